@@ -0,0 +1,47 @@
+// The layouts of include/mosaic/graphics/light_clustering.hpp, read from the frame ring buffer
+// through the ResourceTable
+#extension GL_EXT_nonuniform_qualifier : require
+
+struct LightCluster
+{
+    uint offset;
+    uint count;
+};
+
+struct ClusterUniforms
+{
+    vec2 tileScale;
+    float sliceScale;
+    float sliceBias;
+    uint tilesX;
+    uint tilesY;
+    uint slices;
+    uint lightCount;
+    uint firstCluster;
+    uint firstIndex;
+};
+
+layout(set = 0, binding = 0) readonly buffer LightClusters
+{
+    LightCluster data[];
+} g_lightClusters[];
+layout(set = 0, binding = 0) readonly buffer LightIndices { uint data[]; } g_lightIndices[];
+
+// The cluster of a fragment: its framebuffer position and view space depth (negative)
+uint findCluster(ClusterUniforms _uniforms, vec2 _fragCoord, float _viewZ)
+{
+    uvec2 tile = min(uvec2(_fragCoord * _uniforms.tileScale),
+                     uvec2(_uniforms.tilesX, _uniforms.tilesY) - 1u);
+    int slice = int(floor(log(-_viewZ) * _uniforms.sliceScale + _uniforms.sliceBias));
+    uint clamped = uint(clamp(slice, 0, int(_uniforms.slices) - 1));
+
+    return (clamped * _uniforms.tilesY + tile.y) * _uniforms.tilesX + tile.x;
+}
+
+// The lights of a fragment are g_lightIndices[ring].data[firstIndex + offset + i], i < count
+LightCluster getClusterLights(uint _ring, ClusterUniforms _uniforms, vec2 _fragCoord,
+                              float _viewZ)
+{
+    uint cluster = findCluster(_uniforms, _fragCoord, _viewZ);
+    return g_lightClusters[_ring].data[_uniforms.firstCluster + cluster];
+}
@@ -0,0 +1,66 @@
+// The layouts of include/mosaic/graphics/gpu_culling.hpp, read through the ResourceTable
+#extension GL_EXT_nonuniform_qualifier : require
+
+#define CULL_OCCLUSION 1u
+#define CULL_EARLY_PHASE 2u
+#define CULL_LATE_PHASE 4u
+#define HANDLE_INDEX(handle) ((handle) & 0xFFFFFu)
+
+struct CullInstance
+{
+    vec4 sphere; // center, radius
+    uint drawIndex;
+    uint instanceIndex;
+    uint padding0;
+    uint padding1;
+};
+
+struct CullDraw
+{
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint maxInstances;
+};
+
+struct IndexedIndirectCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+struct CullUniforms
+{
+    vec4 frustum[6];
+    mat4 view;
+    vec4 projection; // p00, p11, zNear
+    vec2 pyramidSize;
+    uint instanceCount;
+    uint drawCount;
+    uint flags;
+};
+
+layout(set = 0, binding = 0) readonly buffer Instances { CullInstance data[]; } g_instances[];
+layout(set = 0, binding = 0) readonly buffer Draws { CullDraw data[]; } g_draws[];
+layout(set = 0, binding = 0) buffer Commands { IndexedIndirectCommand data[]; } g_commands[];
+layout(set = 0, binding = 0) buffer Counters { uint data[]; } g_counters[];
+layout(set = 0, binding = 0) readonly buffer Uniforms { CullUniforms data; } g_uniforms[];
+layout(set = 0, binding = 1) uniform texture2D g_textures[];
+layout(set = 0, binding = 2) uniform sampler g_samplers[];
+
+layout(push_constant) uniform CullConstants
+{
+    uint instances;
+    uint draws;
+    uint commands;
+    uint compacted;
+    uint visibleInstances;
+    uint drawCount;
+    uint uniforms;
+    uint depthPyramid;
+    uint pyramidSampler;
+    uint visibility; // of each instance, the frame before: 1 visible, 0 not
+} c_handles;
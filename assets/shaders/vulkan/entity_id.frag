@@ -0,0 +1,18 @@
+#version 460
+
+// The entity ID attachment picking reads back (TextureFormat::R32UI): the fragment shader of the
+// ID variant of a pipeline, drawn with its vertex shader. The draw pushes its entity as its last
+// DrawCall resource, 0 for none; the DrawCall resources before are those of the vertex shader.
+
+layout(push_constant) uniform DrawConstants
+{
+    uint resources[3];
+    uint entity;
+} c_draw;
+
+layout(location = 0) out uint outEntity;
+
+void main()
+{
+    outEntity = c_draw.entity;
+}
@@ -0,0 +1,13 @@
+#version 460
+
+// The meshlet draws shaded by their normal (both paths): a debug view until they have materials
+
+layout(location = 0) in vec3 fragNormal;
+layout(location = 1) in vec2 fragUv;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    outColor = vec4(normalize(fragNormal) * 0.5 + 0.5, 1.0);
+}
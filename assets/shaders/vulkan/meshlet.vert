@@ -0,0 +1,50 @@
+#version 460
+
+// The emulated meshlet draw (vkCmdDrawIndirect of cull_meshlets.comp's arguments): an instance
+// per visible meshlet, a vertex per corner of its triangles, MAX_MESHLET_TRIANGLES of them. The
+// corners past its triangles, and the instances past the visible list, are degenerate.
+
+#define MESHLET_EMULATED_DRAW
+#include "meshlet_common.glsl"
+
+layout(push_constant) uniform DrawConstants
+{
+    uint instances;
+    uint meshes;
+    uint uniforms;
+    uint visible;
+} c_draw;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec2 fragUv;
+
+void main()
+{
+    MeshletCullUniforms u = g_uniforms[HANDLE_INDEX(c_draw.uniforms)].data;
+
+    uint triangle = uint(gl_VertexIndex) / 3u;
+    uint corner = uint(gl_VertexIndex) % 3u;
+
+    fragNormal = vec3(0.0, 0.0, 1.0);
+    fragUv = vec2(0.0);
+    gl_Position = vec4(0.0);
+
+    if (uint(gl_InstanceIndex) >= u.maxVisible) return;
+
+    VisibleMeshlet visible = g_visible[HANDLE_INDEX(c_draw.visible)].data[gl_InstanceIndex];
+    MeshletInstance instance = g_instances[HANDLE_INDEX(c_draw.instances)].data[visible.instance];
+    MeshletMesh mesh = g_meshes[HANDLE_INDEX(c_draw.meshes)].data[instance.mesh];
+    Meshlet meshlet = loadMeshlet(mesh, visible.meshlet);
+
+    if (triangle >= meshlet.triangleCount || meshlet.vertexCount == 0u) return;
+
+    // as meshlet.mesh, the corners clamped to the vertices
+    uvec3 corners = loadMeshletTriangle(mesh, meshlet, triangle);
+    uint local = min(corners[corner], meshlet.vertexCount - 1u);
+
+    MeshletVertex vertex = loadVertex(mesh, loadMeshletVertex(mesh, meshlet, local));
+
+    gl_Position = u.viewProjection * instance.world * vec4(vertex.position, 1.0);
+    fragNormal = normalize(transpose(inverse(mat3(instance.world))) * vertex.normal);
+    fragUv = vertex.uv;
+}
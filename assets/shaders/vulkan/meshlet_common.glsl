@@ -0,0 +1,250 @@
+// The layouts of include/mosaic/graphics/meshlet_culling.hpp and of the cooked meshes (mesh.hpp),
+// read through the ResourceTable. The compute fallback defines MESHLET_CULL_PASS, the only one that
+// writes the visible meshlets; the emulated draw (meshlet.vert) MESHLET_EMULATED_DRAW.
+#extension GL_EXT_nonuniform_qualifier : require
+
+#define MESHLET_CONE 1u
+#define MESHLET_OCCLUSION 2u
+#define MESHLET_TASK_SIZE 32
+#define MAX_MESHLET_VERTICES 64
+#define MAX_MESHLET_TRIANGLES 124
+#define HANDLE_INDEX(handle) ((handle) & 0xFFFFFu)
+
+#ifdef MESHLET_CULL_PASS
+#define VISIBLE_ACCESS
+#else
+#define VISIBLE_ACCESS readonly
+#endif
+
+struct Meshlet
+{
+    uint vertexOffset;
+    uint triangleOffset; // in bytes
+    uint vertexCount;
+    uint triangleCount;
+    vec4 sphere; // center, radius
+    vec4 cone;   // axis, cutoff
+};
+
+struct MeshletMesh
+{
+    uint buffer;
+    uint vertexOffset; // the sections in the buffer, in bytes
+    uint meshletOffset;
+    uint meshletVertexOffset;
+    uint meshletTriangleOffset;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+    vec4 boundsMin;
+    vec4 boundsExtent;
+};
+
+struct MeshletInstance
+{
+    mat4 world;
+    uint mesh;
+    uint firstMeshlet;
+    uint meshletCount;
+    uint instanceIndex;
+};
+
+struct MeshletTask
+{
+    uint instance;
+    uint firstMeshlet;
+    uint meshletCount;
+    uint padding;
+};
+
+struct VisibleMeshlet
+{
+    uint instance;
+    uint meshlet;
+};
+
+struct MeshletCullUniforms
+{
+    vec4 frustum[6];
+    mat4 viewProjection;
+    mat4 view;
+    vec4 camera;     // position, p00
+    vec4 projection; // p11, zNear, pyramid width, pyramid height
+    uint taskCount;
+    uint maxVisible;
+    uint flags;
+    uint padding;
+};
+
+struct DrawIndirectCommand
+{
+    uint vertexCount;
+    uint instanceCount;
+    uint firstVertex;
+    uint firstInstance;
+};
+
+// The meshlets of a task the task shader kept, a mesh workgroup each
+struct MeshletPayload
+{
+    uint instance;
+    uint meshlets[MESHLET_TASK_SIZE];
+};
+
+struct MeshletVertex
+{
+    vec3 position; // object space
+    vec3 normal;
+    vec2 uv;
+};
+
+layout(set = 0, binding = 0) readonly buffer Words { uint data[]; } g_words[]; // the meshes
+layout(set = 0, binding = 0) readonly buffer Meshes { MeshletMesh data[]; } g_meshes[];
+layout(set = 0, binding = 0) readonly buffer Instances { MeshletInstance data[]; } g_instances[];
+layout(set = 0, binding = 0) readonly buffer Tasks { MeshletTask data[]; } g_tasks[];
+layout(set = 0, binding = 0) readonly buffer Uniforms { MeshletCullUniforms data; } g_uniforms[];
+layout(set = 0, binding = 0) VISIBLE_ACCESS buffer Visible { VisibleMeshlet data[]; } g_visible[];
+layout(set = 0, binding = 0) VISIBLE_ACCESS buffer Arguments
+{
+    DrawIndirectCommand data;
+} g_arguments[];
+layout(set = 0, binding = 1) uniform texture2D g_textures[];
+layout(set = 0, binding = 2) uniform sampler g_samplers[];
+
+// The handles of the buffers, as MeshletRenderer pushes them (the emulated draw pushes its own)
+#ifndef MESHLET_EMULATED_DRAW
+layout(push_constant) uniform MeshletConstants
+{
+    uint instances;
+    uint meshes;
+    uint uniforms;
+    uint visible;
+    uint tasks;
+    uint depthPyramid;
+    uint pyramidSampler;
+    uint drawArguments;
+} c_handles;
+#endif
+
+#include "project_sphere.glsl"
+
+// opaque: combined where it is sampled
+#define PYRAMID(texture, sampler)                                                                  \
+    sampler2D(g_textures[HANDLE_INDEX(texture)], g_samplers[HANDLE_INDEX(sampler)])
+
+Meshlet loadMeshlet(MeshletMesh _mesh, uint _index)
+{
+    uint buffer = HANDLE_INDEX(_mesh.buffer);
+    uint base = _mesh.meshletOffset / 4u + _index * 12u;
+
+    Meshlet meshlet;
+    meshlet.vertexOffset = g_words[buffer].data[base];
+    meshlet.triangleOffset = g_words[buffer].data[base + 1u];
+    meshlet.vertexCount = min(g_words[buffer].data[base + 2u], MAX_MESHLET_VERTICES);
+    meshlet.triangleCount = min(g_words[buffer].data[base + 3u], MAX_MESHLET_TRIANGLES);
+    for (uint i = 0u; i < 4u; ++i)
+    {
+        meshlet.sphere[i] = uintBitsToFloat(g_words[buffer].data[base + 4u + i]);
+        meshlet.cone[i] = uintBitsToFloat(g_words[buffer].data[base + 8u + i]);
+    }
+    return meshlet;
+}
+
+// unpackPosition(), unpackNormal() and unpackUv() of mesh.cpp: _index in the vertices of the mesh
+MeshletVertex loadVertex(MeshletMesh _mesh, uint _index)
+{
+    uint buffer = HANDLE_INDEX(_mesh.buffer);
+    uint base = _mesh.vertexOffset / 4u + _index * 4u;
+
+    uint position0 = g_words[buffer].data[base];
+    uint position1 = g_words[buffer].data[base + 1u];
+    vec3 unit = vec3(unpackUnorm2x16(position0), unpackUnorm2x16(position1).x);
+
+    // octahedral: the lower hemisphere folded over the upper one
+    vec2 folded = max(unpackSnorm2x16(g_words[buffer].data[base + 2u]), -1.0);
+    vec3 normal = vec3(folded, 1.0 - abs(folded.x) - abs(folded.y));
+    if (normal.z < 0.0) normal.xy = (1.0 - abs(normal.yx)) * mix(vec2(-1.0), vec2(1.0),
+                                                                 greaterThanEqual(normal.xy,
+                                                                                  vec2(0.0)));
+
+    MeshletVertex vertex;
+    vertex.position = _mesh.boundsMin.xyz + _mesh.boundsExtent.xyz * unit;
+    vertex.normal = normalize(normal);
+    vertex.uv = unpackHalf2x16(g_words[buffer].data[base + 3u]);
+    return vertex;
+}
+
+// The index in the vertices of the mesh of vertex _local of _meshlet
+uint loadMeshletVertex(MeshletMesh _mesh, Meshlet _meshlet, uint _local)
+{
+    uint buffer = HANDLE_INDEX(_mesh.buffer);
+    return g_words[buffer].data[_mesh.meshletVertexOffset / 4u + _meshlet.vertexOffset + _local];
+}
+
+// The vertices of triangle _triangle of _meshlet, in its vertices
+uvec3 loadMeshletTriangle(MeshletMesh _mesh, Meshlet _meshlet, uint _triangle)
+{
+    uint buffer = HANDLE_INDEX(_mesh.buffer);
+    uint first = _mesh.meshletTriangleOffset + _meshlet.triangleOffset + _triangle * 3u;
+
+    uvec3 corners;
+    for (uint k = 0u; k < 3u; ++k)
+    {
+        uint byte = first + k;
+        corners[k] = (g_words[buffer].data[byte / 4u] >> ((byte % 4u) * 8u)) & 0xFFu;
+    }
+    return corners;
+}
+
+// cullMeshlets() of meshlet_culling.cpp for one meshlet: the frustum, the cone, the pyramid
+bool isMeshletVisible(MeshletCullUniforms _u, mat4 _world, Meshlet _meshlet, uint _pyramid,
+                      uint _pyramidSampler)
+{
+    // transformSphere(), the squared scales of the axes
+    vec3 scales = vec3(dot(_world[0].xyz, _world[0].xyz), dot(_world[1].xyz, _world[1].xyz),
+                       dot(_world[2].xyz, _world[2].xyz));
+    float maxScale = max(scales.x, max(scales.y, scales.z));
+    float minScale = min(scales.x, min(scales.y, scales.z));
+
+    vec3 center = (_world * vec4(_meshlet.sphere.xyz, 1.0)).xyz;
+    float radius = _meshlet.sphere.w * sqrt(maxScale);
+
+    for (int i = 0; i < 6; ++i)
+    {
+        if (dot(_u.frustum[i].xyz, center) + _u.frustum[i].w < -radius) return false;
+    }
+
+    // transformMeshletCone() and isMeshletBackfacing()
+    if ((_u.flags & MESHLET_CONE) != 0u && _meshlet.cone.w < 1.0 && minScale > 0.0 &&
+        maxScale <= minScale * 1.001)
+    {
+        vec3 axis = normalize(mat3(_world) * _meshlet.cone.xyz);
+        vec3 direction = center - _u.camera.xyz;
+        if (dot(direction, axis) >= _meshlet.cone.w * length(direction) + radius) return false;
+    }
+
+    if ((_u.flags & MESHLET_OCCLUSION) != 0u)
+    {
+        vec3 viewCenter = (_u.view * vec4(center, 1.0)).xyz;
+        vec4 aabb;
+
+        // as cull_instances.comp, the spheres crossing the near plane kept
+        if (projectSphere(viewCenter, radius, _u.projection.y, _u.camera.w, _u.projection.x,
+                          aabb))
+        {
+            vec2 size = (aabb.zw - aabb.xy) * _u.projection.zw;
+            float level = ceil(log2(max(max(size.x, size.y), 1.0)));
+
+            float depth =
+                min(min(textureLod(PYRAMID(_pyramid, _pyramidSampler), aabb.xy, level).x,
+                        textureLod(PYRAMID(_pyramid, _pyramidSampler), aabb.zy, level).x),
+                    min(textureLod(PYRAMID(_pyramid, _pyramidSampler), aabb.xw, level).x,
+                        textureLod(PYRAMID(_pyramid, _pyramidSampler), aabb.zw, level).x));
+
+            float sphereDepth = _u.projection.y / (-viewCenter.z - radius);
+            if (sphereDepth < depth) return false;
+        }
+    }
+
+    return true;
+}
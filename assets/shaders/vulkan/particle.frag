@@ -0,0 +1,16 @@
+#version 460
+
+// A soft disc, blended over the scene (straight alpha)
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragCorner;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    float falloff = 1.0 - smoothstep(0.5, 1.0, length(fragCorner));
+    if (falloff <= 0.0) discard;
+
+    outColor = vec4(fragColor.rgb, fragColor.a * falloff);
+}
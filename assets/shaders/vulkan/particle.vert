@@ -0,0 +1,39 @@
+#version 460
+
+// A camera-facing quad per particle of the sorted list (vkCmdDrawIndirect, 6 vertices and an
+// instance per particle), faded out over its lifetime.
+
+#define PARTICLE_DRAW
+#include "particles_common.glsl"
+
+layout(push_constant) uniform DrawConstants
+{
+    uint particles;
+    uint alive;
+    uint uniforms;
+    uint padding;
+} c_draw;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragCorner;
+
+const vec2 k_corners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                                 vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main()
+{
+    ParticleUniforms u = g_uniforms[HANDLE_INDEX(c_draw.uniforms)].data;
+
+    uint slot = g_indices[HANDLE_INDEX(c_draw.alive)].data[gl_InstanceIndex];
+    GpuParticle particle = g_particles[HANDLE_INDEX(c_draw.particles)].data[slot];
+
+    vec2 corner = k_corners[gl_VertexIndex];
+    vec3 position =
+        particle.position + (u.cameraRight * corner.x + u.cameraUp * corner.y) * particle.size;
+
+    float fade = 1.0 - clamp(particle.age / particle.lifetime, 0.0, 1.0);
+
+    gl_Position = u.viewProjection * vec4(position, 1.0);
+    fragColor = vec4(particle.color.rgb, particle.color.a * fade);
+    fragCorner = corner;
+}
@@ -0,0 +1,145 @@
+// The layouts of include/mosaic/graphics/gpu_particles.hpp, read through the ResourceTable
+#extension GL_EXT_nonuniform_qualifier : require
+
+#define HANDLE_INDEX(handle) ((handle) & 0xFFFFFu)
+
+#define SORT_BITS 16u
+#define SORT_RADIX 256u
+#define SORT_BLOCK_SIZE 1024u
+#define SORT_INVALID 0xFFFFFFFFu
+
+struct GpuParticle
+{
+    vec3 position;
+    float age;
+    vec3 velocity;
+    float lifetime;
+    vec4 color;
+    float size;
+    float drag;
+    uint emitter;
+    uint padding;
+};
+
+struct ParticleEmitter
+{
+    vec3 position;
+    float radius;
+    vec3 velocity;
+    float velocityJitter;
+    vec4 color;
+    float size;
+    float lifetime;
+    float lifetimeJitter;
+    float drag;
+    uint firstSpawn;
+    uint spawnCount;
+    uint seed;
+    uint padding;
+};
+
+struct ParticleUniforms
+{
+    mat4 viewProjection;
+    vec3 cameraPosition;
+    float sortDistance;
+    vec3 cameraRight;
+    float padding0;
+    vec3 cameraUp;
+    float padding1;
+    vec3 gravity;
+    float deltaTime;
+    uint emitterCount;
+    uint spawnCount;
+    uint frame;
+    uint capacity;
+};
+
+struct ParticleCounters
+{
+    uint deadCount;
+    uint aliveCount[2];
+    uint sortBlocks;
+    uint simulateArguments[3];
+    uint padding0;
+    uint sortArguments[3];
+    uint padding1;
+    uint drawArguments[4];
+};
+
+// the vertex stage only reads them (no vertexPipelineStoresAndAtomics)
+#ifdef PARTICLE_DRAW
+#define PARTICLE_ACCESS readonly
+#else
+#define PARTICLE_ACCESS
+#endif
+
+layout(set = 0, binding = 0) PARTICLE_ACCESS buffer Particles { GpuParticle data[]; } g_particles[];
+layout(set = 0, binding = 0) readonly buffer Emitters { ParticleEmitter data[]; } g_emitters[];
+layout(set = 0, binding = 0) readonly buffer Uniforms { ParticleUniforms data; } g_uniforms[];
+layout(set = 0, binding = 0) PARTICLE_ACCESS buffer Counters
+{
+    ParticleCounters data;
+} g_counters[];
+layout(set = 0, binding = 0) PARTICLE_ACCESS buffer Indices { uint data[]; } g_indices[];
+
+// The handles of the buffers and the pass, as GpuParticles pushes them (the draw pushes its own)
+#ifndef PARTICLE_DRAW
+layout(push_constant) uniform ParticleConstants
+{
+    uint particles;
+    uint deadList;
+    uint aliveCurrent; // the list simulated this frame
+    uint aliveNext;    // the survivors, sorted for the draw
+    uint counters;
+    uint emitters;
+    uint uniforms;
+    uint histogram;
+    uint sourceKeys;
+    uint sourceValues;
+    uint destinationKeys;
+    uint destinationValues;
+    uint shift;   // of the digit of a sort pass
+    uint current; // the aliveCount of aliveCurrent
+} c_handles;
+#endif
+
+#define PARTICLES g_particles[HANDLE_INDEX(c_handles.particles)].data
+#define COUNTERS g_counters[HANDLE_INDEX(c_handles.counters)].data
+#define UNIFORMS g_uniforms[HANDLE_INDEX(c_handles.uniforms)].data
+
+// PCG hash, a random uint per input
+uint hashUint(uint _value)
+{
+    uint state = _value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// A random float in [0, 1) from _state, which moves to the next one
+float randomFloat(inout uint _state)
+{
+    _state = hashUint(_state);
+    return float(_state >> 8u) / 16777216.0;
+}
+
+// A random point in the unit ball
+vec3 randomInBall(inout uint _state)
+{
+    vec3 direction = vec3(randomFloat(_state), randomFloat(_state), randomFloat(_state)) * 2.0 -
+                     1.0;
+    float length2 = dot(direction, direction);
+    if (length2 < 1e-6) return vec3(0.0);
+
+    return direction * (pow(randomFloat(_state), 1.0 / 3.0) * inversesqrt(length2));
+}
+
+// getParticleSortKey() of gpu_particles.cpp: ascending the farthest first
+uint getSortKey(float _distance, float _sortDistance)
+{
+    const uint maxKey = (1u << SORT_BITS) - 1u;
+    float t = _sortDistance > 0.0 ? _distance / _sortDistance : 0.0;
+    t = t > 0.0 ? min(t, 1.0) : 0.0;
+
+    return maxKey - uint(t * float(maxKey));
+}
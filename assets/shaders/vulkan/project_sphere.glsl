@@ -0,0 +1,21 @@
+// projectSphere() of gpu_culling.cpp: the uv rectangle of a view space sphere, -Z forward
+bool projectSphere(vec3 _center, float _radius, float _zNear, float _p00, float _p11,
+                   out vec4 _aabb)
+{
+    vec3 c = vec3(_center.xy, -_center.z);
+    if (c.z < _radius + _zNear) return false;
+
+    float tx = sqrt(c.x * c.x + c.z * c.z - _radius * _radius);
+    float minX = (tx * c.x - _radius * c.z) / (_radius * c.x + tx * c.z);
+    float maxX = (tx * c.x + _radius * c.z) / (tx * c.z - _radius * c.x);
+
+    float ty = sqrt(c.y * c.y + c.z * c.z - _radius * _radius);
+    float minY = (ty * c.y - _radius * c.z) / (_radius * c.y + ty * c.z);
+    float maxY = (ty * c.y + _radius * c.z) / (ty * c.z - _radius * c.y);
+
+    vec2 u = vec2(minX, maxX) * _p00 * 0.5 + 0.5;
+    vec2 v = vec2(maxY, minY) * _p11 * -0.5 + 0.5;
+
+    _aabb = vec4(min(u.x, u.y), min(v.x, v.y), max(u.x, u.y), max(v.x, v.y));
+    return true;
+}
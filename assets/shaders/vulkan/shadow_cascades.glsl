@@ -0,0 +1,30 @@
+// The layout of include/mosaic/graphics/shadow_cascades.hpp, the cascades the layers of a
+// sampler2DArrayShadow
+struct ShadowUniforms
+{
+    mat4 viewProjection[4];
+    vec4 splitDepths;
+    vec4 texelSizes;
+    uint cascadeCount;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+};
+
+// The cascade of a fragment at view space depth _viewZ (negative), cascadeCount past the last
+uint findCascade(ShadowUniforms _uniforms, float _viewZ)
+{
+    uint cascade = 0u;
+    while (cascade < _uniforms.cascadeCount && -_viewZ > _uniforms.splitDepths[cascade])
+    {
+        ++cascade;
+    }
+    return cascade;
+}
+
+// The uv of a world position in a cascade, and the depth to compare with
+vec3 getShadowCoord(ShadowUniforms _uniforms, uint _cascade, vec3 _worldPosition)
+{
+    vec4 clip = _uniforms.viewProjection[_cascade] * vec4(_worldPosition, 1.0);
+    return vec3(clip.xy * 0.5 + 0.5, clip.z);
+}
@@ -4,6 +4,17 @@ layout(location = 0) in vec3 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
+// The features of the material (ShaderVariantKey), bit k constant_id k: folded when the pipeline
+// is created, or defined by the permutation compiled for the key (variants.txt)
+#ifdef MOSAIC_VARIANT
+const bool GRAYSCALE = (MOSAIC_VARIANT & 0x1) != 0;
+#else
+layout(constant_id = 0) const bool GRAYSCALE = false;
+#endif
+
 void main() {
-    outColor = vec4(fragColor, 1.0);
-}
\ No newline at end of file
+    vec3 color = fragColor;
+    if (GRAYSCALE) color = vec3(dot(color, vec3(0.2126, 0.7152, 0.0722)));
+
+    outColor = vec4(color, 1.0);
+}
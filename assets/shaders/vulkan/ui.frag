@@ -0,0 +1,41 @@
+#version 460
+
+// A solid color, an image or a glyph of the atlas, blended over the frame (straight alpha). The
+// glyphs are distance fields, their edge at 0.5, antialiased across a pixel at any size.
+
+#include "ui_common.glsl"
+
+layout(set = 0, binding = 1) uniform texture2D g_textures[];
+layout(set = 0, binding = 1) uniform texture2DArray g_textureArrays[];
+layout(set = 0, binding = 2) uniform sampler g_samplers[];
+
+#define LINEAR_SAMPLER g_samplers[HANDLE_INDEX(c_draw.sampler)]
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragUv;
+layout(location = 2) flat in uvec3 fragSource;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    vec4 color = fragColor;
+
+    if (fragSource.z == UI_IMAGE)
+    {
+        uint image = HANDLE_INDEX(fragSource.x);
+        color *= texture(sampler2D(g_textures[nonuniformEXT(image)], LINEAR_SAMPLER), fragUv);
+    }
+    else if (fragSource.z == UI_TEXT)
+    {
+        vec3 uv = vec3(fragUv, float(fragSource.y));
+        float distance =
+            texture(sampler2DArray(g_textureArrays[HANDLE_INDEX(c_draw.atlas)], LINEAR_SAMPLER), uv)
+                .r;
+        float width = max(fwidth(distance) * 0.5, 1e-4);
+        color.a *= smoothstep(0.5 - width, 0.5 + width, distance);
+    }
+
+    if (color.a <= 0.0) discard;
+    outColor = color;
+}
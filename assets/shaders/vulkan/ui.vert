@@ -0,0 +1,25 @@
+#version 460
+
+// The vertices of a UiBatcher, pulled from the frame ring (the index buffer gives
+// gl_VertexIndex, the vertex offset of the draw included), in pixels to clip space.
+
+#include "ui_common.glsl"
+
+layout(set = 0, binding = 0) readonly buffer UiVertices { UiVertex data[]; } g_vertices[];
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragUv;
+layout(location = 2) flat out uvec3 fragSource; // texture, layer, mode
+
+void main()
+{
+    UiVertex vertex = g_vertices[HANDLE_INDEX(c_draw.vertices)].data[gl_VertexIndex];
+
+    vec2 viewport = vec2(float(c_draw.viewport & 0xFFFFu), float(c_draw.viewport >> 16));
+
+    // y down, as the clip space
+    gl_Position = vec4(vertex.position / viewport * 2.0 - 1.0, 0.0, 1.0);
+    fragColor = unpackUnorm4x8(vertex.color);
+    fragUv = vertex.uv;
+    fragSource = uvec3(vertex.texture, vertex.layer, vertex.mode);
+}
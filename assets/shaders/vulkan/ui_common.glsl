@@ -0,0 +1,27 @@
+// The layout of include/mosaic/graphics/ui_batcher.hpp, read through the ResourceTable
+#extension GL_EXT_nonuniform_qualifier : require
+
+#define HANDLE_INDEX(handle) ((handle) & 0xFFFFFu)
+
+#define UI_SOLID 0u
+#define UI_IMAGE 1u
+#define UI_TEXT 2u
+
+struct UiVertex
+{
+    vec2 position;
+    vec2 uv;
+    uint color;
+    uint texture;
+    uint layer;
+    uint mode;
+};
+
+// DrawCall::resources, the UiBatcher slots
+layout(push_constant) uniform DrawConstants
+{
+    uint vertices; // the frame ring
+    uint atlas;    // the glyph atlas, an array texture
+    uint sampler;
+    uint viewport; // width | height << 16
+} c_draw;
@@ -4,12 +4,15 @@
 # (ISAs), this module will automatically detect the host's compiler SIMD
 # capabilities and compile the appropriate ISA-specific source files if they
 # exist. At runtime, the correct SIMD code will be selected based on the
-# detected capabilities.
+# detected capabilities: the target is given SIMD_HAS_<ISA> for each variant it
+# compiles, for the base file to dispatch to it only when it exists.
 #
 # Usage: include(cmake/EnhancedSimdConfig.cmake)
 # add_isa_specific_sources(target_name "filename.cpp" AVX SSE4_1)
 #
-# Available ISA flags: SSE2 SSE4_1 SSE4_2 AVX AVX2 AVX512F
+# Available ISA flags: SSE2 SSE4_1 SSE4_2 AVX AVX2 AVX512F, NEON on ARM and
+# WASM_SIMD128 on Emscripten. A WebAssembly module has no runtime detection:
+# one using SIMD does not compile on a browser without it.
 
 cmake_minimum_required(VERSION 3.10 FATAL_ERROR)
 
@@ -110,6 +113,19 @@ int main() {
     return 0;
 }")
 
+# WebAssembly SIMD definitions (Emscripten reports an x86 processor)
+set(_simd_wasm_levels WASM_SIMD128)
+set(_simd_wasm_flags_WASM_SIMD128 "-msimd128")
+set(_simd_wasm_defs_WASM_SIMD128 "SIMD_WASM_SIMD128")
+set(_simd_wasm_suffix_WASM_SIMD128 "wasm_simd128")
+
+set(_simd_wasm_test_wasm_simd128
+    "#include <wasm_simd128.h>
+int main() {
+    v128_t a = wasm_f32x4_splat(0.0f);
+    return wasm_i32x4_bitmask(a);
+}")
+
 # Global variable to cache SIMD detection results
 set(_SIMD_DETECTION_CACHE
     ""
@@ -126,7 +142,11 @@ function(_detect_simd_capabilities)
   message(STATUS "[SIMD] Target CPU: ${CMAKE_SYSTEM_PROCESSOR}")
 
   # Determine architecture and available tests
-  if(CMAKE_SYSTEM_PROCESSOR MATCHES "(x86_64|AMD64|i[3-6]86)")
+  if(EMSCRIPTEN)
+    set(_arch "wasm")
+    set(_levels ${_simd_wasm_levels})
+    message(STATUS "[SIMD] Detected WebAssembly target")
+  elseif(CMAKE_SYSTEM_PROCESSOR MATCHES "(x86_64|AMD64|i[3-6]86)")
     set(_arch "x86")
     set(_levels ${_simd_x86_levels})
     message(
@@ -192,6 +212,8 @@ function(_get_isa_suffix isa out_suffix)
     set(_suffix_var _simd_x86_suffix_${isa})
   elseif(_arch STREQUAL "arm")
     set(_suffix_var _simd_arm_suffix_${isa})
+  elseif(_arch STREQUAL "wasm")
+    set(_suffix_var _simd_wasm_suffix_${isa})
   else()
     set(${out_suffix}
         ""
@@ -247,6 +269,9 @@ function(_apply_isa_flags target source_file isa)
   elseif(_arch STREQUAL "arm")
     set(_flag_var _simd_arm_flags_${isa})
     set(_def_var _simd_arm_defs_${isa})
+  elseif(_arch STREQUAL "wasm")
+    set(_flag_var _simd_wasm_flags_${isa})
+    set(_def_var _simd_wasm_defs_${isa})
   else()
     return()
   endif()
@@ -315,6 +340,7 @@ function(add_isa_specific_sources target base_filename)
         if(EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/${_isa_filename}")
           target_sources(${target} PRIVATE ${_isa_filename})
           _apply_isa_flags(${target} ${_isa_filename} ${isa})
+          target_compile_definitions(${target} PRIVATE SIMD_HAS_${isa})
           message(STATUS "[SIMD] Added ISA-specific source: ${_isa_filename}")
         else()
           message(
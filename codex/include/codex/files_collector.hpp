@@ -3,30 +3,55 @@
 #include <string>
 #include <vector>
 #include <filesystem>
-#include <mutex>
+#include <functional>
+#include <unordered_set>
+
+#include <pieces/utils/coroutines.hpp>
 
 namespace codex
 {
 
 class FilesCollector final
 {
+   public:
+    // Called from the walking threads at once: it must be thread-safe and must not throw
+    using FileSink = std::function<void(std::filesystem::path)>;
+
    private:
-    std::vector<std::string> m_extensions;
+    std::unordered_set<std::string> m_extensions; // lowercase, with the dot
     std::vector<std::string> m_paths;
+    std::vector<std::string> m_excludes;
     bool m_recursive;
-
-    mutable std::mutex m_mutex;
+    size_t m_workerCount;
 
    public:
+    /**
+     * @brief _excludes are gitignore-style patterns matched against the paths relative to the path
+     * walked: `*` and `?` within a name, `**` across directories, a trailing `/` for directories
+     * only, a pattern without `/` matching a name at any depth. An excluded directory is not
+     * entered. One walking thread per hardware thread if _workerCount is 0.
+     */
     FilesCollector(const std::vector<std::string>& _extensions,
-                   const std::vector<std::string>& _paths, bool _recursive = true);
+                   const std::vector<std::string>& _paths, bool _recursive = true,
+                   std::vector<std::string> _excludes = {}, size_t _workerCount = 0);
 
    public:
-    std::vector<std::filesystem::path> collect();
+    // Every file, sorted by path
+    std::vector<std::filesystem::path> collect() const;
+
+    // Hands each file to _sink as soon as it is found, the directories walked by a bounded pool:
+    // the files come in no particular order
+    void collect(const FileSink& _sink) const;
+
+    // Walks the paths one after the other, a file at a time as the caller iterates; the
+    // collector must outlive the generator
+    pieces::Generator<std::filesystem::path> stream() const;
 
    private:
-    std::vector<std::filesystem::path> collectFromPath(const std::filesystem::path& _basePath);
+    pieces::Generator<std::filesystem::path> walk(const std::filesystem::path& _basePath) const;
     bool hasValidExtension(const std::filesystem::path& _file) const;
+    bool isExcluded(const std::filesystem::path& _path, const std::filesystem::path& _basePath,
+                    bool _isDirectory) const;
 };
 
 } // namespace codex
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace codex
+{
+
+/**
+ * @brief A file mapped read-only into memory (mmap, MapViewOfFile): its bytes are those of the page
+ * cache, read by the parser without being copied. The mapping lives as long as the object.
+ *
+ * NOTE: a file truncated by another process while mapped faults on access, the sources are
+ * expected to stay put while codex runs.
+ */
+class MappedFile final
+{
+   private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+
+   public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+   public:
+    // Null if the file cannot be opened or mapped; an empty file maps to an empty view
+    static std::shared_ptr<const MappedFile> open(const std::filesystem::path& _path);
+
+    [[nodiscard]] std::string_view view() const noexcept { return {m_data, m_size}; }
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+};
+
+} // namespace codex
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace codex
+{
+
+/**
+ * @brief The memory of the nodes of one source tree: each node and its reference count are carved
+ * out of large blocks instead of a heap allocation of their own, the blocks freed at once when the
+ * last node of the tree is released.
+ *
+ * The nodes stay std::shared_ptr, so the trees are shared and walked as before; every node keeps
+ * the blocks alive. A tree is built by one thread at a time, its nodes can be released by any.
+ */
+class NodeArena final
+{
+   public:
+    template <typename T>
+    class Allocator
+    {
+       private:
+        template <typename U>
+        friend class Allocator;
+
+        std::shared_ptr<std::pmr::monotonic_buffer_resource> m_blocks;
+
+       public:
+        using value_type = T;
+
+        explicit Allocator(std::shared_ptr<std::pmr::monotonic_buffer_resource> _blocks) noexcept
+            : m_blocks(std::move(_blocks))
+        {
+        }
+
+        template <typename U>
+        Allocator(const Allocator<U>& _other) noexcept : m_blocks(_other.m_blocks)
+        {
+        }
+
+        T* allocate(size_t _count)
+        {
+            return static_cast<T*>(m_blocks->allocate(_count * sizeof(T), alignof(T)));
+        }
+
+        // released with the blocks
+        void deallocate(T* _pointer, size_t _count) noexcept
+        {
+            (void)_pointer;
+            (void)_count;
+        }
+
+        template <typename U>
+        bool operator==(const Allocator<U>& _other) const noexcept
+        {
+            return m_blocks == _other.m_blocks;
+        }
+    };
+
+   private:
+    std::shared_ptr<std::pmr::monotonic_buffer_resource> m_blocks;
+
+   public:
+    // _blockSize is that of the first block, the next ones grow geometrically
+    explicit NodeArena(size_t _blockSize = 64 * 1024)
+        : m_blocks(std::make_shared<std::pmr::monotonic_buffer_resource>(_blockSize))
+    {
+    }
+
+   public:
+    template <typename T, typename... Args>
+    std::shared_ptr<T> make(Args&&... _args)
+    {
+        return std::allocate_shared<T>(Allocator<T>(m_blocks), std::forward<Args>(_args)...);
+    }
+};
+
+} // namespace codex
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "nodes.hpp"
+#include "source.hpp"
+
+namespace codex
+{
+
+/**
+ * @brief The SourceNode trees of the sources parsed by earlier runs, persisted to a file: a source
+ * of the same path, modification time and content hash is not parsed again (see Parser).
+ *
+ * The trees are kept serialized and rebuilt on a hit, so nothing of a run is shared with the
+ * next. find() and store() can be called from the parsing threads, load() and save() not.
+ *
+ * NOTE: k_formatVersion must be bumped whenever a node gains, loses or reorders a field, the
+ * cache files of the older version being dropped on load.
+ */
+class ParseCache final
+{
+   public:
+    static constexpr uint32_t k_formatVersion = 1;
+
+   private:
+    struct Entry
+    {
+        double lastModifiedTime;
+        uint64_t contentHash;
+        std::string tree;
+    };
+
+    std::filesystem::path m_file;
+    std::unordered_map<std::string, Entry> m_entries;
+
+    mutable std::shared_mutex m_mutex;
+
+    std::atomic<size_t> m_hits = 0;
+    std::atomic<size_t> m_misses = 0;
+
+   public:
+    explicit ParseCache(std::filesystem::path _file);
+
+    ParseCache(const ParseCache&) = delete;
+    ParseCache& operator=(const ParseCache&) = delete;
+
+   public:
+    // Reads the cache file, false (and an empty cache) if missing, of another version or corrupt
+    bool load();
+
+    // Writes the cache file through a temporary one, the entries of deleted files dropped
+    bool save() const;
+
+    // The tree parsed from _source by an earlier run, null if it changed since or never parsed
+    std::shared_ptr<SourceNode> find(const std::shared_ptr<Source>& _source);
+
+    void store(const Source& _source, const SourceNode& _tree);
+
+    [[nodiscard]] size_t getEntryCount() const;
+    [[nodiscard]] size_t getHitCount() const noexcept { return m_hits.load(); }
+    [[nodiscard]] size_t getMissCount() const noexcept { return m_misses.load(); }
+
+    // FNV-1a 64 of the content as parsed, after the preprocessor ran
+    [[nodiscard]] static uint64_t hashContent(std::string_view _content) noexcept;
+};
+
+} // namespace codex
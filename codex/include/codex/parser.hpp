@@ -1,22 +1,97 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include <string>
-#include <vector>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <tree_sitter/api.h>
 
 #include "nodes.hpp"
+#include "parse_cache.hpp"
 
 namespace codex
 {
 
 class Parser
 {
+   private:
+    size_t m_workerCount;
+    ParseCache* m_cache;
+
    public:
+    // One worker per hardware thread if _workerCount is 0; the cache, if any, outlives the parser
+    explicit Parser(size_t _workerCount = 0, ParseCache* _cache = nullptr);
+
+   public:
+    // The trees in the order of _sources, those that failed to parse left out
     std::vector<std::shared_ptr<SourceNode>> parse(
         const std::vector<std::shared_ptr<Source>>& _sources);
+
+    // On the calling thread, through the cache if any; throws if the source cannot be parsed
+    std::shared_ptr<SourceNode> parse(const std::shared_ptr<Source>& _source) const;
+};
+
+/**
+ * @brief What an IncrementalParser update changed in the tree of a source, in declarations: those
+ * directly in the file or in its namespaces. The namespaces are containers, rebuilt on every
+ * update and never reported themselves.
+ */
+struct SourceDiff
+{
+    std::filesystem::path path;
+    std::shared_ptr<SourceNode> tree; // after the update, null once the source is removed
+
+    std::vector<std::shared_ptr<Node>> added;
+    std::vector<std::shared_ptr<Node>> removed;
+    // (before, after) of the declarations reparsed under the same kind and name
+    std::vector<std::pair<std::shared_ptr<Node>, std::shared_ptr<Node>>> changed;
+
+    // Declarations carried over from the previous tree instead of being parsed again
+    size_t reusedCount = 0;
+
+    [[nodiscard]] bool isEmpty() const
+    {
+        return added.empty() && removed.empty() && changed.empty();
+    }
+};
+
+/**
+ * @brief The parser of watch mode: it keeps the tree-sitter tree of each source between updates,
+ * hands it the edit to parse the new text incrementally, and extracts again only the declarations
+ * the edit or the reparse touched; the others are carried over from the previous tree, their lines
+ * shifted.
+ *
+ * NOTE: the nodes carried over are shared with the tree of the previous update, which must not be
+ * walked concurrently. An update is not thread-safe, one watcher drives the parser.
+ */
+class IncrementalParser
+{
+   private:
+    struct File;
+
+    std::unordered_map<std::string, std::unique_ptr<File>> m_files;
+
+   public:
+    IncrementalParser();
+    ~IncrementalParser();
+
+    IncrementalParser(const IncrementalParser&) = delete;
+    IncrementalParser& operator=(const IncrementalParser&) = delete;
+
+   public:
+    // The first update of a path parses it in full; the next ones compare the text with the last
+    // to find the edit. Throws if the source cannot be parsed
+    SourceDiff update(const std::shared_ptr<Source>& _source);
+
+    // Forgets the source: every declaration of its tree reported removed
+    SourceDiff remove(const std::filesystem::path& _path);
+
+    // The tree of the last update of the path, null if unknown
+    [[nodiscard]] std::shared_ptr<SourceNode> getTree(const std::filesystem::path& _path) const;
 };
 
 } // namespace codex
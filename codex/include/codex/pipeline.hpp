@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "files_collector.hpp"
+#include "nodes.hpp"
+#include "parser.hpp"
+#include "preprocessor.hpp"
+#include "source_extractor.hpp"
+
+namespace codex
+{
+
+/**
+ * @brief The stages of codex run file by file: each file the collector finds is extracted,
+ * expanded and parsed on the walking thread that found it, then handed to the sink. Nothing is
+ * kept, a tree (and the text of its Source) is released once the sink lets go of it, so the peak
+ * memory is that of the files in flight rather than of the whole project.
+ *
+ * The sink runs on the walking threads at once (see FilesCollector): it must be thread-safe, and
+ * is where a consumer renders the pages of a file and records what it needs across files.
+ */
+class Pipeline final
+{
+   public:
+    using TreeSink = std::function<void(std::shared_ptr<SourceNode>)>;
+
+   private:
+    FilesCollector m_collector;
+    SourceExtractor m_extractor;
+    Preprocessor m_preprocessor;
+    Parser m_parser;
+
+   public:
+    Pipeline(FilesCollector _collector, SourceExtractor _extractor, Preprocessor _preprocessor,
+             Parser _parser);
+
+   public:
+    // The count of trees handed to _sink; the files that fail are reported and skipped
+    size_t run(const TreeSink& _sink) const;
+};
+
+} // namespace codex
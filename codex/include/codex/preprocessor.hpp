@@ -14,12 +14,17 @@ class Preprocessor
 {
    private:
     std::unordered_map<std::string, std::string> m_defines;
+    size_t m_workerCount;
 
    public:
-    Preprocessor(const std::unordered_map<std::string, std::string>& _defines = {});
+    // One worker per hardware thread if _workerCount is 0
+    Preprocessor(const std::unordered_map<std::string, std::string>& _defines = {},
+                 size_t _workerCount = 0);
 
    public:
     void expand(std::vector<std::shared_ptr<Source>>& _sources);
+    // On the calling thread
+    void expand(const std::shared_ptr<Source>& _source) const;
 };
 
 } // namespace codex
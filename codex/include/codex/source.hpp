@@ -1,7 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <filesystem>
+#include <memory>
+
+#include "mapped_file.hpp"
 
 namespace codex
 {
@@ -10,7 +14,12 @@ struct Source
 {
     std::string name;
     std::filesystem::path path;
+
+    // The text of a source read (or rewritten by the Preprocessor), empty while mapped: read it
+    // through getContent()
     std::string content;
+    std::shared_ptr<const MappedFile> mapping;
+
     std::string encoding;
     double lastModifiedTime;
 
@@ -21,6 +30,27 @@ struct Source
           content(std::move(_content)),
           encoding(std::move(_encoding)),
           lastModifiedTime(_lastModifiedTime) {};
+
+    Source(std::string _name, std::filesystem::path _path,
+           std::shared_ptr<const MappedFile> _mapping, std::string _encoding,
+           double _lastModifiedTime)
+        : name(std::move(_name)),
+          path(std::move(_path)),
+          mapping(std::move(_mapping)),
+          encoding(std::move(_encoding)),
+          lastModifiedTime(_lastModifiedTime) {};
+
+    [[nodiscard]] std::string_view getContent() const noexcept
+    {
+        return mapping ? mapping->view() : std::string_view(content);
+    }
+
+    // Replaces the text, the mapping (if any) released
+    void setContent(std::string _content)
+    {
+        content = std::move(_content);
+        mapping.reset();
+    }
 };
 
 } // namespace codex
@@ -5,6 +5,7 @@
 #include <string>
 #include <filesystem>
 
+#include "files_collector.hpp"
 #include "source.hpp"
 
 namespace codex
@@ -12,8 +13,26 @@ namespace codex
 
 class SourceExtractor
 {
+   private:
+    size_t m_workerCount;
+    bool m_mapFiles;
+
+   public:
+    /**
+     * @brief One worker per hardware thread if _workerCount is 0. With _mapFiles the sources are
+     * mapped rather than read (see MappedFile), the parser reading the page cache directly.
+     */
+    explicit SourceExtractor(size_t _workerCount = 0, bool _mapFiles = true);
+
    public:
     std::vector<std::shared_ptr<Source>> extract(const std::vector<std::filesystem::path>& _paths);
+
+    // Extracts each file on the walking thread that finds it, while the others keep walking; the
+    // sources sorted by path
+    std::vector<std::shared_ptr<Source>> extract(const FilesCollector& _collector);
+
+    // On the calling thread; throws if the file cannot be stat'ed
+    std::shared_ptr<Source> extract(const std::filesystem::path& _path) const;
 };
 
 } // namespace codex
@@ -2,62 +2,222 @@
 
 #include <algorithm>
 #include <cctype>
+#include <condition_variable>
 #include <filesystem>
-#include <future>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "parallel_for.hpp"
+
 namespace codex
 {
 
-FilesCollector::FilesCollector(const std::vector<std::string>& _extensions,
-                               const std::vector<std::string>& _paths, bool _recursive)
-    : m_extensions(_extensions), m_paths(_paths), m_recursive(_recursive)
+namespace
 {
-    // Normalize extensions to lowercase for consistency
-    for (auto& ext : m_extensions)
+
+std::string toLower(std::string _text)
+{
+    std::transform(_text.begin(), _text.end(), _text.begin(),
+                   [](unsigned char _c) { return static_cast<char>(std::tolower(_c)); });
+    return _text;
+}
+
+// `*` and `?` stop at a `/`, `**` does not, `**/` also matches no directory at all
+bool matchGlob(std::string_view _pattern, std::string_view _text)
+{
+    if (_pattern.empty()) return _text.empty();
+
+    if (_pattern.starts_with("**"))
+    {
+        std::string_view rest = _pattern.substr(2);
+
+        if (rest.starts_with('/') && matchGlob(rest.substr(1), _text)) return true;
+
+        for (size_t i = 0; i <= _text.size(); ++i)
+        {
+            if (matchGlob(rest, _text.substr(i))) return true;
+        }
+
+        return false;
+    }
+
+    if (_pattern.front() == '*')
+    {
+        for (size_t i = 0; i <= _text.size(); ++i)
+        {
+            if (matchGlob(_pattern.substr(1), _text.substr(i))) return true;
+            if (i < _text.size() && _text[i] == '/') break;
+        }
+
+        return false;
+    }
+
+    if (_text.empty()) return false;
+
+    if (_pattern.front() == '?' ? _text.front() != '/' : _pattern.front() == _text.front())
     {
-        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return matchGlob(_pattern.substr(1), _text.substr(1));
     }
+
+    return false;
+}
+
+} // namespace
+
+FilesCollector::FilesCollector(const std::vector<std::string>& _extensions,
+                               const std::vector<std::string>& _paths, bool _recursive,
+                               std::vector<std::string> _excludes, size_t _workerCount)
+    : m_paths(_paths),
+      m_excludes(std::move(_excludes)),
+      m_recursive(_recursive),
+      m_workerCount(_workerCount)
+{
+    // Normalize extensions to lowercase for consistency
+    for (const auto& ext : _extensions) m_extensions.insert(toLower(ext));
 }
 
-std::vector<std::filesystem::path> FilesCollector::collect()
+std::vector<std::filesystem::path> FilesCollector::collect() const
 {
-    std::vector<std::future<std::vector<std::filesystem::path>>> futures;
+    std::mutex mutex;
     std::vector<std::filesystem::path> results;
 
+    collect(
+        [&](std::filesystem::path _file)
+        {
+            std::scoped_lock lock(mutex);
+            results.emplace_back(std::move(_file));
+        });
+
+    std::sort(results.begin(), results.end());
+
+    return results;
+}
+
+void FilesCollector::collect(const FileSink& _sink) const
+{
+    struct Directory
+    {
+        std::filesystem::path path;
+        std::filesystem::path basePath; // the excludes are relative to it
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Directory> pending;
+    size_t busy = 0;
+
     for (const auto& path : m_paths)
     {
-        futures.emplace_back(
-            std::async(std::launch::async, [this, path] { return collectFromPath(path); }));
+        std::error_code error;
+
+        if (std::filesystem::is_directory(path, error))
+        {
+            pending.push_back({path, path});
+        }
+        else if (std::filesystem::is_regular_file(path, error) && hasValidExtension(path))
+        {
+            _sink(path);
+        }
     }
 
-    for (auto& future : futures)
+    auto options = std::filesystem::directory_options::skip_permission_denied;
+
+    // Lists one directory, its subdirectories left to whichever worker is free
+    auto list = [&](const Directory& _directory, std::vector<Directory>& _found)
     {
-        auto fResult = future.get();
-        results.insert(results.end(), fResult.begin(), fResult.end());
-    }
+        std::error_code error;
+        std::filesystem::directory_iterator it(_directory.path, options, error);
 
-    return results;
+        for (; !error && it != std::filesystem::directory_iterator(); it.increment(error))
+        {
+            const auto& entry = *it;
+
+            // a link to a directory is not followed, as recursive_directory_iterator does not
+            if (std::filesystem::is_directory(entry.symlink_status(error)))
+            {
+                if (m_recursive && !isExcluded(entry.path(), _directory.basePath, true))
+                {
+                    _found.push_back({entry.path(), _directory.basePath});
+                }
+            }
+            else if (entry.is_regular_file(error) && hasValidExtension(entry.path()) &&
+                     !isExcluded(entry.path(), _directory.basePath, false))
+            {
+                _sink(entry.path());
+            }
+        }
+    };
+
+    auto work = [&]()
+    {
+        std::vector<Directory> found;
+        std::unique_lock lock(mutex);
+
+        while (true)
+        {
+            // done once nothing is left and nobody can find more
+            wake.wait(lock, [&] { return !pending.empty() || busy == 0; });
+            if (pending.empty()) return;
+
+            Directory directory = std::move(pending.back());
+            pending.pop_back();
+            ++busy;
+
+            lock.unlock();
+            list(directory, found);
+            lock.lock();
+
+            --busy;
+            for (auto& subdirectory : found) pending.push_back(std::move(subdirectory));
+
+            if (!found.empty() || busy == 0) wake.notify_all();
+            found.clear();
+        }
+    };
+
+    if (pending.empty()) return;
+
+    const size_t threadCount = resolveWorkerCount(m_workerCount);
+
+    std::vector<std::jthread> workers;
+    workers.reserve(threadCount - 1);
+
+    for (size_t i = 1; i < threadCount; ++i) workers.emplace_back(work);
+
+    work();
+}
+
+pieces::Generator<std::filesystem::path> FilesCollector::stream() const
+{
+    for (const auto& path : m_paths) co_yield pieces::elementsOf(walk(path));
 }
 
-std::vector<std::filesystem::path> FilesCollector::collectFromPath(
-    const std::filesystem::path& _basePath)
+pieces::Generator<std::filesystem::path> FilesCollector::walk(
+    const std::filesystem::path& _basePath) const
 {
-    if (!std::filesystem::exists(_basePath)) return {};
+    if (!std::filesystem::exists(_basePath)) co_return;
 
     auto options = std::filesystem::directory_options::skip_permission_denied;
-    std::vector<std::filesystem::path> collectedFiles;
 
     if (m_recursive)
     {
-        for (const auto& entry : std::filesystem::recursive_directory_iterator(_basePath, options))
+        std::filesystem::recursive_directory_iterator it(_basePath, options);
+
+        for (; it != std::filesystem::recursive_directory_iterator(); ++it)
         {
-            if (entry.is_regular_file() && hasValidExtension(entry.path()))
+            if (it->is_directory())
             {
-                std::scoped_lock lock(m_mutex);
-                collectedFiles.push_back(entry.path());
+                if (isExcluded(it->path(), _basePath, true)) it.disable_recursion_pending();
+            }
+            else if (it->is_regular_file() && hasValidExtension(it->path()) &&
+                     !isExcluded(it->path(), _basePath, false))
+            {
+                co_yield it->path();
             }
         }
     }
@@ -65,22 +225,47 @@ std::vector<std::filesystem::path> FilesCollector::collectFromPath(
     {
         for (const auto& entry : std::filesystem::directory_iterator(_basePath, options))
         {
-            if (entry.is_regular_file() && hasValidExtension(entry.path()))
+            if (entry.is_regular_file() && hasValidExtension(entry.path()) &&
+                !isExcluded(entry.path(), _basePath, false))
             {
-                std::scoped_lock lock(m_mutex);
-                collectedFiles.push_back(entry.path());
+                co_yield entry.path();
             }
         }
     }
-
-    return collectedFiles;
 }
 
 bool FilesCollector::hasValidExtension(const std::filesystem::path& _file) const
 {
-    auto ext = _file.extension().string();
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    return std::find(m_extensions.begin(), m_extensions.end(), ext) != m_extensions.end();
+    return m_extensions.contains(toLower(_file.extension().string()));
+}
+
+bool FilesCollector::isExcluded(const std::filesystem::path& _path,
+                                const std::filesystem::path& _basePath, bool _isDirectory) const
+{
+    if (m_excludes.empty()) return false;
+
+    const std::string relative = _path.lexically_relative(_basePath).generic_string();
+    const std::string name = _path.filename().string();
+
+    for (std::string_view pattern : m_excludes)
+    {
+        if (pattern.ends_with('/'))
+        {
+            if (!_isDirectory) continue;
+            pattern.remove_suffix(1);
+        }
+
+        // a bare name matches at any depth, a path from the walked path
+        const bool anchored = pattern.find('/') != std::string_view::npos;
+        if (pattern.starts_with('/')) pattern.remove_prefix(1);
+
+        if (matchGlob(pattern, anchored ? std::string_view(relative) : std::string_view(name)))
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 } // namespace codex
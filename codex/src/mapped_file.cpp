@@ -0,0 +1,98 @@
+#include "codex/mapped_file.hpp"
+
+#include <memory>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace codex
+{
+
+MappedFile::~MappedFile()
+{
+    if (!m_data) return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::filesystem::path& _path)
+{
+    auto file = std::make_shared<MappedFile>();
+
+#if defined(_WIN32)
+    HANDLE handle = CreateFileW(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return nullptr;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size))
+    {
+        CloseHandle(handle);
+        return nullptr;
+    }
+
+    // a mapping of an empty file is an error
+    if (size.QuadPart == 0)
+    {
+        CloseHandle(handle);
+        return file;
+    }
+
+    HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle);
+    if (!mapping) return nullptr;
+
+    // the view keeps the mapping alive
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data) return nullptr;
+
+    file->m_data = static_cast<const char*>(data);
+    file->m_size = static_cast<size_t>(size.QuadPart);
+#else
+    const int descriptor = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0) return nullptr;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        close(descriptor);
+        return nullptr;
+    }
+
+    if (status.st_size == 0)
+    {
+        close(descriptor);
+        return file;
+    }
+
+    const auto size = static_cast<size_t>(status.st_size);
+
+    // the mapping keeps the file alive
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (data == MAP_FAILED) return nullptr;
+
+    // tree-sitter reads the source front to back
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    file->m_data = static_cast<const char*>(data);
+    file->m_size = size;
+#endif
+
+    return file;
+}
+
+} // namespace codex
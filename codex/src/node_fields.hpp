@@ -0,0 +1,220 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+#include "codex/nodes.hpp"
+
+namespace codex
+{
+
+/**
+ * @brief The fields of each node type, handed one after the other to an archive: the writer and
+ * the reader of the ParseCache, the line shift of the IncrementalParser. The common fields of Node
+ * (position, comment) are left to the archives.
+ *
+ * NOTE: the order is that of the ParseCache files, bump ParseCache::k_formatVersion on a change.
+ */
+
+template <typename Archive>
+void describe(Archive& _ar, TemplateParameter& _value)
+{
+    _ar(_value.keyword, _value.name, _value.isVariadic);
+}
+
+template <typename Archive>
+void describe(Archive& _ar, MacroParameter& _value)
+{
+    _ar(_value.name, _value.isVariadic);
+}
+
+template <typename Archive>
+void describe(Archive& _ar, TypeSignature& _value)
+{
+    _ar(_value.baseType, _value.isConst, _value.isVolatile, _value.isMutable, _value.isPointer,
+        _value.isLValueRef, _value.isRValueRef, _value.templateArgs);
+}
+
+template <typename Archive>
+void describe(Archive& _ar, TemplateArgument& _value)
+{
+    _ar(_value.keyword, _value.typeSignature, _value.value);
+}
+
+template <typename Archive>
+void describe(Archive& _ar, GenericParameter& _value)
+{
+    _ar(_value.typeSignature, _value.name, _value.defaultValue);
+}
+
+template <typename Archive>
+void describeNode(Archive& _ar, Node& _node)
+{
+    switch (_node.kind)
+    {
+        case NodeKind::Source:
+        {
+            // the source itself is that of the run, set on a hit
+            auto& node = static_cast<SourceNode&>(_node);
+            _ar(node.children);
+            break;
+        }
+        case NodeKind::Comment:
+        {
+            auto& node = static_cast<CommentNode&>(_node);
+            _ar(node.text);
+            break;
+        }
+        case NodeKind::Template:
+        {
+            auto& node = static_cast<TemplateNode&>(_node);
+            _ar(node.parameters);
+            break;
+        }
+        case NodeKind::IncludeDirective:
+        {
+            auto& node = static_cast<IncludeNode&>(_node);
+            _ar(node.path, node.isSystem);
+            break;
+        }
+        case NodeKind::ObjectLikeMacro:
+        {
+            auto& node = static_cast<ObjectLikeMacroNode&>(_node);
+            _ar(node.name, node.body);
+            break;
+        }
+        case NodeKind::FunctionLikeMacro:
+        {
+            auto& node = static_cast<FunctionLikeMacroNode&>(_node);
+            _ar(node.name, node.body, node.parameters);
+            break;
+        }
+        case NodeKind::Namespace:
+        {
+            auto& node = static_cast<NamespaceNode&>(_node);
+            _ar(node.name, node.isAnonymous, node.isNested, node.children);
+            break;
+        }
+        case NodeKind::NamespaceAlias:
+        {
+            auto& node = static_cast<NamespaceAliasNode&>(_node);
+            _ar(node.aliasName, node.targetNamespace);
+            break;
+        }
+        case NodeKind::UsingNamespace:
+        {
+            auto& node = static_cast<UsingNamespaceNode&>(_node);
+            _ar(node.name);
+            break;
+        }
+        case NodeKind::Typedef:
+        {
+            auto& node = static_cast<TypedefNode&>(_node);
+            _ar(node.aliasName, node.targetType);
+            break;
+        }
+        case NodeKind::TypeAlias:
+        {
+            auto& node = static_cast<TypeAliasNode&>(_node);
+            _ar(node.aliasName, node.targetType, node.templateDecl);
+            break;
+        }
+        case NodeKind::EnumSpecifier: // the enum itself
+        {
+            auto& node = static_cast<EnumNode&>(_node);
+            _ar(node.name, node.underlyingType, node.isScoped, node.enumerators);
+            break;
+        }
+        case NodeKind::Enum: // an enumerator of it
+        {
+            auto& node = static_cast<EnumSpecifierNode&>(_node);
+            _ar(node.name, node.value);
+            break;
+        }
+        case NodeKind::Variable:
+        {
+            auto& node = static_cast<VariableNode&>(_node);
+            _ar(node.isStatic, node.isConst, node.isConstexpr, node.isMutable, node.isVolatile,
+                node.isThreadLocal, node.isInline, node.isExtern, node.isConstinit, node.type,
+                node.name, node.initialValue);
+            break;
+        }
+        case NodeKind::Concept:
+        {
+            auto& node = static_cast<ConceptNode&>(_node);
+            _ar(node.name, node.constraint, node.templateDecl);
+            break;
+        }
+        case NodeKind::Function:
+        {
+            auto& node = static_cast<FunctionNode&>(_node);
+            _ar(node.isStatic, node.isConst, node.isVolatile, node.isVirtual, node.isPureVirtual,
+                node.isOverride, node.isNoexcept, node.isFinal, node.isInline, node.isConstexpr,
+                node.isConsteval, node.isExplicit, node.attributes, node.returnSignature,
+                node.name, node.parameters, node.templateDecl, node.templateArgs);
+            break;
+        }
+        case NodeKind::Constructor:
+        {
+            auto& node = static_cast<ConstructorNode&>(_node);
+            _ar(node.isExplicit, node.isNoexcept, node.isDefaulted, node.isDeleted,
+                node.isConstexpr, node.isInline, node.name, node.parameters, node.templateDecl,
+                node.templateArgs);
+            break;
+        }
+        case NodeKind::Destructor:
+        {
+            auto& node = static_cast<DestructorNode&>(_node);
+            _ar(node.isVirtual, node.isPureVirtual, node.isDefaulted, node.isDeleted,
+                node.isNoexcept, node.isInline, node.isConstexpr, node.name);
+            break;
+        }
+        case NodeKind::Operator:
+        {
+            auto& node = static_cast<OperatorNode&>(_node);
+            _ar(node.isStatic, node.isConst, node.isVirtual, node.isPureVirtual, node.isOverride,
+                node.isNoexcept, node.isFinal, node.isInline, node.isConstexpr, node.isExplicit,
+                node.operatorSymbol, node.returnSignature, node.parameters, node.templateDecl,
+                node.templateArgs);
+            break;
+        }
+        case NodeKind::Union:
+        {
+            auto& node = static_cast<UnionNode&>(_node);
+            _ar(node.isAnonymous, node.name, node.templateDecl, node.templateArgs,
+                node.memberVariables, node.memberFunctions, node.staticMemberVariables,
+                node.staticMemberFunctions, node.constructors, node.destructors, node.operators,
+                node.nestedTypes);
+            break;
+        }
+        case NodeKind::Friend:
+        {
+            auto& node = static_cast<FriendNode&>(_node);
+            _ar(node.kind, node.name);
+            break;
+        }
+        case NodeKind::Struct:
+        {
+            auto& node = static_cast<StructNode&>(_node);
+            _ar(node.isFinal, node.name, node.templateDecl, node.templateArgs, node.baseClasses,
+                node.derivedClasses, node.memberVariables, node.memberFunctions,
+                node.staticMemberVariables, node.staticMemberFunctions, node.constructors,
+                node.destructors, node.operators, node.friends, node.nestedTypes);
+            break;
+        }
+        case NodeKind::Class:
+        {
+            auto& node = static_cast<ClassNode&>(_node);
+            _ar(node.isFinal, node.name, node.templateDecl, node.templateArgs, node.baseClasses,
+                node.derivedClasses, node.memberVariables, node.memberFunctions,
+                node.staticMemberVariables, node.staticMemberFunctions, node.constructors,
+                node.destructors, node.operators, node.friends, node.nestedTypes);
+            break;
+        }
+        default:
+            // no node of the parser has these kinds
+            throw std::runtime_error("unsupported node kind " + nodeKindToString(_node.kind));
+    }
+}
+
+} // namespace codex
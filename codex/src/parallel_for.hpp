@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace codex
+{
+
+// One worker per hardware thread when none is asked for
+inline size_t resolveWorkerCount(size_t _workerCount)
+{
+    if (_workerCount > 0) return _workerCount;
+
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Runs _task(i) for every i in [0, _count) on at most _workerCount threads, the calling
+ * thread being one of them: the workers take the next index as they finish, so a batch of
+ * thousands of files costs the threads of the machine, not one thread per file.
+ *
+ * _task must not throw, the callers keep the error of each index instead.
+ */
+template <typename Task>
+void parallelFor(size_t _count, size_t _workerCount, Task&& _task)
+{
+    if (_count == 0) return;
+
+    const size_t threadCount = std::min(resolveWorkerCount(_workerCount), _count);
+
+    std::atomic<size_t> next = 0;
+    auto work = [&]()
+    {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < _count;
+             i = next.fetch_add(1, std::memory_order_relaxed))
+        {
+            _task(i);
+        }
+    };
+
+    std::vector<std::jthread> workers;
+    workers.reserve(threadCount - 1);
+
+    for (size_t i = 1; i < threadCount; ++i) workers.emplace_back(work);
+
+    work();
+}
+
+} // namespace codex
@@ -0,0 +1,490 @@
+#include "codex/parse_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "codex/node_arena.hpp"
+#include "codex/nodes.hpp"
+
+#include "node_fields.hpp"
+
+namespace codex
+{
+
+namespace
+{
+
+constexpr char k_magic[8] = {'C', 'D', 'X', 'P', 'A', 'R', 'S', 'E'};
+
+// Marks a null node where a node pointer is expected
+constexpr uint8_t k_nullNode = 0xFF;
+
+std::shared_ptr<Node> createNode(NodeArena& _arena, NodeKind _kind, int _startLine,
+                                 int _startColumn, int _endLine, int _endColumn)
+{
+    switch (_kind)
+    {
+        case NodeKind::Source:
+            return _arena.make<SourceNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Comment:
+            return _arena.make<CommentNode>("", _startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Template:
+            return _arena.make<TemplateNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::IncludeDirective:
+            return _arena.make<IncludeNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::ObjectLikeMacro:
+            return _arena.make<ObjectLikeMacroNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::FunctionLikeMacro:
+            return _arena.make<FunctionLikeMacroNode>(_startLine, _startColumn, _endLine,
+                                                      _endColumn);
+        case NodeKind::Namespace:
+            return _arena.make<NamespaceNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::NamespaceAlias:
+            return _arena.make<NamespaceAliasNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::UsingNamespace:
+            return _arena.make<UsingNamespaceNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Typedef:
+            return _arena.make<TypedefNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::TypeAlias:
+            return _arena.make<TypeAliasNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::EnumSpecifier:
+            return _arena.make<EnumNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Enum:
+            return _arena.make<EnumSpecifierNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Variable:
+            return _arena.make<VariableNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Concept:
+            return _arena.make<ConceptNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Function:
+            return _arena.make<FunctionNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Constructor:
+            return _arena.make<ConstructorNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Destructor:
+            return _arena.make<DestructorNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Operator:
+            return _arena.make<OperatorNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Union:
+            return _arena.make<UnionNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Friend:
+            return _arena.make<FriendNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Struct:
+            return _arena.make<StructNode>(_startLine, _startColumn, _endLine, _endColumn);
+        case NodeKind::Class:
+            return _arena.make<ClassNode>(_startLine, _startColumn, _endLine, _endColumn);
+        default:
+            throw std::runtime_error("unsupported node kind " + nodeKindToString(_kind));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Archives
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Native byte order: a cache file stays on the machine that wrote it
+class TreeWriter
+{
+   private:
+    std::string& m_bytes;
+
+   public:
+    explicit TreeWriter(std::string& _bytes) : m_bytes(_bytes) {}
+
+    template <typename... Ts>
+    void operator()(Ts&... _values)
+    {
+        (write(_values), ...);
+    }
+
+    void writeNode(Node& _node)
+    {
+        writeRaw(static_cast<uint8_t>(_node.kind));
+        writeRaw(_node.startLine);
+        writeRaw(_node.startColumn);
+        writeRaw(_node.endLine);
+        writeRaw(_node.endColumn);
+        write(_node.comment);
+
+        describeNode(*this, _node);
+    }
+
+   private:
+    template <typename T>
+    void writeRaw(T _value)
+    {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &_value, sizeof(T));
+        m_bytes.append(bytes, sizeof(T));
+    }
+
+    void write(bool _value) { writeRaw<uint8_t>(_value ? 1 : 0); }
+    void write(uint32_t _value) { writeRaw(_value); }
+    void write(AccessSpecifier _value) { writeRaw(static_cast<uint8_t>(_value)); }
+
+    void write(std::string& _value)
+    {
+        writeRaw(static_cast<uint32_t>(_value.size()));
+        m_bytes.append(_value);
+    }
+
+    template <typename A, typename B>
+    void write(std::pair<A, B>& _value)
+    {
+        write(_value.first);
+        write(_value.second);
+    }
+
+    template <typename T>
+    void write(std::vector<T>& _values)
+    {
+        writeRaw(static_cast<uint32_t>(_values.size()));
+        for (T& value : _values) write(value);
+    }
+
+    template <typename T>
+    void write(std::shared_ptr<T>& _node)
+    {
+        if (_node)
+        {
+            writeNode(*_node);
+        }
+        else
+        {
+            writeRaw(k_nullNode);
+        }
+    }
+
+    template <typename T>
+    void write(T& _value)
+    {
+        describe(*this, _value);
+    }
+};
+
+// Throws on data that ends early or holds a kind it does not know
+class TreeReader
+{
+   private:
+    std::string_view m_bytes;
+    size_t m_offset = 0;
+
+    NodeArena m_arena;
+
+   public:
+    explicit TreeReader(std::string_view _bytes) : m_bytes(_bytes) {}
+
+    template <typename... Ts>
+    void operator()(Ts&... _values)
+    {
+        (read(_values), ...);
+    }
+
+    [[nodiscard]] bool isAtEnd() const noexcept { return m_offset == m_bytes.size(); }
+
+   private:
+    void require(size_t _size)
+    {
+        if (m_bytes.size() - m_offset < _size) throw std::runtime_error("truncated tree");
+    }
+
+    template <typename T>
+    T readRaw()
+    {
+        require(sizeof(T));
+
+        T value;
+        std::memcpy(&value, m_bytes.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+
+        return value;
+    }
+
+    void read(bool& _value) { _value = readRaw<uint8_t>() != 0; }
+    void read(uint32_t& _value) { _value = readRaw<uint32_t>(); }
+
+    void read(AccessSpecifier& _value)
+    {
+        const uint8_t value = readRaw<uint8_t>();
+        if (value > static_cast<uint8_t>(AccessSpecifier::None))
+        {
+            throw std::runtime_error("invalid access specifier");
+        }
+
+        _value = static_cast<AccessSpecifier>(value);
+    }
+
+    void read(std::string& _value)
+    {
+        const uint32_t size = readRaw<uint32_t>();
+        require(size);
+
+        _value.assign(m_bytes.data() + m_offset, size);
+        m_offset += size;
+    }
+
+    template <typename A, typename B>
+    void read(std::pair<A, B>& _value)
+    {
+        read(_value.first);
+        read(_value.second);
+    }
+
+    template <typename T>
+    void read(std::vector<T>& _values)
+    {
+        const uint32_t size = readRaw<uint32_t>();
+
+        // every element takes a byte at least
+        require(size);
+
+        _values.clear();
+        _values.resize(size);
+        for (T& value : _values) read(value);
+    }
+
+    template <typename T>
+    void read(std::shared_ptr<T>& _node)
+    {
+        const uint8_t kind = readRaw<uint8_t>();
+        if (kind == k_nullNode)
+        {
+            _node = nullptr;
+            return;
+        }
+
+        const auto startLine = static_cast<int>(readRaw<uint32_t>());
+        const auto startColumn = static_cast<int>(readRaw<uint32_t>());
+        const auto endLine = static_cast<int>(readRaw<uint32_t>());
+        const auto endColumn = static_cast<int>(readRaw<uint32_t>());
+
+        std::shared_ptr<Node> node = createNode(m_arena, static_cast<NodeKind>(kind), startLine,
+                                                startColumn, endLine, endColumn);
+
+        read(node->comment);
+        describeNode(*this, *node);
+
+        _node = std::static_pointer_cast<T>(std::move(node));
+    }
+
+    template <typename T>
+    void read(T& _value)
+    {
+        describe(*this, _value);
+    }
+};
+
+template <typename T>
+void writeValue(std::ostream& _stream, const T& _value)
+{
+    _stream.write(reinterpret_cast<const char*>(&_value), sizeof(T));
+}
+
+void writeString(std::ostream& _stream, const std::string& _value)
+{
+    writeValue(_stream, static_cast<uint64_t>(_value.size()));
+    _stream.write(_value.data(), static_cast<std::streamsize>(_value.size()));
+}
+
+template <typename T>
+bool readValue(std::istream& _stream, T& _value)
+{
+    return static_cast<bool>(_stream.read(reinterpret_cast<char*>(&_value), sizeof(T)));
+}
+
+bool readString(std::istream& _stream, std::string& _value, uint64_t _remaining)
+{
+    uint64_t size = 0;
+    if (!readValue(_stream, size) || size > _remaining) return false;
+
+    _value.resize(size);
+    return static_cast<bool>(_stream.read(_value.data(), static_cast<std::streamsize>(size)));
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ParseCache
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ParseCache::ParseCache(std::filesystem::path _file) : m_file(std::move(_file)) {}
+
+bool ParseCache::load()
+{
+    std::unique_lock lock(m_mutex);
+    m_entries.clear();
+
+    std::error_code error;
+    const uint64_t fileSize = std::filesystem::file_size(m_file, error);
+    if (error) return false;
+
+    std::ifstream file(m_file, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    char magic[sizeof(k_magic)];
+    uint32_t version = 0;
+    uint64_t count = 0;
+
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, k_magic, sizeof(magic)) != 0 ||
+        !readValue(file, version) || version != k_formatVersion || !readValue(file, count))
+    {
+        return false;
+    }
+
+    std::unordered_map<std::string, Entry> entries;
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        std::string path;
+        Entry entry;
+
+        if (!readString(file, path, fileSize) || !readValue(file, entry.lastModifiedTime) ||
+            !readValue(file, entry.contentHash) || !readString(file, entry.tree, fileSize))
+        {
+            std::cerr << "Ignoring corrupt parse cache: " << m_file << "\n";
+            return false;
+        }
+
+        entries.insert_or_assign(std::move(path), std::move(entry));
+    }
+
+    m_entries = std::move(entries);
+    return true;
+}
+
+bool ParseCache::save() const
+{
+    std::shared_lock lock(m_mutex);
+
+    std::vector<const std::pair<const std::string, Entry>*> kept;
+    kept.reserve(m_entries.size());
+
+    for (const auto& entry : m_entries)
+    {
+        std::error_code error;
+        if (std::filesystem::exists(entry.first, error)) kept.push_back(&entry);
+    }
+
+    std::error_code error;
+    if (m_file.has_parent_path()) std::filesystem::create_directories(m_file.parent_path(), error);
+
+    // a run killed while saving must not leave a truncated cache behind
+    std::filesystem::path temporary = m_file;
+    temporary += ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        file.write(k_magic, sizeof(k_magic));
+        writeValue(file, k_formatVersion);
+        writeValue(file, static_cast<uint64_t>(kept.size()));
+
+        for (const auto* entry : kept)
+        {
+            writeString(file, entry->first);
+            writeValue(file, entry->second.lastModifiedTime);
+            writeValue(file, entry->second.contentHash);
+            writeString(file, entry->second.tree);
+        }
+
+        if (!file.flush()) return false;
+    }
+
+    std::filesystem::rename(temporary, m_file, error);
+    if (error)
+    {
+        std::cerr << "Failed to write parse cache " << m_file << ": " << error.message() << "\n";
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<SourceNode> ParseCache::find(const std::shared_ptr<Source>& _source)
+{
+    const uint64_t hash = hashContent(_source->getContent());
+
+    std::shared_lock lock(m_mutex);
+
+    auto it = m_entries.find(_source->path.string());
+    if (it == m_entries.end() || it->second.lastModifiedTime != _source->lastModifiedTime ||
+        it->second.contentHash != hash)
+    {
+        ++m_misses;
+        return nullptr;
+    }
+
+    try
+    {
+        TreeReader reader(it->second.tree);
+
+        std::shared_ptr<SourceNode> tree;
+        reader(tree);
+
+        if (!tree || tree->kind != NodeKind::Source || !reader.isAtEnd())
+        {
+            throw std::runtime_error("not a source tree");
+        }
+
+        tree->source = _source;
+
+        ++m_hits;
+        return tree;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Ignoring cached tree of " << _source->path << ": " << e.what() << "\n";
+    }
+
+    ++m_misses;
+    return nullptr;
+}
+
+void ParseCache::store(const Source& _source, const SourceNode& _tree)
+{
+    Entry entry{_source.lastModifiedTime, hashContent(_source.getContent()), {}};
+
+    try
+    {
+        // describe() hands out the fields by reference for the reader, the writer only reads them
+        TreeWriter writer(entry.tree);
+        writer.writeNode(const_cast<SourceNode&>(_tree));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Not caching the tree of " << _source.path << ": " << e.what() << "\n";
+        return;
+    }
+
+    std::unique_lock lock(m_mutex);
+    m_entries.insert_or_assign(_source.path.string(), std::move(entry));
+}
+
+size_t ParseCache::getEntryCount() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_entries.size();
+}
+
+uint64_t ParseCache::hashContent(std::string_view _content) noexcept
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for (const char c : _content)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+} // namespace codex
@@ -1,42 +1,228 @@
 #include "codex/parser.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
-#include <future>
 
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 #include <tree_sitter/api.h>
 
+#include "codex/node_arena.hpp"
 #include "codex/nodes.hpp"
 
+#include "node_fields.hpp"
+#include "parallel_for.hpp"
 #include "tree_sitter_cpp.hpp"
 
 namespace codex
 {
 
+namespace
+{
+
+// Adds a line delta to a node and everything under it, each node once however often it is shared
+class LineShifter
+{
+   private:
+    int64_t m_delta;
+    std::unordered_set<const Node*> m_visited;
+
+   public:
+    explicit LineShifter(int64_t _delta) : m_delta(_delta) {}
+
+    template <typename... Ts>
+    void operator()(Ts&... _values)
+    {
+        (visit(_values), ...);
+    }
+
+    void shift(Node& _node)
+    {
+        if (m_delta == 0 || !m_visited.insert(&_node).second) return;
+
+        _node.startLine = static_cast<uint32_t>(_node.startLine + m_delta);
+        _node.endLine = static_cast<uint32_t>(_node.endLine + m_delta);
+        visit(_node.comment);
+
+        describeNode(*this, _node);
+    }
+
+   private:
+    template <typename T>
+    void visit(std::shared_ptr<T>& _node)
+    {
+        if constexpr (std::is_base_of_v<Node, T>)
+        {
+            if (_node) shift(*_node);
+        }
+    }
+
+    template <typename T>
+    void visit(std::vector<T>& _values)
+    {
+        for (T& value : _values) visit(value);
+    }
+
+    template <typename A, typename B>
+    void visit(std::pair<A, B>& _value)
+    {
+        visit(_value.first);
+        visit(_value.second);
+    }
+
+    // plain fields hold no node
+    template <typename T>
+    void visit(T& _value)
+    {
+        (void)_value;
+    }
+};
+
+} // namespace
+
+/**
+ * @brief The declarations of the previous tree of a source an incremental parse carries over:
+ * those the edit and the reparse left alone, found by their start byte before the edit. A
+ * declaration is taken again when the edit touches it or the gap before it (where its comment
+ * lives), or when it follows a comment that is parsed again, or starts on the last line of the
+ * edit (its columns moved).
+ */
+class UnitReuse
+{
+   private:
+    const std::unordered_map<uint32_t, std::shared_ptr<Node>>& m_previous;
+    const TSInputEdit* m_edit;
+    std::vector<TSRange> m_changed;
+    LineShifter m_shifter;
+
+   public:
+    // The declarations of the new tree by start byte, for the next update
+    std::unordered_map<uint32_t, std::shared_ptr<Node>> units;
+    std::unordered_set<const Node*> reused;
+    std::vector<std::shared_ptr<Node>> dispatched;
+
+   public:
+    // Without an edit nothing is carried over: the first parse of a source
+    UnitReuse(const std::unordered_map<uint32_t, std::shared_ptr<Node>>& _previous,
+              const TSInputEdit* _edit)
+        : m_previous(_previous),
+          m_edit(_edit),
+          m_shifter(_edit ? static_cast<int64_t>(_edit->new_end_point.row) -
+                                static_cast<int64_t>(_edit->old_end_point.row)
+                          : 0)
+    {
+    }
+
+   public:
+    // The ranges tree-sitter reports changed by the reparse
+    void setChangedRanges(std::vector<TSRange> _changed) { m_changed = std::move(_changed); }
+
+    // The node of the previous tree for the declaration, null if it must be parsed again
+    std::shared_ptr<Node> take(TSNode _unit)
+    {
+        if (!m_edit) return nullptr;
+
+        std::string_view type = ts_node_type(_unit);
+
+        // comments are always parsed again to be handed as leading comments, namespaces rebuilt
+        if (type == "comment" || type == "namespace_definition") return nullptr;
+
+        const uint32_t start = ts_node_start_byte(_unit);
+        const uint32_t end = ts_node_end_byte(_unit);
+
+        TSNode previous = ts_node_prev_sibling(_unit);
+        const uint32_t gapStart = ts_node_is_null(previous) ? start : ts_node_end_byte(previous);
+
+        const bool before = end <= m_edit->start_byte;
+        const bool after = gapStart >= m_edit->new_end_byte &&
+                           ts_node_start_point(_unit).row > m_edit->new_end_point.row;
+
+        if (!before && !after) return nullptr;
+        if (isReparsed(gapStart, end)) return nullptr;
+
+        // its leading comment was edited
+        if (!ts_node_is_null(previous) && std::string_view(ts_node_type(previous)) == "comment" &&
+            (!isCarried(previous) ||
+             isReparsed(ts_node_start_byte(previous), ts_node_end_byte(previous))))
+        {
+            return nullptr;
+        }
+
+        const uint32_t oldStart =
+            after ? start - m_edit->new_end_byte + m_edit->old_end_byte : start;
+
+        auto it = m_previous.find(oldStart);
+        if (it == m_previous.end()) return nullptr;
+
+        if (after) m_shifter.shift(*it->second);
+
+        units.emplace(start, it->second);
+        reused.insert(it->second.get());
+
+        return it->second;
+    }
+
+    void record(TSNode _unit, const std::shared_ptr<Node>& _node)
+    {
+        units.emplace(ts_node_start_byte(_unit), _node);
+        dispatched.emplace_back(_node);
+    }
+
+   private:
+    // Whether tree-sitter reports the bytes changed by the reparse
+    bool isReparsed(uint32_t _start, uint32_t _end) const
+    {
+        return std::any_of(m_changed.begin(), m_changed.end(), [&](const TSRange& _range)
+                           { return _start < _range.end_byte && _range.start_byte < _end; });
+    }
+
+    // Whether the node stands wholly before or after the edit
+    bool isCarried(TSNode _node) const
+    {
+        return ts_node_end_byte(_node) <= m_edit->start_byte ||
+               ts_node_start_byte(_node) >= m_edit->new_end_byte;
+    }
+};
+
 class SingleParser
 {
    private:
     TSParser* m_parser;
     std::shared_ptr<Source> m_source;
+    std::string_view m_content; // mapped or read, see Source::getContent()
+    NodeArena m_arena;
     std::shared_ptr<CommentNode> m_leadingComment;
     std::shared_ptr<TemplateNode> m_templateDeclaration;
+    UnitReuse* m_reuse = nullptr;
 
    public:
     SingleParser(const std::shared_ptr<Source>& _source);
+    // _content is the text of _source to parse, alive as long as the parser
+    SingleParser(const std::shared_ptr<Source>& _source, std::string_view _content);
     ~SingleParser();
 
    public:
     std::shared_ptr<SourceNode> parse();
 
+    // The tree-sitter tree of the text, _oldTree (if any) edited beforehand; the caller owns it
+    TSTree* parseTree(const TSTree* _oldTree);
+    // The tree of _tree, the declarations _reuse holds carried over and the others recorded in it
+    std::shared_ptr<SourceNode> build(TSTree* _tree, UnitReuse* _reuse);
+
    private:
+    // The declarations directly under _list (the root, a namespace body)
+    void dispatchUnits(TSNode _list, std::vector<std::shared_ptr<Node>>& _nodes);
     std::shared_ptr<Node> dispatch(TSNode _node);
 
     // Dependent nodes (requiring to be linked to other nodes and leaving outisde the main tree)
@@ -102,7 +288,13 @@ class SingleParser
     std::vector<TemplateArgument> parseTemplateArgumentsList(const TSNode& _node);
 };
 
-SingleParser::SingleParser(const std::shared_ptr<Source>& _source) : m_source(_source)
+SingleParser::SingleParser(const std::shared_ptr<Source>& _source)
+    : SingleParser(_source, _source->getContent())
+{
+}
+
+SingleParser::SingleParser(const std::shared_ptr<Source>& _source, std::string_view _content)
+    : m_source(_source), m_content(_content)
 {
     m_parser = ts_parser_new();
 
@@ -118,29 +310,73 @@ SingleParser::~SingleParser() { ts_parser_delete(m_parser); }
 
 std::shared_ptr<SourceNode> SingleParser::parse()
 {
-    TSTree* tree = ts_parser_parse_string(m_parser, nullptr, m_source->content.c_str(),
-                                          static_cast<uint32_t>(m_source->content.size()));
+    TSTree* tree = parseTree(nullptr);
+    auto srcNode = build(tree, nullptr);
+
+    ts_tree_delete(tree);
+
+    return srcNode;
+}
+
+TSTree* SingleParser::parseTree(const TSTree* _oldTree)
+{
+    // an empty mapping has no data at all
+    const char* text = m_content.empty() ? "" : m_content.data();
+
+    TSTree* tree = ts_parser_parse_string(m_parser, _oldTree, text,
+                                          static_cast<uint32_t>(m_content.size()));
+
+    if (!tree) throw std::runtime_error("Failed to parse " + m_source->path.string());
+
+    return tree;
+}
+
+std::shared_ptr<SourceNode> SingleParser::build(TSTree* _tree, UnitReuse* _reuse)
+{
+    m_reuse = _reuse;
 
-    TSNode root = ts_tree_root_node(tree);
+    TSNode root = ts_tree_root_node(_tree);
     TSPoint rootEnd = ts_node_end_point(root);
-    auto srcNode = std::make_shared<SourceNode>(0, 0, static_cast<int>(rootEnd.row),
+    auto srcNode = m_arena.make<SourceNode>(0, 0, static_cast<int>(rootEnd.row),
                                                 static_cast<int>(rootEnd.column));
 
     srcNode->source = m_source;
 
-    uint32_t childCount = ts_node_child_count(root);
+    dispatchUnits(root, srcNode->children);
+
+    m_reuse = nullptr;
+
+    return srcNode;
+}
+
+void SingleParser::dispatchUnits(TSNode _list, std::vector<std::shared_ptr<Node>>& _nodes)
+{
+    uint32_t childCount = ts_node_child_count(_list);
 
     for (uint32_t i = 0; i < childCount; ++i)
     {
-        TSNode child = ts_node_child(root, i);
-        auto childNode = dispatch(child);
+        TSNode child = ts_node_child(_list, i);
 
-        if (childNode) srcNode->children.emplace_back(childNode);
-    }
+        if (m_reuse)
+        {
+            if (auto reused = m_reuse->take(child))
+            {
+                // consumed by the declaration when it was parsed
+                clearLeadingComment();
+                clearTemplateDeclaration();
 
-    ts_tree_delete(tree);
+                _nodes.emplace_back(std::move(reused));
+                continue;
+            }
+        }
 
-    return srcNode;
+        auto childNode = dispatch(child);
+        if (!childNode) continue;
+
+        if (m_reuse && childNode->kind != NodeKind::Namespace) m_reuse->record(child, childNode);
+
+        _nodes.emplace_back(std::move(childNode));
+    }
 }
 
 std::shared_ptr<Node> SingleParser::dispatch(TSNode _node)
@@ -174,16 +410,7 @@ std::shared_ptr<Node> SingleParser::dispatch(TSNode _node)
             TSNode child = ts_node_child(_node, i);
             std::string childType = ts_node_type(child);
 
-            if (childType == "declaration_list")
-            {
-                uint32_t subChildCount = ts_node_child_count(child);
-
-                for (uint32_t j = 0; j < subChildCount; ++j)
-                {
-                    auto subChild = dispatch(ts_node_child(child, j));
-                    if (subChild) ns->children.emplace_back(subChild);
-                }
-            }
+            if (childType == "declaration_list") dispatchUnits(child, ns->children);
         }
 
         return ns;
@@ -258,10 +485,10 @@ std::shared_ptr<CommentNode> SingleParser::parseComment(const TSNode& _node)
 {
     auto [start, end] = getPositionData(_node);
 
-    auto text = m_source->content.substr(ts_node_start_byte(_node),
-                                         ts_node_end_byte(_node) - ts_node_start_byte(_node));
+    auto text = std::string(m_content.substr(ts_node_start_byte(_node),
+                                             ts_node_end_byte(_node) - ts_node_start_byte(_node)));
 
-    return std::make_shared<CommentNode>(text, start.row, start.column, end.row, end.column);
+    return m_arena.make<CommentNode>(text, start.row, start.column, end.row, end.column);
 }
 
 std::shared_ptr<TemplateNode> SingleParser::parseTemplate(const TSNode& _node)
@@ -270,7 +497,7 @@ std::shared_ptr<TemplateNode> SingleParser::parseTemplate(const TSNode& _node)
     const uint32_t childCount = ts_node_child_count(_node);
 
     auto templateDeclNode =
-        std::make_shared<TemplateNode>(start.row, start.column, end.row, end.column);
+        m_arena.make<TemplateNode>(start.row, start.column, end.row, end.column);
 
     for (uint32_t i = 0; i < childCount; ++i)
     {
@@ -298,11 +525,11 @@ std::shared_ptr<TemplateNode> SingleParser::parseTemplate(const TSNode& _node)
 
                         if (subType == "typename" || subType == "class")
                         {
-                            tp.keyword = getNodeText(sub, m_source->content);
+                            tp.keyword = getNodeText(sub, m_content);
                         }
                         else if (subType == "type_identifier")
                         {
-                            tp.name = getNodeText(sub, m_source->content);
+                            tp.name = getNodeText(sub, m_content);
                         }
                     }
                 }
@@ -317,11 +544,11 @@ std::shared_ptr<TemplateNode> SingleParser::parseTemplate(const TSNode& _node)
 
                         if (subType == "class" || subType == "typename")
                         {
-                            tp.keyword = getNodeText(sub, m_source->content);
+                            tp.keyword = getNodeText(sub, m_content);
                         }
                         else if (subType == "type_identifier")
                         {
-                            tp.name = getNodeText(sub, m_source->content);
+                            tp.name = getNodeText(sub, m_content);
                         }
                     }
                 }
@@ -372,7 +599,7 @@ std::shared_ptr<IncludeNode> SingleParser::parseInclude(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     uint32_t childCount = ts_node_child_count(_node);
 
-    auto incNode = std::make_shared<IncludeNode>(start.row, start.column, end.row, end.column);
+    auto incNode = m_arena.make<IncludeNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     incNode->comment = getLeadingComment();
@@ -381,7 +608,7 @@ std::shared_ptr<IncludeNode> SingleParser::parseInclude(const TSNode& _node)
     {
         TSNode child = ts_node_child(_node, i);
         std::string type = ts_node_type(child);
-        std::string text = getNodeText(child, m_source->content);
+        std::string text = getNodeText(child, m_content);
 
         if (type == "system_lib_string")
         {
@@ -404,7 +631,7 @@ std::shared_ptr<ObjectLikeMacroNode> SingleParser::parseObjectLikeMacro(const TS
     const uint32_t childCount = ts_node_child_count(_node);
 
     auto objMacroNode =
-        std::make_shared<ObjectLikeMacroNode>(start.row, start.column, end.row, end.column);
+        m_arena.make<ObjectLikeMacroNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     objMacroNode->comment = getLeadingComment();
@@ -416,11 +643,11 @@ std::shared_ptr<ObjectLikeMacroNode> SingleParser::parseObjectLikeMacro(const TS
 
         if (childType == "identifier" && objMacroNode->name.empty())
         {
-            objMacroNode->name = getNodeText(child, m_source->content);
+            objMacroNode->name = getNodeText(child, m_content);
         }
         else if (childType == "preproc_arg")
         {
-            objMacroNode->body = getNodeText(child, m_source->content);
+            objMacroNode->body = getNodeText(child, m_content);
         }
     }
 
@@ -433,7 +660,7 @@ std::shared_ptr<FunctionLikeMacroNode> SingleParser::parseFunctionLikeMacro(cons
     const uint32_t childCount = ts_node_child_count(_node);
 
     auto fnMacroNode =
-        std::make_shared<FunctionLikeMacroNode>(start.row, start.column, end.row, end.column);
+        m_arena.make<FunctionLikeMacroNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     fnMacroNode->comment = getLeadingComment();
@@ -445,7 +672,7 @@ std::shared_ptr<FunctionLikeMacroNode> SingleParser::parseFunctionLikeMacro(cons
 
         if (childType == "identifier" && fnMacroNode->name.empty())
         {
-            fnMacroNode->name = getNodeText(child, m_source->content);
+            fnMacroNode->name = getNodeText(child, m_content);
         }
         else if (childType == "preproc_params")
         {
@@ -460,7 +687,7 @@ std::shared_ptr<FunctionLikeMacroNode> SingleParser::parseFunctionLikeMacro(cons
 
                 if (paramType == "identifier")
                 {
-                    mp.name = getNodeText(param, m_source->content);
+                    mp.name = getNodeText(param, m_content);
                 }
                 else if (paramType == "...")
                 {
@@ -473,7 +700,7 @@ std::shared_ptr<FunctionLikeMacroNode> SingleParser::parseFunctionLikeMacro(cons
         }
         else if (childType == "preproc_arg")
         {
-            fnMacroNode->body = getNodeText(child, m_source->content);
+            fnMacroNode->body = getNodeText(child, m_content);
         }
     }
 
@@ -494,7 +721,7 @@ std::shared_ptr<NamespaceNode> SingleParser::parseNamespace(const TSNode& _node)
 
             if (type == "namespace_identifier")
             {
-                out.emplace_back(getNodeText(child, m_source->content));
+                out.emplace_back(getNodeText(child, m_content));
             }
             else if (type == "nested_namespace_specifier")
             {
@@ -506,7 +733,7 @@ std::shared_ptr<NamespaceNode> SingleParser::parseNamespace(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto nsNode = std::make_shared<NamespaceNode>(start.row, start.column, end.row, end.column);
+    auto nsNode = m_arena.make<NamespaceNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     nsNode->comment = getLeadingComment();
@@ -523,7 +750,7 @@ std::shared_ptr<NamespaceNode> SingleParser::parseNamespace(const TSNode& _node)
         else if (type == "namespace_identifier")
         {
             // e.g. "mynamespace"
-            nsNode->name = getNodeText(child, m_source->content);
+            nsNode->name = getNodeText(child, m_content);
             nsNode->isAnonymous = false;
         }
         else if (type == "nested_namespace_specifier")
@@ -547,7 +774,7 @@ std::shared_ptr<NamespaceAliasNode> SingleParser::parseNamespaceAlias(const TSNo
     const uint32_t childCount = ts_node_child_count(_node);
 
     auto nsAliasNode =
-        std::make_shared<NamespaceAliasNode>(start.row, start.column, end.row, end.column);
+        m_arena.make<NamespaceAliasNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     nsAliasNode->comment = getLeadingComment();
@@ -561,12 +788,12 @@ std::shared_ptr<NamespaceAliasNode> SingleParser::parseNamespaceAlias(const TSNo
         {
             if (nsAliasNode->aliasName.empty())
             {
-                nsAliasNode->aliasName = getNodeText(child, m_source->content); // first is alias
+                nsAliasNode->aliasName = getNodeText(child, m_content); // first is alias
             }
             else
             {
                 nsAliasNode->targetNamespace =
-                    getNodeText(child, m_source->content); // second is target
+                    getNodeText(child, m_content); // second is target
             }
         }
     }
@@ -580,7 +807,7 @@ std::shared_ptr<UsingNamespaceNode> SingleParser::parseUsingNamespace(const TSNo
     const uint32_t childCount = ts_node_child_count(_node);
 
     auto usingNsNode =
-        std::make_shared<UsingNamespaceNode>(start.row, start.column, end.row, end.column);
+        m_arena.make<UsingNamespaceNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     usingNsNode->comment = getLeadingComment();
@@ -592,7 +819,7 @@ std::shared_ptr<UsingNamespaceNode> SingleParser::parseUsingNamespace(const TSNo
 
         if (childType == "namespace" || childType == "identifier")
         {
-            usingNsNode->name = getNodeText(child, m_source->content);
+            usingNsNode->name = getNodeText(child, m_content);
         }
     }
 
@@ -604,7 +831,7 @@ std::shared_ptr<TypedefNode> SingleParser::parseTypedef(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     uint32_t childCount = ts_node_child_count(_node);
 
-    auto typedefNode = std::make_shared<TypedefNode>(start.row, start.column, end.row, end.column);
+    auto typedefNode = m_arena.make<TypedefNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     typedefNode->comment = getLeadingComment();
@@ -617,18 +844,18 @@ std::shared_ptr<TypedefNode> SingleParser::parseTypedef(const TSNode& _node)
         if (type == "primitive_type")
         {
             // e.g. "int"
-            typedefNode->targetType = getNodeText(child, m_source->content);
+            typedefNode->targetType = getNodeText(child, m_content);
         }
         else if (type == "struct_specifier" || type == "class_specifier" ||
                  type == "union_specifier")
         {
             // e.g. "struct MyStruct { ... }"
-            typedefNode->targetType = getNodeText(child, m_source->content);
+            typedefNode->targetType = getNodeText(child, m_content);
         }
         else if (type == "type_identifier")
         {
             // e.g. "MyType"
-            typedefNode->aliasName = getNodeText(child, m_source->content);
+            typedefNode->aliasName = getNodeText(child, m_content);
         }
     }
 
@@ -640,8 +867,7 @@ std::shared_ptr<TypeAliasNode> SingleParser::parseTypeAlias(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto typeAliasNode =
-        std::make_shared<TypeAliasNode>(start.row, start.column, end.row, end.column);
+    auto typeAliasNode = m_arena.make<TypeAliasNode>(start.row, start.column, end.row, end.column);
 
     typeAliasNode->templateDecl = getTemplateDeclaration();
     typeAliasNode->comment = getLeadingComment();
@@ -653,12 +879,12 @@ std::shared_ptr<TypeAliasNode> SingleParser::parseTypeAlias(const TSNode& _node)
 
         if (childType == "type_identifier")
         {
-            typeAliasNode->aliasName = getNodeText(child, m_source->content);
+            typeAliasNode->aliasName = getNodeText(child, m_content);
         }
         else if (childType == "type_descriptor" || childType == "primitive_type" ||
                  childType == "identifier")
         {
-            typeAliasNode->targetType = getNodeText(child, m_source->content);
+            typeAliasNode->targetType = getNodeText(child, m_content);
         }
     }
 
@@ -670,7 +896,7 @@ std::shared_ptr<EnumNode> SingleParser::parseEnum(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto enumNode = std::make_shared<EnumNode>(start.row, start.column, end.row, end.column);
+    auto enumNode = m_arena.make<EnumNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     enumNode->comment = getLeadingComment();
@@ -682,7 +908,7 @@ std::shared_ptr<EnumNode> SingleParser::parseEnum(const TSNode& _node)
 
         if (type == "type_identifier")
         {
-            enumNode->name = getNodeText(child, m_source->content);
+            enumNode->name = getNodeText(child, m_content);
         }
         else if (type == "class")
         {
@@ -690,7 +916,7 @@ std::shared_ptr<EnumNode> SingleParser::parseEnum(const TSNode& _node)
         }
         else if (type == "primitive_type")
         {
-            enumNode->underlyingType = getNodeText(child, m_source->content);
+            enumNode->underlyingType = getNodeText(child, m_content);
         }
         else if (type == "enumerator_list")
         {
@@ -721,17 +947,17 @@ std::shared_ptr<EnumNode> SingleParser::parseEnum(const TSNode& _node)
                         if (pType == "identifier")
                         {
                             // e.g. "VALUE1"
-                            enumName = getNodeText(part, m_source->content);
+                            enumName = getNodeText(part, m_content);
                         }
                         else if (pType == "number_literal" || pType == "string_literal")
                         {
                             // e.g. "42" or "\"value\""
-                            enumValue = getNodeText(part, m_source->content);
+                            enumValue = getNodeText(part, m_content);
                         }
                     }
 
                     auto enumSpecNode =
-                        std::make_shared<EnumSpecifierNode>(s.row, s.column, e.row, e.column);
+                        m_arena.make<EnumSpecifierNode>(s.row, s.column, e.row, e.column);
 
                     enumSpecNode->name = enumName;
                     enumSpecNode->value = enumValue;
@@ -750,7 +976,7 @@ std::shared_ptr<ConceptNode> SingleParser::parseConcept(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto conceptNode = std::make_shared<ConceptNode>(start.row, start.column, end.row, end.column);
+    auto conceptNode = m_arena.make<ConceptNode>(start.row, start.column, end.row, end.column);
 
     conceptNode->comment = getLeadingComment();
     conceptNode->templateDecl = getTemplateDeclaration();
@@ -763,13 +989,13 @@ std::shared_ptr<ConceptNode> SingleParser::parseConcept(const TSNode& _node)
         if (childType == "identifier")
         {
             // e.g. "Integral"
-            conceptNode->name = getNodeText(child, m_source->content);
+            conceptNode->name = getNodeText(child, m_content);
         }
         else if (childType == "qualified_identifier" || childType == "identifier" ||
                  childType == "template_function")
         {
             // Entire constraint expression just grab text
-            conceptNode->constraint = getNodeText(child, m_source->content);
+            conceptNode->constraint = getNodeText(child, m_content);
         }
     }
 
@@ -781,7 +1007,7 @@ std::shared_ptr<VariableNode> SingleParser::parseVariable(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto varNode = std::make_shared<VariableNode>(start.row, start.column, end.row, end.column);
+    auto varNode = m_arena.make<VariableNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     varNode->comment = getLeadingComment();
@@ -793,11 +1019,11 @@ std::shared_ptr<VariableNode> SingleParser::parseVariable(const TSNode& _node)
 
         if (childType == "identifier" || childType == "field_identifier")
         {
-            varNode->name = getNodeText(child, m_source->content);
+            varNode->name = getNodeText(child, m_content);
         }
         else if (childType == "type_qualifier")
         {
-            std::string q = getNodeText(child, m_source->content);
+            std::string q = getNodeText(child, m_content);
 
             if (q == "const")
                 varNode->isConst = true;
@@ -820,7 +1046,7 @@ std::shared_ptr<VariableNode> SingleParser::parseVariable(const TSNode& _node)
         }
         else if (childType == "primitive_type" || childType == "type_identifier")
         {
-            varNode->type = getNodeText(child, m_source->content);
+            varNode->type = getNodeText(child, m_content);
         }
         else if (childType == "init_declarator")
         {
@@ -842,11 +1068,11 @@ void SingleParser::parseInitDeclarator(const TSNode& _node, std::shared_ptr<Vari
 
         if (type == "identifier" || type == "field_identifier")
         {
-            _varNode->name = getNodeText(child, m_source->content);
+            _varNode->name = getNodeText(child, m_content);
         }
         else if (type == "number_literal" || type == "string_literal")
         {
-            _varNode->initialValue = getNodeText(child, m_source->content);
+            _varNode->initialValue = getNodeText(child, m_content);
         }
         else if (type == "reference_declarator" || type == "pointer_declarator")
         {
@@ -859,11 +1085,11 @@ void SingleParser::parseInitDeclarator(const TSNode& _node, std::shared_ptr<Vari
 
                 if (subType == "identifier")
                 {
-                    _varNode->name = getNodeText(subChild, m_source->content);
+                    _varNode->name = getNodeText(subChild, m_content);
                 }
                 else if (subType == "number_literal" || subType == "string_literal")
                 {
-                    _varNode->initialValue = getNodeText(subChild, m_source->content);
+                    _varNode->initialValue = getNodeText(subChild, m_content);
                 }
             }
         }
@@ -875,7 +1101,7 @@ std::shared_ptr<FunctionNode> SingleParser::parseFunction(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto fnNode = std::make_shared<FunctionNode>(start.row, start.column, end.row, end.column);
+    auto fnNode = m_arena.make<FunctionNode>(start.row, start.column, end.row, end.column);
 
     fnNode->comment = getLeadingComment();
     fnNode->templateDecl = getTemplateDeclaration();
@@ -888,17 +1114,17 @@ std::shared_ptr<FunctionNode> SingleParser::parseFunction(const TSNode& _node)
 
         if (type == "attribute_declaration")
         {
-            fnNode->attributes.emplace_back(getNodeText(child, m_source->content));
+            fnNode->attributes.emplace_back(getNodeText(child, m_content));
         }
         else if (type == "storage_class_specifier")
         {
-            std::string txt = getNodeText(child, m_source->content);
+            std::string txt = getNodeText(child, m_content);
             if (txt == "static") fnNode->isStatic = true;
             if (txt == "inline") fnNode->isInline = true;
         }
         else if (type == "type_qualifier")
         {
-            std::string txt = getNodeText(child, m_source->content);
+            std::string txt = getNodeText(child, m_content);
             if (txt == "constexpr") fnNode->isConstexpr = true;
             if (txt == "consteval") fnNode->isConsteval = true;
             if (txt == "const") fnNode->isConst = true;
@@ -941,7 +1167,7 @@ void SingleParser::parseFunctionDeclarator(const TSNode& _node, std::shared_ptr<
 
         if (type == "identifier" || type == "field_identifier" || type == "destructor_name")
         {
-            _fn->name = getNodeText(child, m_source->content);
+            _fn->name = getNodeText(child, m_content);
         }
         else if (type == "template_function" || type == "template_method")
         {
@@ -987,7 +1213,7 @@ std::shared_ptr<OperatorNode> SingleParser::parseOperator(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto opNode = std::make_shared<OperatorNode>(start.row, start.column, end.row, end.column);
+    auto opNode = m_arena.make<OperatorNode>(start.row, start.column, end.row, end.column);
 
     opNode->comment = getLeadingComment();
     opNode->templateDecl = getTemplateDeclaration();
@@ -1004,13 +1230,13 @@ std::shared_ptr<OperatorNode> SingleParser::parseOperator(const TSNode& _node)
         }
         else if (type == "storage_class_specifier")
         {
-            std::string txt = getNodeText(child, m_source->content);
+            std::string txt = getNodeText(child, m_content);
             if (txt == "static") opNode->isStatic = true;
             if (txt == "inline") opNode->isInline = true;
         }
         else if (type == "type_qualifier")
         {
-            std::string text = getNodeText(child, m_source->content);
+            std::string text = getNodeText(child, m_content);
             if (text == "const") opNode->isConst = true;
             if (text == "constexpr") opNode->isConstexpr = true;
             if (text == "explicit") opNode->isExplicit = true;
@@ -1032,7 +1258,7 @@ void SingleParser::parseOperatorDeclarator(const TSNode& _node, std::shared_ptr<
         if (type == "operator_name")
         {
             _op->operatorSymbol =
-                getNodeText(child, m_source->content).substr(8); // remove "operator"
+                getNodeText(child, m_content).substr(8); // remove "operator"
         }
         else if (type == "parameter_list")
         {
@@ -1073,10 +1299,11 @@ void SingleParser::parseOperatorDeclarator(const TSNode& _node, std::shared_ptr<
     }
 }
 
-auto toConstructorNode = [](const std::shared_ptr<FunctionNode>& func)
+std::shared_ptr<ConstructorNode> toConstructorNode(NodeArena& _arena,
+                                                   const std::shared_ptr<FunctionNode>& func)
 {
-    auto ctor = std::make_shared<ConstructorNode>(func->startLine, func->startColumn, func->endLine,
-                                                  func->endColumn);
+    auto ctor = _arena.make<ConstructorNode>(func->startLine, func->startColumn, func->endLine,
+                                             func->endColumn);
 
     ctor->name = func->name;
 
@@ -1094,12 +1321,13 @@ auto toConstructorNode = [](const std::shared_ptr<FunctionNode>& func)
 
     ctor->comment = func->comment;
     return ctor;
-};
+}
 
-auto toDestructorNode = [](const std::shared_ptr<FunctionNode>& func)
+std::shared_ptr<DestructorNode> toDestructorNode(NodeArena& _arena,
+                                                 const std::shared_ptr<FunctionNode>& func)
 {
-    auto dtor = std::make_shared<DestructorNode>(func->startLine, func->startColumn, func->endLine,
-                                                 func->endColumn);
+    auto dtor = _arena.make<DestructorNode>(func->startLine, func->startColumn, func->endLine,
+                                            func->endColumn);
 
     dtor->name = func->name;
 
@@ -1114,14 +1342,14 @@ auto toDestructorNode = [](const std::shared_ptr<FunctionNode>& func)
 
     dtor->comment = func->comment;
     return dtor;
-};
+}
 
 std::shared_ptr<UnionNode> SingleParser::parseUnion(const TSNode& _node)
 {
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto unionNode = std::make_shared<UnionNode>(start.row, start.column, end.row, end.column);
+    auto unionNode = m_arena.make<UnionNode>(start.row, start.column, end.row, end.column);
 
     unionNode->comment = getLeadingComment();
     unionNode->templateDecl = getTemplateDeclaration();
@@ -1133,7 +1361,7 @@ std::shared_ptr<UnionNode> SingleParser::parseUnion(const TSNode& _node)
 
         if (childType == "type_identifier")
         {
-            unionNode->name = getNodeText(child, m_source->content);
+            unionNode->name = getNodeText(child, m_content);
         }
         else if (childType == "template_type")
         {
@@ -1141,7 +1369,7 @@ std::shared_ptr<UnionNode> SingleParser::parseUnion(const TSNode& _node)
 
             if (subChildCount == 0) continue;
 
-            auto text = getNodeText(ts_node_child(child, 0), m_source->content);
+            auto text = getNodeText(ts_node_child(child, 0), m_content);
 
             unionNode->name = text;
         }
@@ -1174,7 +1402,7 @@ std::shared_ptr<Node> SingleParser::parseFriend(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto friendNode = std::make_shared<FriendNode>(start.row, start.column, end.row, end.column);
+    auto friendNode = m_arena.make<FriendNode>(start.row, start.column, end.row, end.column);
 
     clearTemplateDeclaration();
     friendNode->comment = getLeadingComment();
@@ -1186,11 +1414,11 @@ std::shared_ptr<Node> SingleParser::parseFriend(const TSNode& _node)
 
         if (childType == "struct" || childType == "class")
         {
-            friendNode->kind = getNodeText(child, m_source->content);
+            friendNode->kind = getNodeText(child, m_content);
         }
         else if (childType == "type_identifier" || childType == "qualified_identifier")
         {
-            friendNode->name = getNodeText(child, m_source->content);
+            friendNode->name = getNodeText(child, m_content);
         }
     }
 
@@ -1202,7 +1430,7 @@ std::shared_ptr<StructNode> SingleParser::parseStruct(const TSNode& _node)
     auto [start, end] = getPositionData(_node);
     const uint32_t childCount = ts_node_child_count(_node);
 
-    auto structNode = std::make_shared<StructNode>(start.row, start.column, end.row, end.column);
+    auto structNode = m_arena.make<StructNode>(start.row, start.column, end.row, end.column);
 
     structNode->comment = getLeadingComment();
     structNode->templateDecl = getTemplateDeclaration();
@@ -1214,7 +1442,7 @@ std::shared_ptr<StructNode> SingleParser::parseStruct(const TSNode& _node)
 
         if (childType == "type_identifier")
         {
-            structNode->name = getNodeText(child, m_source->content);
+            structNode->name = getNodeText(child, m_content);
         }
         else if (childType == "template_type")
         {
@@ -1222,7 +1450,7 @@ std::shared_ptr<StructNode> SingleParser::parseStruct(const TSNode& _node)
 
             if (subChildCount == 0) continue;
 
-            auto text = getNodeText(ts_node_child(child, 0), m_source->content);
+            auto text = getNodeText(ts_node_child(child, 0), m_content);
 
             structNode->name = text;
         }
@@ -1244,13 +1472,13 @@ std::shared_ptr<StructNode> SingleParser::parseStruct(const TSNode& _node)
 
                 if (baseType == "qualified_identifier" || baseType == "type_identifier")
                 {
-                    structNode->baseClasses.emplace_back(getNodeText(baseNode, m_source->content));
+                    structNode->baseClasses.emplace_back(getNodeText(baseNode, m_content));
                 }
             }
         }
         else if (childType == "virtual_specifier")
         {
-            structNode->isFinal = getNodeText(child, m_source->content) == "final";
+            structNode->isFinal = getNodeText(child, m_content) == "final";
         }
         else if (childType == "field_declaration_list")
         {
@@ -1268,7 +1496,7 @@ std::shared_ptr<StructNode> SingleParser::parseStruct(const TSNode& _node)
 std::shared_ptr<ClassNode> SingleParser::parseClass(const TSNode& _node)
 {
     auto [start, end] = getPositionData(_node);
-    auto classNode = std::make_shared<ClassNode>(start.row, start.column, end.row, end.column);
+    auto classNode = m_arena.make<ClassNode>(start.row, start.column, end.row, end.column);
 
     const uint32_t childCount = ts_node_child_count(_node);
 
@@ -1282,7 +1510,7 @@ std::shared_ptr<ClassNode> SingleParser::parseClass(const TSNode& _node)
 
         if (childType == "type_identifier")
         {
-            classNode->name = getNodeText(child, m_source->content);
+            classNode->name = getNodeText(child, m_content);
         }
         else if (childType == "template_type")
         {
@@ -1290,7 +1518,7 @@ std::shared_ptr<ClassNode> SingleParser::parseClass(const TSNode& _node)
 
             if (subChildCount == 0) continue;
 
-            auto text = getNodeText(ts_node_child(child, 0), m_source->content);
+            auto text = getNodeText(ts_node_child(child, 0), m_content);
 
             classNode->name = text;
         }
@@ -1303,7 +1531,7 @@ std::shared_ptr<ClassNode> SingleParser::parseClass(const TSNode& _node)
 
         if (type == "virtual_specifier")
         {
-            std::string txt = getNodeText(child, m_source->content);
+            std::string txt = getNodeText(child, m_content);
             if (txt == "final") classNode->isFinal = true;
         }
         else if (type == "base_class_clause")
@@ -1315,7 +1543,7 @@ std::shared_ptr<ClassNode> SingleParser::parseClass(const TSNode& _node)
                 if (ts_node_type(baseChild) == std::string("qualified_identifier") ||
                     ts_node_type(baseChild) == std::string("type_identifier"))
                 {
-                    classNode->baseClasses.push_back(getNodeText(baseChild, m_source->content));
+                    classNode->baseClasses.push_back(getNodeText(baseChild, m_content));
                 }
             }
         }
@@ -1451,15 +1679,15 @@ TypeSignature SingleParser::parseTypeSignature(const TSNode& _node)
 
         if (type == "primitive_type" || type == "type_identifier")
         {
-            sig.baseType += getNodeText(child, m_source->content);
+            sig.baseType += getNodeText(child, m_content);
         }
         else if (type == "qualified_identifier")
         {
-            sig.baseType += getNodeText(child, m_source->content);
+            sig.baseType += getNodeText(child, m_content);
         }
         else if (type == "type_qualifier")
         {
-            std::string txt = getNodeText(child, m_source->content);
+            std::string txt = getNodeText(child, m_content);
             if (txt == "const") sig.isConst = true;
             if (txt == "volatile") sig.isVolatile = true;
             if (txt == "mutable") sig.isMutable = true;
@@ -1470,7 +1698,7 @@ TypeSignature SingleParser::parseTypeSignature(const TSNode& _node)
         }
         else if (type == "reference_declarator")
         {
-            std::string txt = getNodeText(child, m_source->content);
+            std::string txt = getNodeText(child, m_content);
 
             if (txt.find("&&") != std::string::npos)
             {
@@ -1484,7 +1712,7 @@ TypeSignature SingleParser::parseTypeSignature(const TSNode& _node)
         else if (type == "template_type")
         {
             sig.baseType =
-                getNodeText(ts_node_child(child, 0), m_source->content); // the identifier
+                getNodeText(ts_node_child(child, 0), m_content); // the identifier
 
             if (ts_node_child_count(child) > 1)
             {
@@ -1524,7 +1752,7 @@ std::vector<GenericParameter> SingleParser::parseGenericParametersList(const TSN
             TSNode sub = ts_node_child(child, j);
             if (ts_node_type(sub) == std::string("default_value"))
             {
-                gp.defaultValue = getNodeText(sub, m_source->content);
+                gp.defaultValue = getNodeText(sub, m_content);
             }
         }
 
@@ -1556,12 +1784,12 @@ std::vector<TemplateArgument> SingleParser::parseTemplateArgumentsList(const TSN
         else if (type == "number_literal" || type == "string_literal" || type == "true" ||
                  type == "false" || type == "identifier" || type == "qualified_identifier")
         {
-            arg.value = getNodeText(child, m_source->content);
+            arg.value = getNodeText(child, m_content);
         }
         else
         {
             // fallback: raw text
-            arg.value = getNodeText(child, m_source->content);
+            arg.value = getNodeText(child, m_content);
         }
 
         args.emplace_back(std::move(arg));
@@ -1621,11 +1849,11 @@ void SingleParser::parseMemberList(const TSNode& _listNode, const std::string& _
 
                 if (funcNode->name == _parentName) // constructor
                 {
-                    _ctors.emplace_back(toConstructorNode(funcNode));
+                    _ctors.emplace_back(toConstructorNode(m_arena, funcNode));
                 }
                 else if (!funcNode->name.empty() && funcNode->name[0] == '~') // destructor
                 {
-                    _dtors.emplace_back(toDestructorNode(funcNode));
+                    _dtors.emplace_back(toDestructorNode(m_arena, funcNode));
                 }
                 else
                 {
@@ -1681,7 +1909,7 @@ void SingleParser::parseClassMemberList(
         }
         else if (subType == "access_specifier")
         {
-            std::string txt = getNodeText(subChild, m_source->content);
+            std::string txt = getNodeText(subChild, m_content);
 
             if (txt == "public")
                 currentAccess = AccessSpecifier::Public;
@@ -1717,11 +1945,13 @@ void SingleParser::parseClassMemberList(
 
                 if (funcNode->name == _parentName) // constructor
                 {
-                    _ctors.emplace_back(std::make_pair(currentAccess, toConstructorNode(funcNode)));
+                    _ctors.emplace_back(
+                        std::make_pair(currentAccess, toConstructorNode(m_arena, funcNode)));
                 }
                 else if (!funcNode->name.empty() && funcNode->name[0] == '~') // destructor
                 {
-                    _dtors.emplace_back(std::make_pair(currentAccess, toDestructorNode(funcNode)));
+                    _dtors.emplace_back(
+                        std::make_pair(currentAccess, toDestructorNode(m_arena, funcNode)));
                 }
                 else
                 {
@@ -1747,36 +1977,335 @@ void SingleParser::parseClassMemberList(
     }
 }
 
+Parser::Parser(size_t _workerCount, ParseCache* _cache)
+    : m_workerCount(_workerCount), m_cache(_cache)
+{
+}
+
+std::shared_ptr<SourceNode> Parser::parse(const std::shared_ptr<Source>& _source) const
+{
+    if (m_cache)
+    {
+        if (auto tree = m_cache->find(_source)) return tree;
+    }
+
+    auto tree = SingleParser(_source).parse();
+
+    if (m_cache && tree) m_cache->store(*_source, *tree);
+
+    return tree;
+}
+
 std::vector<std::shared_ptr<SourceNode>> Parser::parse(
     const std::vector<std::shared_ptr<Source>>& _sources)
 {
-    std::vector<std::future<std::shared_ptr<SourceNode>>> futures;
-    std::vector<std::shared_ptr<SourceNode>> results;
+    std::vector<std::shared_ptr<SourceNode>> trees(_sources.size());
+    std::vector<std::string> errors(_sources.size());
 
-    futures.reserve(_sources.size());
+    parallelFor(_sources.size(), m_workerCount,
+                [&](size_t _index)
+                {
+                    const std::shared_ptr<Source>& source = _sources[_index];
+
+                    try
+                    {
+                        trees[_index] = parse(source);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        errors[_index] = e.what();
+                    }
+                });
+
+    std::vector<std::shared_ptr<SourceNode>> results;
     results.reserve(_sources.size());
 
-    for (const auto& source : _sources)
+    for (size_t i = 0; i < _sources.size(); ++i)
+    {
+        if (!errors[i].empty()) std::cout << "Error parsing file: " << errors[i] << "\n";
+        if (trees[i]) results.emplace_back(std::move(trees[i]));
+    }
+
+    return results;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Incremental parser
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// The row and byte column of an offset of the text
+TSPoint pointAt(std::string_view _text, size_t _offset)
+{
+    std::string_view head = _text.substr(0, _offset);
+
+    const auto row = static_cast<uint32_t>(std::count(head.begin(), head.end(), '\n'));
+    const size_t lineStart = head.rfind('\n');
+
+    return {row, static_cast<uint32_t>(lineStart == std::string_view::npos
+                                           ? _offset
+                                           : _offset - lineStart - 1)};
+}
+
+// The one edit turning _before into _after: the bytes between their common prefix and suffix
+TSInputEdit findEdit(std::string_view _before, std::string_view _after)
+{
+    const size_t shortest = std::min(_before.size(), _after.size());
+
+    size_t prefix = 0;
+    while (prefix < shortest && _before[prefix] == _after[prefix]) ++prefix;
+
+    size_t suffix = 0;
+    while (suffix < shortest - prefix &&
+           _before[_before.size() - 1 - suffix] == _after[_after.size() - 1 - suffix])
     {
-        futures.emplace_back(std::async(std::launch::async,
-                                        [this, source]() -> std::shared_ptr<SourceNode>
-                                        { return SingleParser(source).parse(); }));
+        ++suffix;
     }
 
-    for (auto& future : futures)
+    TSInputEdit edit;
+    edit.start_byte = static_cast<uint32_t>(prefix);
+    edit.old_end_byte = static_cast<uint32_t>(_before.size() - suffix);
+    edit.new_end_byte = static_cast<uint32_t>(_after.size() - suffix);
+    edit.start_point = pointAt(_before, edit.start_byte);
+    edit.old_end_point = pointAt(_before, edit.old_end_byte);
+    edit.new_end_point = pointAt(_after, edit.new_end_byte);
+
+    return edit;
+}
+
+// What a declaration is known by across updates, empty for those that have no name
+std::string getDeclarationKey(const Node& _node)
+{
+    std::string name;
+
+    switch (_node.kind)
+    {
+        case NodeKind::IncludeDirective:
+            name = static_cast<const IncludeNode&>(_node).path;
+            break;
+        case NodeKind::ObjectLikeMacro:
+            name = static_cast<const ObjectLikeMacroNode&>(_node).name;
+            break;
+        case NodeKind::FunctionLikeMacro:
+            name = static_cast<const FunctionLikeMacroNode&>(_node).name;
+            break;
+        case NodeKind::NamespaceAlias:
+            name = static_cast<const NamespaceAliasNode&>(_node).aliasName;
+            break;
+        case NodeKind::UsingNamespace:
+            name = static_cast<const UsingNamespaceNode&>(_node).name;
+            break;
+        case NodeKind::Typedef:
+            name = static_cast<const TypedefNode&>(_node).aliasName;
+            break;
+        case NodeKind::TypeAlias:
+            name = static_cast<const TypeAliasNode&>(_node).aliasName;
+            break;
+        case NodeKind::EnumSpecifier:
+            name = static_cast<const EnumNode&>(_node).name;
+            break;
+        case NodeKind::Variable:
+            name = static_cast<const VariableNode&>(_node).name;
+            break;
+        case NodeKind::Concept:
+            name = static_cast<const ConceptNode&>(_node).name;
+            break;
+        case NodeKind::Function:
+            name = static_cast<const FunctionNode&>(_node).name;
+            break;
+        case NodeKind::Operator:
+            name = static_cast<const OperatorNode&>(_node).operatorSymbol;
+            break;
+        case NodeKind::Union:
+            name = static_cast<const UnionNode&>(_node).name;
+            break;
+        case NodeKind::Struct:
+            name = static_cast<const StructNode&>(_node).name;
+            break;
+        case NodeKind::Class:
+            name = static_cast<const ClassNode&>(_node).name;
+            break;
+        default:
+            break;
+    }
+
+    if (name.empty()) return {};
+
+    return nodeKindToString(_node.kind) + ":" + name;
+}
+
+// Pairs the declarations removed and added under the same key into changes; overloads pair in
+// the order of the file
+void pairChanges(SourceDiff& _diff)
+{
+    std::unordered_multimap<std::string, size_t> removedByKey;
+
+    for (size_t i = 0; i < _diff.removed.size(); ++i)
+    {
+        std::string key = getDeclarationKey(*_diff.removed[i]);
+        if (!key.empty()) removedByKey.emplace(std::move(key), i);
+    }
+
+    if (removedByKey.empty()) return;
+
+    std::vector<bool> paired(_diff.removed.size(), false);
+    std::vector<std::shared_ptr<Node>> added;
+
+    for (auto& node : _diff.added)
     {
-        try
+        auto [first, last] = removedByKey.equal_range(getDeclarationKey(*node));
+        auto it = std::find_if(first, last,
+                               [&](const auto& _entry) { return !paired[_entry.second]; });
+
+        if (it == last)
         {
-            auto result = future.get();
-            if (result) results.emplace_back(result);
+            added.emplace_back(std::move(node));
+            continue;
         }
-        catch (const std::exception& e)
+
+        paired[it->second] = true;
+        _diff.changed.emplace_back(_diff.removed[it->second], std::move(node));
+    }
+
+    std::vector<std::shared_ptr<Node>> removed;
+
+    for (size_t i = 0; i < _diff.removed.size(); ++i)
+    {
+        if (!paired[i]) removed.emplace_back(std::move(_diff.removed[i]));
+    }
+
+    _diff.added = std::move(added);
+    _diff.removed = std::move(removed);
+}
+
+} // namespace
+
+struct IncrementalParser::File
+{
+    TSTree* tree = nullptr;
+    std::string content; // parsed last, to diff with the next text (a mapping changes under us)
+    std::unordered_map<uint32_t, std::shared_ptr<Node>> units;
+    std::shared_ptr<SourceNode> sourceTree;
+
+    File() = default;
+    ~File()
+    {
+        if (tree) ts_tree_delete(tree);
+    }
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+};
+
+IncrementalParser::IncrementalParser() = default;
+
+IncrementalParser::~IncrementalParser() = default;
+
+SourceDiff IncrementalParser::update(const std::shared_ptr<Source>& _source)
+{
+    auto& slot = m_files[_source->path.string()];
+    if (!slot) slot = std::make_unique<File>();
+
+    File& file = *slot;
+
+    SourceDiff diff;
+    diff.path = _source->path;
+
+    std::string content(_source->getContent());
+
+    if (file.tree && content == file.content)
+    {
+        diff.tree = file.sourceTree;
+        diff.reusedCount = file.units.size();
+        return diff;
+    }
+
+    TSInputEdit edit;
+    if (file.tree)
+    {
+        edit = findEdit(file.content, content);
+        ts_tree_edit(file.tree, &edit);
+    }
+
+    SingleParser parser(_source, content);
+    TSTree* tree = nullptr;
+
+    std::vector<TSRange> changedRanges;
+    UnitReuse reuse(file.units, file.tree ? &edit : nullptr);
+    std::shared_ptr<SourceNode> sourceTree;
+
+    try
+    {
+        tree = parser.parseTree(file.tree);
+
+        if (file.tree)
         {
-            std::cout << "Error parsing file: " << e.what() << "\n";
+            uint32_t count = 0;
+            TSRange* ranges = ts_tree_get_changed_ranges(file.tree, tree, &count);
+
+            changedRanges.assign(ranges, ranges + count);
+            std::free(ranges);
         }
+
+        reuse.setChangedRanges(std::move(changedRanges));
+        sourceTree = parser.build(tree, &reuse);
+    }
+    catch (...)
+    {
+        // the old tree is edited already: the next update parses the source in full
+        if (tree) ts_tree_delete(tree);
+        m_files.erase(_source->path.string());
+        throw;
     }
 
-    return results;
+    diff.tree = sourceTree;
+    diff.added = std::move(reuse.dispatched);
+    diff.reusedCount = reuse.reused.size();
+
+    for (const auto& [start, node] : file.units)
+    {
+        if (!reuse.reused.contains(node.get())) diff.removed.emplace_back(node);
+    }
+
+    // the map has no order, the file does
+    std::sort(diff.removed.begin(), diff.removed.end(),
+              [](const auto& _a, const auto& _b) { return _a->startLine < _b->startLine; });
+
+    pairChanges(diff);
+
+    if (file.tree) ts_tree_delete(file.tree);
+    file.tree = tree;
+    file.content = std::move(content);
+    file.units = std::move(reuse.units);
+    file.sourceTree = std::move(sourceTree);
+
+    return diff;
+}
+
+SourceDiff IncrementalParser::remove(const std::filesystem::path& _path)
+{
+    SourceDiff diff;
+    diff.path = _path;
+
+    auto it = m_files.find(_path.string());
+    if (it == m_files.end()) return diff;
+
+    for (const auto& [start, node] : it->second->units) diff.removed.emplace_back(node);
+
+    std::sort(diff.removed.begin(), diff.removed.end(),
+              [](const auto& _a, const auto& _b) { return _a->startLine < _b->startLine; });
+
+    m_files.erase(it);
+
+    return diff;
+}
+
+std::shared_ptr<SourceNode> IncrementalParser::getTree(const std::filesystem::path& _path) const
+{
+    auto it = m_files.find(_path.string());
+    return it == m_files.end() ? nullptr : it->second->sourceTree;
 }
 
 } // namespace codex
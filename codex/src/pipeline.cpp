@@ -0,0 +1,61 @@
+#include "codex/pipeline.hpp"
+
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace codex
+{
+
+Pipeline::Pipeline(FilesCollector _collector, SourceExtractor _extractor,
+                   Preprocessor _preprocessor, Parser _parser)
+    : m_collector(std::move(_collector)),
+      m_extractor(std::move(_extractor)),
+      m_preprocessor(std::move(_preprocessor)),
+      m_parser(std::move(_parser))
+{
+}
+
+size_t Pipeline::run(const TreeSink& _sink) const
+{
+    std::atomic<size_t> count = 0;
+
+    std::mutex mutex;
+    std::vector<std::string> errors;
+
+    m_collector.collect(
+        [&](std::filesystem::path _path)
+        {
+            try
+            {
+                auto source = m_extractor.extract(_path);
+                if (!source) return;
+
+                m_preprocessor.expand(source);
+
+                auto tree = m_parser.parse(source);
+                if (!tree) return;
+
+                // the sink holds the last references
+                source.reset();
+                _sink(std::move(tree));
+
+                count.fetch_add(1, std::memory_order_relaxed);
+            }
+            catch (const std::exception& e)
+            {
+                std::scoped_lock lock(mutex);
+                errors.emplace_back(_path.string() + ": " + e.what());
+            }
+        });
+
+    for (const auto& error : errors) std::cout << "Error processing file: " << error << "\n";
+
+    return count.load();
+}
+
+} // namespace codex
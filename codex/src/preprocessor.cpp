@@ -1,9 +1,11 @@
 #include "codex/preprocessor.hpp"
-#include <future>
+#include <exception>
 #include <iostream>
 #include <sstream>
 #include <regex>
 
+#include "parallel_for.hpp"
+
 namespace codex
 {
 
@@ -65,12 +67,12 @@ std::string SingleFilePreprocessor::processLine(const std::string& line)
 
 void SingleFilePreprocessor::expand()
 {
-    if (!m_source || m_source->content.empty())
+    if (!m_source || m_source->getContent().empty())
     {
         return;
     }
 
-    std::istringstream input(m_source->content);
+    std::istringstream input{std::string(m_source->getContent())};
     std::ostringstream output;
     std::string line;
 
@@ -87,30 +89,41 @@ void SingleFilePreprocessor::expand()
         output << processLine(line);
     }
 
-    m_source->content = output.str();
+    m_source->setContent(output.str());
 }
 
-Preprocessor::Preprocessor(const std::unordered_map<std::string, std::string>& _defines)
-    : m_defines(_defines)
+Preprocessor::Preprocessor(const std::unordered_map<std::string, std::string>& _defines,
+                           size_t _workerCount)
+    : m_defines(_defines), m_workerCount(_workerCount)
 {
 }
 
 void Preprocessor::expand(std::vector<std::shared_ptr<Source>>& _sources)
 {
-    std::vector<std::future<void>> futures;
-
-    futures.reserve(_sources.size());
-
-    for (auto& src : _sources)
+    std::vector<std::exception_ptr> errors(_sources.size());
+
+    parallelFor(_sources.size(), m_workerCount,
+                [&](size_t _index)
+                {
+                    try
+                    {
+                        SingleFilePreprocessor(_sources[_index], m_defines).expand();
+                    }
+                    catch (...)
+                    {
+                        errors[_index] = std::current_exception();
+                    }
+                });
+
+    for (const std::exception_ptr& error : errors)
     {
-        futures.emplace_back(std::async(std::launch::async, [this, src]()
-                                        { SingleFilePreprocessor(src, m_defines).expand(); }));
+        if (error) std::rethrow_exception(error);
     }
+}
 
-    for (auto& future : futures)
-    {
-        future.get();
-    }
+void Preprocessor::expand(const std::shared_ptr<Source>& _source) const
+{
+    SingleFilePreprocessor(_source, m_defines).expand();
 }
 
 } // namespace codex
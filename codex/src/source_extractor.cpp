@@ -1,10 +1,15 @@
 #include "codex/source_extractor.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <mutex>
 #include <string>
-#include <future>
+#include <utility>
+
+#include "codex/mapped_file.hpp"
+
+#include "parallel_for.hpp"
 
 namespace codex
 {
@@ -13,63 +18,132 @@ class SingleSourceExtractor
 {
    private:
     std::filesystem::path m_path;
-    std::string m_sourceCode;
+    bool m_mapFile;
 
    public:
-    SingleSourceExtractor(const std::filesystem::path& _path);
+    SingleSourceExtractor(const std::filesystem::path& _path, bool _mapFile);
 
    public:
     std::shared_ptr<Source> extractSource();
+
+   private:
+    std::string readFile() const;
 };
 
-SingleSourceExtractor::SingleSourceExtractor(const std::filesystem::path& _path) : m_path(_path) {}
+SingleSourceExtractor::SingleSourceExtractor(const std::filesystem::path& _path, bool _mapFile)
+    : m_path(_path), m_mapFile(_mapFile)
+{
+}
 
 std::shared_ptr<Source> SingleSourceExtractor::extractSource()
 {
-    std::ifstream file(m_path);
+    const double lastModifiedTime =
+        std::filesystem::last_write_time(m_path).time_since_epoch().count();
+
+    if (m_mapFile)
+    {
+        if (auto mapping = MappedFile::open(m_path))
+        {
+            return std::make_shared<Source>(m_path.filename().string(), m_path,
+                                            std::move(mapping), "UTF-8", lastModifiedTime);
+        }
+    }
+
+    // not mappable (a pipe, a file system without mmap): read instead
+    return std::make_shared<Source>(m_path.filename().string(), m_path, readFile(), "UTF-8",
+                                    lastModifiedTime);
+}
+
+// Straight into the string of the Source, sized from the file
+std::string SingleSourceExtractor::readFile() const
+{
+    std::ifstream file(m_path, std::ios::binary | std::ios::ate);
     if (!file.is_open())
     {
         std::cerr << "Failed to open file: " << m_path << "\n";
+        return {};
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    m_sourceCode = buffer.str();
+    const std::streamoff size = file.tellg();
+    if (size <= 0) return {};
+
+    std::string content(static_cast<size_t>(size), '\0');
 
-    auto source = std::make_shared<Source>(
-        m_path.filename().string(), m_path, m_sourceCode, "UTF-8",
-        std::filesystem::last_write_time(m_path).time_since_epoch().count());
+    file.seekg(0);
+    file.read(content.data(), size);
+    content.resize(static_cast<size_t>(file.gcount()));
 
-    return source;
+    return content;
+}
+
+SourceExtractor::SourceExtractor(size_t _workerCount, bool _mapFiles)
+    : m_workerCount(_workerCount), m_mapFiles(_mapFiles)
+{
 }
 
 std::vector<std::shared_ptr<Source>> SourceExtractor::extract(
     const std::vector<std::filesystem::path>& _paths)
 {
-    std::vector<std::future<std::shared_ptr<Source>>> futures;
-    std::vector<std::shared_ptr<Source>> results;
+    std::vector<std::shared_ptr<Source>> sources(_paths.size());
+    std::vector<std::string> errors(_paths.size());
+
+    parallelFor(_paths.size(), m_workerCount,
+                [&](size_t _index)
+                {
+                    try
+                    {
+                        sources[_index] = extract(_paths[_index]);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        errors[_index] = e.what();
+                    }
+                });
 
-    futures.reserve(_paths.size());
+    std::vector<std::shared_ptr<Source>> results;
     results.reserve(_paths.size());
 
-    for (const auto& path : _paths)
+    for (size_t i = 0; i < _paths.size(); ++i)
     {
-        futures.emplace_back(std::async(std::launch::async, [this, path]()
-                                        { return SingleSourceExtractor(path).extractSource(); }));
+        if (!errors[i].empty()) std::cout << "Error extracting source: " << errors[i] << "\n";
+        if (sources[i]) results.emplace_back(std::move(sources[i]));
     }
 
-    for (auto& future : futures)
-    {
-        try
-        {
-            auto fResult = future.get();
-            if (fResult) results.emplace_back(fResult);
-        }
-        catch (const std::exception& e)
+    return results;
+}
+
+std::shared_ptr<Source> SourceExtractor::extract(const std::filesystem::path& _path) const
+{
+    return SingleSourceExtractor(_path, m_mapFiles).extractSource();
+}
+
+std::vector<std::shared_ptr<Source>> SourceExtractor::extract(const FilesCollector& _collector)
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Source>> results;
+    std::vector<std::string> errors;
+
+    _collector.collect(
+        [&](std::filesystem::path _path)
         {
-            std::cout << "Error extracting source: " << e.what() << "\n";
-        }
-    }
+            try
+            {
+                auto source = extract(_path);
+
+                std::scoped_lock lock(mutex);
+                if (source) results.emplace_back(std::move(source));
+            }
+            catch (const std::exception& e)
+            {
+                std::scoped_lock lock(mutex);
+                errors.emplace_back(e.what());
+            }
+        });
+
+    for (const auto& error : errors) std::cout << "Error extracting source: " << error << "\n";
+
+    std::sort(results.begin(), results.end(),
+              [](const auto& _a, const auto& _b) { return _a->path < _b->path; });
 
     return results;
 }
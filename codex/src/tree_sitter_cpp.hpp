@@ -15,7 +15,7 @@ extern "C"
     return {start, end};
 }
 
-[[nodiscard]] inline std::string getNodeText(const TSNode& _node, const std::string& _source)
+[[nodiscard]] inline std::string getNodeText(const TSNode& _node, std::string_view _source)
 {
     uint32_t startByte = ts_node_start_byte(_node);
     uint32_t endByte = ts_node_end_byte(_node);
@@ -25,5 +25,5 @@ extern "C"
         throw std::runtime_error("Invalid node position data");
     }
 
-    return _source.substr(startByte, endByte - startByte);
+    return std::string(_source.substr(startByte, endByte - startByte));
 }
@@ -0,0 +1,256 @@
+// Editor end of the engine edit protocol (mosaic/include/mosaic/ecs/edit_protocol.hpp).
+//
+// Messages are packed little-endian structs: a 32-byte header, then either the
+// schema components or the commands of a batch. The editor sends one edits
+// message per frame and applies the changes messages the engine answers with.
+
+import 'dart:convert';
+import 'dart:typed_data';
+
+const int kEditProtocolMagic = 0x5444454D; // "MEDT"
+const int kEditProtocolVersion = 1;
+
+const int _headerSize = 32;
+const int _commandHeaderSize = 16;
+const int _schemaComponentSize = 20;
+const int _entitySize = 8;
+
+enum EditMessageKind { schema, edits, changes }
+
+enum EditOp { setComponents, addComponent, removeComponent, destroyEntities }
+
+/// A generational entity handle, as the engine's EntityMeta.
+class EntityHandle {
+  const EntityHandle(this.id, this.gen);
+
+  final int id;
+  final int gen;
+
+  @override
+  bool operator ==(Object other) =>
+      other is EntityHandle && other.id == id && other.gen == gen;
+
+  @override
+  int get hashCode => Object.hash(id, gen);
+}
+
+/// A component registered by the engine.
+class SchemaComponent {
+  const SchemaComponent(
+      this.id, this.name, this.size, this.alignment, this.shared);
+
+  final int id;
+  final String name;
+  final int size;
+  final int alignment;
+  final bool shared;
+}
+
+/// The components of the engine and the hash every edits message carries.
+class EditSchema {
+  EditSchema(this.hash, this.components);
+
+  /// Decodes the schema message the engine sends first.
+  factory EditSchema.decode(Uint8List message) {
+    final reader = _Reader(message);
+    final header = reader.header(EditMessageKind.schema);
+
+    final components = <SchemaComponent>[];
+    for (var i = 0; i < header.count; ++i) {
+      final id = reader.uint32();
+      final size = reader.uint32();
+      final alignment = reader.uint32();
+      final shared = reader.uint32() != 0;
+      final name = utf8.decode(reader.bytes(reader.uint32()));
+      components.add(SchemaComponent(id, name, size, alignment, shared));
+    }
+    reader.expectEnd();
+
+    return EditSchema(header.schemaHash, components);
+  }
+
+  final int hash;
+  final List<SchemaComponent> components;
+
+  SchemaComponent? byName(String name) {
+    for (final component in components) {
+      if (component.name == name) return component;
+    }
+    return null;
+  }
+}
+
+/// Accumulates the edits of one frame, sent as a single message by [finish].
+class EditBatch {
+  EditBatch(this.schema, this.frame);
+
+  final EditSchema schema;
+  final int frame;
+
+  final BytesBuilder _commands = BytesBuilder(copy: false);
+  int _count = 0;
+
+  bool get isEmpty => _count == 0;
+
+  /// Writes the same component of several entities, [values] packed.
+  void setComponents(
+      SchemaComponent component, List<EntityHandle> entities, Uint8List values) {
+    if (values.length != entities.length * component.size) {
+      throw ArgumentError('values do not match the component size');
+    }
+
+    _command(EditOp.setComponents, component.id, entities.length,
+        component.size);
+    for (var i = 0; i < entities.length; ++i) {
+      _entity(entities[i]);
+      _commands.add(Uint8List.sublistView(
+          values, i * component.size, (i + 1) * component.size));
+    }
+  }
+
+  /// Adds the component, copied from [value] or zeroed without one.
+  void addComponent(EntityHandle entity, SchemaComponent component,
+      [Uint8List? value]) {
+    _command(EditOp.addComponent, component.id, 1, value?.length ?? 0);
+    _entity(entity);
+    if (value != null) _commands.add(value);
+  }
+
+  void removeComponent(EntityHandle entity, SchemaComponent component) {
+    _command(EditOp.removeComponent, component.id, 1, 0);
+    _entity(entity);
+  }
+
+  void destroyEntities(List<EntityHandle> entities) {
+    _command(EditOp.destroyEntities, 0, entities.length, 0);
+    entities.forEach(_entity);
+  }
+
+  Uint8List finish() {
+    final header = ByteData(_headerSize)
+      ..setUint32(0, kEditProtocolMagic, Endian.little)
+      ..setUint32(4, kEditProtocolVersion, Endian.little)
+      ..setUint32(8, EditMessageKind.edits.index + 1, Endian.little)
+      ..setUint32(12, schema.hash, Endian.little)
+      ..setUint64(16, frame, Endian.little)
+      ..setUint32(24, _count, Endian.little);
+
+    return (BytesBuilder(copy: false)
+          ..add(header.buffer.asUint8List())
+          ..add(_commands.takeBytes()))
+        .takeBytes();
+  }
+
+  void _command(EditOp op, int component, int count, int size) {
+    final header = ByteData(_commandHeaderSize)
+      ..setUint16(0, op.index + 1, Endian.little)
+      ..setUint32(4, component, Endian.little)
+      ..setUint32(8, count, Endian.little)
+      ..setUint32(12, size, Endian.little);
+    _commands.add(header.buffer.asUint8List());
+    ++_count;
+  }
+
+  void _entity(EntityHandle entity) {
+    final bytes = ByteData(_entitySize)
+      ..setUint32(0, entity.id, Endian.little)
+      ..setUint32(4, entity.gen, Endian.little);
+    _commands.add(bytes.buffer.asUint8List());
+  }
+}
+
+/// Decodes a changes message: [onValue] gets each written component value, a
+/// view into [message] valid for the duration of the call. Returns the frame.
+int decodeChanges(Uint8List message, EditSchema schema,
+    void Function(EntityHandle entity, int component, Uint8List value) onValue) {
+  final reader = _Reader(message);
+  final header = reader.header(EditMessageKind.changes);
+  if (header.schemaHash != schema.hash) {
+    throw const FormatException('changes of another component schema');
+  }
+
+  for (var command = 0; command < header.count; ++command) {
+    final op = reader.uint16();
+    reader.uint16();
+    final component = reader.uint32();
+    final count = reader.uint32();
+    final size = reader.uint32();
+    if (op != EditOp.setComponents.index + 1) {
+      throw const FormatException('unexpected command in changes');
+    }
+
+    for (var i = 0; i < count; ++i) {
+      final entity = EntityHandle(reader.uint32(), reader.uint32());
+      onValue(entity, component, reader.bytes(size));
+    }
+  }
+  reader.expectEnd();
+
+  return header.frame;
+}
+
+class _Header {
+  const _Header(this.schemaHash, this.frame, this.count);
+
+  final int schemaHash;
+  final int frame;
+  final int count;
+}
+
+class _Reader {
+  _Reader(this._bytes) : _data = ByteData.sublistView(_bytes);
+
+  final Uint8List _bytes;
+  final ByteData _data;
+  int _cursor = 0;
+
+  _Header header(EditMessageKind kind) {
+    if (_bytes.length < _headerSize ||
+        uint32() != kEditProtocolMagic ||
+        uint32() != kEditProtocolVersion ||
+        uint32() != kind.index + 1) {
+      throw const FormatException('not an edit message of the expected kind');
+    }
+
+    final schemaHash = uint32();
+    final frame = _data.getUint64(_cursor, Endian.little);
+    _cursor += 8;
+    final count = uint32();
+    uint32();
+
+    return _Header(schemaHash, frame, count);
+  }
+
+  int uint16() {
+    _check(2);
+    final value = _data.getUint16(_cursor, Endian.little);
+    _cursor += 2;
+    return value;
+  }
+
+  int uint32() {
+    _check(4);
+    final value = _data.getUint32(_cursor, Endian.little);
+    _cursor += 4;
+    return value;
+  }
+
+  Uint8List bytes(int size) {
+    _check(size);
+    final view = Uint8List.sublistView(_bytes, _cursor, _cursor + size);
+    _cursor += size;
+    return view;
+  }
+
+  void expectEnd() {
+    if (_cursor != _bytes.length) {
+      throw const FormatException('edit message has trailing bytes');
+    }
+  }
+
+  void _check(int size) {
+    if (_cursor + size > _bytes.length) {
+      throw const FormatException('edit message is truncated');
+    }
+  }
+}
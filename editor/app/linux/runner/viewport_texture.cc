@@ -0,0 +1,194 @@
+#include "viewport_texture.h"
+
+#include <epoxy/gl.h>
+#include <unistd.h>
+
+#include <deque>
+#include <vector>
+
+struct ImportedImage {
+  ViewportImage exported;
+  GLuint memory;
+  GLuint texture;
+  GLuint ready;
+  GLuint released;
+};
+
+struct _ViewportTexture {
+  FlTextureGL parent_instance;
+
+  uint32_t width;
+  uint32_t height;
+
+  // Imported into GL on the first frame, the context of Flutter is only
+  // current while populating
+  std::vector<ImportedImage>* images;
+  gboolean imported;
+
+  // The frames submitted by the engine and not waited for yet, and the image
+  // on screen (held until the next one replaces it)
+  std::deque<uint32_t>* pending;
+  int64_t shown;
+};
+
+G_DEFINE_TYPE(ViewportTexture, viewport_texture, fl_texture_gl_get_type())
+
+static void close_descriptor(int* descriptor) {
+  if (*descriptor >= 0) close(*descriptor);
+  *descriptor = -1;
+}
+
+// The descriptors are owned by GL once imported (EXT_external_objects_fd).
+static gboolean import_images(ViewportTexture* self, GError** error) {
+  if (!epoxy_has_gl_extension("GL_EXT_memory_object_fd") ||
+      !epoxy_has_gl_extension("GL_EXT_semaphore_fd")) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                "GL_EXT_memory_object_fd and GL_EXT_semaphore_fd are required "
+                "to import the viewport");
+    return FALSE;
+  }
+
+  for (ImportedImage& image : *self->images) {
+    const GLint dedicated = GL_TRUE;
+    glCreateMemoryObjectsEXT(1, &image.memory);
+    glMemoryObjectParameterivEXT(image.memory, GL_DEDICATED_MEMORY_OBJECT_EXT,
+                                 &dedicated);
+    glImportMemoryFdEXT(image.memory, image.exported.memory_size,
+                        GL_HANDLE_TYPE_OPAQUE_FD_EXT, image.exported.memory);
+    image.exported.memory = -1;
+
+    // The images are sRGB, their bytes are handed to Flutter as they are
+    glGenTextures(1, &image.texture);
+    glBindTexture(GL_TEXTURE_2D, image.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_TILING_EXT, GL_OPTIMAL_TILING_EXT);
+    glTexStorageMem2DEXT(GL_TEXTURE_2D, 1, GL_SRGB8_ALPHA8, self->width,
+                         self->height, image.memory, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SRGB_DECODE_EXT,
+                    GL_SKIP_DECODE_EXT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glGenSemaphoresEXT(1, &image.ready);
+    glImportSemaphoreFdEXT(image.ready, GL_HANDLE_TYPE_OPAQUE_FD_EXT,
+                           image.exported.ready);
+    image.exported.ready = -1;
+
+    glGenSemaphoresEXT(1, &image.released);
+    glImportSemaphoreFdEXT(image.released, GL_HANDLE_TYPE_OPAQUE_FD_EXT,
+                           image.exported.released);
+    image.exported.released = -1;
+  }
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  if (glGetError() != GL_NO_ERROR) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "failed to import the viewport images");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+// Hands the image back to the engine once the commands sampling it ran.
+static void release_image(ImportedImage& image) {
+  const GLenum layout = GL_LAYOUT_TRANSFER_SRC_EXT;
+  glSignalSemaphoreEXT(image.released, 0, nullptr, 1, &image.texture, &layout);
+}
+
+// Implements FlTextureGL::populate.
+static gboolean viewport_texture_populate(FlTextureGL* texture,
+                                          uint32_t* target, uint32_t* name,
+                                          uint32_t* width, uint32_t* height,
+                                          GError** error) {
+  ViewportTexture* self = VIEWPORT_TEXTURE(texture);
+
+  if (!self->imported) {
+    if (!import_images(self, error)) return FALSE;
+    self->imported = TRUE;
+  }
+
+  // Each frame signaled its ready semaphore once, every one is waited for:
+  // the frames skipped are released at once, the newest kept on screen
+  while (!self->pending->empty()) {
+    const uint32_t index = self->pending->front();
+    self->pending->pop_front();
+
+    ImportedImage& image = (*self->images)[index];
+    const GLenum layout = GL_LAYOUT_TRANSFER_SRC_EXT;
+    glWaitSemaphoreEXT(image.ready, 0, nullptr, 1, &image.texture, &layout);
+
+    if (self->shown >= 0) release_image((*self->images)[self->shown]);
+    self->shown = index;
+  }
+
+  if (self->shown < 0) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_PENDING,
+                "no viewport frame rendered yet");
+    return FALSE;
+  }
+
+  *target = GL_TEXTURE_2D;
+  *name = (*self->images)[self->shown].texture;
+  *width = self->width;
+  *height = self->height;
+
+  return TRUE;
+}
+
+// Implements GObject::dispose.
+static void viewport_texture_dispose(GObject* object) {
+  ViewportTexture* self = VIEWPORT_TEXTURE(object);
+
+  // The GL objects go with the context of Flutter, the descriptors never
+  // imported are closed here
+  if (self->images != nullptr) {
+    for (ImportedImage& image : *self->images) {
+      close_descriptor(&image.exported.memory);
+      close_descriptor(&image.exported.ready);
+      close_descriptor(&image.exported.released);
+    }
+  }
+
+  g_clear_pointer(&self->images, [](std::vector<ImportedImage>* images) {
+    delete images;
+  });
+  g_clear_pointer(&self->pending,
+                  [](std::deque<uint32_t>* pending) { delete pending; });
+
+  G_OBJECT_CLASS(viewport_texture_parent_class)->dispose(object);
+}
+
+static void viewport_texture_class_init(ViewportTextureClass* klass) {
+  FL_TEXTURE_GL_CLASS(klass)->populate = viewport_texture_populate;
+  G_OBJECT_CLASS(klass)->dispose = viewport_texture_dispose;
+}
+
+static void viewport_texture_init(ViewportTexture* self) {
+  self->images = new std::vector<ImportedImage>();
+  self->pending = new std::deque<uint32_t>();
+  self->imported = FALSE;
+  self->shown = -1;
+}
+
+ViewportTexture* viewport_texture_new(const ViewportImage* images,
+                                      uint32_t count, uint32_t width,
+                                      uint32_t height) {
+  ViewportTexture* self = VIEWPORT_TEXTURE(
+      g_object_new(viewport_texture_get_type(), nullptr));
+
+  self->width = width;
+  self->height = height;
+  for (uint32_t i = 0; i < count; ++i) {
+    self->images->push_back(ImportedImage{images[i], 0, 0, 0, 0});
+  }
+
+  return self;
+}
+
+void viewport_texture_frame_ready(ViewportTexture* self, uint32_t index) {
+  g_return_if_fail(VIEWPORT_IS_TEXTURE(self));
+  g_return_if_fail(index < self->images->size());
+
+  self->pending->push_back(index);
+}
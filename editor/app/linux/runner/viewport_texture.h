@@ -0,0 +1,54 @@
+#ifndef FLUTTER_VIEWPORT_TEXTURE_H_
+#define FLUTTER_VIEWPORT_TEXTURE_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstdint>
+
+G_DECLARE_FINAL_TYPE(ViewportTexture, viewport_texture, VIEWPORT, TEXTURE,
+                     FlTextureGL)
+
+/**
+ * ViewportImage:
+ *
+ * An image of the engine viewport exported by its headless render context
+ * (mosaic::ExportedFrames::Image on Linux): the file descriptors of its memory
+ * and of its ready and released semaphores.
+ */
+typedef struct {
+  int memory;
+  uint64_t memory_size;
+  int ready;
+  int released;
+} ViewportImage;
+
+/**
+ * viewport_texture_new:
+ * @images: the exported images, the texture takes ownership of their
+ * descriptors.
+ * @count: the number of images.
+ * @width: the width of the images in pixels.
+ * @height: the height of the images in pixels.
+ *
+ * Creates a texture sampling the engine viewport in place: the images are
+ * imported into the GL context of Flutter on the first frame, never copied.
+ *
+ * Returns: a new #ViewportTexture.
+ */
+ViewportTexture* viewport_texture_new(const ViewportImage* images,
+                                      uint32_t count, uint32_t width,
+                                      uint32_t height);
+
+/**
+ * viewport_texture_frame_ready:
+ * @texture: a #ViewportTexture.
+ * @index: the image the engine rendered into
+ * (mosaic::RenderContext::getLastExportedImage()).
+ *
+ * Records a frame submitted by the engine, in submission order. Every frame
+ * is consumed: the engine renders into an image again only once the texture
+ * released it. Mark the texture frame available on the registrar after it.
+ */
+void viewport_texture_frame_ready(ViewportTexture* texture, uint32_t index);
+
+#endif  // FLUTTER_VIEWPORT_TEXTURE_H_
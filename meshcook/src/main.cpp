@@ -0,0 +1,80 @@
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <lyra/lyra.hpp>
+
+#include <mosaic/graphics/mesh_cook.hpp>
+
+#include "obj_reader.hpp"
+
+int main(int _argc, const char** _argv)
+{
+    bool showHelp = false;
+    std::string input;
+    std::string output;
+    bool meshlets = false;
+    uint32_t lods = mosaic::graphics::MeshCookSettings{}.maxLods;
+
+    auto cli = lyra::help(showHelp) |
+               lyra::arg(input, "input")("The Wavefront OBJ file to cook.").required() |
+               lyra::opt(output, "output")["-o"]["--output"](
+                   "The mesh file to write, the input with the .mesh extension by default.") |
+               lyra::opt(meshlets)["--meshlets"]("Build the meshlets of each LOD.") |
+               lyra::opt(lods, "count")["--lods"]("The most LODs, the full one included.");
+
+    const auto parsed = cli.parse({_argc, _argv});
+    if (!parsed)
+    {
+        std::fprintf(stderr, "%s\n", parsed.message().c_str());
+        return 1;
+    }
+
+    if (showHelp)
+    {
+        std::cout << cli << std::endl;
+        return 0;
+    }
+
+    if (output.empty())
+    {
+        output = std::filesystem::path(input).replace_extension(".mesh").string();
+    }
+
+    auto obj = meshcook::readObj(input);
+    if (obj.isErr())
+    {
+        std::fprintf(stderr, "%s\n", obj.error().c_str());
+        return 1;
+    }
+
+    mosaic::graphics::MeshCookSettings settings;
+    settings.maxLods = lods;
+    settings.meshlets = meshlets;
+
+    const meshcook::ObjMesh& mesh = obj.unwrap();
+    auto cooked = mosaic::graphics::cookMesh(mesh.vertices, mesh.indices, settings);
+    if (cooked.isErr())
+    {
+        std::fprintf(stderr, "%s: %s\n", input.c_str(), cooked.error().c_str());
+        return 1;
+    }
+
+    const std::vector<uint8_t>& bytes = cooked.unwrap();
+    std::ofstream file(output, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+    if (!file)
+    {
+        std::fprintf(stderr, "failed to write %s\n", output.c_str());
+        return 1;
+    }
+
+    std::printf("%s: %zu vertices, %zu triangles, %zu bytes\n", output.c_str(),
+                mesh.vertices.size(), mesh.indices.size() / 3, bytes.size());
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "obj_reader.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <string_view>
+#include <tuple>
+
+namespace meshcook
+{
+
+using mosaic::graphics::MeshVertex;
+
+// A vertex of a face: its position, uv and normal, 1-based, 0 when absent
+using Corner = std::tuple<int64_t, int64_t, int64_t>;
+
+static std::string_view nextToken(std::string_view& _line)
+{
+    const size_t begin = _line.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos)
+    {
+        _line = {};
+        return {};
+    }
+
+    const size_t end = _line.find_first_of(" \t\r", begin);
+    const std::string_view token = _line.substr(begin, end - begin);
+    _line = end == std::string_view::npos ? std::string_view{} : _line.substr(end);
+    return token;
+}
+
+static float parseFloat(std::string_view _token)
+{
+    float value = 0.0f;
+    std::from_chars(_token.data(), _token.data() + _token.size(), value);
+    return value;
+}
+
+// "v", "v/t", "v//n" or "v/t/n", negative indices counted from the end
+static bool parseCorner(std::string_view _token, std::array<size_t, 3> _counts, Corner& _corner)
+{
+    std::array<int64_t, 3> values = {};
+    for (size_t i = 0; i < 3 && !_token.empty(); ++i)
+    {
+        const size_t slash = _token.find('/');
+        const std::string_view part = _token.substr(0, slash);
+
+        if (!part.empty())
+        {
+            int64_t value = 0;
+            if (std::from_chars(part.data(), part.data() + part.size(), value).ec != std::errc{})
+            {
+                return false;
+            }
+
+            if (value < 0) value += static_cast<int64_t>(_counts[i]) + 1;
+            if (value <= 0 || value > static_cast<int64_t>(_counts[i])) return false;
+            values[i] = value;
+        }
+
+        _token = slash == std::string_view::npos ? std::string_view{} : _token.substr(slash + 1);
+    }
+
+    _corner = {values[0], values[1], values[2]};
+    return values[0] != 0;
+}
+
+pieces::Result<ObjMesh, std::string> readObj(const std::filesystem::path& _path)
+{
+    std::ifstream file(_path);
+    if (!file) return pieces::Err<ObjMesh, std::string>("failed to open " + _path.string());
+
+    std::vector<std::array<float, 3>> positions;
+    std::vector<std::array<float, 2>> uvs;
+    std::vector<std::array<float, 3>> normals;
+
+    ObjMesh mesh;
+    std::map<Corner, uint32_t> vertexOf;
+    std::vector<Corner> face;
+
+    std::string buffer;
+    for (size_t lineNumber = 1; std::getline(file, buffer); ++lineNumber)
+    {
+        std::string_view line = buffer;
+        const std::string_view keyword = nextToken(line);
+
+        if (keyword == "v")
+        {
+            auto& position = positions.emplace_back();
+            for (float& value : position) value = parseFloat(nextToken(line));
+        }
+        else if (keyword == "vt")
+        {
+            auto& uv = uvs.emplace_back();
+            for (float& value : uv) value = parseFloat(nextToken(line));
+            uv[1] = 1.0f - uv[1]; // OBJ has v up, the textures are read top down
+        }
+        else if (keyword == "vn")
+        {
+            auto& normal = normals.emplace_back();
+            for (float& value : normal) value = parseFloat(nextToken(line));
+        }
+        else if (keyword == "f")
+        {
+            face.clear();
+            for (std::string_view token = nextToken(line); !token.empty();
+                 token = nextToken(line))
+            {
+                Corner& corner = face.emplace_back();
+                if (!parseCorner(token, {positions.size(), uvs.size(), normals.size()}, corner))
+                {
+                    return pieces::Err<ObjMesh, std::string>(
+                        _path.string() + ":" + std::to_string(lineNumber) + ": invalid face");
+                }
+            }
+
+            if (face.size() < 3) continue;
+
+            // the normal of the polygon, for the corners without one (Newell)
+            std::array<float, 3> faceNormal = {};
+            for (size_t i = 0; i < face.size(); ++i)
+            {
+                const auto& a = positions[std::get<0>(face[i]) - 1];
+                const auto& b = positions[std::get<0>(face[(i + 1) % face.size()]) - 1];
+                faceNormal[0] += (a[1] - b[1]) * (a[2] + b[2]);
+                faceNormal[1] += (a[2] - b[2]) * (a[0] + b[0]);
+                faceNormal[2] += (a[0] - b[0]) * (a[1] + b[1]);
+            }
+
+            const float length = std::sqrt(faceNormal[0] * faceNormal[0] +
+                                           faceNormal[1] * faceNormal[1] +
+                                           faceNormal[2] * faceNormal[2]);
+            if (length > 0.0f)
+            {
+                for (float& value : faceNormal) value /= length;
+            }
+
+            std::vector<uint32_t> corners;
+            for (const Corner& corner : face)
+            {
+                // without a normal, a corner takes the normal of its face and is not shared
+                Corner key = corner;
+                if (std::get<2>(key) == 0)
+                {
+                    std::get<2>(key) = -static_cast<int64_t>(mesh.vertices.size()) - 1;
+                }
+
+                auto [it, inserted] =
+                    vertexOf.try_emplace(key, static_cast<uint32_t>(mesh.vertices.size()));
+                if (inserted)
+                {
+                    MeshVertex& vertex = mesh.vertices.emplace_back();
+                    vertex.position = positions[std::get<0>(corner) - 1];
+                    if (std::get<1>(corner) != 0) vertex.uv = uvs[std::get<1>(corner) - 1];
+                    vertex.normal = std::get<2>(corner) != 0 ? normals[std::get<2>(corner) - 1]
+                                                              : faceNormal;
+                }
+
+                corners.push_back(it->second);
+            }
+
+            for (size_t i = 1; i + 1 < corners.size(); ++i)
+            {
+                mesh.indices.insert(mesh.indices.end(), {corners[0], corners[i], corners[i + 1]});
+            }
+        }
+    }
+
+    if (mesh.indices.empty())
+    {
+        return pieces::Err<ObjMesh, std::string>(_path.string() + ": no faces");
+    }
+
+    return pieces::Ok<ObjMesh, std::string>(std::move(mesh));
+}
+
+} // namespace meshcook
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include <mosaic/graphics/mesh_cook.hpp>
+
+namespace meshcook
+{
+
+struct ObjMesh
+{
+    std::vector<mosaic::graphics::MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+/**
+ * @brief Reads the triangles of a Wavefront OBJ file: positions, normals and texture coordinates,
+ * the polygons fanned into triangles, one vertex per distinct position/uv/normal triplet.
+ * Faces without normals get the normal of their polygon. Groups and materials are ignored.
+ */
+pieces::Result<ObjMesh, std::string> readObj(const std::filesystem::path& _path);
+
+} // namespace meshcook
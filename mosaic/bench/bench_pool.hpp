@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdexcept>
+
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/core/sys_info.hpp>
+
+// The engine's pool, created on first use with one worker per logical core and shared by every
+// benchmark of the executable (two pools would compete for the cores)
+inline mosaic::exec::ThreadPool& benchmarkPool()
+{
+    static mosaic::exec::ThreadPool pool;
+    static const bool initialized =
+        pool.initialize(mosaic::core::SystemInfo::getCPUInfo()).isOk();
+
+    if (!initialized) throw std::runtime_error("Failed to initialize the benchmark pool.");
+    return pool;
+}
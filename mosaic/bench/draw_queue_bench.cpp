@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <mosaic/graphics/draw_queue.hpp>
+
+using namespace mosaic::graphics;
+
+// A frame of draws over a few pipelines and many meshes, submitted in scene order
+static std::vector<DrawCall> makeFrame(size_t _count)
+{
+    std::mt19937_64 rng(7);
+    std::vector<DrawCall> calls(_count);
+
+    for (DrawCall& call : calls)
+    {
+        const auto pipeline = static_cast<ResourceHandle>(rng() % 16);
+        const auto mesh = static_cast<ResourceHandle>(rng() % 512);
+        const auto depth = static_cast<uint32_t>(rng() % (1u << 24));
+
+        call.type = DrawCallType::Indexed;
+        call.pipeline = pipeline;
+        call.vertexBufferCount = 2;
+        call.vertexBuffers = {mesh, mesh + 512};
+        call.indexBuffer = mesh;
+        call.indexCount = 36;
+        call.sortKey = uint64_t{pipeline} << 48 | uint64_t{mesh} << 24 | depth;
+    }
+
+    return calls;
+}
+
+// Counts the commands so the recording is not optimized out
+struct CountingEncoder
+{
+    uint64_t commands = 0;
+
+    void bindPipeline(ResourceHandle _pipeline) { commands += _pipeline | 1; }
+    void bindVertexBuffer(uint32_t _slot, ResourceHandle _buffer) { commands += _slot + _buffer; }
+    void bindIndexBuffer(ResourceHandle _buffer) { commands += _buffer; }
+    void draw(const DrawCall& _call) { commands += _call.indexCount; }
+};
+
+static void DrawQueue_SubmitSortRecord(benchmark::State& _state)
+{
+    const auto calls = makeFrame(static_cast<size_t>(_state.range(0)));
+
+    DrawQueue queue;
+    DrawQueueStats stats;
+
+    for (auto _ : _state)
+    {
+        queue.clear();
+        for (const DrawCall& call : calls) queue.submit(call);
+
+        queue.sort();
+
+        CountingEncoder encoder;
+        stats = queue.record(encoder);
+        benchmark::DoNotOptimize(encoder.commands);
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+    _state.counters["binds"] = static_cast<double>(stats.pipelineBinds + stats.vertexBufferBinds +
+                                                   stats.indexBufferBinds);
+}
+
+// The same frame sorted by std::stable_sort on the draws themselves
+static void DrawQueue_StdStableSortBaseline(benchmark::State& _state)
+{
+    const auto calls = makeFrame(static_cast<size_t>(_state.range(0)));
+    std::vector<DrawCall> sorted;
+    sorted.reserve(calls.size());
+
+    for (auto _ : _state)
+    {
+        sorted.assign(calls.begin(), calls.end());
+        std::ranges::stable_sort(sorted, {}, &DrawCall::sortKey);
+
+        CountingEncoder encoder;
+        for (const DrawCall& call : sorted) encoder.draw(call);
+        benchmark::DoNotOptimize(encoder.commands);
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+BENCHMARK(DrawQueue_SubmitSortRecord)->Arg(20000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(DrawQueue_StdStableSortBaseline)->Arg(20000)->Unit(benchmark::kMicrosecond);
@@ -1,11 +1,20 @@
 #include <benchmark/benchmark.h>
 
+#include <chrono>
 #include <random>
 #include <memory>
+#include <span>
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <utility>
 
 #include <mosaic/ecs/entity_registry.hpp>
+#include <mosaic/ecs/command_buffer.hpp>
+#include <mosaic/ecs/edit_protocol.hpp>
+#include <mosaic/exec/thread_pool.hpp>
+
+#include "bench_pool.hpp"
 
 using namespace mosaic::ecs;
 
@@ -35,6 +44,24 @@ struct Renderable
     int meshId, textureId;
 };
 
+// Empty-ish marker components used to fan entities out over many archetypes
+template <size_t N>
+struct Marker
+{
+    uint8_t value;
+};
+
+static constexpr size_t k_markerCount = 8;
+
+// 16-byte fields making up the wide archetypes of production entities (20+ components)
+template <size_t N>
+struct WideField
+{
+    float values[4];
+};
+
+static constexpr size_t k_wideFieldCount = 24;
+
 static std::unique_ptr<ComponentRegistry> g_componentRegistry = nullptr;
 static std::unique_ptr<EntityRegistry> g_entityRegistry = nullptr;
 
@@ -53,6 +80,16 @@ class ECSBenchmark : public benchmark::Fixture
             g_componentRegistry->registerComponent<Health>("Health");
             g_componentRegistry->registerComponent<Transform>("Transform");
             g_componentRegistry->registerComponent<Renderable>("Renderable");
+
+            [&]<size_t... Is>(std::index_sequence<Is...>)
+            {
+                (g_componentRegistry->registerComponent<Marker<Is>>("Marker"), ...);
+            }(std::make_index_sequence<k_markerCount>{});
+
+            [&]<size_t... Is>(std::index_sequence<Is...>)
+            {
+                (g_componentRegistry->registerComponent<WideField<Is>>("WideField"), ...);
+            }(std::make_index_sequence<k_wideFieldCount>{});
         }
 
         if (!g_entityRegistry)
@@ -123,12 +160,51 @@ BENCHMARK_DEFINE_F(ECSBenchmark, BatchEntityCreation)(benchmark::State& state)
         benchmark::DoNotOptimize(entities);
 
         // Clean up for next iteration
-        g_entityRegistry->destroyEntities(entities);
+        g_entityRegistry->destroyEntityBulk(entities);
     }
 
     state.SetItemsProcessed(state.iterations() * batch_size);
 }
 
+// Spawns waves of 1000 entities into one wide archetype; worst_wave_us is the longest wave, which
+// includes the row reallocations (interleaved) or the one-off split (adaptive).
+static void spawnWaves(benchmark::State& _state, ArchetypeStorageMode _mode)
+{
+    const int entityCount = _state.range(0);
+    constexpr int k_waveSize = 1000;
+    double worstWave = 0.0;
+
+    for (auto _ : _state)
+    {
+        EntityRegistry registry(g_componentRegistry.get(), _mode);
+
+        for (int spawned = 0; spawned < entityCount; spawned += k_waveSize)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            registry.createEntityBulk<Position, Velocity, Transform>(k_waveSize);
+            const std::chrono::duration<double, std::micro> wave =
+                std::chrono::steady_clock::now() - start;
+
+            worstWave = std::max(worstWave, wave.count());
+        }
+
+        benchmark::DoNotOptimize(registry.entityCount());
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * entityCount);
+    _state.counters["worst_wave_us"] = worstWave;
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, MassSpawn_Interleaved)(benchmark::State& state)
+{
+    spawnWaves(state, ArchetypeStorageMode::interleaved);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, MassSpawn_Adaptive)(benchmark::State& state)
+{
+    spawnWaves(state, ArchetypeStorageMode::adaptive);
+}
+
 BENCHMARK_DEFINE_F(ECSBenchmark, EntityDestruction)(benchmark::State& state)
 {
     // Pre-create entities
@@ -194,6 +270,93 @@ BENCHMARK_DEFINE_F(ECSBenchmark, ComponentAddition)(benchmark::State& state)
     state.counters["archetypes"] = g_entityRegistry->archetypeCount();
 }
 
+BENCHMARK_DEFINE_F(ECSBenchmark, ComponentToggle)(benchmark::State& state)
+{
+    // Pre-create entities that get a status-effect component toggled on and off
+    std::vector<EntityID> entities;
+    const int entity_count = 1000;
+
+    for (int i = 0; i < entity_count; ++i)
+    {
+        entities.push_back(g_entityRegistry->createEntity<Position, Velocity, Transform>().id);
+    }
+
+    for (auto _ : state)
+    {
+        for (EntityID eid : entities) g_entityRegistry->addComponents<Health>(eid);
+        for (EntityID eid : entities) g_entityRegistry->removeComponents<Health>(eid);
+    }
+
+    state.SetItemsProcessed(state.iterations() * entity_count * 2);
+    state.counters["archetypes"] = g_entityRegistry->archetypeCount();
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, ComponentToggle_CommandBuffer)(benchmark::State& state)
+{
+    // Same toggle as above, recorded during iteration and played back at a sync point
+    const int entity_count = 1000;
+
+    for (int i = 0; i < entity_count; ++i)
+    {
+        g_entityRegistry->createEntity<Position, Velocity, Transform>();
+    }
+
+    EntityCommandBuffer commands;
+    auto query = g_entityRegistry->query<Position, Velocity, Transform>();
+
+    for (auto _ : state)
+    {
+        query.forEach([&](EntityMeta meta, Position&, Velocity&, Transform&)
+                      { commands.addComponents<Health>(meta.id); });
+        commands.playback(*g_entityRegistry);
+
+        query.forEach([&](EntityMeta meta, Position&, Velocity&, Transform&)
+                      { commands.removeComponents<Health>(meta.id); });
+        commands.playback(*g_entityRegistry);
+    }
+
+    state.SetItemsProcessed(state.iterations() * entity_count * 2);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, EditMessage_Drag)(benchmark::State& state)
+{
+    // One editor frame of a gizmo drag over a selection: encode, record, play back, stream back
+    const auto selected = static_cast<size_t>(state.range(0));
+
+    const auto entities = g_entityRegistry->createEntityBulk<Position, Transform>(10000);
+    const std::span<const EntityMeta> selection(entities.data(), selected);
+    const ComponentID transformID = g_componentRegistry->getID<Transform>();
+    const uint32_t schema = editSchemaHash(*g_componentRegistry);
+
+    std::vector<Transform> values(selected, Transform{});
+    std::vector<uint8_t> edits;
+    std::vector<uint8_t> changes;
+    EntityCommandBuffer commands;
+    uint32_t since = g_entityRegistry->advanceTick();
+    uint64_t frame = 0;
+
+    for (auto _ : state)
+    {
+        for (Transform& value : values) value.matrix[12] += 1.0f;
+
+        edits.clear();
+        EditMessageWriter writer(edits, EditMessageKind::edits, schema, ++frame);
+        writer.setComponents(transformID, selection, values.data(), sizeof(Transform));
+
+        (void)recordEditMessage(edits, *g_entityRegistry, *g_componentRegistry, commands);
+        commands.playback(*g_entityRegistry);
+
+        changes.clear();
+        benchmark::DoNotOptimize(writeEditChanges(*g_entityRegistry, *g_componentRegistry,
+                                                  {&transformID, 1}, since, frame, changes));
+        since = g_entityRegistry->advanceTick();
+    }
+
+    state.SetItemsProcessed(state.iterations() * selected);
+    state.counters["edit_bytes"] = static_cast<double>(edits.size());
+    state.counters["change_bytes"] = static_cast<double>(changes.size());
+}
+
 BENCHMARK_DEFINE_F(ECSBenchmark, ComponentRemoval)(benchmark::State& state)
 {
     // Pre-create entities with multiple components
@@ -371,6 +534,81 @@ BENCHMARK_DEFINE_F(ECSBenchmark, ViewSubsetIteration_MultipleComponents)(benchma
                             (sizeof(Position) + sizeof(Velocity)));
 }
 
+BENCHMARK_DEFINE_F(ECSBenchmark, ViewSubsetIteration_Chunked)(benchmark::State& state)
+{
+    const int entityCount = state.range(0);
+
+    EntityRegistry registry(g_componentRegistry.get(), ArchetypeStorageMode::chunked);
+    registry.createEntityBulk<Position, Velocity>(entityCount);
+
+    for (auto _ : state)
+    {
+        auto view = registry.viewSubset<Position, Velocity>();
+        if (view)
+        {
+            view->forEachChunk(
+                [](size_t count, EntityMeta* metas, Position* pos, Velocity* vel)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        pos[i].x += vel[i].dx; // Simulate work
+                        pos[i].y += vel[i].dy;
+                        pos[i].z += vel[i].dz;
+                    }
+                    benchmark::DoNotOptimize(pos);
+                });
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * entityCount);
+    state.SetBytesProcessed(state.iterations() * entityCount *
+                            (sizeof(Position) + sizeof(Velocity)));
+}
+
+// Same work as ViewSubsetIteration_Chunked through column spans (aligned to
+// k_columnSpanAlignment). The interleaved variant measures the gather/scatter cost.
+static void integrateSpans(EntityRegistry& _registry)
+{
+    _registry.query<Position, detail::Read<Velocity>>().forEachChunk(
+        [](std::span<const EntityMeta>, std::span<Position> _pos, std::span<const Velocity> _vel)
+        {
+            for (size_t i = 0; i < _pos.size(); ++i)
+            {
+                _pos[i].x += _vel[i].dx;
+                _pos[i].y += _vel[i].dy;
+                _pos[i].z += _vel[i].dz;
+            }
+            benchmark::DoNotOptimize(_pos.data());
+        });
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, ViewSubsetIteration_ChunkedSpans)(benchmark::State& state)
+{
+    const int entityCount = state.range(0);
+
+    EntityRegistry registry(g_componentRegistry.get(), ArchetypeStorageMode::chunked);
+    registry.createEntityBulk<Position, Velocity>(entityCount);
+
+    for (auto _ : state) integrateSpans(registry);
+
+    state.SetItemsProcessed(state.iterations() * entityCount);
+    state.SetBytesProcessed(state.iterations() * entityCount *
+                            (sizeof(Position) + sizeof(Velocity)));
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, ViewSubsetIteration_InterleavedSpans)(benchmark::State& state)
+{
+    const int entityCount = state.range(0);
+
+    g_entityRegistry->createEntityBulk<Position, Velocity>(entityCount);
+
+    for (auto _ : state) integrateSpans(*g_entityRegistry);
+
+    state.SetItemsProcessed(state.iterations() * entityCount);
+    state.SetBytesProcessed(state.iterations() * entityCount *
+                            (sizeof(Position) + sizeof(Velocity)));
+}
+
 BENCHMARK_DEFINE_F(ECSBenchmark, ViewSubsetIteration_Iterator)(benchmark::State& state)
 {
     const int entityCount = state.range(0);
@@ -394,7 +632,138 @@ BENCHMARK_DEFINE_F(ECSBenchmark, ViewSubsetIteration_Iterator)(benchmark::State&
     state.SetItemsProcessed(state.iterations() * entityCount);
 }
 
+// Creates one Position + Velocity entity per combination of markers (2^k_markerCount archetypes)
+static void createEntitiesAcrossManyArchetypes(int entitiesPerArchetype)
+{
+    for (size_t mask = 0; mask < (size_t(1) << k_markerCount); ++mask)
+    {
+        for (int i = 0; i < entitiesPerArchetype; ++i)
+        {
+            EntityMeta meta = g_entityRegistry->createEntity<Position, Velocity>();
+
+            [&]<size_t... Is>(std::index_sequence<Is...>)
+            {
+                ((mask & (size_t(1) << Is) ? g_entityRegistry->addComponents<Marker<Is>>(meta.id)
+                                           : void()),
+                 ...);
+            }(std::make_index_sequence<k_markerCount>{});
+        }
+    }
+}
+
+// Runs a frame of state.range(0) systems, each re-resolving its matching archetypes
+BENCHMARK_DEFINE_F(ECSBenchmark, SystemsPerFrame_ViewSubset)(benchmark::State& state)
+{
+    const int systemCount = state.range(0);
+
+    createEntitiesAcrossManyArchetypes(1);
+
+    for (auto _ : state)
+    {
+        for (int system = 0; system < systemCount; ++system)
+        {
+            auto view = g_entityRegistry->viewSubset<Position, Velocity, Marker<0>>();
+            view->forEach([](EntityMeta, Position& pos, Velocity& vel, Marker<0>&)
+                          { pos.x += vel.dx; });
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * systemCount);
+}
+
+// Same frame as above, each system iterating a persistent query instead
+BENCHMARK_DEFINE_F(ECSBenchmark, SystemsPerFrame_Query)(benchmark::State& state)
+{
+    const int systemCount = state.range(0);
+
+    createEntitiesAcrossManyArchetypes(1);
+    auto query = g_entityRegistry->query<Position, Velocity, Marker<0>>();
+
+    for (auto _ : state)
+    {
+        for (int system = 0; system < systemCount; ++system)
+        {
+            query.forEach([](EntityMeta, Position& pos, Velocity& vel, Marker<0>&)
+                          { pos.x += vel.dx; });
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * systemCount);
+}
+
+// Moves state.range(0) entities, 70% of them carrying a Marker<0> that freezes them in place
+static void createPartlyFrozenEntities(int entity_count)
+{
+    for (int i = 0; i < entity_count; ++i)
+    {
+        EntityMeta meta = g_entityRegistry->createEntity<Position, Velocity>();
+        if (i % 10 < 7) g_entityRegistry->addComponents<Marker<0>>(meta.id);
+    }
+}
+
+// The system visits every entity and rejects the frozen ones per row
+BENCHMARK_DEFINE_F(ECSBenchmark, SkipFrozen_BranchReject)(benchmark::State& state)
+{
+    createPartlyFrozenEntities(state.range(0));
+    auto query = g_entityRegistry->query<Position, detail::Read<Velocity>,
+                                         detail::Optional<Marker<0>>>();
+
+    for (auto _ : state)
+    {
+        query.forEach(
+            [](EntityMeta, Position& pos, const Velocity& vel, Marker<0>* frozen)
+            {
+                if (!frozen) pos.x += vel.dx;
+            });
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Same system with the frozen archetypes excluded once, when the query matches them
+BENCHMARK_DEFINE_F(ECSBenchmark, SkipFrozen_Without)(benchmark::State& state)
+{
+    createPartlyFrozenEntities(state.range(0));
+    auto query = g_entityRegistry->query<Position, detail::Read<Velocity>,
+                                         detail::Without<Marker<0>>>();
+
+    for (auto _ : state)
+    {
+        query.forEach([](EntityMeta, Position& pos, const Velocity& vel) { pos.x += vel.dx; });
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
 // Stress test - mixed operations
+BENCHMARK_DEFINE_F(ECSBenchmark, RandomAccess_ByHandle)(benchmark::State& state)
+{
+    const int entityCount = state.range(0);
+
+    createEntitiesWithCompsCombinations(entityCount);
+
+    // Build a shuffled list of handles to simulate targeting lookups
+    std::vector<EntityMeta> handles;
+    auto view = g_entityRegistry->viewSubset<Position>();
+    if (view) view->forEach([&](EntityMeta meta, Position&) { handles.push_back(meta); });
+
+    std::mt19937 gen(42);
+    std::shuffle(handles.begin(), handles.end(), gen);
+
+    for (auto _ : state)
+    {
+        for (const auto& handle : handles)
+        {
+            if (!g_entityRegistry->isEntityValid(handle)) continue;
+
+            auto result = g_entityRegistry->getComponentsForEntity<Position, Velocity>(handle.id);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * handles.size());
+}
+
 BENCHMARK_DEFINE_F(ECSBenchmark, MixedOperations)(benchmark::State& state)
 {
     std::random_device rd;
@@ -464,6 +833,372 @@ BENCHMARK_DEFINE_F(ECSBenchmark, MixedOperations)(benchmark::State& state)
     state.counters["archetypes"] = g_entityRegistry->archetypeCount();
 }
 
+// Level load: replaying the creations of a level vs reading a snapshot of it.
+BENCHMARK_DEFINE_F(ECSBenchmark, LevelLoad_Replay)(benchmark::State& state)
+{
+    const int entity_count = state.range(0);
+
+    for (auto _ : state)
+    {
+        g_entityRegistry->clear();
+
+        for (int i = 0; i < entity_count; ++i)
+        {
+            const float f = static_cast<float>(i);
+            g_entityRegistry->createEntity<Position, Velocity, Health>(
+                std::make_tuple(f, f, f), std::make_tuple(1.0f, 0.0f, 0.0f),
+                std::make_tuple(100, 100));
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * entity_count);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, LevelLoad_Snapshot)(benchmark::State& state)
+{
+    const int entity_count = state.range(0);
+
+    for (int i = 0; i < entity_count; ++i)
+    {
+        const float f = static_cast<float>(i);
+        g_entityRegistry->createEntity<Position, Velocity, Health>(
+            std::make_tuple(f, f, f), std::make_tuple(1.0f, 0.0f, 0.0f), std::make_tuple(100, 100));
+    }
+
+    std::vector<uint8_t> snapshot;
+    g_entityRegistry->writeSnapshot(snapshot);
+
+    for (auto _ : state)
+    {
+        g_entityRegistry->readSnapshot(snapshot);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * entity_count);
+    state.counters["bytes"] = static_cast<double>(snapshot.size());
+}
+
+// Render batching: 1% of the renderables change mesh every frame, then the frame walks them in
+// mesh order. Baseline sorts (meshId, entity) pairs every frame, the group restores its order.
+static void changeMeshes(int entity_count, int change_count, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> entity(0, entity_count - 1);
+    std::uniform_int_distribution<int> mesh(0, 63);
+
+    for (int i = 0; i < change_count; ++i)
+    {
+        const EntityID id = static_cast<EntityID>(entity(rng));
+        std::get<0>(*g_entityRegistry->getComponentsForEntity<Renderable>(id)).meshId = mesh(rng);
+        g_entityRegistry->markChanged<Renderable>(id);
+    }
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, RenderBatches_SortPerFrame)(benchmark::State& state)
+{
+    const int entity_count = state.range(0);
+    std::mt19937 rng(42);
+
+    g_entityRegistry->createEntityBulk<Transform, Renderable>(entity_count);
+    changeMeshes(entity_count, entity_count * 4, rng);
+
+    auto query = g_entityRegistry->query<Transform, Renderable>();
+    std::vector<std::pair<int, EntityID>> order;
+
+    for (auto _ : state)
+    {
+        changeMeshes(entity_count, entity_count / 100, rng);
+
+        order.clear();
+        query.view().readOnly().forEach([&](EntityMeta _meta, Transform&, Renderable& _r)
+                                        { order.emplace_back(_r.meshId, _meta.id); });
+        std::sort(order.begin(), order.end());
+
+        float sum = 0.0f;
+        for (const auto& [mesh, id] : order)
+        {
+            sum += std::get<0>(*g_entityRegistry->getComponentsForEntity<Transform>(id)).matrix[0];
+        }
+        benchmark::DoNotOptimize(sum);
+
+        g_entityRegistry->advanceTick();
+    }
+
+    state.SetItemsProcessed(state.iterations() * entity_count);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, RenderBatches_GroupBy)(benchmark::State& state)
+{
+    const int entity_count = state.range(0);
+    std::mt19937 rng(42);
+
+    g_entityRegistry->createEntityBulk<Transform, Renderable>(entity_count);
+    changeMeshes(entity_count, entity_count * 4, rng);
+    g_entityRegistry->groupBy<Renderable>([](const Renderable& _a, const Renderable& _b)
+                                          { return _a.meshId < _b.meshId; });
+
+    auto query = g_entityRegistry->query<Transform, Renderable>();
+
+    for (auto _ : state)
+    {
+        changeMeshes(entity_count, entity_count / 100, rng);
+        g_entityRegistry->updateGroups();
+
+        float sum = 0.0f;
+        query.view().readOnly().forEach([&](EntityMeta, Transform& _t, Renderable&)
+                                        { sum += _t.matrix[0]; });
+        benchmark::DoNotOptimize(sum);
+
+        g_entityRegistry->advanceTick();
+    }
+
+    g_entityRegistry->ungroup<Renderable>();
+    state.SetItemsProcessed(state.iterations() * entity_count);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Production-Shaped Workloads
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Creates entities with Position, Velocity and every WideField (26 components, ~420-byte rows)
+static void createWideEntities(EntityRegistry& _registry, int _count)
+{
+    [&]<size_t... Is>(std::index_sequence<Is...>)
+    {
+        _registry.createEntityBulk<Position, Velocity, WideField<Is>...>(_count);
+    }(std::make_index_sequence<k_wideFieldCount>{});
+}
+
+// Touches one (Position) or two (Position, Velocity) columns of a wide archetype: interleaved
+// rows pull the whole row through the cache, chunked columns only the touched components.
+static void touchWideColumns(benchmark::State& _state, ArchetypeStorageMode _mode, int _columns)
+{
+    const int entityCount = _state.range(0);
+
+    EntityRegistry registry(g_componentRegistry.get(), _mode);
+    createWideEntities(registry, entityCount);
+
+    for (auto _ : _state)
+    {
+        if (_columns == 1)
+        {
+            registry.query<Position>().forEach([](EntityMeta, Position& _pos) { _pos.x += 1.0f; });
+        }
+        else
+        {
+            registry.query<Position, detail::Read<Velocity>>().forEach(
+                [](EntityMeta, Position& _pos, const Velocity& _vel)
+                {
+                    _pos.x += _vel.dx;
+                    _pos.y += _vel.dy;
+                    _pos.z += _vel.dz;
+                });
+        }
+        benchmark::ClobberMemory();
+    }
+
+    const size_t touched = _columns == 1 ? sizeof(Position) : sizeof(Position) + sizeof(Velocity);
+    _state.SetItemsProcessed(_state.iterations() * entityCount);
+    _state.SetBytesProcessed(_state.iterations() * entityCount * touched);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, WideArchetype_TouchOneColumn_Interleaved)(benchmark::State& state)
+{
+    touchWideColumns(state, ArchetypeStorageMode::interleaved, 1);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, WideArchetype_TouchOneColumn_Chunked)(benchmark::State& state)
+{
+    touchWideColumns(state, ArchetypeStorageMode::chunked, 1);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, WideArchetype_TouchTwoColumns_Interleaved)(benchmark::State& state)
+{
+    touchWideColumns(state, ArchetypeStorageMode::interleaved, 2);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, WideArchetype_TouchTwoColumns_Chunked)(benchmark::State& state)
+{
+    touchWideColumns(state, ArchetypeStorageMode::chunked, 2);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, WideArchetype_BulkCreation)(benchmark::State& state)
+{
+    const int entityCount = state.range(0);
+
+    for (auto _ : state)
+    {
+        createWideEntities(*g_entityRegistry, entityCount);
+
+        state.PauseTiming();
+        g_entityRegistry->clear();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * entityCount);
+}
+
+// Looks two components of a wide archetype up by handle, in random order
+static void randomAccessWide(benchmark::State& _state, ArchetypeStorageMode _mode)
+{
+    using LastField = WideField<k_wideFieldCount - 1>;
+    const int entityCount = _state.range(0);
+
+    EntityRegistry registry(g_componentRegistry.get(), _mode);
+    createWideEntities(registry, entityCount);
+
+    std::vector<EntityID> handles(entityCount);
+    std::iota(handles.begin(), handles.end(), EntityID{0});
+    std::shuffle(handles.begin(), handles.end(), std::mt19937(42));
+
+    for (auto _ : _state)
+    {
+        for (EntityID eid : handles)
+        {
+            auto result = registry.getComponentsForEntity<Position, LastField>(eid);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * handles.size());
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, RandomAccess_WideInterleaved)(benchmark::State& state)
+{
+    randomAccessWide(state, ArchetypeStorageMode::interleaved);
+}
+
+BENCHMARK_DEFINE_F(ECSBenchmark, RandomAccess_WideChunked)(benchmark::State& state)
+{
+    randomAccessWide(state, ArchetypeStorageMode::chunked);
+}
+
+// Adds the marker if the entity lacks it and removes it otherwise
+template <size_t N>
+static void toggleMarker(EntityID _eid)
+{
+    if (g_entityRegistry->getComponentsForEntity<Marker<N>>(_eid))
+    {
+        g_entityRegistry->removeComponents<Marker<N>>(_eid);
+    }
+    else
+    {
+        g_entityRegistry->addComponents<Marker<N>>(_eid);
+    }
+}
+
+// Iterates state.range(0) entities after state.range(1) rounds of churn: every round toggles a
+// random marker on 10% of the entities and destroys then recreates another 10% (recycled IDs,
+// swap-and-pop holes refilled out of order). Arg 0 is the unfragmented baseline.
+BENCHMARK_DEFINE_F(ECSBenchmark, Fragmentation_IterateAfterChurn)(benchmark::State& state)
+{
+    const int entityCount = state.range(0);
+    const int churnRounds = state.range(1);
+
+    createEntitiesAcrossManyArchetypes(entityCount >> k_markerCount);
+
+    std::vector<EntityID> alive;
+    g_entityRegistry->query<Position>().forEach([&](EntityMeta _meta, Position&)
+                                                { alive.push_back(_meta.id); });
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> entity(0, alive.size() - 1);
+    std::uniform_int_distribution<size_t> marker(0, k_markerCount - 1);
+
+    for (int round = 0; round < churnRounds; ++round)
+    {
+        for (size_t i = 0; i < alive.size() / 10; ++i)
+        {
+            const EntityID eid = alive[entity(rng)];
+            const size_t which = marker(rng);
+
+            [&]<size_t... Is>(std::index_sequence<Is...>)
+            {
+                ((which == Is ? toggleMarker<Is>(eid) : void()), ...);
+            }(std::make_index_sequence<k_markerCount>{});
+        }
+
+        for (size_t i = 0; i < alive.size() / 10; ++i)
+        {
+            EntityID& eid = alive[entity(rng)];
+            g_entityRegistry->destroyEntity(eid);
+            eid = g_entityRegistry->createEntity<Position, Velocity>().id;
+        }
+    }
+
+    auto query = g_entityRegistry->query<Position, detail::Read<Velocity>>();
+
+    for (auto _ : state)
+    {
+        query.forEach(
+            [](EntityMeta, Position& _pos, const Velocity& _vel)
+            {
+                _pos.x += _vel.dx;
+                _pos.y += _vel.dy;
+                _pos.z += _vel.dz;
+            });
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * alive.size());
+    state.counters["archetypes"] = g_entityRegistry->archetypeCount();
+    state.counters["bytes_per_entity"] =
+        static_cast<double>(g_entityRegistry->totalMemoryUsageInBytes()) / alive.size();
+}
+
+// Moves a whole Position + Velocity archetype to Position + Velocity + Health and back
+BENCHMARK_DEFINE_F(ECSBenchmark, BulkMigration_ModifyComponents)(benchmark::State& state)
+{
+    const int entityCount = state.range(0);
+
+    g_entityRegistry->createEntityBulk<Position, Velocity>(entityCount);
+
+    for (auto _ : state)
+    {
+        g_entityRegistry->migrateArchetypeModifyComponents(
+            detail::From<Position, Velocity>{}, detail::Add<Health>{}, detail::Remove<>{});
+        g_entityRegistry->migrateArchetypeModifyComponents(
+            detail::From<Position, Velocity, Health>{}, detail::Add<>{}, detail::Remove<Health>{});
+    }
+
+    state.SetItemsProcessed(state.iterations() * entityCount * 2);
+}
+
+// Same integration as ViewSubsetIteration_Chunked spread over the pool (grain = state.range(1))
+BENCHMARK_DEFINE_F(ECSBenchmark, ParallelIteration_Chunked)(benchmark::State& state)
+{
+    const int entityCount = state.range(0);
+    const size_t grainSize = state.range(1);
+
+    EntityRegistry registry(g_componentRegistry.get(), ArchetypeStorageMode::chunked);
+    registry.createEntityBulk<Position, Velocity>(entityCount);
+
+    mosaic::exec::ThreadPool& pool = benchmarkPool();
+    auto query = registry.query<Position, detail::Read<Velocity>>();
+
+    for (auto _ : state)
+    {
+        query.parallelForEachChunk(
+            pool,
+            [](size_t _count, EntityMeta*, Position* _pos, const Velocity* _vel)
+            {
+                for (size_t i = 0; i < _count; ++i)
+                {
+                    _pos[i].x += _vel[i].dx;
+                    _pos[i].y += _vel[i].dy;
+                    _pos[i].z += _vel[i].dz;
+                }
+            },
+            grainSize);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * entityCount);
+    state.SetBytesProcessed(state.iterations() * entityCount *
+                            (sizeof(Position) + sizeof(Velocity)));
+}
+
 // Register benchmarks
 BENCHMARK_REGISTER_F(ECSBenchmark, EntityCreation_SingleComponent)->Unit(benchmark::kNanosecond);
 BENCHMARK_REGISTER_F(ECSBenchmark, EntityCreation_ThreeComponents)->Unit(benchmark::kNanosecond);
@@ -473,10 +1208,26 @@ BENCHMARK_REGISTER_F(ECSBenchmark, BatchEntityCreation)
     ->Range(10, 10000)
     ->Unit(benchmark::kMicrosecond);
 
+BENCHMARK_REGISTER_F(ECSBenchmark, MassSpawn_Interleaved)
+    ->Arg(500000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, MassSpawn_Adaptive)->Arg(500000)->Unit(benchmark::kMillisecond);
+
 BENCHMARK_REGISTER_F(ECSBenchmark, EntityDestruction)->Unit(benchmark::kNanosecond);
 
 BENCHMARK_REGISTER_F(ECSBenchmark, ComponentAddition)->Unit(benchmark::kNanosecond);
 BENCHMARK_REGISTER_F(ECSBenchmark, ComponentRemoval)->Unit(benchmark::kNanosecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, ComponentToggle)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, ComponentToggle_CommandBuffer)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, EditMessage_Drag)
+    ->Arg(1)
+    ->Arg(1000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, RandomAccess_ByHandle)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_REGISTER_F(ECSBenchmark, ViewSetIteration_SingleComponent)
     ->Range(100, 100000)
@@ -497,6 +1248,80 @@ BENCHMARK_REGISTER_F(ECSBenchmark, ViewSubsetIteration_MultipleComponents)
 BENCHMARK_REGISTER_F(ECSBenchmark, ViewSubsetIteration_Iterator)
     ->Range(100, 100000)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, ViewSubsetIteration_Chunked)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, ViewSubsetIteration_ChunkedSpans)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, ViewSubsetIteration_InterleavedSpans)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, SystemsPerFrame_ViewSubset)
+    ->Arg(60)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, SystemsPerFrame_Query)->Arg(60)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, SkipFrozen_BranchReject)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, SkipFrozen_Without)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, LevelLoad_Replay)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, LevelLoad_Snapshot)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, RenderBatches_SortPerFrame)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, RenderBatches_GroupBy)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, WideArchetype_TouchOneColumn_Interleaved)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, WideArchetype_TouchOneColumn_Chunked)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, WideArchetype_TouchTwoColumns_Interleaved)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, WideArchetype_TouchTwoColumns_Chunked)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, WideArchetype_BulkCreation)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, RandomAccess_WideInterleaved)
+    ->Arg(1 << 18)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ECSBenchmark, RandomAccess_WideChunked)
+    ->Arg(1 << 18)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, Fragmentation_IterateAfterChurn)
+    ->Args({1 << 18, 0})
+    ->Args({1 << 18, 20})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, BulkMigration_ModifyComponents)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ECSBenchmark, ParallelIteration_Chunked)
+    ->Args({1 << 20, 4096})
+    ->Args({1 << 20, 65536})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_REGISTER_F(ECSBenchmark, MixedOperations)
     ->Iterations(10000)
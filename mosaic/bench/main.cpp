@@ -1,3 +1,37 @@
 #include <benchmark/benchmark.h>
 
-BENCHMARK_MAIN();
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+// Unless --benchmark_out is given, the results are also written as JSON to
+// mosaic_benchmark.json so runs of different commits can be diffed (e.g. with compare.py from
+// google/benchmark's tools).
+int main(int _argc, char** _argv)
+{
+    static char s_outArg[] = "--benchmark_out=mosaic_benchmark.json";
+    static char s_formatArg[] = "--benchmark_out_format=json";
+
+    std::vector<char*> args(_argv, _argv + _argc);
+
+    const bool hasOut = std::ranges::any_of(
+        args, [](std::string_view _arg) { return _arg.starts_with("--benchmark_out="); });
+    if (!hasOut)
+    {
+        args.push_back(s_outArg);
+        args.push_back(s_formatArg);
+    }
+
+    int argc = static_cast<int>(args.size());
+    benchmark::Initialize(&argc, args.data());
+    if (benchmark::ReportUnrecognizedArguments(argc, args.data())) return 1;
+
+#if defined(MOSAIC_BENCH_GIT_COMMIT)
+    benchmark::AddCustomContext("git_commit", MOSAIC_BENCH_GIT_COMMIT);
+#endif
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
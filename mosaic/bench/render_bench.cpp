@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <lyra/lyra.hpp>
+#include <nlohmann/json.hpp>
+
+#include <mosaic/core/sys_info.hpp>
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/graphics/render_system.hpp>
+#include <mosaic/tools/memory_tracker.hpp>
+#include <mosaic/tools/tracer.hpp>
+
+using namespace mosaic;
+
+// The frames rendered before the measured ones: the pipelines compiled, the frames in flight
+// filled and the GPU clocks up
+static constexpr uint32_t k_warmupFrames = 60;
+
+// Offscreen contexts rendered together for a number of frames, each drawing its built-in frame
+struct Scene
+{
+    std::string_view name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t contexts; // more than one: the batched recording and submission of the backend
+};
+
+static constexpr Scene k_scenes[] = {
+    {"triangle_1080p", 1920, 1080, 1},
+    {"triangle_4k", 3840, 2160, 1},
+    {"four_contexts_1080p", 1920, 1080, 4},
+};
+
+// In milliseconds
+struct Timings
+{
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+static Timings summarize(std::vector<double> _samples)
+{
+    Timings timings;
+    if (_samples.empty()) return timings;
+
+    std::sort(_samples.begin(), _samples.end());
+
+    const auto percentile = [&](double _fraction)
+    { return _samples[static_cast<size_t>(_fraction * static_cast<double>(_samples.size() - 1))]; };
+
+    for (double sample : _samples) timings.mean += sample;
+    timings.mean /= static_cast<double>(_samples.size());
+    timings.p50 = percentile(0.5);
+    timings.p95 = percentile(0.95);
+    timings.max = _samples.back();
+    return timings;
+}
+
+static nlohmann::json toJson(const Timings& _timings)
+{
+    return {{"mean", _timings.mean}, {"p50", _timings.p50}, {"p95", _timings.p95},
+            {"max", _timings.max}};
+}
+
+struct SceneResult
+{
+    Timings cpu;                // RenderSystem::update(): the recording and the submission
+    std::optional<Timings> gpu; // the "GPU frame" spans of the timestamp queries, if any
+    size_t allocatedBytes = 0;  // of the "vulkan" memory stats, at the end
+    size_t peakBytes = 0;       // over the measured frames
+};
+
+static std::optional<SceneResult> runScene(graphics::RenderSystem& _renderSystem,
+                                           const Scene& _scene, uint32_t _frames)
+{
+    std::vector<graphics::RenderContext*> contexts;
+    for (uint32_t i = 0; i < _scene.contexts; ++i)
+    {
+        auto context = _renderSystem.createHeadlessContext({_scene.width, _scene.height});
+        if (context.isErr())
+        {
+            std::fprintf(stderr, "%s: %s\n", std::string(_scene.name).c_str(),
+                         context.error().c_str());
+            for (graphics::RenderContext* created : contexts)
+            {
+                _renderSystem.destroyHeadlessContext(created);
+            }
+            return std::nullopt;
+        }
+
+        contexts.push_back(context.unwrap());
+    }
+
+    // The GPU spans are aggregated into the frames of markFrame(), the warmup out of the window
+    tools::Tracer::initialize(tools::Tracer::Config(true, false, 1000, 10000, 100, _frames));
+    auto* tracer = tools::Tracer::getInstance();
+
+    std::vector<double> cpuSamples;
+    cpuSamples.reserve(_frames);
+
+    for (uint32_t frame = 0; frame < k_warmupFrames + _frames; ++frame)
+    {
+        if (frame == k_warmupFrames) tools::MemoryTracker::resetPeaks();
+
+        _renderSystem.pace();
+
+        const auto start = std::chrono::steady_clock::now();
+        _renderSystem.update();
+        const std::chrono::duration<double, std::milli> cpu =
+            std::chrono::steady_clock::now() - start;
+
+        if (frame >= k_warmupFrames) cpuSamples.push_back(cpu.count());
+        if (tracer) tracer->markFrame();
+    }
+
+    SceneResult result;
+    result.cpu = summarize(std::move(cpuSamples));
+
+    const pieces::AllocationStats& stats = tools::MemoryTracker::getStats("vulkan");
+    result.allocatedBytes = stats.allocatedBytes();
+    result.peakBytes = stats.peakBytes();
+
+    // the queries of the last frames in flight are read by frames that never start
+    for (graphics::RenderContext* context : contexts) _renderSystem.destroyHeadlessContext(context);
+
+    if (tracer)
+    {
+        tracer->flush();
+
+        for (const tools::ScopeStatistics& scope : tracer->getScopeStatistics())
+        {
+            if (scope.name != "GPU frame") continue;
+
+            result.gpu = Timings{scope.mean, scope.p50, scope.p95, scope.max};
+        }
+
+        tools::Tracer::shutdown();
+    }
+
+    return result;
+}
+
+// Renders the canned scenes offscreen, without a window or a display, and reports their CPU and
+// GPU frame times and the device memory allocated: the results are written as JSON to
+// render_bench.json (unless --out is given), so runs of different commits can be diffed.
+int main(int _argc, const char** _argv)
+{
+    bool showHelp = false;
+    uint32_t frames = 600;
+    std::string backend = "vulkan";
+    std::string profile = "release";
+    std::string filter;
+    std::string output = "render_bench.json";
+
+    auto cli =
+        lyra::help(showHelp) |
+        lyra::opt(frames, "count")["-n"]["--frames"]("The frames measured per scene.") |
+        lyra::opt(backend, "vulkan|webgpu")["--backend"]("The render backend.") |
+        lyra::opt(profile, "release|development|debug")["--render-profile"](
+            "The validation, labels and checks measured, release by default.") |
+        lyra::opt(filter, "name")["--scene"]("Only the scenes whose name contains this.") |
+        lyra::opt(output, "path")["-o"]["--out"]("The JSON results, render_bench.json by default.");
+
+    const auto parsed = cli.parse({_argc, _argv});
+    if (!parsed)
+    {
+        std::fprintf(stderr, "%s\n", parsed.message().c_str());
+        return 1;
+    }
+
+    if (showHelp)
+    {
+        std::cout << cli << std::endl;
+        return 0;
+    }
+
+    if (backend != "vulkan" && backend != "webgpu")
+    {
+        std::fprintf(stderr, "unknown backend %s\n", backend.c_str());
+        return 1;
+    }
+
+    const auto profileType = graphics::parseRenderProfileType(profile);
+    if (!profileType)
+    {
+        std::fprintf(stderr, "unknown render profile %s\n", profile.c_str());
+        return 1;
+    }
+
+    // the recording of the contexts and the pipeline compilation run on the engine's pool
+    exec::ThreadPool pool;
+    if (pool.initialize(core::SystemInfo::getCPUInfo()).isErr())
+    {
+        std::fprintf(stderr, "failed to initialize the thread pool\n");
+        return 1;
+    }
+
+    // no window system: a headless device
+    auto renderSystem = graphics::RenderSystem::create(backend == "vulkan"
+                                                           ? graphics::RendererAPIType::vulkan
+                                                           : graphics::RendererAPIType::web_gpu);
+
+    renderSystem->setProfile(graphics::makeRenderProfile(*profileType));
+
+    auto initialized = renderSystem->initialize();
+    if (initialized.isErr())
+    {
+        std::fprintf(stderr, "%s\n", initialized.error().c_str());
+        pool.shutdown();
+        return 1;
+    }
+
+    nlohmann::json results;
+    results["context"]["backend"] = backend;
+    results["context"]["render_profile"] = profile;
+    results["context"]["frames"] = frames;
+#if defined(MOSAIC_BENCH_GIT_COMMIT)
+    results["context"]["git_commit"] = MOSAIC_BENCH_GIT_COMMIT;
+#endif
+    results["scenes"] = nlohmann::json::array();
+
+    std::printf("%-24s %12s %12s %12s %12s %12s\n", "scene", "cpu mean", "cpu p95", "gpu mean",
+                "gpu p95", "vulkan MiB");
+
+    for (const Scene& scene : k_scenes)
+    {
+        if (!filter.empty() && scene.name.find(filter) == std::string_view::npos) continue;
+
+        const auto result = runScene(*renderSystem, scene, frames);
+        if (!result) continue;
+
+        nlohmann::json entry;
+        entry["name"] = std::string(scene.name);
+        entry["width"] = scene.width;
+        entry["height"] = scene.height;
+        entry["contexts"] = scene.contexts;
+        entry["cpu_ms"] = toJson(result->cpu);
+        entry["gpu_ms"] = result->gpu ? toJson(*result->gpu) : nlohmann::json();
+        entry["memory"] = {{"allocated_bytes", result->allocatedBytes},
+                           {"peak_bytes", result->peakBytes}};
+        results["scenes"].push_back(std::move(entry));
+
+        const double mebibytes = static_cast<double>(result->peakBytes) / (1024.0 * 1024.0);
+        if (result->gpu)
+        {
+            std::printf("%-24s %10.3fms %10.3fms %10.3fms %10.3fms %12.1f\n",
+                        std::string(scene.name).c_str(), result->cpu.mean, result->cpu.p95,
+                        result->gpu->mean, result->gpu->p95, mebibytes);
+        }
+        else
+        {
+            std::printf("%-24s %10.3fms %10.3fms %12s %12s %12.1f\n",
+                        std::string(scene.name).c_str(), result->cpu.mean, result->cpu.p95, "-",
+                        "-", mebibytes);
+        }
+    }
+
+    renderSystem->shutdown();
+    renderSystem.reset();
+    pool.shutdown();
+
+    std::ofstream file(output);
+    file << results.dump(2) << std::endl;
+    if (!file)
+    {
+        std::fprintf(stderr, "failed to write %s\n", output.c_str());
+        return 1;
+    }
+
+    return results["scenes"].empty() ? 1 : 0;
+}
@@ -0,0 +1,369 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/exec/task_future.hpp>
+#include <mosaic/exec/parallel_for.hpp>
+
+#include "bench_pool.hpp"
+
+using namespace mosaic::exec;
+using namespace std::chrono_literals;
+
+// Publishes the pool counters accumulated since the last resetStats(), per iteration
+static void reportPoolStats(benchmark::State& _state, const ThreadPool& _pool)
+{
+    using benchmark::Counter;
+
+    const PoolStatsSnapshot stats = _pool.getPoolStats();
+
+    _state.counters["executed"] =
+        Counter(static_cast<double>(stats.totalTasksExecuted), Counter::kAvgIterations);
+    _state.counters["stolen"] =
+        Counter(static_cast<double>(stats.totalTasksStolen), Counter::kAvgIterations);
+    _state.counters["from_global"] =
+        Counter(static_cast<double>(stats.totalTasksReceivedFromGlobal), Counter::kAvgIterations);
+    _state.counters["idle_us"] =
+        Counter(static_cast<double>(stats.totalIdleNanoseconds) / 1e3, Counter::kAvgIterations);
+    _state.counters["steal_rate"] = stats.stealSuccessRate();
+}
+
+// Spins on the calling thread until the counter reaches the target
+static void waitFor(const std::atomic<uint64_t>& _counter, uint64_t _target)
+{
+    while (_counter.load(std::memory_order_acquire) < _target) std::this_thread::yield();
+}
+
+// Burns the CPU for about the given duration, the body of the non-empty tasks
+static void spinFor(std::chrono::nanoseconds _duration)
+{
+    const auto end = std::chrono::steady_clock::now() + _duration;
+    while (std::chrono::steady_clock::now() < end)
+    {
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Submission Throughput
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// state.range(0) empty tasks through the global queue, each with its future
+static void ThreadPool_EmptyTasks_Global(benchmark::State& _state)
+{
+    ThreadPool& pool = benchmarkPool();
+    const auto count = static_cast<uint64_t>(_state.range(0));
+    std::atomic<uint64_t> done{0};
+
+    pool.resetStats();
+
+    for (auto _ : _state)
+    {
+        done.store(0, std::memory_order_relaxed);
+
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            auto future =
+                pool.enqueueToGlobal([&done] { done.fetch_add(1, std::memory_order_release); });
+            benchmark::DoNotOptimize(future);
+        }
+
+        waitFor(done, count);
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+    reportPoolStats(_state, pool);
+}
+
+// state.range(0) empty tasks assigned round-robin to the workers by id, each with its future
+static void ThreadPool_EmptyTasks_Direct(benchmark::State& _state)
+{
+    ThreadPool& pool = benchmarkPool();
+    const auto count = static_cast<uint64_t>(_state.range(0));
+    const uint32_t workers = pool.getWorkersCount();
+    std::atomic<uint64_t> done{0};
+
+    pool.resetStats();
+
+    for (auto _ : _state)
+    {
+        done.store(0, std::memory_order_relaxed);
+
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            auto future = pool.enqueueToWorkerById(
+                static_cast<uint32_t>(i % workers),
+                [&done] { done.fetch_add(1, std::memory_order_release); });
+
+            if (!future)
+            {
+                _state.SkipWithError("A worker refuses direct submissions.");
+                return;
+            }
+        }
+
+        waitFor(done, count);
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+    reportPoolStats(_state, pool);
+}
+
+// state.range(0) fire-and-forget tasks pushed by a worker to its own queue (its deque in
+// lifo_local mode), the others stealing them
+static void ThreadPool_EmptyTasks_Local(benchmark::State& _state)
+{
+    ThreadPool& pool = benchmarkPool();
+    const auto count = static_cast<uint64_t>(_state.range(0));
+    std::atomic<uint64_t> done{0};
+
+    pool.resetStats();
+
+    for (auto _ : _state)
+    {
+        done.store(0, std::memory_order_relaxed);
+
+        pool.enqueueToCurrentWorker(
+            [&pool, &done, count]
+            {
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    pool.enqueueToCurrentWorker(
+                        [&done] { done.fetch_add(1, std::memory_order_release); });
+                }
+            });
+
+        waitFor(done, count);
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+    reportPoolStats(_state, pool);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fork-Join and Stealing
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Forks two halves and joins them, down to the given depth; the joining thread helps while it
+// waits (see parallelFor())
+static void forkJoin(ThreadPool& _pool, int _depth)
+{
+    if (_depth == 0) return;
+
+    parallelFor(_pool, 0, 2, 1, [&_pool, _depth](int) { forkJoin(_pool, _depth - 1); });
+}
+
+// A binary fork-join tree of depth state.range(0), 2^depth leaves
+static void ThreadPool_ForkJoin(benchmark::State& _state)
+{
+    ThreadPool& pool = benchmarkPool();
+    const auto depth = static_cast<int>(_state.range(0));
+
+    pool.resetStats();
+
+    for (auto _ : _state) forkJoin(pool, depth);
+
+    _state.SetItemsProcessed(_state.iterations() * (int64_t{1} << depth));
+    reportPoolStats(_state, pool);
+}
+
+// state.range(0) tasks of about 2 us all handed to worker 0, spread by stealing only
+static void ThreadPool_StealEfficiency(benchmark::State& _state)
+{
+    ThreadPool& pool = benchmarkPool();
+    const auto count = static_cast<uint64_t>(_state.range(0));
+    std::atomic<uint64_t> done{0};
+
+    pool.resetStats();
+
+    for (auto _ : _state)
+    {
+        done.store(0, std::memory_order_relaxed);
+
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            auto future = pool.enqueueToWorkerById(0,
+                                                   [&done]
+                                                   {
+                                                       spinFor(2us);
+                                                       done.fetch_add(1, std::memory_order_release);
+                                                   });
+
+            if (!future)
+            {
+                _state.SkipWithError("Worker 0 refuses direct submissions.");
+                return;
+            }
+        }
+
+        waitFor(done, count);
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+    reportPoolStats(_state, pool);
+
+    // the share of the tasks another worker than 0 ran
+    const PoolStatsSnapshot stats = pool.getPoolStats();
+    _state.counters["stolen_share"] =
+        stats.totalTasksExecuted > 0 ? static_cast<double>(stats.totalTasksStolen) /
+                                           static_cast<double>(stats.totalTasksExecuted)
+                                     : 0.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Latency
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Submission to start of one task once every worker parked, under the low_latency (0) or the
+// power_saving (1) idle policy. queue_wait_p50/p99 are the pool's own timings of the same tasks.
+static void ThreadPool_WakeUpLatency(benchmark::State& _state)
+{
+    ThreadPool& pool = benchmarkPool();
+
+    const IdlePolicy previousPolicy = pool.getIdlePolicy();
+    const PoolTelemetry previousTelemetry = pool.getTelemetry();
+
+    const IdlePolicy policy = _state.range(0) == 0 ? idle_policy_presets::low_latency
+                                                   : idle_policy_presets::power_saving;
+    pool.setIdlePolicy(policy);
+    pool.setTelemetry(PoolTelemetry::timings);
+    pool.resetStats();
+
+    for (auto _ : _state)
+    {
+        // long enough for the workers to spin, yield, then park
+        std::this_thread::sleep_for(policy.spinDuration + policy.yieldDuration + 500us);
+
+        std::atomic<int64_t> startedAt{0};
+        const auto submittedAt = std::chrono::steady_clock::now();
+
+        pool.enqueueToCurrentWorker(
+            [&startedAt]
+            {
+                startedAt.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                std::memory_order_release);
+            });
+
+        while (startedAt.load(std::memory_order_acquire) == 0) std::this_thread::yield();
+
+        const std::chrono::steady_clock::duration latency(startedAt.load() -
+                                                          submittedAt.time_since_epoch().count());
+        _state.SetIterationTime(std::chrono::duration<double>(latency).count());
+    }
+
+    const PoolStatsSnapshot stats = pool.getPoolStats();
+    _state.counters["queue_wait_p50_us"] = static_cast<double>(stats.queueWait.p50) / 1e3;
+    _state.counters["queue_wait_p99_us"] = static_cast<double>(stats.queueWait.p99) / 1e3;
+    reportPoolStats(_state, pool);
+
+    pool.setTelemetry(previousTelemetry);
+    pool.setIdlePolicy(previousPolicy);
+}
+
+// Creating a promise, completing it and reading its future on one thread
+static void TaskFuture_SetGet(benchmark::State& _state)
+{
+    for (auto _ : _state)
+    {
+        TaskPromise<int> promise;
+        TaskFuture<int> future = promise.getFuture();
+
+        promise.setValue(42);
+        benchmark::DoNotOptimize(future.get());
+    }
+
+    _state.SetItemsProcessed(_state.iterations());
+}
+
+// One task returning a value through the pool, waited for by the submitting thread
+static void TaskFuture_RoundTrip(benchmark::State& _state)
+{
+    ThreadPool& pool = benchmarkPool();
+
+    pool.resetStats();
+
+    for (auto _ : _state)
+    {
+        auto future = pool.enqueueToWorker([] { return 42; });
+        benchmark::DoNotOptimize(future->get());
+    }
+
+    _state.SetItemsProcessed(_state.iterations());
+    reportPoolStats(_state, pool);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scaling
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// parallelFor over 1M floats (grain 4096) with state.range(0) active workers, plus the calling
+// thread which helps
+static void ParallelFor_Scaling(benchmark::State& _state)
+{
+    ThreadPool& pool = benchmarkPool();
+    const uint32_t workers = std::min(static_cast<uint32_t>(_state.range(0)),
+                                      pool.getWorkersCount());
+
+    constexpr size_t k_count = size_t(1) << 20;
+    std::vector<float> values(k_count, 1.0f);
+
+    pool.setActiveWorkersCount(workers);
+    pool.resetStats();
+
+    for (auto _ : _state)
+    {
+        parallelFor(pool, size_t{0}, k_count, size_t{4096},
+                    [&values](size_t _begin, size_t _end)
+                    {
+                        for (size_t i = _begin; i < _end; ++i)
+                        {
+                            values[i] = std::sqrt(values[i] * 1.0001f + 0.5f);
+                        }
+                    });
+        benchmark::ClobberMemory();
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * k_count);
+    _state.counters["threads"] = workers + 1;
+    reportPoolStats(_state, pool);
+
+    pool.setActiveWorkersCount(pool.getWorkersCount());
+}
+
+// 1, 2, 4... active workers up to the count initialize() creates (one per logical core but one,
+// at least 5)
+static void scalingArguments(benchmark::internal::Benchmark* _benchmark)
+{
+    const uint32_t workers = std::max(std::thread::hardware_concurrency(), 6u) - 1;
+
+    for (uint32_t count = 1; count < workers; count *= 2) _benchmark->Arg(count);
+    _benchmark->Arg(workers);
+}
+
+BENCHMARK(ThreadPool_EmptyTasks_Global)->Arg(10000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(ThreadPool_EmptyTasks_Direct)->Arg(10000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(ThreadPool_EmptyTasks_Local)->Arg(10000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(ThreadPool_ForkJoin)->Arg(4)->Arg(8)->Arg(12)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(ThreadPool_StealEfficiency)->Arg(4096)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(ThreadPool_WakeUpLatency)
+    ->Arg(0)
+    ->Arg(1)
+    ->UseManualTime()
+    ->Iterations(200)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(TaskFuture_SetGet)->Unit(benchmark::kNanosecond);
+BENCHMARK(TaskFuture_RoundTrip)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(ParallelFor_Scaling)
+    ->Apply(scalingArguments)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 
 #include <pieces/core/result.hpp>
 
 #include "mosaic/defines.hpp"
 #include "mosaic/version.hpp"
+#include "mosaic/core/fixed_timestep.hpp"
 
 namespace mosaic
 {
@@ -25,9 +27,18 @@ namespace graphics
 class RenderSystem;
 }
 
+namespace exec
+{
+class MainThreadQueue;
+}
+
 namespace core
 {
 
+class VirtualFileSystem;
+class AssetManager;
+class ThermalGovernor;
+
 enum class ApplicationState
 {
     uninitialized,
@@ -92,6 +103,112 @@ class MOSAIC_API Application
     [[nodiscard]] input::InputSystem* getInputSystem() const;
     [[nodiscard]] graphics::RenderSystem* getRenderSystem() const;
 
+    /**
+     * @brief The queue of tasks other threads hand to the main thread, drained every frame after
+     * the window system update and before input and rendering, at most for the budget.
+     */
+    [[nodiscard]] exec::MainThreadQueue* getMainThreadQueue() const;
+
+    /**
+     * @brief The files of the application, the working directory mounted at the root on desktop
+     * and the web, the APK assets on Android. Archives and directories mounted over it override it.
+     */
+    [[nodiscard]] VirtualFileSystem* getFileSystem() const;
+
+    /**
+     * @brief The assets of the application, loaded through its file system. Updated every frame
+     * after the main thread queue (the finalizations run then); in reactive mode a load completed
+     * wakes the update.
+     */
+    [[nodiscard]] AssetManager* getAssetManager() const;
+
+    // Time the main thread queue may take per frame (2 ms by default)
+    void setMainThreadBudget(std::chrono::microseconds _budget);
+    [[nodiscard]] std::chrono::microseconds getMainThreadBudget() const;
+
+    /**
+     * @brief Renders each frame on a dedicated thread (exec::RenderThread) while the next one is
+     * simulated, off by default. A frame renders what onExtract() copied of the simulation: the
+     * frame of update() N is presented during update() N+1, a frame of latency more.
+     *
+     * The window events, the main thread queue and onExtract() run while no frame renders; the
+     * render contexts must not be touched from onPollInputs() or onUpdate() then.
+     */
+    void setPipelinedRendering(bool _enabled);
+    [[nodiscard]] bool isPipelinedRendering() const;
+
+    /**
+     * @brief Runs onFixedUpdate() in fixed steps of _settings.step before each onUpdate(), off by
+     * default. The frame times are accumulated either way: getFrameTiming() gives the smoothed
+     * delta for animation and, in this mode, the interpolation alpha for rendering.
+     */
+    void setFixedTimestep(bool _enabled, const FixedTimestepSettings& _settings = {});
+    [[nodiscard]] bool isFixedTimestep() const;
+    [[nodiscard]] const FixedTimestep& getFrameTiming() const;
+
+    /**
+     * @brief Starts the frames at most _framesPerSecond times a second, 0 (the default) for no
+     * limit: update() sleeps until the next frame is due, with Timer::sleepUntil() (paced within
+     * microseconds, without vsync too). The thermal governor may lower it.
+     */
+    void setFrameRateLimit(double _framesPerSecond);
+    [[nodiscard]] double getFrameRateLimit() const;
+
+    /**
+     * @brief Scales the engine down as the device heats up, on by default: the level of the
+     * ThermalGovernor, polled once a second, suspends ThreadPool workers, caps the frame rate and
+     * the dynamic resolution scale. Where the thermal state is unknown it stays nominal.
+     *
+     * The work of the main and render threads is reported every frame either way, through the
+     * platform hint sessions (Android 13+), against the interval of the frame rate limit.
+     */
+    void setThermalGovernor(bool _enabled);
+    [[nodiscard]] bool isThermalGovernor() const;
+    [[nodiscard]] const ThermalGovernor& getThermalGovernor() const;
+
+    /**
+     * @brief Renders only when something changed, off by default: input, a window event, a task
+     * drained from the main thread queue, invalidate() or a frame scheduled with scheduleFrame().
+     * In between, update() sleeps in the window system until an event arrives or a frame is due:
+     * idle, the tools built on the engine need neither the CPU nor the GPU.
+     *
+     * The updates with nothing to render run none of the on...() methods; the frame after an idle
+     * period accumulates no frame time, like the first after a resume.
+     */
+    void setReactive(bool _enabled);
+    [[nodiscard]] bool isReactive() const;
+
+    /**
+     * @brief Asks for a frame in reactive mode, from any thread (a ThreadPool task done): wakes
+     * the update waiting for events.
+     */
+    void invalidate() noexcept;
+
+    /// A frame is rendered at _time in reactive mode, at the latest (a caret blink, a timer).
+    void scheduleFrame(std::chrono::steady_clock::time_point _time);
+
+    /**
+     * @brief How long the platform loop may block for events before the next update(): zero
+     * unless reactive and idle, then until the next frame scheduled (bounded, for the tasks
+     * posted to the main thread queue without invalidate()).
+     */
+    [[nodiscard]] std::chrono::nanoseconds getIdleWait() const;
+
+   private:
+    // Application::update() with a render thread
+    pieces::RefResult<Application, std::string> updatePipelined();
+    // onFixedUpdate() then onUpdate(), the simulation of a frame
+    void simulate();
+    // Sleeps until the frame is due under the frame rate limit
+    void limitFrameRate();
+    // Polls the thermal state when due, while no frame renders
+    void governThermals();
+    void applyPerformanceLevel(uint32_t _level);
+    // Before anything the frame in flight renders with changes, its errors logged
+    void waitForRenderThread();
+    // Reactive: whether anything changed since the last frame, _drainedTasks run by this update
+    bool consumeChanges(size_t _drainedTasks);
+
    protected:
     virtual void onInitialize() = 0;
     virtual void onUpdate() = 0;
@@ -99,6 +216,19 @@ class MOSAIC_API Application
     virtual void onResume() = 0;
     virtual void onShutdown() = 0;
     virtual void onPollInputs() = 0;
+
+    /**
+     * @brief The _steps of the fixed timestep due this frame, each getFrameTiming().getStep()
+     * long: run in one batch (physics substeps), before onUpdate(). Only in fixed-step mode.
+     */
+    virtual void onFixedUpdate([[maybe_unused]] uint32_t _steps) {}
+
+    /**
+     * @brief Copies what the frame renders out of the simulation (its render snapshot, e.g. the
+     * batches of a scene::RenderExtraction), once a frame before it is rendered. With pipelined
+     * rendering the only point where both may be touched; nothing to copy otherwise.
+     */
+    virtual void onExtract() {}
 };
 
 } // namespace core
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+/**
+ * @brief The bytes of an asset, and what keeps them alive: the mapping of a file, the archive
+ * they are part of or the buffer they were decompressed to. Copies share the bytes.
+ */
+class FileData final
+{
+   private:
+    std::span<const uint8_t> m_bytes;
+    std::shared_ptr<const void> m_owner;
+
+   public:
+    FileData() = default;
+    FileData(std::span<const uint8_t> _bytes, std::shared_ptr<const void> _owner)
+        : m_bytes(_bytes), m_owner(std::move(_owner)){};
+
+    // Owns the buffer.
+    static FileData fromBuffer(std::vector<uint8_t> _buffer)
+    {
+        auto owner = std::make_shared<const std::vector<uint8_t>>(std::move(_buffer));
+        return FileData(std::span<const uint8_t>(*owner), owner);
+    }
+
+   public:
+    [[nodiscard]] std::span<const uint8_t> bytes() const noexcept { return m_bytes; }
+    [[nodiscard]] size_t size() const noexcept { return m_bytes.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_bytes.empty(); }
+
+    [[nodiscard]] const std::shared_ptr<const void>& getOwner() const noexcept { return m_owner; }
+};
+
+enum class AssetCompression : uint32_t
+{
+    none = 0, /// Stored as is, aligned: read in place.
+    lz4 = 1,  /// An LZ4 block (see compressLz4()), decompressed by every read.
+};
+
+/**
+ * @brief A packed archive of assets, read in place from its mapping: a table of contents (TOC)
+ * sorted by the hash of the paths, looked up by binary search, and the files, each stored as is
+ * at an offset aligned to k_alignment (SPIR-V, vertex data: read as they are) or compressed.
+ *
+ * The layout, little-endian: a header (magic "MPAK", version, entry count, alignment, TOC
+ * offset), the files, then the TOC (Entry). The paths themselves are not stored: the writer
+ * rejects two paths of the same hash.
+ *
+ * @see AssetArchiveWriter
+ */
+class MOSAIC_API AssetArchive final
+{
+   public:
+    static constexpr uint32_t k_version = 1;
+    static constexpr uint32_t k_alignment = 16;
+
+    struct Entry
+    {
+        uint64_t pathHash;
+        uint64_t offset;     // from the start of the archive
+        uint64_t storedSize; // in the archive
+        uint64_t size;       // once decompressed
+        AssetCompression compression;
+        uint32_t reserved;
+    };
+
+   private:
+    FileData m_data;
+    std::vector<Entry> m_entries; // by pathHash
+
+   public:
+    /**
+     * @brief Reads the TOC of the archive, which the data holds whole.
+     *
+     * @throws std::runtime_error if it is not an archive of this version, or a file is not in it.
+     */
+    explicit AssetArchive(FileData _data);
+
+    // Maps the archive file, same as above.
+    explicit AssetArchive(const std::filesystem::path& _path);
+
+   public:
+    /// "shaders/a.spv", "shaders\a.spv" and "./shaders/a.spv" are the same path.
+    [[nodiscard]] static std::string normalizePath(std::string_view _path);
+    [[nodiscard]] static uint64_t hashPath(std::string_view _path) noexcept;
+
+    [[nodiscard]] const Entry* find(std::string_view _path) const noexcept;
+    [[nodiscard]] const Entry* findHash(uint64_t _pathHash) const noexcept;
+
+    /**
+     * @brief The bytes of the file, in place when it is stored as is, decompressed otherwise.
+     *
+     * @throws std::runtime_error if the compressed bytes are corrupt.
+     */
+    [[nodiscard]] FileData read(const Entry& _entry) const;
+
+    // Same as above for the file of the path, none if it is not in the archive.
+    [[nodiscard]] std::optional<FileData> read(std::string_view _path) const;
+
+    [[nodiscard]] std::span<const Entry> getEntries() const noexcept { return m_entries; }
+    [[nodiscard]] size_t size() const noexcept { return m_entries.size(); }
+};
+
+/**
+ * @brief Packs files into an AssetArchive, in memory.
+ *
+ * @example
+ *   AssetArchiveWriter writer;
+ *   writer.addDirectory("assets");               // every file, by its path relative to "assets"
+ *   writer.write("assets.mpak");
+ */
+class MOSAIC_API AssetArchiveWriter final
+{
+   private:
+    std::vector<uint8_t> m_bytes; // the header left for finish()
+    std::vector<AssetArchive::Entry> m_entries;
+
+   public:
+    AssetArchiveWriter();
+
+   public:
+    /**
+     * @brief Adds a file, compressed if that makes it smaller (stored as is otherwise).
+     *
+     * @throws std::invalid_argument if a path of the same hash was added.
+     */
+    void add(std::string_view _path, std::span<const uint8_t> _bytes,
+             AssetCompression _compression = AssetCompression::lz4);
+
+    /**
+     * @brief Adds every file under the directory, by its path relative to it.
+     *
+     * @throws std::runtime_error if one cannot be read.
+     * @throws std::invalid_argument if two paths have the same hash.
+     */
+    void addDirectory(const std::filesystem::path& _directory,
+                      AssetCompression _compression = AssetCompression::lz4);
+
+    // The archive of the files added, the writer is left empty.
+    [[nodiscard]] std::vector<uint8_t> finish();
+
+    /**
+     * @brief Same as above, written to the file.
+     *
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void write(const std::filesystem::path& _path);
+
+    [[nodiscard]] size_t size() const noexcept { return m_entries.size(); }
+};
+
+} // namespace core
+} // namespace mosaic
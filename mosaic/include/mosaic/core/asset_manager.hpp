@@ -0,0 +1,422 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/cancellation.hpp"
+
+#include "asset_archive.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+class VirtualFileSystem;
+class AssetManager;
+class AssetLoaderBase;
+class AssetContext;
+
+enum class AssetState : uint8_t
+{
+    unloaded,   /// Never requested, released or evicted.
+    queued,     /// Waiting for a load slot, by priority.
+    reading,    /// Its bytes read (IoService or VirtualFileSystem).
+    waiting,    /// Its dependencies loading.
+    decoding,   /// Decoded on a ThreadPool worker.
+    finalizing, /// Decoded, finalized by the next AssetManager::update() (GPU uploads).
+    ready,
+    failed,
+};
+
+namespace detail
+{
+
+// The state of an asset shared by its handles and the manager
+struct AssetEntry
+{
+    std::string path;
+    std::type_index type;
+    AssetLoaderBase* loader;
+
+    std::atomic<AssetState> state = AssetState::unloaded;
+    std::atomic<uint32_t> handles = 0;
+    std::shared_ptr<void> asset; // published by state, ready
+    uint64_t size = 0;
+    std::string error; // failed
+
+    // the manager's, under its mutex
+    FileData bytes;
+    std::vector<std::shared_ptr<AssetEntry>> dependencies; // a handle held on each
+    std::vector<std::weak_ptr<AssetEntry>> dependents;     // waiting for this one
+    uint32_t pendingDependencies = 0;
+    exec::CancellationSource cancellation; // of the stage enqueued, renewed by every load
+    float priority = 0.0f;
+    uint64_t priorityFrame = 0; // the highest priority of that frame wins
+    uint64_t lastUse = 0;       // the last frame it was held or requested in
+    uint32_t stages = 0;        // of its load, enqueued or running
+    bool holdsSlot = false;     // reading or decoding, one of maxLoads
+
+    AssetEntry(std::string _path, std::type_index _type, AssetLoaderBase* _loader)
+        : path(std::move(_path)), type(_type), loader(_loader){};
+};
+
+} // namespace detail
+
+/**
+ * @brief A counted reference to an asset of an AssetManager: the asset stays loaded while one
+ * exists, a handle to a loading asset keeps its load going. Copies share the asset, from any
+ * thread.
+ */
+template <typename T>
+class AssetHandle final
+{
+   private:
+    std::shared_ptr<detail::AssetEntry> m_entry;
+
+    friend class AssetManager;
+    friend class AssetContext;
+
+    explicit AssetHandle(std::shared_ptr<detail::AssetEntry> _entry) : m_entry(std::move(_entry))
+    {
+        if (m_entry) m_entry->handles.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Counted by the manager already
+    AssetHandle(std::shared_ptr<detail::AssetEntry> _entry, std::adopt_lock_t) noexcept
+        : m_entry(std::move(_entry)){};
+
+   public:
+    AssetHandle() = default;
+    AssetHandle(const AssetHandle& _other) : AssetHandle(_other.m_entry) {};
+    AssetHandle(AssetHandle&& _other) noexcept : m_entry(std::move(_other.m_entry)) {};
+    ~AssetHandle() { reset(); }
+
+    AssetHandle& operator=(AssetHandle _other) noexcept
+    {
+        std::swap(m_entry, _other.m_entry);
+        return *this;
+    }
+
+   public:
+    void reset() noexcept
+    {
+        if (m_entry) m_entry->handles.fetch_sub(1, std::memory_order_acq_rel);
+        m_entry.reset();
+    }
+
+    // Null until ready.
+    [[nodiscard]] const T* get() const noexcept
+    {
+        return isReady() ? static_cast<const T*>(m_entry->asset.get()) : nullptr;
+    }
+
+    [[nodiscard]] AssetState getState() const noexcept
+    {
+        return m_entry ? m_entry->state.load(std::memory_order_acquire) : AssetState::unloaded;
+    }
+
+    [[nodiscard]] bool isValid() const noexcept { return m_entry != nullptr; }
+    [[nodiscard]] bool isReady() const noexcept { return getState() == AssetState::ready; }
+    [[nodiscard]] bool isFailed() const noexcept { return getState() == AssetState::failed; }
+
+    // Why it failed; set once failed.
+    [[nodiscard]] const std::string& getError() const noexcept { return m_entry->error; }
+    [[nodiscard]] const std::string& getPath() const noexcept { return m_entry->path; }
+
+    bool operator==(const AssetHandle&) const = default;
+};
+
+// An asset another one needs loaded first, by path and type
+struct AssetDependency
+{
+    std::string path;
+    std::type_index type;
+
+    template <typename T>
+    [[nodiscard]] static AssetDependency of(std::string _path)
+    {
+        return {std::move(_path), std::type_index(typeid(T))};
+    }
+};
+
+// What a loader decodes from: the bytes of the asset and its dependencies, all ready
+class AssetContext final
+{
+   private:
+    const FileData& m_bytes;
+    std::span<const std::shared_ptr<detail::AssetEntry>> m_dependencies;
+
+   public:
+    AssetContext(const FileData& _bytes,
+                 std::span<const std::shared_ptr<detail::AssetEntry>> _dependencies)
+        : m_bytes(_bytes), m_dependencies(_dependencies) {};
+
+   public:
+    [[nodiscard]] const FileData& getBytes() const noexcept { return m_bytes; }
+    [[nodiscard]] size_t getDependencyCount() const noexcept { return m_dependencies.size(); }
+
+    // The dependency listed at _index by getDependencies(), invalid if it is not a T.
+    template <typename T>
+    [[nodiscard]] AssetHandle<T> getDependency(size_t _index) const
+    {
+        const auto& entry = m_dependencies[_index];
+        if (entry->type != std::type_index(typeid(T))) return {};
+
+        return AssetHandle<T>(entry);
+    }
+};
+
+class AssetLoaderBase
+{
+   public:
+    virtual ~AssetLoaderBase() = default;
+
+    /**
+     * @brief The assets this one needs, read from its bytes (the textures of a material), loaded
+     * before it is decoded. Thread-safe, called on a worker.
+     */
+    [[nodiscard]] virtual std::vector<AssetDependency> getDependencies(const FileData& _bytes) const
+    {
+        (void)_bytes;
+        return {};
+    }
+
+    // Whether finalize() runs, on the thread calling AssetManager::update().
+    [[nodiscard]] virtual bool needsFinalize() const noexcept { return false; }
+
+   private:
+    friend class AssetManager;
+
+    // The asset decoded and its memory size, or why it failed
+    virtual pieces::Result<std::shared_ptr<void>, std::string> decodeErased(
+        const AssetContext& _context, uint64_t& _size) = 0;
+    virtual void finalizeErased(void* _asset) = 0;
+};
+
+/**
+ * @brief Decodes one type of asset for an AssetManager.
+ *
+ * @example
+ *   class MaterialLoader final : public AssetLoader<Material>
+ *   {
+ *       std::vector<AssetDependency> getDependencies(const FileData& _bytes) const override
+ *       {
+ *           return {AssetDependency::of<Texture>(parseAlbedoPath(_bytes))};
+ *       }
+ *
+ *       pieces::Result<Material, std::string> decode(const AssetContext& _context) override
+ *       {
+ *           return pieces::Ok<Material, std::string>(Material{_context.getDependency<Texture>(0)});
+ *       }
+ *   };
+ */
+template <typename T>
+class AssetLoader : public AssetLoaderBase
+{
+   public:
+    // Thread-safe, called on a worker once the dependencies are ready.
+    [[nodiscard]] virtual pieces::Result<T, std::string> decode(const AssetContext& _context) = 0;
+
+    // The bytes it holds, for the memory budget.
+    [[nodiscard]] virtual uint64_t getMemorySize(const T& _asset) const noexcept
+    {
+        (void)_asset;
+        return sizeof(T);
+    }
+
+    // On the thread calling AssetManager::update(), when needsFinalize().
+    virtual void finalize(T& _asset) { (void)_asset; }
+
+   private:
+    pieces::Result<std::shared_ptr<void>, std::string> decodeErased(const AssetContext& _context,
+                                                                    uint64_t& _size) final
+    {
+        auto result = decode(_context);
+        if (result.isErr())
+        {
+            return pieces::Err<std::shared_ptr<void>, std::string>(std::move(result.error()));
+        }
+
+        auto asset = std::make_shared<T>(std::move(result.unwrap()));
+        _size = getMemorySize(*asset);
+
+        return pieces::Ok<std::shared_ptr<void>, std::string>(std::move(asset));
+    }
+
+    void finalizeErased(void* _asset) final { finalize(*static_cast<T*>(_asset)); }
+};
+
+struct AssetManagerSettings
+{
+    uint64_t budget = 512ull * 1024 * 1024; // of the ready assets, those no handle holds evicted
+    uint32_t maxLoads = 16;                 // reading or decoding at once
+};
+
+struct AssetManagerStats
+{
+    size_t queued = 0;
+    size_t loading = 0; // reading, waiting, decoding or finalizing
+    size_t ready = 0;
+    size_t failed = 0;
+    uint64_t residentSize = 0; // of the ready assets
+    uint64_t evictions = 0;
+};
+
+/**
+ * @brief Loads assets by path through the VirtualFileSystem, shared by counted handles.
+ *
+ * A load reads the bytes (through the IoService when one runs and the file is on disk, from the
+ * VirtualFileSystem otherwise), loads the dependencies the loader lists, decodes on a ThreadPool
+ * worker, then finalizes on the thread of update() if the loader needs it. The stages of
+ * different assets overlap on the workers; at most maxLoads assets read or decode at once, the
+ * others queue by priority: the visible ones first, then the nearest (prioritize()). The
+ * dependencies of an asset load with its priority at least, a cycle fails the assets on it.
+ * Without a pool, the stages run in update().
+ *
+ * Releasing the last handle of a loading asset cancels it at the next update(): the stage not
+ * started yet is dropped through its CancellationToken. A ready asset without handles stays
+ * cached until the ready assets exceed the budget, the least recently used evicted first.
+ *
+ * @example
+ *   AssetManager assets(application.getFileSystem());
+ *   assets.registerLoader<Material>(std::make_unique<MaterialLoader>());
+ *
+ *   AssetHandle<Material> material = assets.load<Material>("materials/rock.json");
+ *   assets.prioritize(material, distance, visible); // every frame it is wanted
+ *   assets.update();                                 // every frame, once
+ *   if (const Material* rock = material.get()) draw(*rock);
+ */
+class MOSAIC_API AssetManager final
+{
+   private:
+    using EntryPointer = std::shared_ptr<detail::AssetEntry>;
+    using Stage = void (AssetManager::*)(const EntryPointer&);
+
+    VirtualFileSystem* m_files;
+    AssetManagerSettings m_settings;
+
+    std::unordered_map<std::type_index, std::unique_ptr<AssetLoaderBase>> m_loaders;
+    std::unordered_map<std::string, EntryPointer> m_entries; // by normalized path
+
+    std::vector<EntryPointer> m_queued;
+    std::vector<EntryPointer> m_finalizing;
+    std::vector<std::pair<EntryPointer, Stage>> m_inline; // without a pool, run by update()
+    size_t m_loading = 0;
+    uint64_t m_frame = 1;
+    uint64_t m_evictions = 0;
+    size_t m_completed = 0; // ready or failed since the last update()
+
+    size_t m_running = 0; // the stages enqueued or running
+    bool m_stopping = false;
+    std::condition_variable m_idle;
+
+    std::function<void()> m_onChange;
+    std::atomic<bool> m_changed = false;
+
+    mutable std::mutex m_mutex;
+
+   public:
+    explicit AssetManager(VirtualFileSystem* _files, const AssetManagerSettings& _settings = {});
+    // Cancels the loads and waits for the stages running
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+   public:
+    // Before the first load of the type.
+    template <typename T>
+    void registerLoader(std::unique_ptr<AssetLoader<T>> _loader)
+    {
+        std::lock_guard lock(m_mutex);
+        m_loaders[std::type_index(typeid(T))] = std::move(_loader);
+    }
+
+    /**
+     * @brief The handle of the asset, its load queued if it is not loaded. Thread-safe.
+     *
+     * @return An invalid handle if no loader handles T, or if the path is loaded as another type.
+     */
+    template <typename T>
+    [[nodiscard]] AssetHandle<T> load(std::string_view _path)
+    {
+        return AssetHandle<T>(acquire(_path, std::type_index(typeid(T))), std::adopt_lock);
+    }
+
+    /**
+     * @brief Wanted this frame at _distance, on screen or not: the highest priority of the frame
+     * wins, until the frame after. Thread-safe.
+     */
+    template <typename T>
+    void prioritize(const AssetHandle<T>& _handle, float _distance, bool _visible)
+    {
+        if (_handle.m_entry) prioritize(_handle.m_entry, _distance, _visible);
+    }
+
+    /**
+     * @brief Once a frame: finalizes the decoded assets, cancels the loads nothing holds, evicts
+     * over the budget and starts the queued loads.
+     *
+     * @return The assets that became ready or failed since the last update.
+     */
+    size_t update();
+
+    // Called from the thread completing a load, for a reactive application to wake up. Before
+    // the first load.
+    void setOnChange(std::function<void()> _onChange);
+
+    void setBudget(uint64_t _budget);
+    [[nodiscard]] uint64_t getBudget() const;
+
+    [[nodiscard]] AssetManagerStats getStats() const;
+
+   private:
+    // The entry counted by a handle, null if it cannot be loaded as _type
+    [[nodiscard]] EntryPointer acquire(std::string_view _path, std::type_index _type);
+    [[nodiscard]] EntryPointer acquireLocked(std::string_view _path, std::type_index _type,
+                                             float _priority);
+    void prioritize(const EntryPointer& _entry, float _distance, bool _visible);
+
+    // Under the lock
+    void queueLocked(const EntryPointer& _entry, float _priority);
+    void raiseLocked(detail::AssetEntry& _entry, float _priority);
+    void dispatchLocked();
+    void runLocked(const EntryPointer& _entry, Stage _stage);
+    void finishLocked(detail::AssetEntry& _entry);
+    void setSlotLocked(detail::AssetEntry& _entry, bool _holds);
+    void completeLocked(const EntryPointer& _entry);
+    void failLocked(const EntryPointer& _entry, std::string _error);
+    void unloadLocked(const EntryPointer& _entry);
+    void releaseDependenciesLocked(const EntryPointer& _entry);
+    [[nodiscard]] bool reachesLocked(const detail::AssetEntry& _from,
+                                     const detail::AssetEntry* _to) const;
+
+    // The stages, on the workers
+    void read(const EntryPointer& _entry);
+    void onRead(const EntryPointer& _entry, std::optional<FileData> _bytes, std::string _error);
+    void decode(const EntryPointer& _entry);
+    // A stage dropped by its token, or by the pool shutting down
+    void onDropped(const EntryPointer& _entry);
+
+    void notifyChange();
+};
+
+} // namespace core
+} // namespace mosaic
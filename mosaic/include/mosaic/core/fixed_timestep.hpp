@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+struct FixedTimestepSettings
+{
+    std::chrono::nanoseconds step = std::chrono::nanoseconds(16'666'667); // 60 Hz
+    uint32_t maxSteps = 5; // per frame, the time beyond is dropped rather than caught up on
+};
+
+/**
+ * @brief Splits the variable time of the frames into deterministic steps of the simulation.
+ *
+ * The time of each frame is accumulated and consumed a step at a time; what is left, less than a
+ * step, is carried to the next frame and gives the interpolation alpha between the last two
+ * simulated states for rendering. A frame owing more than maxSteps runs maxSteps and drops the
+ * rest: a slow step no longer owes more steps the next frame (the spiral of death), the
+ * simulation slows down instead.
+ *
+ * A smoothed frame time is kept alongside, for animation: the measures clamped to the time of
+ * maxSteps (a hitch, the first frame) before they are averaged.
+ */
+class MOSAIC_API FixedTimestep final
+{
+   private:
+    FixedTimestepSettings m_settings;
+
+    std::chrono::nanoseconds m_accumulator = {};
+    std::chrono::nanoseconds m_dropped = {}; // since the creation
+    std::chrono::nanoseconds m_smoothedDelta = {};
+    uint64_t m_stepCount = 0;
+
+   public:
+    explicit FixedTimestep(const FixedTimestepSettings& _settings = {});
+
+   public:
+    /// Accumulates the time of a frame; returns the steps it runs, at most maxSteps.
+    uint32_t advance(std::chrono::nanoseconds _frameTime) noexcept;
+
+    /// Between the state of the last step and the one of the next, in [0, 1).
+    [[nodiscard]] float getAlpha() const noexcept;
+
+    [[nodiscard]] std::chrono::nanoseconds getStep() const noexcept { return m_settings.step; }
+    [[nodiscard]] double getStepSeconds() const noexcept;
+    [[nodiscard]] std::chrono::nanoseconds getSmoothedDelta() const noexcept
+    {
+        return m_smoothedDelta;
+    }
+    [[nodiscard]] std::chrono::nanoseconds getDroppedTime() const noexcept { return m_dropped; }
+    [[nodiscard]] uint64_t getStepCount() const noexcept { return m_stepCount; }
+    [[nodiscard]] const FixedTimestepSettings& getSettings() const noexcept { return m_settings; }
+
+    /// Drops the time accumulated (after a pause, a load), the next frame starts a new step.
+    void reset() noexcept { m_accumulator = {}; }
+};
+
+} // namespace core
+} // namespace mosaic
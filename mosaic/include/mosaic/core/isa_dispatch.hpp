@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/core/sys_info.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+class CommandLineParser;
+
+/**
+ * @brief The instruction sets a kernel is compiled for: the base source of
+ * add_isa_specific_sources() (cmake/ConfigSIMD.cmake) and its _<isa> variants.
+ */
+enum class ISALevel : uint8_t
+{
+    scalar,
+    sse2,
+    sse41,
+    sse42,
+    avx,
+    avx2,
+    avx512f,
+    neon,
+};
+
+// "scalar", "sse2", "sse4.1", "sse4.2", "avx", "avx2", "avx512f", "neon"
+[[nodiscard]] MOSAIC_API const char* toString(ISALevel _level) noexcept;
+[[nodiscard]] MOSAIC_API std::optional<ISALevel> parseISALevel(std::string_view _name) noexcept;
+
+/// Whether _support runs the code compiled for _level (scalar always does).
+[[nodiscard]] MOSAIC_API bool isISASupported(ISALevel _level,
+                                             const CPUInfo::ISASupport& _support) noexcept;
+
+/**
+ * @brief The instruction sets of this CPU, the ones the OS saves the registers of (cpuid and
+ * xgetbv on x86, the compile target or the auxiliary vector on ARM). Cheap, unlike
+ * SystemInfo::getCPUInfo(); getHostISASupport() keeps the first result.
+ */
+[[nodiscard]] MOSAIC_API CPUInfo::ISASupport detectISASupport() noexcept;
+[[nodiscard]] MOSAIC_API const CPUInfo::ISASupport& getHostISASupport() noexcept;
+
+/**
+ * @brief Caps the variants the dispatches resolve to (avx2 runs the AVX2 kernels on an AVX-512
+ * CPU, scalar the base ones), to run the paths of older CPUs on this one. Only the dispatches
+ * resolved afterwards see it: set it at startup, before the first kernel runs.
+ */
+MOSAIC_API void setMaxISALevel(std::optional<ISALevel> _level) noexcept;
+[[nodiscard]] MOSAIC_API std::optional<ISALevel> getMaxISALevel() noexcept;
+
+/// Whether the dispatches may resolve to _level: supported by the host and within the cap.
+[[nodiscard]] MOSAIC_API bool isISAAllowed(ISALevel _level) noexcept;
+
+/// Registers --max-isa, the cap of setMaxISALevel(). Returns the error of the parser, if any.
+MOSAIC_API std::optional<std::string> registerISAOptions(CommandLineParser& _parser);
+
+// A kernel table compiled for an instruction set, returned by the getter of its variant file.
+template <typename Table>
+struct ISAVariant
+{
+    ISALevel level;
+    Table (*get)() noexcept;
+};
+
+/**
+ * @brief The kernels of the widest variant the CPU runs, resolved once: a table of function
+ * pointers (or a single one) of the base source, replaced by the table of the highest allowed
+ * variant. Held in a function-local static, the kernels then cost one indirect call:
+ *
+ *     static const core::ISADispatch<Kernels> kernels(makeKernels(), {
+ *     #if defined(SIMD_HAS_AVX2)
+ *         {core::ISALevel::avx2, &getKernelsAvx2},
+ *     #endif
+ *     });
+ *
+ * Only the variants compiled for the target (SIMD_HAS_<ISA>) are listed; the base source must
+ * run on every CPU of the target. The variant files leave this header out: compiled with wider
+ * flags, the inline functions of the standard library they would emit could be the ones kept.
+ */
+template <typename Table>
+class ISADispatch final
+{
+   private:
+    Table m_table;
+    std::optional<ISALevel> m_level; // empty for the base table
+
+   public:
+    ISADispatch(Table _base, std::initializer_list<ISAVariant<Table>> _variants) noexcept
+        : ISADispatch(_base, _variants, &isISAAllowed)
+    {
+    }
+
+    // With the predicate of the allowed variants, isISAAllowed() above.
+    ISADispatch(Table _base, std::initializer_list<ISAVariant<Table>> _variants,
+                bool (*_allowed)(ISALevel) noexcept) noexcept
+        : m_table(_base)
+    {
+        const ISAVariant<Table>* best = nullptr;
+        for (const ISAVariant<Table>& variant : _variants)
+        {
+            if (!_allowed(variant.level)) continue;
+            if (best == nullptr || variant.level > best->level) best = &variant;
+        }
+
+        if (best != nullptr)
+        {
+            m_table = best->get();
+            m_level = best->level;
+        }
+    }
+
+   public:
+    [[nodiscard]] const Table& get() const noexcept { return m_table; }
+    [[nodiscard]] const Table& operator*() const noexcept { return m_table; }
+    [[nodiscard]] const Table* operator->() const noexcept { return &m_table; }
+
+    /// The level of the variant resolved to, empty for the base table.
+    [[nodiscard]] std::optional<ISALevel> getLevel() const noexcept { return m_level; }
+};
+
+} // namespace core
+} // namespace mosaic
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+/**
+ * @brief Compresses the bytes to an LZ4 block (the raw block format, without the frame of the
+ * lz4 tool), read back by decompressLz4() or any LZ4 block decoder.
+ *
+ * Matches are found greedily through a hash table of 4-byte sequences: the ratio is that of the
+ * fast LZ4 levels, the point is the decompression speed.
+ */
+MOSAIC_API std::vector<uint8_t> compressLz4(std::span<const uint8_t> _input);
+
+/**
+ * @brief Decompresses an LZ4 block to exactly _output.size() bytes.
+ *
+ * @return false if the block is malformed or does not decompress to that size, _output is
+ * undefined then.
+ */
+MOSAIC_API [[nodiscard]] bool decompressLz4(std::span<const uint8_t> _input,
+                                            std::span<uint8_t> _output) noexcept;
+
+} // namespace core
+} // namespace mosaic
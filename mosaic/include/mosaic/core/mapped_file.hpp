@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+#include <windows.h>
+#elif defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_MACOS) || \
+    defined(MOSAIC_PLATFORM_ANDROID)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MOSAIC_MAPPED_FILE_MMAP
+#endif
+
+namespace mosaic
+{
+namespace core
+{
+
+/**
+ * @brief Read-only view of a whole file, memory-mapped where the platform allows it and read into
+ * a buffer otherwise (e.g. Emscripten).
+ */
+class MappedFile final
+{
+   private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<uint8_t> m_buffer;
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+
+   public:
+    /**
+     * @brief Maps the given file.
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::filesystem::path& _path)
+    {
+#if defined(MOSAIC_MAPPED_FILE_MMAP)
+        const int fd = ::open(_path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Failed to open " + _path.string());
+
+        struct stat info{};
+        if (::fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat " + _path.string());
+        }
+
+        m_size = static_cast<size_t>(info.st_size);
+        if (m_size > 0)
+        {
+            void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Failed to map " + _path.string());
+            }
+
+            // the whole file is read front to back once
+            ::madvise(data, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const uint8_t*>(data);
+        }
+
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+#elif defined(MOSAIC_PLATFORM_WINDOWS)
+        m_file = ::CreateFileW(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Failed to open " + _path.string());
+        }
+
+        LARGE_INTEGER size{};
+        ::GetFileSizeEx(m_file, &size);
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        if (m_size > 0)
+        {
+            m_mapping = ::CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            const void* data =
+                m_mapping ? ::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+            if (!data)
+            {
+                release();
+                throw std::runtime_error("Failed to map " + _path.string());
+            }
+            m_data = static_cast<const uint8_t*>(data);
+        }
+#else
+        std::ifstream file(_path, std::ios::binary | std::ios::ate);
+        if (!file) throw std::runtime_error("Failed to open " + _path.string());
+
+        m_buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(m_buffer.data()),
+                  static_cast<std::streamsize>(m_buffer.size()));
+
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+#endif
+    }
+
+    ~MappedFile() { release(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+   public:
+    [[nodiscard]] std::span<const uint8_t> bytes() const noexcept { return {m_data, m_size}; }
+
+   private:
+    void release() noexcept
+    {
+#if defined(MOSAIC_MAPPED_FILE_MMAP)
+        if (m_data) ::munmap(const_cast<uint8_t*>(m_data), m_size);
+#elif defined(MOSAIC_PLATFORM_WINDOWS)
+        if (m_data) ::UnmapViewOfFile(m_data);
+        if (m_mapping) ::CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) ::CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#endif
+        m_data = nullptr;
+    }
+};
+
+} // namespace core
+} // namespace mosaic
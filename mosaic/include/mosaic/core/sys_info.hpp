@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -48,7 +50,27 @@ struct MemoryMetrics
     size_t usedMemoryKB;  // Used memory in kilobytes
     size_t freeMemoryKB;  // Free memory in kilobytes
 
-    MemoryMetrics() : totalMemoryKB(0), usedMemoryKB(0), freeMemoryKB(0){};
+    size_t processResidentKB;     // Resident memory of this process (working set) in kilobytes
+    size_t processPeakResidentKB; // Highest resident memory of this process so far in kilobytes
+
+    MemoryMetrics()
+        : totalMemoryKB(0),
+          usedMemoryKB(0),
+          freeMemoryKB(0),
+          processResidentKB(0),
+          processPeakResidentKB(0){};
+};
+
+// Represents a logical processor (hardware thread) and where it sits in the CPU topology
+struct LogicalProcessorInfo
+{
+    uint32_t id;             // OS processor index, as used in affinity masks
+    uint32_t coreId;         // Physical core, the lowest id among its SMT siblings
+    uint32_t cacheGroup;     // Last-level cache (L3, CCX, cluster), the lowest id sharing it
+    uint32_t numaNode;       // NUMA node
+    uint8_t efficiencyClass; // Relative core performance, 0 for the slowest (E-cores, LITTLE)
+
+    LogicalProcessorInfo() : id(0), coreId(0), cacheGroup(0), numaNode(0), efficiencyClass(0){};
 };
 
 struct CPUInfo
@@ -61,22 +83,29 @@ struct CPUInfo
     uint32_t physicalCores;   // Number of physical cores
     float clockSpeedGHz;      // Clock speed in GHz
 
+    // Topology ordered by processor id, empty if the platform does not report it
+    std::vector<LogicalProcessorInfo> processors;
+    uint32_t performanceCores; // Physical cores of the highest efficiency class
+    uint32_t efficiencyCores;  // Physical cores of the lower classes (0 unless hybrid)
+    uint32_t numaNodes;        // Number of NUMA nodes (1 unless reported otherwise)
+
     struct ISASupport
     {
-        bool sse;     // Streaming SIMD Extensions
-        bool sse2;    // Streaming SIMD Extensions 2
-        bool sse3;    // Streaming SIMD Extensions 3
-        bool ssse3;   // Supplemental Streaming SIMD Extensions 3
-        bool sse41;   // Streaming SIMD Extensions 4.1
-        bool sse42;   // Streaming SIMD Extensions 4.2
-        bool avx;     // Advanced Vector Extensions
-        bool avx2;    // Advanced Vector Extensions 2
-        bool avx512;  // Advanced Vector Extensions 512
-        bool avx10;   // Advanced Vector Extensions 10
-        bool avx10_2; // Advanced Vector Extensions 10.2
-        bool neon;    // ARM Neon support
-        bool apx;     // Advanced Pixel Extensions
-        bool fp16;    // Floating Point 16-bit support
+        bool sse;         // Streaming SIMD Extensions
+        bool sse2;        // Streaming SIMD Extensions 2
+        bool sse3;        // Streaming SIMD Extensions 3
+        bool ssse3;       // Supplemental Streaming SIMD Extensions 3
+        bool sse41;       // Streaming SIMD Extensions 4.1
+        bool sse42;       // Streaming SIMD Extensions 4.2
+        bool avx;         // Advanced Vector Extensions
+        bool avx2;        // Advanced Vector Extensions 2
+        bool avx512;      // Advanced Vector Extensions 512
+        bool avx10;       // Advanced Vector Extensions 10
+        bool avx10_2;     // Advanced Vector Extensions 10.2
+        bool neon;        // ARM Neon support
+        bool wasmSimd128; // WebAssembly 128-bit SIMD
+        bool apx;         // Advanced Pixel Extensions
+        bool fp16;        // Floating Point 16-bit support
 
         ISASupport()
             : sse(false),
@@ -91,6 +120,7 @@ struct CPUInfo
               avx10(false),
               avx10_2(false),
               neon(false),
+              wasmSimd128(false),
               apx(false),
               fp16(false){};
     } isaSupport;
@@ -103,7 +133,13 @@ struct CPUInfo
           logicalCores(0),
           physicalCores(0),
           clockSpeedGHz(0.0f),
+          performanceCores(0),
+          efficiencyCores(0),
+          numaNodes(1),
           isaSupport(){};
+
+    // Whether the cores are of different classes (Intel P/E-cores, ARM big.LITTLE)
+    [[nodiscard]] bool isHybrid() const noexcept { return efficiencyCores > 0; }
 };
 
 struct MonitorInfo
@@ -230,6 +266,13 @@ struct LocaleInfo
 /**
  * @brief Provides system information, such as OS, CPU, memory, storage, locale, and monitors
  * properties and metrics.
+ *
+ * The static information (OS, CPU, locale) is queried on the first call only. The dynamic
+ * metrics are queried by every call, which can take hundreds of milliseconds (WMI on Win32): a
+ * frame polls them through refreshMetricsAsync() and the getters of the last refresh instead,
+ * and getMemoryMetricsFast() reads the counters of the process on top.
+ *
+ * The queries are serialized, they can be made from any thread.
  */
 class SystemInfo
 {
@@ -247,6 +290,9 @@ class SystemInfo
         virtual std::vector<StorageDeviceInfo> getStorageDevices() = 0;
         virtual LocaleInfo getLocaleInfo() = 0;
         virtual std::vector<MonitorInfo> getMonitors() = 0;
+
+        // Fills the process counters of the metrics, cheap and callable during another query.
+        virtual void queryProcessMemory(MemoryMetrics& _metrics) { (void)_metrics; }
     };
 
    private:
@@ -265,6 +311,23 @@ class SystemInfo
     MOSAIC_API [[nodiscard]] static std::vector<StorageDeviceInfo> getStorageDevices();
     MOSAIC_API [[nodiscard]] static LocaleInfo getLocaleInfo();
     MOSAIC_API [[nodiscard]] static std::vector<MonitorInfo> getMonitors();
+
+    /**
+     * @brief Queries the memory, storage and monitor metrics on a background task of the
+     * exec::ThreadPool (on the calling thread without one), for the getters below. Does nothing
+     * while a refresh is in flight.
+     */
+    MOSAIC_API static void refreshMetricsAsync();
+
+    // The system-wide metrics of the last refresh (zero before), the process counters read now.
+    MOSAIC_API [[nodiscard]] static MemoryMetrics getMemoryMetricsFast();
+
+    // Those of the last refresh, empty before.
+    MOSAIC_API [[nodiscard]] static std::vector<StorageDeviceInfo> getLastStorageDevices();
+    MOSAIC_API [[nodiscard]] static std::vector<MonitorInfo> getLastMonitors();
+
+    // The refreshes completed so far, to tell whether the metrics changed.
+    MOSAIC_API [[nodiscard]] static uint64_t getRefreshCount() noexcept;
 };
 
 } // namespace core
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+// The thermal status of the device, in the order of the Android levels (AThermalStatus)
+enum class ThermalStatus
+{
+    unknown,
+    none,
+    light,
+    moderate, // the device throttles its clocks
+    severe,
+    critical, // the platform is about to shut the heaviest work down
+    emergency,
+    shutdown
+};
+
+struct ThermalState
+{
+    ThermalStatus status = ThermalStatus::unknown;
+
+    // The forecast of the next 10 s, 1.0 at severe throttling (AThermal_getThermalHeadroom), NaN
+    // where there is none
+    float headroom = std::numeric_limits<float>::quiet_NaN();
+};
+
+/**
+ * @brief The work durations of a group of threads reported to the platform, which sets the clocks
+ * and cores they run on to meet the target (Android Dynamic Performance Framework hint sessions).
+ * Invalid where the platform takes no hints, its methods doing nothing then.
+ */
+class MOSAIC_API PerformanceHintSession
+{
+   private:
+    void* m_session = nullptr;
+
+   public:
+    PerformanceHintSession() = default;
+    explicit PerformanceHintSession(void* _session) : m_session(_session) {}
+    ~PerformanceHintSession();
+
+    PerformanceHintSession(const PerformanceHintSession&) = delete;
+    PerformanceHintSession& operator=(const PerformanceHintSession&) = delete;
+    PerformanceHintSession(PerformanceHintSession&& _other) noexcept;
+    PerformanceHintSession& operator=(PerformanceHintSession&& _other) noexcept;
+
+   public:
+    [[nodiscard]] bool isValid() const noexcept { return m_session != nullptr; }
+
+    // The time the work of each frame should take, the frame interval usually
+    void updateTargetDuration(std::chrono::nanoseconds _target) noexcept;
+    // The time the work of the last frame took, idle and blocking time left out
+    void reportActualDuration(std::chrono::nanoseconds _actual) noexcept;
+};
+
+/**
+ * @brief The performance controls of the platform: the thermal state of the device and the hint
+ * sessions telling it how long the frame work takes. Android (API 30+ for the thermal state, 33+
+ * for the hints) is the only platform with an implementation; elsewhere the thermal state is
+ * unknown and the sessions invalid.
+ *
+ * The calls can be made from any thread.
+ */
+class SystemPerformance
+{
+   public:
+    class SystemPerformanceImpl
+    {
+       public:
+        SystemPerformanceImpl() = default;
+        virtual ~SystemPerformanceImpl() = default;
+
+       public:
+        virtual ThermalState getThermalState() { return {}; }
+
+        // A platform session, null if the platform takes no hints
+        virtual void* createHintSession(std::span<const int32_t> _threadIds,
+                                        std::chrono::nanoseconds _target)
+        {
+            (void)_threadIds;
+            (void)_target;
+            return nullptr;
+        }
+        virtual void closeHintSession(void* _session) { (void)_session; }
+        virtual void updateTargetDuration(void* _session, std::chrono::nanoseconds _target)
+        {
+            (void)_session;
+            (void)_target;
+        }
+        virtual void reportActualDuration(void* _session, std::chrono::nanoseconds _actual)
+        {
+            (void)_session;
+            (void)_actual;
+        }
+    };
+
+   private:
+    MOSAIC_API static std::unique_ptr<SystemPerformanceImpl> impl;
+
+    friend class PerformanceHintSession;
+
+   public:
+    SystemPerformance(const SystemPerformance&) = delete;
+    SystemPerformance& operator=(const SystemPerformance&) = delete;
+    SystemPerformance(SystemPerformance&&) = delete;
+    SystemPerformance& operator=(SystemPerformance&&) = delete;
+
+   public:
+    MOSAIC_API [[nodiscard]] static ThermalState getThermalState();
+
+    /**
+     * @brief A session for the threads of _threadIds (getCurrentThreadId() of each), invalid if
+     * the platform takes no hints.
+     */
+    MOSAIC_API [[nodiscard]] static PerformanceHintSession createHintSession(
+        std::span<const int32_t> _threadIds, std::chrono::nanoseconds _target);
+
+    // The id the platform knows the calling thread by (gettid()), the threads of a session
+    MOSAIC_API [[nodiscard]] static int32_t getCurrentThreadId() noexcept;
+};
+
+} // namespace core
+} // namespace mosaic
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/core/sys_performance.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+// What the engine runs at under a level of heat
+struct PerformanceLevel
+{
+    float workers = 1.0f;         // of the ThreadPool workers left active, at least one
+    double frameRateLimit = 0.0;  // the frames a second at most, 0 for none
+    float resolutionLimit = 1.0f; // the dynamic resolution scale at most
+};
+
+struct ThermalGovernorSettings
+{
+    // Nominal, warm, hot and critical
+    std::array<PerformanceLevel, 4> levels = {{
+        {1.0f, 0.0, 1.0f},
+        {0.75f, 60.0, 0.85f},
+        {0.5f, 30.0, 0.7f},
+        {0.25f, 30.0, 0.5f},
+    }};
+
+    // The headroom forecast at which each level past the nominal one starts, 1.0 being severe
+    std::array<float, 3> headroomThresholds = {0.75f, 0.9f, 1.0f};
+
+    std::chrono::nanoseconds recoveryDelay = std::chrono::seconds(10); // cooler, per level
+};
+
+/**
+ * @brief Picks the performance level of the engine from the thermal state of the device: the
+ * hotter of the level of the status and of the level of the headroom forecast, so that the load
+ * is shed before the platform throttles the clocks.
+ *
+ * A hotter level is taken at once, a cooler one a level at a time, each after the state has been
+ * below the current level for the recovery delay: the load coming back does not heat the device
+ * up straight into the level it just left.
+ */
+class MOSAIC_API ThermalGovernor final
+{
+   public:
+    using Clock = std::chrono::steady_clock;
+
+   private:
+    ThermalGovernorSettings m_settings;
+
+    uint32_t m_level = 0;
+    Clock::time_point m_coolerSince; // the state was below m_level since then
+    ThermalState m_state;
+
+   public:
+    explicit ThermalGovernor(const ThermalGovernorSettings& _settings = {});
+
+   public:
+    /// The thermal state polled at _now; returns the level the engine runs at from then on.
+    uint32_t update(const ThermalState& _state, Clock::time_point _now) noexcept;
+
+    /// The level the state alone asks for, without the recovery delay.
+    [[nodiscard]] uint32_t getLevelOf(const ThermalState& _state) const noexcept;
+
+    [[nodiscard]] uint32_t getLevel() const noexcept { return m_level; }
+    [[nodiscard]] const PerformanceLevel& getPerformanceLevel() const noexcept
+    {
+        return m_settings.levels[m_level];
+    }
+    [[nodiscard]] const ThermalState& getState() const noexcept { return m_state; }
+    [[nodiscard]] const ThermalGovernorSettings& getSettings() const noexcept
+    {
+        return m_settings;
+    }
+
+    /// Back to the nominal level at once.
+    void reset() noexcept;
+};
+
+} // namespace core
+} // namespace mosaic
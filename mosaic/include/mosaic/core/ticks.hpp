@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "mosaic/defines.hpp"
+
+#if defined(MOSAIC_COMPILER_MSVC) && (defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86))
+#include <intrin.h>
+#endif
+
+// The architectures with a counter readable from user space, used where it is safe
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86) || \
+    (defined(MOSAIC_ARCH_ARM64) && !defined(MOSAIC_COMPILER_MSVC))
+#define MOSAIC_TICKS_COUNTER
+#endif
+
+namespace mosaic
+{
+namespace core
+{
+
+/**
+ * @brief The engine-wide monotonic clock: `int64_t` ticks of the invariant TSC on x86, of
+ * CNTVCT_EL0 on ARM64, or nanoseconds of std::chrono::steady_clock where there is no such
+ * counter (no invariant TSC, the web, MSVC on ARM64). Reading it costs a few cycles and no call,
+ * the timestamps of the hot paths (traces, log records, input events) take it.
+ *
+ * The counter is calibrated once, at the first conversion: its frequency comes from CNTFRQ_EL0
+ * or cpuid leaf 0x15 where they report it, from a 5 ms measurement against the steady clock
+ * otherwise. Convert at output only: toNanoseconds() for spans, toSteady() to correlate with
+ * std::chrono::steady_clock (the timestamps of the traces), toSystem() for wall time (the
+ * timestamps of the logs).
+ */
+class MOSAIC_API Ticks final
+{
+   private:
+    enum class Source : uint8_t
+    {
+        unknown, // until the first read
+        counter,
+        steady,
+    };
+
+    // Constant-initialized, reads during the static initialization find it unknown
+    static std::atomic<Source> s_source;
+
+   public:
+    Ticks() = delete;
+
+    [[nodiscard]] static inline int64_t now() noexcept
+    {
+#if defined(MOSAIC_TICKS_COUNTER)
+        const Source source = s_source.load(std::memory_order_relaxed);
+        if (source == Source::counter) [[likely]] return readCounter();
+        if (source == Source::unknown && detectSource() == Source::counter) return readCounter();
+#endif
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /// Whether the ticks are those of the hardware counter rather than steady nanoseconds.
+    [[nodiscard]] static bool isHardwareCounter() noexcept;
+
+    [[nodiscard]] static double getNanosecondsPerTick() noexcept;
+
+    /// A span of ticks in nanoseconds.
+    [[nodiscard]] static int64_t toNanoseconds(int64_t _ticks) noexcept;
+
+    /// A span of nanoseconds in ticks, for deadlines compared with now().
+    [[nodiscard]] static int64_t fromNanoseconds(int64_t _nanoseconds) noexcept;
+
+    /// The tick in nanoseconds of the epoch of std::chrono::steady_clock.
+    [[nodiscard]] static int64_t toSteadyNanoseconds(int64_t _ticks) noexcept;
+
+    [[nodiscard]] static std::chrono::steady_clock::time_point toSteady(int64_t _ticks) noexcept
+    {
+        return std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::nanoseconds(toSteadyNanoseconds(_ticks))));
+    }
+
+    /// The tick in wall time, for display: follows the system clock as it was at calibration.
+    [[nodiscard]] static std::chrono::system_clock::time_point toSystem(int64_t _ticks) noexcept;
+
+   private:
+    // Checks the counter is there and invariant, once
+    static Source detectSource() noexcept;
+
+#if defined(MOSAIC_TICKS_COUNTER)
+    static inline int64_t readCounter() noexcept
+    {
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86)
+#if defined(MOSAIC_COMPILER_MSVC)
+        return static_cast<int64_t>(__rdtsc());
+#else
+        return static_cast<int64_t>(__builtin_ia32_rdtsc());
+#endif
+#else
+        uint64_t ticks;
+        __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+        return static_cast<int64_t>(ticks);
+#endif
+    }
+#endif
+};
+
+/**
+ * @brief A std::chrono clock over Ticks, for the time points of the APIs: nanoseconds of the
+ * epoch of std::chrono::steady_clock, so comparable with it and with the traces, at the cost of
+ * a Ticks::now() and a conversion.
+ */
+struct TickClock
+{
+    using rep = int64_t;
+    using period = std::nano;
+    using duration = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<TickClock>;
+
+    static constexpr bool is_steady = true;
+
+    [[nodiscard]] static time_point now() noexcept
+    {
+        return time_point(duration(Ticks::toSteadyNanoseconds(Ticks::now())));
+    }
+
+    [[nodiscard]] static time_point fromTicks(int64_t _ticks) noexcept
+    {
+        return time_point(duration(Ticks::toSteadyNanoseconds(_ticks)));
+    }
+};
+
+} // namespace core
+} // namespace mosaic
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <chrono>
-#include <functional>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 #include "mosaic/defines.hpp"
+#include "mosaic/exec/move_only_task.hpp"
 
 namespace mosaic
 {
@@ -12,25 +14,24 @@ namespace core
 {
 
 /**
- * @brief Represents a scheduled callback.
- *
- * The ScheduledCallback struct contains information about a callback including its trigger time,
- * its UUID, and whether it has been cancelled.
+ * @brief Where a scheduled callback runs once due.
  */
-struct ScheduledCallback
+enum class TimerDispatch : uint8_t
 {
-    size_t id;
-    double triggerTime;
-    bool cancelled;
-    std::function<void()> callback;
-
-    ScheduledCallback(size_t _id, double _triggerTime, const std::function<void()>& _callback)
-        : id(_id), triggerTime(_triggerTime), cancelled(false), callback(_callback){};
+    tick,        /// On the thread advancing the timer (Timer::tick() or Timer::advance()).
+    thread_pool, /// Handed to the exec::ThreadPool, on a worker.
+    main_thread, /// Posted to the exec::MainThreadQueue, at its next drain.
 };
 
 /**
  * @brief The `Timer` class provides both a static interface for getting the current time and an
  * object instance interface for scheduling callbacks to be executed after a certain delay.
+ *
+ * Callbacks are kept in a hierarchical timing wheel (4 levels of 256 slots, 1 ms per slot of the
+ * first level): scheduling and cancelling are O(1) whatever the number of timers, and advancing
+ * only visits the slots elapsed since the last advance. No thread is involved, the timers are
+ * advanced by tick() once per frame, or by advance() from any thread (a ThreadPool task say).
+ * A callback never runs before its delay, and at most one advance after it.
  */
 class MOSAIC_API Timer
 {
@@ -43,24 +44,43 @@ class MOSAIC_API Timer
     Timer();
     ~Timer();
 
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
    public:
     /**
-     * @brief Schedule a callback to be executed after a certain delay.
+     * @brief Schedule a callback to be executed after a certain delay, from any thread.
      *
      * @param _delaySeconds The delay before the callback is executed.
      * @param _callback The callback function to be executed.
+     * @param _dispatch Where the callback runs once due.
+     *
+     * @return The id of the callback, to cancel it (never 0).
+     */
+    [[nodiscard]] uint64_t scheduleCallback(std::chrono::duration<double> _delaySeconds,
+                                            exec::MoveOnlyTask<void()> _callback,
+                                            TimerDispatch _dispatch = TimerDispatch::tick);
+
+    /**
+     * @brief Cancel a scheduled callback. Ids of callbacks already run or cancelled are ignored.
      *
-     * @return A ScheduledCallback object representing the scheduled callback.
+     * @param _id The id of the callback to cancel.
+     *
+     * @return true if the callback was still pending.
      */
-    [[nodiscard]] size_t scheduleCallback(std::chrono::duration<double> _delaySeconds,
-                                          std::function<void()> _callback);
+    bool cancelCallback(const uint64_t _id);
 
     /**
-     * @brief Cancel a scheduled callback.
+     * @brief Runs (or dispatches) the callbacks of this timer that are due, from any thread.
      *
-     * @param _uuid The UUID of the callback to cancel.
+     * @return The number of callbacks that were due.
      */
-    void cancelCallback(const size_t _id);
+    size_t advance();
+
+    /**
+     * @brief Get the number of callbacks scheduled and not run or cancelled yet.
+     */
+    [[nodiscard]] size_t getPendingCount() const;
 
     /**
      * @brief Get the current time in seconds since the epoch.
@@ -77,22 +97,35 @@ class MOSAIC_API Timer
     static std::string getCurrentDate();
 
     /**
-     * @brief Get the current time in seconds since the epoch.
+     * @brief Get the time between the last two ticks, raw: see FixedTimestep for fixed steps and
+     * a smoothed delta.
      *
-     * @return The current time in seconds since the epoch.
+     * @return The time between the last two ticks in seconds, 0 before the first.
      */
     static double getDeltaTime();
 
     /**
-     * @brief Sleep for a specified duration. Wraps std::this_thread::sleep_for.
+     * @brief Sleep for a specified duration, precisely: see sleepUntil().
      *
      * @param _seconds The duration to sleep for.
      */
     static void sleepFor(std::chrono::duration<double> _seconds);
 
+    /**
+     * @brief Sleep until a point of the steady clock, waking within a few microseconds of it.
+     *
+     * The thread blocks in the OS until 0.5 ms before (a high resolution waitable timer on
+     * Windows, clock_nanosleep() on Linux and Android) and spins the rest, where
+     * std::this_thread::sleep_until() may wake a scheduler tick late (up to 15.6 ms on Windows).
+     * On the web the rest is slept too, the page must not spin.
+     *
+     * @param _deadline The point to wake at, returns at once if it has passed.
+     */
+    static void sleepUntil(std::chrono::steady_clock::time_point _deadline);
+
     /**
      * @brief Tick the timer. This function updates the last time to the current time
-     * so that the delta time can be calculated correctly.
+     * so that the delta time can be calculated correctly, and advances every timer.
      */
     static void tick();
 };
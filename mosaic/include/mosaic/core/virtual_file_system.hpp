@@ -0,0 +1,110 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+
+#include "asset_archive.hpp"
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+struct AAssetManager;
+#endif
+
+namespace mosaic
+{
+namespace core
+{
+
+/**
+ * @brief The files of the application, read through mount points: a directory (the Emscripten
+ * preloaded files are one), an AssetArchive, or the APK assets on Android. A path is looked up
+ * in the mounts whose point prefixes it, the last mounted first, so that a mount overrides those
+ * before it (a patch archive over the base one, a directory over the archives when iterating).
+ *
+ * Reads are zero-copy where the source allows it: the mapping of a file, an archive entry stored
+ * as is, the buffer of an uncompressed asset.
+ *
+ * Reads may run concurrently, with each other and with the mounts.
+ *
+ * @example
+ *   VirtualFileSystem files;
+ *   files.mountArchive("", "assets.mpak");
+ *   files.mountDirectory("shaders", "build/shaders"); // "shaders/a.spv" is build/shaders/a.spv
+ *
+ *   auto spirv = files.read("shaders/a.spv");
+ */
+class MOSAIC_API VirtualFileSystem final
+{
+   private:
+    struct Mount
+    {
+        std::string point; // normalized, without the trailing '/', empty for the root
+        std::filesystem::path directory;
+        std::shared_ptr<const AssetArchive> archive;
+#if defined(MOSAIC_PLATFORM_ANDROID)
+        AAssetManager* assets = nullptr;
+#endif
+    };
+
+    static VirtualFileSystem* g_instance;
+
+    std::vector<Mount> m_mounts; // in mount order
+    mutable std::shared_mutex m_mutex;
+
+   public:
+    VirtualFileSystem();
+    ~VirtualFileSystem();
+
+    VirtualFileSystem(const VirtualFileSystem&) = delete;
+    VirtualFileSystem& operator=(const VirtualFileSystem&) = delete;
+
+   public:
+    void mountDirectory(std::string_view _point, const std::filesystem::path& _directory);
+
+    /**
+     * @brief Maps the archive and mounts it.
+     *
+     * @throws std::runtime_error if it cannot be mapped or is not an archive.
+     */
+    void mountArchive(std::string_view _point, const std::filesystem::path& _archive);
+    void mountArchive(std::string_view _point, std::shared_ptr<const AssetArchive> _archive);
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+    void mountAssets(std::string_view _point, AAssetManager* _assets);
+#endif
+
+    // Removes every mount of the point.
+    void unmount(std::string_view _point);
+
+    /**
+     * @brief The bytes of the file, from the last mount holding it.
+     *
+     * @return The error of the last mount that had it but failed to read it, or that none has it.
+     */
+    [[nodiscard]] pieces::Result<FileData, std::string> read(std::string_view _path) const;
+
+    [[nodiscard]] bool exists(std::string_view _path) const;
+
+    /**
+     * @brief The file on disk behind the path, for the reads that bypass the mapping (IoService).
+     *
+     * @return None if no mount has it, or if the last one holding it is not a directory.
+     */
+    [[nodiscard]] std::optional<std::filesystem::path> locate(std::string_view _path) const;
+
+    [[nodiscard]] size_t getMountCount() const;
+
+    // The first one created, by the Application.
+    [[nodiscard]] static VirtualFileSystem* getInstance() noexcept { return g_instance; }
+};
+
+} // namespace core
+} // namespace mosaic
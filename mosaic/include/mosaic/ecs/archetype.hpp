@@ -1,32 +1,200 @@
 #pragma once
 
 #include <bitset>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <optional>
+#include <algorithm>
 #include <unordered_map>
 
+#include <pieces/containers/small_vector.hpp>
+
 #include "component.hpp"
 #include "typeless_sparse_set.hpp"
+#include "typeless_chunked_storage.hpp"
 
 namespace mosaic
 {
 namespace ecs
 {
 
+/**
+ * @brief Describes how an archetype lays out the data of its entities in memory.
+ */
+enum class ArchetypeStorageMode : uint8_t
+{
+    interleaved, /// One row per entity: [EntityMeta | Component1 | ... | ComponentN] (AoS).
+    chunked,     /// Fixed-size chunks with one contiguous column per component (SoA).
+    adaptive,    /// Interleaved rows until the archetype outgrows a size threshold, then chunked.
+};
+
+class Archetype;
+
+/**
+ * @brief Change-detection ticks of one component column over one tick block of rows.
+ *
+ * A tick block is a chunk in chunked mode and Archetype::k_tickBlockRows rows in interleaved
+ * mode. Tick 0 means "never".
+ */
+struct ColumnTicks
+{
+    uint32_t added = 0;   /// Last tick an entity of the block gained the component.
+    uint32_t changed = 0; /// Last tick the component of an entity of the block was written.
+};
+
+// Returns whether the tick is strictly more recent than the reference one (wrap-around safe).
+[[nodiscard]] inline constexpr bool isNewerTick(uint32_t _tick, uint32_t _since) noexcept
+{
+    return static_cast<int32_t>(_tick - _since) > 0;
+}
+
+/**
+ * @brief A byte range copied verbatim between the rows of two interleaved archetypes.
+ */
+struct ArchetypeCopyRange
+{
+    size_t srcOffset;
+    size_t dstOffset;
+    size_t size;
+};
+
+/**
+ * @brief A column of raw component data handed out by untyped iteration (see
+ * EntityRegistry::forEachRawChunk()), element i lives at data + i * stride.
+ *
+ * Tags and shared components have a stride of 0 (and tags a null data pointer).
+ */
+struct RawColumn
+{
+    uint8_t* data;
+    size_t stride;
+
+    [[nodiscard]] uint8_t* operator[](size_t _index) const noexcept
+    {
+        return data + _index * stride;
+    }
+};
+
+/**
+ * @brief Runs a body over [0, count) as consecutive [first, last) ranges, here as a single range
+ * on the calling thread. Parallel bulk operations of the registry substitute a runner that
+ * dispatches the ranges to a pool: the body then runs concurrently on disjoint rows.
+ */
+struct InlineRowRanges
+{
+    template <typename Body>
+    void operator()(size_t _count, Body&& _body) const
+    {
+        _body(size_t{0}, _count);
+    }
+};
+
+/**
+ * @brief A cached structural transition from one archetype to another.
+ *
+ * Edges are built once per (source, target) pair and hold everything needed to move an entity
+ * without touching signatures or offset maps. Shared components that are adjacent in both rows are
+ * merged into a single copy range (the EntityMeta included), while the per-component list is used
+ * whenever one of the two archetypes is chunked.
+ */
+struct ArchetypeEdge
+{
+    Archetype* target = nullptr;
+    std::vector<ArchetypeCopyRange> copyRanges;
+    std::vector<std::pair<ComponentID, size_t>> sharedComponents;
+    std::vector<size_t> addedTickSlots; // tick columns of the target the source does not have
+};
+
+/**
+ * @brief The value of a shared component referenced by every entity of an archetype.
+ *
+ * Values are interned by the registry (see SharedValueTable), the index identifies the value
+ * and the address points at the interned copy.
+ */
+struct SharedComponentValue
+{
+    ComponentID id;
+    uint32_t index;
+    uint8_t* value;
+
+    bool operator==(const SharedComponentValue&) const = default;
+};
+
+/**
+ * @brief Identifies an archetype within a registry: its signature and the values of its shared
+ * components (ordered by ascending ComponentID).
+ */
+struct ArchetypeKey
+{
+    ComponentSignature signature;
+    std::vector<SharedComponentValue> sharedValues;
+
+    bool operator==(const ArchetypeKey&) const = default;
+};
+
 /**
  * @brief The 'Archetype' class represents a collection of entities that share the same set of
  * components in an ECS architecture.
  *
- * Archetypes wrap the underlying storage mechanism (TypelessSparseSet). The main reason for this
- * wrapper is to associate a component signature with the storage and to keep track of component
- * offsets within the entity data therefore speeding up access all entity registry operations.
+ * Archetypes wrap the underlying storage mechanism (TypelessSparseSet or TypelessChunkedStorage).
+ * The main reason for this wrapper is to associate a component signature with the storage and to
+ * keep track of component offsets within the entity data therefore speeding up access all entity
+ * registry operations.
+ *
+ * In interleaved mode every entity is stored as one row. In chunked mode the archetype keeps
+ * fixed-size chunks with one column per component, which is preferable for wide archetypes whose
+ * systems only touch a few components. Both modes accept rows laid out according to
+ * componentOffsets() on insertion, per-component access goes through getComponent()/componentAt().
+ *
+ * Tags and shared components are part of the signature but not of the rows: every entity of the
+ * archetype uses the shared values listed in sharedValues().
  */
 class Archetype final
 {
+   public:
+    // Number of rows sharing the same change-detection ticks in interleaved mode.
+    static constexpr size_t k_tickBlockRows = 64;
+
+    // Size of the interleaved rows past which an adaptive archetype moves to chunked storage.
+    static constexpr size_t k_defaultSplitThresholdInBytes = 4 * BYTES_PER_MIB;
+
    private:
     using Byte = uint8_t;
+    using ChunkedStorage = TypelessChunkedStorage<64>;
 
+    // Column 0 of the chunked storage always holds the EntityMeta of each row
+    static constexpr size_t k_metaColumn = 0;
+
+    // A component of both sides of a migration: id, source offset, destination offset, size
+    using SharedComponent = std::tuple<ComponentID, size_t, size_t, size_t>;
+    static constexpr size_t k_inlineSharedComponents = 16;
+
+    ArchetypeStorageMode m_storageMode; // interleaved or chunked (adaptive archetypes switch)
+    size_t m_splitRows = 0;             // rows past which interleaved storage splits (0 = never)
     ComponentSignature m_signature;
     TypelessSparseSet<64, false> m_storage;
-    std::unordered_map<ComponentID, size_t> m_componentOffsets;
+    std::optional<ChunkedStorage> m_chunkedStorage;
+    ComponentOffsets m_componentOffsets;
+    ComponentOffsets m_componentColumns;
+
+    // ComponentID-indexed copy of the offsets (interleaved) or columns (chunked) for hot lookups
+    std::vector<uint32_t> m_componentSlots;
+    uint32_t m_index = 0;
+    std::vector<SharedComponentValue> m_sharedValues;
+
+    // Change detection: [block * m_tickColumnCount + column] ticks, columns indexed by m_tickSlots
+    std::vector<ColumnTicks> m_ticks;
+    std::vector<uint32_t> m_tickSlots;
+    size_t m_tickColumnCount = 0;
+    uint32_t m_currentTick = 0;
+
+    // Transition graph: edges are owned by m_edges (keyed by target), node addresses are stable
+    std::unordered_map<const Archetype*, ArchetypeEdge> m_edges;
+    pieces::FlatHashMap<ComponentID, ArchetypeEdge*> m_addEdges;
+    pieces::FlatHashMap<ComponentID, ArchetypeEdge*> m_removeEdges;
 
    public:
     /**
@@ -38,26 +206,137 @@ class Archetype final
      * @param _stride The size in bytes of each entity's data (including metadata and components).
      * @param _componentOffsets A mapping from component IDs to their byte offsets within the
      * entity data.
+     * @param _storageAllocator Where the rows are allocated, or nullptr for the global heap (it
+     * must outlive the archetype).
      */
     Archetype(ComponentSignature _signature, size_t _stride,
-              std::unordered_map<ComponentID, size_t> _componentOffsets)
-        : m_signature(_signature), m_storage(_stride), m_componentOffsets(_componentOffsets) {};
+              ComponentOffsets _componentOffsets, StorageAllocator* _storageAllocator = nullptr)
+        : m_storageMode(ArchetypeStorageMode::interleaved),
+          m_signature(_signature),
+          m_storage(_stride, 1, _storageAllocator),
+          m_componentOffsets(std::move(_componentOffsets))
+    {
+        buildSlotTable();
+    };
+
+    /**
+     * @brief Constructs an Archetype using the given storage mode.
+     *
+     * @param _signature The component signature representing the set of components in this
+     * archetype.
+     * @param _stride The size in bytes of each entity's row (including metadata and components).
+     * @param _componentOffsets A mapping from component IDs to their byte offsets within a row.
+     * @param _storageMode The storage mode used by the archetype.
+     * @param _componentLayouts The size and alignment of every component (only used in chunked
+     * mode), ordered by ascending ComponentID.
+     * @param _chunkSizeInBytes The target size of a chunk (only used in chunked and adaptive
+     * modes).
+     * @param _splitThresholdInBytes The size of the interleaved rows past which an adaptive
+     * archetype moves them to chunks (only used in adaptive mode).
+     * @param _chunkArena The arena chunks are allocated from, or nullptr for the global heap (only
+     * used in chunked and adaptive modes, it must outlive the archetype).
+     * @param _storageAllocator Where the interleaved rows are allocated, or nullptr for the global
+     * heap (it must outlive the archetype).
+     *
+     * @note An adaptive archetype starts interleaved, so small archetypes keep their single
+     * allocation, and switches to chunked storage for good the first time an insertion would take
+     * it past the threshold. Growing further then allocates chunks instead of reallocating (and
+     * copying) the whole row array.
+     */
+    Archetype(ComponentSignature _signature, size_t _stride,
+              ComponentOffsets _componentOffsets,
+              ArchetypeStorageMode _storageMode,
+              const std::vector<std::pair<ComponentID, ChunkedStorage::ColumnLayout>>&
+                  _componentLayouts,
+              size_t _chunkSizeInBytes = ChunkedStorage::k_defaultChunkSizeInBytes,
+              size_t _splitThresholdInBytes = k_defaultSplitThresholdInBytes,
+              ChunkArena* _chunkArena = nullptr, StorageAllocator* _storageAllocator = nullptr)
+        : m_storageMode(_storageMode),
+          m_signature(_signature),
+          m_storage(_stride, 1, _storageAllocator),
+          m_componentOffsets(std::move(_componentOffsets))
+    {
+        if (m_storageMode == ArchetypeStorageMode::interleaved)
+        {
+            buildSlotTable();
+            return;
+        }
+
+        if (m_storageMode == ArchetypeStorageMode::adaptive)
+        {
+            m_storageMode = ArchetypeStorageMode::interleaved;
+            m_splitRows = std::max<size_t>(_splitThresholdInBytes / _stride, 1);
+        }
+
+        std::vector<ChunkedStorage::ColumnLayout> columns;
+        columns.reserve(_componentLayouts.size() + 1);
+        columns.push_back({sizeof(EntityMeta), alignof(EntityMeta)});
+
+        for (const auto& [compID, layout] : _componentLayouts)
+        {
+            m_componentColumns[compID] = columns.size();
+            columns.push_back(layout);
+        }
+
+        m_chunkedStorage.emplace(std::move(columns), _chunkSizeInBytes, _chunkArena);
+
+        buildSlotTable();
+    }
 
    public:
     /**
      * @brief Inserts a new entity with the given ID and associated data into the archetype.
      *
      * @param _eid The ID of the entity to be inserted.
-     * @param _data A pointer to the raw data representing the entity's metadata and components.
+     * @param _data A pointer to the raw data representing the entity's metadata and components,
+     * laid out according to componentOffsets().
      */
-    void insert(EntityID _eid, const Byte* _data) { m_storage.insert(_eid, _data); }
+    void insert(EntityID _eid, const Byte* _data)
+    {
+        splitIfOutgrown(size() + 1);
+
+        if (!isChunked())
+        {
+            const bool isNew = !m_storage.contains(_eid);
+            m_storage.insert(_eid, _data);
+            markRowsWritten(rowOf(_eid), 1, isNew);
+            return;
+        }
+
+        size_t row = m_chunkedStorage->indexOf(_eid);
+        const bool isNew = row == m_chunkedStorage->size();
+        if (isNew) row = m_chunkedStorage->emplaceUninitialized(_eid);
+
+        scatterRow(row, _data);
+        markRowsWritten(row, 1, isNew);
+    }
 
     /**
      * @brief Removes the entity with the specified ID from the archetype.
      *
      * @param _eid The ID of the entity to be removed.
      */
-    void remove(EntityID _eid) { m_storage.remove(_eid); }
+    void remove(EntityID _eid)
+    {
+        size_t row = 0;
+
+        if (isChunked())
+        {
+            row = m_chunkedStorage->indexOf(_eid);
+            if (!m_chunkedStorage->remove(_eid)) return;
+        }
+        else
+        {
+            const Byte* rowPtr = m_storage.get(_eid);
+            if (!rowPtr) return;
+
+            row = static_cast<size_t>(rowPtr - m_storage.data().data()) / stride();
+            m_storage.remove(_eid);
+        }
+
+        // swap-and-pop moved the last entity into the freed row
+        if (row < size()) markRowsWritten(row, 1, false);
+    }
 
     /**
      * @brief Inserts multiple entities with contiguous raw data into the archetype.
@@ -68,7 +347,19 @@ class Archetype final
      */
     void insertBulk(const EntityID* _eids, const Byte* _data, size_t _count)
     {
-        m_storage.insertBulk(_eids, _data, _count);
+        splitIfOutgrown(size() + _count);
+
+        if (!isChunked())
+        {
+            const size_t first = m_storage.size();
+            m_storage.insertBulk(_eids, _data, _count);
+            markRowsWritten(first, m_storage.size() - first, true);
+            return;
+        }
+
+        m_chunkedStorage->reserve(m_chunkedStorage->size() + _count);
+
+        for (size_t i = 0; i < _count; ++i) insert(_eids[i], _data + i * stride());
     }
 
     /**
@@ -77,10 +368,54 @@ class Archetype final
      * @param _eids Array of entity IDs to insert.
      * @param _count Number of entities to insert.
      * @return Pointer to the first entity's data slot for caller to initialize.
+     *
+     * @note Only available in interleaved mode (rows are not contiguous in chunked mode), use
+     * emplaceBulkUninitialized() for a mode-agnostic alternative. Adaptive archetypes are not
+     * split by this call.
      */
     Byte* insertBulkUninitialized(const EntityID* _eids, size_t _count)
     {
-        return m_storage.insertBulkUninitialized(_eids, _count);
+        if (isChunked())
+        {
+            throw std::logic_error("insertBulkUninitialized is not supported in chunked mode");
+        }
+
+        const size_t first = m_storage.size();
+        Byte* data = m_storage.insertBulkUninitialized(_eids, _count);
+        markRowsWritten(first, _count, true);
+
+        return data;
+    }
+
+    /**
+     * @brief Inserts multiple entities with uninitialized data regardless of the storage mode.
+     *
+     * @param _eids Array of entity IDs to insert (all must be NEW).
+     * @param _count Number of entities to insert.
+     * @return The dense row index of the first inserted entity, rows are then initialized through
+     * metaAt() and componentAt().
+     */
+    size_t emplaceBulkUninitialized(const EntityID* _eids, size_t _count)
+    {
+        const size_t first = emplaceRowsUntracked(_eids, _count);
+        markRowsWritten(first, _count, true);
+
+        return first;
+    }
+
+    /**
+     * @brief Inserts a single entity with uninitialized data regardless of the storage mode.
+     *
+     * @param _eid The ID of the entity to insert (must be NEW).
+     * @return The dense row index of the entity, the row is then initialized through metaAt() and
+     * componentAt().
+     */
+    size_t emplaceUninitialized(EntityID _eid)
+    {
+        const size_t row = emplaceRowUntracked(_eid);
+        markRowsWritten(row, 1, true);
+
+        return row;
     }
 
     /**
@@ -92,7 +427,15 @@ class Archetype final
      */
     std::vector<EntityID> removeBulk(const EntityID* _eids, size_t _count)
     {
-        return m_storage.removeBulk(_eids, _count);
+        std::vector<EntityID> notFound;
+
+        for (size_t i = 0; i < _count; ++i)
+        {
+            if (!contains(_eids[i])) notFound.push_back(_eids[i]);
+            else remove(_eids[i]);
+        }
+
+        return notFound;
     }
 
     /**
@@ -103,17 +446,20 @@ class Archetype final
      *
      * @param _dest Destination archetype (must have compatible component layout).
      * @param _registry Component registry for size/alignment info.
+     * @param _rowRanges The runner the row copies are split with (see InlineRowRanges). Any other
+     * than InlineRowRanges reserves the destination rows once and copies ranges of them
+     * concurrently.
      * @return Vector of all entity IDs that were migrated.
      */
-    template <typename ComponentRegistryT>
-    std::vector<EntityID> migrateAllTo(Archetype& _dest, const ComponentRegistryT* _registry)
+    template <typename ComponentRegistryT, typename RowRanges = InlineRowRanges>
+    std::vector<EntityID> migrateAllTo(Archetype& _dest, const ComponentRegistryT* _registry,
+                                       RowRanges&& _rowRanges = {})
     {
         const auto& srcOffsets = m_componentOffsets;
         const auto& destOffsets = _dest.m_componentOffsets;
-        const size_t destStride = _dest.stride();
 
         // Compute shared components (present in both archetypes)
-        std::vector<std::tuple<ComponentID, size_t, size_t, size_t>> sharedComponents;
+        pieces::SmallVector<SharedComponent, k_inlineSharedComponents> sharedComponents;
         for (const auto& [compID, srcOffset] : srcOffsets)
         {
             auto it = destOffsets.find(compID);
@@ -124,8 +470,19 @@ class Archetype final
             }
         }
 
+        _dest.splitIfOutgrown(_dest.size() + size());
+
+        if (isChunked() || _dest.isChunked() ||
+            !std::is_same_v<std::decay_t<RowRanges>, InlineRowRanges>)
+        {
+            return migrateAllToMixed(_dest, sharedComponents, _rowRanges);
+        }
+
+        const size_t first = _dest.size();
+        const size_t count = size();
+
         // Use moveAllTo with transform function
-        return m_storage.moveAllTo(
+        std::vector<EntityID> migrated = m_storage.moveAllTo(
             _dest.m_storage,
             [&](EntityID eid, Byte* srcRow, Byte* destRow)
             {
@@ -138,6 +495,10 @@ class Archetype final
                     std::memcpy(destRow + destOff, srcRow + srcOff, size);
                 }
             });
+
+        _dest.markRowsMovedIn(first, count, m_signature);
+
+        return migrated;
     }
 
     /**
@@ -146,8 +507,338 @@ class Archetype final
      * @param _eid The ID of the entity whose data is to be retrieved.
      * @return A pointer to the raw data of the entity, or nullptr if the entity does not exist in
      * the archetype.
+     *
+     * @note Only meaningful in interleaved mode (returns nullptr in chunked mode), use
+     * getComponent() and getMeta() for a mode-agnostic alternative.
+     */
+    Byte* get(EntityID _eid) { return isChunked() ? nullptr : m_storage.get(_eid); }
+
+    /**
+     * @brief Retrieves a pointer to a single component of the entity with the given ID.
+     *
+     * @param _eid The ID of the entity.
+     * @param _compID The ID of the component (must be part of the archetype signature).
+     * @return A pointer to the component data, or nullptr if the entity does not exist in the
+     * archetype.
+     */
+    Byte* getComponent(EntityID _eid, ComponentID _compID)
+    {
+        if (isChunked())
+        {
+            const size_t row = m_chunkedStorage->indexOf(_eid);
+            if (row == m_chunkedStorage->size()) return nullptr;
+            return m_chunkedStorage->at(row, m_componentSlots[_compID]);
+        }
+
+        Byte* rowPtr = m_storage.get(_eid);
+        return rowPtr ? rowPtr + m_componentSlots[_compID] : nullptr;
+    }
+
+    /**
+     * @brief Retrieves the metadata of the entity with the given ID.
+     *
+     * @param _eid The ID of the entity.
+     * @return A pointer to the entity metadata, or nullptr if the entity does not exist in the
+     * archetype.
+     */
+    EntityMeta* getMeta(EntityID _eid)
+    {
+        if (isChunked())
+        {
+            const size_t row = m_chunkedStorage->indexOf(_eid);
+            if (row == m_chunkedStorage->size()) return nullptr;
+            return reinterpret_cast<EntityMeta*>(m_chunkedStorage->at(row, k_metaColumn));
+        }
+
+        return reinterpret_cast<EntityMeta*>(m_storage.get(_eid));
+    }
+
+    /**
+     * @brief Retrieves a pointer to a single component of the entity stored at the given dense
+     * row index.
+     *
+     * @param _row The dense row index (must be < size()).
+     * @param _compID The ID of the component (must be part of the archetype signature).
+     */
+    Byte* componentAt(size_t _row, ComponentID _compID)
+    {
+        if (isChunked()) return m_chunkedStorage->at(_row, m_componentSlots[_compID]);
+
+        return m_storage.data()[_row] + m_componentSlots[_compID];
+    }
+
+    // Returns the byte offset of the component within a row (interleaved mode only).
+    [[nodiscard]] inline size_t componentOffset(ComponentID _compID) const noexcept
+    {
+        return m_componentSlots[_compID];
+    }
+
+    /**
+     * @brief Retrieves the metadata of the entity stored at the given dense row index.
+     *
+     * @param _row The dense row index (must be < size()).
+     */
+    EntityMeta* metaAt(size_t _row)
+    {
+        if (isChunked())
+        {
+            return reinterpret_cast<EntityMeta*>(m_chunkedStorage->at(_row, k_metaColumn));
+        }
+
+        return reinterpret_cast<EntityMeta*>(m_storage.data()[_row]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Transition Graph
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Returns the cached edge reached by adding the given component (nullptr if not linked yet).
+    [[nodiscard]] ArchetypeEdge* findAddEdge(ComponentID _compID) noexcept
+    {
+        auto it = m_addEdges.find(_compID);
+        return it != m_addEdges.end() ? it->second : nullptr;
+    }
+
+    // Returns the cached edge reached by removing the given component (nullptr if not linked yet).
+    [[nodiscard]] ArchetypeEdge* findRemoveEdge(ComponentID _compID) noexcept
+    {
+        auto it = m_removeEdges.find(_compID);
+        return it != m_removeEdges.end() ? it->second : nullptr;
+    }
+
+    /**
+     * @brief Retrieves the edge leading from this archetype to the given one, building it on first
+     * use.
+     *
+     * @param _target The destination archetype (may be this archetype, which yields a no-op edge).
+     * @param _registry Component registry for size info.
+     * @return The cached edge, valid for as long as both archetypes live.
+     */
+    template <typename ComponentRegistryT>
+    ArchetypeEdge& edgeTo(Archetype* _target, const ComponentRegistryT* _registry)
+    {
+        auto it = m_edges.find(_target);
+        if (it != m_edges.end()) return it->second;
+
+        ArchetypeEdge& edge = m_edges[_target];
+        edge.target = _target;
+
+        if (_target == this) return edge;
+
+        const ComponentSignature& targetSig = _target->m_signature;
+        for (size_t compID = targetSig.findFirstSet(); compID < _target->m_tickSlots.size();
+             compID = targetSig.findFirstSetFrom(compID + 1))
+        {
+            if (!m_signature.testBit(compID))
+            {
+                edge.addedTickSlots.push_back(_target->m_tickSlots[compID]);
+            }
+        }
+
+        std::vector<ArchetypeCopyRange> ranges;
+        ranges.push_back({0, 0, sizeof(EntityMeta)});
+
+        for (const auto& [compID, srcOffset] : m_componentOffsets)
+        {
+            auto destIt = _target->m_componentOffsets.find(compID);
+            if (destIt == _target->m_componentOffsets.end()) continue;
+
+            const size_t compSize = _registry->info(compID).size;
+            edge.sharedComponents.emplace_back(compID, compSize);
+            ranges.push_back({srcOffset, destIt->second, compSize});
+        }
+
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const auto& _a, const auto& _b) { return _a.srcOffset < _b.srcOffset; });
+
+        // Merge ranges that are contiguous in both rows
+        for (const auto& range : ranges)
+        {
+            if (!edge.copyRanges.empty())
+            {
+                auto& last = edge.copyRanges.back();
+
+                if (last.srcOffset + last.size == range.srcOffset &&
+                    last.dstOffset + last.size == range.dstOffset)
+                {
+                    last.size += range.size;
+                    continue;
+                }
+            }
+
+            edge.copyRanges.push_back(range);
+        }
+
+        return edge;
+    }
+
+    // Links the edge to the given target as the result of adding the given component.
+    template <typename ComponentRegistryT>
+    ArchetypeEdge& linkAddEdge(ComponentID _compID, Archetype* _target,
+                               const ComponentRegistryT* _registry)
+    {
+        ArchetypeEdge& edge = edgeTo(_target, _registry);
+        m_addEdges[_compID] = &edge;
+        return edge;
+    }
+
+    // Links the edge to the given target as the result of removing the given component.
+    template <typename ComponentRegistryT>
+    ArchetypeEdge& linkRemoveEdge(ComponentID _compID, Archetype* _target,
+                                  const ComponentRegistryT* _registry)
+    {
+        ArchetypeEdge& edge = edgeTo(_target, _registry);
+        m_removeEdges[_compID] = &edge;
+        return edge;
+    }
+
+    // Forgets every edge leading to the given archetype (called before it is destroyed).
+    void unlinkEdgesTo(const Archetype* _target)
+    {
+        auto it = m_edges.find(_target);
+        if (it == m_edges.end()) return;
+
+        const ArchetypeEdge* edge = &it->second;
+        m_addEdges.erase_if([&](const auto& _entry) { return _entry.second == edge; });
+        m_removeEdges.erase_if([&](const auto& _entry) { return _entry.second == edge; });
+
+        m_edges.erase(it);
+    }
+
+    /**
+     * @brief Moves an entity along the given edge, copying its metadata and shared components.
+     *
+     * @param _eid The ID of the entity (must be stored in this archetype).
+     * @param _edge An edge obtained from this archetype leading to a different archetype.
+     * @return The dense row of the entity in the target archetype, components that only exist in
+     * the target are left uninitialized and must be constructed through componentAt().
+     */
+    size_t moveAlong(EntityID _eid, const ArchetypeEdge& _edge)
+    {
+        Archetype& target = *_edge.target;
+        const size_t row = target.emplaceRowUntracked(_eid);
+        target.markRowMovedAlong(row, _edge);
+
+        if (!isChunked() && !target.isChunked())
+        {
+            const Byte* srcRow = m_storage.get(_eid);
+            Byte* destRow = target.m_storage.data()[row];
+
+            for (const auto& range : _edge.copyRanges)
+            {
+                std::memcpy(destRow + range.dstOffset, srcRow + range.srcOffset, range.size);
+            }
+        }
+        else
+        {
+            std::memcpy(target.metaAt(row), getMeta(_eid), sizeof(EntityMeta));
+
+            for (const auto& [compID, size] : _edge.sharedComponents)
+            {
+                std::memcpy(target.componentAt(row, compID), getComponent(_eid, compID), size);
+            }
+        }
+
+        remove(_eid);
+        return row;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Chunk API (chunked mode only)
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Returns the number of chunks holding at least one entity (0 in interleaved mode).
+    [[nodiscard]] inline size_t chunkCount() const noexcept
+    {
+        return isChunked() ? m_chunkedStorage->chunkCount() : 0;
+    }
+
+    // Returns the number of entities stored in the given chunk.
+    [[nodiscard]] inline size_t chunkSize(size_t _chunkIdx) const noexcept
+    {
+        return m_chunkedStorage->chunkSize(_chunkIdx);
+    }
+
+    // Returns the maximum number of entities a chunk can hold (0 in interleaved mode).
+    [[nodiscard]] inline size_t chunkCapacity() const noexcept
+    {
+        return isChunked() ? m_chunkedStorage->chunkCapacity() : 0;
+    }
+
+    // Returns the contiguous column of the given component inside the given chunk.
+    [[nodiscard]] inline Byte* chunkColumn(size_t _chunkIdx, ComponentID _compID)
+    {
+        return m_chunkedStorage->columnData(_chunkIdx, m_componentSlots[_compID]);
+    }
+
+    // Returns the contiguous column of entity metadata inside the given chunk.
+    [[nodiscard]] inline EntityMeta* chunkMetas(size_t _chunkIdx)
+    {
+        Byte* column = m_chunkedStorage->columnData(_chunkIdx, k_metaColumn);
+        return reinterpret_cast<EntityMeta*>(column);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Change Detection
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // Returns the tick stamped on every write made to the archetype.
+    [[nodiscard]] inline uint32_t currentTick() const noexcept { return m_currentTick; }
+
+    // Sets the tick stamped on every write made to the archetype (driven by the registry).
+    inline void setCurrentTick(uint32_t _tick) noexcept { m_currentTick = _tick; }
+
+    // Returns the number of rows sharing the same ticks (the chunk capacity in chunked mode).
+    [[nodiscard]] inline size_t tickBlockRows() const noexcept
+    {
+        return isChunked() ? chunkCapacity() : k_tickBlockRows;
+    }
+
+    // Returns the number of tick blocks covering the stored rows.
+    [[nodiscard]] inline size_t tickBlockCount() const noexcept
+    {
+        return (size() + tickBlockRows() - 1) / tickBlockRows();
+    }
+
+    // Returns the ticks of the given component over the given block (zeros if never written).
+    [[nodiscard]] ColumnTicks columnTicks(size_t _block, ComponentID _compID) const noexcept
+    {
+        const size_t idx = _block * m_tickColumnCount + m_tickSlots[_compID];
+        return idx < m_ticks.size() ? m_ticks[idx] : ColumnTicks{};
+    }
+
+    /**
+     * @brief Stamps the given component as changed at the current tick over a range of blocks.
+     *
+     * @param _compID The ID of the component (must be part of the archetype signature).
+     * @param _firstBlock The first tick block of the range.
+     * @param _lastBlock One past the last tick block of the range.
      */
-    Byte* get(EntityID _eid) { return m_storage.get(_eid); }
+    void markChanged(ComponentID _compID, size_t _firstBlock, size_t _lastBlock)
+    {
+        if (_firstBlock >= _lastBlock) return;
+
+        ensureTickBlocks(_lastBlock);
+
+        for (size_t block = _firstBlock; block < _lastBlock; ++block)
+        {
+            m_ticks[block * m_tickColumnCount + m_tickSlots[_compID]].changed = m_currentTick;
+        }
+    }
+
+    // Stamps the given component of the entity stored at the given row as changed.
+    void markChangedAt(size_t _row, ComponentID _compID)
+    {
+        const size_t block = tickBlockOf(_row);
+        const size_t idx = block * m_tickColumnCount + m_tickSlots[_compID];
+
+        if (idx >= m_ticks.size()) ensureTickBlocks(block + 1);
+        m_ticks[idx].changed = m_currentTick;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Accessors
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
 
     /**
      * @brief Retrieves the component signature of the archetype.
@@ -162,44 +853,465 @@ class Archetype final
     /**
      * @brief Retrieves the mapping of component IDs to their byte offsets within the entity data.
      *
-     * @return const std::unordered_map<ComponentID, size_t>&
+     * @return const ComponentOffsets&
+     *
+     * @note In chunked mode the offsets describe the row layout accepted by insert().
      */
-    [[nodiscard]] inline const std::unordered_map<ComponentID, size_t>& componentOffsets()
-        const noexcept
+    [[nodiscard]] inline const ComponentOffsets& componentOffsets() const noexcept
     {
         return m_componentOffsets;
     }
 
+    // Returns the values of the shared components of the archetype (ascending ComponentIDs).
+    [[nodiscard]] inline const std::vector<SharedComponentValue>& sharedValues() const noexcept
+    {
+        return m_sharedValues;
+    }
+
+    // Returns the value of the given shared component, or nullptr if the archetype has none.
+    [[nodiscard]] inline Byte* sharedValue(ComponentID _compID) const noexcept
+    {
+        for (const SharedComponentValue& shared : m_sharedValues)
+        {
+            if (shared.id == _compID) return shared.value;
+        }
+
+        return nullptr;
+    }
+
+    // Sets the values of the shared components (done once by the registry on creation).
+    inline void setSharedValues(std::vector<SharedComponentValue> _values)
+    {
+        m_sharedValues = std::move(_values);
+    }
+
+    // Returns the key identifying the archetype in the owning registry.
+    [[nodiscard]] ArchetypeKey key() const { return {m_signature, m_sharedValues}; }
+
+    // Returns the index of the archetype in the owning registry's archetype table.
+    [[nodiscard]] inline uint32_t index() const noexcept { return m_index; }
+
+    // Sets the index of the archetype in the owning registry's archetype table.
+    inline void setIndex(uint32_t _index) noexcept { m_index = _index; }
+
+    // Returns the storage mode currently used by the archetype (adaptive ones report the layout
+    // they are in, interleaved or chunked).
+    [[nodiscard]] inline ArchetypeStorageMode storageMode() const noexcept
+    {
+        return m_storageMode;
+    }
+
+    // Returns whether the archetype uses chunked (SoA) storage.
+    [[nodiscard]] inline bool isChunked() const noexcept
+    {
+        return m_storageMode == ArchetypeStorageMode::chunked;
+    }
+
     // Returns the size in bytes of each entity's data (metadata and components).
     [[nodiscard]] inline size_t stride() const noexcept { return m_storage.stride(); }
 
     // Returns the number of entities in the archetype.
-    [[nodiscard]] inline size_t size() const noexcept { return m_storage.size(); }
+    [[nodiscard]] inline size_t size() const noexcept
+    {
+        return isChunked() ? m_chunkedStorage->size() : m_storage.size();
+    }
 
     // Checks if the archetype is empty (contains no entities).
-    [[nodiscard]] inline bool empty() const noexcept { return m_storage.empty(); }
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return isChunked() ? m_chunkedStorage->empty() : m_storage.empty();
+    }
 
-    // Provides direct access to the underlying data storage.
-    [[nodiscard]] inline Byte* data() noexcept { return m_storage.data().data(); }
+    // Provides direct access to the underlying row storage (interleaved mode only).
+    [[nodiscard]] inline Byte* data() noexcept
+    {
+        return isChunked() ? nullptr : m_storage.data().data();
+    }
 
-    // Returns the memory usage of the archetype in bytes.
+    // Returns the memory usage of the archetype in bytes (storage and change ticks).
     [[nodiscard]] inline size_t memoryUsageInBytes() const noexcept
     {
-        return m_storage.memoryUsageInBytes();
+        const size_t storage = isChunked() ? m_chunkedStorage->memoryUsageInBytes()
+                                           : m_storage.memoryUsageInBytes();
+
+        return storage + m_ticks.capacity() * sizeof(ColumnTicks);
+    }
+
+    /**
+     * @brief Releases the memory the archetype no longer needs: unused dense capacity, empty
+     * sparse pages, chunks past the last used one and ticks of blocks past the last row.
+     */
+    void shrinkToFit()
+    {
+        if (isChunked())
+        {
+            m_chunkedStorage->releaseEmptyPages();
+            m_chunkedStorage->shrinkToFit();
+        }
+        else
+        {
+            m_storage.releaseEmptyPages();
+            m_storage.shrinkToFit();
+        }
+
+        m_ticks.resize(std::min(m_ticks.size(), tickBlockCount() * m_tickColumnCount));
+        m_ticks.shrink_to_fit();
+    }
+
+    /**
+     * @brief Reorders the rows: row i afterwards holds the entity previously stored at row
+     * _order[i].
+     *
+     * Only the moved rows are copied and no component is stamped as changed by the move itself.
+     * As ticks are kept per block, every block takes the newest ticks of the blocks its rows come
+     * from, so Changed<>/Added<> filters may report more rows but never miss one. Callers must
+     * update the records of the moved entities.
+     *
+     * @param _order A permutation of [0, size()).
+     */
+    void permuteRows(std::span<const uint32_t> _order)
+    {
+        if (isChunked()) m_chunkedStorage->permute(_order);
+        else m_storage.permute(_order);
+
+        if (m_tickColumnCount == 0) return;
+
+        ensureTickBlocks(tickBlockCount());
+        const std::vector<ColumnTicks> ticks = m_ticks;
+
+        // Every block takes the newest ticks of the blocks its rows come from, rows are visited
+        // in order so each block is first assigned then merged with the following runs
+        size_t prevSrc = std::numeric_limits<size_t>::max();
+        size_t prevDst = std::numeric_limits<size_t>::max();
+
+        for (size_t row = 0; row < _order.size(); ++row)
+        {
+            const size_t srcBlock = tickBlockOf(_order[row]);
+            const size_t dstBlock = tickBlockOf(row);
+            if (srcBlock == prevSrc && dstBlock == prevDst) continue;
+
+            const ColumnTicks* src = ticks.data() + srcBlock * m_tickColumnCount;
+            ColumnTicks* dst = m_ticks.data() + dstBlock * m_tickColumnCount;
+
+            for (size_t column = 0; column < m_tickColumnCount; ++column)
+            {
+                if (dstBlock != prevDst)
+                {
+                    dst[column] = src[column];
+                    continue;
+                }
+
+                if (isNewerTick(src[column].added, dst[column].added))
+                {
+                    dst[column].added = src[column].added;
+                }
+                if (isNewerTick(src[column].changed, dst[column].changed))
+                {
+                    dst[column].changed = src[column].changed;
+                }
+            }
+
+            prevSrc = srcBlock;
+            prevDst = dstBlock;
+        }
     }
 
     // Returns all entity IDs stored in this archetype.
     [[nodiscard]] inline const std::vector<EntityID>& entityIDs() const noexcept
     {
-        return m_storage.keys();
+        return isChunked() ? m_chunkedStorage->keys() : m_storage.keys();
     }
 
     // Returns whether this archetype contains the specified entity.
     [[nodiscard]] inline bool contains(EntityID _eid) const noexcept
     {
-        return m_storage.contains(_eid);
+        return isChunked() ? m_chunkedStorage->contains(_eid) : m_storage.contains(_eid);
+    }
+
+   private:
+    // Flattens the offset (interleaved) or column (chunked) maps into m_componentSlots.
+    void buildSlotTable()
+    {
+        const auto& slots = isChunked() ? m_componentColumns : m_componentOffsets;
+
+        ComponentID maxID = 0;
+        for (const auto& [compID, slot] : slots) maxID = std::max(maxID, compID);
+
+        m_componentSlots.assign(slots.empty() ? 0 : maxID + 1, 0);
+        for (const auto& [compID, slot] : slots) m_componentSlots[compID] = slot;
+
+        // Tick columns follow ascending ComponentIDs and cover the whole signature, so tags get
+        // one as well (Added<Tag> works even though they have no storage)
+        ComponentID maxTickID = 0;
+        for (size_t compID = m_signature.findFirstSet(); compID < m_signature.size();
+             compID = m_signature.findFirstSetFrom(compID + 1))
+        {
+            maxTickID = compID + 1;
+        }
+
+        m_tickSlots.assign(maxTickID, 0);
+        m_tickColumnCount = 0;
+
+        for (ComponentID compID = 0; compID < maxTickID; ++compID)
+        {
+            if (m_signature.testBit(compID)) m_tickSlots[compID] = m_tickColumnCount++;
+        }
+    }
+
+    // Returns the dense row of a stored entity.
+    [[nodiscard]] size_t rowOf(EntityID _eid) const
+    {
+        if (isChunked()) return m_chunkedStorage->indexOf(_eid);
+
+        const Byte* rowPtr = m_storage.get(_eid);
+        return static_cast<size_t>(rowPtr - m_storage.data().data()) / stride();
+    }
+
+    // Appends a row without stamping any tick (callers stamp it according to its origin).
+    size_t emplaceRowUntracked(EntityID _eid)
+    {
+        splitIfOutgrown(size() + 1);
+
+        if (isChunked()) return m_chunkedStorage->emplaceUninitialized(_eid);
+
+        const size_t row = m_storage.size();
+        m_storage.emplaceUninitialized(_eid);
+        return row;
+    }
+
+    // Appends multiple rows without stamping any tick.
+    size_t emplaceRowsUntracked(const EntityID* _eids, size_t _count)
+    {
+        splitIfOutgrown(size() + _count);
+
+        if (isChunked()) return m_chunkedStorage->emplaceUninitializedBulk(_eids, _count);
+
+        const size_t first = m_storage.size();
+        m_storage.insertBulkUninitialized(_eids, _count);
+        return first;
+    }
+
+    // Returns the tick block of a row (constant divisor in interleaved mode).
+    [[nodiscard]] size_t tickBlockOf(size_t _row) const noexcept
+    {
+        return isChunked() ? _row / chunkCapacity() : _row / k_tickBlockRows;
+    }
+
+    // Grows the tick table so that it covers the given number of blocks.
+    void ensureTickBlocks(size_t _blockCount)
+    {
+        if (m_ticks.size() < _blockCount * m_tickColumnCount)
+        {
+            m_ticks.resize(_blockCount * m_tickColumnCount);
+        }
+    }
+
+    // Stamps every column of the blocks covering the rows as changed (and added if _added).
+    void markRowsWritten(size_t _firstRow, size_t _count, bool _added)
+    {
+        if (_count == 0 || m_tickColumnCount == 0) return;
+
+        const size_t firstBlock = tickBlockOf(_firstRow);
+        const size_t lastBlock = tickBlockOf(_firstRow + _count - 1) + 1;
+        ensureTickBlocks(lastBlock);
+
+        for (size_t i = firstBlock * m_tickColumnCount; i < lastBlock * m_tickColumnCount; ++i)
+        {
+            m_ticks[i].changed = m_currentTick;
+            if (_added) m_ticks[i].added = m_currentTick;
+        }
+    }
+
+    // Stamps rows moved in from an archetype with the given signature: every column is changed,
+    // the columns the source did not have are also added.
+    void markRowsMovedIn(size_t _firstRow, size_t _count, const ComponentSignature& _srcSignature)
+    {
+        if (_count == 0 || m_tickColumnCount == 0) return;
+
+        markRowsWritten(_firstRow, _count, false);
+
+        const size_t firstBlock = tickBlockOf(_firstRow);
+        const size_t lastBlock = tickBlockOf(_firstRow + _count - 1) + 1;
+
+        for (size_t compID = m_signature.findFirstSet(); compID < m_tickSlots.size();
+             compID = m_signature.findFirstSetFrom(compID + 1))
+        {
+            if (_srcSignature.testBit(compID)) continue;
+
+            for (size_t block = firstBlock; block < lastBlock; ++block)
+            {
+                m_ticks[block * m_tickColumnCount + m_tickSlots[compID]].added = m_currentTick;
+            }
+        }
+    }
+
+    // Single-row version of markRowsMovedIn() using the tick columns precomputed on the edge.
+    void markRowMovedAlong(size_t _row, const ArchetypeEdge& _edge)
+    {
+        if (m_tickColumnCount == 0) return;
+
+        const size_t block = tickBlockOf(_row);
+        ensureTickBlocks(block + 1);
+
+        ColumnTicks* ticks = m_ticks.data() + block * m_tickColumnCount;
+        for (size_t i = 0; i < m_tickColumnCount; ++i) ticks[i].changed = m_currentTick;
+        for (size_t slot : _edge.addedTickSlots) ticks[slot].added = m_currentTick;
+    }
+
+    // Moves an adaptive archetype to chunked storage when it is about to hold more than the
+    // split threshold.
+    void splitIfOutgrown(size_t _rowCount)
+    {
+        if (m_splitRows != 0 && _rowCount > m_splitRows && !isChunked()) splitIntoChunks();
+    }
+
+    /**
+     * @brief Moves the interleaved rows into chunks (same dense order, so rows keep their index)
+     * and releases the row array.
+     *
+     * Every chunk takes the newest ticks of the row blocks it covers, so Changed<>/Added<>
+     * filters may report more rows afterwards but never miss one.
+     */
+    void splitIntoChunks()
+    {
+        const size_t count = m_storage.size();
+        const size_t rowStride = stride();
+        const Byte* rows = m_storage.data().data();
+
+        m_chunkedStorage->emplaceUninitializedBulk(m_storage.keys().data(), count);
+
+        // column by column, the row array is read once per column but every write is sequential
+        auto copyColumn = [&](size_t _column, size_t _offset, size_t _size)
+        {
+            for (size_t row = 0; row < count; ++row)
+            {
+                std::memcpy(m_chunkedStorage->at(row, _column), rows + row * rowStride + _offset,
+                            _size);
+            }
+        };
+
+        copyColumn(k_metaColumn, 0, sizeof(EntityMeta));
+        for (const auto& [compID, column] : m_componentColumns)
+        {
+            const size_t size = m_chunkedStorage->column(column).size;
+            copyColumn(column, m_componentOffsets.at(compID), size);
+        }
+
+        const std::vector<ColumnTicks> rowTicks = std::move(m_ticks);
+
+        m_storageMode = ArchetypeStorageMode::chunked;
+        buildSlotTable();
+
+        m_ticks.assign(tickBlockCount() * m_tickColumnCount, ColumnTicks{});
+
+        const size_t rowBlocks = m_tickColumnCount ? rowTicks.size() / m_tickColumnCount : 0;
+        for (size_t block = 0; block < rowBlocks && block * k_tickBlockRows < count; ++block)
+        {
+            const size_t lastRow = std::min((block + 1) * k_tickBlockRows, count) - 1;
+            const ColumnTicks* src = rowTicks.data() + block * m_tickColumnCount;
+
+            for (size_t chunk = tickBlockOf(block * k_tickBlockRows); chunk <= tickBlockOf(lastRow);
+                 ++chunk)
+            {
+                ColumnTicks* dst = m_ticks.data() + chunk * m_tickColumnCount;
+
+                for (size_t column = 0; column < m_tickColumnCount; ++column)
+                {
+                    if (isNewerTick(src[column].added, dst[column].added))
+                    {
+                        dst[column].added = src[column].added;
+                    }
+                    if (isNewerTick(src[column].changed, dst[column].changed))
+                    {
+                        dst[column].changed = src[column].changed;
+                    }
+                }
+            }
+        }
+
+        m_storage.clear();
+        m_storage.shrinkToFit();
+    }
+
+   private:
+    // Copies a row laid out according to m_componentOffsets into the columns of a chunked row.
+    void scatterRow(size_t _row, const Byte* _data)
+    {
+        std::memcpy(m_chunkedStorage->at(_row, k_metaColumn), _data, sizeof(EntityMeta));
+
+        for (const auto& [compID, column] : m_componentColumns)
+        {
+            std::memcpy(m_chunkedStorage->at(_row, column), _data + m_componentOffsets.at(compID),
+                        m_chunkedStorage->column(column).size);
+        }
+    }
+
+    // Generic migration path used whenever at least one of the archetypes is chunked, or the
+    // copies are split across threads (the destination rows are all reserved up front).
+    template <typename RowRanges>
+    std::vector<EntityID> migrateAllToMixed(Archetype& _dest,
+                                            std::span<const SharedComponent> _sharedComponents,
+                                            RowRanges& _rowRanges)
+    {
+        if (empty()) return {};
+
+        std::vector<EntityID> migratedEntities(entityIDs());
+
+        const size_t first =
+            _dest.emplaceRowsUntracked(migratedEntities.data(), migratedEntities.size());
+        _dest.markRowsMovedIn(first, migratedEntities.size(), m_signature);
+
+        _rowRanges(migratedEntities.size(),
+                   [&](size_t _first, size_t _last)
+                   {
+                       for (size_t i = _first; i < _last; ++i)
+                       {
+                           *_dest.metaAt(first + i) = *metaAt(i);
+
+                           for (const auto& [compID, srcOff, destOff, size] : _sharedComponents)
+                           {
+                               std::memcpy(_dest.componentAt(first + i, compID),
+                                           componentAt(i, compID), size);
+                           }
+                       }
+                   });
+
+        if (isChunked())
+        {
+            m_chunkedStorage->clear();
+        }
+        else
+        {
+            m_storage.clear();
+        }
+
+        return migratedEntities;
     }
 };
 
 } // namespace ecs
 } // namespace mosaic
+
+namespace std
+{
+
+template <>
+struct hash<mosaic::ecs::ArchetypeKey>
+{
+    size_t operator()(const mosaic::ecs::ArchetypeKey& _key) const noexcept
+    {
+        constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+        uint64_t hash = std::hash<mosaic::ecs::ComponentSignature>{}(_key.signature);
+
+        for (const auto& shared : _key.sharedValues)
+        {
+            hash ^= (static_cast<uint64_t>(shared.id) << 32) | shared.index;
+            hash *= FNV_PRIME;
+        }
+
+        return static_cast<size_t>(hash);
+    }
+};
+
+} // namespace std
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include <pieces/memory/allocation_stats.hpp>
+
+#include "mosaic/defines.hpp"
+
+#include "storage_allocator.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+/**
+ * @brief Recycles the chunk allocations of the chunked archetypes of one registry.
+ *
+ * Chunks are carved from slabs of about `k_slabSizeInBytes` and freed chunks go back to the free
+ * list of their size, so a registry that keeps creating and destroying archetypes reuses its own
+ * memory instead of going through the global heap for every chunk. Independent registries
+ * simulated on different threads (see WorldSet) therefore never contend on the allocator, and
+ * the chunks of one world stay packed together.
+ *
+ * Slabs are only given back to the system by trim() or when the arena is destroyed. The slabs and
+ * the chunks in use are counted in the stats attached by setStats(), if any. Slabs come from the
+ * global heap, or from a StorageAllocator (e.g. PageStorageAllocator for large pages), their size
+ * then rounded up to its granularity().
+ *
+ * @note Not thread-safe, an arena belongs to a single registry.
+ */
+class ChunkArena final
+{
+   public:
+    using Byte = uint8_t;
+
+    static constexpr size_t k_slabSizeInBytes = 1 * BYTES_PER_MIB;
+    static constexpr size_t k_alignment = MOSAIC_CACHE_LINE_SIZE;
+
+   private:
+    struct Slab
+    {
+        Byte* memory;
+        size_t chunkCount;
+    };
+
+    // The slabs and free chunks of one chunk size
+    struct SizeClass
+    {
+        std::vector<Slab> slabs;
+        std::vector<Byte*> free;
+        size_t chunkCount = 0; // total over every slab
+    };
+
+    std::unordered_map<size_t, SizeClass> m_classes; // keyed by chunk size
+    size_t m_reservedBytes = 0;
+    pieces::AllocationStats* m_stats = nullptr;
+    StorageAllocator* m_storageAllocator = nullptr; // null = global heap
+
+   public:
+    ChunkArena() = default;
+
+    // The slabs are allocated from the given allocator (it must outlive the arena).
+    explicit ChunkArena(StorageAllocator* _storageAllocator) noexcept
+        : m_storageAllocator(_storageAllocator)
+    {
+    }
+
+    ~ChunkArena()
+    {
+        setStats(nullptr);
+
+        for (auto& [size, sizeClass] : m_classes)
+        {
+            for (const Slab& slab : sizeClass.slabs) freeSlab(slab, size);
+        }
+    }
+
+    ChunkArena(const ChunkArena&) = delete;
+    ChunkArena& operator=(const ChunkArena&) = delete;
+
+   public:
+    /**
+     * @brief Hands out a chunk of the given size (a multiple of `k_alignment`), aligned on
+     * `k_alignment`.
+     *
+     * @throws std::bad_alloc if a new slab cannot be allocated.
+     */
+    [[nodiscard]] Byte* allocate(size_t _size)
+    {
+        SizeClass& sizeClass = m_classes[_size];
+        if (sizeClass.free.empty()) addSlab(sizeClass, _size);
+
+        Byte* chunk = sizeClass.free.back();
+        sizeClass.free.pop_back();
+
+        if (m_stats) m_stats->allocate(_size);
+
+        return chunk;
+    }
+
+    /**
+     * @brief Gives back a chunk obtained from allocate() with the same size.
+     */
+    void deallocate(Byte* _chunk, size_t _size) noexcept
+    {
+        // the free list always has room for every chunk of the class (see addSlab())
+        m_classes.find(_size)->second.free.push_back(_chunk);
+
+        if (m_stats) m_stats->deallocate(_size);
+    }
+
+    /**
+     * @brief Releases the slabs none of whose chunks are in use.
+     *
+     * @return The number of bytes given back to the system.
+     */
+    size_t trim()
+    {
+        size_t released = 0;
+
+        for (auto& [size, sizeClass] : m_classes)
+        {
+            std::vector<Byte*>& free = sizeClass.free;
+            std::sort(free.begin(), free.end());
+
+            std::erase_if(
+                sizeClass.slabs,
+                [&, size = size](const Slab& _slab)
+                {
+                    Byte* end = _slab.memory + _slab.chunkCount * size;
+                    const auto first = std::lower_bound(free.begin(), free.end(), _slab.memory);
+                    const auto last = std::lower_bound(first, free.end(), end);
+                    if (static_cast<size_t>(last - first) != _slab.chunkCount) return false;
+
+                    free.erase(first, last);
+                    sizeClass.chunkCount -= _slab.chunkCount;
+                    released += _slab.chunkCount * size;
+                    freeSlab(_slab, size);
+                    return true;
+                });
+        }
+
+        m_reservedBytes -= released;
+        if (m_stats) m_stats->release(released);
+        std::erase_if(m_classes, [](const auto& _entry) { return _entry.second.slabs.empty(); });
+
+        return released;
+    }
+
+    /**
+     * @brief Attaches the counters of a subsystem to the arena (nullptr detaches it), the slabs
+     * and the chunks in use are moved over from the previous ones.
+     */
+    void setStats(pieces::AllocationStats* _stats) noexcept
+    {
+        const size_t inUse = m_reservedBytes - freeBytes();
+
+        if (m_stats)
+        {
+            m_stats->deallocate(inUse);
+            m_stats->release(m_reservedBytes);
+        }
+
+        m_stats = _stats;
+
+        if (m_stats)
+        {
+            m_stats->reserve(m_reservedBytes);
+            if (inUse > 0) m_stats->allocate(inUse);
+        }
+    }
+
+    [[nodiscard]] pieces::AllocationStats* getStats() const noexcept { return m_stats; }
+
+    [[nodiscard]] StorageAllocator* storageAllocator() const noexcept
+    {
+        return m_storageAllocator;
+    }
+
+    // Returns the bytes held by the slabs, whether their chunks are in use or not.
+    [[nodiscard]] size_t reservedBytes() const noexcept { return m_reservedBytes; }
+
+    // Returns the bytes of the chunks waiting in the free lists.
+    [[nodiscard]] size_t freeBytes() const noexcept
+    {
+        size_t total = 0;
+
+        for (const auto& [size, sizeClass] : m_classes) total += sizeClass.free.size() * size;
+
+        return total;
+    }
+
+   private:
+    void addSlab(SizeClass& _sizeClass, size_t _size)
+    {
+        size_t slabSize = k_slabSizeInBytes;
+        if (m_storageAllocator)
+        {
+            const size_t granularity = m_storageAllocator->granularity();
+            slabSize = (std::max(slabSize, _size) + granularity - 1) / granularity * granularity;
+        }
+
+        const size_t chunkCount = std::max<size_t>(slabSize / _size, 1);
+
+        // reserved first so deallocate() never has to grow the free list
+        const size_t needed = _sizeClass.chunkCount + chunkCount;
+        _sizeClass.free.reserve(std::max(needed, _sizeClass.free.capacity() * 2));
+
+        _sizeClass.slabs.push_back({nullptr, chunkCount});
+        try
+        {
+            _sizeClass.slabs.back().memory =
+                m_storageAllocator
+                    ? m_storageAllocator->allocate(chunkCount * _size, k_alignment)
+                    : static_cast<Byte*>(
+                          ::operator new(chunkCount * _size, std::align_val_t{k_alignment}));
+        }
+        catch (...)
+        {
+            _sizeClass.slabs.pop_back();
+            throw;
+        }
+
+        Byte* memory = _sizeClass.slabs.back().memory;
+        _sizeClass.chunkCount += chunkCount;
+        m_reservedBytes += chunkCount * _size;
+        if (m_stats) m_stats->reserve(chunkCount * _size);
+
+        // handed out from the front of the slab first
+        for (size_t i = chunkCount; i-- > 0;) _sizeClass.free.push_back(memory + i * _size);
+    }
+
+    void freeSlab(const Slab& _slab, size_t _size) noexcept
+    {
+        if (m_storageAllocator)
+        {
+            m_storageAllocator->deallocate(_slab.memory, _slab.chunkCount * _size, k_alignment);
+        }
+        else ::operator delete(_slab.memory, std::align_val_t{k_alignment});
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "entity_registry.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+namespace detail
+{
+
+// Unique address per batch type, used to merge the commands of the same kind.
+template <typename Batch>
+inline constexpr char k_commandBatchTag = 0;
+
+/**
+ * @brief Type-erased group of recorded commands of the same kind (same component types), played
+ * back against the registry in a single batched call.
+ */
+class CommandBatch
+{
+   private:
+    const void* m_key;
+
+   public:
+    explicit CommandBatch(const void* _key) : m_key(_key) {};
+    virtual ~CommandBatch() = default;
+
+    CommandBatch(const CommandBatch&) = delete;
+    CommandBatch& operator=(const CommandBatch&) = delete;
+
+   public:
+    // Applies the recorded commands to the registry.
+    virtual void playback(EntityRegistry& _registry) = 0;
+
+    // Moves the commands of a batch of the same kind at the end of this one.
+    virtual void append(CommandBatch& _other) = 0;
+
+    [[nodiscard]] virtual size_t commandCount() const noexcept = 0;
+
+    [[nodiscard]] const void* key() const noexcept { return m_key; }
+};
+
+template <typename AddList, typename RemoveList>
+class ModifyBatch;
+
+// Default-constructed additions and removals, played back through modifyComponentsBulk().
+template <Component... AddComponents, Component... RemoveComponents>
+class ModifyBatch<TypeList<AddComponents...>, TypeList<RemoveComponents...>> final
+    : public CommandBatch
+{
+   private:
+    std::vector<EntityID> m_eids;
+
+   public:
+    ModifyBatch() : CommandBatch(&k_commandBatchTag<ModifyBatch>) {};
+
+   public:
+    void record(EntityID _eid) { m_eids.push_back(_eid); }
+
+    void playback(EntityRegistry& _registry) override
+    {
+        _registry.modifyComponentsBulk(Add<AddComponents...>{}, Remove<RemoveComponents...>{},
+                                       m_eids);
+    }
+
+    void append(CommandBatch& _other) override
+    {
+        auto& other = static_cast<ModifyBatch&>(_other);
+        m_eids.insert(m_eids.end(), other.m_eids.begin(), other.m_eids.end());
+    }
+
+    [[nodiscard]] size_t commandCount() const noexcept override { return m_eids.size(); }
+};
+
+// Additions with explicit values, played back in recording order once the bulk moves are done.
+template <Component... Ts>
+class AddWithValuesBatch final : public CommandBatch
+{
+   private:
+    std::vector<std::pair<EntityID, std::tuple<Ts...>>> m_commands;
+
+   public:
+    AddWithValuesBatch() : CommandBatch(&k_commandBatchTag<AddWithValuesBatch>) {};
+
+   public:
+    void record(EntityID _eid, const Ts&... _values) { m_commands.push_back({_eid, {_values...}}); }
+
+    void playback(EntityRegistry& _registry) override
+    {
+        for (const auto& [eid, values] : m_commands)
+        {
+            addWithValues(_registry, eid, values, std::index_sequence_for<Ts...>{});
+        }
+    }
+
+    void append(CommandBatch& _other) override
+    {
+        auto& other = static_cast<AddWithValuesBatch&>(_other);
+        m_commands.insert(m_commands.end(), other.m_commands.begin(), other.m_commands.end());
+    }
+
+    [[nodiscard]] size_t commandCount() const noexcept override { return m_commands.size(); }
+
+   private:
+    template <size_t... Is>
+    static void addWithValues(EntityRegistry& _registry, EntityID _eid,
+                              const std::tuple<Ts...>& _values, std::index_sequence<Is...>)
+    {
+        _registry.addComponents<Ts...>(_eid, std::make_tuple(std::get<Is>(_values))...);
+    }
+};
+
+// Creations of default-constructed entities, played back through createEntityBulk().
+template <Component... Ts>
+class CreateBatch final : public CommandBatch
+{
+   private:
+    size_t m_count = 0;
+
+   public:
+    CreateBatch() : CommandBatch(&k_commandBatchTag<CreateBatch>) {};
+
+   public:
+    void record() { ++m_count; }
+
+    void playback(EntityRegistry& _registry) override
+    {
+        (void)_registry.createEntityBulk<Ts...>(m_count);
+    }
+
+    void append(CommandBatch& _other) override
+    {
+        m_count += static_cast<CreateBatch&>(_other).m_count;
+    }
+
+    [[nodiscard]] size_t commandCount() const noexcept override { return m_count; }
+};
+
+// Creations with explicit component values, played back one entity at a time.
+template <Component... Ts>
+class CreateWithValuesBatch final : public CommandBatch
+{
+   private:
+    std::vector<std::tuple<Ts...>> m_commands;
+
+   public:
+    CreateWithValuesBatch() : CommandBatch(&k_commandBatchTag<CreateWithValuesBatch>) {};
+
+   public:
+    void record(const Ts&... _values) { m_commands.emplace_back(_values...); }
+
+    void playback(EntityRegistry& _registry) override
+    {
+        for (const auto& values : m_commands)
+        {
+            createWithValues(_registry, values, std::index_sequence_for<Ts...>{});
+        }
+    }
+
+    void append(CommandBatch& _other) override
+    {
+        auto& other = static_cast<CreateWithValuesBatch&>(_other);
+        m_commands.insert(m_commands.end(), other.m_commands.begin(), other.m_commands.end());
+    }
+
+    [[nodiscard]] size_t commandCount() const noexcept override { return m_commands.size(); }
+
+   private:
+    template <size_t... Is>
+    static void createWithValues(EntityRegistry& _registry, const std::tuple<Ts...>& _values,
+                                 std::index_sequence<Is...>)
+    {
+        (void)_registry.createEntity<Ts...>(std::make_tuple(std::get<Is>(_values))...);
+    }
+};
+
+// Creations of entities whose handles were reserved up front, played back one entity at a time.
+template <Component... Ts>
+class ReservedCreateBatch final : public CommandBatch
+{
+   private:
+    std::vector<std::pair<EntityMeta, std::tuple<Ts...>>> m_commands;
+
+   public:
+    ReservedCreateBatch() : CommandBatch(&k_commandBatchTag<ReservedCreateBatch>) {};
+
+   public:
+    void record(EntityMeta _reserved, const Ts&... _values)
+    {
+        m_commands.emplace_back(_reserved, std::tuple<Ts...>{_values...});
+    }
+
+    void playback(EntityRegistry& _registry) override
+    {
+        for (const auto& [reserved, values] : m_commands)
+        {
+            createReserved(_registry, reserved, values, std::index_sequence_for<Ts...>{});
+        }
+    }
+
+    void append(CommandBatch& _other) override
+    {
+        auto& other = static_cast<ReservedCreateBatch&>(_other);
+        m_commands.insert(m_commands.end(), other.m_commands.begin(), other.m_commands.end());
+    }
+
+    [[nodiscard]] size_t commandCount() const noexcept override { return m_commands.size(); }
+
+   private:
+    template <size_t... Is>
+    static void createReserved(EntityRegistry& _registry, EntityMeta _reserved,
+                               const std::tuple<Ts...>& _values, std::index_sequence<Is...>)
+    {
+        (void)_registry.createReservedEntity<Ts...>(_reserved,
+                                                    std::make_tuple(std::get<Is>(_values))...);
+    }
+};
+
+// Component bytes written by ID (dynamic components, editors), copied when recorded and played
+// back in recording order through getComponent().
+class WriteBatch final : public CommandBatch
+{
+   private:
+    struct Write
+    {
+        EntityID eid;
+        ComponentID component;
+        size_t offset;
+        size_t size;
+    };
+
+    std::vector<Write> m_writes;
+    std::vector<uint8_t> m_bytes;
+
+   public:
+    WriteBatch() : CommandBatch(&k_commandBatchTag<WriteBatch>) {};
+
+   public:
+    void record(EntityID _eid, ComponentID _compID, std::span<const uint8_t> _bytes)
+    {
+        m_writes.push_back({_eid, _compID, m_bytes.size(), _bytes.size()});
+        m_bytes.insert(m_bytes.end(), _bytes.begin(), _bytes.end());
+    }
+
+    void playback(EntityRegistry& _registry) override
+    {
+        for (const Write& write : m_writes)
+        {
+            uint8_t* component = _registry.getComponent(write.eid, write.component);
+            if (!component) continue;
+
+            std::memcpy(component, m_bytes.data() + write.offset, write.size);
+            _registry.markChanged(write.eid, write.component);
+        }
+    }
+
+    void append(CommandBatch& _other) override
+    {
+        auto& other = static_cast<WriteBatch&>(_other);
+
+        for (const Write& write : other.m_writes)
+        {
+            m_writes.push_back({write.eid, write.component, write.offset + m_bytes.size(),
+                                write.size});
+        }
+        m_bytes.insert(m_bytes.end(), other.m_bytes.begin(), other.m_bytes.end());
+    }
+
+    [[nodiscard]] size_t commandCount() const noexcept override { return m_writes.size(); }
+};
+
+// Components added (zeroed or copied) or removed by ID, played back in recording order.
+class ModifyByIDBatch final : public CommandBatch
+{
+   private:
+    struct Modify
+    {
+        EntityID eid;
+        ComponentID component;
+        bool add;
+        bool hasValue;
+        size_t offset;
+    };
+
+    std::vector<Modify> m_commands;
+    std::vector<uint8_t> m_bytes;
+
+   public:
+    ModifyByIDBatch() : CommandBatch(&k_commandBatchTag<ModifyByIDBatch>) {};
+
+   public:
+    void record(EntityID _eid, ComponentID _compID, bool _add, std::span<const uint8_t> _value)
+    {
+        m_commands.push_back({_eid, _compID, _add, !_value.empty(), m_bytes.size()});
+        m_bytes.insert(m_bytes.end(), _value.begin(), _value.end());
+    }
+
+    void playback(EntityRegistry& _registry) override
+    {
+        for (const Modify& command : m_commands)
+        {
+            if (!command.add)
+            {
+                _registry.removeComponent(command.eid, command.component);
+                continue;
+            }
+
+            const uint8_t* value = command.hasValue ? m_bytes.data() + command.offset : nullptr;
+            _registry.addComponent(command.eid, command.component, value);
+        }
+    }
+
+    void append(CommandBatch& _other) override
+    {
+        auto& other = static_cast<ModifyByIDBatch&>(_other);
+
+        for (Modify command : other.m_commands)
+        {
+            command.offset += m_bytes.size();
+            m_commands.push_back(command);
+        }
+        m_bytes.insert(m_bytes.end(), other.m_bytes.begin(), other.m_bytes.end());
+    }
+
+    [[nodiscard]] size_t commandCount() const noexcept override { return m_commands.size(); }
+};
+
+} // namespace detail
+
+/**
+ * @brief The 'EntityCommandBuffer' class records structural changes (creations, destructions and
+ * component additions/removals) so they can be applied later at a sync point.
+ *
+ * Structural changes swap-and-pop archetype rows and invalidate any running iteration, so systems
+ * iterating a view (possibly in parallel) record them instead. A buffer is not thread-safe: each
+ * thread records into its own buffer, and buffers are merged with append() before playback.
+ *
+ * Commands are grouped by kind (the exact set of component types involved) and every group is
+ * applied with a single bulk call, which in turn groups entities by source archetype. Playback
+ * applies, in order: creations of reserved handles, component modifications (in the order their
+ * kinds were first recorded), then destructions, then creations. Commands targeting entities that
+ * no longer exist are skipped.
+ *
+ * Creations through a handle reserved with EntityRegistry::reserveEntity() (or an EntityReserver)
+ * let the recording thread know the entity ID up front and record further commands targeting it.
+ */
+class EntityCommandBuffer final
+{
+   private:
+    std::vector<std::unique_ptr<detail::CommandBatch>> m_modifyBatches;
+    std::vector<std::unique_ptr<detail::CommandBatch>> m_createBatches;
+    std::vector<std::unique_ptr<detail::CommandBatch>> m_reservedCreateBatches;
+    std::vector<EntityID> m_destroyed;
+
+   public:
+    EntityCommandBuffer() = default;
+
+    EntityCommandBuffer(EntityCommandBuffer&&) noexcept = default;
+    EntityCommandBuffer& operator=(EntityCommandBuffer&&) noexcept = default;
+
+   public:
+    // Records the creation of an entity with default-constructed components.
+    template <Component... Ts>
+    void createEntity()
+    {
+        findOrAddBatch<detail::CreateBatch<Ts...>>(m_createBatches).record();
+    }
+
+    // Records the creation of an entity whose components are copies of the given values.
+    template <Component... Ts>
+        requires(sizeof...(Ts) > 0)
+    void createEntity(const Ts&... _values)
+    {
+        findOrAddBatch<detail::CreateWithValuesBatch<Ts...>>(m_createBatches).record(_values...);
+    }
+
+    /**
+     * @brief Records the creation of the entity of a reserved handle, with default-constructed
+     * components or copies of the given values.
+     *
+     * Played back before any other command, so commands recorded for the handle in the same
+     * buffer apply to the created entity. Handles that are not pending reservations anymore when
+     * played back are skipped.
+     */
+    template <Component... Ts>
+    void createReservedEntity(EntityMeta _reserved)
+    {
+        findOrAddBatch<detail::ReservedCreateBatch<Ts...>>(m_reservedCreateBatches)
+            .record(_reserved, Ts{}...);
+    }
+
+    template <Component... Ts>
+        requires(sizeof...(Ts) > 0)
+    void createReservedEntity(EntityMeta _reserved, const Ts&... _values)
+    {
+        findOrAddBatch<detail::ReservedCreateBatch<Ts...>>(m_reservedCreateBatches)
+            .record(_reserved, _values...);
+    }
+
+    // Records the destruction of an entity.
+    void destroyEntity(EntityID _eid) { m_destroyed.push_back(_eid); }
+
+    // Records the addition and/or removal of (default-constructed) components to an entity.
+    template <Component... AddComponents, Component... RemoveComponents>
+    void modifyComponents(EntityID _eid, detail::Add<AddComponents...>,
+                          detail::Remove<RemoveComponents...>)
+    {
+        using Batch = detail::ModifyBatch<detail::Add<AddComponents...>,
+                                          detail::Remove<RemoveComponents...>>;
+
+        findOrAddBatch<Batch>(m_modifyBatches).record(_eid);
+    }
+
+    // Records the addition of default-constructed components to an entity.
+    template <Component... Ts>
+    void addComponents(EntityID _eid)
+    {
+        modifyComponents(_eid, detail::Add<Ts...>{}, detail::Remove<>{});
+    }
+
+    // Records the addition of components initialized with copies of the given values.
+    template <Component... Ts>
+        requires(sizeof...(Ts) > 0)
+    void addComponents(EntityID _eid, const Ts&... _values)
+    {
+        findOrAddBatch<detail::AddWithValuesBatch<Ts...>>(m_modifyBatches).record(_eid, _values...);
+    }
+
+    // Records the removal of components from an entity.
+    template <Component... Ts>
+    void removeComponents(EntityID _eid)
+    {
+        modifyComponents(_eid, detail::Add<>{}, detail::Remove<Ts...>{});
+    }
+
+    /**
+     * @brief Records the bytes of a component of the given ID, copied into the entity's component
+     * when played back and stamped as changed (skipped if the entity does not have it then).
+     *
+     * @param _bytes The whole component (info(_compID).size bytes), copied when recorded.
+     */
+    void setComponent(EntityID _eid, ComponentID _compID, std::span<const uint8_t> _bytes)
+    {
+        findOrAddBatch<detail::WriteBatch>(m_modifyBatches).record(_eid, _compID, _bytes);
+    }
+
+    // Records the addition of the component of the given ID, zeroed or copied from _value.
+    void addComponent(EntityID _eid, ComponentID _compID, std::span<const uint8_t> _value = {})
+    {
+        findOrAddBatch<detail::ModifyByIDBatch>(m_modifyBatches)
+            .record(_eid, _compID, true, _value);
+    }
+
+    // Records the removal of the component of the given ID.
+    void removeComponent(EntityID _eid, ComponentID _compID)
+    {
+        findOrAddBatch<detail::ModifyByIDBatch>(m_modifyBatches).record(_eid, _compID, false, {});
+    }
+
+    /**
+     * @brief Moves every command recorded in another buffer at the end of this one.
+     *
+     * Commands of the same kind are merged in a single group, so merging the per-thread buffers
+     * before playback maximizes batching.
+     *
+     * @param _other The buffer to take the commands from (left empty).
+     */
+    void append(EntityCommandBuffer&& _other)
+    {
+        appendBatches(m_modifyBatches, _other.m_modifyBatches);
+        appendBatches(m_createBatches, _other.m_createBatches);
+        appendBatches(m_reservedCreateBatches, _other.m_reservedCreateBatches);
+
+        m_destroyed.insert(m_destroyed.end(), _other.m_destroyed.begin(), _other.m_destroyed.end());
+
+        _other.clear();
+    }
+
+    /**
+     * @brief Applies every recorded command to the registry, then clears the buffer.
+     *
+     * Must be called from a sync point where no view of the registry is being iterated.
+     *
+     * @param _registry The registry to apply the commands to.
+     * @throws std::runtime_error if one or more components are not registered.
+     */
+    void playback(EntityRegistry& _registry)
+    {
+        for (auto& batch : m_reservedCreateBatches) batch->playback(_registry);
+
+        for (auto& batch : m_modifyBatches) batch->playback(_registry);
+
+        if (!m_destroyed.empty()) (void)_registry.destroyEntityBulk(m_destroyed);
+
+        for (auto& batch : m_createBatches) batch->playback(_registry);
+
+        clear();
+    }
+
+    // Discards every recorded command.
+    void clear()
+    {
+        m_modifyBatches.clear();
+        m_createBatches.clear();
+        m_reservedCreateBatches.clear();
+        m_destroyed.clear();
+    }
+
+    // Returns the number of recorded commands.
+    [[nodiscard]] size_t commandCount() const noexcept
+    {
+        size_t count = m_destroyed.size();
+        for (const auto& batch : m_modifyBatches) count += batch->commandCount();
+        for (const auto& batch : m_createBatches) count += batch->commandCount();
+        for (const auto& batch : m_reservedCreateBatches) count += batch->commandCount();
+        return count;
+    }
+
+    // Checks if no command has been recorded.
+    [[nodiscard]] bool empty() const noexcept { return commandCount() == 0; }
+
+   private:
+    // Kinds are few per buffer, so a linear search keeps the recording order without a map.
+    template <typename Batch>
+    static Batch& findOrAddBatch(std::vector<std::unique_ptr<detail::CommandBatch>>& _batches)
+    {
+        const void* key = &detail::k_commandBatchTag<Batch>;
+
+        for (auto& batch : _batches)
+        {
+            if (batch->key() == key) return static_cast<Batch&>(*batch);
+        }
+
+        return static_cast<Batch&>(*_batches.emplace_back(std::make_unique<Batch>()));
+    }
+
+    static void appendBatches(std::vector<std::unique_ptr<detail::CommandBatch>>& _dst,
+                              std::vector<std::unique_ptr<detail::CommandBatch>>& _src)
+    {
+        for (auto& batch : _src)
+        {
+            auto it = std::find_if(_dst.begin(), _dst.end(),
+                                   [&](const auto& _b) { return _b->key() == batch->key(); });
+
+            if (it != _dst.end()) (*it)->append(*batch);
+            else _dst.push_back(std::move(batch));
+        }
+
+        _src.clear();
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
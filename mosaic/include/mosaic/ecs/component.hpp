@@ -1,9 +1,22 @@
 #pragma once
 
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 
 #include <pieces/containers/bitset.hpp>
+#include <pieces/containers/flat_hash_map.hpp>
+#include <pieces/containers/static_bitset.hpp>
+
+/**
+ * @brief Upper bound on the number of component types a ComponentRegistry can hold.
+ *
+ * Up to 256 components, signatures are stored inline (pieces::StaticBitSet), larger limits fall
+ * back to the heap-allocated pieces::BitSet.
+ */
+#ifndef MOSAIC_ECS_MAX_COMPONENTS
+#define MOSAIC_ECS_MAX_COMPONENTS 256
+#endif
 
 namespace mosaic
 {
@@ -11,13 +24,27 @@ namespace ecs
 {
 
 using ComponentID = size_t;
-using ComponentSignature = pieces::BitSet;
+
+// Byte offset in a row (interleaved) or column index (chunked) of each component of an archetype
+using ComponentOffsets = pieces::FlatHashMap<ComponentID, size_t>;
+
+inline constexpr size_t k_maxComponents = MOSAIC_ECS_MAX_COMPONENTS;
+inline constexpr bool k_inlineSignatures = k_maxComponents <= 256;
+
+using ComponentSignature =
+    std::conditional_t<k_inlineSignatures, pieces::StaticBitSet<k_maxComponents>, pieces::BitSet>;
 
 struct ComponentMeta
 {
     std::string name;
     size_t size;
     size_t alignment;
+    bool shared = false; // one value per archetype, see EntityRegistry::setSharedComponent()
+    bool sparse = false; // kept out of archetypes, see EntityRegistry::addSparseComponent()
+
+    // Checks if the component takes bytes in the rows of its archetypes (not a tag, shared or
+    // sparse).
+    [[nodiscard]] bool hasRowStorage() const noexcept { return size != 0 && !shared && !sparse; }
 };
 
 template <typename T>
@@ -25,9 +52,24 @@ concept Component = std::is_trivially_copyable_v<T> && std::is_trivially_destruc
                     !std::is_pointer_v<T> && !std::is_reference_v<T> && !std::is_const_v<T> &&
                     !std::is_volatile_v<T> && std::is_standard_layout_v<T>;
 
+/**
+ * @brief Empty component types are tags: they take part in archetype signatures (and so in
+ * queries) but are registered with a size of 0 and get neither row bytes nor a column.
+ */
+template <typename T>
+concept TagComponent = Component<T> && std::is_empty_v<T>;
+
 namespace detail
 {
 
+// Shared instance handed out wherever a reference to a tag is expected, tags having no storage.
+template <TagComponent T>
+[[nodiscard]] inline T& tagInstance() noexcept
+{
+    static T s_instance{};
+    return s_instance;
+}
+
 template <typename... Ts>
 struct TypeList
 {
@@ -42,8 +84,42 @@ using Add = TypeList<Components...>;
 template <Component... Components>
 using Remove = TypeList<Components...>;
 
+// Change-detection filters, distinct types so views can overload on them
+template <Component... Components>
+struct Changed
+{
+};
+
 template <Component... Components>
-using With = TypeList<Components...>;
+struct Added
+{
+};
+
+// Query terms (see EntityRegistry::query()), a plain component in a query stands for Write<T>
+template <Component T>
+struct Read // fetched as const T&, never stamped as changed
+{
+};
+
+template <Component T>
+struct Write // fetched as T&
+{
+};
+
+template <Component T>
+struct With // required but not fetched
+{
+};
+
+template <Component T>
+struct Without // archetypes with T are skipped
+{
+};
+
+template <Component T>
+struct Optional // fetched as T*, nullptr in archetypes without T
+{
+};
 
 } // namespace detail
 
@@ -79,4 +155,24 @@ struct hash<pieces::BitSet>
     }
 };
 
+template <size_t N>
+struct hash<pieces::StaticBitSet<N>>
+{
+    size_t operator()(const pieces::StaticBitSet<N>& _bitset) const noexcept
+    {
+        constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+        constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+        uint64_t hash = FNV_OFFSET_BASIS;
+
+        for (size_t i = 0; i < _bitset.wordCount(); ++i)
+        {
+            hash ^= _bitset.data()[i];
+            hash *= FNV_PRIME;
+        }
+
+        return static_cast<size_t>(hash);
+    }
+};
+
 } // namespace std
@@ -1,10 +1,12 @@
 #pragma once
 
-#include <typeindex>
+#include <atomic>
+#include <bit>
+#include <limits>
+#include <stdexcept>
 #include <typeinfo>
 #include <string>
 #include <vector>
-#include <unordered_map>
 
 #include "component.hpp"
 
@@ -13,6 +15,32 @@ namespace mosaic
 namespace ecs
 {
 
+namespace detail
+{
+
+// Hands out dense, process-wide type slots (shared by every ComponentRegistry instance).
+[[nodiscard]] inline size_t nextComponentTypeSlot() noexcept
+{
+    static std::atomic<size_t> s_nextSlot = 0;
+    return s_nextSlot.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the process-wide type slot of T, assigned on first use.
+ *
+ * Registries map slots to their own ComponentIDs through a flat table, so resolving the ID of a
+ * type is a single indexed load. A function-local static is used instead of a variable template
+ * so the slot is always initialized before use, even from other static initializers.
+ */
+template <typename T>
+[[nodiscard]] inline size_t componentTypeSlot() noexcept
+{
+    static const size_t s_slot = nextComponentTypeSlot();
+    return s_slot;
+}
+
+} // namespace detail
+
 /**
  * @brief The 'ComponentRegistry' class manages the registration and metadata of component types
  * within an ECS architecture.
@@ -30,8 +58,10 @@ namespace ecs
 class ComponentRegistry final
 {
    private:
+    static constexpr ComponentID k_invalidID = std::numeric_limits<ComponentID>::max();
+
     size_t m_maxComponents;
-    std::unordered_map<std::type_index, ComponentID> m_typeToId;
+    std::vector<ComponentID> m_slotToId; // indexed by detail::componentTypeSlot<T>()
     std::vector<ComponentMeta> m_infos;
 
    public:
@@ -40,11 +70,17 @@ class ComponentRegistry final
      *
      * @param _maxComponents The maximum number of distinct component types that can be
      * registered. Default is 64.
+     * @throws std::invalid_argument if _maxComponents exceeds the inline signature capacity
+     * (MOSAIC_ECS_MAX_COMPONENTS).
      */
     ComponentRegistry(size_t _maxComponents = 64) : m_maxComponents(_maxComponents)
     {
+        if (k_inlineSignatures && _maxComponents > k_maxComponents)
+        {
+            throw std::invalid_argument("Maximum components exceed MOSAIC_ECS_MAX_COMPONENTS!");
+        }
+
         m_infos.reserve(_maxComponents);
-        m_typeToId.reserve(_maxComponents);
     }
 
    public:
@@ -66,20 +102,115 @@ class ComponentRegistry final
             throw std::runtime_error("Exceeded maximum number of components!");
         }
 
-        auto it = m_typeToId.find(std::type_index(typeid(T)));
-        if (it != m_typeToId.end()) return it->second;
+        const size_t slot = detail::componentTypeSlot<T>();
+        if (slot < m_slotToId.size() && m_slotToId[slot] != k_invalidID) return m_slotToId[slot];
+
+        if (slot >= m_slotToId.size()) m_slotToId.resize(slot + 1, k_invalidID);
 
         ComponentID id = static_cast<ComponentID>(m_infos.size());
-        m_typeToId[typeid(T)] = id;
+        m_slotToId[slot] = id;
+        // tags are signature-only, size 0 keeps them out of every row layout
         m_infos.push_back({
             name,
-            sizeof(T),
-            alignof(T),
+            TagComponent<T> ? 0 : sizeof(T),
+            TagComponent<T> ? 1 : alignof(T),
         });
 
         return id;
     }
 
+    /**
+     * @brief Registers a new shared component type T with an optional name.
+     *
+     * Entities do not store shared components in their rows: the archetype holds a reference to
+     * a value interned by the entity registry, see EntityRegistry::setSharedComponent().
+     *
+     * @tparam T The component type to be registered (tags cannot be shared).
+     * @param name An optional name for the component type.
+     * @return The unique ComponentID assigned to the registered component type.
+     * @throws std::runtime_error under the same conditions as registerComponent() or if T is
+     * already registered as a regular component.
+     */
+    template <typename T>
+        requires(!TagComponent<T>)
+    ComponentID registerSharedComponent(const std::string& name = typeid(T).name())
+    {
+        const bool wasRegistered = isRegistered<T>();
+        const ComponentID id = registerComponent<T>(name);
+
+        if (wasRegistered && !m_infos[id].shared)
+        {
+            throw std::runtime_error("Component already registered as a regular component!");
+        }
+
+        m_infos[id].shared = true;
+        return id;
+    }
+
+    /**
+     * @brief Registers a new sparse component type T with an optional name.
+     *
+     * Sparse components never enter archetype signatures: their values live in one sparse set
+     * keyed by EntityID, so adding or removing one is O(1) and moves no row. Meant for components
+     * toggled every few frames (selection, combat state, one-shot markers), see
+     * EntityRegistry::addSparseComponent(). Queries join them by probing the set per entity.
+     *
+     * @tparam T The component type to be registered (tags included).
+     * @param name An optional name for the component type.
+     * @return The unique ComponentID assigned to the registered component type.
+     * @throws std::runtime_error under the same conditions as registerComponent() or if T is
+     * already registered as a non-sparse component.
+     */
+    template <typename T>
+    ComponentID registerSparseComponent(const std::string& name = typeid(T).name())
+    {
+        const bool wasRegistered = isRegistered<T>();
+        const ComponentID id = registerComponent<T>(name);
+
+        if (wasRegistered && !m_infos[id].sparse)
+        {
+            throw std::runtime_error("Component already registered as a non-sparse component!");
+        }
+
+        m_infos[id].sparse = true;
+        return id;
+    }
+
+    /**
+     * @brief Registers a component defined at runtime (e.g. by a script or a plugin) by its
+     * layout alone.
+     *
+     * Dynamic components live in the same archetype rows and chunks as native ones, they are
+     * accessed through the ComponentID-based API of EntityRegistry (createEntity(), addComponent(),
+     * getComponent(), forEachRawChunk(), ...). Their bytes must be trivially copyable: rows are
+     * moved with memcpy and never destroyed.
+     *
+     * @param _name The name of the component (snapshots match components by name).
+     * @param _size The size in bytes of one instance, 0 registers a tag.
+     * @param _alignment The alignment in bytes of one instance (a power of two).
+     * @return The unique ComponentID assigned to the component.
+     * @throws std::invalid_argument if the alignment is not a power of two.
+     * @throws std::runtime_error if the maximum number of components has been exceeded.
+     */
+    ComponentID registerDynamicComponent(const std::string& _name, size_t _size,
+                                         size_t _alignment)
+    {
+        if (!std::has_single_bit(_alignment))
+        {
+            throw std::invalid_argument("Component alignment must be a power of two!");
+        }
+
+        if (m_infos.size() >= m_maxComponents)
+        {
+            throw std::runtime_error("Exceeded maximum number of components!");
+        }
+
+        const ComponentID id = static_cast<ComponentID>(m_infos.size());
+        m_infos.push_back({_name, _size, _size == 0 ? 1 : _alignment});
+
+        return id;
+    }
+
     /**
      * @brief Retrieves the unique ComponentID for the registered component type T.
      *
@@ -90,9 +221,23 @@ class ComponentRegistry final
     template <typename T>
     [[nodiscard]] ComponentID getID() const
     {
-        auto it = m_typeToId.find(std::type_index(typeid(T)));
-        if (it == m_typeToId.end()) throw std::runtime_error("Component not registered!");
-        return it->second;
+        const ComponentID id = lookupID<T>();
+        if (id == k_invalidID) throw std::runtime_error("Component not registered!");
+        return id;
+    }
+
+    /**
+     * @brief Retrieves the ComponentID of T without validation.
+     *
+     * Meant for hot loops that already checked registration (e.g. via isRegistered<T>()).
+     *
+     * @tparam T The component type whose ID is to be retrieved (must be registered).
+     * @return The ComponentID of the registered component type T.
+     */
+    template <typename T>
+    [[nodiscard]] ComponentID getIDUnchecked() const noexcept
+    {
+        return m_slotToId[detail::componentTypeSlot<T>()];
     }
 
     /**
@@ -117,14 +262,26 @@ class ComponentRegistry final
     template <typename T>
     bool isRegistered() const
     {
-        return m_typeToId.find(std::type_index(typeid(T))) != m_typeToId.end();
+        return lookupID<T>() != k_invalidID;
     }
 
+    // Checks if the ID designates a registered component (native or dynamic).
+    [[nodiscard]] bool isRegistered(ComponentID _id) const noexcept { return _id < m_infos.size(); }
+
     // Returns the total number of registered component types.
     [[nodiscard]] size_t count() const { return m_infos.size(); }
 
     // Returns the maximum number of component types that can be registered.
     [[nodiscard]] size_t maxCount() const { return m_maxComponents; }
+
+   private:
+    // Returns the ComponentID of T, or k_invalidID if T is not registered in this registry.
+    template <typename T>
+    [[nodiscard]] ComponentID lookupID() const noexcept
+    {
+        const size_t slot = detail::componentTypeSlot<T>();
+        return slot < m_slotToId.size() ? m_slotToId[slot] : k_invalidID;
+    }
 };
 
 } // namespace ecs
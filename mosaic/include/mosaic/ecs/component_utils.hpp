@@ -1,7 +1,6 @@
 #pragma once
 
 #include <vector>
-#include <unordered_map>
 #include <algorithm>
 
 #include "entity.hpp"
@@ -51,7 +50,7 @@ template <typename... Ts>
  * @return The total stride size in bytes for the archetype.
  *
  * @note The stride includes the size of EntityMeta and accounts for alignment requirements of each
- * component.
+ * component. Tag and shared components do not contribute to it.
  */
 [[nodiscard]] inline size_t calculateStrideFromSignature(const ComponentRegistry* _registry,
                                                          const ComponentSignature& sig)
@@ -60,7 +59,7 @@ template <typename... Ts>
 
     for (size_t i = 0; i < _registry->count(); ++i)
     {
-        if (sig.testBit(i))
+        if (sig.testBit(i) && _registry->info(i).hasRowStorage())
         {
             const auto& info = _registry->info(i);
 
@@ -80,7 +79,7 @@ template <typename... Ts>
  * @param _signature The component signature defining the archetype.
  * @return A map of ComponentID to their respective byte offsets within the archetype's data rows.
  */
-[[nodiscard]] inline std::unordered_map<ComponentID, size_t>
+[[nodiscard]] inline ComponentOffsets
 getComponentOffsetsInBytesFromSignature(const ComponentRegistry* _registry,
                                         const ComponentSignature& _signature)
 {
@@ -88,12 +87,17 @@ getComponentOffsetsInBytesFromSignature(const ComponentRegistry* _registry,
 
     for (ComponentID id = 0; id < _registry->maxCount(); ++id)
     {
-        if (_signature.testBit(id)) idSizePairs.emplace_back(id, _registry->info(id).size);
+        // tags and shared components have no row storage, hence no offset entry
+        if (_signature.testBit(id) && _registry->info(id).hasRowStorage())
+        {
+            idSizePairs.emplace_back(id, _registry->info(id).size);
+        }
     }
 
     std::sort(idSizePairs.begin(), idSizePairs.end());
 
-    std::unordered_map<ComponentID, size_t> componentOffsets;
+    ComponentOffsets componentOffsets;
+    componentOffsets.reserve(idSizePairs.size());
     size_t currentOffset = sizeof(EntityMeta);
 
     for (const auto& [id, size] : idSizePairs)
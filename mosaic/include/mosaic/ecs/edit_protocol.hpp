@@ -0,0 +1,449 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "component_registry.hpp"
+#include "entity_registry.hpp"
+#include "command_buffer.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+/*
+ * Edit protocol messages (native endianness, the editor runs on the same host; packed, read with
+ * memcpy):
+ *
+ *   EditMessageHeader
+ *   schema:  EditSchemaComponent[count], each followed by its name
+ *   edits, changes:
+ *     for each command:
+ *       EditCommandHeader
+ *       setComponents, addComponent:     { EntityMeta, bytes[size] }[count]
+ *       removeComponent, destroyEntities: EntityMeta[count]
+ *
+ * The editor sends one edits message per frame, the engine answers with the changes message of
+ * the components written since the previous one (setComponents commands only). Edits and changes
+ * carry the hash of the schema they were encoded against, a message of another schema (or
+ * version) is rejected as a whole.
+ */
+
+inline constexpr uint32_t k_editProtocolMagic = 0x5444454D; // "MEDT"
+inline constexpr uint32_t k_editProtocolVersion = 1;
+
+enum class EditMessageKind : uint32_t
+{
+    schema = 1,  // engine → editor, the registered components
+    edits = 2,   // editor → engine
+    changes = 3, // engine → editor, the component data written since the previous changes
+};
+
+enum class EditOp : uint16_t
+{
+    setComponents = 1,
+    addComponent = 2,
+    removeComponent = 3,
+    destroyEntities = 4,
+};
+
+struct EditMessageHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    EditMessageKind kind;
+    uint32_t schemaHash;
+    uint64_t frame;
+    uint32_t count; // components (schema) or commands
+    uint32_t reserved;
+};
+
+struct EditSchemaComponent
+{
+    uint32_t id;
+    uint32_t size;
+    uint32_t alignment;
+    uint32_t shared;
+    uint32_t nameLength;
+};
+
+struct EditCommandHeader
+{
+    EditOp op;
+    uint16_t reserved;
+    uint32_t component; // unused by destroyEntities
+    uint32_t count;     // entities
+    uint32_t size;      // bytes of each value, 0 without values
+};
+
+// The other end decodes the packed layout, it must not move
+static_assert(sizeof(EditMessageHeader) == 32 && sizeof(EditCommandHeader) == 16 &&
+              sizeof(EditSchemaComponent) == 20 && sizeof(EntityMeta) == 8);
+
+namespace detail
+{
+
+// Reads a message in place, every read is bounds-checked.
+class EditReader final
+{
+   private:
+    std::span<const uint8_t> m_data;
+    size_t m_cursor = 0;
+
+   public:
+    explicit EditReader(std::span<const uint8_t> _data) : m_data(_data) {}
+
+   public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    [[nodiscard]] T get()
+    {
+        T value;
+        std::memcpy(&value, getBytes(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    [[nodiscard]] std::span<const uint8_t> getBytes(size_t _size)
+    {
+        if (_size > m_data.size() - m_cursor)
+        {
+            throw std::runtime_error("Edit message is truncated.");
+        }
+
+        const std::span<const uint8_t> bytes = m_data.subspan(m_cursor, _size);
+        m_cursor += _size;
+        return bytes;
+    }
+
+    [[nodiscard]] bool atEnd() const noexcept { return m_cursor == m_data.size(); }
+};
+
+// Reads the header of a message of the given kind and checks its version and schema.
+inline EditMessageHeader readEditHeader(EditReader& _reader, EditMessageKind _kind,
+                                        uint32_t _schemaHash)
+{
+    const auto header = _reader.get<EditMessageHeader>();
+
+    if (header.magic != k_editProtocolMagic || header.kind != _kind)
+    {
+        throw std::runtime_error("Not an edit message of the expected kind.");
+    }
+    if (header.version != k_editProtocolVersion)
+    {
+        throw std::runtime_error("Unsupported edit protocol version.");
+    }
+    if (header.schemaHash != _schemaHash)
+    {
+        throw std::runtime_error("Edit message was encoded against another component schema.");
+    }
+
+    return header;
+}
+
+} // namespace detail
+
+/**
+ * @brief Returns the hash (FNV-1a) of the layout of every registered component: names, sizes,
+ * alignments and order (the IDs). Both ends encode against it, so a registration made on one
+ * side only is caught before any byte is reinterpreted.
+ */
+[[nodiscard]] inline uint32_t editSchemaHash(const ComponentRegistry& _components)
+{
+    uint32_t hash = 2166136261u;
+    const auto mix = [&](const void* _data, size_t _size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(_data);
+        for (size_t i = 0; i < _size; ++i) hash = (hash ^ bytes[i]) * 16777619u;
+    };
+
+    for (ComponentID id = 0; id < _components.count(); ++id)
+    {
+        const ComponentMeta& info = _components.info(id);
+        const uint32_t layout[3] = {static_cast<uint32_t>(info.size),
+                                    static_cast<uint32_t>(info.alignment), info.shared};
+
+        mix(info.name.data(), info.name.size());
+        mix(layout, sizeof(layout));
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Appends one edits or changes message to a byte buffer, the command count of its header
+ * kept up to date with every command.
+ *
+ * Entities are addressed by EntityMeta: a command reaching the engine after its entity was
+ * destroyed is dropped instead of hitting the entity that took the ID.
+ */
+class EditMessageWriter final
+{
+   private:
+    std::vector<uint8_t>& m_out;
+    size_t m_header;
+    uint32_t m_count = 0;
+
+   public:
+    EditMessageWriter(std::vector<uint8_t>& _out, EditMessageKind _kind, uint32_t _schemaHash,
+                      uint64_t _frame)
+        : m_out(_out), m_header(_out.size())
+    {
+        put(EditMessageHeader{k_editProtocolMagic, k_editProtocolVersion, _kind, _schemaHash,
+                              _frame, 0, 0});
+    }
+
+   public:
+    /**
+     * @brief Writes the same component of several entities (a gizmo drag over a selection).
+     *
+     * @param _values _entities.size() values of _size bytes each, packed.
+     */
+    void setComponents(ComponentID _compID, std::span<const EntityMeta> _entities,
+                       const void* _values, size_t _size)
+    {
+        beginCommand(EditOp::setComponents, _compID, _entities.size(), _size);
+
+        const auto* values = static_cast<const uint8_t*>(_values);
+        for (size_t i = 0; i < _entities.size(); ++i)
+        {
+            put(_entities[i]);
+            putBytes(values + i * _size, _size);
+        }
+    }
+
+    void setComponent(EntityMeta _entity, ComponentID _compID, std::span<const uint8_t> _value)
+    {
+        setComponents(_compID, {&_entity, 1}, _value.data(), _value.size());
+    }
+
+    // Adds the component, copied from _value or zeroed when it is empty.
+    void addComponent(EntityMeta _entity, ComponentID _compID, std::span<const uint8_t> _value = {})
+    {
+        beginCommand(EditOp::addComponent, _compID, 1, _value.size());
+        put(_entity);
+        putBytes(_value.data(), _value.size());
+    }
+
+    void removeComponent(EntityMeta _entity, ComponentID _compID)
+    {
+        beginCommand(EditOp::removeComponent, _compID, 1, 0);
+        put(_entity);
+    }
+
+    void destroyEntities(std::span<const EntityMeta> _entities)
+    {
+        beginCommand(EditOp::destroyEntities, 0, _entities.size(), 0);
+        for (const EntityMeta& entity : _entities) put(entity);
+    }
+
+    [[nodiscard]] uint32_t commandCount() const noexcept { return m_count; }
+
+   private:
+    void beginCommand(EditOp _op, ComponentID _compID, size_t _count, size_t _size)
+    {
+        put(EditCommandHeader{_op, 0, static_cast<uint32_t>(_compID),
+                              static_cast<uint32_t>(_count), static_cast<uint32_t>(_size)});
+
+        ++m_count;
+        std::memcpy(m_out.data() + m_header + offsetof(EditMessageHeader, count), &m_count,
+                    sizeof(m_count));
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void put(const T& _value)
+    {
+        putBytes(&_value, sizeof(T));
+    }
+
+    void putBytes(const void* _data, size_t _size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(_data);
+        m_out.insert(m_out.end(), bytes, bytes + _size);
+    }
+};
+
+/**
+ * @brief Appends the schema message: every registered component (ID, layout, name), sent to the
+ * editor before any other message so it can decode component bytes and hash the same schema.
+ */
+inline void writeEditSchema(const ComponentRegistry& _components, std::vector<uint8_t>& _out)
+{
+    const EditMessageHeader header{k_editProtocolMagic,
+                                   k_editProtocolVersion,
+                                   EditMessageKind::schema,
+                                   editSchemaHash(_components),
+                                   0,
+                                   static_cast<uint32_t>(_components.count()),
+                                   0};
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&header);
+    _out.insert(_out.end(), bytes, bytes + sizeof(header));
+
+    for (ComponentID id = 0; id < _components.count(); ++id)
+    {
+        const ComponentMeta& info = _components.info(id);
+        const EditSchemaComponent component{
+            static_cast<uint32_t>(id), static_cast<uint32_t>(info.size),
+            static_cast<uint32_t>(info.alignment), info.shared,
+            static_cast<uint32_t>(info.name.size())};
+
+        bytes = reinterpret_cast<const uint8_t*>(&component);
+        _out.insert(_out.end(), bytes, bytes + sizeof(component));
+        _out.insert(_out.end(), info.name.begin(), info.name.end());
+    }
+}
+
+/**
+ * @brief Decodes an edits message and records its commands into a command buffer, played back
+ * at the next sync point like any other structural change.
+ *
+ * The whole message is validated before anything is recorded. Commands targeting entities that
+ * are not alive anymore (EntityMeta generation) are dropped. Values must have the registered size
+ * of their component; shared components are set with EntityRegistry::setSharedComponent(), never
+ * through edits. Writes are played back after the additions recorded before them, and stamped, so
+ * they come back in the next changes message (the editor's acknowledgment).
+ *
+ * @param _message The message.
+ * @param _registry The registry the commands are checked against.
+ * @param _components The component registry of _registry.
+ * @param _commands The command buffer to record into.
+ * @return The number of entity commands recorded.
+ * @throws std::runtime_error if the message is malformed, of another version or schema.
+ */
+inline size_t recordEditMessage(std::span<const uint8_t> _message, const EntityRegistry& _registry,
+                                const ComponentRegistry& _components,
+                                EntityCommandBuffer& _commands)
+{
+    const auto validate = [&](std::span<const uint8_t> _bytes, bool _record)
+    {
+        detail::EditReader reader(_bytes);
+        const EditMessageHeader header =
+            detail::readEditHeader(reader, EditMessageKind::edits, editSchemaHash(_components));
+
+        size_t recorded = 0;
+        for (uint32_t command = 0; command < header.count; ++command)
+        {
+            const auto commandHeader = reader.get<EditCommandHeader>();
+            const EditOp op = commandHeader.op;
+            const ComponentID id = commandHeader.component;
+
+            if (op < EditOp::setComponents || op > EditOp::destroyEntities)
+            {
+                throw std::runtime_error("Unknown edit command.");
+            }
+
+            if (op != EditOp::destroyEntities)
+            {
+                if (!_components.isRegistered(id) || _components.info(id).shared)
+                {
+                    throw std::runtime_error("Edit targets an unknown or shared component.");
+                }
+
+                const size_t size = _components.info(id).size;
+                const bool sized = op == EditOp::setComponents
+                                       ? commandHeader.size == size && size != 0
+                                       : commandHeader.size == size || commandHeader.size == 0;
+                if (!sized || (op == EditOp::removeComponent && commandHeader.size != 0))
+                {
+                    throw std::runtime_error("Edit value does not match its component size.");
+                }
+            }
+            else if (commandHeader.size != 0)
+            {
+                throw std::runtime_error("Edit value does not match its component size.");
+            }
+
+            for (uint32_t i = 0; i < commandHeader.count; ++i)
+            {
+                const auto entity = reader.get<EntityMeta>();
+                const std::span<const uint8_t> value = reader.getBytes(commandHeader.size);
+
+                if (!_record || !_registry.isEntityValid(entity)) continue;
+
+                switch (op)
+                {
+                    case EditOp::setComponents:
+                        _commands.setComponent(entity.id, id, value);
+                        break;
+                    case EditOp::addComponent:
+                        _commands.addComponent(entity.id, id, value);
+                        break;
+                    case EditOp::removeComponent:
+                        _commands.removeComponent(entity.id, id);
+                        break;
+                    case EditOp::destroyEntities:
+                        _commands.destroyEntity(entity.id);
+                        break;
+                }
+                ++recorded;
+            }
+        }
+
+        if (!reader.atEnd()) throw std::runtime_error("Edit message has trailing bytes.");
+
+        return recorded;
+    };
+
+    (void)validate(_message, false);
+
+    return validate(_message, true);
+}
+
+/**
+ * @brief Appends the changes message of the given components: one setComponents command per tick
+ * block where a component was written or added after tick _since.
+ *
+ * Blocks are sent whole (a chunk or Archetype::k_tickBlockRows rows), so a few untouched rows
+ * ride along with the written ones; tags have no bytes and are skipped. The engine typically calls
+ * it after the frame's systems with the tick returned by its previous advanceTick().
+ *
+ * @return The number of component values written.
+ * @throws std::runtime_error if one or more components are not registered.
+ */
+inline size_t writeEditChanges(const EntityRegistry& _registry,
+                               const ComponentRegistry& _components,
+                               std::span<const ComponentID> _watched, uint32_t _since,
+                               uint64_t _frame, std::vector<uint8_t>& _out)
+{
+    EditMessageWriter writer(_out, EditMessageKind::changes, editSchemaHash(_components), _frame);
+    std::vector<EntityMeta> entities;
+    std::vector<uint8_t> values;
+    size_t written = 0;
+
+    for (ComponentID id : _watched)
+    {
+        const size_t size = _components.isRegistered(id) ? _components.info(id).size : 0;
+
+        _registry.forEachChangedRawBlock(
+            id, _since,
+            [&](size_t _count, RawColumn _metas, RawColumn _column)
+            {
+                if (!_column.data) return;
+
+                entities.resize(_count);
+                values.resize(_count * size);
+                for (size_t i = 0; i < _count; ++i)
+                {
+                    std::memcpy(&entities[i], _metas[i], sizeof(EntityMeta));
+                    std::memcpy(values.data() + i * size, _column[i], size);
+                }
+
+                writer.setComponents(id, entities, values.data(), size);
+                written += _count;
+            });
+    }
+
+    return written;
+}
+
+} // namespace ecs
+} // namespace mosaic
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <span>
 #include <vector>
 
 #include "entity.hpp"
@@ -9,37 +14,220 @@ namespace mosaic
 namespace ecs
 {
 
+/**
+ * @brief Dense, ID-indexed record of an entity: its generation and where its data lives.
+ *
+ * The archetype is referenced by its index in the owning registry's archetype table and the row
+ * is the dense index inside that archetype, so resolving a handle costs a single array access.
+ */
+struct EntityRecord
+{
+    static constexpr uint32_t k_invalidArchetype = std::numeric_limits<uint32_t>::max();
+    // Archetype of an ID handed out by a reservation but not created yet.
+    static constexpr uint32_t k_reservedArchetype = k_invalidArchetype - 1;
+
+    EntityGen gen = 0;
+    uint32_t archetype = k_invalidArchetype;
+    uint32_t row = 0;
+
+    // Returns whether the record points to a live entity.
+    [[nodiscard]] bool isAlive() const noexcept { return archetype < k_reservedArchetype; }
+
+    // Returns whether the ID is reserved and waiting to be created.
+    [[nodiscard]] bool isReserved() const noexcept { return archetype == k_reservedArchetype; }
+};
+
 /**
  * @brief Helper class for allocating and freeing entity metadata (IDs and generations).
+ *
+ * Alongside generations it keeps the location of every live entity, which the registry updates on
+ * every structural change.
+ *
+ * IDs can also be reserved from any thread without locking: a single atomic cursor walks the free
+ * list downwards, and once it goes negative it hands out fresh IDs past m_next (so the free list
+ * and the record table are only read while reserving). The owning thread folds the reservations
+ * into its bookkeeping with commitReservations(), which every other mutating call does first.
+ * Reservation may run concurrently with other reservations and const accesses only.
  */
 class EntityAllocationHelper
 {
    private:
     EntityID m_next = 0;
     std::vector<EntityID> m_freeList;
-    std::vector<EntityGen> m_generations;
+    std::vector<EntityRecord> m_records;
+
+    // Equal to m_freeList.size() when no reservation is pending
+    mutable std::atomic<int64_t> m_reserveCursor = 0;
+    size_t m_reservedCount = 0; // committed reservations not created nor released yet
+
+   public:
+    EntityAllocationHelper() = default;
+
+    EntityAllocationHelper(EntityAllocationHelper&& _other) noexcept
+        : m_next(_other.m_next), m_freeList(std::move(_other.m_freeList)),
+          m_records(std::move(_other.m_records)),
+          m_reserveCursor(_other.m_reserveCursor.load(std::memory_order_relaxed)),
+          m_reservedCount(_other.m_reservedCount)
+    {
+        _other.reset();
+    }
+
+    EntityAllocationHelper& operator=(EntityAllocationHelper&& _other) noexcept
+    {
+        if (this != &_other)
+        {
+            m_next = _other.m_next;
+            m_freeList = std::move(_other.m_freeList);
+            m_records = std::move(_other.m_records);
+            m_reserveCursor.store(_other.m_reserveCursor.load(std::memory_order_relaxed),
+                                  std::memory_order_relaxed);
+            m_reservedCount = _other.m_reservedCount;
+            _other.reset();
+        }
+        return *this;
+    }
 
    public:
     [[nodiscard]] EntityMeta getID()
     {
+        commitReservations();
+
         if (!m_freeList.empty())
         {
             EntityID id = m_freeList.back();
             m_freeList.pop_back();
 
-            ++m_generations[id];
+            ++m_records[id].gen;
+            syncReserveCursor();
 
-            return {id, m_generations[id]};
+            return {id, m_records[id].gen};
         }
 
         EntityID id = m_next++;
 
-        if (id >= m_generations.size()) m_generations.push_back(0);
+        if (id >= m_records.size()) m_records.emplace_back();
+
+        return {id, m_records[id].gen};
+    }
+
+    void freeID(EntityID _id)
+    {
+        commitReservations();
+
+        EntityRecord& record = m_records[_id];
+        if (record.isReserved()) --m_reservedCount;
+
+        record.archetype = EntityRecord::k_invalidArchetype;
+        m_freeList.push_back(_id);
+        syncReserveCursor();
+    }
+
+    /**
+     * @brief Reserves entity IDs, thread-safe with respect to other reservations.
+     *
+     * Recycled IDs are handed out first with the generation they will have once reused. The
+     * reserved IDs are not alive until claimReservedID() is called for them.
+     *
+     * @param _out Receives one reserved handle per element.
+     * @note Must not run concurrently with any non-const member except other reservations.
+     */
+    void reserveIDs(std::span<EntityMeta> _out) const noexcept
+    {
+        const int64_t count = static_cast<int64_t>(_out.size());
+        if (count == 0) return;
+
+        // Only atomicity matters here, publication to the owning thread goes through its sync point
+        const int64_t last = m_reserveCursor.fetch_sub(count, std::memory_order_relaxed);
+
+        for (int64_t i = 0; i < count; ++i)
+        {
+            const int64_t slot = last - 1 - i;
+
+            if (slot >= 0)
+            {
+                const EntityID id = m_freeList[static_cast<size_t>(slot)];
+                _out[static_cast<size_t>(i)] = {id, m_records[id].gen + 1};
+            }
+            else
+            {
+                const EntityID id = m_next + static_cast<EntityID>(-slot - 1);
+                _out[static_cast<size_t>(i)] = {id, id < m_records.size() ? m_records[id].gen : 0};
+            }
+        }
+    }
+
+    /**
+     * @brief Folds the pending reservations into the free list and records, reserved IDs are
+     * flagged as such until claimed or released.
+     */
+    void commitReservations()
+    {
+        const int64_t cursor = m_reserveCursor.load(std::memory_order_relaxed);
+        const int64_t freeCount = static_cast<int64_t>(m_freeList.size());
+        if (cursor == freeCount) return;
+
+        const size_t keptFree = static_cast<size_t>(std::max<int64_t>(cursor, 0));
+        for (size_t i = keptFree; i < m_freeList.size(); ++i)
+        {
+            EntityRecord& record = m_records[m_freeList[i]];
+            ++record.gen;
+            record.archetype = EntityRecord::k_reservedArchetype;
+        }
+        m_reservedCount += m_freeList.size() - keptFree;
+        m_freeList.resize(keptFree);
+
+        if (cursor < 0)
+        {
+            const EntityID freshCount = static_cast<EntityID>(-cursor);
+            m_next += freshCount;
+            if (m_records.size() < m_next) m_records.resize(m_next);
+
+            for (EntityID id = m_next - freshCount; id < m_next; ++id)
+            {
+                m_records[id].archetype = EntityRecord::k_reservedArchetype;
+            }
+            m_reservedCount += freshCount;
+        }
+
+        syncReserveCursor();
+    }
+
+    /**
+     * @brief Turns a reserved handle into an allocated one, whose location must then be set.
+     *
+     * @return false if the handle is not a pending reservation (already claimed, released,
+     * stale or never reserved).
+     */
+    [[nodiscard]] bool claimReservedID(EntityMeta _meta)
+    {
+        commitReservations();
+
+        if (_meta.id >= m_records.size()) return false;
 
-        return {id, m_generations[id]};
+        const EntityRecord& record = m_records[_meta.id];
+        if (!record.isReserved() || record.gen != _meta.gen) return false;
+
+        --m_reservedCount;
+        return true;
     }
 
-    void freeID(EntityID _id) { m_freeList.push_back(_id); }
+    /**
+     * @brief Returns an unused reserved handle to the free list.
+     *
+     * @return false if the handle is not a pending reservation.
+     */
+    bool releaseReservedID(EntityMeta _meta)
+    {
+        commitReservations();
+
+        if (_meta.id >= m_records.size()) return false;
+
+        const EntityRecord& record = m_records[_meta.id];
+        if (!record.isReserved() || record.gen != _meta.gen) return false;
+
+        freeID(_meta.id);
+        return true;
+    }
 
     /**
      * @brief Allocates multiple entity IDs at once.
@@ -67,10 +255,12 @@ class EntityAllocationHelper
      */
     void freeIDBulk(const std::vector<EntityID>& _ids)
     {
+        commitReservations();
+
         m_freeList.reserve(m_freeList.size() + _ids.size());
         for (EntityID id : _ids)
         {
-            m_freeList.push_back(id);
+            freeID(id);
         }
     }
 
@@ -78,10 +268,97 @@ class EntityAllocationHelper
     {
         m_next = 0;
         m_freeList.clear();
-        m_generations.clear();
+        m_records.clear();
+        m_reserveCursor.store(0, std::memory_order_relaxed);
+        m_reservedCount = 0;
+    }
+
+    [[nodiscard]] EntityGen getGenForID(EntityID _eid) const { return m_records[_eid].gen; }
+
+    // Returns the number of entity IDs ever allocated (alive, free or reserved).
+    [[nodiscard]] size_t recordCount() const noexcept { return m_records.size(); }
+
+    /**
+     * @brief Replaces the whole state with dead records of the given generations, the locations of
+     * the loaded entities are then set and rebuildFreeList() is called.
+     */
+    void restoreGenerations(std::span<const EntityGen> _gens)
+    {
+        reset();
+
+        m_records.resize(_gens.size());
+        for (size_t id = 0; id < _gens.size(); ++id) m_records[id].gen = _gens[id];
+
+        m_next = static_cast<EntityID>(_gens.size());
+    }
+
+    // Puts every ID that is not alive in the free list, lowest IDs are reused first.
+    void rebuildFreeList()
+    {
+        commitReservations();
+
+        m_freeList.clear();
+        m_reservedCount = 0;
+
+        for (EntityID id = m_next; id-- > 0;)
+        {
+            if (!m_records[id].isAlive())
+            {
+                m_records[id].archetype = EntityRecord::k_invalidArchetype;
+                m_freeList.push_back(id);
+            }
+        }
+
+        syncReserveCursor();
+    }
+
+    /**
+     * @brief Retrieves the record of the given entity ID.
+     *
+     * @param _eid The entity ID.
+     * @return A pointer to the record, or nullptr if the ID was never allocated or is not alive.
+     */
+    [[nodiscard]] EntityRecord* findRecord(EntityID _eid) noexcept
+    {
+        if (_eid >= m_records.size() || !m_records[_eid].isAlive()) return nullptr;
+        return &m_records[_eid];
+    }
+
+    [[nodiscard]] const EntityRecord* findRecord(EntityID _eid) const noexcept
+    {
+        if (_eid >= m_records.size() || !m_records[_eid].isAlive()) return nullptr;
+        return &m_records[_eid];
     }
 
-    [[nodiscard]] EntityGen getGenForID(EntityID _eid) const { return m_generations[_eid]; }
+    // Updates the location of an allocated entity ID (the generation is left untouched).
+    void setLocation(EntityID _eid, uint32_t _archetype, uint32_t _row) noexcept
+    {
+        m_records[_eid].archetype = _archetype;
+        m_records[_eid].row = _row;
+    }
+
+    // Updates the row of an allocated entity ID inside its current archetype.
+    void setRow(EntityID _eid, uint32_t _row) noexcept { m_records[_eid].row = _row; }
+
+    // Returns the number of allocated (live) entity IDs, pending reservations excluded.
+    [[nodiscard]] size_t aliveCount() const noexcept
+    {
+        return m_next - m_freeList.size() - m_reservedCount;
+    }
+
+    // Returns the number of reserved IDs waiting to be claimed or released (committed or not).
+    [[nodiscard]] size_t reservedCount() const noexcept
+    {
+        const int64_t pending = static_cast<int64_t>(m_freeList.size()) -
+                                m_reserveCursor.load(std::memory_order_relaxed);
+        return m_reservedCount + static_cast<size_t>(pending);
+    }
+
+   private:
+    void syncReserveCursor() noexcept
+    {
+        m_reserveCursor.store(static_cast<int64_t>(m_freeList.size()), std::memory_order_relaxed);
+    }
 };
 
 } // namespace ecs
@@ -1,7 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "entity.hpp"
@@ -10,13 +17,30 @@
 #include "component_registry.hpp"
 #include "component_utils.hpp"
 #include "entity_view.hpp"
+#include "query.hpp"
+#include "observer.hpp"
+#include "relation.hpp"
+#include "sparse_storage.hpp"
+#include "static_archetype.hpp"
 #include "entity_allocation_helper.hpp"
+#include "shared_value_table.hpp"
+#include "snapshot_format.hpp"
 
 namespace mosaic
 {
 namespace ecs
 {
 
+/**
+ * @brief Outcome of a call to EntityRegistry::compact().
+ */
+struct CompactionResult
+{
+    size_t bytesReclaimed = 0;    // decrease of totalMemoryUsageInBytes() caused by the call
+    size_t archetypesRemoved = 0; // number of empty archetypes destroyed
+    bool finished = false;        // whether the call completed a pass over every archetype
+};
+
 /**
  * @brief The 'EntityRegistry' class manages the lifecycle of entities and their associated
  components within an ECS architecture.
@@ -33,22 +57,69 @@ namespace ecs
  */
 class EntityRegistry final
 {
+   public:
+    // Parallel bulk operations run smaller batches on the calling thread.
+    static constexpr size_t k_parallelBulkMinEntities = 50'000;
+    // The number of rows processed by a single task of a parallel bulk operation.
+    static constexpr size_t k_parallelBulkGrainSize = 16'384;
+
    private:
     using Byte = uint8_t;
 
-    std::unordered_map<ComponentSignature, std::unique_ptr<Archetype>> m_archetypes;
-    std::unordered_map<EntityID, Archetype*> m_entityToArchetype;
+    // A row order kept by groupBy(), restored by updateGroups().
+    struct SortGroup
+    {
+        ComponentID component;
+        uint32_t sortedTick; // rows written at this tick or later may be out of order
+        std::function<void(EntityRegistry&, Archetype*, std::optional<uint32_t>)> sort;
+    };
+
+    pieces::FlatHashMap<ArchetypeKey, std::unique_ptr<Archetype>> m_archetypes;
+    std::vector<Archetype*> m_archetypeTable; // indexed by EntityRecord::archetype
+    pieces::FlatHashMap<detail::QueryKey, std::unique_ptr<detail::QueryState>> m_queries;
     const ComponentRegistry* m_componentRegistry;
     EntityAllocationHelper m_EntityAllocationHelper;
+    ArchetypeStorageMode m_storageMode;
+    size_t m_splitThresholdInBytes; // adaptive mode only
+    ChunkArena* m_chunkArena;       // chunk allocations of chunked archetypes (null = global heap)
+    StorageAllocator* m_storageAllocator; // rows of interleaved archetypes (null = global heap)
+    uint32_t m_tick = 1; // world tick stamped on writes, 0 is reserved for "never"
+    size_t m_compactionCursor = 0; // next archetype table slot visited by compact()
+    std::unordered_map<ComponentID, SharedValueTable> m_sharedValueTables;
+    std::vector<std::optional<TypelessVector>> m_singletons; // by detail::componentTypeSlot<T>()
+    std::vector<SortGroup> m_sortGroups;                     // in registration order
+    detail::ObserverTable m_observers;
+    detail::RelationTable m_relations;
+    detail::SparseStorage m_sparseStorage; // values of the sparse components
+    pieces::FlatHashMap<ComponentSignature, detail::StaticRowLayout> m_staticLayouts; // by sig
 
    public:
     /**
      * @brief Constructs an EntityRegistry with the given component registry.
      *
      * @param _componentRegistry The component registry for component type information.
+     * @param _storageMode The storage mode used by every archetype created by this registry
+     * (default is interleaved rows, chunked columns are preferable for wide archetypes, adaptive
+     * keeps small archetypes interleaved and moves the ones that outgrow the split threshold to
+     * chunks).
+     * @param _splitThresholdInBytes The size of the rows of an archetype past which it is moved
+     * to chunks (adaptive mode only).
+     * @param _chunkArena The arena the chunks of chunked archetypes are allocated from, or
+     * nullptr for the global heap (it must outlive the registry, see World).
+     * @param _storageAllocator The allocator the rows of interleaved archetypes come from, or
+     * nullptr for the zero-filled global heap (it must outlive the registry). Back the arena with
+     * the same allocator to place every archetype in it (see PageStorageAllocator).
      */
-    EntityRegistry(const ComponentRegistry* _componentRegistry)
-        : m_componentRegistry(_componentRegistry) {};
+    EntityRegistry(const ComponentRegistry* _componentRegistry,
+                   ArchetypeStorageMode _storageMode = ArchetypeStorageMode::interleaved,
+                   size_t _splitThresholdInBytes = Archetype::k_defaultSplitThresholdInBytes,
+                   ChunkArena* _chunkArena = nullptr, StorageAllocator* _storageAllocator = nullptr)
+        : m_componentRegistry(_componentRegistry),
+          m_storageMode(_storageMode),
+          m_splitThresholdInBytes(_splitThresholdInBytes),
+          m_chunkArena(_chunkArena),
+          m_storageAllocator(_storageAllocator),
+          m_observers(_componentRegistry->maxCount()) {};
 
    public:
     ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -73,20 +144,19 @@ class EntityRegistry final
         auto sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
         auto stride = calculateStrideFromSignature(m_componentRegistry, sig);
 
-        EntityMeta meta = m_EntityAllocationHelper.getID();
+        // resolved before allocating the ID as archetype creation may throw
         Archetype* arch = getOrCreateArchetype(sig, stride);
+        EntityMeta meta = m_EntityAllocationHelper.getID();
 
-        auto componentOffsets = getComponentOffsetsInBytesFromSignature(m_componentRegistry, sig);
-
-        std::vector<Byte> row(stride);
-        Byte* rowPtr = row.data();
+        // Construct straight into the reserved row (no temporary row nor copy)
+        const size_t row = arch->emplaceUninitialized(meta.id);
 
-        new (rowPtr) EntityMeta{meta};
+        new (arch->metaAt(row)) EntityMeta{meta};
 
-        ((new (rowPtr + componentOffsets[m_componentRegistry->getID<Ts>()]) Ts()), ...);
+        (constructComponent<Ts>(arch, row), ...);
 
-        arch->insert(meta.id, rowPtr);
-        m_entityToArchetype[meta.id] = arch;
+        placeEntity(meta.id, arch, row);
+        m_observers.notify(ComponentEvent::added, sig, {&meta.id, 1});
 
         return meta;
     }
@@ -113,30 +183,20 @@ class EntityRegistry final
         auto sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
         auto stride = calculateStrideFromSignature(m_componentRegistry, sig);
 
-        EntityMeta meta = m_EntityAllocationHelper.getID();
+        // resolved before allocating the ID as archetype creation may throw
         Archetype* arch = getOrCreateArchetype(sig, stride);
+        EntityMeta meta = m_EntityAllocationHelper.getID();
 
-        auto componentOffsets = getComponentOffsetsInBytesFromSignature(m_componentRegistry, sig);
-
-        std::vector<Byte> row(stride);
-        Byte* rowPtr = row.data();
+        // Construct straight into the reserved row (no temporary row nor copy)
+        const size_t row = arch->emplaceUninitialized(meta.id);
 
-        new (rowPtr) EntityMeta{meta};
+        new (arch->metaAt(row)) EntityMeta{meta};
 
         // Construct each component with its args via tuple unpacking
-        size_t idx = 0;
-        (
-            [&]<typename T, typename ArgTuple>(ArgTuple&& argTuple)
-            {
-                auto offset = componentOffsets[m_componentRegistry->getID<T>()];
-                std::apply([&](auto&&... args)
-                           { new (rowPtr + offset) T(std::forward<decltype(args)>(args)...); },
-                           std::forward<ArgTuple>(argTuple));
-            }.template operator()<Ts>(std::forward<ArgTuples>(_argTuples)),
-            ...);
+        (constructComponent<Ts>(arch, row, std::forward<ArgTuples>(_argTuples)), ...);
 
-        arch->insert(meta.id, rowPtr);
-        m_entityToArchetype[meta.id] = arch;
+        placeEntity(meta.id, arch, row);
+        m_observers.notify(ComponentEvent::added, sig, {&meta.id, 1});
 
         return meta;
     }
@@ -149,13 +209,22 @@ class EntityRegistry final
      */
     void destroyEntity(EntityID _eid)
     {
-        if (m_entityToArchetype.find(_eid) == m_entityToArchetype.end()) return;
+        // pairs must be dropped and cascades followed, which the bulk path does in one batch
+        if (!m_relations.empty())
+        {
+            destroyEntityBulk({_eid});
+            return;
+        }
+
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return;
 
-        Archetype* arch = m_entityToArchetype.at(_eid);
+        Archetype* arch = m_archetypeTable[record->archetype];
+        m_observers.notify(ComponentEvent::removed, arch->signature(), {&_eid, 1});
 
-        arch->remove(_eid);
-        m_entityToArchetype.erase(_eid);
+        eraseRow(arch, _eid, record->row);
         m_EntityAllocationHelper.freeID(_eid);
+        if (!m_sparseStorage.empty()) m_sparseStorage.erase(_eid);
     }
 
     /**
@@ -185,60 +254,34 @@ class EntityRegistry final
             throw std::runtime_error("One or more components are not registered.");
         }
 
-        auto mapIt = m_entityToArchetype.find(_eid);
-        if (mapIt == m_entityToArchetype.end()) return; // entity not found (no-op)
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return; // entity not found (no-op)
 
-        Archetype* oldArch = mapIt->second;
-        Byte* oldRowPtr = oldArch->get(_eid);
-        if (!oldRowPtr) return; // defensive
+        Archetype* oldArch = m_archetypeTable[record->archetype];
+        const size_t oldRow = record->row;
 
-        ComponentSignature oldSig = oldArch->signature();
-
-        // compute destination signature
-        ComponentSignature newSig = oldSig;
-        (newSig.setBit(m_componentRegistry->getID<AddComponents>()), ...);
-        (newSig.clearBit(m_componentRegistry->getID<RemoveComponents>()), ...);
+        // follow the cached transition (no signature rebuild once the edge is linked)
+        const ArchetypeEdge& edge = resolveEdge(oldArch, detail::Add<AddComponents...>{},
+                                                detail::Remove<RemoveComponents...>{});
 
         // no-op if signature unchanged
-        if (oldSig == newSig) return;
-
-        size_t newStride = calculateStrideFromSignature(m_componentRegistry, newSig);
-        Archetype* newArch = getOrCreateArchetype(newSig, newStride);
+        Archetype* newArch = edge.target;
+        if (newArch == oldArch) return;
 
-        if (newArch == oldArch) return; // safety (shouldn't happen, but cheap guard)
+        notifyDifference(ComponentEvent::removed, oldArch, newArch, {&_eid, 1});
 
-        std::vector<Byte> newRow(newStride);
-        Byte* newRowPtr = newRow.data();
-
-        // copy EntityMeta
-        EntityMeta meta = *reinterpret_cast<EntityMeta*>(oldRowPtr);
-        new (newRowPtr) EntityMeta{meta};
-
-        // copy surviving components from old row to the corresponding new offsets
-        auto oldOffsets = oldArch->componentOffsets(); // map<CompID, offset>
-        auto newOffsets = newArch->componentOffsets(); // map<CompID, offset>
-
-        for (const auto& [compID, srcOffset] : oldOffsets)
-        {
-            auto destIt = newOffsets.find(compID);
-            if (destIt == newOffsets.end()) continue; // component removed
-            size_t compSize = m_componentRegistry->info(compID).size;
-            std::memcpy(newRowPtr + destIt->second, oldRowPtr + srcOffset, compSize);
-        }
+        // copy EntityMeta and surviving components straight into the destination row
+        const size_t row = oldArch->moveAlong(_eid, edge);
+        patchSwappedRow(oldArch, oldRow);
+        placeEntity(_eid, newArch, row);
 
         // default-construct newly added components (if any)
         if constexpr (sizeof...(AddComponents) > 0)
         {
-            ((new (newRowPtr + newOffsets[m_componentRegistry->getID<AddComponents>()])
-                  AddComponents()),
-             ...);
+            (constructComponent<AddComponents>(newArch, row), ...);
         }
 
-        // perform the migration: insert into destination archetype, remove from source, update
-        // mapping
-        newArch->insert(meta.id, newRowPtr);
-        oldArch->remove(meta.id);
-        m_entityToArchetype[meta.id] = newArch;
+        notifyDifference(ComponentEvent::added, newArch, oldArch, {&_eid, 1});
     }
 
     /**
@@ -299,67 +342,36 @@ class EntityRegistry final
             throw std::runtime_error("One or more components are not registered.");
         }
 
-        auto mapIt = m_entityToArchetype.find(_eid);
-        if (mapIt == m_entityToArchetype.end()) return; // entity not found (no-op)
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return; // entity not found (no-op)
 
-        Archetype* oldArch = mapIt->second;
-        Byte* oldRowPtr = oldArch->get(_eid);
-        if (!oldRowPtr) return; // defensive
+        Archetype* oldArch = m_archetypeTable[record->archetype];
+        const size_t oldRow = record->row;
 
-        ComponentSignature oldSig = oldArch->signature();
-
-        // compute destination signature
-        ComponentSignature newSig = oldSig;
-        (newSig.setBit(m_componentRegistry->getID<AddComponents>()), ...);
-        (newSig.clearBit(m_componentRegistry->getID<RemoveComponents>()), ...);
+        // follow the cached transition (no signature rebuild once the edge is linked)
+        const ArchetypeEdge& edge = resolveEdge(oldArch, detail::Add<AddComponents...>{},
+                                                detail::Remove<RemoveComponents...>{});
 
         // no-op if signature unchanged
-        if (oldSig == newSig) return;
-
-        size_t newStride = calculateStrideFromSignature(m_componentRegistry, newSig);
-        Archetype* newArch = getOrCreateArchetype(newSig, newStride);
+        Archetype* newArch = edge.target;
+        if (newArch == oldArch) return;
 
-        if (newArch == oldArch) return; // safety (shouldn't happen, but cheap guard)
+        notifyDifference(ComponentEvent::removed, oldArch, newArch, {&_eid, 1});
 
-        std::vector<Byte> newRow(newStride);
-        Byte* newRowPtr = newRow.data();
-
-        // copy EntityMeta
-        EntityMeta meta = *reinterpret_cast<EntityMeta*>(oldRowPtr);
-        new (newRowPtr) EntityMeta{meta};
-
-        // copy surviving components from old row to the corresponding new offsets
-        auto oldOffsets = oldArch->componentOffsets(); // map<CompID, offset>
-        auto newOffsets = newArch->componentOffsets(); // map<CompID, offset>
-
-        for (const auto& [compID, srcOffset] : oldOffsets)
-        {
-            auto destIt = newOffsets.find(compID);
-            if (destIt == newOffsets.end()) continue; // component removed
-            size_t compSize = m_componentRegistry->info(compID).size;
-            std::memcpy(newRowPtr + destIt->second, oldRowPtr + srcOffset, compSize);
-        }
+        // copy EntityMeta and surviving components straight into the destination row
+        const size_t row = oldArch->moveAlong(_eid, edge);
+        patchSwappedRow(oldArch, oldRow);
+        placeEntity(_eid, newArch, row);
 
         // construct newly added components with args (if any)
         if constexpr (sizeof...(AddComponents) > 0)
         {
-            (
-                [&]<typename T, typename ArgTuple>(ArgTuple&& argTuple)
-                {
-                    auto offset = newOffsets[m_componentRegistry->getID<T>()];
-                    std::apply(
-                        [&](auto&&... args)
-                        { new (newRowPtr + offset) T(std::forward<decltype(args)>(args)...); },
-                        std::forward<ArgTuple>(argTuple));
-                }.template operator()<AddComponents>(std::forward<ArgTuples>(_argTuples)),
-                ...);
+            (constructComponent<AddComponents>(newArch, row,
+                                               std::forward<ArgTuples>(_argTuples)),
+             ...);
         }
 
-        // perform the migration: insert into destination archetype, remove from source, update
-        // mapping
-        newArch->insert(meta.id, newRowPtr);
-        oldArch->remove(meta.id);
-        m_entityToArchetype[meta.id] = newArch;
+        notifyDifference(ComponentEvent::added, newArch, oldArch, {&_eid, 1});
     }
 
     /**
@@ -398,50 +410,28 @@ class EntityRegistry final
     template <Component... Ts>
     std::vector<EntityMeta> createEntityBulk(size_t _count)
     {
-        if (_count == 0) return {};
-
-        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
-        {
-            throw std::runtime_error("One or more components are not registered.");
-        }
-
-        auto sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
-        auto stride = calculateStrideFromSignature(m_componentRegistry, sig);
-        auto componentOffsets = getComponentOffsetsInBytesFromSignature(m_componentRegistry, sig);
-
-        // Allocate all entity IDs upfront
-        std::vector<EntityMeta> metas = m_EntityAllocationHelper.getIDBulk(_count);
-
-        // Get or create archetype
-        Archetype* arch = getOrCreateArchetype(sig, stride);
-
-        // Extract just the IDs for bulk insert
-        std::vector<EntityID> eids;
-        eids.reserve(_count);
-        for (const auto& meta : metas)
-        {
-            eids.push_back(meta.id);
-        }
-
-        // Allocate uninitialized storage for all entities
-        Byte* dstBase = arch->insertBulkUninitialized(eids.data(), _count);
-
-        // Initialize each entity's data
-        for (size_t i = 0; i < _count; ++i)
-        {
-            Byte* rowPtr = dstBase + i * stride;
-
-            // Initialize EntityMeta
-            new (rowPtr) EntityMeta{metas[i]};
-
-            // Default-initialize all components
-            ((new (rowPtr + componentOffsets[m_componentRegistry->getID<Ts>()]) Ts()), ...);
-
-            // Update entity-to-archetype mapping
-            m_entityToArchetype[metas[i].id] = arch;
-        }
+        return createEntitiesInRanges<Ts...>(_count, InlineRowRanges{},
+                                             [this](Archetype* _arch, size_t _row)
+                                             { (constructComponent<Ts>(_arch, _row), ...); });
+    }
 
-        return metas;
+    /**
+     * @brief Parallel version of createEntityBulk(): the rows are reserved once, then the
+     * components are constructed and the entity locations recorded by ranges of
+     * k_parallelBulkGrainSize entities dispatched to the pool. Batches smaller than
+     * k_parallelBulkMinEntities are created on the calling thread.
+     *
+     * IDs are still allocated and observers notified on the calling thread, the result is the
+     * same as the one of createEntityBulk().
+     *
+     * @tparam Pool An executor such as exec::ThreadPool.
+     */
+    template <Component... Ts, detail::TaskPool Pool>
+    std::vector<EntityMeta> createEntityBulk(Pool& _pool, size_t _count)
+    {
+        return createEntitiesInRanges<Ts...>(_count, poolRowRanges(_pool),
+                                             [this](Archetype* _arch, size_t _row)
+                                             { (constructComponent<Ts>(_arch, _row), ...); });
     }
 
     /**
@@ -462,112 +452,59 @@ class EntityRegistry final
         requires(sizeof...(Ts) == sizeof...(ArgTuples))
     std::vector<EntityMeta> createEntityBulk(size_t _count, ArgTuples&&... _argTuples)
     {
-        if (_count == 0) return {};
-
-        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
-        {
-            throw std::runtime_error("One or more components are not registered.");
-        }
-
-        auto sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
-        auto stride = calculateStrideFromSignature(m_componentRegistry, sig);
-        auto componentOffsets = getComponentOffsetsInBytesFromSignature(m_componentRegistry, sig);
-
-        // Allocate all entity IDs upfront
-        std::vector<EntityMeta> metas = m_EntityAllocationHelper.getIDBulk(_count);
-
-        // Get or create archetype
-        Archetype* arch = getOrCreateArchetype(sig, stride);
-
-        // Extract just the IDs for bulk insert
-        std::vector<EntityID> eids;
-        eids.reserve(_count);
-        for (const auto& meta : metas)
-        {
-            eids.push_back(meta.id);
-        }
-
-        // Allocate uninitialized storage for all entities
-        Byte* dstBase = arch->insertBulkUninitialized(eids.data(), _count);
-
-        // Initialize each entity's data with the SAME constructor arguments
-        for (size_t i = 0; i < _count; ++i)
-        {
-            Byte* rowPtr = dstBase + i * stride;
-
-            // Initialize EntityMeta
-            new (rowPtr) EntityMeta{metas[i]};
-
-            // Construct each component with its args via tuple unpacking (same args for all)
-            (
-                [&]<typename T, typename ArgTuple>(ArgTuple&& argTuple)
-                {
-                    auto offset = componentOffsets[m_componentRegistry->getID<T>()];
-                    std::apply([&](auto&&... args)
-                               { new (rowPtr + offset) T(std::forward<decltype(args)>(args)...); },
-                               std::forward<ArgTuple>(argTuple));
-                }.template operator()<Ts>(_argTuples),
-                ...);
-
-            // Update entity-to-archetype mapping
-            m_entityToArchetype[metas[i].id] = arch;
-        }
+        // the SAME constructor arguments for every entity, hence never forwarded
+        return createEntitiesInRanges<Ts...>(
+            _count, InlineRowRanges{}, [&](Archetype* _arch, size_t _row)
+            { (constructComponent<Ts>(_arch, _row, _argTuples), ...); });
+    }
 
-        return metas;
+    /**
+     * @brief Parallel version of createEntityBulk() with constructor arguments, shared by every
+     * entity (each task constructs from the same tuples, which must be safe to read concurrently).
+     *
+     * @see createEntityBulk(Pool&, size_t) for the scheduling.
+     */
+    template <Component... Ts, detail::TaskPool Pool, typename... ArgTuples>
+        requires(sizeof...(Ts) == sizeof...(ArgTuples))
+    std::vector<EntityMeta> createEntityBulk(Pool& _pool, size_t _count,
+                                             ArgTuples&&... _argTuples)
+    {
+        return createEntitiesInRanges<Ts...>(
+            _count, poolRowRanges(_pool), [&](Archetype* _arch, size_t _row)
+            { (constructComponent<Ts>(_arch, _row, _argTuples), ...); });
     }
 
     /**
      * @brief Destroys multiple entities.
      *
-     * Invalid entity IDs are skipped (not treated as errors).
+     * Invalid entity IDs are skipped (not treated as errors). The sources of the relations whose
+     * kind destroys them with their target (RelationCleanup::destroySource) are destroyed in the
+     * same batch, recursively, and every pair the destroyed entities were part of is dropped.
      *
      * @param _eids Vector of entity IDs to destroy.
      * @return Vector of entity IDs that were NOT found (skipped).
      */
     std::vector<EntityID> destroyEntityBulk(const std::vector<EntityID>& _eids)
     {
-        std::vector<EntityID> notFound;
-
-        // Group entities by archetype for batch removal
-        std::unordered_map<Archetype*, std::vector<EntityID>> archetypeGroups;
-
-        for (EntityID eid : _eids)
+        if (!m_relations.empty())
         {
-            auto it = m_entityToArchetype.find(eid);
-            if (it == m_entityToArchetype.end())
-            {
-                notFound.push_back(eid);
-            }
-            else
+            std::vector<EntityID> notFound;
+            std::vector<EntityID> eids;
+            eids.reserve(_eids.size());
+            for (EntityID eid : _eids)
             {
-                archetypeGroups[it->second].push_back(eid);
+                if (m_EntityAllocationHelper.findRecord(eid)) eids.push_back(eid);
+                else notFound.push_back(eid);
             }
-        }
 
-        // Remove entities from each archetype in batches
-        for (auto& [arch, eids] : archetypeGroups)
-        {
-            arch->removeBulk(eids.data(), eids.size());
-
-            for (EntityID eid : eids)
-            {
-                m_entityToArchetype.erase(eid);
-            }
-        }
+            m_relations.expandCascade(eids);
+            for (EntityID eid : destroyEntities(eids)) notFound.push_back(eid);
+            m_relations.erase(eids);
 
-        // Free all valid IDs at once
-        std::vector<EntityID> validIds;
-        validIds.reserve(_eids.size() - notFound.size());
-        for (EntityID eid : _eids)
-        {
-            if (std::find(notFound.begin(), notFound.end(), eid) == notFound.end())
-            {
-                validIds.push_back(eid);
-            }
+            return notFound;
         }
-        m_EntityAllocationHelper.freeIDBulk(validIds);
 
-        return notFound;
+        return destroyEntities(_eids);
     }
 
     /**
@@ -586,93 +523,36 @@ class EntityRegistry final
      * @throws std::runtime_error if one or more components are not registered.
      */
     template <Component... AddComponents, Component... RemoveComponents>
-    std::vector<EntityID> modifyComponentsBulk(detail::Add<AddComponents...>,
-                                               detail::Remove<RemoveComponents...>,
+    std::vector<EntityID> modifyComponentsBulk(detail::Add<AddComponents...> _add,
+                                               detail::Remove<RemoveComponents...> _remove,
                                                const std::vector<EntityID>& _eids)
     {
-        if (_eids.empty()) return {};
-
-        // validate registrations (guard empty packs)
-        if ((sizeof...(AddComponents) > 0 &&
-             !areComponentsRegistered<AddComponents...>(m_componentRegistry)) ||
-            (sizeof...(RemoveComponents) > 0 &&
-             !areComponentsRegistered<RemoveComponents...>(m_componentRegistry)))
-        {
-            throw std::runtime_error("One or more components are not registered.");
-        }
-
-        std::vector<EntityID> notFound;
-        std::unordered_map<Archetype*, std::vector<EntityID>> archetypeGroups;
-
-        // Group entities by their current archetype (skip missing)
-        for (EntityID eid : _eids)
-        {
-            auto it = m_entityToArchetype.find(eid);
-            if (it == m_entityToArchetype.end())
-            {
-                notFound.push_back(eid);
-            }
-            else
-            {
-                archetypeGroups[it->second].push_back(eid);
-            }
-        }
+        return modifyComponentsInRanges(_add, _remove, _eids, InlineRowRanges{});
+    }
 
-        // Process each group
-        for (auto& [srcArch, eids] : archetypeGroups)
+    /**
+     * @brief Parallel version of modifyComponentsBulk(). Every archetype whose entities all take
+     * part in the batch migrates as a whole: the destination rows are reserved once, then the
+     * rows are copied, the added components constructed and the entity locations recorded by
+     * ranges dispatched to the pool (see createEntityBulk(Pool&, size_t)). Other entities move one
+     * by one on the calling thread, as do batches smaller than k_parallelBulkMinEntities.
+     *
+     * Entities migrated as a whole keep the order of their source rows rather than the order of
+     * _eids.
+     *
+     * @tparam Pool An executor such as exec::ThreadPool.
+     */
+    template <detail::TaskPool Pool, Component... AddComponents, Component... RemoveComponents>
+    std::vector<EntityID> modifyComponentsBulk(Pool& _pool, detail::Add<AddComponents...> _add,
+                                               detail::Remove<RemoveComponents...> _remove,
+                                               const std::vector<EntityID>& _eids)
+    {
+        if (_eids.size() < k_parallelBulkMinEntities)
         {
-            ComponentSignature oldSig = srcArch->signature();
-
-            // Compute new signature: set bits for Add, clear bits for Remove
-            ComponentSignature newSig = oldSig;
-            (newSig.setBit(m_componentRegistry->getID<AddComponents>()), ...);
-            (newSig.clearBit(m_componentRegistry->getID<RemoveComponents>()), ...);
-
-            if (oldSig == newSig) continue; // nothing to do for this archetype
-
-            size_t newStride = calculateStrideFromSignature(m_componentRegistry, newSig);
-            Archetype* dstArch = getOrCreateArchetype(newSig, newStride);
-
-            auto srcOffsets = srcArch->componentOffsets();  // map<CompID, offset>
-            auto destOffsets = dstArch->componentOffsets(); // map<CompID, offset>
-
-            for (EntityID eid : eids)
-            {
-                Byte* srcRow = srcArch->get(eid);
-                if (!srcRow) continue; // defensive
-
-                std::vector<Byte> newRow(newStride);
-                Byte* newRowPtr = newRow.data();
-
-                // copy meta
-                EntityMeta meta = *reinterpret_cast<EntityMeta*>(srcRow);
-                new (newRowPtr) EntityMeta{meta};
-
-                // Copy components that survive into destination offsets
-                for (const auto& [compID, srcOffset] : srcOffsets)
-                {
-                    auto it = destOffsets.find(compID);
-                    if (it == destOffsets.end()) continue; // this component was removed
-                    size_t compSize = m_componentRegistry->info(compID).size;
-                    std::memcpy(newRowPtr + it->second, srcRow + srcOffset, compSize);
-                }
-
-                // Default-construct newly added components
-                if constexpr (sizeof...(AddComponents) > 0)
-                {
-                    ((new (newRowPtr + destOffsets[m_componentRegistry->getID<AddComponents>()])
-                          AddComponents()),
-                     ...);
-                }
-
-                // Insert into destination archetype, remove from source, update map
-                dstArch->insert(meta.id, newRowPtr);
-                srcArch->remove(meta.id);
-                m_entityToArchetype[meta.id] = dstArch;
-            }
+            return modifyComponentsInRanges(_add, _remove, _eids, InlineRowRanges{});
         }
 
-        return notFound;
+        return modifyComponentsInRanges(_add, _remove, _eids, poolRowRanges(_pool));
     }
 
     /**
@@ -702,248 +582,2478 @@ class EntityRegistry final
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
-    // Archetype Migration API
+    // Shared Components API
     ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    template <Component... SourceComponents, Component... AddComponents,
-              Component... RemoveComponents>
-    size_t migrateArchetypeModifyComponents(detail::From<SourceComponents...>,
-                                            detail::Add<AddComponents...>,
-                                            detail::Remove<RemoveComponents...>)
+    /**
+     * @brief Sets the value of a shared component of the entity with the given ID.
+     *
+     * Shared components (see ComponentRegistry::registerSharedComponent()) take no bytes in the
+     * rows: equal values are interned once and the value index is part of the archetype key, so
+     * entities are grouped by value and iterating archetypes groups them by material or mesh for
+     * free. Setting another value moves the entity to the archetype of that value, removing the
+     * component goes through removeComponents() as usual.
+     *
+     * Views and getComponentsForEntity() hand out a reference to the archetype's value, which must
+     * be treated as read-only since it is referenced by every entity of the archetype.
+     *
+     * @tparam T The shared component type.
+     * @param _eid The ID of the entity (ignored if not found).
+     * @param _value The value, compared bytewise with the ones already interned.
+     * @throws std::runtime_error if the component is not registered or not registered as shared.
+     *
+     * @note viewSet() and migrateArchetypeModifyComponents() look archetypes up by signature only,
+     * so they never match archetypes holding shared values.
+     */
+    template <Component T>
+    void setSharedComponent(EntityID _eid, const T& _value)
     {
-        static_assert(sizeof...(SourceComponents) > 0,
-                      "Source archetype must specify at least one component");
-
-        // Verify components are registered (guard empty packs)
-        if (!areComponentsRegistered<SourceComponents...>(m_componentRegistry) ||
-            (sizeof...(AddComponents) > 0 &&
-             !areComponentsRegistered<AddComponents...>(m_componentRegistry)) ||
-            (sizeof...(RemoveComponents) > 0 &&
-             !areComponentsRegistered<RemoveComponents...>(m_componentRegistry)))
-        {
-            throw std::runtime_error("One or more components are not registered.");
-        }
-
-        // Source signature & archetype lookup
-        ComponentSignature srcSig = getSignatureFromTypes<SourceComponents...>(m_componentRegistry);
+        const ComponentID id = m_componentRegistry->getID<T>();
+        const ComponentMeta& info = m_componentRegistry->info(id);
 
-        auto srcIt = m_archetypes.find(srcSig);
-        if (srcIt == m_archetypes.end() || srcIt->second->empty()) return 0;
-
-        Archetype* srcArch = srcIt->second.get();
+        if (!info.shared) throw std::runtime_error("Component is not registered as shared.");
 
-        // Compute destination signature: set bits for Add, clear bits for Remove
-        ComponentSignature destSig = srcSig;
-        (destSig.setBit(m_componentRegistry->getID<AddComponents>()), ...);
-        (destSig.clearBit(m_componentRegistry->getID<RemoveComponents>()), ...);
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return;
 
-        if (srcSig == destSig) return 0; // nothing to do
+        Archetype* oldArch = m_archetypeTable[record->archetype];
+        const size_t oldRow = record->row;
 
-        // Ensure destination archetype exists
-        size_t destStride = calculateStrideFromSignature(m_componentRegistry, destSig);
-        Archetype* dstArch = getOrCreateArchetype(destSig, destStride);
+        SharedValueTable& table = m_sharedValueTables.try_emplace(id, info.size).first->second;
+        const uint32_t index = table.intern(&_value);
+        const SharedComponentValue value{id, index, table.at(index)};
 
-        auto destOffsets = dstArch->componentOffsets();
+        // replace (or insert, keeping IDs ordered) the value in the key of the current archetype
+        ArchetypeKey key = oldArch->key();
+        key.signature.setBit(id);
 
-        // Count and migrate
-        size_t count = srcArch->size();
-        std::vector<EntityID> migratedIds = srcArch->migrateAllTo(*dstArch, m_componentRegistry);
+        auto it = std::lower_bound(key.sharedValues.begin(), key.sharedValues.end(), id,
+                                   [](const SharedComponentValue& _shared, ComponentID _id)
+                                   { return _shared.id < _id; });
 
-        // Initialize added components (if any) and update entity->archetype mapping
-        if constexpr (sizeof...(AddComponents) > 0)
+        if (it != key.sharedValues.end() && it->id == id)
         {
-            for (EntityID eid : migratedIds)
-            {
-                Byte* rowPtr = dstArch->get(eid);
-                // placement-new each added component at its offset
-                ((new (rowPtr + destOffsets[m_componentRegistry->getID<AddComponents>()])
-                      AddComponents()),
-                 ...);
-
-                m_entityToArchetype[eid] = dstArch;
-            }
+            if (*it == value) return; // same value, same archetype
+            *it = value;
         }
         else
         {
-            // No components to construct; just update mapping
-            for (EntityID eid : migratedIds)
-            {
-                m_entityToArchetype[eid] = dstArch;
-            }
+            key.sharedValues.insert(it, value);
         }
 
-        return count;
+        const size_t stride = calculateStrideFromSignature(m_componentRegistry, key.signature);
+        Archetype* newArch = getOrCreateArchetype(std::move(key), stride);
+
+        const size_t row = oldArch->moveAlong(_eid, oldArch->edgeTo(newArch, m_componentRegistry));
+        patchSwappedRow(oldArch, oldRow);
+        placeEntity(_eid, newArch, row);
+
+        // a new value is not an addition, only gaining the component is
+        notifyDifference(ComponentEvent::added, newArch, oldArch, {&_eid, 1});
     }
 
     /**
-     * @brief Clears all entities and archetypes from the registry, resetting the entity allocator.
+     * @brief Retrieves the value of a shared component of the entity with the given ID.
+     *
+     * @return A pointer to the value, or nullptr if the entity is not found or has no such
+     * component.
+     * @throws std::runtime_error if the component is not registered.
      */
-    void clear()
+    template <Component T>
+    [[nodiscard]] const T* getSharedComponent(EntityID _eid) const
     {
-        m_EntityAllocationHelper.reset();
-        m_entityToArchetype.clear();
-        m_archetypes.clear();
+        const ComponentID id = m_componentRegistry->getID<T>();
+
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return nullptr;
+
+        return reinterpret_cast<const T*>(m_archetypeTable[record->archetype]->sharedValue(id));
     }
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Dynamic Components API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
     /**
-     * @brief Retrieves a view of entities that have exactly the specified set of components (strict
-     * archetype match).
+     * @brief Creates a new entity with the components of the given IDs, zero-initialized.
      *
-     * @tparam Ts The component types that define the view.
-     * @return std::optional<EntityView<Ts...>> containing the view, or std::nullopt if no
-     * archetype has the exact set of requested components.
+     * Meant for components registered with ComponentRegistry::registerDynamicComponent(), native
+     * components can be listed as well (their bytes are zeroed, not constructed).
+     *
+     * @param _components The IDs of the components (duplicates are ignored).
+     * @return The metadata of the newly created entity.
      * @throws std::runtime_error if one or more components are not registered.
      */
-    template <Component... Ts>
-    [[nodiscard]] std::optional<EntityView<Ts...>> viewSet()
+    EntityMeta createEntity(std::span<const ComponentID> _components)
     {
-        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
-        {
-            throw std::runtime_error("One or more components are not registered.");
-        }
+        const ComponentSignature sig = signatureFromIDs(_components);
+        const size_t stride = calculateStrideFromSignature(m_componentRegistry, sig);
 
-        ComponentSignature sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
+        // resolved before allocating the ID as archetype creation may throw
+        Archetype* arch = getOrCreateArchetype(sig, stride);
+        EntityMeta meta = m_EntityAllocationHelper.getID();
 
-        if (m_archetypes.find(sig) == m_archetypes.end()) return std::nullopt;
-        if (m_archetypes.at(sig)->empty()) return std::nullopt;
+        const size_t row = arch->emplaceUninitialized(meta.id);
 
-        return EntityView<Ts...>({m_archetypes.at(sig).get()}, m_componentRegistry);
-    }
+        new (arch->metaAt(row)) EntityMeta{meta};
+
+        for (ComponentID id : _components) initializeRawComponent(arch, row, id, nullptr);
+
+        placeEntity(meta.id, arch, row);
+        m_observers.notify(ComponentEvent::added, sig, {&meta.id, 1});
+
+        return meta;
+    }
 
     /**
-     * @brief Retrieves a view of entities that have at least the specified set of components
-     * (looser archetype match).
+     * @brief Adds the component of the given ID to the entity, copied from _value.
      *
-     * @tparam Ts The component types that define the view.
-     * @return std::optional<EntityView<Ts...>> containing the view, or std::nullopt if no
-     * archetypes have a superset of the requested components.
-     * @throws std::runtime_error if one or more components are not registered.
+     * The entity moves along the same cached transition edges as with addComponents<Ts...>().
+     * Nothing happens if the entity does not exist or already has the component.
+     *
+     * @param _eid The ID of the entity.
+     * @param _compID The ID of the component (shared components must go through
+     * setSharedComponent()).
+     * @param _value The initial bytes of the component (info(_compID).size of them), or nullptr
+     * to zero it.
+     * @throws std::runtime_error if the component is not registered.
      */
-    template <Component... Ts>
-    [[nodiscard]] std::optional<EntityView<Ts...>> viewSubset()
+    void addComponent(EntityID _eid, ComponentID _compID, const void* _value = nullptr)
     {
-        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        if (!m_componentRegistry->isRegistered(_compID))
         {
             throw std::runtime_error("One or more components are not registered.");
         }
 
-        std::vector<Archetype*> matchingArches;
-        ComponentSignature sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return;
 
-        for (const auto& [archSig, arch] : m_archetypes)
+        Archetype* oldArch = m_archetypeTable[record->archetype];
+        const size_t oldRow = record->row;
+
+        const ArchetypeEdge& edge = resolveSingleEdge(oldArch, _compID, true);
+        Archetype* newArch = edge.target;
+        if (newArch == oldArch) return;
+
+        const size_t row = oldArch->moveAlong(_eid, edge);
+        patchSwappedRow(oldArch, oldRow);
+        placeEntity(_eid, newArch, row);
+
+        initializeRawComponent(newArch, row, _compID, _value);
+
+        notifyDifference(ComponentEvent::added, newArch, oldArch, {&_eid, 1});
+    }
+
+    /**
+     * @brief Removes the component of the given ID from the entity (no-op if it does not have it).
+     *
+     * @throws std::runtime_error if the component is not registered.
+     */
+    void removeComponent(EntityID _eid, ComponentID _compID)
+    {
+        if (!m_componentRegistry->isRegistered(_compID))
         {
-            if ((archSig & sig) == sig && !arch->empty()) matchingArches.push_back(arch.get());
+            throw std::runtime_error("One or more components are not registered.");
         }
 
-        if (matchingArches.empty()) return std::nullopt;
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return;
 
-        return EntityView<Ts...>(matchingArches, m_componentRegistry);
+        Archetype* oldArch = m_archetypeTable[record->archetype];
+        const size_t oldRow = record->row;
+
+        const ArchetypeEdge& edge = resolveSingleEdge(oldArch, _compID, false);
+        Archetype* newArch = edge.target;
+        if (newArch == oldArch) return;
+
+        notifyDifference(ComponentEvent::removed, oldArch, newArch, {&_eid, 1});
+
+        const size_t row = oldArch->moveAlong(_eid, edge);
+        patchSwappedRow(oldArch, oldRow);
+        placeEntity(_eid, newArch, row);
     }
 
     /**
-     * @brief Retrieves the archetype that contains the entity with the specified ID.
+     * @brief Retrieves the bytes of the component of the given ID of the entity.
      *
-     * @param _eid The ID of the entity whose archetype is to be retrieved.
-     * @return Archetype* or nullptr if the entity does not exist.
+     * Writes through the pointer are not stamped for change detection, see markChanged().
+     *
+     * @param _eid The ID of the entity.
+     * @param _compID The ID of the component.
+     * @return The component (the archetype's value for shared components), or nullptr if the
+     * entity does not exist, does not have the component or the component is a tag.
+     * @throws std::runtime_error if the component is not registered.
      */
-    [[nodiscard]] Archetype* getArchetypeForEntity(EntityID _eid) const
+    [[nodiscard]] Byte* getComponent(EntityID _eid, ComponentID _compID)
     {
-        if (m_entityToArchetype.find(_eid) == m_entityToArchetype.end()) return nullptr;
+        if (!hasComponent(_eid, _compID)) return nullptr;
 
-        return m_entityToArchetype.at(_eid);
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        Archetype* arch = m_archetypeTable[record->archetype];
+
+        const ComponentMeta& info = m_componentRegistry->info(_compID);
+        if (info.sparse) return info.size != 0 ? m_sparseStorage.find(_compID)->get(_eid) : nullptr;
+
+        if (Byte* shared = arch->sharedValue(_compID)) return shared;
+        if (!info.hasRowStorage()) return nullptr;
+
+        return arch->componentAt(record->row, _compID);
     }
 
     /**
-     * @brief Retrieves the components of the entity with the specified ID as a tuple of references.
+     * @brief Checks whether the entity has the component of the given ID (tags included).
+     *
+     * @throws std::runtime_error if the component is not registered.
+     */
+    [[nodiscard]] bool hasComponent(EntityID _eid, ComponentID _compID) const
+    {
+        if (!m_componentRegistry->isRegistered(_compID))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return false;
+
+        if (m_componentRegistry->info(_compID).sparse)
+        {
+            const detail::SparseComponentSet* set = m_sparseStorage.find(_compID);
+            return set && set->contains(_eid);
+        }
+
+        return m_archetypeTable[record->archetype]->signature().testBit(_compID);
+    }
+
+    /**
+     * @brief Stamps the component of the given ID of the entity as changed at the current tick
+     * (see markChanged<Ts...>()).
      *
-     * If the entity does not have all the specified components, std::nullopt is returned.
+     * @throws std::runtime_error if the component is not registered.
+     */
+    void markChanged(EntityID _eid, ComponentID _compID)
+    {
+        if (!hasComponent(_eid, _compID)) return;
+
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        m_archetypeTable[record->archetype]->markChangedAt(record->row, _compID);
+    }
+
+    /**
+     * @brief Invokes the function once per run of entities having every given component, with one
+     * raw column per component (in the order of _components).
      *
-     * @tparam Ts The component types to be retrieved.
-     * @param _eid The ID of the entity whose components are to be retrieved.
-     * @return std::optional<std::tuple<Ts&...>> containing references to the components, or
-     * std::nullopt if the entity does not have all specified components.
+     * A run is one chunk in chunked mode (columns are contiguous, the stride is the component
+     * size) or a whole interleaved archetype (the stride is the row stride). The function is
+     * called as func(size_t count, RawColumn metas, std::span<const RawColumn> columns), where
+     * metas holds the EntityMeta of each entity. Every listed component with storage is stamped
+     * as changed over the visited archetypes. The matching archetypes are cached like a query's.
+     *
+     * @param _components The IDs of the components (native or dynamic).
+     * @param _func The function to invoke, it must not make structural changes.
      * @throws std::runtime_error if one or more components are not registered.
      */
-    template <Component... Ts>
-    [[nodiscard]] std::optional<std::tuple<Ts&...>> getComponentsForEntity(EntityID _eid)
+    template <typename Func>
+        requires std::is_invocable_v<Func&, size_t, RawColumn, std::span<const RawColumn>>
+    void forEachRawChunk(std::span<const ComponentID> _components, Func&& _func)
     {
-        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        const detail::QueryState& state = getOrCreateQuery(
+            {signatureFromIDs(_components), ComponentSignature(m_componentRegistry->maxCount())});
+
+        std::vector<RawColumn> columns(_components.size());
+
+        for (Archetype* arch : state.archetypes)
+        {
+            if (arch->empty()) continue;
+
+            if (arch->isChunked())
+            {
+                for (size_t chunk = 0; chunk < arch->chunkCount(); ++chunk)
+                {
+                    for (size_t i = 0; i < _components.size(); ++i)
+                    {
+                        columns[i] = rawColumnOf(arch, chunk, _components[i]);
+                    }
+
+                    const RawColumn metas{reinterpret_cast<Byte*>(arch->chunkMetas(chunk)),
+                                          sizeof(EntityMeta)};
+                    _func(arch->chunkSize(chunk), metas, std::span<const RawColumn>(columns));
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < _components.size(); ++i)
+                {
+                    columns[i] = rawColumnOf(arch, 0, _components[i]);
+                }
+
+                _func(arch->size(), RawColumn{arch->data(), arch->stride()},
+                      std::span<const RawColumn>(columns));
+            }
+
+            for (ComponentID id : _components)
+            {
+                if (m_componentRegistry->info(id).hasRowStorage())
+                {
+                    arch->markChanged(id, 0, arch->tickBlockCount());
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Invokes the function once per tick block where the component of the given ID was
+     * written or added after tick _since, as func(size_t count, RawColumn metas, RawColumn column).
+     *
+     * Nothing is stamped. A block is a chunk (chunked) or Archetype::k_tickBlockRows rows
+     * (interleaved), so rows of a block that were not written are visited too. The column of a
+     * shared component has a stride of 0, that of a tag is null.
+     *
+     * @param _compID The ID of the component (native or dynamic).
+     * @param _since The tick the changes are looked for after (0 visits every block ever written).
+     * @param _func The function to invoke, it must not make structural changes.
+     * @throws std::runtime_error if the component is not registered.
+     */
+    template <typename Func>
+        requires std::is_invocable_v<Func&, size_t, RawColumn, RawColumn>
+    void forEachChangedRawBlock(ComponentID _compID, uint32_t _since, Func&& _func) const
+    {
+        if (!m_componentRegistry->isRegistered(_compID))
         {
             throw std::runtime_error("One or more components are not registered.");
         }
 
-        auto arch = getArchetypeForEntity(_eid);
+        for (Archetype* arch : m_archetypeTable)
+        {
+            if (arch->empty() || !arch->signature().testBit(_compID)) continue;
 
-        if (!arch) return std::nullopt;
+            const RawColumn rows = rawColumnOf(arch, 0, _compID);
 
-        ComponentSignature archSig = arch->signature();
-        ComponentSignature querySig = getSignatureFromTypes<Ts...>(m_componentRegistry);
+            for (size_t block = 0; block < arch->tickBlockCount(); ++block)
+            {
+                const ColumnTicks ticks = arch->columnTicks(block, _compID);
+                if (!isNewerTick(ticks.changed, _since) && !isNewerTick(ticks.added, _since))
+                {
+                    continue;
+                }
 
-        if ((archSig & querySig) != querySig) return std::nullopt;
+                if (arch->isChunked())
+                {
+                    const RawColumn metas{reinterpret_cast<Byte*>(arch->chunkMetas(block)),
+                                          sizeof(EntityMeta)};
+                    _func(arch->chunkSize(block), metas, rawColumnOf(arch, block, _compID));
+                    continue;
+                }
 
-        Byte* rowPtr = arch->get(_eid);
-        auto componentOffsets = arch->componentOffsets();
+                const size_t first = block * Archetype::k_tickBlockRows;
+                const size_t count = std::min(Archetype::k_tickBlockRows, arch->size() - first);
+                const RawColumn metas{arch->data() + first * arch->stride(), arch->stride()};
+                const RawColumn column{rows.data ? rows[first] : nullptr, rows.stride};
 
-        return std::optional<std::tuple<Ts&...>>{
-            std::in_place,
-            (*reinterpret_cast<Ts*>(rowPtr +
-                                    componentOffsets[m_componentRegistry->getID<Ts>()]))...,
-        };
+                _func(count, metas, column);
+            }
+        }
     }
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Singleton API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
     /**
-     * @brief Checks if the entity with the specified metadata is valid (exists and generation
-     * matches).
+     * @brief Constructs the registry-level instance of T, replacing the previous one if any.
      *
-     * @param _meta The metadata of the entity to be checked.
-     * @return true if the entity is valid, false otherwise.
+     * Singletons hold world-wide state (primary camera, time, physics settings...) that would
+     * otherwise be duplicated into every row or kept outside the ECS. They are not part of any
+     * archetype, need no registration and survive clear().
+     *
+     * @tparam T The singleton type.
+     * @param _args The arguments forwarded to the constructor of T.
+     * @return A reference to the singleton, valid until it is removed.
      */
-    [[nodiscard]] bool isEntityValid(EntityMeta _meta) const
+    template <Component T, typename... Args>
+    T& setSingleton(Args&&... _args)
     {
-        if (m_entityToArchetype.find(_meta.id) == m_entityToArchetype.end()) return false;
+        const size_t slot = detail::componentTypeSlot<T>();
+        if (slot >= m_singletons.size()) m_singletons.resize(slot + 1);
 
-        auto rowPtr = m_entityToArchetype.at(_meta.id)->get(_meta.id);
-        auto entityMeta = reinterpret_cast<EntityMeta*>(rowPtr);
+        if (!m_singletons[slot])
+        {
+            m_singletons[slot].emplace(sizeof(T));
+            m_singletons[slot]->resize(1);
+        }
 
-        return entityMeta->gen == _meta.gen &&
-               m_EntityAllocationHelper.getGenForID(_meta.id) == _meta.gen;
+        return *new (m_singletons[slot]->data()) T(std::forward<Args>(_args)...);
     }
 
-    // Returns the total number of entities in the registry.
-    [[nodiscard]] size_t entityCount() const { return m_entityToArchetype.size(); }
+    // Returns the singleton instance of T, or nullptr if it is not set.
+    template <Component T>
+    [[nodiscard]] T* getSingleton() noexcept
+    {
+        const size_t slot = detail::componentTypeSlot<T>();
+        if (slot >= m_singletons.size() || !m_singletons[slot]) return nullptr;
 
-    // Returns the total number of archetypes in the registry.
-    [[nodiscard]] size_t archetypeCount() const { return m_archetypes.size(); }
+        return reinterpret_cast<T*>(m_singletons[slot]->data());
+    }
 
-    // Returns the total memory usage of all archetypes in bytes.
-    [[nodiscard]] size_t totalMemoryUsageInBytes() const
+    // Const version of getSingleton().
+    template <Component T>
+    [[nodiscard]] const T* getSingleton() const noexcept
     {
-        size_t total = 0;
+        const size_t slot = detail::componentTypeSlot<T>();
+        if (slot >= m_singletons.size() || !m_singletons[slot]) return nullptr;
+
+        return reinterpret_cast<const T*>(m_singletons[slot]->data());
+    }
+
+    // Removes the singleton instance of T, returns whether there was one.
+    template <Component T>
+    bool removeSingleton() noexcept
+    {
+        const size_t slot = detail::componentTypeSlot<T>();
+        if (slot >= m_singletons.size() || !m_singletons[slot]) return false;
+
+        m_singletons[slot].reset();
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Relation API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Registers the relation kind R, (source, target) pairs of entities indexed both ways.
+     *
+     * Relations replace the EntityID fields of components (parent, owner, target...): the targets
+     * of a source and the sources of a target are each one hash lookup away, and destroying an
+     * entity drops its pairs, or destroys the sources targeting it, without scanning anything. R
+     * is only a tag: it takes no component registration and no archetype signature bit, so
+     * entities with different targets still share their archetype. Registering a kind again
+     * changes its settings and drops its pairs.
+     *
+     * @tparam R The relation kind, any type (typically an empty struct such as scene::ChildOf).
+     */
+    template <typename R>
+    void registerRelation(const RelationSettings& _settings = {})
+    {
+        m_relations.registerKind(detail::componentTypeSlot<R>(), _settings);
+    }
+
+    /**
+     * @brief Adds the pair (_source, _target) of the relation R. For an exclusive kind it replaces
+     * the target the source had, if any.
+     *
+     * @return Whether the pair was added, false if it existed or either entity is not alive.
+     * @throws std::runtime_error if R is not registered.
+     */
+    template <typename R>
+    bool addRelation(EntityID _source, EntityID _target)
+    {
+        detail::RelationIndex& index = relationIndex<R>();
 
-        for (const auto& [sig, arch] : m_archetypes)
+        if (!m_EntityAllocationHelper.findRecord(_source) ||
+            !m_EntityAllocationHelper.findRecord(_target))
         {
-            total += arch->memoryUsageInBytes();
+            return false;
         }
 
-        return total;
+        return index.add(_source, _target);
     }
 
-   private:
-    // Retrieves an existing archetype by signature or creates a new one if it doesn't exist.
-    Archetype* getOrCreateArchetype(ComponentSignature _signature, size_t _stride)
+    // Removes the pair (_source, _target) of the relation R, returns whether it existed.
+    template <typename R>
+    bool removeRelation(EntityID _source, EntityID _target)
+    {
+        return relationIndex<R>().remove(_source, _target);
+    }
+
+    template <typename R>
+    [[nodiscard]] bool hasRelation(EntityID _source, EntityID _target) const
+    {
+        return relationIndex<R>().contains(_source, _target);
+    }
+
+    /**
+     * @brief Returns the targets of the source through the relation R, in no particular order.
+     *
+     * @note The span is invalidated by any change to the pairs of R (destruction included).
+     */
+    template <typename R>
+    [[nodiscard]] std::span<const EntityID> relationTargets(EntityID _source) const
+    {
+        return relationIndex<R>().targetsOf(_source);
+    }
+
+    /**
+     * @brief Returns the sources targeting the entity through the relation R (e.g. the children of
+     * a parent), in no particular order.
+     *
+     * @note The span is invalidated by any change to the pairs of R (destruction included).
+     */
+    template <typename R>
+    [[nodiscard]] std::span<const EntityID> relationSources(EntityID _target) const
+    {
+        return relationIndex<R>().sourcesOf(_target);
+    }
+
+    // Returns the number of pairs of the relation R.
+    template <typename R>
+    [[nodiscard]] size_t relationCount() const
+    {
+        return relationIndex<R>().size();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Sparse Components API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Gives the entity the sparse component T (see
+     * ComponentRegistry::registerSparseComponent()), or overwrites its value.
+     *
+     * The value goes to the sparse set of T: no archetype change, no row copy, O(1). Queries
+     * filter and fetch sparse terms by probing the set per entity. Sparse components carry no
+     * change ticks, fire no observers and are not written to snapshots.
+     *
+     * @param _args The arguments forwarded to the constructor of T.
+     * @return The component (the tag instance for tags), or nullptr if the entity is not alive.
+     * @throws std::runtime_error if T is not registered as a sparse component.
+     */
+    template <Component T, typename... Args>
+    T* addSparseComponent(EntityID _eid, Args&&... _args)
+    {
+        detail::SparseComponentSet& set = sparseSetOf<T>();
+        if (!m_EntityAllocationHelper.findRecord(_eid)) return nullptr;
+
+        Byte* element = set.contains(_eid) ? set.get(_eid) : set.emplaceUninitialized(_eid);
+        if constexpr (TagComponent<T>) return &detail::tagInstance<T>();
+        else return new (element) T(std::forward<Args>(_args)...);
+    }
+
+    // Removes the sparse component T from the entity, returns whether it had it.
+    template <Component T>
+    bool removeSparseComponent(EntityID _eid)
+    {
+        detail::SparseComponentSet& set = sparseSetOf<T>();
+        if (!set.contains(_eid)) return false;
+
+        set.remove(_eid);
+        return true;
+    }
+
+    // Returns the sparse component T of the entity, or nullptr if it does not have it.
+    template <Component T>
+    [[nodiscard]] T* getSparseComponent(EntityID _eid)
+    {
+        Byte* element = sparseSetOf<T>().get(_eid);
+        if (!element) return nullptr;
+
+        if constexpr (TagComponent<T>) return &detail::tagInstance<T>();
+        else return reinterpret_cast<T*>(element);
+    }
+
+    template <Component T>
+    [[nodiscard]] bool hasSparseComponent(EntityID _eid)
+    {
+        return sparseSetOf<T>().contains(_eid);
+    }
+
+    // Returns the number of entities having the sparse component T.
+    template <Component T>
+    [[nodiscard]] size_t sparseComponentCount()
+    {
+        return sparseSetOf<T>().size();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Static Archetypes API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Registers the archetype made of exactly Ts... with the compile-time row layout
+     * detail::StaticLayout<Ts...>, and returns a handle iterating it with constant offsets.
+     *
+     * The layout is kept by the registry: the archetype uses it whenever it is created, including
+     * after clear(), compaction or a snapshot load. Registering the same list again returns a new
+     * handle over the same archetype.
+     *
+     * @throws std::runtime_error if a component is not registered, is shared or sparse, if the
+     * components were registered in another order, or if entities made of them already exist
+     * with another layout.
+     */
+    template <Component... Ts>
+    StaticArchetype<Ts...> registerStaticArchetype()
     {
-        if (m_archetypes.find(_signature) != m_archetypes.end())
+        using Layout = detail::StaticLayout<Ts...>;
+
+        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        const std::array<ComponentID, sizeof...(Ts)> ids{m_componentRegistry->getID<Ts>()...};
+        const ComponentSignature sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
+
+        detail::StaticRowLayout layout{{}, Layout::k_stride};
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            const ComponentMeta& info = m_componentRegistry->info(ids[i]);
+            if (info.shared || info.sparse)
+            {
+                throw std::runtime_error(
+                    "Static archetypes cannot hold shared or sparse components.");
+            }
+            if (info.hasRowStorage()) layout.offsets[ids[i]] = Layout::k_offsets[i];
+        }
+
+        if (auto it = m_staticLayouts.find(sig); it != m_staticLayouts.end())
+        {
+            if (it->second.offsets != layout.offsets)
+            {
+                throw std::runtime_error(
+                    "Static archetype is already registered with another component order.");
+            }
+        }
+        else if (auto it = m_archetypes.find(ArchetypeKey{sig, {}}); it != m_archetypes.end())
+        {
+            // an archetype laid out by ComponentID is only replaced while it holds no entity
+            Archetype* arch = it->second.get();
+            if (arch->componentOffsets() != layout.offsets || arch->stride() != layout.stride)
+            {
+                if (!arch->empty())
+                {
+                    throw std::runtime_error(
+                        "Static archetypes must be registered before their entities exist.");
+                }
+                destroyArchetype(arch);
+            }
+        }
+
+        m_staticLayouts.try_emplace(sig, std::move(layout));
+
+        ComponentSignature others(m_componentRegistry->maxCount());
+        for (ComponentID id = 0; id < m_componentRegistry->maxCount(); ++id)
         {
-            return m_archetypes[_signature].get();
+            if (!sig.testBit(id)) others.setBit(id);
         }
 
-        auto componentOffsets =
-            getComponentOffsetsInBytesFromSignature(m_componentRegistry, _signature);
+        return StaticArchetype<Ts...>(&getOrCreateQuery(detail::QueryKey{sig, std::move(others)}),
+                                      ids);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Reservation API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Reserves an entity handle without creating the entity, lock-free and callable from
+     * any thread.
+     *
+     * The handle can be referenced right away (e.g. recorded into a command buffer) and becomes a
+     * live entity once passed to createReservedEntity() on the owning thread.
+     *
+     * @note Reservations may run concurrently with each other and with const accesses, but not
+     * with structural changes (create, destroy, modify, clear).
+     */
+    [[nodiscard]] EntityMeta reserveEntity() const noexcept
+    {
+        EntityMeta meta;
+        m_EntityAllocationHelper.reserveIDs({&meta, 1});
+        return meta;
+    }
+
+    /**
+     * @brief Reserves one entity handle per element of the given span with a single atomic
+     * operation.
+     *
+     * @see reserveEntity for the threading rules.
+     */
+    void reserveEntities(std::span<EntityMeta> _out) const noexcept
+    {
+        m_EntityAllocationHelper.reserveIDs(_out);
+    }
 
-        m_archetypes[_signature] =
-            std::make_unique<Archetype>(_signature, _stride, componentOffsets);
+    /**
+     * @brief Creates the entity of a reserved handle with the specified components.
+     *
+     * @tparam Ts The component types to be added to the new entity.
+     * @param _reserved A handle returned by reserveEntity() or reserveEntities().
+     * @param _argTuples Tuples of constructor arguments for each component, or none to default
+     * construct them.
+     * @return false if the handle is not a pending reservation (already created, released or
+     * stale), nothing is created then.
+     * @throws std::runtime_error if one or more components are not registered.
+     */
+    template <Component... Ts, typename... ArgTuples>
+        requires(sizeof...(ArgTuples) == 0 || sizeof...(Ts) == sizeof...(ArgTuples))
+    bool createReservedEntity(EntityMeta _reserved, ArgTuples&&... _argTuples)
+    {
+        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        auto sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
+        auto stride = calculateStrideFromSignature(m_componentRegistry, sig);
+
+        // resolved before claiming the ID as archetype creation may throw
+        Archetype* arch = getOrCreateArchetype(sig, stride);
+        if (!m_EntityAllocationHelper.claimReservedID(_reserved)) return false;
+
+        const size_t row = arch->emplaceUninitialized(_reserved.id);
+
+        new (arch->metaAt(row)) EntityMeta{_reserved};
+
+        if constexpr (sizeof...(ArgTuples) == 0) (constructComponent<Ts>(arch, row), ...);
+        else (constructComponent<Ts>(arch, row, std::forward<ArgTuples>(_argTuples)), ...);
+
+        placeEntity(_reserved.id, arch, row);
+        m_observers.notify(ComponentEvent::added, sig, {&_reserved.id, 1});
+
+        return true;
+    }
+
+    /**
+     * @brief Gives back a reserved handle that will not be created, so its ID can be recycled.
+     *
+     * @return false if the handle is not a pending reservation.
+     */
+    bool releaseReservedEntity(EntityMeta _reserved)
+    {
+        return m_EntityAllocationHelper.releaseReservedID(_reserved);
+    }
+
+    // Returns the number of reserved handles neither created nor released yet.
+    [[nodiscard]] size_t reservedEntityCount() const noexcept
+    {
+        return m_EntityAllocationHelper.reservedCount();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Snapshot API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Appends a binary snapshot of every entity to a byte buffer.
+     *
+     * Components are trivially copyable, so each archetype is written as its raw rows together
+     * with the name, size and alignment of its components (see snapshot_format.hpp). Entity IDs
+     * and generations are kept, so handles stored inside components stay valid after a load.
+     * Singletons and change ticks are not part of snapshots.
+     *
+     * @param _out The buffer the snapshot is appended to.
+     */
+    void writeSnapshot(std::vector<uint8_t>& _out) const
+    {
+        detail::SnapshotWriter writer(_out);
+
+        uint32_t archetypeCount = 0;
+        for (const Archetype* arch : m_archetypeTable) archetypeCount += arch->empty() ? 0 : 1;
+
+        const size_t recordCount = m_EntityAllocationHelper.recordCount();
+        writer.put(detail::SnapshotHeader{detail::k_snapshotMagic, detail::k_snapshotVersion,
+                                          static_cast<uint32_t>(m_componentRegistry->count()),
+                                          archetypeCount, static_cast<uint32_t>(recordCount), 0});
+
+        for (ComponentID id = 0; id < m_componentRegistry->count(); ++id)
+        {
+            const ComponentMeta& info = m_componentRegistry->info(id);
+            writer.put(detail::SnapshotComponent{
+                static_cast<uint32_t>(info.name.size()), static_cast<uint32_t>(info.size),
+                static_cast<uint32_t>(info.alignment), info.shared ? 1u : 0u});
+            writer.putBytes(info.name.data(), info.name.size());
+            writer.align(8);
+        }
+
+        for (EntityID id = 0; id < recordCount; ++id)
+        {
+            writer.put(m_EntityAllocationHelper.getGenForID(id));
+        }
+        writer.align(8);
+
+        for (Archetype* arch : m_archetypeTable)
+        {
+            if (!arch->empty()) writeArchetypeSnapshot(writer, arch);
+        }
+    }
+
+    /**
+     * @brief Replaces the content of the registry with the entities of a snapshot.
+     *
+     * Components are matched by name, so the component registry may assign different IDs than
+     * the one the snapshot was written from (rows are then re-laid out component by component,
+     * otherwise they are inserted in bulk verbatim). The data is only read during the call, it can
+     * point straight into a memory-mapped file (see loadSnapshotFromFile()).
+     *
+     * @param _data The bytes of a snapshot written by writeSnapshot().
+     * @throws std::runtime_error if the snapshot is malformed, or if one of its components is not
+     * registered or was registered with a different size or kind. The registry is left empty in
+     * that case.
+     */
+    void readSnapshot(std::span<const uint8_t> _data)
+    {
+        clear();
+
+        try
+        {
+            readSnapshotSections(_data);
+        }
+        catch (...)
+        {
+            clearStorage();
+            throw;
+        }
+
+        for (const Archetype* arch : m_archetypeTable)
+        {
+            m_observers.notify(ComponentEvent::added, arch->signature(), arch->entityIDs());
+        }
+    }
+
+    /**
+     * @brief Appends the entities of a snapshot to the registry under new IDs, at most
+     * _maxEntities a call: a large snapshot is inserted over several calls (frames), each resuming
+     * where _cursor stopped.
+     *
+     * Unlike readSnapshot() the entities of the registry stay and the IDs and generations of the
+     * snapshot are not restored, so entity IDs stored inside its components do not refer to the
+     * new entities. Rows are inserted in bulk like readSnapshot() does, observers are notified per
+     * archetype of every call. _data must stay the same until the cursor is done.
+     *
+     * @param _created Receives the new entities, in the order of the snapshot.
+     * @return Whether the whole snapshot is inserted.
+     * @throws std::runtime_error if the snapshot is malformed, or if one of its components is not
+     * registered or was registered with a different size or kind. The entities inserted by the
+     * previous calls stay.
+     */
+    bool appendSnapshot(std::span<const uint8_t> _data, SnapshotCursor& _cursor,
+                        size_t _maxEntities, std::vector<EntityMeta>& _created)
+    {
+        if (_cursor.done) return true;
+
+        detail::SnapshotReader reader(_data);
+        const auto header = readSnapshotHeader(reader);
+        const SnapshotComponents components = readSnapshotComponents(reader, header);
+
+        if (_cursor.offset == 0)
+        {
+            (void)reader.getBytes(header.recordCount * sizeof(EntityGen));
+            reader.align(8);
+            _cursor.offset = reader.tell();
+        }
+        reader.seek(_cursor.offset);
+
+        size_t budget = _maxEntities;
+        std::vector<EntityID> eids;
+
+        while (_cursor.archetype < header.archetypeCount)
+        {
+            if (budget == 0) return false;
+
+            const SnapshotRows section = readSnapshotArchetype(reader, components);
+            const size_t count = std::min(budget, section.count - std::min(_cursor.row,
+                                                                           section.count));
+            if (count > 0)
+            {
+                const std::vector<EntityMeta> metas = m_EntityAllocationHelper.getIDBulk(count);
+                eids.resize(count);
+                for (size_t i = 0; i < count; ++i) eids[i] = metas[i].id;
+
+                const size_t first = copySnapshotRows(section, eids.data(), _cursor.row, count);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    std::memcpy(section.arch->metaAt(first + i), &metas[i], sizeof(EntityMeta));
+                    placeEntity(eids[i], section.arch, first + i);
+                }
+
+                m_observers.notify(ComponentEvent::added, section.arch->signature(), eids);
+                _created.insert(_created.end(), metas.begin(), metas.end());
+
+                _cursor.row += count;
+                budget -= count;
+            }
+
+            if (_cursor.row < section.count) return false;
+
+            ++_cursor.archetype;
+            _cursor.row = 0;
+            _cursor.offset = reader.tell();
+        }
+
+        _cursor.done = true;
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observer API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Registers a callback fired whenever T is added to or removed from entities.
+     *
+     * Callbacks receive every entity an operation affected at once instead of being called per
+     * entity: one call per createEntityBulk(), modifyComponentsBulk(), destroyEntityBulk(),
+     * migrateArchetypeModifyComponents() or clear() (thus per command buffer playback batch),
+     * single-entity operations pass a span of one. Added callbacks run once the components are
+     * constructed, removed callbacks before the entities lose them (destruction included), so the
+     * values can still be read, e.g. to release GPU resources.
+     *
+     * The span is only valid during the call. Callbacks must neither make structural changes to
+     * the registry nor register or remove observers: record them in a CommandBuffer instead.
+     *
+     * @tparam T The observed component (changing the value of a shared component is not an
+     * addition).
+     * @param _event Whether the callback observes additions or removals.
+     * @param _callback Called with the IDs of the affected entities.
+     * @return The ID to pass to unobserve().
+     * @throws std::runtime_error if T is not registered.
+     */
+    template <Component T>
+    ObserverID observe(ComponentEvent _event, ObserverCallback _callback)
+    {
+        if (!areComponentsRegistered<T>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        return m_observers.add(m_componentRegistry->getIDUnchecked<T>(), _event,
+                               std::move(_callback));
+    }
+
+    /**
+     * @brief Same as observe<T>() for the component of the given ID (e.g. a dynamic one).
+     *
+     * @throws std::runtime_error if the component is not registered.
+     */
+    ObserverID observe(ComponentID _compID, ComponentEvent _event, ObserverCallback _callback)
+    {
+        if (!m_componentRegistry->isRegistered(_compID))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        return m_observers.add(_compID, _event, std::move(_callback));
+    }
+
+    // Removes an observer registered with observe(), returns whether it was registered.
+    bool unobserve(ObserverID _id) { return m_observers.remove(_id); }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Sorting API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Sorts the rows of every archetype containing T by the values of T, once.
+     *
+     * Views then visit the entities of each archetype in that order (archetypes are still visited
+     * one after the other). The sort is stable, entity handles are unaffected and no component is
+     * stamped as changed. Later structural changes append or swap-and-pop rows and break the
+     * order again, see groupBy() to keep it. Must not be called while a view is iterated.
+     *
+     * @tparam T The component to sort by (neither a tag nor shared, archetypes holding it as a
+     * shared component are left untouched as all their entities have the same value).
+     * @param _compare A strict weak ordering of two `const T&`.
+     * @throws std::runtime_error if T is not registered.
+     */
+    template <Component T, typename Compare = std::less<T>>
+    void sortArchetype(Compare _compare = {})
+    {
+        static_assert(!TagComponent<T>, "Tags have no value to sort by");
+
+        if (!areComponentsRegistered<T>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        const ComponentID id = m_componentRegistry->getIDUnchecked<T>();
+        for (Archetype* arch : m_archetypeTable)
+        {
+            if (arch->signature().testBit(id)) sortRowsBy<T>(arch, _compare, std::nullopt);
+        }
+    }
+
+    /**
+     * @brief Keeps the rows of every archetype containing T sorted by the values of T (e.g. the
+     * mesh of renderables, to build instanced batches without sorting them every frame).
+     *
+     * The rows are sorted right away, then updateGroups() restores the order incrementally: only
+     * the rows of the tick blocks where T was written since the previous update (created, moved
+     * in, handed out mutably by a view or stamped with markChanged()) are sorted, then merged
+     * with the other rows. Registering T again replaces its ordering. An archetype containing the
+     * components of several groups follows the group registered first.
+     *
+     * @tparam T The component to sort by (neither a tag nor shared).
+     * @param _compare A strict weak ordering of two `const T&`.
+     * @throws std::runtime_error if T is not registered.
+     */
+    template <Component T, typename Compare = std::less<T>>
+    void groupBy(Compare _compare = {})
+    {
+        static_assert(!TagComponent<T>, "Tags have no value to sort by");
+
+        if (!areComponentsRegistered<T>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        const ComponentID id = m_componentRegistry->getIDUnchecked<T>();
+        auto sort = [compare = std::move(_compare)](EntityRegistry& _registry, Archetype* _arch,
+                                                    std::optional<uint32_t> _since) mutable
+        { _registry.sortRowsBy<T>(_arch, compare, _since); };
+
+        auto it = std::ranges::find(m_sortGroups, id, &SortGroup::component);
+        if (it == m_sortGroups.end())
+        {
+            it = m_sortGroups.insert(m_sortGroups.end(), SortGroup{id, m_tick, std::move(sort)});
+        }
+        else
+        {
+            *it = SortGroup{id, m_tick, std::move(sort)};
+        }
+
+        updateGroup(static_cast<size_t>(it - m_sortGroups.begin()), std::nullopt);
+    }
+
+    /**
+     * @brief Stops keeping the rows sorted by T (the current order is left as is).
+     *
+     * @return true if T was grouped.
+     */
+    template <Component T>
+    bool ungroup()
+    {
+        if (!areComponentsRegistered<T>(m_componentRegistry)) return false;
+
+        const ComponentID id = m_componentRegistry->getIDUnchecked<T>();
+        return std::erase_if(m_sortGroups, [id](const SortGroup& _group)
+                             { return _group.component == id; }) > 0;
+    }
+
+    /**
+     * @brief Restores the row order of every group (see groupBy()), typically once per frame
+     * before the systems relying on it. Must not be called while a view is iterated.
+     */
+    void updateGroups()
+    {
+        for (size_t i = 0; i < m_sortGroups.size(); ++i)
+        {
+            updateGroup(i, m_sortGroups[i].sortedTick);
+            m_sortGroups[i].sortedTick = m_tick;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Archetype Migration API
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    template <Component... SourceComponents, Component... AddComponents,
+              Component... RemoveComponents>
+    size_t migrateArchetypeModifyComponents(detail::From<SourceComponents...> _from,
+                                            detail::Add<AddComponents...> _add,
+                                            detail::Remove<RemoveComponents...> _remove)
+    {
+        return migrateArchetypeInRanges(_from, _add, _remove, InlineRowRanges{});
+    }
+
+    /**
+     * @brief Parallel version of migrateArchetypeModifyComponents(): the destination rows are
+     * reserved once, then the rows are copied, the added components constructed and the entity
+     * locations recorded by ranges dispatched to the pool (see createEntityBulk(Pool&, size_t)).
+     *
+     * @tparam Pool An executor such as exec::ThreadPool.
+     */
+    template <detail::TaskPool Pool, Component... SourceComponents, Component... AddComponents,
+              Component... RemoveComponents>
+    size_t migrateArchetypeModifyComponents(Pool& _pool, detail::From<SourceComponents...> _from,
+                                            detail::Add<AddComponents...> _add,
+                                            detail::Remove<RemoveComponents...> _remove)
+    {
+        return migrateArchetypeInRanges(_from, _add, _remove, poolRowRanges(_pool));
+    }
+
+
+    /**
+     * @brief Clears all entities and archetypes from the registry, resetting the entity allocator.
+     *
+     * Removal observers are notified once per archetype before anything is cleared.
+     */
+    void clear()
+    {
+        if (m_observers.observed(ComponentEvent::removed).any())
+        {
+            for (const Archetype* arch : m_archetypeTable)
+            {
+                m_observers.notify(ComponentEvent::removed, arch->signature(), arch->entityIDs());
+            }
+        }
+
+        clearStorage();
+    }
+
+    /**
+     * @brief Gives memory back incrementally: destroys the empty archetypes and shrinks the
+     * storage of the others (see Archetype::shrinkToFit()).
+     *
+     * Every call visits at most _archetypeBudget archetypes and resumes where the previous one
+     * stopped, so a full pass can be spread over several frames (e.g. during a loading screen).
+     * Destroyed archetypes are unlinked from the transition graph and from every query, they are
+     * recreated on demand. Must not be called while a view or query of the registry is iterated,
+     * and views obtained before the call must not be used after it.
+     *
+     * @param _archetypeBudget The maximum number of archetypes visited by this call.
+     * @return What the call reclaimed, `finished` is set once the pass reached the last archetype.
+     */
+    CompactionResult compact(size_t _archetypeBudget = std::numeric_limits<size_t>::max())
+    {
+        CompactionResult result;
+
+        for (size_t visited = 0;
+             visited < _archetypeBudget && m_compactionCursor < m_archetypeTable.size(); ++visited)
+        {
+            Archetype* arch = m_archetypeTable[m_compactionCursor];
+            const size_t before = arch->memoryUsageInBytes();
+
+            if (arch->empty())
+            {
+                // the last archetype takes over the slot, so the cursor stays in place
+                destroyArchetype(arch);
+                result.bytesReclaimed += before;
+                ++result.archetypesRemoved;
+            }
+            else
+            {
+                arch->shrinkToFit();
+                result.bytesReclaimed += before - arch->memoryUsageInBytes();
+                ++m_compactionCursor;
+            }
+        }
+
+        if (m_compactionCursor >= m_archetypeTable.size())
+        {
+            m_compactionCursor = 0;
+            result.finished = true;
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Retrieves a view of entities that have exactly the specified set of components (strict
+     * archetype match).
+     *
+     * @tparam Ts The component types that define the view.
+     * @return std::optional<EntityView<Ts...>> containing the view, or std::nullopt if no
+     * archetype has the exact set of requested components.
+     * @throws std::runtime_error if one or more components are not registered.
+     */
+    template <Component... Ts>
+    [[nodiscard]] std::optional<EntityView<Ts...>> viewSet()
+    {
+        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        ComponentSignature sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
+
+        auto it = m_archetypes.find(ArchetypeKey{sig, {}});
+        if (it == m_archetypes.end() || it->second->empty()) return std::nullopt;
+
+        return EntityView<Ts...>({it->second.get()}, m_componentRegistry);
+    }
+
+    /**
+     * @brief Retrieves a view of entities that have at least the specified set of components
+     * (looser archetype match).
+     *
+     * @tparam Ts The component types that define the view.
+     * @return std::optional<EntityView<Ts...>> containing the view, or std::nullopt if no
+     * archetypes have a superset of the requested components.
+     * @throws std::runtime_error if one or more components are not registered.
+     */
+    template <Component... Ts>
+    [[nodiscard]] std::optional<EntityView<Ts...>> viewSubset()
+    {
+        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        pieces::SmallVector<Archetype*, k_viewInlineArchetypes> matchingArches;
+        const detail::QueryState& state =
+            getOrCreateQuery({getSignatureFromTypes<Ts...>(m_componentRegistry),
+                              ComponentSignature(m_componentRegistry->maxCount())});
+
+        for (Archetype* arch : state.archetypes)
+        {
+            if (!arch->empty()) matchingArches.push_back(arch);
+        }
+
+        if (matchingArches.empty()) return std::nullopt;
+
+        return EntityView<Ts...>(std::move(matchingArches), m_componentRegistry);
+    }
+
+    /**
+     * @brief Retrieves a persistent query over the entities whose archetype matches the terms.
+     *
+     * Terms are plain components or detail::Read<>, Write<>, With<>, Without<> and Optional<>
+     * wrappers (see Query), e.g. `query<Read<A>, Write<B>, With<C>, Without<D>, Optional<E>>()`.
+     * The registry tests every archetype against the required and excluded signatures once, when
+     * either is created, so iterating a query costs O(matching archetypes) and never allocates.
+     * Queries with the same required and excluded sets share their state, requesting one again
+     * is a single lookup.
+     *
+     * @tparam Terms The terms that define the query.
+     * @return Query<Terms...> A handle that stays valid for the lifetime of the registry.
+     * @throws std::runtime_error if one or more components are not registered.
+     */
+    template <detail::QueryTerm... Terms>
+    [[nodiscard]] Query<Terms...> query()
+    {
+        if (!areComponentsRegistered<detail::TermComponent<Terms>...>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        // the sets of sparse terms are created up front, the query keeps pointers to them
+        (sparseSetIfSparse(m_componentRegistry->getID<detail::TermComponent<Terms>>()), ...);
+
+        return Query<Terms...>(
+            &getOrCreateQuery(detail::queryKeyFromTerms<Terms...>(m_componentRegistry)),
+            m_componentRegistry);
+    }
+
+    /**
+     * @brief Retrieves the archetype that contains the entity with the specified ID.
+     *
+     * @param _eid The ID of the entity whose archetype is to be retrieved.
+     * @return Archetype* or nullptr if the entity does not exist.
+     */
+    [[nodiscard]] Archetype* getArchetypeForEntity(EntityID _eid) const
+    {
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+
+        return record ? m_archetypeTable[record->archetype] : nullptr;
+    }
+
+    /**
+     * @brief Retrieves the components of the entity with the specified ID as a tuple of references.
+     *
+     * If the entity does not have all the specified components, std::nullopt is returned. Writes
+     * through the returned references are not stamped for change detection, see markChanged().
+     *
+     * @tparam Ts The component types to be retrieved.
+     * @param _eid The ID of the entity whose components are to be retrieved.
+     * @return std::optional<std::tuple<Ts&...>> containing references to the components, or
+     * std::nullopt if the entity does not have all specified components.
+     * @throws std::runtime_error if one or more components are not registered.
+     */
+    template <Component... Ts>
+    [[nodiscard]] std::optional<std::tuple<Ts&...>> getComponentsForEntity(EntityID _eid)
+    {
+        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return std::nullopt;
+
+        Archetype* arch = m_archetypeTable[record->archetype];
+        const ComponentSignature& archSig = arch->signature();
+
+        if (!(archSig.testBit(m_componentRegistry->getIDUnchecked<Ts>()) && ...))
+        {
+            return std::nullopt;
+        }
+
+        return std::optional<std::tuple<Ts&...>>{
+            std::in_place,
+            componentRef<Ts>(arch, record->row)...,
+        };
+    }
+
+    /**
+     * @brief Stamps the specified components of the entity as changed at the current tick.
+     *
+     * View iterations stamp the components they hand out per tick block, but random accesses
+     * such as getComponentsForEntity() do not (it would tax every lookup): writes made through
+     * them are published to Changed<> filters with this call.
+     *
+     * @tparam Ts The component types that were written.
+     * @param _eid The ID of the entity.
+     * @throws std::runtime_error if one or more components are not registered.
+     */
+    template <Component... Ts>
+    void markChanged(EntityID _eid)
+    {
+        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_eid);
+        if (!record) return;
+
+        Archetype* arch = m_archetypeTable[record->archetype];
+
+        ((arch->signature().testBit(m_componentRegistry->getIDUnchecked<Ts>())
+              ? arch->markChangedAt(record->row, m_componentRegistry->getIDUnchecked<Ts>())
+              : void()),
+         ...);
+    }
+
+    // Returns the current world tick, stamped on every write until the next advanceTick().
+    [[nodiscard]] uint32_t tick() const noexcept { return m_tick; }
+
+    /**
+     * @brief Ends the current world tick: later writes are stamped with the next one.
+     *
+     * A consumer of Changed<>/Added<> filters typically stores the returned value right after its
+     * run and passes it as the "since" tick of its next run, so it sees every write made after
+     * it (including later in the same frame) but not its own.
+     *
+     * @return The tick that just ended.
+     */
+    uint32_t advanceTick()
+    {
+        const uint32_t ended = m_tick++;
+        if (m_tick == 0) ++m_tick; // skip the reserved "never" tick on wrap-around
+
+        for (Archetype* arch : m_archetypeTable) arch->setCurrentTick(m_tick);
+
+        return ended;
+    }
+
+    /**
+     * @brief Checks if the entity with the specified metadata is valid (exists and generation
+     * matches).
+     *
+     * @param _meta The metadata of the entity to be checked.
+     * @return true if the entity is valid, false otherwise.
+     */
+    [[nodiscard]] bool isEntityValid(EntityMeta _meta) const
+    {
+        const EntityRecord* record = m_EntityAllocationHelper.findRecord(_meta.id);
+
+        return record && record->gen == _meta.gen;
+    }
+
+    // Returns the total number of entities in the registry.
+    [[nodiscard]] size_t entityCount() const { return m_EntityAllocationHelper.aliveCount(); }
+
+    // Returns the total number of archetypes in the registry.
+    [[nodiscard]] size_t archetypeCount() const { return m_archetypes.size(); }
+
+    // Returns the number of distinct queries registered (including those created by viewSubset).
+    [[nodiscard]] size_t queryCount() const { return m_queries.size(); }
+
+    // Returns the storage mode used for newly created archetypes.
+    [[nodiscard]] ArchetypeStorageMode storageMode() const { return m_storageMode; }
+
+    // Returns the total memory usage of all archetypes in bytes.
+    [[nodiscard]] size_t totalMemoryUsageInBytes() const
+    {
+        size_t total = 0;
+
+        for (const auto& [key, arch] : m_archetypes)
+        {
+            total += arch->memoryUsageInBytes();
+        }
+
+        return total;
+    }
+
+   private:
+    /**
+     * @brief Resolves the transition graph edge followed by entities of the given archetype when
+     * adding and removing the specified components.
+     *
+     * Single-component changes go through the add/remove edges of the source archetype, so after
+     * the first call they cost one hash lookup on a ComponentID. Multi-component changes compute
+     * the destination signature and reuse the cached copy plan towards that archetype.
+     */
+    template <Component... AddComponents, Component... RemoveComponents>
+    ArchetypeEdge& resolveEdge(Archetype* _src, detail::Add<AddComponents...>,
+                               detail::Remove<RemoveComponents...>)
+    {
+        constexpr size_t addCount = sizeof...(AddComponents);
+        constexpr size_t removeCount = sizeof...(RemoveComponents);
+
+        if constexpr (addCount == 1 && removeCount == 0)
+        {
+            return resolveSingleEdge(_src, (m_componentRegistry->getID<AddComponents>(), ...),
+                                     true);
+        }
+        else if constexpr (addCount == 0 && removeCount == 1)
+        {
+            return resolveSingleEdge(_src, (m_componentRegistry->getID<RemoveComponents>(), ...),
+                                     false);
+        }
+        else
+        {
+            ComponentSignature sig = _src->signature();
+            (sig.setBit(m_componentRegistry->getID<AddComponents>()), ...);
+            (sig.clearBit(m_componentRegistry->getID<RemoveComponents>()), ...);
+
+            return _src->edgeTo(getOrCreateArchetype(sig, _src), m_componentRegistry);
+        }
+    }
+
+    // Follows the add (or remove) edge of a single component, linking it on first use.
+    ArchetypeEdge& resolveSingleEdge(Archetype* _src, ComponentID _compID, bool _add)
+    {
+        ArchetypeEdge* edge = _add ? _src->findAddEdge(_compID) : _src->findRemoveEdge(_compID);
+        if (edge) return *edge;
+
+        ComponentSignature sig = _src->signature();
+        if (_add) sig.setBit(_compID);
+        else sig.clearBit(_compID);
+
+        Archetype* target = getOrCreateArchetype(sig, _src);
+
+        return _add ? _src->linkAddEdge(_compID, target, m_componentRegistry)
+                    : _src->linkRemoveEdge(_compID, target, m_componentRegistry);
+    }
+
+    // Builds the signature of the given component IDs.
+    [[nodiscard]] ComponentSignature
+    signatureFromIDs(std::span<const ComponentID> _components) const
+    {
+        ComponentSignature sig(m_componentRegistry->maxCount());
+
+        for (ComponentID id : _components)
+        {
+            if (!m_componentRegistry->isRegistered(id))
+            {
+                throw std::runtime_error("One or more components are not registered.");
+            }
+
+            sig.setBit(id);
+        }
+
+        return sig;
+    }
+
+    // Copies (or zeroes if _value is null) a component of the given row, tags and shared
+    // components have nothing to initialize.
+    void initializeRawComponent(Archetype* _arch, size_t _row, ComponentID _compID,
+                                const void* _value)
+    {
+        const ComponentMeta& info = m_componentRegistry->info(_compID);
+        if (!info.hasRowStorage()) return;
+
+        Byte* dest = _arch->componentAt(_row, _compID);
+        if (_value) std::memcpy(dest, _value, info.size);
+        else std::memset(dest, 0, info.size);
+    }
+
+    // Returns the raw column of a component over a chunk (chunked) or every row (interleaved).
+    [[nodiscard]] RawColumn rawColumnOf(Archetype* _arch, size_t _chunk, ComponentID _compID) const
+    {
+        if (Byte* shared = _arch->sharedValue(_compID)) return {shared, 0};
+
+        const ComponentMeta& info = m_componentRegistry->info(_compID);
+        if (info.size == 0) return {nullptr, 0};
+        if (_arch->isChunked()) return {_arch->chunkColumn(_chunk, _compID), info.size};
+
+        return {_arch->data() + _arch->componentOffset(_compID), _arch->stride()};
+    }
+
+    // Same as getOrCreateArchetype(), but short-circuits to _src when the signature is unchanged.
+    Archetype* getOrCreateArchetype(const ComponentSignature& _signature, Archetype* _src)
+    {
+        if (_signature == _src->signature()) return _src;
+
+        // shared values follow the entity unless their component is removed
+        ArchetypeKey key{_signature, {}};
+        for (const SharedComponentValue& shared : _src->sharedValues())
+        {
+            if (_signature.testBit(shared.id)) key.sharedValues.push_back(shared);
+        }
+
+        return getOrCreateArchetype(std::move(key),
+                                    calculateStrideFromSignature(m_componentRegistry, _signature));
+    }
+
+    // Records that the entity lives at the given row of the given archetype.
+    void placeEntity(EntityID _eid, const Archetype* _arch, size_t _row)
+    {
+        m_EntityAllocationHelper.setLocation(_eid, _arch->index(), static_cast<uint32_t>(_row));
+    }
+
+    // Constructs the added components of the rows migrated to _arch from _firstRow on, and
+    // records the new entity locations.
+    template <Component... AddComponents, typename RowRanges>
+    void placeMigratedRows(Archetype* _arch, size_t _firstRow, RowRanges& _rowRanges)
+    {
+        const std::vector<EntityID>& eids = _arch->entityIDs();
+
+        _rowRanges(eids.size() - _firstRow,
+                   [&](size_t _first, size_t _last)
+                   {
+                       for (size_t row = _firstRow + _first; row < _firstRow + _last; ++row)
+                       {
+                           // placement-new each added component at its offset
+                           (constructComponent<AddComponents>(_arch, row), ...);
+                           placeEntity(eids[row], _arch, row);
+                       }
+                   });
+    }
+
+    // Checks if the entities of a group (alive in _arch, possibly repeated) are all of its
+    // entities, one pass over their records.
+    bool coversArchetype(const Archetype* _arch, const std::vector<EntityID>& _eids) const
+    {
+        if (_eids.size() < _arch->size()) return false;
+
+        std::vector<bool> listed(_arch->size());
+        size_t distinct = 0;
+
+        for (EntityID eid : _eids)
+        {
+            const uint32_t row = m_EntityAllocationHelper.findRecord(eid)->row;
+            if (!listed[row])
+            {
+                listed[row] = true;
+                ++distinct;
+            }
+        }
+
+        return distinct == _arch->size();
+    }
+
+    // Body of migrateArchetypeModifyComponents(), _rowRanges splitting the row copies.
+    template <Component... SourceComponents, Component... AddComponents,
+              Component... RemoveComponents, typename RowRanges>
+    size_t migrateArchetypeInRanges(detail::From<SourceComponents...>,
+                                    detail::Add<AddComponents...>,
+                                    detail::Remove<RemoveComponents...>, RowRanges&& _rowRanges)
+    {
+        static_assert(sizeof...(SourceComponents) > 0,
+                      "Source archetype must specify at least one component");
+
+        // Verify components are registered (guard empty packs)
+        if (!areComponentsRegistered<SourceComponents...>(m_componentRegistry) ||
+            (sizeof...(AddComponents) > 0 &&
+             !areComponentsRegistered<AddComponents...>(m_componentRegistry)) ||
+            (sizeof...(RemoveComponents) > 0 &&
+             !areComponentsRegistered<RemoveComponents...>(m_componentRegistry)))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        // Source signature & archetype lookup
+        ComponentSignature srcSig = getSignatureFromTypes<SourceComponents...>(m_componentRegistry);
+
+        auto srcIt = m_archetypes.find(ArchetypeKey{srcSig, {}});
+        if (srcIt == m_archetypes.end() || srcIt->second->empty()) return 0;
+
+        Archetype* srcArch = srcIt->second.get();
+
+        // Compute destination signature: set bits for Add, clear bits for Remove
+        ComponentSignature destSig = srcSig;
+        (destSig.setBit(m_componentRegistry->getID<AddComponents>()), ...);
+        (destSig.clearBit(m_componentRegistry->getID<RemoveComponents>()), ...);
+
+        if (srcSig == destSig) return 0; // nothing to do
+
+        // Ensure destination archetype exists
+        size_t destStride = calculateStrideFromSignature(m_componentRegistry, destSig);
+        Archetype* dstArch = getOrCreateArchetype(destSig, destStride);
+
+        // the rows of the source archetype are handed to observers as is
+        m_observers.notify(ComponentEvent::removed,
+                           observedDifference(ComponentEvent::removed, srcArch, dstArch),
+                           srcArch->entityIDs());
+
+        // Count and migrate (migrated entities are appended to the destination rows)
+        size_t count = srcArch->size();
+        const size_t firstRow = dstArch->size();
+        srcArch->migrateAllTo(*dstArch, m_componentRegistry, _rowRanges);
+        placeMigratedRows<AddComponents...>(dstArch, firstRow, _rowRanges);
+
+        m_observers.notify(ComponentEvent::added,
+                           observedDifference(ComponentEvent::added, dstArch, srcArch),
+                           std::span(dstArch->entityIDs()).subspan(firstRow));
+
+        return count;
+    }
+
+    // The row ranges of parallel bulk operations (see InlineRowRanges): batches of
+    // k_parallelBulkMinEntities or more are split into tasks of k_parallelBulkGrainSize rows.
+    template <detail::TaskPool Pool>
+    [[nodiscard]] static auto poolRowRanges(Pool& _pool)
+    {
+        return [&_pool](size_t _count, auto&& _body)
+        {
+            if (_count < k_parallelBulkMinEntities)
+            {
+                _body(size_t{0}, _count);
+                return;
+            }
+
+            const size_t tasks = (_count + k_parallelBulkGrainSize - 1) / k_parallelBulkGrainSize;
+            detail::dispatchTasks(_pool, tasks,
+                                  [&](size_t _task)
+                                  {
+                                      const size_t first = _task * k_parallelBulkGrainSize;
+                                      _body(first,
+                                            std::min(_count, first + k_parallelBulkGrainSize));
+                                  });
+        };
+    }
+
+    /**
+     * @brief Creates _count entities of the signature of Ts...: IDs and rows are allocated at
+     * once, then every range of rows is initialized by _construct(arch, row) and recorded.
+     * Ranges may run concurrently, on disjoint rows and entity records.
+     */
+    template <Component... Ts, typename RowRanges, typename Construct>
+    std::vector<EntityMeta> createEntitiesInRanges(size_t _count, RowRanges&& _rowRanges,
+                                                   Construct&& _construct)
+    {
+        if (_count == 0) return {};
+
+        if (!areComponentsRegistered<Ts...>(m_componentRegistry))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        auto sig = getSignatureFromTypes<Ts...>(m_componentRegistry);
+        auto stride = calculateStrideFromSignature(m_componentRegistry, sig);
+
+        // Get or create archetype (before allocating IDs as creation may throw)
+        Archetype* arch = getOrCreateArchetype(sig, stride);
+
+        // Allocate all entity IDs upfront
+        std::vector<EntityMeta> metas = m_EntityAllocationHelper.getIDBulk(_count);
+
+        // Extract just the IDs for bulk insert
+        std::vector<EntityID> eids;
+        eids.reserve(_count);
+        for (const auto& meta : metas)
+        {
+            eids.push_back(meta.id);
+        }
+
+        // Allocate uninitialized storage for all entities
+        const size_t firstRow = arch->emplaceBulkUninitialized(eids.data(), _count);
+
+        _rowRanges(_count,
+                   [&](size_t _first, size_t _last)
+                   {
+                       for (size_t i = _first; i < _last; ++i)
+                       {
+                           const size_t row = firstRow + i;
+
+                           new (arch->metaAt(row)) EntityMeta{metas[i]};
+                           _construct(arch, row);
+                           placeEntity(metas[i].id, arch, row);
+                       }
+                   });
+
+        m_observers.notify(ComponentEvent::added, sig, eids);
+
+        return metas;
+    }
+
+    /**
+     * @brief Body of modifyComponentsBulk(), _rowRanges deciding how the archetypes entirely
+     * covered by the batch are migrated (see modifyComponentsBulk(Pool&, ...)).
+     */
+    template <Component... AddComponents, Component... RemoveComponents, typename RowRanges>
+    std::vector<EntityID> modifyComponentsInRanges(detail::Add<AddComponents...>,
+                                                   detail::Remove<RemoveComponents...>,
+                                                   const std::vector<EntityID>& _eids,
+                                                   RowRanges&& _rowRanges)
+    {
+        if (_eids.empty()) return {};
+
+        // validate registrations (guard empty packs)
+        if ((sizeof...(AddComponents) > 0 &&
+             !areComponentsRegistered<AddComponents...>(m_componentRegistry)) ||
+            (sizeof...(RemoveComponents) > 0 &&
+             !areComponentsRegistered<RemoveComponents...>(m_componentRegistry)))
+        {
+            throw std::runtime_error("One or more components are not registered.");
+        }
+
+        std::vector<EntityID> notFound;
+        std::unordered_map<Archetype*, std::vector<EntityID>> archetypeGroups;
+
+        // Group entities by their current archetype (skip missing)
+        for (EntityID eid : _eids)
+        {
+            const EntityRecord* record = m_EntityAllocationHelper.findRecord(eid);
+            if (!record)
+            {
+                notFound.push_back(eid);
+            }
+            else
+            {
+                archetypeGroups[m_archetypeTable[record->archetype]].push_back(eid);
+            }
+        }
+
+        // observers see every entity losing a component at once, before any of them moved
+        if (m_observers.observed(ComponentEvent::removed).any())
+        {
+            detail::ObserverBatch removed;
+            for (auto& [srcArch, eids] : archetypeGroups)
+            {
+                const Archetype* dstArch = resolveEdge(srcArch, detail::Add<AddComponents...>{},
+                                                       detail::Remove<RemoveComponents...>{})
+                                               .target;
+
+                removed.add(observedDifference(ComponentEvent::removed, srcArch, dstArch), eids);
+            }
+
+            removed.deduplicate();
+            m_observers.notify(ComponentEvent::removed, removed);
+        }
+
+        detail::ObserverBatch added;
+        std::vector<EntityID> moved;
+
+        // Process each group
+        for (auto& [srcArch, eids] : archetypeGroups)
+        {
+            const ArchetypeEdge& edge = resolveEdge(srcArch, detail::Add<AddComponents...>{},
+                                                    detail::Remove<RemoveComponents...>{});
+
+            Archetype* dstArch = edge.target;
+            if (dstArch == srcArch) continue; // nothing to do for this archetype
+
+            const ComponentSignature gained =
+                observedDifference(ComponentEvent::added, dstArch, srcArch);
+            moved.clear();
+
+            // split runners move whole archetypes at once, rows copied by ranges
+            if constexpr (!std::is_same_v<std::decay_t<RowRanges>, InlineRowRanges>)
+            {
+                if (coversArchetype(srcArch, eids))
+                {
+                    const size_t firstRow = dstArch->size();
+                    srcArch->migrateAllTo(*dstArch, m_componentRegistry, _rowRanges);
+                    placeMigratedRows<AddComponents...>(dstArch, firstRow, _rowRanges);
+
+                    if (gained.any())
+                    {
+                        added.add(gained, std::span(dstArch->entityIDs()).subspan(firstRow));
+                    }
+                    continue;
+                }
+            }
+
+            for (EntityID eid : eids)
+            {
+                // rows shift as the group migrates, so the record is re-read for every entity
+                const EntityRecord* record = m_EntityAllocationHelper.findRecord(eid);
+                if (record->archetype != srcArch->index()) continue; // duplicate ID, already moved
+
+                const size_t oldRow = record->row;
+                const size_t row = srcArch->moveAlong(eid, edge);
+                patchSwappedRow(srcArch, oldRow);
+
+                // Default-construct newly added components
+                if constexpr (sizeof...(AddComponents) > 0)
+                {
+                    (constructComponent<AddComponents>(dstArch, row), ...);
+                }
+
+                placeEntity(eid, dstArch, row);
+                if (gained.any()) moved.push_back(eid);
+            }
+
+            added.add(gained, moved);
+        }
+
+        m_observers.notify(ComponentEvent::added, added);
+
+        return notFound;
+    }
+
+
+    // Returns the component of the given row (the shared instance for tags, the archetype's
+    // value for shared components).
+    template <Component T>
+    [[nodiscard]] T& componentRef(Archetype* _arch, size_t _row) const
+    {
+        if constexpr (TagComponent<T>)
+        {
+            return detail::tagInstance<T>();
+        }
+        else
+        {
+            const ComponentID id = m_componentRegistry->getIDUnchecked<T>();
+            Byte* shared = _arch->sharedValue(id);
+
+            return *reinterpret_cast<T*>(shared ? shared : _arch->componentAt(_row, id));
+        }
+    }
+
+    // Constructs a component of the given row in place from an argument tuple (tags have no
+    // storage, so there is nothing to construct).
+    template <Component T, typename ArgTuple = std::tuple<>>
+    void constructComponent(Archetype* _arch, size_t _row, ArgTuple&& _args = {})
+    {
+        if constexpr (!TagComponent<T>)
+        {
+            Byte* dest = _arch->componentAt(_row, m_componentRegistry->getID<T>());
+            std::apply([&](auto&&... args)
+                       { new (dest) T(std::forward<decltype(args)>(args)...); },
+                       std::forward<ArgTuple>(_args));
+        }
+    }
+
+    // Fixes the record of the entity that swap-and-pop moved into the freed row of _arch.
+    void patchSwappedRow(Archetype* _arch, size_t _row)
+    {
+        if (_row < _arch->size())
+        {
+            m_EntityAllocationHelper.setRow(_arch->entityIDs()[_row], static_cast<uint32_t>(_row));
+        }
+    }
+
+    // Removes the entity stored at _row of _arch, keeping the swapped entity's record in sync.
+    void eraseRow(Archetype* _arch, EntityID _eid, size_t _row)
+    {
+        _arch->remove(_eid);
+        patchSwappedRow(_arch, _row);
+    }
+
+    // Retrieves an existing archetype without shared values by signature or creates it.
+    Archetype* getOrCreateArchetype(ComponentSignature _signature, size_t _stride)
+    {
+        return getOrCreateArchetype(ArchetypeKey{std::move(_signature), {}}, _stride);
+    }
+
+    /**
+     * @brief Retrieves an existing archetype by key or creates a new one if it doesn't exist.
+     *
+     * @throws std::runtime_error if a shared component of the signature has no value in the key
+     * (shared components are only given one through setSharedComponent()).
+     */
+    Archetype* getOrCreateArchetype(ArchetypeKey _key, size_t _stride)
+    {
+        if (auto it = m_archetypes.find(_key); it != m_archetypes.end()) return it->second.get();
+
+        const ComponentSignature& signature = _key.signature;
+
+        size_t sharedCount = 0;
+        for (ComponentID id = 0; id < m_componentRegistry->count(); ++id)
+        {
+            if (!signature.testBit(id)) continue;
+
+            const ComponentMeta& info = m_componentRegistry->info(id);
+            if (info.shared) ++sharedCount;
+            if (info.sparse)
+            {
+                throw std::runtime_error(
+                    "Sparse components must be added through addSparseComponent().");
+            }
+        }
+
+        if (sharedCount != _key.sharedValues.size())
+        {
+            throw std::runtime_error("Shared components must be set through setSharedComponent().");
+        }
+
+        ComponentOffsets componentOffsets;
+
+        // registered static layouts replace the one derived from the signature
+        if (auto it = m_staticLayouts.find(signature); it != m_staticLayouts.end())
+        {
+            componentOffsets = it->second.offsets;
+            _stride = it->second.stride;
+        }
+        else
+        {
+            componentOffsets = getComponentOffsetsInBytesFromSignature(m_componentRegistry,
+                                                                       signature);
+        }
+
+        std::unique_ptr<Archetype> arch;
+
+        if (m_storageMode == ArchetypeStorageMode::interleaved)
+        {
+            arch = std::make_unique<Archetype>(signature, _stride, std::move(componentOffsets),
+                                               m_storageAllocator);
+        }
+        else
+        {
+            std::vector<std::pair<ComponentID, TypelessChunkedStorage<>::ColumnLayout>> layouts;
+
+            for (ComponentID id = 0; id < m_componentRegistry->count(); ++id)
+            {
+                const auto& info = m_componentRegistry->info(id);
+                if (!signature.testBit(id) || !info.hasRowStorage()) continue;
+
+                layouts.push_back({id, {info.size, info.alignment}});
+            }
+
+            arch = std::make_unique<Archetype>(
+                signature, _stride, componentOffsets, m_storageMode, layouts,
+                TypelessChunkedStorage<>::k_defaultChunkSizeInBytes, m_splitThresholdInBytes,
+                m_chunkArena, m_storageAllocator);
+        }
+
+        arch->setIndex(static_cast<uint32_t>(m_archetypeTable.size()));
+        arch->setCurrentTick(m_tick);
+        arch->setSharedValues(_key.sharedValues);
+        m_archetypeTable.push_back(arch.get());
+
+        for (auto& [queryKey, state] : m_queries)
+        {
+            if (queryKey.matches(signature)) state->archetypes.push_back(arch.get());
+        }
+
+        return (m_archetypes[std::move(_key)] = std::move(arch)).get();
+    }
+
+    // Destroys an empty archetype after unlinking it from the transition graph and the queries.
+    void destroyArchetype(Archetype* _arch)
+    {
+        const ArchetypeKey key = _arch->key();
+        const ComponentSignature& signature = key.signature;
+
+        for (Archetype* other : m_archetypeTable) other->unlinkEdgesTo(_arch);
+
+        for (auto& [queryKey, state] : m_queries)
+        {
+            if (queryKey.matches(signature)) std::erase(state->archetypes, _arch);
+        }
+
+        // swap-and-pop the table slot, the moved archetype's entities follow it
+        const uint32_t index = _arch->index();
+        Archetype* last = m_archetypeTable.back();
+
+        if (last != _arch)
+        {
+            m_archetypeTable[index] = last;
+            last->setIndex(index);
+
+            const auto& eids = last->entityIDs();
+            for (size_t row = 0; row < eids.size(); ++row) placeEntity(eids[row], last, row);
+        }
+
+        m_archetypeTable.pop_back();
+        m_archetypes.erase(key);
+    }
+
+    // Retrieves the state of the query with the given key, registering it if needed.
+    detail::QueryState& getOrCreateQuery(const detail::QueryKey& _key)
+    {
+        if (auto it = m_queries.find(_key); it != m_queries.end()) return *it->second;
+
+        auto state = std::make_unique<detail::QueryState>(detail::QueryState{_key, {}});
+
+        state->sparse.storage = &m_sparseStorage;
+        for (ComponentID id : _key.sparseRequired)
+        {
+            state->sparse.required.push_back(sparseSetIfSparse(id));
+        }
+        for (ComponentID id : _key.sparseExcluded)
+        {
+            state->sparse.excluded.push_back(sparseSetIfSparse(id));
+        }
+
+        for (Archetype* arch : m_archetypeTable)
+        {
+            if (_key.matches(arch->signature())) state->archetypes.push_back(arch);
+        }
+
+        return *(m_queries[_key] = std::move(state));
+    }
+
+    // Returns the set of the component if it is sparse (created on first use), nullptr otherwise.
+    detail::SparseComponentSet* sparseSetIfSparse(ComponentID _id)
+    {
+        const ComponentMeta& info = m_componentRegistry->info(_id);
+        return info.sparse ? &m_sparseStorage.getOrCreate(_id, info.size) : nullptr;
+    }
+
+    // Returns the set of the sparse component T.
+    template <Component T>
+    [[nodiscard]] detail::SparseComponentSet& sparseSetOf()
+    {
+        const ComponentID id = m_componentRegistry->getID<T>();
+        detail::SparseComponentSet* set = sparseSetIfSparse(id);
+        if (!set) throw std::runtime_error("Component is not registered as sparse.");
+
+        return *set;
+    }
+
+    template <typename R>
+    [[nodiscard]] detail::RelationIndex& relationIndex()
+    {
+        detail::RelationIndex* index = m_relations.find(detail::componentTypeSlot<R>());
+        if (!index) throw std::runtime_error("Relation is not registered.");
+
+        return *index;
+    }
+
+    template <typename R>
+    [[nodiscard]] const detail::RelationIndex& relationIndex() const
+    {
+        const detail::RelationIndex* index = m_relations.find(detail::componentTypeSlot<R>());
+        if (!index) throw std::runtime_error("Relation is not registered.");
+
+        return *index;
+    }
+
+    // Destroys the entities in one batch, without looking at relations (see destroyEntityBulk()).
+    std::vector<EntityID> destroyEntities(const std::vector<EntityID>& _eids)
+    {
+        std::vector<EntityID> notFound;
+
+        // observers see every destroyed entity at once, before any of them is gone
+        if (m_observers.observed(ComponentEvent::removed).any())
+        {
+            detail::ObserverBatch batch;
+            for (EntityID eid : _eids)
+            {
+                const EntityRecord* record = m_EntityAllocationHelper.findRecord(eid);
+                if (!record) continue;
+
+                batch.add(m_archetypeTable[record->archetype]->signature() &
+                              m_observers.observed(ComponentEvent::removed),
+                          {&eid, 1});
+            }
+
+            batch.deduplicate();
+            m_observers.notify(ComponentEvent::removed, batch);
+        }
+
+        for (EntityID eid : _eids)
+        {
+            const EntityRecord* record = m_EntityAllocationHelper.findRecord(eid);
+            if (!record)
+            {
+                notFound.push_back(eid);
+                continue;
+            }
+
+            eraseRow(m_archetypeTable[record->archetype], eid, record->row);
+            m_EntityAllocationHelper.freeID(eid);
+            if (!m_sparseStorage.empty()) m_sparseStorage.erase(eid);
+        }
+
+        return notFound;
+    }
+
+    // Drops every entity and archetype without notifying observers.
+    void clearStorage()
+    {
+        m_EntityAllocationHelper.reset();
+        m_archetypeTable.clear();
+        m_archetypes.clear();
+        m_sharedValueTables.clear();
+        m_relations.clearPairs();
+        m_sparseStorage.clear();
+        m_compactionCursor = 0;
+
+        // Queries outlive clear(), they simply match nothing until archetypes are recreated
+        for (auto& [sig, state] : m_queries) state->archetypes.clear();
+    }
+
+    // Returns the observed components (for the event) the first archetype has and the other lacks.
+    [[nodiscard]] ComponentSignature observedDifference(ComponentEvent _event,
+                                                        const Archetype* _has,
+                                                        const Archetype* _lacks) const
+    {
+        const ComponentSignature& has = _has->signature();
+        return ((has ^ _lacks->signature()) & has) & m_observers.observed(_event);
+    }
+
+    // Notifies the observers of the components the first archetype has and the other lacks.
+    void notifyDifference(ComponentEvent _event, const Archetype* _has, const Archetype* _lacks,
+                          std::span<const EntityID> _eids) const
+    {
+        if (m_observers.empty()) return;
+
+        m_observers.notify(_event, observedDifference(_event, _has, _lacks), _eids);
+    }
+
+    // Sorts the archetypes owned by the group (those containing no component of an earlier one).
+    void updateGroup(size_t _group, std::optional<uint32_t> _since)
+    {
+        SortGroup& group = m_sortGroups[_group];
+
+        for (Archetype* arch : m_archetypeTable)
+        {
+            const ComponentSignature& signature = arch->signature();
+            if (!signature.testBit(group.component)) continue;
+
+            const bool owned = std::none_of(m_sortGroups.begin(), m_sortGroups.begin() + _group,
+                                            [&](const SortGroup& _other)
+                                            { return signature.testBit(_other.component); });
+
+            if (owned) group.sort(*this, arch, _since);
+        }
+    }
+
+    // Stably sorts the rows of the archetype by T. With _since, only the rows of tick blocks
+    // where T was written at that tick or later are assumed out of order: they are sorted on
+    // their own and merged with the others (fully sorted instead if the others are not sorted).
+    template <Component T, typename Compare>
+    void sortRowsBy(Archetype* _arch, Compare& _compare, std::optional<uint32_t> _since)
+    {
+        const size_t count = _arch->size();
+        const ComponentID id = m_componentRegistry->getIDUnchecked<T>();
+        if (count < 2 || _arch->sharedValue(id)) return;
+
+        auto less = [&](uint32_t _a, uint32_t _b)
+        {
+            return _compare(*reinterpret_cast<const T*>(_arch->componentAt(_a, id)),
+                            *reinterpret_cast<const T*>(_arch->componentAt(_b, id)));
+        };
+
+        std::vector<uint32_t> order(count);
+        std::vector<uint32_t> clean;
+        std::vector<uint32_t> written;
+
+        if (_since)
+        {
+            const size_t blockRows = _arch->tickBlockRows();
+
+            for (size_t block = 0; block < _arch->tickBlockCount(); ++block)
+            {
+                const uint32_t changed = _arch->columnTicks(block, id).changed;
+                auto& rows = isNewerTick(*_since, changed) ? clean : written;
+
+                const size_t end = std::min(count, (block + 1) * blockRows);
+                for (size_t row = block * blockRows; row < end; ++row)
+                {
+                    rows.push_back(static_cast<uint32_t>(row));
+                }
+            }
+
+            if (written.empty()) return;
+        }
+
+        if (_since && std::is_sorted(clean.begin(), clean.end(), less))
+        {
+            std::stable_sort(written.begin(), written.end(), less);
+            std::merge(clean.begin(), clean.end(), written.begin(), written.end(), order.begin(),
+                       less);
+        }
+        else
+        {
+            std::iota(order.begin(), order.end(), 0u);
+            std::stable_sort(order.begin(), order.end(), less);
+        }
+
+        size_t firstMoved = 0;
+        while (firstMoved < count && order[firstMoved] == firstMoved) ++firstMoved;
+        if (firstMoved == count) return;
+
+        _arch->permuteRows(order);
+
+        const auto& eids = _arch->entityIDs();
+        for (size_t row = firstMoved; row < count; ++row)
+        {
+            if (order[row] != row) placeEntity(eids[row], _arch, row);
+        }
+    }
+
+    // Writes the description, shared values and rows of a non-empty archetype.
+    void writeArchetypeSnapshot(detail::SnapshotWriter& _writer, Archetype* _arch) const
+    {
+        const ComponentSignature& signature = _arch->signature();
+        const auto& offsets = _arch->componentOffsets();
+        const size_t stride = _arch->stride();
+
+        std::vector<ComponentID> ids;
+        for (ComponentID id = 0; id < m_componentRegistry->count(); ++id)
+        {
+            if (signature.testBit(id)) ids.push_back(id);
+        }
+
+        _writer.put(detail::SnapshotArchetype{
+            static_cast<uint32_t>(ids.size()), static_cast<uint32_t>(_arch->sharedValues().size()),
+            static_cast<uint32_t>(_arch->size()), static_cast<uint32_t>(stride)});
+
+        for (ComponentID id : ids) _writer.put(static_cast<uint32_t>(id));
+        for (ComponentID id : ids)
+        {
+            auto it = offsets.find(id);
+            _writer.put(static_cast<uint32_t>(it != offsets.end() ? it->second : 0));
+        }
+
+        for (const SharedComponentValue& shared : _arch->sharedValues())
+        {
+            _writer.put(static_cast<uint32_t>(shared.id));
+            _writer.putBytes(shared.value, m_componentRegistry->info(shared.id).size);
+            _writer.align(8);
+        }
+
+        _writer.align(16);
+
+        if (!_arch->isChunked())
+        {
+            _writer.putBytes(_arch->data(), _arch->size() * stride);
+        }
+        else
+        {
+            // Gathered back into the interleaved layout, so snapshots do not depend on the mode
+            std::vector<Byte> row(stride);
+
+            for (size_t r = 0; r < _arch->size(); ++r)
+            {
+                std::memcpy(row.data(), _arch->metaAt(r), sizeof(EntityMeta));
+                for (const auto& [id, offset] : offsets)
+                {
+                    std::memcpy(row.data() + offset, _arch->componentAt(r, id),
+                                m_componentRegistry->info(id).size);
+                }
+                _writer.putBytes(row.data(), stride);
+            }
+        }
+
+        _writer.align(8);
+    }
+
+    // Component of a snapshot row resolved against the component registry.
+    struct SnapshotColumn
+    {
+        ComponentID id;
+        size_t srcOffset;
+        size_t size;
+    };
+
+    // The components of a snapshot matched with the registered ones.
+    struct SnapshotComponents
+    {
+        static constexpr ComponentID k_invalidComponent = std::numeric_limits<ComponentID>::max();
+
+        std::vector<ComponentID> remap; // snapshot ComponentID -> registry ComponentID
+        std::vector<std::string_view> names;
+
+        [[nodiscard]] ComponentID resolve(uint32_t _srcID) const
+        {
+            if (_srcID >= remap.size()) throw std::runtime_error("Snapshot is malformed.");
+            if (remap[_srcID] == k_invalidComponent)
+            {
+                throw std::runtime_error("Snapshot component '" + std::string(names[_srcID]) +
+                                         "' is not registered.");
+            }
+            return remap[_srcID];
+        }
+    };
+
+    // An archetype section of a snapshot, its rows read in place.
+    struct SnapshotRows
+    {
+        Archetype* arch;
+        const uint8_t* rows;
+        size_t count;
+        size_t srcStride;
+        std::vector<SnapshotColumn> columns;
+        bool verbatim; // the layouts match, rows are copied whole
+    };
+
+    static detail::SnapshotHeader readSnapshotHeader(detail::SnapshotReader& _reader)
+    {
+        const auto header = _reader.get<detail::SnapshotHeader>();
+        if (header.magic != detail::k_snapshotMagic || header.version != detail::k_snapshotVersion)
+        {
+            throw std::runtime_error("Not an entity snapshot, or unsupported snapshot version.");
+        }
+        return header;
+    }
+
+    SnapshotComponents readSnapshotComponents(detail::SnapshotReader& _reader,
+                                              const detail::SnapshotHeader& _header) const
+    {
+        // Names are not unique (e.g. instances of a template), the n-th component of a name in the
+        // snapshot is matched with the n-th registered under that name
+        std::unordered_map<std::string_view, std::vector<ComponentID>> idsByName;
+        for (ComponentID id = static_cast<ComponentID>(m_componentRegistry->count()); id-- > 0;)
+        {
+            idsByName[m_componentRegistry->info(id).name].push_back(id);
+        }
+
+        SnapshotComponents components;
+        components.remap.assign(_header.componentCount, SnapshotComponents::k_invalidComponent);
+        components.names.resize(_header.componentCount);
+
+        for (uint32_t i = 0; i < _header.componentCount; ++i)
+        {
+            const auto component = _reader.get<detail::SnapshotComponent>();
+            components.names[i] = {
+                reinterpret_cast<const char*>(_reader.getBytes(component.nameLength)),
+                component.nameLength};
+            _reader.align(8);
+
+            auto it = idsByName.find(components.names[i]);
+            if (it == idsByName.end() || it->second.empty()) continue;
+
+            const ComponentID id = it->second.back();
+            it->second.pop_back();
+
+            const ComponentMeta& info = m_componentRegistry->info(id);
+            if (info.size != component.size || info.alignment != component.alignment ||
+                info.shared != (component.shared != 0))
+            {
+                throw std::runtime_error("Snapshot component '" +
+                                         std::string(components.names[i]) +
+                                         "' does not match its registration.");
+            }
+            components.remap[i] = id;
+        }
+
+        return components;
+    }
+
+    // Reads the description of the next archetype section, creates its archetype and skips its
+    // rows.
+    SnapshotRows readSnapshotArchetype(detail::SnapshotReader& _reader,
+                                       const SnapshotComponents& _components)
+    {
+        const auto desc = _reader.get<detail::SnapshotArchetype>();
+        const uint8_t* srcIDs = _reader.getBytes(desc.componentCount * sizeof(uint32_t));
+        const uint8_t* srcOffsets = _reader.getBytes(desc.componentCount * sizeof(uint32_t));
+
+        SnapshotRows section{};
+        ComponentSignature signature(m_componentRegistry->maxCount());
+
+        for (uint32_t c = 0; c < desc.componentCount; ++c)
+        {
+            uint32_t srcID = 0;
+            uint32_t srcOffset = 0;
+            std::memcpy(&srcID, srcIDs + c * sizeof(uint32_t), sizeof(uint32_t));
+            std::memcpy(&srcOffset, srcOffsets + c * sizeof(uint32_t), sizeof(uint32_t));
+
+            const ComponentID id = _components.resolve(srcID);
+            const ComponentMeta& info = m_componentRegistry->info(id);
+            signature.setBit(id);
+
+            if (!info.hasRowStorage()) continue;
+            if (srcOffset < sizeof(EntityMeta) || srcOffset + info.size > desc.stride)
+            {
+                throw std::runtime_error("Snapshot is malformed.");
+            }
+            section.columns.push_back({id, srcOffset, info.size});
+        }
+
+        std::vector<SharedComponentValue> sharedValues;
+        for (uint32_t s = 0; s < desc.sharedCount; ++s)
+        {
+            const ComponentID id = _components.resolve(_reader.get<uint32_t>());
+            const size_t size = m_componentRegistry->info(id).size;
+
+            SharedValueTable& table = m_sharedValueTables.try_emplace(id, size).first->second;
+            const uint32_t index = table.intern(_reader.getBytes(size));
+            sharedValues.push_back({id, index, table.at(index)});
+            _reader.align(8);
+        }
+        std::sort(sharedValues.begin(), sharedValues.end(),
+                  [](const SharedComponentValue& _a, const SharedComponentValue& _b)
+                  { return _a.id < _b.id; });
+
+        _reader.align(16);
+        section.srcStride = desc.stride;
+        if (section.srcStride < sizeof(EntityMeta))
+        {
+            throw std::runtime_error("Snapshot is malformed.");
+        }
+
+        section.count = desc.entityCount;
+        section.rows = _reader.getBytes(section.count * section.srcStride);
+        _reader.align(8);
+
+        const size_t stride = calculateStrideFromSignature(m_componentRegistry, signature);
+        section.arch = getOrCreateArchetype(ArchetypeKey{signature, sharedValues}, stride);
+
+        // Identical layouts (the common case, same registration order) are inserted verbatim
+        const auto& offsets = section.arch->componentOffsets();
+        section.verbatim =
+            !section.arch->isChunked() && section.arch->stride() == section.srcStride;
+        for (const SnapshotColumn& column : section.columns)
+        {
+            section.verbatim = section.verbatim && offsets.at(column.id) == column.srcOffset;
+        }
+
+        return section;
+    }
+
+    // Inserts _count rows of a section from _firstRow (EntityMeta included) as the entities _eids,
+    // returns the archetype row of the first one.
+    static size_t copySnapshotRows(const SnapshotRows& _section, const EntityID* _eids,
+                                   size_t _firstRow, size_t _count)
+    {
+        Archetype* arch = _section.arch;
+        const uint8_t* rows = _section.rows + _firstRow * _section.srcStride;
+
+        if (_section.verbatim)
+        {
+            const size_t first = arch->size();
+            arch->insertBulk(_eids, rows, _count);
+            return first;
+        }
+
+        const size_t first = arch->emplaceBulkUninitialized(_eids, _count);
+        for (size_t r = 0; r < _count; ++r)
+        {
+            const uint8_t* src = rows + r * _section.srcStride;
+            std::memcpy(arch->metaAt(first + r), src, sizeof(EntityMeta));
+
+            for (const SnapshotColumn& column : _section.columns)
+            {
+                std::memcpy(arch->componentAt(first + r, column.id), src + column.srcOffset,
+                            column.size);
+            }
+        }
+        return first;
+    }
+
+    void readSnapshotSections(std::span<const uint8_t> _data)
+    {
+        detail::SnapshotReader reader(_data);
+
+        const auto header = readSnapshotHeader(reader);
+        const SnapshotComponents components = readSnapshotComponents(reader, header);
+
+        std::vector<EntityGen> gens(header.recordCount);
+        std::memcpy(gens.data(), reader.getBytes(gens.size() * sizeof(EntityGen)),
+                    gens.size() * sizeof(EntityGen));
+        reader.align(8);
+
+        m_EntityAllocationHelper.restoreGenerations(gens);
+
+        std::vector<EntityID> eids;
+
+        for (uint32_t a = 0; a < header.archetypeCount; ++a)
+        {
+            const SnapshotRows section = readSnapshotArchetype(reader, components);
+
+            eids.resize(section.count);
+            for (size_t r = 0; r < section.count; ++r)
+            {
+                EntityMeta meta;
+                std::memcpy(&meta, section.rows + r * section.srcStride, sizeof(EntityMeta));
+
+                if (meta.id >= gens.size() || gens[meta.id] != meta.gen)
+                {
+                    throw std::runtime_error("Snapshot is malformed.");
+                }
+                eids[r] = meta.id;
+            }
+
+            for (EntityID eid : eids)
+            {
+                if (m_EntityAllocationHelper.findRecord(eid))
+                {
+                    throw std::runtime_error("Snapshot is malformed.");
+                }
+            }
+
+            const size_t first = copySnapshotRows(section, eids.data(), 0, eids.size());
+            for (size_t r = 0; r < eids.size(); ++r) placeEntity(eids[r], section.arch, first + r);
+        }
 
-        return m_archetypes.at(_signature).get();
+        m_EntityAllocationHelper.rebuildFreeList();
     }
 };
 
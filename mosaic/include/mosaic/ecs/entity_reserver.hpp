@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "entity.hpp"
+#include "entity_registry.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+/**
+ * @brief The 'EntityReserver' class caches a block of reserved entity handles for the thread that
+ * owns it, so reserving costs one atomic operation per k_blockSize handles instead of one per
+ * handle.
+ *
+ * Each worker keeps its own reserver (e.g. alongside its EntityCommandBuffer), reserve() is then
+ * free of any synchronization until the block runs out. Recycled IDs are handed out before fresh
+ * ones, by blocks.
+ *
+ * @note Handles left in the cache stay reserved: keep the reserver across frames, or give them
+ * back with release() at a sync point.
+ */
+class EntityReserver final
+{
+   public:
+    // Number of handles reserved at once when the cache runs out.
+    static constexpr size_t k_blockSize = 64;
+
+   private:
+    const EntityRegistry* m_registry;
+    std::array<EntityMeta, k_blockSize> m_block{};
+    size_t m_next = k_blockSize;
+
+   public:
+    explicit EntityReserver(const EntityRegistry& _registry) : m_registry(&_registry) {}
+
+   public:
+    // Returns a reserved handle, see EntityRegistry::reserveEntity() for the threading rules.
+    [[nodiscard]] EntityMeta reserve() noexcept
+    {
+        if (m_next == k_blockSize)
+        {
+            m_registry->reserveEntities(m_block);
+            m_next = 0;
+        }
+
+        return m_block[m_next++];
+    }
+
+    // Returns the number of reserved handles cached and not handed out yet.
+    [[nodiscard]] size_t cachedCount() const noexcept { return k_blockSize - m_next; }
+
+    /**
+     * @brief Gives the cached handles back to the registry so their IDs can be recycled.
+     *
+     * @param _registry The registry the handles were reserved from, on its owning thread.
+     */
+    void release(EntityRegistry& _registry)
+    {
+        for (; m_next < k_blockSize; ++m_next)
+        {
+            (void)_registry.releaseReservedEntity(m_block[m_next]);
+        }
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <exception>
+#include <span>
+#include <stdexcept>
 #include <vector>
 #include <tuple>
-#include <unordered_map>
 #include <type_traits>
 #include <cstdint>
 #include <utility>
@@ -10,157 +15,1069 @@
 #include "entity.hpp"
 #include "archetype.hpp"
 #include "component_registry.hpp"
+#include "sparse_storage.hpp"
 
 namespace mosaic
 {
 namespace ecs
 {
 
+namespace detail
+{
+
+// Default number of entities processed by a single task of a parallel view iteration.
+inline constexpr size_t k_defaultGrainSize = 1024;
+
+/**
+ * @brief Executor interface required by parallel view iteration, modelled on
+ * exec::ThreadPool::enqueueToWorker() (an optional future that can be joined with get()).
+ */
+template <typename Pool>
+concept TaskPool = requires(Pool& _pool) { _pool.enqueueToWorker([] {})->get(); };
+
+/**
+ * @brief Runs _body(i) for every i in [0, _count): indices 1.. are enqueued to the pool (inline
+ * if it refuses one), the calling thread takes index 0 instead of idling at the join barrier.
+ *
+ * Every task is joined before returning, the first exception thrown by a task is rethrown.
+ */
+template <TaskPool Pool, typename Body>
+void dispatchTasks(Pool& _pool, size_t _count, Body&& _body)
+{
+    if (_count == 0) return;
+
+    using Future = std::decay_t<decltype(*_pool.enqueueToWorker([] {}))>;
+
+    std::vector<Future> futures;
+    futures.reserve(_count - 1);
+
+    std::exception_ptr error;
+    auto runInline = [&](size_t _index)
+    {
+        try
+        {
+            _body(_index);
+        }
+        catch (...)
+        {
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    for (size_t i = 1; i < _count; ++i)
+    {
+        auto future = _pool.enqueueToWorker([&_body, i] { _body(i); });
+
+        if (future) futures.push_back(std::move(*future));
+        else runInline(i);
+    }
+
+    runInline(0);
+
+    for (Future& future : futures)
+    {
+        try
+        {
+            future.get();
+        }
+        catch (...)
+        {
+            if (!error) error = std::current_exception();
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+}
+
+// A slice of an archetype processed by one task: rows if interleaved, chunks if chunked.
+struct ViewWorkRange
+{
+    Archetype* archetype;
+    size_t first;
+    size_t last;
+};
+
+// Address of the first element of a component in a run of rows and distance between elements.
+struct ViewColumn
+{
+    uint8_t* first;
+    size_t stride;
+};
+
 /**
- * @brief The 'EntityView' class provides a non-owning view over a set of entities that share
+ * @brief Resolves the column of T in a run: every row of an interleaved archetype, or one chunk
+ * (ignored in interleaved mode).
+ *
+ * Tags and shared components resolve to a single instance with a stride of 0, the tag's shared
+ * instance and the archetype's value respectively.
+ */
+template <Component T>
+[[nodiscard]] inline ViewColumn columnOf(Archetype* _arch, size_t _chunk,
+                                         const ComponentRegistry* _com)
+{
+    if constexpr (TagComponent<T>)
+    {
+        return {reinterpret_cast<uint8_t*>(&tagInstance<T>()), 0};
+    }
+    else
+    {
+        const ComponentID id = _com->getIDUnchecked<T>();
+
+        if (uint8_t* shared = _arch->sharedValue(id)) return {shared, 0};
+        if (_arch->isChunked()) return {_arch->chunkColumn(_chunk, id), sizeof(T)};
+
+        return {_arch->data() + _arch->componentOffset(id), _arch->stride()};
+    }
+}
+
+// How a query term takes part in the archetype match and in the iteration.
+enum class TermAccess : uint8_t
+{
+    read,
+    write,
+    with,
+    without,
+    optional,
+};
+
+// Splits a query term into its component and access, plain components are written.
+template <typename Term>
+struct QueryTermTraits
+{
+    using Type = Term;
+    static constexpr TermAccess k_access = TermAccess::write;
+};
+
+template <Component T>
+struct QueryTermTraits<Read<T>>
+{
+    using Type = T;
+    static constexpr TermAccess k_access = TermAccess::read;
+};
+
+template <Component T>
+struct QueryTermTraits<Write<T>>
+{
+    using Type = T;
+    static constexpr TermAccess k_access = TermAccess::write;
+};
+
+template <Component T>
+struct QueryTermTraits<With<T>>
+{
+    using Type = T;
+    static constexpr TermAccess k_access = TermAccess::with;
+};
+
+template <Component T>
+struct QueryTermTraits<Without<T>>
+{
+    using Type = T;
+    static constexpr TermAccess k_access = TermAccess::without;
+};
+
+template <Component T>
+struct QueryTermTraits<Optional<T>>
+{
+    using Type = T;
+    static constexpr TermAccess k_access = TermAccess::optional;
+};
+
+template <typename Term>
+using TermComponent = typename QueryTermTraits<Term>::Type;
+
+template <typename Term>
+inline constexpr TermAccess k_termAccess = QueryTermTraits<Term>::k_access;
+
+template <typename Term>
+concept QueryTerm = Component<TermComponent<Term>>;
+
+// Terms handed to the iteration functions, With<> and Without<> only take part in the match.
+template <typename Term>
+concept FetchedTerm = QueryTerm<Term> && k_termAccess<Term> != TermAccess::with &&
+                      k_termAccess<Term> != TermAccess::without;
+
+// Column pointer of a fetched term: const for Read<>, null in archetypes without an Optional<>.
+template <typename Term>
+using TermPointer = std::conditional_t<k_termAccess<Term> == TermAccess::read,
+                                       const TermComponent<Term>*, TermComponent<Term>*>;
+
+// Per-entity argument of a fetched term: a reference, or a pointer for Optional<>.
+template <typename Term>
+using TermReference =
+    std::conditional_t<k_termAccess<Term> == TermAccess::optional, TermPointer<Term>,
+                       std::remove_pointer_t<TermPointer<Term>>&>;
+
+template <typename Term>
+[[nodiscard]] inline TermReference<Term> fetchTerm(uint8_t* _element) noexcept
+{
+    if constexpr (k_termAccess<Term> == TermAccess::optional)
+    {
+        return reinterpret_cast<TermPointer<Term>>(_element);
+    }
+    else
+    {
+        return *reinterpret_cast<TermPointer<Term>>(_element);
+    }
+}
+
+// Resolves the column of a fetched term, an absent Optional<> or a sparse component (probed per
+// entity instead) resolves to a null column.
+template <FetchedTerm Term>
+[[nodiscard]] inline ViewColumn termColumnOf(Archetype* _arch, size_t _chunk,
+                                             const ComponentRegistry* _com)
+{
+    using T = TermComponent<Term>;
+
+    if constexpr (k_termAccess<Term> == TermAccess::optional)
+    {
+        if (!_arch->signature().testBit(_com->getIDUnchecked<T>())) return {nullptr, 0};
+    }
+    else if constexpr (!TagComponent<T>)
+    {
+        if (_com->info(_com->getIDUnchecked<T>()).sparse) return {nullptr, 0};
+    }
+
+    return columnOf<T>(_arch, _chunk, _com);
+}
+
+// Element of a sparse term of the entity (the tag instance for tags), null where absent.
+template <FetchedTerm Term>
+[[nodiscard]] inline uint8_t* sparseElementOf(const SparseComponentSet* _set, EntityID _eid)
+{
+    using T = TermComponent<Term>;
+
+    uint8_t* element = const_cast<SparseComponentSet*>(_set)->get(_eid);
+    if constexpr (TagComponent<T>)
+    {
+        if (element) element = reinterpret_cast<uint8_t*>(&tagInstance<T>());
+    }
+
+    return element;
+}
+
+// Column span of a fetched term handed out by span-based chunk iteration.
+template <typename Term>
+using TermSpan = std::span<std::remove_pointer_t<TermPointer<Term>>>;
+
+// Chunk functions take either the run size and raw pointers or one span per column.
+template <typename Func, typename... Ts>
+concept ChunkPointerFunc =
+    std::is_invocable_r_v<void, Func, size_t, EntityMeta*, TermPointer<Ts>...>;
+
+template <typename Func, typename... Ts>
+concept ChunkSpanFunc =
+    std::is_invocable_r_v<void, Func, std::span<const EntityMeta>, TermSpan<Ts>...>;
+
+template <typename Func, typename... Ts>
+concept ChunkFunc = ChunkPointerFunc<Func, Ts...> || ChunkSpanFunc<Func, Ts...>;
+
+// Number of interleaved rows gathered per span run, one tick block.
+inline constexpr size_t k_spanRows = Archetype::k_tickBlockRows;
+
+/**
+ * @brief Aligned scratch column an interleaved run is gathered into. Its size is a multiple of
+ * the alignment, so reading up to the next boundary after the gathered rows stays inside it.
+ */
+template <typename T>
+struct alignas(TypelessChunkedStorage<>::k_columnAlignment) SpanScratch
+{
+    uint8_t bytes[sizeof(T) * k_spanRows];
+
+    [[nodiscard]] T* data() noexcept { return reinterpret_cast<T*>(bytes); }
+};
+
+// Span over a column of `_count` elements, one element for tags and shared components.
+template <FetchedTerm Term>
+[[nodiscard]] inline TermSpan<Term> columnSpan(ViewColumn _column, size_t _count) noexcept
+{
+    using Pointer = TermPointer<Term>;
+
+    if (!_column.first) return {};
+    if (_column.stride == 0) return {reinterpret_cast<Pointer>(_column.first), 1};
+
+    return {reinterpret_cast<Pointer>(_column.first), _count};
+}
+
+// Copies the rows [_first, _first + _count) of an interleaved column into the scratch column.
+template <FetchedTerm Term>
+inline void gatherColumn(ViewColumn _column, size_t _first, size_t _count,
+                         SpanScratch<TermComponent<Term>>& _scratch) noexcept
+{
+    using T = TermComponent<Term>;
+
+    if (!_column.first || _column.stride == 0) return;
+
+    const uint8_t* src = _column.first + _first * _column.stride;
+    for (size_t i = 0; i < _count; ++i, src += _column.stride)
+    {
+        std::memcpy(_scratch.bytes + i * sizeof(T), src, sizeof(T));
+    }
+}
+
+// Copies the scratch column back into the interleaved rows, unless the term is read-only.
+template <FetchedTerm Term>
+inline void scatterColumn(ViewColumn _column, size_t _first, size_t _count,
+                          const SpanScratch<TermComponent<Term>>& _scratch) noexcept
+{
+    using T = TermComponent<Term>;
+
+    if constexpr (k_termAccess<Term> != TermAccess::read)
+    {
+        if (!_column.first || _column.stride == 0) return;
+
+        uint8_t* dst = _column.first + _first * _column.stride;
+        for (size_t i = 0; i < _count; ++i, dst += _column.stride)
+        {
+            std::memcpy(dst, _scratch.bytes + i * sizeof(T), sizeof(T));
+        }
+    }
+}
+
+// Span over the gathered scratch column, or the column itself for tags and shared components.
+template <FetchedTerm Term>
+[[nodiscard]] inline TermSpan<Term> scratchSpan(ViewColumn _column, size_t _count,
+                                                SpanScratch<TermComponent<Term>>& _scratch)
+{
+    if (!_column.first || _column.stride == 0) return columnSpan<Term>(_column, _count);
+
+    return {_scratch.data(), _count};
+}
+
+} // namespace detail
+
+/**
+ * @brief Alignment of the first element of every column span handed out by span-based chunk
+ * iteration (see BasicEntityView::forEachChunk()), the cache-line alignment of chunk columns.
+ */
+inline constexpr size_t k_columnSpanAlignment = TypelessChunkedStorage<>::k_columnAlignment;
+
+/**
+ * @brief The 'BasicEntityView' class provides a non-owning view over a set of entities that share
  * a specific set of components even if they are stored in different archetypes.
  *
- * @tparam Ts The component types that define the view.
+ * The archetype list type decides who owns the list of matching archetypes: EntityView owns a
+ * vector built for the call, ArchetypeSpanView borrows the list maintained by a Query.
+ *
+ * Every element of Ts is a fetched query term: a plain component or Write<T> is handed out as
+ * T&, Read<T> as const T& and Optional<T> as T* (nullptr in archetypes without T). Iterating a
+ * view stamps the visited tick blocks of every written component as changed (see
+ * Changed<>/Added<> filters). Systems that only read use Read<> terms or go through readOnly() to
+ * keep change detection precise.
+ *
+ * @tparam Archetypes The contiguous range of archetype pointers the view iterates over.
+ * @tparam Ts The fetched terms that define the view.
  */
-template <Component... Ts>
-class EntityView
+template <typename Archetypes, detail::FetchedTerm... Ts>
+class BasicEntityView
 {
    private:
     using Byte = uint8_t;
 
-    std::vector<Archetype*> m_archetypes;
+    Archetypes m_archetypes;
     const ComponentRegistry* m_componentRegistry;
+    const detail::SparseJoin* m_sparse; // sparse components joined per entity, null if none
+    bool m_trackWrites = true;
 
    public:
     /**
-     * @brief Constructs an EntityView with the given archetypes and component registry
-     * (inherited from the EntityRegistry).
+     * @brief Constructs a view with the given archetypes and component registry (inherited from
+     * the EntityRegistry).
      *
      * @param _archetypes The list of archetypes containing the entities to be viewed.
      * @param _com The component registry for component type information.
+     * @param _sparse The sparse components the entities are filtered by and fetched from (see
+     * Query), or nullptr if the view involves none.
      */
-    EntityView(const std::vector<Archetype*>& _archetypes, const ComponentRegistry* _com)
-        : m_archetypes(std::move(_archetypes)), m_componentRegistry(_com) {};
+    BasicEntityView(Archetypes _archetypes, const ComponentRegistry* _com,
+                    const detail::SparseJoin* _sparse = nullptr)
+        : m_archetypes(std::move(_archetypes)), m_componentRegistry(_com), m_sparse(_sparse) {};
 
    public:
+    /**
+     * @brief Returns a copy of the view whose iterations do not stamp components as changed.
+     *
+     * The references handed out stay mutable, the caller promises not to write through them.
+     */
+    [[nodiscard]] BasicEntityView readOnly() const
+    {
+        BasicEntityView view = *this;
+        view.m_trackWrites = false;
+        return view;
+    }
+
     /**
      * @brief Applies the provided function to each entity and its components in the view.
      *
      * @tparam Func The type of the function to be applied.
      * @param _func The function to apply to each entity and its components. It should accept
-     * an EntityMeta and references to the components of types Ts...
+     * an EntityMeta and one argument per term of Ts... (see detail::TermReference).
      */
     template <typename Func>
-        requires std::is_invocable_r_v<void, Func, EntityMeta, Ts&...>
+        requires std::is_invocable_r_v<void, Func, EntityMeta, detail::TermReference<Ts>...>
     void forEach(Func&& _func)
     {
         for (auto* archetype : m_archetypes)
         {
-            auto componentOffsets = archetype->componentOffsets();
+            forEachInRange({archetype, 0, unitCount(archetype)}, _func);
+        }
+    }
 
-            Byte* base = archetype->data();
-            size_t stride = archetype->stride();
-            size_t count = archetype->size();
+    /**
+     * @brief Applies the provided function to contiguous runs of entities in the view.
+     *
+     * For chunked archetypes the function is invoked once per chunk with one pointer per
+     * component column, each pointing at `count` contiguous elements. Interleaved archetypes do
+     * not store components contiguously, so they are visited as runs of a single entity. Tag
+     * components have no column: their pointer addresses a single shared instance and must not
+     * be indexed. The pointer of an Optional<> term is null in archetypes without the component.
+     *
+     * The function may instead take a `std::span<const EntityMeta>` and one detail::TermSpan per
+     * term (`std::span<const T>` for Read<> terms), meant for SIMD kernels. Every column span
+     * then starts on a k_columnSpanAlignment boundary and reading (not writing) past its end up
+     * to the next boundary stays within the allocation. Chunked archetypes hand out their
+     * columns in place; interleaved rows are gathered into aligned scratch columns of up to
+     * k_tickBlockRows entities, and written terms are copied back after every call. Tags and
+     * shared components are spans of one element, absent Optional<> terms are empty spans.
+     *
+     * @tparam Func The type of the function to be applied.
+     * @param _func The function to apply. It should accept the number of entities in the run, a
+     * pointer to their EntityMeta and one pointer per term of Ts..., or the spans above.
+     */
+    template <typename Func>
+        requires detail::ChunkFunc<Func, Ts...>
+    void forEachChunk(Func&& _func)
+    {
+        for (auto* archetype : m_archetypes)
+        {
+            forEachChunkInRange({archetype, 0, unitCount(archetype)}, _func);
+        }
+    }
+
+    /**
+     * @brief Applies the provided function to each entity of the tick blocks (chunks in chunked
+     * mode) where at least one of the filter components was written after the given tick.
+     *
+     * Change detection has block granularity: untouched blocks are skipped entirely, while every
+     * entity of a matching block is visited.
+     *
+     * @tparam Cs The components whose changes are looked for (archetypes without any are skipped).
+     * @param _since The reference tick, usually the value returned by advanceTick() at the end of
+     * the previous run of the system.
+     * @param _func The function to apply to each entity and its components.
+     */
+    template <Component... Cs, typename Func>
+        requires std::is_invocable_r_v<void, Func, EntityMeta, detail::TermReference<Ts>...>
+    void forEach(detail::Changed<Cs...>, uint32_t _since, Func&& _func)
+    {
+        forEachMatchingBlock([_since](const ColumnTicks& _ticks)
+                             { return isNewerTick(_ticks.changed, _since); },
+                             std::type_identity<detail::TypeList<Cs...>>{},
+                             [&](const detail::ViewWorkRange& _range)
+                             { forEachInRange(_range, _func); });
+    }
+
+    /**
+     * @brief Applies the provided function to each entity of the tick blocks where at least one
+     * entity gained one of the filter components after the given tick.
+     *
+     * @see forEach(detail::Changed<Cs...>, uint32_t, Func&&) for the granularity rules.
+     */
+    template <Component... Cs, typename Func>
+        requires std::is_invocable_r_v<void, Func, EntityMeta, detail::TermReference<Ts>...>
+    void forEach(detail::Added<Cs...>, uint32_t _since, Func&& _func)
+    {
+        forEachMatchingBlock([_since](const ColumnTicks& _ticks)
+                             { return isNewerTick(_ticks.added, _since); },
+                             std::type_identity<detail::TypeList<Cs...>>{},
+                             [&](const detail::ViewWorkRange& _range)
+                             { forEachInRange(_range, _func); });
+    }
+
+    // Chunk-wise version of forEach(detail::Changed<Cs...>, ...).
+    template <Component... Cs, typename Func>
+        requires detail::ChunkFunc<Func, Ts...>
+    void forEachChunk(detail::Changed<Cs...>, uint32_t _since, Func&& _func)
+    {
+        forEachMatchingBlock([_since](const ColumnTicks& _ticks)
+                             { return isNewerTick(_ticks.changed, _since); },
+                             std::type_identity<detail::TypeList<Cs...>>{},
+                             [&](const detail::ViewWorkRange& _range)
+                             { forEachChunkInRange(_range, _func); });
+    }
+
+    // Chunk-wise version of forEach(detail::Added<Cs...>, ...).
+    template <Component... Cs, typename Func>
+        requires detail::ChunkFunc<Func, Ts...>
+    void forEachChunk(detail::Added<Cs...>, uint32_t _since, Func&& _func)
+    {
+        forEachMatchingBlock([_since](const ColumnTicks& _ticks)
+                             { return isNewerTick(_ticks.added, _since); },
+                             std::type_identity<detail::TypeList<Cs...>>{},
+                             [&](const detail::ViewWorkRange& _range)
+                             { forEachChunkInRange(_range, _func); });
+    }
+
+    /**
+     * @brief Parallel version of forEach(): splits the rows of the matching archetypes into
+     * ranges of about _grainSize entities and dispatches them to the pool.
+     *
+     * The calling thread processes a range itself and then joins on every dispatched one, so all
+     * the entities have been visited when the call returns. Ranges the pool refuses (e.g. while
+     * shutting down) are run on the calling thread. The first exception thrown by the function is
+     * rethrown after the join.
+     *
+     * The function is invoked concurrently: it must only touch the components it is given and
+     * must not create, destroy or modify the components of entities (structural changes).
+     *
+     * @tparam Pool An executor such as exec::ThreadPool.
+     * @tparam Func The type of the function to be applied.
+     * @param _pool The pool the ranges are dispatched to via enqueueToWorker().
+     * @param _func The function to apply to each entity and its components.
+     * @param _grainSize The approximate number of entities processed by a single task: rounded
+     * up to a multiple of Archetype::k_tickBlockRows in interleaved archetypes (500 gives ranges
+     * of 512 rows) and down to whole chunks in chunked ones, so tasks never stamp the same block.
+     */
+    template <detail::TaskPool Pool, typename Func>
+        requires std::is_invocable_r_v<void, Func&, EntityMeta, detail::TermReference<Ts>...>
+    void parallelForEach(Pool& _pool, Func&& _func,
+                         size_t _grainSize = detail::k_defaultGrainSize)
+    {
+        dispatchRanges(_pool, _grainSize, [this, &_func](const detail::ViewWorkRange& _range)
+                       { forEachInRange(_range, _func); });
+    }
 
-            for (size_t row = 0; row < count; ++row)
+    /**
+     * @brief Parallel version of forEachChunk(), the ranges are made of whole chunks (or whole
+     * tick blocks of interleaved rows). Pointer and span functions are both accepted.
+     *
+     * @see parallelForEach for the scheduling, joining and thread-safety rules, and the rounding
+     * of _grainSize.
+     */
+    template <detail::TaskPool Pool, typename Func>
+        requires detail::ChunkFunc<Func&, Ts...>
+    void parallelForEachChunk(Pool& _pool, Func&& _func,
+                              size_t _grainSize = detail::k_defaultGrainSize)
+    {
+        dispatchRanges(_pool, _grainSize, [this, &_func](const detail::ViewWorkRange& _range)
+                       { forEachChunkInRange(_range, _func); });
+    }
+
+   private:
+    // Returns the number of iteration units of an archetype: rows, or chunks if chunked.
+    static size_t unitCount(const Archetype* _archetype)
+    {
+        return _archetype->isChunked() ? _archetype->chunkCount() : _archetype->size();
+    }
+
+    // Invokes the function for every entity of the range (rows, or chunks if chunked).
+    template <typename Func>
+    void forEachInRange(const detail::ViewWorkRange& _range, Func& _func)
+    {
+        if (m_sparse)
+        {
+            forEachJoinedInRange(_range, [&](EntityMeta& _meta, auto*... _elements)
+                                 { _func(_meta, detail::fetchTerm<Ts>(_elements)...); });
+            markRangeWritten(_range);
+            return;
+        }
+
+        auto perEntity = [&](EntityMeta& _meta, auto*... _elements)
+        { _func(_meta, detail::fetchTerm<Ts>(_elements)...); };
+
+        if (_range.archetype->isChunked())
+        {
+            forEachEntityInChunks(_range, perEntity, std::index_sequence_for<Ts...>{});
+        }
+        else
+        {
+            forEachInRows(_range, perEntity, std::index_sequence_for<Ts...>{});
+        }
+
+        markRangeWritten(_range);
+    }
+
+    // Invokes the function for every run of the range (chunks, or single rows if interleaved).
+    template <typename Func>
+    void forEachChunkInRange(const detail::ViewWorkRange& _range, Func& _func)
+    {
+        if (m_sparse)
+        {
+            // sparse components have no column, joined entities are runs of one
+            if constexpr (!detail::ChunkPointerFunc<Func&, Ts...>)
+            {
+                throw std::logic_error("Span chunks cannot join sparse components.");
+            }
+            else
+            {
+                forEachJoinedInRange(_range,
+                                     [&](EntityMeta& _meta, auto*... _elements)
+                                     {
+                                         _func(size_t(1), &_meta,
+                                               reinterpret_cast<detail::TermPointer<Ts>>(
+                                                   _elements)...);
+                                     });
+            }
+        }
+        else if constexpr (!detail::ChunkPointerFunc<Func&, Ts...>)
+        {
+            forEachSpanInRange(_range, _func, std::index_sequence_for<Ts...>{});
+        }
+        else if (_range.archetype->isChunked())
+        {
+            forEachInChunks(_range, _func, std::index_sequence_for<Ts...>{});
+        }
+        else
+        {
+            auto singleRuns = [&](EntityMeta& _meta, auto*... _elements)
+            { _func(size_t(1), &_meta, reinterpret_cast<detail::TermPointer<Ts>>(_elements)...); };
+
+            forEachInRows(_range, singleRuns, std::index_sequence_for<Ts...>{});
+        }
+
+        markRangeWritten(_range);
+    }
+
+    /**
+     * @brief Invokes the function for every entity of the range admitted by the sparse filters,
+     * the elements of sparse terms probed in their sets (null where an Optional<> is absent).
+     */
+    template <typename Func>
+    void forEachJoinedInRange(const detail::ViewWorkRange& _range, Func&& _func)
+    {
+        forEachJoinedInRange(_range, _func, std::index_sequence_for<Ts...>{});
+    }
+
+    template <typename Func, size_t... Is>
+    void forEachJoinedInRange(const detail::ViewWorkRange& _range, Func& _func,
+                              std::index_sequence<Is...> _terms)
+    {
+        const std::array<const detail::SparseComponentSet*, sizeof...(Ts)> sets = {
+            sparseSetOf<Ts>()...};
+
+        auto perEntity = [&](EntityMeta& _meta, auto*... _elements)
+        {
+            if (!m_sparse->admits(_meta.id)) return;
+
+            std::array<Byte*, sizeof...(Ts)> elements = {_elements...};
+            ((sets[Is] ? elements[Is] = detail::sparseElementOf<Ts>(sets[Is], _meta.id) : nullptr),
+             ...);
+
+            _func(_meta, elements[Is]...);
+        };
+
+        if (_range.archetype->isChunked()) forEachEntityInChunks(_range, perEntity, _terms);
+        else forEachInRows(_range, perEntity, _terms);
+    }
+
+    // Returns the set of a fetched term if its component is sparse, nullptr otherwise.
+    template <typename Term>
+    [[nodiscard]] const detail::SparseComponentSet* sparseSetOf() const
+    {
+        const ComponentID id = m_componentRegistry->getIDUnchecked<detail::TermComponent<Term>>();
+        return m_sparse->storage ? m_sparse->storage->find(id) : nullptr;
+    }
+
+    // Stamps the components of the view as changed over the tick blocks covered by the range.
+    void markRangeWritten(const detail::ViewWorkRange& _range)
+    {
+        if (!m_trackWrites || _range.first >= _range.last) return;
+
+        Archetype* arch = _range.archetype;
+        size_t firstBlock = _range.first;
+        size_t lastBlock = _range.last;
+
+        if (!arch->isChunked())
+        {
+            firstBlock = _range.first / Archetype::k_tickBlockRows;
+            lastBlock = (_range.last + Archetype::k_tickBlockRows - 1) / Archetype::k_tickBlockRows;
+        }
+
+        (markTermWritten<Ts>(arch, firstBlock, lastBlock), ...);
+    }
+
+    // Stamps the component of a term over the given tick blocks if the term writes it.
+    template <typename Term>
+    void markTermWritten(Archetype* _arch, size_t _firstBlock, size_t _lastBlock)
+    {
+        using T = detail::TermComponent<Term>;
+
+        // tags have no data to write, Read<> terms hand out const references
+        if constexpr (!TagComponent<T> && detail::k_termAccess<Term> != detail::TermAccess::read)
+        {
+            const ComponentID id = m_componentRegistry->getIDUnchecked<T>();
+
+            // sparse components have no ticks
+            if (m_sparse && m_componentRegistry->info(id).sparse) return;
+
+            if (detail::k_termAccess<Term> != detail::TermAccess::optional ||
+                _arch->signature().testBit(id))
+            {
+                _arch->markChanged(id, _firstBlock, _lastBlock);
+            }
+        }
+    }
+
+    /**
+     * @brief Invokes the body on the runs of consecutive tick blocks where the predicate holds
+     * for at least one of the filter components.
+     */
+    template <typename Pred, Component... Cs, typename Body>
+    void forEachMatchingBlock(Pred&& _pred, std::type_identity<detail::TypeList<Cs...>>,
+                              Body&& _body)
+    {
+        const std::array<ComponentID, sizeof...(Cs)> ids = {m_componentRegistry->getID<Cs>()...};
+
+        for (Archetype* arch : m_archetypes)
+        {
+            std::array<bool, sizeof...(Cs)> present{};
+            bool anyPresent = false;
+
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                present[i] = arch->signature().testBit(ids[i]);
+                anyPresent |= present[i];
+            }
+
+            if (!anyPresent) continue;
+
+            const size_t blockRows = arch->tickBlockRows();
+            const size_t blockCount = arch->tickBlockCount();
+            const size_t units = unitCount(arch);
+
+            auto blockMatches = [&](size_t _block)
+            {
+                for (size_t i = 0; i < ids.size(); ++i)
+                {
+                    if (present[i] && _pred(arch->columnTicks(_block, ids[i]))) return true;
+                }
+
+                return false;
+            };
+
+            // rows are grouped by block in interleaved mode, chunks already are blocks
+            const size_t unitsPerBlock = arch->isChunked() ? 1 : blockRows;
+
+            for (size_t block = 0; block < blockCount;)
             {
-                Byte* rowPtr = base + row * stride;
+                if (!blockMatches(block))
+                {
+                    ++block;
+                    continue;
+                }
+
+                const size_t firstBlock = block;
+                while (block < blockCount && blockMatches(block)) ++block;
+
+                _body(detail::ViewWorkRange{arch, firstBlock * unitsPerBlock,
+                                            std::min(block * unitsPerBlock, units)});
+            }
+        }
+    }
 
-                EntityMeta meta = *reinterpret_cast<EntityMeta*>(rowPtr);
+    // Invokes the function once per row of an interleaved archetype with the address of every
+    // term's element (null for absent Optional<> terms), columns are resolved once.
+    template <typename Func, size_t... Is>
+    void forEachInRows(const detail::ViewWorkRange& _range, Func& _func,
+                       std::index_sequence<Is...>)
+    {
+        std::array<detail::ViewColumn, sizeof...(Ts)> columns = {
+            detail::termColumnOf<Ts>(_range.archetype, 0, m_componentRegistry)...};
+        ((columns[Is].first += _range.first * columns[Is].stride), ...);
+
+        const size_t stride = _range.archetype->stride();
+        Byte* rowPtr = _range.archetype->data() + _range.first * stride;
+
+        for (size_t row = _range.first; row < _range.last; ++row, rowPtr += stride)
+        {
+            _func(*reinterpret_cast<EntityMeta*>(rowPtr), columns[Is].first...);
 
-                auto tuple = std::forward_as_tuple(
-                    meta, (*reinterpret_cast<Ts*>(
-                              rowPtr + componentOffsets[m_componentRegistry->getID<Ts>()]))...);
+            ((columns[Is].first += columns[Is].stride), ...);
+        }
+    }
 
-                std::apply(_func, tuple);
+    // Same as forEachInRows() over the chunks of a chunked archetype, columns are resolved once
+    // per chunk (shared values and tags keep a stride of 0).
+    template <typename Func, size_t... Is>
+    void forEachEntityInChunks(const detail::ViewWorkRange& _range, Func& _func,
+                               std::index_sequence<Is...>)
+    {
+        Archetype* arch = _range.archetype;
+
+        for (size_t chunk = _range.first; chunk < _range.last; ++chunk)
+        {
+            std::array<detail::ViewColumn, sizeof...(Ts)> columns = {
+                detail::termColumnOf<Ts>(arch, chunk, m_componentRegistry)...};
+
+            EntityMeta* metas = arch->chunkMetas(chunk);
+            const size_t count = arch->chunkSize(chunk);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                _func(metas[i], columns[Is].first...);
+
+                ((columns[Is].first += columns[Is].stride), ...);
             }
         }
     }
 
+    // Invokes the function once per chunk of a chunked archetype with its column pointers.
+    template <typename Func, size_t... Is>
+    void forEachInChunks(const detail::ViewWorkRange& _range, Func& _func,
+                         std::index_sequence<Is...>)
+    {
+        Archetype* arch = _range.archetype;
+
+        for (size_t chunk = _range.first; chunk < _range.last; ++chunk)
+        {
+            _func(arch->chunkSize(chunk), arch->chunkMetas(chunk),
+                  reinterpret_cast<detail::TermPointer<Ts>>(
+                      detail::termColumnOf<Ts>(arch, chunk, m_componentRegistry).first)...);
+        }
+    }
+
+    /**
+     * @brief Invokes the function once per run of the range with one aligned span per column:
+     * every chunk in place, or interleaved rows gathered tick block by tick block into scratch
+     * columns and copied back (written terms only) after the call.
+     */
+    template <typename Func, size_t... Is>
+    void forEachSpanInRange(const detail::ViewWorkRange& _range, Func& _func,
+                            std::index_sequence<Is...>)
+    {
+        Archetype* arch = _range.archetype;
+
+        if (arch->isChunked())
+        {
+            for (size_t chunk = _range.first; chunk < _range.last; ++chunk)
+            {
+                const size_t count = arch->chunkSize(chunk);
+
+                _func(std::span<const EntityMeta>(arch->chunkMetas(chunk), count),
+                      detail::columnSpan<Ts>(
+                          detail::termColumnOf<Ts>(arch, chunk, m_componentRegistry), count)...);
+            }
+
+            return;
+        }
+
+        const std::array<detail::ViewColumn, sizeof...(Ts)> columns = {
+            detail::termColumnOf<Ts>(arch, 0, m_componentRegistry)...};
+        const size_t stride = arch->stride();
+
+        detail::SpanScratch<EntityMeta> metas;
+        std::tuple<detail::SpanScratch<detail::TermComponent<Ts>>...> scratch;
+
+        for (size_t first = _range.first; first < _range.last; first += detail::k_spanRows)
+        {
+            const size_t count = std::min(detail::k_spanRows, _range.last - first);
+
+            // EntityMeta sits at offset 0 of every row
+            for (size_t i = 0; i < count; ++i)
+            {
+                std::memcpy(metas.bytes + i * sizeof(EntityMeta),
+                            arch->data() + (first + i) * stride, sizeof(EntityMeta));
+            }
+            (detail::gatherColumn<Ts>(columns[Is], first, count, std::get<Is>(scratch)), ...);
+
+            _func(std::span<const EntityMeta>(metas.data(), count),
+                  detail::scratchSpan<Ts>(columns[Is], count, std::get<Is>(scratch))...);
+
+            (detail::scatterColumn<Ts>(columns[Is], first, count, std::get<Is>(scratch)), ...);
+        }
+    }
+
+    // Splits the matching archetypes into ranges and runs them on the pool and calling thread.
+    template <typename Pool, typename Body>
+    void dispatchRanges(Pool& _pool, size_t _grainSize, Body&& _body)
+    {
+        const std::vector<detail::ViewWorkRange> ranges = splitIntoRanges(_grainSize);
+
+        detail::dispatchTasks(_pool, ranges.size(),
+                              [&](size_t _index) { _body(ranges[_index]); });
+    }
+
+    // Splits the rows (or chunks) of every non-empty archetype into ranges of ~_grainSize entities.
+    [[nodiscard]] std::vector<detail::ViewWorkRange> splitIntoRanges(size_t _grainSize) const
+    {
+        std::vector<detail::ViewWorkRange> ranges;
+        _grainSize = std::max<size_t>(_grainSize, 1);
+
+        for (Archetype* archetype : m_archetypes)
+        {
+            const size_t units = unitCount(archetype);
+            // interleaved ranges are aligned on tick blocks so tasks never stamp the same block
+            const size_t rowBlocks =
+                (_grainSize + Archetype::k_tickBlockRows - 1) / Archetype::k_tickBlockRows;
+            const size_t step = archetype->isChunked()
+                                    ? std::max<size_t>(_grainSize / archetype->chunkCapacity(), 1)
+                                    : rowBlocks * Archetype::k_tickBlockRows;
+
+            for (size_t first = 0; first < units; first += step)
+            {
+                ranges.push_back({archetype, first, std::min(first + step, units)});
+            }
+        }
+
+        return ranges;
+    }
+
    public:
     /**
      * @brief An iterator for traversing entities and their components in the view.
+     *
+     * The iterator borrows the archetype list of the view and walks contiguous runs (a whole
+     * interleaved archetype, or one chunk): entering a run resolves one base pointer and stride per
+     * column, then every step only bumps those pointers. It never allocates nor looks up offsets
+     * per row, and stays valid as long as the view's archetype list does.
      */
     struct Iterator
     {
        private:
-        const ComponentRegistry* m_componentRegistry;
-        std::vector<Archetype*> m_archetypes;
-        size_t m_archetypeIndex;
-        size_t m_rowIndex;
+        static constexpr size_t k_columnCount = sizeof...(Ts) + 1; // EntityMeta first
 
-        // Cached values for the current archetype
-        Byte* m_base = nullptr;
-        size_t m_stride = 0;
-        size_t m_count = 0;
-        std::unordered_map<ComponentID, size_t> m_componentOffsets;
+        // Current run (null columns once past the end)
+        struct Run
+        {
+            size_t archetypeIndex = 0;
+            size_t chunkIndex = 0;
+            Byte* end = nullptr;
+            std::array<Byte*, k_columnCount> columns{};
+            std::array<size_t, k_columnCount> strides{};
+        };
+
+        const ComponentRegistry* m_componentRegistry;
+        std::span<Archetype* const> m_archetypes;
+        Run m_run;
 
-        // Load the archetype at the given index and update cached values
-        void loadArchetype(size_t index)
+        // Returns the first run with rows at or after the given position (or the end). Only
+        // values cross the call, so the iterator itself never escapes the caller's registers.
+        static Run seekRun(const ComponentRegistry* _com, std::span<Archetype* const> _archetypes,
+                           size_t _archetypeIndex, size_t _chunkIndex)
         {
-            if (index >= m_archetypes.size()) return;
-            Archetype* arch = m_archetypes[index];
-            m_base = arch->data();
-            m_stride = arch->stride();
-            m_count = arch->size();
-            m_componentOffsets = arch->componentOffsets();
+            Run run;
+
+            for (; _archetypeIndex < _archetypes.size(); ++_archetypeIndex, _chunkIndex = 0)
+            {
+                Archetype* arch = _archetypes[_archetypeIndex];
+                run.archetypeIndex = _archetypeIndex;
+
+                if (arch->isChunked())
+                {
+                    for (; _chunkIndex < arch->chunkCount(); ++_chunkIndex)
+                    {
+                        const size_t count = arch->chunkSize(_chunkIndex);
+                        if (count == 0) continue;
+
+                        run.chunkIndex = _chunkIndex;
+                        setColumns(run, reinterpret_cast<Byte*>(arch->chunkMetas(_chunkIndex)),
+                                   sizeof(EntityMeta),
+                                   {detail::termColumnOf<Ts>(arch, _chunkIndex, _com)...});
+                        run.end = run.columns[0] + count * sizeof(EntityMeta);
+                        return run;
+                    }
+                }
+                else if (_chunkIndex == 0 && arch->size() > 0)
+                {
+                    setColumns(run, arch->data(), arch->stride(),
+                               {detail::termColumnOf<Ts>(arch, 0, _com)...});
+                    run.end = run.columns[0] + arch->size() * arch->stride();
+                    return run;
+                }
+            }
+
+            return Run{_archetypes.size()};
         }
 
-        // Advance to the next valid archetype with rows, if necessary
-        void advanceToValid()
+        // Fills the columns of a run, EntityMeta first.
+        static void setColumns(Run& _run, Byte* _metas, size_t _metaStride,
+                               const std::array<detail::ViewColumn, sizeof...(Ts)>& _columns)
         {
-            while (m_archetypeIndex < m_archetypes.size() && m_rowIndex >= m_count)
+            _run.columns[0] = _metas;
+            _run.strides[0] = _metaStride;
+
+            for (size_t i = 0; i < sizeof...(Ts); ++i)
             {
-                ++m_archetypeIndex;
-                m_rowIndex = 0;
-                if (m_archetypeIndex < m_archetypes.size()) loadArchetype(m_archetypeIndex);
+                _run.columns[i + 1] = _columns[i].first;
+                _run.strides[i + 1] = _columns[i].stride;
             }
         }
 
+        template <size_t... Is>
+        auto dereference(std::index_sequence<Is...>) const
+        {
+            return EntityMetaComponentTuplePair{
+                *reinterpret_cast<EntityMeta*>(m_run.columns[0]),
+                std::tuple<detail::TermReference<Ts>...>(
+                    detail::fetchTerm<Ts>(m_run.columns[Is + 1])...)};
+        }
+
+        // Constant indices only, so the run can be kept in registers
+        template <size_t... Is>
+        void advanceColumns(std::index_sequence<Is...>)
+        {
+            ((m_run.columns[Is] += m_run.strides[Is]), ...);
+        }
+
        public:
-        Iterator(const ComponentRegistry* _com, std::vector<Archetype*> _archetypes,
-                 size_t archetypeIndex, size_t rowIndex)
+        Iterator(const ComponentRegistry* _com, std::span<Archetype* const> _archetypes,
+                 size_t _archetypeIndex)
             : m_componentRegistry(_com),
-              m_archetypes(std::move(_archetypes)),
-              m_archetypeIndex(archetypeIndex),
-              m_rowIndex(rowIndex)
+              m_archetypes(_archetypes),
+              m_run(seekRun(_com, _archetypes, _archetypeIndex, 0))
         {
-            if (m_archetypeIndex < m_archetypes.size()) loadArchetype(m_archetypeIndex);
-            advanceToValid();
         }
 
         struct EntityMetaComponentTuplePair
         {
             EntityMeta meta;
-            std::tuple<Ts&...> components;
+            std::tuple<detail::TermReference<Ts>...> components;
         };
 
         EntityMetaComponentTuplePair operator*() const
         {
-            Byte* rowPtr = m_base + m_rowIndex * m_stride;
-            EntityID eid = *reinterpret_cast<EntityID*>(rowPtr);
-
-            auto comps = std::forward_as_tuple((*reinterpret_cast<Ts*>(
-                rowPtr + m_componentOffsets.at(m_componentRegistry->getID<Ts>())))...);
-
-            return {EntityMeta{eid, 0u}, comps};
+            return dereference(std::index_sequence_for<Ts...>{});
         }
 
+        // Every position has its own EntityMeta address, the end has none
         bool operator!=(const Iterator& _other) const
         {
-            return m_archetypeIndex != _other.m_archetypeIndex || m_rowIndex != _other.m_rowIndex;
+            return m_run.columns[0] != _other.m_run.columns[0];
         }
 
         void operator++()
         {
-            ++m_rowIndex;
-            advanceToValid();
+            advanceColumns(std::make_index_sequence<k_columnCount>{});
+
+            if (m_run.columns[0] != m_run.end) return;
+
+            const Run next = seekRun(m_componentRegistry, m_archetypes, m_run.archetypeIndex,
+                                     m_run.chunkIndex + 1);
+            m_run = next;
         }
     };
 
-    Iterator begin() { return Iterator(m_componentRegistry, m_archetypes, 0, 0); }
-    Iterator end() { return Iterator(m_componentRegistry, m_archetypes, m_archetypes.size(), 0); }
+    // Iteration through the Iterator conservatively stamps every visited archetype up front.
+    Iterator begin()
+    {
+        for (Archetype* arch : m_archetypes) markRangeWritten({arch, 0, unitCount(arch)});
+
+        return Iterator(m_componentRegistry, m_archetypes, 0);
+    }
+
+    Iterator end() { return Iterator(m_componentRegistry, m_archetypes, m_archetypes.size()); }
 };
 
+// The archetypes an owning view holds without an allocation; a view matches a few of them.
+inline constexpr size_t k_viewInlineArchetypes = 8;
+
+// View owning the list of archetypes it iterates over (returned by viewSet() and viewSubset()).
+template <detail::FetchedTerm... Ts>
+using EntityView = BasicEntityView<pieces::SmallVector<Archetype*, k_viewInlineArchetypes>, Ts...>;
+
+// View borrowing a list of archetypes owned elsewhere (used by Query, never allocates).
+template <detail::FetchedTerm... Ts>
+using ArchetypeSpanView = BasicEntityView<std::span<Archetype* const>, Ts...>;
+
 } // namespace ecs
 } // namespace mosaic
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#include "entity.hpp"
+#include "component.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+/**
+ * @brief The structural events observers subscribe to (see EntityRegistry::observe()).
+ */
+enum class ComponentEvent : uint8_t
+{
+    added,   /// The component was added to the entities (creation included), after construction.
+    removed, /// The component is about to be removed (destruction included), values still readable.
+};
+
+// Identifies an observer registered with EntityRegistry::observe().
+using ObserverID = uint32_t;
+
+// Called once per structural operation with every entity the event applies to.
+using ObserverCallback = std::function<void(std::span<const EntityID>)>;
+
+namespace detail
+{
+
+/**
+ * @brief The entities affected by one bulk operation, gathered per observed component so that
+ * every observer is called once for the whole operation.
+ */
+class ObserverBatch final
+{
+   private:
+    std::vector<std::pair<ComponentID, std::vector<EntityID>>> m_entities;
+
+   public:
+    // Records the entities for every component of the given (already filtered) set.
+    void add(const ComponentSignature& _components, std::span<const EntityID> _eids)
+    {
+        if (_eids.empty()) return;
+
+        for (size_t compID = _components.findFirstSet(); compID < _components.size();
+             compID = _components.findFirstSetFrom(compID + 1))
+        {
+            auto it = std::ranges::find(m_entities, compID,
+                                        &std::pair<ComponentID, std::vector<EntityID>>::first);
+            if (it == m_entities.end()) it = m_entities.insert(m_entities.end(), {compID, {}});
+
+            it->second.insert(it->second.end(), _eids.begin(), _eids.end());
+        }
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return m_entities.empty(); }
+
+    // Sorts the entities of every component and drops duplicated IDs.
+    void deduplicate()
+    {
+        for (auto& [compID, eids] : m_entities)
+        {
+            std::sort(eids.begin(), eids.end());
+            eids.erase(std::unique(eids.begin(), eids.end()), eids.end());
+        }
+    }
+
+    // Returns the entities recorded for the component (empty if none).
+    [[nodiscard]] std::span<const EntityID> entities(ComponentID _compID) const noexcept
+    {
+        for (const auto& [compID, eids] : m_entities)
+        {
+            if (compID == _compID) return eids;
+        }
+
+        return {};
+    }
+};
+
+/**
+ * @brief The observers of a registry, along with the components observed per event so that
+ * structural operations skip notifications with a single signature test when nobody listens.
+ */
+class ObserverTable final
+{
+   private:
+    struct Observer
+    {
+        ObserverID id;
+        ComponentID component;
+        ComponentEvent event;
+        ObserverCallback callback;
+    };
+
+    std::vector<Observer> m_observers; // in registration order
+    std::array<ComponentSignature, 2> m_observed;
+    ObserverID m_nextID = 0;
+
+   public:
+    explicit ObserverTable(size_t _maxComponents)
+        : m_observed{ComponentSignature(_maxComponents), ComponentSignature(_maxComponents)}
+    {
+    }
+
+   public:
+    ObserverID add(ComponentID _compID, ComponentEvent _event, ObserverCallback _callback)
+    {
+        m_observers.push_back({m_nextID, _compID, _event, std::move(_callback)});
+        m_observed[slot(_event)].setBit(_compID);
+
+        return m_nextID++;
+    }
+
+    bool remove(ObserverID _id)
+    {
+        auto it = std::ranges::find(m_observers, _id, &Observer::id);
+        if (it == m_observers.end()) return false;
+
+        const ComponentID compID = it->component;
+        const ComponentEvent event = it->event;
+        m_observers.erase(it);
+
+        const bool stillObserved = std::ranges::any_of(
+            m_observers, [&](const Observer& _observer)
+            { return _observer.component == compID && _observer.event == event; });
+        if (!stillObserved) m_observed[slot(event)].clearBit(compID);
+
+        return true;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return m_observers.empty(); }
+
+    // Returns the components with at least one observer for the event.
+    [[nodiscard]] const ComponentSignature& observed(ComponentEvent _event) const noexcept
+    {
+        return m_observed[slot(_event)];
+    }
+
+    // Calls the observers of every component of the set for the event with the same entities.
+    void notify(ComponentEvent _event, const ComponentSignature& _components,
+                std::span<const EntityID> _eids) const
+    {
+        if (_eids.empty() || (_components & m_observed[slot(_event)]).none()) return;
+
+        for (const Observer& observer : m_observers)
+        {
+            if (observer.event == _event && _components.testBit(observer.component))
+            {
+                observer.callback(_eids);
+            }
+        }
+    }
+
+    // Calls the observers of the event once with the entities gathered for their component.
+    void notify(ComponentEvent _event, const ObserverBatch& _batch) const
+    {
+        if (_batch.empty()) return;
+
+        for (const Observer& observer : m_observers)
+        {
+            if (observer.event != _event) continue;
+
+            const std::span<const EntityID> eids = _batch.entities(observer.component);
+            if (!eids.empty()) observer.callback(eids);
+        }
+    }
+
+   private:
+    static constexpr size_t slot(ComponentEvent _event) noexcept
+    {
+        return static_cast<size_t>(_event);
+    }
+};
+
+} // namespace detail
+
+} // namespace ecs
+} // namespace mosaic
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+
+#include "mosaic/defines.hpp"
+
+#include "storage_allocator.hpp"
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+#include <windows.h>
+#define MOSAIC_PAGE_STORAGE_VIRTUAL_ALLOC
+#elif defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_MACOS) || \
+    defined(MOSAIC_PLATFORM_ANDROID)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MOSAIC_PAGE_STORAGE_MMAP
+#if defined(MOSAIC_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace mosaic
+{
+namespace ecs
+{
+
+// Pages placed wherever the system sees fit.
+inline constexpr uint32_t k_anyNumaNode = UINT32_MAX;
+
+struct PageStorageSettings
+{
+    bool largePages = true;            // MAP_HUGETLB / MEM_LARGE_PAGES when the system has them
+    uint32_t numaNode = k_anyNumaNode; // the node the pages are preferably placed on
+    size_t minPageAllocation = 64 * BYTES_PER_KIB; // the smaller allocations go to the heap
+};
+
+/**
+ * @brief Archetype storage straight from the virtual memory of the system: large pages to cut
+ * the TLB misses of large worlds, placed on a NUMA node, and zeroed by the system rather than
+ * memset.
+ *
+ * Allocations of at least a large page are mapped with MAP_HUGETLB (Linux) or MEM_LARGE_PAGES
+ * (Windows, needs SeLockMemoryPrivilege) and fall back to regular pages, marked MADV_HUGEPAGE for
+ * transparent huge pages on Linux, when the system has none to spare. With a NUMA node the pages
+ * are bound to it as the preferred one (mbind, VirtualAllocExNuma), a node the system does not
+ * have is ignored. Allocations smaller than minPageAllocation, or aligned on more than a page, go
+ * to the global heap: one mapping per small row array would waste most of its page.
+ *
+ * Pair it with a ChunkArena (which rounds its slabs up to granularity()) so every chunk of a
+ * chunked archetype sits in a large page, or give it to the registry directly for the row arrays
+ * of interleaved archetypes. Thread-safe, the allocator must outlive the storages it backs.
+ *
+ * @note Without mmap or VirtualAlloc (e.g. Emscripten) every allocation goes to the heap.
+ */
+class PageStorageAllocator final : public StorageAllocator
+{
+   private:
+    PageStorageSettings m_settings;
+    size_t m_pageSize = 4 * BYTES_PER_KIB;
+    size_t m_largePageSize = 0; // 0 without large pages
+
+    std::atomic<size_t> m_mappedBytes{0};
+    std::atomic<size_t> m_largePageBytes{0};
+
+    // The mappings made of large pages (allocations of a large page at least, so few)
+    mutable std::mutex m_mutex;
+    std::unordered_set<const Byte*> m_largeMappings;
+
+   public:
+    explicit PageStorageAllocator(const PageStorageSettings& _settings = {})
+        : m_settings(_settings)
+    {
+#if defined(MOSAIC_PAGE_STORAGE_VIRTUAL_ALLOC)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        m_pageSize = info.dwPageSize;
+        if (m_settings.largePages) m_largePageSize = GetLargePageMinimum();
+#elif defined(MOSAIC_PAGE_STORAGE_MMAP)
+        m_pageSize = size_t(::sysconf(_SC_PAGESIZE));
+#if defined(MAP_HUGETLB)
+        // the default huge page size of x86-64 and arm64 kernels
+        if (m_settings.largePages) m_largePageSize = 2 * BYTES_PER_MIB;
+#endif
+#endif
+    }
+
+    PageStorageAllocator(const PageStorageAllocator&) = delete;
+    PageStorageAllocator& operator=(const PageStorageAllocator&) = delete;
+
+   public:
+    [[nodiscard]] Byte* allocate(size_t _size, size_t _alignment) override
+    {
+        if (isHeapAllocation(_size, _alignment))
+        {
+            return static_cast<Byte*>(::operator new(_size, std::align_val_t{_alignment}));
+        }
+
+        const size_t length = mappedLength(_size);
+        bool large = false;
+        Byte* memory = map(length, large);
+
+        m_mappedBytes.fetch_add(length, std::memory_order_relaxed);
+        if (large)
+        {
+            m_largePageBytes.fetch_add(length, std::memory_order_relaxed);
+
+            std::lock_guard lock(m_mutex);
+            m_largeMappings.insert(memory);
+        }
+
+        return memory;
+    }
+
+    void deallocate(Byte* _memory, size_t _size, size_t _alignment) noexcept override
+    {
+        if (isHeapAllocation(_size, _alignment))
+        {
+            ::operator delete(_memory, std::align_val_t{_alignment});
+            return;
+        }
+
+        const size_t length = mappedLength(_size);
+        m_mappedBytes.fetch_sub(length, std::memory_order_relaxed);
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_largeMappings.erase(_memory) != 0)
+            {
+                m_largePageBytes.fetch_sub(length, std::memory_order_relaxed);
+            }
+        }
+
+        unmap(_memory, length);
+    }
+
+    [[nodiscard]] size_t granularity() const noexcept override
+    {
+        return m_largePageSize != 0 ? m_largePageSize : m_pageSize;
+    }
+
+    [[nodiscard]] const PageStorageSettings& settings() const noexcept { return m_settings; }
+
+    [[nodiscard]] size_t pageSize() const noexcept { return m_pageSize; }
+
+    // Returns the large page size used, 0 if the allocator does not ask for large pages.
+    [[nodiscard]] size_t largePageSize() const noexcept { return m_largePageSize; }
+
+    // Returns the bytes of the mappings in use, heap allocations excluded.
+    [[nodiscard]] size_t mappedBytes() const noexcept
+    {
+        return m_mappedBytes.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the bytes of the mappings made of explicit large pages (transparent huge
+     * pages are not seen).
+     */
+    [[nodiscard]] size_t largePageBytes() const noexcept
+    {
+        return m_largePageBytes.load(std::memory_order_relaxed);
+    }
+
+   private:
+    [[nodiscard]] bool isHeapAllocation(size_t _size, size_t _alignment) const noexcept
+    {
+#if defined(MOSAIC_PAGE_STORAGE_VIRTUAL_ALLOC) || defined(MOSAIC_PAGE_STORAGE_MMAP)
+        return _size < m_settings.minPageAllocation || _alignment > m_pageSize;
+#else
+        (void)_size;
+        (void)_alignment;
+        return true;
+#endif
+    }
+
+    // Whole large pages from one large page on, whole pages below
+    [[nodiscard]] size_t mappedLength(size_t _size) const noexcept
+    {
+        const size_t unit =
+            m_largePageSize != 0 && _size >= m_largePageSize ? m_largePageSize : m_pageSize;
+        return (_size + unit - 1) / unit * unit;
+    }
+
+    Byte* map(size_t _length, bool& _large)
+    {
+        _large = false;
+        const bool wantLarge = m_largePageSize != 0 && _length % m_largePageSize == 0;
+
+#if defined(MOSAIC_PAGE_STORAGE_VIRTUAL_ALLOC)
+        const auto virtualAlloc = [&](DWORD _type) -> void*
+        {
+            if (m_settings.numaNode == k_anyNumaNode)
+            {
+                return VirtualAlloc(nullptr, _length, _type, PAGE_READWRITE);
+            }
+            return VirtualAllocExNuma(GetCurrentProcess(), nullptr, _length, _type, PAGE_READWRITE,
+                                      DWORD(m_settings.numaNode));
+        };
+
+        void* memory = nullptr;
+        if (wantLarge)
+        {
+            memory = virtualAlloc(MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES);
+            _large = memory != nullptr;
+        }
+        if (!memory) memory = virtualAlloc(MEM_RESERVE | MEM_COMMIT);
+        if (!memory) throw std::bad_alloc();
+
+        return static_cast<Byte*>(memory);
+#elif defined(MOSAIC_PAGE_STORAGE_MMAP)
+        constexpr int k_protection = PROT_READ | PROT_WRITE;
+        constexpr int k_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+        void* memory = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+        if (wantLarge)
+        {
+            memory = ::mmap(nullptr, _length, k_protection, k_flags | MAP_HUGETLB, -1, 0);
+            _large = memory != MAP_FAILED;
+        }
+#endif
+        if (memory == MAP_FAILED)
+        {
+            memory = ::mmap(nullptr, _length, k_protection, k_flags, -1, 0);
+            if (memory == MAP_FAILED) throw std::bad_alloc();
+
+#if defined(MADV_HUGEPAGE)
+            if (wantLarge) ::madvise(memory, _length, MADV_HUGEPAGE);
+#endif
+        }
+
+        bindToNode(memory, _length);
+        return static_cast<Byte*>(memory);
+#else
+        (void)wantLarge;
+        throw std::bad_alloc();
+#endif
+    }
+
+    static void unmap(Byte* _memory, size_t _length) noexcept
+    {
+#if defined(MOSAIC_PAGE_STORAGE_VIRTUAL_ALLOC)
+        (void)_length;
+        VirtualFree(_memory, 0, MEM_RELEASE);
+#elif defined(MOSAIC_PAGE_STORAGE_MMAP)
+        ::munmap(_memory, _length);
+#else
+        (void)_memory;
+        (void)_length;
+#endif
+    }
+
+    // Before the pages are first touched, so they are faulted in on the node
+    void bindToNode([[maybe_unused]] void* _memory, [[maybe_unused]] size_t _length) const noexcept
+    {
+#if defined(MOSAIC_PAGE_STORAGE_MMAP) && defined(MOSAIC_PLATFORM_LINUX) && defined(SYS_mbind)
+        constexpr size_t k_maskBits = 1024;
+        constexpr int k_preferred = 1; // MPOL_PREFERRED, without depending on libnuma's header
+
+        if (m_settings.numaNode >= k_maskBits) return;
+
+        unsigned long mask[k_maskBits / (8 * sizeof(unsigned long))] = {};
+        mask[m_settings.numaNode / (8 * sizeof(unsigned long))] =
+            1ul << (m_settings.numaNode % (8 * sizeof(unsigned long)));
+
+        // best effort: the pages keep the default policy if the node does not exist
+        ::syscall(SYS_mbind, _memory, _length, k_preferred, mask, k_maskBits + 1, 0);
+#endif
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
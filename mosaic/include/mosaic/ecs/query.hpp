@@ -0,0 +1,312 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "component.hpp"
+#include "archetype.hpp"
+#include "component_registry.hpp"
+#include "entity_view.hpp"
+#include "sparse_storage.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+namespace detail
+{
+
+// The components an archetype must have and the ones it must not have to match a query, and
+// the sparse components an entity must (not) have on top of it.
+struct QueryKey
+{
+    ComponentSignature required;
+    ComponentSignature excluded;
+    std::vector<ComponentID> sparseRequired = {};
+    std::vector<ComponentID> sparseExcluded = {};
+
+    bool operator==(const QueryKey&) const = default;
+
+    // The match is decided once per archetype, never per entity.
+    [[nodiscard]] bool matches(const ComponentSignature& _signature) const
+    {
+        return _signature.containsAll(required) && !_signature.intersects(excluded);
+    }
+};
+
+/**
+ * @brief Registry-owned state of a persistent query: the key it matches and the list of
+ * matching archetypes, appended to by the registry whenever a matching archetype is created.
+ */
+struct QueryState
+{
+    QueryKey key;
+    std::vector<Archetype*> archetypes;
+    SparseJoin sparse = {}; // the sets of the sparse components of the key
+};
+
+// Builds the key of a query: Read<>, Write<> and With<> terms are required, Without<> ones
+// excluded, Optional<> ones take no part in the match. Sparse components go to the sparse lists.
+template <QueryTerm... Terms>
+[[nodiscard]] inline QueryKey queryKeyFromTerms(const ComponentRegistry* _registry)
+{
+    QueryKey key{ComponentSignature(_registry->maxCount()),
+                 ComponentSignature(_registry->maxCount())};
+
+    auto addTerm = [&]<typename Term>()
+    {
+        const ComponentID id = _registry->getID<TermComponent<Term>>();
+        const bool sparse = _registry->info(id).sparse;
+
+        if constexpr (k_termAccess<Term> == TermAccess::without)
+        {
+            if (sparse) key.sparseExcluded.push_back(id);
+            else key.excluded.setBit(id);
+        }
+        else if constexpr (k_termAccess<Term> != TermAccess::optional)
+        {
+            if (sparse) key.sparseRequired.push_back(id);
+            else key.required.setBit(id);
+        }
+    };
+
+    (addTerm.template operator()<Terms>(), ...);
+
+    std::ranges::sort(key.sparseRequired);
+    std::ranges::sort(key.sparseExcluded);
+    return key;
+}
+
+// Checks if a fetched term of the query is a sparse component (probed per entity).
+template <QueryTerm... Terms>
+[[nodiscard]] inline bool fetchesSparseTerms(const ComponentRegistry* _registry)
+{
+    return ((FetchedTerm<Terms> &&
+             _registry->info(_registry->getID<TermComponent<Terms>>()).sparse) ||
+            ...);
+}
+
+// The view type iterating the fetched terms of a query, With<> and Without<> terms dropped.
+template <typename Fetched, typename... Terms>
+struct QueryViewOf;
+
+template <FetchedTerm... Fetched>
+struct QueryViewOf<TypeList<Fetched...>>
+{
+    using type = ArchetypeSpanView<Fetched...>;
+};
+
+template <typename... Fetched, typename Term, typename... Rest>
+struct QueryViewOf<TypeList<Fetched...>, Term, Rest...>
+    : std::conditional_t<FetchedTerm<Term>, QueryViewOf<TypeList<Fetched..., Term>, Rest...>,
+                         QueryViewOf<TypeList<Fetched...>, Rest...>>
+{
+};
+
+} // namespace detail
+
+/**
+ * @brief The 'Query' class is a persistent, cheap-to-copy handle over the entities whose
+ * archetype matches a list of terms.
+ *
+ * A term is a plain component or Write<T> (required, fetched as T&), Read<T> (required, fetched
+ * as const T& and never stamped as changed), With<T> (required, not fetched), Without<T>
+ * (archetypes with T are skipped) or Optional<T> (fetched as T*, nullptr where absent). The
+ * iteration functions receive the fetched terms in the order they are listed.
+ *
+ * Unlike viewSubset(), the list of matching archetypes is maintained incrementally by the
+ * EntityRegistry, so iterating a query never scans unrelated archetypes nor allocates, and
+ * filtered-out archetypes cost nothing per entity. A query stays valid for the whole lifetime of
+ * the registry that created it (clear() included), but archetypes must not be created while it
+ * is being iterated.
+ *
+ * @tparam Terms The terms that define the query.
+ */
+template <detail::QueryTerm... Terms>
+class Query
+{
+   public:
+    using View = typename detail::QueryViewOf<detail::TypeList<>, Terms...>::type;
+
+   private:
+    const detail::QueryState* m_state;
+    const ComponentRegistry* m_componentRegistry;
+    const detail::SparseJoin* m_sparse = nullptr; // null when no sparse component is involved
+
+   public:
+    /**
+     * @brief Constructs a Query over the given registry-owned state.
+     *
+     * @param _state The state maintained by the EntityRegistry.
+     * @param _com The component registry for component type information.
+     */
+    Query(const detail::QueryState* _state, const ComponentRegistry* _com)
+        : m_state(_state), m_componentRegistry(_com)
+    {
+        if (m_state->sparse.filters() || detail::fetchesSparseTerms<Terms...>(_com))
+        {
+            m_sparse = &m_state->sparse;
+        }
+    };
+
+   public:
+    // Returns a non-owning view over the archetypes currently matching the query (readOnly() on
+    // the returned view skips change stamping).
+    [[nodiscard]] View view() const
+    {
+        return View(std::span<Archetype* const>(m_state->archetypes), m_componentRegistry,
+                    m_sparse);
+    }
+
+    /**
+     * @brief Applies the provided function to each entity matching the query.
+     *
+     * @see BasicEntityView::forEach
+     */
+    template <typename Func>
+        requires requires(View _view, Func&& _func) { _view.forEach(std::forward<Func>(_func)); }
+    void forEach(Func&& _func) const
+    {
+        view().forEach(std::forward<Func>(_func));
+    }
+
+    /**
+     * @brief Applies the provided function to contiguous runs of entities matching the query.
+     *
+     * @see BasicEntityView::forEachChunk
+     */
+    template <typename Func>
+        requires requires(View _view, Func&& _func) {
+            _view.forEachChunk(std::forward<Func>(_func));
+        }
+    void forEachChunk(Func&& _func) const
+    {
+        view().forEachChunk(std::forward<Func>(_func));
+    }
+
+    /**
+     * @brief Applies the provided function to the entities of the tick blocks matching a
+     * detail::Changed<> or detail::Added<> filter.
+     *
+     * @see BasicEntityView::forEach(detail::Changed<Cs...>, uint32_t, Func&&)
+     */
+    template <typename Filter, typename Func>
+    void forEach(Filter _filter, uint32_t _since, Func&& _func) const
+    {
+        view().forEach(_filter, _since, std::forward<Func>(_func));
+    }
+
+    // Chunk-wise version of the filtered forEach().
+    template <typename Filter, typename Func>
+    void forEachChunk(Filter _filter, uint32_t _since, Func&& _func) const
+    {
+        view().forEachChunk(_filter, _since, std::forward<Func>(_func));
+    }
+
+    /**
+     * @brief Applies the provided function to each entity matching the query, in parallel.
+     *
+     * @see BasicEntityView::parallelForEach
+     */
+    template <detail::TaskPool Pool, typename Func>
+        requires requires(View _view, Pool& _pool, Func&& _func) {
+            _view.parallelForEach(_pool, std::forward<Func>(_func));
+        }
+    void parallelForEach(Pool& _pool, Func&& _func,
+                         size_t _grainSize = detail::k_defaultGrainSize) const
+    {
+        view().parallelForEach(_pool, std::forward<Func>(_func), _grainSize);
+    }
+
+    /**
+     * @brief Applies the provided function to contiguous runs of matching entities, in parallel.
+     *
+     * @see BasicEntityView::parallelForEachChunk
+     */
+    template <detail::TaskPool Pool, typename Func>
+        requires requires(View _view, Pool& _pool, Func&& _func) {
+            _view.parallelForEachChunk(_pool, std::forward<Func>(_func));
+        }
+    void parallelForEachChunk(Pool& _pool, Func&& _func,
+                              size_t _grainSize = detail::k_defaultGrainSize) const
+    {
+        view().parallelForEachChunk(_pool, std::forward<Func>(_func), _grainSize);
+    }
+
+    // Returns the archetypes currently matching the query (empty ones included).
+    [[nodiscard]] std::span<Archetype* const> archetypes() const noexcept
+    {
+        return m_state->archetypes;
+    }
+
+    // Returns the components an archetype must have to match the query.
+    [[nodiscard]] const ComponentSignature& signature() const noexcept
+    {
+        return m_state->key.required;
+    }
+
+    // Returns the components an archetype must not have to match the query.
+    [[nodiscard]] const ComponentSignature& excluded() const noexcept
+    {
+        return m_state->key.excluded;
+    }
+
+    // Returns the number of entities currently matching the query (probing sparse components).
+    [[nodiscard]] size_t entityCount() const noexcept
+    {
+        size_t count = 0;
+
+        for (const Archetype* arch : m_state->archetypes)
+        {
+            if (!m_state->sparse.filters())
+            {
+                count += arch->size();
+                continue;
+            }
+
+            for (EntityID eid : arch->entityIDs()) count += m_state->sparse.admits(eid);
+        }
+
+        return count;
+    }
+
+    // Checks if no entity currently matches the query.
+    [[nodiscard]] bool empty() const noexcept { return entityCount() == 0; }
+
+    // Iterators walk the matching archetypes only, sparse filters and terms need forEach().
+    typename View::Iterator begin() const { return view().begin(); }
+    typename View::Iterator end() const { return view().end(); }
+};
+
+} // namespace ecs
+} // namespace mosaic
+
+namespace std
+{
+
+template <>
+struct hash<mosaic::ecs::detail::QueryKey>
+{
+    size_t operator()(const mosaic::ecs::detail::QueryKey& _key) const noexcept
+    {
+        constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+        uint64_t hash = std::hash<mosaic::ecs::ComponentSignature>{}(_key.required);
+        hash ^= std::hash<mosaic::ecs::ComponentSignature>{}(_key.excluded);
+        hash *= FNV_PRIME;
+
+        for (mosaic::ecs::ComponentID id : _key.sparseRequired) hash = (hash ^ id) * FNV_PRIME;
+        hash ^= 0xff;
+        for (mosaic::ecs::ComponentID id : _key.sparseExcluded) hash = (hash ^ id) * FNV_PRIME;
+
+        return static_cast<size_t>(hash);
+    }
+};
+
+} // namespace std
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <algorithm>
+#include <optional>
+
+#include <pieces/containers/flat_hash_map.hpp>
+#include <pieces/containers/small_vector.hpp>
+
+#include "entity.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+// What happens to the (source, target) pairs of a relation when their target is destroyed.
+enum class RelationCleanup : uint8_t
+{
+    removePair,    // the sources lose the pair and live on (targeting, ownership...)
+    destroySource, // the sources are destroyed with the target, recursively (parent/child)
+};
+
+struct RelationSettings
+{
+    RelationCleanup onTargetDestroyed = RelationCleanup::removePair;
+    bool exclusive = false; // a source has at most one target, adding a pair replaces it
+};
+
+namespace detail
+{
+
+/**
+ * @brief The (source, target) pairs of one relation kind, indexed both ways: the targets of a
+ * source and the sources of a target are each a single hash lookup away.
+ *
+ * Both sides are kept in small vectors, so a pair is added in O(1) and removed in O(degree) by
+ * swap-and-pop: the order of targetsOf()/sourcesOf() is not stable.
+ */
+class RelationIndex final
+{
+   public:
+    using Links = pieces::SmallVector<EntityID, 4>;
+
+   private:
+    RelationSettings m_settings;
+    pieces::FlatHashMap<EntityID, Links> m_targets; // by source
+    pieces::FlatHashMap<EntityID, Links> m_sources; // by target
+    size_t m_pairCount = 0;
+
+   public:
+    explicit RelationIndex(const RelationSettings& _settings) : m_settings(_settings) {}
+
+   public:
+    // Adds the pair, returns false if it already existed (replaces an exclusive source's target).
+    bool add(EntityID _source, EntityID _target)
+    {
+        Links& targets = m_targets[_source];
+        if (std::find(targets.begin(), targets.end(), _target) != targets.end()) return false;
+
+        if (m_settings.exclusive && !targets.empty())
+        {
+            unlink(m_sources, targets.front(), _source);
+            targets.clear();
+            --m_pairCount;
+        }
+
+        targets.push_back(_target);
+        m_sources[_target].push_back(_source);
+        ++m_pairCount;
+        return true;
+    }
+
+    // Removes the pair, returns whether it existed.
+    bool remove(EntityID _source, EntityID _target)
+    {
+        if (!unlink(m_targets, _source, _target)) return false;
+
+        unlink(m_sources, _target, _source);
+        --m_pairCount;
+        return true;
+    }
+
+    [[nodiscard]] bool contains(EntityID _source, EntityID _target) const
+    {
+        const std::span<const EntityID> targets = targetsOf(_source);
+        return std::find(targets.begin(), targets.end(), _target) != targets.end();
+    }
+
+    [[nodiscard]] std::span<const EntityID> targetsOf(EntityID _source) const
+    {
+        auto it = m_targets.find(_source);
+        if (it == m_targets.end()) return {};
+        return {it->second.data(), it->second.size()};
+    }
+
+    [[nodiscard]] std::span<const EntityID> sourcesOf(EntityID _target) const
+    {
+        auto it = m_sources.find(_target);
+        if (it == m_sources.end()) return {};
+        return {it->second.data(), it->second.size()};
+    }
+
+    // Drops every pair the entity is the source or the target of.
+    void erase(EntityID _eid)
+    {
+        if (auto it = m_targets.find(_eid); it != m_targets.end())
+        {
+            for (EntityID target : it->second) unlink(m_sources, target, _eid);
+            m_pairCount -= it->second.size();
+            m_targets.erase(it);
+        }
+
+        if (auto it = m_sources.find(_eid); it != m_sources.end())
+        {
+            for (EntityID source : it->second) unlink(m_targets, source, _eid);
+            m_pairCount -= it->second.size();
+            m_sources.erase(it);
+        }
+    }
+
+    void clear() noexcept
+    {
+        m_targets.clear();
+        m_sources.clear();
+        m_pairCount = 0;
+    }
+
+    [[nodiscard]] const RelationSettings& settings() const noexcept { return m_settings; }
+    [[nodiscard]] size_t size() const noexcept { return m_pairCount; }
+
+   private:
+    // Removes _value from the links of _key (dropping them once empty), returns whether it was in.
+    static bool unlink(pieces::FlatHashMap<EntityID, Links>& _map, EntityID _key, EntityID _value)
+    {
+        auto it = _map.find(_key);
+        if (it == _map.end()) return false;
+
+        Links& links = it->second;
+        auto found = std::find(links.begin(), links.end(), _value);
+        if (found == links.end()) return false;
+
+        *found = links.back();
+        links.pop_back();
+        if (links.empty()) _map.erase(it);
+        return true;
+    }
+};
+
+/**
+ * @brief The relation indices of a registry, by detail::componentTypeSlot<R>() of the relation
+ * kind R (kinds are plain C++ types and never part of an archetype signature).
+ */
+class RelationTable final
+{
+   private:
+    std::vector<std::optional<RelationIndex>> m_indices;
+    size_t m_kindCount = 0;
+    bool m_cascades = false; // whether any kind destroys its sources
+
+   public:
+    RelationIndex& registerKind(size_t _slot, const RelationSettings& _settings)
+    {
+        if (_slot >= m_indices.size()) m_indices.resize(_slot + 1);
+
+        if (!m_indices[_slot]) ++m_kindCount;
+        m_indices[_slot].emplace(_settings);
+
+        m_cascades = std::ranges::any_of(
+            m_indices,
+            [](const std::optional<RelationIndex>& _index) {
+                return _index &&
+                       _index->settings().onTargetDestroyed == RelationCleanup::destroySource;
+            });
+
+        return *m_indices[_slot];
+    }
+
+    [[nodiscard]] RelationIndex* find(size_t _slot) noexcept
+    {
+        return _slot < m_indices.size() && m_indices[_slot] ? &*m_indices[_slot] : nullptr;
+    }
+
+    [[nodiscard]] const RelationIndex* find(size_t _slot) const noexcept
+    {
+        return _slot < m_indices.size() && m_indices[_slot] ? &*m_indices[_slot] : nullptr;
+    }
+
+    /**
+     * @brief Appends to the list every entity destroyed along with it through a destroySource
+     * kind, transitively, each entity once (entities already listed are not appended again).
+     */
+    void expandCascade(std::vector<EntityID>& _eids) const
+    {
+        if (!m_cascades) return;
+
+        pieces::FlatHashSet<EntityID> listed;
+        listed.reserve(_eids.size());
+        for (EntityID eid : _eids) listed.insert(eid);
+
+        // the list grows while it is walked, every appended entity is visited in turn
+        for (size_t i = 0; i < _eids.size(); ++i)
+        {
+            for (const std::optional<RelationIndex>& index : m_indices)
+            {
+                if (!index || index->settings().onTargetDestroyed != RelationCleanup::destroySource)
+                {
+                    continue;
+                }
+
+                for (EntityID source : index->sourcesOf(_eids[i]))
+                {
+                    if (listed.insert(source).second) _eids.push_back(source);
+                }
+            }
+        }
+    }
+
+    // Drops every pair of every kind the entities are part of.
+    void erase(std::span<const EntityID> _eids)
+    {
+        for (std::optional<RelationIndex>& index : m_indices)
+        {
+            if (!index || index->size() == 0) continue;
+            for (EntityID eid : _eids) index->erase(eid);
+        }
+    }
+
+    // Drops every pair, the kinds stay registered.
+    void clearPairs() noexcept
+    {
+        for (std::optional<RelationIndex>& index : m_indices)
+        {
+            if (index) index->clear();
+        }
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return m_kindCount == 0; }
+};
+
+} // namespace detail
+} // namespace ecs
+} // namespace mosaic
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "typeless_vector.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+/**
+ * @brief The 'SharedValueTable' class interns the values of one shared component type: equal
+ * values share a single copy identified by a dense index.
+ *
+ * Values are stored in fixed-capacity pages that never reallocate, so their addresses stay valid
+ * for the lifetime of the table and archetypes can point straight at them.
+ *
+ * @note Values are compared bytewise (components are trivially copyable), so two values that only
+ * differ in padding bytes get distinct indices.
+ */
+class SharedValueTable final
+{
+   public:
+    using Byte = uint8_t;
+
+    // Number of values per page.
+    static constexpr size_t k_pageCapacity = 64;
+
+   private:
+    size_t m_valueSize;
+    std::vector<TypelessVector> m_pages;
+    std::unordered_multimap<uint64_t, uint32_t> m_indicesByHash;
+    size_t m_size = 0;
+
+   public:
+    /**
+     * @brief Constructs an empty SharedValueTable.
+     *
+     * @param _valueSize The size in bytes of a value (must be > 0).
+     */
+    explicit SharedValueTable(size_t _valueSize) : m_valueSize(_valueSize) {}
+
+   public:
+    /**
+     * @brief Returns the index of the value bytewise equal to the given one, a copy is inserted
+     * if there is none yet.
+     *
+     * @param _value A pointer to the value (m_valueSize bytes).
+     * @return The index of the value, stable for the lifetime of the table.
+     */
+    uint32_t intern(const void* _value)
+    {
+        const uint64_t hash = hashBytes(_value);
+
+        auto [first, last] = m_indicesByHash.equal_range(hash);
+        for (auto it = first; it != last; ++it)
+        {
+            if (std::memcmp(at(it->second), _value, m_valueSize) == 0) return it->second;
+        }
+
+        if (m_size % k_pageCapacity == 0) m_pages.emplace_back(m_valueSize, k_pageCapacity);
+        m_pages.back().pushBack(_value);
+
+        const uint32_t index = static_cast<uint32_t>(m_size++);
+        m_indicesByHash.emplace(hash, index);
+        return index;
+    }
+
+    [[nodiscard]] Byte* at(uint32_t _index) noexcept
+    {
+        return m_pages[_index / k_pageCapacity][_index % k_pageCapacity];
+    }
+
+    [[nodiscard]] const Byte* at(uint32_t _index) const noexcept
+    {
+        return m_pages[_index / k_pageCapacity][_index % k_pageCapacity];
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+    [[nodiscard]] size_t valueSize() const noexcept { return m_valueSize; }
+
+    [[nodiscard]] size_t memoryUsageInBytes() const noexcept
+    {
+        size_t usage = sizeof(*this);
+        for (const auto& page : m_pages) usage += page.memoryUsageInBytes();
+        return usage;
+    }
+
+   private:
+    // FNV-1a over the bytes of a value.
+    [[nodiscard]] uint64_t hashBytes(const void* _value) const noexcept
+    {
+        constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+        constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+        const Byte* bytes = static_cast<const Byte*>(_value);
+        uint64_t hash = FNV_OFFSET_BASIS;
+
+        for (size_t i = 0; i < m_valueSize; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+
+        return hash;
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mosaic/core/mapped_file.hpp"
+#include "mosaic/defines.hpp"
+
+#include "entity_registry.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+/**
+ * @brief Writes a snapshot of the registry to a file (see EntityRegistry::writeSnapshot()).
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+inline void saveSnapshotToFile(const EntityRegistry& _registry,
+                               const std::filesystem::path& _path)
+{
+    std::vector<uint8_t> bytes;
+    _registry.writeSnapshot(bytes);
+
+    std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+
+    if (!file) throw std::runtime_error("Failed to write " + _path.string());
+}
+
+/**
+ * @brief Replaces the content of the registry with the snapshot stored in a file.
+ *
+ * The file is memory-mapped and the archetype rows are bulk-inserted straight from the mapping,
+ * so the load costs about one copy of the entity data.
+ *
+ * @throws std::runtime_error if the file cannot be read or the snapshot cannot be loaded (see
+ * EntityRegistry::readSnapshot()).
+ */
+inline void loadSnapshotFromFile(EntityRegistry& _registry, const std::filesystem::path& _path)
+{
+    const core::MappedFile file(_path);
+    _registry.readSnapshot(file.bytes());
+}
+
+} // namespace ecs
+} // namespace mosaic
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace mosaic
+{
+namespace ecs
+{
+
+namespace detail
+{
+
+/*
+ * Snapshot layout (native endianness, every section starts on an 8-byte boundary):
+ *
+ *   SnapshotHeader
+ *   SnapshotComponent[componentCount], each followed by its name
+ *   EntityGen[recordCount]                 generation of every entity ID ever allocated
+ *   for each archetype:
+ *     SnapshotArchetype
+ *     uint32_t ids[componentCount]         source ComponentIDs of the signature, ascending
+ *     uint32_t offsets[componentCount]     row offsets (0 for tags and shared components)
+ *     for each shared component: uint32_t id, then the value
+ *     rows[entityCount * stride]           interleaved rows, 16-byte aligned, EntityMeta first
+ */
+
+inline constexpr uint32_t k_snapshotMagic = 0x504E534D; // "MSNP"
+inline constexpr uint32_t k_snapshotVersion = 1;
+
+struct SnapshotHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t componentCount;
+    uint32_t archetypeCount;
+    uint32_t recordCount;
+    uint32_t reserved;
+};
+
+struct SnapshotComponent
+{
+    uint32_t nameLength;
+    uint32_t size;
+    uint32_t alignment;
+    uint32_t shared;
+};
+
+struct SnapshotArchetype
+{
+    uint32_t componentCount;
+    uint32_t sharedCount;
+    uint32_t entityCount;
+    uint32_t stride;
+};
+
+// Appends the sections of a snapshot to a byte buffer.
+class SnapshotWriter final
+{
+   private:
+    std::vector<uint8_t>& m_out;
+
+   public:
+    explicit SnapshotWriter(std::vector<uint8_t>& _out) : m_out(_out) {}
+
+   public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void put(const T& _value)
+    {
+        putBytes(&_value, sizeof(T));
+    }
+
+    void putBytes(const void* _data, size_t _size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(_data);
+        m_out.insert(m_out.end(), bytes, bytes + _size);
+    }
+
+    // Pads with zeros up to the next multiple of _alignment.
+    void align(size_t _alignment)
+    {
+        m_out.resize((m_out.size() + _alignment - 1) & ~(_alignment - 1));
+    }
+};
+
+// Reads the sections of a snapshot in place, every read is bounds-checked.
+class SnapshotReader final
+{
+   private:
+    std::span<const uint8_t> m_data;
+    size_t m_cursor = 0;
+
+   public:
+    explicit SnapshotReader(std::span<const uint8_t> _data) : m_data(_data) {}
+
+   public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    [[nodiscard]] T get()
+    {
+        T value;
+        std::memcpy(&value, getBytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // Returns a pointer to the next _size bytes (possibly unaligned) and skips them.
+    [[nodiscard]] const uint8_t* getBytes(size_t _size)
+    {
+        if (_size > m_data.size() - m_cursor) throw std::runtime_error("Snapshot is truncated.");
+
+        const uint8_t* bytes = m_data.data() + m_cursor;
+        m_cursor += _size;
+        return bytes;
+    }
+
+    void align(size_t _alignment)
+    {
+        const size_t aligned = (m_cursor + _alignment - 1) & ~(_alignment - 1);
+        if (aligned > m_data.size()) throw std::runtime_error("Snapshot is truncated.");
+        m_cursor = aligned;
+    }
+
+    [[nodiscard]] size_t tell() const noexcept { return m_cursor; }
+
+    void seek(size_t _offset)
+    {
+        if (_offset > m_data.size()) throw std::runtime_error("Snapshot is truncated.");
+        m_cursor = _offset;
+    }
+};
+
+} // namespace detail
+
+// Where EntityRegistry::appendSnapshot() stopped in a snapshot, the next call resumes there.
+struct SnapshotCursor
+{
+    size_t offset = 0;      // of the archetype section being inserted, 0 before the first call
+    uint32_t archetype = 0; // sections inserted
+    size_t row = 0;         // rows of the section inserted
+    bool done = false;
+};
+
+} // namespace ecs
+} // namespace mosaic
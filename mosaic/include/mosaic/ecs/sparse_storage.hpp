@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "typeless_sparse_set.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+namespace detail
+{
+
+using SparseComponentSet = TypelessSparseSet<64, false>;
+
+/**
+ * @brief The values of the sparse components of a registry (see
+ * ComponentRegistry::registerSparseComponent()), one TypelessSparseSet keyed by EntityID per
+ * component.
+ *
+ * Sets are created once per component and never destroyed before the registry, so queries can
+ * keep pointers to them. Tags get one byte per entity, the sets cannot have a zero stride.
+ */
+class SparseStorage final
+{
+   private:
+    std::vector<std::unique_ptr<SparseComponentSet>> m_sets; // by ComponentID
+    std::vector<ComponentID> m_ids;                          // of the created sets
+
+   public:
+    // Returns the set of the component, created on first use.
+    SparseComponentSet& getOrCreate(ComponentID _id, size_t _size)
+    {
+        if (_id >= m_sets.size()) m_sets.resize(_id + 1);
+
+        if (!m_sets[_id])
+        {
+            m_sets[_id] = std::make_unique<SparseComponentSet>(std::max<size_t>(_size, 1));
+            m_ids.push_back(_id);
+        }
+
+        return *m_sets[_id];
+    }
+
+    [[nodiscard]] SparseComponentSet* find(ComponentID _id) const noexcept
+    {
+        return _id < m_sets.size() ? m_sets[_id].get() : nullptr;
+    }
+
+    // Drops the values of the entity in every set.
+    void erase(EntityID _eid)
+    {
+        for (ComponentID id : m_ids)
+        {
+            SparseComponentSet& set = *m_sets[id];
+            if (set.contains(_eid)) set.remove(_eid);
+        }
+    }
+
+    // Drops every value, the sets stay alive.
+    void clear() noexcept
+    {
+        for (ComponentID id : m_ids) m_sets[id]->clear();
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return m_ids.empty(); }
+};
+
+/**
+ * @brief How a query joins the sparse components: the sets an entity must be in, the ones it
+ * must not be in, and the storage its fetched sparse terms are probed in.
+ */
+struct SparseJoin
+{
+    const SparseStorage* storage = nullptr;
+    std::vector<const SparseComponentSet*> required;
+    std::vector<const SparseComponentSet*> excluded;
+
+    // Checks if the entity passes the sparse filters (one probe per set).
+    [[nodiscard]] bool admits(EntityID _eid) const noexcept
+    {
+        for (const SparseComponentSet* set : required)
+        {
+            if (!set->contains(_eid)) return false;
+        }
+
+        for (const SparseComponentSet* set : excluded)
+        {
+            if (set->contains(_eid)) return false;
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] bool filters() const noexcept { return !required.empty() || !excluded.empty(); }
+};
+
+} // namespace detail
+} // namespace ecs
+} // namespace mosaic
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "archetype.hpp"
+#include "component_registry.hpp"
+#include "query.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+namespace detail
+{
+
+template <typename T, typename... Ts>
+inline constexpr bool k_occursOnce = (std::is_same_v<T, Ts> + ... + 0) == 1;
+
+/**
+ * @brief The row layout of a static archetype, computed at compile time: EntityMeta first, then
+ * the components in the order they are listed (not by ComponentID), each aligned. Tags have no
+ * bytes and an offset of 0.
+ */
+template <Component... Ts>
+struct StaticLayout
+{
+    static_assert((k_occursOnce<Ts, Ts...> && ...), "A component is listed twice");
+
+    static constexpr size_t k_count = sizeof...(Ts);
+
+    static constexpr std::array<size_t, k_count> k_offsets = []
+    {
+        std::array<size_t, k_count> offsets{};
+        size_t offset = sizeof(EntityMeta);
+        size_t i = 0;
+
+        auto place = [&]<typename T>()
+        {
+            if constexpr (!TagComponent<T>)
+            {
+                offset = (offset + alignof(T) - 1) & ~(alignof(T) - 1);
+                offsets[i] = offset;
+                offset += sizeof(T);
+            }
+            ++i;
+        };
+
+        (place.template operator()<Ts>(), ...);
+        return offsets;
+    }();
+
+    // Same rule as calculateStrideFromSignature(): the row ends with its last component.
+    static constexpr size_t k_stride = []
+    {
+        size_t stride = sizeof(EntityMeta);
+        size_t i = 0;
+        ((stride = TagComponent<Ts> ? stride : k_offsets[i] + sizeof(Ts), ++i), ...);
+        return stride;
+    }();
+
+    template <typename T>
+    static constexpr size_t k_indexOf = []
+    {
+        size_t index = 0;
+        bool found = false;
+        ((found = found || std::is_same_v<T, Ts>, index += found ? 0 : 1), ...);
+        return index;
+    }();
+
+    template <typename T>
+        requires(k_occursOnce<T, Ts...> && !TagComponent<T>)
+    static constexpr size_t k_offsetOf = k_offsets[k_indexOf<T>];
+};
+
+// A row layout registered with EntityRegistry::registerStaticArchetype(), used in place of the
+// one derived from the signature whenever the archetype is (re)created.
+struct StaticRowLayout
+{
+    ComponentOffsets offsets;
+    size_t stride;
+};
+
+} // namespace detail
+
+/**
+ * @brief The 'StaticArchetype' class is a handle over the entities made of exactly Ts..., whose
+ * archetype uses the compile-time detail::StaticLayout<Ts...> (see
+ * EntityRegistry::registerStaticArchetype()).
+ *
+ * Its forEach() walks the rows with constant offsets and stride, no offset map is looked up and
+ * the loop body is open to unrolling and vectorization. The archetype is otherwise an ordinary
+ * one: dynamic queries match it, components are added and removed through the usual edges and
+ * snapshots round-trip it. Entities with more components than Ts... are not visited (use a
+ * Query for them). Like a Query, the handle stays valid for the lifetime of the registry.
+ *
+ * @tparam Ts The components of the archetype, in row order.
+ */
+template <Component... Ts>
+class StaticArchetype
+{
+   public:
+    using Layout = detail::StaticLayout<Ts...>;
+
+   private:
+    const detail::QueryState* m_state; // matches the exact signature, so one archetype at most
+    std::array<ComponentID, sizeof...(Ts)> m_ids;
+
+   public:
+    /**
+     * @brief Constructs a StaticArchetype over the given registry-owned state.
+     *
+     * @param _state The state of a query matching exactly the signature of Ts...
+     * @param _ids The IDs of Ts..., in the same order.
+     */
+    StaticArchetype(const detail::QueryState* _state,
+                    const std::array<ComponentID, sizeof...(Ts)>& _ids)
+        : m_state(_state), m_ids(_ids) {};
+
+   public:
+    /**
+     * @brief Applies the provided function to each entity of the archetype, and stamps its
+     * components as changed.
+     *
+     * Interleaved rows are addressed as `row + Layout::k_offsets[i]` with a constant stride;
+     * chunked archetypes (chunked mode, or adaptive ones past their split threshold) are walked
+     * column by column, the columns being resolved once per chunk.
+     *
+     * @param _func The function to apply. It should accept an EntityMeta and one reference per
+     * component of Ts... (tags receive a shared instance).
+     */
+    template <typename Func>
+        requires std::is_invocable_r_v<void, Func, EntityMeta, Ts&...>
+    void forEach(Func&& _func) const
+    {
+        forEachImpl(_func, std::index_sequence_for<Ts...>{});
+    }
+
+    // Returns the number of entities made of exactly Ts...
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return m_state->archetypes.empty() ? 0 : m_state->archetypes.front()->size();
+    }
+
+    // Returns the archetype, or nullptr while it does not exist (before its first entity).
+    [[nodiscard]] Archetype* archetype() const noexcept
+    {
+        return m_state->archetypes.empty() ? nullptr : m_state->archetypes.front();
+    }
+
+   private:
+    template <typename Func, size_t... Is>
+    void forEachImpl(Func& _func, std::index_sequence<Is...>) const
+    {
+        Archetype* arch = archetype();
+        if (!arch || arch->empty()) return;
+
+        if (arch->isChunked())
+        {
+            for (size_t c = 0; c < arch->chunkCount(); ++c)
+            {
+                const size_t count = arch->chunkSize(c);
+                const EntityMeta* metas = arch->chunkMetas(c);
+                const std::tuple<Ts*...> columns{columnOf<Ts>(arch, c, m_ids[Is])...};
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    _func(metas[i], elementOf<Ts>(std::get<Is>(columns), i)...);
+                }
+            }
+
+            markWritten(arch, arch->chunkCount());
+            return;
+        }
+
+        uint8_t* rows = arch->data();
+        const size_t count = arch->size();
+
+        for (size_t r = 0; r < count; ++r)
+        {
+            uint8_t* row = rows + r * Layout::k_stride;
+            _func(*std::launder(reinterpret_cast<EntityMeta*>(row)),
+                  rowElementOf<Ts>(row + Layout::k_offsets[Is])...);
+        }
+
+        markWritten(arch, (count + Archetype::k_tickBlockRows - 1) / Archetype::k_tickBlockRows);
+    }
+
+    template <typename T>
+    [[nodiscard]] static T* columnOf(Archetype* _arch, size_t _chunk, ComponentID _id)
+    {
+        if constexpr (TagComponent<T>) return &detail::tagInstance<T>();
+        else return std::launder(reinterpret_cast<T*>(_arch->chunkColumn(_chunk, _id)));
+    }
+
+    template <typename T>
+    [[nodiscard]] static T& elementOf(T* _column, size_t _index) noexcept
+    {
+        if constexpr (TagComponent<T>) return *_column;
+        else return _column[_index];
+    }
+
+    template <typename T>
+    [[nodiscard]] static T& rowElementOf(uint8_t* _data) noexcept
+    {
+        if constexpr (TagComponent<T>) return detail::tagInstance<T>();
+        else return *std::launder(reinterpret_cast<T*>(_data));
+    }
+
+    // Stamps every non-tag component as changed over the first _blockCount tick blocks.
+    void markWritten(Archetype* _arch, size_t _blockCount) const
+    {
+        size_t i = 0;
+        ((TagComponent<Ts> ? void() : _arch->markChanged(m_ids[i], 0, _blockCount), ++i), ...);
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
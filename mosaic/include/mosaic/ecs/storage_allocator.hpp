@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace mosaic
+{
+namespace ecs
+{
+
+/**
+ * @brief Where the row arrays of interleaved archetypes, the chunks of chunked ones and the slabs
+ * of a ChunkArena come from (see EntityRegistry), the global heap when none is given.
+ *
+ * The memory handed out is NOT initialized: without an allocator the unused capacity of the row
+ * arrays is zero-filled, with one it is left as is, the storage always writing a row before it is
+ * read. The padding bytes of rows then hold whatever the memory held, which only matters to
+ * byte-wise comparisons of snapshots.
+ *
+ * @note An allocator shared by registries updated on different threads (see WorldSet) must be
+ * thread-safe, the built-in ones are.
+ */
+class StorageAllocator
+{
+   public:
+    using Byte = uint8_t;
+
+    virtual ~StorageAllocator() = default;
+
+    /**
+     * @brief Allocates _size bytes aligned on _alignment (a power of two).
+     *
+     * @throws std::bad_alloc if the memory cannot be allocated.
+     */
+    [[nodiscard]] virtual Byte* allocate(size_t _size, size_t _alignment) = 0;
+
+    // Gives back memory obtained from allocate() with the same size and alignment.
+    virtual void deallocate(Byte* _memory, size_t _size, size_t _alignment) noexcept = 0;
+
+    /**
+     * @brief The size the large allocations are best rounded to (a ChunkArena rounds its slabs up
+     * to it), e.g. the large page size.
+     */
+    [[nodiscard]] virtual size_t granularity() const noexcept { return 1; }
+};
+
+/**
+ * @brief The global heap without the zero-fill: for registries whose rows are always written
+ * before they are read, i.e. every registry that does not compare snapshots byte-wise.
+ */
+class HeapStorageAllocator final : public StorageAllocator
+{
+   public:
+    [[nodiscard]] Byte* allocate(size_t _size, size_t _alignment) override
+    {
+        return static_cast<Byte*>(::operator new(_size, std::align_val_t{_alignment}));
+    }
+
+    void deallocate(Byte* _memory, size_t, size_t _alignment) noexcept override
+    {
+        ::operator delete(_memory, std::align_val_t{_alignment});
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
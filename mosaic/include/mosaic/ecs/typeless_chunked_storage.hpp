@@ -0,0 +1,478 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <bitset>
+#include <memory>
+#include <span>
+#include <new>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#include "mosaic/defines.hpp"
+
+#include "entity.hpp"
+#include "chunk_arena.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+/**
+ * @brief A typeless, column-oriented (SoA) storage made of fixed-size chunks.
+ *
+ * Every chunk holds up to `chunkCapacity()` entities and stores one contiguous column per
+ * registered column layout entry. Column 0 is conventionally used for the EntityMeta of each row,
+ * the remaining columns hold one component type each. Iterating a single column therefore only
+ * touches the bytes of that component instead of the whole interleaved row.
+ *
+ * Like TypelessSparseSet it keeps a paged sparse mapping from entity IDs to dense indices, and
+ * removal uses swap-and-pop semantics (last row is moved into the removed slot).
+ *
+ * @tparam PageSize The size of each sparse page (default is 64).
+ */
+template <size_t PageSize = 64>
+    requires(PageSize > 0)
+class TypelessChunkedStorage final
+{
+   public:
+    using Byte = uint8_t;
+
+    static constexpr size_t k_defaultChunkSizeInBytes = 16 * BYTES_PER_KIB;
+    static constexpr size_t k_columnAlignment = MOSAIC_CACHE_LINE_SIZE;
+
+    /**
+     * @brief Describes a single column of the storage (size and alignment of one element).
+     */
+    struct ColumnLayout
+    {
+        size_t size;
+        size_t alignment;
+    };
+
+   private:
+    struct Page
+    {
+        std::array<size_t, PageSize> sparse{}; // maps entity index to dense index
+        std::bitset<PageSize> present{};       // whether entity index is present
+        size_t presentCount = 0;               // optimization to avoid popcount
+    };
+
+    // Gives the chunk back to its arena, or to the global heap if it has none
+    struct ChunkDeleter
+    {
+        ChunkArena* arena = nullptr;
+        size_t size = 0;
+
+        void operator()(Byte* _ptr) const noexcept
+        {
+            if (arena) arena->deallocate(_ptr, size);
+            else ::operator delete(_ptr, std::align_val_t{k_columnAlignment});
+        }
+    };
+
+    using ChunkPtr = std::unique_ptr<Byte, ChunkDeleter>;
+
+    std::vector<ColumnLayout> m_columns;          // layout of every column
+    std::vector<size_t> m_columnOffsets;          // byte offset of every column inside a chunk
+    size_t m_chunkCapacity = 0;                   // rows per chunk
+    size_t m_chunkSizeInBytes = 0;                // actual allocation size of a chunk
+    std::vector<ChunkPtr> m_chunks;               // owned chunk allocations
+    ChunkArena* m_arena = nullptr;                // where chunks come from (null = global heap)
+    std::vector<std::unique_ptr<Page>> m_pages{}; // stores pages of sparse entity IDs
+    std::vector<EntityID> m_denseEntities{};      // stores entity IDs densely
+
+   public:
+    /**
+     * @brief Constructs a chunked storage for the given column layout.
+     *
+     * @param _columns The layout of every column (at least one column is required).
+     * @param _chunkSizeInBytes The target size of a chunk (default is 16 KiB). If a single row
+     * does not fit the chunk is enlarged to hold exactly one row.
+     * @param _arena The arena chunks are allocated from, or nullptr for the global heap (it must
+     * outlive the storage).
+     * @throws std::invalid_argument if no columns are provided or a column has zero size.
+     */
+    explicit TypelessChunkedStorage(std::vector<ColumnLayout> _columns,
+                                    size_t _chunkSizeInBytes = k_defaultChunkSizeInBytes,
+                                    ChunkArena* _arena = nullptr)
+        : m_columns(std::move(_columns)),
+          m_arena(_arena)
+    {
+        if (m_columns.empty()) throw std::invalid_argument("At least one column is required");
+
+        for (const auto& col : m_columns)
+        {
+            if (col.size == 0) throw std::invalid_argument("Column size must be > 0");
+            if (col.alignment > k_columnAlignment)
+            {
+                throw std::invalid_argument("Column alignment exceeds chunk alignment");
+            }
+        }
+
+        computeLayout(_chunkSizeInBytes);
+    }
+
+    TypelessChunkedStorage(TypelessChunkedStorage&&) noexcept = default;
+    TypelessChunkedStorage& operator=(TypelessChunkedStorage&&) noexcept = default;
+
+    TypelessChunkedStorage(const TypelessChunkedStorage&) = delete;
+    TypelessChunkedStorage& operator=(const TypelessChunkedStorage&) = delete;
+
+   public:
+    /**
+     * @brief Appends a new, uninitialized row for the given entity.
+     *
+     * @param _eid The ID of the entity (must NOT already be present).
+     * @return The dense index of the new row.
+     */
+    size_t emplaceUninitialized(EntityID _eid)
+    {
+        const size_t denseIdx = m_denseEntities.size();
+
+        if (denseIdx == m_chunks.size() * m_chunkCapacity) allocateChunk();
+
+        Page& page = ensurePageExists(_eid);
+        const size_t offset = getPageOffset(_eid);
+
+        page.sparse[offset] = denseIdx;
+        page.present.set(offset);
+        ++page.presentCount;
+
+        m_denseEntities.push_back(_eid);
+
+        return denseIdx;
+    }
+
+    /**
+     * @brief Appends multiple uninitialized rows.
+     *
+     * @param _eids Array of entity IDs to insert (all must be NEW).
+     * @param _count Number of entities to insert.
+     * @return The dense index of the first new row.
+     */
+    size_t emplaceUninitializedBulk(const EntityID* _eids, size_t _count)
+    {
+        const size_t first = m_denseEntities.size();
+
+        reserve(first + _count);
+
+        for (size_t i = 0; i < _count; ++i) emplaceUninitialized(_eids[i]);
+
+        return first;
+    }
+
+    /**
+     * @brief Removes the entity with swap-and-pop semantics.
+     *
+     * @param _eid The ID of the entity to remove.
+     * @return true if the entity was present and removed.
+     */
+    bool remove(EntityID _eid)
+    {
+        const size_t pageIdx = getPageIndex(_eid);
+        if (pageIdx >= m_pages.size() || !m_pages[pageIdx]) return false;
+
+        Page& page = *m_pages[pageIdx];
+        const size_t pageOffset = getPageOffset(_eid);
+
+        if (!page.present.test(pageOffset)) return false;
+
+        const size_t denseIdx = page.sparse[pageOffset];
+        const size_t lastIdx = m_denseEntities.size() - 1;
+
+        if (denseIdx < lastIdx)
+        {
+            const EntityID lastEntity = m_denseEntities[lastIdx];
+
+            // Move every column of the last row into the freed slot
+            for (size_t col = 0; col < m_columns.size(); ++col)
+            {
+                std::memcpy(at(denseIdx, col), at(lastIdx, col), m_columns[col].size);
+            }
+
+            m_denseEntities[denseIdx] = lastEntity;
+            m_pages[getPageIndex(lastEntity)]->sparse[getPageOffset(lastEntity)] = denseIdx;
+        }
+
+        m_denseEntities.pop_back();
+        page.present.reset(pageOffset);
+        --page.presentCount;
+
+        return true;
+    }
+
+    /**
+     * @brief Reorders the rows: dense index i afterwards holds the entity previously at dense
+     * index _order[i].
+     *
+     * Every cycle of the permutation is rotated through a single temporary row, so only the rows
+     * that actually move are copied (once each, column by column).
+     *
+     * @param _order A permutation of [0, size()).
+     */
+    void permute(std::span<const uint32_t> _order)
+    {
+        size_t rowSize = 0;
+        for (const auto& col : m_columns) rowSize += col.size;
+
+        std::unique_ptr<Byte[]> tmp(new Byte[rowSize]);
+        std::vector<bool> placed(_order.size(), false);
+
+        for (size_t start = 0; start < _order.size(); ++start)
+        {
+            if (placed[start] || _order[start] == start) continue;
+
+            const EntityID startEntity = m_denseEntities[start];
+            for (size_t col = 0, offset = 0; col < m_columns.size(); ++col)
+            {
+                std::memcpy(tmp.get() + offset, at(start, col), m_columns[col].size);
+                offset += m_columns[col].size;
+            }
+
+            size_t current = start;
+            while (_order[current] != start)
+            {
+                const size_t next = _order[current];
+
+                for (size_t col = 0; col < m_columns.size(); ++col)
+                {
+                    std::memcpy(at(current, col), at(next, col), m_columns[col].size);
+                }
+
+                setDenseEntity(current, m_denseEntities[next]);
+                placed[current] = true;
+                current = next;
+            }
+
+            for (size_t col = 0, offset = 0; col < m_columns.size(); ++col)
+            {
+                std::memcpy(at(current, col), tmp.get() + offset, m_columns[col].size);
+                offset += m_columns[col].size;
+            }
+
+            setDenseEntity(current, startEntity);
+            placed[current] = true;
+        }
+    }
+
+    /**
+     * @brief Returns the dense index of the entity, or size() if it is not present.
+     */
+    [[nodiscard]] size_t indexOf(EntityID _eid) const noexcept
+    {
+        const size_t pageIdx = getPageIndex(_eid);
+        if (pageIdx >= m_pages.size() || !m_pages[pageIdx]) return size();
+
+        const Page& page = *m_pages[pageIdx];
+        const size_t pageOffset = getPageOffset(_eid);
+
+        if (!page.present.test(pageOffset)) return size();
+
+        return page.sparse[pageOffset];
+    }
+
+    [[nodiscard]] bool contains(EntityID _eid) const noexcept { return indexOf(_eid) != size(); }
+
+    /**
+     * @brief Returns a pointer to the element of the given column at the given dense index.
+     */
+    [[nodiscard]] Byte* at(size_t _denseIdx, size_t _column) noexcept
+    {
+        Byte* chunk = m_chunks[_denseIdx / m_chunkCapacity].get();
+        return chunk + m_columnOffsets[_column] +
+               (_denseIdx % m_chunkCapacity) * m_columns[_column].size;
+    }
+
+    [[nodiscard]] const Byte* at(size_t _denseIdx, size_t _column) const noexcept
+    {
+        const Byte* chunk = m_chunks[_denseIdx / m_chunkCapacity].get();
+        return chunk + m_columnOffsets[_column] +
+               (_denseIdx % m_chunkCapacity) * m_columns[_column].size;
+    }
+
+    /**
+     * @brief Returns a pointer to the first element of a column inside a chunk.
+     */
+    [[nodiscard]] Byte* columnData(size_t _chunkIdx, size_t _column) noexcept
+    {
+        return m_chunks[_chunkIdx].get() + m_columnOffsets[_column];
+    }
+
+    [[nodiscard]] const Byte* columnData(size_t _chunkIdx, size_t _column) const noexcept
+    {
+        return m_chunks[_chunkIdx].get() + m_columnOffsets[_column];
+    }
+
+    // Returns the number of rows stored in the given chunk.
+    [[nodiscard]] size_t chunkSize(size_t _chunkIdx) const noexcept
+    {
+        const size_t begin = _chunkIdx * m_chunkCapacity;
+        return std::min(m_chunkCapacity, m_denseEntities.size() - begin);
+    }
+
+    // Returns the number of chunks currently holding at least one row.
+    [[nodiscard]] size_t chunkCount() const noexcept
+    {
+        return (m_denseEntities.size() + m_chunkCapacity - 1) / m_chunkCapacity;
+    }
+
+    [[nodiscard]] size_t chunkCapacity() const noexcept { return m_chunkCapacity; }
+    [[nodiscard]] size_t chunkSizeInBytes() const noexcept { return m_chunkSizeInBytes; }
+    [[nodiscard]] size_t columnCount() const noexcept { return m_columns.size(); }
+    [[nodiscard]] const ColumnLayout& column(size_t _column) const { return m_columns[_column]; }
+
+    [[nodiscard]] size_t size() const noexcept { return m_denseEntities.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_denseEntities.empty(); }
+    [[nodiscard]] size_t capacity() const noexcept { return m_chunks.size() * m_chunkCapacity; }
+
+    [[nodiscard]] size_t memoryUsageInBytes() const noexcept
+    {
+        size_t total = sizeof(*this);
+        total += m_denseEntities.capacity() * sizeof(EntityID);
+        total += m_chunks.size() * m_chunkSizeInBytes;
+        total += m_pages.capacity() * sizeof(std::unique_ptr<Page>);
+
+        for (const auto& pagePtr : m_pages)
+        {
+            if (pagePtr) total += sizeof(Page);
+        }
+
+        return total;
+    }
+
+    // Reserves enough chunks to store the given number of rows.
+    void reserve(size_t _rowCount)
+    {
+        while (capacity() < _rowCount) allocateChunk();
+        m_denseEntities.reserve(_rowCount);
+    }
+
+    void clear() noexcept
+    {
+        m_denseEntities.clear();
+        m_pages.clear();
+    }
+
+    // Frees the chunks past the last used one and the unused capacity of the dense arrays.
+    void shrinkToFit()
+    {
+        m_chunks.resize(chunkCount());
+        m_chunks.shrink_to_fit();
+        m_denseEntities.shrink_to_fit();
+        m_pages.shrink_to_fit();
+    }
+
+    /**
+     * @brief Frees the sparse pages that no longer map any entity, then drops the trailing null
+     * page slots.
+     *
+     * @return The number of pages freed.
+     */
+    size_t releaseEmptyPages() noexcept
+    {
+        size_t released = 0;
+
+        for (auto& page : m_pages)
+        {
+            if (page && page->presentCount == 0)
+            {
+                page.reset();
+                ++released;
+            }
+        }
+
+        while (!m_pages.empty() && !m_pages.back()) m_pages.pop_back();
+
+        return released;
+    }
+
+    const std::vector<EntityID>& keys() const noexcept { return m_denseEntities; }
+
+   private:
+    size_t getPageIndex(EntityID _eid) const { return _eid / PageSize; }
+
+    size_t getPageOffset(EntityID _eid) const { return _eid % PageSize; }
+
+    // Stores the entity at the given dense index and points its sparse entry at it.
+    void setDenseEntity(size_t _denseIdx, EntityID _eid)
+    {
+        m_denseEntities[_denseIdx] = _eid;
+        m_pages[getPageIndex(_eid)]->sparse[getPageOffset(_eid)] = _denseIdx;
+    }
+
+    Page& ensurePageExists(EntityID _eid)
+    {
+        const size_t pageIdx = getPageIndex(_eid);
+
+        if (pageIdx >= m_pages.size())
+        {
+            size_t newSize = std::max(pageIdx + 1, m_pages.size() * 2);
+            m_pages.resize(newSize);
+        }
+
+        if (!m_pages[pageIdx]) m_pages[pageIdx] = std::make_unique<Page>();
+
+        return *m_pages[pageIdx];
+    }
+
+    static constexpr size_t alignUp(size_t _value, size_t _alignment)
+    {
+        return (_value + _alignment - 1) & ~(_alignment - 1);
+    }
+
+    // Computes the number of bytes a chunk needs to hold _capacity rows.
+    size_t bytesForCapacity(size_t _capacity) const
+    {
+        size_t bytes = 0;
+
+        for (const auto& col : m_columns)
+        {
+            bytes = alignUp(bytes, k_columnAlignment);
+            bytes += col.size * _capacity;
+        }
+
+        return alignUp(bytes, k_columnAlignment);
+    }
+
+    void computeLayout(size_t _chunkSizeInBytes)
+    {
+        size_t rowSize = 0;
+        for (const auto& col : m_columns) rowSize += col.size;
+
+        // Start from the unpadded estimate and shrink until padding fits the budget
+        size_t capacity = std::max<size_t>(1, _chunkSizeInBytes / rowSize);
+        while (capacity > 1 && bytesForCapacity(capacity) > _chunkSizeInBytes) --capacity;
+
+        m_chunkCapacity = capacity;
+        m_chunkSizeInBytes = bytesForCapacity(capacity);
+
+        m_columnOffsets.resize(m_columns.size());
+
+        size_t offset = 0;
+        for (size_t col = 0; col < m_columns.size(); ++col)
+        {
+            offset = alignUp(offset, k_columnAlignment);
+            m_columnOffsets[col] = offset;
+            offset += m_columns[col].size * m_chunkCapacity;
+        }
+    }
+
+    void allocateChunk()
+    {
+        static_assert(k_columnAlignment == ChunkArena::k_alignment);
+
+        m_chunks.reserve(m_chunks.size() + 1);
+
+        auto* memory = m_arena ? m_arena->allocate(m_chunkSizeInBytes)
+                               : static_cast<Byte*>(::operator new(
+                                     m_chunkSizeInBytes, std::align_val_t{k_columnAlignment}));
+        m_chunks.emplace_back(memory, ChunkDeleter{m_arena, m_chunkSizeInBytes});
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
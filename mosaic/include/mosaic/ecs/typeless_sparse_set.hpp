@@ -4,6 +4,7 @@
 #include <vector>
 #include <bitset>
 #include <memory>
+#include <span>
 #include <cstdint>
 #include <cstring>
 #include <stdexcept>
@@ -57,10 +58,13 @@ class TypelessSparseSet final
      *
      * @param _stride The size in bytes of each component.
      * @param _initialCapacity Initial capacity for components (default is 1).
+     * @param _storageAllocator Where the components are allocated, or nullptr for the global heap
+     * (it must outlive the set).
      * @throws std::invalid_argument if _stride is 0.
      */
-    explicit TypelessSparseSet(size_t _stride, size_t _initialCapacity = 1)
-        : m_componentTuples(_stride, _initialCapacity)
+    explicit TypelessSparseSet(size_t _stride, size_t _initialCapacity = 1,
+                               StorageAllocator* _storageAllocator = nullptr)
+        : m_componentTuples(_stride, _initialCapacity, _storageAllocator)
     {
         if (_stride == 0) throw std::invalid_argument("Component stride must be > 0");
     }
@@ -88,6 +92,28 @@ class TypelessSparseSet final
         }
     }
 
+    /**
+     * @brief Inserts a new entity and returns its uninitialized component slot.
+     *
+     * Unlike insertBulkUninitialized() the dense arrays grow geometrically, so repeated
+     * single-entity insertions stay amortized O(1).
+     *
+     * @param _eid The ID of the entity to insert (must be NEW).
+     * @return A pointer to the uninitialized component slot of the entity.
+     */
+    Byte* emplaceUninitialized(EntityID _eid)
+    {
+        Page& page = ensurePageExists(_eid);
+        auto offset = getPageOffset(_eid);
+
+        page.sparse[offset] = m_denseEntities.size();
+        m_denseEntities.push_back(_eid);
+        page.present.set(offset);
+        ++page.presentCount;
+
+        return m_componentTuples.appendUninitialized(1);
+    }
+
     bool tryInsert(EntityID _eid, const void* _componentData)
     {
         Page& page = ensurePageExists(_eid);
@@ -256,6 +282,45 @@ class TypelessSparseSet final
         return notFound;
     }
 
+    /**
+     * @brief Reorders the dense storage: dense index i afterwards holds the entity previously at
+     * dense index _order[i].
+     *
+     * Every cycle of the permutation is rotated through a single temporary row, so only the rows
+     * that actually move are copied (once each).
+     *
+     * @param _order A permutation of [0, size()).
+     */
+    void permute(std::span<const uint32_t> _order)
+    {
+        const size_t stride = m_componentTuples.stride();
+        std::unique_ptr<Byte[]> tmp(new Byte[stride]);
+        std::vector<bool> placed(_order.size(), false);
+
+        for (size_t start = 0; start < _order.size(); ++start)
+        {
+            if (placed[start] || _order[start] == start) continue;
+
+            const EntityID startEntity = m_denseEntities[start];
+            std::memcpy(tmp.get(), m_componentTuples[start], stride);
+
+            size_t current = start;
+            while (_order[current] != start)
+            {
+                const size_t next = _order[current];
+
+                std::memcpy(m_componentTuples[current], m_componentTuples[next], stride);
+                setDenseEntity(current, m_denseEntities[next]);
+                placed[current] = true;
+                current = next;
+            }
+
+            std::memcpy(m_componentTuples[current], tmp.get(), stride);
+            setDenseEntity(current, startEntity);
+            placed[current] = true;
+        }
+    }
+
     /**
      * @brief Transfers ALL entities to another sparse set with data transformation.
      *
@@ -416,6 +481,30 @@ class TypelessSparseSet final
         m_pages.shrink_to_fit();
     }
 
+    /**
+     * @brief Frees the sparse pages that no longer map any entity (what AggressiveReclaim does on
+     * every removal), then drops the trailing null page slots.
+     *
+     * @return The number of pages freed.
+     */
+    size_t releaseEmptyPages() noexcept
+    {
+        size_t released = 0;
+
+        for (auto& page : m_pages)
+        {
+            if (page && page->presentCount == 0)
+            {
+                page.reset();
+                ++released;
+            }
+        }
+
+        while (!m_pages.empty() && !m_pages.back()) m_pages.pop_back();
+
+        return released;
+    }
+
     const std::vector<EntityID>& keys() const noexcept { return m_denseEntities; }
     TypelessVector& data() noexcept { return m_componentTuples; }
     const TypelessVector& data() const noexcept { return m_componentTuples; }
@@ -459,6 +548,13 @@ class TypelessSparseSet final
 
     size_t getPageOffset(EntityID _eid) const { return _eid % PageSize; }
 
+    // Stores the entity at the given dense index and points its sparse entry at it.
+    void setDenseEntity(size_t _denseIdx, EntityID _eid)
+    {
+        m_denseEntities[_denseIdx] = _eid;
+        m_pages[getPageIndex(_eid)]->sparse[getPageOffset(_eid)] = _denseIdx;
+    }
+
     Page& ensurePageExists(EntityID _eid)
     {
         const size_t pageIdx = getPageIndex(_eid);
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <stdexcept>
 #include <cstring>
+#include <memory>
+#include <new>
 #include <utility>
 
-#include <pieces/memory/contiguous_allocator.hpp>
+#include "storage_allocator.hpp"
 
 namespace mosaic
 {
@@ -17,38 +20,52 @@ namespace ecs
  * @brief A vector-like container for untyped, fixed-stride elements.
  * Mimics std::vector API closely, except it is untyped.
  *
- * Backed by ContiguousAllocatorBase<uint8_t>.
+ * Backed by the global heap, the capacity past the size zero-filled, or by a StorageAllocator
+ * (see EntityRegistry), the capacity then left uninitialized. Growing only copies the elements
+ * in use and never clears the bytes it is about to overwrite.
  */
 class TypelessVector final
 {
    public:
     using Byte = uint8_t;
 
+    static constexpr size_t k_alignment = alignof(std::max_align_t);
+
    private:
     size_t m_stride;
-    pieces::ContiguousAllocatorBase<Byte> m_allocator;
+    Byte* m_data = nullptr;
     size_t m_size;
     size_t m_capacity;
+    StorageAllocator* m_storageAllocator; // null = global heap
 
    public:
     /**
      * @brief Constructs a TypelessVector with the specified stride and initial capacity.
      *
      * @param _stride The size in bytes of each element (must be > 0).
-     * @param _capacity The initial capacity of the vector (default is 1).
-     * @throws std::invalid_argument if _stride is 0.
+     * @param _capacity The initial capacity of the vector (default is 1, must be > 0).
+     * @param _storageAllocator Where the elements are allocated, or nullptr for the global heap
+     * (it must outlive the vector).
+     * @throws std::invalid_argument if _stride or _capacity is 0.
      */
-    TypelessVector(size_t _stride, size_t _capacity = 1)
-        : m_stride(_stride), m_allocator(_capacity * _stride), m_size(0), m_capacity(_capacity)
+    TypelessVector(size_t _stride, size_t _capacity = 1,
+                   StorageAllocator* _storageAllocator = nullptr)
+        : m_stride(_stride), m_size(0), m_capacity(_capacity), m_storageAllocator(_storageAllocator)
     {
         if (_stride == 0) throw std::invalid_argument("Stride must be > 0");
+        if (_capacity == 0) throw std::invalid_argument("Capacity must be > 0");
+
+        m_data = allocateBuffer(_capacity, 0);
     }
 
+    ~TypelessVector() { freeBuffer(); }
+
     TypelessVector(TypelessVector&& _other) noexcept
         : m_stride(_other.m_stride),
-          m_allocator(std::move(_other.m_allocator)),
+          m_data(std::exchange(_other.m_data, nullptr)),
           m_size(_other.m_size),
-          m_capacity(_other.m_capacity)
+          m_capacity(_other.m_capacity),
+          m_storageAllocator(_other.m_storageAllocator)
     {
         _other.m_stride = 0;
         _other.m_size = 0;
@@ -59,14 +76,19 @@ class TypelessVector final
     {
         if (this == &_other) return *this;
 
+        freeBuffer();
+
         m_stride = _other.m_stride;
-        m_allocator = std::move(_other.m_allocator);
+        m_data = std::exchange(_other.m_data, nullptr);
         m_size = _other.m_size;
         m_capacity = _other.m_capacity;
+        m_storageAllocator = _other.m_storageAllocator;
 
         _other.m_stride = 0;
         _other.m_size = 0;
         _other.m_capacity = 0;
+
+        return *this;
     }
 
     TypelessVector(const TypelessVector&) = delete;
@@ -84,8 +106,8 @@ class TypelessVector final
         return (*this)[_idx];
     }
 
-    Byte* data() { return m_allocator.getBuffer(); }
-    const Byte* data() const { return m_allocator.getBuffer(); }
+    Byte* data() { return m_data; }
+    const Byte* data() const { return m_data; }
 
     void pushBack(const void* _src)
     {
@@ -165,8 +187,8 @@ class TypelessVector final
     {
         if (_i == _j) return;
 
-        Byte* a = m_allocator.getBuffer() + _i * m_stride;
-        Byte* b = m_allocator.getBuffer() + _j * m_stride;
+        Byte* a = m_data + _i * m_stride;
+        Byte* b = m_data + _j * m_stride;
 
         std::unique_ptr<Byte[]> tmp(new Byte[m_stride]);
 
@@ -179,6 +201,7 @@ class TypelessVector final
     size_t capacity() const { return m_capacity; }
     bool empty() const { return m_size == 0; }
     size_t stride() const { return m_stride; }
+    StorageAllocator* storageAllocator() const { return m_storageAllocator; }
 
     size_t memoryUsageInBytes() const { return sizeof(*this) + m_capacity * m_stride; }
 
@@ -186,15 +209,7 @@ class TypelessVector final
     {
         if (_capacity <= m_capacity) return;
 
-        pieces::ContiguousAllocatorBase<Byte> newAlloc(_capacity * m_stride);
-
-        if (m_size > 0)
-        {
-            std::memcpy(newAlloc.getBuffer(), m_allocator.getBuffer(), m_size * m_stride);
-        }
-
-        m_allocator = std::move(newAlloc);
-        m_capacity = _capacity;
+        reallocate(_capacity);
     }
 
     void resize(size_t _size)
@@ -207,23 +222,15 @@ class TypelessVector final
 
     void shrinkToFit()
     {
-        if (m_size < m_capacity)
-        {
-            pieces::ContiguousAllocatorBase<Byte> newAlloc(m_size * m_stride);
-
-            if (m_size > 0)
-            {
-                std::memcpy(newAlloc.getBuffer(), m_allocator.getBuffer(), m_size * m_stride);
-            }
+        // The allocator cannot hold an empty buffer, an empty vector keeps room for one element
+        const size_t capacity = std::max<size_t>(m_size, 1);
 
-            m_allocator = std::move(newAlloc);
-            m_capacity = m_size;
-        }
+        if (capacity < m_capacity) reallocate(capacity);
     }
 
-    Byte* operator[](size_t _idx) { return m_allocator.getBuffer() + _idx * m_stride; }
+    Byte* operator[](size_t _idx) { return m_data + _idx * m_stride; }
 
-    const Byte* operator[](size_t _idx) const { return m_allocator.getBuffer() + _idx * m_stride; }
+    const Byte* operator[](size_t _idx) const { return m_data + _idx * m_stride; }
 
    public:
     struct Iterator
@@ -252,11 +259,11 @@ class TypelessVector final
         Byte* operator*() const { return ptr; }
     };
 
-    Iterator begin() { return Iterator(m_allocator.getBuffer(), m_stride); }
-    Iterator end() { return Iterator(m_allocator.getBuffer() + m_size * m_stride, m_stride); }
+    Iterator begin() { return Iterator(m_data, m_stride); }
+    Iterator end() { return Iterator(m_data + m_size * m_stride, m_stride); }
 
-    Iterator begin() const { return Iterator(m_allocator.getBuffer(), m_stride); }
-    Iterator end() const { return Iterator(m_allocator.getBuffer() + m_size * m_stride, m_stride); }
+    Iterator begin() const { return Iterator(m_data, m_stride); }
+    Iterator end() const { return Iterator(m_data + m_size * m_stride, m_stride); }
 
    private:
     void ensureCapacity(size_t _required)
@@ -266,6 +273,40 @@ class TypelessVector final
         size_t newCap = std::max(_required, m_capacity == 0 ? size_t(1) : m_capacity * 2);
         reserve(newCap);
     }
+
+    // A buffer of _capacity elements whose first _kept ones are about to be overwritten
+    Byte* allocateBuffer(size_t _capacity, size_t _kept)
+    {
+        const size_t bytes = _capacity * m_stride;
+        if (m_storageAllocator) return m_storageAllocator->allocate(bytes, k_alignment);
+
+        auto* buffer = static_cast<Byte*>(::operator new(bytes, std::align_val_t{k_alignment}));
+        std::memset(buffer + _kept * m_stride, 0, bytes - _kept * m_stride);
+        return buffer;
+    }
+
+    void freeBuffer() noexcept
+    {
+        if (!m_data) return;
+
+        if (m_storageAllocator)
+        {
+            m_storageAllocator->deallocate(m_data, m_capacity * m_stride, k_alignment);
+        }
+        else ::operator delete(m_data, std::align_val_t{k_alignment});
+
+        m_data = nullptr;
+    }
+
+    void reallocate(size_t _capacity)
+    {
+        Byte* buffer = allocateBuffer(_capacity, m_size);
+        if (m_size > 0) std::memcpy(buffer, m_data, m_size * m_stride);
+
+        freeBuffer();
+        m_data = buffer;
+        m_capacity = _capacity;
+    }
 };
 
 } // namespace ecs
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "chunk_arena.hpp"
+#include "component_registry.hpp"
+#include "entity_registry.hpp"
+
+namespace mosaic
+{
+namespace ecs
+{
+
+// Identifies a world of a WorldSet, never reused by the set.
+using WorldID = uint32_t;
+
+/**
+ * @brief An independent simulation instance (a match, an AI rollout...): an entity registry and
+ * the chunk arena backing its chunked archetypes.
+ *
+ * Worlds share the component registry of their WorldSet but nothing else, so different worlds
+ * can be updated on different threads without synchronization.
+ */
+class World final
+{
+   private:
+    WorldID m_id;
+    ChunkArena m_chunkArena; // declared first, outlives the archetypes of the registry
+    EntityRegistry m_registry;
+
+   public:
+    World(WorldID _id, const ComponentRegistry* _componentRegistry,
+          ArchetypeStorageMode _storageMode, size_t _splitThresholdInBytes,
+          pieces::AllocationStats* _memoryStats = nullptr,
+          StorageAllocator* _storageAllocator = nullptr)
+        : m_id(_id),
+          m_chunkArena(_storageAllocator),
+          m_registry(_componentRegistry, _storageMode, _splitThresholdInBytes, &m_chunkArena,
+                     _storageAllocator)
+    {
+        m_chunkArena.setStats(_memoryStats);
+    }
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+   public:
+    [[nodiscard]] WorldID id() const noexcept { return m_id; }
+
+    [[nodiscard]] EntityRegistry& registry() noexcept { return m_registry; }
+    [[nodiscard]] const EntityRegistry& registry() const noexcept { return m_registry; }
+
+    [[nodiscard]] ChunkArena& chunkArena() noexcept { return m_chunkArena; }
+    [[nodiscard]] const ChunkArena& chunkArena() const noexcept { return m_chunkArena; }
+
+    /**
+     * @brief Runs a full compaction pass over the registry (see EntityRegistry::compact()), then
+     * gives the slabs of the arena that became unused back to the system.
+     *
+     * @return The number of bytes released by the arena.
+     */
+    size_t releaseMemory()
+    {
+        m_registry.compact();
+        return m_chunkArena.trim();
+    }
+};
+
+/**
+ * @brief A set of independent worlds sharing one read-only component registry, updated serially
+ * or one task per world on a thread pool.
+ *
+ * Every world owns its archetypes and its chunk arena, so updating worlds in parallel involves no
+ * shared mutable state: the component registry is only read (components must all be registered
+ * before the first update).
+ */
+class WorldSet final
+{
+   private:
+    const ComponentRegistry* m_componentRegistry;
+    ArchetypeStorageMode m_storageMode;
+    size_t m_splitThresholdInBytes;
+    pieces::AllocationStats* m_memoryStats = nullptr; // of the chunk arenas of the worlds
+    StorageAllocator* m_storageAllocator = nullptr;    // backing every world, null = global heap
+    std::vector<std::unique_ptr<World>> m_worlds; // in creation order, addresses are stable
+    WorldID m_nextID = 0;
+
+   public:
+    /**
+     * @brief Constructs an empty set of worlds.
+     *
+     * @param _componentRegistry The component registry shared by every world.
+     * @param _storageMode The storage mode of the registry of every world (default is adaptive, so
+     * large archetypes grow in chunks allocated from the world's arena).
+     * @param _splitThresholdInBytes The split threshold of adaptive archetypes.
+     */
+    explicit WorldSet(const ComponentRegistry* _componentRegistry,
+                      ArchetypeStorageMode _storageMode = ArchetypeStorageMode::adaptive,
+                      size_t _splitThresholdInBytes = Archetype::k_defaultSplitThresholdInBytes)
+        : m_componentRegistry(_componentRegistry),
+          m_storageMode(_storageMode),
+          m_splitThresholdInBytes(_splitThresholdInBytes)
+    {
+    }
+
+   public:
+    // Creates a new, empty world, the reference stays valid until the world is destroyed.
+    World& createWorld()
+    {
+        m_worlds.push_back(std::make_unique<World>(m_nextID++, m_componentRegistry, m_storageMode,
+                                                   m_splitThresholdInBytes, m_memoryStats,
+                                                   m_storageAllocator));
+        return *m_worlds.back();
+    }
+
+    /**
+     * @brief Counts the chunk arenas of the worlds created next in the stats (shared by worlds
+     * updated in parallel, the counters are atomic), e.g. tools::MemoryTracker's "ecs" ones.
+     */
+    void setMemoryStats(pieces::AllocationStats* _stats) noexcept { m_memoryStats = _stats; }
+
+    /**
+     * @brief Backs the arenas and the interleaved rows of the worlds created next with the
+     * allocator (shared by worlds updated in parallel, it must be thread-safe and outlive them),
+     * e.g. a PageStorageAllocator for large pages on the node of the simulation threads.
+     */
+    void setStorageAllocator(StorageAllocator* _allocator) noexcept
+    {
+        m_storageAllocator = _allocator;
+    }
+
+    // Destroys the world with the given ID, returns whether it existed.
+    bool destroyWorld(WorldID _id)
+    {
+        return std::erase_if(m_worlds, [_id](const std::unique_ptr<World>& _world)
+                             { return _world->id() == _id; }) != 0;
+    }
+
+    // Returns the world with the given ID, or nullptr if there is none.
+    [[nodiscard]] World* findWorld(WorldID _id) noexcept
+    {
+        auto it = std::ranges::find(m_worlds, _id, &World::id);
+        return it != m_worlds.end() ? it->get() : nullptr;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return m_worlds.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_worlds.empty(); }
+
+    [[nodiscard]] const ComponentRegistry* componentRegistry() const noexcept
+    {
+        return m_componentRegistry;
+    }
+
+    // Invokes the function on every world in creation order, on the calling thread.
+    template <typename Func>
+        requires std::is_invocable_v<Func&, World&>
+    void forEach(Func&& _func)
+    {
+        for (const std::unique_ptr<World>& world : m_worlds) _func(*world);
+    }
+
+    /**
+     * @brief Invokes the function on every world, one task per world on the pool, and waits for
+     * all of them.
+     *
+     * The calling thread updates the first world. The function may do anything with the world it
+     * is given (structural changes included) but must not touch the other worlds or register
+     * components. The first exception thrown by a task is rethrown once every task is joined.
+     *
+     * @param _pool The pool the worlds are dispatched to via enqueueToWorker().
+     * @param _func The function to invoke, as func(World&).
+     */
+    template <detail::TaskPool Pool, typename Func>
+        requires std::is_invocable_v<const Func&, World&>
+    void parallelForEach(Pool& _pool, const Func& _func)
+    {
+        detail::dispatchTasks(_pool, m_worlds.size(),
+                              [&](size_t _index) { _func(*m_worlds[_index]); });
+    }
+};
+
+} // namespace ecs
+} // namespace mosaic
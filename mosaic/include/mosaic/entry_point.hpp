@@ -6,10 +6,13 @@
 #include <mosaic/core/sys_console.hpp>
 #include <mosaic/tools/logger.hpp>
 #include <mosaic/tools/logger_default_sink.hpp>
+#include <mosaic/tools/logger_file_sink.hpp>
 #include <mosaic/tools/tracer.hpp>
 #include <mosaic/core/cmd_line_parser.hpp>
+#include <mosaic/core/isa_dispatch.hpp>
 #include <mosaic/core/platform.hpp>
 #include <mosaic/core/application.hpp>
+#include <mosaic/graphics/render_profile.hpp>
 
 #ifndef MOSAIC_PLATFORM_ANDROID
 
@@ -26,6 +29,10 @@ int runApp(const std::vector<std::string>& _cmdLineArgs, Args&&... _appConstucto
 
     auto cmdLineParser = core::CommandLineParser::getInstance();
 
+    // the profile of the render system the application creates, unless it sets its own
+    graphics::registerRenderProfileOptions(*cmdLineParser, graphics::getDefaultRenderProfile());
+    core::registerISAOptions(*cmdLineParser);
+
     auto parseResult = cmdLineParser->parseCommandLine(_cmdLineArgs);
 
     if (parseResult.has_value())
@@ -40,11 +47,16 @@ int runApp(const std::vector<std::string>& _cmdLineArgs, Args&&... _appConstucto
 
     core::SystemConsole::create();
 
-    tools::Logger::initialize();
+    // callers only copy their records, the logging thread formats and writes them
+    tools::Logger::Config loggerConfig;
+    loggerConfig.async = true;
+
+    tools::Logger::initialize(loggerConfig);
 
     auto logger = tools::Logger::getInstance();
 
     logger->addSink<tools::DefaultSink>("default", tools::DefaultSink());
+    logger->addSink<tools::FileSink>("file", tools::FileSink());
 
     tools::Tracer::initialize();
 
@@ -61,6 +73,7 @@ int runApp(const std::vector<std::string>& _cmdLineArgs, Args&&... _appConstucto
         if (result.isErr())
         {
             MOSAIC_ERROR(result.error().c_str());
+            logger->flush();
             core::SystemConsole::destroy();
             return 1;
         }
@@ -295,8 +308,9 @@ extern "C"
             /* Main event loop */                                                              \
             while (!_pApp->destroyRequested)                                                   \
             {                                                                                  \
-                /* Process all pending events */                                               \
-                int timeout = 0; /* Non-blocking */                                            \
+                /* Process all pending events, the first wait as long as the app is idle */    \
+                int timeout = static_cast<int>(                                                \
+                    std::chrono::ceil<std::chrono::milliseconds>(app->getIdleWait()).count()); \
                 int events = 0;                                                                \
                 android_poll_source* pSource = nullptr;                                        \
                                                                                                \
@@ -319,6 +333,8 @@ extern "C"
                     {                                                                          \
                         pSource->process(_pApp, pSource);                                      \
                     }                                                                          \
+                                                                                               \
+                    timeout = 0; /* Non-blocking for the events left */                        \
                 }                                                                              \
                                                                                                \
                 /* Run application logic if platform is ready */                               \
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace mosaic
+{
+namespace exec
+{
+namespace detail
+{
+
+// Set once the cache of the thread is destroyed, blocks freed later go back to the heap.
+inline thread_local bool t_blockCacheDestroyed = false;
+
+/**
+ * @brief Per-thread cache of freed blocks of one size, handed out again by the next allocations
+ * of the thread before falling back to the heap.
+ *
+ * Blocks may be freed by another thread than the one that allocated them (a promise completed by
+ * a worker, a future dropped by the main thread), they simply join the cache of the freeing
+ * thread. Each cache keeps at most `k_maxCachedBlocks` blocks and gives the surplus to a depot
+ * shared by every thread, in batches of `k_batchSize`, where the threads allocating more than
+ * they free (the main thread submitting tasks the workers destroy) take them back from.
+ */
+template <size_t Size, size_t Alignment>
+class BlockCache final
+{
+   private:
+    static constexpr size_t k_maxCachedBlocks = 4096;
+    static constexpr size_t k_batchSize = 256;
+    static constexpr size_t k_maxDepotBatches = 64;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    static_assert(Size >= sizeof(FreeBlock));
+    static_assert(k_maxCachedBlocks >= k_batchSize);
+
+    // Chains of k_batchSize blocks, one lock per batch moved in or out
+    struct Depot
+    {
+        std::mutex mutex;
+        std::vector<FreeBlock*> batches;
+
+        Depot() { batches.reserve(k_maxDepotBatches); }
+
+        ~Depot()
+        {
+            for (FreeBlock* batch : batches) releaseChain(batch);
+        }
+    };
+
+    FreeBlock* m_head = nullptr;
+    size_t m_count = 0;
+
+   public:
+    ~BlockCache()
+    {
+        t_blockCacheDestroyed = true;
+
+        releaseChain(m_head);
+    }
+
+   public:
+    static void* allocate()
+    {
+        if (t_blockCacheDestroyed) return ::operator new(Size, std::align_val_t{Alignment});
+
+        BlockCache& cache = local();
+        if (!cache.m_head && !cache.refill())
+        {
+            return ::operator new(Size, std::align_val_t{Alignment});
+        }
+
+        FreeBlock* block = cache.m_head;
+        cache.m_head = block->next;
+        cache.m_count--;
+
+        return block;
+    }
+
+    static void deallocate(void* _block) noexcept
+    {
+        if (t_blockCacheDestroyed) return release(_block);
+
+        BlockCache& cache = local();
+        if (cache.m_count == k_maxCachedBlocks) cache.spill();
+
+        cache.m_head = ::new (_block) FreeBlock{cache.m_head};
+        cache.m_count++;
+    }
+
+   private:
+    static BlockCache& local() noexcept
+    {
+        thread_local BlockCache s_cache;
+        return s_cache;
+    }
+
+    static Depot& depot() noexcept
+    {
+        static Depot s_depot;
+        return s_depot;
+    }
+
+    static void release(void* _block) noexcept
+    {
+        ::operator delete(_block, std::align_val_t{Alignment});
+    }
+
+    static void releaseChain(FreeBlock* _head) noexcept
+    {
+        while (_head)
+        {
+            FreeBlock* next = _head->next;
+            release(_head);
+            _head = next;
+        }
+    }
+
+    // Takes a batch from the depot into the empty cache.
+    bool refill() noexcept
+    {
+        Depot& shared = depot();
+
+        std::lock_guard lock(shared.mutex);
+        if (shared.batches.empty()) return false;
+
+        m_head = shared.batches.back();
+        m_count = k_batchSize;
+        shared.batches.pop_back();
+
+        return true;
+    }
+
+    // Moves the newest k_batchSize blocks of the full cache to the depot, to the heap once the
+    // depot is full as well.
+    void spill() noexcept
+    {
+        FreeBlock* batch = m_head;
+        FreeBlock* last = m_head;
+        for (size_t i = 1; i < k_batchSize; ++i) last = last->next;
+
+        m_head = last->next;
+        m_count -= k_batchSize;
+        last->next = nullptr;
+
+        Depot& shared = depot();
+
+        {
+            std::lock_guard lock(shared.mutex);
+
+            // reserved up front, push_back() cannot throw below the cap
+            if (shared.batches.size() < k_maxDepotBatches)
+            {
+                shared.batches.push_back(batch);
+                return;
+            }
+        }
+
+        releaseChain(batch);
+    }
+};
+
+// The spilled callables of MoveOnlyTask are pooled in power of two size classes up to this size,
+// larger ones (or over-aligned ones) are left to the heap.
+inline constexpr size_t k_minPooledCallableSize = 64;
+inline constexpr size_t k_maxPooledCallableSize = 1024;
+
+template <typename F>
+inline constexpr bool k_isPooledCallable =
+    sizeof(F) <= k_maxPooledCallableSize && alignof(F) <= alignof(std::max_align_t);
+
+template <typename F>
+using CallableCache = BlockCache<std::bit_ceil(std::max(sizeof(F), k_minPooledCallableSize)),
+                                 alignof(std::max_align_t)>;
+
+} // namespace detail
+} // namespace exec
+} // namespace mosaic
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace mosaic
+{
+namespace exec
+{
+
+namespace detail
+{
+
+// Shared by a CancellationSource and its tokens
+struct CancellationState
+{
+    static constexpr int64_t k_noDeadline = std::numeric_limits<int64_t>::max();
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<int64_t> deadline{k_noDeadline}; // steady_clock ticks
+
+    bool isCancellationRequested() noexcept
+    {
+        if (cancelled.load(std::memory_order_acquire)) return true;
+
+        const int64_t ticks = deadline.load(std::memory_order_relaxed);
+        if (ticks == k_noDeadline) return false;
+
+        if (std::chrono::steady_clock::now().time_since_epoch().count() < ticks) return false;
+
+        // later checks skip the clock
+        cancelled.store(true, std::memory_order_release);
+        return true;
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Read side of a cancellation: tasks enqueued with it are skipped once it is cancelled,
+ * and running ones may poll it to return early.
+ *
+ * Tokens are cheap to copy (one shared pointer) and all observe the CancellationSource they came
+ * from. A default-constructed token is never cancelled.
+ *
+ * @see CancellationSource
+ */
+class CancellationToken
+{
+   private:
+    std::shared_ptr<detail::CancellationState> m_state;
+
+    friend class CancellationSource;
+
+    explicit CancellationToken(std::shared_ptr<detail::CancellationState> _state) noexcept
+        : m_state(std::move(_state))
+    {
+    }
+
+   public:
+    CancellationToken() noexcept = default;
+
+    /**
+     * @brief Whether the source was cancelled or its deadline passed. Reads the clock only when
+     * the source has a deadline.
+     */
+    [[nodiscard]] bool isCancellationRequested() const noexcept
+    {
+        return m_state && m_state->isCancellationRequested();
+    }
+
+    /**
+     * @brief Whether the token comes from a source, and so may ever be cancelled.
+     */
+    [[nodiscard]] bool canBeCancelled() const noexcept { return m_state != nullptr; }
+};
+
+/**
+ * @brief Write side of a cancellation, shared by every task working toward the same goal (a
+ * streamed chunk, a speculative path search).
+ *
+ * Cancelling is sticky and does not interrupt running tasks: the ones still queued are dropped
+ * when a worker takes them (their futures become cancelled), the running ones see
+ * isCancellationRequested() at their next poll. A deadline cancels the source once it passes.
+ * Copies share the same state.
+ *
+ * @example
+ *   CancellationSource streaming;
+ *   streaming.cancelAfter(50ms);
+ *   pool.enqueueToWorker(streaming.token(), [token = streaming.token()] {
+ *       for (auto& mip : mips) if (!token.isCancellationRequested()) decode(mip);
+ *   });
+ *   // the player moved away
+ *   streaming.cancel();
+ */
+class CancellationSource
+{
+   private:
+    std::shared_ptr<detail::CancellationState> m_state;
+
+   public:
+    CancellationSource() : m_state(std::make_shared<detail::CancellationState>()) {}
+
+    // no move operations, a source always has a state
+    CancellationSource(const CancellationSource&) = default;
+    CancellationSource& operator=(const CancellationSource&) = default;
+
+    // Cancelled once the deadline passes
+    explicit CancellationSource(std::chrono::steady_clock::time_point _deadline)
+        : CancellationSource()
+    {
+        setDeadline(_deadline);
+    }
+
+    [[nodiscard]] CancellationToken token() const noexcept { return CancellationToken(m_state); }
+
+    /**
+     * @brief Cancels the tokens of the source.
+     *
+     * @return true if this call cancelled it, false if it already was.
+     */
+    bool cancel() noexcept
+    {
+        return !m_state->cancelled.exchange(true, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Cancels the tokens once the deadline passes, replacing the previous deadline. A
+     * deadline already past cancels at the next check.
+     */
+    void setDeadline(std::chrono::steady_clock::time_point _deadline) noexcept
+    {
+        m_state->deadline.store(_deadline.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    template <typename Rep, typename Period>
+    void cancelAfter(const std::chrono::duration<Rep, Period>& _timeout) noexcept
+    {
+        setDeadline(std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(_timeout));
+    }
+
+    [[nodiscard]] bool isCancellationRequested() const noexcept
+    {
+        return m_state->isCancellationRequested();
+    }
+};
+
+} // namespace exec
+} // namespace mosaic
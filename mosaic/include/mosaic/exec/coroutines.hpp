@@ -0,0 +1,97 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#include <pieces/utils/coroutines.hpp>
+
+#include "thread_pool.hpp"
+#include "task_future.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+namespace detail
+{
+
+/**
+ * @brief A coroutine nobody awaits: it starts at once and its frame is destroyed as soon as it
+ * returns. It must not let exceptions escape.
+ */
+struct DetachedCoroutine
+{
+    struct promise_type
+    {
+        DetachedCoroutine get_return_object() noexcept { return {}; }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+template <typename T>
+DetachedCoroutine runOnPool(ThreadPool& _pool, pieces::Task<T> _task, TaskPromise<T> _promise)
+{
+    co_await _pool.schedule();
+
+    try
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            co_await _task;
+            _promise.setValue();
+        }
+        else
+        {
+            _promise.setValue(co_await _task);
+        }
+    }
+    catch (...)
+    {
+        _promise.setException(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Starts a coroutine on a worker of the pool and returns the future of its result, so that
+ * coroutines can be launched from regular code (and awaited from other coroutines).
+ *
+ * The coroutine runs on a worker until its first suspension, and its await points
+ * (ThreadPool::schedule(), ThreadPool::yield(), TaskFuture) never block a thread, so any number
+ * of them can be in flight on a fixed number of workers. If the pool is shutting down, it runs on
+ * the calling thread instead.
+ *
+ * @return The future of the value returned by the coroutine, or of the exception it threw.
+ *
+ * @example
+ *   pieces::Task<Texture> loadTexture(ThreadPool& _pool, std::string _path)
+ *   {
+ *       std::vector<std::byte> bytes = co_await readFileAsync(_path); // a TaskFuture
+ *       co_await _pool.schedule();                                  // decode on a worker
+ *       co_return decodeTexture(bytes);
+ *   }
+ *
+ *   TaskFuture<Texture> texture = exec::spawn(pool, loadTexture(pool, "rock.png"));
+ */
+template <typename T>
+[[nodiscard]] TaskFuture<T> spawn(ThreadPool& _pool, pieces::Task<T> _task)
+{
+    TaskPromise<T> promise;
+    TaskFuture<T> future = promise.getFuture();
+
+    detail::runOnPool(_pool, std::move(_task), std::move(promise));
+
+    return future;
+}
+
+} // namespace exec
+} // namespace mosaic
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/task_future.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+namespace detail
+{
+class IocpBackend;
+}
+
+/// The bytes of a read, fewer than asked when it reached the end of the file.
+using IoBuffer = std::vector<uint8_t>;
+
+/**
+ * @brief A file opened for positional reads from any thread (O_RDONLY, or FILE_FLAG_OVERLAPPED on
+ * Windows), shared by the reads in flight.
+ */
+class MOSAIC_API IoFile final
+{
+   private:
+    std::filesystem::path m_path;
+    uint64_t m_size = 0;
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    void* m_handle = nullptr;
+    // with the completion port of the first IoService reading it, a handle takes one port
+    mutable std::atomic<bool> m_associated = false;
+
+    friend class detail::IocpBackend;
+#else
+    int m_fd = -1;
+#endif
+
+   public:
+    /**
+     * @brief Opens the file.
+     *
+     * @throws std::system_error if it cannot be opened.
+     */
+    explicit IoFile(const std::filesystem::path& _path);
+    ~IoFile();
+
+    IoFile(const IoFile&) = delete;
+    IoFile& operator=(const IoFile&) = delete;
+
+    // Same as the constructor.
+    [[nodiscard]] static std::shared_ptr<const IoFile> open(const std::filesystem::path& _path)
+    {
+        return std::make_shared<const IoFile>(_path);
+    }
+
+   public:
+    /**
+     * @brief Reads at the offset, blocking the calling thread.
+     *
+     * @return The bytes read (0 at the end of the file), or minus the system error code.
+     */
+    [[nodiscard]] int64_t readAt(void* _data, size_t _size, uint64_t _offset) const noexcept;
+
+    [[nodiscard]] const std::filesystem::path& getPath() const noexcept { return m_path; }
+    // When opened.
+    [[nodiscard]] uint64_t getSize() const noexcept { return m_size; }
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    [[nodiscard]] void* getNativeHandle() const noexcept { return m_handle; }
+#else
+    [[nodiscard]] int getNativeHandle() const noexcept { return m_fd; }
+#endif
+};
+
+struct IoRequest
+{
+    std::shared_ptr<const IoFile> file;
+    uint64_t offset = 0;
+    size_t size = 0;
+};
+
+enum class IoBackendType : uint8_t
+{
+    none,        /// Not initialized, or shut down.
+    thread_pool, /// Blocking reads on ThreadPool workers (inline without a pool).
+    io_uring,    /// Linux 5.6+ and Android where the kernel allows it.
+    iocp,        /// Windows I/O completion ports.
+};
+
+/**
+ * @brief Asynchronous file reads, completed through TaskFutures: io_uring on Linux and Android,
+ * IOCP on Windows, blocking reads on the ThreadPool elsewhere (Emscripten reads its preloaded
+ * files there) or when the kernel refuses io_uring.
+ *
+ * Reads queue by TaskPriority, critical first, and at most the queue depth of them are in flight;
+ * a batch (readBatch()) goes to the kernel in one submission. Futures complete on the thread that
+ * reaps the completion, the I/O thread of the backend: attach the work with then(), which hands it
+ * to the ThreadPool, rather than with onReady(). A future cancelled before its read is submitted
+ * skips it.
+ *
+ * @example
+ *   IoService io;
+ *   io.initialize();
+ *
+ *   auto file = IoFile::open("assets/level.bin");
+ *   auto header = io.readAsync(file, 0, 4096, TaskPriority::critical)
+ *                     .then([](IoBuffer _bytes) { return parse(_bytes); }); // on the pool
+ */
+class MOSAIC_API IoService final
+{
+   public:
+    static constexpr uint32_t k_defaultQueueDepth = 64;
+    // The blocking reads of the fallback, each takes a worker
+    static constexpr uint32_t k_threadPoolQueueDepth = 4;
+
+   private:
+    struct Impl;
+
+    static IoService* g_instance;
+
+    Impl* m_impl;
+
+   public:
+    IoService();
+    // Shuts the service down
+    ~IoService();
+
+    IoService(const IoService&) = delete;
+    IoService& operator=(const IoService&) = delete;
+
+   public:
+    /**
+     * @brief Starts the best backend of the platform, the ThreadPool one if it cannot.
+     *
+     * @param _queueDepth The reads in flight at most (k_threadPoolQueueDepth at most on the
+     * ThreadPool backend).
+     * @param _preferred Forces the backend, tests use thread_pool.
+     */
+    pieces::RefResult<IoService, std::string> initialize(
+        uint32_t _queueDepth = k_defaultQueueDepth,
+        IoBackendType _preferred = IoBackendType::none) noexcept;
+
+    /**
+     * @brief Waits for the reads in flight; the queued ones are dropped, their futures broken.
+     */
+    void shutdown() noexcept;
+
+    /**
+     * @brief Reads _size bytes at _offset, fewer past the end of the file. The future holds the
+     * std::system_error of a failed read, or a std::runtime_error if the service is not running.
+     */
+    [[nodiscard]] TaskFuture<IoBuffer> readAsync(std::shared_ptr<const IoFile> _file,
+                                                 uint64_t _offset, size_t _size,
+                                                 TaskPriority _priority = TaskPriority::normal);
+
+    // Same as above, submitted together: one future per request, in order.
+    [[nodiscard]] std::vector<TaskFuture<IoBuffer>> readBatch(
+        std::span<const IoRequest> _requests, TaskPriority _priority = TaskPriority::normal);
+
+    [[nodiscard]] IoBackendType getBackend() const noexcept;
+
+    // Queued, waiting for a slot.
+    [[nodiscard]] size_t getQueuedCount() const;
+    [[nodiscard]] size_t getInFlightCount() const noexcept;
+
+    [[nodiscard]] static IoService* getInstance() noexcept { return g_instance; }
+};
+
+} // namespace exec
+} // namespace mosaic
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/move_only_task.hpp"
+#include "mosaic/exec/task_future.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+/**
+ * @brief Queue of tasks that must run on the main thread (window, UI or JNI calls), posted from
+ * any thread and run where the main thread drains it.
+ *
+ * The application owns one and drains it every frame, after the window system update and before
+ * rendering (see core::Application::update()). Workers hand their results back with enqueue(),
+ * whose future can be waited on or continued like any task of the pool.
+ *
+ * Posting is lock-free. Draining runs the tasks queued before the call, so tasks posting tasks
+ * do not keep the main thread in the drain, and drainFor() stops once its time budget is spent:
+ * the tasks left run at the next drain, in order. Exceptions thrown by posted tasks are logged.
+ *
+ * @example
+ *   // on a worker
+ *   auto done = app.getMainThreadQueue()->enqueue([&] { window.setTitle(title); });
+ *   done.wait();
+ */
+class MOSAIC_API MainThreadQueue
+{
+   private:
+    static MainThreadQueue* g_instance;
+
+    struct Impl;
+
+    Impl* m_impl;
+
+   public:
+    MainThreadQueue();
+    ~MainThreadQueue();
+
+    MainThreadQueue(const MainThreadQueue&) = delete;
+    MainThreadQueue& operator=(const MainThreadQueue&) = delete;
+    MainThreadQueue(MainThreadQueue&&) = delete;
+    MainThreadQueue& operator=(MainThreadQueue&&) = delete;
+
+   public:
+    /**
+     * @brief Queues a fire-and-forget task, from any thread.
+     */
+    void post(MoveOnlyTask<void()> _task) noexcept;
+
+    /**
+     * @brief Queues a task from any thread and returns its future, completed on the main thread.
+     * The future is broken if the queue is destroyed before draining the task.
+     */
+    template <typename F, typename... Args>
+    TaskFuture<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> enqueue(
+        F&& _f, Args&&... _args)
+    {
+        auto [wrapper, future] = makeTaskPair(std::forward<F>(_f), std::forward<Args>(_args)...);
+
+        post(std::move(wrapper));
+
+        return std::move(future);
+    }
+
+    /**
+     * @brief Runs the tasks queued before the call, on the calling (main) thread.
+     *
+     * @return The number of tasks run.
+     */
+    size_t drain() noexcept;
+
+    /**
+     * @brief Same as drain(), stopping once the budget is spent (checked between tasks, at least
+     * one runs).
+     *
+     * @return The number of tasks run.
+     */
+    size_t drainFor(std::chrono::microseconds _budget) noexcept;
+
+    /**
+     * @brief Approximate number of tasks waiting for a drain.
+     */
+    [[nodiscard]] size_t getPendingCount() const noexcept;
+
+    [[nodiscard]] static inline MainThreadQueue* getInstance() noexcept { return g_instance; }
+
+   private:
+    size_t run(size_t _maxCount, std::chrono::steady_clock::time_point _deadline) noexcept;
+};
+
+} // namespace exec
+} // namespace mosaic
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <new>
 #include <type_traits>
 #include <utility>
 
+#include "mosaic/exec/block_cache.hpp"
+
 namespace mosaic
 {
 namespace exec
@@ -16,9 +19,12 @@ namespace exec
  *
  * A custom implementation of std::move_only_function for platforms where it is unavailable
  * (e.g., Android NDK). Provides identical semantics: move-only ownership, type-erased storage,
- * and small buffer optimization to avoid heap allocation for small callables.
+ * and small buffer optimization to avoid heap allocation for small callables. Larger callables are
+ * allocated from per-thread pools of power of two size classes up to 1 KiB (`detail::BlockCache`),
+ * from the heap beyond.
  *
  * @tparam Signature Function signature (e.g., void(), int(float, double))
+ * @tparam SboSize Size of the inline buffer, at least a pointer (32 bytes on 64-bit by default)
  *
  * @example
  *   MoveOnlyTask<void()> task = []() { doWork(); };
@@ -26,8 +32,10 @@ namespace exec
  *
  *   MoveOnlyTask<int(int, int)> add = [](int a, int b) { return a + b; };
  *   int result = add(2, 3); // result == 5
+ *
+ *   MoveOnlyTask<void(), 64> wide = [a, b, c, d, e]() { use(a, b, c, d, e); }; // inline
  */
-template <typename Signature>
+template <typename Signature, std::size_t SboSize = sizeof(void*) * 4>
 class MoveOnlyTask;
 
 /**
@@ -35,16 +43,18 @@ class MoveOnlyTask;
  *
  * @tparam R Return type
  * @tparam Args Argument types
+ * @tparam SboSize Size of the inline buffer
  */
-template <typename R, typename... Args>
-class MoveOnlyTask<R(Args...)>
+template <typename R, typename... Args, std::size_t SboSize>
+class MoveOnlyTask<R(Args...), SboSize>
 {
    private:
-    /// Small buffer size for SBO. Chosen to fit most lambdas with 1-2 captures.
-    /// Aligned to pointer size for optimal access.
-    static constexpr std::size_t k_sboSize = sizeof(void*) * 4; // 32 bytes on 64-bit
+    /// Small buffer size for SBO. The default fits most lambdas with 1-2 captures.
+    static constexpr std::size_t k_sboSize = SboSize;
     static constexpr std::size_t k_sboAlign = alignof(std::max_align_t);
 
+    static_assert(k_sboSize >= sizeof(void*), "The buffer must hold the pointer of spilled tasks");
+
     /// Type-erased operation vtable
     struct VTable
     {
@@ -75,13 +85,51 @@ class MoveOnlyTask<R(Args...)>
         };
     }
 
+    /// Allocate a callable that does not fit inline, from the pool of its size class if it has one
+    template <typename F, typename Arg>
+    static F* allocateSpilled(Arg&& arg)
+    {
+        if constexpr (detail::k_isPooledCallable<F>)
+        {
+            void* block = detail::CallableCache<F>::allocate();
+
+            try
+            {
+                return ::new (block) F(std::forward<Arg>(arg));
+            }
+            catch (...)
+            {
+                detail::CallableCache<F>::deallocate(block);
+                throw;
+            }
+        }
+        else
+        {
+            return new F(std::forward<Arg>(arg));
+        }
+    }
+
+    template <typename F>
+    static void destroySpilled(F* f) noexcept
+    {
+        if constexpr (detail::k_isPooledCallable<F>)
+        {
+            f->~F();
+            detail::CallableCache<F>::deallocate(f);
+        }
+        else
+        {
+            delete f;
+        }
+    }
+
     /// Generate vtable for a specific callable type stored on heap
     template <typename F>
     static constexpr VTable makeHeapVTable() noexcept
     {
         return VTable{
             // destroy
-            [](void* storage) noexcept { delete *reinterpret_cast<F**>(storage); },
+            [](void* storage) noexcept { destroySpilled(*reinterpret_cast<F**>(storage)); },
             // move (just move the pointer)
             [](void* dst, void* src) noexcept
             {
@@ -121,7 +169,7 @@ class MoveOnlyTask<R(Args...)>
      * @tparam F Callable type (lambda, function pointer, functor)
      * @param f Callable to store
      *
-     * Uses SBO if callable is small enough, otherwise heap-allocates.
+     * Uses SBO if callable is small enough, otherwise allocates it from the pools (or the heap).
      */
     template <typename F,
               typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, MoveOnlyTask> &&
@@ -139,8 +187,9 @@ class MoveOnlyTask<R(Args...)>
         }
         else
         {
-            // Heap allocate
-            *reinterpret_cast<DecayedF**>(m_storage) = new DecayedF(std::forward<F>(f));
+            // Spill to the pools
+            *reinterpret_cast<DecayedF**>(m_storage) =
+                allocateSpilled<DecayedF>(std::forward<F>(f));
             static constexpr VTable vtable = makeHeapVTable<DecayedF>();
             m_vtable = &vtable;
         }
@@ -233,36 +282,36 @@ class MoveOnlyTask<R(Args...)>
 };
 
 /// @brief Swap two MoveOnlyTask objects.
-template <typename R, typename... Args>
-void swap(MoveOnlyTask<R(Args...)>& lhs, MoveOnlyTask<R(Args...)>& rhs) noexcept
+template <typename R, typename... Args, std::size_t SboSize>
+void swap(MoveOnlyTask<R(Args...), SboSize>& lhs, MoveOnlyTask<R(Args...), SboSize>& rhs) noexcept
 {
     lhs.swap(rhs);
 }
 
 /// @brief Compare MoveOnlyTask with nullptr.
-template <typename R, typename... Args>
-bool operator==(const MoveOnlyTask<R(Args...)>& task, std::nullptr_t) noexcept
+template <typename R, typename... Args, std::size_t SboSize>
+bool operator==(const MoveOnlyTask<R(Args...), SboSize>& task, std::nullptr_t) noexcept
 {
     return !task;
 }
 
 /// @brief Compare nullptr with MoveOnlyTask.
-template <typename R, typename... Args>
-bool operator==(std::nullptr_t, const MoveOnlyTask<R(Args...)>& task) noexcept
+template <typename R, typename... Args, std::size_t SboSize>
+bool operator==(std::nullptr_t, const MoveOnlyTask<R(Args...), SboSize>& task) noexcept
 {
     return !task;
 }
 
 /// @brief Compare MoveOnlyTask with nullptr (inequality).
-template <typename R, typename... Args>
-bool operator!=(const MoveOnlyTask<R(Args...)>& task, std::nullptr_t) noexcept
+template <typename R, typename... Args, std::size_t SboSize>
+bool operator!=(const MoveOnlyTask<R(Args...), SboSize>& task, std::nullptr_t) noexcept
 {
     return static_cast<bool>(task);
 }
 
 /// @brief Compare nullptr with MoveOnlyTask (inequality).
-template <typename R, typename... Args>
-bool operator!=(std::nullptr_t, const MoveOnlyTask<R(Args...)>& task) noexcept
+template <typename R, typename... Args, std::size_t SboSize>
+bool operator!=(std::nullptr_t, const MoveOnlyTask<R(Args...), SboSize>& task) noexcept
 {
     return static_cast<bool>(task);
 }
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "thread_pool.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+namespace detail
+{
+
+// The accumulator of parallelFor(), which has nothing to reduce.
+struct NoAccumulator
+{
+};
+
+/**
+ * @brief The state shared by the tasks of one parallelFor()/parallelReduce() call, kept alive by
+ * every task holding a part of the range.
+ *
+ * @tparam Piece Runs a piece of the range, as piece(Accumulator&, begin, end).
+ * @tparam Merge Folds the accumulator of a task into the result, as merge(Accumulator&&), called
+ * under the mutex.
+ */
+template <std::integral Index, typename Accumulator, typename Piece, typename Merge>
+struct ParallelRange
+{
+    ThreadPool* pool;
+    Index grain;
+    Index eagerSize; // larger ranges are split even when no worker is idle
+    Accumulator identity;
+    Piece piece;
+    Merge merge;
+
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<uint64_t> remaining; // elements not run yet
+    std::atomic<bool> failed{false};
+
+    std::mutex mutex;
+    std::exception_ptr error; // guarded by mutex
+
+    ParallelRange(ThreadPool* _pool, Index _grain, Index _eagerSize, Accumulator _identity,
+                  Piece _piece, Merge _merge, uint64_t _count)
+        : pool(_pool),
+          grain(_grain),
+          eagerSize(_eagerSize),
+          identity(std::move(_identity)),
+          piece(std::move(_piece)),
+          merge(std::move(_merge)),
+          remaining(_count)
+    {
+    }
+};
+
+/**
+ * @brief Runs [_begin, _end) by recursive binary splitting: the upper half is pushed to the local
+ * queue of the current worker while the task keeps the lower one, so the first halves stolen by
+ * idle workers are the largest ones.
+ *
+ * Past the eager size, a range only keeps splitting while some worker is idle and otherwise runs
+ * one grain at a time, checking again between grains.
+ */
+template <typename State, std::integral Index>
+void runRange(const std::shared_ptr<State>& _state, Index _begin, Index _end) noexcept
+{
+    State& state = *_state;
+    uint64_t done = 0;
+
+    try
+    {
+        auto accumulator = state.identity;
+
+        while (_begin < _end)
+        {
+            const Index size = _end - _begin;
+
+            if (size > state.grain &&
+                (size > state.eagerSize || state.pool->getIdleWorkersCount() > 0))
+            {
+                const Index middle = _begin + size / 2;
+
+                if (!state.pool->enqueueToCurrentWorker([_state, middle, _end]
+                                                        { runRange(_state, middle, _end); }))
+                {
+                    runRange(_state, middle, _end); // the pool is shutting down
+                }
+
+                _end = middle;
+                continue;
+            }
+
+            const Index pieceEnd = _begin + std::min(size, state.grain);
+
+            if (!state.failed.load(std::memory_order_relaxed))
+            {
+                state.piece(accumulator, _begin, pieceEnd);
+            }
+
+            done += static_cast<uint64_t>(pieceEnd - _begin);
+            _begin = pieceEnd;
+        }
+
+        if constexpr (!std::is_same_v<decltype(accumulator), NoAccumulator>)
+        {
+            std::lock_guard lock(state.mutex);
+            if (!state.failed.load(std::memory_order_relaxed)) state.merge(std::move(accumulator));
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard lock(state.mutex);
+
+        if (!state.error) state.error = std::current_exception();
+        state.failed.store(true, std::memory_order_relaxed);
+
+        done += static_cast<uint64_t>(_end - _begin);
+    }
+
+    // released after the merge, the caller reads the result once every element is accounted for
+    if (state.remaining.fetch_sub(done, std::memory_order_acq_rel) == done)
+    {
+        state.remaining.notify_all();
+    }
+}
+
+template <std::integral Index, typename Accumulator, typename Piece, typename Merge>
+void runParallel(ThreadPool& _pool, Index _begin, Index _end, Index _grain,
+                 Accumulator _identity, Piece _piece, Merge _merge)
+{
+    if (_begin >= _end) return;
+
+    using State = ParallelRange<Index, Accumulator, Piece, Merge>;
+
+    const uint64_t count = static_cast<uint64_t>(_end - _begin);
+    const uint64_t threads = _pool.getWorkersCount() + 1;
+
+    // 0 picks a grain giving about 8 pieces per thread
+    const Index grain =
+        _grain > 0 ? _grain : static_cast<Index>(std::max<uint64_t>(count / (threads * 8), 1));
+    const Index eagerSize = std::max(static_cast<Index>(count / threads), grain);
+
+    auto state = std::make_shared<State>(&_pool, grain, eagerSize, std::move(_identity),
+                                         std::move(_piece), std::move(_merge), count);
+
+    runRange(state, _begin, _end);
+
+    // the calling thread runs pending tasks (its own halves first if it is a worker) until the
+    // whole range is done, and only blocks once there is nothing left to pick up
+    while (true)
+    {
+        const uint64_t remaining = state->remaining.load(std::memory_order_acquire);
+        if (remaining == 0) break;
+
+        if (!_pool.tryExecutePendingTask())
+        {
+            state->remaining.wait(remaining, std::memory_order_acquire);
+        }
+    }
+
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+} // namespace detail
+
+/**
+ * @brief Invokes the function over [_begin, _end) on the pool and returns once every index is
+ * done, the calling thread taking part in the work.
+ *
+ * The range is split in halves down to pieces of `_grain` indices (see detail::runRange()). The
+ * function is invoked as func(begin, end) once per piece if it accepts two indices, as func(i) for
+ * every index otherwise, and must be safe to call concurrently.
+ *
+ * @param _pool The pool the halves are split to.
+ * @param _grain The size of the smallest piece, 0 to derive it from the number of workers.
+ * @throws The first exception thrown by the function, once every task returned. The pieces that
+ * did not start yet are skipped.
+ *
+ * @example
+ *   exec::parallelFor(pool, size_t{0}, particles.size(), size_t{1024},
+ *                     [&](size_t _i) { particles[_i].position += particles[_i].velocity * dt; });
+ */
+template <std::integral Index, typename Func>
+    requires std::is_invocable_v<const Func&, Index, Index> ||
+             std::is_invocable_v<const Func&, Index>
+void parallelFor(ThreadPool& _pool, Index _begin, Index _end, Index _grain, const Func& _func)
+{
+    auto piece = [&_func](detail::NoAccumulator&, Index _pieceBegin, Index _pieceEnd)
+    {
+        if constexpr (std::is_invocable_v<const Func&, Index, Index>)
+        {
+            _func(_pieceBegin, _pieceEnd);
+        }
+        else
+        {
+            for (Index i = _pieceBegin; i < _pieceEnd; ++i) _func(i);
+        }
+    };
+
+    detail::runParallel(_pool, _begin, _end, _grain, detail::NoAccumulator{}, piece,
+                        [](detail::NoAccumulator&&) {});
+}
+
+// Same as above on ThreadPool::getInstance(), serially on the calling thread if there is none.
+template <std::integral Index, typename Func>
+    requires std::is_invocable_v<const Func&, Index, Index> ||
+             std::is_invocable_v<const Func&, Index>
+void parallelFor(Index _begin, Index _end, Index _grain, const Func& _func)
+{
+    if (ThreadPool* pool = ThreadPool::getInstance())
+    {
+        parallelFor(*pool, _begin, _end, _grain, _func);
+    }
+    else if constexpr (std::is_invocable_v<const Func&, Index, Index>)
+    {
+        if (_begin < _end) _func(_begin, _end);
+    }
+    else
+    {
+        for (Index i = _begin; i < _end; ++i) _func(i);
+    }
+}
+
+/**
+ * @brief Reduces [_begin, _end) on the pool: every task folds the pieces it runs into its own
+ * accumulator, then the accumulators are folded into the result.
+ *
+ * @param _identity The identity of the reduction, the result for an empty range.
+ * @param _map Maps a piece to a value, as map(begin, end) if it accepts two indices, map(i) for
+ * every index otherwise.
+ * @param _reduce Combines two values, as reduce(T, T) -> T. It must be associative and
+ * commutative, the order in which pieces are combined is unspecified.
+ * @throws The first exception thrown by map or reduce, once every task returned.
+ *
+ * @example
+ *   const float total = exec::parallelReduce(pool, size_t{0}, masses.size(), size_t{0}, 0.0f,
+ *                                            [&](size_t _i) { return masses[_i]; },
+ *                                            std::plus<>{});
+ */
+template <std::integral Index, typename T, typename Map, typename Reduce>
+    requires(std::is_invocable_r_v<T, const Map&, Index, Index> ||
+             std::is_invocable_r_v<T, const Map&, Index>) &&
+            std::is_invocable_r_v<T, const Reduce&, T, T>
+[[nodiscard]] T parallelReduce(ThreadPool& _pool, Index _begin, Index _end, Index _grain,
+                               T _identity, const Map& _map, const Reduce& _reduce)
+{
+    T result = _identity;
+
+    auto piece = [&_map, &_reduce](T& _accumulator, Index _pieceBegin, Index _pieceEnd)
+    {
+        if constexpr (std::is_invocable_r_v<T, const Map&, Index, Index>)
+        {
+            _accumulator = _reduce(std::move(_accumulator), _map(_pieceBegin, _pieceEnd));
+        }
+        else
+        {
+            for (Index i = _pieceBegin; i < _pieceEnd; ++i)
+            {
+                _accumulator = _reduce(std::move(_accumulator), _map(i));
+            }
+        }
+    };
+
+    auto merge = [&result, &_reduce](T&& _accumulator)
+    { result = _reduce(std::move(result), std::move(_accumulator)); };
+
+    detail::runParallel(_pool, _begin, _end, _grain, std::move(_identity), piece, merge);
+
+    return result;
+}
+
+// Same as above on ThreadPool::getInstance(), serially on the calling thread if there is none.
+template <std::integral Index, typename T, typename Map, typename Reduce>
+    requires(std::is_invocable_r_v<T, const Map&, Index, Index> ||
+             std::is_invocable_r_v<T, const Map&, Index>) &&
+            std::is_invocable_r_v<T, const Reduce&, T, T>
+[[nodiscard]] T parallelReduce(Index _begin, Index _end, Index _grain, T _identity,
+                               const Map& _map, const Reduce& _reduce)
+{
+    if (ThreadPool* pool = ThreadPool::getInstance())
+    {
+        return parallelReduce(*pool, _begin, _end, _grain, std::move(_identity), _map, _reduce);
+    }
+
+    if (_begin >= _end) return _identity;
+
+    if constexpr (std::is_invocable_r_v<T, const Map&, Index, Index>)
+    {
+        return _reduce(std::move(_identity), _map(_begin, _end));
+    }
+    else
+    {
+        for (Index i = _begin; i < _end; ++i) _identity = _reduce(std::move(_identity), _map(i));
+
+        return _identity;
+    }
+}
+
+} // namespace exec
+} // namespace mosaic
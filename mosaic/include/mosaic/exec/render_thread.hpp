@@ -0,0 +1,65 @@
+#pragma once
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/move_only_task.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+/**
+ * @brief A dedicated thread running one frame at a time, handed by the thread that owns it: the
+ * frame N it renders overlaps the simulation of frame N+1 on the caller.
+ *
+ * The hand-off is a fence: kick() waits for the frame handed before, so the caller may write what
+ * the frames read (their snapshot of the simulation) between wait() and kick() only, while no
+ * frame runs. An exception thrown by a frame is rethrown by the next wait() or kick(), on the
+ * caller; the thread goes on.
+ *
+ * @example
+ *   RenderThread renderThread;
+ *
+ *   simulate();                 // frame N+1, while the thread renders frame N
+ *   renderThread.wait();
+ *   extract(snapshot);          // nothing renders
+ *   renderThread.kick([&] { render(snapshot); });
+ */
+class MOSAIC_API RenderThread
+{
+   private:
+    struct Impl;
+
+    Impl* m_impl;
+
+   public:
+    RenderThread();
+    // Waits for the frame in flight, then joins the thread
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+    RenderThread(RenderThread&&) = delete;
+    RenderThread& operator=(RenderThread&&) = delete;
+
+   public:
+    /**
+     * @brief Hands _frame to the thread, once the frame before completed.
+     *
+     * @throws What the frame before threw, _frame is then not run.
+     */
+    void kick(MoveOnlyTask<void()> _frame);
+
+    /**
+     * @brief Blocks until the frame handed last completed, at once if none is in flight.
+     *
+     * @throws What that frame threw, once.
+     */
+    void wait();
+
+    /// Whether a frame was handed and has not completed yet.
+    [[nodiscard]] bool isBusy() const noexcept;
+};
+
+} // namespace exec
+} // namespace mosaic
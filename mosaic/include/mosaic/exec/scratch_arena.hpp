@@ -0,0 +1,198 @@
+#pragma once
+
+#include "mosaic/defines.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+
+#include <pieces/core/templates.hpp>
+#include <pieces/memory/contiguous_allocator.hpp>
+
+namespace mosaic
+{
+namespace exec
+{
+
+/**
+ * @brief A linear arena for the short-lived temporaries of a task (sort buffers, culling
+ * lists...), owned by a single thread so that allocating is a pointer bump without contention.
+ *
+ * Every worker of a ThreadPool owns one and rewinds it after each task to where it was when the
+ * task started: a task run while helping from another one (see tryExecutePendingTask()) only
+ * releases its own allocations. currentScratch() returns the arena of the calling worker, or one
+ * per thread off the pool's workers, which is never rewound automatically (use scope()).
+ *
+ * getResource() adapts the arena to std::pmr containers, a request it cannot satisfy falls back
+ * to the upstream resource.
+ *
+ * @note Nothing allocated by a task may outlive it, hand results over in regular memory.
+ * @note The objects are never destroyed: makeArray<T>() takes trivially destructible types only.
+ */
+class ScratchArena final : public pieces::NonCopyable<ScratchArena>,
+                           pieces::NonMovable<ScratchArena>
+{
+   public:
+    using Byte = uint8_t;
+    using BufferAllocator = pieces::LinearAllocator<Byte>;
+    using Marker = BufferAllocator::Marker;
+
+    // The capacity of the arena of every worker, and of the other threads
+    static constexpr size_t k_workerCapacity = size_t(256) << 10;
+
+    /**
+     * @brief Rewinds the arena to where it was when the scope was opened, as it is closed.
+     */
+    class Scope final : public pieces::NonCopyable<Scope>, pieces::NonMovable<Scope>
+    {
+       private:
+        ScratchArena& m_arena;
+        Marker m_marker;
+
+       public:
+        explicit Scope(ScratchArena& _arena) noexcept
+            : m_arena(_arena), m_marker(_arena.getMarker())
+        {
+        }
+
+        ~Scope() { m_arena.rewind(m_marker); }
+    };
+
+    /**
+     * @brief A std::pmr::memory_resource allocating from an arena, and from upstream once the
+     * arena is full. Deallocating memory of the arena does nothing.
+     */
+    class Resource final : public std::pmr::memory_resource
+    {
+       private:
+        ScratchArena& m_arena;
+        std::pmr::memory_resource* m_upstream;
+
+       public:
+        explicit Resource(ScratchArena& _arena,
+                          std::pmr::memory_resource* _upstream = std::pmr::new_delete_resource())
+            : m_arena(_arena), m_upstream(_upstream)
+        {
+        }
+
+       private:
+        void* do_allocate(size_t _bytes, size_t _alignment) override
+        {
+            if (void* ptr = m_arena.allocate(_bytes, _alignment)) return ptr;
+
+            return m_upstream->allocate(_bytes, _alignment);
+        }
+
+        void do_deallocate(void* _ptr, size_t _bytes, size_t _alignment) override
+        {
+            if (!m_arena.owns(_ptr)) m_upstream->deallocate(_ptr, _bytes, _alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& _other) const noexcept override
+        {
+            return this == &_other;
+        }
+    };
+
+   private:
+    BufferAllocator m_buffer;
+    size_t m_peakUsed = 0; // the most used at once since construction or resetPeak()
+
+    Resource m_resource{*this};
+
+   public:
+    /**
+     * @brief Constructs a ScratchArena of a given capacity.
+     *
+     * @throws std::invalid_argument if _capacityInBytes is zero.
+     */
+    explicit ScratchArena(size_t _capacityInBytes = k_workerCapacity) : m_buffer(_capacityInBytes)
+    {
+    }
+
+   public:
+    /**
+     * @brief Allocates raw memory from the arena.
+     *
+     * @param _bytes The number of bytes to allocate.
+     * @param _alignment The alignment in bytes, a power of two.
+     * @return Pointer to the allocated memory, or nullptr if the arena is full.
+     */
+    [[nodiscard]] void* allocate(size_t _bytes,
+                                 size_t _alignment = alignof(std::max_align_t)) noexcept
+    {
+        void* ptr = m_buffer.allocate(_bytes, _alignment);
+        if (ptr) m_peakUsed = std::max(m_peakUsed, m_buffer.used());
+
+        return ptr;
+    }
+
+    /**
+     * @brief Allocates and value-initializes _count Ts from the arena.
+     *
+     * @return The objects, or an empty span if the arena is full.
+     */
+    template <pieces::TriviallyDestructible T>
+    [[nodiscard]] std::span<T> makeArray(size_t _count) noexcept
+    {
+        if (_count == 0 || _count > SIZE_MAX / sizeof(T)) return {};
+
+        T* ptr = static_cast<T*>(allocate(_count * sizeof(T), alignof(T)));
+        if (!ptr) return {};
+
+        std::uninitialized_value_construct_n(ptr, _count);
+        return {ptr, _count};
+    }
+
+    [[nodiscard]] Marker getMarker() const noexcept { return m_buffer.getMarker(); }
+
+    // Releases what was allocated since the marker was taken.
+    void rewind(const Marker& _marker) noexcept { m_buffer.rewind(_marker); }
+
+    // Releases everything.
+    void reset() noexcept { m_buffer.reset(); }
+
+    /**
+     * @brief Opens a scope, the arena is rewound as it closes.
+     */
+    [[nodiscard]] Scope scope() noexcept { return Scope(*this); }
+
+    [[nodiscard]] std::pmr::memory_resource* getResource() noexcept { return &m_resource; }
+
+    // Expressed in bytes
+    [[nodiscard]] size_t capacity() const noexcept { return m_buffer.capacity(); }
+    [[nodiscard]] size_t used() const noexcept { return m_buffer.used(); }
+    [[nodiscard]] size_t available() const noexcept { return capacity() - used(); }
+    [[nodiscard]] size_t peakUsed() const noexcept { return m_peakUsed; }
+
+    void resetPeak() noexcept { m_peakUsed = m_buffer.used(); }
+
+    /**
+     * @brief Checks whether the pointer is in the arena, allocated still or not.
+     */
+    [[nodiscard]] bool owns(const void* _ptr) const noexcept
+    {
+        const uintptr_t ptrAddr = reinterpret_cast<uintptr_t>(_ptr);
+        const uintptr_t bufferStart = reinterpret_cast<uintptr_t>(m_buffer.getBuffer());
+
+        return bufferStart && ptrAddr >= bufferStart && ptrAddr < bufferStart + capacity();
+    }
+};
+
+/**
+ * @brief Returns the scratch arena of the calling thread: its worker's, rewound after every task
+ * on the workers of a ThreadPool, or a per-thread one elsewhere (the main thread...).
+ *
+ * @example
+ *   pool.enqueueToWorker([&] {
+ *       std::pmr::vector<uint32_t> visible(exec::currentScratch().getResource());
+ *       cull(objects, visible); // released when the task returns
+ *   });
+ */
+MOSAIC_API [[nodiscard]] ScratchArena& currentScratch() noexcept;
+
+} // namespace exec
+} // namespace mosaic
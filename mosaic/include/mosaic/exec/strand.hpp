@@ -0,0 +1,258 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "mosaic/defines.hpp"
+
+#if defined(MOSAIC_COMPILER_MSVC) && (defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86))
+#include <intrin.h>
+#endif
+
+#include "thread_pool.hpp"
+#include "move_only_task.hpp"
+#include "task_future.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+/**
+ * @brief A serial stream of tasks over a ThreadPool: the tasks posted to a strand run one at a
+ * time, in the order they were posted, but on any worker (per-entity network messages, per-file
+ * writes, per-window events).
+ *
+ * Posting is lock-free: the task is linked into an MPSC list of pooled nodes (one exchange) and
+ * a counter of pending tasks is incremented. The post that finds the strand idle schedules one
+ * drain task on the pool, which runs the queued tasks back to back until the counter falls to
+ * zero, so a strand never occupies more than one worker and never blocks one waiting for work.
+ * After k_maxTasksPerRun tasks the drain hands its worker back and schedules itself again, a busy
+ * strand does not starve the other tasks of the pool.
+ *
+ * Tasks posted from one thread run in their posting order; tasks posted from several threads
+ * run in the order their posts were linked, a total order every thread agrees with. Everything
+ * a task wrote is visible to the ones after it. Exceptions thrown by posted tasks are logged,
+ * the tasks after them still run.
+ *
+ * The queue is shared with the drain task: destroying the strand does not cancel what it
+ * queued, which still runs. Once the pool refuses new tasks (shutdown), the drain runs on the
+ * posting thread.
+ *
+ * @example
+ *   exec::Strand connection(pool);
+ *   for (Message& message : received)
+ *       connection.post([&, message = std::move(message)] { session.handle(message); });
+ */
+class Strand final
+{
+   public:
+    // The tasks a drain runs before handing its worker back to the pool
+    static constexpr size_t k_maxTasksPerRun = 64;
+
+   private:
+    struct Node
+    {
+        MoveOnlyTask<void()> task;
+        std::atomic<Node*> next{nullptr};
+    };
+
+    struct State
+    {
+        ThreadPool* pool;
+        TaskPriority priority;
+
+        // Producers exchange the tail, the drain owns the head (a consumed node whose task has
+        // been moved out, the next one holds the oldest task)
+        alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<Node*> tail;
+        alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<size_t> pending{0};
+        alignas(MOSAIC_CACHE_LINE_SIZE) Node* head;
+
+        State(ThreadPool* _pool, TaskPriority _priority)
+            : pool(_pool), priority(_priority), tail(createNode()), head(tail.load())
+        {
+        }
+
+        State(const State&) = delete;
+        State& operator=(const State&) = delete;
+
+        ~State()
+        {
+            while (head)
+            {
+                Node* next = head->next.load(std::memory_order_relaxed);
+                destroyNode(head);
+                head = next;
+            }
+        }
+    };
+
+    // The strand whose drain runs on this thread, if any
+    static inline thread_local const State* t_current = nullptr;
+
+    std::shared_ptr<State> m_state;
+
+   public:
+    /**
+     * @brief Constructs a Strand running its tasks on the given pool.
+     *
+     * @param _priority The priority of the drain task, so of every task of the strand.
+     */
+    explicit Strand(ThreadPool& _pool, TaskPriority _priority = TaskPriority::normal)
+        : m_state(std::make_shared<State>(&_pool, _priority))
+    {
+    }
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+    Strand(Strand&&) = delete;
+    Strand& operator=(Strand&&) = delete;
+
+   public:
+    /**
+     * @brief Queues a fire-and-forget task behind the ones already posted, from any thread.
+     */
+    void post(MoveOnlyTask<void()> _task)
+    {
+        State& state = *m_state;
+
+        Node* node = createNode();
+        node->task = std::move(_task);
+
+        Node* prev = state.tail.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+
+        if (state.pending.fetch_add(1, std::memory_order_acq_rel) == 0) schedule(m_state);
+    }
+
+    /**
+     * @brief Queues a task behind the ones already posted, from any thread, and returns its
+     * future.
+     */
+    template <typename F, typename... Args>
+    TaskFuture<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> enqueue(
+        F&& _f, Args&&... _args)
+    {
+        auto [wrapper, future] = makeTaskPair(std::forward<F>(_f), std::forward<Args>(_args)...);
+
+        post(std::move(wrapper));
+
+        return std::move(future);
+    }
+
+    /**
+     * @brief Approximate number of tasks posted and not finished yet, the running one included.
+     */
+    [[nodiscard]] size_t getPendingCount() const noexcept
+    {
+        return m_state->pending.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Checks whether the calling thread is running a task of this strand.
+     */
+    [[nodiscard]] bool runningInThisThread() const noexcept { return t_current == m_state.get(); }
+
+   private:
+    [[nodiscard]] static Node* createNode()
+    {
+        detail::PoolAllocator<Node> allocator;
+        return std::construct_at(allocator.allocate(1));
+    }
+
+    static void destroyNode(Node* _node) noexcept
+    {
+        detail::PoolAllocator<Node> allocator;
+        std::destroy_at(_node);
+        allocator.deallocate(_node, 1);
+    }
+
+    // Hints the core that the thread is spinning (lets the sibling hyperthread run, saves power).
+    static void cpuRelax() noexcept
+    {
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86)
+#if defined(MOSAIC_COMPILER_MSVC)
+        _mm_pause();
+#else
+        __builtin_ia32_pause();
+#endif
+#elif defined(MOSAIC_ARCH_ARM64) || defined(MOSAIC_ARCH_ARM32)
+#if defined(MOSAIC_COMPILER_MSVC)
+        __yield();
+#else
+        __asm__ __volatile__("yield");
+#endif
+#endif
+    }
+
+    static void schedule(const std::shared_ptr<State>& _state)
+    {
+        if (!_state->pool->enqueueToCurrentWorker([_state] { drain(_state); }, _state->priority))
+        {
+            // shutting down: run the stream here rather than drop it
+            drain(_state);
+        }
+    }
+
+    static void drain(const std::shared_ptr<State>& _state)
+    {
+        State& state = *_state;
+
+        const State* outer = t_current;
+        t_current = &state;
+
+        for (size_t ran = 1;; ++ran)
+        {
+            runNext(state);
+
+            if (state.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) break;
+
+            if (ran == k_maxTasksPerRun)
+            {
+                t_current = outer;
+                schedule(_state);
+                return;
+            }
+        }
+
+        t_current = outer;
+    }
+
+    // Runs the oldest task, the counter said there is one.
+    static void runNext(State& _state) noexcept
+    {
+        // Counted but maybe not linked yet: a producer that exchanged the tail before the one
+        // whose post was counted may not have stored its link, the window is a few instructions
+        Node* next = _state.head->next.load(std::memory_order_acquire);
+        while (!next)
+        {
+            cpuRelax();
+            next = _state.head->next.load(std::memory_order_acquire);
+        }
+
+        destroyNode(_state.head);
+        _state.head = next;
+
+        MoveOnlyTask<void()> task = std::move(next->task);
+
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            MOSAIC_ERROR("Strand: task threw std::exception: {}", e.what());
+        }
+        catch (...)
+        {
+            MOSAIC_ERROR("Strand: task threw unknown exception.");
+        }
+    }
+};
+
+} // namespace exec
+} // namespace mosaic
@@ -2,16 +2,25 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <stdexcept>
 #include <type_traits>
 #include <variant>
 #include <tuple>
 #include <chrono>
+#include <thread>
+#include <vector>
+#include <limits>
 
 #include "mosaic/defines.hpp"
+#include "mosaic/exec/block_cache.hpp"
+#include "mosaic/exec/cancellation.hpp"
 #include "mosaic/exec/move_only_task.hpp"
 
 namespace mosaic
@@ -79,11 +88,60 @@ class FutureException : public std::logic_error
     }
 };
 
+namespace detail
+{
+
+/**
+ * @brief Allocator recycling single objects through the BlockCache of their size, used for shared
+ * states (and their control blocks, through std::allocate_shared()).
+ */
+template <typename T>
+struct PoolAllocator
+{
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept
+    {
+    }
+
+    [[nodiscard]] T* allocate(size_t _count)
+    {
+        if (_count != 1)
+        {
+            return static_cast<T*>(
+                ::operator new(_count * sizeof(T), std::align_val_t{alignof(T)}));
+        }
+
+        return static_cast<T*>(BlockCache<sizeof(T), alignof(T)>::allocate());
+    }
+
+    void deallocate(T* _pointer, size_t _count) noexcept
+    {
+        if (_count != 1) return ::operator delete(_pointer, std::align_val_t{alignof(T)});
+
+        BlockCache<sizeof(T), alignof(T)>::deallocate(_pointer);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+};
+
+} // namespace detail
+
 /**
  * @brief Shared state between Promise and Future
  *
- * Uses a single allocation for the entire state, including the result storage.
- * Optimized for cache locality and minimal synchronization overhead.
+ * Uses a single allocation for the entire state, including the result storage. Synchronization is
+ * a single atomic status word: completing a state is one exchange, which only wakes waiters
+ * (std::atomic::wait(), a futex where available) when one of them flagged itself in the word. The
+ * mutex and condition variable needed by timed waits are only allocated by the first timed wait
+ * that has to sleep.
  */
 template <typename T>
 class SharedState
@@ -95,22 +153,36 @@ class SharedState
    private:
     static constexpr int k_spinCount = 100;
 
-    alignas(MOSAIC_CACHE_LINE_SIZE) mutable std::mutex m_mutex;
-    alignas(MOSAIC_CACHE_LINE_SIZE) std::condition_variable m_cv;
-    std::atomic<FutureStatus> m_status;
-    std::variant<std::monostate, StorageType, std::exception_ptr> m_storage;
+    // The status word holds a FutureStatus in its low byte, plus the flags below
+    static constexpr uint32_t k_statusMask = 0xFF;
+    static constexpr uint32_t k_writing = 0xFF; // the result is being stored, reads as executing
+    static constexpr uint32_t k_waitersBit = 1u << 8;      // a waiter sleeps on the word
+    static constexpr uint32_t k_continuationBit = 1u << 9; // m_continuation is set
+
+    // Created by the first timed wait that has to sleep
+    struct TimedWait
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    std::atomic<uint32_t> m_word;
     std::atomic<bool> m_future_retrieved;
     std::atomic<bool> m_cancellationRequested;
     std::atomic<bool> m_cancelled;
+    std::atomic<TimedWait*> m_timedWait;
+    std::variant<std::monostate, StorageType, std::exception_ptr> m_storage;
+    MoveOnlyTask<void()> m_continuation; // published by k_continuationBit
 
    public:
     SharedState()
-        : m_status(FutureStatus::pending),
+        : m_word(code(FutureStatus::pending)),
           m_future_retrieved(false),
           m_cancellationRequested(false),
-          m_cancelled(false) {};
+          m_cancelled(false),
+          m_timedWait(nullptr) {};
 
-    ~SharedState() = default;
+    ~SharedState() { delete m_timedWait.load(std::memory_order_relaxed); }
 
     SharedState(const SharedState&) = delete;
     SharedState& operator=(const SharedState&) = delete;
@@ -126,54 +198,75 @@ class SharedState
     template <typename U = T>
     std::enable_if_t<!std::is_void_v<U>, void> setValue(U&& _value)
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
+        const uint32_t previous = claim();
 
-        auto current = m_status.load(std::memory_order_relaxed);
-        if (current != FutureStatus::pending && current != FutureStatus::executing)
+        try
         {
-            throw FutureException(FutureErrorCode::promise_already_satisfied);
+            m_storage.template emplace<1>(std::forward<U>(_value));
+        }
+        catch (...)
+        {
+            unclaim(previous);
+            throw;
         }
 
-        m_storage.template emplace<1>(std::forward<U>(_value));
-        m_status.store(FutureStatus::ready, std::memory_order_release);
-
-        lock.unlock();
-        m_cv.notify_all();
+        complete(FutureStatus::ready);
     }
 
     template <typename U = T>
     std::enable_if_t<std::is_void_v<U>, void> setValue()
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
-
-        auto current = m_status.load(std::memory_order_relaxed);
-        if (current != FutureStatus::pending && current != FutureStatus::executing)
-        {
-            throw FutureException(FutureErrorCode::promise_already_satisfied);
-        }
+        claim();
 
         m_storage.template emplace<1>(std::monostate{});
-        m_status.store(FutureStatus::ready, std::memory_order_release);
 
-        lock.unlock();
-        m_cv.notify_all();
+        complete(FutureStatus::ready);
     }
 
     void setException(std::exception_ptr _ex)
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
+        claim();
+
+        m_storage.template emplace<2>(std::move(_ex));
+
+        complete(FutureStatus::error);
+    }
+
+    /**
+     * @brief Sets the callback invoked by the thread completing the state (value, exception or
+     * cancellation), right after waiters are woken up. Invoked at once on the calling thread if
+     * the state is already complete.
+     *
+     * @throws FutureException future_already_retrieved if a continuation is already set.
+     */
+    void setContinuation(MoveOnlyTask<void()> _continuation)
+    {
+        uint32_t word = m_word.load(std::memory_order_acquire);
 
-        auto current = m_status.load(std::memory_order_relaxed);
-        if (current != FutureStatus::pending && current != FutureStatus::executing)
+        if (word & k_continuationBit)
         {
-            throw FutureException(FutureErrorCode::promise_already_satisfied);
+            throw FutureException(FutureErrorCode::future_already_retrieved);
         }
 
-        m_storage.template emplace<2>(std::move(_ex));
-        m_status.store(FutureStatus::error, std::memory_order_release);
+        if (isComplete(word))
+        {
+            _continuation();
+            return;
+        }
+
+        // only read by the completing thread once the bit is published
+        m_continuation = std::move(_continuation);
 
-        lock.unlock();
-        m_cv.notify_all();
+        while (!m_word.compare_exchange_weak(word, word | k_continuationBit,
+                                             std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            if (isComplete(word))
+            {
+                MoveOnlyTask<void()> continuation = std::move(m_continuation);
+                continuation();
+                return;
+            }
+        }
     }
 
     bool isCancellationRequested() const noexcept
@@ -183,56 +276,37 @@ class SharedState
 
     bool isCancelled() const noexcept { return m_cancelled.load(std::memory_order_acquire); }
 
-    bool isExecuting() const noexcept
-    {
-        return m_status.load(std::memory_order_acquire) == FutureStatus::executing;
-    }
+    bool isExecuting() const noexcept { return getStatus() == FutureStatus::executing; }
 
     bool isReady() const noexcept
     {
-        auto status = m_status.load(std::memory_order_acquire);
+        auto status = getStatus();
         return status == FutureStatus::ready || status == FutureStatus::error;
     }
 
     bool tryMarkExecuting() noexcept
     {
-        FutureStatus expected = FutureStatus::pending;
-        return m_status.compare_exchange_strong(expected, FutureStatus::executing,
-                                                std::memory_order_acq_rel);
+        return transition(FutureStatus::pending, code(FutureStatus::executing));
     }
 
     void markReady() noexcept
     {
-        FutureStatus expected = FutureStatus::executing;
-        if (m_status.load(std::memory_order_acquire) == expected &&
-            !m_cancellationRequested.load(std::memory_order_acquire))
-        {
-            m_status.compare_exchange_strong(expected, FutureStatus::ready,
-                                             std::memory_order_acq_rel);
-        }
+        if (m_cancellationRequested.load(std::memory_order_acquire)) return;
+
+        if (transition(FutureStatus::executing, k_writing)) complete(FutureStatus::ready);
     }
 
     bool cancel() noexcept
     {
-        FutureStatus current = m_status.load(std::memory_order_acquire);
-
-        if (current == FutureStatus::pending)
+        if (transition(FutureStatus::pending, k_writing))
         {
-            if (m_status.compare_exchange_strong(current, FutureStatus::cancelled,
-                                                 std::memory_order_acq_rel))
-            {
-                std::unique_lock<std::mutex> lock(m_mutex);
+            m_cancelled.store(true, std::memory_order_release);
+            complete(FutureStatus::cancelled);
 
-                m_cancelled.store(true, std::memory_order_release);
-
-                lock.unlock();
-                m_cv.notify_all();
-
-                return true;
-            }
+            return true;
         }
 
-        if (current == FutureStatus::executing)
+        if (getStatus() == FutureStatus::executing)
         {
             m_cancellationRequested.store(true, std::memory_order_release);
             return true;
@@ -244,156 +318,266 @@ class SharedState
     template <typename U = T>
     std::enable_if_t<!std::is_void_v<U>, U> get()
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_cv.wait(lock,
-                  [this]
-                  {
-                      auto status = m_status.load(std::memory_order_acquire);
-                      return status != FutureStatus::pending && status != FutureStatus::executing;
-                  });
+        consume();
 
-        auto status = m_status.load(std::memory_order_acquire);
+        return std::move(std::get<StorageType>(m_storage));
+    }
 
-        if (status == FutureStatus::cancelled)
+    template <typename U = T>
+    std::enable_if_t<std::is_void_v<U>, void> get()
+    {
+        consume();
+    }
+
+    void wait()
+    {
+        if (spinUntilComplete()) return;
+
+        uint32_t word = m_word.load(std::memory_order_acquire);
+
+        while (!isComplete(word))
         {
-            throw FutureException(FutureErrorCode::broken_promise);
+            // flag the wait so that the completing thread knows it has someone to wake up
+            if (!(word & k_waitersBit))
+            {
+                if (!m_word.compare_exchange_weak(word, word | k_waitersBit,
+                                                  std::memory_order_acq_rel,
+                                                  std::memory_order_acquire))
+                {
+                    continue;
+                }
+
+                word |= k_waitersBit;
+            }
+
+            m_word.wait(word, std::memory_order_acquire);
+            word = m_word.load(std::memory_order_acquire);
         }
+    }
 
-        if (status == FutureStatus::consumed)
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return waitUntil(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename Clock, typename Duration>
+    bool waitUntil(const std::chrono::time_point<Clock, Duration>& _deadline)
+    {
+        if (isComplete(m_word.load(std::memory_order_acquire))) return true;
+
+        for (int i = 0; i < k_spinCount; ++i)
         {
-            throw FutureException(FutureErrorCode::future_already_consumed);
+            if (isComplete(m_word.load(std::memory_order_acquire))) return true;
+
+            if (Clock::now() >= _deadline) return false;
+
+            std::this_thread::yield();
         }
 
-        if (status == FutureStatus::error)
+        if (Clock::now() >= _deadline) return false;
+
+        // seq_cst like complete(): either it sees the wait object, or this sees the completion
+        TimedWait& timedWait = acquireTimedWait();
+
+        auto completed = [this] { return isComplete(m_word.load(std::memory_order_seq_cst)); };
+
+        std::unique_lock<std::mutex> lock(timedWait.mutex);
+        return timedWait.cv.wait_until(lock, _deadline, completed);
+    }
+
+    FutureStatus getStatus() const noexcept
+    {
+        const uint32_t status = m_word.load(std::memory_order_acquire) & k_statusMask;
+
+        return status == k_writing ? FutureStatus::executing : static_cast<FutureStatus>(status);
+    }
+
+   private:
+    static constexpr uint32_t code(FutureStatus _status) noexcept
+    {
+        return static_cast<uint32_t>(_status);
+    }
+
+    static constexpr bool isComplete(uint32_t _word) noexcept
+    {
+        const uint32_t status = _word & k_statusMask;
+
+        return status != code(FutureStatus::pending) && status != code(FutureStatus::executing) &&
+               status != k_writing;
+    }
+
+    // Replaces the status if it is the expected one, keeping the flags.
+    bool transition(FutureStatus _expected, uint32_t _status) noexcept
+    {
+        uint32_t word = m_word.load(std::memory_order_relaxed);
+
+        do
         {
-            std::rethrow_exception(std::get<std::exception_ptr>(m_storage));
-        }
+            if ((word & k_statusMask) != code(_expected)) return false;
+        } while (!m_word.compare_exchange_weak(word, (word & ~k_statusMask) | _status,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_relaxed));
 
-        auto result = std::move(std::get<StorageType>(m_storage));
-        m_status.store(FutureStatus::consumed, std::memory_order_release);
-        return result;
+        return true;
     }
 
-    template <typename U = T>
-    std::enable_if_t<std::is_void_v<U>, void> get()
+    // Takes the exclusive right to store the result, returns the status it replaced.
+    uint32_t claim()
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_cv.wait(lock,
-                  [this]
-                  {
-                      auto status = m_status.load(std::memory_order_acquire);
-                      return status != FutureStatus::pending && status != FutureStatus::executing;
-                  });
+        uint32_t word = m_word.load(std::memory_order_relaxed);
+        uint32_t status;
+
+        do
+        {
+            status = word & k_statusMask;
 
-        auto status = m_status.load(std::memory_order_acquire);
+            if (status != code(FutureStatus::pending) && status != code(FutureStatus::executing))
+            {
+                throw FutureException(FutureErrorCode::promise_already_satisfied);
+            }
+        } while (!m_word.compare_exchange_weak(word, (word & ~k_statusMask) | k_writing,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed));
 
-        if (status == FutureStatus::cancelled)
+        return status;
+    }
+
+    // Gives the right back after storing the result threw.
+    void unclaim(uint32_t _status) noexcept
+    {
+        uint32_t word = m_word.load(std::memory_order_relaxed);
+
+        while (!m_word.compare_exchange_weak(word, (word & ~k_statusMask) | _status,
+                                             std::memory_order_release, std::memory_order_relaxed))
         {
-            throw FutureException(FutureErrorCode::broken_promise);
         }
+    }
+
+    // Publishes the final status of a claimed state, then wakes the waiters and runs the
+    // continuation.
+    void complete(FutureStatus _status) noexcept
+    {
+        const uint32_t previous = m_word.exchange(code(_status), std::memory_order_seq_cst);
+
+        if (previous & k_waitersBit) m_word.notify_all();
 
-        if (status == FutureStatus::consumed)
+        if (TimedWait* timedWait = m_timedWait.load(std::memory_order_seq_cst))
         {
-            throw FutureException(FutureErrorCode::future_already_consumed);
+            // under the mutex, a timed waiter is either before its check or asleep
+            std::lock_guard<std::mutex> lock(timedWait->mutex);
+            timedWait->cv.notify_all();
         }
 
-        if (status == FutureStatus::error)
+        if (previous & k_continuationBit)
         {
-            std::rethrow_exception(std::get<std::exception_ptr>(m_storage));
+            MoveOnlyTask<void()> continuation = std::move(m_continuation);
+            continuation();
         }
-
-        m_status.store(FutureStatus::consumed, std::memory_order_release);
     }
 
-    void wait()
+    // Waits for the result, then claims it for this call or throws the stored error.
+    void consume()
     {
-        auto status = m_status.load(std::memory_order_acquire);
-        if (status != FutureStatus::pending && status != FutureStatus::executing) return;
+        wait();
 
-        for (int i = 0; i < k_spinCount; ++i)
+        uint32_t word = m_word.load(std::memory_order_acquire);
+
+        switch (static_cast<FutureStatus>(word & k_statusMask))
         {
-            status = m_status.load(std::memory_order_acquire);
-            if (status != FutureStatus::pending && status != FutureStatus::executing) return;
+            case FutureStatus::cancelled:
+                throw FutureException(FutureErrorCode::broken_promise);
+            case FutureStatus::error:
+                std::rethrow_exception(std::get<std::exception_ptr>(m_storage));
+            default:
+                break;
+        }
 
-            std::this_thread::yield();
+        if (!m_word.compare_exchange_strong(word, code(FutureStatus::consumed),
+                                            std::memory_order_acq_rel))
+        {
+            throw FutureException(FutureErrorCode::future_already_consumed);
         }
 
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_cv.wait(lock,
-                  [this]
-                  {
-                      auto status = m_status.load(std::memory_order_acquire);
-                      return status != FutureStatus::pending && status != FutureStatus::executing;
-                  });
+        if ((word & k_statusMask) != code(FutureStatus::ready))
+        {
+            throw FutureException(FutureErrorCode::future_already_consumed);
+        }
     }
 
-    template <typename Rep, typename Period>
-    bool waitFor(const std::chrono::duration<Rep, Period>& timeout)
+    bool spinUntilComplete() const noexcept
     {
-        auto start = std::chrono::steady_clock::now();
-
-        auto status = m_status.load(std::memory_order_acquire);
-        if (status != FutureStatus::pending && status != FutureStatus::executing) return true;
+        if (isComplete(m_word.load(std::memory_order_acquire))) return true;
 
         for (int i = 0; i < k_spinCount; ++i)
         {
-            status = m_status.load(std::memory_order_acquire);
-            if (status != FutureStatus::pending && status != FutureStatus::executing) return true;
-
-            auto elapsed = std::chrono::steady_clock::now() - start;
-            if (elapsed >= timeout) return false;
+            if (isComplete(m_word.load(std::memory_order_acquire))) return true;
 
             std::this_thread::yield();
         }
 
-        auto elapsed = std::chrono::steady_clock::now() - start;
-        auto remaining = timeout - elapsed;
-        if (remaining <= std::chrono::duration<Rep, Period>::zero()) return false;
-
-        std::unique_lock<std::mutex> lock(m_mutex);
-        return m_cv.wait_for(lock, remaining,
-                             [this]
-                             {
-                                 auto status = m_status.load(std::memory_order_acquire);
-                                 return status != FutureStatus::pending &&
-                                        status != FutureStatus::executing;
-                             });
+        return false;
     }
 
-    template <typename Clock, typename Duration>
-    bool waitUntil(const std::chrono::time_point<Clock, Duration>& _deadline)
+    TimedWait& acquireTimedWait()
     {
-        auto status = m_status.load(std::memory_order_acquire);
-        if (status != FutureStatus::pending && status != FutureStatus::executing) return true;
+        TimedWait* timedWait = m_timedWait.load(std::memory_order_seq_cst);
+        if (timedWait) return *timedWait;
 
-        for (int i = 0; i < k_spinCount; ++i)
+        auto created = std::make_unique<TimedWait>();
+        if (m_timedWait.compare_exchange_strong(timedWait, created.get(),
+                                                std::memory_order_seq_cst))
         {
-            status = m_status.load(std::memory_order_acquire);
-            if (status != FutureStatus::pending && status != FutureStatus::executing) return true;
-
-            if (Clock::now() >= _deadline) return false;
-
-            std::this_thread::yield();
+            return *created.release();
         }
 
-        if (Clock::now() >= _deadline) return false;
-
-        std::unique_lock<std::mutex> lock(m_mutex);
-        return m_cv.wait_until(lock, _deadline,
-                               [this]
-                               {
-                                   auto status = m_status.load(std::memory_order_acquire);
-                                   return status != FutureStatus::pending &&
-                                          status != FutureStatus::executing;
-                               });
+        return *timedWait;
     }
-
-    FutureStatus getStatus() const noexcept { return m_status.load(std::memory_order_acquire); }
 };
 
 template <typename T>
 class ExecutionToken;
 
+template <typename T>
+class TaskFuture;
+
+template <typename T>
+class TaskPromise;
+
+class ThreadPool;
+
+namespace detail
+{
+
+// A continuation takes the value of the ready future (nothing for void), or the future itself.
+template <typename T, typename F>
+consteval auto continuationResult()
+{
+    if constexpr (std::is_void_v<T> && std::is_invocable_v<F&>)
+    {
+        return std::type_identity<std::invoke_result_t<F&>>{};
+    }
+    else if constexpr (!std::is_void_v<T> && std::is_invocable_v<F&, T>)
+    {
+        return std::type_identity<std::invoke_result_t<F&, T>>{};
+    }
+    else
+    {
+        return std::type_identity<std::invoke_result_t<F&, TaskFuture<T>>>{};
+    }
+}
+
+template <typename T, typename F>
+using ContinuationResult = typename decltype(continuationResult<T, F>())::type;
+
+// The index of whenAny() before a future completed.
+inline constexpr size_t k_noFutureIndex = std::numeric_limits<size_t>::max();
+
+template <typename R, typename T, typename F>
+void runContinuation(TaskPromise<R>& _promise, TaskFuture<T> _antecedent, F& _f) noexcept;
+
+} // namespace detail
+
 /**
  * @brief Custom Future implementation
  *
@@ -508,6 +692,119 @@ class TaskFuture
     {
         return isValid() ? m_state->getStatus() : FutureStatus::pending;
     }
+
+    /**
+     * @brief Register a callback invoked by the thread completing the result, or at once if it is
+     * already complete, so that nothing blocks waiting for it
+     *
+     * @note The callback runs inside setValue()/setException()/cancel() and must not throw: keep
+     * it short and hand real work to a pool (see then()). A future takes a single callback.
+     */
+    void onReady(MoveOnlyTask<void()> _callback)
+    {
+        if (!isValid()) throw FutureException(FutureErrorCode::no_state);
+
+        m_state->setContinuation(std::move(_callback));
+    }
+
+    /**
+     * @brief Schedule a function on the pool once the result is complete, consuming this future
+     *
+     * The function takes the value (nothing for void), in which case the exception or cancellation
+     * of this future is forwarded to the returned future without calling it, or takes the ready
+     * TaskFuture<T> to handle errors itself. The thread completing the result enqueues it with
+     * enqueueToCurrentWorker(), so it usually runs on the worker that produced its input.
+     *
+     * @return The future of the result of the function
+     */
+    template <typename Pool, typename F>
+    auto then(Pool& _pool, F&& _f) -> TaskFuture<detail::ContinuationResult<T, std::decay_t<F>>>
+    {
+        return thenOn(&_pool, std::forward<F>(_f));
+    }
+
+    /**
+     * @brief Same as then(pool, f) on ThreadPool::getInstance(), the function runs on the
+     * completing thread if there is no pool
+     */
+    template <typename F, typename Pool = ThreadPool>
+    auto then(F&& _f) -> TaskFuture<detail::ContinuationResult<T, std::decay_t<F>>>
+    {
+        return thenOn(Pool::getInstance(), std::forward<F>(_f));
+    }
+
+    /**
+     * @brief Make the future awaitable: `co_await future` suspends the coroutine until the result
+     * is complete, without blocking the thread, then returns it like get() does
+     *
+     * The coroutine resumes on the thread completing the result (see onReady()), usually the
+     * worker that produced it, or does not suspend if the result is already complete. Awaiting
+     * uses the single callback of the future.
+     */
+    auto operator co_await() noexcept
+    {
+        struct Awaiter
+        {
+            TaskFuture& m_future;
+
+            bool await_ready() const noexcept
+            {
+                const FutureStatus status = m_future.getStatus();
+
+                return !m_future.isValid() ||
+                       (status != FutureStatus::pending && status != FutureStatus::executing);
+            }
+
+            void await_suspend(std::coroutine_handle<> _handle)
+            {
+                // resumes inline if the result completed in the meantime, the awaiter lives in
+                // the frame and must not be touched past this call
+                m_future.onReady([_handle] { _handle.resume(); });
+            }
+
+            T await_resume() { return m_future.get(); }
+        };
+
+        return Awaiter{*this};
+    }
+
+   private:
+    template <typename Pool, typename F>
+    auto thenOn(Pool* _pool, F&& _f) -> TaskFuture<detail::ContinuationResult<T, std::decay_t<F>>>
+    {
+        using R = detail::ContinuationResult<T, std::decay_t<F>>;
+
+        if (!isValid()) throw FutureException(FutureErrorCode::no_state);
+
+        auto promise = std::make_shared<TaskPromise<R>>();
+        TaskFuture<R> future = promise->getFuture();
+
+        // the callback keeps the state alive until the state completes and invokes it
+        m_state->setContinuation(
+            [_pool, state = m_state, promise = std::move(promise),
+             f = std::forward<F>(_f)]() mutable
+            {
+                MoveOnlyTask<void()> work = [state = std::move(state),
+                                             promise = std::move(promise),
+                                             f = std::move(f)]() mutable
+                { detail::runContinuation(*promise, TaskFuture<T>(std::move(state)), f); };
+
+                // if the pool refuses it while shutting down, the promise is broken when the task
+                // is destroyed (see ~TaskPromise())
+                if (_pool && _pool->isRunning())
+                {
+                    _pool->enqueueToCurrentWorker(std::move(work));
+                }
+                else
+                {
+                    work();
+                }
+            });
+
+        m_state.reset();
+
+        return future;
+    }
 };
 
 /**
@@ -522,7 +819,10 @@ class TaskPromise
     friend class ExecutionToken<T>;
 
    public:
-    TaskPromise() : m_state(std::make_shared<SharedState<T>>()) {}
+    TaskPromise()
+        : m_state(std::allocate_shared<SharedState<T>>(detail::PoolAllocator<SharedState<T>>{}))
+    {
+    }
 
     TaskPromise(const TaskPromise&) = delete;
     TaskPromise& operator=(const TaskPromise&) = delete;
@@ -607,6 +907,49 @@ class TaskPromise
     std::shared_ptr<SharedState<T>> getState() const noexcept { return m_state; }
 };
 
+namespace detail
+{
+
+template <typename R, typename T, typename F>
+void runContinuation(TaskPromise<R>& _promise, TaskFuture<T> _antecedent, F& _f) noexcept
+{
+    auto invoke = [&]() -> R
+    {
+        if constexpr (std::is_void_v<T> && std::is_invocable_v<F&>)
+        {
+            _antecedent.get();
+            return _f();
+        }
+        else if constexpr (!std::is_void_v<T> && std::is_invocable_v<F&, T>)
+        {
+            return _f(_antecedent.get());
+        }
+        else
+        {
+            return _f(std::move(_antecedent));
+        }
+    };
+
+    try
+    {
+        if constexpr (std::is_void_v<R>)
+        {
+            invoke();
+            _promise.setValue();
+        }
+        else
+        {
+            _promise.setValue(invoke());
+        }
+    }
+    catch (...)
+    {
+        _promise.setException(std::current_exception());
+    }
+}
+
+} // namespace detail
+
 /**
  * @brief Token representing execution of a task
  *
@@ -671,6 +1014,40 @@ class ExecutionToken
     std::shared_ptr<SharedState<T>> getState() const noexcept { return m_state; }
 };
 
+namespace detail
+{
+
+// The body of the tasks of makeTaskPair(), run once by the worker taking the task.
+template <typename Ret, typename F, typename Tuple>
+void runTaskPair(TaskPromise<Ret>& _promise, F& _f, Tuple& _argsTuple)
+{
+    ExecutionToken<Ret> token(_promise);
+
+    if (!token) return;
+
+    try
+    {
+        if constexpr (std::is_void_v<Ret>)
+        {
+            std::apply(std::move(_f), std::move(_argsTuple));
+
+            if (!token.isCancellationRequested()) _promise.setValue();
+        }
+        else
+        {
+            auto result = std::apply(std::move(_f), std::move(_argsTuple));
+
+            if (!token.isCancellationRequested()) _promise.setValue(std::move(result));
+        }
+    }
+    catch (...)
+    {
+        _promise.setException(std::current_exception());
+    }
+}
+
+} // namespace detail
+
 /**
  * @brief Helper to create a task with promise/future pair
  *
@@ -685,40 +1062,161 @@ inline auto makeTaskPair(F&& _f, Args&&... _args)
 {
     using Ret = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
 
-    auto promise = std::make_shared<TaskPromise<Ret>>();
-    TaskFuture<Ret> future = promise->getFuture();
+    // the promise is moved into the task, a single allocation (pooled) per pair
+    TaskPromise<Ret> promise;
+    TaskFuture<Ret> future = promise.getFuture();
 
     auto argsTuple = std::make_tuple(std::forward<Args>(_args)...);
 
-    MoveOnlyTask<void()> wrapper =
-        [promise, f = std::forward<F>(_f), argsTuple = std::move(argsTuple)]() mutable
-    {
-        ExecutionToken<Ret> token(*promise);
+    MoveOnlyTask<void()> wrapper = [promise = std::move(promise), f = std::forward<F>(_f),
+                                    argsTuple = std::move(argsTuple)]() mutable
+    { detail::runTaskPair(promise, f, argsTuple); };
 
-        if (!token) return;
+    return std::make_pair(std::move(wrapper), std::move(future));
+}
 
-        try
+/**
+ * @brief Same as makeTaskPair(), the task is skipped and its future cancelled if the token is
+ * cancelled by the time the task runs
+ */
+template <typename F, typename... Args>
+inline auto makeCancellableTaskPair(CancellationToken _cancellation, F&& _f, Args&&... _args)
+{
+    using Ret = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+    TaskPromise<Ret> promise;
+    TaskFuture<Ret> future = promise.getFuture();
+
+    auto argsTuple = std::make_tuple(std::forward<Args>(_args)...);
+
+    MoveOnlyTask<void()> wrapper = [promise = std::move(promise), f = std::forward<F>(_f),
+                                    argsTuple = std::move(argsTuple),
+                                    cancellation = std::move(_cancellation)]() mutable
+    {
+        if (cancellation.isCancellationRequested())
         {
-            if constexpr (std::is_void_v<Ret>)
-            {
-                std::apply(std::move(f), std::move(argsTuple));
+            // pending, the future completes as cancelled and the callable never runs
+            promise.getState()->cancel();
+            return;
+        }
 
-                if (!token.isCancellationRequested()) promise->setValue();
-            }
-            else
-            {
-                auto result = std::apply(std::move(f), std::move(argsTuple));
+        detail::runTaskPair(promise, f, argsTuple);
+    };
 
-                if (!token.isCancellationRequested()) promise->setValue(std::move(result));
+    return std::make_pair(std::move(wrapper), std::move(future));
+}
+
+/**
+ * @brief Combine futures into one that is ready once all of them are, holding them in the same
+ * order
+ *
+ * Every future decrements an atomic counter when it completes (see TaskFuture::onReady()), so no
+ * thread waits for them. Failed or cancelled futures count as complete, their own get() rethrows.
+ *
+ * @throws FutureException no_state if a future is invalid
+ */
+template <typename T>
+TaskFuture<std::vector<TaskFuture<T>>> whenAll(std::vector<TaskFuture<T>> _futures)
+{
+    struct State
+    {
+        std::vector<TaskFuture<T>> futures;
+        TaskPromise<std::vector<TaskFuture<T>>> promise;
+        std::atomic<size_t> remaining; // one per future, plus one released after registration
+
+        void release()
+        {
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                promise.setValue(std::move(futures));
             }
         }
-        catch (...)
+    };
+
+    for (const TaskFuture<T>& future : _futures)
+    {
+        if (!future.isValid()) throw FutureException(FutureErrorCode::no_state);
+    }
+
+    auto state = std::make_shared<State>();
+    state->remaining.store(_futures.size() + 1, std::memory_order_relaxed);
+    state->futures = std::move(_futures);
+
+    TaskFuture<std::vector<TaskFuture<T>>> result = state->promise.getFuture();
+
+    for (TaskFuture<T>& future : state->futures) future.onReady([state] { state->release(); });
+
+    state->release();
+
+    return result;
+}
+
+/**
+ * @brief The result of whenAny(): the index of the first future that completed, and every future.
+ */
+template <typename T>
+struct WhenAnyResult
+{
+    size_t index;
+    std::vector<TaskFuture<T>> futures;
+};
+
+/**
+ * @brief Combine futures into one that is ready as soon as one of them is
+ *
+ * The first future to complete claims the result with a compare-exchange, the others complete
+ * later in the returned vector. An empty set is ready at once, with index 0.
+ *
+ * @throws FutureException no_state if a future is invalid
+ */
+template <typename T>
+TaskFuture<WhenAnyResult<T>> whenAny(std::vector<TaskFuture<T>> _futures)
+{
+    struct State
+    {
+        std::vector<TaskFuture<T>> futures;
+        TaskPromise<WhenAnyResult<T>> promise;
+        std::atomic<size_t> index{detail::k_noFutureIndex};
+        std::atomic<uint32_t> holds{2}; // the winner and the registration
+
+        void release()
         {
-            promise->setException(std::current_exception());
+            if (holds.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                const size_t first = index.load(std::memory_order_acquire);
+                const size_t winner = first == detail::k_noFutureIndex ? 0 : first;
+                promise.setValue(WhenAnyResult<T>{winner, std::move(futures)});
+            }
         }
     };
 
-    return std::make_pair(std::move(wrapper), std::move(future));
+    for (const TaskFuture<T>& future : _futures)
+    {
+        if (!future.isValid()) throw FutureException(FutureErrorCode::no_state);
+    }
+
+    auto state = std::make_shared<State>();
+    if (_futures.empty()) state->holds.store(1, std::memory_order_relaxed);
+    state->futures = std::move(_futures);
+
+    TaskFuture<WhenAnyResult<T>> result = state->promise.getFuture();
+
+    for (size_t i = 0; i < state->futures.size(); ++i)
+    {
+        state->futures[i].onReady(
+            [state, i]
+            {
+                size_t expected = detail::k_noFutureIndex;
+                if (state->index.compare_exchange_strong(expected, i, std::memory_order_acq_rel))
+                {
+                    state->release();
+                }
+            });
+    }
+
+    state->release();
+
+    return result;
 }
 
 } // namespace exec
@@ -0,0 +1,382 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+#include "thread_pool.hpp"
+#include "move_only_task.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+// Identifies a node of a TaskGraph, the index of the node in insertion order.
+using TaskNodeID = uint32_t;
+
+/**
+ * @brief A directed acyclic graph of tasks, built once and submitted to a thread pool every frame.
+ *
+ * Every node has a dependency counter reset to its number of predecessors on submission. The roots
+ * are enqueued to the pool, and the worker completing a node decrements the counters of its
+ * successors: it keeps running the first one that becomes ready and pushes the others to its own
+ * local queue (see ThreadPool::enqueueToCurrentWorker()), where idle workers steal them. The
+ * submitting thread only blocks once per frame, in wait().
+ *
+ * Once a node throws, the nodes that did not start yet are skipped (their counters still go down
+ * so the submission completes) and wait() rethrows the first exception.
+ *
+ * @note The graph must not be modified or submitted again while a submission is in flight, and
+ * must outlive it (the destructor waits for it).
+ *
+ * @example
+ *   TaskGraph graph;
+ *   const TaskNodeID input = graph.addNode([&] { pollInput(); }, "input");
+ *   const TaskNodeID ai = graph.addNode([&] { updateAI(); }, "ai");
+ *   const TaskNodeID physics = graph.addNode([&] { stepPhysics(); }, "physics");
+ *   graph.precede(input, physics);
+ *   graph.precede(ai, physics);
+ *
+ *   while (running) graph.run(pool); // physics runs after input and ai, every frame
+ */
+class TaskGraph final
+{
+   public:
+    static constexpr TaskNodeID k_invalidNode = std::numeric_limits<TaskNodeID>::max();
+
+   private:
+    struct Node
+    {
+        MoveOnlyTask<void()> work;
+        std::string debugName;
+        std::vector<TaskNodeID> successors;
+        uint32_t predecessorCount = 0;
+    };
+
+    // One per node, on its own cache line so that workers completing unrelated nodes do not
+    // false-share their counters.
+    struct alignas(MOSAIC_CACHE_LINE_SIZE) DependencyCounter
+    {
+        std::atomic<uint32_t> pending{0};
+    };
+
+    std::vector<Node> m_nodes; // indexed by TaskNodeID
+    std::vector<TaskNodeID> m_roots;
+    std::unique_ptr<DependencyCounter[]> m_counters;
+    bool m_validated = false; // roots and counters match the nodes, the graph is acyclic
+
+    // State of the submission in flight
+    ThreadPool* m_pool = nullptr;
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<uint32_t> m_remaining{0};
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<bool> m_failed{false};
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_submitted = false;   // guarded by m_mutex
+    bool m_completed = false;   // guarded by m_mutex
+    std::exception_ptr m_error; // guarded by m_mutex
+
+   public:
+    TaskGraph() = default;
+
+    ~TaskGraph() { waitForCompletion(); }
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+   public:
+    /**
+     * @brief Adds a node running the given work, with no dependencies yet.
+     *
+     * @param _work The work of the node, invoked once per submission.
+     * @param _debugName An optional name, for debugging only.
+     * @return The ID of the new node.
+     * @throws std::logic_error if a submission is in flight.
+     */
+    TaskNodeID addNode(MoveOnlyTask<void()> _work, std::string _debugName = {})
+    {
+        throwIfSubmitted();
+
+        m_nodes.push_back({std::move(_work), std::move(_debugName), {}, 0});
+        m_validated = false;
+
+        return static_cast<TaskNodeID>(m_nodes.size() - 1);
+    }
+
+    /**
+     * @brief Makes a node run only after another one completed (adding the same edge twice has no
+     * effect). Cycles are detected by the next submission.
+     *
+     * @throws std::out_of_range if either node does not exist.
+     * @throws std::invalid_argument if both are the same node.
+     * @throws std::logic_error if a submission is in flight.
+     */
+    void precede(TaskNodeID _before, TaskNodeID _after)
+    {
+        throwIfSubmitted();
+
+        if (_before >= m_nodes.size() || _after >= m_nodes.size())
+        {
+            throw std::out_of_range("TaskGraph node does not exist.");
+        }
+
+        if (_before == _after)
+        {
+            throw std::invalid_argument("A TaskGraph node cannot precede itself.");
+        }
+
+        std::vector<TaskNodeID>& successors = m_nodes[_before].successors;
+        if (std::ranges::find(successors, _after) != successors.end()) return;
+
+        successors.push_back(_after);
+        m_nodes[_after].predecessorCount++;
+        m_validated = false;
+    }
+
+    /**
+     * @brief Resets the dependency counters and enqueues the roots of the graph to the pool, then
+     * returns without waiting.
+     *
+     * @throws std::logic_error if the graph has a cycle or a submission is in flight.
+     */
+    void submit(ThreadPool& _pool)
+    {
+        start(_pool);
+
+        for (TaskNodeID root : m_roots) schedule(root);
+    }
+
+    /**
+     * @brief Blocks until the submission in flight completed.
+     *
+     * @throws The first exception thrown by a node of the submission.
+     */
+    void wait()
+    {
+        std::exception_ptr error = waitForCompletion();
+
+        if (error) std::rethrow_exception(error);
+    }
+
+    /**
+     * @brief Blocks until the submission in flight completed, or for the timeout at most, so that
+     * the submitting thread can do something else between two waits (help the pool, pump events).
+     *
+     * @return true if nothing is in flight anymore: wait() returns at once, or rethrows.
+     */
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& _timeout)
+    {
+        std::unique_lock lock(m_mutex);
+        if (!m_submitted) return true;
+
+        return m_cv.wait_for(lock, _timeout, [this] { return m_completed; });
+    }
+
+    /**
+     * @brief Submits the graph and waits for it, the calling thread runs the first root (and the
+     * chain of nodes it unlocks) instead of idling.
+     *
+     * @throws std::logic_error if the graph has a cycle or a submission is in flight.
+     * @throws The first exception thrown by a node.
+     */
+    void run(ThreadPool& _pool)
+    {
+        start(_pool);
+
+        if (!m_roots.empty())
+        {
+            for (size_t i = 1; i < m_roots.size(); ++i) schedule(m_roots[i]);
+
+            execute(m_roots.front());
+        }
+
+        wait();
+    }
+
+    [[nodiscard]] bool isSubmitted() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_submitted;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return m_nodes.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_nodes.empty(); }
+
+    [[nodiscard]] const std::string& debugName(TaskNodeID _id) const
+    {
+        return m_nodes.at(_id).debugName;
+    }
+
+    // Removes every node, the IDs handed out so far become invalid.
+    void clear()
+    {
+        throwIfSubmitted();
+
+        m_nodes.clear();
+        m_roots.clear();
+        m_counters.reset();
+        m_validated = false;
+    }
+
+   private:
+    void throwIfSubmitted() const
+    {
+        if (isSubmitted()) throw std::logic_error("TaskGraph is already submitted.");
+    }
+
+    // Finds the roots and checks the graph is acyclic (Kahn's algorithm).
+    void validate()
+    {
+        m_roots.clear();
+        std::vector<uint32_t> pending(m_nodes.size());
+        std::vector<TaskNodeID> ready;
+
+        for (TaskNodeID id = 0; id < m_nodes.size(); ++id)
+        {
+            pending[id] = m_nodes[id].predecessorCount;
+            if (pending[id] == 0) m_roots.push_back(id);
+        }
+
+        ready = m_roots;
+        size_t visited = 0;
+
+        while (!ready.empty())
+        {
+            const TaskNodeID id = ready.back();
+            ready.pop_back();
+            visited++;
+
+            for (TaskNodeID successor : m_nodes[id].successors)
+            {
+                if (--pending[successor] == 0) ready.push_back(successor);
+            }
+        }
+
+        if (visited != m_nodes.size()) throw std::logic_error("TaskGraph has a dependency cycle.");
+
+        m_counters = std::make_unique<DependencyCounter[]>(m_nodes.size());
+        m_validated = true;
+    }
+
+    void start(ThreadPool& _pool)
+    {
+        throwIfSubmitted();
+
+        if (!m_validated) validate();
+
+        for (TaskNodeID id = 0; id < m_nodes.size(); ++id)
+        {
+            m_counters[id].pending.store(m_nodes[id].predecessorCount, std::memory_order_relaxed);
+        }
+
+        m_pool = &_pool;
+        m_failed.store(false, std::memory_order_relaxed);
+        m_remaining.store(static_cast<uint32_t>(m_nodes.size()), std::memory_order_relaxed);
+
+        std::lock_guard lock(m_mutex);
+        m_submitted = true;
+        m_completed = m_nodes.empty();
+        m_error = nullptr;
+    }
+
+    void schedule(TaskNodeID _id) noexcept
+    {
+        // the pool is shutting down, the node still has to run for the submission to complete
+        if (!m_pool->enqueueToCurrentWorker([this, _id] { execute(_id); })) execute(_id);
+    }
+
+    void execute(TaskNodeID _id) noexcept
+    {
+        while (true)
+        {
+            Node& node = m_nodes[_id];
+
+            if (!m_failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    node.work();
+                }
+                catch (...)
+                {
+                    fail(std::current_exception());
+                }
+            }
+
+            // acq_rel, the last predecessor to finish sees the writes of all the others
+            TaskNodeID next = k_invalidNode;
+            for (TaskNodeID successor : node.successors)
+            {
+                if (m_counters[successor].pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                {
+                    continue;
+                }
+
+                if (next == k_invalidNode)
+                {
+                    next = successor;
+                }
+                else
+                {
+                    schedule(successor);
+                }
+            }
+
+            // the graph must not be touched past the last completion, wait() may have returned
+            if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                complete();
+                return;
+            }
+
+            if (next == k_invalidNode) return;
+
+            _id = next;
+        }
+    }
+
+    void fail(std::exception_ptr _error) noexcept
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (!m_error) m_error = std::move(_error);
+        m_failed.store(true, std::memory_order_relaxed);
+    }
+
+    void complete() noexcept
+    {
+        // notified under the lock, the waiter cannot destroy the graph before the call returned
+        std::lock_guard lock(m_mutex);
+
+        m_completed = true;
+        m_cv.notify_all();
+    }
+
+    std::exception_ptr waitForCompletion() noexcept
+    {
+        std::unique_lock lock(m_mutex);
+        if (!m_submitted) return nullptr;
+
+        m_cv.wait(lock, [this] { return m_completed; });
+
+        m_submitted = false;
+        return std::exchange(m_error, nullptr);
+    }
+};
+
+} // namespace exec
+} // namespace mosaic
@@ -2,6 +2,17 @@
 
 #include "mosaic/defines.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <pieces/core/result.hpp>
 #include <pieces/utils/enum_flags.hpp>
 
@@ -16,6 +27,23 @@ namespace mosaic
 namespace exec
 {
 
+/**
+ * @brief The priority of a task. A worker always looks for tasks of a higher priority first: in
+ * its own queues, the global queue, then the other workers' queues, before going down a level.
+ *
+ * Tasks are not preempted: a critical task submitted while every worker runs a long background
+ * task waits for one of them to return (see WorkerSharingMode::accept_background to keep workers
+ * free of background work).
+ */
+enum class TaskPriority : uint8_t
+{
+    critical = 0,   /// Frame-critical work, run before anything else.
+    normal = 1,     /// The default.
+    background = 2, /// Long-running work (streaming, decompression), run when nothing else waits.
+};
+
+inline constexpr size_t k_taskPriorityCount = 3;
+
 /**
  * @brief Describes how a worker shares or isolates its workload.
  *
@@ -25,10 +53,13 @@ namespace exec
 enum class WorkerSharingMode : uint8_t
 {
     none = 0,
-    allow_steal = 1 << 1,     /// Other workers can steal tasks from it.
-    accept_direct = 1 << 3,   /// The thread pool can assign tasks directly to this worker.
-    accept_indirect = 1 << 2, /// The thread pool can assign tasks through automatic dispatch.
-    global_consumer = 1 << 6, /// Can pull tasks directly from the global queue.
+    allow_steal = 1 << 1,       /// Other workers can steal tasks from it.
+    accept_direct = 1 << 3,     /// The thread pool can assign tasks directly to this worker.
+    accept_indirect = 1 << 2,   /// The thread pool can assign tasks through automatic dispatch.
+    lifo_local = 1 << 4,        /// Tasks it enqueues itself run newest first (work-stealing deque).
+    accept_background = 1 << 5, /// The pool hands it background tasks (assigned, global, stolen).
+    global_consumer = 1 << 6,   /// Can pull tasks directly from the global queue.
+    background_only = 1 << 7,   /// The pool only hands it background tasks (a reserved lane).
 };
 
 MOSAIC_DEFINE_ENUM_FLAGS_OPERATORS(WorkerSharingMode)
@@ -41,18 +72,105 @@ inline constexpr WorkerSharingMode exclusive = WorkerSharingMode::accept_direct;
 
 inline constexpr WorkerSharingMode shared =
     WorkerSharingMode::allow_steal | WorkerSharingMode::accept_direct |
-    WorkerSharingMode::accept_indirect | WorkerSharingMode::global_consumer;
+    WorkerSharingMode::accept_indirect | WorkerSharingMode::lifo_local |
+    WorkerSharingMode::accept_background | WorkerSharingMode::global_consumer;
+
+inline constexpr WorkerSharingMode shared_no_steal =
+    WorkerSharingMode::accept_direct | WorkerSharingMode::accept_indirect |
+    WorkerSharingMode::lifo_local | WorkerSharingMode::accept_background |
+    WorkerSharingMode::global_consumer;
+
+// Like shared, but every task runs in submission order.
+inline constexpr WorkerSharingMode shared_fifo =
+    WorkerSharingMode::allow_steal | WorkerSharingMode::accept_direct |
+    WorkerSharingMode::accept_indirect | WorkerSharingMode::accept_background |
+    WorkerSharingMode::global_consumer;
 
-inline constexpr WorkerSharingMode shared_no_steal = WorkerSharingMode::accept_direct |
-                                                     WorkerSharingMode::accept_indirect |
-                                                     WorkerSharingMode::global_consumer;
+// Like shared, but never starts a background task, so it is always free for frame work within
+// one task.
+inline constexpr WorkerSharingMode frame_lane =
+    WorkerSharingMode::allow_steal | WorkerSharingMode::accept_direct |
+    WorkerSharingMode::accept_indirect | WorkerSharingMode::lifo_local |
+    WorkerSharingMode::global_consumer;
+
+// Reserved for background tasks, pair it with frame_lane workers.
+inline constexpr WorkerSharingMode background_lane =
+    WorkerSharingMode::allow_steal | WorkerSharingMode::accept_direct |
+    WorkerSharingMode::accept_indirect | WorkerSharingMode::accept_background |
+    WorkerSharingMode::global_consumer | WorkerSharingMode::background_only;
 
 } // namespace worker_sharing_presets
 
+/**
+ * @brief How an idle worker waits for work.
+ *
+ * Between two attempts at finding work (its queues, the global queue, then stealing), a worker
+ * first spins with a CPU pause, then yields its time slice, then parks until a task is enqueued
+ * for it. A parked worker still wakes up after the park timeout to look for work to steal, since
+ * tasks pushed to busy workers only wake one idle worker up.
+ */
+struct IdlePolicy
+{
+    std::chrono::microseconds spinDuration;  /// Idle time spent spinning before yielding.
+    std::chrono::microseconds yieldDuration; /// Idle time spent yielding before parking.
+    std::chrono::microseconds parkTimeout;   /// The longest park before looking for work again.
+};
+
+/// Common idle policies, selected with ThreadPool::setIdlePolicy().
+namespace idle_policy_presets
+{
+
+// Picks a task up within microseconds of its submission, at the cost of keeping idle cores busy
+// for a quarter of a millisecond.
+inline constexpr IdlePolicy low_latency{std::chrono::microseconds(50),
+                                        std::chrono::microseconds(200),
+                                        std::chrono::microseconds(1000)};
+
+// Parks almost at once and rarely wakes up on its own, for thermally limited devices. Tasks are
+// still picked up as soon as the parked worker is notified.
+inline constexpr IdlePolicy power_saving{std::chrono::microseconds(0),
+                                         std::chrono::microseconds(20),
+                                         std::chrono::microseconds(8000)};
+
+#if defined(MOSAIC_PLATFORM_MOBILE) || defined(MOSAIC_PLATFORM_WEB)
+inline constexpr IdlePolicy platform_default = power_saving;
+#else
+inline constexpr IdlePolicy platform_default = low_latency;
+#endif
+
+} // namespace idle_policy_presets
+
+/**
+ * @brief What the pool records beyond its counters, see ThreadPool::setTelemetry().
+ */
+enum class PoolTelemetry : uint8_t
+{
+    none = 0,
+    timings = 1 << 0, /// Queue wait and execution time of every task, into per-worker histograms.
+    tracing = 1 << 1, /// A tools::Tracer event per task (function category), on named threads.
+};
+
+MOSAIC_DEFINE_ENUM_FLAGS_OPERATORS(PoolTelemetry)
+
+/**
+ * @brief Percentiles of a task timing in nanoseconds, read from log-linear histogram buckets: a
+ * percentile is the upper bound of its bucket, at most 12.5% above the actual value.
+ */
+struct LatencyPercentiles
+{
+    uint64_t count; /// Timings recorded.
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t max;
+};
+
 /**
  * @brief Statistics snapshot for a single worker (copy, no atomics exposed).
  *
- * All counters are cumulative since pool initialization or last resetStats() call.
+ * All counters are cumulative since pool initialization or last resetStats() call. Timings are
+ * only recorded while PoolTelemetry::timings is enabled: queue wait from the submission to the
+ * start of the task on the worker, execution including the tasks it ran while helping.
  */
 struct WorkerStatsSnapshot
 {
@@ -61,6 +179,9 @@ struct WorkerStatsSnapshot
     uint64_t stealAttempts;           /// Total steal attempts made by this worker.
     uint64_t tasksReceivedFromGlobal; /// Total tasks received from global queue.
     size_t currentQueueSize;          /// Approximate current queue size.
+    uint64_t idleNanoseconds;         /// Time spent idle (spinning, yielding or parked).
+    LatencyPercentiles queueWait;     /// Submission to start of the tasks it ran.
+    LatencyPercentiles execution;     /// Start to end of the tasks it ran.
 };
 
 /**
@@ -75,6 +196,9 @@ struct PoolStatsSnapshot
     uint64_t totalStealAttempts;
     uint64_t totalTasksReceivedFromGlobal;
     size_t totalQueuedTasks;
+    uint64_t totalIdleNanoseconds;
+    LatencyPercentiles queueWait; /// Over the histograms of every worker.
+    LatencyPercentiles execution;
 
     /// Compute average tasks stolen per steal attempt. Can exceed 1.0 due to batch stealing.
     /// Returns 0.0 if no attempts made.
@@ -86,6 +210,147 @@ struct PoolStatsSnapshot
     }
 };
 
+/**
+ * @brief Where a worker runs: the logical processor it is pinned to, and what it shares with the
+ * other workers. Workers steal from the workers of their cache group first, then of their NUMA
+ * node, then from any other.
+ */
+struct WorkerPlacement
+{
+    uint32_t processor = 0;      /// Logical processor the worker is pinned to.
+    uint32_t cacheGroup = 0;     /// Last-level cache group of the processor.
+    uint32_t numaNode = 0;       /// NUMA node of the processor.
+    bool performanceCore = true; /// Whether the core is of the highest efficiency class.
+};
+
+/**
+ * @brief Plans the placement of the workers over the topology reported in the CPU info.
+ *
+ * Processors are ordered one per physical core first (SMT siblings last), the fastest cores first,
+ * then by NUMA node and cache group so that consecutive workers share their caches. The first
+ * processor is left to the main thread, the workers take the next ones (wrapping around when there
+ * are more workers than processors), so the lowest worker ids sit on performance cores.
+ *
+ * @return One placement per worker, empty if the CPU info has no topology.
+ */
+MOSAIC_API [[nodiscard]] std::vector<WorkerPlacement> planWorkerPlacement(
+    const core::CPUInfo& _cpuInfo, uint32_t _workersCount);
+
+namespace detail
+{
+
+/**
+ * @brief The state shared by the tasks of one ThreadPool::enqueueBulk() call: the function, one
+ * completion counter and the promise of the whole batch, in place of a promise per task.
+ */
+template <typename F>
+struct BulkState
+{
+    F func;
+    TaskPromise<void> promise;
+    SharedState<void>* shared; // of the promise, checked for cancellation by every task
+    CancellationToken cancellation;
+
+    std::atomic<size_t> remaining{1}; // tasks alive, plus one held by enqueueBulk() while it runs
+    std::atomic<bool> failed{false};
+    std::atomic<bool> dropped{false};   // a task was destroyed without running (shutdown)
+    std::atomic<bool> cancelled{false}; // a task was skipped for the cancellation token
+    std::exception_ptr error;           // written by the first task that failed
+
+    BulkState(F _func, CancellationToken _cancellation)
+        : func(std::move(_func)),
+          shared(promise.getState().get()),
+          cancellation(std::move(_cancellation))
+    {
+    }
+
+    // Called once per task, run or not: the last call completes the promise and frees the state.
+    void release(bool _ran) noexcept
+    {
+        if (!_ran) dropped.store(true, std::memory_order_relaxed);
+
+        // acq_rel, the last call sees the error and the drops of every other task
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+        try
+        {
+            // a dropped batch breaks the promise when it is destroyed
+            if (dropped.load(std::memory_order_relaxed)) {}
+            else if (error) promise.setException(error);
+            else if (cancelled.load(std::memory_order_relaxed)) shared->cancel();
+            else promise.setValue();
+        }
+        catch (...)
+        {
+            // the future was cancelled in the meantime
+        }
+
+        delete this;
+    }
+};
+
+// One element of a bulk submission. It releases the shared state when destroyed, so that the
+// batch still completes when the pool drops queued tasks.
+template <typename F, typename T>
+class BulkTask
+{
+   private:
+    BulkState<F>* m_state;
+    T m_value;
+    bool m_ran = false;
+
+   public:
+    BulkTask(BulkState<F>* _state, T _value) : m_state(_state), m_value(std::move(_value)) {}
+
+    BulkTask(BulkTask&& _other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : m_state(std::exchange(_other.m_state, nullptr)),
+          m_value(std::move(_other.m_value)),
+          m_ran(_other.m_ran)
+    {
+    }
+
+    BulkTask& operator=(BulkTask&&) = delete;
+
+    ~BulkTask()
+    {
+        if (m_state) m_state->release(m_ran);
+    }
+
+    void operator()()
+    {
+        m_ran = true;
+
+        BulkState<F>& state = *m_state;
+
+        // the first exception (or a cancellation) skips the tasks that did not start yet
+        if (state.failed.load(std::memory_order_relaxed) ||
+            state.shared->isCancellationRequested())
+        {
+            return;
+        }
+
+        if (state.cancellation.isCancellationRequested())
+        {
+            state.cancelled.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        try
+        {
+            std::invoke(std::as_const(state.func), m_value);
+        }
+        catch (...)
+        {
+            if (!state.failed.exchange(true, std::memory_order_relaxed))
+            {
+                state.error = std::current_exception();
+            }
+        }
+    }
+};
+
+} // namespace detail
+
 /**
  * @brief A thread worker wraps a single thread and manages its task queue.
  *
@@ -123,6 +388,14 @@ class MOSAIC_API ThreadPool
     ThreadPool& operator=(const ThreadPool&) = delete;
 
    public:
+    /**
+     * @brief Creates one worker per logical core but one, left to the main thread (at least 5).
+     *
+     * If the CPU info has a topology (see core::SystemInfo::getCPUInfo()), the workers are pinned
+     * following planWorkerPlacement(). On hybrid CPUs, critical tasks then go to the workers of
+     * performance cores first, and these do not take background tasks (frame_lane). Otherwise
+     * worker i is pinned to logical core i + 1.
+     */
     pieces::RefResult<ThreadPool, std::string> initialize(
         const mosaic::core::CPUInfo& _cpuInfo) noexcept;
     void shutdown() noexcept;
@@ -152,6 +425,45 @@ class MOSAIC_API ThreadPool
         return std::make_optional(std::move(future));
     }
 
+    // Same as above, with the given priority.
+    template <typename F, typename... Args>
+    std::optional<TaskFuture<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>>
+    enqueueToGlobal(TaskPriority _priority, F&& _f, Args&&... _args)
+    {
+        auto [wrapper, future] = makeTaskPair(std::forward<F>(_f), std::forward<Args>(_args)...);
+
+        if (!assignTaskToGlobal(std::move(wrapper), _priority)) return std::nullopt;
+
+        return std::make_optional(std::move(future));
+    }
+
+    /**
+     * @brief Same as above, the task is dropped when a worker takes it if the token was cancelled
+     * by then (its future is cancelled, the callable does not run). A running task is not
+     * interrupted, it may poll the token itself.
+     */
+    template <typename F, typename... Args>
+    std::optional<TaskFuture<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>>
+    enqueueToGlobal(CancellationToken _cancellation, F&& _f, Args&&... _args)
+    {
+        return enqueueToGlobal(TaskPriority::normal, std::move(_cancellation), std::forward<F>(_f),
+                               std::forward<Args>(_args)...);
+    }
+
+    // Same as above, with the given priority.
+    template <typename F, typename... Args>
+    std::optional<TaskFuture<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>>
+    enqueueToGlobal(TaskPriority _priority, CancellationToken _cancellation, F&& _f,
+                    Args&&... _args)
+    {
+        auto [wrapper, future] = makeCancellableTaskPair(
+            std::move(_cancellation), std::forward<F>(_f), std::forward<Args>(_args)...);
+
+        if (!assignTaskToGlobal(std::move(wrapper), _priority)) return std::nullopt;
+
+        return std::make_optional(std::move(future));
+    }
+
     /**
      * @brief Tries to perform optimal assignment of a task to worker threads and fallbacks to the
      * global queue if no suitable worker is found.
@@ -178,6 +490,125 @@ class MOSAIC_API ThreadPool
         return std::make_optional(std::move(future));
     }
 
+    /**
+     * @brief Same as above, with the given priority. Critical and normal tasks avoid the workers
+     * busy with a background task, background tasks go to the workers accepting them.
+     *
+     * @example
+     *   pool.enqueueToWorker(TaskPriority::background, [&] { transcode(texture); });
+     *   pool.enqueueToWorker(TaskPriority::critical, [&] { cullVisibleObjects(camera); });
+     */
+    template <typename F, typename... Args>
+    std::optional<TaskFuture<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>>
+    enqueueToWorker(TaskPriority _priority, F&& _f, Args&&... _args)
+    {
+        auto [wrapper, future] = makeTaskPair(std::forward<F>(_f), std::forward<Args>(_args)...);
+
+        if (!assignTaskToWorker(std::move(wrapper), _priority)) return std::nullopt;
+
+        return std::make_optional(std::move(future));
+    }
+
+    /**
+     * @brief Same as above, the task is dropped when a worker takes it if the token was cancelled
+     * by then (its future is cancelled, the callable does not run). A running task is not
+     * interrupted, it may poll the token itself.
+     *
+     * @example
+     *   CancellationSource speculation(std::chrono::steady_clock::now() + 4ms);
+     *   auto path = pool.enqueueToWorker(speculation.token(), [&, token = speculation.token()]
+     *                                    { return findPath(from, to, token); });
+     */
+    template <typename F, typename... Args>
+    std::optional<TaskFuture<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>>
+    enqueueToWorker(CancellationToken _cancellation, F&& _f, Args&&... _args)
+    {
+        return enqueueToWorker(TaskPriority::normal, std::move(_cancellation), std::forward<F>(_f),
+                               std::forward<Args>(_args)...);
+    }
+
+    // Same as above, with the given priority.
+    template <typename F, typename... Args>
+    std::optional<TaskFuture<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>>
+    enqueueToWorker(TaskPriority _priority, CancellationToken _cancellation, F&& _f,
+                    Args&&... _args)
+    {
+        auto [wrapper, future] = makeCancellableTaskPair(
+            std::move(_cancellation), std::forward<F>(_f), std::forward<Args>(_args)...);
+
+        if (!assignTaskToWorker(std::move(wrapper), _priority)) return std::nullopt;
+
+        return std::make_optional(std::move(future));
+    }
+
+    /**
+     * @brief Enqueues one task per element of the range and returns a single future for all of
+     * them, completed once every task returned.
+     *
+     * The tasks share one state (the function and a completion counter) instead of a promise
+     * each, and are spread over the workers in contiguous blocks, one bulk enqueue per worker,
+     * from a worker that rotates between calls. Elements are copied into their task: pass indices
+     * (std::views::iota) or pointers rather than large objects. The function is called as
+     * func(element) concurrently, and once it throws the tasks that did not start yet are
+     * skipped. So are they once the cancellation token is cancelled, the future of the batch is
+     * then cancelled.
+     *
+     * @return The future of the batch, rethrowing the first exception, or std::nullopt if the
+     * pool is shutting down (no task runs then).
+     *
+     * @example
+     *   auto done = pool.enqueueBulk(std::views::iota(size_t{0}, particles.size()),
+     *                                [&](size_t _i) { integrate(particles[_i], dt); });
+     *   if (done) done->wait();
+     */
+    template <std::ranges::input_range Range, typename F>
+        requires std::is_invocable_v<const std::decay_t<F>&, std::ranges::range_value_t<Range>&>
+    std::optional<TaskFuture<void>> enqueueBulk(Range&& _range, F&& _func,
+                                                TaskPriority _priority = TaskPriority::normal,
+                                                CancellationToken _cancellation = {})
+    {
+        using State = detail::BulkState<std::decay_t<F>>;
+        using Value = std::ranges::range_value_t<Range>;
+
+        auto* state = new State(std::forward<F>(_func), std::move(_cancellation));
+        TaskFuture<void> future = state->promise.getFuture();
+
+        std::vector<MoveOnlyTask<void()>> tasks;
+        if constexpr (std::ranges::sized_range<Range>)
+        {
+            tasks.reserve(static_cast<size_t>(std::ranges::size(_range)));
+        }
+
+        // the whole vector is counted at once, the tasks destroyed on a throw still release
+        try
+        {
+            for (auto&& element : _range)
+            {
+                tasks.emplace_back(detail::BulkTask<std::decay_t<F>, Value>(
+                    state, Value(std::forward<decltype(element)>(element))));
+            }
+        }
+        catch (...)
+        {
+            state->remaining.fetch_add(tasks.size(), std::memory_order_relaxed);
+            tasks.clear();
+            state->release(false);
+            throw;
+        }
+
+        state->remaining.fetch_add(tasks.size(), std::memory_order_relaxed);
+
+        // the tasks refused by a pool shutting down are destroyed here, unrun
+        const bool assigned = assignTasksToWorkers(tasks, _priority);
+        tasks.clear();
+
+        state->release(true);
+
+        if (!assigned) return std::nullopt;
+
+        return std::make_optional(std::move(future));
+    }
+
     /**
      * @brief Enqueues a task to a worker thread by its ID.
      *
@@ -230,24 +661,140 @@ class MOSAIC_API ThreadPool
         return std::make_optional(std::move(future));
     }
 
+    /**
+     * @brief Enqueues a fire-and-forget task to the local queue of the calling worker, so that
+     * continuations (see TaskGraph) stay on the core that produced their inputs while idle workers
+     * can still steal them.
+     *
+     * A worker in lifo_local mode pushes it to its work-stealing deque: it runs the newest task
+     * first, while its cache is still warm, and thieves take the oldest one (the largest piece of
+     * a recursive split). Off the pool's workers, or when the calling worker does not accept
+     * direct submissions, the task is assigned like enqueueToWorker() does. Exceptions thrown by
+     * the task are logged.
+     *
+     * @return true if the task was enqueued.
+     * @return false if the thread pool is shutting down and cannot accept new tasks.
+     */
+    bool enqueueToCurrentWorker(MoveOnlyTask<void()> _task) noexcept;
+
+    /**
+     * @brief Same as above with the given priority, the priority of the running task (normal off
+     * the pool's workers) otherwise. Background tasks skip the deque, which holds the worker's
+     * critical and normal work.
+     */
+    bool enqueueToCurrentWorker(MoveOnlyTask<void()> _task, TaskPriority _priority) noexcept;
+
+    /**
+     * @brief Runs one pending task on the calling thread, so a thread waiting for work it handed
+     * to the pool (see parallelFor()) helps instead of blocking.
+     *
+     * A worker of the pool takes from its local queue, the global queue, then steals like it does
+     * when idle, down to the priority of the task it runs. Other threads take critical and
+     * normal tasks from the global queue, then steal them from the workers allowing it.
+     * Exceptions thrown by the task are logged.
+     *
+     * @return true if a task was run.
+     */
+    bool tryExecutePendingTask() noexcept;
+
+    /**
+     * @brief The awaitable of schedule() and yield(): suspends the coroutine and enqueues a task
+     * resuming it on a worker.
+     *
+     * If the pool refuses the task while shutting down, the coroutine resumes on the calling
+     * thread instead. Resumptions still queued when the pool shuts down are dropped, so the
+     * coroutines awaiting them must be done by then.
+     */
+    class ScheduleAwaitable
+    {
+       private:
+        ThreadPool* m_pool;
+        bool m_yield;
+
+       public:
+        ScheduleAwaitable(ThreadPool* _pool, bool _yield) noexcept : m_pool(_pool), m_yield(_yield)
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> _handle) noexcept
+        {
+            // the coroutine may already run on a worker once the task is enqueued, the awaitable
+            // (which lives in its frame) must not be touched past this point
+            MoveOnlyTask<void()> resume = [_handle] { _handle.resume(); };
+
+            return m_yield ? m_pool->requeueToCurrentWorker(std::move(resume))
+                           : m_pool->assignTaskToWorker(std::move(resume));
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Returns an awaitable moving the awaiting coroutine to a worker of the pool, assigned
+     * like enqueueToWorker() does.
+     *
+     * @example
+     *   pieces::Task<Mesh> loadMesh(ThreadPool& _pool, std::string _path)
+     *   {
+     *       co_await _pool.schedule(); // the rest runs on a worker
+     *       co_return parseMesh(co_await readFileAsync(_path));
+     *   }
+     */
+    [[nodiscard]] ScheduleAwaitable schedule() noexcept { return {this, false}; }
+
+    /**
+     * @brief Returns an awaitable letting the tasks queued on the current worker run before the
+     * awaiting coroutine resumes, enqueued behind them to the worker's MPMC queue.
+     */
+    [[nodiscard]] ScheduleAwaitable yield() noexcept { return {this, true}; }
+
     void setWorkerAffinity(uint32_t _workerId, size_t _cpuCoreId) noexcept;
     void setWorkerSharingMode(uint32_t _workerId, WorkerSharingMode _sharingMode) noexcept;
 
+    /**
+     * @brief Sets how idle workers wait for work (idle_policy_presets::platform_default unless
+     * set), taken into account by every worker the next time it goes idle.
+     */
+    void setIdlePolicy(const IdlePolicy& _policy) noexcept;
+    [[nodiscard]] IdlePolicy getIdlePolicy() const noexcept;
+
     [[nodiscard]] bool isRunning() const noexcept;
 
     [[nodiscard]] uint32_t getWorkersCount() const noexcept;
     [[nodiscard]] uint32_t getBusyWorkersCount() const noexcept;
     [[nodiscard]] uint32_t getIdleWorkersCount() const noexcept;
 
+    /**
+     * @brief Suspends the workers past the first _count (all of them run after initialize()): the
+     * pool assigns them no task and they take none from the global queues or the other workers,
+     * running the tasks already in their own queues before parking. Clamped to [1, workers].
+     *
+     * Meant for shedding load when the device heats up, not for tuning throughput.
+     */
+    void setActiveWorkersCount(uint32_t _count) noexcept;
+    [[nodiscard]] uint32_t getActiveWorkersCount() const noexcept;
+
     /// @brief Get statistics snapshot for a specific worker.
     [[nodiscard]] WorkerStatsSnapshot getWorkerStats(uint32_t _workerIdx) const noexcept;
 
+    /// @brief Get where a worker was placed by initialize().
+    [[nodiscard]] WorkerPlacement getWorkerPlacement(uint32_t _workerIdx) const noexcept;
+
     /// @brief Get aggregated statistics for entire pool (lazy - iterates all workers).
     [[nodiscard]] PoolStatsSnapshot getPoolStats() const noexcept;
 
     /// @brief Reset all statistics counters across all workers.
     void resetStats() noexcept;
 
+    /**
+     * @brief Selects the telemetry recorded for every task (none by default). Timings cost two
+     * clock reads and a wrapper per task, tracing an event in the tools::Tracer, if it exists.
+     */
+    void setTelemetry(PoolTelemetry _telemetry) noexcept;
+    [[nodiscard]] PoolTelemetry getTelemetry() const noexcept;
+
     /// @brief Get a random worker from the pool using a uniform distribution.
     [[nodiscard]] ThreadWorker* getRandomWorker() const noexcept;
 
@@ -265,7 +812,7 @@ class MOSAIC_API ThreadPool
     }
 
    private:
-    void setupWorker(uint32_t _idx);
+    void setupWorker(uint32_t _idx, const WorkerPlacement& _placement, bool _hybrid);
     void startupWorker(uint32_t _idx);
 
     /**
@@ -274,7 +821,8 @@ class MOSAIC_API ThreadPool
      * @return true if the task was successfully enqueued to the global queue.
      * @return false if the thread pool is shutting down and cannot accept new tasks.
      */
-    bool assignTaskToGlobal(MoveOnlyTask<void()> _task) noexcept;
+    bool assignTaskToGlobal(MoveOnlyTask<void()> _task,
+                            TaskPriority _priority = TaskPriority::normal) noexcept;
 
     /**
      * @brief Tries to perform optimal assignment of a task to a worker.
@@ -283,7 +831,20 @@ class MOSAIC_API ThreadPool
      * global queue.
      * @return false if the thread pool is shutting down and cannot accept new tasks.
      */
-    bool assignTaskToWorker(MoveOnlyTask<void()> _task) noexcept;
+    bool assignTaskToWorker(MoveOnlyTask<void()> _task,
+                            TaskPriority _priority = TaskPriority::normal) noexcept;
+
+    // Enqueues to the global queue of the priority and notifies the workers consuming it.
+    void pushToGlobal(MoveOnlyTask<void()> _task, TaskPriority _priority) noexcept;
+
+    /**
+     * @brief Moves the tasks to the workers accepting indirect submissions of the priority, in
+     * contiguous blocks with one bulk enqueue per worker (to the global queue if none does).
+     *
+     * @return false if the thread pool is shutting down, the tasks are left in the vector then.
+     */
+    bool assignTasksToWorkers(std::vector<MoveOnlyTask<void()>>& _tasks,
+                              TaskPriority _priority) noexcept;
 
     /**
      * @brief Assigns a task directly to a specific worker by its ID.
@@ -303,6 +864,14 @@ class MOSAIC_API ThreadPool
      */
     bool assignTaskToWorkerByDebugName(const std::string& _debugName,
                                        MoveOnlyTask<void()> _task) noexcept;
+
+    /**
+     * @brief Enqueues a task behind everything the calling worker has queued (see yield()), like
+     * enqueueToCurrentWorker() but never to its deque.
+     *
+     * @return false if the thread pool is shutting down and cannot accept new tasks.
+     */
+    bool requeueToCurrentWorker(MoveOnlyTask<void()> _task) noexcept;
 };
 
 } // namespace exec
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+/**
+ * @brief A Chase-Lev work-stealing deque: its owner pushes and pops at the bottom (newest first,
+ * wait-free unless the buffer grows), any other thread steals from the top (oldest first).
+ *
+ * This is the C11 formulation of Lê et al. ("Correct and Efficient Work-Stealing for Weak Memory
+ * Models", 2013). Elements are read by thieves before they win the race for them, so they must be
+ * trivially copyable, typically pointers to the actual work. The buffer doubles when full; the
+ * buffers it replaced are kept until the deque is destroyed since thieves may still read them.
+ *
+ * @tparam T A trivially copyable element type, usually a pointer.
+ */
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+class WorkStealingDeque final
+{
+   private:
+    struct Buffer
+    {
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Buffer(int64_t _capacity)
+            : capacity(_capacity),
+              mask(_capacity - 1),
+              slots(std::make_unique<std::atomic<T>[]>(static_cast<size_t>(_capacity)))
+        {
+        }
+
+        T load(int64_t _index) const noexcept
+        {
+            return slots[_index & mask].load(std::memory_order_relaxed);
+        }
+
+        void store(int64_t _index, T _value) noexcept
+        {
+            slots[_index & mask].store(_value, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<int64_t> m_top{0};
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<int64_t> m_bottom{0};
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<Buffer*> m_buffer;
+
+    std::vector<std::unique_ptr<Buffer>> m_buffers; // owned by the owner thread, last is current
+
+   public:
+    /**
+     * @param _capacity The initial capacity, rounded up to a power of two.
+     */
+    explicit WorkStealingDeque(int64_t _capacity = 256)
+    {
+        int64_t capacity = 1;
+        while (capacity < _capacity) capacity <<= 1;
+
+        m_buffers.push_back(std::make_unique<Buffer>(capacity));
+        m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+   public:
+    // Owner only: pushes an element at the bottom.
+    void push(T _value)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+        if (bottom - top > buffer->capacity - 1) buffer = grow(buffer, top, bottom);
+
+        buffer->store(bottom, _value);
+
+        // release, a thief reading the new bottom also sees the element
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only: pops the newest element, if any.
+    std::optional<T> pop() noexcept
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T value = buffer->load(bottom);
+
+        if (top == bottom)
+        {
+            // the last element, thieves may race for it
+            const bool won = m_top.compare_exchange_strong(
+                top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+            if (!won) return std::nullopt;
+        }
+
+        return value;
+    }
+
+    // Any thread: steals the oldest element, fails if it is empty or another thread won the race.
+    std::optional<T> steal() noexcept
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) return std::nullopt;
+
+        const T value = m_buffer.load(std::memory_order_acquire)->load(top);
+
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed))
+        {
+            return std::nullopt;
+        }
+
+        return value;
+    }
+
+    // Approximate when other threads push or steal concurrently.
+    [[nodiscard]] size_t size() const noexcept
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_relaxed);
+
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    [[nodiscard]] int64_t capacity() const noexcept
+    {
+        return m_buffer.load(std::memory_order_relaxed)->capacity;
+    }
+
+   private:
+    Buffer* grow(Buffer* _buffer, int64_t _top, int64_t _bottom)
+    {
+        auto grown = std::make_unique<Buffer>(_buffer->capacity * 2);
+
+        for (int64_t i = _top; i < _bottom; ++i) grown->store(i, _buffer->load(i));
+
+        Buffer* buffer = grown.get();
+        m_buffers.push_back(std::move(grown));
+        m_buffer.store(buffer, std::memory_order_release);
+
+        return buffer;
+    }
+};
+
+} // namespace exec
+} // namespace mosaic
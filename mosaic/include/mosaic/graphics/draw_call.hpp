@@ -1,6 +1,8 @@
 #pragma once
 
-#include <string>
+#include <array>
+#include <cstdint>
+#include <type_traits>
 
 #include "buffer.hpp"
 #include "shader.hpp"
@@ -12,54 +14,63 @@ namespace mosaic
 namespace graphics
 {
 
-enum class DrawCallType
+enum class DrawCallType : uint8_t
 {
     NonIndexed,
     Indexed,
     Instanced,
     IndexedInstanced,
-    Indirect
+    Indirect,
+    IndexedIndirectCount // up to maxDrawCount commands, their count read from countBuffer
 };
 
 using ResourceHandle = uint32_t;
 
+/**
+ * @brief One draw of a DrawQueue, plain data copied by the thousands every frame.
+ *
+ * The draws are recorded in ascending sortKey order: the caller packs the state that is the
+ * most expensive to change (pass, pipeline) in the high bits, then what to sort by inside it
+ * (material, depth).
+ */
 struct DrawCall
 {
-    DrawCallType type;
+    static constexpr uint32_t k_maxVertexBuffers = 4;
+    static constexpr uint32_t k_maxResources = 4;
 
-    ResourceHandle pipeline;
-    std::vector<ResourceHandle> vertexBuffers;
-    ResourceHandle indexBuffer;
-    ResourceHandle indirectBuffer;
+    uint64_t sortKey = 0;
 
-    uint32_t vertexCount;
-    uint32_t indexCount;
-    uint32_t instanceCount;
+    DrawCallType type = DrawCallType::NonIndexed;
+    uint8_t vertexBufferCount = 0; // the slots in use, from slot 0
 
-    uint32_t firstVertex;
-    uint32_t firstIndex;
-    uint32_t vertexOffset;
-    uint32_t firstInstance;
+    ResourceHandle pipeline = 0;
+    std::array<ResourceHandle, k_maxVertexBuffers> vertexBuffers = {};
+    ResourceHandle indexBuffer = 0;
+    ResourceHandle indirectBuffer = 0;
+    ResourceHandle countBuffer = 0;
 
-    uint64_t sortKey;
+    // Pushed to the shaders: the values of the BufferHandles, TextureHandles and SamplerHandles
+    // of the resource registry they read (e.g. the draw's uniforms and material)
+    std::array<uint32_t, k_maxResources> resources = {};
 
-    std::string debugName;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t instanceCount = 1;
 
-    DrawCall(const std::string& _debugName)
-        : type(DrawCallType::NonIndexed),
-          pipeline(0),
-          indexBuffer(0),
-          indirectBuffer(0),
-          vertexCount(0),
-          indexCount(0),
-          instanceCount(1),
-          firstVertex(0),
-          firstIndex(0),
-          vertexOffset(0),
-          firstInstance(0),
-          sortKey(0),
-          debugName(_debugName){};
+    uint32_t firstVertex = 0;
+    uint32_t firstIndex = 0;
+    uint32_t vertexOffset = 0;
+    uint32_t firstInstance = 0;
+    uint32_t maxDrawCount = 0;
+
+    [[nodiscard]] bool isIndexed() const noexcept
+    {
+        return type == DrawCallType::Indexed || type == DrawCallType::IndexedInstanced ||
+               type == DrawCallType::IndexedIndirectCount;
+    }
 };
 
+static_assert(std::is_trivially_copyable_v<DrawCall>, "DrawCall is copied with memcpy");
+
 } // namespace graphics
 } // namespace mosaic
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <pieces/memory/contiguous_allocator.hpp>
+
+#include "mosaic/defines.hpp"
+
+#include "draw_call.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief Records the commands of a DrawQueue on a backend command buffer; the queue only calls
+ * the binds when the state changes.
+ */
+template <typename Encoder>
+concept DrawCommandEncoder =
+    requires(Encoder& _encoder, const DrawCall& _call, ResourceHandle _handle, uint32_t _slot) {
+        _encoder.bindPipeline(_handle);
+        _encoder.bindVertexBuffer(_slot, _handle);
+        _encoder.bindIndexBuffer(_handle);
+        _encoder.draw(_call);
+    };
+
+struct DrawQueueStats
+{
+    uint32_t draws = 0;
+    uint32_t pipelineBinds = 0;
+    uint32_t vertexBufferBinds = 0;
+    uint32_t indexBufferBinds = 0;
+};
+
+/**
+ * @brief The draws of a frame: collected in a linear allocator, radix sorted by
+ * DrawCall::sortKey, then recorded with the redundant pipeline, vertex and index buffer binds
+ * filtered out.
+ *
+ * Grows by doubling when full, and keeps its memory across clear(), so a frame of as many
+ * draws as the previous one allocates nothing.
+ */
+class MOSAIC_API DrawQueue final
+{
+   public:
+    static constexpr size_t k_defaultCapacity = 1024;
+
+   private:
+    // Sorted instead of the draws themselves, a fraction of their size
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    static constexpr ResourceHandle k_unbound = std::numeric_limits<ResourceHandle>::max();
+
+    pieces::LinearAllocator<DrawCall> m_calls;
+    std::vector<SortEntry> m_entries;
+    std::vector<SortEntry> m_scratch;
+
+   public:
+    explicit DrawQueue(size_t _capacity = k_defaultCapacity);
+
+   public:
+    void submit(const DrawCall& _call)
+    {
+        DrawCall* slot = m_calls.allocate(1);
+        if (!slot) slot = grow();
+
+        *slot = _call;
+        m_entries.push_back({_call.sortKey, static_cast<uint32_t>(m_entries.size())});
+    }
+
+    /// Stable: the draws of equal keys keep their submission order.
+    void sort();
+
+    /**
+     * @brief Calls the encoder for every draw, in the order of the last sort() (the submission
+     * order if none), binding the state a draw needs only when it differs from the previous.
+     */
+    template <DrawCommandEncoder Encoder>
+    DrawQueueStats record(Encoder& _encoder) const
+    {
+        return record(_encoder, 0, m_entries.size());
+    }
+
+    /**
+     * @brief Same as above for _count draws of the order from _first, starting with nothing
+     * bound: the ranges can be recorded in parallel, each on its own command buffer.
+     */
+    template <DrawCommandEncoder Encoder>
+    DrawQueueStats record(Encoder& _encoder, size_t _first, size_t _count) const
+    {
+        DrawQueueStats stats;
+
+        ResourceHandle pipeline = k_unbound;
+        ResourceHandle indexBuffer = k_unbound;
+        std::array<ResourceHandle, DrawCall::k_maxVertexBuffers> vertexBuffers;
+        vertexBuffers.fill(k_unbound);
+
+        const DrawCall* calls = data();
+
+        const size_t last = std::min(_first + _count, m_entries.size());
+
+        for (size_t i = _first; i < last; ++i)
+        {
+            const SortEntry& entry = m_entries[i];
+            const DrawCall& call = calls[entry.index];
+
+            if (call.pipeline != pipeline)
+            {
+                _encoder.bindPipeline(call.pipeline);
+                pipeline = call.pipeline;
+                ++stats.pipelineBinds;
+            }
+
+            for (uint32_t slot = 0; slot < call.vertexBufferCount; ++slot)
+            {
+                if (call.vertexBuffers[slot] == vertexBuffers[slot]) continue;
+
+                _encoder.bindVertexBuffer(slot, call.vertexBuffers[slot]);
+                vertexBuffers[slot] = call.vertexBuffers[slot];
+                ++stats.vertexBufferBinds;
+            }
+
+            if (call.isIndexed() && call.indexBuffer != indexBuffer)
+            {
+                _encoder.bindIndexBuffer(call.indexBuffer);
+                indexBuffer = call.indexBuffer;
+                ++stats.indexBufferBinds;
+            }
+
+            _encoder.draw(call);
+            ++stats.draws;
+        }
+
+        return stats;
+    }
+
+    /**
+     * @brief A hash of the draws in the order record() takes them, field by field: the same
+     * draws recorded the same commands, e.g. the render bundle of a static draw set is replayed
+     * rather than encoded again. A change detector, not a content address: the handles it hashes
+     * are generational, a resource replaced changes them.
+     */
+    [[nodiscard]] uint64_t getHash() const noexcept;
+
+    /// Drops the draws, keeps the memory for the next frame.
+    void clear() noexcept;
+
+    [[nodiscard]] size_t size() const noexcept { return m_entries.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_entries.empty(); }
+    [[nodiscard]] size_t capacity() const noexcept { return m_calls.capacity(); }
+
+    /// The draws in submission order.
+    [[nodiscard]] std::span<const DrawCall> getCalls() const noexcept
+    {
+        return {data(), m_entries.size()};
+    }
+
+   private:
+    [[nodiscard]] const DrawCall* data() const noexcept
+    {
+        return reinterpret_cast<const DrawCall*>(m_calls.getBuffer());
+    }
+
+    // Doubles the capacity, moving the draws over, and returns the slot of the next one
+    DrawCall* grow();
+};
+
+} // namespace graphics
+} // namespace mosaic
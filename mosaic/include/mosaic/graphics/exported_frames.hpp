@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief The offscreen images of a headless context created with exportFrames, shared with
+ * another API or process (the viewport of the editor) that samples the frames where the GPU
+ * rendered them, with no readback. Each image comes as native handles the caller owns and hands
+ * over: file descriptors on Linux, NT handles on Windows (duplicated into the other process).
+ *
+ * The handshake of an image: every frame rendered into it signals `ready`, which the consumer
+ * waits for exactly once; when it no longer samples that frame (a newer one is shown) it signals
+ * `released`, which the next frame rendered into the image waits for. The consumer must keep up
+ * its side as long as the context lives, a frame waiting for a release never completes otherwise.
+ */
+struct ExportedFrames
+{
+    using NativeHandle = intptr_t;
+
+    struct Image
+    {
+        NativeHandle memory;    // a dedicated allocation, bound at offset 0
+        uint64_t memorySize;    // to import the memory with
+        NativeHandle ready;     // binary semaphores
+        NativeHandle released;
+    };
+
+    glm::uvec2 extent;
+    uint32_t format; // a VkFormat (R8G8B8A8_SRGB), optimal tiling, TRANSFER_SRC_OPTIMAL once ready
+    std::vector<Image> images;
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief Estimates when the GPU completes the frames in flight, from when the CPU submitted
+ * them and when they were seen completed, and how long the CPU takes to build a frame.
+ *
+ * In low-latency mode the next frame starts (samples input, simulates) that much later: its
+ * submission then reaches the GPU as it gets idle, instead of the frame waiting in the queue
+ * behind the ones in flight with input sampled a frame or more earlier.
+ */
+class MOSAIC_API FramePacer final
+{
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint32_t k_maxFramesInFlight = 8;
+
+   private:
+    std::array<Clock::time_point, k_maxFramesInFlight> m_submits = {}; // of the frames in flight
+    uint32_t m_firstPending = 0;
+    uint32_t m_pendingCount = 0;
+
+    Clock::time_point m_frameStart = {};
+    Clock::time_point m_lastCompletion = {};
+    uint32_t m_completedCount = 0;
+
+    // smoothed, the GPU time counted from when a frame could start: its submission, or the
+    // completion of the one before when it waited in the queue
+    Clock::duration m_cpuTime = {};
+    Clock::duration m_gpuTime = {};
+
+   public:
+    FramePacer() = default;
+
+   public:
+    /// The CPU starts building a frame.
+    void beginFrame(Clock::time_point _now) noexcept;
+
+    /// The frame begun last was submitted.
+    void submitFrame(Clock::time_point _now) noexcept;
+
+    /// The GPU completed the oldest frame in flight, by _time (when it was seen completed).
+    void completeFrame(Clock::time_point _time) noexcept;
+
+    /**
+     * @brief How much later than _now the next frame should start for its submission to reach
+     * the GPU as it completes the frames in flight, zero until both times were measured.
+     */
+    [[nodiscard]] Clock::duration getDelay(Clock::time_point _now) const noexcept;
+
+    [[nodiscard]] uint32_t getPendingCount() const noexcept { return m_pendingCount; }
+    [[nodiscard]] Clock::duration getCpuTime() const noexcept { return m_cpuTime; }
+    [[nodiscard]] Clock::duration getGpuTime() const noexcept { return m_gpuTime; }
+};
+
+} // namespace graphics
+} // namespace mosaic
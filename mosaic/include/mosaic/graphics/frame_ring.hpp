@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief A sub-allocation of a FrameRing: where to write on the CPU, and the offset in the
+ * backend buffer to bind it at (a dynamic uniform or storage offset, a vertex buffer offset).
+ */
+struct FrameAllocation
+{
+    std::byte* data = nullptr;
+    size_t offset = 0;
+    size_t size = 0;
+
+    [[nodiscard]] explicit operator bool() const noexcept { return data != nullptr; }
+};
+
+/**
+ * @brief The per-frame data (uniforms, dynamic geometry) of the frames in flight, bump allocated
+ * in one buffer split into a region per frame.
+ *
+ * A region is reset by beginFrame() once the GPU is done with the frame that used it last (its
+ * fence signaled), so thousands of objects a frame cost no buffer allocation. The memory is the
+ * mapped backend buffer, or a copy of it the backend uploads at the end of the frame.
+ */
+class MOSAIC_API FrameRing final
+{
+   private:
+    std::byte* m_memory = nullptr;
+    size_t m_frameSize = 0;
+    uint32_t m_frameCount = 0;
+
+    size_t m_frameOffset = 0;
+    std::atomic<size_t> m_head{0}; // in the region of the frame
+    size_t m_peak = 0;
+
+   public:
+    FrameRing() = default;
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+   public:
+    /// _memory spans _frameCount regions of _frameSize bytes, a multiple of every alignment the
+    /// allocations ask for.
+    void reset(std::byte* _memory, size_t _frameSize, uint32_t _frameCount) noexcept;
+
+    /// Starts allocating in the region of _frame, whose previous contents the GPU no longer reads.
+    void beginFrame(uint32_t _frame) noexcept;
+
+    /**
+     * @brief _size bytes at an offset multiple of _alignment (a power of two), or an empty
+     * allocation when the region of the frame is full. Safe to call from several threads.
+     */
+    [[nodiscard]] FrameAllocation allocate(size_t _size, size_t _alignment = 16) noexcept;
+
+    /// Copies _value into a new allocation.
+    template <typename T>
+    [[nodiscard]] FrameAllocation push(const T& _value, size_t _alignment = alignof(T)) noexcept
+    {
+        FrameAllocation allocation = allocate(sizeof(T), _alignment);
+        if (allocation) std::memcpy(allocation.data, &_value, sizeof(T));
+
+        return allocation;
+    }
+
+    /// Offset and bytes allocated of the region of the current frame, to flush or upload.
+    [[nodiscard]] size_t getFrameOffset() const noexcept { return m_frameOffset; }
+    [[nodiscard]] size_t getUsed() const noexcept
+    {
+        return std::min(m_head.load(std::memory_order_relaxed), m_frameSize);
+    }
+
+    [[nodiscard]] size_t getFrameSize() const noexcept { return m_frameSize; }
+    [[nodiscard]] uint32_t getFrameCount() const noexcept { return m_frameCount; }
+
+    /// The most bytes a frame used, to size the regions.
+    [[nodiscard]] size_t getPeakUsage() const noexcept { return m_peak; }
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+
+#include "gpu_culling.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// World space bounding spheres, a column per field (e.g. the columns of an ECS chunk).
+struct SphereColumns
+{
+    std::span<const float> centerX;
+    std::span<const float> centerY;
+    std::span<const float> centerZ;
+    std::span<const float> radius;
+
+    [[nodiscard]] size_t size() const noexcept { return radius.size(); }
+};
+
+// World space axis-aligned boxes as their center and half extents, a column per field.
+struct AabbColumns
+{
+    std::span<const float> centerX;
+    std::span<const float> centerY;
+    std::span<const float> centerZ;
+    std::span<const float> extentX;
+    std::span<const float> extentY;
+    std::span<const float> extentZ;
+
+    [[nodiscard]] size_t size() const noexcept { return extentX.size(); }
+};
+
+// The objects a task of the parallel culls tests, its output written in place.
+inline constexpr size_t k_cullGrainSize = 4096;
+
+/**
+ * @brief The CPU culling of the objects without a GPU-driven path (WebGPU without
+ * indirect-count, the fallback of GpuCulling): writes the indices of the objects that are not
+ * outside a plane of _frustum, plus _firstIndex, to _visible in ascending order and returns
+ * their count. _visible holds up to the object count (every column has at least that many).
+ *
+ * The kernels test 4 (SSE2, NEON), 8 (AVX2) or 16 (AVX-512F) objects per instruction, the
+ * widest the CPU supports (getCullingIsa()).
+ */
+MOSAIC_API uint32_t cullSpheres(const Frustum& _frustum, const SphereColumns& _spheres,
+                                std::span<uint32_t> _visible, uint32_t _firstIndex = 0) noexcept;
+
+// Same as above for boxes, tested against each plane at their farthest corner along its normal.
+MOSAIC_API uint32_t cullAabbs(const Frustum& _frustum, const AabbColumns& _boxes,
+                              std::span<uint32_t> _visible, uint32_t _firstIndex = 0) noexcept;
+
+/**
+ * @brief Same as above on _pool, a range of _grainSize objects per task: each range writes its
+ * visible indices in place, then the ranges are compacted. The output is that of cullSpheres().
+ */
+MOSAIC_API uint32_t cullSpheres(exec::ThreadPool& _pool, const Frustum& _frustum,
+                                const SphereColumns& _spheres, std::span<uint32_t> _visible,
+                                uint32_t _firstIndex = 0, size_t _grainSize = k_cullGrainSize);
+
+MOSAIC_API uint32_t cullAabbs(exec::ThreadPool& _pool, const Frustum& _frustum,
+                              const AabbColumns& _boxes, std::span<uint32_t> _visible,
+                              uint32_t _firstIndex = 0, size_t _grainSize = k_cullGrainSize);
+
+// The instruction set the culls run with, selected once from the CPU: "AVX-512F", "AVX2"...
+[[nodiscard]] MOSAIC_API const char* getCullingIsa() noexcept;
+
+} // namespace graphics
+} // namespace mosaic
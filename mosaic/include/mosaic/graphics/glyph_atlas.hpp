@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/task_future.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+class ThreadPool;
+} // namespace exec
+
+namespace graphics
+{
+
+// The signed distance field of a glyph: 8 bits a texel, its edge at 128, _spread pixels each way
+// from 0 to 255.
+struct GlyphBitmap
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    float left = 0.0f; // of the bitmap from the pen, in pixels, +x right
+    float top = 0.0f;  // of the bitmap from the baseline, in pixels, +y down
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * @brief The glyphs of a font, for a GlyphAtlas: the metrics, read on the calling thread, and the
+ * distance fields, rasterized on the workers (const members are called concurrently).
+ */
+class MOSAIC_API GlyphSource
+{
+   public:
+    virtual ~GlyphSource() = default;
+
+    // In pixels at _pixelHeight: the baseline below the top of a line, and the line spacing.
+    [[nodiscard]] virtual float getAscent(float _pixelHeight) const = 0;
+    [[nodiscard]] virtual float getLineHeight(float _pixelHeight) const = 0;
+
+    [[nodiscard]] virtual float getAdvance(char32_t _codepoint, float _pixelHeight) const = 0;
+    [[nodiscard]] virtual float getKerning(char32_t _left, char32_t _right,
+                                           float _pixelHeight) const
+    {
+        return 0.0f;
+    }
+
+    // Nothing for a glyph without an outline (a space): it still advances.
+    [[nodiscard]] virtual std::optional<GlyphBitmap> rasterize(char32_t _codepoint,
+                                                               float _pixelHeight,
+                                                               uint32_t _spread) const = 0;
+};
+
+/**
+ * @brief A TrueType/OpenType font read by stb_truetype, its distance fields from the outlines
+ * (stbtt_GetGlyphSDF()). The file stays in memory, the glyphs are read from it.
+ */
+class MOSAIC_API Font final : public GlyphSource
+{
+   private:
+    struct Data;
+
+    std::unique_ptr<Data> m_data;
+
+    explicit Font(std::unique_ptr<Data> _data);
+
+   public:
+    ~Font() override;
+
+    /// The font _index of a TrueType file or collection.
+    static pieces::Result<std::shared_ptr<Font>, std::string> load(std::vector<uint8_t> _file,
+                                                                   uint32_t _index = 0);
+
+   public:
+    [[nodiscard]] float getAscent(float _pixelHeight) const override;
+    [[nodiscard]] float getLineHeight(float _pixelHeight) const override;
+    [[nodiscard]] float getAdvance(char32_t _codepoint, float _pixelHeight) const override;
+    [[nodiscard]] float getKerning(char32_t _left, char32_t _right,
+                                   float _pixelHeight) const override;
+    [[nodiscard]] std::optional<GlyphBitmap> rasterize(char32_t _codepoint, float _pixelHeight,
+                                                       uint32_t _spread) const override;
+};
+
+using FontId = uint32_t;
+
+struct GlyphAtlasSettings
+{
+    uint32_t extent = 1024;    // of a layer, square
+    uint32_t layers = 4;       // of the array texture
+    float pixelHeight = 32.0f; // rasterized at, drawn at any size from the distance fields
+    uint32_t spread = 4;       // of the distance fields, in pixels at pixelHeight
+    uint32_t maxPending = 64;  // glyphs rasterizing on the workers at once
+};
+
+// A glyph of a GlyphAtlas, its sizes in pixels at GlyphAtlasSettings::pixelHeight.
+struct AtlasGlyph
+{
+    std::array<float, 4> uv = {}; // u0, v0, u1, v1 in its layer
+    uint32_t layer = 0;
+    float left = 0.0f;
+    float top = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float advance = 0.0f;
+    bool resident = false; // its field in the atlas: drawn, otherwise only advanced over
+};
+
+// The texels of a glyph new in the atlas, GlyphAtlas::getUploadData() from offset, tightly packed.
+struct GlyphUpload
+{
+    uint32_t layer = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t offset = 0;
+};
+
+/**
+ * @brief The distance fields of the glyphs a frame draws, packed in the layers of one R8 array
+ * texture: the text of every font and size is drawn from the same texture, with no texture
+ * change between draws.
+ *
+ * A glyph is added on its first find(), with its advance, so the text is laid out the same
+ * before and after its field is ready. The fields are rasterized by update() (on the workers of a
+ * ThreadPool when given, background tasks), and packed in shelves as they complete; each one
+ * rasterized is a GlyphUpload for the backend to copy to the texture. Once every layer is full
+ * the glyphs left are only advanced over (a warning, once).
+ *
+ * Not thread-safe: the main thread finds, updates and uploads.
+ */
+class MOSAIC_API GlyphAtlas final
+{
+   private:
+    struct Shelf
+    {
+        uint32_t y;
+        uint32_t height;
+        uint32_t x; // the first free column
+    };
+
+    struct Pending
+    {
+        FontId font;
+        char32_t codepoint;
+        std::optional<exec::TaskFuture<std::optional<GlyphBitmap>>> future;
+        bool done;
+    };
+
+    GlyphAtlasSettings m_settings;
+    std::vector<std::shared_ptr<const GlyphSource>> m_fonts;
+    std::unordered_map<uint64_t, AtlasGlyph> m_glyphs;
+    std::vector<Pending> m_pending; // requested, those with a future rasterizing
+
+    std::vector<std::vector<Shelf>> m_shelves; // of each layer
+    bool m_full = false; // warned of
+
+    std::vector<GlyphUpload> m_uploads;
+    std::vector<uint8_t> m_uploadData;
+
+   public:
+    /// @throws std::invalid_argument if a layer cannot hold a glyph of the settings.
+    explicit GlyphAtlas(const GlyphAtlasSettings& _settings = {});
+    ~GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+   public:
+    FontId addFont(std::shared_ptr<const GlyphSource> _font);
+
+    /// The glyph of _codepoint, requested if new (its field rasterized by a later update()).
+    const AtlasGlyph& find(FontId _font, char32_t _codepoint);
+
+    /**
+     * @brief Once a frame: starts rasterizing the glyphs requested (all at once, on this thread,
+     * without _pool) and packs those completed, adding their uploads. Returns the glyphs made
+     * resident.
+     */
+    uint32_t update(exec::ThreadPool* _pool = nullptr);
+
+    /// Waits for the glyphs rasterizing, e.g. before a screenshot.
+    void flush(exec::ThreadPool* _pool = nullptr);
+
+    [[nodiscard]] std::span<const GlyphUpload> getUploads() const noexcept { return m_uploads; }
+    [[nodiscard]] std::span<const uint8_t> getUploadData() const noexcept
+    {
+        return m_uploadData;
+    }
+
+    /// The backend copied the uploads to the texture.
+    void clearUploads() noexcept;
+
+    [[nodiscard]] const GlyphSource& getFont(FontId _font) const { return *m_fonts[_font]; }
+    [[nodiscard]] const GlyphAtlasSettings& getSettings() const noexcept { return m_settings; }
+    [[nodiscard]] size_t getGlyphCount() const noexcept { return m_glyphs.size(); }
+    [[nodiscard]] size_t getPendingCount() const noexcept { return m_pending.size(); }
+
+   private:
+    // False if it has no field (a space, a failure) or no room
+    bool place(const Pending& _pending, std::optional<GlyphBitmap> _bitmap);
+    [[nodiscard]] bool allocate(uint32_t _width, uint32_t _height, uint32_t& _layer,
+                                uint32_t& _x, uint32_t& _y);
+};
+
+} // namespace graphics
+} // namespace mosaic
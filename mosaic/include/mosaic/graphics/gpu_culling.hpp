@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+class OcclusionBuffer;
+
+// The matrices are column-major, as glm stores them (&matrix[0][0]).
+using Matrix4 = std::span<const float, 16>;
+
+struct BoundingSphere
+{
+    std::array<float, 3> center = {};
+    float radius = 0.0f;
+};
+
+/**
+ * @brief An instance of the GPU-driven path: its world bounds, the draw (mesh) it is an instance
+ * of, and the index the vertex shader reads its data at. std430, as the culling shaders read it.
+ */
+struct CullInstance
+{
+    BoundingSphere bounds;
+    uint32_t drawIndex = 0;
+    uint32_t instanceIndex = 0;
+    uint32_t padding[2] = {};
+};
+
+static_assert(sizeof(CullInstance) == 32, "CullInstance is read by the culling shaders");
+
+// The mesh of a draw, instanced up to maxInstances times a frame.
+struct CullDraw
+{
+    uint32_t indexCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    uint32_t maxInstances = 0;
+};
+
+static_assert(sizeof(CullDraw) == 16, "CullDraw is read by the culling shaders");
+
+// The layout of VkDrawIndexedIndirectCommand (and of a WebGPU drawIndexedIndirect).
+struct IndexedIndirectCommand
+{
+    uint32_t indexCount = 0;
+    uint32_t instanceCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    uint32_t firstInstance = 0;
+};
+
+static_assert(sizeof(IndexedIndirectCommand) == 20, "IndexedIndirectCommand is read by the GPU");
+
+/**
+ * @brief The parameters of the culling passes of a frame (std430). The occlusion test reads a
+ * depth pyramid of the previous frame: reverse-Z (1 at the near plane), each mip the farthest
+ * depth of the texels it covers.
+ *
+ * Two-phase, the early pass draws the instances visible the frame before (frustum only), the
+ * pyramid is built from the depth they wrote, then the late pass tests every instance against
+ * it and draws those the early one did not: the disoccluded ones. The late pass records which
+ * instances are visible for the next frame.
+ */
+struct CullUniforms
+{
+    static constexpr uint32_t k_occlusion = 1u << 0;
+    static constexpr uint32_t k_earlyPhase = 1u << 1;
+    static constexpr uint32_t k_latePhase = 1u << 2;
+
+    std::array<std::array<float, 4>, 6> frustum = {}; // Frustum::planes
+    std::array<float, 16> view = {};                   // for the occlusion test
+    float p00 = 0.0f;
+    float p11 = 0.0f;
+    float zNear = 0.0f;
+    float padding0 = 0.0f;
+    float pyramidWidth = 0.0f;
+    float pyramidHeight = 0.0f;
+    uint32_t instanceCount = 0;
+    uint32_t drawCount = 0;
+    uint32_t flags = 0;
+    uint32_t padding1[3] = {};
+};
+
+static_assert(sizeof(CullUniforms) == 208, "CullUniforms is read by the culling shaders");
+
+// Normalized world space planes (a, b, c, d), a point p inside all of them: dot(abc, p) + d >= 0.
+struct Frustum
+{
+    std::array<std::array<float, 4>, 6> planes = {}; // left, right, bottom, top, near, far
+};
+
+/**
+ * @brief The planes of a view-projection matrix to a [0, 1] depth clip space (Vulkan, WebGPU),
+ * normalized so the sphere test is a signed distance (Gribb and Hartmann).
+ */
+[[nodiscard]] MOSAIC_API Frustum extractFrustum(Matrix4 _viewProjection) noexcept;
+
+[[nodiscard]] MOSAIC_API bool isSphereInFrustum(const Frustum& _frustum,
+                                                const BoundingSphere& _sphere) noexcept;
+
+// The bounds of _local through _world, its radius scaled by the largest axis scale.
+[[nodiscard]] MOSAIC_API BoundingSphere transformSphere(Matrix4 _world,
+                                                        const BoundingSphere& _local) noexcept;
+
+/**
+ * @brief The uv rectangle (min x, min y, max x, max y) a view space sphere covers through a
+ * perspective projection of _p00, _p11 (projection[0][0], [1][1]), the view looking down -Z as
+ * glm's; empty when the sphere crosses the near plane (2D polar bounds, Mara and McGuire).
+ *
+ * The occlusion test of the culling shader samples the depth pyramid at the mip the rectangle
+ * covers a texel of.
+ */
+[[nodiscard]] MOSAIC_API std::optional<std::array<float, 4>> projectSphere(
+    const BoundingSphere& _viewSphere, float _zNear, float _p00, float _p11) noexcept;
+
+/**
+ * @brief The commands before culling, one per draw: no instance yet, and firstInstance the start
+ * of the range of the visible instance indices of the draw. Returns the size of that buffer.
+ */
+MOSAIC_API uint32_t buildIndirectCommands(std::span<const CullDraw> _draws,
+                                          std::span<IndexedIndirectCommand> _commands) noexcept;
+
+/**
+ * @brief The reference of the culling and compaction compute passes, and the path of the
+ * backends without draw-indirect-count: appends the instances in the frustum to the
+ * _visibleInstances range of their draw (_commands, built by buildIndirectCommands()), then
+ * copies the commands of the draws with a visible instance to _compacted. Returns their count.
+ *
+ * The order of the instances of a draw is that of _instances; on the GPU it is arbitrary. With
+ * _occlusion, the instances in the frustum it occludes are culled too (the software fallback of
+ * the occlusion pass).
+ */
+MOSAIC_API uint32_t cullInstances(const Frustum& _frustum, std::span<const CullInstance> _instances,
+                                  std::span<const CullDraw> _draws,
+                                  std::span<IndexedIndirectCommand> _commands,
+                                  std::span<uint32_t> _visibleInstances,
+                                  std::span<IndexedIndirectCommand> _compacted,
+                                  const OcclusionBuffer* _occlusion = nullptr) noexcept;
+
+} // namespace graphics
+} // namespace mosaic
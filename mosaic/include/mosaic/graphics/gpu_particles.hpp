@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The emitters a frame of the GPU particles updates, in one vkCmdUpdateBuffer() (64 KiB at most).
+inline constexpr uint32_t k_maxParticleEmitters = 512;
+
+// The quantized camera distance the particles are sorted by, back to front: two 8-bit passes.
+inline constexpr uint32_t k_particleSortBits = 16;
+inline constexpr uint32_t k_particleSortRadixBits = 8;
+
+// The particles a workgroup of the radix sort passes histograms and scatters.
+inline constexpr uint32_t k_particleSortBlockSize = 1024;
+
+// A live particle of the simulation (std430), in a pool the emitters take free slots from.
+struct GpuParticle
+{
+    std::array<float, 3> position = {};
+    float age = 0.0f;
+    std::array<float, 3> velocity = {};
+    float lifetime = 0.0f;
+    std::array<float, 4> color = {};
+    float size = 0.0f;
+    float drag = 0.0f;
+    uint32_t emitter = 0;
+    uint32_t padding = 0;
+};
+
+static_assert(sizeof(GpuParticle) == 64, "GpuParticle is read by the particle shaders");
+
+/**
+ * @brief An emitter of a frame (std430): where its particles spawn, with what, and which range of
+ * the spawns of the frame is its own (firstSpawn, spawnCount), one particle per emit invocation.
+ */
+struct ParticleEmitter
+{
+    std::array<float, 3> position = {};
+    float radius = 0.0f; // of the sphere the particles spawn in
+    std::array<float, 3> velocity = {};
+    float velocityJitter = 0.0f; // the radius of a random velocity added to each
+    std::array<float, 4> color = {1.0f, 1.0f, 1.0f, 1.0f};
+    float size = 0.1f;
+    float lifetime = 1.0f;
+    float lifetimeJitter = 0.0f; // the lifetime of a particle varies by up to this much
+    float drag = 0.0f;
+    uint32_t firstSpawn = 0;
+    uint32_t spawnCount = 0;
+    uint32_t seed = 0;
+    uint32_t padding = 0;
+};
+
+static_assert(sizeof(ParticleEmitter) == 80, "ParticleEmitter is read by the particle shaders");
+
+// The parameters of a frame of the particle passes (std430).
+struct ParticleUniforms
+{
+    std::array<float, 16> viewProjection = {}; // column-major, as glm stores it
+    std::array<float, 3> cameraPosition = {};
+    float sortDistance = 100.0f; // the distance the sort keys span
+    std::array<float, 3> cameraRight = {1.0f, 0.0f, 0.0f}; // the billboard axes, world space
+    float padding0 = 0.0f;
+    std::array<float, 3> cameraUp = {0.0f, 1.0f, 0.0f};
+    float padding1 = 0.0f;
+    std::array<float, 3> gravity = {0.0f, -9.81f, 0.0f};
+    float deltaTime = 0.0f;
+    uint32_t emitterCount = 0;
+    uint32_t spawnCount = 0; // of every emitter
+    uint32_t frame = 0;
+    uint32_t capacity = 0;
+};
+
+static_assert(sizeof(ParticleUniforms) == 144, "ParticleUniforms is read by the particle shaders");
+
+/**
+ * @brief The counters of the particle pool (std430), written by the shaders only: the free slots,
+ * the particles alive in each of the ping-ponged lists, and the indirect arguments the passes
+ * after the emission and the draw read.
+ */
+struct ParticleCounters
+{
+    uint32_t deadCount = 0;
+    std::array<uint32_t, 2> aliveCount = {};
+    uint32_t sortBlocks = 0;
+    std::array<uint32_t, 3> simulateArguments = {}; // VkDispatchIndirectCommand
+    uint32_t padding0 = 0;
+    std::array<uint32_t, 3> sortArguments = {}; // VkDispatchIndirectCommand
+    uint32_t padding1 = 0;
+    std::array<uint32_t, 4> drawArguments = {}; // VkDrawIndirectCommand, a quad per particle
+};
+
+static_assert(sizeof(ParticleCounters) == 64, "ParticleCounters is read by the particle shaders");
+static_assert(offsetof(ParticleCounters, simulateArguments) == 16 &&
+                  offsetof(ParticleCounters, sortArguments) == 32 &&
+                  offsetof(ParticleCounters, drawArguments) == 48,
+              "the indirect arguments are read at these offsets");
+
+/**
+ * @brief The particles an emitter of _rate per second spawns over _deltaTime: the whole part of
+ * what it owes, the fraction carried over in _carry so a slow emitter still spawns at its rate.
+ */
+[[nodiscard]] MOSAIC_API uint32_t getParticleSpawnCount(float _rate, float _deltaTime,
+                                                        float& _carry) noexcept;
+
+/**
+ * @brief The key the particles are sorted by, ascending: the farthest from the camera first, for
+ * back to front blending; k_particleSortBits of _distance over _sortDistance, clamped.
+ * particles_common.glsl computes the same.
+ */
+[[nodiscard]] MOSAIC_API uint32_t getParticleSortKey(float _distance,
+                                                     float _sortDistance) noexcept;
+
+} // namespace graphics
+} // namespace mosaic
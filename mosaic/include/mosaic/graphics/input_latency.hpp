@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief Measures the input-to-present latency of the frames: each frame is tagged with the
+ * oldest input it consumed, and the time from that input to the frame reaching the display makes
+ * a sample. The percentiles are those of the last k_sampleCount samples.
+ *
+ * The input not consumed by a frame (one skipped, minimized) carries over to the next one; the
+ * frames without input are not measured.
+ *
+ * The present time is what the backend measures best: the frame seen displayed where the
+ * presentation can be waited for (VK_KHR_present_wait), its completion by the GPU otherwise.
+ */
+class MOSAIC_API InputLatency final
+{
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint32_t k_maxPendingFrames = 16;
+    static constexpr uint32_t k_sampleCount = 128;
+
+    struct Percentiles
+    {
+        Clock::duration p50 = {};
+        Clock::duration p95 = {};
+        Clock::duration p99 = {};
+    };
+
+   private:
+    struct PendingFrame
+    {
+        uint64_t frame;
+        Clock::time_point input;
+    };
+
+    // Submitted with input, not presented yet, oldest first
+    std::array<PendingFrame, k_maxPendingFrames> m_pending = {};
+    uint32_t m_firstPending = 0;
+    uint32_t m_pendingCount = 0;
+
+    std::optional<Clock::time_point> m_input; // the oldest of the frame being built
+
+    std::array<Clock::duration, k_sampleCount> m_samples = {};
+    uint32_t m_nextSample = 0;
+    uint32_t m_sampleCount = 0;
+    uint64_t m_measuredCount = 0;
+
+    Percentiles m_percentiles = {};
+
+   public:
+    InputLatency() = default;
+
+   public:
+    /// The next frame submitted consumes input that happened at _input.
+    void consumeInput(Clock::time_point _input) noexcept;
+
+    /// The frame built was submitted as _frame, a strictly increasing id, tagged with its input.
+    void submitFrame(uint64_t _frame) noexcept;
+
+    /// The frames up to _frame were presented, by _time: those tagged make samples.
+    void presentFrame(uint64_t _frame, Clock::time_point _time) noexcept;
+
+    /// The frames pending cannot be timed (their swapchain was replaced), they are forgotten.
+    void discardFrames() noexcept;
+
+    /// The oldest frame tagged and not presented yet, the next one to wait for.
+    [[nodiscard]] std::optional<uint64_t> getPendingFrame() const noexcept;
+
+    [[nodiscard]] uint32_t getPendingCount() const noexcept { return m_pendingCount; }
+    [[nodiscard]] uint32_t getSampleCount() const noexcept { return m_sampleCount; }
+    // Every sample so far, to tell whether the percentiles changed
+    [[nodiscard]] uint64_t getMeasuredCount() const noexcept { return m_measuredCount; }
+
+    /// Those of the samples in the window, zero until the first one.
+    [[nodiscard]] const Percentiles& getPercentiles() const noexcept { return m_percentiles; }
+
+   private:
+    void updatePercentiles() noexcept;
+};
+
+} // namespace graphics
+} // namespace mosaic
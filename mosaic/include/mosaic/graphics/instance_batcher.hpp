@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/tools/logger.hpp"
+
+#include "draw_call.hpp"
+#include "draw_queue.hpp"
+#include "frame_ring.hpp"
+#include "gpu_culling.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The per-instance data of a batched draw, std430: the vertex shader reads it at
+// instances[gl_InstanceIndex] in the buffer of DrawCall::resources[k_instanceResource].
+struct InstanceData
+{
+    std::array<float, 16> world = {}; // column-major
+};
+
+static_assert(sizeof(InstanceData) == 64, "InstanceData is read by the vertex shaders");
+
+// The instances of one mesh, LOD and material, a range of InstanceBatcher::getInstances().
+struct InstanceBatch
+{
+    uint32_t mesh = 0;
+    uint32_t material = 0;
+    uint32_t firstInstance = 0;
+    uint32_t instanceCount = 0;
+    uint8_t lod = 0; // a mesh LOD or k_impostorTier (lod_selection.hpp)
+};
+
+/**
+ * @brief Groups the instances of a frame by mesh, LOD and material, so each group costs one
+ * DrawCallType::IndexedInstanced draw.
+ *
+ * The instances are added in any order and build() lays them out contiguously, a range per
+ * batch, the batches in ascending (mesh, LOD, material) order and the instances of a batch in the
+ * order they were added: the same scene always gives the same draws. emit() copies them into
+ * the frame ring in one allocation, so a scene that did not change can be emitted again every
+ * frame without being rebuilt.
+ */
+class MOSAIC_API InstanceBatcher final
+{
+   public:
+    // The slot of DrawCall::resources emit() writes the handle of the instance buffer to.
+    static constexpr uint32_t k_instanceResource = 0;
+
+   private:
+    struct Pending
+    {
+        uint64_t key;
+        InstanceData data;
+    };
+
+    std::vector<Pending> m_pending;
+    std::vector<InstanceData> m_instances;
+    std::vector<InstanceBatch> m_batches;
+
+   public:
+    InstanceBatcher() = default;
+
+   public:
+    // The material ids of the batches have 24 bits.
+    static constexpr uint32_t k_maxMaterial = (1u << 24) - 1;
+
+    void add(uint32_t _mesh, uint32_t _material, Matrix4 _world)
+    {
+        add(_mesh, 0, _material, _world);
+    }
+
+    /// An instance of LOD _lod of _mesh, the tier LodSelector::getTier() gave it.
+    void add(uint32_t _mesh, uint8_t _lod, uint32_t _material, Matrix4 _world)
+    {
+        Pending& pending = m_pending.emplace_back();
+        pending.key = (static_cast<uint64_t>(_mesh) << 32) | (static_cast<uint64_t>(_lod) << 24) |
+                      (_material & k_maxMaterial);
+        std::memcpy(pending.data.world.data(), _world.data(), sizeof(pending.data.world));
+    }
+
+    /// Groups the instances added since the last build(), replacing the batches.
+    void build();
+
+    /// Drops the instances, added and built, keeps the memory.
+    void clear() noexcept;
+
+    /**
+     * @brief Copies the instances into _ring and submits a draw per batch to _queue, completed
+     * by _resolve(const InstanceBatch&) -> std::optional<DrawCall> with the mesh (pipeline,
+     * buffers, the index range of the LOD, or the billboard of the impostor) and material; a
+     * batch it returns no draw for is skipped.
+     *
+     * The draws are indexed instanced with the instance count of their batch, firstInstance the
+     * index of its first instance in the buffer of _instanceBuffer (the handle of the ring's
+     * buffer in the resource registry). Returns the number of draws, none if the ring is full.
+     */
+    template <typename Resolve>
+        requires std::is_invocable_r_v<std::optional<DrawCall>, Resolve, const InstanceBatch&>
+    uint32_t emit(FrameRing& _ring, DrawQueue& _queue, uint32_t _instanceBuffer,
+                  Resolve&& _resolve) const
+    {
+        if (m_batches.empty()) return 0;
+
+        const size_t size = m_instances.size() * sizeof(InstanceData);
+
+        // aligned to an instance, the offset is an index in the buffer
+        const FrameAllocation allocation = _ring.allocate(size, sizeof(InstanceData));
+        if (!allocation)
+        {
+            MOSAIC_ERROR("The frame ring is out of memory for {} instances", m_instances.size());
+            return 0;
+        }
+
+        std::memcpy(allocation.data, m_instances.data(), size);
+
+        const uint32_t base = static_cast<uint32_t>(allocation.offset / sizeof(InstanceData));
+
+        uint32_t draws = 0;
+        for (const InstanceBatch& batch : m_batches)
+        {
+            std::optional<DrawCall> call = _resolve(batch);
+            if (!call) continue;
+
+            call->type = DrawCallType::IndexedInstanced;
+            call->instanceCount = batch.instanceCount;
+            call->firstInstance = base + batch.firstInstance;
+            call->resources[k_instanceResource] = _instanceBuffer;
+
+            _queue.submit(*call);
+            ++draws;
+        }
+
+        return draws;
+    }
+
+    [[nodiscard]] std::span<const InstanceBatch> getBatches() const noexcept { return m_batches; }
+    [[nodiscard]] std::span<const InstanceData> getInstances() const noexcept
+    {
+        return m_instances;
+    }
+
+    /// The instances added since the last build().
+    [[nodiscard]] size_t getPendingCount() const noexcept { return m_pending.size(); }
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+
+#include "texture.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// How the mips of a KTX2 file are stored
+enum class Ktx2Encoding : uint8_t
+{
+    Native, // in a GPU format (vkFormat), uploaded as they are
+    ETC1S,  // Basis Universal, BasisLZ supercompressed: small, transcoded (to ETC2, BCn...)
+    UASTC   // Basis Universal: higher quality, transcoded (to ASTC, BC7...)
+};
+
+// A level of a KTX2 file, in the bytes of the file
+struct Ktx2Level
+{
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+// What the header, level index and data format descriptor of a KTX2 file say
+struct Ktx2Info
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 0;
+    Ktx2Encoding encoding = Ktx2Encoding::Native;
+    std::optional<TextureFormat> format; // of a Native file, none if not a format of the engine
+    uint32_t supercompression = 0;       // 0 none, 1 BasisLZ, 2 Zstandard, 3 zlib
+    bool srgb = false;
+    bool alpha = false;
+    std::vector<Ktx2Level> levels; // level 0 the largest
+};
+
+[[nodiscard]] MOSAIC_API bool isKtx2(std::span<const uint8_t> _file) noexcept;
+
+// 2D textures only: no array layers, cube faces or depth.
+MOSAIC_API pieces::Result<Ktx2Info, std::string> parseKtx2(std::span<const uint8_t> _file);
+
+/**
+ * @brief The format a Basis Universal file is best transcoded to among those the device samples:
+ * ASTC 4x4, then BC7, then ETC2, then BC3 (BC1 without alpha), RGBA8 when none is.
+ */
+[[nodiscard]] MOSAIC_API TextureFormat chooseTranscodeFormat(
+    std::span<const TextureFormat> _supported, bool _alpha) noexcept;
+
+/**
+ * @brief The mips from _firstMip on of a KTX2 file: copied for a native one (in a format of
+ * _supported, if not empty), transcoded to chooseTranscodeFormat() for a Basis Universal one,
+ * its levels in parallel on the exec::ThreadPool.
+ *
+ * Basis Universal needs the basisu transcoder (MOSAIC_HAS_BASISU), an error without. Zstandard
+ * and zlib supercompressed native files are not supported.
+ */
+MOSAIC_API pieces::Result<TextureMipChain, std::string> decodeKtx2(
+    std::span<const uint8_t> _file, uint32_t _firstMip, std::span<const TextureFormat> _supported);
+
+// What decodeKtx2() gives for the file: the format, its extent and mips
+MOSAIC_API pieces::Result<TextureDescription, std::string> readKtx2Description(
+    std::span<const uint8_t> _file, std::span<const TextureFormat> _supported);
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+
+#include "frame_ring.hpp"
+#include "frustum_culling.hpp"
+#include "gpu_culling.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief The froxels of a view: the screen split in tiles, each tile in depth slices spaced
+ * exponentially between the near and far planes.
+ */
+struct ClusterGrid
+{
+    uint32_t tilesX = 16;
+    uint32_t tilesY = 9;
+    uint32_t slices = 24;
+
+    [[nodiscard]] uint32_t size() const noexcept { return tilesX * tilesY * slices; }
+
+    constexpr bool operator==(const ClusterGrid&) const noexcept = default;
+};
+
+// The range of the light index list a cluster covers, as the shaders read it (std430).
+struct LightCluster
+{
+    uint32_t offset = 0;
+    uint32_t count = 0;
+};
+
+static_assert(sizeof(LightCluster) == 8, "LightCluster is read by the lighting shaders");
+
+/**
+ * @brief What a fragment shader looks its cluster up with (std430): the tile of its framebuffer
+ * position times tileScale, the slice of its view depth log(-z) * sliceScale + sliceBias. The
+ * clusters and the light indices are read from the frame ring buffer, at the element offsets
+ * firstCluster and firstIndex.
+ */
+struct ClusterUniforms
+{
+    float tileScaleX = 0.0f;
+    float tileScaleY = 0.0f;
+    float sliceScale = 0.0f;
+    float sliceBias = 0.0f;
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    uint32_t slices = 0;
+    uint32_t lightCount = 0;
+    uint32_t firstCluster = 0;
+    uint32_t firstIndex = 0;
+    uint32_t padding[2] = {};
+};
+
+static_assert(sizeof(ClusterUniforms) == 48, "ClusterUniforms is read by the lighting shaders");
+
+// The frame ring allocations of an assignment, empty when the ring was full.
+struct LightClusterBuffers
+{
+    FrameAllocation uniforms; // ClusterUniforms
+    FrameAllocation clusters; // a LightCluster per cluster, x fastest, then y, then the slice
+    FrameAllocation indices;  // the light indices the clusters range over, ascending per cluster
+    uint32_t indexCount = 0;
+
+    [[nodiscard]] explicit operator bool() const noexcept { return uniforms && clusters; }
+};
+
+/**
+ * @brief Clustered light culling: assigns the lights of a view to the froxels they touch each
+ * frame, so the lighting of a fragment loops over the lights of its cluster only, whatever the
+ * light count of the scene. A forward renderer's alternative to a G-buffer, whose bandwidth mobile
+ * tilers cannot afford.
+ *
+ * The lights are view space bounding spheres (the view looking down -Z as glm's). A slice is
+ * first culled against the full view, then each of its tiles against the lights left, both by the
+ * SIMD kernels of cullSpheres(); the slices run in parallel on the pool. The planes of the
+ * clusters are conservative: a light near a cluster corner may be assigned to it without touching
+ * it, never the other way.
+ */
+class MOSAIC_API LightClustering final
+{
+   private:
+    // The lights a slice keeps and the clusters of its tiles, reused from frame to frame
+    struct Slice
+    {
+        std::vector<float> x, y, z, radius;
+        std::vector<uint32_t> lights;  // the indices of the lights in the slice
+        std::vector<uint32_t> visible; // scratch of a tile
+        std::vector<uint32_t> indices; // the lights of each tile, in tile order
+        std::vector<LightCluster> clusters;
+    };
+
+    ClusterGrid m_grid;
+    ClusterUniforms m_uniforms;
+    std::vector<Frustum> m_sliceFrustums; // the view cut at the depth of each slice
+    std::vector<Frustum> m_tileFrustums;  // the sides of each tile, the depth planes unset
+    std::vector<Slice> m_slices;
+
+   public:
+    LightClustering() = default;
+
+   public:
+    /**
+     * @brief Builds the cluster planes of a symmetric perspective projection of _p00, _p11
+     * (projection[0][0], [1][1]) between _zNear and _zFar, on a framebuffer of _width x _height.
+     * Tile row 0 is at NDC y = -1: the top of a Vulkan framebuffer with a y-flipped projection.
+     *
+     * @throws std::invalid_argument if the grid is empty or the depth range not 0 < near < far.
+     */
+    void setProjection(const ClusterGrid& _grid, float _p00, float _p11, float _zNear,
+                       float _zFar, uint32_t _width, uint32_t _height);
+
+    /**
+     * @brief Assigns _lights to the clusters and writes the result to _ring, the light indices
+     * relative to the first light. Returns empty allocations before setProjection(), and with an
+     * error logged when the ring is out of memory.
+     */
+    LightClusterBuffers assign(exec::ThreadPool& _pool, const SphereColumns& _lights,
+                               FrameRing& _ring);
+
+    /// Same as above on the calling thread.
+    LightClusterBuffers assign(const SphereColumns& _lights, FrameRing& _ring);
+
+    [[nodiscard]] const ClusterGrid& getGrid() const noexcept { return m_grid; }
+    [[nodiscard]] const ClusterUniforms& getUniforms() const noexcept { return m_uniforms; }
+
+    /// The view space planes of a cluster, for debug drawing.
+    [[nodiscard]] Frustum getClusterFrustum(uint32_t _x, uint32_t _y,
+                                            uint32_t _slice) const noexcept;
+
+   private:
+    void assignSlice(uint32_t _slice, const SphereColumns& _lights);
+    LightClusterBuffers write(uint32_t _lightCount, FrameRing& _ring);
+};
+
+} // namespace graphics
+} // namespace mosaic
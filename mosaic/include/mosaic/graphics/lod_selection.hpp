@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+#include "frustum_culling.hpp"
+#include "gpu_culling.hpp"
+#include "mesh.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The mesh LODs of a chain, the impostor tier after them.
+inline constexpr uint32_t k_maxLodCount = 8;
+
+// The tier of an object drawn as a billboard impostor, InstanceBatch::lod.
+inline constexpr uint8_t k_impostorTier = 0xFE;
+
+// The tier of an object too small to be drawn.
+inline constexpr uint8_t k_culledTier = 0xFF;
+
+/**
+ * @brief The tiers an object is drawn with by its screen coverage, the fraction of the viewport
+ * height its bounding sphere covers (getScreenCoverage()): mesh LOD i down to minCoverage[i],
+ * then the impostor down to impostorCoverage when the chain has one, culled below the last.
+ */
+struct LodChain
+{
+    std::array<float, k_maxLodCount> minCoverage = {}; // descending
+    uint32_t lodCount = 1;
+    bool impostor = false;
+    float impostorCoverage = 0.0f;
+};
+
+// The camera the tiers are selected for.
+struct LodView
+{
+    std::array<float, 3> position = {};
+    float scale = 1.0f;       // projection[1][1], times a LOD bias (below 1 for coarser LODs)
+    float hysteresis = 0.1f;  // the fraction of its threshold an object crosses to switch tier
+};
+
+/**
+ * @brief The chain of the LODs of a cooked mesh: each LOD drawn while the next one would be seen
+ * with an error of more than _maxPixels on a viewport _viewportHeight pixels tall (as
+ * selectMeshLod()). The last LOD is drawn down to _impostorCoverage, without an impostor when
+ * it is 0.
+ */
+[[nodiscard]] MOSAIC_API LodChain makeLodChain(std::span<const MeshLod> _lods, float _radius,
+                                               float _viewportHeight, float _maxPixels = 1.0f,
+                                               float _impostorCoverage = 0.0f) noexcept;
+
+// The radius of _sphere over its distance to the camera, times the scale of _view.
+[[nodiscard]] MOSAIC_API float getScreenCoverage(const BoundingSphere& _sphere,
+                                                 const LodView& _view) noexcept;
+
+/**
+ * @brief The tier of _chain at _coverage: a mesh LOD, k_impostorTier or k_culledTier. From a
+ * _previous tier, the thresholds on the way are moved by _hysteresis of their value, so an
+ * object near one does not switch back and forth.
+ */
+[[nodiscard]] MOSAIC_API uint8_t selectLodTier(const LodChain& _chain, float _coverage,
+                                               std::optional<uint8_t> _previous,
+                                               float _hysteresis) noexcept;
+
+/**
+ * @brief The culling and LOD selection of the objects drawn through an InstanceBatcher: the
+ * objects in the frustum (cullSpheres()), then their tier, the objects too small dropped. The
+ * tier an object had the previous select() is its hysteresis; an object that was not visible
+ * gets the tier of its coverage.
+ *
+ * The objects keep their index from a frame to the next. The coverage is compared squared,
+ * without a square root, over the compacted visible indices.
+ */
+class MOSAIC_API LodSelector final
+{
+   private:
+    std::vector<uint8_t> m_tiers;
+    std::vector<uint32_t> m_frames; // of the last select() each object was visible in
+    std::vector<uint32_t> m_visible;
+    uint32_t m_frame = 0;
+
+   public:
+    LodSelector() = default;
+
+   public:
+    /**
+     * @brief Selects the tiers of _spheres, the chain of object i _chains[_chainOf[i]]. Returns
+     * the objects to draw, ascending, their tier getTier().
+     */
+    std::span<const uint32_t> select(const Frustum& _frustum, const SphereColumns& _spheres,
+                                     std::span<const uint32_t> _chainOf,
+                                     std::span<const LodChain> _chains, const LodView& _view);
+
+    /// Same as above, culled on _pool (cullSpheres()).
+    std::span<const uint32_t> select(exec::ThreadPool& _pool, const Frustum& _frustum,
+                                     const SphereColumns& _spheres,
+                                     std::span<const uint32_t> _chainOf,
+                                     std::span<const LodChain> _chains, const LodView& _view);
+
+    /// The tier of an object at the last select() it was visible in.
+    [[nodiscard]] uint8_t getTier(uint32_t _object) const noexcept { return m_tiers[_object]; }
+
+    /// Forgets the tiers, the next select() has no hysteresis.
+    void reset() noexcept;
+
+   private:
+    std::span<const uint32_t> selectVisible(uint32_t _count, const SphereColumns& _spheres,
+                                            std::span<const uint32_t> _chainOf,
+                                            std::span<const LodChain> _chains,
+                                            const LodView& _view);
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// How close the process is to the device memory budget the driver grants it.
+enum class MemoryPressure : uint8_t
+{
+    Normal,
+    High,    // the streamed resources are evicted down to the high watermark
+    Critical // the next allocations may fail (out of device memory, a lost device on Android)
+};
+
+struct MemoryBudgetSettings
+{
+    float highUsage = 0.85f;     // of the budget, from which the pressure is high
+    float criticalUsage = 0.95f; // of the budget, from which it is critical
+    float lowLoad = 0.5f; // of the frame interval, at most the CPU and GPU time of a low-load frame
+    uint64_t defragmentationBytes = 16ull * 1024 * 1024; // at most moved by a low-load frame
+};
+
+[[nodiscard]] MOSAIC_API MemoryPressure getMemoryPressure(
+    uint64_t _usage, uint64_t _budget, const MemoryBudgetSettings& _settings = {}) noexcept;
+
+/**
+ * @brief The bytes the streamed resources may keep resident, _streamed of the _usage: what the
+ * high watermark of the budget leaves besides the other resources, none once they reach it. The
+ * streaming then evicts before the pressure gets high instead of filling the budget and leaving
+ * the next render target or buffer to fail.
+ */
+[[nodiscard]] MOSAIC_API uint64_t getStreamingBudget(
+    uint64_t _usage, uint64_t _budget, uint64_t _streamed,
+    const MemoryBudgetSettings& _settings = {}) noexcept;
+
+/**
+ * @brief Whether a frame leaves the time of a defragmentation pass (its copies, the CPU work of
+ * the moves): both its CPU and GPU time within lowLoad of the interval between two frames.
+ */
+[[nodiscard]] MOSAIC_API bool isLowLoadFrame(std::chrono::nanoseconds _cpuTime,
+                                             std::chrono::nanoseconds _gpuTime,
+                                             std::chrono::nanoseconds _interval,
+                                             const MemoryBudgetSettings& _settings = {}) noexcept;
+
+[[nodiscard]] MOSAIC_API const char* getMemoryPressureName(MemoryPressure _pressure) noexcept;
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+
+#include "gpu_culling.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/*
+ * Mesh file layout (native endianness, every section starts on a 16-byte boundary), written by
+ * cookMesh() and read in place from a mapped file:
+ *
+ *   MeshFileHeader
+ *   MeshLod[lodCount]                    the finest first
+ *   --- the payload, uploaded as it is to one buffer ---
+ *   PackedVertex[vertexCount]            shared by every LOD
+ *   uint32_t indices[indexCount]         a range per LOD
+ *   Meshlet[meshletCount]                a range per LOD
+ *   uint32_t meshletVertices[...]        indices into the vertices, a range per meshlet
+ *   uint8_t meshletTriangles[...]        3 per triangle into the vertices of the meshlet,
+ *                                        each meshlet padded to 4 bytes
+ */
+
+inline constexpr uint32_t k_meshMagic = 0x48534D4D; // "MMSH"
+inline constexpr uint32_t k_meshVersion = 2;
+
+/**
+ * @brief A vertex as the shaders read it, 16 bytes: the position in unorm16 over the bounds of
+ * the mesh, the normal octahedral in snorm16, the texture coordinates in half floats.
+ */
+struct PackedVertex
+{
+    std::array<uint16_t, 3> position = {};
+    uint16_t padding = 0;
+    std::array<int16_t, 2> normal = {};
+    std::array<uint16_t, 2> uv = {};
+};
+
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex is read by the shaders");
+
+// A level of detail: its indices, its meshlets, and how far it is from the finest (object space)
+struct MeshLod
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    uint32_t firstMeshlet = 0;
+    uint32_t meshletCount = 0;
+    float error = 0.0f;
+    uint32_t padding[3] = {};
+};
+
+static_assert(sizeof(MeshLod) == 32, "MeshLod is stored in mesh files");
+
+/**
+ * @brief At most MeshCookSettings::maxMeshletVertices and maxMeshletTriangles, std430.
+ *
+ * The normals of its triangles (counter-clockwise seen from the front) are within a cone around
+ * coneAxis: seen from a camera at c, every triangle faces away when
+ * dot(center - c, coneAxis) >= coneCutoff * length(center - c) + radius (isMeshletBackfacing()).
+ * A cutoff of 1 never culls: the triangles face every way.
+ */
+struct Meshlet
+{
+    uint32_t vertexOffset = 0;   // in the meshlet vertices
+    uint32_t triangleOffset = 0; // in bytes, in the meshlet triangles
+    uint32_t vertexCount = 0;
+    uint32_t triangleCount = 0;
+    BoundingSphere bounds;              // object space
+    std::array<float, 3> coneAxis = {}; // object space, normalized
+    float coneCutoff = 1.0f;            // the sine of the half angle of the cone
+};
+
+static_assert(sizeof(Meshlet) == 48, "Meshlet is read by the shaders");
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t lodCount;
+    uint32_t meshletCount;
+    uint32_t meshletVertexCount;
+    uint32_t meshletTriangleSize; // in bytes
+    std::array<float, 3> boundsMin; // the position 0 of the quantization
+    float padding0;
+    std::array<float, 3> boundsExtent; // the position 65535
+    float padding1;
+    BoundingSphere bounds;
+};
+
+static_assert(sizeof(MeshFileHeader) == 80, "MeshFileHeader is stored in mesh files");
+
+// The byte range of a section of a mesh file
+struct MeshSection
+{
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+/**
+ * @brief A mesh file read in place: the header and LODs copied, the sections of the payload by
+ * their range in the file, for an upload straight from the mapping.
+ */
+struct MeshData
+{
+    MeshFileHeader header = {};
+    std::vector<MeshLod> lods;
+
+    MeshSection payload; // from the vertices to the end
+    MeshSection vertices;
+    MeshSection indices;
+    MeshSection meshlets;
+    MeshSection meshletVertices;
+    MeshSection meshletTriangles;
+};
+
+// Checks the header and that every section is in the file, copies nothing of the payload.
+MOSAIC_API pieces::Result<MeshData, std::string> parseMesh(std::span<const uint8_t> _file);
+
+/**
+ * @brief The coarsest LOD whose error, seen at _distance, is at most _maxPixels on screen.
+ *
+ * @param _pixelsPerUnit The pixels a unit spans at a distance of 1 (the viewport height over
+ * 2 tan(fovY / 2)).
+ */
+[[nodiscard]] MOSAIC_API uint32_t selectMeshLod(std::span<const MeshLod> _lods, float _distance,
+                                                float _pixelsPerUnit,
+                                                float _maxPixels = 1.0f) noexcept;
+
+// The inverse of the quantization of cookMesh(), for the CPU (shaders do the same).
+[[nodiscard]] MOSAIC_API std::array<float, 3> unpackPosition(const MeshFileHeader& _header,
+                                                             const PackedVertex& _vertex) noexcept;
+[[nodiscard]] MOSAIC_API std::array<float, 3> unpackNormal(const PackedVertex& _vertex) noexcept;
+[[nodiscard]] MOSAIC_API std::array<float, 2> unpackUv(const PackedVertex& _vertex) noexcept;
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+
+#include "mesh.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// A vertex of the source of a mesh, as an importer reads it
+struct MeshVertex
+{
+    std::array<float, 3> position = {};
+    std::array<float, 3> normal = {0.0f, 0.0f, 1.0f};
+    std::array<float, 2> uv = {};
+};
+
+struct MeshCookSettings
+{
+    uint32_t maxLods = 4;              // the finest included
+    float lodRatio = 0.5f;             // of the triangles of the LOD before
+    uint32_t minLodTriangles = 64;     // no coarser LOD below
+    float overdrawThreshold = 1.05f;   // how much worse the vertex cache may get for overdraw
+    bool meshlets = false;
+    uint32_t maxMeshletVertices = 64;
+    uint32_t maxMeshletTriangles = 124;
+};
+
+/**
+ * @brief The mesh file of a triangle list, offline: the LODs simplified from it, the indices of
+ * each reordered for the post-transform cache then for overdraw, the vertices for fetch locality
+ * and quantized, and the meshlets of each LOD if asked.
+ */
+MOSAIC_API pieces::Result<std::vector<uint8_t>, std::string> cookMesh(
+    std::span<const MeshVertex> _vertices, std::span<const uint32_t> _indices,
+    const MeshCookSettings& _settings = {});
+
+// Reorders the triangles for a post-transform cache of _cacheSize vertices (Tipsify).
+MOSAIC_API void optimizeVertexCache(std::span<uint32_t> _indices, size_t _vertexCount,
+                                    uint32_t _cacheSize = 16);
+
+/**
+ * @brief Reorders clusters of the triangles, cache optimized first, so outward facing ones are
+ * drawn first: the clusters split where the cache restarts, and where the cache efficiency of
+ * the cluster so far is within _threshold of the whole one.
+ */
+MOSAIC_API void optimizeOverdraw(std::span<uint32_t> _indices,
+                                 std::span<const MeshVertex> _vertices, float _threshold = 1.05f,
+                                 uint32_t _cacheSize = 16);
+
+/**
+ * @brief Merges the vertices in cells of _cellSize (vertex clustering), each to the one nearest
+ * to the average of its cell, and drops the triangles that collapsed.
+ *
+ * @return The indices of the simplified triangles, into the same vertices.
+ */
+MOSAIC_API std::vector<uint32_t> simplifyMesh(std::span<const uint32_t> _indices,
+                                              std::span<const MeshVertex> _vertices,
+                                              float _cellSize);
+
+// The average cache misses per triangle of a FIFO post-transform cache, 0.5 to 3.
+[[nodiscard]] MOSAIC_API float getAcmr(std::span<const uint32_t> _indices, size_t _vertexCount,
+                                       uint32_t _cacheSize = 16);
+
+} // namespace graphics
+} // namespace mosaic
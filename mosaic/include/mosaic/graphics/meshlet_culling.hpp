@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+#include "gpu_culling.hpp"
+#include "mesh.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+class OcclusionBuffer;
+
+// The meshlets a task workgroup culls, an invocation each (meshlet.task, cull_meshlets.comp).
+inline constexpr uint32_t k_meshletTaskSize = 32;
+
+// The outputs of meshlet.mesh: the meshes drawn by meshlets are cooked within the default
+// MeshCookSettings limits, the meshlets beyond them are cut.
+inline constexpr uint32_t k_maxMeshletVertices = 64;
+inline constexpr uint32_t k_maxMeshletTriangles = 124;
+
+/**
+ * @brief Where the meshlet shaders read a cooked mesh (std430): the BufferHandle value of its
+ * buffer, the byte offsets of its sections in it, and the bounds its positions are quantized
+ * over (MeshFileHeader::boundsMin, boundsExtent).
+ */
+struct MeshletMesh
+{
+    uint32_t buffer = 0;
+    uint32_t vertexOffset = 0;
+    uint32_t meshletOffset = 0;
+    uint32_t meshletVertexOffset = 0;
+    uint32_t meshletTriangleOffset = 0;
+    uint32_t padding0[3] = {};
+    std::array<float, 3> boundsMin = {};
+    float padding1 = 0.0f;
+    std::array<float, 3> boundsExtent = {};
+    float padding2 = 0.0f;
+};
+
+static_assert(sizeof(MeshletMesh) == 64, "MeshletMesh is read by the meshlet shaders");
+
+// An instance drawn by meshlets: those of the LOD it is drawn at (a MeshLod's range), std430.
+struct MeshletInstance
+{
+    std::array<float, 16> world = {}; // column-major
+    uint32_t mesh = 0;                // its MeshletMesh
+    uint32_t firstMeshlet = 0;
+    uint32_t meshletCount = 0;
+    uint32_t instanceIndex = 0; // of its data in the fragment shader (the material)
+};
+
+static_assert(sizeof(MeshletInstance) == 80, "MeshletInstance is read by the meshlet shaders");
+
+// Up to k_meshletTaskSize meshlets of an instance, culled by one task workgroup.
+struct MeshletTask
+{
+    uint32_t instance = 0;
+    uint32_t firstMeshlet = 0; // in the meshlets of the mesh
+    uint32_t meshletCount = 0;
+    uint32_t padding = 0;
+};
+
+static_assert(sizeof(MeshletTask) == 16, "MeshletTask is read by the meshlet shaders");
+
+// A meshlet the culling kept (the compute fallback), drawn as an instance of the emulated draw.
+struct VisibleMeshlet
+{
+    uint32_t instance = 0;
+    uint32_t meshlet = 0; // in the meshlets of the mesh
+};
+
+static_assert(sizeof(VisibleMeshlet) == 8, "VisibleMeshlet is read by the meshlet shaders");
+
+/**
+ * @brief The camera of the meshlet draws and their culling (std430): every meshlet is tested
+ * against the frustum, then its cone against the camera position (k_cone), then its sphere against
+ * the depth pyramid (k_occlusion, reverse-Z, each mip the farthest depth of the texels it covers,
+ * as CullUniforms's).
+ */
+struct MeshletCullUniforms
+{
+    static constexpr uint32_t k_cone = 1u << 0;
+    static constexpr uint32_t k_occlusion = 1u << 1;
+
+    std::array<std::array<float, 4>, 6> frustum = {}; // Frustum::planes
+    std::array<float, 16> viewProjection = {};        // of the draws
+    std::array<float, 16> view = {};                  // for the occlusion test
+    std::array<float, 3> cameraPosition = {};         // world space, for the cone test
+    float p00 = 0.0f;
+    float p11 = 0.0f;
+    float zNear = 0.0f;
+    float pyramidWidth = 0.0f;
+    float pyramidHeight = 0.0f;
+    uint32_t taskCount = 0;
+    uint32_t maxVisible = 0; // of the fallback's VisibleMeshlets
+    uint32_t flags = k_cone;
+    uint32_t padding = 0;
+};
+
+static_assert(sizeof(MeshletCullUniforms) == 272,
+              "MeshletCullUniforms is read by the meshlet shaders");
+
+/**
+ * @brief The cone of _meshlet through _world into _axis (normalized). False when it cannot cull:
+ * a cone of a half space or wider, or a non-uniform scale, which bends the normals out of it.
+ */
+[[nodiscard]] MOSAIC_API bool transformMeshletCone(Matrix4 _world, const Meshlet& _meshlet,
+                                                   std::array<float, 3>& _axis) noexcept;
+
+/**
+ * @brief Whether every triangle in _bounds with its normal in the cone of _axis and _cutoff
+ * faces away from _camera (world space), the test without the apex of the cone: conservative,
+ * the sphere's angular radius added to the cone's.
+ */
+[[nodiscard]] MOSAIC_API bool isMeshletBackfacing(const BoundingSphere& _bounds,
+                                                  const std::array<float, 3>& _axis,
+                                                  float _cutoff,
+                                                  const std::array<float, 3>& _camera) noexcept;
+
+/// The meshlets of the instances split in tasks of at most k_meshletTaskSize, in order.
+MOSAIC_API void buildMeshletTasks(std::span<const MeshletInstance> _instances,
+                                  std::vector<MeshletTask>& _tasks);
+
+/**
+ * @brief The reference of the task shader's culling, and of cull_meshlets.comp, its fallback:
+ * the meshlets of _tasks kept by the tests of _uniforms.flags are appended to _visible, in task
+ * order (on the GPU, any). _meshlets are those of each mesh, by MeshletInstance::mesh; with
+ * _occlusion its test stands for the depth pyramid's. Returns the meshlets kept, those past the
+ * end of _visible counted but not written.
+ */
+MOSAIC_API uint32_t cullMeshlets(const MeshletCullUniforms& _uniforms,
+                                 std::span<const MeshletInstance> _instances,
+                                 std::span<const std::span<const Meshlet>> _meshlets,
+                                 std::span<const MeshletTask> _tasks,
+                                 std::span<VisibleMeshlet> _visible,
+                                 const OcclusionBuffer* _occlusion = nullptr) noexcept;
+
+} // namespace graphics
+} // namespace mosaic
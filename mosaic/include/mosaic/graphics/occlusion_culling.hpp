@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+#include "gpu_culling.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief The software occlusion culling of the devices where the compute passes of GpuCulling
+ * are too slow or missing: a few large occluders (walls, floors, their simplified meshes) are
+ * rasterized on the CPU into a small depth buffer, of which a pyramid is built as the GPU path
+ * does; then each sphere is tested against it as by cull_instances.comp.
+ *
+ * The projection is that of CullUniforms: reverse-Z with an infinite far plane (the depth of a
+ * view space point zNear / -z), of scale _p00 and _p11. The depth of an occluder triangle is the
+ * farthest of its vertices over the pixels whose center it covers, so an occluder never hides
+ * what is in front of it. Triangles crossing the near plane are skipped, both windings drawn.
+ *
+ * A frame is begin(), the occluders rasterize()d, finish(), then isOccluded() from any thread.
+ */
+class MOSAIC_API OcclusionBuffer final
+{
+   public:
+    static constexpr uint32_t k_defaultWidth = 256;
+    static constexpr uint32_t k_defaultHeight = 128;
+
+   private:
+    uint32_t m_width;
+    uint32_t m_height;
+    std::vector<std::vector<float>> m_levels; // the depths, level 0 rasterized, row-major
+
+    std::array<float, 16> m_view = {};
+    float m_p00 = 1.0f;
+    float m_p11 = 1.0f;
+    float m_zNear = 0.1f;
+
+   public:
+    explicit OcclusionBuffer(uint32_t _width = k_defaultWidth,
+                             uint32_t _height = k_defaultHeight);
+
+   public:
+    // Cleared to the far plane (0) for the camera of the frame.
+    void begin(Matrix4 _view, float _p00, float _p11, float _zNear);
+
+    /**
+     * @brief The triangles of _indices (three per triangle) over _positions (x, y, z per vertex),
+     * placed in the world by _world.
+     */
+    void rasterize(std::span<const float> _positions, std::span<const uint32_t> _indices,
+                   Matrix4 _world);
+
+    // Builds the pyramid of the rasterized depths, each texel the farthest of those it covers.
+    void finish();
+
+    /**
+     * @brief Whether the world space _sphere is behind the occluders over the whole rectangle it
+     * covers on screen. A sphere crossing the near plane or off screen is never occluded.
+     */
+    [[nodiscard]] bool isOccluded(const BoundingSphere& _sphere) const noexcept;
+
+    [[nodiscard]] uint32_t getWidth() const noexcept { return m_width; }
+
+    [[nodiscard]] uint32_t getHeight() const noexcept { return m_height; }
+
+    [[nodiscard]] uint32_t getLevelCount() const noexcept
+    {
+        return static_cast<uint32_t>(m_levels.size());
+    }
+
+    // The depth of texel (_x, _y) of pyramid level _level, after finish().
+    [[nodiscard]] float getDepth(uint32_t _x, uint32_t _y, uint32_t _level = 0) const noexcept;
+
+   private:
+    [[nodiscard]] uint32_t getLevelWidth(uint32_t _level) const noexcept;
+    [[nodiscard]] uint32_t getLevelHeight(uint32_t _level) const noexcept;
+};
+
+} // namespace graphics
+} // namespace mosaic
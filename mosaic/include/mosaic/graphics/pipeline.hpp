@@ -1,8 +1,14 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string>
+#include <vector>
+
+#include "mosaic/defines.hpp"
 
 #include "shader.hpp"
+#include "texture.hpp"
 
 namespace mosaic
 {
@@ -80,5 +86,15 @@ struct PipelineDescription
     std::string debugName;
 };
 
+/**
+ * @brief FNV-1a over everything a pipeline is compiled from: the shaders (stage, bytecode, entry
+ * point, specialization constants), the vertex layout, the states and the topology. The debug
+ * names are left out, so equal hashes are the same pipeline (the backends compile it once).
+ */
+MOSAIC_API uint64_t hashPipelineDescription(const PipelineDescription& _description) noexcept;
+
+// FNV-1a over SPIR-V bytecode only: one shader module serves every stage and entry point of it
+MOSAIC_API uint64_t hashShaderBytecode(std::span<const uint8_t> _bytecode) noexcept;
+
 } // namespace graphics
 } // namespace mosaic
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// What the presentation of the frames is tuned for, mapped to the best mode the surface supports.
+enum class PresentPolicy : uint8_t
+{
+    LowLatency, // the newest frame shown each refresh without tearing: mailbox, else FIFO
+    VSync,      // every frame shown, at most one per refresh: FIFO
+    PowerSave,  // synchronized but a late frame shown at once: FIFO relaxed, else FIFO
+    Uncapped    // as fast as the GPU renders, for benchmarks: immediate (tears), else mailbox
+};
+
+// The presentation modes Vulkan and WebGPU have in common.
+enum class PresentMode : uint8_t
+{
+    Immediate,
+    Mailbox,
+    Fifo,
+    FifoRelaxed
+};
+
+/**
+ * @brief The first mode of _policy's preferences in _supported, FIFO when none is (every
+ * surface supports it).
+ */
+[[nodiscard]] MOSAIC_API PresentMode choosePresentMode(
+    PresentPolicy _policy, std::span<const PresentMode> _supported) noexcept;
+
+[[nodiscard]] MOSAIC_API const char* getPresentModeName(PresentMode _mode) noexcept;
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/task_future.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The bytes the GPU copied, once the frame that recorded the copy completed
+using ReadbackFuture = exec::TaskFuture<std::vector<std::byte>>;
+
+/**
+ * @brief A copy the GPU writes into a ReadbackRing: where in the backend buffer to copy to, and
+ * the future of its bytes. Empty when the ring had no room.
+ */
+struct Readback
+{
+    size_t offset = 0;
+    size_t size = 0;
+    ReadbackFuture future;
+
+    [[nodiscard]] explicit operator bool() const noexcept { return size != 0; }
+};
+
+/**
+ * @brief The GPU to CPU copies of the frames in flight (picking, screenshots, counters), in one
+ * persistently mapped buffer allocated as a FIFO ring: a copy is given its space by the frame
+ * that records it, and read back by complete() once that frame's fence signaled, frames later.
+ * Nothing waits for the GPU: when the ring is full the copy is refused, the caller tries again
+ * on a later frame.
+ *
+ * The futures complete on the thread that calls complete(), the one recording the frames.
+ */
+class MOSAIC_API ReadbackRing final
+{
+   private:
+    struct Pending
+    {
+        size_t offset;
+        size_t size;
+        uint64_t frame;
+        exec::TaskPromise<std::vector<std::byte>> promise;
+    };
+
+    const std::byte* m_memory = nullptr;
+    size_t m_capacity = 0;
+
+    size_t m_head = 0; // the end of the copy allocated last
+    std::deque<Pending> m_pending; // by frame, the oldest at the tail of the ring
+
+   public:
+    ReadbackRing() = default;
+
+    ReadbackRing(const ReadbackRing&) = delete;
+    ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+   public:
+    /// _memory is the mapped backend buffer of _capacity bytes. Breaks the copies in flight.
+    void reset(const std::byte* _memory, size_t _capacity);
+
+    /**
+     * @brief _size bytes at an offset multiple of _alignment (a power of two) for a copy recorded
+     * by _frame (a count of frames submitted, that of the frame recording), or an empty Readback
+     * when the copies in flight leave no room.
+     */
+    [[nodiscard]] Readback allocate(size_t _size, uint64_t _frame, size_t _alignment = 16);
+
+    /**
+     * @brief Completes, oldest first, the copies of the frames up to _completedFrame with their
+     * bytes, which the backend made visible to the CPU, and frees their space.
+     */
+    void complete(uint64_t _completedFrame);
+
+    /// Breaks the copies in flight (FutureErrorCode::broken_promise), e.g. of a destroyed context.
+    void cancel() noexcept;
+
+    [[nodiscard]] size_t getCapacity() const noexcept { return m_capacity; }
+    [[nodiscard]] size_t getPendingCount() const noexcept { return m_pending.size(); }
+};
+
+/**
+ * @brief The texels around the click a pick reads back, in a render target of _extent: a square
+ * of 2 * _radius + 1 texels clamped to the target (empty when the click is outside), so a click
+ * next to a thin object still hits it.
+ */
+struct PickRegion
+{
+    glm::uvec2 offset = {0, 0};
+    glm::uvec2 extent = {0, 0};
+
+    [[nodiscard]] bool empty() const noexcept { return extent.x == 0 || extent.y == 0; }
+    [[nodiscard]] size_t getTexelCount() const noexcept { return size_t{extent.x} * extent.y; }
+};
+
+[[nodiscard]] MOSAIC_API PickRegion getPickRegion(glm::uvec2 _pixel, glm::uvec2 _extent,
+                                                  uint32_t _radius = 2) noexcept;
+
+/**
+ * @brief The entity under _pixel in _ids, the entity IDs of _region read back row by row (0 where
+ * nothing was drawn): that of the pixel, else the closest one in the region, 0 if none.
+ */
+[[nodiscard]] MOSAIC_API uint32_t findPickedEntity(std::span<const uint32_t> _ids,
+                                                   const PickRegion& _region,
+                                                   glm::uvec2 _pixel) noexcept;
+
+} // namespace graphics
+} // namespace mosaic
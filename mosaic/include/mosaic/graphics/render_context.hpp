@@ -1,9 +1,17 @@
 #pragma once
 
+#include <optional>
+
 #include <pieces/core/result.hpp>
 
 #include "mosaic/window/window.hpp"
 
+#include "exported_frames.hpp"
+#include "input_latency.hpp"
+
+#include "present_mode.hpp"
+#include "render_profile.hpp"
+
 namespace mosaic
 {
 namespace graphics
@@ -11,11 +19,35 @@ namespace graphics
 
 struct RenderContextSettings
 {
-    bool enableDebugLayers;
-    uint32_t backbufferCount;
+    bool validation;          // of the device, where the context creates its own (WebGPU)
+    bool debugLabels;         // the passes labelled and the objects named, for captures
+    bool checks;              // the handles of each draw checked before it is recorded
+    uint32_t backbufferCount; // the swapchain images asked for, 0 for the device's minimum + 1
+    uint32_t framesInFlight;  // recorded by the CPU while the GPU renders the previous ones
+    bool lowLatency;          // each frame starts late enough to reach the GPU as it gets idle
+    PresentPolicy presentPolicy;
+    glm::uvec2 offscreenExtent; // the images of a headless context, which has no window
+    bool exportFrames;          // those images shared with another process, see ExportedFrames
+
+    // The scene rendered at the scale holding its GPU time within resolution.frameBudget, then
+    // upscaled to the backbuffer (where the timestamps and a blit to it are supported)
+    bool dynamicResolution;
+    ResolutionScalerSettings resolution;
+    float resolutionLimit; // the thermal cap of the scale, see ResolutionScaler::setLimit
 
-    RenderContextSettings(bool _enableDebugLayers, uint32_t _backbufferCount)
-        : enableDebugLayers(_enableDebugLayers), backbufferCount(_backbufferCount){};
+    RenderContextSettings(const RenderProfile& _profile, bool _lowLatency = false)
+        : validation(_profile.validation),
+          debugLabels(_profile.debugLabels),
+          checks(_profile.checks),
+          backbufferCount(_profile.backbufferCount),
+          framesInFlight(_profile.framesInFlight),
+          lowLatency(_lowLatency),
+          presentPolicy(_profile.presentPolicy),
+          offscreenExtent(1920, 1080),
+          exportFrames(false),
+          dynamicResolution(_profile.dynamicResolution),
+          resolution(_profile.resolution),
+          resolutionLimit(1.0f){};
 };
 
 class RenderSystem;
@@ -36,18 +68,48 @@ class RenderContext
         RenderSystem* _renderSystem) = 0;
     virtual void shutdown() = 0;
 
+    // Blocks until the next frame may start, before its input is sampled: a frame in flight
+    // completed and, in low-latency mode, until the GPU is about to get idle
+    void pace();
     void render();
 
+    void setLowLatency(bool _enabled);
+    // Applied by the next frame, through the swapchain recreation of a resize
+    void setPresentPolicy(PresentPolicy _policy);
+    // Caps the dynamic resolution scale from the next frame, ignored without it
+    void setResolutionLimit(float _limit);
+
+    // The next frame rendered consumes input that happened at _input, see InputLatency
+    void consumeInput(InputLatency::Clock::time_point _input);
+
+    /**
+     * @brief The images of a headless context created with exportFrames, as new handles for one
+     * consumer: the handshake of ExportedFrames starts with the frames rendered after the call.
+     * Errs where the context or the device cannot export them (a window, WebGPU).
+     */
+    virtual pieces::Result<ExportedFrames, std::string> exportFrames();
+    // The image of the frame submitted last since exportFrames(), shown once its `ready` signals
+    [[nodiscard]] virtual std::optional<uint32_t> getLastExportedImage() const;
+
+    // Null for a headless context, see RenderSystem::createHeadlessContext()
     [[nodiscard]] const window::Window* getWindow() const;
     [[nodiscard]] const RenderContextSettings getSettings() const;
+    [[nodiscard]] const InputLatency& getInputLatency() const;
 
    protected:
     [[nodiscard]] window::Window* getWindowInternal();
     [[nodiscard]] RenderContextSettings& getSettingsInternal();
+    // Told by the backend when the frames are submitted and presented
+    [[nodiscard]] InputLatency& getInputLatencyInternal();
 
     virtual void resizeFramebuffer() = 0;
     virtual void recreateSurface() = 0;
-    virtual void beginFrame() = 0;
+    // Nothing to wait for by default, beginFrame() blocks for the frame
+    virtual void waitForFrame() {}
+    virtual void applyPresentPolicy() = 0;
+    // False when the frame has nothing to render to (minimized window, swapchain recreated), the
+    // other steps of the frame are then skipped
+    virtual bool beginFrame() = 0;
     virtual void updateResources() = 0;
     virtual void drawScene() = 0;
     virtual void endFrame() = 0;
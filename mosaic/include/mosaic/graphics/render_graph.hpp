@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+#include "texture.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief How a pass uses a texture; the backends map it to their layout, stages and access.
+ */
+enum class ResourceAccess : uint8_t
+{
+    None, // undefined contents (first use of a transient, or to discard)
+    ColorAttachment,
+    DepthAttachment,
+    DepthRead,         // read-only depth attachment
+    InputAttachment,   // read at the pixel a subpass shades, as an earlier subpass wrote it
+    ResolveAttachment, // the single sampled target multisampled color attachments resolve to
+    Sampled,
+    StorageRead,
+    StorageWrite,
+    TransferSource,
+    TransferDestination,
+    Present
+};
+
+/**
+ * @brief The queue a pass runs on. An async compute pass overlaps the graphics passes it shares
+ * nothing with (shadow maps, a depth prepass...), the backends order it against the others with
+ * semaphores between their queues; on a device with a single queue it runs in order with them.
+ */
+enum class RenderGraphQueue : uint8_t
+{
+    Graphics,
+    AsyncCompute // dispatches and copies only: no attachments, no imported textures
+};
+
+enum class AttachmentLoad : uint8_t
+{
+    Load,
+    Clear,
+    DontCare
+};
+
+/**
+ * @brief Handle to a texture of a RenderGraph, valid until RenderGraph::reset().
+ */
+struct RenderGraphResource
+{
+    static constexpr uint32_t k_invalid = std::numeric_limits<uint32_t>::max();
+
+    uint32_t id = k_invalid;
+
+    [[nodiscard]] bool isValid() const noexcept { return id != k_invalid; }
+
+    bool operator==(const RenderGraphResource&) const = default;
+};
+
+/**
+ * @brief A transition of a texture before a pass (or at the end of the graph).
+ *
+ * A discarding barrier does not keep the contents: the backends transition from an undefined
+ * layout. An aliasing one is the first use of a transient in memory another transient used
+ * before, it waits on every earlier pass. A cross-queue one follows an access of a pass on the
+ * other queue, made visible by the semaphore its batch waits on: only the layout transition is
+ * left to it.
+ */
+struct RenderGraphBarrier
+{
+    RenderGraphResource resource;
+    ResourceAccess before;
+    ResourceAccess after;
+    bool discard;
+    bool aliasing;
+    bool crossQueue = false;
+};
+
+/**
+ * @brief A run of passes on one queue, submitted at once by the backends. It waits for the batch
+ * of the other queue it has a hazard with (or a dependency on), k_unused if none: the batches
+ * in between overlap.
+ */
+struct RenderGraphBatch
+{
+    static constexpr uint32_t k_unused = std::numeric_limits<uint32_t>::max();
+
+    RenderGraphQueue queue;
+    std::vector<uint32_t> passes; // in the order they run
+    uint32_t wait = k_unused;     // the index of a batch of the other queue
+};
+
+struct RenderGraphAccess
+{
+    RenderGraphResource resource;
+    ResourceAccess access;
+    AttachmentLoad load;
+    bool storeContents; // read by a later pass, or imported; a transient at its end is not kept
+};
+
+class RenderGraph;
+
+/**
+ * @brief Command recording of a pass: the backend command buffer and the graph, whose textures
+ * the backend resolves.
+ */
+struct RenderGraphPassContext
+{
+    const RenderGraph* graph;
+    void* commandBuffer; // VkCommandBuffer, WGPURenderPassEncoder...
+    uint32_t pass;
+
+    // What the secondary command buffers of a parallel recording pass inherit
+    // (VkCommandBufferInheritanceInfo, its rendering info chained with dynamic rendering),
+    // nullptr otherwise
+    const void* inheritance = nullptr;
+};
+
+/**
+ * @brief Declares the accesses of a pass while it is added; each texture once per pass.
+ */
+class MOSAIC_API RenderGraphBuilder final
+{
+   private:
+    RenderGraph* m_graph;
+    uint32_t m_pass;
+
+   public:
+    RenderGraphBuilder(RenderGraph* _graph, uint32_t _pass) : m_graph(_graph), m_pass(_pass){};
+
+   public:
+    /// A transient texture, whose memory the textures not used at the same time share.
+    RenderGraphResource create(const std::string& _name, const TextureDescription& _description);
+
+    /// Sampled, StorageRead, TransferSource, DepthRead or InputAttachment. Reading an input
+    /// attachment makes the pass a subpass of the render pass of the pass before it, which must
+    /// have written the texture: the contents stay in tile memory between them.
+    RenderGraphResource read(RenderGraphResource _resource,
+                             ResourceAccess _access = ResourceAccess::Sampled);
+
+    /// ColorAttachment, DepthAttachment, ResolveAttachment, StorageWrite or TransferDestination.
+    /// Loading the contents also reads them, the other loads start from undefined contents. The
+    /// k-th resolve attachment of a pass is that of its k-th color attachment.
+    RenderGraphResource write(RenderGraphResource _resource,
+                              ResourceAccess _access = ResourceAccess::ColorAttachment,
+                              AttachmentLoad _load = AttachmentLoad::Load);
+
+    /// The pass is never culled (readbacks, timestamps...).
+    void setSideEffects();
+
+    /// The pass records its commands in secondary command buffers, in parallel, which its
+    /// command buffer only executes (RenderGraphPassContext::inheritance).
+    void setParallelRecording();
+
+    /// The queue the pass runs on, the graphics one by default.
+    void setQueue(RenderGraphQueue _queue);
+
+    /// A pass added before it whose work it needs beyond the textures of the graph (a buffer the
+    /// pass fills, such as the draws of the culling): kept with it, and waited for across queues.
+    void dependOn(uint32_t _pass);
+};
+
+/**
+ * @brief Frame graph above a RenderContext: passes declare the textures they read and write,
+ * compile() culls the passes nothing uses, computes the barriers and layout transitions between
+ * the passes, and places the transient textures in one heap, aliasing those with disjoint
+ * lifetimes.
+ *
+ * The passes run in the order they are added. Built once and compiled again when the
+ * descriptions change (a resize); the backends execute the compiled passes every frame
+ * (vulkan::executeRenderGraph()).
+ *
+ * For the tiled GPUs of mobile: a pass reading input attachments is merged as a subpass into the
+ * render pass of the passes before it, what the attachments hold not needed after it is never
+ * stored, and the transients only ever attachments of one render pass are memoryless (lazily
+ * allocated where the device has such memory, never backed).
+ *
+ * The passes on the async compute queue are grouped with the graphics ones into batches
+ * (getBatches()), each waiting for the batch of the other queue whose passes it conflicts with;
+ * the transients they use are shared by both queues and never aliased.
+ */
+class MOSAIC_API RenderGraph final
+{
+   public:
+    using SetupFunction = std::function<void(RenderGraphBuilder&)>;
+    using ExecuteFunction = std::function<void(const RenderGraphPassContext&)>;
+
+    struct MemoryRequirements
+    {
+        size_t size;
+        size_t alignment;
+    };
+
+    /// The memory of a transient texture on the device, estimated from its texels if none.
+    /// Called once the accesses are known (Resource::accessMask).
+    using MemoryRequirementsFunction =
+        std::function<MemoryRequirements(RenderGraphResource, const TextureDescription&)>;
+
+    struct Resource
+    {
+        std::string name;
+        TextureDescription description;
+        bool imported;
+        ResourceAccess initialAccess; // imported ones
+        ResourceAccess finalAccess;
+
+        // Compiled
+        uint32_t accessMask = 0; // 1 << ResourceAccess of every live access, for the usage
+        uint32_t firstPass = k_unused; // the first of its render pass, if used by a subpass
+        uint32_t lastPass = k_unused;
+        size_t heapOffset = 0; // transients
+        size_t heapSize = 0;
+        bool memoryless = false; // a transient in tile memory only: attachments, not stored
+        bool asyncCompute = false; // used by an async compute pass, shared by both queues
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::vector<RenderGraphAccess> accesses;
+        ExecuteFunction execute;
+        bool sideEffects = false;
+        bool parallelRecording = false;
+        RenderGraphQueue queue = RenderGraphQueue::Graphics;
+        std::vector<uint32_t> dependencies; // passes added before it
+
+        // Compiled
+        bool culled = false;
+        std::vector<RenderGraphBarrier> barriers; // before the pass, none for subpasses
+        uint32_t renderPass = k_unused; // its first pass if the pass has attachments
+        uint32_t subpass = 0;           // in that render pass
+        uint32_t batch = k_unused;
+    };
+
+    static constexpr uint32_t k_unused = std::numeric_limits<uint32_t>::max();
+
+   private:
+    friend class RenderGraphBuilder;
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+
+    std::vector<uint32_t> m_executionOrder;
+    std::vector<RenderGraphBatch> m_batches;
+    std::vector<RenderGraphBarrier> m_finalBarriers;
+    size_t m_heapSize = 0;
+    size_t m_heapAlignment = 1;
+    bool m_compiled = false;
+
+   public:
+    RenderGraph() = default;
+
+   public:
+    /**
+     * @brief A texture the graph does not own (the swapchain image, history buffers...): never
+     * aliased, in _initialAccess when the graph starts and left in _finalAccess.
+     */
+    RenderGraphResource importTexture(const std::string& _name,
+                                      const TextureDescription& _description,
+                                      ResourceAccess _initialAccess,
+                                      ResourceAccess _finalAccess);
+
+    /// The index of the pass, for RenderGraphBuilder::dependOn().
+    uint32_t addPass(const std::string& _name, const SetupFunction& _setup,
+                     ExecuteFunction _execute);
+
+    /// A new size (or format) of a texture, such as the backbuffer after a resize; compile again.
+    void setDescription(RenderGraphResource _resource, const TextureDescription& _description);
+
+    /**
+     * @brief Culls, computes the barriers and the placement of the transients.
+     *
+     * @throws std::invalid_argument If a pass reads a transient no earlier pass wrote, or an
+     * async compute pass uses an attachment or an imported texture.
+     */
+    void compile(const MemoryRequirementsFunction& _requirements = {});
+
+    /// Removes every pass and texture.
+    void reset() noexcept;
+
+    [[nodiscard]] bool isCompiled() const noexcept { return m_compiled; }
+
+    [[nodiscard]] std::span<const Resource> getResources() const noexcept { return m_resources; }
+    [[nodiscard]] const Resource& getResource(RenderGraphResource _resource) const
+    {
+        return m_resources.at(_resource.id);
+    }
+
+    [[nodiscard]] std::span<const Pass> getPasses() const noexcept { return m_passes; }
+
+    /// The passes not culled, in the order they run.
+    [[nodiscard]] std::span<const uint32_t> getExecutionOrder() const noexcept
+    {
+        return m_executionOrder;
+    }
+
+    /// The execution order by queue, a single graphics batch without async compute passes.
+    [[nodiscard]] std::span<const RenderGraphBatch> getBatches() const noexcept
+    {
+        return m_batches;
+    }
+
+    [[nodiscard]] bool hasAsyncCompute() const noexcept
+    {
+        return std::ranges::any_of(m_batches, [](const RenderGraphBatch& _batch)
+                                   { return _batch.queue == RenderGraphQueue::AsyncCompute; });
+    }
+
+    /// Transitions of the imported textures to their final access, after the last pass (and the
+    /// last async compute batch).
+    [[nodiscard]] std::span<const RenderGraphBarrier> getFinalBarriers() const noexcept
+    {
+        return m_finalBarriers;
+    }
+
+    /// Bytes of the memory every transient is placed in, and its alignment.
+    [[nodiscard]] size_t getHeapSize() const noexcept { return m_heapSize; }
+    [[nodiscard]] size_t getHeapAlignment() const noexcept { return m_heapAlignment; }
+
+    [[nodiscard]] static bool isWriteAccess(ResourceAccess _access) noexcept;
+    [[nodiscard]] static bool isAttachmentAccess(ResourceAccess _access) noexcept;
+
+   private:
+    RenderGraphResource addResource(Resource&& _resource);
+    void addAccess(uint32_t _pass, RenderGraphResource _resource, ResourceAccess _access,
+                   AttachmentLoad _load);
+
+    void cullPasses();
+    void mergeSubpasses();
+    void computeBarriers();
+    void buildBatches();
+    void placeTransients(const MemoryRequirementsFunction& _requirements);
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mosaic/defines.hpp"
+
+#include "present_mode.hpp"
+#include "resolution_scaler.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+class CommandLineParser;
+} // namespace core
+
+namespace graphics
+{
+
+// The defaults of the render profiles, those of the build (getBuildRenderProfileType()) unless
+// the command line or the application asks for another.
+enum class RenderProfileType : uint8_t
+{
+    Release,     // the fast path: no validation, no labels and no checks of the draws
+    Development, // the labels and object names of the captures, the draws checked
+    Debug        // everything, the validation layer too
+};
+
+/**
+ * @brief What the render system and its contexts pay for at runtime. The validation is set on
+ * the device as the render system initializes, the rest for each context it creates.
+ */
+struct RenderProfile
+{
+    bool validation = false;  // the API's validation layer (Dawn's own) and its messages
+    bool debugLabels = false; // the passes labelled and the objects named, for captures
+    bool checks = false;      // the handles of each draw checked before it is recorded
+    uint32_t backbufferCount = 0; // the swapchain images, 0 for the device's minimum plus one
+    uint32_t framesInFlight = 2;  // recorded by the CPU while the GPU renders the previous ones
+    PresentPolicy presentPolicy = PresentPolicy::LowLatency;
+
+    // the scene rendered at the scale holding its GPU time within resolution.frameBudget
+    bool dynamicResolution = false;
+    ResolutionScalerSettings resolution;
+};
+
+[[nodiscard]] MOSAIC_API RenderProfile makeRenderProfile(RenderProfileType _type) noexcept;
+
+// Debug in debug builds, Development in dev builds, Release otherwise.
+[[nodiscard]] MOSAIC_API RenderProfileType getBuildRenderProfileType() noexcept;
+
+[[nodiscard]] MOSAIC_API std::optional<RenderProfileType> parseRenderProfileType(
+    std::string_view _name) noexcept;
+
+[[nodiscard]] MOSAIC_API const char* getRenderProfileTypeName(RenderProfileType _type) noexcept;
+
+/**
+ * @brief The profile the render systems are created with: that of the build, as changed by the
+ * options of registerRenderProfileOptions(), which the application may replace before it
+ * initializes the render system (RenderSystem::setProfile()).
+ */
+[[nodiscard]] MOSAIC_API RenderProfile& getDefaultRenderProfile() noexcept;
+
+/**
+ * @brief The options setting _profile as the command line is parsed: --render-profile
+ * (release, development or debug, the backbuffer count kept) and --backbuffers.
+ */
+MOSAIC_API std::optional<std::string> registerRenderProfileOptions(
+    core::CommandLineParser& _parser, RenderProfile& _profile);
+
+/**
+ * @brief The swapchain images of _requested, 0 for one more than the surface's minimum (a
+ * frame queued while one is shown and one rendered), within the surface's limits (_max 0 when
+ * it has none).
+ */
+[[nodiscard]] MOSAIC_API uint32_t chooseBackbufferCount(uint32_t _requested, uint32_t _min,
+                                                        uint32_t _max) noexcept;
+
+} // namespace graphics
+} // namespace mosaic
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 
 #include <pieces/core/result.hpp>
 
@@ -10,6 +11,7 @@
 #include "mosaic/core/system.hpp"
 
 #include "render_context.hpp"
+#include "render_profile.hpp"
 
 namespace mosaic
 {
@@ -47,15 +49,46 @@ class MOSAIC_API RenderSystem : public core::EngineSystem
     virtual pieces::RefResult<core::System, std::string> initialize() override = 0;
     virtual void shutdown() override = 0;
 
+    /**
+     * @brief The validation, labels, checks and backbuffers of the device and of the contexts
+     * created next, getDefaultRenderProfile() until set. The validation takes effect only when
+     * set before initialize().
+     */
+    void setProfile(const RenderProfile& _profile);
+    [[nodiscard]] const RenderProfile& getProfile() const;
+
+    // The dynamic resolution cap of every context and of those created next, 1 until set
+    void setResolutionLimit(float _limit);
+    [[nodiscard]] float getResolutionLimit() const;
+
     pieces::Result<RenderContext*, std::string> createContext(const window::Window* _window);
     void destroyContext(const window::Window* _window);
 
+    /**
+     * @brief A context without a window, rendering to offscreen images of _extent that are never
+     * presented: GPU benchmarks and CI runs without a display. The render system may have been
+     * initialized without a window (headless Vulkan device). With _exportFrames the images are
+     * shared with another process, the viewport of the editor (RenderContext::exportFrames()).
+     */
+    pieces::Result<RenderContext*, std::string> createHeadlessContext(glm::uvec2 _extent,
+                                                                      bool _exportFrames = false);
+    void destroyHeadlessContext(RenderContext* _context);
+
     void destroyAllContexts();
 
+    // Before the input of the frame is sampled, see RenderContext::pace()
+    void pace();
     pieces::RefResult<core::System, std::string> update() override;
 
+    // The oldest input the next frames consume, see RenderContext::consumeInput()
+    void consumeInput(InputLatency::Clock::time_point _input);
+
     RenderContext* getContext(const window::Window* _window) const;
 
+   protected:
+    // The frame of each context, rendered one after another unless the backend batches them
+    virtual void renderContexts(std::span<RenderContext* const> _contexts);
+
     [[nodiscard]] static inline RenderSystem* getInstance()
     {
         if (!g_instance) MOSAIC_ERROR("RenderSystem has not been created yet!");
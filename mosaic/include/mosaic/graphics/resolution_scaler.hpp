@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "mosaic/defines.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+struct ResolutionScalerSettings
+{
+    std::chrono::nanoseconds frameBudget = std::chrono::nanoseconds(16'666'667); // 60 fps
+    float minScale = 0.5f; // of the width and height of the output
+    float maxScale = 1.0f;
+    float scaleStep = 0.05f; // the scales are multiples of it: each a new target to allocate
+    float headroom = 0.85f;  // of the budget, the GPU time below which the scale goes up
+    uint32_t upscaleFrames = 60; // measured in a row below the headroom before it does
+    uint32_t settleFrames = 4;   // ignored after a change, still rendered at the last scale
+};
+
+/**
+ * @brief Drives the scale the scene is rendered at from the GPU time of the frames, to hold
+ * them within a budget (the GPU slowing down under thermal throttling) instead of dropping
+ * to the next vsync interval.
+ *
+ * The GPU time is taken to follow the pixels, the square of the scale: a frame over the budget
+ * lowers the scale at once to what fits it, then the scale climbs a step at a time once the
+ * frames have kept below the headroom for a while. The measures of the frames in flight at the
+ * last scale are left out after each change.
+ */
+class MOSAIC_API ResolutionScaler final
+{
+   private:
+    ResolutionScalerSettings m_settings;
+
+    float m_scale;
+    float m_limit = 1.0f; // over the maximum scale, see setLimit
+    std::chrono::nanoseconds m_gpuTime = {}; // smoothed, at the current scale
+    uint32_t m_framesBelow = 0;
+    uint32_t m_framesToSettle = 0;
+
+   public:
+    explicit ResolutionScaler(const ResolutionScalerSettings& _settings = {});
+
+   public:
+    /// The GPU time of a completed frame; returns the scale of the next frames.
+    float update(std::chrono::nanoseconds _gpuTime) noexcept;
+
+    /**
+     * @brief Caps the scale below the maximum of the settings while the device runs hot, the
+     * scale dropping to it at once if above. Raising it lets the scale climb back a step at a time.
+     */
+    void setLimit(float _limit) noexcept;
+
+    [[nodiscard]] float getScale() const noexcept { return m_scale; }
+    [[nodiscard]] float getLimit() const noexcept { return m_limit; }
+    [[nodiscard]] std::chrono::nanoseconds getGpuTime() const noexcept { return m_gpuTime; }
+    [[nodiscard]] const ResolutionScalerSettings& getSettings() const noexcept
+    {
+        return m_settings;
+    }
+
+    /// _extent at _scale, each side at least 1 texel.
+    [[nodiscard]] static glm::uvec2 getScaledExtent(glm::uvec2 _extent, float _scale) noexcept;
+
+   private:
+    // _scale to a multiple of the step, down, within the settings
+    [[nodiscard]] float quantize(float _scale) const noexcept;
+    void setScale(float _scale) noexcept;
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+enum class ResourceType : uint8_t
+{
+    Buffer,
+    Texture,
+    Sampler
+};
+
+/**
+ * @brief Generational handle to a resource of a ResourcePool: its slot in the low bits, which is
+ * also the index of its descriptor the shaders read it through, and the generation of the slot
+ * in the high bits, so a handle to a released resource never resolves to the one reusing it.
+ */
+template <ResourceType Type>
+struct GenerationalHandle
+{
+    static constexpr uint32_t k_indexBits = 20;
+    static constexpr uint32_t k_indexMask = (1u << k_indexBits) - 1;
+    static constexpr uint32_t k_generationMask = (1u << (32 - k_indexBits)) - 1;
+    static constexpr uint32_t k_invalid = std::numeric_limits<uint32_t>::max();
+
+    uint32_t value = k_invalid;
+
+    [[nodiscard]] static constexpr GenerationalHandle make(uint32_t _index, uint32_t _generation)
+    {
+        return {((_generation & k_generationMask) << k_indexBits) | (_index & k_indexMask)};
+    }
+
+    [[nodiscard]] constexpr uint32_t getIndex() const noexcept { return value & k_indexMask; }
+    [[nodiscard]] constexpr uint32_t getGeneration() const noexcept
+    {
+        return value >> k_indexBits;
+    }
+
+    [[nodiscard]] constexpr bool isValid() const noexcept { return value != k_invalid; }
+
+    constexpr bool operator==(const GenerationalHandle&) const = default;
+};
+
+using BufferHandle = GenerationalHandle<ResourceType::Buffer>;
+using TextureHandle = GenerationalHandle<ResourceType::Texture>;
+using SamplerHandle = GenerationalHandle<ResourceType::Sampler>;
+
+/**
+ * @brief The resources of a type a backend registered, in at most _capacity slots (the size of
+ * its descriptor array).
+ *
+ * A released slot is retired until recycle() is told the frames that might still read its
+ * descriptor completed, then reused with the next generation.
+ */
+template <typename Resource, ResourceType Type>
+class ResourcePool final
+{
+   public:
+    using Handle = GenerationalHandle<Type>;
+
+   private:
+    struct Slot
+    {
+        Resource resource{};
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeList;
+    std::vector<std::pair<uint64_t, uint32_t>> m_retired; // frame released at, slot
+    uint32_t m_capacity;
+    uint32_t m_aliveCount = 0;
+
+   public:
+    explicit ResourcePool(uint32_t _capacity = Handle::k_indexMask)
+        : m_capacity(std::min(_capacity, Handle::k_indexMask)){};
+
+   public:
+    /// An invalid handle when every slot is alive or retired.
+    [[nodiscard]] Handle allocate(const Resource& _resource)
+    {
+        uint32_t index;
+
+        if (!m_freeList.empty())
+        {
+            index = m_freeList.back();
+            m_freeList.pop_back();
+        }
+        else if (m_slots.size() < m_capacity)
+        {
+            index = static_cast<uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        }
+        else
+        {
+            return {};
+        }
+
+        Slot& slot = m_slots[index];
+        slot.resource = _resource;
+        slot.alive = true;
+        ++m_aliveCount;
+
+        return Handle::make(index, slot.generation);
+    }
+
+    /// The handle is no longer valid, its slot reused once _frame completed.
+    bool release(Handle _handle, uint64_t _frame)
+    {
+        Slot* slot = find(_handle);
+        if (!slot) return false;
+
+        slot->alive = false;
+        slot->generation = (slot->generation + 1) & Handle::k_generationMask;
+        --m_aliveCount;
+
+        m_retired.emplace_back(_frame, _handle.getIndex());
+
+        return true;
+    }
+
+    /// The slots released at or before _completedFrame become free.
+    void recycle(uint64_t _completedFrame)
+    {
+        std::erase_if(m_retired,
+                      [&](const std::pair<uint64_t, uint32_t>& _retired)
+                      {
+                          if (_retired.first > _completedFrame) return false;
+
+                          m_freeList.push_back(_retired.second);
+                          return true;
+                      });
+    }
+
+    [[nodiscard]] Resource* get(Handle _handle)
+    {
+        Slot* slot = find(_handle);
+        return slot ? &slot->resource : nullptr;
+    }
+
+    [[nodiscard]] const Resource* get(Handle _handle) const
+    {
+        return const_cast<ResourcePool*>(this)->get(_handle);
+    }
+
+    [[nodiscard]] bool isValid(Handle _handle) const { return get(_handle) != nullptr; }
+
+    [[nodiscard]] uint32_t size() const noexcept { return m_aliveCount; }
+    [[nodiscard]] uint32_t capacity() const noexcept { return m_capacity; }
+
+    /// Calls _function(handle, resource) for every alive resource.
+    template <typename Function>
+    void forEach(Function&& _function) const
+    {
+        for (uint32_t i = 0; i < m_slots.size(); ++i)
+        {
+            const Slot& slot = m_slots[i];
+            if (slot.alive) _function(Handle::make(i, slot.generation), slot.resource);
+        }
+    }
+
+   private:
+    [[nodiscard]] Slot* find(Handle _handle)
+    {
+        if (!_handle.isValid() || _handle.getIndex() >= m_slots.size()) return nullptr;
+
+        Slot& slot = m_slots[_handle.getIndex()];
+        return slot.alive && slot.generation == _handle.getGeneration() ? &slot : nullptr;
+    }
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace mosaic
 {
@@ -11,7 +13,18 @@ enum class ShaderStage
 {
     Vertex,
     Fragment,
-    Compute
+    Compute,
+    Task, // VK_EXT_mesh_shader, Vulkan only
+    Mesh
+};
+
+// A 32-bit specialization constant of the shader (a bool, an int or a float bit pattern)
+struct SpecializationConstant
+{
+    uint32_t id; // constant_id in the GLSL
+    uint32_t value;
+
+    constexpr bool operator==(const SpecializationConstant&) const noexcept = default;
 };
 
 struct ShaderDescription
@@ -20,6 +33,7 @@ struct ShaderDescription
     std::vector<uint8_t> bytecode;
     std::string entryPoint = "main";
     std::string debugName;
+    std::vector<SpecializationConstant> specialization; // folded when the pipeline is created
 };
 
 } // namespace graphics
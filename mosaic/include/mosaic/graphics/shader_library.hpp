@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/task_future.hpp"
+
+#include "shader.hpp"
+#include "shader_variant.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+/**
+ * @brief Where the GLSL sources of the watched SPIR-V are, and how to compile them: the source of
+ * "bin/triangle.vert.spv" is "triangle.vert" in sourceDirectory.
+ */
+struct ShaderHotReload
+{
+    std::filesystem::path sourceDirectory; // empty: only the SPIR-V files are watched
+    std::string compiler = "glslc";        // run as: compiler "source" -o "spirv"
+    std::chrono::milliseconds interval = std::chrono::milliseconds(250); // between the polls
+};
+
+/**
+ * @brief The SPIR-V shaders of the application, each file memory-mapped and read once, with the
+ * FNV-1a hash of its bytecode (the key the backends cache their shader modules by).
+ *
+ * With hot reload (desktop only) update() polls the files: a SPIR-V file written since it was
+ * read, or a source newer than it, is compiled and read again on an exec::ThreadPool worker,
+ * then replaces the description in the next update() that sees it done. The frames keep the old
+ * shader meanwhile, and for good if the new one fails to compile or to reflect.
+ */
+class MOSAIC_API ShaderLibrary final
+{
+   public:
+    using Clock = std::chrono::steady_clock;
+
+   private:
+    struct Entry
+    {
+        ShaderDescription description;
+        uint64_t hash = 0;
+        std::filesystem::file_time_type writeTime; // of the SPIR-V read last
+        std::filesystem::file_time_type sourceTime; // of the source compiled last
+        bool reloading = false;
+    };
+
+    // Of a reload done by a worker, applied by update()
+    struct Reload
+    {
+        std::string path;
+        std::optional<std::vector<uint8_t>> bytecode; // none if it failed
+        std::filesystem::file_time_type writeTime;
+        std::filesystem::file_time_type sourceTime;
+    };
+
+    std::unordered_map<std::string, std::unique_ptr<Entry>> m_entries; // by path
+
+    std::optional<ShaderHotReload> m_hotReload;
+    Clock::time_point m_nextPoll = {};
+    uint64_t m_generation = 0;
+
+    std::mutex m_reloadMutex;
+    std::vector<Reload> m_reloads; // done, not applied yet
+    std::vector<exec::TaskFuture<void>> m_reloadTasks;
+
+   public:
+    ShaderLibrary() = default;
+    ~ShaderLibrary();
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+   public:
+    /**
+     * @brief The shader of a SPIR-V file (an asset on Android), read by the first call only. The
+     * reference lives as long as the library, its content replaced by the reloads.
+     *
+     * @throws std::runtime_error if the file cannot be read.
+     */
+    const ShaderDescription& load(ShaderStage _stage, const std::filesystem::path& _path);
+
+    /**
+     * @brief The shader specialized for the features of the key: its permutation compiled
+     * offline if shipped (getShaderVariantPath(), loaded and reloaded as its own file), else the
+     * shader of _path with the specialization constants of the key. load() for the key 0.
+     *
+     * @throws std::runtime_error if the shader cannot be read.
+     */
+    ShaderDescription loadVariant(ShaderStage _stage, const std::filesystem::path& _path,
+                                  ShaderVariantKey _key);
+
+    // The FNV-1a hash of the bytecode of a loaded shader, 0 if none
+    [[nodiscard]] uint64_t getHash(const std::filesystem::path& _path) const;
+
+    // Watched by update() from now on, until disableHotReload()
+    void enableHotReload(const ShaderHotReload& _hotReload);
+
+    // Waits for the reloads in flight (before the thread pool shuts down), left unapplied
+    void disableHotReload();
+    [[nodiscard]] bool isHotReloadEnabled() const noexcept { return m_hotReload.has_value(); }
+
+    /**
+     * @brief At a frame boundary, on the thread that loads: applies the reloads done since the
+     * last call, then starts those of the files changed since the last poll.
+     *
+     * @return the paths of the shaders replaced, the generation bumped if any.
+     */
+    std::vector<std::filesystem::path> update(Clock::time_point _now = Clock::now());
+
+    // Bumped by every update() that replaced a shader: the users build their pipelines again
+    [[nodiscard]] uint64_t getGeneration() const noexcept { return m_generation; }
+
+   private:
+    void reload(const std::string& _path, bool _compile);
+};
+
+} // namespace graphics
+} // namespace mosaic
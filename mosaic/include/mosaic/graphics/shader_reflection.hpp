@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+
+#include "shader.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+enum class ShaderResourceType : uint8_t
+{
+    UniformBuffer,
+    StorageBuffer,
+    SampledImage,
+    StorageImage,
+    Sampler,
+    CombinedImageSampler,
+    AccelerationStructure
+};
+
+struct ShaderBinding
+{
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    uint32_t count = 1; // of the array, 0 for a runtime array (bindless)
+    ShaderResourceType type = ShaderResourceType::UniformBuffer;
+    std::string name;
+};
+
+/**
+ * @brief What a pipeline layout needs from a SPIR-V module: the descriptor bindings it declares,
+ * the size of its push constant block and, for compute, its workgroup size.
+ */
+struct ShaderReflection
+{
+    std::optional<ShaderStage> stage; // of the entry point, none for the stages not supported
+    std::vector<ShaderBinding> bindings; // by set, then binding
+    uint32_t pushConstantSize = 0; // up to the end of the last member, 0 without a block
+    std::array<uint32_t, 3> localSize = {0, 0, 0};
+};
+
+/**
+ * @brief Reflects the entry point _entryPoint of a SPIR-V module from its instructions (no
+ * compiler in the loop), the bindings of every descriptor of the module.
+ *
+ * Fails on anything that is not a well formed module with that entry point.
+ */
+MOSAIC_API pieces::Result<ShaderReflection, std::string> reflectShader(
+    std::span<const uint8_t> _spirv, std::string_view _entryPoint = "main");
+
+} // namespace graphics
+} // namespace mosaic
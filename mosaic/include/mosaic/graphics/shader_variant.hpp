@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+#include "shader.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+constexpr uint32_t k_maxShaderFeatures = 32;
+
+/**
+ * @brief The features of a material a shader is specialized for, one bit each: bit k is the
+ * bool specialization constant of constant_id k (false by default), so the branches on it fold
+ * when the pipeline is created. A permutation compiled offline for the key (MOSAIC_VARIANT
+ * defined to it, see scripts/compile_shaders.sh) replaces the specialization where it is shipped.
+ *
+ * Made at compile time from the feature enum of the shader:
+ *
+ *   enum class TriangleFeature : uint32_t { Grayscale };
+ *   constexpr ShaderVariantKey k_gray = makeShaderVariantKey({TriangleFeature::Grayscale});
+ */
+struct ShaderVariantKey
+{
+    uint32_t features = 0;
+
+    [[nodiscard]] constexpr bool has(uint32_t _feature) const noexcept
+    {
+        return (features >> _feature & 1u) != 0;
+    }
+
+    constexpr bool operator==(const ShaderVariantKey&) const noexcept = default;
+};
+
+template <typename Feature>
+    requires std::is_enum_v<Feature>
+[[nodiscard]] constexpr ShaderVariantKey makeShaderVariantKey(
+    std::initializer_list<Feature> _features) noexcept
+{
+    ShaderVariantKey key;
+    for (const Feature feature : _features)
+    {
+        key.features |= 1u << static_cast<uint32_t>(feature);
+    }
+    return key;
+}
+
+/**
+ * @brief Where the permutation of the key is compiled to: "shaders/bin/triangle.frag.spv" with
+ * the key 0x5 is "shaders/bin/triangle.frag.5.spv" (hexadecimal), the path itself for the key 0.
+ */
+MOSAIC_API std::filesystem::path getShaderVariantPath(const std::filesystem::path& _path,
+                                                      ShaderVariantKey _key);
+
+// A constant of value 1 per feature of the key, by increasing id: the others keep their default
+MOSAIC_API std::vector<SpecializationConstant> getSpecializationConstants(ShaderVariantKey _key);
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+
+#include "frustum_culling.hpp"
+#include "gpu_culling.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+inline constexpr uint32_t k_maxShadowCascades = 4;
+
+struct ShadowCascadeSettings
+{
+    uint32_t cascadeCount = 4;  // 1 to k_maxShadowCascades
+    uint32_t resolution = 2048; // texels on a side of a cascade map
+    float distance = 80.0f;     // the view depth the last cascade ends at
+    float splitLambda = 0.8f;   // the splits from uniform (0) to logarithmic (1)
+
+    // How far past its split a cascade reaches, in fractions of its radius: the distance the
+    // camera moves before the static casters of the cascade are redrawn
+    float refitMargin = 0.2f;
+
+    // The radians the light turns before every static cascade is redrawn
+    float refitAngle = 0.01f;
+};
+
+/**
+ * @brief A cascade of a frame: its light projection, where it is sampled, and whether its cached
+ * static depth is stale.
+ */
+struct ShadowCascade
+{
+    // World to the clip space of the cascade, column-major, [0, 1] depth toward the light
+    std::array<float, 16> viewProjection = {};
+
+    // The planes casters are culled against, the near one open toward the light: the shadow pass
+    // clamps depth (depthClampEnable, unclippedDepth) so casters in front of it are flattened on it
+    Frustum casterFrustum;
+
+    float splitDepth = 0.0f; // the view depth the cascade is sampled up to
+    float texelSize = 0.0f;  // world units, for normal offset biasing
+
+    bool redrawStatic = false; // the static casters must be drawn into the cache this frame
+};
+
+/**
+ * @brief What the lighting shaders sample the cascades with (std140 and std430): the first cascade
+ * whose split depth is past the fragment's, its uv clip.xy * 0.5 + 0.5 of viewProjection.
+ */
+struct ShadowUniforms
+{
+    std::array<std::array<float, 16>, k_maxShadowCascades> viewProjection = {};
+    std::array<float, k_maxShadowCascades> splitDepths = {};
+    std::array<float, k_maxShadowCascades> texelSizes = {};
+    uint32_t cascadeCount = 0;
+    uint32_t padding[3] = {};
+};
+
+static_assert(sizeof(ShadowUniforms) == 304, "ShadowUniforms is read by the lighting shaders");
+
+/**
+ * @brief Cascaded shadow maps of a directional light that keep the depth of the static casters
+ * from frame to frame: drawing every caster into every cascade each frame is what mobile cannot
+ * afford, and the static ones rarely need it.
+ *
+ * A cascade covers the sphere around the camera its split reaches, enlarged by refitMargin and
+ * snapped to its texels, so turning the camera never moves it and moving it by less than the
+ * margin does not either. The static casters are only culled and redrawn when a cascade is refit
+ * (the camera left its margin, the light turned past refitAngle) or invalidated. The backend keeps
+ * a static depth layer per cascade: when redrawStatic is set it clears it and draws
+ * getStaticCasters() into it, then each frame copies it into the shadow map and draws
+ * getDynamicCasters() on top. The casters are culled with the cullSpheres() kernels, the cascades
+ * in parallel on the pool.
+ */
+class MOSAIC_API ShadowCascades final
+{
+   private:
+    // What a cascade keeps from frame to frame
+    struct Cache
+    {
+        float radius = 0.0f; // of the sphere around the camera its split reaches
+        float extent = 0.0f; // half the side of its box, 0 until fit
+        std::array<float, 3> center = {}; // light space: right, up, along the light
+        bool staticDirty = true;
+
+        std::vector<uint32_t> staticCasters;
+        std::vector<uint32_t> dynamicCasters;
+    };
+
+    ShadowCascadeSettings m_settings;
+    uint32_t m_cascadeCount = 0;
+
+    // The light space basis, rebuilt when the light turns past refitAngle
+    std::array<float, 3> m_lightDirection = {};
+    std::array<float, 3> m_lightRight = {};
+    std::array<float, 3> m_lightUp = {};
+    bool m_hasLight = false;
+
+    std::array<ShadowCascade, k_maxShadowCascades> m_cascades;
+    std::array<Cache, k_maxShadowCascades> m_caches;
+    ShadowUniforms m_uniforms;
+
+   public:
+    ShadowCascades() = default;
+
+   public:
+    /**
+     * @brief Splits the view of a symmetric perspective projection of _p00, _p11
+     * (projection[0][0], [1][1]) from _zNear to _settings.distance, and drops the cached cascades.
+     *
+     * @throws std::invalid_argument if the settings or the projection are out of range.
+     */
+    void setProjection(const ShadowCascadeSettings& _settings, float _p00, float _p11,
+                       float _zNear);
+
+    /**
+     * @brief Refits the cascades that no longer cover the camera at _cameraPosition lit along
+     * _lightDirection (the direction the light travels, normalized here), culls the static casters
+     * of the ones to redraw and the dynamic casters of all. Does nothing before setProjection().
+     */
+    void update(exec::ThreadPool& _pool, const std::array<float, 3>& _cameraPosition,
+                const std::array<float, 3>& _lightDirection, const SphereColumns& _staticCasters,
+                const SphereColumns& _dynamicCasters);
+
+    /// Same as above on the calling thread.
+    void update(const std::array<float, 3>& _cameraPosition,
+                const std::array<float, 3>& _lightDirection, const SphereColumns& _staticCasters,
+                const SphereColumns& _dynamicCasters);
+
+    /// Redraws the static casters of every cascade next update(): static geometry added or removed.
+    void invalidateStatic() noexcept;
+
+    /// Same as above for the cascades _bounds touches: call it with the old and new bounds of a
+    /// static caster that moved.
+    void invalidateStatic(const BoundingSphere& _bounds) noexcept;
+
+    [[nodiscard]] std::span<const ShadowCascade> getCascades() const noexcept
+    {
+        return {m_cascades.data(), m_cascadeCount};
+    }
+
+    // The indices of the static casters of a cascade, empty unless its redrawStatic is set
+    [[nodiscard]] std::span<const uint32_t> getStaticCasters(uint32_t _cascade) const noexcept
+    {
+        return m_caches[_cascade].staticCasters;
+    }
+
+    [[nodiscard]] std::span<const uint32_t> getDynamicCasters(uint32_t _cascade) const noexcept
+    {
+        return m_caches[_cascade].dynamicCasters;
+    }
+
+    [[nodiscard]] const ShadowUniforms& getUniforms() const noexcept { return m_uniforms; }
+
+   private:
+    void fit(const std::array<float, 3>& _cameraPosition,
+             const std::array<float, 3>& _lightDirection);
+    void fitCascade(uint32_t _cascade, const std::array<float, 3>& _camera);
+    void cull(uint32_t _task, const SphereColumns& _staticCasters,
+              const SphereColumns& _dynamicCasters);
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace mosaic
 {
@@ -10,7 +13,19 @@ namespace graphics
 enum class TextureFormat
 {
     RGBA8,
-    Depth24Stencil8
+    BGRA8,
+    RGBA16F,
+    R32UI, // integer render targets: entity IDs
+    Depth24Stencil8,
+    Depth32F,
+    // Block compressed, sampled only: 4x4 texel blocks
+    BC1,       // RGB, 1-bit alpha, 8 bytes a block (desktop)
+    BC3,       // RGBA, 16 bytes (desktop)
+    BC5,       // RG, normal maps, 16 bytes (desktop)
+    BC7,       // RGBA, 16 bytes (desktop)
+    ETC2RGB8,  // RGB, 8 bytes (mobile)
+    ETC2RGBA8, // RGBA, 16 bytes (mobile)
+    ASTC4x4    // RGBA, 16 bytes (mobile, some desktops)
 };
 
 enum class TextureUsage
@@ -29,7 +44,70 @@ struct TextureDescription
     TextureUsage usage;
     bool cpuReadable = false;
     std::string debugName;
+    uint32_t samples = 1; // MSAA, render targets only
 };
 
+// A level of a TextureMipChain, tightly packed texels (or blocks) at offset in its texels
+struct TextureMip
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+// The mips of a decoded texture from firstMip to the last (1x1) one
+struct TextureMipChain
+{
+    TextureFormat format = TextureFormat::RGBA8;
+    bool srgb = true; // color data, else linear (normal maps, masks)
+    uint32_t firstMip = 0;
+    std::vector<TextureMip> mips;
+    std::vector<uint8_t> texels;
+};
+
+// The texels of a format are stored by blocks, a texel a block for the uncompressed ones
+struct TextureFormatInfo
+{
+    uint32_t blockExtent = 1;
+    uint32_t bytesPerBlock = 4;
+};
+
+constexpr TextureFormatInfo getTextureFormatInfo(TextureFormat _format) noexcept
+{
+    switch (_format)
+    {
+        case TextureFormat::RGBA16F:
+            return {1, 8};
+        case TextureFormat::BC1:
+        case TextureFormat::ETC2RGB8:
+            return {4, 8};
+        case TextureFormat::BC3:
+        case TextureFormat::BC5:
+        case TextureFormat::BC7:
+        case TextureFormat::ETC2RGBA8:
+        case TextureFormat::ASTC4x4:
+            return {4, 16};
+        default:
+            return {1, 4};
+    }
+}
+
+constexpr bool isCompressed(TextureFormat _format) noexcept
+{
+    return getTextureFormatInfo(_format).blockExtent > 1;
+}
+
+// The bytes of a _width x _height mip, partial blocks included
+constexpr uint64_t getTextureMipSize(TextureFormat _format, uint32_t _width,
+                                     uint32_t _height) noexcept
+{
+    const TextureFormatInfo info = getTextureFormatInfo(_format);
+    const uint64_t blocksX = (uint64_t{_width} + info.blockExtent - 1) / info.blockExtent;
+    const uint64_t blocksY = (uint64_t{_height} + info.blockExtent - 1) / info.blockExtent;
+
+    return blocksX * blocksY * info.bytesPerBlock;
+}
+
 } // namespace graphics
 } // namespace mosaic
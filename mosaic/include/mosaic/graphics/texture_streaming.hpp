@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/defines.hpp"
+
+#include "texture.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The extent, full mip count and format of an encoded image, from its header: what
+// decodeTextureMips() gives for the same formats.
+MOSAIC_API pieces::Result<TextureDescription, std::string> readTextureDescription(
+    std::span<const uint8_t> _encoded, std::span<const TextureFormat> _supported = {});
+
+/**
+ * @brief Decodes an image to the mips from _firstMip on, without keeping the finer ones.
+ * Thread-safe: the decoding runs on the workers.
+ *
+ * A KTX2 file is read by decodeKtx2(), its mips compressed in a format of _supported (the formats
+ * the device samples). Any other image (PNG, JPEG, TGA, BMP...) is decoded to RGBA8 and
+ * downsampled in sRGB.
+ */
+MOSAIC_API pieces::Result<TextureMipChain, std::string> decodeTextureMips(
+    std::span<const uint8_t> _encoded, uint32_t _firstMip,
+    std::span<const TextureFormat> _supported = {});
+
+// The index of a texture and its residency in a TextureStreamer
+using StreamedTextureId = uint32_t;
+
+struct TextureStreamingSettings
+{
+    uint64_t budget = 256ull * 1024 * 1024; // of the resident mips, the device budget may lower it
+    uint64_t maxMipSize = UINT64_MAX;       // of one mip, the finer ones are never streamed
+    uint32_t tailExtent = 64;               // the mips no larger are always resident
+};
+
+// The mips a texture is to be streamed at: firstMip to the last, finer (a load) or coarser (an
+// eviction) than those resident
+struct TextureResidencyChange
+{
+    StreamedTextureId texture = 0;
+    uint32_t firstMip = 0;
+};
+
+/**
+ * @brief The residency policy of the streamed textures, backend-neutral: which mips of each
+ * texture should be resident under a memory budget, the backend loading them.
+ *
+ * A texture starts with its mip tail (the mips of at most tailExtent texels) only. Every frame
+ * the renderer reports the screen-space size each texture was drawn at (request()), and update()
+ * plans the changes: the textures drawn with coarser mips than their size needs are loaded finer
+ * ones, the most blurred first, as long as they fit in the budget. Once they no longer do, the
+ * least recently drawn textures are evicted down to their tail, then those drawn smaller than
+ * their resident mips down to the mips they need, until what is loaded fits.
+ *
+ * A texture has one change in flight at most; the memory of a change counts from when it is
+ * planned for a load, until it completed (onResident()) for an eviction: a load that needs the
+ * memory of an eviction waits for it.
+ */
+class MOSAIC_API TextureStreamer final
+{
+   private:
+    struct Texture
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 0;
+        TextureFormat format = TextureFormat::RGBA8;
+        uint32_t finestMip = 0;   // of at most maxMipSize
+        uint32_t tailMip = 0;     // of at most tailExtent, or finestMip
+        uint32_t residentMip = 0; // mipLevels while nothing is
+        uint32_t pendingMip = 0;  // residentMip without a change in flight
+        uint32_t requestedMip = 0;
+        uint64_t lastUse = 0; // the frame it was requested in last
+        bool queued = false;  // its tail not planned yet
+    };
+
+    TextureStreamingSettings m_settings;
+    std::vector<Texture> m_textures;
+    uint64_t m_budget;
+    uint64_t m_frame = 1;
+
+   public:
+    explicit TextureStreamer(const TextureStreamingSettings& _settings = {});
+
+   public:
+    // Loaded with its mip tail by the next update(), whatever the budget.
+    StreamedTextureId add(uint32_t _width, uint32_t _height, uint32_t _mipLevels,
+                          TextureFormat _format = TextureFormat::RGBA8);
+
+    // Drawn this frame at _screenExtent pixels across its largest side, the largest request wins.
+    void request(StreamedTextureId _texture, float _screenExtent);
+
+    // Of the device memory left to the textures, at most the budget of the settings.
+    void setBudget(uint64_t _budget) noexcept;
+    [[nodiscard]] uint64_t getBudget() const noexcept { return m_budget; }
+
+    /**
+     * @brief Once a frame, after the requests: plans the changes of residency, the evictions
+     * first, then starts the next frame.
+     */
+    std::vector<TextureResidencyChange> update();
+
+    // The change of the texture completed with _firstMip resident (the former mips if it failed).
+    void onResident(StreamedTextureId _texture, uint32_t _firstMip);
+
+    [[nodiscard]] uint32_t getResidentMip(StreamedTextureId _texture) const
+    {
+        return m_textures[_texture].residentMip;
+    }
+
+    // The bytes of the resident (and loading) mips of every texture
+    [[nodiscard]] uint64_t getCommittedSize() const noexcept;
+
+    [[nodiscard]] size_t getTextureCount() const noexcept { return m_textures.size(); }
+
+    // The bytes of the mips from _firstMip to the last
+    [[nodiscard]] static uint64_t getMipChainSize(uint32_t _width, uint32_t _height,
+                                                  uint32_t _mipLevels, uint32_t _firstMip,
+                                                  TextureFormat _format) noexcept;
+
+    // The mip of about a texel per pixel at _screenExtent pixels, the last one when not visible
+    [[nodiscard]] static uint32_t selectMip(uint32_t _width, uint32_t _height, uint32_t _mipLevels,
+                                            float _screenExtent) noexcept;
+
+   private:
+    [[nodiscard]] uint64_t getSize(const Texture& _texture, uint32_t _firstMip) const noexcept;
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+
+#include "draw_call.hpp"
+#include "draw_queue.hpp"
+#include "frame_ring.hpp"
+#include "glyph_atlas.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// A rectangle in pixels of the viewport, y down: x0, y0 its top left corner, x1, y1 past the end.
+struct UiRect
+{
+    float x0 = 0.0f;
+    float y0 = 0.0f;
+    float x1 = 0.0f;
+    float y1 = 0.0f;
+
+    [[nodiscard]] bool isEmpty() const noexcept { return !(x0 < x1) || !(y0 < y1); }
+};
+
+// RGBA8, red in the low byte: unpackUnorm4x8() in the shaders.
+[[nodiscard]] constexpr uint32_t packUiColor(uint8_t _r, uint8_t _g, uint8_t _b,
+                                             uint8_t _a = 255) noexcept
+{
+    return static_cast<uint32_t>(_r) | (static_cast<uint32_t>(_g) << 8) |
+           (static_cast<uint32_t>(_b) << 16) | (static_cast<uint32_t>(_a) << 24);
+}
+
+/**
+ * @brief A vertex of the 2D batch (std430), read by ui.vert from the frame ring at gl_VertexIndex:
+ * every primitive of a frame is in the same vertex stream, what it samples chosen per vertex.
+ */
+struct UiVertex
+{
+    static constexpr uint32_t k_solid = 0;
+    static constexpr uint32_t k_image = 1; // texture, a TextureHandle value
+    static constexpr uint32_t k_text = 2;  // layer of the glyph atlas, its distance field
+
+    std::array<float, 2> position = {}; // in pixels
+    std::array<float, 2> uv = {};
+    uint32_t color = 0; // packUiColor()
+    uint32_t texture = 0;
+    uint32_t layer = 0;
+    uint32_t mode = k_solid;
+};
+
+static_assert(sizeof(UiVertex) == 32, "UiVertex is read by the UI shaders");
+
+/**
+ * @brief An immediate-mode 2D batch (HUD, debug overlays, text): rectangles, images, lines and
+ * text are added in painter's order between begin() and emit(), and emit() draws them all with
+ * one indexed draw, its vertices and indices in the frame ring.
+ *
+ * Nothing breaks the batch: the images are bindless textures chosen per vertex, the glyphs of
+ * every font in the layers of one GlyphAtlas, and the clip rectangles are applied on the CPU (the
+ * primitives cut to them, their texture coordinates with them), so the draw needs no scissor.
+ */
+class MOSAIC_API UiBatcher final
+{
+   public:
+    // The slots of DrawCall::resources: emit() writes the first and the last, the caller the
+    // glyph atlas texture and the sampler of every texture
+    static constexpr uint32_t k_vertexResource = 0;   // the frame ring buffer's handle
+    static constexpr uint32_t k_atlasResource = 1;    // TextureHandle of the glyph atlas
+    static constexpr uint32_t k_samplerResource = 2;  // SamplerHandle, linear
+    static constexpr uint32_t k_viewportResource = 3; // width | height << 16, in pixels
+
+   private:
+    std::vector<UiVertex> m_vertices;
+    std::vector<uint32_t> m_indices;
+    std::vector<UiRect> m_clips; // the top one is the clip, intersected with those below
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+
+   public:
+    UiBatcher() = default;
+
+   public:
+    /// Drops the primitives of the last frame, the clip the whole _width x _height viewport.
+    void begin(uint32_t _width, uint32_t _height);
+
+    /// Clips what is added next to _rect, within the clip already pushed.
+    void pushClip(const UiRect& _rect);
+    void popClip();
+
+    void addRect(const UiRect& _rect, uint32_t _color);
+
+    /// _texture is a TextureHandle value, sampled between the corners of _uv.
+    void addImage(const UiRect& _rect, uint32_t _texture,
+                  const UiRect& _uv = {0.0f, 0.0f, 1.0f, 1.0f},
+                  uint32_t _color = packUiColor(255, 255, 255));
+
+    void addLine(float _x0, float _y0, float _x1, float _y1, float _thickness, uint32_t _color);
+
+    /**
+     * @brief UTF-8 _text at _size pixels in _font of _atlas, the top of its first line at _y; a
+     * '\n' starts a line. The glyphs not resident yet are advanced over. Returns the width of the
+     * longest line.
+     */
+    float addText(GlyphAtlas& _atlas, FontId _font, float _x, float _y, float _size,
+                  std::string_view _text, uint32_t _color);
+
+    /// The width of the longest line of _text, its glyphs requested as by addText().
+    [[nodiscard]] static float measureText(GlyphAtlas& _atlas, FontId _font, float _size,
+                                           std::string_view _text);
+
+    /**
+     * @brief Copies the vertices and indices into _ring and submits one DrawCallType::Indexed draw
+     * of them to _queue, completed from _call: its pipeline (ui.vert/ui.frag, alpha blended), its
+     * indexBuffer (the ring's buffer among the index buffers of the context), sortKey and the
+     * atlas and sampler resources. Returns the number of draws, none if empty or the ring is full.
+     */
+    uint32_t emit(FrameRing& _ring, DrawQueue& _queue, uint32_t _vertexBuffer,
+                  DrawCall _call) const;
+
+    [[nodiscard]] std::span<const UiVertex> getVertices() const noexcept { return m_vertices; }
+    [[nodiscard]] std::span<const uint32_t> getIndices() const noexcept { return m_indices; }
+    [[nodiscard]] UiRect getClip() const noexcept
+    {
+        return m_clips.empty() ? UiRect{} : m_clips.back();
+    }
+
+   private:
+    void addQuad(const UiRect& _rect, const UiRect& _uv, uint32_t _color, uint32_t _texture,
+                 uint32_t _layer, uint32_t _mode);
+    void addPolygon(std::span<const UiVertex> _vertices);
+};
+
+} // namespace graphics
+} // namespace mosaic
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <variant>
 #include <vector>
@@ -15,6 +17,14 @@ namespace input
 
 class InputContext;
 
+/**
+ * @brief The dense index of a registered action in its InputContext, returned by
+ * `registerActions()`: the ids of the unregistered actions are reused.
+ */
+using ActionId = uint32_t;
+
+constexpr ActionId k_invalidActionId = std::numeric_limits<ActionId>::max();
+
 /**
  * @brief Represents an action that can be triggered by user input.
  *
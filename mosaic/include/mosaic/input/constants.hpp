@@ -1,6 +1,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 
 namespace mosaic
 {
@@ -25,12 +27,29 @@ constexpr auto k_keyHoldMinDuration = std::chrono::milliseconds(35);
 // Sample rate for mouse wheel and cursor position data derivation
 constexpr auto k_inputSamplingRate = std::chrono::milliseconds(16);
 
+// Time constant of the exponentially weighted cursor and wheel speeds and accelerations
+constexpr auto k_motionSmoothingTime = std::chrono::milliseconds(50);
+
 // Number of samples to keep for mouse wheel scroll and cursor position to derive data
 constexpr auto k_mouseWheelNumSamples = 8;
 constexpr auto k_mouseCursorNumSamples = 16;
 
+// Touch pointers tracked at once, and the samples kept per pointer (a 240 Hz digitizer reports
+// 4 per frame at 60 Hz, the historical samples of its batches included)
+constexpr auto k_maxTouchPointers = 10;
+constexpr auto k_touchNumSamples = 32;
+
 // Maximum number of events to keep in the event history for all input types
 constexpr auto k_eventHistoryMaxSize = 8;
 
+// Raw events an input source queues between two frames, the ones past it are dropped (a 8 kHz
+// mouse fills about a hundred per frame at 60 Hz)
+constexpr auto k_rawEventQueueCapacity = 1024;
+
+// Input recordings: "MINR", the version of their format, and the bytes buffered between writes
+constexpr uint32_t k_inputRecordingMagic = 0x524E494D;
+constexpr uint32_t k_inputRecordingVersion = 2;
+constexpr size_t k_inputRecordingFlushSize = 64 * 1024;
+
 } // namespace input
 } // namespace mosaic
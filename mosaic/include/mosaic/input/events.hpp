@@ -8,6 +8,8 @@
 
 #include <pieces/utils/enum_flags.hpp>
 
+#include "mosaic/core/ticks.hpp"
+
 namespace mosaic
 {
 namespace input
@@ -75,12 +77,12 @@ MOSAIC_DEFINE_ENUM_FLAGS_OPERATORS(GestureDirection)
  */
 struct InputEventMetadata
 {
-    std::chrono::time_point<std::chrono::high_resolution_clock> timestamp;
+    core::TickClock::time_point timestamp;
     std::chrono::duration<double> duration;
     uint64_t pollCount;
     InputEventType type;
 
-    InputEventMetadata(std::chrono::time_point<std::chrono::high_resolution_clock> _now,
+    InputEventMetadata(core::TickClock::time_point _now,
                        std::chrono::duration<double> _duration, uint64_t _pollCount = 0,
                        InputEventType _type = InputEventType::standalone)
         : timestamp(_now), duration(_duration), pollCount(_pollCount), type(_type) {};
@@ -100,12 +102,12 @@ struct MouseButtonEvent
     ActionableState state;
 
     MouseButtonEvent()
-        : metadata(std::chrono::high_resolution_clock::now(), std::chrono::milliseconds(0), 0,
+        : metadata(core::TickClock::now(), std::chrono::milliseconds(0), 0,
                    InputEventType::standalone),
           state(ActionableState::none) {};
 
     MouseButtonEvent(ActionableState _state,
-                     std::chrono::time_point<std::chrono::high_resolution_clock> _now,
+                     core::TickClock::time_point _now,
                      uint64_t _pollCount,
                      std::chrono::duration<double> _duration = std::chrono::milliseconds(0))
         : metadata(_now, _duration, _pollCount), state(_state) {};
@@ -124,12 +126,12 @@ struct MouseCursorMoveEvent
     glm::vec2 delta;
 
     MouseCursorMoveEvent()
-        : metadata(std::chrono::high_resolution_clock::now(), std::chrono::milliseconds(0), 0),
+        : metadata(core::TickClock::now(), std::chrono::milliseconds(0), 0),
           position(0.0f),
           delta(0.0f) {};
 
     MouseCursorMoveEvent(glm::vec2 _position, glm::vec2 _delta,
-                         std::chrono::time_point<std::chrono::high_resolution_clock> _now,
+                         core::TickClock::time_point _now,
                          uint64_t _pollCount, InputEventType _type,
                          std::chrono::duration<double> _duration = std::chrono::milliseconds(0))
         : metadata(_now, _duration, _pollCount, _type), position(_position), delta(_delta) {};
@@ -149,12 +151,12 @@ struct MouseWheelScrollEvent
     glm::vec2 delta;
 
     MouseWheelScrollEvent()
-        : metadata(std::chrono::high_resolution_clock::now(), std::chrono::milliseconds(0), 0),
+        : metadata(core::TickClock::now(), std::chrono::milliseconds(0), 0),
           offset(0.0f),
           delta(0.0f) {};
 
     MouseWheelScrollEvent(glm::vec2 _offset, glm::vec2 _delta,
-                          std::chrono::time_point<std::chrono::high_resolution_clock> _now,
+                          core::TickClock::time_point _now,
                           uint64_t _pollCount, InputEventType _type,
                           std::chrono::duration<double> _duration = std::chrono::milliseconds(0))
         : metadata(_now, _duration, _pollCount, _type), offset(_offset), delta(_delta) {};
@@ -169,17 +171,100 @@ struct KeyboardKeyEvent
     ActionableState state;
 
     KeyboardKeyEvent()
-        : metadata(std::chrono::high_resolution_clock::now(), std::chrono::milliseconds(0), 0,
+        : metadata(core::TickClock::now(), std::chrono::milliseconds(0), 0,
                    InputEventType::standalone),
           state(ActionableState::none) {};
 
     KeyboardKeyEvent(ActionableState _state,
-                     std::chrono::time_point<std::chrono::high_resolution_clock> _now,
+                     core::TickClock::time_point _now,
                      uint64_t _pollCount,
                      std::chrono::duration<double> _duration = std::chrono::milliseconds(0))
         : metadata(_now, _duration, _pollCount), state(_state) {};
 };
 
+/**
+ * @brief The `RawInputEventType` enum class defines the kinds of device events a platform queues
+ * on an input source.
+ */
+enum class RawInputEventType : uint8_t
+{
+    button, // MouseButton, pressed or released
+    key,    // KeyboardKey, pressed or released
+    cursor, // Absolute cursor position
+    scroll, // Wheel offset since the previous scroll event
+};
+
+/**
+ * @brief The `RawInputEvent` struct is a device event as the platform captured it, timestamped
+ * when it happened rather than when the frame processes it.
+ *
+ * Platform callbacks, or a thread reading the device (Win32 raw input), queue them with
+ * `InputSource::pushRawEvent()`; the source drains them at its next `processInput()`. Touch
+ * samples come in batches read on the frame's thread and go to `TouchInputSource` directly.
+ */
+struct RawInputEvent
+{
+    core::TickClock::time_point timestamp;
+    glm::vec2 value; // cursor and scroll
+    uint32_t code;   // button and key, the value of the MouseButton or the KeyboardKey
+    RawInputEventType type;
+    bool pressed;
+
+    RawInputEvent()
+        : timestamp(core::TickClock::now()),
+          value(0.0f),
+          code(0),
+          type(RawInputEventType::cursor),
+          pressed(false) {};
+
+    RawInputEvent(RawInputEventType _type, uint32_t _code, bool _pressed,
+                  core::TickClock::time_point _now = core::TickClock::now())
+        : timestamp(_now), value(0.0f), code(_code), type(_type), pressed(_pressed) {};
+
+    RawInputEvent(RawInputEventType _type, glm::vec2 _value,
+                  core::TickClock::time_point _now = core::TickClock::now())
+        : timestamp(_now), value(_value), code(0), type(_type), pressed(false) {};
+};
+
+/**
+ * @brief The `TouchPhase` enum class defines what a touch sample is to its pointer.
+ */
+enum class TouchPhase : uint8_t
+{
+    down,   // The pointer touched the screen
+    move,   // Moved while down, the historical samples of a batch too
+    up,     // Lifted
+    cancel, // Taken away by the system (a gesture, a palm): its last sample
+};
+
+/**
+ * @brief The `TouchSample` struct is a position of a pointer as the digitizer reported it,
+ * timestamped when it was sampled: the historical samples of a batch keep their own times.
+ */
+struct TouchSample
+{
+    core::TickClock::time_point timestamp;
+    glm::vec2 position; // in pixels of the window
+    float pressure;     // nominally 0 to 1, 1 where the device does not measure it
+    int32_t pointerId;  // of the platform, stable while the pointer is down
+    TouchPhase phase;
+
+    TouchSample()
+        : timestamp(core::TickClock::now()),
+          position(0.0f),
+          pressure(1.0f),
+          pointerId(0),
+          phase(TouchPhase::move) {};
+
+    TouchSample(int32_t _pointerId, TouchPhase _phase, glm::vec2 _position, float _pressure,
+                core::TickClock::time_point _time)
+        : timestamp(_time),
+          position(_position),
+          pressure(_pressure),
+          pointerId(_pointerId),
+          phase(_phase) {};
+};
+
 /**
  * @brief The `TextInputEvent` struct contains data and meta-data for a batched text input event.
  *
@@ -197,13 +282,13 @@ struct TextInputEvent
     std::string text;
 
     TextInputEvent()
-        : metadata(std::chrono::high_resolution_clock::now(), std::chrono::milliseconds(0), 0,
+        : metadata(core::TickClock::now(), std::chrono::milliseconds(0), 0,
                    InputEventType::standalone),
           codepoints(),
           text() {};
 
     TextInputEvent(std::vector<char32_t> _codepoints, std::string _text,
-                   std::chrono::time_point<std::chrono::high_resolution_clock> _now,
+                   core::TickClock::time_point _now,
                    uint64_t _pollCount,
                    std::chrono::duration<double> _duration = std::chrono::milliseconds(0))
         : metadata(_now, _duration, _pollCount, InputEventType::standalone),
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <chrono>
+#include <filesystem>
+#include <optional>
+
+#include <pieces/utils/string_id.hpp>
+
 #include "action.hpp"
 
 #include "mosaic/tools/logger.hpp"
 #include "sources/input_source.hpp"
 #include "sources/mouse_input_source.hpp"
 #include "sources/keyboard_input_source.hpp"
+#include "sources/touch_input_source.hpp"
 #include "sources/unified_text_input_source.hpp"
 
 namespace mosaic
@@ -25,7 +32,8 @@ namespace input
  * - Dynamic mapping and serialization/deserialization of virtual keys and buttons to their native
  * equivalents.
  *
- * - Improving performance by caching input and action states.
+ * - Improving performance by caching input and action states: every trigger runs once per
+ * `update()` into a bitset, queried by ActionId.
  *
  * @note Due to their common and limited usage some input events can also be checked outside of the
  * action system. For example, mouse cursor and wheel have dedicated getters.
@@ -33,6 +41,7 @@ namespace input
  * @see Action
  * @see MouseInputSource
  * @see KeyboardInputSource
+ * @see TouchInputSource
  * @see TextInputSource
  */
 class MOSAIC_API InputContext
@@ -57,19 +66,60 @@ class MOSAIC_API InputContext
 
     void update();
 
+    // When the oldest input the last update() processed happened, none without input
+    [[nodiscard]] std::optional<core::TickClock::time_point> getOldestInput() const;
+
     void loadVirtualKeysAndButtons(const std::string& _filePath);
     void saveVirtualKeysAndButtons(const std::string& _filePath);
     void updateVirtualKeyboardKeys(const std::unordered_map<std::string, KeyboardKey>&& _map);
     void updateVirtualMouseButtons(const std::unordered_map<std::string, MouseButton>&& _map);
 
-    void registerActions(const std::vector<Action>&& _actions);
+    /**
+     * @brief Registers the actions, evaluated at every `update()` from then on.
+     *
+     * @return The id of each action, in order, or k_invalidActionId for the names already taken.
+     */
+    std::vector<ActionId> registerActions(const std::vector<Action>&& _actions);
     void unregisterActions(const std::vector<std::string>&& _name);
 
+    // k_invalidActionId if no action has that name
+    [[nodiscard]] ActionId getActionId(pieces::StringId _name) const;
+
+    // A bit test, the triggers having run in update()
+    [[nodiscard]] bool isActionTriggered(ActionId _id, bool _onlyCurrPoll = true);
+
+    // Wrappers looking the id up: "moveLeft"_sid hashes at compile time, the string per call
     [[nodiscard]] bool isActionTriggered(const std::string& _name, bool _onlyCurrPoll = true);
+    [[nodiscard]] bool isActionTriggered(pieces::StringId _name, bool _onlyCurrPoll = true);
 
     [[nodiscard]] KeyboardKey translateKey(const std::string& _key) const;
     [[nodiscard]] MouseButton translateButton(const std::string& _button) const;
 
+    /**
+     * @brief Records what the sources read from their devices to a file, from the next `update()`
+     * on, until `stopRecording()`.
+     *
+     * @see InputRecorder
+     */
+    pieces::RefResult<InputContext, std::string> startRecording(
+        const std::filesystem::path& _filePath);
+    void stopRecording();
+    [[nodiscard]] bool isRecording() const;
+
+    /**
+     * @brief Plays a recording back: the sources of the context are replaced by replay ones, fed
+     * one recorded frame per `update()`, until `stopReplay()` puts them back.
+     *
+     * With a fixed timestep, the same recording gives the same input every run.
+     *
+     * @see InputReplay
+     */
+    pieces::RefResult<InputContext, std::string> startReplay(
+        const std::filesystem::path& _filePath);
+    void stopReplay();
+    // Until the recording is over
+    [[nodiscard]] bool isReplaying() const;
+
 #define DEFINE_SOURCE(_Type, _Member, _Name)                  \
     pieces::Result<_Type*, std::string> add##_Name##Source(); \
     void remove##_Name##Source();                             \
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/input/constants.hpp"
+#include "mosaic/input/events.hpp"
+#include "mosaic/input/mappings.hpp"
+
+namespace mosaic
+{
+namespace input
+{
+
+/**
+ * @brief The kinds of input a recording holds, what the sources read from their device in
+ * `processInput()`.
+ */
+enum class InputRecordType : uint8_t
+{
+    active, // The source gained or lost the focus
+    button, // MouseButton state, polled or raw
+    key,    // KeyboardKey state, polled or raw
+    cursor, // Absolute cursor position, polled or raw
+    scroll, // Wheel offset, polled or raw
+    text,   // TextInputEvent
+    ime,    // IMEEvent
+    touch,  // TouchSample, always raw
+};
+
+enum class InputRecordSource : uint8_t
+{
+    mouse,
+    keyboard,
+    text,
+    touch,
+};
+
+/**
+ * @brief One input of a recorded frame.
+ */
+struct InputRecord
+{
+    std::chrono::microseconds age; // raw: how long before the frame it happened
+    glm::vec2 value;               // cursor, scroll, touch: the position
+    uint32_t code;  // button, key: the code; active: the InputRecordSource; text, ime: the index;
+                    // touch: the pointer id
+    uint8_t state;  // button, key: the InputAction (polled) or pressed (raw); active: the flag;
+                    // touch: the TouchPhase
+    float pressure; // touch
+    InputRecordType type;
+    bool raw; // queued with pushRawEvent() rather than polled
+
+    InputRecord()
+        : age(0),
+          value(0.0f),
+          code(0),
+          state(0),
+          pressure(0.0f),
+          type(InputRecordType::active),
+          raw(false){};
+};
+
+/**
+ * @brief Records the input read by the sources of a context, frame by frame, to a compact binary
+ * stream.
+ *
+ * The polled state is delta-encoded: a button or a key is written when it changes, the cursor
+ * when it moves (the difference in pixels when it is a whole number), the wheel when it scrolls,
+ * and an idle frame costs its time and a record count, a few bytes. The raw events are written as
+ * they are drained, with their age relative to the frame.
+ *
+ * The stream is a header (k_inputRecordingMagic, k_inputRecordingVersion) followed by frames:
+ *
+ *     frame  := varint(µs since the previous frame) varint(record count) record*
+ *     record := tag [zigzag(age in µs), if raw] payload
+ *     tag    := type (bits 0-3) | raw (bit 4) | state (bits 5-6) | float payload (bit 7)
+ *
+ * The records go to a buffer, flushed to the file once it outgrows k_inputRecordingFlushSize.
+ *
+ * @note Not thread-safe: the sources record from the thread of `InputContext::update()`.
+ */
+class MOSAIC_API InputRecorder
+{
+   private:
+    std::ofstream m_file;
+    std::vector<uint8_t> m_bytes;
+    std::vector<uint8_t> m_frame;
+    uint32_t m_frameRecordCount;
+    uint64_t m_frameCount;
+
+    core::TickClock::time_point m_startTime;
+    core::TickClock::time_point m_frameTime;
+    std::chrono::microseconds m_frameOffset; // since the start, written as a difference
+
+    // The last state written, for the delta encoding
+    std::array<int8_t, 4> m_active;
+    std::array<uint8_t, c_mouseButtons.size()> m_buttons;
+    std::array<uint8_t, c_keyboardKeys.size()> m_keys;
+    glm::vec2 m_cursor;
+    glm::vec2 m_polledCursor;
+    bool m_hasPolledCursor;
+
+   public:
+    // Records to memory, see getBytes()
+    InputRecorder();
+
+    /**
+     * @brief Records to a file, overwritten.
+     *
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    explicit InputRecorder(const std::filesystem::path& _path);
+
+    ~InputRecorder();
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+   public:
+    void beginFrame(core::TickClock::time_point _time);
+    void endFrame();
+
+    // Written on change only
+    void recordActive(InputRecordSource _source, bool _active);
+    void recordButton(MouseButton _button, InputAction _action);
+    void recordKey(KeyboardKey _key, InputAction _action);
+    void recordCursor(const glm::vec2& _position);
+
+    // Written when not zero
+    void recordScroll(const glm::vec2& _offset);
+
+    void recordRawEvent(const RawInputEvent& _event);
+    void recordText(const TextInputEvent& _event);
+    void recordIME(const IMEEvent& _event);
+    void recordTouch(const TouchSample& _sample);
+
+    // Writes the buffered frames to the file
+    void flush();
+
+    [[nodiscard]] inline uint64_t getFrameCount() const { return m_frameCount; }
+
+    // The frames not flushed yet, all of them when recording to memory
+    [[nodiscard]] inline const std::vector<uint8_t>& getBytes() const { return m_bytes; }
+
+   private:
+    // The tag and, when raw, the age of a record of the frame
+    void beginRecord(InputRecordType _type, bool _raw, uint8_t _state, bool _float,
+                     std::chrono::microseconds _age);
+
+    // A whole difference from _base when it is exact, the floats otherwise
+    void writeVectorRecord(InputRecordType _type, bool _raw, std::chrono::microseconds _age,
+                           const glm::vec2& _value, const glm::vec2& _base, uint8_t _state = 0);
+
+    [[nodiscard]] std::chrono::microseconds getAge(core::TickClock::time_point _time) const;
+};
+
+/**
+ * @brief Plays a recording back, one frame per `advance()`; the replay sources read the records
+ * of the current frame.
+ *
+ * The frames keep their recorded times, counted from the first `advance()`, so that the
+ * durations the sources measure (holds, double clicks) are those of the recording.
+ */
+class MOSAIC_API InputReplay
+{
+   private:
+    std::vector<uint8_t> m_bytes;
+    size_t m_offset;
+
+    std::vector<InputRecord> m_records;
+    std::vector<TextInputEvent> m_texts;
+    std::vector<IMEEvent> m_imes;
+
+    core::TickClock::time_point m_startTime;
+    std::chrono::microseconds m_frameOffset;
+    uint64_t m_frameCount;
+    bool m_finished;
+
+    glm::vec2 m_cursor;
+
+   public:
+    /**
+     * @brief Plays back the bytes of a recording.
+     *
+     * @throws std::runtime_error if they do not start with a recording header.
+     */
+    explicit InputReplay(std::vector<uint8_t> _bytes);
+
+    /**
+     * @brief Plays back a recording file.
+     *
+     * @throws std::runtime_error if the file cannot be read or is not a recording.
+     */
+    explicit InputReplay(const std::filesystem::path& _path);
+
+   public:
+    /**
+     * @brief Decodes the next frame.
+     *
+     * @return false once the recording is over (the frame then has no records).
+     * @throws std::runtime_error if the frame is truncated or malformed.
+     */
+    bool advance();
+
+    [[nodiscard]] inline bool isFinished() const { return m_finished; }
+    // The frames played so far
+    [[nodiscard]] inline uint64_t getFrameCount() const { return m_frameCount; }
+
+    [[nodiscard]] inline core::TickClock::time_point getFrameTime() const
+    {
+        return m_startTime + m_frameOffset;
+    }
+
+    [[nodiscard]] inline std::span<const InputRecord> getRecords() const { return m_records; }
+
+    // The events of the text and ime records, by code
+    [[nodiscard]] inline const TextInputEvent& getText(uint32_t _index) const
+    {
+        return m_texts[_index];
+    }
+
+    [[nodiscard]] inline const IMEEvent& getIME(uint32_t _index) const { return m_imes[_index]; }
+
+   private:
+    [[nodiscard]] uint8_t readByte();
+    [[nodiscard]] uint64_t readVarint();
+    [[nodiscard]] int64_t readZigzag();
+    [[nodiscard]] float readFloat();
+    [[nodiscard]] std::string readString();
+};
+
+} // namespace input
+} // namespace mosaic
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <string>
 
 #include <pieces/core/result.hpp>
@@ -70,6 +72,12 @@ class MOSAIC_API InputSystem final : public core::EngineSystem
 
     InputContext* getContext(const window::Window* _window) const;
 
+    /**
+     * @brief When the oldest input of the last update, of any context, happened: on the steady
+     * clock of the renderer, which tags the frame rendered next with it. None without input.
+     */
+    [[nodiscard]] std::optional<std::chrono::steady_clock::time_point> getOldestInput() const;
+
     [[nodiscard]] static inline InputSystem* getInstance()
     {
         if (!g_instance) MOSAIC_ERROR("InputSystem has not been created yet!");
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <stdexcept>
+#include <utility>
 
 #include <pieces/core/result.hpp>
 #include <pieces/containers/circular_buffer.hpp>
+#include <pieces/containers/concurrent_ring_buffer.hpp>
 
 #include "mosaic/tools/logger.hpp"
 #include "mosaic/input/constants.hpp"
@@ -17,12 +22,22 @@ namespace mosaic
 namespace input
 {
 
+class InputRecorder;
+
 /**
  * @brief The `InputSource` class is an abstract base class for all input sources.
  *
  * Input sources provide a unified platform-agnostic interface for polling and processing input
  * events for a specific input device.
  *
+ * Besides polling the device, a platform can queue the events it captures with `pushRawEvent()`,
+ * from its callbacks or from a thread reading the device at its own rate: the source drains them
+ * in batches at its next `processInput()`, in order and at the time they happened, so that a
+ * press and its release between two frames are both seen.
+ *
+ * With a recorder attached, the source writes what it reads from the device to it, for the replay
+ * sources to feed it back through the same `processInput()`.
+ *
  * @note This class is not meant to be instantiated directly. Instead, use derived classes such as
  * `MouseInputSource` and `KeyboardInputSource`.
  */
@@ -32,9 +47,23 @@ class InputSource
     bool m_isActive;
     uint64_t m_pollCount;
     window::Window* m_window;
+    InputRecorder* m_recorder;
+
+   private:
+    pieces::SPSCRingBuffer<RawInputEvent> m_rawEvents;
+    std::atomic<uint64_t> m_droppedRawEventCount;
+
+    // The time of the oldest input processed since takeOldestInput()
+    std::optional<core::TickClock::time_point> m_oldestInput;
 
    public:
-    InputSource(window::Window* _window) : m_isActive(false), m_pollCount(0), m_window(_window){};
+    InputSource(window::Window* _window)
+        : m_isActive(false),
+          m_pollCount(0),
+          m_window(_window),
+          m_recorder(nullptr),
+          m_rawEvents(k_rawEventQueueCapacity),
+          m_droppedRawEventCount(0){};
     virtual ~InputSource() = default;
 
    public:
@@ -46,6 +75,57 @@ class InputSource
 
     [[nodiscard]] inline bool isActive() const { return m_isActive; }
     [[nodiscard]] inline uint64_t getPollCount() const { return m_pollCount; }
+
+    // nullptr detaches it; the recorder outlives the source or is detached first
+    inline void setRecorder(InputRecorder* _recorder) { m_recorder = _recorder; }
+    [[nodiscard]] inline InputRecorder* getRecorder() const { return m_recorder; }
+
+    /**
+     * @brief Queues an event for the next `processInput()`, lock-free.
+     *
+     * @return false if the queue is full: the event is dropped, and counted.
+     * @note A single producer per source: the thread of the platform callbacks, or the one reading
+     * the device, not both.
+     */
+    inline bool pushRawEvent(const RawInputEvent& _event)
+    {
+        if (m_rawEvents.tryPush(_event)) return true;
+
+        m_droppedRawEventCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    [[nodiscard]] inline uint64_t getDroppedRawEventCount() const
+    {
+        return m_droppedRawEventCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief When the oldest input processed since the last call happened: a raw event at its
+     * timestamp, a polled change at the time it was polled. None without input.
+     */
+    [[nodiscard]] inline std::optional<core::TickClock::time_point> takeOldestInput()
+    {
+        return std::exchange(m_oldestInput, std::nullopt);
+    }
+
+   protected:
+    // The time processInput() stamps the polled state with, the one of the frame when replaying
+    [[nodiscard]] virtual core::TickClock::time_point now() const { return core::TickClock::now(); }
+
+    // A press, a release, a move: the frame built next reacts to input that happened at _time
+    inline void consumeInput(core::TickClock::time_point _time)
+    {
+        m_oldestInput = m_oldestInput ? std::min(*m_oldestInput, _time) : _time;
+    }
+
+    // Calls _func on the events queued so far, oldest first, from the thread of processInput()
+    template <typename Func>
+    inline size_t drainRawEvents(Func&& _func)
+    {
+        return m_rawEvents.consume([&_func](size_t, const RawInputEvent& _event)
+                                   { _func(_event); });
+    }
 };
 
 } // namespace input
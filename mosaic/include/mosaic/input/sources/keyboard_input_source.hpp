@@ -50,6 +50,9 @@ class MOSAIC_API KeyboardInputSource : public InputSource
 
    protected:
     [[nodiscard]] virtual InputAction queryKeyState(KeyboardKey _key) const = 0;
+
+   private:
+    void updateKey(KeyboardKey _key, InputAction _action, core::TickClock::time_point _time);
 };
 
 } // namespace input
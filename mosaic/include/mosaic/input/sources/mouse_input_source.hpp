@@ -21,33 +21,41 @@ namespace input
 class MOSAIC_API MouseInputSource : public InputSource
 {
    protected:
+    // Sample timestamps: steady_clock, in nanoseconds
+    using SampleTime = int64_t;
+
     struct MouseWheelScrollSample
     {
         glm::vec2 offset;
-        std::chrono::time_point<std::chrono::high_resolution_clock> timestamp;
+        SampleTime timestamp;
 
-        MouseWheelScrollSample()
-            : offset(0.0f, 0.0f), timestamp(std::chrono::high_resolution_clock::now()){};
+        MouseWheelScrollSample() : offset(0.0f, 0.0f), timestamp(0){};
 
-        MouseWheelScrollSample(
-            const glm::vec2& _offset,
-            std::chrono::time_point<std::chrono::high_resolution_clock> _timestamp)
+        MouseWheelScrollSample(const glm::vec2& _offset, SampleTime _timestamp)
             : offset(_offset), timestamp(_timestamp){};
     };
 
     struct MouseCursorPosSample
     {
         glm::vec2 position;
-        std::chrono::time_point<std::chrono::high_resolution_clock> timestamp;
+        SampleTime timestamp;
 
-        MouseCursorPosSample()
-            : position(0.0f, 0.0f), timestamp(std::chrono::high_resolution_clock::now()){};
+        MouseCursorPosSample() : position(0.0f, 0.0f), timestamp(0){};
 
-        MouseCursorPosSample(const glm::vec2& _position,
-                             std::chrono::time_point<std::chrono::high_resolution_clock> _timestamp)
+        MouseCursorPosSample(const glm::vec2& _position, SampleTime _timestamp)
             : position(_position), timestamp(_timestamp){};
     };
 
+    /**
+     * @brief Exponentially weighted estimates of the rate of change of a sampled signal and of
+     * the change of that rate, over k_motionSmoothingTime. Updated once per sample.
+     */
+    struct MotionStats
+    {
+        glm::vec2 velocity = glm::vec2(0.0f);
+        glm::vec2 acceleration = glm::vec2(0.0f);
+    };
+
     // Events
     std::array<pieces::CircularBuffer<MouseButtonEvent, k_eventHistoryMaxSize>,
                c_mouseButtons.size()>
@@ -61,6 +69,9 @@ class MOSAIC_API MouseInputSource : public InputSource
     pieces::CircularBuffer<MouseCursorPosSample, k_mouseCursorNumSamples> m_cursorPosSamples;
 
     // Derived
+    MotionStats m_wheelStats;
+    MotionStats m_cursorStats;
+    glm::vec2 m_wheelOffsetSum; // of the samples in the ring
     glm::vec2 m_wheelOffset;
     glm::vec2 m_wheelDelta;
     glm::vec2 m_cursorPosition;
@@ -70,6 +81,11 @@ class MOSAIC_API MouseInputSource : public InputSource
     glm::vec2 m_wheelSensitivity;
     glm::vec2 m_cursorSensitivity;
 
+    // From the raw events of the current call to processInput()
+    glm::vec2 m_rawWheelOffset;
+    glm::vec2 m_rawCursorPosition;
+    bool m_hasRawCursorPosition;
+
    public:
     MouseInputSource(window::Window* _window);
     virtual ~MouseInputSource() = default;
@@ -161,7 +177,20 @@ class MOSAIC_API MouseInputSource : public InputSource
    protected:
     [[nodiscard]] virtual InputAction queryButtonState(MouseButton _button) const = 0;
     [[nodiscard]] virtual glm::vec2 queryCursorPosition() const = 0;
-    [[nodiscard]] virtual glm::vec2 queryWheelOffset() = 0;
+
+    /**
+     * @brief The scroll offset accumulated since the last call, for the sources polling the wheel;
+     * those sending their scroll as raw events keep this default of zero.
+     */
+    [[nodiscard]] virtual glm::vec2 queryWheelOffset();
+
+   private:
+    void updateButton(MouseButton _button, InputAction _action, core::TickClock::time_point _time);
+    void applyRawEvent(const RawInputEvent& _event);
+
+    // Every k_inputSamplingRate at most
+    void sampleCursor(const glm::vec2& _position, SampleTime _time);
+    void sampleWheel(const glm::vec2& _offset, SampleTime _time);
 };
 
 } // namespace input
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+
+#include "mosaic/input/input_recording.hpp"
+
+#include "keyboard_input_source.hpp"
+#include "mouse_input_source.hpp"
+#include "touch_input_source.hpp"
+#include "unified_text_input_source.hpp"
+
+namespace mosaic
+{
+namespace input
+{
+
+/**
+ * @brief The `ReplayMouseInputSource` class plays the mouse records of an `InputReplay` back:
+ * each `processInput()` applies those of the current frame, the polled state to what the queries
+ * return and the raw events to the queue, then runs the one of `MouseInputSource`.
+ *
+ * @note The replay is advanced by its owner (`InputContext::update()`), once per frame, before
+ * the sources process their input.
+ *
+ * @see InputReplay
+ */
+class MOSAIC_API ReplayMouseInputSource : public MouseInputSource
+{
+   private:
+    const InputReplay* m_replay;
+
+    std::array<InputAction, c_mouseButtons.size()> m_buttons;
+    glm::vec2 m_cursor;
+    glm::vec2 m_wheelOffset;
+
+   public:
+    ReplayMouseInputSource(window::Window* _window, const InputReplay* _replay);
+    ~ReplayMouseInputSource() override = default;
+
+   public:
+    pieces::RefResult<InputSource, std::string> initialize() override;
+    void shutdown() override {}
+
+    void pollDevice() override { ++m_pollCount; }
+    void processInput() override;
+
+   protected:
+    [[nodiscard]] core::TickClock::time_point now() const override
+    {
+        return m_replay->getFrameTime();
+    }
+
+    [[nodiscard]] InputAction queryButtonState(MouseButton _button) const override;
+    [[nodiscard]] glm::vec2 queryCursorPosition() const override { return m_cursor; }
+    [[nodiscard]] glm::vec2 queryWheelOffset() override { return m_wheelOffset; }
+};
+
+/**
+ * @brief The `ReplayKeyboardInputSource` class plays the key records of an `InputReplay` back,
+ * like `ReplayMouseInputSource`.
+ */
+class MOSAIC_API ReplayKeyboardInputSource : public KeyboardInputSource
+{
+   private:
+    const InputReplay* m_replay;
+
+    std::array<InputAction, c_keyboardKeys.size()> m_keys;
+
+   public:
+    ReplayKeyboardInputSource(window::Window* _window, const InputReplay* _replay);
+    ~ReplayKeyboardInputSource() override = default;
+
+   public:
+    pieces::RefResult<InputSource, std::string> initialize() override;
+    void shutdown() override {}
+
+    void pollDevice() override { ++m_pollCount; }
+    void processInput() override;
+
+   protected:
+    [[nodiscard]] core::TickClock::time_point now() const override
+    {
+        return m_replay->getFrameTime();
+    }
+
+    [[nodiscard]] InputAction queryKeyState(KeyboardKey _key) const override;
+};
+
+/**
+ * @brief The `ReplayUnifiedTextInputSource` class plays the text and IME records of an
+ * `InputReplay` back, like `ReplayMouseInputSource`.
+ *
+ * @note The IME is the recorded one: the candidate window position is ignored.
+ */
+class MOSAIC_API ReplayUnifiedTextInputSource : public UnifiedTextInputSource
+{
+   private:
+    const InputReplay* m_replay;
+
+   public:
+    ReplayUnifiedTextInputSource(window::Window* _window, const InputReplay* _replay)
+        : UnifiedTextInputSource(_window), m_replay(_replay){};
+    ~ReplayUnifiedTextInputSource() override = default;
+
+   public:
+    pieces::RefResult<InputSource, std::string> initialize() override;
+    void shutdown() override {}
+
+    void pollDevice() override { ++m_pollCount; }
+    void processInput() override;
+
+    void setEnabled(bool _enabled) override;
+    void setInitialComposition(const std::string& _text, size_t _cursor) override;
+    void setCandidateWindowPosition(int, int) override {}
+
+   protected:
+    void queryPendingEvents(std::vector<TextInputEvent>& _outTextEvents,
+                            std::vector<IMEEvent>& _outIMEEvents) override;
+};
+
+/**
+ * @brief The `ReplayTouchInputSource` class plays the touch samples of an `InputReplay` back,
+ * like `ReplayMouseInputSource`, at the times they were sampled.
+ */
+class MOSAIC_API ReplayTouchInputSource : public TouchInputSource
+{
+   private:
+    const InputReplay* m_replay;
+
+   public:
+    ReplayTouchInputSource(window::Window* _window, const InputReplay* _replay)
+        : TouchInputSource(_window), m_replay(_replay){};
+    ~ReplayTouchInputSource() override = default;
+
+   public:
+    pieces::RefResult<InputSource, std::string> initialize() override;
+    void shutdown() override {}
+
+    void pollDevice() override;
+    void processInput() override;
+
+   protected:
+    [[nodiscard]] core::TickClock::time_point now() const override
+    {
+        return m_replay->getFrameTime();
+    }
+};
+
+} // namespace input
+} // namespace mosaic
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "input_source.hpp"
+
+#include <array>
+#include <span>
+
+#include <pieces/containers/circular_buffer.hpp>
+
+namespace mosaic
+{
+namespace input
+{
+
+/**
+ * @brief The `TouchInputSource` class is an abstract base class for touch screen input sources:
+ * the pointers down, up to k_maxTouchPointers, each with the samples its digitizer reported.
+ *
+ * The platform reads the device once per `processInput()`, in `pollDevice()`, and hands every
+ * sample to `addSample()`, oldest first and the historical samples of a batch included: the
+ * position, the velocity and the last k_touchNumSamples samples of a pointer follow sample by
+ * sample, in fixed rings, without allocation. A pointer lifted or cancelled stays until the next
+ * `processInput()` in its last phase, so that the frame sees the release.
+ *
+ * @note This class is not meant to be instantiated directly. Instead, use the
+ * `TouchInputSource::create()` factory method to create an instance of a concrete touch input
+ * source implementation.
+ *
+ * @see InputSource
+ */
+class MOSAIC_API TouchInputSource : public InputSource
+{
+   public:
+    struct Pointer
+    {
+        int32_t id = 0;
+        TouchPhase phase = TouchPhase::up; // of its last sample
+
+        glm::vec2 position = glm::vec2(0.0f);
+        glm::vec2 startPosition = glm::vec2(0.0f); // where it touched
+        glm::vec2 delta = glm::vec2(0.0f);         // since the previous processInput()
+
+        // Pixels per second, exponentially weighted over k_motionSmoothingTime
+        glm::vec2 velocity = glm::vec2(0.0f);
+
+        float pressure = 0.0f;
+        core::TickClock::time_point downTime;
+        core::TickClock::time_point time; // of its last sample
+
+        // Newest first; the first frameSampleCount came with the last processInput()
+        pieces::CircularBuffer<TouchSample, k_touchNumSamples> samples;
+        uint32_t frameSampleCount = 0;
+
+        glm::vec2 framePosition = glm::vec2(0.0f); // at the start of the processInput()
+
+        [[nodiscard]] inline bool isDown() const
+        {
+            return phase == TouchPhase::down || phase == TouchPhase::move;
+        }
+    };
+
+   protected:
+    // The pointers tracked, in the order they touched; compacted as they leave
+    std::array<Pointer, k_maxTouchPointers> m_pointers;
+    uint32_t m_pointerCount;
+
+    uint64_t m_droppedSampleCount; // of the pointers past k_maxTouchPointers
+
+   public:
+    TouchInputSource(window::Window* _window);
+    virtual ~TouchInputSource() = default;
+
+    static std::unique_ptr<TouchInputSource> create(window::Window* _window);
+
+   public:
+    virtual pieces::RefResult<InputSource, std::string> initialize() override = 0;
+    virtual void shutdown() override = 0;
+
+    virtual void pollDevice() override = 0;
+    void processInput() override;
+
+    // The pointers down, and the ones released during the last processInput()
+    [[nodiscard]] inline std::span<const Pointer> getPointers() const
+    {
+        return std::span<const Pointer>(m_pointers.data(), m_pointerCount);
+    }
+
+    // nullptr if no pointer has that id
+    [[nodiscard]] const Pointer* findPointer(int32_t _id) const;
+
+    // The first pointer down still down, nullptr if none
+    [[nodiscard]] const Pointer* getPrimaryPointer() const;
+
+    [[nodiscard]] inline uint64_t getDroppedSampleCount() const { return m_droppedSampleCount; }
+
+   protected:
+    /**
+     * @brief Applies a sample read from the device, from `pollDevice()`: a pointer starts with a
+     * down (or with the first sample of an id not tracked) and ends with an up or a cancel.
+     */
+    void addSample(const TouchSample& _sample);
+
+    // Ends the pointers down with a cancel at _time (the focus or the surface lost)
+    void cancelPointers(core::TickClock::time_point _time);
+
+   private:
+    [[nodiscard]] Pointer* findTrackedPointer(int32_t _id);
+    void applySample(const TouchSample& _sample);
+};
+
+} // namespace input
+} // namespace mosaic
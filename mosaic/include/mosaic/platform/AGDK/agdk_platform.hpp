@@ -19,6 +19,7 @@ namespace agdk
 class AGDKPlatformContext : public core::PlatformContext
 {
    private:
+    android_app* m_app;
     GameActivity* m_activity;
     AAssetManager* m_assetManager;
     ANativeWindow* m_currentWindow;
@@ -35,6 +36,8 @@ class AGDKPlatformContext : public core::PlatformContext
 
     void setApp(android_app* _app);
 
+    // The glue of android_main(), its input buffers read by the thread polling it only
+    [[nodiscard]] android_app* getApp() const { return m_app; }
     [[nodiscard]] GameActivity* getActivity() const { return m_activity; }
     [[nodiscard]] AAssetManager* getAssetManager() const { return m_assetManager; }
 
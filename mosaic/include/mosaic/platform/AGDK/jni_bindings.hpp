@@ -0,0 +1,301 @@
+#pragma once
+
+#include <jni.h>
+
+#include <span>
+#include <type_traits>
+
+#include "mosaic/platform/AGDK/jni_helper.hpp"
+
+namespace mosaic
+{
+namespace platform
+{
+namespace agdk
+{
+
+/**
+ * @brief A Java member declared once with its class, name and signature, resolved by
+ * JNIHelper::bind() from JNI_OnLoad (the class loader of the application is only that of the
+ * library load and the threads it attached) and called through the typed stubs below: no string,
+ * lookup or lock on the call path, the JNIEnv* of the thread taken from JNIHelper::getThreadEnv().
+ *
+ * The bindings live in static storage (the generated bridge::getBindings() table, see
+ * scripts/jni_on_load_generator.py), the class global references in the JNIHelper cache.
+ */
+class JNIBinding
+{
+   public:
+    enum class Kind
+    {
+        method,
+        static_method,
+        field,
+        static_field
+    };
+
+   private:
+    const char* m_className;
+    const char* m_name;
+    const char* m_signature;
+    Kind m_kind;
+
+   protected:
+    jclass m_class = nullptr;
+    jmethodID m_method = nullptr;
+    jfieldID m_field = nullptr;
+
+   public:
+    constexpr JNIBinding(Kind _kind, const char* _className, const char* _name,
+                         const char* _signature) noexcept
+        : m_className(_className), m_name(_name), m_signature(_signature), m_kind(_kind)
+    {
+    }
+
+    JNIBinding(const JNIBinding&) = delete;
+    JNIBinding& operator=(const JNIBinding&) = delete;
+
+   public:
+    [[nodiscard]] const char* getClassName() const noexcept { return m_className; }
+    [[nodiscard]] const char* getName() const noexcept { return m_name; }
+    [[nodiscard]] const char* getSignature() const noexcept { return m_signature; }
+    [[nodiscard]] Kind getKind() const noexcept { return m_kind; }
+
+    [[nodiscard]] bool isBound() const noexcept { return m_method || m_field; }
+
+   private:
+    friend class JNIHelper;
+
+    void bindMethod(jclass _class, jmethodID _method) noexcept
+    {
+        m_class = _class;
+        m_method = _method;
+    }
+
+    void bindField(jclass _class, jfieldID _field) noexcept
+    {
+        m_class = _class;
+        m_field = _field;
+    }
+
+    void unbind() noexcept
+    {
+        m_class = nullptr;
+        m_method = nullptr;
+        m_field = nullptr;
+    }
+};
+
+namespace detail
+{
+
+template <typename T>
+inline constexpr bool k_isJNIReference =
+    std::is_pointer_v<T> && std::is_convertible_v<T, jobject>;
+
+// The Call<Type>Method of the return type, a pending Java exception described and cleared
+template <typename R, typename... Args>
+R callJNIMethod(JNIEnv* _env, jobject _object, jmethodID _method, Args... _args)
+{
+    if constexpr (std::is_void_v<R>)
+    {
+        _env->CallVoidMethod(_object, _method, _args...);
+        JNIHelper::clearException(_env);
+    }
+    else
+    {
+        R result{};
+
+        if constexpr (std::is_same_v<R, jboolean>)
+            result = _env->CallBooleanMethod(_object, _method, _args...);
+        else if constexpr (std::is_same_v<R, jbyte>)
+            result = _env->CallByteMethod(_object, _method, _args...);
+        else if constexpr (std::is_same_v<R, jchar>)
+            result = _env->CallCharMethod(_object, _method, _args...);
+        else if constexpr (std::is_same_v<R, jshort>)
+            result = _env->CallShortMethod(_object, _method, _args...);
+        else if constexpr (std::is_same_v<R, jint>)
+            result = _env->CallIntMethod(_object, _method, _args...);
+        else if constexpr (std::is_same_v<R, jlong>)
+            result = _env->CallLongMethod(_object, _method, _args...);
+        else if constexpr (std::is_same_v<R, jfloat>)
+            result = _env->CallFloatMethod(_object, _method, _args...);
+        else if constexpr (std::is_same_v<R, jdouble>)
+            result = _env->CallDoubleMethod(_object, _method, _args...);
+        else if constexpr (k_isJNIReference<R>)
+            result = static_cast<R>(_env->CallObjectMethod(_object, _method, _args...));
+        else
+            static_assert(k_isJNIReference<R>, "not a JNI return type");
+
+        if (JNIHelper::clearException(_env)) return R{};
+        return result;
+    }
+}
+
+template <typename R, typename... Args>
+R callJNIStaticMethod(JNIEnv* _env, jclass _class, jmethodID _method, Args... _args)
+{
+    if constexpr (std::is_void_v<R>)
+    {
+        _env->CallStaticVoidMethod(_class, _method, _args...);
+        JNIHelper::clearException(_env);
+    }
+    else
+    {
+        R result{};
+
+        if constexpr (std::is_same_v<R, jboolean>)
+            result = _env->CallStaticBooleanMethod(_class, _method, _args...);
+        else if constexpr (std::is_same_v<R, jbyte>)
+            result = _env->CallStaticByteMethod(_class, _method, _args...);
+        else if constexpr (std::is_same_v<R, jchar>)
+            result = _env->CallStaticCharMethod(_class, _method, _args...);
+        else if constexpr (std::is_same_v<R, jshort>)
+            result = _env->CallStaticShortMethod(_class, _method, _args...);
+        else if constexpr (std::is_same_v<R, jint>)
+            result = _env->CallStaticIntMethod(_class, _method, _args...);
+        else if constexpr (std::is_same_v<R, jlong>)
+            result = _env->CallStaticLongMethod(_class, _method, _args...);
+        else if constexpr (std::is_same_v<R, jfloat>)
+            result = _env->CallStaticFloatMethod(_class, _method, _args...);
+        else if constexpr (std::is_same_v<R, jdouble>)
+            result = _env->CallStaticDoubleMethod(_class, _method, _args...);
+        else if constexpr (k_isJNIReference<R>)
+            result = static_cast<R>(_env->CallStaticObjectMethod(_class, _method, _args...));
+        else
+            static_assert(k_isJNIReference<R>, "not a JNI return type");
+
+        if (JNIHelper::clearException(_env)) return R{};
+        return result;
+    }
+}
+
+template <typename T>
+T getJNIField(JNIEnv* _env, jobject _object, jfieldID _field)
+{
+    if constexpr (std::is_same_v<T, jboolean>)
+        return _env->GetBooleanField(_object, _field);
+    else if constexpr (std::is_same_v<T, jint>)
+        return _env->GetIntField(_object, _field);
+    else if constexpr (std::is_same_v<T, jlong>)
+        return _env->GetLongField(_object, _field);
+    else if constexpr (std::is_same_v<T, jfloat>)
+        return _env->GetFloatField(_object, _field);
+    else if constexpr (std::is_same_v<T, jdouble>)
+        return _env->GetDoubleField(_object, _field);
+    else if constexpr (k_isJNIReference<T>)
+        return static_cast<T>(_env->GetObjectField(_object, _field));
+    else
+        static_assert(k_isJNIReference<T>, "not a JNI field type");
+}
+
+template <typename T>
+T getJNIStaticField(JNIEnv* _env, jclass _class, jfieldID _field)
+{
+    if constexpr (std::is_same_v<T, jboolean>)
+        return _env->GetStaticBooleanField(_class, _field);
+    else if constexpr (std::is_same_v<T, jint>)
+        return _env->GetStaticIntField(_class, _field);
+    else if constexpr (std::is_same_v<T, jlong>)
+        return _env->GetStaticLongField(_class, _field);
+    else if constexpr (std::is_same_v<T, jfloat>)
+        return _env->GetStaticFloatField(_class, _field);
+    else if constexpr (std::is_same_v<T, jdouble>)
+        return _env->GetStaticDoubleField(_class, _field);
+    else if constexpr (k_isJNIReference<T>)
+        return static_cast<T>(_env->GetStaticObjectField(_class, _field));
+    else
+        static_assert(k_isJNIReference<T>, "not a JNI field type");
+}
+
+} // namespace detail
+
+template <typename Signature>
+class JNIMethod;
+
+/**
+ * @brief An instance method, called as method(object, args...): the default value of R when the
+ * binding failed, the thread has no JNIEnv or the method threw.
+ */
+template <typename R, typename... Args>
+class JNIMethod<R(Args...)> final : public JNIBinding
+{
+   public:
+    constexpr JNIMethod(const char* _className, const char* _name, const char* _signature) noexcept
+        : JNIBinding(Kind::method, _className, _name, _signature)
+    {
+    }
+
+    R operator()(jobject _object, Args... _args) const
+    {
+        JNIEnv* env = JNIHelper::getThreadEnv();
+        if (!env || !m_method || !_object) return R();
+
+        return detail::callJNIMethod<R>(env, _object, m_method, _args...);
+    }
+};
+
+template <typename Signature>
+class JNIStaticMethod;
+
+// A static method (a @JvmStatic function of a Kotlin object), called as method(args...)
+template <typename R, typename... Args>
+class JNIStaticMethod<R(Args...)> final : public JNIBinding
+{
+   public:
+    constexpr JNIStaticMethod(const char* _className, const char* _name,
+                              const char* _signature) noexcept
+        : JNIBinding(Kind::static_method, _className, _name, _signature)
+    {
+    }
+
+    R operator()(Args... _args) const
+    {
+        JNIEnv* env = JNIHelper::getThreadEnv();
+        if (!env || !m_method) return R();
+
+        return detail::callJNIStaticMethod<R>(env, m_class, m_method, _args...);
+    }
+};
+
+// An instance field, read as field.get(object)
+template <typename T>
+class JNIField final : public JNIBinding
+{
+   public:
+    constexpr JNIField(const char* _className, const char* _name, const char* _signature) noexcept
+        : JNIBinding(Kind::field, _className, _name, _signature)
+    {
+    }
+
+    [[nodiscard]] T get(jobject _object) const
+    {
+        JNIEnv* env = JNIHelper::getThreadEnv();
+        if (!env || !m_field || !_object) return T();
+
+        return detail::getJNIField<T>(env, _object, m_field);
+    }
+};
+
+template <typename T>
+class JNIStaticField final : public JNIBinding
+{
+   public:
+    constexpr JNIStaticField(const char* _className, const char* _name,
+                             const char* _signature) noexcept
+        : JNIBinding(Kind::static_field, _className, _name, _signature)
+    {
+    }
+
+    [[nodiscard]] T get() const
+    {
+        JNIEnv* env = JNIHelper::getThreadEnv();
+        if (!env || !m_field) return T();
+
+        return detail::getJNIStaticField<T>(env, m_class, m_field);
+    }
+};
+
+} // namespace agdk
+} // namespace platform
+} // namespace mosaic
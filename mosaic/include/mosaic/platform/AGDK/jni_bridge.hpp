@@ -0,0 +1,42 @@
+// Auto-generated JNI bindings
+// Generated by jni_on_load_generator.py
+// Found 2 classes with 6 methods
+
+#pragma once
+
+#include <span>
+
+#include "mosaic/platform/AGDK/jni_bindings.hpp"
+
+namespace mosaic
+{
+namespace platform
+{
+namespace agdk
+{
+namespace bridge
+{
+
+// com/mosaic/engine_bridge/SystemUI
+namespace SystemUI
+{
+extern JNIStaticMethod<jobject(jstring, jstring, jboolean)> showQuestionDialog;
+extern JNIStaticMethod<void(jstring, jstring)> showInfoDialog;
+extern JNIStaticMethod<void(jstring, jstring)> showWarningDialog;
+extern JNIStaticMethod<void(jstring, jstring)> showErrorDialog;
+}
+
+// com/mosaic/engine_bridge/SystemServices
+namespace SystemServices
+{
+extern JNIStaticMethod<void(jstring)> setClipboard;
+extern JNIStaticMethod<jstring()> getClipboard;
+}
+
+// Every binding above, for JNIHelper::bind()
+[[nodiscard]] std::span<JNIBinding* const> getBindings();
+
+} // namespace bridge
+} // namespace agdk
+} // namespace platform
+} // namespace mosaic
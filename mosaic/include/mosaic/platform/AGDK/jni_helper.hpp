@@ -1,6 +1,7 @@
 #pragma once
 
 #include <jni.h>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -21,6 +22,8 @@ namespace platform
 namespace agdk
 {
 
+class JNIBinding;
+
 /**
  * @brief The `JNIHelper` class provides a singleton interface for managing JNI interactions.
  *
@@ -36,8 +39,12 @@ namespace agdk
  *
  * - Dynamic native method callbacks registration.
  *
- * - Thread safe access to JNI environment via thread-local storage and RAII-style thread
- * attachment.
+ * - Thread safe access to JNI environment via thread-local storage: a thread is attached once,
+ * on its first call, and detached when it exits.
+ *
+ * - Bindings resolved once (bind(), from JNI_OnLoad) and called through typed stubs, see
+ * jni_bindings.hpp: the per-frame calls (IME, sensors) take no lock and build no string, unlike
+ * the string-keyed lookups and call wrappers below, kept for the occasional call.
  *
  * @note Always keep in mind you need the correct class loader context when performing lookups.
  * @note Java version dependent references all point to Java 11 documentation as it's the target
@@ -71,6 +78,9 @@ class JNIHelper
 
     mutable std::mutex m_cacheMutex;
 
+    // Unbound at shutdown, the class references they hold released with the cache
+    std::vector<JNIBinding*> m_bindings;
+
    public:
     JNIHelper() = default;
     ~JNIHelper() = default;
@@ -91,6 +101,21 @@ class JNIHelper
     [[nodiscard]] JNIEnv* getEnv();
     void releaseEnv();
 
+    // The JNIEnv* of the calling thread, attaching it on its first call: one TLS read after that
+    [[nodiscard]] static JNIEnv* getThreadEnv()
+    {
+        if (m_tlsEnv) return m_tlsEnv;
+
+        return m_instance ? m_instance->getEnv() : nullptr;
+    }
+
+    /**
+     * @brief Resolves the class and member IDs of _bindings, logging those missing. Called from
+     * JNI_OnLoad, on the thread of the class loader of the application. False if any is missing,
+     * the others bound regardless.
+     */
+    bool bind(std::span<JNIBinding* const> _bindings);
+
     // Class and method management
 
     jclass findClass(const std::string& _className);
@@ -121,6 +146,8 @@ class JNIHelper
     // String utilities
 
     std::string jstringToString(jstring _jstr);
+    // Into _out, its capacity reused: no allocation once it fits the strings of the frame
+    void jstringToString(jstring _jstr, std::string& _out);
     jstring stringToJstring(const std::string& _str);
 
     // Array utilities
@@ -136,6 +163,8 @@ class JNIHelper
     // Exception handling
 
     bool checkAndClearException();
+    // Describes and clears the pending exception of _env, if any
+    static bool clearException(JNIEnv* _env);
     void throwJavaException(const std::string& _exceptionClass, const std::string& _message);
 
     // Dynamic native method binding
@@ -151,8 +180,9 @@ class JNIHelper
                                const std::vector<NativeMethod>& _methods);
 
     /**
-     * @brief ThreadAttachment is a RAII class that automatically attaches the current thread to the
-     * JNI environment.
+     * @brief ThreadAttachment makes sure the current thread is attached to the JNI environment,
+     * for the scope of a thread that calls into Java. The thread stays attached (and its JNIEnv*
+     * cached) until it exits, see getThreadEnv().
      */
     class ThreadAttachment
     {
@@ -165,7 +195,6 @@ class JNIHelper
 
        private:
         JNIEnv* m_env;
-        bool m_shouldDetach;
     };
 
     // Callback system for Kotlin -> C++ communication
@@ -206,7 +235,7 @@ T JNIHelper::callMethod(jobject _obj, const std::string& _className, const std::
     jmethodID method = getMethodID(_className, _methodName, _signature);
     if (!method) return T{};
 
-    T result;
+    T result{};
     if constexpr (std::is_same_v<T, jint>)
     {
         result = env->CallIntMethod(_obj, method, _args...);
@@ -227,9 +256,9 @@ T JNIHelper::callMethod(jobject _obj, const std::string& _className, const std::
     {
         result = env->CallBooleanMethod(_obj, method, _args...);
     }
-    else if constexpr (std::is_same_v<T, jobject>)
+    else if constexpr (std::is_convertible_v<T, jobject>)
     {
-        result = env->CallObjectMethod(_obj, method, _args...);
+        result = static_cast<T>(env->CallObjectMethod(_obj, method, _args...));
     }
 
     checkAndClearException();
@@ -263,7 +292,7 @@ T JNIHelper::callStaticMethod(const std::string& _className, const std::string&
     jmethodID method = getStaticMethodID(_className, _methodName, _signature);
     if (!clazz || !method) return T{};
 
-    T result;
+    T result{};
     if constexpr (std::is_same_v<T, jint>)
     {
         result = env->CallStaticIntMethod(clazz, method, _args...);
@@ -284,9 +313,9 @@ T JNIHelper::callStaticMethod(const std::string& _className, const std::string&
     {
         result = env->CallStaticBooleanMethod(clazz, method, _args...);
     }
-    else if constexpr (std::is_same_v<T, jobject>)
+    else if constexpr (std::is_convertible_v<T, jobject>)
     {
-        result = env->CallStaticObjectMethod(clazz, method, _args...);
+        result = static_cast<T>(env->CallStaticObjectMethod(clazz, method, _args...));
     }
 
     checkAndClearException();
@@ -2,6 +2,8 @@
 // Generated by jni_generator.py
 // Found 2 classes with 6 methods
 
+#include <mosaic/platform/AGDK/jni_bridge.hpp>
+
 JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)
 {
     mosaic::tools::Logger::initialize();
@@ -10,46 +12,10 @@ JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)
 
     helper->initialize(vm);
 
-    // Load methods for com/mosaic/engine_bridge/SystemUI
-    {
-        auto clazzRef = helper->findClass("com/mosaic/engine_bridge/SystemUI");
-        if (!clazzRef)
-        {
-            MOSAIC_ERROR("Failed to find SystemUI class");
-            return JNI_ERR;
-        }
-
-        helper->createGlobalRef(clazzRef);
-
-        helper->getStaticMethodID("com/mosaic/engine_bridge/SystemUI", "showQuestionDialog",
-                                  "(Ljava/lang/String;Ljava/lang/String;Z)Ljava/lang/Boolean;");
-
-        helper->getStaticMethodID("com/mosaic/engine_bridge/SystemUI", "showInfoDialog",
-                                  "(Ljava/lang/String;Ljava/lang/String;)V");
-
-        helper->getStaticMethodID("com/mosaic/engine_bridge/SystemUI", "showWarningDialog",
-                                  "(Ljava/lang/String;Ljava/lang/String;)V");
-
-        helper->getStaticMethodID("com/mosaic/engine_bridge/SystemUI", "showErrorDialog",
-                                  "(Ljava/lang/String;Ljava/lang/String;)V");
-    }
-
-    // Load methods for com/mosaic/engine_bridge/SystemServices
+    if (!helper->bind(mosaic::platform::agdk::bridge::getBindings()))
     {
-        auto clazzRef = helper->findClass("com/mosaic/engine_bridge/SystemServices");
-        if (!clazzRef)
-        {
-            MOSAIC_ERROR("Failed to find SystemServices class");
-            return JNI_ERR;
-        }
-
-        helper->createGlobalRef(clazzRef);
-
-        helper->getStaticMethodID("com/mosaic/engine_bridge/SystemServices", "setClipboard",
-                                  "(Ljava/lang/String;)V");
-
-        helper->getStaticMethodID("com/mosaic/engine_bridge/SystemServices", "getClipboard",
-                                  "()Ljava/lang/String;");
+        MOSAIC_ERROR("Failed to bind the engine bridge");
+        return JNI_ERR;
     }
 
     return JNI_VERSION_1_6;
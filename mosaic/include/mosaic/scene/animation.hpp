@@ -0,0 +1,306 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/ecs/entity_registry.hpp"
+#include "mosaic/graphics/frame_ring.hpp"
+
+#include "builtin_components.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+class ThreadPool;
+} // namespace exec
+
+namespace scene
+{
+
+// The transform of a joint relative to its parent.
+struct JointTransform
+{
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+};
+
+// A skinning matrix, std430: the 3 rows of the affine model * inverse bind transform of a joint,
+// read by the vertex shaders as 3 vec4 at 3 * joint.
+struct SkinningMatrix
+{
+    std::array<float, 12> rows = {};
+};
+
+static_assert(sizeof(SkinningMatrix) == 48, "SkinningMatrix is read by the vertex shaders");
+
+/**
+ * @brief The joints of a skinned mesh: their hierarchy, a parent always before its children, and
+ * the bind pose the mesh was modeled in.
+ */
+class MOSAIC_API Skeleton final
+{
+   public:
+    static constexpr int32_t k_noParent = -1;
+
+   private:
+    std::vector<int32_t> m_parents;
+    std::vector<JointTransform> m_bindPose;
+    std::vector<float> m_inverseBind; // 16 floats a joint, column-major
+
+   public:
+    /// @throws std::runtime_error if the sizes differ or a joint comes before its parent.
+    Skeleton(std::vector<int32_t> _parents, std::vector<JointTransform> _bindPose);
+
+   public:
+    [[nodiscard]] size_t getJointCount() const noexcept { return m_parents.size(); }
+    [[nodiscard]] std::span<const int32_t> getParents() const noexcept { return m_parents; }
+    [[nodiscard]] std::span<const JointTransform> getBindPose() const noexcept
+    {
+        return m_bindPose;
+    }
+
+    // The inverse of the model space bind transform of _joint, 16 floats column-major.
+    [[nodiscard]] const float* getInverseBind(size_t _joint) const noexcept
+    {
+        return m_inverseBind.data() + 16 * _joint;
+    }
+};
+
+/**
+ * @brief The local transforms of the joints of a skeleton, one array per scalar (struct of
+ * arrays) padded to a multiple of k_lanes joints, sampled and blended k_lanes joints at a time.
+ */
+class MOSAIC_API AnimationPose final
+{
+   public:
+    static constexpr size_t k_lanes = 8;
+
+    enum Channel : size_t
+    {
+        translationX,
+        translationY,
+        translationZ,
+        rotationX,
+        rotationY,
+        rotationZ,
+        rotationW,
+        scaleX,
+        scaleY,
+        scaleZ,
+        channelCount
+    };
+
+   private:
+    std::vector<float> m_data; // channelCount arrays of m_stride
+    size_t m_jointCount = 0;
+    size_t m_stride = 0;
+
+   public:
+    AnimationPose() = default;
+    explicit AnimationPose(size_t _jointCount) { resize(_jointCount); }
+
+   public:
+    /// Sizes the pose for _jointCount joints, every one reset to the identity.
+    void resize(size_t _jointCount);
+
+    [[nodiscard]] size_t size() const noexcept { return m_jointCount; }
+    [[nodiscard]] size_t getStride() const noexcept { return m_stride; }
+
+    [[nodiscard]] float* data(Channel _channel) noexcept
+    {
+        return m_data.data() + _channel * m_stride;
+    }
+    [[nodiscard]] const float* data(Channel _channel) const noexcept
+    {
+        return m_data.data() + _channel * m_stride;
+    }
+
+    [[nodiscard]] JointTransform getJoint(size_t _joint) const noexcept;
+    void setJoint(size_t _joint, const JointTransform& _transform) noexcept;
+};
+
+// The errors keyframe reduction may introduce, quantization aside.
+struct AnimationTolerance
+{
+    float translation = 0.001f; // in model units
+    float rotation = 0.001f;    // in radians
+    float scale = 0.001f;
+};
+
+/**
+ * @brief An animation of a skeleton compressed for sampling many characters a frame.
+ *
+ * Every channel (translation, rotation, scale) of every joint is a track of its own keyframes:
+ * a key is dropped when interpolating its neighbours stays within the tolerance, so a still or
+ * linearly moving joint costs two keys. A key is a frame index and 3 16-bit values: translations
+ * and scales quantized to the range of their track, rotations by their smallest three components
+ * (the largest one is rebuilt from the others, its index in the top bits). 6 bytes a value, 2 a
+ * time against the 40 of an uncompressed joint a frame.
+ *
+ * The tracks are arrays per channel (the keys of a track consecutive) and sample() finds its two
+ * keys by binary search: a clip holds no playback state and is shared by every character playing
+ * it, at any time.
+ */
+class MOSAIC_API AnimationClip final
+{
+   public:
+    // The keyframes of one channel, every joint's consecutive
+    struct Channel
+    {
+        std::vector<uint32_t> firstKey;   // joints + 1
+        std::vector<uint16_t> frames;     // a key
+        std::vector<uint16_t> values;     // 3 a key
+        std::vector<float> minimum, step; // 3 a joint, of the quantized ranges
+    };
+
+   private:
+    Channel m_translations;
+    Channel m_rotations;
+    Channel m_scales;
+
+    size_t m_jointCount = 0;
+    uint32_t m_frameCount = 0;
+    float m_frameRate = 30.0f;
+
+   public:
+    AnimationClip() = default;
+
+   public:
+    /**
+     * @brief Compresses an animation sampled uniformly.
+     *
+     * @param _samples The local joint transforms, _jointCount a frame, frame after frame.
+     * @throws std::runtime_error if there are no samples, not a whole number of frames, more
+     * than 65536 frames or the frame rate is not positive.
+     */
+    [[nodiscard]] static AnimationClip compress(size_t _jointCount,
+                                                std::span<const JointTransform> _samples,
+                                                float _frameRate,
+                                                const AnimationTolerance& _tolerance = {});
+
+    /// The pose at _time in seconds, clamped to the clip; _pose is sized to the clip's joints.
+    void sample(float _time, AnimationPose& _pose) const;
+
+    [[nodiscard]] float getDuration() const noexcept
+    {
+        return m_frameCount > 1 ? float(m_frameCount - 1) / m_frameRate : 0.0f;
+    }
+
+    [[nodiscard]] size_t getJointCount() const noexcept { return m_jointCount; }
+    [[nodiscard]] uint32_t getFrameCount() const noexcept { return m_frameCount; }
+    [[nodiscard]] float getFrameRate() const noexcept { return m_frameRate; }
+
+    [[nodiscard]] const Channel& getTranslations() const noexcept { return m_translations; }
+    [[nodiscard]] const Channel& getRotations() const noexcept { return m_rotations; }
+    [[nodiscard]] const Channel& getScales() const noexcept { return m_scales; }
+
+    // The keyframes of every track, and the bytes they take.
+    [[nodiscard]] size_t getKeyCount() const noexcept;
+    [[nodiscard]] size_t getByteSize() const noexcept;
+};
+
+/// _a towards _b by _weight (0 is _a) joint by joint, rotations normalized; _out may be either.
+MOSAIC_API void blendPoses(const AnimationPose& _a, const AnimationPose& _b, float _weight,
+                           AnimationPose& _out);
+
+/// The skinning matrices of the joints of _skeleton posed by _pose, as many as the smaller.
+MOSAIC_API void computeSkinningPalette(const Skeleton& _skeleton, const AnimationPose& _pose,
+                                       std::span<SkinningMatrix> _palette);
+
+// The skeletons and clips the AnimatorComponents refer to by index.
+class MOSAIC_API AnimationLibrary final
+{
+   private:
+    std::vector<Skeleton> m_skeletons;
+    std::vector<AnimationClip> m_clips;
+
+   public:
+    [[nodiscard]] uint32_t addSkeleton(Skeleton _skeleton);
+    [[nodiscard]] uint32_t addClip(AnimationClip _clip);
+
+    [[nodiscard]] const Skeleton* getSkeleton(uint32_t _index) const noexcept
+    {
+        return _index < m_skeletons.size() ? &m_skeletons[_index] : nullptr;
+    }
+    [[nodiscard]] const AnimationClip* getClip(uint32_t _index) const noexcept
+    {
+        return _index < m_clips.size() ? &m_clips[_index] : nullptr;
+    }
+
+    [[nodiscard]] size_t getSkeletonCount() const noexcept { return m_skeletons.size(); }
+    [[nodiscard]] size_t getClipCount() const noexcept { return m_clips.size(); }
+};
+
+/**
+ * @brief Plays the AnimatorComponents of a registry and writes their skinning palettes to the
+ * frame ring for GPU skinning.
+ *
+ * update() advances every animator, samples its clip (and blends its second one), composes the
+ * joints in model space and writes the skinning matrices straight into one allocation of the
+ * ring, the characters spread over the pool. The palette of an animator starts at its
+ * paletteOffset, its joints' matrices consecutive. An animator whose skeleton or clips are
+ * missing or do not match is skipped.
+ *
+ * The registry and the library must outlive the system; the library is not changed during an
+ * update().
+ */
+class MOSAIC_API AnimationSystem final
+{
+   public:
+    using AnimatorQuery = ecs::Query<ecs::detail::Read<AnimatorComponent>>;
+
+    // The characters animated by one task of the pool
+    static constexpr size_t k_grain = 8;
+
+   private:
+    struct Job
+    {
+        const AnimatorComponent* animator;
+        const Skeleton* skeleton;
+        const AnimationClip* clip;
+        const AnimationClip* blendClip; // null for none
+        uint32_t offset;                // in bytes of the palettes' allocation
+    };
+
+    const AnimationLibrary* m_library;
+    AnimatorQuery m_query;
+    std::vector<Job> m_jobs;
+    graphics::FrameAllocation m_palettes;
+
+   public:
+    /// @throws std::runtime_error if AnimatorComponent is not registered in _registry.
+    AnimationSystem(ecs::EntityRegistry& _registry, const AnimationLibrary& _library);
+
+   public:
+    /**
+     * @brief Animates every animator by _deltaTime seconds.
+     *
+     * @return The characters animated, 0 if the ring had no room for their palettes (none is
+     * written then).
+     */
+    size_t update(float _deltaTime, graphics::FrameRing& _ring);
+    size_t update(exec::ThreadPool& _pool, float _deltaTime, graphics::FrameRing& _ring);
+
+    // The palettes written by the last update, to bind.
+    [[nodiscard]] const graphics::FrameAllocation& getPalettes() const noexcept
+    {
+        return m_palettes;
+    }
+
+   private:
+    // Advances the animators and allocates their palettes, returns their count.
+    size_t prepare(float _deltaTime, graphics::FrameRing& _ring);
+    void animate(size_t _begin, size_t _end) const;
+};
+
+} // namespace scene
+} // namespace mosaic
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace mosaic
+{
+namespace scene
+{
+
+struct TagComponent
+{
+    std::array<char, 32> tag;
+    bool active;
+
+    TagComponent() : tag{}, active(true){};
+
+    TagComponent(const std::string& _tag, bool _active = true) : active(_active)
+    {
+        std::strncpy(tag.data(), _tag.c_str(), tag.size() - 1);
+        tag[tag.size() - 1] = '\0'; // Ensure null-termination
+    }
+};
+
+struct TransformComponent
+{
+    glm::vec3 position;
+    glm::quat rotation;
+    glm::vec3 scale;
+
+    mutable glm::mat4 transform;
+    mutable bool dirty;
+
+    TransformComponent()
+        : position(0.0f), rotation(1.0f, 0.0f, 0.0f, 0.0f), scale(1.0f), dirty(true){};
+
+    TransformComponent(const glm::vec3& pos, const glm::quat& rot, const glm::vec3& scl)
+        : position(pos), rotation(rot), scale(scl), dirty(true){};
+};
+
+// The box of an entity around its TransformComponent, in its local space: indexed by
+// SpatialIndex.
+struct BoundsComponent
+{
+    glm::vec3 center;
+    glm::vec3 extent; // half extents
+
+    BoundsComponent() : center(0.0f), extent(0.5f) {}
+
+    BoundsComponent(const glm::vec3& _extent) : center(0.0f), extent(_extent) {}
+
+    BoundsComponent(const glm::vec3& _center, const glm::vec3& _extent)
+        : center(_center), extent(_extent){};
+};
+
+struct CameraComponent
+{
+    float fov;
+    float nearPlane;
+    float farPlane;
+    bool primary;
+
+    CameraComponent() : fov(45.0f), nearPlane(0.1f), farPlane(100.0f), primary(true) {}
+
+    CameraComponent(float _fov, float _near, float _far, bool _primary = true)
+        : fov(_fov), nearPlane(_near), farPlane(_far), primary(_primary){};
+};
+
+struct MeshComponent
+{
+    uint32_t meshId;
+
+    MeshComponent() : meshId(0) {}
+
+    MeshComponent(uint32_t _id) : meshId(_id) {}
+};
+
+struct SpriteComponent
+{
+    uint32_t spriteId;
+
+    SpriteComponent() : spriteId(0) {}
+
+    SpriteComponent(uint32_t _id) : spriteId(_id) {}
+};
+
+struct MaterialComponent
+{
+    uint32_t materialId;
+
+    MaterialComponent() : materialId(0) {}
+
+    MaterialComponent(uint32_t _id) : materialId(_id) {}
+};
+
+struct LightComponent
+{
+    glm::vec3 color;
+    float intensity;
+    enum class Type
+    {
+        directional,
+        point,
+        spot
+    } type;
+
+    LightComponent() : color(1.0f), intensity(1.0f), type(Type::point) {}
+
+    LightComponent(const glm::vec3& _color, float _intensity, Type _type)
+        : color(_color), intensity(_intensity), type(_type){};
+};
+
+// Spawns GPU particles at its transform (graphics::ParticleEmitter), rate a second.
+struct ParticleEmitterComponent
+{
+    glm::vec3 velocity;
+    float velocityJitter;
+    glm::vec4 color;
+    float rate;
+    float lifetime;
+    float lifetimeJitter;
+    float size;
+    float radius;
+    float drag;
+
+    mutable float carry; // the fraction of a particle owed, spawned in a later frame
+
+    ParticleEmitterComponent()
+        : velocity(0.0f, 1.0f, 0.0f),
+          velocityJitter(0.5f),
+          color(1.0f),
+          rate(100.0f),
+          lifetime(2.0f),
+          lifetimeJitter(0.5f),
+          size(0.1f),
+          radius(0.0f),
+          drag(0.0f),
+          carry(0.0f){};
+
+    ParticleEmitterComponent(float _rate, float _lifetime, const glm::vec3& _velocity,
+                             const glm::vec4& _color)
+        : velocity(_velocity),
+          velocityJitter(0.5f),
+          color(_color),
+          rate(_rate),
+          lifetime(_lifetime),
+          lifetimeJitter(0.0f),
+          size(0.1f),
+          radius(0.0f),
+          drag(0.0f),
+          carry(0.0f){};
+};
+
+// Plays a clip of a skeleton of the AnimationLibrary, optionally blended towards a second one.
+struct AnimatorComponent
+{
+    static constexpr uint32_t k_noClip = UINT32_MAX;
+
+    uint32_t skeleton;
+    uint32_t clip;
+    uint32_t blendClip; // k_noClip for none
+    float blendWeight;  // of blendClip, from 0 to 1
+    float speed;
+    bool loop;
+
+    // advanced by AnimationSystem::update(), the palette is where it wrote the skinning matrices
+    mutable float time;
+    mutable float blendTime;
+    mutable uint32_t paletteOffset; // in bytes of the frame ring, UINT32_MAX if not animated
+
+    AnimatorComponent()
+        : skeleton(0),
+          clip(0),
+          blendClip(k_noClip),
+          blendWeight(0.0f),
+          speed(1.0f),
+          loop(true),
+          time(0.0f),
+          blendTime(0.0f),
+          paletteOffset(UINT32_MAX){};
+
+    AnimatorComponent(uint32_t _skeleton, uint32_t _clip, float _speed = 1.0f, bool _loop = true)
+        : skeleton(_skeleton),
+          clip(_clip),
+          blendClip(k_noClip),
+          blendWeight(0.0f),
+          speed(_speed),
+          loop(_loop),
+          time(0.0f),
+          blendTime(0.0f),
+          paletteOffset(UINT32_MAX){};
+};
+
+// The relation kind linking a child (source) to its parent (target), mirrored by
+// TransformHierarchy. Register it with EntityRegistry::registerRelation<ChildOf>({
+// RelationCleanup::destroySource, true}) so a child has one parent and destroying a parent
+// destroys its subtree in the same batch.
+struct ChildOf
+{
+};
+
+} // namespace scene
+} // namespace mosaic
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/ecs/entity_registry.hpp"
+#include "mosaic/graphics/gpu_particles.hpp"
+
+#include "builtin_components.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+/**
+ * @brief The graphics::ParticleEmitters of the entities with a TransformComponent and a
+ * ParticleEmitterComponent, for the GPU particle passes of a frame: the CPU cost is one emitter
+ * per entity, whatever the particles it keeps alive.
+ *
+ * The emitters are those of the entities in iteration order, up to k_maxParticleEmitters, each
+ * given its range of the spawns of the frame. Past the budget the last emitters spawn nothing that
+ * frame, what they owe dropped.
+ */
+class MOSAIC_API ParticleExtraction final
+{
+   public:
+    using EmitterQuery = ecs::Query<ecs::detail::Read<TransformComponent>,
+                                    ecs::detail::Read<ParticleEmitterComponent>>;
+
+   private:
+    EmitterQuery m_query;
+    std::vector<graphics::ParticleEmitter> m_emitters;
+    uint32_t m_spawnCount = 0;
+
+   public:
+    /// @throws std::runtime_error if the components are not registered in _registry.
+    explicit ParticleExtraction(ecs::EntityRegistry& _registry);
+
+   public:
+    /// Rebuilds the emitters of a frame of _deltaTime, _budget spawns at most; returns the spawns.
+    uint32_t update(float _deltaTime, uint32_t _budget);
+
+    [[nodiscard]] std::span<const graphics::ParticleEmitter> getEmitters() const noexcept
+    {
+        return m_emitters;
+    }
+
+    [[nodiscard]] uint32_t getSpawnCount() const noexcept { return m_spawnCount; }
+};
+
+} // namespace scene
+} // namespace mosaic
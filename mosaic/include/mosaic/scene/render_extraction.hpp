@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/ecs/entity_registry.hpp"
+#include "mosaic/graphics/draw_call.hpp"
+#include "mosaic/graphics/draw_queue.hpp"
+#include "mosaic/graphics/frame_ring.hpp"
+#include "mosaic/graphics/instance_batcher.hpp"
+
+#include "builtin_components.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+/**
+ * @brief Batches the entities with a TransformComponent and a MeshComponent (and an optional
+ * MaterialComponent, material 0 without) of a registry into the instanced draws of a
+ * graphics::InstanceBatcher.
+ *
+ * The batches are rebuilt only when a block of the matching archetypes was written (created,
+ * moved, changed through a Write<> term or markChanged()) or their entity count changed: a
+ * static scene costs one copy of its instances to the frame ring a frame. The dirty transforms
+ * are composed into their cached matrix on the way.
+ *
+ * Change detection has the granularity of the world tick: a write is seen by the update() of
+ * the tick it was made in and by the next one, so a change rebuilds the batches twice at most.
+ */
+class MOSAIC_API RenderExtraction final
+{
+   public:
+    using MeshQuery =
+        ecs::Query<ecs::detail::Read<TransformComponent>, ecs::detail::Read<MeshComponent>,
+                   ecs::detail::Optional<MaterialComponent>>;
+
+   private:
+    ecs::EntityRegistry* m_registry;
+    MeshQuery m_query;
+    graphics::InstanceBatcher m_batcher;
+
+    uint32_t m_since = 0;
+    size_t m_entityCount = 0;
+    bool m_built = false;
+
+   public:
+    /// @throws std::runtime_error if the components are not registered in _registry.
+    explicit RenderExtraction(ecs::EntityRegistry& _registry);
+
+   public:
+    /// Rebuilds the batches if the mesh entities changed since the last update, returns whether.
+    bool update();
+
+    /// Drops the batches, the next update() rebuilds them.
+    void invalidate() noexcept { m_built = false; }
+
+    /// @see graphics::InstanceBatcher::emit()
+    template <typename Resolve>
+        requires std::is_invocable_r_v<std::optional<graphics::DrawCall>, Resolve,
+                                       const graphics::InstanceBatch&>
+    uint32_t emit(graphics::FrameRing& _ring, graphics::DrawQueue& _queue,
+                  uint32_t _instanceBuffer, Resolve&& _resolve) const
+    {
+        return m_batcher.emit(_ring, _queue, _instanceBuffer, std::forward<Resolve>(_resolve));
+    }
+
+    [[nodiscard]] const graphics::InstanceBatcher& getBatcher() const noexcept { return m_batcher; }
+
+   private:
+    [[nodiscard]] bool hasChanged() const;
+    void rebuild();
+};
+
+} // namespace scene
+} // namespace mosaic
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <pieces/containers/flat_hash_map.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/ecs/component_registry.hpp"
+#include "mosaic/ecs/entity_registry.hpp"
+#include "mosaic/ecs/observer.hpp"
+
+#include "spatial_index.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+class ThreadPool;
+} // namespace exec
+
+namespace scene
+{
+
+/*
+ * Snapshot messages (header in native endianness, then a little-endian bit stream):
+ *
+ *   ReplicationHeader
+ *   for each entity that differs from the baseline, by ascending ID:
+ *     id - previous id                       varint (2-bit width class, then 4/8/16/32 bits)
+ *     op                                     2 bits
+ *     create: generation varint, component mask, every value of the present components
+ *     update: per replicated component, 1 bit changed, then 1 bit present, then
+ *             the values (added) or per value 1 bit changed and the value (written)
+ *     remove: nothing
+ *
+ * Values are the quantized scalars of the fields of a component, each of its field's width.
+ */
+
+inline constexpr uint32_t k_replicationMagic = 0x5045524D; // "MREP"
+inline constexpr uint32_t k_replicationVersion = 1;
+
+struct ReplicationHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t schemaHash;
+    uint32_t sequence; // of this snapshot, from 1
+    uint32_t baseline; // the snapshot it is a delta against, 0 for a full one
+    uint32_t frame;    // ReplicationServer::update() count when it was written
+    uint32_t count;    // entities
+    uint32_t bits;     // of the stream
+};
+
+static_assert(sizeof(ReplicationHeader) == 32);
+
+/**
+ * @brief A part of a replicated component sent over the network: floats quantized to a range,
+ * or bytes sent as is. The bytes of a component no field covers are left to the receiver.
+ */
+struct ReplicatedField
+{
+    uint32_t offset; // in bytes
+    uint32_t size;   // in bytes
+    uint32_t bits;   // of every float, 0 for raw bytes
+    float min;
+    float max;
+
+    /// _count floats at _offset, clamped to [_min, _max] and sent on _bits bits each (1 to 24).
+    [[nodiscard]] static constexpr ReplicatedField quantized(uint32_t _offset, uint32_t _count,
+                                                             float _min, float _max,
+                                                             uint32_t _bits) noexcept
+    {
+        return {_offset, _count * uint32_t(sizeof(float)), _bits, _min, _max};
+    }
+
+    /// _size bytes at _offset, compared and sent 4 at a time.
+    [[nodiscard]] static constexpr ReplicatedField raw(uint32_t _offset, uint32_t _size) noexcept
+    {
+        return {_offset, _size, 0, 0.0f, 0.0f};
+    }
+};
+
+/**
+ * @brief The components replicated from a server registry to client registries, and how each
+ * is quantized. Both ends build the same schema, the messages carry its hash.
+ */
+class MOSAIC_API ReplicationSchema final
+{
+   public:
+    static constexpr size_t k_maxComponents = 32;
+
+    // One quantized value: a float of a quantized field or up to 4 bytes of a raw one
+    struct Scalar
+    {
+        uint32_t offset;
+        uint32_t bits;
+        uint32_t bytes; // of a raw value, 0 for a float
+        float min;
+        float scale; // from [min, max] to [0, 2^bits - 1]
+    };
+
+    struct Component
+    {
+        ecs::ComponentID id;
+        uint32_t firstScalar;
+        uint32_t scalarCount;
+    };
+
+   private:
+    const ecs::ComponentRegistry* m_components;
+    std::vector<Component> m_replicated;
+    std::vector<Scalar> m_scalars;
+    uint32_t m_hash = 2166136261u;
+
+   public:
+    explicit ReplicationSchema(const ecs::ComponentRegistry& _components)
+        : m_components(&_components)
+    {
+    }
+
+   public:
+    /**
+     * @brief Replicates T, every byte of it when no field is given (a tag only by its presence).
+     *
+     * @throws std::runtime_error if T is not registered, shared, already replicated, if the
+     * schema is full or a field leaves the component or has more than 24 bits.
+     */
+    template <ecs::Component T>
+    void add(std::initializer_list<ReplicatedField> _fields = {})
+    {
+        add(m_components->getID<T>(), std::span<const ReplicatedField>(_fields));
+    }
+
+    void add(ecs::ComponentID _compID, std::span<const ReplicatedField> _fields);
+
+    [[nodiscard]] std::span<const Component> getComponents() const noexcept
+    {
+        return m_replicated;
+    }
+    [[nodiscard]] std::span<const Scalar> getScalars() const noexcept { return m_scalars; }
+    [[nodiscard]] uint32_t getHash() const noexcept { return m_hash; }
+};
+
+/**
+ * @brief Writes per-client snapshot messages of the replicated components of a registry, each
+ * a delta against the last snapshot the client acknowledged.
+ *
+ * update() quantizes the tick blocks where a replicated component changed since the previous
+ * update, once for every client, and stamps the values that actually moved with its frame. A
+ * client's snapshot then compares its baseline with that cache: a component left untouched since
+ * the baseline's frame is skipped without looking at its values, a written one sends only the
+ * values that differ. Without an acknowledged baseline in the history (a new client, or too many
+ * lost acknowledgments) the snapshot is a full one.
+ *
+ * A client given an interest box only receives the entities of the spatial index overlapping
+ * it, and every entity the index does not hold (no bounds). Leaving the box removes an entity
+ * on the client, entering it sends the entity whole.
+ *
+ * The registry (and the index) must outlive the server. update() runs after the index's, the
+ * snapshots of different clients may be written in parallel.
+ */
+class MOSAIC_API ReplicationServer final
+{
+   public:
+    using ClientID = uint32_t;
+
+    // The snapshots kept per client to delta against once acknowledged
+    static constexpr size_t k_historySize = 32;
+
+    // A snapshot as the client sees it: sorted entities, their components and values
+    struct Frame
+    {
+        uint32_t sequence = 0;
+        uint32_t frame = 0;
+        std::vector<ecs::EntityMeta> entities;
+        std::vector<uint32_t> masks;
+        std::vector<uint32_t> values; // entities * scalars
+    };
+
+   private:
+    struct Entity
+    {
+        ecs::EntityMeta meta;
+        uint32_t mask;
+        std::array<uint32_t, ReplicationSchema::k_maxComponents> changed; // frames
+    };
+
+    struct Client
+    {
+        bool connected = false;
+        bool hasInterest = false;
+        Aabb interest;
+        uint32_t sequence = 0;
+        uint32_t acknowledged = 0;
+        std::array<Frame, k_historySize> history;
+
+        // reused by every snapshot of the client
+        std::vector<ecs::EntityMeta> visible;
+        std::vector<uint32_t> rows;
+    };
+
+    ecs::EntityRegistry* m_registry;
+    const ReplicationSchema* m_schema;
+    const SpatialIndex* m_index;
+    std::vector<ecs::ObserverID> m_observers;
+
+    // the quantized state: entities by row, their values at row * scalars, rows sorted by ID
+    std::vector<Entity> m_entities;
+    std::vector<uint32_t> m_values;
+    pieces::FlatHashMap<ecs::EntityID, uint32_t> m_rows;
+    std::vector<std::pair<ecs::EntityID, uint32_t>> m_removed; // with the replicated component
+    std::vector<uint32_t> m_scratch;
+
+    std::vector<Client> m_clients;
+
+    uint32_t m_frame = 0;
+    uint32_t m_since = 0;
+
+   public:
+    /// @throws std::runtime_error if a replicated component is not registered in _registry.
+    ReplicationServer(ecs::EntityRegistry& _registry, const ReplicationSchema& _schema,
+                      const SpatialIndex* _index = nullptr);
+    ~ReplicationServer();
+
+    ReplicationServer(const ReplicationServer&) = delete;
+    ReplicationServer& operator=(const ReplicationServer&) = delete;
+
+   public:
+    /// Quantizes the replicated components written since the last update, returns their count.
+    size_t update();
+
+    [[nodiscard]] ClientID addClient();
+    void removeClient(ClientID _client);
+
+    // Limits the entities sent to the client to those of the index overlapping _box.
+    void setInterest(ClientID _client, const Aabb& _box);
+    void clearInterest(ClientID _client);
+
+    /// The client received the snapshot _sequence, later ones are a delta against it.
+    void acknowledge(ClientID _client, uint32_t _sequence);
+
+    /// Appends the next snapshot of the client to _out, returns its entity count.
+    size_t writeSnapshot(ClientID _client, std::vector<uint8_t>& _out);
+
+    /// writeSnapshot() of every client of _clients into the buffer of the same index, on _pool.
+    void writeSnapshots(exec::ThreadPool& _pool, std::span<const ClientID> _clients,
+                        std::span<std::vector<uint8_t>> _out);
+
+    [[nodiscard]] size_t size() const noexcept { return m_entities.size(); }
+    [[nodiscard]] uint32_t getFrame() const noexcept { return m_frame; }
+
+   private:
+    void quantize(const uint8_t* _component, const ReplicationSchema::Component& _replicated,
+                  uint32_t* _values) const noexcept;
+    [[nodiscard]] Client& getClient(ClientID _client);
+    void sortRows();
+};
+
+/**
+ * @brief Applies the snapshot messages of a ReplicationServer to a client registry: creates,
+ * writes (stamped as changed) and destroys the entities mirroring those of the server.
+ *
+ * Mirrored entities have their own IDs, use getLocalEntity() to translate. A snapshot older than
+ * the last one applied is dropped.
+ */
+class MOSAIC_API ReplicationClient final
+{
+   public:
+    using Frame = ReplicationServer::Frame;
+
+   private:
+    ecs::EntityRegistry* m_registry;
+    const ReplicationSchema* m_schema;
+
+    std::array<Frame, ReplicationServer::k_historySize> m_history;
+    uint32_t m_current = 0; // the sequence applied, 0 before the first one
+    pieces::FlatHashMap<ecs::EntityID, ecs::EntityMeta> m_locals;
+
+   public:
+    ReplicationClient(ecs::EntityRegistry& _registry, const ReplicationSchema& _schema);
+
+   public:
+    /**
+     * @brief Decodes a snapshot and applies it to the registry.
+     *
+     * @return The sequence to acknowledge to the server, 0 if the snapshot was dropped.
+     * @throws std::runtime_error if the message is malformed, of another version or schema, or
+     * against a baseline this client does not have.
+     */
+    uint32_t read(std::span<const uint8_t> _message);
+
+    // The entity mirroring the one of the server, if it is replicated here.
+    [[nodiscard]] std::optional<ecs::EntityMeta> getLocalEntity(ecs::EntityID _serverEntity) const;
+
+    [[nodiscard]] size_t size() const noexcept { return m_locals.size(); }
+    [[nodiscard]] uint32_t getSequence() const noexcept { return m_current; }
+
+   private:
+    void apply(const Frame& _previous, const Frame& _next);
+    void write(ecs::EntityID _local, const ReplicationSchema::Component& _replicated,
+               const uint32_t* _values);
+};
+
+} // namespace scene
+} // namespace mosaic
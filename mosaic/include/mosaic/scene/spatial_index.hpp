@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <pieces/containers/flat_hash_map.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/ecs/entity_registry.hpp"
+#include "mosaic/ecs/observer.hpp"
+
+#include "builtin_components.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+class ThreadPool;
+} // namespace exec
+
+namespace scene
+{
+
+// A world space axis-aligned box.
+struct Aabb
+{
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    [[nodiscard]] bool overlaps(const Aabb& _other) const noexcept
+    {
+        return glm::all(glm::lessThanEqual(min, _other.max)) &&
+               glm::all(glm::lessThanEqual(_other.min, max));
+    }
+};
+
+// The smallest world space box around _bounds rotated, scaled and moved by _transform.
+[[nodiscard]] MOSAIC_API Aabb computeWorldAabb(const TransformComponent& _transform,
+                                               const BoundsComponent& _bounds) noexcept;
+
+/**
+ * @brief A loose uniform grid over the world boxes of the entities with a TransformComponent and
+ * a BoundsComponent of a registry, for range queries (culling, AI perception, broadphase,
+ * network interest) that do not visit every entity.
+ *
+ * An entity is stored in the cell of its center when its half extents fit in half a cell, so a
+ * query only visits the cells of its box grown by half a cell; larger entities are kept apart
+ * and tested by every query. Every cell holds its boxes as columns, tested four at a time (SSE2,
+ * NEON, scalar otherwise).
+ *
+ * update() follows the registry incrementally: the entities of the blocks where a transform or a
+ * bounds changed (creations and moves included) are re-boxed, those that lost either component
+ * or were destroyed are dropped (observed). Like RenderExtraction, a write is seen by the
+ * update() of its tick and by the next one.
+ *
+ * The registry must outlive the index. Queries are const and may run concurrently, not with
+ * update() or rebuild().
+ */
+class MOSAIC_API SpatialIndex final
+{
+   public:
+    using BoundsQuery = ecs::Query<ecs::detail::Read<TransformComponent>,
+                                   ecs::detail::Read<BoundsComponent>>;
+
+    // The default size of a cell, in world units.
+    static constexpr float k_defaultCellSize = 16.0f;
+
+   private:
+    // The boxes of a cell as columns, row by row with their entities
+    struct Cell
+    {
+        std::vector<float> minX, minY, minZ;
+        std::vector<float> maxX, maxY, maxZ;
+        std::vector<ecs::EntityMeta> entities;
+    };
+
+    struct Location
+    {
+        uint32_t cell;
+        uint32_t row;
+    };
+
+    ecs::EntityRegistry* m_registry;
+    BoundsQuery m_query;
+    ecs::ObserverID m_transformObserver;
+    ecs::ObserverID m_boundsObserver;
+
+    float m_cellSize;
+    std::vector<Cell> m_cells; // the oversized entities first, then the cells of the grid
+    pieces::FlatHashMap<uint64_t, uint32_t> m_cellByKey;
+    pieces::FlatHashMap<ecs::EntityID, Location> m_locations;
+    std::vector<ecs::EntityID> m_removed; // by the observers, since the last update
+
+    uint32_t m_since = 0;
+    bool m_built = false;
+
+   public:
+    /// @throws std::runtime_error if the components are not registered in _registry.
+    explicit SpatialIndex(ecs::EntityRegistry& _registry, float _cellSize = k_defaultCellSize);
+    ~SpatialIndex();
+
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+   public:
+    /// Applies the changes of the registry since the last update, returns the entities re-boxed.
+    size_t update();
+
+    /// Re-boxes every entity, the first update() does; the boxes computed on _pool.
+    void rebuild();
+    void rebuild(exec::ThreadPool& _pool);
+
+    /// Appends the entities whose box overlaps _box to _entities, in no particular order.
+    void query(const Aabb& _box, std::vector<ecs::EntityMeta>& _entities) const;
+
+    /// Appends the entities whose box is within _radius of _center to _entities.
+    void querySphere(const glm::vec3& _center, float _radius,
+                     std::vector<ecs::EntityMeta>& _entities) const;
+
+    /// query() of every box of _boxes into the results of the same index, spread over _pool.
+    void query(exec::ThreadPool& _pool, std::span<const Aabb> _boxes,
+               std::span<std::vector<ecs::EntityMeta>> _results) const;
+
+    [[nodiscard]] size_t size() const noexcept { return m_locations.size(); }
+    [[nodiscard]] bool contains(ecs::EntityID _eid) const { return m_locations.contains(_eid); }
+    [[nodiscard]] float getCellSize() const noexcept { return m_cellSize; }
+
+    // The cells of the grid holding entities, the oversized ones not counted.
+    [[nodiscard]] size_t getCellCount() const noexcept;
+
+   private:
+    [[nodiscard]] uint64_t cellKey(const glm::vec3& _center) const noexcept;
+    [[nodiscard]] uint32_t cellOf(const Aabb& _box);
+
+    void insert(ecs::EntityMeta _entity, const Aabb& _box);
+    void erase(ecs::EntityID _eid);
+    void clear() noexcept;
+
+    // Calls _test(cell) for the oversized entities and every cell the box may overlap.
+    template <typename Test>
+    void visitCandidates(const Aabb& _box, Test&& _test) const;
+};
+
+} // namespace scene
+} // namespace mosaic
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/ecs/command_buffer.hpp"
+#include "mosaic/ecs/component_registry.hpp"
+#include "mosaic/ecs/entity_registry.hpp"
+#include "mosaic/ecs/entity_view.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+class ThreadPool;
+} // namespace exec
+
+namespace scene
+{
+
+// Identifies a system of a SystemScheduler, its index in registration order.
+using SystemID = uint32_t;
+
+/**
+ * @brief Access declared by a system that changes the registry itself (creates or destroys
+ * entities, adds or removes components, registers observers...): it runs alone in its stage.
+ */
+struct Structural
+{
+};
+
+/// What a system is given: the registry, and the command buffer of the system, played back at
+/// the end of its stage.
+struct SystemContext
+{
+    ecs::EntityRegistry& registry;
+    ecs::EntityCommandBuffer& commands;
+};
+
+using SystemFunction = std::function<void(SystemContext&)>;
+
+// The last run of a system.
+struct SystemStats
+{
+    uint32_t stage = 0;
+    std::chrono::nanoseconds duration{0};
+};
+
+/**
+ * @brief Runs the systems of a frame in stages built from the access they declare, so systems
+ * without conflicts run in parallel without hand-wired dependencies.
+ *
+ * A system declares query terms (ecs::detail::Read<T> reads T, Write<T>, a plain T and
+ * Optional<T> write it, With<> and Without<> touch no data) and Structural for direct
+ * structural changes. Two systems conflict when one writes a component the other reads or
+ * writes, or when one is structural. A system runs in the stage after the last one holding a
+ * system registered before it that it conflicts with, so conflicting systems keep their
+ * registration order and the others run as early as they can.
+ *
+ * Between stages, the command buffers of the systems of the stage are played back in
+ * registration order: the entities they create or destroy are seen from the next stage on.
+ * Every system is timed and traced under its name, on the thread that ran it.
+ *
+ * Systems must only touch the components they declared, and must not create queries while
+ * others run (EntityRegistry::query() may create the state of the query): create them up front
+ * and capture them. The registry tick is not advanced, that is left to the caller.
+ */
+class MOSAIC_API SystemScheduler final
+{
+   private:
+    struct System
+    {
+        std::string name;
+        SystemFunction function;
+        ecs::ComponentSignature reads;
+        ecs::ComponentSignature writes;
+        bool structural = false;
+        ecs::EntityCommandBuffer commands;
+        SystemStats stats;
+    };
+
+    const ecs::ComponentRegistry* m_componentRegistry;
+    std::vector<System> m_systems;             // by SystemID
+    std::vector<std::vector<SystemID>> m_stages; // in execution order, IDs ascending
+
+   public:
+    explicit SystemScheduler(const ecs::ComponentRegistry* _componentRegistry)
+        : m_componentRegistry(_componentRegistry)
+    {
+    }
+
+    SystemScheduler(const SystemScheduler&) = delete;
+    SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+   public:
+    /**
+     * @brief Registers a system run after the systems registered before it it conflicts with.
+     *
+     * @tparam Access The query terms of the components the system accesses, and Structural.
+     * @param _name The name of the system in the traces.
+     * @param _function The system, as function(SystemContext&).
+     * @return The ID of the system.
+     * @throws std::runtime_error if a declared component is not registered.
+     */
+    template <typename... Access>
+    SystemID addSystem(std::string _name, SystemFunction _function)
+    {
+        System system;
+        system.name = std::move(_name);
+        system.function = std::move(_function);
+        system.reads = ecs::ComponentSignature(m_componentRegistry->maxCount());
+        system.writes = ecs::ComponentSignature(m_componentRegistry->maxCount());
+
+        (declareAccess<Access>(system), ...);
+
+        return insertSystem(std::move(system));
+    }
+
+    /**
+     * @brief Runs every stage, the systems of a stage one task each on the pool (the calling
+     * thread takes one of them), and plays back their commands once all of them returned.
+     *
+     * Systems may iterate in parallel on the pool too, but joining on it from every worker can
+     * starve it: prefer serial iteration in systems that share a stage with many others.
+     *
+     * The first exception thrown by a system is rethrown once its stage is joined, the commands
+     * of the stage are discarded and the next stages do not run.
+     */
+    void run(exec::ThreadPool& _pool, ecs::EntityRegistry& _registry);
+
+    // Runs every system on the calling thread, in the order of the stages.
+    void run(ecs::EntityRegistry& _registry);
+
+    [[nodiscard]] const std::vector<std::vector<SystemID>>& getStages() const noexcept
+    {
+        return m_stages;
+    }
+
+    [[nodiscard]] size_t getSystemCount() const noexcept { return m_systems.size(); }
+
+    [[nodiscard]] std::string_view getName(SystemID _id) const { return m_systems.at(_id).name; }
+
+    [[nodiscard]] const SystemStats& getStats(SystemID _id) const
+    {
+        return m_systems.at(_id).stats;
+    }
+
+    // Whether two systems may not share a stage.
+    [[nodiscard]] bool conflicts(SystemID _first, SystemID _second) const;
+
+   private:
+    template <typename Term>
+    void declareAccess(System& _system) const
+    {
+        if constexpr (std::is_same_v<Term, Structural>)
+        {
+            _system.structural = true;
+        }
+        else
+        {
+            static_assert(ecs::detail::QueryTerm<Term>,
+                          "Access must be a query term or Structural");
+
+            using ecs::detail::TermAccess;
+            constexpr TermAccess access = ecs::detail::k_termAccess<Term>;
+
+            const ecs::ComponentID id =
+                m_componentRegistry->getID<ecs::detail::TermComponent<Term>>();
+
+            if constexpr (access == TermAccess::read)
+            {
+                _system.reads.setBit(id);
+            }
+            else if constexpr (access == TermAccess::write || access == TermAccess::optional)
+            {
+                _system.writes.setBit(id);
+            }
+        }
+    }
+
+    SystemID insertSystem(System&& _system);
+
+    void runSystem(System& _system, ecs::EntityRegistry& _registry);
+    void playbackStage(const std::vector<SystemID>& _stage, ecs::EntityRegistry& _registry);
+    void discardStage(const std::vector<SystemID>& _stage) noexcept;
+};
+
+} // namespace scene
+} // namespace mosaic
@@ -0,0 +1,655 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MOSAIC_SCENE_MAT4_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MOSAIC_SCENE_MAT4_NEON
+#endif
+
+#include "mosaic/ecs/entity.hpp"
+#include "mosaic/ecs/entity_view.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+/**
+ * @brief Multiplies two column-major 4x4 matrices (_a * _b), with SSE2 or NEON when available.
+ *
+ * Each column of the result is a linear combination of the columns of _a, so a column costs four
+ * broadcasts and four multiply-adds instead of sixteen scalar dot products.
+ */
+[[nodiscard]] inline glm::mat4 multiplyMat4(const glm::mat4& _a, const glm::mat4& _b) noexcept
+{
+    glm::mat4 result;
+
+#if defined(MOSAIC_SCENE_MAT4_SSE2)
+    const __m128 a0 = _mm_loadu_ps(&_a[0][0]);
+    const __m128 a1 = _mm_loadu_ps(&_a[1][0]);
+    const __m128 a2 = _mm_loadu_ps(&_a[2][0]);
+    const __m128 a3 = _mm_loadu_ps(&_a[3][0]);
+
+    for (int column = 0; column < 4; ++column)
+    {
+        const glm::vec4& b = _b[column];
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(b[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(b[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(b[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(b[3])));
+        _mm_storeu_ps(&result[column][0], sum);
+    }
+#elif defined(MOSAIC_SCENE_MAT4_NEON)
+    const float32x4_t a0 = vld1q_f32(&_a[0][0]);
+    const float32x4_t a1 = vld1q_f32(&_a[1][0]);
+    const float32x4_t a2 = vld1q_f32(&_a[2][0]);
+    const float32x4_t a3 = vld1q_f32(&_a[3][0]);
+
+    for (int column = 0; column < 4; ++column)
+    {
+        const glm::vec4& b = _b[column];
+        float32x4_t sum = vmulq_n_f32(a0, b[0]);
+        sum = vmlaq_n_f32(sum, a1, b[1]);
+        sum = vmlaq_n_f32(sum, a2, b[2]);
+        sum = vmlaq_n_f32(sum, a3, b[3]);
+        vst1q_f32(&result[column][0], sum);
+    }
+#else
+    result = _a * _b;
+#endif
+
+    return result;
+}
+
+/**
+ * @brief Builds the local matrix of a translation, rotation and scale (T * R * S), the layout
+ * used by scene::TransformComponent.
+ */
+[[nodiscard]] inline glm::mat4 composeTransform(const glm::vec3& _position,
+                                                const glm::quat& _rotation,
+                                                const glm::vec3& _scale) noexcept
+{
+    glm::mat4 result = glm::mat4_cast(_rotation);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float scale = _scale[axis];
+        for (int row = 0; row < 3; ++row) result[axis][row] *= scale;
+    }
+
+    result[3] = glm::vec4(_position, 1.0f);
+    return result;
+}
+
+/**
+ * @brief The 'TransformHierarchy' class propagates local transforms down a parent/child graph
+ * of entities and caches the resulting world matrices.
+ *
+ * Nodes are kept in structure-of-arrays form and sorted by depth: every node of depth d is
+ * stored before any node of depth d + 1, so a node's parent always has a smaller index. An update
+ * is a single forward sweep, level by level, where a node is recomputed if its local transform
+ * was set or its parent's world matrix was recomputed during the same update. Clean subtrees are
+ * only touched to test two flags per node, and the levels above the shallowest dirty node are
+ * skipped entirely.
+ *
+ * Structural changes (insert, reparent, remove) only record the new links; the depth order is
+ * rebuilt once, with a counting sort, on the next update or bulk access.
+ *
+ * Within a level no node depends on another, so large levels are split into ranges processed in
+ * parallel, with a join between levels.
+ *
+ * @note Not thread-safe, a hierarchy must not be modified while it is being updated.
+ */
+class TransformHierarchy final
+{
+   public:
+    // Parent index stored for root nodes.
+    static constexpr uint32_t k_noParent = std::numeric_limits<uint32_t>::max();
+
+    // Default minimum number of nodes processed by a single task of a parallel update.
+    static constexpr size_t k_defaultGrainSize = 2048;
+
+   private:
+    // Parent index stored for nodes removed since the last rebuild.
+    static constexpr uint32_t k_removed = k_noParent - 1;
+
+    // Depth order, parents always precede their children once m_orderValid is true
+    std::vector<ecs::EntityID> m_entities;
+    std::vector<uint32_t> m_parents;
+    std::vector<glm::mat4> m_locals;
+    std::vector<glm::mat4> m_worlds;
+    std::vector<uint8_t> m_dirty;
+    std::vector<uint8_t> m_changed;
+
+    // First node index of every depth, followed by the node count
+    std::vector<size_t> m_levelStarts;
+
+    std::unordered_map<ecs::EntityID, uint32_t> m_indices;
+
+    size_t m_firstDirtyLevel = 0;
+    bool m_anyDirty = false;
+    bool m_anyChanged = false;
+    bool m_orderValid = true;
+
+   public:
+    TransformHierarchy() = default;
+    ~TransformHierarchy() = default;
+
+    TransformHierarchy(const TransformHierarchy&) = default;
+    TransformHierarchy& operator=(const TransformHierarchy&) = default;
+    TransformHierarchy(TransformHierarchy&&) noexcept = default;
+    TransformHierarchy& operator=(TransformHierarchy&&) noexcept = default;
+
+   public:
+    /**
+     * @brief Adds a root node.
+     *
+     * @param _entity The entity of the node.
+     * @param _local The local transform of the node, which is also its world transform.
+     * @throws std::invalid_argument if the entity is already in the hierarchy.
+     */
+    void insert(ecs::EntityID _entity, const glm::mat4& _local = glm::mat4(1.0f))
+    {
+        insertNode(_entity, k_noParent, _local);
+    }
+
+    /**
+     * @brief Adds a node under an existing parent.
+     *
+     * @param _entity The entity of the node.
+     * @param _parent The entity of the parent node.
+     * @param _local The transform of the node relative to its parent.
+     * @throws std::invalid_argument if the entity is already in the hierarchy or the parent is
+     * not.
+     */
+    void insert(ecs::EntityID _entity, ecs::EntityID _parent,
+                const glm::mat4& _local = glm::mat4(1.0f))
+    {
+        insertNode(_entity, indexOf(_parent), _local);
+    }
+
+    /**
+     * @brief Moves a node, with its whole subtree, under another parent.
+     *
+     * The local transform is kept, so the world transform of the subtree changes.
+     *
+     * @throws std::invalid_argument if either entity is not in the hierarchy, or if the new parent
+     * is the node itself or one of its descendants.
+     */
+    void setParent(ecs::EntityID _entity, ecs::EntityID _parent)
+    {
+        const uint32_t index = indexOf(_entity);
+        const uint32_t parent = indexOf(_parent);
+
+        for (uint32_t ancestor = parent; ancestor != k_noParent; ancestor = m_parents[ancestor])
+        {
+            if (ancestor == index)
+            {
+                throw std::invalid_argument("A transform cannot be parented to its own subtree.");
+            }
+        }
+
+        m_parents[index] = parent;
+        m_orderValid = false;
+        markDirty(index);
+    }
+
+    /**
+     * @brief Turns a node into a root, its subtree follows it.
+     *
+     * @throws std::invalid_argument if the entity is not in the hierarchy.
+     */
+    void detach(ecs::EntityID _entity)
+    {
+        const uint32_t index = indexOf(_entity);
+        if (m_parents[index] == k_noParent) return;
+
+        m_parents[index] = k_noParent;
+        m_orderValid = false;
+        markDirty(index);
+    }
+
+    /**
+     * @brief Removes a node and all of its descendants.
+     *
+     * @return The number of removed nodes, 0 if the entity is not in the hierarchy.
+     */
+    size_t remove(ecs::EntityID _entity)
+    {
+        auto it = m_indices.find(_entity);
+        if (it == m_indices.end()) return 0;
+
+        // Descendants come after their ancestors in depth order, one forward sweep finds them all
+        ensureOrder();
+        const uint32_t first = it->second;
+
+        size_t removed = 1;
+        m_parents[first] = k_removed;
+
+        for (size_t i = first + 1; i < m_entities.size(); ++i)
+        {
+            const uint32_t parent = m_parents[i];
+            if (parent != k_noParent && parent != k_removed && m_parents[parent] == k_removed)
+            {
+                m_parents[i] = k_removed;
+                ++removed;
+            }
+        }
+
+        for (size_t i = first; i < m_entities.size(); ++i)
+        {
+            if (m_parents[i] == k_removed) m_indices.erase(m_entities[i]);
+        }
+
+        m_orderValid = false;
+        rebuildOrder();
+        return removed;
+    }
+
+    /**
+     * @brief Removes every node.
+     */
+    void clear() noexcept
+    {
+        m_entities.clear();
+        m_parents.clear();
+        m_locals.clear();
+        m_worlds.clear();
+        m_dirty.clear();
+        m_changed.clear();
+        m_levelStarts.clear();
+        m_indices.clear();
+        m_firstDirtyLevel = 0;
+        m_anyDirty = false;
+        m_anyChanged = false;
+        m_orderValid = true;
+    }
+
+    /**
+     * @brief Sets the transform of a node relative to its parent, its subtree is recomputed on the
+     * next update.
+     *
+     * @throws std::invalid_argument if the entity is not in the hierarchy.
+     */
+    void setLocalTransform(ecs::EntityID _entity, const glm::mat4& _local)
+    {
+        const uint32_t index = indexOf(_entity);
+        m_locals[index] = _local;
+        markDirty(index);
+    }
+
+    [[nodiscard]] const glm::mat4& localTransform(ecs::EntityID _entity) const
+    {
+        return m_locals[indexOf(_entity)];
+    }
+
+    /**
+     * @brief Returns the world transform of a node as of the last update.
+     *
+     * @throws std::invalid_argument if the entity is not in the hierarchy.
+     */
+    [[nodiscard]] const glm::mat4& worldTransform(ecs::EntityID _entity) const
+    {
+        return m_worlds[indexOf(_entity)];
+    }
+
+    /**
+     * @brief Returns whether the world transform of a node was recomputed by the last update
+     * (e.g. to only upload the matrices that moved).
+     */
+    [[nodiscard]] bool worldChanged(ecs::EntityID _entity) const
+    {
+        return m_changed[indexOf(_entity)] != 0;
+    }
+
+    // Returns the parent of a node, std::nullopt if it is a root.
+    [[nodiscard]] std::optional<ecs::EntityID> parentOf(ecs::EntityID _entity) const
+    {
+        const uint32_t parent = m_parents[indexOf(_entity)];
+        if (parent == k_noParent) return std::nullopt;
+        return m_entities[parent];
+    }
+
+    [[nodiscard]] bool contains(ecs::EntityID _entity) const
+    {
+        return m_indices.contains(_entity);
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return m_entities.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_entities.empty(); }
+
+    // Number of depth levels (only accurate once the order is rebuilt, e.g. after update()).
+    [[nodiscard]] size_t depthCount() const noexcept
+    {
+        return m_levelStarts.empty() ? 0 : m_levelStarts.size() - 1;
+    }
+
+    /**
+     * @brief Returns the entities in depth order, aligned with worldTransforms().
+     *
+     * @note The spans are invalidated by any structural change.
+     */
+    [[nodiscard]] std::span<const ecs::EntityID> entities()
+    {
+        ensureOrder();
+        return m_entities;
+    }
+
+    [[nodiscard]] std::span<const glm::mat4> worldTransforms()
+    {
+        ensureOrder();
+        return m_worlds;
+    }
+
+    /**
+     * @brief Recomputes the world transforms of every dirty node and of their descendants on the
+     * calling thread.
+     */
+    void update()
+    {
+        if (!beginUpdate()) return;
+
+        for (size_t level = m_firstDirtyLevel; level + 1 < m_levelStarts.size(); ++level)
+        {
+            updateRange(m_levelStarts[level], m_levelStarts[level + 1]);
+        }
+
+        endUpdate();
+    }
+
+    /**
+     * @brief Parallel version of update(), every level larger than the grain size is split into
+     * ranges processed by the pool.
+     *
+     * The calling thread processes the first range of each level and joins the others before the
+     * next level starts (children read the world matrices of their parents). If the pool rejects
+     * a task, its range is processed inline. The first exception thrown by a task is rethrown
+     * after the level is joined.
+     *
+     * @param _pool The executor, e.g. exec::ThreadPool.
+     * @param _grainSize The minimum number of nodes per task.
+     */
+    template <ecs::detail::TaskPool Pool>
+    void update(Pool& _pool, size_t _grainSize = k_defaultGrainSize)
+    {
+        if (!beginUpdate()) return;
+
+        using Future = std::decay_t<decltype(*_pool.enqueueToWorker([] {}))>;
+
+        _grainSize = std::max<size_t>(_grainSize, 1);
+        std::vector<Future> futures;
+
+        for (size_t level = m_firstDirtyLevel; level + 1 < m_levelStarts.size(); ++level)
+        {
+            const size_t first = m_levelStarts[level];
+            const size_t last = m_levelStarts[level + 1];
+
+            if (last - first <= _grainSize)
+            {
+                updateRange(first, last);
+                continue;
+            }
+
+            std::exception_ptr error;
+            auto runInline = [&](size_t _first, size_t _last)
+            {
+                try
+                {
+                    updateRange(_first, _last);
+                }
+                catch (...)
+                {
+                    if (!error) error = std::current_exception();
+                }
+            };
+
+            futures.clear();
+            for (size_t begin = first + _grainSize; begin < last; begin += _grainSize)
+            {
+                const size_t end = std::min(begin + _grainSize, last);
+                auto future =
+                    _pool.enqueueToWorker([this, begin, end] { updateRange(begin, end); });
+
+                if (future) futures.push_back(std::move(*future));
+                else runInline(begin, end);
+            }
+
+            runInline(first, first + _grainSize);
+
+            for (Future& future : futures)
+            {
+                try
+                {
+                    future.get();
+                }
+                catch (...)
+                {
+                    if (!error) error = std::current_exception();
+                }
+            }
+
+            if (error) std::rethrow_exception(error);
+        }
+
+        endUpdate();
+    }
+
+   private:
+    [[nodiscard]] uint32_t indexOf(ecs::EntityID _entity) const
+    {
+        auto it = m_indices.find(_entity);
+        if (it == m_indices.end())
+        {
+            throw std::invalid_argument("Entity is not part of the transform hierarchy.");
+        }
+        return it->second;
+    }
+
+    void insertNode(ecs::EntityID _entity, uint32_t _parent, const glm::mat4& _local)
+    {
+        if (m_indices.contains(_entity))
+        {
+            throw std::invalid_argument("Entity is already part of the transform hierarchy.");
+        }
+
+        const uint32_t index = static_cast<uint32_t>(m_entities.size());
+        m_indices.emplace(_entity, index);
+
+        m_entities.push_back(_entity);
+        m_parents.push_back(_parent);
+        m_locals.push_back(_local);
+        m_worlds.push_back(_local);
+        m_dirty.push_back(0);
+        m_changed.push_back(0);
+
+        m_orderValid = false;
+        markDirty(index);
+    }
+
+    void markDirty(uint32_t _index)
+    {
+        m_dirty[_index] = 1;
+
+        // The level of a node is only known while the order is valid, otherwise the rebuild resets
+        // the first dirty level
+        if (m_orderValid)
+        {
+            const size_t level = static_cast<size_t>(
+                std::upper_bound(m_levelStarts.begin(), m_levelStarts.end(), _index) -
+                m_levelStarts.begin() - 1);
+            m_firstDirtyLevel = m_anyDirty ? std::min(m_firstDirtyLevel, level) : level;
+        }
+
+        m_anyDirty = true;
+    }
+
+    // Returns false if nothing has to be recomputed.
+    bool beginUpdate()
+    {
+        ensureOrder();
+
+        if (!m_anyDirty || m_entities.empty())
+        {
+            if (m_anyChanged) std::fill(m_changed.begin(), m_changed.end(), uint8_t{0});
+            m_anyChanged = false;
+            m_anyDirty = false;
+            return false;
+        }
+
+        // Nodes above the first dirty level keep their flag from the previous update otherwise
+        if (m_anyChanged)
+        {
+            std::fill(m_changed.begin(), m_changed.begin() + m_levelStarts[m_firstDirtyLevel],
+                      uint8_t{0});
+        }
+
+        return true;
+    }
+
+    void endUpdate() noexcept
+    {
+        m_anyDirty = false;
+        m_anyChanged = true;
+        m_firstDirtyLevel = 0;
+    }
+
+    // Recomputes the nodes of [_first, _last), which must all belong to the same level.
+    void updateRange(size_t _first, size_t _last) noexcept
+    {
+        const uint32_t* parents = m_parents.data();
+        const glm::mat4* locals = m_locals.data();
+        glm::mat4* worlds = m_worlds.data();
+        uint8_t* dirty = m_dirty.data();
+        uint8_t* changed = m_changed.data();
+
+        for (size_t i = _first; i < _last; ++i)
+        {
+            const uint32_t parent = parents[i];
+            const bool root = parent == k_noParent;
+            const bool recompute = dirty[i] != 0 || (!root && changed[parent] != 0);
+
+            if (recompute) worlds[i] = root ? locals[i] : multiplyMat4(worlds[parent], locals[i]);
+
+            changed[i] = recompute;
+            dirty[i] = 0;
+        }
+    }
+
+    void ensureOrder()
+    {
+        if (!m_orderValid) rebuildOrder();
+    }
+
+    // Drops removed nodes and sorts the others by depth (stable, so siblings keep their order).
+    void rebuildOrder()
+    {
+        const size_t count = m_entities.size();
+        constexpr uint32_t unknown = std::numeric_limits<uint32_t>::max();
+
+        // Depth of every live node, each chain of ancestors is walked once thanks to the memo
+        std::vector<uint32_t> depths(count, unknown);
+        std::vector<uint32_t> chain;
+        size_t liveCount = 0;
+        uint32_t maxDepth = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (m_parents[i] == k_removed) continue;
+            ++liveCount;
+
+            uint32_t node = static_cast<uint32_t>(i);
+            while (depths[node] == unknown && m_parents[node] != k_noParent)
+            {
+                chain.push_back(node);
+                node = m_parents[node];
+            }
+
+            uint32_t depth = depths[node] == unknown ? 0 : depths[node];
+            depths[node] = depth;
+
+            while (!chain.empty())
+            {
+                depths[chain.back()] = ++depth;
+                chain.pop_back();
+            }
+
+            maxDepth = std::max(maxDepth, depths[i]);
+        }
+
+        m_levelStarts.assign(liveCount == 0 ? 0 : maxDepth + 2, 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (m_parents[i] != k_removed) ++m_levelStarts[depths[i] + 1];
+        }
+        for (size_t level = 1; level < m_levelStarts.size(); ++level)
+        {
+            m_levelStarts[level] += m_levelStarts[level - 1];
+        }
+
+        std::vector<uint32_t> newIndices(count, k_removed);
+        {
+            std::vector<size_t> cursors(m_levelStarts.begin(), m_levelStarts.end());
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (m_parents[i] != k_removed)
+                {
+                    newIndices[i] = static_cast<uint32_t>(cursors[depths[i]]++);
+                }
+            }
+        }
+
+        std::vector<ecs::EntityID> entities(liveCount);
+        std::vector<uint32_t> parents(liveCount);
+        std::vector<glm::mat4> locals(liveCount);
+        std::vector<glm::mat4> worlds(liveCount);
+        std::vector<uint8_t> dirty(liveCount);
+        std::vector<uint8_t> changed(liveCount);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint32_t target = newIndices[i];
+            if (target == k_removed) continue;
+
+            const uint32_t parent = m_parents[i];
+            entities[target] = m_entities[i];
+            parents[target] = parent == k_noParent ? k_noParent : newIndices[parent];
+            locals[target] = m_locals[i];
+            worlds[target] = m_worlds[i];
+            dirty[target] = m_dirty[i];
+            changed[target] = m_changed[i];
+            m_indices[m_entities[i]] = target;
+        }
+
+        m_entities = std::move(entities);
+        m_parents = std::move(parents);
+        m_locals = std::move(locals);
+        m_worlds = std::move(worlds);
+        m_dirty = std::move(dirty);
+        m_changed = std::move(changed);
+
+        // Dirty nodes may have moved to any level, the next update starts from the roots
+        m_firstDirtyLevel = 0;
+        m_orderValid = true;
+    }
+};
+
+} // namespace scene
+} // namespace mosaic
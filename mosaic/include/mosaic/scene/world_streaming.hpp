@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/ecs/entity_registry.hpp"
+#include "mosaic/exec/io_service.hpp"
+#include "mosaic/exec/task_future.hpp"
+
+#include "spatial_index.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+// The index of a cell of a WorldStreamer
+using WorldCellId = uint32_t;
+
+struct WorldStreamingSettings
+{
+    float loadDistance = 256.0f;            // cells closer to the camera are streamed in
+    float unloadDistance = 320.0f;          // and out once farther, at least loadDistance
+    uint64_t budget = 256ull * 1024 * 1024; // of the resident cells, in bytes of their snapshots
+    std::chrono::microseconds activationBudget{2000}; // a frame, to insert entities
+    size_t activationSlice = 256; // entities inserted between two looks at the clock
+};
+
+enum class WorldCellState : uint8_t
+{
+    unloaded,
+    loading,    /// Its snapshot is read.
+    activating, /// Its entities are inserted, a slice of the time budget a frame.
+    active,     /// Its entities are in the registry.
+    failed,     /// It could not be read or inserted, it is not streamed again.
+};
+
+/**
+ * @brief Streams the entities of a large world in and out of a registry by cells: a box of the
+ * world whose entities are stored in an ECS snapshot file (EntityRegistry::writeSnapshot(), see
+ * saveSnapshotToFile()).
+ *
+ * Every update() ranks the cells by their distance to the camera: those closer than
+ * loadDistance are read through the IoService, the nearest first, as long as the snapshots of
+ * the resident cells fit in the budget; those farther than unloadDistance, or pushed out of the
+ * budget by nearer ones, are unloaded (their entities destroyed, their read cancelled). A read
+ * cell is activated by EntityRegistry::appendSnapshot() slices until the time budget of the
+ * frame is spent, so a large cell takes several frames rather than a hitch; its snapshot bytes
+ * are released once every entity is in.
+ *
+ * The entities of a cell are new ones and IDs stored in its components are not remapped:
+ * references between the entities of a cell or to persistent ones go through other keys. An
+ * entity of a cell destroyed meanwhile is skipped when the cell is unloaded.
+ *
+ * The registry and the IoService must outlive the streamer. update() runs on the thread making
+ * the structural changes of the registry.
+ */
+class MOSAIC_API WorldStreamer final
+{
+   private:
+    struct Cell
+    {
+        Aabb bounds;
+        std::filesystem::path path;
+        uint64_t size = 0;
+        WorldCellState state = WorldCellState::unloaded;
+        float distance = 0.0f;
+
+        exec::TaskFuture<exec::IoBuffer> read;
+        exec::IoBuffer bytes;
+        ecs::SnapshotCursor cursor;
+        std::vector<ecs::EntityMeta> entities;
+    };
+
+    ecs::EntityRegistry* m_registry;
+    exec::IoService* m_io;
+    WorldStreamingSettings m_settings;
+
+    std::vector<Cell> m_cells;
+    std::vector<WorldCellId> m_order; // by distance, reused by every update
+    uint64_t m_committed = 0;
+
+   public:
+    WorldStreamer(ecs::EntityRegistry& _registry, exec::IoService& _io,
+                  const WorldStreamingSettings& _settings = {});
+    // Cancels the reads in flight, the entities of the active cells stay
+    ~WorldStreamer();
+
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+   public:
+    /**
+     * @brief A cell whose entities are within _bounds, stored in the snapshot at _path; its size
+     * is the one of the file now.
+     */
+    WorldCellId addCell(const Aabb& _bounds, std::filesystem::path _path);
+
+    /**
+     * @brief Once a frame: unloads, starts the reads and activates the read cells around the
+     * camera.
+     *
+     * @return The entities inserted.
+     */
+    size_t update(const glm::vec3& _camera);
+
+    // Destroys the entities of the cell and drops its snapshot, a failed cell may stream again.
+    void unload(WorldCellId _cell);
+
+    [[nodiscard]] WorldCellState getState(WorldCellId _cell) const { return m_cells[_cell].state; }
+    [[nodiscard]] std::span<const ecs::EntityMeta> getEntities(WorldCellId _cell) const
+    {
+        return m_cells[_cell].entities;
+    }
+    [[nodiscard]] uint64_t getCellSize(WorldCellId _cell) const { return m_cells[_cell].size; }
+
+    // The bytes of the cells loading, activating or active
+    [[nodiscard]] uint64_t getCommittedSize() const noexcept { return m_committed; }
+    [[nodiscard]] size_t getCellCount() const noexcept { return m_cells.size(); }
+
+    [[nodiscard]] const WorldStreamingSettings& getSettings() const noexcept { return m_settings; }
+
+   private:
+    void plan(const glm::vec3& _camera);
+    void poll();
+    size_t activate();
+    void fail(Cell& _cell);
+};
+
+} // namespace scene
+} // namespace mosaic
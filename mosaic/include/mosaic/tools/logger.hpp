@@ -4,11 +4,21 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <array>
 #include <unordered_map>
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -22,8 +32,28 @@ namespace tools
 {
 
 constexpr uint16_t k_logHistorySize = 1024;
+constexpr size_t k_logHistoryEntrySize = 256; // longer messages are truncated in the history
 constexpr const char* k_logsBasePath = "logs/";
 
+enum class LogLevel
+{
+    trace = 0,
+    debug = 1,
+    info = 2,
+    warn = 3,
+    error = 4,
+    critical = 5
+};
+
+/**
+ * @brief A message of a batch written by the asynchronous Logger, see Sink::writeBatch().
+ */
+struct LogEntry
+{
+    LogLevel level;
+    std::string message; // with its prefixes
+};
+
 class Sink;
 
 template <typename SinkType>
@@ -46,16 +76,42 @@ class Sink
     virtual void warn(const std::string& _message) const = 0;
     virtual void error(const std::string& _message) const = 0;
     virtual void critical(const std::string& _message) const = 0;
-};
 
-enum class LogLevel
-{
-    trace = 0,
-    debug = 1,
-    info = 2,
-    warn = 3,
-    error = 4,
-    critical = 5
+    /**
+     * @brief The messages the logging thread took from the ring in a row, in order. Calls the
+     * method of the level of each by default; override it to write them at once.
+     */
+    virtual void writeBatch(std::span<const LogEntry> _entries) const
+    {
+        for (const auto& entry : _entries) write(entry.level, entry.message);
+    }
+
+    void write(LogLevel _level, const std::string& _message) const
+    {
+        switch (_level)
+        {
+            case LogLevel::trace:
+                trace(_message);
+                break;
+            case LogLevel::debug:
+                debug(_message);
+                break;
+            case LogLevel::info:
+                info(_message);
+                break;
+            case LogLevel::warn:
+                warn(_message);
+                break;
+            case LogLevel::error:
+                error(_message);
+                break;
+            case LogLevel::critical:
+                critical(_message);
+                break;
+            default:
+                break;
+        }
+    }
 };
 
 /**
@@ -65,8 +121,149 @@ constexpr std::array<const char*, 6> c_levelNames = {
     "Trace", "Debug", "Info", "Warn", "Error", "Critical",
 };
 
+/**
+ * @brief The history of a thread: a ring of its last historySize messages, truncated to
+ * k_logHistoryEntrySize bytes, allocated once by its first message.
+ */
+class LogHistory;
+
+/**
+ * @brief The messages of a thread for a crash dump, oldest first.
+ */
+struct LogThreadHistory
+{
+    std::thread::id tid;
+    bool exited;
+    std::vector<std::string> messages;
+};
+
+/**
+ * @brief A log call of the asynchronous mode, formatted by the logging thread: the format string
+ * and the arguments are copied into the payload, its formatter is instantiated for their types.
+ */
+struct LogRecord
+{
+    static constexpr size_t k_payloadSize = 464;
+
+    // Returns the message of the payload; nullptr stops the logging thread
+    using Formatter = std::string (*)(const std::byte* _payload);
+
+    int64_t time; // core::Ticks, in wall time at output
+    std::thread::id tid;
+    Formatter format;
+    uint64_t position;   // in the queue
+    LogHistory* history; // of the calling thread
+    LogLevel level;
+    alignas(8) std::byte payload[k_payloadSize];
+};
+
+namespace detail
+{
+
+/**
+ * @brief How the asynchronous mode copies an argument into a LogRecord. The strings travel as
+ * their bytes and the arithmetic values as they are; the other types are formatted by the caller.
+ */
+template <typename T>
+struct LogArgument
+{
+    static constexpr bool k_deferred = false;
+};
+
+template <typename T>
+    requires std::is_arithmetic_v<T>
+struct LogArgument<T>
+{
+    using Stored = T;
+
+    static constexpr bool k_deferred = true;
+
+    static size_t size(const T&) noexcept { return sizeof(T); }
+
+    static void encode(std::byte*& _out, const T& _value) noexcept
+    {
+        std::memcpy(_out, &_value, sizeof(T));
+        _out += sizeof(T);
+    }
+
+    static T decode(const std::byte*& _in) noexcept
+    {
+        T value;
+        std::memcpy(&value, _in, sizeof(T));
+        _in += sizeof(T);
+
+        return value;
+    }
+};
+
+template <typename T>
+    requires(!std::is_arithmetic_v<T> && std::is_convertible_v<const T&, std::string_view>)
+struct LogArgument<T>
+{
+    using Stored = std::string_view;
+
+    static constexpr bool k_deferred = true;
+
+    static std::string_view view(const T& _value) noexcept
+    {
+        if constexpr (std::is_pointer_v<T>)
+        {
+            if (!_value) return {};
+        }
+
+        return std::string_view(_value);
+    }
+
+    static size_t size(const T& _value) noexcept { return sizeof(uint32_t) + view(_value).size(); }
+
+    static void encode(std::byte*& _out, const T& _value) noexcept
+    {
+        const std::string_view bytes = view(_value);
+        const auto length = static_cast<uint32_t>(bytes.size());
+
+        std::memcpy(_out, &length, sizeof(length));
+        std::memcpy(_out + sizeof(length), bytes.data(), bytes.size());
+        _out += sizeof(length) + bytes.size();
+    }
+
+    static std::string_view decode(const std::byte*& _in) noexcept
+    {
+        uint32_t length;
+        std::memcpy(&length, _in, sizeof(length));
+
+        const std::string_view bytes(reinterpret_cast<const char*>(_in + sizeof(length)), length);
+        _in += sizeof(length) + length;
+
+        return bytes;
+    }
+};
+
+// The format string, then the arguments
+template <typename... Stored>
+std::string formatLogRecord(const std::byte* _payload)
+{
+    const std::byte* in = _payload;
+    const std::string_view format = LogArgument<std::string_view>::decode(in);
+
+    // a braced list decodes in order
+    std::tuple<Stored...> args{LogArgument<Stored>::decode(in)...};
+
+    return std::apply([format](auto&... _args)
+                      { return fmt::vformat(format, fmt::make_format_args(_args...)); },
+                      args);
+}
+
+} // namespace detail
+
 /**
  * @brief Manages logging functionality, including sink management, history, and configuration.
+ *
+ * In the asynchronous mode (Config::async, read by initialize()) a log call only copies a
+ * LogRecord into a bounded MPSC ring, the logging thread formats the message, renders the
+ * prefixes and calls the sinks. Arguments other than strings and arithmetic values, records
+ * larger than the payload and the stack traces are formatted by the calling thread. A full ring
+ * makes the callers wait for the logging thread; critical messages are written before the call
+ * returns.
  */
 class Logger final
 {
@@ -87,15 +284,19 @@ class Logger final
 
         std::atomic_uint16_t historySize;
 
+        std::atomic_bool async; // formatting and sinks on the logging thread
+
         std::array<std::atomic_bool, 6> levelEnabled;
 
         Config(bool _showLevel = true, bool _showTid = false, bool _showTimestamp = true,
-               bool _showStackTrace = false, uint16_t _historySize = k_logHistorySize)
+               bool _showStackTrace = false, uint16_t _historySize = k_logHistorySize,
+               bool _async = false)
             : showLevel(_showLevel),
               showTid(_showTid),
               showTimestamp(_showTimestamp),
               showStackTrace(_showStackTrace),
-              historySize(_historySize)
+              historySize(_historySize),
+              async(_async)
         {
             for (auto& e : levelEnabled) e.store(true);
         }
@@ -109,6 +310,7 @@ class Logger final
             showTimestamp.store(other.showTimestamp.load());
             showStackTrace.store(other.showStackTrace.load());
             historySize.store(other.historySize.load());
+            async.store(other.async.load());
 
             for (size_t i = 0; i < levelEnabled.size(); ++i)
             {
@@ -120,18 +322,26 @@ class Logger final
     };
 
    private:
+    struct RecordQueue;
+
     MOSAIC_API static Logger* s_instance;
 
     std::unordered_map<std::string, std::shared_ptr<Sink>> m_sinks;
     std::mutex m_sinksMutex;
-    std::unordered_map<std::thread::id, std::vector<std::string>> m_history;
-    std::mutex m_historyMutex;
+    // Of every thread that logged, and kept for the last ones that exited
+    std::vector<std::shared_ptr<LogHistory>> m_histories;
+    mutable std::mutex m_historiesMutex;
+
+    // Asynchronous mode
+    bool m_async = false;
+    std::unique_ptr<RecordQueue> m_queue;
+    std::jthread m_writer;
 
     Config m_config;
 
    private:
-    Logger() = default;
-    ~Logger() = default;
+    Logger();
+    ~Logger();
 
    public:
     MOSAIC_API static bool initialize(const Config& _config = Config()) noexcept;
@@ -151,11 +361,8 @@ class Logger final
     inline void setShowStackTrace(bool _show) noexcept { m_config.showStackTrace = _show; }
     [[nodiscard]] inline bool isShowStackTrace() const noexcept { return m_config.showStackTrace; }
 
-    inline void setHistorySize(uint16_t _size) noexcept
-    {
-        m_config.historySize = _size;
-        m_history.reserve(_size);
-    }
+    /// The capacity of the histories of the threads that log next.
+    inline void setHistorySize(uint16_t _size) noexcept { m_config.historySize = _size; }
 
     [[nodiscard]] inline uint16_t getHistorySize() const noexcept { return m_config.historySize; }
 
@@ -169,6 +376,20 @@ class Logger final
         return m_config.levelEnabled[static_cast<int>(_level)];
     }
 
+    [[nodiscard]] inline bool isAsync() const noexcept { return m_async; }
+
+    /**
+     * @brief Whether a call of the level reaches log(), checked by the logging macros before
+     * their arguments are evaluated. Without a logger it does, log() reports it.
+     */
+    [[nodiscard]] static inline bool shouldLog(LogLevel _level) noexcept
+    {
+        return !s_instance || s_instance->isLevelEnabled(_level);
+    }
+
+    /// Returns once the messages logged before are written to the sinks (asynchronous mode).
+    MOSAIC_API void flush() noexcept;
+
     // Sink management
 
     template <typename SinkType>
@@ -215,21 +436,21 @@ class Logger final
 
     // History management
 
-    [[nodiscard]] inline const std::vector<std::string> getHistory() const noexcept
-    {
-        auto tid = std::this_thread::get_id();
+    /// The messages of the calling thread, oldest first; in the asynchronous mode, those written.
+    [[nodiscard]] MOSAIC_API std::vector<std::string> getHistory() const noexcept;
 
-        if (m_history.find(tid) == m_history.end()) return {};
+    MOSAIC_API void clearHistory() noexcept;
 
-        return m_history.at(tid);
-    }
-
-    inline void clearHistory() noexcept { m_history[std::this_thread::get_id()].clear(); }
+    /**
+     * @brief The histories of the threads that logged, for a crash dump. Each thread writes its
+     * own ring (the logging thread in the asynchronous mode) under the lock of that ring only.
+     */
+    [[nodiscard]] MOSAIC_API std::vector<LogThreadHistory> getHistories() const noexcept;
 
     // Logging methods
 
     template <typename... Args>
-    inline void log(LogLevel _level, const std::string& _message, Args&&... _args) noexcept
+    inline void log(LogLevel _level, std::string_view _message, Args&&... _args) noexcept
     {
         try
         {
@@ -237,6 +458,14 @@ class Logger final
 
             if (!m_config.levelEnabled[static_cast<int>(_level)]) return;
 
+            if constexpr ((detail::LogArgument<std::decay_t<Args>>::k_deferred && ...))
+            {
+                if (m_async && !m_config.showStackTrace && deferLog(_level, _message, _args...))
+                {
+                    return;
+                }
+            }
+
             // Format message with arguments
             std::string formattedMessage = fmt::vformat(_message, fmt::make_format_args(_args...));
 
@@ -248,36 +477,233 @@ class Logger final
         }
     }
 
+    /**
+     * @brief Logs the message of a rate-limited call site (see LogLimiter), followed by the count
+     * of the calls it suppressed since its last message.
+     */
+    template <typename... Args>
+    inline void logRepeated(LogLevel _level, uint64_t _suppressed, std::string_view _message,
+                            Args&&... _args) noexcept
+    {
+        if (_suppressed == 0) return log(_level, _message, std::forward<Args>(_args)...);
+
+        try
+        {
+            // formatted by the caller, these calls are the rare ones
+            log(_level, "{} ({} similar messages suppressed)",
+                fmt::vformat(_message, fmt::make_format_args(_args...)), _suppressed);
+        }
+        catch (const std::exception& e)
+        {
+            core::SystemConsole::printError(e.what());
+        }
+    }
+
     [[nodiscard]] static inline Logger* getInstance() { return s_instance; }
 
    private:
+    // Copies the call into a record, false if it does not fit
+    template <typename... Args>
+    inline bool deferLog(LogLevel _level, std::string_view _message,
+                         const Args&... _args) noexcept
+    {
+        const size_t size = detail::LogArgument<std::string_view>::size(_message) +
+                            (detail::LogArgument<std::decay_t<Args>>::size(_args) + ... + 0);
+
+        if (size > LogRecord::k_payloadSize) return false;
+
+        LogRecord* record = acquireRecord(_level);
+        if (!record) return false;
+
+        std::byte* out = record->payload;
+        detail::LogArgument<std::string_view>::encode(out, _message);
+        (detail::LogArgument<std::decay_t<Args>>::encode(out, _args), ...);
+
+        record->format =
+            &detail::formatLogRecord<typename detail::LogArgument<std::decay_t<Args>>::Stored...>;
+
+        commitRecord(*record);
+
+        return true;
+    }
+
+    // A free record of the queue, waits while it is full. nullptr on the logging thread.
+    MOSAIC_API LogRecord* acquireRecord(LogLevel _level) noexcept;
+    // Publishes the record to the logging thread, and waits for it if critical.
+    MOSAIC_API void commitRecord(LogRecord& _record) noexcept;
+
     MOSAIC_API void logInternal(LogLevel _level, std::string _message) noexcept;
+
+    void runWriter() noexcept;
+    // Formats the record into the batch
+    void takeRecord(const LogRecord& _record, std::vector<LogEntry>& _batch,
+                    std::vector<LogHistory*>& _histories) noexcept;
+    void writeBatch(const std::vector<LogEntry>& _batch,
+                    const std::vector<LogHistory*>& _histories) noexcept;
+
+    // The history of the calling thread, created by its first message (nullptr if that failed)
+    LogHistory* localHistory() noexcept;
+
+    // The timestamp, thread and level prefixes
+    std::string decorate(LogLevel _level, std::string_view _message, std::thread::id _tid,
+                         int64_t _ticks) const;
+    void emit(LogLevel _level, const std::string& _message);
+};
+
+/**
+ * @brief The state of a rate-limited call site (MOSAIC_LOG_EVERY_N, MOSAIC_LOG_RATE_LIMITED), a
+ * constant-initialized static of the macro: the calls it lets through, and the count of those it
+ * suppressed in between. A suppressed call is an atomic increment, its arguments are not
+ * evaluated.
+ */
+class LogLimiter final
+{
+   private:
+    std::atomic<uint64_t> m_calls{0};
+    std::atomic<uint64_t> m_suppressed{0};
+    std::atomic<int64_t> m_next{std::numeric_limits<int64_t>::min()}; // ns, steady clock
+
+   public:
+    constexpr LogLimiter() noexcept = default;
+
+    LogLimiter(const LogLimiter&) = delete;
+    LogLimiter& operator=(const LogLimiter&) = delete;
+
+    /// Lets the first call through, then one in `_n`.
+    [[nodiscard]] inline bool everyN(uint64_t _n, uint64_t& _suppressed) noexcept
+    {
+        const uint64_t call = m_calls.fetch_add(1, std::memory_order_relaxed);
+        if (_n > 1 && call % _n != 0) return false;
+
+        _suppressed = call == 0 ? 0 : _n - 1;
+
+        return true;
+    }
+
+    /// Lets a call through, then none for `_interval`.
+    [[nodiscard]] inline bool every(std::chrono::nanoseconds _interval,
+                                    uint64_t& _suppressed) noexcept
+    {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+
+        int64_t next = m_next.load(std::memory_order_relaxed);
+
+        // one of the threads that reach the deadline together logs
+        if (now < next || !m_next.compare_exchange_strong(next, now + _interval.count(),
+                                                          std::memory_order_relaxed))
+        {
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+
+        return true;
+    }
 };
 
 } // namespace tools
 } // namespace mosaic
 
+// The lowest level compiled in, 0 (trace) to 5 (critical), 6 for none: the calls below it are
+// removed, arguments included. Trace in Debug and Dev builds, info otherwise; define it to
+// override.
+#if !defined(MOSAIC_LOG_MIN_LEVEL)
 #if defined(MOSAIC_DEBUG_BUILD) || defined(MOSAIC_DEV_BUILD)
-#define MOSAIC_TRACE(_Msg, ...)                                               \
-    mosaic::tools::Logger::getInstance()->log(mosaic::tools::LogLevel::trace, \
-                                              _Msg __VA_OPT__(, __VA_ARGS__))
-#define MOSAIC_DEBUG(_Msg, ...)                                               \
-    mosaic::tools::Logger::getInstance()->log(mosaic::tools::LogLevel::debug, \
-                                              _Msg __VA_OPT__(, __VA_ARGS__))
+#define MOSAIC_LOG_MIN_LEVEL 0
+#else
+#define MOSAIC_LOG_MIN_LEVEL 2
+#endif
+#endif
+
+#define MOSAIC_LOG_LEVEL_COMPILED(_Level) \
+    (static_cast<int>(mosaic::tools::LogLevel::_Level) >= MOSAIC_LOG_MIN_LEVEL)
+
+// The arguments are evaluated only if the level is enabled, at compile time and at runtime
+#define MOSAIC_LOG(_Level, _Msg, ...)                                                    \
+    do                                                                                   \
+    {                                                                                    \
+        if constexpr (MOSAIC_LOG_LEVEL_COMPILED(_Level))                                 \
+        {                                                                                \
+            if (mosaic::tools::Logger::shouldLog(mosaic::tools::LogLevel::_Level))       \
+            {                                                                            \
+                mosaic::tools::Logger::getInstance()->log(mosaic::tools::LogLevel::_Level, \
+                                                          _Msg __VA_OPT__(, __VA_ARGS__)); \
+            }                                                                            \
+        }                                                                                \
+    } while (0)
+
+// Logs the first call of the site, then one in _N, with the count of those skipped
+#define MOSAIC_LOG_EVERY_N(_Level, _N, _Msg, ...)                                            \
+    do                                                                                       \
+    {                                                                                        \
+        if constexpr (MOSAIC_LOG_LEVEL_COMPILED(_Level))                                     \
+        {                                                                                    \
+            static mosaic::tools::LogLimiter _logLimiter;                                    \
+            uint64_t _logSuppressed = 0;                                                     \
+            if (mosaic::tools::Logger::shouldLog(mosaic::tools::LogLevel::_Level) &&         \
+                _logLimiter.everyN(_N, _logSuppressed))                                      \
+            {                                                                                \
+                mosaic::tools::Logger::getInstance()->logRepeated(                           \
+                    mosaic::tools::LogLevel::_Level, _logSuppressed,                         \
+                    _Msg __VA_OPT__(, __VA_ARGS__));                                         \
+            }                                                                                \
+        }                                                                                    \
+    } while (0)
+
+// Logs a call of the site at most every _IntervalMs, with the count of those suppressed
+#define MOSAIC_LOG_RATE_LIMITED(_Level, _IntervalMs, _Msg, ...)                              \
+    do                                                                                       \
+    {                                                                                        \
+        if constexpr (MOSAIC_LOG_LEVEL_COMPILED(_Level))                                     \
+        {                                                                                    \
+            static mosaic::tools::LogLimiter _logLimiter;                                    \
+            uint64_t _logSuppressed = 0;                                                     \
+            if (mosaic::tools::Logger::shouldLog(mosaic::tools::LogLevel::_Level) &&         \
+                _logLimiter.every(std::chrono::milliseconds(_IntervalMs), _logSuppressed))   \
+            {                                                                                \
+                mosaic::tools::Logger::getInstance()->logRepeated(                           \
+                    mosaic::tools::LogLevel::_Level, _logSuppressed,                         \
+                    _Msg __VA_OPT__(, __VA_ARGS__));                                         \
+            }                                                                                \
+        }                                                                                    \
+    } while (0)
+
+// The levels below MOSAIC_LOG_MIN_LEVEL expand to nothing, their arguments are not even compiled
+#if MOSAIC_LOG_MIN_LEVEL <= 0
+#define MOSAIC_TRACE(_Msg, ...) MOSAIC_LOG(trace, _Msg __VA_OPT__(, __VA_ARGS__))
 #else
 #define MOSAIC_TRACE(_Msg, ...) ((void)0)
+#endif
+
+#if MOSAIC_LOG_MIN_LEVEL <= 1
+#define MOSAIC_DEBUG(_Msg, ...) MOSAIC_LOG(debug, _Msg __VA_OPT__(, __VA_ARGS__))
+#else
 #define MOSAIC_DEBUG(_Msg, ...) ((void)0)
 #endif
 
-#define MOSAIC_INFO(_Msg, ...)                                               \
-    mosaic::tools::Logger::getInstance()->log(mosaic::tools::LogLevel::info, \
-                                              _Msg __VA_OPT__(, __VA_ARGS__))
-#define MOSAIC_WARN(_Msg, ...)                                               \
-    mosaic::tools::Logger::getInstance()->log(mosaic::tools::LogLevel::warn, \
-                                              _Msg __VA_OPT__(, __VA_ARGS__))
-#define MOSAIC_ERROR(_Msg, ...)                                               \
-    mosaic::tools::Logger::getInstance()->log(mosaic::tools::LogLevel::error, \
-                                              _Msg __VA_OPT__(, __VA_ARGS__))
-#define MOSAIC_CRITICAL(_Msg, ...)                                               \
-    mosaic::tools::Logger::getInstance()->log(mosaic::tools::LogLevel::critical, \
-                                              _Msg __VA_OPT__(, __VA_ARGS__))
+#if MOSAIC_LOG_MIN_LEVEL <= 2
+#define MOSAIC_INFO(_Msg, ...) MOSAIC_LOG(info, _Msg __VA_OPT__(, __VA_ARGS__))
+#else
+#define MOSAIC_INFO(_Msg, ...) ((void)0)
+#endif
+
+#if MOSAIC_LOG_MIN_LEVEL <= 3
+#define MOSAIC_WARN(_Msg, ...) MOSAIC_LOG(warn, _Msg __VA_OPT__(, __VA_ARGS__))
+#else
+#define MOSAIC_WARN(_Msg, ...) ((void)0)
+#endif
+
+#if MOSAIC_LOG_MIN_LEVEL <= 4
+#define MOSAIC_ERROR(_Msg, ...) MOSAIC_LOG(error, _Msg __VA_OPT__(, __VA_ARGS__))
+#else
+#define MOSAIC_ERROR(_Msg, ...) ((void)0)
+#endif
+
+#if MOSAIC_LOG_MIN_LEVEL <= 5
+#define MOSAIC_CRITICAL(_Msg, ...) MOSAIC_LOG(critical, _Msg __VA_OPT__(, __VA_ARGS__))
+#else
+#define MOSAIC_CRITICAL(_Msg, ...) ((void)0)
+#endif
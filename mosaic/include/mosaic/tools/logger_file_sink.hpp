@@ -0,0 +1,84 @@
+#pragma once
+
+#include "mosaic/defines.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <pieces/core/result.hpp>
+
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace tools
+{
+
+/**
+ * @brief Logging sink that appends the messages to `<k_logsBasePath><name>.log` through a
+ * userspace buffer.
+ *
+ * The buffer is written out once it holds bufferSize bytes, once flushIntervalMs passed since the
+ * last write of the file, on a critical message and at shutdown. Past maxFileSize the file is
+ * rotated to `<name>.1.log` (the older ones shifted up to `<name>.<maxFiles>.log`); the file of
+ * the previous session is rotated the same way by initialize(). writeBatch() appends a batch of
+ * the asynchronous Logger under a single lock.
+ */
+class MOSAIC_API FileSink final : public Sink
+{
+   public:
+    struct Config
+    {
+        std::string name;
+        size_t bufferSize;
+        uint32_t flushIntervalMs;
+        uint64_t maxFileSize;
+        uint32_t maxFiles; // rotated files kept
+
+        Config(std::string _name = "mosaic", size_t _bufferSize = 256 * 1024,
+               uint32_t _flushIntervalMs = 1000, uint64_t _maxFileSize = 16 * 1024 * 1024,
+               uint32_t _maxFiles = 5)
+            : name(std::move(_name)),
+              bufferSize(_bufferSize),
+              flushIntervalMs(_flushIntervalMs),
+              maxFileSize(_maxFileSize),
+              maxFiles(_maxFiles)
+        {
+        }
+    };
+
+   private:
+    struct State;
+
+    std::unique_ptr<State> m_state;
+
+   public:
+    explicit FileSink(Config _config = Config());
+    ~FileSink() override;
+
+    FileSink(FileSink&&) noexcept;
+    FileSink& operator=(FileSink&&) noexcept;
+
+    pieces::RefResult<Sink, std::string> initialize() override;
+    void shutdown() override;
+
+    void trace(const std::string& _message) const override;
+    void debug(const std::string& _message) const override;
+    void info(const std::string& _message) const override;
+    void warn(const std::string& _message) const override;
+    void error(const std::string& _message) const override;
+    void critical(const std::string& _message) const override;
+
+    void writeBatch(std::span<const LogEntry> _entries) const override;
+
+    /// Writes the buffer to the file.
+    void flush() const;
+
+    [[nodiscard]] std::string getPath() const;
+};
+
+} // namespace tools
+} // namespace mosaic
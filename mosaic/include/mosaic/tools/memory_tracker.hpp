@@ -0,0 +1,70 @@
+#pragma once
+
+#include "mosaic/defines.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pieces/memory/allocation_stats.hpp>
+
+namespace mosaic
+{
+namespace tools
+{
+
+/**
+ * @brief The counters of a subsystem at the time of MemoryTracker::getSummary().
+ */
+struct MemorySummary
+{
+    std::string subsystem;
+    size_t reservedBytes;
+    size_t allocatedBytes;
+    size_t peakBytes;
+    uint64_t allocations;
+    float fragmentation; // share of the reserved bytes not allocated
+
+    // Filled by the pieces::ProxyAllocator in front of the allocators, zeros without one
+    std::array<uint64_t, pieces::AllocationStats::k_sizeClasses> sizeClasses;
+    std::array<uint64_t, pieces::AllocationStats::k_lifetimeClasses> lifetimeClasses;
+};
+
+/**
+ * @brief Per-subsystem memory counters: allocators opt in by attaching the stats of their
+ * subsystem (`setStats(&MemoryTracker::getStats("ecs"))` on the pieces allocators, an
+ * ecs::ChunkArena or the VMA allocator), the others cost nothing.
+ *
+ * While the tracer records TraceCategory::memory, traceCounters() turns the counters into
+ * counter events once per frame (called by core::Application::update()): `Memory <subsystem>`
+ * allocated, reserved and peak in MiB, and fragmentation. The subsystems allocating through a
+ * pieces::ProxyAllocator add their histograms, the allocations by size class (`Memory <subsystem>
+ * size <= 64 B`) and the deallocated ones by lifetime (`Memory <subsystem> lifetime < 10 ms`).
+ */
+class MOSAIC_API MemoryTracker final
+{
+   public:
+    MemoryTracker() = delete;
+
+   public:
+    /**
+     * @brief The counters of the subsystem, created by the first call; the reference stays
+     * valid until the end of the program. Takes a lock, get the stats once and keep them.
+     */
+    [[nodiscard]] static pieces::AllocationStats& getStats(std::string_view _subsystem);
+
+    /// The counters of every subsystem, by decreasing reserved bytes.
+    [[nodiscard]] static std::vector<MemorySummary> getSummary();
+
+    /// The counter events of every subsystem, if the tracer records TraceCategory::memory.
+    static void traceCounters() noexcept;
+
+    /// Restarts the peaks of every subsystem from their current allocated bytes.
+    static void resetPeaks() noexcept;
+};
+
+} // namespace tools
+} // namespace mosaic
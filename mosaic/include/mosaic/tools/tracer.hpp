@@ -2,19 +2,27 @@
 
 #include "mosaic/defines.hpp"
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
 #include <mutex>
-#include <stack>
+#include <span>
+#include <stop_token>
 #include <string>
+#include <string_view>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
 MOSAIC_DISABLE_ALL_WARNINGS
 #include <nlohmann/json.hpp>
 MOSAIC_POP_WARNINGS
 
+#include <pieces/containers/small_string.hpp>
+
 #include "logger.hpp"
 
 namespace mosaic
@@ -51,27 +59,31 @@ enum class TracePhase
     flow_end = 12         // 'f' - Flow end
 };
 
+// The names and the arguments of the traces fit inline, without an allocation per event
+inline constexpr size_t k_traceInlineName = 48;
+inline constexpr size_t k_traceInlineArgs = 64;
+
 struct Trace
 {
     TraceCategory category;
     TracePhase phase;
-    std::string name;
-    std::string args; // JSON string for additional arguments
+    pieces::SmallString<k_traceInlineName> name;
+    pieces::SmallString<k_traceInlineArgs> args; // JSON string for additional arguments
     size_t tid;
     uint32_t pid;
-    int64_t timestamp;
-    int64_t duration;
-    uint64_t id; // For flow events and object tracking
+    int64_t timestamp; // ns
+    int64_t duration;  // ns
+    uint64_t id;       // For flow events and object tracking
 
     Trace() = default;
 
-    Trace(TraceCategory _category, TracePhase _phase, const std::string& _name, size_t _tid,
+    Trace(TraceCategory _category, TracePhase _phase, std::string_view _name, size_t _tid,
           uint32_t _pid, int64_t _timestamp, int64_t _duration = 0, uint64_t _id = 0,
-          const std::string& _args = "{}")
+          std::string_view _args = "{}")
         : category(_category),
           phase(_phase),
-          name(_name),
-          args(_args),
+          name(_name.data(), _name.size()),
+          args(_args.data(), _args.size()),
           tid(_tid),
           pid(_pid),
           timestamp(_timestamp),
@@ -79,6 +91,40 @@ struct Trace
           id(_id){};
 };
 
+/**
+ * @brief Event recorded by the tracing calls without arguments: no allocation and no lock, the
+ * name is interned. Resolved into a Trace by the flusher.
+ */
+struct TraceEvent
+{
+    int64_t timestamp; // core::Ticks
+    int64_t value;     // duration in ticks (complete), flow id, or the bits of a counter value
+    uint32_t name;     // interned, see Tracer::internName()
+    uint8_t category;
+    uint8_t phase;
+};
+
+/**
+ * @brief Rolling statistics of a traced scope over the last frames, see
+ * Tracer::getScopeStatistics(). A sample is the time of every pass of the scope in one frame, on
+ * every thread, in milliseconds.
+ */
+class TraceStream;
+class SamplingProfiler;
+struct StackSample;
+
+struct ScopeStatistics
+{
+    std::string name;
+    uint32_t frames;      // of the window that ran the scope, the count of the samples
+    double callsPerFrame; // over those frames
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+};
+
 /**
  * @brief Lookup table for trace categories.
  */
@@ -93,6 +139,29 @@ constexpr std::array<const char*, 13> c_phaseNames = {
     "X", "B", "E", "i", "C", "M", "P", "N", "O", "D", "s", "t", "f",
 };
 
+/**
+ * @brief A traced scope whose name is a string literal, built at compile time (constinit in the
+ * MOSAIC_TRACE_SCOPE and MOSAIC_TRACE_FUNCTION macros). Its name is interned at the first pass
+ * recorded, along with the file and line, and the events only carry the id.
+ */
+struct TraceSite final
+{
+    std::string_view name;
+    std::string_view file;
+    uint32_t line;
+    TraceCategory category;
+    mutable std::atomic<uint32_t> id{0}; // 0 until interned
+
+    consteval TraceSite(const char* _name, TraceCategory _category, const char* _file,
+                        uint32_t _line) noexcept
+        : name(_name), file(_file), line(_line), category(_category)
+    {
+    }
+
+    TraceSite(const TraceSite&) = delete;
+    TraceSite& operator=(const TraceSite&) = delete;
+};
+
 /**
  * @brief RAII helper for automatic trace scoping.
  */
@@ -102,7 +171,11 @@ class MOSAIC_API ScopedTrace final
     bool m_valid;
 
    public:
-    ScopedTrace(const std::string& _name, TraceCategory _category = TraceCategory::scope) noexcept;
+    ScopedTrace(std::string_view _name, TraceCategory _category = TraceCategory::scope) noexcept;
+
+    /// No string, no call while the tracer or the category of the site is off: one relaxed load.
+    explicit ScopedTrace(const TraceSite& _site) noexcept;
+
     ~ScopedTrace() noexcept;
 
     ScopedTrace(const ScopedTrace&) = delete;
@@ -113,6 +186,33 @@ class MOSAIC_API ScopedTrace final
 
 /**
  * @brief Manages tracing functionality, including trace storage, metadata, and configuration.
+ *
+ * Every thread records its events into its own ring buffer (single producer, single consumer) of
+ * POD TraceEvents, timestamped with core::Ticks (the CPU counter where it is safe): beginTrace()
+ * and endTrace() take no lock and allocate nothing, and nested traces wait for their end in a
+ * per-thread stack. A background thread drains the rings every few milliseconds into the chunks of
+ * a compact binary trace file (`.mtrace`, layout in tracer.cpp), appended to from that thread only
+ * and rotated past maxFileSizeMb. A full ring drops its new events (counted, see
+ * getDroppedTraceCount()) rather than blocking the thread.
+ *
+ * Events carrying JSON arguments (and metadata) keep the former locked path, they are rare.
+ *
+ * scripts/trace_to_chrome.py converts the trace files to the Chrome trace format, which
+ * chrome://tracing and Perfetto open.
+ *
+ * The flusher also aggregates the complete events into frames, delimited by markFrame(): the
+ * rolling statistics of every scope over the last statisticsFrames frames, for a live overlay
+ * (getScopeStatistics()). A frame is settled 100 ms after its end, so that the events traced late
+ * (the GPU spans, frames in flight behind) reach it; flush() settles them all.
+ *
+ * With a stream port, the flusher also sends the events of every drain to a viewer connected over
+ * TCP, in the format of the trace files (`scripts/trace_to_chrome.py --connect`). A viewer too
+ * slow for the game loses the events of the low-priority categories first (function, scope,
+ * custom), then every event, never stalling the flusher; see getStreamDroppedCount().
+ *
+ * The sampling profiler records the call stacks of every thread at a fixed interval, as sample
+ * events of raw return addresses; the modules of the process go to the metadata of the trace, so
+ * that `scripts/trace_to_chrome.py --symbolize` can name the frames offline.
  */
 class MOSAIC_API Tracer final
 {
@@ -131,16 +231,24 @@ class MOSAIC_API Tracer final
         std::atomic_uint32_t flushIntervalMs;
         std::atomic_uint32_t maxTraces;
         std::atomic_uint32_t maxFileSizeMb; // MB
+        std::atomic_uint32_t statisticsFrames; // the window of the scope statistics
+        std::atomic_uint32_t streamPort;       // TCP port of the live stream, 0 for none
+        std::atomic_uint32_t samplingIntervalUs; // of the sampling profiler, 0 for none
 
         std::array<std::atomic_bool, 8> categoryEnabled;
 
         Config(bool _enabled = true, bool _autoFlush = true, uint32_t _flushIntervalMs = 1000,
-               uint32_t _maxTraces = 10000, uint32_t _maxFileSizeMb = 100)
+               uint32_t _maxTraces = 10000, uint32_t _maxFileSizeMb = 100,
+               uint32_t _statisticsFrames = 120, uint32_t _streamPort = 0,
+               uint32_t _samplingIntervalUs = 0)
             : enabled(_enabled),
               autoFlush(_autoFlush),
               flushIntervalMs(_flushIntervalMs),
               maxTraces(_maxTraces),
-              maxFileSizeMb(_maxFileSizeMb)
+              maxFileSizeMb(_maxFileSizeMb),
+              statisticsFrames(_statisticsFrames),
+              streamPort(_streamPort),
+              samplingIntervalUs(_samplingIntervalUs)
         {
             for (auto& e : categoryEnabled) e.store(true);
         }
@@ -154,6 +262,9 @@ class MOSAIC_API Tracer final
             flushIntervalMs.store(other.flushIntervalMs.load());
             maxTraces.store(other.maxTraces.load());
             maxFileSizeMb.store(other.maxFileSizeMb.load());
+            statisticsFrames.store(other.statisticsFrames.load());
+            streamPort.store(other.streamPort.load());
+            samplingIntervalUs.store(other.samplingIntervalUs.load());
 
             for (size_t i = 0; i < categoryEnabled.size(); ++i)
             {
@@ -165,32 +276,72 @@ class MOSAIC_API Tracer final
     };
 
    private:
+    struct ThreadBuffer;
+    struct FrameProfile;
+
     static Tracer* s_instance;
 
+    // A bit per recorded category, and k_recordingEnabled while the tracer exists and is enabled
+    static constexpr uint32_t k_recordingEnabled = 1u << 31;
+    static std::atomic<uint32_t> s_recording;
+
     // Actual trace storage
 
-    std::unordered_map<std::thread::id, std::stack<Trace>> m_activeTraces;
-    mutable std::mutex m_tracesMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers; // of every thread that traced
+    size_t m_retiredDroppedCount = 0; // dropped by the threads that exited since
+    mutable std::mutex m_buffersMutex;
     std::vector<Trace> m_completedTraces;
     mutable std::mutex m_completedMutex;
+    mutable std::mutex m_drainMutex; // the consumer side of the rings, and the trace file
+
+    // Drained events not written yet, already framed as the event chunks of the file
+    std::vector<char> m_pending;
+    size_t m_openChunk = 0; // offset of the chunk appended to, the size of m_pending if none
+    size_t m_pendingCount = 0;
+
+    // The frames of the scope statistics, their events aggregated by the drain
+    std::unique_ptr<FrameProfile> m_profile;
+    uint32_t m_frameName = 0; // of the instant events of markFrame()
+
+    // Drains the rings every k_drainPeriod, sooner when one is half full
+    std::jthread m_flusher;
+    std::mutex m_flusherMutex;
+    std::condition_variable_any m_flusherWakeUp;
+    bool m_drainRequested = false;
 
     // Metadata for the trace session
 
     nlohmann::json m_metadata;
     std::string m_currentFile;
     uint32_t m_fileCounter;
+    std::ofstream m_file;
+    uint64_t m_fileSize = 0;
+    size_t m_namesWritten = 0;   // ids below are defined in the current file
+    size_t m_sourcesWritten = 0; // likewise for the sources of the sites
+
+    // Live stream, under m_drainMutex
+    std::unique_ptr<TraceStream> m_stream;
+    size_t m_streamed = 0;       // bytes of m_pending sent to the stream
+    size_t m_namesStreamed = 0;  // ids below are defined for the viewer
+    size_t m_sourcesStreamed = 0;
+    std::vector<char> m_streamBuffer;
+    std::atomic<uint64_t> m_streamDropped{0};
+
+    // Sampling profiler, feeding the completed traces from its own thread
+    std::unique_ptr<SamplingProfiler> m_sampler;
+    mutable std::mutex m_samplerMutex;
 
     // Timing and ID management
 
     std::chrono::steady_clock::time_point m_startTime;
     std::chrono::steady_clock::time_point m_lastFlush;
-    uint64_t m_nextTraceId;
+    std::atomic<uint64_t> m_nextTraceId;
 
     Config m_config;
 
    private:
-    Tracer() : m_fileCounter(0), m_nextTraceId(1){};
-    ~Tracer() = default;
+    Tracer();
+    ~Tracer();
 
    public:
     static bool initialize(const Config& _config = Config()) noexcept;
@@ -198,7 +349,12 @@ class MOSAIC_API Tracer final
 
     // Configurable options
 
-    void setEnabled(bool _enabled) noexcept { m_config.enabled = _enabled; }
+    void setEnabled(bool _enabled) noexcept
+    {
+        m_config.enabled = _enabled;
+        setRecordingBits(k_recordingEnabled, _enabled);
+    }
+
     [[nodiscard]] bool isEnabled() const noexcept { return m_config.enabled; }
 
     void setAutoFlush(bool _autoFlush) noexcept { m_config.autoFlush = _autoFlush; }
@@ -210,9 +366,17 @@ class MOSAIC_API Tracer final
     void setMaxTraces(uint32_t _maxTraces) noexcept { m_config.maxTraces = _maxTraces; }
     [[nodiscard]] uint32_t getMaxTraces() const noexcept { return m_config.maxTraces; }
 
+    /// The statistics restart over the new window.
+    void setStatisticsFrames(uint32_t _frames) noexcept { m_config.statisticsFrames = _frames; }
+    [[nodiscard]] uint32_t getStatisticsFrames() const noexcept
+    {
+        return m_config.statisticsFrames;
+    }
+
     void enableCategory(TraceCategory _category, bool _enabled) noexcept
     {
         m_config.categoryEnabled[static_cast<int>(_category)] = _enabled;
+        setRecordingBits(1u << static_cast<uint32_t>(_category), _enabled);
     }
 
     [[nodiscard]] bool isCategoryEnabled(TraceCategory _category) const noexcept
@@ -220,64 +384,220 @@ class MOSAIC_API Tracer final
         return m_config.categoryEnabled[static_cast<int>(_category)];
     }
 
+    /**
+     * @brief Whether a tracer exists, is enabled and records the category. A relaxed load, for
+     * the paths that should cost nothing while tracing is off.
+     */
+    [[nodiscard]] static bool isRecording(TraceCategory _category) noexcept
+    {
+        const uint32_t bits = k_recordingEnabled | (1u << static_cast<uint32_t>(_category));
+        return (s_recording.load(std::memory_order_relaxed) & bits) == bits;
+    }
+
     // Tracing methods
 
-    void beginTrace(const std::string& _name, TraceCategory _category = TraceCategory::function,
-                    const std::string& _args = "{}") noexcept;
+    void beginTrace(std::string_view _name, TraceCategory _category = TraceCategory::function,
+                    std::string_view _args = "{}") noexcept;
+    void beginTrace(const TraceSite& _site) noexcept;
     void endTrace() noexcept;
 
-    void instantTrace(const std::string& _name, TraceCategory _category = TraceCategory::function,
-                      const std::string& _args = "{}") noexcept;
+    void instantTrace(std::string_view _name, TraceCategory _category = TraceCategory::function,
+                      std::string_view _args = "{}") noexcept;
 
-    void counterTrace(const std::string& _name, double _value,
+    void counterTrace(std::string_view _name, double _value,
                       TraceCategory _category = TraceCategory::function) noexcept;
 
-    void metadataTrace(const std::string& _name, const std::string& _value,
+    void metadataTrace(std::string_view _name, std::string_view _value,
                        TraceCategory _category = TraceCategory::function) noexcept;
 
-    void objectCreated(const std::string& _name, const std::string& _args = "{}",
+    void objectCreated(std::string_view _name, std::string_view _args = "{}",
                        TraceCategory _category = TraceCategory::function) noexcept;
-    void objectSnapshot(const std::string& _name, const std::string& _args = "{}",
+    void objectSnapshot(std::string_view _name, std::string_view _args = "{}",
                         TraceCategory _category = TraceCategory::function) noexcept;
-    void objectDestroyed(const std::string& _name, const std::string& _args = "{}",
+    void objectDestroyed(std::string_view _name, std::string_view _args = "{}",
                          TraceCategory _category = TraceCategory::function) noexcept;
 
-    uint64_t beginFlowTrace(const std::string& _name,
+    /**
+     * @brief Records a span timed elsewhere, on the track `_track` rather than the calling
+     * thread: the GPU timestamps of the render passes. Takes the locked path, for a few spans per
+     * frame.
+     */
+    void spanTrace(std::string_view _name, TraceCategory _category,
+                   std::chrono::steady_clock::time_point _start, std::chrono::nanoseconds _duration,
+                   uint64_t _track) noexcept;
+
+    /// Names the track of spanTrace() `_track` in the viewers.
+    void nameTrack(uint64_t _track, std::string_view _name) noexcept;
+
+    /**
+     * @brief Ends the frame and begins the next one, an instant "Frame" event of the thread.
+     * Called by core::Application::update().
+     */
+    void markFrame() noexcept;
+
+    uint64_t beginFlowTrace(std::string_view _name,
                             TraceCategory _category = TraceCategory::function) noexcept;
-    void stepFlowTrace(uint64_t _flowId, const std::string& _name) noexcept;
-    void endFlowTrace(uint64_t _flowId, const std::string& _name) noexcept;
+    void stepFlowTrace(uint64_t _flowId, std::string_view _name) noexcept;
+    void endFlowTrace(uint64_t _flowId, std::string_view _name) noexcept;
+
+    /**
+     * @brief Id of the name in the process-wide name table, the events store it instead of the
+     * string. Names are never freed; each thread caches the names it used last, so a name
+     * recorded again costs a comparison.
+     */
+    [[nodiscard]] static uint32_t internName(std::string_view _name) noexcept;
 
     // Manual flush control
 
+    /// Drains every ring and writes the events to the trace file.
     void flush() noexcept;
+
+    /// Discards the events not written yet. Traces still open are kept.
     void clear() noexcept;
 
+    // Live streaming
+
+    /**
+     * @brief Listens for a viewer on the TCP port (0 for one picked by the system), in place of
+     * the current stream. Fails on the web.
+     */
+    bool startStreaming(uint16_t _port = 0) noexcept;
+    void stopStreaming() noexcept;
+
+    /// The port listened on, 0 when not streaming.
+    [[nodiscard]] uint16_t getStreamPort() const noexcept;
+    [[nodiscard]] bool isStreamConnected() const noexcept;
+
+    /// Events the viewers were too slow to receive.
+    [[nodiscard]] uint64_t getStreamDroppedCount() const noexcept
+    {
+        return m_streamDropped.load(std::memory_order_relaxed);
+    }
+
+    // Sampling
+
+    /**
+     * @brief Samples the call stacks of every thread every `_interval`, in place of the current
+     * sampling. Fails where the platform cannot sample (see SamplingProfiler), or while another
+     * profiler samples the process.
+     */
+    bool startSampling(
+        std::chrono::microseconds _interval = std::chrono::microseconds(1000)) noexcept;
+    void stopSampling() noexcept;
+
+    [[nodiscard]] bool isSampling() const noexcept;
+
+    /// Stacks recorded, and the ones the threads did not answer in time, since sampling started.
+    [[nodiscard]] uint64_t getSampleCount() const noexcept;
+    [[nodiscard]] uint64_t getMissedSampleCount() const noexcept;
+
     // Statistics
 
     [[nodiscard]] size_t getActiveTraceCount() const noexcept;
     [[nodiscard]] size_t getCompletedTraceCount() const noexcept;
+    [[nodiscard]] size_t getDroppedTraceCount() const noexcept;
     [[nodiscard]] double getTracingOverheadMs() const noexcept;
 
+    /**
+     * @brief The statistics of the scopes that ran in the settled frames of the window, by
+     * decreasing mean. Computed on call, a few times per second for an overlay.
+     */
+    [[nodiscard]] std::vector<ScopeStatistics> getScopeStatistics() const noexcept;
+
+    /// The statistics of the frame times themselves, named "Frame".
+    [[nodiscard]] ScopeStatistics getFrameStatistics() const noexcept;
+
     [[nodiscard]] static Tracer* getInstance() noexcept { return s_instance; }
 
    private:
-    void flushToFile() noexcept;
+    static void setRecordingBits(uint32_t _bits, bool _set) noexcept
+    {
+        if (_set)
+            s_recording.fetch_or(_bits, std::memory_order_relaxed);
+        else
+            s_recording.fetch_and(~_bits, std::memory_order_relaxed);
+    }
+
+    // Interns the name of the site, and keeps where the first site of the name is
+    static uint32_t internSite(const TraceSite& _site) noexcept;
+
+    // Pushes the trace on the stack of the thread; a 0 name pushes it skipped.
+    void beginInterned(uint32_t _name, TraceCategory _category, std::string_view _args) noexcept;
+
+    // The ring of the calling thread, created by its first event (nullptr if that failed)
+    ThreadBuffer* localBuffer() noexcept;
+    void record(ThreadBuffer& _buffer, const TraceEvent& _event) noexcept;
+    int64_t toNanoseconds(int64_t _ticks) const noexcept;
+
+    // Records an event without duration, in the ring unless it has arguments.
+    void recordPoint(TracePhase _phase, std::string_view _name, TraceCategory _category,
+                     std::string_view _args = "{}", uint64_t _id = 0) noexcept;
+
+    // Appends an event with arguments, or a metadata event, to the completed traces.
+    void pushTrace(Trace&& _trace) noexcept;
+
+    // Appends the stacks of a sampling round as sample events, on the sampling thread.
+    void recordSamples(std::span<const StackSample> _samples) noexcept;
+
+    // Moves the events of the rings and the completed traces to m_pending, under m_drainMutex.
+    void drain() noexcept;
+    void runFlusher(std::stop_token _stop) noexcept;
+
+    void appendEvent(int64_t _timestamp, int64_t _value, uint64_t _tid, uint32_t _name,
+                     TraceCategory _category, TracePhase _phase, std::string_view _args);
+    void closeChunk() noexcept;
+
+    // Adds the events of a drain to their frames, and moves the frames settled before
+    // `_settledBefore` (ns) to the statistics.
+    void aggregateFrames(int64_t _drainStart, int64_t _settledBefore) noexcept;
+
+    // Sends the events of m_pending not streamed yet to the viewer, under m_drainMutex.
+    void streamPending() noexcept;
+
+    // Writes m_pending and the names it uses to the trace file, under m_drainMutex.
+    void writePending() noexcept;
+    // Opens the next trace file and writes its header and metadata.
+    bool openFile() noexcept;
     void rotateFile() noexcept;
     std::string generateFileName() noexcept;
-    nlohmann::json traceToJson(const Trace& _trace) const noexcept;
-    int64_t getCurrentTimestamp() const noexcept;
+    // core::Ticks, converted to nanoseconds by the flusher
+    static int64_t getCurrentTimestamp() noexcept;
 };
 
+inline ScopedTrace::ScopedTrace(const TraceSite& _site) noexcept
+    : m_valid(Tracer::isRecording(_site.category))
+{
+    if (!m_valid) [[likely]] return;
+
+    if (auto* manager = Tracer::getInstance())
+        manager->beginTrace(_site);
+    else
+        m_valid = false;
+}
+
+inline ScopedTrace::~ScopedTrace() noexcept
+{
+    if (!m_valid) [[likely]] return;
+
+    if (auto* manager = Tracer::getInstance()) manager->endTrace();
+}
+
 } // namespace tools
 } // namespace mosaic
 
 #if defined(MOSAIC_DEBUG_BUILD) || defined(MOSAIC_DEV_BUILD)
 
+// The name must be a string literal
+#define MOSAIC_TRACE_SITE_SCOPE(_Name, _Category)                                           \
+    constinit static const mosaic::tools::TraceSite _traceSite(_Name, _Category, __FILE__, \
+                                                               __LINE__);                  \
+    mosaic::tools::ScopedTrace _trace(_traceSite)
+
 #define MOSAIC_TRACE_FUNCTION() \
-    mosaic::tools::ScopedTrace _trace(__FUNCTION__, mosaic::tools::TraceCategory::function)
+    MOSAIC_TRACE_SITE_SCOPE(__FUNCTION__, mosaic::tools::TraceCategory::function)
 
 #define MOSAIC_TRACE_SCOPE(_Name) \
-    mosaic::tools::ScopedTrace _trace(_Name, mosaic::tools::TraceCategory::scope)
+    MOSAIC_TRACE_SITE_SCOPE(_Name, mosaic::tools::TraceCategory::scope)
 
 #define MOSAIC_TRACE_BEGIN(_Name, _Category) \
     mosaic::tools::Tracer::getInstance()->beginTrace(_Name, _Category)
@@ -309,6 +629,7 @@ class MOSAIC_API Tracer final
 
 #else
 
+#define MOSAIC_TRACE_SITE_SCOPE(_Name, _Category) ((void)0)
 #define MOSAIC_TRACE_FUNCTION() ((void)0)
 #define MOSAIC_TRACE_SCOPE(name) ((void)0)
 #define MOSAIC_TRACE_BEGIN(_Name, _Category) ((void)0)
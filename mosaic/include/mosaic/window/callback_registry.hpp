@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "mosaic/exec/move_only_task.hpp"
+
+namespace mosaic
+{
+namespace window
+{
+
+template <typename Signature>
+class CallbackRegistry;
+
+/**
+ * @brief The callbacks of a window event, invoked in place in the order they were added: no copy
+ * of the list, no allocation for a callback fitting the inline buffer of exec::MoveOnlyTask.
+ *
+ * A callback is known by the id add() returned, never reused by the registry. A dispatched
+ * callback may add or remove callbacks, itself included: the added ones are invoked from the next
+ * dispatch on, the removed ones are skipped at once and erased when the outermost dispatch
+ * returns, so the entries never move under a dispatch.
+ *
+ * Not thread-safe, like the windows.
+ */
+template <typename... Args>
+class CallbackRegistry<void(Args...)>
+{
+   public:
+    using Callback = exec::MoveOnlyTask<void(Args...)>;
+
+   private:
+    struct Entry
+    {
+        size_t id; // 0 once removed during a dispatch
+        Callback callback;
+    };
+
+    std::vector<Entry> m_entries;
+    std::vector<Entry> m_added; // during a dispatch, appended once it returns
+
+    size_t m_nextId = 1;
+    uint32_t m_dispatchDepth = 0;
+    bool m_hasRemoved = false;
+
+   public:
+    CallbackRegistry() = default;
+
+    CallbackRegistry(const CallbackRegistry&) = delete;
+    CallbackRegistry& operator=(const CallbackRegistry&) = delete;
+
+   public:
+    /// The id of _callback, 0 (no callback) if _callback is empty.
+    size_t add(Callback _callback)
+    {
+        if (!_callback) return 0;
+
+        const size_t id = m_nextId++;
+
+        if (m_dispatchDepth > 0)
+        {
+            m_added.push_back(Entry{id, std::move(_callback)});
+        }
+        else
+        {
+            m_entries.push_back(Entry{id, std::move(_callback)});
+        }
+
+        return id;
+    }
+
+    /// False if _id is no callback of the registry.
+    bool remove(size_t _id)
+    {
+        if (_id == 0) return false;
+
+        auto matches = [_id](const Entry& _entry) { return _entry.id == _id; };
+
+        auto it = std::find_if(m_entries.begin(), m_entries.end(), matches);
+        if (it != m_entries.end())
+        {
+            if (m_dispatchDepth > 0)
+            {
+                it->id = 0;
+                m_hasRemoved = true;
+            }
+            else
+            {
+                m_entries.erase(it);
+            }
+
+            return true;
+        }
+
+        // not dispatched yet, nothing iterates them
+        auto added = std::find_if(m_added.begin(), m_added.end(), matches);
+        if (added == m_added.end()) return false;
+
+        m_added.erase(added);
+        return true;
+    }
+
+    void dispatch(Args... _args)
+    {
+        DispatchScope scope(*this);
+
+        // the entries added meanwhile wait in m_added: the vector neither grows nor moves
+        const size_t count = m_entries.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            Entry& entry = m_entries[i];
+            if (entry.id != 0) entry.callback(_args...);
+        }
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        size_t count = m_added.size();
+        for (const Entry& entry : m_entries) count += entry.id != 0;
+
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+   private:
+    // Settles the removals and additions when the outermost dispatch returns, or throws
+    struct DispatchScope
+    {
+        CallbackRegistry& registry;
+
+        explicit DispatchScope(CallbackRegistry& _registry) : registry(_registry)
+        {
+            ++registry.m_dispatchDepth;
+        }
+
+        ~DispatchScope()
+        {
+            if (--registry.m_dispatchDepth == 0) registry.settle();
+        }
+
+        DispatchScope(const DispatchScope&) = delete;
+        DispatchScope& operator=(const DispatchScope&) = delete;
+    };
+
+    void settle()
+    {
+        if (m_hasRemoved)
+        {
+            std::erase_if(m_entries, [](const Entry& _entry) { return _entry.id == 0; });
+            m_hasRemoved = false;
+        }
+
+        if (m_added.empty()) return;
+
+        for (Entry& entry : m_added) m_entries.push_back(std::move(entry));
+        m_added.clear();
+    }
+};
+
+} // namespace window
+} // namespace mosaic
@@ -2,14 +2,15 @@
 
 #include <string>
 #include <array>
-#include <functional>
-#include <vector>
+#include <cstdint>
+#include <memory>
 
 #include <pieces/core/result.hpp>
 
 #include <glm/glm.hpp>
 
 #include "mosaic/defines.hpp"
+#include "mosaic/window/callback_registry.hpp"
 
 namespace mosaic
 {
@@ -96,44 +97,33 @@ struct WindowProperties
           cursorProperties() {};
 };
 
-template <typename Fn>
-struct WindowEventCallback
-{
-    using CallbackFn = Fn;
-    Fn callback;
-    size_t id;
-
-    WindowEventCallback(size_t _id, const Fn& _callback)
-        : id(_id), callback(std::move(_callback)) {};
-};
-
 // Callback type definitions
 
-using WindowCloseCallbackFn = std::function<void()>;
-using WindowFocusCallbackFn = std::function<void(int)>;
-using WindowResizeCallbackFn = std::function<void(int, int)>;
-using WindowRefreshCallbackFn = std::function<void()>;
-using WindowIconifyCallbackFn = std::function<void(int)>;
-using WindowMaximizeCallbackFn = std::function<void(int)>;
-using WindowDropCallbackFn = std::function<void(int, const char**)>;
-using WindowScrollCallbackFn = std::function<void(double, double)>;
-using WindowCursorEnterCallbackFn = std::function<void(int)>;
-using WindowPosCallbackFn = std::function<void(int, int)>;
-using WindowContentScaleCallbackFn = std::function<void(float, float)>;
-using WindowCharCallbackFn = std::function<void(unsigned int)>;
-
-using WindowCloseCallback = WindowEventCallback<WindowCloseCallbackFn>;
-using WindowFocusCallback = WindowEventCallback<WindowFocusCallbackFn>;
-using WindowResizeCallback = WindowEventCallback<WindowResizeCallbackFn>;
-using WindowRefreshCallback = WindowEventCallback<WindowRefreshCallbackFn>;
-using WindowIconifyCallback = WindowEventCallback<WindowIconifyCallbackFn>;
-using WindowMaximizeCallback = WindowEventCallback<WindowMaximizeCallbackFn>;
-using WindowDropCallback = WindowEventCallback<WindowDropCallbackFn>;
-using WindowScrollCallback = WindowEventCallback<WindowScrollCallbackFn>;
-using WindowCursorEnterCallback = WindowEventCallback<WindowCursorEnterCallbackFn>;
-using WindowPosCallback = WindowEventCallback<WindowPosCallbackFn>;
-using WindowContentScaleCallback = WindowEventCallback<WindowContentScaleCallbackFn>;
-using WindowCharCallback = WindowEventCallback<WindowCharCallbackFn>;
+using WindowCloseCallback = CallbackRegistry<void()>;
+using WindowFocusCallback = CallbackRegistry<void(int)>;
+using WindowResizeCallback = CallbackRegistry<void(int, int)>;
+using WindowRefreshCallback = CallbackRegistry<void()>;
+using WindowIconifyCallback = CallbackRegistry<void(int)>;
+using WindowMaximizeCallback = CallbackRegistry<void(int)>;
+using WindowDropCallback = CallbackRegistry<void(int, const char**)>;
+using WindowScrollCallback = CallbackRegistry<void(double, double)>;
+using WindowCursorEnterCallback = CallbackRegistry<void(int)>;
+using WindowPosCallback = CallbackRegistry<void(int, int)>;
+using WindowContentScaleCallback = CallbackRegistry<void(float, float)>;
+using WindowCharCallback = CallbackRegistry<void(unsigned int)>;
+
+using WindowCloseCallbackFn = WindowCloseCallback::Callback;
+using WindowFocusCallbackFn = WindowFocusCallback::Callback;
+using WindowResizeCallbackFn = WindowResizeCallback::Callback;
+using WindowRefreshCallbackFn = WindowRefreshCallback::Callback;
+using WindowIconifyCallbackFn = WindowIconifyCallback::Callback;
+using WindowMaximizeCallbackFn = WindowMaximizeCallback::Callback;
+using WindowDropCallbackFn = WindowDropCallback::Callback;
+using WindowScrollCallbackFn = WindowScrollCallback::Callback;
+using WindowCursorEnterCallbackFn = WindowCursorEnterCallback::Callback;
+using WindowPosCallbackFn = WindowPosCallback::Callback;
+using WindowContentScaleCallbackFn = WindowContentScaleCallback::Callback;
+using WindowCharCallbackFn = WindowCharCallback::Callback;
 
 enum class WindowCallbackType
 {
@@ -218,10 +208,19 @@ class MOSAIC_API Window
     [[nodiscard]] const WindowProperties getWindowProperties() const;
     [[nodiscard]] const CursorProperties getCursorProperties() const;
 
-#define DEFINE_CALLBACK(_Type, _Name, _Params, _Args)              \
-    size_t register##_Name##Callback(const _Type::CallbackFn& cb); \
-    void unregister##_Name##Callback(size_t id);                   \
-    std::vector<_Type> get##_Name##Callbacks();                    \
+    // The events delivered so far, every callback invocation whether registered to or not
+    [[nodiscard]] uint64_t getEventCount() const;
+
+    /**
+     * @brief Delivers the events batched since the last call, as one event of each kind: the
+     * scroll offsets summed, the last position. Called by the window system once it polled.
+     */
+    void flushBatchedEvents();
+
+#define DEFINE_CALLBACK(_Type, _Name, _Params, _Args)                \
+    size_t register##_Name##Callback(_Type::Callback _callback);     \
+    void unregister##_Name##Callback(size_t _id);                    \
+    [[nodiscard]] const _Type& get##_Name##Callbacks() const;        \
     void invoke##_Name##Callbacks _Params;
 
 #include "callbacks.def"
@@ -231,6 +230,10 @@ class MOSAIC_API Window
    protected:
     [[nodiscard]] WindowProperties& getWindowPropertiesInternal();
     [[nodiscard]] CursorProperties& getCursorPropertiesInternal();
+
+    // A burst of these (a trackpad scroll, a window drag) is delivered by flushBatchedEvents()
+    void batchWindowScrollEvent(double _xoffset, double _yoffset);
+    void batchWindowPosEvent(int _x, int _y);
 };
 
 } // namespace window
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <unordered_map>
@@ -70,16 +72,43 @@ class MOSAIC_API WindowSystem : public core::EngineSystem
      */
     virtual pieces::RefResult<System, std::string> update() override = 0;
 
+    /**
+     * @brief Same as update(), blocking first until an event arrives, wakeUp() is called or
+     * _timeout passed: the loop of an idle application sleeps there (see
+     * core::Application::setReactive()).
+     *
+     * Where the events are not dispatched by the window system (Android, the web) it does not
+     * block: the platform loop waits instead, with core::Application::getIdleWait().
+     */
+    virtual pieces::RefResult<System, std::string> waitEvents(std::chrono::nanoseconds _timeout)
+    {
+        (void)_timeout;
+        return update();
+    }
+
+    /// Makes the current or the next waitEvents() return, callable from any thread.
+    virtual void wakeUp() noexcept {}
+
     [[nodiscard]] Window* getWindow(const std::string& _windowId) const;
 
     [[nodiscard]] inline size_t getWindowCount() const;
 
+    /// Nothing to render until a window is restored: the update can wait for the events.
+    [[nodiscard]] bool areAllWindowsMinimized() const;
+
+    /// The events delivered to the windows so far: some arrived when it changed over an update.
+    [[nodiscard]] uint64_t getEventCount() const;
+
     [[nodiscard]] static inline WindowSystem* getInstance()
     {
         if (!g_instance) MOSAIC_ERROR("WindowSystem has not been created yet!");
 
         return g_instance;
     }
+
+   protected:
+    /// Window::flushBatchedEvents() of every window, once the events of an update are polled.
+    void flushBatchedEvents();
 };
 
 } // namespace window
@@ -1,16 +1,31 @@
 #include "mosaic/core/application.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
 #include <exception>
 #include <memory>
+#include <optional>
 #include <string>
+#include <thread>
 #include <utility>
 #include <mosaic/tools/logger.hpp>
+#include <mosaic/tools/tracer.hpp>
+#include <mosaic/tools/memory_tracker.hpp>
 #include <mosaic/core/timer.hpp>
+#include <mosaic/core/asset_manager.hpp>
+#include <mosaic/core/sys_performance.hpp>
+#include <mosaic/core/thermal_governor.hpp>
+#include <mosaic/core/virtual_file_system.hpp>
+#include <mosaic/exec/main_thread_queue.hpp>
+#include <mosaic/exec/render_thread.hpp>
+#include <mosaic/exec/thread_pool.hpp>
 #include <mosaic/graphics/render_system.hpp>
 #include <mosaic/input/input_system.hpp>
 #include <mosaic/window/window_system.hpp>
 #include <pieces/core/result.hpp>
+#include <pieces/memory/frame_arena.hpp>
 
 using namespace std::chrono_literals;
 
@@ -19,6 +34,26 @@ namespace mosaic
 namespace core
 {
 
+// The longest a reactive update sleeps, for the tasks posted to the main thread queue without
+// waking it
+static constexpr std::chrono::nanoseconds k_maxIdleWait = 250ms;
+
+// The thermal state is polled at most this often (the headroom forecast is NaN when faster)
+static constexpr std::chrono::nanoseconds k_thermalPollInterval = 1s;
+
+// The work target of the hint sessions without a frame rate limit
+static constexpr double k_defaultTargetRate = 60.0;
+
+// Reports the time from its creation to its destruction to a hint session
+struct HintReport
+{
+    PerformanceHintSession& session;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    explicit HintReport(PerformanceHintSession& _session) : session(_session) {}
+    ~HintReport() { session.reportActualDuration(std::chrono::steady_clock::now() - start); }
+};
+
 struct Application::Impl
 {
     static bool s_created;
@@ -26,10 +61,73 @@ struct Application::Impl
     std::string appName;
     ApplicationState state = ApplicationState::uninitialized;
 
+    // Created before the systems and destroyed after them, they read their files through it
+    VirtualFileSystem fileSystem;
+
     std::unique_ptr<window::WindowSystem> windowSystem;
     std::unique_ptr<input::InputSystem> inputSystem;
     std::unique_ptr<graphics::RenderSystem> renderSystem;
 
+    // Destroyed before the systems, its assets may hold their resources
+    AssetManager assetManager{&fileSystem};
+
+    // Tasks handed to the main thread, drained every frame within the budget
+    exec::MainThreadQueue mainThreadQueue;
+    std::chrono::microseconds mainThreadBudget = 2ms;
+
+    // Created once pipelined rendering is enabled, renders a frame while the next is simulated
+    std::unique_ptr<exec::RenderThread> renderThread;
+    // Pipelined, the input of an update reaches the frame rendered during the next one
+    std::optional<std::chrono::steady_clock::time_point> pipelinedInput;
+
+    // The time of every frame, split in steps when fixedTimestep
+    FixedTimestep frameTiming;
+    bool fixedTimestep = false;
+    uint32_t pendingSteps = 0; // of the frame, for onFixedUpdate()
+    bool skipFrameTime = true; // until the first frame after a resume
+
+    // Reactive mode: the frames rendered on change only, the updates sleeping in between
+    std::atomic<bool> reactive = false; // read by invalidate(), from any thread
+    std::atomic<bool> invalidated = true;
+    std::chrono::steady_clock::time_point scheduledFrame =
+        std::chrono::steady_clock::time_point::max();
+    uint64_t windowEvents = 0;  // delivered when the last update looked
+    bool renderPending = false; // pipelined: the last update simulated, its snapshot to render
+
+    // The frames start at most at the lower of the two rates, 0 for no limit
+    double frameRateLimit = 0.0;
+    double thermalFrameRateLimit = 0.0;
+    std::chrono::steady_clock::time_point lastFrameStart;
+
+    // The level of the thermal state, applied to the ThreadPool, the frame rate and the resolution
+    bool thermalGoverned = true;
+    ThermalGovernor thermalGovernor;
+    uint32_t appliedThermalLevel = 0;
+    std::chrono::steady_clock::time_point nextThermalPoll;
+
+    // The work of each frame reported to the platform, see PerformanceHintSession
+    bool hintSessionsCreated = false;
+    PerformanceHintSession mainThreadHints;
+    PerformanceHintSession renderThreadHints; // created and used on the render thread
+    std::chrono::nanoseconds renderThreadTarget{0}; // its target, 0 before it is created
+
+    // The interval of the effective frame rate limit, 60 Hz without one
+    [[nodiscard]] std::chrono::nanoseconds getFrameTarget() const noexcept
+    {
+        const double limit = getEffectiveFrameRateLimit();
+
+        return std::chrono::nanoseconds(
+            static_cast<int64_t>(1e9 / (limit > 0.0 ? limit : k_defaultTargetRate)));
+    }
+
+    [[nodiscard]] double getEffectiveFrameRateLimit() const noexcept
+    {
+        if (frameRateLimit <= 0.0) return thermalFrameRateLimit;
+        if (thermalFrameRateLimit <= 0.0) return frameRateLimit;
+
+        return std::min(frameRateLimit, thermalFrameRateLimit);
+    }
+
     Impl(const std::string& _name)
         : exitRequested(false),
           appName(_name),
@@ -40,6 +138,10 @@ struct Application::Impl
     {
         assert(!s_created && "Application  already exists!");
         s_created = true;
+
+#if !defined(MOSAIC_PLATFORM_ANDROID)
+        fileSystem.mountDirectory("", ".");
+#endif
     };
 
     ~Impl() { s_created = false; }
@@ -47,7 +149,11 @@ struct Application::Impl
 
 bool Application::Impl::s_created = false;
 
-Application::Application(const std::string& _appName) : m_impl(new Impl(_appName)) {}
+Application::Application(const std::string& _appName) : m_impl(new Impl(_appName))
+{
+    // a load completed on a worker is a change to render
+    m_impl->assetManager.setOnChange([this] { invalidate(); });
+}
 
 Application::~Application() { delete m_impl; }
 
@@ -76,13 +182,15 @@ pieces::RefResult<Application, std::string> Application::initialize()
         return pieces::ErrRef<Application, std::string>(std::move(inputCtxRegResult.error()));
     }
 
+    // The window is up and its input registered before the GPU starts: the render system runs its
+    // startup stages on the thread pool and keeps answering the window events meanwhile
     m_impl->renderSystem->initialize();
 
     auto rndrCtxCreateRes = m_impl->renderSystem->createContext(wndCreateResult.unwrap());
 
     if (rndrCtxCreateRes.isErr())
     {
-        return pieces::ErrRef<Application, std::string>(std::move(inputCtxRegResult.error()));
+        return pieces::ErrRef<Application, std::string>(std::move(rndrCtxCreateRes.error()));
     }
 
     try
@@ -108,12 +216,69 @@ pieces::RefResult<Application, std::string> Application::update()
         return pieces::OkRef<Application, std::string>(*this);
     }
 
+    // idle, until an event arrives or a frame is due; the events are dispatched below
+    if (m_impl->reactive) (void)m_impl->windowSystem->waitEvents(getIdleWait());
+
+    limitFrameRate();
+
     core::Timer::tick();
 
+    // the temporaries of the frame before last are released as each thread allocates again
+    pieces::FrameArena::beginFrame();
+
+    // the time of the first frame after a resume spans the pause
+    uint32_t steps = 0;
+    if (!std::exchange(m_impl->skipFrameTime, false))
+    {
+        const std::chrono::duration<double> frameTime(core::Timer::getDeltaTime());
+        steps = m_impl->frameTiming.advance(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(frameTime));
+    }
+    m_impl->pendingSteps = m_impl->fixedTimestep ? steps : 0;
+
+    // the scope statistics of the tracer are per frame
+    if (auto* tracer = tools::Tracer::getInstance()) tracer->markFrame();
+    tools::MemoryTracker::traceCounters();
+
+    if (!m_impl->hintSessionsCreated)
+    {
+        m_impl->hintSessionsCreated = true;
+
+        const int32_t mainThread = SystemPerformance::getCurrentThreadId();
+        m_impl->mainThreadHints =
+            SystemPerformance::createHintSession({&mainThread, 1}, m_impl->getFrameTarget());
+    }
+
+    if (m_impl->renderThread) return updatePipelined();
+
+    // the input is sampled as late as the frames in flight allow
+    m_impl->renderSystem->pace();
+
+    // the work of the frame, the pacing left out
+    const HintReport report(m_impl->mainThreadHints);
+
+    // nothing renders: the resolution limit reaches the contexts between two frames
+    governThermals();
+
     m_impl->windowSystem->update();
 
+    // after the window events, before anything of the frame is recorded
+    size_t drainedTasks = m_impl->mainThreadQueue.drainFor(m_impl->mainThreadBudget);
+    drainedTasks += m_impl->assetManager.update();
+
     m_impl->inputSystem->update();
 
+    if (m_impl->reactive && !consumeChanges(drainedTasks))
+    {
+        return pieces::OkRef<Application, std::string>(*this);
+    }
+
+    // the frame rendered below reacts to it, see RenderContext::consumeInput()
+    if (const auto input = m_impl->inputSystem->getOldestInput())
+    {
+        m_impl->renderSystem->consumeInput(*input);
+    }
+
     try
     {
         onPollInputs();
@@ -125,11 +290,22 @@ pieces::RefResult<Application, std::string> Application::update()
             std::string("Application input polling error: ") + e.what());
     }
 
+    try
+    {
+        onExtract();
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR("Application extraction error: {}", e.what());
+        return pieces::ErrRef<Application, std::string>(
+            std::string("Application extraction error: ") + e.what());
+    }
+
     m_impl->renderSystem->update();
 
     try
     {
-        onUpdate();
+        simulate();
     }
     catch (const std::exception& e)
     {
@@ -141,10 +317,207 @@ pieces::RefResult<Application, std::string> Application::update()
     return pieces::OkRef<Application, std::string>(*this);
 }
 
+pieces::RefResult<Application, std::string> Application::updatePipelined()
+{
+    // the frame before rendered the snapshot of the last update, nothing renders from here on
+    try
+    {
+        m_impl->renderThread->wait();
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR("Application render error: {}", e.what());
+        return pieces::ErrRef<Application, std::string>(std::string("Application render error: ") +
+                                                        e.what());
+    }
+
+    // the work of the frame, the wait for the render thread left out
+    const HintReport report(m_impl->mainThreadHints);
+
+    governThermals();
+
+    // resizes and surface changes reach the contexts while they are idle
+    m_impl->windowSystem->update();
+
+    size_t drainedTasks = m_impl->mainThreadQueue.drainFor(m_impl->mainThreadBudget);
+    drainedTasks += m_impl->assetManager.update(); // its finalizations touch the idle contexts
+
+    // reactive, the snapshot of an update that simulated nothing is the one already rendered
+    if (!m_impl->reactive || std::exchange(m_impl->renderPending, false))
+    {
+        try
+        {
+            onExtract();
+        }
+        catch (const std::exception& e)
+        {
+            MOSAIC_ERROR("Application extraction error: {}", e.what());
+            return pieces::ErrRef<Application, std::string>(
+                std::string("Application extraction error: ") + e.what());
+        }
+
+        // the snapshot extracted is that of the input of the last update
+        if (const auto input = std::exchange(m_impl->pipelinedInput, std::nullopt))
+        {
+            m_impl->renderSystem->consumeInput(*input);
+        }
+
+        // paced on the render thread: the frames in flight no longer hold the simulation back
+        m_impl->renderThread->kick(
+            [impl = m_impl, target = m_impl->getFrameTarget()]
+            {
+                impl->renderSystem->pace();
+
+                // the render thread is known once it runs a frame
+                PerformanceHintSession& hints = impl->renderThreadHints;
+                if (impl->renderThreadTarget.count() == 0)
+                {
+                    const int32_t renderThread = SystemPerformance::getCurrentThreadId();
+                    hints = SystemPerformance::createHintSession({&renderThread, 1}, target);
+                }
+                else if (impl->renderThreadTarget != target)
+                {
+                    hints.updateTargetDuration(target);
+                }
+                impl->renderThreadTarget = target;
+
+                const HintReport report(hints);
+                impl->renderSystem->update();
+            });
+    }
+
+    m_impl->inputSystem->update();
+
+    if (m_impl->reactive)
+    {
+        if (!consumeChanges(drainedTasks)) return pieces::OkRef<Application, std::string>(*this);
+
+        m_impl->renderPending = true;
+    }
+
+    m_impl->pipelinedInput = m_impl->inputSystem->getOldestInput();
+
+    try
+    {
+        onPollInputs();
+        simulate();
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR("Application update error: {}", e.what());
+        return pieces::ErrRef<Application, std::string>(std::string("Application update error: ") +
+                                                        e.what());
+    }
+
+    return pieces::OkRef<Application, std::string>(*this);
+}
+
+void Application::limitFrameRate()
+{
+    const double limit = m_impl->getEffectiveFrameRateLimit();
+    const auto now = std::chrono::steady_clock::now();
+
+    if (limit > 0.0)
+    {
+        const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / limit));
+        const auto next = m_impl->lastFrameStart + interval;
+
+        // a frame late by more than an interval does not owe the next ones a shorter one
+        if (next > now)
+        {
+            Timer::sleepUntil(next);
+            m_impl->lastFrameStart = next;
+            return;
+        }
+    }
+
+    m_impl->lastFrameStart = now;
+}
+
+void Application::governThermals()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (!m_impl->thermalGoverned || now < m_impl->nextThermalPoll) return;
+
+    m_impl->nextThermalPoll = now + k_thermalPollInterval;
+
+    const ThermalState state = SystemPerformance::getThermalState();
+
+    const uint32_t level = m_impl->thermalGovernor.update(state, now);
+    if (level != m_impl->appliedThermalLevel) applyPerformanceLevel(level);
+}
+
+void Application::applyPerformanceLevel(uint32_t _level)
+{
+    const PerformanceLevel& performance = m_impl->thermalGovernor.getSettings().levels[_level];
+
+    MOSAIC_INFO("Application: performance level {} to {} (workers {:.0f}%, {} fps, scale {:.2f}).",
+                m_impl->appliedThermalLevel, _level, performance.workers * 100.0f,
+                performance.frameRateLimit, performance.resolutionLimit);
+
+    m_impl->appliedThermalLevel = _level;
+
+    if (auto* pool = exec::ThreadPool::getInstance())
+    {
+        const float workers = performance.workers * static_cast<float>(pool->getWorkersCount());
+        pool->setActiveWorkersCount(static_cast<uint32_t>(std::lround(workers)));
+    }
+
+    m_impl->thermalFrameRateLimit = performance.frameRateLimit;
+    m_impl->renderSystem->setResolutionLimit(performance.resolutionLimit);
+
+    // the render thread session takes the new target with the next frame it renders
+    m_impl->mainThreadHints.updateTargetDuration(m_impl->getFrameTarget());
+}
+
+void Application::simulate()
+{
+    if (m_impl->pendingSteps > 0) onFixedUpdate(std::exchange(m_impl->pendingSteps, 0));
+
+    onUpdate();
+}
+
+bool Application::consumeChanges(size_t _drainedTasks)
+{
+    const uint64_t windowEvents = m_impl->windowSystem->getEventCount();
+    const bool windowEvent = std::exchange(m_impl->windowEvents, windowEvents) != windowEvents;
+
+    const auto now = std::chrono::steady_clock::now();
+    const bool frameDue = m_impl->scheduledFrame <= now;
+    if (frameDue) m_impl->scheduledFrame = std::chrono::steady_clock::time_point::max();
+
+    // every source looked at, so that none is left for the next update
+    const bool invalidated = m_impl->invalidated.exchange(false, std::memory_order_acq_rel);
+    const bool input = m_impl->inputSystem->getOldestInput().has_value();
+
+    if (invalidated || frameDue || windowEvent || input || _drainedTasks > 0) return true;
+
+    // the time slept is not simulated after it
+    m_impl->skipFrameTime = true;
+    return false;
+}
+
+void Application::waitForRenderThread()
+{
+    if (!m_impl->renderThread) return;
+
+    try
+    {
+        m_impl->renderThread->wait();
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR("Application render error: {}", e.what());
+    }
+}
+
 void Application::pause()
 {
     if (m_impl->state == ApplicationState::resumed)
     {
+        waitForRenderThread();
+
         try
         {
             onPause();
@@ -171,6 +544,9 @@ void Application::resume()
             MOSAIC_ERROR("Application resume error: {}", e.what());
         }
 
+        m_impl->skipFrameTime = true;
+        m_impl->frameTiming.reset();
+
         m_impl->state = ApplicationState::resumed;
     }
 }
@@ -179,6 +555,16 @@ void Application::shutdown()
 {
     if (m_impl->state != ApplicationState::shutdown)
     {
+        // the last frame completes before the systems it renders with go
+        waitForRenderThread();
+        m_impl->renderThread.reset();
+        m_impl->renderThreadHints = {};
+        m_impl->renderThreadTarget = {};
+        m_impl->mainThreadHints = {};
+
+        // the main thread work still queued runs while the systems are alive
+        m_impl->mainThreadQueue.drain();
+
         try
         {
             onShutdown();
@@ -214,5 +600,127 @@ input::InputSystem* Application::getInputSystem() const { return m_impl->inputSy
 
 graphics::RenderSystem* Application::getRenderSystem() const { return m_impl->renderSystem.get(); }
 
+exec::MainThreadQueue* Application::getMainThreadQueue() const { return &m_impl->mainThreadQueue; }
+
+VirtualFileSystem* Application::getFileSystem() const { return &m_impl->fileSystem; }
+
+AssetManager* Application::getAssetManager() const { return &m_impl->assetManager; }
+
+void Application::setMainThreadBudget(std::chrono::microseconds _budget)
+{
+    m_impl->mainThreadBudget = _budget;
+}
+
+std::chrono::microseconds Application::getMainThreadBudget() const
+{
+    return m_impl->mainThreadBudget;
+}
+
+void Application::setPipelinedRendering(bool _enabled)
+{
+    if (_enabled == isPipelinedRendering()) return;
+
+    if (_enabled)
+    {
+        m_impl->renderThread = std::make_unique<exec::RenderThread>();
+        return;
+    }
+
+    waitForRenderThread();
+    m_impl->renderThread.reset();
+    m_impl->renderThreadHints = {};
+    m_impl->renderThreadTarget = {};
+}
+
+bool Application::isPipelinedRendering() const { return m_impl->renderThread != nullptr; }
+
+void Application::setFixedTimestep(bool _enabled, const FixedTimestepSettings& _settings)
+{
+    // the time accumulated at another step is not owed to the new one
+    if (_enabled) m_impl->frameTiming = FixedTimestep(_settings);
+
+    m_impl->fixedTimestep = _enabled;
+}
+
+bool Application::isFixedTimestep() const { return m_impl->fixedTimestep; }
+
+const FixedTimestep& Application::getFrameTiming() const { return m_impl->frameTiming; }
+
+void Application::setFrameRateLimit(double _framesPerSecond)
+{
+    m_impl->frameRateLimit = std::max(_framesPerSecond, 0.0);
+
+    // the render thread session takes the new target with the next frame it renders
+    m_impl->mainThreadHints.updateTargetDuration(m_impl->getFrameTarget());
+}
+
+double Application::getFrameRateLimit() const { return m_impl->frameRateLimit; }
+
+void Application::setThermalGovernor(bool _enabled)
+{
+    if (_enabled == m_impl->thermalGoverned) return;
+
+    m_impl->thermalGoverned = _enabled;
+    m_impl->nextThermalPoll = {};
+
+    // what the last level held back runs again
+    if (!_enabled)
+    {
+        waitForRenderThread();
+
+        m_impl->thermalGovernor.reset();
+        if (m_impl->appliedThermalLevel != 0) applyPerformanceLevel(0);
+    }
+}
+
+bool Application::isThermalGovernor() const { return m_impl->thermalGoverned; }
+
+const ThermalGovernor& Application::getThermalGovernor() const { return m_impl->thermalGovernor; }
+
+void Application::setReactive(bool _enabled)
+{
+    if (_enabled == m_impl->reactive) return;
+
+    m_impl->reactive = _enabled;
+
+    // what the last frame rendered may be stale
+    m_impl->renderPending = false;
+    invalidate();
+}
+
+bool Application::isReactive() const { return m_impl->reactive; }
+
+void Application::invalidate() noexcept
+{
+    m_impl->invalidated.store(true, std::memory_order_release);
+
+    if (m_impl->reactive) m_impl->windowSystem->wakeUp();
+}
+
+void Application::scheduleFrame(std::chrono::steady_clock::time_point _time)
+{
+    m_impl->scheduledFrame = std::min(m_impl->scheduledFrame, _time);
+}
+
+std::chrono::nanoseconds Application::getIdleWait() const
+{
+    if (!m_impl->reactive || m_impl->state != ApplicationState::resumed) return 0ns;
+
+    // something to render already
+    if (m_impl->renderPending || m_impl->invalidated.load(std::memory_order_acquire) ||
+        m_impl->mainThreadQueue.getPendingCount() > 0)
+    {
+        return 0ns;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (m_impl->scheduledFrame <= now) return 0ns;
+
+    // the time_point::max() of no frame scheduled does not overflow the difference
+    if (m_impl->scheduledFrame - now >= k_maxIdleWait) return k_maxIdleWait;
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(m_impl->scheduledFrame - now);
+}
+
 } // namespace core
 } // namespace mosaic
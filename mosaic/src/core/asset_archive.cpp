@@ -0,0 +1,299 @@
+#include "mosaic/core/asset_archive.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "mosaic/core/lz4.hpp"
+#include "mosaic/core/mapped_file.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+namespace
+{
+
+constexpr std::array<uint8_t, 4> k_magic = {'M', 'P', 'A', 'K'};
+
+// magic, version, entry count, alignment, TOC offset, reserved
+constexpr size_t k_headerSize = 32;
+// path hash, offset, stored size, size, compression, reserved
+constexpr size_t k_entrySize = 40;
+
+void putUint32(uint8_t* _bytes, uint32_t _value)
+{
+    for (int i = 0; i < 4; ++i) _bytes[i] = uint8_t(_value >> (8 * i));
+}
+
+void putUint64(uint8_t* _bytes, uint64_t _value)
+{
+    for (int i = 0; i < 8; ++i) _bytes[i] = uint8_t(_value >> (8 * i));
+}
+
+uint32_t getUint32(const uint8_t* _bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= uint32_t(_bytes[i]) << (8 * i);
+    return value;
+}
+
+uint64_t getUint64(const uint8_t* _bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) value |= uint64_t(_bytes[i]) << (8 * i);
+    return value;
+}
+
+void putEntry(uint8_t* _bytes, const AssetArchive::Entry& _entry)
+{
+    putUint64(_bytes, _entry.pathHash);
+    putUint64(_bytes + 8, _entry.offset);
+    putUint64(_bytes + 16, _entry.storedSize);
+    putUint64(_bytes + 24, _entry.size);
+    putUint32(_bytes + 32, uint32_t(_entry.compression));
+    putUint32(_bytes + 36, _entry.reserved);
+}
+
+AssetArchive::Entry getEntry(const uint8_t* _bytes)
+{
+    AssetArchive::Entry entry;
+    entry.pathHash = getUint64(_bytes);
+    entry.offset = getUint64(_bytes + 8);
+    entry.storedSize = getUint64(_bytes + 16);
+    entry.size = getUint64(_bytes + 24);
+    entry.compression = AssetCompression(getUint32(_bytes + 32));
+    entry.reserved = getUint32(_bytes + 36);
+    return entry;
+}
+
+FileData mapFile(const std::filesystem::path& _path)
+{
+    auto file = std::make_shared<const MappedFile>(_path);
+    return FileData(file->bytes(), file);
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetArchive
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+AssetArchive::AssetArchive(FileData _data) : m_data(std::move(_data))
+{
+    const std::span<const uint8_t> bytes = m_data.bytes();
+
+    if (bytes.size() < k_headerSize || !std::equal(k_magic.begin(), k_magic.end(), bytes.data()))
+    {
+        throw std::runtime_error("Not an asset archive");
+    }
+
+    if (getUint32(bytes.data() + 4) != k_version)
+    {
+        throw std::runtime_error("Unsupported asset archive version");
+    }
+
+    const uint64_t count = getUint32(bytes.data() + 8);
+    const uint64_t tocOffset = getUint64(bytes.data() + 16);
+
+    if (tocOffset > bytes.size() || count > (bytes.size() - tocOffset) / k_entrySize)
+    {
+        throw std::runtime_error("Truncated asset archive");
+    }
+
+    m_entries.reserve(count);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const Entry entry = getEntry(bytes.data() + tocOffset + i * k_entrySize);
+
+        if (entry.offset > bytes.size() || entry.storedSize > bytes.size() - entry.offset)
+        {
+            throw std::runtime_error("Asset archive entry out of bounds");
+        }
+
+        if (entry.compression != AssetCompression::none &&
+            entry.compression != AssetCompression::lz4)
+        {
+            throw std::runtime_error("Unsupported asset archive compression");
+        }
+
+        if (!m_entries.empty() && m_entries.back().pathHash >= entry.pathHash)
+        {
+            throw std::runtime_error("Asset archive TOC is not sorted");
+        }
+
+        m_entries.push_back(entry);
+    }
+}
+
+AssetArchive::AssetArchive(const std::filesystem::path& _path) : AssetArchive(mapFile(_path)) {}
+
+std::string AssetArchive::normalizePath(std::string_view _path)
+{
+    std::string path(_path);
+    std::replace(path.begin(), path.end(), '\\', '/');
+
+    while (path.starts_with("./")) path.erase(0, 2);
+    while (path.starts_with('/')) path.erase(0, 1);
+
+    return path;
+}
+
+// FNV-1a
+uint64_t AssetArchive::hashPath(std::string_view _path) noexcept
+{
+    std::string_view path = _path;
+    while (path.starts_with("./") || path.starts_with(".\\")) path.remove_prefix(2);
+    while (path.starts_with('/') || path.starts_with('\\')) path.remove_prefix(1);
+
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char c : path)
+    {
+        hash = (hash ^ uint8_t(c == '\\' ? '/' : c)) * 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+const AssetArchive::Entry* AssetArchive::find(std::string_view _path) const noexcept
+{
+    return findHash(hashPath(_path));
+}
+
+const AssetArchive::Entry* AssetArchive::findHash(uint64_t _pathHash) const noexcept
+{
+    auto it = std::ranges::lower_bound(m_entries, _pathHash, {}, &Entry::pathHash);
+
+    return it != m_entries.end() && it->pathHash == _pathHash ? &*it : nullptr;
+}
+
+FileData AssetArchive::read(const Entry& _entry) const
+{
+    const std::span<const uint8_t> stored =
+        m_data.bytes().subspan(_entry.offset, _entry.storedSize);
+
+    if (_entry.compression == AssetCompression::none)
+    {
+        // shares the archive, the bytes are read in place
+        return FileData(stored, m_data.getOwner());
+    }
+
+    std::vector<uint8_t> buffer(_entry.size);
+    if (!decompressLz4(stored, buffer))
+    {
+        throw std::runtime_error("Corrupt asset archive entry");
+    }
+
+    return FileData::fromBuffer(std::move(buffer));
+}
+
+std::optional<FileData> AssetArchive::read(std::string_view _path) const
+{
+    const Entry* entry = find(_path);
+    if (!entry) return std::nullopt;
+
+    return read(*entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetArchiveWriter
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+AssetArchiveWriter::AssetArchiveWriter() : m_bytes(k_headerSize, 0) {}
+
+void AssetArchiveWriter::add(std::string_view _path, std::span<const uint8_t> _bytes,
+                             AssetCompression _compression)
+{
+    const uint64_t hash = AssetArchive::hashPath(_path);
+
+    if (std::ranges::find(m_entries, hash, &AssetArchive::Entry::pathHash) != m_entries.end())
+    {
+        throw std::invalid_argument("Asset path already in the archive (or of the same hash): " +
+                                    std::string(_path));
+    }
+
+    std::vector<uint8_t> compressed;
+    if (_compression == AssetCompression::lz4) compressed = compressLz4(_bytes);
+
+    // not worth a decompression on every read
+    if (compressed.size() >= _bytes.size()) _compression = AssetCompression::none;
+
+    const std::span<const uint8_t> stored =
+        _compression == AssetCompression::none ? _bytes : std::span<const uint8_t>(compressed);
+
+    m_bytes.resize((m_bytes.size() + AssetArchive::k_alignment - 1) &
+                   ~size_t(AssetArchive::k_alignment - 1));
+
+    AssetArchive::Entry entry;
+    entry.pathHash = hash;
+    entry.offset = m_bytes.size();
+    entry.storedSize = stored.size();
+    entry.size = _bytes.size();
+    entry.compression = _compression;
+    entry.reserved = 0;
+
+    m_bytes.insert(m_bytes.end(), stored.begin(), stored.end());
+    m_entries.push_back(entry);
+}
+
+void AssetArchiveWriter::addDirectory(const std::filesystem::path& _directory,
+                                      AssetCompression _compression)
+{
+    // sorted, the same directory packs to the same archive
+    std::vector<std::filesystem::path> files;
+    for (const auto& file : std::filesystem::recursive_directory_iterator(_directory))
+    {
+        if (file.is_regular_file()) files.push_back(file.path());
+    }
+    std::ranges::sort(files);
+
+    for (const std::filesystem::path& file : files)
+    {
+        const MappedFile mapped(file);
+        add(std::filesystem::relative(file, _directory).generic_string(), mapped.bytes(),
+            _compression);
+    }
+}
+
+std::vector<uint8_t> AssetArchiveWriter::finish()
+{
+    std::ranges::sort(m_entries, {}, &AssetArchive::Entry::pathHash);
+
+    m_bytes.resize((m_bytes.size() + 7) & ~size_t(7));
+    const uint64_t tocOffset = m_bytes.size();
+
+    m_bytes.resize(tocOffset + m_entries.size() * k_entrySize);
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        putEntry(m_bytes.data() + tocOffset + i * k_entrySize, m_entries[i]);
+    }
+
+    std::copy(k_magic.begin(), k_magic.end(), m_bytes.begin());
+    putUint32(m_bytes.data() + 4, AssetArchive::k_version);
+    putUint32(m_bytes.data() + 8, uint32_t(m_entries.size()));
+    putUint32(m_bytes.data() + 12, AssetArchive::k_alignment);
+    putUint64(m_bytes.data() + 16, tocOffset);
+
+    std::vector<uint8_t> bytes = std::move(m_bytes);
+
+    m_bytes.assign(k_headerSize, 0);
+    m_entries.clear();
+
+    return bytes;
+}
+
+void AssetArchiveWriter::write(const std::filesystem::path& _path)
+{
+    const std::vector<uint8_t> bytes = finish();
+
+    std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+
+    if (!file) throw std::runtime_error("Failed to write " + _path.string());
+}
+
+} // namespace core
+} // namespace mosaic
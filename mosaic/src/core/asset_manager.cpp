@@ -0,0 +1,706 @@
+#include "mosaic/core/asset_manager.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "mosaic/core/virtual_file_system.hpp"
+#include "mosaic/exec/io_service.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+#include "mosaic/tools/logger.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace core
+{
+
+// The priority of a load none asked for: an asset visible but infinitely far, or invisible
+// right there
+static constexpr float k_defaultPriority = 1.0f;
+
+// The visible assets above the others, each the higher the nearer, in ]0, 2]
+static float priorityOf(float _distance, bool _visible) noexcept
+{
+    return (_visible ? 1.0f : 0.0f) + 1.0f / (1.0f + std::max(_distance, 0.0f));
+}
+
+// The visible assets along with the work of the frames, the others after it
+static exec::TaskPriority taskPriorityOf(float _priority) noexcept
+{
+    return _priority >= k_defaultPriority ? exec::TaskPriority::normal
+                                          : exec::TaskPriority::background;
+}
+
+AssetManager::AssetManager(VirtualFileSystem* _files, const AssetManagerSettings& _settings)
+    : m_files(_files), m_settings(_settings)
+{
+    m_settings.maxLoads = std::max(m_settings.maxLoads, 1u);
+}
+
+AssetManager::~AssetManager()
+{
+    std::unique_lock lock(m_mutex);
+    m_stopping = true;
+
+    // the stages queued on the pool are dropped, those running finish
+    for (auto& [path, entry] : m_entries) entry->cancellation.cancel();
+
+    m_running -= m_inline.size();
+    m_inline.clear();
+
+    m_idle.wait(lock, [this] { return m_running == 0; });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Requests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+AssetManager::EntryPointer AssetManager::acquire(std::string_view _path, std::type_index _type)
+{
+    std::lock_guard lock(m_mutex);
+    return acquireLocked(_path, _type, k_defaultPriority);
+}
+
+AssetManager::EntryPointer AssetManager::acquireLocked(std::string_view _path,
+                                                       std::type_index _type, float _priority)
+{
+    std::string path = AssetArchive::normalizePath(_path);
+
+    auto it = m_entries.find(path);
+    if (it == m_entries.end())
+    {
+        const auto loader = m_loaders.find(_type);
+        if (loader == m_loaders.end())
+        {
+            MOSAIC_ERROR("No asset loader registered for {} ({})", path, _type.name());
+            return nullptr;
+        }
+
+        auto entry = std::make_shared<detail::AssetEntry>(path, _type, loader->second.get());
+        it = m_entries.emplace(std::move(path), std::move(entry)).first;
+    }
+
+    const EntryPointer& entry = it->second;
+    if (entry->type != _type)
+    {
+        MOSAIC_ERROR("Asset {} is loaded as {}, not as {}", entry->path, entry->type.name(),
+                     _type.name());
+        return nullptr;
+    }
+
+    // counted before the lock is released, an update() cannot cancel it in between
+    entry->handles.fetch_add(1, std::memory_order_relaxed);
+    entry->lastUse = m_frame;
+
+    if (entry->state.load(std::memory_order_relaxed) == AssetState::unloaded)
+    {
+        queueLocked(entry, _priority);
+    }
+
+    return entry;
+}
+
+void AssetManager::prioritize(const EntryPointer& _entry, float _distance, bool _visible)
+{
+    const float priority = priorityOf(_distance, _visible);
+
+    std::lock_guard lock(m_mutex);
+    _entry->lastUse = m_frame;
+
+    // the first request of the frame replaces the priority of the frame before
+    if (_entry->priorityFrame != m_frame)
+    {
+        _entry->priority = priority;
+        _entry->priorityFrame = m_frame;
+    }
+
+    raiseLocked(*_entry, priority);
+}
+
+size_t AssetManager::update()
+{
+    MOSAIC_TRACE_SITE_SCOPE("AssetManager::update", tools::TraceCategory::io);
+
+    std::vector<EntryPointer> finalizing;
+    std::vector<std::pair<EntryPointer, Stage>> stages;
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_frame;
+
+        finalizing.swap(m_finalizing);
+        stages.swap(m_inline);
+    }
+
+    // without a pool, the stages those start run the next update
+    for (auto& [entry, stage] : stages)
+    {
+        if (entry->cancellation.token().isCancellationRequested())
+        {
+            onDropped(entry);
+            continue;
+        }
+
+        (this->*stage)(entry);
+
+        std::lock_guard lock(m_mutex);
+        finishLocked(*entry);
+    }
+
+    // the GPU uploads, on the thread that owns the contexts
+    std::vector<std::string> errors(finalizing.size());
+    for (size_t i = 0; i < finalizing.size(); ++i)
+    {
+        try
+        {
+            finalizing[i]->loader->finalizeErased(finalizing[i]->asset.get());
+        }
+        catch (const std::exception& _error)
+        {
+            errors[i] = std::string("Failed to finalize: ") + _error.what();
+        }
+    }
+
+    std::lock_guard lock(m_mutex);
+
+    for (size_t i = 0; i < finalizing.size(); ++i)
+    {
+        if (errors[i].empty())
+        {
+            completeLocked(finalizing[i]);
+        }
+        else
+        {
+            failLocked(finalizing[i], std::move(errors[i]));
+        }
+    }
+
+    uint64_t resident = 0;
+    std::vector<EntryPointer> evictable;
+
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        const EntryPointer& entry = it->second;
+        const AssetState state = entry->state.load(std::memory_order_relaxed);
+
+        if (state == AssetState::ready) resident += entry->size;
+
+        if (entry->handles.load(std::memory_order_acquire) > 0)
+        {
+            entry->lastUse = m_frame;
+            ++it;
+            continue;
+        }
+
+        switch (state)
+        {
+            case AssetState::ready:
+                evictable.push_back(entry);
+                break;
+            case AssetState::queued:
+            case AssetState::waiting:
+                unloadLocked(entry);
+                break;
+            case AssetState::reading:
+            case AssetState::decoding:
+                // the stage not started yet is dropped, a running one finds it released
+                entry->cancellation.cancel();
+                break;
+            default:
+                break;
+        }
+
+        const AssetState left = entry->state.load(std::memory_order_relaxed);
+        const bool dead = left == AssetState::unloaded || left == AssetState::failed;
+
+        it = dead && entry->stages == 0 ? m_entries.erase(it) : std::next(it);
+    }
+
+    // the least recently used first
+    if (resident > m_settings.budget)
+    {
+        std::ranges::sort(evictable, {},
+                          [](const EntryPointer& _entry) { return _entry->lastUse; });
+
+        for (const EntryPointer& entry : evictable)
+        {
+            if (resident <= m_settings.budget) break;
+
+            resident -= entry->size;
+            unloadLocked(entry);
+            ++m_evictions;
+        }
+    }
+
+    dispatchLocked();
+
+    return std::exchange(m_completed, 0);
+}
+
+void AssetManager::setOnChange(std::function<void()> _onChange)
+{
+    m_onChange = std::move(_onChange);
+}
+
+void AssetManager::setBudget(uint64_t _budget)
+{
+    std::lock_guard lock(m_mutex);
+    m_settings.budget = _budget;
+}
+
+uint64_t AssetManager::getBudget() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_settings.budget;
+}
+
+AssetManagerStats AssetManager::getStats() const
+{
+    AssetManagerStats stats;
+
+    std::lock_guard lock(m_mutex);
+
+    for (const auto& [path, entry] : m_entries)
+    {
+        switch (entry->state.load(std::memory_order_relaxed))
+        {
+            case AssetState::unloaded:
+                break;
+            case AssetState::queued:
+                ++stats.queued;
+                break;
+            case AssetState::ready:
+                ++stats.ready;
+                stats.residentSize += entry->size;
+                break;
+            case AssetState::failed:
+                ++stats.failed;
+                break;
+            default:
+                ++stats.loading;
+                break;
+        }
+    }
+
+    stats.evictions = m_evictions;
+
+    return stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scheduling
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void AssetManager::queueLocked(const EntryPointer& _entry, float _priority)
+{
+    _entry->priority = _priority;
+    _entry->priorityFrame = m_frame;
+    _entry->cancellation = exec::CancellationSource(); // the last load cancelled its own
+    _entry->state.store(AssetState::queued, std::memory_order_release);
+
+    m_queued.push_back(_entry);
+}
+
+void AssetManager::raiseLocked(detail::AssetEntry& _entry, float _priority)
+{
+    if (_entry.priority < _priority) _entry.priority = _priority;
+
+    // the graph is acyclic, see onRead()
+    for (const EntryPointer& dependency : _entry.dependencies)
+    {
+        if (dependency->state.load(std::memory_order_relaxed) != AssetState::ready)
+        {
+            raiseLocked(*dependency, _entry.priority);
+        }
+    }
+}
+
+void AssetManager::dispatchLocked()
+{
+    if (m_stopping || m_queued.empty() || m_loading >= m_settings.maxLoads) return;
+
+    // the highest priority last, taken from the back
+    std::ranges::sort(m_queued, {}, [](const EntryPointer& _entry) { return _entry->priority; });
+
+    while (m_loading < m_settings.maxLoads && !m_queued.empty())
+    {
+        EntryPointer entry = std::move(m_queued.back());
+        m_queued.pop_back();
+
+        entry->state.store(AssetState::reading, std::memory_order_release);
+        setSlotLocked(*entry, true);
+        runLocked(entry, &AssetManager::read);
+    }
+}
+
+void AssetManager::runLocked(const EntryPointer& _entry, Stage _stage)
+{
+    if (m_stopping) return;
+
+    ++m_running;
+    ++_entry->stages;
+
+    if (exec::ThreadPool* pool = exec::ThreadPool::getInstance())
+    {
+        auto ran = std::make_shared<std::atomic<bool>>(false);
+
+        auto future = pool->enqueueToGlobal(taskPriorityOf(_entry->priority),
+                                            _entry->cancellation.token(),
+                                            [this, entry = _entry, _stage, ran]
+                                            {
+                                                ran->store(true, std::memory_order_relaxed);
+                                                (this->*_stage)(entry);
+                                                notifyChange();
+
+                                                // last, the manager may be destroyed once done
+                                                std::lock_guard lock(m_mutex);
+                                                finishLocked(*entry);
+                                            });
+
+        if (future)
+        {
+            future->onReady(
+                [this, entry = _entry, ran]
+                {
+                    if (!ran->load(std::memory_order_relaxed)) onDropped(entry);
+                });
+
+            return;
+        }
+    }
+
+    m_inline.emplace_back(_entry, _stage);
+}
+
+void AssetManager::finishLocked(detail::AssetEntry& _entry)
+{
+    --_entry.stages;
+
+    if (--m_running == 0) m_idle.notify_all();
+}
+
+void AssetManager::setSlotLocked(detail::AssetEntry& _entry, bool _holds)
+{
+    if (_entry.holdsSlot == _holds) return;
+
+    _entry.holdsSlot = _holds;
+    _holds ? ++m_loading : --m_loading;
+}
+
+void AssetManager::completeLocked(const EntryPointer& _entry)
+{
+    setSlotLocked(*_entry, false);
+    _entry->bytes = {};
+    _entry->state.store(AssetState::ready, std::memory_order_release);
+
+    ++m_completed;
+    m_changed.store(true, std::memory_order_relaxed);
+
+    // the dependents of nothing else decode now
+    for (const std::weak_ptr<detail::AssetEntry>& weak : std::exchange(_entry->dependents, {}))
+    {
+        const EntryPointer dependent = weak.lock();
+        if (!dependent || dependent->state.load(std::memory_order_relaxed) != AssetState::waiting)
+        {
+            continue;
+        }
+
+        if (--dependent->pendingDependencies > 0) continue;
+
+        dependent->state.store(AssetState::decoding, std::memory_order_release);
+        setSlotLocked(*dependent, true);
+        runLocked(dependent, &AssetManager::decode);
+    }
+
+    dispatchLocked();
+}
+
+void AssetManager::failLocked(const EntryPointer& _entry, std::string _error)
+{
+    MOSAIC_WARN("Failed to load asset {}: {}", _entry->path, _error);
+
+    setSlotLocked(*_entry, false);
+    releaseDependenciesLocked(_entry);
+    _entry->bytes = {};
+    _entry->error = std::move(_error);
+    _entry->state.store(AssetState::failed, std::memory_order_release);
+
+    ++m_completed;
+    m_changed.store(true, std::memory_order_relaxed);
+
+    for (const std::weak_ptr<detail::AssetEntry>& weak : std::exchange(_entry->dependents, {}))
+    {
+        const EntryPointer dependent = weak.lock();
+        if (dependent && dependent->state.load(std::memory_order_relaxed) == AssetState::waiting)
+        {
+            failLocked(dependent, "Its dependency " + _entry->path + " failed to load");
+        }
+    }
+
+    dispatchLocked();
+}
+
+void AssetManager::unloadLocked(const EntryPointer& _entry)
+{
+    if (_entry->state.load(std::memory_order_relaxed) == AssetState::queued)
+    {
+        std::erase(m_queued, _entry);
+    }
+
+    setSlotLocked(*_entry, false);
+    releaseDependenciesLocked(_entry);
+    _entry->bytes = {};
+    _entry->asset.reset();
+    _entry->size = 0;
+    _entry->state.store(AssetState::unloaded, std::memory_order_release);
+}
+
+void AssetManager::releaseDependenciesLocked(const EntryPointer& _entry)
+{
+    for (const EntryPointer& dependency : _entry->dependencies)
+    {
+        std::erase_if(dependency->dependents,
+                      [&](const std::weak_ptr<detail::AssetEntry>& _dependent)
+                      { return _dependent.lock() == _entry; });
+
+        dependency->handles.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    _entry->dependencies.clear();
+    _entry->pendingDependencies = 0;
+}
+
+bool AssetManager::reachesLocked(const detail::AssetEntry& _from,
+                                 const detail::AssetEntry* _to) const
+{
+    if (&_from == _to) return true;
+
+    for (const EntryPointer& dependency : _from.dependencies)
+    {
+        if (reachesLocked(*dependency, _to)) return true;
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stages
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void AssetManager::read(const EntryPointer& _entry)
+{
+    MOSAIC_TRACE_SITE_SCOPE("AssetManager::read", tools::TraceCategory::io);
+
+    // a file on disk is read asynchronously, the reads of the archives are mapped
+    exec::IoService* io = exec::IoService::getInstance();
+    if (io && io->getBackend() != exec::IoBackendType::none)
+    {
+        if (const auto path = m_files->locate(_entry->path))
+        {
+            std::shared_ptr<const exec::IoFile> file;
+            try
+            {
+                file = exec::IoFile::open(*path);
+            }
+            catch (const std::exception&)
+            {
+                // read below, with the error of the file system
+            }
+
+            if (file)
+            {
+                exec::TaskPriority priority;
+                {
+                    std::lock_guard lock(m_mutex);
+                    ++m_running;
+                    ++_entry->stages;
+                    priority = taskPriorityOf(_entry->priority);
+                }
+
+                (void)io->readAsync(file, 0, file->getSize(), priority)
+                    .then(
+                        [this, entry = _entry](exec::TaskFuture<exec::IoBuffer> _read)
+                        {
+                            try
+                            {
+                                onRead(entry, FileData::fromBuffer(_read.get()), {});
+                            }
+                            catch (const std::exception& _error)
+                            {
+                                onRead(entry, std::nullopt, _error.what());
+                            }
+
+                            notifyChange();
+
+                            std::lock_guard lock(m_mutex);
+                            finishLocked(*entry);
+                        });
+
+                return;
+            }
+        }
+    }
+
+    auto bytes = m_files->read(_entry->path);
+    if (bytes.isErr())
+    {
+        onRead(_entry, std::nullopt, std::move(bytes.error()));
+        return;
+    }
+
+    onRead(_entry, std::move(bytes.unwrap()), {});
+}
+
+void AssetManager::onRead(const EntryPointer& _entry, std::optional<FileData> _bytes,
+                          std::string _error)
+{
+    std::vector<AssetDependency> dependencies;
+    if (_bytes)
+    {
+        try
+        {
+            dependencies = _entry->loader->getDependencies(*_bytes);
+        }
+        catch (const std::exception& _exception)
+        {
+            _bytes.reset();
+            _error = std::string("Failed to list the dependencies: ") + _exception.what();
+        }
+    }
+
+    std::lock_guard lock(m_mutex);
+
+    if (!_bytes)
+    {
+        failLocked(_entry, std::move(_error));
+        return;
+    }
+
+    // released meanwhile
+    if (m_stopping || _entry->handles.load(std::memory_order_acquire) == 0)
+    {
+        unloadLocked(_entry);
+        return;
+    }
+
+    _entry->bytes = std::move(*_bytes);
+
+    for (const AssetDependency& dependency : dependencies)
+    {
+        EntryPointer entry = acquireLocked(dependency.path, dependency.type, _entry->priority);
+        if (!entry)
+        {
+            failLocked(_entry, "Cannot load its dependency " + dependency.path);
+            return;
+        }
+
+        // counted by the handle acquired, released with the dependencies
+        _entry->dependencies.push_back(entry);
+
+        if (reachesLocked(*entry, _entry.get()))
+        {
+            failLocked(_entry, "Dependency cycle through " + entry->path);
+            return;
+        }
+
+        const AssetState state = entry->state.load(std::memory_order_relaxed);
+        if (state == AssetState::ready) continue;
+
+        if (state == AssetState::failed)
+        {
+            failLocked(_entry, "Its dependency " + entry->path + " failed to load");
+            return;
+        }
+
+        ++_entry->pendingDependencies;
+        entry->dependents.push_back(_entry);
+        raiseLocked(*entry, _entry->priority);
+    }
+
+    if (_entry->pendingDependencies > 0)
+    {
+        // its slot goes to the dependencies meanwhile
+        _entry->state.store(AssetState::waiting, std::memory_order_release);
+        setSlotLocked(*_entry, false);
+        dispatchLocked();
+        return;
+    }
+
+    _entry->state.store(AssetState::decoding, std::memory_order_release);
+    runLocked(_entry, &AssetManager::decode);
+}
+
+void AssetManager::decode(const EntryPointer& _entry)
+{
+    MOSAIC_TRACE_SITE_SCOPE("AssetManager::decode", tools::TraceCategory::io);
+
+    // the bytes and the dependencies do not change while it decodes
+    std::shared_ptr<void> asset;
+    uint64_t size = 0;
+    std::string error;
+
+    try
+    {
+        const AssetContext context(_entry->bytes, _entry->dependencies);
+
+        auto result = _entry->loader->decodeErased(context, size);
+        if (result.isOk())
+        {
+            asset = std::move(result.unwrap());
+        }
+        else
+        {
+            error = std::move(result.error());
+        }
+    }
+    catch (const std::exception& _exception)
+    {
+        error = std::string("Failed to decode: ") + _exception.what();
+    }
+
+    std::lock_guard lock(m_mutex);
+
+    if (!asset)
+    {
+        failLocked(_entry, std::move(error));
+        return;
+    }
+
+    _entry->asset = std::move(asset);
+    _entry->size = size;
+
+    if (_entry->loader->needsFinalize())
+    {
+        _entry->state.store(AssetState::finalizing, std::memory_order_release);
+        _entry->bytes = {};
+        setSlotLocked(*_entry, false);
+        m_finalizing.push_back(_entry);
+        dispatchLocked();
+        return;
+    }
+
+    completeLocked(_entry);
+}
+
+void AssetManager::onDropped(const EntryPointer& _entry)
+{
+    std::lock_guard lock(m_mutex);
+    finishLocked(*_entry);
+
+    if (m_stopping) return;
+
+    unloadLocked(_entry);
+
+    // wanted again since it was cancelled, or dropped by the pool shutting down
+    if (_entry->handles.load(std::memory_order_acquire) > 0) queueLocked(_entry, _entry->priority);
+
+    dispatchLocked();
+}
+
+void AssetManager::notifyChange()
+{
+    if (m_changed.exchange(false, std::memory_order_acq_rel) && m_onChange) m_onChange();
+}
+
+} // namespace core
+} // namespace mosaic
@@ -0,0 +1,61 @@
+#include "mosaic/core/fixed_timestep.hpp"
+
+#include <algorithm>
+
+namespace mosaic
+{
+namespace core
+{
+
+// Weight of a new measure of the smoothed delta, out of 8
+static constexpr int k_smoothing = 2;
+
+FixedTimestep::FixedTimestep(const FixedTimestepSettings& _settings) : m_settings(_settings)
+{
+    // a step of nothing would never consume the accumulator
+    m_settings.step = std::max(m_settings.step, std::chrono::nanoseconds(1));
+    m_settings.maxSteps = std::max(m_settings.maxSteps, 1u);
+}
+
+uint32_t FixedTimestep::advance(std::chrono::nanoseconds _frameTime) noexcept
+{
+    const std::chrono::nanoseconds maxTime = m_settings.step * m_settings.maxSteps;
+    const std::chrono::nanoseconds frameTime =
+        std::clamp(_frameTime, std::chrono::nanoseconds::zero(), maxTime);
+
+    m_smoothedDelta = m_smoothedDelta == std::chrono::nanoseconds::zero()
+                          ? frameTime
+                          : (m_smoothedDelta * (8 - k_smoothing) + frameTime * k_smoothing) / 8;
+
+    m_accumulator += std::max(_frameTime, std::chrono::nanoseconds::zero());
+
+    auto steps = static_cast<uint32_t>(
+        std::min<int64_t>(m_accumulator / m_settings.step, m_settings.maxSteps));
+    m_accumulator -= m_settings.step * steps;
+
+    // what maxSteps could not run, but the part of a step the next frame completes
+    if (m_accumulator >= m_settings.step)
+    {
+        const std::chrono::nanoseconds kept = m_accumulator % m_settings.step;
+        m_dropped += m_accumulator - kept;
+        m_accumulator = kept;
+    }
+
+    m_stepCount += steps;
+
+    return steps;
+}
+
+float FixedTimestep::getAlpha() const noexcept
+{
+    return static_cast<float>(static_cast<double>(m_accumulator.count()) /
+                              static_cast<double>(m_settings.step.count()));
+}
+
+double FixedTimestep::getStepSeconds() const noexcept
+{
+    return std::chrono::duration<double>(m_settings.step).count();
+}
+
+} // namespace core
+} // namespace mosaic
@@ -0,0 +1,226 @@
+#include "mosaic/core/isa_dispatch.hpp"
+
+#include <array>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "mosaic/core/cmd_line_parser.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MOSAIC_ISA_X86
+#if defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__arm__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+namespace mosaic
+{
+namespace core
+{
+
+static constexpr std::array<std::pair<ISALevel, const char*>, 8> k_levelNames = {{
+    {ISALevel::scalar, "scalar"},
+    {ISALevel::sse2, "sse2"},
+    {ISALevel::sse41, "sse4.1"},
+    {ISALevel::sse42, "sse4.2"},
+    {ISALevel::avx, "avx"},
+    {ISALevel::avx2, "avx2"},
+    {ISALevel::avx512f, "avx512f"},
+    {ISALevel::neon, "neon"},
+}};
+
+// 0xFF: no cap
+static std::atomic<uint8_t> s_maxLevel = 0xFF;
+
+// The width of the level, for the cap: NEON is a 128-bit level like SSE2
+static uint8_t rankOf(ISALevel _level) noexcept
+{
+    return _level == ISALevel::neon ? uint8_t(ISALevel::sse2) : uint8_t(_level);
+}
+
+const char* toString(ISALevel _level) noexcept
+{
+    for (const auto& [level, name] : k_levelNames)
+    {
+        if (level == _level) return name;
+    }
+
+    return "unknown";
+}
+
+std::optional<ISALevel> parseISALevel(std::string_view _name) noexcept
+{
+    for (const auto& [level, name] : k_levelNames)
+    {
+        if (_name == name) return level;
+    }
+
+    return std::nullopt;
+}
+
+bool isISASupported(ISALevel _level, const CPUInfo::ISASupport& _support) noexcept
+{
+    switch (_level)
+    {
+        case ISALevel::scalar:
+            return true;
+        case ISALevel::sse2:
+            return _support.sse2;
+        case ISALevel::sse41:
+            return _support.sse41;
+        case ISALevel::sse42:
+            return _support.sse42;
+        case ISALevel::avx:
+            return _support.avx;
+        case ISALevel::avx2:
+            return _support.avx2;
+        case ISALevel::avx512f:
+            return _support.avx512;
+        case ISALevel::neon:
+            return _support.neon;
+    }
+
+    return false;
+}
+
+#if defined(MOSAIC_ISA_X86)
+
+static bool cpuid(uint32_t _leaf, uint32_t _subleaf, uint32_t (&_registers)[4]) noexcept
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (uint32_t(info[0]) < _leaf) return false;
+
+    __cpuidex(info, int(_leaf), int(_subleaf));
+    for (int i = 0; i < 4; ++i) _registers[i] = uint32_t(info[i]);
+    return true;
+#else
+    return __get_cpuid_count(_leaf, _subleaf, &_registers[0], &_registers[1], &_registers[2],
+                             &_registers[3]) != 0;
+#endif
+}
+
+// The register state the OS saves on a context switch
+static uint64_t readXcr0() noexcept
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t low = 0;
+    uint32_t high = 0;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (uint64_t(high) << 32) | low;
+#endif
+}
+
+#endif
+
+CPUInfo::ISASupport detectISASupport() noexcept
+{
+    CPUInfo::ISASupport support;
+
+#if defined(MOSAIC_ISA_X86)
+    uint32_t r[4] = {}; // eax, ebx, ecx, edx
+    if (!cpuid(1, 0, r)) return support;
+
+    const auto bit = [](uint32_t _register, int _bit) { return ((_register >> _bit) & 1u) != 0; };
+
+    support.sse = bit(r[3], 25);
+    support.sse2 = bit(r[3], 26);
+    support.sse3 = bit(r[2], 0);
+    support.ssse3 = bit(r[2], 9);
+    support.sse41 = bit(r[2], 19);
+    support.sse42 = bit(r[2], 20);
+
+    // The CPU having the registers is not enough, the OS must save them (OSXSAVE, then XCR0)
+    const bool osxsave = bit(r[2], 27);
+    const bool avxCpu = bit(r[2], 28);
+    const uint64_t xcr0 = osxsave ? readXcr0() : 0;
+    const bool ymmState = (xcr0 & 0x6) == 0x6;   // SSE, AVX
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6; // and opmask, ZMM0-15 upper, ZMM16-31
+    const bool apxState = (xcr0 & (1ull << 19)) != 0;
+
+    support.avx = avxCpu && ymmState;
+
+    uint32_t leaf7[4] = {};
+    if (cpuid(7, 0, leaf7))
+    {
+        support.avx2 = support.avx && bit(leaf7[1], 5);
+        support.avx512 = zmmState && bit(leaf7[1], 16);
+        support.fp16 = zmmState && bit(leaf7[3], 23);
+
+        uint32_t leaf7_1[4] = {};
+        if (leaf7[0] >= 1 && cpuid(7, 1, leaf7_1))
+        {
+            support.avx10 = zmmState && bit(leaf7_1[3], 19);
+            support.apx = apxState && bit(leaf7_1[3], 21);
+        }
+
+        // The AVX10 version, in leaf 0x24
+        uint32_t leaf24[4] = {};
+        if (support.avx10 && cpuid(0x24, 0, leaf24)) support.avx10_2 = (leaf24[1] & 0xFF) >= 2;
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    support.neon = true; // mandatory in ARMv8-A
+#elif defined(__arm__) && defined(__linux__)
+    support.neon = (getauxval(AT_HWCAP) & (1ul << 12)) != 0; // HWCAP_NEON
+#elif defined(__wasm_simd128__)
+    support.wasmSimd128 = true; // the browser validated the module with it
+#endif
+
+    return support;
+}
+
+const CPUInfo::ISASupport& getHostISASupport() noexcept
+{
+    static const CPUInfo::ISASupport support = detectISASupport();
+    return support;
+}
+
+void setMaxISALevel(std::optional<ISALevel> _level) noexcept
+{
+    s_maxLevel.store(_level ? uint8_t(*_level) : uint8_t(0xFF), std::memory_order_relaxed);
+}
+
+std::optional<ISALevel> getMaxISALevel() noexcept
+{
+    const uint8_t level = s_maxLevel.load(std::memory_order_relaxed);
+    if (level == 0xFF) return std::nullopt;
+
+    return ISALevel(level);
+}
+
+bool isISAAllowed(ISALevel _level) noexcept
+{
+    const std::optional<ISALevel> max = getMaxISALevel();
+    if (max && rankOf(_level) > rankOf(*max)) return false;
+
+    return isISASupported(_level, getHostISASupport());
+}
+
+std::optional<std::string> registerISAOptions(CommandLineParser& _parser)
+{
+    return _parser.registerTypedOption<std::string>(
+        "max-isa", "", "Widest instruction set",
+        "The widest SIMD kernels run, to test the paths of older CPUs: scalar, sse2, sse4.1, "
+        "sse4.2, avx, avx2 or avx512f",
+        CmdOptionValueTypes::single,
+        [](const std::vector<std::string>& _values) -> bool
+        {
+            const std::optional<ISALevel> level = parseISALevel(_values.front());
+            if (!level) return false;
+
+            setMaxISALevel(level);
+            return true;
+        });
+}
+
+} // namespace core
+} // namespace mosaic
@@ -0,0 +1,232 @@
+#include "mosaic/tools/logger_file_sink.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <fmt/format.h>
+
+#include "mosaic/core/sys_console.hpp"
+
+namespace mosaic
+{
+namespace tools
+{
+
+struct FileSink::State
+{
+    Config config;
+
+    std::mutex mutex;
+    std::ofstream file;
+    std::string buffer;
+    uint64_t fileSize = 0; // written out
+    std::chrono::steady_clock::time_point lastWrite;
+    bool failed = false; // reported once
+
+    explicit State(Config _config) : config(std::move(_config))
+    {
+        buffer.reserve(config.bufferSize);
+    }
+
+    // <name>.log, then <name>.<index>.log for the rotated ones
+    std::filesystem::path path(uint32_t _index) const
+    {
+        const std::string file = _index == 0 ? fmt::format("{}.log", config.name)
+                                             : fmt::format("{}.{}.log", config.name, _index);
+
+        return std::filesystem::path(k_logsBasePath) / file;
+    }
+
+    bool open()
+    {
+        file.open(path(0), std::ios::binary | std::ios::app);
+        if (!file.is_open()) return false;
+
+        std::error_code error;
+        const auto size = std::filesystem::file_size(path(0), error);
+        fileSize = error ? 0 : size;
+
+        return true;
+    }
+
+    void rotate()
+    {
+        file.close();
+
+        std::error_code error;
+
+        if (config.maxFiles == 0)
+        {
+            std::filesystem::remove(path(0), error);
+        }
+        else
+        {
+            std::filesystem::remove(path(config.maxFiles), error);
+
+            for (uint32_t index = config.maxFiles; index > 0; --index)
+            {
+                // the missing ones are skipped
+                std::filesystem::rename(path(index - 1), path(index), error);
+            }
+        }
+
+        open();
+    }
+
+    void append(std::string_view _message)
+    {
+        buffer.append(_message);
+        buffer.push_back('\n');
+    }
+
+    void writeOut()
+    {
+        lastWrite = std::chrono::steady_clock::now();
+
+        if (buffer.empty()) return;
+
+        if (fileSize > 0 && fileSize + buffer.size() > config.maxFileSize) rotate();
+
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.flush();
+
+        if (!file.good() && !failed)
+        {
+            failed = true;
+            core::SystemConsole::printError(
+                fmt::format("FileSink: could not write to {}\n", path(0).string()));
+        }
+
+        fileSize += buffer.size();
+        buffer.clear();
+    }
+
+    void writeIfDue(bool _critical)
+    {
+        const auto interval = std::chrono::milliseconds(config.flushIntervalMs);
+
+        if (_critical || buffer.size() >= config.bufferSize ||
+            std::chrono::steady_clock::now() - lastWrite >= interval)
+        {
+            writeOut();
+        }
+    }
+
+    void write(LogLevel _level, std::string_view _message)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        append(_message);
+        writeIfDue(_level == LogLevel::critical);
+    }
+};
+
+FileSink::FileSink(Config _config) : m_state(std::make_unique<State>(std::move(_config))) {}
+
+FileSink::~FileSink()
+{
+    if (m_state && m_state->file.is_open()) shutdown();
+}
+
+FileSink::FileSink(FileSink&&) noexcept = default;
+FileSink& FileSink::operator=(FileSink&&) noexcept = default;
+
+pieces::RefResult<Sink, std::string> FileSink::initialize()
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+
+    std::error_code error;
+    std::filesystem::create_directories(k_logsBasePath, error);
+
+    if (error)
+    {
+        return pieces::ErrRef<Sink, std::string>(
+            fmt::format("could not create {}: {}", k_logsBasePath, error.message()));
+    }
+
+    if (!m_state->open())
+    {
+        return pieces::ErrRef<Sink, std::string>(
+            fmt::format("could not open {}", m_state->path(0).string()));
+    }
+
+    // the file of the previous session is kept
+    if (m_state->fileSize > 0) m_state->rotate();
+
+    m_state->lastWrite = std::chrono::steady_clock::now();
+
+    return pieces::OkRef<Sink, std::string>(*this);
+}
+
+void FileSink::shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+
+    m_state->writeOut();
+    m_state->file.close();
+}
+
+void FileSink::trace(const std::string& _message) const
+{
+    m_state->write(LogLevel::trace, _message);
+}
+
+void FileSink::debug(const std::string& _message) const
+{
+    m_state->write(LogLevel::debug, _message);
+}
+
+void FileSink::info(const std::string& _message) const
+{
+    m_state->write(LogLevel::info, _message);
+}
+
+void FileSink::warn(const std::string& _message) const
+{
+    m_state->write(LogLevel::warn, _message);
+}
+
+void FileSink::error(const std::string& _message) const
+{
+    m_state->write(LogLevel::error, _message);
+}
+
+void FileSink::critical(const std::string& _message) const
+{
+    m_state->write(LogLevel::critical, _message);
+}
+
+void FileSink::writeBatch(std::span<const LogEntry> _entries) const
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+
+    bool critical = false;
+
+    for (const auto& entry : _entries)
+    {
+        m_state->append(entry.message);
+        critical |= entry.level == LogLevel::critical;
+    }
+
+    m_state->writeIfDue(critical);
+}
+
+void FileSink::flush() const
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+
+    m_state->writeOut();
+}
+
+std::string FileSink::getPath() const
+{
+    return m_state->path(0).string();
+}
+
+} // namespace tools
+} // namespace mosaic
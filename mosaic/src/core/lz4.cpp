@@ -0,0 +1,185 @@
+#include "mosaic/core/lz4.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace mosaic
+{
+namespace core
+{
+
+// The format: a match is 4 bytes at least, 64 KiB back at most, the last 5 bytes are literals and
+// the last match starts 12 bytes before the end at the latest
+static constexpr size_t k_minMatch = 4;
+static constexpr size_t k_maxOffset = 65535;
+static constexpr size_t k_lastLiterals = 5;
+static constexpr size_t k_matchLimit = 12;
+
+static constexpr uint32_t k_hashBits = 12;
+
+static uint32_t read32(const uint8_t* _data) noexcept
+{
+    uint32_t value;
+    std::memcpy(&value, _data, sizeof(value));
+    return value;
+}
+
+static uint32_t hashSequence(uint32_t _sequence) noexcept
+{
+    return (_sequence * 2654435761u) >> (32 - k_hashBits);
+}
+
+// 15 in the token, then bytes of 255 until the rest
+static void writeLength(std::vector<uint8_t>& _output, size_t _length)
+{
+    for (; _length >= 255; _length -= 255) _output.push_back(255);
+    _output.push_back(static_cast<uint8_t>(_length));
+}
+
+static void writeSequence(std::vector<uint8_t>& _output, const uint8_t* _literals,
+                          size_t _literalCount, size_t _offset, size_t _matchLength)
+{
+    const size_t matchCode = _matchLength - k_minMatch;
+    const uint8_t token = static_cast<uint8_t>((std::min<size_t>(_literalCount, 15) << 4) |
+                                               std::min<size_t>(matchCode, 15));
+    _output.push_back(token);
+
+    if (_literalCount >= 15) writeLength(_output, _literalCount - 15);
+    _output.insert(_output.end(), _literals, _literals + _literalCount);
+
+    _output.push_back(static_cast<uint8_t>(_offset));
+    _output.push_back(static_cast<uint8_t>(_offset >> 8));
+
+    if (matchCode >= 15) writeLength(_output, matchCode - 15);
+}
+
+static void writeLastLiterals(std::vector<uint8_t>& _output, const uint8_t* _literals,
+                              size_t _literalCount)
+{
+    _output.push_back(static_cast<uint8_t>(std::min<size_t>(_literalCount, 15) << 4));
+
+    if (_literalCount >= 15) writeLength(_output, _literalCount - 15);
+    _output.insert(_output.end(), _literals, _literals + _literalCount);
+}
+
+std::vector<uint8_t> compressLz4(std::span<const uint8_t> _input)
+{
+    const uint8_t* input = _input.data();
+    const size_t size = _input.size();
+
+    std::vector<uint8_t> output;
+    output.reserve(size + size / 255 + 16);
+
+    // the positions + 1 of the last sequences of each hash, 0 for none
+    std::array<uint32_t, size_t{1} << k_hashBits> table = {};
+
+    size_t anchor = 0;
+    size_t position = 0;
+
+    while (size > k_matchLimit && position < size - k_matchLimit)
+    {
+        const uint32_t sequence = read32(input + position);
+        uint32_t& slot = table[hashSequence(sequence)];
+        const size_t candidate = slot;
+        slot = static_cast<uint32_t>(position + 1);
+
+        if (candidate == 0 || position - (candidate - 1) > k_maxOffset ||
+            read32(input + candidate - 1) != sequence)
+        {
+            ++position;
+            continue;
+        }
+
+        const size_t match = candidate - 1;
+        size_t length = k_minMatch;
+        while (position + length < size - k_lastLiterals &&
+               input[match + length] == input[position + length])
+        {
+            ++length;
+        }
+
+        writeSequence(output, input + anchor, position - anchor, position - match, length);
+
+        position += length;
+        anchor = position;
+    }
+
+    writeLastLiterals(output, input + anchor, size - anchor);
+
+    return output;
+}
+
+// Adds the bytes of 255 (and the one ending them) to _length, false past the end of the input
+static bool readLength(const uint8_t*& _in, const uint8_t* _end, size_t& _length) noexcept
+{
+    uint8_t byte;
+    do
+    {
+        if (_in == _end) return false;
+
+        byte = *_in++;
+        _length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+bool decompressLz4(std::span<const uint8_t> _input, std::span<uint8_t> _output) noexcept
+{
+    const uint8_t* in = _input.data();
+    const uint8_t* const inEnd = in + _input.size();
+    uint8_t* out = _output.data();
+    uint8_t* const outBegin = out;
+    uint8_t* const outEnd = out + _output.size();
+
+    while (in < inEnd)
+    {
+        const uint8_t token = *in++;
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(in, inEnd, literalCount)) return false;
+
+        if (literalCount > static_cast<size_t>(inEnd - in) ||
+            literalCount > static_cast<size_t>(outEnd - out))
+        {
+            return false;
+        }
+
+        std::memcpy(out, in, literalCount);
+        in += literalCount;
+        out += literalCount;
+
+        // the last sequence has no match
+        if (in == inEnd) break;
+
+        if (inEnd - in < 2) return false;
+
+        const size_t offset = size_t{in[0]} | (size_t{in[1]} << 8);
+        in += 2;
+
+        if (offset == 0 || offset > static_cast<size_t>(out - outBegin)) return false;
+
+        size_t length = (token & 15) + k_minMatch;
+        if ((token & 15) == 15 && !readLength(in, inEnd, length)) return false;
+
+        if (length > static_cast<size_t>(outEnd - out)) return false;
+
+        // overlapping when the offset is shorter than the match: a run, copied byte by byte
+        const uint8_t* match = out - offset;
+        if (offset >= length)
+        {
+            std::memcpy(out, match, length);
+            out += length;
+        }
+        else
+        {
+            for (size_t i = 0; i < length; ++i) *out++ = match[i];
+        }
+    }
+
+    return out == outEnd;
+}
+
+} // namespace core
+} // namespace mosaic
@@ -1,9 +1,18 @@
 #include "mosaic/core/sys_info.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <vector>
 
 #include "mosaic/defines.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+#include "mosaic/tools/logger.hpp"
 
 #if defined(MOSAIC_PLATFORM_WINDOWS)
 #include "platform/Win32/win32_sys_info.hpp"
@@ -34,17 +43,169 @@ std::unique_ptr<SystemInfo::SystemInfoImpl> SystemInfo::impl =
     std::make_unique<platform::agdk::AGDKSystemInfo>();
 #endif
 
-OSInfo SystemInfo::getOSInfo() { return impl->getOSInfo(); }
+// The platform queries are not reentrant (the WMI helper of Win32 is created by the first one)
+static std::mutex s_queryMutex;
 
-CPUInfo SystemInfo::getCPUInfo() { return impl->getCPUInfo(); }
+// Queried once, guarded by s_queryMutex
+static std::optional<OSInfo> s_osInfo;
+static std::optional<CPUInfo> s_cpuInfo;
+static std::optional<LocaleInfo> s_localeInfo;
 
-MemoryMetrics SystemInfo::getMemoryMetrics() { return impl->getMemoryMetrics(); }
+// Of the last refresh, guarded by s_metricsMutex and not s_queryMutex: the getters do not wait
+// for the refresh in flight
+static std::mutex s_metricsMutex;
+static MemoryMetrics s_memoryMetrics;
+static std::vector<StorageDeviceInfo> s_storageDevices;
+static std::vector<MonitorInfo> s_monitors;
 
-std::vector<StorageDeviceInfo> SystemInfo::getStorageDevices() { return impl->getStorageDevices(); }
+static std::atomic<bool> s_refreshing = false;
+static std::atomic<uint64_t> s_refreshCount = 0;
 
-LocaleInfo SystemInfo::getLocaleInfo() { return impl->getLocaleInfo(); }
+OSInfo SystemInfo::getOSInfo()
+{
+    std::lock_guard lock(s_queryMutex);
+
+    if (!s_osInfo) s_osInfo = impl->getOSInfo();
+
+    return *s_osInfo;
+}
+
+// Derives the core counts from the topology, when the platform reported one.
+static void summarizeTopology(CPUInfo& _info)
+{
+    if (_info.processors.empty()) return;
+
+    std::map<uint32_t, uint8_t> classOfCore;
+    std::set<uint32_t> nodes;
+
+    for (const LogicalProcessorInfo& processor : _info.processors)
+    {
+        classOfCore[processor.coreId] = processor.efficiencyClass;
+        nodes.insert(processor.numaNode);
+    }
+
+    uint8_t highestClass = 0;
+    for (const auto& [core, efficiencyClass] : classOfCore)
+    {
+        highestClass = std::max(highestClass, efficiencyClass);
+    }
+
+    _info.logicalCores = static_cast<uint32_t>(_info.processors.size());
+    _info.physicalCores = static_cast<uint32_t>(classOfCore.size());
+    _info.performanceCores = static_cast<uint32_t>(std::ranges::count_if(
+        classOfCore, [&](const auto& _core) { return _core.second == highestClass; }));
+    _info.efficiencyCores = _info.physicalCores - _info.performanceCores;
+    _info.numaNodes = static_cast<uint32_t>(nodes.size());
+}
+
+CPUInfo SystemInfo::getCPUInfo()
+{
+    std::lock_guard lock(s_queryMutex);
+
+    if (!s_cpuInfo)
+    {
+        s_cpuInfo = impl->getCPUInfo();
+        summarizeTopology(*s_cpuInfo);
+    }
+
+    return *s_cpuInfo;
+}
+
+MemoryMetrics SystemInfo::getMemoryMetrics()
+{
+    std::lock_guard lock(s_queryMutex);
+
+    MemoryMetrics metrics = impl->getMemoryMetrics();
+    impl->queryProcessMemory(metrics);
+
+    return metrics;
+}
+
+std::vector<StorageDeviceInfo> SystemInfo::getStorageDevices()
+{
+    std::lock_guard lock(s_queryMutex);
+    return impl->getStorageDevices();
+}
+
+LocaleInfo SystemInfo::getLocaleInfo()
+{
+    std::lock_guard lock(s_queryMutex);
 
-std::vector<MonitorInfo> SystemInfo::getMonitors() { return impl->getMonitors(); }
+    if (!s_localeInfo) s_localeInfo = impl->getLocaleInfo();
+
+    return *s_localeInfo;
+}
+
+std::vector<MonitorInfo> SystemInfo::getMonitors()
+{
+    std::lock_guard lock(s_queryMutex);
+    return impl->getMonitors();
+}
+
+void SystemInfo::refreshMetricsAsync()
+{
+    if (s_refreshing.exchange(true, std::memory_order_acq_rel)) return;
+
+    auto refresh = []
+    {
+        try
+        {
+            MemoryMetrics memory = getMemoryMetrics();
+            std::vector<StorageDeviceInfo> storage = getStorageDevices();
+            std::vector<MonitorInfo> monitors = getMonitors();
+
+            std::lock_guard lock(s_metricsMutex);
+            s_memoryMetrics = memory;
+            s_storageDevices = std::move(storage);
+            s_monitors = std::move(monitors);
+        }
+        catch (const std::exception& _error)
+        {
+            MOSAIC_WARN("Failed to refresh the system metrics: {}", _error.what());
+        }
+
+        s_refreshCount.fetch_add(1, std::memory_order_release);
+        s_refreshing.store(false, std::memory_order_release);
+    };
+
+    if (exec::ThreadPool* pool = exec::ThreadPool::getInstance())
+    {
+        // the queries mostly wait on the system, the work of the frames goes first
+        if (pool->enqueueToGlobal(exec::TaskPriority::background, refresh)) return;
+    }
+
+    refresh();
+}
+
+MemoryMetrics SystemInfo::getMemoryMetricsFast()
+{
+    MemoryMetrics metrics;
+    {
+        std::lock_guard lock(s_metricsMutex);
+        metrics = s_memoryMetrics;
+    }
+
+    impl->queryProcessMemory(metrics);
+
+    return metrics;
+}
+
+std::vector<StorageDeviceInfo> SystemInfo::getLastStorageDevices()
+{
+    std::lock_guard lock(s_metricsMutex);
+    return s_storageDevices;
+}
+
+std::vector<MonitorInfo> SystemInfo::getLastMonitors()
+{
+    std::lock_guard lock(s_metricsMutex);
+    return s_monitors;
+}
+
+uint64_t SystemInfo::getRefreshCount() noexcept
+{
+    return s_refreshCount.load(std::memory_order_acquire);
+}
 
 } // namespace core
 } // namespace mosaic
@@ -0,0 +1,95 @@
+#include "mosaic/core/sys_performance.hpp"
+
+#include <utility>
+
+#include "mosaic/defines.hpp"
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+#include <windows.h>
+#elif defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+#include "platform/AGDK/agdk_sys_performance.hpp"
+#endif
+
+namespace mosaic
+{
+namespace core
+{
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+std::unique_ptr<SystemPerformance::SystemPerformanceImpl> SystemPerformance::impl =
+    std::make_unique<platform::agdk::AGDKSystemPerformance>();
+#else
+std::unique_ptr<SystemPerformance::SystemPerformanceImpl> SystemPerformance::impl =
+    std::make_unique<SystemPerformance::SystemPerformanceImpl>();
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// PerformanceHintSession
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PerformanceHintSession::~PerformanceHintSession()
+{
+    if (m_session) SystemPerformance::impl->closeHintSession(m_session);
+}
+
+PerformanceHintSession::PerformanceHintSession(PerformanceHintSession&& _other) noexcept
+    : m_session(std::exchange(_other.m_session, nullptr))
+{
+}
+
+PerformanceHintSession& PerformanceHintSession::operator=(PerformanceHintSession&& _other) noexcept
+{
+    if (this == &_other) return *this;
+
+    if (m_session) SystemPerformance::impl->closeHintSession(m_session);
+    m_session = std::exchange(_other.m_session, nullptr);
+
+    return *this;
+}
+
+void PerformanceHintSession::updateTargetDuration(std::chrono::nanoseconds _target) noexcept
+{
+    if (m_session) SystemPerformance::impl->updateTargetDuration(m_session, _target);
+}
+
+void PerformanceHintSession::reportActualDuration(std::chrono::nanoseconds _actual) noexcept
+{
+    // the platform rejects empty durations
+    if (m_session && _actual.count() > 0)
+    {
+        SystemPerformance::impl->reportActualDuration(m_session, _actual);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SystemPerformance
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThermalState SystemPerformance::getThermalState() { return impl->getThermalState(); }
+
+PerformanceHintSession SystemPerformance::createHintSession(std::span<const int32_t> _threadIds,
+                                                            std::chrono::nanoseconds _target)
+{
+    if (_threadIds.empty() || _target.count() <= 0) return {};
+
+    return PerformanceHintSession(impl->createHintSession(_threadIds, _target));
+}
+
+int32_t SystemPerformance::getCurrentThreadId() noexcept
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    return static_cast<int32_t>(::GetCurrentThreadId());
+#elif defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+    return static_cast<int32_t>(::syscall(SYS_gettid));
+#else
+    return 0;
+#endif
+}
+
+} // namespace core
+} // namespace mosaic
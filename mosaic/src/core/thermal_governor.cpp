@@ -0,0 +1,74 @@
+#include "mosaic/core/thermal_governor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mosaic
+{
+namespace core
+{
+
+ThermalGovernor::ThermalGovernor(const ThermalGovernorSettings& _settings) : m_settings(_settings)
+{
+    for (PerformanceLevel& level : m_settings.levels)
+    {
+        level.workers = std::clamp(level.workers, 0.0f, 1.0f);
+        level.frameRateLimit = std::max(level.frameRateLimit, 0.0);
+        level.resolutionLimit = std::clamp(level.resolutionLimit, 0.01f, 1.0f);
+    }
+}
+
+uint32_t ThermalGovernor::update(const ThermalState& _state, Clock::time_point _now) noexcept
+{
+    m_state = _state;
+
+    const uint32_t target = getLevelOf(_state);
+
+    if (target >= m_level)
+    {
+        m_level = target;
+        m_coolerSince = _now;
+    }
+    else if (_now - m_coolerSince >= m_settings.recoveryDelay)
+    {
+        --m_level;
+        m_coolerSince = _now;
+    }
+
+    return m_level;
+}
+
+uint32_t ThermalGovernor::getLevelOf(const ThermalState& _state) const noexcept
+{
+    uint32_t level = 0;
+
+    switch (_state.status)
+    {
+        case ThermalStatus::unknown:
+        case ThermalStatus::none:
+        case ThermalStatus::light: level = 0; break;
+        case ThermalStatus::moderate: level = 1; break;
+        case ThermalStatus::severe: level = 2; break;
+        case ThermalStatus::critical:
+        case ThermalStatus::emergency:
+        case ThermalStatus::shutdown: level = 3; break;
+    }
+
+    // NaN compares false: no forecast, the status alone
+    uint32_t forecast = 0;
+    for (float threshold : m_settings.headroomThresholds)
+    {
+        if (_state.headroom >= threshold) ++forecast;
+    }
+
+    return std::max(level, forecast);
+}
+
+void ThermalGovernor::reset() noexcept
+{
+    m_level = 0;
+    m_state = {};
+}
+
+} // namespace core
+} // namespace mosaic
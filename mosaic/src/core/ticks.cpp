@@ -0,0 +1,191 @@
+#include "mosaic/core/ticks.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86)
+#if defined(MOSAIC_COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace mosaic
+{
+namespace core
+{
+
+constinit std::atomic<Ticks::Source> Ticks::s_source{Ticks::Source::unknown};
+
+// How long the counter is measured against the steady clock when its frequency is not reported
+static constexpr std::chrono::milliseconds k_calibrationPeriod{5};
+
+// The epochs of the three clocks at one instant, and the rate of the ticks
+struct Calibration
+{
+    int64_t ticks;
+    int64_t steady; // ns
+    int64_t system; // ns
+    double nanosecondsPerTick;
+};
+
+static int64_t steadyNanoseconds() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static int64_t systemNanoseconds() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86)
+
+static bool cpuid(uint32_t _leaf, uint32_t (&_registers)[4]) noexcept
+{
+#if defined(MOSAIC_COMPILER_MSVC)
+    int info[4];
+    __cpuid(info, int(_leaf & 0x80000000u));
+    if (uint32_t(info[0]) < _leaf) return false;
+
+    __cpuid(info, int(_leaf));
+    for (int i = 0; i < 4; ++i) _registers[i] = uint32_t(info[i]);
+    return true;
+#else
+    return __get_cpuid(_leaf, &_registers[0], &_registers[1], &_registers[2], &_registers[3]) !=
+           0;
+#endif
+}
+
+#endif
+
+// The frequency of the counter where the CPU reports it, 0 otherwise
+[[maybe_unused]] static uint64_t reportedFrequency() noexcept
+{
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86)
+    // TSC / crystal ratio and crystal frequency (Intel since Skylake)
+    uint32_t leaf15[4];
+    if (cpuid(0x15, leaf15) && leaf15[0] != 0 && leaf15[1] != 0 && leaf15[2] != 0)
+    {
+        return uint64_t(leaf15[2]) * leaf15[1] / leaf15[0];
+    }
+
+    return 0;
+#elif defined(MOSAIC_ARCH_ARM64) && !defined(MOSAIC_COMPILER_MSVC)
+    uint64_t frequency;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frequency));
+    return frequency;
+#else
+    return 0;
+#endif
+}
+
+Ticks::Source Ticks::detectSource() noexcept
+{
+    Source source = Source::steady;
+
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86)
+    // invariant TSC: constant rate, across cores and power states (hypervisors often hide it)
+    uint32_t leaf[4];
+    if (cpuid(0x80000007, leaf) && (leaf[3] & (1u << 8)) != 0) source = Source::counter;
+#elif defined(MOSAIC_TICKS_COUNTER)
+    // the generic timer of ARMv8 runs at a fixed frequency
+    source = Source::counter;
+#endif
+
+    // every thread finds the same answer
+    s_source.store(source, std::memory_order_relaxed);
+
+    return source;
+}
+
+static Calibration calibrate() noexcept
+{
+    if (!Ticks::isHardwareCounter())
+    {
+        const int64_t steady = steadyNanoseconds();
+        return {steady, steady, systemNanoseconds(), 1.0};
+    }
+
+    double nanosecondsPerTick;
+
+    if (const uint64_t frequency = reportedFrequency(); frequency != 0)
+    {
+        nanosecondsPerTick = 1e9 / static_cast<double>(frequency);
+    }
+    else
+    {
+        const int64_t startTicks = Ticks::now();
+        const int64_t start = steadyNanoseconds();
+
+        int64_t end;
+        do
+        {
+            end = steadyNanoseconds();
+        } while (end - start <
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(k_calibrationPeriod).count());
+
+        const int64_t endTicks = Ticks::now();
+
+        nanosecondsPerTick = endTicks > startTicks ? static_cast<double>(end - start) /
+                                                         static_cast<double>(endTicks - startTicks)
+                                                   : 1.0;
+    }
+
+    // the tick read between the two clocks, about halfway
+    const int64_t steady = steadyNanoseconds();
+    const int64_t ticks = Ticks::now();
+    const int64_t system = systemNanoseconds();
+
+    return {ticks, steady, system, nanosecondsPerTick};
+}
+
+static const Calibration& calibration() noexcept
+{
+    static const Calibration s_calibration = calibrate();
+    return s_calibration;
+}
+
+bool Ticks::isHardwareCounter() noexcept
+{
+    Source source = s_source.load(std::memory_order_relaxed);
+    if (source == Source::unknown) source = detectSource();
+
+    return source == Source::counter;
+}
+
+double Ticks::getNanosecondsPerTick() noexcept { return calibration().nanosecondsPerTick; }
+
+int64_t Ticks::toNanoseconds(int64_t _ticks) noexcept
+{
+    return static_cast<int64_t>(static_cast<double>(_ticks) * calibration().nanosecondsPerTick);
+}
+
+int64_t Ticks::fromNanoseconds(int64_t _nanoseconds) noexcept
+{
+    return static_cast<int64_t>(static_cast<double>(_nanoseconds) /
+                                calibration().nanosecondsPerTick);
+}
+
+int64_t Ticks::toSteadyNanoseconds(int64_t _ticks) noexcept
+{
+    const Calibration& base = calibration();
+    return base.steady + toNanoseconds(_ticks - base.ticks);
+}
+
+std::chrono::system_clock::time_point Ticks::toSystem(int64_t _ticks) noexcept
+{
+    const Calibration& base = calibration();
+
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(base.system + toNanoseconds(_ticks - base.ticks))));
+}
+
+} // namespace core
+} // namespace mosaic
@@ -1,41 +1,207 @@
 #include "mosaic/core/timer.hpp"
 
 #include <algorithm>
-#include <atomic>
+#include <array>
 #include <chrono>
 #include <ctime>
-#include <functional>
+#include <exception>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+#include <windows.h>
+#elif defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+#include <cerrno>
+#include <time.h>
+#endif
+
+#if defined(MOSAIC_COMPILER_MSVC) && (defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86))
+#include <intrin.h>
+#endif
+
+#include "mosaic/core/ticks.hpp"
+#include "mosaic/exec/main_thread_queue.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+#include "mosaic/tools/logger.hpp"
+
 namespace mosaic
 {
 namespace core
 {
 
+// The end of a precise sleep is spun rather than left to the scheduler, which wakes late by up to
+// its timer slack (50 us on Linux, more under load) and the high resolution timers of Windows too
+static constexpr std::chrono::microseconds k_spinMargin{500};
+
+// Hints the core that the thread is spinning (lets the sibling hyperthread run, saves power).
+static inline void cpuRelax() noexcept
+{
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86)
+#if defined(MOSAIC_COMPILER_MSVC)
+    _mm_pause();
+#else
+    __builtin_ia32_pause();
+#endif
+#elif defined(MOSAIC_ARCH_ARM64) || defined(MOSAIC_ARCH_ARM32)
+#if defined(MOSAIC_COMPILER_MSVC)
+    __yield();
+#else
+    __asm__ __volatile__("yield");
+#endif
+#endif
+}
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+
+// The period of the system timer, which wakes the waits of a timer without high resolution
+static constexpr std::chrono::milliseconds k_coarseTimerPeriod{16};
+
+// A waitable timer per sleeping thread, high resolution (Windows 10 1803+) where available: a
+// Sleep() or a plain timer wakes at the next 15.6 ms tick of the system timer
+struct WaitableTimer
+{
+    HANDLE handle = nullptr;
+    bool highResolution = false;
+
+    WaitableTimer()
+    {
+        handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                        TIMER_ALL_ACCESS);
+        highResolution = handle != nullptr;
+
+        if (!handle) handle = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+
+    ~WaitableTimer()
+    {
+        if (handle) CloseHandle(handle);
+    }
+
+    WaitableTimer(const WaitableTimer&) = delete;
+    WaitableTimer& operator=(const WaitableTimer&) = delete;
+};
+
+#endif
+
+// Blocks in the OS until about _deadline, never past it by more than the scheduler's latency
+static void sleepInSystemUntil(std::chrono::steady_clock::time_point _deadline)
+{
+    using namespace std::chrono;
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    thread_local WaitableTimer t_timer;
+
+    const auto remaining = _deadline - steady_clock::now();
+    if (remaining <= steady_clock::duration::zero()) return;
+
+    // a coarse timer wakes up to a tick late, that much of the wait is spun rather than overslept
+    const auto wait = t_timer.highResolution ? remaining : remaining - k_coarseTimerPeriod;
+    if (wait <= steady_clock::duration::zero()) return;
+
+    // relative, in units of 100 ns
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -std::max<LONGLONG>(duration_cast<nanoseconds>(wait).count() / 100, 1);
+
+    if (t_timer.handle && SetWaitableTimerEx(t_timer.handle, &dueTime, 0, nullptr, nullptr,
+                                             nullptr, 0))
+    {
+        WaitForSingleObject(t_timer.handle, INFINITE);
+    }
+    else
+    {
+        std::this_thread::sleep_for(wait);
+    }
+#elif defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+    // steady_clock is CLOCK_MONOTONIC: an absolute deadline does not drift across the signals
+    const auto sinceEpoch = duration_cast<nanoseconds>(_deadline.time_since_epoch()).count();
+
+    timespec deadline;
+    deadline.tv_sec = static_cast<time_t>(sinceEpoch / 1'000'000'000);
+    deadline.tv_nsec = static_cast<long>(sinceEpoch % 1'000'000'000);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+    {
+    }
+#else
+    std::this_thread::sleep_until(_deadline);
+#endif
+}
+
 struct Timer::Impl
 {
+    static constexpr uint32_t k_levelBits = 8;
+    static constexpr uint32_t k_slotsPerLevel = 1u << k_levelBits;
+    static constexpr uint32_t k_levelCount = 4;
+    static constexpr uint64_t k_maxDelta = (uint64_t{1} << (k_levelBits * k_levelCount)) - 1;
+    static constexpr uint32_t k_nil = std::numeric_limits<uint32_t>::max();
+
+    // Duration of a slot of the first level
+    using Ticks = std::chrono::duration<uint64_t, std::milli>;
+
+    // A scheduled callback, linked in the list of its slot. Freed nodes are reused, their
+    // generation tells the ids of the earlier callbacks apart.
+    struct Node
+    {
+        exec::MoveOnlyTask<void()> callback;
+        uint64_t expiry = 0; // in ticks
+        uint32_t prev = k_nil;
+        uint32_t next = k_nil;
+        uint32_t generation = 1;
+        uint32_t slot = k_nil; // k_nil when not scheduled
+        TimerDispatch dispatch = TimerDispatch::tick;
+    };
+
+    struct DueCallback
+    {
+        exec::MoveOnlyTask<void()> callback;
+        TimerDispatch dispatch;
+    };
+
     static double s_lastTime;
+    static double s_deltaTime; // between the last two ticks
+
+    // The timers advanced by tick()
+    static std::mutex s_timersMutex;
+    static std::vector<Impl*> s_timers;
 
-    std::vector<ScheduledCallback> m_callbacks;
-    std::mutex m_mutex;
-    bool m_running;
-    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_free;
+    std::array<uint32_t, k_slotsPerLevel * k_levelCount> m_slots;
+    uint64_t m_now; // the tick the wheel was advanced to
+    size_t m_pendingCount = 0;
+
+    Impl() : m_now(nowTicks())
+    {
+        m_slots.fill(k_nil);
 
-    Impl() : m_running(true) { m_thread = std::thread(&Impl::runScheduledCallbacks, this); }
+        std::lock_guard<std::mutex> lock(s_timersMutex);
+        s_timers.push_back(this);
+    }
 
     ~Impl()
     {
-        m_running = false;
-        if (m_thread.joinable()) m_thread.join();
+        std::lock_guard<std::mutex> lock(s_timersMutex);
+        s_timers.erase(std::find(s_timers.begin(), s_timers.end(), this));
     }
 
-    [[nodiscard]] size_t scheduleCallback(std::chrono::duration<double> _delaySeconds,
-                                          std::function<void()> _callback);
+    [[nodiscard]] uint64_t scheduleCallback(std::chrono::duration<double> _delaySeconds,
+                                            exec::MoveOnlyTask<void()> _callback,
+                                            TimerDispatch _dispatch);
+
+    bool cancelCallback(const uint64_t _id);
 
-    void cancelCallback(const size_t _id);
+    /**
+     * @brief Advances the wheel to the tick, moving the callbacks due to `_due`.
+     *
+     * Every elapsed tick visits one slot of the first level, and cascades the slot of an upper
+     * level into the levels below each time the ticks of the level below wrap around.
+     */
+    void collect(uint64_t _now, std::vector<DueCallback>& _due);
 
     static double getCurrentTime();
 
@@ -45,19 +211,88 @@ struct Timer::Impl
 
     static void sleepFor(std::chrono::duration<double> _seconds);
 
+    static void sleepUntil(std::chrono::steady_clock::time_point _deadline);
+
     static void tick();
 
-    /**
-     * @brief Runs the scheduled callbacks in a separate thread.
-     *
-     * This function continuously checks for scheduled callbacks and executes them when their
-     * trigger time is reached. It runs in a separate thread to avoid blocking the main application
-     * thread.
-     */
-    void runScheduledCallbacks();
+    static uint64_t nowTicks() noexcept
+    {
+        using namespace std::chrono;
+
+        return duration_cast<Ticks>(TickClock::now().time_since_epoch()).count();
+    }
+
+    // Runs the callbacks, or hands them to where they were scheduled to run.
+    static void dispatch(std::vector<DueCallback>& _due) noexcept;
+
+   private:
+    // Into the slot of the first level whose range covers the expiry, seen from the current
+    // tick. Past the range of the wheel the node waits in the last level, and is placed again
+    // once cascaded.
+    void link(uint32_t _node) noexcept
+    {
+        Node& node = m_nodes[_node];
+
+        const uint64_t expiry = std::clamp(node.expiry, m_now + 1, m_now + k_maxDelta);
+        const uint64_t delta = expiry - m_now;
+
+        uint32_t level = 0;
+        while (level + 1 < k_levelCount && (delta >> (k_levelBits * (level + 1))) != 0) ++level;
+
+        const uint64_t index = (expiry >> (k_levelBits * level)) & (k_slotsPerLevel - 1);
+        const auto slot = static_cast<uint32_t>(level * k_slotsPerLevel + index);
+
+        node.slot = slot;
+        node.prev = k_nil;
+        node.next = m_slots[slot];
+        if (node.next != k_nil) m_nodes[node.next].prev = _node;
+        m_slots[slot] = _node;
+    }
+
+    void unlink(uint32_t _node) noexcept
+    {
+        Node& node = m_nodes[_node];
+
+        if (node.prev != k_nil)
+            m_nodes[node.prev].next = node.next;
+        else
+            m_slots[node.slot] = node.next;
+
+        if (node.next != k_nil) m_nodes[node.next].prev = node.prev;
+
+        node.slot = k_nil;
+    }
+
+    // The node is unlinked and its callback moved out.
+    void release(uint32_t _node)
+    {
+        m_nodes[_node].generation++;
+        m_free.push_back(_node);
+        m_pendingCount--;
+    }
+
+    // Empties the slot, returns its first node.
+    uint32_t detach(uint32_t _slot) noexcept { return std::exchange(m_slots[_slot], k_nil); }
+
+    void cascade(uint32_t _level) noexcept
+    {
+        const uint64_t index = (m_now >> (k_levelBits * _level)) & (k_slotsPerLevel - 1);
+
+        uint32_t node = detach(static_cast<uint32_t>(_level * k_slotsPerLevel + index));
+
+        while (node != k_nil)
+        {
+            const uint32_t next = m_nodes[node].next;
+            link(node);
+            node = next;
+        }
+    }
 };
 
 double Timer::Impl::s_lastTime = getCurrentTime();
+double Timer::Impl::s_deltaTime = 0.0;
+std::mutex Timer::Impl::s_timersMutex;
+std::vector<Timer::Impl*> Timer::Impl::s_timers;
 
 Timer::Timer() : m_impl(new Impl()) {}
 
@@ -67,7 +302,7 @@ double Timer::Impl::getCurrentTime()
 {
     using namespace std::chrono;
 
-    auto now = steady_clock::now();
+    auto now = TickClock::now();
     double seconds = duration_cast<duration<double>>(now.time_since_epoch()).count();
     return seconds;
 }
@@ -82,87 +317,232 @@ std::string Timer::Impl::getCurrentDate()
 #pragma warning(default : 4996)
 }
 
-double Timer::Impl::getDeltaTime()
+double Timer::Impl::getDeltaTime() { return s_deltaTime; }
+
+void Timer::Impl::sleepFor(std::chrono::duration<double> _seconds)
 {
-    double now = getCurrentTime();
-    double dt = now - s_lastTime;
-    s_lastTime = now;
-    return dt;
+    using namespace std::chrono;
+
+    if (_seconds <= duration<double>::zero()) return;
+
+    sleepUntil(steady_clock::now() + duration_cast<steady_clock::duration>(_seconds));
 }
 
-void Timer::Impl::sleepFor(std::chrono::duration<double> _seconds)
+void Timer::Impl::sleepUntil(std::chrono::steady_clock::time_point _deadline)
 {
-    std::this_thread::sleep_for(_seconds);
+    using namespace std::chrono;
+
+    const auto now = steady_clock::now();
+    if (_deadline <= now) return;
+
+    if (_deadline - now > k_spinMargin) sleepInSystemUntil(_deadline - k_spinMargin);
+
+#if defined(MOSAIC_PLATFORM_EMSCRIPTEN)
+    // the main thread of a page must not spin, the browser would stall with it
+    std::this_thread::sleep_until(_deadline);
+#else
+    // the rest in ticks, cheaper to read than the steady clock in a loop
+    const auto remaining = duration_cast<nanoseconds>(_deadline - steady_clock::now()).count();
+    if (remaining <= 0) return;
+
+    const int64_t deadline = core::Ticks::now() + core::Ticks::fromNanoseconds(remaining);
+    while (core::Ticks::now() < deadline) cpuRelax();
+
+    // the calibration of the ticks may be off by a few nanoseconds: the steady clock has the last
+    // word, a read or two at most
+    while (steady_clock::now() < _deadline) cpuRelax();
+#endif
 }
 
-size_t Timer::Impl::scheduleCallback(std::chrono::duration<double> _delaySeconds,
-                                     std::function<void()> _callback)
+uint64_t Timer::Impl::scheduleCallback(std::chrono::duration<double> _delaySeconds,
+                                       exec::MoveOnlyTask<void()> _callback,
+                                       TimerDispatch _dispatch)
 {
-    static std::atomic<size_t> callbackIdCounter(0);
+    using namespace std::chrono;
 
-    callbackIdCounter++;
+    const auto delay = duration_cast<TickClock::duration>(
+        std::max(_delaySeconds, duration<double>::zero()));
 
-    double triggerTime = getCurrentTime() + _delaySeconds.count();
+    // rounded up, a callback never runs early
+    const uint64_t expiry = ceil<Ticks>(TickClock::now().time_since_epoch() + delay).count();
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_callbacks.emplace_back(callbackIdCounter, triggerTime, _callback);
+    uint32_t idx;
 
-    return callbackIdCounter.load();
+    if (!m_free.empty())
+    {
+        idx = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        idx = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    Node& node = m_nodes[idx];
+    node.callback = std::move(_callback);
+    node.expiry = expiry;
+    node.dispatch = _dispatch;
+
+    link(idx);
+    m_pendingCount++;
+
+    return (static_cast<uint64_t>(node.generation) << 32) | idx;
 }
 
-void Timer::Impl::cancelCallback(const size_t _id)
+bool Timer::Impl::cancelCallback(const uint64_t _id)
 {
+    const auto idx = static_cast<uint32_t>(_id & k_nil);
+    const auto generation = static_cast<uint32_t>(_id >> 32);
+
+    // destroyed out of the lock, its captures may use the timer
+    exec::MoveOnlyTask<void()> callback;
+
     std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = std::find_if(m_callbacks.begin(), m_callbacks.end(),
-                           [_id](const ScheduledCallback& cb) { return cb.id == _id; });
 
-    if (it != m_callbacks.end()) it->cancelled = true;
-}
+    if (idx >= m_nodes.size()) return false;
+
+    Node& node = m_nodes[idx];
+    if (node.generation != generation || node.slot == k_nil) return false;
 
-void Timer::Impl::tick() { s_lastTime = getCurrentTime(); }
+    unlink(idx);
+    callback = std::move(node.callback);
+    release(idx);
 
-void Timer::Impl::runScheduledCallbacks()
+    return true;
+}
+
+void Timer::Impl::collect(uint64_t _now, std::vector<DueCallback>& _due)
 {
-    using namespace std::chrono_literals;
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-    while (m_running)
+    while (m_now < _now)
     {
+        // no slot to visit in between
+        if (m_pendingCount == 0)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            double now = getCurrentTime();
+            m_now = _now;
+            break;
+        }
+
+        m_now++;
+
+        // highest level first, its nodes may land in the slot cascaded next
+        for (uint32_t level = k_levelCount - 1; level > 0; --level)
+        {
+            if ((m_now & ((uint64_t{1} << (k_levelBits * level)) - 1)) == 0) cascade(level);
+        }
 
-            std::vector<size_t> callbacksToRemove;
+        uint32_t node = detach(static_cast<uint32_t>(m_now & (k_slotsPerLevel - 1)));
 
-            for (size_t i = 0; i < m_callbacks.size(); ++i)
+        while (node != k_nil)
+        {
+            Node& current = m_nodes[node];
+            const uint32_t next = current.next;
+
+            // only the nodes clamped to the range of the wheel come back early
+            if (current.expiry > m_now)
+            {
+                link(node);
+            }
+            else
             {
-                if (m_callbacks[i].cancelled)
-                {
-                    callbacksToRemove.push_back(i);
-                }
-                else if (now >= m_callbacks[i].triggerTime)
-                {
-                    m_callbacks[i].callback();
-                    callbacksToRemove.push_back(i);
-                }
+                current.slot = k_nil;
+                _due.push_back({std::move(current.callback), current.dispatch});
+                release(node);
             }
 
-            std::sort(callbacksToRemove.begin(), callbacksToRemove.end(), std::greater<size_t>());
+            node = next;
+        }
+    }
+}
 
-            for (auto idx : callbacksToRemove) m_callbacks.erase(m_callbacks.begin() + idx);
+void Timer::Impl::dispatch(std::vector<DueCallback>& _due) noexcept
+{
+    for (auto& [callback, where] : _due)
+    {
+        if (where == TimerDispatch::thread_pool)
+        {
+            // from a worker (advance() in a pool task), to its own queue. A pool shutting down
+            // drops it with a warning.
+            if (auto* pool = exec::ThreadPool::getInstance())
+            {
+                pool->enqueueToCurrentWorker(std::move(callback));
+                continue;
+            }
+        }
+        else if (where == TimerDispatch::main_thread)
+        {
+            if (auto* queue = exec::MainThreadQueue::getInstance())
+            {
+                queue->post(std::move(callback));
+                continue;
+            }
         }
 
-        sleepFor(0.1ms);
+        // ticked callbacks, and the others when there is nowhere to send them
+        try
+        {
+            callback();
+        }
+        catch (const std::exception& e)
+        {
+            MOSAIC_ERROR("Timer: callback threw std::exception: {}", e.what());
+        }
+        catch (...)
+        {
+            MOSAIC_ERROR("Timer: callback threw unknown exception.");
+        }
     }
+
+    _due.clear();
 }
 
-size_t Timer::scheduleCallback(std::chrono::duration<double> _delaySeconds,
-                               std::function<void()> _callback)
+void Timer::Impl::tick()
 {
-    return m_impl->scheduleCallback(_delaySeconds, _callback);
+    const double time = getCurrentTime();
+    s_deltaTime = time - s_lastTime;
+    s_lastTime = time;
+
+    const uint64_t now = nowTicks();
+
+    // run once the list of timers is unlocked, the callbacks may create or destroy timers
+    std::vector<DueCallback> due;
+
+    {
+        std::lock_guard<std::mutex> lock(s_timersMutex);
+        for (Impl* timer : s_timers) timer->collect(now, due);
+    }
+
+    dispatch(due);
 }
 
-void Timer::cancelCallback(const size_t _id) { return m_impl->cancelCallback(_id); }
+uint64_t Timer::scheduleCallback(std::chrono::duration<double> _delaySeconds,
+                                 exec::MoveOnlyTask<void()> _callback, TimerDispatch _dispatch)
+{
+    return m_impl->scheduleCallback(_delaySeconds, std::move(_callback), _dispatch);
+}
+
+bool Timer::cancelCallback(const uint64_t _id) { return m_impl->cancelCallback(_id); }
+
+size_t Timer::advance()
+{
+    std::vector<Impl::DueCallback> due;
+    m_impl->collect(Impl::nowTicks(), due);
+
+    const size_t count = due.size();
+    Impl::dispatch(due);
+
+    return count;
+}
+
+size_t Timer::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    return m_impl->m_pendingCount;
+}
 
 double Timer::getCurrentTime() { return Impl::getCurrentTime(); }
 
@@ -172,6 +552,11 @@ double Timer::getDeltaTime() { return Impl::getDeltaTime(); }
 
 void Timer::sleepFor(std::chrono::duration<double> _seconds) { Impl::sleepFor(_seconds); }
 
+void Timer::sleepUntil(std::chrono::steady_clock::time_point _deadline)
+{
+    Impl::sleepUntil(_deadline);
+}
+
 void Timer::tick() { Impl::tick(); }
 
 } // namespace core
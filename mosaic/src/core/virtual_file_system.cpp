@@ -0,0 +1,283 @@
+#include "mosaic/core/virtual_file_system.hpp"
+
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+#include "mosaic/core/mapped_file.hpp"
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+#include <android/asset_manager.h>
+#endif
+
+namespace mosaic
+{
+namespace core
+{
+
+VirtualFileSystem* VirtualFileSystem::g_instance = nullptr;
+
+// The path relative to the point, none if the point does not prefix it
+static std::optional<std::string_view> relativeTo(std::string_view _path, std::string_view _point)
+{
+    if (_point.empty()) return _path;
+
+    if (!_path.starts_with(_point)) return std::nullopt;
+    if (_path.size() == _point.size()) return std::string_view();
+    if (_path[_point.size()] != '/') return std::nullopt;
+
+    return _path.substr(_point.size() + 1);
+}
+
+static std::string normalizePoint(std::string_view _point)
+{
+    std::string point = AssetArchive::normalizePath(_point);
+    while (point.ends_with('/')) point.pop_back();
+
+    return point;
+}
+
+// None if the file is not there, or if it cannot be read (_error says why then)
+static std::optional<FileData> readDirectory(const std::filesystem::path& _directory,
+                                             std::string_view _path, std::string& _error)
+{
+    const std::filesystem::path path = _directory / _path;
+
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error)) return std::nullopt;
+
+    try
+    {
+        auto file = std::make_shared<const MappedFile>(path);
+        return FileData(file->bytes(), file);
+    }
+    catch (const std::exception& _exception)
+    {
+        _error = _exception.what();
+        return std::nullopt;
+    }
+}
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+
+// Same as readDirectory()
+static std::optional<FileData> readAssets(AAssetManager* _assets, std::string_view _path,
+                                          std::string& _error)
+{
+    const std::string path(_path);
+
+    AAsset* asset = AAssetManager_open(_assets, path.c_str(), AASSET_MODE_BUFFER);
+    if (!asset) return std::nullopt;
+
+    // mapped from the APK when the asset is stored uncompressed, the asset keeps the mapping
+    const auto* data = static_cast<const uint8_t*>(AAsset_getBuffer(asset));
+    if (!data)
+    {
+        AAsset_close(asset);
+        _error = "Failed to read asset: " + path;
+        return std::nullopt;
+    }
+
+    const size_t size = static_cast<size_t>(AAsset_getLength64(asset));
+    std::shared_ptr<AAsset> owner(asset, AAsset_close);
+
+    return FileData({data, size}, std::move(owner));
+}
+
+#endif
+
+VirtualFileSystem::VirtualFileSystem()
+{
+    if (!g_instance) g_instance = this;
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+    if (g_instance == this) g_instance = nullptr;
+}
+
+void VirtualFileSystem::mountDirectory(std::string_view _point,
+                                       const std::filesystem::path& _directory)
+{
+    Mount mount;
+    mount.point = normalizePoint(_point);
+    mount.directory = _directory;
+
+    std::unique_lock lock(m_mutex);
+    m_mounts.push_back(std::move(mount));
+}
+
+void VirtualFileSystem::mountArchive(std::string_view _point,
+                                     const std::filesystem::path& _archive)
+{
+    mountArchive(_point, std::make_shared<const AssetArchive>(_archive));
+}
+
+void VirtualFileSystem::mountArchive(std::string_view _point,
+                                     std::shared_ptr<const AssetArchive> _archive)
+{
+    Mount mount;
+    mount.point = normalizePoint(_point);
+    mount.archive = std::move(_archive);
+
+    std::unique_lock lock(m_mutex);
+    m_mounts.push_back(std::move(mount));
+}
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+
+void VirtualFileSystem::mountAssets(std::string_view _point, AAssetManager* _assets)
+{
+    Mount mount;
+    mount.point = normalizePoint(_point);
+    mount.assets = _assets;
+
+    std::unique_lock lock(m_mutex);
+    m_mounts.push_back(std::move(mount));
+}
+
+#endif
+
+void VirtualFileSystem::unmount(std::string_view _point)
+{
+    const std::string point = normalizePoint(_point);
+
+    std::unique_lock lock(m_mutex);
+    std::erase_if(m_mounts, [&](const Mount& _mount) { return _mount.point == point; });
+}
+
+pieces::Result<FileData, std::string> VirtualFileSystem::read(std::string_view _path) const
+{
+    const std::string path = AssetArchive::normalizePath(_path);
+    std::string error = "No such file: " + path;
+
+    // the data read shares its source (mapping, archive, asset), it outlives an unmount
+    std::shared_lock lock(m_mutex);
+
+    for (auto it = m_mounts.rbegin(); it != m_mounts.rend(); ++it)
+    {
+        const std::optional<std::string_view> relative = relativeTo(path, it->point);
+        if (!relative || relative->empty()) continue;
+
+        if (it->archive)
+        {
+            const AssetArchive::Entry* entry = it->archive->find(*relative);
+            if (!entry) continue;
+
+            try
+            {
+                return pieces::Ok<FileData, std::string>(it->archive->read(*entry));
+            }
+            catch (const std::exception& _error)
+            {
+                error = _error.what();
+            }
+
+            continue;
+        }
+
+        std::optional<FileData> data;
+#if defined(MOSAIC_PLATFORM_ANDROID)
+        if (it->assets)
+        {
+            data = readAssets(it->assets, *relative, error);
+        }
+        else
+#endif
+        {
+            data = readDirectory(it->directory, *relative, error);
+        }
+
+        if (data) return pieces::Ok<FileData, std::string>(std::move(*data));
+    }
+
+    return pieces::Err<FileData, std::string>(std::move(error));
+}
+
+bool VirtualFileSystem::exists(std::string_view _path) const
+{
+    const std::string path = AssetArchive::normalizePath(_path);
+
+    std::shared_lock lock(m_mutex);
+
+    for (auto it = m_mounts.rbegin(); it != m_mounts.rend(); ++it)
+    {
+        const std::optional<std::string_view> relative = relativeTo(path, it->point);
+        if (!relative || relative->empty()) continue;
+
+        if (it->archive)
+        {
+            if (it->archive->find(*relative)) return true;
+            continue;
+        }
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+        if (it->assets)
+        {
+            const std::string asset(*relative);
+            AAsset* opened = AAssetManager_open(it->assets, asset.c_str(), AASSET_MODE_UNKNOWN);
+            if (opened)
+            {
+                AAsset_close(opened);
+                return true;
+            }
+            continue;
+        }
+#endif
+
+        std::error_code error;
+        if (std::filesystem::is_regular_file(it->directory / *relative, error)) return true;
+    }
+
+    return false;
+}
+
+std::optional<std::filesystem::path> VirtualFileSystem::locate(std::string_view _path) const
+{
+    const std::string path = AssetArchive::normalizePath(_path);
+
+    std::shared_lock lock(m_mutex);
+
+    for (auto it = m_mounts.rbegin(); it != m_mounts.rend(); ++it)
+    {
+        const std::optional<std::string_view> relative = relativeTo(path, it->point);
+        if (!relative || relative->empty()) continue;
+
+        if (it->archive)
+        {
+            if (it->archive->find(*relative)) return std::nullopt;
+            continue;
+        }
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+        // inside the APK, not a file of its own
+        if (it->assets)
+        {
+            const std::string asset(*relative);
+            AAsset* opened = AAssetManager_open(it->assets, asset.c_str(), AASSET_MODE_UNKNOWN);
+            if (!opened) continue;
+
+            AAsset_close(opened);
+            return std::nullopt;
+        }
+#endif
+
+        std::filesystem::path file = it->directory / *relative;
+
+        std::error_code error;
+        if (std::filesystem::is_regular_file(file, error)) return file;
+    }
+
+    return std::nullopt;
+}
+
+size_t VirtualFileSystem::getMountCount() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_mounts.size();
+}
+
+} // namespace core
+} // namespace mosaic
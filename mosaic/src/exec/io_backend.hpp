@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mosaic/exec/io_service.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+namespace detail
+{
+
+// The largest part of a read handed to the kernel at once, the rest is read when it completes
+inline constexpr size_t k_maxIoChunk = size_t(1) << 30;
+
+struct IoRead
+{
+    std::shared_ptr<const IoFile> file;
+    uint64_t offset = 0;
+    IoBuffer buffer; // of the size asked
+    size_t done = 0; // bytes read so far
+    TaskPriority priority = TaskPriority::normal;
+    TaskPromise<IoBuffer> promise;
+
+    [[nodiscard]] uint8_t* next() noexcept { return buffer.data() + done; }
+    [[nodiscard]] uint64_t nextOffset() const noexcept { return offset + done; }
+    [[nodiscard]] size_t nextSize() const noexcept
+    {
+        return std::min(buffer.size() - done, k_maxIoChunk);
+    }
+};
+
+/**
+ * @brief The reads waiting for a slot, by priority, and the count of those in flight: what every
+ * backend shares. The backends take batches (takeBatch()), report the result of every part they
+ * read (advance()), and call pump() once they reaped their completions.
+ */
+class IoQueue
+{
+   private:
+    std::array<std::deque<std::unique_ptr<IoRead>>, k_taskPriorityCount> m_queued;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_idle;
+
+    std::atomic<size_t> m_inFlight = 0;
+    uint32_t m_depth = 0;
+    bool m_stopping = false;
+
+   public:
+    void start(uint32_t _depth);
+
+    // Drops the queued reads (their promises broken), takeBatch() returns nothing after it.
+    void stop();
+
+    void push(std::unique_ptr<IoRead> _read);
+    void push(std::vector<std::unique_ptr<IoRead>> _reads);
+
+    /**
+     * @brief The queued reads that fit the free slots, highest priority first, counted in flight;
+     * those whose future was cancelled are dropped.
+     */
+    [[nodiscard]] std::vector<IoRead*> takeBatch();
+
+    /**
+     * @brief Accounts the result of the last part of the read: the bytes read, or minus the system
+     * error code. Completes the read (its future, then frees it and its slot) on an error, at the
+     * end of the file or once every byte is read.
+     *
+     * @return true if the rest of the read is still to submit.
+     */
+    [[nodiscard]] bool advance(IoRead* _read, int64_t _result) noexcept;
+
+    // Frees a read that never completed (its promise broken) and its slot.
+    void abandon(IoRead* _read) noexcept;
+
+    [[nodiscard]] size_t getQueuedCount() const;
+    [[nodiscard]] size_t getInFlightCount() const noexcept
+    {
+        return m_inFlight.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] bool isStopping() const;
+
+    // Blocks until no read is in flight.
+    void waitIdle();
+
+   private:
+    void release(IoRead* _read) noexcept;
+};
+
+class IoBackend
+{
+   protected:
+    IoQueue& m_queue;
+
+   public:
+    explicit IoBackend(IoQueue& _queue) : m_queue(_queue) {};
+    virtual ~IoBackend() = default;
+
+    // Starts the reads of a batch, from any thread.
+    virtual void submit(std::span<IoRead* const> _reads) = 0;
+
+    // Once the queue stopped: waits for the reads in flight, the thread of the backend joined.
+    virtual void stop() = 0;
+
+    [[nodiscard]] virtual IoBackendType getType() const noexcept = 0;
+
+    // Submits the batches of the queue until it has none.
+    void pump()
+    {
+        for (std::vector<IoRead*> batch = m_queue.takeBatch(); !batch.empty();
+             batch = m_queue.takeBatch())
+        {
+            submit(batch);
+        }
+    }
+};
+
+#if defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+// None if the kernel does not offer io_uring (or IORING_OP_READ), _error says why.
+std::unique_ptr<IoBackend> createUringBackend(IoQueue& _queue, uint32_t _depth,
+                                              std::string& _error);
+#endif
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+// Same as above for an I/O completion port.
+std::unique_ptr<IoBackend> createIocpBackend(IoQueue& _queue, std::string& _error);
+#endif
+
+} // namespace detail
+} // namespace exec
+} // namespace mosaic
@@ -0,0 +1,487 @@
+#include "mosaic/exec/io_service.hpp"
+
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "mosaic/tools/logger.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+#include "io_backend.hpp"
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mosaic
+{
+namespace exec
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// IoFile
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+IoFile::IoFile(const std::filesystem::path& _path) : m_path(_path)
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    // overlapped for the completion port, positional reads either way
+    m_handle = ::CreateFileW(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+    if (m_handle == INVALID_HANDLE_VALUE)
+    {
+        throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(),
+                                "Failed to open " + _path.string());
+    }
+
+    LARGE_INTEGER size{};
+    ::GetFileSizeEx(m_handle, &size);
+    m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+    m_fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        throw std::system_error(errno, std::system_category(), "Failed to open " + _path.string());
+    }
+
+    struct stat info{};
+    if (::fstat(m_fd, &info) == 0) m_size = static_cast<uint64_t>(info.st_size);
+#endif
+}
+
+IoFile::~IoFile()
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    if (m_handle != INVALID_HANDLE_VALUE) ::CloseHandle(m_handle);
+#else
+    if (m_fd >= 0) ::close(m_fd);
+#endif
+}
+
+int64_t IoFile::readAt(void* _data, size_t _size, uint64_t _offset) const noexcept
+{
+    _size = std::min(_size, detail::k_maxIoChunk);
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    // an overlapped handle still reads synchronously when waited for
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(_offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(_offset >> 32);
+    overlapped.hEvent = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!overlapped.hEvent) return -static_cast<int64_t>(::GetLastError());
+
+    DWORD read = 0;
+    BOOL done = ::ReadFile(m_handle, _data, static_cast<DWORD>(_size), nullptr, &overlapped);
+    DWORD error = done ? ERROR_SUCCESS : ::GetLastError();
+    if (done || error == ERROR_IO_PENDING)
+    {
+        done = ::GetOverlappedResult(m_handle, &overlapped, &read, TRUE);
+        error = done ? ERROR_SUCCESS : ::GetLastError();
+    }
+    ::CloseHandle(overlapped.hEvent);
+
+    if (error == ERROR_HANDLE_EOF) return 0;
+    if (error != ERROR_SUCCESS) return -static_cast<int64_t>(error);
+
+    return static_cast<int64_t>(read);
+#else
+    for (;;)
+    {
+        const ssize_t read = ::pread(m_fd, _data, _size, static_cast<off_t>(_offset));
+        if (read >= 0) return static_cast<int64_t>(read);
+        if (errno != EINTR) return -static_cast<int64_t>(errno);
+    }
+#endif
+}
+
+namespace detail
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// IoQueue
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void IoQueue::start(uint32_t _depth)
+{
+    std::lock_guard lock(m_mutex);
+
+    m_depth = std::max(_depth, 1u);
+    m_stopping = false;
+}
+
+void IoQueue::stop()
+{
+    std::array<std::deque<std::unique_ptr<IoRead>>, k_taskPriorityCount> dropped;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_stopping = true;
+        dropped.swap(m_queued);
+    }
+}
+
+void IoQueue::push(std::unique_ptr<IoRead> _read)
+{
+    std::lock_guard lock(m_mutex);
+
+    // shutting down: the promise broken
+    if (m_stopping) return;
+
+    m_queued[static_cast<size_t>(_read->priority)].push_back(std::move(_read));
+}
+
+void IoQueue::push(std::vector<std::unique_ptr<IoRead>> _reads)
+{
+    std::lock_guard lock(m_mutex);
+
+    if (m_stopping) return;
+
+    for (auto& read : _reads)
+    {
+        m_queued[static_cast<size_t>(read->priority)].push_back(std::move(read));
+    }
+}
+
+std::vector<IoRead*> IoQueue::takeBatch()
+{
+    std::vector<IoRead*> batch;
+    std::vector<std::unique_ptr<IoRead>> cancelled;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (m_stopping) return batch;
+
+        for (auto& queued : m_queued)
+        {
+            while (!queued.empty() && m_inFlight.load(std::memory_order_relaxed) < m_depth)
+            {
+                std::unique_ptr<IoRead> read = std::move(queued.front());
+                queued.pop_front();
+
+                // a future cancelled while queued is complete already
+                if (!read->promise.getState()->tryMarkExecuting())
+                {
+                    cancelled.push_back(std::move(read));
+                    continue;
+                }
+
+                m_inFlight.fetch_add(1, std::memory_order_relaxed);
+                batch.push_back(read.release());
+            }
+        }
+    }
+
+    return batch;
+}
+
+bool IoQueue::advance(IoRead* _read, int64_t _result) noexcept
+{
+    if (_result < 0)
+    {
+        const std::error_code error(static_cast<int>(-_result), std::system_category());
+        _read->promise.setException(std::make_exception_ptr(
+            std::system_error(error, "Failed to read " + _read->file->getPath().string())));
+
+        release(_read);
+        return false;
+    }
+
+    _read->done += static_cast<size_t>(_result);
+
+    if (_result > 0 && _read->done < _read->buffer.size()) return true;
+
+    // complete, or cut at the end of the file
+    _read->buffer.resize(_read->done);
+    _read->promise.setValue(std::move(_read->buffer));
+
+    release(_read);
+    return false;
+}
+
+void IoQueue::abandon(IoRead* _read) noexcept
+{
+    // marked executing by takeBatch(), the destructor of the promise would not break it
+    _read->promise.setException(
+        std::make_exception_ptr(FutureException(FutureErrorCode::broken_promise)));
+
+    release(_read);
+}
+
+void IoQueue::release(IoRead* _read) noexcept
+{
+    delete _read;
+
+    if (m_inFlight.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        std::lock_guard lock(m_mutex);
+        m_idle.notify_all();
+    }
+}
+
+size_t IoQueue::getQueuedCount() const
+{
+    std::lock_guard lock(m_mutex);
+
+    size_t count = 0;
+    for (const auto& queued : m_queued) count += queued.size();
+
+    return count;
+}
+
+bool IoQueue::isStopping() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_stopping;
+}
+
+void IoQueue::waitIdle()
+{
+    std::unique_lock lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_inFlight.load(std::memory_order_acquire) == 0; });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ThreadPoolBackend
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Blocking reads, one pool task per read: the queue depth bounds the workers they take
+class ThreadPoolBackend final : public IoBackend
+{
+   private:
+    // Abandons its read if the pool drops it, counted until destroyed: it pumps after its read
+    struct Job
+    {
+        ThreadPoolBackend* backend;
+        IoRead* read;
+
+        Job(ThreadPoolBackend* _backend, IoRead* _read) : backend(_backend), read(_read)
+        {
+            backend->m_jobs.fetch_add(1, std::memory_order_relaxed);
+        }
+        Job(Job&& _other) noexcept
+            : backend(std::exchange(_other.backend, nullptr)),
+              read(std::exchange(_other.read, nullptr)) {};
+        Job(const Job&) = delete;
+
+        ~Job()
+        {
+            if (!backend) return;
+
+            if (read) backend->m_queue.abandon(read);
+            backend->finishJob();
+        }
+
+        void operator()()
+        {
+            backend->read(std::exchange(read, nullptr));
+            backend->pump();
+        }
+    };
+
+    std::atomic<size_t> m_jobs = 0;
+    std::mutex m_jobsMutex;
+    std::condition_variable m_jobsDone;
+
+   public:
+    using IoBackend::IoBackend;
+
+    void submit(std::span<IoRead* const> _reads) override
+    {
+        ThreadPool* pool = ThreadPool::getInstance();
+
+        for (IoRead* read : _reads)
+        {
+            // inline without a pool, pump() then takes the next batch
+            if (!pool)
+            {
+                this->read(read);
+                continue;
+            }
+
+            pool->enqueueToCurrentWorker(Job(this, read), read->priority);
+        }
+    }
+
+    void stop() override
+    {
+        m_queue.waitIdle();
+
+        std::unique_lock lock(m_jobsMutex);
+        m_jobsDone.wait(lock, [this] { return m_jobs.load(std::memory_order_acquire) == 0; });
+    }
+
+    IoBackendType getType() const noexcept override { return IoBackendType::thread_pool; }
+
+   private:
+    void read(IoRead* _read) noexcept
+    {
+        MOSAIC_TRACE_SITE_SCOPE("IoService::read", tools::TraceCategory::io);
+
+        while (m_queue.advance(_read, _read->file->readAt(_read->next(), _read->nextSize(),
+                                                           _read->nextOffset())))
+        {
+        }
+    }
+
+    // Under the lock: stop() returns once it is released, the backend destroyed after it
+    void finishJob() noexcept
+    {
+        std::lock_guard lock(m_jobsMutex);
+        if (m_jobs.fetch_sub(1, std::memory_order_acq_rel) == 1) m_jobsDone.notify_all();
+    }
+};
+
+} // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// IoService
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct IoService::Impl
+{
+    detail::IoQueue queue;
+    std::unique_ptr<detail::IoBackend> backend;
+    std::atomic<IoBackendType> type = IoBackendType::none;
+};
+
+IoService* IoService::g_instance = nullptr;
+
+IoService::IoService() : m_impl(new Impl())
+{
+    if (!g_instance) g_instance = this;
+}
+
+IoService::~IoService()
+{
+    shutdown();
+
+    delete m_impl;
+    m_impl = nullptr;
+
+    if (g_instance == this) g_instance = nullptr;
+}
+
+pieces::RefResult<IoService, std::string> IoService::initialize(uint32_t _queueDepth,
+                                                               IoBackendType _preferred) noexcept
+{
+    if (m_impl->backend)
+    {
+        return pieces::ErrRef<IoService, std::string>("IoService is already initialized");
+    }
+
+    // io_uring takes 4096 entries at most, one of them for its wake-up
+    _queueDepth = std::clamp(_queueDepth, 1u, 4095u);
+
+    std::string error;
+
+#if defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+    if (_preferred == IoBackendType::none || _preferred == IoBackendType::io_uring)
+    {
+        m_impl->backend = detail::createUringBackend(m_impl->queue, _queueDepth, error);
+    }
+#elif defined(MOSAIC_PLATFORM_WINDOWS)
+    if (_preferred == IoBackendType::none || _preferred == IoBackendType::iocp)
+    {
+        m_impl->backend = detail::createIocpBackend(m_impl->queue, error);
+    }
+#endif
+
+    if (!m_impl->backend)
+    {
+        if (!error.empty()) MOSAIC_WARN("IoService: {}, reading on the thread pool", error);
+
+        m_impl->backend = std::make_unique<detail::ThreadPoolBackend>(m_impl->queue);
+        _queueDepth = std::min(_queueDepth, k_threadPoolQueueDepth);
+    }
+
+    m_impl->queue.start(_queueDepth);
+    m_impl->type.store(m_impl->backend->getType(), std::memory_order_release);
+
+    return pieces::OkRef<IoService, std::string>(*this);
+}
+
+void IoService::shutdown() noexcept
+{
+    if (!m_impl || !m_impl->backend) return;
+
+    m_impl->type.store(IoBackendType::none, std::memory_order_release);
+
+    m_impl->queue.stop();
+    m_impl->backend->stop();
+    m_impl->backend.reset();
+}
+
+TaskFuture<IoBuffer> IoService::readAsync(std::shared_ptr<const IoFile> _file, uint64_t _offset,
+                                          size_t _size, TaskPriority _priority)
+{
+    const IoRequest request{std::move(_file), _offset, _size};
+    std::vector<TaskFuture<IoBuffer>> futures = readBatch(std::span(&request, 1), _priority);
+
+    return std::move(futures.front());
+}
+
+std::vector<TaskFuture<IoBuffer>> IoService::readBatch(std::span<const IoRequest> _requests,
+                                                       TaskPriority _priority)
+{
+    std::vector<TaskFuture<IoBuffer>> futures;
+    futures.reserve(_requests.size());
+
+    std::vector<std::unique_ptr<detail::IoRead>> reads;
+    reads.reserve(_requests.size());
+
+    const bool running = m_impl->type.load(std::memory_order_acquire) != IoBackendType::none;
+
+    for (const IoRequest& request : _requests)
+    {
+        auto read = std::make_unique<detail::IoRead>();
+        futures.push_back(read->promise.getFuture());
+
+        if (!running)
+        {
+            read->promise.setException(
+                std::make_exception_ptr(std::runtime_error("IoService is not running")));
+            continue;
+        }
+
+        if (request.size == 0)
+        {
+            read->promise.setValue(IoBuffer());
+            continue;
+        }
+
+        read->file = request.file;
+        read->offset = request.offset;
+        read->buffer.resize(request.size);
+        read->priority = _priority;
+
+        reads.push_back(std::move(read));
+    }
+
+    if (!reads.empty())
+    {
+        m_impl->queue.push(std::move(reads));
+        m_impl->backend->pump();
+    }
+
+    return futures;
+}
+
+IoBackendType IoService::getBackend() const noexcept
+{
+    return m_impl->type.load(std::memory_order_acquire);
+}
+
+size_t IoService::getQueuedCount() const { return m_impl->queue.getQueuedCount(); }
+
+size_t IoService::getInFlightCount() const noexcept { return m_impl->queue.getInFlightCount(); }
+
+} // namespace exec
+} // namespace mosaic
@@ -0,0 +1,297 @@
+#include "io_backend.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define MOSAIC_IO_URING
+#endif
+
+#include "mosaic/tools/logger.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+namespace detail
+{
+
+#if defined(MOSAIC_IO_URING)
+
+// The user data of the wake-up of the completion thread, no read is at address 0
+static constexpr uint64_t k_wakeUserData = 0;
+
+/**
+ * @brief io_uring through the raw system calls (liburing is not a dependency): one ring, written
+ * by the submitting threads under a mutex, reaped by a completion thread of its own.
+ *
+ * The submission and completion rings are shared with the kernel: it reads the submission tail
+ * and writes the completion tail, hence the acquire/release accesses of those words. The reads
+ * pass through the kernel between the submitters and the completion thread, unseen by
+ * ThreadSanitizer.
+ */
+class UringBackend final : public IoBackend
+{
+   private:
+    int m_ring = -1;
+
+    void* m_sqMapping = MAP_FAILED;
+    size_t m_sqMappingSize = 0;
+    void* m_cqMapping = MAP_FAILED;
+    size_t m_cqMappingSize = 0;
+    io_uring_sqe* m_sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t m_sqesSize = 0;
+
+    uint32_t* m_sqHead = nullptr;
+    uint32_t* m_sqTail = nullptr;
+    uint32_t m_sqMask = 0;
+    uint32_t* m_sqArray = nullptr;
+    uint32_t m_sqLocalTail = 0; // the entries acquired, published to the kernel by enter()
+
+    uint32_t* m_cqHead = nullptr;
+    uint32_t* m_cqTail = nullptr;
+    uint32_t m_cqMask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+
+    std::mutex m_submitMutex;
+    std::thread m_thread;
+
+   public:
+    using IoBackend::IoBackend;
+
+    ~UringBackend() override { release(); }
+
+    // false, with the error, if the kernel refuses the ring
+    bool start(uint32_t _depth, std::string& _error)
+    {
+        io_uring_params params{};
+
+        // one more for the wake-up, the kernel rounds up to a power of two
+        m_ring = static_cast<int>(::syscall(__NR_io_uring_setup, _depth + 1, &params));
+        if (m_ring < 0)
+        {
+            _error = std::string("io_uring_setup failed: ") + std::strerror(errno);
+            return false;
+        }
+
+        // IORING_OP_READ came with the current-position reads (Linux 5.6)
+        if (!(params.features & IORING_FEAT_RW_CUR_POS))
+        {
+            _error = "io_uring has no IORING_OP_READ (Linux 5.6+)";
+            return false;
+        }
+
+        m_sqMappingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        m_cqMappingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) m_sqMappingSize = m_cqMappingSize = std::max(m_sqMappingSize, m_cqMappingSize);
+
+        m_sqMapping = ::mmap(nullptr, m_sqMappingSize, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+        m_cqMapping = single ? m_sqMapping
+                             : ::mmap(nullptr, m_cqMappingSize, PROT_READ | PROT_WRITE,
+                                      MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, m_ring,
+                                                   IORING_OFF_SQES));
+
+        if (m_sqMapping == MAP_FAILED || m_cqMapping == MAP_FAILED || m_sqes == MAP_FAILED)
+        {
+            _error = std::string("Failed to map the io_uring rings: ") + std::strerror(errno);
+            return false;
+        }
+
+        auto* sq = static_cast<uint8_t*>(m_sqMapping);
+        m_sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+        m_sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        m_sqLocalTail = *m_sqTail;
+
+        auto* cq = static_cast<uint8_t*>(m_cqMapping);
+        m_cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        m_thread = std::thread([this] { reap(); });
+
+        return true;
+    }
+
+    void submit(std::span<IoRead* const> _reads) override
+    {
+        std::lock_guard lock(m_submitMutex);
+
+        for (IoRead* read : _reads)
+        {
+            io_uring_sqe& sqe = acquireEntry();
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = read->file->getNativeHandle();
+            sqe.off = read->nextOffset();
+            sqe.addr = reinterpret_cast<uint64_t>(read->next());
+            sqe.len = static_cast<uint32_t>(read->nextSize());
+            sqe.user_data = reinterpret_cast<uint64_t>(read);
+        }
+
+        enter();
+    }
+
+    void stop() override
+    {
+        if (!m_thread.joinable()) return;
+
+        // the thread leaves once it reaped the wake-up and nothing is in flight
+        {
+            std::lock_guard lock(m_submitMutex);
+
+            io_uring_sqe& sqe = acquireEntry();
+            sqe.opcode = IORING_OP_NOP;
+            sqe.user_data = k_wakeUserData;
+
+            enter();
+        }
+
+        m_thread.join();
+    }
+
+    IoBackendType getType() const noexcept override { return IoBackendType::io_uring; }
+
+   private:
+    // A cleared entry past the tail; the queue depth keeps one free for every read in flight
+    io_uring_sqe& acquireEntry() noexcept
+    {
+        const uint32_t index = m_sqLocalTail++ & m_sqMask;
+
+        io_uring_sqe& sqe = m_sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        m_sqArray[index] = index;
+
+        return sqe;
+    }
+
+    // Publishes the entries acquired and hands them to the kernel
+    void enter() noexcept
+    {
+        std::atomic_ref(*m_sqTail).store(m_sqLocalTail, std::memory_order_release);
+
+        for (;;)
+        {
+            const uint32_t pending =
+                m_sqLocalTail - std::atomic_ref(*m_sqHead).load(std::memory_order_acquire);
+            if (pending == 0) return;
+
+            const long submitted =
+                ::syscall(__NR_io_uring_enter, m_ring, pending, 0, 0, nullptr, 0);
+            if (submitted > 0) continue;
+            if (submitted == 0) return;
+
+            // a full completion ring clears as the completion thread reaps it
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            MOSAIC_ERROR("io_uring_enter failed: {}", std::strerror(errno));
+            return;
+        }
+    }
+
+    void reap()
+    {
+        std::vector<IoRead*> resubmit;
+        bool woken = false;
+
+        for (;;)
+        {
+            uint32_t head = *m_cqHead; // written by this thread only
+            const uint32_t tail = std::atomic_ref(*m_cqTail).load(std::memory_order_acquire);
+
+            if (head == tail)
+            {
+                if (woken && m_queue.getInFlightCount() == 0) return;
+
+                ::syscall(__NR_io_uring_enter, m_ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+
+            {
+                MOSAIC_TRACE_SITE_SCOPE("IoService::reap", tools::TraceCategory::io);
+
+                for (; head != tail; ++head)
+                {
+                    const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+
+                    if (cqe.user_data == k_wakeUserData)
+                    {
+                        woken = true;
+                        continue;
+                    }
+
+                    auto* read = reinterpret_cast<IoRead*>(cqe.user_data);
+                    if (m_queue.advance(read, cqe.res)) resubmit.push_back(read);
+                }
+
+                std::atomic_ref(*m_cqHead).store(head, std::memory_order_release);
+
+                // the rest of short reads, in the slots they hold
+                if (!resubmit.empty())
+                {
+                    submit(resubmit);
+                    resubmit.clear();
+                }
+            }
+
+            pump();
+        }
+    }
+
+    void release() noexcept
+    {
+        if (m_sqes != MAP_FAILED) ::munmap(m_sqes, m_sqesSize);
+        if (m_cqMapping != MAP_FAILED && m_cqMapping != m_sqMapping)
+        {
+            ::munmap(m_cqMapping, m_cqMappingSize);
+        }
+        if (m_sqMapping != MAP_FAILED) ::munmap(m_sqMapping, m_sqMappingSize);
+        if (m_ring >= 0) ::close(m_ring);
+
+        m_ring = -1;
+    }
+};
+
+#endif
+
+std::unique_ptr<IoBackend> createUringBackend(IoQueue& _queue, uint32_t _depth,
+                                              std::string& _error)
+{
+#if defined(MOSAIC_IO_URING)
+    auto backend = std::make_unique<UringBackend>(_queue);
+    if (!backend->start(_depth, _error)) return nullptr;
+
+    return backend;
+#else
+    (void)_queue;
+    (void)_depth;
+    _error = "io_uring is not available in this build";
+
+    return nullptr;
+#endif
+}
+
+} // namespace detail
+} // namespace exec
+} // namespace mosaic
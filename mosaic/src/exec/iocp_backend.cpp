@@ -0,0 +1,156 @@
+#include "io_backend.hpp"
+
+#include <thread>
+#include <vector>
+
+#include <windows.h>
+
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+namespace detail
+{
+
+// The completion key of the wake-up of the completion thread, the reads post 0
+static constexpr ULONG_PTR k_wakeKey = 1;
+
+/**
+ * @brief An I/O completion port, the files associated with it on their first read (for good: a
+ * handle takes one port), reaped by a completion thread of its own. Every read posts its
+ * completion, synchronous ones included.
+ */
+class IocpBackend final : public IoBackend
+{
+   private:
+    struct Overlapped
+    {
+        OVERLAPPED overlapped{}; // first, the completion hands its address back
+        IoRead* read = nullptr;
+    };
+
+    HANDLE m_port = nullptr;
+    std::thread m_thread;
+
+   public:
+    using IoBackend::IoBackend;
+
+    ~IocpBackend() override
+    {
+        if (m_port) ::CloseHandle(m_port);
+    }
+
+    bool start(std::string& _error)
+    {
+        m_port = ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+        if (!m_port)
+        {
+            _error = "CreateIoCompletionPort failed: " + std::to_string(::GetLastError());
+            return false;
+        }
+
+        m_thread = std::thread([this] { reap(); });
+
+        return true;
+    }
+
+    void submit(std::span<IoRead* const> _reads) override
+    {
+        for (IoRead* read : _reads)
+        {
+            const IoFile& file = *read->file;
+
+            if (!file.m_associated.exchange(true, std::memory_order_acq_rel))
+            {
+                ::CreateIoCompletionPort(file.m_handle, m_port, 0, 0);
+            }
+
+            auto* overlapped = new Overlapped();
+            overlapped->overlapped.Offset = static_cast<DWORD>(read->nextOffset());
+            overlapped->overlapped.OffsetHigh = static_cast<DWORD>(read->nextOffset() >> 32);
+            overlapped->read = read;
+
+            if (::ReadFile(file.m_handle, read->next(), static_cast<DWORD>(read->nextSize()),
+                           nullptr, &overlapped->overlapped))
+            {
+                continue;
+            }
+
+            const DWORD error = ::GetLastError();
+            if (error == ERROR_IO_PENDING) continue;
+
+            // failed at once, nothing is posted
+            delete overlapped;
+
+            const int64_t result = error == ERROR_HANDLE_EOF ? 0 : -static_cast<int64_t>(error);
+            (void)m_queue.advance(read, result);
+        }
+    }
+
+    void stop() override
+    {
+        if (!m_thread.joinable()) return;
+
+        // the thread leaves once it reaped the wake-up and nothing is in flight
+        ::PostQueuedCompletionStatus(m_port, 0, k_wakeKey, nullptr);
+
+        m_thread.join();
+    }
+
+    IoBackendType getType() const noexcept override { return IoBackendType::iocp; }
+
+   private:
+    void reap()
+    {
+        bool woken = false;
+
+        while (!woken || m_queue.getInFlightCount() > 0)
+        {
+            DWORD bytes = 0;
+            ULONG_PTR key = 0;
+            OVERLAPPED* completed = nullptr;
+
+            const BOOL done =
+                ::GetQueuedCompletionStatus(m_port, &bytes, &key, &completed, INFINITE);
+
+            if (!completed)
+            {
+                // the wake-up, or the port closed under the thread
+                if (key == k_wakeKey || !done) woken = true;
+                continue;
+            }
+
+            MOSAIC_TRACE_SITE_SCOPE("IoService::reap", tools::TraceCategory::io);
+
+            auto* overlapped = reinterpret_cast<Overlapped*>(completed);
+            IoRead* read = overlapped->read;
+            delete overlapped;
+
+            int64_t result = static_cast<int64_t>(bytes);
+            if (!done)
+            {
+                const DWORD error = ::GetLastError();
+                result = error == ERROR_HANDLE_EOF ? 0 : -static_cast<int64_t>(error);
+            }
+
+            // the rest of a short read, in the slot it holds
+            if (m_queue.advance(read, result)) submit(std::span(&read, 1));
+
+            pump();
+        }
+    }
+};
+
+std::unique_ptr<IoBackend> createIocpBackend(IoQueue& _queue, std::string& _error)
+{
+    auto backend = std::make_unique<IocpBackend>(_queue);
+    if (!backend->start(_error)) return nullptr;
+
+    return backend;
+}
+
+} // namespace detail
+} // namespace exec
+} // namespace mosaic
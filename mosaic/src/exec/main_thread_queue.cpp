@@ -0,0 +1,129 @@
+#include "mosaic/exec/main_thread_queue.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <concurrentqueue/moodycamel/concurrentqueue.h>
+
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace exec
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// MainThreadQueue::Impl
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct MainThreadQueue::Impl
+{
+    static constexpr size_t k_maxPopCount = 32;
+
+    moodycamel::ConcurrentQueue<MoveOnlyTask<void()>> tasks;
+
+    // Only touched by the draining thread: the tasks popped last, run from `next` on, so that a
+    // drain out of budget leaves the rest to the next one in order
+    std::vector<MoveOnlyTask<void()>> popped;
+    size_t next = 0;
+
+    std::thread::id owner = std::this_thread::get_id();
+
+    [[nodiscard]] size_t poppedLeft() const noexcept { return popped.size() - next; }
+
+    bool pop(size_t _maxCount)
+    {
+        popped.clear();
+        next = 0;
+
+        popped.resize(std::min(_maxCount, k_maxPopCount));
+        popped.resize(tasks.try_dequeue_bulk(popped.begin(), popped.size()));
+
+        return !popped.empty();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// MainThreadQueue
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+MainThreadQueue* MainThreadQueue::g_instance = nullptr;
+
+MainThreadQueue::MainThreadQueue() : m_impl(new Impl())
+{
+    if (!g_instance) g_instance = this;
+}
+
+MainThreadQueue::~MainThreadQueue()
+{
+    if (g_instance == this) g_instance = nullptr;
+
+    // the tasks never drained break their promises
+    delete m_impl;
+}
+
+void MainThreadQueue::post(MoveOnlyTask<void()> _task) noexcept
+{
+    m_impl->tasks.enqueue(std::move(_task));
+}
+
+size_t MainThreadQueue::drain() noexcept
+{
+    return run(getPendingCount(), std::chrono::steady_clock::time_point::max());
+}
+
+size_t MainThreadQueue::drainFor(std::chrono::microseconds _budget) noexcept
+{
+    return run(getPendingCount(), std::chrono::steady_clock::now() + _budget);
+}
+
+size_t MainThreadQueue::getPendingCount() const noexcept
+{
+    return m_impl->tasks.size_approx() + m_impl->poppedLeft();
+}
+
+size_t MainThreadQueue::run(size_t _maxCount,
+                            std::chrono::steady_clock::time_point _deadline) noexcept
+{
+    assert(std::this_thread::get_id() == m_impl->owner &&
+           "MainThreadQueue drained off the thread that created it!");
+
+    const bool budgeted = _deadline != std::chrono::steady_clock::time_point::max();
+
+    size_t ran = 0;
+
+    while (ran < _maxCount)
+    {
+        if (m_impl->poppedLeft() == 0 && !m_impl->pop(_maxCount - ran)) break;
+
+        // moved out first, a task may drain the queue itself
+        MoveOnlyTask<void()> task = std::move(m_impl->popped[m_impl->next++]);
+
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            MOSAIC_ERROR("Main thread: task threw std::exception: {}", e.what());
+        }
+        catch (...)
+        {
+            MOSAIC_ERROR("Main thread: task threw unknown exception.");
+        }
+
+        ran++;
+
+        if (budgeted && std::chrono::steady_clock::now() >= _deadline) break;
+    }
+
+    return ran;
+}
+
+} // namespace exec
+} // namespace mosaic
@@ -0,0 +1,126 @@
+#include "mosaic/exec/render_thread.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+namespace mosaic
+{
+namespace exec
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderThread::Impl
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct RenderThread::Impl
+{
+    // once a frame: a condition variable rather than a spinning hand-off
+    mutable std::mutex mutex;
+    std::condition_variable_any handed;
+    std::condition_variable done;
+
+    MoveOnlyTask<void()> frame;
+    bool busy = false;
+    std::exception_ptr error;
+
+    std::jthread thread;
+
+    void run(std::stop_token _stop)
+    {
+        while (true)
+        {
+            MoveOnlyTask<void()> next;
+
+            {
+                std::unique_lock lock(mutex);
+                if (!handed.wait(lock, _stop, [this] { return busy; })) return;
+
+                next = std::move(frame);
+            }
+
+            std::exception_ptr thrown;
+
+            try
+            {
+                next();
+            }
+            catch (...)
+            {
+                thrown = std::current_exception();
+            }
+
+            // the captures of the frame are released before the caller goes on
+            next = nullptr;
+
+            {
+                std::lock_guard lock(mutex);
+                error = std::move(thrown);
+                busy = false;
+            }
+
+            done.notify_all();
+        }
+    }
+
+    void rethrow(std::unique_lock<std::mutex>& _lock)
+    {
+        done.wait(_lock, [this] { return !busy; });
+
+        if (error) std::rethrow_exception(std::exchange(error, nullptr));
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderThread
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RenderThread::RenderThread() : m_impl(new Impl())
+{
+    m_impl->thread = std::jthread([this](std::stop_token _stop) { m_impl->run(_stop); });
+}
+
+RenderThread::~RenderThread()
+{
+    {
+        std::unique_lock lock(m_impl->mutex);
+        m_impl->done.wait(lock, [this] { return !m_impl->busy; });
+    }
+
+    // requesting the stop wakes the thread up
+    m_impl->thread.request_stop();
+    m_impl->thread.join();
+
+    delete m_impl;
+}
+
+void RenderThread::kick(MoveOnlyTask<void()> _frame)
+{
+    {
+        std::unique_lock lock(m_impl->mutex);
+        m_impl->rethrow(lock);
+
+        m_impl->frame = std::move(_frame);
+        m_impl->busy = true;
+    }
+
+    m_impl->handed.notify_one();
+}
+
+void RenderThread::wait()
+{
+    std::unique_lock lock(m_impl->mutex);
+    m_impl->rethrow(lock);
+}
+
+bool RenderThread::isBusy() const noexcept
+{
+    std::lock_guard lock(m_impl->mutex);
+    return m_impl->busy;
+}
+
+} // namespace exec
+} // namespace mosaic
@@ -1,15 +1,34 @@
 #include "mosaic/exec/thread_pool.hpp"
-
+#include "mosaic/exec/scratch_arena.hpp"
+#include "mosaic/exec/work_stealing_deque.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
 #include <string>
+#include <tuple>
 #include <thread>
 #include <vector>
 #include <random>
 #include <chrono>
 #include <cassert>
 #include <condition_variable>
+#include <memory>
+#include <utility>
 
 #ifdef MOSAIC_PLATFORM_WINDOWS
 #include <windows.h>
+#elif defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+#include <sched.h>
+#endif
+
+#if defined(MOSAIC_COMPILER_MSVC) && (defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86))
+#include <intrin.h>
 #endif
 
 #include <concurrentqueue/moodycamel/concurrentqueue.h>
@@ -29,20 +48,178 @@ struct ThreadPool::Impl
 
     // fixed after initialization (no need for atomic)
     uint32_t workersCount = 0;
+    bool hybrid = false; // some workers sit on efficiency cores
 
-    moodycamel::ConcurrentQueue<MoveOnlyTask<void()>> globalTaskQueue;
+    // One global queue per priority
+    std::array<moodycamel::ConcurrentQueue<MoveOnlyTask<void()>>, k_taskPriorityCount>
+        globalTaskQueues;
     std::vector<std::unique_ptr<ThreadWorker>> workers;
 
     // Aligned to 64 bytes boundaries to avoid false sharing
     alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<uint32_t> idleWorkersCount;
     alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<bool> stop;
 
+    // The idle policy, in microseconds, read by every worker going idle
+    std::atomic<int64_t> spinMicroseconds;
+    std::atomic<int64_t> yieldMicroseconds;
+    std::atomic<int64_t> parkTimeoutMicroseconds;
+
+    // The worker receiving the first block of the next bulk submission, rotating between calls
+    std::atomic<uint32_t> bulkCursor{0};
+
+    // The workers past it are suspended: they run their own queues only, see setActiveWorkersCount
+    std::atomic<uint32_t> activeWorkersCount{std::numeric_limits<uint32_t>::max()};
+
+    std::atomic<PoolTelemetry> telemetry{PoolTelemetry::none};
+
+    [[nodiscard]] moodycamel::ConcurrentQueue<MoveOnlyTask<void()>>& globalQueue(
+        TaskPriority _priority) noexcept
+    {
+        return globalTaskQueues[static_cast<size_t>(_priority)];
+    }
+
+    [[nodiscard]] IdlePolicy idlePolicy() const noexcept
+    {
+        return {std::chrono::microseconds(spinMicroseconds.load(std::memory_order_relaxed)),
+                std::chrono::microseconds(yieldMicroseconds.load(std::memory_order_relaxed)),
+                std::chrono::microseconds(parkTimeoutMicroseconds.load(std::memory_order_relaxed))};
+    }
+
     Impl();
+
+    // Wakes the global consumers accepting the priority, after an enqueue to its global queue.
+    void notifyGlobalConsumers(TaskPriority _priority) noexcept;
+
+    // Wraps the task to record its queue wait while timings are enabled, at submission.
+    [[nodiscard]] MoveOnlyTask<void()> stamp(MoveOnlyTask<void()> _task) const noexcept;
     ~Impl();
 };
 
 bool ThreadPool::Impl::s_created = false;
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram - Log-linear buckets of nanosecond timings
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// HDR-style: values below 8 have a bucket each, then every power of two is split in 8 buckets
+// (3 significant bits). Written by its worker only, read by any thread.
+class LatencyHistogram
+{
+   public:
+    static constexpr uint32_t k_subBucketBits = 3;
+    static constexpr uint64_t k_subBuckets = uint64_t{1} << k_subBucketBits;
+    static constexpr uint32_t k_maxExponent = 40; // about 18 minutes, longer timings are clamped
+    static constexpr size_t k_bucketCount = (k_maxExponent - k_subBucketBits + 2) * k_subBuckets;
+
+    using Counts = std::array<uint64_t, k_bucketCount>;
+
+   private:
+    std::array<std::atomic<uint64_t>, k_bucketCount> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_max{0};
+
+   public:
+    // The single writer needs no read-modify-write, only loads and stores that readers see whole.
+    void record(uint64_t _nanoseconds) noexcept
+    {
+        increment(m_buckets[bucketOf(_nanoseconds)]);
+        increment(m_count);
+
+        if (_nanoseconds > m_max.load(std::memory_order_relaxed))
+        {
+            m_max.store(_nanoseconds, std::memory_order_relaxed);
+        }
+    }
+
+    void reset() noexcept
+    {
+        for (auto& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+
+        m_count.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    // Adds the buckets to the counts, returns the maximum.
+    uint64_t addTo(Counts& _counts) const noexcept
+    {
+        for (size_t i = 0; i < k_bucketCount; ++i)
+        {
+            _counts[i] += m_buckets[i].load(std::memory_order_relaxed);
+        }
+
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] LatencyPercentiles percentiles() const noexcept
+    {
+        Counts counts{};
+        const uint64_t max = addTo(counts);
+
+        return percentiles(counts, max);
+    }
+
+    // The counts are summed again rather than taken from m_count, a reader may see the buckets
+    // and the count of different tasks.
+    [[nodiscard]] static LatencyPercentiles percentiles(const Counts& _counts,
+                                                        uint64_t _max) noexcept
+    {
+        LatencyPercentiles result{};
+
+        for (uint64_t count : _counts) result.count += count;
+        if (result.count == 0) return result;
+
+        result.max = _max;
+        result.p50 = std::min(valueAt(_counts, result.count, 0.50), _max);
+        result.p90 = std::min(valueAt(_counts, result.count, 0.90), _max);
+        result.p99 = std::min(valueAt(_counts, result.count, 0.99), _max);
+
+        return result;
+    }
+
+   private:
+    static void increment(std::atomic<uint64_t>& _counter) noexcept
+    {
+        _counter.store(_counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static size_t bucketOf(uint64_t _value) noexcept
+    {
+        if (_value < k_subBuckets) return static_cast<size_t>(_value);
+
+        const uint64_t clamped = std::min(_value, (uint64_t{2} << k_maxExponent) - 1);
+        const uint32_t exponent = static_cast<uint32_t>(std::bit_width(clamped)) - 1;
+        const uint64_t subBucket = (clamped >> (exponent - k_subBucketBits)) & (k_subBuckets - 1);
+
+        return static_cast<size_t>((exponent - k_subBucketBits + 1) * k_subBuckets + subBucket);
+    }
+
+    static uint64_t upperBoundOf(size_t _bucket) noexcept
+    {
+        if (_bucket < k_subBuckets) return _bucket;
+
+        const auto exponent =
+            static_cast<uint32_t>(_bucket / k_subBuckets) + k_subBucketBits - 1;
+        const uint64_t width = uint64_t{1} << (exponent - k_subBucketBits);
+        const uint64_t lower = (k_subBuckets + _bucket % k_subBuckets) * width;
+
+        return lower + width - 1;
+    }
+
+    static uint64_t valueAt(const Counts& _counts, uint64_t _total, double _quantile) noexcept
+    {
+        const auto rank = static_cast<uint64_t>(std::ceil(_quantile * static_cast<double>(_total)));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < k_bucketCount; ++i)
+        {
+            seen += _counts[i];
+            if (seen >= rank) return upperBoundOf(i);
+        }
+
+        return upperBoundOf(k_bucketCount - 1);
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // WorkerStats - Cache-line aligned per-worker statistics
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -53,6 +230,11 @@ struct alignas(MOSAIC_CACHE_LINE_SIZE) WorkerStats
     std::atomic<uint64_t> tasksStolen{0};
     std::atomic<uint64_t> stealAttempts{0};
     std::atomic<uint64_t> tasksReceivedFromGlobal{0};
+    std::atomic<uint64_t> idleNanoseconds{0};
+
+    // Recorded with PoolTelemetry::timings only
+    LatencyHistogram queueWait;
+    LatencyHistogram execution;
 
     void reset() noexcept
     {
@@ -60,99 +242,453 @@ struct alignas(MOSAIC_CACHE_LINE_SIZE) WorkerStats
         tasksStolen.store(0, std::memory_order_relaxed);
         stealAttempts.store(0, std::memory_order_relaxed);
         tasksReceivedFromGlobal.store(0, std::memory_order_relaxed);
+        idleNanoseconds.store(0, std::memory_order_relaxed);
+        queueWait.reset();
+        execution.reset();
     }
 };
 
+// Nanoseconds between two points of the steady clock
+static inline uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point _from,
+                                          std::chrono::steady_clock::time_point _to) noexcept
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(_to - _from).count());
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // ThreadWorker
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-constexpr auto k_idleTimeout = std::chrono::milliseconds(1);
+constexpr int k_pausesPerSpin = 16;
 constexpr size_t k_stealBatchSize = 8;
 constexpr size_t k_maxPopCountFromGlobal = 16;
 
+class ThreadWorker;
+
+// A task a worker enqueued itself, in a heap slot of its deque
+struct LocalTask
+{
+    MoveOnlyTask<void()> task;
+    TaskPriority priority;
+};
+
+// Recycles the heap slots of the tasks pushed to the work-stealing deques
+using TaskSlotCache = detail::BlockCache<sizeof(LocalTask), alignof(LocalTask)>;
+
+// Hints the core that the thread is spinning (lets the sibling hyperthread run, saves power).
+static inline void cpuRelax() noexcept
+{
+#if defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_X86)
+#if defined(MOSAIC_COMPILER_MSVC)
+    _mm_pause();
+#else
+    __builtin_ia32_pause();
+#endif
+#elif defined(MOSAIC_ARCH_ARM64) || defined(MOSAIC_ARCH_ARM32)
+#if defined(MOSAIC_COMPILER_MSVC)
+    __yield();
+#else
+    __asm__ __volatile__("yield");
+#endif
+#endif
+}
+
+// Pins the calling thread to a logical processor. Like setWorkerAffinity(), a processor outside
+// of the process' affinity mask is ignored and the thread keeps running anywhere.
+static void pinCurrentThread(uint32_t _processor) noexcept
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    GROUP_AFFINITY affinity{};
+    affinity.Group = static_cast<WORD>(_processor / 64);
+    affinity.Mask = KAFFINITY{1} << (_processor % 64);
+
+    SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+#elif defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+    if (_processor >= CPU_SETSIZE) return;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(_processor, &cpuset);
+
+    // 0 is the calling thread, unlike pthread_setaffinity_np() this is available on Android
+    sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
+#else
+    (void)_processor;
+#endif
+}
+
+// The worker running on this thread, nullptr off the pools' threads
+static thread_local ThreadWorker* t_currentWorker = nullptr;
+
 class ThreadWorker final
 {
    private:
+    using TaskQueue = moodycamel::ConcurrentQueue<MoveOnlyTask<void()>>;
+
     ThreadPool::Impl* m_pool = nullptr;
 
     std::condition_variable m_cv;
     std::mutex m_cvMutex;
 
+    // Set while the worker sleeps on m_cv, notify() only takes the mutex then
+    std::atomic<bool> m_parked{false};
+
+    // The priority of the task running on the worker, only touched by its thread
+    TaskPriority m_currentPriority = TaskPriority::normal;
+
    public:
     uint32_t m_idx;
     size_t m_tid;
 
     std::string m_debugName;
-    WorkerSharingMode m_sharingMode;
+    std::atomic<WorkerSharingMode> m_sharingMode; // changed at runtime by setWorkerSharingMode()
 
     std::jthread m_thread;
 
-    moodycamel::ConcurrentQueue<MoveOnlyTask<void()>> m_taskQueue;
+    // Tasks submitted by any thread, one queue per priority
+    std::array<TaskQueue, k_taskPriorityCount> m_taskQueues;
+
+    // Critical and normal tasks the worker enqueued itself in lifo_local mode: popped newest first
+    // by the worker, stolen oldest first by the others
+    WorkStealingDeque<LocalTask*> m_deque;
+
+    // Set by notify(), wakes the worker up to steal even though none of its queues has work
+    std::atomic<bool> m_notified{false};
+
+    // Read by the assignment of critical and normal tasks, which avoids these workers
+    std::atomic<bool> m_runningBackground{false};
 
     WorkerStats m_stats;
 
+    // Fixed after initialization, read by getWorkerPlacement()
+    WorkerPlacement m_placement;
+
+    // Temporaries of the running task (see currentScratch()), only touched by the worker's thread
+    ScratchArena m_scratch;
+
+   private:
+    // The other workers in stealing order: the same cache group, the same NUMA node, then the
+    // others. Only touched by the worker's thread once it started.
+    std::vector<uint32_t> m_victims;
+    size_t m_cacheGroupVictims = 0; // end of the cache group tier in m_victims
+    size_t m_numaNodeVictims = 0;   // end of the NUMA node tier in m_victims
+    size_t m_nextVictim = 0;        // rotates the start of every tier
+
+    bool m_namedInTrace = false; // the thread_name metadata was emitted, only touched by its thread
+
    public:
     explicit ThreadWorker(uint32_t _idx, const std::string& _debugName, ThreadPool::Impl* _pool,
-                          WorkerSharingMode _sharingMode = worker_sharing_presets::shared)
+                          WorkerSharingMode _sharingMode = worker_sharing_presets::shared,
+                          const WorkerPlacement& _placement = {})
         : m_pool(_pool),
           m_idx(_idx),
           m_debugName(_debugName),
           m_sharingMode(_sharingMode),
-          m_tid(0) {};
+          m_tid(0),
+          m_placement(_placement) {};
+
+    ~ThreadWorker()
+    {
+        // the thread is joined, the deque can be drained from here
+        MoveOnlyTask<void()> task;
+        TaskPriority priority;
+        while (tryPopDeque(task, priority)) task = nullptr;
+    }
 
     void operator()()
     {
         auto& impl = *m_pool;
 
         m_tid = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        t_currentWorker = this;
+
+        pinCurrentThread(m_placement.processor);
 
         MoveOnlyTask<void()> task;
+        TaskPriority priority;
+
+        bool idle = false;
+        std::chrono::steady_clock::time_point idleSince;
 
         while (!impl.stop.load(std::memory_order_acquire))
         {
-            if (tryPopLocal(task) || tryPopGlobal(task) || tryStealing(task))
+            if (findTask(task, priority, TaskPriority::background))
             {
-                executeTask(task);
+                if (idle)
+                {
+                    impl.idleWorkersCount.fetch_sub(1, std::memory_order_release);
+
+                    const uint64_t idleTime =
+                        elapsedNanoseconds(idleSince, std::chrono::steady_clock::now());
+                    m_stats.idleNanoseconds.fetch_add(idleTime, std::memory_order_relaxed);
+                }
+
+                idle = false;
+
+                executeTask(task, priority);
                 continue;
             }
 
-            waitForWork();
+            if (!idle)
+            {
+                impl.idleWorkersCount.fetch_add(1, std::memory_order_release);
+                idle = true;
+                idleSince = std::chrono::steady_clock::now();
+            }
+
+            waitForWork(std::chrono::steady_clock::now() - idleSince);
+        }
+
+        if (idle) impl.idleWorkersCount.fetch_sub(1, std::memory_order_release);
+    }
+
+    void notify()
+    {
+        // seq_cst with park(): either the worker sees the flag, or this sees it parked
+        m_notified.store(true, std::memory_order_seq_cst);
+
+        if (m_parked.load(std::memory_order_seq_cst))
+        {
+            std::lock_guard lock(m_cvMutex);
+            m_cv.notify_one();
         }
     }
 
-    void notify() { m_cv.notify_one(); }
+    // Whether the pool may hand the worker tasks of the priority (its own queues always run).
+    [[nodiscard]] bool accepts(TaskPriority _priority) const noexcept
+    {
+        if (m_idx >= m_pool->activeWorkersCount.load(std::memory_order_relaxed)) return false;
+
+        return _priority == TaskPriority::background
+                   ? mosaic::utils::hasFlag(sharingMode(), WorkerSharingMode::accept_background)
+                   : !mosaic::utils::hasFlag(sharingMode(), WorkerSharingMode::background_only);
+    }
+
+    [[nodiscard]] TaskPriority currentPriority() const noexcept { return m_currentPriority; }
+
+    // Orders the other workers by proximity, once every worker of the pool is set up.
+    void orderVictims()
+    {
+        const auto& workers = m_pool->workers;
+
+        auto tier = [&](uint32_t _idx)
+        {
+            const WorkerPlacement& other = workers[_idx]->m_placement;
 
-    [[nodiscard]] size_t getTasksCount() const noexcept { return m_taskQueue.size_approx(); }
+            if (other.cacheGroup == m_placement.cacheGroup) return 0;
+            return other.numaNode == m_placement.numaNode ? 1 : 2;
+        };
+
+        m_victims.clear();
+        for (uint32_t i = 0; i < workers.size(); ++i)
+        {
+            if (i != m_idx) m_victims.push_back(i);
+        }
+
+        std::ranges::stable_sort(m_victims, {}, tier);
+
+        auto tierEnd = [&](int _tier)
+        {
+            const auto end = std::ranges::partition_point(
+                m_victims, [&](uint32_t _idx) { return tier(_idx) <= _tier; });
+
+            return static_cast<size_t>(end - m_victims.begin());
+        };
+
+        m_cacheGroupVictims = tierEnd(0);
+        m_numaNodeVictims = tierEnd(1);
+    }
+
+    [[nodiscard]] WorkerSharingMode sharingMode() const noexcept
+    {
+        return m_sharingMode.load(std::memory_order_relaxed);
+    }
+
+    // Pushes a task the worker enqueues from its own thread, to the deque in lifo_local mode.
+    void pushLocal(MoveOnlyTask<void()> _task, TaskPriority _priority)
+    {
+        if (_priority == TaskPriority::background ||
+            !mosaic::utils::hasFlag(sharingMode(), WorkerSharingMode::lifo_local))
+        {
+            queue(_priority).enqueue(std::move(_task));
+            return;
+        }
+
+        m_deque.push(::new (TaskSlotCache::allocate()) LocalTask{std::move(_task), _priority});
+    }
+
+    // Steals a critical task, then the oldest task of the deque, then a normal task (from any
+    // thread that is not a worker, which never helps with background tasks).
+    bool trySteal(MoveOnlyTask<void()>& _outTask) noexcept
+    {
+        TaskPriority priority;
+
+        return queue(TaskPriority::critical).try_dequeue(_outTask) ||
+               tryStealDeque(_outTask, priority) ||
+               queue(TaskPriority::normal).try_dequeue(_outTask);
+    }
+
+    // Runs one task the worker would pick up next, from a task it is currently blocked in. Tasks
+    // of a lower priority than the blocked one are left alone.
+    bool tryExecuteOne() noexcept
+    {
+        MoveOnlyTask<void()> task;
+        TaskPriority priority;
+
+        if (!findTask(task, priority, m_currentPriority)) return false;
+
+        executeTask(task, priority);
+        return true;
+    }
+
+    [[nodiscard]] bool belongsTo(const ThreadPool::Impl* _pool) const noexcept
+    {
+        return m_pool == _pool;
+    }
+
+    [[nodiscard]] TaskQueue& queue(TaskPriority _priority) noexcept
+    {
+        return m_taskQueues[static_cast<size_t>(_priority)];
+    }
+
+    [[nodiscard]] size_t getTasksCount() const noexcept
+    {
+        size_t count = m_deque.size();
+        for (const TaskQueue& taskQueue : m_taskQueues) count += taskQueue.size_approx();
+
+        return count;
+    }
 
    private:
-    void waitForWork()
+    /**
+     * @brief Finds the next task to run, by priority: for each priority down to the lowest one
+     * requested, the worker's own queues, then the global queue, then the other workers' queues.
+     *
+     * The deque holds the worker's critical and normal children: it is popped after every
+     * critical task is taken, so frame-critical work waiting anywhere in the pool comes first.
+     */
+    bool findTask(MoveOnlyTask<void()>& _outTask, TaskPriority& _outPriority,
+                  TaskPriority _lowest) noexcept
+    {
+        bool stealAttempted = false;
+
+        auto fromPool = [&](TaskPriority _priority)
+        {
+            if (!accepts(_priority)) return false;
+            if (tryPopGlobal(_priority, _outTask)) return true;
+
+            if (!stealAttempted) m_stats.stealAttempts.fetch_add(1, std::memory_order_relaxed);
+            stealAttempted = true;
+
+            return tryStealing(_priority, _outTask, _outPriority);
+        };
+
+        for (uint8_t level = 0; level <= static_cast<uint8_t>(_lowest); ++level)
+        {
+            const TaskPriority priority = static_cast<TaskPriority>(level);
+            _outPriority = priority;
+
+            if (priority == TaskPriority::normal && tryPopDeque(_outTask, _outPriority))
+            {
+                return true;
+            }
+
+            if (queue(priority).try_dequeue(_outTask) || fromPool(priority)) return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Waits between two attempts at finding work, following the idle policy of the pool:
+     * a few CPU pauses while the worker has been idle for less than the spin duration, a yield of
+     * the time slice during the yield duration, then parking until notified or the park timeout.
+     */
+    void waitForWork(std::chrono::steady_clock::duration _idleFor)
+    {
+        const IdlePolicy policy = m_pool->idlePolicy();
+
+        if (_idleFor < policy.spinDuration)
+        {
+            for (int i = 0; i < k_pausesPerSpin; ++i) cpuRelax();
+        }
+        else if (_idleFor < policy.spinDuration + policy.yieldDuration)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            park(policy.parkTimeout);
+        }
+    }
+
+    void park(std::chrono::microseconds _timeout)
     {
         auto& impl = *m_pool;
 
         std::unique_lock lock(m_cvMutex);
+        m_parked.store(true, std::memory_order_seq_cst);
 
-        impl.idleWorkersCount.fetch_add(1, std::memory_order_release);
-
-        m_cv.wait_for(lock, k_idleTimeout,
+        // woken up by a notification, or by the timeout to look for work to steal again
+        m_cv.wait_for(lock, _timeout,
                       [&]
                       {
                           return impl.stop.load(std::memory_order_acquire) ||
-                                 m_taskQueue.size_approx() > 0 ||
-                                 impl.globalTaskQueue.size_approx() > 0;
+                                 m_notified.exchange(false, std::memory_order_seq_cst) ||
+                                 hasQueuedWork();
                       });
 
-        impl.idleWorkersCount.fetch_sub(1, std::memory_order_release);
+        m_parked.store(false, std::memory_order_relaxed);
     }
 
-    bool tryPopLocal(MoveOnlyTask<void()>& _outTask) noexcept
+    [[nodiscard]] bool hasQueuedWork() const noexcept
     {
-        return m_taskQueue.try_dequeue(_outTask);
+        for (size_t i = 0; i < k_taskPriorityCount; ++i)
+        {
+            if (m_taskQueues[i].size_approx() > 0) return true;
+
+            if (accepts(static_cast<TaskPriority>(i)) &&
+                m_pool->globalTaskQueues[i].size_approx() > 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
     }
 
-    bool tryPopGlobal(MoveOnlyTask<void()>& _outTask) noexcept
+    bool tryPopDeque(MoveOnlyTask<void()>& _outTask, TaskPriority& _outPriority) noexcept
     {
-        if (!mosaic::utils::hasFlag(m_sharingMode, WorkerSharingMode::global_consumer))
+        std::optional<LocalTask*> slot = m_deque.pop();
+        if (!slot) return false;
+
+        takeSlot(*slot, _outTask, _outPriority);
+        return true;
+    }
+
+    bool tryStealDeque(MoveOnlyTask<void()>& _outTask, TaskPriority& _outPriority) noexcept
+    {
+        std::optional<LocalTask*> slot = m_deque.steal();
+        if (!slot) return false;
+
+        takeSlot(*slot, _outTask, _outPriority);
+        return true;
+    }
+
+    static void takeSlot(LocalTask* _slot, MoveOnlyTask<void()>& _outTask,
+                         TaskPriority& _outPriority) noexcept
+    {
+        _outTask = std::move(_slot->task);
+        _outPriority = _slot->priority;
+
+        std::destroy_at(_slot);
+        TaskSlotCache::deallocate(_slot);
+    }
+
+    bool tryPopGlobal(TaskPriority _priority, MoveOnlyTask<void()>& _outTask) noexcept
+    {
+        if (!mosaic::utils::hasFlag(sharingMode(), WorkerSharingMode::global_consumer))
         {
             return false;
         }
@@ -160,7 +696,8 @@ class ThreadWorker final
         auto& impl = *m_pool;
 
         MoveOnlyTask<void()> tasks[k_maxPopCountFromGlobal];
-        const size_t count = impl.globalTaskQueue.try_dequeue_bulk(tasks, k_maxPopCountFromGlobal);
+        const size_t count =
+            impl.globalQueue(_priority).try_dequeue_bulk(tasks, k_maxPopCountFromGlobal);
 
         if (count == 0) return false;
 
@@ -168,63 +705,93 @@ class ThreadWorker final
 
         _outTask = std::move(tasks[0]);
 
-        for (size_t i = 1; i < count; ++i) m_taskQueue.enqueue(std::move(tasks[i]));
+        for (size_t i = 1; i < count; ++i) queue(_priority).enqueue(std::move(tasks[i]));
 
         return true;
     }
 
-    bool tryStealing(MoveOnlyTask<void()>& _outTask) noexcept
+    bool tryStealing(TaskPriority _priority, MoveOnlyTask<void()>& _outTask,
+                     TaskPriority& _outPriority) noexcept
     {
-        const auto& impl = *m_pool;
-        const auto& workers = impl.workers;
-        const uint32_t n = impl.workersCount;
-
-        if (n <= 1) return false;
+        if (m_victims.empty()) return false;
 
-        m_stats.stealAttempts.fetch_add(1, std::memory_order_relaxed);
+        const auto& workers = m_pool->workers;
+        const size_t tierEnds[] = {m_cacheGroupVictims, m_numaNodeVictims, m_victims.size()};
+        const size_t start = m_nextVictim++;
 
-        static thread_local uint32_t nextStart = 0;
-        const uint32_t start = nextStart;
-        nextStart = (nextStart + 1) % n;
-
-        const auto thisWorker = this;
-
-        for (uint32_t i = 0; i < n; ++i)
+        // nearest tier first, from a rotating start within each tier
+        size_t tierBegin = 0;
+        for (size_t tierEnd : tierEnds)
         {
-            const uint32_t victimIdx = (start + i) % n;
-            const auto victim = workers[victimIdx].get();
+            const size_t count = tierEnd - tierBegin;
 
-            if (victim == thisWorker) continue;
-            if (!mosaic::utils::hasFlag(victim->m_sharingMode, WorkerSharingMode::allow_steal))
+            for (size_t i = 0; i < count; ++i)
             {
-                continue;
-            }
-
-            MoveOnlyTask<void()> stolen[k_stealBatchSize];
-            size_t actualCount = victim->m_taskQueue.try_dequeue_bulk(stolen, k_stealBatchSize);
+                ThreadWorker* victim = workers[m_victims[tierBegin + (start + i) % count]].get();
 
-            if (actualCount == 0) continue;
+                if (stealFrom(victim, _priority, _outTask, _outPriority)) return true;
+            }
 
-            m_stats.tasksStolen.fetch_add(actualCount, std::memory_order_relaxed);
+            tierBegin = tierEnd;
+        }
 
-            _outTask = std::move(stolen[0]);
+        return false;
+    }
 
-            if (actualCount > 1)
-            {
-                for (size_t j = 1; j < actualCount; ++j)
-                {
-                    m_taskQueue.enqueue(std::move(stolen[j]));
-                }
-            }
+    bool stealFrom(ThreadWorker* _victim, TaskPriority _priority, MoveOnlyTask<void()>& _outTask,
+                   TaskPriority& _outPriority) noexcept
+    {
+        if (!mosaic::utils::hasFlag(_victim->sharingMode(), WorkerSharingMode::allow_steal))
+        {
+            return false;
+        }
 
+        // the oldest task of a deque is the largest piece of its owner's work (see parallelFor)
+        if (_priority == TaskPriority::normal && _victim->tryStealDeque(_outTask, _outPriority))
+        {
+            m_stats.tasksStolen.fetch_add(1, std::memory_order_relaxed);
             return true;
         }
 
-        return false;
+        MoveOnlyTask<void()> stolen[k_stealBatchSize];
+        const size_t actualCount =
+            _victim->queue(_priority).try_dequeue_bulk(stolen, k_stealBatchSize);
+
+        if (actualCount == 0) return false;
+
+        m_stats.tasksStolen.fetch_add(actualCount, std::memory_order_relaxed);
+
+        _outTask = std::move(stolen[0]);
+        _outPriority = _priority;
+
+        for (size_t j = 1; j < actualCount; ++j) queue(_priority).enqueue(std::move(stolen[j]));
+
+        return true;
     }
 
-    void executeTask(MoveOnlyTask<void()>& task) noexcept
+    void executeTask(MoveOnlyTask<void()>& task, TaskPriority _priority) noexcept
     {
+        // restored afterwards, the task may be run by a worker helping from another task
+        const TaskPriority previous = std::exchange(m_currentPriority, _priority);
+        const bool wasRunningBackground = m_runningBackground.load(std::memory_order_relaxed);
+        m_runningBackground.store(_priority == TaskPriority::background, std::memory_order_relaxed);
+
+        const PoolTelemetry telemetry = m_pool->telemetry.load(std::memory_order_relaxed);
+        const bool timed = mosaic::utils::hasFlag(telemetry, PoolTelemetry::timings);
+
+        tools::Tracer* tracer = mosaic::utils::hasFlag(telemetry, PoolTelemetry::tracing)
+                                    ? tools::Tracer::getInstance()
+                                    : nullptr;
+        if (tracer && !tracer->isEnabled()) tracer = nullptr;
+
+        if (tracer) beginTrace(*tracer, _priority);
+
+        const auto start = timed ? std::chrono::steady_clock::now()
+                                 : std::chrono::steady_clock::time_point{};
+
+        // the task only releases its own temporaries, it may run inside another one
+        const ScratchArena::Scope scratch(m_scratch);
+
         try
         {
             task();
@@ -238,17 +805,50 @@ class ThreadWorker final
             MOSAIC_ERROR("Worker {}: task threw unknown exception.", m_idx);
         }
 
+        if (timed)
+        {
+            m_stats.execution.record(elapsedNanoseconds(start, std::chrono::steady_clock::now()));
+        }
+
+        if (tracer) tracer->endTrace();
+
+        m_runningBackground.store(wasRunningBackground, std::memory_order_relaxed);
+        m_currentPriority = previous;
+
         m_stats.tasksExecuted.fetch_add(1, std::memory_order_relaxed);
 
         task = nullptr;
     }
+
+   private:
+    // Names the thread in the trace before its first task, the names of the events are static.
+    void beginTrace(tools::Tracer& _tracer, TaskPriority _priority) noexcept
+    {
+        static const std::array<std::string, k_taskPriorityCount> k_names = {
+            "ThreadPool task (critical)", "ThreadPool task (normal)",
+            "ThreadPool task (background)"};
+
+        if (!m_namedInTrace)
+        {
+            _tracer.metadataTrace("thread_name", m_debugName);
+            m_namedInTrace = true;
+        }
+
+        _tracer.beginTrace(k_names[static_cast<size_t>(_priority)], tools::TraceCategory::function);
+    }
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // ThreadPool::Impl (with complete type for ThreadWorker)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-ThreadPool::Impl::Impl() : workersCount(0), idleWorkersCount(0), stop(false)
+ThreadPool::Impl::Impl()
+    : workersCount(0),
+      idleWorkersCount(0),
+      stop(false),
+      spinMicroseconds(idle_policy_presets::platform_default.spinDuration.count()),
+      yieldMicroseconds(idle_policy_presets::platform_default.yieldDuration.count()),
+      parkTimeoutMicroseconds(idle_policy_presets::platform_default.parkTimeout.count())
 {
     assert(!s_created && "ThreadPool already exists!");
     s_created = true;
@@ -256,6 +856,38 @@ ThreadPool::Impl::Impl() : workersCount(0), idleWorkersCount(0), stop(false)
     stop.store(false, std::memory_order_relaxed);
 };
 
+MoveOnlyTask<void()> ThreadPool::Impl::stamp(MoveOnlyTask<void()> _task) const noexcept
+{
+    if (!mosaic::utils::hasFlag(telemetry.load(std::memory_order_relaxed), PoolTelemetry::timings))
+    {
+        return _task;
+    }
+
+    // recorded by the worker starting it, not by threads helping from outside the pool
+    return [enqueuedAt = std::chrono::steady_clock::now(), task = std::move(_task)]() mutable
+    {
+        if (ThreadWorker* worker = t_currentWorker)
+        {
+            worker->m_stats.queueWait.record(
+                elapsedNanoseconds(enqueuedAt, std::chrono::steady_clock::now()));
+        }
+
+        task();
+    };
+}
+
+void ThreadPool::Impl::notifyGlobalConsumers(TaskPriority _priority) noexcept
+{
+    for (auto& worker : workers)
+    {
+        if (mosaic::utils::hasFlag(worker->sharingMode(), WorkerSharingMode::global_consumer) &&
+            worker->accepts(_priority))
+        {
+            worker->notify();
+        }
+    }
+}
+
 ThreadPool::Impl::~Impl()
 {
     stop.store(true, std::memory_order_relaxed);
@@ -263,11 +895,83 @@ ThreadPool::Impl::~Impl()
     s_created = false;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Worker Placement
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<WorkerPlacement> planWorkerPlacement(const core::CPUInfo& _cpuInfo,
+                                                 uint32_t _workersCount)
+{
+    const std::vector<core::LogicalProcessorInfo>& processors = _cpuInfo.processors;
+    std::vector<WorkerPlacement> placements;
+
+    if (processors.empty() || _workersCount == 0) return placements;
+
+    uint8_t highestClass = 0;
+    for (const auto& processor : processors)
+    {
+        highestClass = std::max(highestClass, processor.efficiencyClass);
+    }
+
+    // rank of every processor among its SMT siblings, 0 for the first thread of its core
+    std::map<uint32_t, uint32_t> threadsOfCore;
+    std::vector<uint32_t> smtRank(processors.size());
+    for (size_t i = 0; i < processors.size(); ++i)
+    {
+        smtRank[i] = threadsOfCore[processors[i].coreId]++;
+    }
+
+    auto key = [&](size_t _i)
+    {
+        const auto& processor = processors[_i];
+
+        return std::tuple(smtRank[_i], highestClass - processor.efficiencyClass, processor.numaNode,
+                          processor.cacheGroup, processor.id);
+    };
+
+    std::vector<size_t> order(processors.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::ranges::sort(order, {}, key);
+
+    placements.reserve(_workersCount);
+
+    for (uint32_t i = 0; i < _workersCount; ++i)
+    {
+        // the first processor is left to the main thread
+        const auto& processor = processors[order[(i + 1) % order.size()]];
+
+        placements.push_back({processor.id, processor.cacheGroup, processor.numaNode,
+                              processor.efficiencyClass == highestClass});
+    }
+
+    return placements;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scratch Arenas
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ScratchArena& currentScratch() noexcept
+{
+    if (ThreadWorker* worker = t_currentWorker) return worker->m_scratch;
+
+    // created on first use, so threads that never ask for one pay nothing
+    thread_local ScratchArena arena;
+    return arena;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // ThreadPool
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#if defined(MOSAIC_PLATFORM_EMSCRIPTEN)
+// The workers are the web workers the page spawned before main() (-sPTHREAD_POOL_SIZE, from
+// navigator.hardwareConcurrency): one started past them waits for the main thread to yield to the
+// browser, which it does only between frames, so there are no more workers than cores
+constexpr auto k_minThreads = 1;
+#else
 constexpr auto k_minThreads = 5;
+#endif
 
 ThreadPool* ThreadPool::g_instance = nullptr;
 
@@ -289,16 +993,30 @@ ThreadPool::~ThreadPool()
 pieces::RefResult<ThreadPool, std::string> ThreadPool::initialize(
     const mosaic::core::CPUInfo& _cpuInfo) noexcept
 {
-    int logical = static_cast<int>(_cpuInfo.logicalCores);
+    // the topology, when there is one, lists the processors actually online
+    int logical = _cpuInfo.processors.empty() ? static_cast<int>(_cpuInfo.logicalCores)
+                                              : static_cast<int>(_cpuInfo.processors.size());
 
     // -1 to leave one thread for main flow
     uint32_t workersCount =
         static_cast<uint32_t>(std::max(logical - 1, static_cast<int>(k_minThreads)));
 
     m_impl->workersCount = workersCount;
+    m_impl->activeWorkersCount.store(workersCount, std::memory_order_relaxed);
     m_impl->workers.reserve(workersCount);
 
-    for (uint32_t i = 0; i < workersCount; ++i) setupWorker(i);
+    const std::vector<WorkerPlacement> placements = planWorkerPlacement(_cpuInfo, workersCount);
+
+    m_impl->hybrid = std::ranges::any_of(placements, [](const WorkerPlacement& _placement)
+                                         { return !_placement.performanceCore; });
+
+    for (uint32_t i = 0; i < workersCount; ++i)
+    {
+        // +1 to leave core 0 for main thread
+        setupWorker(i, placements.empty() ? WorkerPlacement{i + 1} : placements[i], m_impl->hybrid);
+    }
+
+    for (auto& worker : m_impl->workers) worker->orderVictims();
     for (uint32_t i = 0; i < workersCount; ++i) startupWorker(i);
 
     return pieces::OkRef<ThreadPool, std::string>(*this);
@@ -318,6 +1036,115 @@ void ThreadPool::shutdown() noexcept
     m_impl->workers.clear();
 }
 
+bool ThreadPool::enqueueToCurrentWorker(MoveOnlyTask<void()> _task) noexcept
+{
+    ThreadWorker* worker = t_currentWorker;
+
+    const TaskPriority priority = worker && worker->belongsTo(m_impl) ? worker->currentPriority()
+                                                                      : TaskPriority::normal;
+
+    return enqueueToCurrentWorker(std::move(_task), priority);
+}
+
+bool ThreadPool::enqueueToCurrentWorker(MoveOnlyTask<void()> _task, TaskPriority _priority) noexcept
+{
+    ThreadWorker* worker = t_currentWorker;
+
+    if (!worker || !worker->belongsTo(m_impl) ||
+        !mosaic::utils::hasFlag(worker->sharingMode(), WorkerSharingMode::accept_direct))
+    {
+        return assignTaskToWorker(std::move(_task), _priority);
+    }
+
+    if (m_impl->stop.load(std::memory_order_acquire))
+    {
+        MOSAIC_WARN("ThreadPool is shutting down, cannot assign new tasks.");
+        return false;
+    }
+
+    // the worker pops it once its current task returns, an idle worker is woken up to steal it
+    // in the meantime (otherwise it would only notice after its idle timeout)
+    worker->pushLocal(m_impl->stamp(std::move(_task)), _priority);
+
+    if (m_impl->idleWorkersCount.load(std::memory_order_acquire) == 0) return true;
+
+    ThreadWorker* otherWorker = getRandomWorker();
+    if (otherWorker == worker)
+    {
+        otherWorker = m_impl->workers[(worker->m_idx + 1) % m_impl->workersCount].get();
+    }
+
+    otherWorker->notify();
+
+    return true;
+}
+
+bool ThreadPool::requeueToCurrentWorker(MoveOnlyTask<void()> _task) noexcept
+{
+    ThreadWorker* worker = t_currentWorker;
+
+    if (!worker || !worker->belongsTo(m_impl) ||
+        !mosaic::utils::hasFlag(worker->sharingMode(), WorkerSharingMode::accept_direct))
+    {
+        return assignTaskToWorker(std::move(_task));
+    }
+
+    if (m_impl->stop.load(std::memory_order_acquire))
+    {
+        MOSAIC_WARN("ThreadPool is shutting down, cannot assign new tasks.");
+        return false;
+    }
+
+    // behind the deque and the tasks already queued, unlike enqueueToCurrentWorker()
+    worker->queue(worker->currentPriority()).enqueue(m_impl->stamp(std::move(_task)));
+
+    return true;
+}
+
+bool ThreadPool::tryExecutePendingTask() noexcept
+{
+    ThreadWorker* worker = t_currentWorker;
+
+    if (worker && worker->belongsTo(m_impl)) return worker->tryExecuteOne();
+
+    // like workers helping from a task, background tasks are left to the workers
+    MoveOnlyTask<void()> task;
+    bool found = m_impl->globalQueue(TaskPriority::critical).try_dequeue(task) ||
+                 m_impl->globalQueue(TaskPriority::normal).try_dequeue(task);
+
+    // workers are gone after shutdown()
+    const uint32_t n = static_cast<uint32_t>(m_impl->workers.size());
+    const ThreadWorker* first = n > 0 ? getRandomWorker() : nullptr;
+    const uint32_t start = first ? first->m_idx : 0;
+
+    for (uint32_t i = 0; i < n && !found; ++i)
+    {
+        ThreadWorker* victim = m_impl->workers[(start + i) % n].get();
+
+        if (mosaic::utils::hasFlag(victim->sharingMode(), WorkerSharingMode::allow_steal))
+        {
+            found = victim->trySteal(task);
+        }
+    }
+
+    if (!found) return false;
+
+    try
+    {
+        task();
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR("External thread: task threw std::exception: {}", e.what());
+    }
+    catch (...)
+    {
+        MOSAIC_ERROR("External thread: task threw unknown exception.");
+    }
+
+    return true;
+}
+
 void ThreadPool::setWorkerAffinity(uint32_t _workerId, size_t _cpuCoreId) noexcept
 {
     ThreadWorker* worker = getWorkerByIdx(_workerId);
@@ -356,7 +1183,7 @@ void ThreadPool::setWorkerSharingMode(uint32_t _workerId, WorkerSharingMode _sha
     static std::atomic<uint32_t> s_indirectAcceptingWorkers{0};
 
     bool currentlyAcceptsIndirect =
-        mosaic::utils::hasFlag(worker->m_sharingMode, WorkerSharingMode::accept_indirect);
+        mosaic::utils::hasFlag(worker->sharingMode(), WorkerSharingMode::accept_indirect);
     bool willAcceptIndirect =
         mosaic::utils::hasFlag(_sharingMode, WorkerSharingMode::accept_indirect);
 
@@ -378,7 +1205,7 @@ void ThreadPool::setWorkerSharingMode(uint32_t _workerId, WorkerSharingMode _sha
         return;
     }
 
-    worker->m_sharingMode = _sharingMode;
+    worker->m_sharingMode.store(_sharingMode, std::memory_order_relaxed);
 }
 
 bool ThreadPool::isRunning() const noexcept
@@ -388,6 +1215,39 @@ bool ThreadPool::isRunning() const noexcept
 
 uint32_t ThreadPool::getWorkersCount() const noexcept { return m_impl->workersCount; }
 
+void ThreadPool::setIdlePolicy(const IdlePolicy& _policy) noexcept
+{
+    m_impl->spinMicroseconds.store(_policy.spinDuration.count(), std::memory_order_relaxed);
+    m_impl->yieldMicroseconds.store(_policy.yieldDuration.count(), std::memory_order_relaxed);
+    m_impl->parkTimeoutMicroseconds.store(_policy.parkTimeout.count(), std::memory_order_relaxed);
+
+    // parked workers pick the new timeout up now rather than at their next timeout
+    for (auto& worker : m_impl->workers) worker->notify();
+}
+
+IdlePolicy ThreadPool::getIdlePolicy() const noexcept { return m_impl->idlePolicy(); }
+
+void ThreadPool::setActiveWorkersCount(uint32_t _count) noexcept
+{
+    const uint32_t count = std::clamp(_count, 1u, std::max(m_impl->workersCount, 1u));
+    const uint32_t previous = m_impl->activeWorkersCount.exchange(count, std::memory_order_relaxed);
+
+    // the resumed workers look at the global queues now rather than at their park timeout
+    if (count > previous)
+    {
+        for (uint32_t i = previous; i < count && i < m_impl->workersCount; ++i)
+        {
+            m_impl->workers[i]->notify();
+        }
+    }
+}
+
+uint32_t ThreadPool::getActiveWorkersCount() const noexcept
+{
+    return std::min(m_impl->activeWorkersCount.load(std::memory_order_relaxed),
+                    m_impl->workersCount);
+}
+
 uint32_t ThreadPool::getBusyWorkersCount() const noexcept
 {
     return m_impl->workersCount - m_impl->idleWorkersCount.load(std::memory_order_acquire);
@@ -415,13 +1275,32 @@ WorkerStatsSnapshot ThreadPool::getWorkerStats(uint32_t _workerIdx) const noexce
         stats.stealAttempts.load(std::memory_order_relaxed),
         stats.tasksReceivedFromGlobal.load(std::memory_order_relaxed),
         worker->getTasksCount(),
+        stats.idleNanoseconds.load(std::memory_order_relaxed),
+        stats.queueWait.percentiles(),
+        stats.execution.percentiles(),
     };
 }
 
+WorkerPlacement ThreadPool::getWorkerPlacement(uint32_t _workerIdx) const noexcept
+{
+    if (_workerIdx >= m_impl->workers.size())
+    {
+        MOSAIC_ERROR("ThreadWorker with id {} does not exist.", _workerIdx);
+        return {};
+    }
+
+    return m_impl->workers[_workerIdx]->m_placement;
+}
+
 PoolStatsSnapshot ThreadPool::getPoolStats() const noexcept
 {
     PoolStatsSnapshot result{};
 
+    LatencyHistogram::Counts queueWait{};
+    LatencyHistogram::Counts execution{};
+    uint64_t maxQueueWait = 0;
+    uint64_t maxExecution = 0;
+
     for (uint32_t i = 0; i < m_impl->workersCount; ++i)
     {
         const auto& worker = m_impl->workers[i];
@@ -433,8 +1312,15 @@ PoolStatsSnapshot ThreadPool::getPoolStats() const noexcept
         result.totalTasksReceivedFromGlobal +=
             stats.tasksReceivedFromGlobal.load(std::memory_order_relaxed);
         result.totalQueuedTasks += worker->getTasksCount();
+        result.totalIdleNanoseconds += stats.idleNanoseconds.load(std::memory_order_relaxed);
+
+        maxQueueWait = std::max(maxQueueWait, stats.queueWait.addTo(queueWait));
+        maxExecution = std::max(maxExecution, stats.execution.addTo(execution));
     }
 
+    result.queueWait = LatencyHistogram::percentiles(queueWait, maxQueueWait);
+    result.execution = LatencyHistogram::percentiles(execution, maxExecution);
+
     return result;
 }
 
@@ -446,6 +1332,16 @@ void ThreadPool::resetStats() noexcept
     }
 }
 
+void ThreadPool::setTelemetry(PoolTelemetry _telemetry) noexcept
+{
+    m_impl->telemetry.store(_telemetry, std::memory_order_relaxed);
+}
+
+PoolTelemetry ThreadPool::getTelemetry() const noexcept
+{
+    return m_impl->telemetry.load(std::memory_order_relaxed);
+}
+
 ThreadWorker* ThreadPool::getRandomWorker() const noexcept
 {
     if (m_impl->workers.empty()) return nullptr;
@@ -484,23 +1380,41 @@ ThreadWorker* ThreadPool::getWorkerByDebugName(const std::string& _debugName) co
     return nullptr;
 }
 
-void ThreadPool::setupWorker(uint32_t _idx)
+void ThreadPool::setupWorker(uint32_t _idx, const WorkerPlacement& _placement, bool _hybrid)
 {
     std::string workerDebugName = "ThreadWorker-" + std::to_string(_idx);
 
-    m_impl->workers.emplace_back(std::make_unique<ThreadWorker>(_idx, workerDebugName, m_impl));
+    // on hybrid CPUs, background tasks are left to the efficiency cores
+    const WorkerSharingMode sharingMode = _hybrid && _placement.performanceCore
+                                              ? worker_sharing_presets::frame_lane
+                                              : worker_sharing_presets::shared;
+
+    m_impl->workers.emplace_back(std::make_unique<ThreadWorker>(_idx, workerDebugName, m_impl,
+                                                                sharingMode, _placement));
 }
 
 void ThreadPool::startupWorker(uint32_t _idx)
 {
     auto worker = m_impl->workers[_idx].get();
 
+    // the worker pins itself to its placement once started
     worker->m_thread = std::jthread(&ThreadWorker::operator(), worker);
+}
+
+bool ThreadPool::assignTaskToGlobal(MoveOnlyTask<void()> _task, TaskPriority _priority) noexcept
+{
+    if (m_impl->stop.load(std::memory_order_acquire))
+    {
+        MOSAIC_WARN("ThreadPool is shutting down, cannot assign new tasks.");
+        return false;
+    }
+
+    pushToGlobal(std::move(_task), _priority);
 
-    setWorkerAffinity(_idx, _idx + 1); // +1 to leave core 0 for main thread
+    return true;
 }
 
-bool ThreadPool::assignTaskToGlobal(MoveOnlyTask<void()> _task) noexcept
+bool ThreadPool::assignTaskToWorker(MoveOnlyTask<void()> _task, TaskPriority _priority) noexcept
 {
     if (m_impl->stop.load(std::memory_order_acquire))
     {
@@ -508,20 +1422,78 @@ bool ThreadPool::assignTaskToGlobal(MoveOnlyTask<void()> _task) noexcept
         return false;
     }
 
-    m_impl->globalTaskQueue.enqueue(std::move(_task));
+    // Random picks first, skipping the workers busy with a background task so that critical and
+    // normal tasks do not queue up behind a long one (and, on hybrid CPUs, the efficiency cores
+    // for critical tasks). Then a scan of every worker, which finds the few accepting the priority
+    // (a single background lane say), and last any worker at all: it always runs its own queues,
+    // so a task nobody accepts still runs.
+    const uint32_t n = m_impl->workersCount;
 
-    for (auto& worker : m_impl->workers)
+    auto assign = [&](ThreadWorker* _worker)
     {
-        if (mosaic::utils::hasFlag(worker->m_sharingMode, WorkerSharingMode::global_consumer))
+        _worker->queue(_priority).enqueue(m_impl->stamp(std::move(_task)));
+        _worker->notify();
+        return true;
+    };
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        ThreadWorker* worker = getRandomWorker();
+
+        if (!mosaic::utils::hasFlag(worker->sharingMode(), WorkerSharingMode::accept_indirect) ||
+            !worker->accepts(_priority))
         {
-            worker->notify();
+            continue;
         }
+
+        if (_priority != TaskPriority::background &&
+            worker->m_runningBackground.load(std::memory_order_relaxed))
+        {
+            continue;
+        }
+
+        if (_priority == TaskPriority::critical && m_impl->hybrid &&
+            !worker->m_placement.performanceCore)
+        {
+            continue;
+        }
+
+        return assign(worker);
     }
 
+    ThreadWorker* fallback = nullptr;
+    const uint32_t start = n > 0 ? getRandomWorker()->m_idx : 0;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        ThreadWorker* worker = m_impl->workers[(start + i) % n].get();
+
+        if (!mosaic::utils::hasFlag(worker->sharingMode(), WorkerSharingMode::accept_indirect))
+        {
+            continue;
+        }
+
+        if (worker->accepts(_priority)) return assign(worker);
+        if (!fallback) fallback = worker;
+    }
+
+    if (fallback) return assign(fallback);
+
+    MOSAIC_INFO("No thread worker available that accepts indirect task submissions.");
+
+    pushToGlobal(std::move(_task), _priority);
+
     return true;
 }
 
-bool ThreadPool::assignTaskToWorker(MoveOnlyTask<void()> _task) noexcept
+void ThreadPool::pushToGlobal(MoveOnlyTask<void()> _task, TaskPriority _priority) noexcept
+{
+    m_impl->globalQueue(_priority).enqueue(m_impl->stamp(std::move(_task)));
+    m_impl->notifyGlobalConsumers(_priority);
+}
+
+bool ThreadPool::assignTasksToWorkers(std::vector<MoveOnlyTask<void()>>& _tasks,
+                                      TaskPriority _priority) noexcept
 {
     if (m_impl->stop.load(std::memory_order_acquire))
     {
@@ -529,28 +1501,61 @@ bool ThreadPool::assignTaskToWorker(MoveOnlyTask<void()> _task) noexcept
         return false;
     }
 
-    for (uint32_t i = 0; i < m_impl->workersCount; ++i)
+    if (_tasks.empty()) return true;
+
+    if (mosaic::utils::hasFlag(m_impl->telemetry.load(std::memory_order_relaxed),
+                               PoolTelemetry::timings))
     {
-        ThreadWorker* worker = getRandomWorker();
+        for (auto& task : _tasks) task = m_impl->stamp(std::move(task));
+    }
 
-        if (mosaic::utils::hasFlag(worker->m_sharingMode, WorkerSharingMode::accept_indirect))
+    // The workers accepting the priority, or as for single tasks any worker taking indirect
+    // submissions: it always runs its own queues.
+    std::vector<ThreadWorker*> targets;
+    std::vector<ThreadWorker*> fallbacks;
+    targets.reserve(m_impl->workersCount);
+
+    for (auto& worker : m_impl->workers)
+    {
+        if (!mosaic::utils::hasFlag(worker->sharingMode(), WorkerSharingMode::accept_indirect))
         {
-            worker->m_taskQueue.enqueue(std::move(_task));
-            worker->notify();
-            return true;
+            continue;
         }
+
+        (worker->accepts(_priority) ? targets : fallbacks).push_back(worker.get());
     }
 
-    MOSAIC_INFO("No thread worker available that accepts indirect task submissions.");
+    if (targets.empty()) targets = std::move(fallbacks);
 
-    m_impl->globalTaskQueue.enqueue(std::move(_task));
+    auto first = std::make_move_iterator(_tasks.begin());
 
-    for (auto& worker : m_impl->workers)
+    if (targets.empty())
     {
-        if (mosaic::utils::hasFlag(worker->m_sharingMode, WorkerSharingMode::global_consumer))
-        {
-            worker->notify();
-        }
+        MOSAIC_INFO("No thread worker available that accepts indirect task submissions.");
+
+        m_impl->globalQueue(_priority).enqueue_bulk(first, _tasks.size());
+        m_impl->notifyGlobalConsumers(_priority);
+
+        return true;
+    }
+
+    // Contiguous blocks, one bulk enqueue each: a worker pays one queue operation for its whole
+    // share, and stealing evens out the blocks that run longer. The rotating start keeps
+    // successive small batches from all landing on the first worker.
+    const size_t count = std::min(targets.size(), _tasks.size());
+    const size_t block = _tasks.size() / count;
+    const size_t extra = _tasks.size() % count;
+    const uint32_t start = m_impl->bulkCursor.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        ThreadWorker* worker = targets[(start + i) % targets.size()];
+        const size_t size = block + (i < extra ? 1 : 0);
+
+        worker->queue(_priority).enqueue_bulk(first, size);
+        worker->notify();
+
+        first += static_cast<std::ptrdiff_t>(size);
     }
 
     return true;
@@ -560,7 +1565,7 @@ bool ThreadPool::assignTaskToWorkerById(uint32_t _idx, MoveOnlyTask<void()> _tas
 {
     ThreadWorker* worker = getWorkerByIdx(_idx);
 
-    const WorkerSharingMode mode = worker->m_sharingMode;
+    const WorkerSharingMode mode = worker->sharingMode();
 
     if (!mosaic::utils::hasFlag(mode, WorkerSharingMode::accept_direct))
     {
@@ -568,10 +1573,10 @@ bool ThreadPool::assignTaskToWorkerById(uint32_t _idx, MoveOnlyTask<void()> _tas
         return false;
     }
 
-    worker->m_taskQueue.enqueue(std::move(_task));
+    worker->queue(TaskPriority::normal).enqueue(m_impl->stamp(std::move(_task)));
     worker->notify();
 
-    if (worker->m_taskQueue.size_approx() < k_stealBatchSize) return true;
+    if (worker->getTasksCount() < k_stealBatchSize) return true;
 
     ThreadWorker* otherWorker = nullptr;
 
@@ -592,7 +1597,7 @@ bool ThreadPool::assignTaskToWorkerByDebugName(const std::string& _debugName,
 {
     ThreadWorker* worker = getWorkerByDebugName(_debugName);
 
-    const WorkerSharingMode mode = worker->m_sharingMode;
+    const WorkerSharingMode mode = worker->sharingMode();
 
     if (!mosaic::utils::hasFlag(mode, WorkerSharingMode::accept_direct))
     {
@@ -601,10 +1606,10 @@ bool ThreadPool::assignTaskToWorkerByDebugName(const std::string& _debugName,
         return false;
     }
 
-    worker->m_taskQueue.enqueue(std::move(_task));
+    worker->queue(TaskPriority::normal).enqueue(m_impl->stamp(std::move(_task)));
     worker->notify();
 
-    if (worker->m_taskQueue.size_approx() < k_stealBatchSize) return true;
+    if (worker->getTasksCount() < k_stealBatchSize) return true;
 
     ThreadWorker* otherWorker = nullptr;
 
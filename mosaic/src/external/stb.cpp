@@ -2,3 +2,5 @@
 #include <stb_image.h>
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #include <stb_image_resize2.h>
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb_truetype.h>
@@ -8,12 +8,12 @@ namespace vulkan
 {
 
 void createCommandBuffer(CommandBuffer& _commandBuffer, const Device& _device,
-                         const CommandPool& _commandPool)
+                         const CommandPool& _commandPool, VkCommandBufferLevel _level)
 {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool = _commandPool.commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.level = _level;
     allocInfo.commandBufferCount = 1;
 
     if (vkAllocateCommandBuffers(_device.device, &allocInfo, &_commandBuffer) != VK_SUCCESS)
@@ -41,6 +41,29 @@ void beingCommandBuffer(CommandBuffer& _commandBuffer, const Surface& _surface)
     }
 }
 
+void beginSecondaryCommandBuffer(CommandBuffer& _commandBuffer,
+                                 const VkCommandBufferInheritanceInfo& _inheritance)
+{
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &_inheritance;
+
+    bool continues = _inheritance.renderPass != VK_NULL_HANDLE;
+    for (auto* next = static_cast<const VkBaseInStructure*>(_inheritance.pNext); next;
+         next = next->pNext)
+    {
+        continues |= next->sType == VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    }
+
+    if (continues) beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+
+    if (vkBeginCommandBuffer(_commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+    }
+}
+
 void endCommandBuffer(CommandBuffer& _commandBuffer)
 {
     if (vkEndCommandBuffer(_commandBuffer) != VK_SUCCESS)
@@ -13,13 +13,19 @@ namespace vulkan
 using CommandBuffer = VkCommandBuffer;
 
 void createCommandBuffer(CommandBuffer& _commandBuffer, const Device& _device,
-                         const CommandPool& _commandPool);
+                         const CommandPool& _commandPool,
+                         VkCommandBufferLevel _level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
 void destroyCommandBuffer(CommandBuffer& _commandBuffer, const Device& _device,
                           const CommandPool& _commandPool);
 
 void beingCommandBuffer(CommandBuffer& _commandPool, const Surface& _surface);
 
+// A secondary command buffer continuing the render pass (if any) of the inheritance info, or the
+// dynamic rendering of a VkCommandBufferInheritanceRenderingInfo in its chain.
+void beginSecondaryCommandBuffer(CommandBuffer& _commandBuffer,
+                                 const VkCommandBufferInheritanceInfo& _inheritance);
+
 void endCommandBuffer(CommandBuffer& _commandPool);
 
 } // namespace vulkan
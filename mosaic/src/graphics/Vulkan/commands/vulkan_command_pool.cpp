@@ -7,15 +7,22 @@ namespace graphics
 namespace vulkan
 {
 
-void createCommandPool(CommandPool& _commandPool, const Device& _device, const Surface& _surface)
+void createCommandPool(CommandPool& _commandPool, const Device& _device, const Surface& _surface,
+                       VkCommandPoolCreateFlags _flags)
 {
     QueueFamilySupportDetails queueFamilyIndices =
         findDeviceQueueFamiliesSupport(_device.physicalDevice, _surface.surface);
 
+    createCommandPool(_commandPool, _device, queueFamilyIndices.graphicsFamily.value(), _flags);
+}
+
+void createCommandPool(CommandPool& _commandPool, const Device& _device, uint32_t _queueFamily,
+                       VkCommandPoolCreateFlags _flags)
+{
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    poolInfo.flags = _flags;
+    poolInfo.queueFamilyIndex = _queueFamily;
 
     if (vkCreateCommandPool(_device.device, &poolInfo, nullptr, &_commandPool.commandPool) !=
         VK_SUCCESS)
@@ -24,6 +31,14 @@ void createCommandPool(CommandPool& _commandPool, const Device& _device, const S
     }
 }
 
+void resetCommandPool(CommandPool& _commandPool, const Device& _device)
+{
+    if (vkResetCommandPool(_device.device, _commandPool.commandPool, 0) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to reset command pool!");
+    }
+}
+
 void destroyCommandPool(CommandPool& _commandPool, const Device& _device)
 {
     vkDestroyCommandPool(_device.device, _commandPool.commandPool, nullptr);
@@ -16,7 +16,18 @@ struct CommandPool
     CommandPool() : commandPool(VK_NULL_HANDLE){};
 };
 
-void createCommandPool(CommandPool& _commandPool, const Device& _device, const Surface& _surface);
+// The command buffers of the pool are reset one by one by default; a pool reset as a whole every
+// frame (resetCommandPool()) is created VK_COMMAND_POOL_CREATE_TRANSIENT_BIT instead.
+void createCommandPool(CommandPool& _commandPool, const Device& _device, const Surface& _surface,
+                       VkCommandPoolCreateFlags _flags =
+                           VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+
+// For the queues of _queueFamily, e.g. the transfer queue of the device.
+void createCommandPool(CommandPool& _commandPool, const Device& _device, uint32_t _queueFamily,
+                       VkCommandPoolCreateFlags _flags =
+                           VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+
+void resetCommandPool(CommandPool& _commandPool, const Device& _device);
 
 void destroyCommandPool(CommandPool& _commandPool, const Device& _device);
 
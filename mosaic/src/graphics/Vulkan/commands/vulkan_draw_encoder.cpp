@@ -0,0 +1,107 @@
+#include "vulkan_draw_encoder.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+static bool isPipeline(std::span<const Pipeline* const> _pipelines, ResourceHandle _pipeline)
+{
+    if (_pipeline < _pipelines.size() && _pipelines[_pipeline]) return true;
+
+    MOSAIC_ERROR("Draw queue: no pipeline {}, its draws are skipped!", _pipeline);
+    return false;
+}
+
+static bool isBuffer(std::span<const VkBuffer> _buffers, ResourceHandle _buffer)
+{
+    if (_buffer < _buffers.size() && _buffers[_buffer] != VK_NULL_HANDLE) return true;
+
+    MOSAIC_ERROR("Draw queue: no buffer {}, its command is skipped!", _buffer);
+    return false;
+}
+
+void DrawEncoder::bindPipeline(ResourceHandle _pipeline)
+{
+    if (checks)
+    {
+        skipping = !isPipeline(pipelines, _pipeline);
+        if (skipping) return;
+    }
+
+    const Pipeline& pipeline = *pipelines[_pipeline];
+    bindGraphicsPipeline(pipeline, commandBuffer);
+
+    if (resourceTable && boundLayout == VK_NULL_HANDLE)
+    {
+        bindResourceTable(*resourceTable, commandBuffer, pipeline.pipelineLayout);
+    }
+
+    boundLayout = pipeline.pipelineLayout;
+}
+
+void DrawEncoder::bindVertexBuffer(uint32_t _slot, ResourceHandle _buffer)
+{
+    if (checks && !isBuffer(buffers, _buffer)) return;
+
+    const VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, _slot, 1, &buffers[_buffer], &offset);
+}
+
+void DrawEncoder::bindIndexBuffer(ResourceHandle _buffer)
+{
+    if (checks && !isBuffer(buffers, _buffer)) return;
+
+    vkCmdBindIndexBuffer(commandBuffer, buffers[_buffer], 0, VK_INDEX_TYPE_UINT32);
+}
+
+void DrawEncoder::draw(const DrawCall& _call)
+{
+    if (checks)
+    {
+        if (skipping || boundLayout == VK_NULL_HANDLE) return;
+
+        const bool counted = _call.type == DrawCallType::IndexedIndirectCount;
+        const bool indirect = counted || _call.type == DrawCallType::Indirect;
+        if (indirect && !isBuffer(buffers, _call.indirectBuffer)) return;
+        if (counted && !isBuffer(buffers, _call.countBuffer)) return;
+    }
+
+    if (!resourcesPushed || pushedResources != _call.resources)
+    {
+        vkCmdPushConstants(commandBuffer, boundLayout, k_resourceStages, 0,
+                           sizeof(DrawCall::resources), _call.resources.data());
+        pushedResources = _call.resources;
+        resourcesPushed = true;
+    }
+
+    switch (_call.type)
+    {
+        case DrawCallType::NonIndexed:
+        case DrawCallType::Instanced:
+            vkCmdDraw(commandBuffer, _call.vertexCount, _call.instanceCount, _call.firstVertex,
+                      _call.firstInstance);
+            break;
+        case DrawCallType::Indexed:
+        case DrawCallType::IndexedInstanced:
+            vkCmdDrawIndexed(commandBuffer, _call.indexCount, _call.instanceCount,
+                             _call.firstIndex, static_cast<int32_t>(_call.vertexOffset),
+                             _call.firstInstance);
+            break;
+        case DrawCallType::Indirect:
+            vkCmdDrawIndirect(commandBuffer, buffers[_call.indirectBuffer], 0, 1,
+                              sizeof(VkDrawIndirectCommand));
+            break;
+        case DrawCallType::IndexedIndirectCount:
+            vkCmdDrawIndexedIndirectCount(commandBuffer, buffers[_call.indirectBuffer], 0,
+                                          buffers[_call.countBuffer], 0, _call.maxDrawCount,
+                                          sizeof(VkDrawIndexedIndirectCommand));
+            break;
+    }
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "mosaic/graphics/draw_queue.hpp"
+
+#include "../pipelines/vulkan_pipeline.hpp"
+#include "../vulkan_resource_table.hpp"
+#include "vulkan_command_buffer.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief Records the draws of a DrawQueue on a command buffer (a DrawCommandEncoder), the
+ * ResourceHandles indexing the pipelines (acquired for the frame) and buffers of the context.
+ *
+ * The resource table is bound with the first pipeline, and stays bound across the others (their
+ * layouts share set 0); DrawCall::resources are pushed when they change.
+ *
+ * With checks (RenderProfile::checks) a handle out of the pipelines or the buffers skips its
+ * command, and the draws until a pipeline is bound again; without, the handles are trusted.
+ */
+struct DrawEncoder
+{
+    CommandBuffer commandBuffer;
+    std::span<const Pipeline* const> pipelines;
+    std::span<const VkBuffer> buffers; // vertex, index (32-bit) and indirect
+    const ResourceTable* resourceTable = nullptr;
+
+    VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+    std::array<uint32_t, DrawCall::k_maxResources> pushedResources = {};
+    bool resourcesPushed = false;
+    bool checks = false;
+    bool skipping = false; // the pipeline bound was not valid
+
+    void bindPipeline(ResourceHandle _pipeline);
+    void bindVertexBuffer(uint32_t _slot, ResourceHandle _buffer);
+    void bindIndexBuffer(ResourceHandle _buffer);
+    void draw(const DrawCall& _call);
+};
+
+static_assert(DrawCommandEncoder<DrawEncoder>);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
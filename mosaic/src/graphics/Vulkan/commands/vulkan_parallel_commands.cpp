@@ -0,0 +1,92 @@
+#include "vulkan_parallel_commands.hpp"
+
+#include <algorithm>
+
+#include "mosaic/exec/parallel_for.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// Past this many recorders, the ranges are too small to pay for their command buffers
+static constexpr uint32_t k_maxRecorders = 16;
+
+void createParallelCommands(ParallelCommands& _commands, const Device& _device,
+                            const Surface& _surface, uint32_t _framesCount)
+{
+    const exec::ThreadPool* pool = exec::ThreadPool::getInstance();
+    const uint32_t workers = pool ? pool->getWorkersCount() : 0;
+
+    _commands.recordersCount = std::clamp(workers + 1, 1u, k_maxRecorders);
+
+    const size_t count = size_t{_commands.recordersCount} * _framesCount;
+    _commands.commandPools.resize(count);
+    _commands.commandBuffers.resize(count, VK_NULL_HANDLE);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        createCommandPool(_commands.commandPools[i], _device, _surface,
+                          VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        createCommandBuffer(_commands.commandBuffers[i], _device, _commands.commandPools[i],
+                            VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    }
+}
+
+void destroyParallelCommands(ParallelCommands& _commands, const Device& _device)
+{
+    for (size_t i = 0; i < _commands.commandPools.size(); ++i)
+    {
+        destroyCommandBuffer(_commands.commandBuffers[i], _device, _commands.commandPools[i]);
+        destroyCommandPool(_commands.commandPools[i], _device);
+    }
+
+    _commands.commandPools.clear();
+    _commands.commandBuffers.clear();
+    _commands.recordersCount = 0;
+}
+
+void recordParallelCommands(ParallelCommands& _commands, const Device& _device,
+                            CommandBuffer& _primary,
+                            const VkCommandBufferInheritanceInfo& _inheritance, uint32_t _frame,
+                            size_t _count, size_t _minRangeSize,
+                            const RecordRangeFunction& _record)
+{
+    if (_count == 0) return;
+
+    // as many ranges as there are recorders, of the minimum size at least, none empty
+    const size_t minRangeSize = std::max<size_t>(_minRangeSize, 1);
+    const size_t maxRanges =
+        std::min<size_t>((_count + minRangeSize - 1) / minRangeSize, _commands.recordersCount);
+    const size_t rangeSize = (_count + maxRanges - 1) / maxRanges;
+    const auto ranges = static_cast<uint32_t>((_count + rangeSize - 1) / rangeSize);
+
+    const size_t firstRecorder = size_t{_frame} * _commands.recordersCount;
+
+    // the calling thread records a range too, every range on its own recorder
+    exec::parallelFor(uint32_t{0}, ranges, uint32_t{1},
+                      [&](uint32_t _range)
+                      {
+                          MOSAIC_TRACE_SCOPE("Record commands");
+
+                          const size_t recorder = firstRecorder + _range;
+                          CommandBuffer& commandBuffer = _commands.commandBuffers[recorder];
+
+                          resetCommandPool(_commands.commandPools[recorder], _device);
+                          beginSecondaryCommandBuffer(commandBuffer, _inheritance);
+
+                          const size_t first = _range * rangeSize;
+                          _record(commandBuffer, first, std::min(rangeSize, _count - first));
+
+                          endCommandBuffer(commandBuffer);
+                      });
+
+    vkCmdExecuteCommands(_primary, ranges, &_commands.commandBuffers[firstRecorder]);
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "../context/vulkan_device.hpp"
+#include "vulkan_command_pool.hpp"
+#include "vulkan_command_buffer.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief Secondary command buffers recorded in parallel on exec::ThreadPool, then executed in
+ * order by a primary one.
+ *
+ * Command pools are not thread safe: every recorder has its own, per frame in flight, reset as a
+ * whole once its frame was waited on. A range only ever records on its recorder, so
+ * the tasks need no lock whichever worker runs them.
+ */
+struct ParallelCommands
+{
+    uint32_t recordersCount; // per frame: the workers of the pool and the calling thread
+
+    // recordersCount per frame in flight, the frames one after the other
+    std::vector<CommandPool> commandPools;
+    std::vector<CommandBuffer> commandBuffers;
+
+    ParallelCommands() : recordersCount(0){};
+};
+
+// Records the commands of [_first, _first + _count) on a secondary command buffer begun for it.
+using RecordRangeFunction = std::function<void(CommandBuffer, size_t _first, size_t _count)>;
+
+void createParallelCommands(ParallelCommands& _commands, const Device& _device,
+                            const Surface& _surface, uint32_t _framesCount);
+
+void destroyParallelCommands(ParallelCommands& _commands, const Device& _device);
+
+/**
+ * @brief Splits _count items (draws of a sorted DrawQueue...) in ranges of _minRangeSize at least,
+ * one per recorder at most, records them in parallel and executes them on _primary in order.
+ *
+ * The primary command buffer is in the render pass of _inheritance, begun with
+ * VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS (with dynamic rendering,
+ * VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT). Nothing is bound in a secondary command
+ * buffer when it starts: each range binds its pipeline and sets its dynamic state.
+ */
+void recordParallelCommands(ParallelCommands& _commands, const Device& _device,
+                            CommandBuffer& _primary,
+                            const VkCommandBufferInheritanceInfo& _inheritance, uint32_t _frame,
+                            size_t _count, size_t _minRangeSize,
+                            const RecordRangeFunction& _record);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
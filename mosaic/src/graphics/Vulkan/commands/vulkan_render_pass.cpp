@@ -7,17 +7,19 @@ namespace graphics
 namespace vulkan
 {
 
-void createRenderPass(RenderPass& _renderPass, const Device& _device, const Swapchain& _swapchain)
+void createRenderPass(RenderPass& _renderPass, const Device& _device, VkFormat _colorFormat)
 {
     VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = _swapchain.surfaceFormat.format;
+    colorAttachment.format = _colorFormat;
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    // never begun, the pipelines are only created against it: the render graph passes choose the
+    // load and store of their attachments, compatible whatever they are
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -57,25 +59,6 @@ void destroyRenderPass(RenderPass& _renderPass, const Device& _device)
     vkDestroyRenderPass(_device.device, _renderPass.renderPass, nullptr);
 }
 
-void beginRenderPass(RenderPass& _renderPass, const Swapchain& _swapchain,
-                     const CommandBuffer& _commandBuffer, uint32_t _imageIndex)
-{
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = _renderPass.renderPass;
-    renderPassInfo.framebuffer = _swapchain.framebuffers[_imageIndex];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = _swapchain.extent;
-
-    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
-
-    vkCmdBeginRenderPass(_commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-}
-
-void endRenderPass(VkCommandBuffer commandBuffer) { vkCmdEndRenderPass(commandBuffer); }
-
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
@@ -20,15 +20,11 @@ struct RenderPass
     RenderPass() : renderPass(nullptr), pipelineLayout(nullptr){};
 };
 
-void createRenderPass(RenderPass& _renderPass, const Device& _device, const Swapchain& _swapchain);
+// One color attachment of the format, the compatibility render pass of the pipelines.
+void createRenderPass(RenderPass& _renderPass, const Device& _device, VkFormat _colorFormat);
 
 void destroyRenderPass(RenderPass& _renderPass, const Device& _device);
 
-void beginRenderPass(RenderPass& _renderPass, const Swapchain& _swapchain,
-                     const CommandBuffer& _commandBuffer, uint32_t imageIndex);
-
-void endRenderPass(VkCommandBuffer commandBuffer);
-
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
@@ -0,0 +1,246 @@
+#include "vulkan_timestamp_queries.hpp"
+
+#include <utility>
+
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// Midway between the submit and the end of a command buffer writing a timestamp: the error is
+// half the submit latency, tens of microseconds.
+static void calibrateTimestamps(TimestampQueries& _queries, const Device& _device,
+                                const CommandPool& _commandPool)
+{
+    CommandBuffer commandBuffer = VK_NULL_HANDLE;
+    createCommandBuffer(commandBuffer, _device, _commandPool);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    vkCmdResetQueryPool(commandBuffer, _queries.queryPool, 0, 1);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _queries.queryPool, 0);
+    endCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    const auto submitted = std::chrono::steady_clock::now();
+
+    if (vkQueueSubmit(_device.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        destroyCommandBuffer(commandBuffer, _device, _commandPool);
+        throw std::runtime_error("failed to submit the timestamp calibration!");
+    }
+
+    vkQueueWaitIdle(_device.graphicsQueue);
+
+    const auto completed = std::chrono::steady_clock::now();
+
+    uint64_t ticks = 0;
+    const VkResult result =
+        vkGetQueryPoolResults(_device.device, _queries.queryPool, 0, 1, sizeof(ticks), &ticks,
+                              sizeof(ticks), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+    destroyCommandBuffer(commandBuffer, _device, _commandPool);
+
+    if (result != VK_SUCCESS)
+    {
+        MOSAIC_WARN("Vulkan timestamp calibration failed, GPU spans are not traced.");
+        _queries.supported = false;
+        return;
+    }
+
+    _queries.calibrationTicks = ticks & _queries.validMask;
+    _queries.calibrationTime = submitted + (completed - submitted) / 2;
+}
+
+void createTimestampQueries(TimestampQueries& _queries, const Device& _device,
+                            const Surface& _surface, const CommandPool& _commandPool,
+                            uint32_t _frameCount)
+{
+    QueueFamilySupportDetails queueFamilyIndices =
+        findDeviceQueueFamiliesSupport(_device.physicalDevice, _surface.surface);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(_device.physicalDevice, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(_device.physicalDevice, &queueFamilyCount,
+                                             queueFamilies.data());
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(_device.physicalDevice, &deviceProperties);
+
+    const uint32_t validBits =
+        queueFamilies[queueFamilyIndices.graphicsFamily.value()].timestampValidBits;
+
+    _queries.frames.resize(_frameCount);
+    _queries.supported = validBits != 0 && deviceProperties.limits.timestampPeriod > 0.0f;
+
+    if (!_queries.supported)
+    {
+        MOSAIC_INFO("Vulkan graphics queue has no timestamps, GPU spans are not traced.");
+        return;
+    }
+
+    _queries.nanosecondsPerTick = deviceProperties.limits.timestampPeriod;
+    _queries.validMask = validBits >= 64 ? ~uint64_t{0} : (uint64_t{1} << validBits) - 1;
+    _queries.track = reinterpret_cast<uintptr_t>(&_queries);
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = _frameCount * TimestampQueries::k_maxSpans * 2;
+
+    if (vkCreateQueryPool(_device.device, &poolInfo, nullptr, &_queries.queryPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    calibrateTimestamps(_queries, _device, _commandPool);
+
+    if (_queries.supported)
+    {
+        if (auto* tracer = tools::Tracer::getInstance()) tracer->nameTrack(_queries.track, "GPU");
+    }
+}
+
+void destroyTimestampQueries(TimestampQueries& _queries, const Device& _device)
+{
+    if (_queries.queryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(_device.device, _queries.queryPool, nullptr);
+        _queries.queryPool = VK_NULL_HANDLE;
+    }
+
+    _queries.frames.clear();
+    _queries.supported = false;
+}
+
+void resetTimestampQueries(TimestampQueries& _queries, CommandBuffer& _commandBuffer,
+                           uint32_t _frame)
+{
+    if (_queries.frames.empty()) return;
+
+    auto& frame = _queries.frames[_frame];
+    frame.spanCount = 0;
+    frame.armed = false;
+
+    if (!_queries.supported) return;
+    if (!_queries.measureFrames && !tools::Tracer::isRecording(tools::TraceCategory::gpu)) return;
+
+    constexpr uint32_t k_queriesPerFrame = TimestampQueries::k_maxSpans * 2;
+
+    vkCmdResetQueryPool(_commandBuffer, _queries.queryPool, _frame * k_queriesPerFrame,
+                        k_queriesPerFrame);
+
+    frame.names.fill(nullptr);
+    frame.armed = true;
+}
+
+uint32_t beginTimestampSpan(TimestampQueries& _queries, CommandBuffer& _commandBuffer,
+                            uint32_t _frame, const char* _name)
+{
+    if (_queries.frames.empty()) return TimestampQueries::k_maxSpans;
+
+    auto& frame = _queries.frames[_frame];
+
+    if (!frame.armed || frame.spanCount >= TimestampQueries::k_maxSpans)
+    {
+        return TimestampQueries::k_maxSpans;
+    }
+
+    const uint32_t span = frame.spanCount++;
+    const uint32_t query = (_frame * TimestampQueries::k_maxSpans + span) * 2;
+
+    frame.names[span] = _name;
+    vkCmdWriteTimestamp(_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _queries.queryPool,
+                        query);
+
+    return span;
+}
+
+void endTimestampSpan(TimestampQueries& _queries, CommandBuffer& _commandBuffer, uint32_t _frame,
+                      uint32_t _span)
+{
+    if (_span >= TimestampQueries::k_maxSpans) return;
+
+    const uint32_t query = (_frame * TimestampQueries::k_maxSpans + _span) * 2 + 1;
+
+    vkCmdWriteTimestamp(_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _queries.queryPool,
+                        query);
+}
+
+void collectTimestampQueries(TimestampQueries& _queries, const Device& _device, uint32_t _frame)
+{
+    if (_queries.frames.empty()) return;
+
+    auto& frame = _queries.frames[_frame];
+
+    frame.armed = false;
+    _queries.frameTime = {};
+
+    const uint32_t spanCount = std::exchange(frame.spanCount, 0);
+    if (spanCount == 0) return;
+
+    // the tracer drops the spans of a category it does not record
+    auto* tracer = tools::Tracer::getInstance();
+    if (!tracer && !_queries.measureFrames) return;
+
+    // a value and its availability per query
+    std::array<uint64_t, TimestampQueries::k_maxSpans * 2 * 2> results{};
+
+    // VK_NOT_READY when some are not available, e.g. a span never ended: told by availability
+    const VkResult result = vkGetQueryPoolResults(
+        _device.device, _queries.queryPool, _frame * TimestampQueries::k_maxSpans * 2,
+        spanCount * 2, sizeof(results), results.data(), 2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    if (result != VK_SUCCESS && result != VK_NOT_READY) return;
+
+    const uint64_t halfRange = _queries.validMask >> 1;
+
+    for (uint32_t span = 0; span < spanCount; ++span)
+    {
+        const uint64_t* begin = &results[span * 4];
+        const uint64_t* end = &results[span * 4 + 2];
+
+        if (begin[1] == 0 || end[1] == 0 || !frame.names[span]) continue;
+
+        // within the valid bits, a counter that wrapped since the calibration stays in order
+        const uint64_t sinceCalibration =
+            (begin[0] - _queries.calibrationTicks) & _queries.validMask;
+        const int64_t offsetTicks = sinceCalibration > halfRange
+                                        ? -static_cast<int64_t>(_queries.validMask + 1 -
+                                                                sinceCalibration)
+                                        : static_cast<int64_t>(sinceCalibration);
+        const uint64_t durationTicks = (end[0] - begin[0]) & _queries.validMask;
+
+        const auto start =
+            _queries.calibrationTime +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::nano>(static_cast<double>(offsetTicks) *
+                                                         _queries.nanosecondsPerTick));
+        const auto duration = std::chrono::nanoseconds(static_cast<int64_t>(
+            static_cast<double>(durationTicks) * _queries.nanosecondsPerTick));
+
+        if (span == 0) _queries.frameTime = duration;
+        if (!tracer) continue;
+
+        tracer->spanTrace(frame.names[span], tools::TraceCategory::gpu, start, duration,
+                          _queries.track);
+    }
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include "../context/vulkan_device.hpp"
+#include "vulkan_command_pool.hpp"
+#include "vulkan_command_buffer.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief GPU timestamps around the passes of each frame in flight, emitted as
+ * TraceCategory::gpu spans of tools::Tracer.
+ *
+ * The queries of a frame are read once it completed, when its slot comes around again (a latency
+ * of the frames in flight), so the readback never waits on the GPU. GPU ticks map to steady
+ * clock time through a calibration taken at creation.
+ *
+ * With measureFrames, the spans are written while the tracer does not record too: the first
+ * span of a frame (the whole frame) gives its GPU time, for dynamic resolution.
+ */
+struct TimestampQueries
+{
+    static constexpr uint32_t k_maxSpans = 16; // per frame
+
+    struct Frame
+    {
+        std::array<const char*, k_maxSpans> names;
+        uint32_t spanCount;
+        bool armed; // its queries were reset, spans are written
+
+        Frame() : names{}, spanCount(0), armed(false){};
+    };
+
+    VkQueryPool queryPool;
+    std::vector<Frame> frames;
+    bool supported;
+
+    double nanosecondsPerTick; // timestampPeriod of the device
+    uint64_t validMask;        // the bits written by the graphics queue
+
+    // A GPU tick and a steady clock time taken at the same instant
+    uint64_t calibrationTicks;
+    std::chrono::steady_clock::time_point calibrationTime;
+
+    uint64_t track; // the trace track of the spans
+
+    bool measureFrames;
+    std::chrono::nanoseconds frameTime; // of the last frame collected, zero if not measured
+
+    TimestampQueries()
+        : queryPool(VK_NULL_HANDLE),
+          supported(false),
+          nanosecondsPerTick(1.0),
+          validMask(0),
+          calibrationTicks(0),
+          track(0),
+          measureFrames(false),
+          frameTime{} {};
+};
+
+void createTimestampQueries(TimestampQueries& _queries, const Device& _device,
+                            const Surface& _surface, const CommandPool& _commandPool,
+                            uint32_t _frameCount);
+
+void destroyTimestampQueries(TimestampQueries& _queries, const Device& _device);
+
+// Recorded first, outside of any render pass. No query is written while the tracer does not
+// record TraceCategory::gpu, unless measureFrames.
+void resetTimestampQueries(TimestampQueries& _queries, CommandBuffer& _commandBuffer,
+                           uint32_t _frame);
+
+// Returns the span to end, k_maxSpans when none was begun.
+uint32_t beginTimestampSpan(TimestampQueries& _queries, CommandBuffer& _commandBuffer,
+                            uint32_t _frame, const char* _name);
+
+void endTimestampSpan(TimestampQueries& _queries, CommandBuffer& _commandBuffer, uint32_t _frame,
+                      uint32_t _span);
+
+// Once the frame completed, emits its spans and sets frameTime.
+void collectTimestampQueries(TimestampQueries& _queries, const Device& _device, uint32_t _frame);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
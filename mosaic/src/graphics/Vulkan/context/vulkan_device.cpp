@@ -39,10 +39,31 @@ bool isDeviceSuitable(const VkPhysicalDevice& _physicalDevice, const VkSurfaceKH
 
     QueueFamilySupportDetails queueFamiliySupport =
         findDeviceQueueFamiliesSupport(_physicalDevice, _surface);
-    SwapChainSupportDetails swapChainSupport =
-        findDeviceSwapChainSupport(_physicalDevice, _surface);
-
-    return queueFamiliySupport.isComplete() && swapChainSupport.isComplete();
+    // headless, without a surface: nothing is presented
+    const bool swapChainSupported =
+        _surface == VK_NULL_HANDLE ||
+        findDeviceSwapChainSupport(_physicalDevice, _surface).isComplete();
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 features2 = {};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(_physicalDevice, &features2);
+
+    // The upload timeline, the descriptor arrays of the ResourceTable, and the GPU culled draws
+    const bool featuresSupported =
+        vulkan12Features.timelineSemaphore && vulkan12Features.descriptorIndexing &&
+        vulkan12Features.runtimeDescriptorArray &&
+        vulkan12Features.descriptorBindingPartiallyBound &&
+        vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+        vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+        vulkan12Features.shaderStorageBufferArrayNonUniformIndexing &&
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing &&
+        vulkan12Features.drawIndirectCount;
+
+    return queueFamiliySupport.isComplete() && swapChainSupported && featuresSupported;
 }
 
 uint16_t getDeviceScore(const VkPhysicalDevice& _physicalDevice)
@@ -152,8 +173,16 @@ QueueFamilySupportDetails findDeviceQueueFamiliesSupport(const VkPhysicalDevice&
             indices.graphicsFamily = i;
         }
 
+        // without a surface, the graphics queue stands for the present one
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(_device, i, _surface, &presentSupport);
+        if (_surface != VK_NULL_HANDLE)
+        {
+            vkGetPhysicalDeviceSurfaceSupportKHR(_device, i, _surface, &presentSupport);
+        }
+        else
+        {
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        }
 
         if (presentSupport)
         {
@@ -168,6 +197,35 @@ QueueFamilySupportDetails findDeviceQueueFamiliesSupport(const VkPhysicalDevice&
         i++;
     }
 
+    // The DMA engines: transfer only families first, then those with compute but no graphics
+    const VkQueueFlags exclusions[] = {VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT,
+                                       VK_QUEUE_GRAPHICS_BIT};
+
+    for (const VkQueueFlags excluded : exclusions)
+    {
+        for (uint32_t family = 0; family < queueFamilyCount && !indices.transferFamily; ++family)
+        {
+            const VkQueueFlags flags = queueFamilies[family].queueFlags;
+
+            if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & excluded))
+            {
+                indices.transferFamily = family;
+            }
+        }
+    }
+
+    // The async compute engine, the transfer one only when it is the single such family
+    for (uint32_t family = 0; family < queueFamilyCount; ++family)
+    {
+        const VkQueueFlags flags = queueFamilies[family].queueFlags;
+        if (!(flags & VK_QUEUE_COMPUTE_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT)) continue;
+
+        if (!indices.computeFamily || indices.computeFamily == indices.transferFamily)
+        {
+            indices.computeFamily = family;
+        }
+    }
+
     return indices;
 }
 
@@ -204,17 +262,19 @@ SwapChainSupportDetails findDeviceSwapChainSupport(const VkPhysicalDevice& devic
 void checkDeviceExtensionsSupport(Device& _device)
 {
     uint32_t extensionCount = 0;
-    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    vkEnumerateDeviceExtensionProperties(_device.physicalDevice, nullptr, &extensionCount,
+                                         nullptr);
 
     std::vector<VkExtensionProperties> extensions(extensionCount);
-    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+    vkEnumerateDeviceExtensionProperties(_device.physicalDevice, nullptr, &extensionCount,
+                                         extensions.data());
 
     for (const auto& requiredExtension : _device.requiredExtensions)
     {
         bool found = std::find_if(extensions.begin(), extensions.end(),
                                   [&](const VkExtensionProperties& extension) {
                                       return strncmp(requiredExtension, extension.extensionName,
-                                                     VK_MAX_EXTENSION_NAME_SIZE);
+                                                     VK_MAX_EXTENSION_NAME_SIZE) == 0;
                                   }) != extensions.end();
 
         if (found)
@@ -232,7 +292,7 @@ void checkDeviceExtensionsSupport(Device& _device)
         bool found = std::find_if(extensions.begin(), extensions.end(),
                                   [&](const VkExtensionProperties& extension) {
                                       return strncmp(optionalExtension, extension.extensionName,
-                                                     VK_MAX_EXTENSION_NAME_SIZE);
+                                                     VK_MAX_EXTENSION_NAME_SIZE) == 0;
                                   }) != extensions.end();
 
         if (found)
@@ -278,10 +338,26 @@ void createDevice(Device& _device, const Instance& _instance, const Surface& _su
 {
     VkPhysicalDevice physicalDevice = pickVulkanPhysicalDevice(_instance, _surface.surface);
 
+    // the extensions of the device picked
+    _device.physicalDevice = physicalDevice;
+
+    // device layers are deprecated, those of the instance enabled again for older loaders
+    if (_instance.validation) _device.requiredLayers = {"VK_LAYER_KHRONOS_validation"};
+    _device.debugUtils = _instance.debugUtils;
+
     checkDeviceExtensionsSupport(_device);
     checkDeviceLayersSupport(_device);
 
-    _device.physicalDevice = physicalDevice;
+    // VK_KHR_external_memory and _semaphore themselves are core in Vulkan 1.1
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    _device.frameExport =
+        isDeviceExtensionEnabled(_device, VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME) &&
+        isDeviceExtensionEnabled(_device, VK_KHR_EXTERNAL_SEMAPHORE_WIN32_EXTENSION_NAME);
+#elif defined(MOSAIC_PLATFORM_LINUX)
+    _device.frameExport =
+        isDeviceExtensionEnabled(_device, VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME) &&
+        isDeviceExtensionEnabled(_device, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME);
+#endif
 
     QueueFamilySupportDetails indices =
         findDeviceQueueFamiliesSupport(physicalDevice, _surface.surface);
@@ -289,6 +365,8 @@ void createDevice(Device& _device, const Instance& _instance, const Surface& _su
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(),
                                               indices.presentFamily.value()};
+    if (indices.transferFamily) uniqueQueueFamilies.insert(indices.transferFamily.value());
+    if (indices.computeFamily) uniqueQueueFamilies.insert(indices.computeFamily.value());
 
     float queuePriority = 1.0f;
 
@@ -302,13 +380,141 @@ void createDevice(Device& _device, const Instance& _instance, const Surface& _su
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    constexpr VkPhysicalDeviceFeatures deviceFeatures{
+    // The block compressed formats the device samples, those of the streamed textures
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(_device.physicalDevice, &supportedFeatures);
+
+    VkPhysicalDeviceFeatures deviceFeatures = {};
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    deviceFeatures.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+    deviceFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+
+    // Core in Vulkan 1.2: the completion of the uploads, the descriptor indexing of the
+    // ResourceTable (formerly VK_EXT_descriptor_indexing) and the draw count of GpuCulling
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    vulkan12Features.descriptorIndexing = VK_TRUE;
+    vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+    vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+    vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+    vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    vulkan12Features.drawIndirectCount = VK_TRUE;
+
+    // Where both extensions and their features are there, the frames are timed as presented
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+
+    if (isDeviceExtensionEnabled(_device, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+        isDeviceExtensionEnabled(_device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &presentIdFeatures;
+        vkGetPhysicalDeviceFeatures2(_device.physicalDevice, &features2);
 
-    };
+        _device.presentWait = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+    }
+
+    if (_device.presentWait) vulkan12Features.pNext = &presentIdFeatures;
+
+    // Core in Vulkan 1.3 (formerly VK_KHR_dynamic_rendering): no render passes nor framebuffers
+    // to make again on a resize or a recompiled graph. The tilers keep the render passes, whose
+    // subpasses the graph merges to keep the attachments on chip.
+    VkPhysicalDeviceVulkan13Features vulkan13Features = {};
+    vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+#if defined(MOSAIC_PLATFORM_DESKTOP)
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_device.physicalDevice, &properties);
+
+    if (properties.apiVersion >= VK_API_VERSION_1_3)
+    {
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &vulkan13Features;
+        vkGetPhysicalDeviceFeatures2(_device.physicalDevice, &features2);
+
+        _device.dynamicRendering = vulkan13Features.dynamicRendering;
+    }
+#endif
+
+    // only the feature used enabled
+    vulkan13Features = {};
+    vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    vulkan13Features.pNext = &vulkan12Features;
+    vulkan13Features.dynamicRendering = VK_TRUE;
+
+    const void* features =
+        _device.dynamicRendering ? static_cast<const void*>(&vulkan13Features) : &vulkan12Features;
+
+    // Pipelines linked from parts compiled once per shader: no hitch on a new material, where the
+    // link is fast (it is not on every driver exposing the extension)
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures = {};
+    libraryFeatures.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+    if (isDeviceExtensionEnabled(_device, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+        isDeviceExtensionEnabled(_device, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &libraryFeatures;
+        vkGetPhysicalDeviceFeatures2(_device.physicalDevice, &features2);
+
+        VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties = {};
+        libraryProperties.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 properties2 = {};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &libraryProperties;
+        vkGetPhysicalDeviceProperties2(_device.physicalDevice, &properties2);
+
+        _device.graphicsPipelineLibrary = libraryFeatures.graphicsPipelineLibrary &&
+                                          libraryProperties.graphicsPipelineLibraryFastLinking;
+    }
+
+    if (_device.graphicsPipelineLibrary)
+    {
+        libraryFeatures.pNext = const_cast<void*>(features);
+        features = &libraryFeatures;
+    }
+
+    // Meshlets culled per task workgroup and drawn by the mesh workgroups it launches, without the
+    // vertex input stage
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures = {};
+    meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+
+    if (isDeviceExtensionEnabled(_device, VK_EXT_MESH_SHADER_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &meshShaderFeatures;
+        vkGetPhysicalDeviceFeatures2(_device.physicalDevice, &features2);
+
+        _device.meshShader = meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+    }
+
+    if (_device.meshShader)
+    {
+        // only the features used enabled
+        meshShaderFeatures = {};
+        meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+        meshShaderFeatures.pNext = const_cast<void*>(features);
+        meshShaderFeatures.taskShader = VK_TRUE;
+        meshShaderFeatures.meshShader = VK_TRUE;
+        features = &meshShaderFeatures;
+    }
 
     const VkDeviceCreateInfo deviceCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .pNext = nullptr,
+        .pNext = features,
         .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
         .pQueueCreateInfos = queueCreateInfos.data(),
         .enabledLayerCount = static_cast<uint32_t>(_device.availableLayers.size()),
@@ -328,10 +534,67 @@ void createDevice(Device& _device, const Instance& _instance, const Surface& _su
 
     vkGetDeviceQueue(_device.device, indices.graphicsFamily.value(), 0, &_device.graphicsQueue);
     vkGetDeviceQueue(_device.device, indices.presentFamily.value(), 0, &_device.presentQueue);
+
+    _device.graphicsFamily = indices.graphicsFamily.value();
+    _device.transferFamily = indices.transferFamily.value_or(_device.graphicsFamily);
+    vkGetDeviceQueue(_device.device, _device.transferFamily, 0, &_device.transferQueue);
+
+    _device.computeFamily = indices.computeFamily.value_or(_device.graphicsFamily);
+    vkGetDeviceQueue(_device.device, _device.computeFamily, 0, &_device.computeQueue);
+
+    if (indices.transferFamily)
+    {
+        MOSAIC_INFO("Vulkan dedicated transfer queue family: {}", _device.transferFamily);
+    }
+
+    if (indices.computeFamily)
+    {
+        MOSAIC_INFO("Vulkan async compute queue family: {}", _device.computeFamily);
+    }
+    if (_device.dynamicRendering) MOSAIC_INFO("Vulkan dynamic rendering enabled");
+    if (_device.graphicsPipelineLibrary) MOSAIC_INFO("Vulkan graphics pipeline library enabled");
+    if (_device.meshShader) MOSAIC_INFO("Vulkan mesh shaders enabled");
 }
 
 void destroyDevice(Device& _device) { vkDestroyDevice(_device.device, nullptr); }
 
+bool isDeviceExtensionEnabled(const Device& _device, const char* _extension)
+{
+    return std::any_of(_device.availableExtensions.begin(), _device.availableExtensions.end(),
+                       [&](const char* _enabled) { return strcmp(_enabled, _extension) == 0; });
+}
+
+void setObjectName(const Device& _device, VkObjectType _type, uint64_t _handle, const char* _name)
+{
+    if (!_device.debugUtils || !vkSetDebugUtilsObjectNameEXT) return;
+
+    VkDebugUtilsObjectNameInfoEXT nameInfo{};
+    nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+    nameInfo.objectType = _type;
+    nameInfo.objectHandle = _handle;
+    nameInfo.pObjectName = _name;
+
+    vkSetDebugUtilsObjectNameEXT(_device.device, &nameInfo);
+}
+
+void beginDebugLabel(const Device& _device, VkCommandBuffer _commandBuffer, const char* _name)
+{
+    if (!_device.debugUtils || !vkCmdBeginDebugUtilsLabelEXT) return;
+
+    VkDebugUtilsLabelEXT label{};
+    label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+    label.pLabelName = _name;
+
+    vkCmdBeginDebugUtilsLabelEXT(_commandBuffer, &label);
+}
+
+void endDebugLabel(const Device& _device, VkCommandBuffer _commandBuffer)
+{
+    if (!_device.debugUtils || !vkCmdEndDebugUtilsLabelEXT) return;
+
+    vkCmdEndDebugUtilsLabelEXT(_commandBuffer);
+}
+
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
@@ -15,6 +15,8 @@ struct QueueFamilySupportDetails
 {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    std::optional<uint32_t> transferFamily; // dedicated: transfers without graphics
+    std::optional<uint32_t> computeFamily;  // dedicated: compute without graphics
 
     bool isComplete() { return graphicsFamily.has_value() && presentFamily.has_value(); }
 };
@@ -36,14 +38,45 @@ struct Device
     VkDevice device;
     VkQueue graphicsQueue;
     VkQueue presentQueue;
+    VkQueue transferQueue; // the graphics queue when the device has no dedicated one
+    VkQueue computeQueue;  // async compute, likewise
+    uint32_t graphicsFamily;
+    uint32_t transferFamily;
+    uint32_t computeFamily;
     std::vector<const char*> requiredExtensions;
     std::vector<const char*> optionalExtensions;
     std::vector<const char*> availableExtensions;
     std::vector<const char*> requiredLayers;
     std::vector<const char*> availableLayers;
+    bool debugUtils; // of the instance: the labels and the object names can be set
+    bool presentWait; // VK_KHR_present_id and _wait: the presents are waited for by their id
+    bool frameExport; // memory and semaphores exported as handles of the platform (fd, NT handle)
+    // Vulkan 1.3 dynamic rendering, desktop only: the render graph passes begin with
+    // vkCmdBeginRendering() and the pipelines only know their attachment formats
+    bool dynamicRendering;
+    // VK_EXT_graphics_pipeline_library with fast linking: the PipelineLibrary links new pipelines
+    // from parts at once and optimizes them in the background
+    bool graphicsPipelineLibrary;
+    // VK_EXT_mesh_shader with task shaders: the MeshletRenderer culls and draws the meshlets in
+    // them, else in its compute fallback
+    bool meshShader;
 
     Device()
-        : physicalDevice(nullptr), device(nullptr), graphicsQueue(nullptr), presentQueue(nullptr)
+        : physicalDevice(nullptr),
+          device(nullptr),
+          graphicsQueue(nullptr),
+          presentQueue(nullptr),
+          transferQueue(nullptr),
+          computeQueue(nullptr),
+          graphicsFamily(0),
+          transferFamily(0),
+          computeFamily(0),
+          debugUtils(false),
+          presentWait(false),
+          frameExport(false),
+          dynamicRendering(false),
+          graphicsPipelineLibrary(false),
+          meshShader(false)
     {
         requiredExtensions = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME,
@@ -53,23 +86,40 @@ struct Device
         };
 
         optionalExtensions = {
+            VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, // the budget of the streamed textures
+            VK_KHR_PRESENT_ID_EXTENSION_NAME,    // the input-to-present latency
+            VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+            VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, // the pipelines linked from parts
+            VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
+            VK_EXT_MESH_SHADER_EXTENSION_NAME, // the meshlets culled and drawn on the GPU
 #ifdef MOSAIC_PLATFORM_WINDOWS
             VK_EXT_FULL_SCREEN_EXCLUSIVE_EXTENSION_NAME,
+            // the frames of a headless context shared with the editor, see ExportedFrames
+            VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME,
+            VK_KHR_EXTERNAL_SEMAPHORE_WIN32_EXTENSION_NAME,
+#elif defined(MOSAIC_PLATFORM_LINUX)
+            VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME,
+            VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME,
 #endif
         };
-
-#if defined(MOSAIC_DEBUG_BUILD) || defined(MOSAIC_DEV_BUILD)
-        requiredLayers = {
-            "VK_LAYER_KHRONOS_validation",
-        };
-#endif
     }
 };
 
+// Without a surface (headless), any device with a graphics queue, its present family the same.
 void createDevice(Device& _device, const Instance& _instance, const Surface& _surface);
 
 void destroyDevice(Device& _device);
 
+// Required, or optional and supported by the device.
+bool isDeviceExtensionEnabled(const Device& _device, const char* _extension);
+
+// The name of an object in the validation messages and the captures; nothing without debug utils.
+void setObjectName(const Device& _device, VkObjectType _type, uint64_t _handle, const char* _name);
+
+// A region of a command buffer, labelled in the captures; nothing without debug utils.
+void beginDebugLabel(const Device& _device, VkCommandBuffer _commandBuffer, const char* _name);
+void endDebugLabel(const Device& _device, VkCommandBuffer _commandBuffer);
+
 QueueFamilySupportDetails findDeviceQueueFamiliesSupport(const VkPhysicalDevice& _device,
                                                          const VkSurfaceKHR& _surface);
 
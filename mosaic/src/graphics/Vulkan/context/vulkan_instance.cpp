@@ -109,7 +109,7 @@ void checkInstanceExtensionsSupport(Instance& _instance)
         bool found = std::find_if(extensions.begin(), extensions.end(),
                                   [&](const VkExtensionProperties& extension) {
                                       return strncmp(requiredExtension, extension.extensionName,
-                                                     VK_MAX_EXTENSION_NAME_SIZE);
+                                                     VK_MAX_EXTENSION_NAME_SIZE) == 0;
                                   }) != extensions.end();
 
         if (found)
@@ -127,7 +127,7 @@ void checkInstanceExtensionsSupport(Instance& _instance)
         bool found = std::find_if(extensions.begin(), extensions.end(),
                                   [&](const VkExtensionProperties& extension) {
                                       return strncmp(optionalExtension, extension.extensionName,
-                                                     VK_MAX_EXTENSION_NAME_SIZE);
+                                                     VK_MAX_EXTENSION_NAME_SIZE) == 0;
                                   }) != extensions.end();
 
         if (found)
@@ -169,7 +169,7 @@ void checkInstanceLayersSupport(Instance& _instance)
     }
 }
 
-void createInstance(Instance& _instance)
+void createInstance(Instance& _instance, bool _validation, bool _debugUtils)
 {
     if (volkInitialize() != VK_SUCCESS)
     {
@@ -191,16 +191,36 @@ void createInstance(Instance& _instance)
         .apiVersion = VK_API_VERSION_1_3,
     };
 
+    // the messages of the validation come through the messenger; the labels and the names work
+    // without the layer, for the captures of a development build
+    if (_validation)
+    {
+        _instance.requiredExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        _instance.requiredLayers.emplace_back("VK_LAYER_KHRONOS_validation");
+    }
+    else if (_debugUtils)
+    {
+        _instance.optionalExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    }
+
     checkInstanceExtensionsSupport(_instance);
     checkInstanceLayersSupport(_instance);
 
-    void* debugCreateInfoPtr = nullptr;
+    _instance.validation = _validation && !_instance.availableLayers.empty();
+    _instance.debugUtils =
+        std::any_of(_instance.availableExtensions.begin(), _instance.availableExtensions.end(),
+                    [](const char* _enabled)
+                    { return strcmp(_enabled, VK_EXT_DEBUG_UTILS_EXTENSION_NAME) == 0; });
 
-#if defined(MOSAIC_DEBUG_BUILD) || defined(MOSAIC_DEV_BUILD)
-    VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo = populateDebugMessengerCreateInfoEXT();
+    if (_validation && !_instance.validation)
+    {
+        MOSAIC_WARN("The Vulkan validation layer is not installed, running without it!");
+    }
+
+    const bool messenger = _instance.validation && _instance.debugUtils;
 
-    debugCreateInfoPtr = &debugCreateInfo;
-#endif
+    VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo = populateDebugMessengerCreateInfoEXT();
+    void* debugCreateInfoPtr = messenger ? &debugCreateInfo : nullptr;
 
     const VkInstanceCreateInfo createInfo = {
         .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
@@ -220,16 +240,12 @@ void createInstance(Instance& _instance)
 
     volkLoadInstance(_instance.instance);
 
-#if defined(MOSAIC_DEBUG_BUILD) || defined(MOSAIC_DEV_BUILD)
-    createDebugMessenger(_instance);
-#endif
+    if (messenger) createDebugMessenger(_instance);
 }
 
 void destroyInstance(Instance& _instance)
 {
-#if defined(MOSAIC_DEBUG_BUILD) || defined(MOSAIC_DEV_BUILD)
-    destroyDebugMessenger(_instance);
-#endif
+    if (_instance.debugMessenger) destroyDebugMessenger(_instance);
 
     vkDestroyInstance(_instance.instance, nullptr);
 }
@@ -18,8 +18,10 @@ struct Instance
     std::vector<const char*> availableExtensions;
     std::vector<const char*> requiredLayers;
     std::vector<const char*> availableLayers;
+    bool validation; // the validation layer enabled, its messages logged
+    bool debugUtils; // VK_EXT_debug_utils enabled: the labels and the object names
 
-    Instance() : instance(nullptr), debugMessenger(nullptr)
+    Instance() : instance(nullptr), debugMessenger(nullptr), validation(false), debugUtils(false)
     {
         requiredExtensions = {
             VK_KHR_SURFACE_EXTENSION_NAME,
@@ -35,19 +37,12 @@ struct Instance
         optionalExtensions = {
             VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME,
         };
-
-#if defined(MOSAIC_DEBUG_BUILD) || defined(MOSAIC_DEV_BUILD)
-        requiredExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-        requiredExtensions.emplace_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
-
-        requiredLayers = {
-            "VK_LAYER_KHRONOS_validation",
-        };
-#endif
     }
 };
 
-void createInstance(Instance& _instance);
+// With _validation the validation layer and its messenger, with _debugUtils (implied by
+// _validation) the debug utils extension if the loader has it.
+void createInstance(Instance& _instance, bool _validation, bool _debugUtils);
 
 void destroyInstance(Instance& _instance);
 
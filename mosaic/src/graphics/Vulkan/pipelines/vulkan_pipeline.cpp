@@ -1,5 +1,9 @@
 #include "vulkan_pipeline.hpp"
 
+#include <cstddef>
+
+#include "mosaic/graphics/shader_reflection.hpp"
+
 namespace mosaic
 {
 namespace graphics
@@ -7,83 +11,278 @@ namespace graphics
 namespace vulkan
 {
 
-void createGraphicsPipeline(Pipeline& _pipeline, const Device& _device, const Swapchain& _swapchain,
-                            const RenderPass& _renderPass)
+static VkShaderStageFlagBits getShaderStage(ShaderStage _stage)
+{
+    switch (_stage)
+    {
+        case ShaderStage::Vertex:
+            return VK_SHADER_STAGE_VERTEX_BIT;
+        case ShaderStage::Fragment:
+            return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case ShaderStage::Task:
+            return VK_SHADER_STAGE_TASK_BIT_EXT;
+        case ShaderStage::Mesh:
+            return VK_SHADER_STAGE_MESH_BIT_EXT;
+        case ShaderStage::Compute:
+        default:
+            return VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+}
+
+static VkFormat getVertexFormat(TextureFormat _format)
+{
+    switch (_format)
+    {
+        case TextureFormat::RGBA8:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        case TextureFormat::BGRA8:
+            return VK_FORMAT_B8G8R8A8_UNORM;
+        case TextureFormat::RGBA16F:
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        default:
+            throw std::runtime_error("unsupported vertex attribute format!");
+    }
+}
+
+static VkPrimitiveTopology getTopology(PrimitiveTopology _topology)
+{
+    switch (_topology)
+    {
+        case PrimitiveTopology::TriangleStrip:
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+        case PrimitiveTopology::LineList:
+            return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        case PrimitiveTopology::TriangleList:
+        default:
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    }
+}
+
+static VkCullModeFlags getCullMode(CullMode _cullMode)
+{
+    switch (_cullMode)
+    {
+        case CullMode::None:
+            return VK_CULL_MODE_NONE;
+        case CullMode::Front:
+            return VK_CULL_MODE_FRONT_BIT;
+        case CullMode::Back:
+        default:
+            return VK_CULL_MODE_BACK_BIT;
+    }
+}
+
+// What the shader declares against the layout every pipeline has: set 0 the resource table, if
+// any, and _pushConstantsSize bytes of push constants
+static void validateShaderLayout(const ShaderDescription& _shader, uint32_t _pushConstantsSize,
+                                 VkDescriptorSetLayout _resourceLayout)
+{
+    auto result = reflectShader(_shader.bytecode, _shader.entryPoint);
+    if (result.isErr())
+    {
+        throw std::runtime_error("failed to reflect shader " + _shader.debugName + ": " +
+                                 result.error() + "!");
+    }
+
+    const ShaderReflection& reflection = result.unwrap();
+
+    if (reflection.stage != _shader.stage)
+    {
+        throw std::runtime_error("shader " + _shader.debugName + " is not of its stage!");
+    }
+
+    if (reflection.pushConstantSize > _pushConstantsSize)
+    {
+        throw std::runtime_error("push constants of shader " + _shader.debugName +
+                                 " exceed those of the pipeline layout!");
+    }
+
+    for (const ShaderBinding& binding : reflection.bindings)
+    {
+        if (binding.set != 0 || _resourceLayout == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("shader " + _shader.debugName + " binds " + binding.name +
+                                     " to a set the pipeline layout does not have!");
+        }
+    }
+}
+
+// Owned by the cache if any, by _owned otherwise (destroyed once the pipeline is created)
+static VkShaderModule getShaderModule(const Device& _device, const ShaderDescription& _shader,
+                                      ShaderModuleCache* _shaderModules, ShaderModule& _owned)
+{
+    if (_shaderModules) return acquireShaderModule(*_shaderModules, _shader);
+
+    createShaderModule(_owned, _device.device, _shader);
+    return _owned.shaderModule;
+}
+
+// The layout of set 0 _resourceLayout (if any) and of _pushConstants (size 0 for none): that of
+// _layouts shared with the pipelines of the same layout if any, else the pipeline's own.
+static bool createPipelineLayout(Pipeline& _pipeline, const Device& _device,
+                                 VkDescriptorSetLayout _resourceLayout,
+                                 const VkPushConstantRange& _pushConstants, LayoutCache* _layouts)
+{
+    const uint32_t setLayoutCount = _resourceLayout != VK_NULL_HANDLE ? 1 : 0;
+
+    if (_layouts)
+    {
+        _pipeline.pipelineLayout = acquirePipelineLayout(
+            *_layouts, std::span(&_resourceLayout, setLayoutCount), _pushConstants);
+        _pipeline.sharedLayout = true;
+        return true;
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = setLayoutCount;
+    pipelineLayoutInfo.pSetLayouts = setLayoutCount > 0 ? &_resourceLayout : nullptr;
+    pipelineLayoutInfo.pushConstantRangeCount = _pushConstants.size > 0 ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = _pushConstants.size > 0 ? &_pushConstants : nullptr;
+
+    _pipeline.sharedLayout = false;
+    return vkCreatePipelineLayout(_device.device, &pipelineLayoutInfo, nullptr,
+                                  &_pipeline.pipelineLayout) == VK_SUCCESS;
+}
+
+// The constants of _shader, pointing into its specialization: nullptr without any
+static const VkSpecializationInfo* fillSpecializationInfo(
+    const ShaderDescription& _shader, std::vector<VkSpecializationMapEntry>& _entries,
+    VkSpecializationInfo& _info)
+{
+    if (_shader.specialization.empty()) return nullptr;
+
+    for (size_t i = 0; i < _shader.specialization.size(); ++i)
+    {
+        const auto offset = static_cast<uint32_t>(i * sizeof(SpecializationConstant) +
+                                                  offsetof(SpecializationConstant, value));
+        _entries.push_back({_shader.specialization[i].id, offset, sizeof(uint32_t)});
+    }
+
+    _info.mapEntryCount = static_cast<uint32_t>(_entries.size());
+    _info.pMapEntries = _entries.data();
+    _info.dataSize = _shader.specialization.size() * sizeof(SpecializationConstant);
+    _info.pData = _shader.specialization.data();
+
+    return &_info;
+}
+
+// The create infos of a description, pointing into each other: filled in place, the shader
+// stages only of _stages
+struct GraphicsPipelineState
 {
-    ShaderModule vertShaderModule;
-    createShaderModule(vertShaderModule, _device.device, "shaders/bin/triangle.vert.spv");
-    ShaderModule fragShaderModule;
-    createShaderModule(fragShaderModule, _device.device, "shaders/bin/triangle.frag.spv");
+    std::vector<ShaderModule> shaderModules; // those owned, destroyed with the state
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+    std::vector<std::vector<VkSpecializationMapEntry>> specializationEntries; // by shader
+    std::vector<VkSpecializationInfo> specializations;
+    std::vector<VkDynamicState> dynamicStates;
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    VkVertexInputBindingDescription binding{};
+    std::vector<VkVertexInputAttributeDescription> attributes;
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    VkPipelineViewportStateCreateInfo viewportState{};
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+    VkPipelineRenderingCreateInfo renderingInfo{};
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+
+    GraphicsPipelineState() = default;
+    GraphicsPipelineState(const GraphicsPipelineState&) = delete;
+    GraphicsPipelineState& operator=(const GraphicsPipelineState&) = delete;
+
+    ~GraphicsPipelineState()
+    {
+        for (ShaderModule& shaderModule : shaderModules) destroyShaderModule(shaderModule);
+    }
+};
 
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule.shaderModule;
-    vertShaderStageInfo.pName = "main";
+static void fillGraphicsPipelineState(GraphicsPipelineState& _state, const Device& _device,
+                                      const PipelineDescription& _description,
+                                      VkFormat _colorFormat, VkRenderPass _renderPass,
+                                      VkShaderStageFlags _stages,
+                                      ShaderModuleCache* _shaderModules)
+{
+    _state.shaderModules.resize(_description.shaders.size());
+    _state.specializationEntries.resize(_description.shaders.size());
+    _state.specializations.resize(_description.shaders.size());
 
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule.shaderModule;
-    fragShaderStageInfo.pName = "main";
+    for (size_t i = 0; i < _description.shaders.size(); ++i)
+    {
+        const ShaderDescription& shader = _description.shaders[i];
+        if (!(getShaderStage(shader.stage) & _stages)) continue;
 
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+        VkPipelineShaderStageCreateInfo& stage = _state.shaderStages.emplace_back();
+        stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage.stage = getShaderStage(shader.stage);
+        stage.module = getShaderModule(_device, shader, _shaderModules, _state.shaderModules[i]);
+        stage.pName = shader.entryPoint.c_str();
+        stage.pSpecializationInfo = fillSpecializationInfo(
+            shader, _state.specializationEntries[i], _state.specializations[i]);
+    }
 
-    std::vector<VkDynamicState> dynamicStates = {
+    _state.dynamicStates = {
         VK_DYNAMIC_STATE_VIEWPORT,
         VK_DYNAMIC_STATE_SCISSOR,
     };
 
-    VkPipelineDynamicStateCreateInfo dynamicState{};
+    VkPipelineDynamicStateCreateInfo& dynamicState = _state.dynamicState;
     dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-    dynamicState.pDynamicStates = dynamicStates.data();
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(_state.dynamicStates.size());
+    dynamicState.pDynamicStates = _state.dynamicStates.data();
 
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    const VertexLayout& layout = _description.vertexLayout;
+
+    _state.binding.binding = 0;
+    _state.binding.stride = layout.stride;
+    _state.binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    for (const VertexInputAttribute& attribute : layout.attributes)
+    {
+        _state.attributes.push_back(
+            {attribute.location, 0, getVertexFormat(attribute.format), attribute.offset});
+    }
+
+    VkPipelineVertexInputStateCreateInfo& vertexInputInfo = _state.vertexInput;
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.pVertexBindingDescriptions = nullptr;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-    vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+    vertexInputInfo.vertexBindingDescriptionCount = layout.stride > 0 ? 1 : 0;
+    vertexInputInfo.pVertexBindingDescriptions = layout.stride > 0 ? &_state.binding : nullptr;
+    vertexInputInfo.vertexAttributeDescriptionCount =
+        static_cast<uint32_t>(_state.attributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = _state.attributes.data();
 
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    VkPipelineInputAssemblyStateCreateInfo& inputAssembly = _state.inputAssembly;
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.topology = getTopology(_description.topology);
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(_swapchain.extent.width);
-    viewport.height = static_cast<float>(_swapchain.extent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = _swapchain.extent;
-
-    VkPipelineViewportStateCreateInfo viewportState{};
+    // Dynamic, only the counts matter
+    VkPipelineViewportStateCreateInfo& viewportState = _state.viewportState;
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
 
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    VkPipelineRasterizationStateCreateInfo& rasterizer = _state.rasterizer;
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizer.depthClampEnable = VK_FALSE;
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.polygonMode = _description.rasterState.fillMode == FillMode::Wireframe
+                                 ? VK_POLYGON_MODE_LINE
+                                 : VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    rasterizer.cullMode = getCullMode(_description.rasterState.cullMode);
+    rasterizer.frontFace = _description.rasterState.frontFaceCCW
+                               ? VK_FRONT_FACE_COUNTER_CLOCKWISE
+                               : VK_FRONT_FACE_CLOCKWISE;
     rasterizer.depthBiasEnable = VK_FALSE;
     rasterizer.depthBiasConstantFactor = 0.0f;
     rasterizer.depthBiasClamp = 0.0f;
     rasterizer.depthBiasSlopeFactor = 0.0f;
 
-    VkPipelineMultisampleStateCreateInfo multisampling{};
+    VkPipelineMultisampleStateCreateInfo& multisampling = _state.multisampling;
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampling.sampleShadingEnable = VK_FALSE;
     multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
@@ -91,18 +290,25 @@ void createGraphicsPipeline(Pipeline& _pipeline, const Device& _device, const Sw
     multisampling.pSampleMask = nullptr;
     multisampling.alphaToCoverageEnable = VK_FALSE;
 
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    VkPipelineColorBlendAttachmentState& colorBlendAttachment = _state.colorBlendAttachment;
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.blendEnable = _description.blendState.enable ? VK_TRUE : VK_FALSE;
+    // Straight alpha when enabled
+    colorBlendAttachment.srcColorBlendFactor = _description.blendState.enable
+                                                   ? VK_BLEND_FACTOR_SRC_ALPHA
+                                                   : VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = _description.blendState.enable
+                                                   ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA
+                                                   : VK_BLEND_FACTOR_ZERO;
     colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
     colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.dstAlphaBlendFactor = _description.blendState.enable
+                                                   ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA
+                                                   : VK_BLEND_FACTOR_ZERO;
     colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    VkPipelineColorBlendStateCreateInfo& colorBlending = _state.colorBlending;
     colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     colorBlending.logicOpEnable = VK_FALSE;
     colorBlending.logicOp = VK_LOGIC_OP_COPY;
@@ -113,23 +319,16 @@ void createGraphicsPipeline(Pipeline& _pipeline, const Device& _device, const Sw
     colorBlending.blendConstants[2] = 0.0f;
     colorBlending.blendConstants[3] = 0.0f;
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pSetLayouts = nullptr;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+    _state.colorFormat = _colorFormat;
+    _state.renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    _state.renderingInfo.colorAttachmentCount = 1;
+    _state.renderingInfo.pColorAttachmentFormats = &_state.colorFormat;
 
-    if (vkCreatePipelineLayout(_device.device, &pipelineLayoutInfo, nullptr,
-                               &_pipeline.pipelineLayout) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
-
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    VkGraphicsPipelineCreateInfo& pipelineInfo = _state.pipelineInfo;
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pNext = _renderPass == VK_NULL_HANDLE ? &_state.renderingInfo : nullptr;
+    pipelineInfo.stageCount = static_cast<uint32_t>(_state.shaderStages.size());
+    pipelineInfo.pStages = _state.shaderStages.data();
     pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
@@ -137,24 +336,207 @@ void createGraphicsPipeline(Pipeline& _pipeline, const Device& _device, const Sw
     pipelineInfo.pMultisampleState = &multisampling;
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = _pipeline.pipelineLayout;
-    pipelineInfo.renderPass = _renderPass.renderPass;
+    pipelineInfo.renderPass = _renderPass;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+}
+
+// The layout of every graphics pipeline: set 0 the resource table, the DrawCall push constants
+static void createGraphicsPipelineLayout(Pipeline& _pipeline, const Device& _device,
+                                         VkDescriptorSetLayout _resourceLayout,
+                                         LayoutCache* _layouts)
+{
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = k_resourceStages;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(DrawCall::resources);
+
+    if (!createPipelineLayout(_pipeline, _device, _resourceLayout, pushConstantRange, _layouts))
+    {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+}
+
+void createGraphicsPipeline(Pipeline& _pipeline, const Device& _device,
+                            const PipelineDescription& _description, VkFormat _colorFormat,
+                            VkRenderPass _renderPass, VkPipelineCache _cache,
+                            VkDescriptorSetLayout _resourceLayout,
+                            ShaderModuleCache* _shaderModules, LayoutCache* _layouts)
+{
+    for (const ShaderDescription& shader : _description.shaders)
+    {
+        validateShaderLayout(shader, sizeof(DrawCall::resources), _resourceLayout);
+    }
+
+    GraphicsPipelineState state;
+    fillGraphicsPipelineState(state, _device, _description, _colorFormat, _renderPass,
+                              VK_SHADER_STAGE_ALL_GRAPHICS, _shaderModules);
+
+    createGraphicsPipelineLayout(_pipeline, _device, _resourceLayout, _layouts);
+    state.pipelineInfo.layout = _pipeline.pipelineLayout;
+
+    const VkResult result = vkCreateGraphicsPipelines(_device.device, _cache, 1,
+                                                      &state.pipelineInfo, nullptr,
+                                                      &_pipeline.pipeline);
+
+    if (result != VK_SUCCESS) throw std::runtime_error("failed to create graphics pipeline!");
+
+    setObjectName(_device, VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(_pipeline.pipeline),
+                  _description.debugName.c_str());
+}
+
+void createMeshPipeline(Pipeline& _pipeline, const Device& _device,
+                        const PipelineDescription& _description, VkFormat _colorFormat,
+                        VkRenderPass _renderPass, uint32_t _pushConstantsSize,
+                        VkPipelineCache _cache, VkDescriptorSetLayout _resourceLayout,
+                        ShaderModuleCache* _shaderModules, LayoutCache* _layouts)
+{
+    constexpr VkShaderStageFlags stages =
+        VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    for (const ShaderDescription& shader : _description.shaders)
+    {
+        validateShaderLayout(shader, _pushConstantsSize, _resourceLayout);
+    }
+
+    GraphicsPipelineState state;
+    fillGraphicsPipelineState(state, _device, _description, _colorFormat, _renderPass, stages,
+                              _shaderModules);
+
+    // the mesh shaders assemble the primitives themselves
+    state.pipelineInfo.pVertexInputState = nullptr;
+    state.pipelineInfo.pInputAssemblyState = nullptr;
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = stages;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = _pushConstantsSize;
+
+    if (!createPipelineLayout(_pipeline, _device, _resourceLayout, pushConstantRange, _layouts))
+    {
+        throw std::runtime_error("failed to create mesh pipeline layout!");
+    }
+
+    state.pipelineInfo.layout = _pipeline.pipelineLayout;
+
+    const VkResult result = vkCreateGraphicsPipelines(_device.device, _cache, 1,
+                                                      &state.pipelineInfo, nullptr,
+                                                      &_pipeline.pipeline);
 
-    if (vkCreateGraphicsPipelines(_device.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
+    if (result != VK_SUCCESS) throw std::runtime_error("failed to create mesh pipeline!");
+
+    setObjectName(_device, VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(_pipeline.pipeline),
+                  _description.debugName.c_str());
+}
+
+static VkGraphicsPipelineLibraryFlagsEXT getLibraryFlags(GraphicsPipelinePart _part)
+{
+    switch (_part)
+    {
+        case GraphicsPipelinePart::VertexInput:
+            return VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+        case GraphicsPipelinePart::PreRasterization:
+            return VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+        case GraphicsPipelinePart::FragmentShader:
+            return VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+        case GraphicsPipelinePart::FragmentOutput:
+        default:
+            return VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+    }
+}
+
+static VkShaderStageFlags getPartStages(GraphicsPipelinePart _part)
+{
+    switch (_part)
+    {
+        case GraphicsPipelinePart::PreRasterization:
+            return VK_SHADER_STAGE_ALL_GRAPHICS & ~VK_SHADER_STAGE_FRAGMENT_BIT;
+        case GraphicsPipelinePart::FragmentShader:
+            return VK_SHADER_STAGE_FRAGMENT_BIT;
+        default:
+            return 0;
+    }
+}
+
+void createGraphicsPipelinePart(Pipeline& _part, const Device& _device,
+                                const PipelineDescription& _description,
+                                GraphicsPipelinePart _kind, VkFormat _colorFormat,
+                                VkRenderPass _renderPass, VkPipelineCache _cache,
+                                VkDescriptorSetLayout _resourceLayout,
+                                ShaderModuleCache* _shaderModules, LayoutCache* _layouts)
+{
+    const VkShaderStageFlags stages = getPartStages(_kind);
+
+    for (const ShaderDescription& shader : _description.shaders)
+    {
+        if (!(getShaderStage(shader.stage) & stages)) continue;
+
+        validateShaderLayout(shader, sizeof(DrawCall::resources), _resourceLayout);
+    }
+
+    GraphicsPipelineState state;
+    fillGraphicsPipelineState(state, _device, _description, _colorFormat, _renderPass, stages,
+                              _shaderModules);
+
+    // the state of the other parts is ignored by the driver
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+    libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+    libraryInfo.pNext = state.pipelineInfo.pNext;
+    libraryInfo.flags = getLibraryFlags(_kind);
+
+    createGraphicsPipelineLayout(_part, _device, _resourceLayout, _layouts);
+
+    state.pipelineInfo.pNext = &libraryInfo;
+    state.pipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+                               VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    state.pipelineInfo.layout = _part.pipelineLayout;
+
+    const VkResult result = vkCreateGraphicsPipelines(_device.device, _cache, 1,
+                                                      &state.pipelineInfo, nullptr,
+                                                      &_part.pipeline);
+
+    if (result != VK_SUCCESS) throw std::runtime_error("failed to create graphics pipeline part!");
+}
+
+void linkGraphicsPipeline(Pipeline& _pipeline, const Device& _device,
+                          std::span<const Pipeline* const> _parts, bool _optimize,
+                          VkPipelineCache _cache, const std::string& _debugName)
+{
+    std::vector<VkPipeline> libraries;
+    for (const Pipeline* part : _parts) libraries.push_back(part->pipeline);
+
+    VkPipelineLibraryCreateInfoKHR libraryInfo{};
+    libraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    libraryInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+    libraryInfo.pLibraries = libraries.data();
+
+    // the layout of the parts, which own it (or their LayoutCache)
+    _pipeline.pipelineLayout = _parts.front()->pipelineLayout;
+    _pipeline.sharedLayout = true;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = &libraryInfo;
+    pipelineInfo.flags = _optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    pipelineInfo.layout = _pipeline.pipelineLayout;
+
+    if (vkCreateGraphicsPipelines(_device.device, _cache, 1, &pipelineInfo, nullptr,
                                   &_pipeline.pipeline) != VK_SUCCESS)
     {
-        throw std::runtime_error("failed to create graphics pipeline!");
+        throw std::runtime_error("failed to link graphics pipeline!");
     }
 
-    vkDestroyShaderModule(_device.device, fragShaderModule.shaderModule, nullptr);
-    vkDestroyShaderModule(_device.device, vertShaderModule.shaderModule, nullptr);
+    setObjectName(_device, VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(_pipeline.pipeline),
+                  _debugName.c_str());
 }
 
 void destroyGraphicsPipeline(Pipeline& _pipeline, const Device& _device)
 {
-    vkDestroyPipelineLayout(_device.device, _pipeline.pipelineLayout, nullptr);
+    if (!_pipeline.sharedLayout)
+    {
+        vkDestroyPipelineLayout(_device.device, _pipeline.pipelineLayout, nullptr);
+    }
+
     vkDestroyPipeline(_device.device, _pipeline.pipeline, nullptr);
 }
 
@@ -163,6 +545,58 @@ void bindGraphicsPipeline(const Pipeline& _pipeline, const CommandBuffer& _comma
     vkCmdBindPipeline(_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline.pipeline);
 }
 
+void createComputePipeline(Pipeline& _pipeline, const Device& _device,
+                           const ShaderDescription& _shader, uint32_t _pushConstantsSize,
+                           VkPipelineCache _cache, VkDescriptorSetLayout _resourceLayout,
+                           ShaderModuleCache* _shaderModules, LayoutCache* _layouts)
+{
+    validateShaderLayout(_shader, _pushConstantsSize, _resourceLayout);
+
+    ShaderModule shaderModule;
+
+    VkPipelineShaderStageCreateInfo shaderStage{};
+    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStage.module = getShaderModule(_device, _shader, _shaderModules, shaderModule);
+    shaderStage.pName = _shader.entryPoint.c_str();
+
+    std::vector<VkSpecializationMapEntry> specializationEntries;
+    VkSpecializationInfo specialization{};
+    shaderStage.pSpecializationInfo =
+        fillSpecializationInfo(_shader, specializationEntries, specialization);
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = _pushConstantsSize;
+
+    if (!createPipelineLayout(_pipeline, _device, _resourceLayout, pushConstantRange, _layouts))
+    {
+        destroyShaderModule(shaderModule);
+        throw std::runtime_error("failed to create compute pipeline layout!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shaderStage;
+    pipelineInfo.layout = _pipeline.pipelineLayout;
+
+    const VkResult result = vkCreateComputePipelines(_device.device, _cache, 1, &pipelineInfo,
+                                                     nullptr, &_pipeline.pipeline);
+
+    destroyShaderModule(shaderModule);
+
+    if (result != VK_SUCCESS) throw std::runtime_error("failed to create compute pipeline!");
+
+    setObjectName(_device, VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(_pipeline.pipeline),
+                  _shader.debugName.c_str());
+}
+
+void bindComputePipeline(const Pipeline& _pipeline, const CommandBuffer& _commandBuffer)
+{
+    vkCmdBindPipeline(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline.pipeline);
+}
+
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <span>
+#include <string>
+
+#include "mosaic/graphics/draw_call.hpp"
+#include "mosaic/graphics/pipeline.hpp"
+
 #include "../context/vulkan_device.hpp"
-#include "../vulkan_swapchain.hpp"
-#include "../commands/vulkan_render_pass.hpp"
+#include "../commands/vulkan_command_buffer.hpp"
+#include "../vulkan_descriptor_cache.hpp"
 #include "vulkan_shader_module.hpp"
 
 namespace mosaic
@@ -12,22 +18,94 @@ namespace graphics
 namespace vulkan
 {
 
+// The stages the resource set and the push constants (DrawCall::resources) are visible to
+constexpr VkShaderStageFlags k_resourceStages =
+    VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+
 struct Pipeline
 {
     VkDevice device;
     VkPipeline pipeline;
     VkPipelineLayout pipelineLayout;
+    bool sharedLayout; // owned by a LayoutCache, not destroyed with the pipeline
+
+    Pipeline()
+        : device(VK_NULL_HANDLE),
+          pipeline(VK_NULL_HANDLE),
+          pipelineLayout(VK_NULL_HANDLE),
+          sharedLayout(false)
+    {
+    }
+};
+
+// Viewport and scissor are dynamic. The pipeline is compatible with every render pass of the
+// attachment formats of _renderPass, which may be destroyed once it returns; without one (dynamic
+// rendering) with the vkCmdBeginRendering() of a _colorFormat attachment. Its layout has
+// _resourceLayout (the ResourceTable) as set 0, if any, and the push constants of a DrawCall:
+// the bindings and push constants reflected from the shaders must fit in it. The shader modules
+// come from _shaderModules if any, else are created for the pipeline only; the layout likewise
+// from _layouts, shared by the pipelines of the same layout.
+void createGraphicsPipeline(Pipeline& _pipeline, const Device& _device,
+                            const PipelineDescription& _description, VkFormat _colorFormat,
+                            VkRenderPass _renderPass, VkPipelineCache _cache = VK_NULL_HANDLE,
+                            VkDescriptorSetLayout _resourceLayout = VK_NULL_HANDLE,
+                            ShaderModuleCache* _shaderModules = nullptr,
+                            LayoutCache* _layouts = nullptr);
 
-    Pipeline() : device(VK_NULL_HANDLE), pipeline(VK_NULL_HANDLE), pipelineLayout(VK_NULL_HANDLE) {}
+// A pipeline of task (optional), mesh and fragment shaders (Device::meshShader), as
+// createGraphicsPipeline() otherwise but for the vertex layout and the topology, which it has
+// none of, and its _pushConstantsSize bytes of push constants, visible to those three stages.
+void createMeshPipeline(Pipeline& _pipeline, const Device& _device,
+                        const PipelineDescription& _description, VkFormat _colorFormat,
+                        VkRenderPass _renderPass, uint32_t _pushConstantsSize,
+                        VkPipelineCache _cache = VK_NULL_HANDLE,
+                        VkDescriptorSetLayout _resourceLayout = VK_NULL_HANDLE,
+                        ShaderModuleCache* _shaderModules = nullptr,
+                        LayoutCache* _layouts = nullptr);
+
+// The parts of VK_EXT_graphics_pipeline_library, each compiled from some of a description
+enum class GraphicsPipelinePart
+{
+    VertexInput,      // the vertex layout and the topology
+    PreRasterization, // the vertex shaders and the raster state
+    FragmentShader,   // the fragment shaders
+    FragmentOutput    // the blend state and the color format
 };
 
-void createGraphicsPipeline(Pipeline& _pipeline, const Device& _device, const Swapchain& _swapchain,
-                            const RenderPass& _renderPass);
+constexpr size_t k_graphicsPipelinePartsCount = 4;
+
+// A pipeline library of the state of _kind only, as createGraphicsPipeline() would compile it,
+// its link-time optimization info retained. Destroyed with destroyGraphicsPipeline().
+void createGraphicsPipelinePart(Pipeline& _part, const Device& _device,
+                                const PipelineDescription& _description,
+                                GraphicsPipelinePart _kind, VkFormat _colorFormat,
+                                VkRenderPass _renderPass, VkPipelineCache _cache = VK_NULL_HANDLE,
+                                VkDescriptorSetLayout _resourceLayout = VK_NULL_HANDLE,
+                                ShaderModuleCache* _shaderModules = nullptr,
+                                LayoutCache* _layouts = nullptr);
+
+// The pipeline of one part of each kind, of the same layout, which it uses without owning: fast
+// to link, or slow and as fast to draw with as createGraphicsPipeline()'s when _optimize. The
+// parts may be destroyed once it returns, the layout they own (if not shared) may not.
+void linkGraphicsPipeline(Pipeline& _pipeline, const Device& _device,
+                          std::span<const Pipeline* const> _parts, bool _optimize,
+                          VkPipelineCache _cache, const std::string& _debugName);
 
 void destroyGraphicsPipeline(Pipeline& _pipeline, const Device& _device);
 
 void bindGraphicsPipeline(const Pipeline& _pipeline, const CommandBuffer& _commandBuffer);
 
+// _pushConstantsSize bytes of push constants, and _resourceLayout as set 0 if any, validated
+// against the shader like a graphics pipeline. Destroyed with destroyGraphicsPipeline().
+void createComputePipeline(Pipeline& _pipeline, const Device& _device,
+                           const ShaderDescription& _shader, uint32_t _pushConstantsSize,
+                           VkPipelineCache _cache = VK_NULL_HANDLE,
+                           VkDescriptorSetLayout _resourceLayout = VK_NULL_HANDLE,
+                           ShaderModuleCache* _shaderModules = nullptr,
+                           LayoutCache* _layouts = nullptr);
+
+void bindComputePipeline(const Pipeline& _pipeline, const CommandBuffer& _commandBuffer);
+
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
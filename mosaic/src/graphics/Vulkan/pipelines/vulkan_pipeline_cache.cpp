@@ -0,0 +1,131 @@
+#include "vulkan_pipeline_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+static std::vector<char> readCacheFile(const std::filesystem::path& _path)
+{
+    std::ifstream file(_path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) return {};
+
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+
+    file.seekg(0);
+    file.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+    return file ? data : std::vector<char>{};
+}
+
+// Some drivers crash on the data of another device (or version) instead of ignoring it
+static bool matchesDevice(const std::vector<char>& _data, const VkPhysicalDeviceProperties& _props)
+{
+    VkPipelineCacheHeaderVersionOne header{};
+    if (_data.size() < sizeof(header)) return false;
+
+    std::memcpy(&header, _data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == _props.vendorID && header.deviceID == _props.deviceID &&
+           std::memcmp(header.pipelineCacheUUID, _props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void createPipelineCache(PipelineCache& _cache, const Device& _device,
+                         const std::filesystem::path& _directory)
+{
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(_device.physicalDevice, &properties);
+
+    std::string uuid;
+    for (const uint8_t byte : properties.pipelineCacheUUID) uuid += fmt::format("{:02x}", byte);
+
+    _cache.path = _directory / fmt::format("pipelines_{:04x}_{:04x}_{:08x}_{}.bin",
+                                           properties.vendorID, properties.deviceID,
+                                           properties.driverVersion, uuid);
+
+    std::vector<char> data = readCacheFile(_cache.path);
+
+    if (!data.empty() && !matchesDevice(data, properties))
+    {
+        MOSAIC_WARN("Pipeline cache {} does not match the device, starting empty",
+                    _cache.path.string());
+        data.clear();
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(_device.device, &cacheInfo, nullptr, &_cache.cache) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    MOSAIC_INFO("Pipeline cache {}: {} bytes loaded", _cache.path.string(), data.size());
+}
+
+void savePipelineCache(PipelineCache& _cache, const Device& _device)
+{
+    std::lock_guard lock(_cache.saveMutex);
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(_device.device, _cache.cache, &size, nullptr) != VK_SUCCESS ||
+        size == 0)
+    {
+        return;
+    }
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(_device.device, _cache.cache, &size, data.data()) != VK_SUCCESS)
+    {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(_cache.path.parent_path(), error);
+
+    std::filesystem::path temporary = _cache.path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(size));
+
+        if (!file)
+        {
+            MOSAIC_WARN("Failed to write the pipeline cache {}", temporary.string());
+            return;
+        }
+    }
+
+    std::filesystem::rename(temporary, _cache.path, error);
+    if (error) MOSAIC_WARN("Failed to save the pipeline cache: {}", error.message());
+}
+
+void destroyPipelineCache(PipelineCache& _cache, const Device& _device)
+{
+    if (_cache.cache == VK_NULL_HANDLE) return;
+
+    savePipelineCache(_cache, _device);
+
+    vkDestroyPipelineCache(_device.device, _cache.cache, nullptr);
+    _cache.cache = VK_NULL_HANDLE;
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+
+#include "../context/vulkan_device.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief A VkPipelineCache persisted to disk, one file per device and driver: the name holds the
+ * vendor, device and driver version and the pipeline cache UUID, so an updated driver starts
+ * from an empty cache instead of handing back blobs it cannot use.
+ *
+ * The cache is internally synchronized, workers compile through it concurrently.
+ */
+struct PipelineCache
+{
+    VkPipelineCache cache;
+    std::filesystem::path path;
+    std::mutex saveMutex; // saves from the workers compiling
+
+    PipelineCache() : cache(VK_NULL_HANDLE){};
+};
+
+// Loads the file of the device from _directory if its header matches the device, empty otherwise.
+void createPipelineCache(PipelineCache& _cache, const Device& _device,
+                         const std::filesystem::path& _directory);
+
+// Written next to the file then renamed over it, a crash mid-save leaves the previous one.
+void savePipelineCache(PipelineCache& _cache, const Device& _device);
+
+// Saves first.
+void destroyPipelineCache(PipelineCache& _cache, const Device& _device);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,312 @@
+#include "vulkan_pipeline_library.hpp"
+
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "mosaic/exec/thread_pool.hpp"
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+static uint64_t getKey(const PipelineDescription& _description, VkFormat _colorFormat)
+{
+    constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    return (hashPipelineDescription(_description) ^ static_cast<uint64_t>(_colorFormat)) *
+           FNV_PRIME;
+}
+
+// Under the mutex of the library; none with dynamic rendering
+static VkRenderPass getRenderPass(PipelineLibrary& _library, VkFormat _colorFormat)
+{
+    if (_library.device->dynamicRendering) return VK_NULL_HANDLE;
+
+    auto [it, inserted] = _library.renderPasses.try_emplace(_colorFormat);
+    if (inserted) createRenderPass(it->second, *_library.device, _colorFormat);
+
+    return it->second.renderPass;
+}
+
+// What the part of _kind is compiled from, the shaders by their hash (no bytecode copied): the
+// pipelines of the same vertex shader share their pre-rasterization part...
+static uint64_t getPartKey(const PipelineDescription& _description, GraphicsPipelinePart _kind,
+                           VkFormat _colorFormat)
+{
+    constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    PipelineDescription state;
+    uint64_t shaders = 0;
+
+    const auto hashShaders = [&](ShaderStage _stage)
+    {
+        for (const ShaderDescription& shader : _description.shaders)
+        {
+            if (shader.stage != _stage) continue;
+
+            shaders = (shaders ^ hashShaderBytecode(shader.bytecode) ^
+                       std::hash<std::string>{}(shader.entryPoint)) *
+                      FNV_PRIME;
+
+            for (const SpecializationConstant& constant : shader.specialization)
+            {
+                shaders = (shaders ^ (uint64_t{constant.id} << 32 | constant.value)) * FNV_PRIME;
+            }
+        }
+    };
+
+    switch (_kind)
+    {
+        case GraphicsPipelinePart::VertexInput:
+            state.vertexLayout = _description.vertexLayout;
+            state.topology = _description.topology;
+            break;
+        case GraphicsPipelinePart::PreRasterization:
+            state.rasterState = _description.rasterState;
+            state.topology = _description.topology;
+            hashShaders(ShaderStage::Vertex);
+            break;
+        case GraphicsPipelinePart::FragmentShader:
+            state.depthState = _description.depthState;
+            hashShaders(ShaderStage::Fragment);
+            break;
+        case GraphicsPipelinePart::FragmentOutput:
+            state.blendState = _description.blendState;
+            break;
+    }
+
+    // every part but the vertex input one knows the attachments
+    const VkFormat format =
+        _kind == GraphicsPipelinePart::VertexInput ? VK_FORMAT_UNDEFINED : _colorFormat;
+
+    return (((hashPipelineDescription(state) ^ shaders) * FNV_PRIME ^
+             static_cast<uint64_t>(_kind)) *
+                FNV_PRIME ^
+            static_cast<uint64_t>(format)) *
+           FNV_PRIME;
+}
+
+// Under the mutex of the library, made the first time it is asked for
+static const Pipeline& getPart(PipelineLibrary& _library, const PipelineDescription& _description,
+                               GraphicsPipelinePart _kind, VkFormat _colorFormat,
+                               VkRenderPass _renderPass)
+{
+    auto [it, inserted] =
+        _library.parts.try_emplace(getPartKey(_description, _kind, _colorFormat));
+
+    if (inserted)
+    {
+        try
+        {
+            createGraphicsPipelinePart(it->second, *_library.device, _description, _kind,
+                                       _colorFormat, _renderPass, _library.cache.cache,
+                                       _library.resourceLayout, &_library.shaderModules,
+                                       &_library.layouts);
+        }
+        catch (...)
+        {
+            _library.parts.erase(it);
+            throw;
+        }
+    }
+
+    return it->second;
+}
+
+// Under the mutex of the library: the parts of the entry and the pipeline linked from them
+// without optimizations, at once. On failure the worker compiles the whole pipeline instead.
+static void linkEntry(PipelineLibrary& _library, PipelineLibrary::Entry& _entry,
+                      const PipelineDescription& _description, VkFormat _colorFormat,
+                      VkRenderPass _renderPass)
+{
+    try
+    {
+        std::array<const Pipeline*, k_graphicsPipelinePartsCount> parts{};
+        for (size_t kind = 0; kind < parts.size(); ++kind)
+        {
+            parts[kind] = &getPart(_library, _description, static_cast<GraphicsPipelinePart>(kind),
+                                   _colorFormat, _renderPass);
+        }
+
+        linkGraphicsPipeline(_entry.fastLinked, *_library.device, parts, false,
+                             _library.cache.cache, _description.debugName);
+
+        _entry.parts = parts;
+        _entry.fastReady.store(true, std::memory_order_release);
+    }
+    catch (const std::exception& _error)
+    {
+        MOSAIC_WARN("Failed to link pipeline {}: {}", _description.debugName, _error.what());
+    }
+}
+
+// The optimized pipeline if ready, else the fast linked one, else _fallback
+static const Pipeline* getReadyPipeline(const PipelineLibrary::Entry& _entry,
+                                        const Pipeline* _fallback)
+{
+    if (_entry.ready.load(std::memory_order_acquire)) return &_entry.pipeline;
+    if (_entry.fastReady.load(std::memory_order_acquire)) return &_entry.fastLinked;
+
+    return _fallback;
+}
+
+static void compileEntry(PipelineLibrary& _library, PipelineLibrary::Entry& _entry,
+                         const PipelineDescription& _description, VkFormat _colorFormat,
+                         VkRenderPass _renderPass)
+{
+    try
+    {
+        // linked again from the parts, with the link-time optimizations
+        if (_entry.parts.front())
+        {
+            linkGraphicsPipeline(_entry.pipeline, *_library.device, _entry.parts, true,
+                                 _library.cache.cache, _description.debugName);
+        }
+        else
+        {
+            createGraphicsPipeline(_entry.pipeline, *_library.device, _description, _colorFormat,
+                                   _renderPass, _library.cache.cache, _library.resourceLayout,
+                                   &_library.shaderModules, &_library.layouts);
+        }
+        _entry.ready.store(true, std::memory_order_release);
+    }
+    catch (const std::exception& _error)
+    {
+        MOSAIC_ERROR("Failed to compile pipeline {}: {}", _description.debugName, _error.what());
+        _entry.failed.store(true, std::memory_order_release);
+    }
+
+    // the last compilation of a burst (the first frames, a level load) saves the results
+    if (_library.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        savePipelineCache(_library.cache, *_library.device);
+    }
+}
+
+void createPipelineLibrary(PipelineLibrary& _library, const Device& _device,
+                           const std::filesystem::path& _cacheDirectory,
+                           VkDescriptorSetLayout _resourceLayout)
+{
+    _library.device = &_device;
+    _library.resourceLayout = _resourceLayout;
+    createPipelineCache(_library.cache, _device, _cacheDirectory);
+    createShaderModuleCache(_library.shaderModules, _device.device);
+    createLayoutCache(_library.layouts, _device);
+}
+
+void destroyPipelineLibrary(PipelineLibrary& _library)
+{
+    std::lock_guard lock(_library.mutex);
+
+    for (auto& [key, entry] : _library.entries)
+    {
+        if (entry->compilation) entry->compilation->wait();
+    }
+
+    for (auto& [key, entry] : _library.entries)
+    {
+        if (entry->ready.load(std::memory_order_acquire))
+        {
+            destroyGraphicsPipeline(entry->pipeline, *_library.device);
+        }
+
+        if (entry->fastReady.load(std::memory_order_acquire))
+        {
+            destroyGraphicsPipeline(entry->fastLinked, *_library.device);
+        }
+    }
+
+    for (auto& [key, part] : _library.parts) destroyGraphicsPipeline(part, *_library.device);
+
+    for (auto& [format, renderPass] : _library.renderPasses)
+    {
+        destroyRenderPass(renderPass, *_library.device);
+    }
+
+    _library.entries.clear();
+    _library.parts.clear();
+    _library.renderPasses.clear();
+
+    destroyShaderModuleCache(_library.shaderModules);
+    destroyLayoutCache(_library.layouts);
+
+    destroyPipelineCache(_library.cache, *_library.device);
+}
+
+const Pipeline* acquirePipeline(PipelineLibrary& _library, const PipelineDescription& _description,
+                                VkFormat _colorFormat, const Pipeline* _fallback)
+{
+    std::unique_lock lock(_library.mutex);
+
+    auto& slot = _library.entries[getKey(_description, _colorFormat)];
+
+    if (slot) return getReadyPipeline(*slot, _fallback);
+
+    slot = std::make_unique<PipelineLibrary::Entry>();
+    PipelineLibrary::Entry* entry = slot.get();
+
+    const VkRenderPass renderPass = getRenderPass(_library, _colorFormat);
+    _library.pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (_library.device->graphicsPipelineLibrary)
+    {
+        linkEntry(_library, *entry, _description, _colorFormat, renderPass);
+    }
+
+    if (exec::ThreadPool* pool = exec::ThreadPool::getInstance())
+    {
+        // the description is copied, the caller's may not outlive the compilation
+        auto compilation = pool->enqueueToGlobal(
+            [&_library, entry, description = _description, _colorFormat, renderPass]
+            { compileEntry(_library, *entry, description, _colorFormat, renderPass); });
+
+        if (compilation)
+        {
+            entry->compilation = std::move(*compilation);
+            return getReadyPipeline(*entry, _fallback);
+        }
+    }
+
+    lock.unlock();
+    compileEntry(_library, *entry, _description, _colorFormat, renderPass);
+
+    return getReadyPipeline(*entry, _fallback);
+}
+
+const Pipeline& compilePipeline(PipelineLibrary& _library, const PipelineDescription& _description,
+                                VkFormat _colorFormat)
+{
+    std::unique_lock lock(_library.mutex);
+
+    auto& slot = _library.entries[getKey(_description, _colorFormat)];
+
+    if (!slot)
+    {
+        slot = std::make_unique<PipelineLibrary::Entry>();
+        const VkRenderPass renderPass = getRenderPass(_library, _colorFormat);
+        _library.pending.fetch_add(1, std::memory_order_relaxed);
+
+        compileEntry(_library, *slot, _description, _colorFormat, renderPass);
+    }
+    else if (slot->compilation)
+    {
+        slot->compilation->wait();
+    }
+
+    if (!slot->ready.load(std::memory_order_acquire))
+    {
+        throw std::runtime_error("failed to compile pipeline " + _description.debugName + "!");
+    }
+
+    return slot->pipeline;
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
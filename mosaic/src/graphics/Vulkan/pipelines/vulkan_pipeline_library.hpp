@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "mosaic/exec/task_future.hpp"
+#include "mosaic/graphics/pipeline.hpp"
+
+#include "../commands/vulkan_render_pass.hpp"
+#include "vulkan_pipeline.hpp"
+#include "vulkan_pipeline_cache.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The pipelines of a device, compiled once per hashPipelineDescription() and color format
+ * through a persistent PipelineCache, on exec::ThreadPool workers, from the shader modules of a
+ * ShaderModuleCache, with the pipeline layouts of a LayoutCache.
+ *
+ * Pipelines are compiled against a compatibility render pass the library owns for each format,
+ * so they stay valid across swapchain recreations and render graph compilations; with dynamic
+ * rendering (Device::dynamicRendering) against the format alone, no render pass made.
+ *
+ * With VK_EXT_graphics_pipeline_library (Device::graphicsPipelineLibrary) a new pipeline is linked
+ * at once from parts shared by the pipelines of the same shaders and states, compiled on the
+ * calling thread the first time only; the worker links the optimized pipeline, which replaces the
+ * fast linked one once ready.
+ */
+struct PipelineLibrary
+{
+    struct Entry
+    {
+        Pipeline pipeline;
+        std::atomic<bool> ready{false};  // set by the worker once the pipeline exists
+        std::atomic<bool> failed{false}; // logged once, never compiled again
+        std::optional<exec::TaskFuture<void>> compilation;
+
+        // Until ready, with the pipeline library: linked from the parts, kept with the entry
+        Pipeline fastLinked;
+        std::atomic<bool> fastReady{false};
+        std::array<const Pipeline*, k_graphicsPipelinePartsCount> parts{};
+    };
+
+    const Device* device;
+    PipelineCache cache;
+    ShaderModuleCache shaderModules;
+    LayoutCache layouts; // shared by the pipelines of the same sets and push constants
+    VkDescriptorSetLayout resourceLayout; // set 0 of every pipeline
+
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::unique_ptr<Entry>> entries; // by description and format
+    std::unordered_map<VkFormat, RenderPass> renderPasses;
+    std::unordered_map<uint64_t, Pipeline> parts; // by the state of their kind and the format
+    std::atomic<uint32_t> pending{0}; // compilations in flight, the cache is saved when none
+
+    PipelineLibrary() : device(nullptr), resourceLayout(VK_NULL_HANDLE){};
+};
+
+// _resourceLayout, that of the ResourceTable, outlives the library.
+void createPipelineLibrary(PipelineLibrary& _library, const Device& _device,
+                           const std::filesystem::path& _cacheDirectory,
+                           VkDescriptorSetLayout _resourceLayout = VK_NULL_HANDLE);
+
+// Waits for the compilations in flight, then saves the cache.
+void destroyPipelineLibrary(PipelineLibrary& _library);
+
+/**
+ * @brief The pipeline of the description for the color format, if compiled already. Otherwise
+ * its compilation starts on a worker (the first call only) and _fallback is returned until it
+ * is done (nullptr if none: the caller skips its draws meanwhile), or the fast linked pipeline
+ * with the pipeline library.
+ *
+ * Without a thread pool the pipeline is compiled on the calling thread.
+ */
+const Pipeline* acquirePipeline(PipelineLibrary& _library, const PipelineDescription& _description,
+                                VkFormat _colorFormat, const Pipeline* _fallback = nullptr);
+
+// Compiled on the calling thread if not yet, the fallbacks needed in the first frame.
+const Pipeline& compilePipeline(PipelineLibrary& _library, const PipelineDescription& _description,
+                                VkFormat _colorFormat);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -1,13 +1,10 @@
 #include "vulkan_shader_module.hpp"
 
+#include <cstring>
+#include <stdexcept>
 #include <vector>
-#include <fstream>
 
-#if defined(MOSAIC_PLATFORM_ANDROID)
-#include <android/asset_manager.h>
-#include <mosaic/core/platform.hpp>
-#include <mosaic/platform/AGDK/agdk_platform.hpp>
-#endif
+#include "mosaic/graphics/pipeline.hpp"
 
 namespace mosaic
 {
@@ -16,62 +13,24 @@ namespace graphics
 namespace vulkan
 {
 
-static std::vector<char> readFile(const std::string& _filename)
-{
-#if defined(MOSAIC_PLATFORM_WINDOWS) || defined(MOSAIC_PLATFORM_LINUX) || \
-    defined(MOSAIC_PLATFORM_MACOS)
-
-    std::ifstream file(_filename, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) throw std::runtime_error("Failed to open shader file: " + _filename);
-
-    size_t fileSize = static_cast<size_t>(file.tellg());
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
-
-    return buffer;
-
-#elif defined(MOSAIC_PLATFORM_ANDROID)
-
-    auto platform = mosaic::core::Platform::getInstance();
-    auto platformContext =
-        static_cast<platform::agdk::AGDKPlatformContext*>(platform->getPlatformContext());
-
-    AAsset* asset = AAssetManager_open(platformContext->getAssetManager(), _filename.c_str(),
-                                       AASSET_MODE_BUFFER);
-
-    if (!asset) throw std::runtime_error("Failed to open shader file: " + _filename);
-
-    size_t fileSize = AAsset_getLength(asset);
-
-    std::vector<char> buffer(fileSize);
-
-    AAsset_read(asset, buffer.data(), fileSize);
-    AAsset_close(asset);
-
-    return buffer;
-
-#endif
-}
-
 void createShaderModule(ShaderModule& _shaderModule, const VkDevice _device,
-                        const std::string& _filepath)
+                        const ShaderDescription& _description)
 {
-    std::vector<char> code = readFile(_filepath);
+    // SPIR-V is made of 32-bit words, the bytecode is copied to be aligned on them
+    std::vector<uint32_t> code((_description.bytecode.size() + 3) / 4);
+    std::memcpy(code.data(), _description.bytecode.data(), _description.bytecode.size());
 
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    createInfo.codeSize = _description.bytecode.size();
+    createInfo.pCode = code.data();
 
     _shaderModule.device = _device;
 
     if (vkCreateShaderModule(_device, &createInfo, nullptr, &_shaderModule.shaderModule) !=
         VK_SUCCESS)
     {
-        throw std::runtime_error("Failed to create shader module from: " + _filepath);
+        throw std::runtime_error("Failed to create shader module: " + _description.debugName);
     }
 }
 
@@ -84,6 +43,49 @@ void destroyShaderModule(ShaderModule& _shaderModule)
     }
 }
 
+void createShaderModuleCache(ShaderModuleCache& _cache, const VkDevice _device)
+{
+    _cache.device = _device;
+}
+
+VkShaderModule acquireShaderModule(ShaderModuleCache& _cache,
+                                   const ShaderDescription& _description)
+{
+    const uint64_t hash = hashShaderBytecode(_description.bytecode);
+
+    std::lock_guard lock(_cache.mutex);
+
+    auto [it, inserted] = _cache.modules.try_emplace(hash, VK_NULL_HANDLE);
+    if (!inserted) return it->second;
+
+    ShaderModule shaderModule;
+    try
+    {
+        createShaderModule(shaderModule, _cache.device, _description);
+    }
+    catch (...)
+    {
+        _cache.modules.erase(it);
+        throw;
+    }
+
+    it->second = shaderModule.shaderModule;
+
+    return it->second;
+}
+
+void destroyShaderModuleCache(ShaderModuleCache& _cache)
+{
+    std::lock_guard lock(_cache.mutex);
+
+    for (auto& [hash, shaderModule] : _cache.modules)
+    {
+        vkDestroyShaderModule(_cache.device, shaderModule, nullptr);
+    }
+
+    _cache.modules.clear();
+}
+
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "mosaic/graphics/shader.hpp"
+
 #include "../context/vulkan_device.hpp"
 
 namespace mosaic
@@ -18,10 +24,30 @@ struct ShaderModule
 };
 
 void createShaderModule(ShaderModule& _shaderModule, const VkDevice _device,
-                        const std::string& _filepath);
+                        const ShaderDescription& _description);
 
 void destroyShaderModule(ShaderModule& _shaderModule);
 
+// The shader modules of a device by hashShaderBytecode(), shared by the pipeline compilations of
+// the workers: a shader used by many pipelines, or compiled again for a new format, is turned
+// into a module once.
+struct ShaderModuleCache
+{
+    VkDevice device;
+    std::mutex mutex;
+    std::unordered_map<uint64_t, VkShaderModule> modules;
+
+    ShaderModuleCache() : device(VK_NULL_HANDLE) {}
+};
+
+void createShaderModuleCache(ShaderModuleCache& _cache, const VkDevice _device);
+
+// Created by the first call for the bytecode, lives as long as the cache.
+VkShaderModule acquireShaderModule(ShaderModuleCache& _cache,
+                                   const ShaderDescription& _description);
+
+void destroyShaderModuleCache(ShaderModuleCache& _cache);
+
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
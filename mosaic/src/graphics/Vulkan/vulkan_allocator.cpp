@@ -1,5 +1,9 @@
 #include "vulkan_allocator.hpp"
 
+#include <array>
+
+#include "mosaic/tools/memory_tracker.hpp"
+
 namespace mosaic
 {
 namespace graphics
@@ -7,13 +11,80 @@ namespace graphics
 namespace vulkan
 {
 
+pieces::AllocationStats& getMemoryCategoryStats(MemoryCategory _category)
+{
+    static const std::array<pieces::AllocationStats*, static_cast<size_t>(MemoryCategory::Count)>
+        stats = {&tools::MemoryTracker::getStats("vulkan textures"),
+                 &tools::MemoryTracker::getStats("vulkan buffers"),
+                 &tools::MemoryTracker::getStats("vulkan render targets")};
+
+    return *stats[static_cast<size_t>(_category)];
+}
+
+// The stats of its category in the user data of the allocation, for untrack()
+static void track(VmaAllocator _allocator, VmaAllocation _allocation, MemoryCategory _category)
+{
+    pieces::AllocationStats& stats = getMemoryCategoryStats(_category);
+    vmaSetAllocationUserData(_allocator, _allocation, &stats);
+
+    VmaAllocationInfo info = {};
+    vmaGetAllocationInfo(_allocator, _allocation, &info);
+    stats.reserve(info.size);
+    stats.allocate(info.size);
+}
+
+static void untrack(VmaAllocator _allocator, VmaAllocation _allocation)
+{
+    if (_allocation == VK_NULL_HANDLE) return;
+
+    VmaAllocationInfo info = {};
+    vmaGetAllocationInfo(_allocator, _allocation, &info);
+    if (!info.pUserData) return;
+
+    auto* stats = static_cast<pieces::AllocationStats*>(info.pUserData);
+    stats->deallocate(info.size);
+    stats->release(info.size);
+}
+
+static void VKAPI_PTR onDeviceMemoryAllocated(VmaAllocator, uint32_t, VkDeviceMemory,
+                                              VkDeviceSize _size, void* _userData)
+{
+    auto* stats = static_cast<pieces::AllocationStats*>(_userData);
+    stats->reserve(_size);
+    stats->allocate(_size);
+}
+
+static void VKAPI_PTR onDeviceMemoryFreed(VmaAllocator, uint32_t, VkDeviceMemory,
+                                          VkDeviceSize _size, void* _userData)
+{
+    auto* stats = static_cast<pieces::AllocationStats*>(_userData);
+    stats->deallocate(_size);
+    stats->release(_size);
+}
+
 void createAllocator(VmaAllocator& _allocator, const VkInstance& _instance,
-                     const VkPhysicalDevice& _physicalDevice, const VkDevice& _device)
+                     const VkPhysicalDevice& _physicalDevice, const VkDevice& _device,
+                     pieces::AllocationStats* _stats, bool _memoryBudget)
 {
+    // copied by vmaCreateAllocator()
+    VmaDeviceMemoryCallbacks memoryCallbacks = {};
+    memoryCallbacks.pfnAllocate = &onDeviceMemoryAllocated;
+    memoryCallbacks.pfnFree = &onDeviceMemoryFreed;
+    memoryCallbacks.pUserData = _stats;
+
+    // volk loads the functions, VMA fetches the rest from these two
+    VmaVulkanFunctions vulkanFunctions = {};
+    vulkanFunctions.vkGetInstanceProcAddr = vkGetInstanceProcAddr;
+    vulkanFunctions.vkGetDeviceProcAddr = vkGetDeviceProcAddr;
+
     VmaAllocatorCreateInfo allocatorInfo = {};
+    allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+    allocatorInfo.pVulkanFunctions = &vulkanFunctions;
     allocatorInfo.instance = _instance;
     allocatorInfo.physicalDevice = _physicalDevice;
     allocatorInfo.device = _device;
+    if (_stats) allocatorInfo.pDeviceMemoryCallbacks = &memoryCallbacks;
+    if (_memoryBudget) allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 
     if (vmaCreateAllocator(&allocatorInfo, &_allocator) != VK_SUCCESS)
     {
@@ -23,6 +94,361 @@ void createAllocator(VmaAllocator& _allocator, const VkInstance& _instance,
 
 void destroyAllocator(VmaAllocator& _allocator) { vmaDestroyAllocator(_allocator); }
 
+void allocateDeviceMemory(VmaAllocator _allocator, const VkMemoryRequirements& _requirements,
+                          VmaAllocation& _allocation, MemoryCategory _category)
+{
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    if (vmaAllocateMemory(_allocator, &_requirements, &allocationInfo, &_allocation, nullptr) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate Vulkan device memory");
+    }
+
+    track(_allocator, _allocation, _category);
+}
+
+void bindImageMemory(VmaAllocator _allocator, VmaAllocation _allocation, VkDeviceSize _offset,
+                     VkImage _image)
+{
+    if (vmaBindImageMemory2(_allocator, _allocation, _offset, _image, nullptr) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to bind Vulkan image memory");
+    }
+}
+
+void freeDeviceMemory(VmaAllocator _allocator, VmaAllocation& _allocation)
+{
+    untrack(_allocator, _allocation);
+    vmaFreeMemory(_allocator, _allocation);
+    _allocation = VK_NULL_HANDLE;
+}
+
+void createDeviceImage(VmaAllocator _allocator, const VkImageCreateInfo& _imageInfo,
+                       VkImage& _image, VmaAllocation& _allocation, MemoryCategory _category,
+                       VmaPool _pool)
+{
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    allocationInfo.pool = _pool;
+
+    if (vmaCreateImage(_allocator, &_imageInfo, &allocationInfo, &_image, &_allocation,
+                       nullptr) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create Vulkan device image");
+    }
+
+    track(_allocator, _allocation, _category);
+}
+
+bool createLazilyAllocatedImage(VmaAllocator _allocator, const VkImageCreateInfo& _imageInfo,
+                                VkImage& _image, VmaAllocation& _allocation,
+                                MemoryCategory _category)
+{
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+
+    const VkResult result = vmaCreateImage(_allocator, &_imageInfo, &allocationInfo, &_image,
+                                           &_allocation, nullptr);
+
+    // desktop GPUs have no such memory type
+    if (result == VK_ERROR_FEATURE_NOT_PRESENT) return false;
+
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create Vulkan lazily allocated image");
+    }
+
+    track(_allocator, _allocation, _category);
+    return true;
+}
+
+bool createImagePool(VmaAllocator _allocator, const VkImageCreateInfo& _imageInfo, VmaPool& _pool)
+{
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    VmaPoolCreateInfo poolInfo = {};
+    if (vmaFindMemoryTypeIndexForImageInfo(_allocator, &_imageInfo, &allocationInfo,
+                                           &poolInfo.memoryTypeIndex) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    return vmaCreatePool(_allocator, &poolInfo, &_pool) == VK_SUCCESS;
+}
+
+void destroyPool(VmaAllocator _allocator, VmaPool& _pool)
+{
+    vmaDestroyPool(_allocator, _pool);
+    _pool = VK_NULL_HANDLE;
+}
+
+// Read by VMA each time it allocates a block of the pools of createExportableImagePool()
+static const VkExportMemoryAllocateInfo k_exportMemoryInfo = {
+    .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+    .pNext = nullptr,
+    .handleTypes = k_exportMemoryHandleType,
+};
+
+static const VkExternalMemoryImageCreateInfo k_externalImageInfo = {
+    .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+    .pNext = nullptr,
+    .handleTypes = k_exportMemoryHandleType,
+};
+
+bool createExportableImagePool(VmaAllocator _allocator, const VkImageCreateInfo& _imageInfo,
+                               VmaPool& _pool)
+{
+    VmaAllocatorInfo allocatorInfo = {};
+    vmaGetAllocatorInfo(_allocator, &allocatorInfo);
+
+    VkPhysicalDeviceExternalImageFormatInfo externalFormatInfo = {};
+    externalFormatInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_IMAGE_FORMAT_INFO;
+    externalFormatInfo.handleType = k_exportMemoryHandleType;
+
+    VkPhysicalDeviceImageFormatInfo2 formatInfo = {};
+    formatInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2;
+    formatInfo.pNext = &externalFormatInfo;
+    formatInfo.format = _imageInfo.format;
+    formatInfo.type = _imageInfo.imageType;
+    formatInfo.tiling = _imageInfo.tiling;
+    formatInfo.usage = _imageInfo.usage;
+    formatInfo.flags = _imageInfo.flags;
+
+    VkExternalImageFormatProperties externalProperties = {};
+    externalProperties.sType = VK_STRUCTURE_TYPE_EXTERNAL_IMAGE_FORMAT_PROPERTIES;
+
+    VkImageFormatProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2;
+    properties.pNext = &externalProperties;
+
+    if (vkGetPhysicalDeviceImageFormatProperties2(allocatorInfo.physicalDevice, &formatInfo,
+                                                  &properties) != VK_SUCCESS ||
+        !(externalProperties.externalMemoryProperties.externalMemoryFeatures &
+          VK_EXTERNAL_MEMORY_FEATURE_EXPORTABLE_BIT))
+    {
+        return false;
+    }
+
+    VkImageCreateInfo imageInfo = _imageInfo;
+    imageInfo.pNext = &k_externalImageInfo;
+
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    VmaPoolCreateInfo poolInfo = {};
+    poolInfo.pMemoryAllocateNext = const_cast<VkExportMemoryAllocateInfo*>(&k_exportMemoryInfo);
+    if (vmaFindMemoryTypeIndexForImageInfo(_allocator, &imageInfo, &allocationInfo,
+                                           &poolInfo.memoryTypeIndex) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    return vmaCreatePool(_allocator, &poolInfo, &_pool) == VK_SUCCESS;
+}
+
+void createExportableImage(VmaAllocator _allocator, VmaPool _pool,
+                           const VkImageCreateInfo& _imageInfo, VkImage& _image,
+                           VmaAllocation& _allocation, MemoryCategory _category)
+{
+    VkImageCreateInfo imageInfo = _imageInfo;
+    imageInfo.pNext = &k_externalImageInfo;
+
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    allocationInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    allocationInfo.pool = _pool;
+
+    if (vmaCreateImage(_allocator, &imageInfo, &allocationInfo, &_image, &_allocation,
+                       nullptr) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create Vulkan exportable image");
+    }
+
+    track(_allocator, _allocation, _category);
+}
+
+bool exportImageMemory(VmaAllocator _allocator, VmaAllocation _allocation, intptr_t& _handle,
+                       VkDeviceSize& _size)
+{
+    VmaAllocatorInfo allocatorInfo = {};
+    vmaGetAllocatorInfo(_allocator, &allocatorInfo);
+
+    VmaAllocationInfo info = {};
+    vmaGetAllocationInfo(_allocator, _allocation, &info);
+    _size = info.size;
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    VkMemoryGetWin32HandleInfoKHR handleInfo = {};
+    handleInfo.sType = VK_STRUCTURE_TYPE_MEMORY_GET_WIN32_HANDLE_INFO_KHR;
+    handleInfo.memory = info.deviceMemory;
+    handleInfo.handleType = k_exportMemoryHandleType;
+
+    HANDLE handle = nullptr;
+    if (vkGetMemoryWin32HandleKHR(allocatorInfo.device, &handleInfo, &handle) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    _handle = reinterpret_cast<intptr_t>(handle);
+#else
+    VkMemoryGetFdInfoKHR fdInfo = {};
+    fdInfo.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
+    fdInfo.memory = info.deviceMemory;
+    fdInfo.handleType = k_exportMemoryHandleType;
+
+    int fd = -1;
+    if (vkGetMemoryFdKHR(allocatorInfo.device, &fdInfo, &fd) != VK_SUCCESS) return false;
+
+    _handle = fd;
+#endif
+
+    return true;
+}
+
+void destroyDeviceImage(VmaAllocator _allocator, VkImage& _image, VmaAllocation& _allocation)
+{
+    untrack(_allocator, _allocation);
+    vmaDestroyImage(_allocator, _image, _allocation);
+    _image = VK_NULL_HANDLE;
+    _allocation = VK_NULL_HANDLE;
+}
+
+void getDeviceLocalBudget(VmaAllocator _allocator, VkDeviceSize& _usage, VkDeviceSize& _budget)
+{
+    const VkPhysicalDeviceMemoryProperties* properties = nullptr;
+    vmaGetMemoryProperties(_allocator, &properties);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    vmaGetHeapBudgets(_allocator, budgets);
+
+    _usage = 0;
+    _budget = 0;
+
+    for (uint32_t heap = 0; heap < properties->memoryHeapCount; ++heap)
+    {
+        if (!(properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) continue;
+
+        _usage += budgets[heap].usage;
+        _budget += budgets[heap].budget;
+    }
+}
+
+void createMappedBuffer(VmaAllocator _allocator, VkDeviceSize _size, VkBufferUsageFlags _usage,
+                        VkBuffer& _buffer, VmaAllocation& _allocation, void*& _mapped,
+                        MemoryCategory _category)
+{
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = _size;
+    bufferInfo.usage = _usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    allocationInfo.flags =
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo info = {};
+
+    if (vmaCreateBuffer(_allocator, &bufferInfo, &allocationInfo, &_buffer, &_allocation, &info) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create Vulkan mapped buffer");
+    }
+
+    track(_allocator, _allocation, _category);
+    _mapped = info.pMappedData;
+}
+
+void createReadbackBuffer(VmaAllocator _allocator, VkDeviceSize _size, VkBuffer& _buffer,
+                          VmaAllocation& _allocation, void*& _mapped, MemoryCategory _category)
+{
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = _size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+    allocationInfo.flags =
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+    VmaAllocationInfo info = {};
+
+    if (vmaCreateBuffer(_allocator, &bufferInfo, &allocationInfo, &_buffer, &_allocation, &info) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create Vulkan readback buffer");
+    }
+
+    track(_allocator, _allocation, _category);
+    _mapped = info.pMappedData;
+}
+
+void createDeviceBuffer(VmaAllocator _allocator, VkDeviceSize _size, VkBufferUsageFlags _usage,
+                        VkBuffer& _buffer, VmaAllocation& _allocation, MemoryCategory _category)
+{
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = _size;
+    bufferInfo.usage = _usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocationInfo = {};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    if (vmaCreateBuffer(_allocator, &bufferInfo, &allocationInfo, &_buffer, &_allocation,
+                        nullptr) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create Vulkan device buffer");
+    }
+
+    track(_allocator, _allocation, _category);
+}
+
+void destroyMappedBuffer(VmaAllocator _allocator, VkBuffer& _buffer, VmaAllocation& _allocation)
+{
+    untrack(_allocator, _allocation);
+    vmaDestroyBuffer(_allocator, _buffer, _allocation);
+    _buffer = VK_NULL_HANDLE;
+    _allocation = VK_NULL_HANDLE;
+}
+
+void destroyDeviceBuffer(VmaAllocator _allocator, VkBuffer& _buffer, VmaAllocation& _allocation)
+{
+    untrack(_allocator, _allocation);
+    vmaDestroyBuffer(_allocator, _buffer, _allocation);
+    _buffer = VK_NULL_HANDLE;
+    _allocation = VK_NULL_HANDLE;
+}
+
+void flushMappedBuffer(VmaAllocator _allocator, VmaAllocation _allocation, VkDeviceSize _offset,
+                       VkDeviceSize _size)
+{
+    if (_size == 0) return;
+
+    if (vmaFlushAllocation(_allocator, _allocation, _offset, _size) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to flush Vulkan mapped buffer");
+    }
+}
+
+void invalidateMappedBuffer(VmaAllocator _allocator, VmaAllocation _allocation,
+                            VkDeviceSize _offset, VkDeviceSize _size)
+{
+    if (_size == 0) return;
+
+    if (vmaInvalidateAllocation(_allocator, _allocation, _offset, _size) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to invalidate Vulkan mapped buffer");
+    }
+}
+
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstdint>
+
 #include <vk_mem_alloc.h>
 
+#include <pieces/memory/allocation_stats.hpp>
+
 #include "vulkan_common.hpp"
 
 namespace mosaic
@@ -11,11 +15,117 @@ namespace graphics
 namespace vulkan
 {
 
+/**
+ * @brief What an allocation of the helpers below holds, each counted in its own
+ * tools::MemoryTracker stats ("vulkan textures", "vulkan buffers", "vulkan render targets"):
+ * the allocated bytes of the categories add up to what VMA suballocated of the "vulkan" blocks.
+ */
+enum class MemoryCategory : uint8_t
+{
+    Textures,
+    Buffers,
+    RenderTargets, // the attachments, the render graph heaps, the depth pyramid
+    Count
+};
+
+[[nodiscard]] pieces::AllocationStats& getMemoryCategoryStats(MemoryCategory _category);
+
+// The device memory blocks of the allocator are counted in _stats, if given (e.g. the "vulkan"
+// stats of tools::MemoryTracker), as both reserved and allocated: VMA suballocates them.
+// _memoryBudget: VK_EXT_memory_budget is enabled, the budgets come from the driver.
 void createAllocator(VmaAllocator& _allocator, const VkInstance& _instance,
-                     const VkPhysicalDevice& _physicalDevice, const VkDevice& _device);
+                     const VkPhysicalDevice& _physicalDevice, const VkDevice& _device,
+                     pieces::AllocationStats* _stats = nullptr, bool _memoryBudget = false);
 
 void destroyAllocator(VmaAllocator& allocator);
 
+// Device local memory the images are bound in by hand, at offsets of their choice (aliasing).
+void allocateDeviceMemory(VmaAllocator _allocator, const VkMemoryRequirements& _requirements,
+                          VmaAllocation& _allocation,
+                          MemoryCategory _category = MemoryCategory::RenderTargets);
+
+void bindImageMemory(VmaAllocator _allocator, VmaAllocation _allocation, VkDeviceSize _offset,
+                     VkImage _image);
+
+void freeDeviceMemory(VmaAllocator _allocator, VmaAllocation& _allocation);
+
+// An image in its own device local allocation, e.g. the mips of a streamed texture, in _pool if
+// given (createImagePool()).
+void createDeviceImage(VmaAllocator _allocator, const VkImageCreateInfo& _imageInfo,
+                       VkImage& _image, VmaAllocation& _allocation,
+                       MemoryCategory _category = MemoryCategory::Textures,
+                       VmaPool _pool = VK_NULL_HANDLE);
+
+void destroyDeviceImage(VmaAllocator _allocator, VkImage& _image, VmaAllocation& _allocation);
+
+// An image in lazily allocated memory, which tiled GPUs only back if its contents leave the tile
+// (a transient attachment), false if the device has none: the image is not created.
+bool createLazilyAllocatedImage(VmaAllocator _allocator, const VkImageCreateInfo& _imageInfo,
+                                VkImage& _image, VmaAllocation& _allocation,
+                                MemoryCategory _category = MemoryCategory::RenderTargets);
+
+/**
+ * @brief A pool of device local memory for the images like _imageInfo, its blocks apart from the
+ * default ones: defragmented alone (vmaBeginDefragmentation()), the images of other owners never
+ * in its moves. False if no memory type suits: the images go to the default pools.
+ */
+bool createImagePool(VmaAllocator _allocator, const VkImageCreateInfo& _imageInfo, VmaPool& _pool);
+
+void destroyPool(VmaAllocator _allocator, VmaPool& _pool);
+
+/**
+ * @brief A pool of device local memory the images like _imageInfo are exported from
+ * (k_exportMemoryHandleType), each image in a dedicated allocation: the memory exported is that
+ * of the image alone. False if the device cannot export such images.
+ */
+bool createExportableImagePool(VmaAllocator _allocator, const VkImageCreateInfo& _imageInfo,
+                               VmaPool& _pool);
+
+// An image of a pool of createExportableImagePool(), _imageInfo chained to the external memory
+// info here; destroyed by destroyDeviceImage()
+void createExportableImage(VmaAllocator _allocator, VmaPool _pool,
+                           const VkImageCreateInfo& _imageInfo, VkImage& _image,
+                           VmaAllocation& _allocation,
+                           MemoryCategory _category = MemoryCategory::RenderTargets);
+
+// A new handle of the memory of such an image, owned by the caller, and the size to import;
+// false if the driver would not export it
+bool exportImageMemory(VmaAllocator _allocator, VmaAllocation _allocation, intptr_t& _handle,
+                       VkDeviceSize& _size);
+
+// Of the device local heaps: the bytes the process allocated and may allocate in all, the
+// budget estimated by VMA (80% of the heaps) without VK_EXT_memory_budget.
+void getDeviceLocalBudget(VmaAllocator _allocator, VkDeviceSize& _usage, VkDeviceSize& _budget);
+
+// A buffer the CPU writes sequentially through _mapped for as long as it lives, in device local
+// memory when it is host visible (resizable BAR, integrated GPUs).
+void createMappedBuffer(VmaAllocator _allocator, VkDeviceSize _size, VkBufferUsageFlags _usage,
+                        VkBuffer& _buffer, VmaAllocation& _allocation, void*& _mapped,
+                        MemoryCategory _category = MemoryCategory::Buffers);
+
+void destroyMappedBuffer(VmaAllocator _allocator, VkBuffer& _buffer, VmaAllocation& _allocation);
+
+// A buffer the device copies to and the CPU reads through _mapped, in host cached memory when
+// there is some (reads of write-combined memory are uncached); destroyed by destroyMappedBuffer().
+void createReadbackBuffer(VmaAllocator _allocator, VkDeviceSize _size, VkBuffer& _buffer,
+                          VmaAllocation& _allocation, void*& _mapped,
+                          MemoryCategory _category = MemoryCategory::Buffers);
+
+// A buffer only the device accesses, written by transfers (the UploadManager) or shaders.
+void createDeviceBuffer(VmaAllocator _allocator, VkDeviceSize _size, VkBufferUsageFlags _usage,
+                        VkBuffer& _buffer, VmaAllocation& _allocation,
+                        MemoryCategory _category = MemoryCategory::Buffers);
+
+void destroyDeviceBuffer(VmaAllocator _allocator, VkBuffer& _buffer, VmaAllocation& _allocation);
+
+// Makes the CPU writes of the range visible to the device, nothing on coherent memory.
+void flushMappedBuffer(VmaAllocator _allocator, VmaAllocation _allocation, VkDeviceSize _offset,
+                       VkDeviceSize _size);
+
+// Makes the device writes of the range visible to the CPU reads, nothing on coherent memory.
+void invalidateMappedBuffer(VmaAllocator _allocator, VmaAllocation _allocation,
+                            VkDeviceSize _offset, VkDeviceSize _size);
+
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
@@ -88,6 +88,19 @@ static void checkVkResult(VkResult _result)
     assert(_result == VK_SUCCESS);
 }
 
+// The handles the frames of a headless context are exported as, see ExportedFrames
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+inline constexpr VkExternalMemoryHandleTypeFlagBits k_exportMemoryHandleType =
+    VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT;
+inline constexpr VkExternalSemaphoreHandleTypeFlagBits k_exportSemaphoreHandleType =
+    VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_WIN32_BIT;
+#else
+inline constexpr VkExternalMemoryHandleTypeFlagBits k_exportMemoryHandleType =
+    VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+inline constexpr VkExternalSemaphoreHandleTypeFlagBits k_exportSemaphoreHandleType =
+    VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+#endif
+
 } // namespace vulkan
 } // namespace graphics
 } // namespace mosaic
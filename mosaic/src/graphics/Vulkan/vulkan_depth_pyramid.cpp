@@ -0,0 +1,259 @@
+#include "vulkan_depth_pyramid.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// Of the pyramid shader
+static constexpr uint32_t k_workgroupSize = 8;
+
+// The sizes of the level a pass reads and of the one it writes, as the shader reads them
+struct PyramidConstants
+{
+    uint32_t sourceWidth;
+    uint32_t sourceHeight;
+    uint32_t levelWidth;
+    uint32_t levelHeight;
+};
+
+static void imageBarrier(DepthPyramid& _pyramid, CommandBuffer _commandBuffer,
+                         VkImageLayout _oldLayout, VkImageLayout _newLayout,
+                         VkAccessFlags _srcAccess, VkAccessFlags _dstAccess, uint32_t _level,
+                         uint32_t _levelCount)
+{
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = _srcAccess;
+    barrier.dstAccessMask = _dstAccess;
+    barrier.oldLayout = _oldLayout;
+    barrier.newLayout = _newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _pyramid.image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, _level, _levelCount, 0, 1};
+
+    vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+}
+
+static VkImageView createView(DepthPyramid& _pyramid, uint32_t _level, uint32_t _levelCount)
+{
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = _pyramid.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R32_SFLOAT;
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, _level, _levelCount, 0, 1};
+
+    VkImageView view = VK_NULL_HANDLE;
+    if (vkCreateImageView(_pyramid.device->device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create depth pyramid image view!");
+    }
+
+    return view;
+}
+
+static void destroyImage(DepthPyramid& _pyramid)
+{
+    if (_pyramid.image == VK_NULL_HANDLE) return;
+
+    releaseTexture(*_pyramid.table, _pyramid.handle);
+    _pyramid.handle = {};
+
+    for (VkImageView level : _pyramid.levels)
+    {
+        vkDestroyImageView(_pyramid.device->device, level, nullptr);
+    }
+
+    vkDestroyImageView(_pyramid.device->device, _pyramid.view, nullptr);
+    destroyDeviceImage(_pyramid.allocator, _pyramid.image, _pyramid.allocation);
+
+    _pyramid.levels.clear();
+    _pyramid.sets.clear();
+    _pyramid.view = VK_NULL_HANDLE;
+    _pyramid.image = VK_NULL_HANDLE;
+    _pyramid.levelCount = 0;
+}
+
+void createDepthPyramid(DepthPyramid& _pyramid, const Device& _device, VmaAllocator _allocator,
+                        ResourceTable& _table, ShaderLibrary& _shaders, LayoutCache& _layouts,
+                        VkPipelineCache _cache)
+{
+    _pyramid.device = &_device;
+    _pyramid.allocator = _allocator;
+    _pyramid.table = &_table;
+
+    const std::array<DescriptorBinding, 2> bindings = {
+        DescriptorBinding{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1,
+                          VK_SHADER_STAGE_COMPUTE_BIT},
+        DescriptorBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT}};
+    _pyramid.setLayout = acquireDescriptorSetLayout(_layouts, bindings);
+
+    const ShaderDescription& shader =
+        _shaders.load(ShaderStage::Compute, "shaders/bin/build_depth_pyramid.comp.spv");
+    createComputePipeline(_pyramid.pipeline, _device, shader, sizeof(PyramidConstants), _cache,
+                          _pyramid.setLayout, nullptr, &_layouts);
+
+    createDescriptorAllocator(_pyramid.descriptors, _device, 1);
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(_device.device, &samplerInfo, nullptr, &_pyramid.sampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create depth pyramid sampler!");
+    }
+
+    _pyramid.samplerHandle = registerSampler(_table, _pyramid.sampler);
+}
+
+void destroyDepthPyramid(DepthPyramid& _pyramid)
+{
+    destroyImage(_pyramid);
+
+    releaseSampler(*_pyramid.table, _pyramid.samplerHandle);
+    vkDestroySampler(_pyramid.device->device, _pyramid.sampler, nullptr);
+    _pyramid.samplerHandle = {};
+    _pyramid.sampler = VK_NULL_HANDLE;
+
+    destroyDescriptorAllocator(_pyramid.descriptors);
+    destroyGraphicsPipeline(_pyramid.pipeline, *_pyramid.device);
+}
+
+void resizeDepthPyramid(DepthPyramid& _pyramid, VkImageView _depthView, VkExtent2D _extent)
+{
+    if (_pyramid.image != VK_NULL_HANDLE && _pyramid.depthExtent.width == _extent.width &&
+        _pyramid.depthExtent.height == _extent.height && _pyramid.depthView == _depthView)
+    {
+        return;
+    }
+
+    destroyImage(_pyramid);
+    resetDescriptorAllocator(_pyramid.descriptors, 0);
+
+    _pyramid.depthExtent = _extent;
+    _pyramid.depthView = _depthView;
+    _pyramid.width = std::bit_floor(std::max(_extent.width, 1u));
+    _pyramid.height = std::bit_floor(std::max(_extent.height, 1u));
+    _pyramid.levelCount = std::bit_width(std::max(_pyramid.width, _pyramid.height));
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R32_SFLOAT;
+    imageInfo.extent = {_pyramid.width, _pyramid.height, 1};
+    imageInfo.mipLevels = _pyramid.levelCount;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    createDeviceImage(_pyramid.allocator, imageInfo, _pyramid.image, _pyramid.allocation,
+                      MemoryCategory::RenderTargets);
+    setObjectName(*_pyramid.device, VK_OBJECT_TYPE_IMAGE,
+                  reinterpret_cast<uint64_t>(_pyramid.image), "Depth pyramid");
+
+    _pyramid.view = createView(_pyramid, 0, _pyramid.levelCount);
+    _pyramid.handle = registerTexture(*_pyramid.table, _pyramid.view);
+
+    _pyramid.levels.resize(_pyramid.levelCount);
+    _pyramid.sets.resize(_pyramid.levelCount);
+
+    for (uint32_t level = 0; level < _pyramid.levelCount; ++level)
+    {
+        _pyramid.levels[level] = createView(_pyramid, level, 1);
+
+        // level 0 reads the depth buffer, the others the level above in VK_IMAGE_LAYOUT_GENERAL
+        DescriptorWrite source;
+        source.binding = 0;
+        source.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        source.view = level == 0 ? _depthView : _pyramid.levels[level - 1];
+        source.layout =
+            level == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+        source.sampler = _pyramid.sampler;
+
+        DescriptorWrite destination;
+        destination.binding = 1;
+        destination.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        destination.view = _pyramid.levels[level];
+        destination.layout = VK_IMAGE_LAYOUT_GENERAL;
+
+        _pyramid.sets[level] =
+            allocateDescriptorSet(_pyramid.descriptors, 0, _pyramid.setLayout);
+        if (!_pyramid.sets[level])
+        {
+            throw std::runtime_error("failed to allocate depth pyramid descriptor sets!");
+        }
+
+        const std::array<DescriptorWrite, 2> writes = {source, destination};
+        writeDescriptorSet(*_pyramid.device, _pyramid.sets[level], writes);
+    }
+}
+
+void recordDepthPyramid(DepthPyramid& _pyramid, CommandBuffer _commandBuffer)
+{
+    if (_pyramid.image == VK_NULL_HANDLE) return;
+
+    // the previous contents are not read: the culling of the previous frame is done with them
+    imageBarrier(_pyramid, _commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0,
+                 VK_ACCESS_SHADER_WRITE_BIT, 0, _pyramid.levelCount);
+
+    bindComputePipeline(_pyramid.pipeline, _commandBuffer);
+
+    uint32_t sourceWidth = _pyramid.depthExtent.width;
+    uint32_t sourceHeight = _pyramid.depthExtent.height;
+
+    for (uint32_t level = 0; level < _pyramid.levelCount; ++level)
+    {
+        const uint32_t levelWidth = std::max(_pyramid.width >> level, 1u);
+        const uint32_t levelHeight = std::max(_pyramid.height >> level, 1u);
+
+        vkCmdBindDescriptorSets(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                _pyramid.pipeline.pipelineLayout, 0, 1, &_pyramid.sets[level], 0,
+                                nullptr);
+
+        const PyramidConstants constants = {sourceWidth, sourceHeight, levelWidth, levelHeight};
+        vkCmdPushConstants(_commandBuffer, _pyramid.pipeline.pipelineLayout,
+                           VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PyramidConstants), &constants);
+
+        vkCmdDispatch(_commandBuffer, (levelWidth + k_workgroupSize - 1) / k_workgroupSize,
+                      (levelHeight + k_workgroupSize - 1) / k_workgroupSize, 1);
+
+        // read by the next pass
+        imageBarrier(_pyramid, _commandBuffer, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                     VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, level, 1);
+
+        sourceWidth = levelWidth;
+        sourceHeight = levelHeight;
+    }
+
+    // as the ResourceTable samples it
+    imageBarrier(_pyramid, _commandBuffer, VK_IMAGE_LAYOUT_GENERAL,
+                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT,
+                 VK_ACCESS_SHADER_READ_BIT, 0, _pyramid.levelCount);
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
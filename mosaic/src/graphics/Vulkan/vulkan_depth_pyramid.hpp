@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/shader_library.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+#include "pipelines/vulkan_pipeline.hpp"
+#include "vulkan_descriptor_cache.hpp"
+#include "vulkan_resource_table.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The depth pyramid the occlusion test of GpuCulling reads (CullUniforms, reverse-Z):
+ * an R32_SFLOAT image, level 0 the previous power of two of the depth buffer, each texel the
+ * farthest depth of those it covers. Built by a compute pass per level
+ * (assets/shaders/vulkan/build_depth_pyramid.comp) from the depth of the frame, then sampled
+ * through the ResourceTable in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+ *
+ * The passes read the level above through a classic set (a sampled and a storage image, which
+ * the ResourceTable has no binding for), a set per level written once per depth buffer.
+ */
+struct DepthPyramid
+{
+    const Device* device;
+    VmaAllocator allocator;
+    ResourceTable* table;
+
+    Pipeline pipeline;
+    VkDescriptorSetLayout setLayout; // of the LayoutCache
+    DescriptorAllocator descriptors; // the sets of the levels, reset on a resize
+    std::vector<VkDescriptorSet> sets;
+
+    VkImage image;
+    VmaAllocation allocation;
+    VkImageView view;                // every level, in the ResourceTable
+    std::vector<VkImageView> levels; // written by the passes
+    VkSampler sampler; // nearest: the texels are min-reduced by the passes already
+
+    TextureHandle handle;
+    SamplerHandle samplerHandle;
+
+    VkImageView depthView; // read by the pass of level 0
+    VkExtent2D depthExtent;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+
+    DepthPyramid()
+        : device(nullptr),
+          allocator(VK_NULL_HANDLE),
+          table(nullptr),
+          setLayout(VK_NULL_HANDLE),
+          image(VK_NULL_HANDLE),
+          allocation(VK_NULL_HANDLE),
+          view(VK_NULL_HANDLE),
+          sampler(VK_NULL_HANDLE),
+          depthView(VK_NULL_HANDLE),
+          depthExtent{0, 0},
+          width(0),
+          height(0),
+          levelCount(0){};
+};
+
+// The shader is loaded through _shaders, its pipeline layout shared through _layouts.
+void createDepthPyramid(DepthPyramid& _pyramid, const Device& _device, VmaAllocator _allocator,
+                        ResourceTable& _table, ShaderLibrary& _shaders, LayoutCache& _layouts,
+                        VkPipelineCache _cache = VK_NULL_HANDLE);
+
+// No frame in flight may read the pyramid.
+void destroyDepthPyramid(DepthPyramid& _pyramid);
+
+/**
+ * @brief The pyramid of a depth buffer of _extent sampled through _depthView, recreated when
+ * either changed (e.g. a swapchain recreation): its handles change, no frame in flight may read
+ * it then.
+ */
+void resizeDepthPyramid(DepthPyramid& _pyramid, VkImageView _depthView, VkExtent2D _extent);
+
+/**
+ * @brief Records the passes building the pyramid, outside a render pass, the depth buffer in
+ * VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL and its writes visible to the compute shaders. The
+ * pyramid is ready for the culling pass once it returns.
+ */
+void recordDepthPyramid(DepthPyramid& _pyramid, CommandBuffer _commandBuffer);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
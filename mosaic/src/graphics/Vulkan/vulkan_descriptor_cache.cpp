@@ -0,0 +1,455 @@
+#include "vulkan_descriptor_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// The descriptors of a pool per set, by type: those of the material and per-draw sets
+struct PoolRatio
+{
+    VkDescriptorType type;
+    float perSet;
+};
+
+static constexpr std::array k_poolRatios = {
+    PoolRatio{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+    PoolRatio{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+    PoolRatio{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+    PoolRatio{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+    PoolRatio{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2.0f},
+    PoolRatio{VK_DESCRIPTOR_TYPE_SAMPLER, 1.0f},
+    PoolRatio{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+};
+
+// FNV-1a, value by value
+class Hasher
+{
+   private:
+    static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    uint64_t m_hash = FNV_OFFSET_BASIS;
+
+   public:
+    void combine(uint64_t _value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            m_hash ^= (_value >> (i * 8)) & 0xff;
+            m_hash *= FNV_PRIME;
+        }
+    }
+
+    [[nodiscard]] uint64_t get() const { return m_hash; }
+};
+
+static uint64_t toHandleValue(const auto _handle)
+{
+    if constexpr (std::is_pointer_v<decltype(_handle)>)
+    {
+        return reinterpret_cast<uintptr_t>(_handle);
+    }
+    else
+    {
+        return static_cast<uint64_t>(_handle);
+    }
+}
+
+static VkDescriptorType toDescriptorType(ShaderResourceType _type)
+{
+    switch (_type)
+    {
+        case ShaderResourceType::UniformBuffer:
+            return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        case ShaderResourceType::StorageBuffer:
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        case ShaderResourceType::SampledImage:
+            return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        case ShaderResourceType::StorageImage:
+            return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        case ShaderResourceType::Sampler:
+            return VK_DESCRIPTOR_TYPE_SAMPLER;
+        case ShaderResourceType::CombinedImageSampler:
+            return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        case ShaderResourceType::AccelerationStructure:
+            return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+    }
+
+    return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+}
+
+std::vector<DescriptorBinding> getDescriptorBindings(const ShaderReflection& _reflection,
+                                                     uint32_t _set, VkShaderStageFlags _stages)
+{
+    std::vector<DescriptorBinding> bindings;
+
+    for (const ShaderBinding& binding : _reflection.bindings)
+    {
+        if (binding.set != _set || binding.count == 0) continue;
+
+        bindings.push_back({binding.binding, toDescriptorType(binding.type), binding.count,
+                            _stages});
+    }
+
+    return bindings;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Layouts
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void createLayoutCache(LayoutCache& _cache, const Device& _device) { _cache.device = &_device; }
+
+void destroyLayoutCache(LayoutCache& _cache)
+{
+    for (auto& [hash, layouts] : _cache.pipelineLayouts)
+    {
+        for (auto& layout : layouts)
+        {
+            vkDestroyPipelineLayout(_cache.device->device, layout.layout, nullptr);
+        }
+    }
+
+    for (auto& [hash, layouts] : _cache.setLayouts)
+    {
+        for (auto& layout : layouts)
+        {
+            vkDestroyDescriptorSetLayout(_cache.device->device, layout.layout, nullptr);
+        }
+    }
+
+    _cache.pipelineLayouts.clear();
+    _cache.setLayouts.clear();
+}
+
+VkDescriptorSetLayout acquireDescriptorSetLayout(LayoutCache& _cache,
+                                                 std::span<const DescriptorBinding> _bindings)
+{
+    Hasher hasher;
+    for (const DescriptorBinding& binding : _bindings)
+    {
+        hasher.combine(binding.binding);
+        hasher.combine(static_cast<uint64_t>(binding.type));
+        hasher.combine(binding.count);
+        hasher.combine(binding.stages);
+    }
+
+    std::lock_guard lock(_cache.mutex);
+
+    auto& candidates = _cache.setLayouts[hasher.get()];
+    for (const auto& candidate : candidates)
+    {
+        if (std::ranges::equal(candidate.bindings, _bindings)) return candidate.layout;
+    }
+
+    std::vector<VkDescriptorSetLayoutBinding> layoutBindings(_bindings.size());
+    for (size_t i = 0; i < _bindings.size(); ++i)
+    {
+        layoutBindings[i].binding = _bindings[i].binding;
+        layoutBindings[i].descriptorType = _bindings[i].type;
+        layoutBindings[i].descriptorCount = _bindings[i].count;
+        layoutBindings[i].stageFlags = _bindings[i].stages;
+        layoutBindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+    layoutInfo.pBindings = layoutBindings.data();
+
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    if (vkCreateDescriptorSetLayout(_cache.device->device, &layoutInfo, nullptr, &layout) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    candidates.push_back({layout, {_bindings.begin(), _bindings.end()}});
+
+    return layout;
+}
+
+VkPipelineLayout acquirePipelineLayout(LayoutCache& _cache,
+                                       std::span<const VkDescriptorSetLayout> _setLayouts,
+                                       const VkPushConstantRange& _pushConstants)
+{
+    Hasher hasher;
+    for (const VkDescriptorSetLayout setLayout : _setLayouts)
+    {
+        hasher.combine(toHandleValue(setLayout));
+    }
+
+    hasher.combine(_pushConstants.stageFlags);
+    hasher.combine(_pushConstants.offset);
+    hasher.combine(_pushConstants.size);
+
+    const auto samePushConstants = [&](const VkPushConstantRange& _range)
+    {
+        return _range.stageFlags == _pushConstants.stageFlags &&
+               _range.offset == _pushConstants.offset && _range.size == _pushConstants.size;
+    };
+
+    std::lock_guard lock(_cache.mutex);
+
+    auto& candidates = _cache.pipelineLayouts[hasher.get()];
+    for (const auto& candidate : candidates)
+    {
+        if (std::ranges::equal(candidate.setLayouts, _setLayouts) &&
+            samePushConstants(candidate.pushConstants))
+        {
+            return candidate.layout;
+        }
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(_setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = _setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = _pushConstants.size > 0 ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = _pushConstants.size > 0 ? &_pushConstants : nullptr;
+
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    if (vkCreatePipelineLayout(_cache.device->device, &pipelineLayoutInfo, nullptr, &layout) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    candidates.push_back({layout, {_setLayouts.begin(), _setLayouts.end()}, _pushConstants});
+
+    return layout;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocator
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static VkDescriptorPool createPool(DescriptorAllocator& _allocator)
+{
+    const uint32_t sets = _allocator.setsPerPool;
+
+    std::array<VkDescriptorPoolSize, k_poolRatios.size()> sizes;
+    for (size_t i = 0; i < k_poolRatios.size(); ++i)
+    {
+        sizes[i].type = k_poolRatios[i].type;
+        sizes[i].descriptorCount =
+            std::max(1u, static_cast<uint32_t>(k_poolRatios[i].perSet * static_cast<float>(sets)));
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = sets;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(sizes.size());
+    poolInfo.pPoolSizes = sizes.data();
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(_allocator.device->device, &poolInfo, nullptr, &pool) !=
+        VK_SUCCESS)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    // the frames that need more sets grow into fewer, larger pools
+    _allocator.setsPerPool =
+        std::min(_allocator.setsPerPool + _allocator.setsPerPool / 2,
+                 DescriptorAllocator::k_maxSetsPerPool);
+    ++_allocator.poolCount;
+
+    return pool;
+}
+
+// The pool a set of the frame is allocated from next: the last one used, unless full
+static VkDescriptorPool takePool(DescriptorAllocator& _allocator,
+                                 DescriptorAllocator::FramePools& _pools)
+{
+    if (!_pools.ready.empty())
+    {
+        _pools.used.push_back(_pools.ready.back());
+        _pools.ready.pop_back();
+        return _pools.used.back();
+    }
+
+    VkDescriptorPool pool = createPool(_allocator);
+    if (pool) _pools.used.push_back(pool);
+
+    return pool;
+}
+
+void createDescriptorAllocator(DescriptorAllocator& _allocator, const Device& _device,
+                               uint32_t _framesInFlight)
+{
+    _allocator.device = &_device;
+    _allocator.frames.resize(std::max(_framesInFlight, 1u));
+    _allocator.setsPerPool = DescriptorAllocator::k_initialSetsPerPool;
+    _allocator.poolCount = 0;
+}
+
+void destroyDescriptorAllocator(DescriptorAllocator& _allocator)
+{
+    for (auto& pools : _allocator.frames)
+    {
+        for (VkDescriptorPool pool : pools.used)
+        {
+            vkDestroyDescriptorPool(_allocator.device->device, pool, nullptr);
+        }
+
+        for (VkDescriptorPool pool : pools.ready)
+        {
+            vkDestroyDescriptorPool(_allocator.device->device, pool, nullptr);
+        }
+    }
+
+    _allocator.frames.clear();
+    _allocator.poolCount = 0;
+}
+
+void resetDescriptorAllocator(DescriptorAllocator& _allocator, uint32_t _frame)
+{
+    auto& pools = _allocator.frames[_frame];
+
+    for (VkDescriptorPool pool : pools.used)
+    {
+        vkResetDescriptorPool(_allocator.device->device, pool, 0);
+        pools.ready.push_back(pool);
+    }
+
+    pools.used.clear();
+}
+
+VkDescriptorSet allocateDescriptorSet(DescriptorAllocator& _allocator, uint32_t _frame,
+                                      VkDescriptorSetLayout _layout)
+{
+    auto& pools = _allocator.frames[_frame];
+
+    VkDescriptorPool pool = pools.used.empty() ? takePool(_allocator, pools) : pools.used.back();
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &_layout;
+
+    // a full pool is set aside until the reset, the set allocated from the next one
+    for (int attempt = 0; attempt < 2 && pool; ++attempt)
+    {
+        allocateInfo.descriptorPool = pool;
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        const VkResult result = vkAllocateDescriptorSets(_allocator.device->device,
+                                                         &allocateInfo, &set);
+        if (result == VK_SUCCESS) return set;
+
+        if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) break;
+
+        pool = takePool(_allocator, pools);
+    }
+
+    MOSAIC_ERROR("Failed to allocate a descriptor set!");
+    return VK_NULL_HANDLE;
+}
+
+void writeDescriptorSet(const Device& _device, VkDescriptorSet _set,
+                        std::span<const DescriptorWrite> _writes)
+{
+    std::vector<VkDescriptorBufferInfo> bufferInfos(_writes.size());
+    std::vector<VkDescriptorImageInfo> imageInfos(_writes.size());
+    std::vector<VkWriteDescriptorSet> writes(_writes.size());
+
+    for (size_t i = 0; i < _writes.size(); ++i)
+    {
+        const DescriptorWrite& write = _writes[i];
+
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = _set;
+        writes[i].dstBinding = write.binding;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = write.type;
+
+        if (write.buffer != VK_NULL_HANDLE)
+        {
+            bufferInfos[i] = {write.buffer, write.offset, write.range};
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        else
+        {
+            imageInfos[i] = {write.sampler, write.view, write.layout};
+            writes[i].pImageInfo = &imageInfos[i];
+        }
+    }
+
+    vkUpdateDescriptorSets(_device.device, static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                           nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Material sets
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void createDescriptorSetCache(DescriptorSetCache& _cache, const Device& _device)
+{
+    createDescriptorAllocator(_cache.allocator, _device, 1);
+}
+
+void destroyDescriptorSetCache(DescriptorSetCache& _cache)
+{
+    _cache.sets.clear();
+    destroyDescriptorAllocator(_cache.allocator);
+}
+
+VkDescriptorSet acquireDescriptorSet(DescriptorSetCache& _cache, VkDescriptorSetLayout _layout,
+                                     std::span<const DescriptorWrite> _writes)
+{
+    Hasher hasher;
+    hasher.combine(toHandleValue(_layout));
+
+    for (const DescriptorWrite& write : _writes)
+    {
+        hasher.combine(write.binding);
+        hasher.combine(static_cast<uint64_t>(write.type));
+        hasher.combine(toHandleValue(write.buffer));
+        hasher.combine(write.offset);
+        hasher.combine(write.range);
+        hasher.combine(toHandleValue(write.view));
+        hasher.combine(static_cast<uint64_t>(write.layout));
+        hasher.combine(toHandleValue(write.sampler));
+    }
+
+    std::lock_guard lock(_cache.mutex);
+
+    auto& candidates = _cache.sets[hasher.get()];
+    for (const auto& candidate : candidates)
+    {
+        if (candidate.layout == _layout && std::ranges::equal(candidate.writes, _writes))
+        {
+            return candidate.set;
+        }
+    }
+
+    VkDescriptorSet set = allocateDescriptorSet(_cache.allocator, 0, _layout);
+    if (!set) return VK_NULL_HANDLE;
+
+    writeDescriptorSet(*_cache.allocator.device, set, _writes);
+    candidates.push_back({set, _layout, {_writes.begin(), _writes.end()}});
+
+    return set;
+}
+
+void clearDescriptorSetCache(DescriptorSetCache& _cache)
+{
+    std::lock_guard lock(_cache.mutex);
+
+    _cache.sets.clear();
+    resetDescriptorAllocator(_cache.allocator, 0);
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
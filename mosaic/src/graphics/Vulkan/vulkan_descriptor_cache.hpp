@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "mosaic/graphics/shader_reflection.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// A binding of a classic descriptor set layout.
+struct DescriptorBinding
+{
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uint32_t count = 1;
+    VkShaderStageFlags stages = VK_SHADER_STAGE_ALL_GRAPHICS;
+
+    bool operator==(const DescriptorBinding&) const = default;
+};
+
+// The bindings of set _set of a reflected shader, visible to _stages. Runtime arrays (bindless)
+// have no classic binding and are left out.
+std::vector<DescriptorBinding> getDescriptorBindings(const ShaderReflection& _reflection,
+                                                     uint32_t _set, VkShaderStageFlags _stages);
+
+/**
+ * @brief The descriptor set layouts and pipeline layouts of a device, created once per hash of
+ * their bindings (of their set layouts and push constants): the pipelines of the same layout
+ * share it, and so are compatible for the sets bound before a pipeline change. Safe to use from
+ * the compiling workers; the layouts live as long as the cache.
+ */
+struct LayoutCache
+{
+    struct SetLayout
+    {
+        VkDescriptorSetLayout layout;
+        std::vector<DescriptorBinding> bindings;
+    };
+
+    struct PipelineLayout
+    {
+        VkPipelineLayout layout;
+        std::vector<VkDescriptorSetLayout> setLayouts;
+        VkPushConstantRange pushConstants;
+    };
+
+    const Device* device;
+
+    std::mutex mutex;
+    // by hash, the few that collide side by side
+    std::unordered_map<uint64_t, std::vector<SetLayout>> setLayouts;
+    std::unordered_map<uint64_t, std::vector<PipelineLayout>> pipelineLayouts;
+
+    LayoutCache() : device(nullptr){};
+};
+
+void createLayoutCache(LayoutCache& _cache, const Device& _device);
+
+void destroyLayoutCache(LayoutCache& _cache);
+
+// The layout of _bindings, created on a miss.
+VkDescriptorSetLayout acquireDescriptorSetLayout(LayoutCache& _cache,
+                                                 std::span<const DescriptorBinding> _bindings);
+
+// The layout of _setLayouts (set i the i-th) and of _pushConstants (size 0 for none), created on
+// a miss.
+VkPipelineLayout acquirePipelineLayout(LayoutCache& _cache,
+                                       std::span<const VkDescriptorSetLayout> _setLayouts,
+                                       const VkPushConstantRange& _pushConstants);
+
+/**
+ * @brief Classic descriptor sets for the devices without descriptor indexing (older Mali), and
+ * the sets written each frame: allocated from the pools of a frame in flight, which are reset
+ * as a whole once the frame completed instead of the sets being freed one by one.
+ *
+ * A frame starts with the pools the previous frames of its slot grew to: a full pool is set
+ * aside and the next taken, a new one created (each larger, up to k_maxSetsPerPool) when none is
+ * left, so after the first frames no pool is created anymore.
+ */
+struct DescriptorAllocator
+{
+    static constexpr uint32_t k_initialSetsPerPool = 64;
+    static constexpr uint32_t k_maxSetsPerPool = 4096;
+
+    struct FramePools
+    {
+        std::vector<VkDescriptorPool> used;  // full, or in use
+        std::vector<VkDescriptorPool> ready; // reset, taken in turn
+    };
+
+    const Device* device;
+    std::vector<FramePools> frames; // by frame in flight
+    uint32_t setsPerPool;           // of the next pool created
+    uint32_t poolCount;             // created, of every frame
+
+    DescriptorAllocator() : device(nullptr), setsPerPool(k_initialSetsPerPool), poolCount(0){};
+};
+
+void createDescriptorAllocator(DescriptorAllocator& _allocator, const Device& _device,
+                               uint32_t _framesInFlight);
+
+void destroyDescriptorAllocator(DescriptorAllocator& _allocator);
+
+// Once the frame last recorded in slot _frame completed: its sets are no longer valid.
+void resetDescriptorAllocator(DescriptorAllocator& _allocator, uint32_t _frame);
+
+// A set of _layout valid until slot _frame is reset, VK_NULL_HANDLE if the device is out of
+// memory. From the recording thread of the slot only.
+VkDescriptorSet allocateDescriptorSet(DescriptorAllocator& _allocator, uint32_t _frame,
+                                      VkDescriptorSetLayout _layout);
+
+// What a binding of a set points to: the buffer range, or the image view and/or the sampler.
+struct DescriptorWrite
+{
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize range = VK_WHOLE_SIZE;
+    VkImageView view = VK_NULL_HANDLE;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    bool operator==(const DescriptorWrite&) const = default;
+};
+
+void writeDescriptorSet(const Device& _device, VkDescriptorSet _set,
+                        std::span<const DescriptorWrite> _writes);
+
+/**
+ * @brief The immutable sets of the materials, created the first time a layout is used with a set
+ * of resources, then cached by the hash of both: the draws sharing a material bind the same set
+ * and no set is allocated or written per draw.
+ *
+ * The sets are never freed one by one: clearDescriptorSetCache() drops them all (once the device
+ * is idle), after the resources of a material are destroyed.
+ */
+struct DescriptorSetCache
+{
+    struct CachedSet
+    {
+        VkDescriptorSet set;
+        VkDescriptorSetLayout layout;
+        std::vector<DescriptorWrite> writes;
+    };
+
+    DescriptorAllocator allocator; // of a single slot, never reset but by a clear
+    std::unordered_map<uint64_t, std::vector<CachedSet>> sets; // by layout and writes
+    std::mutex mutex;
+};
+
+void createDescriptorSetCache(DescriptorSetCache& _cache, const Device& _device);
+
+void destroyDescriptorSetCache(DescriptorSetCache& _cache);
+
+// The set of _layout with _writes, allocated and written on a miss; VK_NULL_HANDLE if the device
+// is out of memory. Safe to call from several threads.
+VkDescriptorSet acquireDescriptorSet(DescriptorSetCache& _cache, VkDescriptorSetLayout _layout,
+                                     std::span<const DescriptorWrite> _writes);
+
+// No set of the cache may be in use by the device.
+void clearDescriptorSetCache(DescriptorSetCache& _cache);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,77 @@
+#include "vulkan_frame_ring.hpp"
+
+#include <algorithm>
+
+#include "mosaic/graphics/instance_batcher.hpp"
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// The copy source of the texels staged by a frame too (the glyphs of the UiAtlas)
+static constexpr VkBufferUsageFlags k_frameRingUsage =
+    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+    VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+static VkDeviceSize alignUp(VkDeviceSize _size, VkDeviceSize _alignment)
+{
+    return (_size + _alignment - 1) / _alignment * _alignment;
+}
+
+void createFrameRingBuffer(FrameRingBuffer& _ringBuffer, const Device& _device,
+                           VmaAllocator _allocator, ResourceTable& _table, VkDeviceSize _frameSize,
+                           uint32_t _frameCount)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_device.physicalDevice, &properties);
+
+    // all powers of two, the largest is a multiple of the others (instances are indexed)
+    _ringBuffer.alignment = std::max({properties.limits.minUniformBufferOffsetAlignment,
+                                      properties.limits.minStorageBufferOffsetAlignment,
+                                      properties.limits.nonCoherentAtomSize,
+                                      VkDeviceSize{sizeof(InstanceData)}});
+
+    const VkDeviceSize frameSize = alignUp(_frameSize, _ringBuffer.alignment);
+
+    void* mapped = nullptr;
+    createMappedBuffer(_allocator, frameSize * _frameCount, k_frameRingUsage, _ringBuffer.buffer,
+                       _ringBuffer.allocation, mapped);
+
+    _ringBuffer.handle = registerBuffer(_table, _ringBuffer.buffer);
+    _ringBuffer.ring.reset(static_cast<std::byte*>(mapped), frameSize, _frameCount);
+}
+
+void destroyFrameRingBuffer(FrameRingBuffer& _ringBuffer, VmaAllocator _allocator,
+                            ResourceTable& _table)
+{
+    _ringBuffer.ring.reset(nullptr, 0, 0);
+
+    releaseBuffer(_table, _ringBuffer.handle);
+    _ringBuffer.handle = {};
+
+    destroyMappedBuffer(_allocator, _ringBuffer.buffer, _ringBuffer.allocation);
+}
+
+void beginFrameRingBuffer(FrameRingBuffer& _ringBuffer, uint32_t _frame)
+{
+    _ringBuffer.ring.beginFrame(_frame);
+}
+
+void flushFrameRingBuffer(FrameRingBuffer& _ringBuffer, VmaAllocator _allocator)
+{
+    const FrameRing& ring = _ringBuffer.ring;
+
+    // whole atoms, the region of the frame is a multiple of them
+    flushMappedBuffer(_allocator, _ringBuffer.allocation, ring.getFrameOffset(),
+                      alignUp(ring.getUsed(), _ringBuffer.alignment));
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
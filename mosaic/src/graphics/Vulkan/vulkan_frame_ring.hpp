@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/frame_ring.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "vulkan_resource_table.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The FrameRing of a context in one persistently mapped buffer, a region per frame in
+ * flight, bound with the offsets of its allocations (dynamic uniform and storage descriptors,
+ * vertex and index buffers). The buffer is in the ResourceTable too, for the shaders that index
+ * it (the instances of InstanceBatcher).
+ */
+struct FrameRingBuffer
+{
+    VkBuffer buffer;
+    VmaAllocation allocation;
+    VkDeviceSize alignment; // of uniform and storage offsets, and of the flushes
+    BufferHandle handle;
+    FrameRing ring;
+
+    FrameRingBuffer() : buffer(VK_NULL_HANDLE), allocation(VK_NULL_HANDLE), alignment(1){};
+};
+
+// _frameSize is rounded up to the offset alignments of the device.
+void createFrameRingBuffer(FrameRingBuffer& _ringBuffer, const Device& _device,
+                           VmaAllocator _allocator, ResourceTable& _table, VkDeviceSize _frameSize,
+                           uint32_t _frameCount);
+
+void destroyFrameRingBuffer(FrameRingBuffer& _ringBuffer, VmaAllocator _allocator,
+                            ResourceTable& _table);
+
+// Once the frame that used the region last completed, before its first allocation.
+void beginFrameRingBuffer(FrameRingBuffer& _ringBuffer, uint32_t _frame);
+
+// What the frame wrote made visible to the device, before its submission.
+void flushFrameRingBuffer(FrameRingBuffer& _ringBuffer, VmaAllocator _allocator);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
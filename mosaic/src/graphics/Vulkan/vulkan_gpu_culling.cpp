@@ -0,0 +1,246 @@
+#include "vulkan_gpu_culling.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "mosaic/tools/logger.hpp"
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// Of the culling shaders
+static constexpr uint32_t k_workgroupSize = 64;
+
+// The handles of the buffers, as the culling shaders read them
+struct CullConstants
+{
+    uint32_t instances;
+    uint32_t draws;
+    uint32_t commands;
+    uint32_t compacted;
+    uint32_t visibleInstances;
+    uint32_t drawCount;
+    uint32_t uniforms;
+    uint32_t depthPyramid;
+    uint32_t pyramidSampler;
+    uint32_t visibility;
+};
+
+static void createBuffer(GpuCulling& _culling, GpuCulling::Buffer& _buffer, VkDeviceSize _size,
+                         VkBufferUsageFlags _usage)
+{
+    createDeviceBuffer(_culling.allocator, _size, _usage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                       _buffer.buffer, _buffer.allocation);
+
+    _buffer.handle = registerBuffer(*_culling.table, _buffer.buffer);
+}
+
+static void destroyBuffer(GpuCulling& _culling, GpuCulling::Buffer& _buffer)
+{
+    if (_buffer.buffer == VK_NULL_HANDLE) return;
+
+    releaseBuffer(*_culling.table, _buffer.handle);
+    destroyDeviceBuffer(_culling.allocator, _buffer.buffer, _buffer.allocation);
+    _buffer.handle = {};
+}
+
+static void bufferBarrier(CommandBuffer _commandBuffer, VkPipelineStageFlags _srcStages,
+                          VkAccessFlags _srcAccess, VkPipelineStageFlags _dstStages,
+                          VkAccessFlags _dstAccess)
+{
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = _srcAccess;
+    barrier.dstAccessMask = _dstAccess;
+
+    vkCmdPipelineBarrier(_commandBuffer, _srcStages, _dstStages, 0, 1, &barrier, 0, nullptr, 0,
+                         nullptr);
+}
+
+void createGpuCulling(GpuCulling& _culling, const Device& _device, VmaAllocator _allocator,
+                      ResourceTable& _table, ShaderLibrary& _shaders, uint32_t _instanceCapacity,
+                      uint32_t _drawCapacity, VkPipelineCache _cache)
+{
+    _culling.device = &_device;
+    _culling.allocator = _allocator;
+    _culling.table = &_table;
+    _culling.instanceCapacity = std::max(_instanceCapacity, 1u);
+    _culling.drawCapacity = std::max(_drawCapacity, 1u);
+    _culling.visibleCapacity = _culling.instanceCapacity;
+
+    const ShaderDescription& cullShader =
+        _shaders.load(ShaderStage::Compute, "shaders/bin/cull_instances.comp.spv");
+    const ShaderDescription& compactShader =
+        _shaders.load(ShaderStage::Compute, "shaders/bin/compact_draws.comp.spv");
+
+    createComputePipeline(_culling.cullPipeline, _device, cullShader, sizeof(CullConstants),
+                          _cache, _table.layout);
+    createComputePipeline(_culling.compactPipeline, _device, compactShader, sizeof(CullConstants),
+                          _cache, _table.layout);
+
+    const VkDeviceSize commandsSize = _culling.drawCapacity * sizeof(IndexedIndirectCommand);
+
+    createBuffer(_culling, _culling.instances, _culling.instanceCapacity * sizeof(CullInstance),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    createBuffer(_culling, _culling.draws, _culling.drawCapacity * sizeof(CullDraw),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    createBuffer(_culling, _culling.initialCommands, commandsSize,
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    createBuffer(_culling, _culling.commands, commandsSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    createBuffer(_culling, _culling.compacted, commandsSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    createBuffer(_culling, _culling.visibleInstances,
+                 _culling.visibleCapacity * sizeof(uint32_t), 0);
+    createBuffer(_culling, _culling.drawCount, sizeof(uint32_t),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    createBuffer(_culling, _culling.uniforms, sizeof(CullUniforms),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    createBuffer(_culling, _culling.visibility, _culling.instanceCapacity * sizeof(uint32_t),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+}
+
+void destroyGpuCulling(GpuCulling& _culling)
+{
+    destroyBuffer(_culling, _culling.visibility);
+    destroyBuffer(_culling, _culling.uniforms);
+    destroyBuffer(_culling, _culling.drawCount);
+    destroyBuffer(_culling, _culling.visibleInstances);
+    destroyBuffer(_culling, _culling.compacted);
+    destroyBuffer(_culling, _culling.commands);
+    destroyBuffer(_culling, _culling.initialCommands);
+    destroyBuffer(_culling, _culling.draws);
+    destroyBuffer(_culling, _culling.instances);
+
+    destroyGraphicsPipeline(_culling.compactPipeline, *_culling.device);
+    destroyGraphicsPipeline(_culling.cullPipeline, *_culling.device);
+}
+
+UploadTicket setGpuCullingScene(GpuCulling& _culling, UploadManager& _uploads,
+                                std::span<const CullInstance> _instances,
+                                std::span<const CullDraw> _draws)
+{
+    const size_t instanceCount = std::min<size_t>(_instances.size(), _culling.instanceCapacity);
+    const size_t drawCount = std::min<size_t>(_draws.size(), _culling.drawCapacity);
+
+    if (instanceCount < _instances.size() || drawCount < _draws.size())
+    {
+        MOSAIC_WARN("GPU culling capacity exceeded: {} of {} instances, {} of {} draws",
+                    instanceCount, _instances.size(), drawCount, _draws.size());
+    }
+
+    // the ranges of the draws share the visible instance buffer, in order
+    std::vector<CullDraw> draws(_draws.begin(), _draws.begin() + drawCount);
+    uint32_t remaining = _culling.visibleCapacity;
+    for (CullDraw& draw : draws)
+    {
+        draw.maxInstances = std::min(draw.maxInstances, remaining);
+        remaining -= draw.maxInstances;
+    }
+
+    std::vector<IndexedIndirectCommand> commands(drawCount);
+    buildIndirectCommands(draws, commands);
+
+    _culling.instanceCount = static_cast<uint32_t>(instanceCount);
+    _culling.drawCountTotal = static_cast<uint32_t>(drawCount);
+    _culling.resetVisibility = true;
+
+    uploadBuffer(_uploads, _culling.instances.buffer, 0, _instances.data(),
+                 instanceCount * sizeof(CullInstance));
+    uploadBuffer(_uploads, _culling.draws.buffer, 0, draws.data(), drawCount * sizeof(CullDraw));
+
+    return uploadBuffer(_uploads, _culling.initialCommands.buffer, 0, commands.data(),
+                        drawCount * sizeof(IndexedIndirectCommand));
+}
+
+void recordGpuCulling(GpuCulling& _culling, CommandBuffer _commandBuffer, CullUniforms _uniforms,
+                      TextureHandle _depthPyramid, SamplerHandle _pyramidSampler)
+{
+    _uniforms.instanceCount = _culling.instanceCount;
+    _uniforms.drawCount = _culling.drawCountTotal;
+    if (!_depthPyramid.isValid() || !_pyramidSampler.isValid())
+    {
+        _uniforms.flags &= ~CullUniforms::k_occlusion;
+    }
+
+    // the early pass draws what was visible, the pyramid it would test against is not built yet
+    const bool twoPhase =
+        (_uniforms.flags & (CullUniforms::k_earlyPhase | CullUniforms::k_latePhase)) != 0;
+    if (_uniforms.flags & CullUniforms::k_earlyPhase) _uniforms.flags &= ~CullUniforms::k_occlusion;
+
+    // the previous frame drew from these buffers
+    bufferBarrier(_commandBuffer,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT, 0);
+
+    if (_culling.drawCountTotal > 0)
+    {
+        const VkBufferCopy region = {0, 0,
+                                     _culling.drawCountTotal * sizeof(IndexedIndirectCommand)};
+        vkCmdCopyBuffer(_commandBuffer, _culling.initialCommands.buffer, _culling.commands.buffer,
+                        1, &region);
+    }
+
+    vkCmdFillBuffer(_commandBuffer, _culling.drawCount.buffer, 0, sizeof(uint32_t), 0);
+
+    if (twoPhase && _culling.resetVisibility)
+    {
+        vkCmdFillBuffer(_commandBuffer, _culling.visibility.buffer, 0, VK_WHOLE_SIZE, 1);
+        _culling.resetVisibility = false;
+    }
+    vkCmdUpdateBuffer(_commandBuffer, _culling.uniforms.buffer, 0, sizeof(CullUniforms),
+                      &_uniforms);
+
+    bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    const CullConstants constants = {_culling.instances.handle.value,
+                                     _culling.draws.handle.value,
+                                     _culling.commands.handle.value,
+                                     _culling.compacted.handle.value,
+                                     _culling.visibleInstances.handle.value,
+                                     _culling.drawCount.handle.value,
+                                     _culling.uniforms.handle.value,
+                                     _depthPyramid.value,
+                                     _pyramidSampler.value,
+                                     _culling.visibility.handle.value};
+
+    // both pipelines share their layout: the set and the constants stay bound
+    bindComputePipeline(_culling.cullPipeline, _commandBuffer);
+    bindResourceTable(*_culling.table, _commandBuffer, _culling.cullPipeline.pipelineLayout,
+                      VK_PIPELINE_BIND_POINT_COMPUTE);
+    vkCmdPushConstants(_commandBuffer, _culling.cullPipeline.pipelineLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &constants);
+
+    vkCmdDispatch(_commandBuffer, (_culling.instanceCount + k_workgroupSize - 1) / k_workgroupSize,
+                  1, 1);
+
+    bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    bindComputePipeline(_culling.compactPipeline, _commandBuffer);
+    vkCmdDispatch(_commandBuffer, (_culling.drawCountTotal + k_workgroupSize - 1) / k_workgroupSize,
+                  1, 1);
+
+    bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_SHADER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                  VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+}
+
+void drawGpuCulled(const GpuCulling& _culling, CommandBuffer _commandBuffer)
+{
+    vkCmdDrawIndexedIndirectCount(_commandBuffer, _culling.compacted.buffer, 0,
+                                  _culling.drawCount.buffer, 0, _culling.drawCountTotal,
+                                  sizeof(VkDrawIndexedIndirectCommand));
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/gpu_culling.hpp"
+#include "mosaic/graphics/shader_library.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+#include "pipelines/vulkan_pipeline.hpp"
+#include "vulkan_resource_table.hpp"
+#include "vulkan_upload_manager.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The GPU-driven draws of a scene: its CullInstances are culled by a compute pass
+ * (frustum, then the depth pyramid of the previous frame), the visible ones appended to the
+ * range of their draw, and a second pass compacts the commands of the draws with one into the
+ * buffer vkCmdDrawIndexedIndirectCount() reads, with their count. The CPU cost of a frame no
+ * longer depends on the instances.
+ *
+ * The buffers are in the ResourceTable: the vertex shader of the draws reads the index of its
+ * instance at visibleInstances[gl_InstanceIndex] (DrawCall::resources), the culling shaders
+ * (assets/shaders/vulkan/cull_instances.comp, compact_draws.comp) get their handles in push
+ * constants.
+ */
+struct GpuCulling
+{
+    struct Buffer
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        BufferHandle handle;
+    };
+
+    const Device* device;
+    VmaAllocator allocator;
+    ResourceTable* table;
+
+    Pipeline cullPipeline;
+    Pipeline compactPipeline;
+
+    Buffer instances;        // CullInstance, uploaded
+    Buffer draws;            // CullDraw, uploaded
+    Buffer initialCommands;  // buildIndirectCommands(), uploaded
+    Buffer commands;         // reset to initialCommands, then counted by the cull pass
+    Buffer compacted;        // read by the draws
+    Buffer visibleInstances; // the ranges of the draws
+    Buffer drawCount;        // a uint32_t, read by the draws
+    Buffer uniforms;         // CullUniforms, updated in the command buffer
+    Buffer visibility;       // of each instance, written by the late pass of the frame before
+
+    uint32_t instanceCapacity;
+    uint32_t drawCapacity;
+    uint32_t visibleCapacity;
+
+    uint32_t instanceCount;
+    uint32_t drawCountTotal; // of the scene, before culling
+    bool resetVisibility;    // a new scene: every instance visible for its first early pass
+
+    GpuCulling()
+        : device(nullptr),
+          allocator(VK_NULL_HANDLE),
+          table(nullptr),
+          instanceCapacity(0),
+          drawCapacity(0),
+          visibleCapacity(0),
+          instanceCount(0),
+          drawCountTotal(0),
+          resetVisibility(true){};
+};
+
+// The culling shaders are loaded through _shaders, their pipelines compiled once.
+void createGpuCulling(GpuCulling& _culling, const Device& _device, VmaAllocator _allocator,
+                      ResourceTable& _table, ShaderLibrary& _shaders, uint32_t _instanceCapacity,
+                      uint32_t _drawCapacity, VkPipelineCache _cache = VK_NULL_HANDLE);
+
+void destroyGpuCulling(GpuCulling& _culling);
+
+/**
+ * @brief Uploads the instances and draws of the scene (the instances of the draws capped to a
+ * total of _instanceCapacity visible ones), usable by the frames recorded once the ticket is.
+ * Called again when instances move: only the bounds change, a buffer upload a frame at most.
+ */
+UploadTicket setGpuCullingScene(GpuCulling& _culling, UploadManager& _uploads,
+                                std::span<const CullInstance> _instances,
+                                std::span<const CullDraw> _draws);
+
+/**
+ * @brief Records the culling and compaction passes, outside a render pass. _uniforms.frustum and
+ * the occlusion parameters come from the camera; the counts are those of the scene. The depth
+ * pyramid is read when CullUniforms::k_occlusion is set, its sampler a min reduction one (or
+ * nearest) in the ResourceTable, the view in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+ *
+ * Two-phase (an interior, dense with occluders), a frame records:
+ * - recordGpuCulling() with CullUniforms::k_earlyPhase, then drawGpuCulled() in the pass
+ *   writing the depth;
+ * - recordDepthPyramid() of that depth (DepthPyramid);
+ * - recordGpuCulling() with k_latePhase and k_occlusion against the pyramid, then
+ *   drawGpuCulled() in a pass loading the color and depth of the first.
+ * Both phases share the buffers: the late culling waits for the early draws.
+ */
+void recordGpuCulling(GpuCulling& _culling, CommandBuffer _commandBuffer, CullUniforms _uniforms,
+                      TextureHandle _depthPyramid = {}, SamplerHandle _pyramidSampler = {});
+
+// The draw of the compacted commands, in a render pass after recordGpuCulling().
+void drawGpuCulled(const GpuCulling& _culling, CommandBuffer _commandBuffer);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
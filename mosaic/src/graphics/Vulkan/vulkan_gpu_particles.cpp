@@ -0,0 +1,299 @@
+#include "vulkan_gpu_particles.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "mosaic/graphics/draw_call.hpp"
+#include "mosaic/tools/logger.hpp"
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// Of the particle shaders but the sort ones (256, a thread per digit)
+static constexpr uint32_t k_workgroupSize = 64;
+
+// The handles of the buffers and the pass, as the particle shaders read them
+struct ParticleConstants
+{
+    uint32_t particles;
+    uint32_t deadList;
+    uint32_t aliveCurrent;
+    uint32_t aliveNext;
+    uint32_t counters;
+    uint32_t emitters;
+    uint32_t uniforms;
+    uint32_t histogram;
+    uint32_t sourceKeys;
+    uint32_t sourceValues;
+    uint32_t destinationKeys;
+    uint32_t destinationValues;
+    uint32_t shift;
+    uint32_t current;
+};
+
+static void createBuffer(GpuParticles& _particles, GpuParticles::Buffer& _buffer,
+                         VkDeviceSize _size, VkBufferUsageFlags _usage)
+{
+    createDeviceBuffer(_particles.allocator, _size, _usage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                       _buffer.buffer, _buffer.allocation);
+
+    _buffer.handle = registerBuffer(*_particles.table, _buffer.buffer);
+}
+
+static void destroyBuffer(GpuParticles& _particles, GpuParticles::Buffer& _buffer)
+{
+    if (_buffer.buffer == VK_NULL_HANDLE) return;
+
+    releaseBuffer(*_particles.table, _buffer.handle);
+    destroyDeviceBuffer(_particles.allocator, _buffer.buffer, _buffer.allocation);
+    _buffer.handle = {};
+}
+
+static void bufferBarrier(CommandBuffer _commandBuffer, VkPipelineStageFlags _srcStages,
+                          VkAccessFlags _srcAccess, VkPipelineStageFlags _dstStages,
+                          VkAccessFlags _dstAccess)
+{
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = _srcAccess;
+    barrier.dstAccessMask = _dstAccess;
+
+    vkCmdPipelineBarrier(_commandBuffer, _srcStages, _dstStages, 0, 1, &barrier, 0, nullptr, 0,
+                         nullptr);
+}
+
+// A compute pass after another, its dispatch possibly sized by the one before
+static void computeBarrier(CommandBuffer _commandBuffer)
+{
+    bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                  VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                      VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+}
+
+static void pushConstants(const GpuParticles& _particles, CommandBuffer _commandBuffer,
+                          const ParticleConstants& _constants)
+{
+    vkCmdPushConstants(_commandBuffer, _particles.emitPipeline.pipelineLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ParticleConstants), &_constants);
+}
+
+void createGpuParticles(GpuParticles& _particles, const Device& _device, VmaAllocator _allocator,
+                        ResourceTable& _table, ShaderLibrary& _shaders, uint32_t _capacity,
+                        VkPipelineCache _cache)
+{
+    _particles.device = &_device;
+    _particles.allocator = _allocator;
+    _particles.table = &_table;
+    _particles.capacity = std::max(_capacity, 1u);
+    _particles.current = 0;
+    _particles.reset = true;
+
+    const auto createPipeline = [&](Pipeline& _pipeline, const char* _path)
+    {
+        createComputePipeline(_pipeline, _device, _shaders.load(ShaderStage::Compute, _path),
+                              sizeof(ParticleConstants), _cache, _table.layout);
+    };
+
+    createPipeline(_particles.resetPipeline, "shaders/bin/reset_particles.comp.spv");
+    createPipeline(_particles.emitPipeline, "shaders/bin/emit_particles.comp.spv");
+    createPipeline(_particles.argumentsPipeline, "shaders/bin/particle_arguments.comp.spv");
+    createPipeline(_particles.simulatePipeline, "shaders/bin/simulate_particles.comp.spv");
+    createPipeline(_particles.histogramPipeline, "shaders/bin/particle_sort_histogram.comp.spv");
+    createPipeline(_particles.scanPipeline, "shaders/bin/particle_sort_scan.comp.spv");
+    createPipeline(_particles.scatterPipeline, "shaders/bin/particle_sort_scatter.comp.spv");
+
+    const VkDeviceSize indicesSize = _particles.capacity * sizeof(uint32_t);
+    const VkDeviceSize sortBlocks =
+        (_particles.capacity + k_particleSortBlockSize - 1) / k_particleSortBlockSize;
+
+    createBuffer(_particles, _particles.particles, _particles.capacity * sizeof(GpuParticle), 0);
+    createBuffer(_particles, _particles.deadList, indicesSize, 0);
+    createBuffer(_particles, _particles.alive[0], indicesSize, 0);
+    createBuffer(_particles, _particles.alive[1], indicesSize, 0);
+    createBuffer(_particles, _particles.sortValues, indicesSize, 0);
+    createBuffer(_particles, _particles.keys[0], indicesSize, 0);
+    createBuffer(_particles, _particles.keys[1], indicesSize, 0);
+    createBuffer(_particles, _particles.histogram,
+                 sortBlocks * (1u << k_particleSortRadixBits) * sizeof(uint32_t), 0);
+    createBuffer(_particles, _particles.counters, sizeof(ParticleCounters),
+                 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    createBuffer(_particles, _particles.emitters, k_maxParticleEmitters * sizeof(ParticleEmitter),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    createBuffer(_particles, _particles.uniforms, sizeof(ParticleUniforms),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+}
+
+void destroyGpuParticles(GpuParticles& _particles)
+{
+    destroyBuffer(_particles, _particles.uniforms);
+    destroyBuffer(_particles, _particles.emitters);
+    destroyBuffer(_particles, _particles.counters);
+    destroyBuffer(_particles, _particles.histogram);
+    destroyBuffer(_particles, _particles.keys[1]);
+    destroyBuffer(_particles, _particles.keys[0]);
+    destroyBuffer(_particles, _particles.sortValues);
+    destroyBuffer(_particles, _particles.alive[1]);
+    destroyBuffer(_particles, _particles.alive[0]);
+    destroyBuffer(_particles, _particles.deadList);
+    destroyBuffer(_particles, _particles.particles);
+
+    destroyGraphicsPipeline(_particles.scatterPipeline, *_particles.device);
+    destroyGraphicsPipeline(_particles.scanPipeline, *_particles.device);
+    destroyGraphicsPipeline(_particles.histogramPipeline, *_particles.device);
+    destroyGraphicsPipeline(_particles.simulatePipeline, *_particles.device);
+    destroyGraphicsPipeline(_particles.argumentsPipeline, *_particles.device);
+    destroyGraphicsPipeline(_particles.emitPipeline, *_particles.device);
+    destroyGraphicsPipeline(_particles.resetPipeline, *_particles.device);
+}
+
+void recordGpuParticles(GpuParticles& _particles, CommandBuffer _commandBuffer,
+                        std::span<const ParticleEmitter> _emitters, ParticleUniforms _uniforms)
+{
+    const size_t emitterCount = std::min<size_t>(_emitters.size(), k_maxParticleEmitters);
+    if (emitterCount < _emitters.size())
+    {
+        MOSAIC_WARN("GPU particle emitters exceeded: {} of {}", emitterCount, _emitters.size());
+    }
+
+    // the spawns past the emitters kept would be given to the last one
+    const ParticleEmitter* last = emitterCount > 0 ? &_emitters[emitterCount - 1] : nullptr;
+    _uniforms.spawnCount =
+        last ? std::min(_uniforms.spawnCount, last->firstSpawn + last->spawnCount) : 0;
+    _uniforms.emitterCount = static_cast<uint32_t>(emitterCount);
+    _uniforms.capacity = _particles.capacity;
+
+    const uint32_t current = _particles.current;
+    const uint32_t next = 1 - current;
+
+    // the previous frame drew from these buffers
+    bufferBarrier(_commandBuffer,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0);
+
+    vkCmdUpdateBuffer(_commandBuffer, _particles.uniforms.buffer, 0, sizeof(ParticleUniforms),
+                      &_uniforms);
+    if (emitterCount > 0)
+    {
+        vkCmdUpdateBuffer(_commandBuffer, _particles.emitters.buffer, 0,
+                          emitterCount * sizeof(ParticleEmitter), _emitters.data());
+    }
+
+    bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+    ParticleConstants constants = {_particles.particles.handle.value,
+                                   _particles.deadList.handle.value,
+                                   _particles.alive[current].handle.value,
+                                   _particles.alive[next].handle.value,
+                                   _particles.counters.handle.value,
+                                   _particles.emitters.handle.value,
+                                   _particles.uniforms.handle.value,
+                                   _particles.histogram.handle.value,
+                                   _particles.keys[0].handle.value,
+                                   _particles.alive[next].handle.value,
+                                   _particles.keys[1].handle.value,
+                                   _particles.sortValues.handle.value,
+                                   0,
+                                   current};
+
+    // the pipelines share their layout: the set and the constants stay bound
+    bindComputePipeline(_particles.emitPipeline, _commandBuffer);
+    bindResourceTable(*_particles.table, _commandBuffer, _particles.emitPipeline.pipelineLayout,
+                      VK_PIPELINE_BIND_POINT_COMPUTE);
+    pushConstants(_particles, _commandBuffer, constants);
+
+    if (_particles.reset)
+    {
+        bindComputePipeline(_particles.resetPipeline, _commandBuffer);
+        vkCmdDispatch(_commandBuffer, (_particles.capacity + k_workgroupSize - 1) / k_workgroupSize,
+                      1, 1);
+        computeBarrier(_commandBuffer);
+
+        _particles.reset = false;
+    }
+
+    if (_uniforms.spawnCount > 0)
+    {
+        bindComputePipeline(_particles.emitPipeline, _commandBuffer);
+        const uint32_t groups = (_uniforms.spawnCount + k_workgroupSize - 1) / k_workgroupSize;
+        vkCmdDispatch(_commandBuffer, groups, 1, 1);
+        computeBarrier(_commandBuffer);
+    }
+
+    // the simulation, sized by the alive count
+    bindComputePipeline(_particles.argumentsPipeline, _commandBuffer);
+    vkCmdDispatch(_commandBuffer, 1, 1, 1);
+    computeBarrier(_commandBuffer);
+
+    bindComputePipeline(_particles.simulatePipeline, _commandBuffer);
+    vkCmdDispatchIndirect(_commandBuffer, _particles.counters.buffer,
+                          offsetof(ParticleCounters, simulateArguments));
+    computeBarrier(_commandBuffer);
+
+    // the sort and the draw, sized by the survivors
+    constants.shift = 1;
+    pushConstants(_particles, _commandBuffer, constants);
+    bindComputePipeline(_particles.argumentsPipeline, _commandBuffer);
+    vkCmdDispatch(_commandBuffer, 1, 1, 1);
+    computeBarrier(_commandBuffer);
+
+    // two passes: keys[0] and the survivors to keys[1] and sortValues, then back
+    for (uint32_t pass = 0; pass < k_particleSortBits / k_particleSortRadixBits; ++pass)
+    {
+        const bool even = pass % 2 == 0;
+        constants.sourceKeys = _particles.keys[even ? 0 : 1].handle.value;
+        constants.sourceValues =
+            even ? _particles.alive[next].handle.value : _particles.sortValues.handle.value;
+        constants.destinationKeys = _particles.keys[even ? 1 : 0].handle.value;
+        constants.destinationValues =
+            even ? _particles.sortValues.handle.value : _particles.alive[next].handle.value;
+        constants.shift = pass * k_particleSortRadixBits;
+        pushConstants(_particles, _commandBuffer, constants);
+
+        bindComputePipeline(_particles.histogramPipeline, _commandBuffer);
+        vkCmdDispatchIndirect(_commandBuffer, _particles.counters.buffer,
+                              offsetof(ParticleCounters, sortArguments));
+        computeBarrier(_commandBuffer);
+
+        bindComputePipeline(_particles.scanPipeline, _commandBuffer);
+        vkCmdDispatch(_commandBuffer, 1, 1, 1);
+        computeBarrier(_commandBuffer);
+
+        bindComputePipeline(_particles.scatterPipeline, _commandBuffer);
+        vkCmdDispatchIndirect(_commandBuffer, _particles.counters.buffer,
+                              offsetof(ParticleCounters, sortArguments));
+        computeBarrier(_commandBuffer);
+    }
+
+    bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_SHADER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                  VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+
+    _particles.current = next;
+}
+
+void drawGpuParticles(const GpuParticles& _particles, CommandBuffer _commandBuffer,
+                      VkPipelineLayout _layout)
+{
+    const std::array<uint32_t, DrawCall::k_maxResources> resources = {
+        _particles.particles.handle.value, _particles.alive[_particles.current].handle.value,
+        _particles.uniforms.handle.value, 0};
+
+    vkCmdPushConstants(_commandBuffer, _layout, k_resourceStages, 0, sizeof(resources),
+                       resources.data());
+    vkCmdDrawIndirect(_commandBuffer, _particles.counters.buffer,
+                      offsetof(ParticleCounters, drawArguments), 1, sizeof(VkDrawIndirectCommand));
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/gpu_particles.hpp"
+#include "mosaic/graphics/shader_library.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+#include "pipelines/vulkan_pipeline.hpp"
+#include "vulkan_resource_table.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief A pool of GPU particles, emitted, simulated, compacted and sorted in compute and drawn
+ * with vkCmdDrawIndirect(): the CPU records the same few dispatches a frame whatever the particle
+ * count, and uploads only the emitters.
+ *
+ * A frame (recordGpuParticles()):
+ * - the emitters take free slots from the dead list, appending their spawns to the alive list;
+ * - the simulation (an indirect dispatch over the alive count) frees the expired particles and
+ *   appends the others to the second alive list, with a key of their camera distance;
+ * - a radix sort of two 8-bit passes (histogram, scan, scatter; indirect over the blocks of the
+ *   survivors) orders that list back to front for blending, and it is the one drawn. The lists swap
+ *   roles the next frame.
+ *
+ * The buffers are in the ResourceTable, the shaders (assets/shaders/vulkan, emit_particles.comp,
+ * simulate_particles.comp, particle_sort_scatter.comp...) get their handles in push constants.
+ */
+struct GpuParticles
+{
+    struct Buffer
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        BufferHandle handle;
+    };
+
+    const Device* device;
+    VmaAllocator allocator;
+    ResourceTable* table;
+
+    Pipeline resetPipeline;
+    Pipeline emitPipeline;
+    Pipeline argumentsPipeline;
+    Pipeline simulatePipeline;
+    Pipeline histogramPipeline;
+    Pipeline scanPipeline;
+    Pipeline scatterPipeline;
+
+    Buffer particles;  // GpuParticle, capacity of them
+    Buffer deadList;   // the free slots
+    Buffer alive[2];   // the slots simulated this frame, then the survivors sorted
+    Buffer sortValues; // the survivors between the two sort passes
+    Buffer keys[2];    // the sort keys of the survivors, ping-ponged by the passes
+    Buffer histogram;  // the digit counts of the sort blocks, scanned
+    Buffer counters;   // ParticleCounters
+    Buffer emitters;   // ParticleEmitter, updated in the command buffer
+    Buffer uniforms;   // ParticleUniforms, updated in the command buffer
+
+    uint32_t capacity;
+    uint32_t current; // the alive list drawn, simulated by the next frame
+    bool reset;       // a new pool: every slot freed before the first frame
+
+    GpuParticles()
+        : device(nullptr),
+          allocator(VK_NULL_HANDLE),
+          table(nullptr),
+          capacity(0),
+          current(0),
+          reset(true){};
+};
+
+// The particle shaders are loaded through _shaders, their pipelines compiled once.
+void createGpuParticles(GpuParticles& _particles, const Device& _device, VmaAllocator _allocator,
+                        ResourceTable& _table, ShaderLibrary& _shaders, uint32_t _capacity,
+                        VkPipelineCache _cache = VK_NULL_HANDLE);
+
+void destroyGpuParticles(GpuParticles& _particles);
+
+/**
+ * @brief Records a frame of the particles, outside a render pass: the emission of _emitters (up
+ * to k_maxParticleEmitters, with their ranges of _uniforms.spawnCount spawns), the simulation over
+ * _uniforms.deltaTime and the sort. The camera fields of _uniforms are those of the draw.
+ */
+void recordGpuParticles(GpuParticles& _particles, CommandBuffer _commandBuffer,
+                        std::span<const ParticleEmitter> _emitters, ParticleUniforms _uniforms);
+
+/**
+ * @brief The draw of the particles sorted by the last recordGpuParticles(), in a render pass with
+ * a pipeline of particle.vert/particle.frag (alpha blended, the depth tested but not written).
+ * _layout is that of the pipeline, its DrawCall::resources push constants set here.
+ */
+void drawGpuParticles(const GpuParticles& _particles, CommandBuffer _commandBuffer,
+                      VkPipelineLayout _layout);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,101 @@
+#include "vulkan_memory_manager.hpp"
+
+#include <algorithm>
+
+#include "mosaic/tools/tracer.hpp"
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+static double toMiB(uint64_t _bytes) { return static_cast<double>(_bytes) / (1024.0 * 1024.0); }
+
+static void traceBudget(const MemoryManager& _manager)
+{
+    if (!tools::Tracer::isRecording(tools::TraceCategory::memory)) return;
+
+    tools::Tracer* tracer = tools::Tracer::getInstance();
+    if (!tracer) return;
+
+    const auto category = tools::TraceCategory::memory;
+    tracer->counterTrace("GPU memory usage (MiB)", toMiB(_manager.usage), category);
+    tracer->counterTrace("GPU memory budget (MiB)", toMiB(_manager.budget), category);
+    tracer->counterTrace("GPU memory pressure", static_cast<double>(_manager.pressure), category);
+    tracer->counterTrace("GPU memory streaming budget (MiB)",
+                         toMiB(_manager.streaming->streamer.getBudget()), category);
+}
+
+static void logPressure(const MemoryManager& _manager, MemoryPressure _previous)
+{
+    if (_manager.pressure == MemoryPressure::Normal)
+    {
+        MOSAIC_INFO("GPU memory pressure back to normal: {:.0f} of {:.0f} MiB used.",
+                    toMiB(_manager.usage), toMiB(_manager.budget));
+        return;
+    }
+
+    if (_manager.pressure < _previous) return;
+
+    const auto allocated = [](MemoryCategory _category)
+    { return toMiB(getMemoryCategoryStats(_category).allocatedBytes()); };
+
+    MOSAIC_WARN("GPU memory pressure {}: {:.0f} of {:.0f} MiB used (textures {:.0f}, buffers "
+                "{:.0f}, render targets {:.0f} MiB), streamed textures evicted to {:.0f} MiB.",
+                getMemoryPressureName(_manager.pressure), toMiB(_manager.usage),
+                toMiB(_manager.budget), allocated(MemoryCategory::Textures),
+                allocated(MemoryCategory::Buffers), allocated(MemoryCategory::RenderTargets),
+                toMiB(_manager.streaming->streamer.getBudget()));
+}
+
+void createMemoryManager(MemoryManager& _manager, VmaAllocator _allocator,
+                         TextureStreaming& _streaming, MemoryBudgetSettings _settings)
+{
+    _manager.allocator = _allocator;
+    _manager.streaming = &_streaming;
+    _manager.settings = _settings;
+    _manager.lastUpdate = MemoryManager::Clock::now();
+}
+
+void reportFrameTimes(MemoryManager& _manager, MemoryManager::Clock::duration _cpuTime,
+                      MemoryManager::Clock::duration _gpuTime)
+{
+    _manager.cpuTime = std::max(_manager.cpuTime, _cpuTime);
+    _manager.gpuTime = std::max(_manager.gpuTime, _gpuTime);
+}
+
+void updateMemoryManager(MemoryManager& _manager)
+{
+    TextureStreamer& streamer = _manager.streaming->streamer;
+
+    getDeviceLocalBudget(_manager.allocator, _manager.usage, _manager.budget);
+
+    streamer.setBudget(getStreamingBudget(_manager.usage, _manager.budget,
+                                          streamer.getCommittedSize(), _manager.settings));
+
+    const MemoryPressure previous = _manager.pressure;
+    _manager.pressure = getMemoryPressure(_manager.usage, _manager.budget, _manager.settings);
+    if (_manager.pressure != previous) logPressure(_manager, previous);
+
+    traceBudget(_manager);
+
+    // the interval between two updates is that of the frames
+    const MemoryManager::Clock::time_point now = MemoryManager::Clock::now();
+    if (isLowLoadFrame(_manager.cpuTime, _manager.gpuTime, now - _manager.lastUpdate,
+                       _manager.settings))
+    {
+        defragmentTextureStreaming(*_manager.streaming, _manager.settings.defragmentationBytes);
+    }
+
+    _manager.cpuTime = {};
+    _manager.gpuTime = {};
+    _manager.lastUpdate = now;
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
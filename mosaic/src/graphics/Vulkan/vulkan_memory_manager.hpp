@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/memory_budget.hpp"
+
+#include "vulkan_common.hpp"
+#include "vulkan_texture_streaming.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief Keeps the process within the device memory budget the driver grants it, checked once a
+ * render system update: the budgets of the device local heaps (vmaGetHeapBudgets(), those of
+ * VK_EXT_memory_budget when the device has it, else 80% of the heaps), the pressure they give
+ * under the MemoryBudgetSettings.
+ *
+ * - the usage, the budget and the pressure are traced (TraceCategory::memory, next to the
+ *   MemoryCategory counters of tools::MemoryTracker), a warning logged as the pressure rises;
+ * - the streamed textures are evicted to what the high watermark leaves the other resources
+ *   (getStreamingBudget()), before the budget is reached rather than once an allocation fails;
+ * - a frame with time to spare (isLowLoadFrame(), from the FramePacer times of the contexts)
+ *   runs a defragmentation pass of the streamed textures.
+ */
+struct MemoryManager
+{
+    using Clock = std::chrono::steady_clock;
+
+    VmaAllocator allocator;
+    TextureStreaming* streaming;
+    MemoryBudgetSettings settings;
+
+    MemoryPressure pressure;
+    VkDeviceSize usage; // of the device local heaps, at the last update
+    VkDeviceSize budget;
+
+    // of the slowest context since the last update
+    Clock::duration cpuTime;
+    Clock::duration gpuTime;
+    Clock::time_point lastUpdate;
+
+    MemoryManager()
+        : allocator(VK_NULL_HANDLE),
+          streaming(nullptr),
+          pressure(MemoryPressure::Normal),
+          usage(0),
+          budget(0),
+          cpuTime{},
+          gpuTime{},
+          lastUpdate{} {};
+};
+
+void createMemoryManager(MemoryManager& _manager, VmaAllocator _allocator,
+                         TextureStreaming& _streaming, MemoryBudgetSettings _settings = {});
+
+// The times a context took to build and render its last frame (FramePacer), once a frame.
+void reportFrameTimes(MemoryManager& _manager, MemoryManager::Clock::duration _cpuTime,
+                      MemoryManager::Clock::duration _gpuTime);
+
+// Once a render system update, after updateTextureStreaming(): the budget it sets applies next.
+void updateMemoryManager(MemoryManager& _manager);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,86 @@
+#include "vulkan_mesh_store.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "mosaic/core/mapped_file.hpp"
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+void createMeshStore(MeshStore& _store, const Device& _device, VmaAllocator _allocator,
+                     UploadManager& _uploads, ResourceTable& _table)
+{
+    _store.device = &_device;
+    _store.allocator = _allocator;
+    _store.uploads = &_uploads;
+    _store.table = &_table;
+}
+
+void destroyMeshStore(MeshStore& _store)
+{
+    for (MeshStore::Mesh& mesh : _store.meshes)
+    {
+        if (mesh.handle.isValid()) releaseBuffer(*_store.table, mesh.handle);
+        destroyDeviceBuffer(_store.allocator, mesh.buffer, mesh.allocation);
+    }
+
+    _store.meshes.clear();
+}
+
+MeshId loadMesh(MeshStore& _store, const std::filesystem::path& _path)
+{
+    const core::MappedFile file(_path);
+
+    auto parsed = parseMesh(file.bytes());
+    if (parsed.isErr())
+    {
+        throw std::runtime_error("Failed to load mesh " + _path.string() + ": " + parsed.error());
+    }
+
+    const MeshData& data = parsed.unwrap();
+
+    MeshStore::Mesh mesh;
+    mesh.header = data.header;
+    mesh.lods = data.lods;
+
+    // The sections from the start of the payload, the buffer
+    const size_t base = data.payload.offset;
+    mesh.vertexOffset = data.vertices.offset - base;
+    mesh.indexOffset = data.indices.offset - base;
+    mesh.meshletOffset = data.meshlets.offset - base;
+    mesh.meshletVertexOffset = data.meshletVertices.offset - base;
+    mesh.meshletTriangleOffset = data.meshletTriangles.offset - base;
+
+    // the index buffer is bound at 0, the LODs index from there (16-byte aligned sections)
+    const uint32_t firstIndex = static_cast<uint32_t>(mesh.indexOffset / sizeof(uint32_t));
+    for (MeshLod& lod : mesh.lods) lod.firstIndex += firstIndex;
+
+    createDeviceBuffer(_store.allocator, data.payload.size,
+                       VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                       mesh.buffer, mesh.allocation);
+
+    // straight from the mapping to the staging chunks
+    mesh.ticket = uploadBuffer(*_store.uploads, mesh.buffer, 0, file.bytes().data() + base,
+                               data.payload.size);
+    mesh.handle = registerBuffer(*_store.table, mesh.buffer);
+
+    _store.meshes.push_back(std::move(mesh));
+    return static_cast<MeshId>(_store.meshes.size() - 1);
+}
+
+bool isMeshReady(MeshStore& _store, MeshId _mesh)
+{
+    return isUploadComplete(*_store.uploads, _store.meshes[_mesh].ticket);
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
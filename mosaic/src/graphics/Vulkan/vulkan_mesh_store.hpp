@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/mesh.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "vulkan_resource_table.hpp"
+#include "vulkan_upload_manager.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// The index of a mesh in a MeshStore, what MeshComponent::meshId refers to
+using MeshId = uint32_t;
+
+/**
+ * @brief The meshes read from cooked mesh files (cookMesh()): each file is mapped and its
+ * payload copied as it is to the staging chunks of the UploadManager, into one device buffer of
+ * the mesh, with no parsing of the vertex data.
+ *
+ * The buffer is the vertex, index and storage buffer of the mesh: the draws bind it with the
+ * offsets of its sections, the shaders read the vertices and meshlets through its BufferHandle.
+ */
+struct MeshStore
+{
+    struct Mesh
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        BufferHandle handle;
+        UploadTicket ticket = 0;
+
+        MeshFileHeader header = {};
+        std::vector<MeshLod> lods; // firstIndex counted from the start of the buffer
+
+        // In the buffer: the sections of the payload
+        VkDeviceSize vertexOffset = 0;
+        VkDeviceSize indexOffset = 0;
+        VkDeviceSize meshletOffset = 0;
+        VkDeviceSize meshletVertexOffset = 0;
+        VkDeviceSize meshletTriangleOffset = 0;
+    };
+
+    const Device* device;
+    VmaAllocator allocator;
+    UploadManager* uploads;
+    ResourceTable* table;
+
+    std::vector<Mesh> meshes; // by MeshId
+
+    MeshStore() : device(nullptr), allocator(VK_NULL_HANDLE), uploads(nullptr), table(nullptr){};
+};
+
+void createMeshStore(MeshStore& _store, const Device& _device, VmaAllocator _allocator,
+                     UploadManager& _uploads, ResourceTable& _table);
+
+// After the device is idle.
+void destroyMeshStore(MeshStore& _store);
+
+/**
+ * @brief Maps and validates a mesh file, creates its buffer and records its upload. The mesh can
+ * be drawn once isMeshReady().
+ *
+ * @throws std::runtime_error if the file cannot be read or is not a mesh file.
+ */
+MeshId loadMesh(MeshStore& _store, const std::filesystem::path& _path);
+
+// Its upload acquired by the graphics queue.
+bool isMeshReady(MeshStore& _store, MeshId _mesh);
+
+inline const MeshStore::Mesh& getMesh(const MeshStore& _store, MeshId _mesh)
+{
+    return _store.meshes[_mesh];
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
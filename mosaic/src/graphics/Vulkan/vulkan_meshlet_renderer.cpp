@@ -0,0 +1,322 @@
+#include "vulkan_meshlet_renderer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "mosaic/graphics/draw_call.hpp"
+#include "mosaic/tools/logger.hpp"
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// The rows of the task grids (maxTaskWorkGroupCount[0], maxComputeWorkGroupCount[0] at least)
+static constexpr uint32_t k_maxGridWidth = 65535;
+
+// The stages of the mesh pipeline's push constants
+static constexpr VkShaderStageFlags k_meshStages =
+    VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+// The handles of the buffers, as the meshlet shaders read them (meshlet_common.glsl)
+struct MeshletConstants
+{
+    uint32_t instances;
+    uint32_t meshes;
+    uint32_t uniforms;
+    uint32_t visible;
+    uint32_t tasks;
+    uint32_t depthPyramid;
+    uint32_t pyramidSampler;
+    uint32_t drawArguments;
+};
+
+static void createBuffer(MeshletRenderer& _renderer, MeshletRenderer::Buffer& _buffer,
+                         VkDeviceSize _size, VkBufferUsageFlags _usage)
+{
+    createDeviceBuffer(_renderer.allocator, _size, _usage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                       _buffer.buffer, _buffer.allocation);
+
+    _buffer.handle = registerBuffer(*_renderer.table, _buffer.buffer);
+}
+
+static void destroyBuffer(MeshletRenderer& _renderer, MeshletRenderer::Buffer& _buffer)
+{
+    if (_buffer.buffer == VK_NULL_HANDLE) return;
+
+    releaseBuffer(*_renderer.table, _buffer.handle);
+    destroyDeviceBuffer(_renderer.allocator, _buffer.buffer, _buffer.allocation);
+    _buffer.handle = {};
+}
+
+static void bufferBarrier(CommandBuffer _commandBuffer, VkPipelineStageFlags _srcStages,
+                          VkAccessFlags _srcAccess, VkPipelineStageFlags _dstStages,
+                          VkAccessFlags _dstAccess)
+{
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = _srcAccess;
+    barrier.dstAccessMask = _dstAccess;
+
+    vkCmdPipelineBarrier(_commandBuffer, _srcStages, _dstStages, 0, 1, &barrier, 0, nullptr, 0,
+                         nullptr);
+}
+
+// A workgroup per task, in rows of k_maxGridWidth: the shaders index them row by row
+static VkExtent2D getTaskGrid(uint32_t _taskCount)
+{
+    const uint32_t width = std::min(_taskCount, k_maxGridWidth);
+    return {width, width > 0 ? (_taskCount + width - 1) / width : 0};
+}
+
+// The stages reading the buffers of the scene in the draw
+static VkPipelineStageFlags getDrawStages(const MeshletRenderer& _renderer)
+{
+    return _renderer.meshShader
+               ? VK_PIPELINE_STAGE_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT
+               : VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+}
+
+static MeshletConstants getConstants(const MeshletRenderer& _renderer)
+{
+    return {_renderer.instances.handle.value,
+            _renderer.meshes.handle.value,
+            _renderer.uniforms.handle.value,
+            _renderer.visible.handle.value,
+            _renderer.tasks.handle.value,
+            _renderer.depthPyramid.value,
+            _renderer.pyramidSampler.value,
+            _renderer.drawArguments.handle.value};
+}
+
+void createMeshletRenderer(MeshletRenderer& _renderer, const Device& _device,
+                           VmaAllocator _allocator, ResourceTable& _table, ShaderLibrary& _shaders,
+                           VkFormat _colorFormat, VkRenderPass _renderPass,
+                           uint32_t _meshCapacity, uint32_t _instanceCapacity,
+                           uint32_t _taskCapacity, VkPipelineCache _cache)
+{
+    _renderer.device = &_device;
+    _renderer.allocator = _allocator;
+    _renderer.table = &_table;
+    _renderer.meshCapacity = std::max(_meshCapacity, 1u);
+    _renderer.instanceCapacity = std::max(_instanceCapacity, 1u);
+    _renderer.taskCapacity = std::max(_taskCapacity, 1u);
+    _renderer.visibleCapacity = _renderer.taskCapacity * k_meshletTaskSize;
+    _renderer.taskCount = 0;
+    _renderer.meshShader = _device.meshShader;
+
+    const ShaderDescription& fragmentShader =
+        _shaders.load(ShaderStage::Fragment, "shaders/bin/meshlet.frag.spv");
+
+    if (_renderer.meshShader)
+    {
+        PipelineDescription description;
+        description.shaders = {_shaders.load(ShaderStage::Task, "shaders/bin/meshlet.task.spv"),
+                               _shaders.load(ShaderStage::Mesh, "shaders/bin/meshlet.mesh.spv"),
+                               fragmentShader};
+        description.debugName = "meshlets";
+
+        createMeshPipeline(_renderer.meshPipeline, _device, description, _colorFormat,
+                           _renderPass, sizeof(MeshletConstants), _cache, _table.layout);
+    }
+    else
+    {
+        createComputePipeline(
+            _renderer.cullPipeline, _device,
+            _shaders.load(ShaderStage::Compute, "shaders/bin/cull_meshlets.comp.spv"),
+            sizeof(MeshletConstants), _cache, _table.layout);
+
+        PipelineDescription description;
+        description.shaders = {_shaders.load(ShaderStage::Vertex, "shaders/bin/meshlet.vert.spv"),
+                               fragmentShader};
+        description.debugName = "meshlets (emulated)";
+
+        createGraphicsPipeline(_renderer.emulatedPipeline, _device, description, _colorFormat,
+                               _renderPass, _cache, _table.layout);
+    }
+
+    createBuffer(_renderer, _renderer.meshes, _renderer.meshCapacity * sizeof(MeshletMesh),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    createBuffer(_renderer, _renderer.instances,
+                 _renderer.instanceCapacity * sizeof(MeshletInstance),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    createBuffer(_renderer, _renderer.tasks, _renderer.taskCapacity * sizeof(MeshletTask),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    createBuffer(_renderer, _renderer.uniforms, sizeof(MeshletCullUniforms),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+    // a buffer of each, unused, keeps the handles of the task shader's constants valid
+    const VkDeviceSize visibleSize =
+        _renderer.meshShader ? sizeof(VisibleMeshlet)
+                             : _renderer.visibleCapacity * sizeof(VisibleMeshlet);
+    createBuffer(_renderer, _renderer.visible, visibleSize, 0);
+    createBuffer(_renderer, _renderer.drawArguments, sizeof(VkDrawIndirectCommand),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+}
+
+void destroyMeshletRenderer(MeshletRenderer& _renderer)
+{
+    destroyBuffer(_renderer, _renderer.drawArguments);
+    destroyBuffer(_renderer, _renderer.visible);
+    destroyBuffer(_renderer, _renderer.uniforms);
+    destroyBuffer(_renderer, _renderer.tasks);
+    destroyBuffer(_renderer, _renderer.instances);
+    destroyBuffer(_renderer, _renderer.meshes);
+
+    if (_renderer.meshShader)
+    {
+        destroyGraphicsPipeline(_renderer.meshPipeline, *_renderer.device);
+    }
+    else
+    {
+        destroyGraphicsPipeline(_renderer.emulatedPipeline, *_renderer.device);
+        destroyGraphicsPipeline(_renderer.cullPipeline, *_renderer.device);
+    }
+}
+
+MeshletMesh getMeshletMesh(const MeshStore::Mesh& _mesh)
+{
+    MeshletMesh mesh;
+    mesh.buffer = _mesh.handle.value;
+    mesh.vertexOffset = static_cast<uint32_t>(_mesh.vertexOffset);
+    mesh.meshletOffset = static_cast<uint32_t>(_mesh.meshletOffset);
+    mesh.meshletVertexOffset = static_cast<uint32_t>(_mesh.meshletVertexOffset);
+    mesh.meshletTriangleOffset = static_cast<uint32_t>(_mesh.meshletTriangleOffset);
+    mesh.boundsMin = _mesh.header.boundsMin;
+    mesh.boundsExtent = _mesh.header.boundsExtent;
+    return mesh;
+}
+
+UploadTicket setMeshletScene(MeshletRenderer& _renderer, UploadManager& _uploads,
+                             std::span<const MeshletMesh> _meshes,
+                             std::span<const MeshletInstance> _instances)
+{
+    const size_t meshCount = std::min<size_t>(_meshes.size(), _renderer.meshCapacity);
+    const size_t instanceCount = std::min<size_t>(_instances.size(), _renderer.instanceCapacity);
+
+    // the instances of the meshes cut are dropped with them
+    std::vector<MeshletInstance> instances;
+    instances.reserve(instanceCount);
+    for (size_t i = 0; i < instanceCount; ++i)
+    {
+        if (_instances[i].mesh < meshCount) instances.push_back(_instances[i]);
+    }
+
+    std::vector<MeshletTask> tasks;
+    buildMeshletTasks(instances, tasks);
+    const size_t taskCount = std::min<size_t>(tasks.size(), _renderer.taskCapacity);
+
+    if (meshCount < _meshes.size() || instanceCount < _instances.size() ||
+        taskCount < tasks.size())
+    {
+        MOSAIC_WARN("meshlet capacity exceeded: {} of {} meshes, {} of {} instances, {} of {} "
+                    "tasks",
+                    meshCount, _meshes.size(), instanceCount, _instances.size(), taskCount,
+                    tasks.size());
+    }
+
+    _renderer.taskCount = static_cast<uint32_t>(taskCount);
+
+    uploadBuffer(_uploads, _renderer.meshes.buffer, 0, _meshes.data(),
+                 meshCount * sizeof(MeshletMesh));
+    uploadBuffer(_uploads, _renderer.instances.buffer, 0, instances.data(),
+                 instances.size() * sizeof(MeshletInstance));
+
+    return uploadBuffer(_uploads, _renderer.tasks.buffer, 0, tasks.data(),
+                        taskCount * sizeof(MeshletTask));
+}
+
+void recordMeshletCulling(MeshletRenderer& _renderer, CommandBuffer _commandBuffer,
+                          MeshletCullUniforms _uniforms, TextureHandle _depthPyramid,
+                          SamplerHandle _pyramidSampler)
+{
+    _uniforms.taskCount = _renderer.taskCount;
+    _uniforms.maxVisible = _renderer.meshShader ? 0 : _renderer.visibleCapacity;
+    if (!_depthPyramid.isValid() || !_pyramidSampler.isValid())
+    {
+        _uniforms.flags &= ~MeshletCullUniforms::k_occlusion;
+    }
+
+    _renderer.depthPyramid = _depthPyramid;
+    _renderer.pyramidSampler = _pyramidSampler;
+
+    // the previous frame drew from these buffers
+    bufferBarrier(_commandBuffer, getDrawStages(_renderer), 0, VK_PIPELINE_STAGE_TRANSFER_BIT, 0);
+
+    vkCmdUpdateBuffer(_commandBuffer, _renderer.uniforms.buffer, 0, sizeof(MeshletCullUniforms),
+                      &_uniforms);
+
+    if (_renderer.meshShader)
+    {
+        bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                      getDrawStages(_renderer), VK_ACCESS_SHADER_READ_BIT);
+        return;
+    }
+
+    // the instances counted by the culling, every triangle of a meshlet drawn
+    const VkDrawIndirectCommand arguments = {k_maxMeshletTriangles * 3, 0, 0, 0};
+    vkCmdUpdateBuffer(_commandBuffer, _renderer.drawArguments.buffer, 0, sizeof(arguments),
+                      &arguments);
+
+    bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                  VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    const MeshletConstants constants = getConstants(_renderer);
+
+    bindComputePipeline(_renderer.cullPipeline, _commandBuffer);
+    bindResourceTable(*_renderer.table, _commandBuffer, _renderer.cullPipeline.pipelineLayout,
+                      VK_PIPELINE_BIND_POINT_COMPUTE);
+    vkCmdPushConstants(_commandBuffer, _renderer.cullPipeline.pipelineLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MeshletConstants), &constants);
+
+    const VkExtent2D grid = getTaskGrid(_renderer.taskCount);
+    if (grid.width > 0) vkCmdDispatch(_commandBuffer, grid.width, grid.height, 1);
+
+    bufferBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_SHADER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                  VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+}
+
+void drawMeshlets(const MeshletRenderer& _renderer, CommandBuffer _commandBuffer)
+{
+    if (_renderer.meshShader)
+    {
+        const VkExtent2D grid = getTaskGrid(_renderer.taskCount);
+        if (grid.width == 0) return;
+
+        const MeshletConstants constants = getConstants(_renderer);
+
+        bindGraphicsPipeline(_renderer.meshPipeline, _commandBuffer);
+        bindResourceTable(*_renderer.table, _commandBuffer,
+                          _renderer.meshPipeline.pipelineLayout);
+        vkCmdPushConstants(_commandBuffer, _renderer.meshPipeline.pipelineLayout, k_meshStages, 0,
+                           sizeof(MeshletConstants), &constants);
+
+        vkCmdDrawMeshTasksEXT(_commandBuffer, grid.width, grid.height, 1);
+        return;
+    }
+
+    // meshlet.vert's DrawConstants
+    const std::array<uint32_t, DrawCall::k_maxResources> resources = {
+        _renderer.instances.handle.value, _renderer.meshes.handle.value,
+        _renderer.uniforms.handle.value, _renderer.visible.handle.value};
+
+    bindGraphicsPipeline(_renderer.emulatedPipeline, _commandBuffer);
+    bindResourceTable(*_renderer.table, _commandBuffer, _renderer.emulatedPipeline.pipelineLayout);
+    vkCmdPushConstants(_commandBuffer, _renderer.emulatedPipeline.pipelineLayout,
+                       k_resourceStages, 0, sizeof(resources), resources.data());
+
+    vkCmdDrawIndirect(_commandBuffer, _renderer.drawArguments.buffer, 0, 1,
+                      sizeof(VkDrawIndirectCommand));
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/meshlet_culling.hpp"
+#include "mosaic/graphics/shader_library.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+#include "pipelines/vulkan_pipeline.hpp"
+#include "vulkan_mesh_store.hpp"
+#include "vulkan_resource_table.hpp"
+#include "vulkan_upload_manager.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The meshlet draws of a scene, culled per meshlet on the GPU (frustum, normal cone, depth
+ * pyramid) where the instance culling keeps or drops whole meshes: the instances are split in
+ * MeshletTasks of up to k_meshletTaskSize meshlets, a workgroup each.
+ *
+ * With Device::meshShader a task workgroup culls its meshlets and launches a mesh workgroup per
+ * meshlet kept (meshlet.task, meshlet.mesh), one vkCmdDrawMeshTasksEXT() for the scene. Without,
+ * a compute pass does the culling (cull_meshlets.comp) and appends the meshlets kept to a list,
+ * drawn by one vkCmdDrawIndirect() of an instance per meshlet (meshlet.vert).
+ *
+ * The meshes are those of a MeshStore cooked with meshlets: the shaders read their packed
+ * vertices and meshlets through their BufferHandle (getMeshletMesh()). The buffers of the scene
+ * are in the ResourceTable, the shaders get their handles in push constants.
+ */
+struct MeshletRenderer
+{
+    struct Buffer
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        BufferHandle handle;
+    };
+
+    const Device* device;
+    VmaAllocator allocator;
+    ResourceTable* table;
+
+    Pipeline meshPipeline;     // meshlet.task, meshlet.mesh, with Device::meshShader
+    Pipeline cullPipeline;     // the fallback: cull_meshlets.comp
+    Pipeline emulatedPipeline; // and meshlet.vert
+
+    Buffer meshes;        // MeshletMesh, uploaded
+    Buffer instances;     // MeshletInstance, uploaded
+    Buffer tasks;         // MeshletTask, uploaded
+    Buffer uniforms;      // MeshletCullUniforms, updated in the command buffer
+    Buffer visible;       // VisibleMeshlet, of the fallback
+    Buffer drawArguments; // VkDrawIndirectCommand, of the fallback: reset, counted by the culling
+
+    uint32_t meshCapacity;
+    uint32_t instanceCapacity;
+    uint32_t taskCapacity;
+    uint32_t visibleCapacity; // every meshlet of taskCapacity tasks
+
+    uint32_t taskCount;
+    bool meshShader; // the task and mesh shaders drawn, else the fallback
+
+    // Of the last recordMeshletCulling(), the task shader tests against it
+    TextureHandle depthPyramid;
+    SamplerHandle pyramidSampler;
+
+    MeshletRenderer()
+        : device(nullptr),
+          allocator(VK_NULL_HANDLE),
+          table(nullptr),
+          meshCapacity(0),
+          instanceCapacity(0),
+          taskCapacity(0),
+          visibleCapacity(0),
+          taskCount(0),
+          meshShader(false){};
+};
+
+/**
+ * @brief The meshlet shaders are loaded through _shaders, the pipelines of the path the device
+ * has compiled once for the render passes of _colorFormat and _renderPass (as
+ * createGraphicsPipeline()).
+ */
+void createMeshletRenderer(MeshletRenderer& _renderer, const Device& _device,
+                           VmaAllocator _allocator, ResourceTable& _table, ShaderLibrary& _shaders,
+                           VkFormat _colorFormat, VkRenderPass _renderPass,
+                           uint32_t _meshCapacity, uint32_t _instanceCapacity,
+                           uint32_t _taskCapacity, VkPipelineCache _cache = VK_NULL_HANDLE);
+
+void destroyMeshletRenderer(MeshletRenderer& _renderer);
+
+// Where the meshlet shaders read _mesh: MeshletInstance::mesh indexes those of the scene.
+MeshletMesh getMeshletMesh(const MeshStore::Mesh& _mesh);
+
+/**
+ * @brief Uploads the meshes and instances of the scene and their tasks (buildMeshletTasks()),
+ * usable by the frames recorded once the ticket is. The meshlet ranges of the instances are those
+ * of a MeshLod of their mesh, not checked.
+ */
+UploadTicket setMeshletScene(MeshletRenderer& _renderer, UploadManager& _uploads,
+                             std::span<const MeshletMesh> _meshes,
+                             std::span<const MeshletInstance> _instances);
+
+/**
+ * @brief Records the update of _uniforms (the camera, from which the frustum and the occlusion
+ * parameters) and, without mesh shaders, the culling pass, outside a render pass. The depth
+ * pyramid is read when MeshletCullUniforms::k_occlusion is set, of the depth drawn earlier in the
+ * frame (the early pass of GpuCulling, recordDepthPyramid()), as for recordGpuCulling().
+ */
+void recordMeshletCulling(MeshletRenderer& _renderer, CommandBuffer _commandBuffer,
+                          MeshletCullUniforms _uniforms, TextureHandle _depthPyramid = {},
+                          SamplerHandle _pyramidSampler = {});
+
+// The draw of the meshlets, in a render pass after recordMeshletCulling(): its pipeline bound.
+void drawMeshlets(const MeshletRenderer& _renderer, CommandBuffer _commandBuffer);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,147 @@
+#include "vulkan_readback.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include "mosaic/exec/thread_pool.hpp"
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// A multiple of every texel size, and of the 4 bytes vkCmdCopyImageToBuffer() offsets need
+static constexpr size_t k_readbackAlignment = 16;
+
+static void memoryBarrier(CommandBuffer _commandBuffer, VkPipelineStageFlags _srcStages,
+                          VkAccessFlags _srcAccess, VkPipelineStageFlags _dstStages,
+                          VkAccessFlags _dstAccess)
+{
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = _srcAccess;
+    barrier.dstAccessMask = _dstAccess;
+
+    vkCmdPipelineBarrier(_commandBuffer, _srcStages, _dstStages, 0, 1, &barrier, 0, nullptr, 0,
+                         nullptr);
+}
+
+// The copy made available to the host, visible once invalidated after the frame completed
+static void hostReadBarrier(CommandBuffer _commandBuffer)
+{
+    memoryBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+}
+
+void createReadbackManager(ReadbackManager& _manager, VmaAllocator _allocator, VkDeviceSize _size)
+{
+    _manager.allocator = _allocator;
+
+    void* mapped = nullptr;
+    createReadbackBuffer(_allocator, _size, _manager.buffer, _manager.allocation, mapped);
+
+    _manager.mapped = static_cast<std::byte*>(mapped);
+    _manager.ring.reset(_manager.mapped, _size);
+}
+
+void destroyReadbackManager(ReadbackManager& _manager)
+{
+    _manager.ring.cancel();
+
+    if (_manager.buffer != VK_NULL_HANDLE)
+    {
+        destroyMappedBuffer(_manager.allocator, _manager.buffer, _manager.allocation);
+    }
+
+    _manager.mapped = nullptr;
+}
+
+Readback readBuffer(ReadbackManager& _manager, CommandBuffer _commandBuffer, uint64_t _frame,
+                    VkBuffer _buffer, VkDeviceSize _offset, VkDeviceSize _size,
+                    VkPipelineStageFlags _srcStages, VkAccessFlags _srcAccess)
+{
+    Readback readback = _manager.ring.allocate(_size, _frame, k_readbackAlignment);
+    if (!readback) return readback;
+
+    memoryBarrier(_commandBuffer, _srcStages, _srcAccess, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_ACCESS_TRANSFER_READ_BIT);
+
+    VkBufferCopy copy = {};
+    copy.srcOffset = _offset;
+    copy.dstOffset = readback.offset;
+    copy.size = _size;
+    vkCmdCopyBuffer(_commandBuffer, _buffer, _manager.buffer, 1, &copy);
+
+    hostReadBarrier(_commandBuffer);
+    return readback;
+}
+
+Readback readImage(ReadbackManager& _manager, CommandBuffer _commandBuffer, uint64_t _frame,
+                   VkImage _image, VkImageAspectFlags _aspect, VkOffset2D _offset,
+                   VkExtent2D _extent, uint32_t _texelSize)
+{
+    const size_t size = size_t{_extent.width} * _extent.height * _texelSize;
+
+    Readback readback = _manager.ring.allocate(size, _frame, k_readbackAlignment);
+    if (!readback) return readback;
+
+    VkBufferImageCopy copy = {};
+    copy.bufferOffset = readback.offset;
+    copy.bufferRowLength = 0; // tightly packed
+    copy.bufferImageHeight = 0;
+    copy.imageSubresource = {_aspect, 0, 0, 1};
+    copy.imageOffset = {_offset.x, _offset.y, 0};
+    copy.imageExtent = {_extent.width, _extent.height, 1};
+    vkCmdCopyImageToBuffer(_commandBuffer, _image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           _manager.buffer, 1, &copy);
+
+    hostReadBarrier(_commandBuffer);
+    return readback;
+}
+
+exec::TaskFuture<uint32_t> readPickedEntity(ReadbackManager& _manager,
+                                            CommandBuffer _commandBuffer, uint64_t _frame,
+                                            VkImage _ids, VkExtent2D _extent, glm::uvec2 _pixel)
+{
+    const PickRegion region = getPickRegion(_pixel, {_extent.width, _extent.height});
+
+    if (region.empty())
+    {
+        exec::TaskPromise<uint32_t> nothing;
+        exec::TaskFuture<uint32_t> future = nothing.getFuture();
+        nothing.setValue(0u);
+        return future;
+    }
+
+    Readback readback = readImage(
+        _manager, _commandBuffer, _frame, _ids, VK_IMAGE_ASPECT_COLOR_BIT,
+        {static_cast<int32_t>(region.offset.x), static_cast<int32_t>(region.offset.y)},
+        {region.extent.x, region.extent.y}, sizeof(uint32_t));
+    if (!readback) return {};
+
+    return readback.future.then(
+        [region, _pixel](std::vector<std::byte> _bytes)
+        {
+            std::vector<uint32_t> ids(_bytes.size() / sizeof(uint32_t));
+            std::memcpy(ids.data(), _bytes.data(), ids.size() * sizeof(uint32_t));
+
+            return findPickedEntity(ids, region, _pixel);
+        });
+}
+
+void completeReadbacks(ReadbackManager& _manager, uint64_t _completedFrame)
+{
+    if (_manager.ring.getPendingCount() == 0) return;
+
+    // the whole ring, the copies completed are read out of it at once
+    invalidateMappedBuffer(_manager.allocator, _manager.allocation, 0, VK_WHOLE_SIZE);
+    _manager.ring.complete(_completedFrame);
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
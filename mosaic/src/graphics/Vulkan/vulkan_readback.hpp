@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec2.hpp>
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/readback.hpp"
+
+#include "vulkan_common.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The GPU to CPU copies of the frames in flight, into a ReadbackRing over a persistently
+ * mapped, host cached buffer: recorded in the command buffer of a frame, their futures complete
+ * in completeReadbacks() once the timeline of the frames reached it, frames later. Nothing waits
+ * for the device, a copy the ring has no room for is refused.
+ *
+ * _frame is the value of the frame timeline the frame recording signals (the count of frames
+ * submitted once it is), the same counter completeReadbacks() is given.
+ */
+struct ReadbackManager
+{
+    VmaAllocator allocator;
+
+    VkBuffer buffer;
+    VmaAllocation allocation;
+    std::byte* mapped;
+
+    ReadbackRing ring;
+
+    ReadbackManager()
+        : allocator(VK_NULL_HANDLE),
+          buffer(VK_NULL_HANDLE),
+          allocation(VK_NULL_HANDLE),
+          mapped(nullptr){};
+};
+
+void createReadbackManager(ReadbackManager& _manager, VmaAllocator _allocator, VkDeviceSize _size);
+
+// Breaks the futures of the copies in flight: once the device no longer writes them.
+void destroyReadbackManager(ReadbackManager& _manager);
+
+/**
+ * @brief Records the copy of _size bytes of _buffer from _offset, outside a render pass, after
+ * the writes of _srcStages and _srcAccess (e.g. the counters a compute pass wrote).
+ */
+Readback readBuffer(ReadbackManager& _manager, CommandBuffer _commandBuffer, uint64_t _frame,
+                    VkBuffer _buffer, VkDeviceSize _offset, VkDeviceSize _size,
+                    VkPipelineStageFlags _srcStages, VkAccessFlags _srcAccess);
+
+/**
+ * @brief Records the copy of a rectangle of the first mip and layer of _image, in
+ * TRANSFER_SRC_OPTIMAL (ResourceAccess::TransferSource of the render graph), as tightly packed
+ * texels of _texelSize bytes row by row: a screenshot, a region of an attachment.
+ */
+Readback readImage(ReadbackManager& _manager, CommandBuffer _commandBuffer, uint64_t _frame,
+                   VkImage _image, VkImageAspectFlags _aspect, VkOffset2D _offset,
+                   VkExtent2D _extent, uint32_t _texelSize);
+
+/**
+ * @brief The entity under _pixel: the PickRegion around it of the entity ID attachment _ids, of
+ * _extent (TextureFormat::R32UI, in TRANSFER_SRC_OPTIMAL), read back and searched with
+ * findPickedEntity(). 0 at once for a click outside; not valid when the ring is full, to ask again
+ * on the next frame.
+ *
+ * The ID pass only has to run the frames a pick is recorded in, scissored to the region
+ * (getPickRegion()), so selecting costs the frame rate nothing.
+ */
+exec::TaskFuture<uint32_t> readPickedEntity(ReadbackManager& _manager,
+                                            CommandBuffer _commandBuffer, uint64_t _frame,
+                                            VkImage _ids, VkExtent2D _extent, glm::uvec2 _pixel);
+
+// Completes the copies of the frames up to _completedFrame, their bytes made visible to the CPU.
+void completeReadbacks(ReadbackManager& _manager, uint64_t _completedFrame);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
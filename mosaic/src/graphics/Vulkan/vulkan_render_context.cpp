@@ -1,9 +1,16 @@
 #include "vulkan_render_context.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
 #if defined(MOSAIC_PLATFORM_ANDROID)
 #include "mosaic/platform/AGDK/agdk_platform.hpp"
 #endif
 
+#include "mosaic/core/timer.hpp"
+
 #include "vulkan_render_system.hpp"
 
 namespace mosaic
@@ -13,36 +20,144 @@ namespace graphics
 namespace vulkan
 {
 
+// Smaller ranges of draws are not worth a secondary command buffer, recorded by a worker
+static constexpr size_t k_minDrawsPerRange = 256;
+
+// Per-frame data of a frame in flight, e.g. 16k objects of 256 bytes of uniforms
+static constexpr VkDeviceSize k_frameRingSize = 4 * 1024 * 1024;
+
+static constexpr const char* k_triangleVertexShader = "shaders/bin/triangle.vert.spv";
+static constexpr const char* k_triangleFragmentShader = "shaders/bin/triangle.frag.spv";
+
+// The features of the triangle material, the specialization constants of triangle.frag
+enum class TriangleFeature : uint32_t
+{
+    Grayscale
+};
+
+static constexpr ShaderVariantKey k_triangleVariant = makeShaderVariantKey<TriangleFeature>({});
+
+// The count of frames submitted once the slot of the next frame is free: the frame submitted
+// _framesInFlight frames before it completed
+static uint64_t getReusableFrame(uint64_t _submittedFrames, uint32_t _framesInFlight)
+{
+    return _submittedFrames >= _framesInFlight ? _submittedFrames + 1 - _framesInFlight : 0;
+}
+
 VulkanRenderContext::VulkanRenderContext(const window::Window* _window,
                                          const RenderContextSettings& _settings)
     : RenderContext(_window, _settings),
       m_instance(nullptr),
       m_device(nullptr),
+      m_allocator(VK_NULL_HANDLE),
+      m_shaderLibrary(nullptr),
+      m_shaderGeneration(0),
+      m_pipelineLibrary(nullptr),
+      m_uploadManager(nullptr),
+      m_uploadWait(0),
+      m_resourceTable(nullptr),
+      m_lastTrianglePipeline(nullptr),
+      m_lastTriangleFormat(VK_FORMAT_UNDEFINED),
+      m_dynamicResolution(false),
+      m_resolutionScaler(_settings.resolution),
+      m_sceneExtent{0, 0},
       m_currentFrame(0),
-      m_framebufferResized(false){};
+      m_framesInFlight(std::clamp(_settings.framesInFlight, 1u, FramePacer::k_maxFramesInFlight)),
+      m_submittedFrames(0),
+      m_completedFrames(0),
+      m_frameTimeline(VK_NULL_HANDLE),
+      m_graphicsTimeline(VK_NULL_HANDLE),
+      m_computeTimeline(VK_NULL_HANDLE),
+      m_graphicsSignals(0),
+      m_computeSignals(0),
+      m_framebufferResized(false),
+      m_headless(_window == nullptr),
+      m_surfaceLost(false),
+      m_graphExtent{0, 0},
+      m_exportingFrames(false){};
 
 pieces::RefResult<RenderContext, std::string> VulkanRenderContext::initialize(
     RenderSystem* _renderSystem)
 {
     m_instance = static_cast<VulkanRenderSystem*>(_renderSystem)->getInstance();
     m_device = static_cast<VulkanRenderSystem*>(_renderSystem)->getDevice();
+    m_allocator = static_cast<VulkanRenderSystem*>(_renderSystem)->getAllocator();
+    m_shaderLibrary = static_cast<VulkanRenderSystem*>(_renderSystem)->getShaderLibrary();
+    m_pipelineLibrary = static_cast<VulkanRenderSystem*>(_renderSystem)->getPipelineLibrary();
+    m_uploadManager = static_cast<VulkanRenderSystem*>(_renderSystem)->getUploadManager();
+    m_resourceTable = static_cast<VulkanRenderSystem*>(_renderSystem)->getResourceTable();
 
     auto window = getWindowInternal();
     auto& settings = getSettings();
 
-    m_frameData.resize(getSettings().backbufferCount);
+    m_frameData.resize(m_framesInFlight);
 
-    createSurface(m_surface, *m_instance, window->getNativeHandle());
+    if (m_framesInFlight > m_resourceTable->retireFrames)
+    {
+        MOSAIC_WARN("{} frames in flight outlive the {} frames released resources are retired for!",
+                    m_framesInFlight, m_resourceTable->retireFrames);
+    }
 
-    createSwapchain(m_swapchain, *m_device, m_surface, window->getNativeHandle(),
-                    window->getFramebufferSize(), window->getWindowProperties().isFullscreen);
+    // Headless, the image of a frame is that of its slot: free again once the frame completed,
+    // with no acquire. The queues are found without a surface
+    if (m_headless)
+    {
+        createOffscreenSwapchain(m_swapchain, *m_device, m_allocator, settings.offscreenExtent,
+                                 m_framesInFlight, settings.exportFrames);
+    }
+    else
+    {
+        createSurface(m_surface, *m_instance, window->getNativeHandle());
+
+        createSwapchain(m_swapchain, *m_device, m_surface, window->getNativeHandle(),
+                        window->getFramebufferSize(), window->getWindowProperties().isFullscreen,
+                        settings.backbufferCount, settings.presentPolicy);
+    }
+
+    // compiled by a worker, the frames clear the backbuffer until it is ready
+    loadShaders();
+    m_trianglePipeline.rasterState.frontFaceCCW = false;
+    m_trianglePipeline.depthState.depthTestEnable = false;
+    m_trianglePipeline.depthState.depthWriteEnable = false;
+    m_trianglePipeline.debugName = "Triangle";
 
-    createRenderPass(m_renderPass, *m_device, m_swapchain);
-    createGraphicsPipeline(m_pipeline, *m_device, m_swapchain, m_renderPass);
-    createSwapchainFramebuffers(m_swapchain, *m_device, m_renderPass);
     createCommandPool(m_commandPool, *m_device, m_surface);
 
+    // blitted to the backbuffer, which the surface may not allow
+    m_dynamicResolution = settings.dynamicResolution;
+    if (m_dynamicResolution && !(m_swapchain.usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+    {
+        MOSAIC_WARN("Vulkan surface images cannot be blitted to, dynamic resolution disabled.");
+        m_dynamicResolution = false;
+    }
+
+    // the async compute passes of the graph run on the graphics queue without a family of theirs
+    if (m_device->computeFamily != m_device->graphicsFamily)
+    {
+        createCommandPool(m_computePool, *m_device, m_device->computeFamily);
+    }
+
+    buildRenderGraph();
+    createRenderGraph();
+
     createFrames();
+    createFrameRingBuffer(m_frameRing, *m_device, m_allocator, *m_resourceTable, k_frameRingSize,
+                          m_framesInFlight);
+    createDescriptorAllocator(m_descriptors, *m_device, m_framesInFlight);
+    createParallelCommands(m_parallelCommands, *m_device, m_surface, m_framesInFlight);
+    createTimestampQueries(m_timestampQueries, *m_device, m_surface, m_commandPool,
+                           m_framesInFlight);
+
+    // the GPU time of every frame, not only while traced; without it the scale stays
+    m_timestampQueries.measureFrames = m_dynamicResolution;
+    if (m_dynamicResolution && !m_timestampQueries.supported)
+    {
+        MOSAIC_WARN("Vulkan dynamic resolution has no GPU time to follow, the scale stays {}.",
+                    m_resolutionScaler.getScale());
+    }
+
+    // no window to resize nor to lose
+    if (m_headless) return pieces::OkRef<RenderContext, std::string>(*this);
 
 #if defined(MOSAIC_PLATFORM_DESKTOP) || defined(MOSAIC_PLATFORM_WEB)
 
@@ -70,184 +185,643 @@ void VulkanRenderContext::shutdown()
 {
     vkDeviceWaitIdle(m_device->device);
 
+    destroyTimestampQueries(m_timestampQueries, *m_device);
     destroyFrames();
+    destroyFrameRingBuffer(m_frameRing, m_allocator, *m_resourceTable);
+    destroyDescriptorAllocator(m_descriptors);
+    destroyParallelCommands(m_parallelCommands, *m_device);
 
     destroyCommandPool(m_commandPool, *m_device);
-    destroySwapchainFramebuffers(m_swapchain, *m_device);
-    destroyGraphicsPipeline(m_pipeline, *m_device);
-    destroyRenderPass(m_renderPass, *m_device);
+    if (m_computePool.commandPool) destroyCommandPool(m_computePool, *m_device);
+    destroyRetiredSwapchains(true);
+    destroyRenderGraphTextures(m_graphTextures, *m_device);
     destroySwapchain(m_swapchain);
-    destroySurface(m_surface, *m_instance);
+    if (!m_headless) destroySurface(m_surface, *m_instance);
+}
+
+pieces::Result<ExportedFrames, std::string> VulkanRenderContext::exportFrames()
+{
+    ExportedFrames frames;
+
+    if (!m_headless || !exportOffscreenSwapchain(m_swapchain, frames))
+    {
+        return pieces::Err<ExportedFrames, std::string>(
+            "Vulkan context has no exportable offscreen images");
+    }
+
+    // a new consumer, none of the images is held by it yet
+    m_exportingFrames = true;
+    m_exportedImagesHeld.assign(frames.images.size(), false);
+    m_lastExportedImage.reset();
+
+    return pieces::Ok<ExportedFrames, std::string>(std::move(frames));
+}
+
+std::optional<uint32_t> VulkanRenderContext::getLastExportedImage() const
+{
+    return m_lastExportedImage;
 }
 
 void VulkanRenderContext::resizeFramebuffer()
 {
+    // no surface to make a swapchain for, recreateSurface() makes one of the new size
+    if (m_surfaceLost) return;
+
     auto window = getWindowInternal();
 
-    auto framebufferSize = window->getFramebufferSize();
+    const auto framebufferSize = window->getFramebufferSize();
 
-    while (framebufferSize.x * framebufferSize.y == 0)
-    {
-        framebufferSize = window->getFramebufferSize();
-    }
+    // Minimized: tried again by the next frames, the window system waits for the events meanwhile
+    if (framebufferSize.x * framebufferSize.y == 0) return;
 
-    vkDeviceWaitIdle(m_device->device);
+    // The frames in flight still render to the old images, through the old graph textures: both
+    // live until those frames complete, without waiting for the device
+    RetiredSwapchain& retired = m_retiredSwapchains.emplace_back();
+    retired.swapchain = std::exchange(m_swapchain, Swapchain());
+    retired.graphTextures = std::exchange(m_graphTextures, RenderGraphTextures());
+    retired.submittedFrames = m_submittedFrames;
 
-    destroySwapchainFramebuffers(m_swapchain, *m_device);
-    destroyGraphicsPipeline(m_pipeline, *m_device);
-    destroyRenderPass(m_renderPass, *m_device);
-    destroySwapchain(m_swapchain);
+    // presented to the old swapchain, their present ids are no longer waited for
+    if (m_device->presentWait) getInputLatencyInternal().discardFrames();
 
     createSwapchain(m_swapchain, *m_device, m_surface, window->getNativeHandle(), framebufferSize,
-                    window->getWindowProperties().isFullscreen);
+                    window->getWindowProperties().isFullscreen, getSettings().backbufferCount,
+                    getSettings().presentPolicy, retired.swapchain.swapchain);
 
-    createRenderPass(m_renderPass, *m_device, m_swapchain);
-    createGraphicsPipeline(m_pipeline, *m_device, m_swapchain, m_renderPass);
-    createSwapchainFramebuffers(m_swapchain, *m_device, m_renderPass);
+    // the pipelines outlive the swapchain, the library compiles again only for a new format
+    createRenderGraph();
 
     m_framebufferResized = false;
 }
 
 void VulkanRenderContext::recreateSurface()
 {
+    if (m_headless) return;
+
     auto window = getWindowInternal();
-    auto windowProps = window->getWindowProperties();
 
+    // Only the native window changed: the device, the pipelines (by format in the library) and
+    // the resources live on, the surface and the swapchain alone are made again
+    if (!m_surfaceLost) releaseSurface();
     if (!window->getNativeHandle()) return;
 
-    vkDeviceWaitIdle(m_device->device);
+    createSurface(m_surface, *m_instance, window->getNativeHandle());
+    createSwapchain(m_swapchain, *m_device, m_surface, window->getNativeHandle(),
+                    window->getFramebufferSize(), window->getWindowProperties().isFullscreen,
+                    getSettings().backbufferCount, getSettings().presentPolicy);
 
-    destroySwapchainFramebuffers(m_swapchain, *m_device);
-    destroyGraphicsPipeline(m_pipeline, *m_device);
-    destroyRenderPass(m_renderPass, *m_device);
+    m_surfaceLost = false;
+    m_framebufferResized = false;
+
+    // the render passes and transients are kept for a swapchain of the same format and extent
+    const RenderGraphTextures::Texture& backbuffer = m_graphTextures.textures[m_backbuffer.id];
+
+    if (!m_graphTextures.passes.empty() &&
+        backbuffer.format == m_swapchain.surfaceFormat.format &&
+        m_graphExtent.width == m_swapchain.extent.width &&
+        m_graphExtent.height == m_swapchain.extent.height)
+    {
+        bindRenderGraphTexture(m_graphTextures, m_backbuffer, m_swapchain.images[0],
+                               m_swapchain.imageViews[0], m_swapchain.surfaceFormat.format);
+        return;
+    }
+
+    destroyRenderGraphTextures(m_graphTextures, *m_device);
+    createRenderGraph();
+}
+
+void VulkanRenderContext::releaseSurface()
+{
+    // the frames presenting to the window, not the device: the uploads and the other contexts
+    // keep going
+    waitForFrames(m_submittedFrames);
+
+    // a swapchain does not outlive its surface
+    if (m_device->presentWait) getInputLatencyInternal().discardFrames();
+    destroyRetiredSwapchains(true);
+    releaseRenderGraphFramebuffers(m_graphTextures, *m_device);
     destroySwapchain(m_swapchain);
     destroySurface(m_surface, *m_instance);
 
-    createSurface(m_surface, *m_instance, window->getNativeHandle());
-    createSwapchain(m_swapchain, *m_device, m_surface, window->getNativeHandle(),
-                    window->getFramebufferSize(), window->getWindowProperties().isFullscreen);
-    createRenderPass(m_renderPass, *m_device, m_swapchain);
-    createGraphicsPipeline(m_pipeline, *m_device, m_swapchain, m_renderPass);
-    createSwapchainFramebuffers(m_swapchain, *m_device, m_renderPass);
+    // null handles, nothing left for shutdown() to destroy
+    m_swapchain = Swapchain();
+    m_surface = Surface();
+    m_surfaceLost = true;
+}
+
+void VulkanRenderContext::applyPresentPolicy()
+{
+    // the present mode is fixed at creation: replaced like on a resize, the frames in flight
+    // presenting the old images. Nothing is presented headless
+    if (!m_headless) m_framebufferResized = true;
+}
+
+void VulkanRenderContext::waitForFrame()
+{
+    waitForFrames(getReusableFrame(m_submittedFrames, m_framesInFlight));
+
+    // Started when the frames in flight leave the frame its CPU time to reach the GPU as it gets
+    // idle: the input it samples is that much more recent, the queue no longer holds it back
+    if (getSettings().lowLatency)
+    {
+        const FramePacer::Clock::duration delay = m_framePacer.getDelay(FramePacer::Clock::now());
+        if (delay > FramePacer::Clock::duration::zero()) core::Timer::sleepFor(delay);
+    }
+
+    m_framePacer.beginFrame(FramePacer::Clock::now());
 }
 
-void VulkanRenderContext::beginFrame()
+bool VulkanRenderContext::beginFrame()
 {
+    // Nothing to present to until the window comes back: APP_CMD_INIT_WINDOW calls
+    // recreateSurface(), which clears m_surfaceLost. A window back without it (a change the
+    // platform did not report) is picked up here, so the frames do not stay skipped
+    if (m_surfaceLost)
+    {
+        if (!getWindowInternal()->getNativeHandle()) return false;
+
+        recreateSurface();
+        if (m_surfaceLost) return false;
+    }
+
+    if (m_framebufferResized) resizeFramebuffer();
+
+    // still minimized
+    if (m_framebufferResized) return false;
+
     auto& frame = m_frameData[m_currentFrame];
 
-    // Wait for previous frame to finish
-    vkWaitForFences(m_device->device, 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+    // The frame that used the slot last completed, already waited for by waitForFrame()
+    waitForFrames(getReusableFrame(m_submittedFrames, m_framesInFlight));
+
+    // The GPU timings of this frame's last use are now available
+    collectTimestampQueries(m_timestampQueries, *m_device, m_currentFrame);
+    if (m_dynamicResolution) updateResolutionScale();
+
+    // and its region of the ring is free again, its descriptor pools too
+    beginFrameRingBuffer(m_frameRing, m_currentFrame);
+    resetDescriptorAllocator(m_descriptors, m_currentFrame);
 
-    // Acquire next image
-    VkResult acquireResult =
-        vkAcquireNextImageKHR(m_device->device, m_swapchain.swapchain, UINT64_MAX,
-                              frame.imageAvailableSemaphore, VK_NULL_HANDLE, &frame.imageIndex);
+    destroyRetiredSwapchains(false);
 
-    if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+    if (m_headless)
     {
-        resizeFramebuffer();
-        return;
+        frame.imageIndex = m_currentFrame;
     }
-    else if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR)
+    else
     {
-        throw std::runtime_error("failed to acquire swap chain image!");
+        // Acquire next image
+        VkResult acquireResult =
+            vkAcquireNextImageKHR(m_device->device, m_swapchain.swapchain, UINT64_MAX,
+                                  frame.imageAvailableSemaphore, VK_NULL_HANDLE, &frame.imageIndex);
+
+        // nothing was signaled, the slot is used by the next frame
+        if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            m_framebufferResized = true;
+            return false;
+        }
+        else if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR)
+        {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
     }
 
     // Prepare for new frame
-    vkResetFences(m_device->device, 1, &frame.inFlightFence);
     vkResetCommandBuffer(frame.commandBuffer, 0);
+
+    return true;
 }
 
 void VulkanRenderContext::updateResources()
 {
-    // For future per-frame resource updates (uniforms, descriptor sets, etc.)
-    // Currently empty
+    // Per-frame uniforms and dynamic geometry are allocated in m_frameRing, bound at the offset
+    // of their allocation: no buffer per object
+
+    m_drawQueue.clear();
+
+    // Shaders reloaded since: the new pipeline compiles on a worker, the last one of the format
+    // is drawn until it is ready
+    if (m_shaderLibrary->getGeneration() != m_shaderGeneration) loadShaders();
+
+    // that of the scene target, the swapchain's without dynamic resolution
+    const RenderGraphResource target = m_dynamicResolution ? m_scene : m_backbuffer;
+    const VkFormat format = m_graphTextures.textures[target.id].format;
+    const Pipeline* trianglePipeline =
+        acquirePipeline(*m_pipelineLibrary, m_trianglePipeline, format,
+                        m_lastTriangleFormat == format ? m_lastTrianglePipeline : nullptr);
+
+    if (trianglePipeline)
+    {
+        m_lastTrianglePipeline = trianglePipeline;
+        m_lastTriangleFormat = format;
+    }
+
+    m_pipelines.assign({trianglePipeline});
+
+    // the fullscreen triangle, its vertices generated by the vertex shader
+    if (trianglePipeline)
+    {
+        DrawCall triangle;
+        triangle.pipeline = 0;
+        triangle.vertexCount = 3;
+        m_drawQueue.submit(triangle);
+    }
+
+    m_drawQueue.sort();
 }
 
 void VulkanRenderContext::drawScene()
+{
+    // The uploads of the last frame start now, those done become usable by this one
+    submitUploads(*m_uploadManager);
+    recordFrame(true);
+}
+
+void VulkanRenderContext::recordFrame(bool _acquireUploads)
 {
     auto& frame = m_frameData[m_currentFrame];
 
     // Begin recording commands
     beingCommandBuffer(frame.commandBuffer, m_surface);
 
-    bindGraphicsPipeline(m_pipeline, frame.commandBuffer);
+    m_uploadWait = _acquireUploads ? acquireUploads(*m_uploadManager, frame.commandBuffer) : 0;
 
-    // Setup viewport
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(m_swapchain.extent.width);
-    viewport.height = static_cast<float>(m_swapchain.extent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(frame.commandBuffer, 0, 1, &viewport);
+    resetTimestampQueries(m_timestampQueries, frame.commandBuffer, m_currentFrame);
+    const uint32_t frameSpan =
+        beginTimestampSpan(m_timestampQueries, frame.commandBuffer, m_currentFrame, "GPU frame");
 
-    // Setup scissor
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = m_swapchain.extent;
-    vkCmdSetScissor(frame.commandBuffer, 0, 1, &scissor);
+    // The passes of the graph, to the swapchain image of the frame
+    bindRenderGraphTexture(m_graphTextures, m_backbuffer, m_swapchain.images[frame.imageIndex],
+                           m_swapchain.imageViews[frame.imageIndex],
+                           m_swapchain.surfaceFormat.format);
+
+    // on the queues of the batches, the frame ending in the submission of the last
+    CommandBuffer lastCommandBuffer = frame.commandBuffer;
+    frame.submits.clear();
 
-    // Render pass and drawing
-    beginRenderPass(m_renderPass, m_swapchain, frame.commandBuffer, frame.imageIndex);
-    vkCmdDraw(frame.commandBuffer, 3, 1, 0, 0);
-    endRenderPass(frame.commandBuffer);
+    if (m_computePool.commandPool && m_renderGraph.hasAsyncCompute())
+    {
+        lastCommandBuffer = recordRenderGraphBatches(frame);
+    }
+    else
+    {
+        executeRenderGraph(m_renderGraph, m_graphTextures, *m_device, frame.commandBuffer,
+                           m_timestampQueries, m_currentFrame);
+    }
+
+    endTimestampSpan(m_timestampQueries, lastCommandBuffer, m_currentFrame, frameSpan);
 
     // End recording
-    endCommandBuffer(frame.commandBuffer);
+    endCommandBuffer(lastCommandBuffer);
 }
 
-void VulkanRenderContext::endFrame()
+CommandBuffer VulkanRenderContext::recordRenderGraphBatches(FrameData& _frame)
 {
-    auto& frame = m_frameData[m_currentFrame];
+    const auto batches = m_renderGraph.getBatches();
 
-    // Submit draw command
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    // the transients the compute batches use again, once the last frame's graphics batches are
+    // done with them
+    const uint64_t lastFrame = m_graphicsSignals;
 
-    VkSemaphore waitSemaphores[] = {frame.imageAvailableSemaphore};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
+    size_t graphicsBuffers = 0;
+    size_t computeBuffers = 0;
 
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &frame.commandBuffer;
+    const auto open = [&](RenderGraphQueue _queue, uint64_t _wait, bool _signals = true)
+    {
+        const bool compute = _queue == RenderGraphQueue::AsyncCompute;
+        auto& buffers = compute ? _frame.computeCommandBuffers : _frame.graphicsCommandBuffers;
+        size_t& used = compute ? computeBuffers : graphicsBuffers;
 
-    VkSemaphore signalSemaphores[] = {frame.renderFinishedSemaphore};
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
+        if (used == buffers.size())
+        {
+            createCommandBuffer(buffers.emplace_back(), *m_device,
+                                compute ? m_computePool : m_commandPool);
+        }
 
-    if (vkQueueSubmit(m_device->graphicsQueue, 1, &submitInfo, frame.inFlightFence) != VK_SUCCESS)
+        CommandBuffer commandBuffer = buffers[used++];
+        vkResetCommandBuffer(commandBuffer, 0);
+        beingCommandBuffer(commandBuffer, m_surface);
+
+        uint64_t signal = 0;
+        if (_signals) signal = compute ? ++m_computeSignals : ++m_graphicsSignals;
+
+        _frame.submits.push_back({_queue, commandBuffer, _wait, signal, false});
+    };
+
+    // that of the frame, its start recorded already
+    _frame.submits.push_back(
+        {RenderGraphQueue::Graphics, _frame.commandBuffer, 0, ++m_graphicsSignals, true});
+
+    size_t graphics = 0; // the graphics submission recorded into
+    std::vector<size_t> submitOf(batches.size());
+
+    for (uint32_t i = 0; i < batches.size(); ++i)
+    {
+        const RenderGraphBatch& batch = batches[i];
+        const uint64_t wait = batch.wait != RenderGraphBatch::k_unused
+                                  ? _frame.submits[submitOf[batch.wait]].signal
+                                  : 0;
+
+        if (batch.queue == RenderGraphQueue::Graphics)
+        {
+            // A wait starts a submission, unless nothing was recorded into the last
+            if (wait > 0 && _frame.submits[graphics].recorded)
+            {
+                endCommandBuffer(_frame.submits[graphics].commandBuffer);
+                open(RenderGraphQueue::Graphics, wait);
+                graphics = _frame.submits.size() - 1;
+            }
+
+            GraphSubmit& submit = _frame.submits[graphics];
+            submit.wait = std::max(submit.wait, wait);
+            submit.recorded = true;
+            submitOf[i] = graphics;
+        }
+        else
+        {
+            // the graphics batch waited for ends its submission, signaled before the others
+            if (wait > 0 && submitOf[batch.wait] == graphics)
+            {
+                endCommandBuffer(_frame.submits[graphics].commandBuffer);
+                open(RenderGraphQueue::Graphics, 0);
+                graphics = _frame.submits.size() - 1;
+            }
+
+            open(RenderGraphQueue::AsyncCompute, std::max(wait, lastFrame));
+            submitOf[i] = _frame.submits.size() - 1;
+        }
+
+        GraphSubmit& submit = _frame.submits[submitOf[i]];
+        executeRenderGraphBatch(m_renderGraph, i, m_graphTextures, *m_device,
+                                submit.commandBuffer, m_timestampQueries, m_currentFrame);
+
+        if (batch.queue == RenderGraphQueue::AsyncCompute) endCommandBuffer(submit.commandBuffer);
+    }
+
+    // The final barriers once every compute batch completed, the frame with them: it signals the
+    // frame timeline rather than that of the batches
+    endCommandBuffer(_frame.submits[graphics].commandBuffer);
+    open(RenderGraphQueue::Graphics, m_computeSignals, false);
+
+    GraphSubmit& last = _frame.submits.back();
+    last.recorded = true;
+    recordRenderGraphFinalBarriers(m_renderGraph, m_graphTextures, last.commandBuffer);
+
+    return last.commandBuffer;
+}
+
+void VulkanRenderContext::endFrame()
+{
+    FrameSubmission submission;
+    prepareSubmission(submission, m_uploadWait);
+
+    std::vector<VkSubmitInfo> submitInfos;
+    std::vector<VkSubmitInfo> computeInfos;
+    for (const auto& submit : submission.graphicsSubmits) submitInfos.push_back(submit.submitInfo);
+    for (const auto& submit : submission.computeSubmits) computeInfos.push_back(submit.submitInfo);
+    submitInfos.push_back(submission.submitInfo);
+
+    // each queue waits for the values the other signals later (timeline semaphores)
+    if (vkQueueSubmit(m_device->graphicsQueue, static_cast<uint32_t>(submitInfos.size()),
+                      submitInfos.data(), VK_NULL_HANDLE) != VK_SUCCESS ||
+        (!computeInfos.empty() &&
+         vkQueueSubmit(m_device->computeQueue, static_cast<uint32_t>(computeInfos.size()),
+                       computeInfos.data(), VK_NULL_HANDLE) != VK_SUCCESS))
     {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
 
+    onSubmitted();
+
+    if (!submission.present)
+    {
+        onPresented(VK_SUCCESS);
+        return;
+    }
+
     // Present the rendered image
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
-
-    VkSwapchainKHR swapChains[] = {m_swapchain.swapchain};
+    presentInfo.pWaitSemaphores = submission.signalSemaphores;
     presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
-    presentInfo.pImageIndices = &frame.imageIndex;
+    presentInfo.pSwapchains = &submission.swapchain;
+    presentInfo.pImageIndices = &submission.imageIndex;
 
-    VkResult presentResult = vkQueuePresentKHR(m_device->presentQueue, &presentInfo);
-    if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR ||
+    VkPresentIdKHR presentId{};
+    presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    presentId.swapchainCount = 1;
+    presentId.pPresentIds = &submission.presentId;
+    if (submission.presentId) presentInfo.pNext = &presentId;
+
+    onPresented(vkQueuePresentKHR(m_device->presentQueue, &presentInfo));
+}
+
+void VulkanRenderContext::prepareSubmission(FrameSubmission& _submission,
+                                            UploadTicket _uploadWait)
+{
+    auto& frame = m_frameData[m_currentFrame];
+
+    flushFrameRingBuffer(m_frameRing, m_allocator);
+
+    // the upload timeline is already signaled, the wait only makes the copies visible. Headless,
+    // there is no image to acquire nor to present
+    uint32_t waitCount = 0;
+    if (!m_headless)
+    {
+        _submission.waitSemaphores[waitCount] = frame.imageAvailableSemaphore;
+        _submission.waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        _submission.waitValues[waitCount++] = 0;
+    }
+
+    if (_uploadWait > 0)
+    {
+        _submission.waitSemaphores[waitCount] = m_uploadManager->timeline;
+        _submission.waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        _submission.waitValues[waitCount++] = _uploadWait;
+    }
+
+    // Exported, the consumer may still sample the frame rendered into the image before
+    if (m_exportingFrames && m_exportedImagesHeld[frame.imageIndex])
+    {
+        _submission.waitSemaphores[waitCount] = m_swapchain.releasedSemaphores[frame.imageIndex];
+        _submission.waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        _submission.waitValues[waitCount++] = 0;
+    }
+
+    // the presentation waits for the semaphore of the image, the next frames for the timeline
+    uint32_t signalCount = 0;
+    if (!m_headless)
+    {
+        _submission.signalSemaphores[signalCount] =
+            m_swapchain.presentSemaphores[frame.imageIndex];
+        _submission.signalValues[signalCount++] = 0;
+    }
+
+    _submission.signalSemaphores[signalCount] = m_frameTimeline;
+    _submission.signalValues[signalCount++] = m_submittedFrames + 1;
+
+    if (m_exportingFrames)
+    {
+        _submission.signalSemaphores[signalCount] = m_swapchain.readySemaphores[frame.imageIndex];
+        _submission.signalValues[signalCount++] = 0;
+    }
+
+    _submission.timelineInfo = {};
+    _submission.timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    _submission.timelineInfo.waitSemaphoreValueCount = waitCount;
+    _submission.timelineInfo.pWaitSemaphoreValues = _submission.waitValues;
+    _submission.timelineInfo.signalSemaphoreValueCount = signalCount;
+    _submission.timelineInfo.pSignalSemaphoreValues = _submission.signalValues;
+
+    _submission.submitInfo = {};
+    _submission.submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    _submission.submitInfo.pNext = &_submission.timelineInfo;
+    _submission.submitInfo.waitSemaphoreCount = waitCount;
+    _submission.submitInfo.pWaitSemaphores = _submission.waitSemaphores;
+    _submission.submitInfo.pWaitDstStageMask = _submission.waitStages;
+    _submission.submitInfo.commandBufferCount = 1;
+    _submission.submitInfo.pCommandBuffers = &frame.commandBuffer;
+    _submission.submitInfo.signalSemaphoreCount = signalCount;
+    _submission.submitInfo.pSignalSemaphores = _submission.signalSemaphores;
+
+    _submission.present = !m_headless;
+    _submission.swapchain = m_swapchain.swapchain;
+    _submission.imageIndex = frame.imageIndex;
+    _submission.presentId = m_device->presentWait && !m_headless ? m_submittedFrames + 1 : 0;
+
+    if (!frame.submits.empty()) prepareBatchSubmissions(_submission, _uploadWait);
+}
+
+void VulkanRenderContext::prepareBatchSubmissions(FrameSubmission& _submission,
+                                                  UploadTicket _uploadWait)
+{
+    const auto& submits = m_frameData[m_currentFrame].submits;
+
+    size_t graphicsCount = 0;
+    size_t computeCount = 0;
+    for (const GraphSubmit& submit : submits)
+    {
+        (submit.queue == RenderGraphQueue::AsyncCompute ? computeCount : graphicsCount)++;
+    }
+
+    // the last graphics one is submitInfo; the vectors do not grow once the infos point in them
+    _submission.graphicsSubmits.resize(graphicsCount - 1);
+    _submission.computeSubmits.resize(computeCount);
+
+    size_t graphics = 0;
+    size_t compute = 0;
+
+    for (size_t i = 0; i + 1 < submits.size(); ++i)
+    {
+        const GraphSubmit& submit = submits[i];
+        const bool isCompute = submit.queue == RenderGraphQueue::AsyncCompute;
+
+        FrameSubmission::QueueSubmit& queueSubmit =
+            isCompute ? _submission.computeSubmits[compute++]
+                      : _submission.graphicsSubmits[graphics++];
+
+        // The first graphics submission waits for the image and the uploads in place of
+        // submitInfo, the first compute one for the uploads
+        uint32_t waitCount = 0;
+        if (i == 0)
+        {
+            for (; waitCount < _submission.submitInfo.waitSemaphoreCount; ++waitCount)
+            {
+                queueSubmit.waitSemaphores[waitCount] = _submission.waitSemaphores[waitCount];
+                queueSubmit.waitStages[waitCount] = _submission.waitStages[waitCount];
+                queueSubmit.waitValues[waitCount] = _submission.waitValues[waitCount];
+            }
+        }
+        else if (isCompute && compute == 1 && _uploadWait > 0)
+        {
+            queueSubmit.waitSemaphores[waitCount] = m_uploadManager->timeline;
+            queueSubmit.waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            queueSubmit.waitValues[waitCount++] = _uploadWait;
+        }
+
+        // a wait of the timeline of the other queue
+        if (submit.wait > 0)
+        {
+            queueSubmit.waitSemaphores[waitCount] = isCompute ? m_graphicsTimeline
+                                                              : m_computeTimeline;
+            queueSubmit.waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            queueSubmit.waitValues[waitCount++] = submit.wait;
+        }
+
+        queueSubmit.signalSemaphore = isCompute ? m_computeTimeline : m_graphicsTimeline;
+        queueSubmit.signalValue = submit.signal;
+
+        queueSubmit.timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        queueSubmit.timelineInfo.waitSemaphoreValueCount = waitCount;
+        queueSubmit.timelineInfo.pWaitSemaphoreValues = queueSubmit.waitValues;
+        queueSubmit.timelineInfo.signalSemaphoreValueCount = 1;
+        queueSubmit.timelineInfo.pSignalSemaphoreValues = &queueSubmit.signalValue;
+
+        queueSubmit.submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        queueSubmit.submitInfo.pNext = &queueSubmit.timelineInfo;
+        queueSubmit.submitInfo.waitSemaphoreCount = waitCount;
+        queueSubmit.submitInfo.pWaitSemaphores = queueSubmit.waitSemaphores;
+        queueSubmit.submitInfo.pWaitDstStageMask = queueSubmit.waitStages;
+        queueSubmit.submitInfo.commandBufferCount = 1;
+        queueSubmit.submitInfo.pCommandBuffers = &submit.commandBuffer;
+        queueSubmit.submitInfo.signalSemaphoreCount = 1;
+        queueSubmit.submitInfo.pSignalSemaphores = &queueSubmit.signalSemaphore;
+    }
+
+    // The last, the final barriers: once the last compute batch, then presented
+    const GraphSubmit& last = submits.back();
+
+    _submission.waitSemaphores[0] = m_computeTimeline;
+    _submission.waitStages[0] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    _submission.waitValues[0] = last.wait;
+
+    _submission.timelineInfo.waitSemaphoreValueCount = 1;
+    _submission.submitInfo.waitSemaphoreCount = 1;
+    _submission.submitInfo.pCommandBuffers = &last.commandBuffer;
+}
+
+void VulkanRenderContext::onSubmitted()
+{
+    if (m_exportingFrames)
+    {
+        const uint32_t image = m_frameData[m_currentFrame].imageIndex;
+
+        m_exportedImagesHeld[image] = true;
+        m_lastExportedImage = image;
+    }
+
+    ++m_submittedFrames;
+    m_framePacer.submitFrame(FramePacer::Clock::now());
+    getInputLatencyInternal().submitFrame(m_submittedFrames);
+}
+
+void VulkanRenderContext::onPresented(VkResult _result)
+{
+    if (_result == VK_ERROR_OUT_OF_DATE_KHR || _result == VK_SUBOPTIMAL_KHR ||
         m_framebufferResized)
     {
-        resizeFramebuffer();
+        // recreated by the next frame, before it acquires
+        m_framebufferResized = true;
     }
-    else if (presentResult != VK_SUCCESS)
+    else if (_result != VK_SUCCESS)
     {
         throw std::runtime_error("failed to present swap chain image!");
     }
 
     // Advance frame
-    m_currentFrame = (m_currentFrame + 1) % getSettings().backbufferCount;
+    m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+}
+
+void VulkanRenderContext::loadShaders()
+{
+    m_trianglePipeline.shaders = {
+        m_shaderLibrary->load(ShaderStage::Vertex, k_triangleVertexShader),
+        m_shaderLibrary->loadVariant(ShaderStage::Fragment, k_triangleFragmentShader,
+                                     k_triangleVariant)};
+
+    m_shaderGeneration = m_shaderLibrary->getGeneration();
 }
 
 void VulkanRenderContext::createFrames()
@@ -255,24 +829,263 @@ void VulkanRenderContext::createFrames()
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
     for (auto& frame : m_frameData)
     {
         createCommandBuffer(frame.commandBuffer, *m_device, m_commandPool);
 
         if (vkCreateSemaphore(m_device->device, &semaphoreInfo, nullptr,
-                              &frame.imageAvailableSemaphore) != VK_SUCCESS ||
-            vkCreateSemaphore(m_device->device, &semaphoreInfo, nullptr,
-                              &frame.renderFinishedSemaphore) != VK_SUCCESS ||
-            vkCreateFence(m_device->device, &fenceInfo, nullptr, &frame.inFlightFence) !=
-                VK_SUCCESS)
+                              &frame.imageAvailableSemaphore) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to create synchronization objects for a frame!");
         }
     }
+
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    semaphoreInfo.pNext = &typeInfo;
+
+    if (vkCreateSemaphore(m_device->device, &semaphoreInfo, nullptr, &m_frameTimeline) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create frame timeline semaphore!");
+    }
+
+    // those of the batches of each queue, with async compute
+    if (!m_computePool.commandPool) return;
+
+    if (vkCreateSemaphore(m_device->device, &semaphoreInfo, nullptr, &m_graphicsTimeline) !=
+            VK_SUCCESS ||
+        vkCreateSemaphore(m_device->device, &semaphoreInfo, nullptr, &m_computeTimeline) !=
+            VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create render graph timeline semaphores!");
+    }
+}
+
+void VulkanRenderContext::waitForFrames(uint64_t _frame)
+{
+    if (_frame > m_completedFrames)
+    {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_frameTimeline;
+        waitInfo.pValues = &_frame;
+
+        if (vkWaitSemaphores(m_device->device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to wait for a frame in flight!");
+        }
+    }
+
+    uint64_t completed = 0;
+    vkGetSemaphoreCounterValue(m_device->device, m_frameTimeline, &completed);
+
+    // completed by now, exactly now for the one the wait returned for
+    const FramePacer::Clock::time_point now = FramePacer::Clock::now();
+    for (; m_completedFrames < completed; ++m_completedFrames) m_framePacer.completeFrame(now);
+
+    pollPresentedFrames(now);
+}
+
+void VulkanRenderContext::pollPresentedFrames(FramePacer::Clock::time_point _now)
+{
+    InputLatency& latency = getInputLatencyInternal();
+
+    // The upper bound of when it reached the display, without a way to see it there
+    if (!m_device->presentWait || m_headless)
+    {
+        latency.presentFrame(m_completedFrames, _now);
+        return;
+    }
+
+    // A zero timeout: only the presents already done, in order
+    while (const auto frame = latency.getPendingFrame())
+    {
+        const VkResult result =
+            vkWaitForPresentKHR(m_device->device, m_swapchain.swapchain, *frame, 0);
+        if (result == VK_TIMEOUT) return;
+
+        // out of date or lost, none of the frames pending is presented
+        if (result != VK_SUCCESS)
+        {
+            latency.discardFrames();
+            return;
+        }
+
+        latency.presentFrame(*frame, _now);
+    }
+}
+
+void VulkanRenderContext::buildRenderGraph()
+{
+    // left offscreen for a readback, rather than presented
+    m_backbuffer = m_renderGraph.importTexture(
+        "Backbuffer", {}, ResourceAccess::None,
+        m_headless ? ResourceAccess::TransferSource : ResourceAccess::Present);
+
+    m_renderGraph.addPass(
+        "Main pass",
+        [this](RenderGraphBuilder& _builder)
+        {
+            // sized by createRenderGraph(), in half floats: linear, blitted to the sRGB images
+            if (m_dynamicResolution) m_scene = _builder.create("Scene", {});
+
+            _builder.write(m_dynamicResolution ? m_scene : m_backbuffer,
+                           ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+            _builder.setParallelRecording();
+        },
+        [this](const RenderGraphPassContext& _context)
+        {
+            auto commandBuffer = static_cast<CommandBuffer>(_context.commandBuffer);
+            const auto& inheritance =
+                *static_cast<const VkCommandBufferInheritanceInfo*>(_context.inheritance);
+
+            const bool checks = getSettings().checks;
+
+            recordParallelCommands(
+                m_parallelCommands, *m_device, commandBuffer, inheritance, m_currentFrame,
+                m_drawQueue.size(), k_minDrawsPerRange,
+                [this, checks](CommandBuffer _commandBuffer, size_t _first, size_t _count)
+                {
+                    setViewportAndScissor(_commandBuffer);
+
+                    DrawEncoder encoder{_commandBuffer, m_pipelines, {}, m_resourceTable};
+                    encoder.checks = checks;
+                    m_drawQueue.record(encoder, _first, _count);
+                });
+        });
+
+    if (!m_dynamicResolution) return;
+
+    m_renderGraph.addPass(
+        "Upscale",
+        [this](RenderGraphBuilder& _builder)
+        {
+            _builder.read(m_scene, ResourceAccess::TransferSource);
+            _builder.write(m_backbuffer, ResourceAccess::TransferDestination,
+                           AttachmentLoad::DontCare);
+        },
+        [this](const RenderGraphPassContext& _context)
+        {
+            auto commandBuffer = static_cast<CommandBuffer>(_context.commandBuffer);
+
+            // bilinear, the barriers of the graph did the transitions
+            VkImageBlit region{};
+            region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+            region.srcOffsets[1] = {static_cast<int32_t>(m_sceneExtent.width),
+                                    static_cast<int32_t>(m_sceneExtent.height), 1};
+            region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+            region.dstOffsets[1] = {static_cast<int32_t>(m_swapchain.extent.width),
+                                    static_cast<int32_t>(m_swapchain.extent.height), 1};
+
+            vkCmdBlitImage(commandBuffer, m_graphTextures.textures[m_scene.id].image,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           m_graphTextures.textures[m_backbuffer.id].image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, VK_FILTER_LINEAR);
+        });
+}
+
+void VulkanRenderContext::updateResolutionScale()
+{
+    const float previous = m_resolutionScaler.getScale();
+    m_resolutionScaler.setLimit(getSettingsInternal().resolutionLimit);
+
+    // nothing measured in the slot yet, the limit alone may have moved the scale
+    const float scale = m_timestampQueries.frameTime > std::chrono::nanoseconds::zero()
+                            ? m_resolutionScaler.update(m_timestampQueries.frameTime)
+                            : m_resolutionScaler.getScale();
+
+    const glm::uvec2 output{m_swapchain.extent.width, m_swapchain.extent.height};
+    const glm::uvec2 extent = ResolutionScaler::getScaledExtent(output, scale);
+    if (extent.x == m_sceneExtent.width && extent.y == m_sceneExtent.height) return;
+
+    MOSAIC_INFO("Vulkan dynamic resolution: scale {:.2f} to {:.2f}, {}x{} ({:.2f} ms GPU).",
+                previous, scale, extent.x, extent.y,
+                std::chrono::duration<double, std::milli>(m_timestampQueries.frameTime).count());
+
+    // the frames in flight still render to the scene target at the last scale
+    RetiredSwapchain& retired = m_retiredSwapchains.emplace_back();
+    retired.graphTextures = std::exchange(m_graphTextures, RenderGraphTextures());
+    retired.submittedFrames = m_submittedFrames;
+
+    createRenderGraph();
+}
+
+void VulkanRenderContext::setViewportAndScissor(CommandBuffer _commandBuffer) const
+{
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(m_sceneExtent.width);
+    viewport.height = static_cast<float>(m_sceneExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(_commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = m_sceneExtent;
+    vkCmdSetScissor(_commandBuffer, 0, 1, &scissor);
+}
+
+void VulkanRenderContext::createRenderGraph()
+{
+    TextureDescription backbuffer{};
+    backbuffer.width = m_swapchain.extent.width;
+    backbuffer.height = m_swapchain.extent.height;
+    backbuffer.format = TextureFormat::BGRA8;
+    backbuffer.usage = TextureUsage::RenderTarget;
+    backbuffer.debugName = "Backbuffer";
+
+    m_renderGraph.setDescription(m_backbuffer, backbuffer);
+
+    m_sceneExtent = m_swapchain.extent;
+    m_graphExtent = m_swapchain.extent;
+
+    if (m_dynamicResolution)
+    {
+        const glm::uvec2 extent = ResolutionScaler::getScaledExtent(
+            {m_swapchain.extent.width, m_swapchain.extent.height}, m_resolutionScaler.getScale());
+        m_sceneExtent = {extent.x, extent.y};
+
+        TextureDescription scene{};
+        scene.width = extent.x;
+        scene.height = extent.y;
+        scene.format = TextureFormat::RGBA16F;
+        scene.usage = TextureUsage::RenderTarget;
+        scene.debugName = "Scene";
+
+        m_renderGraph.setDescription(m_scene, scene);
+    }
+
+    // the format of the swapchain makes the render pass of the graph
+    bindRenderGraphTexture(m_graphTextures, m_backbuffer, m_swapchain.images[0],
+                           m_swapchain.imageViews[0], m_swapchain.surfaceFormat.format);
+
+    m_graphTextures.debugLabels = getSettings().debugLabels;
+    createRenderGraphTextures(m_graphTextures, m_renderGraph, *m_device, m_allocator);
+}
+
+void VulkanRenderContext::destroyRetiredSwapchains(bool _deviceIdle)
+{
+    // the frame timeline tells when the frames submitted before the retirement all completed
+    std::erase_if(m_retiredSwapchains,
+                  [&](RetiredSwapchain& _retired)
+                  {
+                      if (!_deviceIdle && m_completedFrames < _retired.submittedFrames)
+                      {
+                          return false;
+                      }
+
+                      destroyRenderGraphTextures(_retired.graphTextures, *m_device);
+                      destroySwapchain(_retired.swapchain);
+
+                      return true;
+                  });
 }
 
 void VulkanRenderContext::destroyFrames()
@@ -280,11 +1093,27 @@ void VulkanRenderContext::destroyFrames()
     for (auto& frame : m_frameData)
     {
         vkDestroySemaphore(m_device->device, frame.imageAvailableSemaphore, nullptr);
-        vkDestroySemaphore(m_device->device, frame.renderFinishedSemaphore, nullptr);
-        vkDestroyFence(m_device->device, frame.inFlightFence, nullptr);
 
         destroyCommandBuffer(frame.commandBuffer, *m_device, m_commandPool);
+
+        for (CommandBuffer& commandBuffer : frame.graphicsCommandBuffers)
+        {
+            destroyCommandBuffer(commandBuffer, *m_device, m_commandPool);
+        }
+
+        for (CommandBuffer& commandBuffer : frame.computeCommandBuffers)
+        {
+            destroyCommandBuffer(commandBuffer, *m_device, m_computePool);
+        }
+
+        frame.graphicsCommandBuffers.clear();
+        frame.computeCommandBuffers.clear();
+        frame.submits.clear();
     }
+
+    vkDestroySemaphore(m_device->device, m_frameTimeline, nullptr);
+    vkDestroySemaphore(m_device->device, m_graphicsTimeline, nullptr);
+    vkDestroySemaphore(m_device->device, m_computeTimeline, nullptr);
 }
 
 } // namespace vulkan
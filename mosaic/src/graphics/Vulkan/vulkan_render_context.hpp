@@ -1,6 +1,11 @@
 #pragma once
 
 #include "mosaic/graphics/render_context.hpp"
+#include "mosaic/graphics/render_graph.hpp"
+#include "mosaic/graphics/draw_queue.hpp"
+#include "mosaic/graphics/frame_pacer.hpp"
+#include "mosaic/graphics/resolution_scaler.hpp"
+#include "mosaic/graphics/shader_library.hpp"
 
 #include "context/vulkan_instance.hpp"
 #include "context/vulkan_device.hpp"
@@ -8,9 +13,17 @@
 #include "vulkan_swapchain.hpp"
 #include "commands/vulkan_render_pass.hpp"
 #include "pipelines/vulkan_pipeline.hpp"
-#include "vulkan_framebuffers.hpp"
+#include "pipelines/vulkan_pipeline_library.hpp"
 #include "commands/vulkan_command_pool.hpp"
 #include "commands/vulkan_command_buffer.hpp"
+#include "commands/vulkan_timestamp_queries.hpp"
+#include "commands/vulkan_parallel_commands.hpp"
+#include "commands/vulkan_draw_encoder.hpp"
+#include "vulkan_render_graph.hpp"
+#include "vulkan_frame_ring.hpp"
+#include "vulkan_descriptor_cache.hpp"
+#include "vulkan_upload_manager.hpp"
+#include "vulkan_resource_table.hpp"
 
 namespace mosaic
 {
@@ -19,38 +32,147 @@ namespace graphics
 namespace vulkan
 {
 
+/**
+ * @brief The submission and the presentation of a frame: VulkanRenderSystem submits those of its
+ * contexts in one vkQueueSubmit() and presents them in one vkQueuePresentKHR(). The infos point
+ * into the struct, which must not move once filled.
+ *
+ * With async compute passes on a queue of their own, the graph is split into the submissions of
+ * its batches, ordered by the timeline semaphores of both queues: the graphics ones go ahead of
+ * submitInfo, which then only waits for the last compute one, the others to the compute queue.
+ */
+struct FrameSubmission
+{
+    struct QueueSubmit
+    {
+        VkSemaphore waitSemaphores[3] = {};
+        VkPipelineStageFlags waitStages[3] = {};
+        uint64_t waitValues[3] = {};
+        VkSemaphore signalSemaphore = VK_NULL_HANDLE;
+        uint64_t signalValue = 0;
+        VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+        VkSubmitInfo submitInfo = {};
+    };
+
+    std::vector<QueueSubmit> graphicsSubmits;
+    std::vector<QueueSubmit> computeSubmits;
+
+    VkSemaphore waitSemaphores[2] = {};
+    VkPipelineStageFlags waitStages[2] = {};
+    uint64_t waitValues[2] = {};
+    VkSemaphore signalSemaphores[2] = {};
+    uint64_t signalValues[2] = {};
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    VkSubmitInfo submitInfo = {};
+
+    bool present = true; // false for a headless context, its image stays offscreen
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    uint32_t imageIndex = 0;
+    uint64_t presentId = 0; // VK_KHR_present_id: the frame, to wait for its present; 0 for none
+};
+
+class VulkanRenderSystem;
+
 class VulkanRenderContext : public RenderContext
 {
+    friend class VulkanRenderSystem;
+
    private:
+    // With async compute: a submission of the batches of the graph, on the queue of its batches
+    struct GraphSubmit
+    {
+        RenderGraphQueue queue;
+        CommandBuffer commandBuffer;
+        uint64_t wait;   // the value of the timeline of the other queue it waits for, 0 if none
+        uint64_t signal; // of the timeline of its queue
+        bool recorded;   // a batch, or the start of the frame
+    };
+
+    // A slot of the frames in flight, reused once the frame submitted last with it completed
     struct FrameData
     {
         VkSemaphore imageAvailableSemaphore;
-        VkSemaphore renderFinishedSemaphore;
-        VkFence inFlightFence;
         CommandBuffer commandBuffer;
         uint32_t imageIndex;
 
-        FrameData()
-            : imageAvailableSemaphore(nullptr),
-              renderFinishedSemaphore(nullptr),
-              inFlightFence(nullptr),
-              commandBuffer(nullptr),
-              imageIndex(0){};
+        // those of the batches after the first, allocated as the graph needs them
+        std::vector<CommandBuffer> graphicsCommandBuffers;
+        std::vector<CommandBuffer> computeCommandBuffers;
+        std::vector<GraphSubmit> submits; // of the last recording, the first in commandBuffer
+
+        FrameData() : imageAvailableSemaphore(nullptr), commandBuffer(nullptr), imageIndex(0){};
+    };
+
+    // Replaced by a resize while frames in flight still used it, with the graph textures
+    // created for its images (or those alone, an empty swapchain, on a new resolution scale)
+    struct RetiredSwapchain
+    {
+        Swapchain swapchain;
+        RenderGraphTextures graphTextures;
+        uint64_t submittedFrames; // the frames submitted before, destroyed once they complete
     };
 
     const Instance* m_instance;
     const Device* m_device;
+    VmaAllocator m_allocator;
 
     Surface m_surface;
     Swapchain m_swapchain;
-    RenderPass m_renderPass;
-    Pipeline m_pipeline;
+    std::vector<RetiredSwapchain> m_retiredSwapchains;
+    ShaderLibrary* m_shaderLibrary;
+    uint64_t m_shaderGeneration; // of the shaders of the pipeline descriptions
+    PipelineLibrary* m_pipelineLibrary;
+    UploadManager* m_uploadManager;
+    UploadTicket m_uploadWait; // the uploads the submission of the frame waits for, 0 if none
+    ResourceTable* m_resourceTable;
+    PipelineDescription m_trianglePipeline;
+    const Pipeline* m_lastTrianglePipeline; // drawn while the reloaded shaders compile
+    VkFormat m_lastTriangleFormat;
+    std::vector<const Pipeline*> m_pipelines; // of the frame, by ResourceHandle
     CommandPool m_commandPool;
+    CommandPool m_computePool; // of the async compute family, none without one
+    ParallelCommands m_parallelCommands;
+    TimestampQueries m_timestampQueries;
+
+    RenderGraph m_renderGraph;
+    RenderGraphTextures m_graphTextures;
+    RenderGraphResource m_backbuffer;
+    RenderGraphResource m_scene; // the target of the main pass with dynamic resolution
+
+    // Dynamic resolution: the scale of the scene from the GPU time of the frames, upscaled
+    bool m_dynamicResolution;
+    ResolutionScaler m_resolutionScaler;
+    VkExtent2D m_sceneExtent; // of the target of the main pass
+
+    DrawQueue m_drawQueue; // the draws of the frame, recorded in parallel by the main pass
+    FrameRingBuffer m_frameRing; // uniforms and dynamic geometry of the frames in flight
+    DescriptorAllocator m_descriptors; // the classic sets written by the frames in flight
 
     uint32_t m_currentFrame;
+    uint32_t m_framesInFlight;
+    uint64_t m_submittedFrames;
+    uint64_t m_completedFrames;
+    VkSemaphore m_frameTimeline; // signaled to the count of frames submitted as each completes
+    VkSemaphore m_graphicsTimeline; // by the submissions of the batches, with async compute
+    VkSemaphore m_computeTimeline;
+    uint64_t m_graphicsSignals; // so far, the value of the last such submission
+    uint64_t m_computeSignals;
     std::vector<FrameData> m_frameData;
+    FramePacer m_framePacer;
 
     bool m_framebufferResized;
+    bool m_headless; // without a window: an offscreen chain of an image per frame in flight
+
+    // The window gone (Android's APP_CMD_TERM_WINDOW): no surface nor swapchain until one comes
+    // back, the device, pipelines and graph textures kept for it
+    bool m_surfaceLost;
+    VkExtent2D m_graphExtent; // of the swapchain the graph textures were created for
+
+    // Exported (exportFrames()): the frames signal the ready semaphore of their image, and wait for
+    // its released one once the consumer was handed a frame of it
+    bool m_exportingFrames;
+    std::vector<bool> m_exportedImagesHeld;
+    std::optional<uint32_t> m_lastExportedImage;
 
    public:
     VulkanRenderContext(const window::Window* _window, const RenderContextSettings& _settings);
@@ -60,16 +182,63 @@ class VulkanRenderContext : public RenderContext
     pieces::RefResult<RenderContext, std::string> initialize(RenderSystem* _renderSystem) override;
     void shutdown() override;
 
+    pieces::Result<ExportedFrames, std::string> exportFrames() override;
+    [[nodiscard]] std::optional<uint32_t> getLastExportedImage() const override;
+
    private:
     void resizeFramebuffer() override;
     void recreateSurface() override;
-    void beginFrame() override;
+    void waitForFrame() override;
+    void applyPresentPolicy() override;
+    bool beginFrame() override;
     void updateResources() override;
     void drawScene() override;
     void endFrame() override;
 
+    // The steps of drawScene() and endFrame() the render system batches with the other contexts:
+    // a submission recorded by recordFrame(), filled by prepareSubmission(), then reported
+    // submitted and presented (its result, which may ask for a new swapchain)
+    void recordFrame(bool _acquireUploads);
+    void prepareSubmission(FrameSubmission& _submission, UploadTicket _uploadWait);
+    void onSubmitted();
+    void onPresented(VkResult _result);
+
+    // The shaders of the pipeline descriptions, as the shader library has them now
+    void loadShaders();
+
     void createFrames();
     void destroyFrames();
+
+    // The surface and the swapchain of a window that went away, once the frames in flight that
+    // present to it completed; the graph textures stay, but for their framebuffers
+    void releaseSurface();
+
+    // Blocks until the frames up to _frame (a count of frames submitted) completed, and tells the
+    // pacer about those seen completed
+    void waitForFrames(uint64_t _frame);
+
+    // Tells the input latency about the frames seen presented by _now, without blocking: those
+    // the presents of which completed with present wait, those completed by the GPU otherwise
+    void pollPresentedFrames(FramePacer::Clock::time_point _now);
+
+    // Those whose frames completed, every one once the device is idle
+    void destroyRetiredSwapchains(bool _deviceIdle);
+
+    // The passes once, their textures for every swapchain
+    void buildRenderGraph();
+    void createRenderGraph();
+
+    // The scale of the scene from the GPU time of the frame completed last, the graph textures
+    // created again when it changed
+    void updateResolutionScale();
+
+    // The batches of the graph in the submissions of the frame, from its command buffer begun
+    // with the start of the frame. Returns the command buffer of the last, left open
+    CommandBuffer recordRenderGraphBatches(FrameData& _frame);
+    void prepareBatchSubmissions(FrameSubmission& _submission, UploadTicket _uploadWait);
+
+    // The state a secondary command buffer of the main pass starts from
+    void setViewportAndScissor(CommandBuffer _commandBuffer) const;
 };
 
 } // namespace vulkan
@@ -0,0 +1,908 @@
+#include "vulkan_render_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+struct AccessInfo
+{
+    VkPipelineStageFlags stages;
+    VkAccessFlags access;
+    VkImageLayout layout;
+};
+
+static AccessInfo getAccessInfo(ResourceAccess _access)
+{
+    constexpr VkPipelineStageFlags depthStages =
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    constexpr VkPipelineStageFlags shaderStages =
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    switch (_access)
+    {
+        case ResourceAccess::ColorAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        case ResourceAccess::DepthAttachment:
+            return {depthStages,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        case ResourceAccess::DepthRead:
+            return {depthStages | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        case ResourceAccess::InputAttachment:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        case ResourceAccess::ResolveAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        case ResourceAccess::Sampled:
+            return {shaderStages, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        case ResourceAccess::StorageRead:
+            return {shaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+        case ResourceAccess::StorageWrite:
+            return {shaderStages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_GENERAL};
+        case ResourceAccess::TransferSource:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+        case ResourceAccess::TransferDestination:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+        case ResourceAccess::Present:
+            return {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+        case ResourceAccess::None:
+        default:
+            return {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED};
+    }
+}
+
+static bool isAttachment(ResourceAccess _access)
+{
+    return RenderGraph::isAttachmentAccess(_access);
+}
+
+static VkSampleCountFlagBits toSampleCount(uint32_t _samples)
+{
+    switch (_samples)
+    {
+        case 2:
+            return VK_SAMPLE_COUNT_2_BIT;
+        case 4:
+            return VK_SAMPLE_COUNT_4_BIT;
+        case 8:
+            return VK_SAMPLE_COUNT_8_BIT;
+        case 16:
+            return VK_SAMPLE_COUNT_16_BIT;
+        default:
+            return VK_SAMPLE_COUNT_1_BIT;
+    }
+}
+
+static VkFormat toVkFormat(TextureFormat _format)
+{
+    switch (_format)
+    {
+        case TextureFormat::BGRA8:
+            return VK_FORMAT_B8G8R8A8_UNORM;
+        case TextureFormat::RGBA16F:
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case TextureFormat::R32UI:
+            return VK_FORMAT_R32_UINT;
+        case TextureFormat::Depth24Stencil8:
+            return VK_FORMAT_D24_UNORM_S8_UINT;
+        case TextureFormat::Depth32F:
+            return VK_FORMAT_D32_SFLOAT;
+        case TextureFormat::RGBA8:
+        default:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+static VkImageAspectFlags getAspect(TextureFormat _format)
+{
+    switch (_format)
+    {
+        case TextureFormat::Depth24Stencil8:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        case TextureFormat::Depth32F:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+static VkImageUsageFlags getUsage(uint32_t _accessMask)
+{
+    const auto uses = [_accessMask](ResourceAccess _access)
+    { return (_accessMask & (1u << static_cast<uint32_t>(_access))) != 0; };
+
+    VkImageUsageFlags usage = 0;
+    if (uses(ResourceAccess::ColorAttachment) || uses(ResourceAccess::ResolveAttachment))
+    {
+        usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    }
+    if (uses(ResourceAccess::DepthAttachment) || uses(ResourceAccess::DepthRead))
+    {
+        usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    }
+    if (uses(ResourceAccess::InputAttachment)) usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    if (uses(ResourceAccess::Sampled)) usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (uses(ResourceAccess::StorageRead) || uses(ResourceAccess::StorageWrite))
+    {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+    if (uses(ResourceAccess::TransferSource)) usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    if (uses(ResourceAccess::TransferDestination)) usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+    return usage;
+}
+
+static VkAttachmentLoadOp toLoadOp(AttachmentLoad _load)
+{
+    switch (_load)
+    {
+        case AttachmentLoad::Clear:
+            return VK_ATTACHMENT_LOAD_OP_CLEAR;
+        case AttachmentLoad::DontCare:
+            return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        case AttachmentLoad::Load:
+        default:
+            return VK_ATTACHMENT_LOAD_OP_LOAD;
+    }
+}
+
+// The attachments of a subpass of a render pass, by their index in it
+struct SubpassAttachments
+{
+    std::vector<VkAttachmentReference> colors;
+    std::vector<VkAttachmentReference> resolves; // as many as the colors, if any
+    std::vector<VkAttachmentReference> inputs;
+    std::vector<uint32_t> preserved;
+    VkAttachmentReference depth{VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED};
+};
+
+static void createPassTargets(RenderGraphTextures& _textures, const RenderGraph& _graph,
+                              const Device& _device)
+{
+    _textures.passes.resize(_graph.getPasses().size());
+
+    const auto order = _graph.getExecutionOrder();
+
+    for (size_t first = 0; first < order.size(); ++first)
+    {
+        const auto& leader = _graph.getPasses()[order[first]];
+        if (leader.renderPass != order[first]) continue;
+
+        auto& targets = _textures.passes[order[first]];
+
+        // the subpasses follow the first pass in the execution order
+        size_t end = first + 1;
+        while (end < order.size() && _graph.getPasses()[order[end]].renderPass == order[first])
+        {
+            ++end;
+        }
+
+        std::vector<VkAttachmentDescription> attachments;
+        std::vector<SubpassAttachments> subpasses(end - first);
+        std::vector<std::vector<bool>> used(end - first); // by subpass and attachment
+
+        for (size_t subpass = 0; subpass < subpasses.size(); ++subpass)
+        {
+            const auto& pass = _graph.getPasses()[order[first + subpass]];
+            auto& references = subpasses[subpass];
+
+            for (const auto& access : pass.accesses)
+            {
+                if (!isAttachment(access.access)) continue;
+
+                const auto& texture = _textures.textures[access.resource.id];
+                const auto& description = _graph.getResource(access.resource).description;
+                const VkImageLayout layout = getAccessInfo(access.access).layout;
+
+                if (texture.format == VK_FORMAT_UNDEFINED)
+                {
+                    throw std::runtime_error("Render graph: " +
+                                             _graph.getResource(access.resource).name +
+                                             " was not bound!");
+                }
+
+                auto it = std::ranges::find(targets.attachments, access.resource);
+                const auto index = static_cast<uint32_t>(it - targets.attachments.begin());
+
+                // the barriers did the transitions before the render pass, the first subpass
+                // using an attachment loads it, the last one leaves it in its layout and stores
+                // it if a later pass reads it
+                if (it == targets.attachments.end())
+                {
+                    VkAttachmentDescription attachment{};
+                    attachment.format = texture.format;
+                    attachment.samples = toSampleCount(description.samples);
+                    attachment.loadOp = toLoadOp(access.load);
+                    attachment.stencilLoadOp = attachment.loadOp;
+                    attachment.initialLayout = layout;
+
+                    targets.attachments.push_back(access.resource);
+                    attachments.push_back(attachment);
+                }
+
+                attachments[index].storeOp = access.storeContents
+                                                 ? VK_ATTACHMENT_STORE_OP_STORE
+                                                 : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+                attachments[index].stencilStoreOp = attachments[index].storeOp;
+                attachments[index].finalLayout = layout;
+
+                used[subpass].resize(targets.attachments.size());
+                used[subpass][index] = true;
+
+                const VkAttachmentReference reference{index, layout};
+
+                switch (access.access)
+                {
+                    case ResourceAccess::ColorAttachment:
+                        references.colors.push_back(reference);
+                        break;
+                    case ResourceAccess::ResolveAttachment:
+                        references.resolves.push_back(reference);
+                        break;
+                    case ResourceAccess::InputAttachment:
+                        references.inputs.push_back(reference);
+                        break;
+                    default:
+                        references.depth = reference;
+                        break;
+                }
+            }
+        }
+
+        const auto& area = _graph.getResource(targets.attachments.front()).description;
+        targets.extent = {area.width, area.height};
+
+        // begun by vkCmdBeginRendering(), which has no subpasses to keep the tiles on chip
+        if (_device.dynamicRendering)
+        {
+            if (subpasses.size() > 1)
+            {
+                throw std::runtime_error("Render graph: " + leader.name +
+                                         " merges subpasses, dynamic rendering has none!");
+            }
+
+            const auto& references = subpasses.front();
+
+            targets.dynamic = true;
+            targets.descriptions = std::move(attachments);
+            for (const auto& color : references.colors) targets.colors.push_back(color.attachment);
+            for (const auto& resolve : references.resolves)
+            {
+                targets.resolves.push_back(resolve.attachment);
+            }
+            targets.resolves.resize(targets.colors.size(), VK_ATTACHMENT_UNUSED);
+            targets.depth = references.depth.attachment;
+            continue;
+        }
+
+        std::vector<VkSubpassDescription> descriptions(subpasses.size());
+        std::vector<VkSubpassDependency> dependencies;
+
+        for (size_t subpass = 0; subpass < subpasses.size(); ++subpass)
+        {
+            auto& references = subpasses[subpass];
+            used[subpass].resize(targets.attachments.size());
+
+            // the k-th resolve is that of the k-th color attachment
+            if (!references.resolves.empty())
+            {
+                references.resolves.resize(references.colors.size(),
+                                           {VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED});
+            }
+
+            // kept for a later subpass through those that do not use them
+            for (uint32_t attachment = 0; attachment < targets.attachments.size(); ++attachment)
+            {
+                if (used[subpass][attachment]) continue;
+
+                const auto usedIn = [&](size_t _first, size_t _last)
+                {
+                    for (size_t other = _first; other < _last; ++other)
+                    {
+                        if (attachment < used[other].size() && used[other][attachment])
+                        {
+                            return true;
+                        }
+                    }
+                    return false;
+                };
+
+                if (usedIn(0, subpass) && usedIn(subpass + 1, subpasses.size()))
+                {
+                    references.preserved.push_back(attachment);
+                }
+            }
+
+            VkSubpassDescription& description = descriptions[subpass];
+            description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            description.colorAttachmentCount = static_cast<uint32_t>(references.colors.size());
+            description.pColorAttachments = references.colors.data();
+            description.pResolveAttachments =
+                references.resolves.empty() ? nullptr : references.resolves.data();
+            description.inputAttachmentCount = static_cast<uint32_t>(references.inputs.size());
+            description.pInputAttachments = references.inputs.data();
+            description.preserveAttachmentCount =
+                static_cast<uint32_t>(references.preserved.size());
+            description.pPreserveAttachments = references.preserved.data();
+            if (references.depth.attachment != VK_ATTACHMENT_UNUSED)
+            {
+                description.pDepthStencilAttachment = &references.depth;
+            }
+
+            if (subpass == 0) continue;
+
+            // the writes of the subpass before, at the same pixel: the tiles stay on chip
+            VkSubpassDependency dependency{};
+            dependency.srcSubpass = static_cast<uint32_t>(subpass - 1);
+            dependency.dstSubpass = static_cast<uint32_t>(subpass);
+            dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                      VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                       VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            dependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                      VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                      VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                                      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dependency.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT |
+                                       VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                       VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                       VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                       VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+            dependencies.push_back(dependency);
+        }
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = static_cast<uint32_t>(descriptions.size());
+        renderPassInfo.pSubpasses = descriptions.data();
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
+
+        if (vkCreateRenderPass(_device.device, &renderPassInfo, nullptr, &targets.renderPass) !=
+            VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create render graph pass!");
+        }
+    }
+}
+
+static VkFramebuffer getFramebuffer(RenderGraphTextures::PassTargets& _targets,
+                                    const RenderGraphTextures& _textures, const Device& _device)
+{
+    std::vector<VkImageView> views;
+    for (const RenderGraphResource attachment : _targets.attachments)
+    {
+        views.push_back(_textures.textures[attachment.id].view);
+    }
+
+    auto it = std::ranges::find(_targets.framebuffers, views,
+                                &std::pair<std::vector<VkImageView>, VkFramebuffer>::first);
+    if (it != _targets.framebuffers.end()) return it->second;
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = _targets.renderPass;
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+    framebufferInfo.pAttachments = views.data();
+    framebufferInfo.width = _targets.extent.width;
+    framebufferInfo.height = _targets.extent.height;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    if (vkCreateFramebuffer(_device.device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create render graph framebuffer!");
+    }
+
+    _targets.framebuffers.emplace_back(std::move(views), framebuffer);
+
+    return framebuffer;
+}
+
+static VkRenderingAttachmentInfo getRenderingAttachment(
+    const RenderGraphTextures::PassTargets& _targets, const RenderGraphTextures& _textures,
+    uint32_t _attachment, VkClearValue _clearValue)
+{
+    const VkAttachmentDescription& description = _targets.descriptions[_attachment];
+
+    VkRenderingAttachmentInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    info.imageView = _textures.textures[_targets.attachments[_attachment].id].view;
+    info.imageLayout = description.initialLayout;
+    info.loadOp = description.loadOp;
+    info.storeOp = description.storeOp;
+    info.clearValue = _clearValue;
+
+    return info;
+}
+
+// The attachments of a render pass without VkRenderPass, as recordPasses() begins them
+struct RenderingAttachments
+{
+    std::vector<VkRenderingAttachmentInfo> colors;
+    std::vector<VkFormat> colorFormats;
+    VkRenderingAttachmentInfo depth{};
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    VkFormat stencilFormat = VK_FORMAT_UNDEFINED;
+};
+
+static void beginRendering(const RenderGraphTextures::PassTargets& _targets,
+                           const RenderGraphTextures& _textures, CommandBuffer& _commandBuffer,
+                           bool _secondary, RenderingAttachments& _attachments)
+{
+    VkClearValue clearColor{};
+    clearColor.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+    VkClearValue clearDepth{};
+    clearDepth.depthStencil = {1.0f, 0};
+
+    for (size_t i = 0; i < _targets.colors.size(); ++i)
+    {
+        const uint32_t color = _targets.colors[i];
+        auto& info = _attachments.colors.emplace_back(
+            getRenderingAttachment(_targets, _textures, color, clearColor));
+        _attachments.colorFormats.push_back(_targets.descriptions[color].format);
+
+        if (const uint32_t resolve = _targets.resolves[i]; resolve != VK_ATTACHMENT_UNUSED)
+        {
+            info.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+            info.resolveImageView = _textures.textures[_targets.attachments[resolve].id].view;
+            info.resolveImageLayout = _targets.descriptions[resolve].initialLayout;
+        }
+    }
+
+    VkRenderingInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = _secondary ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = _targets.extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(_attachments.colors.size());
+    renderingInfo.pColorAttachments = _attachments.colors.data();
+
+    if (_targets.depth != VK_ATTACHMENT_UNUSED)
+    {
+        _attachments.depth =
+            getRenderingAttachment(_targets, _textures, _targets.depth, clearDepth);
+        _attachments.depthFormat = _targets.descriptions[_targets.depth].format;
+        renderingInfo.pDepthAttachment = &_attachments.depth;
+
+        const auto& texture = _textures.textures[_targets.attachments[_targets.depth].id];
+        if (texture.aspect & VK_IMAGE_ASPECT_STENCIL_BIT)
+        {
+            _attachments.stencilFormat = _attachments.depthFormat;
+            renderingInfo.pStencilAttachment = &_attachments.depth;
+        }
+    }
+
+    vkCmdBeginRendering(_commandBuffer, &renderingInfo);
+}
+
+// Where the barriers are recorded: whether the cross-queue ones follow a semaphore wait, the
+// stages of the queue family
+struct BarrierQueue
+{
+    bool separate;
+    VkPipelineStageFlags stages;
+};
+
+static constexpr BarrierQueue k_singleQueue = {false, ~VkPipelineStageFlags{0}};
+
+static constexpr VkPipelineStageFlags k_computeStages =
+    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+    VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+static void recordBarriers(std::span<const RenderGraphBarrier> _barriers,
+                           const RenderGraphTextures& _textures, CommandBuffer& _commandBuffer,
+                           BarrierQueue _queue = k_singleQueue)
+{
+    if (_barriers.empty()) return;
+
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    imageBarriers.reserve(_barriers.size());
+
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+
+    for (const RenderGraphBarrier& barrier : _barriers)
+    {
+        const auto& texture = _textures.textures[barrier.resource.id];
+        const AccessInfo before = getAccessInfo(barrier.before);
+        const AccessInfo after = getAccessInfo(barrier.after);
+
+        VkImageMemoryBarrier imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.oldLayout = barrier.discard ? VK_IMAGE_LAYOUT_UNDEFINED : before.layout;
+        imageBarrier.newLayout = after.layout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = texture.image;
+        imageBarrier.subresourceRange = {texture.aspect, 0, VK_REMAINING_MIP_LEVELS, 0,
+                                         VK_REMAINING_ARRAY_LAYERS};
+        imageBarrier.dstAccessMask = after.access;
+
+        if (barrier.aliasing)
+        {
+            // any earlier pass may still use the memory
+            srcStages |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            imageBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        }
+        else if (barrier.before == ResourceAccess::None || (barrier.crossQueue && _queue.separate))
+        {
+            // chains with the semaphore wait of the swapchain image (or of the batch of the other
+            // queue, whose accesses it made visible), at the same stages
+            srcStages |= after.stages;
+        }
+        else
+        {
+            // reads only need the execution dependency
+            srcStages |= before.stages;
+            imageBarrier.srcAccessMask =
+                RenderGraph::isWriteAccess(barrier.before) ? before.access : 0;
+        }
+
+        dstStages |= after.stages;
+        imageBarriers.push_back(imageBarrier);
+    }
+
+    // the shader stages of the accesses are those of both queues
+    srcStages = (srcStages & _queue.stages) ? srcStages & _queue.stages
+                                             : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    dstStages = (dstStages & _queue.stages) ? dstStages & _queue.stages
+                                             : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+    vkCmdPipelineBarrier(_commandBuffer, srcStages, dstStages, 0, 0, nullptr, 0, nullptr,
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+static void recordPasses(const RenderGraph& _graph, std::span<const uint32_t> _passes,
+                         RenderGraphTextures& _textures, const Device& _device,
+                         CommandBuffer& _commandBuffer, TimestampQueries* _queries,
+                         uint32_t _frame, BarrierQueue _queue)
+{
+    for (size_t position = 0; position < _passes.size(); ++position)
+    {
+        const uint32_t index = _passes[position];
+        const auto& pass = _graph.getPasses()[index];
+
+        const bool subpass = pass.renderPass != RenderGraph::k_unused && pass.renderPass != index;
+        auto& targets = _textures.passes[subpass ? pass.renderPass : index];
+
+        // none for a subpass, the graph moved them before its render pass
+        recordBarriers(pass.barriers, _textures, _commandBuffer, _queue);
+
+        if (_textures.debugLabels) beginDebugLabel(_device, _commandBuffer, pass.name.c_str());
+
+        const uint32_t span =
+            _queries ? beginTimestampSpan(*_queries, _commandBuffer, _frame, pass.name.c_str())
+                     : 0;
+
+        VkCommandBufferInheritanceInfo inheritance{};
+        inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+        // with dynamic rendering: the formats the secondary command buffers render to
+        RenderingAttachments rendering;
+        VkCommandBufferInheritanceRenderingInfo renderingInheritance{};
+        renderingInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+
+        const VkSubpassContents contents = pass.parallelRecording
+                                               ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                               : VK_SUBPASS_CONTENTS_INLINE;
+
+        const VkFramebuffer framebuffer =
+            targets.renderPass ? getFramebuffer(targets, _textures, _device) : VK_NULL_HANDLE;
+
+        if (subpass)
+        {
+            vkCmdNextSubpass(_commandBuffer, contents);
+        }
+        else if (targets.renderPass)
+        {
+            std::vector<VkClearValue> clearValues;
+            for (const RenderGraphResource attachment : targets.attachments)
+            {
+                VkClearValue clearValue{};
+                if (_textures.textures[attachment.id].aspect == VK_IMAGE_ASPECT_COLOR_BIT)
+                {
+                    clearValue.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+                }
+                else
+                {
+                    clearValue.depthStencil = {1.0f, 0};
+                }
+
+                clearValues.push_back(clearValue);
+            }
+
+            VkRenderPassBeginInfo renderPassInfo{};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInfo.renderPass = targets.renderPass;
+            renderPassInfo.framebuffer = framebuffer;
+            renderPassInfo.renderArea.offset = {0, 0};
+            renderPassInfo.renderArea.extent = targets.extent;
+            renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+            renderPassInfo.pClearValues = clearValues.data();
+
+            vkCmdBeginRenderPass(_commandBuffer, &renderPassInfo, contents);
+        }
+        else if (targets.dynamic)
+        {
+            beginRendering(targets, _textures, _commandBuffer, pass.parallelRecording, rendering);
+        }
+
+        if (targets.renderPass)
+        {
+            inheritance.renderPass = targets.renderPass;
+            inheritance.subpass = pass.subpass;
+            inheritance.framebuffer = framebuffer;
+        }
+        else if (targets.dynamic)
+        {
+            renderingInheritance.colorAttachmentCount =
+                static_cast<uint32_t>(rendering.colorFormats.size());
+            renderingInheritance.pColorAttachmentFormats = rendering.colorFormats.data();
+            renderingInheritance.depthAttachmentFormat = rendering.depthFormat;
+            renderingInheritance.stencilAttachmentFormat = rendering.stencilFormat;
+            renderingInheritance.rasterizationSamples = targets.descriptions.front().samples;
+            inheritance.pNext = &renderingInheritance;
+        }
+
+        if (pass.execute)
+        {
+            pass.execute({&_graph, _commandBuffer, index,
+                          pass.parallelRecording ? &inheritance : nullptr});
+        }
+
+        // after its last subpass, the render passes never span two batches
+        const bool lastSubpass =
+            position + 1 == _passes.size() ||
+            _graph.getPasses()[_passes[position + 1]].renderPass != pass.renderPass;
+
+        if (targets.renderPass && lastSubpass) vkCmdEndRenderPass(_commandBuffer);
+        if (targets.dynamic) vkCmdEndRendering(_commandBuffer);
+
+        if (_queries) endTimestampSpan(*_queries, _commandBuffer, _frame, span);
+
+        if (_textures.debugLabels) endDebugLabel(_device, _commandBuffer);
+    }
+}
+
+void bindRenderGraphTexture(RenderGraphTextures& _textures, RenderGraphResource _resource,
+                            VkImage _image, VkImageView _view, VkFormat _format,
+                            VkImageAspectFlags _aspect)
+{
+    if (_textures.textures.size() <= _resource.id) _textures.textures.resize(_resource.id + 1);
+
+    auto& texture = _textures.textures[_resource.id];
+    texture.image = _image;
+    texture.view = _view;
+    texture.format = _format;
+    texture.aspect = _aspect;
+    texture.transient = false;
+}
+
+void createRenderGraphTextures(RenderGraphTextures& _textures, RenderGraph& _graph,
+                               const Device& _device, VmaAllocator _allocator)
+{
+    _textures.allocator = _allocator;
+    _textures.textures.resize(_graph.getResources().size());
+
+    uint32_t memoryTypeBits = ~0u;
+
+    // The images are made as the graph places them, knowing their accesses
+    _graph.compile(
+        [&](RenderGraphResource _resource, const TextureDescription& _description)
+        {
+            auto& texture = _textures.textures[_resource.id];
+
+            texture.format = toVkFormat(_description.format);
+            texture.aspect = getAspect(_description.format);
+            texture.transient = true;
+
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = texture.format;
+            imageInfo.extent = {_description.width, _description.height, 1};
+            imageInfo.mipLevels = std::max(_description.mipLevels, 1u);
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = toSampleCount(_description.samples);
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = getUsage(_graph.getResource(_resource).accessMask);
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            // used by both queues, with no ownership transfer between them
+            const uint32_t families[] = {_device.graphicsFamily, _device.computeFamily};
+            if (_graph.getResource(_resource).asyncCompute &&
+                _device.computeFamily != _device.graphicsFamily)
+            {
+                imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+                imageInfo.queueFamilyIndexCount = 2;
+                imageInfo.pQueueFamilyIndices = families;
+            }
+
+            // never backed on a tiled GPU (depth, MSAA, a G-buffer read as input attachments),
+            // out of the heap; in it where there is no lazily allocated memory
+            if (_graph.getResource(_resource).memoryless)
+            {
+                imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+                if (createLazilyAllocatedImage(_allocator, imageInfo, texture.image,
+                                               texture.allocation))
+                {
+                    return RenderGraph::MemoryRequirements{0, 1};
+                }
+            }
+
+            if (vkCreateImage(_device.device, &imageInfo, nullptr, &texture.image) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create render graph image!");
+            }
+
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(_device.device, texture.image, &requirements);
+            memoryTypeBits &= requirements.memoryTypeBits;
+
+            return RenderGraph::MemoryRequirements{static_cast<size_t>(requirements.size),
+                                                   static_cast<size_t>(requirements.alignment)};
+        });
+
+    if (_graph.getHeapSize() > 0)
+    {
+        if (memoryTypeBits == 0)
+        {
+            throw std::runtime_error("Render graph: the transients share no memory type!");
+        }
+
+        VkMemoryRequirements heapRequirements{};
+        heapRequirements.size = _graph.getHeapSize();
+        heapRequirements.alignment = _graph.getHeapAlignment();
+        heapRequirements.memoryTypeBits = memoryTypeBits;
+
+        allocateDeviceMemory(_allocator, heapRequirements, _textures.heap);
+    }
+
+    for (uint32_t i = 0; i < _textures.textures.size(); ++i)
+    {
+        auto& texture = _textures.textures[i];
+        if (!texture.transient) continue;
+
+        const auto& resource = _graph.getResource({i});
+
+        if (!texture.allocation)
+        {
+            bindImageMemory(_allocator, _textures.heap, resource.heapOffset, texture.image);
+        }
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = texture.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = texture.format;
+        viewInfo.subresourceRange = {texture.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, 1};
+
+        if (vkCreateImageView(_device.device, &viewInfo, nullptr, &texture.view) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create render graph image view!");
+        }
+
+        if (_textures.debugLabels)
+        {
+            setObjectName(_device, VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(texture.image),
+                          resource.name.c_str());
+        }
+    }
+
+    createPassTargets(_textures, _graph, _device);
+}
+
+void releaseRenderGraphFramebuffers(RenderGraphTextures& _textures, const Device& _device)
+{
+    for (auto& targets : _textures.passes)
+    {
+        for (auto& [views, framebuffer] : targets.framebuffers)
+        {
+            vkDestroyFramebuffer(_device.device, framebuffer, nullptr);
+        }
+
+        targets.framebuffers.clear();
+    }
+}
+
+void destroyRenderGraphTextures(RenderGraphTextures& _textures, const Device& _device)
+{
+    releaseRenderGraphFramebuffers(_textures, _device);
+
+    for (auto& targets : _textures.passes)
+    {
+        vkDestroyRenderPass(_device.device, targets.renderPass, nullptr);
+    }
+
+    for (auto& texture : _textures.textures)
+    {
+        if (!texture.transient) continue;
+
+        vkDestroyImageView(_device.device, texture.view, nullptr);
+
+        if (texture.allocation)
+        {
+            destroyDeviceImage(_textures.allocator, texture.image, texture.allocation);
+        }
+        else
+        {
+            vkDestroyImage(_device.device, texture.image, nullptr);
+        }
+    }
+
+    if (_textures.heap) freeDeviceMemory(_textures.allocator, _textures.heap);
+
+    // the imported textures stay bound
+    for (auto& texture : _textures.textures)
+    {
+        if (texture.transient) texture = {};
+    }
+
+    _textures.passes.clear();
+}
+
+void executeRenderGraph(const RenderGraph& _graph, RenderGraphTextures& _textures,
+                        const Device& _device, CommandBuffer& _commandBuffer,
+                        TimestampQueries& _queries, uint32_t _frame)
+{
+    // the batches of both queues, in order
+    recordPasses(_graph, _graph.getExecutionOrder(), _textures, _device, _commandBuffer,
+                 &_queries, _frame, k_singleQueue);
+
+    recordBarriers(_graph.getFinalBarriers(), _textures, _commandBuffer);
+}
+
+void executeRenderGraphBatch(const RenderGraph& _graph, uint32_t _batch,
+                             RenderGraphTextures& _textures, const Device& _device,
+                             CommandBuffer& _commandBuffer, TimestampQueries& _queries,
+                             uint32_t _frame)
+{
+    const RenderGraphBatch& batch = _graph.getBatches()[_batch];
+
+    if (batch.queue == RenderGraphQueue::AsyncCompute)
+    {
+        recordPasses(_graph, batch.passes, _textures, _device, _commandBuffer, nullptr, _frame,
+                     {true, k_computeStages});
+    }
+    else
+    {
+        recordPasses(_graph, batch.passes, _textures, _device, _commandBuffer, &_queries, _frame,
+                     {true, ~VkPipelineStageFlags{0}});
+    }
+}
+
+void recordRenderGraphFinalBarriers(const RenderGraph& _graph, RenderGraphTextures& _textures,
+                                    CommandBuffer& _commandBuffer)
+{
+    recordBarriers(_graph.getFinalBarriers(), _textures, _commandBuffer);
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/render_graph.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+#include "commands/vulkan_timestamp_queries.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The Vulkan objects of a compiled RenderGraph: the images of its transients, bound in
+ * one VMA allocation where those with disjoint lifetimes alias, and a render pass for each pass
+ * with attachments, the passes merged into it as its subpasses.
+ *
+ * The render passes start and end in the layout the barriers of the graph leave the attachments
+ * in, a pipeline created for a render pass of the same attachment formats is compatible. The
+ * memoryless transients are in lazily allocated memory of their own when the device has some.
+ * Those of the async compute passes are shared concurrently by the graphics and compute families.
+ */
+struct RenderGraphTextures
+{
+    struct Texture
+    {
+        VkImage image;
+        VkImageView view;
+        VkFormat format;
+        VkImageAspectFlags aspect;
+        VmaAllocation allocation; // lazily allocated, else the image is in the heap
+        bool transient;           // created and destroyed with the textures
+
+        Texture()
+            : image(VK_NULL_HANDLE),
+              view(VK_NULL_HANDLE),
+              format(VK_FORMAT_UNDEFINED),
+              aspect(VK_IMAGE_ASPECT_COLOR_BIT),
+              allocation(VK_NULL_HANDLE),
+              transient(false){};
+    };
+
+    // Of the first pass of a render pass
+    struct PassTargets
+    {
+        VkRenderPass renderPass;
+        VkExtent2D extent;
+        std::vector<RenderGraphResource> attachments; // of every subpass, once each
+
+        // By the views of the attachments, one per swapchain image at most
+        std::vector<std::pair<std::vector<VkImageView>, VkFramebuffer>> framebuffers;
+
+        // With dynamic rendering, neither render pass nor framebuffers: the ops and layout of
+        // each attachment, the color, resolve and depth ones by their index in attachments
+        bool dynamic;
+        std::vector<VkAttachmentDescription> descriptions;
+        std::vector<uint32_t> colors;
+        std::vector<uint32_t> resolves; // of the k-th color, VK_ATTACHMENT_UNUSED if none
+        uint32_t depth;
+
+        PassTargets()
+            : renderPass(VK_NULL_HANDLE), extent({}), dynamic(false), depth(VK_ATTACHMENT_UNUSED){};
+    };
+
+    VmaAllocator allocator;
+    VmaAllocation heap;
+    std::vector<Texture> textures; // by RenderGraphResource
+    std::vector<PassTargets> passes;
+    bool debugLabels; // the passes labelled and the transients named, set before they are made
+
+    RenderGraphTextures() : allocator(VK_NULL_HANDLE), heap(VK_NULL_HANDLE), debugLabels(false){};
+};
+
+// The imported textures are bound before createRenderGraphTextures() (their format makes the
+// render passes), and again whenever they change (the swapchain image of the frame).
+void bindRenderGraphTexture(RenderGraphTextures& _textures, RenderGraphResource _resource,
+                            VkImage _image, VkImageView _view, VkFormat _format,
+                            VkImageAspectFlags _aspect = VK_IMAGE_ASPECT_COLOR_BIT);
+
+// Compiles the graph with the memory requirements of the device, then allocates its transients.
+void createRenderGraphTextures(RenderGraphTextures& _textures, RenderGraph& _graph,
+                               const Device& _device, VmaAllocator _allocator);
+
+void destroyRenderGraphTextures(RenderGraphTextures& _textures, const Device& _device);
+
+// The framebuffers of the passes, on the views of the imported textures: released with the
+// swapchain they came from while the render passes and transients outlive it (a new swapchain of
+// the same format and extent), made again for the views of the next.
+void releaseRenderGraphFramebuffers(RenderGraphTextures& _textures, const Device& _device);
+
+// Records the barriers and the passes of the graph, each in a GPU timestamp span of its name (and
+// a debug label, with debugLabels). The async compute passes too, in order, on a device without a
+// queue family for them.
+void executeRenderGraph(const RenderGraph& _graph, RenderGraphTextures& _textures,
+                        const Device& _device, CommandBuffer& _commandBuffer,
+                        TimestampQueries& _queries, uint32_t _frame);
+
+/**
+ * @brief Records a batch of the graph (RenderGraph::getBatches()) alone, to be submitted to the
+ * queue it runs on once the batch it waits for signaled, the semaphore wait at
+ * VK_PIPELINE_STAGE_ALL_COMMANDS_BIT. Those of the async compute queue are in a command buffer of
+ * the compute family, without timestamp spans (the queries are reset by the graphics queue).
+ *
+ * The final barriers follow every batch (recordRenderGraphFinalBarriers()), at the end of a
+ * graphics submission waiting for the last compute batch.
+ */
+void executeRenderGraphBatch(const RenderGraph& _graph, uint32_t _batch,
+                             RenderGraphTextures& _textures, const Device& _device,
+                             CommandBuffer& _commandBuffer, TimestampQueries& _queries,
+                             uint32_t _frame);
+
+void recordRenderGraphFinalBarriers(const RenderGraph& _graph, RenderGraphTextures& _textures,
+                                    CommandBuffer& _commandBuffer);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
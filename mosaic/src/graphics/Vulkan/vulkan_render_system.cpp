@@ -1,6 +1,16 @@
 #include "vulkan_render_system.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "mosaic/exec/parallel_for.hpp"
+#include "mosaic/exec/task_graph.hpp"
 #include "mosaic/window/window_system.hpp"
+#include "mosaic/tools/memory_tracker.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+#include "vulkan_render_context.hpp"
 
 namespace mosaic
 {
@@ -9,34 +19,310 @@ namespace graphics
 namespace vulkan
 {
 
-pieces::RefResult<core::System, std::string> VulkanRenderSystem::initialize()
+// Next to the traces and the logs of the working directory
+static constexpr const char* k_pipelineCacheDirectory = "./cache";
+
+// The staging memory of the uploads in flight, split in UploadManager::k_chunkCount chunks
+static constexpr VkDeviceSize k_uploadStagingSize = 64 * 1024 * 1024;
+
+// The frames a released descriptor is kept for, more than the backbuffers of any context
+static constexpr uint32_t k_resourceRetireFrames = 4;
+
+// How long the startup waits for the window events before it looks at the stages again
+static constexpr std::chrono::milliseconds k_startupEventWait = std::chrono::milliseconds(2);
+
+// Waits for the startup graph: this thread helps with the stages, and once the device exists
+// (its selection makes a surface of the window) answers the window events between two, so the
+// window shows and stays responsive while the workers finish
+static void runStartup(exec::TaskGraph& _graph, exec::ThreadPool& _pool,
+                       const std::atomic<bool>& _deviceCreated)
 {
-    createInstance(m_instance);
+    auto windowSystem = window::WindowSystem::getInstance();
+
+    _graph.submit(_pool);
+
+    while (!_graph.waitFor(std::chrono::milliseconds(0)))
+    {
+        if (_pool.tryExecutePendingTask()) continue;
 
+        if (windowSystem && _deviceCreated.load(std::memory_order_acquire))
+        {
+            windowSystem->waitEvents(k_startupEventWait);
+        }
+        else
+        {
+            _graph.waitFor(k_startupEventWait);
+        }
+    }
+
+    _graph.wait();
+}
+
+pieces::RefResult<core::System, std::string> VulkanRenderSystem::initialize()
+{
     auto windowSystem = window::WindowSystem::getInstance();
+    auto window = windowSystem ? windowSystem->getWindow("MainWindow") : nullptr;
+
+    std::atomic<bool> deviceCreated = false;
+
+    auto startInstance = [&]
+    {
+        MOSAIC_TRACE_SCOPE("Vulkan instance");
+        createInstance(m_instance, getProfile().validation, getProfile().debugLabels);
+    };
+
+    auto selectDevice = [&]
+    {
+        MOSAIC_TRACE_SCOPE("Vulkan device");
+
+        // Without a window the device renders headless, to the offscreen images of the contexts
+        // (createHeadlessContext()), e.g. for the benchmarks run on CI
+        Surface dummySurface;
+        if (window)
+        {
+            createSurface(dummySurface, m_instance, window->getNativeHandle());
+        }
+        else
+        {
+            MOSAIC_INFO("No main window, the Vulkan render system is headless.");
+        }
+
+        createDevice(m_device, m_instance, dummySurface);
+
+        if (window) destroySurface(dummySurface, m_instance);
+
+        deviceCreated.store(true, std::memory_order_release);
+    };
+
+    auto createMemory = [&]
+    {
+        MOSAIC_TRACE_SCOPE("Vulkan allocator");
+        createAllocator(m_allocator, m_instance.instance, m_device.physicalDevice, m_device.device,
+                        &tools::MemoryTracker::getStats("vulkan"),
+                        isDeviceExtensionEnabled(m_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME));
+    };
+
+    auto createTable = [&]
+    {
+        MOSAIC_TRACE_SCOPE("Vulkan resource table");
+        createResourceTable(m_resourceTable, m_device, k_resourceRetireFrames);
+    };
+
+    // the cache read from disk and handed to the driver, the longest stage of a warm start
+    auto createPipelines = [&]
+    {
+        MOSAIC_TRACE_SCOPE("Vulkan pipeline library");
+        createPipelineLibrary(m_pipelineLibrary, m_device, k_pipelineCacheDirectory,
+                              m_resourceTable.layout);
+    };
+
+    auto createStreaming = [&]
+    {
+        MOSAIC_TRACE_SCOPE("Vulkan streaming");
+        createUploadManager(m_uploadManager, m_device, m_allocator, k_uploadStagingSize);
+        createTextureStreaming(m_textureStreaming, m_device, m_allocator, m_uploadManager,
+                               m_resourceTable);
+        createMeshStore(m_meshStore, m_device, m_allocator, m_uploadManager, m_resourceTable);
+        createMemoryManager(m_memoryManager, m_allocator, m_textureStreaming);
+    };
+
+    auto createMaterials = [&]
+    {
+        MOSAIC_TRACE_SCOPE("Vulkan descriptor set cache");
+        createDescriptorSetCache(m_materialSets, m_device);
+    };
+
+    if (exec::ThreadPool* pool = exec::ThreadPool::getInstance())
+    {
+        // Past the device, the stages only depend on those whose objects they take
+        exec::TaskGraph startup;
+        const exec::TaskNodeID instance = startup.addNode(startInstance, "Instance");
+        const exec::TaskNodeID device = startup.addNode(selectDevice, "Device");
+        const exec::TaskNodeID allocator = startup.addNode(createMemory, "Allocator");
+        const exec::TaskNodeID table = startup.addNode(createTable, "Resource table");
+        const exec::TaskNodeID pipelines = startup.addNode(createPipelines, "Pipeline library");
+        const exec::TaskNodeID streaming = startup.addNode(createStreaming, "Streaming");
+        const exec::TaskNodeID materials = startup.addNode(createMaterials, "Materials");
+
+        startup.precede(instance, device);
+        startup.precede(device, allocator);
+        startup.precede(device, table);
+        startup.precede(device, materials);
+        startup.precede(table, pipelines);
+        startup.precede(allocator, streaming);
+        startup.precede(table, streaming);
+
+        runStartup(startup, *pool, deviceCreated);
+    }
+    else
+    {
+        startInstance();
+        selectDevice();
+        createMemory();
+        createTable();
+        createPipelines();
+        createStreaming();
+        createMaterials();
+    }
+
+#if defined(MOSAIC_SHADER_SOURCE_DIR) && defined(MOSAIC_PLATFORM_DESKTOP)
+    // the sources edited are compiled again on a worker, swapped in between two frames
+    ShaderHotReload hotReload;
+    hotReload.sourceDirectory = MOSAIC_SHADER_SOURCE_DIR;
+    m_shaderLibrary.enableHotReload(hotReload);
+#endif
 
-    if (!windowSystem)
+    return pieces::OkRef<core::System, std::string>(*this);
+}
+
+pieces::RefResult<core::System, std::string> VulkanRenderSystem::update()
+{
+    // between two frames: the contexts build the pipelines of the shaders replaced
+    m_shaderLibrary.update();
+
+    auto result = RenderSystem::update();
+
+    // the frames reported the texture sizes and acquired the uploads
+    updateTextureStreaming(m_textureStreaming);
+
+    // the budget of the next update, a defragmentation pass if the frame left the time
+    updateMemoryManager(m_memoryManager);
+
+    // every context recorded the frame, the releases of the next one are stamped after it
+    advanceResourceTable(m_resourceTable);
+
+    return result;
+}
+
+void VulkanRenderSystem::renderContexts(std::span<RenderContext* const> _contexts)
+{
+    for (RenderContext* context : _contexts)
     {
-        return pieces::ErrRef<core::System, std::string>(
-            "Window system is not initialized. Cannot create Vulkan render system.");
+        const FramePacer& pacer = static_cast<VulkanRenderContext*>(context)->m_framePacer;
+        reportFrameTimes(m_memoryManager, pacer.getCpuTime(), pacer.getGpuTime());
     }
 
-    auto window = windowSystem->getWindow("MainWindow");
+    if (_contexts.size() <= 1)
+    {
+        RenderSystem::renderContexts(_contexts);
+        return;
+    }
 
-    if (!window)
+    // The swapchains replaced and the images acquired one after another, the contexts with
+    // nothing to render to left out of the frame. The shader library loads on this thread only:
+    // the reloaded shaders are looked up before the recording
+    std::vector<VulkanRenderContext*> contexts;
+    for (RenderContext* context : _contexts)
     {
-        return pieces::ErrRef<core::System, std::string>(
-            "Main window does not exist. Cannot create Vulkan render system.");
+        auto vulkanContext = static_cast<VulkanRenderContext*>(context);
+        if (!vulkanContext->beginFrame()) continue;
+
+        if (vulkanContext->m_shaderGeneration != m_shaderLibrary.getGeneration())
+        {
+            vulkanContext->loadShaders();
+        }
+
+        contexts.push_back(vulkanContext);
     }
 
-    Surface dummySurface;
-    createSurface(dummySurface, m_instance, window->getNativeHandle());
+    if (contexts.empty()) return;
 
-    createDevice(m_device, m_instance, dummySurface);
+    // The uploads of the last frame start now; the first command buffer of the batch acquires
+    // those done, the submissions all wait for them
+    submitUploads(m_uploadManager);
 
-    destroySurface(dummySurface, m_instance);
+    exec::parallelFor(size_t{0}, contexts.size(), size_t{1},
+                      [&](size_t _index)
+                      {
+                          MOSAIC_TRACE_SCOPE("Record context");
 
-    return pieces::OkRef<core::System, std::string>(*this);
+                          contexts[_index]->updateResources();
+                          contexts[_index]->recordFrame(_index == 0);
+                      });
+
+    const UploadTicket uploadWait = contexts[0]->m_uploadWait;
+
+    // The async compute batches of the graphs go to the compute queue, those of the graphics
+    // queue ahead of the submission of their frame
+    std::vector<FrameSubmission> submissions(contexts.size());
+    std::vector<VkSubmitInfo> submitInfos;
+    std::vector<VkSubmitInfo> computeInfos;
+    for (size_t i = 0; i < contexts.size(); ++i)
+    {
+        contexts[i]->prepareSubmission(submissions[i], uploadWait);
+
+        for (const auto& submit : submissions[i].graphicsSubmits)
+        {
+            submitInfos.push_back(submit.submitInfo);
+        }
+
+        for (const auto& submit : submissions[i].computeSubmits)
+        {
+            computeInfos.push_back(submit.submitInfo);
+        }
+
+        submitInfos.push_back(submissions[i].submitInfo);
+    }
+
+    // each queue waits for values the other signals later (timeline semaphores)
+    if (vkQueueSubmit(m_device.graphicsQueue, static_cast<uint32_t>(submitInfos.size()),
+                      submitInfos.data(), VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit the draw command buffers!");
+    }
+
+    if (!computeInfos.empty() &&
+        vkQueueSubmit(m_device.computeQueue, static_cast<uint32_t>(computeInfos.size()),
+                      computeInfos.data(), VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit the async compute command buffers!");
+    }
+
+    for (VulkanRenderContext* context : contexts) context->onSubmitted();
+
+    // One present of every swapchain, a result for each; the headless contexts present nothing
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<VkSwapchainKHR> swapchains;
+    std::vector<uint32_t> imageIndices;
+    std::vector<uint64_t> presentIds;
+    std::vector<VkResult> results(contexts.size(), VK_SUCCESS);
+    std::vector<VkResult*> resultOf(contexts.size(), nullptr);
+    for (size_t i = 0; i < contexts.size(); ++i)
+    {
+        if (!submissions[i].present) continue;
+
+        resultOf[i] = &results[swapchains.size()];
+        waitSemaphores.push_back(submissions[i].signalSemaphores[0]);
+        swapchains.push_back(submissions[i].swapchain);
+        imageIndices.push_back(submissions[i].imageIndex);
+        presentIds.push_back(submissions[i].presentId);
+    }
+
+    if (!swapchains.empty())
+    {
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+        presentInfo.pWaitSemaphores = waitSemaphores.data();
+        presentInfo.swapchainCount = static_cast<uint32_t>(swapchains.size());
+        presentInfo.pSwapchains = swapchains.data();
+        presentInfo.pImageIndices = imageIndices.data();
+        presentInfo.pResults = results.data();
+
+        // a 0 for the swapchains presented without an id
+        VkPresentIdKHR presentId{};
+        presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentId.swapchainCount = static_cast<uint32_t>(presentIds.size());
+        presentId.pPresentIds = presentIds.data();
+        if (m_device.presentWait) presentInfo.pNext = &presentId;
+
+        vkQueuePresentKHR(m_device.presentQueue, &presentInfo);
+    }
+
+    for (size_t i = 0; i < contexts.size(); ++i)
+    {
+        contexts[i]->onPresented(resultOf[i] ? *resultOf[i] : VK_SUCCESS);
+    }
 }
 
 void VulkanRenderSystem::shutdown()
@@ -45,6 +331,15 @@ void VulkanRenderSystem::shutdown()
 
     destroyAllContexts();
 
+    m_shaderLibrary.disableHotReload();
+
+    destroyDescriptorSetCache(m_materialSets);
+    destroyMeshStore(m_meshStore);
+    destroyTextureStreaming(m_textureStreaming);
+    destroyUploadManager(m_uploadManager);
+    destroyPipelineLibrary(m_pipelineLibrary);
+    destroyResourceTable(m_resourceTable);
+    destroyAllocator(m_allocator);
     destroyDevice(m_device);
     destroyInstance(m_instance);
 }
@@ -1,9 +1,18 @@
 #pragma once
 
 #include "mosaic/graphics/render_system.hpp"
+#include "mosaic/graphics/shader_library.hpp"
 
 #include "context/vulkan_instance.hpp"
 #include "context/vulkan_device.hpp"
+#include "vulkan_allocator.hpp"
+#include "pipelines/vulkan_pipeline_library.hpp"
+#include "vulkan_upload_manager.hpp"
+#include "vulkan_mesh_store.hpp"
+#include "vulkan_resource_table.hpp"
+#include "vulkan_texture_streaming.hpp"
+#include "vulkan_descriptor_cache.hpp"
+#include "vulkan_memory_manager.hpp"
 
 namespace mosaic
 {
@@ -17,18 +26,55 @@ class VulkanRenderSystem : public RenderSystem
    private:
     Instance m_instance;
     Device m_device;
+    VmaAllocator m_allocator;
+    ShaderLibrary m_shaderLibrary;     // reloaded between the frames in debug builds
+    PipelineLibrary m_pipelineLibrary; // shared by the contexts
+    UploadManager m_uploadManager;
+    ResourceTable m_resourceTable; // set 0 of the pipelines of the library
+    TextureStreaming m_textureStreaming;
+    MeshStore m_meshStore;
+    DescriptorSetCache m_materialSets; // the material sets of the devices without bindless
+    MemoryManager m_memoryManager;
 
    public:
-    VulkanRenderSystem() : RenderSystem(RendererAPIType::vulkan){};
+    VulkanRenderSystem() : RenderSystem(RendererAPIType::vulkan), m_allocator(VK_NULL_HANDLE){};
     ~VulkanRenderSystem() override = default;
 
    public:
     pieces::RefResult<core::System, std::string> initialize() override;
     void shutdown() override;
 
+    pieces::RefResult<core::System, std::string> update() override;
+
     inline Instance* getInstance() { return &m_instance; }
 
     inline Device* getDevice() { return &m_device; }
+
+    inline VmaAllocator getAllocator() { return m_allocator; }
+
+    inline ShaderLibrary* getShaderLibrary() { return &m_shaderLibrary; }
+
+    inline PipelineLibrary* getPipelineLibrary() { return &m_pipelineLibrary; }
+
+    inline UploadManager* getUploadManager() { return &m_uploadManager; }
+
+    inline ResourceTable* getResourceTable() { return &m_resourceTable; }
+
+    inline TextureStreaming* getTextureStreaming() { return &m_textureStreaming; }
+
+    inline MeshStore* getMeshStore() { return &m_meshStore; }
+
+    inline DescriptorSetCache* getMaterialSets() { return &m_materialSets; }
+
+    inline MemoryManager* getMemoryManager() { return &m_memoryManager; }
+
+   protected:
+    /**
+     * @brief With several contexts, the frames are recorded in parallel on the thread pool once
+     * each acquired its image, submitted in one vkQueueSubmit() and presented in one
+     * vkQueuePresentKHR(): a window costs its recording on a worker, not a frame of the others.
+     */
+    void renderContexts(std::span<RenderContext* const> _contexts) override;
 };
 
 } // namespace vulkan
@@ -0,0 +1,246 @@
+#include "vulkan_resource_table.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "mosaic/tools/logger.hpp"
+
+#include "pipelines/vulkan_pipeline.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+static constexpr VkDescriptorBindingFlags k_bindingFlags =
+    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+    VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+// Under the mutex of the table
+static void writeDescriptor(const ResourceTable& _table, uint32_t _binding, uint32_t _index,
+                            VkDescriptorType _type, const VkDescriptorBufferInfo* _bufferInfo,
+                            const VkDescriptorImageInfo* _imageInfo)
+{
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = _table.set;
+    write.dstBinding = _binding;
+    write.dstArrayElement = _index;
+    write.descriptorCount = 1;
+    write.descriptorType = _type;
+    write.pBufferInfo = _bufferInfo;
+    write.pImageInfo = _imageInfo;
+
+    vkUpdateDescriptorSets(_table.device->device, 1, &write, 0, nullptr);
+}
+
+void createResourceTable(ResourceTable& _table, const Device& _device, uint32_t _retireFrames)
+{
+    _table.device = &_device;
+    _table.retireFrames = _retireFrames;
+
+    VkPhysicalDeviceVulkan12Properties vulkan12Properties = {};
+    vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &vulkan12Properties;
+    vkGetPhysicalDeviceProperties2(_device.physicalDevice, &properties);
+
+    // the arrays are visible to the graphics and compute stages: the per stage limits apply
+    const uint32_t bufferCount =
+        std::min({ResourceTable::k_maxBuffers,
+                  vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+                  vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers});
+    const uint32_t textureCount =
+        std::min({ResourceTable::k_maxTextures,
+                  vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                  vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages});
+    const uint32_t samplerCount =
+        std::min({ResourceTable::k_maxSamplers,
+                  vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                  vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers});
+
+    // the meshlet task and mesh shaders read the table too, where the device has them
+    const VkShaderStageFlags stages =
+        k_resourceStages |
+        (_device.meshShader ? VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT : 0);
+
+    const std::array<VkDescriptorSetLayoutBinding, 3> bindings = {{
+        {ResourceTable::k_bufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bufferCount, stages,
+         nullptr},
+        {ResourceTable::k_textureBinding, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, textureCount, stages,
+         nullptr},
+        {ResourceTable::k_samplerBinding, VK_DESCRIPTOR_TYPE_SAMPLER, samplerCount, stages,
+         nullptr},
+    }};
+    const std::array<VkDescriptorBindingFlags, 3> bindingFlags = {k_bindingFlags, k_bindingFlags,
+                                                                  k_bindingFlags};
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(_device.device, &layoutInfo, nullptr, &_table.layout) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create resource table layout!");
+    }
+
+    const std::array<VkDescriptorPoolSize, 3> poolSizes = {{
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bufferCount},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, textureCount},
+        {VK_DESCRIPTOR_TYPE_SAMPLER, samplerCount},
+    }};
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    if (vkCreateDescriptorPool(_device.device, &poolInfo, nullptr, &_table.pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create resource table pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = _table.pool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &_table.layout;
+
+    if (vkAllocateDescriptorSets(_device.device, &allocateInfo, &_table.set) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate resource table set!");
+    }
+
+    _table.buffers = ResourcePool<ResourceTable::BufferRange, ResourceType::Buffer>(bufferCount);
+    _table.textures = ResourcePool<VkImageView, ResourceType::Texture>(textureCount);
+    _table.samplers = ResourcePool<VkSampler, ResourceType::Sampler>(samplerCount);
+
+    MOSAIC_INFO("Resource table: {} buffers, {} textures, {} samplers", bufferCount, textureCount,
+                samplerCount);
+}
+
+void destroyResourceTable(ResourceTable& _table)
+{
+    // the set is freed with its pool
+    vkDestroyDescriptorPool(_table.device->device, _table.pool, nullptr);
+    vkDestroyDescriptorSetLayout(_table.device->device, _table.layout, nullptr);
+
+    _table.pool = VK_NULL_HANDLE;
+    _table.layout = VK_NULL_HANDLE;
+    _table.set = VK_NULL_HANDLE;
+}
+
+BufferHandle registerBuffer(ResourceTable& _table, VkBuffer _buffer, VkDeviceSize _offset,
+                            VkDeviceSize _range)
+{
+    std::lock_guard lock(_table.mutex);
+
+    const BufferHandle handle = _table.buffers.allocate({_buffer, _offset, _range});
+    if (!handle.isValid())
+    {
+        MOSAIC_ERROR("The resource table is out of buffer descriptors!");
+        return handle;
+    }
+
+    const VkDescriptorBufferInfo bufferInfo = {_buffer, _offset, _range};
+    writeDescriptor(_table, ResourceTable::k_bufferBinding, handle.getIndex(),
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &bufferInfo, nullptr);
+
+    return handle;
+}
+
+TextureHandle registerTexture(ResourceTable& _table, VkImageView _view)
+{
+    std::lock_guard lock(_table.mutex);
+
+    const TextureHandle handle = _table.textures.allocate(_view);
+    if (!handle.isValid())
+    {
+        MOSAIC_ERROR("The resource table is out of texture descriptors!");
+        return handle;
+    }
+
+    const VkDescriptorImageInfo imageInfo = {VK_NULL_HANDLE, _view,
+                                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    writeDescriptor(_table, ResourceTable::k_textureBinding, handle.getIndex(),
+                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, nullptr, &imageInfo);
+
+    return handle;
+}
+
+SamplerHandle registerSampler(ResourceTable& _table, VkSampler _sampler)
+{
+    std::lock_guard lock(_table.mutex);
+
+    const SamplerHandle handle = _table.samplers.allocate(_sampler);
+    if (!handle.isValid())
+    {
+        MOSAIC_ERROR("The resource table is out of sampler descriptors!");
+        return handle;
+    }
+
+    const VkDescriptorImageInfo imageInfo = {_sampler, VK_NULL_HANDLE,
+                                             VK_IMAGE_LAYOUT_UNDEFINED};
+    writeDescriptor(_table, ResourceTable::k_samplerBinding, handle.getIndex(),
+                    VK_DESCRIPTOR_TYPE_SAMPLER, nullptr, &imageInfo);
+
+    return handle;
+}
+
+// The descriptors stay written: partially bound, a stale one is never read through a valid handle
+void releaseBuffer(ResourceTable& _table, BufferHandle _handle)
+{
+    std::lock_guard lock(_table.mutex);
+    _table.buffers.release(_handle, _table.frame);
+}
+
+void releaseTexture(ResourceTable& _table, TextureHandle _handle)
+{
+    std::lock_guard lock(_table.mutex);
+    _table.textures.release(_handle, _table.frame);
+}
+
+void releaseSampler(ResourceTable& _table, SamplerHandle _handle)
+{
+    std::lock_guard lock(_table.mutex);
+    _table.samplers.release(_handle, _table.frame);
+}
+
+void advanceResourceTable(ResourceTable& _table)
+{
+    std::lock_guard lock(_table.mutex);
+
+    ++_table.frame;
+    if (_table.frame <= _table.retireFrames) return;
+
+    const uint64_t completedFrame = _table.frame - _table.retireFrames - 1;
+    _table.buffers.recycle(completedFrame);
+    _table.textures.recycle(completedFrame);
+    _table.samplers.recycle(completedFrame);
+}
+
+void bindResourceTable(const ResourceTable& _table, CommandBuffer _commandBuffer,
+                       VkPipelineLayout _pipelineLayout, VkPipelineBindPoint _bindPoint)
+{
+    vkCmdBindDescriptorSets(_commandBuffer, _bindPoint, _pipelineLayout, 0, 1, &_table.set, 0,
+                            nullptr);
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
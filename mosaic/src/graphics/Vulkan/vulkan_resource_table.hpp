@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+#include "mosaic/graphics/resource_registry.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The buffers, textures and samplers of a device in one descriptor set of arrays, bound
+ * once per command buffer: the shaders index them by the BufferHandle, TextureHandle or
+ * SamplerHandle they are given (in push constants, or in a storage buffer), instead of the
+ * draws binding descriptors.
+ *
+ * Set 0 of every pipeline of the PipelineLibrary:
+ *   binding 0: StructuredBuffer/readonly buffer[] (k_bufferBinding)
+ *   binding 1: Texture2D/texture2D[]              (k_textureBinding)
+ *   binding 2: SamplerState/sampler[]             (k_samplerBinding)
+ * indexed with nonuniformEXT() when the index varies in a draw. The handles of a draw come in
+ * the push constants every pipeline has, DrawCall::resources at offset 0.
+ *
+ * The bindings are partially bound and updated after bind: registering writes the descriptor of
+ * a new slot while the set is in use, and a released slot is only reused once the frames that
+ * may read it completed (advanceResourceTable()).
+ */
+struct ResourceTable
+{
+    static constexpr uint32_t k_bufferBinding = 0;
+    static constexpr uint32_t k_textureBinding = 1;
+    static constexpr uint32_t k_samplerBinding = 2;
+
+    // Clamped to the limits of the device
+    static constexpr uint32_t k_maxBuffers = 1u << 16;
+    static constexpr uint32_t k_maxTextures = 1u << 16;
+    static constexpr uint32_t k_maxSamplers = 1u << 8;
+
+    struct BufferRange
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize range = VK_WHOLE_SIZE;
+    };
+
+    const Device* device;
+    VkDescriptorSetLayout layout;
+    VkDescriptorPool pool;
+    VkDescriptorSet set;
+
+    ResourcePool<BufferRange, ResourceType::Buffer> buffers;
+    ResourcePool<VkImageView, ResourceType::Texture> textures;
+    ResourcePool<VkSampler, ResourceType::Sampler> samplers;
+
+    uint64_t frame;        // of the render system, the releases are stamped with
+    uint32_t retireFrames; // after which no frame in flight reads a released descriptor
+
+    std::mutex mutex;
+
+    ResourceTable()
+        : device(nullptr),
+          layout(VK_NULL_HANDLE),
+          pool(VK_NULL_HANDLE),
+          set(VK_NULL_HANDLE),
+          frame(0),
+          retireFrames(0){};
+};
+
+// _retireFrames: at least the frames in flight of every context.
+void createResourceTable(ResourceTable& _table, const Device& _device, uint32_t _retireFrames);
+
+void destroyResourceTable(ResourceTable& _table);
+
+// An invalid handle when the array is full. Safe to call from several threads.
+BufferHandle registerBuffer(ResourceTable& _table, VkBuffer _buffer, VkDeviceSize _offset = 0,
+                            VkDeviceSize _range = VK_WHOLE_SIZE);
+
+// _view is read in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+TextureHandle registerTexture(ResourceTable& _table, VkImageView _view);
+
+SamplerHandle registerSampler(ResourceTable& _table, VkSampler _sampler);
+
+// The handle is invalid at once, the resource itself may be destroyed after retireFrames frames.
+void releaseBuffer(ResourceTable& _table, BufferHandle _handle);
+void releaseTexture(ResourceTable& _table, TextureHandle _handle);
+void releaseSampler(ResourceTable& _table, SamplerHandle _handle);
+
+// Once a frame of the render system, after every context rendered: recycles the retired slots.
+void advanceResourceTable(ResourceTable& _table);
+
+// Set 0 for the pipelines of _pipelineLayout, which share it with every pipeline of the library.
+void bindResourceTable(const ResourceTable& _table, CommandBuffer _commandBuffer,
+                       VkPipelineLayout _pipelineLayout,
+                       VkPipelineBindPoint _bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -1,12 +1,18 @@
 #include "vulkan_swapchain.hpp"
 
 #include <algorithm>
+#include <array>
+#include <utility>
 
 #if defined(MOSAIC_PLATFORM_DESKTOP) || defined(MOSAIC_PLATFORM_WEB)
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
 #endif
 
+#if !defined(MOSAIC_PLATFORM_WINDOWS)
+#include <unistd.h>
+#endif
+
 namespace mosaic
 {
 namespace graphics
@@ -124,12 +130,32 @@ VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>
         "Failed to find a suitable Vulkan surface format! No preferred formats available.");
 }
 
-VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& _availablePresentModes)
+static constexpr std::array<std::pair<PresentMode, VkPresentModeKHR>, 4> k_presentModes = {{
+    {PresentMode::Immediate, VK_PRESENT_MODE_IMMEDIATE_KHR},
+    {PresentMode::Mailbox, VK_PRESENT_MODE_MAILBOX_KHR},
+    {PresentMode::Fifo, VK_PRESENT_MODE_FIFO_KHR},
+    {PresentMode::FifoRelaxed, VK_PRESENT_MODE_FIFO_RELAXED_KHR},
+}};
+
+VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& _availablePresentModes,
+                                       PresentPolicy _presentPolicy)
 {
-    if (std::find(_availablePresentModes.begin(), _availablePresentModes.end(),
-                  VK_PRESENT_MODE_MAILBOX_KHR) != _availablePresentModes.end())
+    std::vector<PresentMode> supported;
+    for (const auto& [mode, vkMode] : k_presentModes)
     {
-        return VK_PRESENT_MODE_MAILBOX_KHR;
+        if (std::find(_availablePresentModes.begin(), _availablePresentModes.end(), vkMode) !=
+            _availablePresentModes.end())
+        {
+            supported.push_back(mode);
+        }
+    }
+
+    const PresentMode mode = choosePresentMode(_presentPolicy, supported);
+    MOSAIC_INFO("Present mode: {}", getPresentModeName(mode));
+
+    for (const auto& [candidate, vkMode] : k_presentModes)
+    {
+        if (candidate == mode) return vkMode;
     }
 
     return VK_PRESENT_MODE_FIFO_KHR;
@@ -157,7 +183,8 @@ VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& _capabilities,
 
 void createSwapchain(Swapchain& _swapchain, const Device& _device, const Surface& _surface,
                      [[maybe_unused]] void* _nativeWindowHandle, glm::uvec2 _framebufferExtent,
-                     [[maybe_unused]] bool _exclusiveFullscreenRequestable)
+                     [[maybe_unused]] bool _exclusiveFullscreenRequestable, uint32_t _imageCount,
+                     PresentPolicy _presentPolicy, VkSwapchainKHR _oldSwapchain)
 {
     _swapchain.device = _device.device;
 
@@ -165,16 +192,12 @@ void createSwapchain(Swapchain& _swapchain, const Device& _device, const Surface
         findDeviceSwapChainSupport(_device.physicalDevice, _surface.surface);
 
     _swapchain.surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-    _swapchain.presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+    _swapchain.presentMode = chooseSwapPresentMode(swapChainSupport.presentModes, _presentPolicy);
     _swapchain.extent = chooseSwapExtent(swapChainSupport.capabilities, _framebufferExtent);
 
-    uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-
-    if (swapChainSupport.capabilities.maxImageCount > 0 &&
-        imageCount > swapChainSupport.capabilities.maxImageCount)
-    {
-        imageCount = swapChainSupport.capabilities.maxImageCount;
-    }
+    const uint32_t imageCount =
+        chooseBackbufferCount(_imageCount, swapChainSupport.capabilities.minImageCount,
+                              swapChainSupport.capabilities.maxImageCount);
 
     VkSwapchainCreateInfoKHR createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -219,7 +242,11 @@ void createSwapchain(Swapchain& _swapchain, const Device& _device, const Surface
     createInfo.imageColorSpace = _swapchain.surfaceFormat.colorSpace;
     createInfo.imageExtent = _swapchain.extent;
     createInfo.imageArrayLayers = 1;
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // the scene rendered at a lower resolution is blitted to the images
+    _swapchain.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                       (swapChainSupport.capabilities.supportedUsageFlags &
+                        VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    createInfo.imageUsage = _swapchain.usage;
     createInfo.presentMode = _swapchain.presentMode;
 
     QueueFamilySupportDetails queueSupportDetails =
@@ -244,7 +271,8 @@ void createSwapchain(Swapchain& _swapchain, const Device& _device, const Surface
     createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = nullptr;
+    // The driver may reuse the resources of the swapchain replaced, which is retired by the call
+    createInfo.oldSwapchain = _oldSwapchain;
 
     MOSAIC_INFO("Surface dimensions: {}x{}", _swapchain.extent.width, _swapchain.extent.height);
 
@@ -261,19 +289,252 @@ void createSwapchain(Swapchain& _swapchain, const Device& _device, const Surface
 
     createImageViews(_swapchain);
 
+    // An image is acquired again once its presentation is done with the semaphore: one per image,
+    // not per frame in flight, is never signaled while a presentation still waits for it
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    _swapchain.presentSemaphores.resize(imageCount, VK_NULL_HANDLE);
+    for (VkSemaphore& semaphore : _swapchain.presentSemaphores)
+    {
+        if (vkCreateSemaphore(_swapchain.device, &semaphoreInfo, nullptr, &semaphore) !=
+            VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create swapchain present semaphore!");
+        }
+    }
+
 #ifdef MOSAIC_PLATFORM_WINDOWS
     if (_swapchain.exclusiveFullscreenAvailable) acquireExclusiveFullscreenMode(_swapchain);
 #endif
 }
 
+// Of a semaphore of an exportable offscreen chain
+static bool exportSemaphore(VkDevice _device, VkSemaphore _semaphore,
+                            ExportedFrames::NativeHandle& _handle)
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    VkSemaphoreGetWin32HandleInfoKHR handleInfo = {};
+    handleInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_WIN32_HANDLE_INFO_KHR;
+    handleInfo.semaphore = _semaphore;
+    handleInfo.handleType = k_exportSemaphoreHandleType;
+
+    HANDLE handle = nullptr;
+    if (vkGetSemaphoreWin32HandleKHR(_device, &handleInfo, &handle) != VK_SUCCESS) return false;
+
+    _handle = reinterpret_cast<ExportedFrames::NativeHandle>(handle);
+#else
+    VkSemaphoreGetFdInfoKHR fdInfo = {};
+    fdInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR;
+    fdInfo.semaphore = _semaphore;
+    fdInfo.handleType = k_exportSemaphoreHandleType;
+
+    int fd = -1;
+    if (vkGetSemaphoreFdKHR(_device, &fdInfo, &fd) != VK_SUCCESS) return false;
+
+    _handle = fd;
+#endif
+
+    return true;
+}
+
+static void closeNativeHandle(ExportedFrames::NativeHandle _handle)
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    CloseHandle(reinterpret_cast<HANDLE>(_handle));
+#else
+    close(static_cast<int>(_handle));
+#endif
+}
+
+// Whether the device exports the semaphores of the handshake, binary ones
+static bool isSemaphoreExportable(const Device& _device)
+{
+    VkPhysicalDeviceExternalSemaphoreInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_SEMAPHORE_INFO;
+    semaphoreInfo.handleType = k_exportSemaphoreHandleType;
+
+    VkExternalSemaphoreProperties properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_EXTERNAL_SEMAPHORE_PROPERTIES;
+
+    vkGetPhysicalDeviceExternalSemaphoreProperties(_device.physicalDevice, &semaphoreInfo,
+                                                   &properties);
+
+    return properties.externalSemaphoreFeatures & VK_EXTERNAL_SEMAPHORE_FEATURE_EXPORTABLE_BIT;
+}
+
+void createOffscreenSwapchain(Swapchain& _swapchain, const Device& _device,
+                              VmaAllocator _allocator, glm::uvec2 _extent, uint32_t _imageCount,
+                              bool _exportable)
+{
+    _swapchain.device = _device.device;
+    _swapchain.allocator = _allocator;
+
+    if (_exportable && !(_device.frameExport && isSemaphoreExportable(_device)))
+    {
+        MOSAIC_WARN("Vulkan device cannot export the offscreen images, the frames stay local.");
+        _exportable = false;
+    }
+
+    // the format a desktop surface is given first, the pipelines are the same; exported, the
+    // one GL and D3D import without swapping the channels
+    _swapchain.surfaceFormat = {_exportable ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_B8G8R8A8_SRGB,
+                                VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+    _swapchain.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    _swapchain.extent = {std::max(_extent.x, 1u), std::max(_extent.y, 1u)};
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = _swapchain.surfaceFormat.format;
+    imageInfo.extent = {_swapchain.extent.width, _swapchain.extent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    _swapchain.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                       VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+    imageInfo.usage = _swapchain.usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (_exportable && !createExportableImagePool(_allocator, imageInfo, _swapchain.exportPool))
+    {
+        MOSAIC_WARN("Vulkan offscreen images of {} cannot be exported, the frames stay local.",
+                    string_VkFormat(imageInfo.format));
+        _exportable = false;
+    }
+
+    _swapchain.images.resize(std::max(_imageCount, 1u), VK_NULL_HANDLE);
+    _swapchain.allocations.resize(_swapchain.images.size(), VK_NULL_HANDLE);
+    for (size_t i = 0; i < _swapchain.images.size(); ++i)
+    {
+        if (_exportable)
+        {
+            createExportableImage(_allocator, _swapchain.exportPool, imageInfo,
+                                  _swapchain.images[i], _swapchain.allocations[i]);
+        }
+        else
+        {
+            createDeviceImage(_allocator, imageInfo, _swapchain.images[i],
+                              _swapchain.allocations[i], MemoryCategory::RenderTargets);
+        }
+    }
+
+    createImageViews(_swapchain);
+
+    if (_exportable)
+    {
+        VkExportSemaphoreCreateInfo exportInfo = {};
+        exportInfo.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO;
+        exportInfo.handleTypes = k_exportSemaphoreHandleType;
+
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &exportInfo;
+
+        _swapchain.readySemaphores.resize(_swapchain.images.size(), VK_NULL_HANDLE);
+        _swapchain.releasedSemaphores.resize(_swapchain.images.size(), VK_NULL_HANDLE);
+
+        for (size_t i = 0; i < _swapchain.images.size(); ++i)
+        {
+            if (vkCreateSemaphore(_swapchain.device, &semaphoreInfo, nullptr,
+                                  &_swapchain.readySemaphores[i]) != VK_SUCCESS ||
+                vkCreateSemaphore(_swapchain.device, &semaphoreInfo, nullptr,
+                                  &_swapchain.releasedSemaphores[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create offscreen export semaphore!");
+            }
+        }
+    }
+
+    MOSAIC_INFO("Offscreen dimensions: {}x{}", _swapchain.extent.width, _swapchain.extent.height);
+}
+
+bool exportOffscreenSwapchain(const Swapchain& _swapchain, ExportedFrames& _frames)
+{
+    if (_swapchain.exportPool == VK_NULL_HANDLE) return false;
+
+    _frames.extent = {_swapchain.extent.width, _swapchain.extent.height};
+    _frames.format = static_cast<uint32_t>(_swapchain.surfaceFormat.format);
+    _frames.images.clear();
+
+    for (size_t i = 0; i < _swapchain.images.size(); ++i)
+    {
+        ExportedFrames::Image image = {};
+        VkDeviceSize size = 0;
+
+        const VkDevice device = _swapchain.device;
+        const bool memory =
+            exportImageMemory(_swapchain.allocator, _swapchain.allocations[i], image.memory, size);
+        const bool ready =
+            memory && exportSemaphore(device, _swapchain.readySemaphores[i], image.ready);
+        const bool released =
+            ready && exportSemaphore(device, _swapchain.releasedSemaphores[i], image.released);
+
+        image.memorySize = size;
+
+        if (!released)
+        {
+            if (memory) closeNativeHandle(image.memory);
+            if (ready) closeNativeHandle(image.ready);
+
+            for (const ExportedFrames::Image& exported : _frames.images)
+            {
+                closeNativeHandle(exported.memory);
+                closeNativeHandle(exported.ready);
+                closeNativeHandle(exported.released);
+            }
+            _frames.images.clear();
+
+            return false;
+        }
+
+        _frames.images.push_back(image);
+    }
+
+    return true;
+}
+
 void destroySwapchain(Swapchain& _swapchain)
 {
 #ifdef MOSAIC_PLATFORM_WINDOWS
     if (_swapchain.exclusiveFullscreenAvailable) releaseExclusiveFullscreenMode(_swapchain);
 #endif
 
+    for (VkSemaphore semaphore : _swapchain.presentSemaphores)
+    {
+        vkDestroySemaphore(_swapchain.device, semaphore, nullptr);
+    }
+    _swapchain.presentSemaphores.clear();
+
+    for (size_t i = 0; i < _swapchain.readySemaphores.size(); ++i)
+    {
+        vkDestroySemaphore(_swapchain.device, _swapchain.readySemaphores[i], nullptr);
+        vkDestroySemaphore(_swapchain.device, _swapchain.releasedSemaphores[i], nullptr);
+    }
+    _swapchain.readySemaphores.clear();
+    _swapchain.releasedSemaphores.clear();
+
     destroyImageViews(_swapchain);
-    vkDestroySwapchainKHR(_swapchain.device, _swapchain.swapchain, nullptr);
+
+    // offscreen, the images are those of the chain
+    for (size_t i = 0; i < _swapchain.allocations.size(); ++i)
+    {
+        destroyDeviceImage(_swapchain.allocator, _swapchain.images[i], _swapchain.allocations[i]);
+    }
+    _swapchain.allocations.clear();
+
+    if (_swapchain.exportPool != VK_NULL_HANDLE)
+    {
+        destroyPool(_swapchain.allocator, _swapchain.exportPool);
+    }
+
+    if (_swapchain.swapchain != VK_NULL_HANDLE)
+    {
+        vkDestroySwapchainKHR(_swapchain.device, _swapchain.swapchain, nullptr);
+    }
 }
 
 } // namespace vulkan
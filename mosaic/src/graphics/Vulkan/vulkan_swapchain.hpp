@@ -4,7 +4,12 @@
 
 #include <glm/vec2.hpp>
 
+#include "mosaic/graphics/exported_frames.hpp"
+#include "mosaic/graphics/present_mode.hpp"
+#include "mosaic/graphics/render_profile.hpp"
+
 #include "vulkan_common.hpp"
+#include "vulkan_allocator.hpp"
 #include "context/vulkan_device.hpp"
 
 namespace mosaic
@@ -21,9 +26,15 @@ struct Swapchain
     VkSurfaceFormatKHR surfaceFormat;
     VkPresentModeKHR presentMode;
     VkExtent2D extent;
+    VkImageUsageFlags usage; // of the images: blitted to (TRANSFER_DST) where the surface allows
     std::vector<VkImage> images;
     std::vector<VkImageView> imageViews;
-    std::vector<VkFramebuffer> framebuffers;
+    std::vector<VkSemaphore> presentSemaphores; // per image, the presentation of a frame waits for
+    VmaAllocator allocator;                     // of the images of an offscreen chain
+    std::vector<VmaAllocation> allocations;
+    VmaPool exportPool; // offscreen, exported: the images in memory of their own to export
+    std::vector<VkSemaphore> readySemaphores;    // exported, per image: see ExportedFrames
+    std::vector<VkSemaphore> releasedSemaphores;
     bool exclusiveFullscreenAvailable;
 
     Swapchain()
@@ -32,12 +43,31 @@ struct Swapchain
           surfaceFormat({}),
           presentMode(),
           extent({}),
+          usage(0),
+          allocator(VK_NULL_HANDLE),
+          exportPool(VK_NULL_HANDLE),
           exclusiveFullscreenAvailable(false){};
 };
 
+// _imageCount images at least (more when the surface needs it, 0 for one more than its minimum),
+// presented in the mode the surface supports that suits _presentPolicy best
 void createSwapchain(Swapchain& _swapchain, const Device& _device, const Surface& _surface,
                      void* _nativeWindowHandle, glm::uvec2 _framebufferExtent,
-                     bool _exclusiveFullscreenRequestable);
+                     bool _exclusiveFullscreenRequestable, uint32_t _imageCount,
+                     PresentPolicy _presentPolicy,
+                     VkSwapchainKHR _oldSwapchain = VK_NULL_HANDLE);
+
+// The images of a headless context, without a surface nor a swapchain: rendered to in turn and
+// never presented, copied from for a readback (VK_IMAGE_USAGE_TRANSFER_SRC_BIT). With _exportable
+// (and a device with frameExport), the images and their semaphores can be exported, in
+// R8G8B8A8_SRGB: the format other APIs import; the chain falls back to a plain one otherwise
+void createOffscreenSwapchain(Swapchain& _swapchain, const Device& _device,
+                              VmaAllocator _allocator, glm::uvec2 _extent, uint32_t _imageCount,
+                              bool _exportable = false);
+
+// New handles of the images and semaphores of an exportable offscreen chain, owned by the caller;
+// false (none left open) if the chain is not exportable or the driver refused a handle
+bool exportOffscreenSwapchain(const Swapchain& _swapchain, ExportedFrames& _frames);
 
 void destroySwapchain(Swapchain& _swapchain);
 
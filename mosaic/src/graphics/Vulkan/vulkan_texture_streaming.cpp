@@ -0,0 +1,668 @@
+#include "vulkan_texture_streaming.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "mosaic/core/mapped_file.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// The stages the frames sample the textures in
+static constexpr VkPipelineStageFlags k_samplingStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+// The moves of a defragmentation pass, at most: the textures a pass re-registers
+static constexpr uint32_t k_maxMovesPerPass = 32;
+
+// The block compressed formats a device may sample, by preference
+static constexpr TextureFormat k_compressedFormats[] = {
+    TextureFormat::ASTC4x4, TextureFormat::BC7,       TextureFormat::BC5,     TextureFormat::BC3,
+    TextureFormat::BC1,     TextureFormat::ETC2RGBA8, TextureFormat::ETC2RGB8};
+
+static VkFormat getVkFormat(TextureFormat _format, bool _srgb)
+{
+    switch (_format)
+    {
+        case TextureFormat::BC1:
+            return _srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case TextureFormat::BC3:
+            return _srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+        case TextureFormat::BC5:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case TextureFormat::BC7:
+            return _srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+        case TextureFormat::ETC2RGB8:
+            return _srgb ? VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK : VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+        case TextureFormat::ETC2RGBA8:
+            return _srgb ? VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+                         : VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+        case TextureFormat::ASTC4x4:
+            return _srgb ? VK_FORMAT_ASTC_4x4_SRGB_BLOCK : VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+        default:
+            return _srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+static void retire(TextureStreaming& _streaming, VkImage& _image, VmaAllocation& _allocation,
+                   VkImageView& _view)
+{
+    if (_image == VK_NULL_HANDLE) return;
+
+    _streaming.retired.push_back({_image, _allocation, _view, _streaming.frame});
+
+    _image = VK_NULL_HANDLE;
+    _allocation = VK_NULL_HANDLE;
+    _view = VK_NULL_HANDLE;
+}
+
+static void destroyImage(TextureStreaming& _streaming, VkImage& _image,
+                         VmaAllocation& _allocation, VkImageView& _view)
+{
+    if (_image == VK_NULL_HANDLE) return;
+
+    vkDestroyImageView(_streaming.device->device, _view, nullptr);
+    destroyDeviceImage(_streaming.allocator, _image, _allocation);
+    _view = VK_NULL_HANDLE;
+}
+
+// The image of the decoded mips, their uploads recorded
+static void uploadMips(TextureStreaming& _streaming, TextureStreaming::Texture& _texture,
+                       const TextureMipChain& _mips)
+{
+    const TextureMip& first = _mips.mips.front();
+    const VkFormat format = getVkFormat(_mips.format, _mips.srgb);
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = {first.width, first.height, 1};
+    imageInfo.mipLevels = static_cast<uint32_t>(_mips.mips.size());
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    // the source of the defragmentation copies too
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                      VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    createDeviceImage(_streaming.allocator, imageInfo, _texture.nextImage,
+                      _texture.nextAllocation, MemoryCategory::Textures, _streaming.pool);
+    _texture.nextImageInfo = imageInfo;
+
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = _texture.nextImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, imageInfo.mipLevels, 0, 1};
+
+    if (vkCreateImageView(_streaming.device->device, &viewInfo, nullptr, &_texture.nextView) !=
+        VK_SUCCESS)
+    {
+        destroyDeviceImage(_streaming.allocator, _texture.nextImage, _texture.nextAllocation);
+        throw std::runtime_error("failed to create streamed texture image view!");
+    }
+
+    for (uint32_t level = 0; level < _mips.mips.size(); ++level)
+    {
+        const TextureMip& mip = _mips.mips[level];
+
+        _texture.ticket = uploadImage(*_streaming.uploads, _texture.nextImage,
+                                      {mip.width, mip.height, 1}, VK_IMAGE_ASPECT_COLOR_BIT,
+                                      _mips.texels.data() + mip.offset, mip.size,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, level);
+    }
+
+    _texture.nextMip = _mips.firstMip;
+}
+
+// The moves replaced their images: the former ones destroyed, no frame reads them any more, and
+// the memory of the textures moved to the new ones
+static void endDefragmentationPass(TextureStreaming& _streaming)
+{
+    TextureStreaming::Defragmentation& defragmentation = _streaming.defragmentation;
+
+    for (TextureStreaming::Moved& moved : defragmentation.moved)
+    {
+        vkDestroyImageView(_streaming.device->device, moved.view, nullptr);
+        vkDestroyImage(_streaming.device->device, moved.image, nullptr);
+        _streaming.textures[moved.texture]->moving = false;
+    }
+
+    defragmentation.moved.clear();
+
+    const VkResult result = vmaEndDefragmentationPass(_streaming.allocator,
+                                                      defragmentation.context,
+                                                      &defragmentation.pass);
+    defragmentation.pass = {};
+
+    // VK_INCOMPLETE: the next pass has moves
+    if (result != VK_SUCCESS) return;
+
+    VmaDefragmentationStats stats = {};
+    vmaEndDefragmentation(_streaming.allocator, defragmentation.context, &stats);
+    defragmentation.context = VK_NULL_HANDLE;
+
+    MOSAIC_INFO("Streamed textures defragmented: {} allocations moved, {} KiB freed.",
+                stats.allocationsMoved, stats.bytesFreed / 1024);
+}
+
+// The image of a move, in its new memory, and registered; false if it could not be
+static bool createMovedImage(TextureStreaming& _streaming, TextureStreaming::Texture& _texture,
+                             VmaAllocation _allocation, VkImage& _image, VkImageView& _view,
+                             TextureHandle& _handle)
+{
+    const VkDevice device = _streaming.device->device;
+
+    if (vkCreateImage(device, &_texture.imageInfo, nullptr, &_image) != VK_SUCCESS) return false;
+
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = _image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = _texture.imageInfo.format;
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, _texture.imageInfo.mipLevels, 0, 1};
+
+    if (vmaBindImageMemory(_streaming.allocator, _allocation, _image) == VK_SUCCESS &&
+        vkCreateImageView(device, &viewInfo, nullptr, &_view) == VK_SUCCESS)
+    {
+        _handle = registerTexture(*_streaming.table, _view);
+        if (_handle.isValid()) return true;
+
+        vkDestroyImageView(device, _view, nullptr);
+    }
+
+    vkDestroyImage(device, _image, nullptr);
+    _image = VK_NULL_HANDLE;
+    _view = VK_NULL_HANDLE;
+    return false;
+}
+
+// The copies of the moves, to the new images in the layout the frames sample them in
+static void recordMoveCopies(TextureStreaming& _streaming)
+{
+    const CommandBuffer commandBuffer = _streaming.commandBuffer;
+    const std::vector<TextureStreaming::Moved>& moves = _streaming.defragmentation.moved;
+
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording texture defragmentation!");
+    }
+
+    // the former images after the frames sampling them, the new ones from nothing
+    std::vector<VkImageMemoryBarrier> barriers;
+    barriers.reserve(moves.size() * 2);
+
+    for (const TextureStreaming::Moved& moved : moves)
+    {
+        const TextureStreaming::Texture& texture = *_streaming.textures[moved.texture];
+
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.imageInfo.mipLevels, 0,
+                                    1};
+
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.image = moved.image;
+        barriers.push_back(barrier);
+
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.image = texture.image;
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, k_samplingStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()),
+                         barriers.data());
+
+    std::vector<VkImageCopy> regions;
+    for (const TextureStreaming::Moved& moved : moves)
+    {
+        const TextureStreaming::Texture& texture = *_streaming.textures[moved.texture];
+        const VkExtent3D extent = texture.imageInfo.extent;
+
+        regions.clear();
+        for (uint32_t level = 0; level < texture.imageInfo.mipLevels; ++level)
+        {
+            VkImageCopy region = {};
+            region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+            region.dstSubresource = region.srcSubresource;
+            region.extent = {std::max(extent.width >> level, 1u),
+                             std::max(extent.height >> level, 1u), 1};
+            regions.push_back(region);
+        }
+
+        vkCmdCopyImage(commandBuffer, moved.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       static_cast<uint32_t>(regions.size()), regions.data());
+    }
+
+    // the new images only, the former ones are destroyed
+    barriers.clear();
+    for (const TextureStreaming::Moved& moved : moves)
+    {
+        const TextureStreaming::Texture& texture = *_streaming.textures[moved.texture];
+
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = texture.image;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.imageInfo.mipLevels, 0,
+                                    1};
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, k_samplingStages, 0, 0,
+                         nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()),
+                         barriers.data());
+
+    endCommandBuffer(_streaming.commandBuffer);
+}
+
+// Decodes the new mips of a texture on a worker
+static void decodeMips(TextureStreaming& _streaming, const TextureResidencyChange& _change)
+{
+    auto task = [&_streaming, change = _change, path = _streaming.textures[_change.texture]->path]
+    {
+        // written before the first texture is loaded only
+        const std::span<const TextureFormat> formats = _streaming.formats;
+        TextureStreaming::Decoded decoded = {change.texture, std::nullopt};
+
+        try
+        {
+            const core::MappedFile file(path);
+            auto mips = decodeTextureMips(file.bytes(), change.firstMip, formats);
+
+            if (mips.isOk())
+            {
+                decoded.mips = std::move(mips.unwrap());
+            }
+            else
+            {
+                MOSAIC_ERROR("Failed to stream texture {}: {}", path.string(), mips.error());
+            }
+        }
+        catch (const std::exception& _error)
+        {
+            MOSAIC_ERROR("Failed to stream texture {}: {}", path.string(), _error.what());
+        }
+
+        std::lock_guard lock(_streaming.mutex);
+        _streaming.decoded.push_back(std::move(decoded));
+    };
+
+    if (exec::ThreadPool* pool = exec::ThreadPool::getInstance())
+    {
+        // the frames go first, a texture is blurred a few frames longer at worst
+        auto future = pool->enqueueToGlobal(exec::TaskPriority::background, task);
+        if (future)
+        {
+            _streaming.tasks.push_back(std::move(*future));
+            return;
+        }
+    }
+
+    task();
+}
+
+void createTextureStreaming(TextureStreaming& _streaming, const Device& _device,
+                            VmaAllocator _allocator, UploadManager& _uploads,
+                            ResourceTable& _table, TextureStreamingSettings _settings)
+{
+    _streaming.device = &_device;
+    _streaming.allocator = _allocator;
+    _streaming.uploads = &_uploads;
+    _streaming.table = &_table;
+
+    for (TextureFormat format : k_compressedFormats)
+    {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(_device.physicalDevice, getVkFormat(format, false),
+                                            &properties);
+
+        if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+        {
+            _streaming.formats.push_back(format);
+        }
+    }
+
+    // a mip is uploaded at once
+    _settings.maxMipSize = std::min<uint64_t>(_settings.maxMipSize, _uploads.chunkSize);
+    _streaming.streamer = TextureStreamer(_settings);
+
+    // the memory type of a typical texture, the compressed ones get the same on the devices
+    // known: those which would not go to the default pools
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = {256, 256, 1};
+    imageInfo.mipLevels = 9;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                      VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (!createImagePool(_allocator, imageInfo, _streaming.pool))
+    {
+        MOSAIC_WARN("No pool for the streamed textures, they will not be defragmented.");
+        return;
+    }
+
+    createCommandPool(_streaming.commandPool, _device, _device.graphicsFamily);
+    createCommandBuffer(_streaming.commandBuffer, _device, _streaming.commandPool);
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    if (vkCreateFence(_device.device, &fenceInfo, nullptr, &_streaming.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create texture defragmentation fence!");
+    }
+}
+
+void destroyTextureStreaming(TextureStreaming& _streaming)
+{
+    // the tasks report to the streaming
+    for (exec::TaskFuture<void>& task : _streaming.tasks) task.wait();
+    _streaming.tasks.clear();
+    _streaming.decoded.clear();
+
+    // the memory of the textures is theirs again, the device idle
+    TextureStreaming::Defragmentation& defragmentation = _streaming.defragmentation;
+    if (defragmentation.pass.moveCount > 0) endDefragmentationPass(_streaming);
+    if (defragmentation.context != VK_NULL_HANDLE)
+    {
+        vmaEndDefragmentation(_streaming.allocator, defragmentation.context, nullptr);
+        defragmentation.context = VK_NULL_HANDLE;
+    }
+
+    for (auto& texture : _streaming.textures)
+    {
+        if (texture->handle.isValid()) releaseTexture(*_streaming.table, texture->handle);
+
+        destroyImage(_streaming, texture->image, texture->allocation, texture->view);
+        destroyImage(_streaming, texture->nextImage, texture->nextAllocation, texture->nextView);
+    }
+
+    for (TextureStreaming::Retired& retired : _streaming.retired)
+    {
+        destroyImage(_streaming, retired.image, retired.allocation, retired.view);
+    }
+
+    _streaming.textures.clear();
+    _streaming.retired.clear();
+
+    if (_streaming.pool == VK_NULL_HANDLE) return;
+
+    vkDestroyFence(_streaming.device->device, _streaming.fence, nullptr);
+    destroyCommandBuffer(_streaming.commandBuffer, *_streaming.device, _streaming.commandPool);
+    destroyCommandPool(_streaming.commandPool, *_streaming.device);
+    destroyPool(_streaming.allocator, _streaming.pool);
+}
+
+StreamedTextureId loadStreamedTexture(TextureStreaming& _streaming,
+                                      const std::filesystem::path& _path)
+{
+    const core::MappedFile file(_path);
+
+    auto description = readTextureDescription(file.bytes(), _streaming.formats);
+    if (description.isErr())
+    {
+        throw std::runtime_error("Failed to read texture " + _path.string() + ": " +
+                                 description.error());
+    }
+
+    const TextureDescription& texture = description.unwrap();
+    const StreamedTextureId id = _streaming.streamer.add(texture.width, texture.height,
+                                                         texture.mipLevels, texture.format);
+
+    _streaming.textures.push_back(std::make_unique<TextureStreaming::Texture>());
+    _streaming.textures.back()->path = _path;
+
+    return id;
+}
+
+void requestStreamedTexture(TextureStreaming& _streaming, StreamedTextureId _texture,
+                            float _screenExtent)
+{
+    _streaming.streamer.request(_texture, _screenExtent);
+}
+
+TextureHandle getStreamedTexture(const TextureStreaming& _streaming, StreamedTextureId _texture)
+{
+    return _streaming.textures[_texture]->handle;
+}
+
+void updateTextureStreaming(TextureStreaming& _streaming)
+{
+    TextureStreamer& streamer = _streaming.streamer;
+    const uint32_t retireFrames = _streaming.table->retireFrames;
+
+    // The defragmentation pass copied and no frame reads the former images: ended
+    const TextureStreaming::Defragmentation& defragmentation = _streaming.defragmentation;
+    if (defragmentation.pass.moveCount > 0 &&
+        _streaming.frame > defragmentation.frame + retireFrames &&
+        vkGetFenceStatus(_streaming.device->device, _streaming.fence) == VK_SUCCESS)
+    {
+        endDefragmentationPass(_streaming);
+    }
+
+    // The uploads the frames acquired: swapped in, once the memory of the texture is not moving
+    for (StreamedTextureId id = 0; id < _streaming.textures.size(); ++id)
+    {
+        TextureStreaming::Texture& texture = *_streaming.textures[id];
+
+        if (texture.nextImage == VK_NULL_HANDLE || texture.moving ||
+            !isUploadComplete(*_streaming.uploads, texture.ticket))
+        {
+            continue;
+        }
+
+        const TextureHandle handle = registerTexture(*_streaming.table, texture.nextView);
+        if (!handle.isValid())
+        {
+            destroyImage(_streaming, texture.nextImage, texture.nextAllocation, texture.nextView);
+            streamer.onResident(id, streamer.getResidentMip(id));
+            continue;
+        }
+
+        if (texture.handle.isValid()) releaseTexture(*_streaming.table, texture.handle);
+        retire(_streaming, texture.image, texture.allocation, texture.view);
+
+        texture.handle = handle;
+        std::swap(texture.image, texture.nextImage);
+        std::swap(texture.allocation, texture.nextAllocation);
+        std::swap(texture.view, texture.nextView);
+        std::swap(texture.imageInfo, texture.nextImageInfo);
+
+        streamer.onResident(id, texture.nextMip);
+    }
+
+    // The mips the workers decoded: uploaded
+    std::vector<TextureStreaming::Decoded> decoded;
+    {
+        std::lock_guard lock(_streaming.mutex);
+        decoded.swap(_streaming.decoded);
+    }
+
+    for (TextureStreaming::Decoded& result : decoded)
+    {
+        TextureStreaming::Texture& texture = *_streaming.textures[result.texture];
+
+        try
+        {
+            if (result.mips)
+            {
+                uploadMips(_streaming, texture, *result.mips);
+                continue;
+            }
+        }
+        catch (const std::exception& _error)
+        {
+            MOSAIC_ERROR("Failed to upload texture {}: {}", texture.path.string(), _error.what());
+
+            // copies to it may have been recorded
+            retire(_streaming, texture.nextImage, texture.nextAllocation, texture.nextView);
+        }
+
+        // the mips resident stay
+        streamer.onResident(result.texture, streamer.getResidentMip(result.texture));
+    }
+
+    std::erase_if(_streaming.tasks,
+                  [](const exec::TaskFuture<void>& _task) { return _task.isReady(); });
+
+    for (const TextureResidencyChange& change : streamer.update()) decodeMips(_streaming, change);
+
+    // no frame in flight reads them any more
+    std::erase_if(_streaming.retired,
+                  [&](TextureStreaming::Retired& _retired)
+                  {
+                      if (_streaming.frame <= _retired.frame + retireFrames) return false;
+
+                      destroyImage(_streaming, _retired.image, _retired.allocation,
+                                   _retired.view);
+                      return true;
+                  });
+
+    ++_streaming.frame;
+}
+
+void defragmentTextureStreaming(TextureStreaming& _streaming, uint64_t _maxBytes)
+{
+    TextureStreaming::Defragmentation& defragmentation = _streaming.defragmentation;
+    if (_streaming.pool == VK_NULL_HANDLE || defragmentation.pass.moveCount > 0) return;
+
+    if (defragmentation.context == VK_NULL_HANDLE)
+    {
+        VmaDefragmentationInfo info = {};
+        info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        info.pool = _streaming.pool;
+        info.maxBytesPerPass = _maxBytes;
+        info.maxAllocationsPerPass = k_maxMovesPerPass;
+
+        if (vmaBeginDefragmentation(_streaming.allocator, &info, &defragmentation.context) !=
+            VK_SUCCESS)
+        {
+            return;
+        }
+    }
+
+    // VK_SUCCESS: nothing left to move
+    if (vmaBeginDefragmentationPass(_streaming.allocator, defragmentation.context,
+                                    &defragmentation.pass) == VK_SUCCESS)
+    {
+        vmaEndDefragmentation(_streaming.allocator, defragmentation.context, nullptr);
+        defragmentation.context = VK_NULL_HANDLE;
+        defragmentation.pass = {};
+        return;
+    }
+
+    for (uint32_t i = 0; i < defragmentation.pass.moveCount; ++i)
+    {
+        VmaDefragmentationMove& move = defragmentation.pass.pMoves[i];
+        move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+
+        // the resident images only: those uploading or retired are in use by the transfers or
+        // the frames in flight
+        const auto found = std::find_if(
+            _streaming.textures.begin(), _streaming.textures.end(),
+            [&](const std::unique_ptr<TextureStreaming::Texture>& _texture)
+            { return _texture->allocation == move.srcAllocation; });
+        if (found == _streaming.textures.end()) continue;
+
+        TextureStreaming::Texture& texture = **found;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        TextureHandle handle;
+        if (!createMovedImage(_streaming, texture, move.dstTmpAllocation, image, view, handle))
+        {
+            continue;
+        }
+
+        // the frames recorded from now on sample the new image
+        releaseTexture(*_streaming.table, texture.handle);
+
+        const auto id = static_cast<StreamedTextureId>(found - _streaming.textures.begin());
+        defragmentation.moved.push_back({id, texture.image, texture.view});
+
+        texture.image = image;
+        texture.view = view;
+        texture.handle = handle;
+        texture.moving = true;
+        move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+    }
+
+    // every move ignored: the next ones would be the same, a later call starts over
+    if (defragmentation.moved.empty())
+    {
+        endDefragmentationPass(_streaming);
+
+        if (defragmentation.context != VK_NULL_HANDLE)
+        {
+            vmaEndDefragmentation(_streaming.allocator, defragmentation.context, nullptr);
+            defragmentation.context = VK_NULL_HANDLE;
+        }
+
+        return;
+    }
+
+    recordMoveCopies(_streaming);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &_streaming.commandBuffer;
+
+    // the copies of the previous pass finished before it ended
+    vkResetFences(_streaming.device->device, 1, &_streaming.fence);
+
+    if (vkQueueSubmit(_streaming.device->graphicsQueue, 1, &submitInfo, _streaming.fence) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit texture defragmentation!");
+    }
+
+    defragmentation.frame = _streaming.frame;
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
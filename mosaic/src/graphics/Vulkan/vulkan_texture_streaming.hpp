@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/exec/task_future.hpp"
+#include "mosaic/graphics/texture_streaming.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+#include "vulkan_resource_table.hpp"
+#include "vulkan_upload_manager.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The textures read from image files and streamed by mip under a TextureStreamer: each is
+ * an image of its resident mips only, in the ResourceTable, replaced by an image of the finer (or
+ * coarser) mips the streamer plans for it.
+ *
+ * A change decodes the file and downsamples it to the new mips on an exec::ThreadPool worker
+ * (background priority), then the render system update that sees it done creates the image and
+ * uploads it through the UploadManager, and the one that sees the upload acquired swaps it in: a
+ * new TextureHandle, the former one released and its image destroyed once no frame reads it.
+ * The main thread never decodes, the frames never wait.
+ *
+ * A KTX2 file is streamed in its block compressed format, or transcoded to the best the device
+ * samples (formats) for Basis Universal; it stays compressed in memory, the budget going further.
+ *
+ * The budget is that of the settings, lowered by the MemoryManager to what the high watermark of
+ * the device local heaps leaves (VK_EXT_memory_budget when the device has it, else the estimate
+ * of VMA). No mip is larger than a staging chunk of the UploadManager: the finer ones are not
+ * streamed.
+ *
+ * The images live in a VMA pool of their own, which defragmentTextureStreaming() compacts a pass
+ * at a time: a moved texture is copied to a new image on the graphics queue, swapped in as an
+ * upload is, the former image destroyed and its memory freed once no frame reads it.
+ */
+struct TextureStreaming
+{
+    struct Texture
+    {
+        std::filesystem::path path;
+
+        VkImage image = VK_NULL_HANDLE; // of the resident mips
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkImageCreateInfo imageInfo = {}; // of image, created again by a defragmentation move
+        TextureHandle handle;
+
+        // The image of the change in flight, uploading
+        VkImage nextImage = VK_NULL_HANDLE;
+        VmaAllocation nextAllocation = VK_NULL_HANDLE;
+        VkImageView nextView = VK_NULL_HANDLE;
+        VkImageCreateInfo nextImageInfo = {};
+        uint32_t nextMip = 0;
+        UploadTicket ticket = 0;
+
+        bool moving = false; // by the defragmentation pass in flight, image swapped once it ends
+    };
+
+    // Of a change decoded by a worker
+    struct Decoded
+    {
+        StreamedTextureId texture;
+        std::optional<TextureMipChain> mips; // none if it failed
+    };
+
+    // What frames in flight may still read
+    struct Retired
+    {
+        VkImage image;
+        VmaAllocation allocation;
+        VkImageView view;
+        uint64_t frame;
+    };
+
+    // The images a defragmentation pass replaced, their memory moved to those of the textures
+    struct Moved
+    {
+        StreamedTextureId texture;
+        VkImage image;
+        VkImageView view;
+    };
+
+    // The incremental defragmentation of the pool, a pass at a time
+    struct Defragmentation
+    {
+        VmaDefragmentationContext context = VK_NULL_HANDLE;
+        VmaDefragmentationPassMoveInfo pass = {}; // in flight if it has moves
+        std::vector<Moved> moved;
+        uint64_t frame = 0; // of the copies
+    };
+
+    const Device* device;
+    VmaAllocator allocator;
+    UploadManager* uploads;
+    ResourceTable* table;
+
+    VmaPool pool; // of the images, none if no memory type suits: no defragmentation
+    CommandPool commandPool; // of the graphics queue, the copies of the moves
+    CommandBuffer commandBuffer;
+    VkFence fence; // of the copies
+    Defragmentation defragmentation;
+
+    TextureStreamer streamer;
+    std::vector<std::unique_ptr<Texture>> textures; // by StreamedTextureId
+    std::vector<TextureFormat> formats;             // the compressed ones the device samples
+
+    std::mutex mutex;
+    std::vector<Decoded> decoded; // not uploaded yet
+    std::vector<exec::TaskFuture<void>> tasks;
+
+    std::vector<Retired> retired;
+    uint64_t frame; // of the updates
+
+    TextureStreaming()
+        : device(nullptr),
+          allocator(VK_NULL_HANDLE),
+          uploads(nullptr),
+          table(nullptr),
+          pool(VK_NULL_HANDLE),
+          commandBuffer(VK_NULL_HANDLE),
+          fence(VK_NULL_HANDLE),
+          frame(0){};
+};
+
+void createTextureStreaming(TextureStreaming& _streaming, const Device& _device,
+                            VmaAllocator _allocator, UploadManager& _uploads,
+                            ResourceTable& _table, TextureStreamingSettings _settings = {});
+
+// Waits for the decoding in flight, after the device is idle.
+void destroyTextureStreaming(TextureStreaming& _streaming);
+
+/**
+ * @brief Reads the header of an image file, its mip tail loaded by the next update.
+ *
+ * @throws std::runtime_error if the file cannot be read or is not an image.
+ */
+StreamedTextureId loadStreamedTexture(TextureStreaming& _streaming,
+                                      const std::filesystem::path& _path);
+
+// Drawn this frame at _screenExtent pixels across its largest side.
+void requestStreamedTexture(TextureStreaming& _streaming, StreamedTextureId _texture,
+                            float _screenExtent);
+
+// The handle of the resident mips, invalid until the tail is. Changes with the residency.
+TextureHandle getStreamedTexture(const TextureStreaming& _streaming, StreamedTextureId _texture);
+
+// Once a render system update, after the contexts acquired the uploads of the frame.
+void updateTextureStreaming(TextureStreaming& _streaming);
+
+/**
+ * @brief Begins a defragmentation pass of the pool moving at most _maxBytes, on the graphics
+ * queue, if none is in flight (the updates end it once no frame reads the former images). A
+ * frame with time to spare calls it, after updateTextureStreaming().
+ *
+ * The textures uploading or retired are not moved, the others get new handles.
+ */
+void defragmentTextureStreaming(TextureStreaming& _streaming, uint64_t _maxBytes);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,186 @@
+#include "vulkan_ui_atlas.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+static void layoutBarrier(const UiAtlas& _atlas, CommandBuffer _commandBuffer,
+                          VkImageLayout _oldLayout, VkImageLayout _newLayout,
+                          VkAccessFlags _srcAccess, VkAccessFlags _dstAccess,
+                          VkPipelineStageFlags _srcStage, VkPipelineStageFlags _dstStage)
+{
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = _srcAccess;
+    barrier.dstAccessMask = _dstAccess;
+    barrier.oldLayout = _oldLayout;
+    barrier.newLayout = _newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _atlas.image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, _atlas.layers};
+
+    vkCmdPipelineBarrier(_commandBuffer, _srcStage, _dstStage, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+}
+
+void createUiAtlas(UiAtlas& _atlas, const Device& _device, VmaAllocator _allocator,
+                   ResourceTable& _table, const GlyphAtlasSettings& _settings)
+{
+    _atlas.device = &_device;
+    _atlas.allocator = _allocator;
+    _atlas.table = &_table;
+    _atlas.extent = _settings.extent;
+    _atlas.layers = _settings.layers;
+    _atlas.cleared = false;
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8_UNORM;
+    imageInfo.extent = {_atlas.extent, _atlas.extent, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = _atlas.layers;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    createDeviceImage(_allocator, imageInfo, _atlas.image, _atlas.allocation);
+    setObjectName(_device, VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(_atlas.image),
+                  "Glyph atlas");
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = _atlas.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    viewInfo.format = VK_FORMAT_R8_UNORM;
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, _atlas.layers};
+
+    if (vkCreateImageView(_device.device, &viewInfo, nullptr, &_atlas.view) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create glyph atlas image view!");
+    }
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(_device.device, &samplerInfo, nullptr, &_atlas.sampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create UI sampler!");
+    }
+
+    _atlas.handle = registerTexture(_table, _atlas.view);
+    _atlas.samplerHandle = registerSampler(_table, _atlas.sampler);
+}
+
+void destroyUiAtlas(UiAtlas& _atlas)
+{
+    if (_atlas.image == VK_NULL_HANDLE) return;
+
+    releaseTexture(*_atlas.table, _atlas.handle);
+    releaseSampler(*_atlas.table, _atlas.samplerHandle);
+    _atlas.handle = {};
+    _atlas.samplerHandle = {};
+
+    vkDestroySampler(_atlas.device->device, _atlas.sampler, nullptr);
+    vkDestroyImageView(_atlas.device->device, _atlas.view, nullptr);
+    destroyDeviceImage(_atlas.allocator, _atlas.image, _atlas.allocation);
+
+    _atlas.sampler = VK_NULL_HANDLE;
+    _atlas.view = VK_NULL_HANDLE;
+}
+
+bool recordUiAtlasUploads(UiAtlas& _atlas, CommandBuffer _commandBuffer,
+                          FrameRingBuffer& _ringBuffer, GlyphAtlas& _glyphs)
+{
+    const std::span<const GlyphUpload> uploads = _glyphs.getUploads();
+    if (uploads.empty() && _atlas.cleared) return true;
+
+    const std::span<const uint8_t> texels = _glyphs.getUploadData();
+    FrameAllocation staging;
+    if (!texels.empty())
+    {
+        staging = _ringBuffer.ring.allocate(texels.size(), 4);
+        if (!staging) return false;
+
+        std::memcpy(staging.data, texels.data(), texels.size());
+    }
+
+    if (_atlas.cleared)
+    {
+        // after the draws of the frames before, on the same queue
+        layoutBarrier(_atlas, _commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_SHADER_READ_BIT,
+                      VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT);
+    }
+    else
+    {
+        // the texels between the glyphs are sampled by their filtering
+        layoutBarrier(_atlas, _commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED,
+                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        const VkClearColorValue clear = {};
+        const VkImageSubresourceRange range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, _atlas.layers};
+        vkCmdClearColorImage(_commandBuffer, _atlas.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             &clear, 1, &range);
+
+        // the clear before the copies
+        layoutBarrier(_atlas, _commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT);
+        _atlas.cleared = true;
+    }
+
+    if (!uploads.empty())
+    {
+        std::vector<VkBufferImageCopy> regions(uploads.size());
+        for (size_t i = 0; i < uploads.size(); ++i)
+        {
+            const GlyphUpload& upload = uploads[i];
+
+            VkBufferImageCopy& region = regions[i];
+            region.bufferOffset = staging.offset + upload.offset;
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, upload.layer, 1};
+            region.imageOffset = {static_cast<int32_t>(upload.x), static_cast<int32_t>(upload.y),
+                                  0};
+            region.imageExtent = {upload.width, upload.height, 1};
+        }
+
+        vkCmdCopyBufferToImage(_commandBuffer, _ringBuffer.buffer, _atlas.image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+    }
+
+    layoutBarrier(_atlas, _commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    _glyphs.clearUploads();
+    return true;
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
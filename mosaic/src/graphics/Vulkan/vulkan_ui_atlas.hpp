@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vk_mem_alloc.h>
+
+#include "mosaic/graphics/glyph_atlas.hpp"
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+#include "vulkan_frame_ring.hpp"
+#include "vulkan_resource_table.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+/**
+ * @brief The device texture of a GlyphAtlas: an R8 array image of its layers, sampled by ui.frag
+ * through the ResourceTable (handle, UiBatcher::k_atlasResource) with a linear sampler, which the
+ * images a UiBatcher draws use too (samplerHandle, UiBatcher::k_samplerResource).
+ *
+ * The new glyphs are copied in the command buffer of the frame, from the frame ring: only their
+ * rectangles are written, the glyphs already drawn stay as they are.
+ */
+struct UiAtlas
+{
+    const Device* device;
+    VmaAllocator allocator;
+    ResourceTable* table;
+
+    VkImage image;
+    VmaAllocation allocation;
+    VkImageView view; // every layer, VK_IMAGE_VIEW_TYPE_2D_ARRAY
+    VkSampler sampler;
+
+    TextureHandle handle;
+    SamplerHandle samplerHandle;
+
+    uint32_t extent;
+    uint32_t layers;
+    bool cleared; // out of VK_IMAGE_LAYOUT_UNDEFINED, by the first recordUiAtlasUploads()
+
+    UiAtlas()
+        : device(nullptr),
+          allocator(VK_NULL_HANDLE),
+          table(nullptr),
+          image(VK_NULL_HANDLE),
+          allocation(VK_NULL_HANDLE),
+          view(VK_NULL_HANDLE),
+          sampler(VK_NULL_HANDLE),
+          extent(0),
+          layers(0),
+          cleared(false){};
+};
+
+// The extent and layers of _settings, those of the GlyphAtlas it holds.
+void createUiAtlas(UiAtlas& _atlas, const Device& _device, VmaAllocator _allocator,
+                   ResourceTable& _table, const GlyphAtlasSettings& _settings);
+
+void destroyUiAtlas(UiAtlas& _atlas);
+
+/**
+ * @brief Records the copies of the uploads of _glyphs, staged in _ringBuffer, outside a render
+ * pass and before the UI draws of the frame; the uploads are cleared. False if the ring is full:
+ * they are kept for the next frame. The first call clears the image, before any draw samples it.
+ */
+bool recordUiAtlasUploads(UiAtlas& _atlas, CommandBuffer _commandBuffer,
+                          FrameRingBuffer& _ringBuffer, GlyphAtlas& _glyphs);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,386 @@
+#include "vulkan_upload_manager.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "vulkan_allocator.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// Of the copies in a chunk: the texel size of every format, a multiple of 4 as images require
+static constexpr VkDeviceSize k_stagingAlignment = 16;
+
+// What the graphics queue reads the uploads with
+static constexpr VkPipelineStageFlags k_consumerStages =
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+static constexpr VkAccessFlags k_consumerAccess =
+    VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+    VK_ACCESS_SHADER_READ_BIT;
+
+static bool hasDedicatedQueue(const UploadManager& _manager)
+{
+    return _manager.device->transferFamily != _manager.device->graphicsFamily;
+}
+
+static UploadTicket getCompletedValue(const UploadManager& _manager)
+{
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(_manager.device->device, _manager.timeline, &value);
+
+    return value;
+}
+
+static void waitForValue(const UploadManager& _manager, UploadTicket _value)
+{
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &_manager.timeline;
+    waitInfo.pValues = &_value;
+
+    if (vkWaitSemaphores(_manager.device->device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to wait for the uploads!");
+    }
+}
+
+// Under the mutex. Once the chunk of the current batch is free again (a backpressure stall
+// only when every chunk is in flight).
+static UploadManager::Batch& beginBatch(UploadManager& _manager)
+{
+    UploadManager::Batch& batch = _manager.batches[_manager.currentBatch];
+    if (batch.recording) return batch;
+
+    waitForValue(_manager, batch.value);
+
+    vkResetCommandBuffer(batch.commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin recording upload command buffer!");
+    }
+
+    batch.stagingHead = 0;
+    batch.value = _manager.nextValue;
+    batch.recording = true;
+
+    return batch;
+}
+
+// Under the mutex
+static void submitBatch(UploadManager& _manager)
+{
+    UploadManager::Batch& batch = _manager.batches[_manager.currentBatch];
+    if (!batch.recording) return;
+
+    endCommandBuffer(batch.commandBuffer);
+
+    // the staging writes of the chunk, rounded to whole atoms by VMA
+    flushMappedBuffer(_manager.allocator, _manager.stagingAllocation, batch.stagingOffset,
+                      batch.stagingHead);
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &batch.value;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &_manager.timeline;
+
+    if (vkQueueSubmit(_manager.device->transferQueue, 1, &submitInfo, VK_NULL_HANDLE) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit upload command buffer!");
+    }
+
+    batch.recording = false;
+
+    ++_manager.nextValue;
+    _manager.currentBatch = (_manager.currentBatch + 1) % UploadManager::k_chunkCount;
+}
+
+// Under the mutex. _size bytes of the staging chunk of the batch recording, submitting it first
+// if full; the batch is returned with the offset.
+static std::pair<UploadManager::Batch*, VkDeviceSize> allocateStaging(UploadManager& _manager,
+                                                                      VkDeviceSize _size)
+{
+    UploadManager::Batch* batch = &beginBatch(_manager);
+
+    VkDeviceSize offset =
+        (batch->stagingHead + k_stagingAlignment - 1) / k_stagingAlignment * k_stagingAlignment;
+
+    if (offset + _size > _manager.chunkSize)
+    {
+        submitBatch(_manager);
+
+        batch = &beginBatch(_manager);
+        offset = 0;
+    }
+
+    batch->stagingHead = offset + _size;
+
+    return {batch, batch->stagingOffset + offset};
+}
+
+void createUploadManager(UploadManager& _manager, const Device& _device, VmaAllocator _allocator,
+                         VkDeviceSize _stagingSize)
+{
+    _manager.device = &_device;
+    _manager.allocator = _allocator;
+    _manager.chunkSize = _stagingSize / UploadManager::k_chunkCount / k_stagingAlignment *
+                         k_stagingAlignment;
+
+    void* mapped = nullptr;
+    createMappedBuffer(_allocator, _manager.chunkSize * UploadManager::k_chunkCount,
+                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT, _manager.staging,
+                       _manager.stagingAllocation, mapped);
+    _manager.stagingData = static_cast<std::byte*>(mapped);
+
+    createCommandPool(_manager.commandPool, _device, _device.transferFamily);
+
+    for (uint32_t i = 0; i < UploadManager::k_chunkCount; ++i)
+    {
+        createCommandBuffer(_manager.batches[i].commandBuffer, _device, _manager.commandPool);
+        _manager.batches[i].stagingOffset = i * _manager.chunkSize;
+    }
+
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    if (vkCreateSemaphore(_device.device, &semaphoreInfo, nullptr, &_manager.timeline) !=
+        VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upload timeline semaphore!");
+    }
+}
+
+void destroyUploadManager(UploadManager& _manager)
+{
+    std::lock_guard lock(_manager.mutex);
+
+    // a batch never submitted is only ended, nothing waits for it
+    UploadManager::Batch& current = _manager.batches[_manager.currentBatch];
+    if (current.recording) endCommandBuffer(current.commandBuffer);
+
+    waitForValue(_manager, _manager.nextValue - 1);
+
+    for (auto& batch : _manager.batches)
+    {
+        destroyCommandBuffer(batch.commandBuffer, *_manager.device, _manager.commandPool);
+    }
+
+    vkDestroySemaphore(_manager.device->device, _manager.timeline, nullptr);
+    destroyCommandPool(_manager.commandPool, *_manager.device);
+    destroyMappedBuffer(_manager.allocator, _manager.staging, _manager.stagingAllocation);
+
+    _manager.bufferAcquires.clear();
+    _manager.imageAcquires.clear();
+}
+
+UploadTicket uploadBuffer(UploadManager& _manager, VkBuffer _buffer, VkDeviceSize _offset,
+                          const void* _data, VkDeviceSize _size)
+{
+    std::lock_guard lock(_manager.mutex);
+
+    const auto* data = static_cast<const std::byte*>(_data);
+    UploadTicket ticket = 0;
+
+    for (VkDeviceSize copied = 0; copied < _size;)
+    {
+        const VkDeviceSize size = std::min(_size - copied, _manager.chunkSize);
+        auto [batch, stagingOffset] = allocateStaging(_manager, size);
+
+        std::memcpy(_manager.stagingData + stagingOffset, data + copied, size);
+
+        VkBufferCopy region = {};
+        region.srcOffset = stagingOffset;
+        region.dstOffset = _offset + copied;
+        region.size = size;
+        vkCmdCopyBuffer(batch->commandBuffer, _manager.staging, _buffer, 1, &region);
+
+        // the release half of the ownership transfer, the same barrier is the acquire
+        if (hasDedicatedQueue(_manager))
+        {
+            VkBufferMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.srcQueueFamilyIndex = _manager.device->transferFamily;
+            barrier.dstQueueFamilyIndex = _manager.device->graphicsFamily;
+            barrier.buffer = _buffer;
+            barrier.offset = region.dstOffset;
+            barrier.size = size;
+
+            vkCmdPipelineBarrier(batch->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier,
+                                 0, nullptr);
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = k_consumerAccess;
+            _manager.bufferAcquires.emplace_back(batch->value, barrier);
+        }
+
+        ticket = batch->value;
+        copied += size;
+    }
+
+    return ticket;
+}
+
+UploadTicket uploadImage(UploadManager& _manager, VkImage _image, VkExtent3D _extent,
+                         VkImageAspectFlags _aspect, const void* _data, VkDeviceSize _size,
+                         VkImageLayout _finalLayout, uint32_t _mipLevel)
+{
+    std::lock_guard lock(_manager.mutex);
+
+    if (_size > _manager.chunkSize)
+    {
+        throw std::runtime_error("image upload larger than a staging chunk!");
+    }
+
+    auto [batch, stagingOffset] = allocateStaging(_manager, _size);
+
+    std::memcpy(_manager.stagingData + stagingOffset, _data, _size);
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _image;
+    barrier.subresourceRange = {_aspect, _mipLevel, 1, 0, 1};
+
+    vkCmdPipelineBarrier(batch->commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = stagingOffset;
+    region.imageSubresource = {_aspect, _mipLevel, 0, 1};
+    region.imageExtent = _extent;
+    vkCmdCopyBufferToImage(batch->commandBuffer, _manager.staging, _image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    // To its final layout, in the release and acquire barriers alike with a dedicated queue
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = _finalLayout;
+
+    if (hasDedicatedQueue(_manager))
+    {
+        barrier.srcQueueFamilyIndex = _manager.device->transferFamily;
+        barrier.dstQueueFamilyIndex = _manager.device->graphicsFamily;
+    }
+
+    vkCmdPipelineBarrier(batch->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+
+    if (hasDedicatedQueue(_manager))
+    {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = k_consumerAccess;
+        _manager.imageAcquires.emplace_back(batch->value, barrier);
+    }
+
+    return batch->value;
+}
+
+void submitUploads(UploadManager& _manager)
+{
+    std::lock_guard lock(_manager.mutex);
+
+    submitBatch(_manager);
+}
+
+UploadTicket acquireUploads(UploadManager& _manager, CommandBuffer _commandBuffer)
+{
+    std::lock_guard lock(_manager.mutex);
+
+    const UploadTicket completed = getCompletedValue(_manager);
+    if (completed <= _manager.acquiredValue) return 0;
+
+    std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+
+    std::erase_if(_manager.bufferAcquires,
+                  [&](const auto& _acquire)
+                  {
+                      if (_acquire.first > completed) return false;
+
+                      bufferBarriers.push_back(_acquire.second);
+                      return true;
+                  });
+
+    std::erase_if(_manager.imageAcquires,
+                  [&](const auto& _acquire)
+                  {
+                      if (_acquire.first > completed) return false;
+
+                      imageBarriers.push_back(_acquire.second);
+                      return true;
+                  });
+
+    if (!bufferBarriers.empty() || !imageBarriers.empty())
+    {
+        vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, k_consumerStages, 0,
+                             0, nullptr, static_cast<uint32_t>(bufferBarriers.size()),
+                             bufferBarriers.data(), static_cast<uint32_t>(imageBarriers.size()),
+                             imageBarriers.data());
+    }
+
+    _manager.acquiredValue = completed;
+
+    return completed;
+}
+
+bool isUploadComplete(UploadManager& _manager, UploadTicket _ticket)
+{
+    std::lock_guard lock(_manager.mutex);
+
+    return _manager.acquiredValue >= _ticket;
+}
+
+void waitForUpload(UploadManager& _manager, UploadTicket _ticket)
+{
+    {
+        std::lock_guard lock(_manager.mutex);
+
+        // still recording, it would never signal
+        if (_ticket >= _manager.nextValue && _manager.batches[_manager.currentBatch].recording)
+        {
+            submitBatch(_manager);
+        }
+    }
+
+    waitForValue(_manager, _ticket);
+}
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <vk_mem_alloc.h>
+
+#include "vulkan_common.hpp"
+#include "context/vulkan_device.hpp"
+#include "commands/vulkan_command_pool.hpp"
+#include "commands/vulkan_command_buffer.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace vulkan
+{
+
+// The value of the upload timeline a copy completes at, compared to isUploadComplete()
+using UploadTicket = uint64_t;
+
+/**
+ * @brief Streams buffer and image data to the device on the transfer queue (a dedicated one when
+ * available), out of a pool of staging chunks, without stalling the graphics queue.
+ *
+ * The copies of a chunk are recorded into one command buffer, submitted as a batch by
+ * submitUploads() (or as soon as the chunk is full), that signals a timeline semaphore. With a
+ * dedicated queue family, the batches release the ownership of what they wrote, and the graphics
+ * queue acquires it in acquireUploads() once the batch completed: a frame never waits for a copy
+ * in flight.
+ *
+ * Without a dedicated transfer queue the batches are submitted to the graphics queue, the uploads
+ * then come from the thread submitting it.
+ */
+struct UploadManager
+{
+    static constexpr uint32_t k_chunkCount = 4;
+
+    struct Batch
+    {
+        CommandBuffer commandBuffer;
+        VkDeviceSize stagingOffset; // of its chunk
+        VkDeviceSize stagingHead;   // in its chunk
+        UploadTicket value;         // signaled once executed, its chunk free again
+        bool recording;
+
+        Batch()
+            : commandBuffer(VK_NULL_HANDLE),
+              stagingOffset(0),
+              stagingHead(0),
+              value(0),
+              recording(false){};
+    };
+
+    const Device* device;
+    VmaAllocator allocator;
+
+    VkBuffer staging;
+    VmaAllocation stagingAllocation;
+    std::byte* stagingData;
+    VkDeviceSize chunkSize;
+
+    CommandPool commandPool; // of the transfer queue family
+    VkSemaphore timeline;
+
+    std::array<Batch, k_chunkCount> batches;
+    uint32_t currentBatch;
+    UploadTicket nextValue;     // of the batch recording
+    UploadTicket acquiredValue; // the batches the graphics queue may use
+
+    // Recorded in the graphics queue once the batch signaled, for dedicated queue families only
+    std::vector<std::pair<UploadTicket, VkBufferMemoryBarrier>> bufferAcquires;
+    std::vector<std::pair<UploadTicket, VkImageMemoryBarrier>> imageAcquires;
+
+    std::mutex mutex;
+
+    UploadManager()
+        : device(nullptr),
+          allocator(VK_NULL_HANDLE),
+          staging(VK_NULL_HANDLE),
+          stagingAllocation(VK_NULL_HANDLE),
+          stagingData(nullptr),
+          chunkSize(0),
+          timeline(VK_NULL_HANDLE),
+          currentBatch(0),
+          nextValue(1),
+          acquiredValue(0){};
+};
+
+// _stagingSize is split in UploadManager::k_chunkCount chunks, each the largest image uploadable.
+void createUploadManager(UploadManager& _manager, const Device& _device, VmaAllocator _allocator,
+                         VkDeviceSize _stagingSize);
+
+// Waits for the batches in flight.
+void destroyUploadManager(UploadManager& _manager);
+
+// Buffers larger than a chunk are copied in several batches, the ticket is that of the last.
+UploadTicket uploadBuffer(UploadManager& _manager, VkBuffer _buffer, VkDeviceSize _offset,
+                          const void* _data, VkDeviceSize _size);
+
+// A mip of the first layer of _image (_extent is that of the mip), tightly packed texels, left
+// in _finalLayout.
+UploadTicket uploadImage(UploadManager& _manager, VkImage _image, VkExtent3D _extent,
+                         VkImageAspectFlags _aspect, const void* _data, VkDeviceSize _size,
+                         VkImageLayout _finalLayout, uint32_t _mipLevel = 0);
+
+// Submits the batch being recorded, if any: once a frame.
+void submitUploads(UploadManager& _manager);
+
+/**
+ * @brief Records the ownership acquires of the completed batches in a command buffer of the
+ * graphics queue, and returns the timeline value its submission waits for (0 if none): already
+ * signaled, it makes the copies visible without a stall.
+ */
+UploadTicket acquireUploads(UploadManager& _manager, CommandBuffer _commandBuffer);
+
+// The copy can be used by the command buffers recorded after the acquireUploads() that saw it.
+bool isUploadComplete(UploadManager& _manager, UploadTicket _ticket);
+
+// On the CPU, e.g. the resources a level needs before the first frame.
+void waitForUpload(UploadManager& _manager, UploadTicket _ticket);
+
+} // namespace vulkan
+} // namespace graphics
+} // namespace mosaic
@@ -1,5 +1,8 @@
 #include "webgpu_device.hpp"
 
+#include <memory>
+#include <utility>
+
 namespace mosaic
 {
 namespace graphics
@@ -7,38 +10,15 @@ namespace graphics
 namespace webgpu
 {
 
-WGPUAdapter requestAdapter(WGPUInstance _instance, WGPUSurface _surface)
+// Requests the adapter; the callback runs once the request ends, from the call itself on native
+// and once the main loop has yielded to the browser on the web
+static void startAdapterRequest(WGPUInstance _instance, WGPUSurface _surface,
+                                WGPURequestAdapterCallback _callback, void* _userData)
 {
-    struct UserData
-    {
-        WGPUAdapter adapter = nullptr;
-        bool requestEnded = false;
-    };
-
-    UserData userData;
-
-    WGPURequestAdapterCallback onAdapterRequestEnded =
-        [](WGPURequestAdapterStatus _status, WGPUAdapter _adapter, WGPUStringView _message,
-           void* _userData1, [[maybe_unused]] void* _userData2)
-    {
-        UserData& userData = *reinterpret_cast<UserData*>(_userData1);
-
-        if (_status == WGPURequestAdapterStatus_Success)
-        {
-            userData.adapter = _adapter;
-        }
-        else
-        {
-            MOSAIC_ERROR("Could not request WebGPU adapter: {}", _message.data);
-        }
-
-        userData.requestEnded = true;
-    };
-
     WGPURequestAdapterCallbackInfo callbackInfo = {
         .mode = WGPUCallbackMode::WGPUCallbackMode_AllowSpontaneous,
-        .callback = onAdapterRequestEnded,
-        .userdata1 = (void*)&userData,
+        .callback = _callback,
+        .userdata1 = _userData,
     };
 
     WGPURequestAdapterOptions adapterOpts = {};
@@ -46,18 +26,6 @@ WGPUAdapter requestAdapter(WGPUInstance _instance, WGPUSurface _surface)
     adapterOpts.compatibleSurface = _surface;
 
     wgpuInstanceRequestAdapter(_instance, &adapterOpts, callbackInfo);
-
-#ifdef __EMSCRIPTEN__
-    while (!userData.requestEnded)
-    {
-        emscripten_sleep(100);
-    }
-#endif
-
-    assert(userData.requestEnded);
-    assert(userData.adapter);
-
-    return userData.adapter;
 }
 
 bool isAdapterSuitable(WGPUAdapter _adapter)
@@ -102,34 +70,10 @@ bool isAdapterSuitable(WGPUAdapter _adapter)
     return true;
 }
 
-WGPUDevice createDevice(WGPUAdapter _adapter)
+// Requests the device, described with the error callbacks of the engine
+static void startDeviceRequest(WGPUAdapter _adapter, bool _validation,
+                               WGPURequestDeviceCallback _callback, void* _userData)
 {
-    struct UserData
-    {
-        WGPUDevice device = nullptr;
-        bool requestEnded = false;
-    };
-
-    UserData userData;
-
-    WGPURequestDeviceCallback onDeviceRequestEnded = [](WGPURequestDeviceStatus _status,
-                                                        WGPUDevice _device, WGPUStringView _message,
-                                                        void* _userData1, void* _userData2)
-    {
-        UserData& userData1 = *reinterpret_cast<UserData*>(_userData1);
-
-        if (_status == WGPURequestDeviceStatus_Success)
-        {
-            userData1.device = _device;
-        }
-        else
-        {
-            MOSAIC_ERROR("Could not request WebGPU device: {}", _message.data);
-        }
-
-        userData1.requestEnded = true;
-    };
-
     WGPUDeviceLostCallback onDeviceLost = [](const WGPUDevice* _device,
                                              WGPUDeviceLostReason _reason, WGPUStringView _message,
                                              void* _userData1, void* _userData2)
@@ -170,28 +114,125 @@ WGPUDevice createDevice(WGPUAdapter _adapter)
 
     WGPURequestDeviceCallbackInfo callbackInfo = {
         .mode = WGPUCallbackMode::WGPUCallbackMode_AllowSpontaneous,
-        .callback = onDeviceRequestEnded,
-        .userdata1 = (void*)&userData,
+        .callback = _callback,
+        .userdata1 = _userData,
         .userdata2 = nullptr,
     };
 
     WGPUDeviceDescriptor deviceDesc = {};
     deviceDesc.nextInChain = nullptr;
+
+#ifdef WEBGPU_BACKEND_DAWN
+    WGPUDawnTogglesDescriptor toggles;
+    toggles.chain.next = nullptr;
+    toggles.chain.sType = WGPUSType_DawnTogglesDescriptor;
+    toggles.disabledToggleCount = 0;
+    toggles.enabledToggleCount = 1;
+    const char* toggleName = "skip_validation";
+    toggles.enabledToggles = &toggleName;
+
+    if (!_validation) deviceDesc.nextInChain = &toggles.chain;
+#else
+    (void)_validation;
+#endif
     deviceDesc.deviceLostCallbackInfo = onDeviceLostCallbackInfo;
     deviceDesc.uncapturedErrorCallbackInfo = uncapturedErrorCallbackInfo;
 
     wgpuAdapterRequestDevice(_adapter, &deviceDesc, callbackInfo);
+}
+
+// The promise of the future of requestDevice(), freed by the last callback
+struct DeviceRequest
+{
+    exec::TaskPromise<DeviceAcquisition> promise;
+    DeviceAcquisition acquisition;
+    bool validation = false;
+};
+
+static void completeDeviceRequest(DeviceRequest* _request)
+{
+    _request->promise.setValue(std::exchange(_request->acquisition, {}));
+    delete _request;
+}
+
+static void onDeviceRequestEnded(WGPURequestDeviceStatus _status, WGPUDevice _device,
+                                 WGPUStringView _message, void* _userData1,
+                                 [[maybe_unused]] void* _userData2)
+{
+    auto* request = reinterpret_cast<DeviceRequest*>(_userData1);
 
-#ifdef __EMSCRIPTEN__
-    while (!userData.requestEnded)
+    if (_status == WGPURequestDeviceStatus_Success)
     {
-        emscripten_sleep(100);
+        request->acquisition.device = _device;
     }
-#endif
+    else
+    {
+        MOSAIC_ERROR("Could not request WebGPU device: {}", _message.data);
+    }
+
+    completeDeviceRequest(request);
+}
+
+static void onAdapterRequestEnded(WGPURequestAdapterStatus _status, WGPUAdapter _adapter,
+                                  WGPUStringView _message, void* _userData1,
+                                  [[maybe_unused]] void* _userData2)
+{
+    auto* request = reinterpret_cast<DeviceRequest*>(_userData1);
 
-    assert(userData.requestEnded);
+    if (_status == WGPURequestAdapterStatus_Success)
+    {
+        request->acquisition.adapter = _adapter;
+    }
+    else
+    {
+        MOSAIC_ERROR("Could not request WebGPU adapter: {}", _message.data);
+    }
+
+    if (!request->acquisition.adapter || !isAdapterSuitable(request->acquisition.adapter))
+    {
+        completeDeviceRequest(request);
+        return;
+    }
+
+    startDeviceRequest(request->acquisition.adapter, request->validation, &onDeviceRequestEnded,
+                       request);
+}
+
+exec::TaskFuture<DeviceAcquisition> requestDevice(WGPUInstance _instance, WGPUSurface _surface,
+                                                  bool _validation)
+{
+    auto* request = new DeviceRequest();
+    request->validation = _validation;
+
+    exec::TaskFuture<DeviceAcquisition> future = request->promise.getFuture();
+
+    // may complete (and free) the request before returning
+    startAdapterRequest(_instance, _surface, &onAdapterRequestEnded, request);
+
+    return future;
+}
+
+void releaseDeviceAcquisition(DeviceAcquisition& _acquisition)
+{
+    if (_acquisition.device) wgpuDeviceRelease(std::exchange(_acquisition.device, nullptr));
+    if (_acquisition.adapter) wgpuAdapterRelease(std::exchange(_acquisition.adapter, nullptr));
+}
+
+void abandonDeviceRequest(exec::TaskFuture<DeviceAcquisition> _future)
+{
+    if (!_future.isValid()) return;
+
+    // the continuation keeps the future alive until it ran (moved out of the state to run), at
+    // once if the future is already complete
+    auto pending = std::make_shared<exec::TaskFuture<DeviceAcquisition>>(std::move(_future));
+    pending->onReady(
+        [pending]()
+        {
+            if (pending->getStatus() != exec::FutureStatus::ready) return;
 
-    return userData.device;
+            DeviceAcquisition acquisition = pending->get();
+            releaseDeviceAcquisition(acquisition);
+        });
 }
 
 } // namespace webgpu
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "mosaic/exec/task_future.hpp"
+
 #include "webgpu_common.hpp"
 
 namespace mosaic
@@ -9,11 +11,33 @@ namespace graphics
 namespace webgpu
 {
 
-WGPUAdapter requestAdapter(WGPUInstance _instance, WGPUSurface _surface);
-
 bool isAdapterSuitable(WGPUAdapter _adapter);
 
-WGPUDevice createDevice(WGPUAdapter _adapter);
+/**
+ * @brief The adapter and the device of a context, null if a request failed (reported by the
+ * callbacks). Released by whoever takes them from the future.
+ */
+struct DeviceAcquisition
+{
+    WGPUAdapter adapter = nullptr;
+    WGPUDevice device = nullptr;
+};
+
+/**
+ * @brief Requests the adapter, then the device, without blocking: the future is completed by the
+ * last callback. On the web they run once the main loop has returned to the browser (nothing may
+ * wait for them there); natively, in the requests themselves or in wgpuInstanceProcessEvents().
+ *
+ * A future dropped before the callbacks ran must go through abandonDeviceRequest(), which
+ * releases what arrives.
+ */
+exec::TaskFuture<DeviceAcquisition> requestDevice(WGPUInstance _instance, WGPUSurface _surface,
+                                                  bool _validation);
+
+void releaseDeviceAcquisition(DeviceAcquisition& _acquisition);
+
+// Takes the future; what it completes with, now or later, is released
+void abandonDeviceRequest(exec::TaskFuture<DeviceAcquisition> _future);
 
 } // namespace webgpu
 } // namespace graphics
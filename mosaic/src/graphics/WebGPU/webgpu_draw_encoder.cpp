@@ -0,0 +1,184 @@
+#include "webgpu_draw_encoder.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+// The commands of a render pass and of a render bundle encoder are the same, by other names
+
+static void setPipeline(WGPURenderPassEncoder _encoder, WGPURenderPipeline _pipeline)
+{
+    wgpuRenderPassEncoderSetPipeline(_encoder, _pipeline);
+}
+
+static void setPipeline(WGPURenderBundleEncoder _encoder, WGPURenderPipeline _pipeline)
+{
+    wgpuRenderBundleEncoderSetPipeline(_encoder, _pipeline);
+}
+
+static void setBindGroup(WGPURenderPassEncoder _encoder, WGPUBindGroup _group)
+{
+    wgpuRenderPassEncoderSetBindGroup(_encoder, 0, _group, 0, nullptr);
+}
+
+static void setBindGroup(WGPURenderBundleEncoder _encoder, WGPUBindGroup _group)
+{
+    wgpuRenderBundleEncoderSetBindGroup(_encoder, 0, _group, 0, nullptr);
+}
+
+static void setVertexBuffer(WGPURenderPassEncoder _encoder, uint32_t _slot,
+                            const ResourceTable::BufferRange& _range)
+{
+    wgpuRenderPassEncoderSetVertexBuffer(_encoder, _slot, _range.buffer, _range.offset,
+                                         _range.size);
+}
+
+static void setVertexBuffer(WGPURenderBundleEncoder _encoder, uint32_t _slot,
+                            const ResourceTable::BufferRange& _range)
+{
+    wgpuRenderBundleEncoderSetVertexBuffer(_encoder, _slot, _range.buffer, _range.offset,
+                                           _range.size);
+}
+
+static void setIndexBuffer(WGPURenderPassEncoder _encoder,
+                           const ResourceTable::BufferRange& _range)
+{
+    wgpuRenderPassEncoderSetIndexBuffer(_encoder, _range.buffer, WGPUIndexFormat_Uint32,
+                                        _range.offset, _range.size);
+}
+
+static void setIndexBuffer(WGPURenderBundleEncoder _encoder,
+                           const ResourceTable::BufferRange& _range)
+{
+    wgpuRenderBundleEncoderSetIndexBuffer(_encoder, _range.buffer, WGPUIndexFormat_Uint32,
+                                          _range.offset, _range.size);
+}
+
+static void draw(WGPURenderPassEncoder _encoder, const DrawCall& _call)
+{
+    wgpuRenderPassEncoderDraw(_encoder, _call.vertexCount, _call.instanceCount,
+                              _call.firstVertex, _call.firstInstance);
+}
+
+static void draw(WGPURenderBundleEncoder _encoder, const DrawCall& _call)
+{
+    wgpuRenderBundleEncoderDraw(_encoder, _call.vertexCount, _call.instanceCount,
+                                _call.firstVertex, _call.firstInstance);
+}
+
+static void drawIndexed(WGPURenderPassEncoder _encoder, const DrawCall& _call)
+{
+    wgpuRenderPassEncoderDrawIndexed(_encoder, _call.indexCount, _call.instanceCount,
+                                     _call.firstIndex, static_cast<int32_t>(_call.vertexOffset),
+                                     _call.firstInstance);
+}
+
+static void drawIndexed(WGPURenderBundleEncoder _encoder, const DrawCall& _call)
+{
+    wgpuRenderBundleEncoderDrawIndexed(_encoder, _call.indexCount, _call.instanceCount,
+                                       _call.firstIndex, static_cast<int32_t>(_call.vertexOffset),
+                                       _call.firstInstance);
+}
+
+static void drawIndirect(WGPURenderPassEncoder _encoder,
+                         const ResourceTable::BufferRange& _range)
+{
+    wgpuRenderPassEncoderDrawIndirect(_encoder, _range.buffer, _range.offset);
+}
+
+static void drawIndirect(WGPURenderBundleEncoder _encoder,
+                         const ResourceTable::BufferRange& _range)
+{
+    wgpuRenderBundleEncoderDrawIndirect(_encoder, _range.buffer, _range.offset);
+}
+
+template <typename PassEncoder>
+void DrawEncoder<PassEncoder>::bindPipeline(ResourceHandle _pipeline)
+{
+    if (checks && (_pipeline >= pipelines.size() || !pipelines[_pipeline]))
+    {
+        MOSAIC_ERROR("Draw queue: no pipeline {}, its draws are skipped!", _pipeline);
+        boundPipeline = nullptr;
+        return;
+    }
+
+    boundPipeline = pipelines[_pipeline];
+    setPipeline(encoder, boundPipeline->pipeline);
+}
+
+template <typename PassEncoder>
+void DrawEncoder<PassEncoder>::bindVertexBuffer(uint32_t _slot, ResourceHandle _buffer)
+{
+    if (const auto* range = resourceTable->buffers.get(BufferHandle{_buffer}))
+    {
+        setVertexBuffer(encoder, _slot, *range);
+    }
+}
+
+template <typename PassEncoder>
+void DrawEncoder<PassEncoder>::bindIndexBuffer(ResourceHandle _buffer)
+{
+    if (const auto* range = resourceTable->buffers.get(BufferHandle{_buffer}))
+    {
+        setIndexBuffer(encoder, *range);
+    }
+}
+
+template <typename PassEncoder>
+void DrawEncoder<PassEncoder>::draw(const DrawCall& _call)
+{
+    if (checks && !boundPipeline) return;
+
+    const WGPUBindGroupLayout layout = boundPipeline->resourceLayout;
+
+    if (layout && (layout != boundLayout || boundResources != _call.resources))
+    {
+        std::array<ResourceBinding, DrawCall::k_maxResources> bindings;
+        for (uint32_t i = 0; i < boundPipeline->resourceCount; ++i)
+        {
+            bindings[i] = {i, boundPipeline->resourceTypes[i], _call.resources[i]};
+        }
+
+        // an invalid handle: the draw would read a resource that is gone
+        WGPUBindGroup group = acquireBindGroup(
+            *resourceTable, layout,
+            std::span<const ResourceBinding>(bindings.data(), boundPipeline->resourceCount));
+        if (!group) return;
+
+        setBindGroup(encoder, group);
+        boundLayout = layout;
+        boundResources = _call.resources;
+    }
+
+    switch (_call.type)
+    {
+        case DrawCallType::NonIndexed:
+        case DrawCallType::Instanced:
+            webgpu::draw(encoder, _call);
+            break;
+        case DrawCallType::Indexed:
+        case DrawCallType::IndexedInstanced:
+            drawIndexed(encoder, _call);
+            break;
+        case DrawCallType::Indirect:
+            if (const auto* range = resourceTable->buffers.get(BufferHandle{_call.indirectBuffer}))
+            {
+                drawIndirect(encoder, *range);
+            }
+            break;
+        case DrawCallType::IndexedIndirectCount:
+            // No indirect count in WebGPU: the objects are culled on the CPU instead
+            MOSAIC_ERROR("WebGPU has no indirect count draws, the draw is skipped!");
+            break;
+    }
+}
+
+template struct DrawEncoder<WGPURenderPassEncoder>;
+template struct DrawEncoder<WGPURenderBundleEncoder>;
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
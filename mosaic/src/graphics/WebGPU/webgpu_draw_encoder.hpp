@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "mosaic/graphics/draw_queue.hpp"
+
+#include "webgpu_common.hpp"
+#include "webgpu_resource_table.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+/**
+ * @brief A render pipeline the draws bind by ResourceHandle, with the layout of its bind group 0:
+ * DrawCall::resources[i] at binding i, a resource of resourceTypes[i].
+ */
+struct DrawPipeline
+{
+    WGPURenderPipeline pipeline = nullptr;
+    WGPUBindGroupLayout resourceLayout = nullptr; // null when the shaders read no resources
+    std::array<ResourceType, DrawCall::k_maxResources> resourceTypes = {};
+    uint32_t resourceCount = 0;
+};
+
+/**
+ * @brief Records the draws of a DrawQueue (a DrawCommandEncoder) on a render pass, or on a render
+ * bundle encoder for the draws replayed from frame to frame (see RenderBundleCache). The
+ * ResourceHandles index the pipelines of the frame, the buffers resolve through the
+ * ResourceTable.
+ *
+ * WebGPU has no push constants: DrawCall::resources select the cached bind group 0 of the
+ * pipeline (acquireBindGroup()), set again only when they or the layout change.
+ *
+ * With checks (RenderProfile::checks) a pipeline handle out of the pipelines skips the draws
+ * until another is bound; the buffers are looked up in the table either way.
+ */
+template <typename PassEncoder>
+struct DrawEncoder
+{
+    PassEncoder encoder = nullptr;
+    std::span<const DrawPipeline* const> pipelines;
+    ResourceTable* resourceTable = nullptr;
+
+    const DrawPipeline* boundPipeline = nullptr;
+    WGPUBindGroupLayout boundLayout = nullptr;
+    std::array<uint32_t, DrawCall::k_maxResources> boundResources = {};
+    bool checks = false;
+
+    void bindPipeline(ResourceHandle _pipeline);
+    void bindVertexBuffer(uint32_t _slot, ResourceHandle _buffer);
+    void bindIndexBuffer(ResourceHandle _buffer);
+    void draw(const DrawCall& _call);
+};
+
+using PassDrawEncoder = DrawEncoder<WGPURenderPassEncoder>;
+using BundleDrawEncoder = DrawEncoder<WGPURenderBundleEncoder>;
+
+static_assert(DrawCommandEncoder<PassDrawEncoder>);
+static_assert(DrawCommandEncoder<BundleDrawEncoder>);
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
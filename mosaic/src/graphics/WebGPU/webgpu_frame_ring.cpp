@@ -0,0 +1,74 @@
+#include "webgpu_frame_ring.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+// The default minUniformBufferOffsetAlignment and minStorageBufferOffsetAlignment limits
+static constexpr uint64_t k_offsetAlignment = 256;
+
+// wgpuQueueWriteBuffer() writes whole words
+static constexpr uint64_t k_writeAlignment = 4;
+
+void createFrameRingBuffer(FrameRingBuffer& _ringBuffer, WGPUDevice _device, ResourceTable& _table,
+                           uint64_t _size)
+{
+    const uint64_t size = (_size + k_offsetAlignment - 1) / k_offsetAlignment * k_offsetAlignment;
+
+    WGPUBufferDescriptor bufferDesc = {};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.label = WGPUStringView("Frame ring", 10);
+    bufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_Storage |
+                       WGPUBufferUsage_Vertex | WGPUBufferUsage_Index | WGPUBufferUsage_CopyDst;
+    bufferDesc.size = size;
+    bufferDesc.mappedAtCreation = false;
+
+    _ringBuffer.buffer = wgpuDeviceCreateBuffer(_device, &bufferDesc);
+
+    // the allocations of the frames then fail
+    if (!_ringBuffer.buffer)
+    {
+        MOSAIC_ERROR("Failed to create WebGPU frame ring buffer!");
+        return;
+    }
+
+    _ringBuffer.handle = registerBuffer(_table, _ringBuffer.buffer);
+    _ringBuffer.staging.resize(size);
+    _ringBuffer.ring.reset(_ringBuffer.staging.data(), size, 1);
+}
+
+void destroyFrameRingBuffer(FrameRingBuffer& _ringBuffer, ResourceTable& _table)
+{
+    _ringBuffer.ring.reset(nullptr, 0, 0);
+    _ringBuffer.staging = {};
+
+    if (_ringBuffer.buffer)
+    {
+        releaseBuffer(_table, _ringBuffer.handle);
+        _ringBuffer.handle = {};
+
+        wgpuBufferDestroy(_ringBuffer.buffer);
+        wgpuBufferRelease(_ringBuffer.buffer);
+        _ringBuffer.buffer = nullptr;
+    }
+}
+
+void beginFrameRingBuffer(FrameRingBuffer& _ringBuffer) { _ringBuffer.ring.beginFrame(0); }
+
+void flushFrameRingBuffer(FrameRingBuffer& _ringBuffer, WGPUQueue _queue)
+{
+    const uint64_t used = _ringBuffer.ring.getUsed();
+    if (used == 0) return;
+
+    // within the buffer, its size a multiple of the offset alignment
+    const uint64_t size = (used + k_writeAlignment - 1) / k_writeAlignment * k_writeAlignment;
+
+    wgpuQueueWriteBuffer(_queue, _ringBuffer.buffer, 0, _ringBuffer.staging.data(), size);
+}
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mosaic/graphics/frame_ring.hpp"
+
+#include "webgpu_common.hpp"
+#include "webgpu_resource_table.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+/**
+ * @brief The FrameRing of a context: allocated in CPU memory, uploaded with one
+ * wgpuQueueWriteBuffer() per frame to the buffer the draws bind at the offsets of their
+ * allocations.
+ *
+ * The queue copies the data when written, ordered before the next submissions: one region is
+ * enough, reused every frame. The buffer is in the ResourceTable too, for the shaders that index
+ * it (the instances of InstanceBatcher).
+ */
+struct FrameRingBuffer
+{
+    WGPUBuffer buffer;
+    std::vector<std::byte> staging;
+    BufferHandle handle;
+    FrameRing ring;
+
+    FrameRingBuffer() : buffer(nullptr){};
+};
+
+void createFrameRingBuffer(FrameRingBuffer& _ringBuffer, WGPUDevice _device, ResourceTable& _table,
+                           uint64_t _size);
+
+void destroyFrameRingBuffer(FrameRingBuffer& _ringBuffer, ResourceTable& _table);
+
+void beginFrameRingBuffer(FrameRingBuffer& _ringBuffer);
+
+// Writes what the frame allocated, before its submission.
+void flushFrameRingBuffer(FrameRingBuffer& _ringBuffer, WGPUQueue _queue);
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,140 @@
+#include "webgpu_render_bundle.hpp"
+
+#include <iterator>
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+static WGPURenderBundle encodeRenderBundle(const RenderBundleCache& _cache,
+                                           const DrawQueue& _draws,
+                                           std::span<const DrawPipeline* const> _pipelines,
+                                           ResourceTable& _table)
+{
+    WGPURenderBundleEncoderDescriptor encoderDesc = {};
+    encoderDesc.nextInChain = nullptr;
+    encoderDesc.label = WGPUStringView("Render bundle encoder", 21);
+    encoderDesc.colorFormatCount = 1;
+    encoderDesc.colorFormats = &_cache.colorFormat;
+    encoderDesc.depthStencilFormat = WGPUTextureFormat_Undefined;
+    encoderDesc.sampleCount = 1;
+    encoderDesc.depthReadOnly = false;
+    encoderDesc.stencilReadOnly = false;
+
+    WGPURenderBundleEncoder bundleEncoder =
+        wgpuDeviceCreateRenderBundleEncoder(_cache.device, &encoderDesc);
+
+    if (!bundleEncoder)
+    {
+        MOSAIC_ERROR("Failed to create WebGPU render bundle encoder!");
+        return nullptr;
+    }
+
+    BundleDrawEncoder encoder;
+    encoder.encoder = bundleEncoder;
+    encoder.pipelines = _pipelines;
+    encoder.resourceTable = &_table;
+    encoder.checks = _cache.checks;
+    _draws.record(encoder);
+
+    WGPURenderBundleDescriptor bundleDesc = {};
+    bundleDesc.nextInChain = nullptr;
+    bundleDesc.label = WGPUStringView("Render bundle", 13);
+
+    WGPURenderBundle bundle = wgpuRenderBundleEncoderFinish(bundleEncoder, &bundleDesc);
+    wgpuRenderBundleEncoderRelease(bundleEncoder);
+
+    return bundle;
+}
+
+void createRenderBundleCache(RenderBundleCache& _cache, WGPUDevice _device, bool _checks)
+{
+    _cache.device = _device;
+    _cache.frame = 0;
+    _cache.encodedCount = 0;
+    _cache.checks = _checks;
+}
+
+void destroyRenderBundleCache(RenderBundleCache& _cache)
+{
+    invalidateRenderBundles(_cache);
+    _cache.device = nullptr;
+}
+
+void invalidateRenderBundles(RenderBundleCache& _cache)
+{
+    for (auto& [id, bundle] : _cache.bundles)
+    {
+        if (bundle.bundle) wgpuRenderBundleRelease(bundle.bundle);
+    }
+
+    _cache.bundles.clear();
+}
+
+void setRenderBundleFormat(RenderBundleCache& _cache, WGPUTextureFormat _colorFormat)
+{
+    if (_cache.colorFormat == _colorFormat) return;
+
+    invalidateRenderBundles(_cache);
+    _cache.colorFormat = _colorFormat;
+}
+
+WGPURenderBundle acquireRenderBundle(RenderBundleCache& _cache, uint64_t _id,
+                                     const DrawQueue& _draws,
+                                     std::span<const DrawPipeline* const> _pipelines,
+                                     ResourceTable& _table)
+{
+    if (_draws.empty()) return nullptr;
+
+    const uint64_t hash = _draws.getHash();
+
+    auto it = _cache.bundles.find(_id);
+    if (it != _cache.bundles.end() && it->second.hash == hash)
+    {
+        it->second.lastFrame = _cache.frame;
+        return it->second.bundle;
+    }
+
+    WGPURenderBundle bundle = encodeRenderBundle(_cache, _draws, _pipelines, _table);
+    if (!bundle) return nullptr;
+
+    ++_cache.encodedCount;
+
+    if (it != _cache.bundles.end())
+    {
+        // the passes that executed the previous one hold a reference until they complete
+        if (it->second.bundle) wgpuRenderBundleRelease(it->second.bundle);
+        it->second = {bundle, hash, _cache.frame};
+    }
+    else
+    {
+        _cache.bundles.emplace(_id, RenderBundleCache::Bundle{bundle, hash, _cache.frame});
+    }
+
+    return bundle;
+}
+
+void advanceRenderBundleCache(RenderBundleCache& _cache)
+{
+    for (auto it = _cache.bundles.begin(); it != _cache.bundles.end();)
+    {
+        if (_cache.frame - it->second.lastFrame > RenderBundleCache::k_maxIdleFrames)
+        {
+            if (it->second.bundle) wgpuRenderBundleRelease(it->second.bundle);
+            it = _cache.bundles.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    ++_cache.frame;
+}
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
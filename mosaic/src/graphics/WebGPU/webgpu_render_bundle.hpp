@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+
+#include "mosaic/graphics/draw_queue.hpp"
+
+#include "webgpu_common.hpp"
+#include "webgpu_draw_encoder.hpp"
+#include "webgpu_resource_table.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+/**
+ * @brief The render bundles of the draw sets of a context that rarely change, such as the static
+ * geometry: a set is encoded once into a bundle, then replayed each frame by one
+ * wgpuRenderPassEncoderExecuteBundles() instead of several calls per draw, each of which crosses
+ * from WASM to JavaScript on the web.
+ *
+ * A bundle is keyed by the id of its set and keeps the DrawQueue::getHash() of the draws it was
+ * encoded from, to encode it again once they change. Setting other pass formats invalidates them
+ * all, as must new pipelines (invalidateRenderBundles()), and the sets not replayed for
+ * k_maxIdleFrames frames are released.
+ */
+struct RenderBundleCache
+{
+    static constexpr uint64_t k_maxIdleFrames = 120;
+
+    struct Bundle
+    {
+        WGPURenderBundle bundle;
+        uint64_t hash;      // of the draws encoded
+        uint64_t lastFrame; // the bundle was acquired
+    };
+
+    WGPUDevice device;
+    WGPUTextureFormat colorFormat; // of the passes the bundles are executed in
+    std::unordered_map<uint64_t, Bundle> bundles; // by the id of their set
+    uint64_t frame;
+    uint32_t encodedCount; // bundles encoded since the cache was created, to spot the churn
+    bool checks;           // the handles of the draws checked as they are encoded
+
+    RenderBundleCache()
+        : device(nullptr),
+          colorFormat(WGPUTextureFormat_Undefined),
+          frame(0),
+          encodedCount(0),
+          checks(false){};
+};
+
+void createRenderBundleCache(RenderBundleCache& _cache, WGPUDevice _device, bool _checks);
+
+void destroyRenderBundleCache(RenderBundleCache& _cache);
+
+// Releases the bundles, to be encoded again with the pipelines or formats that changed.
+void invalidateRenderBundles(RenderBundleCache& _cache);
+
+// The color format of the passes that follow, the bundles invalidated if it changed.
+void setRenderBundleFormat(RenderBundleCache& _cache, WGPUTextureFormat _colorFormat);
+
+/**
+ * @brief The bundle of the set _id for the sorted _draws, encoded again if they changed since it
+ * was, or null if there's nothing to draw.
+ */
+WGPURenderBundle acquireRenderBundle(RenderBundleCache& _cache, uint64_t _id,
+                                     const DrawQueue& _draws,
+                                     std::span<const DrawPipeline* const> _pipelines,
+                                     ResourceTable& _table);
+
+// Ends the frame: releases the bundles not acquired for k_maxIdleFrames frames.
+void advanceRenderBundleCache(RenderBundleCache& _cache);
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
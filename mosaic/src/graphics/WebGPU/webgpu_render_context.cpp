@@ -1,5 +1,6 @@
 #include "webgpu_render_context.hpp"
 
+#include <utility>
 #include <vector>
 
 #include <GLFW/glfw3.h>
@@ -16,6 +17,12 @@ namespace graphics
 namespace webgpu
 {
 
+// Per-frame data, e.g. 16k objects of 256 bytes of uniforms
+static constexpr uint64_t k_frameRingSize = 4 * 1024 * 1024;
+
+// The render bundle of m_staticDraws
+static constexpr uint64_t k_staticDrawSet = 0;
+
 WebGPURenderContext::WebGPURenderContext(const window::Window* _window,
                                          const RenderContextSettings& _settings)
     : m_instance(nullptr),
@@ -23,6 +30,8 @@ WebGPURenderContext::WebGPURenderContext(const window::Window* _window,
       m_adapter(nullptr),
       m_device(nullptr),
       m_presentQueue(nullptr),
+      m_offscreenTexture(nullptr),
+      m_submittedFrames(0),
       RenderContext(_window, _settings){};
 
 pieces::RefResult<RenderContext, std::string> WebGPURenderContext::initialize(
@@ -30,29 +39,44 @@ pieces::RefResult<RenderContext, std::string> WebGPURenderContext::initialize(
 {
     auto window = getWindow();
 
-    m_surface = glfwCreateWindowWGPUSurface(m_instance,
-                                            static_cast<GLFWwindow*>(window->getNativeHandle()));
-
     m_instance = createInstance();
 
-    m_adapter = requestAdapter(m_instance, m_surface);
+    // headless, the adapter is requested without a surface to be compatible with
+    if (window)
+    {
+        m_surface = glfwCreateWindowWGPUSurface(
+            m_instance, static_cast<GLFWwindow*>(window->getNativeHandle()));
+    }
+
+    // the engine goes on loading while the device is requested, the frames are skipped until it
+    // arrived; the native backends usually answer in the requests themselves
+    m_deviceRequest = requestDevice(m_instance, m_surface, getSettings().validation);
 
-    if (!isAdapterSuitable(m_adapter))
+    if (m_deviceRequest.isReady() && !acquireDevice())
     {
-        return pieces::ErrRef<RenderContext, std::string>("WebGPU adapter is not suitable!");
+        return pieces::ErrRef<RenderContext, std::string>("Could not acquire a WebGPU device!");
     }
 
-    m_device = createDevice(m_adapter);
+    return pieces::OkRef<RenderContext, std::string>(*this);
+}
+
+void WebGPURenderContext::createDeviceResources()
+{
+    auto window = getWindow();
 
     m_presentQueue = wgpuDeviceGetQueue(m_device);
 
+    createResourceTable(m_resourceTable, m_device);
+    createFrameRingBuffer(m_frameRing, m_device, m_resourceTable, k_frameRingSize);
+    createRenderBundleCache(m_renderBundles, m_device, getSettings().checks);
+
     WGPUQueueWorkDoneCallback onQueueWorkDone =
         [](WGPUQueueWorkDoneStatus status, void* userData1, void* userData2)
     {
         switch (status)
         {
             case WGPUQueueWorkDoneStatus_Success:
-                MOSAIC_INFO("WebGPU queue work done successfully!");
+                MOSAIC_LOG_RATE_LIMITED(debug, 10000, "WebGPU queue work done successfully!");
                 break;
             case WGPUQueueWorkDoneStatus_Error:
                 MOSAIC_ERROR("WebGPU queue work done with error!");
@@ -80,26 +104,83 @@ pieces::RefResult<RenderContext, std::string> WebGPURenderContext::initialize(
 
     wgpuQueueOnSubmittedWorkDone(m_presentQueue, workDoneCallbackInfo);
 
+    if (!window)
+    {
+        m_offscreenTexture = createOffscreenTexture(m_device, getSettings().offscreenExtent);
+        return;
+    }
+
+    // the adapter is kept to configure the surface again
     configureSwapchain(m_adapter, m_device, m_surface,
                        static_cast<GLFWwindow*>(window->getNativeHandle()),
-                       window->getFramebufferSize());
+                       window->getFramebufferSize(), getSettings().presentPolicy);
+}
 
-    wgpuAdapterRelease(m_adapter);
+bool WebGPURenderContext::acquireDevice()
+{
+    if (!m_deviceRequest.isValid()) return false;
 
-    return pieces::OkRef<RenderContext, std::string>(*this);
+#if !defined(__EMSCRIPTEN__)
+    // the callbacks a native backend did not run in the requests
+    if (!m_deviceRequest.isReady()) wgpuInstanceProcessEvents(m_instance);
+#endif
+
+    if (!m_deviceRequest.isReady()) return false;
+
+    DeviceAcquisition acquisition = std::exchange(m_deviceRequest, {}).get();
+
+    // reported by the callbacks; the context stays without a device
+    if (!acquisition.device)
+    {
+        releaseDeviceAcquisition(acquisition);
+        return false;
+    }
+
+    m_adapter = acquisition.adapter;
+    m_device = acquisition.device;
+
+    createDeviceResources();
+
+    return true;
 }
 
 void WebGPURenderContext::shutdown()
 {
-    wgpuSurfaceUnconfigure(m_surface);
-    wgpuSurfaceRelease(m_surface);
+    abandonDeviceRequest(std::move(m_deviceRequest));
+
+    if (m_device)
+    {
+        destroyRenderBundleCache(m_renderBundles);
+        destroyFrameRingBuffer(m_frameRing, m_resourceTable);
+        destroyResourceTable(m_resourceTable);
+    }
+
+    if (m_surface)
+    {
+        wgpuSurfaceUnconfigure(m_surface);
+        wgpuSurfaceRelease(m_surface);
+    }
+
+    if (m_offscreenTexture) wgpuTextureRelease(m_offscreenTexture);
+
+    if (m_adapter) wgpuAdapterRelease(m_adapter);
     wgpuInstanceRelease(m_instance);
-    wgpuQueueRelease(m_presentQueue);
-    wgpuDeviceRelease(m_device);
+    if (m_presentQueue) wgpuQueueRelease(m_presentQueue);
+    if (m_device) wgpuDeviceRelease(m_device);
 }
 
 void WebGPURenderContext::resizeFramebuffer() {}
 
+void WebGPURenderContext::applyPresentPolicy()
+{
+    auto window = getWindowInternal();
+    if (!window || !m_device) return;
+
+    configureSwapchain(m_adapter, m_device, m_surface,
+                       static_cast<GLFWwindow*>(window->getNativeHandle()),
+                       window->getFramebufferSize(), getSettings().presentPolicy);
+}
+
 void mosaic::graphics::webgpu::WebGPURenderContext::recreateSurface() {}
 
 void WebGPURenderContext::getNextSurfaceViewData()
@@ -128,6 +209,9 @@ void WebGPURenderContext::getNextSurfaceViewData()
 
     WGPUTextureView targetView = wgpuTextureCreateView(surfaceTexture.texture, &viewDescriptor);
 
+    // a surface configured again may have another format
+    setRenderBundleFormat(m_renderBundles, viewDescriptor.format);
+
 #ifndef WEBGPU_BACKEND_WGPU
     wgpuTextureRelease(surfaceTexture.texture);
 #endif
@@ -148,9 +232,22 @@ void WebGPURenderContext::pollDevice(int _times)
     }
 }
 
-void WebGPURenderContext::beginFrame()
+bool WebGPURenderContext::beginFrame()
 {
-    getNextSurfaceViewData();
+    if (!m_device && !acquireDevice()) return false;
+
+    if (m_offscreenTexture)
+    {
+        m_frameData.surfaceTexture = {};
+        m_frameData.targetView = wgpuTextureCreateView(m_offscreenTexture, nullptr);
+        setRenderBundleFormat(m_renderBundles, wgpuTextureGetFormat(m_offscreenTexture));
+    }
+    else
+    {
+        getNextSurfaceViewData();
+    }
+
+    beginFrameRingBuffer(m_frameRing);
 
     m_frameData.commandEncoder = createCommandEncoder(m_device, "Clear Screen Encoder");
 
@@ -161,17 +258,32 @@ void WebGPURenderContext::beginFrame()
                                                  0.5f,
                                                  1.0f,
                                              });
+
+    return true;
 }
 
 void WebGPURenderContext::updateResources()
 {
-    // Placeholder for resource updates (uniforms, buffer data, etc.)
+    // Per-frame uniforms and dynamic geometry are allocated in m_frameRing, uploaded at once by
+    // endFrame(), with the writes to the other buffers queued in m_uploads
 }
 
 void WebGPURenderContext::drawScene()
 {
-    // This is where draw calls would go
-    // e.g., wgpuRenderPassEncoderDraw(...);
+    // the static draws replayed by one call, encoded again only once they change
+    WGPURenderBundle bundle = acquireRenderBundle(m_renderBundles, k_staticDrawSet, m_staticDraws,
+                                                  m_pipelines, m_resourceTable);
+
+    const bool debugLabels = getSettings().debugLabels;
+    if (debugLabels)
+    {
+        wgpuRenderPassEncoderPushDebugGroup(m_frameData.renderPass,
+                                            WGPUStringView("Static draws", 12));
+    }
+
+    if (bundle) wgpuRenderPassEncoderExecuteBundles(m_frameData.renderPass, 1, &bundle);
+
+    if (debugLabels) wgpuRenderPassEncoderPopDebugGroup(m_frameData.renderPass);
 
     endRenderPass(m_frameData.renderPass);
 }
@@ -188,15 +300,31 @@ void WebGPURenderContext::endFrame()
         createCommandBuffer(m_frameData.commandEncoder, cmdBufferDescriptor);
     commands.push_back(command);
 
+    flushFrameRingBuffer(m_frameRing, m_presentQueue);
+    flushUploadBatch(m_uploads, m_presentQueue);
     submitCommands(m_presentQueue, commands);
     pollDevice();
 
+    getInputLatencyInternal().submitFrame(++m_submittedFrames);
+
+    advanceRenderBundleCache(m_renderBundles);
+
     wgpuTextureViewRelease(m_frameData.targetView);
 
+    // nothing to present headless; the presentation cannot be timed, the latency is the one of
+    // the frame handed to the surface
+    if (m_offscreenTexture)
+    {
+        getInputLatencyInternal().presentFrame(m_submittedFrames, InputLatency::Clock::now());
+        return;
+    }
+
 #ifndef __EMSCRIPTEN__
     wgpuSurfacePresent(m_surface);
 #endif
 
+    getInputLatencyInternal().presentFrame(m_submittedFrames, InputLatency::Clock::now());
+
 #ifdef WEBGPU_BACKEND_WGPU
     wgpuTextureRelease(m_frameData.surfaceTexture.texture);
 #endif
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <vector>
+
+#include "mosaic/graphics/draw_queue.hpp"
 #include "mosaic/graphics/render_context.hpp"
 
 #include "webgpu_common.hpp"
+#include "webgpu_device.hpp"
+#include "webgpu_draw_encoder.hpp"
+#include "webgpu_frame_ring.hpp"
+#include "webgpu_render_bundle.hpp"
+#include "webgpu_resource_table.hpp"
+#include "webgpu_upload_batch.hpp"
 
 namespace mosaic
 {
@@ -33,6 +42,19 @@ class WebGPURenderContext : public RenderContext
     WGPUAdapter m_adapter;
     WGPUDevice m_device;
     WGPUQueue m_presentQueue;
+    WGPUTexture m_offscreenTexture; // the target of a headless context, which has no surface
+    uint64_t m_submittedFrames;
+
+    FrameRingBuffer m_frameRing; // uniforms and dynamic geometry of the frame
+    ResourceTable m_resourceTable; // the resources by handle, and their cached bind groups
+    UploadBatch m_uploads;         // the buffer writes of the frame, merged when written
+
+    DrawQueue m_staticDraws; // sorted once submitted, replayed from their render bundle
+    std::vector<const DrawPipeline*> m_pipelines; // by the ResourceHandle of the draws
+    RenderBundleCache m_renderBundles;
+
+    // the adapter and the device until they arrived, the frames are skipped meanwhile
+    exec::TaskFuture<DeviceAcquisition> m_deviceRequest;
 
    public:
     WebGPURenderContext(const window::Window* _window, const RenderContextSettings& _settings);
@@ -44,13 +66,18 @@ class WebGPURenderContext : public RenderContext
 
    private:
     void resizeFramebuffer() override;
+    void applyPresentPolicy() override;
     void recreateSurface() override;
-    void beginFrame() override;
+    bool beginFrame() override;
     void updateResources() override;
     void drawScene() override;
     void endFrame() override;
 
    private:
+    // The queue, the tables and the surface configuration of m_device
+    void createDeviceResources();
+    // Takes the device of m_deviceRequest once it arrived, without waiting for it
+    bool acquireDevice();
     void getNextSurfaceViewData();
     void pollDevice(int _times = 5);
 };
@@ -0,0 +1,203 @@
+#include "webgpu_resource_table.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+// FNV-1a of the layout and of the bindings, field by field
+static uint64_t hashBindGroup(WGPUBindGroupLayout _layout,
+                              std::span<const ResourceBinding> _bindings)
+{
+    constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    auto combine = [&](uint64_t _value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            hash ^= (_value >> (i * 8)) & 0xff;
+            hash *= FNV_PRIME;
+        }
+    };
+
+    combine(reinterpret_cast<uintptr_t>(_layout));
+
+    for (const ResourceBinding& binding : _bindings)
+    {
+        combine(binding.binding);
+        combine(static_cast<uint64_t>(binding.type));
+        combine(binding.handle);
+    }
+
+    return hash;
+}
+
+// The bind groups a released handle was in are no longer reachable with valid handles
+static void evictBindGroups(ResourceTable& _table, ResourceType _type, uint32_t _handle)
+{
+    std::erase_if(_table.bindGroups,
+                  [&](const auto& _entry)
+                  {
+                      const std::vector<ResourceBinding>& bindings = _entry.second.bindings;
+                      const bool referenced = std::ranges::any_of(
+                          bindings, [&](const ResourceBinding& _binding)
+                          { return _binding.type == _type && _binding.handle == _handle; });
+
+                      if (referenced) wgpuBindGroupRelease(_entry.second.bindGroup);
+                      return referenced;
+                  });
+}
+
+// A WGPUBindGroupEntry for the binding, false if its handle is invalid
+static bool resolveBinding(const ResourceTable& _table, const ResourceBinding& _binding,
+                           WGPUBindGroupEntry& _entry)
+{
+    _entry = {};
+    _entry.binding = _binding.binding;
+
+    switch (_binding.type)
+    {
+        case ResourceType::Buffer:
+        {
+            const auto* range = _table.buffers.get(BufferHandle{_binding.handle});
+            if (!range) return false;
+
+            _entry.buffer = range->buffer;
+            _entry.offset = range->offset;
+            _entry.size = range->size;
+            return true;
+        }
+        case ResourceType::Texture:
+        {
+            const WGPUTextureView* view = _table.textures.get(TextureHandle{_binding.handle});
+            if (!view) return false;
+
+            _entry.textureView = *view;
+            return true;
+        }
+        case ResourceType::Sampler:
+        {
+            const WGPUSampler* sampler = _table.samplers.get(SamplerHandle{_binding.handle});
+            if (!sampler) return false;
+
+            _entry.sampler = *sampler;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void createResourceTable(ResourceTable& _table, WGPUDevice _device) { _table.device = _device; }
+
+void destroyResourceTable(ResourceTable& _table)
+{
+    for (auto& [hash, cached] : _table.bindGroups) wgpuBindGroupRelease(cached.bindGroup);
+
+    _table.bindGroups.clear();
+}
+
+BufferHandle registerBuffer(ResourceTable& _table, WGPUBuffer _buffer, uint64_t _offset,
+                            uint64_t _size)
+{
+    const BufferHandle handle = _table.buffers.allocate({_buffer, _offset, _size});
+    if (!handle.isValid()) MOSAIC_ERROR("The resource table is out of buffer slots!");
+
+    return handle;
+}
+
+TextureHandle registerTexture(ResourceTable& _table, WGPUTextureView _view)
+{
+    const TextureHandle handle = _table.textures.allocate(_view);
+    if (!handle.isValid()) MOSAIC_ERROR("The resource table is out of texture slots!");
+
+    return handle;
+}
+
+SamplerHandle registerSampler(ResourceTable& _table, WGPUSampler _sampler)
+{
+    const SamplerHandle handle = _table.samplers.allocate(_sampler);
+    if (!handle.isValid()) MOSAIC_ERROR("The resource table is out of sampler slots!");
+
+    return handle;
+}
+
+// The bind groups in flight keep their resources alive: the slots are reused at once
+void releaseBuffer(ResourceTable& _table, BufferHandle _handle)
+{
+    if (!_table.buffers.release(_handle, 0)) return;
+
+    _table.buffers.recycle(0);
+    evictBindGroups(_table, ResourceType::Buffer, _handle.value);
+}
+
+void releaseTexture(ResourceTable& _table, TextureHandle _handle)
+{
+    if (!_table.textures.release(_handle, 0)) return;
+
+    _table.textures.recycle(0);
+    evictBindGroups(_table, ResourceType::Texture, _handle.value);
+}
+
+void releaseSampler(ResourceTable& _table, SamplerHandle _handle)
+{
+    if (!_table.samplers.release(_handle, 0)) return;
+
+    _table.samplers.recycle(0);
+    evictBindGroups(_table, ResourceType::Sampler, _handle.value);
+}
+
+WGPUBindGroup acquireBindGroup(ResourceTable& _table, WGPUBindGroupLayout _layout,
+                               std::span<const ResourceBinding> _bindings)
+{
+    const uint64_t hash = hashBindGroup(_layout, _bindings);
+
+    auto it = _table.bindGroups.find(hash);
+    if (it != _table.bindGroups.end() && it->second.layout == _layout &&
+        std::ranges::equal(it->second.bindings, _bindings))
+    {
+        return it->second.bindGroup;
+    }
+
+    std::vector<WGPUBindGroupEntry> entries(_bindings.size());
+
+    for (size_t i = 0; i < _bindings.size(); ++i)
+    {
+        if (!resolveBinding(_table, _bindings[i], entries[i]))
+        {
+            MOSAIC_ERROR("Bind group entry {} is an invalid handle!", _bindings[i].binding);
+            return nullptr;
+        }
+    }
+
+    WGPUBindGroupDescriptor descriptor = {};
+    descriptor.nextInChain = nullptr;
+    descriptor.layout = _layout;
+    descriptor.entryCount = entries.size();
+    descriptor.entries = entries.data();
+
+    WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(_table.device, &descriptor);
+    if (!bindGroup)
+    {
+        MOSAIC_ERROR("Failed to create WebGPU bind group!");
+        return nullptr;
+    }
+
+    // a collision replaces the group cached under the hash
+    if (it != _table.bindGroups.end()) wgpuBindGroupRelease(it->second.bindGroup);
+
+    _table.bindGroups[hash] = {bindGroup, _layout, {_bindings.begin(), _bindings.end()}};
+
+    return bindGroup;
+}
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "mosaic/graphics/resource_registry.hpp"
+
+#include "webgpu_common.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+// A resource of a bind group, by its binding in the layout and its handle value.
+struct ResourceBinding
+{
+    uint32_t binding = 0;
+    ResourceType type = ResourceType::Buffer;
+    uint32_t handle = 0;
+
+    bool operator==(const ResourceBinding&) const = default;
+};
+
+/**
+ * @brief The buffers, texture views and samplers of a context by generational handle, and the
+ * bind groups of their combinations.
+ *
+ * WebGPU has no descriptor arrays: a bind group is created the first time a layout is bound with
+ * a set of handles, then cached by the hash of both, so the draws sharing a material reuse it. The
+ * objects are reference counted by the API, a released handle is recycled at once and evicts the
+ * bind groups it was in.
+ */
+struct ResourceTable
+{
+    struct BufferRange
+    {
+        WGPUBuffer buffer = nullptr;
+        uint64_t offset = 0;
+        uint64_t size = WGPU_WHOLE_SIZE;
+    };
+
+    struct CachedBindGroup
+    {
+        WGPUBindGroup bindGroup;
+        WGPUBindGroupLayout layout;
+        std::vector<ResourceBinding> bindings; // to evict it once one is released
+    };
+
+    WGPUDevice device;
+
+    ResourcePool<BufferRange, ResourceType::Buffer> buffers;
+    ResourcePool<WGPUTextureView, ResourceType::Texture> textures;
+    ResourcePool<WGPUSampler, ResourceType::Sampler> samplers;
+
+    std::unordered_map<uint64_t, CachedBindGroup> bindGroups; // by layout and bindings
+
+    ResourceTable() : device(nullptr){};
+};
+
+void createResourceTable(ResourceTable& _table, WGPUDevice _device);
+
+// Releases the cached bind groups, the resources stay owned by their creators.
+void destroyResourceTable(ResourceTable& _table);
+
+BufferHandle registerBuffer(ResourceTable& _table, WGPUBuffer _buffer, uint64_t _offset = 0,
+                            uint64_t _size = WGPU_WHOLE_SIZE);
+TextureHandle registerTexture(ResourceTable& _table, WGPUTextureView _view);
+SamplerHandle registerSampler(ResourceTable& _table, WGPUSampler _sampler);
+
+void releaseBuffer(ResourceTable& _table, BufferHandle _handle);
+void releaseTexture(ResourceTable& _table, TextureHandle _handle);
+void releaseSampler(ResourceTable& _table, SamplerHandle _handle);
+
+// The cached bind group of _layout with _bindings, created on a miss; nullptr if a handle is
+// invalid.
+WGPUBindGroup acquireBindGroup(ResourceTable& _table, WGPUBindGroupLayout _layout,
+                               std::span<const ResourceBinding> _bindings);
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
@@ -1,5 +1,10 @@
 #include "webgpu_swapchain.hpp"
 
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
 namespace mosaic
 {
 namespace graphics
@@ -7,8 +12,39 @@ namespace graphics
 namespace webgpu
 {
 
+static constexpr std::array<std::pair<PresentMode, WGPUPresentMode>, 4> k_presentModes = {{
+    {PresentMode::Immediate, WGPUPresentMode_Immediate},
+    {PresentMode::Mailbox, WGPUPresentMode_Mailbox},
+    {PresentMode::Fifo, WGPUPresentMode_Fifo},
+    {PresentMode::FifoRelaxed, WGPUPresentMode_FifoRelaxed},
+}};
+
+static WGPUPresentMode choosePresentMode(const WGPUSurfaceCapabilities& _capabilities,
+                                         PresentPolicy _presentPolicy)
+{
+    const WGPUPresentMode* available = _capabilities.presentModes;
+    const WGPUPresentMode* availableEnd = available + _capabilities.presentModeCount;
+
+    std::vector<PresentMode> supported;
+    for (const auto& [mode, wgpuMode] : k_presentModes)
+    {
+        if (std::find(available, availableEnd, wgpuMode) != availableEnd) supported.push_back(mode);
+    }
+
+    const PresentMode mode = graphics::choosePresentMode(_presentPolicy, supported);
+    MOSAIC_INFO("Present mode: {}", getPresentModeName(mode));
+
+    for (const auto& [candidate, wgpuMode] : k_presentModes)
+    {
+        if (candidate == mode) return wgpuMode;
+    }
+
+    return WGPUPresentMode_Fifo;
+}
+
 void configureSwapchain(WGPUAdapter _adapter, WGPUDevice _device, WGPUSurface _surface,
-                        GLFWwindow* _glfwHandle, glm::uvec2 _framebufferExtent)
+                        GLFWwindow* _glfwHandle, glm::uvec2 _framebufferExtent,
+                        PresentPolicy _presentPolicy)
 {
     WGPUSurfaceCapabilities surfaceCapabilities;
 
@@ -39,7 +75,7 @@ void configureSwapchain(WGPUAdapter _adapter, WGPUDevice _device, WGPUSurface _s
     surfaceConfig.format = WGPUTextureFormat_RGBA8UnormSrgb;
     surfaceConfig.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding;
     surfaceConfig.device = _device;
-    surfaceConfig.presentMode = WGPUPresentMode_Fifo;
+    surfaceConfig.presentMode = choosePresentMode(surfaceCapabilities, _presentPolicy);
     surfaceConfig.alphaMode = WGPUCompositeAlphaMode_Auto;
     surfaceConfig.viewFormatCount = 0;
     surfaceConfig.viewFormats = nullptr;
@@ -47,6 +83,23 @@ void configureSwapchain(WGPUAdapter _adapter, WGPUDevice _device, WGPUSurface _s
     wgpuSurfaceConfigure(_surface, &surfaceConfig);
 }
 
+WGPUTexture createOffscreenTexture(WGPUDevice _device, glm::uvec2 _extent)
+{
+    WGPUTextureDescriptor textureDescriptor = {};
+    textureDescriptor.nextInChain = nullptr;
+    textureDescriptor.label = WGPUStringView("Offscreen texture", 17);
+    textureDescriptor.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_CopySrc;
+    textureDescriptor.dimension = WGPUTextureDimension_2D;
+    textureDescriptor.size = {std::max(_extent.x, 1u), std::max(_extent.y, 1u), 1};
+    textureDescriptor.format = WGPUTextureFormat_RGBA8UnormSrgb;
+    textureDescriptor.mipLevelCount = 1;
+    textureDescriptor.sampleCount = 1;
+    textureDescriptor.viewFormatCount = 0;
+    textureDescriptor.viewFormats = nullptr;
+
+    return wgpuDeviceCreateTexture(_device, &textureDescriptor);
+}
+
 } // namespace webgpu
 } // namespace graphics
 } // namespace mosaic
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "mosaic/graphics/present_mode.hpp"
+
 #include "webgpu_common.hpp"
 
 namespace mosaic
@@ -9,8 +11,14 @@ namespace graphics
 namespace webgpu
 {
 
+// Presented in the mode the surface supports that suits _presentPolicy best
 void configureSwapchain(WGPUAdapter _adapter, WGPUDevice _device, WGPUSurface _surface,
-                        GLFWwindow* _glfwHandle, glm::uvec2 _framebufferExtent);
+                        GLFWwindow* _glfwHandle, glm::uvec2 _framebufferExtent,
+                        PresentPolicy _presentPolicy);
+
+// The target of a headless context in place of the surface, in its format: copied from for a
+// readback, never presented
+WGPUTexture createOffscreenTexture(WGPUDevice _device, glm::uvec2 _extent);
 
 } // namespace webgpu
 } // namespace graphics
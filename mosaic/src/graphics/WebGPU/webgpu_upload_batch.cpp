@@ -0,0 +1,96 @@
+#include "webgpu_upload_batch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+// wgpuQueueWriteBuffer() writes whole words
+static constexpr uint64_t k_writeAlignment = 4;
+
+void queueBufferWrite(UploadBatch& _batch, WGPUBuffer _buffer, uint64_t _offset, const void* _data,
+                      uint64_t _size)
+{
+    if (!_buffer || _size == 0) return;
+
+    if (_offset % k_writeAlignment != 0 || _size % k_writeAlignment != 0)
+    {
+        MOSAIC_ERROR("WebGPU buffer writes must be aligned to 4 bytes!");
+        return;
+    }
+
+    const size_t staging = _batch.staging.size();
+    _batch.staging.resize(staging + _size);
+    std::memcpy(_batch.staging.data() + staging, _data, _size);
+
+    _batch.writes.push_back({_buffer, _offset, _size, staging});
+}
+
+void flushUploadBatch(UploadBatch& _batch, WGPUQueue _queue)
+{
+    _batch.writeCount = 0;
+    if (_batch.writes.empty()) return;
+
+    // by buffer then offset, stable: the writes to the same bytes keep the order they were queued
+    std::stable_sort(_batch.writes.begin(), _batch.writes.end(),
+                     [](const UploadBatch::Write& _a, const UploadBatch::Write& _b)
+                     {
+                         if (_a.buffer != _b.buffer) return _a.buffer < _b.buffer;
+                         return _a.offset < _b.offset;
+                     });
+
+    size_t first = 0;
+    while (first < _batch.writes.size())
+    {
+        const WGPUBuffer buffer = _batch.writes[first].buffer;
+        const uint64_t start = _batch.writes[first].offset;
+
+        // the writes whose bytes join those before them
+        uint64_t end = start + _batch.writes[first].size;
+        size_t last = first + 1;
+        for (; last < _batch.writes.size(); ++last)
+        {
+            const UploadBatch::Write& write = _batch.writes[last];
+            if (write.buffer != buffer || write.offset > end) break;
+            end = std::max(end, write.offset + write.size);
+        }
+
+        if (last - first == 1)
+        {
+            wgpuQueueWriteBuffer(_queue, buffer, start,
+                                 _batch.staging.data() + _batch.writes[first].staging, end - start);
+        }
+        else
+        {
+            // applied in the order queued, which that of their staging is
+            std::sort(_batch.writes.begin() + first, _batch.writes.begin() + last,
+                      [](const UploadBatch::Write& _a, const UploadBatch::Write& _b)
+                      { return _a.staging < _b.staging; });
+
+            _batch.merged.resize(end - start);
+            for (size_t i = first; i < last; ++i)
+            {
+                const UploadBatch::Write& write = _batch.writes[i];
+                std::memcpy(_batch.merged.data() + (write.offset - start),
+                            _batch.staging.data() + write.staging, write.size);
+            }
+
+            wgpuQueueWriteBuffer(_queue, buffer, start, _batch.merged.data(), end - start);
+        }
+
+        ++_batch.writeCount;
+        first = last;
+    }
+
+    _batch.staging.clear();
+    _batch.writes.clear();
+}
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "webgpu_common.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace webgpu
+{
+
+/**
+ * @brief The buffer writes of a frame, staged in CPU memory and written together before its
+ * submission: the writes to a buffer that overlap or touch are merged into one
+ * wgpuQueueWriteBuffer(), so a frame makes a call per contiguous range rather than per write, each
+ * a crossing from WASM to JavaScript on the web.
+ *
+ * The writes are applied in the order queued, a later one overwriting the bytes of an earlier.
+ * Like the queue's, their offsets and sizes are multiples of 4.
+ */
+struct UploadBatch
+{
+    struct Write
+    {
+        WGPUBuffer buffer;
+        uint64_t offset;
+        uint64_t size;
+        size_t staging; // of its bytes in staging
+    };
+
+    std::vector<std::byte> staging;
+    std::vector<Write> writes;
+    std::vector<std::byte> merged; // the bytes of a range written at once
+
+    uint32_t writeCount; // the queue writes of the last flush, against writes.size() queued
+
+    UploadBatch() : writeCount(0){};
+};
+
+// Copies _size bytes of _data, written at the next flush.
+void queueBufferWrite(UploadBatch& _batch, WGPUBuffer _buffer, uint64_t _offset, const void* _data,
+                      uint64_t _size);
+
+// Writes what was queued, before the submission that reads it.
+void flushUploadBatch(UploadBatch& _batch, WGPUQueue _queue);
+
+} // namespace webgpu
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,130 @@
+#include "mosaic/graphics/draw_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The key is sorted a byte at a time, least significant first
+static constexpr uint32_t k_radixBits = 8;
+static constexpr uint32_t k_radixBuckets = 1u << k_radixBits;
+static constexpr uint32_t k_radixPasses = 64 / k_radixBits;
+
+DrawQueue::DrawQueue(size_t _capacity) : m_calls(std::max<size_t>(_capacity, 1))
+{
+    m_entries.reserve(m_calls.capacity());
+    m_scratch.reserve(m_calls.capacity());
+}
+
+void DrawQueue::sort()
+{
+    const size_t count = m_entries.size();
+    if (count < 2) return;
+
+    // Every histogram in one read of the keys
+    std::array<std::array<uint32_t, k_radixBuckets>, k_radixPasses> histograms{};
+
+    for (const SortEntry& entry : m_entries)
+    {
+        for (uint32_t pass = 0; pass < k_radixPasses; ++pass)
+        {
+            ++histograms[pass][(entry.key >> (pass * k_radixBits)) & (k_radixBuckets - 1)];
+        }
+    }
+
+    m_scratch.resize(count);
+
+    SortEntry* source = m_entries.data();
+    SortEntry* destination = m_scratch.data();
+
+    for (uint32_t pass = 0; pass < k_radixPasses; ++pass)
+    {
+        const uint32_t shift = pass * k_radixBits;
+        auto& histogram = histograms[pass];
+
+        // the same byte in every key (the unused high bits, a single pipeline...): nothing moves
+        if (histogram[(source[0].key >> shift) & (k_radixBuckets - 1)] == count) continue;
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) offset += std::exchange(bucket, offset);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const SortEntry& entry = source[i];
+            destination[histogram[(entry.key >> shift) & (k_radixBuckets - 1)]++] = entry;
+        }
+
+        std::swap(source, destination);
+    }
+
+    if (source != m_entries.data()) m_entries.swap(m_scratch);
+}
+
+uint64_t DrawQueue::getHash() const noexcept
+{
+    constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    // a word at a time, its high bits folded back so that the low ones depend on them too
+    uint64_t hash = FNV_OFFSET_BASIS;
+    auto combine = [&](uint64_t _value)
+    {
+        hash = (hash ^ _value) * FNV_PRIME;
+        hash ^= hash >> 32;
+    };
+
+    auto pack = [](uint32_t _high, uint32_t _low) { return uint64_t{_high} << 32 | _low; };
+
+    const DrawCall* calls = data();
+
+    for (const SortEntry& entry : m_entries)
+    {
+        const DrawCall& call = calls[entry.index];
+
+        combine(call.sortKey);
+        combine(pack(static_cast<uint32_t>(call.type) << 8 | call.vertexBufferCount,
+                     call.pipeline));
+        combine(pack(call.vertexBuffers[0], call.vertexBuffers[1]));
+        combine(pack(call.vertexBuffers[2], call.vertexBuffers[3]));
+        combine(pack(call.indexBuffer, call.indirectBuffer));
+        combine(pack(call.countBuffer, call.maxDrawCount));
+        combine(pack(call.resources[0], call.resources[1]));
+        combine(pack(call.resources[2], call.resources[3]));
+        combine(pack(call.vertexCount, call.indexCount));
+        combine(pack(call.instanceCount, call.firstVertex));
+        combine(pack(call.firstIndex, call.vertexOffset));
+        combine(call.firstInstance);
+    }
+
+    return hash;
+}
+
+void DrawQueue::clear() noexcept
+{
+    m_calls.reset();
+    m_entries.clear();
+}
+
+DrawCall* DrawQueue::grow()
+{
+    const size_t used = m_calls.used();
+
+    pieces::LinearAllocator<DrawCall> calls(m_calls.capacity() * 2);
+
+    DrawCall* moved = calls.allocate(used);
+    std::memcpy(moved, data(), used * sizeof(DrawCall));
+
+    m_calls = std::move(calls);
+    m_entries.reserve(m_calls.capacity());
+    m_scratch.reserve(m_calls.capacity());
+
+    return m_calls.allocate(1);
+}
+
+} // namespace graphics
+} // namespace mosaic
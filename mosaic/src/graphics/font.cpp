@@ -0,0 +1,105 @@
+#include "mosaic/graphics/glyph_atlas.hpp"
+
+#include <cstring>
+
+#include <stb_truetype.h>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+struct Font::Data
+{
+    std::vector<uint8_t> file; // read by info, never moved once loaded
+    stbtt_fontinfo info;
+    int ascent = 0;
+    int descent = 0;
+    int lineGap = 0;
+};
+
+Font::Font(std::unique_ptr<Data> _data) : m_data(std::move(_data)) {}
+
+Font::~Font() = default;
+
+pieces::Result<std::shared_ptr<Font>, std::string> Font::load(std::vector<uint8_t> _file,
+                                                              uint32_t _index)
+{
+    auto data = std::make_unique<Data>();
+    data->file = std::move(_file);
+
+    const int offset = stbtt_GetFontOffsetForIndex(data->file.data(), static_cast<int>(_index));
+    if (offset < 0 || !stbtt_InitFont(&data->info, data->file.data(), offset))
+    {
+        return pieces::Err<std::shared_ptr<Font>, std::string>("not a TrueType font");
+    }
+
+    stbtt_GetFontVMetrics(&data->info, &data->ascent, &data->descent, &data->lineGap);
+
+    return pieces::Ok<std::shared_ptr<Font>, std::string>(
+        std::shared_ptr<Font>(new Font(std::move(data))));
+}
+
+float Font::getAscent(float _pixelHeight) const
+{
+    return m_data->ascent * stbtt_ScaleForPixelHeight(&m_data->info, _pixelHeight);
+}
+
+float Font::getLineHeight(float _pixelHeight) const
+{
+    const int height = m_data->ascent - m_data->descent + m_data->lineGap;
+    return height * stbtt_ScaleForPixelHeight(&m_data->info, _pixelHeight);
+}
+
+float Font::getAdvance(char32_t _codepoint, float _pixelHeight) const
+{
+    const int glyph = stbtt_FindGlyphIndex(&m_data->info, static_cast<int>(_codepoint));
+
+    int advance = 0;
+    int bearing = 0;
+    stbtt_GetGlyphHMetrics(&m_data->info, glyph, &advance, &bearing);
+
+    return advance * stbtt_ScaleForPixelHeight(&m_data->info, _pixelHeight);
+}
+
+float Font::getKerning(char32_t _left, char32_t _right, float _pixelHeight) const
+{
+    const int kerning = stbtt_GetCodepointKernAdvance(&m_data->info, static_cast<int>(_left),
+                                                      static_cast<int>(_right));
+    return kerning * stbtt_ScaleForPixelHeight(&m_data->info, _pixelHeight);
+}
+
+std::optional<GlyphBitmap> Font::rasterize(char32_t _codepoint, float _pixelHeight,
+                                           uint32_t _spread) const
+{
+    const int glyph = stbtt_FindGlyphIndex(&m_data->info, static_cast<int>(_codepoint));
+    const float scale = stbtt_ScaleForPixelHeight(&m_data->info, _pixelHeight);
+
+    // the edge at 128, _spread pixels out at 0 and in at 255
+    const float distanceScale = 128.0f / static_cast<float>(_spread);
+
+    int width = 0;
+    int height = 0;
+    int left = 0;
+    int top = 0;
+    unsigned char* field =
+        stbtt_GetGlyphSDF(&m_data->info, scale, glyph, static_cast<int>(_spread), 128,
+                          distanceScale, &width, &height, &left, &top);
+
+    // no outline: a space
+    if (!field) return std::nullopt;
+
+    GlyphBitmap bitmap;
+    bitmap.width = static_cast<uint32_t>(width);
+    bitmap.height = static_cast<uint32_t>(height);
+    bitmap.left = static_cast<float>(left);
+    bitmap.top = static_cast<float>(top);
+    bitmap.pixels.resize(bitmap.width * bitmap.height);
+    std::memcpy(bitmap.pixels.data(), field, bitmap.pixels.size());
+
+    stbtt_FreeSDF(field, nullptr);
+    return bitmap;
+}
+
+} // namespace graphics
+} // namespace mosaic
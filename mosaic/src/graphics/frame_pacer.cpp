@@ -0,0 +1,79 @@
+#include "mosaic/graphics/frame_pacer.hpp"
+
+#include <algorithm>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The slack left for the variation of the CPU time, a fraction of it plus a fixed part
+static constexpr int k_marginDivisor = 8;
+static constexpr FramePacer::Clock::duration k_minMargin = std::chrono::microseconds(250);
+
+// Weight of a new measure, out of 8
+static constexpr int k_smoothing = 2;
+
+static FramePacer::Clock::duration smooth(FramePacer::Clock::duration _average,
+                                          FramePacer::Clock::duration _measure,
+                                          bool _first) noexcept
+{
+    if (_first) return _measure;
+
+    return (_average * (8 - k_smoothing) + _measure * k_smoothing) / 8;
+}
+
+void FramePacer::beginFrame(Clock::time_point _now) noexcept { m_frameStart = _now; }
+
+void FramePacer::submitFrame(Clock::time_point _now) noexcept
+{
+    const bool first = m_cpuTime == Clock::duration::zero();
+    m_cpuTime = smooth(m_cpuTime, _now - m_frameStart, first);
+
+    // more frames than tracked are not paced better, the oldest is forgotten
+    if (m_pendingCount == k_maxFramesInFlight)
+    {
+        m_firstPending = (m_firstPending + 1) % k_maxFramesInFlight;
+        --m_pendingCount;
+    }
+
+    m_submits[(m_firstPending + m_pendingCount) % k_maxFramesInFlight] = _now;
+    ++m_pendingCount;
+}
+
+void FramePacer::completeFrame(Clock::time_point _time) noexcept
+{
+    if (m_pendingCount == 0) return;
+
+    const Clock::time_point submit = m_submits[m_firstPending];
+    m_firstPending = (m_firstPending + 1) % k_maxFramesInFlight;
+    --m_pendingCount;
+
+    const Clock::time_point start =
+        m_completedCount > 0 ? std::max(submit, m_lastCompletion) : submit;
+    m_gpuTime = smooth(m_gpuTime, std::max(_time - start, Clock::duration::zero()),
+                       m_completedCount == 0);
+
+    m_lastCompletion = std::max(_time, m_lastCompletion);
+    ++m_completedCount;
+}
+
+FramePacer::Clock::duration FramePacer::getDelay(Clock::time_point _now) const noexcept
+{
+    if (m_completedCount == 0 || m_cpuTime == Clock::duration::zero()) return {};
+
+    // the frames in flight run after each other, each from its submission at the earliest
+    Clock::time_point idle = m_lastCompletion;
+    for (uint32_t i = 0; i < m_pendingCount; ++i)
+    {
+        idle = std::max(idle, m_submits[(m_firstPending + i) % k_maxFramesInFlight]) + m_gpuTime;
+    }
+
+    const Clock::duration margin = std::max(m_cpuTime / k_marginDivisor, k_minMargin);
+    const Clock::time_point start = idle - m_cpuTime - margin;
+
+    return std::max(start - _now, Clock::duration::zero());
+}
+
+} // namespace graphics
+} // namespace mosaic
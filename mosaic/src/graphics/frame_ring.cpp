@@ -0,0 +1,48 @@
+#include "mosaic/graphics/frame_ring.hpp"
+
+#include <algorithm>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+void FrameRing::reset(std::byte* _memory, size_t _frameSize, uint32_t _frameCount) noexcept
+{
+    m_memory = _memory;
+    m_frameSize = _frameSize;
+    m_frameCount = _frameCount;
+
+    m_frameOffset = 0;
+    m_head.store(0, std::memory_order_relaxed);
+    m_peak = 0;
+}
+
+void FrameRing::beginFrame(uint32_t _frame) noexcept
+{
+    m_peak = std::max(m_peak, getUsed());
+
+    m_frameOffset = m_frameCount > 0 ? (_frame % m_frameCount) * m_frameSize : 0;
+    m_head.store(0, std::memory_order_relaxed);
+}
+
+FrameAllocation FrameRing::allocate(size_t _size, size_t _alignment) noexcept
+{
+    if (!m_memory) return {};
+
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t offset;
+
+    // the regions start aligned, the offsets in them are aligned the same
+    do
+    {
+        offset = (head + _alignment - 1) & ~(_alignment - 1);
+
+        if (offset + _size > m_frameSize) return {};
+    } while (!m_head.compare_exchange_weak(head, offset + _size, std::memory_order_relaxed));
+
+    return {m_memory + m_frameOffset + offset, m_frameOffset + offset, _size};
+}
+
+} // namespace graphics
+} // namespace mosaic
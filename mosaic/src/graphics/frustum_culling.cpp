@@ -0,0 +1,130 @@
+// The base kernels are compiled for what every CPU of the target has
+#if !defined(SIMD_X86_SSE2) && (defined(__SSE2__) || defined(_M_X64))
+#define SIMD_X86_SSE2
+#elif !defined(SIMD_ARM_NEON) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define SIMD_ARM_NEON
+#endif
+
+#include <pieces/intrinsics/simd.hpp>
+
+#include "frustum_culling_kernels.hpp"
+
+#include "mosaic/graphics/frustum_culling.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "mosaic/core/isa_dispatch.hpp"
+#include "mosaic/exec/parallel_for.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static const detail::CullKernels& getKernels() noexcept
+{
+    static const core::ISADispatch<detail::CullKernels> kernels(detail::makeCullKernels(), {
+#if defined(SIMD_HAS_AVX512F)
+        {core::ISALevel::avx512f, &detail::getCullKernelsAvx512f},
+#endif
+#if defined(SIMD_HAS_AVX2)
+        {core::ISALevel::avx2, &detail::getCullKernelsAvx2},
+#endif
+    });
+
+    return *kernels;
+}
+
+static detail::CullBatch makeBatch(const Frustum& _frustum, const SphereColumns& _spheres,
+                                   std::span<uint32_t> _visible, uint32_t _firstIndex) noexcept
+{
+    return {&_frustum.planes[0][0],
+            {_spheres.centerX.data(), _spheres.centerY.data(), _spheres.centerZ.data(),
+             _spheres.radius.data(), nullptr, nullptr},
+            0,
+            _spheres.size(),
+            _visible.data(),
+            _firstIndex};
+}
+
+static detail::CullBatch makeBatch(const Frustum& _frustum, const AabbColumns& _boxes,
+                                   std::span<uint32_t> _visible, uint32_t _firstIndex) noexcept
+{
+    return {&_frustum.planes[0][0],
+            {_boxes.centerX.data(), _boxes.centerY.data(), _boxes.centerZ.data(),
+             _boxes.extentX.data(), _boxes.extentY.data(), _boxes.extentZ.data()},
+            0,
+            _boxes.size(),
+            _visible.data(),
+            _firstIndex};
+}
+
+// Culls a range of _grainSize objects per task in place, then moves the ranges together
+static uint32_t cullInParallel(exec::ThreadPool& _pool, detail::CullKernel _kernel,
+                               const detail::CullBatch& _batch, size_t _grainSize)
+{
+    const size_t grain = std::max<size_t>(_grainSize, 1);
+    const size_t rangeCount = (_batch.end + grain - 1) / grain;
+
+    if (rangeCount <= 1) return _kernel(_batch);
+
+    std::vector<uint32_t> counts(rangeCount);
+
+    exec::parallelFor(_pool, size_t{0}, rangeCount, size_t{1},
+                      [&](size_t _range)
+                      {
+                          detail::CullBatch batch = _batch;
+                          batch.begin = _range * grain;
+                          batch.end = std::min(batch.begin + grain, _batch.end);
+                          batch.visible = _batch.visible + batch.begin;
+
+                          counts[_range] = _kernel(batch);
+                      });
+
+    uint32_t count = counts[0];
+    for (size_t range = 1; range < rangeCount; ++range)
+    {
+        std::memmove(_batch.visible + count, _batch.visible + range * grain,
+                     counts[range] * sizeof(uint32_t));
+        count += counts[range];
+    }
+
+    return count;
+}
+
+uint32_t cullSpheres(const Frustum& _frustum, const SphereColumns& _spheres,
+                     std::span<uint32_t> _visible, uint32_t _firstIndex) noexcept
+{
+    return getKernels().spheres(makeBatch(_frustum, _spheres, _visible, _firstIndex));
+}
+
+uint32_t cullAabbs(const Frustum& _frustum, const AabbColumns& _boxes,
+                   std::span<uint32_t> _visible, uint32_t _firstIndex) noexcept
+{
+    return getKernels().aabbs(makeBatch(_frustum, _boxes, _visible, _firstIndex));
+}
+
+uint32_t cullSpheres(exec::ThreadPool& _pool, const Frustum& _frustum,
+                     const SphereColumns& _spheres, std::span<uint32_t> _visible,
+                     uint32_t _firstIndex, size_t _grainSize)
+{
+    return cullInParallel(_pool, getKernels().spheres,
+                          makeBatch(_frustum, _spheres, _visible, _firstIndex), _grainSize);
+}
+
+uint32_t cullAabbs(exec::ThreadPool& _pool, const Frustum& _frustum, const AabbColumns& _boxes,
+                   std::span<uint32_t> _visible, uint32_t _firstIndex, size_t _grainSize)
+{
+    return cullInParallel(_pool, getKernels().aabbs,
+                          makeBatch(_frustum, _boxes, _visible, _firstIndex), _grainSize);
+}
+
+const char* getCullingIsa() noexcept
+{
+    return getKernels().isa;
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,19 @@
+#include <pieces/intrinsics/simd.hpp>
+
+#include "frustum_culling_kernels.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace detail
+{
+
+CullKernels getCullKernelsAvx512f() noexcept
+{
+    return makeCullKernels();
+}
+
+} // namespace detail
+} // namespace graphics
+} // namespace mosaic
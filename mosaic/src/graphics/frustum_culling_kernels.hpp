@@ -0,0 +1,340 @@
+#pragma once
+
+// The culling kernels, compiled once per instruction set: by frustum_culling.cpp for the base one
+// of the target (SSE2, NEON, WebAssembly SIMD or scalar) and by the frustum_culling_<isa>.cpp
+// variants with the flags add_isa_specific_sources() gives them. Included after
+// pieces/intrinsics/simd.hpp.
+//
+// A variant must not emit code another translation unit could link: it only includes this
+// header, and everything but the table getters has internal linkage. The standard library is
+// left out, its inline functions compiled with AVX could be the ones the linker keeps.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mosaic
+{
+namespace graphics
+{
+namespace detail
+{
+
+// A range of objects to cull, as plain pointers for the variants.
+struct CullBatch
+{
+    const float* planes;     // 6 normalized (a, b, c, d), Frustum::planes
+    const float* columns[6]; // center x, y, z, then the radius or the extents x, y, z
+    size_t begin;
+    size_t end;
+    uint32_t* visible; // written from its start
+    uint32_t firstIndex;
+};
+
+using CullKernel = uint32_t (*)(const CullBatch&);
+
+struct CullKernels
+{
+    const char* isa;
+    CullKernel spheres;
+    CullKernel aabbs;
+};
+
+// Defined by the variants compiled for the target (SIMD_HAS_<ISA>).
+CullKernels getCullKernelsAvx2() noexcept;
+CullKernels getCullKernelsAvx512f() noexcept;
+
+namespace
+{
+
+#if defined(SIMD_X86_AVX512F)
+
+struct Lanes
+{
+    static constexpr size_t k_width = 16;
+
+    using Float = __m512;
+    using Mask = __mmask16;
+
+    static Float load(const float* _p) { return _mm512_loadu_ps(_p); }
+    static Float broadcast(float _value) { return _mm512_set1_ps(_value); }
+    static Float add(Float _a, Float _b) { return _mm512_add_ps(_a, _b); }
+    static Float mulAdd(Float _a, Float _b, Float _c) { return _mm512_fmadd_ps(_a, _b, _c); }
+
+    static Mask all() { return 0xFFFF; }
+    static Mask andNotNegative(Mask _mask, Float _distance)
+    {
+        return _mm512_mask_cmp_ps_mask(_mask, _distance, _mm512_setzero_ps(), _CMP_GE_OQ);
+    }
+
+    static uint32_t write(Mask _mask, uint32_t* _visible, uint32_t _first)
+    {
+        const __m512i lanes =
+            _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+        const __m512i indices =
+            _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(_first)), lanes);
+        _mm512_mask_compressstoreu_epi32(_visible, _mask, indices);
+
+        // no POPCNT in AVX-512F
+        uint32_t bits = _mask;
+        bits = bits - ((bits >> 1) & 0x5555u);
+        bits = (bits & 0x3333u) + ((bits >> 2) & 0x3333u);
+        bits = (bits + (bits >> 4)) & 0x0F0Fu;
+        return (bits + (bits >> 8)) & 0x1Fu;
+    }
+};
+
+#elif defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX)
+
+struct Lanes
+{
+    static constexpr size_t k_width = 8;
+
+    using Float = __m256;
+    using Mask = __m256;
+
+    static Float load(const float* _p) { return _mm256_loadu_ps(_p); }
+    static Float broadcast(float _value) { return _mm256_set1_ps(_value); }
+    static Float add(Float _a, Float _b) { return _mm256_add_ps(_a, _b); }
+    static Float mulAdd(Float _a, Float _b, Float _c)
+    {
+        return _mm256_add_ps(_mm256_mul_ps(_a, _b), _c);
+    }
+
+    static Mask all() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    static Mask andNotNegative(Mask _mask, Float _distance)
+    {
+        return _mm256_and_ps(_mask, _mm256_cmp_ps(_distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+
+    static uint32_t bits(Mask _mask) { return static_cast<uint32_t>(_mm256_movemask_ps(_mask)); }
+};
+
+#elif defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1)
+
+struct Lanes
+{
+    static constexpr size_t k_width = 4;
+
+    using Float = __m128;
+    using Mask = __m128;
+
+    static Float load(const float* _p) { return _mm_loadu_ps(_p); }
+    static Float broadcast(float _value) { return _mm_set1_ps(_value); }
+    static Float add(Float _a, Float _b) { return _mm_add_ps(_a, _b); }
+    static Float mulAdd(Float _a, Float _b, Float _c) { return _mm_add_ps(_mm_mul_ps(_a, _b), _c); }
+
+    static Mask all() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    static Mask andNotNegative(Mask _mask, Float _distance)
+    {
+        return _mm_and_ps(_mask, _mm_cmpge_ps(_distance, _mm_setzero_ps()));
+    }
+
+    static uint32_t bits(Mask _mask) { return static_cast<uint32_t>(_mm_movemask_ps(_mask)); }
+};
+
+#elif defined(SIMD_ARM_NEON)
+
+struct Lanes
+{
+    static constexpr size_t k_width = 4;
+
+    using Float = float32x4_t;
+    using Mask = uint32x4_t;
+
+    static Float load(const float* _p) { return vld1q_f32(_p); }
+    static Float broadcast(float _value) { return vdupq_n_f32(_value); }
+    static Float add(Float _a, Float _b) { return vaddq_f32(_a, _b); }
+    static Float mulAdd(Float _a, Float _b, Float _c) { return vmlaq_f32(_c, _a, _b); }
+
+    static Mask all() { return vdupq_n_u32(0xFFFFFFFFu); }
+    static Mask andNotNegative(Mask _mask, Float _distance)
+    {
+        return vandq_u32(_mask, vcgeq_f32(_distance, vdupq_n_f32(0.0f)));
+    }
+
+    static uint32_t bits(Mask _mask)
+    {
+        const uint32_t lanes[4] = {1, 2, 4, 8};
+        const uint32x4_t weighted = vandq_u32(_mask, vld1q_u32(lanes));
+#if defined(__aarch64__) || defined(_M_ARM64)
+        return vaddvq_u32(weighted);
+#else
+        const uint32x2_t sum = vpadd_u32(vget_low_u32(weighted), vget_high_u32(weighted));
+        return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#endif
+    }
+};
+
+#elif defined(SIMD_WASM_SIMD128)
+
+struct Lanes
+{
+    static constexpr size_t k_width = 4;
+
+    using Float = v128_t;
+    using Mask = v128_t;
+
+    static Float load(const float* _p) { return wasm_v128_load(_p); }
+    static Float broadcast(float _value) { return wasm_f32x4_splat(_value); }
+    static Float add(Float _a, Float _b) { return wasm_f32x4_add(_a, _b); }
+    static Float mulAdd(Float _a, Float _b, Float _c)
+    {
+        return wasm_f32x4_add(wasm_f32x4_mul(_a, _b), _c);
+    }
+
+    static Mask all() { return wasm_i32x4_splat(-1); }
+    static Mask andNotNegative(Mask _mask, Float _distance)
+    {
+        return wasm_v128_and(_mask, wasm_f32x4_ge(_distance, wasm_f32x4_splat(0.0f)));
+    }
+
+    static uint32_t bits(Mask _mask) { return static_cast<uint32_t>(wasm_i32x4_bitmask(_mask)); }
+};
+
+#else
+
+struct Lanes
+{
+    static constexpr size_t k_width = 1;
+
+    using Float = float;
+    using Mask = bool;
+
+    static Float load(const float* _p) { return *_p; }
+    static Float broadcast(float _value) { return _value; }
+    static Float add(Float _a, Float _b) { return _a + _b; }
+    static Float mulAdd(Float _a, Float _b, Float _c) { return _a * _b + _c; }
+
+    static Mask all() { return true; }
+    static Mask andNotNegative(Mask _mask, Float _distance) { return _mask && _distance >= 0.0f; }
+
+    static uint32_t bits(Mask _mask) { return _mask ? 1u : 0u; }
+};
+
+#endif
+
+// Appends the indices of the set lanes, without a branch per object.
+template <typename L = Lanes>
+uint32_t writeVisible(typename L::Mask _mask, uint32_t* _visible, uint32_t _first)
+{
+    if constexpr (requires { L::write(_mask, _visible, _first); })
+    {
+        return L::write(_mask, _visible, _first);
+    }
+    else
+    {
+        const uint32_t bits = L::bits(_mask);
+
+        uint32_t count = 0;
+        for (uint32_t lane = 0; lane < L::k_width; ++lane)
+        {
+            _visible[count] = _first + lane;
+            count += (bits >> lane) & 1u;
+        }
+
+        return count;
+    }
+}
+
+// The signed distances of the objects to each plane, grown by their radius (spheres) or by the
+// projection of their extents on its normal (boxes): outside when negative for a plane.
+template <bool Box>
+uint32_t cullKernel(const CullBatch& _batch)
+{
+    using Float = typename Lanes::Float;
+
+    const float* x = _batch.columns[0];
+    const float* y = _batch.columns[1];
+    const float* z = _batch.columns[2];
+    const float* a = _batch.columns[3];
+    const float* b = _batch.columns[4];
+    const float* c = _batch.columns[5];
+
+    // (a, b, c, d, |a|, |b|, |c|) of each plane, broadcast once
+    float planes[6][7];
+    Float lanes[6][7];
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        const float* source = _batch.planes + plane * 4;
+        for (int i = 0; i < 4; ++i) planes[plane][i] = source[i];
+        for (int i = 0; i < 3; ++i)
+        {
+            planes[plane][4 + i] = source[i] < 0.0f ? -source[i] : source[i];
+        }
+        for (int i = 0; i < 7; ++i) lanes[plane][i] = Lanes::broadcast(planes[plane][i]);
+    }
+
+    uint32_t count = 0;
+    size_t i = _batch.begin;
+
+    // the lanes of an object write past the count, never past the range: count <= i - begin
+    for (; i + Lanes::k_width <= _batch.end; i += Lanes::k_width)
+    {
+        const Float px = Lanes::load(x + i);
+        const Float py = Lanes::load(y + i);
+        const Float pz = Lanes::load(z + i);
+        const Float pa = Lanes::load(a + i);
+
+        Float pb{};
+        Float pc{};
+        if constexpr (Box)
+        {
+            pb = Lanes::load(b + i);
+            pc = Lanes::load(c + i);
+        }
+
+        typename Lanes::Mask mask = Lanes::all();
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const Float* n = lanes[plane];
+
+            Float distance;
+            if constexpr (Box)
+            {
+                distance = Lanes::mulAdd(n[6], pc, n[3]);
+                distance = Lanes::mulAdd(n[5], pb, distance);
+                distance = Lanes::mulAdd(n[4], pa, distance);
+            }
+            else
+            {
+                distance = Lanes::add(pa, n[3]);
+            }
+
+            distance = Lanes::mulAdd(n[2], pz, distance);
+            distance = Lanes::mulAdd(n[1], py, distance);
+            distance = Lanes::mulAdd(n[0], px, distance);
+            mask = Lanes::andNotNegative(mask, distance);
+        }
+
+        count += writeVisible(mask, _batch.visible + count,
+                              _batch.firstIndex + static_cast<uint32_t>(i));
+    }
+
+    for (; i < _batch.end; ++i)
+    {
+        bool visible = true;
+        for (int plane = 0; plane < 6 && visible; ++plane)
+        {
+            const float* n = planes[plane];
+
+            float distance = Box ? n[4] * a[i] + n[5] * b[i] + n[6] * c[i] + n[3] : a[i] + n[3];
+            distance += n[0] * x[i] + n[1] * y[i] + n[2] * z[i];
+            visible = distance >= 0.0f;
+        }
+
+        if (visible) _batch.visible[count++] = _batch.firstIndex + static_cast<uint32_t>(i);
+    }
+
+    return count;
+}
+
+inline CullKernels makeCullKernels()
+{
+    return {SIMD_LEVEL_NAME, &cullKernel<false>, &cullKernel<true>};
+}
+
+} // namespace
+
+} // namespace detail
+} // namespace graphics
+} // namespace mosaic
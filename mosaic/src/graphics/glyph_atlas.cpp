@@ -0,0 +1,234 @@
+#include "mosaic/graphics/glyph_atlas.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include "mosaic/exec/thread_pool.hpp"
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// Between the glyphs of a layer, so filtering never reads a neighbour
+static constexpr uint32_t k_glyphGutter = 1;
+
+// The heights of the shelves are multiples of it
+static constexpr uint32_t k_shelfRounding = 4;
+
+static uint64_t getGlyphKey(FontId _font, char32_t _codepoint) noexcept
+{
+    return (static_cast<uint64_t>(_font) << 32) | static_cast<uint64_t>(_codepoint);
+}
+
+GlyphAtlas::GlyphAtlas(const GlyphAtlasSettings& _settings)
+    : m_settings(_settings),
+      m_shelves(_settings.layers)
+{
+    if (_settings.layers == 0 || !(_settings.pixelHeight > 0.0f) || _settings.spread == 0)
+    {
+        throw std::invalid_argument("a glyph atlas needs layers, a pixel height and a spread");
+    }
+
+    const float glyphHeight = _settings.pixelHeight + 2.0f * _settings.spread + k_glyphGutter;
+    if (glyphHeight > static_cast<float>(_settings.extent))
+    {
+        throw std::invalid_argument("the glyphs of the atlas do not fit in a layer");
+    }
+
+    m_settings.maxPending = std::max(m_settings.maxPending, 1u);
+}
+
+GlyphAtlas::~GlyphAtlas() = default;
+
+FontId GlyphAtlas::addFont(std::shared_ptr<const GlyphSource> _font)
+{
+    m_fonts.push_back(std::move(_font));
+    return static_cast<FontId>(m_fonts.size() - 1);
+}
+
+const AtlasGlyph& GlyphAtlas::find(FontId _font, char32_t _codepoint)
+{
+    auto [it, inserted] = m_glyphs.try_emplace(getGlyphKey(_font, _codepoint));
+    if (inserted)
+    {
+        it->second.advance = m_fonts[_font]->getAdvance(_codepoint, m_settings.pixelHeight);
+        m_pending.push_back({_font, _codepoint, std::nullopt, false});
+    }
+
+    return it->second;
+}
+
+uint32_t GlyphAtlas::update(exec::ThreadPool* _pool)
+{
+    uint32_t resident = 0;
+    const auto complete = [&](Pending& _pending, auto&& _rasterize)
+    {
+        std::optional<GlyphBitmap> bitmap;
+        try
+        {
+            bitmap = _rasterize();
+        }
+        catch (const std::exception& _error)
+        {
+            MOSAIC_ERROR("Failed to rasterize glyph U+{:04X}: {}",
+                         static_cast<uint32_t>(_pending.codepoint), _error.what());
+        }
+
+        if (place(_pending, std::move(bitmap))) ++resident;
+        _pending.done = true;
+    };
+
+    size_t rasterizing = std::ranges::count_if(m_pending, [](const Pending& _pending)
+                                               { return _pending.future.has_value(); });
+
+    // the new requests, started in order up to the limit
+    for (Pending& pending : m_pending)
+    {
+        if (pending.future || pending.done) continue;
+
+        std::shared_ptr<const GlyphSource> font = m_fonts[pending.font];
+        const float pixelHeight = m_settings.pixelHeight;
+        const uint32_t spread = m_settings.spread;
+
+        if (_pool && rasterizing < m_settings.maxPending)
+        {
+            pending.future = _pool->enqueueToGlobal(
+                exec::TaskPriority::background,
+                [font, codepoint = pending.codepoint, pixelHeight, spread]()
+                { return font->rasterize(codepoint, pixelHeight, spread); });
+
+            if (pending.future)
+            {
+                ++rasterizing;
+                continue;
+            }
+        }
+        else if (_pool)
+        {
+            break;
+        }
+
+        // no pool, or it refused the task
+        complete(pending,
+                 [&]() { return font->rasterize(pending.codepoint, pixelHeight, spread); });
+    }
+
+    for (Pending& pending : m_pending)
+    {
+        if (!pending.future || !pending.future->isReady()) continue;
+
+        complete(pending, [&]() { return pending.future->get(); });
+        pending.future.reset();
+    }
+
+    std::erase_if(m_pending, [](const Pending& _pending) { return _pending.done; });
+
+    return resident;
+}
+
+void GlyphAtlas::flush(exec::ThreadPool* _pool)
+{
+    while (!m_pending.empty())
+    {
+        update(_pool);
+
+        for (Pending& pending : m_pending)
+        {
+            if (pending.future) pending.future->wait();
+        }
+    }
+}
+
+void GlyphAtlas::clearUploads() noexcept
+{
+    m_uploads.clear();
+    m_uploadData.clear();
+}
+
+bool GlyphAtlas::place(const Pending& _pending, std::optional<GlyphBitmap> _bitmap)
+{
+    // no outline, or it failed: only advanced over
+    if (!_bitmap || _bitmap->width == 0 || _bitmap->height == 0) return false;
+
+    uint32_t layer = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    if (!allocate(_bitmap->width + k_glyphGutter, _bitmap->height + k_glyphGutter, layer, x, y))
+    {
+        if (!m_full)
+        {
+            MOSAIC_WARN("The glyph atlas is full, the glyphs from U+{:04X} on are not drawn",
+                        static_cast<uint32_t>(_pending.codepoint));
+            m_full = true;
+        }
+        return false;
+    }
+
+    const float extent = static_cast<float>(m_settings.extent);
+
+    AtlasGlyph& glyph = m_glyphs[getGlyphKey(_pending.font, _pending.codepoint)];
+    glyph.uv = {x / extent, y / extent, (x + _bitmap->width) / extent,
+                (y + _bitmap->height) / extent};
+    glyph.layer = layer;
+    glyph.left = _bitmap->left;
+    glyph.top = _bitmap->top;
+    glyph.width = static_cast<float>(_bitmap->width);
+    glyph.height = static_cast<float>(_bitmap->height);
+    glyph.resident = true;
+
+    GlyphUpload& upload = m_uploads.emplace_back();
+    upload.layer = layer;
+    upload.x = x;
+    upload.y = y;
+    upload.width = _bitmap->width;
+    upload.height = _bitmap->height;
+    upload.offset = m_uploadData.size();
+
+    m_uploadData.insert(m_uploadData.end(), _bitmap->pixels.begin(), _bitmap->pixels.end());
+    return true;
+}
+
+bool GlyphAtlas::allocate(uint32_t _width, uint32_t _height, uint32_t& _layer, uint32_t& _x,
+                          uint32_t& _y)
+{
+    if (_width > m_settings.extent || _height > m_settings.extent) return false;
+
+    for (uint32_t layer = 0; layer < m_settings.layers; ++layer)
+    {
+        std::vector<Shelf>& shelves = m_shelves[layer];
+
+        // the shelf the glyph wastes the least height of
+        Shelf* best = nullptr;
+        for (Shelf& shelf : shelves)
+        {
+            if (shelf.height < _height || shelf.x + _width > m_settings.extent) continue;
+            if (!best || shelf.height < best->height) best = &shelf;
+        }
+
+        if (!best)
+        {
+            const uint32_t top = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+            if (top + _height > m_settings.extent) continue;
+
+            // rounded up, so the glyphs of about the same height share it
+            const uint32_t height =
+                std::min((_height + k_shelfRounding - 1) / k_shelfRounding * k_shelfRounding,
+                         m_settings.extent - top);
+            best = &shelves.emplace_back(Shelf{top, height, 0});
+        }
+
+        _layer = layer;
+        _x = best->x;
+        _y = best->y;
+        best->x += _width;
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace graphics
+} // namespace mosaic
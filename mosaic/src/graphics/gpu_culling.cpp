@@ -0,0 +1,171 @@
+#include "mosaic/graphics/gpu_culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mosaic/graphics/occlusion_culling.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// Row _row of a column-major matrix
+static std::array<float, 4> getRow(Matrix4 _matrix, int _row) noexcept
+{
+    return {_matrix[_row], _matrix[4 + _row], _matrix[8 + _row], _matrix[12 + _row]};
+}
+
+Frustum extractFrustum(Matrix4 _viewProjection) noexcept
+{
+    const std::array<float, 4> row0 = getRow(_viewProjection, 0);
+    const std::array<float, 4> row1 = getRow(_viewProjection, 1);
+    const std::array<float, 4> row2 = getRow(_viewProjection, 2);
+    const std::array<float, 4> row3 = getRow(_viewProjection, 3);
+
+    Frustum frustum;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        frustum.planes[0][i] = row3[i] + row0[i]; // -w <= x
+        frustum.planes[1][i] = row3[i] - row0[i]; // x <= w
+        frustum.planes[2][i] = row3[i] + row1[i]; // -w <= y
+        frustum.planes[3][i] = row3[i] - row1[i]; // y <= w
+        frustum.planes[4][i] = row2[i];           // 0 <= z
+        frustum.planes[5][i] = row3[i] - row2[i]; // z <= w
+    }
+
+    for (std::array<float, 4>& plane : frustum.planes)
+    {
+        const float length =
+            std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            for (float& value : plane) value /= length;
+        }
+    }
+
+    return frustum;
+}
+
+bool isSphereInFrustum(const Frustum& _frustum, const BoundingSphere& _sphere) noexcept
+{
+    for (const std::array<float, 4>& plane : _frustum.planes)
+    {
+        const float distance = plane[0] * _sphere.center[0] + plane[1] * _sphere.center[1] +
+                               plane[2] * _sphere.center[2] + plane[3];
+
+        if (distance < -_sphere.radius) return false;
+    }
+
+    return true;
+}
+
+BoundingSphere transformSphere(Matrix4 _world, const BoundingSphere& _local) noexcept
+{
+    BoundingSphere sphere;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        sphere.center[i] = _world[i] * _local.center[0] + _world[4 + i] * _local.center[1] +
+                           _world[8 + i] * _local.center[2] + _world[12 + i];
+    }
+
+    float scale = 0.0f;
+    for (int column = 0; column < 3; ++column)
+    {
+        const float* axis = &_world[column * 4];
+        scale = std::max(scale, axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    }
+
+    sphere.radius = _local.radius * std::sqrt(scale);
+
+    return sphere;
+}
+
+std::optional<std::array<float, 4>> projectSphere(const BoundingSphere& _viewSphere,
+                                                  float _zNear, float _p00, float _p11) noexcept
+{
+    // in front of the camera along +Z
+    const float x = _viewSphere.center[0];
+    const float y = _viewSphere.center[1];
+    const float z = -_viewSphere.center[2];
+    const float r = _viewSphere.radius;
+
+    if (z < r + _zNear) return std::nullopt;
+
+    // the tangents from the eye to the circle of the sphere in the xz and yz planes
+    const float tx = std::sqrt(x * x + z * z - r * r);
+    const float minX = (tx * x - r * z) / (r * x + tx * z);
+    const float maxX = (tx * x + r * z) / (tx * z - r * x);
+
+    const float ty = std::sqrt(y * y + z * z - r * r);
+    const float minY = (ty * y - r * z) / (r * y + ty * z);
+    const float maxY = (ty * y + r * z) / (ty * z - r * y);
+
+    // clip space to uv, y down
+    const float u0 = minX * _p00 * 0.5f + 0.5f;
+    const float u1 = maxX * _p00 * 0.5f + 0.5f;
+    const float v0 = maxY * _p11 * -0.5f + 0.5f;
+    const float v1 = minY * _p11 * -0.5f + 0.5f;
+
+    return std::array<float, 4>{std::min(u0, u1), std::min(v0, v1), std::max(u0, u1),
+                                std::max(v0, v1)};
+}
+
+uint32_t buildIndirectCommands(std::span<const CullDraw> _draws,
+                               std::span<IndexedIndirectCommand> _commands) noexcept
+{
+    uint32_t firstInstance = 0;
+
+    for (size_t i = 0; i < _draws.size() && i < _commands.size(); ++i)
+    {
+        const CullDraw& draw = _draws[i];
+        _commands[i] = {draw.indexCount, 0, draw.firstIndex, draw.vertexOffset, firstInstance};
+
+        firstInstance += draw.maxInstances;
+    }
+
+    return firstInstance;
+}
+
+uint32_t cullInstances(const Frustum& _frustum, std::span<const CullInstance> _instances,
+                       std::span<const CullDraw> _draws,
+                       std::span<IndexedIndirectCommand> _commands,
+                       std::span<uint32_t> _visibleInstances,
+                       std::span<IndexedIndirectCommand> _compacted,
+                       const OcclusionBuffer* _occlusion) noexcept
+{
+    for (const CullInstance& instance : _instances)
+    {
+        if (instance.drawIndex >= _commands.size()) continue;
+        if (!isSphereInFrustum(_frustum, instance.bounds)) continue;
+        if (_occlusion && _occlusion->isOccluded(instance.bounds)) continue;
+
+        // the shader increments with an atomic, past maxInstances only the count grows
+        IndexedIndirectCommand& command = _commands[instance.drawIndex];
+        const uint32_t slot = command.instanceCount++;
+
+        if (slot < _draws[instance.drawIndex].maxInstances &&
+            command.firstInstance + slot < _visibleInstances.size())
+        {
+            _visibleInstances[command.firstInstance + slot] = instance.instanceIndex;
+        }
+    }
+
+    uint32_t drawCount = 0;
+
+    for (size_t i = 0; i < _commands.size() && i < _draws.size(); ++i)
+    {
+        if (_commands[i].instanceCount == 0 || drawCount >= _compacted.size()) continue;
+
+        IndexedIndirectCommand& compacted = _compacted[drawCount++];
+        compacted = _commands[i];
+        compacted.instanceCount = std::min(compacted.instanceCount, _draws[i].maxInstances);
+    }
+
+    return drawCount;
+}
+
+} // namespace graphics
+} // namespace mosaic
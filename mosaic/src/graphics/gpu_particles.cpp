@@ -0,0 +1,39 @@
+#include "mosaic/graphics/gpu_particles.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+uint32_t getParticleSpawnCount(float _rate, float _deltaTime, float& _carry) noexcept
+{
+    if (!(_rate > 0.0f) || !(_deltaTime > 0.0f))
+    {
+        _carry = 0.0f;
+        return 0;
+    }
+
+    const float owed = _carry + _rate * _deltaTime;
+    const float count = std::floor(owed);
+    _carry = owed - count;
+
+    // far past any pool, but a count a uint32_t holds
+    return static_cast<uint32_t>(std::min(count, 1.0e9f));
+}
+
+uint32_t getParticleSortKey(float _distance, float _sortDistance) noexcept
+{
+    constexpr uint32_t maxKey = (1u << k_particleSortBits) - 1;
+
+    // a negative or NaN distance sorts as the nearest
+    const float t = _sortDistance > 0.0f ? _distance / _sortDistance : 0.0f;
+    const float clamped = t > 0.0f ? std::min(t, 1.0f) : 0.0f;
+
+    return maxKey - static_cast<uint32_t>(clamped * static_cast<float>(maxKey));
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,86 @@
+#include "mosaic/graphics/input_latency.hpp"
+
+#include <algorithm>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// Nearest rank: the smallest sample at least _percent of them do not exceed
+static InputLatency::Clock::duration rank(const InputLatency::Clock::duration* _sorted,
+                                          uint32_t _count, uint32_t _percent) noexcept
+{
+    const uint32_t index = (_count * _percent + 99) / 100;
+    return _sorted[std::max(index, 1u) - 1];
+}
+
+void InputLatency::consumeInput(Clock::time_point _input) noexcept
+{
+    m_input = m_input ? std::min(*m_input, _input) : _input;
+}
+
+void InputLatency::submitFrame(uint64_t _frame) noexcept
+{
+    if (!m_input) return;
+
+    // more frames than tracked are late enough to be an outlier, the oldest is forgotten
+    if (m_pendingCount == k_maxPendingFrames)
+    {
+        m_firstPending = (m_firstPending + 1) % k_maxPendingFrames;
+        --m_pendingCount;
+    }
+
+    m_pending[(m_firstPending + m_pendingCount) % k_maxPendingFrames] = {_frame, *m_input};
+    ++m_pendingCount;
+
+    m_input.reset();
+}
+
+void InputLatency::presentFrame(uint64_t _frame, Clock::time_point _time) noexcept
+{
+    bool measured = false;
+
+    while (m_pendingCount > 0 && m_pending[m_firstPending].frame <= _frame)
+    {
+        const Clock::duration latency =
+            std::max(_time - m_pending[m_firstPending].input, Clock::duration::zero());
+
+        m_samples[m_nextSample] = latency;
+        m_nextSample = (m_nextSample + 1) % k_sampleCount;
+        m_sampleCount = std::min(m_sampleCount + 1, k_sampleCount);
+        ++m_measuredCount;
+
+        m_firstPending = (m_firstPending + 1) % k_maxPendingFrames;
+        --m_pendingCount;
+        measured = true;
+    }
+
+    if (measured) updatePercentiles();
+}
+
+void InputLatency::discardFrames() noexcept
+{
+    m_firstPending = 0;
+    m_pendingCount = 0;
+}
+
+std::optional<uint64_t> InputLatency::getPendingFrame() const noexcept
+{
+    if (m_pendingCount == 0) return std::nullopt;
+
+    return m_pending[m_firstPending].frame;
+}
+
+void InputLatency::updatePercentiles() noexcept
+{
+    std::array<Clock::duration, k_sampleCount> sorted = m_samples;
+    std::sort(sorted.begin(), sorted.begin() + m_sampleCount);
+
+    m_percentiles.p50 = rank(sorted.data(), m_sampleCount, 50);
+    m_percentiles.p95 = rank(sorted.data(), m_sampleCount, 95);
+    m_percentiles.p99 = rank(sorted.data(), m_sampleCount, 99);
+}
+
+} // namespace graphics
+} // namespace mosaic
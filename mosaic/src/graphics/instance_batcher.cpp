@@ -0,0 +1,68 @@
+#include "mosaic/graphics/instance_batcher.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include <pieces/memory/frame_arena.hpp>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+void InstanceBatcher::build()
+{
+    m_instances.resize(m_pending.size());
+    m_batches.clear();
+
+    // the temporaries of the frame, released as the build returns
+    pieces::FrameArena& arena = pieces::FrameArena::local();
+    auto scope = arena.scope();
+
+    // one batch per key, its instance count first
+    std::pmr::unordered_map<uint64_t, uint32_t> indices(arena.getResource());
+    std::pmr::vector<uint64_t> keys(arena.getResource());
+
+    for (const Pending& pending : m_pending)
+    {
+        auto [it, inserted] = indices.try_emplace(pending.key, 0);
+        if (inserted) keys.push_back(pending.key);
+        ++it->second;
+    }
+
+    std::sort(keys.begin(), keys.end());
+    m_batches.reserve(keys.size());
+
+    // the counts become the start of the ranges, then the instances are scattered in order
+    uint32_t offset = 0;
+    for (const uint64_t key : keys)
+    {
+        uint32_t& slot = indices[key];
+        const uint32_t count = slot;
+
+        InstanceBatch& batch = m_batches.emplace_back();
+        batch.mesh = static_cast<uint32_t>(key >> 32);
+        batch.material = static_cast<uint32_t>(key) & k_maxMaterial;
+        batch.firstInstance = offset;
+        batch.instanceCount = count;
+        batch.lod = static_cast<uint8_t>(key >> 24);
+
+        slot = offset;
+        offset += count;
+    }
+
+    for (const Pending& pending : m_pending) m_instances[indices[pending.key]++] = pending.data;
+
+    m_pending.clear();
+}
+
+void InstanceBatcher::clear() noexcept
+{
+    m_pending.clear();
+    m_instances.clear();
+    m_batches.clear();
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,382 @@
+#include "mosaic/graphics/ktx2.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#ifdef MOSAIC_HAS_BASISU
+#include <mutex>
+
+#include <basisu/transcoder/basisu_transcoder.h>
+
+#include "mosaic/exec/parallel_for.hpp"
+#endif
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static constexpr std::array<uint8_t, 12> k_identifier = {0xAB, 'K',  'T',  'X',  ' ',  '2',
+                                                         '0',  0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+// The header (identifier, 9 fields), the index, then the level index
+static constexpr size_t k_headerSize = 48;
+static constexpr size_t k_indexSize = 32;
+static constexpr size_t k_levelSize = 24;
+
+// Of the data format descriptor (Khronos Data Format, basic block)
+static constexpr uint8_t k_colorModelETC1S = 163;
+static constexpr uint8_t k_colorModelUASTC = 166;
+static constexpr uint8_t k_transferSRGB = 2;
+static constexpr uint8_t k_channelUASTCRGBA = 3;
+static constexpr uint8_t k_channelUASTCRRRG = 5;
+
+static constexpr uint32_t k_supercompressionBasisLZ = 1;
+
+// The file is little endian, as are the platforms of the engine
+template <typename T>
+static T read(std::span<const uint8_t> _file, size_t _offset)
+{
+    T value;
+    std::memcpy(&value, _file.data() + _offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+static pieces::Result<T, std::string> fail(std::string _error)
+{
+    return pieces::Err<T, std::string>("invalid KTX2 file: " + std::move(_error));
+}
+
+// The format of a vkFormat, and whether it is sRGB
+static std::optional<std::pair<TextureFormat, bool>> getTextureFormat(uint32_t _vkFormat)
+{
+    switch (_vkFormat)
+    {
+        case 37: return std::pair{TextureFormat::RGBA8, false};      // R8G8B8A8_UNORM
+        case 43: return std::pair{TextureFormat::RGBA8, true};       // R8G8B8A8_SRGB
+        case 133: return std::pair{TextureFormat::BC1, false};       // BC1_RGBA_UNORM_BLOCK
+        case 134: return std::pair{TextureFormat::BC1, true};        // BC1_RGBA_SRGB_BLOCK
+        case 137: return std::pair{TextureFormat::BC3, false};       // BC3_UNORM_BLOCK
+        case 138: return std::pair{TextureFormat::BC3, true};        // BC3_SRGB_BLOCK
+        case 141: return std::pair{TextureFormat::BC5, false};       // BC5_UNORM_BLOCK
+        case 145: return std::pair{TextureFormat::BC7, false};       // BC7_UNORM_BLOCK
+        case 146: return std::pair{TextureFormat::BC7, true};        // BC7_SRGB_BLOCK
+        case 147: return std::pair{TextureFormat::ETC2RGB8, false};  // ETC2_R8G8B8_UNORM_BLOCK
+        case 148: return std::pair{TextureFormat::ETC2RGB8, true};   // ETC2_R8G8B8_SRGB_BLOCK
+        case 151: return std::pair{TextureFormat::ETC2RGBA8, false}; // ETC2_R8G8B8A8_UNORM_BLOCK
+        case 152: return std::pair{TextureFormat::ETC2RGBA8, true};  // ETC2_R8G8B8A8_SRGB_BLOCK
+        case 157: return std::pair{TextureFormat::ASTC4x4, false};   // ASTC_4x4_UNORM_BLOCK
+        case 158: return std::pair{TextureFormat::ASTC4x4, true};    // ASTC_4x4_SRGB_BLOCK
+        default: return std::nullopt;
+    }
+}
+
+static bool isSupported(std::span<const TextureFormat> _supported, TextureFormat _format)
+{
+    return std::ranges::find(_supported, _format) != _supported.end();
+}
+
+bool isKtx2(std::span<const uint8_t> _file) noexcept
+{
+    return _file.size() >= k_identifier.size() &&
+           std::equal(k_identifier.begin(), k_identifier.end(), _file.begin());
+}
+
+pieces::Result<Ktx2Info, std::string> parseKtx2(std::span<const uint8_t> _file)
+{
+    if (!isKtx2(_file) || _file.size() < k_headerSize + k_indexSize)
+    {
+        return fail<Ktx2Info>("no KTX2 header");
+    }
+
+    const uint32_t vkFormat = read<uint32_t>(_file, 12);
+    const uint32_t width = read<uint32_t>(_file, 20);
+    const uint32_t height = read<uint32_t>(_file, 24);
+    const uint32_t depth = read<uint32_t>(_file, 28);
+    const uint32_t layers = read<uint32_t>(_file, 32);
+    const uint32_t faces = read<uint32_t>(_file, 36);
+    const uint32_t levelCount = read<uint32_t>(_file, 40);
+
+    if (width == 0 || height == 0 || depth != 0 || layers != 0 || faces != 1)
+    {
+        return fail<Ktx2Info>("not a 2D texture");
+    }
+
+    Ktx2Info info;
+    info.width = width;
+    info.height = height;
+    info.supercompression = read<uint32_t>(_file, 44);
+
+    // no levels: the mips are to be generated, which compressed formats cannot be
+    info.mipLevels = std::max(levelCount, 1u);
+    if (info.mipLevels > 32 || (std::max(width, height) >> (info.mipLevels - 1)) == 0)
+    {
+        return fail<Ktx2Info>("too many levels");
+    }
+
+    const size_t levelIndexEnd = k_headerSize + k_indexSize + size_t{info.mipLevels} * k_levelSize;
+    if (_file.size() < levelIndexEnd) return fail<Ktx2Info>("truncated level index");
+
+    for (uint32_t level = 0; level < info.mipLevels; ++level)
+    {
+        const size_t entry = k_headerSize + k_indexSize + size_t{level} * k_levelSize;
+        const uint64_t offset = read<uint64_t>(_file, entry);
+        const uint64_t size = read<uint64_t>(_file, entry + 8);
+
+        if (offset > _file.size() || size > _file.size() - offset)
+        {
+            return fail<Ktx2Info>("level " + std::to_string(level) + " out of the file");
+        }
+
+        info.levels.push_back({offset, size});
+    }
+
+    // The data format descriptor: its total size, then the basic block
+    const uint64_t dfdOffset = read<uint32_t>(_file, k_headerSize);
+    const uint64_t dfdSize = read<uint32_t>(_file, k_headerSize + 4);
+
+    if (dfdSize < 4 + 24 || dfdOffset + dfdSize > _file.size())
+    {
+        return fail<Ktx2Info>("no data format descriptor");
+    }
+
+    const size_t block = dfdOffset + 4;
+    const uint16_t blockSize = read<uint16_t>(_file, block + 6);
+    if (blockSize < 24 || blockSize > dfdSize - 4) return fail<Ktx2Info>("invalid descriptor");
+
+    const uint8_t colorModel = _file[block + 8];
+    const uint32_t sampleCount = (blockSize - 24u) / 16u;
+    auto getChannel = [&](uint32_t _sample) { return _file[block + 24 + _sample * 16 + 3] & 0xF; };
+
+    info.srgb = _file[block + 10] == k_transferSRGB;
+
+    if (vkFormat != 0)
+    {
+        if (info.supercompression != 0)
+        {
+            return pieces::Err<Ktx2Info, std::string>(
+                "supercompressed KTX2 textures of a native format are not supported");
+        }
+
+        if (auto format = getTextureFormat(vkFormat))
+        {
+            info.format = format->first;
+            info.srgb = format->second;
+        }
+
+        info.encoding = Ktx2Encoding::Native;
+        info.alpha = info.format != TextureFormat::ETC2RGB8 && info.format != TextureFormat::BC5;
+    }
+    else if (colorModel == k_colorModelETC1S)
+    {
+        if (info.supercompression != k_supercompressionBasisLZ)
+        {
+            return fail<Ktx2Info>("ETC1S without BasisLZ");
+        }
+
+        // a slice of RGB, one of alpha
+        info.encoding = Ktx2Encoding::ETC1S;
+        info.alpha = sampleCount == 2;
+    }
+    else if (colorModel == k_colorModelUASTC)
+    {
+        info.encoding = Ktx2Encoding::UASTC;
+        info.alpha = sampleCount > 0 && (getChannel(0) == k_channelUASTCRGBA ||
+                                         getChannel(0) == k_channelUASTCRRRG);
+    }
+    else
+    {
+        return fail<Ktx2Info>("undefined format");
+    }
+
+    return pieces::Ok<Ktx2Info, std::string>(std::move(info));
+}
+
+TextureFormat chooseTranscodeFormat(std::span<const TextureFormat> _supported,
+                                    bool _alpha) noexcept
+{
+    // by quality: ASTC and BC7 keep the most of UASTC, ETC2 is what ETC1S maps to at no cost
+    const TextureFormat etc2 = _alpha ? TextureFormat::ETC2RGBA8 : TextureFormat::ETC2RGB8;
+    const TextureFormat bc = _alpha ? TextureFormat::BC3 : TextureFormat::BC1;
+
+    for (TextureFormat format : {TextureFormat::ASTC4x4, TextureFormat::BC7, etc2, bc})
+    {
+        if (isSupported(_supported, format)) return format;
+    }
+
+    return TextureFormat::RGBA8;
+}
+
+// The format the mips of the file are given in, an error if the device cannot sample them
+static pieces::Result<TextureFormat, std::string> getDecodedFormat(
+    const Ktx2Info& _info, std::span<const TextureFormat> _supported)
+{
+    if (_info.encoding != Ktx2Encoding::Native)
+    {
+#ifdef MOSAIC_HAS_BASISU
+        return pieces::Ok<TextureFormat, std::string>(
+            chooseTranscodeFormat(_supported, _info.alpha));
+#else
+        return pieces::Err<TextureFormat, std::string>(
+            "Basis Universal KTX2 texture, but the basisu transcoder is not available");
+#endif
+    }
+
+    if (!_info.format)
+    {
+        return pieces::Err<TextureFormat, std::string>("unsupported KTX2 vkFormat");
+    }
+
+    if (!_supported.empty() && !isSupported(_supported, *_info.format))
+    {
+        return pieces::Err<TextureFormat, std::string>(
+            "the KTX2 texture format is not supported by the device");
+    }
+
+    return pieces::Ok<TextureFormat, std::string>(TextureFormat{*_info.format});
+}
+
+#ifdef MOSAIC_HAS_BASISU
+static basist::transcoder_texture_format getTranscoderFormat(TextureFormat _format)
+{
+    switch (_format)
+    {
+        case TextureFormat::ASTC4x4: return basist::transcoder_texture_format::cTFASTC_4x4_RGBA;
+        case TextureFormat::BC7: return basist::transcoder_texture_format::cTFBC7_RGBA;
+        case TextureFormat::ETC2RGBA8: return basist::transcoder_texture_format::cTFETC2_RGBA;
+        case TextureFormat::ETC2RGB8: return basist::transcoder_texture_format::cTFETC1_RGB;
+        case TextureFormat::BC3: return basist::transcoder_texture_format::cTFBC3_RGBA;
+        case TextureFormat::BC1: return basist::transcoder_texture_format::cTFBC1_RGB;
+        default: return basist::transcoder_texture_format::cTFRGBA32;
+    }
+}
+
+// Transcodes the levels of the chain in parallel, each with its own state
+static pieces::Result<TextureMipChain, std::string> transcode(std::span<const uint8_t> _file,
+                                                              TextureMipChain&& _chain)
+{
+    static std::once_flag s_init;
+    std::call_once(s_init, [] { basist::basisu_transcoder_init(); });
+
+    basist::ktx2_transcoder transcoder;
+    if (!transcoder.init(_file.data(), static_cast<uint32_t>(_file.size())) ||
+        !transcoder.start_transcoding())
+    {
+        return pieces::Err<TextureMipChain, std::string>("failed to start transcoding KTX2 file");
+    }
+
+    const basist::transcoder_texture_format format = getTranscoderFormat(_chain.format);
+    const uint32_t bytesPerBlock = getTextureFormatInfo(_chain.format).bytesPerBlock;
+    std::vector<uint8_t> failed(_chain.mips.size(), 0);
+
+    exec::parallelFor(size_t{0}, _chain.mips.size(), size_t{1},
+                      [&](size_t _i)
+                      {
+                          const TextureMip& mip = _chain.mips[_i];
+                          basist::ktx2_transcoder_state state;
+
+                          failed[_i] = !transcoder.transcode_image_level(
+                              _chain.firstMip + static_cast<uint32_t>(_i), 0, 0,
+                              _chain.texels.data() + mip.offset,
+                              static_cast<uint32_t>(mip.size / bytesPerBlock), format, 0, 0, 0,
+                              -1, -1, &state);
+                      });
+
+    if (std::ranges::find(failed, 1) != failed.end())
+    {
+        return pieces::Err<TextureMipChain, std::string>("failed to transcode KTX2 level");
+    }
+
+    return pieces::Ok<TextureMipChain, std::string>(std::move(_chain));
+}
+#endif
+
+pieces::Result<TextureMipChain, std::string> decodeKtx2(std::span<const uint8_t> _file,
+                                                        uint32_t _firstMip,
+                                                        std::span<const TextureFormat> _supported)
+{
+    auto parsed = parseKtx2(_file);
+    if (parsed.isErr())
+    {
+        return pieces::Err<TextureMipChain, std::string>(std::move(parsed.error()));
+    }
+
+    const Ktx2Info& info = parsed.unwrap();
+
+    auto format = getDecodedFormat(info, _supported);
+    if (format.isErr())
+    {
+        return pieces::Err<TextureMipChain, std::string>(std::move(format.error()));
+    }
+
+    TextureMipChain chain;
+    chain.format = format.unwrap();
+    chain.srgb = info.srgb;
+    chain.firstMip = std::min(_firstMip, info.mipLevels - 1);
+
+    size_t size = 0;
+    for (uint32_t mip = chain.firstMip; mip < info.mipLevels; ++mip)
+    {
+        TextureMip& level = chain.mips.emplace_back();
+        level.width = std::max(info.width >> mip, 1u);
+        level.height = std::max(info.height >> mip, 1u);
+        level.offset = size;
+        level.size = getTextureMipSize(chain.format, level.width, level.height);
+        size += level.size;
+    }
+
+    chain.texels.resize(size);
+
+#ifdef MOSAIC_HAS_BASISU
+    if (info.encoding != Ktx2Encoding::Native) return transcode(_file, std::move(chain));
+#endif
+
+    // Native: the levels as they are, tightly packed in the file
+    for (size_t i = 0; i < chain.mips.size(); ++i)
+    {
+        const TextureMip& mip = chain.mips[i];
+        const Ktx2Level& level = info.levels[chain.firstMip + i];
+
+        if (level.size < mip.size)
+        {
+            return fail<TextureMipChain>("level smaller than its extent");
+        }
+
+        std::memcpy(chain.texels.data() + mip.offset, _file.data() + level.offset, mip.size);
+    }
+
+    return pieces::Ok<TextureMipChain, std::string>(std::move(chain));
+}
+
+pieces::Result<TextureDescription, std::string> readKtx2Description(
+    std::span<const uint8_t> _file, std::span<const TextureFormat> _supported)
+{
+    auto parsed = parseKtx2(_file);
+    if (parsed.isErr())
+    {
+        return pieces::Err<TextureDescription, std::string>(std::move(parsed.error()));
+    }
+
+    const Ktx2Info& info = parsed.unwrap();
+
+    auto format = getDecodedFormat(info, _supported);
+    if (format.isErr())
+    {
+        return pieces::Err<TextureDescription, std::string>(std::move(format.error()));
+    }
+
+    TextureDescription description = {};
+    description.width = info.width;
+    description.height = info.height;
+    description.mipLevels = info.mipLevels;
+    description.format = format.unwrap();
+    description.usage = TextureUsage::Sampled;
+
+    return pieces::Ok<TextureDescription, std::string>(std::move(description));
+}
+
+} // namespace graphics
+} // namespace mosaic
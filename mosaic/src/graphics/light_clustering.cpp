@@ -0,0 +1,227 @@
+#include "mosaic/graphics/light_clustering.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "mosaic/exec/parallel_for.hpp"
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static std::array<float, 4> normalizePlane(float _a, float _b, float _c, float _d) noexcept
+{
+    const float length = std::sqrt(_a * _a + _b * _b + _c * _c);
+    return {_a / length, _b / length, _c / length, _d / length};
+}
+
+// The view space planes of the NDC rectangle [_x0, _x1] x [_y0, _y1]: ndc.x = p00 * x / -z, so
+// x0 <= ndc.x is p00 * x + x0 * z >= 0, the depth planes left unset
+static Frustum getTileFrustum(float _p00, float _p11, float _x0, float _x1, float _y0,
+                              float _y1) noexcept
+{
+    Frustum frustum;
+    frustum.planes[0] = normalizePlane(_p00, 0.0f, _x0, 0.0f);
+    frustum.planes[1] = normalizePlane(-_p00, 0.0f, -_x1, 0.0f);
+    frustum.planes[2] = normalizePlane(0.0f, _p11, _y0, 0.0f);
+    frustum.planes[3] = normalizePlane(0.0f, -_p11, -_y1, 0.0f);
+
+    return frustum;
+}
+
+void LightClustering::setProjection(const ClusterGrid& _grid, float _p00, float _p11,
+                                    float _zNear, float _zFar, uint32_t _width, uint32_t _height)
+{
+    if (_grid.size() == 0 || _width == 0 || _height == 0)
+    {
+        throw std::invalid_argument("Light clustering: empty cluster grid or framebuffer!");
+    }
+
+    if (!(_zNear > 0.0f && _zNear < _zFar) || _p00 == 0.0f || _p11 == 0.0f)
+    {
+        throw std::invalid_argument("Light clustering: not a perspective projection!");
+    }
+
+    m_grid = _grid;
+
+    const float depthRange = std::log(_zFar / _zNear);
+
+    m_uniforms = {};
+    m_uniforms.tileScaleX = static_cast<float>(_grid.tilesX) / static_cast<float>(_width);
+    m_uniforms.tileScaleY = static_cast<float>(_grid.tilesY) / static_cast<float>(_height);
+    m_uniforms.sliceScale = static_cast<float>(_grid.slices) / depthRange;
+    m_uniforms.sliceBias = -static_cast<float>(_grid.slices) * std::log(_zNear) / depthRange;
+    m_uniforms.tilesX = _grid.tilesX;
+    m_uniforms.tilesY = _grid.tilesY;
+    m_uniforms.slices = _grid.slices;
+
+    m_tileFrustums.resize(_grid.tilesX * _grid.tilesY);
+    for (uint32_t y = 0; y < _grid.tilesY; ++y)
+    {
+        const float y0 = -1.0f + 2.0f * static_cast<float>(y) / static_cast<float>(_grid.tilesY);
+        const float y1 =
+            -1.0f + 2.0f * static_cast<float>(y + 1) / static_cast<float>(_grid.tilesY);
+
+        for (uint32_t x = 0; x < _grid.tilesX; ++x)
+        {
+            const float x0 =
+                -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(_grid.tilesX);
+            const float x1 =
+                -1.0f + 2.0f * static_cast<float>(x + 1) / static_cast<float>(_grid.tilesX);
+
+            m_tileFrustums[y * _grid.tilesX + x] = getTileFrustum(_p00, _p11, x0, x1, y0, y1);
+        }
+    }
+
+    // The slice k spans near * (far / near)^(k / slices) to that of k + 1
+    const Frustum view = getTileFrustum(_p00, _p11, -1.0f, 1.0f, -1.0f, 1.0f);
+
+    m_sliceFrustums.assign(_grid.slices, view);
+    for (uint32_t slice = 0; slice < _grid.slices; ++slice)
+    {
+        const float sliceNear =
+            _zNear * std::exp(depthRange * static_cast<float>(slice) / _grid.slices);
+        const float sliceFar =
+            slice + 1 == _grid.slices
+                ? _zFar
+                : _zNear * std::exp(depthRange * static_cast<float>(slice + 1) / _grid.slices);
+
+        m_sliceFrustums[slice].planes[4] = {0.0f, 0.0f, -1.0f, -sliceNear}; // -z >= near
+        m_sliceFrustums[slice].planes[5] = {0.0f, 0.0f, 1.0f, sliceFar};    // -z <= far
+    }
+
+    m_slices.resize(_grid.slices);
+    for (Slice& slice : m_slices) slice.clusters.resize(_grid.tilesX * _grid.tilesY);
+}
+
+Frustum LightClustering::getClusterFrustum(uint32_t _x, uint32_t _y,
+                                           uint32_t _slice) const noexcept
+{
+    Frustum frustum = m_tileFrustums[_y * m_grid.tilesX + _x];
+    frustum.planes[4] = m_sliceFrustums[_slice].planes[4];
+    frustum.planes[5] = m_sliceFrustums[_slice].planes[5];
+
+    return frustum;
+}
+
+void LightClustering::assignSlice(uint32_t _slice, const SphereColumns& _lights)
+{
+    Slice& slice = m_slices[_slice];
+    const Frustum& sliceFrustum = m_sliceFrustums[_slice];
+
+    slice.indices.clear();
+
+    // The lights of the slice, gathered so the tiles only test those
+    slice.lights.resize(_lights.size());
+    const uint32_t count = cullSpheres(sliceFrustum, _lights, slice.lights);
+    slice.lights.resize(count);
+
+    slice.x.resize(count);
+    slice.y.resize(count);
+    slice.z.resize(count);
+    slice.radius.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t light = slice.lights[i];
+        slice.x[i] = _lights.centerX[light];
+        slice.y[i] = _lights.centerY[light];
+        slice.z[i] = _lights.centerZ[light];
+        slice.radius[i] = _lights.radius[light];
+    }
+
+    const SphereColumns columns = {slice.x, slice.y, slice.z, slice.radius};
+    slice.visible.resize(count);
+
+    for (size_t tile = 0; tile < slice.clusters.size(); ++tile)
+    {
+        LightCluster& cluster = slice.clusters[tile];
+        cluster.offset = static_cast<uint32_t>(slice.indices.size());
+        cluster.count = 0;
+
+        if (count == 0) continue;
+
+        Frustum frustum = m_tileFrustums[tile];
+        frustum.planes[4] = sliceFrustum.planes[4];
+        frustum.planes[5] = sliceFrustum.planes[5];
+
+        cluster.count = cullSpheres(frustum, columns, slice.visible);
+        for (uint32_t i = 0; i < cluster.count; ++i)
+        {
+            slice.indices.push_back(slice.lights[slice.visible[i]]);
+        }
+    }
+}
+
+LightClusterBuffers LightClustering::write(uint32_t _lightCount, FrameRing& _ring)
+{
+    if (m_slices.empty()) return {};
+
+    size_t indexCount = 0;
+    for (const Slice& slice : m_slices) indexCount += slice.indices.size();
+
+    LightClusterBuffers buffers;
+    buffers.clusters = _ring.allocate(m_grid.size() * sizeof(LightCluster));
+    buffers.indices = _ring.allocate(std::max<size_t>(indexCount, 1) * sizeof(uint32_t));
+    buffers.uniforms = _ring.allocate(sizeof(ClusterUniforms));
+
+    if (!buffers.clusters || !buffers.indices || !buffers.uniforms)
+    {
+        MOSAIC_ERROR("The frame ring is out of memory for {} light indices", indexCount);
+        return {};
+    }
+
+    // The slices are written one after the other, their offsets moved past the previous ones
+    std::byte* clusters = buffers.clusters.data;
+    std::byte* indices = buffers.indices.data;
+    uint32_t base = 0;
+
+    for (Slice& slice : m_slices)
+    {
+        for (LightCluster& cluster : slice.clusters) cluster.offset += base;
+
+        std::memcpy(clusters, slice.clusters.data(), slice.clusters.size() * sizeof(LightCluster));
+        if (!slice.indices.empty())
+        {
+            std::memcpy(indices, slice.indices.data(), slice.indices.size() * sizeof(uint32_t));
+        }
+
+        clusters += slice.clusters.size() * sizeof(LightCluster);
+        indices += slice.indices.size() * sizeof(uint32_t);
+        base += static_cast<uint32_t>(slice.indices.size());
+    }
+
+    m_uniforms.lightCount = _lightCount;
+    m_uniforms.firstCluster =
+        static_cast<uint32_t>(buffers.clusters.offset / sizeof(LightCluster));
+    m_uniforms.firstIndex = static_cast<uint32_t>(buffers.indices.offset / sizeof(uint32_t));
+    std::memcpy(buffers.uniforms.data, &m_uniforms, sizeof(ClusterUniforms));
+
+    buffers.indexCount = static_cast<uint32_t>(indexCount);
+
+    return buffers;
+}
+
+LightClusterBuffers LightClustering::assign(exec::ThreadPool& _pool, const SphereColumns& _lights,
+                                            FrameRing& _ring)
+{
+    const auto sliceCount = static_cast<uint32_t>(m_slices.size());
+    exec::parallelFor(_pool, uint32_t{0}, sliceCount, uint32_t{1},
+                      [&](uint32_t _slice) { assignSlice(_slice, _lights); });
+
+    return write(static_cast<uint32_t>(_lights.size()), _ring);
+}
+
+LightClusterBuffers LightClustering::assign(const SphereColumns& _lights, FrameRing& _ring)
+{
+    for (uint32_t slice = 0; slice < m_slices.size(); ++slice) assignSlice(slice, _lights);
+
+    return write(static_cast<uint32_t>(_lights.size()), _ring);
+}
+
+} // namespace graphics
+} // namespace mosaic
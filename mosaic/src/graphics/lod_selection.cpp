@@ -0,0 +1,197 @@
+#include "mosaic/graphics/lod_selection.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The tiers of a chain as indices: its LODs, the impostor, then culled
+static uint32_t getTierCount(const LodChain& _chain) noexcept
+{
+    return _chain.lodCount + (_chain.impostor ? 1 : 0);
+}
+
+static float getThreshold(const LodChain& _chain, uint32_t _index) noexcept
+{
+    return _index < _chain.lodCount ? _chain.minCoverage[_index] : _chain.impostorCoverage;
+}
+
+static uint32_t toIndex(const LodChain& _chain, uint8_t _tier) noexcept
+{
+    if (_tier == k_culledTier) return getTierCount(_chain);
+    if (_tier == k_impostorTier) return _chain.impostor ? _chain.lodCount : getTierCount(_chain);
+    return std::min<uint32_t>(_tier, getTierCount(_chain));
+}
+
+static uint8_t toTier(const LodChain& _chain, uint32_t _index) noexcept
+{
+    if (_index < _chain.lodCount) return static_cast<uint8_t>(_index);
+    return _index < getTierCount(_chain) ? k_impostorTier : k_culledTier;
+}
+
+// The first tier whose threshold, times _scale, the coverage is at least: the coverage squared
+// is _numerator / _denominator (radius² scale² over distance²), compared without the division
+static uint32_t getIndex(const LodChain& _chain, float _numerator, float _denominator,
+                         float _scale) noexcept
+{
+    const uint32_t count = getTierCount(_chain);
+
+    uint32_t index = 0;
+    for (; index < count; ++index)
+    {
+        const float threshold = getThreshold(_chain, index) * _scale;
+        if (_numerator >= threshold * threshold * _denominator) break;
+    }
+
+    return index;
+}
+
+static uint8_t selectTier(const LodChain& _chain, float _numerator, float _denominator,
+                          std::optional<uint8_t> _previous, float _hysteresis) noexcept
+{
+    const uint32_t index = getIndex(_chain, _numerator, _denominator, 1.0f);
+    if (!_previous) return toTier(_chain, index);
+
+    const uint32_t previous = toIndex(_chain, *_previous);
+
+    // coarser once below the thresholds lowered by the hysteresis, finer once above them raised
+    if (index > previous)
+    {
+        const uint32_t lowered = getIndex(_chain, _numerator, _denominator, 1.0f - _hysteresis);
+        return toTier(_chain, std::max(previous, lowered));
+    }
+
+    if (index < previous)
+    {
+        const uint32_t raised = getIndex(_chain, _numerator, _denominator, 1.0f + _hysteresis);
+        return toTier(_chain, std::min(previous, raised));
+    }
+
+    return toTier(_chain, index);
+}
+
+LodChain makeLodChain(std::span<const MeshLod> _lods, float _radius, float _viewportHeight,
+                      float _maxPixels, float _impostorCoverage) noexcept
+{
+    LodChain chain;
+    chain.lodCount = static_cast<uint32_t>(
+        std::clamp<size_t>(_lods.size(), 1, static_cast<size_t>(k_maxLodCount)));
+
+    // LOD i + 1 is seen with an error of error * (height / 2) * scale / distance pixels, that is
+    // error * height * coverage / (2 radius): LOD i is drawn while that is above _maxPixels
+    for (uint32_t lod = 0; lod + 1 < chain.lodCount; ++lod)
+    {
+        const float error = _lods[lod + 1].error;
+        chain.minCoverage[lod] = error > 0.0f ? 2.0f * _maxPixels * _radius /
+                                                    (error * _viewportHeight)
+                                              : 0.0f;
+    }
+
+    chain.minCoverage[chain.lodCount - 1] = _impostorCoverage;
+    chain.impostor = _impostorCoverage > 0.0f;
+    chain.impostorCoverage = 0.0f;
+    return chain;
+}
+
+float getScreenCoverage(const BoundingSphere& _sphere, const LodView& _view) noexcept
+{
+    const float dx = _sphere.center[0] - _view.position[0];
+    const float dy = _sphere.center[1] - _view.position[1];
+    const float dz = _sphere.center[2] - _view.position[2];
+    const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    if (distance <= 0.0f) return std::numeric_limits<float>::infinity();
+    return _sphere.radius * _view.scale / distance;
+}
+
+uint8_t selectLodTier(const LodChain& _chain, float _coverage, std::optional<uint8_t> _previous,
+                      float _hysteresis) noexcept
+{
+    if (std::isinf(_coverage)) return selectTier(_chain, 1.0f, 0.0f, _previous, _hysteresis);
+    return selectTier(_chain, _coverage * _coverage, 1.0f, _previous, _hysteresis);
+}
+
+std::span<const uint32_t> LodSelector::select(const Frustum& _frustum,
+                                              const SphereColumns& _spheres,
+                                              std::span<const uint32_t> _chainOf,
+                                              std::span<const LodChain> _chains,
+                                              const LodView& _view)
+{
+    m_visible.resize(_spheres.size());
+    const uint32_t count = cullSpheres(_frustum, _spheres, m_visible);
+    return selectVisible(count, _spheres, _chainOf, _chains, _view);
+}
+
+std::span<const uint32_t> LodSelector::select(exec::ThreadPool& _pool, const Frustum& _frustum,
+                                              const SphereColumns& _spheres,
+                                              std::span<const uint32_t> _chainOf,
+                                              std::span<const LodChain> _chains,
+                                              const LodView& _view)
+{
+    m_visible.resize(_spheres.size());
+    const uint32_t count = cullSpheres(_pool, _frustum, _spheres, m_visible);
+    return selectVisible(count, _spheres, _chainOf, _chains, _view);
+}
+
+void LodSelector::reset() noexcept
+{
+    m_tiers.clear();
+    m_frames.clear();
+    m_frame = 0;
+}
+
+std::span<const uint32_t> LodSelector::selectVisible(uint32_t _count,
+                                                     const SphereColumns& _spheres,
+                                                     std::span<const uint32_t> _chainOf,
+                                                     std::span<const LodChain> _chains,
+                                                     const LodView& _view)
+{
+    if (m_tiers.size() < _spheres.size())
+    {
+        m_tiers.resize(_spheres.size(), k_culledTier);
+        m_frames.resize(_spheres.size(), 0);
+    }
+
+    // 0 is never a frame, the objects never selected have no previous tier
+    ++m_frame;
+    if (m_frame == 0)
+    {
+        std::fill(m_frames.begin(), m_frames.end(), 0);
+        m_frame = 1;
+    }
+
+    const float scale = _view.scale * _view.scale;
+
+    // compacted in place, the objects drawn keep their order
+    uint32_t drawn = 0;
+    for (uint32_t i = 0; i < _count; ++i)
+    {
+        const uint32_t object = m_visible[i];
+
+        const float dx = _spheres.centerX[object] - _view.position[0];
+        const float dy = _spheres.centerY[object] - _view.position[1];
+        const float dz = _spheres.centerZ[object] - _view.position[2];
+        const float radius = _spheres.radius[object];
+
+        std::optional<uint8_t> previous;
+        if (m_frames[object] != 0 && m_frames[object] + 1 == m_frame) previous = m_tiers[object];
+
+        const uint8_t tier = selectTier(_chains[_chainOf[object]], radius * radius * scale,
+                                        dx * dx + dy * dy + dz * dz, previous, _view.hysteresis);
+
+        m_tiers[object] = tier;
+        m_frames[object] = m_frame;
+
+        m_visible[drawn] = object;
+        drawn += tier != k_culledTier ? 1 : 0;
+    }
+
+    return std::span<const uint32_t>(m_visible.data(), drawn);
+}
+
+} // namespace graphics
+} // namespace mosaic
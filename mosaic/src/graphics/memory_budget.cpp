@@ -0,0 +1,68 @@
+#include "mosaic/graphics/memory_budget.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// _share of _bytes, the share to a hundredth of a percent: exact for those of the settings
+static uint64_t getShare(uint64_t _bytes, float _share) noexcept
+{
+    const double share = std::round(std::clamp(_share, 0.0f, 1.0f) * 10000.0f);
+    return static_cast<uint64_t>(static_cast<double>(_bytes) * share / 10000.0);
+}
+
+MemoryPressure getMemoryPressure(uint64_t _usage, uint64_t _budget,
+                                 const MemoryBudgetSettings& _settings) noexcept
+{
+    // no heap reported
+    if (_budget == 0) return MemoryPressure::Normal;
+
+    if (_usage >= getShare(_budget, _settings.criticalUsage)) return MemoryPressure::Critical;
+    if (_usage >= getShare(_budget, _settings.highUsage)) return MemoryPressure::High;
+
+    return MemoryPressure::Normal;
+}
+
+uint64_t getStreamingBudget(uint64_t _usage, uint64_t _budget, uint64_t _streamed,
+                            const MemoryBudgetSettings& _settings) noexcept
+{
+    const uint64_t others = _usage - std::min(_usage, _streamed);
+    const uint64_t watermark = getShare(_budget, _settings.highUsage);
+
+    return watermark > others ? watermark - others : 0;
+}
+
+bool isLowLoadFrame(std::chrono::nanoseconds _cpuTime, std::chrono::nanoseconds _gpuTime,
+                    std::chrono::nanoseconds _interval,
+                    const MemoryBudgetSettings& _settings) noexcept
+{
+    // nothing measured yet
+    if (_interval <= std::chrono::nanoseconds::zero()) return false;
+
+    const auto limit = std::chrono::nanoseconds(
+        static_cast<int64_t>(static_cast<double>(_interval.count()) * _settings.lowLoad));
+
+    return std::max(_cpuTime, _gpuTime) <= limit;
+}
+
+const char* getMemoryPressureName(MemoryPressure _pressure) noexcept
+{
+    switch (_pressure)
+    {
+        case MemoryPressure::Normal:
+            return "normal";
+        case MemoryPressure::High:
+            return "high";
+        case MemoryPressure::Critical:
+            return "critical";
+    }
+
+    return "unknown";
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,143 @@
+#include "mosaic/graphics/mesh.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static constexpr size_t k_sectionAlignment = 16;
+
+static size_t alignSection(size_t _offset)
+{
+    return (_offset + k_sectionAlignment - 1) & ~(k_sectionAlignment - 1);
+}
+
+pieces::Result<MeshData, std::string> parseMesh(std::span<const uint8_t> _file)
+{
+    auto fail = [](const char* _error)
+    { return pieces::Err<MeshData, std::string>(std::string("invalid mesh file: ") + _error); };
+
+    MeshData mesh;
+    if (_file.size() < sizeof(MeshFileHeader)) return fail("truncated header");
+
+    std::memcpy(&mesh.header, _file.data(), sizeof(MeshFileHeader));
+    const MeshFileHeader& header = mesh.header;
+
+    if (header.magic != k_meshMagic) return fail("not a mesh file");
+    if (header.version != k_meshVersion) return fail("unsupported version");
+    if (header.lodCount == 0 || header.indexCount % 3 != 0) return fail("no triangles");
+
+    // The sections one after the other, every size computed in 64 bits
+    size_t cursor = sizeof(MeshFileHeader);
+    auto section = [&](uint64_t _size)
+    {
+        const MeshSection range = {alignSection(cursor), static_cast<size_t>(_size)};
+        cursor = range.offset + range.size;
+        return range;
+    };
+
+    const MeshSection lods = section(uint64_t{header.lodCount} * sizeof(MeshLod));
+    mesh.vertices = section(uint64_t{header.vertexCount} * sizeof(PackedVertex));
+    mesh.indices = section(uint64_t{header.indexCount} * sizeof(uint32_t));
+    mesh.meshlets = section(uint64_t{header.meshletCount} * sizeof(Meshlet));
+    mesh.meshletVertices = section(uint64_t{header.meshletVertexCount} * sizeof(uint32_t));
+    mesh.meshletTriangles = section(header.meshletTriangleSize);
+
+    if (cursor > _file.size()) return fail("truncated payload");
+
+    mesh.payload = {mesh.vertices.offset, cursor - mesh.vertices.offset};
+
+    mesh.lods.resize(header.lodCount);
+    std::memcpy(mesh.lods.data(), _file.data() + lods.offset, lods.size);
+
+    for (const MeshLod& lod : mesh.lods)
+    {
+        if (lod.firstIndex > header.indexCount ||
+            lod.indexCount > header.indexCount - lod.firstIndex ||
+            lod.firstMeshlet > header.meshletCount ||
+            lod.meshletCount > header.meshletCount - lod.firstMeshlet)
+        {
+            return fail("LOD out of the mesh");
+        }
+    }
+
+    return pieces::Ok<MeshData, std::string>(std::move(mesh));
+}
+
+uint32_t selectMeshLod(std::span<const MeshLod> _lods, float _distance, float _pixelsPerUnit,
+                       float _maxPixels) noexcept
+{
+    const float distance = std::max(_distance, 1e-6f);
+
+    uint32_t selected = 0;
+    for (uint32_t lod = 1; lod < _lods.size(); ++lod)
+    {
+        if (_lods[lod].error * _pixelsPerUnit / distance > _maxPixels) break;
+        selected = lod;
+    }
+
+    return selected;
+}
+
+std::array<float, 3> unpackPosition(const MeshFileHeader& _header,
+                                    const PackedVertex& _vertex) noexcept
+{
+    std::array<float, 3> position;
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        position[axis] = _header.boundsMin[axis] +
+                         _header.boundsExtent[axis] * (_vertex.position[axis] / 65535.0f);
+    }
+
+    return position;
+}
+
+std::array<float, 3> unpackNormal(const PackedVertex& _vertex) noexcept
+{
+    // octahedral: the lower hemisphere folded over the upper one
+    float x = std::max(_vertex.normal[0] / 32767.0f, -1.0f);
+    float y = std::max(_vertex.normal[1] / 32767.0f, -1.0f);
+    const float z = 1.0f - std::abs(x) - std::abs(y);
+
+    if (z < 0.0f)
+    {
+        const float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+    }
+
+    const float length = std::sqrt(x * x + y * y + z * z);
+    return {x / length, y / length, z / length};
+}
+
+// IEEE half to float, subnormals included
+static float halfToFloat(uint16_t _half)
+{
+    const uint32_t sign = uint32_t{_half & 0x8000u} << 16;
+    const uint32_t exponent = (_half >> 10) & 0x1F;
+    const uint32_t mantissa = _half & 0x3FF;
+
+    if (exponent == 0)
+    {
+        const float value = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -value : value;
+    }
+
+    const uint32_t bits = exponent == 0x1F ? sign | 0x7F800000u | (mantissa << 13)
+                                           : sign | ((exponent + 112) << 23) | (mantissa << 13);
+    return std::bit_cast<float>(bits);
+}
+
+std::array<float, 2> unpackUv(const PackedVertex& _vertex) noexcept
+{
+    return {halfToFloat(_vertex.uv[0]), halfToFloat(_vertex.uv[1])};
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,798 @@
+#include "mosaic/graphics/mesh_cook.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+using Vec3 = std::array<float, 3>;
+
+static Vec3 sub(const Vec3& _a, const Vec3& _b)
+{
+    return {_a[0] - _b[0], _a[1] - _b[1], _a[2] - _b[2]};
+}
+
+static Vec3 cross(const Vec3& _a, const Vec3& _b)
+{
+    return {_a[1] * _b[2] - _a[2] * _b[1], _a[2] * _b[0] - _a[0] * _b[2],
+            _a[0] * _b[1] - _a[1] * _b[0]};
+}
+
+static float dot(const Vec3& _a, const Vec3& _b)
+{
+    return _a[0] * _b[0] + _a[1] * _b[1] + _a[2] * _b[2];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Index optimization
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The triangles of every vertex, a range of triangles per vertex from offsets
+struct Adjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+};
+
+static Adjacency buildAdjacency(std::span<const uint32_t> _indices, size_t _vertexCount)
+{
+    Adjacency adjacency;
+    adjacency.offsets.assign(_vertexCount + 1, 0);
+    adjacency.triangles.resize(_indices.size());
+
+    for (uint32_t index : _indices) ++adjacency.offsets[index + 1];
+    std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(),
+                     adjacency.offsets.begin());
+
+    std::vector<uint32_t> cursors(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (size_t i = 0; i < _indices.size(); ++i)
+    {
+        adjacency.triangles[cursors[_indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    return adjacency;
+}
+
+/**
+ * @brief A FIFO post-transform cache by timestamps: a vertex is in the cache while fewer than
+ * cacheSize vertices missed since it did. restart() empties it in O(1).
+ */
+class CacheSimulator final
+{
+   private:
+    std::vector<uint32_t> m_timestamps;
+    uint32_t m_cacheSize;
+    uint32_t m_time;
+
+   public:
+    CacheSimulator(size_t _vertexCount, uint32_t _cacheSize)
+        : m_timestamps(_vertexCount, 0),
+          m_cacheSize(_cacheSize),
+          m_time(_cacheSize + 1)
+    {
+    }
+
+   public:
+    // The misses of a triangle, 0 to 3
+    uint32_t access(const uint32_t* _triangle)
+    {
+        uint32_t misses = 0;
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            uint32_t& timestamp = m_timestamps[_triangle[k]];
+            if (m_time - timestamp > m_cacheSize)
+            {
+                timestamp = m_time++;
+                ++misses;
+            }
+        }
+
+        return misses;
+    }
+
+    void restart() noexcept { m_time += m_cacheSize + 1; }
+};
+
+float getAcmr(std::span<const uint32_t> _indices, size_t _vertexCount, uint32_t _cacheSize)
+{
+    const size_t triangleCount = _indices.size() / 3;
+    if (triangleCount == 0) return 0.0f;
+
+    CacheSimulator cache(_vertexCount, _cacheSize);
+
+    size_t misses = 0;
+    for (size_t t = 0; t < triangleCount; ++t) misses += cache.access(&_indices[t * 3]);
+
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+void optimizeVertexCache(std::span<uint32_t> _indices, size_t _vertexCount, uint32_t _cacheSize)
+{
+    const size_t triangleCount = _indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    const Adjacency adjacency = buildAdjacency(_indices, _vertexCount);
+
+    // the triangles left of every vertex
+    std::vector<uint32_t> live(_vertexCount);
+    for (size_t v = 0; v < _vertexCount; ++v)
+    {
+        live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+
+    std::vector<uint32_t> cacheTime(_vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(_indices.size());
+
+    uint32_t time = _cacheSize + 1;
+    size_t cursor = 0;
+    int64_t fanning = _indices[0];
+
+    // Tipsify (Sander, Nehab, Barczak 2007): the triangles of a vertex fanned out at once, then
+    // the next vertex is the candidate that stays the longest in the cache
+    while (fanning >= 0)
+    {
+        candidates.clear();
+
+        const uint32_t vertex = static_cast<uint32_t>(fanning);
+        for (uint32_t j = adjacency.offsets[vertex]; j < adjacency.offsets[vertex + 1]; ++j)
+        {
+            const uint32_t triangle = adjacency.triangles[j];
+            if (emitted[triangle]) continue;
+
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t v = _indices[triangle * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+
+                if (time - cacheTime[v] > _cacheSize) cacheTime[v] = time++;
+            }
+
+            emitted[triangle] = 1;
+        }
+
+        fanning = -1;
+        int64_t bestPriority = -1;
+
+        for (uint32_t v : candidates)
+        {
+            if (live[v] == 0) continue;
+
+            // still in the cache once its triangles are emitted: the oldest first
+            int64_t priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= _cacheSize) priority = time - cacheTime[v];
+
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanning = v;
+            }
+        }
+
+        // a dead end: a vertex recently used, or the next with triangles left
+        while (fanning < 0 && !deadEnd.empty())
+        {
+            const uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) fanning = v;
+        }
+
+        while (fanning < 0 && cursor < _vertexCount)
+        {
+            if (live[cursor] > 0) fanning = static_cast<int64_t>(cursor);
+            ++cursor;
+        }
+    }
+
+    std::copy(output.begin(), output.end(), _indices.begin());
+}
+
+void optimizeOverdraw(std::span<uint32_t> _indices, std::span<const MeshVertex> _vertices,
+                      float _threshold, uint32_t _cacheSize)
+{
+    const size_t triangleCount = _indices.size() / 3;
+    if (triangleCount < 2) return;
+
+    CacheSimulator cache(_vertices.size(), _cacheSize);
+
+    // Hard boundaries: the triangles the cache restarts at, every vertex a miss
+    std::vector<size_t> hard = {0};
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (cache.access(&_indices[t * 3]) == 3 && t > 0) hard.push_back(t);
+    }
+    hard.push_back(triangleCount);
+
+    // Soft boundaries: where a cluster alone is about as cache efficient as the whole of it
+    std::vector<size_t> clusters;
+    for (size_t c = 0; c + 1 < hard.size(); ++c)
+    {
+        const size_t begin = hard[c];
+        const size_t end = hard[c + 1];
+
+        cache.restart();
+        size_t misses = 0;
+        for (size_t t = begin; t < end; ++t) misses += cache.access(&_indices[t * 3]);
+        const float acmr = static_cast<float>(misses) / static_cast<float>(end - begin);
+
+        cache.restart();
+        clusters.push_back(begin);
+        size_t start = begin;
+        misses = 0;
+
+        for (size_t t = begin; t + 1 < end; ++t)
+        {
+            misses += cache.access(&_indices[t * 3]);
+
+            if (static_cast<float>(misses) / static_cast<float>(t - start + 1) <=
+                acmr * _threshold)
+            {
+                clusters.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                cache.restart();
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // Each cluster by how far out it faces, from the centroid of the mesh (area weighted)
+    const size_t clusterCount = clusters.size() - 1;
+    std::vector<Vec3> centroids(clusterCount, Vec3{});
+    std::vector<Vec3> normals(clusterCount, Vec3{});
+    std::vector<float> areas(clusterCount, 0.0f);
+    Vec3 meshCentroid = {};
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            const Vec3& a = _vertices[_indices[t * 3 + 0]].position;
+            const Vec3& b = _vertices[_indices[t * 3 + 1]].position;
+            const Vec3& d = _vertices[_indices[t * 3 + 2]].position;
+
+            const Vec3 normal = cross(sub(b, a), sub(d, a));
+            const float area = std::sqrt(dot(normal, normal));
+
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                centroids[c][axis] += (a[axis] + b[axis] + d[axis]) / 3.0f * area;
+                normals[c][axis] += normal[axis];
+            }
+            areas[c] += area;
+        }
+
+        for (size_t axis = 0; axis < 3; ++axis) meshCentroid[axis] += centroids[c][axis];
+        meshArea += areas[c];
+
+        if (areas[c] > 0.0f)
+        {
+            for (float& value : centroids[c]) value /= areas[c];
+        }
+    }
+
+    if (meshArea > 0.0f)
+    {
+        for (float& value : meshCentroid) value /= meshArea;
+    }
+
+    std::vector<float> keys(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        const float length = std::sqrt(dot(normals[c], normals[c]));
+        keys[c] = length > 0.0f ? dot(sub(centroids[c], meshCentroid), normals[c]) / length : 0.0f;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t _a, size_t _b) { return keys[_a] > keys[_b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(_indices.size());
+    for (size_t c : order)
+    {
+        output.insert(output.end(), _indices.begin() + clusters[c] * 3,
+                      _indices.begin() + clusters[c + 1] * 3);
+    }
+
+    std::copy(output.begin(), output.end(), _indices.begin());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Simplification
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A triangle rotated to start at its smallest index, its winding kept
+struct TriangleKey
+{
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+
+    bool operator==(const TriangleKey&) const = default;
+};
+
+struct TriangleKeyHash
+{
+    size_t operator()(const TriangleKey& _key) const noexcept
+    {
+        const uint64_t high = (uint64_t{_key.a} << 32) | _key.b;
+        return std::hash<uint64_t>{}(high ^ (uint64_t{_key.c} * 0x9E3779B97F4A7C15ull));
+    }
+};
+
+static TriangleKey makeTriangleKey(uint32_t _a, uint32_t _b, uint32_t _c)
+{
+    if (_b < _a && _b < _c) return {_b, _c, _a};
+    if (_c < _a && _c < _b) return {_c, _a, _b};
+    return {_a, _b, _c};
+}
+
+std::vector<uint32_t> simplifyMesh(std::span<const uint32_t> _indices,
+                                   std::span<const MeshVertex> _vertices, float _cellSize)
+{
+    if (!(_cellSize > 0.0f)) return {_indices.begin(), _indices.end()};
+
+    Vec3 boundsMin = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                      std::numeric_limits<float>::max()};
+    for (uint32_t index : _indices)
+    {
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            boundsMin[axis] = std::min(boundsMin[axis], _vertices[index].position[axis]);
+        }
+    }
+
+    // The cell of every vertex used, 21 bits an axis
+    constexpr uint32_t k_noCell = UINT32_MAX;
+    std::vector<uint32_t> cellOf(_vertices.size(), k_noCell);
+    std::unordered_map<uint64_t, uint32_t> cells;
+    std::vector<Vec3> averages;
+    std::vector<uint32_t> counts;
+
+    for (uint32_t index : _indices)
+    {
+        if (cellOf[index] != k_noCell) continue;
+
+        const Vec3& position = _vertices[index].position;
+        uint64_t key = 0;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            const float cell = std::floor((position[axis] - boundsMin[axis]) / _cellSize);
+            key = (key << 21) | static_cast<uint64_t>(std::min(cell, 2097151.0f));
+        }
+
+        auto [it, inserted] = cells.try_emplace(key, static_cast<uint32_t>(averages.size()));
+        if (inserted)
+        {
+            averages.push_back({});
+            counts.push_back(0);
+        }
+
+        cellOf[index] = it->second;
+        for (size_t axis = 0; axis < 3; ++axis) averages[it->second][axis] += position[axis];
+        ++counts[it->second];
+    }
+
+    for (size_t cell = 0; cell < averages.size(); ++cell)
+    {
+        for (float& value : averages[cell]) value /= static_cast<float>(counts[cell]);
+    }
+
+    // The vertex of a cell: the nearest to its average, an original one
+    std::vector<uint32_t> representative(averages.size(), k_noCell);
+    std::vector<float> distances(averages.size(), std::numeric_limits<float>::max());
+
+    for (uint32_t v = 0; v < _vertices.size(); ++v)
+    {
+        const uint32_t cell = cellOf[v];
+        if (cell == k_noCell) continue;
+
+        const Vec3 offset = sub(_vertices[v].position, averages[cell]);
+        const float distance = dot(offset, offset);
+        if (distance < distances[cell])
+        {
+            distances[cell] = distance;
+            representative[cell] = v;
+        }
+    }
+
+    std::vector<uint32_t> simplified;
+    std::unordered_set<TriangleKey, TriangleKeyHash> emitted;
+
+    for (size_t t = 0; t + 2 < _indices.size(); t += 3)
+    {
+        const uint32_t a = representative[cellOf[_indices[t + 0]]];
+        const uint32_t b = representative[cellOf[_indices[t + 1]]];
+        const uint32_t c = representative[cellOf[_indices[t + 2]]];
+
+        // collapsed, or the same as one before
+        if (a == b || b == c || a == c) continue;
+        if (!emitted.insert(makeTriangleKey(a, b, c)).second) continue;
+
+        simplified.insert(simplified.end(), {a, b, c});
+    }
+
+    return simplified;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cooking
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// IEEE half, rounded to nearest even
+static uint16_t floatToHalf(float _value)
+{
+    const uint32_t bits = std::bit_cast<uint32_t>(_value);
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+    if (magnitude >= 0x7F800000) // infinity and NaN
+    {
+        return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0);
+    }
+    if (magnitude >= 0x477FF000) return sign | 0x7C00; // rounds past 65504
+
+    if (magnitude < 0x38800000) // subnormal
+    {
+        const float value = std::bit_cast<float>(magnitude) * 16777216.0f; // 2^24
+        return sign | static_cast<uint16_t>(std::lrint(value));
+    }
+
+    const uint32_t rounded = magnitude + 0xFFF + ((magnitude >> 13) & 1);
+    return sign | static_cast<uint16_t>((rounded - 0x38000000) >> 13);
+}
+
+static int16_t toSnorm16(float _value)
+{
+    return static_cast<int16_t>(std::lrint(std::clamp(_value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static std::array<int16_t, 2> encodeOctahedral(Vec3 _normal)
+{
+    const float sum = std::abs(_normal[0]) + std::abs(_normal[1]) + std::abs(_normal[2]);
+    if (sum == 0.0f) return {0, 0}; // +Z
+
+    float x = _normal[0] / sum;
+    float y = _normal[1] / sum;
+
+    if (_normal[2] < 0.0f)
+    {
+        const float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+    }
+
+    return {toSnorm16(x), toSnorm16(y)};
+}
+
+// The smallest cell size simplifyMesh() keeps at most _target triangles with, by bisection: the
+// triangle count decreases with the cell size, roughly.
+static std::vector<uint32_t> simplifyTo(std::span<const uint32_t> _indices,
+                                        std::span<const MeshVertex> _vertices, size_t _target,
+                                        float _maxCellSize, float& _cellSize)
+{
+    float low = 0.0f;
+    float high = _maxCellSize;
+    std::vector<uint32_t> best;
+
+    for (int iteration = 0; iteration < 24; ++iteration)
+    {
+        const float middle = (low + high) * 0.5f;
+        std::vector<uint32_t> simplified = simplifyMesh(_indices, _vertices, middle);
+
+        if (simplified.size() / 3 <= _target)
+        {
+            high = middle;
+            best = std::move(simplified);
+        }
+        else
+        {
+            low = middle;
+        }
+    }
+
+    _cellSize = high;
+    return best;
+}
+
+static void buildMeshlets(std::span<const uint32_t> _indices, std::span<const Vec3> _positions,
+                          const MeshCookSettings& _settings, std::vector<Meshlet>& _meshlets,
+                          std::vector<uint32_t>& _meshletVertices,
+                          std::vector<uint8_t>& _meshletTriangles)
+{
+    constexpr uint8_t k_notInMeshlet = 0xFF;
+    std::vector<uint8_t> local(_positions.size(), k_notInMeshlet);
+    std::vector<uint32_t> vertices;
+    std::vector<uint8_t> triangles;
+
+    auto flush = [&]
+    {
+        if (triangles.empty()) return;
+
+        Meshlet& meshlet = _meshlets.emplace_back();
+        meshlet.vertexOffset = static_cast<uint32_t>(_meshletVertices.size());
+        meshlet.triangleOffset = static_cast<uint32_t>(_meshletTriangles.size());
+        meshlet.vertexCount = static_cast<uint32_t>(vertices.size());
+        meshlet.triangleCount = static_cast<uint32_t>(triangles.size() / 3);
+
+        Vec3 center = {};
+        for (uint32_t v : vertices)
+        {
+            for (size_t axis = 0; axis < 3; ++axis) center[axis] += _positions[v][axis];
+        }
+        for (float& value : center) value /= static_cast<float>(vertices.size());
+
+        float radius = 0.0f;
+        for (uint32_t v : vertices)
+        {
+            const Vec3 offset = sub(_positions[v], center);
+            radius = std::max(radius, std::sqrt(dot(offset, offset)));
+            local[v] = k_notInMeshlet;
+        }
+        meshlet.bounds = {center, radius};
+
+        // The cone of the normals: around their mean, as wide as the farthest from it
+        std::vector<Vec3> normals;
+        Vec3 axis = {};
+        for (size_t t = 0; t + 2 < triangles.size(); t += 3)
+        {
+            const Vec3& a = _positions[vertices[triangles[t]]];
+            Vec3 normal = cross(sub(_positions[vertices[triangles[t + 1]]], a),
+                                sub(_positions[vertices[triangles[t + 2]]], a));
+
+            const float length = std::sqrt(dot(normal, normal));
+            if (!(length > 0.0f)) continue; // degenerate, faces no way
+
+            for (float& value : normal) value /= length;
+            for (size_t k = 0; k < 3; ++k) axis[k] += normal[k];
+            normals.push_back(normal);
+        }
+
+        const float axisLength = std::sqrt(dot(axis, axis));
+        if (axisLength > 0.0f)
+        {
+            for (float& value : axis) value /= axisLength;
+
+            float minDot = 1.0f;
+            for (const Vec3& normal : normals) minDot = std::min(minDot, dot(normal, axis));
+
+            // wider than a half space, some triangle faces every camera
+            if (minDot > 0.0f)
+            {
+                meshlet.coneAxis = axis;
+                meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+        }
+
+        _meshletVertices.insert(_meshletVertices.end(), vertices.begin(), vertices.end());
+        _meshletTriangles.insert(_meshletTriangles.end(), triangles.begin(), triangles.end());
+        _meshletTriangles.resize((_meshletTriangles.size() + 3) & ~size_t{3});
+
+        vertices.clear();
+        triangles.clear();
+    };
+
+    for (size_t t = 0; t + 2 < _indices.size(); t += 3)
+    {
+        const uint32_t* triangle = &_indices[t];
+
+        uint32_t added = 0;
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            const bool repeated = (k > 0 && triangle[k] == triangle[0]) ||
+                                  (k > 1 && triangle[k] == triangle[1]);
+            if (local[triangle[k]] == k_notInMeshlet && !repeated) ++added;
+        }
+
+        if (vertices.size() + added > _settings.maxMeshletVertices ||
+            triangles.size() / 3 + 1 > _settings.maxMeshletTriangles)
+        {
+            flush();
+        }
+
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            if (local[triangle[k]] == k_notInMeshlet)
+            {
+                local[triangle[k]] = static_cast<uint8_t>(vertices.size());
+                vertices.push_back(triangle[k]);
+            }
+
+            triangles.push_back(local[triangle[k]]);
+        }
+    }
+
+    flush();
+}
+
+pieces::Result<std::vector<uint8_t>, std::string> cookMesh(std::span<const MeshVertex> _vertices,
+                                                           std::span<const uint32_t> _indices,
+                                                           const MeshCookSettings& _settings)
+{
+    auto fail = [](const char* _error)
+    { return pieces::Err<std::vector<uint8_t>, std::string>(std::string(_error)); };
+
+    if (_indices.empty() || _indices.size() % 3 != 0)
+    {
+        return fail("the indices are not a triangle list");
+    }
+    if (std::ranges::any_of(_indices, [&](uint32_t _index) { return _index >= _vertices.size(); }))
+    {
+        return fail("an index is out of the vertices");
+    }
+    if (_settings.meshlets &&
+        (_settings.maxMeshletVertices < 3 || _settings.maxMeshletVertices > 255 ||
+         _settings.maxMeshletTriangles == 0))
+    {
+        return fail("the meshlet limits are out of range");
+    }
+
+    // The bounds of the vertices used
+    Vec3 boundsMin = _vertices[_indices[0]].position;
+    Vec3 boundsMax = boundsMin;
+    for (uint32_t index : _indices)
+    {
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            boundsMin[axis] = std::min(boundsMin[axis], _vertices[index].position[axis]);
+            boundsMax[axis] = std::max(boundsMax[axis], _vertices[index].position[axis]);
+        }
+    }
+    const Vec3 extent = sub(boundsMax, boundsMin);
+    const float maxExtent = std::max({extent[0], extent[1], extent[2]});
+
+    // The LOD chain, each simplified from the finest to stay close to it
+    std::vector<std::vector<uint32_t>> lods = {{_indices.begin(), _indices.end()}};
+    std::vector<float> errors = {0.0f};
+
+    while (lods.size() < std::max(_settings.maxLods, 1u))
+    {
+        const size_t target =
+            static_cast<size_t>(static_cast<float>(lods.back().size() / 3) * _settings.lodRatio);
+        if (target < _settings.minLodTriangles || target == 0 || !(maxExtent > 0.0f)) break;
+
+        float cellSize = 0.0f;
+        std::vector<uint32_t> lod = simplifyTo(_indices, _vertices, target, maxExtent, cellSize);
+        if (lod.empty()) break;
+
+        lods.push_back(std::move(lod));
+        errors.push_back(cellSize * std::sqrt(3.0f)); // the diagonal of a cell
+    }
+
+    for (std::vector<uint32_t>& lod : lods)
+    {
+        optimizeVertexCache(lod, _vertices.size());
+        optimizeOverdraw(lod, _vertices, _settings.overdrawThreshold);
+    }
+
+    // The vertices in the order the finest LOD first reads them, those unused dropped
+    constexpr uint32_t k_unused = UINT32_MAX;
+    std::vector<uint32_t> remap(_vertices.size(), k_unused);
+    std::vector<uint32_t> order;
+
+    for (std::vector<uint32_t>& lod : lods)
+    {
+        for (uint32_t& index : lod)
+        {
+            if (remap[index] == k_unused)
+            {
+                remap[index] = static_cast<uint32_t>(order.size());
+                order.push_back(index);
+            }
+            index = remap[index];
+        }
+    }
+
+    MeshFileHeader header = {};
+    header.magic = k_meshMagic;
+    header.version = k_meshVersion;
+    header.vertexCount = static_cast<uint32_t>(order.size());
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    header.boundsMin = boundsMin;
+    header.boundsExtent = extent;
+
+    std::vector<PackedVertex> packed(order.size());
+    std::vector<Vec3> positions(order.size()); // as the shaders see them
+
+    for (size_t v = 0; v < order.size(); ++v)
+    {
+        const MeshVertex& source = _vertices[order[v]];
+        PackedVertex& vertex = packed[v];
+
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            const float unit = extent[axis] > 0.0f
+                                   ? (source.position[axis] - boundsMin[axis]) / extent[axis]
+                                   : 0.0f;
+            vertex.position[axis] =
+                static_cast<uint16_t>(std::lrint(std::clamp(unit, 0.0f, 1.0f) * 65535.0f));
+        }
+
+        vertex.normal = encodeOctahedral(source.normal);
+        vertex.uv = {floatToHalf(source.uv[0]), floatToHalf(source.uv[1])};
+        positions[v] = unpackPosition(header, vertex);
+    }
+
+    // The bounding sphere around the center of the bounds
+    Vec3 center;
+    for (size_t axis = 0; axis < 3; ++axis) center[axis] = boundsMin[axis] + extent[axis] * 0.5f;
+
+    float radius = 0.0f;
+    for (const Vec3& position : positions)
+    {
+        const Vec3 offset = sub(position, center);
+        radius = std::max(radius, std::sqrt(dot(offset, offset)));
+    }
+    header.bounds = {center, radius};
+
+    // The LODs, their indices and meshlets one after the other
+    std::vector<MeshLod> lodRanges(lods.size());
+    std::vector<uint32_t> indices;
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint8_t> meshletTriangles;
+
+    for (size_t l = 0; l < lods.size(); ++l)
+    {
+        MeshLod& range = lodRanges[l];
+        range.firstIndex = static_cast<uint32_t>(indices.size());
+        range.indexCount = static_cast<uint32_t>(lods[l].size());
+        range.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+        range.error = errors[l];
+
+        indices.insert(indices.end(), lods[l].begin(), lods[l].end());
+
+        if (_settings.meshlets)
+        {
+            buildMeshlets(lods[l], positions, _settings, meshlets, meshletVertices,
+                          meshletTriangles);
+        }
+        range.meshletCount = static_cast<uint32_t>(meshlets.size()) - range.firstMeshlet;
+    }
+
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.meshletCount = static_cast<uint32_t>(meshlets.size());
+    header.meshletVertexCount = static_cast<uint32_t>(meshletVertices.size());
+    header.meshletTriangleSize = static_cast<uint32_t>(meshletTriangles.size());
+
+    // Written in the order parseMesh() reads, every section 16-byte aligned
+    std::vector<uint8_t> file;
+    auto write = [&file](const void* _data, size_t _size)
+    {
+        file.resize((file.size() + 15) & ~size_t{15});
+        const auto* bytes = static_cast<const uint8_t*>(_data);
+        file.insert(file.end(), bytes, bytes + _size);
+    };
+
+    write(&header, sizeof(header));
+    write(lodRanges.data(), lodRanges.size() * sizeof(MeshLod));
+    write(packed.data(), packed.size() * sizeof(PackedVertex));
+    write(indices.data(), indices.size() * sizeof(uint32_t));
+    write(meshlets.data(), meshlets.size() * sizeof(Meshlet));
+    write(meshletVertices.data(), meshletVertices.size() * sizeof(uint32_t));
+    write(meshletTriangles.data(), meshletTriangles.size());
+
+    return pieces::Ok<std::vector<uint8_t>, std::string>(std::move(file));
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,129 @@
+#include "mosaic/graphics/meshlet_culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mosaic/graphics/occlusion_culling.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// How far apart the squared scales of the axes are still one scale for the cones
+static constexpr float k_uniformScaleTolerance = 1e-3f;
+
+bool transformMeshletCone(Matrix4 _world, const Meshlet& _meshlet,
+                          std::array<float, 3>& _axis) noexcept
+{
+    if (!(_meshlet.coneCutoff < 1.0f)) return false;
+
+    float minScale = INFINITY;
+    float maxScale = 0.0f;
+    for (int column = 0; column < 3; ++column)
+    {
+        const float* axis = &_world[column * 4];
+        const float scale = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        minScale = std::min(minScale, scale);
+        maxScale = std::max(maxScale, scale);
+    }
+
+    if (!(minScale > 0.0f) || maxScale > minScale * (1.0f + k_uniformScaleTolerance)) return false;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        _axis[i] = _world[i] * _meshlet.coneAxis[0] + _world[4 + i] * _meshlet.coneAxis[1] +
+                   _world[8 + i] * _meshlet.coneAxis[2];
+    }
+
+    const float length =
+        std::sqrt(_axis[0] * _axis[0] + _axis[1] * _axis[1] + _axis[2] * _axis[2]);
+    if (!(length > 0.0f)) return false;
+
+    for (float& value : _axis) value /= length;
+    return true;
+}
+
+bool isMeshletBackfacing(const BoundingSphere& _bounds, const std::array<float, 3>& _axis,
+                         float _cutoff, const std::array<float, 3>& _camera) noexcept
+{
+    const std::array<float, 3> direction = {_bounds.center[0] - _camera[0],
+                                            _bounds.center[1] - _camera[1],
+                                            _bounds.center[2] - _camera[2]};
+
+    const float distance = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] +
+                                     direction[2] * direction[2]);
+
+    return direction[0] * _axis[0] + direction[1] * _axis[1] + direction[2] * _axis[2] >=
+           _cutoff * distance + _bounds.radius;
+}
+
+void buildMeshletTasks(std::span<const MeshletInstance> _instances,
+                       std::vector<MeshletTask>& _tasks)
+{
+    _tasks.clear();
+
+    for (uint32_t i = 0; i < _instances.size(); ++i)
+    {
+        const MeshletInstance& instance = _instances[i];
+
+        for (uint32_t first = 0; first < instance.meshletCount; first += k_meshletTaskSize)
+        {
+            MeshletTask& task = _tasks.emplace_back();
+            task.instance = i;
+            task.firstMeshlet = instance.firstMeshlet + first;
+            task.meshletCount = std::min(instance.meshletCount - first, k_meshletTaskSize);
+        }
+    }
+}
+
+uint32_t cullMeshlets(const MeshletCullUniforms& _uniforms,
+                      std::span<const MeshletInstance> _instances,
+                      std::span<const std::span<const Meshlet>> _meshlets,
+                      std::span<const MeshletTask> _tasks, std::span<VisibleMeshlet> _visible,
+                      const OcclusionBuffer* _occlusion) noexcept
+{
+    const Frustum frustum = {_uniforms.frustum};
+    const bool cone = (_uniforms.flags & MeshletCullUniforms::k_cone) != 0;
+    const bool occlusion = _occlusion && (_uniforms.flags & MeshletCullUniforms::k_occlusion);
+
+    uint32_t visibleCount = 0;
+
+    for (const MeshletTask& task : _tasks)
+    {
+        if (task.instance >= _instances.size()) continue;
+
+        const MeshletInstance& instance = _instances[task.instance];
+        if (instance.mesh >= _meshlets.size()) continue;
+
+        const std::span<const Meshlet> meshlets = _meshlets[instance.mesh];
+
+        for (uint32_t m = task.firstMeshlet; m < task.firstMeshlet + task.meshletCount; ++m)
+        {
+            if (m >= meshlets.size()) break;
+
+            const Meshlet& meshlet = meshlets[m];
+            const BoundingSphere bounds = transformSphere(instance.world, meshlet.bounds);
+
+            if (!isSphereInFrustum(frustum, bounds)) continue;
+
+            std::array<float, 3> axis;
+            if (cone && transformMeshletCone(instance.world, meshlet, axis) &&
+                isMeshletBackfacing(bounds, axis, meshlet.coneCutoff, _uniforms.cameraPosition))
+            {
+                continue;
+            }
+
+            if (occlusion && _occlusion->isOccluded(bounds)) continue;
+
+            // the shader appends with an atomic, past the end only the count grows
+            if (visibleCount < _visible.size()) _visible[visibleCount] = {task.instance, m};
+            ++visibleCount;
+        }
+    }
+
+    return visibleCount;
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,235 @@
+#include "mosaic/graphics/occlusion_culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The texels of a level a sphere's rectangle is tested against, at most, along each axis
+static constexpr uint32_t k_maxTestedTexels = 4;
+
+// _matrix times the point (_x, _y, _z, 1), column-major
+static std::array<float, 3> transformPoint(Matrix4 _matrix, float _x, float _y, float _z) noexcept
+{
+    std::array<float, 3> point;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        point[i] = _matrix[i] * _x + _matrix[4 + i] * _y + _matrix[8 + i] * _z + _matrix[12 + i];
+    }
+
+    return point;
+}
+
+OcclusionBuffer::OcclusionBuffer(uint32_t _width, uint32_t _height)
+    : m_width(std::max(_width, 1u)), m_height(std::max(_height, 1u))
+{
+    uint32_t levelCount = 1;
+    while (getLevelWidth(levelCount - 1) > 1 || getLevelHeight(levelCount - 1) > 1) ++levelCount;
+
+    m_levels.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        m_levels[level].resize(getLevelWidth(level) * getLevelHeight(level), 0.0f);
+    }
+}
+
+void OcclusionBuffer::begin(Matrix4 _view, float _p00, float _p11, float _zNear)
+{
+    std::copy(_view.begin(), _view.end(), m_view.begin());
+    m_p00 = _p00;
+    m_p11 = _p11;
+    m_zNear = _zNear;
+
+    for (std::vector<float>& level : m_levels) std::fill(level.begin(), level.end(), 0.0f);
+}
+
+void OcclusionBuffer::rasterize(std::span<const float> _positions,
+                                std::span<const uint32_t> _indices, Matrix4 _world)
+{
+    const size_t vertexCount = _positions.size() / 3;
+    const float width = static_cast<float>(m_width);
+    const float height = static_cast<float>(m_height);
+
+    // the vertices in pixels, their depth
+    std::vector<std::array<float, 3>> screen(vertexCount);
+    std::vector<bool> inFront(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const std::array<float, 3> world =
+            transformPoint(_world, _positions[i * 3], _positions[i * 3 + 1], _positions[i * 3 + 2]);
+        const std::array<float, 3> view = transformPoint(m_view, world[0], world[1], world[2]);
+
+        const float w = -view[2];
+        inFront[i] = w >= m_zNear;
+        if (!inFront[i]) continue;
+
+        // clip space to pixels, y down as the uv of projectSphere()
+        screen[i] = {(view[0] * m_p00 / w * 0.5f + 0.5f) * width,
+                     (view[1] * m_p11 / w * -0.5f + 0.5f) * height, m_zNear / w};
+    }
+
+    std::vector<float>& depths = m_levels[0];
+
+    for (size_t t = 0; t + 2 < _indices.size(); t += 3)
+    {
+        const uint32_t i0 = _indices[t];
+        const uint32_t i1 = _indices[t + 1];
+        const uint32_t i2 = _indices[t + 2];
+        if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount) continue;
+        if (!inFront[i0] || !inFront[i1] || !inFront[i2]) continue;
+
+        const std::array<float, 3>& a = screen[i0];
+        const std::array<float, 3>& b = screen[i1];
+        const std::array<float, 3>& c = screen[i2];
+
+        const float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+        if (area == 0.0f) continue;
+
+        // either winding: the edge functions of a counter-clockwise triangle are made positive
+        const float sign = area > 0.0f ? 1.0f : -1.0f;
+        const float depth = std::min({a[2], b[2], c[2]});
+
+        const int minX = std::max(0, static_cast<int>(std::floor(std::min({a[0], b[0], c[0]}))));
+        const int minY = std::max(0, static_cast<int>(std::floor(std::min({a[1], b[1], c[1]}))));
+        const int maxX = std::min(static_cast<int>(m_width) - 1,
+                                  static_cast<int>(std::ceil(std::max({a[0], b[0], c[0]}))));
+        const int maxY = std::min(static_cast<int>(m_height) - 1,
+                                  static_cast<int>(std::ceil(std::max({a[1], b[1], c[1]}))));
+
+        const auto edge = [sign](const std::array<float, 3>& _from,
+                                 const std::array<float, 3>& _to, float _x, float _y)
+        {
+            return sign * ((_to[0] - _from[0]) * (_y - _from[1]) -
+                           (_to[1] - _from[1]) * (_x - _from[0]));
+        };
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            const float centerY = static_cast<float>(y) + 0.5f;
+
+            for (int x = minX; x <= maxX; ++x)
+            {
+                const float centerX = static_cast<float>(x) + 0.5f;
+
+                if (edge(a, b, centerX, centerY) < 0.0f || edge(b, c, centerX, centerY) < 0.0f ||
+                    edge(c, a, centerX, centerY) < 0.0f)
+                {
+                    continue;
+                }
+
+                // reverse-Z: the nearest occluder of the pixel
+                float& stored = depths[static_cast<size_t>(y) * m_width + x];
+                stored = std::max(stored, depth);
+            }
+        }
+    }
+}
+
+void OcclusionBuffer::finish()
+{
+    for (uint32_t level = 1; level < m_levels.size(); ++level)
+    {
+        const std::vector<float>& source = m_levels[level - 1];
+        std::vector<float>& destination = m_levels[level];
+
+        const uint32_t sourceWidth = getLevelWidth(level - 1);
+        const uint32_t sourceHeight = getLevelHeight(level - 1);
+        const uint32_t levelWidth = getLevelWidth(level);
+        const uint32_t levelHeight = getLevelHeight(level);
+
+        for (uint32_t y = 0; y < levelHeight; ++y)
+        {
+            // an odd source row or column is folded into the last texel
+            const uint32_t lastY = y + 1 == levelHeight ? sourceHeight - 1 : y * 2 + 1;
+
+            for (uint32_t x = 0; x < levelWidth; ++x)
+            {
+                const uint32_t lastX = x + 1 == levelWidth ? sourceWidth - 1 : x * 2 + 1;
+
+                float depth = 1.0f;
+                for (uint32_t sy = std::min(y * 2, sourceHeight - 1); sy <= lastY; ++sy)
+                {
+                    for (uint32_t sx = std::min(x * 2, sourceWidth - 1); sx <= lastX; ++sx)
+                    {
+                        depth = std::min(depth, source[sy * sourceWidth + sx]);
+                    }
+                }
+
+                destination[y * levelWidth + x] = depth;
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::isOccluded(const BoundingSphere& _sphere) const noexcept
+{
+    const std::array<float, 3> center =
+        transformPoint(m_view, _sphere.center[0], _sphere.center[1], _sphere.center[2]);
+    const BoundingSphere viewSphere = {center, _sphere.radius};
+
+    const auto rectangle = projectSphere(viewSphere, m_zNear, m_p00, m_p11);
+    if (!rectangle) return false;
+
+    const auto& [u0, v0, u1, v1] = *rectangle;
+    if (u1 <= 0.0f || v1 <= 0.0f || u0 >= 1.0f || v0 >= 1.0f) return false;
+
+    const auto toTexel = [](float _coordinate, uint32_t _size)
+    {
+        const float texel = std::floor(_coordinate * static_cast<float>(_size));
+        return static_cast<uint32_t>(std::clamp(texel, 0.0f, static_cast<float>(_size - 1)));
+    };
+
+    uint32_t minX = toTexel(u0, m_width);
+    uint32_t minY = toTexel(v0, m_height);
+    uint32_t maxX = toTexel(u1, m_width);
+    uint32_t maxY = toTexel(v1, m_height);
+
+    // the level the rectangle covers a few texels of
+    uint32_t level = 0;
+    while (level + 1 < m_levels.size() &&
+           (maxX - minX >= k_maxTestedTexels || maxY - minY >= k_maxTestedTexels))
+    {
+        ++level;
+        minX = std::min(minX / 2, getLevelWidth(level) - 1);
+        minY = std::min(minY / 2, getLevelHeight(level) - 1);
+        maxX = std::min(maxX / 2, getLevelWidth(level) - 1);
+        maxY = std::min(maxY / 2, getLevelHeight(level) - 1);
+    }
+
+    float occluderDepth = 1.0f;
+    for (uint32_t y = minY; y <= maxY; ++y)
+    {
+        for (uint32_t x = minX; x <= maxX; ++x)
+        {
+            occluderDepth = std::min(occluderDepth, getDepth(x, y, level));
+        }
+    }
+
+    // reverse-Z: the nearest point of the sphere behind the farthest occluder depth
+    const float sphereDepth = m_zNear / (-center[2] - _sphere.radius);
+
+    return sphereDepth < occluderDepth;
+}
+
+float OcclusionBuffer::getDepth(uint32_t _x, uint32_t _y, uint32_t _level) const noexcept
+{
+    return m_levels[_level][_y * getLevelWidth(_level) + _x];
+}
+
+uint32_t OcclusionBuffer::getLevelWidth(uint32_t _level) const noexcept
+{
+    return std::max(m_width >> _level, 1u);
+}
+
+uint32_t OcclusionBuffer::getLevelHeight(uint32_t _level) const noexcept
+{
+    return std::max(m_height >> _level, 1u);
+}
+
+} // namespace graphics
+} // namespace mosaic
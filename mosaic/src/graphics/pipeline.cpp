@@ -0,0 +1,102 @@
+#include "mosaic/graphics/pipeline.hpp"
+
+#include <string_view>
+#include <type_traits>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+namespace
+{
+
+// FNV-1a, fed field by field so the padding of the states never reaches it
+struct PipelineHasher
+{
+    static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    void bytes(const void* _data, size_t _size) noexcept
+    {
+        const auto* data = static_cast<const uint8_t*>(_data);
+        for (size_t i = 0; i < _size; ++i)
+        {
+            hash ^= data[i];
+            hash *= FNV_PRIME;
+        }
+    }
+
+    template <typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    void value(T _value) noexcept
+    {
+        bytes(&_value, sizeof(T));
+    }
+
+    // The size first, so that ("ab", "c") and ("a", "bc") differ
+    void string(std::string_view _string) noexcept
+    {
+        value(_string.size());
+        bytes(_string.data(), _string.size());
+    }
+};
+
+} // namespace
+
+uint64_t hashPipelineDescription(const PipelineDescription& _description) noexcept
+{
+    PipelineHasher hasher;
+
+    hasher.value(_description.shaders.size());
+    for (const ShaderDescription& shader : _description.shaders)
+    {
+        hasher.value(shader.stage);
+        hasher.value(shader.bytecode.size());
+        hasher.bytes(shader.bytecode.data(), shader.bytecode.size());
+        hasher.string(shader.entryPoint);
+
+        hasher.value(shader.specialization.size());
+        for (const SpecializationConstant& constant : shader.specialization)
+        {
+            hasher.value(constant.id);
+            hasher.value(constant.value);
+        }
+    }
+
+    const VertexLayout& layout = _description.vertexLayout;
+    hasher.value(layout.stride);
+    hasher.value(layout.attributes.size());
+    for (const VertexInputAttribute& attribute : layout.attributes)
+    {
+        hasher.value(attribute.format);
+        hasher.value(attribute.location);
+        hasher.value(attribute.offset);
+    }
+
+    hasher.value(_description.rasterState.cullMode);
+    hasher.value(_description.rasterState.fillMode);
+    hasher.value(_description.rasterState.frontFaceCCW);
+
+    hasher.value(_description.depthState.depthTestEnable);
+    hasher.value(_description.depthState.depthWriteEnable);
+    hasher.value(_description.depthState.compareOp);
+
+    hasher.value(_description.blendState.enable);
+    hasher.value(_description.topology);
+
+    return hasher.hash;
+}
+
+uint64_t hashShaderBytecode(std::span<const uint8_t> _bytecode) noexcept
+{
+    PipelineHasher hasher;
+    hasher.bytes(_bytecode.data(), _bytecode.size());
+
+    return hasher.hash;
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,64 @@
+#include "mosaic/graphics/present_mode.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static constexpr std::array k_lowLatency = {PresentMode::Mailbox, PresentMode::Fifo};
+static constexpr std::array k_vsync = {PresentMode::Fifo};
+static constexpr std::array k_powerSave = {PresentMode::FifoRelaxed, PresentMode::Fifo};
+static constexpr std::array k_uncapped = {PresentMode::Immediate, PresentMode::Mailbox,
+                                          PresentMode::Fifo};
+
+// In the order they are tried
+static std::span<const PresentMode> getPreferences(PresentPolicy _policy) noexcept
+{
+    switch (_policy)
+    {
+        case PresentPolicy::LowLatency:
+            return k_lowLatency;
+        case PresentPolicy::VSync:
+            return k_vsync;
+        case PresentPolicy::PowerSave:
+            return k_powerSave;
+        case PresentPolicy::Uncapped:
+            return k_uncapped;
+    }
+
+    return k_vsync;
+}
+
+PresentMode choosePresentMode(PresentPolicy _policy,
+                              std::span<const PresentMode> _supported) noexcept
+{
+    for (PresentMode mode : getPreferences(_policy))
+    {
+        if (std::find(_supported.begin(), _supported.end(), mode) != _supported.end()) return mode;
+    }
+
+    return PresentMode::Fifo;
+}
+
+const char* getPresentModeName(PresentMode _mode) noexcept
+{
+    switch (_mode)
+    {
+        case PresentMode::Immediate:
+            return "immediate";
+        case PresentMode::Mailbox:
+            return "mailbox";
+        case PresentMode::Fifo:
+            return "FIFO";
+        case PresentMode::FifoRelaxed:
+            return "FIFO relaxed";
+    }
+
+    return "unknown";
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,132 @@
+#include "mosaic/graphics/readback.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static size_t alignUp(size_t _value, size_t _alignment)
+{
+    return (_value + _alignment - 1) & ~(_alignment - 1);
+}
+
+void ReadbackRing::reset(const std::byte* _memory, size_t _capacity)
+{
+    cancel();
+
+    m_memory = _memory;
+    m_capacity = _capacity;
+}
+
+Readback ReadbackRing::allocate(size_t _size, uint64_t _frame, size_t _alignment)
+{
+    if (_size == 0 || _size > m_capacity) return {};
+
+    size_t offset = 0;
+
+    if (!m_pending.empty())
+    {
+        const size_t tail = m_pending.front().offset;
+        const size_t aligned = alignUp(m_head, _alignment);
+
+        if (m_head > tail)
+        {
+            // the copies in flight span [tail, head): after them, else wrapped before the tail
+            if (aligned <= m_capacity && _size <= m_capacity - aligned) offset = aligned;
+            else if (_size <= tail) offset = 0;
+            else return {};
+        }
+        else
+        {
+            // wrapped: the room is between the head and the tail
+            if (aligned > tail || _size > tail - aligned) return {};
+            offset = aligned;
+        }
+    }
+
+    Pending& pending = m_pending.emplace_back();
+    pending.offset = offset;
+    pending.size = _size;
+    pending.frame = _frame;
+    m_head = offset + _size;
+
+    Readback readback;
+    readback.offset = offset;
+    readback.size = _size;
+    readback.future = pending.promise.getFuture();
+    return readback;
+}
+
+void ReadbackRing::complete(uint64_t _completedFrame)
+{
+    while (!m_pending.empty() && m_pending.front().frame <= _completedFrame)
+    {
+        // popped first: a continuation may allocate the next copy
+        Pending pending = std::move(m_pending.front());
+        m_pending.pop_front();
+        if (m_pending.empty()) m_head = 0;
+
+        std::vector<std::byte> bytes(pending.size);
+        std::memcpy(bytes.data(), m_memory + pending.offset, pending.size);
+        pending.promise.setValue(std::move(bytes));
+    }
+}
+
+void ReadbackRing::cancel() noexcept
+{
+    // the promises break as they are destroyed
+    m_pending.clear();
+    m_head = 0;
+}
+
+PickRegion getPickRegion(glm::uvec2 _pixel, glm::uvec2 _extent, uint32_t _radius) noexcept
+{
+    if (_pixel.x >= _extent.x || _pixel.y >= _extent.y) return {};
+
+    PickRegion region;
+    region.offset = {_pixel.x - std::min(_pixel.x, _radius),
+                     _pixel.y - std::min(_pixel.y, _radius)};
+
+    const glm::uvec2 end = {_pixel.x + std::min(_extent.x - _pixel.x - 1, _radius) + 1,
+                            _pixel.y + std::min(_extent.y - _pixel.y - 1, _radius) + 1};
+    region.extent = end - region.offset;
+    return region;
+}
+
+uint32_t findPickedEntity(std::span<const uint32_t> _ids, const PickRegion& _region,
+                          glm::uvec2 _pixel) noexcept
+{
+    if (_ids.size() < _region.getTexelCount()) return 0;
+
+    uint32_t picked = 0;
+    int64_t closest = std::numeric_limits<int64_t>::max();
+
+    for (uint32_t y = 0; y < _region.extent.y; ++y)
+    {
+        for (uint32_t x = 0; x < _region.extent.x; ++x)
+        {
+            const uint32_t id = _ids[size_t{y} * _region.extent.x + x];
+            if (id == 0) continue;
+
+            const int64_t dx = int64_t{_region.offset.x} + x - _pixel.x;
+            const int64_t dy = int64_t{_region.offset.y} + y - _pixel.y;
+            const int64_t distance = dx * dx + dy * dy;
+
+            // the first in row order of those as close
+            if (distance < closest)
+            {
+                closest = distance;
+                picked = id;
+            }
+        }
+    }
+
+    return picked;
+}
+
+} // namespace graphics
+} // namespace mosaic
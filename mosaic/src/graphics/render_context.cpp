@@ -1,5 +1,6 @@
 #include "mosaic/graphics/render_context.hpp"
 
+#include "mosaic/tools/tracer.hpp"
 #include "mosaic/window/window.hpp"
 
 namespace mosaic
@@ -11,24 +12,82 @@ struct RenderContext::Impl
 {
     const window::Window* m_window;
     RenderContextSettings m_settings;
+    InputLatency m_inputLatency;
+    uint64_t m_tracedLatencies; // the samples measured when the percentiles were traced last
 
     Impl(const window::Window* _window, const RenderContextSettings& _settings)
-        : m_window(_window), m_settings(_settings){};
+        : m_window(_window), m_settings(_settings), m_tracedLatencies(0){};
 };
 
+// The percentiles as counters, when the frames presented meanwhile changed them
+static void traceInputLatency(const InputLatency& _latency, uint64_t& _traced)
+{
+    if (_latency.getMeasuredCount() == _traced) return;
+    _traced = _latency.getMeasuredCount();
+
+    if (!tools::Tracer::isRecording(tools::TraceCategory::render)) return;
+
+    tools::Tracer* tracer = tools::Tracer::getInstance();
+    if (!tracer) return;
+
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    const InputLatency::Percentiles& percentiles = _latency.getPercentiles();
+    const auto category = tools::TraceCategory::render;
+
+    tracer->counterTrace("Input latency p50 (ms)", Milliseconds(percentiles.p50).count(), category);
+    tracer->counterTrace("Input latency p95 (ms)", Milliseconds(percentiles.p95).count(), category);
+    tracer->counterTrace("Input latency p99 (ms)", Milliseconds(percentiles.p99).count(), category);
+}
+
 RenderContext::RenderContext(const window::Window* _window, const RenderContextSettings& _settings)
     : m_impl(new Impl(_window, _settings)){};
 
 RenderContext::~RenderContext() { delete m_impl; }
 
+void RenderContext::pace()
+{
+    waitForFrame();
+
+    // the frames seen presented while waiting
+    traceInputLatency(m_impl->m_inputLatency, m_impl->m_tracedLatencies);
+}
+
 void RenderContext::render()
 {
-    beginFrame();
+    if (!beginFrame()) return;
+
     updateResources();
     drawScene();
     endFrame();
 }
 
+pieces::Result<ExportedFrames, std::string> RenderContext::exportFrames()
+{
+    return pieces::Err<ExportedFrames, std::string>("The backend does not export its frames");
+}
+
+std::optional<uint32_t> RenderContext::getLastExportedImage() const { return std::nullopt; }
+
+void RenderContext::setLowLatency(bool _enabled) { m_impl->m_settings.lowLatency = _enabled; }
+
+void RenderContext::setPresentPolicy(PresentPolicy _policy)
+{
+    if (m_impl->m_settings.presentPolicy == _policy) return;
+
+    m_impl->m_settings.presentPolicy = _policy;
+    applyPresentPolicy();
+}
+
+void RenderContext::setResolutionLimit(float _limit)
+{
+    m_impl->m_settings.resolutionLimit = _limit;
+}
+
+void RenderContext::consumeInput(InputLatency::Clock::time_point _input)
+{
+    m_impl->m_inputLatency.consumeInput(_input);
+}
+
 const window::Window* RenderContext::getWindow() const { return m_impl->m_window; }
 
 const RenderContextSettings RenderContext::getSettings() const { return m_impl->m_settings; }
@@ -38,7 +97,11 @@ window::Window* RenderContext::getWindowInternal()
     return const_cast<window::Window*>(m_impl->m_window);
 }
 
+const InputLatency& RenderContext::getInputLatency() const { return m_impl->m_inputLatency; }
+
 RenderContextSettings& RenderContext::getSettingsInternal() { return m_impl->m_settings; }
 
+InputLatency& RenderContext::getInputLatencyInternal() { return m_impl->m_inputLatency; }
+
 } // namespace graphics
 } // namespace mosaic
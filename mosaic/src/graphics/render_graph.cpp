@@ -0,0 +1,671 @@
+#include "mosaic/graphics/render_graph.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pieces/memory/frame_arena.hpp>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// Render targets are placed at this alignment when the backend gives no requirements
+static constexpr size_t k_estimatedAlignment = 64 * 1024;
+
+static size_t bytesPerTexel(TextureFormat _format)
+{
+    switch (_format)
+    {
+        case TextureFormat::RGBA16F:
+            return 8;
+        case TextureFormat::RGBA8:
+        case TextureFormat::BGRA8:
+        case TextureFormat::R32UI:
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F:
+        default:
+            return 4;
+    }
+}
+
+static RenderGraph::MemoryRequirements estimateRequirements(const TextureDescription& _desc)
+{
+    size_t texels = 0;
+    for (uint32_t mip = 0; mip < std::max(_desc.mipLevels, 1u); ++mip)
+    {
+        texels += size_t{std::max(_desc.width >> mip, 1u)} * std::max(_desc.height >> mip, 1u);
+    }
+
+    return {texels * bytesPerTexel(_desc.format), k_estimatedAlignment};
+}
+
+static size_t alignUp(size_t _offset, size_t _alignment)
+{
+    return (_offset + _alignment - 1) / _alignment * _alignment;
+}
+
+// Whether the access needs the contents the texture had before the pass
+static bool readsContents(const RenderGraphAccess& _access)
+{
+    return !RenderGraph::isWriteAccess(_access.access) || _access.load == AttachmentLoad::Load;
+}
+
+static bool overwritesContents(const RenderGraphAccess& _access)
+{
+    return RenderGraph::isWriteAccess(_access.access) && _access.load != AttachmentLoad::Load;
+}
+
+static bool hasAttachments(const RenderGraph::Pass& _pass)
+{
+    return std::ranges::any_of(_pass.accesses, [](const RenderGraphAccess& _access)
+                               { return RenderGraph::isAttachmentAccess(_access.access); });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderGraphBuilder
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RenderGraphResource RenderGraphBuilder::create(const std::string& _name,
+                                               const TextureDescription& _description)
+{
+    return m_graph->addResource(
+        {_name, _description, false, ResourceAccess::None, ResourceAccess::None});
+}
+
+RenderGraphResource RenderGraphBuilder::read(RenderGraphResource _resource,
+                                             ResourceAccess _access)
+{
+    if (RenderGraph::isWriteAccess(_access) || _access == ResourceAccess::None ||
+        _access == ResourceAccess::Present)
+    {
+        throw std::invalid_argument("Render graph: not a read access!");
+    }
+
+    m_graph->addAccess(m_pass, _resource, _access, AttachmentLoad::Load);
+
+    return _resource;
+}
+
+RenderGraphResource RenderGraphBuilder::write(RenderGraphResource _resource,
+                                              ResourceAccess _access, AttachmentLoad _load)
+{
+    if (!RenderGraph::isWriteAccess(_access))
+    {
+        throw std::invalid_argument("Render graph: not a write access!");
+    }
+
+    m_graph->addAccess(m_pass, _resource, _access, _load);
+
+    return _resource;
+}
+
+void RenderGraphBuilder::setSideEffects() { m_graph->m_passes[m_pass].sideEffects = true; }
+
+void RenderGraphBuilder::setParallelRecording()
+{
+    m_graph->m_passes[m_pass].parallelRecording = true;
+}
+
+void RenderGraphBuilder::setQueue(RenderGraphQueue _queue)
+{
+    m_graph->m_passes[m_pass].queue = _queue;
+}
+
+void RenderGraphBuilder::dependOn(uint32_t _pass)
+{
+    if (_pass >= m_pass)
+    {
+        throw std::invalid_argument("Render graph: " + m_graph->m_passes[m_pass].name +
+                                    " depends on a pass not added before it!");
+    }
+
+    m_graph->m_passes[m_pass].dependencies.push_back(_pass);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderGraph
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RenderGraphResource RenderGraph::importTexture(const std::string& _name,
+                                               const TextureDescription& _description,
+                                               ResourceAccess _initialAccess,
+                                               ResourceAccess _finalAccess)
+{
+    return addResource({_name, _description, true, _initialAccess, _finalAccess});
+}
+
+uint32_t RenderGraph::addPass(const std::string& _name, const SetupFunction& _setup,
+                              ExecuteFunction _execute)
+{
+    const auto pass = static_cast<uint32_t>(m_passes.size());
+
+    m_passes.push_back({_name, {}, std::move(_execute)});
+    m_compiled = false;
+
+    RenderGraphBuilder builder(this, pass);
+    _setup(builder);
+
+    return pass;
+}
+
+void RenderGraph::setDescription(RenderGraphResource _resource,
+                                 const TextureDescription& _description)
+{
+    m_resources.at(_resource.id).description = _description;
+    m_compiled = false;
+}
+
+void RenderGraph::compile(const MemoryRequirementsFunction& _requirements)
+{
+    m_compiled = false;
+
+    for (Resource& resource : m_resources)
+    {
+        resource.accessMask = 0;
+        resource.firstPass = k_unused;
+        resource.lastPass = k_unused;
+        resource.heapOffset = 0;
+        resource.heapSize = 0;
+        resource.memoryless = false;
+        resource.asyncCompute = false;
+    }
+
+    for (Pass& pass : m_passes)
+    {
+        pass.culled = false;
+        pass.barriers.clear();
+        pass.renderPass = k_unused;
+        pass.subpass = 0;
+        pass.batch = k_unused;
+    }
+
+    m_executionOrder.clear();
+    m_batches.clear();
+    m_finalBarriers.clear();
+    m_heapSize = 0;
+    m_heapAlignment = 1;
+
+    cullPasses();
+    mergeSubpasses();
+    computeBarriers();
+    buildBatches();
+    placeTransients(_requirements);
+
+    m_compiled = true;
+}
+
+void RenderGraph::reset() noexcept
+{
+    m_resources.clear();
+    m_passes.clear();
+    m_executionOrder.clear();
+    m_batches.clear();
+    m_finalBarriers.clear();
+    m_heapSize = 0;
+    m_heapAlignment = 1;
+    m_compiled = false;
+}
+
+bool RenderGraph::isWriteAccess(ResourceAccess _access) noexcept
+{
+    switch (_access)
+    {
+        case ResourceAccess::ColorAttachment:
+        case ResourceAccess::DepthAttachment:
+        case ResourceAccess::ResolveAttachment:
+        case ResourceAccess::StorageWrite:
+        case ResourceAccess::TransferDestination:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool RenderGraph::isAttachmentAccess(ResourceAccess _access) noexcept
+{
+    switch (_access)
+    {
+        case ResourceAccess::ColorAttachment:
+        case ResourceAccess::DepthAttachment:
+        case ResourceAccess::DepthRead:
+        case ResourceAccess::InputAttachment:
+        case ResourceAccess::ResolveAttachment:
+            return true;
+        default:
+            return false;
+    }
+}
+
+RenderGraphResource RenderGraph::addResource(Resource&& _resource)
+{
+    m_resources.push_back(std::move(_resource));
+    m_compiled = false;
+
+    return {static_cast<uint32_t>(m_resources.size() - 1)};
+}
+
+void RenderGraph::addAccess(uint32_t _pass, RenderGraphResource _resource,
+                            ResourceAccess _access, AttachmentLoad _load)
+{
+    if (_resource.id >= m_resources.size())
+    {
+        throw std::invalid_argument("Render graph: unknown texture!");
+    }
+
+    auto& accesses = m_passes[_pass].accesses;
+
+    if (std::ranges::find(accesses, _resource, &RenderGraphAccess::resource) != accesses.end())
+    {
+        throw std::invalid_argument("Render graph: " + m_resources[_resource.id].name +
+                                    " is used twice by " + m_passes[_pass].name + "!");
+    }
+
+    accesses.push_back({_resource, _access, _load, true});
+}
+
+void RenderGraph::cullPasses()
+{
+    // From the last pass back, the textures whose current contents a kept pass needs
+    std::vector<bool> needed(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); ++i) needed[i] = m_resources[i].imported;
+
+    // and the passes a kept pass depends on
+    std::vector<bool> required(m_passes.size());
+
+    for (size_t i = m_passes.size(); i-- > 0;)
+    {
+        Pass& pass = m_passes[i];
+
+        pass.culled = !pass.sideEffects && !required[i] &&
+                      std::ranges::none_of(pass.accesses,
+                                           [&](const RenderGraphAccess& _access)
+                                           {
+                                               return isWriteAccess(_access.access) &&
+                                                      needed[_access.resource.id];
+                                           });
+
+        if (pass.culled) continue;
+
+        for (const uint32_t dependency : pass.dependencies) required[dependency] = true;
+
+        // what the earlier passes wrote is overwritten here, unless imported
+        for (const RenderGraphAccess& access : pass.accesses)
+        {
+            const auto id = access.resource.id;
+            if (overwritesContents(access) && !m_resources[id].imported) needed[id] = false;
+        }
+
+        for (const RenderGraphAccess& access : pass.accesses)
+        {
+            if (readsContents(access)) needed[access.resource.id] = true;
+        }
+    }
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        if (!m_passes[i].culled) m_executionOrder.push_back(i);
+    }
+}
+
+void RenderGraph::mergeSubpasses()
+{
+    // the passes of the render pass so far, none after a pass without attachments
+    std::vector<uint32_t> members;
+    std::pair<uint32_t, uint32_t> extent;
+
+    // that of its first attachment
+    const auto getExtent = [this](const Pass& _pass)
+    {
+        const auto attachment = std::ranges::find_if(
+            _pass.accesses, [](const RenderGraphAccess& _access)
+            { return isAttachmentAccess(_access.access); });
+        const TextureDescription& description = m_resources[attachment->resource.id].description;
+
+        return std::pair(description.width, description.height);
+    };
+
+    for (const uint32_t index : m_executionOrder)
+    {
+        Pass& pass = m_passes[index];
+
+        if (!hasAttachments(pass))
+        {
+            members.clear();
+            continue;
+        }
+
+        const bool readsInput = std::ranges::any_of(
+            pass.accesses, [](const RenderGraphAccess& _access)
+            { return _access.access == ResourceAccess::InputAttachment; });
+
+        if (!readsInput)
+        {
+            members.assign(1, index);
+            pass.renderPass = index;
+            extent = getExtent(pass);
+            continue;
+        }
+
+        const auto writtenBefore = [&](RenderGraphResource _resource)
+        {
+            return std::ranges::any_of(
+                members,
+                [&](uint32_t _member)
+                {
+                    return std::ranges::any_of(m_passes[_member].accesses,
+                                               [&](const RenderGraphAccess& _access)
+                                               {
+                                                   return _access.resource == _resource &&
+                                                          isWriteAccess(_access.access);
+                                               });
+                });
+        };
+
+        // the same render area, and nothing a barrier would have to wait for inside it
+        const auto joins = [&](const RenderGraphAccess& _access)
+        {
+            const TextureDescription& description = m_resources[_access.resource.id].description;
+
+            return isAttachmentAccess(_access.access) && description.width == extent.first &&
+                   description.height == extent.second &&
+                   (_access.access != ResourceAccess::InputAttachment ||
+                    writtenBefore(_access.resource));
+        };
+
+        if (members.empty() || !std::ranges::all_of(pass.accesses, joins))
+        {
+            throw std::invalid_argument("Render graph: " + pass.name +
+                                        " reads input attachments but cannot be a subpass of "
+                                        "the passes before it!");
+        }
+
+        pass.renderPass = members.front();
+        pass.subpass = static_cast<uint32_t>(members.size());
+        members.push_back(index);
+    }
+}
+
+void RenderGraph::computeBarriers()
+{
+    // the access each texture was last left in
+    std::vector<ResourceAccess> states(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); ++i) states[i] = m_resources[i].initialAccess;
+
+    for (const uint32_t index : m_executionOrder)
+    {
+        Pass& pass = m_passes[index];
+
+        // the barriers of a subpass are recorded before its render pass begins
+        const uint32_t barrierPass = pass.renderPass != k_unused ? pass.renderPass : index;
+
+        for (const RenderGraphAccess& access : pass.accesses)
+        {
+            Resource& resource = m_resources[access.resource.id];
+            ResourceAccess& state = states[access.resource.id];
+
+            // the subpass dependencies order the accesses of a render pass
+            const bool sameRenderPass = pass.renderPass != k_unused &&
+                                        resource.lastPass != k_unused &&
+                                        m_passes[resource.lastPass].renderPass == pass.renderPass;
+
+            const bool crossQueue = resource.lastPass != k_unused &&
+                                    m_passes[resource.lastPass].queue != pass.queue;
+
+            resource.accessMask |= 1u << static_cast<uint32_t>(access.access);
+            if (resource.firstPass == k_unused) resource.firstPass = barrierPass;
+            resource.lastPass = index;
+
+            const bool firstUse = !resource.imported && state == ResourceAccess::None;
+
+            if (firstUse && readsContents(access))
+            {
+                throw std::invalid_argument("Render graph: " + pass.name + " reads " +
+                                            resource.name + " before any pass writes it!");
+            }
+
+            // reads in the same access need no barrier between them
+            const bool hazard = state != access.access || isWriteAccess(state) ||
+                                isWriteAccess(access.access);
+
+            if (hazard && !sameRenderPass)
+            {
+                m_passes[barrierPass].barriers.push_back(
+                    {access.resource, state, access.access, firstUse || overwritesContents(access),
+                     false, crossQueue});
+            }
+
+            state = access.access;
+        }
+    }
+
+    // the imported textures are never used by async compute passes
+    for (uint32_t i = 0; i < m_resources.size(); ++i)
+    {
+        const Resource& resource = m_resources[i];
+
+        if (resource.imported && resource.finalAccess != ResourceAccess::None &&
+            states[i] != resource.finalAccess)
+        {
+            m_finalBarriers.push_back({{i}, states[i], resource.finalAccess, false, false});
+        }
+    }
+
+    // From the last pass back: the contents a later pass reads are stored, the others may be
+    // dropped at the end of their pass (tiled GPUs then never write them to memory). The
+    // attachments read are in tile memory, stored too only for the passes after them
+    std::vector<bool> readLater(m_resources.size());
+
+    for (auto it = m_executionOrder.rbegin(); it != m_executionOrder.rend(); ++it)
+    {
+        for (RenderGraphAccess& access : m_passes[*it].accesses)
+        {
+            const auto id = access.resource.id;
+
+            access.storeContents = m_resources[id].imported || readLater[id] ||
+                                   (!isWriteAccess(access.access) &&
+                                    !isAttachmentAccess(access.access));
+
+            if (overwritesContents(access)) readLater[id] = false;
+            if (readsContents(access)) readLater[id] = true;
+        }
+    }
+
+    // The transients only attachments of one render pass whose contents are never stored
+    constexpr uint32_t attachmentMask =
+        1u << static_cast<uint32_t>(ResourceAccess::ColorAttachment) |
+        1u << static_cast<uint32_t>(ResourceAccess::DepthAttachment) |
+        1u << static_cast<uint32_t>(ResourceAccess::DepthRead) |
+        1u << static_cast<uint32_t>(ResourceAccess::InputAttachment) |
+        1u << static_cast<uint32_t>(ResourceAccess::ResolveAttachment);
+
+    std::vector<bool> storedAtEnd(m_resources.size());
+
+    for (Resource& resource : m_resources)
+    {
+        resource.memoryless = !resource.imported && resource.firstPass != k_unused &&
+                              (resource.accessMask & ~attachmentMask) == 0;
+    }
+
+    for (const uint32_t index : m_executionOrder)
+    {
+        for (const RenderGraphAccess& access : m_passes[index].accesses)
+        {
+            const auto id = access.resource.id;
+
+            if (m_passes[index].renderPass != m_resources[id].firstPass)
+            {
+                m_resources[id].memoryless = false;
+            }
+
+            storedAtEnd[id] = access.storeContents;
+        }
+    }
+
+    for (size_t i = 0; i < m_resources.size(); ++i)
+    {
+        if (storedAtEnd[i]) m_resources[i].memoryless = false;
+    }
+}
+
+void RenderGraph::buildBatches()
+{
+    // The last pass of each queue to use each texture, and its access
+    struct Use
+    {
+        uint32_t pass = k_unused;
+        ResourceAccess access = ResourceAccess::None;
+    };
+
+    std::vector<std::array<Use, 2>> uses(m_resources.size());
+
+    for (const uint32_t index : m_executionOrder)
+    {
+        Pass& pass = m_passes[index];
+        const auto queue = static_cast<size_t>(pass.queue);
+
+        if (m_batches.empty() || m_batches.back().queue != pass.queue)
+        {
+            m_batches.push_back({pass.queue, {}, RenderGraphBatch::k_unused});
+        }
+
+        RenderGraphBatch& batch = m_batches.back();
+        pass.batch = static_cast<uint32_t>(m_batches.size() - 1);
+        batch.passes.push_back(index);
+
+        // the batches of the other queue all ran before this one in the execution order
+        const auto waitFor = [&](uint32_t _pass)
+        {
+            if (_pass == k_unused || m_passes[_pass].queue == pass.queue) return;
+
+            const uint32_t other = m_passes[_pass].batch;
+            if (batch.wait == RenderGraphBatch::k_unused || batch.wait < other) batch.wait = other;
+        };
+
+        for (const uint32_t dependency : pass.dependencies) waitFor(dependency);
+
+        for (const RenderGraphAccess& access : pass.accesses)
+        {
+            Resource& resource = m_resources[access.resource.id];
+
+            if (pass.queue == RenderGraphQueue::AsyncCompute)
+            {
+                if (resource.imported || isAttachmentAccess(access.access))
+                {
+                    throw std::invalid_argument("Render graph: " + pass.name +
+                                                " runs on the async compute queue but uses " +
+                                                resource.name + " as an attachment or imported "
+                                                "texture!");
+                }
+
+                resource.asyncCompute = true;
+            }
+
+            // reads in the same access may overlap, anything else waits
+            const Use& other = uses[access.resource.id][1 - queue];
+            if (other.access != access.access || isWriteAccess(other.access) ||
+                isWriteAccess(access.access))
+            {
+                waitFor(other.pass);
+            }
+
+            uses[access.resource.id][queue] = {index, access.access};
+        }
+    }
+}
+
+void RenderGraph::placeTransients(const MemoryRequirementsFunction& _requirements)
+{
+    pieces::FrameArena& arena = pieces::FrameArena::local();
+    auto scope = arena.scope();
+
+    std::pmr::vector<uint32_t> transients(arena.getResource());
+    std::pmr::vector<size_t> alignments(m_resources.size(), 1, arena.getResource());
+
+    for (uint32_t i = 0; i < m_resources.size(); ++i)
+    {
+        Resource& resource = m_resources[i];
+        if (resource.imported || resource.firstPass == k_unused) continue;
+
+        const MemoryRequirements requirements = _requirements
+                                                    ? _requirements({i}, resource.description)
+                                                    : estimateRequirements(resource.description);
+
+        resource.heapSize = requirements.size;
+        alignments[i] = std::max<size_t>(requirements.alignment, 1);
+        m_heapAlignment = std::max(m_heapAlignment, alignments[i]);
+
+        transients.push_back(i);
+    }
+
+    // The largest first, each at the lowest offset free during its lifetime
+    std::ranges::stable_sort(transients, std::ranges::greater{},
+                             [this](uint32_t _id) { return m_resources[_id].heapSize; });
+
+    // the passes of the other queue overlap those of an async compute batch: its transients
+    // live with every other
+    const auto livesWith = [](const Resource& _a, const Resource& _b)
+    {
+        return _a.asyncCompute || _b.asyncCompute ||
+               (_a.firstPass <= _b.lastPass && _b.firstPass <= _a.lastPass);
+    };
+
+    const auto sharesMemory = [](const Resource& _a, const Resource& _b)
+    {
+        return _a.heapOffset < _b.heapOffset + _b.heapSize &&
+               _b.heapOffset < _a.heapOffset + _a.heapSize;
+    };
+
+    for (size_t i = 0; i < transients.size(); ++i)
+    {
+        Resource& resource = m_resources[transients[i]];
+
+        const size_t alignment = alignments[transients[i]];
+
+        for (bool moved = true; moved;)
+        {
+            moved = false;
+
+            for (size_t j = 0; j < i; ++j)
+            {
+                const Resource& placed = m_resources[transients[j]];
+
+                if (livesWith(resource, placed) && sharesMemory(resource, placed))
+                {
+                    resource.heapOffset = alignUp(placed.heapOffset + placed.heapSize, alignment);
+                    moved = true;
+                }
+            }
+        }
+
+        m_heapSize = std::max(m_heapSize, resource.heapOffset + resource.heapSize);
+    }
+
+    // The first use of a transient in the memory of an earlier one waits on it
+    for (const uint32_t id : transients)
+    {
+        const Resource& resource = m_resources[id];
+
+        const bool aliasing = std::ranges::any_of(
+            transients,
+            [&](uint32_t _other)
+            {
+                const Resource& other = m_resources[_other];
+                return other.lastPass < resource.firstPass && sharesMemory(resource, other);
+            });
+
+        if (!aliasing) continue;
+
+        for (RenderGraphBarrier& barrier : m_passes[resource.firstPass].barriers)
+        {
+            if (barrier.resource.id == id) barrier.aliasing = true;
+        }
+    }
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,123 @@
+#include "mosaic/graphics/render_profile.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "mosaic/core/cmd_line_parser.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// More than any surface asks for, the frames queued would only add latency
+static constexpr uint32_t k_maxBackbufferCount = 8;
+
+RenderProfile makeRenderProfile(RenderProfileType _type) noexcept
+{
+    RenderProfile profile;
+
+    switch (_type)
+    {
+        case RenderProfileType::Release:
+            break;
+        case RenderProfileType::Development:
+            profile.debugLabels = true;
+            profile.checks = true;
+            break;
+        case RenderProfileType::Debug:
+            profile.validation = true;
+            profile.debugLabels = true;
+            profile.checks = true;
+            break;
+    }
+
+    return profile;
+}
+
+RenderProfileType getBuildRenderProfileType() noexcept
+{
+#if defined(MOSAIC_DEBUG_BUILD)
+    return RenderProfileType::Debug;
+#elif defined(MOSAIC_DEV_BUILD)
+    return RenderProfileType::Development;
+#else
+    return RenderProfileType::Release;
+#endif
+}
+
+std::optional<RenderProfileType> parseRenderProfileType(std::string_view _name) noexcept
+{
+    if (_name == "release") return RenderProfileType::Release;
+    if (_name == "development" || _name == "dev") return RenderProfileType::Development;
+    if (_name == "debug") return RenderProfileType::Debug;
+
+    return std::nullopt;
+}
+
+const char* getRenderProfileTypeName(RenderProfileType _type) noexcept
+{
+    switch (_type)
+    {
+        case RenderProfileType::Release:
+            return "release";
+        case RenderProfileType::Development:
+            return "development";
+        case RenderProfileType::Debug:
+            return "debug";
+    }
+
+    return "unknown";
+}
+
+RenderProfile& getDefaultRenderProfile() noexcept
+{
+    static RenderProfile profile = makeRenderProfile(getBuildRenderProfileType());
+
+    return profile;
+}
+
+std::optional<std::string> registerRenderProfileOptions(core::CommandLineParser& _parser,
+                                                        RenderProfile& _profile)
+{
+    auto result = _parser.registerTypedOption<std::string>(
+        "render-profile", "", "Render profile",
+        "The validation, debug labels and checks of the renderer: release, development or debug",
+        core::CmdOptionValueTypes::single,
+        [&_profile](const std::vector<std::string>& _values) -> bool
+        {
+            const auto type = parseRenderProfileType(_values.front());
+            if (!type) return false;
+
+            // in whichever order the options are given
+            const uint32_t backbufferCount = _profile.backbufferCount;
+            _profile = makeRenderProfile(*type);
+            _profile.backbufferCount = backbufferCount;
+            return true;
+        });
+
+    if (result) return result;
+
+    return _parser.registerTypedOption<int>(
+        "backbuffers", "", "Swapchain images",
+        "The swapchain images asked for, 0 for the device's minimum plus one",
+        core::CmdOptionValueTypes::single,
+        [&_profile](const std::vector<int>& _values) -> bool
+        {
+            const int count = _values.front();
+            if (count < 0 || count > static_cast<int>(k_maxBackbufferCount)) return false;
+
+            _profile.backbufferCount = static_cast<uint32_t>(count);
+            return true;
+        });
+}
+
+uint32_t chooseBackbufferCount(uint32_t _requested, uint32_t _min, uint32_t _max) noexcept
+{
+    const uint32_t count = _requested == 0 ? _min + 1 : std::max(_requested, _min);
+
+    return _max > 0 ? std::min(count, _max) : count;
+}
+
+} // namespace graphics
+} // namespace mosaic
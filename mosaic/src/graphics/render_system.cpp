@@ -1,10 +1,12 @@
 #include "mosaic/graphics/render_system.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <pieces/core/result.hpp>
 
@@ -32,9 +34,12 @@ namespace graphics
 struct RenderSystem::Impl
 {
     RendererAPIType apiType;
+    RenderProfile profile;
     std::unordered_map<const window::Window*, std::unique_ptr<RenderContext>> contexts;
+    std::vector<std::unique_ptr<RenderContext>> headlessContexts;
+    float resolutionLimit = 1.0f;
 
-    Impl(RendererAPIType _apiType) : apiType(_apiType) {}
+    Impl(RendererAPIType _apiType) : apiType(_apiType), profile(getDefaultRenderProfile()) {}
 };
 
 RenderSystem* RenderSystem::g_instance = nullptr;
@@ -71,6 +76,20 @@ std::unique_ptr<RenderSystem> RenderSystem::create(RendererAPIType _apiType)
     }
 }
 
+void RenderSystem::setProfile(const RenderProfile& _profile) { m_impl->profile = _profile; }
+
+const RenderProfile& RenderSystem::getProfile() const { return m_impl->profile; }
+
+void RenderSystem::setResolutionLimit(float _limit)
+{
+    m_impl->resolutionLimit = _limit;
+
+    for (auto& [window, context] : m_impl->contexts) context->setResolutionLimit(_limit);
+    for (auto& context : m_impl->headlessContexts) context->setResolutionLimit(_limit);
+}
+
+float RenderSystem::getResolutionLimit() const { return m_impl->resolutionLimit; }
+
 pieces::Result<RenderContext*, std::string> RenderSystem::createContext(
     const window::Window* _window)
 {
@@ -95,7 +114,7 @@ pieces::Result<RenderContext*, std::string> RenderSystem::createContext(
             }
 
             contexts[_window] = std::make_unique<webgpu::WebGPURenderContext>(
-                _window, RenderContextSettings(true, 2));
+                _window, RenderContextSettings(m_impl->profile));
 
             break;
         }
@@ -104,7 +123,7 @@ pieces::Result<RenderContext*, std::string> RenderSystem::createContext(
         case RendererAPIType::vulkan:
         {
             contexts[_window] = std::make_unique<vulkan::VulkanRenderContext>(
-                _window, RenderContextSettings(true, 2));
+                _window, RenderContextSettings(m_impl->profile));
 
             break;
         }
@@ -115,6 +134,8 @@ pieces::Result<RenderContext*, std::string> RenderSystem::createContext(
         }
     }
 
+    contexts[_window]->setResolutionLimit(m_impl->resolutionLimit);
+
     auto result = contexts[_window]->initialize(this);
 
     if (result.isErr())
@@ -139,20 +160,114 @@ void RenderSystem::destroyContext(const window::Window* _window)
     }
 }
 
+pieces::Result<RenderContext*, std::string> RenderSystem::createHeadlessContext(
+    glm::uvec2 _extent, bool _exportFrames)
+{
+    std::unique_ptr<RenderContext> context;
+
+    switch (m_impl->apiType)
+    {
+#ifndef MOSAIC_PLATFORM_ANDROID
+        case RendererAPIType::web_gpu:
+        {
+            if (m_impl->contexts.size() + m_impl->headlessContexts.size() > 1)
+            {
+                return pieces::Err<RenderContext*, std::string>(
+                    "WebGPU backend only supports one context at a time");
+            }
+
+            RenderContextSettings settings(m_impl->profile);
+            settings.offscreenExtent = _extent;
+            settings.exportFrames = _exportFrames;
+            context = std::make_unique<webgpu::WebGPURenderContext>(nullptr, settings);
+
+            break;
+        }
+#endif
+#ifndef MOSAIC_PLATFORM_EMSCRIPTEN
+        case RendererAPIType::vulkan:
+        {
+            RenderContextSettings settings(m_impl->profile);
+            settings.offscreenExtent = _extent;
+            settings.exportFrames = _exportFrames;
+            context = std::make_unique<vulkan::VulkanRenderContext>(nullptr, settings);
+
+            break;
+        }
+#endif
+        default:
+        {
+            return pieces::Err<RenderContext*, std::string>("RenderSystem: Unsupported API type");
+        }
+    }
+
+    context->setResolutionLimit(m_impl->resolutionLimit);
+
+    auto result = context->initialize(this);
+
+    if (result.isErr())
+    {
+        return pieces::Err<RenderContext*, std::string>(std::move(result.error()));
+    }
+
+    return pieces::Ok<RenderContext*, std::string>(
+        m_impl->headlessContexts.emplace_back(std::move(context)).get());
+}
+
+void RenderSystem::destroyHeadlessContext(RenderContext* _context)
+{
+    auto& headlessContexts = m_impl->headlessContexts;
+
+    auto it = std::find_if(headlessContexts.begin(), headlessContexts.end(),
+                           [_context](const std::unique_ptr<RenderContext>& _headless)
+                           { return _headless.get() == _context; });
+
+    if (it != headlessContexts.end())
+    {
+        (*it)->shutdown();
+
+        headlessContexts.erase(it);
+    }
+}
+
 void RenderSystem::destroyAllContexts()
 {
     for (auto& [window, context] : m_impl->contexts) context->shutdown();
+    for (auto& context : m_impl->headlessContexts) context->shutdown();
 
     m_impl->contexts.clear();
+    m_impl->headlessContexts.clear();
+}
+
+void RenderSystem::pace()
+{
+    for (auto& [window, context] : m_impl->contexts) context->pace();
+    for (auto& context : m_impl->headlessContexts) context->pace();
 }
 
 pieces::RefResult<core::System, std::string> RenderSystem::update()
 {
-    for (auto& [window, context] : m_impl->contexts) context->render();
+    std::vector<RenderContext*> contexts;
+    contexts.reserve(m_impl->contexts.size() + m_impl->headlessContexts.size());
+    for (auto& [window, context] : m_impl->contexts) contexts.push_back(context.get());
+    for (auto& context : m_impl->headlessContexts) contexts.push_back(context.get());
+
+    renderContexts(contexts);
 
     return pieces::OkRef<core::System, std::string>(*this);
 }
 
+void RenderSystem::consumeInput(InputLatency::Clock::time_point _input)
+{
+    for (auto& [window, context] : m_impl->contexts) context->consumeInput(_input);
+    for (auto& context : m_impl->headlessContexts) context->consumeInput(_input);
+}
+
+void RenderSystem::renderContexts(std::span<RenderContext* const> _contexts)
+{
+    for (RenderContext* context : _contexts) context->render();
+}
+
 RenderContext* RenderSystem::getContext(const window::Window* _window) const
 {
     if (m_impl->contexts.find(_window) != m_impl->contexts.end())
@@ -0,0 +1,114 @@
+#include "mosaic/graphics/resolution_scaler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// Weight of a new measure, out of 8
+static constexpr int64_t k_smoothing = 2;
+
+// Below a multiple of the step by rounding only, a scale is on it
+static constexpr float k_stepTolerance = 1e-3f;
+
+static std::chrono::nanoseconds scaleTime(std::chrono::nanoseconds _time, double _ratio) noexcept
+{
+    return std::chrono::nanoseconds(
+        static_cast<int64_t>(static_cast<double>(_time.count()) * _ratio * _ratio));
+}
+
+ResolutionScaler::ResolutionScaler(const ResolutionScalerSettings& _settings)
+    : m_settings(_settings), m_scale(1.0f)
+{
+    m_settings.minScale = std::clamp(m_settings.minScale, 0.01f, 1.0f);
+    m_settings.maxScale = std::clamp(m_settings.maxScale, m_settings.minScale, 1.0f);
+    m_settings.scaleStep = std::max(m_settings.scaleStep, 0.01f);
+    m_settings.upscaleFrames = std::max(m_settings.upscaleFrames, 1u);
+
+    m_scale = quantize(m_settings.maxScale);
+}
+
+float ResolutionScaler::update(std::chrono::nanoseconds _gpuTime) noexcept
+{
+    // rendered at the last scale
+    if (m_framesToSettle > 0)
+    {
+        --m_framesToSettle;
+        return m_scale;
+    }
+
+    m_gpuTime = m_gpuTime == std::chrono::nanoseconds::zero()
+                    ? _gpuTime
+                    : (m_gpuTime * (8 - k_smoothing) + _gpuTime * k_smoothing) / 8;
+
+    const auto target = std::chrono::nanoseconds(static_cast<int64_t>(
+        static_cast<double>(m_settings.frameBudget.count()) * m_settings.headroom));
+
+    // Over the budget: the scale whose pixels fit below the headroom, at once
+    if (m_gpuTime > m_settings.frameBudget)
+    {
+        const double fit = std::sqrt(static_cast<double>(target.count()) /
+                                     static_cast<double>(m_gpuTime.count()));
+        setScale(quantize(static_cast<float>(m_scale * fit)));
+
+        return m_scale;
+    }
+
+    // Between the headroom and the budget the scale holds
+    if (m_gpuTime > target)
+    {
+        m_framesBelow = 0;
+        return m_scale;
+    }
+
+    if (++m_framesBelow < m_settings.upscaleFrames) return m_scale;
+
+    // A step up, if the frames would still be below the headroom there
+    m_framesBelow = 0;
+
+    const float next = quantize(m_scale + m_settings.scaleStep);
+    if (next > m_scale && scaleTime(m_gpuTime, next / m_scale) <= target) setScale(next);
+
+    return m_scale;
+}
+
+void ResolutionScaler::setLimit(float _limit) noexcept
+{
+    m_limit = std::clamp(_limit, m_settings.minScale, 1.0f);
+
+    const float capped = quantize(m_scale);
+    if (capped < m_scale) setScale(capped);
+}
+
+glm::uvec2 ResolutionScaler::getScaledExtent(glm::uvec2 _extent, float _scale) noexcept
+{
+    const auto scale = [_scale](uint32_t _size)
+    { return std::max(static_cast<uint32_t>(std::lround(_size * _scale)), 1u); };
+
+    return {scale(_extent.x), scale(_extent.y)};
+}
+
+float ResolutionScaler::quantize(float _scale) const noexcept
+{
+    const float steps = std::floor(_scale / m_settings.scaleStep + k_stepTolerance);
+
+    return std::clamp(steps * m_settings.scaleStep, m_settings.minScale,
+                      std::min(m_settings.maxScale, m_limit));
+}
+
+void ResolutionScaler::setScale(float _scale) noexcept
+{
+    if (_scale == m_scale) return;
+
+    // what the frames should take at the new scale, until they are measured
+    m_gpuTime = scaleTime(m_gpuTime, _scale / m_scale);
+    m_scale = _scale;
+    m_framesBelow = 0;
+    m_framesToSettle = m_settings.settleFrames;
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,340 @@
+#include "mosaic/graphics/shader_library.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+#include <android/asset_manager.h>
+#include <mosaic/core/platform.hpp>
+#include <mosaic/platform/AGDK/agdk_platform.hpp>
+#else
+#include "mosaic/core/mapped_file.hpp"
+#endif
+
+#include "mosaic/core/virtual_file_system.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+#include "mosaic/graphics/pipeline.hpp"
+#include "mosaic/graphics/shader_reflection.hpp"
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static std::vector<uint8_t> readSpirvFile(const std::filesystem::path& _path)
+{
+#if defined(MOSAIC_PLATFORM_ANDROID)
+
+    auto platform = mosaic::core::Platform::getInstance();
+    auto platformContext =
+        static_cast<platform::agdk::AGDKPlatformContext*>(platform->getPlatformContext());
+
+    AAsset* asset = AAssetManager_open(platformContext->getAssetManager(), _path.c_str(),
+                                       AASSET_MODE_BUFFER);
+
+    if (!asset) throw std::runtime_error("Failed to open shader file: " + _path.string());
+
+    // mapped from the APK when the asset is stored uncompressed
+    const auto* data = static_cast<const uint8_t*>(AAsset_getBuffer(asset));
+    std::vector<uint8_t> bytecode;
+    if (data) bytecode.assign(data, data + AAsset_getLength(asset));
+    AAsset_close(asset);
+
+    if (!data) throw std::runtime_error("Failed to read shader file: " + _path.string());
+
+    return bytecode;
+
+#else
+
+    const core::MappedFile file(_path);
+    const std::span<const uint8_t> bytes = file.bytes();
+
+    return {bytes.begin(), bytes.end()};
+
+#endif
+}
+
+// Through the mounts of the application (archives, the APK assets), the file itself without them
+static std::vector<uint8_t> readSpirv(const std::filesystem::path& _path)
+{
+    core::VirtualFileSystem* files = core::VirtualFileSystem::getInstance();
+    if (!files) return readSpirvFile(_path);
+
+    auto data = files->read(_path.generic_string());
+    if (data.isErr())
+    {
+        throw std::runtime_error("Failed to read shader file: " + std::move(data.error()));
+    }
+
+    const std::span<const uint8_t> bytes = data.unwrap().bytes();
+
+    return {bytes.begin(), bytes.end()};
+}
+
+static bool spirvExists(const std::filesystem::path& _path)
+{
+    if (core::VirtualFileSystem* files = core::VirtualFileSystem::getInstance())
+    {
+        return files->exists(_path.generic_string());
+    }
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+
+    auto platform = mosaic::core::Platform::getInstance();
+    auto platformContext =
+        static_cast<platform::agdk::AGDKPlatformContext*>(platform->getPlatformContext());
+
+    AAsset* asset = AAssetManager_open(platformContext->getAssetManager(), _path.c_str(),
+                                       AASSET_MODE_UNKNOWN);
+    if (asset) AAsset_close(asset);
+
+    return asset != nullptr;
+
+#else
+
+    std::error_code error;
+    return std::filesystem::is_regular_file(_path, error);
+
+#endif
+}
+
+// The oldest time when the file does not exist (yet)
+static std::filesystem::file_time_type getWriteTime(const std::filesystem::path& _path)
+{
+    std::error_code error;
+    const std::filesystem::file_time_type time = std::filesystem::last_write_time(_path, error);
+
+    return error ? std::filesystem::file_time_type::min() : time;
+}
+
+static std::optional<std::filesystem::path> getSourcePath(const ShaderHotReload& _hotReload,
+                                                          const std::filesystem::path& _path)
+{
+    if (_hotReload.sourceDirectory.empty()) return std::nullopt;
+
+    // "triangle.vert.spv" is compiled from "triangle.vert"
+    return _hotReload.sourceDirectory / _path.stem();
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+    // the tasks report to the library
+    for (exec::TaskFuture<void>& task : m_reloadTasks) task.wait();
+}
+
+const ShaderDescription& ShaderLibrary::load(ShaderStage _stage, const std::filesystem::path& _path)
+{
+    const std::string key = _path.generic_string();
+
+    if (auto it = m_entries.find(key); it != m_entries.end()) return it->second->description;
+
+    auto entry = std::make_unique<Entry>();
+    entry->description.stage = _stage;
+    entry->description.bytecode = readSpirv(_path);
+    entry->description.debugName = key;
+    entry->hash = hashShaderBytecode(entry->description.bytecode);
+    entry->writeTime = getWriteTime(_path);
+
+    if (m_hotReload)
+    {
+        auto source = getSourcePath(*m_hotReload, _path);
+        if (source) entry->sourceTime = getWriteTime(*source);
+    }
+
+    return m_entries.emplace(key, std::move(entry)).first->second->description;
+}
+
+ShaderDescription ShaderLibrary::loadVariant(ShaderStage _stage,
+                                             const std::filesystem::path& _path,
+                                             ShaderVariantKey _key)
+{
+    if (_key.features == 0) return load(_stage, _path);
+
+    // a shipped permutation is loaded, and watched, as a shader of its own
+    const std::filesystem::path permutation = getShaderVariantPath(_path, _key);
+    if (m_entries.contains(permutation.generic_string()) || spirvExists(permutation))
+    {
+        return load(_stage, permutation);
+    }
+
+    ShaderDescription description = load(_stage, _path);
+    description.specialization = getSpecializationConstants(_key);
+
+    return description;
+}
+
+uint64_t ShaderLibrary::getHash(const std::filesystem::path& _path) const
+{
+    auto it = m_entries.find(_path.generic_string());
+
+    return it != m_entries.end() ? it->second->hash : 0;
+}
+
+void ShaderLibrary::enableHotReload(const ShaderHotReload& _hotReload)
+{
+#if defined(MOSAIC_PLATFORM_DESKTOP)
+
+    m_hotReload = _hotReload;
+    m_nextPoll = {};
+
+    // the sources of the shaders loaded so far are as old as their SPIR-V
+    for (auto& [path, entry] : m_entries)
+    {
+        auto source = getSourcePath(_hotReload, path);
+        if (source) entry->sourceTime = getWriteTime(*source);
+    }
+
+#else
+
+    MOSAIC_WARN("Shader hot reload is only supported on desktop, {} is ignored",
+                _hotReload.sourceDirectory.string());
+
+#endif
+}
+
+void ShaderLibrary::disableHotReload()
+{
+    m_hotReload.reset();
+
+    for (exec::TaskFuture<void>& task : m_reloadTasks) task.wait();
+    m_reloadTasks.clear();
+}
+
+std::vector<std::filesystem::path> ShaderLibrary::update(Clock::time_point _now)
+{
+    std::vector<Reload> reloads;
+    {
+        std::lock_guard lock(m_reloadMutex);
+        reloads.swap(m_reloads);
+    }
+
+    std::vector<std::filesystem::path> replaced;
+
+    for (Reload& reload : reloads)
+    {
+        Entry& entry = *m_entries.at(reload.path);
+        entry.reloading = false;
+        entry.writeTime = reload.writeTime;
+        entry.sourceTime = reload.sourceTime;
+
+        if (!reload.bytecode) continue;
+
+        // written again, the same code: the pipelines stay
+        const uint64_t hash = hashShaderBytecode(*reload.bytecode);
+        if (hash == entry.hash) continue;
+
+        entry.description.bytecode = std::move(*reload.bytecode);
+        entry.hash = hash;
+
+        MOSAIC_INFO("Shader {} reloaded", reload.path);
+        replaced.emplace_back(reload.path);
+    }
+
+    if (!replaced.empty()) ++m_generation;
+
+    std::erase_if(m_reloadTasks,
+                  [](const exec::TaskFuture<void>& _task) { return _task.isReady(); });
+
+    if (!m_hotReload || _now < m_nextPoll) return replaced;
+
+    m_nextPoll = _now + m_hotReload->interval;
+
+    for (auto& [path, entry] : m_entries)
+    {
+        if (entry->reloading) continue;
+
+        const std::optional<std::filesystem::path> source = getSourcePath(*m_hotReload, path);
+        const std::filesystem::file_time_type writeTime = getWriteTime(path);
+        const std::filesystem::file_time_type sourceTime =
+            source ? getWriteTime(*source) : std::filesystem::file_time_type::min();
+
+        // a source not compiled yet (a failed compilation is tried again once it changes)
+        const bool compile = source && sourceTime != entry->sourceTime && sourceTime > writeTime;
+        if (!compile && writeTime == entry->writeTime) continue;
+
+        entry->reloading = true;
+        reload(path, compile);
+    }
+
+    return replaced;
+}
+
+void ShaderLibrary::reload(const std::string& _path, bool _compile)
+{
+    const Entry& entry = *m_entries.at(_path);
+
+    std::optional<std::filesystem::path> source;
+    if (_compile) source = getSourcePath(*m_hotReload, _path);
+
+    auto task = [this, path = _path, source = std::move(source), compiler = m_hotReload->compiler,
+                 stage = entry.description.stage, entryPoint = entry.description.entryPoint,
+                 sourceTime = entry.sourceTime]
+    {
+        Reload reload;
+        reload.path = path;
+        reload.sourceTime = sourceTime;
+
+        bool compiled = true;
+        if (source)
+        {
+            reload.sourceTime = getWriteTime(*source);
+
+            const std::string command =
+                compiler + " \"" + source->string() + "\" -o \"" + path + "\"";
+            compiled = std::system(command.c_str()) == 0;
+
+            if (!compiled) MOSAIC_ERROR("Failed to compile shader {}", source->string());
+        }
+
+        reload.writeTime = getWriteTime(path);
+
+        try
+        {
+            if (compiled)
+            {
+                std::vector<uint8_t> bytecode = readSpirvFile(path);
+                auto reflection = reflectShader(bytecode, entryPoint);
+
+                if (reflection.isErr())
+                {
+                    MOSAIC_ERROR("Failed to reflect shader {}: {}", path, reflection.error());
+                }
+                else if (reflection.unwrap().stage != stage)
+                {
+                    MOSAIC_ERROR("Shader {} is not of the stage of the pipelines using it", path);
+                }
+                else
+                {
+                    reload.bytecode = std::move(bytecode);
+                }
+            }
+        }
+        catch (const std::exception& _error)
+        {
+            MOSAIC_ERROR("Failed to reload shader {}: {}", path, _error.what());
+        }
+
+        std::lock_guard lock(m_reloadMutex);
+        m_reloads.push_back(std::move(reload));
+    };
+
+    if (exec::ThreadPool* pool = exec::ThreadPool::getInstance())
+    {
+        // compiling takes a while, the work of the frames goes first
+        auto future = pool->enqueueToGlobal(exec::TaskPriority::background, task);
+        if (future)
+        {
+            m_reloadTasks.push_back(std::move(*future));
+            return;
+        }
+    }
+
+    task();
+}
+
+} // namespace graphics
+} // namespace mosaic
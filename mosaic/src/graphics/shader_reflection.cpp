@@ -0,0 +1,448 @@
+#include "mosaic/graphics/shader_reflection.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+namespace
+{
+
+// The subset of the SPIR-V specification reflection reads
+namespace spirv
+{
+
+constexpr uint32_t k_magic = 0x07230203;
+constexpr size_t k_headerWords = 5;
+
+enum Op : uint32_t
+{
+    OpName = 5,
+    OpEntryPoint = 15,
+    OpExecutionMode = 16,
+    OpTypeBool = 20,
+    OpTypeInt = 21,
+    OpTypeFloat = 22,
+    OpTypeVector = 23,
+    OpTypeMatrix = 24,
+    OpTypeImage = 25,
+    OpTypeSampler = 26,
+    OpTypeSampledImage = 27,
+    OpTypeArray = 28,
+    OpTypeRuntimeArray = 29,
+    OpTypeStruct = 30,
+    OpTypePointer = 32,
+    OpConstant = 43,
+    OpVariable = 59,
+    OpDecorate = 71,
+    OpMemberDecorate = 72,
+    OpTypeAccelerationStructureKHR = 5341
+};
+
+enum Decoration : uint32_t
+{
+    Block = 2,
+    BufferBlock = 3,
+    ArrayStride = 6,
+    MatrixStride = 7,
+    Binding = 33,
+    DescriptorSet = 34,
+    Offset = 35
+};
+
+enum StorageClass : uint32_t
+{
+    UniformConstant = 0,
+    Uniform = 2,
+    PushConstant = 9,
+    StorageBuffer = 12
+};
+
+enum ExecutionModel : uint32_t
+{
+    Vertex = 0,
+    Fragment = 4,
+    GLCompute = 5,
+    TaskEXT = 5364,
+    MeshEXT = 5365
+};
+
+constexpr uint32_t k_localSize = 17; // execution mode
+constexpr uint32_t k_storageImage = 2; // "Sampled" operand of OpTypeImage
+
+} // namespace spirv
+
+// Deeper types are not a layout a shader declares (and no cycle is followed forever)
+constexpr int k_maxTypeDepth = 32;
+
+struct IdInfo
+{
+    uint32_t opcode = 0;
+    size_t first = 0; // the word of the instruction
+    uint32_t wordCount = 0;
+
+    std::string name;
+    std::optional<uint32_t> set;
+    std::optional<uint32_t> binding;
+    uint32_t arrayStride = 0;
+    bool bufferBlock = false;
+    std::vector<uint32_t> memberOffsets;
+    std::vector<uint32_t> memberMatrixStrides;
+};
+
+struct Module
+{
+    std::vector<uint32_t> words;
+    std::vector<IdInfo> ids;
+
+    // the n-th operand of the instruction defining _id, after its opcode word
+    uint32_t operand(uint32_t _id, uint32_t _index) const noexcept
+    {
+        const IdInfo& info = ids[_id];
+        return _index + 1 < info.wordCount ? words[info.first + 1 + _index] : 0;
+    }
+
+    const IdInfo* type(uint32_t _id) const noexcept
+    {
+        return _id < ids.size() && ids[_id].opcode != 0 ? &ids[_id] : nullptr;
+    }
+
+    uint32_t sizeOf(uint32_t _type, uint32_t _matrixStride = 0, int _depth = 0) const noexcept;
+};
+
+// A literal string of _count words from _first, nul-terminated
+std::string readString(const std::vector<uint32_t>& _words, size_t _first, size_t _count)
+{
+    std::string string(reinterpret_cast<const char*>(_words.data() + _first), _count * 4);
+    string.resize(std::strlen(string.c_str()));
+
+    return string;
+}
+
+uint32_t Module::sizeOf(uint32_t _type, uint32_t _matrixStride, int _depth) const noexcept
+{
+    const IdInfo* info = type(_type);
+    if (!info || _depth > k_maxTypeDepth) return 0;
+
+    switch (info->opcode)
+    {
+        case spirv::OpTypeBool:
+            return 4;
+        case spirv::OpTypeInt:
+        case spirv::OpTypeFloat:
+            return operand(_type, 1) / 8;
+        case spirv::OpTypeVector:
+            return operand(_type, 2) * sizeOf(operand(_type, 1), 0, _depth + 1);
+        case spirv::OpTypeMatrix:
+        {
+            const uint32_t column =
+                _matrixStride > 0 ? _matrixStride : sizeOf(operand(_type, 1), 0, _depth + 1);
+            return operand(_type, 2) * column;
+        }
+        case spirv::OpTypeArray:
+        {
+            const uint32_t length = operand(_type, 2);
+            const uint32_t count = type(length) && ids[length].opcode == spirv::OpConstant
+                                       ? operand(length, 2)
+                                       : 0;
+            const uint32_t stride = info->arrayStride > 0
+                                        ? info->arrayStride
+                                        : sizeOf(operand(_type, 1), _matrixStride, _depth + 1);
+            return count * stride;
+        }
+        case spirv::OpTypeStruct:
+        {
+            uint32_t size = 0;
+            for (uint32_t member = 0; member + 2 < info->wordCount; ++member)
+            {
+                const uint32_t offset =
+                    member < info->memberOffsets.size() ? info->memberOffsets[member] : 0;
+                const uint32_t stride = member < info->memberMatrixStrides.size()
+                                            ? info->memberMatrixStrides[member]
+                                            : 0;
+                size = std::max(size,
+                                offset + sizeOf(operand(_type, member + 1), stride, _depth + 1));
+            }
+            return size;
+        }
+        default:
+            return 0;
+    }
+}
+
+std::optional<ShaderStage> getStage(uint32_t _model) noexcept
+{
+    switch (_model)
+    {
+        case spirv::Vertex:
+            return ShaderStage::Vertex;
+        case spirv::Fragment:
+            return ShaderStage::Fragment;
+        case spirv::GLCompute:
+            return ShaderStage::Compute;
+        case spirv::TaskEXT:
+            return ShaderStage::Task;
+        case spirv::MeshEXT:
+            return ShaderStage::Mesh;
+        default:
+            return std::nullopt;
+    }
+}
+
+// The binding of a descriptor variable, none for a type no descriptor has
+std::optional<ShaderBinding> reflectBinding(const Module& _module, const IdInfo& _variable,
+                                            uint32_t _pointee, uint32_t _storage)
+{
+    ShaderBinding binding;
+    binding.set = *_variable.set;
+    binding.binding = *_variable.binding;
+    binding.name = _variable.name;
+
+    uint32_t type = _pointee;
+    const IdInfo* info = _module.type(type);
+
+    // arrays of descriptors, the bindless ones unsized
+    if (info && (info->opcode == spirv::OpTypeArray || info->opcode == spirv::OpTypeRuntimeArray))
+    {
+        if (info->opcode == spirv::OpTypeArray)
+        {
+            const uint32_t length = _module.operand(type, 2);
+            const IdInfo* constant = _module.type(length);
+            binding.count =
+                constant && constant->opcode == spirv::OpConstant ? _module.operand(length, 2) : 1;
+        }
+        else
+        {
+            binding.count = 0;
+        }
+
+        type = _module.operand(type, 1);
+        info = _module.type(type);
+    }
+
+    if (!info) return std::nullopt;
+
+    switch (info->opcode)
+    {
+        case spirv::OpTypeStruct:
+            binding.type = _storage == spirv::StorageBuffer || info->bufferBlock
+                               ? ShaderResourceType::StorageBuffer
+                               : ShaderResourceType::UniformBuffer;
+            if (binding.name.empty()) binding.name = info->name;
+            break;
+        case spirv::OpTypeImage:
+            binding.type = _module.operand(type, 6) == spirv::k_storageImage
+                               ? ShaderResourceType::StorageImage
+                               : ShaderResourceType::SampledImage;
+            break;
+        case spirv::OpTypeSampler:
+            binding.type = ShaderResourceType::Sampler;
+            break;
+        case spirv::OpTypeSampledImage:
+            binding.type = ShaderResourceType::CombinedImageSampler;
+            break;
+        case spirv::OpTypeAccelerationStructureKHR:
+            binding.type = ShaderResourceType::AccelerationStructure;
+            break;
+        default:
+            return std::nullopt;
+    }
+
+    return binding;
+}
+
+} // namespace
+
+pieces::Result<ShaderReflection, std::string> reflectShader(std::span<const uint8_t> _spirv,
+                                                            std::string_view _entryPoint)
+{
+    using Error = pieces::Result<ShaderReflection, std::string>;
+
+    if (_spirv.size() % 4 != 0 || _spirv.size() < spirv::k_headerWords * 4)
+    {
+        return pieces::Err<ShaderReflection, std::string>("not a SPIR-V module");
+    }
+
+    // the bytes may not be aligned on words
+    Module module;
+    module.words.resize(_spirv.size() / 4);
+    std::memcpy(module.words.data(), _spirv.data(), _spirv.size());
+
+    const std::vector<uint32_t>& words = module.words;
+    if (words[0] != spirv::k_magic)
+    {
+        return pieces::Err<ShaderReflection, std::string>("not a SPIR-V module");
+    }
+
+    module.ids.resize(words[3]); // the bound of the ids
+
+    uint32_t entryId = 0;
+    std::optional<uint32_t> entryModel;
+    std::vector<size_t> executionModes;
+    std::vector<size_t> variables;
+
+    const auto outOfBounds = [](size_t _word) -> Error
+    {
+        return pieces::Err<ShaderReflection, std::string>("id out of bounds at word " +
+                                                          std::to_string(_word));
+    };
+
+    for (size_t word = spirv::k_headerWords; word < words.size();)
+    {
+        const uint32_t opcode = words[word] & 0xFFFF;
+        const uint32_t count = words[word] >> 16;
+
+        if (count == 0 || word + count > words.size())
+        {
+            return pieces::Err<ShaderReflection, std::string>("truncated instruction at word " +
+                                                              std::to_string(word));
+        }
+
+        const auto at = [&](uint32_t _index) { return _index < count ? words[word + _index] : 0; };
+
+        switch (opcode)
+        {
+            case spirv::OpName:
+                if (at(1) >= module.ids.size()) return outOfBounds(word);
+                module.ids[at(1)].name = readString(words, word + 2, count - 2);
+                break;
+
+            case spirv::OpEntryPoint:
+                if (count > 3 && readString(words, word + 3, count - 3) == _entryPoint)
+                {
+                    entryModel = at(1);
+                    entryId = at(2);
+                }
+                break;
+
+            case spirv::OpExecutionMode:
+                executionModes.push_back(word);
+                break;
+
+            case spirv::OpDecorate:
+            {
+                if (at(1) >= module.ids.size()) return outOfBounds(word);
+                IdInfo& target = module.ids[at(1)];
+
+                if (at(2) == spirv::DescriptorSet) target.set = at(3);
+                if (at(2) == spirv::Binding) target.binding = at(3);
+                if (at(2) == spirv::ArrayStride) target.arrayStride = at(3);
+                if (at(2) == spirv::BufferBlock) target.bufferBlock = true;
+                break;
+            }
+
+            case spirv::OpMemberDecorate:
+            {
+                if (at(1) >= module.ids.size()) return outOfBounds(word);
+                IdInfo& target = module.ids[at(1)];
+                const uint32_t member = at(2);
+
+                // literals, not ids: a module may not have that many members
+                if (member >= 4096) return outOfBounds(word);
+
+                std::vector<uint32_t>* values = nullptr;
+                if (at(3) == spirv::Offset) values = &target.memberOffsets;
+                if (at(3) == spirv::MatrixStride) values = &target.memberMatrixStrides;
+
+                if (values)
+                {
+                    if (values->size() <= member) values->resize(member + 1, 0);
+                    (*values)[member] = at(4);
+                }
+                break;
+            }
+
+            case spirv::OpTypeBool:
+            case spirv::OpTypeInt:
+            case spirv::OpTypeFloat:
+            case spirv::OpTypeVector:
+            case spirv::OpTypeMatrix:
+            case spirv::OpTypeImage:
+            case spirv::OpTypeSampler:
+            case spirv::OpTypeSampledImage:
+            case spirv::OpTypeArray:
+            case spirv::OpTypeRuntimeArray:
+            case spirv::OpTypeStruct:
+            case spirv::OpTypePointer:
+            case spirv::OpTypeAccelerationStructureKHR:
+            case spirv::OpConstant:
+            case spirv::OpVariable:
+            {
+                // the result id follows the result type of constants and variables
+                const bool typed = opcode == spirv::OpConstant || opcode == spirv::OpVariable;
+                const uint32_t id = at(typed ? 2 : 1);
+                if (id >= module.ids.size()) return outOfBounds(word);
+
+                IdInfo& info = module.ids[id];
+                info.opcode = opcode;
+                info.first = word;
+                info.wordCount = count;
+
+                if (opcode == spirv::OpVariable && count >= 4) variables.push_back(word);
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        word += count;
+    }
+
+    if (!entryModel)
+    {
+        return pieces::Err<ShaderReflection, std::string>("no entry point " +
+                                                          std::string(_entryPoint));
+    }
+
+    ShaderReflection reflection;
+    reflection.stage = getStage(*entryModel);
+
+    for (size_t word : executionModes)
+    {
+        if (words[word] >> 16 >= 6 && words[word + 1] == entryId &&
+            words[word + 2] == spirv::k_localSize)
+        {
+            reflection.localSize = {words[word + 3], words[word + 4], words[word + 5]};
+        }
+    }
+
+    for (size_t word : variables)
+    {
+        const uint32_t pointer = words[word + 1];
+        const IdInfo& variable = module.ids[words[word + 2]];
+        const uint32_t storage = words[word + 3];
+
+        const IdInfo* pointerType = module.type(pointer);
+        if (!pointerType || pointerType->opcode != spirv::OpTypePointer) continue;
+
+        const uint32_t pointee = module.operand(pointer, 2);
+
+        if (storage == spirv::PushConstant)
+        {
+            reflection.pushConstantSize =
+                std::max(reflection.pushConstantSize, module.sizeOf(pointee));
+        }
+        else if ((storage == spirv::UniformConstant || storage == spirv::Uniform ||
+                  storage == spirv::StorageBuffer) &&
+                 variable.set && variable.binding)
+        {
+            if (auto binding = reflectBinding(module, variable, pointee, storage))
+            {
+                reflection.bindings.push_back(std::move(*binding));
+            }
+        }
+    }
+
+    std::sort(reflection.bindings.begin(), reflection.bindings.end(),
+              [](const ShaderBinding& _a, const ShaderBinding& _b)
+              { return _a.set != _b.set ? _a.set < _b.set : _a.binding < _b.binding; });
+
+    return pieces::Ok<ShaderReflection, std::string>(std::move(reflection));
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,41 @@
+#include "mosaic/graphics/shader_variant.hpp"
+
+#include <charconv>
+#include <string_view>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+std::filesystem::path getShaderVariantPath(const std::filesystem::path& _path,
+                                           ShaderVariantKey _key)
+{
+    if (_key.features == 0) return _path;
+
+    // the key before the last extension: "triangle.frag" + ".5" + ".spv"
+    char key[9];
+    const auto end = std::to_chars(key, key + sizeof(key), _key.features, 16).ptr;
+
+    std::filesystem::path variant = _path.parent_path() / _path.stem();
+    variant += ".";
+    variant += std::string_view(key, end);
+    variant += _path.extension();
+
+    return variant;
+}
+
+std::vector<SpecializationConstant> getSpecializationConstants(ShaderVariantKey _key)
+{
+    std::vector<SpecializationConstant> constants;
+
+    for (uint32_t feature = 0; feature < k_maxShaderFeatures; ++feature)
+    {
+        if (_key.has(feature)) constants.push_back({feature, 1});
+    }
+
+    return constants;
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,242 @@
+#include "mosaic/graphics/shadow_cascades.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "mosaic/exec/parallel_for.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static float dot(const std::array<float, 3>& _a, const std::array<float, 3>& _b) noexcept
+{
+    return _a[0] * _b[0] + _a[1] * _b[1] + _a[2] * _b[2];
+}
+
+static std::array<float, 3> cross(const std::array<float, 3>& _a,
+                                  const std::array<float, 3>& _b) noexcept
+{
+    return {_a[1] * _b[2] - _a[2] * _b[1], _a[2] * _b[0] - _a[0] * _b[2],
+            _a[0] * _b[1] - _a[1] * _b[0]};
+}
+
+static std::array<float, 3> normalize(const std::array<float, 3>& _v) noexcept
+{
+    const float length = std::sqrt(dot(_v, _v));
+    return {_v[0] / length, _v[1] / length, _v[2] / length};
+}
+
+void ShadowCascades::setProjection(const ShadowCascadeSettings& _settings, float _p00, float _p11,
+                                   float _zNear)
+{
+    if (_settings.cascadeCount == 0 || _settings.cascadeCount > k_maxShadowCascades ||
+        _settings.resolution == 0)
+    {
+        throw std::invalid_argument("Shadow cascades: 1 to 4 cascades of at least a texel!");
+    }
+
+    if (!(_settings.splitLambda >= 0.0f && _settings.splitLambda <= 1.0f) ||
+        !(_settings.refitMargin >= 0.0f) || !(_settings.refitAngle >= 0.0f))
+    {
+        throw std::invalid_argument("Shadow cascades: split lambda or refit margins out of range!");
+    }
+
+    if (!(_zNear > 0.0f && _zNear < _settings.distance) || _p00 == 0.0f || _p11 == 0.0f)
+    {
+        throw std::invalid_argument("Shadow cascades: not a perspective projection!");
+    }
+
+    m_settings = _settings;
+    m_cascadeCount = _settings.cascadeCount;
+    m_hasLight = false;
+
+    // A point at view depth d is at most d * corner from the camera, corner the distance to a far
+    // corner of the view at depth 1
+    const float corner = std::sqrt(1.0f + 1.0f / (_p00 * _p00) + 1.0f / (_p11 * _p11));
+    const float count = static_cast<float>(m_cascadeCount);
+
+    // Practical splits: the logarithmic ones, even in texel density, blended with uniform ones
+    for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+    {
+        const float fraction = static_cast<float>(cascade + 1) / count;
+        const float logarithmic = _zNear * std::pow(_settings.distance / _zNear, fraction);
+        const float uniform = _zNear + (_settings.distance - _zNear) * fraction;
+
+        m_cascades[cascade] = {};
+        m_cascades[cascade].splitDepth =
+            cascade + 1 == m_cascadeCount
+                ? _settings.distance
+                : _settings.splitLambda * logarithmic + (1.0f - _settings.splitLambda) * uniform;
+
+        Cache& cache = m_caches[cascade];
+        cache.radius = m_cascades[cascade].splitDepth * corner;
+        cache.extent = 0.0f;
+        cache.staticDirty = true;
+        cache.staticCasters.clear();
+        cache.dynamicCasters.clear();
+    }
+
+    m_uniforms = {};
+    m_uniforms.cascadeCount = m_cascadeCount;
+}
+
+void ShadowCascades::invalidateStatic() noexcept
+{
+    for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+    {
+        m_caches[cascade].staticDirty = true;
+    }
+}
+
+void ShadowCascades::invalidateStatic(const BoundingSphere& _bounds) noexcept
+{
+    for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+    {
+        if (isSphereInFrustum(m_cascades[cascade].casterFrustum, _bounds))
+        {
+            m_caches[cascade].staticDirty = true;
+        }
+    }
+}
+
+void ShadowCascades::fit(const std::array<float, 3>& _cameraPosition,
+                         const std::array<float, 3>& _lightDirection)
+{
+    const std::array<float, 3> direction = normalize(_lightDirection);
+
+    // Past the angle every cascade is refit in the new basis, whatever the camera did
+    if (!m_hasLight || dot(direction, m_lightDirection) < std::cos(m_settings.refitAngle))
+    {
+        const std::array<float, 3> worldUp = std::abs(direction[1]) > 0.99f
+                                                 ? std::array<float, 3>{0.0f, 0.0f, 1.0f}
+                                                 : std::array<float, 3>{0.0f, 1.0f, 0.0f};
+
+        m_lightDirection = direction;
+        m_lightRight = normalize(cross(direction, worldUp));
+        m_lightUp = cross(m_lightRight, direction);
+        m_hasLight = true;
+
+        for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+        {
+            m_caches[cascade].extent = 0.0f;
+        }
+    }
+
+    const std::array<float, 3> camera = {dot(m_lightRight, _cameraPosition),
+                                         dot(m_lightUp, _cameraPosition),
+                                         dot(m_lightDirection, _cameraPosition)};
+
+    for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+    {
+        const Cache& cache = m_caches[cascade];
+
+        // Kept while the sphere around the camera stays inside the box
+        bool covered = cache.extent > 0.0f;
+        for (int axis = 0; axis < 3 && covered; ++axis)
+        {
+            covered = std::abs(camera[axis] - cache.center[axis]) + cache.radius <= cache.extent;
+        }
+
+        if (!covered) fitCascade(cascade, camera);
+
+        m_cascades[cascade].redrawStatic = m_caches[cascade].staticDirty;
+        m_caches[cascade].staticDirty = false;
+    }
+}
+
+void ShadowCascades::fitCascade(uint32_t _cascade, const std::array<float, 3>& _camera)
+{
+    Cache& cache = m_caches[_cascade];
+    ShadowCascade& cascade = m_cascades[_cascade];
+
+    // The extent only changes with the settings: snapped to it, the texel grid is the same after a
+    // refit, so the static depth does not shimmer from one cache to the next
+    cache.extent = cache.radius * (1.0f + m_settings.refitMargin);
+    const float texelSize = 2.0f * cache.extent / static_cast<float>(m_settings.resolution);
+
+    cache.center = {std::round(_camera[0] / texelSize) * texelSize,
+                    std::round(_camera[1] / texelSize) * texelSize, _camera[2]};
+    cache.staticDirty = true;
+
+    // x = (right.p - cx) / e, y = (up.p - cy) / e, z = (dir.p - cz + e) / 2e
+    const float scale = 1.0f / cache.extent;
+    const float depthScale = 0.5f / cache.extent;
+
+    std::array<float, 16>& m = cascade.viewProjection;
+    for (int i = 0; i < 3; ++i)
+    {
+        m[i * 4 + 0] = m_lightRight[i] * scale;
+        m[i * 4 + 1] = m_lightUp[i] * scale;
+        m[i * 4 + 2] = m_lightDirection[i] * depthScale;
+        m[i * 4 + 3] = 0.0f;
+    }
+
+    m[12] = -cache.center[0] * scale;
+    m[13] = -cache.center[1] * scale;
+    m[14] = (cache.extent - cache.center[2]) * depthScale;
+    m[15] = 1.0f;
+
+    cascade.casterFrustum = extractFrustum(m);
+    cascade.casterFrustum.planes[4] = {0.0f, 0.0f, 0.0f, std::numeric_limits<float>::max()};
+    cascade.texelSize = texelSize;
+
+    m_uniforms.viewProjection[_cascade] = m;
+    m_uniforms.splitDepths[_cascade] = cascade.splitDepth;
+    m_uniforms.texelSizes[_cascade] = texelSize;
+}
+
+void ShadowCascades::cull(uint32_t _task, const SphereColumns& _staticCasters,
+                          const SphereColumns& _dynamicCasters)
+{
+    // Two tasks a cascade: its static casters, then its dynamic ones
+    const uint32_t cascade = _task / 2;
+    const bool dynamic = _task % 2 == 1;
+
+    std::vector<uint32_t>& visible =
+        dynamic ? m_caches[cascade].dynamicCasters : m_caches[cascade].staticCasters;
+
+    if (!dynamic && !m_cascades[cascade].redrawStatic)
+    {
+        visible.clear();
+        return;
+    }
+
+    const SphereColumns& casters = dynamic ? _dynamicCasters : _staticCasters;
+    visible.resize(casters.size());
+    visible.resize(cullSpheres(m_cascades[cascade].casterFrustum, casters, visible));
+}
+
+void ShadowCascades::update(exec::ThreadPool& _pool, const std::array<float, 3>& _cameraPosition,
+                            const std::array<float, 3>& _lightDirection,
+                            const SphereColumns& _staticCasters,
+                            const SphereColumns& _dynamicCasters)
+{
+    if (m_cascadeCount == 0) return;
+
+    fit(_cameraPosition, _lightDirection);
+
+    exec::parallelFor(_pool, uint32_t{0}, m_cascadeCount * 2, uint32_t{1}, [&](uint32_t _task)
+                      { cull(_task, _staticCasters, _dynamicCasters); });
+}
+
+void ShadowCascades::update(const std::array<float, 3>& _cameraPosition,
+                            const std::array<float, 3>& _lightDirection,
+                            const SphereColumns& _staticCasters,
+                            const SphereColumns& _dynamicCasters)
+{
+    if (m_cascadeCount == 0) return;
+
+    fit(_cameraPosition, _lightDirection);
+
+    for (uint32_t task = 0; task < m_cascadeCount * 2; ++task)
+    {
+        cull(task, _staticCasters, _dynamicCasters);
+    }
+}
+
+} // namespace graphics
+} // namespace mosaic
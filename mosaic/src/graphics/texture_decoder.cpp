@@ -0,0 +1,127 @@
+#include "mosaic/graphics/texture_streaming.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <memory>
+
+#include <stb_image.h>
+#include <stb_image_resize2.h>
+
+#include "mosaic/graphics/ktx2.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+static constexpr int k_channels = 4; // RGBA8
+
+static uint32_t getMipLevelCount(uint32_t _width, uint32_t _height)
+{
+    return std::bit_width(std::max({_width, _height, 1u}));
+}
+
+pieces::Result<TextureDescription, std::string> readTextureDescription(
+    std::span<const uint8_t> _encoded, std::span<const TextureFormat> _supported)
+{
+    if (isKtx2(_encoded)) return readKtx2Description(_encoded, _supported);
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+
+    if (_encoded.size() > INT_MAX ||
+        !stbi_info_from_memory(_encoded.data(), static_cast<int>(_encoded.size()), &width, &height,
+                               &channels))
+    {
+        return pieces::Err<TextureDescription, std::string>("unsupported image format");
+    }
+
+    TextureDescription description = {};
+    description.width = static_cast<uint32_t>(width);
+    description.height = static_cast<uint32_t>(height);
+    description.mipLevels = getMipLevelCount(description.width, description.height);
+    description.format = TextureFormat::RGBA8;
+    description.usage = TextureUsage::Sampled;
+
+    return pieces::Ok<TextureDescription, std::string>(std::move(description));
+}
+
+pieces::Result<TextureMipChain, std::string> decodeTextureMips(
+    std::span<const uint8_t> _encoded, uint32_t _firstMip,
+    std::span<const TextureFormat> _supported)
+{
+    if (isKtx2(_encoded)) return decodeKtx2(_encoded, _firstMip, _supported);
+
+    if (_encoded.size() > INT_MAX)
+    {
+        return pieces::Err<TextureMipChain, std::string>("image too large");
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+
+    std::unique_ptr<stbi_uc, void (*)(void*)> image(
+        stbi_load_from_memory(_encoded.data(), static_cast<int>(_encoded.size()), &width, &height,
+                              &channels, k_channels),
+        stbi_image_free);
+
+    if (!image)
+    {
+        return pieces::Err<TextureMipChain, std::string>(std::string("failed to decode image: ") +
+                                                         stbi_failure_reason());
+    }
+
+    const uint32_t mipLevels =
+        getMipLevelCount(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+    TextureMipChain chain;
+    chain.firstMip = std::min(_firstMip, mipLevels - 1);
+
+    size_t size = 0;
+    for (uint32_t mip = chain.firstMip; mip < mipLevels; ++mip)
+    {
+        TextureMip& level = chain.mips.emplace_back();
+        level.width = std::max(static_cast<uint32_t>(width) >> mip, 1u);
+        level.height = std::max(static_cast<uint32_t>(height) >> mip, 1u);
+        level.offset = size;
+        level.size = static_cast<size_t>(level.width) * level.height * k_channels;
+        size += level.size;
+    }
+
+    chain.texels.resize(size);
+
+    // The first mip from the image, each of the next from the one before
+    const stbi_uc* source = image.get();
+    int sourceWidth = width;
+    int sourceHeight = height;
+
+    for (const TextureMip& level : chain.mips)
+    {
+        uint8_t* texels = chain.texels.data() + level.offset;
+        const int levelWidth = static_cast<int>(level.width);
+        const int levelHeight = static_cast<int>(level.height);
+
+        if (levelWidth == sourceWidth && levelHeight == sourceHeight)
+        {
+            std::memcpy(texels, source, level.size);
+        }
+        else if (!stbir_resize_uint8_srgb(source, sourceWidth, sourceHeight, 0, texels,
+                                          levelWidth, levelHeight, 0, STBIR_RGBA))
+        {
+            return pieces::Err<TextureMipChain, std::string>("failed to downsample image");
+        }
+
+        source = texels;
+        sourceWidth = levelWidth;
+        sourceHeight = levelHeight;
+    }
+
+    return pieces::Ok<TextureMipChain, std::string>(std::move(chain));
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,257 @@
+#include "mosaic/graphics/texture_streaming.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <pieces/memory/frame_arena.hpp>
+
+namespace mosaic
+{
+namespace graphics
+{
+
+TextureStreamer::TextureStreamer(const TextureStreamingSettings& _settings)
+    : m_settings(_settings),
+      m_budget(_settings.budget)
+{
+}
+
+StreamedTextureId TextureStreamer::add(uint32_t _width, uint32_t _height, uint32_t _mipLevels,
+                                       TextureFormat _format)
+{
+    Texture& texture = m_textures.emplace_back();
+    texture.width = std::max(_width, 1u);
+    texture.height = std::max(_height, 1u);
+    texture.mipLevels = std::max(_mipLevels, 1u);
+    texture.format = _format;
+
+    const uint32_t lastMip = texture.mipLevels - 1;
+
+    auto getExtent = [&](uint32_t _mip)
+    { return std::max({texture.width >> _mip, texture.height >> _mip, 1u}); };
+
+    auto getMipSize = [&](uint32_t _mip)
+    {
+        return getTextureMipSize(texture.format, std::max(texture.width >> _mip, 1u),
+                                 std::max(texture.height >> _mip, 1u));
+    };
+
+    while (texture.finestMip < lastMip && getMipSize(texture.finestMip) > m_settings.maxMipSize)
+    {
+        ++texture.finestMip;
+    }
+
+    while (texture.tailMip < lastMip && getExtent(texture.tailMip) > m_settings.tailExtent)
+    {
+        ++texture.tailMip;
+    }
+
+    texture.tailMip = std::max(texture.tailMip, texture.finestMip);
+    texture.residentMip = texture.mipLevels;
+    texture.pendingMip = texture.mipLevels;
+    texture.requestedMip = lastMip;
+    texture.queued = true;
+
+    return static_cast<StreamedTextureId>(m_textures.size() - 1);
+}
+
+void TextureStreamer::request(StreamedTextureId _texture, float _screenExtent)
+{
+    Texture& texture = m_textures[_texture];
+
+    uint32_t mip = selectMip(texture.width, texture.height, texture.mipLevels, _screenExtent);
+    mip = std::clamp(mip, texture.finestMip, texture.tailMip);
+
+    if (texture.lastUse != m_frame)
+    {
+        texture.lastUse = m_frame;
+        texture.requestedMip = mip;
+        return;
+    }
+
+    texture.requestedMip = std::min(texture.requestedMip, mip);
+}
+
+void TextureStreamer::setBudget(uint64_t _budget) noexcept
+{
+    m_budget = std::min(_budget, m_settings.budget);
+}
+
+std::vector<TextureResidencyChange> TextureStreamer::update()
+{
+    std::vector<TextureResidencyChange> changes;
+
+    auto plan = [&](StreamedTextureId _id, uint32_t _firstMip)
+    {
+        m_textures[_id].pendingMip = _firstMip;
+        changes.push_back({_id, _firstMip});
+    };
+
+    for (StreamedTextureId id = 0; id < m_textures.size(); ++id)
+    {
+        if (!m_textures[id].queued) continue;
+
+        m_textures[id].queued = false;
+        plan(id, m_textures[id].tailMip);
+    }
+
+    uint64_t committed = getCommittedSize();
+
+    // of the evictions in flight, free once they complete
+    uint64_t freeing = 0;
+    for (const Texture& texture : m_textures)
+    {
+        if (texture.pendingMip <= texture.residentMip) continue;
+
+        freeing += getSize(texture, texture.residentMip) - getSize(texture, texture.pendingMip);
+    }
+
+    auto isDrawn = [&](const Texture& _texture) { return _texture.lastUse == m_frame; };
+
+    pieces::FrameArena& arena = pieces::FrameArena::local();
+    auto scope = arena.scope();
+
+    // The least recently drawn first, those drawn this frame (smaller than their mips) last
+    std::pmr::vector<StreamedTextureId> candidates(arena.getResource());
+    candidates.reserve(m_textures.size());
+    for (StreamedTextureId id = 0; id < m_textures.size(); ++id) candidates.push_back(id);
+
+    std::sort(candidates.begin(), candidates.end(),
+              [&](StreamedTextureId _a, StreamedTextureId _b)
+              {
+                  return std::pair(m_textures[_a].lastUse, _a) <
+                         std::pair(m_textures[_b].lastUse, _b);
+              });
+
+    size_t nextCandidate = 0;
+
+    auto evictUntil = [&](uint64_t _limit)
+    {
+        while (committed - freeing > _limit && nextCandidate < candidates.size())
+        {
+            const StreamedTextureId id = candidates[nextCandidate++];
+            const Texture& texture = m_textures[id];
+
+            if (texture.pendingMip != texture.residentMip) continue;
+
+            const uint32_t target = isDrawn(texture) ? texture.requestedMip : texture.tailMip;
+            if (target <= texture.residentMip) continue;
+
+            freeing += getSize(texture, texture.residentMip) - getSize(texture, target);
+            plan(id, target);
+        }
+    };
+
+    // the budget may have shrunk
+    evictUntil(m_budget);
+
+    // The loads, the most blurred first
+    std::pmr::vector<StreamedTextureId> loads(arena.getResource());
+    for (StreamedTextureId id = 0; id < m_textures.size(); ++id)
+    {
+        const Texture& texture = m_textures[id];
+
+        if (isDrawn(texture) && texture.pendingMip == texture.residentMip &&
+            texture.requestedMip < texture.residentMip)
+        {
+            loads.push_back(id);
+        }
+    }
+
+    std::sort(loads.begin(), loads.end(),
+              [&](StreamedTextureId _a, StreamedTextureId _b)
+              {
+                  const Texture& a = m_textures[_a];
+                  const Texture& b = m_textures[_b];
+                  const uint32_t blurA = a.residentMip - a.requestedMip;
+                  const uint32_t blurB = b.residentMip - b.requestedMip;
+
+                  return blurA != blurB ? blurA > blurB : _a < _b;
+              });
+
+    for (const StreamedTextureId id : loads)
+    {
+        const Texture& texture = m_textures[id];
+        const uint64_t resident = getSize(texture, texture.residentMip);
+
+        auto getNeed = [&](uint32_t _mip) { return getSize(texture, _mip) - resident; };
+
+        uint64_t need = getNeed(texture.requestedMip);
+        if (committed + need > m_budget)
+        {
+            if (need <= m_budget) evictUntil(m_budget - need);
+
+            // loaded once the evictions freed the memory
+            if (committed - freeing + need <= m_budget) continue;
+        }
+
+        // the finest mips that fit, if not those requested
+        uint32_t mip = texture.requestedMip;
+        while (mip < texture.residentMip && committed + getNeed(mip) > m_budget) ++mip;
+
+        if (mip == texture.residentMip) continue;
+
+        need = getNeed(mip);
+        committed += need;
+        plan(id, mip);
+    }
+
+    ++m_frame;
+
+    return changes;
+}
+
+void TextureStreamer::onResident(StreamedTextureId _texture, uint32_t _firstMip)
+{
+    Texture& texture = m_textures[_texture];
+    texture.residentMip = _firstMip;
+    texture.pendingMip = _firstMip;
+}
+
+uint64_t TextureStreamer::getCommittedSize() const noexcept
+{
+    uint64_t size = 0;
+    for (const Texture& texture : m_textures)
+    {
+        size += getSize(texture, std::min(texture.residentMip, texture.pendingMip));
+    }
+
+    return size;
+}
+
+uint64_t TextureStreamer::getMipChainSize(uint32_t _width, uint32_t _height, uint32_t _mipLevels,
+                                          uint32_t _firstMip, TextureFormat _format) noexcept
+{
+    uint64_t size = 0;
+    for (uint32_t mip = _firstMip; mip < _mipLevels; ++mip)
+    {
+        size += getTextureMipSize(_format, std::max(_width >> mip, 1u),
+                                  std::max(_height >> mip, 1u));
+    }
+
+    return size;
+}
+
+uint32_t TextureStreamer::selectMip(uint32_t _width, uint32_t _height, uint32_t _mipLevels,
+                                    float _screenExtent) noexcept
+{
+    const uint32_t lastMip = std::max(_mipLevels, 1u) - 1;
+    if (!(_screenExtent > 0.0f)) return lastMip;
+
+    const float texelsPerPixel = static_cast<float>(std::max(_width, _height)) / _screenExtent;
+    if (texelsPerPixel <= 1.0f) return 0;
+
+    const auto mip = static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel)));
+
+    return std::min(mip, lastMip);
+}
+
+uint64_t TextureStreamer::getSize(const Texture& _texture, uint32_t _firstMip) const noexcept
+{
+    return getMipChainSize(_texture.width, _texture.height, _texture.mipLevels, _firstMip,
+                           _texture.format);
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -0,0 +1,336 @@
+#include "mosaic/graphics/ui_batcher.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace graphics
+{
+
+// The vertices a convex quad has at most once clipped by a rectangle
+static constexpr size_t k_maxClippedVertices = 8;
+
+static constexpr char32_t k_replacement = 0xFFFD;
+
+// The next codepoint of _text from _offset, U+FFFD for a malformed sequence (one byte skipped).
+static char32_t decodeUtf8(std::string_view _text, size_t& _offset) noexcept
+{
+    const auto byte = [&](size_t _index) { return static_cast<uint8_t>(_text[_index]); };
+
+    const uint8_t lead = byte(_offset);
+    if (lead < 0x80)
+    {
+        ++_offset;
+        return lead;
+    }
+
+    size_t length = 0;
+    char32_t codepoint = 0;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        length = 2;
+        codepoint = lead & 0x1F;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        length = 3;
+        codepoint = lead & 0x0F;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        length = 4;
+        codepoint = lead & 0x07;
+    }
+
+    if (length == 0 || _offset + length > _text.size())
+    {
+        ++_offset;
+        return k_replacement;
+    }
+
+    for (size_t i = 1; i < length; ++i)
+    {
+        if ((byte(_offset + i) & 0xC0) != 0x80)
+        {
+            ++_offset;
+            return k_replacement;
+        }
+        codepoint = (codepoint << 6) | (byte(_offset + i) & 0x3F);
+    }
+
+    _offset += length;
+    return codepoint > 0x10FFFF ? k_replacement : codepoint;
+}
+
+/**
+ * Lays out _text at _size, _place(glyph, penX, baseline) called for each glyph, from a pen at
+ * x = 0 and a first baseline at the ascent. Returns the width of the longest line.
+ */
+template <typename Place>
+static float layoutText(GlyphAtlas& _atlas, FontId _font, float _size, std::string_view _text,
+                        Place&& _place)
+{
+    const GlyphSource& font = _atlas.getFont(_font);
+    const float scale = _size / _atlas.getSettings().pixelHeight;
+    const float lineHeight = font.getLineHeight(_size);
+
+    float penX = 0.0f;
+    float baseline = font.getAscent(_size);
+    float width = 0.0f;
+    char32_t previous = 0;
+
+    for (size_t offset = 0; offset < _text.size();)
+    {
+        const char32_t codepoint = decodeUtf8(_text, offset);
+
+        if (codepoint == U'\n')
+        {
+            width = std::max(width, penX);
+            penX = 0.0f;
+            baseline += lineHeight;
+            previous = 0;
+            continue;
+        }
+
+        if (previous != 0) penX += font.getKerning(previous, codepoint, _size);
+
+        const AtlasGlyph& glyph = _atlas.find(_font, codepoint);
+        _place(glyph, penX, baseline, scale);
+
+        penX += glyph.advance * scale;
+        previous = codepoint;
+    }
+
+    return std::max(width, penX);
+}
+
+static UiRect intersect(const UiRect& _a, const UiRect& _b) noexcept
+{
+    return {std::max(_a.x0, _b.x0), std::max(_a.y0, _b.y0), std::min(_a.x1, _b.x1),
+            std::min(_a.y1, _b.y1)};
+}
+
+// _a + (_b - _a) * _t, in position and texture coordinates
+static UiVertex lerp(const UiVertex& _a, const UiVertex& _b, float _t) noexcept
+{
+    UiVertex vertex = _a;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        vertex.position[i] = _a.position[i] + (_b.position[i] - _a.position[i]) * _t;
+        vertex.uv[i] = _a.uv[i] + (_b.uv[i] - _a.uv[i]) * _t;
+    }
+    return vertex;
+}
+
+void UiBatcher::begin(uint32_t _width, uint32_t _height)
+{
+    m_vertices.clear();
+    m_indices.clear();
+    m_clips.clear();
+
+    m_width = _width;
+    m_height = _height;
+    m_clips.push_back({0.0f, 0.0f, static_cast<float>(_width), static_cast<float>(_height)});
+}
+
+void UiBatcher::pushClip(const UiRect& _rect)
+{
+    m_clips.push_back(intersect(getClip(), _rect));
+}
+
+void UiBatcher::popClip()
+{
+    // the viewport stays
+    if (m_clips.size() > 1) m_clips.pop_back();
+}
+
+void UiBatcher::addRect(const UiRect& _rect, uint32_t _color)
+{
+    addQuad(_rect, {}, _color, 0, 0, UiVertex::k_solid);
+}
+
+void UiBatcher::addImage(const UiRect& _rect, uint32_t _texture, const UiRect& _uv,
+                         uint32_t _color)
+{
+    addQuad(_rect, _uv, _color, _texture, 0, UiVertex::k_image);
+}
+
+void UiBatcher::addLine(float _x0, float _y0, float _x1, float _y1, float _thickness,
+                        uint32_t _color)
+{
+    const float dx = _x1 - _x0;
+    const float dy = _y1 - _y0;
+    const float length = std::sqrt(dx * dx + dy * dy);
+    if (!(length > 0.0f) || !(_thickness > 0.0f)) return;
+
+    // half the thickness each side, along the normal
+    const float nx = -dy / length * _thickness * 0.5f;
+    const float ny = dx / length * _thickness * 0.5f;
+
+    std::array<UiVertex, 4> corners;
+    corners[0].position = {_x0 + nx, _y0 + ny};
+    corners[1].position = {_x1 + nx, _y1 + ny};
+    corners[2].position = {_x1 - nx, _y1 - ny};
+    corners[3].position = {_x0 - nx, _y0 - ny};
+    for (UiVertex& corner : corners) corner.color = _color;
+
+    addPolygon(corners);
+}
+
+float UiBatcher::addText(GlyphAtlas& _atlas, FontId _font, float _x, float _y, float _size,
+                         std::string_view _text, uint32_t _color)
+{
+    return layoutText(_atlas, _font, _size, _text,
+                      [&](const AtlasGlyph& _glyph, float _penX, float _baseline, float _scale)
+                      {
+                          if (!_glyph.resident) return;
+
+                          const float x0 = _x + _penX + _glyph.left * _scale;
+                          const float y0 = _y + _baseline + _glyph.top * _scale;
+                          addQuad({x0, y0, x0 + _glyph.width * _scale,
+                                   y0 + _glyph.height * _scale},
+                                  {_glyph.uv[0], _glyph.uv[1], _glyph.uv[2], _glyph.uv[3]},
+                                  _color, 0, _glyph.layer, UiVertex::k_text);
+                      });
+}
+
+float UiBatcher::measureText(GlyphAtlas& _atlas, FontId _font, float _size,
+                             std::string_view _text)
+{
+    return layoutText(_atlas, _font, _size, _text, [](const AtlasGlyph&, float, float, float) {});
+}
+
+uint32_t UiBatcher::emit(FrameRing& _ring, DrawQueue& _queue, uint32_t _vertexBuffer,
+                         DrawCall _call) const
+{
+    if (m_indices.empty()) return 0;
+
+    const size_t vertexSize = m_vertices.size() * sizeof(UiVertex);
+    const size_t indexSize = m_indices.size() * sizeof(uint32_t);
+
+    // aligned to their element, the offsets are indices in the buffer
+    const FrameAllocation vertices = _ring.allocate(vertexSize, sizeof(UiVertex));
+    const FrameAllocation indices = vertices ? _ring.allocate(indexSize, sizeof(uint32_t))
+                                             : FrameAllocation{};
+    if (!indices)
+    {
+        MOSAIC_ERROR("The frame ring is out of memory for {} UI vertices", m_vertices.size());
+        return 0;
+    }
+
+    std::memcpy(vertices.data, m_vertices.data(), vertexSize);
+    std::memcpy(indices.data, m_indices.data(), indexSize);
+
+    _call.type = DrawCallType::Indexed;
+    _call.indexCount = static_cast<uint32_t>(m_indices.size());
+    _call.instanceCount = 1;
+    _call.firstIndex = static_cast<uint32_t>(indices.offset / sizeof(uint32_t));
+    _call.vertexOffset = static_cast<uint32_t>(vertices.offset / sizeof(UiVertex));
+    _call.resources[k_vertexResource] = _vertexBuffer;
+    _call.resources[k_viewportResource] = (m_width & 0xFFFFu) | (m_height << 16);
+
+    _queue.submit(_call);
+    return 1;
+}
+
+void UiBatcher::addQuad(const UiRect& _rect, const UiRect& _uv, uint32_t _color,
+                        uint32_t _texture, uint32_t _layer, uint32_t _mode)
+{
+    const UiRect clipped = intersect(_rect, getClip());
+    if (clipped.isEmpty()) return;
+
+    // the texture coordinates cut with the rectangle
+    const float du = (_uv.x1 - _uv.x0) / (_rect.x1 - _rect.x0);
+    const float dv = (_uv.y1 - _uv.y0) / (_rect.y1 - _rect.y0);
+    const UiRect uv = {_uv.x0 + (clipped.x0 - _rect.x0) * du, _uv.y0 + (clipped.y0 - _rect.y0) * dv,
+                       _uv.x0 + (clipped.x1 - _rect.x0) * du,
+                       _uv.y0 + (clipped.y1 - _rect.y0) * dv};
+
+    const uint32_t base = static_cast<uint32_t>(m_vertices.size());
+
+    const std::array<std::array<float, 4>, 4> corners = {{
+        {clipped.x0, clipped.y0, uv.x0, uv.y0},
+        {clipped.x1, clipped.y0, uv.x1, uv.y0},
+        {clipped.x1, clipped.y1, uv.x1, uv.y1},
+        {clipped.x0, clipped.y1, uv.x0, uv.y1},
+    }};
+
+    for (const auto& corner : corners)
+    {
+        UiVertex& vertex = m_vertices.emplace_back();
+        vertex.position = {corner[0], corner[1]};
+        vertex.uv = {corner[2], corner[3]};
+        vertex.color = _color;
+        vertex.texture = _texture;
+        vertex.layer = _layer;
+        vertex.mode = _mode;
+    }
+
+    m_indices.insert(m_indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+}
+
+void UiBatcher::addPolygon(std::span<const UiVertex> _vertices)
+{
+    const UiRect clip = getClip();
+
+    // Sutherland-Hodgman, an edge of the clip at a time; the distance inside each edge
+    std::array<UiVertex, k_maxClippedVertices> buffers[2];
+    size_t count = std::min(_vertices.size(), size_t{4});
+    std::copy_n(_vertices.begin(), count, buffers[0].begin());
+
+    const auto inside = [&](const UiVertex& _vertex, int _edge)
+    {
+        switch (_edge)
+        {
+            case 0:
+                return _vertex.position[0] - clip.x0;
+            case 1:
+                return clip.x1 - _vertex.position[0];
+            case 2:
+                return _vertex.position[1] - clip.y0;
+            default:
+                return clip.y1 - _vertex.position[1];
+        }
+    };
+
+    int current = 0;
+    for (int edge = 0; edge < 4 && count > 0; ++edge)
+    {
+        const auto& input = buffers[current];
+        auto& output = buffers[1 - current];
+        size_t written = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const UiVertex& a = input[i];
+            const UiVertex& b = input[(i + 1) % count];
+            const float da = inside(a, edge);
+            const float db = inside(b, edge);
+
+            if (da >= 0.0f) output[written++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) output[written++] = lerp(a, b, da / (da - db));
+        }
+
+        count = written;
+        current = 1 - current;
+    }
+
+    if (count < 3) return;
+
+    // a fan, the polygon convex
+    const uint32_t base = static_cast<uint32_t>(m_vertices.size());
+    m_vertices.insert(m_vertices.end(), buffers[current].begin(),
+                      buffers[current].begin() + count);
+
+    for (uint32_t i = 1; i + 1 < count; ++i)
+    {
+        m_indices.insert(m_indices.end(), {base, base + i, base + i + 1});
+    }
+}
+
+} // namespace graphics
+} // namespace mosaic
@@ -1,5 +1,6 @@
 #include "mosaic/input/input_context.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -7,15 +8,22 @@
 #include <vector>
 #include <exception>
 #include <fstream>
+#include <iterator>
+#include <optional>
 
 #include <nlohmann/json.hpp>
 #include <nlohmann/json_fwd.hpp>
 
+#include <pieces/containers/flat_hash_map.hpp>
 #include <pieces/core/result.hpp>
+#include <pieces/utils/string_id.hpp>
 
+#include "mosaic/core/virtual_file_system.hpp"
 #include "mosaic/tools/logger.hpp"
 #include "mosaic/input/action.hpp"
+#include "mosaic/input/input_recording.hpp"
 #include "mosaic/input/mappings.hpp"
+#include "mosaic/input/sources/replay_input_sources.hpp"
 #include "mosaic/window/window.hpp"
 
 namespace mosaic
@@ -32,17 +40,53 @@ struct InputContext::Impl
 #include "mosaic/input/sources.def"
 #undef DEFINE_SOURCE
 
+    // Recording and replay; the sources replaced by the replay ones are kept aside
+    std::unique_ptr<InputRecorder> recorder;
+    std::unique_ptr<InputReplay> replay;
+#define DEFINE_SOURCE(_Type, _Member, _Name) std::unique_ptr<_Type> replaced##_Name;
+#include "mosaic/input/sources.def"
+#undef DEFINE_SOURCE
+
+    std::optional<core::TickClock::time_point> oldestInput;
+
     // Virtual keys and buttons mapped to their native equivalents
-    std::unordered_map<std::string, KeyboardKey> virtualKeyboardKeys;
-    std::unordered_map<std::string, MouseButton> virtualMouseButtons;
+    pieces::FlatHashMap<std::string, KeyboardKey> virtualKeyboardKeys;
+    pieces::FlatHashMap<std::string, MouseButton> virtualMouseButtons;
 
-    // Bound actions triggers
-    std::unordered_map<std::string, Action> actions;
+    struct ActionSlot
+    {
+        Action action;
+        bool registered = false;
+    };
+
+    // Bound actions triggers, by ActionId, and the ids by the id of their name
+    std::vector<ActionSlot> actions;
+    std::vector<ActionId> freeActionIds;
+    pieces::FlatHashMap<pieces::StringId, ActionId> actionIds;
 
-    // Cache
-    std::unordered_map<std::string, bool> triggeredActionsCache;
+    // One bit per ActionId, cleared by update(): evaluated this update, and the result
+    std::vector<uint64_t> evaluatedActions;
+    std::vector<uint64_t> triggeredActions;
 
     Impl(const window::Window* _window) : window(_window) {};
+
+    [[nodiscard]] static bool testBit(const std::vector<uint64_t>& _bits, ActionId _id) noexcept
+    {
+        return (_bits[_id / 64] >> (_id % 64)) & 1;
+    }
+
+    static void assignBit(std::vector<uint64_t>& _bits, ActionId _id, bool _value) noexcept
+    {
+        const uint64_t mask = uint64_t(1) << (_id % 64);
+        _bits[_id / 64] = _value ? _bits[_id / 64] | mask : _bits[_id / 64] & ~mask;
+    }
+
+    void resizeActionBits()
+    {
+        const size_t wordCount = (actions.size() + 63) / 64;
+        evaluatedActions.resize(wordCount, 0);
+        triggeredActions.resize(wordCount, 0);
+    }
 };
 
 InputContext::InputContext(const window::Window* _window) : m_impl(new Impl(_window)) {}
@@ -56,6 +100,10 @@ pieces::RefResult<InputContext, std::string> InputContext::initialize()
 
 void InputContext::shutdown()
 {
+    stopReplay();
+    stopRecording();
+
+    removeTouchInputSource();
     removeUnifiedTextInputSource();
     removeKeyboardInputSource();
     removeMouseInputSource();
@@ -63,18 +111,62 @@ void InputContext::shutdown()
 
 void InputContext::update()
 {
+    if (m_impl->replay) (void)m_impl->replay->advance();
+    if (m_impl->recorder) m_impl->recorder->beginFrame(core::TickClock::now());
+
     if (m_impl->mouseSource) m_impl->mouseSource->processInput();
     if (m_impl->keyboardInputSource) m_impl->keyboardInputSource->processInput();
     if (m_impl->unifiedTextInputSource) m_impl->unifiedTextInputSource->processInput();
+    if (m_impl->touchSource) m_impl->touchSource->processInput();
+
+    // the oldest of the sources, for the input-to-present latency of the frame
+    m_impl->oldestInput.reset();
+    const auto takeOldestInput = [this](InputSource& _source)
+    {
+        const auto input = _source.takeOldestInput();
+        if (input && (!m_impl->oldestInput || *input < *m_impl->oldestInput))
+        {
+            m_impl->oldestInput = input;
+        }
+    };
+
+#define DEFINE_SOURCE(_Type, _Member, _Name) \
+    if (m_impl->_Member) takeOldestInput(*m_impl->_Member);
+#include "mosaic/input/sources.def"
+#undef DEFINE_SOURCE
+
+    if (m_impl->recorder) m_impl->recorder->endFrame();
+
+    std::ranges::fill(m_impl->evaluatedActions, 0);
+
+    // In id order; the triggers querying other actions evaluate them first
+    for (ActionId id = 0; id < m_impl->actions.size(); ++id)
+    {
+        if (m_impl->actions[id].registered) (void)isActionTriggered(id);
+    }
+}
 
-    m_impl->triggeredActionsCache.clear();
+std::optional<core::TickClock::time_point> InputContext::getOldestInput() const
+{
+    return m_impl->oldestInput;
 }
 
 void InputContext::loadVirtualKeysAndButtons(const std::string& _filePath)
 {
-    std::ifstream file(_filePath);
+    // through the mounts of the application (archives, the APK assets) when it has them
+    std::optional<core::FileData> data;
+    if (core::VirtualFileSystem* files = core::VirtualFileSystem::getInstance())
+    {
+        auto result = files->read(_filePath);
+        if (result.isOk()) data = result.unwrap();
+    }
+    else if (std::ifstream file(_filePath, std::ios::binary); file.is_open())
+    {
+        data = core::FileData::fromBuffer(
+            std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {}));
+    }
 
-    if (!file.is_open())
+    if (!data)
     {
         MOSAIC_ERROR("Failed to open virtual mouse buttons file: {}", _filePath);
         return;
@@ -84,7 +176,7 @@ void InputContext::loadVirtualKeysAndButtons(const std::string& _filePath)
 
     try
     {
-        file >> jsonData;
+        jsonData = nlohmann::json::parse(data->bytes().begin(), data->bytes().end());
     }
     catch (const nlohmann::json::parse_error& e)
     {
@@ -182,98 +274,246 @@ void InputContext::updateVirtualMouseButtons(
     }
 }
 
-void InputContext::registerActions(const std::vector<Action>&& _actions)
+std::vector<ActionId> InputContext::registerActions(const std::vector<Action>&& _actions)
 {
-    auto& actions = m_impl->actions;
+    std::vector<ActionId> ids;
+    ids.reserve(_actions.size());
 
-    const auto backupActions = m_impl->actions;
-
-    try
+    for (auto& action : _actions)
     {
-        for (auto& action : _actions)
+        // Interned, for the logs of the lookups by id
+        const auto name = pieces::StringId::intern(action.name);
+
+        if (m_impl->actionIds.find(name) != m_impl->actionIds.end())
         {
-            if (actions.find(action.name) != actions.end())
-            {
-                MOSAIC_ERROR("An action with the name '{}' already exists. ", action.name);
-                continue;
-            }
+            MOSAIC_ERROR("An action with the name '{}' already exists. ", action.name);
+            ids.push_back(k_invalidActionId);
+            continue;
+        }
 
-            actions[action.name] = action;
+        ActionId id;
+        if (!m_impl->freeActionIds.empty())
+        {
+            id = m_impl->freeActionIds.back();
+            m_impl->freeActionIds.pop_back();
         }
-    }
-    catch (const std::exception& e)
-    {
-        actions = backupActions;
+        else
+        {
+            id = static_cast<ActionId>(m_impl->actions.size());
+            m_impl->actions.emplace_back();
+            m_impl->resizeActionBits();
+        }
+
+        m_impl->actions[id] = {action, true};
+        m_impl->actionIds[name] = id;
 
-        MOSAIC_ERROR("Failed to register actions: {}", e.what());
+        // Evaluated at its first query until the next update
+        Impl::assignBit(m_impl->evaluatedActions, id, false);
+
+        ids.push_back(id);
     }
+
+    return ids;
 }
 
 void InputContext::unregisterActions(const std::vector<std::string>&& _names)
 {
     for (const auto& name : _names)
     {
-        if (m_impl->actions.find(name) == m_impl->actions.end())
+        const auto it = m_impl->actionIds.find(pieces::StringId(name));
+
+        if (it == m_impl->actionIds.end())
         {
             MOSAIC_ERROR("An action with the name '{}' does not exist. ", name);
             continue;
         }
 
-        m_impl->actions.erase(name);
+        const ActionId id = it->second;
+        m_impl->actionIds.erase(it);
+
+        m_impl->actions[id] = {};
+        m_impl->freeActionIds.push_back(id);
     }
 }
 
-bool InputContext::isActionTriggered(const std::string& _name, bool _onlyCurrPoll)
+ActionId InputContext::getActionId(pieces::StringId _name) const
+{
+    const auto it = m_impl->actionIds.find(_name);
+    return it != m_impl->actionIds.end() ? it->second : k_invalidActionId;
+}
+
+bool InputContext::isActionTriggered(ActionId _id, [[maybe_unused]] bool _onlyCurrPoll)
 {
-    auto& actions = m_impl->actions;
-    auto& triggeredActionsCache = m_impl->triggeredActionsCache;
+    if (_id >= m_impl->actions.size() || !m_impl->actions[_id].registered)
+    {
+        MOSAIC_ERROR("Action not found: {}", _id);
+        return false;
+    }
+
+    if (Impl::testBit(m_impl->evaluatedActions, _id))
+    {
+        return Impl::testBit(m_impl->triggeredActions, _id);
+    }
+
+    // Marked first, so that triggers querying each other end (false for the one in progress)
+    Impl::assignBit(m_impl->evaluatedActions, _id, true);
+    Impl::assignBit(m_impl->triggeredActions, _id, false);
 
-    const auto actionIt = m_impl->actions.find(_name);
+    const bool triggered = m_impl->actions[_id].action.trigger(this);
+    Impl::assignBit(m_impl->triggeredActions, _id, triggered);
+
+    return triggered;
+}
 
-    if (actionIt == actions.end())
+bool InputContext::isActionTriggered(const std::string& _name, bool _onlyCurrPoll)
+{
+    const ActionId id = getActionId(pieces::StringId(_name));
+
+    if (id == k_invalidActionId)
     {
         MOSAIC_ERROR("Action not found: {}", _name);
         return false;
     }
 
-    const auto cacheIt = triggeredActionsCache.find(_name);
+    return isActionTriggered(id, _onlyCurrPoll);
+}
+
+bool InputContext::isActionTriggered(pieces::StringId _name, bool _onlyCurrPoll)
+{
+    const ActionId id = getActionId(_name);
+
+    if (id == k_invalidActionId)
+    {
+        // Only the registered names are interned
+        if (const std::string_view name = _name.str(); !name.empty())
+        {
+            MOSAIC_ERROR("Action not found: {}", name);
+        }
+        else
+        {
+            MOSAIC_ERROR("Action not found: {:#018x}", _name.getHash());
+        }
+
+        return false;
+    }
+
+    return isActionTriggered(id, _onlyCurrPoll);
+}
+
+pieces::RefResult<InputContext, std::string> InputContext::startRecording(
+    const std::filesystem::path& _filePath)
+{
+    stopRecording();
+
+    try
+    {
+        m_impl->recorder = std::make_unique<InputRecorder>(_filePath);
+    }
+    catch (const std::exception& e)
+    {
+        return pieces::ErrRef<InputContext, std::string>(e.what());
+    }
+
+#define DEFINE_SOURCE(_Type, _Member, _Name) \
+    if (m_impl->_Member) m_impl->_Member->setRecorder(m_impl->recorder.get());
+#include "mosaic/input/sources.def"
+#undef DEFINE_SOURCE
+
+    return pieces::OkRef<InputContext, std::string>(*this);
+}
+
+void InputContext::stopRecording()
+{
+    if (!m_impl->recorder) return;
+
+#define DEFINE_SOURCE(_Type, _Member, _Name) \
+    if (m_impl->_Member) m_impl->_Member->setRecorder(nullptr);
+#include "mosaic/input/sources.def"
+#undef DEFINE_SOURCE
 
-    if (cacheIt != triggeredActionsCache.end())
+    // Flushed on destruction
+    m_impl->recorder.reset();
+}
+
+bool InputContext::isRecording() const { return m_impl->recorder != nullptr; }
+
+pieces::RefResult<InputContext, std::string> InputContext::startReplay(
+    const std::filesystem::path& _filePath)
+{
+    stopReplay();
+
+    try
     {
-        return cacheIt->second;
+        m_impl->replay = std::make_unique<InputReplay>(_filePath);
     }
+    catch (const std::exception& e)
+    {
+        return pieces::ErrRef<InputContext, std::string>(e.what());
+    }
+
+    auto* window = const_cast<window::Window*>(m_impl->window);
+
+    // The sources the context has are replaced, the others stay absent
+#define DEFINE_SOURCE(_Type, _Member, _Name)                                                    \
+    if (m_impl->_Member)                                                                        \
+    {                                                                                           \
+        m_impl->replaced##_Name = std::move(m_impl->_Member);                                   \
+        m_impl->_Member = std::make_unique<Replay##_Name##Source>(window, m_impl->replay.get()); \
+        (void)m_impl->_Member->initialize();                                                    \
+        m_impl->_Member->setRecorder(m_impl->recorder.get());                                   \
+    }
+#include "mosaic/input/sources.def"
+#undef DEFINE_SOURCE
+
+    return pieces::OkRef<InputContext, std::string>(*this);
+}
 
-    auto result = actionIt->second.trigger(this);
+void InputContext::stopReplay()
+{
+    if (!m_impl->replay) return;
+
+#define DEFINE_SOURCE(_Type, _Member, _Name)                         \
+    if (m_impl->replaced##_Name)                                     \
+    {                                                                \
+        if (m_impl->_Member) m_impl->_Member->shutdown();            \
+        m_impl->_Member = std::move(m_impl->replaced##_Name);        \
+        m_impl->_Member->setRecorder(m_impl->recorder.get());        \
+    }
+#include "mosaic/input/sources.def"
+#undef DEFINE_SOURCE
 
-    triggeredActionsCache[_name] = result;
+    m_impl->replay.reset();
+}
 
-    return result;
+bool InputContext::isReplaying() const
+{
+    return m_impl->replay != nullptr && !m_impl->replay->isFinished();
 }
 
 KeyboardKey InputContext::translateKey(const std::string& _key) const
 {
-    auto& virtualKeyboardKeys = m_impl->virtualKeyboardKeys;
+    const auto it = m_impl->virtualKeyboardKeys.find(_key);
 
-    if (virtualKeyboardKeys.find(_key) == virtualKeyboardKeys.end())
+    if (it == m_impl->virtualKeyboardKeys.end())
     {
         MOSAIC_ERROR("Virtual keyboard key not found: {}", _key);
         return static_cast<KeyboardKey>(0);
     };
 
-    return virtualKeyboardKeys.at(_key);
+    return it->second;
 }
 
 MouseButton InputContext::translateButton(const std::string& _button) const
 {
-    auto& virtualMouseButtons = m_impl->virtualMouseButtons;
+    const auto it = m_impl->virtualMouseButtons.find(_button);
 
-    if (virtualMouseButtons.find(_button) == virtualMouseButtons.end())
+    if (it == m_impl->virtualMouseButtons.end())
     {
         MOSAIC_ERROR("Virtual mouse button not found: {}", _button);
         return static_cast<MouseButton>(0);
     };
 
-    return virtualMouseButtons.at(_button);
+    return it->second;
 }
 
 #define DEFINE_SOURCE(_Type, _Member, _Name)                                     \
@@ -294,6 +534,7 @@ MouseButton InputContext::translateButton(const std::string& _button) const
             return pieces::Err<_Type*, std::string>(std::move(result.error()));  \
         }                                                                        \
                                                                                  \
+        member->setRecorder(m_impl->recorder.get());                             \
         return pieces::Ok<_Type*, std::string>(member.get());                    \
     }                                                                            \
                                                                                  \
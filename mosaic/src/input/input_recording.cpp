@@ -0,0 +1,453 @@
+#include "mosaic/input/input_recording.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "mosaic/core/mapped_file.hpp"
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace input
+{
+
+namespace
+{
+
+constexpr uint8_t k_typeMask = 0x0F;
+constexpr uint8_t k_rawBit = 0x10;
+constexpr uint8_t k_stateShift = 5;
+constexpr uint8_t k_stateMask = 0x03;
+constexpr uint8_t k_floatBit = 0x80;
+
+void putVarint(std::vector<uint8_t>& _bytes, uint64_t _value)
+{
+    while (_value >= 0x80)
+    {
+        _bytes.push_back(uint8_t(_value) | 0x80);
+        _value >>= 7;
+    }
+
+    _bytes.push_back(uint8_t(_value));
+}
+
+void putZigzag(std::vector<uint8_t>& _bytes, int64_t _value)
+{
+    putVarint(_bytes, (uint64_t(_value) << 1) ^ uint64_t(_value >> 63));
+}
+
+void putUint32(std::vector<uint8_t>& _bytes, uint32_t _value)
+{
+    for (int i = 0; i < 4; ++i) _bytes.push_back(uint8_t(_value >> (8 * i)));
+}
+
+void putString(std::vector<uint8_t>& _bytes, const std::string& _string)
+{
+    putVarint(_bytes, _string.size());
+    _bytes.insert(_bytes.end(), _string.begin(), _string.end());
+}
+
+// The integral value of a component, if it is one small enough for the varints
+bool isWhole(float _value)
+{
+    return std::trunc(_value) == _value && std::abs(_value) < 2147483648.0f;
+}
+
+std::vector<uint8_t> readFile(const std::filesystem::path& _path)
+{
+    const core::MappedFile file(_path);
+    const auto bytes = file.bytes();
+
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+} // namespace
+
+InputRecorder::InputRecorder()
+    : m_frameRecordCount(0),
+      m_frameCount(0),
+      m_frameOffset(0),
+      m_cursor(0.0f),
+      m_polledCursor(0.0f),
+      m_hasPolledCursor(false)
+{
+    m_active.fill(-1);
+    m_buttons.fill(uint8_t(InputAction::release));
+    m_keys.fill(uint8_t(InputAction::release));
+
+    putUint32(m_bytes, k_inputRecordingMagic);
+    putUint32(m_bytes, k_inputRecordingVersion);
+}
+
+InputRecorder::InputRecorder(const std::filesystem::path& _path) : InputRecorder()
+{
+    m_file.open(_path, std::ios::binary | std::ios::trunc);
+
+    if (!m_file) throw std::runtime_error("Failed to open " + _path.string());
+
+    m_bytes.reserve(k_inputRecordingFlushSize);
+}
+
+InputRecorder::~InputRecorder() { flush(); }
+
+void InputRecorder::beginFrame(core::TickClock::time_point _time)
+{
+    if (m_frameCount == 0) m_startTime = _time;
+
+    m_frameTime = _time;
+    m_frame.clear();
+    m_frameRecordCount = 0;
+}
+
+void InputRecorder::endFrame()
+{
+    // Offsets since the start, so that the rounding to microseconds does not add up
+    const auto offset = std::max(
+        std::chrono::duration_cast<std::chrono::microseconds>(m_frameTime - m_startTime),
+        m_frameOffset);
+
+    putVarint(m_bytes, uint64_t((offset - m_frameOffset).count()));
+    putVarint(m_bytes, m_frameRecordCount);
+    m_bytes.insert(m_bytes.end(), m_frame.begin(), m_frame.end());
+
+    m_frameOffset = offset;
+    ++m_frameCount;
+
+    if (m_file.is_open() && m_bytes.size() >= k_inputRecordingFlushSize) flush();
+}
+
+void InputRecorder::recordActive(InputRecordSource _source, bool _active)
+{
+    auto& active = m_active[static_cast<size_t>(_source)];
+    if (active == int8_t(_active)) return;
+
+    active = int8_t(_active);
+
+    beginRecord(InputRecordType::active, false, uint8_t(_active), false, {});
+    putVarint(m_frame, static_cast<uint64_t>(_source));
+}
+
+void InputRecorder::recordButton(MouseButton _button, InputAction _action)
+{
+    const auto code = static_cast<uint32_t>(_button);
+    if (code >= m_buttons.size() || m_buttons[code] == uint8_t(_action)) return;
+
+    m_buttons[code] = uint8_t(_action);
+
+    beginRecord(InputRecordType::button, false, uint8_t(_action), false, {});
+    putVarint(m_frame, code);
+}
+
+void InputRecorder::recordKey(KeyboardKey _key, InputAction _action)
+{
+    const auto code = static_cast<uint32_t>(_key);
+    if (code >= m_keys.size() || m_keys[code] == uint8_t(_action)) return;
+
+    m_keys[code] = uint8_t(_action);
+
+    beginRecord(InputRecordType::key, false, uint8_t(_action), false, {});
+    putVarint(m_frame, code);
+}
+
+void InputRecorder::recordCursor(const glm::vec2& _position)
+{
+    if (m_hasPolledCursor && _position == m_polledCursor) return;
+
+    m_polledCursor = _position;
+    m_hasPolledCursor = true;
+
+    writeVectorRecord(InputRecordType::cursor, false, {}, _position, m_cursor);
+    m_cursor = _position;
+}
+
+void InputRecorder::recordScroll(const glm::vec2& _offset)
+{
+    if (_offset == glm::vec2(0.0f)) return;
+
+    writeVectorRecord(InputRecordType::scroll, false, {}, _offset, glm::vec2(0.0f));
+}
+
+void InputRecorder::recordRawEvent(const RawInputEvent& _event)
+{
+    const auto age = getAge(_event.timestamp);
+
+    switch (_event.type)
+    {
+        case RawInputEventType::button:
+            beginRecord(InputRecordType::button, true, uint8_t(_event.pressed), false, age);
+            putVarint(m_frame, _event.code);
+            break;
+        case RawInputEventType::key:
+            beginRecord(InputRecordType::key, true, uint8_t(_event.pressed), false, age);
+            putVarint(m_frame, _event.code);
+            break;
+        case RawInputEventType::cursor:
+            writeVectorRecord(InputRecordType::cursor, true, age, _event.value, m_cursor);
+            m_cursor = _event.value;
+            break;
+        case RawInputEventType::scroll:
+            writeVectorRecord(InputRecordType::scroll, true, age, _event.value, glm::vec2(0.0f));
+            break;
+    }
+}
+
+void InputRecorder::recordText(const TextInputEvent& _event)
+{
+    if (_event.codepoints.empty() && _event.text.empty()) return;
+
+    beginRecord(InputRecordType::text, false, 0, false, {});
+
+    putVarint(m_frame, _event.codepoints.size());
+    for (const char32_t codepoint : _event.codepoints) putVarint(m_frame, uint32_t(codepoint));
+
+    putString(m_frame, _event.text);
+}
+
+void InputRecorder::recordIME(const IMEEvent& _event)
+{
+    beginRecord(InputRecordType::ime, false, 0, false, {});
+
+    putVarint(m_frame, static_cast<uint64_t>(_event.type));
+    putVarint(m_frame, _event.composition.cursor);
+    putString(m_frame, _event.composition.text);
+}
+
+void InputRecorder::recordTouch(const TouchSample& _sample)
+{
+    // whole pixels where the digitizer reports them, the phase in the state of the tag
+    writeVectorRecord(InputRecordType::touch, true, getAge(_sample.timestamp), _sample.position,
+                      glm::vec2(0.0f), uint8_t(_sample.phase));
+    putVarint(m_frame, uint32_t(_sample.pointerId));
+    putUint32(m_frame, std::bit_cast<uint32_t>(_sample.pressure));
+}
+
+void InputRecorder::flush()
+{
+    if (!m_file.is_open() || m_bytes.empty()) return;
+
+    m_file.write(reinterpret_cast<const char*>(m_bytes.data()),
+                 static_cast<std::streamsize>(m_bytes.size()));
+    m_file.flush();
+
+    if (!m_file) MOSAIC_ERROR("InputRecorder: failed to write {} bytes", m_bytes.size());
+
+    m_bytes.clear();
+}
+
+void InputRecorder::beginRecord(InputRecordType _type, bool _raw, uint8_t _state, bool _float,
+                                std::chrono::microseconds _age)
+{
+    uint8_t tag = static_cast<uint8_t>(_type);
+    if (_raw) tag |= k_rawBit;
+    if (_float) tag |= k_floatBit;
+    tag |= uint8_t((_state & k_stateMask) << k_stateShift);
+
+    m_frame.push_back(tag);
+    if (_raw) putZigzag(m_frame, _age.count());
+
+    ++m_frameRecordCount;
+}
+
+void InputRecorder::writeVectorRecord(InputRecordType _type, bool _raw,
+                                      std::chrono::microseconds _age, const glm::vec2& _value,
+                                      const glm::vec2& _base, uint8_t _state)
+{
+    const glm::vec2 delta = _value - _base;
+
+    // Exact only if adding it back gives the same floats
+    if (isWhole(delta.x) && isWhole(delta.y) && _base + delta == _value)
+    {
+        beginRecord(_type, _raw, _state, false, _age);
+        putZigzag(m_frame, int64_t(delta.x));
+        putZigzag(m_frame, int64_t(delta.y));
+        return;
+    }
+
+    beginRecord(_type, _raw, _state, true, _age);
+    putUint32(m_frame, std::bit_cast<uint32_t>(_value.x));
+    putUint32(m_frame, std::bit_cast<uint32_t>(_value.y));
+}
+
+std::chrono::microseconds InputRecorder::getAge(core::TickClock::time_point _time) const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(m_frameTime - _time);
+}
+
+InputReplay::InputReplay(std::vector<uint8_t> _bytes)
+    : m_bytes(std::move(_bytes)),
+      m_offset(0),
+      m_frameOffset(0),
+      m_frameCount(0),
+      m_finished(false),
+      m_cursor(0.0f)
+{
+    if (m_bytes.size() < 8) throw std::runtime_error("Not an input recording");
+
+    const auto readUint32 = [this]
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= uint32_t(readByte()) << (8 * i);
+        return value;
+    };
+
+    if (readUint32() != k_inputRecordingMagic) throw std::runtime_error("Not an input recording");
+
+    // the versions before only lack record types
+    if (const uint32_t version = readUint32(); version == 0 || version > k_inputRecordingVersion)
+    {
+        throw std::runtime_error("Unsupported input recording version " + std::to_string(version));
+    }
+}
+
+InputReplay::InputReplay(const std::filesystem::path& _path) : InputReplay(readFile(_path)) {}
+
+bool InputReplay::advance()
+{
+    m_records.clear();
+    m_texts.clear();
+    m_imes.clear();
+
+    if (m_offset >= m_bytes.size())
+    {
+        m_finished = true;
+        return false;
+    }
+
+    if (m_frameCount == 0) m_startTime = core::TickClock::now();
+
+    m_frameOffset += std::chrono::microseconds(readVarint());
+    const uint64_t count = readVarint();
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        InputRecord& record = m_records.emplace_back();
+
+        const uint8_t tag = readByte();
+        const bool isFloat = tag & k_floatBit;
+
+        if ((tag & k_typeMask) > static_cast<uint8_t>(InputRecordType::touch))
+        {
+            throw std::runtime_error("Malformed input recording");
+        }
+
+        record.type = static_cast<InputRecordType>(tag & k_typeMask);
+        record.raw = tag & k_rawBit;
+        record.state = (tag >> k_stateShift) & k_stateMask;
+
+        if (record.raw) record.age = std::chrono::microseconds(readZigzag());
+
+        const auto readVector = [&](const glm::vec2& _base)
+        {
+            if (isFloat)
+            {
+                const float x = readFloat();
+                return glm::vec2(x, readFloat());
+            }
+
+            const float x = float(readZigzag());
+            return _base + glm::vec2(x, float(readZigzag()));
+        };
+
+        switch (record.type)
+        {
+            case InputRecordType::active:
+            case InputRecordType::button:
+            case InputRecordType::key:
+                record.code = uint32_t(readVarint());
+                break;
+            case InputRecordType::cursor:
+                record.value = readVector(m_cursor);
+                m_cursor = record.value;
+                break;
+            case InputRecordType::scroll:
+                record.value = readVector(glm::vec2(0.0f));
+                break;
+            case InputRecordType::touch:
+                record.value = readVector(glm::vec2(0.0f));
+                record.code = uint32_t(readVarint());
+                record.pressure = readFloat();
+                break;
+            case InputRecordType::text:
+            {
+                std::vector<char32_t> codepoints(readVarint());
+                for (char32_t& codepoint : codepoints) codepoint = char32_t(readVarint());
+
+                record.code = uint32_t(m_texts.size());
+                m_texts.emplace_back(std::move(codepoints), readString(), getFrameTime(), 0);
+                break;
+            }
+            case InputRecordType::ime:
+            {
+                const uint64_t type = readVarint();
+                if (type > static_cast<uint64_t>(IMEEventType::CompositionEnd))
+                {
+                    throw std::runtime_error("Malformed input recording");
+                }
+
+                IMEComposition composition;
+                composition.cursor = size_t(readVarint());
+                composition.text = readString();
+
+                record.code = uint32_t(m_imes.size());
+                m_imes.emplace_back(static_cast<IMEEventType>(type), composition);
+                break;
+            }
+        }
+    }
+
+    ++m_frameCount;
+    return true;
+}
+
+uint8_t InputReplay::readByte()
+{
+    if (m_offset >= m_bytes.size()) throw std::runtime_error("Truncated input recording");
+
+    return m_bytes[m_offset++];
+}
+
+uint64_t InputReplay::readVarint()
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        const uint8_t byte = readByte();
+        value |= uint64_t(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80)) return value;
+    }
+
+    throw std::runtime_error("Malformed input recording");
+}
+
+int64_t InputReplay::readZigzag()
+{
+    const uint64_t value = readVarint();
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+float InputReplay::readFloat()
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; ++i) bits |= uint32_t(readByte()) << (8 * i);
+
+    return std::bit_cast<float>(bits);
+}
+
+std::string InputReplay::readString()
+{
+    const uint64_t size = readVarint();
+    if (size > m_bytes.size() - m_offset) throw std::runtime_error("Truncated input recording");
+
+    std::string string(reinterpret_cast<const char*>(m_bytes.data() + m_offset), size_t(size));
+    m_offset += size_t(size);
+
+    return string;
+}
+
+} // namespace input
+} // namespace mosaic
@@ -21,6 +21,7 @@ namespace input
 struct InputSystem::Impl
 {
     std::unordered_map<const window::Window*, std::unique_ptr<InputContext>> contexts;
+    std::optional<std::chrono::steady_clock::time_point> oldestInput;
 
     Impl() = default;
 };
@@ -94,11 +95,33 @@ void InputSystem::unregisterAllWindows()
 
 pieces::RefResult<core::System, std::string> InputSystem::update()
 {
-    for (auto& [window, context] : m_impl->contexts) context->update();
+    std::optional<core::TickClock::time_point> oldestInput;
+
+    for (auto& [window, context] : m_impl->contexts)
+    {
+        context->update();
+
+        const auto input = context->getOldestInput();
+        if (input && (!oldestInput || *input < *oldestInput)) oldestInput = input;
+    }
+
+    // The time points of the tick clock are on the epoch of the steady clock
+    m_impl->oldestInput.reset();
+    if (oldestInput)
+    {
+        m_impl->oldestInput = std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                oldestInput->time_since_epoch()));
+    }
 
     return pieces::OkRef<System, std::string>(*this);
 }
 
+std::optional<std::chrono::steady_clock::time_point> InputSystem::getOldestInput() const
+{
+    return m_impl->oldestInput;
+}
+
 InputContext* InputSystem::getContext(const window::Window* _window) const
 {
     auto& contexts = m_impl->contexts;
@@ -1,5 +1,7 @@
 #include "mosaic/input/sources/keyboard_input_source.hpp"
 
+#include "mosaic/input/input_recording.hpp"
+
 #if defined(MOSAIC_PLATFORM_DESKTOP) || defined(MOSAIC_PLATFORM_WEB)
 #include "platform/GLFW/glfw_keyboard_input_source.hpp"
 #endif
@@ -13,7 +15,7 @@ namespace input
 
 KeyboardInputSource::KeyboardInputSource(window::Window* _window) : InputSource(_window)
 {
-    auto currentTime = std::chrono::high_resolution_clock::now();
+    auto currentTime = core::TickClock::now();
 
     KeyboardKeyEvent dummyKeyEvent = {
         ActionableState::none,
@@ -39,97 +41,126 @@ std::unique_ptr<KeyboardInputSource> KeyboardInputSource::create(window::Window*
 
 void KeyboardInputSource::processInput()
 {
-    if (!isActive()) return;
+    if (m_recorder) m_recorder->recordActive(InputRecordSource::keyboard, isActive());
+
+    if (!isActive())
+    {
+        // Unfocused, the events queued meanwhile are dropped
+        drainRawEvents([](const RawInputEvent&) {});
+        return;
+    }
 
     pollDevice();
 
-    auto currentTime = std::chrono::high_resolution_clock::now();
+    const auto currentTime = now();
+
+    // The events captured since the last call first, at the time they happened
+    drainRawEvents(
+        [this](const RawInputEvent& _event)
+        {
+            if (_event.type != RawInputEventType::key) return;
+            if (_event.code >= m_keyboardKeyEvents.size()) return;
+            if (m_recorder) m_recorder->recordRawEvent(_event);
+
+            updateKey(static_cast<KeyboardKey>(_event.code),
+                      _event.pressed ? InputAction::press : InputAction::release, _event.timestamp);
+        });
 
     for (const auto& key : c_keyboardKeys)
     {
         const InputAction action = queryKeyState(key);
-        auto& eventQueue = m_keyboardKeyEvents[static_cast<uint32_t>(key)];
+        if (m_recorder) m_recorder->recordKey(key, action);
 
-        const auto lastEvent = eventQueue.front().unwrap();
+        updateKey(key, action, currentTime);
+    }
+}
+
+void KeyboardInputSource::updateKey(KeyboardKey _key, InputAction _action,
+                                    core::TickClock::time_point _time)
+{
+    auto& eventQueue = m_keyboardKeyEvents[static_cast<uint32_t>(_key)];
+
+    const auto lastEvent = eventQueue.front().unwrap();
 
-        const bool wasDown = utils::hasFlag(lastEvent.state, ActionableState::press) ||
-                             utils::hasFlag(lastEvent.state, ActionableState::hold);
+    const bool wasDown = utils::hasFlag(lastEvent.state, ActionableState::press) ||
+                         utils::hasFlag(lastEvent.state, ActionableState::hold);
 
-        auto timeSinceLastEvent = std::chrono::duration_cast<std::chrono::milliseconds>(
-            currentTime - lastEvent.metadata.timestamp);
+    auto timeSinceLastEvent = std::chrono::duration_cast<std::chrono::milliseconds>(
+        _time - lastEvent.metadata.timestamp);
 
-        KeyboardKeyEvent currEvent;
+    KeyboardKeyEvent currEvent;
 
-        if (action == InputAction::press)
+    if (_action == InputAction::press)
+    {
+        if (wasDown)
         {
-            if (wasDown)
+            if (utils::hasFlag(lastEvent.state, ActionableState::press) &&
+                timeSinceLastEvent >= k_keyHoldMinDuration)
             {
-                if (utils::hasFlag(lastEvent.state, ActionableState::press) &&
-                    timeSinceLastEvent >= k_keyHoldMinDuration)
-                {
-                    currEvent = KeyboardKeyEvent{
-                        ActionableState::hold,
-                        lastEvent.metadata.timestamp, // Keep original press timestamp
-                        m_pollCount,
-                        timeSinceLastEvent, // Duration since press
-                    };
-
-                    eventQueue.push(currEvent);
-                }
-                else if (utils::hasFlag(lastEvent.state, ActionableState::hold))
-                {
-                    auto totalHoldDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                        currentTime - lastEvent.metadata.timestamp);
-
-                    currEvent = KeyboardKeyEvent{
-                        ActionableState::hold,
-                        lastEvent.metadata.timestamp, // Keep original press timestamp
-                        m_pollCount,
-                        totalHoldDuration, // Total duration since press
-                    };
-
-                    eventQueue.push(currEvent);
-                }
+                currEvent = KeyboardKeyEvent{
+                    ActionableState::hold,
+                    lastEvent.metadata.timestamp, // Keep original press timestamp
+                    m_pollCount,
+                    timeSinceLastEvent, // Duration since press
+                };
+
+                eventQueue.push(currEvent);
             }
-            else
+            else if (utils::hasFlag(lastEvent.state, ActionableState::hold))
             {
-                if (utils::hasFlag(lastEvent.state, ActionableState::release) &&
-                    timeSinceLastEvent >= k_doubleClickMinInterval &&
-                    timeSinceLastEvent <= k_doubleClickMaxInterval)
-                {
-                    currEvent = KeyboardKeyEvent{
-                        ActionableState::press | ActionableState::double_press, currentTime,
-                        m_pollCount,
-                        std::chrono::milliseconds(0), // Press is instantaneous
-                    };
-                }
-                else
-                {
-                    currEvent = KeyboardKeyEvent{
-                        ActionableState::press, currentTime, m_pollCount,
-                        std::chrono::milliseconds(0), // Press is instantaneous
-                    };
-                }
+                auto totalHoldDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    _time - lastEvent.metadata.timestamp);
+
+                currEvent = KeyboardKeyEvent{
+                    ActionableState::hold,
+                    lastEvent.metadata.timestamp, // Keep original press timestamp
+                    m_pollCount,
+                    totalHoldDuration, // Total duration since press
+                };
 
                 eventQueue.push(currEvent);
             }
         }
-        else if (action == InputAction::release)
+        else
         {
-            if (wasDown)
+            if (utils::hasFlag(lastEvent.state, ActionableState::release) &&
+                timeSinceLastEvent >= k_doubleClickMinInterval &&
+                timeSinceLastEvent <= k_doubleClickMaxInterval)
+            {
+                currEvent = KeyboardKeyEvent{
+                    ActionableState::press | ActionableState::double_press, _time,
+                    m_pollCount,
+                    std::chrono::milliseconds(0), // Press is instantaneous
+                };
+            }
+            else
             {
-                auto totalPressDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    currentTime - lastEvent.metadata.timestamp);
-
-                if (totalPressDuration >= k_keyReleaseDuration)
-                {
-                    currEvent = KeyboardKeyEvent{
-                        ActionableState::release, currentTime, m_pollCount,
-                        totalPressDuration, // Duration from press to release
-                    };
-
-                    eventQueue.push(currEvent);
-                }
+                currEvent = KeyboardKeyEvent{
+                    ActionableState::press, _time, m_pollCount,
+                    std::chrono::milliseconds(0), // Press is instantaneous
+                };
+            }
+
+            eventQueue.push(currEvent);
+            consumeInput(_time);
+        }
+    }
+    else if (_action == InputAction::release)
+    {
+        if (wasDown)
+        {
+            auto totalPressDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                _time - lastEvent.metadata.timestamp);
+
+            if (totalPressDuration >= k_keyReleaseDuration)
+            {
+                currEvent = KeyboardKeyEvent{
+                    ActionableState::release, _time, m_pollCount,
+                    totalPressDuration, // Duration from press to release
+                };
+
+                eventQueue.push(currEvent);
+                consumeInput(_time);
             }
         }
     }
@@ -1,5 +1,10 @@
 #include "mosaic/input/sources/mouse_input_source.hpp"
 
+#include "mosaic/input/input_recording.hpp"
+
+#include <cmath>
+#include <utility>
+
 #if defined(MOSAIC_PLATFORM_DESKTOP) || defined(MOSAIC_PLATFORM_WEB)
 #include "platform/GLFW/glfw_mouse_input_source.hpp"
 #endif
@@ -11,16 +16,50 @@ namespace mosaic
 namespace input
 {
 
+namespace
+{
+
+using SampleTime = int64_t;
+
+constexpr SampleTime k_samplingPeriod =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(k_inputSamplingRate).count();
+constexpr float k_smoothingTime = std::chrono::duration<float>(k_motionSmoothingTime).count();
+
+// The events are stamped with the tick clock, whose time points are already on the epoch of the
+// steady clock
+SampleTime toSampleTime(core::TickClock::time_point _time)
+{
+    return _time.time_since_epoch().count();
+}
+
+// The velocity measured over the last _dt seconds, weighted by how much of the smoothing time
+// it covers so that the estimates do not depend on the sampling rate
+void updateMotionStats(glm::vec2& _velocity, glm::vec2& _acceleration, const glm::vec2& _measured,
+                       float _dt)
+{
+    const float alpha = 1.0f - std::exp(-_dt / k_smoothingTime);
+    const glm::vec2 velocity = _velocity + (_measured - _velocity) * alpha;
+
+    _acceleration += ((velocity - _velocity) / _dt - _acceleration) * alpha;
+    _velocity = velocity;
+}
+
+} // namespace
+
 MouseInputSource::MouseInputSource(window::Window* _window)
     : InputSource(_window),
+      m_wheelOffsetSum(0.f),
       m_wheelOffset(0.f),
       m_wheelDelta(0.f),
       m_cursorPosition(0.f),
       m_cursorDelta(0.f),
       m_wheelSensitivity(1.0f),
-      m_cursorSensitivity(1.0f)
+      m_cursorSensitivity(1.0f),
+      m_rawWheelOffset(0.f),
+      m_rawCursorPosition(0.f),
+      m_hasRawCursorPosition(false)
 {
-    auto currentTime = std::chrono::high_resolution_clock::now();
+    auto currentTime = core::TickClock::now();
 
     MouseButtonEvent dummyButtonEvent = {
         ActionableState::none,
@@ -37,12 +76,14 @@ MouseInputSource::MouseInputSource(window::Window* _window)
     m_mouseScrollEvents.push(MouseWheelScrollEvent(glm::vec2(0.f), glm::vec2(0.f), currentTime,
                                                    m_pollCount, InputEventType::none));
 
-    m_mouseScrollWheelSamples.push(MouseWheelScrollSample(glm::vec2(0.f), currentTime));
+    const SampleTime sampleTime = toSampleTime(currentTime);
+
+    m_mouseScrollWheelSamples.push(MouseWheelScrollSample(glm::vec2(0.f), sampleTime));
 
     m_cursorMoveEvents.push(MouseCursorMoveEvent(glm::vec2(0.f), glm::vec2(0.f), currentTime,
                                                  m_pollCount, InputEventType::none));
 
-    m_cursorPosSamples.push(MouseCursorPosSample(glm::vec2(0.f), currentTime));
+    m_cursorPosSamples.push(MouseCursorPosSample(glm::vec2(0.f), sampleTime));
 };
 
 std::unique_ptr<MouseInputSource> MouseInputSource::create(window::Window* _window)
@@ -56,127 +97,63 @@ std::unique_ptr<MouseInputSource> MouseInputSource::create(window::Window* _wind
 
 void MouseInputSource::processInput()
 {
-    auto currentTime = std::chrono::high_resolution_clock::now();
+    const auto currentTime = now();
+    const SampleTime sampleTime = toSampleTime(currentTime);
+
+    if (m_recorder) m_recorder->recordActive(InputRecordSource::mouse, isActive());
 
     if (!isActive())
     {
-        m_cursorPosSamples.push(MouseCursorPosSample(glm::vec2(0.f), currentTime));
-        m_mouseScrollWheelSamples.push(MouseWheelScrollSample(glm::vec2(0.f), currentTime));
+        // Still, the estimates decay
+        sampleCursor(m_cursorPosition, sampleTime);
+        sampleWheel(glm::vec2(0.0f), sampleTime);
+
+        // Unfocused, the events queued meanwhile are dropped
+        drainRawEvents([](const RawInputEvent&) {});
+        m_rawWheelOffset = glm::vec2(0.0f);
 
         return;
     }
 
     pollDevice();
 
-    // Fixed mouse button processing
+    // The events captured since the last call first, at the time they happened
+    m_hasRawCursorPosition = false;
+    drainRawEvents(
+        [this](const RawInputEvent& _event)
+        {
+            if (m_recorder && _event.type != RawInputEventType::key)
+            {
+                m_recorder->recordRawEvent(_event);
+            }
+
+            if (_event.type != RawInputEventType::key) consumeInput(_event.timestamp);
+            applyRawEvent(_event);
+        });
+
     for (const auto& button : c_mouseButtons)
     {
         const InputAction action = queryButtonState(button);
-        auto& eventQueue = m_mouseButtonEvents[static_cast<uint32_t>(button)];
-
-        const auto lastEvent = eventQueue.front().unwrap();
+        if (m_recorder) m_recorder->recordButton(button, action);
 
-        const bool wasDown = utils::hasFlag(lastEvent.state, ActionableState::press) ||
-                             utils::hasFlag(lastEvent.state, ActionableState::hold);
-
-        auto timeSinceLastEvent = std::chrono::duration_cast<std::chrono::milliseconds>(
-            currentTime - lastEvent.metadata.timestamp);
+        updateButton(button, action, currentTime);
+    }
 
-        MouseButtonEvent currEvent;
+    {
+        glm::vec2 pos = m_rawCursorPosition;
 
-        if (action == InputAction::press)
+        if (!m_hasRawCursorPosition)
         {
-            if (wasDown)
-            {
-                if (utils::hasFlag(lastEvent.state, ActionableState::press) &&
-                    timeSinceLastEvent >= k_keyHoldMinDuration)
-                {
-                    currEvent = MouseButtonEvent{
-                        ActionableState::hold,
-                        lastEvent.metadata.timestamp, // Keep original press timestamp
-                        m_pollCount,
-                        timeSinceLastEvent, // Duration since press
-                    };
-
-                    eventQueue.push(currEvent);
-                }
-                else if (utils::hasFlag(lastEvent.state, ActionableState::hold))
-                {
-                    auto totalHoldDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                        currentTime - lastEvent.metadata.timestamp + lastEvent.metadata.duration);
-
-                    currEvent = MouseButtonEvent{
-                        ActionableState::hold,
-                        lastEvent.metadata.timestamp, // Keep original press timestamp
-                        m_pollCount,
-                        totalHoldDuration, // Total duration since press
-                    };
-
-                    eventQueue.push(currEvent);
-                }
-            }
-            else
-            {
-                if (utils::hasFlag(lastEvent.state, ActionableState::release) &&
-                    timeSinceLastEvent >= k_doubleClickMinInterval &&
-                    timeSinceLastEvent <= k_doubleClickMaxInterval)
-                {
-                    currEvent = MouseButtonEvent{
-                        ActionableState::press | ActionableState::double_press,
-                        currentTime,
-                        m_pollCount,
-                        std::chrono::milliseconds(0), // Press is instantaneous
-                    };
-                }
-                else
-                {
-                    currEvent = MouseButtonEvent{
-                        ActionableState::press,
-                        currentTime,
-                        m_pollCount,
-                        std::chrono::milliseconds(0), // Press is instantaneous
-                    };
-                }
+            pos = queryCursorPosition();
+            if (m_recorder) m_recorder->recordCursor(pos);
 
-                eventQueue.push(currEvent);
-            }
-        }
-        else if (action == InputAction::release)
-        {
-            if (wasDown)
-            {
-                auto totalPressDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    currentTime - lastEvent.metadata.timestamp);
-
-                if (totalPressDuration >= k_keyReleaseDuration)
-                {
-                    currEvent = MouseButtonEvent{
-                        ActionableState::release,
-                        currentTime,
-                        m_pollCount,
-                        totalPressDuration, // Duration from press to release
-                    };
-
-                    eventQueue.push(currEvent);
-                }
-            }
+            if (pos != m_cursorPosition) consumeInput(currentTime);
         }
-    }
-
-    {
-        const auto& pos = queryCursorPosition();
 
         m_cursorDelta = pos - m_cursorPosition;
         m_cursorPosition = pos;
 
-        const auto lastSample = m_cursorPosSamples.back().unwrap();
-
-        if (currentTime - lastSample.timestamp > k_inputSamplingRate)
-        {
-            MouseCursorPosSample sample(pos, currentTime);
-
-            m_cursorPosSamples.push(sample);
-        }
+        sampleCursor(pos, sampleTime);
 
         const auto lastEvent = m_cursorMoveEvents.back().unwrap();
 
@@ -201,19 +178,16 @@ void MouseInputSource::processInput()
     }
 
     {
-        const auto& offset = queryWheelOffset();
+        const glm::vec2 polledOffset = queryWheelOffset();
+        if (m_recorder) m_recorder->recordScroll(polledOffset);
+        if (polledOffset != glm::vec2(0.0f)) consumeInput(currentTime);
+
+        const glm::vec2 offset = polledOffset + std::exchange(m_rawWheelOffset, glm::vec2(0.0f));
 
         m_wheelDelta = offset - m_wheelOffset;
         m_wheelOffset = offset;
 
-        const auto lastSample = m_mouseScrollWheelSamples.back().unwrap();
-
-        if (currentTime - lastSample.timestamp > k_inputSamplingRate)
-        {
-            MouseWheelScrollSample sample(glm::vec2(offset), currentTime);
-
-            m_mouseScrollWheelSamples.push(sample);
-        }
+        sampleWheel(offset, sampleTime);
 
         const auto lastEvent = m_mouseScrollEvents.back().unwrap();
 
@@ -238,89 +212,199 @@ void MouseInputSource::processInput()
     }
 }
 
-const glm::vec2 MouseInputSource::getAveragedWheelDeltas() const
+void MouseInputSource::updateButton(MouseButton _button, InputAction _action,
+                                    core::TickClock::time_point _time)
 {
-    if (m_mouseScrollWheelSamples.empty()) return {0.0, 0.0};
+    auto& eventQueue = m_mouseButtonEvents[static_cast<uint32_t>(_button)];
+
+    const auto lastEvent = eventQueue.front().unwrap();
+
+    const bool wasDown = utils::hasFlag(lastEvent.state, ActionableState::press) ||
+                         utils::hasFlag(lastEvent.state, ActionableState::hold);
+
+    auto timeSinceLastEvent = std::chrono::duration_cast<std::chrono::milliseconds>(
+        _time - lastEvent.metadata.timestamp);
+
+    MouseButtonEvent currEvent;
+
+    if (_action == InputAction::press)
+    {
+        if (wasDown)
+        {
+            if (utils::hasFlag(lastEvent.state, ActionableState::press) &&
+                timeSinceLastEvent >= k_keyHoldMinDuration)
+            {
+                currEvent = MouseButtonEvent{
+                    ActionableState::hold,
+                    lastEvent.metadata.timestamp, // Keep original press timestamp
+                    m_pollCount,
+                    timeSinceLastEvent, // Duration since press
+                };
+
+                eventQueue.push(currEvent);
+            }
+            else if (utils::hasFlag(lastEvent.state, ActionableState::hold))
+            {
+                auto totalHoldDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    _time - lastEvent.metadata.timestamp + lastEvent.metadata.duration);
 
-    double xSum = 0.0;
-    double ySum = 0.0;
+                currEvent = MouseButtonEvent{
+                    ActionableState::hold,
+                    lastEvent.metadata.timestamp, // Keep original press timestamp
+                    m_pollCount,
+                    totalHoldDuration, // Total duration since press
+                };
 
-    glm::vec2 sum(0.f);
+                eventQueue.push(currEvent);
+            }
+        }
+        else
+        {
+            if (utils::hasFlag(lastEvent.state, ActionableState::release) &&
+                timeSinceLastEvent >= k_doubleClickMinInterval &&
+                timeSinceLastEvent <= k_doubleClickMaxInterval)
+            {
+                currEvent = MouseButtonEvent{
+                    ActionableState::press | ActionableState::double_press,
+                    _time,
+                    m_pollCount,
+                    std::chrono::milliseconds(0), // Press is instantaneous
+                };
+            }
+            else
+            {
+                currEvent = MouseButtonEvent{
+                    ActionableState::press,
+                    _time,
+                    m_pollCount,
+                    std::chrono::milliseconds(0), // Press is instantaneous
+                };
+            }
 
-    for (size_t i = 0; i < m_mouseScrollWheelSamples.size(); ++i)
+            eventQueue.push(currEvent);
+            consumeInput(_time);
+        }
+    }
+    else if (_action == InputAction::release)
     {
-        // Offset is already a delta as wheel can scroll inifinitely
-        sum += m_mouseScrollWheelSamples[i].offset;
+        if (wasDown)
+        {
+            auto totalPressDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                _time - lastEvent.metadata.timestamp);
+
+            if (totalPressDuration >= k_keyReleaseDuration)
+            {
+                currEvent = MouseButtonEvent{
+                    ActionableState::release,
+                    _time,
+                    m_pollCount,
+                    totalPressDuration, // Duration from press to release
+                };
+
+                eventQueue.push(currEvent);
+                consumeInput(_time);
+            }
+        }
     }
+}
 
-    glm::vec2 averaged = sum / static_cast<float>(m_mouseScrollWheelSamples.size());
+glm::vec2 MouseInputSource::queryWheelOffset() { return glm::vec2(0.0f); }
 
-    return averaged * m_wheelSensitivity;
+void MouseInputSource::applyRawEvent(const RawInputEvent& _event)
+{
+    switch (_event.type)
+    {
+        case RawInputEventType::button:
+            if (_event.code < m_mouseButtonEvents.size())
+            {
+                updateButton(static_cast<MouseButton>(_event.code),
+                             _event.pressed ? InputAction::press : InputAction::release,
+                             _event.timestamp);
+            }
+            break;
+        case RawInputEventType::cursor:
+            // Sampled at the rate of the device, not at the one of the frames
+            sampleCursor(_event.value, toSampleTime(_event.timestamp));
+
+            m_rawCursorPosition = _event.value;
+            m_hasRawCursorPosition = true;
+            break;
+        case RawInputEventType::scroll:
+            m_rawWheelOffset += _event.value;
+            break;
+        case RawInputEventType::key:
+            break;
+    }
 }
 
-const glm::vec2 MouseInputSource::getWheelSpeed() const
+void MouseInputSource::sampleCursor(const glm::vec2& _position, SampleTime _time)
 {
-    if (m_mouseScrollWheelSamples.empty()) return {0.0, 0.0};
+    const MouseCursorPosSample last = m_cursorPosSamples.front().unwrap();
+    if (_time - last.timestamp <= k_samplingPeriod) return;
+
+    const float dt = float(_time - last.timestamp) * 1e-9f;
+    updateMotionStats(m_cursorStats.velocity, m_cursorStats.acceleration,
+                      (_position - last.position) / dt, dt);
+
+    m_cursorPosSamples.push(MouseCursorPosSample(_position, _time));
+}
 
-    auto oldestTime = m_mouseScrollWheelSamples.front().unwrap().timestamp;
-    auto newestTime = m_mouseScrollWheelSamples.back().unwrap().timestamp;
-    auto timeSpan = std::chrono::duration<float>(newestTime - oldestTime).count();
+void MouseInputSource::sampleWheel(const glm::vec2& _offset, SampleTime _time)
+{
+    const MouseWheelScrollSample last = m_mouseScrollWheelSamples.front().unwrap();
+    if (_time - last.timestamp <= k_samplingPeriod) return;
 
-    if (timeSpan == 0) return {0.0, 0.0};
+    // Offset is already a delta as wheel can scroll inifinitely
+    const float dt = float(_time - last.timestamp) * 1e-9f;
+    updateMotionStats(m_wheelStats.velocity, m_wheelStats.acceleration, _offset / dt, dt);
 
-    glm::vec2 averaged = getAveragedWheelDeltas(); // already scaled by sensitivity
+    // The oldest sample is overwritten
+    if (m_mouseScrollWheelSamples.size() == m_mouseScrollWheelSamples.capacity())
+    {
+        m_wheelOffsetSum -= m_mouseScrollWheelSamples.back().unwrap().offset;
+    }
 
-    return averaged / timeSpan;
+    m_wheelOffsetSum += _offset;
+    m_mouseScrollWheelSamples.push(MouseWheelScrollSample(_offset, _time));
 }
 
-const glm::vec2 MouseInputSource::getWheelAcceleration() const
+const glm::vec2 MouseInputSource::getAveragedWheelDeltas() const
 {
-    if (m_mouseScrollWheelSamples.empty()) return glm::vec2(0.f);
+    if (m_mouseScrollWheelSamples.empty()) return {0.0, 0.0};
 
-    auto oldestTime = m_mouseScrollWheelSamples.front().unwrap().timestamp;
-    auto newestTime = m_mouseScrollWheelSamples.back().unwrap().timestamp;
-    auto timeSpan = std::chrono::duration<float>(newestTime - oldestTime).count();
+    const glm::vec2 averaged =
+        m_wheelOffsetSum / static_cast<float>(m_mouseScrollWheelSamples.size());
 
-    if (timeSpan == 0) return glm::vec2(0.f);
+    return averaged * m_wheelSensitivity;
+}
 
-    glm::vec2 speed = getWheelSpeed(); // already scaled appropriately
+const glm::vec2 MouseInputSource::getWheelSpeed() const
+{
+    return m_wheelStats.velocity * m_wheelSensitivity;
+}
 
-    return speed / timeSpan;
+const glm::vec2 MouseInputSource::getWheelAcceleration() const
+{
+    return m_wheelStats.acceleration * m_wheelSensitivity;
 }
 
 const glm::vec2 MouseInputSource::getAveragedCursorDeltas() const
 {
-    if (m_cursorPosSamples.empty()) return glm::vec2(0.f);
+    if (m_cursorPosSamples.size() < 2) return glm::vec2(0.f);
 
-    glm::vec2 lastPos(0.f);
-    glm::vec2 sum(0.f);
+    // The deltas between the samples sum up to the one between the newest and the oldest
+    const glm::vec2 newest = m_cursorPosSamples.front().unwrap().position;
+    const glm::vec2 oldest = m_cursorPosSamples.back().unwrap().position;
 
-    for (size_t i = 0; i < m_cursorPosSamples.size(); ++i)
-    {
-        const auto currPos = m_cursorPosSamples[i].position;
-
-        lastPos = currPos;
-        sum += currPos - lastPos;
-    }
-
-    glm::vec2 averaged = sum / static_cast<float>(m_cursorPosSamples.size());
+    const glm::vec2 averaged =
+        (newest - oldest) / static_cast<float>(m_cursorPosSamples.size() - 1);
 
     return averaged * m_cursorSensitivity;
 }
 
 const glm::vec2 MouseInputSource::getCursorSpeed() const
 {
-    if (m_cursorPosSamples.empty()) return glm::vec2(0.f);
-
-    auto oldestTime = m_cursorPosSamples.front().unwrap().timestamp;
-    auto newestTime = m_cursorPosSamples.back().unwrap().timestamp;
-    auto timeSpan = std::chrono::duration<float>(newestTime - oldestTime).count();
-
-    if (timeSpan == 0) return glm::vec2(0.f);
-
-    glm::vec2 averaged = getAveragedCursorDeltas(); // already scaled by sensitivity
-
-    return averaged / timeSpan;
+    return m_cursorStats.velocity * m_cursorSensitivity;
 };
 
 double MouseInputSource::getCursorLinearSpeed() const
@@ -330,17 +414,7 @@ double MouseInputSource::getCursorLinearSpeed() const
 
 const glm::vec2 MouseInputSource::getCursorAcceleration() const
 {
-    if (m_cursorPosSamples.empty()) return glm::vec2(0.f);
-
-    auto oldestTime = m_cursorPosSamples.front().unwrap().timestamp;
-    auto newestTime = m_cursorPosSamples.back().unwrap().timestamp;
-    auto timeSpan = std::chrono::duration<float>(newestTime - oldestTime).count();
-
-    if (timeSpan == 0) return glm::vec2(0.f);
-
-    const glm::vec2 speed = getCursorSpeed(); // already scaled by sensitivity
-
-    return speed / timeSpan;
+    return m_cursorStats.acceleration * m_cursorSensitivity;
 }
 
 double MouseInputSource::getCursorLinearAcceleration() const
@@ -0,0 +1,225 @@
+#include "mosaic/input/sources/replay_input_sources.hpp"
+
+namespace mosaic
+{
+namespace input
+{
+
+namespace
+{
+
+// When a raw record happened, its age before the frame
+core::TickClock::time_point getRecordTime(const InputReplay& _replay, const InputRecord& _record)
+{
+    return _replay.getFrameTime() -
+           std::chrono::duration_cast<core::TickClock::duration>(_record.age);
+}
+
+bool isActiveRecord(const InputRecord& _record, InputRecordSource _source)
+{
+    return _record.type == InputRecordType::active &&
+           _record.code == static_cast<uint32_t>(_source);
+}
+
+} // namespace
+
+ReplayMouseInputSource::ReplayMouseInputSource(window::Window* _window,
+                                               const InputReplay* _replay)
+    : MouseInputSource(_window), m_replay(_replay), m_cursor(0.0f), m_wheelOffset(0.0f)
+{
+    m_buttons.fill(InputAction::release);
+}
+
+pieces::RefResult<InputSource, std::string> ReplayMouseInputSource::initialize()
+{
+    // Until the recording says otherwise
+    m_isActive = true;
+
+    return pieces::OkRef<InputSource, std::string>(*this);
+}
+
+void ReplayMouseInputSource::processInput()
+{
+    m_wheelOffset = glm::vec2(0.0f);
+
+    for (const InputRecord& record : m_replay->getRecords())
+    {
+        if (isActiveRecord(record, InputRecordSource::mouse)) m_isActive = record.state != 0;
+
+        switch (record.type)
+        {
+            case InputRecordType::button:
+                if (record.code >= m_buttons.size()) break;
+
+                if (record.raw)
+                {
+                    pushRawEvent(RawInputEvent(RawInputEventType::button, record.code,
+                                               record.state != 0,
+                                               getRecordTime(*m_replay, record)));
+                }
+                else
+                {
+                    m_buttons[record.code] = static_cast<InputAction>(record.state);
+                }
+                break;
+            case InputRecordType::cursor:
+                if (record.raw)
+                {
+                    pushRawEvent(RawInputEvent(RawInputEventType::cursor, record.value,
+                                               getRecordTime(*m_replay, record)));
+                }
+                else
+                {
+                    m_cursor = record.value;
+                }
+                break;
+            case InputRecordType::scroll:
+                if (record.raw)
+                {
+                    pushRawEvent(RawInputEvent(RawInputEventType::scroll, record.value,
+                                               getRecordTime(*m_replay, record)));
+                }
+                else
+                {
+                    m_wheelOffset += record.value;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    MouseInputSource::processInput();
+}
+
+InputAction ReplayMouseInputSource::queryButtonState(MouseButton _button) const
+{
+    const auto code = static_cast<uint32_t>(_button);
+    return code < m_buttons.size() ? m_buttons[code] : InputAction::release;
+}
+
+ReplayKeyboardInputSource::ReplayKeyboardInputSource(window::Window* _window,
+                                                     const InputReplay* _replay)
+    : KeyboardInputSource(_window), m_replay(_replay)
+{
+    m_keys.fill(InputAction::release);
+}
+
+pieces::RefResult<InputSource, std::string> ReplayKeyboardInputSource::initialize()
+{
+    m_isActive = true;
+
+    return pieces::OkRef<InputSource, std::string>(*this);
+}
+
+void ReplayKeyboardInputSource::processInput()
+{
+    for (const InputRecord& record : m_replay->getRecords())
+    {
+        if (isActiveRecord(record, InputRecordSource::keyboard)) m_isActive = record.state != 0;
+
+        if (record.type != InputRecordType::key || record.code >= m_keys.size()) continue;
+
+        if (record.raw)
+        {
+            pushRawEvent(RawInputEvent(RawInputEventType::key, record.code, record.state != 0,
+                                       getRecordTime(*m_replay, record)));
+        }
+        else
+        {
+            m_keys[record.code] = static_cast<InputAction>(record.state);
+        }
+    }
+
+    KeyboardInputSource::processInput();
+}
+
+InputAction ReplayKeyboardInputSource::queryKeyState(KeyboardKey _key) const
+{
+    const auto code = static_cast<uint32_t>(_key);
+    return code < m_keys.size() ? m_keys[code] : InputAction::release;
+}
+
+pieces::RefResult<InputSource, std::string> ReplayUnifiedTextInputSource::initialize()
+{
+    m_isActive = true;
+
+    return pieces::OkRef<InputSource, std::string>(*this);
+}
+
+void ReplayUnifiedTextInputSource::processInput()
+{
+    for (const InputRecord& record : m_replay->getRecords())
+    {
+        if (isActiveRecord(record, InputRecordSource::text)) m_isActive = record.state != 0;
+    }
+
+    UnifiedTextInputSource::processInput();
+}
+
+void ReplayUnifiedTextInputSource::setEnabled(bool _enabled)
+{
+    m_textInputEnabled = _enabled;
+
+    if (!_enabled)
+    {
+        m_isComposing = false;
+        m_currentComposition = IMEComposition();
+    }
+}
+
+void ReplayUnifiedTextInputSource::setInitialComposition(const std::string& _text, size_t _cursor)
+{
+    m_currentComposition.text = _text;
+    m_currentComposition.cursor = _cursor;
+}
+
+void ReplayUnifiedTextInputSource::queryPendingEvents(std::vector<TextInputEvent>& _outTextEvents,
+                                                      std::vector<IMEEvent>& _outIMEEvents)
+{
+    for (const InputRecord& record : m_replay->getRecords())
+    {
+        if (record.type == InputRecordType::text)
+        {
+            TextInputEvent& event = _outTextEvents.emplace_back(m_replay->getText(record.code));
+            event.metadata.pollCount = m_pollCount;
+        }
+        else if (record.type == InputRecordType::ime)
+        {
+            _outIMEEvents.push_back(m_replay->getIME(record.code));
+        }
+    }
+}
+
+pieces::RefResult<InputSource, std::string> ReplayTouchInputSource::initialize()
+{
+    m_isActive = true;
+
+    return pieces::OkRef<InputSource, std::string>(*this);
+}
+
+void ReplayTouchInputSource::pollDevice()
+{
+    ++m_pollCount;
+
+    for (const InputRecord& record : m_replay->getRecords())
+    {
+        if (record.type != InputRecordType::touch) continue;
+
+        addSample(TouchSample(int32_t(record.code), static_cast<TouchPhase>(record.state),
+                              record.value, record.pressure, getRecordTime(*m_replay, record)));
+    }
+}
+
+void ReplayTouchInputSource::processInput()
+{
+    for (const InputRecord& record : m_replay->getRecords())
+    {
+        if (isActiveRecord(record, InputRecordSource::touch)) m_isActive = record.state != 0;
+    }
+
+    TouchInputSource::processInput();
+}
+
+} // namespace input
+} // namespace mosaic
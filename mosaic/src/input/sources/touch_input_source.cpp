@@ -0,0 +1,176 @@
+#include "mosaic/input/sources/touch_input_source.hpp"
+
+#include "mosaic/input/input_recording.hpp"
+
+#include <cmath>
+#include <utility>
+
+#if defined(MOSAIC_PLATFORM_ANDROID)
+#include "platform/AGDK/agdk_touch_input_source.hpp"
+#endif
+
+namespace mosaic
+{
+namespace input
+{
+
+namespace
+{
+
+constexpr float k_smoothingTime = std::chrono::duration<float>(k_motionSmoothingTime).count();
+
+} // namespace
+
+TouchInputSource::TouchInputSource(window::Window* _window)
+    : InputSource(_window), m_pointerCount(0), m_droppedSampleCount(0)
+{
+}
+
+std::unique_ptr<TouchInputSource> TouchInputSource::create(window::Window* _window)
+{
+#if defined(MOSAIC_PLATFORM_ANDROID)
+    return std::make_unique<platform::agdk::AGDKTouchInputSource>(_window);
+#else
+    throw std::runtime_error("Touch input source not supported on this platform");
+#endif
+}
+
+void TouchInputSource::processInput()
+{
+    if (m_recorder) m_recorder->recordActive(InputRecordSource::touch, isActive());
+
+    // The pointers released during the last call leave, in order
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < m_pointerCount; ++i)
+    {
+        if (!m_pointers[i].isDown()) continue;
+        if (i != count) m_pointers[count] = std::move(m_pointers[i]);
+
+        ++count;
+    }
+
+    m_pointerCount = count;
+
+    for (uint32_t i = 0; i < m_pointerCount; ++i)
+    {
+        m_pointers[i].framePosition = m_pointers[i].position;
+        m_pointers[i].frameSampleCount = 0;
+    }
+
+    if (isActive())
+    {
+        pollDevice();
+    }
+    else
+    {
+        // Unfocused, the gestures in progress are lost
+        cancelPointers(now());
+    }
+
+    for (uint32_t i = 0; i < m_pointerCount; ++i)
+    {
+        m_pointers[i].delta = m_pointers[i].position - m_pointers[i].framePosition;
+    }
+}
+
+const TouchInputSource::Pointer* TouchInputSource::findPointer(int32_t _id) const
+{
+    for (uint32_t i = 0; i < m_pointerCount; ++i)
+    {
+        if (m_pointers[i].id == _id) return &m_pointers[i];
+    }
+
+    return nullptr;
+}
+
+const TouchInputSource::Pointer* TouchInputSource::getPrimaryPointer() const
+{
+    for (uint32_t i = 0; i < m_pointerCount; ++i)
+    {
+        if (m_pointers[i].isDown()) return &m_pointers[i];
+    }
+
+    return nullptr;
+}
+
+void TouchInputSource::addSample(const TouchSample& _sample)
+{
+    if (m_recorder) m_recorder->recordTouch(_sample);
+
+    consumeInput(_sample.timestamp);
+    applySample(_sample);
+}
+
+void TouchInputSource::cancelPointers(core::TickClock::time_point _time)
+{
+    for (uint32_t i = 0; i < m_pointerCount; ++i)
+    {
+        const Pointer& pointer = m_pointers[i];
+        if (!pointer.isDown()) continue;
+
+        applySample(TouchSample(pointer.id, TouchPhase::cancel, pointer.position, pointer.pressure,
+                                _time));
+    }
+}
+
+TouchInputSource::Pointer* TouchInputSource::findTrackedPointer(int32_t _id)
+{
+    return const_cast<Pointer*>(std::as_const(*this).findPointer(_id));
+}
+
+void TouchInputSource::applySample(const TouchSample& _sample)
+{
+    Pointer* pointer = findTrackedPointer(_sample.pointerId);
+    const bool ends = _sample.phase == TouchPhase::up || _sample.phase == TouchPhase::cancel;
+
+    if (!pointer || !pointer->isDown() || _sample.phase == TouchPhase::down)
+    {
+        // The end of a pointer never seen down, its down dropped, ends nothing
+        if (ends && (!pointer || !pointer->isDown())) return;
+
+        // A new pointer, or the id of one released earlier in the frame touching again
+        if (!pointer)
+        {
+            if (m_pointerCount == m_pointers.size())
+            {
+                ++m_droppedSampleCount;
+                return;
+            }
+
+            pointer = &m_pointers[m_pointerCount++];
+        }
+
+        pointer->id = _sample.pointerId;
+        pointer->startPosition = _sample.position;
+        pointer->framePosition = _sample.position;
+        pointer->velocity = glm::vec2(0.0f);
+        pointer->downTime = _sample.timestamp;
+        pointer->samples.clear();
+        pointer->frameSampleCount = 0;
+    }
+    else
+    {
+        // The velocity measured since the previous sample, weighted by how much of the smoothing
+        // time it covers so that the estimate does not depend on the rate of the digitizer
+        const float dt = std::chrono::duration<float>(_sample.timestamp - pointer->time).count();
+
+        if (dt > 0.0f)
+        {
+            const glm::vec2 measured = (_sample.position - pointer->position) / dt;
+            const float alpha = 1.0f - std::exp(-dt / k_smoothingTime);
+
+            pointer->velocity += (measured - pointer->velocity) * alpha;
+        }
+    }
+
+    pointer->phase = _sample.phase;
+    pointer->position = _sample.position;
+    pointer->pressure = _sample.pressure;
+    pointer->time = _sample.timestamp;
+
+    pointer->samples.push(_sample);
+    ++pointer->frameSampleCount;
+}
+
+} // namespace input
+} // namespace mosaic
@@ -1,6 +1,7 @@
 #include "mosaic/input/sources/unified_text_input_source.hpp"
 
 #include "mosaic/tools/logger.hpp"
+#include "mosaic/input/input_recording.hpp"
 
 #ifdef MOSAIC_PLATFORM_WINDOWS
 #include "platform/Win32/win32_unified_text_input_source.hpp"
@@ -23,6 +24,8 @@ std::unique_ptr<UnifiedTextInputSource> UnifiedTextInputSource::create(window::W
 
 void UnifiedTextInputSource::processInput()
 {
+    if (m_recorder) m_recorder->recordActive(InputRecordSource::text, isActive());
+
     if (!isActive())
     {
         return;
@@ -39,6 +42,16 @@ void UnifiedTextInputSource::processInput()
     std::vector<IMEEvent> imeEvents;
     queryPendingEvents(textEvents, imeEvents);
 
+    if (m_recorder)
+    {
+        for (const auto& event : textEvents) m_recorder->recordText(event);
+        for (const auto& event : imeEvents) m_recorder->recordIME(event);
+    }
+
+    // the IME events carry no time, they are as old as the poll
+    for (const auto& event : textEvents) consumeInput(event.metadata.timestamp);
+    if (!imeEvents.empty()) consumeInput(now());
+
     // Store the batched text event (should only be 0 or 1 element)
     if (!textEvents.empty()) m_lastTextEvent = textEvents.back();
 
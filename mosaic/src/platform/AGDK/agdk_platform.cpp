@@ -1,5 +1,7 @@
 #include "mosaic/platform/AGDK/agdk_platform.hpp"
 
+#include "mosaic/core/virtual_file_system.hpp"
+
 namespace mosaic
 {
 namespace platform
@@ -8,7 +10,8 @@ namespace agdk
 {
 
 AGDKPlatformContext::AGDKPlatformContext()
-    : m_activity(nullptr),
+    : m_app(nullptr),
+      m_activity(nullptr),
       m_assetManager(nullptr),
       m_currentWindow(nullptr),
       m_pendingWindow(nullptr),
@@ -19,6 +22,7 @@ void AGDKPlatformContext::setApp(android_app* _app)
 {
     if (_app)
     {
+        m_app = _app;
         m_activity = _app->activity;
         m_assetManager = _app->activity->assetManager;
         m_currentWindow = _app->window;
@@ -81,6 +85,10 @@ pieces::RefResult<core::Platform, std::string> AGDKPlatform::initialize()
         return pieces::ErrRef<core::Platform, std::string>("Platform context not available");
     }
 
+    // the APK assets at the root, before the systems read their files
+    auto context = static_cast<AGDKPlatformContext*>(getPlatformContext());
+    getApplication()->getFileSystem()->mountAssets("", context->getAssetManager());
+
     auto result = getApplication()->initialize();
 
     if (result.isErr())
@@ -1,5 +1,8 @@
 #include "agdk_sys_info.hpp"
 
+#include "platform/POSIX/posix_cpu_topology.hpp"
+#include "platform/POSIX/posix_process_memory.hpp"
+
 #include <unistd.h>
 #include <sys/statvfs.h>
 
@@ -67,6 +70,9 @@ core::CPUInfo AGDKSystemInfo::getCPUInfo()
 
     // We can confidently say that mobile CPUs do not support any AVX versions
 
+    // Android exposes the same sysfs topology as Linux, cpu_capacity tells big and LITTLE apart
+    info.processors = posix::sysfs::readCPUTopology();
+
     return info;
 }
 
@@ -140,6 +146,11 @@ std::vector<core::MonitorInfo> AGDKSystemInfo::getMonitors()
     return monitorsInfo;
 }
 
+void AGDKSystemInfo::queryProcessMemory(core::MemoryMetrics& _metrics)
+{
+    posix::procfs::readProcessMemory(_metrics);
+}
+
 } // namespace agdk
 } // namespace platform
 } // namespace mosaic
@@ -29,6 +29,8 @@ class AGDKSystemInfo : public core::SystemInfo::SystemInfoImpl
     std::vector<core::StorageDeviceInfo> getStorageDevices() override;
     core::LocaleInfo getLocaleInfo() override;
     std::vector<core::MonitorInfo> getMonitors() override;
+
+    void queryProcessMemory(core::MemoryMetrics& _metrics) override;
 };
 
 } // namespace agdk
@@ -0,0 +1,138 @@
+#include "agdk_sys_performance.hpp"
+
+#include <dlfcn.h>
+
+#include "mosaic/tools/logger.hpp"
+
+namespace mosaic
+{
+namespace platform
+{
+namespace agdk
+{
+
+// The forecast of AThermal_getThermalHeadroom, that of the ThermalState
+static constexpr int k_headroomForecastSeconds = 10;
+
+// The opaque types of android/thermal.h and android/performance_hint.h, not in every NDK
+using ThermalManager = void;
+using HintManager = void;
+using HintSession = void;
+
+struct AGDKSystemPerformance::Api
+{
+    void* library = nullptr;
+
+    ThermalManager* (*acquireThermalManager)() = nullptr;
+    void (*releaseThermalManager)(ThermalManager*) = nullptr;
+    int (*getCurrentThermalStatus)(ThermalManager*) = nullptr;
+    float (*getThermalHeadroom)(ThermalManager*, int) = nullptr;
+
+    HintManager* (*getHintManager)() = nullptr;
+    HintSession* (*createSession)(HintManager*, const int32_t*, size_t, int64_t) = nullptr;
+    void (*closeSession)(HintSession*) = nullptr;
+    int (*updateTargetWorkDuration)(HintSession*, int64_t) = nullptr;
+    int (*reportActualWorkDuration)(HintSession*, int64_t) = nullptr;
+
+    ThermalManager* thermalManager = nullptr;
+    HintManager* hintManager = nullptr;
+
+    template <typename Function>
+    void resolve(Function& _function, const char* _name)
+    {
+        _function = reinterpret_cast<Function>(::dlsym(library, _name));
+    }
+};
+
+AGDKSystemPerformance::AGDKSystemPerformance() : m_api(new Api())
+{
+    Api& api = *m_api;
+
+    api.library = ::dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+    if (!api.library)
+    {
+        MOSAIC_WARN("AGDKSystemPerformance: libandroid.so not loaded: {}", ::dlerror());
+        return;
+    }
+
+    api.resolve(api.acquireThermalManager, "AThermal_acquireManager");
+    api.resolve(api.releaseThermalManager, "AThermal_releaseManager");
+    api.resolve(api.getCurrentThermalStatus, "AThermal_getCurrentThermalStatus");
+    api.resolve(api.getThermalHeadroom, "AThermal_getThermalHeadroom");
+
+    api.resolve(api.getHintManager, "APerformanceHint_getManager");
+    api.resolve(api.createSession, "APerformanceHint_createSession");
+    api.resolve(api.closeSession, "APerformanceHint_closeSession");
+    api.resolve(api.updateTargetWorkDuration, "APerformanceHint_updateTargetWorkDuration");
+    api.resolve(api.reportActualWorkDuration, "APerformanceHint_reportActualWorkDuration");
+
+    if (api.acquireThermalManager && api.getCurrentThermalStatus)
+    {
+        api.thermalManager = api.acquireThermalManager();
+    }
+
+    // null where the device does not support the hints
+    if (api.getHintManager && api.createSession && api.closeSession &&
+        api.updateTargetWorkDuration && api.reportActualWorkDuration)
+    {
+        api.hintManager = api.getHintManager();
+    }
+}
+
+AGDKSystemPerformance::~AGDKSystemPerformance()
+{
+    if (m_api->thermalManager && m_api->releaseThermalManager)
+    {
+        m_api->releaseThermalManager(m_api->thermalManager);
+    }
+    if (m_api->library) ::dlclose(m_api->library);
+
+    delete m_api;
+}
+
+core::ThermalState AGDKSystemPerformance::getThermalState()
+{
+    core::ThermalState state;
+    if (!m_api->thermalManager) return state;
+
+    // ATHERMAL_STATUS_ERROR (-1) to ATHERMAL_STATUS_SHUTDOWN (6), one past the unknown status
+    const int status = m_api->getCurrentThermalStatus(m_api->thermalManager);
+    if (status >= 0 && status <= 6) state.status = static_cast<core::ThermalStatus>(status + 1);
+
+    // NaN when polled faster than once a second or unsupported by the device
+    if (m_api->getThermalHeadroom)
+    {
+        state.headroom =
+            m_api->getThermalHeadroom(m_api->thermalManager, k_headroomForecastSeconds);
+    }
+
+    return state;
+}
+
+void* AGDKSystemPerformance::createHintSession(std::span<const int32_t> _threadIds,
+                                               std::chrono::nanoseconds _target)
+{
+    if (!m_api->hintManager) return nullptr;
+
+    HintSession* session = m_api->createSession(m_api->hintManager, _threadIds.data(),
+                                                _threadIds.size(), _target.count());
+    if (!session) MOSAIC_WARN("AGDKSystemPerformance: the hint session was refused.");
+
+    return session;
+}
+
+void AGDKSystemPerformance::closeHintSession(void* _session) { m_api->closeSession(_session); }
+
+void AGDKSystemPerformance::updateTargetDuration(void* _session, std::chrono::nanoseconds _target)
+{
+    m_api->updateTargetWorkDuration(_session, _target.count());
+}
+
+void AGDKSystemPerformance::reportActualDuration(void* _session, std::chrono::nanoseconds _actual)
+{
+    m_api->reportActualWorkDuration(_session, _actual.count());
+}
+
+} // namespace agdk
+} // namespace platform
+} // namespace mosaic
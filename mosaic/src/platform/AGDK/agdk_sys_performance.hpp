@@ -0,0 +1,39 @@
+#pragma once
+
+#include "mosaic/core/sys_performance.hpp"
+
+namespace mosaic
+{
+namespace platform
+{
+namespace agdk
+{
+
+/**
+ * @brief The thermal manager (API 30, the headroom API 31) and the performance hint manager (API
+ * 33) of libandroid, resolved at runtime: the minimum SDK is older, the entry points missing on
+ * the devices that predate them leave the state unknown and the sessions invalid.
+ */
+class AGDKSystemPerformance : public core::SystemPerformance::SystemPerformanceImpl
+{
+   private:
+    struct Api;
+
+    Api* m_api;
+
+   public:
+    AGDKSystemPerformance();
+    ~AGDKSystemPerformance() override;
+
+    core::ThermalState getThermalState() override;
+
+    void* createHintSession(std::span<const int32_t> _threadIds,
+                            std::chrono::nanoseconds _target) override;
+    void closeHintSession(void* _session) override;
+    void updateTargetDuration(void* _session, std::chrono::nanoseconds _target) override;
+    void reportActualDuration(void* _session, std::chrono::nanoseconds _actual) override;
+};
+
+} // namespace agdk
+} // namespace platform
+} // namespace mosaic
@@ -2,6 +2,8 @@
 
 #include <game-activity/native_app_glue/android_native_app_glue.h>
 
+#include "mosaic/platform/AGDK/jni_bridge.hpp"
+
 namespace mosaic
 {
 namespace platform
@@ -15,7 +17,7 @@ std::optional<bool> AGDKSystemUI::showQuestionDialog(const std::string& _title,
 {
     auto* helper = JNIHelper::getInstance();
 
-    JNIEnv* env = helper->getEnv();
+    JNIEnv* env = JNIHelper::getThreadEnv();
     if (!env)
     {
         MOSAIC_ERROR("AGDKSystemUI::showQuestionDialog: JNI environment not available.");
@@ -27,10 +29,7 @@ std::optional<bool> AGDKSystemUI::showQuestionDialog(const std::string& _title,
     jboolean jAllowCancel = static_cast<jboolean>(_allowCancel);
 
     // See SystemUI.showQuestionDialog(String title, String message, boolean allowCancel)
-    jobject jResult = helper->callStaticMethod<jobject>(
-        "com/mosaic/engine_bridge/SystemUI", "showQuestionDialog",
-        "(Ljava/lang/String;Ljava/lang/String;Z)Ljava/lang/Boolean;", jTitle, jMessage,
-        jAllowCancel);
+    jobject jResult = bridge::SystemUI::showQuestionDialog(jTitle, jMessage, jAllowCancel);
 
     if (jTitle) env->DeleteLocalRef(jTitle);
     if (jMessage) env->DeleteLocalRef(jMessage);
@@ -51,7 +50,7 @@ void AGDKSystemUI::showInfoDialog(const std::string& _title, const std::string&
 {
     auto* helper = JNIHelper::getInstance();
 
-    JNIEnv* env = helper->getEnv();
+    JNIEnv* env = JNIHelper::getThreadEnv();
     if (!env)
     {
         MOSAIC_ERROR("AGDKSystemUI::showInfoDialog: JNI environment not available.");
@@ -62,8 +61,7 @@ void AGDKSystemUI::showInfoDialog(const std::string& _title, const std::string&
     jstring jMessage = helper->stringToJstring(_message);
 
     // See SystemUI.showInfoDialog(String title, String message)
-    helper->callStaticVoidMethod("com/mosaic/engine_bridge/SystemUI", "showInfoDialog",
-                                 "(Ljava/lang/String;Ljava/lang/String;)V", jTitle, jMessage);
+    bridge::SystemUI::showInfoDialog(jTitle, jMessage);
 
     if (jTitle) env->DeleteLocalRef(jTitle);
     if (jMessage) env->DeleteLocalRef(jMessage);
@@ -73,7 +71,7 @@ void AGDKSystemUI::showWarningDialog(const std::string& _title, const std::strin
 {
     auto* helper = JNIHelper::getInstance();
 
-    JNIEnv* env = helper->getEnv();
+    JNIEnv* env = JNIHelper::getThreadEnv();
     if (!env)
     {
         MOSAIC_ERROR("AGDKSystemUI::showWarningDialog: JNI environment not available.");
@@ -84,8 +82,7 @@ void AGDKSystemUI::showWarningDialog(const std::string& _title, const std::strin
     jstring jMessage = helper->stringToJstring(_message);
 
     // See SystemUI.showWarningDialog(String title, String message)
-    helper->callStaticVoidMethod("com/mosaic/engine_bridge/SystemUI", "showWarningDialog",
-                                 "(Ljava/lang/String;Ljava/lang/String;)V", jTitle, jMessage);
+    bridge::SystemUI::showWarningDialog(jTitle, jMessage);
 
     if (jTitle) env->DeleteLocalRef(jTitle);
     if (jMessage) env->DeleteLocalRef(jMessage);
@@ -95,7 +92,7 @@ void AGDKSystemUI::showErrorDialog(const std::string& _title, const std::string&
 {
     auto* helper = JNIHelper::getInstance();
 
-    JNIEnv* env = helper->getEnv();
+    JNIEnv* env = JNIHelper::getThreadEnv();
     if (!env)
     {
         MOSAIC_ERROR("AGDKSystemUI::showErrorDialog: JNI environment not available.");
@@ -106,8 +103,7 @@ void AGDKSystemUI::showErrorDialog(const std::string& _title, const std::string&
     jstring jMessage = helper->stringToJstring(_message);
 
     // See SystemUI.showErrorDialog(String title, String message)
-    helper->callStaticVoidMethod("com/mosaic/engine_bridge/SystemUI", "showErrorDialog",
-                                 "(Ljava/lang/String;Ljava/lang/String;)V", jTitle, jMessage);
+    bridge::SystemUI::showErrorDialog(jTitle, jMessage);
 
     if (jTitle) env->DeleteLocalRef(jTitle);
     if (jMessage) env->DeleteLocalRef(jMessage);
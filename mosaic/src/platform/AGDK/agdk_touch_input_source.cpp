@@ -0,0 +1,143 @@
+#include "agdk_touch_input_source.hpp"
+
+#include "mosaic/platform/AGDK/agdk_platform.hpp"
+
+namespace mosaic
+{
+namespace platform
+{
+namespace agdk
+{
+
+namespace
+{
+
+// The times of the events are nanoseconds of CLOCK_MONOTONIC, the steady clock of the NDK
+core::TickClock::time_point toTime(int64_t _nanoseconds)
+{
+    return core::TickClock::time_point(std::chrono::nanoseconds(_nanoseconds));
+}
+
+} // namespace
+
+AGDKTouchInputSource::AGDKTouchInputSource(window::Window* _window)
+    : input::TouchInputSource(_window), m_app(nullptr){};
+
+pieces::RefResult<input::InputSource, std::string> AGDKTouchInputSource::initialize()
+{
+    auto context =
+        static_cast<AGDKPlatformContext*>(AGDKPlatform::getInstance()->getPlatformContext());
+
+    m_app = context ? context->getApp() : nullptr;
+
+    if (!m_app)
+    {
+        return pieces::ErrRef<input::InputSource, std::string>(
+            "No GameActivity to read input from");
+    }
+
+    // The application updates only while resumed, with the focus
+    m_isActive = true;
+
+    return pieces::OkRef<input::InputSource, std::string>(*this);
+}
+
+void AGDKTouchInputSource::shutdown() { m_app = nullptr; }
+
+void AGDKTouchInputSource::pollDevice()
+{
+    ++m_pollCount;
+
+    // The glue fills the other buffer meanwhile; null when nothing came
+    android_input_buffer* buffer = android_app_swap_input_buffers(m_app);
+    if (!buffer) return;
+
+    for (uint64_t i = 0; i < buffer->motionEventsCount; ++i)
+    {
+        addMotionEvent(buffer->motionEvents[i]);
+    }
+
+    android_app_clear_motion_events(buffer);
+
+    // No source reads the keys on Android, left they would fill the buffer
+    android_app_clear_key_events(buffer);
+}
+
+void AGDKTouchInputSource::addMotionEvent(const GameActivityMotionEvent& _event)
+{
+    if ((_event.source & AINPUT_SOURCE_CLASS_MASK) != AINPUT_SOURCE_CLASS_POINTER) return;
+
+    const int32_t action = _event.action & AMOTION_EVENT_ACTION_MASK;
+    const uint32_t actionIndex =
+        uint32_t(_event.action & AMOTION_EVENT_ACTION_POINTER_INDEX_MASK) >>
+        AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT;
+
+    switch (action)
+    {
+        case AMOTION_EVENT_ACTION_DOWN:
+        case AMOTION_EVENT_ACTION_POINTER_DOWN:
+        case AMOTION_EVENT_ACTION_MOVE:
+        case AMOTION_EVENT_ACTION_UP:
+        case AMOTION_EVENT_ACTION_POINTER_UP:
+        case AMOTION_EVENT_ACTION_CANCEL:
+            break;
+        default:
+            return; // hover, scroll, outside: no pointer down
+    }
+
+    // The samples the digitizer took since the previous event first, every pointer moving
+    const int historySize = GameActivityMotionEvent_getHistorySize(&_event);
+
+    for (int h = 0; h < historySize; ++h)
+    {
+        const auto time = toTime(GameActivityMotionEvent_getHistoricalEventTimeNanos(&_event, h));
+
+        for (uint32_t p = 0; p < _event.pointerCount; ++p)
+        {
+            addSample(input::TouchSample(
+                _event.pointers[p].id, input::TouchPhase::move,
+                glm::vec2(GameActivityMotionEvent_getHistoricalX(&_event, int(p), h),
+                          GameActivityMotionEvent_getHistoricalY(&_event, int(p), h)),
+                GameActivityMotionEvent_getHistoricalAxisValue(&_event, AMOTION_EVENT_AXIS_PRESSURE,
+                                                               int(p), h),
+                time));
+        }
+    }
+
+    const auto time = toTime(_event.eventTime);
+
+    for (uint32_t p = 0; p < _event.pointerCount; ++p)
+    {
+        input::TouchPhase phase = input::TouchPhase::move;
+
+        switch (action)
+        {
+            case AMOTION_EVENT_ACTION_DOWN:
+            case AMOTION_EVENT_ACTION_POINTER_DOWN:
+                if (p == actionIndex) phase = input::TouchPhase::down;
+                break;
+            case AMOTION_EVENT_ACTION_UP:
+            case AMOTION_EVENT_ACTION_POINTER_UP:
+                if (p == actionIndex) phase = input::TouchPhase::up;
+                break;
+            case AMOTION_EVENT_ACTION_CANCEL:
+                phase = input::TouchPhase::cancel;
+                break;
+            default:
+                break;
+        }
+
+        const GameActivityPointerAxes& pointer = _event.pointers[p];
+
+        const glm::vec2 position(GameActivityPointerAxes_getX(&pointer),
+                                 GameActivityPointerAxes_getY(&pointer));
+
+        addSample(input::TouchSample(
+            pointer.id, phase, position,
+            GameActivityPointerAxes_getAxisValue(&pointer, AMOTION_EVENT_AXIS_PRESSURE), time));
+    }
+}
+
+} // namespace agdk
+} // namespace platform
+} // namespace mosaic
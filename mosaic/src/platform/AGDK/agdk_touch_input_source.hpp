@@ -0,0 +1,39 @@
+#pragma once
+
+#include "mosaic/input/sources/touch_input_source.hpp"
+
+#include <game-activity/native_app_glue/android_native_app_glue.h>
+
+namespace mosaic
+{
+namespace platform
+{
+namespace agdk
+{
+
+/**
+ * @brief The touch screen of a GameActivity: the motion events its glue buffered since the last
+ * frame, read once per `pollDevice()` with their historical samples.
+ */
+class AGDKTouchInputSource : public input::TouchInputSource
+{
+   private:
+    android_app* m_app;
+
+   public:
+    AGDKTouchInputSource(window::Window* _window);
+    ~AGDKTouchInputSource() override = default;
+
+   public:
+    pieces::RefResult<input::InputSource, std::string> initialize() override;
+    void shutdown() override;
+
+    void pollDevice() override;
+
+   private:
+    void addMotionEvent(const GameActivityMotionEvent& _event);
+};
+
+} // namespace agdk
+} // namespace platform
+} // namespace mosaic
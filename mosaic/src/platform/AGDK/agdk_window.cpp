@@ -1,5 +1,7 @@
 #include "agdk_window.hpp"
 
+#include "mosaic/platform/AGDK/jni_bridge.hpp"
+
 namespace mosaic
 {
 namespace platform
@@ -130,7 +132,7 @@ void AGDKWindow::setClipboardString([[maybe_unused]] const std::string& _string)
 {
     auto* helper = JNIHelper::getInstance();
 
-    JNIEnv* env = helper->getEnv();
+    JNIEnv* env = JNIHelper::getThreadEnv();
     if (!env)
     {
         MOSAIC_ERROR("AGDKWindow::setClipboardString: JNI environment is not available.");
@@ -140,8 +142,7 @@ void AGDKWindow::setClipboardString([[maybe_unused]] const std::string& _string)
     jstring jContent = helper->stringToJstring(_string);
 
     // See SystemServices.setClipboardString(String content)
-    helper->callStaticVoidMethod("com/mosaic/engine_bridge/SystemServices", "setClipboard",
-                                 "(Ljava/lang/String;)V", jContent);
+    bridge::SystemServices::setClipboard(jContent);
 
     if (jContent) env->DeleteLocalRef(jContent);
 }
@@ -150,15 +151,14 @@ std::string AGDKWindow::getClipboardString() const
 {
     auto* helper = JNIHelper::getInstance();
 
-    JNIEnv* env = helper->getEnv();
+    JNIEnv* env = JNIHelper::getThreadEnv();
     if (!env)
     {
         MOSAIC_ERROR("AGDKWindow::getClipboardString: JNI environment is not available.");
         return std::string();
     }
 
-    jstring jContent = helper->callStaticMethod<jstring>("com/mosaic/engine_bridge/SystemServices",
-                                                         "getClipboard", "()Ljava/lang/String;");
+    jstring jContent = bridge::SystemServices::getClipboard();
 
     if (!jContent)
     {
@@ -167,6 +167,7 @@ std::string AGDKWindow::getClipboardString() const
     }
 
     std::string content = helper->jstringToString(jContent);
+    env->DeleteLocalRef(jContent);
 
     return content;
 }
@@ -9,6 +9,8 @@ namespace agdk
 
 pieces::RefResult<core::System, std::string> AGDKWindowSystem::initialize()
 {
+    m_looper = ALooper_forThread();
+
     return pieces::OkRef<core::System, std::string>(*this);
 }
 
@@ -16,6 +18,11 @@ void AGDKWindowSystem::shutdown() { destroyAllWindows(); }
 
 pieces::RefResult<core::System, std::string> AGDKWindowSystem::update() {}
 
+void AGDKWindowSystem::wakeUp() noexcept
+{
+    if (m_looper) ALooper_wake(m_looper);
+}
+
 } // namespace agdk
 } // namespace platform
 } // namespace mosaic
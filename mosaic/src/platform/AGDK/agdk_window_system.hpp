@@ -2,6 +2,8 @@
 
 #include "mosaic/window/window_system.hpp"
 
+#include <android/looper.h>
+
 namespace mosaic
 {
 namespace platform
@@ -11,6 +13,9 @@ namespace agdk
 
 class AGDKWindowSystem : public window::WindowSystem
 {
+   private:
+    ALooper* m_looper = nullptr; // of the main thread, which android_main() polls
+
    public:
     ~AGDKWindowSystem() override = default;
 
@@ -19,6 +24,9 @@ class AGDKWindowSystem : public window::WindowSystem
     void shutdown() override;
 
     virtual pieces::RefResult<System, std::string> update() override;
+
+    // The poll of android_main() returns, see core::Application::getIdleWait()
+    void wakeUp() noexcept override;
 };
 
 } // namespace agdk
@@ -0,0 +1,57 @@
+// Auto-generated JNI bindings
+// Generated by jni_on_load_generator.py
+
+#include "mosaic/platform/AGDK/jni_bridge.hpp"
+
+#include <array>
+
+namespace mosaic
+{
+namespace platform
+{
+namespace agdk
+{
+namespace bridge
+{
+
+namespace SystemUI
+{
+JNIStaticMethod<jobject(jstring, jstring, jboolean)> showQuestionDialog{
+    "com/mosaic/engine_bridge/SystemUI", "showQuestionDialog",
+    "(Ljava/lang/String;Ljava/lang/String;Z)Ljava/lang/Boolean;"};
+JNIStaticMethod<void(jstring, jstring)> showInfoDialog{
+    "com/mosaic/engine_bridge/SystemUI", "showInfoDialog",
+    "(Ljava/lang/String;Ljava/lang/String;)V"};
+JNIStaticMethod<void(jstring, jstring)> showWarningDialog{
+    "com/mosaic/engine_bridge/SystemUI", "showWarningDialog",
+    "(Ljava/lang/String;Ljava/lang/String;)V"};
+JNIStaticMethod<void(jstring, jstring)> showErrorDialog{
+    "com/mosaic/engine_bridge/SystemUI", "showErrorDialog",
+    "(Ljava/lang/String;Ljava/lang/String;)V"};
+}
+
+namespace SystemServices
+{
+JNIStaticMethod<void(jstring)> setClipboard{
+    "com/mosaic/engine_bridge/SystemServices", "setClipboard",
+    "(Ljava/lang/String;)V"};
+JNIStaticMethod<jstring()> getClipboard{
+    "com/mosaic/engine_bridge/SystemServices", "getClipboard",
+    "()Ljava/lang/String;"};
+}
+
+static const std::array<JNIBinding*, 6> k_bindings = {
+    &SystemUI::showQuestionDialog,
+    &SystemUI::showInfoDialog,
+    &SystemUI::showWarningDialog,
+    &SystemUI::showErrorDialog,
+    &SystemServices::setClipboard,
+    &SystemServices::getClipboard,
+};
+
+std::span<JNIBinding* const> getBindings() { return k_bindings; }
+
+} // namespace bridge
+} // namespace agdk
+} // namespace platform
+} // namespace mosaic
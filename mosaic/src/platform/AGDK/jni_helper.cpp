@@ -1,4 +1,5 @@
 #include "mosaic/platform/AGDK/jni_helper.hpp"
+#include "mosaic/platform/AGDK/jni_bindings.hpp"
 
 namespace mosaic
 {
@@ -11,6 +12,20 @@ std::unique_ptr<JNIHelper> JNIHelper::m_instance = std::make_unique<JNIHelper>()
 
 thread_local JNIEnv* JNIHelper::m_tlsEnv = nullptr;
 
+// Detaches the thread attached by attachCurrentThread() when it exits, a thread that is never
+// detached keeps the VM from unloading
+struct ThreadDetacher
+{
+    JavaVM* vm = nullptr;
+
+    ~ThreadDetacher()
+    {
+        if (vm) vm->DetachCurrentThread();
+    }
+};
+
+static thread_local ThreadDetacher s_threadDetacher;
+
 pieces::RefResult<JNIHelper, std::string> JNIHelper::initialize(JavaVM* _vm)
 {
     if (m_initialized.load())
@@ -43,6 +58,9 @@ void JNIHelper::shutdown()
     {
         std::lock_guard<std::mutex> lock(m_cacheMutex);
 
+        for (JNIBinding* binding : m_bindings) binding->unbind();
+        m_bindings.clear();
+
         for (auto& pair : m_classCache)
         {
             if (pair.second)
@@ -108,6 +126,7 @@ JNIEnv* JNIHelper::attachCurrentThread()
     if (result == JNI_OK)
     {
         m_tlsEnv = env;
+        s_threadDetacher.vm = m_javaVM;
         MOSAIC_INFO("Thread attached successfully");
         return env;
     }
@@ -124,6 +143,7 @@ void JNIHelper::detachCurrentThread()
     {
         m_javaVM->DetachCurrentThread();
         m_tlsEnv = nullptr;
+        s_threadDetacher.vm = nullptr;
         MOSAIC_INFO("Thread detached");
     }
 }
@@ -290,6 +310,58 @@ jfieldID JNIHelper::getStaticFieldID(const std::string& _className, const std::s
     return field;
 }
 
+bool JNIHelper::bind(std::span<JNIBinding* const> _bindings)
+{
+    JNIEnv* env = getEnv();
+    if (!env) return false;
+
+    bool bound = true;
+
+    for (JNIBinding* binding : _bindings)
+    {
+        jclass clazz = findClass(binding->getClassName());
+        if (!clazz)
+        {
+            bound = false;
+            continue;
+        }
+
+        const char* name = binding->getName();
+        const char* signature = binding->getSignature();
+
+        switch (binding->getKind())
+        {
+            case JNIBinding::Kind::method:
+                binding->bindMethod(clazz, env->GetMethodID(clazz, name, signature));
+                break;
+            case JNIBinding::Kind::static_method:
+                binding->bindMethod(clazz, env->GetStaticMethodID(clazz, name, signature));
+                break;
+            case JNIBinding::Kind::field:
+                binding->bindField(clazz, env->GetFieldID(clazz, name, signature));
+                break;
+            case JNIBinding::Kind::static_field:
+                binding->bindField(clazz, env->GetStaticFieldID(clazz, name, signature));
+                break;
+        }
+
+        if (!binding->isBound())
+        {
+            MOSAIC_ERROR("Failed to bind {}.{}{}", binding->getClassName(), name, signature);
+            checkAndClearException();
+            bound = false;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        m_bindings.push_back(binding);
+    }
+
+    MOSAIC_INFO("Bound {} JNI members", m_bindings.size());
+
+    return bound;
+}
+
 bool JNIHelper::registerNativeMethods(const std::string& _className,
                                       const std::vector<NativeMethod>& _methods)
 {
@@ -327,17 +399,26 @@ bool JNIHelper::registerNativeMethods(const std::string& _className,
 
 std::string JNIHelper::jstringToString(jstring _jstr)
 {
-    if (!_jstr) return "";
+    std::string result;
+    jstringToString(_jstr, result);
 
-    JNIEnv* env = getEnv();
-    if (!env) return "";
+    return result;
+}
+
+void JNIHelper::jstringToString(jstring _jstr, std::string& _out)
+{
+    _out.clear();
+    if (!_jstr) return;
 
-    const char* chars = env->GetStringUTFChars(_jstr, nullptr);
-    if (!chars) return "";
+    JNIEnv* env = getThreadEnv();
+    if (!env) return;
 
-    std::string result(chars);
-    env->ReleaseStringUTFChars(_jstr, chars);
-    return result;
+    // copied straight into the string: no buffer of the VM to pin, allocate and release
+    const jsize length = env->GetStringLength(_jstr);
+    const jsize size = env->GetStringUTFLength(_jstr);
+
+    _out.resize(static_cast<size_t>(size));
+    env->GetStringUTFRegion(_jstr, 0, length, _out.data());
 }
 
 jstring JNIHelper::stringToJstring(const std::string& _str)
@@ -422,10 +503,15 @@ bool JNIHelper::checkAndClearException()
     JNIEnv* env = getEnv();
     if (!env) return false;
 
-    if (env->ExceptionCheck())
+    return clearException(env);
+}
+
+bool JNIHelper::clearException(JNIEnv* _env)
+{
+    if (_env->ExceptionCheck())
     {
-        env->ExceptionDescribe(); // Print to logcat
-        env->ExceptionClear();
+        _env->ExceptionDescribe(); // Print to logcat
+        _env->ExceptionClear();
         return true;
     }
     return false;
@@ -473,26 +559,18 @@ std::string JNIHelper::createCacheKey(const std::string& _className, const std::
 }
 
 // ThreadAttachment implementation
-JNIHelper::ThreadAttachment::ThreadAttachment() : m_env(nullptr), m_shouldDetach(false)
+JNIHelper::ThreadAttachment::ThreadAttachment() : m_env(nullptr)
 {
     auto helper = JNIHelper::getInstance();
 
     if (!helper->m_initialized.load()) return;
 
-    // Check if thread is already attached
-    jint result = helper->m_javaVM->GetEnv(reinterpret_cast<void**>(&m_env), JNI_VERSION_1_6);
-    if (result == JNI_EDETACHED)
-    {
-        // Need to attach
-        m_env = helper->attachCurrentThread();
-        m_shouldDetach = (m_env != nullptr);
-    }
+    // attached on the first call of the thread, detached when it exits
+    m_env = getThreadEnv();
 }
 
-JNIHelper::ThreadAttachment::~ThreadAttachment()
-{
-    if (m_shouldDetach && m_env) JNIHelper::getInstance()->detachCurrentThread();
-}
+// the thread stays attached, attaching it again for every scope costs more than the call
+JNIHelper::ThreadAttachment::~ThreadAttachment() = default;
 
 } // namespace agdk
 } // namespace platform
@@ -1,5 +1,7 @@
 #include "emscripten_platform.hpp"
 
+#include "mosaic/tools/logger.hpp"
+
 namespace mosaic
 {
 namespace platform
@@ -28,40 +30,46 @@ pieces::RefResult<core::Platform, std::string> EmscriptenPlatform::initialize()
 
 pieces::RefResult<core::Platform, std::string> EmscriptenPlatform::run()
 {
-    static std::string errorMsg;
-
-    auto callback = [](void* _arg)
-    {
-        auto pApp = reinterpret_cast<core::Application*>(_arg);
+    // The browser calls runFrame() at each animation frame, the main thread returning to it in
+    // between: nothing waits on it, which needs no ASYNCIFY. The stack of main() is unwound, the
+    // call does not return; the last frame shuts the platform down.
+    emscripten_set_main_loop_arg(&EmscriptenPlatform::runFrame, this, 0, true);
 
-        glfwPollEvents();
+    return pieces::OkRef<core::Platform, std::string>(*this);
+}
 
-        if (pApp->shouldExit())
-        {
-            return emscripten_cancel_main_loop();
-        }
+void EmscriptenPlatform::runFrame(void* _platform)
+{
+    auto* platform = static_cast<EmscriptenPlatform*>(_platform);
+    auto* app = platform->getApplication();
 
-        if (pApp->isResumed())
-        {
-            auto result = pApp->update();
+    glfwPollEvents();
 
-            if (result.isErr())
-            {
-                errorMsg = std::move(result.error());
+    if (app->shouldExit())
+    {
+        platform->stop();
+        return;
+    }
 
-                return emscripten_cancel_main_loop();
-            }
-        }
-    };
+    if (!app->isResumed()) return;
 
-    emscripten_set_main_loop_arg(callback, this, 0, true);
+    auto result = app->update();
 
-    if (!errorMsg.empty())
+    if (result.isErr())
     {
-        return pieces::ErrRef<core::Platform, std::string>(std::move(errorMsg));
+        MOSAIC_ERROR("{}", result.error());
+        platform->stop();
     }
+}
 
-    return pieces::OkRef<core::Platform, std::string>(*this);
+void EmscriptenPlatform::stop()
+{
+    emscripten_cancel_main_loop();
+
+    shutdown();
+
+    // runApp() does not resume past run(), the logger is not shut down
+    tools::Logger::getInstance()->flush();
 }
 
 void EmscriptenPlatform::pause()
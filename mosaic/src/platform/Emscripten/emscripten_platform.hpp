@@ -27,6 +27,13 @@ class EmscriptenPlatform : public core::Platform
     void pause() override;
     void resume() override;
     void shutdown() override;
+
+   private:
+    // A frame of the main loop, the platform as argument
+    static void runFrame(void* _platform);
+
+    // Ends the main loop, then shuts the application down
+    void stop();
 };
 
 } // namespace emscripten
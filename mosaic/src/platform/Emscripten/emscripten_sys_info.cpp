@@ -1,5 +1,7 @@
 #include "emscripten_sys_info.hpp"
 
+#include <emscripten/threading.h>
+
 namespace mosaic
 {
 namespace platform
@@ -25,7 +27,18 @@ core::CPUInfo EmscriptenSystemInfo::getCPUInfo()
 {
     core::CPUInfo info;
 
-    // Emscripten does not provide detailed CPU information like other platforms.
+    // The browser tells the number of cores (navigator.hardwareConcurrency) and nothing else, the
+    // size of the web worker pool the ThreadPool runs on
+    const int cores = emscripten_num_logical_cores();
+
+    info.architecture = "wasm32";
+    info.logicalCores = cores > 0 ? static_cast<uint32_t>(cores) : 1;
+    info.physicalCores = info.logicalCores;
+
+#if defined(__wasm_simd128__)
+    // a browser without it would not have compiled the module
+    info.isaSupport.wasmSimd128 = true;
+#endif
 
     return info;
 }
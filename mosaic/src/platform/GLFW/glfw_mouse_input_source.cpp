@@ -11,7 +11,7 @@ GLFWMouseInputSource::GLFWMouseInputSource(window::Window* _window)
     : input::MouseInputSource(_window),
       m_nativeHandle(nullptr),
       m_focusCallbackId(0),
-      m_wheelOffsetBuffer(0.0f, 0.0f){};
+      m_scrollCallbackId(0){};
 
 pieces::RefResult<input::InputSource, std::string> GLFWMouseInputSource::initialize()
 {
@@ -29,7 +29,12 @@ pieces::RefResult<input::InputSource, std::string> GLFWMouseInputSource::initial
 
     m_scrollCallbackId = m_window->registerWindowScrollCallback(
         [this](double xoffset, double yoffset)
-        { m_wheelOffsetBuffer += glm::vec2(xoffset, yoffset); });
+        {
+            // Timestamped here, when the window system flushes the scroll of its poll, rather
+            // than in processInput()
+            pushRawEvent(input::RawInputEvent(input::RawInputEventType::scroll,
+                                              glm::vec2(xoffset, yoffset)));
+        });
 
     return pieces::OkRef<input::InputSource, std::string>(*this);
 }
@@ -60,13 +65,6 @@ glm::vec2 GLFWMouseInputSource::queryCursorPosition() const
     return glm::vec2(xpos, ypos);
 }
 
-glm::vec2 GLFWMouseInputSource::queryWheelOffset()
-{
-    auto wheelOffset = m_wheelOffsetBuffer;
-    m_wheelOffsetBuffer = glm::vec2(0.0f);
-    return wheelOffset;
-}
-
 } // namespace glfw
 } // namespace platform
 } // namespace mosaic
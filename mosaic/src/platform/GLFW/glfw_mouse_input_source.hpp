@@ -16,7 +16,6 @@ class GLFWMouseInputSource : public input::MouseInputSource
    private:
     GLFWwindow* m_nativeHandle;
     size_t m_focusCallbackId, m_scrollCallbackId;
-    glm::vec2 m_wheelOffsetBuffer;
 
    public:
     GLFWMouseInputSource(window::Window* _window);
@@ -31,7 +30,6 @@ class GLFWMouseInputSource : public input::MouseInputSource
    private:
     [[nodiscard]] input::InputAction queryButtonState(input::MouseButton _button) const override;
     [[nodiscard]] glm::vec2 queryCursorPosition() const override;
-    [[nodiscard]] glm::vec2 queryWheelOffset() override;
 };
 
 } // namespace glfw
@@ -471,7 +471,7 @@ void GLFWWindow::windowScrollCallback(GLFWwindow* window, double xoffset, double
 
     if (instance)
     {
-        instance->invokeWindowScrollCallbacks(xoffset, yoffset);
+        instance->batchWindowScrollEvent(xoffset, yoffset);
     }
     else
     {
@@ -500,7 +500,7 @@ void GLFWWindow::windowPosCallback(GLFWwindow* window, int x, int y)
     if (instance)
     {
         instance->getWindowPropertiesInternal().position = glm::ivec2(x, y);
-        instance->invokeWindowPosCallbacks(x, y);
+        instance->batchWindowPosEvent(x, y);
     }
     else
     {
@@ -26,11 +26,50 @@ void GLFWWindowSystem::shutdown()
 
 pieces::RefResult<core::System, std::string> GLFWWindowSystem::update()
 {
+#if defined(MOSAIC_PLATFORM_WEB)
     glfwPollEvents();
+#else
+    // Minimized, the render contexts have no swapchain image to draw to: sleep until restored
+    if (areAllWindowsMinimized())
+    {
+        glfwWaitEvents();
+    }
+    else
+    {
+        glfwPollEvents();
+    }
+#endif
+
+    flushBatchedEvents();
+
+    return pieces::OkRef<core::System, std::string>(*this);
+}
+
+pieces::RefResult<core::System, std::string> GLFWWindowSystem::waitEvents(
+    std::chrono::nanoseconds _timeout)
+{
+#if defined(MOSAIC_PLATFORM_WEB)
+    // the browser runs the loop, it cannot block
+    (void)_timeout;
+    glfwPollEvents();
+#else
+    if (_timeout <= std::chrono::nanoseconds::zero() || areAllWindowsMinimized()) return update();
+
+    glfwWaitEventsTimeout(std::chrono::duration<double>(_timeout).count());
+#endif
+
+    flushBatchedEvents();
 
     return pieces::OkRef<core::System, std::string>(*this);
 }
 
+void GLFWWindowSystem::wakeUp() noexcept
+{
+#if !defined(MOSAIC_PLATFORM_WEB)
+    glfwPostEmptyEvent();
+#endif
+}
+
 } // namespace glfw
 } // namespace platform
 } // namespace mosaic
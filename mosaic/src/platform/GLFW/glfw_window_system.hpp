@@ -21,6 +21,9 @@ class GLFWWindowSystem : public window::WindowSystem
     void shutdown() override;
 
     pieces::RefResult<core::System, std::string> update() override;
+    pieces::RefResult<core::System, std::string> waitEvents(
+        std::chrono::nanoseconds _timeout) override;
+    void wakeUp() noexcept override;
 };
 
 } // namespace glfw
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "mosaic/core/sys_info.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace mosaic
+{
+namespace platform
+{
+namespace posix
+{
+
+// Reads the topology Linux exposes in sysfs, shared with Android (AGDK) where it is the same.
+namespace sysfs
+{
+
+inline const std::string k_cpuRoot = "/sys/devices/system/cpu/";
+inline const std::string k_nodeRoot = "/sys/devices/system/node/";
+
+// Returns the first line of a file, empty if it cannot be read.
+inline std::string readLine(const std::string& _path)
+{
+    std::ifstream file(_path);
+    std::string line;
+
+    if (file) std::getline(file, line);
+
+    return line;
+}
+
+// Parses a kernel CPU list such as "0-3,8,10-11".
+inline std::vector<uint32_t> parseCPUList(const std::string& _list)
+{
+    std::vector<uint32_t> ids;
+    size_t pos = 0;
+
+    while (pos < _list.size())
+    {
+        const size_t comma = std::min(_list.find(',', pos), _list.size());
+        const std::string range = _list.substr(pos, comma - pos);
+        pos = comma + 1;
+
+        const size_t dash = range.find('-');
+
+        try
+        {
+            const uint32_t first = static_cast<uint32_t>(std::stoul(range));
+            const uint32_t last = dash == std::string::npos
+                                      ? first
+                                      : static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+
+            for (uint32_t id = first; id <= last; ++id) ids.push_back(id);
+        }
+        catch (const std::exception&)
+        {
+            // a malformed or empty range, skipped
+        }
+    }
+
+    return ids;
+}
+
+// The lowest id of a CPU list file, or the fallback if it cannot be read.
+inline uint32_t firstOfCPUList(const std::string& _path, uint32_t _fallback)
+{
+    const std::vector<uint32_t> ids = parseCPUList(readLine(_path));
+
+    return ids.empty() ? _fallback : *std::ranges::min_element(ids);
+}
+
+// The processors sharing the last data (or unified) cache level of the processor.
+inline uint32_t lastLevelCacheGroup(uint32_t _cpu)
+{
+    const std::string cacheRoot = k_cpuRoot + "cpu" + std::to_string(_cpu) + "/cache/index";
+
+    int bestLevel = -1;
+    uint32_t group = _cpu;
+
+    for (int index = 0;; ++index)
+    {
+        const std::string root = cacheRoot + std::to_string(index) + "/";
+        const std::string level = readLine(root + "level");
+
+        if (level.empty()) break;
+        if (readLine(root + "type") == "Instruction") continue;
+
+        const int value = std::atoi(level.c_str());
+        if (value <= bestLevel) continue;
+
+        bestLevel = value;
+        group = firstOfCPUList(root + "shared_cpu_list", _cpu);
+    }
+
+    return group;
+}
+
+/**
+ * @brief Reads the online processors with their core, last-level cache, NUMA node and efficiency
+ * class.
+ *
+ * Efficiency classes come from the Intel hybrid PMU list (cpu_atom are the E-cores) when present,
+ * otherwise from the ranks of the distinct cpu_capacity values (big.LITTLE). Maximum frequencies
+ * are not used: the favored cores of homogeneous CPUs boost higher. The result is empty if sysfs
+ * is not mounted.
+ */
+inline std::vector<core::LogicalProcessorInfo> readCPUTopology()
+{
+    std::vector<core::LogicalProcessorInfo> processors;
+
+    const std::vector<uint32_t> online = parseCPUList(readLine(k_cpuRoot + "online"));
+    if (online.empty()) return processors;
+
+    std::map<uint32_t, uint32_t> nodeOf;
+    for (uint32_t node = 0;; ++node)
+    {
+        const std::string cpus = readLine(k_nodeRoot + "node" + std::to_string(node) + "/cpulist");
+        if (cpus.empty()) break;
+
+        for (uint32_t cpu : parseCPUList(cpus)) nodeOf[cpu] = node;
+    }
+
+    const std::vector<uint32_t> atomCPUs = parseCPUList(readLine("/sys/devices/cpu_atom/cpus"));
+
+    std::vector<uint64_t> capacities;
+    capacities.reserve(online.size());
+
+    for (uint32_t cpu : online)
+    {
+        const std::string root = k_cpuRoot + "cpu" + std::to_string(cpu) + "/";
+
+        core::LogicalProcessorInfo processor;
+        processor.id = cpu;
+        processor.coreId = firstOfCPUList(root + "topology/thread_siblings_list", cpu);
+        processor.cacheGroup = lastLevelCacheGroup(cpu);
+        processor.numaNode = nodeOf.contains(cpu) ? nodeOf[cpu] : 0;
+
+        capacities.push_back(std::strtoull(readLine(root + "cpu_capacity").c_str(), nullptr, 10));
+        processors.push_back(processor);
+    }
+
+    if (!atomCPUs.empty())
+    {
+        for (auto& processor : processors)
+        {
+            const bool atom = std::ranges::find(atomCPUs, processor.id) != atomCPUs.end();
+            processor.efficiencyClass = atom ? 0 : 1;
+        }
+
+        return processors;
+    }
+
+    // ranks of the distinct capacities, equal for every processor when they are all the same
+    const std::set<uint64_t> distinct(capacities.begin(), capacities.end());
+
+    for (size_t i = 0; i < processors.size(); ++i)
+    {
+        const auto rank = std::distance(distinct.begin(), distinct.find(capacities[i]));
+        processors[i].efficiencyClass = static_cast<uint8_t>(std::min<std::ptrdiff_t>(rank, 255));
+    }
+
+    return processors;
+}
+
+} // namespace sysfs
+
+} // namespace posix
+} // namespace platform
+} // namespace mosaic
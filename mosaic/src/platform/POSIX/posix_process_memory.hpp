@@ -0,0 +1,48 @@
+#pragma once
+
+#include "mosaic/core/sys_info.hpp"
+
+#include <cstddef>
+#include <fstream>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace mosaic
+{
+namespace platform
+{
+namespace posix
+{
+
+// Reads the counters Linux exposes for the process, shared with Android (AGDK) where they are
+// the same: no parsing beyond two numbers, cheap enough to be read every frame.
+namespace procfs
+{
+
+inline void readProcessMemory(core::MemoryMetrics& _metrics)
+{
+    // in pages: the size of the address space, then the resident set
+    std::ifstream statm("/proc/self/statm");
+    size_t sizePages = 0;
+    size_t residentPages = 0;
+
+    if (statm >> sizePages >> residentPages)
+    {
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        _metrics.processResidentKB = residentPages * static_cast<size_t>(pageSize) / 1024;
+    }
+
+    // in kilobytes on Linux
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        _metrics.processPeakResidentKB = static_cast<size_t>(usage.ru_maxrss);
+    }
+}
+
+} // namespace procfs
+
+} // namespace posix
+} // namespace platform
+} // namespace mosaic
@@ -1,4 +1,8 @@
 #include "posix_sys_info.hpp"
+#include "posix_cpu_topology.hpp"
+#include "posix_process_memory.hpp"
+
+#include "mosaic/core/isa_dispatch.hpp"
 
 namespace mosaic
 {
@@ -18,6 +22,9 @@ core::CPUInfo POSIXSystemInfo::getCPUInfo()
 {
     core::CPUInfo info{};
 
+    info.processors = sysfs::readCPUTopology();
+    info.isaSupport = core::getHostISASupport();
+
     return info;
 }
 
@@ -25,6 +32,17 @@ core::MemoryMetrics POSIXSystemInfo::getMemoryMetrics()
 {
     core::MemoryMetrics metrics{};
 
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    const long totalPages = sysconf(_SC_PHYS_PAGES);
+    const long freePages = sysconf(_SC_AVPHYS_PAGES);
+
+    if (pageSize > 0 && totalPages > 0 && freePages >= 0)
+    {
+        metrics.totalMemoryKB = static_cast<size_t>(totalPages) * pageSize / 1024;
+        metrics.freeMemoryKB = static_cast<size_t>(freePages) * pageSize / 1024;
+        metrics.usedMemoryKB = metrics.totalMemoryKB - metrics.freeMemoryKB;
+    }
+
     return metrics;
 }
 
@@ -49,6 +67,11 @@ std::vector<core::MonitorInfo> POSIXSystemInfo::getMonitors()
     return monitorsInfo;
 }
 
+void POSIXSystemInfo::queryProcessMemory(core::MemoryMetrics& _metrics)
+{
+    procfs::readProcessMemory(_metrics);
+}
+
 } // namespace posix
 } // namespace platform
 } // namespace mosaic
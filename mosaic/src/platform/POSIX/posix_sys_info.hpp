@@ -23,6 +23,8 @@ class POSIXSystemInfo : public core::SystemInfo::SystemInfoImpl
     std::vector<core::StorageDeviceInfo> getStorageDevices() override;
     core::LocaleInfo getLocaleInfo() override;
     std::vector<core::MonitorInfo> getMonitors() override;
+
+    void queryProcessMemory(core::MemoryMetrics& _metrics) override;
 };
 
 } // namespace posix
@@ -16,11 +16,17 @@
 #include <immintrin.h>
 #include <isa_availability.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <vector>
+
 #pragma comment(lib, "wbemuuid.lib")
 #pragma comment(lib, "oleaut32.lib")
 #pragma comment(lib, "ole32.lib")
 #pragma comment(lib, "setupapi.lib")
 #pragma comment(lib, "shcore.lib")
+#pragma comment(lib, "psapi.lib")
 
 namespace mosaic
 {
@@ -332,13 +338,113 @@ core::CPUInfo Win32SystemInfo::getCPUInfo()
     info.isaSupport.apx = checkISA(__IA_SUPPORT_APX);
     info.isaSupport.fp16 = checkISA(__IA_SUPPORT_FP16);
 
+    info.processors = queryCPUTopology();
+
     return info;
 }
 
-core::MemoryMetrics Win32SystemInfo::getMemoryMetrics()
+std::vector<core::LogicalProcessorInfo> Win32SystemInfo::queryCPUTopology()
 {
-    if (!m_wmiHelper) m_wmiHelper = std::make_unique<WMIHelper>();
+    std::vector<core::LogicalProcessorInfo> processors;
+
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) return processors;
+
+    std::vector<std::byte> buffer(length);
+    if (!GetLogicalProcessorInformationEx(
+            RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()),
+            &length))
+    {
+        return processors;
+    }
 
+    auto forEachEntry = [&](LOGICAL_PROCESSOR_RELATIONSHIP _relationship, auto&& _func)
+    {
+        for (DWORD offset = 0; offset < length;)
+        {
+            const auto* entry =
+                reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+            offset += entry->Size;
+
+            if (entry->Relationship == _relationship) _func(*entry);
+        }
+    };
+
+    // Processor ids span the processor groups, 64 per group
+    auto idsOf = [](const GROUP_AFFINITY& _mask)
+    {
+        std::vector<uint32_t> ids;
+        for (uint32_t bit = 0; bit < 64; ++bit)
+        {
+            if (_mask.Mask & (KAFFINITY{1} << bit)) ids.push_back(_mask.Group * 64u + bit);
+        }
+        return ids;
+    };
+
+    std::map<uint32_t, core::LogicalProcessorInfo> byId;
+    std::map<uint32_t, BYTE> cacheLevelOf;
+
+    // Cores first, the caches and nodes then refer to their processors
+    forEachEntry(RelationProcessorCore,
+                 [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& _entry)
+                 {
+                     std::vector<uint32_t> ids;
+                     for (WORD i = 0; i < _entry.Processor.GroupCount; ++i)
+                     {
+                         for (uint32_t id : idsOf(_entry.Processor.GroupMask[i])) ids.push_back(id);
+                     }
+
+                     if (ids.empty()) return;
+                     const uint32_t coreId = *std::min_element(ids.begin(), ids.end());
+
+                     for (uint32_t id : ids)
+                     {
+                         core::LogicalProcessorInfo& processor = byId[id];
+                         processor.id = id;
+                         processor.coreId = coreId;
+                         processor.cacheGroup = coreId;
+                         processor.efficiencyClass = _entry.Processor.EfficiencyClass;
+                     }
+                 });
+
+    forEachEntry(RelationCache,
+                 [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& _entry)
+                 {
+                     const CACHE_RELATIONSHIP& cache = _entry.Cache;
+                     if (cache.Type == CacheInstruction) return;
+
+                     const std::vector<uint32_t> ids = idsOf(cache.GroupMask);
+                     if (ids.empty()) return;
+                     const uint32_t group = *std::min_element(ids.begin(), ids.end());
+
+                     for (uint32_t id : ids)
+                     {
+                         if (!byId.contains(id) || cacheLevelOf[id] >= cache.Level) continue;
+
+                         cacheLevelOf[id] = cache.Level;
+                         byId[id].cacheGroup = group;
+                     }
+                 });
+
+    forEachEntry(RelationNumaNode,
+                 [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& _entry)
+                 {
+                     for (uint32_t id : idsOf(_entry.NumaNode.GroupMask))
+                     {
+                         if (byId.contains(id)) byId[id].numaNode = _entry.NumaNode.NodeNumber;
+                     }
+                 });
+
+    processors.reserve(byId.size());
+    for (const auto& [id, processor] : byId) processors.push_back(processor);
+
+    return processors;
+}
+
+core::MemoryMetrics Win32SystemInfo::getMemoryMetrics()
+{
+    // the memory status only, connecting to WMI would take longer than the whole query
     core::MemoryMetrics metrics{};
 
     MEMORYSTATUSEX memStatus;
@@ -534,6 +640,18 @@ std::vector<core::MonitorInfo> Win32SystemInfo::getMonitors()
     return monitorsInfo;
 }
 
+void Win32SystemInfo::queryProcessMemory(core::MemoryMetrics& _metrics)
+{
+    PROCESS_MEMORY_COUNTERS counters{};
+    counters.cb = sizeof(counters);
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        _metrics.processResidentKB = BYTES_TO_KB(counters.WorkingSetSize);
+        _metrics.processPeakResidentKB = BYTES_TO_KB(counters.PeakWorkingSetSize);
+    }
+}
+
 std::string Win32SystemInfo::getRegistryString(HKEY hKey, const std::string& subKey,
                                                const std::string& valueName)
 {
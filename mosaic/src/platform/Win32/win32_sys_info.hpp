@@ -58,6 +58,7 @@ class Win32SystemInfo : public core::SystemInfo::SystemInfoImpl
                                   const std::string& _valueName);
     core::StorageDeviceInfo::StorageType determineStorageType(const std::string& _devicePath);
     std::string getVolumeLabel(const std::string& _rootPath);
+    std::vector<core::LogicalProcessorInfo> queryCPUTopology();
 
     // Monitor enumeration callback
     static BOOL CALLBACK monitorEnumProc(HMONITOR _hMonitor, HDC _hdcMonitor, LPRECT _lprcMonitor,
@@ -73,6 +74,8 @@ class Win32SystemInfo : public core::SystemInfo::SystemInfoImpl
     std::vector<core::StorageDeviceInfo> getStorageDevices() override;
     core::LocaleInfo getLocaleInfo() override;
     std::vector<core::MonitorInfo> getMonitors() override;
+
+    void queryProcessMemory(core::MemoryMetrics& _metrics) override;
 };
 
 } // namespace win32
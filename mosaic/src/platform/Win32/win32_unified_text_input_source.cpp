@@ -15,6 +15,20 @@ namespace platform
 namespace win32
 {
 
+namespace
+{
+
+// Sized once for the longest encoding then trimmed: no growth per codepoint
+void toUtf8(std::span<const char32_t> _codepoints, std::string& _out)
+{
+    _out.resize(_codepoints.size() * 4);
+
+    auto written = pieces::utils::CodepointsToUtf8(_codepoints, std::span<char>(_out));
+    _out.resize(written.isOk() ? written.unwrap() : 0);
+}
+
+} // namespace
+
 // Static map to associate HWND with Win32UnifiedTextInputSource instances for window procedure
 std::unordered_map<HWND, Win32UnifiedTextInputSource*> Win32UnifiedTextInputSource::s_sourceMap;
 
@@ -159,8 +173,8 @@ void Win32UnifiedTextInputSource::queryPendingEvents(
     {
         input::TextInputEvent event;
         event.codepoints = std::move(m_codepointsBuffer);
-        event.text = pieces::utils::CodepointsToUtf8(event.codepoints);
-        event.metadata.timestamp = std::chrono::high_resolution_clock::now();
+        toUtf8(event.codepoints, event.text);
+        event.metadata.timestamp = core::TickClock::now();
         event.metadata.pollCount = m_pollCount;
 
         _outTextEvents.push_back(std::move(event));
@@ -278,7 +292,7 @@ void Win32UnifiedTextInputSource::handleIMEComposition(LPARAM lParam)
             // IME_ENDCOMPOSITION
             input::IMEEvent imeEvent;
             imeEvent.type = input::IMEEventType::CompositionCommit;
-            imeEvent.composition.text = pieces::utils::Utf32ToUtf8(resultStr);
+            toUtf8(resultStr, imeEvent.composition.text);
             imeEvent.composition.cursor = resultStr.length();
             m_imeEventBuffer.push_back(imeEvent);
         }
@@ -292,7 +306,7 @@ void Win32UnifiedTextInputSource::handleIMEComposition(LPARAM lParam)
 
         input::IMEEvent event;
         event.type = input::IMEEventType::CompositionUpdate;
-        event.composition.text = pieces::utils::Utf32ToUtf8(compStr);
+        toUtf8(compStr, event.composition.text);
         event.composition.cursor = cursor;
         m_imeEventBuffer.push_back(event);
     }
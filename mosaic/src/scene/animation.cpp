@@ -0,0 +1,809 @@
+#include "mosaic/scene/animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <pieces/intrinsics/simd_math.hpp>
+
+#include "mosaic/exec/parallel_for.hpp"
+#include "mosaic/tools/logger.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+namespace simd = pieces::simd;
+
+namespace
+{
+
+constexpr size_t k_lanes = AnimationPose::k_lanes;
+
+// The range of the three smallest components of a unit quaternion
+constexpr float k_smallestRange = 0.70710678f;
+
+struct Value4
+{
+    float v[4];
+};
+
+// The inverse of an affine column-major matrix.
+void invertAffine(const float* _m, float* _out) noexcept
+{
+    const float a = _m[0], b = _m[4], c = _m[8];
+    const float d = _m[1], e = _m[5], f = _m[9];
+    const float g = _m[2], h = _m[6], i = _m[10];
+
+    const float c00 = e * i - f * h, c01 = c * h - b * i, c02 = b * f - c * e;
+    const float c10 = f * g - d * i, c11 = a * i - c * g, c12 = c * d - a * f;
+    const float c20 = d * h - e * g, c21 = b * g - a * h, c22 = a * e - b * d;
+
+    const float determinant = a * c00 + b * c10 + c * c20;
+    const float inverse = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+
+    const float r[9] = {c00 * inverse, c01 * inverse, c02 * inverse, c10 * inverse, c11 * inverse,
+                        c12 * inverse, c20 * inverse, c21 * inverse, c22 * inverse};
+
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 3; ++column) _out[4 * column + row] = r[3 * row + column];
+        _out[4 * row + 3] = 0.0f;
+    }
+
+    for (int row = 0; row < 3; ++row)
+    {
+        _out[12 + row] =
+            -(r[3 * row] * _m[12] + r[3 * row + 1] * _m[13] + r[3 * row + 2] * _m[14]);
+    }
+    _out[15] = 1.0f;
+}
+
+simd::mat4 localMatrix(const JointTransform& _joint) noexcept
+{
+    return simd::mat4::fromTranslationRotationScale(
+        simd::float4(_joint.translation.x, _joint.translation.y, _joint.translation.z, 0.0f),
+        simd::float4(_joint.rotation.x, _joint.rotation.y, _joint.rotation.z, _joint.rotation.w),
+        simd::float4(_joint.scale.x, _joint.scale.y, _joint.scale.z, 0.0f));
+}
+
+// Composes the model space transforms of the joints into _palette, reusing _models.
+void writePalette(const Skeleton& _skeleton, const AnimationPose& _pose, SkinningMatrix* _palette,
+                  size_t _count, std::vector<simd::mat4>& _models)
+{
+    const std::span<const int32_t> parents = _skeleton.getParents();
+    _models.resize(_count);
+
+    const float* tx = _pose.data(AnimationPose::translationX);
+    const float* ty = _pose.data(AnimationPose::translationY);
+    const float* tz = _pose.data(AnimationPose::translationZ);
+    const float* rx = _pose.data(AnimationPose::rotationX);
+    const float* ry = _pose.data(AnimationPose::rotationY);
+    const float* rz = _pose.data(AnimationPose::rotationZ);
+    const float* rw = _pose.data(AnimationPose::rotationW);
+    const float* sx = _pose.data(AnimationPose::scaleX);
+    const float* sy = _pose.data(AnimationPose::scaleY);
+    const float* sz = _pose.data(AnimationPose::scaleZ);
+
+    for (size_t joint = 0; joint < _count; ++joint)
+    {
+        const simd::mat4 local = simd::mat4::fromTranslationRotationScale(
+            simd::float4(tx[joint], ty[joint], tz[joint], 0.0f),
+            simd::float4(rx[joint], ry[joint], rz[joint], rw[joint]),
+            simd::float4(sx[joint], sy[joint], sz[joint], 0.0f));
+
+        const int32_t parent = parents[joint];
+        _models[joint] = parent == Skeleton::k_noParent ? local : _models[parent] * local;
+
+        // the rows of the skinning matrix are the columns of its transpose, the last one is 0001
+        const simd::mat4 skinning = simd::transpose(
+            _models[joint] * simd::mat4::load(_skeleton.getInverseBind(joint)));
+
+        float* rows = _palette[joint].rows.data();
+        for (int row = 0; row < 3; ++row) skinning.columns[row].store(rows + 4 * row);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compression
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Value4 interpolate(const Value4& _a, const Value4& _b, float _t, bool _rotation) noexcept
+{
+    Value4 result;
+    for (int i = 0; i < 4; ++i) result.v[i] = _a.v[i] + (_b.v[i] - _a.v[i]) * _t;
+
+    if (_rotation)
+    {
+        const float length = std::sqrt(result.v[0] * result.v[0] + result.v[1] * result.v[1] +
+                                       result.v[2] * result.v[2] + result.v[3] * result.v[3]);
+        for (float& component : result.v) component /= length;
+    }
+    return result;
+}
+
+// A distance for vectors, an angle in radians for rotations of the same hemisphere.
+float difference(const Value4& _a, const Value4& _b, bool _rotation) noexcept
+{
+    if (_rotation)
+    {
+        const float dot = std::abs(_a.v[0] * _b.v[0] + _a.v[1] * _b.v[1] + _a.v[2] * _b.v[2] +
+                                   _a.v[3] * _b.v[3]);
+        return 2.0f * std::acos(std::min(dot, 1.0f));
+    }
+
+    const float x = _a.v[0] - _b.v[0], y = _a.v[1] - _b.v[1], z = _a.v[2] - _b.v[2];
+    return std::sqrt(x * x + y * y + z * z);
+}
+
+// The frames kept of a track: a key is dropped while interpolating the last kept one and the next
+// candidate stays within _tolerance of every frame between.
+void reduceTrack(std::span<const Value4> _values, float _tolerance, bool _rotation,
+                 std::vector<uint16_t>& _frames)
+{
+    const size_t count = _values.size();
+    _frames.push_back(0);
+
+    size_t anchor = 0;
+    for (size_t end = 2; end < count; ++end)
+    {
+        bool within = true;
+        for (size_t frame = anchor + 1; frame < end && within; ++frame)
+        {
+            const float t = float(frame - anchor) / float(end - anchor);
+            within = difference(interpolate(_values[anchor], _values[end], t, _rotation),
+                                _values[frame], _rotation) <= _tolerance;
+        }
+
+        if (!within)
+        {
+            anchor = end - 1;
+            _frames.push_back(uint16_t(anchor));
+        }
+    }
+
+    if (count > 1) _frames.push_back(uint16_t(count - 1));
+}
+
+uint16_t quantizeUnit(float _value, float _max) noexcept
+{
+    return uint16_t(std::lround(std::clamp(_value, 0.0f, 1.0f) * _max));
+}
+
+// The smallest three of a unit quaternion, 15, 15 and 16 bits, the index of the largest one in
+// the top bits of the first two.
+void encodeRotation(const Value4& _q, uint16_t* _out) noexcept
+{
+    int largest = 0;
+    for (int i = 1; i < 4; ++i)
+    {
+        if (std::abs(_q.v[i]) > std::abs(_q.v[largest])) largest = i;
+    }
+
+    // q and -q are the same rotation, the largest is positive and not stored
+    const float sign = _q.v[largest] < 0.0f ? -1.0f : 1.0f;
+
+    float smallest[3];
+    for (int i = 0, j = 0; i < 4; ++i)
+    {
+        if (i != largest) smallest[j++] = _q.v[i] * sign;
+    }
+
+    const auto unit = [](float _component)
+    { return (_component + k_smallestRange) / (2.0f * k_smallestRange); };
+
+    _out[0] = uint16_t((uint32_t(largest) >> 1) << 15 | quantizeUnit(unit(smallest[0]), 32767.0f));
+    _out[1] = uint16_t((uint32_t(largest) & 1) << 15 | quantizeUnit(unit(smallest[1]), 32767.0f));
+    _out[2] = quantizeUnit(unit(smallest[2]), 65535.0f);
+}
+
+void compressChannel(size_t _jointCount, size_t _frameCount, std::span<const Value4> _values,
+                     float _tolerance, bool _rotation, AnimationClip::Channel& _channel)
+{
+    _channel.firstKey.assign(1, 0);
+    if (!_rotation)
+    {
+        _channel.minimum.resize(3 * _jointCount);
+        _channel.step.resize(3 * _jointCount);
+    }
+
+    std::vector<uint16_t> frames;
+    for (size_t joint = 0; joint < _jointCount; ++joint)
+    {
+        const std::span<const Value4> track = _values.subspan(joint * _frameCount, _frameCount);
+
+        frames.clear();
+        reduceTrack(track, _tolerance, _rotation, frames);
+        _channel.frames.insert(_channel.frames.end(), frames.begin(), frames.end());
+        _channel.firstKey.push_back(uint32_t(_channel.frames.size()));
+
+        if (_rotation)
+        {
+            for (uint16_t frame : frames)
+            {
+                uint16_t encoded[3];
+                encodeRotation(track[frame], encoded);
+                _channel.values.insert(_channel.values.end(), encoded, encoded + 3);
+            }
+            continue;
+        }
+
+        // the range of the kept keys per axis, a still axis has no step
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float low = track[frames[0]].v[axis];
+            float high = low;
+            for (uint16_t frame : frames)
+            {
+                low = std::min(low, track[frame].v[axis]);
+                high = std::max(high, track[frame].v[axis]);
+            }
+
+            _channel.minimum[3 * joint + axis] = low;
+            _channel.step[3 * joint + axis] = (high - low) / 65535.0f;
+        }
+
+        for (uint16_t frame : frames)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float step = _channel.step[3 * joint + axis];
+                const float offset = track[frame].v[axis] - _channel.minimum[3 * joint + axis];
+                _channel.values.push_back(
+                    step > 0.0f ? uint16_t(std::lround(std::clamp(offset / step, 0.0f, 65535.0f)))
+                                : uint16_t(0));
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sampling
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The two keys around a frame of a track of a channel and how far between them
+void findKeys(const AnimationClip::Channel& _channel, size_t _joint, float _frame, uint32_t& _key0,
+              uint32_t& _key1, float& _alpha) noexcept
+{
+    const uint32_t first = _channel.firstKey[_joint];
+    const uint32_t last = _channel.firstKey[_joint + 1] - 1;
+
+    const uint16_t frame = uint16_t(_frame);
+    const uint16_t* begin = _channel.frames.data() + first;
+    const uint16_t* end = _channel.frames.data() + last + 1;
+    const uint32_t next = uint32_t(std::upper_bound(begin, end, frame) - _channel.frames.data());
+
+    if (next > last)
+    {
+        _key0 = _key1 = last;
+        _alpha = 0.0f;
+        return;
+    }
+
+    _key0 = next - 1;
+    _key1 = next;
+
+    const float frame0 = float(_channel.frames[_key0]);
+    _alpha = (_frame - frame0) / (float(_channel.frames[_key1]) - frame0);
+}
+
+// The keys of k_lanes joints, quantized values and ranges as floats, one array per component
+struct alignas(32) Lanes
+{
+    float key0[3][k_lanes];
+    float key1[3][k_lanes];
+    float minimum[3][k_lanes];
+    float step[3][k_lanes];
+    float alpha[k_lanes];
+    uint32_t largest0[k_lanes];
+    uint32_t largest1[k_lanes];
+};
+
+void gatherVectors(const AnimationClip::Channel& _channel, size_t _first, size_t _count,
+                   float _frame, Lanes& _lanes) noexcept
+{
+    for (size_t lane = 0; lane < k_lanes; ++lane)
+    {
+        if (lane >= _count)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                _lanes.key0[axis][lane] = _lanes.key1[axis][lane] = 0.0f;
+                _lanes.minimum[axis][lane] = _lanes.step[axis][lane] = 0.0f;
+            }
+            _lanes.alpha[lane] = 0.0f;
+            continue;
+        }
+
+        const size_t joint = _first + lane;
+        uint32_t key0, key1;
+        findKeys(_channel, joint, _frame, key0, key1, _lanes.alpha[lane]);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            _lanes.key0[axis][lane] = float(_channel.values[3 * key0 + axis]);
+            _lanes.key1[axis][lane] = float(_channel.values[3 * key1 + axis]);
+            _lanes.minimum[axis][lane] = _channel.minimum[3 * joint + axis];
+            _lanes.step[axis][lane] = _channel.step[3 * joint + axis];
+        }
+    }
+}
+
+// Dequantizes and interpolates the gathered keys into 3 channels of the pose at _first.
+void sampleVectors(const Lanes& _lanes, size_t _first, AnimationPose& _pose,
+                   AnimationPose::Channel _x) noexcept
+{
+    const simd::float8 alpha = simd::float8::load(_lanes.alpha);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const simd::float8 minimum = simd::float8::load(_lanes.minimum[axis]);
+        const simd::float8 step = simd::float8::load(_lanes.step[axis]);
+
+        const simd::float8 value0 = mulAdd(simd::float8::load(_lanes.key0[axis]), step, minimum);
+        const simd::float8 value1 = mulAdd(simd::float8::load(_lanes.key1[axis]), step, minimum);
+
+        mulAdd(value1 - value0, alpha, value0)
+            .store(_pose.data(AnimationPose::Channel(_x + axis)) + _first);
+    }
+}
+
+void gatherRotations(const AnimationClip::Channel& _channel, size_t _first, size_t _count,
+                     float _frame, Lanes& _lanes) noexcept
+{
+    // the middle of every range decodes to 0, the padding lanes to the identity
+    constexpr float k_middle[3] = {16383.5f, 16383.5f, 32767.5f};
+
+    for (size_t lane = 0; lane < k_lanes; ++lane)
+    {
+        if (lane >= _count)
+        {
+            for (int i = 0; i < 3; ++i) _lanes.key0[i][lane] = _lanes.key1[i][lane] = k_middle[i];
+            _lanes.largest0[lane] = _lanes.largest1[lane] = 3;
+            _lanes.alpha[lane] = 0.0f;
+            continue;
+        }
+
+        uint32_t key0, key1;
+        findKeys(_channel, _first + lane, _frame, key0, key1, _lanes.alpha[lane]);
+
+        const uint16_t* value0 = _channel.values.data() + 3 * key0;
+        const uint16_t* value1 = _channel.values.data() + 3 * key1;
+
+        _lanes.largest0[lane] = uint32_t(value0[0] >> 15) << 1 | uint32_t(value0[1] >> 15);
+        _lanes.largest1[lane] = uint32_t(value1[0] >> 15) << 1 | uint32_t(value1[1] >> 15);
+
+        _lanes.key0[0][lane] = float(value0[0] & 0x7FFF);
+        _lanes.key0[1][lane] = float(value0[1] & 0x7FFF);
+        _lanes.key0[2][lane] = float(value0[2]);
+        _lanes.key1[0][lane] = float(value1[0] & 0x7FFF);
+        _lanes.key1[1][lane] = float(value1[1] & 0x7FFF);
+        _lanes.key1[2][lane] = float(value1[2]);
+    }
+}
+
+// The 4 components of k_lanes quaternions from their smallest three.
+simd::float4x8 decodeRotations(const float (&_key)[3][k_lanes],
+                               const uint32_t (&_largest)[k_lanes]) noexcept
+{
+    const simd::float8 offset(-k_smallestRange);
+    const simd::float8 scale15(2.0f * k_smallestRange / 32767.0f);
+    const simd::float8 scale16(2.0f * k_smallestRange / 65535.0f);
+
+    const simd::float8 a = mulAdd(simd::float8::load(_key[0]), scale15, offset);
+    const simd::float8 b = mulAdd(simd::float8::load(_key[1]), scale15, offset);
+    const simd::float8 c = mulAdd(simd::float8::load(_key[2]), scale16, offset);
+    const simd::float8 d = sqrt(max(simd::float8(1.0f) - (a * a + b * b + c * c),
+                                    simd::float8(0.0f)));
+
+    // the largest component goes back to its place
+    alignas(32) float decoded[4][k_lanes];
+    a.store(decoded[0]);
+    b.store(decoded[1]);
+    c.store(decoded[2]);
+    d.store(decoded[3]);
+
+    alignas(32) float components[4][k_lanes];
+    for (size_t lane = 0; lane < k_lanes; ++lane)
+    {
+        const uint32_t largest = _largest[lane];
+        for (uint32_t i = 0, j = 0; i < 4; ++i)
+        {
+            components[i][lane] = i == largest ? decoded[3][lane] : decoded[j++][lane];
+        }
+    }
+
+    return simd::float4x8::load(components[0], components[1], components[2], components[3]);
+}
+
+// -1 where _value is negative, 1 elsewhere
+simd::float8 signOf(simd::float8 _value) noexcept
+{
+    const simd::float4 zero = simd::float4::zero();
+    const simd::float4 negative(-1.0f), positive(1.0f);
+    return simd::float8(simd::select(_value.low() < zero, negative, positive),
+                        simd::select(_value.high() < zero, negative, positive));
+}
+
+// Interpolates towards the closest of _b and -_b, normalized.
+simd::float4x8 nlerp(const simd::float4x8& _a, const simd::float4x8& _b,
+                     simd::float8 _weight) noexcept
+{
+    const simd::float4x8 b = _b * signOf(dot(_a, _b));
+    const simd::float4x8 q = _a + (b - _a) * _weight;
+    return q * (simd::float8(1.0f) / sqrt(dot(q, q)));
+}
+
+void storeRotations(const simd::float4x8& _q, size_t _first, AnimationPose& _pose) noexcept
+{
+    _q.store(_pose.data(AnimationPose::rotationX) + _first,
+             _pose.data(AnimationPose::rotationY) + _first,
+             _pose.data(AnimationPose::rotationZ) + _first,
+             _pose.data(AnimationPose::rotationW) + _first);
+}
+
+float advance(float _time, float _deltaTime, const AnimationClip& _clip, bool _loop) noexcept
+{
+    const float duration = _clip.getDuration();
+    if (duration <= 0.0f) return 0.0f;
+
+    const float time = _time + _deltaTime;
+    if (!_loop) return std::clamp(time, 0.0f, duration);
+
+    const float wrapped = std::fmod(time, duration);
+    return wrapped < 0.0f ? wrapped + duration : wrapped;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Skeleton
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Skeleton::Skeleton(std::vector<int32_t> _parents, std::vector<JointTransform> _bindPose)
+    : m_parents(std::move(_parents)), m_bindPose(std::move(_bindPose))
+{
+    if (m_parents.size() != m_bindPose.size())
+    {
+        throw std::runtime_error("Skeleton has not as many parents as bind transforms.");
+    }
+
+    std::vector<simd::mat4> models(m_parents.size());
+    m_inverseBind.resize(16 * m_parents.size());
+
+    for (size_t joint = 0; joint < m_parents.size(); ++joint)
+    {
+        const int32_t parent = m_parents[joint];
+        if (parent != k_noParent && (parent < 0 || size_t(parent) >= joint))
+        {
+            throw std::runtime_error("Skeleton joint comes before its parent.");
+        }
+
+        const simd::mat4 local = localMatrix(m_bindPose[joint]);
+        models[joint] = parent == k_noParent ? local : models[parent] * local;
+
+        alignas(16) float model[16];
+        models[joint].store(model);
+        invertAffine(model, m_inverseBind.data() + 16 * joint);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AnimationPose
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void AnimationPose::resize(size_t _jointCount)
+{
+    m_jointCount = _jointCount;
+    m_stride = (_jointCount + k_lanes - 1) / k_lanes * k_lanes;
+    m_data.assign(channelCount * m_stride, 0.0f);
+
+    std::fill_n(data(rotationW), m_stride, 1.0f);
+    std::fill_n(data(scaleX), 3 * m_stride, 1.0f);
+}
+
+JointTransform AnimationPose::getJoint(size_t _joint) const noexcept
+{
+    JointTransform joint;
+    joint.translation = glm::vec3(data(translationX)[_joint], data(translationY)[_joint],
+                                  data(translationZ)[_joint]);
+    joint.rotation = glm::quat(data(rotationW)[_joint], data(rotationX)[_joint],
+                               data(rotationY)[_joint], data(rotationZ)[_joint]);
+    joint.scale = glm::vec3(data(scaleX)[_joint], data(scaleY)[_joint], data(scaleZ)[_joint]);
+    return joint;
+}
+
+void AnimationPose::setJoint(size_t _joint, const JointTransform& _transform) noexcept
+{
+    const float values[channelCount] = {
+        _transform.translation.x, _transform.translation.y, _transform.translation.z,
+        _transform.rotation.x,    _transform.rotation.y,    _transform.rotation.z,
+        _transform.rotation.w,    _transform.scale.x,       _transform.scale.y,
+        _transform.scale.z};
+
+    for (size_t channel = 0; channel < channelCount; ++channel)
+    {
+        data(Channel(channel))[_joint] = values[channel];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AnimationClip
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+AnimationClip AnimationClip::compress(size_t _jointCount, std::span<const JointTransform> _samples,
+                                      float _frameRate, const AnimationTolerance& _tolerance)
+{
+    if (_jointCount == 0 || _samples.empty() || _samples.size() % _jointCount != 0)
+    {
+        throw std::runtime_error("Animation samples are not a whole number of frames.");
+    }
+
+    const size_t frameCount = _samples.size() / _jointCount;
+    if (frameCount > 65536) throw std::runtime_error("Animation has too many frames.");
+    if (!(_frameRate > 0.0f)) throw std::runtime_error("Animation frame rate is not positive.");
+
+    MOSAIC_TRACE_SCOPE("AnimationClip::compress");
+
+    AnimationClip clip;
+    clip.m_jointCount = _jointCount;
+    clip.m_frameCount = uint32_t(frameCount);
+    clip.m_frameRate = _frameRate;
+
+    // the tracks joint after joint, rotations normalized and kept in the hemisphere of the
+    // previous frame so that neighbours interpolate the short way
+    std::vector<Value4> translations(_samples.size());
+    std::vector<Value4> rotations(_samples.size());
+    std::vector<Value4> scales(_samples.size());
+
+    for (size_t joint = 0; joint < _jointCount; ++joint)
+    {
+        for (size_t frame = 0; frame < frameCount; ++frame)
+        {
+            const JointTransform& sample = _samples[frame * _jointCount + joint];
+            const size_t index = joint * frameCount + frame;
+
+            translations[index] = {
+                {sample.translation.x, sample.translation.y, sample.translation.z, 0.0f}};
+            scales[index] = {{sample.scale.x, sample.scale.y, sample.scale.z, 0.0f}};
+
+            Value4 q = {{sample.rotation.x, sample.rotation.y, sample.rotation.z,
+                         sample.rotation.w}};
+            const float length =
+                std::sqrt(q.v[0] * q.v[0] + q.v[1] * q.v[1] + q.v[2] * q.v[2] + q.v[3] * q.v[3]);
+
+            float sign = 1.0f;
+            if (frame > 0)
+            {
+                const Value4& previous = rotations[index - 1];
+                const float dot = q.v[0] * previous.v[0] + q.v[1] * previous.v[1] +
+                                  q.v[2] * previous.v[2] + q.v[3] * previous.v[3];
+                if (dot < 0.0f) sign = -1.0f;
+            }
+
+            for (float& component : q.v) component *= sign / length;
+            rotations[index] = q;
+        }
+    }
+
+    compressChannel(_jointCount, frameCount, translations, _tolerance.translation, false,
+                    clip.m_translations);
+    compressChannel(_jointCount, frameCount, rotations, _tolerance.rotation, true,
+                    clip.m_rotations);
+    compressChannel(_jointCount, frameCount, scales, _tolerance.scale, false, clip.m_scales);
+
+    return clip;
+}
+
+void AnimationClip::sample(float _time, AnimationPose& _pose) const
+{
+    if (_pose.size() != m_jointCount) _pose.resize(m_jointCount);
+
+    const float frame = std::clamp(_time, 0.0f, getDuration()) * m_frameRate;
+
+    Lanes lanes;
+    for (size_t first = 0; first < m_jointCount; first += k_lanes)
+    {
+        const size_t count = std::min(k_lanes, m_jointCount - first);
+
+        gatherVectors(m_translations, first, count, frame, lanes);
+        sampleVectors(lanes, first, _pose, AnimationPose::translationX);
+
+        gatherVectors(m_scales, first, count, frame, lanes);
+        sampleVectors(lanes, first, _pose, AnimationPose::scaleX);
+
+        gatherRotations(m_rotations, first, count, frame, lanes);
+        storeRotations(nlerp(decodeRotations(lanes.key0, lanes.largest0),
+                             decodeRotations(lanes.key1, lanes.largest1),
+                             simd::float8::load(lanes.alpha)),
+                       first, _pose);
+    }
+}
+
+size_t AnimationClip::getKeyCount() const noexcept
+{
+    return m_translations.frames.size() + m_rotations.frames.size() + m_scales.frames.size();
+}
+
+size_t AnimationClip::getByteSize() const noexcept
+{
+    size_t size = 0;
+    for (const Channel* channel : {&m_translations, &m_rotations, &m_scales})
+    {
+        size += channel->firstKey.size() * sizeof(uint32_t);
+        size += (channel->frames.size() + channel->values.size()) * sizeof(uint16_t);
+        size += (channel->minimum.size() + channel->step.size()) * sizeof(float);
+    }
+    return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Poses
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void blendPoses(const AnimationPose& _a, const AnimationPose& _b, float _weight,
+                AnimationPose& _out)
+{
+    const size_t jointCount = std::min(_a.size(), _b.size());
+    if (_out.size() != jointCount) _out.resize(jointCount);
+
+    const simd::float8 weight(_weight);
+
+    for (size_t first = 0; first < jointCount; first += k_lanes)
+    {
+        for (AnimationPose::Channel channel :
+             {AnimationPose::translationX, AnimationPose::translationY,
+              AnimationPose::translationZ, AnimationPose::scaleX, AnimationPose::scaleY,
+              AnimationPose::scaleZ})
+        {
+            const simd::float8 a = simd::float8::load(_a.data(channel) + first);
+            const simd::float8 b = simd::float8::load(_b.data(channel) + first);
+            mulAdd(b - a, weight, a).store(_out.data(channel) + first);
+        }
+
+        const auto load = [first](const AnimationPose& _pose)
+        {
+            return simd::float4x8::load(_pose.data(AnimationPose::rotationX) + first,
+                                        _pose.data(AnimationPose::rotationY) + first,
+                                        _pose.data(AnimationPose::rotationZ) + first,
+                                        _pose.data(AnimationPose::rotationW) + first);
+        };
+        storeRotations(nlerp(load(_a), load(_b), weight), first, _out);
+    }
+}
+
+void computeSkinningPalette(const Skeleton& _skeleton, const AnimationPose& _pose,
+                            std::span<SkinningMatrix> _palette)
+{
+    std::vector<simd::mat4> models;
+    writePalette(_skeleton, _pose, _palette.data(),
+                 std::min({_skeleton.getJointCount(), _pose.size(), _palette.size()}), models);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AnimationLibrary
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t AnimationLibrary::addSkeleton(Skeleton _skeleton)
+{
+    m_skeletons.push_back(std::move(_skeleton));
+    return uint32_t(m_skeletons.size() - 1);
+}
+
+uint32_t AnimationLibrary::addClip(AnimationClip _clip)
+{
+    m_clips.push_back(std::move(_clip));
+    return uint32_t(m_clips.size() - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AnimationSystem
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+AnimationSystem::AnimationSystem(ecs::EntityRegistry& _registry, const AnimationLibrary& _library)
+    : m_library(&_library), m_query(_registry.query<ecs::detail::Read<AnimatorComponent>>())
+{
+}
+
+size_t AnimationSystem::update(float _deltaTime, graphics::FrameRing& _ring)
+{
+    MOSAIC_TRACE_SCOPE("AnimationSystem::update");
+
+    const size_t count = prepare(_deltaTime, _ring);
+    animate(0, count);
+    return count;
+}
+
+size_t AnimationSystem::update(exec::ThreadPool& _pool, float _deltaTime,
+                               graphics::FrameRing& _ring)
+{
+    MOSAIC_TRACE_SCOPE("AnimationSystem::update");
+
+    const size_t count = prepare(_deltaTime, _ring);
+    exec::parallelFor(_pool, size_t{0}, count, k_grain,
+                      [this](size_t _begin, size_t _end) { animate(_begin, _end); });
+    return count;
+}
+
+size_t AnimationSystem::prepare(float _deltaTime, graphics::FrameRing& _ring)
+{
+    m_jobs.clear();
+    m_palettes = {};
+
+    size_t size = 0;
+
+    // only the playback state is written, the view does not stamp it
+    m_query.view().readOnly().forEach(
+        [&](ecs::EntityMeta, const AnimatorComponent& _animator)
+        {
+            _animator.paletteOffset = UINT32_MAX;
+
+            const Skeleton* skeleton = m_library->getSkeleton(_animator.skeleton);
+            const AnimationClip* clip = m_library->getClip(_animator.clip);
+            const AnimationClip* blendClip = _animator.blendClip == AnimatorComponent::k_noClip
+                                                 ? nullptr
+                                                 : m_library->getClip(_animator.blendClip);
+
+            if (!skeleton || !clip || skeleton->getJointCount() != clip->getJointCount()) return;
+            if (_animator.blendClip != AnimatorComponent::k_noClip &&
+                (!blendClip || blendClip->getJointCount() != clip->getJointCount()))
+            {
+                return;
+            }
+
+            const float deltaTime = _deltaTime * _animator.speed;
+            _animator.time = advance(_animator.time, deltaTime, *clip, _animator.loop);
+            if (blendClip)
+            {
+                _animator.blendTime =
+                    advance(_animator.blendTime, deltaTime, *blendClip, _animator.loop);
+            }
+
+            m_jobs.push_back({&_animator, skeleton, clip, blendClip, uint32_t(size)});
+            size += skeleton->getJointCount() * sizeof(SkinningMatrix);
+        });
+
+    if (size == 0) return m_jobs.size();
+
+    m_palettes = _ring.allocate(size);
+    if (!m_palettes)
+    {
+        MOSAIC_ERROR("The frame ring is out of memory for {} skinning palettes", m_jobs.size());
+        m_jobs.clear();
+        return 0;
+    }
+
+    for (const Job& job : m_jobs)
+    {
+        job.animator->paletteOffset = uint32_t(m_palettes.offset + job.offset);
+    }
+    return m_jobs.size();
+}
+
+void AnimationSystem::animate(size_t _begin, size_t _end) const
+{
+    // reused by the characters of the range
+    AnimationPose pose;
+    AnimationPose blend;
+    std::vector<simd::mat4> models;
+
+    for (size_t i = _begin; i < _end; ++i)
+    {
+        const Job& job = m_jobs[i];
+
+        job.clip->sample(job.animator->time, pose);
+        if (job.blendClip)
+        {
+            job.blendClip->sample(job.animator->blendTime, blend);
+            blendPoses(pose, blend, std::clamp(job.animator->blendWeight, 0.0f, 1.0f), pose);
+        }
+
+        auto* palette = reinterpret_cast<SkinningMatrix*>(m_palettes.data + job.offset);
+        writePalette(*job.skeleton, pose, palette, job.skeleton->getJointCount(), models);
+    }
+}
+
+} // namespace scene
+} // namespace mosaic
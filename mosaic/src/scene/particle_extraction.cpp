@@ -0,0 +1,64 @@
+#include "mosaic/scene/particle_extraction.hpp"
+
+#include <algorithm>
+
+#include "mosaic/scene/transform_hierarchy.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+ParticleExtraction::ParticleExtraction(ecs::EntityRegistry& _registry)
+    : m_query(_registry.query<ecs::detail::Read<TransformComponent>,
+                              ecs::detail::Read<ParticleEmitterComponent>>())
+{
+}
+
+uint32_t ParticleExtraction::update(float _deltaTime, uint32_t _budget)
+{
+    m_emitters.clear();
+    m_spawnCount = 0;
+
+    // only the cached members (the transform, the carry) are written, the view does not stamp them
+    m_query.view().readOnly().forEach(
+        [&](ecs::EntityMeta _entity, const TransformComponent& _transform,
+            const ParticleEmitterComponent& _emitter)
+        {
+            if (m_emitters.size() == graphics::k_maxParticleEmitters) return;
+
+            const uint32_t owed = graphics::getParticleSpawnCount(_emitter.rate, _deltaTime,
+                                                                  _emitter.carry);
+            const uint32_t spawnCount = std::min(owed, _budget - m_spawnCount);
+
+            if (_transform.dirty)
+            {
+                _transform.transform = composeTransform(
+                    _transform.position, _transform.rotation, _transform.scale);
+                _transform.dirty = false;
+            }
+
+            graphics::ParticleEmitter& emitter = m_emitters.emplace_back();
+            emitter.position = {_transform.transform[3][0], _transform.transform[3][1],
+                                _transform.transform[3][2]};
+            emitter.radius = _emitter.radius;
+            emitter.velocity = {_emitter.velocity.x, _emitter.velocity.y, _emitter.velocity.z};
+            emitter.velocityJitter = _emitter.velocityJitter;
+            emitter.color = {_emitter.color.x, _emitter.color.y, _emitter.color.z,
+                             _emitter.color.w};
+            emitter.size = _emitter.size;
+            emitter.lifetime = _emitter.lifetime;
+            emitter.lifetimeJitter = _emitter.lifetimeJitter;
+            emitter.drag = _emitter.drag;
+            emitter.firstSpawn = m_spawnCount;
+            emitter.spawnCount = spawnCount;
+            emitter.seed = _entity.id;
+
+            m_spawnCount += spawnCount;
+        });
+
+    return m_spawnCount;
+}
+
+} // namespace scene
+} // namespace mosaic
@@ -0,0 +1,73 @@
+#include "mosaic/scene/render_extraction.hpp"
+
+#include "mosaic/scene/transform_hierarchy.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+RenderExtraction::RenderExtraction(ecs::EntityRegistry& _registry)
+    : m_registry(&_registry),
+      m_query(_registry.query<ecs::detail::Read<TransformComponent>,
+                              ecs::detail::Read<MeshComponent>,
+                              ecs::detail::Optional<MaterialComponent>>())
+{
+}
+
+bool RenderExtraction::update()
+{
+    const bool changed = !m_built || hasChanged();
+
+    // the writes of the current tick made after this run are seen by the next one
+    m_since = m_registry->tick() - 1;
+
+    if (!changed) return false;
+
+    rebuild();
+    return true;
+}
+
+bool RenderExtraction::hasChanged() const
+{
+    if (m_query.entityCount() != m_entityCount) return true;
+
+    // a block written since the last update, the removal of the last row of an archetype
+    // excepted (which changes the count)
+    bool changed = false;
+    m_query.view().readOnly().forEach(
+        ecs::detail::Changed<TransformComponent, MeshComponent, MaterialComponent>{}, m_since,
+        [&](ecs::EntityMeta, const TransformComponent&, const MeshComponent&, MaterialComponent*)
+        { changed = true; });
+
+    return changed;
+}
+
+void RenderExtraction::rebuild()
+{
+    m_batcher.clear();
+
+    // only the cached members of the transforms are written, the view does not stamp them
+    m_query.view().readOnly().forEach(
+        [&](ecs::EntityMeta, const TransformComponent& _transform, const MeshComponent& _mesh,
+            MaterialComponent* _material)
+        {
+            if (_transform.dirty)
+            {
+                _transform.transform = composeTransform(
+                    _transform.position, _transform.rotation, _transform.scale);
+                _transform.dirty = false;
+            }
+
+            m_batcher.add(_mesh.meshId, _material ? _material->materialId : 0,
+                          graphics::Matrix4(&_transform.transform[0][0], 16));
+        });
+
+    m_batcher.build();
+
+    m_entityCount = m_query.entityCount();
+    m_built = true;
+}
+
+} // namespace scene
+} // namespace mosaic
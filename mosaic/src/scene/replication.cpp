@@ -0,0 +1,939 @@
+#include "mosaic/scene/replication.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "mosaic/exec/parallel_for.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+namespace
+{
+
+enum class EntityOp : uint32_t
+{
+    create = 0,
+    update = 1,
+    remove = 2,
+};
+
+constexpr uint32_t k_varintWidths[4] = {4, 8, 16, 32};
+
+// Appends values of 1 to 32 bits to a byte buffer, least significant bits first.
+class BitWriter final
+{
+   private:
+    std::vector<uint8_t>& m_out;
+    uint64_t m_pending = 0;
+    uint32_t m_pendingBits = 0;
+    size_t m_bits = 0;
+
+   public:
+    explicit BitWriter(std::vector<uint8_t>& _out) : m_out(_out) {}
+
+   public:
+    void write(uint32_t _value, uint32_t _bits)
+    {
+        const uint64_t mask = (uint64_t{1} << _bits) - 1;
+        m_pending |= (uint64_t{_value} & mask) << m_pendingBits;
+        m_pendingBits += _bits;
+        m_bits += _bits;
+
+        while (m_pendingBits >= 8)
+        {
+            m_out.push_back(static_cast<uint8_t>(m_pending));
+            m_pending >>= 8;
+            m_pendingBits -= 8;
+        }
+    }
+
+    void writeVarint(uint32_t _value)
+    {
+        uint32_t width = 0;
+        while (width < 3 && _value >= (uint64_t{1} << k_varintWidths[width])) ++width;
+
+        write(width, 2);
+        write(_value, k_varintWidths[width]);
+    }
+
+    // Writes the last partial byte, zero padded.
+    void flush()
+    {
+        if (m_pendingBits != 0) m_out.push_back(static_cast<uint8_t>(m_pending));
+        m_pending = 0;
+        m_pendingBits = 0;
+    }
+
+    [[nodiscard]] size_t bits() const noexcept { return m_bits; }
+};
+
+// Reads what a BitWriter wrote, every read is bounds-checked.
+class BitReader final
+{
+   private:
+    std::span<const uint8_t> m_data;
+    size_t m_bits;
+    size_t m_cursor = 0;
+
+   public:
+    BitReader(std::span<const uint8_t> _data, size_t _bits) : m_data(_data), m_bits(_bits)
+    {
+        if ((_bits + 7) / 8 > _data.size())
+        {
+            throw std::runtime_error("Snapshot message is truncated.");
+        }
+    }
+
+   public:
+    [[nodiscard]] uint32_t read(uint32_t _bits)
+    {
+        if (_bits > m_bits - m_cursor) throw std::runtime_error("Snapshot message is truncated.");
+
+        uint64_t value = 0;
+        uint32_t got = 0;
+        while (got < _bits)
+        {
+            const uint32_t shift = static_cast<uint32_t>(m_cursor & 7);
+            const uint32_t take = std::min(8 - shift, _bits - got);
+            const uint32_t byte = m_data[m_cursor >> 3];
+
+            value |= uint64_t{(byte >> shift) & ((1u << take) - 1)} << got;
+            got += take;
+            m_cursor += take;
+        }
+
+        return static_cast<uint32_t>(value);
+    }
+
+    [[nodiscard]] uint32_t readVarint() { return read(k_varintWidths[read(2)]); }
+
+    [[nodiscard]] bool atEnd() const noexcept { return m_cursor == m_bits; }
+};
+
+void mix(uint32_t& _hash, const void* _data, size_t _size)
+{
+    const auto* bytes = static_cast<const uint8_t*>(_data);
+    for (size_t i = 0; i < _size; ++i) _hash = (_hash ^ bytes[i]) * 16777619u;
+}
+
+uint32_t quantizeScalar(const ReplicationSchema::Scalar& _scalar, const uint8_t* _component)
+{
+    if (_scalar.bytes != 0)
+    {
+        uint32_t value = 0;
+        std::memcpy(&value, _component + _scalar.offset, _scalar.bytes);
+        return value;
+    }
+
+    float value;
+    std::memcpy(&value, _component + _scalar.offset, sizeof(float));
+
+    // NaN lands on the minimum
+    const float max = _scalar.min + float((uint64_t{1} << _scalar.bits) - 1) / _scalar.scale;
+    value = value >= _scalar.min ? std::min(value, max) : _scalar.min;
+
+    return static_cast<uint32_t>(std::lround((value - _scalar.min) * _scalar.scale));
+}
+
+void dequantizeScalar(const ReplicationSchema::Scalar& _scalar, uint32_t _value,
+                      uint8_t* _component)
+{
+    if (_scalar.bytes != 0)
+    {
+        std::memcpy(_component + _scalar.offset, &_value, _scalar.bytes);
+        return;
+    }
+
+    const float value = _scalar.min + float(_value) / _scalar.scale;
+    std::memcpy(_component + _scalar.offset, &value, sizeof(float));
+}
+
+bool sameValues(const uint32_t* _a, const uint32_t* _b, uint32_t _count)
+{
+    return std::equal(_a, _a + _count, _b);
+}
+
+void writeValues(BitWriter& _writer, std::span<const ReplicationSchema::Scalar> _scalars,
+                 const ReplicationSchema::Component& _replicated, const uint32_t* _values)
+{
+    for (uint32_t i = 0; i < _replicated.scalarCount; ++i)
+    {
+        _writer.write(_values[i], _scalars[_replicated.firstScalar + i].bits);
+    }
+}
+
+void readValues(BitReader& _reader, std::span<const ReplicationSchema::Scalar> _scalars,
+                const ReplicationSchema::Component& _replicated, uint32_t* _values)
+{
+    for (uint32_t i = 0; i < _replicated.scalarCount; ++i)
+    {
+        _values[i] = _reader.read(_scalars[_replicated.firstScalar + i].bits);
+    }
+}
+
+// Appends entity _index of _source to _target.
+void copyEntity(const ReplicationServer::Frame& _source, size_t _index,
+                ReplicationServer::Frame& _target, size_t _stride)
+{
+    _target.entities.push_back(_source.entities[_index]);
+    _target.masks.push_back(_source.masks[_index]);
+    _target.values.insert(_target.values.end(), _source.values.begin() + _index * _stride,
+                          _source.values.begin() + (_index + 1) * _stride);
+}
+
+void clearFrame(ReplicationServer::Frame& _frame)
+{
+    _frame.sequence = 0;
+    _frame.frame = 0;
+    _frame.entities.clear();
+    _frame.masks.clear();
+    _frame.values.clear();
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ReplicationSchema
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ReplicationSchema::add(ecs::ComponentID _compID, std::span<const ReplicatedField> _fields)
+{
+    if (!m_components->isRegistered(_compID))
+    {
+        throw std::runtime_error("One or more components are not registered.");
+    }
+
+    const ecs::ComponentMeta& info = m_components->info(_compID);
+    if (info.shared) throw std::runtime_error("Shared components cannot be replicated.");
+    if (m_replicated.size() == k_maxComponents)
+    {
+        throw std::runtime_error("Too many replicated components.");
+    }
+    if (std::ranges::any_of(m_replicated, [&](const Component& _component)
+                            { return _component.id == _compID; }))
+    {
+        throw std::runtime_error("Component is already replicated.");
+    }
+
+    const ReplicatedField whole = ReplicatedField::raw(0, static_cast<uint32_t>(info.size));
+    const std::span<const ReplicatedField> fields =
+        _fields.empty() && info.size != 0 ? std::span<const ReplicatedField>(&whole, 1) : _fields;
+
+    std::vector<Scalar> scalars;
+    for (const ReplicatedField& field : fields)
+    {
+        if (size_t{field.offset} + field.size > info.size)
+        {
+            throw std::runtime_error("Replicated field leaves its component.");
+        }
+
+        if (field.bits == 0)
+        {
+            for (uint32_t offset = 0; offset < field.size; offset += 4)
+            {
+                const uint32_t bytes = std::min(4u, field.size - offset);
+                scalars.push_back({field.offset + offset, bytes * 8, bytes, 0.0f, 0.0f});
+            }
+            continue;
+        }
+
+        if (field.bits > 24 || field.size % sizeof(float) != 0 || !(field.max > field.min))
+        {
+            throw std::runtime_error("Quantized field is malformed.");
+        }
+
+        const float scale = float((uint64_t{1} << field.bits) - 1) / (field.max - field.min);
+        for (uint32_t offset = 0; offset < field.size; offset += sizeof(float))
+        {
+            scalars.push_back({field.offset + offset, field.bits, 0, field.min, scale});
+        }
+    }
+
+    m_replicated.push_back({_compID, static_cast<uint32_t>(m_scalars.size()),
+                            static_cast<uint32_t>(scalars.size())});
+    m_scalars.insert(m_scalars.end(), scalars.begin(), scalars.end());
+
+    // the layout both ends must agree on
+    const uint32_t layout[2] = {static_cast<uint32_t>(info.size),
+                                static_cast<uint32_t>(scalars.size())};
+    mix(m_hash, info.name.data(), info.name.size());
+    mix(m_hash, layout, sizeof(layout));
+    for (const Scalar& scalar : scalars) mix(m_hash, &scalar, sizeof(scalar));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ReplicationServer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ReplicationServer::ReplicationServer(ecs::EntityRegistry& _registry,
+                                     const ReplicationSchema& _schema, const SpatialIndex* _index)
+    : m_registry(&_registry), m_schema(&_schema), m_index(_index)
+{
+    const std::span<const ReplicationSchema::Component> components = _schema.getComponents();
+
+    try
+    {
+        for (uint32_t k = 0; k < components.size(); ++k)
+        {
+            m_observers.push_back(_registry.observe(
+                components[k].id, ecs::ComponentEvent::removed,
+                [this, k](std::span<const ecs::EntityID> _eids)
+                {
+                    for (ecs::EntityID eid : _eids) m_removed.emplace_back(eid, k);
+                }));
+        }
+    }
+    catch (...)
+    {
+        for (ecs::ObserverID observer : m_observers) m_registry->unobserve(observer);
+        throw;
+    }
+}
+
+ReplicationServer::~ReplicationServer()
+{
+    for (ecs::ObserverID observer : m_observers) m_registry->unobserve(observer);
+}
+
+size_t ReplicationServer::update()
+{
+    MOSAIC_TRACE_SITE_SCOPE("ReplicationServer::update", tools::TraceCategory::network);
+
+    const std::span<const ReplicationSchema::Component> components = m_schema->getComponents();
+    const size_t stride = m_schema->getScalars().size();
+
+    ++m_frame;
+    bool structural = false;
+
+    for (const auto& [eid, k] : m_removed)
+    {
+        const auto it = m_rows.find(eid);
+        if (it == m_rows.end()) continue;
+
+        Entity& entity = m_entities[it->second];
+        entity.mask &= ~(1u << k);
+        entity.changed[k] = m_frame;
+        structural |= entity.mask == 0;
+    }
+    m_removed.clear();
+
+    size_t count = 0;
+    for (uint32_t k = 0; k < components.size(); ++k)
+    {
+        const ReplicationSchema::Component& replicated = components[k];
+        m_scratch.resize(replicated.scalarCount);
+
+        m_registry->forEachChangedRawBlock(
+            replicated.id, m_since,
+            [&](size_t _count, ecs::RawColumn _metas, ecs::RawColumn _column)
+            {
+                for (size_t i = 0; i < _count; ++i)
+                {
+                    ecs::EntityMeta meta;
+                    std::memcpy(&meta, _metas[i], sizeof(meta));
+
+                    const auto [it, inserted] =
+                        m_rows.try_emplace(meta.id, static_cast<uint32_t>(m_entities.size()));
+                    if (inserted)
+                    {
+                        m_entities.push_back({meta, 0, {}});
+                        m_values.resize(m_values.size() + stride);
+                        structural = true;
+                    }
+
+                    Entity& entity = m_entities[it->second];
+                    if (entity.meta.gen != meta.gen) entity = {meta, 0, {}};
+
+                    uint32_t* values = m_values.data() + it->second * stride +
+                                       replicated.firstScalar;
+                    quantize(_column[i], replicated, m_scratch.data());
+
+                    // only the values that moved are stamped, a rewrite of the same ones is not
+                    const bool moved =
+                        !sameValues(values, m_scratch.data(), replicated.scalarCount);
+                    if ((entity.mask & (1u << k)) == 0 || moved)
+                    {
+                        std::copy_n(m_scratch.data(), replicated.scalarCount, values);
+                        entity.mask |= 1u << k;
+                        entity.changed[k] = m_frame;
+                    }
+                    ++count;
+                }
+            });
+    }
+
+    if (structural) sortRows();
+
+    // the writes of the current tick made after this update are seen by the next one
+    m_since = m_registry->tick() - 1;
+    return count;
+}
+
+void ReplicationServer::quantize(const uint8_t* _component,
+                                 const ReplicationSchema::Component& _replicated,
+                                 uint32_t* _values) const noexcept
+{
+    const std::span<const ReplicationSchema::Scalar> scalars = m_schema->getScalars();
+    for (uint32_t i = 0; i < _replicated.scalarCount; ++i)
+    {
+        _values[i] = quantizeScalar(scalars[_replicated.firstScalar + i], _component);
+    }
+}
+
+void ReplicationServer::sortRows()
+{
+    const size_t stride = m_schema->getScalars().size();
+
+    std::vector<uint32_t> order;
+    order.reserve(m_entities.size());
+    for (uint32_t row = 0; row < m_entities.size(); ++row)
+    {
+        if (m_entities[row].mask != 0) order.push_back(row);
+    }
+    std::ranges::sort(order, [&](uint32_t _a, uint32_t _b)
+                      { return m_entities[_a].meta.id < m_entities[_b].meta.id; });
+
+    std::vector<Entity> entities;
+    std::vector<uint32_t> values;
+    entities.reserve(order.size());
+    values.reserve(order.size() * stride);
+    m_rows.clear();
+
+    for (uint32_t row : order)
+    {
+        m_rows.try_emplace(m_entities[row].meta.id, static_cast<uint32_t>(entities.size()));
+        entities.push_back(m_entities[row]);
+        values.insert(values.end(), m_values.begin() + row * stride,
+                      m_values.begin() + (row + 1) * stride);
+    }
+
+    m_entities = std::move(entities);
+    m_values = std::move(values);
+}
+
+ReplicationServer::Client& ReplicationServer::getClient(ClientID _client)
+{
+    if (_client >= m_clients.size() || !m_clients[_client].connected)
+    {
+        throw std::runtime_error("Unknown replication client.");
+    }
+
+    return m_clients[_client];
+}
+
+ReplicationServer::ClientID ReplicationServer::addClient()
+{
+    auto it = std::ranges::find_if(m_clients, [](const Client& _client)
+                                   { return !_client.connected; });
+    if (it == m_clients.end()) it = m_clients.emplace(m_clients.end());
+
+    *it = Client{};
+    it->connected = true;
+
+    return static_cast<ClientID>(it - m_clients.begin());
+}
+
+void ReplicationServer::removeClient(ClientID _client)
+{
+    Client& client = getClient(_client);
+    client = Client{};
+}
+
+void ReplicationServer::setInterest(ClientID _client, const Aabb& _box)
+{
+    Client& client = getClient(_client);
+    client.hasInterest = true;
+    client.interest = _box;
+}
+
+void ReplicationServer::clearInterest(ClientID _client)
+{
+    getClient(_client).hasInterest = false;
+}
+
+void ReplicationServer::acknowledge(ClientID _client, uint32_t _sequence)
+{
+    Client& client = getClient(_client);
+
+    // late acknowledgments of older snapshots are ignored
+    if (_sequence > client.acknowledged && _sequence <= client.sequence)
+    {
+        client.acknowledged = _sequence;
+    }
+}
+
+size_t ReplicationServer::writeSnapshot(ClientID _client, std::vector<uint8_t>& _out)
+{
+    MOSAIC_TRACE_SITE_SCOPE("ReplicationServer::writeSnapshot", tools::TraceCategory::network);
+
+    Client& client = getClient(_client);
+    const std::span<const ReplicationSchema::Component> components = m_schema->getComponents();
+    const std::span<const ReplicationSchema::Scalar> scalars = m_schema->getScalars();
+    const size_t stride = scalars.size();
+
+    // a baseline still in the history and not about to be overwritten by this snapshot
+    static const Frame s_empty;
+    const Frame* baseline = &s_empty;
+    if (client.acknowledged != 0 && client.sequence + 1 - client.acknowledged < k_historySize)
+    {
+        baseline = &client.history[client.acknowledged % k_historySize];
+    }
+
+    Frame& next = client.history[(client.sequence + 1) % k_historySize];
+    clearFrame(next);
+    next.sequence = ++client.sequence;
+    next.frame = m_frame;
+
+    // the entities the client sees, in ID order
+    const bool filtered = client.hasInterest && m_index != nullptr;
+    if (filtered)
+    {
+        client.visible.clear();
+        m_index->query(client.interest, client.visible);
+        std::ranges::sort(client.visible, {}, &ecs::EntityMeta::id);
+    }
+
+    client.rows.clear();
+    for (uint32_t row = 0; row < m_entities.size(); ++row)
+    {
+        const ecs::EntityMeta meta = m_entities[row].meta;
+        if (filtered && m_index->contains(meta.id) &&
+            !std::ranges::binary_search(client.visible, meta.id, {}, &ecs::EntityMeta::id))
+        {
+            continue;
+        }
+
+        client.rows.push_back(row);
+        next.entities.push_back(meta);
+        next.masks.push_back(m_entities[row].mask);
+        next.values.insert(next.values.end(), m_values.begin() + row * stride,
+                           m_values.begin() + (row + 1) * stride);
+    }
+
+    const size_t headerOffset = _out.size();
+    ReplicationHeader header{k_replicationMagic,
+                             k_replicationVersion,
+                             m_schema->getHash(),
+                             next.sequence,
+                             baseline->sequence,
+                             m_frame,
+                             0,
+                             0};
+    _out.resize(headerOffset + sizeof(header));
+
+    BitWriter writer(_out);
+    ecs::EntityID previous = 0;
+    uint32_t count = 0;
+
+    const auto begin = [&](ecs::EntityID _eid, EntityOp _op)
+    {
+        writer.writeVarint(_eid - previous);
+        writer.write(static_cast<uint32_t>(_op), 2);
+        previous = _eid;
+        ++count;
+    };
+
+    const auto create = [&](size_t _index)
+    {
+        begin(next.entities[_index].id, EntityOp::create);
+        writer.writeVarint(next.entities[_index].gen);
+        writer.write(next.masks[_index], static_cast<uint32_t>(components.size()));
+
+        const uint32_t* values = next.values.data() + _index * stride;
+        for (uint32_t k = 0; k < components.size(); ++k)
+        {
+            if ((next.masks[_index] & (1u << k)) == 0) continue;
+            writeValues(writer, scalars, components[k], values + components[k].firstScalar);
+        }
+    };
+
+    size_t b = 0;
+    size_t n = 0;
+    while (b < baseline->entities.size() || n < next.entities.size())
+    {
+        const bool inBaseline = b < baseline->entities.size();
+        const bool inNext = n < next.entities.size();
+
+        if (inBaseline && (!inNext || baseline->entities[b].id < next.entities[n].id))
+        {
+            begin(baseline->entities[b].id, EntityOp::remove);
+            ++b;
+            continue;
+        }
+
+        if (!inBaseline || next.entities[n].id < baseline->entities[b].id ||
+            next.entities[n].gen != baseline->entities[b].gen)
+        {
+            // a recycled ID replaces the entity the client had
+            if (inBaseline && next.entities[n].id == baseline->entities[b].id) ++b;
+            create(n++);
+            continue;
+        }
+
+        // the components added, removed, or whose values moved since the baseline
+        const Entity& entity = m_entities[client.rows[n]];
+        const uint32_t* before = baseline->values.data() + b * stride;
+        const uint32_t* after = next.values.data() + n * stride;
+        const uint32_t presence = baseline->masks[b] ^ next.masks[n];
+
+        uint32_t changed = presence;
+        for (uint32_t k = 0; k < components.size(); ++k)
+        {
+            const uint32_t bit = 1u << k;
+            if ((next.masks[n] & presence & bit) != 0 || (next.masks[n] & bit) == 0) continue;
+            if (entity.changed[k] <= baseline->frame) continue;
+
+            const uint32_t first = components[k].firstScalar;
+            if (!sameValues(before + first, after + first, components[k].scalarCount))
+            {
+                changed |= bit;
+            }
+        }
+
+        if (changed != 0)
+        {
+            begin(next.entities[n].id, EntityOp::update);
+
+            for (uint32_t k = 0; k < components.size(); ++k)
+            {
+                const uint32_t bit = 1u << k;
+                writer.write((changed & bit) != 0, 1);
+                if ((changed & bit) == 0) continue;
+
+                const bool present = (next.masks[n] & bit) != 0;
+                writer.write(present, 1);
+                if (!present) continue;
+
+                const ReplicationSchema::Component& replicated = components[k];
+                const uint32_t* values = after + replicated.firstScalar;
+                if ((presence & bit) != 0)
+                {
+                    writeValues(writer, scalars, replicated, values);
+                    continue;
+                }
+
+                for (uint32_t i = 0; i < replicated.scalarCount; ++i)
+                {
+                    const bool moved = values[i] != before[replicated.firstScalar + i];
+                    writer.write(moved, 1);
+                    if (moved) writer.write(values[i], scalars[replicated.firstScalar + i].bits);
+                }
+            }
+        }
+
+        ++b;
+        ++n;
+    }
+
+    header.count = count;
+    header.bits = static_cast<uint32_t>(writer.bits());
+    writer.flush();
+    std::memcpy(_out.data() + headerOffset, &header, sizeof(header));
+
+    return count;
+}
+
+void ReplicationServer::writeSnapshots(exec::ThreadPool& _pool,
+                                       std::span<const ClientID> _clients,
+                                       std::span<std::vector<uint8_t>> _out)
+{
+    // validated up front, an unknown client must not throw on a worker
+    for (ClientID client : _clients) (void)getClient(client);
+
+    const size_t count = std::min(_clients.size(), _out.size());
+    exec::parallelFor(_pool, size_t{0}, count, size_t{1},
+                      [&](size_t _i) { writeSnapshot(_clients[_i], _out[_i]); });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ReplicationClient
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ReplicationClient::ReplicationClient(ecs::EntityRegistry& _registry,
+                                     const ReplicationSchema& _schema)
+    : m_registry(&_registry), m_schema(&_schema)
+{
+}
+
+uint32_t ReplicationClient::read(std::span<const uint8_t> _message)
+{
+    MOSAIC_TRACE_SITE_SCOPE("ReplicationClient::read", tools::TraceCategory::network);
+
+    if (_message.size() < sizeof(ReplicationHeader))
+    {
+        throw std::runtime_error("Snapshot message is truncated.");
+    }
+
+    ReplicationHeader header;
+    std::memcpy(&header, _message.data(), sizeof(header));
+
+    if (header.magic != k_replicationMagic)
+    {
+        throw std::runtime_error("Not a snapshot message.");
+    }
+    if (header.version != k_replicationVersion)
+    {
+        throw std::runtime_error("Unsupported replication protocol version.");
+    }
+    if (header.schemaHash != m_schema->getHash())
+    {
+        throw std::runtime_error("Snapshot message was encoded against another schema.");
+    }
+    if (header.sequence == 0) throw std::runtime_error("Snapshot message is malformed.");
+
+    // late, a newer snapshot was applied already
+    if (header.sequence <= m_current) return 0;
+
+    const Frame* baseline = nullptr;
+    static const Frame s_empty;
+    if (header.baseline == 0)
+    {
+        baseline = &s_empty;
+    }
+    else
+    {
+        baseline = &m_history[header.baseline % ReplicationServer::k_historySize];
+        if (baseline->sequence != header.baseline || header.baseline >= header.sequence)
+        {
+            throw std::runtime_error("Snapshot message is against an unknown baseline.");
+        }
+    }
+
+    const std::span<const ReplicationSchema::Component> components = m_schema->getComponents();
+    const std::span<const ReplicationSchema::Scalar> scalars = m_schema->getScalars();
+    const size_t stride = scalars.size();
+    const uint32_t maskBits = static_cast<uint32_t>(components.size());
+    const uint32_t validMask = maskBits == 32 ? ~0u : (1u << maskBits) - 1;
+
+    BitReader reader(_message.subspan(sizeof(header)), header.bits);
+
+    Frame next;
+    next.sequence = header.sequence;
+    next.frame = header.frame;
+
+    size_t b = 0;
+    uint64_t previous = 0;
+    for (uint32_t op = 0; op < header.count; ++op)
+    {
+        const uint64_t eid = previous + reader.readVarint();
+        const auto kind = static_cast<EntityOp>(reader.read(2));
+        if (eid > UINT32_MAX || (op != 0 && eid == previous) || kind > EntityOp::remove)
+        {
+            throw std::runtime_error("Snapshot message is malformed.");
+        }
+        previous = eid;
+
+        while (b < baseline->entities.size() && baseline->entities[b].id < eid)
+        {
+            copyEntity(*baseline, b++, next, stride);
+        }
+        const bool known = b < baseline->entities.size() && baseline->entities[b].id == eid;
+
+        if (kind == EntityOp::create)
+        {
+            if (known) ++b;
+
+            const ecs::EntityGen gen = reader.readVarint();
+            const uint32_t mask = reader.read(maskBits);
+            if ((mask & ~validMask) != 0 || mask == 0)
+            {
+                throw std::runtime_error("Snapshot message is malformed.");
+            }
+
+            next.entities.push_back({static_cast<ecs::EntityID>(eid), gen});
+            next.masks.push_back(mask);
+            next.values.resize(next.values.size() + stride);
+
+            uint32_t* values = next.values.data() + next.values.size() - stride;
+            for (uint32_t k = 0; k < components.size(); ++k)
+            {
+                if ((mask & (1u << k)) == 0) continue;
+                readValues(reader, scalars, components[k], values + components[k].firstScalar);
+            }
+            continue;
+        }
+
+        if (!known) throw std::runtime_error("Snapshot message updates an unknown entity.");
+
+        if (kind == EntityOp::remove)
+        {
+            ++b;
+            continue;
+        }
+
+        copyEntity(*baseline, b++, next, stride);
+        uint32_t& mask = next.masks.back();
+        uint32_t* values = next.values.data() + next.values.size() - stride;
+
+        for (uint32_t k = 0; k < components.size(); ++k)
+        {
+            const uint32_t bit = 1u << k;
+            if (reader.read(1) == 0) continue;
+
+            const ReplicationSchema::Component& replicated = components[k];
+            uint32_t* componentValues = values + replicated.firstScalar;
+
+            if (reader.read(1) == 0)
+            {
+                mask &= ~bit;
+                std::fill_n(componentValues, replicated.scalarCount, 0u);
+                continue;
+            }
+
+            if ((mask & bit) == 0)
+            {
+                mask |= bit;
+                readValues(reader, scalars, replicated, componentValues);
+                continue;
+            }
+
+            for (uint32_t i = 0; i < replicated.scalarCount; ++i)
+            {
+                if (reader.read(1) != 0)
+                {
+                    componentValues[i] = reader.read(scalars[replicated.firstScalar + i].bits);
+                }
+            }
+        }
+
+        if (mask == 0) throw std::runtime_error("Snapshot message is malformed.");
+    }
+
+    while (b < baseline->entities.size()) copyEntity(*baseline, b++, next, stride);
+
+    if (!reader.atEnd()) throw std::runtime_error("Snapshot message has trailing bits.");
+
+    // everything is decoded before the registry is touched
+    const Frame& current =
+        m_current != 0 ? m_history[m_current % ReplicationServer::k_historySize] : s_empty;
+    apply(current, next);
+
+    m_current = header.sequence;
+    m_history[header.sequence % ReplicationServer::k_historySize] = std::move(next);
+
+    return header.sequence;
+}
+
+std::optional<ecs::EntityMeta> ReplicationClient::getLocalEntity(
+    ecs::EntityID _serverEntity) const
+{
+    const auto it = m_locals.find(_serverEntity);
+    if (it == m_locals.end()) return std::nullopt;
+
+    return it->second;
+}
+
+void ReplicationClient::apply(const Frame& _previous, const Frame& _next)
+{
+    const std::span<const ReplicationSchema::Component> components = m_schema->getComponents();
+    const size_t stride = m_schema->getScalars().size();
+
+    std::vector<ecs::ComponentID> ids;
+
+    const auto destroy = [&](ecs::EntityID _serverEntity)
+    {
+        const auto it = m_locals.find(_serverEntity);
+        if (it == m_locals.end()) return;
+
+        m_registry->destroyEntity(it->second.id);
+        m_locals.erase(it);
+    };
+
+    const auto create = [&](size_t _index)
+    {
+        ids.clear();
+        for (uint32_t k = 0; k < components.size(); ++k)
+        {
+            if ((_next.masks[_index] & (1u << k)) != 0) ids.push_back(components[k].id);
+        }
+
+        const ecs::EntityMeta local = m_registry->createEntity(ids);
+        m_locals.insert_or_assign(_next.entities[_index].id, local);
+
+        const uint32_t* values = _next.values.data() + _index * stride;
+        for (uint32_t k = 0; k < components.size(); ++k)
+        {
+            if ((_next.masks[_index] & (1u << k)) == 0) continue;
+            write(local.id, components[k], values + components[k].firstScalar);
+        }
+    };
+
+    size_t p = 0;
+    size_t n = 0;
+    while (p < _previous.entities.size() || n < _next.entities.size())
+    {
+        const bool inPrevious = p < _previous.entities.size();
+        const bool inNext = n < _next.entities.size();
+
+        if (inPrevious && (!inNext || _previous.entities[p].id < _next.entities[n].id))
+        {
+            destroy(_previous.entities[p++].id);
+            continue;
+        }
+
+        if (!inPrevious || _next.entities[n].id < _previous.entities[p].id ||
+            _next.entities[n].gen != _previous.entities[p].gen)
+        {
+            if (inPrevious && _next.entities[n].id == _previous.entities[p].id)
+            {
+                destroy(_previous.entities[p++].id);
+            }
+            create(n++);
+            continue;
+        }
+
+        const ecs::EntityID local = m_locals.find(_next.entities[n].id)->second.id;
+        const uint32_t* before = _previous.values.data() + p * stride;
+        const uint32_t* after = _next.values.data() + n * stride;
+
+        for (uint32_t k = 0; k < components.size(); ++k)
+        {
+            const uint32_t bit = 1u << k;
+            const ReplicationSchema::Component& replicated = components[k];
+            const bool had = (_previous.masks[p] & bit) != 0;
+            const bool has = (_next.masks[n] & bit) != 0;
+
+            if (had && !has)
+            {
+                m_registry->removeComponent(local, replicated.id);
+            }
+            else if (!had && has)
+            {
+                m_registry->addComponent(local, replicated.id);
+                write(local, replicated, after + replicated.firstScalar);
+            }
+            else if (has && !sameValues(before + replicated.firstScalar,
+                                        after + replicated.firstScalar, replicated.scalarCount))
+            {
+                write(local, replicated, after + replicated.firstScalar);
+            }
+        }
+
+        ++p;
+        ++n;
+    }
+}
+
+void ReplicationClient::write(ecs::EntityID _local, const ReplicationSchema::Component& _replicated,
+                              const uint32_t* _values)
+{
+    uint8_t* component = m_registry->getComponent(_local, _replicated.id);
+    if (component == nullptr) return;
+
+    const std::span<const ReplicationSchema::Scalar> scalars = m_schema->getScalars();
+    for (uint32_t i = 0; i < _replicated.scalarCount; ++i)
+    {
+        dequantizeScalar(scalars[_replicated.firstScalar + i], _values[i], component);
+    }
+
+    m_registry->markChanged(_local, _replicated.id);
+}
+
+} // namespace scene
+} // namespace mosaic
@@ -0,0 +1,492 @@
+// The box tests are compiled for what every CPU of the target has
+#if !defined(SIMD_X86_SSE2) && (defined(__SSE2__) || defined(_M_X64))
+#define SIMD_X86_SSE2
+#elif !defined(SIMD_ARM_NEON) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define SIMD_ARM_NEON
+#endif
+
+#include <pieces/intrinsics/simd.hpp>
+
+#include "mosaic/scene/spatial_index.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "mosaic/exec/parallel_for.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+namespace
+{
+
+#if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1)
+
+struct Lanes
+{
+    static constexpr size_t k_width = 4;
+
+    using Float = __m128;
+    using Mask = __m128;
+
+    static Float load(const float* _p) { return _mm_loadu_ps(_p); }
+    static Float broadcast(float _value) { return _mm_set1_ps(_value); }
+    static Float sub(Float _a, Float _b) { return _mm_sub_ps(_a, _b); }
+    static Float mulAdd(Float _a, Float _b, Float _c) { return _mm_add_ps(_mm_mul_ps(_a, _b), _c); }
+    static Float max(Float _a, Float _b) { return _mm_max_ps(_a, _b); }
+
+    static Mask lessEqual(Float _a, Float _b) { return _mm_cmple_ps(_a, _b); }
+    static Mask both(Mask _a, Mask _b) { return _mm_and_ps(_a, _b); }
+
+    static uint32_t bits(Mask _mask) { return static_cast<uint32_t>(_mm_movemask_ps(_mask)); }
+};
+
+#elif defined(SIMD_ARM_NEON)
+
+struct Lanes
+{
+    static constexpr size_t k_width = 4;
+
+    using Float = float32x4_t;
+    using Mask = uint32x4_t;
+
+    static Float load(const float* _p) { return vld1q_f32(_p); }
+    static Float broadcast(float _value) { return vdupq_n_f32(_value); }
+    static Float sub(Float _a, Float _b) { return vsubq_f32(_a, _b); }
+    static Float mulAdd(Float _a, Float _b, Float _c) { return vmlaq_f32(_c, _a, _b); }
+    static Float max(Float _a, Float _b) { return vmaxq_f32(_a, _b); }
+
+    static Mask lessEqual(Float _a, Float _b) { return vcleq_f32(_a, _b); }
+    static Mask both(Mask _a, Mask _b) { return vandq_u32(_a, _b); }
+
+    static uint32_t bits(Mask _mask)
+    {
+        const uint32_t lanes[4] = {1, 2, 4, 8};
+        const uint32x4_t weighted = vandq_u32(_mask, vld1q_u32(lanes));
+#if defined(__aarch64__) || defined(_M_ARM64)
+        return vaddvq_u32(weighted);
+#else
+        const uint32x2_t sum = vpadd_u32(vget_low_u32(weighted), vget_high_u32(weighted));
+        return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#endif
+    }
+};
+
+#else
+
+struct Lanes
+{
+    static constexpr size_t k_width = 1;
+
+    using Float = float;
+    using Mask = bool;
+
+    static Float load(const float* _p) { return *_p; }
+    static Float broadcast(float _value) { return _value; }
+    static Float sub(Float _a, Float _b) { return _a - _b; }
+    static Float mulAdd(Float _a, Float _b, Float _c) { return _a * _b + _c; }
+    static Float max(Float _a, Float _b) { return _a < _b ? _b : _a; }
+
+    static Mask lessEqual(Float _a, Float _b) { return _a <= _b; }
+    static Mask both(Mask _a, Mask _b) { return _a && _b; }
+
+    static uint32_t bits(Mask _mask) { return _mask ? 1u : 0u; }
+};
+
+#endif
+
+// The cell coordinates are biased into 21 bits each
+constexpr float k_cellCoordinateBias = float(1 << 20);
+
+template <typename Cell>
+void appendLanes(uint32_t _bits, const Cell& _cell, size_t _first,
+                 std::vector<ecs::EntityMeta>& _entities)
+{
+    while (_bits != 0)
+    {
+        _entities.push_back(_cell.entities[_first + std::countr_zero(_bits)]);
+        _bits &= _bits - 1;
+    }
+}
+
+// The boxes of the cell overlapping [_min, _max]
+template <typename Cell>
+void testBoxes(const Cell& _cell, const Aabb& _box, std::vector<ecs::EntityMeta>& _entities)
+{
+    using Float = Lanes::Float;
+
+    const Float minX = Lanes::broadcast(_box.min.x);
+    const Float minY = Lanes::broadcast(_box.min.y);
+    const Float minZ = Lanes::broadcast(_box.min.z);
+    const Float maxX = Lanes::broadcast(_box.max.x);
+    const Float maxY = Lanes::broadcast(_box.max.y);
+    const Float maxZ = Lanes::broadcast(_box.max.z);
+
+    const size_t count = _cell.entities.size();
+    size_t i = 0;
+
+    for (; i + Lanes::k_width <= count; i += Lanes::k_width)
+    {
+        Lanes::Mask mask = Lanes::lessEqual(Lanes::load(_cell.minX.data() + i), maxX);
+        mask = Lanes::both(mask, Lanes::lessEqual(minX, Lanes::load(_cell.maxX.data() + i)));
+        mask = Lanes::both(mask, Lanes::lessEqual(Lanes::load(_cell.minY.data() + i), maxY));
+        mask = Lanes::both(mask, Lanes::lessEqual(minY, Lanes::load(_cell.maxY.data() + i)));
+        mask = Lanes::both(mask, Lanes::lessEqual(Lanes::load(_cell.minZ.data() + i), maxZ));
+        mask = Lanes::both(mask, Lanes::lessEqual(minZ, Lanes::load(_cell.maxZ.data() + i)));
+
+        appendLanes(Lanes::bits(mask), _cell, i, _entities);
+    }
+
+    for (; i < count; ++i)
+    {
+        const Aabb box{{_cell.minX[i], _cell.minY[i], _cell.minZ[i]},
+                       {_cell.maxX[i], _cell.maxY[i], _cell.maxZ[i]}};
+        if (box.overlaps(_box)) _entities.push_back(_cell.entities[i]);
+    }
+}
+
+// The boxes of the cell whose closest point to _center is within _radius
+template <typename Cell>
+void testSphere(const Cell& _cell, const glm::vec3& _center, float _radius,
+                std::vector<ecs::EntityMeta>& _entities)
+{
+    using Float = Lanes::Float;
+
+    const Float centerX = Lanes::broadcast(_center.x);
+    const Float centerY = Lanes::broadcast(_center.y);
+    const Float centerZ = Lanes::broadcast(_center.z);
+    const Float zero = Lanes::broadcast(0.0f);
+    const Float radius2 = Lanes::broadcast(_radius * _radius);
+
+    // the distance to the box along an axis, 0 inside its slab
+    auto axis = [&](const float* _min, const float* _max, Float _c)
+    {
+        return Lanes::max(Lanes::max(Lanes::sub(Lanes::load(_min), _c),
+                                     Lanes::sub(_c, Lanes::load(_max))),
+                          zero);
+    };
+
+    const size_t count = _cell.entities.size();
+    size_t i = 0;
+
+    for (; i + Lanes::k_width <= count; i += Lanes::k_width)
+    {
+        const Float dx = axis(_cell.minX.data() + i, _cell.maxX.data() + i, centerX);
+        const Float dy = axis(_cell.minY.data() + i, _cell.maxY.data() + i, centerY);
+        const Float dz = axis(_cell.minZ.data() + i, _cell.maxZ.data() + i, centerZ);
+
+        const Float distance2 =
+            Lanes::mulAdd(dx, dx, Lanes::mulAdd(dy, dy, Lanes::mulAdd(dz, dz, zero)));
+        appendLanes(Lanes::bits(Lanes::lessEqual(distance2, radius2)), _cell, i, _entities);
+    }
+
+    for (; i < count; ++i)
+    {
+        const glm::vec3 min(_cell.minX[i], _cell.minY[i], _cell.minZ[i]);
+        const glm::vec3 max(_cell.maxX[i], _cell.maxY[i], _cell.maxZ[i]);
+
+        const glm::vec3 d = glm::max(glm::max(min - _center, _center - max), glm::vec3(0.0f));
+        if (glm::dot(d, d) <= _radius * _radius) _entities.push_back(_cell.entities[i]);
+    }
+}
+
+// The transform and bounds of the entities to box, gathered serially
+struct BoxSource
+{
+    ecs::EntityMeta entity;
+    const TransformComponent* transform;
+    const BoundsComponent* bounds;
+};
+
+} // namespace
+
+Aabb computeWorldAabb(const TransformComponent& _transform,
+                      const BoundsComponent& _bounds) noexcept
+{
+    const glm::mat3 rotation = glm::mat3_cast(_transform.rotation);
+
+    // the extents of the rotated box along the world axes: |R| times the scaled extents
+    glm::mat3 absolute;
+    for (int column = 0; column < 3; ++column) absolute[column] = glm::abs(rotation[column]);
+
+    const glm::vec3 center = _transform.position + rotation * (_transform.scale * _bounds.center);
+    const glm::vec3 extent = absolute * glm::abs(_transform.scale * _bounds.extent);
+
+    return {center - extent, center + extent};
+}
+
+SpatialIndex::SpatialIndex(ecs::EntityRegistry& _registry, float _cellSize)
+    : m_registry(&_registry),
+      m_query(_registry.query<ecs::detail::Read<TransformComponent>,
+                              ecs::detail::Read<BoundsComponent>>()),
+      m_cellSize(std::max(_cellSize, 1e-3f))
+{
+    auto removed = [this](std::span<const ecs::EntityID> _eids)
+    { m_removed.insert(m_removed.end(), _eids.begin(), _eids.end()); };
+
+    m_transformObserver =
+        _registry.observe<TransformComponent>(ecs::ComponentEvent::removed, removed);
+    m_boundsObserver = _registry.observe<BoundsComponent>(ecs::ComponentEvent::removed, removed);
+
+    m_cells.emplace_back();
+}
+
+SpatialIndex::~SpatialIndex()
+{
+    m_registry->unobserve(m_transformObserver);
+    m_registry->unobserve(m_boundsObserver);
+}
+
+size_t SpatialIndex::update()
+{
+    if (!m_built)
+    {
+        rebuild();
+        return size();
+    }
+
+    for (ecs::EntityID eid : m_removed) erase(eid);
+    m_removed.clear();
+
+    size_t count = 0;
+    m_query.view().readOnly().forEach(
+        ecs::detail::Changed<TransformComponent, BoundsComponent>{}, m_since,
+        [&](ecs::EntityMeta _entity, const TransformComponent& _transform,
+            const BoundsComponent& _bounds)
+        {
+            insert(_entity, computeWorldAabb(_transform, _bounds));
+            ++count;
+        });
+
+    // the writes of the current tick made after this update are seen by the next one
+    m_since = m_registry->tick() - 1;
+    return count;
+}
+
+void SpatialIndex::rebuild()
+{
+    clear();
+
+    m_query.view().readOnly().forEach(
+        [&](ecs::EntityMeta _entity, const TransformComponent& _transform,
+            const BoundsComponent& _bounds)
+        { insert(_entity, computeWorldAabb(_transform, _bounds)); });
+}
+
+void SpatialIndex::rebuild(exec::ThreadPool& _pool)
+{
+    clear();
+
+    std::vector<BoxSource> sources;
+    sources.reserve(m_query.entityCount());
+    m_query.view().readOnly().forEach(
+        [&](ecs::EntityMeta _entity, const TransformComponent& _transform,
+            const BoundsComponent& _bounds)
+        { sources.push_back({_entity, &_transform, &_bounds}); });
+
+    std::vector<Aabb> boxes(sources.size());
+    exec::parallelFor(_pool, size_t{0}, sources.size(), size_t{1024},
+                      [&](size_t _i)
+                      {
+                          const BoxSource& source = sources[_i];
+                          boxes[_i] = computeWorldAabb(*source.transform, *source.bounds);
+                      });
+
+    for (size_t i = 0; i < sources.size(); ++i) insert(sources[i].entity, boxes[i]);
+}
+
+void SpatialIndex::query(const Aabb& _box, std::vector<ecs::EntityMeta>& _entities) const
+{
+    visitCandidates(_box, [&](const Cell& _cell) { testBoxes(_cell, _box, _entities); });
+}
+
+void SpatialIndex::querySphere(const glm::vec3& _center, float _radius,
+                               std::vector<ecs::EntityMeta>& _entities) const
+{
+    const Aabb box{_center - glm::vec3(_radius), _center + glm::vec3(_radius)};
+    visitCandidates(box, [&](const Cell& _cell)
+                    { testSphere(_cell, _center, _radius, _entities); });
+}
+
+void SpatialIndex::query(exec::ThreadPool& _pool, std::span<const Aabb> _boxes,
+                         std::span<std::vector<ecs::EntityMeta>> _results) const
+{
+    const size_t count = std::min(_boxes.size(), _results.size());
+    exec::parallelFor(_pool, size_t{0}, count, size_t{1},
+                      [&](size_t _i) { query(_boxes[_i], _results[_i]); });
+}
+
+size_t SpatialIndex::getCellCount() const noexcept
+{
+    return static_cast<size_t>(std::count_if(m_cells.begin() + 1, m_cells.end(),
+                                             [](const Cell& _cell)
+                                             { return !_cell.entities.empty(); }));
+}
+
+uint64_t SpatialIndex::cellKey(const glm::vec3& _center) const noexcept
+{
+    uint64_t key = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float cell = std::clamp(std::floor(_center[axis] / m_cellSize),
+                                      -k_cellCoordinateBias, k_cellCoordinateBias - 1.0f);
+        key |= static_cast<uint64_t>(cell + k_cellCoordinateBias) << (21 * axis);
+    }
+
+    return key;
+}
+
+uint32_t SpatialIndex::cellOf(const Aabb& _box)
+{
+    // fits in its cell grown by half a cell on every side, else tested by every query
+    const glm::vec3 extent = (_box.max - _box.min) * 0.5f;
+    if (std::max({extent.x, extent.y, extent.z}) > m_cellSize * 0.5f) return 0;
+
+    const auto [it, inserted] =
+        m_cellByKey.try_emplace(cellKey((_box.min + _box.max) * 0.5f), 0u);
+    if (inserted)
+    {
+        it->second = static_cast<uint32_t>(m_cells.size());
+        m_cells.emplace_back();
+    }
+
+    return it->second;
+}
+
+void SpatialIndex::insert(ecs::EntityMeta _entity, const Aabb& _box)
+{
+    const uint32_t cell = cellOf(_box);
+
+    auto it = m_locations.find(_entity.id);
+    if (it != m_locations.end() && it->second.cell != cell)
+    {
+        erase(_entity.id);
+        it = m_locations.end();
+    }
+
+    uint32_t row;
+    Cell& target = m_cells[cell];
+
+    if (it != m_locations.end())
+    {
+        row = it->second.row;
+    }
+    else
+    {
+        row = static_cast<uint32_t>(target.entities.size());
+        target.minX.emplace_back();
+        target.minY.emplace_back();
+        target.minZ.emplace_back();
+        target.maxX.emplace_back();
+        target.maxY.emplace_back();
+        target.maxZ.emplace_back();
+        target.entities.emplace_back();
+
+        m_locations.try_emplace(_entity.id, Location{cell, row});
+    }
+
+    target.minX[row] = _box.min.x;
+    target.minY[row] = _box.min.y;
+    target.minZ[row] = _box.min.z;
+    target.maxX[row] = _box.max.x;
+    target.maxY[row] = _box.max.y;
+    target.maxZ[row] = _box.max.z;
+    target.entities[row] = _entity;
+}
+
+void SpatialIndex::erase(ecs::EntityID _eid)
+{
+    auto it = m_locations.find(_eid);
+    if (it == m_locations.end()) return;
+
+    const Location location = it->second;
+    m_locations.erase(it);
+
+    // swap and pop, the last row moves into the freed one
+    Cell& cell = m_cells[location.cell];
+    const size_t last = cell.entities.size() - 1;
+
+    if (location.row != last)
+    {
+        cell.minX[location.row] = cell.minX[last];
+        cell.minY[location.row] = cell.minY[last];
+        cell.minZ[location.row] = cell.minZ[last];
+        cell.maxX[location.row] = cell.maxX[last];
+        cell.maxY[location.row] = cell.maxY[last];
+        cell.maxZ[location.row] = cell.maxZ[last];
+        cell.entities[location.row] = cell.entities[last];
+
+        m_locations.find(cell.entities[location.row].id)->second.row = location.row;
+    }
+
+    cell.minX.pop_back();
+    cell.minY.pop_back();
+    cell.minZ.pop_back();
+    cell.maxX.pop_back();
+    cell.maxY.pop_back();
+    cell.maxZ.pop_back();
+    cell.entities.pop_back();
+}
+
+void SpatialIndex::clear() noexcept
+{
+    // the cells emptied by moves are reclaimed here
+    m_cells.clear();
+    m_cells.emplace_back();
+    m_cellByKey.clear();
+    m_locations.clear();
+    m_removed.clear();
+
+    m_since = m_registry->tick() - 1;
+    m_built = true;
+}
+
+template <typename Test>
+void SpatialIndex::visitCandidates(const Aabb& _box, Test&& _test) const
+{
+    _test(m_cells[0]);
+    if (m_cellByKey.empty()) return;
+
+    // the cells whose loose bounds overlap the box
+    const float loose = m_cellSize * 0.5f;
+    glm::vec3 first;
+    glm::vec3 last;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        first[axis] = std::clamp(std::floor((_box.min[axis] - loose) / m_cellSize),
+                                 -k_cellCoordinateBias, k_cellCoordinateBias - 1.0f);
+        last[axis] = std::clamp(std::floor((_box.max[axis] + loose) / m_cellSize),
+                                -k_cellCoordinateBias, k_cellCoordinateBias - 1.0f);
+    }
+
+    const glm::vec3 span = last - first + glm::vec3(1.0f);
+
+    // every cell at once when the box covers more cells than there are
+    if (double(span.x) * span.y * span.z > double(m_cellByKey.size()))
+    {
+        for (size_t cell = 1; cell < m_cells.size(); ++cell) _test(m_cells[cell]);
+        return;
+    }
+
+    for (float z = first.z; z <= last.z; ++z)
+    {
+        for (float y = first.y; y <= last.y; ++y)
+        {
+            for (float x = first.x; x <= last.x; ++x)
+            {
+                const glm::vec3 center = (glm::vec3(x, y, z) + glm::vec3(0.5f)) * m_cellSize;
+
+                auto it = m_cellByKey.find(cellKey(center));
+                if (it != m_cellByKey.end()) _test(m_cells[it->second]);
+            }
+        }
+    }
+}
+
+} // namespace scene
+} // namespace mosaic
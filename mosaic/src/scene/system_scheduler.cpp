@@ -0,0 +1,121 @@
+#include "mosaic/scene/system_scheduler.hpp"
+
+#include <algorithm>
+
+#include "mosaic/exec/thread_pool.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+bool SystemScheduler::conflicts(SystemID _first, SystemID _second) const
+{
+    const System& first = m_systems.at(_first);
+    const System& second = m_systems.at(_second);
+
+    if (first.structural || second.structural) return true;
+
+    return first.writes.intersects(second.writes) || first.writes.intersects(second.reads) ||
+           second.writes.intersects(first.reads);
+}
+
+SystemID SystemScheduler::insertSystem(System&& _system)
+{
+    const SystemID id = static_cast<SystemID>(m_systems.size());
+    m_systems.push_back(std::move(_system));
+
+    // after the last stage holding a system it conflicts with (the last one for a structural
+    // system, which conflicts with every other)
+    size_t stage = m_stages.size();
+    while (stage > 0 && std::ranges::none_of(m_stages[stage - 1], [&](SystemID _other)
+                                             { return conflicts(_other, id); }))
+    {
+        --stage;
+    }
+
+    if (stage == m_stages.size()) m_stages.emplace_back();
+    m_stages[stage].push_back(id);
+    m_systems[id].stats.stage = static_cast<uint32_t>(stage);
+
+    return id;
+}
+
+void SystemScheduler::run(exec::ThreadPool& _pool, ecs::EntityRegistry& _registry)
+{
+    for (const std::vector<SystemID>& stage : m_stages)
+    {
+        try
+        {
+            ecs::detail::dispatchTasks(_pool, stage.size(), [&](size_t _index)
+                                       { runSystem(m_systems[stage[_index]], _registry); });
+        }
+        catch (...)
+        {
+            discardStage(stage);
+            throw;
+        }
+
+        playbackStage(stage, _registry);
+    }
+}
+
+void SystemScheduler::run(ecs::EntityRegistry& _registry)
+{
+    for (const std::vector<SystemID>& stage : m_stages)
+    {
+        try
+        {
+            for (SystemID id : stage) runSystem(m_systems[id], _registry);
+        }
+        catch (...)
+        {
+            discardStage(stage);
+            throw;
+        }
+
+        playbackStage(stage, _registry);
+    }
+}
+
+void SystemScheduler::runSystem(System& _system, ecs::EntityRegistry& _registry)
+{
+    SystemContext context{_registry, _system.commands};
+
+    const auto start = std::chrono::steady_clock::now();
+    MOSAIC_TRACE_BEGIN(_system.name, tools::TraceCategory::scope);
+
+    try
+    {
+        _system.function(context);
+    }
+    catch (...)
+    {
+        MOSAIC_TRACE_END();
+        throw;
+    }
+
+    MOSAIC_TRACE_END();
+    _system.stats.duration = std::chrono::steady_clock::now() - start;
+}
+
+void SystemScheduler::playbackStage(const std::vector<SystemID>& _stage,
+                                    ecs::EntityRegistry& _registry)
+{
+    MOSAIC_TRACE_SCOPE("SystemScheduler::playback");
+
+    for (SystemID id : _stage)
+    {
+        ecs::EntityCommandBuffer& commands = m_systems[id].commands;
+        if (!commands.empty()) commands.playback(_registry);
+    }
+}
+
+void SystemScheduler::discardStage(const std::vector<SystemID>& _stage) noexcept
+{
+    for (SystemID id : _stage) m_systems[id].commands.clear();
+}
+
+} // namespace scene
+} // namespace mosaic
@@ -0,0 +1,222 @@
+#include "mosaic/scene/world_streaming.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <system_error>
+
+#include "mosaic/tools/logger.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace scene
+{
+
+namespace
+{
+
+// From the point to the box, 0 inside.
+float distanceToBox(const glm::vec3& _point, const Aabb& _box) noexcept
+{
+    const glm::vec3 outside =
+        glm::max(glm::max(_box.min - _point, _point - _box.max), glm::vec3(0.0f));
+    return glm::length(outside);
+}
+
+bool isResident(WorldCellState _state) noexcept
+{
+    return _state == WorldCellState::loading || _state == WorldCellState::activating ||
+           _state == WorldCellState::active;
+}
+
+} // namespace
+
+WorldStreamer::WorldStreamer(ecs::EntityRegistry& _registry, exec::IoService& _io,
+                             const WorldStreamingSettings& _settings)
+    : m_registry(&_registry), m_io(&_io), m_settings(_settings)
+{
+    m_settings.unloadDistance = std::max(m_settings.unloadDistance, m_settings.loadDistance);
+    m_settings.activationSlice = std::max<size_t>(m_settings.activationSlice, 1);
+}
+
+WorldStreamer::~WorldStreamer()
+{
+    for (Cell& cell : m_cells)
+    {
+        if (cell.state == WorldCellState::loading) cell.read.cancel();
+    }
+}
+
+WorldCellId WorldStreamer::addCell(const Aabb& _bounds, std::filesystem::path _path)
+{
+    Cell& cell = m_cells.emplace_back();
+    cell.bounds = _bounds;
+
+    // a missing file fails when the cell is first read
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(_path, error);
+    cell.size = error ? 0 : uint64_t(size);
+    cell.path = std::move(_path);
+
+    return WorldCellId(m_cells.size() - 1);
+}
+
+size_t WorldStreamer::update(const glm::vec3& _camera)
+{
+    MOSAIC_TRACE_SITE_SCOPE("WorldStreamer::update", tools::TraceCategory::io);
+
+    plan(_camera);
+    poll();
+    return activate();
+}
+
+void WorldStreamer::unload(WorldCellId _cell)
+{
+    Cell& cell = m_cells[_cell];
+    if (isResident(cell.state)) m_committed -= cell.size;
+
+    if (cell.state == WorldCellState::loading) cell.read.cancel();
+    cell.read = {};
+
+    // the entities destroyed meanwhile are skipped, their IDs may have been reused
+    std::vector<ecs::EntityID> eids;
+    for (const ecs::EntityMeta& entity : cell.entities)
+    {
+        if (m_registry->isEntityValid(entity)) eids.push_back(entity.id);
+    }
+    if (!eids.empty()) m_registry->destroyEntityBulk(eids);
+
+    cell.entities = {};
+    cell.bytes = {};
+    cell.cursor = {};
+    cell.state = WorldCellState::unloaded;
+}
+
+void WorldStreamer::plan(const glm::vec3& _camera)
+{
+    m_order.resize(m_cells.size());
+    for (WorldCellId id = 0; id < m_cells.size(); ++id)
+    {
+        m_cells[id].distance = distanceToBox(_camera, m_cells[id].bounds);
+        m_order[id] = id;
+    }
+
+    std::sort(m_order.begin(), m_order.end(),
+              [this](WorldCellId _a, WorldCellId _b)
+              {
+                  return m_cells[_a].distance < m_cells[_b].distance ||
+                         (m_cells[_a].distance == m_cells[_b].distance && _a < _b);
+              });
+
+    // the nearest cells first, until the budget: a resident cell only leaves past unloadDistance
+    // or when nearer ones need its memory
+    uint64_t kept = 0;
+    for (WorldCellId id : m_order)
+    {
+        Cell& cell = m_cells[id];
+        if (cell.state == WorldCellState::failed) continue;
+
+        const bool resident = isResident(cell.state);
+        const float limit = resident ? m_settings.unloadDistance : m_settings.loadDistance;
+
+        if (cell.distance > limit || kept + cell.size > m_settings.budget)
+        {
+            if (resident) unload(id);
+            continue;
+        }
+
+        kept += cell.size;
+        if (resident) continue;
+
+        try
+        {
+            auto file = exec::IoFile::open(cell.path);
+            cell.size = file->getSize();
+
+            cell.read = m_io->readAsync(file, 0, size_t(cell.size), exec::TaskPriority::background);
+            cell.state = WorldCellState::loading;
+            m_committed += cell.size;
+        }
+        catch (const std::exception& _error)
+        {
+            MOSAIC_ERROR("Failed to stream the world cell {}: {}", cell.path.string(),
+                         _error.what());
+            cell.state = WorldCellState::failed;
+        }
+    }
+}
+
+void WorldStreamer::poll()
+{
+    for (WorldCellId id : m_order)
+    {
+        Cell& cell = m_cells[id];
+        if (cell.state != WorldCellState::loading || !cell.read.isReady()) continue;
+
+        try
+        {
+            cell.bytes = cell.read.get();
+            cell.read = {};
+            cell.cursor = {};
+            cell.state = WorldCellState::activating;
+        }
+        catch (const std::exception& _error)
+        {
+            MOSAIC_ERROR("Failed to read the world cell {}: {}", cell.path.string(),
+                         _error.what());
+            fail(cell);
+        }
+    }
+}
+
+size_t WorldStreamer::activate()
+{
+    const auto deadline = std::chrono::steady_clock::now() + m_settings.activationBudget;
+    size_t inserted = 0;
+
+    // the nearest first, a slice at least a frame
+    for (WorldCellId id : m_order)
+    {
+        Cell& cell = m_cells[id];
+        if (cell.state != WorldCellState::activating) continue;
+
+        try
+        {
+            for (;;)
+            {
+                const size_t before = cell.entities.size();
+                const bool done = m_registry->appendSnapshot(cell.bytes, cell.cursor,
+                                                             m_settings.activationSlice,
+                                                             cell.entities);
+                inserted += cell.entities.size() - before;
+
+                if (done)
+                {
+                    cell.bytes = {};
+                    cell.state = WorldCellState::active;
+                    break;
+                }
+                if (std::chrono::steady_clock::now() >= deadline) return inserted;
+            }
+        }
+        catch (const std::exception& _error)
+        {
+            MOSAIC_ERROR("Failed to activate the world cell {}: {}", cell.path.string(),
+                         _error.what());
+            fail(cell);
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline) break;
+    }
+
+    return inserted;
+}
+
+void WorldStreamer::fail(Cell& _cell)
+{
+    unload(WorldCellId(&_cell - m_cells.data()));
+    _cell.state = WorldCellState::failed;
+}
+
+} // namespace scene
+} // namespace mosaic
@@ -8,6 +8,12 @@
 #include <sstream>
 #include <vector>
 #include <cassert>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <atomic>
 
 #ifndef MOSAIC_ARCH_ARM64
 #include <stacktrace>
@@ -24,6 +30,7 @@
 #include <pieces/core/result.hpp>
 
 #include "mosaic/core/sys_console.hpp"
+#include "mosaic/core/ticks.hpp"
 
 namespace mosaic
 {
@@ -32,106 +39,576 @@ namespace tools
 
 Logger* Logger::s_instance = nullptr;
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordQueue - Bounded MPSC ring of the asynchronous mode
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Sequence per slot (Vyukov): a producer claims a position by CAS, fills the record and
+// publishes it through the sequence of its slot; the logging thread frees it a lap ahead.
+struct Logger::RecordQueue
+{
+    static constexpr uint64_t k_capacity = 1024;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        LogRecord record;
+    };
+
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<uint64_t> enqueue{0};
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<uint64_t> written{0}; // for flush()
+
+    const std::unique_ptr<Slot[]> slots;
+
+    RecordQueue() : slots(new Slot[k_capacity])
+    {
+        for (uint64_t i = 0; i < k_capacity; ++i) slots[i].sequence.store(i);
+    }
+};
+
+// Set on the logging thread, whose logs (from the sinks) are written in place
+static thread_local bool t_writing = false;
+
+// The message formatted by the caller, in the payload when it fits
+static std::string formatText(const std::byte* _payload)
+{
+    const std::byte* in = _payload;
+    return std::string(detail::LogArgument<std::string_view>::decode(in));
+}
+
+static std::string formatOwnedText(const std::byte* _payload)
+{
+    std::string* text;
+    std::memcpy(&text, _payload, sizeof(text));
+
+    return std::move(*std::unique_ptr<std::string>(text));
+}
+
+// The same second as the message before most of the time
+static std::string_view formatTimestamp(std::chrono::system_clock::time_point _time)
+{
+    struct Cache
+    {
+        std::time_t second = -1;
+        char text[32] = {};
+    };
+
+    thread_local Cache t_cache;
+
+    const std::time_t now_c = std::chrono::system_clock::to_time_t(_time);
+
+    if (now_c != t_cache.second)
+    {
+        std::tm now_tm;
+
+#ifdef MOSAIC_COMPILER_MSVC
+        localtime_s(&now_tm, &now_c);
+#else
+        localtime_r(&now_c, &now_tm);
+#endif
+
+        std::strftime(t_cache.text, sizeof(t_cache.text), "%Y-%m-%d %H:%M:%S", &now_tm);
+        t_cache.second = now_c;
+    }
+
+    return t_cache.text;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// LogHistory - Ring of the last messages of a thread
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Written by one thread at a time (its own, or the logging thread), under a lock of its own that
+// is only contended by the readers: no logging call shares a lock for the history.
+class LogHistory
+{
+   private:
+    struct Entry
+    {
+        uint16_t size;
+        char text[k_logHistoryEntrySize - sizeof(uint16_t)];
+    };
+
+    mutable std::mutex m_mutex;
+    const std::unique_ptr<Entry[]> m_entries;
+    const uint32_t m_capacity;
+    uint64_t m_count = 0; // pushed since the last clear
+
+    const std::thread::id m_tid;
+    std::atomic<bool> m_exited{false};
+
+   public:
+    LogHistory(uint16_t _capacity, std::thread::id _tid)
+        : m_entries(new Entry[std::max<uint16_t>(_capacity, 1)]),
+          m_capacity(std::max<uint16_t>(_capacity, 1)),
+          m_tid(_tid)
+    {
+    }
+
+    void push(std::string_view _message) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        Entry& entry = m_entries[m_count % m_capacity];
+        entry.size = static_cast<uint16_t>(std::min(_message.size(), sizeof(entry.text)));
+        std::memcpy(entry.text, _message.data(), entry.size);
+
+        ++m_count;
+    }
+
+    void clear() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_count = 0;
+    }
+
+    // Oldest first
+    [[nodiscard]] std::vector<std::string> read() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const uint64_t first = m_count > m_capacity ? m_count - m_capacity : 0;
+
+        std::vector<std::string> messages;
+        messages.reserve(m_count - first);
+
+        for (uint64_t i = first; i < m_count; ++i)
+        {
+            const Entry& entry = m_entries[i % m_capacity];
+            messages.emplace_back(entry.text, entry.size);
+        }
+
+        return messages;
+    }
+
+    [[nodiscard]] std::thread::id getTid() const noexcept { return m_tid; }
+
+    void setExited() noexcept { m_exited.store(true, std::memory_order_release); }
+    [[nodiscard]] bool hasExited() const noexcept
+    {
+        return m_exited.load(std::memory_order_acquire);
+    }
+};
+
+// Histories of exited threads kept for a crash dump, the oldest dropped past it
+static constexpr size_t k_exitedHistories = 16;
+
+// Incremented by Logger::initialize(), for the threads that logged to a previous instance
+static std::atomic<uint64_t> s_historyEpoch{0};
+
+// The history of the thread, also owned by the Logger; marked at the exit of the thread
+struct LocalHistory
+{
+    std::shared_ptr<LogHistory> history;
+    uint64_t epoch = 0;
+
+    ~LocalHistory()
+    {
+        if (!history) return;
+
+        // no record of the thread is left for the logging thread to write into the ring
+        Logger* logger = Logger::getInstance();
+        if (logger && epoch == s_historyEpoch.load(std::memory_order_acquire)) logger->flush();
+
+        history->setExited();
+    }
+};
+
+static thread_local LocalHistory t_history;
+
+// The history of the calling thread in the current Logger, if it logged
+static LogHistory* currentHistory() noexcept
+{
+    if (t_history.epoch != s_historyEpoch.load(std::memory_order_acquire)) return nullptr;
+
+    return t_history.history.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Logger
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Logger::Logger() = default;
+Logger::~Logger() = default;
+
 bool Logger::initialize(const Config& _config) noexcept
 {
     assert(s_instance == nullptr && "Logger already exists!");
     s_instance = new Logger();
+
+    auto& instance = *s_instance;
+    instance.m_config = _config;
+
+    s_historyEpoch.fetch_add(1, std::memory_order_acq_rel);
+
+    if (!_config.async) return true;
+
+    try
+    {
+        instance.m_queue = std::make_unique<RecordQueue>();
+        instance.m_writer = std::jthread([&instance] { instance.runWriter(); });
+        instance.m_async = true;
+    }
+    catch (const std::exception& e)
+    {
+        core::SystemConsole::printError(
+            fmt::format("Logger: no logging thread, logging synchronously: {}", e.what()));
+    }
+
     return true;
 }
 
 void Logger::shutdown() noexcept
 {
     assert(s_instance != nullptr && "Logger does not exist!");
+
+    auto& instance = *s_instance;
+
+    if (instance.m_async)
+    {
+        // after every record logged before
+        LogRecord* stop = instance.acquireRecord(LogLevel::info);
+        stop->format = nullptr;
+        instance.commitRecord(*stop);
+
+        instance.m_writer.join();
+        instance.m_async = false;
+    }
+
     delete s_instance;
     s_instance = nullptr;
 }
 
-void Logger::logInternal(LogLevel _level, std::string _formattedMessage) noexcept
+void Logger::flush() noexcept
 {
-    // Prepend log level if requested
-    if (m_config.showLevel)
+    if (!m_async || t_writing) return;
+
+    auto& queue = *m_queue;
+
+    const uint64_t target = queue.enqueue.load(std::memory_order_acquire);
+    uint64_t written = queue.written.load(std::memory_order_acquire);
+
+    while (written < target)
     {
-        _formattedMessage =
-            fmt::format("[{}] {}", c_levelNames[static_cast<int>(_level)], _formattedMessage);
+        queue.written.wait(written, std::memory_order_acquire);
+        written = queue.written.load(std::memory_order_acquire);
     }
+}
 
-    auto tid = std::this_thread::get_id(); // Moved outside the scope for reuse
+LogRecord* Logger::acquireRecord(LogLevel _level) noexcept
+{
+    // the ring may be full of records waiting for the sink logging
+    if (t_writing) return nullptr;
 
-    // Prepend thread ID if requested
-    if (m_config.showTid)
+    auto& queue = *m_queue;
+    uint64_t position = queue.enqueue.load(std::memory_order_relaxed);
+
+    for (;;)
     {
-        std::ostringstream oss;
-        oss << tid; // Trick to get a readable thread ID
+        auto& slot = queue.slots[position & (RecordQueue::k_capacity - 1)];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto lag = static_cast<int64_t>(sequence - position);
+
+        if (lag == 0)
+        {
+            if (queue.enqueue.compare_exchange_weak(position, position + 1,
+                                                    std::memory_order_relaxed))
+            {
+                LogRecord& record = slot.record;
+                record.time = core::Ticks::now();
+                record.tid = std::this_thread::get_id();
+                record.position = position;
+                record.history = localHistory();
+                record.level = _level;
+
+                return &record;
+            }
+        }
+        else if (lag < 0)
+        {
+            // full, the record a lap behind is not written yet
+            std::this_thread::yield();
+            position = queue.enqueue.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            position = queue.enqueue.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::commitRecord(LogRecord& _record) noexcept
+{
+    auto& queue = *m_queue;
+
+    // the record is the logging thread's once published
+    const uint64_t position = _record.position;
+    const bool critical = _record.level == LogLevel::critical;
+
+    queue.slots[position & (RecordQueue::k_capacity - 1)].sequence.store(
+        position + 1, std::memory_order_release);
+    queue.enqueue.notify_one();
+
+    if (critical) flush();
+}
+
+void Logger::runWriter() noexcept
+{
+    // records taken from the ring for one writeBatch() call of the sinks, at most
+    constexpr size_t k_batchSize = 64;
+
+    auto& queue = *m_queue;
+    uint64_t position = 0;
+
+    std::vector<LogEntry> batch;
+    std::vector<LogHistory*> histories;
+    batch.reserve(k_batchSize);
+    histories.reserve(k_batchSize);
+
+    t_writing = true;
+
+    for (;;)
+    {
+        const uint64_t first = position;
+        bool stop = false;
+
+        while (batch.size() < k_batchSize)
+        {
+            auto& slot = queue.slots[position & (RecordQueue::k_capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) break;
+
+            stop = slot.record.format == nullptr;
+            if (!stop) takeRecord(slot.record, batch, histories);
+
+            slot.sequence.store(position + RecordQueue::k_capacity, std::memory_order_release);
+            ++position;
+
+            if (stop) break;
+        }
+
+        if (position == first)
+        {
+            // nothing logged, or claimed and not published yet
+            if (queue.enqueue.load(std::memory_order_acquire) == position)
+                queue.enqueue.wait(position, std::memory_order_acquire);
+            else
+                std::this_thread::yield();
+
+            continue;
+        }
+
+        writeBatch(batch, histories);
+        batch.clear();
+        histories.clear();
 
-        _formattedMessage = fmt::format("[{}] {}", oss.str(), _formattedMessage);
+        queue.written.store(position, std::memory_order_release);
+        queue.written.notify_all();
+
+        if (stop) return;
     }
+}
 
-    // Prepend timestamp if requested
-    if (m_config.showTimestamp)
+void Logger::takeRecord(const LogRecord& _record, std::vector<LogEntry>& _batch,
+                        std::vector<LogHistory*>& _histories) noexcept
+{
+    try
     {
-        auto now = std::chrono::system_clock::now();
-        const std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-        std::tm now_tm;
+        const std::string message = _record.format(_record.payload);
 
-#ifdef MOSAIC_COMPILER_MSVC
-        localtime_s(&now_tm, &now_c);
-#else
-        localtime_r(&now_c, &now_tm);
-#endif
+        _batch.push_back({_record.level, decorate(_record.level, message, _record.tid,
+                                                  _record.time)});
+        _histories.push_back(_record.history);
+    }
+    catch (const std::exception& e)
+    {
+        core::SystemConsole::printError(e.what());
+    }
+}
+
+void Logger::writeBatch(const std::vector<LogEntry>& _batch,
+                        const std::vector<LogHistory*>& _histories) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sinksMutex);
 
-        char timeBuffer[100];
-        std::strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", &now_tm);
+        for (const auto& [name, sink] : m_sinks)
+        {
+            try
+            {
+                sink->writeBatch(_batch);
+            }
+            catch (const std::exception& e)
+            {
+                core::SystemConsole::printError(
+                    fmt::format("Sink '{}' failed to write: {}", name, e.what()));
+            }
+        }
+    }
 
-        _formattedMessage = fmt::format("[{}] {}", timeBuffer, _formattedMessage);
+    for (size_t i = 0; i < _batch.size(); ++i)
+    {
+        if (_histories[i]) _histories[i]->push(_batch[i].message);
     }
+}
+
+void Logger::logInternal(LogLevel _level, std::string _formattedMessage) noexcept
+{
+    try
+    {
+        const auto tid = std::this_thread::get_id();
 
 #ifndef MOSAIC_ARCH_ARM64
-    // Append stack trace if requested (platform-dependent, stubbed here)
-    if (m_config.showStackTrace)
+        // Append stack trace if requested, of the calling thread in both modes
+        if (m_config.showStackTrace)
+        {
+            std::ostringstream oss;
+            oss << std::stacktrace::current(); // Trick to get a readable stack trace
+
+            _formattedMessage += fmt::format("\n[Stack Trace]\n{}", oss.str());
+        }
+#endif
+
+        if (m_async)
+        {
+            if (LogRecord* record = acquireRecord(_level))
+            {
+                const size_t size = sizeof(uint32_t) + _formattedMessage.size();
+
+                if (size <= LogRecord::k_payloadSize)
+                {
+                    std::byte* out = record->payload;
+                    detail::LogArgument<std::string_view>::encode(out, _formattedMessage);
+                    record->format = &formatText;
+                }
+                else
+                {
+                    auto* text = new (std::nothrow) std::string(std::move(_formattedMessage));
+                    if (!text) text = new (std::nothrow) std::string("(log message lost)");
+
+                    std::memcpy(record->payload, &text, sizeof(text));
+                    record->format = &formatOwnedText;
+                }
+
+                commitRecord(*record);
+                return;
+            }
+        }
+
+        emit(_level, decorate(_level, _formattedMessage, tid, core::Ticks::now()));
+    }
+    catch (const std::exception& e)
+    {
+        core::SystemConsole::printError(e.what());
+    }
+}
+
+std::string Logger::decorate(LogLevel _level, std::string_view _message, std::thread::id _tid,
+                             int64_t _ticks) const
+{
+    std::string decorated;
+    decorated.reserve(_message.size() + 48);
+
+    auto out = std::back_inserter(decorated);
+
+    if (m_config.showTimestamp) fmt::format_to(out, "[{}] ", formatTimestamp(core::Ticks::toSystem(_ticks)));
+
+    if (m_config.showTid)
     {
         std::ostringstream oss;
-        oss << std::stacktrace::current(); // Trick to get a readable stack trace
+        oss << _tid; // Trick to get a readable thread ID
 
-        _formattedMessage += fmt::format("\n[Stack Trace]\n{}", oss.str());
+        fmt::format_to(out, "[{}] ", oss.str());
     }
-#endif
 
-    for (const auto& [name, sink] : m_sinks)
+    if (m_config.showLevel) fmt::format_to(out, "[{}] ", c_levelNames[static_cast<int>(_level)]);
+
+    decorated += _message;
+
+    return decorated;
+}
+
+void Logger::emit(LogLevel _level, const std::string& _message)
+{
+    for (const auto& [name, sink] : m_sinks) sink->write(_level, _message);
+
+    if (LogHistory* history = localHistory()) history->push(_message);
+}
+
+LogHistory* Logger::localHistory() noexcept
+{
+    if (LogHistory* history = currentHistory()) return history;
+
+    try
     {
-        switch (_level)
+        auto history = std::make_shared<LogHistory>(m_config.historySize,
+                                                    std::this_thread::get_id());
+
+        // the only lock shared by the threads, once per thread
+        std::lock_guard<std::mutex> lock(m_historiesMutex);
+
+        const auto exited = std::ranges::count_if(m_histories, [](const auto& _history)
+                                                  { return _history->hasExited(); });
+
+        if (static_cast<size_t>(exited) >= k_exitedHistories)
         {
-            case LogLevel::trace:
-                sink->trace(_formattedMessage);
-                break;
-            case LogLevel::debug:
-                sink->debug(_formattedMessage);
-                break;
-            case LogLevel::info:
-                sink->info(_formattedMessage);
-                break;
-            case LogLevel::warn:
-                sink->warn(_formattedMessage);
-                break;
-            case LogLevel::error:
-                sink->error(_formattedMessage);
-                break;
-            case LogLevel::critical:
-                sink->critical(_formattedMessage);
-                break;
-            default:
-                break;
+            m_histories.erase(std::ranges::find_if(m_histories, [](const auto& _history)
+                                                   { return _history->hasExited(); }));
         }
+
+        m_histories.push_back(history);
+
+        t_history.history = std::move(history);
+        t_history.epoch = s_historyEpoch.load(std::memory_order_acquire);
+
+        return t_history.history.get();
     }
+    catch (const std::exception& e)
+    {
+        core::SystemConsole::printError(e.what());
+        return nullptr;
+    }
+}
 
-    if (m_history.find(tid) == m_history.end())
+std::vector<std::string> Logger::getHistory() const noexcept
+{
+    try
     {
-        std::lock_guard<std::mutex> lock(m_historyMutex);
-        m_history[tid] = std::vector<std::string>();
+        if (LogHistory* history = currentHistory()) return history->read();
     }
+    catch (const std::exception& e)
+    {
+        core::SystemConsole::printError(e.what());
+    }
+
+    return {};
+}
+
+void Logger::clearHistory() noexcept
+{
+    if (LogHistory* history = currentHistory()) history->clear();
+}
+
+std::vector<LogThreadHistory> Logger::getHistories() const noexcept
+{
+    std::vector<LogThreadHistory> histories;
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_historiesMutex);
+
+        histories.reserve(m_histories.size());
 
-    if (m_history.at(tid).size() >= m_config.historySize) clearHistory();
+        for (const auto& history : m_histories)
+        {
+            histories.push_back({history->getTid(), history->hasExited(), history->read()});
+        }
+    }
+    catch (const std::exception& e)
+    {
+        core::SystemConsole::printError(e.what());
+    }
 
-    m_history.at(tid).emplace_back(_formattedMessage);
+    return histories;
 }
 
 } // namespace tools
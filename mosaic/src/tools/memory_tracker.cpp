@@ -0,0 +1,214 @@
+#include "mosaic/tools/memory_tracker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "mosaic/core/sys_console.hpp"
+#include "mosaic/tools/tracer.hpp"
+
+namespace mosaic
+{
+namespace tools
+{
+
+namespace
+{
+
+using Stats = pieces::AllocationStats;
+
+std::string formatBytes(size_t _bytes)
+{
+    if (_bytes >= 1024 * 1024) return fmt::format("{} MiB", _bytes / (1024 * 1024));
+    if (_bytes >= 1024) return fmt::format("{} KiB", _bytes / 1024);
+    return fmt::format("{} B", _bytes);
+}
+
+std::string formatNanoseconds(uint64_t _nanoseconds)
+{
+    if (_nanoseconds >= 1'000'000'000) return fmt::format("{} s", _nanoseconds / 1'000'000'000);
+    if (_nanoseconds >= 1'000'000) return fmt::format("{} ms", _nanoseconds / 1'000'000);
+    return fmt::format("{} us", _nanoseconds / 1'000);
+}
+
+// "<= 64 B", the last class "> 256 KiB"
+std::string formatSizeClass(size_t _class)
+{
+    if (_class + 1 < Stats::k_sizeClasses)
+    {
+        return "<= " + formatBytes(Stats::sizeClassLimit(_class));
+    }
+
+    return "> " + formatBytes(Stats::sizeClassLimit(_class - 1));
+}
+
+// "< 10 ms", the last class ">= 1 s"
+std::string formatLifetimeClass(size_t _class)
+{
+    if (_class + 1 < Stats::k_lifetimeClasses)
+    {
+        return "< " + formatNanoseconds(Stats::lifetimeClassLimit(_class));
+    }
+
+    return ">= " + formatNanoseconds(Stats::lifetimeClassLimit(_class - 1));
+}
+
+struct Subsystem
+{
+    std::string name;
+    pieces::AllocationStats stats;
+
+    // Interned once by the tracer, the counters are traced every frame
+    std::string allocatedName;
+    std::string reservedName;
+    std::string peakName;
+    std::string fragmentationName;
+    std::array<std::string, Stats::k_sizeClasses> sizeClassNames;
+    std::array<std::string, Stats::k_lifetimeClasses> lifetimeClassNames;
+
+    explicit Subsystem(std::string_view _name)
+        : name(_name),
+          allocatedName(fmt::format("Memory {} allocated (MiB)", _name)),
+          reservedName(fmt::format("Memory {} reserved (MiB)", _name)),
+          peakName(fmt::format("Memory {} peak (MiB)", _name)),
+          fragmentationName(fmt::format("Memory {} fragmentation", _name))
+    {
+        for (size_t i = 0; i < Stats::k_sizeClasses; ++i)
+        {
+            sizeClassNames[i] = fmt::format("Memory {} size {}", _name, formatSizeClass(i));
+        }
+
+        for (size_t i = 0; i < Stats::k_lifetimeClasses; ++i)
+        {
+            lifetimeClassNames[i] =
+                fmt::format("Memory {} lifetime {}", _name, formatLifetimeClass(i));
+        }
+    }
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::deque<Subsystem> subsystems; // addresses are stable
+};
+
+// Never destroyed: allocators attached to the stats may outlive the static destructors
+Registry& registry()
+{
+    static Registry* s_registry = new Registry();
+    return *s_registry;
+}
+
+double toMiB(size_t _bytes) { return static_cast<double>(_bytes) / BYTES_PER_MIB; }
+
+} // namespace
+
+pieces::AllocationStats& MemoryTracker::getStats(std::string_view _subsystem)
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    auto it = std::ranges::find(reg.subsystems, _subsystem, &Subsystem::name);
+    if (it != reg.subsystems.end()) return it->stats;
+
+    return reg.subsystems.emplace_back(_subsystem).stats;
+}
+
+std::vector<MemorySummary> MemoryTracker::getSummary()
+{
+    Registry& reg = registry();
+    std::vector<MemorySummary> summary;
+
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        summary.reserve(reg.subsystems.size());
+
+        for (const Subsystem& subsystem : reg.subsystems)
+        {
+            const auto& stats = subsystem.stats;
+            MemorySummary& entry = summary.emplace_back(
+                subsystem.name, stats.reservedBytes(), stats.allocatedBytes(), stats.peakBytes(),
+                stats.allocations(), stats.fragmentation());
+
+            for (size_t i = 0; i < Stats::k_sizeClasses; ++i)
+            {
+                entry.sizeClasses[i] = stats.sizeClassCount(i);
+            }
+
+            for (size_t i = 0; i < Stats::k_lifetimeClasses; ++i)
+            {
+                entry.lifetimeClasses[i] = stats.lifetimeClassCount(i);
+            }
+        }
+    }
+
+    std::ranges::sort(summary, std::ranges::greater{}, &MemorySummary::reservedBytes);
+
+    return summary;
+}
+
+void MemoryTracker::traceCounters() noexcept
+{
+    if (!Tracer::isRecording(TraceCategory::memory)) return;
+
+    Tracer* tracer = Tracer::getInstance();
+    if (!tracer) return;
+
+    try
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+
+        for (const Subsystem& subsystem : reg.subsystems)
+        {
+            const auto& stats = subsystem.stats;
+            const auto category = TraceCategory::memory;
+
+            tracer->counterTrace(subsystem.allocatedName, toMiB(stats.allocatedBytes()), category);
+            tracer->counterTrace(subsystem.reservedName, toMiB(stats.reservedBytes()), category);
+            tracer->counterTrace(subsystem.peakName, toMiB(stats.peakBytes()), category);
+            tracer->counterTrace(subsystem.fragmentationName, stats.fragmentation(), category);
+
+            if (!stats.hasHistograms()) continue;
+
+            for (size_t i = 0; i < Stats::k_sizeClasses; ++i)
+            {
+                tracer->counterTrace(subsystem.sizeClassNames[i],
+                                     static_cast<double>(stats.sizeClassCount(i)), category);
+            }
+
+            for (size_t i = 0; i < Stats::k_lifetimeClasses; ++i)
+            {
+                tracer->counterTrace(subsystem.lifetimeClassNames[i],
+                                     static_cast<double>(stats.lifetimeClassCount(i)), category);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        core::SystemConsole::printError(e.what());
+    }
+}
+
+void MemoryTracker::resetPeaks() noexcept
+{
+    try
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+
+        for (Subsystem& subsystem : reg.subsystems) subsystem.stats.resetPeak();
+    }
+    catch (const std::exception& e)
+    {
+        core::SystemConsole::printError(e.what());
+    }
+}
+
+} // namespace tools
+} // namespace mosaic
@@ -0,0 +1,531 @@
+#include "sampling_profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <utility>
+
+#include "mosaic/defines.hpp"
+#include "mosaic/tools/logger.hpp"
+
+#if defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <dirent.h>
+#include <link.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <ucontext.h>
+#include <unistd.h>
+#elif defined(MOSAIC_PLATFORM_WINDOWS)
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#endif
+
+namespace mosaic
+{
+namespace tools
+{
+
+// One profiler at a time: the capture slot and the signal handler are process-wide
+static std::atomic<bool> s_profilerActive{false};
+
+// How long the sampler waits for a thread to take its sample
+static constexpr std::chrono::milliseconds k_captureTimeout{2};
+
+// The frame pointers are only followed this far above the stack pointer
+static constexpr uintptr_t k_maxStackDepth = uintptr_t{8} << 20;
+
+// Walks the chain of frame pointers (each frame holds the previous frame pointer, then the
+// return address), each frame above the previous one and within k_maxStackDepth of the stack
+// pointer, so that a register holding something else stops the walk rather than fault.
+[[maybe_unused]] static uint32_t walkFramePointers(uintptr_t _pc, uintptr_t _fp, uintptr_t _sp,
+                                                   uintptr_t* _frames) noexcept
+{
+    if (_pc == 0) return 0;
+
+    uint32_t count = 0;
+    _frames[count++] = _pc;
+
+    while (count < StackSample::k_maxFrames)
+    {
+        if (_fp < _sp || _fp - _sp > k_maxStackDepth || _fp % alignof(uintptr_t) != 0) break;
+
+        const auto* frame = reinterpret_cast<const uintptr_t*>(_fp);
+        const uintptr_t previous = frame[0];
+        const uintptr_t returnAddress = frame[1];
+
+        if (returnAddress == 0) break;
+        _frames[count++] = returnAddress;
+
+        if (previous <= _fp) break;
+        _fp = previous;
+    }
+
+    return count;
+}
+
+static int64_t steadyNanoseconds() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#if defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Signals (Linux, Android)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using ThreadHandle = pid_t;
+
+// The slot handed by the sampler to the handler of the sampled thread. The handler claims it
+// (requested -> writing), so a sample the sampler gave up on is never written late.
+struct SignalCapture
+{
+    enum State : int
+    {
+        idle,
+        requested,
+        writing,
+        captured
+    };
+
+    std::atomic<int> state{idle};
+    std::atomic<pid_t> target{0};
+    uint32_t frameCount = 0;
+    uintptr_t frames[StackSample::k_maxFrames];
+};
+
+static_assert(std::atomic<int>::is_always_lock_free && std::atomic<pid_t>::is_always_lock_free,
+              "The capture is written from a signal handler");
+
+static SignalCapture s_capture;
+
+static pid_t currentTid() noexcept { return static_cast<pid_t>(::syscall(SYS_gettid)); }
+
+// Async-signal-safe: atomics, a syscall and reads of the stack of the thread
+static void onSampleSignal(int, siginfo_t*, void* _context)
+{
+    const int savedErrno = errno;
+
+    int expected = SignalCapture::requested;
+    if (s_capture.state.compare_exchange_strong(expected, SignalCapture::writing,
+                                                std::memory_order_acquire))
+    {
+        if (s_capture.target.load(std::memory_order_relaxed) != currentTid())
+        {
+            // a stray SIGPROF, the sampled thread still has to answer
+            s_capture.state.store(SignalCapture::requested, std::memory_order_release);
+        }
+        else
+        {
+            const auto* context = static_cast<const ucontext_t*>(_context);
+            uintptr_t pc = 0, fp = 0, sp = 0;
+
+#if defined(MOSAIC_ARCH_X64)
+            pc = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RIP]);
+            fp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RBP]);
+            sp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RSP]);
+#elif defined(MOSAIC_ARCH_ARM64)
+            pc = static_cast<uintptr_t>(context->uc_mcontext.pc);
+            fp = static_cast<uintptr_t>(context->uc_mcontext.regs[29]);
+            sp = static_cast<uintptr_t>(context->uc_mcontext.sp);
+#else
+            (void)context;
+#endif
+
+            s_capture.frameCount = walkFramePointers(pc, fp, sp, s_capture.frames);
+            s_capture.state.store(SignalCapture::captured, std::memory_order_release);
+        }
+    }
+
+    errno = savedErrno;
+}
+
+// Installed once and never removed: a signal still pending when the profiler stops finds a
+// handler that ignores it, where restoring the default action would terminate the process.
+static bool installSignalHandler() noexcept
+{
+    static const bool s_installed = []
+    {
+        struct sigaction action{};
+        action.sa_sigaction = onSampleSignal;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+
+        return sigaction(SIGPROF, &action, nullptr) == 0;
+    }();
+
+    return s_installed;
+}
+
+static void listThreads(std::vector<ThreadHandle>& _threads)
+{
+    _threads.clear();
+
+    DIR* tasks = opendir("/proc/self/task");
+    if (!tasks) return;
+
+    while (const dirent* entry = readdir(tasks))
+    {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+
+        _threads.push_back(static_cast<pid_t>(std::strtol(entry->d_name, nullptr, 10)));
+    }
+
+    closedir(tasks);
+}
+
+static bool sampleThread(ThreadHandle _thread, StackSample& _sample) noexcept
+{
+    s_capture.target.store(_thread, std::memory_order_relaxed);
+    s_capture.state.store(SignalCapture::requested, std::memory_order_release);
+
+    // the thread exited since it was listed
+    if (::syscall(SYS_tgkill, ::getpid(), _thread, SIGPROF) != 0)
+    {
+        s_capture.state.store(SignalCapture::idle, std::memory_order_relaxed);
+        return false;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + k_captureTimeout;
+
+    while (s_capture.state.load(std::memory_order_acquire) != SignalCapture::captured)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            // withdrawn unless the handler is writing, it finishes in a few microseconds
+            int expected = SignalCapture::requested;
+            if (s_capture.state.compare_exchange_strong(expected, SignalCapture::idle,
+                                                        std::memory_order_relaxed))
+            {
+                return false;
+            }
+        }
+
+        std::this_thread::yield();
+    }
+
+    _sample.threadId = static_cast<uint64_t>(_thread);
+    _sample.timestamp = steadyNanoseconds();
+    _sample.frameCount = s_capture.frameCount;
+    std::copy_n(s_capture.frames, s_capture.frameCount, _sample.frames);
+
+    s_capture.state.store(SignalCapture::idle, std::memory_order_relaxed);
+
+    return _sample.frameCount > 0;
+}
+
+#elif defined(MOSAIC_PLATFORM_WINDOWS)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread suspension (Windows)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using ThreadHandle = DWORD;
+
+// Nothing may allocate here: the suspended thread could hold the lock of the heap.
+static uint32_t unwindContext(CONTEXT& _context, uintptr_t* _frames) noexcept
+{
+#if defined(MOSAIC_ARCH_X64)
+    uint32_t count = 0;
+
+    while (count < StackSample::k_maxFrames && _context.Rip != 0)
+    {
+        _frames[count++] = static_cast<uintptr_t>(_context.Rip);
+
+        DWORD64 imageBase = 0;
+        PRUNTIME_FUNCTION function = RtlLookupFunctionEntry(_context.Rip, &imageBase, nullptr);
+
+        if (!function)
+        {
+            // a leaf function, the return address is at the top of the stack
+            _context.Rip = *reinterpret_cast<const DWORD64*>(_context.Rsp);
+            _context.Rsp += sizeof(DWORD64);
+            continue;
+        }
+
+        PVOID handlerData = nullptr;
+        DWORD64 establisherFrame = 0;
+        RtlVirtualUnwind(UNW_FLAG_NHANDLER, imageBase, _context.Rip, function, &_context,
+                         &handlerData, &establisherFrame, nullptr);
+    }
+
+    return count;
+#elif defined(MOSAIC_ARCH_ARM64)
+    return walkFramePointers(static_cast<uintptr_t>(_context.Pc),
+                             static_cast<uintptr_t>(_context.Fp),
+                             static_cast<uintptr_t>(_context.Sp), _frames);
+#else
+    (void)_context;
+    (void)_frames;
+    return 0;
+#endif
+}
+
+static void listThreads(std::vector<ThreadHandle>& _threads)
+{
+    _threads.clear();
+
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) return;
+
+    const DWORD process = GetCurrentProcessId();
+
+    THREADENTRY32 entry{};
+    entry.dwSize = sizeof(entry);
+
+    for (BOOL found = Thread32First(snapshot, &entry); found; found = Thread32Next(snapshot, &entry))
+    {
+        if (entry.th32OwnerProcessID == process) _threads.push_back(entry.th32ThreadID);
+    }
+
+    CloseHandle(snapshot);
+}
+
+static bool sampleThread(ThreadHandle _thread, StackSample& _sample) noexcept
+{
+    HANDLE thread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT |
+                                   THREAD_QUERY_INFORMATION,
+                               FALSE, _thread);
+    if (!thread) return false;
+
+    bool captured = false;
+
+    if (SuspendThread(thread) != static_cast<DWORD>(-1))
+    {
+        // waits for the suspension to take effect
+        CONTEXT context{};
+        context.ContextFlags = CONTEXT_FULL;
+
+        if (GetThreadContext(thread, &context))
+        {
+            _sample.frameCount = unwindContext(context, _sample.frames);
+            captured = _sample.frameCount > 0;
+        }
+
+        ResumeThread(thread);
+    }
+
+    CloseHandle(thread);
+
+    _sample.threadId = _thread;
+    _sample.timestamp = steadyNanoseconds();
+
+    return captured;
+}
+
+#else
+
+using ThreadHandle = uint64_t;
+
+static void listThreads(std::vector<ThreadHandle>& _threads) { _threads.clear(); }
+
+static bool sampleThread(ThreadHandle, StackSample&) noexcept { return false; }
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SamplingProfiler
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SamplingProfiler::isSupported() noexcept
+{
+#if (defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID) || \
+     defined(MOSAIC_PLATFORM_WINDOWS)) &&                                   \
+    (defined(MOSAIC_ARCH_X64) || defined(MOSAIC_ARCH_ARM64))
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t SamplingProfiler::currentThreadId() noexcept
+{
+#if defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+    return static_cast<uint64_t>(currentTid());
+#elif defined(MOSAIC_PLATFORM_WINDOWS)
+    return GetCurrentThreadId();
+#else
+    return std::hash<std::thread::id>{}(std::this_thread::get_id());
+#endif
+}
+
+bool SamplingProfiler::start(std::chrono::microseconds _interval, Sink _sink) noexcept
+{
+    if (!isSupported() || isRunning() || _interval.count() <= 0) return false;
+
+    bool expected = false;
+    if (!s_profilerActive.compare_exchange_strong(expected, true)) return false;
+
+#if defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+    if (!installSignalHandler())
+    {
+        s_profilerActive.store(false);
+        return false;
+    }
+#endif
+
+    try
+    {
+        m_thread = std::jthread(
+            [this, _interval, sink = std::move(_sink)](std::stop_token _stop) mutable
+            { run(std::move(_stop), _interval, std::move(sink)); });
+
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR("SamplingProfiler: {}", e.what());
+        s_profilerActive.store(false);
+        return false;
+    }
+}
+
+void SamplingProfiler::stop() noexcept
+{
+    if (!m_thread.joinable()) return;
+
+    m_thread.request_stop();
+    m_thread.join();
+    m_thread = std::jthread();
+
+    s_profilerActive.store(false);
+}
+
+void SamplingProfiler::run(std::stop_token _stop, std::chrono::microseconds _interval,
+                           Sink _sink) noexcept
+{
+    const auto self = static_cast<ThreadHandle>(currentThreadId());
+
+    std::vector<ThreadHandle> threads;
+    std::vector<StackSample> samples;
+
+    auto next = std::chrono::steady_clock::now();
+
+    while (!_stop.stop_requested())
+    {
+        try
+        {
+            listThreads(threads);
+
+            // allocated before any thread is stopped
+            samples.resize(threads.size());
+            size_t count = 0;
+
+            for (const ThreadHandle thread : threads)
+            {
+                if (thread == self) continue;
+
+                if (sampleThread(thread, samples[count]))
+                    ++count;
+                else
+                    m_missedCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            m_sampleCount.fetch_add(count, std::memory_order_relaxed);
+            if (count > 0) _sink(std::span<const StackSample>(samples.data(), count));
+        }
+        catch (const std::exception& e)
+        {
+            MOSAIC_ERROR("SamplingProfiler: {}", e.what());
+        }
+
+        // a late round does not make the next ones catch up
+        next = std::max(next + _interval, std::chrono::steady_clock::now());
+        std::this_thread::sleep_until(next);
+    }
+}
+
+std::vector<ModuleInfo> SamplingProfiler::listModules()
+{
+    std::vector<ModuleInfo> modules;
+
+#if defined(MOSAIC_PLATFORM_LINUX) || defined(MOSAIC_PLATFORM_ANDROID)
+    std::error_code error;
+    const std::string executable = std::filesystem::read_symlink("/proc/self/exe", error).string();
+
+    struct Context
+    {
+        std::vector<ModuleInfo>* modules;
+        const std::string* executable;
+    } context{&modules, &executable};
+
+    dl_iterate_phdr(
+        [](dl_phdr_info* _info, size_t, void* _data) -> int
+        {
+            auto& [out, executablePath] = *static_cast<Context*>(_data);
+
+            uintptr_t start = std::numeric_limits<uintptr_t>::max();
+            uintptr_t end = 0;
+
+            for (ElfW(Half) i = 0; i < _info->dlpi_phnum; ++i)
+            {
+                const ElfW(Phdr)& header = _info->dlpi_phdr[i];
+                if (header.p_type != PT_LOAD) continue;
+
+                start = std::min<uintptr_t>(start, _info->dlpi_addr + header.p_vaddr);
+                end = std::max<uintptr_t>(end, _info->dlpi_addr + header.p_vaddr + header.p_memsz);
+            }
+
+            if (start >= end) return 0;
+
+            try
+            {
+                // the executable has no name in the list
+                const bool named = _info->dlpi_name && _info->dlpi_name[0] != '\0';
+                out->push_back({named ? std::string(_info->dlpi_name) : *executablePath, start,
+                                end, static_cast<uintptr_t>(_info->dlpi_addr)});
+            }
+            catch (...)
+            {
+                return 1;
+            }
+
+            return 0;
+        },
+        &context);
+#elif defined(MOSAIC_PLATFORM_WINDOWS)
+    const HANDLE process = GetCurrentProcess();
+
+    std::vector<HMODULE> handles(256);
+    DWORD needed = 0;
+
+    while (EnumProcessModules(process, handles.data(),
+                              static_cast<DWORD>(handles.size() * sizeof(HMODULE)), &needed) &&
+           needed > handles.size() * sizeof(HMODULE))
+    {
+        handles.resize(needed / sizeof(HMODULE));
+    }
+
+    handles.resize(std::min<size_t>(handles.size(), needed / sizeof(HMODULE)));
+
+    for (const HMODULE handle : handles)
+    {
+        MODULEINFO info{};
+        if (!GetModuleInformation(process, handle, &info, sizeof(info))) continue;
+
+        wchar_t widePath[MAX_PATH];
+        const DWORD length = GetModuleFileNameW(handle, widePath, MAX_PATH);
+
+        std::string path(static_cast<size_t>(length) * 3, '\0');
+        path.resize(static_cast<size_t>(WideCharToMultiByte(
+            CP_UTF8, 0, widePath, static_cast<int>(length), path.data(),
+            static_cast<int>(path.size()), nullptr, nullptr)));
+
+        const auto start = reinterpret_cast<uintptr_t>(info.lpBaseOfDll);
+        modules.push_back({std::move(path), start, start + info.SizeOfImage, start});
+    }
+#endif
+
+    return modules;
+}
+
+} // namespace tools
+} // namespace mosaic
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mosaic
+{
+namespace tools
+{
+
+/**
+ * @brief The call stack of a thread at one instant, leaf first: return addresses, raw, to be
+ * symbolized offline against the modules of the process (see SamplingProfiler::listModules()).
+ */
+struct StackSample
+{
+    static constexpr uint32_t k_maxFrames = 64;
+
+    uint64_t threadId;  // of the OS (gettid(), GetCurrentThreadId())
+    int64_t timestamp;  // ns, steady clock
+    uint32_t frameCount;
+    uintptr_t frames[k_maxFrames];
+};
+
+/**
+ * @brief A module mapped in the process: `address - bias` is the address in the file (the ELF
+ * virtual address, or the RVA of a PE image).
+ */
+struct ModuleInfo
+{
+    std::string path;
+    uintptr_t start;
+    uintptr_t end;
+    uintptr_t bias;
+};
+
+/**
+ * @brief Samples the call stacks of every thread of the process at a fixed interval, from a
+ * thread of its own, for the Tracer (see Tracer::startSampling()).
+ *
+ * On Linux and Android the sampler sends SIGPROF to one thread at a time (tgkill), whose handler
+ * walks the frame pointers from the interrupted context into a static slot: no allocation, no
+ * lock. On Windows it suspends the thread, reads its context and unwinds it (RtlVirtualUnwind on
+ * x64, frame pointers on ARM64), allocating nothing until the thread resumes. Elsewhere (macOS,
+ * iOS, the web) start() fails.
+ *
+ * The stacks are as deep as the frame pointers go: Dev and RelWithDebInfo builds keep them
+ * (-fno-omit-frame-pointer), release ones may stop after the leaf. A thread the signal does not
+ * reach in time (masked, exiting) is counted as missed.
+ */
+class SamplingProfiler final
+{
+   public:
+    // Receives the samples of one round, on the sampling thread
+    using Sink = std::function<void(std::span<const StackSample>)>;
+
+   private:
+    std::jthread m_thread;
+    std::atomic<uint64_t> m_sampleCount{0};
+    std::atomic<uint64_t> m_missedCount{0};
+
+   public:
+    SamplingProfiler() = default;
+    ~SamplingProfiler() { stop(); }
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+   public:
+    /// Starts sampling every thread but the sampler every _interval. One profiler at a time.
+    bool start(std::chrono::microseconds _interval, Sink _sink) noexcept;
+    void stop() noexcept;
+
+    [[nodiscard]] bool isRunning() const noexcept { return m_thread.joinable(); }
+
+    [[nodiscard]] uint64_t getSampleCount() const noexcept
+    {
+        return m_sampleCount.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t getMissedCount() const noexcept
+    {
+        return m_missedCount.load(std::memory_order_relaxed);
+    }
+
+    /// Whether the platform can sample the threads.
+    [[nodiscard]] static bool isSupported() noexcept;
+
+    /// The id of the calling thread, as in StackSample::threadId.
+    [[nodiscard]] static uint64_t currentThreadId() noexcept;
+
+    /// The modules mapped in the process, for the symbolization of the samples.
+    [[nodiscard]] static std::vector<ModuleInfo> listModules();
+
+   private:
+    void run(std::stop_token _stop, std::chrono::microseconds _interval, Sink _sink) noexcept;
+};
+
+} // namespace tools
+} // namespace mosaic
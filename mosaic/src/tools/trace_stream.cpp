@@ -0,0 +1,243 @@
+#include "trace_stream.hpp"
+
+#include <algorithm>
+
+#include "mosaic/defines.hpp"
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#elif !defined(MOSAIC_PLATFORM_WEB)
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace mosaic
+{
+namespace tools
+{
+
+#if !defined(MOSAIC_PLATFORM_WEB)
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+using NativeSocket = SOCKET;
+#else
+using NativeSocket = int;
+#endif
+
+static NativeSocket toNative(uintptr_t _socket) { return static_cast<NativeSocket>(_socket); }
+
+static void closeSocket(uintptr_t _socket) noexcept
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    closesocket(toNative(_socket));
+#else
+    ::close(toNative(_socket));
+#endif
+}
+
+static bool setNonBlocking(NativeSocket _socket) noexcept
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    u_long enabled = 1;
+    return ioctlsocket(_socket, FIONBIO, &enabled) == 0;
+#else
+    const int flags = fcntl(_socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(_socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// Nothing to accept, or the socket is full
+static bool wouldBlock() noexcept
+{
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+#endif
+
+TraceStream::~TraceStream() { close(); }
+
+bool TraceStream::listen(uint16_t _port) noexcept
+{
+#if defined(MOSAIC_PLATFORM_WEB)
+    (void)_port;
+    return false;
+#else
+    close();
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+#endif
+
+    const NativeSocket listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    m_listener = static_cast<uintptr_t>(listener);
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    if (listener == INVALID_SOCKET)
+#else
+    if (listener < 0)
+#endif
+    {
+        m_listener = k_invalidSocket;
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    // a restarted game takes its port back at once
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse),
+               sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(_port);
+
+    socklen_t size = sizeof(address);
+
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, 1) != 0 || !setNonBlocking(listener) ||
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &size) != 0)
+    {
+        close();
+        return false;
+    }
+
+    m_port = ntohs(address.sin_port);
+
+    return true;
+#endif
+}
+
+void TraceStream::close() noexcept
+{
+#if !defined(MOSAIC_PLATFORM_WEB)
+    const bool started = isListening();
+
+    disconnect();
+
+    if (isListening()) closeSocket(m_listener);
+
+    m_listener = k_invalidSocket;
+    m_port = 0;
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    if (started) WSACleanup();
+#else
+    (void)started;
+#endif
+#endif
+}
+
+bool TraceStream::accept() noexcept
+{
+#if defined(MOSAIC_PLATFORM_WEB)
+    return false;
+#else
+    if (!isListening()) return false;
+
+    const NativeSocket client = ::accept(toNative(m_listener), nullptr, nullptr);
+
+#if defined(MOSAIC_PLATFORM_WINDOWS)
+    if (client == INVALID_SOCKET) return false;
+#else
+    if (client < 0) return false;
+#endif
+
+    if (!setNonBlocking(client))
+    {
+        closeSocket(static_cast<uintptr_t>(client));
+        return false;
+    }
+
+    // the events go out in drains of a few milliseconds, no need to coalesce them further
+    int noDelay = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay),
+               sizeof(noDelay));
+
+#if defined(SO_NOSIGPIPE)
+    int noSignal = 1;
+    setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+#endif
+
+    disconnect();
+    m_client = static_cast<uintptr_t>(client);
+
+    return true;
+#endif
+}
+
+void TraceStream::enqueue(std::span<const char> _bytes)
+{
+    if (!isConnected()) return;
+
+    // the sent bytes are dropped once they are the larger part of the queue
+    if (m_sent > 0 && m_sent >= m_queue.size() / 2)
+    {
+        m_queue.erase(m_queue.begin(), m_queue.begin() + static_cast<ptrdiff_t>(m_sent));
+        m_sent = 0;
+    }
+
+    m_queue.insert(m_queue.end(), _bytes.begin(), _bytes.end());
+}
+
+void TraceStream::send() noexcept
+{
+#if !defined(MOSAIC_PLATFORM_WEB)
+#if defined(MSG_NOSIGNAL)
+    constexpr int k_flags = MSG_NOSIGNAL;
+#else
+    constexpr int k_flags = 0;
+#endif
+
+    while (isConnected() && m_sent < m_queue.size())
+    {
+        const size_t remaining = m_queue.size() - m_sent;
+        const int size = static_cast<int>(std::min<size_t>(remaining, 1 << 20));
+
+        const auto sent = ::send(toNative(m_client), m_queue.data() + m_sent, size, k_flags);
+
+        if (sent > 0)
+        {
+            m_sent += static_cast<size_t>(sent);
+        }
+        else
+        {
+            // the viewer left, or is too slow for the socket to take more now
+            if (sent == 0 || !wouldBlock()) disconnect();
+            break;
+        }
+    }
+
+    if (m_sent == m_queue.size())
+    {
+        m_queue.clear();
+        m_sent = 0;
+    }
+#endif
+}
+
+void TraceStream::disconnect() noexcept
+{
+#if !defined(MOSAIC_PLATFORM_WEB)
+    if (isConnected()) closeSocket(m_client);
+#endif
+
+    m_client = k_invalidSocket;
+    m_queue.clear();
+    m_sent = 0;
+}
+
+} // namespace tools
+} // namespace mosaic
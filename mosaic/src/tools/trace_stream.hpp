@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace mosaic
+{
+namespace tools
+{
+
+/**
+ * @brief TCP server of the live trace stream, one viewer at a time, polled by the flusher of the
+ * Tracer: never blocks, the bytes the socket does not take wait in a queue.
+ *
+ * On Android the viewer reaches the device through `adb forward tcp:<port> tcp:<port>`. Not
+ * available on the web, listen() fails.
+ */
+class TraceStream final
+{
+   private:
+    static constexpr uintptr_t k_invalidSocket = ~uintptr_t{0};
+
+    uintptr_t m_listener = k_invalidSocket;
+    uintptr_t m_client = k_invalidSocket;
+    uint16_t m_port = 0;
+
+    std::vector<char> m_queue;
+    size_t m_sent = 0; // bytes of the queue already sent
+
+   public:
+    TraceStream() = default;
+    ~TraceStream();
+
+    TraceStream(const TraceStream&) = delete;
+    TraceStream& operator=(const TraceStream&) = delete;
+
+   public:
+    /// Listens on the port of every interface (0 for one picked by the system).
+    bool listen(uint16_t _port) noexcept;
+    void close() noexcept;
+
+    /// Takes a waiting viewer, whether one connected (in place of the previous one).
+    bool accept() noexcept;
+
+    void enqueue(std::span<const char> _bytes);
+
+    /// Sends what the socket takes, drops the viewer on an error.
+    void send() noexcept;
+
+    [[nodiscard]] bool isListening() const noexcept { return m_listener != k_invalidSocket; }
+    [[nodiscard]] bool isConnected() const noexcept { return m_client != k_invalidSocket; }
+    [[nodiscard]] uint16_t getPort() const noexcept { return m_port; }
+
+    /// Bytes waiting for the viewer.
+    [[nodiscard]] size_t getQueuedSize() const noexcept { return m_queue.size() - m_sent; }
+
+   private:
+    void disconnect() noexcept;
+};
+
+} // namespace tools
+} // namespace mosaic
@@ -2,46 +2,430 @@
 
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <bit>
+#include <charconv>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <mutex>
 #include <ostream>
+#include <shared_mutex>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 #include <nlohmann/json_fwd.hpp>
 
+#include <pieces/containers/flat_hash_map.hpp>
+
 #include "mosaic/defines.hpp"
 #include "mosaic/tools/logger.hpp"
 #include "mosaic/version.h"
 #include "mosaic/core/cmd_line_parser.hpp"
+#include "mosaic/core/ticks.hpp"
+
+#include "sampling_profiler.hpp"
+#include "trace_stream.hpp"
 
 namespace mosaic
 {
 namespace tools
 {
 
-Tracer* Tracer::s_instance = nullptr;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Name interning
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-ScopedTrace::ScopedTrace(const std::string& _name, TraceCategory _category) noexcept
-    : m_valid(false)
+// Process-wide and never freed: threads may still trace while the program exits.
+struct NameTable
 {
-    if (auto* manager = Tracer::getInstance())
+    struct Hash
     {
-        manager->beginTrace(_name, _category);
-        m_valid = true;
+        using is_transparent = void;
+
+        size_t operator()(std::string_view _name) const noexcept
+        {
+            return std::hash<std::string_view>{}(_name);
+        }
+    };
+
+    std::shared_mutex mutex;
+    pieces::FlatHashMap<std::string, uint32_t, Hash, std::equal_to<>> ids;
+    std::deque<std::string> names{""}; // id 0, names that could not be interned
+    std::vector<std::pair<uint32_t, std::string>> sources; // "file:line" of the names of sites
+
+    static NameTable& get() noexcept
+    {
+        static NameTable* s_table = new NameTable();
+        return *s_table;
     }
+};
+
+// Direct-mapped on the address of the names, literals and static strings always hit. The
+// comparison catches another string at the same address.
+struct NameCacheEntry
+{
+    const char* data = nullptr;
+    size_t size = 0;
+    const std::string* name = nullptr;
+    uint32_t id = 0;
+};
+
+static constexpr size_t k_nameCacheSize = 64;
+
+static thread_local std::array<NameCacheEntry, k_nameCacheSize> t_nameCache;
+
+// Bumped by every initialize(), the rings of a previous tracer are not reused
+static std::atomic<uint64_t> s_tracerEpoch{0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Trace file
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Binary and append-only, little endian. A header, then chunks of a type and a size in bytes:
+//
+//   metadata  1  JSON of the session, the first chunk of every file
+//   names     2  { u32 id, u32 size, bytes }..., the names used next that the file lacks
+//   sources   3  { u32 id, u32 size, bytes }..., the "file:line" of the sites of the names
+//   events    4  { EventRecord, args bytes }..., args being JSON (or none)
+//
+// A file is complete on its own: a rotation writes the metadata and the names again.
+
+static constexpr char k_fileMagic[8] = {'M', 'O', 'S', 'T', 'R', 'A', 'C', 'E'};
+static constexpr uint32_t k_fileVersion = 1;
+
+enum class ChunkType : uint32_t
+{
+    metadata = 1,
+    names = 2,
+    sources = 3,
+    events = 4
+};
+
+struct ChunkHeader
+{
+    uint32_t type;
+    uint32_t size;
+};
+
+struct EventRecord
+{
+    int64_t timestamp; // ns
+    int64_t value;     // duration in ns (complete), the bits of a counter value, or the id
+    uint64_t tid;
+    uint32_t name;
+    uint32_t argsSize;
+    uint8_t category;
+    uint8_t phase;
+    uint8_t reserved[6];
+};
+
+static_assert(sizeof(ChunkHeader) == 8 && sizeof(EventRecord) == 40);
+static_assert(std::endian::native == std::endian::little, "Trace files are little endian!");
+
+// A new event chunk past this size, so that readers can stream the file
+static constexpr size_t k_chunkSize = 64 * 1024;
+
+template <typename T>
+static void appendBytes(std::vector<char>& _out, const T& _value)
+{
+    const auto* bytes = reinterpret_cast<const char*>(&_value);
+    _out.insert(_out.end(), bytes, bytes + sizeof(T));
+}
+
+static void appendString(std::vector<char>& _out, std::string_view _bytes)
+{
+    _out.insert(_out.end(), _bytes.begin(), _bytes.end());
+}
+
+static void appendChunk(std::vector<char>& _out, ChunkType _type, std::string_view _payload)
+{
+    appendBytes(_out, ChunkHeader{static_cast<uint32_t>(_type),
+                                  static_cast<uint32_t>(_payload.size())});
+    appendString(_out, _payload);
+}
+
+static void appendFileHeader(std::vector<char>& _out, std::string_view _metadata)
+{
+    appendBytes(_out, k_fileMagic);
+    appendBytes(_out, k_fileVersion);
+    appendBytes(_out, uint32_t{0});
+    appendChunk(_out, ChunkType::metadata, _metadata);
 }
 
-ScopedTrace::~ScopedTrace() noexcept
+// The names and sources of the table from the counts of those already written on
+static void appendDefinitions(std::vector<char>& _out, size_t& _namesDone, size_t& _sourcesDone)
 {
-    if (!m_valid) return;
+    NameTable& table = NameTable::get();
+    std::shared_lock lock(table.mutex);
+
+    std::vector<char> names;
+    for (; _namesDone < table.names.size(); ++_namesDone)
+    {
+        const std::string& name = table.names[_namesDone];
 
-    if (auto* manager = Tracer::getInstance()) manager->endTrace();
+        appendBytes(names, static_cast<uint32_t>(_namesDone));
+        appendBytes(names, static_cast<uint32_t>(name.size()));
+        appendString(names, name);
+    }
+
+    std::vector<char> sources;
+    for (; _sourcesDone < table.sources.size(); ++_sourcesDone)
+    {
+        const auto& [id, source] = table.sources[_sourcesDone];
+
+        appendBytes(sources, id);
+        appendBytes(sources, static_cast<uint32_t>(source.size()));
+        appendString(sources, source);
+    }
+
+    if (!names.empty()) appendChunk(_out, ChunkType::names, {names.data(), names.size()});
+    if (!sources.empty()) appendChunk(_out, ChunkType::sources, {sources.data(), sources.size()});
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Live stream
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Past this many bytes waiting for the viewer, the low priority events are dropped; past twice
+// as many, every event until the viewer catches up
+static constexpr size_t k_streamBacklog = 4 * 1024 * 1024;
+
+// By TraceCategory, the events of priority 0 are the first ones dropped
+static constexpr std::array<uint8_t, 8> k_streamPriorities = {
+    0, // function
+    0, // scope
+    2, // gpu
+    1, // io
+    2, // memory
+    2, // render
+    1, // network
+    0  // custom
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ThreadBuffer - Ring of the events of one thread
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct Tracer::ThreadBuffer
+{
+    static constexpr uint64_t k_capacity = uint64_t{1} << 14;
+    static constexpr uint32_t k_maxDepth = 64;
+
+    // Traces begun and not ended, only touched by the thread
+    struct OpenTrace
+    {
+        int64_t start;
+        uint32_t name;
+        uint8_t category;
+        bool skipped; // disabled category, popped without an event
+        bool hasArgs; // the arguments are at the back of openArgs
+    };
+
+    // Producer side
+
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<uint64_t> head{0};
+    uint64_t cachedTail = 0;
+    std::atomic<uint32_t> depth{0};
+    std::atomic<uint64_t> dropped{0};
+    std::array<OpenTrace, k_maxDepth> open{};
+    std::vector<std::string> openArgs;
+
+    // Consumer side (the drain)
+
+    alignas(MOSAIC_CACHE_LINE_SIZE) std::atomic<uint64_t> tail{0};
+
+    std::atomic<bool> retired{false}; // the thread exited
+    const size_t tid;
+    const uint64_t osThreadId; // the stack samples of the thread go to its track
+    const std::unique_ptr<TraceEvent[]> events;
+
+    ThreadBuffer(size_t _tid, uint64_t _osThreadId)
+        : tid(_tid), osThreadId(_osThreadId), events(new TraceEvent[k_capacity])
+    {
+    }
+
+    // Returns the number of events in the ring after the push, 0 if it was full.
+    uint64_t push(const TraceEvent& _event) noexcept
+    {
+        const uint64_t position = head.load(std::memory_order_relaxed);
+
+        if (position - cachedTail == k_capacity)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+
+            if (position - cachedTail == k_capacity)
+            {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+                return 0;
+            }
+        }
+
+        events[position & (k_capacity - 1)] = _event;
+        head.store(position + 1, std::memory_order_release);
+
+        return position + 1 - cachedTail;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameProfile - Scope statistics over the last frames
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// How long after its end a frame still receives events (GPU spans come a few frames late)
+static constexpr int64_t k_statisticsLatencyNs = 100'000'000;
+
+struct Tracer::FrameProfile
+{
+    // A complete event, in ns
+    struct Span
+    {
+        int64_t start;
+        int64_t duration;
+        uint32_t name;
+    };
+
+    struct Pass
+    {
+        int64_t total = 0;
+        uint32_t calls = 0;
+    };
+
+    struct Frame
+    {
+        int64_t begin;
+        int64_t end; // the next mark, max while open
+        pieces::FlatHashMap<uint32_t, Pass> scopes;
+    };
+
+    // The passes of a scope in a settled frame
+    struct Sample
+    {
+        uint64_t frame;
+        int64_t total;
+        uint32_t calls;
+    };
+
+    // The last samples of a scope, a ring of at most the frames of the window
+    struct Window
+    {
+        std::vector<Sample> samples;
+        size_t next = 0;
+
+        void push(const Sample& _sample, size_t _capacity)
+        {
+            if (samples.size() < _capacity)
+            {
+                samples.push_back(_sample);
+                return;
+            }
+
+            samples[next] = _sample;
+            next = (next + 1) % _capacity;
+        }
+    };
+
+    // Drain side, under m_drainMutex
+
+    std::vector<Span> spans;    // of the drain, and those deferred by the one before
+    std::vector<int64_t> marks; // of the drain
+    std::deque<Frame> frames;   // not settled yet, the last one open
+
+    // Statistics side, read by the queries
+
+    mutable std::mutex mutex;
+    pieces::FlatHashMap<uint32_t, Window> windows;
+    Window frameTimes;
+    uint64_t settledCount = 0;
+    uint32_t windowFrames = 0;
+
+    ScopeStatistics summarize(std::string_view _name, const Window& _window) const
+    {
+        ScopeStatistics statistics{std::string(_name), 0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+        // the ring may still hold samples of frames older than the window
+        const uint64_t first = settledCount > windowFrames ? settledCount - windowFrames : 0;
+
+        std::vector<int64_t> totals;
+        totals.reserve(_window.samples.size());
+        uint64_t calls = 0;
+
+        for (const Sample& sample : _window.samples)
+        {
+            if (sample.frame < first) continue;
+
+            totals.push_back(sample.total);
+            calls += sample.calls;
+        }
+
+        if (totals.empty()) return statistics;
+
+        std::ranges::sort(totals);
+
+        const auto count = static_cast<double>(totals.size());
+        const auto milliseconds = [](int64_t _ns) { return static_cast<double>(_ns) / 1e6; };
+
+        // nearest rank
+        const auto percentile = [&](double _rank)
+        {
+            const auto index = static_cast<size_t>(std::ceil(_rank * count));
+            return milliseconds(totals[std::max<size_t>(index, 1) - 1]);
+        };
+
+        int64_t sum = 0;
+        for (int64_t total : totals) sum += total;
+
+        statistics.frames = static_cast<uint32_t>(totals.size());
+        statistics.callsPerFrame = static_cast<double>(calls) / count;
+        statistics.mean = milliseconds(sum) / count;
+        statistics.p50 = percentile(0.50);
+        statistics.p95 = percentile(0.95);
+        statistics.p99 = percentile(0.99);
+        statistics.max = milliseconds(totals.back());
+
+        return statistics;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tracer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// How often the flusher moves the events out of the rings
+static constexpr std::chrono::milliseconds k_drainPeriod{5};
+
+Tracer* Tracer::s_instance = nullptr;
+std::atomic<uint32_t> Tracer::s_recording{0};
+
+ScopedTrace::ScopedTrace(std::string_view _name, TraceCategory _category) noexcept
+    : m_valid(false)
+{
+    // a disabled tracer pushes nothing, there would be nothing to end
+    auto* manager = Tracer::getInstance();
+    if (!manager || !manager->isEnabled()) return;
+
+    manager->beginTrace(_name, _category);
+    m_valid = true;
+}
+
+Tracer::Tracer()
+    : m_profile(std::make_unique<FrameProfile>()), m_fileCounter(0), m_nextTraceId(1)
+{
+}
+
+Tracer::~Tracer() = default;
+
 bool Tracer::initialize(const Config& _config) noexcept
 {
     assert(s_instance == nullptr && "Tracer already exists!");
@@ -62,7 +446,10 @@ bool Tracer::initialize(const Config& _config) noexcept
         instance.m_config = _config;
         instance.m_startTime = std::chrono::steady_clock::now();
         instance.m_lastFlush = instance.m_startTime;
-        instance.m_currentFile = instance.generateFileName();
+
+        s_tracerEpoch.fetch_add(1, std::memory_order_relaxed);
+
+        instance.m_frameName = internName("Frame");
 
         // Initialize traces with metadata
 
@@ -80,10 +467,13 @@ bool Tracer::initialize(const Config& _config) noexcept
         metadata["startTime"] = std::chrono::system_clock::to_time_t(systemStartTime);
         metadata["processId"] = 0;
         metadata["threadName"] = nlohmann::json::object();
-        metadata["processName"] = core::CommandLineParser::getInstance()->getExecutableName();
 
-        std::ofstream testFile(instance.m_currentFile);
-        if (!testFile.is_open())
+        if (auto* parser = core::CommandLineParser::getInstance())
+        {
+            metadata["processName"] = parser->getExecutableName();
+        }
+
+        if (!instance.openFile())
         {
             delete s_instance;
             s_instance = nullptr;
@@ -91,7 +481,29 @@ bool Tracer::initialize(const Config& _config) noexcept
             return false;
         }
 
-        testFile.close();
+        // without a stream the session still records to the file
+        if (const uint16_t port = static_cast<uint16_t>(instance.m_config.streamPort.load());
+            port != 0 && !instance.startStreaming(port))
+        {
+            MOSAIC_ERROR("Tracer: could not stream on port {}", port);
+        }
+
+        if (const uint32_t interval = instance.m_config.samplingIntervalUs.load();
+            interval != 0 && !instance.startSampling(std::chrono::microseconds(interval)))
+        {
+            MOSAIC_ERROR("Tracer: could not sample every {} us", interval);
+        }
+
+        instance.m_flusher = std::jthread([&instance](std::stop_token _stop)
+                                          { instance.runFlusher(std::move(_stop)); });
+
+        uint32_t recording = instance.m_config.enabled ? k_recordingEnabled : 0;
+        for (uint32_t i = 0; i < instance.m_config.categoryEnabled.size(); ++i)
+        {
+            if (instance.m_config.categoryEnabled[i]) recording |= 1u << i;
+        }
+
+        s_recording.store(recording, std::memory_order_relaxed);
 
         return true;
     }
@@ -106,31 +518,624 @@ void Tracer::shutdown() noexcept
 {
     assert(s_instance != nullptr && "Tracer does not exist!");
 
-    auto& instance = *s_instance;
+    auto& instance = *s_instance;
+
+    s_recording.store(0, std::memory_order_relaxed);
+
+    // before the flusher, a round in progress pushes its samples
+    instance.stopSampling();
+
+    if (instance.m_flusher.joinable())
+    {
+        instance.m_flusher.request_stop();
+        instance.m_flusher.join();
+    }
+
+    // the last events go to the file and to the viewer
+    instance.flush();
+    instance.stopStreaming();
+
+    delete s_instance;
+    s_instance = nullptr;
+}
+
+uint32_t Tracer::internName(std::string_view _name) noexcept
+{
+    const auto address = reinterpret_cast<uintptr_t>(_name.data());
+    NameCacheEntry& cached = t_nameCache[((address >> 3) ^ _name.size()) % k_nameCacheSize];
+
+    if (cached.data == _name.data() && cached.size == _name.size() &&
+        std::memcmp(cached.name->data(), _name.data(), _name.size()) == 0) [[likely]]
+    {
+        return cached.id;
+    }
+
+    NameTable& table = NameTable::get();
+
+    try
+    {
+        uint32_t id;
+        const std::string* name;
+
+        {
+            std::shared_lock lock(table.mutex);
+
+            auto it = table.ids.find(_name);
+            if (it != table.ids.end())
+            {
+                id = it->second;
+                name = &table.names[id];
+            }
+            else
+            {
+                id = 0;
+            }
+        }
+
+        if (id == 0)
+        {
+            std::unique_lock lock(table.mutex);
+
+            const auto next = static_cast<uint32_t>(table.names.size());
+            auto [it, inserted] = table.ids.try_emplace(std::string(_name), next);
+            if (inserted) table.names.emplace_back(_name);
+
+            id = it->second;
+            name = &table.names[id];
+        }
+
+        cached = {_name.data(), _name.size(), name, id};
+
+        return id;
+    }
+    catch (const std::exception&)
+    {
+        return 0;
+    }
+}
+
+uint32_t Tracer::internSite(const TraceSite& _site) noexcept
+{
+    const uint32_t id = internName(_site.name);
+    if (id == 0) return 0;
+
+    NameTable& table = NameTable::get();
+
+    try
+    {
+        std::unique_lock lock(table.mutex);
+
+        // once per site, the first site of a name wins
+        if (std::ranges::find(table.sources, id, &std::pair<uint32_t, std::string>::first) ==
+            table.sources.end())
+        {
+            table.sources.emplace_back(id,
+                                       std::string(_site.file) + ":" + std::to_string(_site.line));
+        }
+    }
+    catch (const std::exception&)
+    {
+        // the events are still recorded, without their source
+    }
+
+    return id;
+}
+
+Tracer::ThreadBuffer* Tracer::localBuffer() noexcept
+{
+    struct Local
+    {
+        std::shared_ptr<ThreadBuffer> buffer;
+        uint64_t epoch = 0;
+
+        // the tracer drains the ring once more, then frees it
+        ~Local()
+        {
+            if (buffer) buffer->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local Local t_local;
+
+    const uint64_t epoch = s_tracerEpoch.load(std::memory_order_relaxed);
+    if (t_local.buffer && t_local.epoch == epoch) [[likely]] return t_local.buffer.get();
+
+    try
+    {
+        const size_t tid = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        auto buffer = std::make_shared<ThreadBuffer>(tid, SamplingProfiler::currentThreadId());
+
+        {
+            std::lock_guard<std::mutex> lock(m_buffersMutex);
+            m_buffers.push_back(buffer);
+        }
+
+        if (t_local.buffer) t_local.buffer->retired.store(true, std::memory_order_release);
+
+        t_local.buffer = std::move(buffer);
+        t_local.epoch = epoch;
+
+        return t_local.buffer.get();
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR(e.what());
+        return nullptr;
+    }
+}
+
+void Tracer::record(ThreadBuffer& _buffer, const TraceEvent& _event) noexcept
+{
+    // half full: the flusher drains now rather than at the end of its period
+    if (_buffer.push(_event) != ThreadBuffer::k_capacity / 2) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_flusherMutex);
+        m_drainRequested = true;
+    }
+
+    m_flusherWakeUp.notify_one();
+}
+
+void Tracer::pushTrace(Trace&& _trace) noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        m_completedTraces.push_back(std::move(_trace));
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR(e.what());
+    }
+}
+
+void Tracer::recordSamples(std::span<const StackSample> _samples) noexcept
+{
+    if (!isRecording(TraceCategory::function)) return;
+
+    try
+    {
+        // the samples of a thread that traced go to its track
+        pieces::FlatHashMap<uint64_t, size_t> tids;
+
+        {
+            std::lock_guard<std::mutex> lock(m_buffersMutex);
+            for (const auto& buffer : m_buffers)
+            {
+                if (!buffer->retired.load(std::memory_order_relaxed))
+                    tids.insert_or_assign(buffer->osThreadId, buffer->tid);
+            }
+        }
+
+        std::vector<Trace> traces;
+        traces.reserve(_samples.size());
+
+        std::string args;
+
+        for (const StackSample& sample : _samples)
+        {
+            args.assign(R"({"frames":[)");
+
+            for (uint32_t i = 0; i < sample.frameCount; ++i)
+            {
+                char digits[2 + 2 * sizeof(uintptr_t)] = {'0', 'x'};
+                const auto result =
+                    std::to_chars(digits + 2, digits + sizeof(digits), sample.frames[i], 16);
+
+                if (i != 0) args.push_back(',');
+                args.push_back('"');
+                args.append(digits, result.ptr);
+                args.push_back('"');
+            }
+
+            args.append("]}");
+
+            const auto it = tids.find(sample.threadId);
+            const size_t tid = it != tids.end() ? it->second : static_cast<size_t>(sample.threadId);
+
+            traces.emplace_back(TraceCategory::function, TracePhase::sample, "Sample", tid, 0,
+                                sample.timestamp, 0, 0, args);
+        }
+
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        m_completedTraces.insert(m_completedTraces.end(), std::make_move_iterator(traces.begin()),
+                                 std::make_move_iterator(traces.end()));
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR(e.what());
+    }
+}
+
+int64_t Tracer::toNanoseconds(int64_t _ticks) const noexcept
+{
+    return core::Ticks::toSteadyNanoseconds(_ticks);
+}
+
+void Tracer::beginTrace(std::string_view _name, TraceCategory _category,
+                        std::string_view _args) noexcept
+{
+    if (!m_config.enabled) return;
+
+    // pushed anyway, so that endTrace() pops the trace it ends
+    const bool recorded = !_name.empty() && isCategoryEnabled(_category);
+    beginInterned(recorded ? internName(_name) : 0, _category, _args);
+}
+
+void Tracer::beginTrace(const TraceSite& _site) noexcept
+{
+    if (!m_config.enabled) return;
+
+    uint32_t name = 0;
+
+    if (isCategoryEnabled(_site.category))
+    {
+        // threads racing for the first pass intern the same id
+        name = _site.id.load(std::memory_order_relaxed);
+        if (name == 0) [[unlikely]]
+        {
+            name = internSite(_site);
+            _site.id.store(name, std::memory_order_relaxed);
+        }
+    }
+
+    beginInterned(name, _site.category, "{}");
+}
+
+void Tracer::beginInterned(uint32_t _name, TraceCategory _category,
+                           std::string_view _args) noexcept
+{
+    ThreadBuffer* buffer = localBuffer();
+    if (!buffer) return;
+
+    const uint32_t depth = buffer->depth.load(std::memory_order_relaxed);
+    buffer->depth.store(depth + 1, std::memory_order_relaxed);
+
+    // too deep, endTrace() pops it without an event
+    if (depth >= ThreadBuffer::k_maxDepth) return;
+
+    auto& open = buffer->open[depth];
+
+    open.skipped = _name == 0;
+    if (open.skipped) return;
+
+    open.name = _name;
+    open.category = static_cast<uint8_t>(_category);
+    open.hasArgs = false;
+
+    if (!_args.empty() && _args != "{}")
+    {
+        try
+        {
+            buffer->openArgs.emplace_back(_args);
+            open.hasArgs = true;
+        }
+        catch (const std::exception& e)
+        {
+            MOSAIC_ERROR(e.what());
+        }
+    }
+
+    open.start = getCurrentTimestamp();
+}
+
+void Tracer::endTrace() noexcept
+{
+    const int64_t end = getCurrentTimestamp();
+
+    ThreadBuffer* buffer = localBuffer();
+    if (!buffer) return;
+
+    uint32_t depth = buffer->depth.load(std::memory_order_relaxed);
+    if (depth == 0) return;
+
+    buffer->depth.store(--depth, std::memory_order_relaxed);
+
+    if (depth >= ThreadBuffer::k_maxDepth) return;
+
+    const auto& open = buffer->open[depth];
+    if (open.skipped) return;
+
+    if (!open.hasArgs)
+    {
+        record(*buffer, {open.start, end - open.start, open.name, open.category,
+                         static_cast<uint8_t>(TracePhase::complete)});
+        return;
+    }
+
+    std::string args = std::move(buffer->openArgs.back());
+    buffer->openArgs.pop_back();
+
+    try
+    {
+        NameTable& table = NameTable::get();
+
+        std::shared_lock nameLock(table.mutex);
+
+        Trace trace(static_cast<TraceCategory>(open.category), TracePhase::complete,
+                    table.names[open.name], buffer->tid, 0, toNanoseconds(open.start),
+                    core::Ticks::toNanoseconds(end - open.start), 0, args);
+
+        nameLock.unlock();
+
+        pushTrace(std::move(trace));
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR(e.what());
+    }
+}
+
+void Tracer::recordPoint(TracePhase _phase, std::string_view _name, TraceCategory _category,
+                         std::string_view _args, uint64_t _id) noexcept
+{
+    if (_name.empty()) return;
+
+    ThreadBuffer* buffer = localBuffer();
+    if (!buffer) return;
+
+    if (_args.empty() || _args == "{}")
+    {
+        record(*buffer, {getCurrentTimestamp(), static_cast<int64_t>(_id), internName(_name),
+                         static_cast<uint8_t>(_category), static_cast<uint8_t>(_phase)});
+        return;
+    }
+
+    try
+    {
+        pushTrace(Trace(_category, _phase, _name, buffer->tid, 0,
+                        toNanoseconds(getCurrentTimestamp()), 0, _id, _args));
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR(e.what());
+    }
+}
+
+void Tracer::instantTrace(std::string_view _name, TraceCategory _category,
+                          std::string_view _args) noexcept
+{
+    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+
+    recordPoint(TracePhase::instant, _name, _category, _args);
+}
+
+void Tracer::counterTrace(std::string_view _name, double _value, TraceCategory _category) noexcept
+{
+    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+
+    if (_name.empty()) return;
+
+    ThreadBuffer* buffer = localBuffer();
+    if (!buffer) return;
+
+    // the value travels as the bits of the event, the flusher makes the JSON arguments
+    record(*buffer, {getCurrentTimestamp(), std::bit_cast<int64_t>(_value), internName(_name),
+                     static_cast<uint8_t>(_category), static_cast<uint8_t>(TracePhase::counter)});
+}
+
+void Tracer::metadataTrace(std::string_view _name, std::string_view _value,
+                           TraceCategory _category) noexcept
+{
+    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+
+    if (_name.empty()) return;
+
+    try
+    {
+        auto tid = std::this_thread::get_id();
+
+        nlohmann::json args = nlohmann::json::object();
+        args["name"] = _value;
+
+        pushTrace(Trace(_category, TracePhase::metadata, _name, std::hash<std::thread::id>{}(tid),
+                        0, toNanoseconds(getCurrentTimestamp()), 0, 0, args.dump()));
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR(e.what());
+    }
+}
+
+void Tracer::objectCreated(std::string_view _name, std::string_view _args,
+                           TraceCategory _category) noexcept
+{
+    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+
+    recordPoint(TracePhase::object_created, _name, _category, _args);
+}
+
+void Tracer::objectSnapshot(std::string_view _name, std::string_view _args,
+                            TraceCategory _category) noexcept
+{
+    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+
+    recordPoint(TracePhase::object_snapshot, _name, _category, _args);
+}
+
+void Tracer::objectDestroyed(std::string_view _name, std::string_view _args,
+                             TraceCategory _category) noexcept
+{
+    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+
+    recordPoint(TracePhase::object_destroyed, _name, _category, _args);
+}
+
+void Tracer::spanTrace(std::string_view _name, TraceCategory _category,
+                       std::chrono::steady_clock::time_point _start,
+                       std::chrono::nanoseconds _duration, uint64_t _track) noexcept
+{
+    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+
+    if (_name.empty()) return;
+
+    try
+    {
+        const auto start =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(_start.time_since_epoch());
+
+        pushTrace(Trace(_category, TracePhase::complete, _name, _track, 0, start.count(),
+                        _duration.count()));
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR(e.what());
+    }
+}
+
+void Tracer::nameTrack(uint64_t _track, std::string_view _name) noexcept
+{
+    if (!m_config.enabled) return;
+
+    try
+    {
+        nlohmann::json args = nlohmann::json::object();
+        args["name"] = _name;
+
+        pushTrace(Trace(TraceCategory::function, TracePhase::metadata, "thread_name", _track, 0,
+                        toNanoseconds(getCurrentTimestamp()), 0, 0, args.dump()));
+    }
+    catch (const std::exception& e)
+    {
+        MOSAIC_ERROR(e.what());
+    }
+}
+
+void Tracer::markFrame() noexcept
+{
+    if (!m_config.enabled || m_frameName == 0) return;
+
+    ThreadBuffer* buffer = localBuffer();
+    if (!buffer) return;
+
+    record(*buffer, {getCurrentTimestamp(), 0, m_frameName,
+                     static_cast<uint8_t>(TraceCategory::function),
+                     static_cast<uint8_t>(TracePhase::instant)});
+}
+
+uint64_t Tracer::beginFlowTrace(std::string_view _name, TraceCategory _category) noexcept
+{
+    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return 0;
+
+    if (_name.empty()) return 0;
+
+    auto flowId = m_nextTraceId.fetch_add(1, std::memory_order_relaxed);
+
+    recordPoint(TracePhase::flow_begin, _name, _category, "{}", flowId);
+
+    return flowId;
+}
+
+void Tracer::stepFlowTrace(uint64_t _flowId, std::string_view _name) noexcept
+{
+    if (!m_config.enabled || _flowId == 0) return;
+
+    recordPoint(TracePhase::flow_step, _name, TraceCategory::function, "{}", _flowId);
+}
+
+void Tracer::endFlowTrace(uint64_t _flowId, std::string_view _name) noexcept
+{
+    if (!m_config.enabled || _flowId == 0) return;
+
+    recordPoint(TracePhase::flow_end, _name, TraceCategory::function, "{}", _flowId);
+}
+
+void Tracer::drain() noexcept
+{
+    try
+    {
+        // the marks recorded before are in their rings, whichever is drained first
+        const int64_t drainStart = toNanoseconds(getCurrentTimestamp());
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+        {
+            std::lock_guard<std::mutex> lock(m_buffersMutex);
+            buffers = m_buffers;
+        }
+
+        size_t count = 0;
+
+        for (auto& buffer : buffers)
+        {
+            const uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+            const uint64_t head = buffer->head.load(std::memory_order_acquire);
+
+            for (uint64_t i = tail; i < head; ++i)
+            {
+                const TraceEvent& event = buffer->events[i & (ThreadBuffer::k_capacity - 1)];
+                const auto phase = static_cast<TracePhase>(event.phase);
+
+                // the counter values and the ids as they are
+                const int64_t value = phase == TracePhase::complete
+                                          ? core::Ticks::toNanoseconds(event.value)
+                                          : event.value;
+
+                const int64_t timestamp = toNanoseconds(event.timestamp);
+
+                appendEvent(timestamp, value, buffer->tid, event.name,
+                            static_cast<TraceCategory>(event.category), phase, {});
+
+                if (phase == TracePhase::complete)
+                {
+                    m_profile->spans.push_back({timestamp, value, event.name});
+                }
+                else if (phase == TracePhase::instant && event.name == m_frameName &&
+                         m_frameName != 0)
+                {
+                    m_profile->marks.push_back(timestamp);
+                }
+            }
+
+            buffer->tail.store(head, std::memory_order_release);
+            count += head - tail;
+        }
+
+        // the events with arguments, out of the lock of their producers
+        std::vector<Trace> traces;
+
+        {
+            std::lock_guard<std::mutex> lock(m_completedMutex);
+            traces.swap(m_completedTraces);
+        }
+
+        for (const Trace& trace : traces)
+        {
+            const int64_t value = trace.phase == TracePhase::complete
+                                      ? trace.duration
+                                      : static_cast<int64_t>(trace.id);
+            const std::string_view args = trace.args == "{}" ? std::string_view() : trace.args;
+
+            const uint32_t name = internName(trace.name);
 
-    instance.flush();
+            appendEvent(trace.timestamp, value, trace.tid, name, trace.category, trace.phase,
+                        args);
 
-    delete s_instance;
-    s_instance = nullptr;
-}
+            if (trace.phase == TracePhase::complete)
+            {
+                m_profile->spans.push_back({trace.timestamp, value, name});
+            }
+        }
 
-void Tracer::beginTrace(const std::string& _name, TraceCategory _category,
-                        const std::string& _args) noexcept
-{
-    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+        m_pendingCount += count + traces.size();
 
-    if (_name.empty()) return;
+        aggregateFrames(drainStart, drainStart - k_statisticsLatencyNs);
 
-    try
-    {
-        auto tid = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+        // the rings of the threads that exited, once empty
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+        std::erase_if(m_buffers,
+                      [this](const std::shared_ptr<ThreadBuffer>& _buffer)
+                      {
+                          if (!_buffer->retired.load(std::memory_order_acquire)) return false;
 
-        Trace trace(_category, TracePhase::complete, _name, std::hash<std::thread::id>{}(tid), 0,
-                    timestamp, 0, 0, _args);
+                          const uint64_t head = _buffer->head.load(std::memory_order_acquire);
+                          if (_buffer->tail.load(std::memory_order_relaxed) != head) return false;
 
-        std::lock_guard<std::mutex> lock(m_tracesMutex);
-        m_activeTraces[tid].push(trace);
+                          m_retiredDroppedCount += _buffer->dropped.load(std::memory_order_relaxed);
+                          return true;
+                      });
     }
     catch (const std::exception& e)
     {
@@ -138,31 +1143,78 @@ void Tracer::beginTrace(const std::string& _name, TraceCategory _category,
     }
 }
 
-void Tracer::endTrace() noexcept
+void Tracer::aggregateFrames(int64_t _drainStart, int64_t _settledBefore) noexcept
 {
-    if (!m_config.enabled) return;
+    auto& profile = *m_profile;
 
     try
     {
-        auto tid = std::this_thread::get_id();
-        auto endTime = getCurrentTimestamp();
+        std::ranges::sort(profile.marks);
+
+        for (int64_t mark : profile.marks)
+        {
+            if (!profile.frames.empty())
+            {
+                if (mark <= profile.frames.back().begin) continue;
+                profile.frames.back().end = mark;
+            }
 
-        std::lock_guard<std::mutex> activeLock(m_tracesMutex);
+            profile.frames.push_back({mark, std::numeric_limits<int64_t>::max(), {}});
+        }
 
-        auto it = m_activeTraces.find(tid);
-        if (it == m_activeTraces.end() || it->second.empty()) return;
+        profile.marks.clear();
 
-        auto& trace = it->second.top();
-        trace.duration = endTime - trace.timestamp;
+        // begun after the start of the drain, its frame may be marked in a ring drained before:
+        // deferred to the next drain
+        size_t deferred = 0;
 
+        for (const auto& span : profile.spans)
         {
-            std::lock_guard<std::mutex> completedLock(m_completedMutex);
-            m_completedTraces.push_back(trace);
+            if (span.start >= _drainStart)
+            {
+                profile.spans[deferred++] = span;
+                continue;
+            }
+
+            // the newest frame begun before, the frames are few. Dropped if older than them all
+            for (auto frame = profile.frames.rbegin(); frame != profile.frames.rend(); ++frame)
+            {
+                if (span.start < frame->begin) continue;
+
+                auto& pass = frame->scopes[span.name];
+                pass.total += span.duration;
+                ++pass.calls;
+                break;
+            }
+        }
+
+        profile.spans.resize(deferred);
 
-            if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
+        const uint32_t windowFrames = std::max(m_config.statisticsFrames.load(), 1u);
+
+        std::lock_guard<std::mutex> lock(profile.mutex);
+
+        if (profile.windowFrames != windowFrames)
+        {
+            profile.windows.clear();
+            profile.frameTimes = {};
+            profile.windowFrames = windowFrames;
         }
 
-        it->second.pop();
+        while (profile.frames.size() > 1 && profile.frames.front().end < _settledBefore)
+        {
+            const auto& frame = profile.frames.front();
+            const uint64_t index = profile.settledCount++;
+
+            profile.frameTimes.push({index, frame.end - frame.begin, 1}, windowFrames);
+
+            for (const auto& [name, pass] : frame.scopes)
+            {
+                profile.windows[name].push({index, pass.total, pass.calls}, windowFrames);
+            }
+
+            profile.frames.pop_front();
+        }
     }
     catch (const std::exception& e)
     {
@@ -170,214 +1222,327 @@ void Tracer::endTrace() noexcept
     }
 }
 
-void Tracer::instantTrace(const std::string& _name, TraceCategory _category,
-                          const std::string& _args) noexcept
+void Tracer::appendEvent(int64_t _timestamp, int64_t _value, uint64_t _tid, uint32_t _name,
+                         TraceCategory _category, TracePhase _phase, std::string_view _args)
 {
-    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+    if (m_openChunk == m_pending.size() || m_pending.size() - m_openChunk >= k_chunkSize)
+    {
+        closeChunk();
 
-    if (_name.empty()) return;
+        m_openChunk = m_pending.size();
+        appendBytes(m_pending, ChunkHeader{static_cast<uint32_t>(ChunkType::events), 0});
+    }
 
-    try
-    {
-        auto tid = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+    EventRecord record{};
+    record.timestamp = _timestamp;
+    record.value = _value;
+    record.tid = _tid;
+    record.name = _name;
+    record.argsSize = static_cast<uint32_t>(_args.size());
+    record.category = static_cast<uint8_t>(_category);
+    record.phase = static_cast<uint8_t>(_phase);
+
+    appendBytes(m_pending, record);
+    appendString(m_pending, _args);
+}
 
-        Trace trace(_category, TracePhase::instant, _name, std::hash<std::thread::id>{}(tid), 0,
-                    timestamp, 0, 0, _args);
+void Tracer::closeChunk() noexcept
+{
+    if (m_openChunk == m_pending.size()) return;
 
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
+    const auto size = static_cast<uint32_t>(m_pending.size() - m_openChunk - sizeof(ChunkHeader));
+    std::memcpy(m_pending.data() + m_openChunk + offsetof(ChunkHeader, size), &size, sizeof(size));
 
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
-    }
-    catch (const std::exception& e)
+    m_openChunk = m_pending.size();
+}
+
+void Tracer::runFlusher(std::stop_token _stop) noexcept
+{
+    while (!_stop.stop_requested())
     {
-        MOSAIC_ERROR(e.what());
+        {
+            std::unique_lock<std::mutex> lock(m_flusherMutex);
+            m_flusherWakeUp.wait_for(lock, _stop, k_drainPeriod,
+                                     [this] { return m_drainRequested; });
+            m_drainRequested = false;
+        }
+
+        std::lock_guard<std::mutex> drainLock(m_drainMutex);
+        drain();
+        streamPending();
+
+        if (!m_config.autoFlush) continue;
+
+        const auto interval = std::chrono::milliseconds(m_config.flushIntervalMs.load());
+
+        if (m_pendingCount >= m_config.maxTraces ||
+            std::chrono::steady_clock::now() - m_lastFlush >= interval)
+        {
+            writePending();
+        }
     }
 }
 
-void Tracer::counterTrace(const std::string& _name, double _value, TraceCategory _category) noexcept
+void Tracer::flush() noexcept
 {
-    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+    drain();
 
-    if (_name.empty()) return;
+    // every frame ended is settled
+    aggregateFrames(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
 
-    try
-    {
-        auto tid = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+    writePending();
+}
 
-        nlohmann::json args = nlohmann::json::object();
-        args[_name] = _value;
+void Tracer::clear() noexcept
+{
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+    drain();
 
-        Trace trace(_category, TracePhase::counter, _name, std::hash<std::thread::id>{}(tid), 0,
-                    timestamp, 0, 0, args.dump());
+    m_pending.clear();
+    m_openChunk = 0;
+    m_pendingCount = 0;
+    m_streamed = 0;
+}
 
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
+bool Tracer::startStreaming(uint16_t _port) noexcept
+{
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+
+    try
+    {
+        auto stream = std::make_unique<TraceStream>();
+        if (!stream->listen(_port)) return false;
 
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
+        m_stream = std::move(stream);
+        m_streamed = 0;
+
+        return true;
     }
     catch (const std::exception& e)
     {
         MOSAIC_ERROR(e.what());
+        return false;
     }
 }
 
-void Tracer::metadataTrace(const std::string& _name, const std::string& _value,
-                           TraceCategory _category) noexcept
+void Tracer::stopStreaming() noexcept
 {
-    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+    m_stream.reset();
+}
 
-    if (_name.empty()) return;
+bool Tracer::startSampling(std::chrono::microseconds _interval) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_samplerMutex);
 
     try
     {
-        auto tid = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+        // before the samples, which the viewers symbolize against them
+        nlohmann::json modules = nlohmann::json::array();
+        for (const ModuleInfo& module : SamplingProfiler::listModules())
+        {
+            modules.push_back(
+                {{"path", module.path}, {"start", module.start}, {"end", module.end},
+                 {"bias", module.bias}});
+        }
+
+        if (m_sampler) m_sampler->stop();
+
+        auto sampler = std::make_unique<SamplingProfiler>();
+        if (!sampler->start(_interval, [this](std::span<const StackSample> _samples)
+                            { recordSamples(_samples); }))
+        {
+            return false;
+        }
+
+        {
+            // the files opened from now on carry them
+            std::lock_guard<std::mutex> drainLock(m_drainMutex);
+            m_metadata["modules"] = modules;
+        }
 
+        // the current file learns them from the event
         nlohmann::json args = nlohmann::json::object();
-        args["name"] = _value;
+        args["modules"] = std::move(modules);
 
-        Trace trace(_category, TracePhase::metadata, _name, std::hash<std::thread::id>{}(tid), 0,
-                    timestamp, 0, 0, args.dump());
+        pushTrace(Trace(TraceCategory::function, TracePhase::metadata, "modules", 0, 0,
+                        toNanoseconds(getCurrentTimestamp()), 0, 0, args.dump()));
 
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
+        m_sampler = std::move(sampler);
 
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
+        return true;
     }
     catch (const std::exception& e)
     {
         MOSAIC_ERROR(e.what());
+        return false;
     }
 }
 
-void Tracer::objectCreated(const std::string& _name, const std::string& _args,
-                           TraceCategory _category) noexcept
+void Tracer::stopSampling() noexcept
 {
-    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
-
-    if (_name.empty()) return;
+    std::lock_guard<std::mutex> lock(m_samplerMutex);
+    if (m_sampler) m_sampler->stop();
+}
 
-    try
-    {
-        auto tid = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+bool Tracer::isSampling() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_samplerMutex);
+    return m_sampler && m_sampler->isRunning();
+}
 
-        Trace trace(_category, TracePhase::object_created, _name, std::hash<std::thread::id>{}(tid),
-                    0, timestamp, 0, 0, _args);
+uint64_t Tracer::getSampleCount() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_samplerMutex);
+    return m_sampler ? m_sampler->getSampleCount() : 0;
+}
 
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
+uint64_t Tracer::getMissedSampleCount() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_samplerMutex);
+    return m_sampler ? m_sampler->getMissedCount() : 0;
+}
 
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
-    }
-    catch (const std::exception& e)
-    {
-        MOSAIC_ERROR(e.what());
-    }
+uint16_t Tracer::getStreamPort() const noexcept
+{
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+    return m_stream ? m_stream->getPort() : 0;
 }
 
-void Tracer::objectSnapshot(const std::string& _name, const std::string& _args,
-                            TraceCategory _category) noexcept
+bool Tracer::isStreamConnected() const noexcept
 {
-    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+    return m_stream && m_stream->isConnected();
+}
 
-    if (_name.empty()) return;
+size_t Tracer::getActiveTraceCount() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
 
-    try
+    size_t count = 0;
+    for (const auto& buffer : m_buffers)
     {
-        auto tid = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+        if (!buffer->retired.load(std::memory_order_relaxed))
+        {
+            count += buffer->depth.load(std::memory_order_relaxed);
+        }
+    }
 
-        Trace trace(_category, TracePhase::object_snapshot, _name,
-                    std::hash<std::thread::id>{}(tid), 0, timestamp, 0, 0, _args);
+    return count;
+}
 
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
+size_t Tracer::getCompletedTraceCount() const noexcept
+{
+    // no drain in between, it would move events from the rings to m_pending
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+
+    size_t count = m_pendingCount;
 
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
-    }
-    catch (const std::exception& e)
     {
-        MOSAIC_ERROR(e.what());
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        for (const auto& buffer : m_buffers)
+        {
+            count += buffer->head.load(std::memory_order_acquire) -
+                     buffer->tail.load(std::memory_order_acquire);
+        }
     }
+
+    std::lock_guard<std::mutex> lock(m_completedMutex);
+    return count + m_completedTraces.size();
 }
 
-void Tracer::objectDestroyed(const std::string& _name, const std::string& _args,
-                             TraceCategory _category) noexcept
+size_t Tracer::getDroppedTraceCount() const noexcept
 {
-    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return;
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
 
-    if (_name.empty()) return;
+    size_t count = m_retiredDroppedCount;
+    for (const auto& buffer : m_buffers) count += buffer->dropped.load(std::memory_order_relaxed);
 
+    return count;
+}
+
+double Tracer::getTracingOverheadMs() const noexcept
+{
+    return 0.000016; // about 16 ns per scoped trace: two counter reads and ring pushes
+}
+
+std::vector<ScopeStatistics> Tracer::getScopeStatistics() const noexcept
+{
     try
     {
-        auto tid = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+        const auto& profile = *m_profile;
+        std::lock_guard<std::mutex> lock(profile.mutex);
 
-        Trace trace(_category, TracePhase::object_destroyed, _name,
-                    std::hash<std::thread::id>{}(tid), 0, timestamp, 0, 0, _args);
+        NameTable& table = NameTable::get();
+        std::shared_lock nameLock(table.mutex);
 
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
+        std::vector<ScopeStatistics> statistics;
+
+        for (const auto& [name, window] : profile.windows)
+        {
+            auto scope = profile.summarize(table.names[name], window);
+            if (scope.frames > 0) statistics.push_back(std::move(scope));
+        }
 
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
+        std::ranges::sort(statistics, std::ranges::greater{}, &ScopeStatistics::mean);
+
+        return statistics;
     }
     catch (const std::exception& e)
     {
         MOSAIC_ERROR(e.what());
+        return {};
     }
 }
 
-uint64_t Tracer::beginFlowTrace(const std::string& _name, TraceCategory _category) noexcept
+ScopeStatistics Tracer::getFrameStatistics() const noexcept
 {
-    if (!m_config.enabled || !m_config.categoryEnabled[static_cast<int>(_category)]) return 0;
-
-    if (_name.empty()) return 0;
-
     try
     {
-        auto tid = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
-        auto flowId = m_nextTraceId++;
-
-        Trace trace(_category, TracePhase::flow_begin, _name, std::hash<std::thread::id>{}(tid), 0,
-                    timestamp, 0, flowId, "{}");
-
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
-
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
+        const auto& profile = *m_profile;
+        std::lock_guard<std::mutex> lock(profile.mutex);
 
-        return flowId;
+        return profile.summarize("Frame", profile.frameTimes);
     }
     catch (const std::exception& e)
     {
         MOSAIC_ERROR(e.what());
-        return 0;
+        return {};
     }
 }
 
-void Tracer::stepFlowTrace(uint64_t _flowId, const std::string& _name) noexcept
+void Tracer::writePending() noexcept
 {
-    if (!m_config.enabled || _flowId == 0) return;
+    m_lastFlush = std::chrono::steady_clock::now();
+
+    streamPending();
+
+    if (m_pendingCount == 0) return;
 
     try
     {
-        if (_name.empty()) return;
+        closeChunk();
 
-        auto threadId = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+        if (m_fileSize >= MB_TO_BYTES(uint64_t{m_config.maxFileSizeMb})) rotateFile();
 
-        Trace trace(TraceCategory::function, TracePhase::flow_step, _name,
-                    std::hash<std::thread::id>{}(threadId), 0, timestamp, 0, _flowId, "{}");
+        if (m_file.is_open())
+        {
+            // the names (and sources) defined since, the events refer to no other
+            std::vector<char> definitions;
+            appendDefinitions(definitions, m_namesWritten, m_sourcesWritten);
 
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
+            m_file.write(definitions.data(), static_cast<std::streamsize>(definitions.size()));
+            m_file.write(m_pending.data(), static_cast<std::streamsize>(m_pending.size()));
+            m_file.flush();
 
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
+            m_fileSize += definitions.size() + m_pending.size();
+        }
+
+        m_pending.clear();
+        m_openChunk = 0;
+        m_pendingCount = 0;
+        m_streamed = 0;
     }
     catch (const std::exception& e)
     {
@@ -385,118 +1550,137 @@ void Tracer::stepFlowTrace(uint64_t _flowId, const std::string& _name) noexcept
     }
 }
 
-void Tracer::endFlowTrace(uint64_t _flowId, const std::string& _name) noexcept
+void Tracer::streamPending() noexcept
 {
-    if (!m_config.enabled || _flowId == 0) return;
+    if (!m_stream) return;
 
     try
     {
-        if (_name.empty()) return;
+        if (m_stream->accept())
+        {
+            // a new viewer reads a file of its own: the header, then every name again
+            closeChunk();
+            m_streamed = m_pending.size();
+            m_namesStreamed = 0;
+            m_sourcesStreamed = 0;
+
+            std::vector<char> header;
+            appendFileHeader(header, m_metadata.dump());
+            m_stream->enqueue(header);
+        }
 
-        auto threadId = std::this_thread::get_id();
-        auto timestamp = getCurrentTimestamp();
+        if (!m_stream->isConnected()) return;
 
-        Trace trace(TraceCategory::function, TracePhase::flow_end, _name,
-                    std::hash<std::thread::id>{}(threadId), 0, timestamp, 0, _flowId, "{}");
+        closeChunk();
 
-        std::lock_guard<std::mutex> lock(m_completedMutex);
-        m_completedTraces.push_back(trace);
+        // the lowest priority kept, by how far behind the viewer is
+        const size_t backlog = m_stream->getQueuedSize();
+        const uint8_t kept = backlog < k_streamBacklog ? 0 : backlog < 2 * k_streamBacklog ? 1 : 3;
 
-        if (m_config.autoFlush && m_completedTraces.size() >= m_config.maxTraces) flushToFile();
-    }
-    catch (const std::exception& e)
-    {
-        MOSAIC_ERROR(e.what());
-    }
-}
+        std::vector<char>& events = m_streamBuffer;
+        events.clear();
+        appendBytes(events, ChunkHeader{static_cast<uint32_t>(ChunkType::events), 0});
 
-void Tracer::flush() noexcept
-{
-    std::lock_guard<std::mutex> lock(m_completedMutex);
-    flushToFile();
-}
+        uint64_t dropped = 0;
 
-void Tracer::clear() noexcept
-{
-    std::lock_guard<std::mutex> completedLock(m_completedMutex);
-    std::lock_guard<std::mutex> traceLock(m_tracesMutex);
+        for (size_t chunk = m_streamed; chunk < m_pending.size();)
+        {
+            ChunkHeader header;
+            std::memcpy(&header, m_pending.data() + chunk, sizeof(header));
 
-    m_completedTraces.clear();
-    m_activeTraces.clear();
-}
+            const size_t end = chunk + sizeof(ChunkHeader) + header.size;
 
-size_t Tracer::getActiveTraceCount() const noexcept
-{
-    try
-    {
-        std::lock_guard<std::mutex> lock(m_tracesMutex);
-        size_t count = 0;
-        for (const auto& [tid, stack] : m_activeTraces)
+            for (size_t offset = chunk + sizeof(ChunkHeader); offset < end;)
+            {
+                EventRecord record;
+                std::memcpy(&record, m_pending.data() + offset, sizeof(record));
+
+                const size_t size = sizeof(EventRecord) + record.argsSize;
+
+                // frames and thread names keep the stream readable
+                const bool essential = record.name == m_frameName ||
+                                       record.phase == static_cast<uint8_t>(TracePhase::metadata);
+                const uint8_t priority = essential ? 2 : k_streamPriorities[record.category & 7];
+
+                if (priority >= kept)
+                {
+                    const char* bytes = m_pending.data() + offset;
+                    events.insert(events.end(), bytes, bytes + size);
+                }
+                else
+                {
+                    ++dropped;
+                }
+
+                offset += size;
+            }
+
+            chunk = end;
+        }
+
+        m_streamed = m_pending.size();
+        if (dropped > 0) m_streamDropped.fetch_add(dropped, std::memory_order_relaxed);
+
+        if (events.size() > sizeof(ChunkHeader))
         {
-            count += stack.size();
+            const auto size = static_cast<uint32_t>(events.size() - sizeof(ChunkHeader));
+            std::memcpy(events.data() + offsetof(ChunkHeader, size), &size, sizeof(size));
+
+            std::vector<char> definitions;
+            appendDefinitions(definitions, m_namesStreamed, m_sourcesStreamed);
+
+            m_stream->enqueue(definitions);
+            m_stream->enqueue(events);
         }
-        return count;
+
+        m_stream->send();
     }
-    catch (const std::exception&)
+    catch (const std::exception& e)
     {
-        return 0;
+        MOSAIC_ERROR(e.what());
     }
 }
 
-size_t Tracer::getCompletedTraceCount() const noexcept
-{
-    std::lock_guard<std::mutex> lock(m_completedMutex);
-    return m_completedTraces.size();
-}
-
-double Tracer::getTracingOverheadMs() const noexcept
-{
-    return 0.001; // 1 microsecond conservative estimate per trace
-}
-
-void Tracer::flushToFile() noexcept
+bool Tracer::openFile() noexcept
 {
-    if (m_completedTraces.empty()) return;
-
     try
     {
-        if (std::filesystem::exists(m_currentFile))
+        // never over the file of an earlier session
+        m_currentFile = generateFileName();
+        while (std::filesystem::exists(m_currentFile))
         {
-            auto fileSize = std::filesystem::file_size(m_currentFile);
-            if (fileSize > MB_TO_BYTES(m_config.maxFileSizeMb)) rotateFile();
+            m_fileCounter++;
+            m_currentFile = generateFileName();
         }
 
-        nlohmann::json output;
-        output["traceEvents"] = nlohmann::json::array();
+        m_file.open(m_currentFile, std::ios::binary | std::ios::trunc);
+        if (!m_file.is_open()) return false;
 
-        for (const auto& trace : m_completedTraces)
-        {
-            output["traceEvents"].push_back(traceToJson(trace));
-        }
+        std::vector<char> header;
+        appendFileHeader(header, m_metadata.dump());
 
-        output["metadata"] = m_metadata;
-        output["endTime"] = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        m_file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        m_file.flush();
 
-        std::ofstream file(m_currentFile, std::ios::app);
-        if (file.is_open())
-        {
-            file << output.dump(4) << std::endl;
-            file.close();
-        }
+        m_fileSize = header.size();
+        m_namesWritten = 0;
+        m_sourcesWritten = 0;
 
-        m_completedTraces.clear();
-        m_lastFlush = std::chrono::steady_clock::now();
+        return m_file.good();
     }
     catch (const std::exception& e)
     {
         MOSAIC_ERROR(e.what());
+        return false;
     }
 }
 
 void Tracer::rotateFile() noexcept
 {
-    m_currentFile = generateFileName();
+    m_file.close();
     m_fileCounter++;
+
+    if (!openFile()) MOSAIC_ERROR("Tracer: could not open {}", m_currentFile);
 }
 
 std::string Tracer::generateFileName() noexcept
@@ -514,58 +1698,17 @@ std::string Tracer::generateFileName() noexcept
             oss << "_" << std::setfill('0') << std::setw(3) << m_fileCounter;
         }
 
-        oss << ".json";
+        oss << ".mtrace";
         return oss.str();
     }
     catch (const std::exception& e)
     {
         MOSAIC_ERROR(e.what());
-        return "./traces/trace_fallback.json";
-    }
-}
-
-nlohmann::json Tracer::traceToJson(const Trace& _trace) const noexcept
-{
-    try
-    {
-        nlohmann::json json;
-        json["cat"] = c_categoryNames[static_cast<int>(_trace.category)];
-        json["ph"] = c_phaseNames[static_cast<int>(_trace.phase)];
-        json["name"] = _trace.name;
-        json["pid"] = _trace.pid;
-        json["tid"] = _trace.tid;
-        json["ts"] = _trace.timestamp;
-
-        if (_trace.duration > 0) json["dur"] = _trace.duration;
-
-        if (_trace.id > 0) json["id"] = _trace.id;
-
-        if (!_trace.args.empty() && _trace.args != "{}")
-        {
-            try
-            {
-                json["args"] = nlohmann::json::parse(_trace.args);
-            }
-            catch (const std::exception&)
-            {
-                json["args"] = nlohmann::json::object();
-            }
-        }
-
-        return json;
-    }
-    catch (const std::exception& e)
-    {
-        MOSAIC_ERROR(e.what());
-        return nlohmann::json::object();
+        return "./traces/trace_fallback.mtrace";
     }
 }
 
-int64_t Tracer::getCurrentTimestamp() const noexcept
-{
-    auto now = std::chrono::high_resolution_clock::now();
-    return std::chrono::time_point_cast<std::chrono::microseconds>(now).time_since_epoch().count();
-}
+int64_t Tracer::getCurrentTimestamp() noexcept { return core::Ticks::now(); }
 
 } // namespace tools
 } // namespace mosaic
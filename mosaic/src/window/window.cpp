@@ -1,8 +1,7 @@
 #include "mosaic/window/window.hpp"
 
-#include <vector>
 #include <memory>
-#include <atomic>
+#include <utility>
 
 #include "mosaic/defines.hpp"
 
@@ -20,8 +19,16 @@ namespace window
 struct Window::Impl
 {
     WindowProperties properties;
+    uint64_t eventCount = 0;
 
-#define DEFINE_CALLBACK(_Type, _Name, ...) std::vector<_Type> _Name##Callbacks;
+    // batched until flushBatchedEvents()
+    double pendingScrollX = 0.0;
+    double pendingScrollY = 0.0;
+    bool hasPendingScroll = false;
+    glm::ivec2 pendingPos = glm::ivec2(0, 0);
+    bool hasPendingPos = false;
+
+#define DEFINE_CALLBACK(_Type, _Name, ...) _Type _Name##Callbacks;
 #include "mosaic/window/callbacks.def"
 #undef DEFINE_CALLBACK
 };
@@ -46,6 +53,8 @@ const CursorProperties Window::getCursorProperties() const
     return m_impl->properties.cursorProperties;
 }
 
+uint64_t Window::getEventCount() const { return m_impl->eventCount; }
+
 WindowProperties& Window::getWindowPropertiesInternal() { return m_impl->properties; }
 
 CursorProperties& Window::getCursorPropertiesInternal()
@@ -53,28 +62,56 @@ CursorProperties& Window::getCursorPropertiesInternal()
     return m_impl->properties.cursorProperties;
 }
 
-#define DEFINE_CALLBACK(_Type, _Name, _Params, _Args)                                       \
-    size_t Window::register##_Name##Callback(const _Type::CallbackFn& cb)                   \
-    {                                                                                       \
-        static std::atomic<size_t> idCounter{0};                                            \
-        size_t id = ++idCounter;                                                            \
-        m_impl->_Name##Callbacks.emplace_back(id, cb);                                      \
-        return id;                                                                          \
-    }                                                                                       \
-                                                                                            \
-    void Window::unregister##_Name##Callback(size_t id)                                     \
-    {                                                                                       \
-        auto& callbacks = m_impl->_Name##Callbacks;                                         \
-        auto it = std::remove_if(callbacks.begin(), callbacks.end(),                        \
-                                 [id](const _Type& cb) { return cb.id == id; });            \
-        if (it != callbacks.end()) callbacks.erase(it);                                     \
-    }                                                                                       \
-                                                                                            \
-    std::vector<_Type> Window::get##_Name##Callbacks() { return m_impl->_Name##Callbacks; } \
-                                                                                            \
-    void Window::invoke##_Name##Callbacks _Params                                           \
-    {                                                                                       \
-        for (auto& cb : m_impl->_Name##Callbacks) cb.callback _Args;                        \
+void Window::flushBatchedEvents()
+{
+    // counted when batched, the callbacks are dispatched directly
+    if (m_impl->hasPendingScroll)
+    {
+        m_impl->hasPendingScroll = false;
+        m_impl->WindowScrollCallbacks.dispatch(m_impl->pendingScrollX, m_impl->pendingScrollY);
+        m_impl->pendingScrollX = 0.0;
+        m_impl->pendingScrollY = 0.0;
+    }
+
+    if (m_impl->hasPendingPos)
+    {
+        m_impl->hasPendingPos = false;
+        m_impl->WindowPosCallbacks.dispatch(m_impl->pendingPos.x, m_impl->pendingPos.y);
+    }
+}
+
+void Window::batchWindowScrollEvent(double _xoffset, double _yoffset)
+{
+    ++m_impl->eventCount;
+    m_impl->pendingScrollX += _xoffset;
+    m_impl->pendingScrollY += _yoffset;
+    m_impl->hasPendingScroll = true;
+}
+
+void Window::batchWindowPosEvent(int _x, int _y)
+{
+    ++m_impl->eventCount;
+    m_impl->pendingPos = glm::ivec2(_x, _y);
+    m_impl->hasPendingPos = true;
+}
+
+#define DEFINE_CALLBACK(_Type, _Name, _Params, _Args)                                            \
+    size_t Window::register##_Name##Callback(_Type::Callback _callback)                          \
+    {                                                                                            \
+        return m_impl->_Name##Callbacks.add(std::move(_callback));                               \
+    }                                                                                            \
+                                                                                                 \
+    void Window::unregister##_Name##Callback(size_t _id)                                         \
+    {                                                                                            \
+        m_impl->_Name##Callbacks.remove(_id);                                                    \
+    }                                                                                            \
+                                                                                                 \
+    const _Type& Window::get##_Name##Callbacks() const { return m_impl->_Name##Callbacks; }      \
+                                                                                                 \
+    void Window::invoke##_Name##Callbacks _Params                                                \
+    {                                                                                            \
+        ++m_impl->eventCount;                                                                    \
+        m_impl->_Name##Callbacks.dispatch _Args;                                                 \
     }
 
 #include "mosaic/window/callbacks.def"
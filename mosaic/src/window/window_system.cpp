@@ -112,5 +112,35 @@ void WindowSystem::destroyAllWindows()
 
 [[nodiscard]] size_t WindowSystem::getWindowCount() const { return m_impl->windows.size(); }
 
+void WindowSystem::flushBatchedEvents()
+{
+    for (auto& [id, window] : m_impl->windows) window->flushBatchedEvents();
+}
+
+uint64_t WindowSystem::getEventCount() const
+{
+    uint64_t count = 0;
+    for (auto& [id, window] : m_impl->windows) count += window->getEventCount();
+
+    return count;
+}
+
+bool WindowSystem::areAllWindowsMinimized() const
+{
+    if (m_impl->windows.empty()) return false;
+
+    for (auto& [id, window] : m_impl->windows)
+    {
+        const auto framebufferSize = window->getFramebufferSize();
+
+        if (!window->getWindowProperties().isMinimized && framebufferSize.x * framebufferSize.y > 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 } // namespace window
 } // namespace mosaic
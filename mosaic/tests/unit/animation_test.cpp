@@ -0,0 +1,343 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/scene/animation.hpp>
+
+using namespace mosaic::scene;
+using namespace mosaic::ecs;
+
+namespace
+{
+
+constexpr float k_frameRate = 30.0f;
+
+// A chain of joints one unit apart along x
+Skeleton makeChain(size_t _jointCount)
+{
+    std::vector<int32_t> parents;
+    std::vector<JointTransform> bindPose(_jointCount);
+    for (size_t joint = 0; joint < _jointCount; ++joint)
+    {
+        parents.push_back(int32_t(joint) - 1);
+        if (joint > 0) bindPose[joint].translation = glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+    return Skeleton(std::move(parents), std::move(bindPose));
+}
+
+// A joint of the chain swinging around z at _frame of _frameCount, the root sliding along x
+JointTransform chainSample(size_t _joint, size_t _frame, size_t _frameCount)
+{
+    const float t = float(_frame) / float(_frameCount - 1);
+
+    JointTransform sample;
+    sample.translation = _joint == 0 ? glm::vec3(2.0f * t, 0.0f, 0.0f) : glm::vec3(1.0f, 0, 0);
+    sample.rotation = glm::angleAxis(std::sin(6.0f * t) * 0.8f + 0.1f * float(_joint),
+                                     glm::vec3(0.0f, 0.0f, 1.0f));
+    return sample;
+}
+
+std::vector<JointTransform> chainSamples(size_t _jointCount, size_t _frameCount)
+{
+    std::vector<JointTransform> samples;
+    for (size_t frame = 0; frame < _frameCount; ++frame)
+    {
+        for (size_t joint = 0; joint < _jointCount; ++joint)
+        {
+            samples.push_back(chainSample(joint, frame, _frameCount));
+        }
+    }
+    return samples;
+}
+
+// The angle between two rotations
+float angle(const glm::quat& _a, const glm::quat& _b)
+{
+    const float dot = std::abs(_a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w);
+    return 2.0f * std::acos(std::min(dot, 1.0f));
+}
+
+// The model space transform of a point by a skinning matrix
+glm::vec3 skin(const SkinningMatrix& _matrix, const glm::vec3& _point)
+{
+    const float* r = _matrix.rows.data();
+    return glm::vec3(r[0] * _point.x + r[1] * _point.y + r[2] * _point.z + r[3],
+                     r[4] * _point.x + r[5] * _point.y + r[6] * _point.z + r[7],
+                     r[8] * _point.x + r[9] * _point.y + r[10] * _point.z + r[11]);
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Clips
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(AnimationClipTest, CompressedClipsSampleWithinTheTolerance)
+{
+    constexpr size_t k_joints = 11; // a full block of lanes and a partial one
+    constexpr size_t k_frames = 61;
+    const std::vector<JointTransform> samples = chainSamples(k_joints, k_frames);
+
+    const AnimationClip clip = AnimationClip::compress(k_joints, samples, k_frameRate);
+    EXPECT_FLOAT_EQ(clip.getDuration(), 2.0f);
+    EXPECT_LT(clip.getByteSize(), samples.size() * sizeof(JointTransform) / 3);
+
+    AnimationPose pose;
+    for (size_t frame = 0; frame < k_frames; frame += 7)
+    {
+        clip.sample(float(frame) / k_frameRate, pose);
+        ASSERT_EQ(pose.size(), k_joints);
+
+        for (size_t joint = 0; joint < k_joints; ++joint)
+        {
+            const JointTransform expected = chainSample(joint, frame, k_frames);
+            const JointTransform sampled = pose.getJoint(joint);
+
+            EXPECT_NEAR(sampled.translation.x, expected.translation.x, 2e-3f);
+            EXPECT_NEAR(sampled.translation.y, 0.0f, 1e-6f);
+            EXPECT_LT(angle(sampled.rotation, expected.rotation), 2e-3f);
+            EXPECT_NEAR(sampled.scale.x, 1.0f, 1e-6f);
+        }
+    }
+
+    // past the end it holds the last frame
+    clip.sample(10.0f, pose);
+    EXPECT_NEAR(pose.getJoint(0).translation.x, 2.0f, 1e-3f);
+}
+
+TEST(AnimationClipTest, KeyframeReductionDropsInterpolatedKeys)
+{
+    constexpr size_t k_joints = 3;
+    constexpr size_t k_frames = 120;
+    const std::vector<JointTransform> samples = chainSamples(k_joints, k_frames);
+
+    const AnimationClip clip = AnimationClip::compress(k_joints, samples, k_frameRate);
+
+    // the root slides linearly, the other translations and every scale are still: 2 keys each
+    const AnimationClip::Channel& translations = clip.getTranslations();
+    for (size_t joint = 0; joint < k_joints; ++joint)
+    {
+        EXPECT_EQ(translations.firstKey[joint + 1] - translations.firstKey[joint], 2u);
+    }
+    EXPECT_EQ(clip.getScales().frames.size(), 2 * k_joints);
+
+    // the rotations swing, they keep more but far from every frame
+    const size_t rotationKeys = clip.getRotations().frames.size();
+    EXPECT_GT(rotationKeys, 2 * k_joints);
+    EXPECT_LT(rotationKeys, k_joints * k_frames / 2);
+
+    // a looser tolerance keeps fewer
+    AnimationTolerance loose;
+    loose.rotation = 0.02f;
+    EXPECT_LT(AnimationClip::compress(k_joints, samples, k_frameRate, loose).getKeyCount(),
+              clip.getKeyCount());
+
+    EXPECT_THROW((void)AnimationClip::compress(2, samples, k_frameRate - 60.0f),
+                 std::runtime_error);
+    EXPECT_THROW((void)AnimationClip::compress(7, samples, k_frameRate), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Poses
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(AnimationPoseTest, BlendingInterpolatesTheShortWay)
+{
+    AnimationPose a(3);
+    AnimationPose b(3);
+
+    JointTransform joint;
+    joint.translation = glm::vec3(2.0f, 0.0f, 0.0f);
+    joint.rotation = glm::angleAxis(1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+    b.setJoint(1, joint);
+
+    // the same rotation as -q, blending must not go around the long way
+    const glm::quat q = glm::angleAxis(0.5f, glm::vec3(0.0f, 0.0f, 1.0f));
+    joint.translation = glm::vec3(0.0f);
+    joint.rotation = glm::quat(-q.w, -q.x, -q.y, -q.z);
+    b.setJoint(2, joint);
+
+    AnimationPose out;
+    blendPoses(a, b, 0.5f, out);
+    ASSERT_EQ(out.size(), 3u);
+
+    EXPECT_NEAR(out.getJoint(1).translation.x, 1.0f, 1e-6f);
+    EXPECT_LT(angle(out.getJoint(1).rotation,
+                    glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f))),
+              1e-4f);
+    EXPECT_LT(angle(out.getJoint(2).rotation,
+                    glm::angleAxis(0.25f, glm::vec3(0.0f, 0.0f, 1.0f))),
+              1e-4f);
+    EXPECT_LT(angle(out.getJoint(0).rotation, glm::quat(1.0f, 0.0f, 0.0f, 0.0f)), 1e-6f);
+}
+
+TEST(AnimationPoseTest, PalettesMoveTheBindPoseToThePose)
+{
+    const Skeleton skeleton = makeChain(3);
+
+    // the bind pose skins every vertex where it was modeled
+    AnimationPose pose(3);
+    for (size_t joint = 0; joint < 3; ++joint) pose.setJoint(joint, skeleton.getBindPose()[joint]);
+
+    std::vector<SkinningMatrix> palette(3);
+    computeSkinningPalette(skeleton, pose, palette);
+    for (const SkinningMatrix& matrix : palette)
+    {
+        const glm::vec3 point = skin(matrix, glm::vec3(0.5f, 1.0f, -2.0f));
+        EXPECT_NEAR(point.x, 0.5f, 1e-5f);
+        EXPECT_NEAR(point.y, 1.0f, 1e-5f);
+        EXPECT_NEAR(point.z, -2.0f, 1e-5f);
+    }
+
+    // a quarter turn of the middle joint swings the tip from (2, 0, 0) to (1, 1, 0)
+    JointTransform bent = skeleton.getBindPose()[1];
+    bent.rotation = glm::angleAxis(1.5707964f, glm::vec3(0.0f, 0.0f, 1.0f));
+    pose.setJoint(1, bent);
+
+    computeSkinningPalette(skeleton, pose, palette);
+    const glm::vec3 tip = skin(palette[2], glm::vec3(2.0f, 0.0f, 0.0f));
+    EXPECT_NEAR(tip.x, 1.0f, 1e-5f);
+    EXPECT_NEAR(tip.y, 1.0f, 1e-5f);
+
+    const glm::vec3 root = skin(palette[0], glm::vec3(0.5f, 0.0f, 0.0f));
+    EXPECT_NEAR(root.x, 0.5f, 1e-5f);
+    EXPECT_NEAR(root.y, 0.0f, 1e-5f);
+
+    EXPECT_THROW(Skeleton({1, -1}, std::vector<JointTransform>(2)), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AnimationSystem
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class AnimationSystemTest : public ::testing::Test
+{
+   protected:
+    std::unique_ptr<ComponentRegistry> m_compRegistry;
+    std::unique_ptr<EntityRegistry> m_entityRegistry;
+    AnimationLibrary m_library;
+
+    void SetUp() override
+    {
+        m_compRegistry = std::make_unique<ComponentRegistry>(16);
+        m_compRegistry->registerComponent<AnimatorComponent>("Animator");
+        m_entityRegistry = std::make_unique<EntityRegistry>(m_compRegistry.get());
+    }
+};
+
+TEST_F(AnimationSystemTest, ParallelUpdateWritesThePalettesToTheRing)
+{
+    constexpr size_t k_joints = 24;
+    constexpr size_t k_characters = 500;
+
+    const uint32_t skeleton = m_library.addSkeleton(makeChain(k_joints));
+    const uint32_t walk =
+        m_library.addClip(AnimationClip::compress(k_joints, chainSamples(k_joints, 31), 30.0f));
+    const uint32_t run =
+        m_library.addClip(AnimationClip::compress(k_joints, chainSamples(k_joints, 16), 30.0f));
+
+    std::vector<EntityMeta> characters;
+    for (size_t i = 0; i < k_characters; ++i)
+    {
+        AnimatorComponent animator(skeleton, walk, 1.0f + float(i % 7) * 0.1f);
+        if (i % 2 == 1)
+        {
+            animator.blendClip = run;
+            animator.blendWeight = 0.3f;
+        }
+        characters.push_back(
+            m_entityRegistry->createEntity<AnimatorComponent>(std::make_tuple(animator)));
+    }
+
+    // an animator of a missing clip is skipped
+    const EntityMeta broken =
+        m_entityRegistry->createEntity<AnimatorComponent>(std::make_tuple(skeleton, 99u));
+
+    constexpr size_t k_paletteSize = k_joints * sizeof(SkinningMatrix);
+    std::vector<std::byte> memory(2 * k_characters * k_paletteSize);
+    mosaic::graphics::FrameRing ring;
+    ring.reset(memory.data(), memory.size() / 2, 2);
+    ring.beginFrame(0);
+
+    mosaic::core::CPUInfo cpuInfo;
+    cpuInfo.logicalCores = 8;
+    cpuInfo.physicalCores = 4;
+
+    mosaic::exec::ThreadPool pool;
+    ASSERT_TRUE(pool.initialize(cpuInfo).isOk());
+
+    AnimationSystem system(*m_entityRegistry, m_library);
+    EXPECT_EQ(system.update(pool, 0.25f, ring), k_characters);
+    EXPECT_EQ(system.getPalettes().size, k_characters * k_paletteSize);
+
+    // every palette is the one of its character sampled alone
+    AnimationPose pose;
+    AnimationPose blend;
+    std::vector<SkinningMatrix> expected(k_joints);
+    for (size_t i = 0; i < k_characters; i += 37)
+    {
+        const auto components =
+            m_entityRegistry->getComponentsForEntity<AnimatorComponent>(characters[i].id);
+        ASSERT_TRUE(components.has_value());
+        const AnimatorComponent& animator = std::get<0>(*components);
+
+        EXPECT_NEAR(animator.time, 0.25f * animator.speed, 1e-5f);
+
+        m_library.getClip(walk)->sample(animator.time, pose);
+        if (animator.blendClip == run)
+        {
+            m_library.getClip(run)->sample(animator.blendTime, blend);
+            blendPoses(pose, blend, animator.blendWeight, pose);
+        }
+        computeSkinningPalette(*m_library.getSkeleton(skeleton), pose, expected);
+
+        ASSERT_NE(animator.paletteOffset, UINT32_MAX);
+        EXPECT_EQ(std::memcmp(memory.data() + animator.paletteOffset, expected.data(),
+                              k_paletteSize),
+                  0);
+    }
+
+    const auto brokenComponents =
+        m_entityRegistry->getComponentsForEntity<AnimatorComponent>(broken.id);
+    EXPECT_EQ(std::get<0>(*brokenComponents).paletteOffset, UINT32_MAX);
+
+    // the clips loop, walk lasts a second
+    for (size_t i = 0; i < 4; ++i) system.update(pool, 0.5f, ring);
+    const auto first =
+        m_entityRegistry->getComponentsForEntity<AnimatorComponent>(characters[0].id);
+    EXPECT_NEAR(std::get<0>(*first).time, 0.25f, 1e-5f);
+
+    pool.shutdown();
+}
+
+TEST_F(AnimationSystemTest, AFullRingAnimatesNothing)
+{
+    const uint32_t skeleton = m_library.addSkeleton(makeChain(4));
+    const uint32_t clip =
+        m_library.addClip(AnimationClip::compress(4, chainSamples(4, 10), k_frameRate));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        m_entityRegistry->createEntity<AnimatorComponent>(std::make_tuple(skeleton, clip));
+    }
+
+    std::vector<std::byte> memory(256);
+    mosaic::graphics::FrameRing ring;
+    ring.reset(memory.data(), memory.size(), 1);
+    ring.beginFrame(0);
+
+    AnimationSystem system(*m_entityRegistry, m_library);
+    EXPECT_EQ(system.update(1.0f / k_frameRate, ring), 0u);
+    EXPECT_FALSE(system.getPalettes());
+
+    std::vector<std::byte> larger(4 * 4 * sizeof(SkinningMatrix));
+    ring.reset(larger.data(), larger.size(), 1);
+    ring.beginFrame(0);
+    EXPECT_EQ(system.update(1.0f / k_frameRate, ring), 4u);
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <mosaic/core/asset_archive.hpp>
+#include <mosaic/core/lz4.hpp>
+#include <mosaic/core/virtual_file_system.hpp>
+
+using namespace mosaic::core;
+
+namespace
+{
+
+std::vector<uint8_t> makeText(size_t _size)
+{
+    const std::string words = "layout(location = 0) in vec3 position; uniform mat4 model; ";
+
+    std::vector<uint8_t> bytes(_size);
+    for (size_t i = 0; i < _size; ++i) bytes[i] = uint8_t(words[(i * 7 + i / 97) % words.size()]);
+
+    return bytes;
+}
+
+std::vector<uint8_t> makeNoise(size_t _size)
+{
+    std::mt19937 random(42);
+
+    std::vector<uint8_t> bytes(_size);
+    for (uint8_t& byte : bytes) byte = uint8_t(random());
+
+    return bytes;
+}
+
+std::vector<uint8_t> toVector(const FileData& _data)
+{
+    return std::vector<uint8_t>(_data.bytes().begin(), _data.bytes().end());
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// LZ4
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(AssetArchiveTest, Lz4RoundTripsRunsTextAndNoise)
+{
+    const std::vector<std::vector<uint8_t>> inputs = {
+        {}, {1, 2, 3}, std::vector<uint8_t>(100000, 7), makeText(70000), makeNoise(5000)};
+
+    for (const std::vector<uint8_t>& input : inputs)
+    {
+        const std::vector<uint8_t> compressed = compressLz4(input);
+
+        std::vector<uint8_t> output(input.size());
+        ASSERT_TRUE(decompressLz4(compressed, output));
+        EXPECT_EQ(output, input);
+    }
+
+    EXPECT_LT(compressLz4(std::vector<uint8_t>(100000, 7)).size(), 1000u);
+    EXPECT_LT(compressLz4(makeText(70000)).size(), 70000u / 4);
+}
+
+TEST(AssetArchiveTest, Lz4RejectsMalformedBlocks)
+{
+    const std::vector<uint8_t> input = makeText(4096);
+    const std::vector<uint8_t> compressed = compressLz4(input);
+
+    std::vector<uint8_t> output(input.size());
+
+    // truncated, or decompressing to another size
+    EXPECT_FALSE(decompressLz4(std::span(compressed).first(compressed.size() / 2), output));
+    std::vector<uint8_t> shorter(input.size() - 1);
+    EXPECT_FALSE(decompressLz4(compressed, shorter));
+
+    // a match reaching before the start of the output
+    const std::vector<uint8_t> before = {0x10, 'a', 0x05, 0x00};
+    std::vector<uint8_t> small(5);
+    EXPECT_FALSE(decompressLz4(before, small));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Archive
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(AssetArchiveTest, FilesAreFoundByPathAndStoredOnesReadInPlace)
+{
+    const std::vector<uint8_t> shader = makeText(3000);
+    const std::vector<uint8_t> texture = makeNoise(777);
+
+    AssetArchiveWriter writer;
+    writer.add("shaders/triangle.vert.spv", shader);
+    writer.add("textures/noise.ktx2", texture);
+    writer.add("empty.txt", {});
+
+    const std::vector<uint8_t> bytes = writer.finish();
+    EXPECT_EQ(writer.size(), 0u);
+
+    const AssetArchive archive(FileData(bytes, nullptr));
+    ASSERT_EQ(archive.size(), 3u);
+
+    const AssetArchive::Entry* text = archive.find("./shaders\\triangle.vert.spv");
+    ASSERT_NE(text, nullptr);
+    EXPECT_EQ(text->compression, AssetCompression::lz4);
+    EXPECT_LT(text->storedSize, shader.size());
+    EXPECT_EQ(toVector(archive.read(*text)), shader);
+
+    // noise does not compress: stored as is, aligned, read from the archive bytes
+    const AssetArchive::Entry* noise = archive.find("textures/noise.ktx2");
+    ASSERT_NE(noise, nullptr);
+    EXPECT_EQ(noise->compression, AssetCompression::none);
+    EXPECT_EQ(noise->offset % AssetArchive::k_alignment, 0u);
+
+    const FileData read = archive.read(*noise);
+    EXPECT_EQ(read.bytes().data(), bytes.data() + noise->offset);
+    EXPECT_EQ(toVector(read), texture);
+
+    ASSERT_TRUE(archive.read("empty.txt").has_value());
+    EXPECT_TRUE(archive.read("empty.txt")->empty());
+    EXPECT_FALSE(archive.read("missing.txt").has_value());
+}
+
+TEST(AssetArchiveTest, MalformedArchivesThrow)
+{
+    AssetArchiveWriter writer;
+    writer.add("a.bin", makeText(100));
+
+    EXPECT_THROW(writer.add("./a.bin", {}), std::invalid_argument);
+
+    std::vector<uint8_t> bytes = writer.finish();
+
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+    EXPECT_THROW(AssetArchive(FileData::fromBuffer(truncated)), std::runtime_error);
+
+    std::vector<uint8_t> wrongMagic = bytes;
+    wrongMagic[0] = 'X';
+    EXPECT_THROW(AssetArchive(FileData::fromBuffer(wrongMagic)), std::runtime_error);
+
+    EXPECT_THROW(AssetArchive(FileData::fromBuffer({1, 2, 3})), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Virtual file system
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(AssetArchiveTest, LaterMountsOverrideEarlierOnes)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "mosaic_vfs_test";
+    std::filesystem::create_directories(directory / "shaders");
+    {
+        std::ofstream file(directory / "shaders" / "a.spv", std::ios::binary);
+        file << "from the directory";
+    }
+
+    AssetArchiveWriter writer;
+    const std::string archived = "from the archive";
+    writer.add("shaders/a.spv", std::span(reinterpret_cast<const uint8_t*>(archived.data()),
+                                          archived.size()));
+    writer.add("config.json", makeText(64));
+
+    VirtualFileSystem files;
+    files.mountArchive("", std::make_shared<const AssetArchive>(
+                               FileData::fromBuffer(writer.finish())));
+
+    auto fromArchive = files.read("shaders/a.spv");
+    ASSERT_TRUE(fromArchive.isOk());
+    EXPECT_EQ(toVector(fromArchive.unwrap()).size(), archived.size());
+
+    // the directory mounted over the archive, under a mount point of its own
+    files.mountDirectory("shaders/", directory / "shaders");
+
+    auto fromDirectory = files.read("shaders/a.spv");
+    ASSERT_TRUE(fromDirectory.isOk());
+    EXPECT_EQ(fromDirectory.unwrap().size(), std::string("from the directory").size());
+
+    EXPECT_TRUE(files.exists("config.json"));
+    EXPECT_FALSE(files.exists("shaders/config.json"));
+    EXPECT_TRUE(files.read("missing.json").isErr());
+
+    files.unmount("shaders");
+    EXPECT_EQ(files.getMountCount(), 1u);
+    EXPECT_EQ(files.read("shaders/a.spv").unwrap().size(), archived.size());
+
+    std::filesystem::remove_all(directory);
+}
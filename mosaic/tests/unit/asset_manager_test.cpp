@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mosaic/core/asset_manager.hpp>
+#include <mosaic/core/virtual_file_system.hpp>
+#include <mosaic/exec/io_service.hpp>
+#include <mosaic/exec/thread_pool.hpp>
+
+using namespace mosaic::core;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+struct Text
+{
+    std::string value;
+};
+
+// A material names the texts it is made of, one per line
+struct Material
+{
+    std::vector<AssetHandle<Text>> parts;
+
+    std::string join() const
+    {
+        std::string joined;
+        for (const AssetHandle<Text>& part : parts) joined += part.get()->value;
+
+        return joined;
+    }
+};
+
+std::string toString(const FileData& _bytes)
+{
+    return std::string(reinterpret_cast<const char*>(_bytes.bytes().data()), _bytes.size());
+}
+
+class TextLoader final : public AssetLoader<Text>
+{
+   public:
+    bool finalized = false;
+    std::atomic<int> decoded = 0;
+    std::thread::id finalizedOn;
+
+    bool needsFinalize() const noexcept override { return true; }
+
+    pieces::Result<Text, std::string> decode(const AssetContext& _context) override
+    {
+        ++decoded;
+        return pieces::Ok<Text, std::string>(Text{toString(_context.getBytes())});
+    }
+
+    uint64_t getMemorySize(const Text& _text) const noexcept override
+    {
+        return _text.value.size();
+    }
+
+    void finalize(Text& _text) override
+    {
+        finalized = true;
+        finalizedOn = std::this_thread::get_id();
+        _text.value += "!";
+    }
+};
+
+class MaterialLoader final : public AssetLoader<Material>
+{
+   public:
+    std::vector<AssetDependency> getDependencies(const FileData& _bytes) const override
+    {
+        std::vector<AssetDependency> dependencies;
+
+        std::istringstream lines(toString(_bytes));
+        for (std::string line; std::getline(lines, line);)
+        {
+            if (line.ends_with(".material"))
+            {
+                dependencies.push_back(AssetDependency::of<Material>(line));
+            }
+            else
+            {
+                dependencies.push_back(AssetDependency::of<Text>(line));
+            }
+        }
+
+        return dependencies;
+    }
+
+    pieces::Result<Material, std::string> decode(const AssetContext& _context) override
+    {
+        Material material;
+        for (size_t i = 0; i < _context.getDependencyCount(); ++i)
+        {
+            material.parts.push_back(_context.getDependency<Text>(i));
+        }
+
+        return pieces::Ok<Material, std::string>(std::move(material));
+    }
+};
+
+// Updates until nothing loads anymore
+void settle(AssetManager& _assets)
+{
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        _assets.update();
+
+        const AssetManagerStats stats = _assets.getStats();
+        if (stats.queued == 0 && stats.loading == 0) return;
+
+        std::this_thread::sleep_for(1ms);
+    }
+
+    FAIL() << "the loads did not settle";
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class AssetManagerTest : public ::testing::Test
+{
+   protected:
+    std::filesystem::path directory;
+    VirtualFileSystem files;
+
+    std::unique_ptr<mosaic::exec::ThreadPool> pool;
+    std::unique_ptr<mosaic::exec::IoService> io;
+
+    TextLoader* texts = nullptr;
+
+    void SetUp() override
+    {
+        directory = std::filesystem::temp_directory_path() / "mosaic_asset_manager_test";
+        std::filesystem::create_directories(directory);
+
+        write("a.txt", "alpha");
+        write("b.txt", "beta");
+        write("rock.material", "a.txt\nb.txt");
+        write("broken.material", "a.txt\nmissing.txt");
+        write("left.material", "right.material");
+        write("right.material", "left.material");
+
+        files.mountDirectory("", directory);
+    }
+
+    void TearDown() override
+    {
+        if (io) io->shutdown();
+        if (pool) pool->shutdown();
+
+        std::filesystem::remove_all(directory);
+    }
+
+    void write(const std::string& _path, const std::string& _contents)
+    {
+        std::ofstream file(directory / _path, std::ios::binary);
+        file << _contents;
+    }
+
+    void startPool()
+    {
+        mosaic::core::CPUInfo mockCPUInfo;
+        mockCPUInfo.logicalCores = 8;
+        mockCPUInfo.physicalCores = 4;
+
+        pool = std::make_unique<mosaic::exec::ThreadPool>();
+        ASSERT_TRUE(pool->initialize(mockCPUInfo).isOk());
+
+        io = std::make_unique<mosaic::exec::IoService>();
+        ASSERT_TRUE(io->initialize(8).isOk());
+    }
+
+    void registerLoaders(AssetManager& _assets)
+    {
+        auto loader = std::make_unique<TextLoader>();
+        texts = loader.get();
+
+        _assets.registerLoader<Text>(std::move(loader));
+        _assets.registerLoader<Material>(std::make_unique<MaterialLoader>());
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loads
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(AssetManagerTest, LoadsDependenciesFirstAndSharesThem)
+{
+    startPool();
+
+    AssetManager assets(&files);
+    registerLoaders(assets);
+
+    AssetHandle<Material> rock = assets.load<Material>("rock.material");
+    AssetHandle<Material> again = assets.load<Material>("./rock.material");
+    EXPECT_EQ(rock, again);
+    EXPECT_EQ(rock.get(), nullptr);
+
+    settle(assets);
+
+    ASSERT_TRUE(rock.isReady()) << rock.getError();
+    EXPECT_EQ(rock.get()->join(), "alpha!beta!");
+
+    // finalized by the thread of update()
+    EXPECT_TRUE(texts->finalized);
+    EXPECT_EQ(texts->finalizedOn, std::this_thread::get_id());
+
+    // the texts the material holds are shared, not loaded again
+    AssetHandle<Text> alpha = assets.load<Text>("a.txt");
+    EXPECT_TRUE(alpha.isReady());
+    EXPECT_EQ(alpha.get(), rock.get()->parts[0].get());
+    EXPECT_EQ(texts->decoded.load(), 2);
+
+    // a path is loaded as one type only
+    EXPECT_FALSE(assets.load<Text>("rock.material").isValid());
+
+    const AssetManagerStats stats = assets.getStats();
+    EXPECT_EQ(stats.ready, 3u);
+    EXPECT_EQ(stats.residentSize, sizeof(Material) + 5 + 4); // measured when decoded
+}
+
+TEST_F(AssetManagerTest, FailuresReachTheDependents)
+{
+    startPool();
+
+    AssetManager assets(&files);
+    registerLoaders(assets);
+
+    AssetHandle<Text> missing = assets.load<Text>("nowhere.txt");
+    AssetHandle<Material> broken = assets.load<Material>("broken.material");
+    AssetHandle<Material> left = assets.load<Material>("left.material");
+
+    settle(assets);
+
+    EXPECT_TRUE(missing.isFailed());
+    EXPECT_TRUE(broken.isFailed());
+    EXPECT_NE(broken.getError().find("missing.txt"), std::string::npos);
+
+    // the cycle fails every asset on it, those without handles are forgotten
+    EXPECT_TRUE(left.isFailed());
+
+    AssetHandle<Material> right = assets.load<Material>("right.material");
+    settle(assets);
+    EXPECT_TRUE(right.isFailed());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scheduling
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Without a pool the stages run in update(), one a frame: the order is that of the priorities
+TEST_F(AssetManagerTest, VisibleAndNearLoadsGoFirst)
+{
+    AssetManagerSettings settings;
+    settings.maxLoads = 1;
+
+    AssetManager assets(&files, settings);
+    registerLoaders(assets);
+
+    AssetHandle<Text> far = assets.load<Text>("a.txt");
+    AssetHandle<Text> near = assets.load<Text>("b.txt");
+    AssetHandle<Material> hidden = assets.load<Material>("rock.material");
+
+    assets.prioritize(far, 100.0f, true);
+    assets.prioritize(near, 1.0f, true);
+    assets.prioritize(hidden, 0.0f, false);
+
+    // dispatched, read, decoded, finalized
+    for (int i = 0; i < 4; ++i) assets.update();
+
+    EXPECT_TRUE(near.isReady());
+    EXPECT_FALSE(far.isReady());
+    EXPECT_EQ(hidden.getState(), AssetState::queued);
+
+    settle(assets);
+    EXPECT_TRUE(far.isReady());
+    EXPECT_TRUE(hidden.isReady());
+}
+
+TEST_F(AssetManagerTest, ReleasedLoadsCancelAndTheBudgetEvicts)
+{
+    AssetManager assets(&files);
+    registerLoaders(assets);
+
+    // released before it started
+    {
+        AssetHandle<Material> rock = assets.load<Material>("rock.material");
+        assets.update(); // dispatched
+    }
+
+    settle(assets);
+    EXPECT_EQ(assets.getStats().ready, 0u);
+    EXPECT_EQ(texts->decoded.load(), 0);
+
+    // cached without handles until over the budget, the least recently used evicted
+    {
+        AssetHandle<Text> alpha = assets.load<Text>("a.txt");
+        settle(assets);
+    }
+    {
+        AssetHandle<Text> beta = assets.load<Text>("b.txt");
+        settle(assets);
+    }
+
+    assets.update();
+    EXPECT_EQ(assets.getStats().ready, 2u);
+
+    assets.setBudget(8);
+    assets.update();
+
+    const AssetManagerStats stats = assets.getStats();
+    EXPECT_EQ(stats.ready, 1u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_TRUE(assets.load<Text>("b.txt").isReady());
+}
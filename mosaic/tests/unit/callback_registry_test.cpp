@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <mosaic/window/callback_registry.hpp>
+
+using namespace mosaic::window;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Registration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(CallbackRegistryTest, DispatchesInOrderOfAddition)
+{
+    CallbackRegistry<void(int)> registry;
+    std::vector<int> calls;
+
+    const size_t first = registry.add([&calls](int _value) { calls.push_back(_value); });
+    const size_t second = registry.add([&calls](int _value) { calls.push_back(_value * 10); });
+    EXPECT_NE(first, 0u);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(registry.size(), 2u);
+
+    registry.dispatch(3);
+    EXPECT_EQ(calls, (std::vector<int>{3, 30}));
+
+    EXPECT_TRUE(registry.remove(first));
+    EXPECT_FALSE(registry.remove(first));
+    EXPECT_FALSE(registry.remove(0));
+
+    registry.dispatch(1);
+    EXPECT_EQ(calls, (std::vector<int>{3, 30, 10}));
+
+    // an empty callback is not registered
+    EXPECT_EQ(registry.add(nullptr), 0u);
+    EXPECT_EQ(registry.size(), 1u);
+}
+
+TEST(CallbackRegistryTest, HoldsMoveOnlyCallbacks)
+{
+    CallbackRegistry<void()> registry;
+    int seen = 0;
+
+    auto value = std::make_unique<int>(7);
+    registry.add([&seen, value = std::move(value)]() { seen = *value; });
+
+    // larger than the inline buffer
+    std::array<int, 32> wide{};
+    wide[31] = 9;
+    registry.add([&seen, wide]() { seen += wide[31]; });
+
+    registry.dispatch();
+    EXPECT_EQ(seen, 16);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Changes during a dispatch
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(CallbackRegistryTest, RemovalsDuringADispatchApplyAtOnce)
+{
+    CallbackRegistry<void()> registry;
+    std::vector<int> calls;
+
+    size_t self = 0;
+    size_t last = 0;
+
+    self = registry.add(
+        [&]()
+        {
+            calls.push_back(1);
+            registry.remove(self);
+            registry.remove(last);
+        });
+    registry.add([&]() { calls.push_back(2); });
+    last = registry.add([&]() { calls.push_back(3); });
+
+    registry.dispatch();
+    EXPECT_EQ(calls, (std::vector<int>{1, 2}));
+    EXPECT_EQ(registry.size(), 1u);
+
+    registry.dispatch();
+    EXPECT_EQ(calls, (std::vector<int>{1, 2, 2}));
+}
+
+TEST(CallbackRegistryTest, AdditionsDuringADispatchWaitForTheNext)
+{
+    CallbackRegistry<void()> registry;
+    int added = 0;
+    int nested = 0;
+
+    registry.add(
+        [&]()
+        {
+            if (added++ > 0) return;
+
+            const size_t id = registry.add([&nested]() { ++nested; });
+            EXPECT_EQ(registry.size(), 2u);
+
+            // added and removed before it was dispatched
+            registry.remove(registry.add([]() { FAIL(); }));
+
+            // re-entrant: the new callback is not dispatched by it either
+            registry.dispatch();
+            EXPECT_EQ(nested, 0);
+            EXPECT_NE(id, 0u);
+        });
+
+    registry.dispatch();
+    EXPECT_EQ(added, 2);
+    EXPECT_EQ(nested, 0);
+    EXPECT_EQ(registry.size(), 2u);
+
+    registry.dispatch();
+    EXPECT_EQ(nested, 1);
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <mosaic/graphics/draw_queue.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Records the commands instead of a command buffer
+struct RecordingEncoder
+{
+    std::vector<ResourceHandle> pipelines;
+    std::vector<std::pair<uint32_t, ResourceHandle>> vertexBuffers;
+    std::vector<ResourceHandle> indexBuffers;
+    std::vector<uint32_t> draws; // firstVertex of each
+
+    void bindPipeline(ResourceHandle _pipeline) { pipelines.push_back(_pipeline); }
+    void bindVertexBuffer(uint32_t _slot, ResourceHandle _buffer)
+    {
+        vertexBuffers.emplace_back(_slot, _buffer);
+    }
+    void bindIndexBuffer(ResourceHandle _buffer) { indexBuffers.push_back(_buffer); }
+    void draw(const DrawCall& _call) { draws.push_back(_call.firstVertex); }
+};
+
+DrawCall makeDraw(uint64_t _sortKey, ResourceHandle _pipeline, ResourceHandle _mesh,
+                  uint32_t _id)
+{
+    DrawCall call;
+    call.sortKey = _sortKey;
+    call.type = DrawCallType::Indexed;
+    call.pipeline = _pipeline;
+    call.vertexBufferCount = 1;
+    call.vertexBuffers[0] = _mesh;
+    call.indexBuffer = _mesh;
+    call.indexCount = 36;
+    call.firstVertex = _id; // tells the draws apart
+
+    return call;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sort Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(DrawQueueTest, SortOrdersTheDrawsByKeyAndKeepsTiesInSubmissionOrder)
+{
+    DrawQueue queue(4);
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> keys;
+    for (uint32_t i = 0; i < 5000; ++i)
+    {
+        // few distinct high bytes and many ties, as pass and pipeline keys are
+        keys.push_back((rng() % 7) << 56 | (rng() % 300));
+        queue.submit(makeDraw(keys.back(), 0, 0, i));
+    }
+
+    queue.sort();
+
+    RecordingEncoder encoder;
+    queue.record(encoder);
+
+    ASSERT_EQ(encoder.draws.size(), keys.size());
+    for (size_t i = 1; i < encoder.draws.size(); ++i)
+    {
+        const uint64_t previous = keys[encoder.draws[i - 1]];
+        const uint64_t current = keys[encoder.draws[i]];
+
+        ASSERT_LE(previous, current) << i;
+        if (previous == current)
+        {
+            ASSERT_LT(encoder.draws[i - 1], encoder.draws[i]) << i;
+        }
+    }
+
+    // grown from a capacity of 4, the draws moved over
+    EXPECT_GE(queue.capacity(), keys.size());
+    EXPECT_EQ(queue.getCalls()[4999].firstVertex, 4999u);
+}
+
+TEST(DrawQueueTest, UnsortedDrawsAreRecordedInSubmissionOrder)
+{
+    DrawQueue queue;
+    queue.submit(makeDraw(3, 0, 0, 0));
+    queue.submit(makeDraw(1, 0, 0, 1));
+    queue.submit(makeDraw(2, 0, 0, 2));
+
+    RecordingEncoder encoder;
+    queue.record(encoder);
+
+    EXPECT_EQ(encoder.draws, (std::vector<uint32_t>{0, 1, 2}));
+
+    queue.sort();
+
+    encoder = {};
+    queue.record(encoder);
+
+    EXPECT_EQ(encoder.draws, (std::vector<uint32_t>{1, 2, 0}));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Recording Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(DrawQueueTest, RedundantBindsAreSkipped)
+{
+    DrawQueue queue;
+
+    // two pipelines, each drawing two meshes twice, submitted interleaved
+    uint32_t id = 0;
+    for (uint32_t round = 0; round < 2; ++round)
+    {
+        for (ResourceHandle pipeline = 0; pipeline < 2; ++pipeline)
+        {
+            for (ResourceHandle mesh = 10; mesh < 12; ++mesh)
+            {
+                queue.submit(makeDraw(uint64_t{pipeline} << 32 | mesh, pipeline, mesh, id++));
+            }
+        }
+    }
+
+    DrawCall fullscreen;
+    fullscreen.sortKey = ~uint64_t{0};
+    fullscreen.pipeline = 1;
+    fullscreen.vertexCount = 3;
+    queue.submit(fullscreen);
+
+    queue.sort();
+
+    RecordingEncoder encoder;
+    const DrawQueueStats stats = queue.record(encoder);
+
+    EXPECT_EQ(stats.draws, 9u);
+    EXPECT_EQ(encoder.pipelines, (std::vector<ResourceHandle>{0, 1}));
+    EXPECT_EQ(stats.pipelineBinds, 2u);
+
+    // the vertex buffers stay bound across the pipelines, the last draw needs none
+    EXPECT_EQ(stats.vertexBufferBinds, 4u);
+    EXPECT_EQ(encoder.indexBuffers, (std::vector<ResourceHandle>{10, 11, 10, 11}));
+    EXPECT_EQ(stats.indexBufferBinds, 4u);
+}
+
+TEST(DrawQueueTest, RangesStartWithNothingBound)
+{
+    DrawQueue queue;
+    for (uint32_t i = 0; i < 6; ++i) queue.submit(makeDraw(i, 0, 10, i));
+
+    queue.sort();
+
+    RecordingEncoder first;
+    RecordingEncoder second;
+    const DrawQueueStats firstStats = queue.record(first, 0, 4);
+    const DrawQueueStats secondStats = queue.record(second, 4, 100);
+
+    EXPECT_EQ(first.draws, (std::vector<uint32_t>{0, 1, 2, 3}));
+    EXPECT_EQ(second.draws, (std::vector<uint32_t>{4, 5}));
+
+    // the same state, bound again on the command buffer of the second range
+    EXPECT_EQ(firstStats.pipelineBinds, 1u);
+    EXPECT_EQ(secondStats.pipelineBinds, 1u);
+    EXPECT_EQ(second.indexBuffers, (std::vector<ResourceHandle>{10}));
+}
+
+TEST(DrawQueueTest, ClearKeepsTheCapacity)
+{
+    DrawQueue queue(2);
+    for (uint32_t i = 0; i < 100; ++i) queue.submit(makeDraw(i, 0, 0, i));
+
+    const size_t capacity = queue.capacity();
+    queue.clear();
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.capacity(), capacity);
+
+    queue.submit(makeDraw(7, 0, 0, 7));
+    queue.sort();
+
+    RecordingEncoder encoder;
+    EXPECT_EQ(queue.record(encoder).draws, 1u);
+    EXPECT_EQ(encoder.draws, (std::vector<uint32_t>{7}));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Hash Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(DrawQueueTest, HashChangesWithTheDrawsOrTheirOrder)
+{
+    DrawQueue queue;
+    auto submitFrame = [&](uint32_t _indexCount)
+    {
+        queue.clear();
+        queue.submit(makeDraw(2, 1, 10, 0));
+        DrawCall changed = makeDraw(1, 0, 11, 1);
+        changed.indexCount = _indexCount;
+        queue.submit(changed);
+    };
+
+    submitFrame(36);
+    const uint64_t unsorted = queue.getHash();
+    queue.sort();
+    const uint64_t sorted = queue.getHash();
+
+    // the same draws the next frame, recorded the same
+    submitFrame(36);
+    queue.sort();
+    EXPECT_EQ(queue.getHash(), sorted);
+    EXPECT_NE(unsorted, sorted);
+
+    submitFrame(72);
+    queue.sort();
+    EXPECT_NE(queue.getHash(), sorted);
+
+    queue.clear();
+    EXPECT_NE(queue.getHash(), sorted);
+}
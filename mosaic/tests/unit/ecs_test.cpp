@@ -1,8 +1,26 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <filesystem>
 #include <memory>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <mosaic/ecs/entity_registry.hpp>
+#include <mosaic/ecs/command_buffer.hpp>
+#include <mosaic/ecs/edit_protocol.hpp>
+#include <mosaic/ecs/entity_reserver.hpp>
+#include <mosaic/ecs/page_storage_allocator.hpp>
+#include <mosaic/ecs/snapshot.hpp>
+#include <mosaic/ecs/world.hpp>
+#include <mosaic/exec/task_future.hpp>
 
 using namespace mosaic::ecs;
 
@@ -30,6 +48,25 @@ struct Tag
     int value;
 };
 
+// Empty type, registered as a signature-only tag
+struct Frozen
+{
+};
+
+// Registered as a shared component
+struct Material
+{
+    int id;
+    float roughness;
+};
+
+// Never registered, only used as a singleton
+struct GameTime
+{
+    float deltaTime;
+    uint64_t frame;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Test Fixture
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -48,11 +85,36 @@ class ECSTest : public ::testing::Test
         m_compRegistry->registerComponent<Velocity>("Velocity");
         m_compRegistry->registerComponent<Health>("Health");
         m_compRegistry->registerComponent<Tag>("Tag");
+        m_compRegistry->registerComponent<Frozen>("Frozen");
+        m_compRegistry->registerSharedComponent<Material>("Material");
 
         m_entityRegistry = std::make_unique<EntityRegistry>(m_compRegistry.get());
     }
 };
 
+// Minimal executor running every task on its own thread, stands in for exec::ThreadPool.
+class ThreadPerTaskPool
+{
+   private:
+    std::vector<std::jthread> m_threads;
+
+   public:
+    std::atomic<size_t> dispatched = 0;
+    bool refuseTasks = false;
+
+    template <typename F>
+    std::optional<mosaic::exec::TaskFuture<void>> enqueueToWorker(F&& _f)
+    {
+        if (refuseTasks) return std::nullopt;
+
+        auto [task, future] = mosaic::exec::makeTaskPair(std::forward<F>(_f));
+        m_threads.emplace_back(std::move(task));
+        ++dispatched;
+
+        return std::move(future);
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Single Entity API Tests
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -805,6 +867,44 @@ TEST_F(ECSTest, ViewMultipleComponentsSubsetIteratesCorrectly)
     EXPECT_EQ(count, 2); // Should find 2 entities with both Position and Velocity
 }
 
+TEST_F(ECSTest, ViewIteratorMatchesForEachAcrossArchetypes)
+{
+    // recycle an ID so that at least one entity has a non-zero generation
+    m_entityRegistry->destroyEntity(m_entityRegistry->createEntity<Position>().id);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        float f = static_cast<float>(i);
+        m_entityRegistry->createEntity<Position, Velocity>(std::make_tuple(f, 0.0f, 0.0f),
+                                                           std::make_tuple(f, 0.0f, 0.0f));
+        m_entityRegistry->createEntity<Position, Velocity, Health>(
+            std::make_tuple(f, 0.0f, 0.0f), std::make_tuple(f, 0.0f, 0.0f),
+            std::make_tuple(i, 100));
+    }
+
+    auto result = m_entityRegistry->viewSubset<Position, Velocity>();
+    ASSERT_TRUE(result.has_value());
+    auto view = result.value();
+
+    std::vector<EntityMeta> expected;
+    view.forEach([&](EntityMeta meta, Position&, Velocity&) { expected.push_back(meta); });
+
+    size_t index = 0;
+    for (auto [meta, components] : view)
+    {
+        auto& [pos, vel] = components;
+        ASSERT_LT(index, expected.size());
+        EXPECT_EQ(meta.id, expected[index].id);
+        EXPECT_EQ(meta.gen, expected[index].gen);
+        ++index;
+        EXPECT_FLOAT_EQ(pos.x, vel.dx);
+    }
+
+    EXPECT_EQ(index, 20);
+    EXPECT_TRUE(std::any_of(expected.begin(), expected.end(),
+                            [](const EntityMeta& _meta) { return _meta.gen != 0; }));
+}
+
 TEST_F(ECSTest, ViewSubsetReturnsNulloptWhenNoMatchingEntities)
 {
     m_entityRegistry->createEntity<Position>();
@@ -990,3 +1090,2480 @@ TEST_F(ECSTest, MixedConstructorArgsAndDefaultConstruction)
     auto result2 = m_entityRegistry->getComponentsForEntity<Position>(meta2.id);
     EXPECT_TRUE(result2.has_value());
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Component Registry Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, ComponentIDsAreLocalToEachRegistry)
+{
+    ComponentRegistry other(8);
+
+    // Register in reverse order so IDs differ from the fixture registry
+    other.registerComponent<Tag>("Tag");
+    other.registerComponent<Position>("Position");
+
+    EXPECT_EQ(other.getID<Tag>(), 0);
+    EXPECT_EQ(other.getID<Position>(), 1);
+    EXPECT_EQ(m_compRegistry->getID<Position>(), 0);
+    EXPECT_EQ(m_compRegistry->getID<Tag>(), 3);
+
+    EXPECT_FALSE(other.isRegistered<Velocity>());
+    EXPECT_THROW((void)other.getID<Velocity>(), std::runtime_error);
+
+    // Re-registering returns the existing ID
+    EXPECT_EQ(other.registerComponent<Tag>("Tag"), 0);
+    EXPECT_EQ(other.count(), 2);
+}
+
+TEST_F(ECSTest, RegistryCapacityIsBoundedByInlineSignatures)
+{
+    if constexpr (k_inlineSignatures)
+    {
+        EXPECT_THROW(ComponentRegistry(k_maxComponents + 1), std::invalid_argument);
+    }
+
+    EXPECT_NO_THROW(ComponentRegistry{k_maxComponents});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Entity Location Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, LocationsStayConsistentAcrossSwapAndPop)
+{
+    std::vector<EntityMeta> metas;
+    for (int i = 0; i < 200; ++i)
+    {
+        metas.push_back(m_entityRegistry->createEntity<Health>(std::make_tuple(i, i)));
+    }
+
+    // Interleave single/bulk destruction and migrations so rows get shuffled around
+    std::vector<EntityID> bulk;
+    for (int i = 0; i < 200; ++i)
+    {
+        if (i % 5 == 0) m_entityRegistry->destroyEntity(metas[i].id);
+        if (i % 5 == 1) bulk.push_back(metas[i].id);
+        if (i % 5 == 2) m_entityRegistry->addComponents<Tag>(metas[i].id);
+    }
+
+    m_entityRegistry->destroyEntityBulk(bulk);
+    m_entityRegistry->removeComponentsBulk<Health>(bulk);
+
+    EXPECT_EQ(m_entityRegistry->entityCount(), 120);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        const bool alive = i % 5 > 1;
+        EXPECT_EQ(m_entityRegistry->isEntityValid(metas[i]), alive);
+
+        if (!alive) continue;
+
+        auto result = m_entityRegistry->getComponentsForEntity<Health>(metas[i].id);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(std::get<0>(result.value()).hp, i);
+    }
+}
+
+TEST_F(ECSTest, RecycledIDInvalidatesStaleHandle)
+{
+    auto stale = m_entityRegistry->createEntity<Position>();
+    m_entityRegistry->destroyEntity(stale.id);
+
+    auto fresh = m_entityRegistry->createEntity<Velocity>();
+
+    EXPECT_EQ(fresh.id, stale.id);
+    EXPECT_FALSE(m_entityRegistry->isEntityValid(stale));
+    EXPECT_TRUE(m_entityRegistry->isEntityValid(fresh));
+    EXPECT_FALSE(m_entityRegistry->getComponentsForEntity<Position>(fresh.id).has_value());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Transition Graph Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, ToggleTagComponentReusesCachedEdges)
+{
+    std::vector<EntityID> ids;
+    for (int i = 0; i < 100; ++i)
+    {
+        float f = static_cast<float>(i);
+        ids.push_back(m_entityRegistry
+                          ->createEntity<Position, Health>(std::make_tuple(f, f, f),
+                                                           std::make_tuple(i, 100))
+                          .id);
+    }
+
+    for (int frame = 0; frame < 4; ++frame)
+    {
+        for (EntityID eid : ids) m_entityRegistry->addComponents<Tag>(eid, std::make_tuple(frame));
+        for (EntityID eid : ids) m_entityRegistry->removeComponents<Tag>(eid);
+    }
+
+    EXPECT_EQ(m_entityRegistry->archetypeCount(), 2);
+
+    auto* arch = m_entityRegistry->getArchetypeForEntity(ids[0]);
+    ASSERT_NE(arch, nullptr);
+
+    const ComponentID tagID = m_compRegistry->getID<Tag>();
+    ASSERT_NE(arch->findAddEdge(tagID), nullptr);
+    EXPECT_EQ(arch->findAddEdge(tagID)->target->findRemoveEdge(tagID)->target, arch);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        auto result = m_entityRegistry->getComponentsForEntity<Position, Health>(ids[i]);
+        ASSERT_TRUE(result.has_value());
+        auto& [pos, health] = result.value();
+        EXPECT_FLOAT_EQ(pos.y, static_cast<float>(i));
+        EXPECT_EQ(health.hp, i);
+    }
+}
+
+TEST_F(ECSTest, EdgeMergesAdjacentSharedComponentsIntoOneCopyRange)
+{
+    auto meta = m_entityRegistry->createEntity<Position, Velocity>();
+    auto* src = m_entityRegistry->getArchetypeForEntity(meta.id);
+
+    // Appending Tag keeps EntityMeta, Position and Velocity at the same offsets
+    m_entityRegistry->addComponents<Tag>(meta.id);
+
+    auto* edge = src->findAddEdge(m_compRegistry->getID<Tag>());
+    ASSERT_NE(edge, nullptr);
+    ASSERT_EQ(edge->copyRanges.size(), 1);
+    EXPECT_EQ(edge->copyRanges[0].srcOffset, 0);
+    EXPECT_EQ(edge->copyRanges[0].size, src->stride());
+    EXPECT_EQ(edge->sharedComponents.size(), 2);
+}
+
+TEST_F(ECSTest, RemovingAbsentComponentLinksSelfEdge)
+{
+    auto meta = m_entityRegistry->createEntity<Position>(std::make_tuple(1.0f, 2.0f, 3.0f));
+    auto* arch = m_entityRegistry->getArchetypeForEntity(meta.id);
+
+    m_entityRegistry->removeComponents<Velocity>(meta.id);
+
+    auto* edge = arch->findRemoveEdge(m_compRegistry->getID<Velocity>());
+    ASSERT_NE(edge, nullptr);
+    EXPECT_EQ(edge->target, arch);
+    EXPECT_EQ(m_entityRegistry->archetypeCount(), 1);
+
+    auto result = m_entityRegistry->getComponentsForEntity<Position>(meta.id);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(result.value()).z, 3.0f);
+}
+
+TEST_F(ECSTest, MultiComponentModificationMovesSharedData)
+{
+    auto meta = m_entityRegistry->createEntity<Position, Velocity>(
+        std::make_tuple(1.0f, 2.0f, 3.0f), std::make_tuple(4.0f, 5.0f, 6.0f));
+
+    m_entityRegistry->modifyComponents(meta.id, detail::Add<Health, Tag>{},
+                                       detail::Remove<Velocity>{});
+
+    EXPECT_FALSE(m_entityRegistry->getComponentsForEntity<Velocity>(meta.id).has_value());
+
+    auto result = m_entityRegistry->getComponentsForEntity<Position, Health, Tag>(meta.id);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(result.value()).x, 1.0f);
+    EXPECT_TRUE(m_entityRegistry->isEntityValid(meta));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Query Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, QueryTracksArchetypesCreatedAfterRegistration)
+{
+    m_entityRegistry->createEntity<Position>();
+
+    auto query = m_entityRegistry->query<Position>();
+    EXPECT_EQ(query.archetypes().size(), 1);
+
+    m_entityRegistry->createEntity<Position, Velocity>();
+    m_entityRegistry->createEntity<Velocity>();
+    m_entityRegistry->createEntity<Position, Health>();
+
+    EXPECT_EQ(query.archetypes().size(), 3);
+    EXPECT_EQ(query.entityCount(), 3);
+
+    int visited = 0;
+    query.forEach([&](EntityMeta, Position&) { ++visited; });
+    EXPECT_EQ(visited, 3);
+
+    visited = 0;
+    for (auto [meta, components] : query)
+    {
+        (void)meta;
+        (void)components;
+        ++visited;
+    }
+    EXPECT_EQ(visited, 3);
+}
+
+TEST_F(ECSTest, QueriesWithSameComponentsShareState)
+{
+    auto first = m_entityRegistry->query<Position, Velocity>();
+    auto second = m_entityRegistry->query<Velocity, Position>();
+
+    EXPECT_EQ(m_entityRegistry->queryCount(), 1);
+    EXPECT_EQ(first.archetypes().data(), second.archetypes().data());
+
+    // viewSubset() goes through the same cache
+    m_entityRegistry->createEntity<Position, Velocity, Health>();
+    auto view = m_entityRegistry->viewSubset<Position, Velocity>();
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(m_entityRegistry->queryCount(), 1);
+    EXPECT_EQ(first.entityCount(), 1);
+}
+
+TEST_F(ECSTest, QueryIsEmptyAfterClearAndRefillsAfterward)
+{
+    auto query = m_entityRegistry->query<Health>();
+    m_entityRegistry->createEntity<Health>();
+    EXPECT_FALSE(query.empty());
+
+    m_entityRegistry->clear();
+    EXPECT_TRUE(query.empty());
+    EXPECT_TRUE(query.archetypes().empty());
+
+    m_entityRegistry->createEntity<Health, Tag>();
+    EXPECT_EQ(query.entityCount(), 1);
+}
+
+TEST_F(ECSTest, QueryTermsFilterArchetypesBySignature)
+{
+    m_entityRegistry->createEntity<Position, Velocity, Health>();
+    m_entityRegistry->createEntity<Position, Velocity, Health, Frozen>();
+    m_entityRegistry->createEntity<Position, Velocity, Health, Tag>(
+        std::make_tuple(0.0f, 0.0f, 0.0f), std::make_tuple(1.0f, 0.0f, 0.0f),
+        std::make_tuple(5, 5), std::make_tuple(7));
+    m_entityRegistry->createEntity<Position, Velocity>();
+
+    auto query = m_entityRegistry->query<detail::Read<Velocity>, detail::Write<Position>,
+                                         detail::With<Health>, detail::Without<Frozen>,
+                                         detail::Optional<Tag>>();
+    EXPECT_EQ(query.archetypes().size(), 2);
+
+    size_t tagged = 0;
+    query.forEach(
+        [&](EntityMeta, const Velocity& _vel, Position& _pos, Tag* _tag)
+        {
+            _pos.x += _vel.dx;
+            if (_tag)
+            {
+                EXPECT_EQ(_tag->value, 7);
+                ++tagged;
+            }
+        });
+    EXPECT_EQ(tagged, 1);
+
+    // Archetypes created afterward go through the same masks
+    auto eid = m_entityRegistry->createEntity<Position, Velocity, Health>().id;
+    m_entityRegistry->setSharedComponent(eid, Material{1, 0.5f});
+    EXPECT_EQ(query.archetypes().size(), 3);
+    EXPECT_EQ(query.entityCount(), 3);
+
+    m_entityRegistry->addComponents<Frozen>(eid);
+    EXPECT_EQ(query.archetypes().size(), 3);
+    EXPECT_EQ(query.entityCount(), 2);
+    EXPECT_TRUE(query.excluded().testBit(m_compRegistry->getID<Frozen>()));
+
+    // Same required set, different exclusions: distinct states
+    (void)m_entityRegistry->query<Position, Velocity, Health>();
+    const size_t queries = m_entityRegistry->queryCount();
+    (void)m_entityRegistry->query<Position, detail::Read<Velocity>, detail::With<Health>,
+                                  detail::Without<Frozen>>();
+    EXPECT_EQ(m_entityRegistry->queryCount(), queries);
+}
+
+TEST_F(ECSTest, ReadTermsAreNotStampedAsChanged)
+{
+    m_entityRegistry->createEntityBulk<Position, Velocity>(100);
+    m_entityRegistry->createEntityBulk<Position>(100);
+    const uint32_t since = m_entityRegistry->advanceTick();
+
+    auto query = m_entityRegistry->query<detail::Read<Position>, detail::Optional<Velocity>>();
+    size_t withVelocity = 0;
+    query.forEachChunk(
+        [&](size_t _count, EntityMeta*, const Position*, Velocity* _vel)
+        { withVelocity += _vel ? _count : 0; });
+    EXPECT_EQ(withVelocity, 100);
+
+    size_t changed = 0;
+    m_entityRegistry->query<Position>().view().readOnly().forEach(
+        detail::Changed<Position>{}, since, [&](EntityMeta, Position&) { ++changed; });
+    EXPECT_EQ(changed, 0);
+
+    // Optional terms are written where present
+    m_entityRegistry->query<detail::Optional<Velocity>>().view().readOnly().forEach(
+        detail::Changed<Velocity>{}, since, [&](EntityMeta, Velocity*) { ++changed; });
+    EXPECT_EQ(changed, 100);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Parallel Iteration Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, ParallelForEachVisitsEveryEntityOnce)
+{
+    m_entityRegistry->createEntityBulk<Position>(1000);
+    m_entityRegistry->createEntityBulk<Position, Velocity>(1500);
+
+    ThreadPerTaskPool pool;
+    auto query = m_entityRegistry->query<Position>();
+
+    query.parallelForEach(pool, [](EntityMeta, Position& _pos) { _pos.x += 1.0f; }, 256);
+
+    // 1000 rows -> 4 ranges, 1500 rows -> 6 ranges, the calling thread keeps one
+    EXPECT_EQ(pool.dispatched, 9);
+
+    size_t visited = 0;
+    query.forEach(
+        [&](EntityMeta, Position& _pos)
+        {
+            EXPECT_FLOAT_EQ(_pos.x, 1.0f);
+            ++visited;
+        });
+    EXPECT_EQ(visited, 2500);
+}
+
+TEST_F(ECSTest, ParallelForEachRunsRefusedRangesInline)
+{
+    m_entityRegistry->createEntityBulk<Health>(300);
+
+    ThreadPerTaskPool pool;
+    pool.refuseTasks = true;
+
+    std::atomic<int> visited = 0;
+    m_entityRegistry->query<Health>().parallelForEach(
+        pool, [&](EntityMeta, Health&) { ++visited; }, 64);
+
+    EXPECT_EQ(visited, 300);
+    EXPECT_EQ(pool.dispatched, 0);
+}
+
+TEST_F(ECSTest, ParallelForEachRethrowsAfterJoin)
+{
+    m_entityRegistry->createEntityBulk<Tag>(512);
+
+    ThreadPerTaskPool pool;
+    std::atomic<int> visited = 0;
+
+    auto view = m_entityRegistry->viewSubset<Tag>();
+    ASSERT_TRUE(view.has_value());
+
+    EXPECT_THROW(view->parallelForEach(pool,
+                                       [&](EntityMeta _meta, Tag&)
+                                       {
+                                           ++visited;
+                                           if (_meta.id == 0) throw std::runtime_error("boom");
+                                       },
+                                       128),
+                 std::runtime_error);
+
+    // The throwing range stops at its first entity, every other range is joined before rethrowing
+    EXPECT_EQ(visited, 512 - 127);
+}
+
+TEST_F(ECSTest, SpanChunksGatherInterleavedRowsAndWriteThemBack)
+{
+    m_entityRegistry->createEntityBulk<Position, Velocity>(150, std::make_tuple(0.0f, 0.0f, 0.0f),
+                                                           std::make_tuple(1.0f, 2.0f, 3.0f));
+    const uint32_t since = m_entityRegistry->advanceTick();
+
+    auto query = m_entityRegistry->query<Position, detail::Read<Velocity>, detail::Optional<Tag>>();
+
+    std::vector<size_t> runs;
+    query.forEachChunk(
+        [&](std::span<const EntityMeta> _metas, std::span<Position> _pos,
+            std::span<const Velocity> _vel, std::span<Tag> _tag)
+        {
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_pos.data()) % k_columnSpanAlignment, 0u);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_vel.data()) % k_columnSpanAlignment, 0u);
+            EXPECT_TRUE(_tag.empty());
+            ASSERT_EQ(_pos.size(), _metas.size());
+
+            for (size_t i = 0; i < _pos.size(); ++i) _pos[i].x += _vel[i].dx * _metas[i].id;
+            runs.push_back(_metas.size());
+        });
+
+    EXPECT_EQ(runs, (std::vector<size_t>{64, 64, 22}));
+
+    auto components = m_entityRegistry->getComponentsForEntity<Position>(149);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).x, 149.0f);
+
+    // Only the written term is stamped
+    size_t changed = 0;
+    auto view = m_entityRegistry->query<Position, Velocity>().view().readOnly();
+    view.forEach(detail::Changed<Position>{}, since, [&](EntityMeta, Position&, Velocity&)
+                 { ++changed; });
+    EXPECT_EQ(changed, 150);
+
+    changed = 0;
+    view.forEach(detail::Changed<Velocity>{}, since, [&](EntityMeta, Position&, Velocity&)
+                 { ++changed; });
+    EXPECT_EQ(changed, 0);
+}
+
+TEST_F(ECSTest, ParallelBulkOperationsSplitLargeBatchesIntoRanges)
+{
+    constexpr size_t count = EntityRegistry::k_parallelBulkMinEntities + 1000;
+    ThreadPerTaskPool pool;
+
+    // Small batches stay on the calling thread
+    m_entityRegistry->createEntityBulk<Position>(pool, 10);
+    EXPECT_EQ(pool.dispatched, 0);
+
+    const auto metas = m_entityRegistry->createEntityBulk<Position, Health>(
+        pool, count, std::make_tuple(1.0f, 2.0f, 3.0f), std::make_tuple(50, 100));
+    EXPECT_GT(pool.dispatched, 0);
+
+    // Every location is recorded, the last range included
+    for (size_t i : {size_t{0}, count / 2, count - 1})
+    {
+        auto components = m_entityRegistry->getComponentsForEntity<Position, Health>(metas[i].id);
+        ASSERT_TRUE(components.has_value());
+        EXPECT_FLOAT_EQ(std::get<0>(*components).z, 3.0f);
+        EXPECT_EQ(std::get<1>(*components).hp, 50);
+    }
+
+    const size_t migrated = m_entityRegistry->migrateArchetypeModifyComponents(
+        pool, detail::From<Position, Health>{}, detail::Add<Velocity>{}, detail::Remove<Health>{});
+    EXPECT_EQ(migrated, count);
+
+    // The whole archetype is covered by the batch, so it migrates by ranges too
+    std::vector<EntityID> eids;
+    for (const EntityMeta& meta : metas) eids.push_back(meta.id);
+    eids.push_back(metas.front().id); // repeated IDs are moved once
+    m_entityRegistry->modifyComponentsBulk(pool, detail::Add<Frozen>{}, detail::Remove<>{}, eids);
+
+    size_t visited = 0;
+    m_entityRegistry->query<detail::Read<Position>, Velocity, detail::With<Frozen>>().forEach(
+        [&](EntityMeta _meta, const Position& _pos, Velocity&)
+        {
+            EXPECT_FLOAT_EQ(_pos.y, 2.0f);
+            auto located = m_entityRegistry->getComponentsForEntity<Position>(_meta.id);
+            EXPECT_EQ(&std::get<0>(*located), &_pos);
+            ++visited;
+        });
+    EXPECT_EQ(visited, count);
+    EXPECT_EQ(m_entityRegistry->entityCount(), count + 10);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Command Buffer Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, CommandBufferDefersStructuralChangesUntilPlayback)
+{
+    m_entityRegistry->createEntityBulk<Position>(100);
+
+    EntityCommandBuffer commands;
+    auto query = m_entityRegistry->query<Position>();
+
+    query.forEach(
+        [&](EntityMeta _meta, Position&)
+        {
+            if (_meta.id % 2 == 0) commands.destroyEntity(_meta.id);
+            else commands.addComponents<Velocity>(_meta.id);
+        });
+
+    EXPECT_EQ(commands.commandCount(), 100);
+    EXPECT_EQ(m_entityRegistry->entityCount(), 100);
+    EXPECT_EQ(m_entityRegistry->archetypeCount(), 1);
+
+    commands.playback(*m_entityRegistry);
+
+    EXPECT_TRUE(commands.empty());
+    EXPECT_EQ(m_entityRegistry->entityCount(), 50);
+    auto moved = m_entityRegistry->query<Position, Velocity>();
+    EXPECT_EQ(moved.entityCount(), 50);
+    EXPECT_FALSE(m_entityRegistry->isEntityValid({0, 0}));
+}
+
+TEST_F(ECSTest, CommandBufferMergesPerThreadBuffers)
+{
+    m_entityRegistry->createEntityBulk<Position>(2000);
+
+    ThreadPerTaskPool pool;
+    std::vector<EntityCommandBuffer> perThread(4);
+
+    // Each range records into the buffer of its quarter: a grain of whole tick blocks is kept as
+    // is, so the ranges are the quarters and the buffers disjoint per task
+    constexpr size_t grain = Archetype::k_tickBlockRows * 8;
+    m_entityRegistry->query<Position>().parallelForEachChunk(
+        pool,
+        [&](size_t _count, EntityMeta* _metas, Position*)
+        {
+            EntityCommandBuffer& commands = perThread[_metas[0].id / grain];
+            for (size_t i = 0; i < _count; ++i) commands.addComponents<Health>(_metas[i].id);
+        },
+        grain);
+
+    EntityCommandBuffer merged;
+    for (auto& commands : perThread) merged.append(std::move(commands));
+
+    EXPECT_EQ(merged.commandCount(), 2000);
+    EXPECT_TRUE(perThread[0].empty());
+
+    merged.playback(*m_entityRegistry);
+
+    auto moved = m_entityRegistry->query<Position, Health>();
+    EXPECT_EQ(moved.entityCount(), 2000);
+    EXPECT_FALSE(m_entityRegistry->viewSet<Position>().has_value());
+}
+
+TEST_F(ECSTest, CommandBufferPlaysModificationsBeforeDestructionsAndCreations)
+{
+    EntityMeta kept = m_entityRegistry->createEntity<Position>();
+    EntityMeta doomed = m_entityRegistry->createEntity<Position>();
+
+    EntityCommandBuffer commands;
+    commands.createEntity<Health>(Health{10, 20});
+    commands.destroyEntity(doomed.id);
+    commands.addComponents<Velocity>(kept.id, Velocity{1.0f, 2.0f, 3.0f});
+    commands.addComponents<Velocity>(doomed.id, Velocity{4.0f, 5.0f, 6.0f});
+    commands.removeComponents<Position>(kept.id);
+
+    commands.playback(*m_entityRegistry);
+
+    // kept: +Velocity with its value, then -Position
+    auto velocity = m_entityRegistry->getComponentsForEntity<Velocity>(kept.id);
+    ASSERT_TRUE(velocity.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*velocity).dy, 2.0f);
+    EXPECT_FALSE(m_entityRegistry->getComponentsForEntity<Position>(kept.id).has_value());
+
+    // doomed was modified and destroyed, its ID is recycled by the creation
+    EXPECT_FALSE(m_entityRegistry->isEntityValid(doomed));
+    auto health = m_entityRegistry->getComponentsForEntity<Health>(doomed.id);
+    ASSERT_TRUE(health.has_value());
+    EXPECT_EQ(std::get<0>(*health).maxHp, 20);
+    EXPECT_EQ(m_entityRegistry->entityCount(), 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tag Component Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, TagComponentsTakeNoRowBytes)
+{
+    EXPECT_EQ(m_compRegistry->info(m_compRegistry->getID<Frozen>()).size, 0);
+
+    auto plain = m_entityRegistry->createEntity<Position>();
+    auto frozen = m_entityRegistry->createEntity<Position, Frozen>();
+
+    auto* plainArch = m_entityRegistry->getArchetypeForEntity(plain.id);
+    auto* frozenArch = m_entityRegistry->getArchetypeForEntity(frozen.id);
+    ASSERT_NE(plainArch, frozenArch);
+
+    EXPECT_EQ(frozenArch->stride(), plainArch->stride());
+    EXPECT_FALSE(frozenArch->componentOffsets().contains(m_compRegistry->getID<Frozen>()));
+    EXPECT_TRUE(frozenArch->signature().testBit(m_compRegistry->getID<Frozen>()));
+}
+
+TEST_F(ECSTest, TagAddRemoveKeepsComponentData)
+{
+    auto metas = m_entityRegistry->createEntityBulk<Position>(
+        10, std::make_tuple(1.0f, 2.0f, 3.0f));
+
+    for (size_t i = 0; i < metas.size(); i += 2)
+    {
+        m_entityRegistry->addComponents<Frozen>(metas[i].id);
+    }
+
+    auto query = m_entityRegistry->query<Position, Frozen>();
+    EXPECT_EQ(query.entityCount(), 5);
+
+    size_t visited = 0;
+    query.forEach(
+        [&](EntityMeta _meta, Position& _pos, Frozen&)
+        {
+            EXPECT_EQ(_meta.id % 2, metas[0].id % 2);
+            EXPECT_FLOAT_EQ(_pos.y, 2.0f);
+            ++visited;
+        });
+    EXPECT_EQ(visited, 5);
+
+    for (auto [meta, components] : query)
+    {
+        EXPECT_FLOAT_EQ(std::get<0>(components).z, 3.0f);
+        --visited;
+    }
+    EXPECT_EQ(visited, 0);
+
+    EXPECT_TRUE((m_entityRegistry->getComponentsForEntity<Position, Frozen>(metas[0].id)));
+    m_entityRegistry->removeComponents<Frozen>(metas[0].id);
+    EXPECT_FALSE((m_entityRegistry->getComponentsForEntity<Position, Frozen>(metas[0].id)));
+
+    auto components = m_entityRegistry->getComponentsForEntity<Position>(metas[0].id);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).x, 1.0f);
+    EXPECT_EQ(query.entityCount(), 4);
+}
+
+TEST_F(ECSTest, AddedFilterReportsNewTags)
+{
+    auto metas = m_entityRegistry->createEntityBulk<Position>(100);
+    const uint32_t since = m_entityRegistry->advanceTick();
+
+    m_entityRegistry->addComponents<Frozen>(metas[7].id);
+
+    std::vector<EntityID> added;
+    m_entityRegistry->query<Position>().forEach(
+        detail::Added<Frozen>{}, since,
+        [&](EntityMeta _meta, Position&) { added.push_back(_meta.id); });
+    EXPECT_EQ(added, std::vector<EntityID>{metas[7].id});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Shared Component Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, SharedComponentsGroupEntitiesByValue)
+{
+    auto metas = m_entityRegistry->createEntityBulk<Position>(6, std::make_tuple(1.0f, 2.0f, 3.0f));
+    const size_t plainStride = m_entityRegistry->getArchetypeForEntity(metas[0].id)->stride();
+
+    for (size_t i = 0; i < metas.size(); ++i)
+    {
+        m_entityRegistry->setSharedComponent(metas[i].id, Material{i < 3 ? 1 : 2, 0.5f});
+    }
+
+    auto* first = m_entityRegistry->getArchetypeForEntity(metas[0].id);
+    auto* second = m_entityRegistry->getArchetypeForEntity(metas[3].id);
+    ASSERT_NE(first, second);
+    EXPECT_EQ(first, m_entityRegistry->getArchetypeForEntity(metas[2].id));
+    EXPECT_EQ(first->stride(), plainStride);
+    EXPECT_EQ(first->size(), 3);
+
+    const Material* material = m_entityRegistry->getSharedComponent<Material>(metas[4].id);
+    ASSERT_NE(material, nullptr);
+    EXPECT_EQ(material->id, 2);
+    EXPECT_EQ(material, m_entityRegistry->getSharedComponent<Material>(metas[5].id));
+
+    auto query = m_entityRegistry->query<Position, Material>();
+    EXPECT_EQ(query.archetypes().size(), 2);
+
+    int materialSum = 0;
+    query.forEach(
+        [&](EntityMeta, Position& _pos, Material& _material)
+        {
+            EXPECT_FLOAT_EQ(_pos.z, 3.0f);
+            materialSum += _material.id;
+        });
+    EXPECT_EQ(materialSum, 9);
+
+    for (auto [meta, components] : query) materialSum -= std::get<1>(components).id;
+    EXPECT_EQ(materialSum, 0);
+
+    auto components = m_entityRegistry->getComponentsForEntity<Position, Material>(metas[0].id);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_EQ(std::get<1>(*components).id, 1);
+}
+
+TEST_F(ECSTest, SharedComponentChangeAndRemovalKeepData)
+{
+    auto meta = m_entityRegistry->createEntity<Position>(std::make_tuple(4.0f, 5.0f, 6.0f));
+    auto* plain = m_entityRegistry->getArchetypeForEntity(meta.id);
+
+    m_entityRegistry->setSharedComponent(meta.id, Material{1, 0.0f});
+    auto* first = m_entityRegistry->getArchetypeForEntity(meta.id);
+
+    m_entityRegistry->setSharedComponent(meta.id, Material{1, 0.0f});
+    EXPECT_EQ(m_entityRegistry->getArchetypeForEntity(meta.id), first);
+
+    m_entityRegistry->setSharedComponent(meta.id, Material{7, 0.0f});
+    EXPECT_NE(m_entityRegistry->getArchetypeForEntity(meta.id), first);
+    EXPECT_EQ(m_entityRegistry->getSharedComponent<Material>(meta.id)->id, 7);
+
+    // regular transitions keep the shared value
+    m_entityRegistry->addComponents<Velocity>(meta.id);
+    EXPECT_EQ(m_entityRegistry->getSharedComponent<Material>(meta.id)->id, 7);
+
+    m_entityRegistry->removeComponents<Velocity, Material>(meta.id);
+    EXPECT_EQ(m_entityRegistry->getSharedComponent<Material>(meta.id), nullptr);
+    EXPECT_EQ(m_entityRegistry->getArchetypeForEntity(meta.id), plain);
+
+    auto components = m_entityRegistry->getComponentsForEntity<Position>(meta.id);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).y, 5.0f);
+}
+
+TEST_F(ECSTest, SharedComponentsRequireAValue)
+{
+    auto meta = m_entityRegistry->createEntity<Position>();
+
+    EXPECT_THROW((m_entityRegistry->createEntity<Position, Material>()), std::runtime_error);
+    EXPECT_THROW(m_entityRegistry->addComponents<Material>(meta.id), std::runtime_error);
+    EXPECT_THROW(m_entityRegistry->setSharedComponent(meta.id, Position{}), std::runtime_error);
+
+    EXPECT_EQ(m_entityRegistry->entityCount(), 1);
+    EXPECT_TRUE((m_entityRegistry->getComponentsForEntity<Position>(meta.id)));
+}
+
+TEST_F(ECSTest, SingletonsLiveOutsideArchetypes)
+{
+    EXPECT_EQ(m_entityRegistry->getSingleton<GameTime>(), nullptr);
+
+    GameTime& time = m_entityRegistry->setSingleton<GameTime>(0.016f, 1u);
+    ++time.frame;
+
+    m_entityRegistry->createEntity<Position>();
+    m_entityRegistry->clear();
+
+    const GameTime* stored = m_entityRegistry->getSingleton<GameTime>();
+    ASSERT_EQ(stored, &time);
+    EXPECT_EQ(stored->frame, 2);
+    EXPECT_EQ(m_entityRegistry->archetypeCount(), 0);
+
+    m_entityRegistry->setSingleton<GameTime>(0.033f, 10u);
+    EXPECT_EQ(m_entityRegistry->getSingleton<GameTime>()->frame, 10);
+
+    EXPECT_TRUE(m_entityRegistry->removeSingleton<GameTime>());
+    EXPECT_FALSE(m_entityRegistry->removeSingleton<GameTime>());
+    EXPECT_EQ(m_entityRegistry->getSingleton<GameTime>(), nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reservation Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, ReservedHandlesBecomeEntitiesOnCreate)
+{
+    m_entityRegistry->createEntity<Position>();
+    EntityMeta destroyed = m_entityRegistry->createEntity<Position>();
+    m_entityRegistry->destroyEntity(destroyed.id);
+
+    std::array<EntityMeta, 3> reserved{};
+    m_entityRegistry->reserveEntities(reserved);
+
+    // Recycled IDs come first, with the generation of their next use
+    EXPECT_EQ(reserved[0].id, destroyed.id);
+    EXPECT_EQ(reserved[0].gen, destroyed.gen + 1);
+    EXPECT_EQ(reserved[1].id, 2);
+    EXPECT_EQ(reserved[2].id, 3);
+
+    EXPECT_FALSE(m_entityRegistry->isEntityValid(reserved[0]));
+    EXPECT_EQ(m_entityRegistry->entityCount(), 1);
+    EXPECT_EQ(m_entityRegistry->reservedEntityCount(), 3);
+
+    // Regular creations skip reserved IDs
+    EXPECT_EQ(m_entityRegistry->createEntity<Position>().id, 4);
+
+    EXPECT_TRUE(m_entityRegistry->createReservedEntity<Position>(
+        reserved[1], std::make_tuple(1.0f, 2.0f, 3.0f)));
+    EXPECT_FALSE(m_entityRegistry->createReservedEntity<Position>(reserved[1]));
+    EXPECT_TRUE(m_entityRegistry->createReservedEntity<Velocity>(reserved[0]));
+
+    EXPECT_TRUE(m_entityRegistry->isEntityValid(reserved[0]));
+    auto created = m_entityRegistry->getComponentsForEntity<Position>(reserved[1].id);
+    ASSERT_TRUE(created.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*created).y, 2.0f);
+    EXPECT_EQ(m_entityRegistry->entityCount(), 4);
+    EXPECT_EQ(m_entityRegistry->reservedEntityCount(), 1);
+
+    EXPECT_TRUE(m_entityRegistry->releaseReservedEntity(reserved[2]));
+    EXPECT_FALSE(m_entityRegistry->releaseReservedEntity(reserved[2]));
+    EXPECT_EQ(m_entityRegistry->reservedEntityCount(), 0);
+    EXPECT_EQ(m_entityRegistry->createEntity<Position>().id, reserved[2].id);
+}
+
+TEST_F(ECSTest, ConcurrentReservationsAreUnique)
+{
+    constexpr size_t k_threads = 4;
+    constexpr size_t k_perThread = 1000;
+
+    // Some recycled IDs to hand out before fresh ones
+    auto metas = m_entityRegistry->createEntityBulk<Position>(100);
+    for (const EntityMeta& meta : metas) m_entityRegistry->destroyEntity(meta.id);
+
+    std::vector<std::vector<EntityMeta>> reserved(k_threads);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 0; t < k_threads; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    EntityReserver reserver(*m_entityRegistry);
+                    for (size_t i = 0; i < k_perThread; ++i)
+                    {
+                        reserved[t].push_back(reserver.reserve());
+                    }
+                });
+        }
+    }
+
+    std::vector<EntityID> ids;
+    for (const auto& handles : reserved)
+    {
+        for (const EntityMeta& meta : handles) ids.push_back(meta.id);
+    }
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(std::adjacent_find(ids.begin(), ids.end()), ids.end());
+
+    // Whole blocks are reserved, the handles left in the caches stay reserved
+    const size_t blocks = (k_perThread + EntityReserver::k_blockSize - 1) /
+                          EntityReserver::k_blockSize;
+    EXPECT_EQ(m_entityRegistry->reservedEntityCount(),
+              k_threads * blocks * EntityReserver::k_blockSize);
+
+    for (const auto& handles : reserved)
+    {
+        for (const EntityMeta& meta : handles)
+        {
+            ASSERT_TRUE(m_entityRegistry->createReservedEntity<Position>(meta));
+        }
+    }
+    EXPECT_EQ(m_entityRegistry->entityCount(), k_threads * k_perThread);
+}
+
+TEST_F(ECSTest, CommandBufferCreatesReservedEntitiesFirst)
+{
+    EntityReserver reserver(*m_entityRegistry);
+    EntityCommandBuffer commands;
+
+    const EntityMeta spawned = reserver.reserve();
+    commands.addComponents<Velocity>(spawned.id, Velocity{0.0f, 0.0f, 5.0f});
+    commands.createReservedEntity<Position>(spawned, Position{1.0f, 2.0f, 3.0f});
+    EXPECT_EQ(commands.commandCount(), 2);
+
+    commands.playback(*m_entityRegistry);
+
+    ASSERT_TRUE(m_entityRegistry->isEntityValid(spawned));
+    auto components = m_entityRegistry->getComponentsForEntity<Position, Velocity>(spawned.id);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).x, 1.0f);
+    EXPECT_FLOAT_EQ(std::get<1>(*components).dz, 5.0f);
+
+    EXPECT_EQ(reserver.cachedCount(), EntityReserver::k_blockSize - 1);
+    reserver.release(*m_entityRegistry);
+    EXPECT_EQ(reserver.cachedCount(), 0);
+    EXPECT_EQ(m_entityRegistry->reservedEntityCount(), 0);
+    EXPECT_EQ(m_entityRegistry->entityCount(), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Snapshot Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, SnapshotRoundTripPreservesEntities)
+{
+    std::vector<EntityMeta> metas;
+    for (int i = 0; i < 100; ++i)
+    {
+        const float f = static_cast<float>(i);
+        metas.push_back(m_entityRegistry->createEntity<Position, Velocity>(
+            std::make_tuple(f, f, f), std::make_tuple(-f, 0.0f, 0.0f)));
+    }
+    EntityMeta frozen = m_entityRegistry->createEntity<Health, Frozen>(std::make_tuple(7, 9),
+                                                                        std::make_tuple());
+    m_entityRegistry->setSharedComponent(frozen.id, Material{4, 0.5f});
+    m_entityRegistry->destroyEntity(metas[10].id);
+    m_entityRegistry->destroyEntity(metas[20].id);
+
+    std::vector<uint8_t> bytes;
+    m_entityRegistry->writeSnapshot(bytes);
+
+    EntityRegistry loaded(m_compRegistry.get());
+    loaded.readSnapshot(bytes);
+
+    EXPECT_EQ(loaded.entityCount(), 99);
+    EXPECT_EQ(loaded.archetypeCount(), 2);
+    EXPECT_FALSE(loaded.isEntityValid(metas[10]));
+    ASSERT_TRUE(loaded.isEntityValid(metas[55]));
+
+    auto components = loaded.getComponentsForEntity<Position, Velocity>(metas[55].id);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).y, 55.0f);
+    EXPECT_FLOAT_EQ(std::get<1>(*components).dx, -55.0f);
+
+    ASSERT_TRUE(loaded.isEntityValid(frozen));
+    EXPECT_EQ(loaded.getSharedComponent<Material>(frozen.id)->id, 4);
+    auto health = loaded.getComponentsForEntity<Health>(frozen.id);
+    ASSERT_TRUE(health.has_value());
+    EXPECT_EQ(std::get<0>(*health).maxHp, 9);
+
+    // Freed IDs are recycled with a new generation
+    const EntityMeta reused = loaded.createEntity<Position>();
+    EXPECT_EQ(reused.id, metas[10].id);
+    EXPECT_EQ(reused.gen, metas[10].gen + 1);
+}
+
+TEST_F(ECSTest, SnapshotRemapsComponentsByName)
+{
+    m_entityRegistry->createEntity<Position, Health>(std::make_tuple(1.0f, 2.0f, 3.0f),
+                                                     std::make_tuple(4, 5));
+
+    std::vector<uint8_t> bytes;
+    m_entityRegistry->writeSnapshot(bytes);
+
+    // Other IDs, other offsets: rows are re-laid out component by component
+    ComponentRegistry other;
+    other.registerComponent<Health>("Health");
+    other.registerComponent<Tag>("Tag");
+    other.registerComponent<Position>("Position");
+    other.registerSharedComponent<Material>("Material");
+
+    EntityRegistry loaded(&other, ArchetypeStorageMode::chunked);
+    loaded.readSnapshot(bytes);
+
+    auto components = loaded.getComponentsForEntity<Position, Health>(0);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).z, 3.0f);
+    EXPECT_EQ(std::get<1>(*components).maxHp, 5);
+
+    // Velocity is not registered in the target, but no archetype uses it
+    m_entityRegistry->createEntity<Velocity>();
+    bytes.clear();
+    m_entityRegistry->writeSnapshot(bytes);
+
+    EXPECT_THROW(loaded.readSnapshot(bytes), std::runtime_error);
+    EXPECT_EQ(loaded.entityCount(), 0);
+}
+
+TEST_F(ECSTest, SnapshotFileRoundTripAndCorruption)
+{
+    m_entityRegistry->createEntityBulk<Health>(1000, std::make_tuple(3, 4));
+
+    const auto path = std::filesystem::temp_directory_path() / "mosaic_ecs_snapshot_test.bin";
+    saveSnapshotToFile(*m_entityRegistry, path);
+
+    EntityRegistry loaded(m_compRegistry.get());
+    loadSnapshotFromFile(loaded, path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(loaded.entityCount(), 1000);
+    EXPECT_EQ(loaded.query<Health>().entityCount(), 1000);
+
+    std::vector<uint8_t> bytes;
+    m_entityRegistry->writeSnapshot(bytes);
+    bytes.resize(bytes.size() / 2);
+
+    EXPECT_THROW(loaded.readSnapshot(bytes), std::runtime_error);
+    EXPECT_EQ(loaded.entityCount(), 0);
+    EXPECT_THROW(loaded.readSnapshot({}), std::runtime_error);
+}
+
+TEST_F(ECSTest, SnapshotAppendsInSlicesUnderNewIDs)
+{
+    for (int i = 0; i < 50; ++i)
+    {
+        const float f = static_cast<float>(i);
+        m_entityRegistry->createEntity<Position, Velocity>(std::make_tuple(f, f, f),
+                                                           std::make_tuple(-f, 0.0f, 0.0f));
+    }
+    m_entityRegistry->createEntityBulk<Health>(30, std::make_tuple(3, 4));
+
+    std::vector<uint8_t> bytes;
+    m_entityRegistry->writeSnapshot(bytes);
+
+    // appended next to the entities already there, whose IDs the snapshot also uses
+    EntityRegistry loaded(m_compRegistry.get());
+    const EntityMeta resident = loaded.createEntity<Position>(std::make_tuple(7.0f, 7.0f, 7.0f));
+
+    size_t added = 0;
+    const ObserverID observer = loaded.observe<Health>(
+        ComponentEvent::added, [&](std::span<const EntityID> _eids) { added += _eids.size(); });
+
+    SnapshotCursor cursor;
+    std::vector<EntityMeta> created;
+    int calls = 0;
+    while (!loaded.appendSnapshot(bytes, cursor, 32, created))
+    {
+        EXPECT_EQ(created.size(), size_t(32 * ++calls));
+    }
+
+    EXPECT_EQ(calls, 2);
+    EXPECT_TRUE(cursor.done);
+    EXPECT_EQ(created.size(), 80u);
+    EXPECT_EQ(added, 30u);
+    EXPECT_EQ(loaded.entityCount(), 81);
+    EXPECT_TRUE(loaded.appendSnapshot(bytes, cursor, 32, created));
+
+    auto kept = loaded.getComponentsForEntity<Position>(resident.id);
+    ASSERT_TRUE(kept.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*kept).x, 7.0f);
+
+    // the rows keep their order, their metas are the new entities
+    auto components = loaded.getComponentsForEntity<Position, Velocity>(created[12].id);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).y, 12.0f);
+    EXPECT_FLOAT_EQ(std::get<1>(*components).dx, -12.0f);
+    EXPECT_EQ(loaded.query<Health>().entityCount(), 30);
+
+    for (const EntityMeta& meta : created) EXPECT_NE(meta.id, resident.id);
+    loaded.unobserve(observer);
+
+    bytes.resize(bytes.size() / 2);
+    SnapshotCursor truncated;
+    EXPECT_THROW(loaded.appendSnapshot(bytes, truncated, 1000, created), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Observer Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, AddObserversReceiveOneBatchPerOperation)
+{
+    std::vector<std::vector<EntityID>> batches;
+    m_entityRegistry->observe<Velocity>(ComponentEvent::added,
+                                        [&](std::span<const EntityID> _eids)
+                                        { batches.emplace_back(_eids.begin(), _eids.end()); });
+
+    m_entityRegistry->createEntityBulk<Position>(4);
+    EXPECT_TRUE(batches.empty());
+
+    m_entityRegistry->createEntityBulk<Position, Velocity>(100);
+    ASSERT_EQ(batches.size(), 1u);
+    EXPECT_EQ(batches[0].size(), 100u);
+
+    // only the entities actually gaining Velocity are reported
+    (void)m_entityRegistry->addComponentsBulk<Velocity>({0, 1, 4, 5, 1});
+    ASSERT_EQ(batches.size(), 2u);
+    std::sort(batches[1].begin(), batches[1].end());
+    EXPECT_EQ(batches[1], (std::vector<EntityID>{0, 1}));
+
+    // whole-archetype migrations hand the migrated rows through
+    (void)m_entityRegistry->migrateArchetypeModifyComponents(
+        detail::From<Position>{}, detail::Add<Velocity>{}, detail::Remove<>{});
+    ASSERT_EQ(batches.size(), 3u);
+    EXPECT_EQ(batches[2].size(), 2u);
+
+    m_entityRegistry->addComponents<Velocity>(m_entityRegistry->createEntity<Health>().id);
+    ASSERT_EQ(batches.size(), 4u);
+    EXPECT_EQ(batches[3].size(), 1u);
+}
+
+TEST_F(ECSTest, RemoveObserversReadValuesBeforeTheyAreGone)
+{
+    for (int i = 0; i < 10; ++i) m_entityRegistry->createEntity<Health>(std::make_tuple(i, 0));
+    m_entityRegistry->createEntity<Health, Tag>(std::make_tuple(10, 0), std::make_tuple(0));
+
+    std::vector<size_t> batchSizes;
+    int hpSum = 0;
+    m_entityRegistry->observe<Health>(
+        ComponentEvent::removed,
+        [&](std::span<const EntityID> _eids)
+        {
+            batchSizes.push_back(_eids.size());
+            for (EntityID eid : _eids)
+            {
+                hpSum += std::get<0>(*m_entityRegistry->getComponentsForEntity<Health>(eid)).hp;
+            }
+        });
+
+    // duplicated IDs and entities of several archetypes, still a single call
+    (void)m_entityRegistry->destroyEntityBulk({1, 2, 2, 10, 99});
+    EXPECT_EQ(batchSizes, (std::vector<size_t>{3}));
+    EXPECT_EQ(hpSum, 1 + 2 + 10);
+
+    m_entityRegistry->removeComponents<Health>(3);
+    (void)m_entityRegistry->removeComponentsBulk<Velocity>({4, 5});
+    m_entityRegistry->destroyEntity(4);
+    EXPECT_EQ(batchSizes, (std::vector<size_t>{3, 1, 1}));
+    EXPECT_EQ(hpSum, 1 + 2 + 10 + 3 + 4);
+
+    // clear() reports the remaining entities per archetype
+    m_entityRegistry->clear();
+    EXPECT_EQ(batchSizes.size(), 4u);
+    EXPECT_EQ(hpSum, 1 + 2 + 10 + 3 + 4 + (0 + 5 + 6 + 7 + 8 + 9));
+}
+
+TEST_F(ECSTest, CommandBufferPlaybackNotifiesPerBatch)
+{
+    auto metas = m_entityRegistry->createEntityBulk<Position>(64);
+
+    size_t addCalls = 0;
+    size_t removeCalls = 0;
+    size_t removed = 0;
+    const ObserverID onAdd = m_entityRegistry->observe<Velocity>(
+        ComponentEvent::added, [&](std::span<const EntityID>) { ++addCalls; });
+    m_entityRegistry->observe<Position>(ComponentEvent::removed,
+                                        [&](std::span<const EntityID> _eids)
+                                        {
+                                            ++removeCalls;
+                                            removed += _eids.size();
+                                        });
+
+    EntityCommandBuffer commands;
+    for (const EntityMeta& meta : metas)
+    {
+        if (meta.id % 2 == 0) commands.destroyEntity(meta.id);
+        else commands.addComponents<Velocity>(meta.id);
+    }
+    commands.playback(*m_entityRegistry);
+
+    EXPECT_EQ(addCalls, 1u);
+    EXPECT_EQ(removeCalls, 1u);
+    EXPECT_EQ(removed, 32u);
+
+    EXPECT_TRUE(m_entityRegistry->unobserve(onAdd));
+    EXPECT_FALSE(m_entityRegistry->unobserve(onAdd));
+    m_entityRegistry->createEntityBulk<Velocity>(8);
+    EXPECT_EQ(addCalls, 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sorting Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Returns the hp values of the entities with Health in view order, checking their records.
+std::vector<int> hpInViewOrder(EntityRegistry& _registry)
+{
+    std::vector<int> values;
+    _registry.query<Health>().view().readOnly().forEach(
+        [&](EntityMeta _meta, Health& _health)
+        {
+            auto components = _registry.getComponentsForEntity<Health>(_meta.id);
+            EXPECT_EQ(&std::get<0>(*components), &_health);
+            values.push_back(_health.hp);
+        });
+
+    return values;
+}
+
+} // namespace
+
+TEST_F(ECSTest, SortArchetypeOrdersRowsAndKeepsHandles)
+{
+    std::vector<EntityMeta> metas;
+    for (int i = 0; i < 500; ++i)
+    {
+        metas.push_back(m_entityRegistry->createEntity<Health, Position>(
+            std::make_tuple((i * 7919) % 500, i), std::make_tuple(static_cast<float>(i), 0.0f,
+                                                                  0.0f)));
+    }
+    m_entityRegistry->createEntity<Health>(std::make_tuple(-1, 0));
+
+    m_entityRegistry->sortArchetype<Health>([](const Health& _a, const Health& _b)
+                                            { return _a.hp < _b.hp; });
+
+    // each archetype is sorted on its own
+    const std::vector<int> values = hpInViewOrder(*m_entityRegistry);
+    ASSERT_EQ(values.size(), 501u);
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end() - 1));
+
+    for (const EntityMeta& meta : metas)
+    {
+        auto components = m_entityRegistry->getComponentsForEntity<Health, Position>(meta.id);
+        EXPECT_EQ(std::get<1>(*components).x, static_cast<float>(std::get<0>(*components).maxHp));
+    }
+}
+
+TEST_F(ECSTest, SortingDoesNotStampChanges)
+{
+    for (int i = 0; i < 300; ++i) m_entityRegistry->createEntity<Health>(std::make_tuple(-i, i));
+
+    const uint32_t since = m_entityRegistry->advanceTick();
+    m_entityRegistry->markChanged<Health>(299);
+
+    m_entityRegistry->sortArchetype<Health>([](const Health& _a, const Health& _b)
+                                            { return _a.hp < _b.hp; });
+
+    // entity 299 moved from the last block to the first one, which now reports it as changed
+    std::vector<EntityID> changed;
+    m_entityRegistry->query<Health>().view().readOnly().forEach(
+        detail::Changed<Health>{}, since,
+        [&](EntityMeta _meta, Health&) { changed.push_back(_meta.id); });
+
+    ASSERT_EQ(changed.size(), Archetype::k_tickBlockRows);
+    EXPECT_EQ(changed.front(), 299u);
+}
+
+TEST_F(ECSTest, GroupByKeepsRowsSortedIncrementally)
+{
+    m_entityRegistry->groupBy<Health>([](const Health& _a, const Health& _b)
+                                      { return _a.hp < _b.hp; });
+
+    std::vector<EntityMeta> metas;
+    for (int i = 0; i < 1000; ++i)
+    {
+        metas.push_back(
+            m_entityRegistry->createEntity<Health>(std::make_tuple((i * 7919) % 1000, i)));
+    }
+
+    m_entityRegistry->updateGroups();
+    std::vector<int> values = hpInViewOrder(*m_entityRegistry);
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+    m_entityRegistry->advanceTick();
+
+    // a few writes, removals and creations scattered over the rows
+    m_entityRegistry->query<Health>().forEach(
+        [](EntityMeta _meta, Health& _health)
+        {
+            if (_meta.id % 97 == 0) _health.hp = 2000 - _health.hp;
+        });
+    for (int i = 0; i < 1000; i += 131) m_entityRegistry->destroyEntity(metas[i].id);
+    for (int i = 0; i < 5; ++i)
+    {
+        m_entityRegistry->createEntity<Health>(std::make_tuple(i * 300 + 1, 0));
+    }
+
+    m_entityRegistry->updateGroups();
+    values = hpInViewOrder(*m_entityRegistry);
+    EXPECT_EQ(values.size(), 1000u - 8u + 5u);
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+
+    // archetypes created later join the group, writes without markChanged() are still caught
+    // as long as the archetype was written somewhere
+    auto extra = m_entityRegistry->createEntityBulk<Health, Tag>(200);
+    std::get<0>(*m_entityRegistry->getComponentsForEntity<Health>(extra[10].id)).hp = 9;
+
+    m_entityRegistry->updateGroups();
+    values = hpInViewOrder(*m_entityRegistry);
+    EXPECT_EQ(values.size(), 1197u);
+
+    EXPECT_TRUE(m_entityRegistry->ungroup<Health>());
+    EXPECT_FALSE(m_entityRegistry->ungroup<Health>());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compaction Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, CompactDestroysEmptyArchetypesAndKeepsEntitiesReachable)
+{
+    auto wave = m_entityRegistry->createEntityBulk<Position, Velocity>(2000);
+    auto positions = m_entityRegistry->createEntityBulk<Position>(10);
+    auto healths = m_entityRegistry->createEntityBulk<Health>(10, std::make_tuple(7, 100));
+
+    auto query = m_entityRegistry->query<Position>();
+    EXPECT_EQ(query.archetypes().size(), 2);
+
+    std::vector<EntityID> waveIDs;
+    for (const auto& meta : wave) waveIDs.push_back(meta.id);
+    (void)m_entityRegistry->destroyEntityBulk(waveIDs);
+
+    const size_t usageBefore = m_entityRegistry->totalMemoryUsageInBytes();
+    const CompactionResult result = m_entityRegistry->compact();
+
+    EXPECT_TRUE(result.finished);
+    EXPECT_EQ(result.archetypesRemoved, 1);
+    EXPECT_EQ(m_entityRegistry->archetypeCount(), 2);
+    EXPECT_GT(result.bytesReclaimed, 0);
+    EXPECT_EQ(m_entityRegistry->totalMemoryUsageInBytes(), usageBefore - result.bytesReclaimed);
+    EXPECT_EQ(query.archetypes().size(), 1);
+
+    // the archetype moved into the freed table slot still resolves its entities
+    for (const auto& meta : healths)
+    {
+        auto health = m_entityRegistry->getComponentsForEntity<Health>(meta.id);
+        ASSERT_TRUE(health.has_value());
+        EXPECT_EQ(std::get<0>(*health).hp, 7);
+    }
+
+    // destroyed archetypes are recreated on demand through the transition graph
+    m_entityRegistry->addComponents<Velocity>(positions[0].id);
+
+    auto* arch = m_entityRegistry->getArchetypeForEntity(positions[0].id);
+    ASSERT_NE(arch, nullptr);
+    EXPECT_EQ(arch->size(), 1);
+    EXPECT_EQ(query.entityCount(), 10);
+    EXPECT_EQ(query.archetypes().size(), 2);
+}
+
+TEST_F(ECSTest, CompactSpreadsOverCallsWithinBudget)
+{
+    m_entityRegistry->createEntity<Position>();
+    m_entityRegistry->createEntity<Velocity>();
+    m_entityRegistry->createEntity<Health>();
+    m_entityRegistry->destroyEntity(m_entityRegistry->createEntity<Tag>().id);
+
+    size_t calls = 0;
+    size_t removed = 0;
+
+    CompactionResult result;
+    do
+    {
+        result = m_entityRegistry->compact(1);
+        removed += result.archetypesRemoved;
+        ++calls;
+    } while (!result.finished);
+
+    EXPECT_EQ(calls, 4);
+    EXPECT_EQ(removed, 1);
+    EXPECT_EQ(m_entityRegistry->archetypeCount(), 3);
+    EXPECT_EQ(m_entityRegistry->entityCount(), 3);
+
+    // a new pass starts over
+    EXPECT_FALSE(m_entityRegistry->compact(1).finished);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Change Detection Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, ChangedFilterSkipsUntouchedBlocks)
+{
+    auto metas = m_entityRegistry->createEntityBulk<Position>(10 * Archetype::k_tickBlockRows);
+    auto query = m_entityRegistry->query<Position>();
+
+    size_t visited = 0;
+    query.forEach(detail::Changed<Position>{}, 0, [&](EntityMeta, Position&) { ++visited; });
+    EXPECT_EQ(visited, metas.size()); // creation is a write
+
+    const uint32_t since = m_entityRegistry->advanceTick();
+
+    visited = 0;
+    query.forEach(detail::Changed<Position>{}, since, [&](EntityMeta, Position&) { ++visited; });
+    EXPECT_EQ(visited, 0);
+
+    // one write in the fourth block
+    auto components = m_entityRegistry->getComponentsForEntity<Position>(metas[200].id);
+    std::get<0>(*components).x = 5.0f;
+    m_entityRegistry->markChanged<Position>(metas[200].id);
+
+    visited = 0;
+    query.forEach(detail::Changed<Position>{}, since,
+                  [&](EntityMeta _meta, Position&)
+                  {
+                      EXPECT_EQ(_meta.id / Archetype::k_tickBlockRows, 3);
+                      ++visited;
+                  });
+    EXPECT_EQ(visited, Archetype::k_tickBlockRows);
+}
+
+TEST_F(ECSTest, AddedFilterOnlyReportsNewlyAddedComponents)
+{
+    auto metas = m_entityRegistry->createEntityBulk<Position>(100);
+    const uint32_t since = m_entityRegistry->advanceTick();
+
+    m_entityRegistry->addComponents<Velocity>(metas[42].id);
+
+    auto query = m_entityRegistry->query<Position>();
+
+    std::vector<EntityID> added;
+    query.forEach(detail::Added<Velocity>{}, since,
+                  [&](EntityMeta _meta, Position&) { added.push_back(_meta.id); });
+    EXPECT_EQ(added, std::vector<EntityID>{metas[42].id});
+
+    // Position moved along with the entity, it was not added
+    size_t visited = 0;
+    query.forEach(detail::Added<Position>{}, since, [&](EntityMeta, Position&) { ++visited; });
+    EXPECT_EQ(visited, 0);
+}
+
+TEST_F(ECSTest, ReadOnlyIterationDoesNotStampChanges)
+{
+    m_entityRegistry->createEntityBulk<Position, Velocity>(300);
+    auto query = m_entityRegistry->query<Position, Velocity>();
+
+    const uint32_t since = m_entityRegistry->advanceTick();
+    auto countChanged = [&]
+    {
+        size_t visited = 0;
+        query.view().readOnly().forEach(detail::Changed<Velocity>{}, since,
+                                        [&](EntityMeta, Position&, Velocity&) { ++visited; });
+        return visited;
+    };
+
+    query.view().readOnly().forEach([](EntityMeta, Position&, Velocity&) {});
+    EXPECT_EQ(countChanged(), 0);
+
+    query.forEach([](EntityMeta, Position& _pos, Velocity& _vel) { _pos.x += _vel.dx; });
+    EXPECT_EQ(countChanged(), 300);
+}
+
+TEST_F(ECSTest, ConsumerDoesNotSeeItsOwnWrites)
+{
+    m_entityRegistry->createEntityBulk<Health>(10);
+    auto query = m_entityRegistry->query<Health>();
+
+    // first run sees everything, then records the tick it ran at
+    size_t visited = 0;
+    query.forEach(detail::Changed<Health>{}, 0, [&](EntityMeta, Health&) { ++visited; });
+    const uint32_t lastRun = m_entityRegistry->advanceTick();
+    EXPECT_EQ(visited, 10);
+
+    visited = 0;
+    query.forEach(detail::Changed<Health>{}, lastRun, [&](EntityMeta, Health&) { ++visited; });
+    EXPECT_EQ(visited, 0);
+
+    // a write made after the run is seen by the next one
+    m_entityRegistry->markChanged<Health>(0);
+    query.forEach(detail::Changed<Health>{}, lastRun, [&](EntityMeta, Health&) { ++visited; });
+    EXPECT_EQ(visited, 10);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Chunked Storage Mode Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ECSChunkedTest : public ECSTest
+{
+   protected:
+    void SetUp() override
+    {
+        ECSTest::SetUp();
+
+        m_entityRegistry =
+            std::make_unique<EntityRegistry>(m_compRegistry.get(), ArchetypeStorageMode::chunked);
+    }
+};
+
+TEST_F(ECSChunkedTest, CreateEntitiesSpanningMultipleChunks)
+{
+    std::vector<EntityMeta> metas;
+    for (int i = 0; i < 3000; ++i)
+    {
+        float f = static_cast<float>(i);
+        metas.push_back(m_entityRegistry->createEntity<Position, Velocity>(
+            std::make_tuple(f, f, f), std::make_tuple(-f, 0.0f, 0.0f)));
+    }
+
+    auto* arch = m_entityRegistry->getArchetypeForEntity(metas[0].id);
+    ASSERT_NE(arch, nullptr);
+    EXPECT_TRUE(arch->isChunked());
+    EXPECT_GT(arch->chunkCount(), 1);
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        auto result = m_entityRegistry->getComponentsForEntity<Position, Velocity>(metas[i].id);
+        ASSERT_TRUE(result.has_value());
+        auto& [pos, vel] = result.value();
+        EXPECT_FLOAT_EQ(pos.x, static_cast<float>(i));
+        EXPECT_FLOAT_EQ(vel.dx, -static_cast<float>(i));
+        EXPECT_TRUE(m_entityRegistry->isEntityValid(metas[i]));
+    }
+}
+
+TEST_F(ECSChunkedTest, DestroyEntityKeepsRemainingDataIntact)
+{
+    std::vector<EntityMeta> metas;
+    for (int i = 0; i < 100; ++i)
+    {
+        metas.push_back(m_entityRegistry->createEntity<Health>(std::make_tuple(i, 100)));
+    }
+
+    for (int i = 0; i < 100; i += 2) m_entityRegistry->destroyEntity(metas[i].id);
+
+    EXPECT_EQ(m_entityRegistry->entityCount(), 50);
+
+    for (int i = 1; i < 100; i += 2)
+    {
+        auto result = m_entityRegistry->getComponentsForEntity<Health>(metas[i].id);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(std::get<0>(result.value()).hp, i);
+    }
+}
+
+TEST_F(ECSChunkedTest, TagsHaveNoColumn)
+{
+    m_entityRegistry->createEntityBulk<Health, Frozen>(3000, std::make_tuple(5, 10),
+                                                       std::make_tuple());
+
+    auto view = m_entityRegistry->viewSubset<Health, Frozen>();
+    ASSERT_TRUE(view.has_value());
+
+    size_t visited = 0;
+    view->forEachChunk(
+        [&](size_t _count, EntityMeta*, Health* _health, Frozen*)
+        {
+            for (size_t i = 0; i < _count; ++i) EXPECT_EQ(_health[i].hp, 5);
+            visited += _count;
+        });
+    EXPECT_EQ(visited, 3000);
+
+    for (auto [meta, components] : *view)
+    {
+        EXPECT_EQ(std::get<0>(components).maxHp, 10);
+        --visited;
+    }
+    EXPECT_EQ(visited, 0);
+}
+
+TEST_F(ECSChunkedTest, SharedComponentsHaveNoColumn)
+{
+    auto metas = m_entityRegistry->createEntityBulk<Health>(3000, std::make_tuple(5, 10));
+    for (const auto& meta : metas) m_entityRegistry->setSharedComponent(meta.id, Material{3, 1.0f});
+
+    auto query = m_entityRegistry->query<Health, Material>();
+    ASSERT_EQ(query.archetypes().size(), 1);
+    EXPECT_EQ(query.archetypes()[0]->componentOffsets().size(), 1);
+
+    size_t visited = 0;
+    query.forEachChunk(
+        [&](size_t _count, EntityMeta*, Health* _health, Material* _material)
+        {
+            EXPECT_EQ(_material->id, 3);
+            for (size_t i = 0; i < _count; ++i) EXPECT_EQ(_health[i].maxHp, 10);
+            visited += _count;
+        });
+    EXPECT_EQ(visited, 3000);
+}
+
+TEST_F(ECSChunkedTest, OptionalTermsAcrossChunks)
+{
+    m_entityRegistry->createEntityBulk<Health, Position>(3000, std::make_tuple(5, 10),
+                                                         std::make_tuple(1.0f, 0.0f, 0.0f));
+    m_entityRegistry->createEntityBulk<Health>(2000, std::make_tuple(5, 10));
+    m_entityRegistry->createEntityBulk<Health, Frozen>(1000, std::make_tuple(5, 10),
+                                                       std::make_tuple());
+
+    auto query = m_entityRegistry
+                     ->query<detail::Read<Health>, detail::Optional<Position>,
+                             detail::Without<Frozen>>();
+
+    size_t visited = 0;
+    float sum = 0.0f;
+    query.forEach(
+        [&](EntityMeta, const Health& _health, Position* _pos)
+        {
+            EXPECT_EQ(_health.maxHp, 10);
+            if (_pos) sum += _pos->x;
+            ++visited;
+        });
+    EXPECT_EQ(visited, 5000);
+    EXPECT_FLOAT_EQ(sum, 3000.0f);
+}
+
+TEST_F(ECSChunkedTest, SpanChunksAreAlignedColumnsInPlace)
+{
+    m_entityRegistry->createEntityBulk<Position, Velocity>(3000, std::make_tuple(0.0f, 0.0f, 0.0f),
+                                                           std::make_tuple(1.0f, 0.0f, 0.0f));
+    for (EntityID eid = 0; eid < 3000; eid += 2)
+    {
+        m_entityRegistry->setSharedComponent(eid, Material{4, 0.5f});
+    }
+
+    ThreadPerTaskPool pool;
+    std::atomic<size_t> visited = 0;
+
+    m_entityRegistry->query<Position, detail::Read<Velocity>, detail::Optional<Material>>()
+        .parallelForEachChunk(
+            pool,
+            [&](std::span<const EntityMeta> _metas, std::span<Position> _pos,
+                std::span<const Velocity> _vel, std::span<Material> _material)
+            {
+                EXPECT_EQ(reinterpret_cast<uintptr_t>(_pos.data()) % k_columnSpanAlignment, 0u);
+                EXPECT_EQ(_vel.size(), _metas.size());
+                if (!_material.empty())
+                {
+                    EXPECT_EQ(_material.size(), 1u);
+                }
+
+                for (size_t i = 0; i < _pos.size(); ++i) _pos[i].x += _vel[i].dx;
+                visited += _metas.size();
+            },
+            1024);
+
+    EXPECT_EQ(visited, 3000);
+
+    m_entityRegistry->query<Position>().forEach([](EntityMeta, Position& _pos)
+                                                { EXPECT_FLOAT_EQ(_pos.x, 1.0f); });
+}
+
+TEST_F(ECSChunkedTest, SnapshotLoadsIntoInterleavedRegistry)
+{
+    for (int i = 0; i < 3000; ++i)
+    {
+        m_entityRegistry->createEntity<Position, Health>(
+            std::make_tuple(static_cast<float>(i), 0.0f, 0.0f), std::make_tuple(i, i));
+    }
+
+    std::vector<uint8_t> bytes;
+    m_entityRegistry->writeSnapshot(bytes);
+
+    EntityRegistry loaded(m_compRegistry.get());
+    loaded.readSnapshot(bytes);
+
+    auto components = loaded.getComponentsForEntity<Position, Health>(2999);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).x, 2999.0f);
+    EXPECT_EQ(std::get<1>(*components).hp, 2999);
+    EXPECT_FALSE(loaded.getArchetypeForEntity(0)->isChunked());
+}
+
+TEST_F(ECSChunkedTest, GroupBySortsAcrossChunks)
+{
+    for (int i = 0; i < 3000; ++i)
+    {
+        m_entityRegistry->createEntity<Health, Position>(
+            std::make_tuple((i * 7919) % 3000, i), std::make_tuple(static_cast<float>(i), 0.0f,
+                                                                   0.0f));
+    }
+
+    m_entityRegistry->groupBy<Health>([](const Health& _a, const Health& _b)
+                                      { return _a.hp > _b.hp; });
+    m_entityRegistry->advanceTick();
+
+    m_entityRegistry->markChanged<Health>(1234);
+    std::get<0>(*m_entityRegistry->getComponentsForEntity<Health>(1234)).hp = 5000;
+    m_entityRegistry->updateGroups();
+
+    const std::vector<int> values = hpInViewOrder(*m_entityRegistry);
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end(), std::greater<>()));
+    EXPECT_EQ(values.front(), 5000);
+
+    for (EntityID id = 0; id < 3000; ++id)
+    {
+        auto components = m_entityRegistry->getComponentsForEntity<Health, Position>(id);
+        EXPECT_EQ(std::get<1>(*components).x, static_cast<float>(std::get<0>(*components).maxHp));
+    }
+}
+
+TEST_F(ECSChunkedTest, CompactFreesUnusedChunks)
+{
+    std::vector<EntityMeta> metas;
+    for (int i = 0; i < 5000; ++i)
+    {
+        metas.push_back(m_entityRegistry->createEntity<Health>(std::make_tuple(i, 100)));
+    }
+
+    auto* arch = m_entityRegistry->getArchetypeForEntity(metas[0].id);
+    ASSERT_NE(arch, nullptr);
+    const size_t usageBefore = arch->memoryUsageInBytes();
+
+    for (int i = 10; i < 5000; ++i) m_entityRegistry->destroyEntity(metas[i].id);
+
+    const CompactionResult result = m_entityRegistry->compact();
+    EXPECT_TRUE(result.finished);
+    EXPECT_GT(result.bytesReclaimed, 0);
+    EXPECT_LT(arch->memoryUsageInBytes(), usageBefore);
+    EXPECT_EQ(arch->chunkCount(), 1);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        auto health = m_entityRegistry->getComponentsForEntity<Health>(metas[i].id);
+        ASSERT_TRUE(health.has_value());
+        EXPECT_EQ(std::get<0>(*health).hp, i);
+    }
+
+    // the archetype grows back after compaction
+    auto more = m_entityRegistry->createEntityBulk<Health>(3000, std::make_tuple(1, 1));
+    EXPECT_EQ(m_entityRegistry->getArchetypeForEntity(more.back().id), arch);
+    EXPECT_EQ(arch->size(), 3010);
+}
+
+TEST_F(ECSChunkedTest, AddAndRemoveComponentsPreserveData)
+{
+    auto meta = m_entityRegistry->createEntity<Position>(std::make_tuple(1.0f, 2.0f, 3.0f));
+
+    m_entityRegistry->addComponents<Velocity>(meta.id, std::make_tuple(4.0f, 5.0f, 6.0f));
+    m_entityRegistry->removeComponents<Position>(meta.id);
+
+    EXPECT_FALSE(m_entityRegistry->getComponentsForEntity<Position>(meta.id).has_value());
+
+    auto result = m_entityRegistry->getComponentsForEntity<Velocity>(meta.id);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(result.value()).dz, 6.0f);
+    EXPECT_TRUE(m_entityRegistry->isEntityValid(meta));
+}
+
+TEST_F(ECSChunkedTest, BulkMigrationPreservesData)
+{
+    auto metas =
+        m_entityRegistry->createEntityBulk<Position>(1000, std::make_tuple(7.0f, 8.0f, 9.0f));
+
+    size_t migrated = m_entityRegistry->migrateArchetypeModifyComponents(
+        detail::From<Position>{}, detail::Add<Health>{}, detail::Remove<>{});
+
+    EXPECT_EQ(migrated, 1000);
+
+    for (const auto& meta : metas)
+    {
+        auto result = m_entityRegistry->getComponentsForEntity<Position, Health>(meta.id);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_FLOAT_EQ(std::get<0>(result.value()).y, 8.0f);
+    }
+}
+
+TEST_F(ECSChunkedTest, ForEachChunkProvidesContiguousColumns)
+{
+    m_entityRegistry->createEntityBulk<Position, Velocity>(2000,
+                                                           std::make_tuple(1.0f, 1.0f, 1.0f),
+                                                           std::make_tuple(2.0f, 2.0f, 2.0f));
+
+    auto view = m_entityRegistry->viewSubset<Position, Velocity>();
+    ASSERT_TRUE(view.has_value());
+
+    size_t visited = 0;
+    size_t runs = 0;
+    view->forEachChunk(
+        [&](size_t _count, EntityMeta*, Position* _pos, Velocity* _vel)
+        {
+            for (size_t i = 0; i < _count; ++i) _pos[i].x += _vel[i].dx;
+            visited += _count;
+            ++runs;
+        });
+
+    EXPECT_EQ(visited, 2000);
+    EXPECT_LT(runs, visited);
+
+    size_t checked = 0;
+    for (auto [meta, components] : *view)
+    {
+        EXPECT_FLOAT_EQ(std::get<0>(components).x, 3.0f);
+        ++checked;
+    }
+
+    EXPECT_EQ(checked, 2000);
+}
+
+TEST_F(ECSChunkedTest, ParallelForEachChunkDispatchesWholeChunks)
+{
+    m_entityRegistry->createEntityBulk<Position, Velocity>(5000,
+                                                           std::make_tuple(1.0f, 1.0f, 1.0f),
+                                                           std::make_tuple(2.0f, 2.0f, 2.0f));
+
+    auto query = m_entityRegistry->query<Position, Velocity>();
+    Archetype* arch = query.archetypes()[0];
+    ASSERT_GT(arch->chunkCount(), 1);
+
+    ThreadPerTaskPool pool;
+    std::atomic<size_t> visited = 0;
+
+    // A grain smaller than a chunk still dispatches one whole chunk per task
+    query.parallelForEachChunk(pool,
+                               [&](size_t _count, EntityMeta*, Position* _pos, Velocity* _vel)
+                               {
+                                   for (size_t i = 0; i < _count; ++i) _pos[i].x += _vel[i].dx;
+                                   visited += _count;
+                               },
+                               1);
+
+    EXPECT_EQ(visited, 5000);
+    EXPECT_EQ(pool.dispatched, arch->chunkCount() - 1);
+
+    query.forEach([](EntityMeta, Position& _pos, Velocity&) { EXPECT_FLOAT_EQ(_pos.x, 3.0f); });
+}
+
+TEST_F(ECSChunkedTest, ChangedFilterSkipsUntouchedChunks)
+{
+    auto metas = m_entityRegistry->createEntityBulk<Position, Velocity>(5000);
+    auto query = m_entityRegistry->query<Position, Velocity>();
+    Archetype* arch = query.archetypes()[0];
+
+    const uint32_t since = m_entityRegistry->advanceTick();
+    m_entityRegistry->markChanged<Velocity>(metas.back().id);
+
+    size_t runs = 0;
+    size_t visited = 0;
+    query.forEachChunk(detail::Changed<Velocity>{}, since,
+                       [&](size_t _count, EntityMeta*, Position*, Velocity*)
+                       {
+                           ++runs;
+                           visited += _count;
+                       });
+
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(visited, arch->chunkSize(arch->chunkCount() - 1));
+
+    // the filtered iteration stamped both components of the chunk it visited
+    visited = 0;
+    query.view().readOnly().forEach(detail::Changed<Position>{}, since,
+                                    [&](EntityMeta, Position&, Velocity&) { ++visited; });
+    EXPECT_EQ(visited, arch->chunkSize(arch->chunkCount() - 1));
+}
+
+TEST_F(ECSTest, AdaptiveArchetypesSplitIntoChunksPastThreshold)
+{
+    EntityRegistry registry(m_compRegistry.get(), ArchetypeStorageMode::adaptive, 4096);
+
+    const EntityMeta first =
+        registry.createEntity<Position, Velocity>(std::make_tuple(0.0f, 0.0f, 0.0f),
+                                                  std::make_tuple(0.0f, 0.0f, 0.0f));
+    Archetype* arch = registry.getArchetypeForEntity(first.id);
+    const size_t splitRows = 4096 / arch->stride();
+
+    for (size_t i = 1; i < splitRows; ++i)
+    {
+        const float f = static_cast<float>(i);
+        registry.createEntity<Position, Velocity>(std::make_tuple(f, f, f),
+                                                  std::make_tuple(-f, 0.0f, 0.0f));
+    }
+    EXPECT_FALSE(arch->isChunked());
+
+    const uint32_t since = registry.advanceTick();
+    registry.markChanged<Velocity>(first.id);
+
+    // Bulk creation past the threshold moves the existing rows to chunks first
+    registry.createEntityBulk<Position, Velocity>(3000, std::make_tuple(1.0f, 2.0f, 3.0f),
+                                                  std::make_tuple(0.0f, 0.0f, 0.0f));
+    ASSERT_TRUE(arch->isChunked());
+    EXPECT_GT(arch->chunkCount(), 1);
+    EXPECT_EQ(arch->size(), splitRows + 3000);
+
+    for (size_t i = 0; i < splitRows; ++i)
+    {
+        auto components = registry.getComponentsForEntity<Position, Velocity>(i);
+        ASSERT_TRUE(components.has_value());
+        EXPECT_FLOAT_EQ(std::get<0>(*components).y, static_cast<float>(i));
+        EXPECT_FLOAT_EQ(std::get<1>(*components).dx, -static_cast<float>(i));
+    }
+
+    // The write made before the split is still seen through the chunk ticks
+    bool sawFirst = false;
+    registry.query<Position, Velocity>().view().readOnly().forEach(
+        detail::Changed<Velocity>{}, since,
+        [&](EntityMeta _meta, Position&, Velocity&) { sawFirst |= _meta.id == first.id; });
+    EXPECT_TRUE(sawFirst);
+
+    // Growing further allocates chunks, the existing ones stay in place
+    uint8_t* column = arch->chunkColumn(0, m_compRegistry->getID<Position>());
+    registry.createEntityBulk<Position, Velocity>(5000);
+    EXPECT_EQ(arch->chunkColumn(0, m_compRegistry->getID<Position>()), column);
+}
+
+TEST_F(ECSTest, AdaptiveArchetypesSplitWhenEntitiesMoveIn)
+{
+    EntityRegistry registry(m_compRegistry.get(), ArchetypeStorageMode::adaptive, 2048);
+
+    auto metas = registry.createEntityBulk<Position>(500, std::make_tuple(4.0f, 5.0f, 6.0f));
+    for (const EntityMeta& meta : metas)
+    {
+        registry.addComponents<Velocity>(meta.id, std::make_tuple(1.0f, 0.0f, 0.0f));
+    }
+
+    Archetype* arch = registry.getArchetypeForEntity(metas[0].id);
+    EXPECT_TRUE(arch->isChunked());
+
+    size_t visited = 0;
+    registry.query<Position, Velocity>().forEach(
+        [&](EntityMeta, Position& _pos, Velocity& _vel)
+        {
+            EXPECT_FLOAT_EQ(_pos.z, 6.0f);
+            EXPECT_FLOAT_EQ(_vel.dx, 1.0f);
+            ++visited;
+        });
+    EXPECT_EQ(visited, 500);
+
+    // Small archetypes never split
+    const EntityMeta lone = registry.createEntity<Health>();
+    EXPECT_FALSE(registry.getArchetypeForEntity(lone.id)->isChunked());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dynamic Component Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The layout a script would declare for a dynamic component (16 bytes, 8-aligned).
+struct ScriptState
+{
+    double energy;
+    uint32_t flags;
+};
+
+TEST_F(ECSTest, DynamicComponentsShareArchetypesWithNativeOnes)
+{
+    const ComponentID stateID = m_compRegistry->registerDynamicComponent("ScriptState", 16, 8);
+    const ComponentID markerID = m_compRegistry->registerDynamicComponent("ScriptMarker", 0, 1);
+    EXPECT_THROW(m_compRegistry->registerDynamicComponent("Bad", 8, 3), std::invalid_argument);
+
+    const std::array<ComponentID, 2> ids{m_compRegistry->getID<Position>(), stateID};
+    const EntityMeta meta = m_entityRegistry->createEntity(ids);
+
+    ASSERT_TRUE(m_entityRegistry->hasComponent(meta.id, stateID));
+    ScriptState state{};
+    std::memcpy(&state, m_entityRegistry->getComponent(meta.id, stateID), sizeof(state));
+    EXPECT_EQ(state.energy, 0.0);
+
+    // Native access keeps working on the same archetype
+    std::get<0>(*m_entityRegistry->getComponentsForEntity<Position>(meta.id)).x = 3.0f;
+
+    size_t added = 0;
+    m_entityRegistry->observe(markerID, ComponentEvent::added,
+                              [&](std::span<const EntityID> _eids) { added += _eids.size(); });
+    m_entityRegistry->addComponent(meta.id, markerID);
+    m_entityRegistry->addComponent(meta.id, markerID);
+    EXPECT_EQ(added, 1);
+    EXPECT_TRUE(m_entityRegistry->hasComponent(meta.id, markerID));
+    EXPECT_EQ(m_entityRegistry->getComponent(meta.id, markerID), nullptr);
+
+    const EntityID other = m_entityRegistry->createEntity<Velocity>().id;
+    const ScriptState value{2.5, 7};
+    m_entityRegistry->addComponent(other, stateID, &value);
+    std::memcpy(&state, m_entityRegistry->getComponent(other, stateID), sizeof(state));
+    EXPECT_EQ(state.energy, 2.5);
+    EXPECT_EQ(state.flags, 7);
+
+    m_entityRegistry->removeComponent(meta.id, stateID);
+    EXPECT_FALSE(m_entityRegistry->hasComponent(meta.id, stateID));
+    EXPECT_EQ(m_entityRegistry->getComponent(meta.id, stateID), nullptr);
+    EXPECT_FLOAT_EQ(std::get<0>(*m_entityRegistry->getComponentsForEntity<Position>(meta.id)).x,
+                    3.0f);
+
+    EXPECT_THROW(m_entityRegistry->addComponent(meta.id, 63), std::runtime_error);
+}
+
+TEST_F(ECSTest, ForEachRawChunkWalksInterleavedRows)
+{
+    const ComponentID stateID = m_compRegistry->registerDynamicComponent("ScriptState", 16, 8);
+    const ComponentID posID = m_compRegistry->getID<Position>();
+
+    for (int i = 0; i < 100; ++i)
+    {
+        const EntityMeta meta =
+            m_entityRegistry->createEntity<Position>(std::make_tuple(1.0f, 0.0f, 0.0f));
+        m_entityRegistry->addComponent(meta.id, stateID);
+    }
+    m_entityRegistry->createEntityBulk<Position>(10);
+    const uint32_t since = m_entityRegistry->advanceTick();
+
+    const std::array<ComponentID, 2> ids{stateID, posID};
+    size_t visited = 0;
+    m_entityRegistry->forEachRawChunk(
+        ids,
+        [&](size_t _count, RawColumn _metas, std::span<const RawColumn> _columns)
+        {
+            ASSERT_EQ(_columns.size(), 2);
+            EXPECT_EQ(_columns[0].stride, _metas.stride);
+            for (size_t i = 0; i < _count; ++i)
+            {
+                auto* state = reinterpret_cast<ScriptState*>(_columns[0][i]);
+                state->energy += reinterpret_cast<const Position*>(_columns[1][i])->x;
+            }
+            visited += _count;
+        });
+    EXPECT_EQ(visited, 100);
+
+    size_t energized = 0;
+    m_entityRegistry->forEachRawChunk(
+        std::span<const ComponentID>(&stateID, 1),
+        [&](size_t _count, RawColumn, std::span<const RawColumn> _columns)
+        {
+            for (size_t i = 0; i < _count; ++i)
+            {
+                energized += reinterpret_cast<ScriptState*>(_columns[0][i])->energy == 1.0;
+            }
+        });
+    EXPECT_EQ(energized, 100);
+
+    // Every listed component is stamped over the visited archetypes only
+    size_t changed = 0;
+    m_entityRegistry->query<Position>().view().readOnly().forEach(
+        detail::Changed<Position>{}, since, [&](EntityMeta, Position&) { ++changed; });
+    EXPECT_EQ(changed, 100);
+}
+
+TEST_F(ECSChunkedTest, ForEachRawChunkWalksChunkColumns)
+{
+    const ComponentID stateID = m_compRegistry->registerDynamicComponent("ScriptState", 16, 8);
+    const std::array<ComponentID, 3> ids{stateID, m_compRegistry->getID<Frozen>(),
+                                         m_compRegistry->getID<Material>()};
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        const EntityMeta meta = m_entityRegistry->createEntity(std::span(ids).first(2));
+        m_entityRegistry->setSharedComponent(meta.id, Material{4, 0.5f});
+    }
+
+    size_t chunks = 0;
+    size_t visited = 0;
+    m_entityRegistry->forEachRawChunk(
+        ids,
+        [&](size_t _count, RawColumn _metas, std::span<const RawColumn> _columns)
+        {
+            EXPECT_EQ(_columns[0].stride, 16);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_columns[0].data) % 8, 0);
+            EXPECT_EQ(_columns[1].data, nullptr);
+            EXPECT_EQ(_columns[2].stride, 0);
+            EXPECT_EQ(reinterpret_cast<const Material*>(_columns[2].data)->id, 4);
+
+            for (size_t i = 0; i < _count; ++i)
+            {
+                const EntityID eid = reinterpret_cast<const EntityMeta*>(_metas[i])->id;
+                EXPECT_EQ(m_entityRegistry->getComponent(eid, stateID), _columns[0][i]);
+            }
+            visited += _count;
+            ++chunks;
+        });
+    EXPECT_EQ(visited, 3000);
+    EXPECT_GT(chunks, 1);
+}
+
+TEST_F(ECSTest, ForEachChunkOnInterleavedArchetypeVisitsSingleEntityRuns)
+{
+    for (int i = 0; i < 10; ++i) m_entityRegistry->createEntity<Position>();
+
+    auto view = m_entityRegistry->viewSubset<Position>();
+    ASSERT_TRUE(view.has_value());
+
+    size_t visited = 0;
+    view->forEachChunk(
+        [&](size_t _count, EntityMeta*, Position*)
+        {
+            EXPECT_EQ(_count, 1);
+            visited += _count;
+        });
+
+    EXPECT_EQ(visited, 10);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// World Set Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, WorldsAreUpdatedInParallelAndStayIndependent)
+{
+    WorldSet worlds(m_compRegistry.get(), ArchetypeStorageMode::chunked);
+    for (int i = 0; i < 8; ++i) worlds.createWorld();
+
+    ThreadPerTaskPool pool;
+    worlds.parallelForEach(pool,
+                           [](World& _world)
+                           {
+                               EntityRegistry& registry = _world.registry();
+                               const size_t count = 1000 * (_world.id() + 1);
+
+                               registry.createEntityBulk<Position, Velocity>(count);
+                               registry.query<Position, Velocity>().forEach(
+                                   [&](EntityMeta, Position& _pos, Velocity&)
+                                   { _pos.x = static_cast<float>(_world.id()); });
+                           });
+    EXPECT_EQ(pool.dispatched.load(), 7);
+
+    worlds.forEach(
+        [](World& _world)
+        {
+            size_t visited = 0;
+            _world.registry().query<Position>().forEach(
+                [&](EntityMeta, Position& _pos)
+                {
+                    EXPECT_FLOAT_EQ(_pos.x, static_cast<float>(_world.id()));
+                    ++visited;
+                });
+            EXPECT_EQ(visited, 1000 * (_world.id() + 1));
+            EXPECT_GT(_world.chunkArena().reservedBytes(), 0);
+        });
+
+    // Chunks freed by a world are recycled by its own arena
+    World* world = worlds.findWorld(3);
+    ASSERT_NE(world, nullptr);
+    world->registry().clear();
+    EXPECT_EQ(world->chunkArena().freeBytes(), world->chunkArena().reservedBytes());
+    EXPECT_GT(world->releaseMemory(), 0);
+    EXPECT_EQ(world->chunkArena().reservedBytes(), 0);
+
+    EXPECT_TRUE(worlds.destroyWorld(3));
+    EXPECT_FALSE(worlds.destroyWorld(3));
+    EXPECT_EQ(worlds.findWorld(3), nullptr);
+    EXPECT_EQ(worlds.createWorld().id(), 8);
+}
+
+TEST_F(ECSTest, WorldSetRethrowsAfterJoiningEveryWorld)
+{
+    WorldSet worlds(m_compRegistry.get());
+    for (int i = 0; i < 4; ++i) worlds.createWorld();
+
+    ThreadPerTaskPool pool;
+    std::atomic<size_t> updated = 0;
+    EXPECT_THROW(worlds.parallelForEach(pool,
+                                        [&](World& _world)
+                                        {
+                                            _world.registry().createEntity<Position>();
+                                            ++updated;
+                                            if (_world.id() == 2) throw std::runtime_error("boom");
+                                        }),
+                 std::runtime_error);
+    EXPECT_EQ(updated.load(), 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sparse Component Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct Selected
+{
+};
+
+struct InCombat
+{
+    float timer;
+};
+
+TEST_F(ECSTest, SparseComponentsToggleWithoutMovingRows)
+{
+    const ComponentID selectedID = m_compRegistry->registerSparseComponent<Selected>("Selected");
+    m_compRegistry->registerSparseComponent<InCombat>("InCombat");
+    EXPECT_THROW(m_compRegistry->registerSparseComponent<Position>(), std::runtime_error);
+
+    const EntityID eid = m_entityRegistry->createEntity<Position>().id;
+    const Archetype* arch = m_entityRegistry->getArchetypeForEntity(eid);
+
+    ASSERT_NE(m_entityRegistry->addSparseComponent<InCombat>(eid, 2.5f), nullptr);
+    EXPECT_NE(m_entityRegistry->addSparseComponent<Selected>(eid), nullptr);
+    EXPECT_EQ(m_entityRegistry->getArchetypeForEntity(eid), arch);
+    EXPECT_FLOAT_EQ(m_entityRegistry->getSparseComponent<InCombat>(eid)->timer, 2.5f);
+    EXPECT_TRUE(m_entityRegistry->hasComponent(eid, selectedID));
+
+    EXPECT_TRUE(m_entityRegistry->removeSparseComponent<Selected>(eid));
+    EXPECT_FALSE(m_entityRegistry->removeSparseComponent<Selected>(eid));
+    EXPECT_FALSE(m_entityRegistry->hasSparseComponent<Selected>(eid));
+    EXPECT_EQ(m_entityRegistry->getArchetypeForEntity(eid), arch);
+
+    // Sparse components never enter archetypes
+    EXPECT_THROW(m_entityRegistry->addComponents<Selected>(eid), std::runtime_error);
+    EXPECT_THROW(m_entityRegistry->addSparseComponent<Velocity>(eid), std::runtime_error);
+
+    m_entityRegistry->destroyEntity(eid);
+    EXPECT_EQ(m_entityRegistry->sparseComponentCount<InCombat>(), 0);
+}
+
+TEST_F(ECSTest, QueriesJoinSparseComponentsByProbing)
+{
+    m_compRegistry->registerSparseComponent<Selected>("Selected");
+    m_compRegistry->registerSparseComponent<InCombat>("InCombat");
+
+    const auto metas = m_entityRegistry->createEntityBulk<Position>(10);
+    for (size_t i = 0; i < metas.size(); ++i)
+    {
+        if (i % 2 == 0) m_entityRegistry->addSparseComponent<Selected>(metas[i].id);
+        if (i % 3 == 0) m_entityRegistry->addSparseComponent<InCombat>(metas[i].id, float(i));
+    }
+
+    auto selected = m_entityRegistry->query<Position, detail::With<Selected>, detail::Optional<InCombat>>();
+    EXPECT_EQ(selected.entityCount(), 5);
+
+    size_t visited = 0;
+    size_t inCombat = 0;
+    selected.forEach(
+        [&](EntityMeta _meta, Position&, InCombat* _combat)
+        {
+            EXPECT_EQ(_meta.id % 2, 0);
+            if (_combat)
+            {
+                EXPECT_FLOAT_EQ(_combat->timer, static_cast<float>(_meta.id));
+                ++inCombat;
+            }
+            ++visited;
+        });
+    EXPECT_EQ(visited, 5);
+    EXPECT_EQ(inCombat, 2); // 0 and 6
+
+    // Written sparse terms are fetched in place
+    m_entityRegistry->query<InCombat, detail::Without<Selected>>().forEach(
+        [](EntityMeta, InCombat& _combat) { _combat.timer = -1.0f; });
+    EXPECT_FLOAT_EQ(m_entityRegistry->getSparseComponent<InCombat>(metas[3].id)->timer, -1.0f);
+    EXPECT_FLOAT_EQ(m_entityRegistry->getSparseComponent<InCombat>(metas[6].id)->timer, 6.0f);
+
+    // Pointer chunks come as runs of one entity, span chunks cannot join
+    size_t runs = 0;
+    selected.forEachChunk([&](size_t _count, EntityMeta*, Position*, InCombat*)
+                          { runs += _count == 1; });
+    EXPECT_EQ(runs, 5);
+    EXPECT_THROW(selected.forEachChunk([](std::span<const EntityMeta>, std::span<Position>,
+                                          std::span<InCombat>) {}),
+                 std::logic_error);
+
+    // Toggling is picked up by the next iteration
+    m_entityRegistry->removeSparseComponent<Selected>(metas[0].id);
+    EXPECT_EQ(selected.entityCount(), 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static Archetype Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, StaticArchetypesUseTheCompileTimeLayout)
+{
+    using Layout = detail::StaticLayout<Health, Frozen, Position>;
+    static_assert(Layout::k_offsetOf<Health> == sizeof(EntityMeta));
+    static_assert(Layout::k_stride == Layout::k_offsetOf<Position> + sizeof(Position));
+
+    auto units = m_entityRegistry->registerStaticArchetype<Health, Frozen, Position>();
+    EXPECT_EQ(units.archetype(), nullptr);
+
+    // Created through the usual API, in any order
+    m_entityRegistry->createEntityBulk<Position, Health, Frozen>(100);
+    m_entityRegistry->createEntity<Position, Health>(); // another archetype
+
+    int next = 0;
+    m_entityRegistry->query<Position, Health, detail::With<Frozen>>().forEach(
+        [&](EntityMeta, Position& _pos, Health& _health)
+        {
+            _pos.x = static_cast<float>(next);
+            _health.hp = next++;
+        });
+
+    const Archetype* arch = units.archetype();
+    ASSERT_NE(arch, nullptr);
+    EXPECT_EQ(arch->stride(), Layout::k_stride);
+    EXPECT_EQ(arch->componentOffsets().at(m_compRegistry->getID<Position>()),
+              Layout::k_offsetOf<Position>);
+    EXPECT_EQ(units.size(), 100);
+
+    units.forEach([](EntityMeta, Health& _health, Frozen&, Position& _pos)
+                  { _pos.y = static_cast<float>(_health.hp) * 2.0f; });
+
+    // Dynamic queries and edges see the same rows
+    size_t matched = 0;
+    m_entityRegistry->query<detail::Read<Position>, detail::With<Frozen>>().forEach(
+        [&](EntityMeta, const Position& _pos)
+        {
+            EXPECT_FLOAT_EQ(_pos.y, _pos.x * 2.0f);
+            ++matched;
+        });
+    EXPECT_EQ(matched, 100);
+
+    const EntityID moved = arch->entityIDs().front();
+    m_entityRegistry->addComponents<Velocity>(moved);
+    m_entityRegistry->removeComponents<Velocity>(moved);
+    EXPECT_EQ(m_entityRegistry->getArchetypeForEntity(moved), arch);
+
+    auto components = m_entityRegistry->getComponentsForEntity<Position, Health>(moved);
+    ASSERT_TRUE(components.has_value());
+    EXPECT_FLOAT_EQ(std::get<0>(*components).y, std::get<1>(*components).hp * 2.0f);
+
+    // The layout outlives the archetype
+    m_entityRegistry->clear();
+    m_entityRegistry->createEntity<Frozen, Position, Health>();
+    EXPECT_EQ(units.archetype()->stride(), Layout::k_stride);
+}
+
+TEST_F(ECSChunkedTest, StaticArchetypesWalkChunkColumnsAndRejectLateRegistration)
+{
+    m_entityRegistry->createEntityBulk<Position, Velocity>(3000);
+    EXPECT_THROW((m_entityRegistry->registerStaticArchetype<Velocity, Position>()),
+                 std::runtime_error);
+
+    auto moving = m_entityRegistry->registerStaticArchetype<Velocity, Health>();
+    EXPECT_THROW((m_entityRegistry->registerStaticArchetype<Health, Velocity>()),
+                 std::runtime_error);
+    m_entityRegistry->createEntityBulk<Health, Velocity>(3000);
+
+    size_t visited = 0;
+    moving.forEach(
+        [&](EntityMeta, Velocity& _vel, Health& _health)
+        {
+            _vel.dx = 1.0f;
+            _health.hp = 7;
+            ++visited;
+        });
+    EXPECT_EQ(visited, 3000);
+    EXPECT_GT(moving.archetype()->chunkCount(), 1);
+
+    m_entityRegistry->query<detail::Read<Health>>().forEach(
+        [](EntityMeta, const Health& _health) { EXPECT_EQ(_health.hp, 7); });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Relation Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct Targets
+{
+};
+
+struct ChildOf
+{
+};
+
+TEST_F(ECSTest, RelationsAreIndexedBothWays)
+{
+    m_entityRegistry->registerRelation<Targets>();
+
+    const EntityID target = m_entityRegistry->createEntity<Position>().id;
+    const EntityID a = m_entityRegistry->createEntity<Position>().id;
+    const EntityID b = m_entityRegistry->createEntity<Velocity>().id;
+
+    EXPECT_TRUE(m_entityRegistry->addRelation<Targets>(a, target));
+    EXPECT_TRUE(m_entityRegistry->addRelation<Targets>(b, target));
+    EXPECT_FALSE(m_entityRegistry->addRelation<Targets>(b, target));
+    EXPECT_TRUE(m_entityRegistry->addRelation<Targets>(a, b));
+
+    std::vector<EntityID> sources(m_entityRegistry->relationSources<Targets>(target).begin(),
+                                  m_entityRegistry->relationSources<Targets>(target).end());
+    std::ranges::sort(sources);
+    EXPECT_EQ(sources, (std::vector<EntityID>{a, b}));
+    EXPECT_EQ(m_entityRegistry->relationTargets<Targets>(a).size(), 2);
+    EXPECT_EQ(m_entityRegistry->relationCount<Targets>(), 3);
+
+    EXPECT_TRUE(m_entityRegistry->removeRelation<Targets>(a, b));
+    EXPECT_FALSE(m_entityRegistry->hasRelation<Targets>(a, b));
+
+    // Destroying the target drops the pairs, the sources live on
+    m_entityRegistry->destroyEntity(target);
+    EXPECT_EQ(m_entityRegistry->entityCount(), 2);
+    EXPECT_TRUE(m_entityRegistry->relationTargets<Targets>(a).empty());
+    EXPECT_TRUE(m_entityRegistry->relationSources<Targets>(target).empty());
+    EXPECT_EQ(m_entityRegistry->relationCount<Targets>(), 0);
+
+    EXPECT_THROW(m_entityRegistry->addRelation<ChildOf>(a, b), std::runtime_error);
+}
+
+TEST_F(ECSTest, DestroyingTargetsCascadesToSourcesInOneBatch)
+{
+    m_entityRegistry->registerRelation<ChildOf>({RelationCleanup::destroySource, true});
+
+    std::vector<EntityID> removed;
+    m_entityRegistry->observe<Position>(
+        ComponentEvent::removed, [&](std::span<const EntityID> _eids)
+        { removed.insert(removed.end(), _eids.begin(), _eids.end()); });
+
+    // root -> {child0, child1}, child0 -> grandchild, other stays unrelated
+    const EntityID root = m_entityRegistry->createEntity<Position>().id;
+    const EntityID child0 = m_entityRegistry->createEntity<Position>().id;
+    const EntityID child1 = m_entityRegistry->createEntity<Position, Velocity>().id;
+    const EntityID grandchild = m_entityRegistry->createEntity<Position>().id;
+    const EntityID other = m_entityRegistry->createEntity<Position>().id;
+
+    m_entityRegistry->addRelation<ChildOf>(child0, root);
+    m_entityRegistry->addRelation<ChildOf>(child1, other);
+    m_entityRegistry->addRelation<ChildOf>(child1, root); // exclusive, replaces the parent
+    m_entityRegistry->addRelation<ChildOf>(grandchild, child0);
+
+    EXPECT_TRUE(m_entityRegistry->relationSources<ChildOf>(other).empty());
+    ASSERT_EQ(m_entityRegistry->relationTargets<ChildOf>(child1).size(), 1);
+    EXPECT_EQ(m_entityRegistry->relationTargets<ChildOf>(child1)[0], root);
+
+    const std::vector<EntityID> notFound = m_entityRegistry->destroyEntityBulk({root, 12345});
+    EXPECT_EQ(notFound, (std::vector<EntityID>{12345}));
+
+    // The whole subtree went in the batch observers saw
+    std::ranges::sort(removed);
+    std::vector<EntityID> expected{root, child0, child1, grandchild};
+    std::ranges::sort(expected);
+    EXPECT_EQ(removed, expected);
+
+    EXPECT_EQ(m_entityRegistry->entityCount(), 1);
+    EXPECT_EQ(m_entityRegistry->relationCount<ChildOf>(), 0);
+    EXPECT_FALSE(m_entityRegistry->getComponentsForEntity<Position>(grandchild).has_value());
+    EXPECT_TRUE(m_entityRegistry->getComponentsForEntity<Position>(other).has_value());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Storage Allocator Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ECSTest, InterleavedRowsComeFromTheStorageAllocator)
+{
+    PageStorageAllocator allocator({.largePages = false, .minPageAllocation = 4096});
+    EntityRegistry registry(m_compRegistry.get(), ArchetypeStorageMode::interleaved,
+                            Archetype::k_defaultSplitThresholdInBytes, nullptr, &allocator);
+
+    registry.createEntityBulk<Position, Velocity>(10000);
+    registry.query<Position>().forEach([](EntityMeta _meta, Position& _pos)
+                                       { _pos.x = static_cast<float>(_meta.id); });
+
+    // The row array outgrew the heap threshold and was moved to mapped pages with its rows
+    EXPECT_GT(allocator.mappedBytes(), 0);
+
+    size_t visited = 0;
+    registry.query<Position>().forEach(
+        [&](EntityMeta _meta, Position& _pos)
+        {
+            EXPECT_FLOAT_EQ(_pos.x, static_cast<float>(_meta.id));
+            ++visited;
+        });
+    EXPECT_EQ(visited, 10000);
+
+    registry.clear();
+    registry.compact();
+    EXPECT_EQ(allocator.mappedBytes(), 0);
+}
+
+TEST_F(ECSTest, WorldArenasAllocateSlabsFromTheStorageAllocator)
+{
+    PageStorageAllocator allocator;
+
+    WorldSet worlds(m_compRegistry.get(), ArchetypeStorageMode::chunked);
+    worlds.setStorageAllocator(&allocator);
+
+    World& world = worlds.createWorld();
+    world.registry().createEntityBulk<Position, Velocity>(5000);
+
+    // Slabs are rounded up to whole (large) pages and every byte of them is mapped
+    EXPECT_EQ(world.chunkArena().reservedBytes() % allocator.granularity(), 0);
+    EXPECT_GE(allocator.mappedBytes(), world.chunkArena().reservedBytes());
+    EXPECT_LE(allocator.largePageBytes(), allocator.mappedBytes());
+
+    world.registry().clear();
+    world.releaseMemory();
+    EXPECT_EQ(allocator.mappedBytes(), 0);
+}
+
+TEST_F(ECSTest, EditMessagesAreRecordedAndChangesStreamedBack)
+{
+    const ComponentID posID = m_compRegistry->getID<Position>();
+    const ComponentID healthID = m_compRegistry->getID<Health>();
+    const uint32_t schema = editSchemaHash(*m_compRegistry);
+
+    const auto entities = m_entityRegistry->createEntityBulk<Position>(200);
+    const EntityMeta stale = entities[199];
+    m_entityRegistry->destroyEntity(stale.id);
+    const uint32_t since = m_entityRegistry->advanceTick();
+
+    // A drag over the first 100 entities, a stale handle and a component added with its value
+    std::vector<uint8_t> edits;
+    EditMessageWriter writer(edits, EditMessageKind::edits, schema, 1);
+    const std::vector<Position> dragged(100, Position{5.0f, 6.0f, 7.0f});
+    writer.setComponents(posID, {entities.data(), 100}, dragged.data(), sizeof(Position));
+    writer.setComponent(stale, posID,
+                        {reinterpret_cast<const uint8_t*>(&dragged[0]), sizeof(Position)});
+    const Health health{7, 10};
+    writer.addComponent(entities[150], healthID,
+                        {reinterpret_cast<const uint8_t*>(&health), sizeof(health)});
+    writer.destroyEntities({&entities[198], 1});
+    EXPECT_EQ(writer.commandCount(), 4);
+
+    EntityCommandBuffer commands;
+    EXPECT_EQ(recordEditMessage(edits, *m_entityRegistry, *m_compRegistry, commands), 102);
+    commands.playback(*m_entityRegistry);
+
+    EXPECT_FLOAT_EQ(std::get<0>(*m_entityRegistry->getComponentsForEntity<Position>(
+                                    entities[42].id)).z,
+                    7.0f);
+    EXPECT_EQ(std::get<0>(*m_entityRegistry->getComponentsForEntity<Health>(entities[150].id)).hp,
+              7);
+    EXPECT_FALSE(m_entityRegistry->isEntityValid(entities[198]));
+
+    // The written blocks come back, the untouched ones do not
+    std::vector<uint8_t> changes;
+    const size_t sent = writeEditChanges(*m_entityRegistry, *m_compRegistry, {&posID, 1}, since,
+                                         1, changes);
+    EXPECT_GE(sent, 100);
+    EXPECT_LT(sent, 197);
+
+    std::vector<uint8_t> none;
+    EXPECT_EQ(writeEditChanges(*m_entityRegistry, *m_compRegistry, {&posID, 1},
+                               m_entityRegistry->advanceTick(), 2, none),
+              0);
+}
+
+TEST_F(ECSTest, MalformedEditMessagesAreRejectedWhole)
+{
+    const ComponentID posID = m_compRegistry->getID<Position>();
+    const EntityMeta meta = m_entityRegistry->createEntity<Position>();
+    const Position value{1.0f, 2.0f, 3.0f};
+    const std::span<const uint8_t> bytes(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+
+    std::vector<uint8_t> edits;
+    EditMessageWriter writer(edits, EditMessageKind::edits, editSchemaHash(*m_compRegistry), 1);
+    writer.setComponent(meta, posID, bytes);
+    writer.setComponent(meta, posID, bytes.first(8)); // wrong size
+
+    EntityCommandBuffer commands;
+    EXPECT_THROW(recordEditMessage(edits, *m_entityRegistry, *m_compRegistry, commands),
+                 std::runtime_error);
+    EXPECT_TRUE(commands.empty());
+
+    std::vector<uint8_t> truncated;
+    EditMessageWriter(truncated, EditMessageKind::edits, editSchemaHash(*m_compRegistry), 1)
+        .setComponent(meta, posID, bytes);
+    truncated.pop_back();
+    EXPECT_THROW(recordEditMessage(truncated, *m_entityRegistry, *m_compRegistry, commands),
+                 std::runtime_error);
+
+    // Encoded before a registration the engine does not know about
+    std::vector<uint8_t> foreign;
+    EditMessageWriter(foreign, EditMessageKind::edits, editSchemaHash(*m_compRegistry) + 1, 1)
+        .setComponent(meta, posID, bytes);
+    EXPECT_THROW(recordEditMessage(foreign, *m_entityRegistry, *m_compRegistry, commands),
+                 std::runtime_error);
+
+    // Shared components are never set through edits
+    std::vector<uint8_t> shared;
+    const Material material{1, 0.5f};
+    EditMessageWriter(shared, EditMessageKind::edits, editSchemaHash(*m_compRegistry), 1)
+        .setComponent(meta, m_compRegistry->getID<Material>(),
+                      {reinterpret_cast<const uint8_t*>(&material), sizeof(material)});
+    EXPECT_THROW(recordEditMessage(shared, *m_entityRegistry, *m_compRegistry, commands),
+                 std::runtime_error);
+    EXPECT_TRUE(commands.empty());
+}
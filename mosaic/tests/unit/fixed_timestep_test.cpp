@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include <mosaic/core/fixed_timestep.hpp>
+
+using namespace mosaic::core;
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Steps
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FixedTimestepTest, FramesRunTheStepsTheyCompleteAndCarryTheRest)
+{
+    FixedTimestep timestep({10ms, 5});
+
+    EXPECT_EQ(timestep.advance(4ms), 0u);
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.4f);
+
+    // 4 + 17 ms: two steps, 1 ms carried
+    EXPECT_EQ(timestep.advance(17ms), 2u);
+    EXPECT_NEAR(timestep.getAlpha(), 0.1f, 1e-6f);
+
+    EXPECT_EQ(timestep.advance(9ms), 1u);
+    EXPECT_NEAR(timestep.getAlpha(), 0.0f, 1e-6f);
+
+    EXPECT_EQ(timestep.getStepCount(), 3u);
+    EXPECT_EQ(timestep.getDroppedTime(), 0ns);
+}
+
+TEST(FixedTimestepTest, AHitchRunsAtMostMaxStepsAndDropsTheRest)
+{
+    FixedTimestep timestep({10ms, 3});
+
+    // 250 ms owe 25 steps: 3 run, the part of a step left is kept
+    EXPECT_EQ(timestep.advance(255ms), 3u);
+    EXPECT_EQ(timestep.getDroppedTime(), 220ms);
+    EXPECT_NEAR(timestep.getAlpha(), 0.5f, 1e-6f);
+
+    // no debt carried to the next frame
+    EXPECT_EQ(timestep.advance(10ms), 1u);
+}
+
+TEST(FixedTimestepTest, TheSmoothedDeltaIgnoresTheSizeOfAHitch)
+{
+    FixedTimestep timestep({10ms, 2});
+
+    for (int i = 0; i < 32; ++i) timestep.advance(8ms);
+    EXPECT_EQ(timestep.getSmoothedDelta(), 8ms);
+
+    // clamped to the 20 ms of maxSteps, then averaged in
+    timestep.advance(1s);
+    EXPECT_EQ(timestep.getSmoothedDelta(), 11ms);
+
+    timestep.reset();
+    EXPECT_FLOAT_EQ(timestep.getAlpha(), 0.0f);
+}
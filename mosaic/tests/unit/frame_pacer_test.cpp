@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include <mosaic/graphics/frame_pacer.hpp>
+
+using namespace mosaic::graphics;
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+constexpr FramePacer::Clock::time_point at(std::chrono::microseconds _time)
+{
+    return FramePacer::Clock::time_point(_time);
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Estimates
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FramePacerTest, NoDelayUntilBothTimesWereMeasured)
+{
+    FramePacer pacer;
+    EXPECT_EQ(pacer.getDelay(at(0us)), FramePacer::Clock::duration::zero());
+
+    pacer.beginFrame(at(0us));
+    pacer.submitFrame(at(4000us));
+    EXPECT_EQ(pacer.getPendingCount(), 1u);
+    EXPECT_EQ(pacer.getDelay(at(4000us)), FramePacer::Clock::duration::zero());
+
+    // nothing in flight to complete
+    pacer.completeFrame(at(9000us));
+    pacer.completeFrame(at(9500us));
+    EXPECT_EQ(pacer.getPendingCount(), 0u);
+    EXPECT_EQ(pacer.getCpuTime(), 4000us);
+    EXPECT_EQ(pacer.getGpuTime(), 5000us);
+}
+
+TEST(FramePacerTest, CountsTheGpuTimeFromWhenAQueuedFrameCouldStart)
+{
+    FramePacer pacer;
+
+    pacer.beginFrame(at(0us));
+    pacer.submitFrame(at(1000us));
+    pacer.beginFrame(at(1000us));
+    pacer.submitFrame(at(2000us));
+
+    // the second frame waited behind the first one: 8 ms each, not 16 for the second
+    pacer.completeFrame(at(9000us));
+    pacer.completeFrame(at(17000us));
+
+    EXPECT_EQ(pacer.getCpuTime(), 1000us);
+    EXPECT_EQ(pacer.getGpuTime(), 8000us);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Delay
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FramePacerTest, GpuBoundFramesStartJustBeforeTheGpuGetsIdle)
+{
+    FramePacer pacer;
+
+    // 2 ms of CPU, 10 ms of GPU: a frame submitted at once would wait 8 ms in the queue
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        const auto start = std::chrono::microseconds(frame * 10'000);
+        pacer.beginFrame(at(start));
+        pacer.submitFrame(at(start + 2000us));
+        pacer.completeFrame(at(start + 12'000us));
+    }
+
+    pacer.beginFrame(at(20'000us));
+    pacer.submitFrame(at(22'000us));
+
+    // in flight until 32 ms: start at 32 - 2 - the margin of 0.25 ms
+    EXPECT_EQ(pacer.getDelay(at(22'000us)), 7750us);
+    EXPECT_EQ(pacer.getDelay(at(31'000us)), FramePacer::Clock::duration::zero());
+}
+
+TEST(FramePacerTest, CpuBoundFramesStartAtOnce)
+{
+    FramePacer pacer;
+
+    // 10 ms of CPU, 3 ms of GPU: the GPU waits for every frame
+    for (int frame = 0; frame < 4; ++frame)
+    {
+        const auto start = std::chrono::microseconds(frame * 10'000);
+        pacer.beginFrame(at(start));
+        pacer.submitFrame(at(start + 10'000us));
+        pacer.completeFrame(at(start + 13'000us));
+    }
+
+    pacer.beginFrame(at(40'000us));
+    pacer.submitFrame(at(50'000us));
+
+    EXPECT_EQ(pacer.getGpuTime(), 3000us);
+    EXPECT_EQ(pacer.getDelay(at(50'000us)), FramePacer::Clock::duration::zero());
+}
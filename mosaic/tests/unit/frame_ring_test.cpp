@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <mosaic/graphics/frame_ring.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FrameRingTest, AllocatesAlignedInTheRegionOfTheFrame)
+{
+    std::vector<std::byte> memory(3 * 1024);
+
+    FrameRing ring;
+    ring.reset(memory.data(), 1024, 3);
+    ring.beginFrame(1);
+
+    const FrameAllocation first = ring.allocate(4, 4);
+    const FrameAllocation second = ring.allocate(64, 256);
+
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+    EXPECT_EQ(first.offset, 1024u);
+    EXPECT_EQ(second.offset, 1024u + 256u);
+    EXPECT_EQ(second.data, memory.data() + second.offset);
+    EXPECT_EQ(ring.getFrameOffset(), 1024u);
+    EXPECT_EQ(ring.getUsed(), 256u + 64u);
+
+    const uint32_t value = 0xC0FFEE;
+    const FrameAllocation pushed = ring.push(value);
+
+    ASSERT_TRUE(pushed);
+    EXPECT_EQ(*reinterpret_cast<const uint32_t*>(pushed.data), value);
+}
+
+TEST(FrameRingTest, FailsWhenTheRegionIsFullAndResetsWithTheFrame)
+{
+    std::vector<std::byte> memory(2 * 512);
+
+    FrameRing ring;
+    ring.reset(memory.data(), 512, 2);
+    ring.beginFrame(0);
+
+    EXPECT_TRUE(ring.allocate(256, 256));
+    EXPECT_TRUE(ring.allocate(256, 256));
+    EXPECT_FALSE(ring.allocate(1, 1));
+
+    // the frame index wraps around the regions
+    ring.beginFrame(3);
+
+    const FrameAllocation allocation = ring.allocate(512, 256);
+
+    ASSERT_TRUE(allocation);
+    EXPECT_EQ(allocation.offset, 512u);
+    EXPECT_EQ(ring.getPeakUsage(), 512u);
+}
+
+TEST(FrameRingTest, AllocationsFromSeveralThreadsDoNotOverlap)
+{
+    constexpr size_t k_threads = 4;
+    constexpr size_t k_allocations = 1000;
+
+    std::vector<std::byte> memory(k_threads * k_allocations * 64);
+
+    FrameRing ring;
+    ring.reset(memory.data(), memory.size(), 1);
+    ring.beginFrame(0);
+
+    std::vector<std::vector<size_t>> offsets(k_threads);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < k_threads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                for (size_t i = 0; i < k_allocations; ++i)
+                {
+                    offsets[t].push_back(ring.allocate(48, 64).offset);
+                }
+            });
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    std::vector<bool> taken(memory.size() / 64);
+
+    for (const auto& thread : offsets)
+    {
+        for (const size_t offset : thread)
+        {
+            ASSERT_EQ(offset % 64, 0u);
+            ASSERT_FALSE(taken[offset / 64]);
+            taken[offset / 64] = true;
+        }
+    }
+}
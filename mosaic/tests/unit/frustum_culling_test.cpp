@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <mosaic/graphics/frustum_culling.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Column-major, right-handed view looking down -Z, [0, 1] depth (glm::perspectiveRH_ZO)
+Frustum perspectiveFrustum()
+{
+    const float f = 1.0f / std::tan(0.5f);
+
+    std::array<float, 16> matrix = {};
+    matrix[0] = f / 1.5f;
+    matrix[5] = f;
+    matrix[10] = 100.0f / (0.1f - 100.0f);
+    matrix[11] = -1.0f;
+    matrix[14] = -(100.0f * 0.1f) / (100.0f - 0.1f);
+    return extractFrustum(matrix);
+}
+
+// Objects around and inside the frustum, a column per field
+struct Objects
+{
+    std::vector<float> x, y, z, a, b, c;
+
+    explicit Objects(size_t _count, uint32_t _seed = 7)
+    {
+        std::mt19937 random(_seed);
+        std::uniform_real_distribution<float> position(-80.0f, 80.0f);
+        std::uniform_real_distribution<float> depth(-140.0f, 20.0f);
+        std::uniform_real_distribution<float> size(0.0f, 6.0f);
+
+        for (size_t i = 0; i < _count; ++i)
+        {
+            x.push_back(position(random));
+            y.push_back(position(random));
+            z.push_back(depth(random));
+            a.push_back(size(random));
+            b.push_back(size(random));
+            c.push_back(size(random));
+        }
+    }
+
+    SphereColumns spheres() const { return {x, y, z, a}; }
+    AabbColumns boxes() const { return {x, y, z, a, b, c}; }
+};
+
+std::vector<uint32_t> referenceSpheres(const Frustum& _frustum, const Objects& _objects,
+                                       uint32_t _firstIndex = 0)
+{
+    std::vector<uint32_t> visible;
+    for (size_t i = 0; i < _objects.x.size(); ++i)
+    {
+        const BoundingSphere sphere = {{_objects.x[i], _objects.y[i], _objects.z[i]},
+                                       _objects.a[i]};
+        if (isSphereInFrustum(_frustum, sphere)) visible.push_back(_firstIndex + i);
+    }
+    return visible;
+}
+
+// An AABB is outside when its farthest corner along a plane normal is behind the plane
+std::vector<uint32_t> referenceBoxes(const Frustum& _frustum, const Objects& _objects)
+{
+    std::vector<uint32_t> visible;
+    for (size_t i = 0; i < _objects.x.size(); ++i)
+    {
+        bool inside = true;
+        for (const std::array<float, 4>& plane : _frustum.planes)
+        {
+            const float cornerX = _objects.x[i] + std::copysign(_objects.a[i], plane[0]);
+            const float cornerY = _objects.y[i] + std::copysign(_objects.b[i], plane[1]);
+            const float cornerZ = _objects.z[i] + std::copysign(_objects.c[i], plane[2]);
+
+            if (plane[0] * cornerX + plane[1] * cornerY + plane[2] * cornerZ + plane[3] < 0.0f)
+            {
+                inside = false;
+            }
+        }
+        if (inside) visible.push_back(static_cast<uint32_t>(i));
+    }
+    return visible;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernels
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FrustumCullingTest, SelectsAnInstructionSet)
+{
+    const std::string isa = getCullingIsa();
+    EXPECT_FALSE(isa.empty());
+    EXPECT_EQ(isa, getCullingIsa());
+}
+
+TEST(FrustumCullingTest, MatchesTheScalarTestsForEveryTail)
+{
+    const Frustum frustum = perspectiveFrustum();
+
+    // every remainder of the 4, 8 and 16 wide batches
+    for (size_t count : {0u, 1u, 3u, 4u, 7u, 15u, 16u, 17u, 31u, 33u, 1000u})
+    {
+        const Objects objects(count, static_cast<uint32_t>(count));
+
+        // the output only ever fills the object count
+        std::vector<uint32_t> visible(count + 1, 0xFFFFFFFFu);
+        const std::span<uint32_t> output(visible.data(), count);
+
+        const uint32_t spheres = cullSpheres(frustum, objects.spheres(), output);
+        EXPECT_EQ(std::vector<uint32_t>(visible.begin(), visible.begin() + spheres),
+                  referenceSpheres(frustum, objects))
+            << count << " spheres";
+        EXPECT_EQ(visible[count], 0xFFFFFFFFu);
+
+        const uint32_t boxes = cullAabbs(frustum, objects.boxes(), output);
+        EXPECT_EQ(std::vector<uint32_t>(visible.begin(), visible.begin() + boxes),
+                  referenceBoxes(frustum, objects))
+            << count << " boxes";
+        EXPECT_EQ(visible[count], 0xFFFFFFFFu);
+    }
+}
+
+TEST(FrustumCullingTest, KeepsTheObjectsAcrossAPlaneAndOffsetsTheIndices)
+{
+    const Frustum frustum = perspectiveFrustum();
+
+    // in front, behind the near plane, straddling it, far to the left
+    const std::vector<float> x = {0.0f, 0.0f, 0.0f, -500.0f, 0.0f};
+    const std::vector<float> y = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    const std::vector<float> z = {-10.0f, 5.0f, 0.5f, -10.0f, -99.0f};
+    const std::vector<float> r = {1.0f, 1.0f, 1.0f, 1.0f, 2.0f};
+
+    std::vector<uint32_t> visible(x.size());
+    ASSERT_EQ(cullSpheres(frustum, {x, y, z, r}, visible, 100), 3u);
+    EXPECT_EQ(visible[0], 100u);
+    EXPECT_EQ(visible[1], 102u);
+    EXPECT_EQ(visible[2], 104u);
+
+    ASSERT_EQ(cullAabbs(frustum, {x, y, z, r, r, r}, visible, 100), 3u);
+    EXPECT_EQ(visible[1], 102u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Parallel culls
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FrustumCullingTest, ParallelCullsMatchTheSerialOnes)
+{
+    mosaic::core::CPUInfo cpuInfo;
+    cpuInfo.logicalCores = 8;
+    cpuInfo.physicalCores = 4;
+
+    auto pool = std::make_unique<mosaic::exec::ThreadPool>();
+    ASSERT_TRUE(pool->initialize(cpuInfo).isOk());
+
+    const Frustum frustum = perspectiveFrustum();
+    const Objects objects(10'007);
+
+    std::vector<uint32_t> serial(objects.x.size());
+    std::vector<uint32_t> parallel(objects.x.size());
+
+    // ranges of an uneven size, and a single range
+    for (size_t grain : {size_t{333}, size_t{1} << 20})
+    {
+        const uint32_t count = cullSpheres(frustum, objects.spheres(), serial, 5);
+        ASSERT_EQ(cullSpheres(*pool, frustum, objects.spheres(), parallel, 5, grain), count);
+        EXPECT_TRUE(std::equal(serial.begin(), serial.begin() + count, parallel.begin()));
+
+        const uint32_t boxes = cullAabbs(frustum, objects.boxes(), serial);
+        ASSERT_EQ(cullAabbs(*pool, frustum, objects.boxes(), parallel, 0, grain), boxes);
+        EXPECT_TRUE(std::equal(serial.begin(), serial.begin() + boxes, parallel.begin()));
+    }
+
+    pool->shutdown();
+}
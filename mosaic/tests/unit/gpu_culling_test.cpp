@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <mosaic/graphics/gpu_culling.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Column-major, right-handed view looking down -Z, [0, 1] depth (glm::perspectiveRH_ZO)
+std::array<float, 16> perspective(float _fovY, float _aspect, float _zNear, float _zFar)
+{
+    const float f = 1.0f / std::tan(_fovY * 0.5f);
+
+    std::array<float, 16> matrix = {};
+    matrix[0] = f / _aspect;
+    matrix[5] = f;
+    matrix[10] = _zFar / (_zNear - _zFar);
+    matrix[11] = -1.0f;
+    matrix[14] = -(_zFar * _zNear) / (_zFar - _zNear);
+    return matrix;
+}
+
+std::array<float, 16> scaleTranslation(float _scale, float _x, float _y, float _z)
+{
+    std::array<float, 16> matrix = {};
+    matrix[0] = matrix[5] = matrix[10] = _scale;
+    matrix[12] = _x;
+    matrix[13] = _y;
+    matrix[14] = _z;
+    matrix[15] = 1.0f;
+    return matrix;
+}
+
+CullInstance instanceAt(float _x, float _y, float _z, uint32_t _draw, uint32_t _index)
+{
+    CullInstance instance;
+    instance.bounds = {{_x, _y, _z}, 1.0f};
+    instance.drawIndex = _draw;
+    instance.instanceIndex = _index;
+    return instance;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Frustum
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(GpuCullingTest, CullsSpheresOutsideTheFrustum)
+{
+    const Frustum frustum = extractFrustum(perspective(1.5707963f, 1.0f, 0.1f, 100.0f));
+
+    EXPECT_TRUE(isSphereInFrustum(frustum, {{0.0f, 0.0f, -10.0f}, 1.0f}));
+    EXPECT_TRUE(isSphereInFrustum(frustum, {{0.0f, 0.0f, 0.5f}, 1.0f})); // crosses the near plane
+    EXPECT_FALSE(isSphereInFrustum(frustum, {{0.0f, 0.0f, 10.0f}, 1.0f}));
+    EXPECT_FALSE(isSphereInFrustum(frustum, {{0.0f, 0.0f, -200.0f}, 1.0f}));
+
+    // a 90 degree field of view: the side planes are at |x| = -z
+    EXPECT_TRUE(isSphereInFrustum(frustum, {{10.5f, 0.0f, -10.0f}, 1.0f}));
+    EXPECT_FALSE(isSphereInFrustum(frustum, {{12.0f, 0.0f, -10.0f}, 1.0f}));
+    EXPECT_FALSE(isSphereInFrustum(frustum, {{0.0f, -12.0f, -10.0f}, 1.0f}));
+}
+
+TEST(GpuCullingTest, TransformsBoundsByTheLargestScale)
+{
+    const BoundingSphere sphere =
+        transformSphere(scaleTranslation(3.0f, 1.0f, 2.0f, 3.0f), {{1.0f, 0.0f, 0.0f}, 0.5f});
+
+    EXPECT_FLOAT_EQ(sphere.center[0], 4.0f);
+    EXPECT_FLOAT_EQ(sphere.center[1], 2.0f);
+    EXPECT_FLOAT_EQ(sphere.center[2], 3.0f);
+    EXPECT_FLOAT_EQ(sphere.radius, 1.5f);
+}
+
+TEST(GpuCullingTest, ProjectsSpheresToTheirScreenRectangle)
+{
+    const std::array<float, 16> projection = perspective(1.5707963f, 1.0f, 0.1f, 100.0f);
+
+    const auto centered = projectSphere({{0.0f, 0.0f, -10.0f}, 1.0f}, 0.1f, projection[0],
+                                        projection[5]);
+    ASSERT_TRUE(centered.has_value());
+    EXPECT_NEAR((*centered)[0] + (*centered)[2], 1.0f, 1e-5f);
+    EXPECT_NEAR((*centered)[1] + (*centered)[3], 1.0f, 1e-5f);
+    // tan(asin(1 / 10)) / 2 of the screen on each side of the center
+    EXPECT_NEAR((*centered)[2] - (*centered)[0], 2.0f * 0.5f * std::tan(std::asin(0.1f)), 1e-5f);
+
+    const auto right = projectSphere({{5.0f, 0.0f, -10.0f}, 1.0f}, 0.1f, projection[0],
+                                     projection[5]);
+    ASSERT_TRUE(right.has_value());
+    EXPECT_GT((*right)[0], 0.5f);
+
+    EXPECT_FALSE(projectSphere({{0.0f, 0.0f, -0.5f}, 1.0f}, 0.1f, projection[0], projection[5]));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compaction
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(GpuCullingTest, CompactsTheDrawsOfVisibleInstances)
+{
+    const std::vector<CullDraw> draws = {{36, 0, 0, 4}, {24, 36, 8, 4}, {12, 60, 16, 1}};
+
+    std::vector<IndexedIndirectCommand> commands(draws.size());
+    const uint32_t visibleCapacity = buildIndirectCommands(draws, commands);
+
+    ASSERT_EQ(visibleCapacity, 9u);
+    EXPECT_EQ(commands[1].firstInstance, 4u);
+    EXPECT_EQ(commands[2].firstInstance, 8u);
+    EXPECT_EQ(commands[2].instanceCount, 0u);
+
+    const std::vector<CullInstance> instances = {
+        instanceAt(0.0f, 0.0f, -10.0f, 0, 100), instanceAt(0.0f, 0.0f, 10.0f, 0, 101),
+        instanceAt(1.0f, 0.0f, -10.0f, 0, 102), instanceAt(0.0f, 0.0f, 10.0f, 1, 103),
+        instanceAt(0.0f, 1.0f, -10.0f, 2, 104), instanceAt(0.0f, 2.0f, -10.0f, 2, 105)};
+
+    std::vector<uint32_t> visible(visibleCapacity, UINT32_MAX);
+    std::vector<IndexedIndirectCommand> compacted(draws.size());
+
+    const Frustum frustum = extractFrustum(perspective(1.5707963f, 1.0f, 0.1f, 100.0f));
+    const uint32_t drawCount =
+        cullInstances(frustum, instances, draws, commands, visible, compacted);
+
+    // the second draw has no visible instance, the third more than its maxInstances
+    ASSERT_EQ(drawCount, 2u);
+    EXPECT_EQ(compacted[0].indexCount, 36u);
+    EXPECT_EQ(compacted[0].instanceCount, 2u);
+    EXPECT_EQ(compacted[0].firstInstance, 0u);
+    EXPECT_EQ(compacted[1].indexCount, 12u);
+    EXPECT_EQ(compacted[1].instanceCount, 1u);
+    EXPECT_EQ(compacted[1].firstInstance, 8u);
+    EXPECT_EQ(compacted[1].vertexOffset, 16);
+
+    EXPECT_EQ(visible[0], 100u);
+    EXPECT_EQ(visible[1], 102u);
+    EXPECT_EQ(visible[8], 104u);
+}
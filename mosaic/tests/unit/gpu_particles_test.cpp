@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+
+#include <mosaic/graphics/gpu_particles.hpp>
+#include <mosaic/scene/particle_extraction.hpp>
+
+using namespace mosaic::scene;
+using namespace mosaic::ecs;
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Emission
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(GpuParticlesTest, SpawnCountCarriesTheFractionOver)
+{
+    float carry = 0.0f;
+
+    // 10 per second at 60 Hz: one particle every 6 frames, 10 a second
+    uint32_t spawned = 0;
+    for (int frame = 0; frame < 60; ++frame)
+    {
+        spawned += getParticleSpawnCount(10.0f, 1.0f / 60.0f, carry);
+    }
+    EXPECT_NEAR(static_cast<float>(spawned), 10.0f, 1.0f);
+    EXPECT_GE(carry, 0.0f);
+    EXPECT_LT(carry, 1.0f);
+
+    carry = 0.25f;
+    EXPECT_EQ(getParticleSpawnCount(1000.0f, 0.01f, carry), 10u);
+    EXPECT_NEAR(carry, 0.25f, 1e-4f);
+}
+
+TEST(GpuParticlesTest, NoRateOrTimeSpawnsNothing)
+{
+    float carry = 0.5f;
+    EXPECT_EQ(getParticleSpawnCount(0.0f, 1.0f, carry), 0u);
+    EXPECT_EQ(carry, 0.0f);
+
+    carry = 0.5f;
+    EXPECT_EQ(getParticleSpawnCount(100.0f, 0.0f, carry), 0u);
+    EXPECT_EQ(getParticleSpawnCount(-5.0f, 1.0f, carry), 0u);
+    EXPECT_EQ(getParticleSpawnCount(std::numeric_limits<float>::quiet_NaN(), 1.0f, carry), 0u);
+    EXPECT_EQ(carry, 0.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sort keys
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(GpuParticlesTest, SortKeysOrderTheFarthestFirst)
+{
+    constexpr uint32_t maxKey = (1u << k_particleSortBits) - 1;
+
+    EXPECT_EQ(getParticleSortKey(0.0f, 100.0f), maxKey);
+    EXPECT_EQ(getParticleSortKey(100.0f, 100.0f), 0u);
+    EXPECT_LT(getParticleSortKey(50.0f, 100.0f), getParticleSortKey(10.0f, 100.0f));
+    EXPECT_LT(getParticleSortKey(10.1f, 100.0f), getParticleSortKey(10.0f, 100.0f));
+
+    // clamped to the range of the keys
+    EXPECT_EQ(getParticleSortKey(1000.0f, 100.0f), 0u);
+    EXPECT_EQ(getParticleSortKey(-1.0f, 100.0f), maxKey);
+    EXPECT_EQ(getParticleSortKey(std::numeric_limits<float>::quiet_NaN(), 100.0f), maxKey);
+    EXPECT_EQ(getParticleSortKey(10.0f, 0.0f), maxKey);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Extraction
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ParticleExtractionTest : public ::testing::Test
+{
+   protected:
+    std::unique_ptr<ComponentRegistry> m_compRegistry;
+    std::unique_ptr<EntityRegistry> m_entityRegistry;
+
+    void SetUp() override
+    {
+        m_compRegistry = std::make_unique<ComponentRegistry>(16);
+
+        m_compRegistry->registerComponent<TransformComponent>("Transform");
+        m_compRegistry->registerComponent<ParticleEmitterComponent>("ParticleEmitter");
+
+        m_entityRegistry = std::make_unique<EntityRegistry>(m_compRegistry.get());
+    }
+
+    EntityMeta createEmitter(float _x, float _rate)
+    {
+        return m_entityRegistry->createEntity<TransformComponent, ParticleEmitterComponent>(
+            std::make_tuple(glm::vec3(_x, 2.0f, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                            glm::vec3(1.0f)),
+            std::make_tuple(_rate, 1.5f, glm::vec3(0.0f, 3.0f, 0.0f), glm::vec4(1.0f)));
+    }
+};
+
+TEST_F(ParticleExtractionTest, GivesEachEmitterItsRangeOfTheSpawns)
+{
+    createEmitter(1.0f, 100.0f);
+    createEmitter(2.0f, 50.0f);
+    m_entityRegistry->createEntity<ParticleEmitterComponent>(); // no transform, no emitter
+
+    ParticleExtraction extraction(*m_entityRegistry);
+    EXPECT_EQ(extraction.update(0.1f, 1000), 15u);
+    EXPECT_EQ(extraction.getSpawnCount(), 15u);
+
+    const auto emitters = extraction.getEmitters();
+    ASSERT_EQ(emitters.size(), 2u);
+
+    // the ranges follow each other, whatever the iteration order
+    const uint32_t first = emitters[0].firstSpawn == 0 ? 0 : 1;
+    const ParticleEmitter& a = emitters[first];
+    const ParticleEmitter& b = emitters[1 - first];
+    EXPECT_EQ(a.firstSpawn, 0u);
+    EXPECT_EQ(b.firstSpawn, a.spawnCount);
+    EXPECT_EQ(a.spawnCount + b.spawnCount, 15u);
+
+    // placed by their composed transforms
+    for (const ParticleEmitter& emitter : emitters)
+    {
+        EXPECT_FLOAT_EQ(emitter.position[1], 2.0f);
+        EXPECT_FLOAT_EQ(emitter.velocity[1], 3.0f);
+        EXPECT_FLOAT_EQ(emitter.lifetime, 1.5f);
+        EXPECT_FLOAT_EQ(emitter.position[0], emitter.spawnCount == 10 ? 1.0f : 2.0f);
+    }
+    EXPECT_NE(a.seed, b.seed);
+}
+
+TEST_F(ParticleExtractionTest, CapsTheSpawnsAtTheBudget)
+{
+    createEmitter(1.0f, 100.0f);
+    createEmitter(2.0f, 100.0f);
+
+    ParticleExtraction extraction(*m_entityRegistry);
+    EXPECT_EQ(extraction.update(0.1f, 15), 15u);
+
+    const auto emitters = extraction.getEmitters();
+    ASSERT_EQ(emitters.size(), 2u);
+    EXPECT_EQ(emitters[0].spawnCount, 10u);
+    EXPECT_EQ(emitters[1].spawnCount, 5u);
+    EXPECT_EQ(emitters[1].firstSpawn, 10u);
+
+    // a frame without time spawns nothing, the emitters still there
+    EXPECT_EQ(extraction.update(0.0f, 15), 0u);
+    EXPECT_EQ(extraction.getEmitters().size(), 2u);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include <mosaic/graphics/input_latency.hpp>
+
+using namespace mosaic::graphics;
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+constexpr InputLatency::Clock::time_point at(std::chrono::microseconds _time)
+{
+    return InputLatency::Clock::time_point(_time);
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tagging
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(InputLatencyTest, FramesWithoutInputAreNotMeasured)
+{
+    InputLatency latency;
+
+    latency.submitFrame(1);
+    EXPECT_EQ(latency.getPendingCount(), 0u);
+    EXPECT_FALSE(latency.getPendingFrame().has_value());
+
+    latency.presentFrame(1, at(16000us));
+    EXPECT_EQ(latency.getSampleCount(), 0u);
+    EXPECT_EQ(latency.getPercentiles().p50, InputLatency::Clock::duration::zero());
+}
+
+TEST(InputLatencyTest, AFrameIsTaggedWithTheOldestInput)
+{
+    InputLatency latency;
+
+    latency.consumeInput(at(3000us));
+    latency.consumeInput(at(1000us));
+    latency.consumeInput(at(2000us));
+    latency.submitFrame(7);
+
+    ASSERT_EQ(latency.getPendingFrame(), 7u);
+
+    // not yet presented
+    latency.presentFrame(6, at(10000us));
+    EXPECT_EQ(latency.getSampleCount(), 0u);
+
+    latency.presentFrame(7, at(21000us));
+    EXPECT_EQ(latency.getSampleCount(), 1u);
+    EXPECT_EQ(latency.getMeasuredCount(), 1u);
+    EXPECT_EQ(latency.getPercentiles().p50, 20ms);
+    EXPECT_FALSE(latency.getPendingFrame().has_value());
+}
+
+TEST(InputLatencyTest, InputCarriesOverToTheNextFrameSubmitted)
+{
+    InputLatency latency;
+
+    latency.consumeInput(at(0us));
+    // a frame skipped (minimized): nothing submitted, more input meanwhile
+    latency.consumeInput(at(5000us));
+    latency.submitFrame(1);
+
+    // the input is consumed by one frame only
+    latency.submitFrame(2);
+
+    latency.presentFrame(2, at(30000us));
+    EXPECT_EQ(latency.getSampleCount(), 1u);
+    EXPECT_EQ(latency.getPercentiles().p99, 30ms);
+}
+
+TEST(InputLatencyTest, DiscardedFramesMakeNoSample)
+{
+    InputLatency latency;
+
+    latency.consumeInput(at(0us));
+    latency.submitFrame(1);
+    latency.discardFrames();
+
+    latency.presentFrame(1, at(16000us));
+    EXPECT_EQ(latency.getSampleCount(), 0u);
+}
+
+TEST(InputLatencyTest, TheOldestPendingFrameIsForgottenWhenFull)
+{
+    InputLatency latency;
+
+    for (uint64_t frame = 1; frame <= InputLatency::k_maxPendingFrames + 1; ++frame)
+    {
+        latency.consumeInput(at(std::chrono::microseconds(frame * 1000)));
+        latency.submitFrame(frame);
+    }
+
+    EXPECT_EQ(latency.getPendingCount(), InputLatency::k_maxPendingFrames);
+    EXPECT_EQ(latency.getPendingFrame(), 2u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Percentiles
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(InputLatencyTest, PercentilesAreTheNearestRanks)
+{
+    InputLatency latency;
+
+    // 1 to 100 ms, presented out of order of their latency
+    for (uint64_t frame = 1; frame <= 100; ++frame)
+    {
+        const auto latencyMs = std::chrono::milliseconds((frame * 37) % 100 + 1);
+
+        latency.consumeInput(at(0us));
+        latency.submitFrame(frame);
+        latency.presentFrame(frame, at(latencyMs));
+    }
+
+    EXPECT_EQ(latency.getSampleCount(), 100u);
+    EXPECT_EQ(latency.getPercentiles().p50, 50ms);
+    EXPECT_EQ(latency.getPercentiles().p95, 95ms);
+    EXPECT_EQ(latency.getPercentiles().p99, 99ms);
+}
+
+TEST(InputLatencyTest, PercentilesAreThoseOfTheLastSamples)
+{
+    InputLatency latency;
+
+    uint64_t frame = 0;
+    const auto measure = [&](std::chrono::milliseconds _latency)
+    {
+        latency.consumeInput(at(0us));
+        latency.submitFrame(++frame);
+        latency.presentFrame(frame, at(_latency));
+    };
+
+    for (uint32_t i = 0; i < InputLatency::k_sampleCount; ++i) measure(100ms);
+    EXPECT_EQ(latency.getPercentiles().p50, 100ms);
+
+    for (uint32_t i = 0; i < InputLatency::k_sampleCount; ++i) measure(10ms);
+
+    EXPECT_EQ(latency.getSampleCount(), InputLatency::k_sampleCount);
+    EXPECT_EQ(latency.getMeasuredCount(), 2u * InputLatency::k_sampleCount);
+    EXPECT_EQ(latency.getPercentiles().p99, 10ms);
+}
@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include <mosaic/input/input_recording.hpp>
+#include <mosaic/input/sources/replay_input_sources.hpp>
+
+using namespace mosaic::input;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Clock = mosaic::core::TickClock;
+
+std::vector<InputRecord> playFrame(InputReplay& _replay)
+{
+    EXPECT_TRUE(_replay.advance());
+
+    const auto records = _replay.getRecords();
+    return std::vector<InputRecord>(records.begin(), records.end());
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Round trip
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(InputRecordingTest, PolledStateIsWrittenOnChangeOnly)
+{
+    InputRecorder recorder;
+    const auto start = Clock::now();
+
+    recorder.beginFrame(start);
+    recorder.recordActive(InputRecordSource::mouse, true);
+    recorder.recordButton(MouseButton::button_left, InputAction::press);
+    recorder.recordCursor(glm::vec2(100.0f, 50.0f));
+    recorder.endFrame();
+
+    // Nothing changed: an idle frame
+    recorder.beginFrame(start + 16ms);
+    recorder.recordActive(InputRecordSource::mouse, true);
+    recorder.recordButton(MouseButton::button_left, InputAction::press);
+    recorder.recordCursor(glm::vec2(100.0f, 50.0f));
+    recorder.recordScroll(glm::vec2(0.0f));
+    recorder.endFrame();
+
+    recorder.beginFrame(start + 33ms);
+    recorder.recordButton(MouseButton::button_left, InputAction::release);
+    recorder.recordCursor(glm::vec2(97.0f, 58.5f));
+    recorder.recordScroll(glm::vec2(0.0f, -1.0f));
+    recorder.endFrame();
+
+    EXPECT_EQ(recorder.getFrameCount(), 3u);
+
+    InputReplay replay(recorder.getBytes());
+
+    const auto first = playFrame(replay);
+    ASSERT_EQ(first.size(), 3u);
+    EXPECT_EQ(first[0].type, InputRecordType::active);
+    EXPECT_EQ(first[0].code, uint32_t(InputRecordSource::mouse));
+    EXPECT_EQ(first[0].state, 1);
+    EXPECT_EQ(first[1].type, InputRecordType::button);
+    EXPECT_EQ(first[1].code, uint32_t(MouseButton::button_left));
+    EXPECT_EQ(first[1].state, uint8_t(InputAction::press));
+    EXPECT_FALSE(first[1].raw);
+    EXPECT_EQ(first[2].value, glm::vec2(100.0f, 50.0f));
+
+    const auto frameTime = replay.getFrameTime();
+    EXPECT_TRUE(playFrame(replay).empty());
+    EXPECT_EQ(replay.getFrameTime() - frameTime, 16ms);
+
+    // A whole difference for x, the floats for the half pixel
+    const auto third = playFrame(replay);
+    ASSERT_EQ(third.size(), 3u);
+    EXPECT_EQ(third[0].state, uint8_t(InputAction::release));
+    EXPECT_EQ(third[1].value, glm::vec2(97.0f, 58.5f));
+    EXPECT_EQ(third[2].type, InputRecordType::scroll);
+    EXPECT_EQ(third[2].value, glm::vec2(0.0f, -1.0f));
+    EXPECT_EQ(replay.getFrameTime() - frameTime, 33ms);
+
+    EXPECT_FALSE(replay.advance());
+    EXPECT_TRUE(replay.isFinished());
+    EXPECT_EQ(replay.getFrameCount(), 3u);
+}
+
+TEST(InputRecordingTest, RawEventsKeepTheirOrderAndAge)
+{
+    InputRecorder recorder;
+    const auto frame = Clock::now();
+
+    recorder.beginFrame(frame);
+    recorder.recordRawEvent(RawInputEvent(RawInputEventType::key, 65, true, frame - 5ms));
+    recorder.recordRawEvent(RawInputEvent(RawInputEventType::key, 65, false, frame - 2ms));
+    recorder.recordRawEvent(RawInputEvent(RawInputEventType::cursor, glm::vec2(3.0f, 4.0f),
+                                          frame - 1ms));
+    recorder.recordCursor(glm::vec2(5.0f, 4.0f));
+    recorder.endFrame();
+
+    InputReplay replay(recorder.getBytes());
+    const auto records = playFrame(replay);
+
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_TRUE(records[0].raw);
+    EXPECT_EQ(records[0].code, 65u);
+    EXPECT_EQ(records[0].state, 1);
+    EXPECT_EQ(records[0].age, 5ms);
+    EXPECT_EQ(records[1].state, 0);
+    EXPECT_EQ(records[1].age, 2ms);
+    EXPECT_EQ(records[2].value, glm::vec2(3.0f, 4.0f));
+
+    // Delta-encoded from the raw position, the last one written
+    EXPECT_FALSE(records[3].raw);
+    EXPECT_EQ(records[3].value, glm::vec2(5.0f, 4.0f));
+}
+
+TEST(InputRecordingTest, TextAndIMEEventsRoundTrip)
+{
+    InputRecorder recorder;
+
+    IMEComposition composition;
+    composition.text = "\xE3\x81\x8B"; // か
+    composition.cursor = 1;
+
+    recorder.beginFrame(Clock::now());
+    recorder.recordText(TextInputEvent({U'h', U'é'}, "h\xC3\xA9", Clock::now(), 0));
+    recorder.recordText(TextInputEvent());
+    recorder.recordIME(IMEEvent(IMEEventType::CompositionUpdate, composition));
+    recorder.endFrame();
+
+    InputReplay replay(recorder.getBytes());
+    const auto records = playFrame(replay);
+
+    ASSERT_EQ(records.size(), 2u);
+    ASSERT_EQ(records[0].type, InputRecordType::text);
+    EXPECT_EQ(replay.getText(records[0].code).codepoints, (std::vector<char32_t>{U'h', U'é'}));
+    EXPECT_EQ(replay.getText(records[0].code).text, "h\xC3\xA9");
+
+    ASSERT_EQ(records[1].type, InputRecordType::ime);
+    EXPECT_EQ(replay.getIME(records[1].code).type, IMEEventType::CompositionUpdate);
+    EXPECT_EQ(replay.getIME(records[1].code).composition.text, composition.text);
+    EXPECT_EQ(replay.getIME(records[1].code).composition.cursor, 1u);
+}
+
+TEST(InputRecordingTest, TouchSamplesRoundTrip)
+{
+    InputRecorder recorder;
+    const auto frame = Clock::now();
+
+    recorder.beginFrame(frame);
+    recorder.recordTouch(TouchSample(7, TouchPhase::down, glm::vec2(10.0f, 20.0f), 0.5f,
+                                     frame - 3ms));
+    recorder.recordTouch(TouchSample(7, TouchPhase::up, glm::vec2(12.5f, 20.0f), 0.25f,
+                                     frame - 1ms));
+    recorder.endFrame();
+
+    InputReplay replay(recorder.getBytes());
+    const auto records = playFrame(replay);
+
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].type, InputRecordType::touch);
+    EXPECT_EQ(records[0].code, 7u);
+    EXPECT_EQ(records[0].state, uint8_t(TouchPhase::down));
+    EXPECT_EQ(records[0].value, glm::vec2(10.0f, 20.0f));
+    EXPECT_EQ(records[0].pressure, 0.5f);
+    EXPECT_EQ(records[0].age, 3ms);
+    EXPECT_EQ(records[1].state, uint8_t(TouchPhase::up));
+    EXPECT_EQ(records[1].value, glm::vec2(12.5f, 20.0f));
+    EXPECT_EQ(records[1].pressure, 0.25f);
+}
+
+TEST(InputRecordingTest, ReplayedTouchesTrackEveryPointerSample)
+{
+    InputRecorder recorder;
+    const auto start = Clock::now();
+
+    // Two samples of the pointer per frame, a second pointer lifting in the second frame
+    recorder.beginFrame(start);
+    recorder.recordTouch(TouchSample(1, TouchPhase::down, glm::vec2(0.0f), 1.0f, start - 8ms));
+    recorder.recordTouch(TouchSample(2, TouchPhase::down, glm::vec2(50.0f), 1.0f, start - 8ms));
+    recorder.recordTouch(TouchSample(1, TouchPhase::move, glm::vec2(4.0f, 0.0f), 1.0f,
+                                     start - 4ms));
+    recorder.endFrame();
+
+    recorder.beginFrame(start + 16ms);
+    recorder.recordTouch(TouchSample(1, TouchPhase::move, glm::vec2(8.0f, 0.0f), 1.0f,
+                                     start + 4ms));
+    recorder.recordTouch(TouchSample(2, TouchPhase::up, glm::vec2(50.0f), 0.0f, start + 6ms));
+    recorder.recordTouch(TouchSample(1, TouchPhase::move, glm::vec2(12.0f, 0.0f), 1.0f,
+                                     start + 12ms));
+    recorder.endFrame();
+
+    recorder.beginFrame(start + 33ms);
+    recorder.endFrame();
+
+    InputReplay replay(recorder.getBytes());
+    ReplayTouchInputSource source(nullptr, &replay);
+    ASSERT_TRUE(source.initialize().isOk());
+
+    ASSERT_TRUE(replay.advance());
+    source.processInput();
+
+    ASSERT_EQ(source.getPointers().size(), 2u);
+    EXPECT_EQ(source.getPrimaryPointer()->id, 1);
+    EXPECT_EQ(source.findPointer(1)->frameSampleCount, 2u);
+
+    ASSERT_TRUE(replay.advance());
+    source.processInput();
+
+    const auto* pointer = source.findPointer(1);
+    ASSERT_NE(pointer, nullptr);
+    EXPECT_EQ(pointer->position, glm::vec2(12.0f, 0.0f));
+    EXPECT_EQ(pointer->startPosition, glm::vec2(0.0f));
+    EXPECT_EQ(pointer->delta, glm::vec2(8.0f, 0.0f));
+    EXPECT_EQ(pointer->frameSampleCount, 2u);
+    EXPECT_EQ(pointer->samples.size(), 4u);
+    EXPECT_EQ(pointer->samples[0].position, glm::vec2(12.0f, 0.0f));
+    EXPECT_GT(pointer->velocity.x, 0.0f);
+    EXPECT_EQ(pointer->velocity.y, 0.0f);
+
+    // The release is seen for one frame
+    ASSERT_NE(source.findPointer(2), nullptr);
+    EXPECT_EQ(source.findPointer(2)->phase, TouchPhase::up);
+
+    ASSERT_TRUE(replay.advance());
+    source.processInput();
+
+    EXPECT_EQ(source.getPointers().size(), 1u);
+    EXPECT_EQ(source.findPointer(2), nullptr);
+    EXPECT_EQ(source.findPointer(1)->delta, glm::vec2(0.0f));
+}
+
+TEST(InputRecordingTest, AnIdleFrameTakesAFewBytes)
+{
+    InputRecorder recorder;
+    const auto start = Clock::now();
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        recorder.beginFrame(start + i * 16ms);
+        recorder.recordActive(InputRecordSource::keyboard, true);
+        recorder.recordKey(KeyboardKey::key_a, InputAction::release);
+        recorder.recordCursor(glm::vec2(10.0f));
+        recorder.endFrame();
+    }
+
+    EXPECT_LT(recorder.getBytes().size(), 1000u * 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Errors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(InputRecordingTest, MalformedRecordingsThrow)
+{
+    EXPECT_THROW(InputReplay(std::vector<uint8_t>{1, 2, 3}), std::runtime_error);
+    EXPECT_THROW(InputReplay(std::vector<uint8_t>(8, 0)), std::runtime_error);
+
+    InputRecorder recorder;
+    recorder.beginFrame(Clock::now());
+    recorder.recordCursor(glm::vec2(0.25f, 0.5f));
+    recorder.endFrame();
+
+    std::vector<uint8_t> bytes = recorder.getBytes();
+    bytes.pop_back();
+
+    InputReplay replay(std::move(bytes));
+    EXPECT_THROW(replay.advance(), std::runtime_error);
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <mosaic/graphics/instance_batcher.hpp>
+#include <mosaic/graphics/lod_selection.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+std::array<float, 16> translation(float _x)
+{
+    std::array<float, 16> matrix = {};
+    matrix[0] = matrix[5] = matrix[10] = matrix[15] = 1.0f;
+    matrix[12] = _x;
+    return matrix;
+}
+
+std::optional<DrawCall> meshDraw(const InstanceBatch& _batch)
+{
+    DrawCall call;
+    call.pipeline = 1;
+    call.indexBuffer = 10 + _batch.mesh;
+    call.indexCount = 36;
+    call.sortKey = _batch.material;
+    return call;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Grouping
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(InstanceBatcherTest, GroupsInstancesByMeshAndMaterialInAddOrder)
+{
+    InstanceBatcher batcher;
+    batcher.add(2, 0, translation(0.0f));
+    batcher.add(1, 5, translation(1.0f));
+    batcher.add(2, 0, translation(2.0f));
+    batcher.add(1, 3, translation(3.0f));
+    batcher.add(1, 5, translation(4.0f));
+
+    EXPECT_EQ(batcher.getPendingCount(), 5u);
+    batcher.build();
+    EXPECT_EQ(batcher.getPendingCount(), 0u);
+
+    const auto batches = batcher.getBatches();
+    ASSERT_EQ(batches.size(), 3u);
+
+    EXPECT_EQ(batches[0].mesh, 1u);
+    EXPECT_EQ(batches[0].material, 3u);
+    EXPECT_EQ(batches[0].firstInstance, 0u);
+    EXPECT_EQ(batches[0].instanceCount, 1u);
+
+    EXPECT_EQ(batches[1].mesh, 1u);
+    EXPECT_EQ(batches[1].material, 5u);
+    EXPECT_EQ(batches[1].firstInstance, 1u);
+    EXPECT_EQ(batches[1].instanceCount, 2u);
+
+    EXPECT_EQ(batches[2].mesh, 2u);
+    EXPECT_EQ(batches[2].firstInstance, 3u);
+    EXPECT_EQ(batches[2].instanceCount, 2u);
+
+    const auto instances = batcher.getInstances();
+    ASSERT_EQ(instances.size(), 5u);
+
+    const std::array<float, 5> expected = {3.0f, 1.0f, 4.0f, 0.0f, 2.0f};
+    for (size_t i = 0; i < expected.size(); ++i) EXPECT_EQ(instances[i].world[12], expected[i]);
+}
+
+TEST(InstanceBatcherTest, SplitsTheBatchesOfAMeshByLod)
+{
+    InstanceBatcher batcher;
+    batcher.add(1, 2, 4, translation(0.0f));
+    batcher.add(1, 4, translation(1.0f));
+    batcher.add(1, k_impostorTier, 4, translation(2.0f));
+    batcher.add(1, 2, 4, translation(3.0f));
+    batcher.build();
+
+    const auto batches = batcher.getBatches();
+    ASSERT_EQ(batches.size(), 3u);
+
+    EXPECT_EQ(batches[0].lod, 0u);
+    EXPECT_EQ(batches[0].instanceCount, 1u);
+    EXPECT_EQ(batches[1].lod, 2u);
+    EXPECT_EQ(batches[1].material, 4u);
+    EXPECT_EQ(batches[1].instanceCount, 2u);
+    EXPECT_EQ(batches[2].lod, k_impostorTier);
+    EXPECT_EQ(batches[2].mesh, 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Emission
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(InstanceBatcherTest, EmitsOneInstancedDrawPerBatchFromOneRingAllocation)
+{
+    std::vector<std::byte> memory(2 * 1024);
+
+    FrameRing ring;
+    ring.reset(memory.data(), 1024, 2);
+    ring.beginFrame(1);
+    ASSERT_TRUE(ring.allocate(4, 4)); // the instances start at the next 64 bytes
+
+    InstanceBatcher batcher;
+    for (uint32_t i = 0; i < 4; ++i) batcher.add(i % 2, 7, translation(static_cast<float>(i)));
+    batcher.add(9, 7, translation(9.0f));
+    batcher.build();
+
+    DrawQueue queue;
+    const uint32_t draws = batcher.emit(ring, queue, 42,
+                                        [](const InstanceBatch& _batch)
+                                        {
+                                            // a mesh that is not loaded yet
+                                            if (_batch.mesh == 9) return std::optional<DrawCall>();
+                                            return meshDraw(_batch);
+                                        });
+
+    ASSERT_EQ(draws, 2u);
+    ASSERT_EQ(queue.size(), 2u);
+
+    // every instance is in the ring, the skipped batch's too
+    EXPECT_EQ(ring.getUsed(), 64u + 5u * sizeof(InstanceData));
+
+    const uint32_t base = (1024u + 64u) / sizeof(InstanceData);
+    const auto calls = queue.getCalls();
+
+    EXPECT_EQ(calls[0].type, DrawCallType::IndexedInstanced);
+    EXPECT_EQ(calls[0].indexBuffer, 10u);
+    EXPECT_EQ(calls[0].instanceCount, 2u);
+    EXPECT_EQ(calls[0].firstInstance, base);
+    EXPECT_EQ(calls[0].resources[InstanceBatcher::k_instanceResource], 42u);
+    EXPECT_EQ(calls[1].indexBuffer, 11u);
+    EXPECT_EQ(calls[1].firstInstance, base + 2u);
+
+    // the shader reads instances[gl_InstanceIndex] of the whole buffer
+    const auto* instances = reinterpret_cast<const InstanceData*>(memory.data());
+    EXPECT_EQ(instances[calls[1].firstInstance + 1].world[12], 3.0f);
+}
+
+TEST(InstanceBatcherTest, EmitsNothingWhenTheRingIsFull)
+{
+    std::vector<std::byte> memory(128);
+
+    FrameRing ring;
+    ring.reset(memory.data(), 128, 1);
+    ring.beginFrame(0);
+
+    InstanceBatcher batcher;
+    for (int i = 0; i < 3; ++i) batcher.add(0, 0, translation(0.0f));
+    batcher.build();
+
+    DrawQueue queue;
+    EXPECT_EQ(batcher.emit(ring, queue, 0, meshDraw), 0u);
+    EXPECT_TRUE(queue.empty());
+
+    // built batches are emitted again without being rebuilt
+    std::vector<std::byte> larger(1024);
+    ring.reset(larger.data(), 1024, 1);
+    ring.beginFrame(0);
+    EXPECT_EQ(batcher.emit(ring, queue, 0, meshDraw), 1u);
+    EXPECT_EQ(batcher.emit(ring, queue, 0, meshDraw), 1u);
+    EXPECT_EQ(queue.getCalls()[1].firstInstance, 3u);
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include "mosaic/exec/io_service.hpp"
+#include "mosaic/exec/thread_pool.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+using namespace mosaic::exec;
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Every test runs on the best backend of the platform and on the thread pool one
+class IoServiceTest : public ::testing::TestWithParam<IoBackendType>
+{
+   protected:
+    std::unique_ptr<ThreadPool> pool;
+    std::unique_ptr<IoService> io;
+
+    std::filesystem::path path;
+    std::vector<uint8_t> contents;
+
+    void SetUp() override
+    {
+        mosaic::core::CPUInfo mockCPUInfo;
+        mockCPUInfo.logicalCores = 8;
+        mockCPUInfo.physicalCores = 4;
+
+        pool = std::make_unique<ThreadPool>();
+        ASSERT_TRUE(pool->initialize(mockCPUInfo).isOk());
+
+        io = std::make_unique<IoService>();
+        ASSERT_TRUE(io->initialize(8, GetParam()).isOk());
+
+        path = std::filesystem::temp_directory_path() /
+               ("mosaic_io_service_test_" + std::to_string(static_cast<int>(GetParam())));
+
+        contents.resize(300000);
+        for (size_t i = 0; i < contents.size(); ++i) contents[i] = uint8_t(i * 31 + i / 251);
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(contents.data()),
+                   static_cast<std::streamsize>(contents.size()));
+    }
+
+    void TearDown() override
+    {
+        io->shutdown();
+        io.reset();
+
+        pool->shutdown();
+        pool.reset();
+
+        std::filesystem::remove(path);
+    }
+
+    std::vector<uint8_t> slice(size_t _offset, size_t _size) const
+    {
+        return std::vector<uint8_t>(contents.begin() + _offset, contents.begin() + _offset + _size);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reads
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_P(IoServiceTest, ReadsRangesAndStopsAtTheEndOfTheFile)
+{
+    if (GetParam() == IoBackendType::none)
+    {
+        EXPECT_NE(io->getBackend(), IoBackendType::none);
+    }
+    if (GetParam() == IoBackendType::thread_pool)
+    {
+        EXPECT_EQ(io->getBackend(), IoBackendType::thread_pool);
+    }
+
+    auto file = IoFile::open(path);
+    EXPECT_EQ(file->getSize(), contents.size());
+
+    auto whole = io->readAsync(file, 0, contents.size());
+    auto middle = io->readAsync(file, 1000, 4096, TaskPriority::critical);
+    auto tail = io->readAsync(file, contents.size() - 10, 100);
+    auto past = io->readAsync(file, contents.size() + 10, 100);
+    auto empty = io->readAsync(file, 0, 0);
+
+    EXPECT_EQ(whole.get(), contents);
+    EXPECT_EQ(middle.get(), slice(1000, 4096));
+    EXPECT_EQ(tail.get(), slice(contents.size() - 10, 10));
+    EXPECT_TRUE(past.get().empty());
+    EXPECT_TRUE(empty.get().empty());
+}
+
+TEST_P(IoServiceTest, BatchesCompleteInOrderBeyondTheQueueDepth)
+{
+    auto file = IoFile::open(path);
+
+    std::vector<IoRequest> requests;
+    for (size_t i = 0; i < 100; ++i) requests.push_back({file, i * 2999, 1500});
+
+    std::vector<TaskFuture<IoBuffer>> futures = io->readBatch(requests, TaskPriority::background);
+    ASSERT_EQ(futures.size(), requests.size());
+
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        ASSERT_EQ(futures[i].get(), slice(i * 2999, 1500)) << "read " << i;
+    }
+
+    EXPECT_EQ(io->getQueuedCount(), 0u);
+}
+
+TEST_P(IoServiceTest, CompletionsContinueOnThePool)
+{
+    auto file = IoFile::open(path);
+
+    auto sum = io->readAsync(file, 0, 1024).then(*pool,
+                                                 [](IoBuffer _bytes)
+                                                 {
+                                                     uint64_t total = 0;
+                                                     for (uint8_t byte : _bytes) total += byte;
+                                                     return total;
+                                                 });
+
+    uint64_t expected = 0;
+    for (size_t i = 0; i < 1024; ++i) expected += contents[i];
+
+    ASSERT_TRUE(sum.waitFor(5s));
+    EXPECT_EQ(sum.get(), expected);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Errors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_P(IoServiceTest, FailuresReachTheFuture)
+{
+    EXPECT_THROW(IoFile::open(path.string() + ".missing"), std::system_error);
+
+#if !defined(MOSAIC_PLATFORM_WINDOWS)
+    // a directory opens, and fails to read
+    auto directory = IoFile::open(std::filesystem::temp_directory_path());
+    EXPECT_THROW(io->readAsync(directory, 0, 16).get(), std::system_error);
+#endif
+
+    io->shutdown();
+    EXPECT_EQ(io->getBackend(), IoBackendType::none);
+    EXPECT_THROW(io->readAsync(IoFile::open(path), 0, 16).get(), std::runtime_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, IoServiceTest,
+                         ::testing::Values(IoBackendType::none, IoBackendType::thread_pool));
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string_view>
+
+#include <mosaic/core/isa_dispatch.hpp>
+
+using namespace mosaic::core;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+using Kernel = int (*)(int);
+
+int baseKernel(int _x) { return _x; }
+int sse41Kernel(int _x) { return _x + 41; }
+int avx2Kernel(int _x) { return _x + 2; }
+
+Kernel getSse41() noexcept { return &sse41Kernel; }
+Kernel getAvx2() noexcept { return &avx2Kernel; }
+
+// The CPU of a player: SSE4.2 but no AVX
+bool allowedUpToSse42(ISALevel _level) noexcept { return _level <= ISALevel::sse42; }
+
+// Restores the cap of a test
+struct MaxISALevelGuard
+{
+    ~MaxISALevelGuard() { setMaxISALevel(std::nullopt); }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ISADispatchTest, NamesRoundTrip)
+{
+    for (ISALevel level : {ISALevel::scalar, ISALevel::sse2, ISALevel::sse41, ISALevel::sse42,
+                           ISALevel::avx, ISALevel::avx2, ISALevel::avx512f, ISALevel::neon})
+    {
+        EXPECT_EQ(parseISALevel(toString(level)), level);
+    }
+
+    EXPECT_EQ(parseISALevel("sse4"), std::nullopt);
+}
+
+TEST(ISADispatchTest, ResolvesToTheWidestAllowedVariant)
+{
+    const ISADispatch<Kernel> player(
+        &baseKernel, {{ISALevel::avx2, &getAvx2}, {ISALevel::sse41, &getSse41}},
+        &allowedUpToSse42);
+    EXPECT_EQ((*player)(1), 42);
+    EXPECT_EQ(player.getLevel(), ISALevel::sse41);
+
+    const ISADispatch<Kernel> all(
+        &baseKernel, {{ISALevel::sse41, &getSse41}, {ISALevel::avx2, &getAvx2}},
+        [](ISALevel) noexcept { return true; });
+    EXPECT_EQ((*all)(1), 3);
+
+    const ISADispatch<Kernel> none(&baseKernel, {{ISALevel::avx2, &getAvx2}},
+                                   &allowedUpToSse42);
+    EXPECT_EQ((*none)(1), 1);
+    EXPECT_EQ(none.getLevel(), std::nullopt);
+}
+
+TEST(ISADispatchTest, MatchesTheFlagsOfTheHost)
+{
+    const CPUInfo::ISASupport& host = getHostISASupport();
+    EXPECT_TRUE(isISASupported(ISALevel::scalar, host));
+
+    // Each level implies the narrower ones
+    EXPECT_TRUE(!host.avx512 || host.avx2);
+    EXPECT_TRUE(!host.avx2 || host.avx);
+    EXPECT_TRUE(!host.sse42 || host.sse41);
+
+#if (defined(__x86_64__) || defined(_M_X64))
+    EXPECT_TRUE(host.sse2);
+#if defined(__GNUC__)
+    EXPECT_EQ(host.avx2, bool(__builtin_cpu_supports("avx2")));
+    EXPECT_EQ(host.avx512, bool(__builtin_cpu_supports("avx512f")));
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    EXPECT_TRUE(host.neon);
+#endif
+}
+
+TEST(ISADispatchTest, CapsTheLevel)
+{
+    MaxISALevelGuard guard;
+
+    setMaxISALevel(ISALevel::scalar);
+    EXPECT_EQ(getMaxISALevel(), ISALevel::scalar);
+    EXPECT_TRUE(isISAAllowed(ISALevel::scalar));
+    EXPECT_FALSE(isISAAllowed(ISALevel::sse2));
+    EXPECT_FALSE(isISAAllowed(ISALevel::neon));
+
+    const ISADispatch<Kernel> capped(&baseKernel, {{ISALevel::sse41, &getSse41}});
+    EXPECT_EQ((*capped)(1), 1);
+
+    setMaxISALevel(ISALevel::sse41);
+    EXPECT_FALSE(isISAAllowed(ISALevel::avx2));
+    EXPECT_EQ(isISAAllowed(ISALevel::sse41), getHostISASupport().sse41);
+
+    setMaxISALevel(std::nullopt);
+    EXPECT_EQ(getMaxISALevel(), std::nullopt);
+    EXPECT_EQ(isISAAllowed(ISALevel::avx2), getHostISASupport().avx2);
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <mosaic/graphics/ktx2.hpp>
+#include <mosaic/graphics/texture_streaming.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+constexpr uint32_t k_vkFormatBC7Srgb = 146;
+constexpr uint8_t k_colorModelETC1S = 163;
+constexpr uint8_t k_colorModelUASTC = 166;
+
+struct Ktx2File
+{
+    uint32_t vkFormat = k_vkFormatBC7Srgb;
+    uint32_t width = 16;
+    uint32_t height = 8;
+    uint32_t levels = 3;
+    uint32_t layers = 0;
+    uint32_t supercompression = 0;
+    uint8_t colorModel = 0;
+    uint32_t samples = 1;
+    uint8_t channel = 0;
+};
+
+template <typename T>
+void write(std::vector<uint8_t>& _file, size_t _offset, T _value)
+{
+    std::memcpy(_file.data() + _offset, &_value, sizeof(T));
+}
+
+// A KTX2 file of the description, level i filled with i + 1 and sized as BC7 (16 bytes a block)
+std::vector<uint8_t> makeKtx2(const Ktx2File& _desc)
+{
+    const size_t levelIndex = 80;
+    const size_t dfdOffset = levelIndex + size_t{_desc.levels} * 24;
+    const uint32_t blockSize = 24 + 16 * _desc.samples;
+    const uint32_t dfdSize = 4 + blockSize;
+
+    std::vector<size_t> levelSizes;
+    size_t size = dfdOffset + dfdSize;
+    for (uint32_t level = 0; level < _desc.levels; ++level)
+    {
+        levelSizes.push_back(getTextureMipSize(TextureFormat::BC7,
+                                               std::max(_desc.width >> level, 1u),
+                                               std::max(_desc.height >> level, 1u)));
+        size += levelSizes.back();
+    }
+
+    std::vector<uint8_t> file(size, 0);
+    const uint8_t identifier[] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    std::memcpy(file.data(), identifier, sizeof(identifier));
+
+    write<uint32_t>(file, 12, _desc.vkFormat);
+    write<uint32_t>(file, 16, 1);
+    write<uint32_t>(file, 20, _desc.width);
+    write<uint32_t>(file, 24, _desc.height);
+    write<uint32_t>(file, 32, _desc.layers);
+    write<uint32_t>(file, 36, 1);
+    write<uint32_t>(file, 40, _desc.levels);
+    write<uint32_t>(file, 44, _desc.supercompression);
+    write<uint32_t>(file, 48, static_cast<uint32_t>(dfdOffset));
+    write<uint32_t>(file, 52, dfdSize);
+
+    write<uint32_t>(file, dfdOffset, dfdSize);
+    write<uint16_t>(file, dfdOffset + 4 + 6, static_cast<uint16_t>(blockSize));
+    file[dfdOffset + 4 + 8] = _desc.colorModel;
+    file[dfdOffset + 4 + 24 + 3] = _desc.channel;
+
+    // the smallest level last, as the files store them
+    size_t offset = size;
+    for (uint32_t level = 0; level < _desc.levels; ++level)
+    {
+        offset -= levelSizes[level];
+        write<uint64_t>(file, levelIndex + level * 24, offset);
+        write<uint64_t>(file, levelIndex + level * 24 + 8, levelSizes[level]);
+        std::memset(file.data() + offset, static_cast<int>(level + 1), levelSizes[level]);
+    }
+
+    return file;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Parsing
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(Ktx2Test, ParsesANativeTexture)
+{
+    const std::vector<uint8_t> file = makeKtx2({});
+    ASSERT_TRUE(isKtx2(file));
+
+    auto parsed = parseKtx2(file);
+    ASSERT_TRUE(parsed.isOk()) << parsed.error();
+
+    const Ktx2Info& info = parsed.unwrap();
+    EXPECT_EQ(info.width, 16u);
+    EXPECT_EQ(info.height, 8u);
+    EXPECT_EQ(info.mipLevels, 3u);
+    EXPECT_EQ(info.encoding, Ktx2Encoding::Native);
+    EXPECT_EQ(info.format, TextureFormat::BC7);
+    EXPECT_TRUE(info.srgb);
+    ASSERT_EQ(info.levels.size(), 3u);
+    EXPECT_EQ(info.levels[0].size, 4u * 2u * 16u);
+    EXPECT_EQ(info.levels[2].size, 16u);
+}
+
+TEST(Ktx2Test, ParsesTheBasisEncodings)
+{
+    Ktx2File etc1s;
+    etc1s.vkFormat = 0;
+    etc1s.supercompression = 1;
+    etc1s.colorModel = k_colorModelETC1S;
+    etc1s.samples = 2;
+
+    auto parsed = parseKtx2(makeKtx2(etc1s));
+    ASSERT_TRUE(parsed.isOk()) << parsed.error();
+    EXPECT_EQ(parsed.unwrap().encoding, Ktx2Encoding::ETC1S);
+    EXPECT_TRUE(parsed.unwrap().alpha);
+
+    Ktx2File uastc;
+    uastc.vkFormat = 0;
+    uastc.colorModel = k_colorModelUASTC;
+    uastc.channel = 0; // RGB
+
+    auto rgb = parseKtx2(makeKtx2(uastc));
+    ASSERT_TRUE(rgb.isOk()) << rgb.error();
+    EXPECT_EQ(rgb.unwrap().encoding, Ktx2Encoding::UASTC);
+    EXPECT_FALSE(rgb.unwrap().alpha);
+}
+
+TEST(Ktx2Test, RejectsMalformedFiles)
+{
+    const uint8_t png[] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    EXPECT_FALSE(isKtx2(png));
+    EXPECT_TRUE(parseKtx2(png).isErr());
+
+    // truncated in its levels
+    std::vector<uint8_t> file = makeKtx2({});
+    file.resize(file.size() - 1);
+    EXPECT_TRUE(parseKtx2(file).isErr());
+
+    Ktx2File array;
+    array.layers = 2;
+    EXPECT_TRUE(parseKtx2(makeKtx2(array)).isErr());
+
+    Ktx2File zstd;
+    zstd.supercompression = 2;
+    EXPECT_TRUE(parseKtx2(makeKtx2(zstd)).isErr());
+
+    Ktx2File levels;
+    levels.levels = 6; // 16x8 has 5
+    EXPECT_TRUE(parseKtx2(makeKtx2(levels)).isErr());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Decoding
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(Ktx2Test, SlicesTheLevelsOfANativeTexture)
+{
+    const std::vector<uint8_t> file = makeKtx2({});
+
+    auto chain = decodeTextureMips(file, 1);
+    ASSERT_TRUE(chain.isOk()) << chain.error();
+
+    const TextureMipChain& mips = chain.unwrap();
+    EXPECT_EQ(mips.format, TextureFormat::BC7);
+    EXPECT_EQ(mips.firstMip, 1u);
+    ASSERT_EQ(mips.mips.size(), 2u);
+    EXPECT_EQ(mips.mips[0].width, 8u);
+    EXPECT_EQ(mips.mips[0].height, 4u);
+    EXPECT_EQ(mips.mips[0].size, 2u * 16u);
+    EXPECT_EQ(mips.mips[1].size, 16u);
+    ASSERT_EQ(mips.texels.size(), 3u * 16u);
+    EXPECT_EQ(mips.texels.front(), 2u);
+    EXPECT_EQ(mips.texels.back(), 3u);
+
+    auto description = readTextureDescription(file);
+    ASSERT_TRUE(description.isOk());
+    EXPECT_EQ(description.unwrap().format, TextureFormat::BC7);
+    EXPECT_EQ(description.unwrap().mipLevels, 3u);
+}
+
+TEST(Ktx2Test, RejectsTheFormatsTheDeviceCannotSample)
+{
+    const std::vector<uint8_t> file = makeKtx2({});
+    const TextureFormat mobile[] = {TextureFormat::ETC2RGBA8, TextureFormat::ASTC4x4};
+    const TextureFormat desktop[] = {TextureFormat::BC7};
+
+    EXPECT_TRUE(decodeKtx2(file, 0, mobile).isErr());
+    EXPECT_TRUE(decodeKtx2(file, 0, desktop).isOk());
+}
+
+TEST(Ktx2Test, ChoosesTheBestTranscodeFormat)
+{
+    const TextureFormat mobile[] = {TextureFormat::ETC2RGB8, TextureFormat::ETC2RGBA8,
+                                    TextureFormat::ASTC4x4};
+    const TextureFormat desktop[] = {TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC7};
+    const TextureFormat etc2[] = {TextureFormat::ETC2RGB8, TextureFormat::ETC2RGBA8};
+    const TextureFormat bc[] = {TextureFormat::BC1, TextureFormat::BC3};
+
+    EXPECT_EQ(chooseTranscodeFormat(mobile, true), TextureFormat::ASTC4x4);
+    EXPECT_EQ(chooseTranscodeFormat(desktop, true), TextureFormat::BC7);
+    EXPECT_EQ(chooseTranscodeFormat(etc2, true), TextureFormat::ETC2RGBA8);
+    EXPECT_EQ(chooseTranscodeFormat(etc2, false), TextureFormat::ETC2RGB8);
+    EXPECT_EQ(chooseTranscodeFormat(bc, true), TextureFormat::BC3);
+    EXPECT_EQ(chooseTranscodeFormat(bc, false), TextureFormat::BC1);
+    EXPECT_EQ(chooseTranscodeFormat({}, true), TextureFormat::RGBA8);
+}
+
+#ifndef MOSAIC_HAS_BASISU
+TEST(Ktx2Test, FailsBasisTexturesWithoutTheTranscoder)
+{
+    Ktx2File uastc;
+    uastc.vkFormat = 0;
+    uastc.colorModel = k_colorModelUASTC;
+
+    EXPECT_TRUE(decodeKtx2(makeKtx2(uastc), 0, {}).isErr());
+    EXPECT_TRUE(readTextureDescription(makeKtx2(uastc)).isErr());
+}
+#endif
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <mosaic/graphics/light_clustering.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+constexpr uint32_t k_width = 1600;
+constexpr uint32_t k_height = 900;
+constexpr float k_zNear = 0.1f;
+constexpr float k_zFar = 100.0f;
+
+// glm::perspective of a 1 radian vertical field of view
+const float k_p11 = 1.0f / std::tan(0.5f);
+const float k_p00 = k_p11 * k_height / k_width;
+
+struct Lights
+{
+    std::vector<float> x, y, z, radius;
+
+    explicit Lights(size_t _count, uint32_t _seed = 3)
+    {
+        std::mt19937 random(_seed);
+        std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+        std::uniform_real_distribution<float> depth(-110.0f, 5.0f);
+        std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+        for (size_t i = 0; i < _count; ++i)
+        {
+            x.push_back(position(random));
+            y.push_back(position(random));
+            z.push_back(depth(random));
+            radius.push_back(size(random));
+        }
+    }
+
+    SphereColumns columns() const { return {x, y, z, radius}; }
+};
+
+// A frame ring over memory of the test
+struct Ring
+{
+    std::vector<std::byte> memory;
+    FrameRing ring;
+
+    explicit Ring(size_t _size) : memory(_size) { ring.reset(memory.data(), _size, 1); }
+};
+
+// The cluster of a view space point as the lighting shaders find it, -1 outside the view
+int64_t findCluster(const ClusterUniforms& _uniforms, float _x, float _y, float _z)
+{
+    const float ndcX = k_p00 * _x / -_z;
+    const float ndcY = k_p11 * _y / -_z;
+    if (_z >= 0.0f || std::abs(ndcX) >= 1.0f || std::abs(ndcY) >= 1.0f) return -1;
+
+    const auto tileX =
+        static_cast<int64_t>((ndcX * 0.5f + 0.5f) * k_width * _uniforms.tileScaleX);
+    const auto tileY =
+        static_cast<int64_t>((ndcY * 0.5f + 0.5f) * k_height * _uniforms.tileScaleY);
+    const auto slice = static_cast<int64_t>(
+        std::floor(std::log(-_z) * _uniforms.sliceScale + _uniforms.sliceBias));
+    if (slice < 0 || slice >= _uniforms.slices) return -1;
+
+    return (slice * _uniforms.tilesY + tileY) * _uniforms.tilesX + tileX;
+}
+
+std::vector<uint32_t> getLights(const LightClusterBuffers& _buffers, int64_t _cluster)
+{
+    LightCluster cluster;
+    std::memcpy(&cluster, _buffers.clusters.data + _cluster * sizeof(LightCluster),
+                sizeof(LightCluster));
+
+    std::vector<uint32_t> lights(cluster.count);
+    if (cluster.count > 0)
+    {
+        std::memcpy(lights.data(), _buffers.indices.data + cluster.offset * sizeof(uint32_t),
+                    cluster.count * sizeof(uint32_t));
+    }
+    return lights;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Projection
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(LightClusteringTest, RejectsEmptyGridsAndDepthRanges)
+{
+    LightClustering clustering;
+
+    EXPECT_THROW(clustering.setProjection({0, 9, 24}, k_p00, k_p11, k_zNear, k_zFar, k_width,
+                                          k_height),
+                 std::invalid_argument);
+    EXPECT_THROW(clustering.setProjection({}, k_p00, k_p11, 0.0f, k_zFar, k_width, k_height),
+                 std::invalid_argument);
+    EXPECT_THROW(clustering.setProjection({}, k_p00, k_p11, k_zFar, k_zNear, k_width, k_height),
+                 std::invalid_argument);
+
+    // nothing to assign to before a projection
+    Ring ring(1 << 16);
+    EXPECT_FALSE(clustering.assign(Lights(4).columns(), ring.ring));
+}
+
+TEST(LightClusteringTest, SlicesTheDepthExponentially)
+{
+    LightClustering clustering;
+    clustering.setProjection({}, k_p00, k_p11, k_zNear, k_zFar, k_width, k_height);
+
+    const ClusterUniforms& uniforms = clustering.getUniforms();
+    EXPECT_NEAR(std::log(k_zNear) * uniforms.sliceScale + uniforms.sliceBias, 0.0f, 1e-4f);
+    EXPECT_NEAR(std::log(k_zFar) * uniforms.sliceScale + uniforms.sliceBias, 24.0f, 1e-4f);
+
+    // each slice starts where the previous one ends, at a constant depth ratio
+    const float ratio = std::pow(k_zFar / k_zNear, 1.0f / 24.0f);
+    const Frustum first = clustering.getClusterFrustum(0, 0, 0);
+    const Frustum second = clustering.getClusterFrustum(0, 0, 1);
+    EXPECT_FLOAT_EQ(-first.planes[4][3], k_zNear);
+    EXPECT_FLOAT_EQ(first.planes[5][3], -second.planes[4][3]);
+    EXPECT_NEAR(second.planes[5][3] / first.planes[5][3], ratio, 1e-4f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Assignment
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(LightClusteringTest, TheClusterOfAPointHoldsEveryLightAroundIt)
+{
+    LightClustering clustering;
+    clustering.setProjection({}, k_p00, k_p11, k_zNear, k_zFar, k_width, k_height);
+
+    const Lights lights(300);
+    Ring ring(1 << 20);
+
+    const LightClusterBuffers buffers = clustering.assign(lights.columns(), ring.ring);
+    ASSERT_TRUE(buffers);
+
+    ClusterUniforms uniforms;
+    std::memcpy(&uniforms, buffers.uniforms.data, sizeof(ClusterUniforms));
+    EXPECT_EQ(uniforms.lightCount, 300u);
+    EXPECT_EQ(uniforms.firstCluster, buffers.clusters.offset / sizeof(LightCluster));
+    EXPECT_EQ(uniforms.firstIndex, buffers.indices.offset / sizeof(uint32_t));
+
+    // far fewer lights per cluster than in the scene, yet no light missing where it shines
+    EXPECT_LT(buffers.indexCount, 300u * clustering.getGrid().size() / 20);
+
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    size_t tested = 0;
+
+    for (size_t light = 0; light < lights.x.size(); ++light)
+    {
+        for (int sample = 0; sample < 8; ++sample)
+        {
+            const float scale = lights.radius[light] * 0.57f;
+            const float x = lights.x[light] + unit(random) * scale;
+            const float y = lights.y[light] + unit(random) * scale;
+            const float z = lights.z[light] + unit(random) * scale;
+
+            const int64_t cluster = findCluster(uniforms, x, y, z);
+            if (cluster < 0) continue;
+
+            const std::vector<uint32_t> inCluster = getLights(buffers, cluster);
+            EXPECT_TRUE(std::ranges::binary_search(inCluster, static_cast<uint32_t>(light)))
+                << "light " << light << " in cluster " << cluster;
+            ++tested;
+        }
+    }
+
+    EXPECT_GT(tested, 100u);
+}
+
+TEST(LightClusteringTest, ParallelAssignmentMatchesTheSerialOne)
+{
+    mosaic::core::CPUInfo cpuInfo;
+    cpuInfo.logicalCores = 8;
+    cpuInfo.physicalCores = 4;
+
+    auto pool = std::make_unique<mosaic::exec::ThreadPool>();
+    ASSERT_TRUE(pool->initialize(cpuInfo).isOk());
+
+    LightClustering serial;
+    LightClustering parallel;
+    serial.setProjection({8, 8, 16}, k_p00, -k_p11, k_zNear, k_zFar, k_width, k_height);
+    parallel.setProjection({8, 8, 16}, k_p00, -k_p11, k_zNear, k_zFar, k_width, k_height);
+
+    const Lights lights(1000, 5);
+    Ring serialRing(1 << 20);
+    Ring parallelRing(1 << 20);
+
+    // twice, the scratch of the first frame reused
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        serialRing.ring.beginFrame(0);
+        parallelRing.ring.beginFrame(0);
+
+        const LightClusterBuffers expected = serial.assign(lights.columns(), serialRing.ring);
+        const LightClusterBuffers actual =
+            parallel.assign(*pool, lights.columns(), parallelRing.ring);
+        ASSERT_TRUE(expected && actual);
+
+        ASSERT_EQ(actual.indexCount, expected.indexCount);
+        EXPECT_EQ(std::memcmp(actual.clusters.data, expected.clusters.data,
+                              expected.clusters.size),
+                  0);
+        EXPECT_EQ(std::memcmp(actual.indices.data, expected.indices.data,
+                              expected.indexCount * sizeof(uint32_t)),
+                  0);
+    }
+
+    pool->shutdown();
+}
+
+TEST(LightClusteringTest, ReturnsNothingWhenTheRingIsFull)
+{
+    LightClustering clustering;
+    clustering.setProjection({}, k_p00, k_p11, k_zNear, k_zFar, k_width, k_height);
+
+    // the clusters alone do not fit
+    Ring ring(1024);
+    const LightClusterBuffers buffers = clustering.assign(Lights(10).columns(), ring.ring);
+    EXPECT_FALSE(buffers);
+    EXPECT_EQ(buffers.indexCount, 0u);
+
+    // no lights still clears every cluster
+    Ring empty(1 << 16);
+    const LightClusterBuffers cleared = clustering.assign(SphereColumns{}, empty.ring);
+    ASSERT_TRUE(cleared);
+    EXPECT_EQ(cleared.indexCount, 0u);
+    EXPECT_TRUE(getLights(cleared, 0).empty());
+}
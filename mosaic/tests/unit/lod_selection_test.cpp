@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <mosaic/graphics/lod_selection.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Column-major, right-handed view looking down -Z, [0, 1] depth (glm::perspectiveRH_ZO)
+Frustum perspectiveFrustum()
+{
+    const float f = 1.0f / std::tan(0.5f);
+
+    std::array<float, 16> matrix = {};
+    matrix[0] = f / 1.5f;
+    matrix[5] = f;
+    matrix[10] = 100.0f / (0.1f - 100.0f);
+    matrix[11] = -1.0f;
+    matrix[14] = -(100.0f * 0.1f) / (100.0f - 0.1f);
+    return extractFrustum(matrix);
+}
+
+// Two LODs, the first down to a fifth of the viewport, then an impostor
+LodChain twoLodsAndImpostor()
+{
+    LodChain chain;
+    chain.minCoverage[0] = 0.2f;
+    chain.minCoverage[1] = 0.05f;
+    chain.lodCount = 2;
+    chain.impostor = true;
+    chain.impostorCoverage = 0.02f;
+    return chain;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tiers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(LodSelectionTest, SelectsTheTierOfTheCoverage)
+{
+    const LodChain chain = twoLodsAndImpostor();
+
+    EXPECT_EQ(selectLodTier(chain, 0.5f, std::nullopt, 0.1f), 0u);
+    EXPECT_EQ(selectLodTier(chain, 0.2f, std::nullopt, 0.1f), 0u);
+    EXPECT_EQ(selectLodTier(chain, 0.1f, std::nullopt, 0.1f), 1u);
+    EXPECT_EQ(selectLodTier(chain, 0.03f, std::nullopt, 0.1f), k_impostorTier);
+    EXPECT_EQ(selectLodTier(chain, 0.01f, std::nullopt, 0.1f), k_culledTier);
+
+    // the camera inside the bounds
+    BoundingSphere sphere;
+    sphere.radius = 1.0f;
+    EXPECT_EQ(selectLodTier(chain, getScreenCoverage(sphere, LodView{}), std::nullopt, 0.1f), 0u);
+
+    LodChain noImpostor = chain;
+    noImpostor.impostor = false;
+    EXPECT_EQ(selectLodTier(noImpostor, 0.03f, std::nullopt, 0.1f), k_culledTier);
+}
+
+TEST(LodSelectionTest, SwitchesTierOnlyPastTheHysteresis)
+{
+    const LodChain chain = twoLodsAndImpostor();
+
+    // coarser below 0.18, finer above 0.22
+    EXPECT_EQ(selectLodTier(chain, 0.19f, 0, 0.1f), 0u);
+    EXPECT_EQ(selectLodTier(chain, 0.17f, 0, 0.1f), 1u);
+    EXPECT_EQ(selectLodTier(chain, 0.21f, 1, 0.1f), 1u);
+    EXPECT_EQ(selectLodTier(chain, 0.23f, 1, 0.1f), 0u);
+
+    // several tiers at once, the thresholds on the way moved too
+    EXPECT_EQ(selectLodTier(chain, 0.046f, 0, 0.1f), 1u);
+    EXPECT_EQ(selectLodTier(chain, 0.04f, 0, 0.1f), k_impostorTier);
+    EXPECT_EQ(selectLodTier(chain, 0.0185f, k_impostorTier, 0.1f), k_impostorTier);
+    EXPECT_EQ(selectLodTier(chain, 0.021f, k_culledTier, 0.1f), k_culledTier);
+    EXPECT_EQ(selectLodTier(chain, 0.5f, k_culledTier, 0.1f), 0u);
+}
+
+TEST(LodSelectionTest, ChainsOfMeshLodsMatchSelectMeshLod)
+{
+    std::vector<MeshLod> lods(3);
+    lods[1].error = 0.01f;
+    lods[2].error = 0.04f;
+
+    const LodChain chain = makeLodChain(lods, 1.0f, 1000.0f, 1.0f, 0.005f);
+    ASSERT_EQ(chain.lodCount, 3u);
+    EXPECT_FLOAT_EQ(chain.minCoverage[0], 0.2f);
+    EXPECT_FLOAT_EQ(chain.minCoverage[1], 0.05f);
+    EXPECT_TRUE(chain.impostor);
+
+    // a projection[1][1] of 2: 1000 pixels a unit at a distance of 1
+    LodView view;
+    view.scale = 2.0f;
+
+    for (const float distance : {4.0f, 15.0f, 30.0f, 60.0f, 150.0f})
+    {
+        BoundingSphere sphere;
+        sphere.center = {0.0f, 0.0f, -distance};
+        sphere.radius = 1.0f;
+
+        const float coverage = getScreenCoverage(sphere, view);
+        EXPECT_EQ(selectLodTier(chain, coverage, std::nullopt, 0.0f),
+                  selectMeshLod(lods, distance, 1000.0f))
+            << distance;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Selector
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(LodSelectionTest, SelectorCullsThenKeepsTheTiersOfTheLastFrame)
+{
+    // 0.4, 0.1 and 0.033 of the viewport from the origin, a sphere too small, one behind
+    const std::vector<float> x = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    const std::vector<float> y = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    const std::vector<float> z = {-5.0f, -20.0f, -60.0f, -90.0f, 10.0f};
+    const std::vector<float> radius = {1.0f, 1.0f, 1.0f, 0.5f, 1.0f};
+    const SphereColumns spheres{x, y, z, radius};
+
+    const std::vector<uint32_t> chainOf(5, 0);
+    const std::vector<LodChain> chains = {twoLodsAndImpostor()};
+    const Frustum frustum = perspectiveFrustum();
+
+    LodView view;
+    view.scale = 2.0f;
+
+    LodSelector selector;
+    const auto drawn = selector.select(frustum, spheres, chainOf, chains, view);
+    ASSERT_EQ(drawn.size(), 3u);
+    EXPECT_EQ(drawn[0], 0u);
+    EXPECT_EQ(drawn[1], 1u);
+    EXPECT_EQ(drawn[2], 2u);
+    EXPECT_EQ(selector.getTier(0), 0u);
+    EXPECT_EQ(selector.getTier(1), 1u);
+    EXPECT_EQ(selector.getTier(2), k_impostorTier);
+    EXPECT_EQ(selector.getTier(3), k_culledTier);
+
+    // the first object at 0.19 of the viewport keeps its LOD, then switches at 0.167
+    view.position = {0.0f, 0.0f, 2.0f / 0.19f - 5.0f};
+    selector.select(frustum, spheres, chainOf, chains, view);
+    EXPECT_EQ(selector.getTier(0), 0u);
+
+    view.position = {0.0f, 0.0f, 7.0f};
+    selector.select(frustum, spheres, chainOf, chains, view);
+    EXPECT_EQ(selector.getTier(0), 1u);
+
+    // back to 0.21, finer only above 0.22
+    view.position = {0.0f, 0.0f, 2.0f / 0.21f - 5.0f};
+    selector.select(frustum, spheres, chainOf, chains, view);
+    EXPECT_EQ(selector.getTier(0), 1u);
+
+    // without its last tier, an object gets that of its coverage
+    selector.reset();
+    selector.select(frustum, spheres, chainOf, chains, view);
+    EXPECT_EQ(selector.getTier(0), 0u);
+}
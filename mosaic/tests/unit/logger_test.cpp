@@ -0,0 +1,356 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <mosaic/tools/logger.hpp>
+#include <mosaic/tools/logger_file_sink.hpp>
+
+using namespace mosaic::tools;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct Captured
+{
+    std::mutex mutex;
+    std::vector<std::string> messages;
+    std::vector<std::thread::id> writers;
+};
+
+// Keeps the messages it receives, and the threads that wrote them
+class CaptureSink final : public Sink
+{
+   private:
+    std::shared_ptr<Captured> m_captured;
+
+   public:
+    explicit CaptureSink(std::shared_ptr<Captured> _captured) : m_captured(std::move(_captured)) {}
+
+    pieces::RefResult<Sink, std::string> initialize() override
+    {
+        return pieces::OkRef<Sink, std::string>(*this);
+    }
+
+    void shutdown() override {}
+
+    void trace(const std::string& _message) const override { capture(_message); }
+    void debug(const std::string& _message) const override { capture(_message); }
+    void info(const std::string& _message) const override { capture(_message); }
+    void warn(const std::string& _message) const override { capture(_message); }
+    void error(const std::string& _message) const override { capture(_message); }
+    void critical(const std::string& _message) const override { capture(_message); }
+
+   private:
+    void capture(const std::string& _message) const
+    {
+        std::lock_guard<std::mutex> lock(m_captured->mutex);
+        m_captured->messages.push_back(_message);
+        m_captured->writers.push_back(std::this_thread::get_id());
+    }
+};
+
+// Formatted by fmt only, not copied into the records
+struct Point
+{
+    int x;
+    int y;
+};
+
+std::string readFile(const std::filesystem::path& _path)
+{
+    std::ifstream file(_path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+// The log files of the name, from an earlier run
+void removeLogFiles(const std::string& _name)
+{
+    if (!std::filesystem::exists(k_logsBasePath)) return;
+
+    for (const auto& entry : std::filesystem::directory_iterator(k_logsBasePath))
+    {
+        if (entry.path().filename().string().starts_with(_name + ".")) remove(entry.path());
+    }
+}
+
+} // namespace
+
+template <>
+struct fmt::formatter<Point> : fmt::formatter<std::string>
+{
+    auto format(const Point& _point, format_context& _context) const
+    {
+        return fmt::format_to(_context.out(), "({}, {})", _point.x, _point.y);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class AsyncLoggerTest : public ::testing::Test
+{
+   protected:
+    Logger* logger = nullptr;
+    std::shared_ptr<Captured> captured = std::make_shared<Captured>();
+
+    void SetUp() override
+    {
+        // the synchronous logger of the test main, restored after
+        Logger::shutdown();
+
+        // the bare messages
+        ASSERT_TRUE(Logger::initialize(Logger::Config(false, false, false, false,
+                                                      k_logHistorySize, true)));
+        logger = Logger::getInstance();
+        ASSERT_TRUE(logger->isAsync());
+        ASSERT_TRUE(logger->addSink("capture", CaptureSink(captured)));
+    }
+
+    void TearDown() override
+    {
+        Logger::shutdown();
+        Logger::initialize();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Asynchronous Mode Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(AsyncLoggerTest, RecordsAreFormattedAndWrittenByTheLoggingThreadInOrder)
+{
+    constexpr int k_threadCount = 4;
+    constexpr int k_iterations = 2000; // a ring of 1024 records, the callers wait
+
+    std::vector<std::jthread> threads;
+
+    for (int t = 0; t < k_threadCount; ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                const std::string name = "worker" + std::to_string(t);
+
+                for (int i = 0; i < k_iterations; ++i)
+                {
+                    logger->log(LogLevel::info, "{} {} {:.1f} {}", name.c_str(), i, 0.5, true);
+                }
+            });
+    }
+
+    threads.clear();
+    logger->flush();
+
+    std::lock_guard<std::mutex> lock(captured->mutex);
+    ASSERT_EQ(captured->messages.size(), size_t{k_threadCount * k_iterations});
+
+    std::vector<int> next(k_threadCount, 0);
+
+    for (size_t i = 0; i < captured->messages.size(); ++i)
+    {
+        EXPECT_NE(captured->writers[i], std::this_thread::get_id());
+
+        const std::string& message = captured->messages[i];
+        const int thread = message[6] - '0';
+
+        // in the order of each thread
+        ASSERT_EQ(message, fmt::format("worker{} {} 0.5 true", thread, next[thread]));
+        ++next[thread];
+    }
+}
+
+TEST_F(AsyncLoggerTest, OtherArgumentsAndLongMessagesAreFormattedByTheCaller)
+{
+    const std::string longText(2000, 'x');
+
+    logger->log(LogLevel::warn, "{} at {}", std::string("point"), Point{1, 2});
+    logger->log(LogLevel::warn, "long {}", longText);
+    logger->log(LogLevel::info, "view {}", std::string_view("text"));
+
+    // the history of the caller is written by the logging thread
+    logger->flush();
+
+    const auto history = logger->getHistory();
+    ASSERT_EQ(history.size(), 3u);
+    EXPECT_EQ(history[0], "point at (1, 2)");
+    // truncated in the history only
+    EXPECT_EQ(history[1], ("long " + longText).substr(0, k_logHistoryEntrySize - 2));
+    EXPECT_EQ(history[2], "view text");
+}
+
+TEST_F(AsyncLoggerTest, CriticalMessagesAreWrittenBeforeTheCallReturns)
+{
+    logger->log(LogLevel::info, "before");
+    logger->log(LogLevel::critical, "failure {}", 42);
+
+    std::lock_guard<std::mutex> lock(captured->mutex);
+    ASSERT_EQ(captured->messages.size(), 2u);
+    EXPECT_EQ(captured->messages[1], "failure 42");
+}
+
+TEST_F(AsyncLoggerTest, HistoriesAreRingsPerThreadKeptAfterTheThreadExits)
+{
+    logger->setHistorySize(8);
+
+    std::thread::id workerId;
+
+    std::jthread(
+        [&]
+        {
+            workerId = std::this_thread::get_id();
+
+            for (int i = 0; i < 20; ++i) logger->log(LogLevel::info, "worker {}", i);
+        })
+        .join();
+
+    logger->log(LogLevel::info, "main");
+    logger->flush();
+
+    // the oldest overwritten
+    const auto histories = logger->getHistories();
+    const auto worker = std::ranges::find(histories, workerId, &LogThreadHistory::tid);
+
+    ASSERT_NE(worker, histories.end());
+    EXPECT_TRUE(worker->exited);
+    ASSERT_EQ(worker->messages.size(), 8u);
+    EXPECT_EQ(worker->messages.front(), "worker 12");
+    EXPECT_EQ(worker->messages.back(), "worker 19");
+
+    ASSERT_EQ(logger->getHistory(), std::vector<std::string>{"main"});
+
+    logger->clearHistory();
+    EXPECT_TRUE(logger->getHistory().empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Macro Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(AsyncLoggerTest, DisabledLevelsDoNotEvaluateTheArguments)
+{
+    int evaluated = 0;
+
+    logger->enableLevel(LogLevel::warn, false);
+    MOSAIC_WARN("skipped {}", ++evaluated);
+    MOSAIC_LOG_EVERY_N(warn, 1, "skipped {}", ++evaluated);
+
+    logger->enableLevel(LogLevel::warn, true);
+    MOSAIC_WARN("logged {}", ++evaluated);
+
+    logger->flush();
+
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(logger->getHistory(), std::vector<std::string>{"logged 1"});
+}
+
+TEST_F(AsyncLoggerTest, RateLimitedSitesCountTheMessagesTheySuppress)
+{
+    int evaluated = 0;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        MOSAIC_LOG_EVERY_N(warn, 4, "every {}", i);
+    }
+
+    // a window of an hour, a single message
+    for (int i = 0; i < 10; ++i)
+    {
+        MOSAIC_LOG_RATE_LIMITED(warn, 3'600'000, "limited {}", ++evaluated);
+    }
+
+    logger->flush();
+
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(logger->getHistory(),
+              (std::vector<std::string>{"every 0", "every 4 (3 similar messages suppressed)",
+                                        "every 8 (3 similar messages suppressed)", "limited 1"}));
+
+    // the next message of a site reports the calls suppressed since its last
+    LogLimiter limiter;
+    uint64_t suppressed = 0;
+
+    ASSERT_TRUE(limiter.every(std::chrono::milliseconds(20), suppressed));
+    EXPECT_EQ(suppressed, 0u);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_FALSE(limiter.every(std::chrono::milliseconds(20), suppressed));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+    ASSERT_TRUE(limiter.every(std::chrono::milliseconds(20), suppressed));
+    EXPECT_EQ(suppressed, 5u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// File Sink Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FileSinkTest, BatchesAreBufferedUntilAThresholdAndRotatedPastTheSizeLimit)
+{
+    removeLogFiles("logger_test");
+
+    FileSink::Config config;
+    config.name = "logger_test";
+    config.bufferSize = 4096;
+    config.flushIntervalMs = 60'000;
+    config.maxFileSize = 16 * 1024;
+    config.maxFiles = 2;
+
+    FileSink sink(config);
+    ASSERT_TRUE(sink.initialize().isOk());
+
+    const std::filesystem::path path = sink.getPath();
+    const std::string line(99, 'x'); // 100 bytes with the newline
+
+    std::vector<LogEntry> batch(10, LogEntry{LogLevel::info, line});
+    sink.writeBatch(batch);
+
+    // below the buffer size
+    EXPECT_TRUE(readFile(path).empty());
+
+    // 1000 lines of 100 bytes: the files hold 16 KB, 2 rotated files are kept
+    for (int i = 0; i < 99; ++i) sink.writeBatch(batch);
+    sink.flush();
+
+    EXPECT_TRUE(std::filesystem::exists(std::filesystem::path(k_logsBasePath) /
+                                        "logger_test.1.log"));
+    EXPECT_TRUE(std::filesystem::exists(std::filesystem::path(k_logsBasePath) /
+                                        "logger_test.2.log"));
+    EXPECT_FALSE(std::filesystem::exists(std::filesystem::path(k_logsBasePath) /
+                                         "logger_test.3.log"));
+    EXPECT_LE(std::filesystem::file_size(path), config.maxFileSize);
+
+    // written out at once
+    sink.critical("logger_test critical");
+    EXPECT_TRUE(readFile(path).ends_with("logger_test critical\n"));
+
+    sink.shutdown();
+
+    // the file of this session is rotated by the next one
+    FileSink next(config);
+    ASSERT_TRUE(next.initialize().isOk());
+    EXPECT_TRUE(readFile(path).empty());
+    EXPECT_TRUE(readFile(std::filesystem::path(k_logsBasePath) / "logger_test.1.log")
+                    .ends_with("logger_test critical\n"));
+
+    next.shutdown();
+    removeLogFiles("logger_test");
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include <mosaic/graphics/memory_budget.hpp>
+
+using namespace mosaic::graphics;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint64_t k_MiB = 1024 * 1024;
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pressure
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MemoryBudgetTest, ThePressureRisesWithTheShareOfTheBudget)
+{
+    EXPECT_EQ(getMemoryPressure(0, 1000 * k_MiB), MemoryPressure::Normal);
+    EXPECT_EQ(getMemoryPressure(849 * k_MiB, 1000 * k_MiB), MemoryPressure::Normal);
+    EXPECT_EQ(getMemoryPressure(850 * k_MiB, 1000 * k_MiB), MemoryPressure::High);
+    EXPECT_EQ(getMemoryPressure(950 * k_MiB, 1000 * k_MiB), MemoryPressure::Critical);
+    EXPECT_EQ(getMemoryPressure(1200 * k_MiB, 1000 * k_MiB), MemoryPressure::Critical);
+
+    MemoryBudgetSettings settings;
+    settings.highUsage = 0.5f;
+    settings.criticalUsage = 0.75f;
+    EXPECT_EQ(getMemoryPressure(600 * k_MiB, 1000 * k_MiB, settings), MemoryPressure::High);
+
+    // no budget reported: nothing to compare against
+    EXPECT_EQ(getMemoryPressure(600 * k_MiB, 0), MemoryPressure::Normal);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Streaming
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MemoryBudgetTest, TheStreamingKeepsWhatTheWatermarkLeavesTheOthers)
+{
+    // 300 MiB of other resources under a 850 MiB watermark
+    EXPECT_EQ(getStreamingBudget(500 * k_MiB, 1000 * k_MiB, 200 * k_MiB), 550 * k_MiB);
+
+    // the others grew past the watermark: everything streamed is evicted
+    EXPECT_EQ(getStreamingBudget(1100 * k_MiB, 1000 * k_MiB, 200 * k_MiB), 0u);
+    EXPECT_EQ(getStreamingBudget(850 * k_MiB, 1000 * k_MiB, 0), 0u);
+
+    // streamed bytes not reported in the usage yet
+    EXPECT_EQ(getStreamingBudget(100 * k_MiB, 1000 * k_MiB, 200 * k_MiB), 850 * k_MiB);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Load
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MemoryBudgetTest, ALowLoadFrameLeavesHalfItsInterval)
+{
+    EXPECT_TRUE(isLowLoadFrame(4ms, 8ms, 16ms));
+    EXPECT_FALSE(isLowLoadFrame(4ms, 9ms, 16ms));
+    EXPECT_FALSE(isLowLoadFrame(12ms, 2ms, 16ms));
+
+    // no interval measured yet
+    EXPECT_FALSE(isLowLoadFrame(0ms, 0ms, 0ms));
+
+    MemoryBudgetSettings settings;
+    settings.lowLoad = 0.25f;
+    EXPECT_FALSE(isLowLoadFrame(4ms, 8ms, 16ms, settings));
+}
@@ -0,0 +1,378 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <mosaic/graphics/mesh.hpp>
+#include <mosaic/graphics/mesh_cook.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct Mesh
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// A UV sphere of _rings x _segments quads, its normals its positions
+Mesh makeSphere(uint32_t _rings, uint32_t _segments)
+{
+    Mesh mesh;
+    for (uint32_t ring = 0; ring <= _rings; ++ring)
+    {
+        const float theta = 3.14159265f * static_cast<float>(ring) / static_cast<float>(_rings);
+        for (uint32_t segment = 0; segment <= _segments; ++segment)
+        {
+            const float phi =
+                2.0f * 3.14159265f * static_cast<float>(segment) / static_cast<float>(_segments);
+
+            MeshVertex& vertex = mesh.vertices.emplace_back();
+            vertex.position = {std::sin(theta) * std::cos(phi), std::cos(theta),
+                               std::sin(theta) * std::sin(phi)};
+            vertex.normal = vertex.position;
+            vertex.uv = {static_cast<float>(segment) / static_cast<float>(_segments),
+                         static_cast<float>(ring) / static_cast<float>(_rings)};
+        }
+    }
+
+    for (uint32_t ring = 0; ring < _rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment < _segments; ++segment)
+        {
+            const uint32_t a = ring * (_segments + 1) + segment;
+            const uint32_t b = a + _segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+
+    return mesh;
+}
+
+void shuffleTriangles(std::vector<uint32_t>& _indices)
+{
+    std::vector<std::array<uint32_t, 3>> triangles(_indices.size() / 3);
+    std::memcpy(triangles.data(), _indices.data(), _indices.size() * sizeof(uint32_t));
+
+    std::mt19937 rng(42);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+    std::memcpy(_indices.data(), triangles.data(), _indices.size() * sizeof(uint32_t));
+}
+
+// The triangles, each rotated to its smallest index (the winding kept), sorted
+std::vector<std::array<uint32_t, 3>> getTriangles(const std::vector<uint32_t>& _indices)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < _indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> triangle = {_indices[i], _indices[i + 1], _indices[i + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()),
+                    triangle.end());
+        triangles.push_back(triangle);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+template <typename T>
+std::vector<T> readSection(const std::vector<uint8_t>& _file, const MeshSection& _section)
+{
+    std::vector<T> values(_section.size / sizeof(T));
+    std::memcpy(values.data(), _file.data() + _section.offset, _section.size);
+    return values;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Index optimization
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MeshCookTest, OptimizesForTheVertexCache)
+{
+    Mesh mesh = makeSphere(32, 64);
+    shuffleTriangles(mesh.indices);
+
+    const auto triangles = getTriangles(mesh.indices);
+    const float before = getAcmr(mesh.indices, mesh.vertices.size());
+
+    optimizeVertexCache(mesh.indices, mesh.vertices.size());
+
+    const float after = getAcmr(mesh.indices, mesh.vertices.size());
+    EXPECT_LT(after, before * 0.5f);
+    EXPECT_LT(after, 1.0f);
+    EXPECT_EQ(getTriangles(mesh.indices), triangles);
+}
+
+TEST(MeshCookTest, OptimizesForOverdrawWithinTheThreshold)
+{
+    Mesh mesh = makeSphere(32, 64);
+    shuffleTriangles(mesh.indices);
+    optimizeVertexCache(mesh.indices, mesh.vertices.size());
+
+    const auto triangles = getTriangles(mesh.indices);
+    const float before = getAcmr(mesh.indices, mesh.vertices.size());
+
+    optimizeOverdraw(mesh.indices, mesh.vertices, 1.05f);
+
+    // the clusters restart the cache, a little worse at most
+    EXPECT_LE(getAcmr(mesh.indices, mesh.vertices.size()), before * 1.25f);
+    EXPECT_EQ(getTriangles(mesh.indices), triangles);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Simplification
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MeshCookTest, SimplifiesByVertexClustering)
+{
+    const Mesh mesh = makeSphere(32, 64);
+
+    // cells smaller than the edges: nothing merges
+    EXPECT_EQ(getTriangles(simplifyMesh(mesh.indices, mesh.vertices, 1e-4f)).size(),
+              getTriangles(mesh.indices).size() - 2 * 64); // the poles are degenerate
+
+    const std::vector<uint32_t> coarse = simplifyMesh(mesh.indices, mesh.vertices, 0.25f);
+    EXPECT_GT(coarse.size(), 0u);
+    EXPECT_LT(coarse.size(), mesh.indices.size() / 4);
+    EXPECT_TRUE(
+        std::ranges::all_of(coarse, [&](uint32_t _i) { return _i < mesh.vertices.size(); }));
+
+    for (size_t i = 0; i < coarse.size(); i += 3)
+    {
+        EXPECT_NE(coarse[i], coarse[i + 1]);
+        EXPECT_NE(coarse[i + 1], coarse[i + 2]);
+        EXPECT_NE(coarse[i], coarse[i + 2]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cooking
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MeshCookTest, CooksAQuantizedMeshWithALodChain)
+{
+    const Mesh mesh = makeSphere(32, 64);
+
+    auto cooked = cookMesh(mesh.vertices, mesh.indices);
+    ASSERT_TRUE(cooked.isOk()) << cooked.error();
+    const std::vector<uint8_t>& file = cooked.unwrap();
+
+    auto parsed = parseMesh(file);
+    ASSERT_TRUE(parsed.isOk()) << parsed.error();
+    const MeshData& data = parsed.unwrap();
+
+    EXPECT_EQ(data.header.vertexCount, mesh.vertices.size());
+    EXPECT_EQ(data.payload.offset + data.payload.size, file.size());
+    EXPECT_NEAR(data.header.bounds.radius, 1.0f, 1e-3f);
+
+    // coarser and coarser, about half the triangles each
+    ASSERT_GE(data.lods.size(), 3u);
+    EXPECT_EQ(data.lods[0].indexCount, mesh.indices.size());
+    EXPECT_FLOAT_EQ(data.lods[0].error, 0.0f);
+    for (size_t lod = 1; lod < data.lods.size(); ++lod)
+    {
+        EXPECT_LE(data.lods[lod].indexCount, data.lods[lod - 1].indexCount / 2 + 3);
+        EXPECT_GT(data.lods[lod].error, data.lods[lod - 1].error);
+    }
+
+    // the vertices within a step of the quantization
+    const std::vector<PackedVertex> vertices = readSection<PackedVertex>(file, data.vertices);
+    const std::vector<uint32_t> indices = readSection<uint32_t>(file, data.indices);
+    ASSERT_EQ(indices.size(), data.header.indexCount);
+    EXPECT_TRUE(std::ranges::all_of(indices, [&](uint32_t _i) { return _i < vertices.size(); }));
+
+    for (const PackedVertex& vertex : vertices)
+    {
+        const std::array<float, 3> position = unpackPosition(data.header, vertex);
+        const std::array<float, 3> normal = unpackNormal(vertex);
+        const std::array<float, 2> uv = unpackUv(vertex);
+
+        const float length = std::sqrt(position[0] * position[0] + position[1] * position[1] +
+                                       position[2] * position[2]);
+        EXPECT_NEAR(length, 1.0f, 1e-4f);
+
+        // the normal of the sphere is its position
+        for (size_t axis = 0; axis < 3; ++axis) EXPECT_NEAR(normal[axis], position[axis], 1e-3f);
+
+        EXPECT_GE(uv[0], 0.0f);
+        EXPECT_LE(uv[1], 1.0f);
+    }
+
+    // the finest LOD reads the vertices in order
+    uint32_t next = 0;
+    for (size_t i = 0; i < data.lods[0].indexCount; ++i)
+    {
+        ASSERT_LE(indices[i], next);
+        if (indices[i] == next) ++next;
+    }
+}
+
+TEST(MeshCookTest, BuildsMeshletsOfEveryLod)
+{
+    const Mesh mesh = makeSphere(32, 64);
+
+    MeshCookSettings settings;
+    settings.meshlets = true;
+    settings.maxMeshletVertices = 64;
+    settings.maxMeshletTriangles = 124;
+
+    auto cooked = cookMesh(mesh.vertices, mesh.indices, settings);
+    ASSERT_TRUE(cooked.isOk()) << cooked.error();
+    const std::vector<uint8_t>& file = cooked.unwrap();
+
+    auto parsed = parseMesh(file);
+    ASSERT_TRUE(parsed.isOk()) << parsed.error();
+    const MeshData& data = parsed.unwrap();
+
+    const std::vector<uint32_t> indices = readSection<uint32_t>(file, data.indices);
+    const std::vector<Meshlet> meshlets = readSection<Meshlet>(file, data.meshlets);
+    const std::vector<uint32_t> meshletVertices = readSection<uint32_t>(file, data.meshletVertices);
+    const std::vector<uint8_t> meshletTriangles =
+        readSection<uint8_t>(file, data.meshletTriangles);
+
+    for (const MeshLod& lod : data.lods)
+    {
+        ASSERT_GT(lod.meshletCount, 0u);
+
+        // the meshlets of a LOD are its triangles
+        std::vector<uint32_t> triangles;
+        for (uint32_t m = lod.firstMeshlet; m < lod.firstMeshlet + lod.meshletCount; ++m)
+        {
+            const Meshlet& meshlet = meshlets[m];
+            EXPECT_LE(meshlet.vertexCount, settings.maxMeshletVertices);
+            EXPECT_LE(meshlet.triangleCount, settings.maxMeshletTriangles);
+            EXPECT_EQ(meshlet.triangleOffset % 4, 0u);
+
+            for (uint32_t t = 0; t < meshlet.triangleCount * 3; ++t)
+            {
+                const uint8_t local = meshletTriangles[meshlet.triangleOffset + t];
+                ASSERT_LT(local, meshlet.vertexCount);
+                triangles.push_back(meshletVertices[meshlet.vertexOffset + local]);
+            }
+        }
+
+        const std::vector<uint32_t> lodIndices(indices.begin() + lod.firstIndex,
+                                               indices.begin() + lod.firstIndex + lod.indexCount);
+        EXPECT_EQ(getTriangles(triangles), getTriangles(lodIndices));
+    }
+}
+
+TEST(MeshCookTest, BoundsTheNormalsOfAMeshletByItsCone)
+{
+    const Mesh mesh = makeSphere(32, 64);
+
+    MeshCookSettings settings;
+    settings.meshlets = true;
+    settings.maxLods = 1;
+
+    auto cooked = cookMesh(mesh.vertices, mesh.indices, settings);
+    ASSERT_TRUE(cooked.isOk()) << cooked.error();
+    const std::vector<uint8_t>& file = cooked.unwrap();
+    const MeshData data = parseMesh(file).unwrap();
+
+    const std::vector<PackedVertex> vertices = readSection<PackedVertex>(file, data.vertices);
+    const std::vector<Meshlet> meshlets = readSection<Meshlet>(file, data.meshlets);
+    const std::vector<uint32_t> meshletVertices = readSection<uint32_t>(file, data.meshletVertices);
+    const std::vector<uint8_t> meshletTriangles =
+        readSection<uint8_t>(file, data.meshletTriangles);
+
+    uint32_t culling = 0;
+    for (const Meshlet& meshlet : meshlets)
+    {
+        if (meshlet.coneCutoff >= 1.0f) continue;
+        ++culling;
+
+        // within the cone: the cosine to the axis at least that of the half angle
+        const float minDot = std::sqrt(1.0f - meshlet.coneCutoff * meshlet.coneCutoff);
+        for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+        {
+            std::array<std::array<float, 3>, 3> corners;
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint8_t local = meshletTriangles[meshlet.triangleOffset + t * 3 + k];
+                const uint32_t vertex = meshletVertices[meshlet.vertexOffset + local];
+                corners[k] = unpackPosition(data.header, vertices[vertex]);
+            }
+
+            std::array<float, 3> u, v;
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                u[axis] = corners[1][axis] - corners[0][axis];
+                v[axis] = corners[2][axis] - corners[0][axis];
+            }
+            const std::array<float, 3> normal = {u[1] * v[2] - u[2] * v[1],
+                                                 u[2] * v[0] - u[0] * v[2],
+                                                 u[0] * v[1] - u[1] * v[0]};
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] +
+                                           normal[2] * normal[2]);
+            if (!(length > 0.0f)) continue;
+
+            const float cosine = (normal[0] * meshlet.coneAxis[0] +
+                                  normal[1] * meshlet.coneAxis[1] +
+                                  normal[2] * meshlet.coneAxis[2]) /
+                                 length;
+            EXPECT_GE(cosine, minDot - 1e-4f);
+        }
+    }
+
+    // the patches of a finely tessellated sphere are nearly flat
+    EXPECT_GT(culling, meshlets.size() / 2);
+}
+
+TEST(MeshCookTest, RejectsWhatIsNotATriangleList)
+{
+    const Mesh mesh = makeSphere(4, 4);
+
+    EXPECT_TRUE(cookMesh(mesh.vertices, {}).isErr());
+
+    std::vector<uint32_t> indices = mesh.indices;
+    indices.pop_back();
+    EXPECT_TRUE(cookMesh(mesh.vertices, indices).isErr());
+
+    indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+    EXPECT_TRUE(cookMesh(mesh.vertices, indices).isErr());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loading
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MeshTest, RejectsMalformedFiles)
+{
+    const Mesh mesh = makeSphere(8, 16);
+    std::vector<uint8_t> file = cookMesh(mesh.vertices, mesh.indices).unwrap();
+
+    std::vector<uint8_t> truncated(file.begin(), file.end() - 1);
+    EXPECT_TRUE(parseMesh(truncated).isErr());
+    EXPECT_TRUE(parseMesh(std::span(file).first(sizeof(MeshFileHeader) - 1)).isErr());
+
+    file[0] ^= 0xFF;
+    EXPECT_TRUE(parseMesh(file).isErr());
+}
+
+TEST(MeshTest, SelectsTheCoarsestLodWithinAPixel)
+{
+    std::vector<MeshLod> lods(3);
+    lods[1].error = 0.01f;
+    lods[2].error = 0.1f;
+
+    // 1000 pixels a unit at a distance of 1
+    EXPECT_EQ(selectMeshLod(lods, 1.0f, 1000.0f), 0u);
+    EXPECT_EQ(selectMeshLod(lods, 10.0f, 1000.0f), 1u);
+    EXPECT_EQ(selectMeshLod(lods, 100.0f, 1000.0f), 2u);
+    EXPECT_EQ(selectMeshLod(lods, 10.0f, 1000.0f, 100.0f), 2u);
+    EXPECT_EQ(selectMeshLod(std::span<const MeshLod>(lods).first(1), 100.0f, 1000.0f), 0u);
+}
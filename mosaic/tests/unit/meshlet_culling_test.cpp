@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <mosaic/graphics/meshlet_culling.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Column-major, right-handed view looking down -Z, [0, 1] depth (glm::perspectiveRH_ZO)
+std::array<float, 16> perspective(float _fovY, float _aspect, float _zNear, float _zFar)
+{
+    const float f = 1.0f / std::tan(_fovY * 0.5f);
+
+    std::array<float, 16> matrix = {};
+    matrix[0] = f / _aspect;
+    matrix[5] = f;
+    matrix[10] = _zFar / (_zNear - _zFar);
+    matrix[11] = -1.0f;
+    matrix[14] = -(_zFar * _zNear) / (_zFar - _zNear);
+    return matrix;
+}
+
+std::array<float, 16> scaleTranslation(float _x, float _y, float _z, float _scale = 1.0f)
+{
+    std::array<float, 16> matrix = {};
+    matrix[0] = matrix[5] = matrix[10] = _scale;
+    matrix[12] = _x;
+    matrix[13] = _y;
+    matrix[14] = _z;
+    matrix[15] = 1.0f;
+    return matrix;
+}
+
+// A meshlet of radius 1 at _center, its triangles within 10 degrees of _axis
+Meshlet meshletAt(float _x, float _y, float _z, std::array<float, 3> _axis = {0.0f, 0.0f, 1.0f})
+{
+    Meshlet meshlet;
+    meshlet.bounds = {{_x, _y, _z}, 1.0f};
+    meshlet.coneAxis = _axis;
+    meshlet.coneCutoff = std::sin(10.0f * 3.14159265f / 180.0f);
+    return meshlet;
+}
+
+// The camera at the origin looking down -Z
+MeshletCullUniforms cameraUniforms()
+{
+    MeshletCullUniforms uniforms;
+    uniforms.frustum = extractFrustum(perspective(1.5707963f, 1.0f, 0.1f, 100.0f)).planes;
+    uniforms.cameraPosition = {0.0f, 0.0f, 0.0f};
+    return uniforms;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cones
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MeshletCullingTest, CullsMeshletsFacingAwayFromTheCamera)
+{
+    const Meshlet meshlet = meshletAt(0.0f, 0.0f, 0.0f);
+
+    // the normals along +Z, seen from behind
+    EXPECT_TRUE(isMeshletBackfacing(meshlet.bounds, meshlet.coneAxis, meshlet.coneCutoff,
+                                    {0.0f, 0.0f, -10.0f}));
+    EXPECT_FALSE(isMeshletBackfacing(meshlet.bounds, meshlet.coneAxis, meshlet.coneCutoff,
+                                     {0.0f, 0.0f, 10.0f}));
+
+    // edge on, and from within the sphere
+    EXPECT_FALSE(isMeshletBackfacing(meshlet.bounds, meshlet.coneAxis, meshlet.coneCutoff,
+                                     {10.0f, 0.0f, 0.0f}));
+    EXPECT_FALSE(isMeshletBackfacing(meshlet.bounds, meshlet.coneAxis, meshlet.coneCutoff,
+                                     {0.0f, 0.0f, -0.5f}));
+
+    // a cone of 1 never culls
+    EXPECT_FALSE(isMeshletBackfacing(meshlet.bounds, meshlet.coneAxis, 1.0f,
+                                     {0.0f, 0.0f, -10.0f}));
+}
+
+TEST(MeshletCullingTest, TransformsConesByRotationAndUniformScale)
+{
+    const Meshlet meshlet = meshletAt(0.0f, 0.0f, 0.0f);
+
+    // a quarter turn about +Y and a scale of 2: +Z to +X
+    std::array<float, 16> world = scaleTranslation(5.0f, 0.0f, 0.0f);
+    world[0] = 0.0f;
+    world[2] = -2.0f;
+    world[5] = 2.0f;
+    world[8] = 2.0f;
+    world[10] = 0.0f;
+
+    std::array<float, 3> axis;
+    ASSERT_TRUE(transformMeshletCone(world, meshlet, axis));
+    EXPECT_NEAR(axis[0], 1.0f, 1e-6f);
+    EXPECT_NEAR(axis[1], 0.0f, 1e-6f);
+    EXPECT_NEAR(axis[2], 0.0f, 1e-6f);
+
+    // stretched, the normals leave the cone
+    std::array<float, 16> stretched = scaleTranslation(0.0f, 0.0f, 0.0f);
+    stretched[0] = 3.0f;
+    EXPECT_FALSE(transformMeshletCone(stretched, meshlet, axis));
+
+    Meshlet wide = meshlet;
+    wide.coneCutoff = 1.0f;
+    EXPECT_FALSE(transformMeshletCone(scaleTranslation(0.0f, 0.0f, 0.0f), wide, axis));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tasks and culling
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MeshletCullingTest, SplitsTheMeshletsOfInstancesInTasks)
+{
+    std::vector<MeshletInstance> instances(3);
+    instances[0].firstMeshlet = 10;
+    instances[0].meshletCount = 2 * k_meshletTaskSize + 6;
+    instances[1].meshletCount = 0;
+    instances[2].firstMeshlet = 4;
+    instances[2].meshletCount = k_meshletTaskSize;
+
+    std::vector<MeshletTask> tasks = {MeshletTask{}};
+    buildMeshletTasks(instances, tasks);
+
+    ASSERT_EQ(tasks.size(), 4u);
+    EXPECT_EQ(tasks[0].instance, 0u);
+    EXPECT_EQ(tasks[0].firstMeshlet, 10u);
+    EXPECT_EQ(tasks[0].meshletCount, k_meshletTaskSize);
+    EXPECT_EQ(tasks[1].firstMeshlet, 10u + k_meshletTaskSize);
+    EXPECT_EQ(tasks[2].firstMeshlet, 10u + 2 * k_meshletTaskSize);
+    EXPECT_EQ(tasks[2].meshletCount, 6u);
+    EXPECT_EQ(tasks[3].instance, 2u);
+    EXPECT_EQ(tasks[3].firstMeshlet, 4u);
+    EXPECT_EQ(tasks[3].meshletCount, k_meshletTaskSize);
+}
+
+TEST(MeshletCullingTest, KeepsTheMeshletsInTheFrustumFacingTheCamera)
+{
+    // in object space around the instance, 10 units in front of the camera
+    const std::vector<Meshlet> meshlets = {
+        meshletAt(0.0f, 0.0f, 0.0f),                      // facing the camera
+        meshletAt(0.0f, 0.0f, 0.0f, {0.0f, 0.0f, -1.0f}), // facing away
+        meshletAt(0.0f, 0.0f, 30.0f),                     // behind the camera
+        meshletAt(0.0f, 2.0f, 0.0f, {1.0f, 0.0f, 0.0f}),  // edge on
+    };
+    const std::array<std::span<const Meshlet>, 1> meshes = {meshlets};
+
+    std::vector<MeshletInstance> instances(1);
+    instances[0].world = scaleTranslation(0.0f, 0.0f, -10.0f);
+    instances[0].meshletCount = static_cast<uint32_t>(meshlets.size());
+
+    std::vector<MeshletTask> tasks;
+    buildMeshletTasks(instances, tasks);
+
+    MeshletCullUniforms uniforms = cameraUniforms();
+    std::vector<VisibleMeshlet> visible(4);
+
+    ASSERT_EQ(cullMeshlets(uniforms, instances, meshes, tasks, visible), 2u);
+    EXPECT_EQ(visible[0].instance, 0u);
+    EXPECT_EQ(visible[0].meshlet, 0u);
+    EXPECT_EQ(visible[1].meshlet, 3u);
+
+    // without the cone test the back of the mesh is drawn too
+    uniforms.flags = 0;
+    ASSERT_EQ(cullMeshlets(uniforms, instances, meshes, tasks, visible), 3u);
+    EXPECT_EQ(visible[1].meshlet, 1u);
+
+    // past the capacity the meshlets are counted, not written
+    std::vector<VisibleMeshlet> one(1);
+    EXPECT_EQ(cullMeshlets(uniforms, instances, meshes, tasks, one), 3u);
+    EXPECT_EQ(one[0].meshlet, 0u);
+}
+
+TEST(MeshletCullingTest, SkipsTasksOutOfTheScene)
+{
+    const std::vector<Meshlet> meshlets = {meshletAt(0.0f, 0.0f, 0.0f)};
+    const std::array<std::span<const Meshlet>, 1> meshes = {meshlets};
+
+    std::vector<MeshletInstance> instances(2);
+    instances[0].world = scaleTranslation(0.0f, 0.0f, -10.0f);
+    instances[1].world = instances[0].world;
+    instances[1].mesh = 1; // no such mesh
+
+    const std::vector<MeshletTask> tasks = {{0, 0, 4, 0}, {1, 0, 1, 0}, {2, 0, 1, 0}};
+    std::vector<VisibleMeshlet> visible(4);
+
+    // the meshlets past those of the mesh, and the missing instance and mesh, are skipped
+    EXPECT_EQ(cullMeshlets(cameraUniforms(), instances, meshes, tasks, visible), 1u);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <mosaic/graphics/gpu_culling.hpp>
+#include <mosaic/graphics/occlusion_culling.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+constexpr std::array<float, 16> k_identity = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                                              0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+// A square wall facing the camera at depth _z, its half extent _size
+struct Wall
+{
+    std::vector<float> positions;
+    std::vector<uint32_t> indices = {0, 1, 2, 2, 3, 0};
+
+    Wall(float _size, float _z)
+        : positions{-_size, -_size, _z, _size, -_size, _z, _size, _size, _z, -_size, _size, _z}
+    {
+    }
+};
+
+// The camera at the origin looking down -Z, 90 degrees wide and 2:1 as the buffer
+OcclusionBuffer makeBuffer()
+{
+    OcclusionBuffer buffer(64, 32);
+    buffer.begin(k_identity, 1.0f, 2.0f, 0.1f);
+    return buffer;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Rasterization
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(OcclusionCullingTest, RasterizesTheFarthestDepthOfTheOccluders)
+{
+    OcclusionBuffer buffer = makeBuffer();
+
+    const Wall wall(2.0f, -5.0f);
+    buffer.rasterize(wall.positions, wall.indices, k_identity);
+
+    // reversed winding, nearer: drawn too, and the nearest wins
+    const Wall nearWall(0.5f, -2.0f);
+    const std::vector<uint32_t> reversed = {0, 2, 1, 0, 3, 2};
+    buffer.rasterize(nearWall.positions, reversed, k_identity);
+    buffer.finish();
+
+    EXPECT_FLOAT_EQ(buffer.getDepth(32, 16), 0.1f / 2.0f);
+    EXPECT_FLOAT_EQ(buffer.getDepth(32 + 8, 16), 0.1f / 5.0f);
+    EXPECT_FLOAT_EQ(buffer.getDepth(0, 0), 0.0f);
+
+    // each level the farthest of the texels it covers, down to a texel
+    ASSERT_EQ(buffer.getLevelCount(), 7u);
+    EXPECT_FLOAT_EQ(buffer.getDepth(10, 4, 2), 0.1f / 5.0f);
+    EXPECT_FLOAT_EQ(buffer.getDepth(0, 0, 6), 0.0f);
+}
+
+TEST(OcclusionCullingTest, SkipsOccludersCrossingTheNearPlane)
+{
+    OcclusionBuffer buffer = makeBuffer();
+
+    std::vector<float> positions = {-1.0f, -1.0f, -5.0f, 1.0f, -1.0f, -5.0f, 0.0f, 1.0f, 1.0f};
+    buffer.rasterize(positions, std::vector<uint32_t>{0, 1, 2}, k_identity);
+    buffer.finish();
+
+    for (uint32_t y = 0; y < buffer.getHeight(); ++y)
+    {
+        for (uint32_t x = 0; x < buffer.getWidth(); ++x) ASSERT_EQ(buffer.getDepth(x, y), 0.0f);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Occlusion
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(OcclusionCullingTest, OccludesTheSpheresBehindTheWall)
+{
+    OcclusionBuffer buffer = makeBuffer();
+
+    const Wall wall(2.0f, -5.0f);
+    buffer.rasterize(wall.positions, wall.indices, k_identity);
+    buffer.finish();
+
+    EXPECT_TRUE(buffer.isOccluded({{0.0f, 0.0f, -10.0f}, 1.0f}));
+    EXPECT_TRUE(buffer.isOccluded({{0.0f, 0.0f, -50.0f}, 5.0f}));
+
+    // in front, beside, half behind, through the wall
+    EXPECT_FALSE(buffer.isOccluded({{0.0f, 0.0f, -3.0f}, 1.0f}));
+    EXPECT_FALSE(buffer.isOccluded({{8.0f, 0.0f, -10.0f}, 1.0f}));
+    EXPECT_FALSE(buffer.isOccluded({{4.0f, 0.0f, -10.0f}, 1.0f}));
+    EXPECT_FALSE(buffer.isOccluded({{0.0f, 0.0f, -5.5f}, 1.0f}));
+
+    // crossing the near plane, behind the camera
+    EXPECT_FALSE(buffer.isOccluded({{0.0f, 0.0f, 0.0f}, 1.0f}));
+    EXPECT_FALSE(buffer.isOccluded({{0.0f, 0.0f, 10.0f}, 1.0f}));
+}
+
+TEST(OcclusionCullingTest, NothingIsOccludedWithoutOccluders)
+{
+    OcclusionBuffer buffer = makeBuffer();
+    buffer.finish();
+
+    EXPECT_FALSE(buffer.isOccluded({{0.0f, 0.0f, -10.0f}, 1.0f}));
+    EXPECT_FALSE(buffer.isOccluded({{0.0f, 0.0f, -1000.0f}, 0.1f}));
+
+    // begin() clears the occluders of the previous frame
+    const Wall wall(2.0f, -5.0f);
+    buffer.rasterize(wall.positions, wall.indices, k_identity);
+    buffer.finish();
+    ASSERT_TRUE(buffer.isOccluded({{0.0f, 0.0f, -10.0f}, 1.0f}));
+
+    buffer.begin(k_identity, 1.0f, 2.0f, 0.1f);
+    buffer.finish();
+    EXPECT_FALSE(buffer.isOccluded({{0.0f, 0.0f, -10.0f}, 1.0f}));
+}
+
+TEST(OcclusionCullingTest, CullsTheOccludedInstancesOfTheDraws)
+{
+    OcclusionBuffer buffer = makeBuffer();
+
+    // the world matrix moves the wall of the origin in front of the camera
+    const Wall wall(2.0f, 0.0f);
+    std::array<float, 16> world = k_identity;
+    world[14] = -5.0f;
+    buffer.rasterize(wall.positions, wall.indices, world);
+    buffer.finish();
+
+    const std::vector<CullDraw> draws = {{36, 0, 0, 4}};
+    std::vector<IndexedIndirectCommand> commands(draws.size());
+    std::vector<uint32_t> visible(buildIndirectCommands(draws, commands));
+    std::vector<IndexedIndirectCommand> compacted(draws.size());
+
+    std::vector<CullInstance> instances(3);
+    instances[0].bounds = {{0.0f, 0.0f, -10.0f}, 1.0f};
+    instances[0].instanceIndex = 10;
+    instances[1].bounds = {{0.0f, 0.0f, -3.0f}, 1.0f};
+    instances[1].instanceIndex = 11;
+    instances[2].bounds = {{8.0f, 0.0f, -10.0f}, 1.0f};
+    instances[2].instanceIndex = 12;
+
+    // 90 degrees horizontally, half vertically as the buffer's p11
+    Frustum frustum;
+    frustum.planes = {{{0.7071068f, 0.0f, -0.7071068f, 0.0f},
+                       {-0.7071068f, 0.0f, -0.7071068f, 0.0f},
+                       {0.0f, 0.8944272f, -0.4472136f, 0.0f},
+                       {0.0f, -0.8944272f, -0.4472136f, 0.0f},
+                       {0.0f, 0.0f, -1.0f, -0.1f},
+                       {0.0f, 0.0f, 1.0f, 1000.0f}}};
+
+    ASSERT_EQ(cullInstances(frustum, instances, draws, commands, visible, compacted, &buffer), 1u);
+    EXPECT_EQ(compacted[0].instanceCount, 2u);
+    EXPECT_EQ(visible[0], 11u);
+    EXPECT_EQ(visible[1], 12u);
+}
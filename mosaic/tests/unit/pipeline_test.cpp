@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <mosaic/graphics/pipeline.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+PipelineDescription makeDescription()
+{
+    PipelineDescription description;
+    description.shaders.push_back({ShaderStage::Vertex, {0x03, 0x02, 0x23, 0x07}, "main", "vs"});
+    description.shaders.push_back({ShaderStage::Fragment, {0x03, 0x02, 0x23, 0x08}, "main", "fs"});
+    description.vertexLayout.attributes.push_back({"position", TextureFormat::RGBA16F, 0, 0});
+    description.vertexLayout.stride = 8;
+    description.debugName = "Opaque";
+
+    return description;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Hash Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(PipelineTest, EqualDescriptionsHashTheSameWhateverTheirNames)
+{
+    PipelineDescription renamed = makeDescription();
+    renamed.debugName = "Opaque (copy)";
+    renamed.shaders[0].debugName = "other vs";
+    renamed.vertexLayout.attributes[0].name = "pos";
+
+    EXPECT_EQ(hashPipelineDescription(makeDescription()), hashPipelineDescription(renamed));
+}
+
+TEST(PipelineTest, EveryStateChangesTheHash)
+{
+    const uint64_t base = hashPipelineDescription(makeDescription());
+
+    const auto hashWith = [](auto _change)
+    {
+        PipelineDescription description = makeDescription();
+        _change(description);
+        return hashPipelineDescription(description);
+    };
+
+    EXPECT_NE(base, hashWith([](auto& _d) { _d.shaders[1].bytecode.back() = 0x09; }));
+    EXPECT_NE(base, hashWith([](auto& _d) { _d.shaders[0].entryPoint = "vsMain"; }));
+    EXPECT_NE(base, hashWith([](auto& _d) { _d.vertexLayout.stride = 16; }));
+    EXPECT_NE(base, hashWith([](auto& _d) { _d.rasterState.cullMode = CullMode::None; }));
+    EXPECT_NE(base, hashWith([](auto& _d) { _d.depthState.depthWriteEnable = false; }));
+    EXPECT_NE(base, hashWith([](auto& _d) { _d.blendState.enable = true; }));
+    EXPECT_NE(base, hashWith([](auto& _d) { _d.topology = PrimitiveTopology::LineList; }));
+
+    // the same bytes split differently between the shaders
+    EXPECT_NE(base, hashWith(
+                        [](auto& _d)
+                        {
+                            _d.shaders[0].bytecode.push_back(0x03);
+                            _d.shaders[1].bytecode.erase(_d.shaders[1].bytecode.begin());
+                        }));
+}
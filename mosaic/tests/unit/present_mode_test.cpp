@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <vector>
+
+#include <mosaic/graphics/present_mode.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Policies
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(PresentModeTest, EveryPolicyPicksItsPreferredModeWhenSupported)
+{
+    const std::array<PresentMode, 4> all = {PresentMode::Fifo, PresentMode::Immediate,
+                                            PresentMode::FifoRelaxed, PresentMode::Mailbox};
+
+    EXPECT_EQ(choosePresentMode(PresentPolicy::LowLatency, all), PresentMode::Mailbox);
+    EXPECT_EQ(choosePresentMode(PresentPolicy::VSync, all), PresentMode::Fifo);
+    EXPECT_EQ(choosePresentMode(PresentPolicy::PowerSave, all), PresentMode::FifoRelaxed);
+    EXPECT_EQ(choosePresentMode(PresentPolicy::Uncapped, all), PresentMode::Immediate);
+}
+
+TEST(PresentModeTest, FallsBackToTheNextSupportedMode)
+{
+    // a typical mobile surface
+    const std::vector<PresentMode> fifoOnly = {PresentMode::Fifo};
+    EXPECT_EQ(choosePresentMode(PresentPolicy::LowLatency, fifoOnly), PresentMode::Fifo);
+    EXPECT_EQ(choosePresentMode(PresentPolicy::PowerSave, fifoOnly), PresentMode::Fifo);
+    EXPECT_EQ(choosePresentMode(PresentPolicy::Uncapped, fifoOnly), PresentMode::Fifo);
+
+    const std::vector<PresentMode> mailbox = {PresentMode::Fifo, PresentMode::Mailbox};
+    EXPECT_EQ(choosePresentMode(PresentPolicy::Uncapped, mailbox), PresentMode::Mailbox);
+
+    // FIFO is guaranteed, even when a backend does not report it
+    EXPECT_EQ(choosePresentMode(PresentPolicy::VSync, {}), PresentMode::Fifo);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <mosaic/graphics/readback.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// What the GPU would copy at the offset of _readback
+void writeCopy(std::vector<std::byte>& _memory, const Readback& _readback, uint8_t _value)
+{
+    std::memset(_memory.data() + _readback.offset, _value, _readback.size);
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Ring
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ReadbackRingTest, CompletesTheCopiesOnceTheirFrameCompleted)
+{
+    std::vector<std::byte> memory(1024);
+
+    ReadbackRing ring;
+    ring.reset(memory.data(), memory.size());
+
+    Readback first = ring.allocate(4, 1);
+    Readback second = ring.allocate(8, 2, 256);
+
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+    EXPECT_EQ(first.offset, 0u);
+    EXPECT_EQ(second.offset, 256u);
+
+    writeCopy(memory, first, 0xAB);
+    writeCopy(memory, second, 0xCD);
+
+    // frames later, never before their frame completed
+    ring.complete(0);
+    EXPECT_FALSE(first.future.isReady());
+
+    ring.complete(1);
+    ASSERT_TRUE(first.future.isReady());
+    EXPECT_FALSE(second.future.isReady());
+    EXPECT_EQ(first.future.get(), std::vector<std::byte>(4, std::byte{0xAB}));
+
+    ring.complete(5);
+    ASSERT_TRUE(second.future.isReady());
+    EXPECT_EQ(second.future.get(), std::vector<std::byte>(8, std::byte{0xCD}));
+    EXPECT_EQ(ring.getPendingCount(), 0u);
+}
+
+TEST(ReadbackRingTest, RefusesCopiesWhenFullAndWrapsAroundOnceFreed)
+{
+    std::vector<std::byte> memory(256);
+
+    ReadbackRing ring;
+    ring.reset(memory.data(), memory.size());
+
+    Readback first = ring.allocate(128, 1);
+    Readback second = ring.allocate(96, 2);
+
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+
+    // no room past the head, none before the tail: refused, nothing waits
+    EXPECT_FALSE(ring.allocate(64, 2));
+    EXPECT_FALSE(ring.allocate(512, 2));
+    EXPECT_FALSE(ring.allocate(0, 2));
+
+    ring.complete(1);
+
+    // wrapped before the copy still in flight
+    Readback wrapped = ring.allocate(64, 3);
+    ASSERT_TRUE(wrapped);
+    EXPECT_EQ(wrapped.offset, 0u);
+
+    Readback between = ring.allocate(64, 3);
+    ASSERT_TRUE(between);
+    EXPECT_EQ(between.offset, 64u);
+    EXPECT_FALSE(ring.allocate(16, 3));
+
+    ring.complete(3);
+    EXPECT_TRUE(second.future.isReady());
+    EXPECT_TRUE(wrapped.future.isReady());
+    EXPECT_TRUE(between.future.isReady());
+
+    // empty again, from the start
+    Readback whole = ring.allocate(256, 4);
+    ASSERT_TRUE(whole);
+    EXPECT_EQ(whole.offset, 0u);
+}
+
+TEST(ReadbackRingTest, BreaksTheCopiesInFlightWhenCancelled)
+{
+    std::vector<std::byte> memory(64);
+
+    ReadbackRing ring;
+    ring.reset(memory.data(), memory.size());
+
+    Readback readback = ring.allocate(16, 1);
+    ASSERT_TRUE(readback);
+
+    ring.cancel();
+
+    ASSERT_TRUE(readback.future.isReady());
+    EXPECT_THROW(readback.future.get(), mosaic::exec::FutureException);
+    EXPECT_EQ(ring.getPendingCount(), 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Picking
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ReadbackPickingTest, ClampsTheRegionAroundTheClick)
+{
+    const PickRegion inside = getPickRegion({100, 50}, {1920, 1080});
+    EXPECT_EQ(inside.offset, glm::uvec2(98, 48));
+    EXPECT_EQ(inside.extent, glm::uvec2(5, 5));
+
+    const PickRegion corner = getPickRegion({0, 1079}, {1920, 1080});
+    EXPECT_EQ(corner.offset, glm::uvec2(0, 1077));
+    EXPECT_EQ(corner.extent, glm::uvec2(3, 3));
+
+    EXPECT_EQ(getPickRegion({5, 5}, {16, 16}, 0).getTexelCount(), 1u);
+    EXPECT_TRUE(getPickRegion({1920, 0}, {1920, 1080}).empty());
+}
+
+TEST(ReadbackPickingTest, PicksTheEntityClosestToTheClick)
+{
+    const PickRegion region = getPickRegion({2, 2}, {16, 16}, 2);
+
+    // row by row, 0 where nothing was drawn
+    std::vector<uint32_t> ids(region.getTexelCount(), 0);
+    EXPECT_EQ(findPickedEntity(ids, region, {2, 2}), 0u);
+
+    ids[0] = 7;  // a corner
+    ids[11] = 9; // next to the click
+    EXPECT_EQ(findPickedEntity(ids, region, {2, 2}), 9u);
+
+    ids[12] = 4; // under it
+    EXPECT_EQ(findPickedEntity(ids, region, {2, 2}), 4u);
+
+    // fewer ids than the region: a bad readback picks nothing
+    EXPECT_EQ(findPickedEntity(std::span(ids).first(3), region, {2, 2}), 0u);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include <mosaic/scene/render_extraction.hpp>
+
+using namespace mosaic::scene;
+using namespace mosaic::ecs;
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class RenderExtractionTest : public ::testing::Test
+{
+   protected:
+    std::unique_ptr<ComponentRegistry> m_compRegistry;
+    std::unique_ptr<EntityRegistry> m_entityRegistry;
+
+    void SetUp() override
+    {
+        m_compRegistry = std::make_unique<ComponentRegistry>(16);
+
+        m_compRegistry->registerComponent<TransformComponent>("Transform");
+        m_compRegistry->registerComponent<MeshComponent>("Mesh");
+        m_compRegistry->registerComponent<MaterialComponent>("Material");
+
+        m_entityRegistry = std::make_unique<EntityRegistry>(m_compRegistry.get());
+    }
+
+    EntityMeta createMesh(float _x, uint32_t _mesh)
+    {
+        return m_entityRegistry->createEntity<TransformComponent, MeshComponent>(
+            std::make_tuple(glm::vec3(_x, 0.0f, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                            glm::vec3(1.0f)),
+            std::make_tuple(_mesh));
+    }
+
+    EntityMeta createMesh(float _x, uint32_t _mesh, uint32_t _material)
+    {
+        return m_entityRegistry->createEntity<TransformComponent, MeshComponent,
+                                              MaterialComponent>(
+            std::make_tuple(glm::vec3(_x, 0.0f, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                            glm::vec3(1.0f)),
+            std::make_tuple(_mesh), std::make_tuple(_material));
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Extraction
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(RenderExtractionTest, BatchesTheMeshEntitiesByMeshAndMaterial)
+{
+    createMesh(1.0f, 4, 2);
+    createMesh(2.0f, 4);
+    createMesh(3.0f, 4, 2);
+    m_entityRegistry->createEntity<MeshComponent>(); // no transform, not drawn
+
+    RenderExtraction extraction(*m_entityRegistry);
+    ASSERT_TRUE(extraction.update());
+
+    const auto batches = extraction.getBatcher().getBatches();
+    ASSERT_EQ(batches.size(), 2u);
+    EXPECT_EQ(batches[0].material, 0u);
+    EXPECT_EQ(batches[0].instanceCount, 1u);
+    EXPECT_EQ(batches[1].mesh, 4u);
+    EXPECT_EQ(batches[1].material, 2u);
+    EXPECT_EQ(batches[1].instanceCount, 2u);
+
+    // the dirty transforms were composed
+    const auto instances = extraction.getBatcher().getInstances();
+    EXPECT_FLOAT_EQ(instances[0].world[12], 2.0f);
+    EXPECT_FLOAT_EQ(instances[1].world[0], 1.0f);
+    EXPECT_FLOAT_EQ(instances[1].world[12] + instances[2].world[12], 4.0f);
+}
+
+TEST_F(RenderExtractionTest, RebuildsOnlyWhenTheMeshEntitiesChange)
+{
+    const EntityMeta moved = createMesh(1.0f, 1);
+    const EntityMeta destroyed = createMesh(2.0f, 1);
+
+    RenderExtraction extraction(*m_entityRegistry);
+    EXPECT_TRUE(extraction.update());
+
+    // the creations were made in this tick, the next one sees them again
+    m_entityRegistry->advanceTick();
+    EXPECT_TRUE(extraction.update());
+    m_entityRegistry->advanceTick();
+    EXPECT_FALSE(extraction.update());
+    EXPECT_FALSE(extraction.update());
+
+    auto components = m_entityRegistry->getComponentsForEntity<TransformComponent>(moved.id);
+    ASSERT_TRUE(components.has_value());
+    TransformComponent& transform = std::get<0>(*components);
+    transform.position = glm::vec3(5.0f, 0.0f, 0.0f);
+    transform.dirty = true;
+    m_entityRegistry->markChanged<TransformComponent>(moved.id);
+
+    EXPECT_TRUE(extraction.update());
+    EXPECT_FLOAT_EQ(extraction.getBatcher().getInstances()[0].world[12], 5.0f);
+
+    m_entityRegistry->advanceTick();
+    extraction.update();
+    m_entityRegistry->advanceTick();
+    EXPECT_FALSE(extraction.update());
+
+    // the last row of the archetype: only the count changes
+    m_entityRegistry->destroyEntity(destroyed.id);
+    EXPECT_TRUE(extraction.update());
+    EXPECT_EQ(extraction.getBatcher().getInstances().size(), 1u);
+}
+
+TEST_F(RenderExtractionTest, EmitsTheCachedBatchesEveryFrame)
+{
+    for (int i = 0; i < 8; ++i) createMesh(static_cast<float>(i), i % 2);
+
+    RenderExtraction extraction(*m_entityRegistry);
+    extraction.update();
+
+    std::vector<std::byte> memory(4096);
+    FrameRing ring;
+    ring.reset(memory.data(), 4096, 1);
+
+    DrawQueue queue;
+    const auto resolve = [](const InstanceBatch& _batch)
+    {
+        DrawCall call;
+        call.indexCount = 6;
+        call.sortKey = _batch.mesh;
+        return std::optional<DrawCall>(call);
+    };
+
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        ring.beginFrame(0);
+        queue.clear();
+
+        EXPECT_EQ(extraction.emit(ring, queue, 3, resolve), 2u);
+        EXPECT_EQ(queue.getCalls()[0].instanceCount, 4u);
+        EXPECT_EQ(queue.getCalls()[1].firstInstance, 4u);
+        EXPECT_EQ(ring.getUsed(), 8u * sizeof(InstanceData));
+    }
+}
@@ -0,0 +1,566 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <mosaic/graphics/render_graph.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+TextureDescription makeTexture(uint32_t _size, TextureFormat _format)
+{
+    return {_size, _size, 1, _format, TextureUsage::RenderTarget};
+}
+
+// One byte per texel, aligned on 256 bytes
+RenderGraph::MemoryRequirements texelRequirements(RenderGraphResource,
+                                                  const TextureDescription& _desc)
+{
+    return {size_t{_desc.width} * _desc.height, 256};
+}
+
+const RenderGraphBarrier* findBarrier(const RenderGraph& _graph, const std::string& _pass,
+                                      RenderGraphResource _resource)
+{
+    for (const auto& pass : _graph.getPasses())
+    {
+        if (pass.name != _pass) continue;
+
+        auto it = std::ranges::find(pass.barriers, _resource, &RenderGraphBarrier::resource);
+        return it != pass.barriers.end() ? &*it : nullptr;
+    }
+
+    return nullptr;
+}
+
+std::vector<std::string> executedPasses(const RenderGraph& _graph)
+{
+    std::vector<std::string> names;
+    for (const uint32_t pass : _graph.getExecutionOrder())
+    {
+        names.push_back(_graph.getPasses()[pass].name);
+    }
+
+    return names;
+}
+
+// Shadows, G-buffer, lighting, bloom and the post pass to the backbuffer, with a debug view
+// nothing reads
+struct DeferredGraph
+{
+    RenderGraph graph;
+
+    RenderGraphResource backbuffer;
+    RenderGraphResource shadowMap;
+    RenderGraphResource albedo;
+    RenderGraphResource depth;
+    RenderGraphResource hdr;
+    RenderGraphResource bloom;
+
+    DeferredGraph()
+    {
+        backbuffer = graph.importTexture("Backbuffer", makeTexture(1024, TextureFormat::BGRA8),
+                                         ResourceAccess::None, ResourceAccess::Present);
+
+        graph.addPass(
+            "Shadows",
+            [&](RenderGraphBuilder& _builder)
+            {
+                const auto shadowDescription = makeTexture(2048, TextureFormat::Depth32F);
+
+                shadowMap = _builder.create("Shadow map", shadowDescription);
+                _builder.write(shadowMap, ResourceAccess::DepthAttachment, AttachmentLoad::Clear);
+            },
+            {});
+
+        graph.addPass(
+            "G-buffer",
+            [&](RenderGraphBuilder& _builder)
+            {
+                albedo = _builder.create("Albedo", makeTexture(1024, TextureFormat::RGBA8));
+                depth = _builder.create("Depth", makeTexture(1024, TextureFormat::Depth32F));
+
+                _builder.write(albedo, ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+                _builder.write(depth, ResourceAccess::DepthAttachment, AttachmentLoad::Clear);
+            },
+            {});
+
+        graph.addPass(
+            "Lighting",
+            [&](RenderGraphBuilder& _builder)
+            {
+                _builder.read(shadowMap);
+                _builder.read(albedo);
+
+                hdr = _builder.create("HDR", makeTexture(1024, TextureFormat::RGBA16F));
+                _builder.write(hdr, ResourceAccess::ColorAttachment, AttachmentLoad::DontCare);
+            },
+            {});
+
+        graph.addPass(
+            "Debug view",
+            [&](RenderGraphBuilder& _builder)
+            {
+                _builder.read(albedo);
+
+                auto view = _builder.create("Debug", makeTexture(1024, TextureFormat::RGBA8));
+                _builder.write(view, ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+            },
+            {});
+
+        graph.addPass(
+            "Bloom",
+            [&](RenderGraphBuilder& _builder)
+            {
+                _builder.read(hdr);
+
+                bloom = _builder.create("Bloom", makeTexture(1024, TextureFormat::RGBA16F));
+                _builder.write(bloom, ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+            },
+            {});
+
+        graph.addPass(
+            "Post",
+            [&](RenderGraphBuilder& _builder)
+            {
+                _builder.read(hdr);
+                _builder.read(bloom);
+                _builder.write(backbuffer, ResourceAccess::ColorAttachment,
+                               AttachmentLoad::DontCare);
+            },
+            {});
+    }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Culling Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(RenderGraphTest, PassesNothingReadsAreCulled)
+{
+    DeferredGraph deferred;
+    deferred.graph.compile(texelRequirements);
+
+    EXPECT_EQ(executedPasses(deferred.graph),
+              (std::vector<std::string>{"Shadows", "G-buffer", "Lighting", "Bloom", "Post"}));
+    EXPECT_TRUE(deferred.graph.getPasses()[3].culled);
+}
+
+TEST(RenderGraphTest, OverwrittenContentsDoNotKeepTheirWriters)
+{
+    RenderGraph graph;
+    auto target = graph.importTexture("Target", makeTexture(64, TextureFormat::RGBA8),
+                                      ResourceAccess::None, ResourceAccess::Sampled);
+    RenderGraphResource scratch;
+
+    graph.addPass(
+        "Discarded",
+        [&](RenderGraphBuilder& _builder)
+        {
+            scratch = _builder.create("Scratch", makeTexture(64, TextureFormat::RGBA8));
+            _builder.write(scratch);
+        },
+        {});
+    graph.addPass(
+        "Cleared", [&](RenderGraphBuilder& _builder)
+        { _builder.write(scratch, ResourceAccess::ColorAttachment, AttachmentLoad::Clear); },
+        {});
+    graph.addPass(
+        "Resolve",
+        [&](RenderGraphBuilder& _builder)
+        {
+            _builder.read(scratch);
+            _builder.write(target, ResourceAccess::TransferDestination, AttachmentLoad::Clear);
+        },
+        {});
+    graph.addPass(
+        "Readback", [&](RenderGraphBuilder& _builder)
+        { _builder.setSideEffects(); }, {});
+
+    graph.compile();
+
+    // the first write of the scratch cannot reach the target
+    EXPECT_EQ(executedPasses(graph),
+              (std::vector<std::string>{"Cleared", "Resolve", "Readback"}));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Barrier Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(RenderGraphTest, BarriersTransitionTheTexturesBetweenTheirAccesses)
+{
+    DeferredGraph deferred;
+    const RenderGraph& graph = deferred.graph;
+    deferred.graph.compile(texelRequirements);
+
+    const auto* shadowWrite = findBarrier(graph, "Shadows", deferred.shadowMap);
+    ASSERT_NE(shadowWrite, nullptr);
+    EXPECT_EQ(shadowWrite->before, ResourceAccess::None);
+    EXPECT_EQ(shadowWrite->after, ResourceAccess::DepthAttachment);
+    EXPECT_TRUE(shadowWrite->discard);
+
+    const auto* shadowRead = findBarrier(graph, "Lighting", deferred.shadowMap);
+    ASSERT_NE(shadowRead, nullptr);
+    EXPECT_EQ(shadowRead->before, ResourceAccess::DepthAttachment);
+    EXPECT_EQ(shadowRead->after, ResourceAccess::Sampled);
+    EXPECT_FALSE(shadowRead->discard);
+
+    // sampled by the bloom already, nothing to wait for
+    EXPECT_NE(findBarrier(graph, "Bloom", deferred.hdr), nullptr);
+    EXPECT_EQ(findBarrier(graph, "Post", deferred.hdr), nullptr);
+
+    const auto* backbuffer = findBarrier(graph, "Post", deferred.backbuffer);
+    ASSERT_NE(backbuffer, nullptr);
+    EXPECT_EQ(backbuffer->before, ResourceAccess::None);
+    EXPECT_TRUE(backbuffer->discard);
+
+    ASSERT_EQ(graph.getFinalBarriers().size(), 1u);
+    EXPECT_EQ(graph.getFinalBarriers()[0].resource, deferred.backbuffer);
+    EXPECT_EQ(graph.getFinalBarriers()[0].before, ResourceAccess::ColorAttachment);
+    EXPECT_EQ(graph.getFinalBarriers()[0].after, ResourceAccess::Present);
+}
+
+TEST(RenderGraphTest, ContentsNoLaterPassReadsAreNotStored)
+{
+    DeferredGraph deferred;
+    deferred.graph.compile(texelRequirements);
+
+    const auto& gbuffer = deferred.graph.getPasses()[1];
+    const auto storeOf = [&](RenderGraphResource _resource)
+    {
+        return std::ranges::find(gbuffer.accesses, _resource, &RenderGraphAccess::resource)
+            ->storeContents;
+    };
+
+    EXPECT_TRUE(storeOf(deferred.albedo));
+    EXPECT_FALSE(storeOf(deferred.depth));
+
+    // the depth never leaves tile memory, the albedo is sampled by the lighting
+    EXPECT_TRUE(deferred.graph.getResource(deferred.depth).memoryless);
+    EXPECT_FALSE(deferred.graph.getResource(deferred.albedo).memoryless);
+    EXPECT_FALSE(deferred.graph.getResource(deferred.backbuffer).memoryless);
+}
+
+TEST(RenderGraphTest, ReadingATransientBeforeItIsWrittenThrows)
+{
+    RenderGraph graph;
+    auto target = graph.importTexture("Target", makeTexture(64, TextureFormat::RGBA8),
+                                      ResourceAccess::None, ResourceAccess::Present);
+    RenderGraphResource texture;
+
+    graph.addPass(
+        "Broken",
+        [&](RenderGraphBuilder& _builder)
+        {
+            texture = _builder.create("Never written", makeTexture(64, TextureFormat::RGBA8));
+            _builder.read(texture);
+            _builder.write(target);
+        },
+        {});
+
+    EXPECT_THROW(graph.compile(), std::invalid_argument);
+
+    // one access per texture and pass
+    graph.addPass(
+        "Twice",
+        [&](RenderGraphBuilder& _builder)
+        {
+            _builder.write(target);
+            EXPECT_THROW(_builder.read(target), std::invalid_argument);
+        },
+        {});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Subpass Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(RenderGraphTest, InputAttachmentReadsMergeThePassesIntoSubpasses)
+{
+    RenderGraph graph;
+    auto backbuffer = graph.importTexture("Backbuffer", makeTexture(512, TextureFormat::BGRA8),
+                                          ResourceAccess::None, ResourceAccess::Present);
+    RenderGraphResource albedo;
+    RenderGraphResource depth;
+
+    graph.addPass(
+        "G-buffer",
+        [&](RenderGraphBuilder& _builder)
+        {
+            albedo = _builder.create("Albedo", makeTexture(512, TextureFormat::RGBA8));
+            depth = _builder.create("Depth", makeTexture(512, TextureFormat::Depth32F));
+
+            _builder.write(albedo, ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+            _builder.write(depth, ResourceAccess::DepthAttachment, AttachmentLoad::Clear);
+        },
+        {});
+    graph.addPass(
+        "Lighting",
+        [&](RenderGraphBuilder& _builder)
+        {
+            _builder.read(albedo, ResourceAccess::InputAttachment);
+            _builder.read(depth, ResourceAccess::DepthRead);
+            _builder.write(backbuffer, ResourceAccess::ColorAttachment, AttachmentLoad::DontCare);
+        },
+        {});
+
+    graph.compile(texelRequirements);
+
+    const auto& gbuffer = graph.getPasses()[0];
+    const auto& lighting = graph.getPasses()[1];
+    EXPECT_EQ(gbuffer.renderPass, 0u);
+    EXPECT_EQ(gbuffer.subpass, 0u);
+    EXPECT_EQ(lighting.renderPass, 0u);
+    EXPECT_EQ(lighting.subpass, 1u);
+
+    // no barrier inside the render pass: that of the backbuffer before it begins
+    EXPECT_TRUE(lighting.barriers.empty());
+    const auto* backbufferWrite = findBarrier(graph, "G-buffer", backbuffer);
+    ASSERT_NE(backbufferWrite, nullptr);
+    EXPECT_EQ(backbufferWrite->after, ResourceAccess::ColorAttachment);
+    EXPECT_EQ(graph.getResource(backbuffer).firstPass, 0u);
+
+    // the G-buffer stays in tile memory
+    EXPECT_TRUE(graph.getResource(albedo).memoryless);
+    EXPECT_TRUE(graph.getResource(depth).memoryless);
+    EXPECT_FALSE(std::ranges::find(lighting.accesses, albedo, &RenderGraphAccess::resource)
+                     ->storeContents);
+}
+
+TEST(RenderGraphTest, InputAttachmentsNoSubpassWroteThrow)
+{
+    RenderGraph graph;
+    auto target = graph.importTexture("Target", makeTexture(64, TextureFormat::RGBA8),
+                                      ResourceAccess::None, ResourceAccess::Present);
+    RenderGraphResource albedo;
+    RenderGraphResource mask;
+
+    graph.addPass(
+        "G-buffer",
+        [&](RenderGraphBuilder& _builder)
+        {
+            albedo = _builder.create("Albedo", makeTexture(64, TextureFormat::RGBA8));
+            _builder.write(albedo, ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+        },
+        {});
+    graph.addPass(
+        "Mask",
+        [&](RenderGraphBuilder& _builder)
+        {
+            mask = _builder.create("Mask", makeTexture(64, TextureFormat::RGBA8));
+            _builder.write(mask, ResourceAccess::StorageWrite, AttachmentLoad::DontCare);
+        },
+        {});
+    graph.addPass(
+        "Lighting",
+        [&](RenderGraphBuilder& _builder)
+        {
+            _builder.read(albedo, ResourceAccess::InputAttachment);
+            _builder.read(mask, ResourceAccess::StorageRead);
+            _builder.write(target);
+        },
+        {});
+
+    // the compute pass ends the render pass, and the lighting reads a storage texture
+    EXPECT_THROW(graph.compile(), std::invalid_argument);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Aliasing Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(RenderGraphTest, TransientsWithDisjointLifetimesShareTheirMemory)
+{
+    DeferredGraph deferred;
+    const RenderGraph& graph = deferred.graph;
+    deferred.graph.compile(texelRequirements);
+
+    size_t transientBytes = 0;
+    for (const auto& resource : graph.getResources())
+    {
+        if (!resource.imported) transientBytes += resource.heapSize;
+
+        // live at the same time, never in the same memory
+        for (const auto& other : graph.getResources())
+        {
+            if (&resource == &other || resource.imported || other.imported) continue;
+            if (resource.heapSize == 0 || other.heapSize == 0) continue;
+
+            const bool lifetimes = resource.firstPass <= other.lastPass &&
+                                   other.firstPass <= resource.lastPass;
+            const bool memory = resource.heapOffset < other.heapOffset + other.heapSize &&
+                                other.heapOffset < resource.heapOffset + resource.heapSize;
+
+            EXPECT_FALSE(lifetimes && memory) << resource.name << " and " << other.name;
+        }
+
+        EXPECT_EQ(resource.heapOffset % 256, 0u) << resource.name;
+    }
+
+    // the bloom takes the memory of the shadow map, ended by the lighting
+    EXPECT_LT(graph.getHeapSize(), transientBytes);
+    EXPECT_EQ(graph.getHeapAlignment(), 256u);
+
+    const auto& bloom = graph.getResource(deferred.bloom);
+    const auto& shadowMap = graph.getResource(deferred.shadowMap);
+    EXPECT_LT(bloom.heapOffset, shadowMap.heapOffset + shadowMap.heapSize);
+
+    const auto* bloomWrite = findBarrier(graph, "Bloom", deferred.bloom);
+    ASSERT_NE(bloomWrite, nullptr);
+    EXPECT_TRUE(bloomWrite->aliasing);
+    EXPECT_FALSE(findBarrier(graph, "Shadows", deferred.shadowMap)->aliasing);
+
+    // the culled debug view takes no memory
+    const auto resources = graph.getResources();
+    const auto debug = std::ranges::find(resources, "Debug", &RenderGraph::Resource::name);
+    ASSERT_NE(debug, resources.end());
+    EXPECT_EQ(debug->heapSize, 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Async Compute Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(RenderGraphTest, AsyncComputePassesOverlapThePassesTheyShareNothingWith)
+{
+    RenderGraph graph;
+    RenderGraphResource shadowMap;
+    RenderGraphResource particles;
+
+    const auto backbuffer =
+        graph.importTexture("Backbuffer", makeTexture(512, TextureFormat::BGRA8),
+                            ResourceAccess::None, ResourceAccess::Present);
+
+    graph.addPass(
+        "Shadows",
+        [&](RenderGraphBuilder& _builder)
+        {
+            shadowMap = _builder.create("Shadow map", makeTexture(1024, TextureFormat::Depth32F));
+            _builder.write(shadowMap, ResourceAccess::DepthAttachment, AttachmentLoad::Clear);
+        },
+        {});
+
+    graph.addPass(
+        "Particles",
+        [&](RenderGraphBuilder& _builder)
+        {
+            particles = _builder.create("Particles", makeTexture(512, TextureFormat::RGBA16F));
+            _builder.write(particles, ResourceAccess::StorageWrite, AttachmentLoad::DontCare);
+            _builder.setQueue(RenderGraphQueue::AsyncCompute);
+        },
+        {});
+
+    graph.addPass(
+        "Lighting",
+        [&](RenderGraphBuilder& _builder)
+        {
+            _builder.read(shadowMap);
+            _builder.read(particles);
+            _builder.write(backbuffer, ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+        },
+        {});
+
+    graph.compile(texelRequirements);
+
+    // the particles run along the shadows, the lighting waits for them
+    const auto batches = graph.getBatches();
+    ASSERT_EQ(batches.size(), 3u);
+    EXPECT_TRUE(graph.hasAsyncCompute());
+
+    EXPECT_EQ(batches[0].queue, RenderGraphQueue::Graphics);
+    EXPECT_EQ(batches[0].wait, RenderGraphBatch::k_unused);
+    EXPECT_EQ(batches[1].queue, RenderGraphQueue::AsyncCompute);
+    EXPECT_EQ(batches[1].wait, RenderGraphBatch::k_unused);
+    EXPECT_EQ(batches[2].queue, RenderGraphQueue::Graphics);
+    EXPECT_EQ(batches[2].wait, 1u);
+    EXPECT_EQ(batches[2].passes, std::vector<uint32_t>{2});
+
+    const auto* particlesRead = findBarrier(graph, "Lighting", particles);
+    ASSERT_NE(particlesRead, nullptr);
+    EXPECT_TRUE(particlesRead->crossQueue);
+    EXPECT_FALSE(findBarrier(graph, "Lighting", shadowMap)->crossQueue);
+
+    // the shadow map ends before the lighting, yet the particles overlap it
+    const auto& particlesTexture = graph.getResource(particles);
+    const auto& shadowTexture = graph.getResource(shadowMap);
+    EXPECT_TRUE(particlesTexture.asyncCompute);
+    EXPECT_TRUE(
+        particlesTexture.heapOffset >= shadowTexture.heapOffset + shadowTexture.heapSize ||
+        shadowTexture.heapOffset >= particlesTexture.heapOffset + particlesTexture.heapSize);
+}
+
+TEST(RenderGraphTest, DependenciesKeepTheirPassesAndWaitAcrossQueues)
+{
+    RenderGraph graph;
+
+    const auto backbuffer =
+        graph.importTexture("Backbuffer", makeTexture(512, TextureFormat::BGRA8),
+                            ResourceAccess::None, ResourceAccess::Present);
+
+    // fills the draws of a buffer the graph does not track
+    const uint32_t culling = graph.addPass(
+        "Culling",
+        [&](RenderGraphBuilder& _builder) { _builder.setQueue(RenderGraphQueue::AsyncCompute); },
+        {});
+
+    graph.addPass(
+        "Draw",
+        [&](RenderGraphBuilder& _builder)
+        {
+            _builder.dependOn(culling);
+            _builder.write(backbuffer, ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+        },
+        {});
+
+    graph.compile(texelRequirements);
+
+    EXPECT_EQ(executedPasses(graph), (std::vector<std::string>{"Culling", "Draw"}));
+
+    const auto batches = graph.getBatches();
+    ASSERT_EQ(batches.size(), 2u);
+    EXPECT_EQ(batches[0].queue, RenderGraphQueue::AsyncCompute);
+    EXPECT_EQ(batches[1].wait, 0u);
+
+    EXPECT_THROW(graph.addPass(
+                     "Later", [](RenderGraphBuilder& _builder) { _builder.dependOn(5); }, {}),
+                 std::invalid_argument);
+}
+
+TEST(RenderGraphTest, AsyncComputeAttachmentsThrow)
+{
+    RenderGraph graph;
+
+    graph.addPass(
+        "Compute target",
+        [&](RenderGraphBuilder& _builder)
+        {
+            auto target = _builder.create("Target", makeTexture(256, TextureFormat::RGBA8));
+            _builder.write(target, ResourceAccess::ColorAttachment, AttachmentLoad::Clear);
+            _builder.setQueue(RenderGraphQueue::AsyncCompute);
+            _builder.setSideEffects();
+        },
+        {});
+
+    EXPECT_THROW(graph.compile(texelRequirements), std::invalid_argument);
+
+    // nothing async: a single graphics batch
+    RenderGraph graphics;
+    graphics.addPass(
+        "Readback", [](RenderGraphBuilder& _builder) { _builder.setSideEffects(); }, {});
+    graphics.compile(texelRequirements);
+
+    ASSERT_EQ(graphics.getBatches().size(), 1u);
+    EXPECT_FALSE(graphics.hasAsyncCompute());
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <mosaic/core/cmd_line_parser.hpp>
+#include <mosaic/graphics/render_profile.hpp>
+
+using namespace mosaic;
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+core::CommandLineParser::Config quietConfig()
+{
+    core::CommandLineParser::Config config;
+    config.printErrors = false;
+    config.autoHelp = false;
+    return config;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Profiles
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(RenderProfileTest, ReleaseIsTheFastPath)
+{
+    const RenderProfile release = makeRenderProfile(RenderProfileType::Release);
+    EXPECT_FALSE(release.validation);
+    EXPECT_FALSE(release.debugLabels);
+    EXPECT_FALSE(release.checks);
+
+    const RenderProfile development = makeRenderProfile(RenderProfileType::Development);
+    EXPECT_FALSE(development.validation);
+    EXPECT_TRUE(development.debugLabels);
+    EXPECT_TRUE(development.checks);
+
+    const RenderProfile debug = makeRenderProfile(RenderProfileType::Debug);
+    EXPECT_TRUE(debug.validation);
+    EXPECT_TRUE(debug.debugLabels);
+    EXPECT_TRUE(debug.checks);
+
+    // the backbuffers chosen per device by every profile
+    EXPECT_EQ(release.backbufferCount, 0u);
+    EXPECT_EQ(debug.backbufferCount, 0u);
+}
+
+TEST(RenderProfileTest, NamesRoundTrip)
+{
+    for (const auto type :
+         {RenderProfileType::Release, RenderProfileType::Development, RenderProfileType::Debug})
+    {
+        EXPECT_EQ(parseRenderProfileType(getRenderProfileTypeName(type)), type);
+    }
+
+    EXPECT_EQ(parseRenderProfileType("dev"), RenderProfileType::Development);
+    EXPECT_FALSE(parseRenderProfileType("Release").has_value());
+    EXPECT_FALSE(parseRenderProfileType("").has_value());
+}
+
+TEST(RenderProfileTest, BackbuffersStayWithinTheSurfaceLimits)
+{
+    // one more than the minimum, unless asked for
+    EXPECT_EQ(chooseBackbufferCount(0, 2, 8), 3u);
+    EXPECT_EQ(chooseBackbufferCount(0, 3, 3), 3u);
+    EXPECT_EQ(chooseBackbufferCount(2, 2, 8), 2u);
+
+    EXPECT_EQ(chooseBackbufferCount(1, 2, 8), 2u);
+    EXPECT_EQ(chooseBackbufferCount(6, 2, 4), 4u);
+
+    // no maximum
+    EXPECT_EQ(chooseBackbufferCount(6, 2, 0), 6u);
+    EXPECT_EQ(chooseBackbufferCount(0, 1, 0), 2u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Command line
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(RenderProfileTest, CommandLineSetsTheProfile)
+{
+    core::CommandLineParser parser;
+    parser.setConfig(quietConfig());
+
+    RenderProfile profile = makeRenderProfile(RenderProfileType::Release);
+    ASSERT_FALSE(registerRenderProfileOptions(parser, profile).has_value());
+
+    // the backbuffers kept whichever option comes first
+    const std::vector<std::string> args = {"--backbuffers", "4", "--render-profile", "debug"};
+    ASSERT_FALSE(parser.parseCommandLine(args).has_value());
+
+    EXPECT_TRUE(profile.validation);
+    EXPECT_TRUE(profile.debugLabels);
+    EXPECT_TRUE(profile.checks);
+    EXPECT_EQ(profile.backbufferCount, 4u);
+}
+
+TEST(RenderProfileTest, CommandLineRejectsUnknownProfiles)
+{
+    core::CommandLineParser parser;
+    parser.setConfig(quietConfig());
+
+    RenderProfile profile = makeRenderProfile(RenderProfileType::Release);
+    ASSERT_FALSE(registerRenderProfileOptions(parser, profile).has_value());
+
+    EXPECT_TRUE(parser.parseCommandLine({"--render-profile", "fast"}).has_value());
+    EXPECT_TRUE(parser.parseCommandLine({"--backbuffers", "64"}).has_value());
+    EXPECT_FALSE(profile.validation);
+    EXPECT_EQ(profile.backbufferCount, 0u);
+}
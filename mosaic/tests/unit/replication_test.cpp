@@ -0,0 +1,392 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/scene/replication.hpp>
+
+using namespace mosaic::scene;
+using namespace mosaic::ecs;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct Position
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+struct Health
+{
+    int32_t value = 0;
+    int32_t local = 0; // not replicated
+};
+
+struct Player
+{
+};
+
+constexpr float k_step = 200.0f / 65535.0f;
+
+} // namespace
+
+class ReplicationTest : public ::testing::Test
+{
+   protected:
+    std::unique_ptr<ComponentRegistry> m_compRegistry;
+    std::unique_ptr<EntityRegistry> m_server;
+    std::unique_ptr<EntityRegistry> m_client;
+    std::unique_ptr<ReplicationSchema> m_schema;
+
+    void SetUp() override
+    {
+        m_compRegistry = std::make_unique<ComponentRegistry>(16);
+
+        m_compRegistry->registerComponent<Position>("Position");
+        m_compRegistry->registerComponent<Health>("Health");
+        m_compRegistry->registerComponent<Player>("Player");
+        m_compRegistry->registerComponent<TransformComponent>("Transform");
+        m_compRegistry->registerComponent<BoundsComponent>("Bounds");
+
+        m_server = std::make_unique<EntityRegistry>(m_compRegistry.get());
+        m_client = std::make_unique<EntityRegistry>(m_compRegistry.get());
+
+        m_schema = std::make_unique<ReplicationSchema>(*m_compRegistry);
+        m_schema->add<Position>({ReplicatedField::quantized(0, 3, -100.0f, 100.0f, 16)});
+        m_schema->add<Health>({ReplicatedField::raw(offsetof(Health, value), sizeof(int32_t))});
+        m_schema->add<Player>();
+    }
+
+    EntityMeta createUnit(float _x, int32_t _health)
+    {
+        return m_server->createEntity<Position, Health>(std::make_tuple(_x, 1.0f, -2.0f),
+                                                        std::make_tuple(_health, 7));
+    }
+
+    // The next snapshot of the client, read and acknowledged unless _acknowledge is false
+    std::vector<uint8_t> replicate(ReplicationServer& _server, ReplicationServer::ClientID _id,
+                                   ReplicationClient& _client, bool _acknowledge = true)
+    {
+        std::vector<uint8_t> message;
+        _server.writeSnapshot(_id, message);
+
+        const uint32_t sequence = _client.read(message);
+        if (_acknowledge) _server.acknowledge(_id, sequence);
+
+        return message;
+    }
+
+    static ReplicationHeader headerOf(const std::vector<uint8_t>& _message)
+    {
+        ReplicationHeader header;
+        std::memcpy(&header, _message.data(), sizeof(header));
+        return header;
+    }
+
+    Health& clientHealth(const ReplicationClient& _client, EntityID _serverEntity)
+    {
+        const EntityID local = _client.getLocalEntity(_serverEntity)->id;
+        return std::get<0>(*m_client->getComponentsForEntity<Health>(local));
+    }
+
+    void setHealth(EntityID _eid, int32_t _value)
+    {
+        std::get<0>(*m_server->getComponentsForEntity<Health>(_eid)).value = _value;
+        m_server->markChanged<Health>(_eid);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Schema
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ReplicationTest, SchemaRejectsMalformedFields)
+{
+    EXPECT_THROW(m_schema->add<Position>(), std::runtime_error);
+
+    ReplicationSchema schema(*m_compRegistry);
+    EXPECT_THROW(schema.add<Health>({ReplicatedField::raw(4, 8)}), std::runtime_error);
+    EXPECT_THROW(schema.add<Position>({ReplicatedField::quantized(0, 3, -1.0f, 1.0f, 25)}),
+                 std::runtime_error);
+    EXPECT_THROW(schema.add<Position>({ReplicatedField::quantized(0, 1, 1.0f, 1.0f, 8)}),
+                 std::runtime_error);
+
+    // the same components quantized differently do not decode each other's messages
+    schema.add<Position>({ReplicatedField::quantized(0, 3, -100.0f, 100.0f, 12)});
+    EXPECT_NE(schema.getHash(), m_schema->getHash());
+
+    ReplicationServer server(*m_server, schema);
+    ReplicationClient client(*m_client, *m_schema);
+    const ReplicationServer::ClientID id = server.addClient();
+
+    std::vector<uint8_t> message;
+    server.writeSnapshot(id, message);
+    EXPECT_THROW((void)client.read(message), std::runtime_error);
+
+    message.resize(8);
+    EXPECT_THROW((void)client.read(message), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Snapshots
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ReplicationTest, FullSnapshotsMirrorTheQuantizedComponents)
+{
+    std::vector<EntityMeta> units;
+    for (int i = 0; i < 100; ++i) units.push_back(createUnit(float(i) * 0.7f - 30.0f, i));
+    const EntityMeta player = m_server->createEntity<Position, Player>();
+
+    ReplicationServer server(*m_server, *m_schema);
+    ReplicationClient client(*m_client, *m_schema);
+    const ReplicationServer::ClientID id = server.addClient();
+
+    EXPECT_EQ(server.update(), 202u);
+    const std::vector<uint8_t> message = replicate(server, id, client);
+
+    EXPECT_EQ(headerOf(message).baseline, 0u);
+    EXPECT_EQ(client.size(), 101u);
+    EXPECT_EQ(m_client->entityCount(), 101u);
+
+    // 16 bits a coordinate of the positions: well under the raw components
+    EXPECT_LT(message.size(), 101 * (sizeof(Position) + sizeof(int32_t)));
+
+    for (int i = 0; i < 100; ++i)
+    {
+        const EntityID local = client.getLocalEntity(units[i].id)->id;
+        const auto [position, health] =
+            *m_client->getComponentsForEntity<Position, Health>(local);
+
+        EXPECT_NEAR(position.x, float(i) * 0.7f - 30.0f, k_step);
+        EXPECT_NEAR(position.y, 1.0f, k_step);
+        EXPECT_NEAR(position.z, -2.0f, k_step);
+        EXPECT_EQ(health.value, i);
+        EXPECT_EQ(health.local, 0);
+    }
+
+    const EntityID local = client.getLocalEntity(player.id)->id;
+    EXPECT_TRUE(m_client->hasComponent(local, m_compRegistry->getID<Player>()));
+    EXPECT_FALSE(m_client->hasComponent(local, m_compRegistry->getID<Health>()));
+}
+
+TEST_F(ReplicationTest, DeltasOnlyCarryWhatChangedSinceTheAcknowledgedBaseline)
+{
+    std::vector<EntityMeta> units;
+    for (int i = 0; i < 50; ++i) units.push_back(createUnit(float(i), 100));
+
+    ReplicationServer server(*m_server, *m_schema);
+    ReplicationClient client(*m_client, *m_schema);
+    const ReplicationServer::ClientID id = server.addClient();
+
+    server.update();
+    const std::vector<uint8_t> full = replicate(server, id, client);
+
+    // the creations are seen again by the next update, with the same values
+    m_server->advanceTick();
+    server.update();
+    std::vector<uint8_t> message = replicate(server, id, client);
+    EXPECT_EQ(headerOf(message).baseline, headerOf(full).sequence);
+    EXPECT_EQ(headerOf(message).count, 0u);
+    EXPECT_EQ(message.size(), sizeof(ReplicationHeader));
+
+    // a write of the same value is not sent either
+    m_server->advanceTick();
+    setHealth(units[3].id, 100);
+    setHealth(units[7].id, 42);
+    server.update();
+    message = replicate(server, id, client);
+    EXPECT_EQ(headerOf(message).count, 1u);
+    EXPECT_LT(message.size(), sizeof(ReplicationHeader) + 8);
+    EXPECT_EQ(clientHealth(client, units[7].id).value, 42);
+
+    // destructions, and components gained and lost
+    m_server->advanceTick();
+    m_server->destroyEntity(units[0].id);
+    m_server->addComponents<Player>(units[1].id);
+    m_server->removeComponents<Health>(units[2].id);
+    server.update();
+    message = replicate(server, id, client);
+
+    EXPECT_EQ(headerOf(message).count, 3u);
+    EXPECT_FALSE(client.getLocalEntity(units[0].id).has_value());
+    EXPECT_EQ(m_client->entityCount(), 49u);
+
+    const EntityID gained = client.getLocalEntity(units[1].id)->id;
+    const EntityID lost = client.getLocalEntity(units[2].id)->id;
+    EXPECT_TRUE(m_client->hasComponent(gained, m_compRegistry->getID<Player>()));
+    EXPECT_FALSE(m_client->hasComponent(lost, m_compRegistry->getID<Health>()));
+    EXPECT_TRUE(m_client->hasComponent(lost, m_compRegistry->getID<Position>()));
+
+    // a recycled ID is a new entity on the client
+    const EntityMeta recycled = createUnit(5.0f, 9);
+    ASSERT_EQ(recycled.id, units[0].id);
+    server.update();
+    replicate(server, id, client);
+    EXPECT_EQ(clientHealth(client, recycled.id).value, 9);
+    EXPECT_EQ(m_client->entityCount(), 50u);
+}
+
+TEST_F(ReplicationTest, LostAcknowledgmentsKeepTheOldBaseline)
+{
+    const EntityMeta unit = createUnit(0.0f, 1);
+
+    ReplicationServer server(*m_server, *m_schema);
+    ReplicationClient client(*m_client, *m_schema);
+    const ReplicationServer::ClientID id = server.addClient();
+
+    server.update();
+    const std::vector<uint8_t> first = replicate(server, id, client);
+
+    // acknowledgments lost: every snapshot is against the first one and carries the new value
+    std::vector<uint8_t> late;
+    for (int32_t value = 2; value < 5; ++value)
+    {
+        m_server->advanceTick();
+        setHealth(unit.id, value);
+        server.update();
+
+        late = replicate(server, id, client, false);
+        EXPECT_EQ(headerOf(late).baseline, headerOf(first).sequence);
+        EXPECT_EQ(clientHealth(client, unit.id).value, value);
+    }
+
+    // a snapshot arriving after a newer one is dropped
+    std::vector<uint8_t> newest;
+    server.writeSnapshot(id, newest);
+    EXPECT_EQ(client.read(newest), headerOf(newest).sequence);
+    EXPECT_EQ(client.read(late), 0u);
+
+    // past the history, the snapshots are full ones again
+    for (size_t i = 0; i < ReplicationServer::k_historySize; ++i)
+    {
+        std::vector<uint8_t> message;
+        server.writeSnapshot(id, message);
+    }
+
+    std::vector<uint8_t> message;
+    server.writeSnapshot(id, message);
+    EXPECT_EQ(headerOf(message).baseline, 0u);
+    EXPECT_EQ(headerOf(message).count, 1u);
+
+    ReplicationClient fresh(*m_client, *m_schema);
+    EXPECT_THROW((void)fresh.read(late), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Interest
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ReplicationTest, InterestLimitsTheClientToTheEntitiesAround)
+{
+    m_schema->add<TransformComponent>({ReplicatedField::quantized(
+        offsetof(TransformComponent, position), 3, -1000.0f, 1000.0f, 20)});
+
+    std::vector<EntityMeta> row;
+    for (int i = 0; i < 20; ++i)
+    {
+        row.push_back(m_server->createEntity<TransformComponent, BoundsComponent, Health>(
+            std::make_tuple(glm::vec3(float(i) * 10.0f, 0.0f, 0.0f),
+                            glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f)),
+            std::make_tuple(glm::vec3(1.0f)), std::make_tuple(i, 0)));
+    }
+    const EntityMeta global = createUnit(0.0f, 1000); // no bounds, always sent
+
+    SpatialIndex index(*m_server);
+    ReplicationServer server(*m_server, *m_schema, &index);
+    ReplicationClient client(*m_client, *m_schema);
+    const ReplicationServer::ClientID id = server.addClient();
+    server.setInterest(id, Aabb{glm::vec3(-5.0f), glm::vec3(35.0f, 5.0f, 5.0f)});
+
+    index.update();
+    server.update();
+    replicate(server, id, client);
+
+    EXPECT_EQ(client.size(), 5u);
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(client.getLocalEntity(row[i].id).has_value());
+    EXPECT_FALSE(client.getLocalEntity(row[4].id).has_value());
+    EXPECT_EQ(clientHealth(client, global.id).value, 1000);
+
+    // the first entity leaves the box, the fifth one enters it
+    m_server->advanceTick();
+    for (const int i : {0, 4})
+    {
+        auto transform = m_server->getComponentsForEntity<TransformComponent>(row[i].id);
+        std::get<0>(*transform).position.x = i == 0 ? 500.0f : 30.0f;
+        m_server->markChanged<TransformComponent>(row[i].id);
+    }
+
+    index.update();
+    server.update();
+    replicate(server, id, client);
+
+    EXPECT_FALSE(client.getLocalEntity(row[0].id).has_value());
+    EXPECT_EQ(clientHealth(client, row[4].id).value, 4);
+    EXPECT_EQ(client.size(), 5u);
+
+    server.clearInterest(id);
+    replicate(server, id, client);
+    EXPECT_EQ(client.size(), 21u);
+}
+
+TEST_F(ReplicationTest, ParallelSnapshotsMatchTheSerialOnes)
+{
+    mosaic::core::CPUInfo cpuInfo;
+    cpuInfo.logicalCores = 8;
+    cpuInfo.physicalCores = 4;
+
+    mosaic::exec::ThreadPool pool;
+    ASSERT_TRUE(pool.initialize(cpuInfo).isOk());
+
+    std::vector<EntityMeta> units;
+    for (int i = 0; i < 500; ++i) units.push_back(createUnit(float(i % 100), i));
+
+    ReplicationServer serial(*m_server, *m_schema);
+    ReplicationServer parallel(*m_server, *m_schema);
+
+    std::vector<ReplicationServer::ClientID> clients;
+    for (int i = 0; i < 16; ++i)
+    {
+        clients.push_back(serial.addClient());
+        EXPECT_EQ(parallel.addClient(), clients.back());
+    }
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        m_server->advanceTick();
+        for (int i = frame; i < 500; i += 7) setHealth(units[i].id, frame);
+
+        serial.update();
+        parallel.update();
+
+        std::vector<std::vector<uint8_t>> messages(clients.size());
+        parallel.writeSnapshots(pool, clients, messages);
+
+        for (size_t c = 0; c < clients.size(); ++c)
+        {
+            std::vector<uint8_t> expected;
+            serial.writeSnapshot(clients[c], expected);
+            EXPECT_EQ(messages[c], expected);
+
+            // half of the clients acknowledge
+            if (c % 2 == 0)
+            {
+                serial.acknowledge(clients[c], headerOf(expected).sequence);
+                parallel.acknowledge(clients[c], headerOf(expected).sequence);
+            }
+        }
+    }
+
+    pool.shutdown();
+}
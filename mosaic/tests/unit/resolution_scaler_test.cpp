@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include <mosaic/graphics/resolution_scaler.hpp>
+
+using namespace mosaic::graphics;
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// The frames at the scale the last update returned, _frames of them
+float feed(ResolutionScaler& _scaler, std::chrono::nanoseconds _gpuTime, uint32_t _frames)
+{
+    float scale = _scaler.getScale();
+    for (uint32_t i = 0; i < _frames; ++i) scale = _scaler.update(_gpuTime);
+
+    return scale;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Control Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ResolutionScalerTest, AFrameOverTheBudgetLowersTheScaleToWhatFits)
+{
+    ResolutionScaler scaler;
+    EXPECT_FLOAT_EQ(scaler.getScale(), 1.0f);
+
+    // 25 ms for a 16.7 ms budget: the pixels of 0.85 of it, sqrt(14.2 / 25) on each side
+    EXPECT_FLOAT_EQ(scaler.update(25ms), 0.75f);
+
+    // the frames in flight were rendered at the last scale
+    EXPECT_FLOAT_EQ(feed(scaler, 40ms, scaler.getSettings().settleFrames), 0.75f);
+
+    // then the heaviest load ends at the lowest scale
+    EXPECT_FLOAT_EQ(feed(scaler, 200ms, 1), 0.5f);
+}
+
+TEST(ResolutionScalerTest, TheScaleClimbsOneStepAtATimeBelowTheHeadroom)
+{
+    ResolutionScaler scaler;
+    scaler.update(25ms);
+    feed(scaler, 25ms, scaler.getSettings().settleFrames);
+
+    const uint32_t upscaleFrames = scaler.getSettings().upscaleFrames;
+
+    // between the headroom and the budget, it holds
+    EXPECT_FLOAT_EQ(feed(scaler, 15ms, upscaleFrames * 2), 0.75f);
+
+    EXPECT_FLOAT_EQ(feed(scaler, 8ms, upscaleFrames - 1), 0.75f);
+    EXPECT_FLOAT_EQ(feed(scaler, 8ms, 1), 0.8f);
+
+    // nor past the maximum
+    EXPECT_FLOAT_EQ(feed(scaler, 1ms, upscaleFrames * 40), 1.0f);
+}
+
+TEST(ResolutionScalerTest, AStepIsNotTakenIfItWouldExceedTheHeadroom)
+{
+    ResolutionScalerSettings settings;
+    settings.settleFrames = 0;
+
+    ResolutionScaler scaler(settings);
+    scaler.update(100ms);
+    ASSERT_FLOAT_EQ(scaler.getScale(), 0.5f);
+
+    // 13.5 ms at 0.5 would be 16.3 ms at 0.55, over the 14.2 ms of the headroom
+    EXPECT_FLOAT_EQ(feed(scaler, 13500us, settings.upscaleFrames * 3), 0.5f);
+}
+
+TEST(ResolutionScalerTest, TheLimitCapsTheScaleUntilRaised)
+{
+    ResolutionScalerSettings settings;
+    settings.settleFrames = 0;
+
+    ResolutionScaler scaler(settings);
+
+    // down at once, however light the frames
+    scaler.setLimit(0.7f);
+    EXPECT_FLOAT_EQ(scaler.getScale(), 0.7f);
+    EXPECT_FLOAT_EQ(feed(scaler, 1ms, settings.upscaleFrames * 4), 0.7f);
+
+    // nor below the minimum
+    scaler.setLimit(0.1f);
+    EXPECT_FLOAT_EQ(scaler.getLimit(), settings.minScale);
+    EXPECT_FLOAT_EQ(scaler.getScale(), 0.5f);
+
+    // then back up a step at a time
+    scaler.setLimit(1.0f);
+    EXPECT_FLOAT_EQ(scaler.getScale(), 0.5f);
+    EXPECT_FLOAT_EQ(feed(scaler, 1ms, settings.upscaleFrames), 0.55f);
+}
+
+TEST(ResolutionScalerTest, ScaledExtentsKeepATexel)
+{
+    EXPECT_EQ(ResolutionScaler::getScaledExtent({1920, 1080}, 0.75f), glm::uvec2(1440, 810));
+    EXPECT_EQ(ResolutionScaler::getScaledExtent({1, 1}, 0.5f), glm::uvec2(1, 1));
+    EXPECT_EQ(ResolutionScaler::getScaledExtent({2400, 1080}, 1.0f), glm::uvec2(2400, 1080));
+}
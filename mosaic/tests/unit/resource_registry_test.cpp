@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <mosaic/graphics/resource_registry.hpp>
+
+using namespace mosaic::graphics;
+
+using TexturePool = ResourcePool<int, ResourceType::Texture>;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Handles
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ResourceRegistryTest, HandlePacksIndexAndGeneration)
+{
+    const TextureHandle handle = TextureHandle::make(1234, 5);
+
+    EXPECT_TRUE(handle.isValid());
+    EXPECT_EQ(handle.getIndex(), 1234u);
+    EXPECT_EQ(handle.getGeneration(), 5u);
+    EXPECT_FALSE(TextureHandle{}.isValid());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pool
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ResourceRegistryTest, ReleasedHandlesNoLongerResolve)
+{
+    TexturePool pool(8);
+
+    const TextureHandle first = pool.allocate(10);
+    const TextureHandle second = pool.allocate(20);
+
+    ASSERT_TRUE(first.isValid());
+    EXPECT_EQ(first.getIndex(), 0u);
+    EXPECT_EQ(second.getIndex(), 1u);
+    EXPECT_EQ(*pool.get(second), 20);
+
+    EXPECT_TRUE(pool.release(first, 0));
+    EXPECT_FALSE(pool.release(first, 0));
+    EXPECT_EQ(pool.get(first), nullptr);
+    EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST(ResourceRegistryTest, SlotsAreReusedOnceTheirFramesCompleted)
+{
+    TexturePool pool(2);
+
+    const TextureHandle first = pool.allocate(1);
+    ASSERT_TRUE(pool.allocate(2).isValid());
+    EXPECT_FALSE(pool.allocate(3).isValid()); // full
+
+    pool.release(first, 5);
+
+    // still read by the frames in flight
+    pool.recycle(4);
+    EXPECT_FALSE(pool.allocate(3).isValid());
+
+    pool.recycle(5);
+    const TextureHandle reused = pool.allocate(3);
+
+    ASSERT_TRUE(reused.isValid());
+    EXPECT_EQ(reused.getIndex(), first.getIndex());
+    EXPECT_NE(reused.getGeneration(), first.getGeneration());
+    EXPECT_EQ(pool.get(first), nullptr);
+    EXPECT_EQ(*pool.get(reused), 3);
+}
+
+TEST(ResourceRegistryTest, ForEachVisitsTheAliveResources)
+{
+    TexturePool pool;
+
+    std::vector<TextureHandle> handles;
+    for (int i = 0; i < 4; ++i) handles.push_back(pool.allocate(i));
+
+    pool.release(handles[1], 0);
+
+    std::vector<int> visited;
+    pool.forEach([&](TextureHandle _handle, int _resource)
+                 {
+                     EXPECT_TRUE(pool.isValid(_handle));
+                     visited.push_back(_resource);
+                 });
+
+    EXPECT_EQ(visited, (std::vector<int>{0, 2, 3}));
+}
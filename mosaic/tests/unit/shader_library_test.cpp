@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/graphics/pipeline.hpp>
+#include <mosaic/graphics/shader_library.hpp>
+
+using namespace mosaic::graphics;
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// A vertex shader module of a main entry point and _names OpNames, to tell versions apart
+std::vector<uint8_t> vertexModule(uint32_t _names = 0)
+{
+    std::vector<uint32_t> words = {0x07230203, 0x00010300, 0, 16, 0};
+
+    words.insert(words.end(), {5u << 16 | 15, 0, 1, 0x6E69616D, 0}); // OpEntryPoint Vertex "main"
+    for (uint32_t i = 0; i < _names; ++i) words.insert(words.end(), {2u << 16 | 5, 1}); // OpName
+
+    std::vector<uint8_t> bytes(words.size() * 4);
+    std::memcpy(bytes.data(), words.data(), bytes.size());
+    return bytes;
+}
+
+// Written a second later than the last version each time, whatever the resolution of the clock
+void writeFile(const std::filesystem::path& _path, const std::vector<uint8_t>& _bytes)
+{
+    std::filesystem::file_time_type time = {};
+    const bool existed = std::filesystem::exists(_path);
+    if (existed) time = std::filesystem::last_write_time(_path);
+
+    std::ofstream(_path, std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char*>(_bytes.data()),
+               static_cast<std::streamsize>(_bytes.size()));
+
+    if (existed) std::filesystem::last_write_time(_path, time + 1s);
+}
+
+// Updates until a shader is replaced, for up to a second
+bool updateUntilReplaced(ShaderLibrary& _library)
+{
+    for (int attempt = 0; attempt < 1000; ++attempt)
+    {
+        if (!_library.update().empty()) return true;
+        std::this_thread::sleep_for(1ms);
+    }
+    return false;
+}
+
+class ShaderLibraryTest : public ::testing::Test
+{
+   protected:
+    std::unique_ptr<mosaic::exec::ThreadPool> pool;
+    std::filesystem::path path;
+
+    void SetUp() override
+    {
+        mosaic::core::CPUInfo cpuInfo;
+        cpuInfo.logicalCores = 8;
+        cpuInfo.physicalCores = 4;
+
+        pool = std::make_unique<mosaic::exec::ThreadPool>();
+        ASSERT_TRUE(pool->initialize(cpuInfo).isOk());
+
+        path = std::filesystem::temp_directory_path() / "mosaic_shader_library_test.vert.spv";
+        std::filesystem::remove(path);
+        writeFile(path, vertexModule());
+    }
+
+    void TearDown() override
+    {
+        pool->shutdown();
+        std::filesystem::remove(path);
+    }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loading
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ShaderLibraryTest, ReadsEachFileOnce)
+{
+    ShaderLibrary library;
+
+    const ShaderDescription& shader = library.load(ShaderStage::Vertex, path);
+    EXPECT_EQ(shader.bytecode, vertexModule());
+    EXPECT_EQ(shader.stage, ShaderStage::Vertex);
+    EXPECT_EQ(library.getHash(path), hashShaderBytecode(vertexModule()));
+
+    // the cached one, even once the file changed
+    writeFile(path, vertexModule(2));
+    EXPECT_EQ(&library.load(ShaderStage::Vertex, path), &shader);
+    EXPECT_EQ(shader.bytecode, vertexModule());
+
+    EXPECT_EQ(library.getHash(path.string() + ".missing"), 0u);
+    EXPECT_THROW(library.load(ShaderStage::Vertex, path.string() + ".missing"), std::runtime_error);
+}
+
+TEST_F(ShaderLibraryTest, LoadsThePermutationOfAVariantElseSpecializesTheShader)
+{
+    enum class Feature : uint32_t
+    {
+        Tinted,
+        Skinned,
+        Fogged
+    };
+
+    constexpr ShaderVariantKey key = makeShaderVariantKey({Feature::Tinted, Feature::Fogged});
+    static_assert(key.features == 0x5 && key.has(2) && !key.has(1));
+
+    const std::filesystem::path permutation = getShaderVariantPath(path, key);
+    EXPECT_EQ(permutation.filename(), "mosaic_shader_library_test.vert.5.spv");
+    EXPECT_EQ(getShaderVariantPath(path, {}), path);
+
+    ShaderLibrary library;
+
+    // not shipped: the shader itself, its branches on the features folded by the constants
+    const ShaderDescription specialized = library.loadVariant(ShaderStage::Vertex, path, key);
+    EXPECT_EQ(specialized.bytecode, vertexModule());
+    EXPECT_EQ(specialized.specialization,
+              (std::vector<SpecializationConstant>{{0, 1}, {2, 1}}));
+    EXPECT_TRUE(library.loadVariant(ShaderStage::Vertex, path, {}).specialization.empty());
+
+    PipelineDescription base;
+    base.shaders = {library.load(ShaderStage::Vertex, path)};
+    PipelineDescription variant;
+    variant.shaders = {specialized};
+    EXPECT_NE(hashPipelineDescription(base), hashPipelineDescription(variant));
+
+    // compiled offline for the key, then used as is
+    writeFile(permutation, vertexModule(3));
+    const ShaderDescription compiled = library.loadVariant(ShaderStage::Vertex, path, key);
+    EXPECT_EQ(compiled.bytecode, vertexModule(3));
+    EXPECT_TRUE(compiled.specialization.empty());
+
+    std::filesystem::remove(permutation);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Hot reload
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ShaderLibraryTest, ReplacesAChangedShaderOnAnUpdate)
+{
+    ShaderLibrary library;
+    const ShaderDescription& shader = library.load(ShaderStage::Vertex, path);
+
+    // nothing is watched meanwhile
+    writeFile(path, vertexModule(1));
+    EXPECT_TRUE(library.update().empty());
+    EXPECT_EQ(shader.bytecode, vertexModule());
+
+    // the poll sees the file written since it was read
+    library.enableHotReload({{}, "glslc", 0ms});
+    ASSERT_TRUE(updateUntilReplaced(library));
+    EXPECT_EQ(shader.bytecode, vertexModule(1));
+    EXPECT_EQ(library.getHash(path), hashShaderBytecode(vertexModule(1)));
+    EXPECT_EQ(library.getGeneration(), 1u);
+
+    writeFile(path, vertexModule(2));
+    ASSERT_TRUE(updateUntilReplaced(library));
+    EXPECT_EQ(shader.bytecode, vertexModule(2));
+    EXPECT_EQ(library.getGeneration(), 2u);
+}
+
+TEST_F(ShaderLibraryTest, KeepsTheShaderWhenTheNewOneIsInvalid)
+{
+    ShaderLibrary library;
+    const ShaderDescription& shader = library.load(ShaderStage::Vertex, path);
+    library.enableHotReload({{}, "glslc", 0ms});
+
+    writeFile(path, {1, 2, 3});
+    for (int attempt = 0; attempt < 50; ++attempt)
+    {
+        EXPECT_TRUE(library.update().empty());
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(shader.bytecode, vertexModule());
+
+    // a fragment shader in place of a vertex one
+    std::vector<uint8_t> fragment = vertexModule();
+    fragment[24] = 4;
+    writeFile(path, fragment);
+    for (int attempt = 0; attempt < 50; ++attempt)
+    {
+        EXPECT_TRUE(library.update().empty());
+        std::this_thread::sleep_for(1ms);
+    }
+
+    writeFile(path, vertexModule(1));
+    ASSERT_TRUE(updateUntilReplaced(library));
+    EXPECT_EQ(shader.bytecode, vertexModule(1));
+    EXPECT_EQ(library.getGeneration(), 1u);
+}
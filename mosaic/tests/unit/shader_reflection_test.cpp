@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <mosaic/graphics/shader_reflection.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Assembles a module instruction by instruction, what glslc emits for the declarations
+struct SpirvAssembler
+{
+    std::vector<uint32_t> words = {0x07230203, 0x00010300, 0, 64, 0};
+
+    void op(uint32_t _opcode, std::initializer_list<uint32_t> _operands,
+            std::string_view _string = {}, std::initializer_list<uint32_t> _after = {})
+    {
+        std::vector<uint32_t> operands(_operands);
+
+        if (!_string.empty())
+        {
+            // nul-terminated, padded to a word
+            std::vector<uint32_t> string(_string.size() / 4 + 1, 0);
+            std::memcpy(string.data(), _string.data(), _string.size());
+            operands.insert(operands.end(), string.begin(), string.end());
+        }
+        operands.insert(operands.end(), _after);
+
+        words.push_back(static_cast<uint32_t>(operands.size() + 1) << 16 | _opcode);
+        words.insert(words.end(), operands.begin(), operands.end());
+    }
+
+    std::vector<uint8_t> bytes() const
+    {
+        std::vector<uint8_t> bytes(words.size() * 4);
+        std::memcpy(bytes.data(), words.data(), bytes.size());
+        return bytes;
+    }
+};
+
+// The layout of the culling shaders: bindless buffers and textures, a push constant block
+std::vector<uint8_t> computeModule()
+{
+    SpirvAssembler spirv;
+
+    spirv.op(15, {5, 2}, "main");          // OpEntryPoint GLCompute %2
+    spirv.op(16, {2, 17, 64, 1, 1});       // OpExecutionMode LocalSize 64 1 1
+    spirv.op(5, {20}, "g_buffers");        // OpName
+    spirv.op(5, {11}, "Uniforms");         // OpName, of the block type
+    spirv.op(71, {20, 34, 0});             // OpDecorate DescriptorSet 0
+    spirv.op(71, {20, 33, 0});             // OpDecorate Binding 0
+    spirv.op(71, {30, 34, 0});
+    spirv.op(71, {30, 33, 1});
+    spirv.op(71, {40, 34, 1});
+    spirv.op(71, {40, 33, 3});
+    spirv.op(72, {6, 0, 35, 0});           // OpMemberDecorate Offset
+    spirv.op(72, {6, 1, 35, 16});
+    spirv.op(72, {6, 2, 35, 32});
+    spirv.op(72, {6, 2, 7, 16});           // MatrixStride
+
+    spirv.op(21, {3, 32, 0});              // %3 uint
+    spirv.op(22, {4, 32});                 // %4 float
+    spirv.op(23, {5, 4, 4});               // %5 vec4
+    spirv.op(24, {7, 5, 4});               // %7 mat4
+    spirv.op(30, {6, 3, 5, 7});            // %6 struct {uint, vec4, mat4}
+    spirv.op(32, {8, 9, 6});               // %8 PushConstant pointer
+    spirv.op(59, {8, 10, 9});              // %10 OpVariable PushConstant
+
+    spirv.op(30, {11, 3});                 // %11 struct {uint}
+    spirv.op(29, {12, 11});                // %12 runtime array
+    spirv.op(32, {13, 12, 12});            // %13 StorageBuffer pointer
+    spirv.op(59, {13, 20, 12});            // %20 g_buffers[]
+
+    spirv.op(25, {14, 4, 1, 0, 0, 0, 1, 0}); // %14 texture2D
+    spirv.op(29, {15, 14});
+    spirv.op(32, {16, 0, 15});             // UniformConstant pointer
+    spirv.op(59, {16, 30, 0});             // %30 textures[]
+
+    spirv.op(43, {3, 17, 4});              // %17 constant 4
+    spirv.op(28, {18, 11, 17});            // %18 Uniforms[4]
+    spirv.op(32, {19, 2, 18});             // Uniform pointer
+    spirv.op(59, {19, 40, 2});             // %40, unnamed
+
+    return spirv.bytes();
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reflection
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ShaderReflectionTest, ReflectsTheLayoutOfAComputeShader)
+{
+    auto result = reflectShader(computeModule());
+    ASSERT_TRUE(result.isOk()) << result.error();
+
+    const ShaderReflection& reflection = result.unwrap();
+    EXPECT_EQ(reflection.stage, ShaderStage::Compute);
+    EXPECT_EQ(reflection.localSize, (std::array<uint32_t, 3>{64, 1, 1}));
+
+    // the mat4 at 32, 4 columns of 16 bytes
+    EXPECT_EQ(reflection.pushConstantSize, 96u);
+
+    ASSERT_EQ(reflection.bindings.size(), 3u);
+
+    EXPECT_EQ(reflection.bindings[0].set, 0u);
+    EXPECT_EQ(reflection.bindings[0].binding, 0u);
+    EXPECT_EQ(reflection.bindings[0].count, 0u);
+    EXPECT_EQ(reflection.bindings[0].type, ShaderResourceType::StorageBuffer);
+    EXPECT_EQ(reflection.bindings[0].name, "g_buffers");
+
+    EXPECT_EQ(reflection.bindings[1].binding, 1u);
+    EXPECT_EQ(reflection.bindings[1].count, 0u);
+    EXPECT_EQ(reflection.bindings[1].type, ShaderResourceType::SampledImage);
+
+    EXPECT_EQ(reflection.bindings[2].set, 1u);
+    EXPECT_EQ(reflection.bindings[2].binding, 3u);
+    EXPECT_EQ(reflection.bindings[2].count, 4u);
+    EXPECT_EQ(reflection.bindings[2].type, ShaderResourceType::UniformBuffer);
+    EXPECT_EQ(reflection.bindings[2].name, "Uniforms");
+}
+
+TEST(ShaderReflectionTest, FindsTheEntryPointByName)
+{
+    SpirvAssembler spirv;
+    spirv.op(15, {0, 2}, "main"); // Vertex
+    spirv.op(15, {4, 3}, "shade"); // Fragment
+    spirv.op(15, {5364, 4}, "cull"); // TaskEXT
+    spirv.op(15, {5365, 5}, "emit"); // MeshEXT
+
+    auto vertex = reflectShader(spirv.bytes());
+    ASSERT_TRUE(vertex.isOk());
+    EXPECT_EQ(vertex.unwrap().stage, ShaderStage::Vertex);
+    EXPECT_TRUE(vertex.unwrap().bindings.empty());
+    EXPECT_EQ(vertex.unwrap().pushConstantSize, 0u);
+
+    auto fragment = reflectShader(spirv.bytes(), "shade");
+    ASSERT_TRUE(fragment.isOk());
+    EXPECT_EQ(fragment.unwrap().stage, ShaderStage::Fragment);
+
+    auto task = reflectShader(spirv.bytes(), "cull");
+    ASSERT_TRUE(task.isOk());
+    EXPECT_EQ(task.unwrap().stage, ShaderStage::Task);
+
+    auto mesh = reflectShader(spirv.bytes(), "emit");
+    ASSERT_TRUE(mesh.isOk());
+    EXPECT_EQ(mesh.unwrap().stage, ShaderStage::Mesh);
+
+    EXPECT_TRUE(reflectShader(spirv.bytes(), "other").isErr());
+}
+
+TEST(ShaderReflectionTest, RejectsWhatIsNotAWellFormedModule)
+{
+    std::vector<uint8_t> module = computeModule();
+
+    EXPECT_TRUE(reflectShader({}).isErr());
+    EXPECT_TRUE(reflectShader(std::span(module).first(module.size() - 2)).isErr());
+
+    // an instruction past the end
+    EXPECT_TRUE(reflectShader(std::span(module).first(module.size() - 4)).isErr());
+
+    // an id past the bound
+    SpirvAssembler spirv;
+    spirv.op(15, {5, 2}, "main");
+    spirv.op(71, {1000, 34, 0});
+    EXPECT_TRUE(reflectShader(spirv.bytes()).isErr());
+
+    module[0] ^= 0xFF;
+    EXPECT_TRUE(reflectShader(module).isErr());
+}
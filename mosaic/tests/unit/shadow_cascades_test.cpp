@@ -0,0 +1,303 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <mosaic/graphics/shadow_cascades.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+constexpr float k_zNear = 0.1f;
+
+// glm::perspective of a 1 radian vertical field of view, 16:9
+const float k_p11 = 1.0f / std::tan(0.5f);
+const float k_p00 = k_p11 * 9.0f / 16.0f;
+
+// Straight down, slightly slanted
+const std::array<float, 3> k_light = {0.3f, -1.0f, 0.2f};
+
+struct Casters
+{
+    std::vector<float> x, y, z, radius;
+
+    void add(float _x, float _y, float _z, float _radius)
+    {
+        x.push_back(_x);
+        y.push_back(_y);
+        z.push_back(_z);
+        radius.push_back(_radius);
+    }
+
+    SphereColumns columns() const { return {x, y, z, radius}; }
+};
+
+Casters makeCasters(size_t _count, uint32_t _seed)
+{
+    std::mt19937 random(_seed);
+    std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+    Casters casters;
+    for (size_t i = 0; i < _count; ++i)
+    {
+        casters.add(position(random), position(random) * 0.1f, position(random), size(random));
+    }
+    return casters;
+}
+
+ShadowCascades makeCascades(const ShadowCascadeSettings& _settings = {})
+{
+    ShadowCascades cascades;
+    cascades.setProjection(_settings, k_p00, k_p11, k_zNear);
+    return cascades;
+}
+
+// The cascades that redraw their static casters this frame, a bit each
+uint32_t getRedrawn(const ShadowCascades& _cascades)
+{
+    uint32_t redrawn = 0;
+    for (uint32_t i = 0; i < _cascades.getCascades().size(); ++i)
+    {
+        if (_cascades.getCascades()[i].redrawStatic) redrawn |= 1u << i;
+    }
+    return redrawn;
+}
+
+// The clip space of a world point in a cascade
+std::array<float, 3> project(const ShadowCascade& _cascade, const std::array<float, 3>& _point)
+{
+    std::array<float, 3> clip;
+    for (int row = 0; row < 3; ++row)
+    {
+        const float* m = _cascade.viewProjection.data();
+        clip[row] = m[row] * _point[0] + m[4 + row] * _point[1] + m[8 + row] * _point[2] +
+                    m[12 + row];
+    }
+    return clip;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Splits
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ShadowCascadesTest, RejectsSettingsOutOfRange)
+{
+    ShadowCascades cascades;
+
+    ShadowCascadeSettings settings;
+    settings.cascadeCount = 5;
+    EXPECT_THROW(cascades.setProjection(settings, k_p00, k_p11, k_zNear), std::invalid_argument);
+
+    settings = {};
+    settings.splitLambda = 1.5f;
+    EXPECT_THROW(cascades.setProjection(settings, k_p00, k_p11, k_zNear), std::invalid_argument);
+
+    EXPECT_THROW(cascades.setProjection({}, k_p00, k_p11, 100.0f), std::invalid_argument);
+
+    // nothing to update before a projection
+    const Casters casters = makeCasters(4, 1);
+    cascades.update({}, k_light, casters.columns(), casters.columns());
+    EXPECT_TRUE(cascades.getCascades().empty());
+}
+
+TEST(ShadowCascadesTest, SplitsBlendUniformAndLogarithmicDepths)
+{
+    ShadowCascadeSettings settings;
+    settings.distance = 100.0f;
+
+    settings.splitLambda = 0.0f;
+    ShadowCascades uniform = makeCascades(settings);
+    ASSERT_EQ(uniform.getCascades().size(), 4u);
+    EXPECT_NEAR(uniform.getCascades()[0].splitDepth, k_zNear + (100.0f - k_zNear) / 4.0f, 1e-3f);
+
+    settings.splitLambda = 1.0f;
+    ShadowCascades logarithmic = makeCascades(settings);
+    EXPECT_NEAR(logarithmic.getCascades()[1].splitDepth, std::sqrt(k_zNear * 100.0f), 1e-3f);
+
+    for (const ShadowCascades* cascades : {&uniform, &logarithmic})
+    {
+        EXPECT_FLOAT_EQ(cascades->getCascades()[3].splitDepth, 100.0f);
+        for (size_t i = 1; i < 4; ++i)
+        {
+            EXPECT_LT(cascades->getCascades()[i - 1].splitDepth,
+                      cascades->getCascades()[i].splitDepth);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Caching
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ShadowCascadesTest, StaticCastersAreRedrawnOnlyWhenTheCameraLeavesTheMargin)
+{
+    ShadowCascades cascades = makeCascades();
+    const Casters casters = makeCasters(200, 2);
+
+    cascades.update({0.0f, 2.0f, 0.0f}, k_light, casters.columns(), {});
+    EXPECT_EQ(getRedrawn(cascades), 0b1111u);
+    EXPECT_FALSE(cascades.getStaticCasters(3).empty());
+
+    // the camera in place, wherever it looks: the spheres around it do not move
+    cascades.update({0.0f, 2.0f, 0.0f}, k_light, casters.columns(), {});
+    EXPECT_EQ(getRedrawn(cascades), 0u);
+    EXPECT_TRUE(cascades.getStaticCasters(0).empty());
+
+    // a small step stays within every margin
+    const float firstMargin = cascades.getCascades()[0].splitDepth * 0.2f;
+    cascades.update({firstMargin * 0.3f, 2.0f, 0.0f}, k_light, casters.columns(), {});
+    EXPECT_EQ(getRedrawn(cascades), 0u);
+
+    // past the margin of the first cascade only the nearest ones are refit
+    const std::array<float, 16> farProjection = cascades.getCascades()[3].viewProjection;
+    cascades.update({firstMargin * 5.0f, 2.0f, 0.0f}, k_light, casters.columns(), {});
+    EXPECT_TRUE(getRedrawn(cascades) & 1u);
+    EXPECT_FALSE(getRedrawn(cascades) & 0b1000u);
+    EXPECT_EQ(cascades.getCascades()[3].viewProjection, farProjection);
+}
+
+TEST(ShadowCascadesTest, TurningTheLightPastTheAngleRefitsEveryCascade)
+{
+    ShadowCascades cascades = makeCascades();
+    const Casters casters = makeCasters(50, 3);
+
+    cascades.update({}, k_light, casters.columns(), {});
+
+    // a thousandth of a radian is below the threshold
+    const std::array<float, 3> nudged = {k_light[0] + 0.001f, k_light[1], k_light[2]};
+    cascades.update({}, nudged, casters.columns(), {});
+    EXPECT_EQ(getRedrawn(cascades), 0u);
+
+    const std::array<float, 3> turned = {k_light[0] + 0.2f, k_light[1], k_light[2]};
+    cascades.update({}, turned, casters.columns(), {});
+    EXPECT_EQ(getRedrawn(cascades), 0b1111u);
+}
+
+TEST(ShadowCascadesTest, InvalidatingBoundsRedrawsTheCascadesTheyTouch)
+{
+    ShadowCascades cascades = makeCascades();
+    const Casters casters = makeCasters(50, 4);
+    cascades.update({}, k_light, casters.columns(), {});
+
+    // beyond the first cascades, within the last
+    cascades.invalidateStatic(BoundingSphere{{100.0f, 0.0f, 0.0f}, 1.0f});
+    cascades.update({}, k_light, casters.columns(), {});
+    EXPECT_EQ(getRedrawn(cascades), 0b1000u);
+
+    // the projections are kept, only the caches redrawn
+    cascades.invalidateStatic();
+    cascades.update({}, k_light, casters.columns(), {});
+    EXPECT_EQ(getRedrawn(cascades), 0b1111u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Projection and culling
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ShadowCascadesTest, CascadesCoverTheirSplitOnStableTexels)
+{
+    ShadowCascades cascades = makeCascades();
+    const std::array<float, 3> camera = {3.7f, 2.0f, -1.3f};
+    cascades.update(camera, k_light, {}, {});
+
+    for (const ShadowCascade& cascade : cascades.getCascades())
+    {
+        // whatever the camera looks at up to the split, it lands in the map
+        const float reach = cascade.splitDepth * std::sqrt(1.0f + 1.0f / (k_p00 * k_p00) +
+                                                           1.0f / (k_p11 * k_p11));
+        for (const std::array<float, 3>& offset :
+             {std::array<float, 3>{reach, 0.0f, 0.0f}, {0.0f, -reach, 0.0f}, {0.0f, 0.0f, reach},
+              {-reach * 0.577f, reach * 0.577f, -reach * 0.577f}})
+        {
+            const std::array<float, 3> clip = project(
+                cascade, {camera[0] + offset[0], camera[1] + offset[1], camera[2] + offset[2]});
+
+            EXPECT_LE(std::abs(clip[0]), 1.0f);
+            EXPECT_LE(std::abs(clip[1]), 1.0f);
+            EXPECT_GE(clip[2], 0.0f);
+            EXPECT_LE(clip[2], 1.0f);
+        }
+
+        // the origin on a texel corner: the grid does not slide between refits
+        const std::array<float, 3> origin = project(cascade, {0.0f, 0.0f, 0.0f});
+        const float texels = origin[0] * 2048.0f * 0.5f;
+        EXPECT_NEAR(texels, std::round(texels), 1e-2f);
+    }
+
+    const ShadowUniforms& uniforms = cascades.getUniforms();
+    EXPECT_EQ(uniforms.cascadeCount, 4u);
+    EXPECT_EQ(uniforms.viewProjection[2], cascades.getCascades()[2].viewProjection);
+    EXPECT_FLOAT_EQ(uniforms.texelSizes[1], cascades.getCascades()[1].texelSize);
+}
+
+TEST(ShadowCascadesTest, DynamicCastersAreCulledEveryFrameTowardTheLight)
+{
+    ShadowCascades cascades = makeCascades();
+
+    Casters dynamic;
+    dynamic.add(1.0f, 1.0f, 1.0f, 0.5f);       // at the camera
+    dynamic.add(-3.0f, 200.0f, -2.0f, 1.0f);   // high up toward the light, shadowing the camera
+    dynamic.add(1000.0f, 0.0f, 1000.0f, 1.0f); // out of every cascade
+
+    const std::array<float, 3> light = {0.0f, -1.0f, 0.0f};
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        cascades.update({}, light, {}, dynamic.columns());
+
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            const std::vector<uint32_t> visible(cascades.getDynamicCasters(i).begin(),
+                                                cascades.getDynamicCasters(i).end());
+            EXPECT_EQ(visible, (std::vector<uint32_t>{0, 1})) << "cascade " << i;
+        }
+    }
+}
+
+TEST(ShadowCascadesTest, ParallelUpdateMatchesTheSerialOne)
+{
+    mosaic::core::CPUInfo cpuInfo;
+    cpuInfo.logicalCores = 8;
+    cpuInfo.physicalCores = 4;
+
+    auto pool = std::make_unique<mosaic::exec::ThreadPool>();
+    ASSERT_TRUE(pool->initialize(cpuInfo).isOk());
+
+    ShadowCascades serial = makeCascades();
+    ShadowCascades parallel = makeCascades();
+    const Casters staticCasters = makeCasters(2000, 5);
+    const Casters dynamicCasters = makeCasters(500, 6);
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        const std::array<float, 3> camera = {frame * 4.0f, 2.0f, frame * -2.0f};
+        serial.update(camera, k_light, staticCasters.columns(), dynamicCasters.columns());
+        parallel.update(*pool, camera, k_light, staticCasters.columns(),
+                        dynamicCasters.columns());
+
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            EXPECT_EQ(parallel.getCascades()[i].redrawStatic, serial.getCascades()[i].redrawStatic);
+            EXPECT_TRUE(std::ranges::equal(parallel.getStaticCasters(i),
+                                           serial.getStaticCasters(i)));
+            EXPECT_TRUE(std::ranges::equal(parallel.getDynamicCasters(i),
+                                           serial.getDynamicCasters(i)));
+        }
+    }
+
+    pool->shutdown();
+}
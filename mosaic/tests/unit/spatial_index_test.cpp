@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/scene/spatial_index.hpp>
+
+using namespace mosaic::scene;
+using namespace mosaic::ecs;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class SpatialIndexTest : public ::testing::Test
+{
+   protected:
+    std::unique_ptr<ComponentRegistry> m_compRegistry;
+    std::unique_ptr<EntityRegistry> m_entityRegistry;
+
+    void SetUp() override
+    {
+        m_compRegistry = std::make_unique<ComponentRegistry>(16);
+
+        m_compRegistry->registerComponent<TransformComponent>("Transform");
+        m_compRegistry->registerComponent<BoundsComponent>("Bounds");
+        m_compRegistry->registerComponent<MeshComponent>("Mesh");
+
+        m_entityRegistry = std::make_unique<EntityRegistry>(m_compRegistry.get());
+    }
+
+    EntityMeta createBox(const glm::vec3& _position, float _extent = 0.5f)
+    {
+        return m_entityRegistry->createEntity<TransformComponent, BoundsComponent>(
+            std::make_tuple(_position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f)),
+            std::make_tuple(glm::vec3(_extent)));
+    }
+
+    // The entities the index returns, by ID to compare them regardless of their order
+    static std::vector<EntityID> ids(const std::vector<EntityMeta>& _entities)
+    {
+        std::vector<EntityID> result;
+        for (const EntityMeta& entity : _entities) result.push_back(entity.id);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::vector<EntityID> queryBox(const SpatialIndex& _index, const glm::vec3& _min,
+                                   const glm::vec3& _max)
+    {
+        std::vector<EntityMeta> entities;
+        _index.query(Aabb{_min, _max}, entities);
+        return ids(entities);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Boxes
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(SpatialIndexBoxTest, WorldBoxesFollowTheTransform)
+{
+    const BoundsComponent bounds(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 2.0f, 0.5f));
+
+    TransformComponent transform(glm::vec3(10.0f, 0.0f, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                                 glm::vec3(2.0f));
+    Aabb box = computeWorldAabb(transform, bounds);
+    EXPECT_EQ(box.min, glm::vec3(10.0f, -4.0f, -1.0f));
+    EXPECT_EQ(box.max, glm::vec3(14.0f, 4.0f, 1.0f));
+
+    // a quarter turn around z swaps the extents along x and y, the center turns with it
+    transform.scale = glm::vec3(1.0f);
+    transform.rotation = glm::angleAxis(1.5707964f, glm::vec3(0.0f, 0.0f, 1.0f));
+    box = computeWorldAabb(transform, bounds);
+    EXPECT_NEAR(box.min.x, 8.0f, 1e-5f);
+    EXPECT_NEAR(box.max.x, 12.0f, 1e-5f);
+    EXPECT_NEAR(box.min.y, 0.0f, 1e-5f);
+    EXPECT_NEAR(box.max.y, 2.0f, 1e-5f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Queries
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(SpatialIndexTest, QueriesReturnTheOverlappingEntities)
+{
+    SpatialIndex index(*m_entityRegistry, 4.0f);
+
+    std::vector<EntityMeta> row;
+    for (int i = 0; i < 64; ++i) row.push_back(createBox(glm::vec3(float(i), 0.0f, 0.0f)));
+    const EntityMeta huge = createBox(glm::vec3(40.0f, 0.0f, 0.0f), 50.0f);
+
+    EXPECT_EQ(index.update(), 65u);
+    EXPECT_EQ(index.size(), 65u);
+    EXPECT_EQ(index.getCellCount(), 16u); // 4 boxes a cell, the huge one apart
+
+    // the boxes 10 to 12 end within [9.6, 12.4], the huge one reaches from x = -10 to 90
+    EXPECT_EQ(queryBox(index, glm::vec3(9.6f, -1.0f, -1.0f), glm::vec3(12.4f, 1.0f, 1.0f)),
+              (std::vector<EntityID>{row[10].id, row[11].id, row[12].id, huge.id}));
+
+    EXPECT_TRUE(queryBox(index, glm::vec3(10.0f, 60.0f, 0.0f), glm::vec3(20.0f, 61.0f, 1.0f))
+                    .empty());
+
+    // within 1 of (30, 1.5, 0): the boxes whose top edge at y = 0.5 is close enough
+    std::vector<EntityMeta> near;
+    index.querySphere(glm::vec3(30.0f, 1.5f, 0.0f), 1.0f, near);
+    EXPECT_EQ(ids(near), (std::vector<EntityID>{row[30].id, huge.id}));
+
+    near.clear();
+    index.querySphere(glm::vec3(30.0f, 1.5f, 0.0f), 1.2f, near);
+    EXPECT_EQ(ids(near), (std::vector<EntityID>{row[29].id, row[30].id, row[31].id, huge.id}));
+}
+
+TEST_F(SpatialIndexTest, UpdateFollowsMovesAndRemovals)
+{
+    SpatialIndex index(*m_entityRegistry, 4.0f);
+
+    const EntityMeta mover = createBox(glm::vec3(0.0f));
+    const EntityMeta stayer = createBox(glm::vec3(1.0f, 0.0f, 0.0f));
+    const EntityMeta doomed = createBox(glm::vec3(2.0f, 0.0f, 0.0f));
+    index.update();
+
+    // the creations were made in this tick, the next one sees them again
+    m_entityRegistry->advanceTick();
+    EXPECT_EQ(index.update(), 3u);
+    m_entityRegistry->advanceTick();
+    EXPECT_EQ(index.update(), 0u);
+
+    auto components = m_entityRegistry->getComponentsForEntity<TransformComponent>(mover.id);
+    ASSERT_TRUE(components.has_value());
+    std::get<0>(*components).position = glm::vec3(40.0f, 0.0f, 0.0f);
+    m_entityRegistry->markChanged<TransformComponent>(mover.id);
+
+    m_entityRegistry->destroyEntity(doomed.id);
+    m_entityRegistry->removeComponents<BoundsComponent>(stayer.id);
+
+    EXPECT_GT(index.update(), 0u);
+    EXPECT_EQ(index.size(), 1u);
+
+    EXPECT_TRUE(queryBox(index, glm::vec3(-1.0f), glm::vec3(3.0f)).empty());
+    EXPECT_EQ(queryBox(index, glm::vec3(39.0f, -1.0f, -1.0f), glm::vec3(41.0f, 1.0f, 1.0f)),
+              std::vector<EntityID>{mover.id});
+
+    // back in the index with its bounds, an entity that only gained another component stays
+    m_entityRegistry->addComponents<BoundsComponent>(stayer.id);
+    m_entityRegistry->addComponents<MeshComponent>(mover.id);
+    index.update();
+
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_EQ(queryBox(index, glm::vec3(-1.0f), glm::vec3(3.0f)),
+              std::vector<EntityID>{stayer.id});
+}
+
+TEST_F(SpatialIndexTest, ParallelRebuildAndBatchedQueriesMatchTheSerialOnes)
+{
+    mosaic::core::CPUInfo cpuInfo;
+    cpuInfo.logicalCores = 8;
+    cpuInfo.physicalCores = 4;
+
+    mosaic::exec::ThreadPool pool;
+    ASSERT_TRUE(pool.initialize(cpuInfo).isOk());
+
+    for (int z = 0; z < 20; ++z)
+    {
+        for (int x = 0; x < 200; ++x) createBox(glm::vec3(float(x) * 1.5f, 0.0f, float(z) * 1.5f));
+    }
+
+    SpatialIndex serial(*m_entityRegistry);
+    serial.rebuild();
+
+    SpatialIndex parallel(*m_entityRegistry);
+    parallel.rebuild(pool);
+    EXPECT_EQ(parallel.size(), 4000u);
+
+    std::vector<Aabb> boxes;
+    for (int i = 0; i < 32; ++i)
+    {
+        const glm::vec3 center(float(i) * 9.0f, 0.0f, float(i % 5) * 5.0f);
+        boxes.push_back({center - glm::vec3(6.0f), center + glm::vec3(6.0f)});
+    }
+
+    std::vector<std::vector<EntityMeta>> results(boxes.size());
+    parallel.query(pool, boxes, results);
+
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        std::vector<EntityMeta> expected;
+        serial.query(boxes[i], expected);
+
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(ids(results[i]), ids(expected));
+    }
+
+    pool.shutdown();
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/scene/system_scheduler.hpp>
+
+using namespace mosaic::scene;
+using namespace mosaic::ecs;
+using mosaic::ecs::detail::Read;
+using mosaic::ecs::detail::With;
+using mosaic::ecs::detail::Write;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct Position
+{
+    float x = 0.0f;
+};
+
+struct Velocity
+{
+    float x = 0.0f;
+};
+
+struct Health
+{
+    int value = 0;
+};
+
+struct Spawned
+{
+};
+
+struct Unregistered
+{
+};
+
+void noop(SystemContext&) {}
+
+} // namespace
+
+class SystemSchedulerTest : public ::testing::Test
+{
+   protected:
+    std::unique_ptr<ComponentRegistry> m_compRegistry;
+    std::unique_ptr<EntityRegistry> m_entityRegistry;
+
+    void SetUp() override
+    {
+        m_compRegistry = std::make_unique<ComponentRegistry>(16);
+
+        m_compRegistry->registerComponent<Position>("Position");
+        m_compRegistry->registerComponent<Velocity>("Velocity");
+        m_compRegistry->registerComponent<Health>("Health");
+        m_compRegistry->registerComponent<Spawned>("Spawned");
+
+        m_entityRegistry = std::make_unique<EntityRegistry>(m_compRegistry.get());
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stages
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(SystemSchedulerTest, SystemsWithoutConflictsShareAStage)
+{
+    SystemScheduler scheduler(m_compRegistry.get());
+
+    const SystemID move = scheduler.addSystem<Write<Position>, Read<Velocity>>("Move", noop);
+    const SystemID regen = scheduler.addSystem<Write<Health>>("Regen", noop);
+    const SystemID damp = scheduler.addSystem<Write<Velocity>>("Damp", noop);
+    const SystemID render = scheduler.addSystem<Read<Position>, Read<Health>>("Render", noop);
+    const SystemID count = scheduler.addSystem<With<Position>>("Count", noop);
+
+    // reads of Velocity, then its write; Render after both writers
+    ASSERT_EQ(scheduler.getStages().size(), 2u);
+    EXPECT_EQ(scheduler.getStages()[0], (std::vector<SystemID>{move, regen, count}));
+    EXPECT_EQ(scheduler.getStages()[1], (std::vector<SystemID>{damp, render}));
+
+    EXPECT_TRUE(scheduler.conflicts(move, damp));
+    EXPECT_TRUE(scheduler.conflicts(render, regen));
+    EXPECT_FALSE(scheduler.conflicts(move, regen));
+    EXPECT_FALSE(scheduler.conflicts(count, move));
+    EXPECT_EQ(scheduler.getStats(render).stage, 1u);
+
+    EXPECT_THROW(scheduler.addSystem<Write<Unregistered>>("Unregistered", noop),
+                 std::runtime_error);
+}
+
+TEST_F(SystemSchedulerTest, StructuralSystemsRunAlone)
+{
+    SystemScheduler scheduler(m_compRegistry.get());
+
+    const SystemID before = scheduler.addSystem<Read<Position>>("Before", noop);
+    const SystemID spawn = scheduler.addSystem<Structural>("Spawn", noop);
+    const SystemID after = scheduler.addSystem<Read<Health>>("After", noop);
+
+    ASSERT_EQ(scheduler.getStages().size(), 3u);
+    EXPECT_EQ(scheduler.getStages()[0], std::vector<SystemID>{before});
+    EXPECT_EQ(scheduler.getStages()[1], std::vector<SystemID>{spawn});
+    EXPECT_EQ(scheduler.getStages()[2], std::vector<SystemID>{after});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Running
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(SystemSchedulerTest, CommandsArePlayedBackAtStageBoundaries)
+{
+    SystemScheduler scheduler(m_compRegistry.get());
+    auto spawned = m_entityRegistry->query<Read<Spawned>>();
+
+    size_t seenInStage = 0;
+    size_t seenAfter = 0;
+
+    scheduler.addSystem<Read<Position>>("Spawner", [](SystemContext& _context)
+                                        { _context.commands.createEntity<Spawned>(); });
+    scheduler.addSystem<Read<Spawned>>("SameStage", [&](SystemContext&)
+                                       { seenInStage = spawned.entityCount(); });
+    scheduler.addSystem<Structural>("NextStage", [&](SystemContext&)
+                                    { seenAfter = spawned.entityCount(); });
+
+    ASSERT_EQ(scheduler.getStages().size(), 2u);
+
+    scheduler.run(*m_entityRegistry);
+
+    EXPECT_EQ(seenInStage, 0u);
+    EXPECT_EQ(seenAfter, 1u);
+    EXPECT_EQ(spawned.entityCount(), 1u);
+}
+
+TEST_F(SystemSchedulerTest, StagesRunInParallelOnThePool)
+{
+    mosaic::core::CPUInfo cpuInfo;
+    cpuInfo.logicalCores = 8;
+    cpuInfo.physicalCores = 4;
+
+    mosaic::exec::ThreadPool pool;
+    ASSERT_TRUE(pool.initialize(cpuInfo).isOk());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        m_entityRegistry->createEntity<Position, Velocity, Health>(
+            std::make_tuple(0.0f), std::make_tuple(1.0f), std::make_tuple(10));
+    }
+
+    auto movers = m_entityRegistry->query<Write<Position>, Read<Velocity>>();
+    auto healths = m_entityRegistry->query<Write<Health>>();
+    auto positions = m_entityRegistry->query<Read<Position>>();
+
+    SystemScheduler scheduler(m_compRegistry.get());
+    std::atomic<int> sum = 0;
+
+    scheduler.addSystem<Write<Position>, Read<Velocity>>(
+        "Move", [&](SystemContext&)
+        { movers.forEach([](EntityMeta, Position& _p, const Velocity& _v) { _p.x += _v.x; }); });
+    scheduler.addSystem<Write<Health>>(
+        "Regen",
+        [&](SystemContext&) { healths.forEach([](EntityMeta, Health& _h) { _h.value += 1; }); });
+    const SystemID total = scheduler.addSystem<Read<Position>>(
+        "Sum", [&](SystemContext&)
+        {
+            positions.forEach([&](EntityMeta, const Position& _p)
+                              { sum += static_cast<int>(_p.x); });
+        });
+
+    for (int frame = 0; frame < 3; ++frame) scheduler.run(pool, *m_entityRegistry);
+
+    // every frame, the sum follows the move of the same frame
+    EXPECT_EQ(sum.load(), 1000 * (1 + 2 + 3));
+    healths.forEach([](EntityMeta, Health& _h) { EXPECT_EQ(_h.value, 13); });
+
+    EXPECT_EQ(scheduler.getStats(total).stage, 1u);
+    EXPECT_GT(scheduler.getStats(total).duration.count(), 0);
+
+    pool.shutdown();
+}
+
+TEST_F(SystemSchedulerTest, ThrowingSystemsDiscardTheCommandsOfTheirStage)
+{
+    SystemScheduler scheduler(m_compRegistry.get());
+    bool nextStageRan = false;
+
+    scheduler.addSystem<Read<Position>>("Spawner", [](SystemContext& _context)
+                                        { _context.commands.createEntity<Spawned>(); });
+    scheduler.addSystem<Read<Health>>("Thrower", [](SystemContext&)
+                                      { throw std::runtime_error("system failed"); });
+    scheduler.addSystem<Structural>("Next", [&](SystemContext&) { nextStageRan = true; });
+
+    EXPECT_THROW(scheduler.run(*m_entityRegistry), std::runtime_error);
+
+    EXPECT_FALSE(nextStageRan);
+    EXPECT_EQ(m_entityRegistry->query<Read<Spawned>>().entityCount(), 0u);
+}
@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <mosaic/graphics/texture_streaming.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// 256x256 textures of 9 mips, a tail of mip 2 (64x64) and down
+constexpr uint32_t k_extent = 256;
+constexpr uint32_t k_mipLevels = 9;
+constexpr uint32_t k_tailMip = 2;
+
+uint64_t chainSize(uint32_t _firstMip)
+{
+    return TextureStreamer::getMipChainSize(k_extent, k_extent, k_mipLevels, _firstMip,
+                                            TextureFormat::RGBA8);
+}
+
+// Applies the changes at once, as if every upload completed
+void complete(TextureStreamer& _streamer, const std::vector<TextureResidencyChange>& _changes)
+{
+    for (const TextureResidencyChange& change : _changes)
+    {
+        _streamer.onResident(change.texture, change.firstMip);
+    }
+}
+
+// Textures resident at their tail
+TextureStreamer makeStreamer(uint64_t _budget, uint32_t _textures)
+{
+    TextureStreamingSettings settings;
+    settings.budget = _budget;
+
+    TextureStreamer streamer(settings);
+    for (uint32_t i = 0; i < _textures; ++i) streamer.add(k_extent, k_extent, k_mipLevels);
+
+    complete(streamer, streamer.update());
+    return streamer;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Mip selection
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(TextureStreamerTest, SelectsTheMipOfATexelPerPixel)
+{
+    EXPECT_EQ(TextureStreamer::selectMip(1024, 512, 11, 2048.0f), 0u);
+    EXPECT_EQ(TextureStreamer::selectMip(1024, 512, 11, 1024.0f), 0u);
+    EXPECT_EQ(TextureStreamer::selectMip(1024, 512, 11, 512.0f), 1u);
+    EXPECT_EQ(TextureStreamer::selectMip(1024, 512, 11, 300.0f), 1u);
+    EXPECT_EQ(TextureStreamer::selectMip(1024, 512, 11, 1.0f), 10u);
+
+    // not visible
+    EXPECT_EQ(TextureStreamer::selectMip(1024, 512, 11, 0.0f), 10u);
+    EXPECT_EQ(TextureStreamer::selectMip(1024, 512, 11, 0.1f), 10u);
+}
+
+TEST(TextureStreamerTest, SumsTheMipsOfAChain)
+{
+    EXPECT_EQ(TextureStreamer::getMipChainSize(4, 2, 3, 0, TextureFormat::RGBA8),
+              (8u + 2u + 1u) * 4u);
+    EXPECT_EQ(TextureStreamer::getMipChainSize(4, 2, 3, 1, TextureFormat::RGBA8), (2u + 1u) * 4u);
+    EXPECT_EQ(TextureStreamer::getMipChainSize(4, 2, 3, 3, TextureFormat::RGBA8), 0u);
+
+    // a block at least per mip
+    EXPECT_EQ(TextureStreamer::getMipChainSize(8, 8, 4, 0, TextureFormat::BC1),
+              (4u + 1u + 1u + 1u) * 8u);
+    EXPECT_EQ(TextureStreamer::getMipChainSize(8, 8, 4, 0, TextureFormat::ASTC4x4), 7u * 16u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loading
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(TextureStreamerTest, LoadsTheTailFirstWhateverTheBudget)
+{
+    TextureStreamingSettings settings;
+    settings.budget = 0;
+
+    TextureStreamer streamer(settings);
+    const StreamedTextureId id = streamer.add(k_extent, k_extent, k_mipLevels);
+    EXPECT_EQ(streamer.getResidentMip(id), k_mipLevels);
+
+    std::vector<TextureResidencyChange> changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].texture, id);
+    EXPECT_EQ(changes[0].firstMip, k_tailMip);
+    EXPECT_EQ(streamer.getCommittedSize(), chainSize(k_tailMip));
+
+    // planned once
+    EXPECT_TRUE(streamer.update().empty());
+
+    complete(streamer, changes);
+    EXPECT_EQ(streamer.getResidentMip(id), k_tailMip);
+}
+
+TEST(TextureStreamerTest, LoadsTheMipsTheScreenSizeNeeds)
+{
+    TextureStreamer streamer = makeStreamer(UINT64_MAX, 1);
+
+    // the largest request of the frame
+    streamer.request(0, 40.0f);
+    streamer.request(0, 128.0f);
+
+    std::vector<TextureResidencyChange> changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].firstMip, 1u);
+
+    // one change in flight at a time
+    streamer.request(0, 256.0f);
+    EXPECT_TRUE(streamer.update().empty());
+
+    complete(streamer, changes);
+    streamer.request(0, 256.0f);
+    changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].firstMip, 0u);
+}
+
+TEST(TextureStreamerTest, LoadsTheMostBlurredFirstWithinTheBudget)
+{
+    // the tails, and mip 1 of one texture
+    const uint64_t budget = 2 * chainSize(k_tailMip) + chainSize(1) - chainSize(k_tailMip);
+    TextureStreamer streamer = makeStreamer(budget, 2);
+
+    streamer.request(0, 128.0f); // mip 1
+    streamer.request(1, 256.0f); // mip 0, more blurred
+
+    // mip 0 does not fit, the finest mips that do are loaded instead
+    std::vector<TextureResidencyChange> changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].texture, 1u);
+    EXPECT_EQ(changes[0].firstMip, 1u);
+    EXPECT_LE(streamer.getCommittedSize(), budget);
+}
+
+TEST(TextureStreamerTest, NeverStreamsMipsLargerThanAnUpload)
+{
+    TextureStreamingSettings settings;
+    settings.maxMipSize = 128 * 128 * 4;
+
+    TextureStreamer streamer(settings);
+    streamer.add(k_extent, k_extent, k_mipLevels);
+    complete(streamer, streamer.update());
+
+    streamer.request(0, 1024.0f);
+    std::vector<TextureResidencyChange> changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].firstMip, 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Eviction
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(TextureStreamerTest, EvictsTheLeastRecentlyDrawnFirst)
+{
+    TextureStreamer streamer = makeStreamer(UINT64_MAX, 3);
+
+    // every texture at mip 0, drawn last in the order 1, 0, 2
+    for (StreamedTextureId id = 0; id < 3; ++id) streamer.request(id, 256.0f);
+    complete(streamer, streamer.update());
+
+    streamer.request(0, 256.0f);
+    streamer.request(2, 256.0f);
+    complete(streamer, streamer.update());
+
+    streamer.request(2, 256.0f);
+    complete(streamer, streamer.update());
+
+    ASSERT_EQ(streamer.getResidentMip(0), 0u);
+    ASSERT_EQ(streamer.getResidentMip(1), 0u);
+    ASSERT_EQ(streamer.getResidentMip(2), 0u);
+
+    // room for one texture at mip 0 less
+    streamer.setBudget(streamer.getCommittedSize() - chainSize(0) + chainSize(k_tailMip));
+    streamer.request(2, 256.0f);
+
+    std::vector<TextureResidencyChange> changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].texture, 1u);
+    EXPECT_EQ(changes[0].firstMip, k_tailMip);
+
+    // counted until it completed: nothing else is evicted meanwhile
+    EXPECT_TRUE(streamer.update().empty());
+
+    complete(streamer, changes);
+    EXPECT_LE(streamer.getCommittedSize(), streamer.getBudget());
+}
+
+TEST(TextureStreamerTest, LoadsOnceTheEvictionsFreedTheMemory)
+{
+    // the tails, and one texture at mip 0
+    const uint64_t budget = chainSize(0) + chainSize(k_tailMip);
+    TextureStreamer streamer = makeStreamer(budget, 2);
+
+    streamer.request(0, 256.0f);
+    complete(streamer, streamer.update());
+    ASSERT_EQ(streamer.getResidentMip(0), 0u);
+
+    // texture 0 is no longer drawn: evicted for texture 1, which waits for it
+    streamer.request(1, 256.0f);
+    std::vector<TextureResidencyChange> changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].texture, 0u);
+    EXPECT_EQ(changes[0].firstMip, k_tailMip);
+
+    complete(streamer, changes);
+    streamer.request(1, 256.0f);
+    changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].texture, 1u);
+    EXPECT_EQ(changes[0].firstMip, 0u);
+}
+
+TEST(TextureStreamerTest, KeepsTheTexturesDrawnWhenNothingElseCanBeEvicted)
+{
+    const uint64_t budget = chainSize(1) + chainSize(k_tailMip);
+    TextureStreamer streamer = makeStreamer(budget, 2);
+
+    streamer.request(0, 128.0f);
+    complete(streamer, streamer.update());
+    ASSERT_EQ(streamer.getResidentMip(0), 1u);
+
+    // both drawn: nothing is left for texture 1, texture 0 keeps its mips
+    streamer.request(0, 128.0f);
+    streamer.request(1, 128.0f);
+    std::vector<TextureResidencyChange> changes = streamer.update();
+    EXPECT_TRUE(changes.empty());
+    EXPECT_EQ(streamer.getResidentMip(0), 1u);
+
+    // drawn smaller, texture 0 gives its finer mips up
+    streamer.request(0, 64.0f);
+    streamer.request(1, 128.0f);
+    changes = streamer.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].texture, 0u);
+    EXPECT_EQ(changes[0].firstMip, k_tailMip);
+}
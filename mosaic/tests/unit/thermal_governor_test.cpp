@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <limits>
+
+#include <mosaic/core/thermal_governor.hpp>
+
+using namespace mosaic::core;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr float k_noForecast = std::numeric_limits<float>::quiet_NaN();
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Levels
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ThermalGovernorTest, TheHotterOfTheStatusAndTheForecastWins)
+{
+    ThermalGovernor governor;
+
+    EXPECT_EQ(governor.getLevelOf({}), 0u);
+    EXPECT_EQ(governor.getLevelOf({ThermalStatus::light, k_noForecast}), 0u);
+    EXPECT_EQ(governor.getLevelOf({ThermalStatus::moderate, k_noForecast}), 1u);
+    EXPECT_EQ(governor.getLevelOf({ThermalStatus::severe, k_noForecast}), 2u);
+    EXPECT_EQ(governor.getLevelOf({ThermalStatus::shutdown, k_noForecast}), 3u);
+
+    // throttling forecast while the status is still cool
+    EXPECT_EQ(governor.getLevelOf({ThermalStatus::none, 0.8f}), 1u);
+    EXPECT_EQ(governor.getLevelOf({ThermalStatus::light, 1.2f}), 3u);
+    EXPECT_EQ(governor.getLevelOf({ThermalStatus::severe, 0.1f}), 2u);
+}
+
+TEST(ThermalGovernorTest, HotterLevelsApplyAtOnceCoolerOnesOneAtATime)
+{
+    ThermalGovernor governor;
+    const auto delay = governor.getSettings().recoveryDelay;
+
+    ThermalGovernor::Clock::time_point now{};
+
+    EXPECT_EQ(governor.update({ThermalStatus::critical, k_noForecast}, now), 3u);
+    EXPECT_EQ(governor.getPerformanceLevel().frameRateLimit, 30.0);
+
+    const ThermalState cool{ThermalStatus::none, 0.2f};
+
+    // not before the delay, then a level per delay
+    EXPECT_EQ(governor.update(cool, now += delay / 2), 3u);
+    EXPECT_EQ(governor.update(cool, now += delay / 2), 2u);
+    EXPECT_EQ(governor.update(cool, now += delay / 2), 2u);
+
+    // heating up again restarts the delay
+    EXPECT_EQ(governor.update({ThermalStatus::severe, k_noForecast}, now += delay / 2), 2u);
+    EXPECT_EQ(governor.update(cool, now += delay / 2), 2u);
+    EXPECT_EQ(governor.update(cool, now += delay / 2), 1u);
+    EXPECT_EQ(governor.update(cool, now += delay), 0u);
+    EXPECT_EQ(governor.getPerformanceLevel().workers, 1.0f);
+
+    governor.update({ThermalStatus::moderate, k_noForecast}, now);
+    governor.reset();
+    EXPECT_EQ(governor.getLevel(), 0u);
+}
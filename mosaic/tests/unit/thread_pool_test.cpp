@@ -2,15 +2,27 @@
 #include <gmock/gmock.h>
 
 #include "mosaic/exec/thread_pool.hpp"
-
+#include "mosaic/exec/main_thread_queue.hpp"
+#include "mosaic/exec/render_thread.hpp"
+#include "mosaic/exec/task_graph.hpp"
+#include "mosaic/exec/parallel_for.hpp"
+#include "mosaic/exec/coroutines.hpp"
+#include "mosaic/exec/work_stealing_deque.hpp"
+#include "mosaic/exec/scratch_arena.hpp"
+#include "mosaic/exec/strand.hpp"
+
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <thread>
 #include <vector>
 #include <numeric>
+#include <set>
+#include <ranges>
 #include <algorithm>
 #include <latch>
 #include <barrier>
+#include <memory_resource>
 
 using namespace mosaic::exec;
 using namespace std::chrono_literals;
@@ -96,6 +108,39 @@ TEST_F(ThreadPoolTest, SimpleTaskExecution)
     EXPECT_TRUE(executed.load());
 }
 
+TEST_F(ThreadPoolTest, IdlePolicyIsConfigurable)
+{
+    const IdlePolicy initial = pool->getIdlePolicy();
+    EXPECT_EQ(initial.spinDuration, idle_policy_presets::platform_default.spinDuration);
+    EXPECT_EQ(initial.parkTimeout, idle_policy_presets::platform_default.parkTimeout);
+
+    pool->setIdlePolicy(idle_policy_presets::power_saving);
+
+    const IdlePolicy current = pool->getIdlePolicy();
+    EXPECT_EQ(current.spinDuration, idle_policy_presets::power_saving.spinDuration);
+    EXPECT_EQ(current.yieldDuration, idle_policy_presets::power_saving.yieldDuration);
+    EXPECT_EQ(current.parkTimeout, idle_policy_presets::power_saving.parkTimeout);
+}
+
+TEST_F(ThreadPoolTest, ParkedWorkersWakeUpOnSubmission)
+{
+    // parked workers would only wake up on their own after a second
+    pool->setIdlePolicy({0us, 0us, 1s});
+    ASSERT_TRUE(waitFor([&] { return pool->getIdleWorkersCount() == pool->getWorkersCount(); }));
+    std::this_thread::sleep_for(20ms);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        auto future = pool->enqueueToWorker([] { return 1; });
+        ASSERT_TRUE(future.has_value());
+        EXPECT_EQ(future->get(), 1);
+
+        EXPECT_LT(std::chrono::steady_clock::now() - start, 500ms);
+    }
+}
+
 TEST_F(ThreadPoolTest, TaskWithReturnValue)
 {
     auto future = pool->enqueueToWorker([]() { return 42; });
@@ -147,6 +192,145 @@ TEST_F(ThreadPoolTest, DirectTaskAssignment)
     EXPECT_TRUE(executed.load());
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Placement Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// 4 P-cores with two threads each (0-7, siblings side by side), then 4 E-cores (8-11).
+mosaic::core::CPUInfo hybridCPU()
+{
+    mosaic::core::CPUInfo info;
+
+    for (uint32_t id = 0; id < 12; ++id)
+    {
+        mosaic::core::LogicalProcessorInfo processor;
+        processor.id = id;
+        processor.coreId = id < 8 ? id & ~1u : id;
+        processor.efficiencyClass = id < 8 ? 1 : 0;
+        info.processors.push_back(processor);
+    }
+
+    info.logicalCores = 12;
+    return info;
+}
+
+std::vector<uint32_t> processorsOf(const std::vector<WorkerPlacement>& _placements)
+{
+    std::vector<uint32_t> ids;
+    for (const auto& placement : _placements) ids.push_back(placement.processor);
+    return ids;
+}
+
+} // namespace
+
+TEST(WorkerPlacementTest, PerformanceCoresFirstAndSiblingsLast)
+{
+    const auto placements = planWorkerPlacement(hybridCPU(), 11);
+
+    // processor 0 is left to the main thread
+    EXPECT_THAT(processorsOf(placements),
+                ::testing::ElementsAre(2, 4, 6, 8, 9, 10, 11, 1, 3, 5, 7));
+
+    for (size_t i = 0; i < placements.size(); ++i)
+    {
+        EXPECT_EQ(placements[i].performanceCore, i < 3 || i >= 7) << "worker " << i;
+    }
+
+    EXPECT_TRUE(planWorkerPlacement(mosaic::core::CPUInfo{}, 4).empty());
+}
+
+TEST(WorkerPlacementTest, NeighbouringWorkersShareTheirNodeAndCache)
+{
+    // two NUMA nodes interleaved by id, two L3 groups per node
+    mosaic::core::CPUInfo info;
+
+    for (uint32_t id = 0; id < 8; ++id)
+    {
+        mosaic::core::LogicalProcessorInfo processor;
+        processor.id = id;
+        processor.coreId = id;
+        processor.numaNode = id % 2;
+        processor.cacheGroup = id % 4;
+        info.processors.push_back(processor);
+    }
+
+    const auto placements = planWorkerPlacement(info, 9);
+
+    EXPECT_THAT(processorsOf(placements), ::testing::ElementsAre(4, 2, 6, 1, 5, 3, 7, 0, 4));
+}
+
+TEST_F(ThreadPoolTest, HybridPoolsLeaveBackgroundTasksToEfficiencyCores)
+{
+    pool->shutdown();
+    pool.reset();
+
+    pool = std::make_unique<ThreadPool>();
+    ASSERT_TRUE(pool->initialize(hybridCPU()).isOk());
+    ASSERT_EQ(pool->getWorkersCount(), 11u);
+
+    EXPECT_TRUE(pool->getWorkerPlacement(0).performanceCore);
+    EXPECT_FALSE(pool->getWorkerPlacement(3).performanceCore);
+
+    std::vector<TaskFuture<void>> futures;
+    for (int i = 0; i < 64; ++i)
+    {
+        auto future = pool->enqueueToWorker(TaskPriority::background, [] {});
+        ASSERT_TRUE(future.has_value());
+        futures.push_back(std::move(*future));
+    }
+
+    for (auto& future : futures) future.get();
+
+    // counted once the task returned
+    ASSERT_TRUE(waitFor([&] { return pool->getPoolStats().totalTasksExecuted == 64; }));
+
+    for (uint32_t i = 0; i < pool->getWorkersCount(); ++i)
+    {
+        if (!pool->getWorkerPlacement(i).performanceCore) continue;
+
+        EXPECT_EQ(pool->getWorkerStats(i).tasksExecuted, 0u) << "worker " << i;
+    }
+}
+
+TEST_F(ThreadPoolTest, SuspendedWorkersTakeNoNewTasks)
+{
+    const uint32_t workers = pool->getWorkersCount();
+    ASSERT_GT(workers, 2u);
+    EXPECT_EQ(pool->getActiveWorkersCount(), workers);
+
+    pool->setActiveWorkersCount(2);
+    EXPECT_EQ(pool->getActiveWorkersCount(), 2u);
+    pool->resetStats();
+
+    std::vector<TaskFuture<void>> futures;
+    for (int i = 0; i < 64; ++i)
+    {
+        auto indirect = pool->enqueueToWorker(TaskPriority::normal, [] {});
+        auto global = pool->enqueueToGlobal(TaskPriority::background, [] {});
+        ASSERT_TRUE(indirect.has_value() && global.has_value());
+
+        futures.push_back(std::move(*indirect));
+        futures.push_back(std::move(*global));
+    }
+
+    for (auto& future : futures) future.get();
+    ASSERT_TRUE(waitFor([&] { return pool->getPoolStats().totalTasksExecuted == 128; }));
+
+    for (uint32_t i = 2; i < workers; ++i)
+    {
+        EXPECT_EQ(pool->getWorkerStats(i).tasksExecuted, 0u) << "worker " << i;
+    }
+
+    // at least one, at most every worker
+    pool->setActiveWorkersCount(0);
+    EXPECT_EQ(pool->getActiveWorkersCount(), 1u);
+    pool->setActiveWorkersCount(workers * 2);
+    EXPECT_EQ(pool->getActiveWorkersCount(), workers);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Concurrency Tests
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -274,6 +458,605 @@ TEST_F(ThreadPoolTest, WorkStealingOccurs)
     EXPECT_LT(elapsed, 500ms);
 }
 
+TEST(WorkStealingDequeTest, OwnerPopsNewestAndThievesStealOldest)
+{
+    WorkStealingDeque<int> deque(4);
+
+    EXPECT_FALSE(deque.pop().has_value());
+    EXPECT_FALSE(deque.steal().has_value());
+
+    for (int i = 0; i < 1000; ++i) deque.push(i);
+
+    EXPECT_EQ(deque.size(), 1000u);
+    EXPECT_GE(deque.capacity(), 1000);
+
+    EXPECT_EQ(deque.steal(), 0);
+    EXPECT_EQ(deque.pop(), 999);
+    EXPECT_EQ(deque.steal(), 1);
+    EXPECT_EQ(deque.pop(), 998);
+
+    while (deque.pop().has_value())
+    {
+    }
+
+    EXPECT_TRUE(deque.empty());
+    EXPECT_FALSE(deque.steal().has_value());
+}
+
+TEST(WorkStealingDequeTest, EveryElementIsTakenExactlyOnce)
+{
+    constexpr int elementCount = 100000;
+    constexpr int thiefCount = 3;
+
+    WorkStealingDeque<int> deque(16);
+    std::vector<std::atomic<int>> taken(elementCount);
+    std::atomic<bool> done{false};
+
+    std::vector<std::jthread> thieves;
+    for (int t = 0; t < thiefCount; ++t)
+    {
+        thieves.emplace_back(
+            [&]
+            {
+                while (!done.load(std::memory_order_acquire) || !deque.empty())
+                {
+                    if (std::optional<int> value = deque.steal()) taken[*value].fetch_add(1);
+                }
+            });
+    }
+
+    // the owner pops every third push, racing with the thieves for the last elements
+    for (int i = 0; i < elementCount; ++i)
+    {
+        deque.push(i);
+
+        if (i % 3 == 0)
+        {
+            if (std::optional<int> value = deque.pop()) taken[*value].fetch_add(1);
+        }
+    }
+
+    while (std::optional<int> value = deque.pop()) taken[*value].fetch_add(1);
+
+    done.store(true, std::memory_order_release);
+    thieves.clear();
+
+    for (int i = 0; i < elementCount; ++i) ASSERT_EQ(taken[i].load(), 1) << "element " << i;
+}
+
+TEST_F(ThreadPoolTest, LocalTasksRunNewestFirstOnTheirWorker)
+{
+    constexpr int childCount = 64;
+
+    std::atomic<int> remaining{childCount};
+    std::vector<int> ranByParentWorker; // only touched by the parent's worker
+
+    auto parent = pool->enqueueToWorker(
+        [&]
+        {
+            const std::thread::id parentThread = std::this_thread::get_id();
+
+            for (int i = 0; i < childCount; ++i)
+            {
+                pool->enqueueToCurrentWorker(
+                    [&, i, parentThread]
+                    {
+                        if (std::this_thread::get_id() == parentThread)
+                        {
+                            ranByParentWorker.push_back(i);
+                        }
+
+                        remaining.fetch_sub(1);
+                    });
+            }
+
+            // helping runs the deque of the worker from its bottom, thieves take from the top
+            while (remaining.load() > 0) pool->tryExecutePendingTask();
+        });
+
+    ASSERT_TRUE(parent.has_value());
+    parent->get();
+
+    // whatever the thieves took, the worker always ran the newest child left
+    EXPECT_TRUE(std::ranges::is_sorted(ranByParentWorker, std::greater<>{}));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Priority Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, WorkersRunCriticalTasksBeforeBackgroundOnes)
+{
+    constexpr int childCount = 32;
+
+    std::atomic<int> remaining{2 * childCount};
+    std::vector<TaskPriority> ranByParentWorker; // only touched by the parent's worker
+
+    auto parent = pool->enqueueToWorker(
+        [&]
+        {
+            const std::thread::id parentThread = std::this_thread::get_id();
+
+            // background first, so that queue order alone would run them first
+            for (TaskPriority priority : {TaskPriority::background, TaskPriority::critical})
+            {
+                for (int i = 0; i < childCount; ++i)
+                {
+                    pool->enqueueToCurrentWorker(
+                        [&, priority, parentThread]
+                        {
+                            if (std::this_thread::get_id() == parentThread)
+                            {
+                                ranByParentWorker.push_back(priority);
+                            }
+
+                            remaining.fetch_sub(1);
+                        },
+                        priority);
+                }
+            }
+        });
+
+    ASSERT_TRUE(parent.has_value());
+    parent->get();
+    ASSERT_TRUE(waitFor([&] { return remaining.load() == 0; }));
+
+    // thieves may take some of either, the worker itself never ran a background task first
+    EXPECT_TRUE(std::ranges::is_sorted(ranByParentWorker));
+}
+
+TEST_F(ThreadPoolTest, BackgroundTasksStayOnBackgroundLanes)
+{
+    ASSERT_GE(pool->getWorkersCount(), 2u);
+
+    pool->setWorkerSharingMode(0, worker_sharing_presets::background_lane);
+    for (uint32_t i = 1; i < pool->getWorkersCount(); ++i)
+    {
+        pool->setWorkerSharingMode(i, worker_sharing_presets::frame_lane);
+    }
+
+    std::vector<TaskFuture<std::thread::id>> background;
+    std::vector<TaskFuture<std::thread::id>> frame;
+
+    for (int i = 0; i < 32; ++i)
+    {
+        auto id = [] { return std::this_thread::get_id(); };
+
+        auto b = pool->enqueueToWorker(TaskPriority::background, id);
+        auto f = pool->enqueueToGlobal(TaskPriority::critical, id);
+        ASSERT_TRUE(b.has_value() && f.has_value());
+
+        background.push_back(std::move(*b));
+        frame.push_back(std::move(*f));
+    }
+
+    // the lane's own normal tasks can be stolen, its background tasks cannot
+    const std::thread::id laneThread = background.front().get();
+
+    for (size_t i = 1; i < background.size(); ++i) EXPECT_EQ(background[i].get(), laneThread);
+    for (auto& f : frame) EXPECT_NE(f.get(), laneThread);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bulk Submission Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, EnqueueBulkRunsEveryElementOnce)
+{
+    constexpr size_t count = 10000;
+    std::vector<std::atomic<int>> visits(count);
+
+    auto done = pool->enqueueBulk(std::views::iota(size_t{0}, count),
+                                  [&](size_t _i) { visits[_i].fetch_add(1); });
+
+    ASSERT_TRUE(done.has_value());
+    done->get();
+
+    for (size_t i = 0; i < count; ++i) ASSERT_EQ(visits[i].load(), 1) << "index " << i;
+
+    // elements of a container are copied into their task, fewer than the workers here
+    const std::vector<int> values = {1, 2, 3};
+    std::atomic<int> sum{0};
+
+    auto small = pool->enqueueBulk(values, [&](int _value) { sum.fetch_add(_value); },
+                                   TaskPriority::critical);
+
+    ASSERT_TRUE(small.has_value());
+    small->get();
+    EXPECT_EQ(sum.load(), 6);
+
+    auto empty = pool->enqueueBulk(std::vector<int>{}, [](int) { FAIL() << "empty range"; });
+
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_TRUE(empty->isReady());
+}
+
+TEST_F(ThreadPoolTest, WorkerScratchArenasAreRewoundAfterEveryTask)
+{
+    auto first = pool->enqueueToWorker(
+        []
+        {
+            ScratchArena& scratch = currentScratch();
+            const size_t before = scratch.used();
+
+            auto values = scratch.makeArray<uint32_t>(1024);
+            std::iota(values.begin(), values.end(), 0u);
+
+            // past the arena, the pmr resource falls back to the heap
+            std::pmr::vector<uint8_t> large(ScratchArena::k_workerCapacity * 2,
+                                            scratch.getResource());
+            const bool spilled = !scratch.owns(large.data());
+
+            return std::make_tuple(&scratch, before, scratch.used() > before, spilled,
+                                   values.back());
+        });
+
+    ASSERT_TRUE(first.has_value());
+    const auto [scratch, before, grew, spilled, last] = first->get();
+
+    EXPECT_EQ(before, 0u);
+    EXPECT_TRUE(grew);
+    EXPECT_TRUE(spilled);
+    EXPECT_EQ(last, 1023u);
+    EXPECT_NE(scratch, &currentScratch()) << "the main thread has an arena of its own";
+
+    // every task starts from an empty arena, whatever the worker ran before
+    std::atomic<size_t> leaked{0};
+    std::vector<TaskFuture<void>> futures;
+
+    for (int i = 0; i < 64; ++i)
+    {
+        auto future = pool->enqueueToWorker(
+            [&leaked]
+            {
+                ScratchArena& arena = currentScratch();
+                leaked.fetch_add(arena.used());
+                (void)arena.allocate(4096);
+            });
+
+        ASSERT_TRUE(future.has_value());
+        futures.push_back(std::move(*future));
+    }
+
+    for (auto& future : futures) future.get();
+    EXPECT_EQ(leaked.load(), 0u);
+
+    // off the workers, the arena is only rewound by a scope
+    ScratchArena& mainScratch = currentScratch();
+    const size_t mainUsed = mainScratch.used();
+    {
+        const auto scope = mainScratch.scope();
+        EXPECT_NE(mainScratch.allocate(256), nullptr);
+        EXPECT_GE(mainScratch.peakUsed(), mainUsed + 256);
+    }
+    EXPECT_EQ(mainScratch.used(), mainUsed);
+}
+
+TEST_F(ThreadPoolTest, EnqueueBulkForwardsTheFirstException)
+{
+    std::atomic<int> ran{0};
+
+    auto done = pool->enqueueBulk(std::views::iota(0, 1000),
+                                  [&](int _i)
+                                  {
+                                      ran.fetch_add(1);
+                                      if (_i % 100 == 0) throw std::runtime_error("Test exception");
+                                  });
+
+    ASSERT_TRUE(done.has_value());
+    EXPECT_THROW(done->get(), std::runtime_error);
+    EXPECT_LE(ran.load(), 1000);
+
+    // the pool is unaffected by the failed batch
+    auto next = pool->enqueueToWorker([] { return 42; });
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next->get(), 42);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Strand Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, StrandsRunTheirTasksOneAtATimeInPostingOrder)
+{
+    constexpr int producers = 4;
+    constexpr int perProducer = 2000;
+
+    Strand strand(*pool);
+
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    std::array<int, producers> lastSeen{}; // only touched by the strand's tasks
+    bool outOfOrder = false;
+    int total = 0;
+
+    {
+        std::vector<std::jthread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back(
+                [&, p]
+                {
+                    for (int i = 1; i <= perProducer; ++i)
+                    {
+                        strand.post(
+                            [&, p, i]
+                            {
+                                if (running.fetch_add(1) != 0) overlapped = true;
+
+                                if (lastSeen[p] != i - 1) outOfOrder = true;
+                                lastSeen[p] = i;
+                                ++total;
+
+                                running.fetch_sub(1);
+                            });
+                    }
+                });
+        }
+    }
+
+    auto last = strand.enqueue([&] { return std::make_pair(total, strand.runningInThisThread()); });
+    const auto [seen, inStrand] = last.get();
+
+    EXPECT_EQ(seen, producers * perProducer);
+    EXPECT_FALSE(overlapped.load());
+    EXPECT_FALSE(outOfOrder);
+    EXPECT_TRUE(inStrand);
+    EXPECT_FALSE(strand.runningInThisThread());
+    EXPECT_TRUE(waitFor([&] { return strand.getPendingCount() == 0; }));
+
+    // a throwing task is logged, the stream goes on
+    strand.post([] { throw std::runtime_error("strand task"); });
+    EXPECT_EQ(strand.enqueue([] { return 42; }).get(), 42);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cancellation Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, CancelledTokensDropQueuedTasksAndStopRunningOnes)
+{
+    CancellationSource source;
+    std::atomic<bool> started{false};
+
+    // polls the token until the source is cancelled
+    auto running = pool->enqueueToWorker(source.token(),
+                                         [&, token = source.token()]
+                                         {
+                                             started.store(true);
+                                             while (!token.isCancellationRequested())
+                                             {
+                                                 std::this_thread::yield();
+                                             }
+                                             return 7;
+                                         });
+
+    ASSERT_TRUE(running.has_value());
+    ASSERT_TRUE(waitFor([&] { return started.load(); }));
+
+    EXPECT_TRUE(source.cancel());
+    EXPECT_FALSE(source.cancel());
+    EXPECT_EQ(running->get(), 7);
+
+    // queued after the cancellation, dropped by the worker taking it
+    std::atomic<bool> ran{false};
+    auto dropped = pool->enqueueToGlobal(TaskPriority::critical, source.token(),
+                                         [&] { ran.store(true); });
+
+    ASSERT_TRUE(dropped.has_value());
+    dropped->wait();
+    EXPECT_TRUE(dropped->isCancelled());
+    EXPECT_FALSE(ran.load());
+
+    // a token without source never cancels
+    auto plain = pool->enqueueToWorker(CancellationToken{}, [] { return 1; });
+    ASSERT_TRUE(plain.has_value());
+    EXPECT_EQ(plain->get(), 1);
+}
+
+TEST_F(ThreadPoolTest, DeadlinesCancelTheirSource)
+{
+    CancellationSource source(std::chrono::steady_clock::now() + 20ms);
+    const CancellationToken token = source.token();
+
+    EXPECT_TRUE(token.canBeCancelled());
+    EXPECT_FALSE(token.isCancellationRequested());
+    EXPECT_TRUE(waitFor([&] { return token.isCancellationRequested(); }));
+
+    CancellationSource expired;
+    expired.cancelAfter(0ms);
+
+    std::atomic<int> ran{0};
+    auto batch = pool->enqueueBulk(std::views::iota(0, 100), [&](int) { ran.fetch_add(1); },
+                                   TaskPriority::normal, expired.token());
+
+    ASSERT_TRUE(batch.has_value());
+    batch->wait();
+    EXPECT_TRUE(batch->isCancelled());
+    EXPECT_EQ(ran.load(), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Main Thread Queue Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, MainThreadQueueRunsWorkerTasksOnTheDrainingThread)
+{
+    MainThreadQueue mainThread;
+    const std::thread::id mainId = std::this_thread::get_id();
+
+    // workers hand their results back, and wait for the main thread themselves
+    auto worker = pool->enqueueToWorker(
+        [&]
+        {
+            auto onMain = mainThread.enqueue([&](int _value)
+                                             { return std::this_thread::get_id() == mainId
+                                                          ? _value
+                                                          : -1; },
+                                             21);
+            return onMain.get() * 2;
+        });
+
+    ASSERT_TRUE(worker.has_value());
+
+    while (!worker->isReady()) mainThread.drain();
+
+    EXPECT_EQ(worker->get(), 42);
+
+    // a throwing task is logged, the drain goes on
+    int ran = 0;
+    mainThread.post([] { throw std::runtime_error("Test exception"); });
+    mainThread.post([&] { ran++; });
+
+    EXPECT_EQ(mainThread.drain(), 2u);
+    EXPECT_EQ(ran, 1);
+    EXPECT_EQ(mainThread.getPendingCount(), 0u);
+}
+
+TEST_F(ThreadPoolTest, MainThreadQueueDrainsWithinItsBudgetAndInOrder)
+{
+    MainThreadQueue mainThread;
+    std::vector<int> order;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        mainThread.post(
+            [&, i]
+            {
+                std::this_thread::sleep_for(1ms);
+                order.push_back(i);
+            });
+    }
+
+    const size_t first = mainThread.drainFor(5ms);
+    EXPECT_GE(first, 1u);
+    EXPECT_LT(first, 100u);
+
+    // re-posted tasks wait for the next drain
+    mainThread.post([&] { mainThread.post([&] { order.push_back(-1); }); });
+
+    mainThread.drain();
+    EXPECT_EQ(mainThread.getPendingCount(), 1u);
+    mainThread.drain();
+
+    ASSERT_EQ(order.size(), 101u);
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end() - 1));
+    EXPECT_EQ(order.back(), -1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Render Thread Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(RenderThreadTest, FramesRunOneAtATimeOffTheCallerWhileItGoesOn)
+{
+    RenderThread renderThread;
+    const std::thread::id callerId = std::this_thread::get_id();
+
+    std::atomic<int> rendered = 0;
+    std::atomic<bool> offCaller = true;
+    std::latch started(1);
+    std::latch release(1);
+
+    renderThread.kick(
+        [&]
+        {
+            offCaller = offCaller && std::this_thread::get_id() != callerId;
+            started.count_down();
+            release.wait();
+            rendered++;
+        });
+
+    // the caller simulates the next frame meanwhile
+    started.wait();
+    EXPECT_TRUE(renderThread.isBusy());
+    EXPECT_EQ(rendered, 0);
+    release.count_down();
+
+    // each kick waits for the frame before
+    for (int i = 0; i < 10; ++i)
+    {
+        renderThread.kick(
+            [&, i]
+            {
+                offCaller = offCaller && std::this_thread::get_id() != callerId;
+                if (rendered == i + 1) rendered++;
+            });
+    }
+
+    renderThread.wait();
+    EXPECT_FALSE(renderThread.isBusy());
+    EXPECT_EQ(rendered, 11);
+    EXPECT_TRUE(offCaller);
+}
+
+TEST(RenderThreadTest, AThrowingFrameRethrowsOnTheCallerOnce)
+{
+    RenderThread renderThread;
+    int rendered = 0;
+
+    renderThread.kick([] { throw std::runtime_error("Test exception"); });
+    EXPECT_THROW(renderThread.wait(), std::runtime_error);
+    EXPECT_NO_THROW(renderThread.wait());
+
+    // the frame handed after a throwing one is not run
+    renderThread.kick([] { throw std::runtime_error("Test exception"); });
+    EXPECT_THROW(renderThread.kick([&] { rendered++; }), std::runtime_error);
+
+    // the thread goes on
+    renderThread.kick([&] { rendered++; });
+    renderThread.wait();
+    EXPECT_EQ(rendered, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Telemetry Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, TimingsRecordQueueWaitAndExecutionPercentiles)
+{
+    EXPECT_EQ(pool->getTelemetry(), PoolTelemetry::none);
+
+    // off by default, nothing is recorded
+    pool->enqueueToWorker([] {});
+    ASSERT_TRUE(waitFor([&] { return pool->getPoolStats().totalTasksExecuted == 1; }));
+    EXPECT_EQ(pool->getPoolStats().execution.count, 0u);
+
+    pool->resetStats();
+    pool->setTelemetry(PoolTelemetry::timings);
+
+    constexpr int k_taskCount = 20;
+    for (int i = 0; i < k_taskCount; ++i)
+    {
+        pool->enqueueToWorker([] { std::this_thread::sleep_for(2ms); });
+    }
+
+    ASSERT_TRUE(
+        waitFor([&] { return pool->getPoolStats().totalTasksExecuted == k_taskCount; }, 5000ms));
+
+    const PoolStatsSnapshot stats = pool->getPoolStats();
+    const auto minimum = static_cast<uint64_t>(std::chrono::nanoseconds(2ms).count());
+
+    EXPECT_EQ(stats.execution.count, static_cast<uint64_t>(k_taskCount));
+    EXPECT_EQ(stats.queueWait.count, static_cast<uint64_t>(k_taskCount));
+    EXPECT_GE(stats.execution.p50, minimum);
+    EXPECT_LE(stats.execution.p50, stats.execution.p90);
+    EXPECT_LE(stats.execution.p90, stats.execution.p99);
+    EXPECT_LE(stats.execution.p99, stats.execution.max);
+    EXPECT_GT(stats.totalIdleNanoseconds, 0u);
+
+    uint64_t perWorker = 0;
+    for (uint32_t i = 0; i < pool->getWorkersCount(); ++i)
+    {
+        perWorker += pool->getWorkerStats(i).execution.count;
+    }
+    EXPECT_EQ(perWorker, static_cast<uint64_t>(k_taskCount));
+
+    pool->resetStats();
+    EXPECT_EQ(pool->getPoolStats().execution.count, 0u);
+    EXPECT_EQ(pool->getPoolStats().execution.max, 0u);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Edge Cases and Error Handling
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -503,3 +1286,567 @@ TEST_F(ThreadPoolTest, LargeCapture)
     ASSERT_TRUE(future.has_value());
     EXPECT_EQ(future->get(), 420000);
 }
+
+// A callable of Size bytes returning its own address, which moves along with an inline task.
+template <size_t Size>
+struct AddressOf
+{
+    std::array<unsigned char, Size> payload{};
+
+    const void* operator()() const { return this; }
+};
+
+TEST(MoveOnlyTaskTest, TheBufferSizeDecidesWhatIsStoredInline)
+{
+    MoveOnlyTask<const void*()> spilled = AddressOf<48>{};
+    const void* heapAddress = spilled();
+
+    MoveOnlyTask<const void*()> movedSpilled = std::move(spilled);
+    EXPECT_EQ(movedSpilled(), heapAddress);
+
+    MoveOnlyTask<const void*(), 64> wide = AddressOf<48>{};
+    const void* inlineAddress = wide();
+
+    MoveOnlyTask<const void*(), 64> movedWide = std::move(wide);
+    EXPECT_NE(movedWide(), inlineAddress);
+    EXPECT_GE(sizeof(movedWide), 64u);
+}
+
+TEST(MoveOnlyTaskTest, CallablesFreedByAnotherThreadAreReusedByTheSubmitter)
+{
+    constexpr size_t taskCount = 5000;
+
+    std::vector<MoveOnlyTask<const void*()>> tasks;
+    std::set<const void*> addresses;
+
+    for (size_t i = 0; i < taskCount; ++i)
+    {
+        tasks.emplace_back(AddressOf<400>{});
+        addresses.insert(tasks.back()());
+    }
+
+    // the worker keeps part of the blocks, the surplus goes back to the submitting thread
+    std::jthread([&] { tasks.clear(); }).join();
+
+    MoveOnlyTask<const void*()> next = AddressOf<400>{};
+    EXPECT_TRUE(addresses.contains(next()));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Task Graph Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, TaskGraphRunsNodesAfterTheirPredecessorsEveryFrame)
+{
+    constexpr uint32_t numNodes = 80;
+    constexpr int numFrames = 50;
+
+    TaskGraph graph;
+    std::atomic<uint32_t> clock{0};
+    std::vector<uint32_t> finishedAt(numNodes, 0);
+    std::vector<std::pair<TaskNodeID, TaskNodeID>> edges;
+
+    for (uint32_t i = 0; i < numNodes; ++i)
+    {
+        graph.addNode([&, i] { finishedAt[i] = clock.fetch_add(1) + 1; });
+    }
+
+    // every node depends on up to three of the previous ones, like systems reading earlier results
+    for (uint32_t i = 1; i < numNodes; ++i)
+    {
+        for (uint32_t j : {i / 2, i - 1, i / 3})
+        {
+            if (j == i || std::ranges::find(edges, std::pair{j, i}) != edges.end()) continue;
+
+            graph.precede(j, i);
+            edges.emplace_back(j, i);
+        }
+    }
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        std::ranges::fill(finishedAt, 0);
+
+        graph.run(*pool);
+
+        for (uint32_t i = 0; i < numNodes; ++i) ASSERT_NE(finishedAt[i], 0u) << "node " << i;
+        for (auto [before, after] : edges) ASSERT_LT(finishedAt[before], finishedAt[after]);
+    }
+
+    EXPECT_EQ(clock.load(), numNodes * numFrames);
+    EXPECT_FALSE(graph.isSubmitted());
+}
+
+TEST_F(ThreadPoolTest, TaskGraphSubmitReturnsBeforeCompletion)
+{
+    TaskGraph graph;
+    std::latch release(1);
+    std::atomic<int> executed{0};
+
+    const TaskNodeID gate = graph.addNode([&] { release.wait(); });
+    for (int i = 0; i < 4; ++i)
+    {
+        graph.precede(gate, graph.addNode([&] { executed.fetch_add(1); }));
+    }
+
+    graph.submit(*pool);
+
+    EXPECT_TRUE(graph.isSubmitted());
+    EXPECT_THROW(graph.addNode([] {}), std::logic_error);
+    EXPECT_EQ(executed.load(), 0);
+
+    release.count_down();
+    graph.wait();
+
+    EXPECT_EQ(executed.load(), 4);
+    EXPECT_FALSE(graph.isSubmitted());
+}
+
+TEST_F(ThreadPoolTest, TaskGraphWaitForTimesOutUntilCompletion)
+{
+    TaskGraph graph;
+    std::latch release(1);
+
+    EXPECT_TRUE(graph.waitFor(std::chrono::milliseconds(0))); // nothing in flight
+
+    const TaskNodeID gate = graph.addNode([&] { release.wait(); });
+    graph.precede(gate, graph.addNode([] { throw std::runtime_error("node failed"); }));
+
+    graph.submit(*pool);
+
+    EXPECT_FALSE(graph.waitFor(std::chrono::milliseconds(5)));
+    EXPECT_TRUE(graph.isSubmitted());
+
+    release.count_down();
+    while (!graph.waitFor(std::chrono::milliseconds(5))) {}
+
+    // still to be waited for: the error is rethrown by wait()
+    EXPECT_TRUE(graph.isSubmitted());
+    EXPECT_THROW(graph.wait(), std::runtime_error);
+    EXPECT_FALSE(graph.isSubmitted());
+}
+
+TEST_F(ThreadPoolTest, TaskGraphRejectsCyclesAndInvalidEdges)
+{
+    TaskGraph graph;
+
+    const TaskNodeID a = graph.addNode([] {});
+    const TaskNodeID b = graph.addNode([] {});
+    const TaskNodeID c = graph.addNode([] {});
+
+    EXPECT_THROW(graph.precede(a, a), std::invalid_argument);
+    EXPECT_THROW(graph.precede(a, 3), std::out_of_range);
+
+    graph.precede(a, b);
+    graph.precede(b, c);
+    graph.precede(c, a);
+
+    EXPECT_THROW(graph.run(*pool), std::logic_error);
+    EXPECT_FALSE(graph.isSubmitted());
+
+    graph.clear();
+    EXPECT_TRUE(graph.empty());
+    EXPECT_NO_THROW(graph.run(*pool));
+}
+
+TEST_F(ThreadPoolTest, TaskGraphSkipsRemainingNodesAfterAnException)
+{
+    TaskGraph graph;
+    std::atomic<bool> fail{true};
+    std::atomic<int> afterFailure{0};
+
+    const TaskNodeID first = graph.addNode(
+        [&]
+        {
+            if (fail.load()) throw std::runtime_error("Test exception");
+        });
+    const TaskNodeID second = graph.addNode([&] { afterFailure.fetch_add(1); });
+    const TaskNodeID third = graph.addNode([&] { afterFailure.fetch_add(1); });
+    graph.precede(first, second);
+    graph.precede(second, third);
+
+    EXPECT_THROW(graph.run(*pool), std::runtime_error);
+    EXPECT_EQ(afterFailure.load(), 0);
+
+    // the next frame starts from a clean state
+    fail.store(false);
+    EXPECT_NO_THROW(graph.run(*pool));
+    EXPECT_EQ(afterFailure.load(), 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Parallel Algorithm Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, ParallelForVisitsEveryIndexOnce)
+{
+    constexpr size_t count = 100000;
+    std::vector<std::atomic<int>> visits(count);
+
+    parallelFor(*pool, size_t{0}, count, size_t{64}, [&](size_t _i) { visits[_i].fetch_add(1); });
+
+    for (size_t i = 0; i < count; ++i) ASSERT_EQ(visits[i].load(), 1) << "index " << i;
+
+    // range form, with a grain derived from the number of workers
+    std::atomic<size_t> covered{0};
+    parallelFor(*pool, 10, 5000, 0,
+                [&](int _begin, int _end)
+                {
+                    EXPECT_LT(_begin, _end);
+                    covered.fetch_add(static_cast<size_t>(_end - _begin));
+                });
+
+    EXPECT_EQ(covered.load(), 4990u);
+
+    parallelFor(*pool, 5, 5, 1, [](int) { FAIL() << "empty range"; });
+}
+
+TEST_F(ThreadPoolTest, ParallelReduceCombinesEveryPiece)
+{
+    constexpr uint64_t count = 1'000'000;
+    constexpr uint64_t expected = count * (count - 1) / 2;
+
+    const uint64_t perIndex = parallelReduce(
+        *pool, uint64_t{0}, count, uint64_t{256}, uint64_t{0}, [](uint64_t _i) { return _i; },
+        std::plus<>{});
+
+    const uint64_t perRange = parallelReduce(
+        *pool, uint64_t{0}, count, uint64_t{0}, uint64_t{0},
+        [](uint64_t _begin, uint64_t _end)
+        {
+            uint64_t sum = 0;
+            for (uint64_t i = _begin; i < _end; ++i) sum += i;
+            return sum;
+        },
+        std::plus<>{});
+
+    EXPECT_EQ(perIndex, expected);
+    EXPECT_EQ(perRange, expected);
+    EXPECT_EQ(parallelReduce(*pool, 3, 3, 1, 7, [](int _i) { return _i; }, std::plus<>{}), 7);
+}
+
+TEST_F(ThreadPoolTest, ParallelForRethrowsOnceEveryTaskReturned)
+{
+    std::atomic<int> running{0};
+
+    auto body = [&](int _i)
+    {
+        running.fetch_add(1);
+        std::this_thread::sleep_for(10us);
+        running.fetch_sub(1);
+
+        if (_i == 500) throw std::runtime_error("Test exception");
+    };
+
+    EXPECT_THROW(parallelFor(*pool, 0, 2000, 8, body), std::runtime_error);
+    EXPECT_EQ(running.load(), 0);
+}
+
+TEST_F(ThreadPoolTest, NestedParallelForHelpsInsteadOfBlocking)
+{
+    std::atomic<int> total{0};
+
+    parallelFor(*pool, 0, 32, 1,
+                [&](int)
+                { parallelFor(*pool, 0, 100, 10, [&](int) { total.fetch_add(1); }); });
+
+    EXPECT_EQ(total.load(), 3200);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Future State Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, FutureWakesEveryKindOfWaiter)
+{
+    TaskPromise<int> promise;
+    TaskFuture<int> future = promise.getFuture();
+
+    EXPECT_FALSE(future.waitFor(1ms)) << "nothing completed the state yet";
+
+    std::atomic<int> woken{0};
+    std::vector<std::thread> waiters;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        waiters.emplace_back(
+            [&, i]
+            {
+                if (i % 2 == 0)
+                {
+                    future.wait();
+                }
+                else
+                {
+                    EXPECT_TRUE(future.waitFor(5s));
+                }
+
+                woken.fetch_add(1);
+            });
+    }
+
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(woken.load(), 0);
+
+    promise.setValue(42);
+    for (std::thread& waiter : waiters) waiter.join();
+
+    EXPECT_EQ(woken.load(), 4);
+    EXPECT_EQ(future.get(), 42);
+    EXPECT_THROW(future.get(), FutureException);
+    EXPECT_THROW(promise.setValue(1), FutureException);
+}
+
+TEST_F(ThreadPoolTest, FutureStatesAreRecycledAcrossThreads)
+{
+    constexpr int numRounds = 20;
+    constexpr int numTasks = 2000;
+
+    for (int round = 0; round < numRounds; ++round)
+    {
+        std::vector<TaskFuture<int>> futures;
+        futures.reserve(numTasks);
+
+        for (int i = 0; i < numTasks; ++i)
+        {
+            auto future = pool->enqueueToWorker([i] { return i; });
+            ASSERT_TRUE(future.has_value());
+            futures.push_back(std::move(*future));
+        }
+
+        int64_t sum = 0;
+        for (TaskFuture<int>& future : futures) sum += future.get();
+
+        ASSERT_EQ(sum, int64_t{numTasks} * (numTasks - 1) / 2);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Continuation Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(ThreadPoolTest, ThenChainsContinuationsOnThePool)
+{
+    auto first = pool->enqueueToWorker([] { return 20; });
+    ASSERT_TRUE(first.has_value());
+
+    std::atomic<bool> sideEffect{false};
+
+    auto doubled = [&](int _value)
+    {
+        sideEffect.store(true);
+        return _value * 2;
+    };
+
+    TaskFuture<int> result = std::move(*first)
+                                 .then(*pool, [](int _value) { return _value + 1; })
+                                 .then(*pool, doubled);
+
+    TaskFuture<void> done = result.then(*pool, [](int _value) { EXPECT_EQ(_value, 42); });
+
+    EXPECT_FALSE(result.isValid()) << "then() consumes the future";
+    EXPECT_NO_THROW(done.get());
+    EXPECT_TRUE(sideEffect.load());
+
+    // a continuation registered on a complete state is scheduled at once
+    TaskPromise<int> promise;
+    TaskFuture<int> ready = promise.getFuture();
+    promise.setValue(5);
+
+    EXPECT_EQ(ready.then(*pool, [](int _value) { return _value * 3; }).get(), 15);
+}
+
+TEST_F(ThreadPoolTest, ThenForwardsExceptionsUnlessTheFutureIsTaken)
+{
+    std::atomic<bool> called{false};
+    auto throwing = []() -> int { throw std::runtime_error("Test exception"); };
+
+    auto failing = pool->enqueueToWorker(throwing);
+    ASSERT_TRUE(failing.has_value());
+
+    auto skipped = std::move(*failing).then(*pool, [&](int _value)
+                                            {
+                                                called.store(true);
+                                                return _value;
+                                            });
+
+    EXPECT_THROW(skipped.get(), std::runtime_error);
+    EXPECT_FALSE(called.load());
+
+    auto recover = [](TaskFuture<int> _future)
+    {
+        try
+        {
+            return _future.get();
+        }
+        catch (const std::runtime_error&)
+        {
+            return -1;
+        }
+    };
+
+    auto recovered = pool->enqueueToWorker(throwing)->then(*pool, recover);
+
+    EXPECT_EQ(recovered.get(), -1);
+}
+
+TEST_F(ThreadPoolTest, WhenAllCompletesOnceEveryFutureIs)
+{
+    constexpr int numTasks = 32;
+
+    std::vector<TaskFuture<int>> futures;
+    for (int i = 0; i < numTasks; ++i)
+    {
+        auto future = pool->enqueueToWorker([i] { return i; });
+        ASSERT_TRUE(future.has_value());
+        futures.push_back(std::move(*future));
+    }
+
+    TaskFuture<int> sum = whenAll(std::move(futures))
+                              .then(*pool,
+                                    [](std::vector<TaskFuture<int>> _ready)
+                                    {
+                                        int total = 0;
+                                        for (TaskFuture<int>& future : _ready)
+                                        {
+                                            total += future.get();
+                                        }
+                                        return total;
+                                    });
+
+    EXPECT_EQ(sum.get(), numTasks * (numTasks - 1) / 2);
+    EXPECT_TRUE(whenAll(std::vector<TaskFuture<int>>{}).get().empty());
+}
+
+TEST_F(ThreadPoolTest, WhenAnyCompletesWithTheFirstFuture)
+{
+    std::latch release(1);
+
+    TaskPromise<int> slow;
+    std::vector<TaskFuture<int>> futures;
+    futures.push_back(slow.getFuture());
+    futures.push_back(std::move(*pool->enqueueToWorker([] { return 7; })));
+
+    WhenAnyResult<int> first = whenAny(std::move(futures)).get();
+
+    ASSERT_EQ(first.index, 1u);
+    EXPECT_EQ(first.futures[1].get(), 7);
+    EXPECT_FALSE(first.futures[0].isReady());
+
+    slow.setValue(3);
+    EXPECT_EQ(first.futures[0].get(), 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Coroutine Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+pieces::Task<int> incrementOnWorker(ThreadPool& _pool, TaskFuture<int> _input,
+                                    std::thread::id _caller, std::atomic<bool>& _hopped)
+{
+    co_await _pool.schedule();
+    _hopped.store(std::this_thread::get_id() != _caller);
+
+    const int value = co_await _input;
+    co_await _pool.yield();
+
+    co_return value + 1;
+}
+
+pieces::Task<void> countOnceSignaled(TaskFuture<void> _signal, std::atomic<int>& _resumed)
+{
+    co_await _signal;
+    _resumed.fetch_add(1);
+}
+
+pieces::Task<int> checkPositive(TaskFuture<int> _input)
+{
+    const int value = co_await _input;
+    if (value < 0) throw std::runtime_error("Test exception");
+
+    co_return value;
+}
+
+pieces::Task<int> sumOfChecked(TaskFuture<int> _first, TaskFuture<int> _second)
+{
+    pieces::Task<int> first = checkPositive(std::move(_first));
+    pieces::Task<int> second = checkPositive(std::move(_second));
+
+    co_return co_await first + co_await second;
+}
+
+} // namespace
+
+TEST_F(ThreadPoolTest, CoroutinesHopOntoWorkersAndAwaitFutures)
+{
+    std::atomic<bool> hopped{false};
+
+    TaskPromise<int> input;
+    TaskFuture<int> result = spawn(*pool, incrementOnWorker(*pool, input.getFuture(),
+                                                            std::this_thread::get_id(), hopped));
+
+    EXPECT_FALSE(result.waitFor(10ms)) << "the coroutine waits for its input";
+
+    input.setValue(41);
+
+    EXPECT_EQ(result.get(), 42);
+    EXPECT_TRUE(hopped.load());
+
+    // an input that is already complete does not suspend the coroutine
+    TaskPromise<int> ready;
+    ready.setValue(1);
+
+    EXPECT_EQ(spawn(*pool, checkPositive(ready.getFuture())).get(), 1);
+}
+
+TEST_F(ThreadPoolTest, SuspendedCoroutinesDoNotHoldWorkers)
+{
+    constexpr int coroutineCount = 1000;
+
+    std::atomic<int> resumed{0};
+    std::vector<TaskPromise<void>> signals(coroutineCount);
+    std::vector<TaskFuture<void>> results;
+
+    for (TaskPromise<void>& signal : signals)
+    {
+        results.push_back(spawn(*pool, countOnceSignaled(signal.getFuture(), resumed)));
+    }
+
+    // far more coroutines than workers are suspended, the pool still runs regular tasks
+    auto task = pool->enqueueToWorker([] { return 7; });
+    ASSERT_TRUE(task.has_value());
+    EXPECT_EQ(task->get(), 7);
+    EXPECT_EQ(resumed.load(), 0);
+
+    for (TaskPromise<void>& signal : signals) signal.setValue();
+    for (TaskFuture<void>& result : results) EXPECT_NO_THROW(result.get());
+
+    EXPECT_EQ(resumed.load(), coroutineCount);
+}
+
+TEST_F(ThreadPoolTest, SpawnForwardsCoroutineExceptions)
+{
+    TaskPromise<int> first;
+    TaskPromise<int> second;
+    TaskFuture<int> sum = spawn(*pool, sumOfChecked(first.getFuture(), second.getFuture()));
+
+    first.setValue(2);
+    second.setValue(3);
+    EXPECT_EQ(sum.get(), 5);
+
+    TaskPromise<int> negative;
+    TaskFuture<int> failing = spawn(*pool, checkPositive(negative.getFuture()));
+
+    negative.setValue(-1);
+    EXPECT_THROW(failing.get(), std::runtime_error);
+
+    // a broken promise resumes the awaiting coroutine with the error
+    auto broken = std::make_unique<TaskPromise<int>>();
+    TaskFuture<int> orphan = spawn(*pool, checkPositive(broken->getFuture()));
+
+    broken.reset();
+    EXPECT_THROW(orphan.get(), FutureException);
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <mosaic/core/ticks.hpp>
+#include <mosaic/core/timer.hpp>
+#include <mosaic/exec/main_thread_queue.hpp>
+
+using namespace mosaic::core;
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Advances the timer until the predicate holds, false past the timeout.
+template <typename Predicate>
+bool advanceUntil(Timer& _timer, Predicate _pred, std::chrono::milliseconds _timeout = 2000ms)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    while (!_pred())
+    {
+        if (std::chrono::steady_clock::now() - start > _timeout) return false;
+
+        _timer.advance();
+        std::this_thread::sleep_for(1ms);
+    }
+
+    return true;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Timing Wheel Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(TimerTest, CallbacksRunInOrderOfTheirDelaysWithoutRunningEarly)
+{
+    Timer timer;
+    std::vector<int> order;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration lastElapsed{};
+
+    // the last two only reach the first level through a cascade
+    (void)timer.scheduleCallback(0s, [&] { order.push_back(0); });
+    (void)timer.scheduleCallback(300ms,
+                                 [&]
+                                 {
+                                     order.push_back(3);
+                                     lastElapsed = std::chrono::steady_clock::now() - start;
+                                 });
+    (void)timer.scheduleCallback(20ms, [&] { order.push_back(1); });
+    (void)timer.scheduleCallback(270ms, [&] { order.push_back(2); });
+
+    EXPECT_EQ(timer.getPendingCount(), 4u);
+
+    ASSERT_TRUE(advanceUntil(timer, [&] { return order.size() == 4; }));
+
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_GE(lastElapsed, 300ms);
+    EXPECT_EQ(timer.getPendingCount(), 0u);
+}
+
+TEST(TimerTest, CancelledCallbacksNeverRunAndStaleIdsAreIgnored)
+{
+    Timer timer;
+    int ran = 0;
+
+    const uint64_t cancelled = timer.scheduleCallback(5ms, [&] { ran += 100; });
+    const uint64_t kept = timer.scheduleCallback(5ms, [&] { ran++; });
+
+    EXPECT_NE(cancelled, kept);
+    EXPECT_TRUE(timer.cancelCallback(cancelled));
+    EXPECT_FALSE(timer.cancelCallback(cancelled));
+
+    ASSERT_TRUE(advanceUntil(timer, [&] { return ran != 0; }));
+    EXPECT_EQ(ran, 1);
+
+    // the node of the cancelled callback is reused under another id
+    const uint64_t reused = timer.scheduleCallback(1h, [&] { ran += 100; });
+    EXPECT_NE(reused, cancelled);
+    EXPECT_FALSE(timer.cancelCallback(kept));
+    EXPECT_TRUE(timer.cancelCallback(reused));
+
+    EXPECT_EQ(timer.getPendingCount(), 0u);
+}
+
+TEST(TimerTest, TickAdvancesEveryTimerAndCallbacksMaySchedule)
+{
+    auto first = std::make_unique<Timer>();
+    Timer second;
+    int ran = 0;
+
+    (void)first->scheduleCallback(1ms, [&] { ran++; });
+    (void)first->scheduleCallback(1h, [&] { ran += 100; });
+    (void)second.scheduleCallback(5ms,
+                                  [&]
+                                  {
+                                      ran++;
+                                      (void)second.scheduleCallback(1ms, [&] { ran++; });
+
+                                      // destroying a timer from a callback is fine as well
+                                      first.reset();
+                                  });
+
+    const auto start = std::chrono::steady_clock::now();
+
+    while (ran < 3 && std::chrono::steady_clock::now() - start < 2s)
+    {
+        std::this_thread::sleep_for(1ms);
+        Timer::tick();
+    }
+
+    EXPECT_EQ(ran, 3);
+    EXPECT_EQ(first, nullptr);
+}
+
+TEST(TimerTest, MainThreadCallbacksWaitForTheDrain)
+{
+    mosaic::exec::MainThreadQueue mainThread;
+    Timer timer;
+    int ran = 0;
+
+    (void)timer.scheduleCallback(1ms, [&] { ran++; }, TimerDispatch::main_thread);
+
+    ASSERT_TRUE(advanceUntil(timer, [&] { return mainThread.getPendingCount() == 1; }));
+    EXPECT_EQ(ran, 0);
+
+    mainThread.drain();
+    EXPECT_EQ(ran, 1);
+}
+
+TEST(TimerTest, SleepUntilWakesAtTheDeadlineNotBefore)
+{
+    for (const std::chrono::microseconds wait : {200us, 2000us, 8000us})
+    {
+        // the median, a loaded machine preempts any sleep now and then
+        std::vector<std::chrono::nanoseconds> lateness;
+
+        for (int i = 0; i < 9; ++i)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + wait;
+            Timer::sleepUntil(deadline);
+            lateness.push_back(std::chrono::steady_clock::now() - deadline);
+
+            EXPECT_GE(lateness.back(), 0ns);
+        }
+
+        std::nth_element(lateness.begin(), lateness.begin() + 4, lateness.end());
+        EXPECT_LT(lateness[4], 1ms); // a scheduler tick would be 1-15.6 ms, the spin microseconds
+    }
+
+    // a deadline passed returns at once
+    const auto start = std::chrono::steady_clock::now();
+    Timer::sleepUntil(start - 1ms);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1ms);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tick Clock Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(TicksTest, TicksAreMonotonicAndConvertToTheSteadyClock)
+{
+    const auto steadyBefore = std::chrono::steady_clock::now();
+    const int64_t first = Ticks::now();
+    std::this_thread::sleep_for(20ms);
+    const int64_t second = Ticks::now();
+    const auto steadyAfter = std::chrono::steady_clock::now();
+
+    ASSERT_GT(second, first);
+    EXPECT_GT(Ticks::getNanosecondsPerTick(), 0.0);
+
+    // the span converts to about the time slept, and the ticks land between the steady reads
+    const auto span = std::chrono::nanoseconds(Ticks::toNanoseconds(second - first));
+    EXPECT_GE(span, 15ms);
+    EXPECT_LE(span, steadyAfter - steadyBefore + 5ms);
+
+    EXPECT_GE(Ticks::toSteady(first), steadyBefore - 5ms);
+    EXPECT_LE(Ticks::toSteady(second), steadyAfter + 5ms);
+
+    // the two conversions invert each other, up to the rounding
+    const int64_t ticks = second - first;
+    EXPECT_NEAR(double(Ticks::fromNanoseconds(Ticks::toNanoseconds(ticks))), double(ticks),
+                double(ticks) * 1e-9 + 2.0);
+}
+
+TEST(TicksTest, TickClockTimePointsAndWallTimeFollowTheirClocks)
+{
+    const auto steady = std::chrono::steady_clock::now();
+    const auto tick = TickClock::now();
+
+    EXPECT_LT(std::chrono::abs(tick.time_since_epoch() - steady.time_since_epoch()), 5ms);
+
+    const auto wall = Ticks::toSystem(Ticks::now());
+    EXPECT_LT(std::chrono::abs(wall - std::chrono::system_clock::now()), 1s);
+}
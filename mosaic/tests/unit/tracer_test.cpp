@@ -0,0 +1,466 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mosaic/tools/memory_tracker.hpp>
+#include <mosaic/tools/tracer.hpp>
+
+#include <pieces/memory/pool_allocator.hpp>
+#include <pieces/memory/proxy_allocator.hpp>
+
+#if !defined(MOSAIC_PLATFORM_WINDOWS) && !defined(MOSAIC_PLATFORM_WEB)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace mosaic::tools;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+std::vector<std::filesystem::path> listTraceFiles()
+{
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator("./traces"))
+    {
+        files.push_back(entry.path());
+    }
+
+    return files;
+}
+
+// Whether a trace file of the directory holds the text
+bool tracesContain(const std::string& _text)
+{
+    for (const auto& path : listTraceFiles())
+    {
+        std::ifstream file(path, std::ios::binary);
+        const std::string content{std::istreambuf_iterator<char>(file),
+                                  std::istreambuf_iterator<char>()};
+
+        if (content.find(_text) != std::string::npos) return true;
+    }
+
+    return false;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TracerTest : public ::testing::Test
+{
+   protected:
+    Tracer* tracer = nullptr;
+
+    void SetUp() override
+    {
+        // written by flush() only
+        ASSERT_TRUE(Tracer::initialize(Tracer::Config(true, false)));
+        tracer = Tracer::getInstance();
+    }
+
+    void TearDown() override { Tracer::shutdown(); }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Ring Buffer Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(TracerTest, EventsOfEveryThreadReachTheTraceFile)
+{
+    constexpr int k_threadCount = 4;
+    constexpr int k_iterations = 1000;
+
+    std::vector<std::jthread> threads;
+
+    for (int t = 0; t < k_threadCount; ++t)
+    {
+        threads.emplace_back(
+            [&]
+            {
+                for (int i = 0; i < k_iterations; ++i)
+                {
+                    ScopedTrace outer("TracerTestOuter");
+                    ScopedTrace inner(std::string("TracerTest") + "Inner");
+                    tracer->counterTrace("TracerTestCounter", i);
+                }
+            });
+    }
+
+    threads.clear();
+
+    // 2 scopes and a counter per iteration, the rings of the exited threads are still drained
+    EXPECT_EQ(tracer->getCompletedTraceCount(), size_t{k_threadCount * k_iterations * 3});
+    EXPECT_EQ(tracer->getActiveTraceCount(), 0u);
+    EXPECT_EQ(tracer->getDroppedTraceCount(), 0u);
+
+    tracer->flush();
+
+    EXPECT_EQ(tracer->getCompletedTraceCount(), 0u);
+    EXPECT_TRUE(tracesContain("TracerTestInner"));
+    EXPECT_TRUE(tracesContain("TracerTestCounter"));
+}
+
+TEST_F(TracerTest, DisabledCategoriesKeepTheNesting)
+{
+    tracer->enableCategory(TraceCategory::io, false);
+
+    tracer->beginTrace("TracerTestRecorded", TraceCategory::function);
+    tracer->beginTrace("TracerTestSkipped", TraceCategory::io);
+    EXPECT_EQ(tracer->getActiveTraceCount(), 2u);
+
+    tracer->endTrace();
+    tracer->endTrace();
+
+    // the second end closed the function trace, not a skipped one
+    EXPECT_EQ(tracer->getActiveTraceCount(), 0u);
+    EXPECT_EQ(tracer->getCompletedTraceCount(), 1u);
+
+    // with arguments, the locked path
+    tracer->beginTrace("TracerTestWithArgs", TraceCategory::function, R"({"chunk":7})");
+    tracer->endTrace();
+    EXPECT_EQ(tracer->getCompletedTraceCount(), 2u);
+
+    tracer->flush();
+
+    EXPECT_TRUE(tracesContain("TracerTestRecorded"));
+    EXPECT_TRUE(tracesContain(R"("chunk":7)"));
+    EXPECT_FALSE(tracesContain("TracerTestSkipped"));
+}
+
+TEST_F(TracerTest, InternedNamesAreSharedAndStable)
+{
+    const uint32_t id = Tracer::internName("TracerTestName");
+
+    std::string copy = "TracerTestName";
+    EXPECT_EQ(Tracer::internName(copy), id);
+
+    // another string at the same address is told apart
+    copy[0] = 'X';
+    EXPECT_NE(Tracer::internName(copy), id);
+
+    uint32_t fromThread = 0;
+    std::jthread([&] { fromThread = Tracer::internName("TracerTestName"); }).join();
+    EXPECT_EQ(fromThread, id);
+}
+
+TEST_F(TracerTest, SitesRecordOnlyTheirIdAndTheCategoriesTheyAreIn)
+{
+    constinit static const TraceSite site("TracerTestSite", TraceCategory::io, __FILE__, __LINE__);
+
+    // interned by an earlier run of the test, if any
+    const uint32_t idBefore = site.id.load();
+
+    tracer->enableCategory(TraceCategory::io, false);
+    EXPECT_FALSE(Tracer::isRecording(TraceCategory::io));
+    EXPECT_TRUE(Tracer::isRecording(TraceCategory::scope));
+
+    {
+        ScopedTrace trace(site);
+        EXPECT_EQ(tracer->getActiveTraceCount(), 0u);
+    }
+
+    // not recorded, not interned
+    EXPECT_EQ(site.id.load(), idBefore);
+
+    tracer->enableCategory(TraceCategory::io, true);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        ScopedTrace trace(site);
+        EXPECT_EQ(tracer->getActiveTraceCount(), 1u);
+    }
+
+    EXPECT_EQ(site.id.load(), Tracer::internName("TracerTestSite"));
+    EXPECT_EQ(tracer->getCompletedTraceCount(), 2u);
+
+    tracer->setEnabled(false);
+    EXPECT_FALSE(Tracer::isRecording(TraceCategory::scope));
+
+    tracer->flush();
+
+    EXPECT_TRUE(tracesContain("TracerTestSite"));
+    EXPECT_TRUE(tracesContain("tracer_test.cpp:"));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scope Statistics Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(TracerTest, ScopeStatisticsRollOverTheLastFrames)
+{
+    using namespace std::chrono_literals;
+
+    tracer->setStatisticsFrames(4);
+
+    // 6 marks close 5 frames, the first one out of the window
+    for (int frame = 0; frame < 6; ++frame)
+    {
+        tracer->markFrame();
+
+        if (frame == 0)
+        {
+            ScopedTrace setup("TracerTestSetup");
+            continue;
+        }
+
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            ScopedTrace work("TracerTestWork");
+            std::this_thread::sleep_for(1ms);
+        }
+
+        // on another thread, in the frame it began in
+        std::jthread([] { ScopedTrace worker("TracerTestWorker"); }).join();
+    }
+
+    tracer->flush();
+
+    const auto statistics = tracer->getScopeStatistics();
+
+    const auto find = [&](const std::string& _name)
+    { return std::ranges::find(statistics, _name, &ScopeStatistics::name); };
+
+    EXPECT_EQ(find("TracerTestSetup"), statistics.end());
+    ASSERT_NE(find("TracerTestWork"), statistics.end());
+    ASSERT_NE(find("TracerTestWorker"), statistics.end());
+
+    const ScopeStatistics& work = *find("TracerTestWork");
+    EXPECT_EQ(work.frames, 4u);
+    EXPECT_DOUBLE_EQ(work.callsPerFrame, 2.0);
+    EXPECT_GE(work.p50, 2.0); // 2 sleeps of 1 ms
+    EXPECT_LE(work.p50, work.p95);
+    EXPECT_LE(work.p95, work.p99);
+    EXPECT_LE(work.p99, work.max);
+    EXPECT_GE(work.mean, 2.0);
+    EXPECT_LE(work.mean, work.max);
+
+    EXPECT_EQ(find("TracerTestWorker")->frames, 4u);
+
+    // sorted by decreasing mean
+    EXPECT_TRUE(std::ranges::is_sorted(statistics, std::ranges::greater{}, &ScopeStatistics::mean));
+
+    const ScopeStatistics frames = tracer->getFrameStatistics();
+    EXPECT_EQ(frames.frames, 4u);
+    EXPECT_GE(frames.p50, work.p50);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory Tracker Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(TracerTest, MemoryCountersOfTheSubsystemsAreTracedWhileRecorded)
+{
+    pieces::AllocationStats& stats = MemoryTracker::getStats("TracerTestPool");
+    EXPECT_EQ(&stats, &MemoryTracker::getStats("TracerTestPool"));
+
+    {
+        pieces::AutomaticIndexingPoolAllocator<uint64_t> pool(128);
+        pool.setStats(&stats);
+
+        for (int i = 0; i < 32; ++i) ASSERT_NE(pool.allocate(1), nullptr);
+
+        const auto summary = MemoryTracker::getSummary();
+        const auto pools = std::ranges::find(summary, "TracerTestPool", &MemorySummary::subsystem);
+
+        ASSERT_NE(pools, summary.end());
+        EXPECT_EQ(pools->reservedBytes, 128 * sizeof(uint64_t));
+        EXPECT_EQ(pools->allocatedBytes, 32 * sizeof(uint64_t));
+        EXPECT_EQ(pools->allocations, 32u);
+        EXPECT_FLOAT_EQ(pools->fragmentation, 0.75f);
+
+        tracer->enableCategory(TraceCategory::memory, false);
+        MemoryTracker::traceCounters();
+        EXPECT_EQ(tracer->getCompletedTraceCount(), 0u);
+
+        // allocated, reserved, peak and fragmentation
+        tracer->enableCategory(TraceCategory::memory, true);
+        MemoryTracker::traceCounters();
+        EXPECT_GE(tracer->getCompletedTraceCount(), 4u);
+    }
+
+    // the buffer of the destroyed pool is released
+    EXPECT_EQ(stats.reservedBytes(), 0u);
+    EXPECT_EQ(stats.peakBytes(), 32 * sizeof(uint64_t));
+
+    tracer->flush();
+    EXPECT_TRUE(tracesContain("Memory TracerTestPool allocated (MiB)"));
+    EXPECT_TRUE(tracesContain("Memory TracerTestPool fragmentation"));
+}
+
+TEST_F(TracerTest, HistogramsOfTheProxiedSubsystemsAreTraced)
+{
+    pieces::AllocationStats& stats = MemoryTracker::getStats("TracerTestProxy");
+
+    pieces::AutomaticIndexingPoolAllocator<uint64_t> pool(64);
+    pieces::ProxyAllocator<uint64_t, pieces::AutomaticIndexingPoolAllocator<uint64_t>> proxy(
+        &pool, &stats);
+
+    uint64_t* ptr = proxy.allocate(4);
+    ASSERT_NE(ptr, nullptr);
+    proxy.deallocate(ptr, 4);
+
+    const auto summary = MemoryTracker::getSummary();
+    const auto proxied = std::ranges::find(summary, "TracerTestProxy", &MemorySummary::subsystem);
+    ASSERT_NE(proxied, summary.end());
+    EXPECT_EQ(proxied->sizeClasses[pieces::AllocationStats::sizeClassOf(4 * sizeof(uint64_t))],
+              1u);
+
+    tracer->enableCategory(TraceCategory::memory, true);
+    MemoryTracker::traceCounters();
+
+    tracer->flush();
+    EXPECT_TRUE(tracesContain("Memory TracerTestProxy size <= 32 B"));
+    EXPECT_TRUE(tracesContain("Memory TracerTestProxy lifetime < 1 us"));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Live Stream Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(MOSAIC_PLATFORM_WINDOWS) && !defined(MOSAIC_PLATFORM_WEB)
+TEST_F(TracerTest, ConnectedViewersReceiveTheEventsOfEveryDrain)
+{
+    ASSERT_TRUE(tracer->startStreaming());
+    ASSERT_NE(tracer->getStreamPort(), 0);
+
+    const int viewer = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(viewer, 0);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(tracer->getStreamPort());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    ASSERT_EQ(connect(viewer, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+
+    // accepted by the flusher
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!tracer->isStreamConnected() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ASSERT_TRUE(tracer->isStreamConnected());
+
+    tracer->counterTrace("TracerTestStreamed", 1.0);
+    tracer->flush();
+
+    std::string received;
+    while (received.find("TracerTestStreamed") == std::string::npos &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        pollfd ready{viewer, POLLIN, 0};
+        if (poll(&ready, 1, 100) <= 0) continue;
+
+        char bytes[4096];
+        const auto size = recv(viewer, bytes, sizeof(bytes), 0);
+        if (size <= 0) break;
+
+        received.append(bytes, static_cast<size_t>(size));
+    }
+
+    close(viewer);
+
+    // a file of its own: the header, then the names of the events
+    EXPECT_EQ(received.substr(0, 8), "MOSTRACE");
+    EXPECT_NE(received.find("TracerTestStreamed"), std::string::npos);
+    EXPECT_EQ(tracer->getStreamDroppedCount(), 0u);
+
+    tracer->stopStreaming();
+    EXPECT_EQ(tracer->getStreamPort(), 0);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sampling Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(TracerTest, SampledStacksAndTheModulesReachTheTraceFile)
+{
+    if (!tracer->startSampling(std::chrono::microseconds(200)))
+    {
+        GTEST_SKIP() << "The platform cannot sample the threads";
+    }
+
+    EXPECT_TRUE(tracer->isSampling());
+
+    // a thread on the CPU all along, the sampler catches it every round
+    std::atomic<bool> stop = false;
+    std::thread busy(
+        [&]
+        {
+            volatile uint64_t sum = 0;
+            while (!stop.load(std::memory_order_relaxed)) sum = sum + 1;
+        });
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (tracer->getSampleCount() < 10 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    stop = true;
+    busy.join();
+
+    tracer->stopSampling();
+    EXPECT_FALSE(tracer->isSampling());
+    EXPECT_GE(tracer->getSampleCount(), 10u);
+
+    tracer->flush();
+
+    EXPECT_TRUE(tracesContain("Sample"));
+    EXPECT_TRUE(tracesContain(R"({"frames":["0x)"));
+    EXPECT_TRUE(tracesContain(R"("modules")"));
+}
+
+TEST(TracerFileTest, FilesStartWithTheirHeaderAndRotatePastTheSizeLimit)
+{
+    // 1 MB and about 40 bytes per event, the fourth write goes to a new file
+    ASSERT_TRUE(Tracer::initialize(Tracer::Config(true, false, 1000, 10000, 1)));
+    Tracer* tracer = Tracer::getInstance();
+
+    const size_t filesBefore = listTraceFiles().size();
+
+    for (int flush = 0; flush < 4; ++flush)
+    {
+        for (int i = 0; i < 10000; ++i) ScopedTrace trace("TracerTestRotated");
+        tracer->flush();
+    }
+
+    EXPECT_EQ(tracer->getDroppedTraceCount(), 0u);
+
+    Tracer::shutdown();
+
+    const auto files = listTraceFiles();
+
+    // the first one was created before filesBefore was counted
+    EXPECT_EQ(files.size(), filesBefore + 1);
+
+    for (const auto& path : files)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string magic(8, '\0');
+        file.read(magic.data(), 8);
+
+        EXPECT_EQ(magic, "MOSTRACE") << path;
+    }
+}
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <mosaic/scene/transform_hierarchy.hpp>
+#include <mosaic/exec/task_future.hpp>
+
+using namespace mosaic::scene;
+using mosaic::ecs::EntityID;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+glm::mat4 translation(float _x, float _y, float _z)
+{
+    glm::mat4 result(1.0f);
+    result[3] = glm::vec4(_x, _y, _z, 1.0f);
+    return result;
+}
+
+void expectMatrixNear(const glm::mat4& _actual, const glm::mat4& _expected)
+{
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            EXPECT_NEAR(_actual[column][row], _expected[column][row], 1e-4f)
+                << "column " << column << ", row " << row;
+        }
+    }
+}
+
+// Minimal executor running every task on its own thread, stands in for exec::ThreadPool.
+class ThreadPerTaskPool
+{
+   private:
+    std::vector<std::jthread> m_threads;
+
+   public:
+    std::atomic<size_t> dispatched = 0;
+
+    template <typename F>
+    std::optional<mosaic::exec::TaskFuture<void>> enqueueToWorker(F&& _f)
+    {
+        auto [task, future] = mosaic::exec::makeTaskPair(std::forward<F>(_f));
+        m_threads.emplace_back(std::move(task));
+        ++dispatched;
+
+        return std::move(future);
+    }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Matrix Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(TransformMathTest, MultiplyMatchesReference)
+{
+    glm::mat4 a;
+    glm::mat4 b;
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            a[column][row] = static_cast<float>(column * 4 + row + 1);
+            b[column][row] = static_cast<float>((column + 3) * (row - 2));
+        }
+    }
+
+    expectMatrixNear(multiplyMat4(a, b), a * b);
+}
+
+TEST(TransformMathTest, ComposeAppliesScaleRotationThenTranslation)
+{
+    // 90 degrees around Z
+    const float half = std::sqrt(0.5f);
+    const glm::mat4 m = composeTransform(glm::vec3(1.0f, 2.0f, 3.0f),
+                                         glm::quat(half, 0.0f, 0.0f, half), glm::vec3(2.0f));
+
+    const glm::vec4 point = m * glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+    EXPECT_NEAR(point[0], 1.0f, 1e-5f);
+    EXPECT_NEAR(point[1], 4.0f, 1e-5f);
+    EXPECT_NEAR(point[2], 3.0f, 1e-5f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Hierarchy Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(TransformHierarchyTest, ChildrenInheritParentTransform)
+{
+    TransformHierarchy hierarchy;
+    hierarchy.insert(1, translation(1.0f, 0.0f, 0.0f));
+    hierarchy.insert(2, 1, translation(0.0f, 2.0f, 0.0f));
+    hierarchy.insert(3, 2, translation(0.0f, 0.0f, 3.0f));
+
+    hierarchy.update();
+
+    EXPECT_EQ(hierarchy.depthCount(), 3u);
+    expectMatrixNear(hierarchy.worldTransform(3), translation(1.0f, 2.0f, 3.0f));
+    EXPECT_EQ(hierarchy.parentOf(3), std::optional<EntityID>(2));
+    EXPECT_FALSE(hierarchy.parentOf(1).has_value());
+}
+
+TEST(TransformHierarchyTest, OnlyDirtySubtreesAreRecomputed)
+{
+    TransformHierarchy hierarchy;
+    hierarchy.insert(1);
+    hierarchy.insert(2, 1);
+    hierarchy.insert(3, 2);
+    hierarchy.insert(4, 1);
+    hierarchy.insert(5);
+    hierarchy.update();
+
+    hierarchy.setLocalTransform(2, translation(5.0f, 0.0f, 0.0f));
+    hierarchy.update();
+
+    EXPECT_FALSE(hierarchy.worldChanged(1));
+    EXPECT_TRUE(hierarchy.worldChanged(2));
+    EXPECT_TRUE(hierarchy.worldChanged(3));
+    EXPECT_FALSE(hierarchy.worldChanged(4));
+    EXPECT_FALSE(hierarchy.worldChanged(5));
+    expectMatrixNear(hierarchy.worldTransform(3), translation(5.0f, 0.0f, 0.0f));
+
+    // A clean update reports nothing as changed
+    hierarchy.update();
+    EXPECT_FALSE(hierarchy.worldChanged(3));
+}
+
+TEST(TransformHierarchyTest, ReparentingKeepsDepthOrder)
+{
+    TransformHierarchy hierarchy;
+    hierarchy.insert(1, translation(1.0f, 0.0f, 0.0f));
+    hierarchy.insert(2, translation(0.0f, 1.0f, 0.0f));
+    hierarchy.insert(3, 2, translation(0.0f, 0.0f, 1.0f));
+    hierarchy.update();
+
+    // Moves 2 (and 3) under 1, which was inserted before 2 was
+    hierarchy.setParent(2, 1);
+    hierarchy.update();
+
+    expectMatrixNear(hierarchy.worldTransform(3), translation(1.0f, 1.0f, 1.0f));
+
+    const auto entities = hierarchy.entities();
+    ASSERT_EQ(entities.size(), 3u);
+    EXPECT_EQ(entities[0], 1u);
+    EXPECT_EQ(entities[1], 2u);
+    EXPECT_EQ(entities[2], 3u);
+
+    hierarchy.detach(2);
+    hierarchy.update();
+    expectMatrixNear(hierarchy.worldTransform(3), translation(0.0f, 1.0f, 1.0f));
+}
+
+TEST(TransformHierarchyTest, CyclesAndUnknownEntitiesAreRejected)
+{
+    TransformHierarchy hierarchy;
+    hierarchy.insert(1);
+    hierarchy.insert(2, 1);
+    hierarchy.insert(3, 2);
+
+    EXPECT_THROW(hierarchy.setParent(1, 3), std::invalid_argument);
+    EXPECT_THROW(hierarchy.setParent(2, 2), std::invalid_argument);
+    EXPECT_THROW(hierarchy.insert(2), std::invalid_argument);
+    EXPECT_THROW(hierarchy.insert(4, 9), std::invalid_argument);
+    EXPECT_THROW((void)hierarchy.worldTransform(9), std::invalid_argument);
+}
+
+TEST(TransformHierarchyTest, RemoveDropsTheWholeSubtree)
+{
+    TransformHierarchy hierarchy;
+    hierarchy.insert(1);
+    hierarchy.insert(2, 1);
+    hierarchy.insert(3, 2);
+    hierarchy.insert(4, 1, translation(0.0f, 4.0f, 0.0f));
+
+    EXPECT_EQ(hierarchy.remove(2), 2u);
+    EXPECT_EQ(hierarchy.remove(2), 0u);
+    EXPECT_EQ(hierarchy.size(), 2u);
+    EXPECT_FALSE(hierarchy.contains(3));
+
+    hierarchy.setLocalTransform(1, translation(1.0f, 0.0f, 0.0f));
+    hierarchy.update();
+    expectMatrixNear(hierarchy.worldTransform(4), translation(1.0f, 4.0f, 0.0f));
+}
+
+TEST(TransformHierarchyTest, ParallelUpdateMatchesSerialUpdate)
+{
+    constexpr EntityID k_roots = 64;
+    constexpr EntityID k_childrenPerRoot = 40;
+
+    TransformHierarchy serial;
+    for (EntityID root = 0; root < k_roots; ++root)
+    {
+        serial.insert(root, translation(static_cast<float>(root), 0.0f, 0.0f));
+        for (EntityID child = 0; child < k_childrenPerRoot; ++child)
+        {
+            const EntityID id = k_roots + root * k_childrenPerRoot + child;
+            serial.insert(id, root, translation(0.0f, static_cast<float>(child), 0.0f));
+            serial.insert(id + 10000, id, translation(0.0f, 0.0f, 1.0f));
+        }
+    }
+
+    TransformHierarchy parallel = serial;
+    ThreadPerTaskPool pool;
+
+    serial.update();
+    parallel.update(pool, 256);
+
+    EXPECT_GT(pool.dispatched.load(), 0u);
+    const auto entities = serial.entities();
+    for (EntityID entity : entities)
+    {
+        EXPECT_EQ(serial.worldTransform(entity), parallel.worldTransform(entity));
+    }
+}
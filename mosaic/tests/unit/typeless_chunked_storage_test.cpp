@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <mosaic/ecs/typeless_chunked_storage.hpp>
+
+using namespace mosaic::ecs;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TypelessChunkedStorageTest : public ::testing::Test
+{
+   protected:
+    using Storage = TypelessChunkedStorage<64>;
+
+    // Two columns: a 4-byte integer and a 12-byte vector, 1 KiB chunks
+    Storage storage{{{sizeof(uint32_t), alignof(uint32_t)}, {3 * sizeof(float), alignof(float)}},
+                    1024};
+
+    void emplace(EntityID _eid)
+    {
+        size_t row = storage.emplaceUninitialized(_eid);
+
+        uint32_t value = _eid;
+        float vec[3] = {float(_eid), float(_eid) * 2.0f, float(_eid) * 3.0f};
+
+        std::memcpy(storage.at(row, 0), &value, sizeof(value));
+        std::memcpy(storage.at(row, 1), vec, sizeof(vec));
+    }
+
+    uint32_t valueOf(EntityID _eid)
+    {
+        uint32_t value = 0;
+        std::memcpy(&value, storage.at(storage.indexOf(_eid), 0), sizeof(value));
+        return value;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Layout Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(TypelessChunkedStorageTest, ChunkLayoutFitsBudgetAndAlignsColumns)
+{
+    EXPECT_GT(storage.chunkCapacity(), 1);
+    EXPECT_LE(storage.chunkSizeInBytes(), 1024);
+
+    emplace(0);
+
+    for (size_t col = 0; col < storage.columnCount(); ++col)
+    {
+        auto address = reinterpret_cast<uintptr_t>(storage.columnData(0, col));
+        EXPECT_EQ(address % Storage::k_columnAlignment, 0);
+    }
+}
+
+TEST_F(TypelessChunkedStorageTest, OversizedRowGetsSingleRowChunk)
+{
+    Storage wide{{{4096, 4}}, 1024};
+
+    EXPECT_EQ(wide.chunkCapacity(), 1);
+    EXPECT_GE(wide.chunkSizeInBytes(), 4096);
+}
+
+TEST_F(TypelessChunkedStorageTest, EmptyLayoutThrows)
+{
+    EXPECT_THROW(Storage({}), std::invalid_argument);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Insertion and Removal Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(TypelessChunkedStorageTest, EmplaceAcrossChunksKeepsColumnsContiguous)
+{
+    const size_t count = storage.chunkCapacity() * 3 + 5;
+    for (EntityID eid = 0; eid < count; ++eid) emplace(eid);
+
+    EXPECT_EQ(storage.size(), count);
+    EXPECT_EQ(storage.chunkCount(), 4);
+    EXPECT_EQ(storage.chunkSize(3), 5);
+
+    size_t seen = 0;
+    for (size_t chunk = 0; chunk < storage.chunkCount(); ++chunk)
+    {
+        auto* values = reinterpret_cast<uint32_t*>(storage.columnData(chunk, 0));
+        for (size_t i = 0; i < storage.chunkSize(chunk); ++i)
+        {
+            EXPECT_EQ(values[i], storage.keys()[seen]);
+            ++seen;
+        }
+    }
+
+    EXPECT_EQ(seen, count);
+}
+
+TEST_F(TypelessChunkedStorageTest, RemoveSwapsLastRowIntoHole)
+{
+    for (EntityID eid = 0; eid < 200; ++eid) emplace(eid);
+
+    EXPECT_TRUE(storage.remove(10));
+    EXPECT_FALSE(storage.remove(10));
+    EXPECT_FALSE(storage.contains(10));
+
+    EXPECT_EQ(storage.size(), 199);
+    EXPECT_EQ(storage.indexOf(199), 10);
+    EXPECT_EQ(valueOf(199), 199);
+
+    for (EntityID eid = 0; eid < 200; ++eid)
+    {
+        if (eid == 10) continue;
+        EXPECT_EQ(valueOf(eid), eid);
+    }
+}
+
+TEST_F(TypelessChunkedStorageTest, ClearKeepsChunksForReuse)
+{
+    for (EntityID eid = 0; eid < 500; ++eid) emplace(eid);
+
+    const size_t capacity = storage.capacity();
+    storage.clear();
+
+    EXPECT_TRUE(storage.empty());
+    EXPECT_EQ(storage.capacity(), capacity);
+    EXPECT_FALSE(storage.contains(0));
+
+    emplace(42);
+    EXPECT_EQ(valueOf(42), 42);
+}
+
+TEST(ChunkArenaTest, StoragesRecycleChunksThroughTheArena)
+{
+    ChunkArena arena;
+    const std::vector<TypelessChunkedStorage<>::ColumnLayout> columns{
+        {sizeof(uint32_t), alignof(uint32_t)}};
+
+    {
+        TypelessChunkedStorage<> storage(columns, 1024, &arena);
+        // enough 1 KiB chunks to span two slabs
+        for (EntityID eid = 0; eid < 300000; ++eid) storage.emplaceUninitialized(eid);
+
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(storage.at(0, 0)) % ChunkArena::k_alignment, 0);
+        EXPECT_EQ(arena.reservedBytes(), 2 * ChunkArena::k_slabSizeInBytes);
+        EXPECT_EQ(arena.freeBytes(),
+                  arena.reservedBytes() - storage.chunkCount() * storage.chunkSizeInBytes());
+    }
+
+    // The chunks of a destroyed storage go back to the arena, not to the heap
+    const size_t reserved = arena.reservedBytes();
+    EXPECT_EQ(arena.freeBytes(), reserved);
+
+    TypelessChunkedStorage<> other(columns, 1024, &arena);
+    other.emplaceUninitialized(0);
+    EXPECT_EQ(arena.reservedBytes(), reserved);
+
+    // Only the slab still holding a chunk in use survives a trim
+    EXPECT_EQ(arena.trim(), reserved - ChunkArena::k_slabSizeInBytes);
+    EXPECT_EQ(arena.reservedBytes(), ChunkArena::k_slabSizeInBytes);
+    EXPECT_EQ(arena.trim(), 0);
+}
+
+TEST(ChunkArenaTest, AttachedStatsCountTheSlabsAndTheChunksInUse)
+{
+    pieces::AllocationStats stats;
+    const std::vector<TypelessChunkedStorage<>::ColumnLayout> columns{
+        {sizeof(uint32_t), alignof(uint32_t)}};
+
+    {
+        ChunkArena arena;
+        arena.setStats(&stats);
+
+        TypelessChunkedStorage<> storage(columns, 1024, &arena);
+        for (EntityID eid = 0; eid < 1000; ++eid) storage.emplaceUninitialized(eid);
+
+        EXPECT_EQ(stats.reservedBytes(), arena.reservedBytes());
+        EXPECT_EQ(stats.allocatedBytes(), storage.chunkCount() * storage.chunkSizeInBytes());
+
+        storage.clear();
+        EXPECT_EQ(stats.allocatedBytes(), arena.reservedBytes() - arena.freeBytes());
+
+        arena.trim();
+        EXPECT_EQ(stats.reservedBytes(), arena.reservedBytes());
+    }
+
+    EXPECT_EQ(stats.reservedBytes(), 0u);
+    EXPECT_EQ(stats.allocatedBytes(), 0u);
+}
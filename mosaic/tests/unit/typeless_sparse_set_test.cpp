@@ -158,3 +158,28 @@ TEST_F(TypelessSparseSetMixedTest, SparseEntityDistribution)
         EXPECT_EQ(healthSet.getTyped<Health>(entity), nullptr);
     }
 }
+
+TEST_F(TypelessSparseSetMixedTest, ReleaseEmptyPagesFreesUnusedPages)
+{
+    Health health(10, 100);
+    for (uint32_t eid = 0; eid < 640; ++eid) healthSet.insert(eid, &health);
+
+    const size_t fullUsage = healthSet.memoryUsageInBytes();
+
+    // empty every page but the first one
+    for (uint32_t eid = 64; eid < 640; ++eid) healthSet.remove(eid);
+
+    EXPECT_EQ(healthSet.releaseEmptyPages(), 9);
+    EXPECT_EQ(healthSet.releaseEmptyPages(), 0);
+
+    healthSet.shrinkToFit();
+    EXPECT_LT(healthSet.memoryUsageInBytes(), fullUsage);
+
+    // surviving entities stay reachable and freed pages are recreated on demand
+    for (uint32_t eid = 0; eid < 64; ++eid) EXPECT_TRUE(healthSet.contains(eid));
+    EXPECT_FALSE(healthSet.contains(300));
+
+    healthSet.insert(300, &health);
+    ASSERT_NE(healthSet.getTyped<Health>(300), nullptr);
+    EXPECT_EQ(healthSet.getTyped<Health>(300)->maximum, 100);
+}
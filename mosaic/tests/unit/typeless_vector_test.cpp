@@ -87,6 +87,19 @@ TEST(TypelessVectorTest, ShrinkToFitReducesCapacity)
     EXPECT_EQ(vec.capacity(), 2);
 }
 
+TEST(TypelessVectorTest, ShrinkToFitOnEmptyVectorKeepsOneSlot)
+{
+    TypelessVector vec(sizeof(int), 8);
+
+    vec.shrinkToFit();
+    EXPECT_EQ(vec.capacity(), 1);
+
+    int a = 7;
+    vec.pushBack(&a);
+    vec.pushBack(&a);
+    EXPECT_EQ(*reinterpret_cast<int*>(vec[1]), 7);
+}
+
 TEST(TypelessVectorTest, ResizeExpandsSize)
 {
     TypelessVector vec(sizeof(int), 2);
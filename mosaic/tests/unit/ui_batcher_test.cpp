@@ -0,0 +1,356 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/graphics/glyph_atlas.hpp>
+#include <mosaic/graphics/ui_batcher.hpp>
+
+using namespace mosaic::graphics;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/**
+ * A monospace font of boxes: every glyph but the space is a field of _pixelHeight / 2 by
+ * _pixelHeight plus the spread each side, its texels the codepoint; U+FFFF fails to rasterize.
+ */
+class BoxFont final : public GlyphSource
+{
+   public:
+    float getAscent(float _pixelHeight) const override { return _pixelHeight * 0.75f; }
+    float getLineHeight(float _pixelHeight) const override { return _pixelHeight * 1.25f; }
+
+    float getAdvance(char32_t, float _pixelHeight) const override { return _pixelHeight * 0.5f; }
+
+    std::optional<GlyphBitmap> rasterize(char32_t _codepoint, float _pixelHeight,
+                                         uint32_t _spread) const override
+    {
+        if (_codepoint == U' ') return std::nullopt;
+        if (_codepoint == 0xFFFF) throw std::runtime_error("no outline");
+
+        GlyphBitmap bitmap;
+        bitmap.width = static_cast<uint32_t>(_pixelHeight * 0.5f) + 2 * _spread;
+        bitmap.height = static_cast<uint32_t>(_pixelHeight) + 2 * _spread;
+        bitmap.left = -static_cast<float>(_spread);
+        bitmap.top = -_pixelHeight * 0.75f - static_cast<float>(_spread);
+        bitmap.pixels.assign(bitmap.width * bitmap.height, static_cast<uint8_t>(_codepoint));
+        return bitmap;
+    }
+};
+
+GlyphAtlasSettings smallAtlas()
+{
+    GlyphAtlasSettings settings;
+    settings.extent = 64;
+    settings.layers = 2;
+    settings.pixelHeight = 16.0f;
+    settings.spread = 2;
+    return settings;
+}
+
+bool overlap(const GlyphUpload& _a, const GlyphUpload& _b)
+{
+    return _a.layer == _b.layer && _a.x < _b.x + _b.width && _b.x < _a.x + _a.width &&
+           _a.y < _b.y + _b.height && _b.y < _a.y + _a.height;
+}
+
+bool isInside(const UiVertex& _vertex, const UiRect& _rect)
+{
+    constexpr float epsilon = 1e-4f;
+    const float x = _vertex.position[0];
+    const float y = _vertex.position[1];
+    return x >= _rect.x0 - epsilon && x <= _rect.x1 + epsilon && y >= _rect.y0 - epsilon &&
+           y <= _rect.y1 + epsilon;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Glyph atlas
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(GlyphAtlasTest, RejectsLayersTooSmallForAGlyph)
+{
+    GlyphAtlasSettings settings = smallAtlas();
+    settings.extent = 16;
+    EXPECT_THROW(GlyphAtlas{settings}, std::invalid_argument);
+
+    settings = smallAtlas();
+    settings.layers = 0;
+    EXPECT_THROW(GlyphAtlas{settings}, std::invalid_argument);
+}
+
+TEST(GlyphAtlasTest, AdvancesAtOnceAndDrawsOnceRasterized)
+{
+    GlyphAtlas atlas(smallAtlas());
+    const FontId font = atlas.addFont(std::make_shared<BoxFont>());
+
+    const AtlasGlyph& glyph = atlas.find(font, U'A');
+    EXPECT_FALSE(glyph.resident);
+    EXPECT_FLOAT_EQ(glyph.advance, 8.0f);
+    EXPECT_EQ(atlas.getPendingCount(), 1u);
+
+    // found again, not requested twice
+    atlas.find(font, U'A');
+    atlas.find(font, U' ');
+    EXPECT_EQ(atlas.getPendingCount(), 2u);
+
+    EXPECT_EQ(atlas.update(), 1u);
+    EXPECT_EQ(atlas.getPendingCount(), 0u);
+
+    const AtlasGlyph& resident = atlas.find(font, U'A');
+    EXPECT_TRUE(resident.resident);
+    EXPECT_FLOAT_EQ(resident.width, 12.0f);
+    EXPECT_FLOAT_EQ(resident.height, 20.0f);
+    EXPECT_FLOAT_EQ(resident.uv[2] - resident.uv[0], 12.0f / 64.0f);
+
+    // the space only advances
+    EXPECT_FALSE(atlas.find(font, U' ').resident);
+
+    ASSERT_EQ(atlas.getUploads().size(), 1u);
+    const GlyphUpload& upload = atlas.getUploads()[0];
+    EXPECT_EQ(upload.width * upload.height, atlas.getUploadData().size());
+    EXPECT_EQ(atlas.getUploadData()[upload.offset], static_cast<uint8_t>(U'A'));
+
+    atlas.clearUploads();
+    EXPECT_TRUE(atlas.getUploads().empty());
+    EXPECT_EQ(atlas.update(), 0u);
+}
+
+TEST(GlyphAtlasTest, PacksTheGlyphsWithoutOverlapUntilEveryLayerIsFull)
+{
+    GlyphAtlas atlas(smallAtlas());
+    const FontId font = atlas.addFont(std::make_shared<BoxFont>());
+
+    // 13 x 21 with the gutter, shelves of 24: 4 a shelf, 2 shelves a layer
+    for (char32_t codepoint = U'a'; codepoint <= U'z'; ++codepoint) atlas.find(font, codepoint);
+    EXPECT_EQ(atlas.update(), 16u);
+
+    const auto uploads = atlas.getUploads();
+    ASSERT_EQ(uploads.size(), 16u);
+    for (size_t i = 0; i < uploads.size(); ++i)
+    {
+        EXPECT_LE(uploads[i].x + uploads[i].width, 64u);
+        EXPECT_LE(uploads[i].y + uploads[i].height, 64u);
+        for (size_t j = i + 1; j < uploads.size(); ++j)
+        {
+            EXPECT_FALSE(overlap(uploads[i], uploads[j])) << i << " and " << j;
+        }
+    }
+    EXPECT_EQ(uploads.back().layer, 1u);
+
+    // the last ones did not fit, only advanced over
+    EXPECT_FALSE(atlas.find(font, U'z').resident);
+    EXPECT_FLOAT_EQ(atlas.find(font, U'z').advance, 8.0f);
+
+    // a glyph that fails to rasterize is not retried
+    atlas.find(font, 0xFFFF);
+    EXPECT_EQ(atlas.update(), 0u);
+    EXPECT_EQ(atlas.getPendingCount(), 0u);
+}
+
+TEST(GlyphAtlasTest, RasterizesOnTheWorkers)
+{
+    mosaic::core::CPUInfo cpuInfo;
+    cpuInfo.logicalCores = 4;
+    cpuInfo.physicalCores = 2;
+
+    auto pool = std::make_unique<mosaic::exec::ThreadPool>();
+    ASSERT_TRUE(pool->initialize(cpuInfo).isOk());
+
+    GlyphAtlasSettings settings;
+    settings.maxPending = 8;
+    GlyphAtlas atlas(settings);
+    const FontId font = atlas.addFont(std::make_shared<BoxFont>());
+
+    for (char32_t codepoint = U'!'; codepoint <= U'~'; ++codepoint) atlas.find(font, codepoint);
+    atlas.find(font, 0xFFFF); // throws on its worker
+    atlas.flush(pool.get());
+
+    EXPECT_EQ(atlas.getPendingCount(), 0u);
+    EXPECT_EQ(atlas.getUploads().size(), static_cast<size_t>(U'~' - U'!' + 1));
+    EXPECT_TRUE(atlas.find(font, U'~').resident);
+
+    pool->shutdown();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Batching
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(UiBatcherTest, DrawsRectsImagesAndTextInOneDraw)
+{
+    std::vector<std::byte> memory(2 * 4096);
+
+    FrameRing ring;
+    ring.reset(memory.data(), 4096, 2);
+    ring.beginFrame(1);
+    ASSERT_TRUE(ring.allocate(4, 4)); // the vertices start at the next 32 bytes
+
+    GlyphAtlas atlas(smallAtlas());
+    const FontId font = atlas.addFont(std::make_shared<BoxFont>());
+    UiBatcher::measureText(atlas, font, 16.0f, "Hi");
+    atlas.update();
+
+    UiBatcher batcher;
+    batcher.begin(800, 600);
+    batcher.addRect({10.0f, 10.0f, 110.0f, 40.0f}, packUiColor(0, 0, 0, 128));
+    batcher.addImage({120.0f, 10.0f, 152.0f, 42.0f}, 77);
+    const uint32_t white = packUiColor(255, 255, 255);
+    EXPECT_FLOAT_EQ(batcher.addText(atlas, font, 12.0f, 12.0f, 32.0f, "Hi", white), 32.0f);
+
+    ASSERT_EQ(batcher.getVertices().size(), 16u);
+    ASSERT_EQ(batcher.getIndices().size(), 24u);
+    const auto vertices = batcher.getVertices();
+    EXPECT_EQ(vertices[4].texture, 77u);
+    EXPECT_EQ(vertices[4].mode, UiVertex::k_image);
+    EXPECT_EQ(vertices[8].mode, UiVertex::k_text);
+
+    // twice the atlas size: the box of 'H' from the pen, its top at the ascent above the baseline
+    EXPECT_FLOAT_EQ(vertices[8].position[0], 12.0f - 4.0f);
+    EXPECT_FLOAT_EQ(vertices[8].position[1], 12.0f - 4.0f);
+    EXPECT_FLOAT_EQ(vertices[13].position[0], 12.0f + 16.0f - 4.0f + 24.0f);
+
+    DrawCall call;
+    call.pipeline = 3;
+    call.indexBuffer = 5;
+    call.resources[UiBatcher::k_atlasResource] = 9;
+
+    DrawQueue queue;
+    ASSERT_EQ(batcher.emit(ring, queue, 42, call), 1u);
+    ASSERT_EQ(queue.size(), 1u);
+
+    const DrawCall& draw = queue.getCalls()[0];
+    EXPECT_EQ(draw.type, DrawCallType::Indexed);
+    EXPECT_EQ(draw.pipeline, 3u);
+    EXPECT_EQ(draw.indexBuffer, 5u);
+    EXPECT_EQ(draw.indexCount, 24u);
+    EXPECT_EQ(draw.vertexOffset, (4096u + 32u) / sizeof(UiVertex));
+    EXPECT_EQ(draw.firstIndex, (4096u + 32u + 16u * sizeof(UiVertex)) / sizeof(uint32_t));
+    EXPECT_EQ(draw.resources[UiBatcher::k_vertexResource], 42u);
+    EXPECT_EQ(draw.resources[UiBatcher::k_atlasResource], 9u);
+    EXPECT_EQ(draw.resources[UiBatcher::k_viewportResource], 800u | (600u << 16));
+
+    // the shaders read vertices[gl_VertexIndex] of the whole buffer
+    const auto* ringVertices = reinterpret_cast<const UiVertex*>(memory.data());
+    const auto* ringIndices = reinterpret_cast<const uint32_t*>(memory.data());
+    EXPECT_EQ(ringVertices[draw.vertexOffset + ringIndices[draw.firstIndex + 6]].texture, 77u);
+}
+
+TEST(UiBatcherTest, EmitsNothingWhenEmptyOrTheRingIsFull)
+{
+    std::vector<std::byte> memory(256);
+
+    FrameRing ring;
+    ring.reset(memory.data(), 256, 1);
+    ring.beginFrame(0);
+
+    UiBatcher batcher;
+    batcher.begin(100, 100);
+
+    DrawQueue queue;
+    EXPECT_EQ(batcher.emit(ring, queue, 0, {}), 0u);
+
+    for (int i = 0; i < 4; ++i) batcher.addRect({0.0f, 0.0f, 10.0f, 10.0f}, 0xFFFFFFFFu);
+    EXPECT_EQ(batcher.emit(ring, queue, 0, {}), 0u);
+    EXPECT_TRUE(queue.empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Clipping
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(UiBatcherTest, ClipsRectanglesAndTheirTextureCoordinates)
+{
+    UiBatcher batcher;
+    batcher.begin(200, 200);
+
+    batcher.pushClip({50.0f, 50.0f, 150.0f, 150.0f});
+    batcher.pushClip({0.0f, 100.0f, 200.0f, 200.0f});
+    EXPECT_FLOAT_EQ(batcher.getClip().x0, 50.0f);
+    EXPECT_FLOAT_EQ(batcher.getClip().y0, 100.0f);
+
+    // half of it clipped away, the lower half of the texture left
+    batcher.addImage({50.0f, 50.0f, 150.0f, 150.0f}, 1);
+    batcher.addRect({0.0f, 0.0f, 40.0f, 40.0f}, 0xFFFFFFFFu); // outside, dropped
+
+    const auto vertices = batcher.getVertices();
+    ASSERT_EQ(vertices.size(), 4u);
+    EXPECT_FLOAT_EQ(vertices[0].position[1], 100.0f);
+    EXPECT_FLOAT_EQ(vertices[0].uv[1], 0.5f);
+    EXPECT_FLOAT_EQ(vertices[2].position[1], 150.0f);
+    EXPECT_FLOAT_EQ(vertices[2].uv[1], 1.0f);
+    EXPECT_FLOAT_EQ(vertices[2].uv[0], 1.0f);
+
+    // back to the first clip, never past the viewport
+    batcher.popClip();
+    batcher.popClip();
+    batcher.popClip();
+    EXPECT_FLOAT_EQ(batcher.getClip().x1, 200.0f);
+    batcher.addRect({190.0f, -10.0f, 260.0f, 10.0f}, 0xFFFFFFFFu);
+    EXPECT_FLOAT_EQ(batcher.getVertices()[4].position[1], 0.0f);
+    EXPECT_FLOAT_EQ(batcher.getVertices()[5].position[0], 200.0f);
+}
+
+TEST(UiBatcherTest, ClipsLinesToTheClipRectangle)
+{
+    UiBatcher batcher;
+    batcher.begin(100, 100);
+
+    const UiRect clip = {20.0f, 20.0f, 80.0f, 80.0f};
+    batcher.pushClip(clip);
+
+    // a diagonal across the whole viewport, cut at both ends
+    batcher.addLine(0.0f, 0.0f, 100.0f, 100.0f, 4.0f, 0xFFFFFFFFu);
+
+    const auto vertices = batcher.getVertices();
+    ASSERT_GE(vertices.size(), 4u);
+    for (const UiVertex& vertex : vertices) EXPECT_TRUE(isInside(vertex, clip));
+    EXPECT_EQ(batcher.getIndices().size(), (vertices.size() - 2) * 3);
+
+    for (uint32_t index : batcher.getIndices()) EXPECT_LT(index, vertices.size());
+
+    // wholly outside
+    batcher.addLine(0.0f, 90.0f, 100.0f, 90.0f, 2.0f, 0xFFFFFFFFu);
+    EXPECT_EQ(batcher.getVertices().size(), vertices.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Text
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(UiBatcherTest, LaysOutLinesAndUtf8)
+{
+    GlyphAtlas atlas(smallAtlas());
+    const FontId font = atlas.addFont(std::make_shared<BoxFont>());
+
+    // 8 pixels a glyph at 16: the longest line wins
+    EXPECT_FLOAT_EQ(UiBatcher::measureText(atlas, font, 16.0f, "abc\nabcde\n"), 40.0f);
+
+    // two codepoints of two and three bytes, then a malformed byte (one glyph)
+    EXPECT_FLOAT_EQ(UiBatcher::measureText(atlas, font, 16.0f, "\xC3\xA9\xE2\x82\xAC\xFF"),
+                    24.0f);
+    atlas.update();
+    EXPECT_TRUE(atlas.find(font, 0xE9).resident);
+    EXPECT_TRUE(atlas.find(font, 0x20AC).resident);
+    EXPECT_TRUE(atlas.find(font, 0xFFFD).resident);
+
+    // the second line a line height below
+    UiBatcher batcher;
+    batcher.begin(200, 200);
+    batcher.addText(atlas, font, 0.0f, 10.0f, 16.0f, "a\na", 0xFFFFFFFFu);
+    ASSERT_EQ(batcher.getVertices().size(), 8u);
+    EXPECT_FLOAT_EQ(batcher.getVertices()[4].position[1] - batcher.getVertices()[0].position[1],
+                    20.0f);
+}
@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <mosaic/ecs/snapshot.hpp>
+#include <mosaic/exec/thread_pool.hpp>
+#include <mosaic/scene/world_streaming.hpp>
+
+using namespace mosaic::scene;
+using namespace mosaic::ecs;
+using namespace mosaic::exec;
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fixture
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct Position
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+struct Cell
+{
+    uint32_t index = 0;
+};
+
+} // namespace
+
+// Cells of 100 units along x, cell i spanning [100 i, 100 i + 100]
+class WorldStreamingTest : public ::testing::Test
+{
+   protected:
+    std::unique_ptr<ThreadPool> m_pool;
+    std::unique_ptr<IoService> m_io;
+    std::unique_ptr<ComponentRegistry> m_compRegistry;
+    std::unique_ptr<EntityRegistry> m_world;
+    std::vector<std::filesystem::path> m_paths;
+
+    void SetUp() override
+    {
+        mosaic::core::CPUInfo mockCPUInfo;
+        mockCPUInfo.logicalCores = 4;
+        mockCPUInfo.physicalCores = 2;
+
+        m_pool = std::make_unique<ThreadPool>();
+        ASSERT_TRUE(m_pool->initialize(mockCPUInfo).isOk());
+
+        m_io = std::make_unique<IoService>();
+        ASSERT_TRUE(m_io->initialize(8, IoBackendType::thread_pool).isOk());
+
+        m_compRegistry = std::make_unique<ComponentRegistry>(16);
+        m_compRegistry->registerComponent<Position>("Position");
+        m_compRegistry->registerComponent<Cell>("Cell");
+
+        m_world = std::make_unique<EntityRegistry>(m_compRegistry.get());
+    }
+
+    void TearDown() override
+    {
+        m_world.reset();
+
+        m_io->shutdown();
+        m_io.reset();
+
+        m_pool->shutdown();
+        m_pool.reset();
+
+        for (const auto& path : m_paths) std::filesystem::remove(path);
+    }
+
+    // Writes the snapshot of a cell of _count entities
+    std::filesystem::path writeCell(uint32_t _index, size_t _count)
+    {
+        EntityRegistry registry(m_compRegistry.get());
+        for (size_t i = 0; i < _count; ++i)
+        {
+            registry.createEntity<Position, Cell>(
+                std::make_tuple(100.0f * float(_index) + float(i % 100), 0.0f, 0.0f),
+                std::make_tuple(_index));
+        }
+
+        const auto path = std::filesystem::temp_directory_path() /
+                          ("mosaic_world_streaming_test_" + std::to_string(_index));
+        saveSnapshotToFile(registry, path);
+        m_paths.push_back(path);
+        return path;
+    }
+
+    static Aabb cellBounds(uint32_t _index)
+    {
+        return {glm::vec3(100.0f * float(_index), -50.0f, -50.0f),
+                glm::vec3(100.0f * float(_index) + 100.0f, 50.0f, 50.0f)};
+    }
+
+    // Updates until no cell is loading or activating
+    static void settle(WorldStreamer& _streamer, const glm::vec3& _camera)
+    {
+        for (int frame = 0; frame < 2000; ++frame)
+        {
+            _streamer.update(_camera);
+
+            bool busy = false;
+            for (WorldCellId id = 0; id < _streamer.getCellCount(); ++id)
+            {
+                const WorldCellState state = _streamer.getState(id);
+                busy |= state == WorldCellState::loading || state == WorldCellState::activating;
+            }
+            if (!busy) return;
+
+            std::this_thread::sleep_for(1ms);
+        }
+        FAIL() << "The cells did not settle";
+    }
+
+    size_t countCellEntities(uint32_t _index)
+    {
+        size_t count = 0;
+        m_world->query<Cell, Position>().view().readOnly().forEach(
+            [&](EntityMeta, const Cell& _cell, const Position& _position)
+            {
+                if (_cell.index != _index) return;
+                EXPECT_GE(_position.x, 100.0f * float(_index));
+                EXPECT_LT(_position.x, 100.0f * float(_index) + 100.0f);
+                ++count;
+            });
+        return count;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Streaming
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST_F(WorldStreamingTest, StreamsTheCellsAroundTheCamera)
+{
+    WorldStreamingSettings settings;
+    settings.loadDistance = 150.0f;
+    settings.unloadDistance = 250.0f;
+
+    WorldStreamer streamer(*m_world, *m_io, settings);
+    for (uint32_t i = 0; i < 6; ++i) streamer.addCell(cellBounds(i), writeCell(i, 40 + i));
+
+    // cells 0 and 1 within 150 of x = 50, cell 2 at 150 exactly
+    settle(streamer, glm::vec3(50.0f, 0.0f, 0.0f));
+    EXPECT_EQ(streamer.getState(0), WorldCellState::active);
+    EXPECT_EQ(streamer.getState(1), WorldCellState::active);
+    EXPECT_EQ(streamer.getState(2), WorldCellState::active);
+    EXPECT_EQ(streamer.getState(3), WorldCellState::unloaded);
+
+    EXPECT_EQ(m_world->entityCount(), 123u);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(countCellEntities(i), 40u + i);
+        EXPECT_EQ(streamer.getEntities(i).size(), 40u + i);
+    }
+    EXPECT_EQ(streamer.getCommittedSize(),
+              streamer.getCellSize(0) + streamer.getCellSize(1) + streamer.getCellSize(2));
+
+    // at x = 250: cell 0 is 150 away, past the load but within the unload distance
+    settle(streamer, glm::vec3(250.0f, 0.0f, 0.0f));
+    EXPECT_EQ(streamer.getState(0), WorldCellState::active);
+    EXPECT_EQ(streamer.getState(4), WorldCellState::active);
+    EXPECT_EQ(streamer.getState(5), WorldCellState::unloaded);
+
+    // at x = 460: cells 0 and 1 are past the unload distance
+    settle(streamer, glm::vec3(460.0f, 0.0f, 0.0f));
+    EXPECT_EQ(streamer.getState(0), WorldCellState::unloaded);
+    EXPECT_EQ(streamer.getState(1), WorldCellState::unloaded);
+    EXPECT_TRUE(streamer.getEntities(0).empty());
+    EXPECT_EQ(countCellEntities(0), 0u);
+    EXPECT_EQ(countCellEntities(1), 0u);
+    EXPECT_EQ(countCellEntities(5), 45u);
+
+    uint64_t committed = 0;
+    size_t entities = 0;
+    for (WorldCellId id = 0; id < streamer.getCellCount(); ++id)
+    {
+        if (streamer.getState(id) != WorldCellState::active) continue;
+        committed += streamer.getCellSize(id);
+        entities += streamer.getEntities(id).size();
+    }
+    EXPECT_EQ(streamer.getCommittedSize(), committed);
+    EXPECT_EQ(m_world->entityCount(), entities);
+}
+
+TEST_F(WorldStreamingTest, ActivatesLargeCellsOverSeveralFrames)
+{
+    WorldStreamingSettings settings;
+    settings.activationBudget = 0us; // a single slice a frame
+    settings.activationSlice = 100;
+
+    WorldStreamer streamer(*m_world, *m_io, settings);
+    const WorldCellId cell = streamer.addCell(cellBounds(0), writeCell(0, 1000));
+
+    while (streamer.update(glm::vec3(0.0f)) == 0)
+    {
+        ASSERT_NE(streamer.getState(cell), WorldCellState::failed);
+        std::this_thread::sleep_for(1ms);
+    }
+
+    size_t frames = 1;
+    while (streamer.getState(cell) == WorldCellState::activating)
+    {
+        const size_t inserted = streamer.update(glm::vec3(0.0f));
+        EXPECT_LE(inserted, 100u);
+        ++frames;
+    }
+
+    EXPECT_EQ(streamer.getState(cell), WorldCellState::active);
+    EXPECT_EQ(frames, 10u);
+    EXPECT_EQ(countCellEntities(0), 1000u);
+
+    // the entities destroyed meanwhile are skipped by the unload
+    const EntityMeta first = streamer.getEntities(cell)[0];
+    m_world->destroyEntity(first.id);
+
+    streamer.unload(cell);
+    EXPECT_EQ(m_world->entityCount(), 0u);
+    EXPECT_EQ(streamer.getCommittedSize(), 0u);
+}
+
+TEST_F(WorldStreamingTest, KeepsTheNearestCellsWithinTheBudget)
+{
+    std::vector<std::filesystem::path> paths;
+    for (uint32_t i = 0; i < 4; ++i) paths.push_back(writeCell(i, 50));
+    const uint64_t size = std::filesystem::file_size(paths[0]);
+
+    WorldStreamingSettings settings;
+    settings.loadDistance = 1000.0f;
+    settings.unloadDistance = 1000.0f;
+    settings.budget = 2 * size;
+
+    WorldStreamer streamer(*m_world, *m_io, settings);
+    for (uint32_t i = 0; i < 4; ++i) streamer.addCell(cellBounds(i), paths[i]);
+
+    settle(streamer, glm::vec3(-10.0f, 0.0f, 0.0f));
+    EXPECT_EQ(streamer.getState(0), WorldCellState::active);
+    EXPECT_EQ(streamer.getState(1), WorldCellState::active);
+    EXPECT_EQ(streamer.getState(2), WorldCellState::unloaded);
+    EXPECT_EQ(streamer.getCommittedSize(), 2 * size);
+
+    // the nearer cells push the farther ones out of the budget
+    settle(streamer, glm::vec3(410.0f, 0.0f, 0.0f));
+    EXPECT_EQ(streamer.getState(0), WorldCellState::unloaded);
+    EXPECT_EQ(streamer.getState(1), WorldCellState::unloaded);
+    EXPECT_EQ(streamer.getState(2), WorldCellState::active);
+    EXPECT_EQ(streamer.getState(3), WorldCellState::active);
+    EXPECT_EQ(streamer.getCommittedSize(), 2 * size);
+    EXPECT_EQ(m_world->entityCount(), 100u);
+}
+
+TEST_F(WorldStreamingTest, FailedCellsAreNotStreamedAgain)
+{
+    const auto missing = std::filesystem::temp_directory_path() / "mosaic_world_streaming_missing";
+    std::filesystem::remove(missing);
+
+    const auto corrupt = std::filesystem::temp_directory_path() / "mosaic_world_streaming_corrupt";
+    {
+        std::ofstream file(corrupt, std::ios::binary | std::ios::trunc);
+        file << "not a snapshot";
+    }
+    m_paths.push_back(corrupt);
+
+    WorldStreamer streamer(*m_world, *m_io);
+    const WorldCellId a = streamer.addCell(cellBounds(0), missing);
+    const WorldCellId b = streamer.addCell(cellBounds(1), corrupt);
+    const WorldCellId c = streamer.addCell(cellBounds(2), writeCell(2, 10));
+
+    settle(streamer, glm::vec3(0.0f));
+    EXPECT_EQ(streamer.getState(a), WorldCellState::failed);
+    EXPECT_EQ(streamer.getState(b), WorldCellState::failed);
+    EXPECT_EQ(streamer.getState(c), WorldCellState::active);
+    EXPECT_EQ(streamer.getCommittedSize(), streamer.getCellSize(c));
+    EXPECT_EQ(m_world->entityCount(), 10u);
+
+    // unload() lets a failed cell be streamed again
+    streamer.unload(a);
+    EXPECT_EQ(streamer.getState(a), WorldCellState::unloaded);
+    settle(streamer, glm::vec3(0.0f));
+    EXPECT_EQ(streamer.getState(a), WorldCellState::failed);
+}
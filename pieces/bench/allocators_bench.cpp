@@ -0,0 +1,325 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <pieces/memory/concurrent_pool_allocator.hpp>
+#include <pieces/memory/contiguous_allocator.hpp>
+#include <pieces/memory/freelist_allocator.hpp>
+#include <pieces/memory/pool_allocator.hpp>
+
+using namespace pieces;
+
+// Every benchmark allocates state.range(0) blocks then frees them, malloc being the baseline of
+// each pattern
+
+struct Object
+{
+    uint64_t data[8];
+};
+
+static std::vector<size_t> makeFreeOrder(size_t _count, uint32_t _seed = 42)
+{
+    std::vector<size_t> order(_count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::shuffle(order.begin(), order.end(), std::mt19937(_seed));
+    return order;
+}
+
+// Between 16 and 512 bytes, mostly small
+static std::vector<size_t> makeSizes(size_t _count, uint32_t _seed = 42)
+{
+    std::mt19937 rng(_seed);
+    std::geometric_distribution<size_t> dist(0.02);
+
+    std::vector<size_t> sizes(_count);
+    for (size_t& size : sizes) size = std::clamp<size_t>(16 + dist(rng) * 4, 16, 512);
+    return sizes;
+}
+
+// Fixed size, freed in a random order
+
+static void BM_Malloc_Fixed(benchmark::State& state)
+{
+    const std::vector<size_t> order = makeFreeOrder(size_t(state.range(0)));
+    std::vector<void*> ptrs(order.size());
+
+    for (auto _ : state)
+    {
+        for (void*& ptr : ptrs) ptr = std::malloc(sizeof(Object));
+        benchmark::DoNotOptimize(ptrs.data());
+        for (size_t i : order) std::free(ptrs[i]);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Malloc_Fixed)->Range(1 << 8, 1 << 16);
+
+template <PoolAllocatorPolicy Policy>
+static void BM_PoolAllocator_Fixed(benchmark::State& state)
+{
+    const std::vector<size_t> order = makeFreeOrder(size_t(state.range(0)));
+    std::vector<Object*> ptrs(order.size());
+    PoolAllocator<Object, Policy> allocator(order.size());
+
+    for (auto _ : state)
+    {
+        for (Object*& ptr : ptrs) ptr = allocator.allocate(1);
+        benchmark::DoNotOptimize(ptrs.data());
+        for (size_t i : order) allocator.deallocate(ptrs[i], 1);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_PoolAllocator_Fixed, PoolAllocatorPolicy::automatic_indexing)
+    ->Range(1 << 8, 1 << 16);
+
+static void BM_ConcurrentPoolAllocator_Fixed(benchmark::State& state)
+{
+    const std::vector<size_t> order = makeFreeOrder(size_t(state.range(0)));
+    std::vector<Object*> ptrs(order.size());
+    ConcurrentPoolAllocator<Object> allocator(order.size());
+
+    for (auto _ : state)
+    {
+        for (Object*& ptr : ptrs) ptr = allocator.allocate();
+        benchmark::DoNotOptimize(ptrs.data());
+        for (size_t i : order) allocator.deallocate(ptrs[i]);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ConcurrentPoolAllocator_Fixed)->Range(1 << 8, 1 << 16);
+
+// Variable sizes, freed in a random order
+
+static void BM_Malloc_Variable(benchmark::State& state)
+{
+    const std::vector<size_t> order = makeFreeOrder(size_t(state.range(0)));
+    const std::vector<size_t> sizes = makeSizes(order.size());
+    std::vector<void*> ptrs(order.size());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < ptrs.size(); ++i) ptrs[i] = std::malloc(sizes[i]);
+        benchmark::DoNotOptimize(ptrs.data());
+        for (size_t i : order) std::free(ptrs[i]);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Malloc_Variable)->Range(1 << 8, 1 << 12);
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+static void BM_FreeListAllocator_Variable(benchmark::State& state)
+{
+    const std::vector<size_t> order = makeFreeOrder(size_t(state.range(0)));
+    const std::vector<size_t> sizes = makeSizes(order.size());
+    std::vector<void*> ptrs(order.size());
+
+    // Room for the headers and the alignment of every block
+    FreeListAllocator<Policy, CoalescePolicy> allocator(order.size() * 1024);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < ptrs.size(); ++i) ptrs[i] = allocator.allocate(sizes[i]);
+        benchmark::DoNotOptimize(ptrs.data());
+        for (size_t i : order) allocator.deallocate(ptrs[i], sizes[i]);
+    }
+
+    state.counters["freeBlocks"] = double(allocator.getFreeBlockCount());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_FreeListAllocator_Variable, FreeListAllocatorPolicy::first_fit,
+                   CoalescingPolicy::immediate)
+    ->Range(1 << 8, 1 << 12);
+BENCHMARK_TEMPLATE(BM_FreeListAllocator_Variable, FreeListAllocatorPolicy::first_fit,
+                   CoalescingPolicy::deferred)
+    ->Range(1 << 8, 1 << 12);
+BENCHMARK_TEMPLATE(BM_FreeListAllocator_Variable, FreeListAllocatorPolicy::best_fit,
+                   CoalescingPolicy::deferred)
+    ->Range(1 << 8, 1 << 12);
+BENCHMARK_TEMPLATE(BM_FreeListAllocator_Variable, FreeListAllocatorPolicy::worst_fit,
+                   CoalescingPolicy::deferred)
+    ->Range(1 << 8, 1 << 12);
+BENCHMARK_TEMPLATE(BM_FreeListAllocator_Variable, FreeListAllocatorPolicy::tlsf,
+                   CoalescingPolicy::immediate)
+    ->Range(1 << 8, 1 << 12);
+
+// The contiguous patterns: released all at once (linear), in reverse order (stack), or
+// overwritten once the buffer wraps around (circular)
+
+static void BM_Malloc_Reverse(benchmark::State& state)
+{
+    std::vector<void*> ptrs(size_t(state.range(0)));
+
+    for (auto _ : state)
+    {
+        for (void*& ptr : ptrs) ptr = std::malloc(sizeof(Object));
+        benchmark::DoNotOptimize(ptrs.data());
+        for (auto it = ptrs.rbegin(); it != ptrs.rend(); ++it) std::free(*it);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Malloc_Reverse)->Range(1 << 8, 1 << 16);
+
+static void BM_LinearAllocator(benchmark::State& state)
+{
+    LinearAllocator<Object> allocator(size_t(state.range(0)));
+
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            benchmark::DoNotOptimize(allocator.allocate(1));
+        }
+        allocator.reset();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_LinearAllocator)->Range(1 << 8, 1 << 16);
+
+static void BM_StackAllocator(benchmark::State& state)
+{
+    std::vector<Object*> ptrs(size_t(state.range(0)));
+    StackAllocator<Object> allocator(ptrs.size());
+
+    for (auto _ : state)
+    {
+        for (Object*& ptr : ptrs) ptr = allocator.allocate(1);
+        benchmark::DoNotOptimize(ptrs.data());
+        for (auto it = ptrs.rbegin(); it != ptrs.rend(); ++it) allocator.deallocate(*it, 1);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_StackAllocator)->Range(1 << 8, 1 << 16);
+
+static void BM_CircularAllocator(benchmark::State& state)
+{
+    // A quarter of the allocations, so that it wraps around four times per iteration
+    CircularAllocator<Object> allocator(size_t(state.range(0)) / 4);
+
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            benchmark::DoNotOptimize(allocator.allocate(1));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_CircularAllocator)->Range(1 << 8, 1 << 16);
+
+// Threaded: every thread allocates and frees its batch; a fraction of state.range(0) percent of
+// it is handed over to the next thread to free, the remote frees of a producer and a consumer
+
+static constexpr size_t k_contendedBatch = 256;
+static constexpr int k_maxContendedThreads = 8;
+
+// Twice the live blocks, for the slots cached in the magazines
+static ConcurrentPoolAllocator<Object> g_concurrentPool(k_contendedBatch * k_maxContendedThreads *
+                                                        4);
+
+// Fixed at startup, one mailbox per thread index: written by its thread, read by the next
+template <typename Ptr>
+struct alignas(64) Mailbox
+{
+    std::atomic<Ptr*> ptrs[k_contendedBatch] = {};
+};
+
+template <typename Ptr, typename Allocate, typename Free>
+static void runContended(benchmark::State& _state, Mailbox<Ptr>* _mailboxes, Allocate&& _allocate,
+                         Free&& _free)
+{
+    const int self = _state.thread_index();
+    const int next = (self + 1) % _state.threads();
+    const size_t handedOver = k_contendedBatch * size_t(_state.range(0)) / 100;
+
+    std::vector<Ptr*> ptrs(k_contendedBatch);
+
+    for (auto _ : _state)
+    {
+        for (Ptr*& ptr : ptrs) ptr = _allocate();
+        benchmark::DoNotOptimize(ptrs.data());
+
+        for (size_t i = 0; i < k_contendedBatch; ++i)
+        {
+            if (i < handedOver)
+            {
+                // Frees what the previous thread handed over in that slot, hands this one over
+                if (Ptr* remote = _mailboxes[next].ptrs[i].exchange(ptrs[i])) _free(remote);
+            }
+            else
+            {
+                _free(ptrs[i]);
+            }
+        }
+    }
+
+    _state.SetItemsProcessed(_state.iterations() * int64_t(k_contendedBatch));
+}
+
+static Mailbox<Object> g_poolMailboxes[k_maxContendedThreads];
+static Mailbox<void> g_mallocMailboxes[k_maxContendedThreads];
+
+template <typename Ptr>
+static void drainMailboxes(Mailbox<Ptr>* _mailboxes, auto&& _free)
+{
+    for (int thread = 0; thread < k_maxContendedThreads; ++thread)
+    {
+        for (std::atomic<Ptr*>& slot : _mailboxes[thread].ptrs)
+        {
+            if (Ptr* ptr = slot.exchange(nullptr)) _free(ptr);
+        }
+    }
+}
+
+static void BM_ConcurrentPoolAllocator_Contended(benchmark::State& state)
+{
+    runContended(
+        state, g_poolMailboxes, [] { return g_concurrentPool.allocate(); },
+        [](Object* _ptr) { g_concurrentPool.deallocate(_ptr); });
+
+    if (state.thread_index() == 0)
+    {
+        drainMailboxes(g_poolMailboxes, [](Object* _ptr) { g_concurrentPool.deallocate(_ptr); });
+    }
+}
+
+static void BM_Malloc_Contended(benchmark::State& state)
+{
+    runContended(
+        state, g_mallocMailboxes, [] { return std::malloc(sizeof(Object)); },
+        [](void* _ptr) { std::free(_ptr); });
+
+    if (state.thread_index() == 0)
+    {
+        drainMailboxes(g_mallocMailboxes, [](void* _ptr) { std::free(_ptr); });
+    }
+}
+
+// The percentage of remote frees, by thread count
+BENCHMARK(BM_ConcurrentPoolAllocator_Contended)
+    ->Arg(0)->Arg(25)->Arg(100)
+    ->ThreadRange(1, k_maxContendedThreads)
+    ->UseRealTime();
+BENCHMARK(BM_Malloc_Contended)
+    ->Arg(0)->Arg(25)->Arg(100)
+    ->ThreadRange(1, k_maxContendedThreads)
+    ->UseRealTime();
@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <pieces/containers/bitset.hpp>
+
+using namespace pieces;
+
+// One of every _stride bits set, from a fixed seed
+static BitSet makeBits(size_t _size, size_t _stride, uint32_t _seed = 42)
+{
+    BitSet bits(_size);
+    std::mt19937 rng(_seed);
+    std::uniform_int_distribution<size_t> dist(0, _stride - 1);
+    for (size_t i = 0; i < _size; ++i)
+    {
+        if (dist(rng) == 0) bits.setBit(i);
+    }
+
+    return bits;
+}
+
+static void BM_BitSet_SetTest(benchmark::State& state)
+{
+    const size_t size = size_t(state.range(0));
+    BitSet bits(size);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < size; i += 3) bits.setBit(i);
+
+        size_t found = 0;
+        for (size_t i = 0; i < size; ++i) found += bits.testBit(i) ? 1 : 0;
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_BitSet_SetTest)->Range(1 << 10, 1 << 20);
+
+static void BM_VectorBool_SetTest(benchmark::State& state)
+{
+    const size_t size = size_t(state.range(0));
+    std::vector<bool> bits(size);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < size; i += 3) bits[i] = true;
+
+        size_t found = 0;
+        for (size_t i = 0; i < size; ++i) found += bits[i] ? 1 : 0;
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_VectorBool_SetTest)->Range(1 << 10, 1 << 20);
+
+// The word-wise operations, the SIMD paths of detail::applyWords
+
+static void BM_BitSet_AndWith(benchmark::State& state)
+{
+    BitSet bits = makeBits(size_t(state.range(0)), 2);
+    const BitSet mask = makeBits(size_t(state.range(0)), 2, 7);
+
+    for (auto _ : state)
+    {
+        bits.andWith(mask);
+        benchmark::DoNotOptimize(bits.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+BENCHMARK(BM_BitSet_AndWith)->Range(1 << 10, 1 << 20);
+
+static void BM_BitSet_Or(benchmark::State& state)
+{
+    const BitSet a = makeBits(size_t(state.range(0)), 2);
+    const BitSet b = makeBits(size_t(state.range(0)), 2, 7);
+
+    for (auto _ : state)
+    {
+        BitSet result = a | b;
+        benchmark::DoNotOptimize(result.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+BENCHMARK(BM_BitSet_Or)->Range(1 << 10, 1 << 20);
+
+static void BM_BitSet_Intersects(benchmark::State& state)
+{
+    // Disjoint, so that the whole set is scanned
+    BitSet a(size_t(state.range(0)));
+    BitSet b(size_t(state.range(0)));
+    for (size_t i = 0; i < a.size(); i += 2) a.setBit(i);
+    for (size_t i = 1; i < b.size(); i += 2) b.setBit(i);
+
+    for (auto _ : state) benchmark::DoNotOptimize(a.intersects(b));
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+BENCHMARK(BM_BitSet_Intersects)->Range(1 << 10, 1 << 20);
+
+static void BM_BitSet_Popcount(benchmark::State& state)
+{
+    const BitSet bits = makeBits(size_t(state.range(0)), 2);
+
+    for (auto _ : state) benchmark::DoNotOptimize(bits.popcount());
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+BENCHMARK(BM_BitSet_Popcount)->Range(1 << 10, 1 << 20);
+
+// Visits the set bits, state.range(1) being the average distance between two of them
+
+static void BM_BitSet_ForEachSet(benchmark::State& state)
+{
+    const BitSet bits = makeBits(size_t(state.range(0)), size_t(state.range(1)));
+
+    for (auto _ : state)
+    {
+        size_t sum = 0;
+        for (size_t i = bits.findFirstSet(); i < bits.size(); i = bits.findFirstSetFrom(i + 1))
+        {
+            sum += i;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_BitSet_ForEachSet)->ArgsProduct({{1 << 12, 1 << 18}, {2, 64, 1024}});
+
+// The search of the pool allocator for contiguous slots
+
+static void BM_BitSet_FindClearRun(benchmark::State& state)
+{
+    const BitSet bits = makeBits(1 << 16, 4);
+
+    for (auto _ : state) benchmark::DoNotOptimize(bits.findClearRun(size_t(state.range(0))));
+}
+
+BENCHMARK(BM_BitSet_FindClearRun)->RangeMultiplier(2)->Range(2, 16);
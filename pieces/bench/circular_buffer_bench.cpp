@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <deque>
+
+#include <pieces/containers/circular_buffer.hpp>
+
+using namespace pieces;
+
+// Full after the first iteration: the pushes overwrite the oldest elements
+
+static void BM_CircularBuffer_Push(benchmark::State& state)
+{
+    CircularBuffer<int, 1024> buffer;
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 512; ++i) buffer.push(i);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * 512);
+}
+
+BENCHMARK(BM_CircularBuffer_Push);
+
+static void BM_CircularBuffer_PushPop(benchmark::State& state)
+{
+    CircularBuffer<int, 1024> buffer;
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 512; ++i) buffer.push(i);
+        for (int i = 0; i < 512; ++i) benchmark::DoNotOptimize(buffer.pop());
+    }
+
+    state.SetItemsProcessed(state.iterations() * 512);
+}
+
+BENCHMARK(BM_CircularBuffer_PushPop);
+
+static void BM_Deque_PushPop(benchmark::State& state)
+{
+    std::deque<int> deque;
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 512; ++i) deque.push_front(i);
+        for (int i = 0; i < 512; ++i)
+        {
+            benchmark::DoNotOptimize(deque.back());
+            deque.pop_back();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 512);
+}
+
+BENCHMARK(BM_Deque_PushPop);
+
+// The history of the profiler graphs: indexed from the most recent element
+
+static void BM_CircularBuffer_Index(benchmark::State& state)
+{
+    CircularBuffer<float, 1024> buffer;
+    for (int i = 0; i < 1500; ++i) buffer.push(float(i));
+
+    for (auto _ : state)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < buffer.size(); ++i) sum += buffer[i];
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+BENCHMARK(BM_CircularBuffer_Index);
@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pieces/containers/constexpr_map.hpp>
+#include <pieces/containers/flat_hash_map.hpp>
+
+using namespace pieces;
+
+// The platform key codes: 349 keys spread with large gaps, mapped to dense indices
+
+static constexpr size_t k_keyCount = 349;
+
+static constexpr std::array<std::pair<uint32_t, uint32_t>, k_keyCount> makeKeyPairs()
+{
+    std::array<std::pair<uint32_t, uint32_t>, k_keyCount> pairs{};
+    for (uint32_t i = 0; i < pairs.size(); ++i) pairs[i] = {i * i * 7 + 32, i};
+    return pairs;
+}
+
+static constexpr auto c_keyPairs = makeKeyPairs();
+static constexpr ConstexprMap<uint32_t, uint32_t, k_keyCount> c_keys(c_keyPairs);
+
+// Hits, with a miss every eighth lookup
+static std::vector<uint32_t> makeLookups()
+{
+    std::vector<uint32_t> lookups;
+    for (uint32_t i = 0; i < 4096; ++i)
+    {
+        const uint32_t index = (i * 2654435761u) % k_keyCount;
+        lookups.push_back(c_keyPairs[index].first + (i % 8 == 0 ? 1 : 0));
+    }
+
+    return lookups;
+}
+
+static void BM_ConstexprMap_Find(benchmark::State& state)
+{
+    const std::vector<uint32_t> lookups = makeLookups();
+
+    for (auto _ : state)
+    {
+        uint32_t sum = 0;
+        for (uint32_t key : lookups)
+        {
+            if (const uint32_t* value = c_keys.find(key)) sum += *value;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(lookups.size()));
+}
+
+BENCHMARK(BM_ConstexprMap_Find);
+
+template <typename Map>
+static void BM_Map_Find(benchmark::State& state)
+{
+    const std::vector<uint32_t> lookups = makeLookups();
+    Map map;
+    for (const auto& [key, value] : c_keyPairs) map.emplace(key, value);
+
+    for (auto _ : state)
+    {
+        uint32_t sum = 0;
+        for (uint32_t key : lookups)
+        {
+            if (const auto it = map.find(key); it != map.end()) sum += it->second;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(lookups.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_Map_Find, FlatHashMap<uint32_t, uint32_t>);
+BENCHMARK_TEMPLATE(BM_Map_Find, std::unordered_map<uint32_t, uint32_t>);
+
+// The fallback of the keys without a hash, and the lookup before the perfect hash
+
+static void BM_LinearSearch_Find(benchmark::State& state)
+{
+    const std::vector<uint32_t> lookups = makeLookups();
+
+    for (auto _ : state)
+    {
+        uint32_t sum = 0;
+        for (uint32_t key : lookups)
+        {
+            const auto it = std::find_if(c_keyPairs.begin(), c_keyPairs.end(),
+                                         [key](const auto& _pair) { return _pair.first == key; });
+            if (it != c_keyPairs.end()) sum += it->second;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(lookups.size()));
+}
+
+BENCHMARK(BM_LinearSearch_Find);
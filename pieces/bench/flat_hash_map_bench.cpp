@@ -0,0 +1,129 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pieces/containers/flat_hash_map.hpp>
+
+using namespace pieces;
+
+// The same keys for both maps: shuffled, so that neither sees them in insertion order
+static std::vector<uint64_t> makeKeys(size_t _count)
+{
+    std::vector<uint64_t> keys(_count);
+    std::mt19937_64 random(7);
+    for (uint64_t& key : keys) key = random();
+
+    return keys;
+}
+
+template <typename Map>
+static void BM_Insert(benchmark::State& state)
+{
+    const std::vector<uint64_t> keys = makeKeys(size_t(state.range(0)));
+
+    for (auto _ : state)
+    {
+        Map map;
+        for (uint64_t key : keys) map[key] = key;
+
+        benchmark::DoNotOptimize(map.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_Insert, FlatHashMap<uint64_t, uint64_t>)->Range(1 << 6, 1 << 18);
+BENCHMARK_TEMPLATE(BM_Insert, std::unordered_map<uint64_t, uint64_t>)->Range(1 << 6, 1 << 18);
+
+template <typename Map>
+static void BM_FindHit(benchmark::State& state)
+{
+    const std::vector<uint64_t> keys = makeKeys(size_t(state.range(0)));
+
+    Map map;
+    for (uint64_t key : keys) map[key] = key;
+
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (uint64_t key : keys) sum += map.find(key)->second;
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_FindHit, FlatHashMap<uint64_t, uint64_t>)->Range(1 << 6, 1 << 18);
+BENCHMARK_TEMPLATE(BM_FindHit, std::unordered_map<uint64_t, uint64_t>)->Range(1 << 6, 1 << 18);
+
+template <typename Map>
+static void BM_FindMiss(benchmark::State& state)
+{
+    const std::vector<uint64_t> keys = makeKeys(size_t(state.range(0)));
+
+    Map map;
+    for (uint64_t key : keys) map[key] = key;
+
+    for (auto _ : state)
+    {
+        size_t found = 0;
+        for (uint64_t key : keys) found += map.count(key + 1);
+
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_FindMiss, FlatHashMap<uint64_t, uint64_t>)->Range(1 << 6, 1 << 18);
+BENCHMARK_TEMPLATE(BM_FindMiss, std::unordered_map<uint64_t, uint64_t>)->Range(1 << 6, 1 << 18);
+
+template <typename Map>
+static void BM_FindString(benchmark::State& state)
+{
+    std::vector<std::string> keys;
+    for (uint64_t key : makeKeys(size_t(state.range(0))))
+    {
+        keys.push_back("action." + std::to_string(key));
+    }
+
+    Map map;
+    for (const std::string& key : keys) map[key] = 1;
+
+    for (auto _ : state)
+    {
+        int sum = 0;
+        for (const std::string& key : keys) sum += map.find(key)->second;
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_FindString, FlatHashMap<std::string, int>)->Range(1 << 4, 1 << 12);
+BENCHMARK_TEMPLATE(BM_FindString, std::unordered_map<std::string, int>)->Range(1 << 4, 1 << 12);
+
+template <typename Map>
+static void BM_Iterate(benchmark::State& state)
+{
+    Map map;
+    for (uint64_t key : makeKeys(size_t(state.range(0)))) map[key] = key;
+
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (const auto& [key, value] : map) sum += value;
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_Iterate, FlatHashMap<uint64_t, uint64_t>)->Range(1 << 6, 1 << 18);
+BENCHMARK_TEMPLATE(BM_Iterate, std::unordered_map<uint64_t, uint64_t>)->Range(1 << 6, 1 << 18);
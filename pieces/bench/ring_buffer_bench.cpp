@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <mutex>
+#include <queue>
+
+#include <pieces/containers/concurrent_ring_buffer.hpp>
+
+using namespace pieces;
+
+// Single-threaded: the cost of the operations themselves, without contention
+
+static void BM_SPSCRingBuffer_PushPop(benchmark::State& state)
+{
+    SPSCRingBuffer<int> buffer(1024);
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 512; ++i) benchmark::DoNotOptimize(buffer.tryPush(i));
+        for (int i = 0; i < 512; ++i) benchmark::DoNotOptimize(buffer.tryPop());
+    }
+
+    state.SetItemsProcessed(state.iterations() * 512);
+}
+
+BENCHMARK(BM_SPSCRingBuffer_PushPop);
+
+static void BM_SPSCRingBuffer_Batch(benchmark::State& state)
+{
+    SPSCRingBuffer<int> buffer(1024);
+    std::array<int, 64> batch = {};
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 8; ++i) buffer.tryPushBatch(batch.begin(), batch.end());
+        for (int i = 0; i < 8; ++i) benchmark::DoNotOptimize(buffer.tryPopBatch(batch));
+    }
+
+    state.SetItemsProcessed(state.iterations() * 512);
+}
+
+BENCHMARK(BM_SPSCRingBuffer_Batch);
+
+static void BM_MPSCRingBuffer_PushPop(benchmark::State& state)
+{
+    MPSCRingBuffer<int> buffer(1024);
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 512; ++i) benchmark::DoNotOptimize(buffer.tryPush(i));
+        for (int i = 0; i < 512; ++i) benchmark::DoNotOptimize(buffer.tryPop());
+    }
+
+    state.SetItemsProcessed(state.iterations() * 512);
+}
+
+BENCHMARK(BM_MPSCRingBuffer_PushPop);
+
+static void BM_MutexQueue_PushPop(benchmark::State& state)
+{
+    std::mutex mutex;
+    std::queue<int> queue;
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 512; ++i)
+        {
+            std::lock_guard lock(mutex);
+            queue.push(i);
+        }
+        for (int i = 0; i < 512; ++i)
+        {
+            std::lock_guard lock(mutex);
+            benchmark::DoNotOptimize(queue.front());
+            queue.pop();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 512);
+}
+
+BENCHMARK(BM_MutexQueue_PushPop);
+
+// Threaded: every thread pushes, thread 0 also drains; a full buffer drops the pushes
+
+static MPSCRingBuffer<int> g_mpscBuffer(4096);
+
+static void BM_MPSCRingBuffer_Contended(benchmark::State& state)
+{
+    int64_t pushed = 0;
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 64; ++i) pushed += g_mpscBuffer.tryPush(i) ? 1 : 0;
+
+        if (state.thread_index() == 0) g_mpscBuffer.consume([](size_t, int) {});
+    }
+
+    state.SetItemsProcessed(pushed);
+}
+
+BENCHMARK(BM_MPSCRingBuffer_Contended)->ThreadRange(1, 8);
@@ -0,0 +1,224 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include <pieces/intrinsics/simd_math.hpp>
+
+using namespace pieces::simd;
+
+namespace
+{
+
+// The scalar reference: a column-major 4x4 matrix of plain floats
+struct ScalarMat4
+{
+    std::array<float, 16> m;
+};
+
+struct ScalarVec4
+{
+    float x, y, z, w;
+};
+
+ScalarMat4 multiply(const ScalarMat4& _a, const ScalarMat4& _b)
+{
+    ScalarMat4 result;
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) sum += _a.m[k * 4 + row] * _b.m[column * 4 + k];
+            result.m[column * 4 + row] = sum;
+        }
+    }
+
+    return result;
+}
+
+ScalarVec4 multiply(const ScalarMat4& _a, const ScalarVec4& _v)
+{
+    const float* m = _a.m.data();
+    return {m[0] * _v.x + m[4] * _v.y + m[8] * _v.z + m[12] * _v.w,
+            m[1] * _v.x + m[5] * _v.y + m[9] * _v.z + m[13] * _v.w,
+            m[2] * _v.x + m[6] * _v.y + m[10] * _v.z + m[14] * _v.w,
+            m[3] * _v.x + m[7] * _v.y + m[11] * _v.z + m[15] * _v.w};
+}
+
+std::vector<float4> makeVectors(size_t _count)
+{
+    std::vector<float4> vectors(_count);
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    for (float4& v : vectors)
+    {
+        v = float4(distribution(random), distribution(random), distribution(random), 1.0f);
+    }
+
+    return vectors;
+}
+
+mat4 makeMatrix()
+{
+    return mat4::fromTranslationRotationScale(float4(1.0f, 2.0f, 3.0f, 1.0f),
+                                              normalize(float4(0.1f, 0.2f, 0.3f, 0.9f)),
+                                              float4(2.0f));
+}
+
+ScalarMat4 toScalar(const mat4& _m)
+{
+    ScalarMat4 result;
+    _m.store(result.m.data());
+    return result;
+}
+
+std::vector<ScalarVec4> toScalar(const std::vector<float4>& _vectors)
+{
+    std::vector<ScalarVec4> result(_vectors.size());
+    for (size_t i = 0; i < _vectors.size(); ++i)
+    {
+        result[i] = {_vectors[i].x(), _vectors[i].y(), _vectors[i].z(), _vectors[i].w()};
+    }
+
+    return result;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Matrix Products
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void BM_MatrixProductScalar(benchmark::State& state)
+{
+    // A chain of products, like a transform hierarchy
+    const ScalarMat4 m = toScalar(makeMatrix());
+    ScalarMat4 world = toScalar(mat4::identity());
+
+    for (auto _ : state)
+    {
+        world = multiply(world, m);
+        benchmark::DoNotOptimize(world);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MatrixProductScalar);
+
+static void BM_MatrixProductSimd(benchmark::State& state)
+{
+    const mat4 m = makeMatrix();
+    mat4 world = mat4::identity();
+
+    for (auto _ : state)
+    {
+        world = world * m;
+        benchmark::DoNotOptimize(world);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MatrixProductSimd);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Vector Transforms
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void BM_TransformScalar(benchmark::State& state)
+{
+    const ScalarMat4 m = toScalar(makeMatrix());
+    const std::vector<ScalarVec4> in = toScalar(makeVectors(size_t(state.range(0))));
+    std::vector<ScalarVec4> out(in.size());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < in.size(); ++i) out[i] = multiply(m, in[i]);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TransformScalar)->Range(1 << 6, 1 << 14);
+
+static void BM_TransformSimd(benchmark::State& state)
+{
+    const mat4 m = makeMatrix();
+    const std::vector<float4> in = makeVectors(size_t(state.range(0)));
+    std::vector<float4> out(in.size());
+
+    for (auto _ : state)
+    {
+        transform(m, in, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TransformSimd)->Range(1 << 6, 1 << 14);
+
+static void BM_TransformBatches(benchmark::State& state)
+{
+    // Already in SoA form, as a system storing x/y/z/w streams would keep them
+    const mat4 m = makeMatrix();
+    const std::vector<float4> vectors = makeVectors(size_t(state.range(0)));
+    std::vector<float4x8> in(vectors.size() / 8);
+    for (size_t i = 0; i < in.size(); ++i) in[i] = float4x8::fromVectors(&vectors[i * 8]);
+    std::vector<float4x8> out(in.size());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < in.size(); ++i) out[i] = m * in[i];
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TransformBatches)->Range(1 << 6, 1 << 14);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dot Products
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void BM_DotScalar(benchmark::State& state)
+{
+    const std::vector<ScalarVec4> a = toScalar(makeVectors(size_t(state.range(0))));
+    const std::vector<ScalarVec4> b = toScalar(makeVectors(size_t(state.range(0)) + 1));
+    std::vector<float> out(a.size());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            out[i] = a[i].x * b[i].x + a[i].y * b[i].y + a[i].z * b[i].z + a[i].w * b[i].w;
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_DotScalar)->Range(1 << 6, 1 << 14);
+
+static void BM_DotSimd(benchmark::State& state)
+{
+    const std::vector<float4> a = makeVectors(size_t(state.range(0)));
+    const std::vector<float4> b = makeVectors(size_t(state.range(0)) + 1);
+    std::vector<float> out(a.size());
+
+    for (auto _ : state)
+    {
+        dot(a, std::span(b).first(a.size()), out);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_DotSimd)->Range(1 << 6, 1 << 14);
@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+
+#include <pieces/containers/spmc_snapshot_buffer.hpp>
+
+using namespace pieces;
+
+// Single-threaded: the cost of a publish and of taking a snapshot, without contention
+
+static void BM_SPMCSnapshotBuffer_Publish(benchmark::State& state)
+{
+    SPMCSnapshotBuffer<int> buffer(size_t(state.range(0)));
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < state.range(0); ++i) buffer.write(i);
+        benchmark::DoNotOptimize(buffer.publish());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SPMCSnapshotBuffer_Publish)->Range(16, 4096);
+
+static void BM_SPMCSnapshotBuffer_GetSnapshot(benchmark::State& state)
+{
+    SPMCSnapshotBuffer<int> buffer;
+    buffer.write(1);
+    buffer.publish();
+
+    for (auto _ : state)
+    {
+        auto snapshot = buffer.getSnapshot();
+        benchmark::DoNotOptimize(snapshot->size());
+    }
+}
+
+BENCHMARK(BM_SPMCSnapshotBuffer_GetSnapshot);
+
+// Threaded: thread 0 writes and publishes, the N - 1 others read the snapshots; the readers hold
+// theirs while summing it, so that the writer meets slots still in use
+
+static SPMCSnapshotBuffer<int> g_snapshotBuffer(256);
+
+static void BM_SPMCSnapshotBuffer_Contended(benchmark::State& state)
+{
+    int64_t items = 0;
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            for (int i = 0; i < 256; ++i) g_snapshotBuffer.write(i);
+            g_snapshotBuffer.publish();
+            items += 256;
+        }
+        else
+        {
+            auto snapshot = g_snapshotBuffer.getSnapshot();
+
+            int sum = 0;
+            for (int value : *snapshot) sum += value;
+            benchmark::DoNotOptimize(sum);
+            items += int64_t(snapshot->size());
+        }
+    }
+
+    state.SetItemsProcessed(items);
+}
+
+BENCHMARK(BM_SPMCSnapshotBuffer_Contended)->ThreadRange(1, 8)->UseRealTime();
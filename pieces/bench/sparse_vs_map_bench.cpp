@@ -1,6 +1,12 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <pieces/containers/sparse_set.hpp>
 
@@ -74,3 +80,277 @@ static void BM_UnorderedMap_Iterate(benchmark::State& state)
 }
 
 BENCHMARK(BM_UnorderedMap_Iterate)->Range(1 << 10, 1 << 20);
+
+// Shuffled keys spread over 4x their count, so that pages are partly filled and accesses random
+static std::vector<uint32_t> makeShuffledKeys(size_t _count, uint32_t _seed = 42)
+{
+    std::vector<uint32_t> keys(_count * 4);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(_seed));
+    keys.resize(_count);
+
+    return keys;
+}
+
+static void BM_SparseSet_InsertBulk(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<int> values(keys.begin(), keys.end());
+
+    for (auto _ : state)
+    {
+        SparseSet<uint32_t, int> set;
+        set.insertBulk(keys, values);
+        benchmark::DoNotOptimize(set.size());
+    }
+}
+
+BENCHMARK(BM_SparseSet_InsertBulk)->Range(1 << 10, 1 << 20);
+
+static void BM_UnorderedSet_InsertBulk(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+
+    for (auto _ : state)
+    {
+        std::unordered_set<uint32_t> set;
+        set.insert(keys.begin(), keys.end());
+        benchmark::DoNotOptimize(set.size());
+    }
+}
+
+BENCHMARK(BM_UnorderedSet_InsertBulk)->Range(1 << 10, 1 << 20);
+
+static void BM_SparseSet_ContainsBulk(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<uint32_t> probes = makeShuffledKeys(state.range(0), 7);
+
+    SparseSet<uint32_t, int> set;
+    set.insertBulk(keys, std::vector<int>(keys.size()));
+    auto results = std::make_unique<bool[]>(probes.size());
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(set.containsBulk(probes, {results.get(), probes.size()}));
+    }
+}
+
+BENCHMARK(BM_SparseSet_ContainsBulk)->Range(1 << 10, 1 << 20);
+
+static void BM_UnorderedSet_ContainsBulk(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<uint32_t> probes = makeShuffledKeys(state.range(0), 7);
+
+    const std::unordered_set<uint32_t> set(keys.begin(), keys.end());
+    auto results = std::make_unique<bool[]>(probes.size());
+
+    for (auto _ : state)
+    {
+        size_t found = 0;
+        for (size_t i = 0; i < probes.size(); ++i)
+        {
+            results[i] = set.contains(probes[i]);
+            found += results[i];
+        }
+
+        benchmark::DoNotOptimize(found);
+    }
+}
+
+BENCHMARK(BM_UnorderedSet_ContainsBulk)->Range(1 << 10, 1 << 20);
+
+static void BM_SparseSet_RemoveBulk(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<int> values(keys.size());
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        SparseSet<uint32_t, int> set;
+        set.insertBulk(keys, values);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(set.removeBulk(keys));
+    }
+}
+
+BENCHMARK(BM_SparseSet_RemoveBulk)->Range(1 << 10, 1 << 18);
+
+static void BM_UnorderedSet_RemoveBulk(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::unordered_set<uint32_t> set(keys.begin(), keys.end());
+        state.ResumeTiming();
+
+        for (uint32_t key : keys) set.erase(key);
+        benchmark::DoNotOptimize(set.size());
+    }
+}
+
+BENCHMARK(BM_UnorderedSet_RemoveBulk)->Range(1 << 10, 1 << 18);
+
+// One key at a time, in a random order: the swap-and-pop of remove()
+
+static void BM_SparseSet_Remove(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<int> values(keys.size());
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        SparseSet<uint32_t, int> set;
+        set.insertBulk(keys, values);
+        state.ResumeTiming();
+
+        for (auto it = keys.rbegin(); it != keys.rend(); ++it) set.remove(*it);
+        benchmark::DoNotOptimize(set.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SparseSet_Remove)->Range(1 << 10, 1 << 18);
+
+static void BM_UnorderedMap_Remove(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::unordered_map<uint32_t, int> map;
+        for (uint32_t key : keys) map.emplace(key, 0);
+        state.ResumeTiming();
+
+        for (auto it = keys.rbegin(); it != keys.rend(); ++it) map.erase(*it);
+        benchmark::DoNotOptimize(map.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_UnorderedMap_Remove)->Range(1 << 10, 1 << 18);
+
+// The keys and the values, after half the keys were removed: the dense arrays stay packed
+
+static void BM_SparseSet_IterateAfterRemove(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<int> values(keys.size(), 1);
+
+    SparseSet<uint32_t, int> set;
+    set.insertBulk(keys, values);
+    for (size_t i = 0; i < keys.size(); i += 2) set.remove(keys[i]);
+
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (const auto& [key, value] : set) sum += key + uint64_t(value);
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(set.size()));
+}
+
+BENCHMARK(BM_SparseSet_IterateAfterRemove)->Range(1 << 10, 1 << 20);
+
+static void BM_UnorderedMap_IterateAfterRemove(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+
+    std::unordered_map<uint32_t, int> map;
+    for (uint32_t key : keys) map.emplace(key, 1);
+    for (size_t i = 0; i < keys.size(); i += 2) map.erase(keys[i]);
+
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (const auto& [key, value] : map) sum += key + uint64_t(value);
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * int64_t(map.size()));
+}
+
+BENCHMARK(BM_UnorderedMap_IterateAfterRemove)->Range(1 << 10, 1 << 20);
+
+static void BM_SparseSet_Intersection(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<uint32_t> otherKeys = makeShuffledKeys(state.range(0) * 4, 7);
+
+    SparseSet<uint32_t, int> set;
+    SparseSet<uint32_t, int> other;
+    set.insertBulk(keys, std::vector<int>(keys.size()));
+    other.insertBulk(otherKeys, std::vector<int>(otherKeys.size()));
+
+    for (auto _ : state) benchmark::DoNotOptimize(set.getIntersection(other).size());
+}
+
+BENCHMARK(BM_SparseSet_Intersection)->Range(1 << 10, 1 << 18);
+
+static void BM_UnorderedSet_Intersection(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<uint32_t> otherKeys = makeShuffledKeys(state.range(0) * 4, 7);
+
+    const std::unordered_set<uint32_t> set(keys.begin(), keys.end());
+    const std::unordered_set<uint32_t> other(otherKeys.begin(), otherKeys.end());
+
+    for (auto _ : state)
+    {
+        std::unordered_set<uint32_t> intersection;
+        for (uint32_t key : set)
+        {
+            if (other.contains(key)) intersection.insert(key);
+        }
+
+        benchmark::DoNotOptimize(intersection.size());
+    }
+}
+
+BENCHMARK(BM_UnorderedSet_Intersection)->Range(1 << 10, 1 << 18);
+
+static void BM_SparseSet_RemoveIf(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+    const std::vector<int> values(keys.begin(), keys.end());
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        SparseSet<uint32_t, int> set;
+        set.insertBulk(keys, values);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(set.removeIf([](uint32_t _key, int) { return _key % 2 == 0; }));
+    }
+}
+
+BENCHMARK(BM_SparseSet_RemoveIf)->Range(1 << 10, 1 << 18);
+
+static void BM_UnorderedSet_RemoveIf(benchmark::State& state)
+{
+    const std::vector<uint32_t> keys = makeShuffledKeys(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::unordered_set<uint32_t> set(keys.begin(), keys.end());
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(std::erase_if(set, [](uint32_t _key) { return _key % 2 == 0; }));
+    }
+}
+
+BENCHMARK(BM_UnorderedSet_RemoveIf)->Range(1 << 10, 1 << 18);
@@ -5,10 +5,203 @@
 #include <cassert>
 #include <stdexcept>
 
+#include <pieces/intrinsics/simd.hpp>
 #include <pieces/memory/contiguous_allocator.hpp>
 
 namespace pieces
 {
+namespace detail
+{
+
+/**
+ * @brief The word operations of the bulk BitSet operations.
+ */
+enum class BitOp : uint8_t
+{
+    and_,
+    or_,
+    xor_,
+    and_not, // a & ~b
+};
+
+template <BitOp Op>
+[[nodiscard]] SIMD_FORCE_INLINE uint64_t applyBitOp(uint64_t _a, uint64_t _b) noexcept
+{
+    if constexpr (Op == BitOp::and_) return _a & _b;
+    else if constexpr (Op == BitOp::or_) return _a | _b;
+    else if constexpr (Op == BitOp::xor_) return _a ^ _b;
+    else return _a & ~_b;
+}
+
+/**
+ * @brief _dst[i] = _a[i] Op _b[i] for _count words, a vector register at a time (AVX-512F, AVX2,
+ * SSE2, NEON) then the words left one by one. The arrays may alias but need no alignment.
+ */
+template <BitOp Op>
+inline void applyWords(uint64_t* _dst, const uint64_t* _a, const uint64_t* _b,
+                       size_t _count) noexcept
+{
+    size_t i = 0;
+
+#if defined(SIMD_X86_AVX512F)
+    for (; i + 8 <= _count; i += 8)
+    {
+        const __m512i a = _mm512_loadu_si512(_a + i);
+        const __m512i b = _mm512_loadu_si512(_b + i);
+
+        __m512i result;
+        if constexpr (Op == BitOp::and_) result = _mm512_and_si512(a, b);
+        else if constexpr (Op == BitOp::or_) result = _mm512_or_si512(a, b);
+        else if constexpr (Op == BitOp::xor_) result = _mm512_xor_si512(a, b);
+        else result = _mm512_andnot_si512(b, a);
+
+        _mm512_storeu_si512(_dst + i, result);
+    }
+#elif defined(SIMD_X86_AVX2)
+    for (; i + 4 <= _count; i += 4)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_a + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_b + i));
+
+        __m256i result;
+        if constexpr (Op == BitOp::and_) result = _mm256_and_si256(a, b);
+        else if constexpr (Op == BitOp::or_) result = _mm256_or_si256(a, b);
+        else if constexpr (Op == BitOp::xor_) result = _mm256_xor_si256(a, b);
+        else result = _mm256_andnot_si256(b, a);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_dst + i), result);
+    }
+#elif defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX)
+    for (; i + 2 <= _count; i += 2)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_a + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_b + i));
+
+        __m128i result;
+        if constexpr (Op == BitOp::and_) result = _mm_and_si128(a, b);
+        else if constexpr (Op == BitOp::or_) result = _mm_or_si128(a, b);
+        else if constexpr (Op == BitOp::xor_) result = _mm_xor_si128(a, b);
+        else result = _mm_andnot_si128(b, a);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + i), result);
+    }
+#elif defined(SIMD_ARM_NEON)
+    for (; i + 2 <= _count; i += 2)
+    {
+        const uint64x2_t a = vld1q_u64(_a + i);
+        const uint64x2_t b = vld1q_u64(_b + i);
+
+        uint64x2_t result;
+        if constexpr (Op == BitOp::and_) result = vandq_u64(a, b);
+        else if constexpr (Op == BitOp::or_) result = vorrq_u64(a, b);
+        else if constexpr (Op == BitOp::xor_) result = veorq_u64(a, b);
+        else result = vbicq_u64(a, b);
+
+        vst1q_u64(_dst + i, result);
+    }
+#endif
+
+    for (; i < _count; ++i) _dst[i] = applyBitOp<Op>(_a[i], _b[i]);
+}
+
+/**
+ * @brief Checks whether some word of _a Op _b is not zero, without storing any: the subset,
+ * intersection and equality tests, a vector register at a time with an early exit.
+ */
+template <BitOp Op>
+[[nodiscard]] inline bool anyWords(const uint64_t* _a, const uint64_t* _b, size_t _count) noexcept
+{
+    size_t i = 0;
+
+#if defined(SIMD_X86_AVX512F)
+    for (; i + 8 <= _count; i += 8)
+    {
+        const __m512i a = _mm512_loadu_si512(_a + i);
+        const __m512i b = _mm512_loadu_si512(_b + i);
+
+        __mmask8 nonZero;
+        if constexpr (Op == BitOp::and_) nonZero = _mm512_test_epi64_mask(a, b);
+        else if constexpr (Op == BitOp::or_) nonZero = _mm512_test_epi64_mask(a, a) |
+                                                       _mm512_test_epi64_mask(b, b);
+        else if constexpr (Op == BitOp::xor_) nonZero = _mm512_cmpneq_epi64_mask(a, b);
+        else nonZero = _mm512_test_epi64_mask(_mm512_andnot_si512(b, a), a);
+
+        if (nonZero != 0) return true;
+    }
+#elif defined(SIMD_X86_AVX2)
+    for (; i + 4 <= _count; i += 4)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_a + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_b + i));
+
+        bool nonZero;
+        if constexpr (Op == BitOp::and_) nonZero = !_mm256_testz_si256(a, b);
+        else if constexpr (Op == BitOp::and_not) nonZero = !_mm256_testc_si256(b, a);
+        else
+        {
+            const __m256i result =
+                Op == BitOp::or_ ? _mm256_or_si256(a, b) : _mm256_xor_si256(a, b);
+            nonZero = !_mm256_testz_si256(result, result);
+        }
+
+        if (nonZero) return true;
+    }
+#elif defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX)
+    for (; i + 2 <= _count; i += 2)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_a + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_b + i));
+
+        bool nonZero;
+        if constexpr (Op == BitOp::and_) nonZero = !_mm_testz_si128(a, b);
+        else if constexpr (Op == BitOp::and_not) nonZero = !_mm_testc_si128(b, a);
+        else
+        {
+            const __m128i result = Op == BitOp::or_ ? _mm_or_si128(a, b) : _mm_xor_si128(a, b);
+            nonZero = !_mm_testz_si128(result, result);
+        }
+
+        if (nonZero) return true;
+    }
+#elif defined(SIMD_X86_SSE2)
+    for (; i + 2 <= _count; i += 2)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_a + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_b + i));
+
+        __m128i result;
+        if constexpr (Op == BitOp::and_) result = _mm_and_si128(a, b);
+        else if constexpr (Op == BitOp::or_) result = _mm_or_si128(a, b);
+        else if constexpr (Op == BitOp::xor_) result = _mm_xor_si128(a, b);
+        else result = _mm_andnot_si128(b, a);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(result, _mm_setzero_si128())) != 0xFFFF) return true;
+    }
+#elif defined(SIMD_ARM_NEON)
+    for (; i + 2 <= _count; i += 2)
+    {
+        const uint64x2_t a = vld1q_u64(_a + i);
+        const uint64x2_t b = vld1q_u64(_b + i);
+
+        uint64x2_t result;
+        if constexpr (Op == BitOp::and_) result = vandq_u64(a, b);
+        else if constexpr (Op == BitOp::or_) result = vorrq_u64(a, b);
+        else if constexpr (Op == BitOp::xor_) result = veorq_u64(a, b);
+        else result = vbicq_u64(a, b);
+
+        if ((vgetq_lane_u64(result, 0) | vgetq_lane_u64(result, 1)) != 0) return true;
+    }
+#endif
+
+    for (; i < _count; ++i)
+    {
+        if (applyBitOp<Op>(_a[i], _b[i]) != 0) return true;
+    }
+
+    return false;
+}
+
+} // namespace detail
 
 /**
  * @brief A BitSet class that provides a dynamic array of bits.
@@ -120,6 +313,34 @@ class BitSet final
         return reinterpret_cast<const Word*>(m_allocator.getBuffer());
     }
 
+    // The bits of the word at _wordIndex that are in the BitSet: all of them but in the last word.
+    [[nodiscard]] inline Word getValidMask(size_t _wordIndex) const noexcept
+    {
+        const size_t tailBits = m_size & WORD_MASK;
+        return _wordIndex + 1 == m_wordCount && tailBits != 0 ? (Word(1) << tailBits) - 1
+                                                              : ~Word(0);
+    }
+
+    // Calls _func(wordIndex, mask) for each word holding some of the _count bits from _start.
+    template <typename Func>
+    inline void forEachWordInRange(size_t _start, size_t _count, Func&& _func) const noexcept
+    {
+        if (_count == 0) return;
+        assert(_start + _count <= m_size && "Range out of bounds");
+
+        const size_t end = _start + _count;
+        const size_t lastWord = (end - 1) >> WORD_SHIFT;
+
+        for (size_t i = _start >> WORD_SHIFT; i <= lastWord; ++i)
+        {
+            Word mask = ~Word(0);
+            if (i == _start >> WORD_SHIFT) mask &= ~Word(0) << (_start & WORD_MASK);
+            if (i == lastWord && (end & WORD_MASK) != 0) mask &= (Word(1) << (end & WORD_MASK)) - 1;
+
+            _func(i, mask);
+        }
+    }
+
    public:
     /**
      * @brief Sets the bit at the specified index to 1 (true).
@@ -286,6 +507,102 @@ class BitSet final
         return m_size;
     }
 
+    /**
+     * @brief Finds the first run of _count clear bits (0s) starting from a given index.
+     *
+     * Word at a time: the clear bits at the bottom of a word extend the run carried from the
+     * previous words, those at the top start the next one, and the runs shorter than a word in
+     * between are found by shifting and ANDing the clear bits (log2(_count) steps).
+     *
+     * @param _count The length of the run.
+     * @param _startIndex The index to start searching from.
+     * @return size_t The index of the first bit of the run, or size() if none is found.
+     */
+    [[nodiscard]] inline size_t findClearRun(size_t _count, size_t _startIndex = 0) const noexcept
+    {
+        if (_count == 0 || _startIndex >= m_size || _count > m_size - _startIndex) return m_size;
+        if (_count == 1) return findFirstClearFrom(_startIndex);
+
+        const Word* words = getWords();
+        const size_t startWord = _startIndex >> WORD_SHIFT;
+
+        // clear bits ending at the last bit of the previous word
+        size_t run = 0;
+
+        for (size_t i = startWord; i < m_wordCount; ++i)
+        {
+            // the bits before the start and the padding count as set
+            Word word = words[i] | ~getValidMask(i);
+            if (i == startWord) word |= (Word(1) << (_startIndex & WORD_MASK)) - 1;
+
+            if (word == 0)
+            {
+                run += BITS_PER_WORD;
+                if (run >= _count) return (i + 1) * BITS_PER_WORD - run;
+                continue;
+            }
+
+            if (run + std::countr_zero(word) >= _count) return i * BITS_PER_WORD - run;
+
+            if (_count < BITS_PER_WORD)
+            {
+                // bit p stays set while p, p + 1, ..., p + width - 1 are all clear
+                Word starts = ~word;
+                size_t width = 1;
+
+                for (; width * 2 <= _count; width *= 2) starts &= starts >> width;
+                if (width < _count) starts &= starts >> (_count - width);
+
+                if (starts != 0) return i * BITS_PER_WORD + std::countr_zero(starts);
+            }
+
+            run = std::countl_zero(word);
+        }
+
+        return m_size;
+    }
+
+    /**
+     * @brief Sets _count bits to 1 (true) from _start, a word at a time.
+     */
+    inline void setRange(size_t _start, size_t _count) noexcept
+    {
+        Word* words = getWords();
+        forEachWordInRange(_start, _count, [words](size_t _i, Word _mask) { words[_i] |= _mask; });
+    }
+
+    /**
+     * @brief Clears _count bits to 0 (false) from _start, a word at a time.
+     */
+    inline void clearRange(size_t _start, size_t _count) noexcept
+    {
+        Word* words = getWords();
+        forEachWordInRange(_start, _count, [words](size_t _i, Word _mask) { words[_i] &= ~_mask; });
+    }
+
+    /**
+     * @brief Counts the set bits (1s) among _count bits from _start.
+     */
+    [[nodiscard]] inline size_t countRange(size_t _start, size_t _count) const noexcept
+    {
+        const Word* words = getWords();
+        size_t count = 0;
+
+        forEachWordInRange(_start, _count, [words, &count](size_t _i, Word _mask)
+                           { count += std::popcount(words[_i] & _mask); });
+
+        return count;
+    }
+
+    /**
+     * @brief Checks whether every bit of the word at _wordIndex is set, the padding excluded.
+     */
+    [[nodiscard]] inline bool isWordFull(size_t _wordIndex) const noexcept
+    {
+        assert(_wordIndex < m_wordCount && "Index out of bounds");
+        return getWords()[_wordIndex] == getValidMask(_wordIndex);
+    }
+
     /**
      * @brief Counts the number of set bits (1s) in the BitSet.
      */
@@ -342,13 +659,7 @@ class BitSet final
     [[nodiscard]] inline bool empty() const noexcept
     {
         const Word* words = getWords();
-
-        for (size_t i = 0; i < m_wordCount; ++i)
-        {
-            if (words[i] != 0) return false;
-        }
-
-        return true;
+        return !detail::anyWords<detail::BitOp::or_>(words, words, m_wordCount);
     }
 
     // Checks if the BitSet is not empty (at least one bit is 1).
@@ -366,19 +677,73 @@ class BitSet final
     // Returns the number of words used to store the bits.
     [[nodiscard]] inline size_t wordCount() const noexcept { return m_wordCount; }
 
-    [[nodiscard]] bool operator==(const BitSet& _other) const noexcept
+    /**
+     * @brief Checks whether every bit set in _other is also set in this BitSet.
+     *
+     * Equivalent to `(*this & _other) == _other` without allocating a temporary.
+     *
+     * @param _other The other BitSet (must have the same size).
+     */
+    [[nodiscard]] inline bool containsAll(const BitSet& _other) const noexcept
     {
-        if (m_size != _other.m_size) return false;
+        assert(m_size == _other.m_size && "BitSet sizes must match");
 
-        Word* words = reinterpret_cast<Word*>(m_allocator.getBuffer());
-        Word* otherWords = reinterpret_cast<Word*>(_other.m_allocator.getBuffer());
+        return !detail::anyWords<detail::BitOp::and_not>(_other.getWords(), getWords(),
+                                                         m_wordCount);
+    }
 
-        for (size_t i = 0; i < m_wordCount; ++i)
-        {
-            if (words[i] != otherWords[i]) return false;
-        }
+    /**
+     * @brief Checks whether every bit set in this BitSet is also set in _other.
+     *
+     * @param _other The other BitSet (must have the same size).
+     */
+    [[nodiscard]] inline bool isSubsetOf(const BitSet& _other) const noexcept
+    {
+        return _other.containsAll(*this);
+    }
+
+    /**
+     * @brief Checks whether at least one bit is set in both BitSets, `(*this & _other).any()`
+     * without allocating a temporary.
+     *
+     * @param _other The other BitSet (must have the same size).
+     */
+    [[nodiscard]] inline bool intersects(const BitSet& _other) const noexcept
+    {
+        assert(m_size == _other.m_size && "BitSet sizes must match");
+
+        return detail::anyWords<detail::BitOp::and_>(getWords(), _other.getWords(), m_wordCount);
+    }
+
+    /**
+     * @brief In-place AND with a BitSet of the same size, nothing allocated nor thrown.
+     */
+    inline BitSet& andWith(const BitSet& _other) noexcept
+    {
+        assert(m_size == _other.m_size && "BitSet sizes must match");
 
-        return true;
+        detail::applyWords<detail::BitOp::and_>(getWords(), getWords(), _other.getWords(),
+                                                m_wordCount);
+        return *this;
+    }
+
+    /**
+     * @brief In-place OR with a BitSet of the same size, nothing allocated nor thrown.
+     */
+    inline BitSet& orWith(const BitSet& _other) noexcept
+    {
+        assert(m_size == _other.m_size && "BitSet sizes must match");
+
+        detail::applyWords<detail::BitOp::or_>(getWords(), getWords(), _other.getWords(),
+                                               m_wordCount);
+        return *this;
+    }
+
+    [[nodiscard]] bool operator==(const BitSet& _other) const noexcept
+    {
+        if (m_size != _other.m_size) return false;
+
+        return !detail::anyWords<detail::BitOp::xor_>(getWords(), _other.getWords(), m_wordCount);
     }
 
     [[nodiscard]] bool operator!=(const BitSet& _other) const noexcept
@@ -400,11 +765,8 @@ class BitSet final
         }
 
         BitSet result(m_size);
-        Word* resultWords = result.getWords();
-        const Word* words = getWords();
-        const Word* otherWords = _other.getWords();
-
-        for (size_t i = 0; i < m_wordCount; ++i) resultWords[i] = words[i] & otherWords[i];
+        detail::applyWords<detail::BitOp::and_>(result.getWords(), getWords(), _other.getWords(),
+                                                m_wordCount);
 
         return result;
     }
@@ -423,11 +785,8 @@ class BitSet final
         }
 
         BitSet result(m_size);
-        Word* resultWords = result.getWords();
-        const Word* words = getWords();
-        const Word* otherWords = _other.getWords();
-
-        for (size_t i = 0; i < m_wordCount; ++i) resultWords[i] = words[i] | otherWords[i];
+        detail::applyWords<detail::BitOp::or_>(result.getWords(), getWords(), _other.getWords(),
+                                               m_wordCount);
 
         return result;
     }
@@ -446,11 +805,8 @@ class BitSet final
         }
 
         BitSet result(m_size);
-        Word* resultWords = result.getWords();
-        const Word* words = getWords();
-        const Word* otherWords = _other.getWords();
-
-        for (size_t i = 0; i < m_wordCount; ++i) resultWords[i] = words[i] ^ otherWords[i];
+        detail::applyWords<detail::BitOp::xor_>(result.getWords(), getWords(), _other.getWords(),
+                                                m_wordCount);
 
         return result;
     }
@@ -468,10 +824,8 @@ class BitSet final
             throw std::invalid_argument("BitSet sizes must match for bitwise operations");
         }
 
-        Word* words = getWords();
-        const Word* otherWords = _other.getWords();
-
-        for (size_t i = 0; i < m_wordCount; ++i) words[i] &= otherWords[i];
+        detail::applyWords<detail::BitOp::and_>(getWords(), getWords(), _other.getWords(),
+                                                m_wordCount);
 
         return *this;
     }
@@ -489,10 +843,8 @@ class BitSet final
             throw std::invalid_argument("BitSet sizes must match for bitwise operations");
         }
 
-        Word* words = getWords();
-        const Word* otherWords = _other.getWords();
-
-        for (size_t i = 0; i < m_wordCount; ++i) words[i] |= otherWords[i];
+        detail::applyWords<detail::BitOp::or_>(getWords(), getWords(), _other.getWords(),
+                                               m_wordCount);
 
         return *this;
     }
@@ -510,10 +862,8 @@ class BitSet final
             throw std::invalid_argument("BitSet sizes must match for bitwise operations");
         }
 
-        Word* words = getWords();
-        const Word* otherWords = _other.getWords();
-
-        for (size_t i = 0; i < m_wordCount; ++i) words[i] ^= otherWords[i];
+        detail::applyWords<detail::BitOp::xor_>(getWords(), getWords(), _other.getWords(),
+                                                m_wordCount);
 
         return *this;
     }
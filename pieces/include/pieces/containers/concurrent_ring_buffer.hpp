@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "pieces/core/result.hpp"
+#include "pieces/core/templates.hpp"
+#include "pieces/internal/error_codes.hpp"
+
+namespace pieces
+{
+namespace detail
+{
+
+// The indices written by different threads live on lines of their own
+inline constexpr size_t k_cacheLineSize = 64;
+
+[[nodiscard]] inline size_t ringCapacity(size_t _capacity)
+{
+    if (_capacity == 0) throw std::invalid_argument("Ring buffer capacity must be greater than 0");
+    if (_capacity > (SIZE_MAX >> 2)) throw std::invalid_argument("Ring buffer capacity too large");
+
+    return std::bit_ceil(_capacity);
+}
+
+} // namespace detail
+
+/**
+ * @brief A bounded, lock-free, single-producer single-consumer ring buffer.
+ *
+ * The producer owns the head index and the consumer the tail one, each on a cache line of its own
+ * along with the copy of the other index it last read: the line of the other side is only loaded
+ * when the copy says the buffer is full (producer) or empty (consumer). Both indices grow without
+ * wrapping, the capacity is rounded up to a power of two. Batches publish their elements with a
+ * single store.
+ *
+ * @tparam T The type of the elements, moved in and out.
+ *
+ * @note Push from one thread and pop from one thread (possibly another one) only.
+ */
+template <typename T>
+    requires std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>
+class SPSCRingBuffer final : public NonCopyable<SPSCRingBuffer<T>>, NonMovable<SPSCRingBuffer<T>>
+{
+   private:
+    struct Slot
+    {
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    // Producer side
+    alignas(detail::k_cacheLineSize) std::atomic<size_t> m_head{0};
+    size_t m_cachedTail = 0;
+
+    // Consumer side
+    alignas(detail::k_cacheLineSize) std::atomic<size_t> m_tail{0};
+    size_t m_cachedHead = 0;
+
+    alignas(detail::k_cacheLineSize) std::unique_ptr<Slot[]> m_slots;
+    size_t m_capacity;
+    size_t m_mask;
+
+   public:
+    /**
+     * @brief Constructs an empty ring buffer of at least _capacity elements.
+     *
+     * @throws std::invalid_argument if _capacity is zero or too large.
+     */
+    explicit SPSCRingBuffer(size_t _capacity)
+        : m_capacity(detail::ringCapacity(_capacity)), m_mask(m_capacity - 1)
+    {
+        m_slots = std::make_unique<Slot[]>(m_capacity);
+    }
+
+    ~SPSCRingBuffer() { clear(); }
+
+   public:
+    /**
+     * @brief Constructs an element at the head of the buffer.
+     *
+     * @return false if the buffer is full, nothing is constructed then.
+     * @note Producer only.
+     */
+    template <typename... Args>
+    [[nodiscard]] bool tryEmplace(Args&&... _args)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == m_capacity)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == m_capacity) return false;
+        }
+
+        ::new (slot(head)) T(std::forward<Args>(_args)...);
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    [[nodiscard]] bool tryPush(const T& _value) { return tryEmplace(_value); }
+    [[nodiscard]] bool tryPush(T&& _value) { return tryEmplace(std::move(_value)); }
+
+    /**
+     * @brief Pushes the elements of [_first, _last) the buffer has room for, in order.
+     *
+     * @return The number of elements pushed, from _first on.
+     * @note Producer only. Pass move iterators to move the elements in.
+     */
+    template <std::input_iterator It, std::sized_sentinel_for<It> Sentinel>
+    size_t tryPushBatch(It _first, Sentinel _last)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const auto wanted = static_cast<size_t>(_last - _first);
+
+        if (m_capacity - (head - m_cachedTail) < wanted)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+
+        const size_t count = std::min(wanted, m_capacity - (head - m_cachedTail));
+        for (size_t i = 0; i < count; ++i, ++_first) ::new (slot(head + i)) T(*_first);
+
+        if (count != 0) m_head.store(head + count, std::memory_order_release);
+
+        return count;
+    }
+
+    /**
+     * @brief Removes the oldest element and returns it.
+     *
+     * @return Result containing the popped value, or ErrorCode::container_empty.
+     * @note Consumer only.
+     */
+    [[nodiscard]] Result<T, ErrorCode> tryPop()
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) return Err<T, ErrorCode>(ErrorCode::container_empty);
+        }
+
+        T* element = slot(tail);
+        T out = std::move(*element);
+        element->~T();
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return Ok<T, ErrorCode>(std::move(out));
+    }
+
+    /**
+     * @brief Moves the oldest elements into _out, as many as it holds and are available.
+     *
+     * @return The number of elements popped into the front of _out.
+     * @note Consumer only.
+     */
+    size_t tryPopBatch(std::span<T> _out)
+    {
+        return consume([&_out](size_t _i, T& _element) { _out[_i] = std::move(_element); },
+                       _out.size());
+    }
+
+    /**
+     * @brief Calls _func(index, element) on up to _maxCount of the oldest elements in place, then
+     * removes them, with a single store for the whole batch.
+     *
+     * @return The number of elements consumed.
+     * @note Consumer only. _func must not throw.
+     */
+    template <typename Func>
+    size_t consume(Func&& _func, size_t _maxCount = SIZE_MAX)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_cachedHead - tail < std::min(_maxCount, m_capacity))
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+        }
+
+        const size_t count = std::min(_maxCount, m_cachedHead - tail);
+        for (size_t i = 0; i < count; ++i)
+        {
+            T* element = slot(tail + i);
+            _func(i, *element);
+            element->~T();
+        }
+
+        if (count != 0) m_tail.store(tail + count, std::memory_order_release);
+
+        return count;
+    }
+
+    /**
+     * @brief Destroys the elements left.
+     *
+     * @note Consumer only, or with no producer running.
+     */
+    void clear()
+    {
+        consume([](size_t, T&) {});
+    }
+
+    // Approximate while the other side runs
+    [[nodiscard]] size_t size() const noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        return m_head.load(std::memory_order_acquire) - tail;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
+
+   private:
+    [[nodiscard]] T* slot(size_t _index) const noexcept
+    {
+        return std::launder(reinterpret_cast<T*>(m_slots[_index & m_mask].storage));
+    }
+};
+
+/**
+ * @brief A bounded, lock-free, multiple-producer single-consumer ring buffer.
+ *
+ * Producers claim slots by moving the shared head forward with a compare-exchange (a batch claims
+ * all its slots at once), construct their elements, then mark each slot with the sequence number
+ * of its lap. The consumer pops the slots in order as their marks appear, a producer still writing
+ * holds back the slots after its own, and frees a whole batch with a single store of the tail.
+ * Pushes are lock-free, pops wait-free.
+ *
+ * @tparam T The type of the elements, moved in and out.
+ *
+ * @note Push from any thread, pop from one thread at a time only.
+ */
+template <typename T>
+    requires std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>
+class MPSCRingBuffer final : public NonCopyable<MPSCRingBuffer<T>>, NonMovable<MPSCRingBuffer<T>>
+{
+   private:
+    struct Slot
+    {
+        // index + 1 once the element of that index is constructed
+        std::atomic<size_t> sequence{0};
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    alignas(detail::k_cacheLineSize) std::atomic<size_t> m_head{0};
+
+    // Consumer side
+    alignas(detail::k_cacheLineSize) std::atomic<size_t> m_tail{0};
+
+    alignas(detail::k_cacheLineSize) std::unique_ptr<Slot[]> m_slots;
+    size_t m_capacity;
+    size_t m_mask;
+
+   public:
+    /**
+     * @brief Constructs an empty ring buffer of at least _capacity elements.
+     *
+     * @throws std::invalid_argument if _capacity is zero or too large.
+     */
+    explicit MPSCRingBuffer(size_t _capacity)
+        : m_capacity(detail::ringCapacity(_capacity)), m_mask(m_capacity - 1)
+    {
+        m_slots = std::make_unique<Slot[]>(m_capacity);
+    }
+
+    ~MPSCRingBuffer() { clear(); }
+
+   public:
+    /**
+     * @brief Constructs an element at the head of the buffer.
+     *
+     * @return false if the buffer is full, nothing is constructed then.
+     */
+    template <typename... Args>
+    [[nodiscard]] bool tryEmplace(Args&&... _args)
+    {
+        size_t head;
+        if (claim(1, head) == 0) return false;
+
+        Slot& claimed = m_slots[head & m_mask];
+        ::new (element(claimed)) T(std::forward<Args>(_args)...);
+        claimed.sequence.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    [[nodiscard]] bool tryPush(const T& _value) { return tryEmplace(_value); }
+    [[nodiscard]] bool tryPush(T&& _value) { return tryEmplace(std::move(_value)); }
+
+    /**
+     * @brief Pushes the elements of [_first, _last) the buffer has room for, contiguous and in
+     * order in the buffer.
+     *
+     * @return The number of elements pushed, from _first on.
+     * @note Pass move iterators to move the elements in.
+     */
+    template <std::input_iterator It, std::sized_sentinel_for<It> Sentinel>
+    size_t tryPushBatch(It _first, Sentinel _last)
+    {
+        size_t head;
+        const size_t count = claim(static_cast<size_t>(_last - _first), head);
+
+        for (size_t i = 0; i < count; ++i, ++_first)
+        {
+            Slot& claimed = m_slots[(head + i) & m_mask];
+            ::new (element(claimed)) T(*_first);
+            claimed.sequence.store(head + i + 1, std::memory_order_release);
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Removes the oldest element and returns it.
+     *
+     * @return Result containing the popped value, or ErrorCode::container_empty if the buffer is
+     * empty or the oldest element is still being written.
+     * @note Consumer only.
+     */
+    [[nodiscard]] Result<T, ErrorCode> tryPop()
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        Slot& oldest = m_slots[tail & m_mask];
+        if (oldest.sequence.load(std::memory_order_acquire) != tail + 1)
+        {
+            return Err<T, ErrorCode>(ErrorCode::container_empty);
+        }
+
+        T* value = element(oldest);
+        T out = std::move(*value);
+        value->~T();
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return Ok<T, ErrorCode>(std::move(out));
+    }
+
+    /**
+     * @brief Moves the oldest elements into _out, as many as it holds and are available.
+     *
+     * @return The number of elements popped into the front of _out.
+     * @note Consumer only.
+     */
+    size_t tryPopBatch(std::span<T> _out)
+    {
+        return consume([&_out](size_t _i, T& _element) { _out[_i] = std::move(_element); },
+                       _out.size());
+    }
+
+    /**
+     * @brief Calls _func(index, element) on up to _maxCount of the oldest elements in place, then
+     * removes them, with a single store for the whole batch.
+     *
+     * @return The number of elements consumed, stopping at the first one still being written.
+     * @note Consumer only. _func must not throw.
+     */
+    template <typename Func>
+    size_t consume(Func&& _func, size_t _maxCount = SIZE_MAX)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        size_t count = 0;
+        for (; count < std::min(_maxCount, m_capacity); ++count)
+        {
+            Slot& oldest = m_slots[(tail + count) & m_mask];
+            if (oldest.sequence.load(std::memory_order_acquire) != tail + count + 1) break;
+
+            T* value = element(oldest);
+            _func(count, *value);
+            value->~T();
+        }
+
+        if (count != 0) m_tail.store(tail + count, std::memory_order_release);
+
+        return count;
+    }
+
+    /**
+     * @brief Destroys the elements left.
+     *
+     * @note With no producer running.
+     */
+    void clear()
+    {
+        consume([](size_t, T&) {});
+    }
+
+    // Approximate while producers run, claimed elements not written yet included
+    [[nodiscard]] size_t size() const noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        return m_head.load(std::memory_order_acquire) - tail;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
+
+   private:
+    [[nodiscard]] static T* element(Slot& _slot) noexcept
+    {
+        return std::launder(reinterpret_cast<T*>(_slot.storage));
+    }
+
+    /**
+     * @brief Moves the head forward by up to _count slots, as many as are free.
+     *
+     * @return The number of slots claimed, from _head on.
+     */
+    size_t claim(size_t _count, size_t& _head) noexcept
+    {
+        if (_count == 0) return 0;
+
+        _head = m_head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            // The slots behind the tail were released by the consumer
+            const size_t tail = m_tail.load(std::memory_order_acquire);
+            const size_t count = std::min(_count, m_capacity - (_head - tail));
+            if (count == 0) return 0;
+
+            if (m_head.compare_exchange_weak(_head, _head + count, std::memory_order_relaxed,
+                                             std::memory_order_relaxed))
+            {
+                return count;
+            }
+        }
+    }
+};
+
+} // namespace pieces
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <utility>
-#include <type_traits>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
 #include "pieces/internal/error_codes.hpp"
 #include "pieces/core/result.hpp"
@@ -11,52 +17,258 @@
 namespace pieces
 {
 
+/**
+ * @brief The default hash of ConstexprMap, defined for integers, enums and strings.
+ *
+ * Keys of other types fall back to a linear search.
+ */
+struct ConstexprHash
+{
+    template <typename K>
+        requires std::is_integral_v<K> || std::is_enum_v<K>
+    constexpr uint64_t operator()(K _key) const noexcept
+    {
+        if constexpr (std::is_enum_v<K>)
+        {
+            return uint64_t(std::to_underlying(_key));
+        }
+        else
+        {
+            return uint64_t(_key);
+        }
+    }
+
+    template <typename K>
+        requires std::is_convertible_v<const K&, std::string_view>
+    constexpr uint64_t operator()(const K& _key) const noexcept
+    {
+        // FNV-1a
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (const char c : std::string_view(_key))
+        {
+            hash = (hash ^ uint8_t(c)) * 0x100000001B3ull;
+        }
+
+        return hash;
+    }
+};
+
+namespace detail
+{
+
+constexpr uint64_t mixConstexprHash(uint64_t _hash) noexcept
+{
+    // splitmix64 finalizer
+    _hash = (_hash ^ (_hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    _hash = (_hash ^ (_hash >> 27)) * 0x94D049BB133111EBull;
+    return _hash ^ (_hash >> 31);
+}
+
+template <size_t Size>
+using ConstexprMapIndex = std::conditional_t<(Size < std::numeric_limits<uint16_t>::max()),
+                                             uint16_t, uint32_t>;
+
+} // namespace detail
+
 /**
  * @brief A constexpr map for small fixed-size key-value pairs.
  *
+ * The constructor builds a perfect hash of the keys (hash and displace): the keys are spread over
+ * buckets, and each bucket gets the seed that sends all its keys to free slots. A lookup hashes
+ * the key once, reads the seed of its bucket and the slot it points to, and compares a single key.
+ * Keys the hash does not support are searched linearly.
+ *
  * NOTE: There is no guarantee that the map will be evaluated at compile time. You should use it in
- * a context where compile-time evaluation is possible.
+ * a context where compile-time evaluation is possible, building the hash at runtime is quadratic.
  *
  * @tparam K The type of the key.
  * @tparam V The type of the value.
  * @tparam Size The number of key-value pairs in the map.
+ * @tparam Hash The hash of the keys, returning 64 bits.
  */
-template <typename K, typename V, size_t Size>
+template <typename K, typename V, size_t Size, typename Hash = ConstexprHash>
 class ConstexprMap final
 {
    private:
     using Pair = std::pair<K, V>;
+    using Index = detail::ConstexprMapIndex<Size>;
+
+    static constexpr bool k_hashed = requires(const Hash& _hash, const K& _key) {
+        { _hash(_key) } -> std::convertible_to<uint64_t>;
+    };
+
+    // About 4 keys per bucket, slots at most 4/5 full
+    static constexpr size_t k_bucketCount = k_hashed ? std::max<size_t>(1, (Size + 3) / 4) : 0;
+    static constexpr size_t k_slotCount = k_hashed ? std::bit_ceil(Size + Size / 4 + 1) : 0;
+    static constexpr Index k_emptySlot = Index(Size);
+
     std::array<Pair, Size> data;
+    std::array<uint32_t, k_bucketCount> m_seeds{};
+    std::array<Index, k_slotCount> m_slots{};
 
    public:
-    explicit constexpr ConstexprMap(const std::array<Pair, Size>& arr) : data(arr) {}
+    /**
+     * @throws std::invalid_argument if a key appears twice (a compile error when constant
+     * evaluated).
+     */
+    explicit constexpr ConstexprMap(const std::array<Pair, Size>& arr) : data(arr)
+    {
+        if constexpr (k_hashed)
+        {
+            buildPerfectHash();
+        }
+        else
+        {
+            for (size_t i = 0; i < Size; ++i)
+            {
+                for (size_t j = i + 1; j < Size; ++j)
+                {
+                    if (data[i].first == data[j].first)
+                    {
+                        throw std::invalid_argument("ConstexprMap: duplicate key");
+                    }
+                }
+            }
+        }
+    }
 
    public:
     /**
      * @brief Returns a reference to the value associated with the given key.
      *
      * @param key The key to look up.
-     * @return constexpr const RefResult<V, ErrorCode>
+     * @return Result<V, ErrorCode> (not const, so that it can be unwrapped)
      *
      * @see ErrorCode for possible error codes.
      */
-    constexpr const Result<V, ErrorCode> at(const K& key) const
+    Result<V, ErrorCode> at(const K& key) const
     {
-        const auto it = std::find_if(data.begin(), data.end(),
-                                     [&key](const Pair& pair) { return pair.first == key; });
+        if (const V* value = find(key))
+        {
+            return Result<V, ErrorCode>::Ok(*value);
+        }
+        else
+        {
+            return Result<V, ErrorCode>::Err(ErrorCode::key_not_found);
+        }
+    }
 
-        if (it != data.end())
+    /**
+     * @brief Returns the value associated with the given key, or nullptr, usable in constant
+     * expressions (unlike Result).
+     */
+    [[nodiscard]] constexpr const V* find(const K& key) const
+    {
+        if constexpr (k_hashed)
         {
-            return Ok(it->second);
+            const uint64_t hash = detail::mixConstexprHash(uint64_t(Hash{}(key)));
+            const Index index = m_slots[slotOf(hash, m_seeds[bucketOf(hash)])];
+
+            if (index != k_emptySlot && data[index].first == key) return &data[index].second;
         }
         else
         {
-            return Err(ErrorCode::key_not_found);
+            for (const Pair& pair : data)
+            {
+                if (pair.first == key) return &pair.second;
+            }
         }
+
+        return nullptr;
     }
 
+    [[nodiscard]] constexpr bool contains(const K& key) const { return find(key) != nullptr; }
+
     /// Returns the number of key-value pairs in the map.
     static constexpr size_t size() { return Size; }
+
+   private:
+    static constexpr size_t bucketOf(uint64_t _hash) noexcept
+    {
+        return size_t((_hash >> 32) % k_bucketCount);
+    }
+
+    static constexpr size_t slotOf(uint64_t _hash, uint32_t _seed) noexcept
+    {
+        return size_t(detail::mixConstexprHash(_hash ^ (_seed * 0x9E3779B97F4A7C15ull)) &
+                      (k_slotCount - 1));
+    }
+
+    constexpr void buildPerfectHash()
+    {
+        std::array<uint64_t, Size> hashes{};
+        std::array<size_t, k_bucketCount> bucketSizes{};
+        for (size_t i = 0; i < Size; ++i)
+        {
+            hashes[i] = detail::mixConstexprHash(uint64_t(Hash{}(data[i].first)));
+            ++bucketSizes[bucketOf(hashes[i])];
+
+            // Two keys of the same hash could never be told apart
+            for (size_t j = 0; j < i; ++j)
+            {
+                if (hashes[j] != hashes[i]) continue;
+
+                throw std::invalid_argument(data[j].first == data[i].first
+                                                ? "ConstexprMap: duplicate key"
+                                                : "ConstexprMap: keys of the same hash");
+            }
+        }
+
+        // The largest buckets first, while most of the slots are free
+        std::array<Index, Size> order{};
+        for (size_t i = 0; i < Size; ++i) order[i] = Index(i);
+        std::sort(order.begin(), order.end(),
+                  [&](Index _lhs, Index _rhs)
+                  {
+                      const size_t lhsBucket = bucketOf(hashes[_lhs]);
+                      const size_t rhsBucket = bucketOf(hashes[_rhs]);
+                      if (bucketSizes[lhsBucket] != bucketSizes[rhsBucket])
+                      {
+                          return bucketSizes[lhsBucket] > bucketSizes[rhsBucket];
+                      }
+
+                      return lhsBucket < rhsBucket;
+                  });
+
+        m_slots.fill(k_emptySlot);
+
+        for (size_t first = 0; first < Size;)
+        {
+            const size_t bucket = bucketOf(hashes[order[first]]);
+            const size_t last = first + bucketSizes[bucket];
+
+            for (uint32_t seed = 0;; ++seed)
+            {
+                if (seed == std::numeric_limits<uint32_t>::max())
+                {
+                    throw std::invalid_argument("ConstexprMap: no perfect hash found");
+                }
+
+                size_t placed = first;
+                for (; placed < last; ++placed)
+                {
+                    Index& slot = m_slots[slotOf(hashes[order[placed]], seed)];
+                    if (slot != k_emptySlot) break;
+
+                    slot = order[placed];
+                }
+
+                if (placed == last)
+                {
+                    m_seeds[bucket] = seed;
+                    break;
+                }
+
+                // Undo the keys this seed placed
+                for (size_t i = first; i < placed; ++i)
+                {
+                    m_slots[slotOf(hashes[order[i]], seed)] = k_emptySlot;
+                }
+            }
+
+            first = last;
+        }
+    }
 };
 
 } // namespace pieces
@@ -0,0 +1,935 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <pieces/intrinsics/simd.hpp>
+
+namespace pieces
+{
+namespace detail
+{
+
+// One control byte per slot: empty, deleted, or the 7 low bits of the hash of a full slot
+using FlatCtrl = int8_t;
+
+inline constexpr FlatCtrl k_flatEmpty = -128; // 0b10000000
+inline constexpr FlatCtrl k_flatDeleted = -2; // 0b11111110
+
+inline constexpr size_t k_flatGroupWidth = 16;
+
+// The control bytes of a table without slots: a single empty group, never written
+alignas(k_flatGroupWidth) inline constexpr FlatCtrl k_flatEmptyGroup[k_flatGroupWidth] = {
+    k_flatEmpty, k_flatEmpty, k_flatEmpty, k_flatEmpty, k_flatEmpty, k_flatEmpty,
+    k_flatEmpty, k_flatEmpty, k_flatEmpty, k_flatEmpty, k_flatEmpty, k_flatEmpty,
+    k_flatEmpty, k_flatEmpty, k_flatEmpty, k_flatEmpty};
+
+#if !defined(SIMD_X86_SSE2) && !defined(SIMD_X86_SSE4_1) && !defined(SIMD_X86_AVX) && \
+    !defined(SIMD_X86_AVX2) && !defined(SIMD_X86_AVX512F) && !defined(SIMD_ARM_NEON)
+
+// Bit 7 of each byte of an 8-byte half group, gathered into the low 8 bits
+[[nodiscard]] SIMD_FORCE_INLINE uint32_t packFlatMask(uint64_t _bytes) noexcept
+{
+    return uint32_t((((_bytes >> 7) & 0x0101'0101'0101'0101ull) * 0x0102'0408'1020'4080ull) >> 56);
+}
+
+[[nodiscard]] SIMD_FORCE_INLINE uint64_t loadFlatHalf(const FlatCtrl* _ctrl) noexcept
+{
+    uint64_t bytes;
+    std::memcpy(&bytes, _ctrl, sizeof(bytes));
+
+    if constexpr (std::endian::native == std::endian::big) bytes = std::byteswap(bytes);
+    return bytes;
+}
+
+#endif
+
+/**
+ * @brief The 16 control bytes probed at once, each match a mask of one bit per slot.
+ */
+struct FlatGroup
+{
+#if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
+    defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+
+    __m128i ctrl;
+
+    explicit FlatGroup(const FlatCtrl* _ctrl) noexcept
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_ctrl)))
+    {
+    }
+
+    [[nodiscard]] uint32_t match(FlatCtrl _h2) const noexcept
+    {
+        return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(_h2))));
+    }
+
+    [[nodiscard]] uint32_t matchEmpty() const noexcept { return match(k_flatEmpty); }
+
+    // Empty and deleted are the only negative bytes
+    [[nodiscard]] uint32_t matchEmptyOrDeleted() const noexcept
+    {
+        return uint32_t(_mm_movemask_epi8(ctrl));
+    }
+
+#elif defined(SIMD_ARM_NEON)
+
+    int8x16_t ctrl;
+
+    explicit FlatGroup(const FlatCtrl* _ctrl) noexcept : ctrl(vld1q_s8(_ctrl)) {}
+
+    [[nodiscard]] static uint32_t toMask(uint8x16_t _bytes) noexcept
+    {
+        static constexpr uint8_t k_weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                                  1, 2, 4, 8, 16, 32, 64, 128};
+
+        const uint8x16_t bits = vandq_u8(_bytes, vld1q_u8(k_weights));
+        return uint32_t(vaddv_u8(vget_low_u8(bits))) |
+               (uint32_t(vaddv_u8(vget_high_u8(bits))) << 8);
+    }
+
+    [[nodiscard]] uint32_t match(FlatCtrl _h2) const noexcept
+    {
+        return toMask(vceqq_s8(ctrl, vdupq_n_s8(_h2)));
+    }
+
+    [[nodiscard]] uint32_t matchEmpty() const noexcept { return match(k_flatEmpty); }
+
+    [[nodiscard]] uint32_t matchEmptyOrDeleted() const noexcept
+    {
+        return toMask(vcltzq_s8(ctrl));
+    }
+
+#else
+
+    uint64_t low;
+    uint64_t high;
+
+    explicit FlatGroup(const FlatCtrl* _ctrl) noexcept
+        : low(loadFlatHalf(_ctrl)), high(loadFlatHalf(_ctrl + 8))
+    {
+    }
+
+    // May report a byte right after a match too: the keys are compared anyway
+    [[nodiscard]] uint32_t match(FlatCtrl _h2) const noexcept
+    {
+        static constexpr uint64_t k_lsbs = 0x0101'0101'0101'0101ull;
+        static constexpr uint64_t k_msbs = 0x8080'8080'8080'8080ull;
+
+        const uint64_t pattern = k_lsbs * uint8_t(_h2);
+        const uint64_t lowBytes = low ^ pattern;
+        const uint64_t highBytes = high ^ pattern;
+
+        return packFlatMask((lowBytes - k_lsbs) & ~lowBytes & k_msbs) |
+               (packFlatMask((highBytes - k_lsbs) & ~highBytes & k_msbs) << 8);
+    }
+
+    // Only empty has bit 7 set and bit 1 clear
+    [[nodiscard]] uint32_t matchEmpty() const noexcept
+    {
+        return packFlatMask(low & ~(low << 6)) | (packFlatMask(high & ~(high << 6)) << 8);
+    }
+
+    [[nodiscard]] uint32_t matchEmptyOrDeleted() const noexcept
+    {
+        return packFlatMask(low) | (packFlatMask(high) << 8);
+    }
+
+#endif
+
+    [[nodiscard]] uint32_t matchFull() const noexcept { return ~matchEmptyOrDeleted() & 0xFFFFu; }
+};
+
+// std::hash of integers is the identity: mixed, so that both the group and the 7 bits kept in the
+// control byte depend on all the bits of the key
+[[nodiscard]] SIMD_FORCE_INLINE uint64_t mixFlatHash(uint64_t _hash) noexcept
+{
+    _hash *= 0x9E37'79B9'7F4A'7C15ull;
+    return _hash ^ (_hash >> 32);
+}
+
+template <typename T>
+concept TransparentFunctor = requires { typename T::is_transparent; };
+
+/**
+ * @brief The open-addressing table under FlatHashMap and FlatHashSet.
+ *
+ * Slots are grouped 16 at a time with their control bytes; a lookup hashes the key once, picks a
+ * group from the high bits and compares the 7 low bits against the 16 control bytes of the group
+ * in one vector compare (SSE2, NEON, or 64-bit words elsewhere), then compares the keys of the
+ * candidates only. The groups are probed quadratically until one with an empty slot. Erasing
+ * leaves a tombstone unless the group has an empty slot, which no probe went past; the table
+ * grows past 7/8 of load and rehashes in place when tombstones made up most of it.
+ *
+ * @tparam Slot The value stored, KeyOf gives its key.
+ */
+template <typename Key, typename Slot, typename KeyOf, typename Hash, typename KeyEqual>
+class FlatHashTable
+{
+   public:
+    using key_type = Key;
+    using value_type = Slot;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+    template <bool Const>
+    class Iterator
+    {
+       private:
+        friend class FlatHashTable;
+        template <bool>
+        friend class Iterator;
+
+        using SlotPointer = std::conditional_t<Const, const Slot*, Slot*>;
+
+        const FlatCtrl* m_ctrl = nullptr;
+        const FlatCtrl* m_end = nullptr;
+        SlotPointer m_slot = nullptr;
+
+        Iterator(const FlatCtrl* _ctrl, const FlatCtrl* _end, SlotPointer _slot) noexcept
+            : m_ctrl(_ctrl), m_end(_end), m_slot(_slot)
+        {
+        }
+
+        void skipFree() noexcept
+        {
+            while (m_ctrl != m_end && *m_ctrl < 0)
+            {
+                ++m_ctrl;
+                ++m_slot;
+            }
+        }
+
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Slot;
+        using difference_type = ptrdiff_t;
+        using pointer = SlotPointer;
+        using reference = std::conditional_t<Const, const Slot&, Slot&>;
+
+        Iterator() noexcept = default;
+
+        // iterator to const_iterator
+        template <bool OtherConst>
+            requires(Const && !OtherConst)
+        Iterator(const Iterator<OtherConst>& _other) noexcept
+            : m_ctrl(_other.m_ctrl), m_end(_other.m_end), m_slot(_other.m_slot)
+        {
+        }
+
+        reference operator*() const noexcept { return *m_slot; }
+        pointer operator->() const noexcept { return m_slot; }
+
+        Iterator& operator++() noexcept
+        {
+            ++m_ctrl;
+            ++m_slot;
+            skipFree();
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept
+        {
+            Iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        template <bool OtherConst>
+        bool operator==(const Iterator<OtherConst>& _other) const noexcept
+        {
+            return m_ctrl == _other.m_ctrl;
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+   private:
+    static constexpr size_t k_slotAlignment = std::max(alignof(Slot), k_flatGroupWidth);
+
+    // One allocation: the slots, then one control byte per slot
+    Slot* m_slots = nullptr;
+    FlatCtrl* m_ctrl = const_cast<FlatCtrl*>(k_flatEmptyGroup);
+    size_t m_capacity = 0;   // slots, a power of two from 16 on, or 0
+    size_t m_groupMask = 0;  // groups - 1
+    size_t m_size = 0;
+    size_t m_growthLeft = 0; // empty slots that may still be filled before a rehash
+
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] KeyEqual m_equal;
+
+   public:
+    FlatHashTable() = default;
+
+    explicit FlatHashTable(size_t _count, const Hash& _hash = Hash(),
+                           const KeyEqual& _equal = KeyEqual())
+        : m_hash(_hash), m_equal(_equal)
+    {
+        reserve(_count);
+    }
+
+    FlatHashTable(const FlatHashTable& _other) : m_hash(_other.m_hash), m_equal(_other.m_equal)
+    {
+        reserve(_other.m_size);
+        for (const Slot& slot : _other) insertUnique(hashOf(KeyOf::get(slot)), slot);
+    }
+
+    FlatHashTable(FlatHashTable&& _other) noexcept
+        : m_slots(std::exchange(_other.m_slots, nullptr)),
+          m_ctrl(std::exchange(_other.m_ctrl, const_cast<FlatCtrl*>(k_flatEmptyGroup))),
+          m_capacity(std::exchange(_other.m_capacity, 0)),
+          m_groupMask(std::exchange(_other.m_groupMask, 0)),
+          m_size(std::exchange(_other.m_size, 0)),
+          m_growthLeft(std::exchange(_other.m_growthLeft, 0)),
+          m_hash(_other.m_hash),
+          m_equal(_other.m_equal)
+    {
+    }
+
+    FlatHashTable& operator=(const FlatHashTable& _other)
+    {
+        if (this != &_other)
+        {
+            FlatHashTable copy(_other);
+            swap(copy);
+        }
+
+        return *this;
+    }
+
+    FlatHashTable& operator=(FlatHashTable&& _other) noexcept
+    {
+        if (this != &_other)
+        {
+            FlatHashTable moved(std::move(_other));
+            swap(moved);
+        }
+
+        return *this;
+    }
+
+    ~FlatHashTable() { release(); }
+
+   public:
+    [[nodiscard]] iterator begin() noexcept
+    {
+        iterator it(m_ctrl, m_ctrl + m_capacity, m_slots);
+        it.skipFree();
+        return it;
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept
+    {
+        const_iterator it(m_ctrl, m_ctrl + m_capacity, m_slots);
+        it.skipFree();
+        return it;
+    }
+
+    [[nodiscard]] iterator end() noexcept
+    {
+        return iterator(m_ctrl + m_capacity, m_ctrl + m_capacity, m_slots + m_capacity);
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept
+    {
+        return const_iterator(m_ctrl + m_capacity, m_ctrl + m_capacity, m_slots + m_capacity);
+    }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+    [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
+
+    [[nodiscard]] float load_factor() const noexcept
+    {
+        return m_capacity == 0 ? 0.0f : float(m_size) / float(m_capacity);
+    }
+
+    [[nodiscard]] hasher hash_function() const { return m_hash; }
+    [[nodiscard]] key_equal key_eq() const { return m_equal; }
+
+    /**
+     * @brief Destroys the elements, the capacity is kept.
+     */
+    void clear() noexcept
+    {
+        destroySlots();
+        if (m_capacity != 0) std::memset(m_ctrl, k_flatEmpty, m_capacity);
+
+        m_size = 0;
+        m_growthLeft = maxLoad(m_capacity);
+    }
+
+    /**
+     * @brief Makes room for _count elements without rehashing.
+     */
+    void reserve(size_t _count)
+    {
+        if (_count > maxLoad(m_capacity)) rehash(capacityFor(_count));
+    }
+
+    void swap(FlatHashTable& _other) noexcept
+    {
+        std::swap(m_slots, _other.m_slots);
+        std::swap(m_ctrl, _other.m_ctrl);
+        std::swap(m_capacity, _other.m_capacity);
+        std::swap(m_groupMask, _other.m_groupMask);
+        std::swap(m_size, _other.m_size);
+        std::swap(m_growthLeft, _other.m_growthLeft);
+        std::swap(m_hash, _other.m_hash);
+        std::swap(m_equal, _other.m_equal);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Lookup
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+    [[nodiscard]] iterator find(const Key& _key) { return iteratorAt(findIndex(_key)); }
+
+    [[nodiscard]] const_iterator find(const Key& _key) const
+    {
+        return iteratorAt(findIndex(_key));
+    }
+
+    template <typename K>
+        requires TransparentFunctor<Hash> && TransparentFunctor<KeyEqual>
+    [[nodiscard]] iterator find(const K& _key)
+    {
+        return iteratorAt(findIndex(_key));
+    }
+
+    template <typename K>
+        requires TransparentFunctor<Hash> && TransparentFunctor<KeyEqual>
+    [[nodiscard]] const_iterator find(const K& _key) const
+    {
+        return iteratorAt(findIndex(_key));
+    }
+
+    [[nodiscard]] bool contains(const Key& _key) const { return findIndex(_key) != m_capacity; }
+
+    template <typename K>
+        requires TransparentFunctor<Hash> && TransparentFunctor<KeyEqual>
+    [[nodiscard]] bool contains(const K& _key) const
+    {
+        return findIndex(_key) != m_capacity;
+    }
+
+    [[nodiscard]] size_t count(const Key& _key) const { return contains(_key) ? 1 : 0; }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Erasure
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Erases the element of the iterator, the other iterators stay valid.
+     *
+     * @return The iterator following it.
+     */
+    iterator erase(const_iterator _it) noexcept
+    {
+        const auto index = size_t(_it.m_ctrl - m_ctrl);
+        eraseAt(index);
+
+        iterator next(m_ctrl + index, m_ctrl + m_capacity, m_slots + index);
+        next.skipFree();
+        return next;
+    }
+
+    iterator erase(iterator _it) noexcept { return erase(const_iterator(_it)); }
+
+    size_t erase(const Key& _key)
+    {
+        const size_t index = findIndex(_key);
+        if (index == m_capacity) return 0;
+
+        eraseAt(index);
+        return 1;
+    }
+
+    template <typename K>
+        requires TransparentFunctor<Hash> && TransparentFunctor<KeyEqual> &&
+                 (!std::is_convertible_v<K, const_iterator>)
+    size_t erase(const K& _key)
+    {
+        const size_t index = findIndex(_key);
+        if (index == m_capacity) return 0;
+
+        eraseAt(index);
+        return 1;
+    }
+
+    /**
+     * @brief Erases the elements _predicate returns true for.
+     *
+     * @return The number of elements erased.
+     */
+    template <typename Predicate>
+    size_t erase_if(Predicate&& _predicate)
+    {
+        const size_t before = m_size;
+        for (size_t i = 0; i < m_capacity; ++i)
+        {
+            if (m_ctrl[i] >= 0 && _predicate(std::as_const(m_slots[i]))) eraseAt(i);
+        }
+
+        return before - m_size;
+    }
+
+   protected:
+    template <typename K>
+    [[nodiscard]] uint64_t hashOf(const K& _key) const
+    {
+        return mixFlatHash(uint64_t(m_hash(_key)));
+    }
+
+    [[nodiscard]] iterator iteratorAt(size_t _index) noexcept
+    {
+        return iterator(m_ctrl + _index, m_ctrl + m_capacity, m_slots + _index);
+    }
+
+    [[nodiscard]] const_iterator iteratorAt(size_t _index) const noexcept
+    {
+        return const_iterator(m_ctrl + _index, m_ctrl + m_capacity, m_slots + _index);
+    }
+
+    [[nodiscard]] Slot& slotAt(size_t _index) noexcept { return m_slots[_index]; }
+
+    /**
+     * @brief Finds the slot of a key.
+     *
+     * @return Its index, or capacity() if the key is absent.
+     */
+    template <typename K>
+    [[nodiscard]] size_t findIndex(const K& _key) const
+    {
+        return findIndex(_key, hashOf(_key));
+    }
+
+    template <typename K>
+    [[nodiscard]] size_t findIndex(const K& _key, uint64_t _hash) const
+    {
+        const auto h2 = FlatCtrl(_hash & 0x7F);
+        size_t group = size_t(_hash >> 7) & m_groupMask;
+
+        for (size_t step = 1;; ++step)
+        {
+            const FlatCtrl* ctrl = m_ctrl + group * k_flatGroupWidth;
+            const FlatGroup probed(ctrl);
+
+            for (uint32_t mask = probed.match(h2); mask != 0; mask &= mask - 1)
+            {
+                const size_t index = group * k_flatGroupWidth + size_t(std::countr_zero(mask));
+                if (SIMD_LIKELY(m_equal(KeyOf::get(m_slots[index]), _key))) return index;
+            }
+
+            if (SIMD_LIKELY(probed.matchEmpty() != 0)) return m_capacity;
+
+            // triangular steps visit every group of a power-of-two count
+            group = (group + step) & m_groupMask;
+        }
+    }
+
+    /**
+     * @brief Finds a slot of a key, or constructs its element there from _args if it is absent.
+     *
+     * @return The index of the slot, and whether the element was inserted.
+     */
+    template <typename K, typename... Args>
+    std::pair<size_t, bool> findOrEmplace(const K& _key, Args&&... _args)
+    {
+        const uint64_t hash = hashOf(_key);
+
+        const size_t found = findIndex(_key, hash);
+        if (found != m_capacity) return {found, false};
+
+        return {emplaceNew(hash, std::forward<Args>(_args)...), true};
+    }
+
+    /**
+     * @brief Constructs an element whose key is known to be absent.
+     *
+     * @return The index of its slot.
+     */
+    template <typename... Args>
+    size_t insertUnique(uint64_t _hash, Args&&... _args)
+    {
+        return emplaceNew(_hash, std::forward<Args>(_args)...);
+    }
+
+   private:
+    [[nodiscard]] static constexpr size_t maxLoad(size_t _capacity) noexcept
+    {
+        return _capacity - _capacity / 8;
+    }
+
+    [[nodiscard]] static size_t capacityFor(size_t _count)
+    {
+        if (_count > (SIZE_MAX >> 4)) throw std::length_error("FlatHashTable: too many elements");
+
+        // Within the 7/8 of load
+        return std::max(k_flatGroupWidth, std::bit_ceil(_count + (_count + 6) / 7));
+    }
+
+    template <typename... Args>
+    size_t emplaceNew(uint64_t _hash, Args&&... _args)
+    {
+        const size_t index = findFreeIndex(_hash);
+        if (SIMD_UNLIKELY(m_growthLeft == 0 && m_ctrl[index] == k_flatEmpty))
+        {
+            // Mostly tombstones: rehashing at the same capacity frees them
+            return rehash(m_size < maxLoad(m_capacity) / 2 ? m_capacity
+                                                           : capacityFor(m_size + 1),
+                          _hash, std::forward<Args>(_args)...);
+        }
+
+        constructAt(index, _hash, std::forward<Args>(_args)...);
+
+        return index;
+    }
+
+    template <typename... Args>
+    void constructAt(size_t _index, uint64_t _hash, Args&&... _args)
+    {
+        ::new (static_cast<void*>(m_slots + _index)) Slot(std::forward<Args>(_args)...);
+
+        if (m_ctrl[_index] == k_flatEmpty) --m_growthLeft;
+        m_ctrl[_index] = FlatCtrl(_hash & 0x7F);
+        ++m_size;
+    }
+
+    [[nodiscard]] size_t findFreeIndex(uint64_t _hash) const noexcept
+    {
+        size_t group = size_t(_hash >> 7) & m_groupMask;
+
+        for (size_t step = 1;; ++step)
+        {
+            const FlatGroup probed(m_ctrl + group * k_flatGroupWidth);
+
+            const uint32_t mask = probed.matchEmptyOrDeleted();
+            if (mask != 0) return group * k_flatGroupWidth + size_t(std::countr_zero(mask));
+
+            group = (group + step) & m_groupMask;
+        }
+    }
+
+    void eraseAt(size_t _index) noexcept
+    {
+        m_slots[_index].~Slot();
+        --m_size;
+
+        // No probe went past a group with an empty slot, the slot needs no tombstone then
+        const size_t group = _index & ~(k_flatGroupWidth - 1);
+        if (FlatGroup(m_ctrl + group).matchEmpty() != 0)
+        {
+            m_ctrl[_index] = k_flatEmpty;
+            ++m_growthLeft;
+        }
+        else
+        {
+            m_ctrl[_index] = k_flatDeleted;
+        }
+    }
+
+    /**
+     * @brief Moves the elements to a table of _capacity slots, after constructing the one of
+     * _args there first (_args may refer to an element).
+     *
+     * @return The index of the element constructed, if any.
+     */
+    template <typename... Args>
+    size_t rehash(size_t _capacity, uint64_t _hash = 0, Args&&... _args)
+    {
+        FlatHashTable rehashed;
+        rehashed.allocate(_capacity);
+
+        size_t index = 0;
+        if constexpr (sizeof...(Args) != 0)
+        {
+            index = rehashed.findFreeIndex(_hash);
+            rehashed.constructAt(index, _hash, std::forward<Args>(_args)...);
+        }
+
+        for (size_t i = 0; i < m_capacity; ++i)
+        {
+            if (m_ctrl[i] < 0) continue;
+
+            const size_t free = rehashed.findFreeIndex(hashOf(KeyOf::get(m_slots[i])));
+            rehashed.constructAt(free, hashOf(KeyOf::get(m_slots[i])), std::move(m_slots[i]));
+        }
+
+        rehashed.m_hash = std::move(m_hash);
+        rehashed.m_equal = std::move(m_equal);
+        swap(rehashed);
+
+        return index;
+    }
+
+    void allocate(size_t _capacity)
+    {
+        void* memory = ::operator new(_capacity * (sizeof(Slot) + 1),
+                                      std::align_val_t(k_slotAlignment));
+
+        m_slots = static_cast<Slot*>(memory);
+        m_ctrl = reinterpret_cast<FlatCtrl*>(m_slots + _capacity);
+        std::memset(m_ctrl, k_flatEmpty, _capacity);
+
+        m_capacity = _capacity;
+        m_groupMask = _capacity / k_flatGroupWidth - 1;
+        m_size = 0;
+        m_growthLeft = maxLoad(_capacity);
+    }
+
+    void destroySlots() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<Slot>)
+        {
+            for (size_t i = 0; i < m_capacity; ++i)
+            {
+                if (m_ctrl[i] >= 0) m_slots[i].~Slot();
+            }
+        }
+    }
+
+    void release() noexcept
+    {
+        if (m_capacity == 0) return;
+
+        destroySlots();
+        ::operator delete(static_cast<void*>(m_slots), std::align_val_t(k_slotAlignment));
+    }
+};
+
+template <typename K, typename V>
+struct FlatMapKeyOf
+{
+    [[nodiscard]] static const K& get(const std::pair<K, V>& _slot) noexcept
+    {
+        return _slot.first;
+    }
+};
+
+template <typename K>
+struct FlatSetKeyOf
+{
+    [[nodiscard]] static const K& get(const K& _slot) noexcept { return _slot; }
+};
+
+} // namespace detail
+
+/**
+ * @brief An open-addressing hash map storing its pairs inline, a drop-in for std::unordered_map
+ * on hot paths (Swiss table: SIMD-probed groups of 16 control bytes).
+ *
+ * @note Unlike std::unordered_map, inserting may move the elements: pointers, references and
+ * iterators are invalidated by any insertion that grows the table. Erasing invalidates only the
+ * erased element. The iteration order is unspecified.
+ * @note The elements are std::pair<K, V> (not std::pair<const K, V>): never modify a key in
+ * place.
+ *
+ * @tparam K The key type.
+ * @tparam V The mapped type.
+ * @tparam Hash Hash of the keys, transparent for heterogeneous lookups.
+ * @tparam KeyEqual Equality of the keys, transparent for heterogeneous lookups.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class FlatHashMap final
+    : public detail::FlatHashTable<K, std::pair<K, V>, detail::FlatMapKeyOf<K, V>, Hash, KeyEqual>
+{
+   private:
+    using Base =
+        detail::FlatHashTable<K, std::pair<K, V>, detail::FlatMapKeyOf<K, V>, Hash, KeyEqual>;
+
+   public:
+    using mapped_type = V;
+    using typename Base::const_iterator;
+    using typename Base::iterator;
+    using typename Base::value_type;
+
+    using Base::Base;
+
+    FlatHashMap() = default;
+
+    FlatHashMap(std::initializer_list<value_type> _values) : Base(_values.size())
+    {
+        for (const value_type& value : _values) insert(value);
+    }
+
+   public:
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& _key, Args&&... _args)
+    {
+        return emplaceKey(_key, std::piecewise_construct, std::forward_as_tuple(_key),
+                          std::forward_as_tuple(std::forward<Args>(_args)...));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& _key, Args&&... _args)
+    {
+        return emplaceKey(_key, std::piecewise_construct, std::forward_as_tuple(std::move(_key)),
+                          std::forward_as_tuple(std::forward<Args>(_args)...));
+    }
+
+    /**
+     * @brief Inserts a pair made of _key and _value if _key is absent (try_emplace semantics:
+     * nothing is constructed when the key is present).
+     */
+    template <typename Key, typename Value>
+    std::pair<iterator, bool> emplace(Key&& _key, Value&& _value)
+    {
+        if constexpr (std::is_same_v<std::remove_cvref_t<Key>, K>)
+        {
+            return try_emplace(std::forward<Key>(_key), std::forward<Value>(_value));
+        }
+        else
+        {
+            return try_emplace(K(std::forward<Key>(_key)), std::forward<Value>(_value));
+        }
+    }
+
+    std::pair<iterator, bool> insert(const value_type& _value)
+    {
+        return emplaceKey(_value.first, _value);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& _value)
+    {
+        return emplaceKey(_value.first, std::move(_value));
+    }
+
+    template <typename Value>
+    std::pair<iterator, bool> insert_or_assign(const K& _key, Value&& _value)
+    {
+        auto result = try_emplace(_key, std::forward<Value>(_value));
+        if (!result.second) result.first->second = std::forward<Value>(_value);
+
+        return result;
+    }
+
+    template <typename Value>
+    std::pair<iterator, bool> insert_or_assign(K&& _key, Value&& _value)
+    {
+        auto result = try_emplace(std::move(_key), std::forward<Value>(_value));
+        if (!result.second) result.first->second = std::forward<Value>(_value);
+
+        return result;
+    }
+
+    V& operator[](const K& _key) { return try_emplace(_key).first->second; }
+    V& operator[](K&& _key) { return try_emplace(std::move(_key)).first->second; }
+
+    /**
+     * @throws std::out_of_range if the key is absent.
+     */
+    [[nodiscard]] V& at(const K& _key)
+    {
+        auto it = this->find(_key);
+        if (it == this->end()) throw std::out_of_range("FlatHashMap::at: key not found");
+
+        return it->second;
+    }
+
+    [[nodiscard]] const V& at(const K& _key) const
+    {
+        auto it = this->find(_key);
+        if (it == this->end()) throw std::out_of_range("FlatHashMap::at: key not found");
+
+        return it->second;
+    }
+
+    friend bool operator==(const FlatHashMap& _lhs, const FlatHashMap& _rhs)
+    {
+        if (_lhs.size() != _rhs.size()) return false;
+
+        for (const value_type& value : _lhs)
+        {
+            auto it = _rhs.find(value.first);
+            if (it == _rhs.end() || !(it->second == value.second)) return false;
+        }
+
+        return true;
+    }
+
+   private:
+    template <typename... Args>
+    std::pair<iterator, bool> emplaceKey(const K& _key, Args&&... _args)
+    {
+        auto [index, inserted] = this->findOrEmplace(_key, std::forward<Args>(_args)...);
+        return {this->iteratorAt(index), inserted};
+    }
+};
+
+/**
+ * @brief An open-addressing hash set storing its keys inline, the set counterpart of FlatHashMap
+ * (same invalidation rules).
+ */
+template <typename K, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class FlatHashSet final
+    : public detail::FlatHashTable<K, K, detail::FlatSetKeyOf<K>, Hash, KeyEqual>
+{
+   private:
+    using Base = detail::FlatHashTable<K, K, detail::FlatSetKeyOf<K>, Hash, KeyEqual>;
+
+   public:
+    using typename Base::const_iterator;
+    using typename Base::iterator;
+
+    using Base::Base;
+
+    FlatHashSet() = default;
+
+    FlatHashSet(std::initializer_list<K> _keys) : Base(_keys.size())
+    {
+        for (const K& key : _keys) insert(key);
+    }
+
+   public:
+    std::pair<iterator, bool> insert(const K& _key)
+    {
+        auto [index, inserted] = this->findOrEmplace(_key, _key);
+        return {this->iteratorAt(index), inserted};
+    }
+
+    std::pair<iterator, bool> insert(K&& _key)
+    {
+        auto [index, inserted] = this->findOrEmplace(_key, std::move(_key));
+        return {this->iteratorAt(index), inserted};
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... _args)
+    {
+        return insert(K(std::forward<Args>(_args)...));
+    }
+
+    friend bool operator==(const FlatHashSet& _lhs, const FlatHashSet& _rhs)
+    {
+        if (_lhs.size() != _rhs.size()) return false;
+
+        for (const K& key : _lhs)
+        {
+            if (!_rhs.contains(key)) return false;
+        }
+
+        return true;
+    }
+};
+
+} // namespace pieces
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "pieces/containers/small_vector.hpp"
+
+namespace pieces
+{
+
+/**
+ * @brief A std::string holding up to N characters inline (the null terminator aside), on the
+ * heap past them: the names of the traces and the logs fit without an allocation, where the
+ * small string buffer of the standard library stops at 15 (libstdc++, MSVC) or 22 (libc++).
+ *
+ * The interface is the common part of std::string: it converts to std::string_view, compares
+ * and hashes like one, and the searches are those of std::string_view.
+ *
+ * @tparam N The number of characters stored inline.
+ */
+template <size_t N>
+class SmallString
+{
+   public:
+    using value_type = char;
+    using traits_type = std::char_traits<char>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = char&;
+    using const_reference = const char&;
+    using pointer = char*;
+    using const_pointer = const char*;
+    using iterator = char*;
+    using const_iterator = const char*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_t npos = std::string_view::npos;
+    static constexpr size_t k_inlineCapacity = N;
+
+   private:
+    // Always ends with the terminator, included in its size
+    SmallVector<char, N + 1> m_chars;
+
+   public:
+    SmallString() noexcept { m_chars.emplace_back('\0'); }
+
+    SmallString(const char* _string) : SmallString(std::string_view(_string)) {}
+    SmallString(const char* _string, size_t _count)
+        : SmallString(std::string_view(_string, _count))
+    {
+    }
+
+    SmallString(size_t _count, char _char) : SmallString() { append(_count, _char); }
+
+    template <std::input_iterator It>
+    SmallString(It _first, It _last) : SmallString()
+    {
+        insert(end(), _first, _last);
+    }
+
+    SmallString(std::initializer_list<char> _chars) : SmallString(_chars.begin(), _chars.end()) {}
+
+    // From std::string_view, std::string and the other types converting to std::string_view
+    template <typename S>
+        requires(std::is_convertible_v<const S&, std::string_view> &&
+                 !std::is_convertible_v<const S&, const char*>)
+    explicit SmallString(const S& _string) : SmallString()
+    {
+        append(std::string_view(_string));
+    }
+
+    SmallString(const SmallString&) = default;
+
+    SmallString(SmallString&& _other) noexcept : m_chars(std::move(_other.m_chars))
+    {
+        _other.m_chars.emplace_back('\0');
+    }
+
+    SmallString& operator=(const SmallString&) = default;
+
+    SmallString& operator=(SmallString&& _other) noexcept
+    {
+        if (this != &_other)
+        {
+            m_chars = std::move(_other.m_chars);
+            _other.m_chars.emplace_back('\0');
+        }
+
+        return *this;
+    }
+
+    SmallString& operator=(std::string_view _string) { return assign(_string); }
+    SmallString& operator=(const char* _string) { return assign(std::string_view(_string)); }
+
+    SmallString& operator=(char _char)
+    {
+        clear();
+        push_back(_char);
+        return *this;
+    }
+
+   public:
+    [[nodiscard]] operator std::string_view() const noexcept { return {data(), size()}; }
+
+    // Explicit, like the conversions of std::string_view to it.
+    [[nodiscard]] explicit operator std::string() const { return std::string(data(), size()); }
+    [[nodiscard]] std::string str() const { return std::string(data(), size()); }
+
+    SmallString& assign(std::string_view _string)
+    {
+        // _string may view this string
+        if (_string.data() >= begin() && _string.data() <= end())
+        {
+            const auto offset = size_t(_string.data() - begin());
+            std::copy_n(begin() + offset, _string.size(), begin());
+            resize(_string.size());
+            return *this;
+        }
+
+        clear();
+        return append(_string);
+    }
+
+    SmallString& assign(size_t _count, char _char)
+    {
+        clear();
+        return append(_count, _char);
+    }
+
+    // Element access
+
+    [[nodiscard]] char& at(size_t _index)
+    {
+        if (_index >= size()) throw std::out_of_range("SmallString::at: index out of range");
+        return m_chars[_index];
+    }
+
+    [[nodiscard]] const char& at(size_t _index) const
+    {
+        if (_index >= size()) throw std::out_of_range("SmallString::at: index out of range");
+        return m_chars[_index];
+    }
+
+    [[nodiscard]] char& operator[](size_t _index) noexcept { return m_chars[_index]; }
+    [[nodiscard]] const char& operator[](size_t _index) const noexcept { return m_chars[_index]; }
+
+    [[nodiscard]] char& front() noexcept { return m_chars[0]; }
+    [[nodiscard]] const char& front() const noexcept { return m_chars[0]; }
+    [[nodiscard]] char& back() noexcept { return m_chars[size() - 1]; }
+    [[nodiscard]] const char& back() const noexcept { return m_chars[size() - 1]; }
+
+    [[nodiscard]] char* data() noexcept { return m_chars.data(); }
+    [[nodiscard]] const char* data() const noexcept { return m_chars.data(); }
+    [[nodiscard]] const char* c_str() const noexcept { return m_chars.data(); }
+
+    // Iterators
+
+    [[nodiscard]] iterator begin() noexcept { return data(); }
+    [[nodiscard]] const_iterator begin() const noexcept { return data(); }
+    [[nodiscard]] const_iterator cbegin() const noexcept { return data(); }
+    [[nodiscard]] iterator end() noexcept { return data() + size(); }
+    [[nodiscard]] const_iterator end() const noexcept { return data() + size(); }
+    [[nodiscard]] const_iterator cend() const noexcept { return data() + size(); }
+
+    [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+    [[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    [[nodiscard]] const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] size_t size() const noexcept { return m_chars.size() - 1; }
+    [[nodiscard]] size_t length() const noexcept { return size(); }
+    [[nodiscard]] size_t capacity() const noexcept { return m_chars.capacity() - 1; }
+    [[nodiscard]] bool isInline() const noexcept { return m_chars.isInline(); }
+
+    void reserve(size_t _capacity) { m_chars.reserve(_capacity + 1); }
+    void shrink_to_fit() { m_chars.shrink_to_fit(); }
+
+    // Modifiers
+
+    void clear() noexcept
+    {
+        m_chars.clear();
+        m_chars.emplace_back('\0');
+    }
+
+    void push_back(char _char)
+    {
+        m_chars.back() = _char;
+        m_chars.emplace_back('\0');
+    }
+
+    void pop_back() noexcept
+    {
+        m_chars.pop_back();
+        m_chars.back() = '\0';
+    }
+
+    SmallString& append(std::string_view _string)
+    {
+        // _string may view this string, it is copied before the growth can move it
+        if (_string.data() >= begin() && _string.data() <= end())
+        {
+            const auto offset = size_t(_string.data() - begin());
+            const size_t oldSize = size();
+            reserve(oldSize + _string.size());
+            m_chars.insert(m_chars.end() - 1, _string.size(), '\0');
+            std::copy_n(begin() + offset, _string.size(), begin() + oldSize);
+            return *this;
+        }
+
+        m_chars.insert(m_chars.end() - 1, _string.begin(), _string.end());
+        return *this;
+    }
+
+    SmallString& append(const char* _string) { return append(std::string_view(_string)); }
+
+    SmallString& append(size_t _count, char _char)
+    {
+        m_chars.insert(m_chars.end() - 1, _count, _char);
+        return *this;
+    }
+
+    SmallString& operator+=(std::string_view _string) { return append(_string); }
+    SmallString& operator+=(const char* _string) { return append(std::string_view(_string)); }
+
+    SmallString& operator+=(char _char)
+    {
+        push_back(_char);
+        return *this;
+    }
+
+    friend SmallString operator+(const SmallString& _lhs, std::string_view _rhs)
+    {
+        SmallString result;
+        result.reserve(_lhs.size() + _rhs.size());
+        result.append(_lhs.view());
+        return result.append(_rhs);
+    }
+
+    template <std::input_iterator It>
+    iterator insert(const_iterator _pos, It _first, It _last)
+    {
+        return m_chars.insert(_pos, _first, _last);
+    }
+
+    SmallString& insert(size_t _index, std::string_view _string)
+    {
+        if (_index > size()) throw std::out_of_range("SmallString::insert: index out of range");
+
+        const SmallString copy(_string);
+        m_chars.insert(m_chars.begin() + _index, copy.begin(), copy.end());
+        return *this;
+    }
+
+    SmallString& erase(size_t _index = 0, size_t _count = npos)
+    {
+        if (_index > size()) throw std::out_of_range("SmallString::erase: index out of range");
+
+        const size_t count = std::min(_count, size() - _index);
+        m_chars.erase(m_chars.begin() + _index, m_chars.begin() + _index + count);
+        return *this;
+    }
+
+    iterator erase(const_iterator _first, const_iterator _last)
+    {
+        return m_chars.erase(_first, _last);
+    }
+
+    void resize(size_t _count, char _char = '\0')
+    {
+        m_chars.pop_back();
+        m_chars.resize(_count, _char);
+        m_chars.emplace_back('\0');
+    }
+
+    void swap(SmallString& _other) noexcept { m_chars.swap(_other.m_chars); }
+
+    friend void swap(SmallString& _lhs, SmallString& _rhs) noexcept { _lhs.swap(_rhs); }
+
+    // Operations, those of std::string_view
+
+    [[nodiscard]] SmallString substr(size_t _index = 0, size_t _count = npos) const
+    {
+        return SmallString(view().substr(_index, _count));
+    }
+
+    [[nodiscard]] size_t find(std::string_view _string, size_t _index = 0) const noexcept
+    {
+        return view().find(_string, _index);
+    }
+
+    [[nodiscard]] size_t find(char _char, size_t _index = 0) const noexcept
+    {
+        return view().find(_char, _index);
+    }
+
+    [[nodiscard]] size_t rfind(std::string_view _string, size_t _index = npos) const noexcept
+    {
+        return view().rfind(_string, _index);
+    }
+
+    [[nodiscard]] size_t rfind(char _char, size_t _index = npos) const noexcept
+    {
+        return view().rfind(_char, _index);
+    }
+
+    [[nodiscard]] bool starts_with(std::string_view _prefix) const noexcept
+    {
+        return view().starts_with(_prefix);
+    }
+
+    [[nodiscard]] bool ends_with(std::string_view _suffix) const noexcept
+    {
+        return view().ends_with(_suffix);
+    }
+
+    [[nodiscard]] bool contains(std::string_view _string) const noexcept
+    {
+        return view().find(_string) != npos;
+    }
+
+    [[nodiscard]] int compare(std::string_view _string) const noexcept
+    {
+        return view().compare(_string);
+    }
+
+    friend bool operator==(const SmallString& _lhs, std::string_view _rhs) noexcept
+    {
+        return _lhs.view() == _rhs;
+    }
+
+    friend std::strong_ordering operator<=>(const SmallString& _lhs,
+                                            std::string_view _rhs) noexcept
+    {
+        return _lhs.view() <=> _rhs;
+    }
+
+   private:
+    [[nodiscard]] std::string_view view() const noexcept { return {data(), size()}; }
+};
+
+} // namespace pieces
+
+template <size_t N>
+struct std::hash<pieces::SmallString<N>>
+{
+    size_t operator()(const pieces::SmallString<N>& _string) const noexcept
+    {
+        return std::hash<std::string_view>()(_string);
+    }
+};
@@ -0,0 +1,550 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace pieces
+{
+
+/**
+ * @brief A std::vector holding its first N elements inline, in the object, and on the heap past
+ * them: the short-lived lists of a hot path (a few archetypes, a few components) never allocate.
+ *
+ * The interface is the one of std::vector (minus the allocator), the iterators are pointers. A
+ * move steals the heap buffer, inline elements are moved one by one: unlike std::vector, a move
+ * invalidates the iterators and references of an inline source. Growing doubles the capacity.
+ *
+ * @tparam T The type of the elements.
+ * @tparam N The number of elements stored inline, at least 1.
+ */
+template <typename T, size_t N>
+class SmallVector
+{
+    static_assert(N > 0, "SmallVector: use std::vector without inline elements");
+
+   public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_t k_inlineCapacity = N;
+
+   private:
+    T* m_data;
+    size_t m_size = 0;
+    size_t m_capacity = N;
+    alignas(T) std::byte m_inline[N * sizeof(T)];
+
+   public:
+    SmallVector() noexcept : m_data(inlineData()) {}
+
+    explicit SmallVector(size_t _count) : SmallVector() { resize(_count); }
+
+    SmallVector(size_t _count, const T& _value) : SmallVector() { assign(_count, _value); }
+
+    template <std::input_iterator It>
+    SmallVector(It _first, It _last) : SmallVector()
+    {
+        append(_first, _last);
+    }
+
+    SmallVector(std::initializer_list<T> _values) : SmallVector()
+    {
+        append(_values.begin(), _values.end());
+    }
+
+    SmallVector(const SmallVector& _other) : SmallVector()
+    {
+        append(_other.begin(), _other.end());
+    }
+
+    SmallVector(SmallVector&& _other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : SmallVector()
+    {
+        takeFrom(_other);
+    }
+
+    ~SmallVector()
+    {
+        std::destroy_n(m_data, m_size);
+        freeHeap();
+    }
+
+    SmallVector& operator=(const SmallVector& _other)
+    {
+        if (this != &_other) assign(_other.begin(), _other.end());
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& _other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &_other)
+        {
+            clear();
+            if (!_other.isInline())
+            {
+                freeHeap();
+                m_data = inlineData();
+                m_capacity = N;
+            }
+
+            takeFrom(_other);
+        }
+
+        return *this;
+    }
+
+    SmallVector& operator=(std::initializer_list<T> _values)
+    {
+        assign(_values.begin(), _values.end());
+        return *this;
+    }
+
+   public:
+    void assign(size_t _count, const T& _value)
+    {
+        // _value may be one of the elements
+        const T value = _value;
+        clear();
+        reserve(_count);
+        std::uninitialized_fill_n(m_data, _count, value);
+        m_size = _count;
+    }
+
+    template <std::input_iterator It>
+    void assign(It _first, It _last)
+    {
+        clear();
+        append(_first, _last);
+    }
+
+    void assign(std::initializer_list<T> _values) { assign(_values.begin(), _values.end()); }
+
+    // Element access
+
+    [[nodiscard]] T& at(size_t _index)
+    {
+        if (_index >= m_size) throw std::out_of_range("SmallVector::at: index out of range");
+        return m_data[_index];
+    }
+
+    [[nodiscard]] const T& at(size_t _index) const
+    {
+        if (_index >= m_size) throw std::out_of_range("SmallVector::at: index out of range");
+        return m_data[_index];
+    }
+
+    [[nodiscard]] T& operator[](size_t _index) noexcept { return m_data[_index]; }
+    [[nodiscard]] const T& operator[](size_t _index) const noexcept { return m_data[_index]; }
+
+    [[nodiscard]] T& front() noexcept { return m_data[0]; }
+    [[nodiscard]] const T& front() const noexcept { return m_data[0]; }
+    [[nodiscard]] T& back() noexcept { return m_data[m_size - 1]; }
+    [[nodiscard]] const T& back() const noexcept { return m_data[m_size - 1]; }
+
+    [[nodiscard]] T* data() noexcept { return m_data; }
+    [[nodiscard]] const T* data() const noexcept { return m_data; }
+
+    // Iterators
+
+    [[nodiscard]] iterator begin() noexcept { return m_data; }
+    [[nodiscard]] const_iterator begin() const noexcept { return m_data; }
+    [[nodiscard]] const_iterator cbegin() const noexcept { return m_data; }
+    [[nodiscard]] iterator end() noexcept { return m_data + m_size; }
+    [[nodiscard]] const_iterator end() const noexcept { return m_data + m_size; }
+    [[nodiscard]] const_iterator cend() const noexcept { return m_data + m_size; }
+
+    [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    [[nodiscard]] const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+    [[nodiscard]] const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    [[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    [[nodiscard]] const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+    [[nodiscard]] const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+    [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
+    [[nodiscard]] static constexpr size_t max_size() noexcept
+    {
+        return std::numeric_limits<size_t>::max() / sizeof(T);
+    }
+
+    /// Whether the elements are in the inline storage, no allocation held.
+    [[nodiscard]] bool isInline() const noexcept { return m_data == inlineData(); }
+
+    void reserve(size_t _capacity)
+    {
+        if (_capacity > m_capacity) reallocate(_capacity);
+    }
+
+    // Back to the inline storage when the elements fit in it.
+    void shrink_to_fit()
+    {
+        if (isInline() || m_size == m_capacity) return;
+
+        reallocate(m_size);
+    }
+
+    // Modifiers
+
+    void clear() noexcept
+    {
+        std::destroy_n(m_data, m_size);
+        m_size = 0;
+    }
+
+    iterator insert(const_iterator _pos, const T& _value) { return emplace(_pos, _value); }
+    iterator insert(const_iterator _pos, T&& _value) { return emplace(_pos, std::move(_value)); }
+
+    iterator insert(const_iterator _pos, size_t _count, const T& _value)
+    {
+        const size_t index = size_t(_pos - begin());
+        const T value = _value;
+
+        reserve(m_size + _count);
+        std::uninitialized_fill_n(end(), _count, value);
+        m_size += _count;
+
+        std::rotate(begin() + index, end() - _count, end());
+        return begin() + index;
+    }
+
+    // _first and _last must not be iterators into this vector (as for std::vector)
+    template <std::input_iterator It>
+    iterator insert(const_iterator _pos, It _first, It _last)
+    {
+        const size_t index = size_t(_pos - begin());
+        const size_t oldSize = m_size;
+
+        append(_first, _last);
+
+        std::rotate(begin() + index, begin() + oldSize, end());
+        return begin() + index;
+    }
+
+    iterator insert(const_iterator _pos, std::initializer_list<T> _values)
+    {
+        return insert(_pos, _values.begin(), _values.end());
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator _pos, Args&&... _args)
+    {
+        const size_t index = size_t(_pos - begin());
+        if (index == m_size)
+        {
+            emplace_back(std::forward<Args>(_args)...);
+            return begin() + index;
+        }
+
+        // Built first: the arguments may be elements the shift moves
+        T value(std::forward<Args>(_args)...);
+
+        if (m_size == m_capacity) reallocate(growTo(m_size + 1));
+
+        std::construct_at(end(), std::move(back()));
+        ++m_size;
+        std::move_backward(begin() + index, end() - 2, end() - 1);
+        m_data[index] = std::move(value);
+
+        return begin() + index;
+    }
+
+    iterator erase(const_iterator _pos) { return erase(_pos, _pos + 1); }
+
+    iterator erase(const_iterator _first, const_iterator _last)
+    {
+        T* first = begin() + (_first - begin());
+        T* last = begin() + (_last - begin());
+
+        if (first != last)
+        {
+            T* newEnd = std::move(last, end(), first);
+            std::destroy(newEnd, end());
+            m_size = size_t(newEnd - begin());
+        }
+
+        return first;
+    }
+
+    void push_back(const T& _value) { emplace_back(_value); }
+    void push_back(T&& _value) { emplace_back(std::move(_value)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... _args)
+    {
+        if (m_size < m_capacity) [[likely]]
+        {
+            T* element = std::construct_at(m_data + m_size, std::forward<Args>(_args)...);
+            ++m_size;
+            return *element;
+        }
+
+        return growAndEmplaceBack(std::forward<Args>(_args)...);
+    }
+
+    void pop_back() noexcept
+    {
+        --m_size;
+        std::destroy_at(m_data + m_size);
+    }
+
+    void resize(size_t _count)
+    {
+        if (_count < m_size)
+        {
+            std::destroy(begin() + _count, end());
+        }
+        else
+        {
+            reserve(_count);
+            std::uninitialized_value_construct(end(), begin() + _count);
+        }
+
+        m_size = _count;
+    }
+
+    void resize(size_t _count, const T& _value)
+    {
+        if (_count <= m_size)
+        {
+            resize(_count);
+            return;
+        }
+
+        insert(end(), _count - m_size, _value);
+    }
+
+    void swap(SmallVector& _other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this == &_other) return;
+
+        if (!isInline() && !_other.isInline())
+        {
+            std::swap(m_data, _other.m_data);
+            std::swap(m_size, _other.m_size);
+            std::swap(m_capacity, _other.m_capacity);
+            return;
+        }
+
+        SmallVector other = std::move(_other);
+        _other = std::move(*this);
+        *this = std::move(other);
+    }
+
+    friend void swap(SmallVector& _lhs, SmallVector& _rhs) noexcept(noexcept(_lhs.swap(_rhs)))
+    {
+        _lhs.swap(_rhs);
+    }
+
+    friend bool operator==(const SmallVector& _lhs, const SmallVector& _rhs)
+    {
+        return std::equal(_lhs.begin(), _lhs.end(), _rhs.begin(), _rhs.end());
+    }
+
+    friend auto operator<=>(const SmallVector& _lhs, const SmallVector& _rhs)
+        requires std::three_way_comparable<T>
+    {
+        return std::lexicographical_compare_three_way(_lhs.begin(), _lhs.end(), _rhs.begin(),
+                                                      _rhs.end());
+    }
+
+   private:
+    [[nodiscard]] T* inlineData() noexcept { return reinterpret_cast<T*>(m_inline); }
+    [[nodiscard]] const T* inlineData() const noexcept
+    {
+        return reinterpret_cast<const T*>(m_inline);
+    }
+
+    [[nodiscard]] size_t growTo(size_t _needed) const noexcept
+    {
+        return std::max(_needed, m_capacity * 2);
+    }
+
+    template <std::input_iterator It>
+    void append(It _first, It _last)
+    {
+        if constexpr (std::forward_iterator<It>)
+        {
+            const size_t count = size_t(std::distance(_first, _last));
+            reserve(m_size + count);
+            std::uninitialized_copy(_first, _last, end());
+            m_size += count;
+        }
+        else
+        {
+            for (; _first != _last; ++_first) emplace_back(*_first);
+        }
+    }
+
+    // Moves the elements of _other here (this is empty, inline or with its heap buffer)
+    void takeFrom(SmallVector& _other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (!_other.isInline() && isInline())
+        {
+            m_data = _other.m_data;
+            m_size = _other.m_size;
+            m_capacity = _other.m_capacity;
+
+            _other.m_data = _other.inlineData();
+            _other.m_size = 0;
+            _other.m_capacity = N;
+            return;
+        }
+
+        reserve(_other.m_size);
+        relocate(_other.m_data, _other.m_size, m_data);
+        m_size = _other.m_size;
+        _other.m_size = 0;
+
+        // What the source held is now here
+        if (!_other.isInline())
+        {
+            _other.freeHeap();
+            _other.m_data = _other.inlineData();
+            _other.m_capacity = N;
+        }
+    }
+
+    // Moves _count elements to uninitialized _destination and destroys the sources
+    static void relocate(T* _source, size_t _count, T* _destination)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if (_count > 0) std::memcpy(_destination, _source, _count * sizeof(T));
+        }
+        else
+        {
+            if constexpr (std::is_nothrow_move_constructible_v<T> ||
+                          !std::is_copy_constructible_v<T>)
+            {
+                std::uninitialized_move_n(_source, _count, _destination);
+            }
+            else
+            {
+                std::uninitialized_copy_n(_source, _count, _destination);
+            }
+
+            std::destroy_n(_source, _count);
+        }
+    }
+
+    // To the inline storage when _capacity fits in it, to a heap buffer otherwise
+    void reallocate(size_t _capacity)
+    {
+        T* destination = _capacity <= N ? inlineData() : allocate(_capacity);
+        if (destination == m_data) return;
+
+        try
+        {
+            relocate(m_data, m_size, destination);
+        }
+        catch (...)
+        {
+            if (destination != inlineData()) deallocate(destination, _capacity);
+            throw;
+        }
+
+        freeHeap();
+        m_data = destination;
+        m_capacity = std::max(_capacity, N);
+    }
+
+    template <typename... Args>
+    T& growAndEmplaceBack(Args&&... _args)
+    {
+        const size_t capacity = growTo(m_size + 1);
+        T* destination = allocate(capacity);
+
+        // Built in the new buffer first: the arguments may be elements of the old one
+        try
+        {
+            std::construct_at(destination + m_size, std::forward<Args>(_args)...);
+        }
+        catch (...)
+        {
+            deallocate(destination, capacity);
+            throw;
+        }
+
+        try
+        {
+            relocate(m_data, m_size, destination);
+        }
+        catch (...)
+        {
+            std::destroy_at(destination + m_size);
+            deallocate(destination, capacity);
+            throw;
+        }
+
+        freeHeap();
+        m_data = destination;
+        m_capacity = capacity;
+
+        return m_data[m_size++];
+    }
+
+    [[nodiscard]] static T* allocate(size_t _capacity)
+    {
+        if (_capacity > max_size()) throw std::length_error("SmallVector: too many elements");
+        return std::allocator<T>().allocate(_capacity);
+    }
+
+    static void deallocate(T* _data, size_t _capacity) noexcept
+    {
+        std::allocator<T>().deallocate(_data, _capacity);
+    }
+
+    void freeHeap() noexcept
+    {
+        if (!isInline()) deallocate(m_data, m_capacity);
+    }
+};
+
+// std::erase and std::erase_if for SmallVector.
+template <typename T, size_t N, typename U>
+size_t erase(SmallVector<T, N>& _vector, const U& _value)
+{
+    const auto last = std::remove(_vector.begin(), _vector.end(), _value);
+    const size_t count = size_t(_vector.end() - last);
+    _vector.erase(last, _vector.end());
+    return count;
+}
+
+template <typename T, size_t N, typename Pred>
+size_t erase_if(SmallVector<T, N>& _vector, Pred _pred)
+{
+    const auto last = std::remove_if(_vector.begin(), _vector.end(), _pred);
+    const size_t count = size_t(_vector.end() - last);
+    _vector.erase(last, _vector.end());
+    return count;
+}
+
+} // namespace pieces
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <bitset>
+#include <functional>
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
 
 #include "pieces/internal/error_codes.hpp"
 #include "pieces/core/result.hpp"
+#include "pieces/intrinsics/simd.hpp"
 
 namespace pieces
 {
@@ -45,6 +50,9 @@ class SparseSet final
         Page() { present.reset(); } // initialize all bits to 0
     };
 
+    // How many keys ahead the bulk operations prefetch the sparse entries of
+    static constexpr size_t k_prefetchDistance = 8;
+
     std::vector<std::unique_ptr<Page>> m_pages{}; // stores pages of sparse keys
     std::vector<K> m_denseKeys{};                 // stores keys densely
     std::vector<T> m_data{};                      // stores values densely
@@ -177,6 +185,140 @@ class SparseSet final
         }
     }
 
+    /**
+     * @brief Inserts the keys with the values at the same positions, updating the values of the
+     * keys that already exist.
+     *
+     * The page table and the dense arrays grow once for the whole batch, and the sparse entries of
+     * the keys a few positions ahead are prefetched.
+     *
+     * @param _keys The keys to insert.
+     * @param _values The values to associate with the keys, as many as there are keys.
+     *
+     * @throws std::invalid_argument if the spans differ in size.
+     */
+    void insertBulk(std::span<const K> _keys, std::span<const T> _values)
+    {
+        if (_keys.size() != _values.size())
+        {
+            throw std::invalid_argument("SparseSet: as many values as keys are required");
+        }
+
+        if (_keys.empty()) return;
+
+        const size_t maxPageIdx = getPageIndex(*std::max_element(_keys.begin(), _keys.end()));
+        if (maxPageIdx >= m_pages.size()) m_pages.resize(maxPageIdx + 1);
+        reserveDense(size() + _keys.size());
+
+        for (size_t i = 0; i < _keys.size(); ++i)
+        {
+            if (i + k_prefetchDistance < _keys.size()) prefetch(_keys[i + k_prefetchDistance]);
+
+            insert(_keys[i], _values[i]);
+        }
+    }
+
+    /**
+     * @brief Removes the keys, ignoring those that are not present.
+     *
+     * @param _keys The keys to remove.
+     * @return The number of keys removed.
+     */
+    size_t removeBulk(std::span<const K> _keys)
+    {
+        const size_t previousSize = size();
+
+        for (size_t i = 0; i < _keys.size(); ++i)
+        {
+            if (i + k_prefetchDistance < _keys.size()) prefetch(_keys[i + k_prefetchDistance]);
+
+            remove(_keys[i]);
+        }
+
+        return previousSize - size();
+    }
+
+    /**
+     * @brief Removes the key-value pairs a predicate holds for, in one pass.
+     *
+     * Unlike remove(), the pairs that stay keep their relative order: they are moved down over
+     * the removed ones, and only their own sparse entries are rewritten.
+     *
+     * @param _predicate Called with each key and its value, returns true to remove the pair.
+     * @return The number of pairs removed.
+     */
+    template <typename Predicate>
+        requires std::is_invocable_r_v<bool, Predicate&, K, const T&>
+    size_t removeIf(Predicate&& _predicate)
+    {
+        const size_t count = m_denseKeys.size();
+        size_t kept = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const K key = m_denseKeys[i];
+            Page& page = *m_pages[getPageIndex(key)];
+            const size_t offset = getPageOffset(key);
+
+            if (std::invoke(_predicate, key, std::as_const(m_data[i])))
+            {
+                page.present.reset(offset);
+                --page.presentCount;
+                continue;
+            }
+
+            if (kept != i)
+            {
+                m_denseKeys[kept] = key;
+                m_data[kept] = std::move(m_data[i]);
+                page.sparse[offset] = kept;
+            }
+
+            ++kept;
+        }
+
+        m_denseKeys.resize(kept);
+        m_data.erase(m_data.begin() + kept, m_data.end());
+
+        if constexpr (AggressiveReclaim)
+        {
+            for (auto& page : m_pages)
+            {
+                if (page && page->presentCount == 0) page.reset();
+            }
+        }
+
+        return count - kept;
+    }
+
+    /**
+     * @brief Checks which of the keys are present, prefetching the sparse entries ahead.
+     *
+     * @param _keys The keys to check for.
+     * @param _results Set to whether the key at the same position is present.
+     * @return The number of keys present.
+     *
+     * @throws std::invalid_argument if the spans differ in size.
+     */
+    size_t containsBulk(std::span<const K> _keys, std::span<bool> _results) const
+    {
+        if (_keys.size() != _results.size())
+        {
+            throw std::invalid_argument("SparseSet: as many results as keys are required");
+        }
+
+        size_t found = 0;
+        for (size_t i = 0; i < _keys.size(); ++i)
+        {
+            if (i + k_prefetchDistance < _keys.size()) prefetch(_keys[i + k_prefetchDistance]);
+
+            _results[i] = contains(_keys[i]);
+            found += _results[i];
+        }
+
+        return found;
+    }
+
     /**
      * @brief Checks if the sparse set contains a key.
      *
@@ -280,31 +422,37 @@ class SparseSet final
 
     /**
      * @brief Computes the intersection of two sparse sets, returning a new sparse set containing
-     * the common keys and values.
+     * the common keys and the values of this set.
      *
-     * Time complexity: O(n + m), where n is the size of the current set and m is the size of the
-     * other set.
+     * The dense keys of the smaller set are probed in the larger one, prefetching ahead.
+     *
+     * Time complexity: O(min(n, m)), where n is the size of the current set and m is the size of
+     * the other set.
      *
      * @param _other The other sparse set to intersect with.
      * @return SelfType A new sparse set containing the intersection of the two sets.
      */
-    [[nodiscard]] SelfType getIntersection(const SelfType& _other)
+    [[nodiscard]] SelfType getIntersection(const SelfType& _other) const
     {
         SelfType intersectionSet;
 
-        if (size() < _other.size())
-        {
-            for (const auto& key : m_denseKeys)
-            {
-                if (_other.contains(key)) intersectionSet.insert(key, m_data[key]);
-            }
-        }
-        else
+        const bool otherIsLarger = size() <= _other.size();
+        const SelfType& smaller = otherIsLarger ? *this : _other;
+        const SelfType& larger = otherIsLarger ? _other : *this;
+        intersectionSet.reserveDense(smaller.size());
+
+        for (size_t i = 0; i < smaller.size(); ++i)
         {
-            for (const auto& key : _other.m_denseKeys)
+            if (i + k_prefetchDistance < smaller.size())
             {
-                if (contains(key)) intersectionSet.insert(key, m_data[key]);
+                larger.prefetch(smaller.m_denseKeys[i + k_prefetchDistance]);
             }
+
+            const K key = smaller.m_denseKeys[i];
+            const size_t largerIdx = larger.denseIndexOf(key);
+            if (largerIdx == k_absent) continue;
+
+            intersectionSet.insert(key, otherIsLarger ? m_data[i] : m_data[largerIdx]);
         }
 
         return intersectionSet;
@@ -312,7 +460,7 @@ class SparseSet final
 
     /**
      * @brief Computes the union of two sparse sets, returning a new sparse set containing all keys
-     * and values from both sets.
+     * and values from both sets (the values of the other set for the common keys).
      *
      * Time complexity: O(n + m), where n is the size of the current set and m is the size of the
      * other set.
@@ -320,14 +468,13 @@ class SparseSet final
      * @param _other The other sparse set to merge with.
      * @return SelfType A new sparse set containing the merged keys and values.
      */
-    [[nodiscard]] SelfType getUnion(const SelfType& _other)
+    [[nodiscard]] SelfType getUnion(const SelfType& _other) const
     {
         SelfType unionSet;
+        unionSet.reserveDense(size() + _other.size());
 
-        if constexpr (AggressiveReclaim) unionSet.reserve(size() + _other.size());
-
-        for (const auto& key : m_denseKeys) unionSet.insert(key, m_data[key]);
-        for (const auto& key : _other.m_denseKeys) unionSet.insert(key, _other.m_data[key]);
+        unionSet.insertBulk(m_denseKeys, m_data);
+        unionSet.insertBulk(_other.m_denseKeys, _other.m_data);
 
         return unionSet;
     }
@@ -344,15 +491,7 @@ class SparseSet final
     [[nodiscard]] SelfType getDifference(const SelfType& _other) const
     {
         SelfType differenceSet;
-
-        for (const auto& key : m_denseKeys)
-        {
-            if (!_other.contains(key))
-            {
-                auto result = get(key);
-                if (result.isOk()) differenceSet.insert(key, result.getValue());
-            }
-        }
+        appendDifference(differenceSet, _other);
 
         return differenceSet;
     }
@@ -370,24 +509,8 @@ class SparseSet final
     [[nodiscard]] SelfType getSymmetricDifference(const SelfType& _other) const
     {
         SelfType symmetricDifferenceSet;
-
-        for (const auto& key : m_denseKeys)
-        {
-            if (!_other.contains(key))
-            {
-                auto result = get(key);
-                if (result.isOk()) symmetricDifferenceSet.insert(key, result.getValue());
-            }
-        }
-
-        for (const auto& key : _other.m_denseKeys)
-        {
-            if (!contains(key))
-            {
-                auto result = _other.get(key);
-                if (result.isOk()) symmetricDifferenceSet.insert(key, result.getValue());
-            }
-        }
+        appendDifference(symmetricDifferenceSet, _other);
+        _other.appendDifference(symmetricDifferenceSet, *this);
 
         return symmetricDifferenceSet;
     }
@@ -493,6 +616,9 @@ class SparseSet final
     Iterator end() const { return Iterator(size(), this); }
 
    private:
+    // The dense index of an absent key
+    static constexpr size_t k_absent = SIZE_MAX;
+
     // Get the corresponding page for the given key.
     [[nodiscard]] size_t getPageIndex(K _key) const { return _key / PageSize; }
 
@@ -516,6 +642,53 @@ class SparseSet final
         return *m_pages[pageIdx];
     }
 
+    // Returns the dense index of the key, or k_absent.
+    [[nodiscard]] size_t denseIndexOf(K _key) const noexcept
+    {
+        const size_t pageIdx = getPageIndex(_key);
+        if (pageIdx >= m_pages.size() || !m_pages[pageIdx]) return k_absent;
+
+        const Page& page = *m_pages[pageIdx];
+        const size_t offset = getPageOffset(_key);
+
+        return page.present.test(offset) ? page.sparse[offset] : k_absent;
+    }
+
+    // Prefetches the presence mask and the sparse entry of a key, if its page exists.
+    void prefetch(K _key) const noexcept
+    {
+        const size_t pageIdx = getPageIndex(_key);
+        if (pageIdx >= m_pages.size() || !m_pages[pageIdx]) return;
+
+        const Page* page = m_pages[pageIdx].get();
+        SIMD_PREFETCH(&page->present);
+        SIMD_PREFETCH(&page->sparse[getPageOffset(_key)]);
+    }
+
+    // Grows the dense arrays geometrically, so that repeated small batches stay amortized O(1).
+    void reserveDense(size_t _count)
+    {
+        if (_count <= m_denseKeys.capacity() && _count <= m_data.capacity()) return;
+
+        const size_t capacity = std::max(_count, m_denseKeys.capacity() * 2);
+        m_denseKeys.reserve(capacity);
+        m_data.reserve(capacity);
+    }
+
+    // Inserts the pairs of this set whose key is not in the other set into a result set.
+    void appendDifference(SelfType& _result, const SelfType& _other) const
+    {
+        for (size_t i = 0; i < size(); ++i)
+        {
+            if (i + k_prefetchDistance < size())
+            {
+                _other.prefetch(m_denseKeys[i + k_prefetchDistance]);
+            }
+
+            if (!_other.contains(m_denseKeys[i])) _result.insert(m_denseKeys[i], m_data[i]);
+        }
+    }
+
     // Constness abstracted get function to avoid code duplication.
     template <typename Self>
     [[nodiscard]] static auto getImpl(Self& _self, K _key) noexcept
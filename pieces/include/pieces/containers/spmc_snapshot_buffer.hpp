@@ -1,10 +1,15 @@
 #pragma once
 
 #include <atomic>
+#include <bit>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <utility>
 #include <vector>
-#include <cstring>
+
+#include "pieces/core/templates.hpp"
 
 namespace pieces
 {
@@ -12,24 +17,30 @@ namespace pieces
 /**
  * @brief A single-producer, multiple-consumer (SPMC) snapshot buffer implementation.
  *
- * A lock-free buffer for single-producer scenarios with thread-safe snapshot
- * publishing for multiple consumers. Each thread maintains its own buffer and
- * can publish immutable snapshots that are accessible to all threads.
+ * The producer appends to a private write buffer and publishes it as an immutable snapshot
+ * that any thread can read, without locks on either side.
+ *
+ * Publishing hands the write buffer over rather than copying it: its vector is swapped into a
+ * free snapshot slot, which becomes current through one atomic exchange, and the write buffer
+ * takes the vector of the slot in return, so its capacity is reused. In the steady state (write
+ * buffer, current snapshot, previous snapshot) nothing is allocated or copied.
  *
- * This class allows:
- * - Lock-free writes for the producer thread
- * - Thread-safe snapshot publishing with double buffering
- * - Immutable snapshot views for concurrent readers
- * - Template-based for type flexibility
+ * Readers pin the snapshot they read with a split reference count: getSnapshot() is a single
+ * fetch_add on the word holding the index of the current slot and its count of readers
+ * (wait-free), releasing it gives the reference back to that word while the slot is current and
+ * to the slot once it was replaced. A replaced slot is recycled by the producer once its count
+ * drops to zero; while readers hold on to older snapshots the producer takes new slots instead.
  *
  * @tparam T Type of items stored in the buffer
  *
  * @note write(), publish(), pendingSize(), hasPending(), and clear()
  * should only be called from the producer thread. getSnapshot() is safe to
  * call from any thread.
+ * @note A SnapshotPtr must not outlive its buffer.
  */
 template <typename T>
-class SPMCSnapshotBuffer
+class SPMCSnapshotBuffer : public NonCopyable<SPMCSnapshotBuffer<T>>,
+                           NonMovable<SPMCSnapshotBuffer<T>>
 {
    public:
     /**
@@ -38,6 +49,8 @@ class SPMCSnapshotBuffer
     class Snapshot
     {
        private:
+        friend class SPMCSnapshotBuffer;
+
         std::vector<T> m_data;
 
        public:
@@ -57,26 +70,120 @@ class SPMCSnapshotBuffer
         auto end() const { return m_data.end(); }
     };
 
+   private:
+    struct Slot
+    {
+        Snapshot snapshot;
+
+        // References released after the slot was replaced, less those it was replaced with
+        std::atomic<int64_t> releasedCount{0};
+
+        // Producer only
+        uint32_t index = 0;
+        bool retired = false;
+    };
+
+    // The current word: index of the current slot in the high half, its readers in the low one
+    static constexpr uint64_t k_countMask = 0xFFFF'FFFFu;
+    static constexpr uint32_t k_indexShift = 32;
+
+    // Slot chunk c holds 2^c slots, so slots never move as the producer adds some
+    static constexpr uint32_t k_maxChunks = 32;
+
+   public:
+    /**
+     * @brief A reference on a published snapshot, which stays valid (and unchanged) until the
+     * reference is released, whatever the producer publishes meanwhile.
+     */
+    class SnapshotPtr
+    {
+       private:
+        friend class SPMCSnapshotBuffer;
+
+        const SPMCSnapshotBuffer* m_owner = nullptr;
+        Slot* m_slot = nullptr;
+
+        SnapshotPtr(const SPMCSnapshotBuffer* _owner, Slot* _slot) noexcept
+            : m_owner(_owner), m_slot(_slot)
+        {
+        }
+
+       public:
+        SnapshotPtr() noexcept = default;
+
+        SnapshotPtr(SnapshotPtr&& _other) noexcept
+            : m_owner(std::exchange(_other.m_owner, nullptr)),
+              m_slot(std::exchange(_other.m_slot, nullptr))
+        {
+        }
+
+        SnapshotPtr& operator=(SnapshotPtr&& _other) noexcept
+        {
+            if (this != &_other)
+            {
+                reset();
+                m_owner = std::exchange(_other.m_owner, nullptr);
+                m_slot = std::exchange(_other.m_slot, nullptr);
+            }
+
+            return *this;
+        }
+
+        SnapshotPtr(const SnapshotPtr&) = delete;
+        SnapshotPtr& operator=(const SnapshotPtr&) = delete;
+
+        ~SnapshotPtr() { reset(); }
+
+        /**
+         * @brief Releases the reference, the snapshot may be recycled from then on.
+         */
+        void reset() noexcept
+        {
+            if (m_slot) m_owner->release(*m_slot);
+
+            m_owner = nullptr;
+            m_slot = nullptr;
+        }
+
+        const Snapshot* get() const noexcept { return m_slot ? &m_slot->snapshot : nullptr; }
+        const Snapshot* operator->() const noexcept { return &m_slot->snapshot; }
+        const Snapshot& operator*() const noexcept { return m_slot->snapshot; }
+
+        explicit operator bool() const noexcept { return m_slot != nullptr; }
+    };
+
    private:
     size_t m_reserveSize;
 
     // Thread-local write buffer (single producer, no locking needed)
     std::vector<T> m_writeBuffer;
 
-    // Shared snapshot pointer protected by mutex
-    mutable std::mutex m_snapshotMutex;
-    std::shared_ptr<Snapshot> m_currentSnapshot;
+    mutable std::atomic<uint64_t> m_current{0};
+    std::atomic<Slot*> m_chunks[k_maxChunks] = {};
+
+    // Producer only
+    uint32_t m_slotCount = 0;
+    uint32_t m_nextScan = 0;
 
     // Atomic flag indicating if any data has been published
     std::atomic<bool> m_hasData;
 
    public:
     explicit SPMCSnapshotBuffer(size_t _reserveSize = 1024)
-        : m_reserveSize(_reserveSize),
-          m_currentSnapshot(std::make_shared<Snapshot>()),
-          m_hasData(false)
+        : m_reserveSize(_reserveSize), m_hasData(false)
     {
         m_writeBuffer.reserve(_reserveSize);
+
+        // Slot 0 is the empty snapshot, current until the first publish
+        addSlot();
+    }
+
+    ~SPMCSnapshotBuffer()
+    {
+        for (uint32_t chunk = 0; chunk < k_maxChunks; ++chunk)
+        {
+            delete[] m_chunks[chunk].load(std::memory_order_relaxed);
+        }
     }
 
    public:
@@ -105,31 +212,37 @@ class SPMCSnapshotBuffer
             return false;
         }
 
-        // Create new snapshot from write buffer
-        auto new_snapshot = std::make_shared<Snapshot>(m_writeBuffer);
-
-        // Thread-safe swap of the snapshot pointer
-        {
-            std::lock_guard<std::mutex> lock(m_snapshotMutex);
-            m_currentSnapshot = new_snapshot;
-            m_hasData.store(true, std::memory_order_release);
-        }
+        // Hand the write buffer over, and take back the storage of a snapshot nobody reads
+        Slot& slot = acquireFreeSlot();
+        slot.snapshot.m_data.swap(m_writeBuffer);
+        slot.retired = false;
 
-        // Clear write buffer for next batch
         m_writeBuffer.clear();
-        m_writeBuffer.reserve(m_reserveSize);
+        if (m_writeBuffer.capacity() < m_reserveSize) m_writeBuffer.reserve(m_reserveSize);
+
+        const uint64_t previous =
+            m_current.exchange(uint64_t(slot.index) << k_indexShift, std::memory_order_acq_rel);
+
+        // The readers still on the previous slot release it there
+        Slot& previousSlot = slotAt(uint32_t(previous >> k_indexShift));
+        previousSlot.releasedCount.fetch_sub(int64_t(previous & k_countMask),
+                                             std::memory_order_relaxed);
+        previousSlot.retired = true;
+
+        m_hasData.store(true, std::memory_order_release);
 
         return true;
     }
 
     /**
-     * Get the current snapshot (thread-safe, returns immutable view)
+     * Get the current snapshot (wait-free, returns immutable view)
      * Multiple consumers can call this concurrently
      */
-    std::shared_ptr<Snapshot> getSnapshot() const
+    SnapshotPtr getSnapshot() const
     {
-        std::lock_guard<std::mutex> lock(m_snapshotMutex);
-        return m_currentSnapshot;
+        const uint64_t current = m_current.fetch_add(1, std::memory_order_acquire);
+
+        return SnapshotPtr(this, &slotAt(uint32_t(current >> k_indexShift)));
     }
 
     /**
@@ -155,6 +268,76 @@ class SPMCSnapshotBuffer
      * @note MUST be called only from the producer thread
      */
     void clear() { m_writeBuffer.clear(); }
+
+    /**
+     * Get the number of snapshot slots, two plus the old snapshots readers held on to at once
+     * @note MUST be called only from the producer thread
+     */
+    size_t getSlotCount() const { return m_slotCount; }
+
+   private:
+    Slot& slotAt(uint32_t _index) const noexcept
+    {
+        const auto chunk = uint32_t(std::bit_width(uint64_t(_index) + 1) - 1);
+        const uint64_t offset = uint64_t(_index) + 1 - (uint64_t(1) << chunk);
+
+        return m_chunks[chunk].load(std::memory_order_acquire)[offset];
+    }
+
+    Slot& addSlot()
+    {
+        const uint32_t index = m_slotCount;
+        const auto chunk = uint32_t(std::bit_width(uint64_t(index) + 1) - 1);
+
+        // The first slot of a chunk allocates it
+        if (uint64_t(index) + 1 == (uint64_t(1) << chunk))
+        {
+            if (chunk == k_maxChunks) throw std::length_error("SPMCSnapshotBuffer: too many slots");
+
+            m_chunks[chunk].store(new Slot[size_t(1) << chunk], std::memory_order_release);
+        }
+
+        Slot& slot = slotAt(index);
+        slot.index = index;
+        ++m_slotCount;
+
+        return slot;
+    }
+
+    Slot& acquireFreeSlot()
+    {
+        // Usually the slot replaced by the previous publish, found first
+        for (uint32_t i = 0; i < m_slotCount; ++i)
+        {
+            Slot& slot = slotAt((m_nextScan + i) % m_slotCount);
+            if (slot.retired && slot.releasedCount.load(std::memory_order_acquire) == 0)
+            {
+                m_nextScan = (slot.index + 1) % m_slotCount;
+                return slot;
+            }
+        }
+
+        return addSlot();
+    }
+
+    void release(Slot& _slot) const noexcept
+    {
+        const uint64_t index = uint64_t(_slot.index) << k_indexShift;
+
+        // The slot cannot be recycled while referenced, a matching index is still the same
+        // publication and the reference is in its count
+        uint64_t current = m_current.load(std::memory_order_relaxed);
+        while ((current & ~k_countMask) == index)
+        {
+            if (m_current.compare_exchange_weak(current, current - 1, std::memory_order_release,
+                                                std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+
+        _slot.releasedCount.fetch_add(1, std::memory_order_release);
+    }
 };
 
 /**
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <bit>
+#include <array>
+#include <cstdint>
+#include <cassert>
+#include <type_traits>
+
+#include <pieces/intrinsics/simd.hpp>
+
+namespace pieces
+{
+
+/**
+ * @brief A fixed-capacity BitSet that stores its words inline.
+ *
+ * Mirrors the BitSet interface but never allocates, so construction, copies and comparisons are
+ * just a handful of word operations and every operation is usable in constant expressions.
+ * Subset tests and equality use SIMD when available (AVX/SSE4.1 `testc`, SSE2 and NEON compares).
+ *
+ * @tparam N The number of bits (capacity) of the set.
+ */
+template <size_t N>
+    requires(N > 0)
+class StaticBitSet final
+{
+   public:
+    using Word = uint64_t;
+
+   private:
+    static constexpr size_t BITS_PER_WORD = sizeof(Word) * 8;
+    static constexpr size_t WORD_MASK = BITS_PER_WORD - 1;
+    static constexpr size_t WORD_SHIFT = 6;
+    static constexpr size_t WORD_COUNT = (N + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+    // Mask of the valid bits in the last word (padding bits must always stay clear).
+    static constexpr Word LAST_WORD_MASK =
+        N % BITS_PER_WORD == 0 ? ~Word(0) : (Word(1) << (N % BITS_PER_WORD)) - 1;
+
+    // Align to a full vector register when the word count allows it
+    static constexpr size_t WORD_ALIGNMENT = WORD_COUNT % 4 == 0   ? 32
+                                             : WORD_COUNT % 2 == 0 ? 16
+                                                                   : alignof(Word);
+
+    alignas(WORD_ALIGNMENT) std::array<Word, WORD_COUNT> m_words{};
+
+   public:
+    constexpr StaticBitSet() noexcept = default;
+
+    /**
+     * @brief Constructs an empty set, the size argument only exists for BitSet compatibility.
+     *
+     * @param _size The requested number of bits (must not exceed N).
+     */
+    constexpr explicit StaticBitSet(size_t _size) noexcept
+    {
+        assert(_size <= N && "StaticBitSet capacity exceeded");
+        (void)_size;
+    }
+
+   public:
+    // Sets the bit at the specified index to 1 (true).
+    constexpr void setBit(size_t _index) noexcept
+    {
+        assert(_index < N && "Index out of bounds");
+        m_words[_index >> WORD_SHIFT] |= (Word(1) << (_index & WORD_MASK));
+    }
+
+    // Clears the bit at the specified index (sets it to 0).
+    constexpr void clearBit(size_t _index) noexcept
+    {
+        assert(_index < N && "Index out of bounds");
+        m_words[_index >> WORD_SHIFT] &= ~(Word(1) << (_index & WORD_MASK));
+    }
+
+    // Tests if the bit at the specified index is set (1) or not (0).
+    [[nodiscard]] constexpr bool testBit(size_t _index) const noexcept
+    {
+        assert(_index < N && "Index out of bounds");
+        return (m_words[_index >> WORD_SHIFT] & (Word(1) << (_index & WORD_MASK))) != 0;
+    }
+
+    // Flips the bit at the specified index (0 to 1 or 1 to 0).
+    constexpr void flipBit(size_t _index) noexcept
+    {
+        assert(_index < N && "Index out of bounds");
+        m_words[_index >> WORD_SHIFT] ^= (Word(1) << (_index & WORD_MASK));
+    }
+
+    /**
+     * @brief Finds the index of the first set bit (1) starting from a given index.
+     *
+     * @param _startIndex The index to start searching from.
+     * @return size_t The index of the first set bit found, or size() if none is found.
+     */
+    [[nodiscard]] constexpr size_t findFirstSetFrom(size_t _startIndex) const noexcept
+    {
+        if (_startIndex >= N) return N;
+
+        size_t wordIdx = _startIndex >> WORD_SHIFT;
+        Word word = m_words[wordIdx] & (~Word(0) << (_startIndex & WORD_MASK));
+
+        while (true)
+        {
+            if (word != 0) return wordIdx * BITS_PER_WORD + std::countr_zero(word);
+            if (++wordIdx == WORD_COUNT) return N;
+            word = m_words[wordIdx];
+        }
+    }
+
+    // Finds the index of the first set bit (1), or size() if none is found.
+    [[nodiscard]] constexpr size_t findFirstSet() const noexcept { return findFirstSetFrom(0); }
+
+    // Finds the index of the first clear bit (0), or size() if none is found.
+    [[nodiscard]] constexpr size_t findFirstClear() const noexcept
+    {
+        for (size_t i = 0; i < WORD_COUNT; ++i)
+        {
+            if (m_words[i] != ~Word(0))
+            {
+                const size_t result = i * BITS_PER_WORD + std::countr_one(m_words[i]);
+                return result < N ? result : N;
+            }
+        }
+
+        return N;
+    }
+
+    // Counts the number of set bits (1s).
+    [[nodiscard]] constexpr size_t popcount() const noexcept
+    {
+        size_t count = 0;
+        for (Word word : m_words) count += std::popcount(word);
+        return count;
+    }
+
+    // Sets all the bits to 1s (true).
+    constexpr void setAll() noexcept
+    {
+        m_words.fill(~Word(0));
+        m_words[WORD_COUNT - 1] &= LAST_WORD_MASK;
+    }
+
+    // Clears all the bits to 0s (false).
+    constexpr void clearAll() noexcept { m_words.fill(0); }
+
+    // Returns the number of bits in the set.
+    [[nodiscard]] static constexpr size_t size() noexcept { return N; }
+
+    // Checks if the set is empty (all bits are 0).
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+        Word merged = 0;
+        for (Word word : m_words) merged |= word;
+        return merged == 0;
+    }
+
+    // Checks if the set is not empty (at least one bit is 1).
+    [[nodiscard]] constexpr bool any() const noexcept { return !empty(); }
+
+    // Checks if the set has no bits set (all bits are 0).
+    [[nodiscard]] constexpr bool none() const noexcept { return empty(); }
+
+    // Alias for popcount to match common terminology.
+    [[nodiscard]] constexpr size_t count() const noexcept { return popcount(); }
+
+    // Returns a pointer to the underlying data (array of Words).
+    [[nodiscard]] constexpr const Word* data() const noexcept { return m_words.data(); }
+
+    // Returns the number of words used to store the bits.
+    [[nodiscard]] static constexpr size_t wordCount() noexcept { return WORD_COUNT; }
+
+    /**
+     * @brief Checks whether every bit set in _other is also set in this set.
+     *
+     * This is the archetype matching primitive: `sig.containsAll(query)` replaces
+     * `(sig & query) == query` without materializing a temporary.
+     */
+    [[nodiscard]] constexpr bool containsAll(const StaticBitSet& _other) const noexcept
+    {
+        if (!std::is_constant_evaluated())
+        {
+#if defined(SIMD_X86_AVX) || defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+            if constexpr (WORD_COUNT % 4 == 0)
+            {
+                for (size_t i = 0; i < WORD_COUNT; i += 4)
+                {
+                    const __m256i a =
+                        _mm256_load_si256(reinterpret_cast<const __m256i*>(&m_words[i]));
+                    const __m256i b =
+                        _mm256_load_si256(reinterpret_cast<const __m256i*>(&_other.m_words[i]));
+                    if (!_mm256_testc_si256(a, b)) return false;
+                }
+
+                return true;
+            }
+#endif
+#if defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || defined(SIMD_X86_AVX2) || \
+    defined(SIMD_X86_AVX512F)
+            if constexpr (WORD_COUNT % 2 == 0)
+            {
+                for (size_t i = 0; i < WORD_COUNT; i += 2)
+                {
+                    const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(&m_words[i]));
+                    const __m128i b =
+                        _mm_load_si128(reinterpret_cast<const __m128i*>(&_other.m_words[i]));
+                    if (!_mm_testc_si128(a, b)) return false;
+                }
+
+                return true;
+            }
+#elif defined(SIMD_X86_SSE2)
+            if constexpr (WORD_COUNT % 2 == 0)
+            {
+                for (size_t i = 0; i < WORD_COUNT; i += 2)
+                {
+                    const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(&m_words[i]));
+                    const __m128i b =
+                        _mm_load_si128(reinterpret_cast<const __m128i*>(&_other.m_words[i]));
+                    const __m128i eq = _mm_cmpeq_epi8(_mm_and_si128(a, b), b);
+                    if (_mm_movemask_epi8(eq) != 0xFFFF) return false;
+                }
+
+                return true;
+            }
+#elif defined(SIMD_ARM_NEON)
+            if constexpr (WORD_COUNT % 2 == 0)
+            {
+                for (size_t i = 0; i < WORD_COUNT; i += 2)
+                {
+                    const uint64x2_t a = vld1q_u64(&m_words[i]);
+                    const uint64x2_t b = vld1q_u64(&_other.m_words[i]);
+                    const uint64x2_t missing = vbicq_u64(b, a); // b & ~a
+                    if ((vgetq_lane_u64(missing, 0) | vgetq_lane_u64(missing, 1)) != 0)
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+#endif
+        }
+
+        Word missing = 0;
+        for (size_t i = 0; i < WORD_COUNT; ++i) missing |= _other.m_words[i] & ~m_words[i];
+        return missing == 0;
+    }
+
+    // Checks whether every bit set in this set is also set in _other.
+    [[nodiscard]] constexpr bool isSubsetOf(const StaticBitSet& _other) const noexcept
+    {
+        return _other.containsAll(*this);
+    }
+
+    // Checks whether at least one bit is set in both sets.
+    [[nodiscard]] constexpr bool intersects(const StaticBitSet& _other) const noexcept
+    {
+        Word common = 0;
+        for (size_t i = 0; i < WORD_COUNT; ++i) common |= m_words[i] & _other.m_words[i];
+        return common != 0;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const StaticBitSet& _other) const noexcept
+    {
+        if (!std::is_constant_evaluated())
+        {
+#if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
+    defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+            if constexpr (WORD_COUNT % 2 == 0)
+            {
+                for (size_t i = 0; i < WORD_COUNT; i += 2)
+                {
+                    const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(&m_words[i]));
+                    const __m128i b =
+                        _mm_load_si128(reinterpret_cast<const __m128i*>(&_other.m_words[i]));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) return false;
+                }
+
+                return true;
+            }
+#endif
+        }
+
+        Word diff = 0;
+        for (size_t i = 0; i < WORD_COUNT; ++i) diff |= m_words[i] ^ _other.m_words[i];
+        return diff == 0;
+    }
+
+    [[nodiscard]] constexpr bool operator!=(const StaticBitSet& _other) const noexcept
+    {
+        return !(*this == _other);
+    }
+
+    // Bitwise AND operation between two sets.
+    [[nodiscard]] constexpr StaticBitSet operator&(const StaticBitSet& _other) const noexcept
+    {
+        StaticBitSet result = *this;
+        result &= _other;
+        return result;
+    }
+
+    // Bitwise OR operation between two sets.
+    [[nodiscard]] constexpr StaticBitSet operator|(const StaticBitSet& _other) const noexcept
+    {
+        StaticBitSet result = *this;
+        result |= _other;
+        return result;
+    }
+
+    // Bitwise XOR operation between two sets.
+    [[nodiscard]] constexpr StaticBitSet operator^(const StaticBitSet& _other) const noexcept
+    {
+        StaticBitSet result = *this;
+        result ^= _other;
+        return result;
+    }
+
+    // In-place AND, the BitSet spelling of operator&=.
+    constexpr StaticBitSet& andWith(const StaticBitSet& _other) noexcept { return *this &= _other; }
+
+    // In-place OR, the BitSet spelling of operator|=.
+    constexpr StaticBitSet& orWith(const StaticBitSet& _other) noexcept { return *this |= _other; }
+
+    // Compound assignment bitwise AND operation.
+    constexpr StaticBitSet& operator&=(const StaticBitSet& _other) noexcept
+    {
+        for (size_t i = 0; i < WORD_COUNT; ++i) m_words[i] &= _other.m_words[i];
+        return *this;
+    }
+
+    // Compound assignment bitwise OR operation.
+    constexpr StaticBitSet& operator|=(const StaticBitSet& _other) noexcept
+    {
+        for (size_t i = 0; i < WORD_COUNT; ++i) m_words[i] |= _other.m_words[i];
+        return *this;
+    }
+
+    // Compound assignment bitwise XOR operation.
+    constexpr StaticBitSet& operator^=(const StaticBitSet& _other) noexcept
+    {
+        for (size_t i = 0; i < WORD_COUNT; ++i) m_words[i] ^= _other.m_words[i];
+        return *this;
+    }
+};
+
+} // namespace pieces
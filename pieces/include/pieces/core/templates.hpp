@@ -5,6 +5,7 @@
 #include <ranges>
 #include <iterator>
 #include <utility>
+#include <functional>
 #include <string>
 #include <string_view>
 
@@ -1,5 +1,10 @@
 #pragma once
 
+// WebAssembly SIMD is enabled per target by -msimd128, not by a per-file level
+#if defined(__wasm_simd128__) && !defined(SIMD_WASM_SIMD128)
+#define SIMD_WASM_SIMD128
+#endif
+
 #if defined(SIMD_X86_AVX512F)
 #include <immintrin.h>
 #define SIMD_LEVEL_NAME "AVX-512F"
@@ -18,6 +23,9 @@
 #elif defined(SIMD_ARM_NEON)
 #include <arm_neon.h>
 #define SIMD_LEVEL_NAME "NEON"
+#elif defined(SIMD_WASM_SIMD128)
+#include <wasm_simd128.h>
+#define SIMD_LEVEL_NAME "WASM-SIMD128"
 #else
 #define SIMD_LEVEL_NAME "SCALAR"
 #endif
@@ -49,10 +57,12 @@
 #define SIMD_RESTRICT __restrict__
 #endif
 
-// Prefetch hint (only valid on x86; no-op elsewhere)
+// Prefetch hint (x86, or the GCC/Clang builtin elsewhere; no-op otherwise)
 #if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
     defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
 #define SIMD_PREFETCH(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
+#elif defined(__GNUC__) || defined(__clang__)
+#define SIMD_PREFETCH(addr) __builtin_prefetch(addr)
 #else
 #define SIMD_PREFETCH(addr) ((void)0)
 #endif
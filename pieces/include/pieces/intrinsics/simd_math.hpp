@@ -0,0 +1,1518 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include <pieces/intrinsics/simd.hpp>
+
+// The fused multiply-adds are in the AVX header, whichever level the file is built for
+#if defined(__FMA__) &&                                                        \
+    (defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
+     defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F))
+#include <immintrin.h>
+#endif
+
+namespace pieces
+{
+namespace simd
+{
+namespace detail
+{
+
+/**
+ * @brief The primitives of 4 float lanes, one implementation per instruction set; everything else
+ * in this header is written on top of them.
+ *
+ * The x86 path only needs SSE2 (every x86 level implies it), the NEON path assumes AArch64.
+ */
+struct Float4Ops
+{
+#if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
+    defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+
+    using Native = __m128;
+
+    static SIMD_FORCE_INLINE Native set(float _x, float _y, float _z, float _w) noexcept
+    {
+        return _mm_setr_ps(_x, _y, _z, _w);
+    }
+
+    static SIMD_FORCE_INLINE Native splat(float _s) noexcept { return _mm_set1_ps(_s); }
+    static SIMD_FORCE_INLINE Native load(const float* _p) noexcept { return _mm_loadu_ps(_p); }
+    static SIMD_FORCE_INLINE void store(float* _p, Native _v) noexcept { _mm_storeu_ps(_p, _v); }
+
+    static SIMD_FORCE_INLINE Native add(Native _a, Native _b) noexcept
+    {
+        return _mm_add_ps(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native sub(Native _a, Native _b) noexcept
+    {
+        return _mm_sub_ps(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native mul(Native _a, Native _b) noexcept
+    {
+        return _mm_mul_ps(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native div(Native _a, Native _b) noexcept
+    {
+        return _mm_div_ps(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native min(Native _a, Native _b) noexcept
+    {
+        return _mm_min_ps(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native max(Native _a, Native _b) noexcept
+    {
+        return _mm_max_ps(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native sqrt(Native _v) noexcept { return _mm_sqrt_ps(_v); }
+
+    static SIMD_FORCE_INLINE Native abs(Native _v) noexcept
+    {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), _v);
+    }
+
+    // _a * _b + _c, fused where the target has FMA
+    static SIMD_FORCE_INLINE Native mulAdd(Native _a, Native _b, Native _c) noexcept
+    {
+#if defined(__FMA__)
+        return _mm_fmadd_ps(_a, _b, _c);
+#else
+        return _mm_add_ps(_mm_mul_ps(_a, _b), _c);
+#endif
+    }
+
+    template <int Lane>
+    static SIMD_FORCE_INLINE Native splatLane(Native _v) noexcept
+    {
+        return _mm_shuffle_ps(_v, _v, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+    }
+
+    // (y, z, x, w)
+    static SIMD_FORCE_INLINE Native yzxw(Native _v) noexcept
+    {
+        return _mm_shuffle_ps(_v, _v, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    static SIMD_FORCE_INLINE float first(Native _v) noexcept { return _mm_cvtss_f32(_v); }
+
+    // The sum of the 4 lanes, in every lane
+    static SIMD_FORCE_INLINE Native sumLanes(Native _v) noexcept
+    {
+        const Native pairs = _mm_add_ps(_v, _mm_shuffle_ps(_v, _v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_add_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+
+    static SIMD_FORCE_INLINE void transpose(Native& _a, Native& _b, Native& _c, Native& _d) noexcept
+    {
+        _MM_TRANSPOSE4_PS(_a, _b, _c, _d);
+    }
+
+#elif defined(SIMD_ARM_NEON)
+
+    using Native = float32x4_t;
+
+    static SIMD_FORCE_INLINE Native set(float _x, float _y, float _z, float _w) noexcept
+    {
+        const float lanes[4] = {_x, _y, _z, _w};
+        return vld1q_f32(lanes);
+    }
+
+    static SIMD_FORCE_INLINE Native splat(float _s) noexcept { return vdupq_n_f32(_s); }
+    static SIMD_FORCE_INLINE Native load(const float* _p) noexcept { return vld1q_f32(_p); }
+    static SIMD_FORCE_INLINE void store(float* _p, Native _v) noexcept { vst1q_f32(_p, _v); }
+
+    static SIMD_FORCE_INLINE Native add(Native _a, Native _b) noexcept { return vaddq_f32(_a, _b); }
+    static SIMD_FORCE_INLINE Native sub(Native _a, Native _b) noexcept { return vsubq_f32(_a, _b); }
+    static SIMD_FORCE_INLINE Native mul(Native _a, Native _b) noexcept { return vmulq_f32(_a, _b); }
+    static SIMD_FORCE_INLINE Native div(Native _a, Native _b) noexcept { return vdivq_f32(_a, _b); }
+    static SIMD_FORCE_INLINE Native min(Native _a, Native _b) noexcept { return vminq_f32(_a, _b); }
+    static SIMD_FORCE_INLINE Native max(Native _a, Native _b) noexcept { return vmaxq_f32(_a, _b); }
+    static SIMD_FORCE_INLINE Native sqrt(Native _v) noexcept { return vsqrtq_f32(_v); }
+    static SIMD_FORCE_INLINE Native abs(Native _v) noexcept { return vabsq_f32(_v); }
+
+    static SIMD_FORCE_INLINE Native mulAdd(Native _a, Native _b, Native _c) noexcept
+    {
+        return vfmaq_f32(_c, _a, _b);
+    }
+
+    template <int Lane>
+    static SIMD_FORCE_INLINE Native splatLane(Native _v) noexcept
+    {
+        return vdupq_laneq_f32(_v, Lane);
+    }
+
+    static SIMD_FORCE_INLINE Native yzxw(Native _v) noexcept
+    {
+        // (y, z, w, x), then x and w back into place
+        const Native rotated = vextq_f32(_v, _v, 1);
+        return vcopyq_laneq_f32(vcopyq_laneq_f32(rotated, 2, _v, 0), 3, _v, 3);
+    }
+
+    static SIMD_FORCE_INLINE float first(Native _v) noexcept { return vgetq_lane_f32(_v, 0); }
+    static SIMD_FORCE_INLINE Native sumLanes(Native _v) noexcept { return splat(vaddvq_f32(_v)); }
+
+    static SIMD_FORCE_INLINE void transpose(Native& _a, Native& _b, Native& _c, Native& _d) noexcept
+    {
+        const float32x4x2_t ab = vtrnq_f32(_a, _b); // a0 b0 a2 b2, a1 b1 a3 b3
+        const float32x4x2_t cd = vtrnq_f32(_c, _d); // c0 d0 c2 d2, c1 d1 c3 d3
+
+        _a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        _b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        _c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        _d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+
+#elif defined(SIMD_WASM_SIMD128)
+
+    using Native = v128_t;
+
+    static SIMD_FORCE_INLINE Native set(float _x, float _y, float _z, float _w) noexcept
+    {
+        return wasm_f32x4_make(_x, _y, _z, _w);
+    }
+
+    static SIMD_FORCE_INLINE Native splat(float _s) noexcept { return wasm_f32x4_splat(_s); }
+    static SIMD_FORCE_INLINE Native load(const float* _p) noexcept { return wasm_v128_load(_p); }
+    static SIMD_FORCE_INLINE void store(float* _p, Native _v) noexcept { wasm_v128_store(_p, _v); }
+
+    static SIMD_FORCE_INLINE Native add(Native _a, Native _b) noexcept
+    {
+        return wasm_f32x4_add(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native sub(Native _a, Native _b) noexcept
+    {
+        return wasm_f32x4_sub(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native mul(Native _a, Native _b) noexcept
+    {
+        return wasm_f32x4_mul(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native div(Native _a, Native _b) noexcept
+    {
+        return wasm_f32x4_div(_a, _b);
+    }
+
+    // Swapped pmin/pmax match the x86 and scalar semantics: the second operand on NaN
+    static SIMD_FORCE_INLINE Native min(Native _a, Native _b) noexcept
+    {
+        return wasm_f32x4_pmin(_b, _a);
+    }
+
+    static SIMD_FORCE_INLINE Native max(Native _a, Native _b) noexcept
+    {
+        return wasm_f32x4_pmax(_b, _a);
+    }
+
+    static SIMD_FORCE_INLINE Native sqrt(Native _v) noexcept { return wasm_f32x4_sqrt(_v); }
+    static SIMD_FORCE_INLINE Native abs(Native _v) noexcept { return wasm_f32x4_abs(_v); }
+
+    static SIMD_FORCE_INLINE Native mulAdd(Native _a, Native _b, Native _c) noexcept
+    {
+        return wasm_f32x4_add(wasm_f32x4_mul(_a, _b), _c);
+    }
+
+    template <int Lane>
+    static SIMD_FORCE_INLINE Native splatLane(Native _v) noexcept
+    {
+        return wasm_i32x4_shuffle(_v, _v, Lane, Lane, Lane, Lane);
+    }
+
+    static SIMD_FORCE_INLINE Native yzxw(Native _v) noexcept
+    {
+        return wasm_i32x4_shuffle(_v, _v, 1, 2, 0, 3);
+    }
+
+    static SIMD_FORCE_INLINE float first(Native _v) noexcept
+    {
+        return wasm_f32x4_extract_lane(_v, 0);
+    }
+
+    static SIMD_FORCE_INLINE Native sumLanes(Native _v) noexcept
+    {
+        const Native pairs = wasm_f32x4_add(_v, wasm_i32x4_shuffle(_v, _v, 1, 0, 3, 2));
+        return wasm_f32x4_add(pairs, wasm_i32x4_shuffle(pairs, pairs, 2, 3, 0, 1));
+    }
+
+    static SIMD_FORCE_INLINE void transpose(Native& _a, Native& _b, Native& _c, Native& _d) noexcept
+    {
+        const Native ab01 = wasm_i32x4_shuffle(_a, _b, 0, 4, 1, 5);
+        const Native cd01 = wasm_i32x4_shuffle(_c, _d, 0, 4, 1, 5);
+        const Native ab23 = wasm_i32x4_shuffle(_a, _b, 2, 6, 3, 7);
+        const Native cd23 = wasm_i32x4_shuffle(_c, _d, 2, 6, 3, 7);
+
+        _a = wasm_i32x4_shuffle(ab01, cd01, 0, 1, 4, 5);
+        _b = wasm_i32x4_shuffle(ab01, cd01, 2, 3, 6, 7);
+        _c = wasm_i32x4_shuffle(ab23, cd23, 0, 1, 4, 5);
+        _d = wasm_i32x4_shuffle(ab23, cd23, 2, 3, 6, 7);
+    }
+
+#else
+
+    struct Native
+    {
+        float lanes[4];
+    };
+
+    template <typename Func>
+    static SIMD_FORCE_INLINE Native map(Native _a, Native _b, Func&& _func) noexcept
+    {
+        return {{_func(_a.lanes[0], _b.lanes[0]), _func(_a.lanes[1], _b.lanes[1]),
+                 _func(_a.lanes[2], _b.lanes[2]), _func(_a.lanes[3], _b.lanes[3])}};
+    }
+
+    static SIMD_FORCE_INLINE Native set(float _x, float _y, float _z, float _w) noexcept
+    {
+        return {{_x, _y, _z, _w}};
+    }
+
+    static SIMD_FORCE_INLINE Native splat(float _s) noexcept { return {{_s, _s, _s, _s}}; }
+    static SIMD_FORCE_INLINE Native load(const float* _p) noexcept
+    {
+        return {{_p[0], _p[1], _p[2], _p[3]}};
+    }
+
+    static SIMD_FORCE_INLINE void store(float* _p, Native _v) noexcept
+    {
+        for (int i = 0; i < 4; ++i) _p[i] = _v.lanes[i];
+    }
+
+    static SIMD_FORCE_INLINE Native add(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](float _l, float _r) { return _l + _r; });
+    }
+
+    static SIMD_FORCE_INLINE Native sub(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](float _l, float _r) { return _l - _r; });
+    }
+
+    static SIMD_FORCE_INLINE Native mul(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](float _l, float _r) { return _l * _r; });
+    }
+
+    static SIMD_FORCE_INLINE Native div(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](float _l, float _r) { return _l / _r; });
+    }
+
+    // As minps/maxps: the second operand unless the first compares less (greater)
+    static SIMD_FORCE_INLINE Native min(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](float _l, float _r) { return _l < _r ? _l : _r; });
+    }
+
+    static SIMD_FORCE_INLINE Native max(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](float _l, float _r) { return _l > _r ? _l : _r; });
+    }
+
+    static SIMD_FORCE_INLINE Native sqrt(Native _v) noexcept
+    {
+        return map(_v, _v, [](float _l, float) { return std::sqrt(_l); });
+    }
+
+    static SIMD_FORCE_INLINE Native abs(Native _v) noexcept
+    {
+        return map(_v, _v, [](float _l, float) { return std::fabs(_l); });
+    }
+
+    static SIMD_FORCE_INLINE Native mulAdd(Native _a, Native _b, Native _c) noexcept
+    {
+        return add(mul(_a, _b), _c);
+    }
+
+    template <int Lane>
+    static SIMD_FORCE_INLINE Native splatLane(Native _v) noexcept
+    {
+        return splat(_v.lanes[Lane]);
+    }
+
+    static SIMD_FORCE_INLINE Native yzxw(Native _v) noexcept
+    {
+        return {{_v.lanes[1], _v.lanes[2], _v.lanes[0], _v.lanes[3]}};
+    }
+
+    static SIMD_FORCE_INLINE float first(Native _v) noexcept { return _v.lanes[0]; }
+
+    static SIMD_FORCE_INLINE Native sumLanes(Native _v) noexcept
+    {
+        return splat((_v.lanes[0] + _v.lanes[1]) + (_v.lanes[2] + _v.lanes[3]));
+    }
+
+    static SIMD_FORCE_INLINE void transpose(Native& _a, Native& _b, Native& _c, Native& _d) noexcept
+    {
+        Native* rows[4] = {&_a, &_b, &_c, &_d};
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = i + 1; j < 4; ++j) std::swap(rows[i]->lanes[j], rows[j]->lanes[i]);
+        }
+    }
+
+#endif
+};
+
+/**
+ * @brief The primitives of 4 int32 lanes. Comparisons return masks of all ones or all zeros.
+ */
+struct Int4Ops
+{
+#if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
+    defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+
+    using Native = __m128i;
+
+    static SIMD_FORCE_INLINE Native set(int32_t _x, int32_t _y, int32_t _z, int32_t _w) noexcept
+    {
+        return _mm_setr_epi32(_x, _y, _z, _w);
+    }
+
+    static SIMD_FORCE_INLINE Native splat(int32_t _s) noexcept { return _mm_set1_epi32(_s); }
+
+    static SIMD_FORCE_INLINE Native load(const int32_t* _p) noexcept
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(_p));
+    }
+
+    static SIMD_FORCE_INLINE void store(int32_t* _p, Native _v) noexcept
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_p), _v);
+    }
+
+    static SIMD_FORCE_INLINE Native add(Native _a, Native _b) noexcept
+    {
+        return _mm_add_epi32(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native sub(Native _a, Native _b) noexcept
+    {
+        return _mm_sub_epi32(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native mul(Native _a, Native _b) noexcept
+    {
+#if defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || defined(SIMD_X86_AVX2) || \
+    defined(SIMD_X86_AVX512F)
+        return _mm_mullo_epi32(_a, _b);
+#else
+        // The low halves of the 64-bit products of the even, then the odd lanes
+        const __m128i even = _mm_mul_epu32(_a, _b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(_a, 32), _mm_srli_epi64(_b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+
+    static SIMD_FORCE_INLINE Native bitAnd(Native _a, Native _b) noexcept
+    {
+        return _mm_and_si128(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native bitOr(Native _a, Native _b) noexcept
+    {
+        return _mm_or_si128(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native bitXor(Native _a, Native _b) noexcept
+    {
+        return _mm_xor_si128(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native equal(Native _a, Native _b) noexcept
+    {
+        return _mm_cmpeq_epi32(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native greater(Native _a, Native _b) noexcept
+    {
+        return _mm_cmpgt_epi32(_a, _b);
+    }
+
+    template <int Bits>
+    static SIMD_FORCE_INLINE Native shiftLeft(Native _v) noexcept
+    {
+        return _mm_slli_epi32(_v, Bits);
+    }
+
+    template <int Bits>
+    static SIMD_FORCE_INLINE Native shiftRight(Native _v) noexcept
+    {
+        return _mm_srai_epi32(_v, Bits);
+    }
+
+    // One bit per lane, set where the lane's top bit is
+    static SIMD_FORCE_INLINE uint32_t signBits(Native _v) noexcept
+    {
+        return uint32_t(_mm_movemask_ps(_mm_castsi128_ps(_v)));
+    }
+
+    static SIMD_FORCE_INLINE Native fromFloat(Float4Ops::Native _v) noexcept
+    {
+        return _mm_cvttps_epi32(_v);
+    }
+
+    static SIMD_FORCE_INLINE Float4Ops::Native toFloat(Native _v) noexcept
+    {
+        return _mm_cvtepi32_ps(_v);
+    }
+
+    // The bits of a float mask, and back
+    static SIMD_FORCE_INLINE Native fromFloatBits(Float4Ops::Native _v) noexcept
+    {
+        return _mm_castps_si128(_v);
+    }
+
+    static SIMD_FORCE_INLINE Float4Ops::Native toFloatBits(Native _v) noexcept
+    {
+        return _mm_castsi128_ps(_v);
+    }
+
+    static SIMD_FORCE_INLINE Native less(Float4Ops::Native _a, Float4Ops::Native _b) noexcept
+    {
+        return fromFloatBits(_mm_cmplt_ps(_a, _b));
+    }
+
+#elif defined(SIMD_ARM_NEON)
+
+    using Native = int32x4_t;
+
+    static SIMD_FORCE_INLINE Native set(int32_t _x, int32_t _y, int32_t _z, int32_t _w) noexcept
+    {
+        const int32_t lanes[4] = {_x, _y, _z, _w};
+        return vld1q_s32(lanes);
+    }
+
+    static SIMD_FORCE_INLINE Native splat(int32_t _s) noexcept { return vdupq_n_s32(_s); }
+    static SIMD_FORCE_INLINE Native load(const int32_t* _p) noexcept { return vld1q_s32(_p); }
+    static SIMD_FORCE_INLINE void store(int32_t* _p, Native _v) noexcept { vst1q_s32(_p, _v); }
+
+    static SIMD_FORCE_INLINE Native add(Native _a, Native _b) noexcept { return vaddq_s32(_a, _b); }
+    static SIMD_FORCE_INLINE Native sub(Native _a, Native _b) noexcept { return vsubq_s32(_a, _b); }
+    static SIMD_FORCE_INLINE Native mul(Native _a, Native _b) noexcept { return vmulq_s32(_a, _b); }
+
+    static SIMD_FORCE_INLINE Native bitAnd(Native _a, Native _b) noexcept
+    {
+        return vandq_s32(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native bitOr(Native _a, Native _b) noexcept
+    {
+        return vorrq_s32(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native bitXor(Native _a, Native _b) noexcept
+    {
+        return veorq_s32(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native equal(Native _a, Native _b) noexcept
+    {
+        return vreinterpretq_s32_u32(vceqq_s32(_a, _b));
+    }
+
+    static SIMD_FORCE_INLINE Native greater(Native _a, Native _b) noexcept
+    {
+        return vreinterpretq_s32_u32(vcgtq_s32(_a, _b));
+    }
+
+    template <int Bits>
+    static SIMD_FORCE_INLINE Native shiftLeft(Native _v) noexcept
+    {
+        return vshlq_n_s32(_v, Bits);
+    }
+
+    template <int Bits>
+    static SIMD_FORCE_INLINE Native shiftRight(Native _v) noexcept
+    {
+        if constexpr (Bits == 0)
+        {
+            return _v;
+        }
+        else
+        {
+            return vshrq_n_s32(_v, Bits);
+        }
+    }
+
+    static SIMD_FORCE_INLINE uint32_t signBits(Native _v) noexcept
+    {
+        static constexpr int32_t k_shifts[4] = {0, 1, 2, 3};
+
+        const uint32x4_t signs = vshrq_n_u32(vreinterpretq_u32_s32(_v), 31);
+        return vaddvq_u32(vshlq_u32(signs, vld1q_s32(k_shifts)));
+    }
+
+    static SIMD_FORCE_INLINE Native fromFloat(Float4Ops::Native _v) noexcept
+    {
+        return vcvtq_s32_f32(_v);
+    }
+
+    static SIMD_FORCE_INLINE Float4Ops::Native toFloat(Native _v) noexcept
+    {
+        return vcvtq_f32_s32(_v);
+    }
+
+    static SIMD_FORCE_INLINE Native fromFloatBits(Float4Ops::Native _v) noexcept
+    {
+        return vreinterpretq_s32_f32(_v);
+    }
+
+    static SIMD_FORCE_INLINE Float4Ops::Native toFloatBits(Native _v) noexcept
+    {
+        return vreinterpretq_f32_s32(_v);
+    }
+
+    static SIMD_FORCE_INLINE Native less(Float4Ops::Native _a, Float4Ops::Native _b) noexcept
+    {
+        return vreinterpretq_s32_u32(vcltq_f32(_a, _b));
+    }
+
+#elif defined(SIMD_WASM_SIMD128)
+
+    using Native = v128_t;
+
+    static SIMD_FORCE_INLINE Native set(int32_t _x, int32_t _y, int32_t _z, int32_t _w) noexcept
+    {
+        return wasm_i32x4_make(_x, _y, _z, _w);
+    }
+
+    static SIMD_FORCE_INLINE Native splat(int32_t _s) noexcept { return wasm_i32x4_splat(_s); }
+    static SIMD_FORCE_INLINE Native load(const int32_t* _p) noexcept { return wasm_v128_load(_p); }
+
+    static SIMD_FORCE_INLINE void store(int32_t* _p, Native _v) noexcept
+    {
+        wasm_v128_store(_p, _v);
+    }
+
+    static SIMD_FORCE_INLINE Native add(Native _a, Native _b) noexcept
+    {
+        return wasm_i32x4_add(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native sub(Native _a, Native _b) noexcept
+    {
+        return wasm_i32x4_sub(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native mul(Native _a, Native _b) noexcept
+    {
+        return wasm_i32x4_mul(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native bitAnd(Native _a, Native _b) noexcept
+    {
+        return wasm_v128_and(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native bitOr(Native _a, Native _b) noexcept
+    {
+        return wasm_v128_or(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native bitXor(Native _a, Native _b) noexcept
+    {
+        return wasm_v128_xor(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native equal(Native _a, Native _b) noexcept
+    {
+        return wasm_i32x4_eq(_a, _b);
+    }
+
+    static SIMD_FORCE_INLINE Native greater(Native _a, Native _b) noexcept
+    {
+        return wasm_i32x4_gt(_a, _b);
+    }
+
+    template <int Bits>
+    static SIMD_FORCE_INLINE Native shiftLeft(Native _v) noexcept
+    {
+        return wasm_i32x4_shl(_v, Bits);
+    }
+
+    template <int Bits>
+    static SIMD_FORCE_INLINE Native shiftRight(Native _v) noexcept
+    {
+        return wasm_i32x4_shr(_v, Bits);
+    }
+
+    static SIMD_FORCE_INLINE uint32_t signBits(Native _v) noexcept
+    {
+        return wasm_i32x4_bitmask(_v);
+    }
+
+    static SIMD_FORCE_INLINE Native fromFloat(Float4Ops::Native _v) noexcept
+    {
+        return wasm_i32x4_trunc_sat_f32x4(_v);
+    }
+
+    static SIMD_FORCE_INLINE Float4Ops::Native toFloat(Native _v) noexcept
+    {
+        return wasm_f32x4_convert_i32x4(_v);
+    }
+
+    // Both are v128_t
+    static SIMD_FORCE_INLINE Native fromFloatBits(Float4Ops::Native _v) noexcept { return _v; }
+    static SIMD_FORCE_INLINE Float4Ops::Native toFloatBits(Native _v) noexcept { return _v; }
+
+    static SIMD_FORCE_INLINE Native less(Float4Ops::Native _a, Float4Ops::Native _b) noexcept
+    {
+        return wasm_f32x4_lt(_a, _b);
+    }
+
+#else
+
+    struct Native
+    {
+        int32_t lanes[4];
+    };
+
+    template <typename Func>
+    static SIMD_FORCE_INLINE Native map(Native _a, Native _b, Func&& _func) noexcept
+    {
+        return {{_func(_a.lanes[0], _b.lanes[0]), _func(_a.lanes[1], _b.lanes[1]),
+                 _func(_a.lanes[2], _b.lanes[2]), _func(_a.lanes[3], _b.lanes[3])}};
+    }
+
+    static SIMD_FORCE_INLINE Native set(int32_t _x, int32_t _y, int32_t _z, int32_t _w) noexcept
+    {
+        return {{_x, _y, _z, _w}};
+    }
+
+    static SIMD_FORCE_INLINE Native splat(int32_t _s) noexcept { return {{_s, _s, _s, _s}}; }
+
+    static SIMD_FORCE_INLINE Native load(const int32_t* _p) noexcept
+    {
+        return {{_p[0], _p[1], _p[2], _p[3]}};
+    }
+
+    static SIMD_FORCE_INLINE void store(int32_t* _p, Native _v) noexcept
+    {
+        for (int i = 0; i < 4; ++i) _p[i] = _v.lanes[i];
+    }
+
+    // Wrapping, as the vector instructions
+    static SIMD_FORCE_INLINE Native add(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b,
+                   [](int32_t _l, int32_t _r) { return int32_t(uint32_t(_l) + uint32_t(_r)); });
+    }
+
+    static SIMD_FORCE_INLINE Native sub(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b,
+                   [](int32_t _l, int32_t _r) { return int32_t(uint32_t(_l) - uint32_t(_r)); });
+    }
+
+    static SIMD_FORCE_INLINE Native mul(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b,
+                   [](int32_t _l, int32_t _r) { return int32_t(uint32_t(_l) * uint32_t(_r)); });
+    }
+
+    static SIMD_FORCE_INLINE Native bitAnd(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](int32_t _l, int32_t _r) { return _l & _r; });
+    }
+
+    static SIMD_FORCE_INLINE Native bitOr(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](int32_t _l, int32_t _r) { return _l | _r; });
+    }
+
+    static SIMD_FORCE_INLINE Native bitXor(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](int32_t _l, int32_t _r) { return _l ^ _r; });
+    }
+
+    static SIMD_FORCE_INLINE Native equal(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](int32_t _l, int32_t _r) { return _l == _r ? -1 : 0; });
+    }
+
+    static SIMD_FORCE_INLINE Native greater(Native _a, Native _b) noexcept
+    {
+        return map(_a, _b, [](int32_t _l, int32_t _r) { return _l > _r ? -1 : 0; });
+    }
+
+    template <int Bits>
+    static SIMD_FORCE_INLINE Native shiftLeft(Native _v) noexcept
+    {
+        return map(_v, _v, [](int32_t _l, int32_t) { return int32_t(uint32_t(_l) << Bits); });
+    }
+
+    template <int Bits>
+    static SIMD_FORCE_INLINE Native shiftRight(Native _v) noexcept
+    {
+        return map(_v, _v, [](int32_t _l, int32_t) { return _l >> Bits; });
+    }
+
+    static SIMD_FORCE_INLINE uint32_t signBits(Native _v) noexcept
+    {
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; ++i) bits |= uint32_t(_v.lanes[i] < 0) << i;
+
+        return bits;
+    }
+
+    static SIMD_FORCE_INLINE Native fromFloat(Float4Ops::Native _v) noexcept
+    {
+        return {{int32_t(_v.lanes[0]), int32_t(_v.lanes[1]), int32_t(_v.lanes[2]),
+                 int32_t(_v.lanes[3])}};
+    }
+
+    static SIMD_FORCE_INLINE Float4Ops::Native toFloat(Native _v) noexcept
+    {
+        return {{float(_v.lanes[0]), float(_v.lanes[1]), float(_v.lanes[2]), float(_v.lanes[3])}};
+    }
+
+    static SIMD_FORCE_INLINE Native fromFloatBits(Float4Ops::Native _v) noexcept
+    {
+        return std::bit_cast<Native>(_v);
+    }
+
+    static SIMD_FORCE_INLINE Float4Ops::Native toFloatBits(Native _v) noexcept
+    {
+        return std::bit_cast<Float4Ops::Native>(_v);
+    }
+
+    static SIMD_FORCE_INLINE Native less(Float4Ops::Native _a, Float4Ops::Native _b) noexcept
+    {
+        Native mask;
+        for (int i = 0; i < 4; ++i) mask.lanes[i] = _a.lanes[i] < _b.lanes[i] ? -1 : 0;
+
+        return mask;
+    }
+
+#endif
+};
+
+} // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// float4 / int4
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 4 float lanes in a register, the x, y, z and w of a vector (or any 4 values).
+ *
+ * Default construction leaves the lanes uninitialized, as the intrinsic types do.
+ */
+struct float4
+{
+    using Ops = detail::Float4Ops;
+
+    Ops::Native native;
+
+    float4() noexcept = default;
+    SIMD_FORCE_INLINE float4(Ops::Native _native) noexcept : native(_native) {}
+    SIMD_FORCE_INLINE explicit float4(float _s) noexcept : native(Ops::splat(_s)) {}
+    SIMD_FORCE_INLINE float4(float _x, float _y, float _z, float _w) noexcept
+        : native(Ops::set(_x, _y, _z, _w))
+    {
+    }
+
+    [[nodiscard]] static SIMD_FORCE_INLINE float4 zero() noexcept { return float4(0.0f); }
+
+    // Unaligned, 4 floats
+    [[nodiscard]] static SIMD_FORCE_INLINE float4 load(const float* _p) noexcept
+    {
+        return Ops::load(_p);
+    }
+
+    SIMD_FORCE_INLINE void store(float* _p) const noexcept { Ops::store(_p, native); }
+
+    [[nodiscard]] SIMD_FORCE_INLINE float x() const noexcept { return Ops::first(native); }
+    [[nodiscard]] SIMD_FORCE_INLINE float y() const noexcept { return lane<1>(); }
+    [[nodiscard]] SIMD_FORCE_INLINE float z() const noexcept { return lane<2>(); }
+    [[nodiscard]] SIMD_FORCE_INLINE float w() const noexcept { return lane<3>(); }
+
+    template <int Lane>
+        requires(Lane >= 0 && Lane < 4)
+    [[nodiscard]] SIMD_FORCE_INLINE float lane() const noexcept
+    {
+        return Ops::first(Ops::splatLane<Lane>(native));
+    }
+
+    // The value of one lane in all 4
+    template <int Lane>
+        requires(Lane >= 0 && Lane < 4)
+    [[nodiscard]] SIMD_FORCE_INLINE float4 splat() const noexcept
+    {
+        return Ops::splatLane<Lane>(native);
+    }
+
+    SIMD_FORCE_INLINE float4& operator+=(float4 _other) noexcept
+    {
+        native = Ops::add(native, _other.native);
+        return *this;
+    }
+
+    SIMD_FORCE_INLINE float4& operator-=(float4 _other) noexcept
+    {
+        native = Ops::sub(native, _other.native);
+        return *this;
+    }
+
+    SIMD_FORCE_INLINE float4& operator*=(float4 _other) noexcept
+    {
+        native = Ops::mul(native, _other.native);
+        return *this;
+    }
+
+    SIMD_FORCE_INLINE float4& operator/=(float4 _other) noexcept
+    {
+        native = Ops::div(native, _other.native);
+        return *this;
+    }
+
+    SIMD_FORCE_INLINE float4& operator*=(float _s) noexcept { return *this *= float4(_s); }
+};
+
+/**
+ * @brief 4 int32 lanes in a register, also the masks the comparisons return (all bits of a lane
+ * set where it holds).
+ */
+struct int4
+{
+    using Ops = detail::Int4Ops;
+
+    Ops::Native native;
+
+    int4() noexcept = default;
+    SIMD_FORCE_INLINE int4(Ops::Native _native) noexcept : native(_native) {}
+    SIMD_FORCE_INLINE explicit int4(int32_t _s) noexcept : native(Ops::splat(_s)) {}
+    SIMD_FORCE_INLINE int4(int32_t _x, int32_t _y, int32_t _z, int32_t _w) noexcept
+        : native(Ops::set(_x, _y, _z, _w))
+    {
+    }
+
+    [[nodiscard]] static SIMD_FORCE_INLINE int4 load(const int32_t* _p) noexcept
+    {
+        return Ops::load(_p);
+    }
+
+    SIMD_FORCE_INLINE void store(int32_t* _p) const noexcept { Ops::store(_p, native); }
+
+    // Truncated toward zero, and back
+    [[nodiscard]] static SIMD_FORCE_INLINE int4 fromFloat(float4 _v) noexcept
+    {
+        return Ops::fromFloat(_v.native);
+    }
+
+    [[nodiscard]] SIMD_FORCE_INLINE float4 toFloat() const noexcept { return Ops::toFloat(native); }
+
+    // Of a mask: one bit per lane that holds
+    [[nodiscard]] SIMD_FORCE_INLINE uint32_t bits() const noexcept { return Ops::signBits(native); }
+    [[nodiscard]] SIMD_FORCE_INLINE bool any() const noexcept { return bits() != 0; }
+    [[nodiscard]] SIMD_FORCE_INLINE bool all() const noexcept { return bits() == 0xF; }
+};
+
+SIMD_FORCE_INLINE float4 operator+(float4 _a, float4 _b) noexcept
+{
+    return float4::Ops::add(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE float4 operator-(float4 _a, float4 _b) noexcept
+{
+    return float4::Ops::sub(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE float4 operator*(float4 _a, float4 _b) noexcept
+{
+    return float4::Ops::mul(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE float4 operator/(float4 _a, float4 _b) noexcept
+{
+    return float4::Ops::div(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE float4 operator*(float4 _a, float _s) noexcept { return _a * float4(_s); }
+SIMD_FORCE_INLINE float4 operator*(float _s, float4 _a) noexcept { return float4(_s) * _a; }
+SIMD_FORCE_INLINE float4 operator/(float4 _a, float _s) noexcept { return _a / float4(_s); }
+SIMD_FORCE_INLINE float4 operator-(float4 _a) noexcept { return float4::zero() - _a; }
+
+SIMD_FORCE_INLINE int4 operator<(float4 _a, float4 _b) noexcept
+{
+    return int4::Ops::less(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator>(float4 _a, float4 _b) noexcept { return _b < _a; }
+
+SIMD_FORCE_INLINE int4 operator+(int4 _a, int4 _b) noexcept
+{
+    return int4::Ops::add(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator-(int4 _a, int4 _b) noexcept
+{
+    return int4::Ops::sub(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator*(int4 _a, int4 _b) noexcept
+{
+    return int4::Ops::mul(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator&(int4 _a, int4 _b) noexcept
+{
+    return int4::Ops::bitAnd(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator|(int4 _a, int4 _b) noexcept
+{
+    return int4::Ops::bitOr(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator^(int4 _a, int4 _b) noexcept
+{
+    return int4::Ops::bitXor(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator==(int4 _a, int4 _b) noexcept
+{
+    return int4::Ops::equal(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator>(int4 _a, int4 _b) noexcept
+{
+    return int4::Ops::greater(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE int4 operator<(int4 _a, int4 _b) noexcept { return _b > _a; }
+
+template <int Bits>
+    requires(Bits >= 0 && Bits < 32)
+SIMD_FORCE_INLINE int4 shiftLeft(int4 _v) noexcept
+{
+    return int4::Ops::shiftLeft<Bits>(_v.native);
+}
+
+// Arithmetic, the sign is copied in
+template <int Bits>
+    requires(Bits >= 0 && Bits < 32)
+SIMD_FORCE_INLINE int4 shiftRight(int4 _v) noexcept
+{
+    return int4::Ops::shiftRight<Bits>(_v.native);
+}
+
+// The lanes of _a where the mask holds, of _b elsewhere
+SIMD_FORCE_INLINE int4 select(int4 _mask, int4 _a, int4 _b) noexcept
+{
+    return (_mask & _a) | int4::Ops::bitAnd(int4::Ops::bitXor(_mask.native, int4(-1).native),
+                                            _b.native);
+}
+
+SIMD_FORCE_INLINE float4 select(int4 _mask, float4 _a, float4 _b) noexcept
+{
+    const int4 bits = select(_mask, int4(int4::Ops::fromFloatBits(_a.native)),
+                             int4(int4::Ops::fromFloatBits(_b.native)));
+    return int4::Ops::toFloatBits(bits.native);
+}
+
+SIMD_FORCE_INLINE float4 min(float4 _a, float4 _b) noexcept
+{
+    return float4::Ops::min(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE float4 max(float4 _a, float4 _b) noexcept
+{
+    return float4::Ops::max(_a.native, _b.native);
+}
+
+SIMD_FORCE_INLINE float4 abs(float4 _v) noexcept { return float4::Ops::abs(_v.native); }
+SIMD_FORCE_INLINE float4 sqrt(float4 _v) noexcept { return float4::Ops::sqrt(_v.native); }
+
+// _a * _b + _c, fused where the target can
+SIMD_FORCE_INLINE float4 mulAdd(float4 _a, float4 _b, float4 _c) noexcept
+{
+    return float4::Ops::mulAdd(_a.native, _b.native, _c.native);
+}
+
+SIMD_FORCE_INLINE float4 lerp(float4 _a, float4 _b, float _t) noexcept
+{
+    return mulAdd(_b - _a, float4(_t), _a);
+}
+
+// The dot products, in every lane
+SIMD_FORCE_INLINE float4 dotSplat(float4 _a, float4 _b) noexcept
+{
+    return float4::Ops::sumLanes((_a * _b).native);
+}
+
+SIMD_FORCE_INLINE float4 dot3Splat(float4 _a, float4 _b) noexcept
+{
+    return dotSplat(select(int4(-1, -1, -1, 0), _a, float4::zero()), _b);
+}
+
+SIMD_FORCE_INLINE float dot(float4 _a, float4 _b) noexcept { return dotSplat(_a, _b).x(); }
+SIMD_FORCE_INLINE float dot3(float4 _a, float4 _b) noexcept { return dot3Splat(_a, _b).x(); }
+
+/**
+ * @brief The cross product of the xyz parts, w is 0 in the result.
+ */
+SIMD_FORCE_INLINE float4 cross(float4 _a, float4 _b) noexcept
+{
+    // (a * b.yzx - a.yzx * b).yzx, the w lanes cancel out
+    const float4 ayzx = float4::Ops::yzxw(_a.native);
+    const float4 byzx = float4::Ops::yzxw(_b.native);
+    return float4::Ops::yzxw((_a * byzx - ayzx * _b).native);
+}
+
+SIMD_FORCE_INLINE float length(float4 _v) noexcept { return std::sqrt(dot(_v, _v)); }
+SIMD_FORCE_INLINE float length3(float4 _v) noexcept { return std::sqrt(dot3(_v, _v)); }
+
+SIMD_FORCE_INLINE float4 normalize(float4 _v) noexcept { return _v / sqrt(dotSplat(_v, _v)); }
+
+// The xyz part normalized, w scaled along
+SIMD_FORCE_INLINE float4 normalize3(float4 _v) noexcept { return _v / sqrt(dot3Splat(_v, _v)); }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// mat4
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief A 4x4 float matrix of 4 column registers.
+ *
+ * Column-major, as glm::mat4: load() and store() take the 16 floats of glm::value_ptr(), and
+ * vectors are columns multiplied on the right.
+ */
+struct mat4
+{
+    float4 columns[4];
+
+    [[nodiscard]] static SIMD_FORCE_INLINE mat4 identity() noexcept
+    {
+        return {{float4(1.0f, 0.0f, 0.0f, 0.0f), float4(0.0f, 1.0f, 0.0f, 0.0f),
+                 float4(0.0f, 0.0f, 1.0f, 0.0f), float4(0.0f, 0.0f, 0.0f, 1.0f)}};
+    }
+
+    [[nodiscard]] static SIMD_FORCE_INLINE mat4 load(const float* _p) noexcept
+    {
+        return {{float4::load(_p), float4::load(_p + 4), float4::load(_p + 8),
+                 float4::load(_p + 12)}};
+    }
+
+    SIMD_FORCE_INLINE void store(float* _p) const noexcept
+    {
+        for (int i = 0; i < 4; ++i) columns[i].store(_p + 4 * i);
+    }
+
+    /**
+     * @brief The rotation of a unit quaternion stored (x, y, z, w), as glm::quat.
+     */
+    [[nodiscard]] static mat4 fromQuaternion(float4 _q) noexcept
+    {
+        return fromTranslationRotationScale(float4(0.0f, 0.0f, 0.0f, 1.0f), _q, float4(1.0f));
+    }
+
+    /**
+     * @brief translate(t) * rotate(q) * scale(s), the local transform of a node.
+     *
+     * @param _translation The translation in xyz, w is ignored.
+     * @param _rotation A unit quaternion stored (x, y, z, w).
+     * @param _scale The scale in xyz, w is ignored.
+     */
+    [[nodiscard]] static mat4 fromTranslationRotationScale(float4 _translation, float4 _rotation,
+                                                           float4 _scale) noexcept
+    {
+        alignas(16) float q[4];
+        _rotation.store(q);
+
+        const float x2 = q[0] + q[0], y2 = q[1] + q[1], z2 = q[2] + q[2];
+        const float xx = q[0] * x2, yy = q[1] * y2, zz = q[2] * z2;
+        const float xy = q[0] * y2, xz = q[0] * z2, yz = q[1] * z2;
+        const float wx = q[3] * x2, wy = q[3] * y2, wz = q[3] * z2;
+
+        const float4 column0(1.0f - (yy + zz), xy + wz, xz - wy, 0.0f);
+        const float4 column1(xy - wz, 1.0f - (xx + zz), yz + wx, 0.0f);
+        const float4 column2(xz + wy, yz - wx, 1.0f - (xx + yy), 0.0f);
+
+        const float4 translation =
+            select(int4(-1, -1, -1, 0), _translation, float4(0.0f, 0.0f, 0.0f, 1.0f));
+
+        return {{column0 * _scale.splat<0>(), column1 * _scale.splat<1>(),
+                 column2 * _scale.splat<2>(), translation}};
+    }
+};
+
+SIMD_FORCE_INLINE float4 operator*(const mat4& _m, float4 _v) noexcept
+{
+    float4 result = _m.columns[0] * _v.splat<0>();
+    result = mulAdd(_m.columns[1], _v.splat<1>(), result);
+    result = mulAdd(_m.columns[2], _v.splat<2>(), result);
+    return mulAdd(_m.columns[3], _v.splat<3>(), result);
+}
+
+SIMD_FORCE_INLINE mat4 operator*(const mat4& _lhs, const mat4& _rhs) noexcept
+{
+    return {{_lhs * _rhs.columns[0], _lhs * _rhs.columns[1], _lhs * _rhs.columns[2],
+             _lhs * _rhs.columns[3]}};
+}
+
+SIMD_FORCE_INLINE mat4 transpose(mat4 _m) noexcept
+{
+    float4::Ops::transpose(_m.columns[0].native, _m.columns[1].native, _m.columns[2].native,
+                           _m.columns[3].native);
+    return _m;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// float8 / float4x8
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 8 float lanes: one AVX register, or two of 4 lanes elsewhere.
+ */
+struct float8
+{
+#if defined(SIMD_X86_AVX) || defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+
+    __m256 native;
+
+    float8() noexcept = default;
+    SIMD_FORCE_INLINE float8(__m256 _native) noexcept : native(_native) {}
+    SIMD_FORCE_INLINE explicit float8(float _s) noexcept : native(_mm256_set1_ps(_s)) {}
+    SIMD_FORCE_INLINE float8(float4 _low, float4 _high) noexcept
+        : native(_mm256_insertf128_ps(_mm256_castps128_ps256(_low.native), _high.native, 1))
+    {
+    }
+
+    [[nodiscard]] static SIMD_FORCE_INLINE float8 load(const float* _p) noexcept
+    {
+        return _mm256_loadu_ps(_p);
+    }
+
+    SIMD_FORCE_INLINE void store(float* _p) const noexcept { _mm256_storeu_ps(_p, native); }
+
+    [[nodiscard]] SIMD_FORCE_INLINE float4 low() const noexcept
+    {
+        return _mm256_castps256_ps128(native);
+    }
+
+    [[nodiscard]] SIMD_FORCE_INLINE float4 high() const noexcept
+    {
+        return _mm256_extractf128_ps(native, 1);
+    }
+
+    friend SIMD_FORCE_INLINE float8 operator+(float8 _a, float8 _b) noexcept
+    {
+        return _mm256_add_ps(_a.native, _b.native);
+    }
+
+    friend SIMD_FORCE_INLINE float8 operator-(float8 _a, float8 _b) noexcept
+    {
+        return _mm256_sub_ps(_a.native, _b.native);
+    }
+
+    friend SIMD_FORCE_INLINE float8 operator*(float8 _a, float8 _b) noexcept
+    {
+        return _mm256_mul_ps(_a.native, _b.native);
+    }
+
+    friend SIMD_FORCE_INLINE float8 operator/(float8 _a, float8 _b) noexcept
+    {
+        return _mm256_div_ps(_a.native, _b.native);
+    }
+
+    friend SIMD_FORCE_INLINE float8 mulAdd(float8 _a, float8 _b, float8 _c) noexcept
+    {
+#if defined(__FMA__)
+        return _mm256_fmadd_ps(_a.native, _b.native, _c.native);
+#else
+        return _mm256_add_ps(_mm256_mul_ps(_a.native, _b.native), _c.native);
+#endif
+    }
+
+    friend SIMD_FORCE_INLINE float8 min(float8 _a, float8 _b) noexcept
+    {
+        return _mm256_min_ps(_a.native, _b.native);
+    }
+
+    friend SIMD_FORCE_INLINE float8 max(float8 _a, float8 _b) noexcept
+    {
+        return _mm256_max_ps(_a.native, _b.native);
+    }
+
+    friend SIMD_FORCE_INLINE float8 sqrt(float8 _v) noexcept { return _mm256_sqrt_ps(_v.native); }
+
+#else
+
+    float4 lowHalf;
+    float4 highHalf;
+
+    float8() noexcept = default;
+    SIMD_FORCE_INLINE explicit float8(float _s) noexcept : lowHalf(_s), highHalf(_s) {}
+    SIMD_FORCE_INLINE float8(float4 _low, float4 _high) noexcept : lowHalf(_low), highHalf(_high)
+    {
+    }
+
+    [[nodiscard]] static SIMD_FORCE_INLINE float8 load(const float* _p) noexcept
+    {
+        return {float4::load(_p), float4::load(_p + 4)};
+    }
+
+    SIMD_FORCE_INLINE void store(float* _p) const noexcept
+    {
+        lowHalf.store(_p);
+        highHalf.store(_p + 4);
+    }
+
+    [[nodiscard]] SIMD_FORCE_INLINE float4 low() const noexcept { return lowHalf; }
+    [[nodiscard]] SIMD_FORCE_INLINE float4 high() const noexcept { return highHalf; }
+
+    friend SIMD_FORCE_INLINE float8 operator+(float8 _a, float8 _b) noexcept
+    {
+        return {_a.lowHalf + _b.lowHalf, _a.highHalf + _b.highHalf};
+    }
+
+    friend SIMD_FORCE_INLINE float8 operator-(float8 _a, float8 _b) noexcept
+    {
+        return {_a.lowHalf - _b.lowHalf, _a.highHalf - _b.highHalf};
+    }
+
+    friend SIMD_FORCE_INLINE float8 operator*(float8 _a, float8 _b) noexcept
+    {
+        return {_a.lowHalf * _b.lowHalf, _a.highHalf * _b.highHalf};
+    }
+
+    friend SIMD_FORCE_INLINE float8 operator/(float8 _a, float8 _b) noexcept
+    {
+        return {_a.lowHalf / _b.lowHalf, _a.highHalf / _b.highHalf};
+    }
+
+    friend SIMD_FORCE_INLINE float8 mulAdd(float8 _a, float8 _b, float8 _c) noexcept
+    {
+        return {simd::mulAdd(_a.lowHalf, _b.lowHalf, _c.lowHalf),
+                simd::mulAdd(_a.highHalf, _b.highHalf, _c.highHalf)};
+    }
+
+    friend SIMD_FORCE_INLINE float8 min(float8 _a, float8 _b) noexcept
+    {
+        return {simd::min(_a.lowHalf, _b.lowHalf), simd::min(_a.highHalf, _b.highHalf)};
+    }
+
+    friend SIMD_FORCE_INLINE float8 max(float8 _a, float8 _b) noexcept
+    {
+        return {simd::max(_a.lowHalf, _b.lowHalf), simd::max(_a.highHalf, _b.highHalf)};
+    }
+
+    friend SIMD_FORCE_INLINE float8 sqrt(float8 _v) noexcept
+    {
+        return {simd::sqrt(_v.lowHalf), simd::sqrt(_v.highHalf)};
+    }
+
+#endif
+};
+
+/**
+ * @brief 8 vectors of 4 floats in struct-of-arrays form: the 8 x, the 8 y, the 8 z and the 8 w,
+ * so that one operation processes 8 vectors.
+ */
+struct float4x8
+{
+    float8 x;
+    float8 y;
+    float8 z;
+    float8 w;
+
+    // From 8 floats per component
+    [[nodiscard]] static SIMD_FORCE_INLINE float4x8 load(const float* _x, const float* _y,
+                                                         const float* _z,
+                                                         const float* _w) noexcept
+    {
+        return {float8::load(_x), float8::load(_y), float8::load(_z), float8::load(_w)};
+    }
+
+    SIMD_FORCE_INLINE void store(float* _x, float* _y, float* _z, float* _w) const noexcept
+    {
+        x.store(_x);
+        y.store(_y);
+        z.store(_z);
+        w.store(_w);
+    }
+
+    // From 8 consecutive vectors (array-of-structs), transposed
+    [[nodiscard]] static SIMD_FORCE_INLINE float4x8 fromVectors(const float4* _v) noexcept
+    {
+        float4 low[4] = {_v[0], _v[1], _v[2], _v[3]};
+        float4 high[4] = {_v[4], _v[5], _v[6], _v[7]};
+        float4::Ops::transpose(low[0].native, low[1].native, low[2].native, low[3].native);
+        float4::Ops::transpose(high[0].native, high[1].native, high[2].native, high[3].native);
+
+        return {{low[0], high[0]}, {low[1], high[1]}, {low[2], high[2]}, {low[3], high[3]}};
+    }
+
+    SIMD_FORCE_INLINE void toVectors(float4* _v) const noexcept
+    {
+        float4 low[4] = {x.low(), y.low(), z.low(), w.low()};
+        float4 high[4] = {x.high(), y.high(), z.high(), w.high()};
+        float4::Ops::transpose(low[0].native, low[1].native, low[2].native, low[3].native);
+        float4::Ops::transpose(high[0].native, high[1].native, high[2].native, high[3].native);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            _v[i] = low[i];
+            _v[i + 4] = high[i];
+        }
+    }
+};
+
+SIMD_FORCE_INLINE float4x8 operator+(const float4x8& _a, const float4x8& _b) noexcept
+{
+    return {_a.x + _b.x, _a.y + _b.y, _a.z + _b.z, _a.w + _b.w};
+}
+
+SIMD_FORCE_INLINE float4x8 operator-(const float4x8& _a, const float4x8& _b) noexcept
+{
+    return {_a.x - _b.x, _a.y - _b.y, _a.z - _b.z, _a.w - _b.w};
+}
+
+SIMD_FORCE_INLINE float4x8 operator*(const float4x8& _a, float8 _s) noexcept
+{
+    return {_a.x * _s, _a.y * _s, _a.z * _s, _a.w * _s};
+}
+
+SIMD_FORCE_INLINE float8 dot(const float4x8& _a, const float4x8& _b) noexcept
+{
+    return mulAdd(_a.w, _b.w, mulAdd(_a.z, _b.z, mulAdd(_a.y, _b.y, _a.x * _b.x)));
+}
+
+SIMD_FORCE_INLINE float8 dot3(const float4x8& _a, const float4x8& _b) noexcept
+{
+    return mulAdd(_a.z, _b.z, mulAdd(_a.y, _b.y, _a.x * _b.x));
+}
+
+// w is 0 in the result
+SIMD_FORCE_INLINE float4x8 cross(const float4x8& _a, const float4x8& _b) noexcept
+{
+    return {_a.y * _b.z - _a.z * _b.y, _a.z * _b.x - _a.x * _b.z, _a.x * _b.y - _a.y * _b.x,
+            float8(0.0f)};
+}
+
+// The 8 vectors transformed by the matrix
+SIMD_FORCE_INLINE float4x8 operator*(const mat4& _m, const float4x8& _v) noexcept
+{
+    alignas(16) float m[16];
+    _m.store(m);
+
+    // Row r of the result is the dot of row r of the matrix with the vectors
+    const auto row = [&](int _r) noexcept
+    {
+        return mulAdd(float8(m[12 + _r]), _v.w,
+                      mulAdd(float8(m[8 + _r]), _v.z,
+                             mulAdd(float8(m[4 + _r]), _v.y, float8(m[_r]) * _v.x)));
+    };
+
+    const float4x8 result{row(0), row(1), row(2), row(3)};
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Span operations
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+inline void checkSpanSizes(size_t _expected, size_t _size)
+{
+    if (_size < _expected)
+    {
+        throw std::invalid_argument("pieces::simd: the output is smaller than the input");
+    }
+}
+
+// _out[i] = dot(_a[i], _b[i]), 4 at once: both sides transposed to one register per component
+template <bool Dot3>
+inline void dotSpans(std::span<const float4> _a, std::span<const float4> _b, std::span<float> _out)
+{
+    if (_a.size() != _b.size())
+    {
+        throw std::invalid_argument("pieces::simd: the inputs differ in size");
+    }
+
+    checkSpanSizes(_a.size(), _out.size());
+
+    size_t i = 0;
+    for (; i + 4 <= _a.size(); i += 4)
+    {
+        float4 a[4] = {_a[i], _a[i + 1], _a[i + 2], _a[i + 3]};
+        float4 b[4] = {_b[i], _b[i + 1], _b[i + 2], _b[i + 3]};
+        Float4Ops::transpose(a[0].native, a[1].native, a[2].native, a[3].native);
+        Float4Ops::transpose(b[0].native, b[1].native, b[2].native, b[3].native);
+
+        float4 sum = mulAdd(a[2], b[2], mulAdd(a[1], b[1], a[0] * b[0]));
+        if constexpr (!Dot3) sum = mulAdd(a[3], b[3], sum);
+
+        sum.store(_out.data() + i);
+    }
+
+    for (; i < _a.size(); ++i) _out[i] = Dot3 ? dot3(_a[i], _b[i]) : dot(_a[i], _b[i]);
+}
+
+} // namespace detail
+
+/**
+ * @brief The dot products of the vectors at the same positions, 4 at a time.
+ *
+ * @throws std::invalid_argument if the inputs differ in size or the output is smaller.
+ */
+inline void dot(std::span<const float4> _a, std::span<const float4> _b, std::span<float> _out)
+{
+    detail::dotSpans<false>(_a, _b, _out);
+}
+
+// As dot(), of the xyz parts
+inline void dot3(std::span<const float4> _a, std::span<const float4> _b, std::span<float> _out)
+{
+    detail::dotSpans<true>(_a, _b, _out);
+}
+
+/**
+ * @brief The cross products of the vectors at the same positions.
+ *
+ * @throws std::invalid_argument if the inputs differ in size or the output is smaller.
+ */
+inline void cross(std::span<const float4> _a, std::span<const float4> _b, std::span<float4> _out)
+{
+    if (_a.size() != _b.size())
+    {
+        throw std::invalid_argument("pieces::simd: the inputs differ in size");
+    }
+
+    detail::checkSpanSizes(_a.size(), _out.size());
+
+    for (size_t i = 0; i < _a.size(); ++i) _out[i] = cross(_a[i], _b[i]);
+}
+
+/**
+ * @brief The vectors transformed by a matrix, _out may be _in.
+ *
+ * @throws std::invalid_argument if the output is smaller than the input.
+ */
+inline void transform(const mat4& _m, std::span<const float4> _in, std::span<float4> _out)
+{
+    detail::checkSpanSizes(_in.size(), _out.size());
+
+    for (size_t i = 0; i < _in.size(); ++i) _out[i] = _m * _in[i];
+}
+
+} // namespace simd
+} // namespace pieces
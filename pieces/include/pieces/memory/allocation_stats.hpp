@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "pieces/core/templates.hpp"
+
+namespace pieces
+{
+
+/**
+ * @brief Byte counters of the allocators of a subsystem, shared by every allocator attached to
+ * it with setStats().
+ *
+ * Reserved bytes are the buffers the allocators hold, allocated bytes the part of them handed
+ * out. The counters are relaxed atomics, allocators of different threads may share them; an
+ * allocator without stats only pays a null check.
+ *
+ * The ProxyAllocator in front of an allocator also fills the histograms: the sizes of the
+ * allocations by power of two, and their lifetimes by power of ten (under a frame, over one, for
+ * the whole level), to tell the subsystems that want pools from those that want arenas.
+ */
+class AllocationStats final : public NonCopyable<AllocationStats>, NonMovable<AllocationStats>
+{
+   public:
+    // Up to 16 bytes, 32, ..., 256 KiB, then larger
+    static constexpr size_t k_sizeClasses = 16;
+    static constexpr size_t k_minSizeClassShift = 4;
+
+    // Under 1 us, 10 us, ..., 1 s, then longer
+    static constexpr size_t k_lifetimeClasses = 8;
+
+   private:
+    std::atomic<size_t> m_reservedBytes{0};
+    std::atomic<size_t> m_allocatedBytes{0};
+    std::atomic<size_t> m_peakBytes{0}; // allocated, since the last resetPeak()
+    std::atomic<uint64_t> m_allocations{0};
+
+    std::array<std::atomic<uint64_t>, k_sizeClasses> m_sizeClasses{};
+    std::array<std::atomic<uint64_t>, k_lifetimeClasses> m_lifetimeClasses{};
+
+   public:
+    AllocationStats() = default;
+
+   public:
+    void reserve(size_t _bytes) noexcept
+    {
+        m_reservedBytes.fetch_add(_bytes, std::memory_order_relaxed);
+    }
+
+    void release(size_t _bytes) noexcept
+    {
+        m_reservedBytes.fetch_sub(_bytes, std::memory_order_relaxed);
+    }
+
+    void allocate(size_t _bytes) noexcept
+    {
+        const size_t allocated =
+            m_allocatedBytes.fetch_add(_bytes, std::memory_order_relaxed) + _bytes;
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+
+        size_t peak = m_peakBytes.load(std::memory_order_relaxed);
+        while (allocated > peak &&
+               !m_peakBytes.compare_exchange_weak(peak, allocated, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void deallocate(size_t _bytes) noexcept
+    {
+        m_allocatedBytes.fetch_sub(_bytes, std::memory_order_relaxed);
+    }
+
+    void recordSize(size_t _bytes) noexcept
+    {
+        m_sizeClasses[sizeClassOf(_bytes)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void recordLifetime(uint64_t _nanoseconds) noexcept
+    {
+        m_lifetimeClasses[lifetimeClassOf(_nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void resetPeak() noexcept
+    {
+        m_peakBytes.store(m_allocatedBytes.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t reservedBytes() const noexcept
+    {
+        return m_reservedBytes.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t allocatedBytes() const noexcept
+    {
+        return m_allocatedBytes.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t peakBytes() const noexcept
+    {
+        return m_peakBytes.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t allocations() const noexcept
+    {
+        return m_allocations.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t sizeClassCount(size_t _class) const noexcept
+    {
+        return m_sizeClasses[_class].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t lifetimeClassCount(size_t _class) const noexcept
+    {
+        return m_lifetimeClasses[_class].load(std::memory_order_relaxed);
+    }
+
+    /// Whether a ProxyAllocator recorded sizes, the histograms are empty otherwise.
+    [[nodiscard]] bool hasHistograms() const noexcept
+    {
+        for (const auto& count : m_sizeClasses)
+        {
+            if (count.load(std::memory_order_relaxed) != 0) return true;
+        }
+
+        return false;
+    }
+
+    /// The largest size of the class, in bytes (SIZE_MAX for the last one).
+    [[nodiscard]] static constexpr size_t sizeClassLimit(size_t _class) noexcept
+    {
+        return _class + 1 < k_sizeClasses ? size_t(1) << (_class + k_minSizeClassShift)
+                                          : SIZE_MAX;
+    }
+
+    /// The lifetimes of the class are under this one, in nanoseconds (UINT64_MAX for the last).
+    [[nodiscard]] static constexpr uint64_t lifetimeClassLimit(size_t _class) noexcept
+    {
+        if (_class + 1 >= k_lifetimeClasses) return UINT64_MAX;
+
+        uint64_t limit = 1000;
+        for (size_t i = 0; i < _class; ++i) limit *= 10;
+        return limit;
+    }
+
+    [[nodiscard]] static constexpr size_t sizeClassOf(size_t _bytes) noexcept
+    {
+        if (_bytes <= (size_t(1) << k_minSizeClassShift)) return 0;
+
+        const size_t shift = std::bit_width(_bytes - 1); // the power of two covering _bytes
+        return std::min(shift - k_minSizeClassShift, k_sizeClasses - 1);
+    }
+
+    [[nodiscard]] static constexpr size_t lifetimeClassOf(uint64_t _nanoseconds) noexcept
+    {
+        size_t lifetimeClass = 0;
+        while (lifetimeClass + 1 < k_lifetimeClasses &&
+               _nanoseconds >= lifetimeClassLimit(lifetimeClass))
+        {
+            ++lifetimeClass;
+        }
+
+        return lifetimeClass;
+    }
+
+    /**
+     * @brief The share of the reserved bytes not allocated: free space fragmented between the
+     * allocations, or kept by the allocators for later ones.
+     *
+     * @return Ratio between 0.0 (everything reserved is in use) and 1.0.
+     */
+    [[nodiscard]] float fragmentation() const noexcept
+    {
+        const size_t reserved = reservedBytes();
+        const size_t allocated = allocatedBytes();
+
+        if (reserved == 0 || allocated >= reserved) return 0.0f;
+
+        return 1.0f - static_cast<float>(allocated) / static_cast<float>(reserved);
+    }
+};
+
+} // namespace pieces
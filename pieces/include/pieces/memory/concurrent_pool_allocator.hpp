@@ -0,0 +1,532 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "pieces/core/templates.hpp"
+#include "pieces/memory/allocation_stats.hpp"
+
+namespace pieces
+{
+namespace detail
+{
+
+/**
+ * @brief The index of the calling thread among the live threads, the lowest free one claimed by
+ * its first call and released when it exits: each thread has a magazine of its own in every
+ * ConcurrentPoolAllocator, reused by the threads started after it exited.
+ */
+inline constexpr uint32_t k_maxThreadIndices = 64;
+inline constexpr uint32_t k_noThreadIndex = UINT32_MAX;
+
+inline std::atomic<uint64_t> g_threadIndices{0};
+
+// Set once the index of the thread is released, the allocations made later take none.
+inline thread_local bool t_threadIndexReleased = false;
+
+/**
+ * @brief What keeps slots per thread index, handed back by the thread of an index as it exits.
+ */
+class ThreadCacheOwner
+{
+   public:
+    virtual void releaseThreadCache(uint32_t _index) noexcept = 0;
+
+   protected:
+    ~ThreadCacheOwner() = default;
+};
+
+// The live owners, registered and unregistered by their constructor and destructor: a mutex,
+// only taken as they are created and destroyed and as threads exit.
+class ThreadCacheRegistry final : public NonCopyable<ThreadCacheRegistry>,
+                                  NonMovable<ThreadCacheRegistry>
+{
+   private:
+    std::mutex m_mutex;
+    std::vector<ThreadCacheOwner*> m_owners;
+
+   public:
+    ThreadCacheRegistry() = default;
+
+   public:
+    static ThreadCacheRegistry& get() noexcept
+    {
+        static ThreadCacheRegistry s_registry;
+        return s_registry;
+    }
+
+    void add(ThreadCacheOwner* _owner)
+    {
+        std::lock_guard lock(m_mutex);
+        m_owners.push_back(_owner);
+    }
+
+    void remove(ThreadCacheOwner* _owner) noexcept
+    {
+        std::lock_guard lock(m_mutex);
+        std::erase(m_owners, _owner);
+    }
+
+    void release(uint32_t _index) noexcept
+    {
+        std::lock_guard lock(m_mutex);
+        for (ThreadCacheOwner* owner : m_owners) owner->releaseThreadCache(_index);
+    }
+};
+
+class ThreadIndex final : public NonCopyable<ThreadIndex>, NonMovable<ThreadIndex>
+{
+   private:
+    uint32_t m_index = k_noThreadIndex;
+
+   public:
+    ThreadIndex() noexcept
+    {
+        uint64_t used = g_threadIndices.load(std::memory_order_relaxed);
+
+        // past k_maxThreadIndices live threads, the thread has no magazine
+        while (~used != 0)
+        {
+            const auto index = static_cast<uint32_t>(std::countr_one(used));
+
+            if (g_threadIndices.compare_exchange_weak(used, used | (uint64_t{1} << index),
+                                                      std::memory_order_acquire,
+                                                      std::memory_order_relaxed))
+            {
+                m_index = index;
+                return;
+            }
+        }
+    }
+
+    ~ThreadIndex()
+    {
+        t_threadIndexReleased = true;
+
+        if (m_index == k_noThreadIndex) return;
+
+        // the slots of its magazines to the depots, the next thread of the index starts empty
+        ThreadCacheRegistry::get().release(m_index);
+
+        g_threadIndices.fetch_and(~(uint64_t{1} << m_index), std::memory_order_release);
+    }
+
+   public:
+    [[nodiscard]] uint32_t get() const noexcept { return m_index; }
+};
+
+[[nodiscard]] inline uint32_t getThreadIndex() noexcept
+{
+    if (t_threadIndexReleased) return k_noThreadIndex;
+
+    thread_local ThreadIndex s_index;
+    return s_index.get();
+}
+
+} // namespace detail
+
+/**
+ * @brief A fixed-capacity pool of T objects, allocated and freed from any thread.
+ *
+ * Each thread allocates from a magazine of its own, an intrusive free list no other thread pops
+ * from: no atomic operation in the common case. A magazine refills from a depot shared by every
+ * thread by whole batches of k_batchSize slots and gives a batch back once it caches more than
+ * k_magazineSize; the depot is a lock-free stack of the batches (a tagged head, no ABA).
+ *
+ * A slot freed by another thread than the one that allocated it goes back to the magazine of
+ * that thread, on a lock-free list of remote frees the owner takes whole once its own list is
+ * empty: a producer freeing what a consumer allocated, or the reverse, keeps the slots with the
+ * thread allocating them. A thread exiting gives its magazines back to the depots. The threads
+ * without a magazine (more than detail::k_maxThreadIndices live threads) work on the depot
+ * directly.
+ *
+ * @tparam T The type of objects to allocate memory for.
+ *
+ * @note One object per allocation, unlike PoolAllocator there is no contiguous allocation.
+ * @note The slots freed by other threads to a thread that exited wait for the next thread of its
+ * index, or for a thread finding the depot empty.
+ */
+template <typename T>
+class ConcurrentPoolAllocator final : public NonCopyable<ConcurrentPoolAllocator<T>>,
+                                      NonMovable<ConcurrentPoolAllocator<T>>,
+                                      detail::ThreadCacheOwner
+{
+   public:
+    using Byte = uint8_t;
+    using ValueType = T;
+
+    static constexpr uint32_t k_batchSize = 32;                 // slots moved from or to the depot
+    static constexpr uint32_t k_magazineSize = 2 * k_batchSize; // cached before a batch spills
+
+   private:
+    static constexpr size_t SIZEOF_VALUE = sizeof(ValueType);
+    static constexpr size_t ALIGNOF_VALUE = alignof(ValueType);
+
+    static constexpr uint32_t k_nil = UINT32_MAX;
+    static constexpr uint8_t k_sharedOwner = UINT8_MAX; // allocated by a thread without magazine
+
+    static_assert(detail::k_maxThreadIndices < k_sharedOwner);
+
+    struct alignas(64) Magazine
+    {
+        // the thread of the magazine only
+        uint32_t head = k_nil;
+        uint32_t count = 0;
+
+        // pushed by the other threads, taken whole
+        std::atomic<uint32_t> remote{k_nil};
+    };
+
+    Byte* m_bufferBytes;
+    size_t m_capacity;
+
+    // per slot: the next one of its list, of its batch in the depot, the magazine it belongs to
+    std::unique_ptr<uint32_t[]> m_next;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_nextBatch;
+    std::unique_ptr<uint32_t[]> m_batchCount;
+    std::unique_ptr<uint8_t[]> m_owners;
+
+    std::unique_ptr<Magazine[]> m_magazines;
+
+    // the first slot of the top batch, and a tag changed by every update
+    alignas(64) std::atomic<uint64_t> m_depot;
+
+    std::atomic<size_t> m_size{0};
+    AllocationStats* m_stats = nullptr;
+
+   public:
+    /**
+     * @brief Constructs a ConcurrentPoolAllocator with a given capacity in T objects, all of them
+     * in the depot.
+     *
+     * @throws std::invalid_argument if _capacity is zero or does not fit 32-bit slot indices.
+     */
+    explicit ConcurrentPoolAllocator(size_t _capacity)
+        : m_bufferBytes(nullptr), m_capacity(_capacity), m_depot(pack(k_nil, 0))
+    {
+        if (_capacity == 0) throw std::invalid_argument("Capacity must be greater than zero.");
+        if (_capacity >= k_nil) throw std::invalid_argument("Capacity is too large.");
+
+        m_bufferBytes = static_cast<Byte*>(
+            ::operator new(_capacity * SIZEOF_VALUE, std::align_val_t{ALIGNOF_VALUE}));
+
+        m_next = std::make_unique<uint32_t[]>(_capacity);
+        m_nextBatch = std::make_unique<std::atomic<uint32_t>[]>(_capacity);
+        m_batchCount = std::make_unique<uint32_t[]>(_capacity);
+        m_owners = std::make_unique<uint8_t[]>(_capacity);
+        m_magazines = std::make_unique<Magazine[]>(detail::k_maxThreadIndices);
+
+        // the first slots on top
+        const auto capacity = static_cast<uint32_t>(_capacity);
+        const uint32_t lastBatch = (capacity - 1) / k_batchSize * k_batchSize;
+
+        for (uint32_t first = lastBatch + k_batchSize; first > 0;)
+        {
+            first -= k_batchSize;
+            const uint32_t end = std::min(first + k_batchSize, capacity);
+
+            for (uint32_t slot = first; slot < end; ++slot)
+            {
+                m_next[slot] = slot + 1 < end ? slot + 1 : k_nil;
+            }
+
+            pushBatch(first, end - first);
+        }
+
+        detail::ThreadCacheRegistry::get().add(this);
+    }
+
+    ~ConcurrentPoolAllocator()
+    {
+        detail::ThreadCacheRegistry::get().remove(this);
+
+        setStats(nullptr);
+        ::operator delete(m_bufferBytes, std::align_val_t{ALIGNOF_VALUE});
+    }
+
+   public:
+    /**
+     * @brief Allocates memory for one T object, from any thread.
+     *
+     * @param _count The number of T objects, one only.
+     * @return Pointer to the allocated memory, or nullptr once every slot is allocated.
+     */
+    [[nodiscard]] ValueType* allocate(size_t _count = 1) noexcept
+    {
+        if (_count != 1) return nullptr;
+
+        const uint32_t thread = detail::getThreadIndex();
+
+        const uint32_t slot =
+            thread == detail::k_noThreadIndex ? takeShared() : takeLocal(m_magazines[thread]);
+        if (slot == k_nil) return nullptr;
+
+        m_owners[slot] =
+            thread == detail::k_noThreadIndex ? k_sharedOwner : static_cast<uint8_t>(thread);
+
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        if (m_stats) m_stats->allocate(SIZEOF_VALUE);
+
+        return reinterpret_cast<ValueType*>(m_bufferBytes + size_t{slot} * SIZEOF_VALUE);
+    }
+
+    /**
+     * @brief Deallocates one T object, from any thread: back to the magazine of the thread that
+     * allocated it.
+     *
+     * @param _ptr Pointer to the memory to deallocate, ignored if the pool does not own it.
+     * @param _count The number of T objects, one only.
+     */
+    void deallocate(ValueType* _ptr, size_t _count = 1) noexcept
+    {
+        if (!owns(_ptr) || _count != 1) return;
+
+        const auto slot = static_cast<uint32_t>((reinterpret_cast<Byte*>(_ptr) - m_bufferBytes) /
+                                                SIZEOF_VALUE);
+        const uint8_t owner = m_owners[slot];
+
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        if (m_stats) m_stats->deallocate(SIZEOF_VALUE);
+
+        if (owner == k_sharedOwner) return pushBatch(slot, 1);
+
+        Magazine& magazine = m_magazines[owner];
+
+        if (owner != detail::getThreadIndex()) return pushRemote(magazine, slot);
+
+        m_next[slot] = magazine.head;
+        magazine.head = slot;
+
+        if (++magazine.count > k_magazineSize) spill(magazine);
+    }
+
+    /**
+     * @brief Constructs an object of type T at the given pointer.
+     *
+     * @throws noexcept If the constructor of T is nothrow constructible.
+     */
+    template <typename... Args>
+    void construct(T* _ptr, Args&&... _args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        if (!owns(_ptr)) return;
+
+        ::new (static_cast<void*>(_ptr)) T(std::forward<Args>(_args)...);
+    }
+
+    /**
+     * @brief Destroys an object of type T at the given pointer.
+     *
+     * @throws noexcept If the destructor of T is nothrow destructible.
+     */
+    void destroy(T* _ptr) noexcept(std::is_nothrow_destructible_v<T>)
+    {
+        if constexpr (!TriviallyDestructible<T>)
+        {
+            if (_ptr) _ptr->~T();
+        }
+    }
+
+    /**
+     * @brief Attaches the counters of a subsystem to the allocator (nullptr detaches it), the
+     * buffer and the current allocations are moved over from the previous ones. Not concurrent
+     * with the allocations.
+     */
+    void setStats(AllocationStats* _stats) noexcept
+    {
+        const size_t size = used();
+
+        if (m_stats)
+        {
+            m_stats->deallocate(size * SIZEOF_VALUE);
+            m_stats->release(m_capacity * SIZEOF_VALUE);
+        }
+
+        m_stats = _stats;
+
+        if (m_stats)
+        {
+            m_stats->reserve(m_capacity * SIZEOF_VALUE);
+            if (size > 0) m_stats->allocate(size * SIZEOF_VALUE);
+        }
+    }
+
+    [[nodiscard]] AllocationStats* getStats() const noexcept { return m_stats; }
+
+    [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
+
+    [[nodiscard]] size_t used() const noexcept { return m_size.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] size_t available() const noexcept { return m_capacity - used(); }
+
+    /// Whether _ptr is a slot of the pool, allocated or not.
+    [[nodiscard]] bool owns(const void* _ptr) const noexcept
+    {
+        if (!_ptr || !m_bufferBytes) return false;
+
+        const auto ptrAddr = reinterpret_cast<uintptr_t>(_ptr);
+        const auto bufferStart = reinterpret_cast<uintptr_t>(m_bufferBytes);
+
+        return ptrAddr >= bufferStart && ptrAddr < bufferStart + m_capacity * SIZEOF_VALUE &&
+               (ptrAddr - bufferStart) % SIZEOF_VALUE == 0;
+    }
+
+   private:
+    // On the exiting thread of _index, the owner of the magazine.
+    void releaseThreadCache(uint32_t _index) noexcept override
+    {
+        Magazine& magazine = m_magazines[_index];
+
+        if (magazine.head != k_nil) pushBatch(magazine.head, magazine.count);
+        magazine.head = k_nil;
+        magazine.count = 0;
+
+        uint32_t count = 0;
+        const uint32_t remote = takeRemote(magazine, count);
+        if (remote != k_nil) pushBatch(remote, count);
+    }
+
+    [[nodiscard]] static constexpr uint64_t pack(uint32_t _slot, uint32_t _tag) noexcept
+    {
+        return (uint64_t{_tag} << 32) | _slot;
+    }
+
+    [[nodiscard]] static constexpr uint32_t getSlot(uint64_t _head) noexcept
+    {
+        return static_cast<uint32_t>(_head);
+    }
+
+    [[nodiscard]] static constexpr uint32_t getTag(uint64_t _head) noexcept
+    {
+        return static_cast<uint32_t>(_head >> 32);
+    }
+
+    // The batch of _count slots chained from _first, on top of the depot.
+    void pushBatch(uint32_t _first, uint32_t _count) noexcept
+    {
+        m_batchCount[_first] = _count;
+
+        uint64_t head = m_depot.load(std::memory_order_relaxed);
+
+        do
+        {
+            m_nextBatch[_first].store(getSlot(head), std::memory_order_relaxed);
+        } while (!m_depot.compare_exchange_weak(head, pack(_first, getTag(head) + 1),
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+    }
+
+    // The first slot of the top batch of the depot and its _count, k_nil if it is empty.
+    [[nodiscard]] uint32_t popBatch(uint32_t& _count) noexcept
+    {
+        uint64_t head = m_depot.load(std::memory_order_acquire);
+
+        while (getSlot(head) != k_nil)
+        {
+            // the slot may be taken meanwhile and its link reused: the tag fails the exchange
+            const uint32_t next = m_nextBatch[getSlot(head)].load(std::memory_order_relaxed);
+
+            if (m_depot.compare_exchange_weak(head, pack(next, getTag(head) + 1),
+                                              std::memory_order_acquire,
+                                              std::memory_order_acquire))
+            {
+                _count = m_batchCount[getSlot(head)];
+                return getSlot(head);
+            }
+        }
+
+        return k_nil;
+    }
+
+    void pushRemote(Magazine& _magazine, uint32_t _slot) noexcept
+    {
+        uint32_t head = _magazine.remote.load(std::memory_order_relaxed);
+
+        do
+        {
+            m_next[_slot] = head;
+        } while (!_magazine.remote.compare_exchange_weak(head, _slot, std::memory_order_release,
+                                                         std::memory_order_relaxed));
+    }
+
+    // The remote frees of a magazine, from whichever thread: the list is taken whole.
+    [[nodiscard]] uint32_t takeRemote(Magazine& _magazine, uint32_t& _count) noexcept
+    {
+        const uint32_t head = _magazine.remote.exchange(k_nil, std::memory_order_acquire);
+
+        _count = 0;
+        for (uint32_t slot = head; slot != k_nil; slot = m_next[slot]) ++_count;
+
+        return head;
+    }
+
+    // The remote frees stranded in the magazines of other threads (exited ones), once the depot
+    // is empty.
+    [[nodiscard]] uint32_t takeStranded(uint32_t& _count) noexcept
+    {
+        for (uint32_t i = 0; i < detail::k_maxThreadIndices; ++i)
+        {
+            const uint32_t head = takeRemote(m_magazines[i], _count);
+            if (head != k_nil) return head;
+        }
+
+        return k_nil;
+    }
+
+    [[nodiscard]] uint32_t takeLocal(Magazine& _magazine) noexcept
+    {
+        if (_magazine.head == k_nil)
+        {
+            // the frees of the other threads first, then the depot
+            _magazine.head = takeRemote(_magazine, _magazine.count);
+            if (_magazine.head == k_nil) _magazine.head = popBatch(_magazine.count);
+            if (_magazine.head == k_nil) _magazine.head = takeStranded(_magazine.count);
+            if (_magazine.head == k_nil) return k_nil;
+        }
+
+        const uint32_t slot = _magazine.head;
+        _magazine.head = m_next[slot];
+        _magazine.count--;
+
+        return slot;
+    }
+
+    // One slot of the depot for a thread without magazine, the rest of its batch put back.
+    [[nodiscard]] uint32_t takeShared() noexcept
+    {
+        uint32_t count = 0;
+
+        uint32_t slot = popBatch(count);
+        if (slot == k_nil) slot = takeStranded(count);
+        if (slot == k_nil) return k_nil;
+
+        if (count > 1) pushBatch(m_next[slot], count - 1);
+
+        return slot;
+    }
+
+    // The newest k_batchSize slots of a full magazine to the depot.
+    void spill(Magazine& _magazine) noexcept
+    {
+        const uint32_t first = _magazine.head;
+
+        uint32_t last = first;
+        for (uint32_t i = 1; i < k_batchSize; ++i) last = m_next[last];
+
+        _magazine.head = m_next[last];
+        _magazine.count -= k_batchSize;
+        m_next[last] = k_nil;
+
+        pushBatch(first, k_batchSize);
+    }
+};
+
+} // namespace pieces
@@ -7,6 +7,7 @@
 #include <cstring>
 
 #include "pieces/core/templates.hpp"
+#include "pieces/memory/allocation_stats.hpp"
 
 namespace pieces
 {
@@ -56,6 +57,19 @@ class ContiguousAllocatorBase final : public NonCopyable<ContiguousAllocatorBase
     size_t m_capacity;
     size_t m_size;
 
+    AllocationStats* m_stats = nullptr;
+
+   public:
+    /**
+     * @brief A position of a linear or stack allocator, everything allocated after it is released
+     * at once by rewind().
+     */
+    struct Marker
+    {
+        size_t offsetInBytes = 0;
+        size_t size = 0;
+    };
+
    public:
     /**
      * @brief Constructs a ContiguousAllocatorBase with a given capacity in T objects.
@@ -79,6 +93,7 @@ class ContiguousAllocatorBase final : public NonCopyable<ContiguousAllocatorBase
 
     ~ContiguousAllocatorBase()
     {
+        setStats(nullptr);
         ::operator delete(m_bufferBytes, std::align_val_t{ALIGNOF_VALUE});
     }
 
@@ -86,27 +101,32 @@ class ContiguousAllocatorBase final : public NonCopyable<ContiguousAllocatorBase
         : m_bufferBytes(_other.m_bufferBytes),
           m_offsetInBytes(_other.m_offsetInBytes),
           m_capacity(_other.m_capacity),
-          m_size(_other.m_size)
+          m_size(_other.m_size),
+          m_stats(_other.m_stats)
     {
         _other.m_bufferBytes = nullptr;
         _other.m_offsetInBytes = 0;
         _other.m_size = 0;
+        _other.m_stats = nullptr;
     }
 
     [[nodiscard]] ContiguousAllocatorBase& operator=(ContiguousAllocatorBase&& _other) noexcept
     {
         if (this == &_other) return *this;
 
+        setStats(nullptr);
         ::operator delete(m_bufferBytes, std::align_val_t{ALIGNOF_VALUE});
 
         m_bufferBytes = _other.m_bufferBytes;
         m_offsetInBytes = _other.m_offsetInBytes;
         m_capacity = _other.m_capacity;
         m_size = _other.m_size;
+        m_stats = _other.m_stats;
 
         _other.m_bufferBytes = nullptr;
         _other.m_offsetInBytes = 0;
         _other.m_size = 0;
+        _other.m_stats = nullptr;
 
         return *this;
     }
@@ -120,7 +140,16 @@ class ContiguousAllocatorBase final : public NonCopyable<ContiguousAllocatorBase
      *
      * @throws std::bad_alloc from the new operator if allocation fails.
      */
-    [[nodiscard]] ValueType* allocate(size_t _count)
+    [[nodiscard]] ValueType* allocate(size_t _count) { return allocate(_count, ALIGNOF_VALUE); }
+
+    /**
+     * @brief Allocates memory for a given number of T objects, at a stricter alignment than T's.
+     *
+     * @param _count The number of T objects to allocate memory for.
+     * @param _alignment The alignment in bytes, a power of two (at least alignof(T) is used).
+     * @return Pointer to the allocated memory, or nullptr if allocation fails.
+     */
+    [[nodiscard]] ValueType* allocate(size_t _count, size_t _alignment)
     {
         if (_count == 0) return nullptr;
 
@@ -143,10 +172,12 @@ class ContiguousAllocatorBase final : public NonCopyable<ContiguousAllocatorBase
         void* rawPtr = m_bufferBytes + m_offsetInBytes;
         void* alignedPtr = rawPtr;
 
-        if (!std::align(ALIGNOF_VALUE, bytesNeeded, alignedPtr, remainingBytes)) return nullptr;
+        const size_t alignment = _alignment > ALIGNOF_VALUE ? _alignment : ALIGNOF_VALUE;
+        if (!std::align(alignment, bytesNeeded, alignedPtr, remainingBytes)) return nullptr;
 
         m_offsetInBytes = static_cast<Byte*>(alignedPtr) - m_bufferBytes + bytesNeeded;
         m_size += _count;
+        if (m_stats) m_stats->allocate(bytesNeeded);
 
         return static_cast<T*>(alignedPtr);
     }
@@ -181,6 +212,7 @@ class ContiguousAllocatorBase final : public NonCopyable<ContiguousAllocatorBase
         }
 
         m_size -= _count;
+        if (m_stats) m_stats->deallocate(_count * SIZEOF_VALUE);
     }
 
     /**
@@ -219,10 +251,61 @@ class ContiguousAllocatorBase final : public NonCopyable<ContiguousAllocatorBase
 
     void reset()
     {
+        if (m_stats) m_stats->deallocate(m_size * SIZEOF_VALUE);
+
         m_size = 0;
         m_offsetInBytes = 0;
     }
 
+    /**
+     * @brief Returns the current position, to rewind() to.
+     */
+    [[nodiscard]] Marker getMarker() const noexcept
+        requires(Policy != ContiguousAllocatorPolicy::circular)
+    {
+        return {m_offsetInBytes, m_size};
+    }
+
+    /**
+     * @brief Releases everything allocated since the marker was taken.
+     *
+     * @param _marker A marker of this allocator, taken since the last reset() (a marker ahead of
+     * the current position is ignored).
+     */
+    void rewind(Marker _marker) noexcept
+        requires(Policy != ContiguousAllocatorPolicy::circular)
+    {
+        if (_marker.offsetInBytes > m_offsetInBytes || _marker.size > m_size) return;
+
+        if (m_stats) m_stats->deallocate((m_size - _marker.size) * SIZEOF_VALUE);
+
+        m_offsetInBytes = _marker.offsetInBytes;
+        m_size = _marker.size;
+    }
+
+    /**
+     * @brief Attaches the counters of a subsystem to the allocator (nullptr detaches it), the
+     * buffer and the current allocations are moved over from the previous ones.
+     */
+    void setStats(AllocationStats* _stats) noexcept
+    {
+        if (m_stats)
+        {
+            m_stats->deallocate(m_size * SIZEOF_VALUE);
+            if (m_bufferBytes) m_stats->release(m_capacity * SIZEOF_VALUE);
+        }
+
+        m_stats = _stats;
+
+        if (m_stats)
+        {
+            if (m_bufferBytes) m_stats->reserve(m_capacity * SIZEOF_VALUE);
+            if (m_size > 0) m_stats->allocate(m_size * SIZEOF_VALUE);
+        }
+    }
+
+    [[nodiscard]] AllocationStats* getStats() const noexcept { return m_stats; }
+
     [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
 
     [[nodiscard]] size_t used() const noexcept { return m_size; }
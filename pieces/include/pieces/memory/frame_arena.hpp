@@ -0,0 +1,270 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <utility>
+
+#include "pieces/core/templates.hpp"
+#include "pieces/memory/allocation_stats.hpp"
+#include "pieces/memory/contiguous_allocator.hpp"
+
+namespace pieces
+{
+namespace detail
+{
+
+// Advanced once a frame by FrameArena::beginFrame(), followed by the arenas of the threads.
+inline std::atomic<uint64_t> g_frameArenaFrame{0};
+
+} // namespace detail
+
+/**
+ * @brief A double-buffered arena for the temporaries of a frame.
+ *
+ * Two linear allocators take turns: flip() makes the other one current and resets it, so what
+ * was allocated during a frame stays valid during the next one too (a render thread a frame
+ * behind reads it) and is released two flips later, all at once. Markers rewind the current
+ * buffer for nested temporaries (Scope), nothing is ever freed one by one.
+ *
+ * FrameArena::local() is the arena of the calling thread, flipped on its first use in each frame
+ * started by beginFrame(); getResource() adapts an arena to std::pmr containers, a request the
+ * arena cannot satisfy falls back to the upstream resource.
+ *
+ * @note Allocations come from the owning thread only, deallocations through the resource of any.
+ * @note The objects are never destroyed: make<T>() and makeArray<T>() take trivially
+ * destructible types only.
+ */
+class FrameArena final : public NonCopyable<FrameArena>, NonMovable<FrameArena>
+{
+   public:
+    using Byte = uint8_t;
+    using BufferAllocator = LinearAllocator<Byte>;
+
+    // Per buffer, for the arenas of the threads
+    static constexpr size_t k_localCapacity = size_t(1) << 20;
+
+    /**
+     * @brief A position in the current buffer, only valid until the next flip.
+     */
+    struct Marker
+    {
+        uint64_t flips = 0;
+        BufferAllocator::Marker position;
+    };
+
+    /**
+     * @brief Rewinds the arena to where it was when the scope was opened, as it is closed.
+     */
+    class Scope final : public NonCopyable<Scope>, NonMovable<Scope>
+    {
+       private:
+        FrameArena& m_arena;
+        Marker m_marker;
+
+       public:
+        explicit Scope(FrameArena& _arena) noexcept
+            : m_arena(_arena), m_marker(_arena.getMarker())
+        {
+        }
+
+        ~Scope() { m_arena.rewind(m_marker); }
+    };
+
+    /**
+     * @brief A std::pmr::memory_resource allocating from an arena, and from upstream once the
+     * arena is full. Deallocating memory of the arena does nothing.
+     */
+    class Resource final : public std::pmr::memory_resource
+    {
+       private:
+        FrameArena& m_arena;
+        std::pmr::memory_resource* m_upstream;
+
+       public:
+        explicit Resource(FrameArena& _arena,
+                          std::pmr::memory_resource* _upstream = std::pmr::new_delete_resource())
+            : m_arena(_arena), m_upstream(_upstream)
+        {
+        }
+
+       private:
+        void* do_allocate(size_t _bytes, size_t _alignment) override
+        {
+            if (void* ptr = m_arena.allocate(_bytes, _alignment)) return ptr;
+
+            return m_upstream->allocate(_bytes, _alignment);
+        }
+
+        void do_deallocate(void* _ptr, size_t _bytes, size_t _alignment) override
+        {
+            if (!m_arena.owns(_ptr)) m_upstream->deallocate(_ptr, _bytes, _alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& _other) const noexcept override
+        {
+            return this == &_other;
+        }
+    };
+
+   private:
+    BufferAllocator m_buffers[2];
+    uint32_t m_current = 0;
+    uint64_t m_flips = 0;
+    uint64_t m_frame = detail::g_frameArenaFrame.load(std::memory_order_relaxed);
+
+    Resource m_resource{*this};
+
+   public:
+    /**
+     * @brief Constructs a FrameArena of two buffers of a given capacity.
+     *
+     * @param _capacityInBytes The capacity of each buffer in bytes.
+     *
+     * @throws std::invalid_argument if _capacityInBytes is zero.
+     */
+    explicit FrameArena(size_t _capacityInBytes)
+        : m_buffers{BufferAllocator(_capacityInBytes), BufferAllocator(_capacityInBytes)}
+    {
+    }
+
+   public:
+    /**
+     * @brief Starts a new frame for the arenas of all the threads, each flips on its next use.
+     */
+    static void beginFrame() noexcept
+    {
+        detail::g_frameArenaFrame.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the arena of the calling thread, flipped if a frame began since its last use.
+     */
+    [[nodiscard]] static FrameArena& local()
+    {
+        thread_local FrameArena arena(k_localCapacity);
+
+        const uint64_t frame = detail::g_frameArenaFrame.load(std::memory_order_relaxed);
+        if (arena.m_frame != frame)
+        {
+            arena.m_frame = frame;
+            arena.flip();
+        }
+
+        return arena;
+    }
+
+    /**
+     * @brief Makes the other buffer current and resets it, the allocations of the previous one
+     * stay valid until the next flip.
+     */
+    void flip() noexcept
+    {
+        m_current ^= 1;
+        m_buffers[m_current].reset();
+        ++m_flips;
+    }
+
+    /**
+     * @brief Allocates raw memory from the current buffer.
+     *
+     * @param _bytes The number of bytes to allocate.
+     * @param _alignment The alignment in bytes, a power of two.
+     * @return Pointer to the allocated memory, or nullptr if the buffer is full.
+     */
+    [[nodiscard]] void* allocate(size_t _bytes,
+                                 size_t _alignment = alignof(std::max_align_t)) noexcept
+    {
+        return m_buffers[m_current].allocate(_bytes, _alignment);
+    }
+
+    /**
+     * @brief Allocates and constructs a T from the current buffer.
+     *
+     * @return Pointer to the object, or nullptr if the buffer is full.
+     */
+    template <TriviallyDestructible T, typename... Args>
+    [[nodiscard]] T* make(Args&&... _args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        void* ptr = allocate(sizeof(T), alignof(T));
+        if (!ptr) return nullptr;
+
+        return ::new (ptr) T(std::forward<Args>(_args)...);
+    }
+
+    /**
+     * @brief Allocates and value-initializes _count Ts from the current buffer.
+     *
+     * @return The objects, or an empty span if the buffer is full.
+     */
+    template <TriviallyDestructible T>
+    [[nodiscard]] std::span<T> makeArray(size_t _count) noexcept
+    {
+        if (_count == 0 || _count > SIZE_MAX / sizeof(T)) return {};
+
+        T* ptr = static_cast<T*>(allocate(_count * sizeof(T), alignof(T)));
+        if (!ptr) return {};
+
+        std::uninitialized_value_construct_n(ptr, _count);
+        return {ptr, _count};
+    }
+
+    [[nodiscard]] Marker getMarker() const noexcept
+    {
+        return {m_flips, m_buffers[m_current].getMarker()};
+    }
+
+    /**
+     * @brief Releases what was allocated since the marker was taken (nothing if the arena flipped
+     * since).
+     */
+    void rewind(const Marker& _marker) noexcept
+    {
+        if (_marker.flips == m_flips) m_buffers[m_current].rewind(_marker.position);
+    }
+
+    /**
+     * @brief Opens a scope, the arena is rewound as it closes.
+     */
+    [[nodiscard]] Scope scope() noexcept { return Scope(*this); }
+
+    [[nodiscard]] std::pmr::memory_resource* getResource() noexcept { return &m_resource; }
+
+    /**
+     * @brief Attaches the counters of a subsystem to both buffers (nullptr detaches them).
+     */
+    void setStats(AllocationStats* _stats) noexcept
+    {
+        for (BufferAllocator& buffer : m_buffers) buffer.setStats(_stats);
+    }
+
+    // Expressed in bytes, for the current buffer
+    [[nodiscard]] size_t capacity() const noexcept { return m_buffers[m_current].capacity(); }
+    [[nodiscard]] size_t used() const noexcept { return m_buffers[m_current].used(); }
+    [[nodiscard]] size_t available() const noexcept { return m_buffers[m_current].available(); }
+
+    /**
+     * @brief Checks whether the pointer is in one of the buffers, allocated still or not.
+     */
+    [[nodiscard]] bool owns(const void* _ptr) const noexcept
+    {
+        const uintptr_t ptrAddr = reinterpret_cast<uintptr_t>(_ptr);
+
+        for (const BufferAllocator& buffer : m_buffers)
+        {
+            const uintptr_t bufferStart = reinterpret_cast<uintptr_t>(buffer.getBuffer());
+            if (bufferStart && ptrAddr >= bufferStart && ptrAddr < bufferStart + buffer.capacity())
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+} // namespace pieces
@@ -1,13 +1,16 @@
 #pragma once
 
+#include <bit>
 #include <new>
 #include <type_traits>
 #include <stdexcept>
 #include <memory>
 #include <cstring>
 #include <cstddef>
+#include <utility>
 
 #include "pieces/core/templates.hpp"
+#include "pieces/memory/allocation_stats.hpp"
 
 namespace pieces
 {
@@ -20,6 +23,7 @@ enum class FreeListAllocatorPolicy : uint8_t
     first_fit, // Fast: allocates first block that fits (early exit)
     best_fit,  // Memory efficient: allocates smallest block that fits (full scan)
     worst_fit, // Fragment reduction: allocates largest block (full scan)
+    tlsf,      // Bounded: two-level segregated fit, O(1) allocate/free, coalesces immediately
 };
 
 /**
@@ -42,6 +46,13 @@ enum class CoalescingPolicy : uint8_t
  * The allocator uses an in-place linked list of free blocks with embedded headers.
  * All allocations are aligned to std::max_align_t for compatibility with any type.
  *
+ * The tlsf policy (Two-Level Segregated Fit) files the free blocks instead in size classes: one
+ * per power of two, split in 16 linear sub-classes, each with its own doubly-linked list and a bit
+ * in two bitmaps. An allocation rounds the size up to the next class and takes the head of the
+ * first non-empty class from there (two countr_zero), a deallocation merges the block with its
+ * free physical neighbours (the previous one through a boundary tag in the header) and files the
+ * result: both in constant time, whatever the number of blocks. CoalescePolicy is ignored.
+ *
  * @tparam Policy The allocation strategy (default: first_fit)
  * @tparam CoalescePolicy The coalescing strategy (default: deferred)
  *
@@ -57,6 +68,18 @@ class FreeListAllocator final : public NonCopyable<FreeListAllocator<Policy, Coa
     using Byte = uint8_t;
 
    private:
+    struct BlockHeader;
+
+    struct Empty
+    {
+    };
+
+    struct TlsfLinks
+    {
+        BlockHeader* prevFree;     // Previous free block of the size class
+        BlockHeader* prevPhysical; // Block right before this one in the buffer (nullptr if first)
+    };
+
     /**
      * @brief Block header structure for the in-place linked list.
      *
@@ -69,19 +92,43 @@ class FreeListAllocator final : public NonCopyable<FreeListAllocator<Policy, Coa
         BlockHeader* next; // Next free block in the free list (nullptr if allocated/last)
         bool isFree;       // true if block is free, false if allocated
 
+        // tlsf only: the free list is doubly-linked and the previous block in memory is known
+        [[no_unique_address]] std::conditional_t<Policy == FreeListAllocatorPolicy::tlsf,
+                                                 TlsfLinks, Empty> links;
+
         // User data follows immediately after header, aligned to max_align_t
         alignas(std::max_align_t) Byte userData[];
     };
 
+
     static constexpr size_t SIZEOF_HEADER = sizeof(BlockHeader);
     static constexpr size_t MIN_BLOCK_SIZE = SIZEOF_HEADER + 1;
     static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
 
+    // tlsf: 16 sub-classes per power of two, the blocks below 256 bytes in linear classes of 16
+    static constexpr size_t TLSF_SL_SHIFT = 4;
+    static constexpr size_t TLSF_SL_COUNT = size_t(1) << TLSF_SL_SHIFT;
+    static constexpr size_t TLSF_FL_SHIFT = TLSF_SL_SHIFT + std::countr_zero(ALIGNMENT);
+    static constexpr size_t TLSF_SMALL_BLOCK = size_t(1) << TLSF_FL_SHIFT;
+    static constexpr size_t TLSF_FL_COUNT = 32; // blocks up to 2^(TLSF_FL_SHIFT + 31) bytes
+
+    struct TlsfIndex
+    {
+        uint32_t flBitmap = 0;                 // bit fl set while a class of fl has a free block
+        uint32_t slBitmaps[TLSF_FL_COUNT] = {}; // bit sl set while the class (fl, sl) has one
+        BlockHeader* heads[TLSF_FL_COUNT][TLSF_SL_COUNT] = {};
+        size_t freeBlockCount = 0;
+    };
+
     Byte* m_bufferBytes;         // Raw buffer managed by allocator
     BlockHeader* m_freeListHead; // Head of free list (linked list of free blocks)
     size_t m_capacityInBytes;    // Total buffer size in bytes
     size_t m_usedInBytes;        // Currently allocated bytes (excluding headers)
     size_t m_totalOverhead;      // Total header overhead in bytes
+    AllocationStats* m_stats;    // Counters of the subsystem (nullptr if not tracked)
+
+    [[no_unique_address]] std::conditional_t<Policy == FreeListAllocatorPolicy::tlsf, TlsfIndex,
+                                             Empty> m_tlsf;
 
     // Helper methods
     size_t alignSize(size_t _size) const noexcept;
@@ -93,6 +140,15 @@ class FreeListAllocator final : public NonCopyable<FreeListAllocator<Policy, Coa
     void rebuildFreeList();
     void* allocateInternal(size_t _sizeInBytes, bool _retryAfterCoalesce);
 
+    // tlsf helpers
+    static void tlsfMapping(size_t _size, size_t& _fl, size_t& _sl) noexcept;
+    BlockHeader* tlsfFindFree(size_t _size) const noexcept;
+    void tlsfInsert(BlockHeader* _block) noexcept;
+    void tlsfRemove(BlockHeader* _block) noexcept;
+    BlockHeader* nextPhysical(BlockHeader* _block) const noexcept;
+    void* tlsfAllocate(size_t _alignedSize);
+    void tlsfDeallocate(BlockHeader* _block) noexcept;
+
    public:
     /**
      * @brief Constructs a FreeListAllocator with a given capacity in bytes.
@@ -215,6 +271,22 @@ class FreeListAllocator final : public NonCopyable<FreeListAllocator<Policy, Coa
      */
     [[nodiscard]] float getFragmentationRatio() const noexcept;
 
+    /**
+     * @brief Attaches the counters of a subsystem to the allocator.
+     *
+     * @param _stats The counters, or nullptr to detach the allocator.
+     *
+     * @note The buffer and the current allocations are moved over from the previous counters.
+     */
+    void setStats(AllocationStats* _stats) noexcept;
+
+    /**
+     * @brief Returns the counters the allocator is attached to.
+     *
+     * @return The counters, or nullptr if not tracked.
+     */
+    [[nodiscard]] AllocationStats* getStats() const noexcept;
+
     /**
      * @brief Equality operator.
      */
@@ -244,6 +316,11 @@ using BestFitAllocator = FreeListAllocator<FreeListAllocatorPolicy::best_fit, Co
 template <CoalescingPolicy CoalescePolicy = CoalescingPolicy::deferred>
 using WorstFitAllocator = FreeListAllocator<FreeListAllocatorPolicy::worst_fit, CoalescePolicy>;
 
+/**
+ * @brief Type alias for a two-level segregated fit allocator (always coalesces immediately).
+ */
+using TlsfAllocator = FreeListAllocator<FreeListAllocatorPolicy::tlsf, CoalescingPolicy::immediate>;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Implementation
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -254,13 +331,21 @@ FreeListAllocator<Policy, CoalescePolicy>::FreeListAllocator(size_t _capacityInB
       m_freeListHead(nullptr),
       m_capacityInBytes(_capacityInBytes),
       m_usedInBytes(0),
-      m_totalOverhead(SIZEOF_HEADER)
+      m_totalOverhead(SIZEOF_HEADER),
+      m_stats(nullptr)
 {
     if (_capacityInBytes < MIN_BLOCK_SIZE)
     {
         throw std::invalid_argument("Capacity too small for allocator");
     }
 
+    if constexpr (Policy == FreeListAllocatorPolicy::tlsf)
+    {
+        size_t fl = 0, sl = 0;
+        tlsfMapping(_capacityInBytes, fl, sl);
+        if (fl >= TLSF_FL_COUNT) throw std::invalid_argument("Capacity too large for allocator");
+    }
+
     // Allocate aligned buffer
     m_bufferBytes =
         static_cast<Byte*>(::operator new(_capacityInBytes, std::align_val_t{ALIGNMENT}));
@@ -272,11 +357,18 @@ FreeListAllocator<Policy, CoalescePolicy>::FreeListAllocator(size_t _capacityInB
     m_freeListHead->size = _capacityInBytes;
     m_freeListHead->isFree = true;
     m_freeListHead->next = nullptr;
+
+    if constexpr (Policy == FreeListAllocatorPolicy::tlsf)
+    {
+        m_freeListHead->links.prevPhysical = nullptr;
+        tlsfInsert(std::exchange(m_freeListHead, nullptr));
+    }
 }
 
 template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
 FreeListAllocator<Policy, CoalescePolicy>::~FreeListAllocator()
 {
+    setStats(nullptr);
     ::operator delete(m_bufferBytes, std::align_val_t{ALIGNMENT});
 }
 
@@ -286,13 +378,16 @@ FreeListAllocator<Policy, CoalescePolicy>::FreeListAllocator(FreeListAllocator&&
       m_freeListHead(_other.m_freeListHead),
       m_capacityInBytes(_other.m_capacityInBytes),
       m_usedInBytes(_other.m_usedInBytes),
-      m_totalOverhead(_other.m_totalOverhead)
+      m_totalOverhead(_other.m_totalOverhead),
+      m_stats(_other.m_stats),
+      m_tlsf(std::exchange(_other.m_tlsf, {}))
 {
     _other.m_bufferBytes = nullptr;
     _other.m_freeListHead = nullptr;
     _other.m_capacityInBytes = 0;
     _other.m_usedInBytes = 0;
     _other.m_totalOverhead = 0;
+    _other.m_stats = nullptr;
 }
 
 template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
@@ -301,6 +396,7 @@ FreeListAllocator<Policy, CoalescePolicy>& FreeListAllocator<Policy, CoalescePol
 {
     if (this == &_other) return *this;
 
+    setStats(nullptr);
     ::operator delete(m_bufferBytes, std::align_val_t{ALIGNMENT});
 
     m_bufferBytes = _other.m_bufferBytes;
@@ -308,12 +404,15 @@ FreeListAllocator<Policy, CoalescePolicy>& FreeListAllocator<Policy, CoalescePol
     m_capacityInBytes = _other.m_capacityInBytes;
     m_usedInBytes = _other.m_usedInBytes;
     m_totalOverhead = _other.m_totalOverhead;
+    m_stats = _other.m_stats;
+    m_tlsf = std::exchange(_other.m_tlsf, {});
 
     _other.m_bufferBytes = nullptr;
     _other.m_freeListHead = nullptr;
     _other.m_capacityInBytes = 0;
     _other.m_usedInBytes = 0;
     _other.m_totalOverhead = 0;
+    _other.m_stats = nullptr;
 
     return *this;
 }
@@ -337,6 +436,9 @@ void* FreeListAllocator<Policy, CoalescePolicy>::allocateInternal(size_t _sizeIn
     if (_sizeInBytes == 0) return nullptr;
 
     size_t alignedSize = alignSize(_sizeInBytes);
+
+    if constexpr (Policy == FreeListAllocatorPolicy::tlsf) return tlsfAllocate(alignedSize);
+
     size_t totalSize = SIZEOF_HEADER + alignedSize;
 
     BlockHeader* prev = nullptr;
@@ -355,6 +457,7 @@ void* FreeListAllocator<Policy, CoalescePolicy>::allocateInternal(size_t _sizeIn
                 unlinkFromFreeList(prev, current);
                 current->isFree = false;
                 m_usedInBytes += alignedSize;
+                if (m_stats) m_stats->allocate(alignedSize);
                 return current->userData;
             }
             prev = current;
@@ -383,6 +486,7 @@ void* FreeListAllocator<Policy, CoalescePolicy>::allocateInternal(size_t _sizeIn
             unlinkFromFreeList(bestFitPrev, bestFit);
             bestFit->isFree = false;
             m_usedInBytes += alignedSize;
+            if (m_stats) m_stats->allocate(alignedSize);
             return bestFit->userData;
         }
     }
@@ -408,6 +512,7 @@ void* FreeListAllocator<Policy, CoalescePolicy>::allocateInternal(size_t _sizeIn
             unlinkFromFreeList(bestFitPrev, bestFit);
             bestFit->isFree = false;
             m_usedInBytes += alignedSize;
+            if (m_stats) m_stats->allocate(alignedSize);
             return bestFit->userData;
         }
     }
@@ -479,6 +584,13 @@ void FreeListAllocator<Policy, CoalescePolicy>::deallocate(void* _ptr, size_t _s
 
     size_t alignedSize = alignSize(_sizeInBytes);
     m_usedInBytes -= alignedSize;
+    if (m_stats) m_stats->deallocate(alignedSize);
+
+    if constexpr (Policy == FreeListAllocatorPolicy::tlsf)
+    {
+        tlsfDeallocate(block);
+        return;
+    }
 
     // Insert into free list
     insertIntoFreeList(block);
@@ -619,6 +731,15 @@ void FreeListAllocator<Policy, CoalescePolicy>::reset()
     m_freeListHead->isFree = true;
     m_freeListHead->next = nullptr;
 
+    if constexpr (Policy == FreeListAllocatorPolicy::tlsf)
+    {
+        m_tlsf = {};
+        m_freeListHead->links.prevPhysical = nullptr;
+        tlsfInsert(std::exchange(m_freeListHead, nullptr));
+    }
+
+    if (m_stats) m_stats->deallocate(m_usedInBytes);
+
     m_usedInBytes = 0;
     m_totalOverhead = SIZEOF_HEADER;
 }
@@ -672,6 +793,8 @@ FreeListAllocator<Policy, CoalescePolicy>::getBuffer() const noexcept
 template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
 size_t FreeListAllocator<Policy, CoalescePolicy>::getFreeBlockCount() const noexcept
 {
+    if constexpr (Policy == FreeListAllocatorPolicy::tlsf) return m_tlsf.freeBlockCount;
+
     size_t count = 0;
     BlockHeader* current = m_freeListHead;
 
@@ -690,6 +813,16 @@ size_t FreeListAllocator<Policy, CoalescePolicy>::getLargestFreeBlock() const no
     size_t largest = 0;
     BlockHeader* current = m_freeListHead;
 
+    // tlsf: the largest block is in the highest size class with one
+    if constexpr (Policy == FreeListAllocatorPolicy::tlsf)
+    {
+        if (m_tlsf.flBitmap != 0)
+        {
+            const size_t fl = std::bit_width(m_tlsf.flBitmap) - 1;
+            current = m_tlsf.heads[fl][std::bit_width(m_tlsf.slBitmaps[fl]) - 1];
+        }
+    }
+
     while (current != nullptr)
     {
         if (current->size > largest)
@@ -712,6 +845,30 @@ float FreeListAllocator<Policy, CoalescePolicy>::getFragmentationRatio() const n
     return 1.0f - (static_cast<float>(largest) / static_cast<float>(totalFree));
 }
 
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+void FreeListAllocator<Policy, CoalescePolicy>::setStats(AllocationStats* _stats) noexcept
+{
+    if (m_stats)
+    {
+        m_stats->deallocate(m_usedInBytes);
+        m_stats->release(m_capacityInBytes);
+    }
+
+    m_stats = _stats;
+
+    if (m_stats)
+    {
+        m_stats->reserve(m_capacityInBytes);
+        if (m_usedInBytes > 0) m_stats->allocate(m_usedInBytes);
+    }
+}
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+AllocationStats* FreeListAllocator<Policy, CoalescePolicy>::getStats() const noexcept
+{
+    return m_stats;
+}
+
 template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
 bool FreeListAllocator<Policy, CoalescePolicy>::operator==(
     const FreeListAllocator& _other) const noexcept
@@ -727,4 +884,169 @@ bool FreeListAllocator<Policy, CoalescePolicy>::operator!=(
     return !(*this == _other);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// TLSF
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+void FreeListAllocator<Policy, CoalescePolicy>::tlsfMapping(size_t _size, size_t& _fl,
+                                                            size_t& _sl) noexcept
+{
+    if (_size < TLSF_SMALL_BLOCK)
+    {
+        _fl = 0;
+        _sl = _size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT);
+        return;
+    }
+
+    // the power of two gives the first level, the next TLSF_SL_SHIFT bits the second one
+    const size_t log2 = std::bit_width(_size) - 1;
+    _fl = log2 - (TLSF_FL_SHIFT - 1);
+    _sl = (_size >> (log2 - TLSF_SL_SHIFT)) ^ TLSF_SL_COUNT;
+}
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+typename FreeListAllocator<Policy, CoalescePolicy>::BlockHeader*
+FreeListAllocator<Policy, CoalescePolicy>::tlsfFindFree(size_t _size) const noexcept
+{
+    // rounded up to the next class: any block of the class found fits, no list is walked
+    size_t rounded = _size;
+    if (rounded >= TLSF_SMALL_BLOCK)
+    {
+        rounded += (size_t(1) << (std::bit_width(rounded) - 1 - TLSF_SL_SHIFT)) - 1;
+    }
+
+    size_t fl = 0, sl = 0;
+    tlsfMapping(rounded, fl, sl);
+    if (fl >= TLSF_FL_COUNT) return nullptr;
+
+    uint32_t slMap = m_tlsf.slBitmaps[fl] & (~uint32_t(0) << sl);
+
+    if (slMap == 0)
+    {
+        const uint64_t flMap = uint64_t(m_tlsf.flBitmap) & (~uint64_t(0) << (fl + 1));
+        if (flMap == 0) return nullptr;
+
+        fl = std::countr_zero(flMap);
+        slMap = m_tlsf.slBitmaps[fl];
+    }
+
+    return m_tlsf.heads[fl][std::countr_zero(slMap)];
+}
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+void FreeListAllocator<Policy, CoalescePolicy>::tlsfInsert(BlockHeader* _block) noexcept
+{
+    size_t fl = 0, sl = 0;
+    tlsfMapping(_block->size, fl, sl);
+
+    BlockHeader*& head = m_tlsf.heads[fl][sl];
+
+    _block->next = head;
+    _block->links.prevFree = nullptr;
+    if (head != nullptr) head->links.prevFree = _block;
+    head = _block;
+
+    m_tlsf.flBitmap |= uint32_t(1) << fl;
+    m_tlsf.slBitmaps[fl] |= uint32_t(1) << sl;
+    ++m_tlsf.freeBlockCount;
+}
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+void FreeListAllocator<Policy, CoalescePolicy>::tlsfRemove(BlockHeader* _block) noexcept
+{
+    size_t fl = 0, sl = 0;
+    tlsfMapping(_block->size, fl, sl);
+
+    BlockHeader*& head = m_tlsf.heads[fl][sl];
+
+    if (_block->links.prevFree != nullptr)
+    {
+        _block->links.prevFree->next = _block->next;
+    }
+    else
+    {
+        head = _block->next;
+    }
+    if (_block->next != nullptr) _block->next->links.prevFree = _block->links.prevFree;
+
+    _block->next = nullptr;
+    _block->links.prevFree = nullptr;
+
+    if (head == nullptr)
+    {
+        m_tlsf.slBitmaps[fl] &= ~(uint32_t(1) << sl);
+        if (m_tlsf.slBitmaps[fl] == 0) m_tlsf.flBitmap &= ~(uint32_t(1) << fl);
+    }
+
+    --m_tlsf.freeBlockCount;
+}
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+typename FreeListAllocator<Policy, CoalescePolicy>::BlockHeader*
+FreeListAllocator<Policy, CoalescePolicy>::nextPhysical(BlockHeader* _block) const noexcept
+{
+    Byte* nextAddr = reinterpret_cast<Byte*>(_block) + _block->size;
+    return nextAddr < m_bufferBytes + m_capacityInBytes ? reinterpret_cast<BlockHeader*>(nextAddr)
+                                                        : nullptr;
+}
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+void* FreeListAllocator<Policy, CoalescePolicy>::tlsfAllocate(size_t _alignedSize)
+{
+    const size_t totalSize = SIZEOF_HEADER + _alignedSize;
+
+    BlockHeader* block = tlsfFindFree(totalSize);
+    if (block == nullptr) return nullptr;
+
+    tlsfRemove(block);
+
+    // Split off the remainder as a free block of its own
+    if (block->size - totalSize >= MIN_BLOCK_SIZE)
+    {
+        Byte* restAddr = reinterpret_cast<Byte*>(block) + totalSize;
+        BlockHeader* rest = reinterpret_cast<BlockHeader*>(restAddr);
+
+        rest->size = block->size - totalSize;
+        rest->isFree = true;
+        rest->links.prevPhysical = block;
+        if (BlockHeader* next = nextPhysical(rest)) next->links.prevPhysical = rest;
+
+        block->size = totalSize;
+        m_totalOverhead += SIZEOF_HEADER;
+
+        tlsfInsert(rest);
+    }
+
+    block->isFree = false;
+    m_usedInBytes += _alignedSize;
+    if (m_stats) m_stats->allocate(_alignedSize);
+
+    return block->userData;
+}
+
+template <FreeListAllocatorPolicy Policy, CoalescingPolicy CoalescePolicy>
+void FreeListAllocator<Policy, CoalescePolicy>::tlsfDeallocate(BlockHeader* _block) noexcept
+{
+    // Merge with the next block, then into the previous one: at most 3 blocks become one
+    if (BlockHeader* next = nextPhysical(_block); next != nullptr && next->isFree)
+    {
+        tlsfRemove(next);
+        _block->size += next->size;
+        m_totalOverhead -= SIZEOF_HEADER;
+    }
+
+    if (BlockHeader* prev = _block->links.prevPhysical; prev != nullptr && prev->isFree)
+    {
+        tlsfRemove(prev);
+        prev->size += _block->size;
+        m_totalOverhead -= SIZEOF_HEADER;
+        _block = prev;
+    }
+
+    if (BlockHeader* next = nextPhysical(_block)) next->links.prevPhysical = _block;
+
+    tlsfInsert(_block);
+}
+
 } // namespace pieces
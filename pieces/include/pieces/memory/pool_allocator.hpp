@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <new>
 #include <type_traits>
 #include <stdexcept>
@@ -7,6 +9,7 @@
 
 #include "pieces/core/templates.hpp"
 #include "pieces/containers/bitset.hpp"
+#include "pieces/memory/allocation_stats.hpp"
 
 namespace pieces
 {
@@ -26,6 +29,12 @@ enum class PoolAllocatorPolicy : uint8_t
  * A pool allocator allows for random access allocation and deallocation of objects
  * within a fixed-size buffer.
  *
+ * The slots are found in two levels: a summary bit per word of the slots states, set while the
+ * word is full, and a hint on the first word that may not be. A single slot is a countr_zero in
+ * the first summary word with a clear bit from the hint, then one in its word; a run of slots is
+ * searched a word at a time (BitSet::findClearRun) from the hint. Filling the pool no longer
+ * slows it down: the full words before the hint are never looked at again.
+ *
  * @tparam T The type of objects to allocate memory for.
  *
  * @note This allocator operates in base T for size, alignment, and all related operations.
@@ -43,13 +52,21 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
     static constexpr size_t ALIGNOF_VALUE = alignof(ValueType);
     static constexpr size_t SIZEOF_VALUE = sizeof(ValueType);
 
+    static constexpr size_t BITS_PER_WORD = sizeof(BitSet::Word) * 8;
+
     Byte* m_bufferBytes;
     BitSet m_slotsState;
+    BitSet m_fullWords; // a bit per word of m_slotsState, set while the word is full
+
+    // Every word of m_slotsState before this one is full
+    size_t m_freeWordHint = 0;
 
     // Expressed in Ts
     size_t m_capacity;
     size_t m_size;
 
+    AllocationStats* m_stats = nullptr;
+
    public:
     /**
      * @brief Constructs a PoolAllocator with a given capacity in T objects.
@@ -59,7 +76,11 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
      * @throws std::invalid_argument if _capacity is zero.
      */
     explicit PoolAllocator(size_t _capacity)
-        : m_bufferBytes(nullptr), m_slotsState(_capacity), m_capacity(_capacity), m_size(0)
+        : m_bufferBytes(nullptr),
+          m_slotsState(_capacity),
+          m_fullWords(m_slotsState.wordCount()),
+          m_capacity(_capacity),
+          m_size(0)
     {
         if (_capacity == 0) throw std::invalid_argument("Capacity must be greater than zero.");
 
@@ -71,33 +92,46 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
         std::memset(m_bufferBytes, 0, bytesNeeded);
     }
 
-    ~PoolAllocator() { ::operator delete(m_bufferBytes, std::align_val_t{alignof(ValueType)}); }
+    ~PoolAllocator()
+    {
+        setStats(nullptr);
+        ::operator delete(m_bufferBytes, std::align_val_t{alignof(ValueType)});
+    }
 
     PoolAllocator(PoolAllocator&& _other) noexcept
         : m_bufferBytes(_other.m_bufferBytes),
           m_slotsState(std::move(_other.m_slotsState)),
+          m_fullWords(std::move(_other.m_fullWords)),
+          m_freeWordHint(_other.m_freeWordHint),
           m_capacity(_other.m_capacity),
-          m_size(_other.m_size)
+          m_size(_other.m_size),
+          m_stats(_other.m_stats)
     {
         _other.m_bufferBytes = nullptr;
         _other.m_capacity = 0;
         _other.m_size = 0;
+        _other.m_stats = nullptr;
     }
 
     PoolAllocator& operator=(PoolAllocator&& _other) noexcept
     {
         if (this == &_other) return *this;
 
+        setStats(nullptr);
         ::operator delete(m_bufferBytes, std::align_val_t{alignof(ValueType)});
 
         m_bufferBytes = _other.m_bufferBytes;
         m_slotsState = std::move(_other.m_slotsState);
+        m_fullWords = std::move(_other.m_fullWords);
+        m_freeWordHint = _other.m_freeWordHint;
         m_capacity = _other.m_capacity;
         m_size = _other.m_size;
+        m_stats = _other.m_stats;
 
         _other.m_bufferBytes = nullptr;
         _other.m_capacity = 0;
         _other.m_size = 0;
+        _other.m_stats = nullptr;
 
         return *this;
     }
@@ -117,11 +151,17 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
 
         if (_count > 1) return allocateContiguous(_count);
 
-        size_t slotIndex = m_slotsState.findFirstClear();
-        if (slotIndex >= m_capacity) return nullptr;
+        const size_t wordIndex = m_fullWords.findFirstClearFrom(m_freeWordHint);
+        if (wordIndex >= m_fullWords.size()) return nullptr;
 
-        m_slotsState.setBit(slotIndex);
+        m_freeWordHint = wordIndex;
+
+        const size_t slotIndex =
+            wordIndex * BITS_PER_WORD + std::countr_one(m_slotsState.data()[wordIndex]);
+
+        markUsed(slotIndex, 1);
         m_size += _count;
+        if (m_stats) m_stats->allocate(SIZEOF_VALUE);
 
         Byte* slotPtr = m_bufferBytes + slotIndex * sizeof(ValueType);
         return reinterpret_cast<ValueType*>(slotPtr);
@@ -142,16 +182,12 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
     {
         if (_idx + _count >= m_capacity) throw std::runtime_error("Index out of bounds.");
 
-        size_t actualCount = 0;
+        if (_count == 0 || m_slotsState.countRange(_idx, _count) != 0) return nullptr;
 
-        for (size_t i = 0; i < _count; ++i)
-        {
-            if (m_slotsState.testBit(_idx + i)) return nullptr;
-            m_slotsState.setBit(_idx + i);
-            ++actualCount;
-        }
+        markUsed(_idx, _count);
 
-        m_size += actualCount;
+        m_size += _count;
+        if (m_stats) m_stats->allocate(_count * SIZEOF_VALUE);
 
         Byte* slotPtr = m_bufferBytes + _idx * sizeof(ValueType);
         return reinterpret_cast<ValueType*>(slotPtr);
@@ -179,16 +215,10 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
         size_t slotIndex = offsetInBytes / sizeof(ValueType);
         if (slotIndex + _count > m_capacity) return;
 
-        size_t actualCount = 0;
-
-        for (size_t i = 0; i < _count && slotIndex + i < m_capacity; ++i)
-        {
-            if (!m_slotsState.testBit(slotIndex + i)) continue;
-            m_slotsState.clearBit(slotIndex + i);
-            ++actualCount;
-        }
+        const size_t actualCount = markFree(slotIndex, _count);
 
         m_size -= actualCount;
+        if (m_stats) m_stats->deallocate(actualCount * SIZEOF_VALUE);
     }
 
     /**
@@ -205,16 +235,10 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
     {
         if (_idx >= m_capacity) throw std::runtime_error("Index out of bounds.");
 
-        size_t actualCount = 0;
-
-        for (size_t i = 0; i < _count && _idx + i < m_capacity; ++i)
-        {
-            if (!m_slotsState.testBit(_idx + i)) continue;
-            m_slotsState.clearBit(_idx + i);
-            ++actualCount;
-        }
+        const size_t actualCount = markFree(_idx, std::min(_count, m_capacity - _idx));
 
         m_size -= actualCount;
+        if (m_stats) m_stats->deallocate(actualCount * SIZEOF_VALUE);
     }
 
     /**
@@ -283,10 +307,9 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
 
         size_t writeIndex = 0;
 
-        for (size_t readIndex = 0; readIndex < m_capacity; ++readIndex)
+        for (size_t readIndex = m_slotsState.findFirstSet(); readIndex < m_capacity;
+             readIndex = m_slotsState.findFirstSetFrom(readIndex + 1))
         {
-            if (!m_slotsState.testBit(readIndex)) continue;
-
             if (writeIndex != readIndex)
             {
                 Byte* srcPtr = m_bufferBytes + readIndex * sizeof(ValueType);
@@ -295,21 +318,50 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
                 std::memcpy(destPtr, srcPtr, sizeof(ValueType));
             }
 
-            m_slotsState.setBit(writeIndex);
-            m_slotsState.clearBit(readIndex);
-
             ++writeIndex;
         }
 
         m_size = writeIndex;
+
+        m_slotsState.clearAll();
+        m_fullWords.clearAll();
+        m_freeWordHint = 0;
+        markUsed(0, m_size);
     }
 
     void reset()
     {
+        if (m_stats) m_stats->deallocate(m_size * SIZEOF_VALUE);
+
         m_slotsState.clearAll();
+        m_fullWords.clearAll();
+        m_freeWordHint = 0;
         m_size = 0;
     }
 
+    /**
+     * @brief Attaches the counters of a subsystem to the allocator (nullptr detaches it), the
+     * buffer and the current allocations are moved over from the previous ones.
+     */
+    void setStats(AllocationStats* _stats) noexcept
+    {
+        if (m_stats)
+        {
+            m_stats->deallocate(m_size * SIZEOF_VALUE);
+            m_stats->release(m_capacity * SIZEOF_VALUE);
+        }
+
+        m_stats = _stats;
+
+        if (m_stats)
+        {
+            m_stats->reserve(m_capacity * SIZEOF_VALUE);
+            if (m_size > 0) m_stats->allocate(m_size * SIZEOF_VALUE);
+        }
+    }
+
+    [[nodiscard]] AllocationStats* getStats() const noexcept { return m_stats; }
+
     [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
 
     [[nodiscard]] size_t used() const noexcept { return m_size; }
@@ -351,30 +403,51 @@ class PoolAllocator final : public NonCopyable<PoolAllocator<T, Policy>>
    private:
     ValueType* allocateContiguous(size_t _count)
     {
-        for (size_t startSlot = 0; startSlot <= m_capacity - _count; ++startSlot)
-        {
-            if (hasContiguousFreeSlots(startSlot, _count))
-            {
-                for (size_t i = 0; i < _count; ++i) m_slotsState.setBit(startSlot + i);
+        const size_t startSlot =
+            m_slotsState.findClearRun(_count, m_freeWordHint * BITS_PER_WORD);
+        if (startSlot >= m_capacity) return nullptr;
 
-                m_size += _count;
+        markUsed(startSlot, _count);
 
-                Byte* blockPtr = m_bufferBytes + startSlot * sizeof(ValueType);
-                return reinterpret_cast<ValueType*>(blockPtr);
-            }
-        }
+        m_size += _count;
+        if (m_stats) m_stats->allocate(_count * SIZEOF_VALUE);
 
-        return nullptr;
+        Byte* blockPtr = m_bufferBytes + startSlot * sizeof(ValueType);
+        return reinterpret_cast<ValueType*>(blockPtr);
     }
 
-    bool hasContiguousFreeSlots(size_t _startSlot, size_t _count) const noexcept
+    // Sets the states of the slots and the summary bits of the words they fill.
+    void markUsed(size_t _start, size_t _count) noexcept
     {
-        for (size_t i = 0; i < _count; ++i)
+        if (_count == 0) return;
+
+        m_slotsState.setRange(_start, _count);
+
+        const size_t lastWord = (_start + _count - 1) / BITS_PER_WORD;
+        for (size_t i = _start / BITS_PER_WORD; i <= lastWord; ++i)
         {
-            if (_startSlot + i >= m_capacity || m_slotsState.testBit(_startSlot + i)) return false;
+            if (m_slotsState.isWordFull(i)) m_fullWords.setBit(i);
         }
+    }
+
+    // Clears the states of the slots and the summary bits of their words; returns the slots that
+    // were used.
+    size_t markFree(size_t _start, size_t _count) noexcept
+    {
+        if (_count == 0) return 0;
+
+        const size_t usedCount = m_slotsState.countRange(_start, _count);
+        if (usedCount == 0) return 0;
+
+        m_slotsState.clearRange(_start, _count);
+
+        const size_t firstWord = _start / BITS_PER_WORD;
+        const size_t lastWord = (_start + _count - 1) / BITS_PER_WORD;
+        m_fullWords.clearRange(firstWord, lastWord - firstWord + 1);
+
+        m_freeWordHint = std::min(m_freeWordHint, firstWord);
 
-        return true;
+        return usedCount;
     }
 };
 
@@ -1,18 +1,41 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <new>
 #include <type_traits>
 #include <stdexcept>
 #include <memory>
-#include <functional>
 
 #include "pieces/core/templates.hpp"
+#include "pieces/memory/allocation_stats.hpp"
+#include "pieces/memory/base_allocator.hpp"
+
+// 0 turns every ProxyAllocator into a plain forward to its allocator
+#ifndef PIECES_ALLOCATOR_INSTRUMENTATION
+#define PIECES_ALLOCATOR_INSTRUMENTATION 1
+#endif
+
+#if PIECES_ALLOCATOR_INSTRUMENTATION
+#include "pieces/containers/flat_hash_map.hpp"
+#endif
 
 namespace pieces
 {
 
 /**
- * @brief A wrapper around an allocator that allows to instruement it.
+ * @brief A wrapper around an allocator that instruments it: the allocations made through it
+ * feed the AllocationStats attached with setStats(), their count and bytes, the peak, the
+ * histogram of their sizes and, timed from allocate() to deallocate(), that of their lifetimes.
+ *
+ * The stats are the tag of the allocations: the proxies of a subsystem share its stats. Attach
+ * them to the proxy or to the allocator behind it, not both, or the bytes count twice.
+ *
+ * Without stats the proxy only pays a null check; with PIECES_ALLOCATOR_INSTRUMENTATION set to 0
+ * it forwards every call and setStats() is a no-op.
+ *
+ * @note Thread-compatible like the allocators: the stats may be shared across threads, a proxy
+ * may not.
  */
 template <typename T, typename A = BaseAllocator<T>>
     requires std::is_trivially_destructible_v<T>
@@ -24,64 +47,152 @@ class ProxyAllocator final : public NonCopyable<ProxyAllocator<T, A>>,
     using ValueType = A::ValueType;
 
    private:
-    using OnAllocateCallback = std::function<void(void*, size_t)>;
-    using OnDeallocateCallback = std::function<void(void*, size_t)>;
-    using OnConstructCallback = std::function<void(void*, const void*)>;
-    using OnDestroyCallback = std::function<void(void*)>;
+    A* m_allocator;
 
-    OnAllocateCallback m_onAllocate;
-    OnDeallocateCallback m_onDeallocate;
-    OnConstructCallback m_onConstruct;
-    OnDestroyCallback m_onDestroy;
+#if PIECES_ALLOCATOR_INSTRUMENTATION
+    using Clock = std::chrono::steady_clock;
 
-    A* m_allocator;
+    struct LiveAllocation
+    {
+        Clock::time_point start;
+        size_t bytes;
+    };
+
+    AllocationStats* m_stats = nullptr;
+
+    // The allocations made while stats were attached, the others are not deallocated from them
+    FlatHashMap<const void*, LiveAllocation> m_live;
+    size_t m_liveBytes = 0;
+#endif
 
    public:
-    explicit ProxyAllocator(A* _allocator, const OnAllocateCallback& _onAllocate,
-                            const OnDeallocateCallback& _onDeallocate,
-                            const OnConstructCallback& _onConstruct,
-                            const OnDestroyCallback& _onDestroy)
-        : m_allocator(_allocator),
-          m_onAllocate(_onAllocate),
-          m_onDeallocate(_onDeallocate),
-          m_onConstruct(_onConstruct),
-          m_onDestroy(_onDestroy)
+    explicit ProxyAllocator(A* _allocator, AllocationStats* _stats = nullptr)
+        : m_allocator(_allocator)
     {
         if (!_allocator) throw std::invalid_argument("Allocator cannot be null.");
+
+        setStats(_stats);
     }
 
+    ~ProxyAllocator() { setStats(nullptr); }
+
    public:
-    [[nodiscard]] T* allocate(size_t _count)
+    [[nodiscard]] ValueType* allocate(size_t _count)
     {
-        T* ptr = m_allocator.allocate(_count);
-        if (ptr) m_onAllocate(ptr, _count);
+        ValueType* ptr = m_allocator->allocate(_count);
+
+#if PIECES_ALLOCATOR_INSTRUMENTATION
+        if (ptr && m_stats) record(ptr, _count * sizeof(ValueType));
+#endif
+
         return ptr;
     }
 
-    void deallocate(T* _ptr, size_t _count)
+    void deallocate(ValueType* _ptr, size_t _count)
     {
-        if (_ptr) m_onDeallocate(static_cast<void*>(_ptr), _count);
-        m_allocator.deallocate(static_cast<T*>(_ptr), _count);
+#if PIECES_ALLOCATOR_INSTRUMENTATION
+        if (_ptr && m_stats) forget(_ptr);
+#endif
+
+        m_allocator->deallocate(_ptr, _count);
     }
 
     template <typename U, typename... Args>
     void construct(U* _ptr, Args&&... _args) noexcept(std::is_nothrow_constructible_v<U, Args...>)
     {
-        if (_ptr) m_onConstruct(static_cast<void*>(_ptr), std::forward<Args>(_args)...);
-        m_allocator.construct(_ptr, std::forward<Args>(_args)...);
+        // BaseAllocator::construct() takes the type explicitly, the others deduce it
+        if constexpr (requires { m_allocator->construct(_ptr, std::forward<Args>(_args)...); })
+        {
+            m_allocator->construct(_ptr, std::forward<Args>(_args)...);
+        }
+        else
+        {
+            m_allocator->template construct<U>(_ptr, std::forward<Args>(_args)...);
+        }
     }
 
     template <typename U>
     void destroy(U* _ptr) noexcept(std::is_nothrow_destructible_v<U>)
     {
-        if (_ptr) m_onDestroy(static_cast<void*>(_ptr));
-        m_allocator.destroy(_ptr);
+        m_allocator->destroy(_ptr);
     }
 
-    [[nodiscard]] bool owns(void* _ptr) const noexcept { return m_allocator.owns(_ptr); }
+    [[nodiscard]] bool owns(void* _ptr) const noexcept { return m_allocator->owns(_ptr); }
 
     // Not instrumentable but required by the Allocator concept.
-    [[nodiscard]] Byte* getBuffer() const noexcept { return m_allocator.getBuffer(); }
+    [[nodiscard]] Byte* getBuffer() const noexcept
+        requires requires(const A& _allocator) { _allocator.getBuffer(); }
+    {
+        return m_allocator->getBuffer();
+    }
+
+    [[nodiscard]] A* getAllocator() const noexcept { return m_allocator; }
+
+    /**
+     * @brief Attaches the counters of a subsystem to the proxy (nullptr detaches it), the live
+     * allocations made through it are moved over from the previous ones.
+     */
+    void setStats([[maybe_unused]] AllocationStats* _stats) noexcept
+    {
+#if PIECES_ALLOCATOR_INSTRUMENTATION
+        if (m_stats && m_liveBytes > 0) m_stats->deallocate(m_liveBytes);
+
+        m_stats = _stats;
+
+        if (!m_stats)
+        {
+            m_live.clear();
+            m_liveBytes = 0;
+        }
+        else if (m_liveBytes > 0)
+        {
+            m_stats->allocate(m_liveBytes);
+        }
+#endif
+    }
+
+    [[nodiscard]] AllocationStats* getStats() const noexcept
+    {
+#if PIECES_ALLOCATOR_INSTRUMENTATION
+        return m_stats;
+#else
+        return nullptr;
+#endif
+    }
+
+#if PIECES_ALLOCATOR_INSTRUMENTATION
+   private:
+    void record(const void* _ptr, size_t _bytes) noexcept
+    {
+        m_stats->allocate(_bytes);
+        m_stats->recordSize(_bytes);
+
+        // Without the memory to track it, the allocation stays in the histogram only
+        try
+        {
+            m_live.insert_or_assign(_ptr, LiveAllocation{Clock::now(), _bytes});
+            m_liveBytes += _bytes;
+        }
+        catch (const std::bad_alloc&)
+        {
+            m_stats->deallocate(_bytes);
+        }
+    }
+
+    void forget(const void* _ptr) noexcept
+    {
+        const auto it = m_live.find(_ptr);
+        if (it == m_live.end()) return;
+
+        const auto lifetime = Clock::now() - it->second.start;
+        m_stats->recordLifetime(uint64_t(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(lifetime).count()));
+        m_stats->deallocate(it->second.bytes);
+
+        m_liveBytes -= it->second.bytes;
+        m_live.erase(it);
+    }
+#endif
 };
 
 } // namespace pieces
@@ -1,13 +1,152 @@
 #pragma once
 
+#include <concepts>
 #include <coroutine>
+#include <cstddef>
+#include <cstring>
 #include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <optional>
+#include <type_traits>
 #include <utility>
 
 namespace pieces
 {
 
+/**
+ * @brief An allocator coroutine frames can come from: allocate(bytes, alignment) or
+ * allocate(bytes) returning a pointer to bytes (a FrameArena, a FreeListAllocator, a
+ * std::pmr::memory_resource, a LinearAllocator<uint8_t>...). deallocate(ptr, bytes) is called
+ * if it has one; arenas without it release the frames when they are reset.
+ */
+template <typename A>
+concept CoroutineFrameAllocator =
+    requires(A& _allocator, size_t _size) { _allocator.allocate(_size, _size); } ||
+    requires(A& _allocator, size_t _size) { _allocator.allocate(_size); };
+
+/**
+ * @brief The base of the promise types of pieces: the coroutine frames come from the allocator
+ * following std::allocator_arg in the parameters of the coroutine (after the object, for a
+ * member function), from the global operator new otherwise.
+ *
+ *     Generator<Mesh> loadMeshes(std::allocator_arg_t, FrameArena& _arena, Level& _level);
+ *
+ * The allocator must outlive the coroutine. The deallocation function and the allocator are
+ * stored after the frame, so the handles stay one pointer.
+ */
+class CoroutineFrameAllocation
+{
+   private:
+    struct FrameDeleter
+    {
+        void (*deallocate)(void* _allocator, void* _frame, size_t _size) noexcept;
+        void* allocator;
+    };
+
+    static constexpr size_t k_frameAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+   public:
+    static void* operator new(size_t _size)
+    {
+        void* frame = ::operator new(totalSize(_size));
+        storeDeleter(frame, _size, {nullptr, nullptr});
+        return frame;
+    }
+
+    template <CoroutineFrameAllocator A, typename... Args>
+    static void* operator new(size_t _size, std::allocator_arg_t, A& _allocator, Args&...)
+    {
+        return allocateFrom(_size, _allocator);
+    }
+
+    template <typename Self, CoroutineFrameAllocator A, typename... Args>
+    static void* operator new(size_t _size, Self&, std::allocator_arg_t, A& _allocator, Args&...)
+    {
+        return allocateFrom(_size, _allocator);
+    }
+
+    static void operator delete(void* _frame, size_t _size) noexcept { release(_frame, _size); }
+
+   private:
+    [[nodiscard]] static constexpr size_t deleterOffset(size_t _size) noexcept
+    {
+        return (_size + alignof(FrameDeleter) - 1) & ~(alignof(FrameDeleter) - 1);
+    }
+
+    // Rounded up to the alignment of the frames, for the allocators bumping a pointer
+    [[nodiscard]] static constexpr size_t totalSize(size_t _size) noexcept
+    {
+        const size_t size = deleterOffset(_size) + sizeof(FrameDeleter);
+        return (size + k_frameAlignment - 1) & ~(k_frameAlignment - 1);
+    }
+
+    static void release(void* _frame, size_t _size) noexcept
+    {
+        FrameDeleter deleter;
+        std::memcpy(&deleter, static_cast<std::byte*>(_frame) + deleterOffset(_size),
+                    sizeof(deleter));
+
+        if (deleter.deallocate)
+        {
+            deleter.deallocate(deleter.allocator, _frame, totalSize(_size));
+        }
+        else
+        {
+            ::operator delete(_frame, totalSize(_size));
+        }
+    }
+
+    static void storeDeleter(void* _frame, size_t _size, const FrameDeleter& _deleter) noexcept
+    {
+        std::memcpy(static_cast<std::byte*>(_frame) + deleterOffset(_size), &_deleter,
+                    sizeof(_deleter));
+    }
+
+    template <typename A>
+    static void* allocateFrom(size_t _size, A& _allocator)
+    {
+        const size_t size = totalSize(_size);
+
+        const auto allocate = [&]
+        {
+            if constexpr (requires { _allocator.allocate(size, k_frameAlignment); })
+            {
+                return _allocator.allocate(size, k_frameAlignment);
+            }
+            else
+            {
+                return _allocator.allocate(size);
+            }
+        };
+
+        using Pointer = decltype(allocate());
+
+        void* frame = static_cast<void*>(allocate());
+        if (!frame) throw std::bad_alloc();
+
+        FrameDeleter deleter{nullptr, std::addressof(_allocator)};
+        deleter.deallocate = [](void* _allocatorPtr, void* _framePtr, size_t _frameSize) noexcept
+        {
+            A& allocator = *static_cast<A*>(_allocatorPtr);
+            const auto ptr = static_cast<Pointer>(_framePtr);
+
+            if constexpr (requires { allocator.deallocate(ptr, _frameSize, k_frameAlignment); })
+            {
+                allocator.deallocate(ptr, _frameSize, k_frameAlignment);
+            }
+            else if constexpr (requires { allocator.deallocate(ptr, _frameSize); })
+            {
+                allocator.deallocate(ptr, _frameSize);
+            }
+        };
+
+        storeDeleter(frame, _size, deleter);
+        return frame;
+    }
+};
+
 /**
  * @brief A simple coroutine task class that can be used to create coroutines in C++20 and later.
  *
@@ -21,7 +160,7 @@ template <typename T>
 class Task
 {
    public:
-    struct promise_type
+    struct promise_type : CoroutineFrameAllocation
     {
         std::optional<T> m_value;
         std::exception_ptr m_exception;
@@ -127,7 +266,7 @@ template <>
 class Task<void>
 {
    public:
-    struct promise_type
+    struct promise_type : CoroutineFrameAllocation
     {
         std::exception_ptr m_exception;
         std::coroutine_handle<> m_continuation;
@@ -212,6 +351,360 @@ class Task<void>
     HandleType m_coro;
 };
 
+template <typename T>
+class Generator;
+
+// The values of a nested generator, yielded one by one: co_yield elementsOf(children());
+template <typename T>
+struct ElementsOf
+{
+    Generator<T> generator;
+};
+
+template <typename T>
+[[nodiscard]] ElementsOf<T> elementsOf(Generator<T>&& _generator) noexcept
+{
+    return {std::move(_generator)};
+}
+
+/**
+ * @brief A lazy synchronous generator, an input range of the values the coroutine yields: the
+ * coroutine runs up to its next co_yield on each increment, so the results stream without being
+ * collected in a vector first.
+ *
+ * The values are not copied: the iterator points to the yielded object, alive in the frame of
+ * the coroutine until the next increment (moving out of it is fine). A const lvalue is copied
+ * into the frame. Nested generators (co_yield elementsOf(...)) are resumed directly by symmetric
+ * transfer, without going through the generators above them.
+ *
+ * The frame is allocated once, from the allocator after std::allocator_arg if any (see
+ * CoroutineFrameAllocation); a generator consumed where it is created can have it elided.
+ * Exceptions leave the coroutine through the increment that resumed it.
+ *
+ * @tparam T The type of the values yielded.
+ */
+template <typename T>
+class Generator
+{
+   public:
+    using value_type = std::remove_cvref_t<T>;
+    using reference = value_type&;
+
+    struct promise_type : CoroutineFrameAllocation
+    {
+        value_type* m_value = nullptr;                // the root: the current value
+        promise_type* m_root = this;                  // the generator iterated over
+        std::coroutine_handle<promise_type> m_leaf;   // the root: the innermost running one
+        std::coroutine_handle<promise_type> m_parent; // the generator this one is nested in
+        std::exception_ptr m_exception;               // of a nested generator, for its parent
+
+        Generator get_return_object() noexcept
+        {
+            m_leaf = std::coroutine_handle<promise_type>::from_promise(*this);
+            return Generator{m_leaf};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            // A nested generator hands over to its parent
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> _handle) noexcept
+            {
+                promise_type& promise = _handle.promise();
+                if (!promise.m_parent) return std::noop_coroutine();
+
+                promise.m_root->m_leaf = promise.m_parent;
+                return promise.m_parent;
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        std::suspend_always yield_value(value_type& _value) noexcept
+        {
+            m_root->m_value = std::addressof(_value);
+            return {};
+        }
+
+        std::suspend_always yield_value(value_type&& _value) noexcept
+        {
+            m_root->m_value = std::addressof(_value);
+            return {};
+        }
+
+        struct CopyAwaiter
+        {
+            value_type m_copy; // lives across the suspension, in the frame
+            promise_type* m_root;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<>) noexcept
+            {
+                m_root->m_value = std::addressof(m_copy);
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        CopyAwaiter yield_value(const value_type& _value)
+            requires std::copy_constructible<value_type>
+        {
+            return {_value, m_root};
+        }
+
+        struct NestedAwaiter
+        {
+            Generator m_nested;
+
+            bool await_ready() const noexcept { return !m_nested.m_coro; }
+
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> _parent) noexcept
+            {
+                promise_type& nested = m_nested.m_coro.promise();
+                promise_type& root = *_parent.promise().m_root;
+
+                nested.m_root = &root;
+                nested.m_parent = _parent;
+                root.m_leaf = m_nested.m_coro;
+
+                return m_nested.m_coro;
+            }
+
+            void await_resume()
+            {
+                if (m_nested.m_coro && m_nested.m_coro.promise().m_exception)
+                {
+                    std::rethrow_exception(m_nested.m_coro.promise().m_exception);
+                }
+            }
+        };
+
+        NestedAwaiter yield_value(ElementsOf<T>&& _elements) noexcept
+        {
+            return {std::move(_elements.generator)};
+        }
+
+        void return_void() noexcept {}
+
+        // The parent of a nested generator rethrows, the root leaves through the increment
+        void unhandled_exception()
+        {
+            if (!m_parent) throw;
+            m_exception = std::current_exception();
+        }
+
+        // Not awaitable, a generator suspends at its co_yields only
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+
+    using HandleType = std::coroutine_handle<promise_type>;
+
+    class Iterator
+    {
+       private:
+        HandleType m_coro;
+
+       public:
+        using value_type = Generator::value_type;
+        using difference_type = ptrdiff_t;
+
+        Iterator() noexcept = default;
+        explicit Iterator(HandleType _coro) noexcept : m_coro(_coro) {}
+
+        [[nodiscard]] reference operator*() const noexcept
+        {
+            return *m_coro.promise().m_value;
+        }
+
+        [[nodiscard]] value_type* operator->() const noexcept { return m_coro.promise().m_value; }
+
+        Iterator& operator++()
+        {
+            m_coro.promise().m_leaf.resume();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        [[nodiscard]] friend bool operator==(const Iterator& _it, std::default_sentinel_t) noexcept
+        {
+            return !_it.m_coro || _it.m_coro.done();
+        }
+    };
+
+    explicit Generator(HandleType _handle) noexcept : m_coro(_handle) {}
+
+    ~Generator()
+    {
+        if (m_coro) m_coro.destroy();
+    }
+
+    Generator(Generator&& _other) noexcept : m_coro(std::exchange(_other.m_coro, nullptr)) {}
+
+    Generator& operator=(Generator&& _other) noexcept
+    {
+        if (this != &_other)
+        {
+            if (m_coro) m_coro.destroy();
+            m_coro = std::exchange(_other.m_coro, nullptr);
+        }
+
+        return *this;
+    }
+
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
+    // Runs the coroutine up to its first value: call it once
+    [[nodiscard]] Iterator begin()
+    {
+        if (m_coro) m_coro.promise().m_leaf.resume();
+        return Iterator{m_coro};
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+   private:
+    HandleType m_coro;
+};
+
+/**
+ * @brief A lazy asynchronous generator: the coroutine may co_await between its co_yields (a
+ * Task, the completion of a read), and a consumer coroutine awaits the values one by one:
+ *
+ *     while (std::optional<Chunk> chunk = co_await stream.next()) process(*chunk);
+ *
+ * next() transfers to the producer and co_yield back to the consumer by symmetric transfer; if
+ * the producer suspends on something else, the consumer resumes with the value from the thread
+ * that completed it. The values are moved out of the frame, an exception of the producer is
+ * rethrown by the next() that reaches it. The frame comes from the allocator after
+ * std::allocator_arg, if any.
+ *
+ * @tparam T The type of the values yielded.
+ */
+template <typename T>
+class AsyncGenerator
+{
+   public:
+    struct promise_type : CoroutineFrameAllocation
+    {
+        std::optional<T> m_value;
+        std::exception_ptr m_exception;
+        std::coroutine_handle<> m_consumer;
+
+        AsyncGenerator get_return_object() noexcept
+        {
+            return AsyncGenerator{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Back to the consumer awaiting next()
+        struct YieldAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> _handle) noexcept
+            {
+                return _handle.promise().m_consumer;
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        YieldAwaiter final_suspend() noexcept { return {}; }
+
+        template <typename U = T>
+            requires std::constructible_from<T, U&&>
+        YieldAwaiter yield_value(U&& _value)
+        {
+            m_value.emplace(std::forward<U>(_value));
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+    };
+
+    using HandleType = std::coroutine_handle<promise_type>;
+
+    explicit AsyncGenerator(HandleType _handle) noexcept : m_coro(_handle) {}
+
+    ~AsyncGenerator()
+    {
+        if (m_coro) m_coro.destroy();
+    }
+
+    AsyncGenerator(AsyncGenerator&& _other) noexcept : m_coro(std::exchange(_other.m_coro, nullptr))
+    {
+    }
+
+    AsyncGenerator& operator=(AsyncGenerator&& _other) noexcept
+    {
+        if (this != &_other)
+        {
+            if (m_coro) m_coro.destroy();
+            m_coro = std::exchange(_other.m_coro, nullptr);
+        }
+
+        return *this;
+    }
+
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+
+    /// The next value, empty once the producer returned. Await one next() at a time.
+    [[nodiscard]] auto next() noexcept
+    {
+        struct Awaiter
+        {
+            HandleType m_coro;
+
+            bool await_ready() const noexcept { return !m_coro || m_coro.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> _consumer) noexcept
+            {
+                m_coro.promise().m_value.reset();
+                m_coro.promise().m_consumer = _consumer;
+                return m_coro;
+            }
+
+            std::optional<T> await_resume()
+            {
+                if (!m_coro) return std::nullopt;
+
+                promise_type& promise = m_coro.promise();
+                if (m_coro.done())
+                {
+                    if (promise.m_exception) std::rethrow_exception(promise.m_exception);
+                    return std::nullopt;
+                }
+
+                return std::move(promise.m_value);
+            }
+        };
+
+        return Awaiter{m_coro};
+    }
+
+    /// Whether the producer returned (or threw); next() returns nothing then.
+    [[nodiscard]] bool isDone() const noexcept { return !m_coro || m_coro.done(); }
+
+   private:
+    HandleType m_coro;
+};
+
 /**
  * @brief A simple awaitable class that can be used to create coroutines in C++20 and later.
  *
@@ -1,44 +1,529 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
-#include <optional>
 
-#include <utf8.h>
+#include <pieces/core/result.hpp>
+#include <pieces/internal/error_codes.hpp>
+#include <pieces/intrinsics/simd.hpp>
 
 namespace pieces
 {
 namespace utils
 {
+namespace detail
+{
+
+enum class TranscodeStatus : uint8_t
+{
+    ok,
+    invalid,  // a malformed sequence or codepoint at read
+    overflow, // the output is full, read stops before what did not fit
+};
+
+struct TranscodeResult
+{
+    size_t read;
+    size_t written;
+    TranscodeStatus status;
+};
+
+// The codepoints the iterator overloads convert at a time, on the stack
+inline constexpr size_t k_transcodeChunkSize = 64;
+
+inline constexpr uint64_t k_asciiHighBits = 0x8080'8080'8080'8080ull;
 
 /**
- * @brief Converts a UTF-8 encoded string to a vector of Unicode codepoints (char32_t).
+ * @brief Widens the ASCII bytes from _src on into _dst, stopping at the first other byte or after
+ * _size: 16 bytes per iteration with a vector register, 8 otherwise.
  *
- * @param utf8 The UTF-8 encoded string to convert.
- * @return std::vector<char32_t> The extracted codepoints.
- *         If the input is not valid UTF-8, an exception will be thrown (handle upstream).
+ * @return How many bytes were ASCII, all written.
  */
-[[nodiscard]] inline std::vector<char32_t> Utf8ToCodepoints(const std::string& utf8)
+[[nodiscard]] inline size_t widenAscii(const unsigned char* SIMD_RESTRICT _src, size_t _size,
+                                       char32_t* SIMD_RESTRICT _dst) noexcept
+{
+    size_t i = 0;
+
+#if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
+    defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= _size; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + i));
+        if (_mm_movemask_epi8(bytes) != 0) break;
+
+        const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+        __m128i* out = reinterpret_cast<__m128i*>(_dst + i);
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+    }
+#elif defined(SIMD_ARM_NEON)
+    for (; i + 16 <= _size; i += 16)
+    {
+        const uint8x16_t bytes = vld1q_u8(_src + i);
+        if (vmaxvq_u8(bytes) >= 0x80) break;
+
+        const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+        const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+
+        uint32_t* out = reinterpret_cast<uint32_t*>(_dst + i);
+        vst1q_u32(out, vmovl_u16(vget_low_u16(low)));
+        vst1q_u32(out + 4, vmovl_u16(vget_high_u16(low)));
+        vst1q_u32(out + 8, vmovl_u16(vget_low_u16(high)));
+        vst1q_u32(out + 12, vmovl_u16(vget_high_u16(high)));
+    }
+#else
+    for (; i + 8 <= _size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, _src + i, sizeof(word));
+        if ((word & k_asciiHighBits) != 0) break;
+
+        for (size_t j = 0; j < 8; ++j) _dst[i + j] = char32_t(_src[i + j]);
+    }
+#endif
+
+    // The block holding the first other byte, or the tail
+    for (; i < _size && _src[i] < 0x80; ++i) _dst[i] = char32_t(_src[i]);
+
+    return i;
+}
+
+/**
+ * @brief Narrows the ASCII codepoints from _src on into _dst, stopping at the first other
+ * codepoint or after _size: 16 codepoints per iteration with a vector register, 8 otherwise.
+ *
+ * @return How many codepoints were ASCII, all written.
+ */
+[[nodiscard]] inline size_t narrowAscii(const char32_t* SIMD_RESTRICT _src, size_t _size,
+                                        unsigned char* SIMD_RESTRICT _dst) noexcept
+{
+    size_t i = 0;
+
+#if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
+    defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+    const __m128i nonAscii = _mm_set1_epi32(~0x7F);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= _size; i += 16)
+    {
+        const __m128i* in = reinterpret_cast<const __m128i*>(_src + i);
+        const __m128i a = _mm_loadu_si128(in);
+        const __m128i b = _mm_loadu_si128(in + 1);
+        const __m128i c = _mm_loadu_si128(in + 2);
+        const __m128i d = _mm_loadu_si128(in + 3);
+
+        const __m128i high =
+            _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), nonAscii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF) break;
+
+        // Below 0x80, the saturating packs only drop the zero bytes
+        const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + i), bytes);
+    }
+#elif defined(SIMD_ARM_NEON)
+    for (; i + 16 <= _size; i += 16)
+    {
+        const uint32_t* in = reinterpret_cast<const uint32_t*>(_src + i);
+        const uint32x4_t a = vld1q_u32(in);
+        const uint32x4_t b = vld1q_u32(in + 4);
+        const uint32x4_t c = vld1q_u32(in + 8);
+        const uint32x4_t d = vld1q_u32(in + 12);
+
+        if (vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d))) >= 0x80) break;
+
+        const uint16x8_t low = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+        const uint16x8_t high = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+        vst1q_u8(_dst + i, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+#else
+    for (; i + 8 <= _size; i += 8)
+    {
+        char32_t any = 0;
+        for (size_t j = 0; j < 8; ++j) any |= _src[i + j];
+        if (any >= 0x80) break;
+
+        for (size_t j = 0; j < 8; ++j) _dst[i + j] = static_cast<unsigned char>(_src[i + j]);
+    }
+#endif
+
+    for (; i < _size && _src[i] < 0x80; ++i) _dst[i] = static_cast<unsigned char>(_src[i]);
+
+    return i;
+}
+
+/**
+ * @brief Decodes the multi-byte sequence at the start of _src, rejecting continuation or invalid
+ * lead bytes, truncation, overlong forms, surrogates and codepoints past U+10FFFF.
+ *
+ * @return The length of the sequence, 0 if it is malformed.
+ */
+[[nodiscard]] inline size_t decodeUtf8Sequence(const unsigned char* _src, size_t _size,
+                                               char32_t& _codepoint) noexcept
+{
+    const unsigned char lead = _src[0];
+
+    size_t length;
+    char32_t codepoint;
+
+    if (lead < 0xC2) return 0; // a continuation byte, or an overlong 2-byte form
+
+    if (lead < 0xE0)
+    {
+        length = 2;
+        codepoint = lead & 0x1F;
+    }
+    else if (lead < 0xF0)
+    {
+        length = 3;
+        codepoint = lead & 0x0F;
+    }
+    else if (lead < 0xF5)
+    {
+        length = 4;
+        codepoint = lead & 0x07;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (_size < length) return 0;
+
+    for (size_t i = 1; i < length; ++i)
+    {
+        if ((_src[i] & 0xC0) != 0x80) return 0;
+        codepoint = (codepoint << 6) | (_src[i] & 0x3F);
+    }
+
+    if (length == 3 && (codepoint < 0x800 || (codepoint >= 0xD800 && codepoint <= 0xDFFF)))
+    {
+        return 0;
+    }
+
+    if (length == 4 && (codepoint < 0x10000 || codepoint > 0x10FFFF)) return 0;
+
+    _codepoint = codepoint;
+    return length;
+}
+
+// 1 to 4 bytes, 0 for a surrogate or past U+10FFFF
+[[nodiscard]] constexpr size_t getUtf8Length(char32_t _codepoint) noexcept
+{
+    if (_codepoint < 0x80) return 1;
+    if (_codepoint < 0x800) return 2;
+    if (_codepoint >= 0xD800 && _codepoint <= 0xDFFF) return 0;
+    if (_codepoint < 0x10000) return 3;
+    if (_codepoint <= 0x10FFFF) return 4;
+
+    return 0;
+}
+
+/**
+ * @brief UTF-8 to UTF-32 into _dst, ASCII runs widened a vector register at a time. Stops at the
+ * first malformed sequence or once _capacity codepoints are written.
+ */
+[[nodiscard]] inline TranscodeResult decodeUtf8(const unsigned char* _src, size_t _size,
+                                                char32_t* _dst, size_t _capacity) noexcept
+{
+    size_t read = 0;
+    size_t written = 0;
+
+    while (read < _size)
+    {
+        if (_src[read] < 0x80)
+        {
+            const size_t room = std::min(_size - read, _capacity - written);
+            const size_t count = widenAscii(_src + read, room, _dst + written);
+
+            read += count;
+            written += count;
+
+            if (read == _size) break;
+            if (_src[read] < 0x80) return {read, written, TranscodeStatus::overflow};
+        }
+
+        if (written == _capacity) return {read, written, TranscodeStatus::overflow};
+
+        const size_t length = decodeUtf8Sequence(_src + read, _size - read, _dst[written]);
+        if (length == 0) return {read, written, TranscodeStatus::invalid};
+
+        read += length;
+        ++written;
+    }
+
+    return {read, written, TranscodeStatus::ok};
+}
+
+/**
+ * @brief UTF-32 to UTF-8 into _dst, ASCII runs narrowed a vector register at a time. Stops at the
+ * first surrogate or codepoint past U+10FFFF, or before the first that does not fit.
+ */
+[[nodiscard]] inline TranscodeResult encodeUtf8(const char32_t* _src, size_t _size,
+                                                unsigned char* _dst, size_t _capacity) noexcept
+{
+    size_t read = 0;
+    size_t written = 0;
+
+    while (read < _size)
+    {
+        if (_src[read] < 0x80)
+        {
+            const size_t room = std::min(_size - read, _capacity - written);
+            const size_t count = narrowAscii(_src + read, room, _dst + written);
+
+            read += count;
+            written += count;
+
+            if (read == _size) break;
+            if (_src[read] < 0x80) return {read, written, TranscodeStatus::overflow};
+        }
+
+        const char32_t codepoint = _src[read];
+        const size_t length = getUtf8Length(codepoint);
+
+        if (length == 0) return {read, written, TranscodeStatus::invalid};
+        if (_capacity - written < length) return {read, written, TranscodeStatus::overflow};
+
+        unsigned char* out = _dst + written;
+
+        switch (length)
+        {
+            case 2:
+                out[0] = static_cast<unsigned char>(0xC0 | (codepoint >> 6));
+                out[1] = static_cast<unsigned char>(0x80 | (codepoint & 0x3F));
+                break;
+            case 3:
+                out[0] = static_cast<unsigned char>(0xE0 | (codepoint >> 12));
+                out[1] = static_cast<unsigned char>(0x80 | ((codepoint >> 6) & 0x3F));
+                out[2] = static_cast<unsigned char>(0x80 | (codepoint & 0x3F));
+                break;
+            default:
+                out[0] = static_cast<unsigned char>(0xF0 | (codepoint >> 18));
+                out[1] = static_cast<unsigned char>(0x80 | ((codepoint >> 12) & 0x3F));
+                out[2] = static_cast<unsigned char>(0x80 | ((codepoint >> 6) & 0x3F));
+                out[3] = static_cast<unsigned char>(0x80 | (codepoint & 0x3F));
+                break;
+        }
+
+        read += 1;
+        written += length;
+    }
+
+    return {read, written, TranscodeStatus::ok};
+}
+
+[[nodiscard]] inline ErrorCode toErrorCode(TranscodeStatus _status) noexcept
+{
+    return _status == TranscodeStatus::invalid ? ErrorCode::parse_error
+                                               : ErrorCode::buffer_overflow;
+}
+
+// Iterators the chunks are copied to; pointers go through the bounded span overloads
+template <typename It, typename T>
+concept TranscodeOutput = std::output_iterator<It, T> && !std::is_pointer_v<It>;
+
+} // namespace detail
+
+/**
+ * @brief Checks that a string is well-formed UTF-8: no invalid or truncated sequence, overlong
+ * form, surrogate or codepoint past U+10FFFF. ASCII runs are checked a vector register at a time.
+ */
+[[nodiscard]] inline bool IsValidUtf8(std::string_view _utf8) noexcept
+{
+    const auto* data = reinterpret_cast<const unsigned char*>(_utf8.data());
+    const size_t size = _utf8.size();
+
+    size_t i = 0;
+
+    while (i < size)
+    {
+#if defined(SIMD_X86_SSE2) || defined(SIMD_X86_SSE4_1) || defined(SIMD_X86_AVX) || \
+    defined(SIMD_X86_AVX2) || defined(SIMD_X86_AVX512F)
+        for (; i + 16 <= size; i += 16)
+        {
+            const int mask =
+                _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+            if (mask != 0)
+            {
+                i += size_t(std::countr_zero(uint32_t(mask)));
+                break;
+            }
+        }
+#elif defined(SIMD_ARM_NEON)
+        for (; i + 16 <= size && vmaxvq_u8(vld1q_u8(data + i)) < 0x80; i += 16)
+        {
+        }
+#else
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            if ((word & detail::k_asciiHighBits) != 0) break;
+        }
+#endif
+
+        for (; i < size && data[i] < 0x80; ++i)
+        {
+        }
+
+        if (i == size) break;
+
+        char32_t codepoint;
+        const size_t length = detail::decodeUtf8Sequence(data + i, size - i, codepoint);
+        if (length == 0) return false;
+
+        i += length;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Converts UTF-8 to codepoints in a caller-provided buffer, allocating nothing: at most
+ * one codepoint per byte, `_utf8.size()` is always enough.
+ *
+ * @param _utf8 The UTF-8 encoded string to convert.
+ * @param _out Where the codepoints are written.
+ * @return The number of codepoints written, or ErrorCode::parse_error if the input is not valid
+ *         UTF-8 and ErrorCode::buffer_overflow if _out is too small (what came before is written).
+ */
+[[nodiscard]] inline Result<size_t, ErrorCode> Utf8ToCodepoints(std::string_view _utf8,
+                                                                std::span<char32_t> _out)
+{
+    const auto result = detail::decodeUtf8(reinterpret_cast<const unsigned char*>(_utf8.data()),
+                                           _utf8.size(), _out.data(), _out.size());
+
+    if (result.status != detail::TranscodeStatus::ok)
+    {
+        return Err<size_t, ErrorCode>(detail::toErrorCode(result.status));
+    }
+
+    return Ok<size_t, ErrorCode>(size_t(result.written));
+}
+
+/**
+ * @brief Converts UTF-8 to codepoints through an output iterator, a stack chunk at a time: with a
+ * `std::back_inserter` on a container cleared and reused, nothing is allocated once it has grown.
+ *
+ * @return The iterator past the last codepoint, or ErrorCode::parse_error if the input is not
+ *         valid UTF-8 (the codepoints before the malformed sequence are written).
+ */
+template <typename OutputIt>
+    requires detail::TranscodeOutput<OutputIt, char32_t>
+[[nodiscard]] Result<OutputIt, ErrorCode> Utf8ToCodepoints(std::string_view _utf8, OutputIt _out)
 {
-    std::vector<char32_t> codepoints;
-    auto it = utf8.begin();
-    const auto end = utf8.end();
+    std::array<char32_t, detail::k_transcodeChunkSize> chunk;
+
+    const auto* data = reinterpret_cast<const unsigned char*>(_utf8.data());
+    size_t read = 0;
 
-    while (it != end)
+    while (read < _utf8.size())
     {
-        try
+        const auto result =
+            detail::decodeUtf8(data + read, _utf8.size() - read, chunk.data(), chunk.size());
+
+        _out = std::copy_n(chunk.data(), result.written, std::move(_out));
+        read += result.read;
+
+        if (result.status == detail::TranscodeStatus::invalid)
         {
-            char32_t cp = utf8::next(it, end);
-            codepoints.push_back(cp);
+            return Err<OutputIt, ErrorCode>(ErrorCode::parse_error);
         }
-        catch (...)
+    }
+
+    return Ok<OutputIt, ErrorCode>(std::move(_out));
+}
+
+/**
+ * @brief Converts codepoints to UTF-8 in a caller-provided buffer, allocating nothing: at most
+ * 4 bytes per codepoint, `4 * _codepoints.size()` is always enough.
+ *
+ * @param _codepoints The Unicode codepoints to convert.
+ * @param _out Where the bytes are written.
+ * @return The number of bytes written, or ErrorCode::parse_error for a surrogate or a codepoint
+ *         past U+10FFFF and ErrorCode::buffer_overflow if _out is too small.
+ */
+[[nodiscard]] inline Result<size_t, ErrorCode> CodepointsToUtf8(
+    std::span<const char32_t> _codepoints, std::span<char> _out)
+{
+    const auto result =
+        detail::encodeUtf8(_codepoints.data(), _codepoints.size(),
+                           reinterpret_cast<unsigned char*>(_out.data()), _out.size());
+
+    if (result.status != detail::TranscodeStatus::ok)
+    {
+        return Err<size_t, ErrorCode>(detail::toErrorCode(result.status));
+    }
+
+    return Ok<size_t, ErrorCode>(size_t(result.written));
+}
+
+/**
+ * @brief Converts codepoints to UTF-8 through an output iterator, a stack chunk at a time.
+ *
+ * @return The iterator past the last byte, or ErrorCode::parse_error for a surrogate or a
+ *         codepoint past U+10FFFF (the bytes of the codepoints before it are written).
+ */
+template <typename OutputIt>
+    requires detail::TranscodeOutput<OutputIt, char>
+[[nodiscard]] Result<OutputIt, ErrorCode> CodepointsToUtf8(std::span<const char32_t> _codepoints,
+                                                           OutputIt _out)
+{
+    std::array<char, detail::k_transcodeChunkSize * 4> chunk;
+
+    size_t read = 0;
+
+    while (read < _codepoints.size())
+    {
+        const auto result = detail::encodeUtf8(_codepoints.data() + read,
+                                               _codepoints.size() - read,
+                                               reinterpret_cast<unsigned char*>(chunk.data()),
+                                               chunk.size());
+
+        _out = std::copy_n(chunk.data(), result.written, std::move(_out));
+        read += result.read;
+
+        if (result.status == detail::TranscodeStatus::invalid)
         {
-            // Skip or rethrow depending on desired behavior
-            // throw; // or just continue;
-            break;
+            return Err<OutputIt, ErrorCode>(ErrorCode::parse_error);
         }
     }
 
+    return Ok<OutputIt, ErrorCode>(std::move(_out));
+}
+
+/**
+ * @brief Converts a UTF-8 encoded string to a vector of Unicode codepoints (char32_t).
+ *
+ * @param utf8 The UTF-8 encoded string to convert.
+ * @return std::vector<char32_t> The extracted codepoints.
+ *         If the input is not valid UTF-8, the codepoints before the malformed sequence.
+ */
+[[nodiscard]] inline std::vector<char32_t> Utf8ToCodepoints(const std::string& utf8)
+{
+    std::vector<char32_t> codepoints(utf8.size());
+
+    const auto result = detail::decodeUtf8(reinterpret_cast<const unsigned char*>(utf8.data()),
+                                           utf8.size(), codepoints.data(), codepoints.size());
+
+    codepoints.resize(result.written);
     return codepoints;
 }
 
@@ -47,11 +532,16 @@ namespace utils
  *
  * @param codepoints The vector of Unicode codepoints to convert.
  * @return std::string The resulting UTF-8 encoded string.
+ *         Throws std::invalid_argument for a surrogate or a codepoint past U+10FFFF.
  */
 [[nodiscard]] inline std::string CodepointsToUtf8(const std::vector<char32_t>& codepoints)
 {
-    std::string utf8;
-    utf8::utf32to8(codepoints.begin(), codepoints.end(), std::back_inserter(utf8));
+    std::string utf8(codepoints.size() * 4, '\0');
+
+    auto result = CodepointsToUtf8(std::span<const char32_t>(codepoints), std::span<char>(utf8));
+    if (result.isErr()) throw std::invalid_argument("Invalid Unicode codepoint");
+
+    utf8.resize(result.unwrap());
     return utf8;
 }
 
@@ -60,11 +550,16 @@ namespace utils
  *
  * @param utf8 The UTF-8 encoded string to convert.
  * @return std::u32string UTF-32 representation.
+ *         Throws std::invalid_argument if the input is not valid UTF-8.
  */
 [[nodiscard]] inline std::u32string Utf8ToUtf32(const std::string& utf8)
 {
-    std::u32string result;
-    utf8::utf8to32(utf8.begin(), utf8.end(), std::back_inserter(result));
+    std::u32string result(utf8.size(), U'\0');
+
+    auto converted = Utf8ToCodepoints(std::string_view(utf8), std::span<char32_t>(result));
+    if (converted.isErr()) throw std::invalid_argument("Invalid UTF-8");
+
+    result.resize(converted.unwrap());
     return result;
 }
 
@@ -73,11 +568,16 @@ namespace utils
  *
  * @param utf32 The UTF-32 encoded string to convert.
  * @return std::string UTF-8 representation.
+ *         Throws std::invalid_argument for a surrogate or a codepoint past U+10FFFF.
  */
 [[nodiscard]] inline std::string Utf32ToUtf8(const std::u32string& utf32)
 {
-    std::string result;
-    utf8::utf32to8(utf32.begin(), utf32.end(), std::back_inserter(result));
+    std::string result(utf32.size() * 4, '\0');
+
+    auto converted = CodepointsToUtf8(std::span<const char32_t>(utf32), std::span<char>(result));
+    if (converted.isErr()) throw std::invalid_argument("Invalid Unicode codepoint");
+
+    result.resize(converted.unwrap());
     return result;
 }
 
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace pieces
+{
+
+namespace detail
+{
+
+inline constexpr uint64_t k_stringIdOffsetBasis = 0xCBF29CE484222325ull;
+
+// FNV-1a
+[[nodiscard]] constexpr uint64_t hashStringId(std::string_view _string) noexcept
+{
+    uint64_t hash = k_stringIdOffsetBasis;
+    for (const char c : _string)
+    {
+        hash = (hash ^ uint8_t(c)) * 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+} // namespace detail
+
+/**
+ * @brief A string identifier: the 64-bit FNV-1a hash of the string, compared and hashed as one
+ * integer. Literals hash at compile time ("moveLeft"_sid), a runtime string once.
+ *
+ * The id alone does not hold the string: StringId::intern() stores it in the global
+ * StringInterner, where str() finds it back (for the logs and the tools). Two strings sharing a
+ * hash would share an id, which intern() asserts against.
+ */
+class StringId
+{
+   private:
+    uint64_t m_hash = detail::k_stringIdOffsetBasis; // the empty string
+
+   public:
+    constexpr StringId() noexcept = default;
+    constexpr explicit StringId(std::string_view _string) noexcept
+        : m_hash(detail::hashStringId(_string))
+    {
+    }
+
+    /// The id of _string, stored in the global StringInterner for str().
+    [[nodiscard]] static StringId intern(std::string_view _string);
+
+    [[nodiscard]] static constexpr StringId fromHash(uint64_t _hash) noexcept
+    {
+        StringId id;
+        id.m_hash = _hash;
+        return id;
+    }
+
+   public:
+    [[nodiscard]] constexpr uint64_t getHash() const noexcept { return m_hash; }
+
+    /// The interned string of the id, empty if it never was (lock-free).
+    [[nodiscard]] std::string_view str() const noexcept;
+
+    friend constexpr bool operator==(StringId, StringId) noexcept = default;
+    friend constexpr std::strong_ordering operator<=>(StringId, StringId) noexcept = default;
+};
+
+inline namespace literals
+{
+
+[[nodiscard]] consteval StringId operator""_sid(const char* _string, size_t _size) noexcept
+{
+    return StringId(std::string_view(_string, _size));
+}
+
+} // namespace literals
+
+/**
+ * @brief The strings of the StringIds, stored once: an append-only arena of characters (each
+ * string null terminated) indexed by an open-addressing table of hashes.
+ *
+ * Lookups take no lock: they probe the current table, published with an atomic pointer, and the
+ * entries it points to never move. Inserts take a mutex; the table they outgrow is kept until
+ * the interner is destroyed, for the readers still probing it.
+ *
+ * @note The views returned live as long as the interner; those of the global one, get(), as long
+ * as the program.
+ */
+class StringInterner final
+{
+   private:
+    struct Entry
+    {
+        uint64_t hash;
+        std::string_view string;
+    };
+
+    struct Table
+    {
+        size_t mask;
+        std::unique_ptr<std::atomic<const Entry*>[]> slots;
+
+        explicit Table(size_t _capacity)
+            : mask(_capacity - 1), slots(std::make_unique<std::atomic<const Entry*>[]>(_capacity))
+        {
+        }
+    };
+
+    static constexpr size_t k_minCapacity = 256;
+    static constexpr size_t k_blockSize = 16 * 1024;
+
+    std::atomic<const Table*> m_table = nullptr;
+
+    mutable std::mutex m_mutex; // the writers
+    std::vector<std::unique_ptr<Table>> m_tables; // the retired ones, then the current one
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char* m_cursor = nullptr;
+    size_t m_blockLeft = 0;
+    std::deque<Entry> m_entries;
+
+   public:
+    StringInterner() = default;
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+    StringInterner(StringInterner&&) = delete;
+    StringInterner& operator=(StringInterner&&) = delete;
+
+    [[nodiscard]] static StringInterner& get() noexcept
+    {
+        static StringInterner s_instance;
+        return s_instance;
+    }
+
+   public:
+    StringId intern(std::string_view _string)
+    {
+        const StringId id(_string);
+
+        std::scoped_lock lock(m_mutex);
+
+        if (const std::optional<std::string_view> found = find(id))
+        {
+            assert(*found == _string && "StringInterner::intern: two strings share a hash");
+            return id;
+        }
+
+        if ((m_entries.size() + 1) * 2 > capacity()) grow();
+
+        const Entry& entry = m_entries.emplace_back(id.getHash(), store(_string));
+        insert(*m_tables.back(), entry);
+
+        return id;
+    }
+
+    /// The string of _id, if interned. Lock-free, from any thread.
+    [[nodiscard]] std::optional<std::string_view> find(StringId _id) const noexcept
+    {
+        const Table* table = m_table.load(std::memory_order_acquire);
+        if (table == nullptr) return std::nullopt;
+
+        const uint64_t hash = _id.getHash();
+        for (size_t i = size_t(hash) & table->mask;; i = (i + 1) & table->mask)
+        {
+            const Entry* entry = table->slots[i].load(std::memory_order_acquire);
+            if (entry == nullptr) return std::nullopt;
+            if (entry->hash == hash) return entry->string;
+        }
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_entries.size();
+    }
+
+   private:
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return m_tables.empty() ? 0 : m_tables.back()->mask + 1;
+    }
+
+    // A copy of _string in the arena, null terminated
+    [[nodiscard]] std::string_view store(std::string_view _string)
+    {
+        const size_t size = _string.size() + 1;
+
+        if (size > m_blockLeft)
+        {
+            const size_t blockSize = std::max(size, k_blockSize);
+            m_cursor = m_blocks.emplace_back(std::make_unique<char[]>(blockSize)).get();
+            m_blockLeft = blockSize;
+        }
+
+        char* string = m_cursor;
+        if (!_string.empty()) std::memcpy(string, _string.data(), _string.size());
+        string[_string.size()] = '\0';
+
+        m_cursor += size;
+        m_blockLeft -= size;
+
+        return {string, _string.size()};
+    }
+
+    static void insert(Table& _table, const Entry& _entry) noexcept
+    {
+        size_t i = size_t(_entry.hash) & _table.mask;
+        while (_table.slots[i].load(std::memory_order_relaxed) != nullptr)
+        {
+            i = (i + 1) & _table.mask;
+        }
+
+        _table.slots[i].store(&_entry, std::memory_order_release);
+    }
+
+    void grow()
+    {
+        auto table = std::make_unique<Table>(std::max(capacity() * 2, k_minCapacity));
+        for (const Entry& entry : m_entries) insert(*table, entry);
+
+        m_tables.push_back(std::move(table));
+        m_table.store(m_tables.back().get(), std::memory_order_release);
+    }
+};
+
+inline StringId StringId::intern(std::string_view _string)
+{
+    return StringInterner::get().intern(_string);
+}
+
+inline std::string_view StringId::str() const noexcept
+{
+    return StringInterner::get().find(*this).value_or(std::string_view());
+}
+
+} // namespace pieces
+
+template <>
+struct std::hash<pieces::StringId>
+{
+    size_t operator()(pieces::StringId _id) const noexcept { return size_t(_id.getHash()); }
+};
@@ -5,7 +5,18 @@
 #include <pieces/memory/proxy_allocator.hpp>
 #include <pieces/memory/contiguous_allocator.hpp>
 #include <pieces/memory/pool_allocator.hpp>
+#include <pieces/memory/concurrent_pool_allocator.hpp>
+#include <pieces/memory/frame_arena.hpp>
 #include <pieces/memory/freelist_allocator.hpp>
+#include <pieces/memory/allocation_stats.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <latch>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 using namespace pieces;
 
@@ -197,6 +208,25 @@ TEST_F(AutomaticIdxPoolAllocatorTest, AllocateCountFailsIfNotEnoughContiguousSlo
     EXPECT_EQ(poolAlloc.allocate(4), nullptr);
 }
 
+TEST_F(AutomaticIdxPoolAllocatorTest, FreedSlotsAreFoundAgainInAFullPool)
+{
+    std::vector<int*> slots;
+    while (int* slot = poolAlloc.allocate(1)) slots.push_back(slot);
+    ASSERT_EQ(slots.size(), kCapacity);
+
+    poolAlloc.deallocate(slots[100], 1);
+    EXPECT_EQ(poolAlloc.allocate(1), slots[100]);
+
+    // a run straddling the two words of the states
+    poolAlloc.deallocate(slots[62], 4);
+    EXPECT_EQ(poolAlloc.allocate(5), nullptr);
+    EXPECT_EQ(poolAlloc.allocate(4), slots[62]);
+    EXPECT_EQ(poolAlloc.available(), 0u);
+
+    poolAlloc.reset();
+    EXPECT_EQ(poolAlloc.allocate(kCapacity), slots[0]);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Test Fixture for ManualIndexingPoolAllocator
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -257,6 +287,184 @@ TEST_F(ManualIdxPoolAllocatorTest, DeallocateAndAllocateAtIndexCorrectlySetBitma
     EXPECT_EQ(poolAlloc.used(), 0);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ConcurrentPoolAllocator
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ConcurrentPoolAllocatorTest, HandsOutEverySlotOnceThenNullptr)
+{
+    ConcurrentPoolAllocator<uint64_t> pool{100};
+
+    std::set<uint64_t*> slots;
+    for (size_t i = 0; i < 100; ++i) slots.insert(pool.allocate());
+
+    EXPECT_EQ(slots.size(), 100u);
+    EXPECT_FALSE(slots.contains(nullptr));
+    EXPECT_EQ(pool.allocate(), nullptr);
+    EXPECT_EQ(pool.available(), 0u);
+
+    for (uint64_t* slot : slots) pool.deallocate(slot);
+    EXPECT_EQ(pool.used(), 0u);
+
+    // more than one at a time is not supported
+    EXPECT_EQ(pool.allocate(2), nullptr);
+    EXPECT_NE(pool.allocate(), nullptr);
+}
+
+TEST(ConcurrentPoolAllocatorTest, CrossThreadFreesGoBackToTheAllocatingThread)
+{
+    using Pool = ConcurrentPoolAllocator<uint64_t>;
+    Pool pool{4 * Pool::k_batchSize};
+
+    uint64_t* first = pool.allocate();
+
+    std::thread([&] { pool.deallocate(first); }).join();
+
+    // the rest of the batch of the magazine, then the remote free
+    std::vector<uint64_t*> rest;
+    for (uint32_t i = 1; i < Pool::k_batchSize; ++i) rest.push_back(pool.allocate());
+
+    EXPECT_EQ(std::ranges::find(rest, first), rest.end());
+    EXPECT_EQ(pool.allocate(), first);
+}
+
+TEST(ConcurrentPoolAllocatorTest, ThreadsFreeingEachOthersSlotsNeverShareOne)
+{
+    constexpr int k_threads = 4;
+    constexpr uint64_t k_rounds = 20000;
+
+    ConcurrentPoolAllocator<uint64_t> pool{256};
+    AllocationStats stats;
+    pool.setStats(&stats);
+
+    // a free slot holds 0, an allocated one the tag of its allocation
+    std::vector<uint64_t*> all;
+    while (uint64_t* slot = pool.allocate()) all.push_back(slot);
+    for (uint64_t* slot : all) *slot = 0;
+    for (uint64_t* slot : all) pool.deallocate(slot);
+
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t*, uint64_t>> handed; // freed by the next thread taking them
+
+    std::atomic<bool> shared = false;
+    std::latch start(k_threads);
+    std::vector<std::thread> threads;
+
+    const auto release = [&](uint64_t* _slot, uint64_t _tag)
+    {
+        if (*_slot != _tag) shared = true;
+        *_slot = 0;
+        pool.deallocate(_slot);
+    };
+
+    for (uint64_t t = 1; t <= k_threads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                start.arrive_and_wait();
+
+                for (uint64_t i = 0; i < k_rounds; ++i)
+                {
+                    const uint64_t tag = t << 32 | i;
+
+                    if (uint64_t* slot = pool.allocate())
+                    {
+                        if (*slot != 0) shared = true;
+                        *slot = tag;
+
+                        std::lock_guard lock(mutex);
+                        handed.emplace_back(slot, tag);
+                    }
+
+                    std::pair<uint64_t*, uint64_t> taken{nullptr, 0};
+
+                    {
+                        std::lock_guard lock(mutex);
+                        if (handed.size() > 64 || i % 2 == 0)
+                        {
+                            if (!handed.empty())
+                            {
+                                std::swap(handed[i % handed.size()], handed.back());
+                                taken = handed.back();
+                                handed.pop_back();
+                            }
+                        }
+                    }
+
+                    if (taken.first) release(taken.first, taken.second);
+                }
+            });
+    }
+
+    for (auto& thread : threads) thread.join();
+    for (auto [slot, tag] : handed) release(slot, tag);
+
+    EXPECT_FALSE(shared);
+    EXPECT_EQ(pool.used(), 0u);
+    EXPECT_EQ(stats.allocatedBytes(), 0u);
+
+    // nothing lost in the magazines of the threads that exited
+    all.clear();
+    while (uint64_t* slot = pool.allocate()) all.push_back(slot);
+    EXPECT_EQ(all.size(), 256u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameArena
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FrameArenaTest, AllocationsSurviveOneFlipAndScopesRewind)
+{
+    FrameArena arena{1024};
+
+    uint64_t* value = arena.make<uint64_t>(42u);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(arena.allocate(1, 64)) % 64, 0u);
+
+    const size_t used = arena.used();
+    {
+        auto scope = arena.scope();
+        std::span<float> floats = arena.makeArray<float>(16);
+        ASSERT_EQ(floats.size(), 16u);
+        EXPECT_EQ(floats[15], 0.0f);
+    }
+    EXPECT_EQ(arena.used(), used);
+
+    // the previous frame is left alone, the one before is released
+    arena.flip();
+    EXPECT_EQ(*value, 42u);
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_TRUE(arena.owns(value));
+
+    EXPECT_EQ(arena.makeArray<uint8_t>(2048).size(), 0u);
+}
+
+TEST(FrameArenaTest, PmrContainersFallBackUpstreamOnceFull)
+{
+    FrameArena arena{256};
+
+    std::pmr::vector<uint32_t> values(arena.getResource());
+    for (uint32_t i = 0; i < 1000; ++i) values.push_back(i);
+
+    EXPECT_EQ(values[999], 999u);
+    EXPECT_FALSE(arena.owns(values.data()));
+}
+
+TEST(FrameArenaTest, TheArenaOfAThreadFlipsOncePerFrame)
+{
+    FrameArena& arena = FrameArena::local();
+    EXPECT_EQ(&arena, &FrameArena::local());
+
+    void* kept = arena.allocate(8);
+    FrameArena::beginFrame();
+
+    EXPECT_EQ(FrameArena::local().used(), 0u);
+    EXPECT_NE(FrameArena::local().allocate(8), kept);
+
+    std::thread([&] { EXPECT_NE(&FrameArena::local(), &arena); }).join();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Test Fixture for FreeListAllocator (First-Fit with Deferred Coalescing)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -543,6 +751,69 @@ TEST_F(WorstFitAllocatorTest, AllocatesLargestBlock)
     worstFitAlloc.deallocate(ptr3, 128);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test Fixture for TlsfAllocator
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TlsfAllocatorTest : public ::testing::Test
+{
+   protected:
+    static constexpr size_t kCapacity = 128 * 1024;
+    TlsfAllocator tlsfAlloc{kCapacity};
+};
+
+TEST_F(TlsfAllocatorTest, FreeMergesWithBothNeighboursAtOnce)
+{
+    void* ptr1 = tlsfAlloc.allocate(100);
+    void* ptr2 = tlsfAlloc.allocate(3000);
+    void* ptr3 = tlsfAlloc.allocate(700);
+    void* guard = tlsfAlloc.allocate(16);
+
+    tlsfAlloc.deallocate(ptr1, 100);
+    tlsfAlloc.deallocate(ptr3, 700);
+    EXPECT_EQ(tlsfAlloc.getFreeBlockCount(), 3);
+
+    // ptr1, ptr2 and ptr3 become one block
+    tlsfAlloc.deallocate(ptr2, 3000);
+    EXPECT_EQ(tlsfAlloc.getFreeBlockCount(), 2);
+    EXPECT_EQ(tlsfAlloc.allocate(3800), ptr1);
+
+    tlsfAlloc.deallocate(guard, 16);
+}
+
+TEST_F(TlsfAllocatorTest, MixedSizesFreedInAnyOrderLeaveOneBlock)
+{
+    std::vector<std::pair<void*, size_t>> blocks;
+
+    for (size_t i = 0; i < 200; ++i)
+    {
+        const size_t size = 16 + (i * 7919) % 600;
+        void* ptr = tlsfAlloc.allocate(size);
+        ASSERT_NE(ptr, nullptr);
+        blocks.emplace_back(ptr, size);
+    }
+
+    const float packedRatio = tlsfAlloc.getFragmentationRatio();
+
+    // every other block first, the holes cannot merge yet
+    for (size_t i = 0; i < blocks.size(); i += 2)
+    {
+        tlsfAlloc.deallocate(blocks[i].first, blocks[i].second);
+    }
+    EXPECT_EQ(tlsfAlloc.getFreeBlockCount(), 101);
+    EXPECT_GT(tlsfAlloc.getFragmentationRatio(), packedRatio);
+
+    for (size_t i = 1; i < blocks.size(); i += 2)
+    {
+        tlsfAlloc.deallocate(blocks[i].first, blocks[i].second);
+    }
+
+    EXPECT_EQ(tlsfAlloc.used(), 0);
+    EXPECT_EQ(tlsfAlloc.getFreeBlockCount(), 1);
+    EXPECT_EQ(tlsfAlloc.getLargestFreeBlock(), tlsfAlloc.capacity());
+    EXPECT_FLOAT_EQ(tlsfAlloc.getFragmentationRatio(), 0.0f);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // General FreeListAllocator Tests
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -589,3 +860,134 @@ TEST(FreeListAllocatorGeneralTest, EqualityOperators)
     FirstFitAllocator<> alloc3{std::move(alloc1)};
     EXPECT_EQ(alloc3, alloc3);
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AllocationStats Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(AllocationStatsTest, AllocatorsOfASubsystemShareTheCounters)
+{
+    AllocationStats stats;
+
+    {
+        AutomaticIndexingPoolAllocator<int> pool{16};
+        LinearAllocator<int> linear{32};
+
+        int* kept = pool.allocate(1);
+        pool.setStats(&stats);
+        linear.setStats(&stats);
+
+        // the buffers, and the allocation made before
+        EXPECT_EQ(stats.reservedBytes(), (16 + 32) * sizeof(int));
+        EXPECT_EQ(stats.allocatedBytes(), sizeof(int));
+
+        int* ptr = pool.allocate(1);
+        ASSERT_NE(linear.allocate(8), nullptr);
+        EXPECT_EQ(stats.allocatedBytes(), 10 * sizeof(int));
+
+        pool.deallocate(ptr, 1);
+        pool.deallocate(kept, 1);
+        linear.reset();
+
+        EXPECT_EQ(stats.allocatedBytes(), 0u);
+        EXPECT_EQ(stats.peakBytes(), 10 * sizeof(int));
+        EXPECT_FLOAT_EQ(stats.fragmentation(), 1.0f);
+
+        // moved with the allocator
+        LinearAllocator<int> moved{std::move(linear)};
+        EXPECT_EQ(stats.reservedBytes(), (16 + 32) * sizeof(int));
+    }
+
+    EXPECT_EQ(stats.reservedBytes(), 0u);
+    EXPECT_EQ(stats.allocatedBytes(), 0u);
+}
+
+TEST(AllocationStatsTest, FreeListAllocationsAreCountedAligned)
+{
+    AllocationStats stats;
+    FirstFitAllocator<> alloc{4096};
+    alloc.setStats(&stats);
+
+    void* ptr1 = alloc.allocate(100);
+    void* ptr2 = alloc.allocate(200);
+
+    EXPECT_EQ(stats.reservedBytes(), 4096u);
+    EXPECT_EQ(stats.allocatedBytes(), alloc.used());
+    EXPECT_EQ(stats.allocations(), 2u);
+
+    alloc.deallocate(ptr1, 100);
+    EXPECT_EQ(stats.allocatedBytes(), alloc.used());
+
+    alloc.deallocate(ptr2, 200);
+    EXPECT_EQ(stats.allocatedBytes(), 0u);
+
+    stats.resetPeak();
+    EXPECT_EQ(stats.peakBytes(), 0u);
+
+    alloc.setStats(nullptr);
+    EXPECT_EQ(stats.reservedBytes(), 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ProxyAllocator Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ProxyAllocatorTest, RecordsSizesAndLifetimesOfItsAllocations)
+{
+    AllocationStats stats;
+    AutomaticIndexingPoolAllocator<uint64_t> pool{64};
+
+    // Made before the stats were attached: never deallocated from them
+    uint64_t* untracked = pool.allocate(1);
+
+    {
+        ProxyAllocator<uint64_t, AutomaticIndexingPoolAllocator<uint64_t>> proxy{&pool, &stats};
+
+        uint64_t* one = proxy.allocate(1);
+        uint64_t* eight = proxy.allocate(8);
+        proxy.construct(one, uint64_t(42));
+        EXPECT_EQ(*one, 42u);
+
+        EXPECT_EQ(stats.allocations(), 2u);
+        EXPECT_EQ(stats.allocatedBytes(), 9 * sizeof(uint64_t));
+        EXPECT_EQ(stats.sizeClassCount(AllocationStats::sizeClassOf(8)), 1u);
+        EXPECT_EQ(stats.sizeClassCount(AllocationStats::sizeClassOf(64)), 1u);
+        EXPECT_TRUE(stats.hasHistograms());
+
+        proxy.deallocate(one, 1);
+        proxy.deallocate(untracked, 1);
+        EXPECT_EQ(stats.allocatedBytes(), 8 * sizeof(uint64_t));
+
+        uint64_t lifetimes = 0;
+        for (size_t i = 0; i < AllocationStats::k_lifetimeClasses; ++i)
+        {
+            lifetimes += stats.lifetimeClassCount(i);
+        }
+        EXPECT_EQ(lifetimes, 1u);
+
+        // The live allocation leaves the stats with the proxy
+        (void)eight;
+    }
+
+    EXPECT_EQ(stats.allocatedBytes(), 0u);
+    EXPECT_EQ(stats.peakBytes(), 9 * sizeof(uint64_t));
+}
+
+TEST(ProxyAllocatorTest, SizeAndLifetimeClassesArePowers)
+{
+    static_assert(AllocationStats::sizeClassOf(1) == 0);
+    static_assert(AllocationStats::sizeClassOf(16) == 0);
+    static_assert(AllocationStats::sizeClassOf(17) == 1);
+    static_assert(AllocationStats::sizeClassOf(32) == 1);
+    static_assert(AllocationStats::sizeClassOf(size_t(1) << 40) ==
+                  AllocationStats::k_sizeClasses - 1);
+    static_assert(AllocationStats::sizeClassLimit(1) == 32);
+
+    static_assert(AllocationStats::lifetimeClassOf(999) == 0);
+    static_assert(AllocationStats::lifetimeClassOf(1000) == 1);
+    static_assert(AllocationStats::lifetimeClassOf(16'000'000) == 5); // a frame, under 100 ms
+    static_assert(AllocationStats::lifetimeClassOf(UINT64_MAX) ==
+                  AllocationStats::k_lifetimeClasses - 1);
+
+    SUCCEED();
+}
@@ -159,6 +159,59 @@ TEST(BitSetTest, CopyAndMoveSemantics)
     EXPECT_EQ(b.size(), 0);
 }
 
+TEST(BitSetTest, RangesAndClearRunsAcrossWords)
+{
+    BitSet bs(200);
+    bs.setRange(3, 130);
+    EXPECT_EQ(bs.count(), 130);
+    EXPECT_EQ(bs.countRange(0, 10), 7);
+    EXPECT_TRUE(bs.isWordFull(1));
+    EXPECT_FALSE(bs.isWordFull(0));
+
+    EXPECT_EQ(bs.findClearRun(3), 0);
+    EXPECT_EQ(bs.findClearRun(4), 133);
+    // 133..199: the run goes into the padded last word but no further
+    EXPECT_EQ(bs.findClearRun(67), 133);
+    EXPECT_EQ(bs.findClearRun(68), bs.size());
+
+    bs.clearRange(60, 10);
+    EXPECT_EQ(bs.findClearRun(10, 4), 60);
+    EXPECT_EQ(bs.findClearRun(5, 62), 62);
+    EXPECT_EQ(bs.countRange(0, 200), 120);
+}
+
+TEST(BitSetTest, BulkOperationsMatchTheWordsOneByOne)
+{
+    // sizes ending inside and past the vector registers
+    for (size_t size : {64u, 130u, 300u, 577u})
+    {
+        BitSet a(size), b(size), empty(size);
+        for (size_t i = 0; i < size; i += 3) a.setBit(i);
+        for (size_t i = 0; i < size; i += 6) b.setBit(i);
+
+        EXPECT_TRUE(a.containsAll(b));
+        EXPECT_TRUE(b.isSubsetOf(a));
+        EXPECT_FALSE(a.isSubsetOf(b));
+        EXPECT_TRUE(a.intersects(b));
+        EXPECT_FALSE(a.intersects(empty));
+
+        // a bit only in the last word
+        b.setBit(size - 1);
+        EXPECT_EQ(b.isSubsetOf(a), (size - 1) % 3 == 0);
+
+        BitSet both = a;
+        both.andWith(b);
+        EXPECT_EQ(both, a & b);
+        EXPECT_EQ(both.count(), (a & b).count());
+
+        BitSet either = a;
+        either.orWith(b);
+        EXPECT_EQ(either, a | b);
+        EXPECT_NE(either, a ^ b);
+        EXPECT_TRUE((a ^ a).none());
+    }
+}
+
 TEST(BitSetTest, ExceptionOnSizeMismatch)
 {
     BitSet a(8), b(9);
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <pieces/containers/concurrent_ring_buffer.hpp>
+
+using namespace pieces;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SPSC Ring Buffer Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(SPSCRingBufferTest, PushesUntilFullAndPopsInOrder)
+{
+    SPSCRingBuffer<int> buffer(3);
+    EXPECT_EQ(buffer.capacity(), 4);
+    EXPECT_TRUE(buffer.tryPop().isErr());
+
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(buffer.tryPush(i));
+    EXPECT_FALSE(buffer.tryPush(4));
+    EXPECT_EQ(buffer.size(), 4);
+
+    EXPECT_EQ(buffer.tryPop().unwrap(), 0);
+    EXPECT_TRUE(buffer.tryPush(4));
+
+    for (int i = 1; i < 5; ++i) EXPECT_EQ(buffer.tryPop().unwrap(), i);
+    EXPECT_TRUE(buffer.empty());
+
+    EXPECT_THROW(SPSCRingBuffer<int>(0), std::invalid_argument);
+}
+
+TEST(SPSCRingBufferTest, BatchesStopAtTheCapacityAndWrapAround)
+{
+    SPSCRingBuffer<std::unique_ptr<int>> buffer(8);
+
+    std::vector<std::unique_ptr<int>> in;
+    for (int i = 0; i < 6; ++i) in.push_back(std::make_unique<int>(i));
+
+    EXPECT_EQ(buffer.tryPushBatch(std::make_move_iterator(in.begin()),
+                                  std::make_move_iterator(in.end())),
+              6);
+
+    std::array<std::unique_ptr<int>, 4> out;
+    EXPECT_EQ(buffer.tryPopBatch(out), 4);
+    EXPECT_EQ(*out[3], 3);
+
+    // 2 left, 6 free across the end of the slots
+    for (int i = 0; i < 8; ++i) in[i % 6] = std::make_unique<int>(10 + i);
+    EXPECT_EQ(buffer.tryPushBatch(std::make_move_iterator(in.begin()),
+                                  std::make_move_iterator(in.end())),
+              6);
+
+    std::vector<int> seen;
+    buffer.consume([&](size_t, std::unique_ptr<int>& _value) { seen.push_back(*_value); });
+    EXPECT_EQ(seen, (std::vector<int>{4, 5, 16, 17, 12, 13, 14, 15}));
+}
+
+TEST(SPSCRingBufferTest, TransfersEverythingInOrderBetweenThreads)
+{
+    constexpr int k_count = 100000;
+    SPSCRingBuffer<int> buffer(256);
+
+    std::thread producer(
+        [&]()
+        {
+            std::array<int, 16> batch;
+            for (int i = 0; i < k_count;)
+            {
+                const int n = std::min<int>(batch.size(), k_count - i);
+                std::iota(batch.begin(), batch.begin() + n, i);
+                const size_t pushed = buffer.tryPushBatch(batch.begin(), batch.begin() + n);
+                if (pushed == 0) std::this_thread::yield();
+                i += int(pushed);
+            }
+        });
+
+    int expected = 0;
+    bool ordered = true;
+    while (expected < k_count)
+    {
+        if (buffer.consume([&](size_t, int _value) { ordered &= _value == expected++; }, 32) == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(buffer.empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// MPSC Ring Buffer Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(MPSCRingBufferTest, PushesUntilFullAndDestroysWhatIsLeft)
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        MPSCRingBuffer<std::shared_ptr<int>> buffer(4);
+
+        for (int i = 0; i < 4; ++i) EXPECT_TRUE(buffer.tryPush(counter));
+        EXPECT_FALSE(buffer.tryPush(counter));
+
+        std::array<std::shared_ptr<int>, 2> out;
+        std::array<std::shared_ptr<int>, 3> in = {counter, counter, counter};
+        EXPECT_EQ(buffer.tryPopBatch(out), 2);
+        EXPECT_EQ(buffer.tryPushBatch(in.begin(), in.end()), 2);
+
+        // out, in and the 4 in the buffer
+        EXPECT_EQ(counter.use_count(), 1 + 2 + 3 + 4);
+    }
+
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(MPSCRingBufferTest, KeepsTheOrderOfEachProducer)
+{
+    constexpr int k_producers = 4;
+    constexpr int k_perProducer = 20000;
+    MPSCRingBuffer<std::pair<int, int>> buffer(128);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < k_producers; ++p)
+    {
+        producers.emplace_back(
+            [&buffer, p]()
+            {
+                for (int i = 0; i < k_perProducer;)
+                {
+                    // alternate single pushes and batches of 3
+                    if (i % 2 == 0)
+                    {
+                        if (buffer.tryPush({p, i})) ++i;
+                        else std::this_thread::yield();
+                        continue;
+                    }
+
+                    std::array<std::pair<int, int>, 3> batch = {
+                        std::pair{p, i}, std::pair{p, i + 1}, std::pair{p, i + 2}};
+                    const int n = std::min(3, k_perProducer - i);
+                    const size_t pushed = buffer.tryPushBatch(batch.begin(), batch.begin() + n);
+                    if (pushed == 0) std::this_thread::yield();
+                    i += int(pushed);
+                }
+            });
+    }
+
+    std::array<int, k_producers> next = {};
+    bool ordered = true;
+    for (int received = 0; received < k_producers * k_perProducer;)
+    {
+        const size_t count = buffer.consume(
+            [&](size_t, const std::pair<int, int>& _value)
+            { ordered &= _value.second == next[_value.first]++; });
+        if (count == 0) std::this_thread::yield();
+        received += int(count);
+    }
+
+    for (auto& producer : producers) producer.join();
+
+    EXPECT_TRUE(ordered);
+    for (int count : next) EXPECT_EQ(count, k_perProducer);
+    EXPECT_TRUE(buffer.tryPop().isErr());
+}
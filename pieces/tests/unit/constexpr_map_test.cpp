@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string_view>
+#include <utility>
+
+#include <pieces/containers/constexpr_map.hpp>
+
+using namespace pieces;
+
+namespace
+{
+
+enum class Key : uint32_t
+{
+    a = 65,
+    b = 66,
+    escape = 256,
+    f12 = 301,
+};
+
+constexpr ConstexprMap<Key, int, 4> c_keys({{
+    {Key::a, 1},
+    {Key::b, 2},
+    {Key::escape, 3},
+    {Key::f12, 4},
+}});
+
+static_assert(*c_keys.find(Key::escape) == 3);
+static_assert(!c_keys.contains(Key(67)));
+
+constexpr auto makeSparseKeys()
+{
+    // spread like the platform key codes, with large gaps
+    std::array<std::pair<uint32_t, uint32_t>, 349> pairs{};
+    for (uint32_t i = 0; i < pairs.size(); ++i) pairs[i] = {i * i * 7 + 32, i};
+
+    return ConstexprMap<uint32_t, uint32_t, 349>(pairs);
+}
+
+constexpr auto c_sparseKeys = makeSparseKeys();
+
+struct Point
+{
+    int x = 0;
+    int y = 0;
+
+    constexpr bool operator==(const Point&) const = default;
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ConstexprMap Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(ConstexprMapTest, FindsEveryKeyAndRejectsTheOthers)
+{
+    for (uint32_t i = 0; i < c_sparseKeys.size(); ++i)
+    {
+        ASSERT_EQ(c_sparseKeys.at(i * i * 7 + 32).unwrap(), i);
+        ASSERT_FALSE(c_sparseKeys.contains(i * i * 7 + 33));
+    }
+
+    EXPECT_EQ(c_keys.at(Key(0)).error(), ErrorCode::key_not_found);
+    EXPECT_EQ(c_keys.find(Key(0)), nullptr);
+}
+
+TEST(ConstexprMapTest, HashesStringKeys)
+{
+    constexpr ConstexprMap<std::string_view, int, 3> map({{
+        {"left", 0},
+        {"right", 1},
+        {"middle", 2},
+    }});
+
+    static_assert(*map.find("middle") == 2);
+    EXPECT_EQ(map.at(std::string_view("right")).unwrap(), 1);
+    EXPECT_FALSE(map.contains("up"));
+}
+
+TEST(ConstexprMapTest, SearchesUnhashableKeysLinearly)
+{
+    constexpr ConstexprMap<Point, int, 2> map({{{{0, 1}, 10}, {{1, 0}, 20}}});
+
+    static_assert(*map.find({1, 0}) == 20);
+    EXPECT_FALSE(map.contains({1, 1}));
+}
+
+TEST(ConstexprMapTest, RejectsDuplicateKeys)
+{
+    using Map = ConstexprMap<int, int, 3>;
+    EXPECT_THROW(Map({{{1, 1}, {2, 2}, {1, 3}}}), std::invalid_argument);
+
+    using PointMap = ConstexprMap<Point, int, 2>;
+    EXPECT_THROW(PointMap({{{{0, 1}, 10}, {{0, 1}, 20}}}), std::invalid_argument);
+
+    const ConstexprMap<int, int, 0> empty({});
+    EXPECT_FALSE(empty.contains(0));
+}
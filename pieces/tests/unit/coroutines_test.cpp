@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 #include <variant>
 #include <functional>
+#include <memory_resource>
+#include <ranges>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <pieces/utils/coroutines.hpp>
 
@@ -172,3 +176,194 @@ TEST(TaskTest, ExceptionPropagates)
 
     EXPECT_THROW(runner.run(throwError()), std::runtime_error);
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Generator Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+Generator<int> countTo(int _count, int* _produced)
+{
+    for (int i = 1; i <= _count; ++i)
+    {
+        ++*_produced;
+        co_yield i;
+    }
+}
+
+struct Node
+{
+    int value;
+    std::vector<Node> children;
+};
+
+// Depth first, the nested generators resumed directly
+Generator<int> flatten(const Node& _node)
+{
+    co_yield _node.value;
+    for (const Node& child : _node.children) co_yield elementsOf(flatten(child));
+}
+
+Generator<std::string> throwAfter(int _count)
+{
+    for (int i = 0; i < _count; ++i) co_yield std::to_string(i);
+    throw std::runtime_error("corrupted");
+}
+
+Generator<std::string> wrap(int _count)
+{
+    co_yield "begin";
+    co_yield elementsOf(throwAfter(_count));
+    co_yield "unreachable";
+}
+
+// Counts the bytes handed out and given back
+struct CountingAllocator
+{
+    size_t allocated = 0;
+    size_t deallocated = 0;
+
+    void* allocate(size_t _bytes)
+    {
+        allocated += _bytes;
+        return ::operator new(_bytes);
+    }
+
+    void deallocate(void* _ptr, size_t _bytes) noexcept
+    {
+        deallocated += _bytes;
+        ::operator delete(_ptr);
+    }
+};
+
+Generator<int> fromAllocator(std::allocator_arg_t, CountingAllocator&, int _count)
+{
+    for (int i = 0; i < _count; ++i) co_yield i;
+}
+
+Task<int> squareOf(int _value) { co_return _value * _value; }
+
+AsyncGenerator<int> squares(int _count)
+{
+    for (int i = 1; i <= _count; ++i)
+    {
+        Task<int> square = squareOf(i);
+        co_yield co_await square;
+    }
+}
+
+AsyncGenerator<std::string> failingStream(std::allocator_arg_t,
+                                          std::pmr::memory_resource& /*_resource*/)
+{
+    co_yield std::string("first");
+    throw std::runtime_error("disconnected");
+}
+
+Task<int> sumOf(AsyncGenerator<int> _stream)
+{
+    int sum = 0;
+    while (std::optional<int> value = co_await _stream.next()) sum += *value;
+    co_return sum;
+}
+
+Task<int> countUntilFailure(AsyncGenerator<std::string>& _stream)
+{
+    int count = 0;
+    try
+    {
+        while (co_await _stream.next()) ++count;
+    }
+    catch (const std::runtime_error&)
+    {
+        co_return -count;
+    }
+
+    co_return count;
+}
+
+} // namespace
+
+TEST(GeneratorTest, RunsUpToEachValueOnDemand)
+{
+    int produced = 0;
+    Generator<int> numbers = countTo(5, &produced);
+    EXPECT_EQ(produced, 0);
+
+    auto it = numbers.begin();
+    EXPECT_EQ(*it, 1);
+    EXPECT_EQ(produced, 1);
+
+    ++it;
+    EXPECT_EQ(*it, 2);
+    EXPECT_EQ(produced, 2);
+
+    static_assert(std::ranges::input_range<Generator<int>>);
+
+    int sum = 0;
+    for (int value : countTo(4, &produced) | std::views::filter([](int v) { return v % 2 == 0; }))
+    {
+        sum += value;
+    }
+    EXPECT_EQ(sum, 6);
+}
+
+TEST(GeneratorTest, NestedGeneratorsYieldDepthFirst)
+{
+    const Node tree{1, {{2, {{3, {}}, {4, {}}}}, {5, {}}, {6, {{7, {{8, {}}}}}}}};
+
+    std::vector<int> values;
+    for (int value : flatten(tree)) values.push_back(value);
+
+    EXPECT_EQ(values, (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8}));
+}
+
+TEST(GeneratorTest, ExceptionsOfNestedGeneratorsLeaveThroughTheLoop)
+{
+    std::vector<std::string> values;
+    auto consume = [&]
+    {
+        for (std::string& value : wrap(2)) values.push_back(std::move(value));
+    };
+
+    EXPECT_THROW(consume(), std::runtime_error);
+    EXPECT_EQ(values, (std::vector<std::string>{"begin", "0", "1"}));
+}
+
+TEST(GeneratorTest, FramesComeFromTheAllocatorAfterAllocatorArg)
+{
+    CountingAllocator allocator;
+
+    {
+        int sum = 0;
+        for (int value : fromAllocator(std::allocator_arg, allocator, 4)) sum += value;
+        EXPECT_EQ(sum, 6);
+        EXPECT_GT(allocator.allocated, 0u);
+    }
+
+    EXPECT_EQ(allocator.deallocated, allocator.allocated);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncGenerator Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(AsyncGeneratorTest, StreamsValuesToAnAwaitingTask)
+{
+    EXPECT_EQ(ManualRunner::run(sumOf(squares(4))), 1 + 4 + 9 + 16);
+    EXPECT_EQ(ManualRunner::run(sumOf(squares(0))), 0);
+}
+
+TEST(AsyncGeneratorTest, NextRethrowsTheExceptionOfTheProducer)
+{
+    std::byte buffer[1024];
+    std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                 std::pmr::null_memory_resource());
+
+    AsyncGenerator<std::string> stream = failingStream(std::allocator_arg, resource);
+    EXPECT_FALSE(stream.isDone());
+
+    EXPECT_EQ(ManualRunner::run(countUntilFailure(stream)), -1);
+    EXPECT_TRUE(stream.isDone());
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <pieces/containers/flat_hash_map.hpp>
+
+using namespace pieces;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FlatHashMap Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FlatHashMapTest, InsertFindAndErase)
+{
+    FlatHashMap<int, std::string> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.find(1), map.end());
+
+    EXPECT_TRUE(map.try_emplace(1, "one").second);
+    EXPECT_FALSE(map.try_emplace(1, "uno").second);
+    map[2] = "two";
+    map.insert_or_assign(1, "uno");
+
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(map.at(1), "uno");
+    EXPECT_EQ(map.find(2)->second, "two");
+    EXPECT_THROW((void)map.at(3), std::out_of_range);
+
+    EXPECT_EQ(map.erase(1), 1);
+    EXPECT_EQ(map.erase(1), 0);
+    EXPECT_FALSE(map.contains(1));
+    EXPECT_TRUE(map.contains(2));
+
+    const FlatHashMap<int, std::string> copy = map;
+    EXPECT_EQ(copy, map);
+}
+
+TEST(FlatHashMapTest, MatchesUnorderedMapUnderRandomOperations)
+{
+    FlatHashMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> expected;
+    std::mt19937_64 random(42);
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        // a small key range, so that erasures hit and tombstones pile up
+        const uint64_t key = random() % 4096;
+        switch (random() % 3)
+        {
+            case 0:
+                map[key] = uint64_t(i);
+                expected[key] = uint64_t(i);
+                break;
+            case 1:
+                ASSERT_EQ(map.erase(key), expected.erase(key));
+                break;
+            default:
+                ASSERT_EQ(map.contains(key), expected.contains(key));
+                break;
+        }
+    }
+
+    ASSERT_EQ(map.size(), expected.size());
+    for (const auto& [key, value] : map) EXPECT_EQ(expected.at(key), value);
+
+    // erasing while iterating
+    const size_t odd = map.erase_if([](const auto& _pair) { return _pair.first % 2 == 1; });
+    for (auto it = map.begin(); it != map.end();) it = map.erase(it);
+    EXPECT_GT(odd, 0);
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(FlatHashMapTest, ReservedCapacityHoldsWithoutRehashing)
+{
+    FlatHashMap<int, int> map;
+    map.reserve(1000);
+    const size_t capacity = map.capacity();
+
+    for (int i = 0; i < 1000; ++i) map[i] = i;
+    EXPECT_EQ(map.capacity(), capacity);
+
+    // churn within the same size reuses the tombstones
+    for (int i = 0; i < 100000; ++i)
+    {
+        map.erase(i);
+        map[i + 1000] = i;
+    }
+
+    EXPECT_EQ(map.size(), 1000);
+    EXPECT_EQ(map.capacity(), capacity);
+}
+
+TEST(FlatHashMapTest, TransparentLookupAndMoveOnlyValues)
+{
+    struct StringHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view _key) const
+        {
+            return std::hash<std::string_view>{}(_key);
+        }
+    };
+
+    FlatHashMap<std::string, std::unique_ptr<int>, StringHash, std::equal_to<>> map;
+    for (int i = 0; i < 100; ++i) map.try_emplace(std::to_string(i), std::make_unique<int>(i));
+
+    const std::string_view key = "42";
+    ASSERT_TRUE(map.contains(key));
+    EXPECT_EQ(*map.find(key)->second, 42);
+    EXPECT_EQ(map.erase(key), 1);
+
+    auto moved = std::move(map);
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(moved.size(), 99);
+}
+
+TEST(FlatHashMapTest, InsertingACopyOfAnElementSurvivesTheRehash)
+{
+    FlatHashMap<int, std::string> map;
+    map[0] = std::string(64, 'x');
+
+    // each insert may grow the table and move the element copied from
+    for (int i = 1; i < 100; ++i) map.try_emplace(i, map.at(0));
+
+    for (const auto& [key, value] : map) EXPECT_EQ(value, std::string(64, 'x'));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FlatHashSet Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(FlatHashSetTest, InsertEraseAndIterate)
+{
+    FlatHashSet<std::string> set = {"a", "b", "c"};
+
+    EXPECT_FALSE(set.insert("a").second);
+    EXPECT_TRUE(set.emplace(3, 'd').second);
+    EXPECT_TRUE(set.contains("ddd"));
+
+    EXPECT_EQ(set.erase("b"), 1);
+
+    std::string joined;
+    for (const std::string& key : set) joined += key;
+    std::sort(joined.begin(), joined.end());
+    EXPECT_EQ(joined, "acddd");
+}
@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <pieces/intrinsics/simd_math.hpp>
+
+using namespace pieces::simd;
+
+namespace
+{
+
+std::array<float, 4> lanes(float4 _v)
+{
+    std::array<float, 4> result;
+    _v.store(result.data());
+    return result;
+}
+
+std::array<int32_t, 4> lanes(int4 _v)
+{
+    std::array<int32_t, 4> result;
+    _v.store(result.data());
+    return result;
+}
+
+void expectNear(float4 _actual, std::array<float, 4> _expected, float _tolerance = 1e-5f)
+{
+    const std::array<float, 4> actual = lanes(_actual);
+    for (int i = 0; i < 4; ++i) EXPECT_NEAR(actual[i], _expected[i], _tolerance) << "lane " << i;
+}
+
+// The reference: element (row, column) of a column-major matrix
+float element(const mat4& _m, int _row, int _column) { return lanes(_m.columns[_column])[_row]; }
+
+float4 randomVector(std::mt19937& _random)
+{
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    return float4(distribution(_random), distribution(_random), distribution(_random),
+                  distribution(_random));
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// float4 / int4 Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(SimdMathTest, Float4ArithmeticAndGeometry)
+{
+    const float4 a(1.0f, 2.0f, 3.0f, 4.0f);
+    const float4 b(-2.0f, 0.5f, 6.0f, 1.0f);
+
+    expectNear(a + b, {-1.0f, 2.5f, 9.0f, 5.0f});
+    expectNear(a * b - a / 2.0f, {-2.5f, 0.0f, 16.5f, 2.0f});
+    expectNear(min(a, b), {-2.0f, 0.5f, 3.0f, 1.0f});
+    expectNear(abs(-a), {1.0f, 2.0f, 3.0f, 4.0f});
+    expectNear(lerp(a, b, 0.5f), {-0.5f, 1.25f, 4.5f, 2.5f});
+    EXPECT_FLOAT_EQ(a.z(), 3.0f);
+
+    EXPECT_FLOAT_EQ(dot(a, b), -2.0f + 1.0f + 18.0f + 4.0f);
+    EXPECT_FLOAT_EQ(dot3(a, b), -2.0f + 1.0f + 18.0f);
+    expectNear(cross(a, b), {2.0f * 6.0f - 3.0f * 0.5f, 3.0f * -2.0f - 1.0f * 6.0f,
+                             1.0f * 0.5f - 2.0f * -2.0f, 0.0f});
+    EXPECT_NEAR(length3(normalize3(a)), 1.0f, 1e-6f);
+    EXPECT_NEAR(length(normalize(a)), 1.0f, 1e-6f);
+}
+
+TEST(SimdMathTest, Int4ArithmeticMasksAndSelect)
+{
+    const int4 a(7, -3, 1 << 20, 0);
+    const int4 b(-5, 4, 3000, 9);
+
+    EXPECT_EQ(lanes(a * b), (std::array<int32_t, 4>{-35, -12, int32_t((1u << 20) * 3000u), 0}));
+    EXPECT_EQ(lanes(shiftRight<1>(a)), (std::array<int32_t, 4>{3, -2, 1 << 19, 0}));
+    EXPECT_EQ(lanes(shiftLeft<2>(a - b)), (std::array<int32_t, 4>{48, -28, ((1 << 20) - 3000) * 4,
+                                                                  -36}));
+
+    const int4 greater = a > b;
+    EXPECT_EQ(greater.bits(), 0b0101u);
+    EXPECT_TRUE(greater.any());
+    EXPECT_FALSE(greater.all());
+    EXPECT_EQ(lanes(select(greater, a, b)), (std::array<int32_t, 4>{7, 4, 1 << 20, 9}));
+
+    const float4 x(1.5f, -2.5f, 3.0f, 0.0f);
+    const int4 negative = x < float4::zero();
+    EXPECT_EQ(negative.bits(), 0b0010u);
+    expectNear(select(negative, -x, x), {1.5f, 2.5f, 3.0f, 0.0f});
+    EXPECT_EQ(lanes(int4::fromFloat(x)), (std::array<int32_t, 4>{1, -2, 3, 0}));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// mat4 Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(SimdMathTest, MatrixProductsMatchTheReference)
+{
+    std::mt19937 random(3);
+    mat4 a;
+    mat4 b;
+    for (int i = 0; i < 4; ++i)
+    {
+        a.columns[i] = randomVector(random);
+        b.columns[i] = randomVector(random);
+    }
+
+    const mat4 product = a * b;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            float expected = 0.0f;
+            for (int k = 0; k < 4; ++k) expected += element(a, row, k) * element(b, k, column);
+            EXPECT_NEAR(element(product, row, column), expected, 1e-3f);
+            EXPECT_EQ(element(transpose(a), row, column), element(a, column, row));
+        }
+    }
+
+    const float4 v = randomVector(random);
+    const float4 av = a * v;
+    for (int row = 0; row < 4; ++row)
+    {
+        float expected = 0.0f;
+        for (int k = 0; k < 4; ++k) expected += element(a, row, k) * lanes(v)[k];
+        EXPECT_NEAR(lanes(av)[row], expected, 1e-3f);
+    }
+
+    // column-major through load() and store()
+    std::array<float, 16> raw;
+    a.store(raw.data());
+    EXPECT_EQ(raw[1 * 4 + 2], element(a, 2, 1));
+    expectNear((mat4::load(raw.data()) * mat4::identity()).columns[3], lanes(a.columns[3]));
+}
+
+TEST(SimdMathTest, QuaternionRotatesAndComposesWithTranslationAndScale)
+{
+    // 90 degrees about z: x goes to y
+    const float half = std::sqrt(0.5f);
+    const mat4 rotation = mat4::fromQuaternion(float4(0.0f, 0.0f, half, half));
+    expectNear(rotation * float4(1.0f, 0.0f, 0.0f, 1.0f), {0.0f, 1.0f, 0.0f, 1.0f});
+    expectNear(rotation * float4(0.0f, 0.0f, 1.0f, 0.0f), {0.0f, 0.0f, 1.0f, 0.0f});
+
+    // an arbitrary axis: the rotation preserves lengths and keeps the axis
+    const float4 axis = normalize3(float4(1.0f, 2.0f, -2.0f, 0.0f));
+    const float s = std::sin(0.6f);
+    const mat4 spin =
+        mat4::fromQuaternion(float4(axis.x() * s, axis.y() * s, axis.z() * s, std::cos(0.6f)));
+    expectNear(spin * axis, lanes(axis));
+    EXPECT_NEAR(length3(spin * float4(3.0f, -1.0f, 2.0f, 0.0f)), std::sqrt(14.0f), 1e-5f);
+
+    const mat4 trs = mat4::fromTranslationRotationScale(
+        float4(5.0f, 6.0f, 7.0f, 123.0f), float4(0.0f, 0.0f, half, half),
+        float4(2.0f, 3.0f, 4.0f, 0.0f));
+    expectNear(trs * float4(1.0f, 1.0f, 1.0f, 1.0f), {5.0f - 3.0f, 6.0f + 2.0f, 7.0f + 4.0f, 1.0f});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// float4x8 and Span Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(SimdMathTest, BatchesMatchTheVectorOperations)
+{
+    std::mt19937 random(5);
+    std::array<float4, 8> a;
+    std::array<float4, 8> b;
+    for (int i = 0; i < 8; ++i)
+    {
+        a[i] = randomVector(random);
+        b[i] = randomVector(random);
+    }
+
+    const float4x8 batchA = float4x8::fromVectors(a.data());
+    const float4x8 batchB = float4x8::fromVectors(b.data());
+
+    std::array<float4, 8> roundTrip;
+    batchA.toVectors(roundTrip.data());
+    for (int i = 0; i < 8; ++i) expectNear(roundTrip[i], lanes(a[i]), 0.0f);
+
+    std::array<float, 8> dots;
+    dot(batchA, batchB).store(dots.data());
+
+    std::array<float4, 8> crosses;
+    cross(batchA, batchB).toVectors(crosses.data());
+
+    const mat4 m = mat4::fromTranslationRotationScale(
+        float4(1.0f, 2.0f, 3.0f, 1.0f), normalize(float4(0.1f, 0.2f, 0.3f, 0.9f)), float4(2.0f));
+    std::array<float4, 8> transformed;
+    (m * batchA).toVectors(transformed.data());
+
+    for (int i = 0; i < 8; ++i)
+    {
+        EXPECT_NEAR(dots[i], dot(a[i], b[i]), 1e-3f);
+        expectNear(crosses[i], lanes(cross(a[i], b[i])), 1e-3f);
+        expectNear(transformed[i], lanes(m * a[i]), 1e-3f);
+    }
+}
+
+TEST(SimdMathTest, SpanOperationsHandleTheTail)
+{
+    std::mt19937 random(9);
+    std::vector<float4> a(11);
+    std::vector<float4> b(11);
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = randomVector(random);
+        b[i] = randomVector(random);
+    }
+
+    std::vector<float> dots(a.size());
+    std::vector<float> dots3(a.size());
+    std::vector<float4> crosses(a.size());
+    dot(a, b, dots);
+    dot3(a, b, dots3);
+    cross(a, b, crosses);
+
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        EXPECT_NEAR(dots[i], dot(a[i], b[i]), 1e-3f);
+        EXPECT_NEAR(dots3[i], dot3(a[i], b[i]), 1e-3f);
+        expectNear(crosses[i], lanes(cross(a[i], b[i])), 1e-3f);
+    }
+
+    // in place
+    const mat4 scale = mat4::fromTranslationRotationScale(
+        float4::zero(), float4(0.0f, 0.0f, 0.0f, 1.0f), float4(2.0f));
+    std::vector<float4> scaled = a;
+    transform(scale, scaled, scaled);
+    expectNear(scaled[10], {a[10].x() * 2, a[10].y() * 2, a[10].z() * 2, a[10].w()});
+
+    EXPECT_THROW(dot(a, std::span(b).first(3), dots), std::invalid_argument);
+    EXPECT_THROW(cross(a, b, std::span(crosses).first(3)), std::invalid_argument);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <pieces/containers/small_string.hpp>
+#include <pieces/containers/small_vector.hpp>
+
+using namespace pieces;
+
+namespace
+{
+
+// Counts its live instances, to catch a leaked or doubly destroyed element
+struct Tracked
+{
+    static inline int s_live = 0;
+
+    std::string value;
+
+    Tracked(std::string _value = {}) : value(std::move(_value)) { ++s_live; }
+    Tracked(const Tracked& _other) : value(_other.value) { ++s_live; }
+    Tracked(Tracked&& _other) noexcept : value(std::move(_other.value)) { ++s_live; }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) noexcept = default;
+    ~Tracked() { --s_live; }
+
+    bool operator==(const Tracked& _other) const { return value == _other.value; }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SmallVector Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(SmallVectorTest, StaysInlineUpToItsCapacity)
+{
+    SmallVector<int, 4> vector;
+    EXPECT_TRUE(vector.empty());
+    EXPECT_EQ(vector.capacity(), 4);
+
+    for (int i = 0; i < 4; ++i) vector.push_back(i);
+    EXPECT_TRUE(vector.isInline());
+
+    vector.push_back(4);
+    EXPECT_FALSE(vector.isInline());
+    EXPECT_EQ(vector, (SmallVector<int, 4>{0, 1, 2, 3, 4}));
+
+    vector.resize(3);
+    vector.shrink_to_fit();
+    EXPECT_TRUE(vector.isInline());
+    EXPECT_EQ(vector, (SmallVector<int, 4>{0, 1, 2}));
+    EXPECT_THROW((void)vector.at(3), std::out_of_range);
+}
+
+TEST(SmallVectorTest, MatchesStdVectorUnderRandomOperations)
+{
+    {
+        SmallVector<Tracked, 3> vector;
+        std::vector<Tracked> expected;
+        std::mt19937 random(17);
+
+        for (int i = 0; i < 20000; ++i)
+        {
+            const std::string value = std::to_string(i);
+            const size_t position = expected.empty() ? 0 : random() % expected.size();
+
+            switch (random() % 8)
+            {
+                case 0:
+                case 1:
+                    vector.emplace_back(value);
+                    expected.emplace_back(value);
+                    break;
+                case 2:
+                    vector.insert(vector.begin() + position, value);
+                    expected.insert(expected.begin() + position, value);
+                    break;
+                case 3:
+                    if (expected.empty()) break;
+                    vector.erase(vector.begin() + position);
+                    expected.erase(expected.begin() + position);
+                    break;
+                case 4:
+                    vector.insert(vector.begin() + position, 2, vector.empty() ? value : vector[0]);
+                    expected.insert(expected.begin() + position, 2,
+                                    expected.empty() ? value : expected[0]);
+                    break;
+                case 5:
+                    vector.resize(random() % 8);
+                    expected.resize(vector.size());
+                    break;
+                case 6:
+                {
+                    // a copy and a move through the other representation
+                    SmallVector<Tracked, 3> copy = vector;
+                    vector = std::move(copy);
+                    break;
+                }
+                case 7:
+                    // an element of the vector itself while it grows
+                    if (!expected.empty())
+                    {
+                        vector.push_back(vector[position]);
+                        expected.push_back(expected[position]);
+                    }
+                    break;
+            }
+
+            ASSERT_TRUE(std::equal(vector.begin(), vector.end(), expected.begin(), expected.end()))
+                << "at step " << i;
+        }
+
+        EXPECT_EQ(Tracked::s_live, int(vector.size() + expected.size()));
+    }
+
+    EXPECT_EQ(Tracked::s_live, 0);
+}
+
+TEST(SmallVectorTest, MovesStealTheHeapAndRelocateInlineElements)
+{
+    SmallVector<std::unique_ptr<int>, 2> inlineVector;
+    inlineVector.push_back(std::make_unique<int>(1));
+
+    SmallVector<std::unique_ptr<int>, 2> heapVector;
+    for (int i = 0; i < 5; ++i) heapVector.push_back(std::make_unique<int>(i));
+    const std::unique_ptr<int>* heapData = heapVector.data();
+
+    SmallVector<std::unique_ptr<int>, 2> stolen = std::move(heapVector);
+    EXPECT_EQ(stolen.data(), heapData);
+    EXPECT_TRUE(heapVector.empty());
+    EXPECT_TRUE(heapVector.isInline());
+
+    swap(stolen, inlineVector);
+    EXPECT_EQ(*stolen[0], 1);
+    EXPECT_EQ(inlineVector.size(), 5);
+    EXPECT_EQ(*inlineVector.back(), 4);
+
+    EXPECT_EQ(erase_if(inlineVector, [](const auto& _p) { return *_p % 2 == 1; }), 2);
+    EXPECT_EQ(inlineVector.size(), 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SmallString Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(SmallStringTest, BehavesLikeStdString)
+{
+    SmallString<8> string = "frame";
+    EXPECT_TRUE(string.isInline());
+    EXPECT_EQ(string, "frame");
+    EXPECT_STREQ(string.c_str(), "frame");
+
+    string += "::update";
+    string.push_back('!');
+    EXPECT_FALSE(string.isInline());
+    EXPECT_EQ(string, std::string("frame::update!"));
+    EXPECT_EQ(string.size(), 14);
+    EXPECT_STREQ(string.c_str(), "frame::update!");
+
+    EXPECT_EQ(string.find("::"), 5);
+    EXPECT_TRUE(string.starts_with("frame"));
+    EXPECT_EQ(string.substr(7, 6), "update");
+    EXPECT_LT(string, "game");
+
+    string.erase(5, 2).insert(5, " / ");
+    EXPECT_EQ(string, "frame / update!");
+
+    // from and into itself
+    string.append(std::string_view(string).substr(0, 5));
+    EXPECT_EQ(string, "frame / update!frame");
+    string.assign(std::string_view(string).substr(8, 6));
+    EXPECT_EQ(string, "update");
+
+    SmallString<8> moved = std::move(string);
+    EXPECT_EQ(moved, "update");
+    EXPECT_TRUE(string.empty());
+    EXPECT_STREQ(string.c_str(), "");
+
+    const std::unordered_set<SmallString<8>> names = {moved, SmallString<8>("render")};
+    EXPECT_TRUE(names.contains(SmallString<8>("render")));
+    EXPECT_EQ(std::hash<SmallString<8>>()(moved), std::hash<std::string_view>()("update"));
+}
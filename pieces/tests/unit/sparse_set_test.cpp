@@ -180,3 +180,61 @@ TEST_F(SparseSetTest, PageBoundaryReinsert)
 
     EXPECT_EQ(set.size(), edgeKeys.size());
 }
+
+TEST_F(SparseSetTest, BulkInsertContainsAndRemove)
+{
+    std::vector<K> keys(1000);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    for (K& key : keys) key *= 3;
+
+    std::vector<T> values(keys.begin(), keys.end());
+    set.insertBulk(keys, values);
+    EXPECT_EQ(set.size(), keys.size());
+    EXPECT_THROW(set.insertBulk(keys, std::span(values).first(1)), std::invalid_argument);
+
+    // every third key is present
+    std::vector<K> probes(3000);
+    std::iota(probes.begin(), probes.end(), 0);
+    auto results = std::make_unique<bool[]>(probes.size());
+    EXPECT_EQ(set.containsBulk(probes, {results.get(), probes.size()}), keys.size());
+    for (K probe : probes) EXPECT_EQ(results[probe], probe % 3 == 0);
+
+    EXPECT_EQ(set.removeBulk(std::span(probes).first(1500)), 500);
+    EXPECT_EQ(set.size(), 500);
+    for (const auto& [key, value] : set) EXPECT_EQ(value, static_cast<T>(key));
+}
+
+TEST_F(SparseSetTest, RemoveIfKeepsTheOrderOfTheRest)
+{
+    for (K key = 0; key < 200; ++key) set.insert(key, static_cast<T>(key));
+
+    EXPECT_EQ(set.removeIf([](K _key, const T&) { return _key % 4 != 0; }), 150);
+    ASSERT_EQ(set.size(), 50);
+
+    for (size_t i = 0; i < set.size(); ++i) EXPECT_EQ(set.keys()[i], i * 4);
+    for (K key = 0; key < 200; ++key) EXPECT_EQ(set.contains(key), key % 4 == 0);
+
+    // the moved keys are still found, and removable
+    EXPECT_EQ(set.get(196).unwrap(), 196);
+    set.remove(4);
+    EXPECT_EQ(set.get(196).unwrap(), 196);
+}
+
+TEST_F(SparseSetTest, SetOperationsPairTheRightValues)
+{
+    SparseSetType other;
+    for (K key = 100; key < 110; ++key) set.insert(key, static_cast<T>(key));
+    for (K key = 105; key < 200; ++key) other.insert(key, -static_cast<T>(key));
+
+    // values come from the left-hand set whichever set is probed
+    const SparseSetType intersection = set.getIntersection(other);
+    EXPECT_EQ(intersection.size(), 5);
+    for (const auto& [key, value] : intersection) EXPECT_EQ(value, static_cast<T>(key));
+    for (const auto& [key, value] : other.getIntersection(set)) EXPECT_EQ(value, -T(key));
+
+    EXPECT_EQ(set.getUnion(other).size(), 100);
+    EXPECT_EQ(set.getUnion(other).get(107).unwrap(), -107);
+    EXPECT_EQ(set.getDifference(other).size(), 5);
+    EXPECT_EQ(set.getSymmetricDifference(other).size(), 95);
+}
@@ -185,6 +185,44 @@ TEST_F(SPMCSnapshotBufferTest, IteratorSupport)
     EXPECT_EQ(*it, 10);
 }
 
+TEST_F(SPMCSnapshotBufferTest, HeldSnapshotOutlivesLaterPublishes)
+{
+    m_buffer.write(1);
+    m_buffer.publish();
+    auto held = m_buffer.getSnapshot();
+
+    for (int i = 0; i < 8; ++i)
+    {
+        m_buffer.write(100 + i);
+        m_buffer.publish();
+    }
+
+    // Its slot is not recycled while held
+    ASSERT_EQ(held->size(), 1);
+    EXPECT_EQ((*held)[0], 1);
+    EXPECT_EQ(m_buffer.getSlotCount(), 3);
+
+    held.reset();
+    EXPECT_FALSE(held);
+    EXPECT_EQ((*m_buffer.getSnapshot())[0], 107);
+}
+
+TEST_F(SPMCSnapshotBufferTest, PublishRecyclesTheStorageOfReleasedSnapshots)
+{
+    std::vector<const int*> storage;
+    for (int i = 0; i < 6; ++i)
+    {
+        for (int j = 0; j < 64; ++j) m_buffer.write(i);
+        m_buffer.publish();
+
+        storage.push_back(m_buffer.getSnapshot()->data().data());
+    }
+
+    // Write buffer, current and previous snapshot take turns: no copy, no allocation
+    EXPECT_EQ(m_buffer.getSlotCount(), 2);
+    for (size_t i = 3; i < storage.size(); ++i) EXPECT_EQ(storage[i], storage[i - 3]);
+}
+
 TEST_F(SPMCSnapshotBufferTest, InterleavedWriteAndPublish)
 {
     std::atomic<bool> done{false};
@@ -207,7 +245,8 @@ TEST_F(SPMCSnapshotBufferTest, InterleavedWriteAndPublish)
     std::thread reader(
         [&]()
         {
-            while (!done.load())
+            // At least one read, the writer may be done before the reader starts
+            do
             {
                 auto snapshot = m_buffer.getSnapshot();
                 readCount++;
@@ -220,7 +259,7 @@ TEST_F(SPMCSnapshotBufferTest, InterleavedWriteAndPublish)
                         EXPECT_GE((*snapshot)[i], (*snapshot)[i - 1]);
                     }
                 }
-            }
+            } while (!done.load());
         });
 
     writer.join();
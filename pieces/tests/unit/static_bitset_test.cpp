@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <pieces/containers/static_bitset.hpp>
+
+using namespace pieces;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(StaticBitSetTest, DefaultConstructedIsEmpty)
+{
+    StaticBitSet<100> bs;
+    EXPECT_EQ(bs.size(), 100);
+    EXPECT_EQ(bs.wordCount(), 2);
+    EXPECT_TRUE(bs.none());
+    EXPECT_FALSE(bs.any());
+}
+
+TEST(StaticBitSetTest, SetClearFlipAndTestBit)
+{
+    StaticBitSet<130> bs;
+    bs.setBit(3);
+    bs.setBit(129);
+    EXPECT_TRUE(bs.testBit(3));
+    EXPECT_TRUE(bs.testBit(129));
+    EXPECT_FALSE(bs.testBit(64));
+
+    bs.clearBit(3);
+    EXPECT_FALSE(bs.testBit(3));
+
+    bs.flipBit(64);
+    EXPECT_TRUE(bs.testBit(64));
+    EXPECT_EQ(bs.count(), 2);
+}
+
+TEST(StaticBitSetTest, SetAllKeepsPaddingClear)
+{
+    StaticBitSet<70> bs;
+    bs.setAll();
+    EXPECT_EQ(bs.popcount(), 70);
+    EXPECT_EQ(bs.findFirstClear(), 70);
+
+    bs.clearAll();
+    EXPECT_TRUE(bs.empty());
+}
+
+TEST(StaticBitSetTest, FindFirstSetAndClear)
+{
+    StaticBitSet<256> bs;
+    EXPECT_EQ(bs.findFirstSet(), 256);
+
+    bs.setBit(0);
+    bs.setBit(200);
+    EXPECT_EQ(bs.findFirstSet(), 0);
+    EXPECT_EQ(bs.findFirstSetFrom(1), 200);
+    EXPECT_EQ(bs.findFirstSetFrom(201), 256);
+    EXPECT_EQ(bs.findFirstClear(), 1);
+}
+
+TEST(StaticBitSetTest, BitwiseOperators)
+{
+    StaticBitSet<256> a, b;
+    a.setBit(1);
+    a.setBit(130);
+    b.setBit(130);
+    b.setBit(255);
+
+    EXPECT_EQ((a & b).count(), 1);
+    EXPECT_EQ((a | b).count(), 3);
+    EXPECT_EQ((a ^ b).count(), 2);
+
+    a |= b;
+    EXPECT_TRUE(a.testBit(255));
+    a &= b;
+    EXPECT_FALSE(a.testBit(1));
+    a ^= b;
+    EXPECT_TRUE(a.none());
+}
+
+TEST(StaticBitSetTest, EqualityAndSubsetChecks)
+{
+    StaticBitSet<256> sig, query;
+    sig.setBit(2);
+    sig.setBit(70);
+    sig.setBit(250);
+    query.setBit(70);
+
+    EXPECT_TRUE(sig.containsAll(query));
+    EXPECT_FALSE(query.containsAll(sig));
+    EXPECT_TRUE(sig.intersects(query));
+    EXPECT_NE(sig, query);
+
+    query.setBit(2);
+    query.setBit(250);
+    EXPECT_EQ(sig, query);
+
+    query.setBit(251);
+    EXPECT_FALSE(sig.containsAll(query));
+}
+
+TEST(StaticBitSetTest, UsableInConstantExpressions)
+{
+    constexpr auto bs = []
+    {
+        StaticBitSet<64> result;
+        result.setBit(5);
+        result.setBit(63);
+        return result;
+    }();
+
+    static_assert(bs.testBit(5) && bs.count() == 2);
+    static_assert(bs.containsAll(StaticBitSet<64>{}));
+    EXPECT_EQ(bs.findFirstSetFrom(6), 63);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pieces/containers/flat_hash_map.hpp>
+#include <pieces/utils/string_id.hpp>
+
+using namespace pieces;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// StringId Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(StringIdTest, LiteralsHashAtCompileTime)
+{
+    constexpr StringId moveLeft = "moveLeft"_sid;
+    static_assert(moveLeft == StringId("moveLeft"));
+    static_assert(moveLeft != "moveRight"_sid);
+    static_assert(StringId() == ""_sid);
+    static_assert(StringId::fromHash(moveLeft.getHash()) == moveLeft);
+
+    const std::string runtime = "move" + std::string("Left");
+    EXPECT_EQ(StringId(runtime), moveLeft);
+
+    FlatHashMap<StringId, int> map;
+    map["moveLeft"_sid] = 1;
+    EXPECT_EQ(map[StringId(runtime)], 1);
+}
+
+TEST(StringIdTest, InternStoresTheStringOnce)
+{
+    const StringId id = StringId::intern("StringIdTest.jump");
+    EXPECT_EQ(id, "StringIdTest.jump"_sid);
+    EXPECT_EQ(id.str(), "StringIdTest.jump");
+    EXPECT_EQ(id.str().data()[id.str().size()], '\0');
+
+    // Interned again, the view is the same
+    const char* data = id.str().data();
+    EXPECT_EQ(StringId::intern(std::string("StringIdTest.") + "jump"), id);
+    EXPECT_EQ(id.str().data(), data);
+
+    EXPECT_TRUE("StringIdTest.neverInterned"_sid.str().empty());
+}
+
+TEST(StringInternerTest, ReadsWhileAnotherThreadInterns)
+{
+    StringInterner interner;
+
+    // Enough strings for the table to grow several times, and one larger than a block
+    constexpr int k_count = 5000;
+    const std::string large(20000, 'x');
+
+    std::atomic<bool> done = false;
+    std::atomic<int> published = 0;
+
+    std::thread writer(
+        [&]
+        {
+            for (int i = 0; i < k_count; ++i)
+            {
+                (void)interner.intern("name" + std::to_string(i));
+                published.store(i + 1, std::memory_order_release);
+            }
+
+            (void)interner.intern(large);
+            done = true;
+        });
+
+    std::vector<std::thread> readers;
+    std::atomic<int> mismatches = 0;
+    for (int r = 0; r < 3; ++r)
+    {
+        readers.emplace_back(
+            [&]
+            {
+                while (!done)
+                {
+                    const int count = published.load(std::memory_order_acquire);
+                    for (int i = 0; i < count; i += 7)
+                    {
+                        const std::string name = "name" + std::to_string(i);
+                        if (interner.find(StringId(name)) != std::optional<std::string_view>(name))
+                        {
+                            ++mismatches;
+                        }
+                    }
+                }
+            });
+    }
+
+    writer.join();
+    for (std::thread& reader : readers) reader.join();
+
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_EQ(interner.size(), size_t(k_count) + 1);
+    EXPECT_EQ(interner.find(StringId(large)), std::optional<std::string_view>(large));
+    EXPECT_EQ(interner.find("name"_sid), std::nullopt);
+}
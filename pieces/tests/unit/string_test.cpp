@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pieces/containers/small_string.hpp>
+#include <pieces/utils/string.hpp>
+
+using namespace pieces;
+using namespace pieces::utils;
+
+namespace
+{
+
+// ASCII past a few vector blocks, then every sequence length
+const std::string k_mixed = std::string(37, 'a') + "h\xC3\xA9\xE3\x81\x8B\xF0\x9F\x98\x80z";
+const std::u32string k_mixedCodepoints = std::u32string(37, U'a') + U"héか\U0001F600z";
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Validation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(StringTest, ValidUtf8IsAccepted)
+{
+    EXPECT_TRUE(IsValidUtf8(""));
+    EXPECT_TRUE(IsValidUtf8(std::string(100, 'x')));
+    EXPECT_TRUE(IsValidUtf8(k_mixed));
+    EXPECT_TRUE(IsValidUtf8("\xF4\x8F\xBF\xBF")); // U+10FFFF
+}
+
+TEST(StringTest, MalformedUtf8IsRejectedAfterAsciiBlocks)
+{
+    const std::string prefix(40, 'a');
+
+    for (const char* bad : {
+             "\x80",             // lone continuation
+             "\xC0\xAF",         // overlong '/'
+             "\xE0\x80\xAF",     // overlong 3-byte
+             "\xED\xA0\x80",     // surrogate U+D800
+             "\xF4\x90\x80\x80", // past U+10FFFF
+             "\xF8\x88\x80\x80", // invalid lead
+             "\xE3\x81",         // truncated
+             "\xE3\x41\x8B",     // missing continuation
+         })
+    {
+        EXPECT_FALSE(IsValidUtf8(prefix + bad)) << prefix + bad;
+        EXPECT_FALSE(IsValidUtf8(bad + prefix)) << bad + prefix;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Caller-provided buffers
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(StringTest, SpanConversionsRoundTrip)
+{
+    std::array<char32_t, 64> codepoints;
+    auto decoded = Utf8ToCodepoints(k_mixed, codepoints);
+    ASSERT_TRUE(decoded.isOk());
+    EXPECT_EQ(std::u32string(codepoints.data(), decoded.unwrap()), k_mixedCodepoints);
+
+    std::array<char, 64> bytes;
+    auto encoded =
+        CodepointsToUtf8(std::span<const char32_t>(codepoints.data(), decoded.unwrap()), bytes);
+    ASSERT_TRUE(encoded.isOk());
+    EXPECT_EQ(std::string(bytes.data(), encoded.unwrap()), k_mixed);
+}
+
+TEST(StringTest, SpanConversionsReportErrors)
+{
+    std::array<char32_t, 64> codepoints;
+    EXPECT_EQ(Utf8ToCodepoints("ab\xC0\xAF", codepoints).error(), ErrorCode::parse_error);
+
+    // One short, in an ASCII run then on a multi-byte sequence
+    std::array<char32_t, 40> shortCodepoints;
+    EXPECT_EQ(Utf8ToCodepoints(std::string(41, 'a'), shortCodepoints).error(),
+              ErrorCode::buffer_overflow);
+    EXPECT_EQ(Utf8ToCodepoints(std::string(40, 'a') + "\xC3\xA9", shortCodepoints).error(),
+              ErrorCode::buffer_overflow);
+
+    std::array<char, 4> bytes;
+    EXPECT_EQ(CodepointsToUtf8(std::u32string(U"abcé"), bytes).error(),
+              ErrorCode::buffer_overflow);
+    EXPECT_EQ(CodepointsToUtf8(std::u32string(U"abé"), bytes).unwrap(), 4u);
+    EXPECT_EQ(CodepointsToUtf8(std::u32string{U'a', char32_t(0xD800)}, bytes).error(),
+              ErrorCode::parse_error);
+    EXPECT_EQ(CodepointsToUtf8(std::u32string{char32_t(0x110000)}, bytes).error(),
+              ErrorCode::parse_error);
+}
+
+TEST(StringTest, IteratorConversionsSpanSeveralChunks)
+{
+    std::string text;
+    for (int i = 0; i < 20; ++i) text += k_mixed;
+
+    std::u32string codepoints;
+    auto decoded = Utf8ToCodepoints(text, std::back_inserter(codepoints));
+    ASSERT_TRUE(decoded.isOk());
+    EXPECT_EQ(codepoints.size(), 20 * k_mixedCodepoints.size());
+    EXPECT_EQ(codepoints.substr(0, k_mixedCodepoints.size()), k_mixedCodepoints);
+
+    // Reused, the inline storage takes a keystroke without allocating
+    SmallString<32> utf8;
+    auto encoded = CodepointsToUtf8(std::u32string_view(U"hé"), std::back_inserter(utf8));
+    ASSERT_TRUE(encoded.isOk());
+    EXPECT_EQ(std::string_view(utf8.data(), utf8.size()), "h\xC3\xA9");
+    EXPECT_TRUE(utf8.isInline());
+
+    std::string all;
+    ASSERT_TRUE(CodepointsToUtf8(codepoints, std::back_inserter(all)).isOk());
+    EXPECT_EQ(all, text);
+
+    // What came before the malformed sequence is written
+    std::u32string partial;
+    EXPECT_EQ(Utf8ToCodepoints("abc\xFF", std::back_inserter(partial)).error(),
+              ErrorCode::parse_error);
+    EXPECT_EQ(partial, U"abc");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocating conversions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TEST(StringTest, AllocatingConversionsKeepTheirBehavior)
+{
+    EXPECT_EQ(Utf8ToUtf32(k_mixed), k_mixedCodepoints);
+    EXPECT_EQ(Utf32ToUtf8(k_mixedCodepoints), k_mixed);
+
+    const std::vector<char32_t> codepoints(k_mixedCodepoints.begin(), k_mixedCodepoints.end());
+    EXPECT_EQ(Utf8ToCodepoints(k_mixed), codepoints);
+    EXPECT_EQ(CodepointsToUtf8(codepoints), k_mixed);
+
+    // Utf8ToCodepoints stops at a malformed sequence, the others throw
+    EXPECT_EQ(Utf8ToCodepoints(std::string("ab\x80") + "cd"), (std::vector<char32_t>{U'a', U'b'}));
+    EXPECT_THROW((void)Utf8ToUtf32("ab\x80"), std::invalid_argument);
+    EXPECT_THROW((void)Utf32ToUtf8(std::u32string{char32_t(0xDFFF)}), std::invalid_argument);
+}
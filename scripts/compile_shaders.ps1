@@ -9,7 +9,7 @@ if (-not (Test-Path $OutputDir)) {
 }
 
 # Define shader file extensions to compile
-$extensions = @("vert", "frag", "comp", "geom", "tesc", "tese")
+$extensions = @("vert", "frag", "comp", "geom", "tesc", "tese", "task", "mesh")
 
 # Set counters for statistics
 $compiledCount = 0
@@ -27,7 +27,10 @@ foreach ($ext in $extensions) {
             $skippedCount++
         } else {
             Write-Host "Compiling $inputFile -> $outputFile"
-            $result = glslangValidator -V $inputFile -o $outputFile
+            # VK_EXT_mesh_shader needs SPIR-V 1.4
+            $targetEnv = @()
+            if ($ext -eq "task" -or $ext -eq "mesh") { $targetEnv = @("--target-env", "vulkan1.2") }
+            $result = glslangValidator -V @targetEnv $inputFile -o $outputFile
             if ($LASTEXITCODE -eq 0) {
                 $compiledCount++
             } else {
@@ -37,4 +40,35 @@ foreach ($ext in $extensions) {
     }
 }
 
+# The permutations the materials use, one "<source> <key>" per line (# comments), the key in
+# lowercase hexadecimal as getShaderVariantPath() names it:
+# compiled with MOSAIC_VARIANT defined to the key, "triangle.frag 5" to triangle.frag.5.spv
+$variants = Join-Path $InputDir "variants.txt"
+if (Test-Path $variants) {
+    Get-Content $variants | ForEach-Object {
+        $fields = $_.Trim() -split '\s+'
+        if ($fields.Count -lt 2 -or $fields[0].StartsWith("#")) { return }
+
+        $source = $fields[0]
+        $key = $fields[1]
+        $inputFile = Join-Path $InputDir $source
+        $outputFile = Join-Path $OutputDir "$source.$key.spv"
+
+        if ((Test-Path $outputFile) -and
+            ((Get-Item $outputFile).LastWriteTime -gt (Get-Item $inputFile).LastWriteTime) -and
+            ((Get-Item $outputFile).LastWriteTime -gt (Get-Item $variants).LastWriteTime)) {
+            Write-Host "Skipping $inputFile variant $key (already up to date)"
+            $skippedCount++
+        } else {
+            Write-Host "Compiling $inputFile variant $key -> $outputFile"
+            $result = glslangValidator -V "-DMOSAIC_VARIANT=0x$key" $inputFile -o $outputFile
+            if ($LASTEXITCODE -eq 0) {
+                $compiledCount++
+            } else {
+                Write-Host "Error compiling $inputFile variant $key" -ForegroundColor Red
+            }
+        }
+    }
+}
+
 Write-Host "Compilation complete: $compiledCount file(s) compiled, $skippedCount file(s) skipped."
\ No newline at end of file
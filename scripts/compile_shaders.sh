@@ -8,7 +8,7 @@ outputDir="${2:-assets/vulkan/shaders/bin}"
 mkdir -p "$outputDir"
 
 # Define shader file extensions to compile
-extensions=("vert" "frag" "comp" "geom" "tesc" "tese")
+extensions=("vert" "frag" "comp" "geom" "tesc" "tese" "task" "mesh")
 
 # Set a counter for modified files
 compiled_count=0
@@ -27,7 +27,10 @@ for ext in "${extensions[@]}"; do
             ((skipped_count++))
         else
             echo "Compiling $file -> $outputFile"
-            glslc "$file" -o "$outputFile"
+            # VK_EXT_mesh_shader needs SPIR-V 1.4
+            targetEnv=()
+            [ "$ext" = "task" ] || [ "$ext" = "mesh" ] && targetEnv=(--target-env=vulkan1.2)
+            glslc "${targetEnv[@]}" "$file" -o "$outputFile"
             if [ $? -eq 0 ]; then
                 ((compiled_count++))
             fi
@@ -35,4 +38,28 @@ for ext in "${extensions[@]}"; do
     done
 done
 
+# The permutations the materials use, one "<source> <key>" per line (# comments), the key in
+# lowercase hexadecimal as getShaderVariantPath() names it:
+# compiled with MOSAIC_VARIANT defined to the key, "triangle.frag 5" to triangle.frag.5.spv
+variants="$inputDir/variants.txt"
+if [ -f "$variants" ]; then
+    while read -r source key _; do
+        [ -n "$source" ] && [ "${source:0:1}" != "#" ] || continue
+        file="$inputDir/$source"
+        outputFile="$outputDir/${source}.${key}.spv"
+
+        if [ -f "$outputFile" ] && [ "$file" -ot "$outputFile" ] &&
+            [ "$variants" -ot "$outputFile" ]; then
+            echo "Skipping $file variant $key (already up to date)"
+            ((skipped_count++))
+        else
+            echo "Compiling $file variant $key -> $outputFile"
+            glslc -DMOSAIC_VARIANT=0x"$key" "$file" -o "$outputFile"
+            if [ $? -eq 0 ]; then
+                ((compiled_count++))
+            fi
+        fi
+    done < "$variants"
+fi
+
 echo "Compilation complete: $compiled_count file(s) compiled, $skipped_count file(s) skipped."
\ No newline at end of file
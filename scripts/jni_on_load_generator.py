@@ -31,6 +31,27 @@ def parse_arguments():
         help="Output C++ file path (default: jni_loader.cpp)"
     )
     
+    parser.add_argument(
+        "--bridge-header",
+        type=str,
+        default="jni_bridge.hpp",
+        help="Output C++ header declaring the bindings (default: jni_bridge.hpp)"
+    )
+
+    parser.add_argument(
+        "--bridge-source",
+        type=str,
+        default="jni_bridge.cpp",
+        help="Output C++ file defining the bindings and their table (default: jni_bridge.cpp)"
+    )
+
+    parser.add_argument(
+        "--bridge-include",
+        type=str,
+        default="mosaic/platform/AGDK/jni_bridge.hpp",
+        help="How the bridge source includes the bridge header"
+    )
+
     parser.add_argument(
         "--helper-class",
         type=str,
@@ -291,6 +312,126 @@ def extract_native_exports(kotlin_files: List[Path], verbose: bool = False) -> D
     
     return dict(class_methods)
 
+def split_jni_signature(signature: str) -> Tuple[List[str], str]:
+    """
+    Split a JNI method signature into its parameter types and its return type.
+
+    Args:
+        signature: JNI signature (e.g. "(Ljava/lang/String;Z)V")
+
+    Returns:
+        Tuple of (parameter signatures, return signature)
+    """
+    params = []
+    i = 1  # past '('
+
+    while signature[i] != ')':
+        start = i
+        while signature[i] == '[':
+            i += 1
+        if signature[i] == 'L':
+            i = signature.index(';', i)
+        i += 1
+        params.append(signature[start:i])
+
+    return params, signature[i + 1:]
+
+def jni_to_cpp_type(sig: str) -> str:
+    """
+    Convert a JNI type signature to the C++ JNI type of the typed call stubs.
+
+    Args:
+        sig: JNI type signature (e.g. "I", "Ljava/lang/String;", "[F")
+
+    Returns:
+        C++ type name (e.g. "jint", "jstring", "jfloatArray")
+    """
+    primitives = {
+        "V": "void",
+        "Z": "jboolean",
+        "B": "jbyte",
+        "C": "jchar",
+        "S": "jshort",
+        "I": "jint",
+        "J": "jlong",
+        "F": "jfloat",
+        "D": "jdouble",
+    }
+
+    if sig in primitives:
+        return primitives[sig]
+    if sig == "Ljava/lang/String;":
+        return "jstring"
+    if sig.startswith("[") and sig[1:] in primitives and sig[1:] != "V":
+        return primitives[sig[1:]] + "Array"
+    if sig.startswith("["):
+        return "jobjectArray"
+
+    return "jobject"
+
+def generate_bridge_files(class_methods: Dict[str, List[Tuple[str, str]]], header_path: Path,
+                          source_path: Path, header_include: str):
+    """
+    Generate the typed bindings of the @NativeExport functions: a header declaring one
+    JNIStaticMethod per function, in a namespace per class, and a source defining them with the
+    table JNI_OnLoad binds.
+
+    Args:
+        class_methods: Dictionary mapping class names to method lists
+        header_path: Output header path
+        source_path: Output source path
+        header_include: Include path of the header from the source
+    """
+    total_methods = sum(len(methods) for methods in class_methods.values())
+
+    def typed(sig: str) -> str:
+        params, ret = split_jni_signature(sig)
+        return f"{jni_to_cpp_type(ret)}({', '.join(jni_to_cpp_type(p) for p in params)})"
+
+    with header_path.open('w', encoding='utf-8') as f:
+        f.write("// Auto-generated JNI bindings\n")
+        f.write("// Generated by jni_on_load_generator.py\n")
+        f.write(f"// Found {len(class_methods)} classes with {total_methods} methods\n\n")
+        f.write("#pragma once\n\n")
+        f.write("#include <span>\n\n")
+        f.write("#include \"mosaic/platform/AGDK/jni_bindings.hpp\"\n\n")
+        f.write("namespace mosaic\n{\nnamespace platform\n{\nnamespace agdk\n{\nnamespace bridge\n{\n\n")
+
+        for class_name, methods in class_methods.items():
+            f.write(f"// {class_name}\n")
+            f.write(f"namespace {class_name.split('/')[-1]}\n{{\n")
+            for name, sig in methods:
+                f.write(f"extern JNIStaticMethod<{typed(sig)}> {name};\n")
+            f.write("}\n\n")
+
+        f.write("// Every binding above, for JNIHelper::bind()\n")
+        f.write("[[nodiscard]] std::span<JNIBinding* const> getBindings();\n\n")
+        f.write("} // namespace bridge\n} // namespace agdk\n} // namespace platform\n} // namespace mosaic\n")
+
+    with source_path.open('w', encoding='utf-8') as f:
+        f.write("// Auto-generated JNI bindings\n")
+        f.write("// Generated by jni_on_load_generator.py\n\n")
+        f.write(f"#include \"{header_include}\"\n\n")
+        f.write("#include <array>\n\n")
+        f.write("namespace mosaic\n{\nnamespace platform\n{\nnamespace agdk\n{\nnamespace bridge\n{\n\n")
+
+        for class_name, methods in class_methods.items():
+            f.write(f"namespace {class_name.split('/')[-1]}\n{{\n")
+            for name, sig in methods:
+                f.write(f"JNIStaticMethod<{typed(sig)}> {name}{{\n")
+                f.write(f"    \"{class_name}\", \"{name}\",\n")
+                f.write(f"    \"{sig}\"}};\n")
+            f.write("}\n\n")
+
+        f.write(f"static const std::array<JNIBinding*, {total_methods}> k_bindings = {{\n")
+        for class_name, methods in class_methods.items():
+            for name, _ in methods:
+                f.write(f"    &{class_name.split('/')[-1]}::{name},\n")
+        f.write("};\n\n")
+
+        f.write("std::span<JNIBinding* const> getBindings() { return k_bindings; }\n\n")
+        f.write("} // namespace bridge\n} // namespace agdk\n} // namespace platform\n} // namespace mosaic\n")
+
 def generate_cpp_file(class_methods: Dict[str, List[Tuple[str, str]]], output_path: Path, helper_class: str):
     """
     Generate the C++ JNI loader file.
@@ -306,6 +447,8 @@ def generate_cpp_file(class_methods: Dict[str, List[Tuple[str, str]]], output_pa
         f.write("// Auto-generated JNI loader code\n")
         f.write("// Generated by jni_generator.py\n")
         f.write(f"// Found {len(class_methods)} classes with {total_methods} methods\n\n")
+
+        f.write("#include <mosaic/platform/AGDK/jni_bridge.hpp>\n\n")
         
         f.write("JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)\n")
         f.write("{\n")
@@ -315,26 +458,13 @@ def generate_cpp_file(class_methods: Dict[str, List[Tuple[str, str]]], output_pa
         
         f.write("    helper->initialize(vm);\n\n")
         
-        # Process each class
-        for class_name, methods in class_methods.items():
-            f.write(f"    // Load methods for {class_name}\n")
-            f.write(f"    {{\n")
-            f.write(f"        auto clazzRef = helper->findClass(\"{class_name}\");\n")
-            f.write(f"        if (!clazzRef)\n")
-            f.write(f"        {{\n")
-            f.write(f"            MOSAIC_ERROR(\"Failed to find {class_name.split('/')[-1]} class\");\n")
-            f.write(f"            return JNI_ERR;\n")
-            f.write(f"        }}\n\n")
-            
-            f.write(f"        helper->createGlobalRef(clazzRef);\n\n")
-            
-            # Generate getStaticMethodID calls for each method in this class
-            for name, sig in methods:
-                f.write(f"        helper->getStaticMethodID(\"{class_name}\", \"{name}\",\n")
-                f.write(f"                                  \"{sig}\");\n\n")
-            
-            f.write(f"    }}\n\n")
-        
+        # Every class and method ID resolved here, on the class loader of the application
+        f.write("    if (!helper->bind(mosaic::platform::agdk::bridge::getBindings()))\n")
+        f.write("    {\n")
+        f.write("        MOSAIC_ERROR(\"Failed to bind the engine bridge\");\n")
+        f.write("        return JNI_ERR;\n")
+        f.write("    }\n\n")
+
         f.write("    return JNI_VERSION_1_6;\n")
         f.write("}\n")
         
@@ -372,6 +502,8 @@ def main():
     # Generate output file
     output_path = Path(args.output)
     generate_cpp_file(class_methods, output_path, args.helper_class)
+    generate_bridge_files(class_methods, Path(args.bridge_header), Path(args.bridge_source),
+                          args.bridge_include)
     
     total_methods = sum(len(methods) for methods in class_methods.values())
     print(f"Generated {output_path} with {len(class_methods)} classes and {total_methods} method loaders.")
@@ -0,0 +1,374 @@
+"""
+Converts the binary trace files written by mosaic::tools::Tracer (.mtrace) to the Chrome
+trace format (JSON), which chrome://tracing and https://ui.perfetto.dev open.
+
+The layout of the files is described in mosaic/src/tools/tracer.cpp.
+
+With --connect, reads the live stream of a running game instead (Tracer::Config::streamPort or
+Tracer::startStreaming()), the same layout over TCP, until the game stops or Ctrl-C. On Android,
+forward the port first: adb forward tcp:<port> tcp:<port>.
+
+The stacks of the sampling profiler (Tracer::startSampling()) become the "stackFrames" of the
+trace, their frames named module+offset, or by function and line with --symbolize (llvm-symbolizer,
+against the modules as they are on this machine: symbolize on the machine that ran the game, or
+one with the same binaries).
+"""
+
+import argparse
+import json
+import bisect
+import socket
+import struct
+import subprocess
+import sys
+from pathlib import Path
+from typing import BinaryIO, Dict, Iterator, List, Optional, Tuple
+
+FILE_MAGIC = b"MOSTRACE"
+FILE_VERSION = 1
+
+CHUNK_METADATA = 1
+CHUNK_NAMES = 2
+CHUNK_SOURCES = 3
+CHUNK_EVENTS = 4
+
+FILE_HEADER = struct.Struct("<8sII")
+CHUNK_HEADER = struct.Struct("<II")
+EVENT_RECORD = struct.Struct("<qqQIIBB6x")
+DEFINITION = struct.Struct("<II")
+
+CATEGORY_NAMES = ["function", "scope", "gpu", "io", "memory", "render", "network", "custom"]
+PHASE_NAMES = ["X", "B", "E", "i", "C", "M", "P", "N", "O", "D", "s", "t", "f"]
+
+PHASE_COMPLETE = 0
+PHASE_COUNTER = 4
+PHASE_METADATA = 5
+PHASE_SAMPLE = 6
+
+
+def parse_arguments():
+    """Parse command line arguments."""
+    parser = argparse.ArgumentParser(
+        description="Convert Mosaic binary traces (.mtrace) to the Chrome trace format"
+    )
+
+    parser.add_argument(
+        "input",
+        type=str,
+        nargs="*",
+        help="Trace files, or directories of trace files",
+    )
+
+    parser.add_argument(
+        "-c", "--connect",
+        type=str,
+        default=None,
+        metavar="HOST:PORT",
+        help="Record the live stream of a running game instead",
+    )
+
+    parser.add_argument(
+        "-o", "--output",
+        type=str,
+        default=None,
+        help="Output directory (default: next to each input file)",
+    )
+
+    parser.add_argument(
+        "-s", "--symbolize",
+        action="store_true",
+        help="Name the frames of the sampled stacks by function and line",
+    )
+
+    parser.add_argument(
+        "--symbolizer",
+        type=str,
+        default="llvm-symbolizer",
+        help="The llvm-symbolizer to run with --symbolize (default: llvm-symbolizer)",
+    )
+
+    args = parser.parse_args()
+    if not args.input and not args.connect:
+        parser.error("no trace file, and no stream to connect to")
+
+    return args
+
+
+def read_chunks(file: BinaryIO) -> Iterator[Tuple[int, bytes]]:
+    """Yield the type and the payload of every chunk, after checking the file header."""
+    header = file.read(FILE_HEADER.size)
+    if len(header) < FILE_HEADER.size:
+        raise ValueError("truncated file header")
+
+    magic, version, _ = FILE_HEADER.unpack(header)
+    if magic != FILE_MAGIC:
+        raise ValueError("not a Mosaic trace file")
+    if version != FILE_VERSION:
+        raise ValueError(f"unsupported trace file version {version}")
+
+    while True:
+        chunk_header = file.read(CHUNK_HEADER.size)
+        if len(chunk_header) < CHUNK_HEADER.size:
+            return
+
+        chunk_type, size = CHUNK_HEADER.unpack(chunk_header)
+        payload = file.read(size)
+
+        # an interrupted write leaves a partial chunk at the end
+        if len(payload) < size:
+            return
+
+        yield chunk_type, payload
+
+
+def read_definitions(payload: bytes, table: Dict[int, str]):
+    """Read the { u32 id, u32 size, bytes } entries of a names or sources chunk."""
+    offset = 0
+    while offset < len(payload):
+        entry_id, size = DEFINITION.unpack_from(payload, offset)
+        offset += DEFINITION.size
+        table[entry_id] = payload[offset:offset + size].decode("utf-8", errors="replace")
+        offset += size
+
+
+class StackTable:
+    """The frames of the sampled stacks, as a tree from the roots: a stack is its leaf node."""
+
+    def __init__(self, symbolizer: Optional[str]):
+        self.symbolizer = symbolizer
+        self.modules: List[dict] = []
+        self.starts: List[int] = []
+        # (parent id, address) -> id, and the (parent id, address) of every id
+        self.ids: Dict[Tuple[Optional[int], int], int] = {}
+        self.nodes: List[Tuple[Optional[int], int]] = []
+
+    def add_modules(self, modules: List[dict]):
+        """Add the modules of a metadata chunk or of a "modules" event."""
+        for module in modules:
+            if module["start"] not in self.starts:
+                index = bisect.bisect(self.starts, module["start"])
+                self.starts.insert(index, module["start"])
+                self.modules.insert(index, module)
+
+    def add_stack(self, frames: List[str]) -> Optional[int]:
+        """Return the id of the stack of the frames, leaf first, None if empty."""
+        parent = None
+        for depth in range(len(frames) - 1, -1, -1):
+            address = int(frames[depth], 16)
+            # the return addresses of the callers point after their call
+            if depth != 0:
+                address -= 1
+
+            key = (parent, address)
+            if key not in self.ids:
+                self.ids[key] = len(self.nodes)
+                self.nodes.append(key)
+            parent = self.ids[key]
+
+        return parent
+
+    def find_module(self, address: int) -> Optional[dict]:
+        index = bisect.bisect(self.starts, address) - 1
+        if index >= 0 and address < self.modules[index]["end"]:
+            return self.modules[index]
+        return None
+
+    def symbolize(self) -> Dict[int, str]:
+        """Name the addresses of the frames with llvm-symbolizer, module by module."""
+        by_module: Dict[str, List[int]] = {}
+        for address in sorted({address for _, address in self.nodes}):
+            module = self.find_module(address)
+            if module:
+                by_module.setdefault(module["path"], []).append(address)
+
+        names: Dict[int, str] = {}
+        for path, addresses in by_module.items():
+            module = self.find_module(addresses[0])
+            command = [self.symbolizer, f"--obj={path}", "--no-inlines", "--demangle"]
+            # the offsets in a PE image are relative to its base
+            if path.lower().endswith((".dll", ".exe")):
+                command.append("--relative-address")
+
+            offsets = "\n".join(hex(address - module["bias"]) for address in addresses)
+            try:
+                output = subprocess.run(command, input=offsets, capture_output=True, text=True,
+                                        check=True).stdout
+            except (OSError, subprocess.CalledProcessError) as error:
+                print(f"{path}: could not symbolize ({error})", file=sys.stderr)
+                continue
+
+            # a function line and a location line per address, then a blank line
+            blocks = [block.splitlines() for block in output.strip().split("\n\n")]
+            for address, block in zip(addresses, blocks):
+                if block and block[0] != "??":
+                    location = Path(block[1]).name if len(block) > 1 else "??"
+                    location = "" if location.startswith("??") else location
+                    names[address] = f"{block[0]} {location}".strip()
+
+        return names
+
+    def stack_frames(self) -> dict:
+        """The "stackFrames" of the trace format."""
+        symbols = self.symbolize() if self.symbolizer and self.nodes else {}
+
+        frames = {}
+        for node_id, (parent, address) in enumerate(self.nodes):
+            module = self.find_module(address)
+            name = symbols.get(address)
+            if name is None:
+                name = (f"{Path(module['path']).name}+{address - module['bias']:#x}" if module
+                        else f"{address:#x}")
+
+            frame = {"name": name, "category": Path(module["path"]).name if module else "?"}
+            if parent is not None:
+                frame["parent"] = str(parent)
+            frames[str(node_id)] = frame
+
+        return frames
+
+
+def read_events(payload: bytes, names: Dict[int, str], stacks: StackTable) -> Iterator[dict]:
+    """Yield the events of an events chunk as Chrome trace events."""
+    offset = 0
+    while offset < len(payload):
+        timestamp, value, tid, name_id, args_size, category, phase = EVENT_RECORD.unpack_from(
+            payload, offset
+        )
+        offset += EVENT_RECORD.size
+
+        args = payload[offset:offset + args_size]
+        offset += args_size
+
+        name = names.get(name_id, "")
+        event = {
+            "cat": CATEGORY_NAMES[category] if category < len(CATEGORY_NAMES) else "custom",
+            "ph": PHASE_NAMES[phase] if phase < len(PHASE_NAMES) else "i",
+            "name": name,
+            "pid": 0,
+            "tid": tid,
+            # microseconds in the trace format
+            "ts": timestamp / 1000.0,
+        }
+
+        if phase == PHASE_COMPLETE:
+            event["dur"] = value / 1000.0
+        elif phase == PHASE_COUNTER:
+            event["args"] = {name: struct.unpack("<d", struct.pack("<q", value))[0]}
+        elif value:
+            event["id"] = value
+
+        if args:
+            try:
+                event["args"] = json.loads(args)
+            except ValueError:
+                event["args"] = {}
+
+        if phase == PHASE_METADATA and name == "modules":
+            stacks.add_modules(event.get("args", {}).get("modules", []))
+        elif phase == PHASE_SAMPLE:
+            stack = stacks.add_stack(event.pop("args", {}).get("frames", []))
+            if stack is not None:
+                event["sf"] = str(stack)
+
+        yield event
+
+
+def convert_stream(source: BinaryIO, output_path: Path, symbolizer: Optional[str] = None) -> int:
+    """Convert a trace read from a file or a socket. Returns the number of events.
+
+    Interrupted with Ctrl-C, the events read so far still make a complete output file.
+    """
+    names: Dict[int, str] = {}
+    sources: Dict[int, str] = {}
+    metadata = {}
+    stacks = StackTable(symbolizer)
+    count = 0
+
+    with output_path.open("w", encoding="utf-8") as out:
+        out.write('{"traceEvents":[')
+
+        try:
+            for chunk_type, payload in read_chunks(source):
+                if chunk_type == CHUNK_METADATA:
+                    metadata = json.loads(payload)
+                    stacks.add_modules(metadata.get("modules", []))
+                elif chunk_type == CHUNK_NAMES:
+                    read_definitions(payload, names)
+                elif chunk_type == CHUNK_SOURCES:
+                    read_definitions(payload, sources)
+                elif chunk_type == CHUNK_EVENTS:
+                    for event in read_events(payload, names, stacks):
+                        out.write("," if count else "")
+                        out.write(json.dumps(event, separators=(",", ":")))
+                        count += 1
+        except KeyboardInterrupt:
+            pass
+
+        metadata["sources"] = {names.get(i, ""): where for i, where in sources.items()}
+
+        # the frames are named once every module is known
+        out.write('],"stackFrames":')
+        out.write(json.dumps(stacks.stack_frames(), separators=(",", ":")))
+        out.write(',"metadata":')
+        out.write(json.dumps(metadata, separators=(",", ":")))
+        out.write("}\n")
+
+    return count
+
+
+def convert(input_path: Path, output_path: Path, symbolizer: Optional[str] = None) -> int:
+    """Convert one trace file, streaming its events. Returns the number of events."""
+    with input_path.open("rb") as source:
+        return convert_stream(source, output_path, symbolizer)
+
+
+def record(address: str, output_dir: Path, symbolizer: Optional[str] = None) -> int:
+    """Record the live stream of a running game to trace_live.json. Returns 0 on success."""
+    host, _, port = address.rpartition(":")
+    output_path = output_dir / "trace_live.json"
+
+    try:
+        with socket.create_connection((host or "127.0.0.1", int(port))) as connection:
+            print(f"Recording {address} to {output_path}, Ctrl-C to stop")
+            count = convert_stream(connection.makefile("rb"), output_path, symbolizer)
+            print(f"{address} -> {output_path} ({count} events)")
+    except (OSError, ValueError) as error:
+        print(f"{address}: {error}", file=sys.stderr)
+        return 1
+
+    return 0
+
+
+def main():
+    args = parse_arguments()
+    symbolizer = args.symbolizer if args.symbolize else None
+
+    if args.connect:
+        output_dir = Path(args.output) if args.output else Path.cwd()
+        output_dir.mkdir(parents=True, exist_ok=True)
+        return record(args.connect, output_dir, symbolizer)
+
+    inputs = []
+    for entry in args.input:
+        path = Path(entry)
+        inputs.extend(sorted(path.glob("*.mtrace")) if path.is_dir() else [path])
+
+    failed = False
+
+    for input_path in inputs:
+        output_dir = Path(args.output) if args.output else input_path.parent
+        output_dir.mkdir(parents=True, exist_ok=True)
+        output_path = output_dir / (input_path.stem + ".json")
+
+        try:
+            count = convert(input_path, output_path, symbolizer)
+            print(f"{input_path} -> {output_path} ({count} events)")
+        except (OSError, ValueError) as error:
+            print(f"{input_path}: {error}", file=sys.stderr)
+            failed = True
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -11,8 +11,10 @@
 #include <mosaic/ecs/entity_registry.hpp>
 
 #include <pieces/utils/string.hpp>
+#include <pieces/utils/string_id.hpp>
 
 using namespace std::chrono_literals;
+using namespace pieces::literals;
 
 namespace testbed
 {
@@ -156,13 +158,13 @@ void TestbedApplication::onPollInputs()
 
     auto inputContext = getInputSystem()->getContext(window);
 
-    if (inputContext->isActionTriggered("moveLeft")) MOSAIC_INFO("Moving left.");
-    if (inputContext->isActionTriggered("moveRight")) MOSAIC_INFO("Moving right.");
-    if (inputContext->isActionTriggered("moveUp")) MOSAIC_INFO("Moving up.");
-    if (inputContext->isActionTriggered("moveDown")) MOSAIC_INFO("Moving down.");
-    if (inputContext->isActionTriggered("resetCamera")) MOSAIC_INFO("Resetting camera.");
+    if (inputContext->isActionTriggered("moveLeft"_sid)) MOSAIC_INFO("Moving left.");
+    if (inputContext->isActionTriggered("moveRight"_sid)) MOSAIC_INFO("Moving right.");
+    if (inputContext->isActionTriggered("moveUp"_sid)) MOSAIC_INFO("Moving up.");
+    if (inputContext->isActionTriggered("moveDown"_sid)) MOSAIC_INFO("Moving down.");
+    if (inputContext->isActionTriggered("resetCamera"_sid)) MOSAIC_INFO("Resetting camera.");
 
-    if (window->shouldClose() || inputContext->isActionTriggered("closeApp"))
+    if (window->shouldClose() || inputContext->isActionTriggered("closeApp"_sid))
     {
         return requestExit();
     }